@@ -45,6 +45,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define CRYPTO_NID_SECP384R1           0x0205
 #define CRYPTO_NID_SECP521R1           0x0206
 #define CRYPTO_NID_SM2_P256            0x0207
+#define CRYPTO_NID_X25519              0x0208
+#define CRYPTO_NID_X448                0x0209
 
 // AEAD
 #define CRYPTO_NID_AES_128_GCM         0x0301
@@ -52,6 +54,14 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define CRYPTO_NID_CHACHA20_POLY1305   0x0303
 #define CRYPTO_NID_SM4_128_GCM         0x0304
 
+///
+/// One piece of a scatter-gather data buffer.
+///
+typedef struct {
+  VOID   *Buffer;
+  UINTN  Size;
+} CRYPT_DATA_SEGMENT;
+
 ///
 /// X.509 v3 Key Usage Extension flags
 ///
@@ -155,6 +165,32 @@ typedef enum {
 //    One-Way Cryptographic Hash SHA Primitives
 //=====================================================================================
 
+/**
+  Allocates one SHA-256 context for subsequent use.
+  The context must be initialized by Sha256Init() before it is used.
+
+  @return  Pointer to the SHA-256 context that has been allocated.
+           If the allocations fails, Sha256New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha256New (
+  VOID
+  );
+
+/**
+  Release the specified SHA-256 context.
+
+  @param[in]  Sha256Context  Pointer to the SHA-256 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha256Free (
+  IN  VOID  *Sha256Context
+  );
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-256 hash operations.
 
@@ -286,6 +322,58 @@ Sha256HashAll (
   OUT  UINT8       *HashValue
   );
 
+/**
+  Computes the SHA-256 message digests of several independent data buffers.
+
+  The result is the same as calling Sha256HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA-256 digest values (32 bytes each).
+
+  @retval TRUE   SHA-256 digest computation succeeded.
+  @retval FALSE  SHA-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  );
+
+/**
+  Allocates one SHA-384 context for subsequent use.
+  The context must be initialized by Sha384Init() before it is used.
+
+  @return  Pointer to the SHA-384 context that has been allocated.
+           If the allocations fails, Sha384New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha384New (
+  VOID
+  );
+
+/**
+  Release the specified SHA-384 context.
+
+  @param[in]  Sha384Context  Pointer to the SHA-384 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha384Free (
+  IN  VOID  *Sha384Context
+  );
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-384 hash operations.
 
@@ -417,6 +505,58 @@ Sha384HashAll (
   OUT  UINT8       *HashValue
   );
 
+/**
+  Computes the SHA-384 message digests of several independent data buffers.
+
+  The result is the same as calling Sha384HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA-384 digest values (48 bytes each).
+
+  @retval TRUE   SHA-384 digest computation succeeded.
+  @retval FALSE  SHA-384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  );
+
+/**
+  Allocates one SHA-512 context for subsequent use.
+  The context must be initialized by Sha512Init() before it is used.
+
+  @return  Pointer to the SHA-512 context that has been allocated.
+           If the allocations fails, Sha512New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha512New (
+  VOID
+  );
+
+/**
+  Release the specified SHA-512 context.
+
+  @param[in]  Sha512Context  Pointer to the SHA-512 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha512Free (
+  IN  VOID  *Sha512Context
+  );
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-512 hash operations.
 
@@ -552,6 +692,32 @@ Sha512HashAll (
 //    One-Way Cryptographic Hash SHA3 Primitives
 //=====================================================================================
 
+/**
+  Allocates one SHA3-256 context for subsequent use.
+  The context must be initialized by Sha3_256Init() before it is used.
+
+  @return  Pointer to the SHA3-256 context that has been allocated.
+           If the allocations fails, Sha3_256New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_256New (
+  VOID
+  );
+
+/**
+  Release the specified SHA3-256 context.
+
+  @param[in]  Sha3_256Context  Pointer to the SHA3-256 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_256Free (
+  IN  VOID  *Sha3_256Context
+  );
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-256 hash operations.
 
@@ -683,6 +849,58 @@ Sha3_256HashAll (
   OUT  UINT8       *HashValue
   );
 
+/**
+  Computes the SHA3-256 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_256HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-256 digest values (256 / 8 bytes each).
+
+  @retval TRUE   SHA3-256 digest computation succeeded.
+  @retval FALSE  SHA3-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_256HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  );
+
+/**
+  Allocates one SHA3-384 context for subsequent use.
+  The context must be initialized by Sha3_384Init() before it is used.
+
+  @return  Pointer to the SHA3-384 context that has been allocated.
+           If the allocations fails, Sha3_384New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_384New (
+  VOID
+  );
+
+/**
+  Release the specified SHA3-384 context.
+
+  @param[in]  Sha3_384Context  Pointer to the SHA3-384 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_384Free (
+  IN  VOID  *Sha3_384Context
+  );
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-384 hash operations.
 
@@ -814,6 +1032,58 @@ Sha3_384HashAll (
   OUT  UINT8       *HashValue
   );
 
+/**
+  Computes the SHA3-384 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_384HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-384 digest values (384 / 8 bytes each).
+
+  @retval TRUE   SHA3-384 digest computation succeeded.
+  @retval FALSE  SHA3-384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_384HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  );
+
+/**
+  Allocates one SHA3-512 context for subsequent use.
+  The context must be initialized by Sha3_512Init() before it is used.
+
+  @return  Pointer to the SHA3-512 context that has been allocated.
+           If the allocations fails, Sha3_512New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_512New (
+  VOID
+  );
+
+/**
+  Release the specified SHA3-512 context.
+
+  @param[in]  Sha3_512Context  Pointer to the SHA3-512 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_512Free (
+  IN  VOID  *Sha3_512Context
+  );
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA3-512 hash operations.
 
@@ -945,6 +1215,32 @@ Sha3_512HashAll (
   OUT  UINT8       *HashValue
   );
 
+/**
+  Computes the SHA3-512 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_512HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-512 digest values (512 / 8 bytes each).
+
+  @retval TRUE   SHA3-512 digest computation succeeded.
+  @retval FALSE  SHA3-512 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_512HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  );
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHAKE256 hash operations.
 
@@ -2282,12 +2578,597 @@ AeadAesGcmEncrypt (
   Performs AEAD AES-GCM authenticated decryption on a data buffer and additional authenticated data (AAD).
 
   IvSize must be 12, otherwise FALSE is returned.
-  KeySize must be 16, 24 or 32, otherwise FALSE is returned.
-  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  KeySize must be 16, 24 or 32, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in]   Key         Pointer to the encryption key.
+  @param[in]   KeySize     Size of the encryption key in bytes.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the decryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD AES-GCM authenticated decryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmDecrypt (
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  IN   CONST UINT8  *Tag,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  );
+
+/**
+  Allocates and initializes one AEAD AES-GCM context for subsequent use.
+
+  The context caches the AES key schedule and the GHASH key once AeadAesGcmSetKey()
+  is called, so that it can be reused for multiple AeadAesGcmSeal()/AeadAesGcmOpen()
+  operations with different IVs.
+
+  @return  Pointer to the AEAD AES-GCM context that has been initialized.
+           If the allocations fails, AeadAesGcmNew() returns NULL.
+
+**/
+VOID *
+EFIAPI
+AeadAesGcmNew (
+  VOID
+  );
+
+/**
+  Release the specified AEAD AES-GCM context.
+
+  @param[in]  AeadContext  Pointer to the AEAD AES-GCM context to be released.
+
+**/
+VOID
+EFIAPI
+AeadAesGcmFree (
+  IN  VOID  *AeadContext
+  );
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to AeadAesGcmSeal() or AeadAesGcmOpen().
+
+  If AeadContext is NULL, then return FALSE.
+  KeySize must be 16, 24 or 32, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the AEAD AES-GCM context.
+  @param[in]       Key          Pointer to the user-supplied key.
+  @param[in]       KeySize      Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmSetKey (
+  IN OUT  VOID         *AeadContext,
+  IN      CONST UINT8  *Key,
+  IN      UINTN        KeySize
+  );
+
+/**
+  Performs AEAD AES-GCM authenticated encryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD AES-GCM context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be encrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD AES-GCM authenticated encryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmSeal (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  OUT  UINT8        *TagOut,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  );
+
+/**
+  Performs AEAD AES-GCM authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD AES-GCM context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the decryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD AES-GCM authenticated decryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmOpen (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  IN   CONST UINT8  *Tag,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  );
+
+/**
+  Performs AEAD AES-GCM authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with the key held in the AEAD AES-GCM context.
+
+  The segments are encrypted in order, as if they were one contiguous buffer, into DataOut.
+  A segment may only overlap DataOut at the offset where its own cipher text is written.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the list of input data segments to be encrypted.
+  @param[in]   DataInCount Number of entries in DataIn.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD AES-GCM authenticated encryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmSealSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataIn,
+  IN   UINTN                       DataInCount,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize,
+  OUT  UINT8                       *DataOut,
+  OUT  UINTN                       *DataOutSize
+  );
+
+/**
+  Performs AEAD AES-GCM authenticated decryption on a data buffer and additional authenticated data (AAD)
+  into a list of data segments, with the key held in the AEAD AES-GCM context.
+
+  The plain text is written in order across the segments, which must hold at least DataInSize bytes.
+  A segment may only overlap DataIn at the offset where its own cipher text is read.
+  If the authentication fails, the plain text written to the segments is zeroed.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[in]   DataOut     Pointer to the list of segments that receive the decryption output.
+  @param[in]   DataOutCount Number of entries in DataOut.
+
+  @retval TRUE   AEAD AES-GCM authenticated decryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmOpenSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *DataIn,
+  IN   UINTN                       DataInSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataOut,
+  IN   UINTN                       DataOutCount
+  );
+
+/**
+  Generates the AEAD AES-GCM authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD AES-GCM context.
+
+  It is equivalent to AeadAesGcmSeal with an empty plain text, but no cipher text is processed.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD AES-GCM authentication tag generation succeeded.
+  @retval FALSE  AEAD AES-GCM authentication tag generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmMac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize
+  );
+
+/**
+  Verifies the AEAD AES-GCM authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD AES-GCM context.
+
+  It is equivalent to AeadAesGcmOpen with an empty cipher text, but no plain text is processed.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD AES-GCM authentication tag verification succeeded.
+  @retval FALSE  AEAD AES-GCM authentication tag verification failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmVerifyMac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize
+  );
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated encryption on a data buffer and additional authenticated data (AAD).
+
+  IvSize must be 12, otherwise FALSE is returned.
+  KeySize must be 32, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+
+  @param[in]   Key         Pointer to the encryption key.
+  @param[in]   KeySize     Size of the encryption key in bytes.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be encrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated encryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305Encrypt(
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  OUT  UINT8        *TagOut,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  );
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated decryption on a data buffer and additional authenticated data (AAD).
+
+  IvSize must be 12, otherwise FALSE is returned.
+  KeySize must be 32, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in]   Key         Pointer to the encryption key.
+  @param[in]   KeySize     Size of the encryption key in bytes.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the decryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated decryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305Decrypt(
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  IN   CONST UINT8  *Tag,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  );
+
+/**
+  Allocates and initializes one AEAD ChaCha20Poly1305 context for subsequent use.
+
+  The context caches the ChaCha20 key once AeadChaCha20Poly1305SetKey()
+  is called, so that it can be reused for multiple AeadChaCha20Poly1305Seal()/AeadChaCha20Poly1305Open()
+  operations with different IVs.
+
+  @return  Pointer to the AEAD ChaCha20Poly1305 context that has been initialized.
+           If the allocations fails, AeadChaCha20Poly1305New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+AeadChaCha20Poly1305New (
+  VOID
+  );
+
+/**
+  Release the specified AEAD ChaCha20Poly1305 context.
+
+  @param[in]  AeadContext  Pointer to the AEAD ChaCha20Poly1305 context to be released.
+
+**/
+VOID
+EFIAPI
+AeadChaCha20Poly1305Free (
+  IN  VOID  *AeadContext
+  );
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to AeadChaCha20Poly1305Seal() or AeadChaCha20Poly1305Open().
+
+  If AeadContext is NULL, then return FALSE.
+  KeySize must be 32, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the AEAD ChaCha20Poly1305 context.
+  @param[in]       Key          Pointer to the user-supplied key.
+  @param[in]       KeySize      Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305SetKey (
+  IN OUT  VOID         *AeadContext,
+  IN      CONST UINT8  *Key,
+  IN      UINTN        KeySize
+  );
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated encryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be encrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated encryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305Seal (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  OUT  UINT8        *TagOut,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  );
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the decryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated decryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305Open (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  IN   CONST UINT8  *Tag,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  );
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  The segments are encrypted in order, as if they were one contiguous buffer, into DataOut.
+  A segment may only overlap DataOut at the offset where its own cipher text is written.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the list of input data segments to be encrypted.
+  @param[in]   DataInCount Number of entries in DataIn.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated encryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305SealSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataIn,
+  IN   UINTN                       DataInCount,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize,
+  OUT  UINT8                       *DataOut,
+  OUT  UINTN                       *DataOutSize
+  );
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated decryption on a data buffer and additional authenticated data (AAD)
+  into a list of data segments, with the key held in the AEAD ChaCha20Poly1305 context.
+
+  The plain text is written in order across the segments, which must hold at least DataInSize bytes.
+  A segment may only overlap DataIn at the offset where its own cipher text is read.
+  If the authentication fails, the plain text written to the segments is zeroed.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
   If additional authenticated data verification fails, FALSE is returned.
 
-  @param[in]   Key         Pointer to the encryption key.
-  @param[in]   KeySize     Size of the encryption key in bytes.
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
   @param[in]   Iv          Pointer to the IV value.
   @param[in]   IvSize      Size of the IV value in bytes.
   @param[in]   AData       Pointer to the additional authenticated data (AAD).
@@ -2296,111 +3177,94 @@ AeadAesGcmEncrypt (
   @param[in]   DataInSize  Size of the input data buffer in bytes.
   @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
   @param[in]   TagSize     Size of the authentication tag in bytes.
-  @param[out]  DataOut     Pointer to a buffer that receives the decryption output.
-  @param[out]  DataOutSize Size of the output data buffer in bytes.
+  @param[in]   DataOut     Pointer to the list of segments that receive the decryption output.
+  @param[in]   DataOutCount Number of entries in DataOut.
 
-  @retval TRUE   AEAD AES-GCM authenticated decryption succeeded.
-  @retval FALSE  AEAD AES-GCM authenticated decryption failed.
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated decryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated decryption failed.
 
 **/
 BOOLEAN
 EFIAPI
-AeadAesGcmDecrypt (
-  IN   CONST UINT8  *Key,
-  IN   UINTN        KeySize,
-  IN   CONST UINT8  *Iv,
-  IN   UINTN        IvSize,
-  IN   CONST UINT8  *AData,
-  IN   UINTN        ADataSize,
-  IN   CONST UINT8  *DataIn,
-  IN   UINTN        DataInSize,
-  IN   CONST UINT8  *Tag,
-  IN   UINTN        TagSize,
-  OUT  UINT8        *DataOut,
-  OUT  UINTN        *DataOutSize
+AeadChaCha20Poly1305OpenSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *DataIn,
+  IN   UINTN                       DataInSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataOut,
+  IN   UINTN                       DataOutCount
   );
 
 /**
-  Performs AEAD ChaCha20Poly1305 authenticated encryption on a data buffer and additional authenticated data (AAD).
+  Generates the AEAD ChaCha20Poly1305 authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  It is equivalent to AeadChaCha20Poly1305Seal with an empty plain text, but no cipher text is processed.
 
   IvSize must be 12, otherwise FALSE is returned.
-  KeySize must be 32, otherwise FALSE is returned.
   TagSize must be 16, otherwise FALSE is returned.
 
-  @param[in]   Key         Pointer to the encryption key.
-  @param[in]   KeySize     Size of the encryption key in bytes.
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
   @param[in]   Iv          Pointer to the IV value.
   @param[in]   IvSize      Size of the IV value in bytes.
   @param[in]   AData       Pointer to the additional authenticated data (AAD).
   @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
-  @param[in]   DataIn      Pointer to the input data buffer to be encrypted.
-  @param[in]   DataInSize  Size of the input data buffer in bytes.
   @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
   @param[in]   TagSize     Size of the authentication tag in bytes.
-  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
-  @param[out]  DataOutSize Size of the output data buffer in bytes.
 
-  @retval TRUE   AEAD ChaCha20Poly1305 authenticated encryption succeeded.
-  @retval FALSE  AEAD ChaCha20Poly1305 authenticated encryption failed.
+  @retval TRUE   AEAD ChaCha20Poly1305 authentication tag generation succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authentication tag generation failed.
 
 **/
 BOOLEAN
 EFIAPI
-AeadChaCha20Poly1305Encrypt(
-  IN   CONST UINT8  *Key,
-  IN   UINTN        KeySize,
-  IN   CONST UINT8  *Iv,
-  IN   UINTN        IvSize,
-  IN   CONST UINT8  *AData,
-  IN   UINTN        ADataSize,
-  IN   CONST UINT8  *DataIn,
-  IN   UINTN        DataInSize,
-  OUT  UINT8        *TagOut,
-  IN   UINTN        TagSize,
-  OUT  UINT8        *DataOut,
-  OUT  UINTN        *DataOutSize
+AeadChaCha20Poly1305Mac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize
   );
 
 /**
-  Performs AEAD ChaCha20Poly1305 authenticated decryption on a data buffer and additional authenticated data (AAD).
+  Verifies the AEAD ChaCha20Poly1305 authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  It is equivalent to AeadChaCha20Poly1305Open with an empty cipher text, but no plain text is processed.
 
   IvSize must be 12, otherwise FALSE is returned.
-  KeySize must be 32, otherwise FALSE is returned.
   TagSize must be 16, otherwise FALSE is returned.
   If additional authenticated data verification fails, FALSE is returned.
 
-  @param[in]   Key         Pointer to the encryption key.
-  @param[in]   KeySize     Size of the encryption key in bytes.
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
   @param[in]   Iv          Pointer to the IV value.
   @param[in]   IvSize      Size of the IV value in bytes.
   @param[in]   AData       Pointer to the additional authenticated data (AAD).
   @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
-  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
-  @param[in]   DataInSize  Size of the input data buffer in bytes.
   @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
   @param[in]   TagSize     Size of the authentication tag in bytes.
-  @param[out]  DataOut     Pointer to a buffer that receives the decryption output.
-  @param[out]  DataOutSize Size of the output data buffer in bytes.
 
-  @retval TRUE   AEAD ChaCha20Poly1305 authenticated decryption succeeded.
-  @retval FALSE  AEAD ChaCha20Poly1305 authenticated decryption failed.
+  @retval TRUE   AEAD ChaCha20Poly1305 authentication tag verification succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authentication tag verification failed.
 
 **/
 BOOLEAN
 EFIAPI
-AeadChaCha20Poly1305Decrypt(
-  IN   CONST UINT8  *Key,
-  IN   UINTN        KeySize,
-  IN   CONST UINT8  *Iv,
-  IN   UINTN        IvSize,
-  IN   CONST UINT8  *AData,
-  IN   UINTN        ADataSize,
-  IN   CONST UINT8  *DataIn,
-  IN   UINTN        DataInSize,
-  IN   CONST UINT8  *Tag,
-  IN   UINTN        TagSize,
-  OUT  UINT8        *DataOut,
-  OUT  UINTN        *DataOutSize
+AeadChaCha20Poly1305VerifyMac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize
   );
 
 /**
@@ -2907,6 +3771,32 @@ RsaGetPublicKeyFromX509 (
   OUT  VOID         **RsaContext
   );
 
+/**
+  Retrieve the RSA Public Key from one DER-encoded SubjectPublicKeyInfo.
+
+  If DerData is NULL, then return FALSE.
+  If RsaContext is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in]  DerData      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param[in]  DerSize      Size of the DER data in bytes.
+  @param[out] RsaContext   Pointer to new-generated RSA context which contain the retrieved
+                           RSA public key component. Use RsaFree() function to free the
+                           resource.
+
+  @retval  TRUE   RSA Public Key was retrieved successfully.
+  @retval  FALSE  Invalid DER data, or the key is not an RSA key.
+  @retval  FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+RsaGetPublicKeyFromDer (
+  IN   CONST UINT8  *DerData,
+  IN   UINTN        DerSize,
+  OUT  VOID         **RsaContext
+  );
+
 /**
   Retrieve the EC Private Key from the password-protected PEM key data.
 
@@ -2933,6 +3823,31 @@ EcGetPrivateKeyFromPem (
   OUT  VOID         **EcContext
   );
 
+/**
+  Retrieve the EC Private Key held by the crypto implementation, such as a persistent key
+  provisioned in a secure element.
+
+  The key is used in place, and EcFree() does not destroy it.
+
+  If EcContext is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in]  KeyId        The key identifier of the crypto implementation.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which refer to the
+                           EC private key. Use EcFree() function to free the resource.
+
+  @retval  TRUE   EC Private Key was retrieved successfully.
+  @retval  FALSE  The key does not exist, or it is not a supported EC key pair.
+  @retval  FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPrivateKeyFromKeyId (
+  IN   UINT32       KeyId,
+  OUT  VOID         **EcContext
+  );
+
 /**
   Retrieve the EC Public Key from one DER-encoded X509 certificate.
 
@@ -2957,6 +3872,30 @@ EcGetPublicKeyFromX509 (
   OUT  VOID         **EcContext
   );
 
+/**
+  Retrieve the EC Public Key from one DER-encoded SubjectPublicKeyInfo.
+
+  @param[in]  DerData      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param[in]  DerSize      Size of the DER data in bytes.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which contain the retrieved
+                           EC public key component. Use EcFree() function to free the
+                           resource.
+
+  If DerData is NULL, then return FALSE.
+  If EcContext is NULL, then return FALSE.
+
+  @retval  TRUE   EC Public Key was retrieved successfully.
+  @retval  FALSE  Invalid DER data, or the key is not an EC key.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPublicKeyFromDer (
+  IN   CONST UINT8  *DerData,
+  IN   UINTN        DerSize,
+  OUT  VOID         **EcContext
+  );
+
 /**
   Retrieve the Ed Private Key from the password-protected PEM key data.
 
@@ -4445,6 +5384,71 @@ EcDsaVerify (
   IN  UINTN        SigSize
   );
 
+/**
+  Prepares the public key of an EC context for repeated EC-DSA verification.
+
+  The prepared public key holds precomputed multiples of the public key point and of
+  the curve generator, so that EcDsaVerifyPrepared() is faster than EcDsaVerify().
+  It does not refer to EcContext, which may be released before the prepared public key.
+
+  If EcContext is NULL, then return NULL.
+
+  @param[in]  EcContext    Pointer to EC context holding the public key.
+
+  @return  Pointer to the prepared public key.
+           If the public key is invalid or the allocations fails, EcDsaPreparePublicKey() returns NULL.
+
+**/
+VOID *
+EFIAPI
+EcDsaPreparePublicKey (
+  IN  VOID         *EcContext
+  );
+
+/**
+  Release the specified prepared public key.
+
+  @param[in]  PreparedKey  Pointer to the prepared public key to be released.
+
+**/
+VOID
+EFIAPI
+EcDsaFreePreparedPublicKey (
+  IN  VOID         *PreparedKey
+  );
+
+/**
+  Verifies the EC-DSA signature with a prepared public key.
+
+  The result is the same as EcDsaVerify() with the EC context the public key is prepared from.
+
+  If PreparedKey is NULL, then return FALSE.
+  If MessageHash is NULL, then return FALSE.
+  If Signature is NULL, then return FALSE.
+  If HashSize need match the HashNid. HashNid could be SHA256, SHA384, SHA512.
+
+  @param[in]  PreparedKey  Pointer to the prepared public key for signature verification.
+  @param[in]  HashNid      hash NID
+  @param[in]  MessageHash  Pointer to octet message hash to be checked.
+  @param[in]  HashSize     Size of the message hash in bytes.
+  @param[in]  Signature    Pointer to EC-DSA signature to be verified.
+  @param[in]  SigSize      Size of signature in bytes.
+
+  @retval  TRUE   Valid signature encoded in EC-DSA.
+  @retval  FALSE  Invalid signature or invalid prepared public key.
+
+**/
+BOOLEAN
+EFIAPI
+EcDsaVerifyPrepared (
+  IN  VOID         *PreparedKey,
+  IN  UINTN        HashNid,
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize
+  );
+
 //=====================================================================================
 //    Edwards-Curve Primitive
 //=====================================================================================
@@ -4643,6 +5647,112 @@ EdDsaVerify (
   IN  UINTN        SigSize
   );
 
+//=====================================================================================
+//    Montgomery-Curve Primitive
+//=====================================================================================
+
+/**
+  Allocates and Initializes one Montgomery-Curve Context for subsequent use
+  with the NID.
+
+  @param Nid cipher NID, CRYPTO_NID_X25519 or CRYPTO_NID_X448.
+
+  @return  Pointer to the Montgomery-Curve Context that has been initialized.
+           If the allocations fails, EcxNewByNid() returns NULL.
+
+**/
+VOID *
+EFIAPI
+EcxNewByNid (
+  IN UINTN  Nid
+  );
+
+/**
+  Release the specified Montgomery-Curve context.
+
+  @param[in]  EcxContext  Pointer to the Montgomery-Curve context to be released.
+
+**/
+VOID
+EFIAPI
+EcxFree (
+  IN  VOID  *EcxContext
+  );
+
+/**
+  Generates Montgomery-Curve key and returns the public key.
+
+  This function generates random secret, and computes the public key, which is
+  returned via parameter Public, PublicSize.
+  The public key is the u-coordinate in little-endian, as defined in RFC 7748.
+  If the Public buffer is too small to hold the public key, FALSE is returned and
+  PublicSize is set to the required buffer size to obtain the public key.
+
+  For X25519, the PublicSize is 32.
+  For X448, the PublicSize is 56.
+
+  If EcxContext is NULL, then return FALSE.
+  If PublicSize is NULL, then return FALSE.
+  If PublicSize is large enough but Public is NULL, then return FALSE.
+
+  @param[in, out]  EcxContext     Pointer to the Montgomery-Curve context.
+  @param[out]      Public         Pointer to the buffer to receive generated public key.
+  @param[in, out]  PublicSize     On input, the size of Public buffer in bytes.
+                                  On output, the size of data returned in Public buffer in bytes.
+
+  @retval TRUE   Montgomery-Curve public key generation succeeded.
+  @retval FALSE  Montgomery-Curve public key generation failed.
+  @retval FALSE  PublicSize is not large enough.
+
+**/
+BOOLEAN
+EFIAPI
+EcxGenerateKey (
+  IN OUT  VOID   *EcxContext,
+  OUT     UINT8  *Public,
+  IN OUT  UINTN  *PublicSize
+  );
+
+/**
+  Computes exchanged common key.
+
+  Given peer's public key, this function computes the exchanged common key,
+  based on its own context including value of curve parameter and random secret.
+  The peer's public key is the u-coordinate in little-endian, as defined in RFC 7748.
+  The exchanged key is rejected if it is all zero, which is the result of a
+  low-order peer's public key.
+
+  If EcxContext is NULL, then return FALSE.
+  If PeerPublic is NULL, then return FALSE.
+  If PeerPublicSize is not the size of the public key, then return FALSE.
+  If Key is NULL, then return FALSE.
+  If KeySize is not large enough, then return FALSE.
+
+  For X25519, the PeerPublicSize and KeySize are 32.
+  For X448, the PeerPublicSize and KeySize are 56.
+
+  @param[in, out]  EcxContext         Pointer to the Montgomery-Curve context.
+  @param[in]       PeerPublic         Pointer to the peer's public key.
+  @param[in]       PeerPublicSize     Size of peer's public key in bytes.
+  @param[out]      Key                Pointer to the buffer to receive generated key.
+  @param[in, out]  KeySize            On input, the size of Key buffer in bytes.
+                                      On output, the size of data returned in Key buffer in bytes.
+
+  @retval TRUE   Montgomery-Curve exchanged key generation succeeded.
+  @retval FALSE  Montgomery-Curve exchanged key generation failed.
+  @retval FALSE  KeySize is not large enough.
+
+**/
+BOOLEAN
+EFIAPI
+EcxComputeKey (
+  IN OUT  VOID         *EcxContext,
+  IN      CONST UINT8  *PeerPublic,
+  IN      UINTN        PeerPublicSize,
+  OUT     UINT8        *Key,
+  IN OUT  UINTN        *KeySize
+  );
+
 //=====================================================================================
 //    Shang-Mi2 Primitive
 //=====================================================================================
@@ -5170,4 +6280,47 @@ HkdfSha512Expand (
   IN   UINTN        OutSize
   );
 
+//=====================================================================================
+//    Scratch Arena
+//=====================================================================================
+
+/**
+  Sets a caller-provided scratch arena for the transient allocations of the crypto operations.
+
+  The allocations of the crypto backend are served from the arena while it is set, so the memory
+  footprint of the crypto operations is bounded by the arena. A context allocated from the arena,
+  such as a hash, HMAC, AEAD or key context, holds the arena until the context is freed.
+  The arena can only be changed when no context allocated from it is outstanding.
+  This function is not thread-safe.
+
+  @param[in]  Arena       Pointer to the arena buffer, or NULL to allocate from the heap.
+  @param[in]  ArenaSize   Size of the arena buffer in bytes.
+  @param[in]  Strict      If TRUE, an allocation fails when the arena cannot serve it,
+                          instead of falling back to the heap.
+
+  @retval TRUE   The scratch arena is set.
+  @retval FALSE  The allocations of the crypto backend cannot be redirected,
+                 or a context allocated from the current arena is outstanding.
+
+**/
+BOOLEAN
+EFIAPI
+CryptSetScratchArena (
+  IN  VOID     *Arena  OPTIONAL,
+  IN  UINTN    ArenaSize,
+  IN  BOOLEAN  Strict
+  );
+
+/**
+  Returns the peak size in bytes used in the scratch arena since it was set.
+
+  @return The peak size in bytes used in the scratch arena.
+
+**/
+UINTN
+EFIAPI
+CryptGetScratchArenaPeakSize (
+  VOID
+  );
+
 #endif // __BASE_CRYPT_LIB_H__
@@ -76,6 +76,44 @@ DebugAssert (
   IN CONST CHAR8  *Description
   );
 
+/**
+  Returns TRUE if any one of the bit is set both in ErrorLevel and in the debug print level of the platform.
+
+  It lets the callers skip the work done only to print a debug message, such as a hex dump.
+
+  @param  ErrorLevel  The error level of the debug message.
+
+  @retval TRUE    Current ErrorLevel is supported.
+  @retval FALSE   Current ErrorLevel is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+DebugPrintLevelEnabled (
+  IN  CONST UINTN        ErrorLevel
+  );
+
+/**
+  Prints the bytes of a buffer in hex to the debug output device if the specified error level is enabled.
+
+  It prints the same output as a DebugPrint() of "%02x" for each byte, or "%02x " if Separated is TRUE,
+  without formatting each byte through DebugPrint().
+
+  @param  ErrorLevel  The error level of the debug message.
+  @param  Data        The bytes to print.
+  @param  Size        The number of bytes to print.
+  @param  Separated   TRUE to print a space after each byte.
+
+**/
+VOID
+EFIAPI
+DebugPrintHex (
+  IN UINTN        ErrorLevel,
+  IN CONST VOID   *Data,
+  IN UINTN        Size,
+  IN BOOLEAN      Separated
+  );
+
 /**
   Internal worker macro that calls DebugAssert().
 
@@ -151,6 +189,25 @@ DebugAssert (
   #define DEBUG(Expression)
 #endif
 
+/**
+  Macro that calls DebugPrintHex().
+
+  If MDEPKG_NDEBUG is not defined, then this macro passes Expression to
+  DebugPrintHex().
+
+  @param  Expression  Expression containing an error level, a buffer, its size
+                      and if the bytes are separated.
+
+**/
+#if !defined(MDEPKG_NDEBUG)
+  #define DEBUG_HEX(Expression)    \
+    do {                           \
+      DebugPrintHex Expression;    \
+    } while (FALSE)
+#else
+  #define DEBUG_HEX(Expression)
+#endif
+
 /**
   Macro that calls DebugAssert() if a RETURN_STATUS evaluates to an error code.
 
@@ -5,6 +5,9 @@
   Definitions of DSP0239 Management Component Transport Protocol (MCTP) IDs and Codes
   version 1.7.0 in Distributed Management Task Force (DMTF).
 
+  Definitions of DSP0237 MCTP SMBus/I2C Transport Binding Specification
+  version 1.2.0 in Distributed Management Task Force (DMTF).
+
   Definitions of DSP0275 SPDM over MCTP Binding Specification
   version 1.0.0 in Distributed Management Task Force (DMTF).
 
@@ -38,6 +41,21 @@ typedef struct {
   UINT8   MessageTag;
 } MCTP_HEADER;
 
+#define MCTP_HEADER_VERSION                   0x01
+#define MCTP_HEADER_VERSION_MASK              0x0F
+
+#define MCTP_MESSAGE_TAG_MASK                 0x07
+#define MCTP_TAG_OWNER                        0x08
+#define MCTP_PACKET_SEQUENCE_NUMBER_SHIFT     4
+#define MCTP_PACKET_SEQUENCE_NUMBER_MASK      0x30
+#define MCTP_END_OF_MESSAGE                   0x40
+#define MCTP_START_OF_MESSAGE                 0x80
+
+//
+// The minimum transmission unit, in bytes of the packet payload after the MCTP header.
+//
+#define MCTP_BASELINE_TRANSMISSION_UNIT       64
+
 typedef struct {
   // B[0~6]: MessageType
   // B[7]  : IntegrityCheck
@@ -54,6 +72,27 @@ typedef struct {
 #define MCTP_MESSAGE_TYPE_VENDOR_DEFINED_PCI  0x7E
 #define MCTP_MESSAGE_TYPE_VENDOR_DEFINED_IANA 0x7F
 
+//
+// MCTP SMBus/I2C packet header
+//
+typedef struct {
+  // B[0]:   0 (write)
+  // B[1~7]: Destination slave address
+  UINT8   DestinationSlaveAddress;
+  UINT8   CommandCode;
+  // Number of bytes after ByteCount, excluding the PEC.
+  UINT8   ByteCount;
+  // B[0]:   1
+  // B[1~7]: Source slave address
+  UINT8   SourceSlaveAddress;
+//MCTP_HEADER  MctpHeader;
+//UINT8        Payload[];
+//UINT8        Pec;
+} MCTP_SMBUS_HEADER;
+
+#define MCTP_SMBUS_COMMAND_CODE               0x0F
+#define MCTP_SMBUS_PEC_SIZE                   1
+
 #pragma pack()
 
 #endif
@@ -0,0 +1,134 @@
+/** @file
+  Definition for pcap file format and link type
+
+  https://www.tcpdump.org/manpages/pcap-savefile.5.txt
+
+  https://wiki.wireshark.org/Development/LibpcapFileFormat
+
+  https://www.ietf.org/archive/id/draft-ietf-opsawg-pcapng-02.html
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __PCAP_H__
+#define __PCAP_H__
+
+#pragma pack(1)
+
+//
+// PCAP file format:
+// +---------------+---------------+-------------+---------------+-------------+---------------+-------------+-----+
+// | Global Header | Packet Header | Packet Data | Packet Header | Packet Data | Packet Header | Packet Data | ... |
+// +---------------+---------------+-------------+---------------+-------------+---------------+-------------+-----+
+//
+
+typedef struct {
+  UINT32 MagicNumber;
+  UINT16 VersionMajor;
+  UINT16 VersionMinor;
+  INT32  ThisZone;
+  UINT32 SigFigs;
+  UINT32 SnapLen;
+  UINT32 Network; // Data Link Type
+} PCAP_GLOBAL_HEADER;
+
+#define PCAP_GLOBAL_HEADER_MAGIC          0xa1b2c3d4
+#define PCAP_GLOBAL_HEADER_MAGIC_SWAPPED  0xd4c3b2a1
+
+#define PCAP_GLOBAL_HEADER_MAGIC_NANO          0xa1b23c4d
+#define PCAP_GLOBAL_HEADER_MAGIC_NANO_SWAPPED  0x4d3cb2a1
+
+#define PCAP_GLOBAL_HEADER_VERSION_MAJOR  0x0002
+#define PCAP_GLOBAL_HEADER_VERSION_MINOR  0x0004
+
+typedef struct {
+  UINT32 TsSec;
+  // PCAP_GLOBAL_HEADER_MAGIC      : MicroSecond
+  // PCAP_GLOBAL_HEADER_MAGIC_NANO : NanoSecond
+  UINT32 TsUsec;
+  UINT32 InclLen;
+  UINT32 OrigLen;
+} PCAP_PACKET_HEADER;
+
+//
+// PCAPNG file format:
+// +----------------------+-------------------------------+--------------------------+-----+
+// | Section Header Block | Interface Description Block   | Enhanced Packet Block    | ... |
+// +----------------------+-------------------------------+--------------------------+-----+
+//
+// Each block is a PCAPNG_BLOCK_HEADER, the block body padded to 4 bytes, and the UINT32 BlockTotalLength again.
+//
+
+typedef struct {
+  UINT32 BlockType;
+  UINT32 BlockTotalLength;
+} PCAPNG_BLOCK_HEADER;
+
+#define PCAPNG_BLOCK_TYPE_SECTION_HEADER          0x0A0D0D0A
+#define PCAPNG_BLOCK_TYPE_INTERFACE_DESCRIPTION   0x00000001
+#define PCAPNG_BLOCK_TYPE_SIMPLE_PACKET           0x00000003
+#define PCAPNG_BLOCK_TYPE_ENHANCED_PACKET         0x00000006
+
+typedef struct {
+  PCAPNG_BLOCK_HEADER Header;
+  UINT32 ByteOrderMagic;
+  UINT16 VersionMajor;
+  UINT16 VersionMinor;
+  INT64  SectionLength;
+//UINT8  Options[];
+} PCAPNG_SECTION_HEADER_BLOCK;
+
+#define PCAPNG_BYTE_ORDER_MAGIC          0x1A2B3C4D
+#define PCAPNG_BYTE_ORDER_MAGIC_SWAPPED  0x4D3C2B1A
+
+#define PCAPNG_SECTION_HEADER_VERSION_MAJOR  0x0001
+#define PCAPNG_SECTION_HEADER_VERSION_MINOR  0x0000
+
+typedef struct {
+  PCAPNG_BLOCK_HEADER Header;
+  UINT16 LinkType;
+  UINT16 Reserved;
+  UINT32 SnapLen;
+//UINT8  Options[];
+} PCAPNG_INTERFACE_DESCRIPTION_BLOCK;
+
+//
+// An option is a PCAPNG_OPTION_HEADER and the option value padded to 4 bytes. PCAPNG_OPTION_END_OF_OPT ends the options.
+//
+typedef struct {
+  UINT16 OptionCode;
+  UINT16 OptionLength;
+//UINT8  OptionValue[];
+} PCAPNG_OPTION_HEADER;
+
+#define PCAPNG_OPTION_END_OF_OPT  0x0000
+
+//
+// if_tsresol of the interface description block, one byte: the timestamp unit is 10^-Value seconds,
+// or 2^-(Value & 0x7F) seconds if bit 7 is set.
+//
+#define PCAPNG_OPTION_IF_TSRESOL  0x0009
+
+typedef struct {
+  PCAPNG_BLOCK_HEADER Header;
+  UINT32 OriginalPacketLength;
+//UINT8  PacketData[];
+} PCAPNG_SIMPLE_PACKET_BLOCK;
+
+typedef struct {
+  PCAPNG_BLOCK_HEADER Header;
+  UINT32 InterfaceId;
+  // in units of the if_tsresol of the interface, microsecond by default.
+  UINT32 TimestampHigh;
+  UINT32 TimestampLow;
+  UINT32 CapturedPacketLength;
+  UINT32 OriginalPacketLength;
+//UINT8  PacketData[];
+//UINT8  Options[];
+} PCAPNG_ENHANCED_PACKET_BLOCK;
+
+#pragma pack()
+
+#endif
@@ -38,6 +38,24 @@ typedef struct {
 #define PCI_DOE_MAX_SIZE_IN_BYTE                   0x00100000
 #define PCI_DOE_MAX_SIZE_IN_DW                     0x00040000
 
+//
+// DOE Extended Capability registers, at offsets from the capability in the configuration space
+//
+#define PCI_DOE_CAPABILITIES_OFFSET                0x04
+#define PCI_DOE_CONTROL_OFFSET                     0x08
+#define PCI_DOE_STATUS_OFFSET                      0x0C
+#define PCI_DOE_WRITE_DATA_MAILBOX_OFFSET          0x10
+#define PCI_DOE_READ_DATA_MAILBOX_OFFSET           0x14
+
+#define PCI_DOE_CONTROL_DOE_ABORT                  0x00000001
+#define PCI_DOE_CONTROL_DOE_INTERRUPT_ENABLE       0x00000002
+#define PCI_DOE_CONTROL_DOE_GO                     0x80000000
+
+#define PCI_DOE_STATUS_DOE_BUSY                    0x00000001
+#define PCI_DOE_STATUS_DOE_INTERRUPT_STATUS        0x00000002
+#define PCI_DOE_STATUS_DOE_ERROR                   0x00000004
+#define PCI_DOE_STATUS_DATA_OBJECT_READY           0x80000000
+
 //
 // DOE Discovery
 //
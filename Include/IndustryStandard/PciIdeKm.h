@@ -81,6 +81,21 @@ typedef struct {
 //IFV(invocation field of the IV) 2 DW 
 } PCI_IDE_KM_KEY_PROG;
 
+#define PCI_IDE_KM_KEY_SIZE                        32
+#define PCI_IDE_KM_IFV_SIZE                        8
+
+//
+// KeySubStream of KEY_PROG, KP_ACK, K_SET_GO, K_SET_STOP and K_GOSTOP_ACK
+//
+#define PCI_IDE_KM_KEY_SET_MASK                    0x01
+#define PCI_IDE_KM_KEY_DIRECTION_RX                0x00
+#define PCI_IDE_KM_KEY_DIRECTION_TX                0x02
+#define PCI_IDE_KM_KEY_SUB_STREAM_MASK             0xF0
+#define PCI_IDE_KM_KEY_SUB_STREAM_PR               0x00
+#define PCI_IDE_KM_KEY_SUB_STREAM_NPR              0x10
+#define PCI_IDE_KM_KEY_SUB_STREAM_CPL              0x20
+#define PCI_IDE_KM_KEY_SUB_STREAM_COUNT            3
+
 //
 // IDE_KM KP_ACK
 //
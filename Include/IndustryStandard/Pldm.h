@@ -16,12 +16,27 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #pragma pack(1)
 
 typedef struct {
+  // B[0~4]: InstanceID
+  // B[6]  : Datagram
+  // B[7]  : Request
   UINT8    InstanceID;
+  // B[0~5]: PldmType
+  // B[6~7]: HeaderVersion
   UINT8    PldmType;
   UINT8    PldmCommandCode;
 //UINT8    Payload[];
 } PLDM_MESSAGE_HEADER;
 
+#define PLDM_HEADER_INSTANCE_ID_MASK   0x1F
+#define PLDM_HEADER_DATAGRAM           0x40
+#define PLDM_HEADER_REQUEST            0x80
+#define PLDM_HEADER_TYPE_MASK          0x3F
+
+//
+// The number of instance IDs, that is the number of requests a PLDM requester may have in flight.
+//
+#define PLDM_INSTANCE_ID_COUNT         (PLDM_HEADER_INSTANCE_ID_MASK + 1)
+
 typedef struct {
   UINT8    PldmCompletionCode;
 } PLDM_MESSAGE_RESPONSE_HEADER;
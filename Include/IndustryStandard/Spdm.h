@@ -38,6 +38,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define SPDM_ENCAPSULATED_RESPONSE_ACK      0x6B
 #define SPDM_END_SESSION_ACK                0x6C
 ///
+/// SPDM response code (1.2)
+///
+#define SPDM_CHUNK_SEND_ACK                 0x05
+#define SPDM_CHUNK_RESPONSE                 0x06
+///
 /// SPDM request code (1.0)
 ///
 #define SPDM_GET_DIGESTS                    0x81
@@ -61,6 +66,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define SPDM_GET_ENCAPSULATED_REQUEST       0xEA
 #define SPDM_DELIVER_ENCAPSULATED_RESPONSE  0xEB
 #define SPDM_END_SESSION                    0xEC
+///
+/// SPDM request code (1.2)
+///
+#define SPDM_CHUNK_SEND                     0x85
+#define SPDM_CHUNK_GET                      0x86
 
 ///
 /// SPDM message header
@@ -134,6 +144,13 @@ typedef struct {
   UINT32               Flags;
 } SPDM_CAPABILITIES_RESPONSE;
 
+///
+/// SPDM response time (1.1), in microseconds.
+/// ST1 applies to a request without cryptographic processing.
+/// CT (2^CTExponent) and WT (2^RDTExponent) are reported by the responder.
+///
+#define SPDM_ST1_VALUE_US  100000
+
 ///
 /// SPDM GET_CAPABILITIES request Flags (1.1)
 ///
@@ -150,6 +167,10 @@ typedef struct {
 #define SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_UPD_CAP                     BIT14
 #define SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP      BIT15
 #define SPDM_GET_CAPABILITIES_REQUEST_FLAGS_PUB_KEY_ID_CAP                  BIT16
+///
+/// SPDM GET_CAPABILITIES request Flags (1.2)
+///
+#define SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CHUNK_CAP                       BIT17
 
 ///
 /// SPDM GET_CAPABILITIES response Flags (1.0)
@@ -176,6 +197,10 @@ typedef struct {
 #define SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_UPD_CAP                     BIT14
 #define SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP      BIT15
 #define SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PUB_KEY_ID_CAP                  BIT16
+///
+/// SPDM GET_CAPABILITIES response Flags (1.2)
+///
+#define SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHUNK_CAP                       BIT17
 
 ///
 /// SPDM NEGOTIATE_ALGORITHMS request
@@ -544,6 +569,10 @@ typedef struct {
 #define SPDM_ERROR_CODE_REQUEST_IN_FLIGHT       0x08
 #define SPDM_ERROR_CODE_INVALID_RESPONSE_CODE   0x09
 #define SPDM_ERROR_CODE_SESSION_LIMIT_EXCEEDED  0x0A
+///
+/// SPDM error code (1.2)
+///
+#define SPDM_ERROR_CODE_LARGE_RESPONSE          0x0F
 
 ///
 /// SPDM ResponseNotReady extended data
@@ -562,6 +591,75 @@ typedef struct {
   SPDM_ERROR_DATA_RESPONSE_NOT_READY  ExtendErrorData;
 } SPDM_ERROR_RESPONSE_DATA_RESPONSE_NOT_READY;
 
+///
+/// SPDM LargeResponse extended data (1.2)
+///
+typedef struct {
+  UINT8                Handle;
+} SPDM_ERROR_DATA_LARGE_RESPONSE;
+
+typedef struct {
+  SPDM_MESSAGE_HEADER  Header;
+  // Param1 == Error Code
+  // Param2 == RSVD
+  SPDM_ERROR_DATA_LARGE_RESPONSE  ExtendErrorData;
+} SPDM_ERROR_RESPONSE_DATA_LARGE_RESPONSE;
+
+///
+/// SPDM CHUNK_SEND request (1.2)
+///
+typedef struct {
+  SPDM_MESSAGE_HEADER  Header;
+  // Param1 == Request Attributes
+  // Param2 == Handle
+  UINT16               ChunkSeqNo;
+  UINT16               Reserved;
+  UINT32               ChunkSize;
+//UINT32               LargeMessageSize; // ChunkSeqNo == 0 only
+//UINT8                SpdmChunk[ChunkSize];
+} SPDM_CHUNK_SEND_REQUEST;
+
+#define SPDM_CHUNK_SEND_REQUEST_ATTRIBUTE_LAST_CHUNK  BIT0
+
+///
+/// SPDM CHUNK_SEND_ACK response (1.2)
+///
+typedef struct {
+  SPDM_MESSAGE_HEADER  Header;
+  // Param1 == Response Attributes
+  // Param2 == Handle
+  UINT16               ChunkSeqNo;
+//UINT8                ResponseToLargeRequest[]; // Last chunk or early error only
+} SPDM_CHUNK_SEND_ACK_RESPONSE;
+
+#define SPDM_CHUNK_SEND_ACK_RESPONSE_ATTRIBUTE_EARLY_ERROR_DETECTED  BIT0
+
+///
+/// SPDM CHUNK_GET request (1.2)
+///
+typedef struct {
+  SPDM_MESSAGE_HEADER  Header;
+  // Param1 == RSVD
+  // Param2 == Handle
+  UINT16               ChunkSeqNo;
+} SPDM_CHUNK_GET_REQUEST;
+
+///
+/// SPDM CHUNK_RESPONSE response (1.2)
+///
+typedef struct {
+  SPDM_MESSAGE_HEADER  Header;
+  // Param1 == Response Attributes
+  // Param2 == Handle
+  UINT16               ChunkSeqNo;
+  UINT16               Reserved;
+  UINT32               ChunkSize;
+//UINT32               LargeMessageSize; // ChunkSeqNo == 0 only
+//UINT8                SpdmChunk[ChunkSize];
+} SPDM_CHUNK_RESPONSE_RESPONSE;
+
+#define SPDM_CHUNK_RESPONSE_ATTRIBUTE_LAST_CHUNK  BIT0
+
 ///
 /// SPDM RESPONSE_IF_READY request
 ///
@@ -0,0 +1,37 @@
+/** @file
+  Definitions of the SPDM over storage binding, with the Security Send and Security Receive commands
+  of NVMe, and the SECURITY PROTOCOL OUT and SECURITY PROTOCOL IN commands of SCSI.
+
+  Each SPDM or secured SPDM message is the data of one command.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __STORAGE_BINDING_H__
+#define __STORAGE_BINDING_H__
+
+#pragma pack(1)
+
+//
+// Storage transport header
+// It is not transferred. It holds the parameters of the command whose data follows it.
+//
+typedef struct {
+  UINT8    SecurityProtocol;
+  UINT8    Reserved;
+  UINT16   SecurityProtocolSpecific;
+  // Length of the data of the command in bytes, excluding the header.
+  UINT32   Length;
+//UINT8    Data[Length];
+} STORAGE_SECURITY_HEADER;
+
+#define STORAGE_SECURITY_PROTOCOL_SPDM                    0xE8
+
+#define STORAGE_SECURITY_PROTOCOL_SPECIFIC_SPDM           0x0001
+#define STORAGE_SECURITY_PROTOCOL_SPECIFIC_SECURED_SPDM   0x0002
+
+#pragma pack()
+
+#endif
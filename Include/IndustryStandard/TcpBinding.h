@@ -0,0 +1,37 @@
+/** @file
+  Definitions of the SPDM over TCP binding.
+
+  Each SPDM or secured SPDM message is sent as one record on the TCP byte stream.
+  A record is a TCP_RECORD_HEADER followed by Length bytes of payload.
+  Several SPDM connections may share one TCP connection, each record carrying the ConnectionId of its SPDM connection.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __TCP_BINDING_H__
+#define __TCP_BINDING_H__
+
+#pragma pack(1)
+
+//
+// TCP record header
+//
+typedef struct {
+  // Length of the payload in bytes, excluding the header.
+  UINT32   Length;
+  UINT16   ConnectionId;
+  UINT8    MessageType;
+  UINT8    Reserved;
+//UINT8    Payload[Length];
+} TCP_RECORD_HEADER;
+
+#define TCP_MESSAGE_TYPE_SPDM                      0x01
+#define TCP_MESSAGE_TYPE_SECURED_SPDM              0x02
+
+#define TCP_MAX_RECORD_PAYLOAD_SIZE                0x00100000
+
+#pragma pack()
+
+#endif
@@ -0,0 +1,215 @@
+/** @file
+  SPDM appraisal library.
+  It appraises the measurement record returned by SpdmGetMeasurement against reference manifests.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __SPDM_APPRAISAL_LIB_H__
+#define __SPDM_APPRAISAL_LIB_H__
+
+#include <Library/SpdmCommonLib.h>
+
+//
+// A reference manifest is identified by a non-zero ManifestId, such as a firmware version.
+// SPDM_APPRAISAL_ANY_MANIFEST appraises a measurement record against all the reference manifests.
+//
+#define SPDM_APPRAISAL_ANY_MANIFEST  0
+
+typedef enum {
+  //
+  // The measurement value is a reference value of the measurement index.
+  //
+  SpdmAppraisalMatch,
+  //
+  // The measurement index has reference values, and the measurement value is none of them.
+  //
+  SpdmAppraisalMismatch,
+  //
+  // The measurement index has no reference value.
+  //
+  SpdmAppraisalNoReference,
+  //
+  // The measurement block is not a DMTF measurement, or its value is larger than MAX_HASH_SIZE.
+  //
+  SpdmAppraisalNotAppraisable,
+} SPDM_APPRAISAL_STATUS;
+
+typedef struct {
+  UINT8                Index;
+  UINT8                DMTFSpecMeasurementValueType;
+  UINT8                Status; // SPDM_APPRAISAL_STATUS
+  UINT8                Reserved;
+  //
+  // The reference manifest of the matched reference value, SPDM_APPRAISAL_ANY_MANIFEST if it is not matched.
+  //
+  UINT32               ManifestId;
+} SPDM_APPRAISAL_RESULT;
+
+/**
+  Return the size in bytes of a reference database.
+
+  @param  MaxReferenceCount            The maximum number of reference values in the database.
+
+  @return the size in bytes of the reference database.
+**/
+UINTN
+EFIAPI
+SpdmAppraisalGetDatabaseSize (
+  IN     UINT32                    MaxReferenceCount
+  );
+
+/**
+  Initialize an empty reference database.
+
+  The reference values are indexed by a hash of (measurement index, DMTFSpecMeasurementValueType, digest),
+  so that the appraisal of a measurement block does not depend on the number of reference manifests.
+
+  @param  Database                     A pointer to the reference database.
+  @param  DatabaseSize                 Size in bytes of the reference database.
+  @param  MaxReferenceCount            The maximum number of reference values in the database.
+
+  @retval RETURN_SUCCESS               The reference database is initialized.
+  @retval RETURN_INVALID_PARAMETER     MaxReferenceCount is 0.
+  @retval RETURN_BUFFER_TOO_SMALL      DatabaseSize is smaller than SpdmAppraisalGetDatabaseSize (MaxReferenceCount).
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraisalInitDatabase (
+  IN     VOID                      *Database,
+  IN     UINTN                     DatabaseSize,
+  IN     UINT32                    MaxReferenceCount
+  );
+
+/**
+  Add a reference value to a reference manifest in a reference database.
+
+  Adding a reference value that the reference manifest already has does nothing.
+
+  @param  Database                     A pointer to the reference database.
+  @param  ManifestId                   The reference manifest.
+  @param  Index                        The measurement index.
+  @param  ValueType                    The DMTFSpecMeasurementValueType.
+  @param  Digest                       The measurement value.
+  @param  DigestSize                   Size in bytes of the measurement value.
+
+  @retval RETURN_SUCCESS               The reference value is added.
+  @retval RETURN_INVALID_PARAMETER     ManifestId is SPDM_APPRAISAL_ANY_MANIFEST, or DigestSize is 0 or larger than MAX_HASH_SIZE.
+  @retval RETURN_OUT_OF_RESOURCES      The reference database is full.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraisalAddReference (
+  IN     VOID                      *Database,
+  IN     UINT32                    ManifestId,
+  IN     UINT8                     Index,
+  IN     UINT8                     ValueType,
+  IN     CONST VOID                *Digest,
+  IN     UINTN                     DigestSize
+  );
+
+/**
+  Remove a reference value from a reference manifest in a reference database.
+
+  @param  Database                     A pointer to the reference database.
+  @param  ManifestId                   The reference manifest.
+  @param  Index                        The measurement index.
+  @param  ValueType                    The DMTFSpecMeasurementValueType.
+  @param  Digest                       The measurement value.
+  @param  DigestSize                   Size in bytes of the measurement value.
+
+  @retval RETURN_SUCCESS               The reference value is removed.
+  @retval RETURN_NOT_FOUND             The reference manifest has not the reference value.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraisalRemoveReference (
+  IN     VOID                      *Database,
+  IN     UINT32                    ManifestId,
+  IN     UINT8                     Index,
+  IN     UINT8                     ValueType,
+  IN     CONST VOID                *Digest,
+  IN     UINTN                     DigestSize
+  );
+
+/**
+  Load a reference manifest to a reference database.
+
+  The reference manifest is a measurement record, such as the one returned by SpdmGetMeasurement for a known good device.
+  The measurement blocks that are not appraisable are skipped.
+  The reference values are added to those the reference manifest already has, so a reference manifest is updated
+  by SpdmAppraisalRemoveManifest then SpdmAppraisalLoadManifest, without rebuilding the reference database.
+  Nothing is loaded if the reference database has not enough free reference values for all the measurement blocks.
+
+  @param  Database                     A pointer to the reference database.
+  @param  ManifestId                   The reference manifest.
+  @param  MeasurementRecordLength      Size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to the measurement record.
+
+  @retval RETURN_SUCCESS               The reference manifest is loaded.
+  @retval RETURN_INVALID_PARAMETER     ManifestId is SPDM_APPRAISAL_ANY_MANIFEST.
+  @retval RETURN_UNSUPPORTED           The measurement record is malformed.
+  @retval RETURN_OUT_OF_RESOURCES      The reference database is full.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraisalLoadManifest (
+  IN     VOID                      *Database,
+  IN     UINT32                    ManifestId,
+  IN     UINTN                     MeasurementRecordLength,
+  IN     CONST VOID                *MeasurementRecord
+  );
+
+/**
+  Remove all the reference values of a reference manifest from a reference database.
+
+  @param  Database                     A pointer to the reference database.
+  @param  ManifestId                   The reference manifest.
+
+  @retval RETURN_SUCCESS               The reference manifest is removed.
+  @retval RETURN_NOT_FOUND             The reference database has no reference value of the reference manifest.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraisalRemoveManifest (
+  IN     VOID                      *Database,
+  IN     UINT32                    ManifestId
+  );
+
+/**
+  Appraise a measurement record returned by SpdmGetMeasurement against a reference database, in one pass.
+
+  With SPDM_APPRAISAL_ANY_MANIFEST, a measurement value matches if it is a reference value of any reference manifest.
+  Otherwise, it matches only if it is a reference value of the reference manifest ManifestId.
+  A measurement index has reference values if any reference manifest has reference values for it.
+
+  @param  Database                     A pointer to the reference database.
+  @param  ManifestId                   The reference manifest, or SPDM_APPRAISAL_ANY_MANIFEST.
+  @param  NumberOfBlocks               The number of measurement blocks in the measurement record.
+  @param  MeasurementRecordLength      Size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to the measurement record.
+  @param  ResultCount                  On input, the number of entries of Results.
+                                       On output, the number of measurement blocks.
+  @param  Results                      The appraisal of each measurement block, in the order of the measurement record.
+                                       It may be NULL if ResultCount is 0 on input.
+
+  @retval RETURN_SUCCESS               No measurement value is mismatched.
+  @retval RETURN_SECURITY_VIOLATION    A measurement value is mismatched.
+  @retval RETURN_UNSUPPORTED           The measurement record is malformed, or has not NumberOfBlocks blocks.
+  @retval RETURN_BUFFER_TOO_SMALL      Results is too small. ResultCount is set to the number of measurement blocks.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraiseMeasurementRecord (
+  IN     VOID                      *Database,
+  IN     UINT32                    ManifestId,
+  IN     UINT8                     NumberOfBlocks,
+  IN     UINTN                     MeasurementRecordLength,
+  IN     CONST VOID                *MeasurementRecord,
+  IN OUT UINTN                     *ResultCount,
+     OUT SPDM_APPRAISAL_RESULT     *Results OPTIONAL
+  );
+
+#endif
@@ -90,6 +90,13 @@ typedef enum {
   SpdmDataLocalSlotCount,
   SpdmDataPeerPublicRootCertHash,
   SpdmDataPeerPublicCertChains,
+  //
+  // Provisioned public key, a DER-encoded SubjectPublicKeyInfo.
+  // It is used in place of the certificate chain for SlotID 0xFF,
+  // if no certificate chain is provisioned for the slot.
+  //
+  SpdmDataLocalPublicKey,
+  SpdmDataPeerPublicKey,
   SpdmDataBasicMutAuthRequested,
   SpdmDataMutAuthRequested,
   //
@@ -113,11 +120,58 @@ typedef enum {
   SpdmDataOpaquePskExchangeReq,
   SpdmDataOpaquePskExchangeRsp,
   //
+  // Measurement cache
+  // The number of requests a verified measurement block is reused for before it is fetched again.
+  // 0 disables the measurement cache.
+  //
+  SpdmDataMeasurementCacheMaxAge,
+  //
+  // Response timing
+  // The round trip time of the transport, in microseconds, added to the response time of each request.
+  // 0 disables the response timeouts, and each response is waited for indefinitely.
+  //
+  SpdmDataTransportRoundTripTime,
+  //
+  // Transport limits
+  // The largest SPDM message the transport carries as one message, in bytes, as UINT32.
+  // The CERTIFICATE portions are sized from it. 0 keeps them to MAX_SPDM_CERT_CHAIN_BLOCK_LEN.
+  // A larger response is retrieved in chunks by CHUNK_GET, if CHUNK_CAP is negotiated.
+  //
+  SpdmDataTransportMaxMessageSize,
+  //
+  // Transport connection
+  // The ID of the SPDM connection on a transport link shared by several SPDM connections, as UINT16.
+  // It is carried in each record by the transport layer, such as SpdmTransportTcpLib. The default is 0.
+  //
+  SpdmDataTransportConnectionId,
+  //
+  // Requester statistics (requester only), as SPDM_REQUESTER_STATS.
+  // It is supported if OPENSPDM_REQUESTER_STATS_SUPPORT is 1. Set a zeroed SPDM_REQUESTER_STATS to reset it.
+  //
+  SpdmDataRequesterStats,
+  //
+  // Responder statistics (responder only), as SPDM_RESPONDER_STATS.
+  // It is supported if OPENSPDM_RESPONDER_STATS_SUPPORT is 1. Set a zeroed SPDM_RESPONDER_STATS to reset it.
+  //
+  SpdmDataResponderStats,
+  //
+  // Crypto statistics, as SPDM_CRYPTO_STATS.
+  // It is supported if OPENSPDM_CRYPTO_STATS_SUPPORT is 1. Set a zeroed SPDM_CRYPTO_STATS to reset it.
+  //
+  SpdmDataCryptoStats,
+  //
+  // Debug output
+  // The categories of the debug hex dumps, as SPDM_DEBUG_DUMP_* in UINT32. The default is SPDM_DEBUG_DUMP_ALL.
+  // The dumps are printed at DEBUG_INFO, and no work is done for them if the level or the category is disabled.
+  //
+  SpdmDataDebugDumpMask,
+  //
   // SessionData
   //
   SpdmDataSessionUsePsk,
   SpdmDataSessionMutAuthRequested,
   SpdmDataSessionEndSessionAttributes,
+  SpdmDataSessionKeyUpdatePolicy,
 
   //
   // MAX
@@ -125,6 +179,144 @@ typedef enum {
   SpdmDataMax,
 } SPDM_DATA_TYPE;
 
+///
+/// The key update policy of a session, used by SpdmSendReceiveData.
+/// A budget of 0 is not limited.
+///
+typedef struct {
+  UINT64   MaxRecordCount;
+  UINT64   MaxByteCount;
+  BOOLEAN  UpdateAllKeys;
+} SPDM_KEY_UPDATE_POLICY;
+
+///
+/// The session lifecycle policy of a responder, set by SpdmSetResponderSessionPolicy.
+/// HeartbeatPeriod is in seconds, and the times are in 100ns units. 0 disables each of them.
+///
+typedef struct {
+  UINT8    HeartbeatPeriod;
+  UINT64   IdleTimeout;
+  UINT64   EvictIdleTime;
+  UINT32   ReservedCount;
+} SPDM_RESPONDER_SESSION_POLICY;
+
+#define SPDM_ALGORITHM_COST_COUNT  16
+
+///
+/// The algorithm cost model of the local device, set by SpdmSetAlgorithmCostModel.
+/// The costs are indexed by the bit number of the algorithm in its bitmask, such as 4 for ECDSA_ECC_NIST_P256.
+/// They are relative, such as the CryptBench time of the operations expected in a handshake and its records.
+/// A cost of 0 is unknown.
+/// MinSecurityStrength is the minimum security strength in bits of the negotiated algorithms, or 0.
+///
+typedef struct {
+  UINT16   MinSecurityStrength;
+  UINT32   BaseAsymAlgoCost[SPDM_ALGORITHM_COST_COUNT];
+  UINT32   BaseHashAlgoCost[SPDM_ALGORITHM_COST_COUNT];
+  UINT32   DHENamedGroupCost[SPDM_ALGORITHM_COST_COUNT];
+  UINT32   AEADCipherSuiteCost[SPDM_ALGORITHM_COST_COUNT];
+  UINT32   ReqBaseAsymAlgCost[SPDM_ALGORITHM_COST_COUNT];
+} SPDM_ALGORITHM_COST_MODEL;
+
+///
+/// The number of latency buckets of SPDM_REQUESTER_REQUEST_STATS.
+/// Bucket N counts the latencies from 4^N to 4^(N+1) microseconds.
+/// The first bucket also counts the shorter latencies, and the last bucket the longer ones.
+///
+#define SPDM_REQUESTER_STATS_LATENCY_BUCKET_COUNT  16
+
+///
+/// The index of an error code in the ErrorCount of SPDM_REQUESTER_REQUEST_STATS.
+/// The error codes below 0x10 are at their value, MAJOR_VERSION_MISMATCH, RESPONSE_NOT_READY and REQUEST_RESYNCH
+/// are at 0xD to 0xF, and the vendor defined and the unknown error codes are at 0.
+///
+#define SPDM_REQUESTER_STATS_ERROR_CODE_COUNT  0x10
+#define SPDM_REQUESTER_STATS_ERROR_CODE_INDEX(ErrorCode) \
+  (((ErrorCode) < 0xD) ? (ErrorCode) : \
+   (((ErrorCode) >= SPDM_ERROR_CODE_MAJOR_VERSION_MISMATCH) && ((ErrorCode) <= SPDM_ERROR_CODE_REQUEST_RESYNCH)) ? \
+   ((ErrorCode) - SPDM_ERROR_CODE_MAJOR_VERSION_MISMATCH + 0xD) : 0)
+
+///
+/// The statistics of one SPDM request code, collected by the requester.
+///
+/// The transport latency is from the request being sent to its response being received.
+/// The local latency is from the response being received to the next request being sent,
+/// when the response is decoded, verified and the next request is built.
+/// The latencies are in 100ns units, and are only collected once a time function is registered.
+///
+typedef struct {
+  UINT32   RequestCount;
+  UINT32   ResponseCount;
+  UINT64   RequestBytes;
+  UINT64   ResponseBytes;
+  //
+  // Requests sent again after ERROR(BUSY), and requests or responses failed in the transport layer.
+  //
+  UINT32   RetryCount;
+  UINT32   FailureCount;
+  //
+  // ERROR responses, by error code. See SPDM_REQUESTER_STATS_ERROR_CODE_INDEX.
+  //
+  UINT32   ErrorCount[SPDM_REQUESTER_STATS_ERROR_CODE_COUNT];
+  UINT8    LastErrorCode;
+  UINT64   TransportTime;
+  UINT64   LocalTime;
+  UINT32   TransportLatency[SPDM_REQUESTER_STATS_LATENCY_BUCKET_COUNT];
+  UINT32   LocalLatency[SPDM_REQUESTER_STATS_LATENCY_BUCKET_COUNT];
+} SPDM_REQUESTER_REQUEST_STATS;
+
+///
+/// The statistics of the requester, indexed by the SPDM request code - 0x80.
+///
+#define SPDM_REQUESTER_STATS_REQUEST_CODE_COUNT  0x80
+
+typedef struct {
+  SPDM_REQUESTER_REQUEST_STATS  Request[SPDM_REQUESTER_STATS_REQUEST_CODE_COUNT];
+} SPDM_REQUESTER_STATS;
+
+///
+/// The latency buckets and the error code index of SPDM_RESPONDER_REQUEST_STATS,
+/// the same as those of SPDM_REQUESTER_REQUEST_STATS.
+///
+#define SPDM_RESPONDER_STATS_LATENCY_BUCKET_COUNT        SPDM_REQUESTER_STATS_LATENCY_BUCKET_COUNT
+#define SPDM_RESPONDER_STATS_ERROR_CODE_COUNT            SPDM_REQUESTER_STATS_ERROR_CODE_COUNT
+#define SPDM_RESPONDER_STATS_ERROR_CODE_INDEX(ErrorCode) SPDM_REQUESTER_STATS_ERROR_CODE_INDEX(ErrorCode)
+
+///
+/// The statistics of one SPDM request code, collected by the responder.
+///
+/// The processing latency is from the request being decoded to its response being built.
+/// The crypto time is the time in the DHE, the signature verification and the session key derivation.
+/// The callback time is the time in the measurement collection and the signing, which call the device functions.
+/// The times are in 100ns units, and are only collected once a time function is registered.
+///
+typedef struct {
+  UINT32   RequestCount;
+  UINT64   RequestBytes;
+  UINT64   ResponseBytes;
+  //
+  // ERROR responses, by error code. See SPDM_RESPONDER_STATS_ERROR_CODE_INDEX.
+  // ResponseNotReadyCount is the ERROR(ResponseNotReady) responses, asking the requester to send RESPOND_IF_READY.
+  //
+  UINT32   ErrorCount[SPDM_RESPONDER_STATS_ERROR_CODE_COUNT];
+  UINT8    LastErrorCode;
+  UINT32   ResponseNotReadyCount;
+  UINT64   ProcessingTime;
+  UINT64   CryptoTime;
+  UINT64   CallbackTime;
+  UINT32   ProcessingLatency[SPDM_RESPONDER_STATS_LATENCY_BUCKET_COUNT];
+  UINT32   CallbackLatency[SPDM_RESPONDER_STATS_LATENCY_BUCKET_COUNT];
+} SPDM_RESPONDER_REQUEST_STATS;
+
+///
+/// The statistics of the responder, indexed by the SPDM request code - 0x80.
+///
+#define SPDM_RESPONDER_STATS_REQUEST_CODE_COUNT  0x80
+
+typedef struct {
+  SPDM_RESPONDER_REQUEST_STATS  Request[SPDM_RESPONDER_STATS_REQUEST_CODE_COUNT];
+} SPDM_RESPONDER_STATS;
+
 typedef enum {
   SpdmDataLocationLocal,
   SpdmDataLocationConnection,
@@ -141,6 +333,44 @@ typedef struct {
   UINT8                AdditionalData[4];
 } SPDM_DATA_PARAMETER;
 
+///
+/// The local configuration of an SPDM context, installed at once by SpdmApplyProfile.
+/// Each field is the data of the SpdmSetData DataType of the same name, at SpdmDataLocationLocal.
+/// The buffers are referenced, not copied, so the profile may be shared by many SPDM contexts.
+///
+typedef struct {
+  UINT8                SpdmVersionCount;
+  SPDM_VERSION_NUMBER  SpdmVersion[MAX_SPDM_VERSION_COUNT];
+  UINT8                SecuredMessageVersionCount;
+  SPDM_VERSION_NUMBER  SecuredMessageVersion[MAX_SPDM_VERSION_COUNT];
+  UINT32               CapabilityFlags;
+  UINT8                CapabilityCTExponent;
+  UINT8                MeasurementSpec;
+  UINT32               MeasurementHashAlgo;
+  UINT32               BaseAsymAlgo;
+  UINT32               BaseHashAlgo;
+  UINT16               DHENamedGroup;
+  UINT16               AEADCipherSuite;
+  UINT16               ReqBaseAsymAlg;
+  UINT16               KeySchedule;
+  UINT8                LocalSlotCount;
+  VOID                 *LocalPublicCertChain[MAX_SPDM_SLOT_COUNT];
+  UINTN                LocalPublicCertChainSize[MAX_SPDM_SLOT_COUNT];
+  VOID                 *PeerPublicRootCertHash;
+  UINTN                PeerPublicRootCertHashSize;
+  VOID                 *PeerPublicCertChains;
+  UINTN                PeerPublicCertChainsSize;
+  VOID                 *PskHint;
+  UINTN                PskHintSize;
+  BOOLEAN              BasicMutAuthRequested;
+  UINT8                MutAuthRequested;
+  // The ReqSlotNum of the encapsulated requests, as AdditionalData[0] of SpdmDataMutAuthRequested.
+  UINT8                MutAuthReqSlotNum;
+  UINT32               MeasurementCacheMaxAge;
+  UINT64               TransportRoundTripTime;
+  UINT32               TransportMaxMessageSize;
+} SPDM_CONFIG_PROFILE;
+
 typedef enum {
   //
   // Before GET_VERSION/VERSION
@@ -214,7 +444,7 @@ typedef enum {
 
   @retval RETURN_SUCCESS               The SPDM context data is set successfully.
   @retval RETURN_INVALID_PARAMETER     The Data is NULL or the DataType is zero.
-  @retval RETURN_UNSUPPORTED           The DataType is unsupported.
+  @retval RETURN_UNSUPPORTED           The DataType is unsupported, or the Data is a SHA3 base hash.
   @retval RETURN_ACCESS_DENIED         The DataType cannot be set.
   @retval RETURN_NOT_READY             Data is not ready to set.
 **/
@@ -257,6 +487,29 @@ SpdmGetData (
   IN OUT UINTN                     *DataSize
   );
 
+/**
+  Set the local configuration of an SPDM context from a configuration profile.
+
+  The whole profile is validated first, with the same rules as SpdmSetData, then all its fields are installed
+  in one pass, so that the SPDM context is either fully configured or left unchanged.
+  The other local data are kept, such as the transport connection ID, the private keys
+  and the opaque data of CHALLENGE_AUTH and MEASUREMENTS.
+  To configure many SPDM contexts with the same profile, the profile may be applied to one SPDM context
+  for SpdmDeviceProfileInit, and the device profile registered to the others with SpdmRegisterDeviceProfile.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Profile                      A pointer to the configuration profile.
+
+  @retval RETURN_SUCCESS               The configuration profile is applied.
+  @retval RETURN_INVALID_PARAMETER     A field of the configuration profile is invalid.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmApplyProfile (
+  IN     VOID                      *SpdmContext,
+  IN     CONST SPDM_CONFIG_PROFILE *Profile
+  );
+
 /**
   Get the last error of an SPDM context.
 
@@ -320,6 +573,447 @@ SpdmGetContextSize (
   VOID
   );
 
+//
+// The limits of the variable-length regions of an SPDM context.
+// A field of 0 selects the default limit used by SpdmInitContext.
+//
+typedef struct {
+  //
+  // Size in bytes of the cached SPDM request, up to MAX_SPDM_MESSAGE_BUFFER_SIZE.
+  //
+  UINTN                           MaxSpdmMessageSize;
+  //
+  // Size in bytes of the inline peer certificate chain buffer, up to MAX_SPDM_CERT_CHAIN_SIZE,
+  // or SPDM_CONTEXT_CONFIG_NO_CERT_CHAIN_BUFFER for none, if SpdmRegisterPeerCertChainBuffer provides the buffer.
+  //
+  UINTN                           MaxCertChainSize;
+  //
+  // Number of session slots, up to MAX_SPDM_SESSION_SLOT_COUNT. The default is MAX_SPDM_SESSION_COUNT.
+  //
+  UINTN                           MaxSessionCount;
+  //
+  // Size in bytes of the transcript arena, up to MAX_UINT32, shared by the certificate chain messages and the session handshake messages.
+  // The default holds MAX_SPDM_MESSAGE_BUFFER_SIZE bytes for each of MessageB and MessageMutB and for each session slot.
+  // SpdmAddTranscriptArenaMemory adds more memory after the SPDM context is initialized.
+  //
+  UINTN                           TranscriptArenaSize;
+  //
+  // Size in bytes of the scratch arena, up to MAX_UINT32, of the temporary message buffers of the library functions.
+  // The default is SPDM_DEFAULT_SCRATCH_SIZE.
+  //
+  UINTN                           ScratchSize;
+  //
+  // Size in bytes of the buffer of a large response retrieved by CHUNK_GET, up to MAX_SPDM_MESSAGE_BUFFER_SIZE,
+  // or SPDM_CONTEXT_CONFIG_NO_CHUNK_BUFFER for none, if the responder does not send large responses.
+  // The default is MAX_SPDM_MESSAGE_BUFFER_SIZE.
+  //
+  UINTN                           ChunkBufferSize;
+} SPDM_CONTEXT_CONFIG;
+
+//
+// The MaxCertChainSize of an SPDM context without an inline peer certificate chain buffer.
+//
+#define SPDM_CONTEXT_CONFIG_NO_CERT_CHAIN_BUFFER  MAX_UINTN
+
+//
+// The ChunkBufferSize of an SPDM context without a large response buffer.
+//
+#define SPDM_CONTEXT_CONFIG_NO_CHUNK_BUFFER  MAX_UINTN
+
+/**
+  Initialize an SPDM context with the limits of its variable-length regions.
+
+  The size in bytes of the SpdmContext can be returned by SpdmGetContextSizeEx with the same Config.
+
+  The secured message contexts of the sessions, with their secrets, and the scratch arena are regions of the SpdmContext,
+  so that the caller places them with the SpdmContext, such as in locked memory on the NUMA node of the thread which owns it.
+  The crypto contexts of the SpdmContext are pool allocations, placed by the allocator of SetPoolAllocator of the thread.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Config                       The limits of the SPDM context, or NULL for the default limits.
+
+  @retval RETURN_SUCCESS               The SPDM context is initialized.
+  @retval RETURN_INVALID_PARAMETER     A limit in Config is out of range.
+*/
+RETURN_STATUS
+EFIAPI
+SpdmInitContextEx (
+  IN     VOID                      *SpdmContext,
+  IN     CONST SPDM_CONTEXT_CONFIG *Config OPTIONAL
+  );
+
+/**
+  Add memory to the transcript arena of an SPDM context.
+
+  The transcripts are kept in chunks of SPDM_TRANSCRIPT_CHUNK_SIZE bytes, taken from the arena as the messages
+  are appended and returned to it when the transcripts are reset, so that their size is only limited by the arena.
+  The memory must stay valid until the SPDM context is released. It is not used by a clone of the SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Buffer                       A pointer to the memory.
+  @param  BufferSize                   Size in bytes of the memory.
+
+  @retval RETURN_SUCCESS               The memory is added to the transcript arena.
+  @retval RETURN_INVALID_PARAMETER     Buffer is NULL, or the memory cannot hold a chunk.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAddTranscriptArenaMemory (
+  IN     VOID                      *SpdmContext,
+  IN     VOID                      *Buffer,
+  IN     UINTN                     BufferSize
+  );
+
+/**
+  Return the size in bytes of an SPDM context with the limits of its variable-length regions.
+
+  @param  Config                       The limits of the SPDM context, or NULL for the default limits.
+
+  @return the size in bytes of the SPDM context, or 0 if a limit in Config is out of range.
+**/
+UINTN
+EFIAPI
+SpdmGetContextSizeEx (
+  IN     CONST SPDM_CONTEXT_CONFIG *Config OPTIONAL
+  );
+
+/**
+  Register a buffer to an SPDM context to hold the peer certificate chain, instead of its inline buffer.
+
+  The certificate chain got by GET_CERTIFICATE is collected in place in the buffer, so that its size
+  is only limited by the buffer and by the transcript, not by MAX_SPDM_CERT_CHAIN_SIZE.
+  The buffer must stay valid until another buffer is registered or the SPDM context is released.
+  Registering a buffer discards the current peer certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CertChainBuffer              A pointer to the peer certificate chain buffer, or NULL to use the inline buffer.
+  @param  CertChainBufferSize          Size in bytes of the peer certificate chain buffer, up to MAX_UINT16.
+
+  @retval RETURN_SUCCESS               The buffer is registered.
+  @retval RETURN_INVALID_PARAMETER     The CertChainBufferSize is out of range.
+  @retval RETURN_NOT_READY             An operation of SpdmRequesterStep is in progress.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRegisterPeerCertChainBuffer (
+  IN     VOID                      *SpdmContext,
+  IN     VOID                      *CertChainBuffer OPTIONAL,
+  IN     UINTN                     CertChainBufferSize
+  );
+
+/**
+  Release the resources held by an SPDM context, such as the running transcript hashes,
+  the session keys and the cached peer public key.
+
+  It must be called before an initialized SPDM context is initialized again, is the Clone of SpdmCloneContext, or is discarded.
+  The resources registered by the integrator, such as the private keys and the shared caches, are not released.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+*/
+VOID
+EFIAPI
+SpdmDeinitContext (
+  IN     VOID                      *SpdmContext
+  );
+
+//
+// The policy of the secrets of the SPDM context in SpdmCloneContext.
+//
+typedef enum {
+  //
+  // The clone has no session and no private key.
+  //
+  SpdmCloneSecretsExclude,
+  //
+  // The clone has the sessions with their keys, and the private keys.
+  //
+  SpdmCloneSecretsInclude,
+  SpdmCloneSecretsMax,
+} SPDM_CLONE_SECRETS_POLICY;
+
+/**
+  Clone an SPDM context, such as a provisioned and negotiated template context, to another SPDM context.
+
+  The Clone gets the local settings, the registered functions, the connection state, the transcripts
+  and the verified peer certificate chain of the SpdmContext. The pointers into the SpdmContext are
+  moved into the Clone, and the Clone gets its own running transcript hashes and its own random stream.
+  The buffers and the resources registered by the integrator, such as the provisioned certificate chains,
+  the device IO context, the certificate chain verification cache and the DHE key pool, are shared.
+  The peer public key is parsed again by the Clone on first use,
+  and the KEY_EXCHANGE requests prepared by SpdmPrestageKeyExchange are not cloned.
+  A peer certificate chain buffer registered by SpdmRegisterPeerCertChainBuffer is shared too,
+  so the Clone must register its own buffer before it gets a peer certificate chain.
+
+  With SpdmCloneSecretsInclude, the Clone also gets the sessions with their keys and the registered private keys,
+  so that it can continue the sessions of the SpdmContext. The keys are installed again in the inline crypto engine
+  by the Clone on first use. The SpdmContext and the Clone must not both send secured messages in the same session,
+  because the sequence numbers would be reused.
+  With SpdmCloneSecretsExclude, the Clone has no session and no private key.
+
+  The Clone must be at least the size returned by SpdmGetContextSizeEx with the Config of the SpdmContext.
+  It must not be an initialized SPDM context, unless it is released by SpdmDeinitContext first.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SecretsPolicy                The policy of the secrets of the SpdmContext.
+  @param  CloneSize                    Size in bytes of the Clone buffer.
+  @param  Clone                        A pointer to the buffer of the cloned SPDM context.
+
+  @retval RETURN_SUCCESS               The SPDM context is cloned.
+  @retval RETURN_INVALID_PARAMETER     The SecretsPolicy is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The Clone buffer is too small.
+  @retval RETURN_NOT_READY             An operation of SpdmRequesterStep or an asynchronous signature is in progress.
+  @retval RETURN_OUT_OF_RESOURCES      The running transcript hashes cannot be cloned.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmCloneContext (
+  IN     VOID                      *SpdmContext,
+  IN     SPDM_CLONE_SECRETS_POLICY SecretsPolicy,
+  IN     UINTN                     CloneSize,
+     OUT VOID                      *Clone
+  );
+
+/**
+  Export the negotiated state of an SPDM connection, to be kept across a reset of the requester or the responder.
+
+  The negotiated state is the version, the capabilities and the algorithms of the peer,
+  the VCA transcript (message A), and the verified peer certificate chain with the peer digests.
+  It can only be exported if the responder supports CACHE_CAP.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsRequester                  Indicates if the SPDM context is a requester.
+  @param  NegotiatedStateSize          On input, the size in bytes of the NegotiatedState buffer.
+                                       On output, the size in bytes of the exported negotiated state.
+  @param  NegotiatedState              A pointer to the buffer to export the negotiated state to.
+
+  @retval RETURN_SUCCESS               The negotiated state is exported.
+  @retval RETURN_NOT_STARTED           The connection is not negotiated.
+  @retval RETURN_UNSUPPORTED           The responder does not support CACHE_CAP.
+  @retval RETURN_BUFFER_TOO_SMALL      The NegotiatedState buffer is too small. NegotiatedStateSize is set to the required size.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmExportNegotiatedState (
+  IN     VOID                      *SpdmContext,
+  IN     BOOLEAN                   IsRequester,
+  IN OUT UINTN                     *NegotiatedStateSize,
+     OUT VOID                      *NegotiatedState
+  );
+
+/**
+  Import the negotiated state exported by SpdmExportNegotiatedState to an SPDM context.
+
+  The connection state is restored to negotiated, so that GET_VERSION, GET_CAPABILITIES and NEGOTIATE_ALGORITHMS are skipped.
+  The next SpdmInitConnection of a requester returns without sending them.
+  If a peer certificate chain is imported, it is verified again with the local provision,
+  so that GET_DIGESTS and GET_CERTIFICATE can be skipped. The peer is authenticated again by CHALLENGE or KEY_EXCHANGE.
+
+  This function must be called after the local settings are set, and before any SPDM communication.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  NegotiatedStateSize          Size in bytes of the negotiated state.
+  @param  NegotiatedState              A pointer to the negotiated state.
+
+  @retval RETURN_SUCCESS               The negotiated state is imported.
+  @retval RETURN_UNSUPPORTED           The negotiated state is malformed, or exported by another version of the library.
+  @retval RETURN_OUT_OF_RESOURCES      The negotiated state does not fit in the SPDM context.
+  @retval RETURN_SECURITY_VIOLATION    The imported peer certificate chain cannot be verified.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmImportNegotiatedState (
+  IN     VOID                      *SpdmContext,
+  IN     UINTN                     NegotiatedStateSize,
+  IN     VOID                      *NegotiatedState
+  );
+
+//
+// The size in bytes of the wrapping key of SpdmExportSession and SpdmImportSession.
+//
+#define SPDM_SESSION_WRAPPING_KEY_SIZE  32
+
+/**
+  Export an established session, to be imported by SpdmImportSession in another SPDM context,
+  such as the SPDM context of a live migrated virtual machine.
+
+  The exported session has the version, the capabilities and the algorithms of the connection, message A,
+  the session attributes, and the secrets, the keys and the sequence numbers of the session.
+  It is encrypted and authenticated with AES-256-GCM and the wrapping key of the caller.
+
+  No message of the session may be in flight, and no KEY_UPDATE may be in progress. The session must not be used
+  by the SpdmContext after it is exported, because the sequence numbers would be reused. It may be freed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+  @param  WrappingKey                  A pointer to the wrapping key.
+  @param  WrappingKeySize              The size in bytes of the wrapping key. It must be SPDM_SESSION_WRAPPING_KEY_SIZE.
+  @param  SessionStateSize             On input, the size in bytes of the SessionState buffer.
+                                       On output, the size in bytes of the exported session.
+  @param  SessionState                 A pointer to the buffer to export the session to.
+
+  @retval RETURN_SUCCESS               The session is exported.
+  @retval RETURN_INVALID_PARAMETER     The wrapping key size is not SPDM_SESSION_WRAPPING_KEY_SIZE.
+  @retval RETURN_NOT_FOUND             The session is not found.
+  @retval RETURN_NOT_READY             The session is not established.
+  @retval RETURN_BUFFER_TOO_SMALL      The SessionState buffer is too small. SessionStateSize is set to the required size.
+  @retval RETURN_OUT_OF_RESOURCES      The session does not fit in the scratch buffer of the SPDM context.
+  @retval RETURN_DEVICE_ERROR          The session cannot be encrypted.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmExportSession (
+  IN     VOID                      *SpdmContext,
+  IN     UINT32                    SessionId,
+  IN     CONST UINT8               *WrappingKey,
+  IN     UINTN                     WrappingKeySize,
+  IN OUT UINTN                     *SessionStateSize,
+     OUT VOID                      *SessionState
+  );
+
+/**
+  Import a session exported by SpdmExportSession to an SPDM context, so that the secured messages of the session
+  continue without KEY_EXCHANGE or PSK_EXCHANGE.
+
+  If the connection of the SPDM context is not negotiated, it is restored from the exported session as negotiated,
+  without the peer certificate chain. Otherwise the connection must have the algorithms of the exported session,
+  and several sessions of one connection can be imported. If the import fails, the connection is left as it was.
+
+  The records of the session decoded before the export are not accepted after the import, if the replay window
+  of the secured messages is enabled.
+
+  This function must be called after the local settings are set.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  WrappingKey                  A pointer to the wrapping key of the export.
+  @param  WrappingKeySize              The size in bytes of the wrapping key. It must be SPDM_SESSION_WRAPPING_KEY_SIZE.
+  @param  ImportTime                   The time of the import, from the requester or responder time function, or 0.
+                                       The heartbeat and the idle time of the session are counted from it.
+  @param  SessionStateSize             Size in bytes of the exported session.
+  @param  SessionState                 A pointer to the exported session.
+
+  @retval RETURN_SUCCESS               The session is imported.
+  @retval RETURN_INVALID_PARAMETER     The wrapping key size is not SPDM_SESSION_WRAPPING_KEY_SIZE.
+  @retval RETURN_UNSUPPORTED           The exported session is malformed, exported by another version of the library,
+                                       or its algorithms are not the ones of the negotiated connection.
+  @retval RETURN_SECURITY_VIOLATION    The exported session cannot be authenticated with the wrapping key.
+  @retval RETURN_ALREADY_STARTED       The SPDM context already has a session with the session ID.
+  @retval RETURN_OUT_OF_RESOURCES      The exported session does not fit in the SPDM context.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmImportSession (
+  IN     VOID                      *SpdmContext,
+  IN     CONST UINT8               *WrappingKey,
+  IN     UINTN                     WrappingKeySize,
+  IN     UINT64                    ImportTime,
+  IN     UINTN                     SessionStateSize,
+  IN     VOID                      *SessionState
+  );
+
+#define SPDM_EVIDENCE_SIGNATURE  SIGNATURE_32('S', 'P', 'E', 'V')
+#define SPDM_EVIDENCE_VERSION    1
+
+//
+// The signed transcripts of an evidence.
+//
+#define SPDM_EVIDENCE_TYPE_CHALLENGE_AUTH  0
+#define SPDM_EVIDENCE_TYPE_MEASUREMENTS    1
+#define SPDM_EVIDENCE_TYPE_COUNT           2
+
+#pragma pack(1)
+
+///
+/// The evidence exported by SpdmExportEvidence.
+/// The digest of the peer certificate chain with BaseHashAlgo, the peer certificate chain
+/// including the SPDM_CERT_CHAIN header, and EntryCount entries follow the header.
+///
+typedef struct {
+  UINT32               Signature;
+  UINT32               Version;
+  UINT8                MeasurementSpec;
+  UINT8                Reserved;
+  UINT16               EntryCount;
+  UINT32               BaseHashAlgo;
+  UINT32               BaseAsymAlgo;
+  UINT32               MeasurementHashAlgo;
+  UINT32               PeerCertChainSize;
+//UINT8                PeerCertChainHash[HashSize];
+//UINT8                PeerCertChain[PeerCertChainSize];
+//SPDM_EVIDENCE_ENTRY  Entry[EntryCount];
+} SPDM_EVIDENCE_HEADER;
+
+///
+/// A signed transcript of an evidence: M2 for SPDM_EVIDENCE_TYPE_CHALLENGE_AUTH, L2 for SPDM_EVIDENCE_TYPE_MEASUREMENTS.
+/// The transcript ends with the signed response without its signature, which starts at ResponseOffset.
+/// The transcript and the signature follow the entry.
+///
+typedef struct {
+  UINT8                Type;
+  UINT8                Reserved[3];
+  UINT32               TranscriptSize;
+  UINT32               ResponseOffset;
+  UINT32               SignatureSize;
+//UINT8                Transcript[TranscriptSize];
+//UINT8                Signature[SignatureSize];
+} SPDM_EVIDENCE_ENTRY;
+
+#pragma pack()
+
+/**
+  Export the evidence of the peer of a requester, to be verified by SpdmVerifyEvidence without any SPDM message.
+
+  The evidence is the negotiated algorithms, the peer certificate chain with its digest, and the signed transcripts
+  of the last CHALLENGE_AUTH and the last signed MEASUREMENTS whose signatures are verified by the requester
+  with this certificate chain. A signed MEASUREMENTS verified by SpdmGetMeasurementsPipelined is not kept.
+  It requires OPENSPDM_EVIDENCE_SUPPORT.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  EvidenceSize                 On input, the size in bytes of the Evidence buffer.
+                                       On output, the size in bytes of the exported evidence.
+  @param  Evidence                     A pointer to the buffer to export the evidence to.
+
+  @retval RETURN_SUCCESS               The evidence is exported.
+  @retval RETURN_NOT_STARTED           The peer certificate chain is not retrieved.
+  @retval RETURN_NOT_FOUND             No signed transcript is verified with the peer certificate chain.
+  @retval RETURN_BUFFER_TOO_SMALL      The Evidence buffer is too small. EvidenceSize is set to the required size.
+  @retval RETURN_UNSUPPORTED           OPENSPDM_EVIDENCE_SUPPORT is 0.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmExportEvidence (
+  IN     VOID                      *SpdmContext,
+  IN OUT UINTN                     *EvidenceSize,
+     OUT VOID                      *Evidence
+  );
+
+/**
+  Verify an evidence exported by SpdmExportEvidence, without any SPDM message.
+
+  The peer certificate chain is verified, and its root certificate must have the digest RootCertHash.
+  Each signed transcript is verified with the public key of the leaf certificate.
+  The CertChainHash of a CHALLENGE_AUTH must be the digest of the peer certificate chain.
+  The measurement blocks are read from the MEASUREMENTS at the ResponseOffset of its entry once it is verified.
+
+  @param  EvidenceSize                 Size in bytes of the evidence.
+  @param  Evidence                     A pointer to the evidence.
+  @param  RootCertHash                 The digest of the trusted root certificate, with the BaseHashAlgo of the evidence.
+  @param  RootCertHashSize             Size in bytes of the digest of the trusted root certificate.
+
+  @retval RETURN_SUCCESS               The evidence is verified.
+  @retval RETURN_INVALID_PARAMETER     RootCertHash is NULL.
+  @retval RETURN_UNSUPPORTED           The evidence is malformed, exported by another version of the library,
+                                       or uses an algorithm that is not supported.
+  @retval RETURN_SECURITY_VIOLATION    The certificate chain or a signature cannot be verified.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmVerifyEvidence (
+  IN     UINTN                     EvidenceSize,
+  IN     VOID                      *Evidence,
+  IN     VOID                      *RootCertHash,
+  IN     UINTN                     RootCertHashSize
+  );
+
 /**
   Send an SPDM transport layer message to a device.
 
@@ -412,42 +1106,354 @@ SpdmRegisterDeviceIoFunc (
   IN     SPDM_DEVICE_RECEIVE_MESSAGE_FUNC  ReceiveMessage
   );
 
-/**
-  Encode an SPDM or APP message to a transport layer message.
+//
+// A segment of an SPDM transport layer message, for the vectored device input/output functions.
+//
+typedef struct {
+  VOID                 *Base;
+  UINTN                Length;
+} SPDM_IO_VECTOR;
 
-  For normal SPDM message, it adds the transport layer wrapper.
-  For secured SPDM message, it encrypts a secured message then adds the transport layer wrapper.
-  For secured APP message, it encrypts a secured message then adds the transport layer wrapper.
+/**
+  Send an SPDM transport layer message gathered from a list of segments to a device.
 
-  The APP message is encoded to a secured message directly in SPDM session.
-  The APP message format is defined by the transport layer.
-  Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
+  The message is the concatenation of the segments, in the order of the list.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
-                                       If SessionId is NULL, it is a normal message.
-                                       If SessionId is NOT NULL, it is a secured message.
-  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
-  @param  IsRequester                  Indicates if it is a requester message.
-  @param  MessageSize                  Size in bytes of the message data buffer.
-  @param  Message                      A pointer to a source buffer to store the message.
-  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
-  @param  TransportMessage             A pointer to a destination buffer to store the transport message.
+  @param  VectorCount                  The number of segments.
+  @param  Vector                       A pointer to the list of segments.
+  @param  Timeout                      The timeout, in 100ns units, to use for the execution
+                                       of the message. A Timeout value of 0
+                                       means that this function will wait indefinitely for the
+                                       message to execute. If Timeout is greater
+                                       than zero, then this function will return RETURN_TIMEOUT if the
+                                       time required to execute the message is greater
+                                       than Timeout.
 
-  @retval RETURN_SUCCESS               The message is encoded successfully.
-  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+  @retval RETURN_SUCCESS               The SPDM message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is sent to the device.
+  @retval RETURN_INVALID_PARAMETER     The Vector is NULL or the VectorCount is zero.
+  @retval RETURN_TIMEOUT               A timeout occurred while waiting for the SPDM message
+                                       to execute.
 **/
 typedef
 RETURN_STATUS
-(EFIAPI *SPDM_TRANSPORT_ENCODE_MESSAGE_FUNC) (
-  IN     VOID                 *SpdmContext,
-  IN     UINT32               *SessionId,
-  IN     BOOLEAN              IsAppMessage,
-  IN     BOOLEAN              IsRequester,
-  IN     UINTN                SpdmMessageSize,
-  IN     VOID                 *SpdmMessage,
-  IN OUT UINTN                *TransportMessageSize,
-     OUT VOID                 *TransportMessage
+(EFIAPI *SPDM_DEVICE_SEND_MESSAGE_VECTOR_FUNC) (
+  IN     VOID                                   *SpdmContext,
+  IN     UINTN                                  VectorCount,
+  IN     SPDM_IO_VECTOR                         *Vector,
+  IN     UINT64                                 Timeout
+  );
+
+/**
+  Receive an SPDM transport layer message from a device, scattered to a list of segments.
+
+  The message fills the segments in the order of the list.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  VectorCount                  The number of segments.
+  @param  Vector                       A pointer to the list of segments.
+  @param  MessageSize                  Size in bytes of the message received.
+  @param  Timeout                      The timeout, in 100ns units, to use for the execution
+                                       of the message. A Timeout value of 0
+                                       means that this function will wait indefinitely for the
+                                       message to execute. If Timeout is greater
+                                       than zero, then this function will return RETURN_TIMEOUT if the
+                                       time required to execute the message is greater
+                                       than Timeout.
+
+  @retval RETURN_SUCCESS               The SPDM message is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is received from the device.
+  @retval RETURN_INVALID_PARAMETER     The Vector is NULL, MessageSize is NULL or the VectorCount is zero.
+  @retval RETURN_TIMEOUT               A timeout occurred while waiting for the SPDM message
+                                       to execute.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_DEVICE_RECEIVE_MESSAGE_VECTOR_FUNC) (
+  IN     VOID                                   *SpdmContext,
+  IN     UINTN                                  VectorCount,
+  IN OUT SPDM_IO_VECTOR                         *Vector,
+     OUT UINTN                                  *MessageSize,
+  IN     UINT64                                 Timeout
+  );
+
+/**
+  Register SPDM device vectored input/output functions.
+
+  A registered vectored function is used instead of the function registered by SpdmRegisterDeviceIoFunc,
+  so that the device writes the segments of a message with writev, a DMA descriptor ring or a mailbox
+  directly, without gathering them to one buffer first.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SendMessageVector            The fuction to send an SPDM transport layer message from segments, or NULL.
+  @param  ReceiveMessageVector         The fuction to receive an SPDM transport layer message to segments, or NULL.
+**/
+VOID
+EFIAPI
+SpdmRegisterDeviceIoVectorFunc (
+  IN     VOID                                     *SpdmContext,
+  IN     SPDM_DEVICE_SEND_MESSAGE_VECTOR_FUNC     SendMessageVector OPTIONAL,
+  IN     SPDM_DEVICE_RECEIVE_MESSAGE_VECTOR_FUNC  ReceiveMessageVector OPTIONAL
+  );
+
+/**
+  Register the context of the SPDM device input/output functions.
+
+  The device input/output functions get it with SpdmGetDeviceIoContext,
+  for example to find the mailbox of the device of the SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  DeviceIoContext              The context of the device input/output functions.
+**/
+VOID
+EFIAPI
+SpdmRegisterDeviceIoContext (
+  IN     VOID                              *SpdmContext,
+  IN     VOID                              *DeviceIoContext
+  );
+
+/**
+  Return the context of the SPDM device input/output functions.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the context registered by SpdmRegisterDeviceIoContext, or NULL.
+**/
+VOID *
+EFIAPI
+SpdmGetDeviceIoContext (
+  IN     VOID                              *SpdmContext
+  );
+
+/**
+  Return the context of the device input/output function of the transport path a message is sent or received over.
+
+  A device send or receive function that may be registered to several transport paths calls it to find its device.
+  The path of a send and the path of a receive are kept apart, so that a send and a receive over
+  different paths may run on different threads.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsSend                       TRUE in a device send function, FALSE in a device receive function.
+
+  @return the DeviceIoContext of the transport path, or the context registered by SpdmRegisterDeviceIoContext for path 0.
+**/
+VOID *
+EFIAPI
+SpdmGetTransportPathDeviceIoContext (
+  IN     VOID                              *SpdmContext,
+  IN     BOOLEAN                           IsSend
+  );
+
+/**
+  Wait for a period of time.
+
+  It is used by the requester to wait before it retries a request
+  answered with ERROR(BUSY) or ERROR(RESPONSE_NOT_READY).
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Duration                     The time to wait, in 100ns units.
+**/
+typedef
+VOID
+(EFIAPI *SPDM_DEVICE_STALL_FUNC) (
+  IN     VOID                                   *SpdmContext,
+  IN     UINT64                                 Duration
+  );
+
+/**
+  Register an SPDM device stall function.
+
+  The stall function is optional. Without it, a retry is sent without waiting.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Stall                        The fuction to wait for a period of time.
+**/
+VOID
+EFIAPI
+SpdmRegisterDeviceStallFunc (
+  IN     VOID                              *SpdmContext,
+  IN     SPDM_DEVICE_STALL_FUNC            Stall
+  );
+
+//
+// A transport layer message seen by the capture function.
+// Message points to the buffer of the device input/output function, and is valid only during the call.
+// CapturedSize is OriginalSize, or the size cap of SpdmRegisterCaptureFunc if the message is larger.
+//
+typedef struct {
+  UINT64               Timestamp;
+  BOOLEAN              IsSend;
+  UINTN                OriginalSize;
+  UINTN                CapturedSize;
+  CONST VOID           *Message;
+} SPDM_CAPTURE_PACKET;
+
+/**
+  Capture a transport layer message sent to or received from the device.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CaptureContext               The capture context of SpdmRegisterCaptureFunc.
+  @param  Packet                       The message, without a copy.
+**/
+typedef
+VOID
+(EFIAPI *SPDM_CAPTURE_FUNC) (
+  IN     VOID                      *SpdmContext,
+  IN     VOID                      *CaptureContext,
+  IN     CONST SPDM_CAPTURE_PACKET *Packet
+  );
+
+/**
+  Return the time of the captured messages.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the time, in 100ns units.
+**/
+typedef
+UINT64
+(EFIAPI *SPDM_CAPTURE_GET_TIME_FUNC) (
+  IN     VOID                      *SpdmContext
+  );
+
+/**
+  Register the capture function, called for each transport layer message sent or received successfully.
+
+  The messages are sampled by exchange: one message in SampleInterval is captured, with the message following it,
+  which is its response or its request. A SampleInterval of 0 or 1 captures all the messages.
+  The capture function of SpdmCaptureRingSink keeps the messages in a ring for an export to SpdmDump.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CaptureFunc                  The capture function, or NULL to stop the capture.
+  @param  CaptureContext               The context passed to the capture function.
+  @param  GetTimeFunc                  The function to return the time of the messages, or NULL for a time of 0.
+  @param  SampleInterval               The sampling interval of the messages.
+  @param  MaxCaptureSize               The size cap of a captured message, or 0 for no cap.
+**/
+VOID
+EFIAPI
+SpdmRegisterCaptureFunc (
+  IN     VOID                        *SpdmContext,
+  IN     SPDM_CAPTURE_FUNC           CaptureFunc OPTIONAL,
+  IN     VOID                        *CaptureContext OPTIONAL,
+  IN     SPDM_CAPTURE_GET_TIME_FUNC  GetTimeFunc OPTIONAL,
+  IN     UINT32                      SampleInterval,
+  IN     UINTN                       MaxCaptureSize
+  );
+
+/**
+  Initialize a capture ring in a buffer, for SpdmCaptureRingSink.
+
+  The ring keeps the most recent messages: the oldest ones are overwritten once the ring is full.
+  It is not locked, so a ring is shared by the SPDM contexts of one thread only.
+
+  @param  Ring                         A pointer to the buffer of the capture ring.
+  @param  RingSize                     Size in bytes of the buffer.
+  @param  LinkType                     The pcap data link type of the transport layer, such as LINKTYPE_MCTP.
+
+  @retval RETURN_SUCCESS               The capture ring is initialized.
+  @retval RETURN_BUFFER_TOO_SMALL      RingSize is too small for a capture ring.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmCaptureRingInit (
+  OUT    VOID                      *Ring,
+  IN     UINTN                     RingSize,
+  IN     UINT16                    LinkType
+  );
+
+/**
+  The capture function appending the message to the capture ring CaptureContext, as a pcapng packet block.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CaptureContext               A pointer to the capture ring.
+  @param  Packet                       The message.
+**/
+VOID
+EFIAPI
+SpdmCaptureRingSink (
+  IN     VOID                      *SpdmContext,
+  IN     VOID                      *CaptureContext,
+  IN     CONST SPDM_CAPTURE_PACKET *Packet
+  );
+
+/**
+  Export the messages of a capture ring as a pcapng file, from the oldest one.
+
+  The timestamp resolution of the interface is 100ns, the unit of SPDM_CAPTURE_GET_TIME_FUNC.
+
+  @param  Ring                         A pointer to the capture ring.
+  @param  PcapSize                     On input, the size in bytes of the Pcap buffer.
+                                       On output, the size in bytes of the pcapng file.
+  @param  Pcap                         A pointer to the buffer to export the pcapng file to.
+  @param  DroppedCount                 The number of messages overwritten or too large for the ring since
+                                       SpdmCaptureRingInit. It may be NULL.
+
+  @retval RETURN_SUCCESS               The pcapng file is exported.
+  @retval RETURN_BUFFER_TOO_SMALL      The Pcap buffer is too small. PcapSize is set to the required size.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmCaptureRingExport (
+  IN     VOID                      *Ring,
+  IN OUT UINTN                     *PcapSize,
+     OUT VOID                      *Pcap,
+     OUT UINT64                    *DroppedCount OPTIONAL
+  );
+
+/**
+  Register the function to read the cycle counter for the crypto statistics.
+
+  The cycle function is optional. Without it, the operations and the bytes are counted, but not the cycles.
+  It takes effect if OPENSPDM_CRYPTO_STATS_SUPPORT is 1.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  GetCycle                     The fuction to read the cycle counter.
+**/
+VOID
+EFIAPI
+SpdmRegisterCryptoCycleFunc (
+  IN     VOID                              *SpdmContext,
+  IN     SPDM_CRYPTO_GET_CYCLE_FUNC        GetCycle
+  );
+
+/**
+  Encode an SPDM or APP message to a transport layer message.
+
+  For normal SPDM message, it adds the transport layer wrapper.
+  For secured SPDM message, it encrypts a secured message then adds the transport layer wrapper.
+  For secured APP message, it encrypts a secured message then adds the transport layer wrapper.
+
+  The APP message is encoded to a secured message directly in SPDM session.
+  The APP message format is defined by the transport layer.
+  Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a source buffer to store the message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a destination buffer to store the transport message.
+
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_TRANSPORT_ENCODE_MESSAGE_FUNC) (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                SpdmMessageSize,
+  IN     VOID                 *SpdmMessage,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
   );
 
 /**
@@ -506,6 +1512,692 @@ SpdmRegisterTransportLayerFunc (
   IN     SPDM_TRANSPORT_DECODE_MESSAGE_FUNC  TransportDecodeMessage
   );
 
+/**
+  Return the room that a transport layer message needs around an SPDM or APP message.
+
+  An SPDM or APP message at Headroom bytes into a buffer, followed by at least Tailroom spare bytes,
+  is encoded in place by SPDM_TRANSPORT_ENCODE_MESSAGE_FUNC with that buffer as the transport message.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  Headroom                     Size in bytes of the transport message data before the message.
+  @param  Tailroom                     Max size in bytes of the transport message data after the message.
+
+  @retval RETURN_SUCCESS               The room is returned successfully.
+  @retval RETURN_UNSUPPORTED           The message is unsupported.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_TRANSPORT_GET_MESSAGE_ROOM_FUNC) (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  );
+
+/**
+  Register the SPDM transport layer function that returns the room of a transport layer message.
+
+  With it, the requester and the responder build each message at the headroom of the transport
+  message buffer, and the transport layer encodes it in place.
+
+  This function must be called after SpdmRegisterTransportLayerFunc, and before any SPDM communication.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  TransportGetMessageRoom      The fuction to return the room of a transport layer message.
+**/
+VOID
+EFIAPI
+SpdmRegisterTransportLayerMessageRoomFunc (
+  IN     VOID                                  *SpdmContext,
+  IN     SPDM_TRANSPORT_GET_MESSAGE_ROOM_FUNC  TransportGetMessageRoom
+  );
+
+//
+// An additional transport path of an SPDM context, such as PCI DOE for a device also reached over MCTP.
+// The records of an established session whose payload is at least MinPayloadSize bytes may be sent over it.
+// TransportGetMessageRoom is optional.
+//
+typedef struct {
+  SPDM_DEVICE_SEND_MESSAGE_FUNC         SendMessage;
+  SPDM_DEVICE_RECEIVE_MESSAGE_FUNC      ReceiveMessage;
+  VOID                                  *DeviceIoContext;
+  SPDM_TRANSPORT_ENCODE_MESSAGE_FUNC    TransportEncodeMessage;
+  SPDM_TRANSPORT_DECODE_MESSAGE_FUNC    TransportDecodeMessage;
+  SPDM_TRANSPORT_GET_MESSAGE_ROOM_FUNC  TransportGetMessageRoom;
+  UINTN                                 MinPayloadSize;
+} SPDM_TRANSPORT_PATH;
+
+/**
+  Register an additional transport path to an SPDM context.
+
+  Path 0 is the one registered by SpdmRegisterDeviceIoFunc and SpdmRegisterTransportLayerFunc.
+  It carries the messages outside a session and the handshake of a session.
+  Once a session is established, the requester sends each of its records over the path with the greatest
+  MinPayloadSize that the payload reaches, and path 0 if there is none. So control messages stay on a
+  low-latency path registered as path 0, and bulk APP messages go over a high-bandwidth path.
+  The response is received over the path of the request, and the responder sends it over the path of the request,
+  see SpdmResponderDispatchMessageOnPath.
+
+  The sequence numbers of a session are shared by its paths. If records of a session may be in flight over
+  several paths at once, OPENSPDM_REPLAY_WINDOW_SIZE must be set and the transports must carry the sequence number,
+  so that the records decoded out of order are accepted.
+
+  The device input/output functions of a path get its DeviceIoContext from SpdmGetTransportPathDeviceIoContext.
+  The paths in use are per direction, so a send and a receive may run on different threads over different paths.
+
+  This function must be called after SpdmRegisterTransportLayerFunc, and before any SPDM communication.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Path                         The transport path, or NULL to remove all the additional paths.
+  @param  PathIndex                    The index of the path registered, from 1.
+
+  @retval RETURN_SUCCESS               The transport path is registered.
+  @retval RETURN_INVALID_PARAMETER     A function of the transport path is NULL.
+  @retval RETURN_OUT_OF_RESOURCES      MAX_SPDM_TRANSPORT_PATH_COUNT paths are already registered.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRegisterTransportPath (
+  IN     VOID                                  *SpdmContext,
+  IN     CONST SPDM_TRANSPORT_PATH             *Path OPTIONAL,
+     OUT UINT8                                 *PathIndex OPTIONAL
+  );
+
+/**
+  Acquire or release the lock of a certificate chain verification cache.
+
+  @param  LockContext                  The context registered with the lock functions.
+**/
+typedef
+VOID
+(EFIAPI *SPDM_CERT_CHAIN_CACHE_LOCK_FUNC) (
+  IN     VOID                                *LockContext
+  );
+
+/**
+  Return the size in bytes of a certificate chain verification cache.
+
+  @param  EntryCount                   The number of certificate chains the cache can hold.
+
+  @return the size in bytes of the certificate chain verification cache.
+**/
+UINTN
+EFIAPI
+SpdmCertChainCacheGetSize (
+  IN     UINTN                               EntryCount
+  );
+
+/**
+  Initialize a certificate chain verification cache.
+
+  The size in bytes of the cache can be returned by SpdmCertChainCacheGetSize.
+  The cache may be shared by multiple SPDM contexts. If the contexts are used concurrently,
+  AcquireLock and ReleaseLock must be provided to serialize the access to the cache.
+
+  @param  CertChainCache               A pointer to the certificate chain verification cache.
+  @param  EntryCount                   The number of certificate chains the cache can hold.
+  @param  AcquireLock                  The function to acquire the cache lock, or NULL.
+  @param  ReleaseLock                  The function to release the cache lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+**/
+VOID
+EFIAPI
+SpdmCertChainCacheInit (
+  IN     VOID                                *CertChainCache,
+  IN     UINTN                               EntryCount,
+  IN     SPDM_CERT_CHAIN_CACHE_LOCK_FUNC     AcquireLock OPTIONAL,
+  IN     SPDM_CERT_CHAIN_CACHE_LOCK_FUNC     ReleaseLock OPTIONAL,
+  IN     VOID                                *LockContext OPTIONAL
+  );
+
+/**
+  Release the resources held by a certificate chain verification cache, such as the parsed public keys.
+
+  It must be called after all SPDM contexts using the cache are reset or discarded.
+
+  @param  CertChainCache               A pointer to the certificate chain verification cache.
+**/
+VOID
+EFIAPI
+SpdmCertChainCacheDeinit (
+  IN     VOID                                *CertChainCache
+  );
+
+/**
+  Register a certificate chain verification cache to an SPDM context.
+
+  A peer certificate chain found in the cache is not verified again.
+  A peer certificate chain verified successfully is added to the cache.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CertChainCache               A pointer to the certificate chain verification cache, or NULL to stop using a cache.
+**/
+VOID
+EFIAPI
+SpdmRegisterCertChainCache (
+  IN     VOID                                *SpdmContext,
+  IN     VOID                                *CertChainCache OPTIONAL
+  );
+
+/**
+  Return the size in bytes of a shared certificate chain verification cache.
+
+  @param  EntryCount                   The number of certificate chains the shared cache can hold.
+
+  @return the size in bytes of the shared certificate chain verification cache.
+**/
+UINTN
+EFIAPI
+SpdmSharedCertChainCacheGetSize (
+  IN     UINTN                               EntryCount
+  );
+
+/**
+  Initialize a shared certificate chain verification cache.
+
+  The shared cache is meant to live in a memory segment shared by processes, and to be initialized once,
+  by the process creating the segment, before any process attaches to it.
+  It holds no pointer, so the processes may map it at different addresses.
+
+  @param  SharedCache                  A pointer to the shared certificate chain verification cache.
+  @param  SharedCacheSize              Size in bytes of the shared cache.
+  @param  EntryCount                   The number of certificate chains the shared cache can hold.
+
+  @retval RETURN_SUCCESS               The shared cache is initialized.
+  @retval RETURN_INVALID_PARAMETER     EntryCount is 0 or larger than MAX_UINT32.
+  @retval RETURN_BUFFER_TOO_SMALL      SharedCacheSize is smaller than SpdmSharedCertChainCacheGetSize (EntryCount).
+**/
+RETURN_STATUS
+EFIAPI
+SpdmSharedCertChainCacheInit (
+  IN     VOID                                *SharedCache,
+  IN     UINTN                               SharedCacheSize,
+  IN     UINTN                               EntryCount
+  );
+
+/**
+  Put a shared certificate chain verification cache behind a certificate chain verification cache.
+
+  A certificate chain missing from the cache is looked up in the shared cache without a lock, so a certificate
+  chain verified by any process attached to the shared cache is not verified again. The public key of its leaf
+  certificate is parsed from the DER-encoded SubjectPublicKeyInfo kept in the shared cache.
+  A certificate chain verified by the process is published to the shared cache. One process publishes at a time,
+  and a publication is skipped while another process publishes.
+  The certificate chain itself is not shared, so GET_CERTIFICATE is still sent for a chain only in the shared cache.
+
+  It must be called before the cache is registered to an SPDM context.
+
+  @param  CertChainCache               A pointer to the certificate chain verification cache.
+  @param  SharedCache                  A pointer to the shared certificate chain verification cache, or NULL to detach.
+
+  @retval RETURN_SUCCESS               The shared cache is attached.
+  @retval RETURN_UNSUPPORTED           The shared cache is not initialized, or is initialized by a build with other limits.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmCertChainCacheAttachShared (
+  IN     VOID                                *CertChainCache,
+  IN     VOID                                *SharedCache OPTIONAL
+  );
+
+/**
+  Return the size in bytes of a device profile.
+
+  @return the size in bytes of the device profile.
+**/
+UINTN
+EFIAPI
+SpdmDeviceProfileGetSize (
+  VOID
+  );
+
+/**
+  Initialize a device profile from the local configuration of an SPDM context.
+
+  The local configuration is set to the SPDM context with SpdmSetData, such as the capabilities, the algorithms,
+  the local certificate chains and the opaque data. The digests of the local certificate chains are precomputed
+  for each BaseHashAlgo of the local algorithms.
+  The buffers referenced by the local configuration must be kept while the profile is used.
+
+  @param  DeviceProfile                A pointer to the device profile.
+  @param  SpdmContext                  A pointer to the SPDM context holding the local configuration.
+
+  @retval RETURN_SUCCESS               The device profile is initialized.
+  @retval RETURN_UNSUPPORTED           A BaseHashAlgo of the local algorithms is not supported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmDeviceProfileInit (
+     OUT VOID                                *DeviceProfile,
+  IN     VOID                                *SpdmContext
+  );
+
+/**
+  Register a device profile to an SPDM context.
+
+  The local configuration of the SPDM context is set from the profile, and the digests of the local
+  certificate chains are taken from the profile instead of being computed for each request.
+  The profile may be shared by many SPDM contexts, one per peer. It is not modified by the contexts.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  DeviceProfile                A pointer to the device profile, or NULL to stop using a profile.
+**/
+VOID
+EFIAPI
+SpdmRegisterDeviceProfile (
+  IN     VOID                                *SpdmContext,
+  IN     CONST VOID                          *DeviceProfile OPTIONAL
+  );
+
+/**
+  Set the algorithm cost model of an SPDM context.
+
+  The local algorithms below MinSecurityStrength are neither offered by the requester nor selected by the responder,
+  and the requester rejects an ALGORITHMS selecting one of them. The responder selects the common algorithm
+  with the lowest cost in each of BaseAsymAlgo, BaseHashAlgo, DHENamedGroup, AEADCipherSuite and ReqBaseAsymAlg.
+  The algorithms with the same or an unknown cost are selected by the default priority.
+  The NEGOTIATE_ALGORITHMS request has no order, so the costs are not used by the requester.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CostModel                    The algorithm cost model, or NULL to select by the default priority.
+**/
+VOID
+EFIAPI
+SpdmSetAlgorithmCostModel (
+  IN     VOID                                *SpdmContext,
+  IN     CONST SPDM_ALGORITHM_COST_MODEL     *CostModel OPTIONAL
+  );
+
+/**
+  Register a DHE key pool to an SPDM context.
+
+  The responder takes the DHE key pair of KEY_EXCHANGE_RSP from the pool when the pool has one
+  for the negotiated DHENamedGroup, and so does the requester for SpdmPrestageKeyExchange.
+  The pool may be shared with other contexts and is refilled
+  by SpdmSecuredMessageDheKeyPoolRefill.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  DheKeyPool                   A pointer to the DHE key pool, or NULL to stop using a pool.
+**/
+VOID
+EFIAPI
+SpdmRegisterDheKeyPool (
+  IN     VOID                                *SpdmContext,
+  IN     VOID                                *DheKeyPool OPTIONAL
+  );
+
+/**
+  Register the inline crypto engine offload functions to an SPDM context.
+
+  The functions are set to the secured message context of each session that is created afterwards,
+  so that the session keys are delivered to the engine, for example a NIC or a PCIe IDE engine.
+  See SpdmSecuredMessageSetOffloadOps.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  OffloadOps                   A pointer to the offload functions, or NULL to use software only.
+  @param  OffloadContext               The context passed to the offload functions.
+**/
+VOID
+EFIAPI
+SpdmRegisterSecuredMessageOffloadOps (
+  IN     VOID                                *SpdmContext,
+  IN     CONST SPDM_SECURED_MESSAGE_OFFLOAD_OPS  *OffloadOps OPTIONAL,
+  IN     VOID                                *OffloadContext OPTIONAL
+  );
+
+/**
+  Start to sign an SPDM message data on behalf of the responder.
+
+  The function must consume Message before it returns, because the buffer is released afterwards.
+  If the signature is available at once, it is returned in Signature.
+  Otherwise SignToken identifies the pending signing to SPDM_RESPONDER_DATA_SIGN_POLL_FUNC.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  Message                      A pointer to a message to be signed (before hash).
+  @param  MessageSize                  The size in bytes of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+  @param  SignToken                    The token of the pending signing, if RETURN_NOT_READY is returned.
+
+  @retval RETURN_SUCCESS               The signature is returned in Signature.
+  @retval RETURN_NOT_READY             The signing is in progress.
+  @retval others                       The signing fails.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_RESPONDER_DATA_SIGN_ASYNC_FUNC) (
+  IN     VOID                                *SpdmContext,
+  IN     UINT32                              BaseAsymAlgo,
+  IN     UINT32                              BaseHashAlgo,
+  IN     CONST UINT8                         *Message,
+  IN     UINTN                               MessageSize,
+     OUT UINT8                               *Signature,
+  IN OUT UINTN                               *SigSize,
+     OUT UINTN                               *SignToken
+  );
+
+/**
+  Poll a pending signing started by SPDM_RESPONDER_DATA_SIGN_ASYNC_FUNC.
+
+  The token is not used again once a status other than RETURN_NOT_READY is returned.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SignToken                    The token of the pending signing.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval RETURN_SUCCESS               The signature is returned in Signature.
+  @retval RETURN_NOT_READY             The signing is still in progress.
+  @retval others                       The signing fails.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_RESPONDER_DATA_SIGN_POLL_FUNC) (
+  IN     VOID                                *SpdmContext,
+  IN     UINTN                               SignToken,
+     OUT UINT8                               *Signature,
+  IN OUT UINTN                               *SigSize
+  );
+
+/**
+  Register the asynchronous signing functions of the responder to an SPDM context.
+
+  The CHALLENGE_AUTH and KEY_EXCHANGE_RSP signatures are then generated by SignAsyncFunc
+  instead of SpdmResponderDataSignFunc. The MEASUREMENTS signature is still generated synchronously,
+  because only the hash of L1/L2 is kept. While a signing is pending, the responder answers
+  ERROR(ResponseNotReady) and completes the response when RESPOND_IF_READY finds the signing done.
+  Any other request abandons the pending signing.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SignAsyncFunc                The function to start a signing, or NULL to sign synchronously.
+  @param  SignPollFunc                 The function to poll a pending signing.
+**/
+VOID
+EFIAPI
+SpdmRegisterResponderDataSignAsyncFunc (
+  IN     VOID                                *SpdmContext,
+  IN     SPDM_RESPONDER_DATA_SIGN_ASYNC_FUNC SignAsyncFunc OPTIONAL,
+  IN     SPDM_RESPONDER_DATA_SIGN_POLL_FUNC  SignPollFunc OPTIONAL
+  );
+
+typedef enum {
+  //
+  // The DHE key pair of KEY_EXCHANGE_RSP is generated. The DHE shared secret is computed next.
+  //
+  SpdmResponderYieldPointDheKeyGenerated = 1,
+  //
+  // The DHE shared secret is computed. KEY_EXCHANGE_RSP is signed next.
+  //
+  SpdmResponderYieldPointDheSecretComputed,
+  //
+  // KEY_EXCHANGE_RSP is signed. The handshake keys are derived next.
+  //
+  SpdmResponderYieldPointSigned,
+} SPDM_RESPONDER_YIELD_POINT;
+
+/**
+  Ask the integrator whether the responder yields after an expensive step of a request.
+
+  The function is called between the cryptographic steps of KEY_EXCHANGE.
+  If it returns TRUE, the responder keeps the state of the request, answers ERROR(ResponseNotReady),
+  and continues after the step when RESPOND_IF_READY is received. A single-threaded firmware then
+  runs its other tasks between the steps, instead of being blocked for the whole KEY_EXCHANGE.
+  If it returns FALSE, the responder continues at once.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  YieldPoint                   The step just completed.
+
+  @retval TRUE                         The responder yields.
+  @retval FALSE                        The responder continues.
+**/
+typedef
+BOOLEAN
+(EFIAPI *SPDM_RESPONDER_YIELD_FUNC) (
+  IN     VOID                                *SpdmContext,
+  IN     UINT8                               RequestCode,
+  IN     SPDM_RESPONDER_YIELD_POINT          YieldPoint
+  );
+
+/**
+  Register the yield function of the responder to an SPDM context.
+
+  As with the asynchronous signing, any request other than RESPOND_IF_READY abandons a yielded request.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  YieldFunc                    The function to decide whether to yield, or NULL to never yield.
+**/
+VOID
+EFIAPI
+SpdmRegisterResponderYieldFunc (
+  IN     VOID                                *SpdmContext,
+  IN     SPDM_RESPONDER_YIELD_FUNC           YieldFunc OPTIONAL
+  );
+
+/**
+  Start to verify a signature of the responder over a message hash, for the requester.
+
+  The function must consume MessageHash and Signature before it returns, because the buffers are reused afterwards.
+  PublicKey is only read. It stays valid until the verification is completed, unless the peer certificate chain changes.
+  If the verification completes at once, its result is returned.
+  Otherwise VerifyToken identifies the pending verification to SPDM_REQUESTER_VERIFY_POLL_FUNC.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  BaseAsymAlgo                 Indicates the verification algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  PublicKey                    The public key context of the responder.
+  @param  MessageHash                  A pointer to the hash of the signed message.
+  @param  Signature                    A pointer to the signature to be verified.
+  @param  SigSize                      The size in bytes of the signature.
+  @param  VerifyToken                  The token of the pending verification, if RETURN_NOT_READY is returned.
+
+  @retval RETURN_SUCCESS               The signature is verified.
+  @retval RETURN_NOT_READY             The verification is in progress.
+  @retval RETURN_SECURITY_VIOLATION    The signature is not verified.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_REQUESTER_VERIFY_ASYNC_FUNC) (
+  IN     VOID                                *SpdmContext,
+  IN     UINT32                              BaseAsymAlgo,
+  IN     UINT32                              BaseHashAlgo,
+  IN     VOID                                *PublicKey,
+  IN     CONST UINT8                         *MessageHash,
+  IN     CONST UINT8                         *Signature,
+  IN     UINTN                               SigSize,
+     OUT UINTN                               *VerifyToken
+  );
+
+/**
+  Poll a pending verification started by SPDM_REQUESTER_VERIFY_ASYNC_FUNC.
+
+  The token is not used again once a status other than RETURN_NOT_READY is returned.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  VerifyToken                  The token of the pending verification.
+  @param  Wait                         TRUE to wait until the verification is completed.
+
+  @retval RETURN_SUCCESS               The signature is verified.
+  @retval RETURN_NOT_READY             The verification is still in progress. It is not returned if Wait is TRUE.
+  @retval RETURN_SECURITY_VIOLATION    The signature is not verified.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_REQUESTER_VERIFY_POLL_FUNC) (
+  IN     VOID                                *SpdmContext,
+  IN     UINTN                               VerifyToken,
+  IN     BOOLEAN                             Wait
+  );
+
+/**
+  Register the asynchronous signature verification functions of the requester to an SPDM context.
+
+  The CHALLENGE_AUTH and MEASUREMENTS signatures verified by SpdmStartChallenge and SpdmGetMeasurementsPipelined
+  are then verified by VerifyAsyncFunc, while the next request is sent. The other requests still verify
+  the signatures synchronously.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  VerifyAsyncFunc              The function to start a verification, or NULL to verify synchronously.
+  @param  VerifyPollFunc               The function to poll a pending verification.
+**/
+VOID
+EFIAPI
+SpdmRegisterRequesterVerifyAsyncFunc (
+  IN     VOID                                *SpdmContext,
+  IN     SPDM_REQUESTER_VERIFY_ASYNC_FUNC    VerifyAsyncFunc OPTIONAL,
+  IN     SPDM_REQUESTER_VERIFY_POLL_FUNC     VerifyPollFunc OPTIONAL
+  );
+
+/**
+  Register a loaded private key handle to an SPDM context.
+
+  The handle is returned by SpdmResponderDataLoadKeyFunc or SpdmRequesterDataLoadKeyFunc.
+  It is used for signing while AsymAlgo matches the negotiated algorithm.
+  The SPDM context does not own the handle. The caller releases it after the context is no longer used.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsRequester                  Indicates if the handle is the requester private key.
+  @param  AsymAlgo                     The BaseAsymAlgo or ReqBaseAsymAlg of the private key.
+  @param  KeyHandle                    The private key handle, or NULL to load the private key per signing.
+**/
+VOID
+EFIAPI
+SpdmRegisterLocalPrivateKey (
+  IN     VOID                                *SpdmContext,
+  IN     BOOLEAN                             IsRequester,
+  IN     UINT32                              AsymAlgo,
+  IN     VOID                                *KeyHandle OPTIONAL
+  );
+
+/**
+  Collect one measurement block of the device.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementSpecification     Indicates the measurement specification.
+                                       It must align with MeasurementSpecification (SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_*)
+  @param  MeasurementHashAlgo          Indicates the measurement hash algorithm.
+                                       It must align with MeasurementHashAlgo (SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_*)
+  @param  MeasurementIndex             The index of the measurement block in the device measurement record, starting from 1.
+  @param  MeasurementBlock             A pointer to a destination buffer to store the measurement block.
+  @param  MeasurementBlockSize         On input, indicates the size in bytes of the destination buffer.
+                                       On output, indicates the size in bytes of the measurement block in the buffer.
+
+  @retval TRUE  the measurement block collection success and the measurement block is returned.
+  @retval FALSE the measurement block collection fail.
+**/
+typedef
+BOOLEAN
+(EFIAPI *SPDM_MEASUREMENT_BLOCK_COLLECTION_FUNC) (
+  IN     VOID                                *SpdmContext,
+  IN     UINT8                               MeasurementSpecification,
+  IN     UINT32                              MeasurementHashAlgo,
+  IN     UINT8                               MeasurementIndex,
+     OUT VOID                                *MeasurementBlock,
+  IN OUT UINTN                               *MeasurementBlockSize
+  );
+
+/**
+  Register the measurement block collection function of the responder to an SPDM context.
+
+  The responder serves GET_MEASUREMENTS and the measurement summary hash from the measurement record
+  collected with SpdmMeasurementCollectionFunc. The record is kept until SpdmMeasurementChanged reports a change,
+  unless the responder advertises MEAS_FRESH_CAP, in which case it is recollected for every request.
+  With CollectionFunc, only the changed measurement blocks are recollected. Without it, the whole record is recollected.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CollectionFunc               The function to collect one measurement block, or NULL to recollect the whole record.
+**/
+VOID
+EFIAPI
+SpdmRegisterMeasurementBlockCollectionFunc (
+  IN     VOID                                   *SpdmContext,
+  IN     SPDM_MEASUREMENT_BLOCK_COLLECTION_FUNC CollectionFunc OPTIONAL
+  );
+
+/**
+  Collect one measurement block of the device, for the measurement block iterator.
+
+  The iterator is called for the measurement indices in order, starting from 1, until it returns RETURN_NOT_FOUND.
+  The blocks are not kept in the SPDM context, so their count and total size are not bounded by
+  MAX_SPDM_MEASUREMENT_BLOCK_COUNT or MAX_SPDM_MEASUREMENT_RECORD_SIZE. Each block must fit in one SPDM message.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementSpecification     Indicates the measurement specification.
+                                       It must align with MeasurementSpecification (SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_*)
+  @param  MeasurementHashAlgo          Indicates the measurement hash algorithm.
+                                       It must align with MeasurementHashAlgo (SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_*)
+  @param  MeasurementIndex             The index of the measurement block, starting from 1.
+  @param  MeasurementBlock             A pointer to a destination buffer to store the measurement block.
+                                       It is NULL if *MeasurementBlockSize is 0.
+  @param  MeasurementBlockSize         On input, indicates the size in bytes of the destination buffer.
+                                       On output, indicates the size in bytes of the measurement block,
+                                       if RETURN_SUCCESS or RETURN_BUFFER_TOO_SMALL is returned.
+
+  @retval RETURN_SUCCESS               The measurement block is returned.
+  @retval RETURN_NOT_FOUND             The device has no measurement block of the index.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the measurement block.
+  @retval others                       The measurement block is not collected.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_MEASUREMENT_BLOCK_ITERATOR_FUNC) (
+  IN     VOID                                *SpdmContext,
+  IN     UINT8                               MeasurementSpecification,
+  IN     UINT32                              MeasurementHashAlgo,
+  IN     UINT8                               MeasurementIndex,
+     OUT VOID                                *MeasurementBlock OPTIONAL,
+  IN OUT UINTN                               *MeasurementBlockSize
+  );
+
+/**
+  Register the measurement block iterator of the responder to an SPDM context.
+
+  With IteratorFunc, GET_MEASUREMENTS and the measurement summary hash are served from the blocks collected
+  one by one with IteratorFunc, instead of the measurement record kept in the SPDM context.
+  A MEASUREMENTS response larger than the transport maximum message size is retrieved by CHUNK_GET.
+  The measurement summary hash is kept until SpdmMeasurementChanged reports a change,
+  unless the responder advertises MEAS_FRESH_CAP.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IteratorFunc                 The function to collect one measurement block, or NULL to use the measurement record.
+**/
+VOID
+EFIAPI
+SpdmRegisterMeasurementBlockIteratorFunc (
+  IN     VOID                                 *SpdmContext,
+  IN     SPDM_MEASUREMENT_BLOCK_ITERATOR_FUNC IteratorFunc OPTIONAL
+  );
+
+/**
+  Notify an SPDM context that a measurement of the device changes.
+
+  The changed measurement block is recollected when the measurement record is used next.
+  The other measurement blocks are served from the measurement record kept in the SPDM context.
+  The measurement summary hashes are recomputed when they are used next.
+  A notification while the block is being recollected causes it to be recollected again.
+  It is how a responder without MEAS_FRESH_CAP reports a runtime change of the measurements it collected once.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementIndex             The index of the changed measurement block, starting from 1,
+                                       or SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS
+                                       if the count or all measurement blocks change.
+**/
+VOID
+EFIAPI
+SpdmMeasurementChanged (
+  IN     VOID                                *SpdmContext,
+  IN     UINT8                               MeasurementIndex
+  );
+
 /**
   Reset Message A cache in SPDM context.
 
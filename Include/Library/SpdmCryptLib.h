@@ -44,6 +44,144 @@ BOOLEAN
   OUT  UINT8       *HashValue
   );
 
+/**
+  Computes the hashes of several independent data buffers.
+
+  @param  Count                        Number of data buffers.
+  @param  Data                         Array of Count data buffers to be hashed.
+  @param  HashValue                    Array of Count pointers to buffers that receive the hash values.
+
+  @retval TRUE   Hash computation succeeded.
+  @retval FALSE  Hash computation failed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HASH_ALL_MULTI) (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  );
+
+///
+/// One label of a batched HKDF-Expand: the info to expand and the buffer receiving the output.
+///
+typedef struct {
+  CONST UINT8  *Info;
+  UINTN        InfoSize;
+  UINT8        *Out;
+  UINTN        OutSize;
+} SPDM_HKDF_EXPAND_LABEL;
+
+///
+/// One signature of a batched verification: the public key context, the message and its signature.
+///
+typedef struct {
+  VOID         *Context;
+  CONST UINT8  *Message;
+  UINTN        MessageSize;
+  CONST UINT8  *Signature;
+  UINTN        SigSize;
+} SPDM_ASYM_VERIFY_ITEM;
+
+///
+/// The fields of one DER-encoded X.509 certificate. They point into the certificate, nothing is copied.
+/// Signature is the content of the signatureValue BIT STRING, without its unused bits octet.
+/// SubjectAltName is the content of the subjectAltName extnValue, or NULL if there is no such extension.
+/// So are BasicConstraints, KeyUsage, SubjectKeyIdentifier, AuthorityKeyIdentifier and NameConstraints for their extension.
+/// OtherCriticalExtension is TRUE if a critical extension is none of them, nor extKeyUsage.
+/// The fields are only valid when FieldsParsed is TRUE.
+///
+typedef struct {
+  UINT8    *Cert;
+  UINTN    CertSize;
+  BOOLEAN  FieldsParsed;
+  UINT8    *Tbs;
+  UINTN    TbsSize;
+  UINT8    *TbsSignatureAlgorithm;
+  UINTN    TbsSignatureAlgorithmSize;
+  UINT8    *Issuer;
+  UINTN    IssuerSize;
+  UINT8    *Subject;
+  UINTN    SubjectSize;
+  UINT8    *SubjectPublicKeyInfo;
+  UINTN    SubjectPublicKeyInfoSize;
+  UINT8    *SignatureAlgorithm;
+  UINTN    SignatureAlgorithmSize;
+  UINT8    *Signature;
+  UINTN    SignatureSize;
+  UINT8    *SubjectAltName;
+  UINTN    SubjectAltNameSize;
+  UINT8    *BasicConstraints;
+  UINTN    BasicConstraintsSize;
+  UINT8    *KeyUsage;
+  UINTN    KeyUsageSize;
+  UINT8    *SubjectKeyIdentifier;
+  UINTN    SubjectKeyIdentifierSize;
+  UINT8    *AuthorityKeyIdentifier;
+  UINTN    AuthorityKeyIdentifierSize;
+  UINT8    *NameConstraints;
+  UINTN    NameConstraintsSize;
+  BOOLEAN  OtherCriticalExtension;
+} SPDM_X509_CERT_VIEW;
+
+///
+/// The view of a certificate chain without SPDM_CERT_CHAIN header, built by one walk of the chain.
+/// Root is the first certificate and Leaf the last one.
+///
+typedef struct {
+  UINT8                *CertChainData;
+  UINTN                CertChainDataSize;
+  UINTN                CertCount;
+  SPDM_X509_CERT_VIEW  Root;
+  SPDM_X509_CERT_VIEW  Leaf;
+} SPDM_CERT_CHAIN_VIEW;
+
+///
+/// The crypto operations counted by SPDM_CRYPTO_STATS.
+///
+typedef enum {
+  SpdmCryptoOperationHash,
+  SpdmCryptoOperationHmac,
+  SpdmCryptoOperationHkdfExpand,
+  SpdmCryptoOperationAsymSign,
+  SpdmCryptoOperationAsymVerify,
+  SpdmCryptoOperationDheGenerateKey,
+  SpdmCryptoOperationDheComputeKey,
+  SpdmCryptoOperationAeadEncrypt,
+  SpdmCryptoOperationAeadDecrypt,
+  SpdmCryptoOperationMax,
+} SPDM_CRYPTO_OPERATION;
+
+///
+/// The statistics of one crypto operation.
+/// Bytes is the size of the data hashed or HMACed, of the message or the hash given to the signature algorithm,
+/// of the HKDF output, of the peer public key of a DHE key computation, and of the data and the associated data
+/// of an AEAD operation. The hash of a message to sign or verify is counted as a hash operation.
+///
+typedef struct {
+  UINT64  Count;
+  UINT64  Bytes;
+  UINT64  Cycles;
+} SPDM_CRYPTO_OPERATION_STATS;
+
+///
+/// The crypto statistics of an SPDM context, indexed by SPDM_CRYPTO_OPERATION.
+///
+typedef struct {
+  SPDM_CRYPTO_OPERATION_STATS  Operation[SpdmCryptoOperationMax];
+} SPDM_CRYPTO_STATS;
+
+/**
+  Read the cycle counter for the crypto statistics.
+
+  @return the current value of a monotonic cycle counter.
+**/
+typedef
+UINT64
+(EFIAPI *SPDM_CRYPTO_GET_CYCLE_FUNC) (
+  VOID
+  );
+
 /**
   Computes the HMAC of a input data buffer.
 
@@ -111,6 +249,25 @@ BOOLEAN
   OUT  VOID         **Context
   );
 
+/**
+  Retrieve the asymmetric Public Key from one DER-encoded SubjectPublicKeyInfo.
+
+  @param  DerData                      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param  DerSize                      Size of the DER data in bytes.
+  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
+                                       Use SpdmAsymFree() function to free the resource.
+
+  @retval  TRUE   Public Key was retrieved successfully.
+  @retval  FALSE  Fail to retrieve public key from the DER data.
+**/
+typedef
+BOOLEAN
+(EFIAPI *ASYM_GET_PUBLIC_KEY_FROM_DER) (
+  IN   CONST UINT8  *DerData,
+  IN   UINTN        DerSize,
+  OUT  VOID         **Context
+  );
+
 /**
   Release the specified asymmetric context.
 
@@ -122,6 +279,19 @@ VOID
   IN  VOID         *Context
   );
 
+/**
+  Prepares a public key for repeated signature verification.
+
+  @param  Context                      Pointer to the asymmetric context holding the public key.
+
+  @return Pointer to the prepared public key, or NULL if it cannot be prepared.
+**/
+typedef
+VOID *
+(EFIAPI *ASYM_PREPARE_PUBLIC_KEY) (
+  IN  VOID         *Context
+  );
+
 /**
   Verifies the asymmetric signature.
 
@@ -345,175 +515,880 @@ BOOLEAN
   );
 
 /**
-  This function returns the SPDM hash algorithm size.
-
-  @param  BaseHashAlgo                  SPDM BaseHashAlgo
+  Allocates and initializes one AEAD context for subsequent use.
 
-  @return SPDM hash algorithm size.
+  @return  Pointer to the AEAD context that has been initialized.
 **/
-UINT32
-EFIAPI
-GetSpdmHashSize (
-  IN      UINT32       BaseHashAlgo
+typedef
+VOID *
+(EFIAPI *AEAD_NEW) (
+  VOID
   );
 
 /**
-  Computes the hash of a input data buffer, based upon the negotiated hash algorithm.
+  Release the specified AEAD context.
 
-  This function performs the hash of a given data buffer, and return the hash value.
+  @param  AeadContext                  Pointer to the AEAD context to be released.
+**/
+typedef
+VOID
+(EFIAPI *AEAD_FREE) (
+  IN  VOID  *AeadContext
+  );
 
-  @param  BaseHashAlgo                 SPDM BaseHashAlgo
-  @param  Data                         Pointer to the buffer containing the data to be hashed.
-  @param  DataSize                     Size of Data buffer in bytes.
-  @param  HashValue                    Pointer to a buffer that receives the hash value.
+/**
+  Set the key for the AEAD context. The key schedule is computed once and reused
+  for every subsequent seal or open operation.
 
-  @retval TRUE   Hash computation succeeded.
-  @retval FALSE  Hash computation failed.
+  @param  AeadContext                  Pointer to the AEAD context.
+  @param  Key                          Pointer to the encryption key.
+  @param  KeySize                      Size of the encryption key in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
 **/
+typedef
 BOOLEAN
-EFIAPI
-SpdmHashAll (
-  IN   UINT32                       BaseHashAlgo,
-  IN   CONST VOID                   *Data,
-  IN   UINTN                        DataSize,
-  OUT  UINT8                        *HashValue
+(EFIAPI *AEAD_SET_KEY) (
+  IN OUT  VOID         *AeadContext,
+  IN      CONST UINT8  *Key,
+  IN      UINTN        KeySize
   );
 
 /**
-  This function returns the SPDM measurement hash algorithm size.
+  Performs AEAD authenticated encryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD context.
 
-  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be encrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the encryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @return SPDM measurement hash algorithm size.
-  @return 0xFFFFFFFF for RAW_BIT_STREAM_ONLY.
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
 **/
-UINT32
-EFIAPI
-GetSpdmMeasurementHashSize (
-  IN   UINT32                       MeasurementHashAlgo
+typedef
+BOOLEAN
+(EFIAPI *AEAD_SEAL) (
+  IN OUT VOID*        AeadContext,
+  IN   CONST UINT8*   Iv,
+  IN   UINTN          IvSize,
+  IN   CONST UINT8*   AData,
+  IN   UINTN          ADataSize,
+  IN   CONST UINT8*   DataIn,
+  IN   UINTN          DataInSize,
+  OUT  UINT8*         TagOut,
+  IN   UINTN          TagSize,
+  OUT  UINT8*         DataOut,
+  OUT  UINTN*         DataOutSize
   );
 
 /**
-  Computes the hash of a input data buffer, based upon the negotiated measurement hash algorithm.
-
-  This function performs the hash of a given data buffer, and return the hash value.
+  Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD context.
 
-  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
-  @param  Data                         Pointer to the buffer containing the data to be hashed.
-  @param  DataSize                     Size of Data buffer in bytes.
-  @param  HashValue                    Pointer to a buffer that receives the hash value.
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the decryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @retval TRUE   Hash computation succeeded.
-  @retval FALSE  Hash computation failed.
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
 **/
+typedef
 BOOLEAN
-EFIAPI
-SpdmMeasurementHashAll (
-  IN   UINT32                       MeasurementHashAlgo,
-  IN   CONST VOID                   *Data,
-  IN   UINTN                        DataSize,
-  OUT  UINT8                        *HashValue
+(EFIAPI *AEAD_OPEN) (
+  IN OUT VOID*        AeadContext,
+  IN   CONST UINT8*   Iv,
+  IN   UINTN          IvSize,
+  IN   CONST UINT8*   AData,
+  IN   UINTN          ADataSize,
+  IN   CONST UINT8*   DataIn,
+  IN   UINTN          DataInSize,
+  IN   CONST UINT8*   Tag,
+  IN   UINTN          TagSize,
+  OUT  UINT8*         DataOut,
+  OUT  UINTN*         DataOutSize
   );
 
 /**
-  Computes the HMAC of a input data buffer, based upon the negotiated HMAC algorithm.
+  Performs AEAD authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with the key held in the AEAD context. The cipher text is written contiguously to DataOut.
 
-  This function performs the HMAC of a given data buffer, and return the hash value.
-
-  @param  BaseHashAlgo                 SPDM BaseHashAlgo
-  @param  Data                         Pointer to the buffer containing the data to be HMACed.
-  @param  DataSize                     Size of Data buffer in bytes.
-  @param  Key                          Pointer to the user-supplied key.
-  @param  KeySize                      Key size in bytes.
-  @param  HashValue                    Pointer to a buffer that receives the HMAC value.
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the list of input data segments to be encrypted.
+  @param  DataInCount                  Number of entries in DataIn.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the encryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @retval TRUE   HMAC computation succeeded.
-  @retval FALSE  HMAC computation failed.
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
 **/
+typedef
 BOOLEAN
-EFIAPI
-SpdmHmacAll (
-  IN   UINT32                       BaseHashAlgo,
-  IN   CONST VOID                   *Data,
-  IN   UINTN                        DataSize,
-  IN   CONST UINT8                  *Key,
-  IN   UINTN                        KeySize,
-  OUT  UINT8                        *HmacValue
+(EFIAPI *AEAD_SEAL_SEGMENTS) (
+  IN OUT VOID*                      AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT*    DataIn,
+  IN   UINTN                        DataInCount,
+  OUT  UINT8*                       TagOut,
+  IN   UINTN                        TagSize,
+  OUT  UINT8*                       DataOut,
+  OUT  UINTN*                       DataOutSize
   );
 
 /**
-  Derive HMAC-based Expand Key Derivation Function (HKDF) Expand, based upon the negotiated HKDF algorithm.
+  Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD context. The plain text is scattered over a list of data segments.
 
-  @param  BaseHashAlgo                 SPDM BaseHashAlgo
-  @param  Prk                          Pointer to the user-supplied key.
-  @param  PrkSize                      Key size in bytes.
-  @param  Info                         Pointer to the application specific info.
-  @param  InfoSize                     Info size in bytes.
-  @param  Out                          Pointer to buffer to receive hkdf value.
-  @param  OutSize                      Size of hkdf bytes to generate.
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to the list of segments that receive the decryption output.
+  @param  DataOutCount                 Number of entries in DataOut.
 
-  @retval TRUE   Hkdf generated successfully.
-  @retval FALSE  Hkdf generation failed.
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
 **/
+typedef
 BOOLEAN
-EFIAPI
-SpdmHkdfExpand (
-  IN   UINT32                       BaseHashAlgo,
-  IN   CONST UINT8                  *Prk,
-  IN   UINTN                        PrkSize,
-  IN   CONST UINT8                  *Info,
-  IN   UINTN                        InfoSize,
-  OUT  UINT8                        *Out,
-  IN   UINTN                        OutSize
+(EFIAPI *AEAD_OPEN_SEGMENTS) (
+  IN OUT VOID*                      AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 DataIn,
+  IN   UINTN                        DataInSize,
+  IN   CONST UINT8*                 Tag,
+  IN   UINTN                        TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT*    DataOut,
+  IN   UINTN                        DataOutCount
   );
 
 /**
-  This function returns the SPDM asymmetric algorithm size.
+  Generates the AEAD authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD context.
 
-  @param  BaseAsymAlgo                 SPDM BaseHashAlgo
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  TagSize                      Size of the authentication tag in bytes.
 
-  @return SPDM asymmetric algorithm size.
+  @retval TRUE   AEAD authentication tag generation succeeded.
+  @retval FALSE  AEAD authentication tag generation failed.
 **/
-UINT32
-EFIAPI
-GetSpdmAsymSignatureSize (
-  IN   UINT32                       BaseAsymAlgo
+typedef
+BOOLEAN
+(EFIAPI *AEAD_MAC) (
+  IN OUT VOID*                      AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  OUT  UINT8*                       TagOut,
+  IN   UINTN                        TagSize
   );
 
 /**
-  Retrieve the asymmetric Public Key from one DER-encoded X509 certificate,
-  based upon negotiated asymmetric algorithm.
+  Verifies the AEAD authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD context.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
-  @param  Cert                         Pointer to the DER-encoded X509 certificate.
-  @param  CertSize                     Size of the X509 certificate in bytes.
-  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
-                                       Use SpdmAsymFree() function to free the resource.
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  TagSize                      Size of the authentication tag in bytes.
 
-  @retval  TRUE   Public Key was retrieved successfully.
-  @retval  FALSE  Fail to retrieve public key from X509 certificate.
+  @retval TRUE   AEAD authentication tag verification succeeded.
+  @retval FALSE  AEAD authentication tag verification failed.
 **/
+typedef
 BOOLEAN
-EFIAPI
-SpdmAsymGetPublicKeyFromX509 (
-  IN   UINT32                       BaseAsymAlgo,
-  IN   CONST UINT8                  *Cert,
-  IN   UINTN                        CertSize,
-  OUT  VOID                         **Context
+(EFIAPI *AEAD_VERIFY_MAC) (
+  IN OUT VOID*                      AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 Tag,
+  IN   UINTN                        TagSize
   );
 
 /**
-  Release the specified asymmetric context,
-  based upon negotiated asymmetric algorithm.
+  Allocates one hash context for subsequent use.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
-  @param  Context                      Pointer to the asymmetric context to be released.
+  @return  Pointer to the hash context that has been allocated.
+           If the allocations fails, NULL is returned.
 **/
-VOID
-EFIAPI
-SpdmAsymFree (
-  IN   UINT32                       BaseAsymAlgo,
-  IN   VOID                         *Context
+typedef
+VOID *
+(EFIAPI *HASH_NEW) (
+  VOID
+  );
+
+/**
+  Release the specified hash context.
+
+  @param  HashContext                  Pointer to the hash context to be released.
+**/
+typedef
+VOID
+(EFIAPI *HASH_FREE) (
+  IN  VOID       *HashContext
+  );
+
+/**
+  Initializes user-supplied memory pointed by HashContext as hash context for
+  subsequent use.
+
+  @param  HashContext                  Pointer to hash context being initialized.
+
+  @retval TRUE   Hash context initialization succeeded.
+  @retval FALSE  Hash context initialization failed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HASH_INIT) (
+  OUT  VOID      *HashContext
+  );
+
+/**
+  Makes a copy of an existing hash context.
+
+  @param  HashContext                  Pointer to hash context being copied.
+  @param  NewHashContext               Pointer to new hash context.
+
+  @retval TRUE   Hash context copy succeeded.
+  @retval FALSE  Hash context copy failed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HASH_DUPLICATE) (
+  IN   CONST VOID  *HashContext,
+  OUT  VOID        *NewHashContext
+  );
+
+/**
+  Digests the input data and updates hash context.
+
+  @param  HashContext                  Pointer to the hash context.
+  @param  Data                         Pointer to the buffer containing the data to be hashed.
+  @param  DataSize                     Size of Data buffer in bytes.
+
+  @retval TRUE   Hash data digest succeeded.
+  @retval FALSE  Hash data digest failed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HASH_UPDATE) (
+  IN OUT  VOID        *HashContext,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  );
+
+/**
+  Completes computation of the hash digest value.
+
+  @param  HashContext                  Pointer to the hash context.
+  @param  HashValue                    Pointer to a buffer that receives the hash value.
+
+  @retval TRUE   Hash digest computation succeeded.
+  @retval FALSE  Hash digest computation failed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HASH_FINAL) (
+  IN OUT  VOID   *HashContext,
+  OUT     UINT8  *HashValue
+  );
+
+/**
+  Allocates one HMAC context for subsequent use.
+
+  @return  Pointer to the HMAC context that has been allocated.
+           If the allocations fails, NULL is returned.
+**/
+typedef
+VOID *
+(EFIAPI *HMAC_NEW) (
+  VOID
+  );
+
+/**
+  Release the specified HMAC context.
+
+  @param  HmacContext                  Pointer to the HMAC context to be released.
+**/
+typedef
+VOID
+(EFIAPI *HMAC_FREE) (
+  IN  VOID       *HmacContext
+  );
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to HMAC update.
+
+  @param  HmacContext                  Pointer to HMAC context.
+  @param  Key                          Pointer to the user-supplied key.
+  @param  KeySize                      Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HMAC_SET_KEY) (
+  OUT  VOID         *HmacContext,
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize
+  );
+
+/**
+  Makes a copy of an existing HMAC context.
+
+  @param  HmacContext                  Pointer to HMAC context being copied.
+  @param  NewHmacContext               Pointer to new HMAC context.
+
+  @retval TRUE   HMAC context copy succeeded.
+  @retval FALSE  HMAC context copy failed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HMAC_DUPLICATE) (
+  IN   CONST VOID  *HmacContext,
+  OUT  VOID        *NewHmacContext
+  );
+
+/**
+  Digests the input data and updates HMAC context.
+
+  @param  HmacContext                  Pointer to the HMAC context.
+  @param  Data                         Pointer to the buffer containing the data to be HMACed.
+  @param  DataSize                     Size of Data buffer in bytes.
+
+  @retval TRUE   HMAC data digest succeeded.
+  @retval FALSE  HMAC data digest failed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HMAC_UPDATE) (
+  IN OUT  VOID        *HmacContext,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  );
+
+/**
+  Completes computation of the HMAC digest value.
+
+  @param  HmacContext                  Pointer to the HMAC context.
+  @param  HmacValue                    Pointer to a buffer that receives the HMAC value.
+
+  @retval TRUE   HMAC digest computation succeeded.
+  @retval FALSE  HMAC digest computation failed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *HMAC_FINAL) (
+  IN OUT  VOID   *HmacContext,
+  OUT     UINT8  *HmacValue
+  );
+
+/**
+  This function returns the SPDM hash algorithm size.
+
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
+
+  @return SPDM hash algorithm size.
+**/
+UINT32
+EFIAPI
+GetSpdmHashSize (
+  IN      UINT32       BaseHashAlgo
+  );
+
+/**
+  Computes the hash of a input data buffer, based upon the negotiated hash algorithm.
+
+  This function performs the hash of a given data buffer, and return the hash value.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Data                         Pointer to the buffer containing the data to be hashed.
+  @param  DataSize                     Size of Data buffer in bytes.
+  @param  HashValue                    Pointer to a buffer that receives the hash value.
+
+  @retval TRUE   Hash computation succeeded.
+  @retval FALSE  Hash computation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHashAll (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST VOID                   *Data,
+  IN   UINTN                        DataSize,
+  OUT  UINT8                        *HashValue
+  );
+
+/**
+  Allocates and initializes one hash context for subsequent use,
+  based upon the negotiated hash algorithm.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+
+  @return  Pointer to the hash context that has been initialized.
+           If the allocations fails, NULL is returned.
+**/
+VOID *
+EFIAPI
+SpdmHashNew (
+  IN   UINT32                       BaseHashAlgo
+  );
+
+/**
+  Release the specified hash context,
+  based upon the negotiated hash algorithm.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HashContext                  Pointer to the hash context to be released.
+**/
+VOID
+EFIAPI
+SpdmHashFree (
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *HashContext
+  );
+
+/**
+  Makes a copy of an existing hash context,
+  based upon the negotiated hash algorithm.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HashContext                  Pointer to hash context being copied.
+  @param  NewHashContext               Pointer to new hash context.
+
+  @retval TRUE   Hash context copy succeeded.
+  @retval FALSE  Hash context copy failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHashDuplicate (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST VOID                   *HashContext,
+  OUT  VOID                         *NewHashContext
+  );
+
+/**
+  Digests the input data and updates hash context,
+  based upon the negotiated hash algorithm.
+
+  This function can be called multiple times to compute the digest of discontinuous data streams.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HashContext                  Pointer to the hash context.
+  @param  Data                         Pointer to the buffer containing the data to be hashed.
+  @param  DataSize                     Size of Data buffer in bytes.
+
+  @retval TRUE   Hash data digest succeeded.
+  @retval FALSE  Hash data digest failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHashUpdate (
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *HashContext,
+  IN   CONST VOID                   *Data,
+  IN   UINTN                        DataSize
+  );
+
+/**
+  Completes computation of the hash digest value,
+  based upon the negotiated hash algorithm.
+
+  After this function has been called, the hash context cannot be used again.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HashContext                  Pointer to the hash context.
+  @param  HashValue                    Pointer to a buffer that receives the hash value.
+
+  @retval TRUE   Hash digest computation succeeded.
+  @retval FALSE  Hash digest computation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHashFinal (
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *HashContext,
+  OUT  UINT8                        *HashValue
+  );
+
+/**
+  Computes the hash of a list of data segments, based upon the negotiated hash algorithm.
+
+  The segments are hashed in order, as if they were one contiguous buffer.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Segments                     Pointer to the list of data segments to be hashed.
+  @param  SegmentCount                 Number of entries in Segments.
+  @param  HashValue                    Pointer to a buffer that receives the hash value.
+
+  @retval TRUE   Hash computation succeeded.
+  @retval FALSE  Hash computation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHashAllSegments (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST CRYPT_DATA_SEGMENT     *Segments,
+  IN   UINTN                        SegmentCount,
+  OUT  UINT8                        *HashValue
+  );
+
+/**
+  This function returns the SPDM measurement hash algorithm size.
+
+  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
+
+  @return SPDM measurement hash algorithm size.
+  @return 0xFFFFFFFF for RAW_BIT_STREAM_ONLY.
+**/
+UINT32
+EFIAPI
+GetSpdmMeasurementHashSize (
+  IN   UINT32                       MeasurementHashAlgo
+  );
+
+/**
+  Computes the hash of a input data buffer, based upon the negotiated measurement hash algorithm.
+
+  This function performs the hash of a given data buffer, and return the hash value.
+
+  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
+  @param  Data                         Pointer to the buffer containing the data to be hashed.
+  @param  DataSize                     Size of Data buffer in bytes.
+  @param  HashValue                    Pointer to a buffer that receives the hash value.
+
+  @retval TRUE   Hash computation succeeded.
+  @retval FALSE  Hash computation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmMeasurementHashAll (
+  IN   UINT32                       MeasurementHashAlgo,
+  IN   CONST VOID                   *Data,
+  IN   UINTN                        DataSize,
+  OUT  UINT8                        *HashValue
+  );
+
+/**
+  Computes the hashes of several independent data buffers, based upon the negotiated measurement hash algorithm.
+
+  The result is the same as calling SpdmMeasurementHashAll() on each buffer, but the crypto
+  backend may hash several buffers at once.
+
+  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
+  @param  Count                        Number of data buffers.
+  @param  Data                         Array of Count data buffers to be hashed.
+  @param  HashValue                    Array of Count pointers to buffers that receive the hash values.
+
+  @retval TRUE   Hash computation succeeded.
+  @retval FALSE  Hash computation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmMeasurementHashMulti (
+  IN   UINT32                       MeasurementHashAlgo,
+  IN   UINTN                        Count,
+  IN   CONST CRYPT_DATA_SEGMENT     *Data,
+  IN   UINT8                        **HashValue
+  );
+
+/**
+  Computes the HMAC of a input data buffer, based upon the negotiated HMAC algorithm.
+
+  This function performs the HMAC of a given data buffer, and return the hash value.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Data                         Pointer to the buffer containing the data to be HMACed.
+  @param  DataSize                     Size of Data buffer in bytes.
+  @param  Key                          Pointer to the user-supplied key.
+  @param  KeySize                      Key size in bytes.
+  @param  HashValue                    Pointer to a buffer that receives the HMAC value.
+
+  @retval TRUE   HMAC computation succeeded.
+  @retval FALSE  HMAC computation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHmacAll (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST VOID                   *Data,
+  IN   UINTN                        DataSize,
+  IN   CONST UINT8                  *Key,
+  IN   UINTN                        KeySize,
+  OUT  UINT8                        *HmacValue
+  );
+
+/**
+  Derive HMAC-based Expand Key Derivation Function (HKDF) Expand, based upon the negotiated HKDF algorithm.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Prk                          Pointer to the user-supplied key.
+  @param  PrkSize                      Key size in bytes.
+  @param  Info                         Pointer to the application specific info.
+  @param  InfoSize                     Info size in bytes.
+  @param  Out                          Pointer to buffer to receive hkdf value.
+  @param  OutSize                      Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHkdfExpand (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST UINT8                  *Prk,
+  IN   UINTN                        PrkSize,
+  IN   CONST UINT8                  *Info,
+  IN   UINTN                        InfoSize,
+  OUT  UINT8                        *Out,
+  IN   UINTN                        OutSize
+  );
+
+/**
+  Allocates one HMAC context and sets the user-supplied key,
+  based upon the negotiated HMAC algorithm.
+
+  The keyed context can be duplicated for each HMAC computation with the same key,
+  so that the key setup is only done once.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Key                          Pointer to the user-supplied key.
+  @param  KeySize                      Key size in bytes.
+
+  @return  Pointer to the keyed HMAC context.
+           If the allocations or the key setup fails, NULL is returned.
+**/
+VOID *
+EFIAPI
+SpdmHmacNewWithKey (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST UINT8                  *Key,
+  IN   UINTN                        KeySize
+  );
+
+/**
+  Release the specified HMAC context,
+  based upon the negotiated HMAC algorithm.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HmacContext                  Pointer to the HMAC context to be released.
+**/
+VOID
+EFIAPI
+SpdmHmacFree (
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *HmacContext
+  );
+
+/**
+  Computes the HMAC of a input data buffer with a keyed HMAC context,
+  based upon the negotiated HMAC algorithm.
+
+  The keyed HMAC context is duplicated, so it is not changed and can be used again.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HmacContext                  Pointer to the keyed HMAC context, returned by SpdmHmacNewWithKey.
+  @param  Data                         Pointer to the buffer containing the data to be HMACed.
+  @param  DataSize                     Size of Data buffer in bytes.
+  @param  HmacValue                    Pointer to a buffer that receives the HMAC value.
+
+  @retval TRUE   HMAC computation succeeded.
+  @retval FALSE  HMAC computation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHmacAllWithContext (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST VOID                   *HmacContext,
+  IN   CONST VOID                   *Data,
+  IN   UINTN                        DataSize,
+  OUT  UINT8                        *HmacValue
+  );
+
+/**
+  Derive HMAC-based Expand Key Derivation Function (HKDF) Expand with a keyed HMAC context,
+  based upon the negotiated HKDF algorithm.
+
+  The HMAC context must be keyed with the PRK. It is duplicated for every output block,
+  so it is not changed and can be used again for the next label.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  PrkHmacContext               Pointer to the HMAC context keyed with the PRK, returned by SpdmHmacNewWithKey.
+  @param  Info                         Pointer to the application specific info.
+  @param  InfoSize                     Info size in bytes.
+  @param  Out                          Pointer to buffer to receive hkdf value.
+  @param  OutSize                      Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHkdfExpandWithContext (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST VOID                   *PrkHmacContext,
+  IN   CONST UINT8                  *Info,
+  IN   UINTN                        InfoSize,
+  OUT  UINT8                        *Out,
+  IN   UINTN                        OutSize
+  );
+
+/**
+  Derive several HMAC-based Expand Key Derivation Function (HKDF) Expand outputs from one PRK,
+  based upon the negotiated HKDF algorithm.
+
+  The PRK is set up as HMAC key once and shared by all labels.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Prk                          Pointer to the user-supplied key.
+  @param  PrkSize                      Key size in bytes.
+  @param  Label                        Array of LabelCount labels, each with its info and output buffer.
+  @param  LabelCount                   Number of labels.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHkdfExpandMulti (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST UINT8                  *Prk,
+  IN   UINTN                        PrkSize,
+  IN   CONST SPDM_HKDF_EXPAND_LABEL *Label,
+  IN   UINTN                        LabelCount
+  );
+
+/**
+  This function returns the SPDM asymmetric algorithm size.
+
+  @param  BaseAsymAlgo                 SPDM BaseHashAlgo
+
+  @return SPDM asymmetric algorithm size.
+**/
+UINT32
+EFIAPI
+GetSpdmAsymSignatureSize (
+  IN   UINT32                       BaseAsymAlgo
+  );
+
+/**
+  Retrieve the asymmetric Public Key from one DER-encoded X509 certificate,
+  based upon negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  Cert                         Pointer to the DER-encoded X509 certificate.
+  @param  CertSize                     Size of the X509 certificate in bytes.
+  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
+                                       Use SpdmAsymFree() function to free the resource.
+
+  @retval  TRUE   Public Key was retrieved successfully.
+  @retval  FALSE  Fail to retrieve public key from X509 certificate.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymGetPublicKeyFromX509 (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   CONST UINT8                  *Cert,
+  IN   UINTN                        CertSize,
+  OUT  VOID                         **Context
+  );
+
+/**
+  Retrieve the asymmetric Public Key from one DER-encoded SubjectPublicKeyInfo,
+  based upon negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  DerData                      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param  DerSize                      Size of the DER data in bytes.
+  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
+                                       Use SpdmAsymFree() function to free the resource.
+
+  @retval  TRUE   Public Key was retrieved successfully.
+  @retval  FALSE  Fail to retrieve public key from the DER data.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymGetPublicKeyFromDer (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   CONST UINT8                  *DerData,
+  IN   UINTN                        DerSize,
+  OUT  VOID                         **Context
+  );
+
+/**
+  Release the specified asymmetric context,
+  based upon negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  Context                      Pointer to the asymmetric context to be released.
+**/
+VOID
+EFIAPI
+SpdmAsymFree (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   VOID                         *Context
+  );
+
+/**
+  Return if asymmetric function need message hash.
+
+  The signature of such an algorithm can be generated and verified from a running hash
+  of the message with SpdmAsymSignHash() and SpdmAsymVerifyHash().
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+
+  @retval TRUE  asymmetric function need message hash
+  @retval FALSE asymmetric function need raw message
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymFuncNeedHash (
+  IN   UINT32                       BaseAsymAlgo
   );
 
 /**
@@ -543,6 +1418,121 @@ SpdmAsymVerify (
   IN   UINTN                        SigSize
   );
 
+/**
+  Verifies the asymmetric signature over a message hash,
+  based upon negotiated asymmetric algorithm.
+
+  This is only valid for the asymmetric algorithms which sign a hash of the message.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature verification.
+  @param  MessageHash                  Pointer to the hash of the message to be checked.
+  @param  Signature                    Pointer to asymmetric signature to be verified.
+  @param  SigSize                      Size of signature in bytes.
+
+  @retval  TRUE   Valid asymmetric signature.
+  @retval  FALSE  Invalid asymmetric signature or invalid asymmetric context.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymVerifyHash (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *Context,
+  IN   CONST UINT8                  *MessageHash,
+  IN   CONST UINT8                  *Signature,
+  IN   UINTN                        SigSize
+  );
+
+/**
+  Prepares a public key for repeated signature verification,
+  based upon negotiated asymmetric algorithm.
+
+  The prepared public key holds precomputed values of the public key, so that
+  SpdmAsymVerifyHashPrepared() is faster than SpdmAsymVerifyHash().
+  It does not refer to Context, which may be released before the prepared public key.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  Context                      Pointer to asymmetric context holding the public key.
+
+  @return Pointer to the prepared public key. Use SpdmAsymFreePreparedPublicKey() function to free the resource.
+  @retval NULL  The algorithm has no prepared public key, or the public key cannot be prepared.
+**/
+VOID *
+EFIAPI
+SpdmAsymPreparePublicKey (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   VOID                         *Context
+  );
+
+/**
+  Release the specified prepared public key,
+  based upon negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  PreparedKey                  Pointer to the prepared public key to be released.
+**/
+VOID
+EFIAPI
+SpdmAsymFreePreparedPublicKey (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   VOID                         *PreparedKey
+  );
+
+/**
+  Verifies the asymmetric signature over a message hash with a prepared public key,
+  based upon negotiated asymmetric algorithm.
+
+  The result is the same as SpdmAsymVerifyHash() with the context the public key is prepared from.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  PreparedKey                  Pointer to the prepared public key for signature verification.
+  @param  MessageHash                  Pointer to the hash of the message to be checked.
+  @param  Signature                    Pointer to asymmetric signature to be verified.
+  @param  SigSize                      Size of signature in bytes.
+
+  @retval  TRUE   Valid asymmetric signature.
+  @retval  FALSE  Invalid asymmetric signature or invalid prepared public key.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymVerifyHashPrepared (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *PreparedKey,
+  IN   CONST UINT8                  *MessageHash,
+  IN   CONST UINT8                  *Signature,
+  IN   UINTN                        SigSize
+  );
+
+/**
+  Verifies several asymmetric signatures, based upon negotiated asymmetric algorithm.
+
+  The result is the same as calling SpdmAsymVerify() on each item, but the messages
+  of the algorithms which sign a hash are hashed several at once by the crypto backend.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Item                         Array of Count signatures to be verified.
+  @param  Count                        Number of signatures.
+  @param  Result                       Array of Count booleans that receive the result of each signature.
+                                       If it is NULL, the verification stops at the first invalid signature.
+
+  @retval  TRUE   All signatures are valid.
+  @retval  FALSE  At least one signature is invalid, or the messages cannot be hashed.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymVerifyBatch (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST SPDM_ASYM_VERIFY_ITEM  *Item,
+  IN   UINTN                        Count,
+  OUT  BOOLEAN                      *Result OPTIONAL
+  );
+
 /**
   Retrieve the Private Key from the password-protected PEM key data.
 
@@ -597,6 +1587,36 @@ SpdmAsymSign (
   IN OUT  UINTN                        *SigSize
   );
 
+/**
+  Carries out the signature generation over a message hash.
+
+  This is only valid for the asymmetric algorithms which sign a hash of the message.
+  If the Signature buffer is too small to hold the contents of signature, FALSE
+  is returned and SigSize is set to the required buffer size to obtain the signature.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature generation.
+  @param  MessageHash                  Pointer to the hash of the message to be signed.
+  @param  Signature                    Pointer to buffer to receive signature.
+  @param  SigSize                      On input, the size of Signature buffer in bytes.
+                                       On output, the size of data returned in Signature buffer in bytes.
+
+  @retval  TRUE   Signature successfully generated.
+  @retval  FALSE  Signature generation failed.
+  @retval  FALSE  SigSize is too small.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymSignHash (
+  IN      UINT32                       BaseAsymAlgo,
+  IN      UINT32                       BaseHashAlgo,
+  IN      VOID                         *Context,
+  IN      CONST UINT8                  *MessageHash,
+  OUT     UINT8                        *Signature,
+  IN OUT  UINTN                        *SigSize
+  );
+
 /**
   This function returns the SPDM requester asymmetric algorithm size.
 
@@ -632,6 +1652,28 @@ SpdmReqAsymGetPublicKeyFromX509 (
   OUT  VOID                         **Context
   );
 
+/**
+  Retrieve the asymmetric Public Key from one DER-encoded SubjectPublicKeyInfo,
+  based upon negotiated requester asymmetric algorithm.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  DerData                      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param  DerSize                      Size of the DER data in bytes.
+  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
+                                       Use SpdmAsymFree() function to free the resource.
+
+  @retval  TRUE   Public Key was retrieved successfully.
+  @retval  FALSE  Fail to retrieve public key from the DER data.
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymGetPublicKeyFromDer (
+  IN   UINT16                       ReqBaseAsymAlg,
+  IN   CONST UINT8                  *DerData,
+  IN   UINTN                        DerSize,
+  OUT  VOID                         **Context
+  );
+
 /**
   Release the specified asymmetric context,
   based upon negotiated requester asymmetric algorithm.
@@ -646,6 +1688,20 @@ SpdmReqAsymFree (
   IN   VOID                         *Context
   );
 
+/**
+  Return if requester asymmetric function need message hash.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+
+  @retval TRUE  requester asymmetric function need message hash
+  @retval FALSE requester asymmetric function need raw message
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymFuncNeedHash (
+  IN   UINT16                       ReqBaseAsymAlg
+  );
+
 /**
   Verifies the asymmetric signature,
   based upon negotiated requester asymmetric algorithm.
@@ -673,6 +1729,33 @@ SpdmReqAsymVerify (
   IN   UINTN                        SigSize
   );
 
+/**
+  Verifies the asymmetric signature over a message hash,
+  based upon negotiated requester asymmetric algorithm.
+
+  This is only valid for the asymmetric algorithms which sign a hash of the message.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature verification.
+  @param  MessageHash                  Pointer to the hash of the message to be checked.
+  @param  Signature                    Pointer to asymmetric signature to be verified.
+  @param  SigSize                      Size of signature in bytes.
+
+  @retval  TRUE   Valid asymmetric signature.
+  @retval  FALSE  Invalid asymmetric signature or invalid asymmetric context.
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymVerifyHash (
+  IN   UINT16                       ReqBaseAsymAlg,
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *Context,
+  IN   CONST UINT8                  *MessageHash,
+  IN   CONST UINT8                  *Signature,
+  IN   UINTN                        SigSize
+  );
+
 /**
   Retrieve the Private Key from the password-protected PEM key data.
 
@@ -727,6 +1810,36 @@ SpdmReqAsymSign (
   IN OUT  UINTN                        *SigSize
   );
 
+/**
+  Carries out the signature generation over a message hash.
+
+  This is only valid for the asymmetric algorithms which sign a hash of the message.
+  If the Signature buffer is too small to hold the contents of signature, FALSE
+  is returned and SigSize is set to the required buffer size to obtain the signature.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature generation.
+  @param  MessageHash                  Pointer to the hash of the message to be signed.
+  @param  Signature                    Pointer to buffer to receive signature.
+  @param  SigSize                      On input, the size of Signature buffer in bytes.
+                                       On output, the size of data returned in Signature buffer in bytes.
+
+  @retval  TRUE   Signature successfully generated.
+  @retval  FALSE  Signature generation failed.
+  @retval  FALSE  SigSize is too small.
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymSignHash (
+  IN      UINT16                       ReqBaseAsymAlg,
+  IN      UINT32                       BaseHashAlgo,
+  IN      VOID                         *Context,
+  IN      CONST UINT8                  *MessageHash,
+  OUT     UINT8                        *Signature,
+  IN OUT  UINTN                        *SigSize
+  );
+
 /**
   This function returns the SPDM DHE algorithm key size.
 
@@ -827,64 +1940,192 @@ SpdmDheComputeKey (
   );
 
 /**
-  This function returns the SPDM AEAD algorithm key size.
+  This function returns the SPDM AEAD algorithm key size.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+
+  @return SPDM AEAD algorithm key size.
+**/
+UINT32
+EFIAPI
+GetSpdmAeadKeySize (
+  IN   UINT16                       AEADCipherSuite
+  );
+
+/**
+  This function returns the SPDM AEAD algorithm iv size.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+
+  @return SPDM AEAD algorithm iv size.
+**/
+UINT32
+EFIAPI
+GetSpdmAeadIvSize (
+  IN   UINT16                       AEADCipherSuite
+  );
+
+/**
+  This function returns the SPDM AEAD algorithm tag size.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+
+  @return SPDM AEAD algorithm tag size.
+**/
+UINT32
+EFIAPI
+GetSpdmAeadTagSize (
+  IN   UINT16                       AEADCipherSuite
+  );
+
+/**
+  This function returns the SPDM AEAD algorithm block size.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+
+  @return SPDM AEAD algorithm block size.
+**/
+UINT32
+EFIAPI
+GetSpdmAeadBlockSize (
+  IN   UINT16                       AEADCipherSuite
+  );
+
+/**
+  Performs AEAD authenticated encryption on a data buffer and additional authenticated data (AAD),
+  based upon negotiated AEAD algorithm.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  Key                          Pointer to the encryption key.
+  @param  KeySize                      Size of the encryption key in bytes.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be encrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the encryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmAeadEncryption (
+  IN   UINT16                       AEADCipherSuite,
+  IN   CONST UINT8*                 Key,
+  IN   UINTN                        KeySize,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 DataIn,
+  IN   UINTN                        DataInSize,
+  OUT  UINT8*                       TagOut,
+  IN   UINTN                        TagSize,
+  OUT  UINT8*                       DataOut,
+  OUT  UINTN*                       DataOutSize
+  );
+
+/**
+  Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD),
+  based upon negotiated AEAD algorithm.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  Key                          Pointer to the encryption key.
+  @param  KeySize                      Size of the encryption key in bytes.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the decryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @return SPDM AEAD algorithm key size.
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
 **/
-UINT32
+BOOLEAN
 EFIAPI
-GetSpdmAeadKeySize (
-  IN   UINT16                       AEADCipherSuite
+SpdmAeadDecryption (
+  IN   UINT16                       AEADCipherSuite,
+  IN   CONST UINT8*                 Key,
+  IN   UINTN                        KeySize,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 DataIn,
+  IN   UINTN                        DataInSize,
+  IN   CONST UINT8*                 Tag,
+  IN   UINTN                        TagSize,
+  OUT  UINT8*                       DataOut,
+  OUT  UINTN*                       DataOutSize
   );
 
 /**
-  This function returns the SPDM AEAD algorithm iv size.
+  Allocates and initializes one AEAD context for subsequent use,
+  based upon negotiated AEAD algorithm.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return SPDM AEAD algorithm iv size.
+  @return  Pointer to the AEAD context that has been initialized.
+           NULL if the allocation fails or the algorithm is not supported.
 **/
-UINT32
+VOID *
 EFIAPI
-GetSpdmAeadIvSize (
+SpdmAeadNew (
   IN   UINT16                       AEADCipherSuite
   );
 
 /**
-  This function returns the SPDM AEAD algorithm tag size.
+  Release the specified AEAD context,
+  based upon negotiated AEAD algorithm.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
-
-  @return SPDM AEAD algorithm tag size.
+  @param  AeadContext                  Pointer to the AEAD context to be released.
 **/
-UINT32
+VOID
 EFIAPI
-GetSpdmAeadTagSize (
-  IN   UINT16                       AEADCipherSuite
+SpdmAeadFree (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext
   );
 
 /**
-  This function returns the SPDM AEAD algorithm block size.
+  Set the key for the AEAD context, based upon negotiated AEAD algorithm.
+
+  The key schedule runs once here. SpdmAeadSeal and SpdmAeadOpen only consume the IV.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the AEAD context.
+  @param  Key                          Pointer to the encryption key.
+  @param  KeySize                      Size of the encryption key in bytes.
 
-  @return SPDM AEAD algorithm block size.
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
 **/
-UINT32
+BOOLEAN
 EFIAPI
-GetSpdmAeadBlockSize (
-  IN   UINT16                       AEADCipherSuite
+SpdmAeadSetKey (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext,
+  IN   CONST UINT8*                 Key,
+  IN   UINTN                        KeySize
   );
 
 /**
   Performs AEAD authenticated encryption on a data buffer and additional authenticated data (AAD),
-  based upon negotiated AEAD algorithm.
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
-  @param  Key                          Pointer to the encryption key.
-  @param  KeySize                      Size of the encryption key in bytes.
+  @param  AeadContext                  Pointer to the keyed AEAD context.
   @param  Iv                           Pointer to the IV value.
   @param  IvSize                       Size of the IV value in bytes.
   @param  AData                        Pointer to the additional authenticated data (AAD).
@@ -901,10 +2142,9 @@ GetSpdmAeadBlockSize (
 **/
 BOOLEAN
 EFIAPI
-SpdmAeadEncryption (
+SpdmAeadSeal (
   IN   UINT16                       AEADCipherSuite,
-  IN   CONST UINT8*                 Key,
-  IN   UINTN                        KeySize,
+  IN   VOID                         *AeadContext,
   IN   CONST UINT8*                 Iv,
   IN   UINTN                        IvSize,
   IN   CONST UINT8*                 AData,
@@ -919,11 +2159,10 @@ SpdmAeadEncryption (
 
 /**
   Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD),
-  based upon negotiated AEAD algorithm.
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
-  @param  Key                          Pointer to the encryption key.
-  @param  KeySize                      Size of the encryption key in bytes.
+  @param  AeadContext                  Pointer to the keyed AEAD context.
   @param  Iv                           Pointer to the IV value.
   @param  IvSize                       Size of the IV value in bytes.
   @param  AData                        Pointer to the additional authenticated data (AAD).
@@ -940,10 +2179,9 @@ SpdmAeadEncryption (
 **/
 BOOLEAN
 EFIAPI
-SpdmAeadDecryption (
+SpdmAeadOpen (
   IN   UINT16                       AEADCipherSuite,
-  IN   CONST UINT8*                 Key,
-  IN   UINTN                        KeySize,
+  IN   VOID                         *AeadContext,
   IN   CONST UINT8*                 Iv,
   IN   UINTN                        IvSize,
   IN   CONST UINT8*                 AData,
@@ -956,6 +2194,171 @@ SpdmAeadDecryption (
   OUT  UINTN*                       DataOutSize
   );
 
+/**
+  Performs AEAD authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
+
+  The segments are encrypted in order, as if they were one contiguous buffer, into DataOut.
+  A segment may only overlap DataOut at the offset where its own cipher text is written.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the list of input data segments to be encrypted.
+  @param  DataInCount                  Number of entries in DataIn.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the encryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmAeadSealSegments (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT*    DataIn,
+  IN   UINTN                        DataInCount,
+  OUT  UINT8*                       TagOut,
+  IN   UINTN                        TagSize,
+  OUT  UINT8*                       DataOut,
+  OUT  UINTN*                       DataOutSize
+  );
+
+/**
+  Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
+
+  The plain text is written in order across the DataOut segments, which must hold at least DataInSize bytes.
+  A segment may only overlap DataIn at the offset where its own cipher text is read.
+  If the authentication fails, the plain text written to the segments is zeroed.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to the list of segments that receive the decryption output.
+  @param  DataOutCount                 Number of entries in DataOut.
+
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmAeadOpenSegments (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 DataIn,
+  IN   UINTN                        DataInSize,
+  IN   CONST UINT8*                 Tag,
+  IN   UINTN                        TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT*    DataOut,
+  IN   UINTN                        DataOutCount
+  );
+
+/**
+  Generates the AEAD authentication tag of additional authenticated data (AAD) only,
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
+
+  It is equivalent to SpdmAeadSeal with an empty plain text. It is used by the MAC-only sessions.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  TagSize                      Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD authentication tag generation succeeded.
+  @retval FALSE  AEAD authentication tag generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmAeadMac (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  OUT  UINT8*                       TagOut,
+  IN   UINTN                        TagSize
+  );
+
+/**
+  Verifies the AEAD authentication tag of additional authenticated data (AAD) only,
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
+
+  It is equivalent to SpdmAeadOpen with an empty cipher text. It is used by the MAC-only sessions.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  TagSize                      Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD authentication tag verification succeeded.
+  @retval FALSE  AEAD authentication tag verification failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmAeadVerifyMac (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 Tag,
+  IN   UINTN                        TagSize
+  );
+
+/**
+  Compares the contents of two buffers in constant time.
+
+  The time of the comparison depends on Length only, not on the contents or the position of the
+  first mismatched byte, so that it is used to verify the secrets, such as the HMAC values.
+  Unlike CompareMem, the return value does not order the buffers.
+
+  @param  DestinationBuffer            A pointer to the destination buffer to compare.
+  @param  SourceBuffer                 A pointer to the source buffer to compare.
+  @param  Length                       The number of bytes to compare.
+
+  @return 0                            All Length bytes of the two buffers are identical.
+  @retval Non-zero                     The two buffers are different.
+**/
+INTN
+EFIAPI
+SpdmConstTimeCompareMem (
+  IN CONST VOID                   *DestinationBuffer,
+  IN CONST VOID                   *SourceBuffer,
+  IN UINTN                        Length
+  );
+
 /**
   Generates a random byte stream of the specified size.
 
@@ -970,6 +2373,49 @@ SpdmGetRandomNumber (
   OUT UINT8                     *Rand
   );
 
+//
+// Random bytes drawn ahead from RandomBytes. Buffer[Offset..] is not consumed yet.
+//
+typedef struct {
+#if OPENSPDM_RANDOM_STREAM_SIZE != 0
+  UINTN                         Offset;
+  UINTN                         RefillCount;
+  UINT8                         Buffer[OPENSPDM_RANDOM_STREAM_SIZE];
+#else
+  UINTN                         Reserved;
+#endif
+} SPDM_RANDOM_STREAM;
+
+/**
+  Initialize a random stream, or wipe the random bytes it holds.
+
+  @param  RandomStream                 A pointer to the random stream.
+**/
+VOID
+EFIAPI
+SpdmRandomStreamInit (
+  OUT SPDM_RANDOM_STREAM        *RandomStream
+  );
+
+/**
+  Generates a random byte stream of the specified size from a random stream.
+
+  The bytes are taken from the buffer of the random stream, which is refilled with
+  OPENSPDM_RANDOM_STREAM_SIZE bytes at once. A request of at least OPENSPDM_RANDOM_STREAM_SIZE bytes
+  is passed to RandomBytes directly. The bytes are wiped from the buffer when they are taken.
+
+  @param  RandomStream                 A pointer to the random stream.
+  @param  Size                         Size of random bytes to generate.
+  @param  Rand                         Pointer to buffer to receive random value.
+**/
+VOID
+EFIAPI
+SpdmRandomStreamGetBytes (
+  IN OUT SPDM_RANDOM_STREAM     *RandomStream,
+  IN     UINTN                  Size,
+     OUT UINT8                  *Rand
+  );
+
 /**
   Certificate Check for SPDM leaf cert.
 
@@ -1024,6 +2470,77 @@ SpdmGetDMTFSubjectAltNameFromBytes (
   IN OUT  UINTN         *OidSize
   );
 
+/**
+  Initialize the view of one DER-encoded X.509 certificate.
+
+  The fields of the certificate are not parsed until SpdmX509CertViewParseFields is called.
+
+  @param[out] CertView         The view of the certificate.
+  @param[in]  Cert             Pointer to the DER-encoded X509 certificate.
+  @param[in]  CertSize         Size of the X509 certificate in bytes.
+**/
+VOID
+EFIAPI
+SpdmX509CertViewInit (
+  OUT SPDM_X509_CERT_VIEW          *CertView,
+  IN  UINT8                        *Cert,
+  IN  UINTN                        CertSize
+  );
+
+/**
+  Parse the fields of the certificate of a view, if they are not parsed yet.
+
+  @param[in,out] CertView      The view of the certificate.
+
+  @retval TRUE   The fields are parsed.
+  @retval FALSE  The certificate is not a valid DER-encoded X509 certificate.
+**/
+BOOLEAN
+EFIAPI
+SpdmX509CertViewParseFields (
+  IN OUT SPDM_X509_CERT_VIEW       *CertView
+  );
+
+/**
+  Initialize the view of a certificate chain, by walking the chain once.
+
+  The walk stops at the first element which is not a certificate, as X509GetCertFromCertChain does.
+
+  @param[out] View               The view of the certificate chain.
+  @param[in]  CertChainData      The certificate chain data without SPDM_CERT_CHAIN header.
+  @param[in]  CertChainDataSize  Size in bytes of the certificate chain data.
+
+  @retval TRUE   The view is initialized.
+  @retval FALSE  The certificate chain data has no certificate.
+**/
+BOOLEAN
+EFIAPI
+SpdmCertChainViewInit (
+  OUT SPDM_CERT_CHAIN_VIEW         *View,
+  IN  UINT8                        *CertChainData,
+  IN  UINTN                        CertChainDataSize
+  );
+
+/**
+  Get one certificate of the view of a certificate chain.
+
+  @param[in]  View             The view of the certificate chain.
+  @param[in]  CertIndex        Index of the certificate, 0 for the root and -1 for the leaf.
+  @param[out] Cert             The certificate at the index.
+  @param[out] CertSize         Size in bytes of the certificate.
+
+  @retval TRUE   The certificate is returned.
+  @retval FALSE  The index is out of the chain.
+**/
+BOOLEAN
+EFIAPI
+SpdmCertChainViewGetCert (
+  IN  SPDM_CERT_CHAIN_VIEW         *View,
+  IN  INT32                        CertIndex,
+  OUT UINT8                        **Cert,
+  OUT UINTN                        *CertSize
+  );
+
 /**
   Retrieve the SubjectAltName from one X.509 certificate.
 
@@ -1096,4 +2613,20 @@ SpdmVerifyCertificateChainBuffer (
   IN UINTN                        CertChainBufferSize
   );
 
-#endif
\ No newline at end of file
+/**
+  Bind the crypto statistics the crypto operations of the calling thread are counted in.
+
+  It takes effect if OPENSPDM_CRYPTO_STATS_SUPPORT is 1. The SPDM library binds the statistics of
+  an SPDM context whenever it sends, receives or processes a message of the context.
+
+  @param  Stats                        The statistics to count the operations in, or NULL not to count them.
+  @param  GetCycle                     The fuction to read the cycle counter, or NULL not to count the cycles.
+**/
+VOID
+EFIAPI
+SpdmCryptoStatsBind (
+  IN SPDM_CRYPTO_STATS            *Stats,    OPTIONAL
+  IN SPDM_CRYPTO_GET_CYCLE_FUNC   GetCycle   OPTIONAL
+  );
+
+#endif
\ No newline at end of file
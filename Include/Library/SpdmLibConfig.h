@@ -12,21 +12,198 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define DEFAULT_CONTEXT_LENGTH            MAX_HASH_SIZE
 #define DEFAULT_SECURE_MCTP_PADDING_SIZE  1
+//
+// The number of MCTP messages reassembled at the same time, one per source EID and message tag.
+//
+#define MAX_MCTP_REASSEMBLY_MESSAGE_COUNT 4
+//
+// The number of data object protocols kept from the DOE Discovery of a DOE mailbox.
+//
+#define MAX_PCI_DOE_PROTOCOL_COUNT        8
 
 #define MAX_SPDM_PSK_HINT_LENGTH          16
 
 #define MAX_SPDM_MEASUREMENT_BLOCK_COUNT  8
 #define MAX_SPDM_SESSION_COUNT            4
+#define MAX_SPDM_SESSION_SLOT_COUNT       0xFFFE
 #define MAX_SPDM_CERT_CHAIN_SIZE          0x1000
 #define MAX_SPDM_MEASUREMENT_RECORD_SIZE  0x1000
 #define MAX_SPDM_CERT_CHAIN_BLOCK_LEN     1024
 
 #define MAX_SPDM_MESSAGE_BUFFER_SIZE      0x1200
 #define MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE 0x100
+//
+// Size in bytes of the data of a chunk of the transcript arena.
+//
+#define SPDM_TRANSCRIPT_CHUNK_SIZE        0x200
+//
+// Size in bytes of the default scratch arena, for the temporary message buffers nested in one call.
+//
+#define SPDM_DEFAULT_SCRATCH_SIZE         (MAX_SPDM_MESSAGE_BUFFER_SIZE * 4)
 
 #define MAX_SPDM_REQUEST_RETRY_TIMES      3
+//
+// The number of signature verifications of the requester in flight while the next requests are sent,
+// once the asynchronous verification functions are registered.
+//
+#define MAX_SPDM_PIPELINED_VERIFY_COUNT   4
+//
+// The number of KEY_EXCHANGE requests the requester prepares ahead with SpdmPrestageKeyExchange.
+//
+#define MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT  2
+//
+// The largest CTExponent or RDTExponent honored when a response time is computed,
+// and the largest power of two ST1 is scaled by to wait after consecutive ERROR(BUSY).
+//
+#define MAX_SPDM_TIMING_EXPONENT          40
+#define MAX_SPDM_BUSY_BACKOFF_SHIFT       5
 #define MAX_SPDM_SESSION_STATE_CALLBACK_NUM     4
 #define MAX_SPDM_CONNECTION_STATE_CALLBACK_NUM  4
+//
+// The number of state transitions the state event queue holds until they are dispatched.
+// It must be a power of two.
+//
+#define MAX_SPDM_STATE_EVENT_QUEUE_DEPTH        16
+#define MAX_SPDM_VENDOR_DEFINED_HANDLER_COUNT   4
+#define MAX_SPDM_VENDOR_ID_LENGTH               8
+//
+// The number of transport paths an SPDM context can register with SpdmRegisterTransportPath,
+// in addition to the one registered by SpdmRegisterDeviceIoFunc and SpdmRegisterTransportLayerFunc.
+//
+#define MAX_SPDM_TRANSPORT_PATH_COUNT           3
+
+//
+// Session Table Configuation
+// Set to 1 to look up the session slots by SessionId in a hash table, instead of scanning them.
+// It is useful if SpdmInitContextEx is used with a large MaxSessionCount.
+//
+#ifndef OPENSPDM_SESSION_HASH_TABLE_SUPPORT
+#define OPENSPDM_SESSION_HASH_TABLE_SUPPORT     0
+#endif
+
+//
+// Requester Statistics Configuation
+// Set to 1 to collect the counts, the sizes, the retries, the ERROR codes and the latencies of each request code
+// in the requester. They are read with SpdmGetData (SpdmDataRequesterStats).
+// The latencies are collected once a time function is registered with SpdmRegisterRequesterMonitorFunc.
+//
+#define OPENSPDM_REQUESTER_STATS_SUPPORT        0
+
+//
+// Responder Statistics Configuation
+// Set to 1 to collect the counts, the sizes, the ERROR codes and the latencies of each request code
+// in the responder. They are read with SpdmGetData (SpdmDataResponderStats).
+// The latencies are collected once a time function is registered with SpdmRegisterResponderAdmissionFunc.
+//
+#define OPENSPDM_RESPONDER_STATS_SUPPORT        0
+
+//
+// Replay Window Configuation
+// Set to the number of sequence numbers, up to 64, below the highest one received that an application
+// secured message may still carry. It applies when the transport carries the sequence number in the record,
+// and lets such records be decoded out of order. 0 only accepts the next sequence number.
+//
+#ifndef OPENSPDM_REPLAY_WINDOW_SIZE
+#define OPENSPDM_REPLAY_WINDOW_SIZE             0
+#endif
+
+//
+// Random Stream Configuation
+// Set to the size in bytes of a buffer of random bytes that is drawn ahead from RandomBytes.
+// The nonces of an SPDM context and the random data of the secured messages of a session are then
+// taken from the buffer, and RandomBytes only runs when the buffer is refilled. 0 calls RandomBytes every time.
+// The random number generator is reseeded every OPENSPDM_RANDOM_STREAM_RESEED_INTERVAL refills.
+//
+#define OPENSPDM_RANDOM_STREAM_SIZE             0
+#define OPENSPDM_RANDOM_STREAM_RESEED_INTERVAL  64
+
+//
+// Message A Digest Configuation
+// Set to 1 to hash the VCA messages as they are added to Message A, with each local base hash algorithm,
+// because the base hash algorithm is not negotiated before ALGORITHMS. Only the running hash of the
+// negotiated algorithm is kept after ALGORITHMS. The M1/M2 and TH hashes then start from a copy of it,
+// instead of hashing Message A again.
+//
+#define OPENSPDM_MESSAGE_A_DIGEST_SUPPORT       0
+
+//
+// Tracepoint Configuation
+// Set to 1 to emit static tracepoints when a message is sent or received, encoded or decoded, when a TH hash,
+// a HMAC or a signature of a session is computed, and when the state of a session changes.
+// They are USDT probes of the provider "openspdm" on Linux, which requires <sys/sdt.h>, and TraceLogging events
+// of the provider "OpenSpdm" on Windows. They are for OS builds only, and must stay 0 for firmware.
+//
+#define OPENSPDM_TRACEPOINT_SUPPORT             0
+
+//
+// Allocation Audit Configuation
+// Set to 1 to tag the pool allocations of each thread with the request code of the SPDM message being processed,
+// by SetPoolAllocationTag of the MemoryAllocationLib. The MemoryAllocationLib of the allocation audit
+// reports the allocations per request code, and the build with MEMORY_ALLOCATION=Audit sets it to 1.
+//
+#ifndef OPENSPDM_ALLOCATION_AUDIT_SUPPORT
+#define OPENSPDM_ALLOCATION_AUDIT_SUPPORT       0
+#endif
+
+//
+// Crypto Statistics Configuation
+// Set to 1 to count the hash, HMAC, HKDF expand, signature, DHE and AEAD operations of each SPDM context,
+// with the bytes they process and, once a cycle function is registered with SpdmRegisterCryptoCycleFunc,
+// the cycles they take. The statistics are returned by SpdmGetData(SpdmDataCryptoStats).
+// The SPDM context is bound to the calling thread in thread-local storage, so it is for OS builds only.
+//
+#define OPENSPDM_CRYPTO_STATS_SUPPORT           0
+
+//
+// Evidence Configuation
+// Set to 1 to let the requester keep the signed transcripts of the last verified CHALLENGE_AUTH and signed MEASUREMENTS.
+// SpdmExportEvidence exports them with the peer certificate chain, and SpdmVerifyEvidence verifies the export
+// without any SPDM message. The requester keeps a copy of Message B and Message M besides their running hashes,
+// in chunks of the transcript arena.
+//
+#define OPENSPDM_EVIDENCE_SUPPORT               0
+
+//
+// Certificate Chain Batch Verification Configuation
+// Set to 1 to verify the signatures of the certificates of a chain with SpdmAsymVerifyBatch, after one walk of
+// the chain. A chain whose links use other algorithms or extensions than those checked this way, or which
+// fails, is verified by X509VerifyCertChain as before. The validity period of the certificates is not checked,
+// as by the Openssl backend, so a MbedTls build which relies on this check should keep it 0.
+//
+#define OPENSPDM_CERT_CHAIN_BATCH_VERIFY_SUPPORT 0
+
+//
+// Capability Configuation
+// Set to 0 to remove the requester and responder handlers of a capability, and the context state they use.
+// The capability is cleared from the local capability flags, so that it is never negotiated, and the APIs
+// which only run it return RETURN_UNSUPPORTED.
+// OPENSPDM_MUT_AUTH_CAP_SUPPORT covers the mutual authentication of CHALLENGE and KEY_EXCHANGE, with the encapsulated
+// GET_DIGESTS, GET_CERTIFICATE and CHALLENGE. It needs OPENSPDM_ENCAP_CAP_SUPPORT, which holds the requester slot.
+// OPENSPDM_ENCAP_CAP_SUPPORT without mutual authentication only carries the responder-initiated KEY_UPDATE.
+//
+#define OPENSPDM_PSK_CAP_SUPPORT                1
+#define OPENSPDM_MUT_AUTH_CAP_SUPPORT           1
+#define OPENSPDM_ENCAP_CAP_SUPPORT              1
+#define OPENSPDM_KEY_UPD_CAP_SUPPORT            1
+#define OPENSPDM_HBEAT_CAP_SUPPORT              1
+
+#if (OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1) && (OPENSPDM_ENCAP_CAP_SUPPORT == 0)
+#error "OPENSPDM_MUT_AUTH_CAP_SUPPORT needs OPENSPDM_ENCAP_CAP_SUPPORT"
+#endif
+#if (OPENSPDM_ENCAP_CAP_SUPPORT == 1) && (OPENSPDM_MUT_AUTH_CAP_SUPPORT == 0) && (OPENSPDM_KEY_UPD_CAP_SUPPORT == 0)
+#error "OPENSPDM_ENCAP_CAP_SUPPORT needs OPENSPDM_MUT_AUTH_CAP_SUPPORT or OPENSPDM_KEY_UPD_CAP_SUPPORT"
+#endif
+
+//
+// Fixed Suite Configuation
+// Define OPENSPDM_FIXED_SUITE to one OPENSPDM_SUITE_* value to build a single algorithm suite.
+// Only the crypto of this suite is built, and the local algorithms are limited to this suite.
+//
+#define OPENSPDM_SUITE_SHA384_ECDSAP384_ECDHEP384_AES256GCM  1
+
+//#define OPENSPDM_FIXED_SUITE  OPENSPDM_SUITE_SHA384_ECDSAP384_ECDHEP384_AES256GCM
+
+#ifndef OPENSPDM_FIXED_SUITE
 
 //
 // Crypto Configuation
@@ -46,4 +223,48 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define OPENSPDM_SHA384_SUPPORT      1
 #define OPENSPDM_SHA512_SUPPORT      1
 
+//
+// SHA3 is provided for the measurement hash. HMAC and HKDF over SHA3 are not,
+// so SpdmSetData and the algorithm negotiation reject a SHA3 base hash.
+//
+#define OPENSPDM_SHA3_256_SUPPORT    1
+#define OPENSPDM_SHA3_384_SUPPORT    1
+#define OPENSPDM_SHA3_512_SUPPORT    1
+
+#elif OPENSPDM_FIXED_SUITE == OPENSPDM_SUITE_SHA384_ECDSAP384_ECDHEP384_AES256GCM
+
+#define OPENSPDM_RSA_SSA_SUPPORT                 0
+#define OPENSPDM_RSA_PSS_SUPPORT                 0
+#define OPENSPDM_ECDSA_SUPPORT                   1
+
+#define OPENSPDM_FFDHE_SUPPORT                   0
+#define OPENSPDM_ECDHE_SUPPORT                   1
+
+#define OPENSPDM_AEAD_GCM_SUPPORT                1
+#define OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT  0
+
+#define OPENSPDM_SHA256_SUPPORT      0
+#define OPENSPDM_SHA384_SUPPORT      1
+#define OPENSPDM_SHA512_SUPPORT      0
+
+#define OPENSPDM_SHA3_256_SUPPORT    0
+#define OPENSPDM_SHA3_384_SUPPORT    0
+#define OPENSPDM_SHA3_512_SUPPORT    0
+
+//
+// The algorithms allowed in the local context.
+//
+#define OPENSPDM_FIXED_MEASUREMENT_HASH_ALGO  (SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384 | \
+                                               SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_RAW_BIT_STREAM_ONLY)
+#define OPENSPDM_FIXED_BASE_ASYM_ALGO         SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384
+#define OPENSPDM_FIXED_BASE_HASH_ALGO         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384
+#define OPENSPDM_FIXED_DHE_NAMED_GROUP        SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1
+#define OPENSPDM_FIXED_AEAD_CIPHER_SUITE      SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM
+#define OPENSPDM_FIXED_REQ_BASE_ASYM_ALG      SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384
+#define OPENSPDM_FIXED_KEY_SCHEDULE           SPDM_ALGORITHMS_KEY_SCHEDULE_HMAC_HASH
+
+#else
+#error "Unknown OPENSPDM_FIXED_SUITE"
+#endif
+
 #endif
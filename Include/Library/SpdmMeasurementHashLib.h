@@ -0,0 +1,71 @@
+/** @file
+  SPDM measurement hash library.
+  It helps a SPDM_MEASUREMENT_COLLECTION_FUNC to hash large measurement regions on a worker pool.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __SPDM_MEASUREMENT_HASH_LIB_H__
+#define __SPDM_MEASUREMENT_HASH_LIB_H__
+
+#include <Library/SpdmDeviceSecretLib.h>
+
+///
+/// A measurement region, which is measured into one DMTF measurement block.
+/// The region is either a buffer in memory, or a file which is mapped into memory.
+///
+typedef struct {
+  // DMTFSpecMeasurementValueType, without SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_RAW_BIT_STREAM.
+  UINT8        ValueType;
+  // The region in memory. If it is NULL, FileName is mapped.
+  CONST VOID   *Buffer;
+  UINTN        Size;
+  CONST CHAR8  *FileName;
+} SPDM_MEASUREMENT_REGION;
+
+/**
+  Collect the DMTF measurement blocks of the measurement regions.
+
+  The block of Region[Index] has the measurement index Index + 1. Its value is the digest of the region
+  with MeasurementHashAlgo, or the raw bit stream of the region for RAW_BIT_STREAM_ONLY.
+  The regions are hashed in parallel by up to ThreadCount threads, including the calling thread.
+  The largest regions are hashed first, so that a large region does not start last. Each region
+  is hashed by one thread as one message, because the digest must match the reference value of
+  the region.
+
+  The function can be called by a SPDM_MEASUREMENT_COLLECTION_FUNC. It is thread safe, as long as
+  the crypto library is.
+
+  @param  MeasurementSpecification     Indicates the measurement specification.
+                                       It must be SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF.
+  @param  MeasurementHashAlgo          Indicates the measurement hash algorithm.
+                                       It must align with MeasurementHashAlgo (SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_*)
+  @param  RegionCount                  The count of the measurement regions, from 1 to 0xFE.
+  @param  Region                       The measurement regions.
+  @param  ThreadCount                  The maximum number of threads. 0 or 1 hashes the regions in the calling thread.
+  @param  DeviceMeasurementCount       The count of the device measurement block.
+  @param  DeviceMeasurement            A pointer to a destination buffer to store the concatenation of all device measurement blocks.
+  @param  DeviceMeasurementSize        On input, indicates the size in bytes of the destination buffer.
+                                       On output, indicates the size in bytes of all device measurement blocks in the buffer,
+                                       or the size in bytes required if the buffer is too small.
+
+  @retval TRUE  the device measurement collection success and measurement is returned.
+  @retval FALSE the device measurement collection fail, a region cannot be read, a raw bit stream region
+                is larger than 0xFFFF bytes, or the destination buffer is too small.
+**/
+BOOLEAN
+EFIAPI
+SpdmMeasurementHashRegions (
+  IN      UINT8                          MeasurementSpecification,
+  IN      UINT32                         MeasurementHashAlgo,
+  IN      UINTN                          RegionCount,
+  IN      CONST SPDM_MEASUREMENT_REGION  *Region,
+  IN      UINTN                          ThreadCount,
+     OUT  UINT8                          *DeviceMeasurementCount,
+     OUT  VOID                           *DeviceMeasurement,
+  IN OUT  UINTN                          *DeviceMeasurementSize
+  );
+
+#endif
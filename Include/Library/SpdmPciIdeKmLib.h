@@ -0,0 +1,120 @@
+/** @file
+  SPDM PCI IDE_KM library.
+  It runs the PCI IDE key management protocol as SPDM VENDOR_DEFINED messages of an SPDM session.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __SPDM_PCI_IDE_KM_LIB_H__
+#define __SPDM_PCI_IDE_KM_LIB_H__
+
+#include <Library/SpdmRequesterLib.h>
+#include <IndustryStandard/PciIdeKm.h>
+
+///
+/// An IDE stream of a port, to be keyed by SpdmPciIdeKmProgramStreams.
+///
+typedef struct {
+  UINT8                PortIndex;
+  UINT8                StreamId;
+} SPDM_PCI_IDE_KM_STREAM;
+
+/**
+  Query the IDE_KM ports of the device.
+
+  QUERY of port 0 returns the MaxPortIndex. The QUERY of the other ports are pipelined,
+  with up to MaxOutstanding requests in flight.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  MaxOutstanding               The maximum number of requests in flight. It must not be zero.
+  @param  PortCount                    On input, the number of entries in QueryResp.
+                                       On output, the number of ports of the device, which is MaxPortIndex + 1.
+  @param  QueryResp                    The QUERY_RESP of each port, indexed by PortIndex.
+
+  @retval RETURN_SUCCESS               All ports are queried.
+  @retval RETURN_INVALID_PARAMETER     MaxOutstanding is zero, or *PortCount is zero.
+  @retval RETURN_BUFFER_TOO_SMALL      *PortCount is too small. Only QueryResp[0] is returned.
+  @retval RETURN_DEVICE_ERROR          The response is not the QUERY_RESP of the port.
+  @retval others                       A request cannot be sent, or a response cannot be received.
+                                       The session should be ended, because the responses in flight are not received.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPciIdeKmQueryPorts (
+  IN     VOID                       *SpdmContext,
+  IN     UINT32                     SessionId,
+  IN     UINTN                      MaxOutstanding,
+  IN OUT UINTN                      *PortCount,
+     OUT PCI_IDE_KM_QUERY_RESP      *QueryResp
+  );
+
+/**
+  Program one key set of the IDE streams, and start to use it.
+
+  A KEY_PROG is sent for the Rx and Tx key of each PR, NPR and CPL substream of each stream.
+  The K_SET_GO are sent once all KP_ACK are received. Both are pipelined, with up to MaxOutstanding
+  requests in flight.
+
+  The keys and IFVs are derived from the ExportMasterSecret of the session with HKDF-Expand,
+  with the label "ide_km key" followed by the PortIndex, StreamId and KeySubStream.
+  Programming the same key set of the same stream again in the session programs the same keys.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  KeySet                       The key set to program, 0 or 1.
+  @param  Stream                       The streams to program.
+  @param  StreamCount                  The number of streams.
+  @param  MaxOutstanding               The maximum number of requests in flight. It must not be zero.
+
+  @retval RETURN_SUCCESS               All keys are programmed and in use.
+  @retval RETURN_INVALID_PARAMETER     KeySet is out of range, StreamCount is zero, or MaxOutstanding is zero.
+  @retval RETURN_NOT_FOUND             The session is not found.
+  @retval RETURN_DEVICE_ERROR          A response is not the acknowledgement of its request, or a key cannot be derived.
+  @retval others                       A request cannot be sent, or a response cannot be received.
+                                       The session should be ended, because the responses in flight are not received.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPciIdeKmProgramStreams (
+  IN     VOID                       *SpdmContext,
+  IN     UINT32                     SessionId,
+  IN     UINT8                      KeySet,
+  IN     CONST SPDM_PCI_IDE_KM_STREAM *Stream,
+  IN     UINTN                      StreamCount,
+  IN     UINTN                      MaxOutstanding
+  );
+
+/**
+  Stop to use one key set of the IDE streams.
+
+  A K_SET_STOP is sent for the Rx and Tx key of each PR, NPR and CPL substream of each stream.
+  They are pipelined, with up to MaxOutstanding requests in flight.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  KeySet                       The key set to stop, 0 or 1.
+  @param  Stream                       The streams to stop.
+  @param  StreamCount                  The number of streams.
+  @param  MaxOutstanding               The maximum number of requests in flight. It must not be zero.
+
+  @retval RETURN_SUCCESS               The key set of all streams is stopped.
+  @retval RETURN_INVALID_PARAMETER     KeySet is out of range, StreamCount is zero, or MaxOutstanding is zero.
+  @retval RETURN_DEVICE_ERROR          A response is not the acknowledgement of its request.
+  @retval others                       A request cannot be sent, or a response cannot be received.
+                                       The session should be ended, because the responses in flight are not received.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPciIdeKmStopStreams (
+  IN     VOID                       *SpdmContext,
+  IN     UINT32                     SessionId,
+  IN     UINT8                      KeySet,
+  IN     CONST SPDM_PCI_IDE_KM_STREAM *Stream,
+  IN     UINTN                      StreamCount,
+  IN     UINTN                      MaxOutstanding
+  );
+
+#endif
@@ -0,0 +1,173 @@
+/** @file
+  SPDM PLDM library.
+  It runs PLDM over MCTP as the APP message of an SPDM session.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __SPDM_PLDM_LIB_H__
+#define __SPDM_PLDM_LIB_H__
+
+#include <Library/SpdmRequesterLib.h>
+
+/**
+  Complete a PLDM request sent by SpdmPldmSendRequest.
+
+  @param  CompletionContext            The context passed to SpdmPldmSendRequest.
+  @param  Status                       RETURN_SUCCESS if the PLDM response is received,
+                                       or RETURN_ABORTED if the request is aborted by SpdmPldmRequesterAbort.
+  @param  InstanceId                   The PLDM instance ID of the request.
+  @param  PldmType                     The PLDM type of the request.
+  @param  PldmCommandCode              The PLDM command code of the request.
+  @param  PldmCompletionCode           The PLDM completion code of the response.
+  @param  ResponseDataSize             Size in bytes of the response data after the completion code.
+  @param  ResponseData                 A pointer to the response data after the completion code.
+                                       It is valid only until the function returns.
+**/
+typedef
+VOID
+(EFIAPI *SPDM_PLDM_COMPLETION_FUNC) (
+  IN     VOID                 *CompletionContext,
+  IN     RETURN_STATUS        Status,
+  IN     UINT8                InstanceId,
+  IN     UINT8                PldmType,
+  IN     UINT8                PldmCommandCode,
+  IN     UINT8                PldmCompletionCode,
+  IN     UINTN                ResponseDataSize,
+  IN     VOID                 *ResponseData
+  );
+
+/**
+  Return the size in bytes of a PLDM requester.
+
+  @return the size in bytes of the PLDM requester.
+**/
+UINTN
+EFIAPI
+SpdmPldmRequesterGetSize (
+  VOID
+  );
+
+/**
+  Initialize a PLDM requester for an SPDM session.
+
+  The size in bytes of the requester can be returned by SpdmPldmRequesterGetSize.
+  The PLDM messages are sent and received as the APP messages of the session, with an MCTP message header.
+  Each outstanding request holds one PLDM instance ID, so that up to MaxOutstanding requests can be in flight,
+  and the responses are routed back to the requests by the instance ID.
+  The functions of one requester must not be called concurrently.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  MaxOutstanding               The maximum number of requests in flight, from 1 to PLDM_INSTANCE_ID_COUNT.
+
+  @retval RETURN_SUCCESS               The requester is initialized.
+  @retval RETURN_INVALID_PARAMETER     MaxOutstanding is out of range.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPldmRequesterInit (
+     OUT VOID                 *PldmRequester,
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINTN                MaxOutstanding
+  );
+
+/**
+  Send a PLDM request without waiting for its response.
+
+  The response is received by SpdmPldmProcessResponse, which calls CompletionFunc.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+  @param  PldmType                     The PLDM type of the request.
+  @param  PldmCommandCode              The PLDM command code of the request.
+  @param  RequestData                  A pointer to the request data after the PLDM message header.
+  @param  RequestDataSize              Size in bytes of the request data.
+  @param  CompletionFunc               The function to complete the request.
+  @param  CompletionContext            The context passed to CompletionFunc.
+  @param  InstanceId                   The PLDM instance ID of the request, if it is sent.
+
+  @retval RETURN_SUCCESS               The request is sent.
+  @retval RETURN_INVALID_PARAMETER     PldmType is out of range, or CompletionFunc is NULL.
+  @retval RETURN_BAD_BUFFER_SIZE       The request does not fit in an APP message.
+  @retval RETURN_NOT_READY             MaxOutstanding requests are in flight.
+                                       A response must be processed by SpdmPldmProcessResponse first.
+  @retval others                       The request cannot be sent, and it is not in flight.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPldmSendRequest (
+  IN     VOID                       *PldmRequester,
+  IN     UINT8                      PldmType,
+  IN     UINT8                      PldmCommandCode,
+  IN     VOID                       *RequestData OPTIONAL,
+  IN     UINTN                      RequestDataSize,
+  IN     SPDM_PLDM_COMPLETION_FUNC  CompletionFunc,
+  IN     VOID                       *CompletionContext OPTIONAL,
+     OUT UINT8                      *InstanceId OPTIONAL
+  );
+
+/**
+  Receive one PLDM response, and complete the request it answers.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+
+  @retval RETURN_SUCCESS               A response is received, and its request is completed.
+  @retval RETURN_NOT_STARTED           No request is in flight.
+  @retval RETURN_NOT_FOUND             A message is received, but it is not a PLDM response to a request in flight.
+                                       It is dropped.
+  @retval others                       No response is received.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPldmProcessResponse (
+  IN     VOID                 *PldmRequester
+  );
+
+/**
+  Receive PLDM responses until no request is in flight.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+
+  @retval RETURN_SUCCESS               No request is in flight.
+  @retval others                       The status of the first SpdmPldmProcessResponse failing to receive a response.
+                                       The requests not completed are still in flight.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPldmRequesterFlush (
+  IN     VOID                 *PldmRequester
+  );
+
+/**
+  Complete all requests in flight with RETURN_ABORTED, and release their instance IDs.
+
+  It is used when the session ends or the responses are lost.
+  A late response to an aborted request is dropped by SpdmPldmProcessResponse, unless its instance ID
+  is held by a new request again. The instance IDs are used in turn to make it unlikely.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+**/
+VOID
+EFIAPI
+SpdmPldmRequesterAbort (
+  IN     VOID                 *PldmRequester
+  );
+
+/**
+  Return the number of requests in flight.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+
+  @return the number of requests in flight.
+**/
+UINTN
+EFIAPI
+SpdmPldmRequesterGetOutstandingCount (
+  IN     VOID                 *PldmRequester
+  );
+
+#endif
@@ -27,6 +27,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
   @retval RETURN_SUCCESS               The SPDM request is sent successfully.
   @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM request is sent to the device.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
 **/
 RETURN_STATUS
 EFIAPI
@@ -53,6 +54,7 @@ SpdmSendRequest (
 
   @retval RETURN_SUCCESS               The SPDM response is received successfully.
   @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM response is received from the device.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
 **/
 RETURN_STATUS
 EFIAPI
@@ -71,6 +73,9 @@ SpdmReceiveResponse (
   Before this function, the requester configuration data can be set via SpdmSetData.
   After this function, the negotiated configuration data can be got via SpdmGetData.
 
+  If the negotiated state is imported by SpdmImportNegotiatedState and the connection is still negotiated,
+  no message is sent, because the responder preserved the negotiated state.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  GetVersionOnly               If the requester sends GET_VERSION only or not.
 
@@ -150,7 +155,8 @@ SpdmGetCertificate (
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SlotNum                      The number of slot for the certificate chain.
-  @param  Length                       MAX_SPDM_CERT_CHAIN_BLOCK_LEN.
+  @param  Length                       Length parameter in the get_certificate message.
+                                       It is limited by the transport maximum message size (SpdmDataTransportMaxMessageSize).
   @param  CertChainSize                On input, indicate the size in bytes of the destination buffer to store the digest buffer.
                                        On output, indicate the size in bytes of the certificate chain.
   @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
@@ -196,12 +202,68 @@ SpdmChallenge (
      OUT VOID                 *MeasurementHash
   );
 
+/**
+  This function sends CHALLENGE to authenticate the device based upon the key in one slot,
+  and returns without waiting for the signature verification.
+
+  Once the asynchronous verification functions are registered with SpdmRegisterRequesterVerifyAsyncFunc,
+  the signature in the challenge auth is verified while the caller sends other requests, for example to
+  another device. The challenge auth is then committed by SpdmCompleteChallenge, which also performs the
+  basic mutual authentication if it is requested. No other request is sent on this connection until then.
+  Without the asynchronous verification functions, this function is the same as SpdmChallenge.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the challenge.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+                                       It is written by SpdmCompleteChallenge if the verification is pending.
+
+  @retval RETURN_SUCCESS               The challenge auth is got and verified successfully.
+  @retval RETURN_NOT_READY             The challenge auth is got, and its signature verification is pending.
+  @retval RETURN_ALREADY_STARTED       A challenge is pending already.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmStartChallenge (
+  IN     VOID                 *SpdmContext,
+  IN     UINT8                SlotNum,
+  IN     UINT8                MeasurementHashType,
+     OUT VOID                 *MeasurementHash
+  );
+
+/**
+  This function completes a challenge started by SpdmStartChallenge.
+
+  Once the signature in the challenge auth is verified, the measurement hash is returned,
+  the basic mutual authentication is performed if it is requested, and the connection is authenticated.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Wait                         TRUE to wait until the signature verification is completed.
+
+  @retval RETURN_SUCCESS               The challenge auth is verified, and the connection is authenticated.
+  @retval RETURN_NOT_READY             The signature verification is still pending. It is not returned if Wait is TRUE.
+  @retval RETURN_NOT_STARTED           No challenge is pending.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmCompleteChallenge (
+  IN     VOID                 *SpdmContext,
+  IN     BOOLEAN              Wait
+  );
+
 /**
   This function sends GET_MEASUREMENT
   to get measurement from the device.
 
   If the signature is requested, this function verifies the signature of the measurement.
 
+  If the measurement cache is enabled with SpdmDataMeasurementCacheMaxAge, the blocks verified with a signature
+  or in a session are cached. A request for one measurement index without signature is served from the cache,
+  until the block is reused for the maximum age.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
                                        If SessionId is NULL, it is a normal message.
@@ -231,6 +293,275 @@ SpdmGetMeasurement (
      OUT VOID                 *MeasurementRecord
   );
 
+///
+/// How fresh a measurement returned by SpdmGetMeasurementEx is.
+///
+typedef enum {
+  //
+  // Recomputed by the responder for the request, as it advertises MEAS_FRESH_CAP.
+  //
+  SpdmMeasurementFreshnessFresh,
+  //
+  // Returned by the responder without MEAS_FRESH_CAP, as measured at its last reset
+  // or last runtime change.
+  //
+  SpdmMeasurementFreshnessReset,
+  //
+  // Served from the measurement cache of the requester, without sending a message.
+  //
+  SpdmMeasurementFreshnessCached,
+} SPDM_MEASUREMENT_FRESHNESS;
+
+/**
+  This function sends GET_MEASUREMENT to get measurement from the device,
+  and returns how fresh the measurement is.
+
+  It is SpdmGetMeasurement with Freshness. A verifier which accepts the measurements of the last reset
+  can use the measurement cache on purpose, as the responder without MEAS_FRESH_CAP returns the same blocks
+  until it is reset or its measurements change at runtime.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestAttribute             The request attribute of the request message.
+  @param  MeasurementOperation         The measurement operation of the request message.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  NumberOfBlocks               The number of blocks of the measurement record.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+  @param  Freshness                    How fresh the measurement record is.
+
+  @retval RETURN_SUCCESS               The measurement is got successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetMeasurementEx (
+  IN     VOID                       *SpdmContext,
+  IN     UINT32                     *SessionId,
+  IN     UINT8                      RequestAttribute,
+  IN     UINT8                      MeasurementOperation,
+  IN     UINT8                      SlotNum,
+     OUT UINT8                      *NumberOfBlocks,
+  IN OUT UINT32                     *MeasurementRecordLength,
+     OUT VOID                       *MeasurementRecord,
+     OUT SPDM_MEASUREMENT_FRESHNESS *Freshness OPTIONAL
+  );
+
+/**
+  This function gets the measurement blocks of a list of measurement indices,
+  and fetches from the device only the blocks which are not fresh in the measurement cache.
+
+  The stale blocks are fetched with one GET_MEASUREMENTS per index. If the signature is requested,
+  only the last GET_MEASUREMENTS requests it, and the signature covers all blocks fetched before.
+  If every block is fresh, no message is sent.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestAttribute             The request attribute of the last request message.
+  @param  SlotIdParam                  The number of slot for the certificate chain.
+  @param  IndexCount                   The number of measurement indices in IndexList.
+  @param  IndexList                    The measurement indices, from 1 to 0xFE.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+                                       It holds one block per index, in the order of IndexList.
+
+  @retval RETURN_SUCCESS               The measurement is got successfully.
+  @retval RETURN_INVALID_PARAMETER     A measurement index is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The measurement record buffer is too small.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetCachedMeasurements (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT8                RequestAttribute,
+  IN     UINT8                SlotIdParam,
+  IN     UINT8                IndexCount,
+  IN     UINT8                *IndexList,
+  IN OUT UINT32               *MeasurementRecordLength,
+     OUT VOID                 *MeasurementRecord
+  );
+
+///
+/// A measurement block returned by SpdmGetMeasurementRange, parsed in the measurement record.
+///
+typedef struct {
+  UINT8                                 Index;
+  UINT8                                 MeasurementSpecification;
+  //
+  // The DMTF measurement value, if MeasurementSpecification is SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF.
+  // Otherwise DmtfValueType and DmtfValueSize are 0, and DmtfValue is NULL.
+  //
+  UINT8                                 DmtfValueType;
+  UINT16                                DmtfValueSize;
+  UINT8                                 *DmtfValue;
+  //
+  // The whole measurement block.
+  //
+  UINT32                                BlockSize;
+  SPDM_MEASUREMENT_BLOCK_COMMON_HEADER  *Block;
+} SPDM_MEASUREMENT_BLOCK_INFO;
+
+/**
+  This function gets the measurement blocks of a set of measurement indices, with the fewest round trips and bytes.
+
+  It fetches either all blocks with one GET_MEASUREMENTS and keeps those of IndexList, or one block per
+  GET_MEASUREMENTS, whichever costs less. The cost of each GET_MEASUREMENTS is its request and response bytes,
+  plus one round trip for each message of the transport maximum message size (SpdmDataTransportMaxMessageSize)
+  the response takes. The block sizes and the number of blocks of the device are learned from the MEASUREMENTS
+  responses of the connection, and a block not seen yet is assumed to be a digest of the measurement hash algorithm.
+  Until the number of blocks is known, several indices are fetched all at once.
+  If SignatureRequired is TRUE, only the last GET_MEASUREMENTS requests a signature, and it covers all blocks fetched.
+  The measurement cache is not used.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  SignatureRequired            TRUE to request the signature of the measurements.
+  @param  SlotIdParam                  The number of slot for the certificate chain.
+  @param  IndexCount                   The number of measurement indices in IndexList.
+  @param  IndexList                    The measurement indices, from 1 to 0xFE.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+                                       It holds one block per index, in the order of IndexList.
+  @param  BlockList                    A pointer to IndexCount parsed blocks, in the order of IndexList.
+                                       They point to the measurement record.
+
+  @retval RETURN_SUCCESS               The measurement is got successfully.
+  @retval RETURN_INVALID_PARAMETER     A measurement index is invalid.
+  @retval RETURN_NOT_FOUND             The device has no block of a measurement index.
+  @retval RETURN_BUFFER_TOO_SMALL      The measurement record buffer is too small.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena is too small for the response.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetMeasurementRange (
+  IN     VOID                         *SpdmContext,
+  IN     UINT32                       *SessionId,
+  IN     BOOLEAN                      SignatureRequired,
+  IN     UINT8                        SlotIdParam,
+  IN     UINT8                        IndexCount,
+  IN     UINT8                        *IndexList,
+  IN OUT UINT32                       *MeasurementRecordLength,
+     OUT VOID                         *MeasurementRecord,
+     OUT SPDM_MEASUREMENT_BLOCK_INFO  *BlockList
+  );
+
+/**
+  This function gets the measurement blocks of a list of measurement indices, each with a signature,
+  and verifies each signature while the next GET_MEASUREMENTS is sent.
+
+  Each block is fetched with one GET_MEASUREMENTS requesting a signature over it. Once the asynchronous
+  verification functions are registered with SpdmRegisterRequesterVerifyAsyncFunc, up to
+  MAX_SPDM_PIPELINED_VERIFY_COUNT signatures are verified while the next requests are sent and received.
+  The L1L2 hash of each signature is taken before the next request, so the transcript is the same as with
+  SpdmGetMeasurement. The blocks are committed to the measurement cache in order, once they and all blocks
+  before are verified. Without the asynchronous verification functions, each signature is verified at once.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  SlotIdParam                  The number of slot for the certificate chain.
+  @param  IndexCount                   The number of measurement indices in IndexList.
+  @param  IndexList                    The measurement indices, from 1 to 0xFE.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+                                       It holds one block per index, in the order of IndexList.
+                                       It is valid only if RETURN_SUCCESS is returned.
+
+  @retval RETURN_SUCCESS               The measurement is got and verified successfully.
+  @retval RETURN_INVALID_PARAMETER     A measurement index is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The measurement record buffer is too small.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena is too small for the response.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetMeasurementsPipelined (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT8                SlotIdParam,
+  IN     UINT8                IndexCount,
+  IN     UINT8                *IndexList,
+  IN OUT UINT32               *MeasurementRecordLength,
+     OUT VOID                 *MeasurementRecord
+  );
+
+/**
+  Receive one measurement block streamed by SpdmGetMeasurementStream.
+
+  If the signature is requested, the block is not verified until SpdmGetMeasurementStream returns RETURN_SUCCESS.
+
+  @param  BlockContext                 The context passed to SpdmGetMeasurementStream.
+  @param  MeasurementIndex             The measurement index of the block, starting from 1.
+  @param  MeasurementBlockSize         Size in bytes of the measurement block.
+  @param  MeasurementBlock             A pointer to the measurement block. It is valid only until the function returns.
+
+  @retval RETURN_SUCCESS               The block is consumed, and the stream continues.
+  @retval others                       The stream is stopped, and SpdmGetMeasurementStream returns the status.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_MEASUREMENT_BLOCK_FUNC) (
+  IN     VOID                 *BlockContext,
+  IN     UINT8                MeasurementIndex,
+  IN     UINTN                MeasurementBlockSize,
+  IN     VOID                 *MeasurementBlock
+  );
+
+/**
+  This function gets the measurement blocks of the device one by one, and hands each block to BlockFunc as it arrives.
+
+  The count is fetched first, and then each block with one GET_MEASUREMENTS per index, in a response buffer
+  taken from the scratch arena. If the signature is requested, only the last GET_MEASUREMENTS requests it,
+  and the signature covers all blocks fetched before. No measurement record is assembled, so the total size
+  of the blocks is not bounded. Each block is bounded by one MEASUREMENTS response, which may be retrieved by CHUNK_GET.
+  The measurement cache is not used.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestAttribute             The request attribute of the last request message.
+  @param  SlotIdParam                  The number of slot for the certificate chain.
+  @param  BlockFunc                    The function to receive each measurement block.
+  @param  BlockContext                 The context passed to BlockFunc.
+  @param  NumberOfBlocks               The number of measurement blocks of the device.
+
+  @retval RETURN_SUCCESS               All measurement blocks are received, and verified if the signature is requested.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena is too small for the response.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval others                       The status returned by BlockFunc to stop the stream.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetMeasurementStream (
+  IN     VOID                         *SpdmContext,
+  IN     UINT32                       *SessionId,
+  IN     UINT8                        RequestAttribute,
+  IN     UINT8                        SlotIdParam,
+  IN     SPDM_MEASUREMENT_BLOCK_FUNC  BlockFunc,
+  IN     VOID                         *BlockContext OPTIONAL,
+     OUT UINT8                        *NumberOfBlocks
+  );
+
 /**
   This function sends KEY_EXCHANGE/FINISH or PSK_EXCHANGE/PSK_FINISH
   to start an SPDM Session.
@@ -263,6 +594,32 @@ SpdmStartSession (
      OUT VOID                 *MeasurementHash
   );
 
+/**
+  This function prepares KEY_EXCHANGE requests ahead of SpdmStartSession.
+
+  Each prepared request holds the random data and the DHE key pair of the negotiated DHENamedGroup.
+  The DHE key pair is taken from the DHE key pool if one is registered.
+  The next SpdmStartSession with UsePsk FALSE takes a prepared request, so that only the session ID
+  and the opaque data are built before the KEY_EXCHANGE is sent.
+  It may be called while the integrator waits for other I/O, but it must not be called concurrently
+  with another function of the same SPDM context.
+  The prepared requests of another DHENamedGroup, such as those of a previous connection, are freed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Count                        The number of prepared requests to have, up to MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT.
+
+  @retval RETURN_SUCCESS               Count requests are prepared.
+  @retval RETURN_INVALID_PARAMETER     Count is larger than MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT.
+  @retval RETURN_UNSUPPORTED           The algorithms are not negotiated, or KEY_EXCHANGE is not supported.
+  @retval RETURN_OUT_OF_RESOURCES      A DHE key pair cannot be generated.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPrestageKeyExchange (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                Count
+  );
+
 /**
   This function sends END_SESSION
   to stop an SPDM Session.
@@ -323,108 +680,859 @@ SpdmSendReceiveData (
   );
 
 /**
-  This function sends HEARTBEAT
-  to an SPDM Session.
+  Return the room that SpdmSendReceiveDataStream needs around the APP messages of a session.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  SessionId                    The session ID of the session.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  Headroom                     Size in bytes of the room before the APP message.
+  @param  Tailroom                     Size in bytes of the room after the APP message.
 
-  @retval RETURN_SUCCESS               The heartbeat is sent and received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
-  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval RETURN_SUCCESS               The room is returned successfully.
+  @retval RETURN_UNSUPPORTED           The transport layer cannot encode the APP message in place.
 **/
 RETURN_STATUS
 EFIAPI
-SpdmHeartbeat (
+SpdmGetDataStreamRoom (
   IN     VOID                 *SpdmContext,
-  IN     UINT32               SessionId
+  IN     UINT32               SessionId,
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
   );
 
 /**
-  This function sends KEY_UPDATE
-  to update keys for an SPDM Session.
+  Send and receive an APP message of a session, in chained records encoded in place in the caller buffers.
 
-  After keys are updated, this function also uses VERIFY_NEW_KEY to verify the key.
+  Unlike SpdmSendReceiveData, the APP messages are not staged in a MAX_SPDM_MESSAGE_BUFFER_SIZE buffer,
+  so they can be larger than it.
+  An APP message is sent as consecutive records of RecordSize bytes, and ends with a record of less than
+  RecordSize bytes. An APP message of a multiple of RecordSize bytes ends with an empty record.
+  The response is received the same way.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  SessionId                    The session ID of the session.
-  @param  SingleDirection              TRUE means the operation is UPDATE_KEY.
-                                       FALSE means the operation is UPDATE_ALL_KEYS.
-
-  @retval RETURN_SUCCESS               The keys of the session are updated.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  RecordSize                   Size in bytes of the APP message in each full record.
+  @param  Request                      A pointer to the request buffer of Headroom + RequestSize + Tailroom bytes,
+                                       with the request at Headroom bytes.
+                                       The request buffer is overwritten by the records sent.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Response                     A pointer to the response buffer.
+                                       On output, the response is at Headroom bytes.
+  @param  ResponseSize                 On input, it means the size in bytes of the response buffer.
+                                       On output, it means the size in bytes of the response.
+
+  @retval RETURN_SUCCESS               The APP message is sent and received successfully.
+  @retval RETURN_INVALID_PARAMETER     The RecordSize is zero.
+  @retval RETURN_UNSUPPORTED           The transport layer cannot encode the APP message in place.
+  @retval RETURN_BUFFER_TOO_SMALL      The response buffer is too small to hold the response.
   @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
-  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
 **/
 RETURN_STATUS
 EFIAPI
-SpdmKeyUpdate (
+SpdmSendReceiveDataStream (
   IN     VOID                 *SpdmContext,
   IN     UINT32               SessionId,
-  IN     BOOLEAN              SingleDirection
+  IN     UINTN                RecordSize,
+  IN OUT VOID                 *Request,
+  IN     UINTN                RequestSize,
+  IN OUT VOID                 *Response,
+  IN OUT UINTN                *ResponseSize
   );
 
 /**
-  This function executes a series of SPDM encapsulated requests and receives SPDM encapsulated responses.
+  This function starts to initialize an SPDM connection with SpdmRequesterStep.
 
-  This function starts with the first encapsulated request (such as GET_ENCAPSULATED_REQUEST)
-  and ends with last encapsulated response (such as RESPONSE_PAYLOAD_TYPE_ABSENT or RESPONSE_PAYLOAD_TYPE_SLOT_NUMBER).
+  The messages are the same as SpdmInitConnection.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  SessionId                    Indicate if the encapsulated request is a secured message.
-                                       If SessionId is NULL, it is a normal message.
-                                       If SessionId is NOT NULL, it is a secured message.
+  @param  GetVersionOnly               If the requester sends GET_VERSION only or not.
 
-  @retval RETURN_SUCCESS               The SPDM Encapsulated requests are sent and the responses are received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
 **/
 RETURN_STATUS
 EFIAPI
-SpdmSendReceiveEncapsulatedRequest (
+SpdmRequesterBeginInitConnection (
   IN     VOID                 *SpdmContext,
-  IN     UINT32               *SessionId
+  IN     BOOLEAN              GetVersionOnly
   );
 
 /**
-  Process the encapsulated request and return the encapsulated response.
+  This function starts to get all digest of the certificate chains with SpdmRequesterStep.
+
+  The messages are the same as SpdmGetDigest.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  SpdmRequestSize              Size in bytes of the request data.
-  @param  SpdmRequest                  A pointer to the request data.
-  @param  SpdmResponseSize             Size in bytes of the response data.
-                                       On input, it means the size in bytes of response data buffer.
-                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
-                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
-  @param  SpdmResponse                 A pointer to the response data.
+  @param  SlotMask                     The slots which deploy the CertificateChain.
+  @param  TotalDigestBuffer            A pointer to a destination buffer to store the digest buffer.
 
-  @retval RETURN_SUCCESS               The request is processed and the response is returned.
-  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
-  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
 **/
-typedef
 RETURN_STATUS
-(EFIAPI *SPDM_GET_ENCAP_RESPONSE_FUNC) (
+EFIAPI
+SpdmRequesterBeginGetDigest (
   IN     VOID                 *SpdmContext,
-  IN     UINTN                SpdmRequestSize,
-  IN     VOID                 *SpdmRequest,
-  IN OUT UINTN                *SpdmResponseSize,
-     OUT VOID                 *SpdmResponse
+     OUT UINT8                *SlotMask,
+     OUT VOID                 *TotalDigestBuffer
   );
 
 /**
-  Register an SPDM encapsulated message process function.
+  This function starts to get the certificate chain of one slot with SpdmRequesterStep.
 
-  If the default encapsulated message process function cannot handle the encapsulated message,
-  this function will be invoked.
+  The messages are the same as SpdmGetCertificate.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  GetEncapResponseFunc         The function to process the encapsuled message.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  CertChainSize                On input, indicate the size in bytes of the destination buffer to store the digest buffer.
+                                       On output, indicate the size in bytes of the certificate chain.
+  @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
+
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
 **/
-VOID
+RETURN_STATUS
 EFIAPI
-SpdmRegisterGetEncapResponseFunc (
-  IN  VOID                          *SpdmContext,
-  IN  SPDM_GET_ENCAP_RESPONSE_FUNC  GetEncapResponseFunc
+SpdmRequesterBeginGetCertificate (
+  IN     VOID                 *SpdmContext,
+  IN     UINT8                SlotNum,
+  IN OUT UINTN                *CertChainSize,
+     OUT VOID                 *CertChain
+  );
+
+/**
+  This function starts to authenticate the device with CHALLENGE with SpdmRequesterStep.
+
+  The messages are the same as SpdmChallenge.
+  The basic mutual authentication is not supported, and RETURN_UNSUPPORTED is returned if the responder requests it.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the challenge.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterBeginChallenge (
+  IN     VOID                 *SpdmContext,
+  IN     UINT8                SlotNum,
+  IN     UINT8                MeasurementHashType,
+     OUT VOID                 *MeasurementHash
+  );
+
+/**
+  This function starts to start an SPDM session with SpdmRequesterStep.
+
+  The messages are the same as SpdmStartSession.
+  The encapsulated mutual authentication is not supported, and RETURN_UNSUPPORTED is returned if the responder requests it.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  UsePsk                       FALSE means to use KEY_EXCHANGE/FINISH to start a session.
+                                       TRUE means to use PSK_EXCHANGE/PSK_FINISH to start a session.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  SessionId                    The session ID of the session.
+  @param  HeartbeatPeriod              The heartbeat period for the session.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterBeginStartSession (
+  IN     VOID                 *SpdmContext,
+  IN     BOOLEAN              UsePsk,
+  IN     UINT8                MeasurementHashType,
+  IN     UINT8                SlotNum,
+     OUT UINT32               *SessionId,
+     OUT UINT8                *HeartbeatPeriod,
+     OUT VOID                 *MeasurementHash
+  );
+
+/**
+  This function starts to send and receive an SPDM or APP message with SpdmRequesterStep.
+
+  The messages are the same as SpdmSendReceiveData, except that the key update policy of the session is not run.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  Request                      A pointer to the request data.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Response                     A pointer to the response data.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer once the operation completes.
+
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterBeginSendReceiveData (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     VOID                 *Request,
+  IN     UINTN                RequestSize,
+     OUT VOID                 *Response,
+  IN OUT UINTN                *ResponseSize
+  );
+
+/**
+  This function aborts the operation started by a SpdmRequesterBegin function.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+EFIAPI
+SpdmRequesterAbort (
+  IN     VOID                 *SpdmContext
+  );
+
+/**
+  This function drives the operation started by a SpdmRequesterBegin function by one message.
+
+  The caller owns the transport. It sends each outgoing message, and passes each received message back,
+  so that the requester never blocks in SendMessage or ReceiveMessage.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IncomingMessageSize          Size in bytes of the incoming transport layer message.
+  @param  IncomingMessage              A pointer to the transport layer message received for the last outgoing message.
+                                       It is NULL for the first call after a SpdmRequesterBegin function.
+  @param  OutgoingMessageSize          On input, the size in bytes of the outgoing message buffer.
+                                       On output, the size in bytes of the outgoing transport layer message,
+                                       or 0 if there is no message to send.
+  @param  OutgoingMessage              A pointer to a destination buffer to store the outgoing transport layer message.
+
+  @retval RETURN_NOT_READY             The outgoing message needs to be sent, and its response passed to the next call.
+  @retval RETURN_SUCCESS               The operation completes.
+  @retval RETURN_NOT_STARTED           No operation is in progress.
+  @retval RETURN_INVALID_PARAMETER     The incoming message is missing, or is not expected.
+  @retval others                       The operation fails, and it ends.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterStep (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                IncomingMessageSize,
+  IN     VOID                 *IncomingMessage OPTIONAL,
+  IN OUT UINTN                *OutgoingMessageSize,
+     OUT VOID                 *OutgoingMessage
+  );
+
+/**
+  Acquire or release the lock of a requester pool.
+
+  @param  LockContext                  The context registered with the lock functions.
+**/
+typedef
+VOID
+(EFIAPI *SPDM_REQUESTER_POOL_LOCK_FUNC) (
+  IN     VOID                 *LockContext
+  );
+
+/**
+  Return the size in bytes of a requester pool.
+
+  @param  EndpointCount                The number of endpoints in the pool.
+
+  @return the size in bytes of the requester pool.
+**/
+UINTN
+EFIAPI
+SpdmRequesterPoolGetSize (
+  IN     UINTN                EndpointCount
+  );
+
+/**
+  Initialize a requester pool.
+
+  The size in bytes of the pool can be returned by SpdmRequesterPoolGetSize.
+  The pool holds one SPDM context per endpoint, initialized by SpdmInitContext.
+  If SpdmRequesterPoolRun is called by multiple workers concurrently,
+  AcquireLock and ReleaseLock must be provided to serialize the scheduling of the endpoints.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  EndpointCount                The number of endpoints in the pool.
+  @param  PollTimeout                  The timeout passed to ReceiveMessage to poll an endpoint, in units of 100ns.
+                                       It must not be 0, because 0 waits for the response indefinitely.
+  @param  AcquireLock                  The function to acquire the pool lock, or NULL.
+  @param  ReleaseLock                  The function to release the pool lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+
+  @retval RETURN_SUCCESS               The pool is initialized.
+  @retval RETURN_INVALID_PARAMETER     EndpointCount or PollTimeout is 0.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolInit (
+  IN     VOID                           *Pool,
+  IN     UINTN                          EndpointCount,
+  IN     UINT64                         PollTimeout,
+  IN     SPDM_REQUESTER_POOL_LOCK_FUNC  AcquireLock OPTIONAL,
+  IN     SPDM_REQUESTER_POOL_LOCK_FUNC  ReleaseLock OPTIONAL,
+  IN     VOID                           *LockContext OPTIONAL
+  );
+
+/**
+  Return the SPDM context of an endpoint in a requester pool.
+
+  The caller registers the device IO and the transport layer functions of the endpoint with the context.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  EndpointIndex                The index of the endpoint.
+
+  @return the SPDM context of the endpoint, or NULL if EndpointIndex is out of range.
+**/
+VOID *
+EFIAPI
+SpdmRequesterPoolGetContext (
+  IN     VOID                 *Pool,
+  IN     UINTN                EndpointIndex
+  );
+
+/**
+  Set the local configuration shared by all endpoints of a requester pool.
+
+  It calls SpdmSetData for the SPDM context of each endpoint, such as the capabilities, the algorithms,
+  the local certificate chains and the peer root certificate hash.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  DataType                     Type of the SPDM context data.
+  @param  Parameter                    Type specific parameter of the SPDM context data.
+  @param  Data                         A pointer to the SPDM context data.
+  @param  DataSize                     Size in bytes of the SPDM context data.
+
+  @retval RETURN_SUCCESS               The SPDM context data is set for all endpoints.
+  @retval others                       SpdmSetData fails for an endpoint.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolSetData (
+  IN     VOID                 *Pool,
+  IN     SPDM_DATA_TYPE       DataType,
+  IN     SPDM_DATA_PARAMETER  *Parameter,
+  IN     VOID                 *Data,
+  IN     UINTN                DataSize
+  );
+
+/**
+  Set the attestation of an endpoint of a requester pool.
+
+  SpdmRequesterPoolRun attests the endpoint with InitConnection, GetDigest, GetCertificate and Challenge.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  EndpointIndex                The index of the endpoint.
+  @param  SlotNum                      The number of slot for the certificate chain and the challenge.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  CertChainSize                On input, indicate the size in bytes of the destination buffer to store the certificate chain.
+                                       On output, indicate the size in bytes of the certificate chain.
+  @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+
+  @retval RETURN_SUCCESS               The attestation is set.
+  @retval RETURN_INVALID_PARAMETER     EndpointIndex is out of range.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolSetAttestation (
+  IN     VOID                 *Pool,
+  IN     UINTN                EndpointIndex,
+  IN     UINT8                SlotNum,
+  IN     UINT8                MeasurementHashType,
+  IN OUT UINTN                *CertChainSize,
+     OUT VOID                 *CertChain,
+     OUT VOID                 *MeasurementHash
+  );
+
+/**
+  Attest all endpoints of a requester pool.
+
+  The endpoints are driven by SpdmRequesterStep in turn. While one endpoint waits for its response,
+  the others send requests and verify responses, so that the IO waits overlap with the verification.
+  Multiple workers may call this function with the same pool concurrently. It returns when all endpoints are done.
+
+  @param  Pool                         A pointer to the requester pool.
+
+  @retval RETURN_SUCCESS               All endpoints are attested.
+  @retval others                       The status of the first endpoint failing the attestation.
+                                       The status of each endpoint can be returned by SpdmRequesterPoolGetStatus.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolRun (
+  IN     VOID                 *Pool
+  );
+
+/**
+  Return the attestation status of an endpoint of a requester pool.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  EndpointIndex                The index of the endpoint.
+
+  @retval RETURN_SUCCESS               The endpoint is attested.
+  @retval RETURN_NOT_READY             The attestation of the endpoint is in progress, or is not run.
+  @retval RETURN_NOT_STARTED           The attestation of the endpoint is not set by SpdmRequesterPoolSetAttestation.
+  @retval RETURN_INVALID_PARAMETER     EndpointIndex is out of range.
+  @retval others                       The attestation of the endpoint fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolGetStatus (
+  IN     VOID                 *Pool,
+  IN     UINTN                EndpointIndex
+  );
+
+/**
+  This function sends HEARTBEAT
+  to an SPDM Session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+
+  @retval RETURN_SUCCESS               The heartbeat is sent and received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmHeartbeat (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               SessionId
+  );
+
+/**
+  Send the heartbeats due for the sessions of an SPDM context.
+
+  The heartbeat of an established session with a heartbeat period is due once half of the period passed
+  since the last secured message received in the session, and it must be sent before the whole period passed.
+  So the application messages of a session postpone its heartbeat, and the heartbeats of all sessions
+  which are due are sent on one wakeup, the earliest time a heartbeat must be sent.
+  The time function must be registered by SpdmRegisterRequesterMonitorFunc.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  NextWakeupTime               Return the earliest time a heartbeat must be sent, in 100ns units,
+                                       or 0 if no session has a heartbeat.
+                                       It is already passed if the heartbeat of a session failed.
+
+  @retval RETURN_SUCCESS               The due heartbeats are sent.
+  @retval RETURN_NOT_STARTED           No time function is registered.
+  @retval others                       The status of the first heartbeat failing. The other heartbeats are still sent.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRunHeartbeats (
+  IN     VOID                 *SpdmContext,
+     OUT UINT64               *NextWakeupTime
+  );
+
+/**
+  Send the heartbeats due for the sessions of all endpoints of a requester pool.
+
+  It calls SpdmRunHeartbeats for each endpoint which is not serviced by a worker of SpdmRequesterPoolRun,
+  so that the heartbeats of all endpoints are sent on one wakeup.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  NextWakeupTime               Return the earliest time a heartbeat must be sent, in 100ns units,
+                                       or 0 if no session has a heartbeat.
+
+  @retval RETURN_SUCCESS               The due heartbeats are sent.
+  @retval others                       The status of the first endpoint failing a heartbeat.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolRunHeartbeats (
+  IN     VOID                 *Pool,
+     OUT UINT64               *NextWakeupTime
+  );
+
+/**
+  This function sends KEY_UPDATE
+  to update keys for an SPDM Session.
+
+  After keys are updated, this function also uses VERIFY_NEW_KEY to verify the key.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+  @param  SingleDirection              TRUE means the operation is UPDATE_KEY.
+                                       FALSE means the operation is UPDATE_ALL_KEYS.
+
+  @retval RETURN_SUCCESS               The keys of the session are updated.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmKeyUpdate (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     BOOLEAN              SingleDirection
+  );
+
+/**
+  Configure the warm session pool of an SPDM context.
+
+  The pool keeps TargetCount sessions established ahead of time, so that SpdmAcquirePooledSession
+  hands out a session without the KEY_EXCHANGE/FINISH or PSK_EXCHANGE/PSK_FINISH latency.
+  The sessions are established and maintained by SpdmRunSessionPool.
+  A TargetCount of 0 disables the pool. The idle sessions beyond TargetCount are ended by SpdmRunSessionPool.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  TargetCount                  The number of sessions to keep established, up to the session count of the context.
+  @param  UsePsk                       FALSE means to use KEY_EXCHANGE/FINISH to start a session.
+                                       TRUE means to use PSK_EXCHANGE/PSK_FINISH to start a session.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  SlotNum                      The number of slot for the certificate chain.
+
+  @retval RETURN_SUCCESS               The pool is configured.
+  @retval RETURN_INVALID_PARAMETER     TargetCount is larger than the session count of the context.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmConfigureSessionPool (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                TargetCount,
+  IN     BOOLEAN              UsePsk,
+  IN     UINT8                MeasurementHashType,
+  IN     UINT8                SlotNum
+  );
+
+/**
+  Maintain the warm session pool of an SPDM context.
+
+  The idle sessions which are no longer established are dropped, and the keys of the idle sessions
+  are updated ahead of time by their key update policy. Then new sessions are established up to the target count,
+  and the due heartbeats are sent by SpdmRunHeartbeats. The idle sessions whose heartbeat failed are dropped,
+  to be established again on the next run.
+
+  The library does not run it in the background. The integrator calls it from an idle loop or a timer,
+  before NextWakeupTime. The functions of one SPDM context must not be called concurrently.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  NextWakeupTime               Return the earliest time a heartbeat must be sent, in 100ns units,
+                                       or 0 if no session has a heartbeat.
+                                       It is already passed if the heartbeat of a session failed.
+
+  @retval RETURN_SUCCESS               The pool has the target count of sessions.
+  @retval others                       The status of the first failure. The pool may have fewer sessions than
+                                       the target count, and the other sessions are still maintained.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRunSessionPool (
+  IN     VOID                 *SpdmContext,
+     OUT UINT64               *NextWakeupTime
+  );
+
+/**
+  Take an idle session of the warm session pool, for SpdmSendReceiveData.
+
+  If no session is idle, and the pool has fewer sessions than the target count,
+  a session is established on demand.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Return the session ID of the session.
+
+  @retval RETURN_SUCCESS               The session is taken. It must be returned by SpdmReleasePooledSession.
+  @retval RETURN_NOT_STARTED           The pool is not configured.
+  @retval RETURN_NOT_READY             All sessions of the pool are in use.
+  @retval others                       No session is idle, and a session cannot be established on demand.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAcquirePooledSession (
+  IN     VOID                 *SpdmContext,
+     OUT UINT32               *SessionId
+  );
+
+/**
+  Return a session taken by SpdmAcquirePooledSession to the warm session pool.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+  @param  EndSession                   TRUE to end the session with END_SESSION, such as after a failure in the session.
+                                       SpdmRunSessionPool establishes a new session in its place.
+
+  @retval RETURN_SUCCESS               The session is returned to the pool, or ended.
+  @retval RETURN_NOT_FOUND             The session is not taken from the pool, or it is already ended.
+  @retval others                       END_SESSION fails. The session is freed anyway.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmReleasePooledSession (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     BOOLEAN              EndSession
+  );
+
+///
+/// A request queued on a channel of a session multiplexer by SpdmMuxSubmit.
+/// The request, the response and ResponseSize are the parameters of SpdmSendReceiveData.
+/// The caller keeps them until Status is no longer RETURN_NOT_READY.
+///
+typedef struct {
+  BOOLEAN              IsAppMessage;
+  VOID                 *Request;
+  UINTN                RequestSize;
+  VOID                 *Response;
+  UINTN                *ResponseSize;
+  RETURN_STATUS        Status;
+} SPDM_MUX_REQUEST;
+
+/**
+  Return the size in bytes of a session multiplexer.
+
+  @param  ChannelCount                 The number of channels of the multiplexer.
+  @param  QueueDepth                   The number of requests each channel can queue.
+
+  @return the size in bytes of the session multiplexer.
+**/
+UINTN
+EFIAPI
+SpdmMuxGetSize (
+  IN     UINTN                ChannelCount,
+  IN     UINTN                QueueDepth
+  );
+
+/**
+  Initialize a session multiplexer over an established session.
+
+  The multiplexer shares the session between logical channels. The requests of the control channels are
+  dispatched first, in the order of the channels, and the requests of the bulk channels share the rest
+  by weighted fair queuing. All channels are bulk channels of weight 1 until SpdmMuxConfigureChannel.
+  The size in bytes of the multiplexer can be returned by SpdmMuxGetSize.
+  If SpdmMuxSubmit is called concurrently with SpdmMuxDispatch or SpdmMuxRun,
+  AcquireLock and ReleaseLock must be provided to serialize the queues.
+
+  @param  Mux                          A pointer to the session multiplexer.
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  ChannelCount                 The number of channels of the multiplexer.
+  @param  QueueDepth                   The number of requests each channel can queue.
+  @param  AcquireLock                  The function to acquire the queue lock, or NULL.
+  @param  ReleaseLock                  The function to release the queue lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+
+  @retval RETURN_SUCCESS               The multiplexer is initialized.
+  @retval RETURN_INVALID_PARAMETER     ChannelCount or QueueDepth is 0.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmMuxInit (
+  IN     VOID                           *Mux,
+  IN     VOID                           *SpdmContext,
+  IN     UINT32                         SessionId,
+  IN     UINTN                          ChannelCount,
+  IN     UINTN                          QueueDepth,
+  IN     SPDM_REQUESTER_POOL_LOCK_FUNC  AcquireLock OPTIONAL,
+  IN     SPDM_REQUESTER_POOL_LOCK_FUNC  ReleaseLock OPTIONAL,
+  IN     VOID                           *LockContext OPTIONAL
+  );
+
+/**
+  Configure a channel of a session multiplexer.
+
+  @param  Mux                          A pointer to the session multiplexer.
+  @param  ChannelIndex                 The index of the channel.
+  @param  IsControl                    TRUE for a control channel, dispatched before all bulk channels.
+  @param  Weight                       The share of a bulk channel, relative to the other bulk channels.
+                                       It is ignored for a control channel.
+
+  @retval RETURN_SUCCESS               The channel is configured.
+  @retval RETURN_INVALID_PARAMETER     ChannelIndex is out of range, or Weight is 0 for a bulk channel.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmMuxConfigureChannel (
+  IN     VOID                 *Mux,
+  IN     UINTN                ChannelIndex,
+  IN     BOOLEAN              IsControl,
+  IN     UINT32               Weight
+  );
+
+/**
+  Queue a request on a channel of a session multiplexer.
+
+  The cost of a request on a bulk channel is its RequestSize plus the size of its response buffer.
+
+  @param  Mux                          A pointer to the session multiplexer.
+  @param  ChannelIndex                 The index of the channel.
+  @param  Request                      The request. Its Status is RETURN_NOT_READY until it is dispatched.
+
+  @retval RETURN_SUCCESS               The request is queued.
+  @retval RETURN_INVALID_PARAMETER     ChannelIndex is out of range.
+  @retval RETURN_OUT_OF_RESOURCES      The queue of the channel is full.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmMuxSubmit (
+  IN     VOID                 *Mux,
+  IN     UINTN                ChannelIndex,
+  IN OUT SPDM_MUX_REQUEST     *Request
+  );
+
+/**
+  Dispatch the next request of a session multiplexer with SpdmSendReceiveData.
+
+  The due heartbeats are sent first by SpdmRunHeartbeats, if a time function is registered.
+  Then the first request of the first control channel with a request is dispatched. Otherwise the bulk request
+  with the lowest finish tag is dispatched, which is the time it would finish if the bulk channels with requests
+  were served in parallel in proportion to their weights.
+  A request being dispatched is not preempted, so a control request waits for at most one bulk request,
+  of up to MAX_SPDM_MESSAGE_BUFFER_SIZE bytes each way, and the control requests before it.
+  The functions of one SPDM context must not be called concurrently.
+
+  @param  Mux                          A pointer to the session multiplexer.
+
+  @retval RETURN_SUCCESS               A request is dispatched. Its result is in its Status.
+  @retval RETURN_NOT_FOUND             No request is queued.
+  @retval others                       A heartbeat fails. No request is dispatched.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmMuxDispatch (
+  IN     VOID                 *Mux
+  );
+
+/**
+  Dispatch the requests of a session multiplexer with SpdmMuxDispatch, until no request is queued.
+
+  @param  Mux                          A pointer to the session multiplexer.
+
+  @retval RETURN_SUCCESS               All requests are dispatched. The result of each request is in its Status.
+  @retval others                       A heartbeat fails. The requests not dispatched are still queued.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmMuxRun (
+  IN     VOID                 *Mux
+  );
+
+/**
+  This function executes a series of SPDM encapsulated requests and receives SPDM encapsulated responses.
+
+  This function starts with the first encapsulated request (such as GET_ENCAPSULATED_REQUEST)
+  and ends with last encapsulated response (such as RESPONSE_PAYLOAD_TYPE_ABSENT or RESPONSE_PAYLOAD_TYPE_SLOT_NUMBER).
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicate if the encapsulated request is a secured message.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+
+  @retval RETURN_SUCCESS               The SPDM Encapsulated requests are sent and the responses are received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmSendReceiveEncapsulatedRequest (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId
+  );
+
+/**
+  Process the encapsulated request and return the encapsulated response.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SpdmRequestSize              Size in bytes of the request data.
+  @param  SpdmRequest                  A pointer to the request data.
+  @param  SpdmResponseSize             Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+  @param  SpdmResponse                 A pointer to the response data.
+
+  @retval RETURN_SUCCESS               The request is processed and the response is returned.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_GET_ENCAP_RESPONSE_FUNC) (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                SpdmRequestSize,
+  IN     VOID                 *SpdmRequest,
+  IN OUT UINTN                *SpdmResponseSize,
+     OUT VOID                 *SpdmResponse
+  );
+
+/**
+  Register an SPDM encapsulated message process function.
+
+  If the default encapsulated message process function cannot handle the encapsulated message,
+  this function will be invoked.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  GetEncapResponseFunc         The function to process the encapsuled message.
+**/
+VOID
+EFIAPI
+SpdmRegisterGetEncapResponseFunc (
+  IN  VOID                          *SpdmContext,
+  IN  SPDM_GET_ENCAP_RESPONSE_FUNC  GetEncapResponseFunc
+  );
+
+/**
+  Return the time used by the requester statistics and the heartbeat scheduler.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the monotonic time, in 100ns units.
+**/
+typedef
+UINT64
+(EFIAPI *SPDM_REQUESTER_GET_TIME_FUNC) (
+  IN     VOID                 *SpdmContext
+  );
+
+/**
+  Notify that an SPDM request is sent, or an SPDM response is received.
+
+  It is called after the transport layer, with the SPDM message in plain text.
+  It is not called for APP messages.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of a secured message, or NULL for a normal message.
+  @param  IsRequester                  TRUE for a request sent, FALSE for a response received.
+  @param  Status                       The status of the transport layer.
+  @param  MessageSize                  Size in bytes of the SPDM message.
+  @param  Message                      A pointer to the SPDM message. It is not valid if Status is an error.
+**/
+typedef
+VOID
+(EFIAPI *SPDM_REQUESTER_MONITOR_FUNC) (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsRequester,
+  IN     RETURN_STATUS        Status,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message
+  );
+
+/**
+  Register the requester monitor functions.
+
+  Both functions are optional.
+  The time function enables the latencies of the requester statistics, if OPENSPDM_REQUESTER_STATS_SUPPORT is 1,
+  and SpdmRunHeartbeats.
+  The monitor function is called for each SPDM request sent and each SPDM response received.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  GetTimeFunc                  The function to return the time, or NULL.
+  @param  MonitorFunc                  The function to notify the SPDM messages, or NULL.
+**/
+VOID
+EFIAPI
+SpdmRegisterRequesterMonitorFunc (
+  IN  VOID                          *SpdmContext,
+  IN  SPDM_REQUESTER_GET_TIME_FUNC  GetTimeFunc,
+  IN  SPDM_REQUESTER_MONITOR_FUNC   MonitorFunc
   );
 
 /**
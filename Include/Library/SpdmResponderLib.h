@@ -65,6 +65,117 @@ SpdmRegisterGetResponseFunc (
   IN  SPDM_GET_RESPONSE_FUNC  GetResponseFunc
   );
 
+/**
+  Register the handler of an SPDM request code.
+
+  The handler takes precedence over the built-in handler of the request code and over the function
+  registered by SpdmRegisterGetResponseFunc. The request is dispatched to it directly by its request code.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  RequestHandler               The function to process the request, or NULL to restore the built-in handler.
+
+  @retval RETURN_SUCCESS               The handler is registered.
+  @retval RETURN_INVALID_PARAMETER     RequestCode is not a request code, or it is RESPOND_IF_READY.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRegisterRequestHandler (
+  IN  VOID                    *SpdmContext,
+  IN  UINT8                   RequestCode,
+  IN  SPDM_GET_RESPONSE_FUNC  RequestHandler
+  );
+
+/**
+  Register the handler of the VENDOR_DEFINED_REQUEST of a standard ID and a vendor ID.
+
+  The handler takes precedence over the handler registered for the VENDOR_DEFINED_REQUEST request code.
+  Registering the same standard ID and vendor ID again overrides the handler.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StandardId                   The standard ID of the request.
+  @param  VendorIdLen                  Size in bytes of the vendor ID.
+  @param  VendorId                     A pointer to the vendor ID.
+  @param  RequestHandler               The function to process the request, or NULL to unregister the handler.
+
+  @retval RETURN_SUCCESS               The handler is registered or unregistered.
+  @retval RETURN_INVALID_PARAMETER     VendorIdLen is larger than MAX_SPDM_VENDOR_ID_LENGTH.
+  @retval RETURN_NOT_FOUND             The handler to unregister is not registered.
+  @retval RETURN_ALREADY_STARTED       No enough memory to register the handler.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRegisterVendorDefinedHandler (
+  IN  VOID                    *SpdmContext,
+  IN  UINT16                  StandardId,
+  IN  UINT8                   VendorIdLen,
+  IN  VOID                    *VendorId,
+  IN  SPDM_GET_RESPONSE_FUNC  RequestHandler
+  );
+
+/**
+  Process the payload of a VENDOR_DEFINED_REQUEST, and return the payload of the VENDOR_DEFINED_RESPONSE.
+
+  The request payload is a view into the decoded request, and the response payload is built in place
+  in the transport message, so neither is copied. The VENDOR_DEFINED_RESPONSE header is built by the library.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  StandardId                   The standard ID of the request.
+  @param  VendorIdLen                  Size in bytes of the vendor ID.
+  @param  VendorId                     A pointer to the vendor ID.
+  @param  RequestPayloadSize           Size in bytes of the request payload.
+  @param  RequestPayload               A pointer to the request payload. It is valid only until the function returns.
+  @param  ResponsePayloadSize          On input, the size in bytes of the response payload buffer.
+                                       On output, the size in bytes of the response payload.
+  @param  ResponsePayload              A pointer to the response payload buffer.
+
+  @retval RETURN_SUCCESS               The response payload is returned.
+  @retval others                       The request is answered with ERROR(UnsupportedRequest).
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_VENDOR_PAYLOAD_FUNC) (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT16               StandardId,
+  IN     UINT8                VendorIdLen,
+  IN     CONST VOID           *VendorId,
+  IN     UINTN                RequestPayloadSize,
+  IN     CONST VOID           *RequestPayload,
+  IN OUT UINTN                *ResponsePayloadSize,
+     OUT VOID                 *ResponsePayload
+  );
+
+/**
+  Register the payload handler of the VENDOR_DEFINED_REQUEST of a standard ID and a vendor ID.
+
+  It shares the table of SpdmRegisterVendorDefinedHandler. Registering the same standard ID and vendor ID
+  again, by either function, overrides the handler.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StandardId                   The standard ID of the request.
+  @param  VendorIdLen                  Size in bytes of the vendor ID.
+  @param  VendorId                     A pointer to the vendor ID.
+  @param  PayloadHandler               The function to process the request payload, or NULL to unregister the handler.
+
+  @retval RETURN_SUCCESS               The handler is registered or unregistered.
+  @retval RETURN_INVALID_PARAMETER     VendorIdLen is larger than MAX_SPDM_VENDOR_ID_LENGTH.
+  @retval RETURN_NOT_FOUND             The handler to unregister is not registered.
+  @retval RETURN_ALREADY_STARTED       No enough memory to register the handler.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRegisterVendorPayloadHandler (
+  IN  VOID                      *SpdmContext,
+  IN  UINT16                    StandardId,
+  IN  UINT8                     VendorIdLen,
+  IN  VOID                      *VendorId,
+  IN  SPDM_VENDOR_PAYLOAD_FUNC  PayloadHandler
+  );
+
 /**
   Process a SPDM request from a device.
 
@@ -106,6 +217,7 @@ SpdmProcessRequest (
 
   @retval RETURN_SUCCESS               The SPDM response is sent successfully.
   @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM response is sent to the device.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
 **/
 RETURN_STATUS
 EFIAPI
@@ -126,6 +238,7 @@ SpdmBuildResponse (
   This function is called in SpdmResponderDispatchMessage to process the message.
   The alternative is: an SPDM responder may receive the request message directly
   and call this function to process it, then send the response message.
+  It holds the lock registered by SpdmRegisterResponderLockFunc while the message is processed.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
@@ -167,6 +280,7 @@ SpdmProcessMessage (
   @retval RETURN_SUCCESS               One SPDM request message is processed.
   @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
   @retval RETURN_UNSUPPORTED           One request message is not supported.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
 **/
 RETURN_STATUS
 EFIAPI
@@ -174,6 +288,30 @@ SpdmResponderDispatchMessage (
   IN     VOID                 *SpdmContext
   );
 
+/**
+  Dispatch function of an SPDM responder for a transport path registered by SpdmRegisterTransportPath.
+
+  It receives one request message over the transport path, processes it and sends the response message
+  over the same path.
+  The transport paths of an SPDM context are dispatched from one thread, for example once a poll
+  on their devices returns the path with a request pending.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  PathIndex                    The index of the transport path, 0 for the path of SpdmRegisterDeviceIoFunc.
+
+  @retval RETURN_SUCCESS               One SPDM request message is processed.
+  @retval RETURN_INVALID_PARAMETER     The transport path is not registered.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_UNSUPPORTED           One request message is not supported.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmResponderDispatchMessageOnPath (
+  IN     VOID                 *SpdmContext,
+  IN     UINT8                PathIndex
+  );
+
 /**
   Generate ERROR message.
 
@@ -296,8 +434,337 @@ SpdmRegisterConnectionStateCallback (
   IN  SPDM_CONNECTION_STATE_CALLBACK  SpdmConnectionStateCallback
   );
 
+/**
+  Enable or disable the state event queue of an SPDM context.
+
+  With the queue, a session or connection state transition is posted to a queue in the SPDM context,
+  instead of calling the registered state callbacks while the request is processed, so that the response
+  is sent before slow callbacks run. The callbacks are called by SpdmDispatchStateEvents.
+  The transitions already posted stay in the queue when it is disabled.
+
+  It must not be called while a message is processed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Enable                       TRUE to post the state transitions, FALSE to call the callbacks at once.
+**/
+VOID
+EFIAPI
+SpdmEnableStateEventQueue (
+  IN     VOID                 *SpdmContext,
+  IN     BOOLEAN              Enable
+  );
+
+/**
+  Call the registered state callbacks for the state transitions posted to the state event queue.
+
+  The transitions are dispatched in the order they happened, across all sessions and the connection,
+  and each one is dispatched once. The callbacks run on the caller's thread. By then the session or
+  connection may be in a later state, and a session may have ended.
+  It may run concurrently with the processing of messages, but not with another SpdmDispatchStateEvents
+  of the same SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MaxEventCount                The maximum number of transitions to dispatch, or 0 for all posted transitions.
+  @param  EventCount                   The number of dispatched transitions.
+
+  @retval RETURN_SUCCESS               The transitions are dispatched.
+  @retval RETURN_OUT_OF_RESOURCES      The transitions are dispatched, but some transitions were dropped because the queue
+                                       was full since the last call. The current states should be read with SpdmGetData.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmDispatchStateEvents (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                MaxEventCount,
+     OUT UINTN                *EventCount OPTIONAL
+  );
+
+/**
+  Return the time used by the admission control of the responder.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the monotonic time, in 100ns units.
+**/
+typedef
+UINT64
+(EFIAPI *SPDM_RESPONDER_GET_TIME_FUNC) (
+  IN     VOID                 *SpdmContext
+  );
+
+/**
+  Decide if a request needing a signing or a DHE operation is served now.
+
+  It lets the integrator refuse such requests on the CPU load of the device, for example.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code, CHALLENGE, KEY_EXCHANGE or GET_MEASUREMENTS with signature.
+
+  @retval TRUE   the request is served.
+  @retval FALSE  the request is answered with ERROR(Busy).
+**/
+typedef
+BOOLEAN
+(EFIAPI *SPDM_RESPONDER_ADMISSION_FUNC) (
+  IN     VOID                 *SpdmContext,
+  IN     UINT8                RequestCode
+  );
+
+/**
+  Register the admission control functions of the responder to an SPDM context.
+
+  CHALLENGE, KEY_EXCHANGE and GET_MEASUREMENTS with signature are the requests needing a signing or a DHE operation.
+  They are answered with ERROR(Busy) if AdmissionFunc refuses them, or if the budget set by SpdmSetResponderRateLimit
+  or the budget of the rate limiter registered by SpdmRegisterResponderRateLimiter is used up.
+  The budgets apply once GetTimeFunc is registered. GetTimeFunc also enables the latencies of the responder statistics,
+  if OPENSPDM_RESPONDER_STATS_SUPPORT is 1.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  GetTimeFunc                  The function to return the time, or NULL.
+  @param  AdmissionFunc                The function to decide if a request is served, or NULL.
+**/
+VOID
+EFIAPI
+SpdmRegisterResponderAdmissionFunc (
+  IN  VOID                           *SpdmContext,
+  IN  SPDM_RESPONDER_GET_TIME_FUNC   GetTimeFunc OPTIONAL,
+  IN  SPDM_RESPONDER_ADMISSION_FUNC  AdmissionFunc OPTIONAL
+  );
+
+/**
+  Set the budget of the requests needing a signing or a DHE operation from the peer of an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Budget                       The number of such requests served in each period, or 0 for no limit.
+  @param  Period                       The period, in 100ns units.
+**/
+VOID
+EFIAPI
+SpdmSetResponderRateLimit (
+  IN  VOID                           *SpdmContext,
+  IN  UINT32                         Budget,
+  IN  UINT64                         Period
+  );
+
+/**
+  Acquire or release the lock of a responder rate limiter.
+
+  @param  LockContext                  The context registered with the lock functions.
+**/
+typedef
+VOID
+(EFIAPI *SPDM_RESPONDER_RATE_LIMITER_LOCK_FUNC) (
+  IN     VOID                 *LockContext
+  );
+
+/**
+  Return the size in bytes of a responder rate limiter.
+
+  @return the size in bytes of the responder rate limiter.
+**/
+UINTN
+EFIAPI
+SpdmResponderRateLimiterGetSize (
+  VOID
+  );
+
+/**
+  Initialize a responder rate limiter.
+
+  The rate limiter holds the budget of the requests needing a signing or a DHE operation from all peers.
+  It may be shared by multiple SPDM contexts. If the contexts are used concurrently,
+  AcquireLock and ReleaseLock must be provided to serialize the access to the rate limiter.
+
+  @param  RateLimiter                  A pointer to the responder rate limiter.
+  @param  Budget                       The number of such requests served in each period, or 0 for no limit.
+  @param  Period                       The period, in 100ns units.
+  @param  AcquireLock                  The function to acquire the lock, or NULL.
+  @param  ReleaseLock                  The function to release the lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+**/
+VOID
+EFIAPI
+SpdmResponderRateLimiterInit (
+  IN     VOID                                   *RateLimiter,
+  IN     UINT32                                 Budget,
+  IN     UINT64                                 Period,
+  IN     SPDM_RESPONDER_RATE_LIMITER_LOCK_FUNC  AcquireLock OPTIONAL,
+  IN     SPDM_RESPONDER_RATE_LIMITER_LOCK_FUNC  ReleaseLock OPTIONAL,
+  IN     VOID                                   *LockContext OPTIONAL
+  );
+
+/**
+  Register a responder rate limiter to an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RateLimiter                  A pointer to the responder rate limiter, or NULL to stop using a rate limiter.
+**/
+VOID
+EFIAPI
+SpdmRegisterResponderRateLimiter (
+  IN     VOID                 *SpdmContext,
+  IN     VOID                 *RateLimiter OPTIONAL
+  );
+
+/**
+  Decide if a KEY_EXCHANGE or PSK_EXCHANGE comes from a privileged requester.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code, KEY_EXCHANGE or PSK_EXCHANGE.
+
+  @retval TRUE   the requester is privileged. It may use the reserved session slots.
+  @retval FALSE  the requester is not privileged.
+**/
+typedef
+BOOLEAN
+(EFIAPI *SPDM_RESPONDER_SESSION_PRIVILEGE_FUNC) (
+  IN     VOID                 *SpdmContext,
+  IN     UINT8                RequestCode
+  );
+
+/**
+  Set the session lifecycle policy of a responder.
+
+  HeartbeatPeriod is returned in KEY_EXCHANGE_RSP and PSK_EXCHANGE_RSP if HBEAT_CAP is supported.
+  A session without any request for twice its heartbeat period, or for IdleTimeout, is expired.
+  The expired sessions are ended when a session slot is needed, or by SpdmReclaimExpiredSessions.
+  If no slot is free, the least recently used session idle for at least EvictIdleTime is evicted.
+  ReservedCount slots are kept for the privileged requesters: a requester which is not privileged
+  creates a session only if more than ReservedCount slots are free, and it evicts only sessions
+  which are not privileged. Without PrivilegeFunc, every requester is privileged.
+
+  The times are from the time function registered by SpdmRegisterResponderAdmissionFunc.
+  Without it, no session expires or is evicted. The ended sessions notify the session state callbacks
+  with SpdmSessionStateNotStarted. With responder workers, EvictIdleTime must be longer than
+  the time to handle an APP message, because the APP messages are handled without the lock.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Policy                       The session lifecycle policy.
+  @param  PrivilegeFunc                The function to decide if a requester is privileged, or NULL.
+**/
+VOID
+EFIAPI
+SpdmSetResponderSessionPolicy (
+  IN     VOID                                   *SpdmContext,
+  IN     CONST SPDM_RESPONDER_SESSION_POLICY    *Policy,
+  IN     SPDM_RESPONDER_SESSION_PRIVILEGE_FUNC  PrivilegeFunc OPTIONAL
+  );
+
+/**
+  End the expired sessions of a responder.
+
+  It may be called periodically, so that the sessions of the requesters which are gone
+  are ended before their slots are needed. It takes the lock registered by SpdmRegisterResponderLockFunc.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the number of sessions ended.
+**/
+UINTN
+EFIAPI
+SpdmReclaimExpiredSessions (
+  IN     VOID                 *SpdmContext
+  );
+
+/**
+  Acquire or release the lock of an SPDM context in a responder.
+
+  @param  LockContext                  The context registered with the lock functions.
+**/
+typedef
+VOID
+(EFIAPI *SPDM_RESPONDER_LOCK_FUNC) (
+  IN     VOID                 *LockContext
+  );
+
+/**
+  Register the lock functions of an SPDM context in a responder.
+
+  The lock serializes SpdmProcessMessage and the responder workers of the SPDM context.
+  It protects the connection state, the response state, the transcripts and the transport layer.
+  The APP message of a session processed by a responder worker is handled without the lock.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  AcquireLock                  The function to acquire the lock, or NULL.
+  @param  ReleaseLock                  The function to release the lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+**/
+VOID
+EFIAPI
+SpdmRegisterResponderLockFunc (
+  IN     VOID                      *SpdmContext,
+  IN     SPDM_RESPONDER_LOCK_FUNC  AcquireLock OPTIONAL,
+  IN     SPDM_RESPONDER_LOCK_FUNC  ReleaseLock OPTIONAL,
+  IN     VOID                      *LockContext OPTIONAL
+  );
+
+/**
+  Return the size in bytes of a responder worker.
+
+  @return the size in bytes of the responder worker.
+**/
+UINTN
+EFIAPI
+SpdmResponderWorkerGetSize (
+  VOID
+  );
+
+/**
+  Initialize a responder worker of an SPDM context.
+
+  A responder worker holds the APP message being processed, so that the APP messages of different sessions
+  are processed concurrently, one worker per thread. The lock functions must be registered to the SPDM context
+  by SpdmRegisterResponderLockFunc.
+
+  @param  ResponderWorker              A pointer to the responder worker.
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+EFIAPI
+SpdmResponderWorkerInit (
+     OUT VOID                 *ResponderWorker,
+  IN     VOID                 *SpdmContext
+  );
+
+/**
+  Process a transport layer message with a responder worker.
+
+  The message is decoded with the lock of the SPDM context. An APP message of a session is then handled
+  by the function registered with SpdmRegisterGetResponseFunc without the lock, and its response is encoded
+  with the lock. Any other message is processed as SpdmProcessMessage does, with the lock.
+  The messages of one session must be processed one at a time, for example by dispatching them by the session ID.
+
+  @param  ResponderWorker              A pointer to the responder worker.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If *SessionId is NULL, it is a normal message.
+                                       If *SessionId is NOT NULL, it is a secured message.
+  @param  Request                      A pointer to the request data.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Response                     A pointer to the response data.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+
+  @retval RETURN_SUCCESS               The SPDM request is set successfully.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmResponderWorkerProcessMessage (
+  IN     VOID                 *ResponderWorker,
+  IN OUT UINT32               **SessionId,
+  IN     VOID                 *Request,
+  IN     UINTN                RequestSize,
+     OUT VOID                 *Response,
+  IN OUT UINTN                *ResponseSize
+  );
+
 /**
   This function initializes the key_update encapsulated state.
+  It does nothing if OPENSPDM_ENCAP_CAP_SUPPORT or OPENSPDM_KEY_UPD_CAP_SUPPORT is 0.
 
   @param  SpdmContext                  A pointer to the SPDM context.
 **/
@@ -307,4 +774,52 @@ SpdmInitKeyUpdateEncapState (
   IN     VOID                 *SpdmContext
   );
 
+/**
+  Schedule a responder-initiated key update of all the established sessions of an SPDM context.
+
+  The next responder DataKey of every scheduled session is derived at once, so that each key update
+  only installs it. A scheduled session runs its key update through the encapsulated flow when its
+  requester sends GET_ENCAPSULATED_REQUEST in the session. The integrator decides when to tell the requester,
+  with SpdmIsKeyUpdateDue, for example in the transport of an application response of the session.
+  A session is no longer scheduled after its key update, or after a KEY_UPDATE with UpdateAllKeys from its requester.
+  It takes the lock registered by SpdmRegisterResponderLockFunc.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Spacing                      The minimum time between two key updates, in 100ns units.
+                                       It applies once the time function is registered by SpdmRegisterResponderAdmissionFunc.
+  @param  SessionCount                 The number of sessions newly scheduled.
+
+  @retval RETURN_SUCCESS               The established sessions are scheduled.
+  @retval RETURN_UNSUPPORTED           KEY_UPD_CAP or ENCAP_CAP is not supported by both sides.
+  @retval RETURN_UNSUPPORTED           OPENSPDM_ENCAP_CAP_SUPPORT or OPENSPDM_KEY_UPD_CAP_SUPPORT is 0.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmScheduleKeyUpdate (
+  IN     VOID                 *SpdmContext,
+  IN     UINT64               Spacing,
+     OUT UINTN                *SessionCount OPTIONAL
+  );
+
+/**
+  Return if the requester of a session should be told to start the scheduled key update of the session now.
+
+  The key updates are started one at a time, because the encapsulated flow of the responder answers
+  the other requests with ERROR(RequestInFlight). They are spread by the spacing of SpdmScheduleKeyUpdate:
+  once TRUE is returned, it returns FALSE for any session until the spacing has elapsed.
+  It is called from the thread dispatching the messages of the SPDM context, between two messages.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SessionId of the session.
+
+  @retval TRUE   The key update of the session is due. Its requester should send GET_ENCAPSULATED_REQUEST.
+  @retval FALSE  The session is not scheduled, or it is not its turn.
+**/
+BOOLEAN
+EFIAPI
+SpdmIsKeyUpdateDue (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               SessionId
+  );
+
 #endif
\ No newline at end of file
@@ -33,6 +33,19 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define BIN_STR_8_LABEL  "exp master"
 #define BIN_STR_9_LABEL  "traffic upd"
 
+//
+// The categories of the debug hex dumps, set with SpdmDataDebugDumpMask.
+// SPDM_DEBUG_DUMP_TRANSCRIPT: the transcripts, their hashes, and the signatures, HMACs, nonces and opaque data.
+// SPDM_DEBUG_DUMP_KEY: the DHE public keys, the PSK hint, and the secrets and keys of the key schedule.
+// SPDM_DEBUG_DUMP_WIRE: the SPDM messages sent and received.
+// SPDM_DEBUG_DUMP_CERT: the certificate chains and their digests.
+//
+#define SPDM_DEBUG_DUMP_TRANSCRIPT  BIT0
+#define SPDM_DEBUG_DUMP_KEY         BIT1
+#define SPDM_DEBUG_DUMP_WIRE        BIT2
+#define SPDM_DEBUG_DUMP_CERT        BIT3
+#define SPDM_DEBUG_DUMP_ALL         (SPDM_DEBUG_DUMP_TRANSCRIPT | SPDM_DEBUG_DUMP_KEY | SPDM_DEBUG_DUMP_WIRE | SPDM_DEBUG_DUMP_CERT)
+
 typedef enum {
   SpdmSessionTypeNone,
   SpdmSessionTypeMacOnly,
@@ -84,6 +97,49 @@ SpdmSecuredMessageInitContext (
   IN     VOID                     *SpdmSecuredMessageContext
   );
 
+/**
+  Reset an SPDM secured message context released by SpdmSecuredMessageDeinitContext, for a new session.
+
+  It is cheaper than SpdmSecuredMessageInitContext, because the secrets are already wiped.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageResetContext (
+  IN     VOID                     *SpdmSecuredMessageContext
+  );
+
+/**
+  Release the resources held by an SPDM secured message context, such as the keyed AEAD handles.
+
+  It must be called before an initialized SPDM secured message context is initialized again or discarded.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageDeinitContext (
+  IN     VOID                     *SpdmSecuredMessageContext
+  );
+
+/**
+  Clone an SPDM secured message context, with the session state and the secrets.
+
+  The Clone creates its own keyed AEAD and HMAC handles and installs the keys in the inline crypto engine on first use,
+  and it has its own random stream.
+  The Clone must not be an initialized SPDM secured message context, unless it is released by SpdmSecuredMessageDeinitContext first.
+
+  @param  SpdmSecuredMessageContextClone  A pointer to the cloned SPDM secured message context.
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageCloneContext (
+     OUT VOID                     *SpdmSecuredMessageContextClone,
+  IN     VOID                     *SpdmSecuredMessageContext
+  );
+
 /**
   Set UsePsk to an SPDM secured message context.
 
@@ -97,6 +153,35 @@ SpdmSecuredMessageSetUsePsk (
   IN BOOLEAN                      UsePsk
   );
 
+/**
+  Set HandshakeInTheClear to an SPDM secured message context.
+
+  If it is set, SpdmGenerateSessionHandshakeKey only derives the finished keys,
+  and no handshake message can be encoded or decoded as a secured message.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  HandshakeInTheClear          Indicate if the handshake messages of the SPDM session are sent in the clear.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageSetHandshakeInTheClear (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN BOOLEAN                      HandshakeInTheClear
+  );
+
+/**
+  Set the debug dump mask to an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  DebugDumpMask                The categories of the debug hex dumps, as SPDM_DEBUG_DUMP_*.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageSetDebugDumpMask (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN UINT32                       DebugDumpMask
+  );
+
 /**
   Set SessionState to an SPDM secured message context.
 
@@ -240,6 +325,8 @@ SpdmSecuredMessageExportSessionKeys (
 /**
   Import the SessionKeys from an SPDM secured message context.
 
+  With OPENSPDM_REPLAY_WINDOW_SIZE, no record below the imported sequence numbers is accepted afterwards.
+
   @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
   @param  SessionKeys                  Indicate the buffer to store the SessionKeys in SPDM_SECURE_SESSION_KEYS_STRUCT.
   @param  SessionKeysSize              The size in bytes of the SessionKeys in SPDM_SECURE_SESSION_KEYS_STRUCT.
@@ -254,6 +341,74 @@ SpdmSecuredMessageImportSessionKeys (
   IN     UINTN                        SessionKeysSize
   );
 
+#define SPDM_SECURE_SESSION_SECRETS_STRUCT_VERSION  1
+
+#pragma pack(1)
+typedef struct {
+  UINT32               Version;
+  UINT32               HashSize;
+  UINT32               AeadKeySize;
+  UINT32               AeadIvSize;
+//  UINT8                HandshakeSecret[HashSize];
+//  UINT8                RequestHandshakeSecret[HashSize];
+//  UINT8                RequestFinishedKey[HashSize];
+//  UINT8                RequestHandshakeEncryptionKey[AeadKeySize];
+//  UINT8                RequestHandshakeSalt[AeadIvSize];
+//  UINT8                ResponseHandshakeSecret[HashSize];
+//  UINT8                ResponseFinishedKey[HashSize];
+//  UINT8                ResponseHandshakeEncryptionKey[AeadKeySize];
+//  UINT8                ResponseHandshakeSalt[AeadIvSize];
+//  UINT8                MasterSecret[HashSize];
+//  UINT8                ExportMasterSecret[HashSize];
+//  UINT8                RequestDataSecret[HashSize];
+//  UINT8                RequestDataEncryptionKey[AeadKeySize];
+//  UINT8                RequestDataSalt[AeadIvSize];
+//  UINT8                ResponseDataSecret[HashSize];
+//  UINT8                ResponseDataEncryptionKey[AeadKeySize];
+//  UINT8                ResponseDataSalt[AeadIvSize];
+} SPDM_SECURE_SESSION_SECRETS_STRUCT;
+#pragma pack()
+
+/**
+  Export the derived secrets of the key schedule from an SPDM secured message context.
+
+  The secrets are the handshake secrets, the master secrets and the current generation of the data secrets,
+  with their keys. The DHE secret and the sequence numbers are not exported.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionSecrets               Indicate the buffer to store the SessionSecrets in SPDM_SECURE_SESSION_SECRETS_STRUCT.
+  @param  SessionSecretsSize           The size in bytes of the SessionSecrets in SPDM_SECURE_SESSION_SECRETS_STRUCT.
+
+  @retval RETURN_SUCCESS  SessionSecrets are exported.
+*/
+RETURN_STATUS
+EFIAPI
+SpdmSecuredMessageExportSessionSecrets (
+  IN     VOID                         *SpdmSecuredMessageContext,
+     OUT VOID                         *SessionSecrets,
+  IN OUT UINTN                        *SessionSecretsSize
+  );
+
+/**
+  Import the derived secrets of the key schedule to an SPDM secured message context,
+  instead of generating them from the DHE secret.
+
+  The sequence numbers are not changed.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionSecrets               Indicate the buffer to store the SessionSecrets in SPDM_SECURE_SESSION_SECRETS_STRUCT.
+  @param  SessionSecretsSize           The size in bytes of the SessionSecrets in SPDM_SECURE_SESSION_SECRETS_STRUCT.
+
+  @retval RETURN_SUCCESS  SessionSecrets are imported.
+*/
+RETURN_STATUS
+EFIAPI
+SpdmSecuredMessageImportSessionSecrets (
+  IN     VOID                         *SpdmSecuredMessageContext,
+  IN     VOID                         *SessionSecrets,
+  IN     UINTN                        SessionSecretsSize
+  );
+
 /**
   Allocates and Initializes one Diffie-Hellman Ephemeral (DHE) Context for subsequent use,
   based upon negotiated DHE algorithm.
@@ -337,6 +492,137 @@ SpdmSecuredMessageDheComputeKey (
   IN OUT  VOID                         *SpdmSecuredMessageContext
   );
 
+/**
+  Acquire or release a lock shared by several users of an SPDM secured message object.
+
+  @param  LockContext                  The lock context registered together with the function.
+**/
+typedef
+VOID
+(EFIAPI *SPDM_SECURED_MESSAGE_LOCK_FUNC) (
+  IN     VOID                         *LockContext
+  );
+
+///
+/// The occupancy of a DHE key pool, returned by SpdmSecuredMessageDheKeyPoolGetStats.
+/// A hit is a DHE key pair taken from the pool, and a miss a DHE key pair generated
+/// because the pool had none for the DHENamedGroup.
+///
+typedef struct {
+  UINTN   EntryCount;
+  UINTN   ReadyCount;
+  UINT64  HitCount;
+  UINT64  MissCount;
+} SPDM_DHE_KEY_POOL_STATS;
+
+/**
+  Return the size in bytes of a DHE key pool.
+
+  @param  EntryCount                   The number of DHE key pairs the pool can hold.
+
+  @return the size in bytes of the DHE key pool.
+**/
+UINTN
+EFIAPI
+SpdmSecuredMessageDheKeyPoolGetSize (
+  IN      UINTN                        EntryCount
+  );
+
+/**
+  Initialize a DHE key pool.
+
+  The pool holds DHE contexts with a generated key pair, so that the key generation can be
+  moved out of KEY_EXCHANGE processing. The size in bytes of the pool can be returned by
+  SpdmSecuredMessageDheKeyPoolGetSize. If the pool is refilled from another thread,
+  AcquireLock and ReleaseLock must be provided to serialize the access to the pool.
+
+  @param  DheKeyPool                   A pointer to the DHE key pool.
+  @param  EntryCount                   The number of DHE key pairs the pool can hold.
+  @param  AcquireLock                  The function to acquire the pool lock, or NULL.
+  @param  ReleaseLock                  The function to release the pool lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+**/
+VOID
+EFIAPI
+SpdmSecuredMessageDheKeyPoolInit (
+  IN      VOID                         *DheKeyPool,
+  IN      UINTN                        EntryCount,
+  IN      SPDM_SECURED_MESSAGE_LOCK_FUNC  AcquireLock OPTIONAL,
+  IN      SPDM_SECURED_MESSAGE_LOCK_FUNC  ReleaseLock OPTIONAL,
+  IN      VOID                         *LockContext OPTIONAL
+  );
+
+/**
+  Release the DHE key pairs held by a DHE key pool.
+
+  No refill may be in progress.
+
+  @param  DheKeyPool                   A pointer to the DHE key pool.
+**/
+VOID
+EFIAPI
+SpdmSecuredMessageDheKeyPoolDeinit (
+  IN      VOID                         *DheKeyPool
+  );
+
+/**
+  Generate DHE key pairs for the free entries of a DHE key pool.
+
+  This function is intended to be called from an idle hook or a background thread.
+  The pool lock is not held during the key generation.
+
+  @param  DheKeyPool                   A pointer to the DHE key pool.
+  @param  DHENamedGroup                SPDM DHENamedGroup of the key pairs to generate.
+  @param  MaxCount                     The maximum number of key pairs to generate.
+
+  @return the number of key pairs generated.
+**/
+UINTN
+EFIAPI
+SpdmSecuredMessageDheKeyPoolRefill (
+  IN      VOID                         *DheKeyPool,
+  IN      UINT16                       DHENamedGroup,
+  IN      UINTN                        MaxCount
+  );
+
+/**
+  Return the occupancy of a DHE key pool.
+
+  @param  DheKeyPool                   A pointer to the DHE key pool.
+  @param  Stats                        The occupancy of the DHE key pool.
+**/
+VOID
+EFIAPI
+SpdmSecuredMessageDheKeyPoolGetStats (
+  IN      VOID                         *DheKeyPool,
+  OUT     SPDM_DHE_KEY_POOL_STATS      *Stats
+  );
+
+/**
+  Return a DHE context with a generated key pair,
+  based upon negotiated DHE algorithm.
+
+  The key pair is taken from the DHE key pool if the pool has one for DHENamedGroup.
+  Otherwise a new DHE context is allocated and its key pair is generated.
+  The DHE context must be released by SpdmSecuredMessageDheFree.
+
+  @param  DheKeyPool                   A pointer to the DHE key pool, or NULL.
+  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  PublicKey                    Pointer to the buffer to receive generated public key.
+  @param  PublicKeySize                On input, the size of PublicKey buffer in bytes.
+                                       On output, the size of data returned in PublicKey buffer in bytes.
+
+  @return  Pointer to the DHE context, or NULL if the key pair cannot be generated.
+**/
+VOID *
+EFIAPI
+SpdmSecuredMessageDheNewFromPool (
+  IN      VOID                         *DheKeyPool OPTIONAL,
+  IN      UINT16                       DHENamedGroup,
+  OUT     UINT8                        *PublicKey,
+  IN OUT  UINTN                        *PublicKeySize
+  );
+
 /**
   Computes the HMAC of a input data buffer, with RequestFinishedKey.
 
@@ -439,9 +725,31 @@ typedef enum {
   SpdmKeyUpdateActionAll       = 0x3,
 } SPDM_KEY_UPDATE_ACTION;
 
+/**
+  This function derives the next generation of SPDM DataKey for a session ahead of the key update.
+
+  It is intended to be called at idle time, after the session is established and after each key update.
+  SpdmCreateUpdateSessionDataKey then installs the prepared keys and their keyed AEAD handles
+  without deriving them again. Records of the session may be encoded and decoded meanwhile.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  Action                       Indicate of the key update action.
+
+  @retval RETURN_SUCCESS  The next generation of SPDM DataKey is prepared.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPrepareUpdateSessionDataKey (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN SPDM_KEY_UPDATE_ACTION       Action
+  );
+
 /**
   This function creates the updates of SPDM DataKey for a session.
 
+  The next generation prepared by SpdmPrepareUpdateSessionDataKey is installed as is.
+  Otherwise it is derived first.
+
   @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
   @param  Action                       Indicate of the key update action.
 
@@ -518,9 +826,199 @@ typedef struct {
   UINT32  SessionId;
 } SPDM_ERROR_STRUCT;
 
+/**
+  Install the AEAD key of one direction of an SPDM session into an inline crypto engine.
+
+  A key that is installed for the same session and direction is replaced.
+
+  @param  OffloadContext               The context registered together with the offload functions.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  IsRequester                  Indicates if the key protects the requester messages.
+  @param  AEADCipherSuite              SPDM AEADCipherSuite of the key.
+  @param  Key                          Pointer to the encryption key.
+  @param  KeySize                      Size of the encryption key in bytes.
+  @param  Salt                         Pointer to the salt. The IV of a record is the salt XOR its sequence number.
+  @param  SaltSize                     Size of the salt in bytes.
+
+  @retval RETURN_SUCCESS               The key is installed.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *SPDM_SECURED_MESSAGE_OFFLOAD_SET_KEY) (
+  IN     VOID         *OffloadContext,
+  IN     UINT32       SessionId,
+  IN     BOOLEAN      IsRequester,
+  IN     UINT16       AEADCipherSuite,
+  IN     CONST UINT8  *Key,
+  IN     UINTN        KeySize,
+  IN     CONST UINT8  *Salt,
+  IN     UINTN        SaltSize
+  );
+
+/**
+  Remove the AEAD key of one direction of an SPDM session from an inline crypto engine.
+
+  @param  OffloadContext               The context registered together with the offload functions.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  IsRequester                  Indicates if the key protects the requester messages.
+**/
+typedef
+VOID
+(EFIAPI *SPDM_SECURED_MESSAGE_OFFLOAD_CLEAR_KEY) (
+  IN     VOID         *OffloadContext,
+  IN     UINT32       SessionId,
+  IN     BOOLEAN      IsRequester
+  );
+
+/**
+  Performs AEAD authenticated encryption for one secured message record in an inline crypto engine,
+  with the key installed for the direction.
+
+  @param  OffloadContext               The context registered together with the offload functions.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be encrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the encryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *SPDM_SECURED_MESSAGE_OFFLOAD_SEAL) (
+  IN     VOID         *OffloadContext,
+  IN     UINT32       SessionId,
+  IN     BOOLEAN      IsRequester,
+  IN     CONST UINT8  *Iv,
+  IN     UINTN        IvSize,
+  IN     CONST UINT8  *AData,
+  IN     UINTN        ADataSize,
+  IN     CONST UINT8  *DataIn,
+  IN     UINTN        DataInSize,
+     OUT UINT8        *TagOut,
+  IN     UINTN        TagSize,
+     OUT UINT8        *DataOut,
+  IN OUT UINTN        *DataOutSize
+  );
+
+/**
+  Performs AEAD authenticated decryption for one secured message record in an inline crypto engine,
+  with the key installed for the direction.
+
+  @param  OffloadContext               The context registered together with the offload functions.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the decryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
+**/
+typedef
+BOOLEAN
+(EFIAPI *SPDM_SECURED_MESSAGE_OFFLOAD_OPEN) (
+  IN     VOID         *OffloadContext,
+  IN     UINT32       SessionId,
+  IN     BOOLEAN      IsRequester,
+  IN     CONST UINT8  *Iv,
+  IN     UINTN        IvSize,
+  IN     CONST UINT8  *AData,
+  IN     UINTN        ADataSize,
+  IN     CONST UINT8  *DataIn,
+  IN     UINTN        DataInSize,
+  IN     CONST UINT8  *Tag,
+  IN     UINTN        TagSize,
+     OUT UINT8        *DataOut,
+  IN OUT UINTN        *DataOutSize
+  );
+
+#define SPDM_SECURED_MESSAGE_OFFLOAD_OPS_VERSION 1
+
+//
+// Seal and Open are either both provided or both NULL. If they are NULL, the engine only receives the keys,
+// for example to protect the link traffic of a PCIe IDE stream, and the secured messages are still
+// encrypted and decrypted in software.
+//
+typedef struct {
+  UINT32                                  Version;
+  SPDM_SECURED_MESSAGE_OFFLOAD_SET_KEY    SetKey;
+  SPDM_SECURED_MESSAGE_OFFLOAD_CLEAR_KEY  ClearKey;
+  SPDM_SECURED_MESSAGE_OFFLOAD_SEAL       Seal;
+  SPDM_SECURED_MESSAGE_OFFLOAD_OPEN       Open;
+} SPDM_SECURED_MESSAGE_OFFLOAD_OPS;
+
+/**
+  Set the inline crypto engine offload functions to an SPDM secured message context.
+
+  The current key of each direction is installed by OffloadOps->SetKey before the first record
+  of the direction is encoded or decoded with it, so that a handshake key, a data key, a key update
+  or imported session keys reach the engine without a software copy.
+  If OffloadOps provides Seal and Open, the records of a direction with an installed key are encrypted
+  and decrypted by the engine instead of the software AEAD. If SetKey fails, the software AEAD is used.
+  The installed keys are removed by OffloadOps->ClearKey in SpdmSecuredMessageDeinitContext.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  OffloadOps                   A pointer to the offload functions, or NULL to use software only.
+  @param  OffloadContext               The context passed to the offload functions.
+**/
+VOID
+EFIAPI
+SpdmSecuredMessageSetOffloadOps (
+  IN     VOID                                    *SpdmSecuredMessageContext,
+  IN     UINT32                                  SessionId,
+  IN     CONST SPDM_SECURED_MESSAGE_OFFLOAD_OPS  *OffloadOps OPTIONAL,
+  IN     VOID                                    *OffloadContext OPTIONAL
+  );
+
+/**
+  Return the room that a secured message needs around its application message.
+
+  An application message at Headroom bytes into a buffer, followed by at least Tailroom spare bytes,
+  can be encoded to a secured message in place at the start of that buffer.
+  A secured message at the start of a buffer can be decoded in place to an application message
+  at Headroom bytes into that buffer.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SpdmSecuredMessageCallbacks  A pointer to a secured message callback functions structure.
+  @param  Headroom                     Size in bytes of the secured message data before the application message.
+  @param  Tailroom                     Max size in bytes of the secured message data after the application message.
+**/
+VOID
+EFIAPI
+SpdmSecuredMessageGetMessageRoom (
+  IN     VOID                           *SpdmSecuredMessageContext,
+  IN     SPDM_SECURED_MESSAGE_CALLBACKS *SpdmSecuredMessageCallbacks,
+     OUT UINTN                          *Headroom,
+     OUT UINTN                          *Tailroom
+  );
+
 /**
   Encode an application message to a secured message.
 
+  The AppMessage buffer must not overlap the SecuredMessage buffer,
+  unless it is at the headroom returned by SpdmSecuredMessageGetMessageRoom to encode in place.
+
+  Encoding the records of one direction of a session may run concurrently with decoding the records
+  of the other direction of the same session, without a lock. The calls for one direction must be
+  serialized, and no key update or session state change may run concurrently with them.
+
   @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
   @param  SessionId                    The session ID of the SPDM session.
   @param  IsRequester                  Indicates if it is a requester message.
@@ -546,9 +1044,59 @@ SpdmEncodeSecuredMessage (
   IN     SPDM_SECURED_MESSAGE_CALLBACKS *SpdmSecuredMessageCallbacks
   );
 
+/**
+  Encode a list of application messages to consecutive secured messages of one session.
+
+  The sequence numbers of all records are reserved at once, the random data of the records
+  is drawn from a shared pool, and the records are sealed back to back with the keyed AEAD
+  handle of the direction.
+  Each AppMessage entry must not overlap any SecuredMessage entry,
+  unless it is at the headroom of its own entry as in SpdmEncodeSecuredMessage.
+
+  If an entry fails, the entries before it are encoded, and the sequence numbers of the entries
+  after it stay consumed.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  MessageCount                 Number of entries in AppMessage and SecuredMessage.
+  @param  AppMessage                   A pointer to the list of application messages.
+  @param  SecuredMessage               A pointer to the list of destination buffers of the secured messages.
+                                       On output, the Size of each encoded entry is the size of its secured message.
+  @param  SpdmSecuredMessageCallbacks  A pointer to a secured message callback functions structure.
+  @param  EncodedCount                 Return the number of entries that are encoded.
+
+  @retval RETURN_SUCCESS               All application messages are encoded successfully.
+  @retval RETURN_OUT_OF_RESOURCES      Not enough sequence numbers are left, or the AEAD encryption failed.
+  @retval RETURN_BUFFER_TOO_SMALL      A SecuredMessage entry is too small.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmEncodeSecuredMessageBatch (
+  IN     VOID                           *SpdmSecuredMessageContext,
+  IN     UINT32                         SessionId,
+  IN     BOOLEAN                        IsRequester,
+  IN     UINTN                          MessageCount,
+  IN     CONST CRYPT_DATA_SEGMENT       *AppMessage,
+  IN OUT CRYPT_DATA_SEGMENT             *SecuredMessage,
+  IN     SPDM_SECURED_MESSAGE_CALLBACKS *SpdmSecuredMessageCallbacks,
+     OUT UINTN                          *EncodedCount OPTIONAL
+  );
+
 /**
   Decode an application message from a secured message.
 
+  The AppMessage buffer must not overlap the SecuredMessage buffer,
+  unless it is at the headroom returned by SpdmSecuredMessageGetMessageRoom to decode in place.
+
+  If OPENSPDM_REPLAY_WINDOW_SIZE is not 0 and the transport carries the sequence number in the record,
+  the application secured messages of a session may be decoded in any order inside the replay window.
+  The calls for one session must still be serialized.
+
+  Encoding the records of one direction of a session may run concurrently with decoding the records
+  of the other direction of the same session, without a lock. The calls for one direction must be
+  serialized, and no key update or session state change may run concurrently with them.
+
   @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
   @param  SessionId                    The session ID of the SPDM session.
   @param  IsRequester                  Indicates if it is a requester message.
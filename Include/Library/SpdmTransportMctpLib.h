@@ -23,6 +23,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
   The APP message format is defined by the transport layer.
   Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
 
+  A secured message is encoded in place at the headroom returned by SpdmTransportMctpGetMessageRoom
+  in TransportMessage. If Message is elsewhere, it is copied to the headroom first.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
                                        If SessionId is NULL, it is a normal message.
@@ -61,6 +64,10 @@ SpdmTransportMctpEncodeMessage (
   The APP message format is defined by the transport layer.
   Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
 
+  A secured message is decoded directly in Message. If Message overlaps TransportMessage,
+  it is decoded in place at the headroom returned by SpdmTransportMctpGetMessageRoom
+  and TransportMessage is overwritten.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
                                        If *SessionId is NULL, it is a normal message.
@@ -89,6 +96,269 @@ SpdmTransportMctpDecodeMessage (
      OUT VOID                 *Message
   );
 
+/**
+  Return the room that a transport layer message needs around an SPDM or APP message.
+
+  An SPDM or APP message at Headroom bytes into a buffer, followed by at least Tailroom spare bytes,
+  is encoded in place by SpdmTransportMctpEncodeMessage with that buffer as the transport message.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  Headroom                     Size in bytes of the transport message data before the message.
+  @param  Tailroom                     Max size in bytes of the transport message data after the message.
+
+  @retval RETURN_SUCCESS               The room is returned successfully.
+  @retval RETURN_UNSUPPORTED           The message is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpGetMessageRoom (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  );
+
+/**
+  Return the number of MCTP packets of an MCTP message.
+
+  @param  MessageSize                  Size in bytes of the MCTP message, from the MCTP message header.
+  @param  TransmissionUnit             Size in bytes of the payload of each packet after the MCTP header,
+                                       at least MCTP_BASELINE_TRANSMISSION_UNIT.
+
+  @return the number of MCTP packets of the MCTP message.
+**/
+UINTN
+EFIAPI
+SpdmTransportMctpGetPacketCount (
+  IN     UINTN                MessageSize,
+  IN     UINTN                TransmissionUnit
+  );
+
+/**
+  Build one MCTP packet of an MCTP message.
+
+  The MCTP header of the packet is built with SOM, EOM and the packet sequence number of PacketIndex,
+  and the payload of the packet is copied from the MCTP message, so that the packets are sent
+  from the transport message encoded by SpdmTransportMctpEncodeMessage without another copy of it.
+
+  @param  DestinationId                The destination EID.
+  @param  SourceId                     The source EID.
+  @param  MessageTag                   The message tag, with MCTP_TAG_OWNER if the tag is owned by the source.
+  @param  TransmissionUnit             Size in bytes of the payload of each packet after the MCTP header,
+                                       at least MCTP_BASELINE_TRANSMISSION_UNIT.
+  @param  MessageSize                  Size in bytes of the MCTP message, from the MCTP message header.
+  @param  Message                      A pointer to the MCTP message.
+  @param  PacketIndex                  The index of the packet, less than SpdmTransportMctpGetPacketCount.
+  @param  PacketSize                   On input, the size in bytes of the packet buffer.
+                                       On output, the size in bytes of the packet.
+  @param  Packet                       A pointer to the packet buffer.
+
+  @retval RETURN_SUCCESS               The packet is built successfully.
+  @retval RETURN_INVALID_PARAMETER     The TransmissionUnit or the PacketIndex is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The packet buffer is too small to hold the packet.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpGetPacket (
+  IN     UINT8                DestinationId,
+  IN     UINT8                SourceId,
+  IN     UINT8                MessageTag,
+  IN     UINTN                TransmissionUnit,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINTN                PacketIndex,
+  IN OUT UINTN                *PacketSize,
+     OUT VOID                 *Packet
+  );
+
+/**
+  Return the size in bytes of an MCTP reassembly context.
+
+  @return the size in bytes of the MCTP reassembly context.
+**/
+UINTN
+EFIAPI
+SpdmTransportMctpReassemblyGetSize (
+  VOID
+  );
+
+/**
+  Initialize an MCTP reassembly context.
+
+  The reassembly context reassembles up to MAX_MCTP_REASSEMBLY_MESSAGE_COUNT MCTP messages at the same time,
+  one per source EID and message tag, into the buffers added by SpdmTransportMctpReassemblyAddBuffer.
+
+  @param  Reassembly                   A pointer to the MCTP reassembly context.
+  @param  TransmissionUnit             Size in bytes of the payload of each packet after the MCTP header,
+                                       at least MCTP_BASELINE_TRANSMISSION_UNIT.
+**/
+VOID
+EFIAPI
+SpdmTransportMctpReassemblyInit (
+     OUT VOID                 *Reassembly,
+  IN     UINTN                TransmissionUnit
+  );
+
+/**
+  Add a buffer to an MCTP reassembly context, to reassemble one MCTP message into.
+
+  @param  Reassembly                   A pointer to the MCTP reassembly context.
+  @param  Buffer                       A pointer to the buffer.
+  @param  BufferSize                   Size in bytes of the buffer.
+
+  @retval RETURN_SUCCESS               The buffer is added successfully.
+  @retval RETURN_OUT_OF_RESOURCES      MAX_MCTP_REASSEMBLY_MESSAGE_COUNT buffers are added already.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpReassemblyAddBuffer (
+  IN OUT VOID                 *Reassembly,
+  IN     VOID                 *Buffer,
+  IN     UINTN                BufferSize
+  );
+
+/**
+  Reassemble an MCTP packet received.
+
+  The payload of the packet is copied to its offset in the buffer of the message of its source EID and message tag.
+  A packet with SOM starts a new message, and drops the unfinished message of the same source EID and message tag.
+  A packet out of sequence, a packet whose size differs from the transmission unit without EOM, or a packet
+  exceeding the buffer drops the unfinished message, as a lost packet does, according to DSP0236.
+
+  A reassembled message stays in its buffer until SpdmTransportMctpReassemblyReleaseMessage is called.
+  It can be decoded by SpdmTransportMctpDecodeMessage in place.
+
+  @param  Reassembly                   A pointer to the MCTP reassembly context.
+  @param  PacketSize                   Size in bytes of the packet, from the MCTP header.
+  @param  Packet                       A pointer to the packet.
+  @param  SourceId                     The source EID of the reassembled message.
+  @param  MessageTag                   The message tag of the reassembled message, with MCTP_TAG_OWNER.
+  @param  MessageSize                  Size in bytes of the reassembled message.
+  @param  Message                      A pointer to the reassembled message, in a buffer of the reassembly context.
+
+  @retval RETURN_SUCCESS               The packet completes a message, and the message is returned.
+  @retval RETURN_NOT_READY             The packet is reassembled, and more packets are needed.
+  @retval RETURN_ABORTED               The packet is dropped, with the unfinished message of its source EID and message tag.
+  @retval RETURN_OUT_OF_RESOURCES      The packet starts a message, but no buffer is free.
+  @retval RETURN_UNSUPPORTED           The packet is not a valid MCTP packet.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpReassemblyPushPacket (
+  IN OUT VOID                 *Reassembly,
+  IN     UINTN                PacketSize,
+  IN     VOID                 *Packet,
+     OUT UINT8                *SourceId,
+     OUT UINT8                *MessageTag,
+     OUT UINTN                *MessageSize,
+     OUT VOID                 **Message
+  );
+
+/**
+  Release a reassembled message, so that its buffer reassembles another message.
+
+  @param  Reassembly                   A pointer to the MCTP reassembly context.
+  @param  Message                      A pointer to the reassembled message.
+**/
+VOID
+EFIAPI
+SpdmTransportMctpReassemblyReleaseMessage (
+  IN OUT VOID                 *Reassembly,
+  IN     VOID                 *Message
+  );
+
+/**
+  Calculate the SMBus packet error code (PEC), a CRC-8 with the polynomial x^8 + x^2 + x + 1.
+
+  @param  Pec                          The PEC of the previous bytes, or 0 for the first bytes.
+  @param  Size                         Size in bytes of the data.
+  @param  Data                         A pointer to the data.
+
+  @return the PEC of the previous bytes and the data.
+**/
+UINT8
+EFIAPI
+SpdmTransportMctpSmbusCalculatePec (
+  IN     UINT8                Pec,
+  IN     UINTN                Size,
+  IN     VOID                 *Data
+  );
+
+/**
+  Build consecutive MCTP SMBus/I2C packets of an MCTP message, back to back in a buffer.
+
+  Each packet is an MCTP_SMBUS_HEADER, from the destination slave address, followed by the MCTP packet
+  built in place by SpdmTransportMctpGetPacket and by the PEC. The last packet carries only the rest of
+  the message and is not padded to the transmission unit. The size of each packet is its ByteCount
+  plus the bytes up to ByteCount and the PEC, so that a driver issues one SMBus block write per packet.
+  A driver whose controller sends the slave address itself skips the first byte of each packet.
+
+  @param  DestinationSlaveAddress      The 7-bit destination slave address.
+  @param  SourceSlaveAddress           The 7-bit source slave address.
+  @param  DestinationId                The destination EID.
+  @param  SourceId                     The source EID.
+  @param  MessageTag                   The message tag, with MCTP_TAG_OWNER if the tag is owned by the source.
+  @param  TransmissionUnit             Size in bytes of the payload of each packet after the MCTP header,
+                                       from MCTP_BASELINE_TRANSMISSION_UNIT to 250.
+  @param  MessageSize                  Size in bytes of the MCTP message, from the MCTP message header.
+  @param  Message                      A pointer to the MCTP message.
+  @param  PacketIndex                  On input, the index of the first packet to build.
+                                       On output, the index of the next packet to build.
+  @param  BufferSize                   On input, the size in bytes of the buffer.
+                                       On output, the size in bytes of the packets built.
+  @param  Buffer                       A pointer to the buffer.
+
+  @retval RETURN_SUCCESS               At least one packet is built, and as many as fit in the buffer.
+  @retval RETURN_INVALID_PARAMETER     The TransmissionUnit or the PacketIndex is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the first packet.
+                                       BufferSize returns the size of that packet.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpSmbusGetPackets (
+  IN     UINT8                DestinationSlaveAddress,
+  IN     UINT8                SourceSlaveAddress,
+  IN     UINT8                DestinationId,
+  IN     UINT8                SourceId,
+  IN     UINT8                MessageTag,
+  IN     UINTN                TransmissionUnit,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *PacketIndex,
+  IN OUT UINTN                *BufferSize,
+     OUT VOID                 *Buffer
+  );
+
+/**
+  Check an MCTP SMBus/I2C packet received, and return the MCTP packet in it.
+
+  The MCTP packet is not copied, so that it is pushed by SpdmTransportMctpReassemblyPushPacket from the SMBus packet.
+
+  @param  PacketSize                   Size in bytes of the SMBus packet, from the destination slave address to the PEC.
+  @param  Packet                       A pointer to the SMBus packet.
+  @param  SourceSlaveAddress           The 7-bit source slave address.
+  @param  MctpPacketSize               Size in bytes of the MCTP packet.
+  @param  MctpPacket                   A pointer to the MCTP packet, in the SMBus packet.
+
+  @retval RETURN_SUCCESS               The SMBus packet is valid.
+  @retval RETURN_UNSUPPORTED           The SMBus packet is not an MCTP packet, or its ByteCount is invalid.
+  @retval RETURN_CRC_ERROR             The PEC of the SMBus packet is invalid.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpSmbusDecodePacket (
+  IN     UINTN                PacketSize,
+  IN     VOID                 *Packet,
+     OUT UINT8                *SourceSlaveAddress,
+     OUT UINTN                *MctpPacketSize,
+     OUT VOID                 **MctpPacket
+  );
+
 /**
   Get sequence number in an SPDM secure message.
 
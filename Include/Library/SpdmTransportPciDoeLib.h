@@ -23,6 +23,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
   The APP message format is defined by the transport layer.
   Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
 
+  A secured message is encoded in place at the headroom returned by SpdmTransportPciDoeGetMessageRoom
+  in TransportMessage. If Message is elsewhere, it is copied to the headroom first.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
                                        If SessionId is NULL, it is a normal message.
@@ -61,6 +64,10 @@ SpdmTransportPciDoeEncodeMessage (
   The APP message format is defined by the transport layer.
   Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
 
+  A secured message is decoded directly in Message. If Message overlaps TransportMessage,
+  it is decoded in place at the headroom returned by SpdmTransportPciDoeGetMessageRoom
+  and TransportMessage is overwritten.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
                                        If *SessionId is NULL, it is a normal message.
@@ -89,6 +96,408 @@ SpdmTransportPciDoeDecodeMessage (
      OUT VOID                 *Message
   );
 
+/**
+  Return the room that a transport layer message needs around an SPDM or APP message.
+
+  An SPDM or APP message at Headroom bytes into a buffer, followed by at least Tailroom spare bytes,
+  is encoded in place by SpdmTransportPciDoeEncodeMessage with that buffer as the transport message.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  Headroom                     Size in bytes of the transport message data before the message.
+  @param  Tailroom                     Max size in bytes of the transport message data after the message.
+
+  @retval RETURN_SUCCESS               The room is returned successfully.
+  @retval RETURN_UNSUPPORTED           The message is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeGetMessageRoom (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  );
+
+/**
+  Read a DWORD register of the configuration space of a DOE function.
+
+  @param  AccessContext                The context of the configuration space accessor.
+  @param  Offset                       The offset of the register in the configuration space.
+  @param  Value                        The value read.
+
+  @retval RETURN_SUCCESS               The register is read successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the register is read.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *PCI_DOE_CONFIG_READ_FUNC) (
+  IN     VOID                 *AccessContext,
+  IN     UINT32               Offset,
+     OUT UINT32               *Value
+  );
+
+/**
+  Write a DWORD register of the configuration space of a DOE function.
+
+  @param  AccessContext                The context of the configuration space accessor.
+  @param  Offset                       The offset of the register in the configuration space.
+  @param  Value                        The value to write.
+
+  @retval RETURN_SUCCESS               The register is written successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the register is written.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *PCI_DOE_CONFIG_WRITE_FUNC) (
+  IN     VOID                 *AccessContext,
+  IN     UINT32               Offset,
+  IN     UINT32               Value
+  );
+
+/**
+  Write a burst of DWORDs to one register of the configuration space of a DOE function.
+
+  @param  AccessContext                The context of the configuration space accessor.
+  @param  Offset                       The offset of the register in the configuration space.
+  @param  Count                        The number of DWORDs to write.
+  @param  Value                        A pointer to the DWORDs to write, in order.
+
+  @retval RETURN_SUCCESS               The DWORDs are written successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the register is written.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *PCI_DOE_CONFIG_WRITE_BURST_FUNC) (
+  IN     VOID                 *AccessContext,
+  IN     UINT32               Offset,
+  IN     UINTN                Count,
+  IN     UINT32               *Value
+  );
+
+/**
+  Read a burst of DWORDs from the DOE Read Data Mailbox of a DOE function.
+
+  Each DWORD is read from the register, then any value is written to the register to pop the next DWORD.
+
+  @param  AccessContext                The context of the configuration space accessor.
+  @param  Offset                       The offset of the DOE Read Data Mailbox in the configuration space.
+  @param  Count                        The number of DWORDs to read.
+  @param  Value                        A pointer to the DWORDs read, in order.
+
+  @retval RETURN_SUCCESS               The DWORDs are read successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the register is read.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *PCI_DOE_CONFIG_READ_BURST_FUNC) (
+  IN     VOID                 *AccessContext,
+  IN     UINT32               Offset,
+  IN     UINTN                Count,
+     OUT UINT32               *Value
+  );
+
+/**
+  Wait for the DOE interrupt of a DOE function.
+
+  @param  AccessContext                The context of the configuration space accessor.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The DOE interrupt is signaled.
+  @retval RETURN_TIMEOUT               The DOE interrupt is not signaled within Timeout.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *PCI_DOE_WAIT_INTERRUPT_FUNC) (
+  IN     VOID                 *AccessContext,
+  IN     UINT64               Timeout
+  );
+
+//
+// The configuration space accessor of a DOE function.
+// ConfigWriteBurst, ConfigReadBurst and WaitInterrupt are optional.
+// Without WaitInterrupt, the DOE Status register is polled.
+//
+typedef struct {
+  PCI_DOE_CONFIG_READ_FUNC         ConfigRead;
+  PCI_DOE_CONFIG_WRITE_FUNC        ConfigWrite;
+  PCI_DOE_CONFIG_WRITE_BURST_FUNC  ConfigWriteBurst;
+  PCI_DOE_CONFIG_READ_BURST_FUNC   ConfigReadBurst;
+  PCI_DOE_WAIT_INTERRUPT_FUNC      WaitInterrupt;
+  VOID                             *AccessContext;
+} PCI_DOE_MAILBOX_ACCESSOR;
+
+/**
+  Return the size in bytes of a DOE mailbox.
+
+  @return the size in bytes of the DOE mailbox.
+**/
+UINTN
+EFIAPI
+SpdmTransportPciDoeMailboxGetSize (
+  VOID
+  );
+
+/**
+  Initialize a DOE mailbox.
+
+  The DOE mailbox is registered to an SPDM context by SpdmRegisterDeviceIoContext, so that
+  SpdmTransportPciDoeMailboxSendMessage and SpdmTransportPciDoeMailboxReceiveMessage
+  are registered by SpdmRegisterDeviceIoFunc as the device input/output functions.
+  They may also be the functions of a path registered by SpdmRegisterTransportPath,
+  with the DOE mailbox as its DeviceIoContext.
+
+  @param  Mailbox                      A pointer to the DOE mailbox.
+  @param  Accessor                     A pointer to the configuration space accessor of the DOE function.
+  @param  CapabilityOffset             The offset of the DOE Extended Capability in the configuration space.
+  @param  MaxPollCount                 The number of reads of the DOE Status register before a timeout,
+                                       if the DOE interrupt is not used. 0 means to poll indefinitely.
+  @param  MaxRetryCount                The number of times a data object is written again after the DOE is aborted.
+**/
+VOID
+EFIAPI
+SpdmTransportPciDoeMailboxInit (
+     OUT VOID                      *Mailbox,
+  IN     PCI_DOE_MAILBOX_ACCESSOR  *Accessor,
+  IN     UINT32                    CapabilityOffset,
+  IN     UINTN                     MaxPollCount,
+  IN     UINTN                     MaxRetryCount
+  );
+
+/**
+  Send an SPDM transport layer message to the DOE mailbox registered to an SPDM context.
+
+  The data object is written to the DOE Write Data Mailbox in a burst, then DOE Go is set once.
+  If the DOE reports an error or stays busy, the DOE is aborted and the data object is written again.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the message data buffer, a multiple of 4.
+  @param  Message                      A pointer to the message, a PCI DOE data object.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is sent to the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid.
+  @retval RETURN_TIMEOUT               The DOE stays busy.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeMailboxSendMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINT64               Timeout
+  );
+
+/**
+  Receive an SPDM transport layer message from the DOE mailbox registered to an SPDM context.
+
+  The function waits for Data Object Ready, with the DOE interrupt if the accessor supports it,
+  then reads the data object from the DOE Read Data Mailbox in bursts.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the message received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is received from the device.
+  @retval RETURN_BUFFER_TOO_SMALL      The data object is larger than the message buffer, and it is aborted.
+  @retval RETURN_TIMEOUT               The data object is not ready within Timeout.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeMailboxReceiveMessage (
+  IN     VOID                 *SpdmContext,
+  IN OUT UINTN                *MessageSize,
+  IN OUT VOID                 *Message,
+  IN     UINT64               Timeout
+  );
+
+/**
+  Discover the data object protocols supported by a DOE mailbox, with DOE Discovery.
+
+  The protocols are kept in the DOE mailbox, for SpdmTransportPciDoeMailboxIsProtocolSupported.
+
+  @param  Mailbox                      A pointer to the DOE mailbox.
+  @param  Timeout                      The timeout of each data object, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The protocols are discovered.
+  @retval RETURN_DEVICE_ERROR          The DOE Discovery response is invalid.
+  @retval RETURN_OUT_OF_RESOURCES      The DOE mailbox supports more than MAX_PCI_DOE_PROTOCOL_COUNT protocols.
+  @return the status of the data object exchange, if it fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeMailboxDiscover (
+  IN OUT VOID                 *Mailbox,
+  IN     UINT64               Timeout
+  );
+
+/**
+  Check whether a DOE mailbox supports a data object protocol, after SpdmTransportPciDoeMailboxDiscover.
+
+  @param  Mailbox                      A pointer to the DOE mailbox.
+  @param  VendorId                     The vendor ID of the data object protocol.
+  @param  DataObjectType               The data object type of the data object protocol.
+
+  @retval TRUE                         The DOE mailbox supports the data object protocol.
+  @retval FALSE                        The DOE mailbox does not support the data object protocol.
+**/
+BOOLEAN
+EFIAPI
+SpdmTransportPciDoeMailboxIsProtocolSupported (
+  IN     VOID                 *Mailbox,
+  IN     UINT16               VendorId,
+  IN     UINT8                DataObjectType
+  );
+
+/**
+  Return the size in bytes of a DOE dispatcher.
+
+  @param  MaxMailboxCount              The number of DOE mailboxes of the dispatcher.
+
+  @return the size in bytes of the DOE dispatcher.
+**/
+UINTN
+EFIAPI
+SpdmTransportPciDoeDispatcherGetSize (
+  IN     UINTN                MaxMailboxCount
+  );
+
+/**
+  Initialize a DOE dispatcher, which spreads the SPDM contexts of a device over its DOE mailboxes.
+
+  @param  Dispatcher                   A pointer to the DOE dispatcher.
+  @param  MaxMailboxCount              The number of DOE mailboxes of the dispatcher.
+**/
+VOID
+EFIAPI
+SpdmTransportPciDoeDispatcherInit (
+     OUT VOID                 *Dispatcher,
+  IN     UINTN                MaxMailboxCount
+  );
+
+/**
+  Discover the data object protocols of a DOE mailbox, and add it to a DOE dispatcher
+  if it supports SPDM or secured SPDM data objects.
+
+  @param  Dispatcher                   A pointer to the DOE dispatcher.
+  @param  Mailbox                      A pointer to the DOE mailbox, initialized by SpdmTransportPciDoeMailboxInit.
+  @param  Timeout                      The timeout of each data object, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The DOE mailbox is added.
+  @retval RETURN_UNSUPPORTED           The DOE mailbox supports neither SPDM nor secured SPDM data objects.
+  @retval RETURN_OUT_OF_RESOURCES      MaxMailboxCount DOE mailboxes are added already.
+  @return the status of SpdmTransportPciDoeMailboxDiscover, if it fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeDispatcherAddMailbox (
+  IN OUT VOID                 *Dispatcher,
+  IN     VOID                 *Mailbox,
+  IN     UINT64               Timeout
+  );
+
+/**
+  Return the size in bytes of a DOE binding.
+
+  @return the size in bytes of the DOE binding.
+**/
+UINTN
+EFIAPI
+SpdmTransportPciDoeBindingGetSize (
+  VOID
+  );
+
+/**
+  Bind an SPDM context to the DOE mailboxes of a DOE dispatcher.
+
+  The SPDM data objects of the binding go to the DOE mailbox supporting them with the fewest bindings.
+  The secured SPDM data objects go to the DOE mailbox supporting them with the fewest bindings,
+  another one than for SPDM data objects if any, so that bulk secured traffic does not wait behind control traffic.
+
+  The DOE binding is registered to the SPDM context by SpdmRegisterDeviceIoContext, so that
+  SpdmTransportPciDoeBindingSendMessage and SpdmTransportPciDoeBindingReceiveMessage
+  are registered by SpdmRegisterDeviceIoFunc as the device input/output functions.
+  SPDM contexts whose bindings share no DOE mailbox can be used concurrently.
+
+  @param  Dispatcher                   A pointer to the DOE dispatcher.
+  @param  Binding                      A pointer to the DOE binding.
+
+  @retval RETURN_SUCCESS               The DOE binding is bound.
+  @retval RETURN_UNSUPPORTED           No DOE mailbox of the dispatcher supports SPDM data objects.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeDispatcherBind (
+  IN OUT VOID                 *Dispatcher,
+     OUT VOID                 *Binding
+  );
+
+/**
+  Unbind an SPDM context from the DOE mailboxes of a DOE dispatcher.
+
+  @param  Binding                      A pointer to the DOE binding.
+**/
+VOID
+EFIAPI
+SpdmTransportPciDoeDispatcherUnbind (
+  IN OUT VOID                 *Binding
+  );
+
+/**
+  Send an SPDM transport layer message to the DOE mailbox of its data object type,
+  in the DOE binding registered to an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the message data buffer, a multiple of 4.
+  @param  Message                      A pointer to the message, a PCI DOE data object.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is sent to the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid.
+  @retval RETURN_TIMEOUT               The DOE stays busy.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeBindingSendMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINT64               Timeout
+  );
+
+/**
+  Receive an SPDM transport layer message from the DOE mailbox of the last message sent,
+  in the DOE binding registered to an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the message received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is received from the device.
+  @retval RETURN_BUFFER_TOO_SMALL      The data object is larger than the message buffer, and it is aborted.
+  @retval RETURN_TIMEOUT               The data object is not ready within Timeout.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeBindingReceiveMessage (
+  IN     VOID                 *SpdmContext,
+  IN OUT UINTN                *MessageSize,
+  IN OUT VOID                 *Message,
+  IN     UINT64               Timeout
+  );
+
 /**
   Get sequence number in an SPDM secure message.
 
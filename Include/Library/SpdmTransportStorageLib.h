@@ -0,0 +1,304 @@
+/** @file
+  SPDM storage Transport library.
+  It follows the SPDM over storage binding in IndustryStandard/StorageBinding.h.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __STORAGE_TRANSPORT_LIB_H__
+#define __STORAGE_TRANSPORT_LIB_H__
+
+#include <Library/SpdmCommonLib.h>
+
+/**
+  Encode an SPDM or APP message to a transport layer message.
+
+  For normal SPDM message, it adds the transport layer wrapper.
+  For secured SPDM message, it encrypts a secured message then adds the transport layer wrapper.
+  For secured APP message, it encrypts a secured message then adds the transport layer wrapper.
+
+  The APP message is encoded to a secured message directly in SPDM session.
+  The APP message format is defined by the transport layer.
+  Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
+
+  A secured message is encoded in place at the headroom returned by SpdmTransportStorageGetMessageRoom
+  in TransportMessage. If Message is elsewhere, it is copied to the headroom first.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a source buffer to store the message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a destination buffer to store the transport message.
+
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportStorageEncodeMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  );
+
+/**
+  Decode an SPDM or APP message from a transport layer message.
+
+  For normal SPDM message, it removes the transport layer wrapper,
+  For secured SPDM message, it removes the transport layer wrapper, then decrypts and verifies a secured message.
+  For secured APP message, it removes the transport layer wrapper, then decrypts and verifies a secured message.
+
+  The APP message is decoded from a secured message directly in SPDM session.
+  The APP message format is defined by the transport layer.
+  Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
+
+  A secured message is decoded directly in Message. If Message overlaps TransportMessage,
+  it is decoded in place at the headroom returned by SpdmTransportStorageGetMessageRoom
+  and TransportMessage is overwritten.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If *SessionId is NULL, it is a normal message.
+                                       If *SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a source buffer to store the transport message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a destination buffer to store the message.
+
+  @retval RETURN_SUCCESS               The message is decoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+  @retval RETURN_UNSUPPORTED           The TransportMessage is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportStorageDecodeMessage (
+  IN     VOID                 *SpdmContext,
+     OUT UINT32               **SessionId,
+     OUT BOOLEAN              *IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                TransportMessageSize,
+  IN     VOID                 *TransportMessage,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  );
+
+/**
+  Return the room that a transport layer message needs around an SPDM or APP message.
+
+  An SPDM or APP message at Headroom bytes into a buffer, followed by at least Tailroom spare bytes,
+  is encoded in place by SpdmTransportStorageEncodeMessage with that buffer as the transport message.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  Headroom                     Size in bytes of the transport message data before the message.
+  @param  Tailroom                     Max size in bytes of the transport message data after the message.
+
+  @retval RETURN_SUCCESS               The room is returned successfully.
+  @retval RETURN_UNSUPPORTED           The message is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportStorageGetMessageRoom (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  );
+
+/**
+  Submit a security command to a storage device, without waiting for its completion.
+
+  For NVMe, it is a Security Send or Security Receive command, submitted through the NVMe passthrough interface.
+  For SCSI, it is a SECURITY PROTOCOL OUT or SECURITY PROTOCOL IN command.
+
+  @param  DeviceContext                The context of the storage device.
+  @param  IsSend                       TRUE for Security Send, FALSE for Security Receive.
+  @param  SecurityProtocol             The SECURITY PROTOCOL field of the command.
+  @param  SecurityProtocolSpecific     The SECURITY PROTOCOL SPECIFIC field of the command.
+  @param  TransferLength               The transfer length or allocation length of the command, in bytes.
+  @param  Buffer                       A pointer to the data of the command. It stays valid until the command completes.
+  @param  Command                      The command submitted, for STORAGE_SECURITY_WAIT_FUNC.
+
+  @retval RETURN_SUCCESS               The command is submitted.
+  @retval RETURN_DEVICE_ERROR          The command cannot be submitted.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *STORAGE_SECURITY_SUBMIT_FUNC) (
+  IN     VOID                 *DeviceContext,
+  IN     BOOLEAN              IsSend,
+  IN     UINT8                SecurityProtocol,
+  IN     UINT16               SecurityProtocolSpecific,
+  IN     UINT32               TransferLength,
+  IN OUT VOID                 *Buffer,
+     OUT VOID                 **Command
+  );
+
+/**
+  Wait for the completion of a security command submitted to a storage device.
+
+  @param  DeviceContext                The context of the storage device.
+  @param  Command                      The command returned by STORAGE_SECURITY_SUBMIT_FUNC.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+  @param  TransferredLength            The number of bytes of data transferred.
+
+  @retval RETURN_SUCCESS               The command completes successfully.
+  @retval RETURN_DEVICE_ERROR          The command completes with an error.
+  @retval RETURN_TIMEOUT               The command does not complete within Timeout. It is aborted.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *STORAGE_SECURITY_WAIT_FUNC) (
+  IN     VOID                 *DeviceContext,
+  IN     VOID                 *Command,
+  IN     UINT64               Timeout,
+     OUT UINT32               *TransferredLength
+  );
+
+//
+// The security command accessor of a storage device.
+//
+typedef struct {
+  STORAGE_SECURITY_SUBMIT_FUNC     Submit;
+  STORAGE_SECURITY_WAIT_FUNC       Wait;
+  VOID                             *DeviceContext;
+} STORAGE_SECURITY_ACCESSOR;
+
+/**
+  Return the size in bytes of a storage device.
+
+  @return the size in bytes of the storage device.
+**/
+UINTN
+EFIAPI
+SpdmTransportStorageDeviceGetSize (
+  VOID
+  );
+
+/**
+  Initialize a storage device.
+
+  The storage device is registered to an SPDM context by SpdmRegisterDeviceIoContext, so that
+  SpdmTransportStorageDeviceSendMessage and SpdmTransportStorageDeviceReceiveMessage
+  are registered by SpdmRegisterDeviceIoFunc as the device input/output functions.
+  SpdmDataTransportMaxMessageSize should be set to MaxTransferLength, so that the certificate chain
+  and the measurements are transferred in as few commands as the device allows.
+
+  @param  Device                       A pointer to the storage device.
+  @param  Accessor                     A pointer to the security command accessor of the storage device.
+  @param  MaxTransferLength            The maximum data transfer size of a command, in bytes.
+**/
+VOID
+EFIAPI
+SpdmTransportStorageDeviceInit (
+     OUT VOID                       *Device,
+  IN     STORAGE_SECURITY_ACCESSOR  *Accessor,
+  IN     UINT32                     MaxTransferLength
+  );
+
+/**
+  Send an SPDM transport layer message to the storage device registered to an SPDM context.
+
+  The Security Send command is submitted with the data following the storage transport header in Message,
+  and the function returns without waiting for its completion, which SpdmTransportStorageDeviceReceiveMessage
+  waits for before it submits the Security Receive command. Message must not be modified until then.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to the message, a storage transport header and its data.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is sent to the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid,
+                                       or the message is larger than the maximum data transfer size.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportStorageDeviceSendMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINT64               Timeout
+  );
+
+/**
+  Receive an SPDM transport layer message from the storage device registered to an SPDM context.
+
+  The function waits for the completion of the Security Send command of the request, then submits
+  a Security Receive command, with the data received directly after the storage transport header in Message,
+  in one command of up to the maximum data transfer size.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the message received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is received from the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid.
+  @retval RETURN_TIMEOUT               A command does not complete within Timeout.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportStorageDeviceReceiveMessage (
+  IN     VOID                 *SpdmContext,
+  IN OUT UINTN                *MessageSize,
+  IN OUT VOID                 *Message,
+  IN     UINT64               Timeout
+  );
+
+/**
+  Get sequence number in an SPDM secure message.
+
+  This value is transport layer specific.
+
+  @param SequenceNumber        The current sequence number used to encode or decode message.
+  @param SequenceNumberBuffer  A buffer to hold the sequence number output used in the secured message.
+                               The size in byte of the output buffer shall be 8.
+
+  @return Size in byte of the SequenceNumberBuffer.
+          It shall be no greater than 8.
+          0 means no sequence number is required.
+**/
+UINT8
+EFIAPI
+StorageGetSequenceNumber (
+  IN     UINT64     SequenceNumber,
+  IN OUT UINT8      *SequenceNumberBuffer
+  );
+
+/**
+  Return max random number count in an SPDM secure message.
+
+  This value is transport layer specific.
+
+  @return Max random number count in an SPDM secured message.
+          0 means no randum number is required.
+**/
+UINT32
+EFIAPI
+StorageGetMaxRandomNumberCount (
+  VOID
+  );
+
+#endif
\ No newline at end of file
@@ -0,0 +1,294 @@
+/** @file
+  SPDM TCP Transport library.
+  It follows the SPDM over TCP binding in IndustryStandard/TcpBinding.h.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __TCP_TRANSPORT_LIB_H__
+#define __TCP_TRANSPORT_LIB_H__
+
+#include <Library/SpdmCommonLib.h>
+
+/**
+  Encode an SPDM message to a transport layer message.
+
+  For normal SPDM message, it adds the transport layer wrapper.
+  For secured SPDM message, it encrypts a secured message then adds the transport layer wrapper.
+  APP messages are not supported.
+
+  The record carries the SpdmDataTransportConnectionId of the SPDM context.
+  A message at the headroom returned by SpdmTransportTcpGetMessageRoom in TransportMessage
+  is encoded in place. If Message is elsewhere, it is copied to the headroom first.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a source buffer to store the message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a destination buffer to store the transport message.
+
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+  @retval RETURN_UNSUPPORTED           The message is an APP message.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportTcpEncodeMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  );
+
+/**
+  Decode an SPDM message from a transport layer message.
+
+  For normal SPDM message, it removes the transport layer wrapper,
+  For secured SPDM message, it removes the transport layer wrapper, then decrypts and verifies a secured message.
+
+  A record of another connection than the SpdmDataTransportConnectionId of the SPDM context is rejected.
+  A normal message is not copied if Message is the payload of the record in TransportMessage.
+  A secured message is decoded directly in Message. If Message overlaps TransportMessage,
+  it is decoded in place at the headroom returned by SpdmTransportTcpGetMessageRoom
+  and TransportMessage is overwritten.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If *SessionId is NULL, it is a normal message.
+                                       If *SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a source buffer to store the transport message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a destination buffer to store the message.
+
+  @retval RETURN_SUCCESS               The message is decoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+  @retval RETURN_UNSUPPORTED           The TransportMessage is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportTcpDecodeMessage (
+  IN     VOID                 *SpdmContext,
+     OUT UINT32               **SessionId,
+     OUT BOOLEAN              *IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                TransportMessageSize,
+  IN     VOID                 *TransportMessage,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  );
+
+/**
+  Return the room that a transport layer message needs around an SPDM message.
+
+  An SPDM message at Headroom bytes into a buffer, followed by at least Tailroom spare bytes,
+  is encoded in place by SpdmTransportTcpEncodeMessage with that buffer as the transport message.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  Headroom                     Size in bytes of the transport message data before the message.
+  @param  Tailroom                     Max size in bytes of the transport message data after the message.
+
+  @retval RETURN_SUCCESS               The room is returned successfully.
+  @retval RETURN_UNSUPPORTED           The message is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportTcpGetMessageRoom (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  );
+
+/**
+  Send bytes on the TCP connection of a TCP link.
+
+  @param  SocketContext                The context of the TCP connection.
+  @param  Size                         The number of bytes to send.
+  @param  Buffer                       A pointer to the bytes to send.
+
+  @retval RETURN_SUCCESS               All bytes are sent.
+  @retval RETURN_DEVICE_ERROR          The bytes cannot be sent.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *TCP_LINK_SEND_FUNC) (
+  IN     VOID                 *SocketContext,
+  IN     UINTN                Size,
+  IN     VOID                 *Buffer
+  );
+
+/**
+  Receive bytes from the TCP connection of a TCP link.
+
+  @param  SocketContext                The context of the TCP connection.
+  @param  Size                         The number of bytes to receive.
+  @param  Buffer                       A pointer to the buffer to receive the bytes in.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               Exactly Size bytes are received.
+  @retval RETURN_DEVICE_ERROR          The bytes cannot be received.
+  @retval RETURN_TIMEOUT               No byte is received within Timeout.
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *TCP_LINK_RECEIVE_FUNC) (
+  IN     VOID                 *SocketContext,
+  IN     UINTN                Size,
+     OUT VOID                 *Buffer,
+  IN     UINT64               Timeout
+  );
+
+//
+// The TCP connection of a TCP link.
+//
+typedef struct {
+  TCP_LINK_SEND_FUNC               Send;
+  TCP_LINK_RECEIVE_FUNC            Receive;
+  VOID                             *SocketContext;
+} TCP_LINK_ACCESSOR;
+
+/**
+  Return the size in bytes of a TCP link.
+
+  @param  ConnectionCount              The number of SPDM connections on the link.
+  @param  MaxRecordSize                The size in bytes of the largest record received, with its header.
+
+  @return the size in bytes of the TCP link.
+**/
+UINTN
+EFIAPI
+SpdmTransportTcpLinkGetSize (
+  IN     UINTN                ConnectionCount,
+  IN     UINTN                MaxRecordSize
+  );
+
+/**
+  Initialize a TCP link, which multiplexes several SPDM connections over one TCP connection.
+
+  The TCP link is registered to the SPDM context of each connection by SpdmRegisterDeviceIoContext, so that
+  SpdmTransportTcpLinkSendMessage and SpdmTransportTcpLinkReceiveMessage are registered by SpdmRegisterDeviceIoFunc
+  as the device input/output functions. Each SPDM context sets a different SpdmDataTransportConnectionId,
+  less than ConnectionCount.
+  The functions of the SPDM contexts sharing a TCP link must not be called concurrently.
+
+  @param  Link                         A pointer to the TCP link.
+  @param  Accessor                     A pointer to the TCP connection.
+  @param  ConnectionCount              The number of SPDM connections on the link.
+  @param  MaxRecordSize                The size in bytes of the largest record received, with its header.
+
+  @retval RETURN_SUCCESS               The TCP link is initialized.
+  @retval RETURN_INVALID_PARAMETER     ConnectionCount is 0 or larger than 0x10000,
+                                       or MaxRecordSize is not larger than a record header.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportTcpLinkInit (
+     OUT VOID                 *Link,
+  IN     TCP_LINK_ACCESSOR    *Accessor,
+  IN     UINTN                ConnectionCount,
+  IN     UINTN                MaxRecordSize
+  );
+
+/**
+  Send an SPDM transport layer message to the TCP link registered to an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to the message, a TCP record.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is sent to the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportTcpLinkSendMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINT64               Timeout
+  );
+
+/**
+  Receive an SPDM transport layer message of an SPDM context from the TCP link registered to it.
+
+  The record header is received first. The payload of a record of the SPDM context is received directly
+  in Message, after the header, so that it is not copied. A record of another SPDM connection of the link
+  is kept for that connection, and the next record is received.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the message received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs, or the TCP byte stream has an invalid record.
+                                       The TCP connection should be closed.
+  @retval RETURN_BUFFER_TOO_SMALL      The record is larger than the message buffer. It is kept.
+  @retval RETURN_TIMEOUT               No record is received within Timeout.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportTcpLinkReceiveMessage (
+  IN     VOID                 *SpdmContext,
+  IN OUT UINTN                *MessageSize,
+  IN OUT VOID                 *Message,
+  IN     UINT64               Timeout
+  );
+
+/**
+  Get sequence number in an SPDM secure message.
+
+  This value is transport layer specific.
+
+  @param SequenceNumber        The current sequence number used to encode or decode message.
+  @param SequenceNumberBuffer  A buffer to hold the sequence number output used in the secured message.
+                               The size in byte of the output buffer shall be 8.
+
+  @return Size in byte of the SequenceNumberBuffer.
+          It shall be no greater than 8.
+          0 means no sequence number is required.
+**/
+UINT8
+EFIAPI
+TcpGetSequenceNumber (
+  IN     UINT64     SequenceNumber,
+  IN OUT UINT8      *SequenceNumberBuffer
+  );
+
+/**
+  Return max random number count in an SPDM secure message.
+
+  This value is transport layer specific.
+
+  @return Max random number count in an SPDM secured message.
+          0 means no randum number is required.
+**/
+UINT32
+EFIAPI
+TcpGetMaxRandomNumberCount (
+  VOID
+  );
+
+#endif
@@ -0,0 +1,648 @@
+/** @file
+  SPDM appraisal library.
+  It appraises the measurement record returned by SpdmGetMeasurement against reference manifests.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/SpdmAppraisalLib.h>
+
+#define SPDM_APPRAISAL_DATABASE_SIGNATURE  SIGNATURE_32 ('S', 'P', 'A', 'D')
+
+#define SPDM_APPRAISAL_MAX_REFERENCE_COUNT  0x100000
+
+//
+// The end of a bucket chain or of the free list.
+//
+#define SPDM_APPRAISAL_REFERENCE_END  MAX_UINT32
+
+typedef struct {
+  //
+  // The next reference value in the bucket chain, or in the free list.
+  //
+  UINT32               Next;
+  //
+  // SPDM_APPRAISAL_ANY_MANIFEST if the reference value is free.
+  //
+  UINT32               ManifestId;
+  UINT8                Index;
+  UINT8                ValueType;
+  UINT8                DigestSize;
+  UINT8                Reserved;
+  UINT8                Digest[MAX_HASH_SIZE];
+} SPDM_APPRAISAL_REFERENCE;
+
+typedef struct {
+  UINT32               Signature;
+  UINT32               MaxReferenceCount;
+  UINT32               BucketMask;
+  UINT32               FreeList;
+  UINT32               FreeCount;
+  //
+  // The number of reference values of each measurement index, in all the reference manifests.
+  //
+  UINT32               IndexReferenceCount[MAX_UINT8 + 1];
+//UINT32               Bucket[BucketMask + 1];
+//SPDM_APPRAISAL_REFERENCE Reference[MaxReferenceCount];
+} SPDM_APPRAISAL_DATABASE;
+
+typedef struct {
+  UINT8                Index;
+  UINT8                ValueType;
+  BOOLEAN              Appraisable;
+  CONST UINT8          *Digest;
+  UINTN                DigestSize;
+} SPDM_APPRAISAL_BLOCK;
+
+/**
+  Return the number of buckets of a reference database, the smallest power of 2 not below MaxReferenceCount.
+
+  @param  MaxReferenceCount            The maximum number of reference values in the database.
+
+  @return the number of buckets.
+**/
+UINT32
+SpdmAppraisalGetBucketCount (
+  IN     UINT32                    MaxReferenceCount
+  )
+{
+  UINT32  BucketCount;
+
+  BucketCount = 1;
+  while (BucketCount < MaxReferenceCount) {
+    BucketCount <<= 1;
+  }
+  return BucketCount;
+}
+
+/**
+  Return the buckets of a reference database, each the head of a chain of reference values.
+**/
+UINT32 *
+SpdmAppraisalGetBuckets (
+  IN     SPDM_APPRAISAL_DATABASE   *Database
+  )
+{
+  return (UINT32 *)(Database + 1);
+}
+
+/**
+  Return the reference values of a reference database.
+**/
+SPDM_APPRAISAL_REFERENCE *
+SpdmAppraisalGetReferences (
+  IN     SPDM_APPRAISAL_DATABASE   *Database
+  )
+{
+  return (SPDM_APPRAISAL_REFERENCE *)(SpdmAppraisalGetBuckets (Database) + Database->BucketMask + 1);
+}
+
+/**
+  Return the bucket of a reference value key, with the FNV-1a hash of (index, value type, digest).
+
+  @param  Database                     A pointer to the reference database.
+  @param  Index                        The measurement index.
+  @param  ValueType                    The DMTFSpecMeasurementValueType.
+  @param  Digest                       The measurement value.
+  @param  DigestSize                   Size in bytes of the measurement value.
+
+  @return the head of the bucket chain.
+**/
+UINT32 *
+SpdmAppraisalGetBucket (
+  IN     SPDM_APPRAISAL_DATABASE   *Database,
+  IN     UINT8                     Index,
+  IN     UINT8                     ValueType,
+  IN     CONST UINT8               *Digest,
+  IN     UINTN                     DigestSize
+  )
+{
+  UINT32  Hash;
+  UINTN   Offset;
+
+  Hash = 0x811C9DC5;
+  Hash = (Hash ^ Index) * 0x01000193;
+  Hash = (Hash ^ ValueType) * 0x01000193;
+  for (Offset = 0; Offset < DigestSize; Offset++) {
+    Hash = (Hash ^ Digest[Offset]) * 0x01000193;
+  }
+  return &SpdmAppraisalGetBuckets (Database)[Hash & Database->BucketMask];
+}
+
+/**
+  Return if a reference value has a key, and belongs to a reference manifest.
+
+  @retval TRUE   The reference value matches.
+  @retval FALSE  The reference value does not match.
+**/
+BOOLEAN
+SpdmAppraisalReferenceMatch (
+  IN     SPDM_APPRAISAL_REFERENCE  *Reference,
+  IN     UINT32                    ManifestId,
+  IN     UINT8                     Index,
+  IN     UINT8                     ValueType,
+  IN     CONST UINT8               *Digest,
+  IN     UINTN                     DigestSize
+  )
+{
+  if ((ManifestId != SPDM_APPRAISAL_ANY_MANIFEST) && (Reference->ManifestId != ManifestId)) {
+    return FALSE;
+  }
+  return (BOOLEAN)((Reference->Index == Index) &&
+                   (Reference->ValueType == ValueType) &&
+                   (Reference->DigestSize == DigestSize) &&
+                   (CompareMem (Reference->Digest, Digest, DigestSize) == 0));
+}
+
+/**
+  Find the link to a reference value in its bucket chain.
+
+  @return the link to the reference value, or NULL if the reference database has not the reference value.
+**/
+UINT32 *
+SpdmAppraisalFindReference (
+  IN     SPDM_APPRAISAL_DATABASE   *Database,
+  IN     UINT32                    ManifestId,
+  IN     UINT8                     Index,
+  IN     UINT8                     ValueType,
+  IN     CONST UINT8               *Digest,
+  IN     UINTN                     DigestSize
+  )
+{
+  SPDM_APPRAISAL_REFERENCE  *References;
+  UINT32                    *Link;
+
+  References = SpdmAppraisalGetReferences (Database);
+  Link = SpdmAppraisalGetBucket (Database, Index, ValueType, Digest, DigestSize);
+  while (*Link != SPDM_APPRAISAL_REFERENCE_END) {
+    if (SpdmAppraisalReferenceMatch (&References[*Link], ManifestId, Index, ValueType, Digest, DigestSize)) {
+      return Link;
+    }
+    Link = &References[*Link].Next;
+  }
+  return NULL;
+}
+
+/**
+  Unlink a reference value from its bucket chain, and free it.
+
+  @param  Database                     A pointer to the reference database.
+  @param  Link                         The link to the reference value.
+**/
+VOID
+SpdmAppraisalFreeReference (
+  IN     SPDM_APPRAISAL_DATABASE   *Database,
+  IN     UINT32                    *Link
+  )
+{
+  SPDM_APPRAISAL_REFERENCE  *Reference;
+  UINT32                    ReferenceIndex;
+
+  ReferenceIndex = *Link;
+  Reference = &SpdmAppraisalGetReferences (Database)[ReferenceIndex];
+  *Link = Reference->Next;
+
+  ASSERT (Database->IndexReferenceCount[Reference->Index] != 0);
+  Database->IndexReferenceCount[Reference->Index]--;
+  Reference->ManifestId = SPDM_APPRAISAL_ANY_MANIFEST;
+  Reference->Next = Database->FreeList;
+  Database->FreeList = ReferenceIndex;
+  Database->FreeCount++;
+}
+
+/**
+  Parse the measurement block at the current position of a measurement record.
+
+  @param  Ptr                          On input, the measurement block. On output, the next measurement block.
+  @param  End                          The end of the measurement record.
+  @param  Block                        The parsed measurement block.
+
+  @retval TRUE   The measurement block is parsed.
+  @retval FALSE  The measurement block is malformed.
+**/
+BOOLEAN
+SpdmAppraisalParseBlock (
+  IN OUT CONST UINT8               **Ptr,
+  IN     CONST UINT8               *End,
+     OUT SPDM_APPRAISAL_BLOCK      *Block
+  )
+{
+  SPDM_MEASUREMENT_BLOCK_COMMON_HEADER  *CommonHeader;
+  SPDM_MEASUREMENT_BLOCK_DMTF_HEADER    *DmtfHeader;
+  UINTN                                 MeasurementSize;
+
+  if ((UINTN)(End - *Ptr) < sizeof(SPDM_MEASUREMENT_BLOCK_COMMON_HEADER)) {
+    return FALSE;
+  }
+  CommonHeader = (SPDM_MEASUREMENT_BLOCK_COMMON_HEADER *)*Ptr;
+  MeasurementSize = CommonHeader->MeasurementSize;
+  if ((UINTN)(End - *Ptr) - sizeof(SPDM_MEASUREMENT_BLOCK_COMMON_HEADER) < MeasurementSize) {
+    return FALSE;
+  }
+  *Ptr += sizeof(SPDM_MEASUREMENT_BLOCK_COMMON_HEADER) + MeasurementSize;
+
+  ZeroMem (Block, sizeof(SPDM_APPRAISAL_BLOCK));
+  Block->Index = CommonHeader->Index;
+  if (((CommonHeader->MeasurementSpecification & SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF) == 0) ||
+      (MeasurementSize < sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER))) {
+    return TRUE;
+  }
+  DmtfHeader = (SPDM_MEASUREMENT_BLOCK_DMTF_HEADER *)(CommonHeader + 1);
+  Block->ValueType = DmtfHeader->DMTFSpecMeasurementValueType;
+  if (DmtfHeader->DMTFSpecMeasurementValueSize != MeasurementSize - sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER)) {
+    return FALSE;
+  }
+  Block->Digest = (CONST UINT8 *)(DmtfHeader + 1);
+  Block->DigestSize = DmtfHeader->DMTFSpecMeasurementValueSize;
+  Block->Appraisable = (BOOLEAN)((Block->DigestSize != 0) && (Block->DigestSize <= MAX_HASH_SIZE));
+  return TRUE;
+}
+
+/**
+  Return the size in bytes of a reference database.
+
+  @param  MaxReferenceCount            The maximum number of reference values in the database.
+
+  @return the size in bytes of the reference database.
+**/
+UINTN
+EFIAPI
+SpdmAppraisalGetDatabaseSize (
+  IN     UINT32                    MaxReferenceCount
+  )
+{
+  if ((MaxReferenceCount == 0) || (MaxReferenceCount > SPDM_APPRAISAL_MAX_REFERENCE_COUNT)) {
+    return 0;
+  }
+  return sizeof(SPDM_APPRAISAL_DATABASE) +
+         SpdmAppraisalGetBucketCount (MaxReferenceCount) * sizeof(UINT32) +
+         MaxReferenceCount * sizeof(SPDM_APPRAISAL_REFERENCE);
+}
+
+/**
+  Initialize an empty reference database.
+
+  The reference values are indexed by a hash of (measurement index, DMTFSpecMeasurementValueType, digest),
+  so that the appraisal of a measurement block does not depend on the number of reference manifests.
+
+  @param  Database                     A pointer to the reference database.
+  @param  DatabaseSize                 Size in bytes of the reference database.
+  @param  MaxReferenceCount            The maximum number of reference values in the database.
+
+  @retval RETURN_SUCCESS               The reference database is initialized.
+  @retval RETURN_INVALID_PARAMETER     MaxReferenceCount is 0.
+  @retval RETURN_BUFFER_TOO_SMALL      DatabaseSize is smaller than SpdmAppraisalGetDatabaseSize (MaxReferenceCount).
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraisalInitDatabase (
+  IN     VOID                      *Database,
+  IN     UINTN                     DatabaseSize,
+  IN     UINT32                    MaxReferenceCount
+  )
+{
+  SPDM_APPRAISAL_DATABASE   *AppraisalDatabase;
+  SPDM_APPRAISAL_REFERENCE  *References;
+  UINT32                    *Buckets;
+  UINT32                    Index;
+
+  if ((MaxReferenceCount == 0) || (MaxReferenceCount > SPDM_APPRAISAL_MAX_REFERENCE_COUNT)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (DatabaseSize < SpdmAppraisalGetDatabaseSize (MaxReferenceCount)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  AppraisalDatabase = Database;
+  ZeroMem (AppraisalDatabase, sizeof(SPDM_APPRAISAL_DATABASE));
+  AppraisalDatabase->Signature = SPDM_APPRAISAL_DATABASE_SIGNATURE;
+  AppraisalDatabase->MaxReferenceCount = MaxReferenceCount;
+  AppraisalDatabase->BucketMask = SpdmAppraisalGetBucketCount (MaxReferenceCount) - 1;
+
+  Buckets = SpdmAppraisalGetBuckets (AppraisalDatabase);
+  for (Index = 0; Index <= AppraisalDatabase->BucketMask; Index++) {
+    Buckets[Index] = SPDM_APPRAISAL_REFERENCE_END;
+  }
+  References = SpdmAppraisalGetReferences (AppraisalDatabase);
+  ZeroMem (References, MaxReferenceCount * sizeof(SPDM_APPRAISAL_REFERENCE));
+  for (Index = 0; Index < MaxReferenceCount; Index++) {
+    References[Index].Next = (Index + 1 < MaxReferenceCount) ? Index + 1 : SPDM_APPRAISAL_REFERENCE_END;
+  }
+  AppraisalDatabase->FreeList = 0;
+  AppraisalDatabase->FreeCount = MaxReferenceCount;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Add a reference value to a reference manifest in a reference database.
+
+  Adding a reference value that the reference manifest already has does nothing.
+
+  @param  Database                     A pointer to the reference database.
+  @param  ManifestId                   The reference manifest.
+  @param  Index                        The measurement index.
+  @param  ValueType                    The DMTFSpecMeasurementValueType.
+  @param  Digest                       The measurement value.
+  @param  DigestSize                   Size in bytes of the measurement value.
+
+  @retval RETURN_SUCCESS               The reference value is added.
+  @retval RETURN_INVALID_PARAMETER     ManifestId is SPDM_APPRAISAL_ANY_MANIFEST, or DigestSize is 0 or larger than MAX_HASH_SIZE.
+  @retval RETURN_OUT_OF_RESOURCES      The reference database is full.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraisalAddReference (
+  IN     VOID                      *Database,
+  IN     UINT32                    ManifestId,
+  IN     UINT8                     Index,
+  IN     UINT8                     ValueType,
+  IN     CONST VOID                *Digest,
+  IN     UINTN                     DigestSize
+  )
+{
+  SPDM_APPRAISAL_DATABASE   *AppraisalDatabase;
+  SPDM_APPRAISAL_REFERENCE  *Reference;
+  UINT32                    *Bucket;
+  UINT32                    ReferenceIndex;
+
+  AppraisalDatabase = Database;
+  ASSERT (AppraisalDatabase->Signature == SPDM_APPRAISAL_DATABASE_SIGNATURE);
+  if ((ManifestId == SPDM_APPRAISAL_ANY_MANIFEST) || (DigestSize == 0) || (DigestSize > MAX_HASH_SIZE)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (SpdmAppraisalFindReference (AppraisalDatabase, ManifestId, Index, ValueType, Digest, DigestSize) != NULL) {
+    return RETURN_SUCCESS;
+  }
+  if (AppraisalDatabase->FreeCount == 0) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  ReferenceIndex = AppraisalDatabase->FreeList;
+  Reference = &SpdmAppraisalGetReferences (AppraisalDatabase)[ReferenceIndex];
+  AppraisalDatabase->FreeList = Reference->Next;
+  AppraisalDatabase->FreeCount--;
+
+  Reference->ManifestId = ManifestId;
+  Reference->Index = Index;
+  Reference->ValueType = ValueType;
+  Reference->DigestSize = (UINT8)DigestSize;
+  CopyMem (Reference->Digest, Digest, DigestSize);
+  //
+  // The latest reference value is first in its bucket chain, so a match reports the latest reference manifest.
+  //
+  Bucket = SpdmAppraisalGetBucket (AppraisalDatabase, Index, ValueType, Digest, DigestSize);
+  Reference->Next = *Bucket;
+  *Bucket = ReferenceIndex;
+  AppraisalDatabase->IndexReferenceCount[Index]++;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Remove a reference value from a reference manifest in a reference database.
+
+  @param  Database                     A pointer to the reference database.
+  @param  ManifestId                   The reference manifest.
+  @param  Index                        The measurement index.
+  @param  ValueType                    The DMTFSpecMeasurementValueType.
+  @param  Digest                       The measurement value.
+  @param  DigestSize                   Size in bytes of the measurement value.
+
+  @retval RETURN_SUCCESS               The reference value is removed.
+  @retval RETURN_NOT_FOUND             The reference manifest has not the reference value.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraisalRemoveReference (
+  IN     VOID                      *Database,
+  IN     UINT32                    ManifestId,
+  IN     UINT8                     Index,
+  IN     UINT8                     ValueType,
+  IN     CONST VOID                *Digest,
+  IN     UINTN                     DigestSize
+  )
+{
+  SPDM_APPRAISAL_DATABASE   *AppraisalDatabase;
+  UINT32                    *Link;
+
+  AppraisalDatabase = Database;
+  ASSERT (AppraisalDatabase->Signature == SPDM_APPRAISAL_DATABASE_SIGNATURE);
+  if ((ManifestId == SPDM_APPRAISAL_ANY_MANIFEST) || (DigestSize == 0) || (DigestSize > MAX_HASH_SIZE)) {
+    return RETURN_NOT_FOUND;
+  }
+  Link = SpdmAppraisalFindReference (AppraisalDatabase, ManifestId, Index, ValueType, Digest, DigestSize);
+  if (Link == NULL) {
+    return RETURN_NOT_FOUND;
+  }
+  SpdmAppraisalFreeReference (AppraisalDatabase, Link);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Load a reference manifest to a reference database.
+
+  The reference manifest is a measurement record, such as the one returned by SpdmGetMeasurement for a known good device.
+  The measurement blocks that are not appraisable are skipped.
+  The reference values are added to those the reference manifest already has, so a reference manifest is updated
+  by SpdmAppraisalRemoveManifest then SpdmAppraisalLoadManifest, without rebuilding the reference database.
+  Nothing is loaded if the reference database has not enough free reference values for all the measurement blocks.
+
+  @param  Database                     A pointer to the reference database.
+  @param  ManifestId                   The reference manifest.
+  @param  MeasurementRecordLength      Size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to the measurement record.
+
+  @retval RETURN_SUCCESS               The reference manifest is loaded.
+  @retval RETURN_INVALID_PARAMETER     ManifestId is SPDM_APPRAISAL_ANY_MANIFEST.
+  @retval RETURN_UNSUPPORTED           The measurement record is malformed.
+  @retval RETURN_OUT_OF_RESOURCES      The reference database is full.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraisalLoadManifest (
+  IN     VOID                      *Database,
+  IN     UINT32                    ManifestId,
+  IN     UINTN                     MeasurementRecordLength,
+  IN     CONST VOID                *MeasurementRecord
+  )
+{
+  SPDM_APPRAISAL_DATABASE   *AppraisalDatabase;
+  SPDM_APPRAISAL_BLOCK      Block;
+  CONST UINT8               *Ptr;
+  CONST UINT8               *End;
+  UINTN                     ReferenceCount;
+  RETURN_STATUS             Status;
+
+  AppraisalDatabase = Database;
+  ASSERT (AppraisalDatabase->Signature == SPDM_APPRAISAL_DATABASE_SIGNATURE);
+  if (ManifestId == SPDM_APPRAISAL_ANY_MANIFEST) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  //
+  // Validate the whole reference manifest first, so that it is loaded entirely or not at all.
+  //
+  ReferenceCount = 0;
+  Ptr = MeasurementRecord;
+  End = Ptr + MeasurementRecordLength;
+  while (Ptr < End) {
+    if (!SpdmAppraisalParseBlock (&Ptr, End, &Block)) {
+      return RETURN_UNSUPPORTED;
+    }
+    if (Block.Appraisable) {
+      ReferenceCount++;
+    }
+  }
+  if (ReferenceCount > AppraisalDatabase->FreeCount) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  Ptr = MeasurementRecord;
+  while (Ptr < End) {
+    SpdmAppraisalParseBlock (&Ptr, End, &Block);
+    if (!Block.Appraisable) {
+      DEBUG((DEBUG_INFO, "SpdmAppraisalLoadManifest - skip measurement index %d\n", Block.Index));
+      continue;
+    }
+    Status = SpdmAppraisalAddReference (AppraisalDatabase, ManifestId, Block.Index, Block.ValueType, Block.Digest, Block.DigestSize);
+    ASSERT_RETURN_ERROR (Status);
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Remove all the reference values of a reference manifest from a reference database.
+
+  @param  Database                     A pointer to the reference database.
+  @param  ManifestId                   The reference manifest.
+
+  @retval RETURN_SUCCESS               The reference manifest is removed.
+  @retval RETURN_NOT_FOUND             The reference database has no reference value of the reference manifest.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraisalRemoveManifest (
+  IN     VOID                      *Database,
+  IN     UINT32                    ManifestId
+  )
+{
+  SPDM_APPRAISAL_DATABASE   *AppraisalDatabase;
+  SPDM_APPRAISAL_REFERENCE  *References;
+  UINT32                    *Buckets;
+  UINT32                    *Link;
+  UINT32                    Index;
+  BOOLEAN                   Found;
+
+  AppraisalDatabase = Database;
+  ASSERT (AppraisalDatabase->Signature == SPDM_APPRAISAL_DATABASE_SIGNATURE);
+  if (ManifestId == SPDM_APPRAISAL_ANY_MANIFEST) {
+    return RETURN_NOT_FOUND;
+  }
+
+  Found = FALSE;
+  Buckets = SpdmAppraisalGetBuckets (AppraisalDatabase);
+  References = SpdmAppraisalGetReferences (AppraisalDatabase);
+  for (Index = 0; Index <= AppraisalDatabase->BucketMask; Index++) {
+    Link = &Buckets[Index];
+    while (*Link != SPDM_APPRAISAL_REFERENCE_END) {
+      if (References[*Link].ManifestId == ManifestId) {
+        SpdmAppraisalFreeReference (AppraisalDatabase, Link);
+        Found = TRUE;
+      } else {
+        Link = &References[*Link].Next;
+      }
+    }
+  }
+  return Found ? RETURN_SUCCESS : RETURN_NOT_FOUND;
+}
+
+/**
+  Appraise a measurement record returned by SpdmGetMeasurement against a reference database, in one pass.
+
+  With SPDM_APPRAISAL_ANY_MANIFEST, a measurement value matches if it is a reference value of any reference manifest.
+  Otherwise, it matches only if it is a reference value of the reference manifest ManifestId.
+  A measurement index has reference values if any reference manifest has reference values for it.
+
+  @param  Database                     A pointer to the reference database.
+  @param  ManifestId                   The reference manifest, or SPDM_APPRAISAL_ANY_MANIFEST.
+  @param  NumberOfBlocks               The number of measurement blocks in the measurement record.
+  @param  MeasurementRecordLength      Size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to the measurement record.
+  @param  ResultCount                  On input, the number of entries of Results.
+                                       On output, the number of measurement blocks.
+  @param  Results                      The appraisal of each measurement block, in the order of the measurement record.
+                                       It may be NULL if ResultCount is 0 on input.
+
+  @retval RETURN_SUCCESS               No measurement value is mismatched.
+  @retval RETURN_SECURITY_VIOLATION    A measurement value is mismatched.
+  @retval RETURN_UNSUPPORTED           The measurement record is malformed, or has not NumberOfBlocks blocks.
+  @retval RETURN_BUFFER_TOO_SMALL      Results is too small. ResultCount is set to the number of measurement blocks.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAppraiseMeasurementRecord (
+  IN     VOID                      *Database,
+  IN     UINT32                    ManifestId,
+  IN     UINT8                     NumberOfBlocks,
+  IN     UINTN                     MeasurementRecordLength,
+  IN     CONST VOID                *MeasurementRecord,
+  IN OUT UINTN                     *ResultCount,
+     OUT SPDM_APPRAISAL_RESULT     *Results OPTIONAL
+  )
+{
+  SPDM_APPRAISAL_DATABASE   *AppraisalDatabase;
+  SPDM_APPRAISAL_BLOCK      Block;
+  SPDM_APPRAISAL_RESULT     Result;
+  CONST UINT8               *Ptr;
+  CONST UINT8               *End;
+  UINT32                    *Link;
+  UINTN                     BlockCount;
+  BOOLEAN                   Mismatched;
+
+  AppraisalDatabase = Database;
+  ASSERT (AppraisalDatabase->Signature == SPDM_APPRAISAL_DATABASE_SIGNATURE);
+
+  BlockCount = 0;
+  Mismatched = FALSE;
+  Ptr = MeasurementRecord;
+  End = Ptr + MeasurementRecordLength;
+  while (Ptr < End) {
+    if (!SpdmAppraisalParseBlock (&Ptr, End, &Block)) {
+      return RETURN_UNSUPPORTED;
+    }
+
+    ZeroMem (&Result, sizeof(Result));
+    Result.Index = Block.Index;
+    Result.DMTFSpecMeasurementValueType = Block.ValueType;
+    if (!Block.Appraisable) {
+      Result.Status = SpdmAppraisalNotAppraisable;
+    } else if (AppraisalDatabase->IndexReferenceCount[Block.Index] == 0) {
+      Result.Status = SpdmAppraisalNoReference;
+    } else {
+      Link = SpdmAppraisalFindReference (AppraisalDatabase, ManifestId, Block.Index, Block.ValueType, Block.Digest, Block.DigestSize);
+      if (Link != NULL) {
+        Result.Status = SpdmAppraisalMatch;
+        Result.ManifestId = SpdmAppraisalGetReferences (AppraisalDatabase)[*Link].ManifestId;
+      } else {
+        Result.Status = SpdmAppraisalMismatch;
+        Mismatched = TRUE;
+      }
+    }
+
+    if (BlockCount < *ResultCount) {
+      CopyMem (&Results[BlockCount], &Result, sizeof(Result));
+    }
+    BlockCount++;
+  }
+
+  if (BlockCount != NumberOfBlocks) {
+    return RETURN_UNSUPPORTED;
+  }
+  if (BlockCount > *ResultCount) {
+    *ResultCount = BlockCount;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *ResultCount = BlockCount;
+  return Mismatched ? RETURN_SECURITY_VIOLATION : RETURN_SUCCESS;
+}
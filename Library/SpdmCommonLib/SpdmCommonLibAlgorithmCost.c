@@ -0,0 +1,203 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmCommonLibInternal.h"
+
+typedef struct {
+  UINT32   Algo;
+  UINT16   SecurityStrength;
+} SPDM_ALGORITHM_STRENGTH;
+
+//
+// The security strength in bits of each algorithm, as in NIST SP 800-57 Part 1.
+// The collision resistance of the hash algorithms is used, because it bounds the signatures.
+//
+SPDM_ALGORITHM_STRENGTH mSpdmAsymStrength[] = {
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048,         112},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048,         112},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072,         128},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072,         128},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256, 128},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096,         152},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096,         152},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384, 192},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521, 256},
+};
+
+SPDM_ALGORITHM_STRENGTH mSpdmHashStrength[] = {
+  {SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256,  128},
+  {SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384,  192},
+  {SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512,  256},
+  {SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256, 128},
+  {SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384, 192},
+  {SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512, 256},
+};
+
+SPDM_ALGORITHM_STRENGTH mSpdmDheStrength[] = {
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048,  112},
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072,  128},
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096,  152},
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1, 128},
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1, 192},
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1, 256},
+};
+
+SPDM_ALGORITHM_STRENGTH mSpdmAeadStrength[] = {
+  {SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM,       128},
+  {SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM,       256},
+  {SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305, 256},
+};
+
+/**
+  Return the algorithms of a bitmask with at least the minimum security strength.
+
+  The algorithms without a known security strength are removed.
+
+  @param  StrengthTable                The security strength of the algorithms of the bitmask.
+  @param  StrengthTableCount           The count of the security strength table entry.
+  @param  Algo                         The algorithm bitmask.
+  @param  MinSecurityStrength          The minimum security strength in bits.
+
+  @return the algorithms with at least the minimum security strength.
+**/
+UINT32
+SpdmFilterAlgorithmByStrength (
+  IN     CONST SPDM_ALGORITHM_STRENGTH  *StrengthTable,
+  IN     UINTN                          StrengthTableCount,
+  IN     UINT32                         Algo,
+  IN     UINT16                         MinSecurityStrength
+  )
+{
+  UINT32  StrongAlgo;
+  UINTN   Index;
+
+  StrongAlgo = 0;
+  for (Index = 0; Index < StrengthTableCount; Index++) {
+    if (StrengthTable[Index].SecurityStrength >= MinSecurityStrength) {
+      StrongAlgo |= StrengthTable[Index].Algo;
+    }
+  }
+  return Algo & StrongAlgo;
+}
+
+/**
+  Set the algorithm cost model of an SPDM context.
+
+  The local algorithms below MinSecurityStrength are neither offered by the requester nor selected by the responder,
+  and the requester rejects an ALGORITHMS selecting one of them. The responder selects the common algorithm
+  with the lowest cost in each of BaseAsymAlgo, BaseHashAlgo, DHENamedGroup, AEADCipherSuite and ReqBaseAsymAlg.
+  The algorithms with the same or an unknown cost are selected by the default priority.
+  The NEGOTIATE_ALGORITHMS request has no order, so the costs are not used by the requester.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CostModel                    The algorithm cost model, or NULL to select by the default priority.
+**/
+VOID
+EFIAPI
+SpdmSetAlgorithmCostModel (
+  IN     VOID                                *Context,
+  IN     CONST SPDM_ALGORITHM_COST_MODEL     *CostModel OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT        *SpdmContext;
+
+  SpdmContext = Context;
+  if (CostModel == NULL) {
+    SpdmContext->AlgorithmCostModelEnabled = FALSE;
+    ZeroMem (&SpdmContext->AlgorithmCostModel, sizeof(SpdmContext->AlgorithmCostModel));
+  } else {
+    SpdmContext->AlgorithmCostModelEnabled = TRUE;
+    CopyMem (&SpdmContext->AlgorithmCostModel, CostModel, sizeof(SpdmContext->AlgorithmCostModel));
+  }
+  //
+  // The cached selection may be made with other costs.
+  //
+  SpdmContext->AlgorithmSelectionCache.Valid = FALSE;
+}
+
+/**
+  Return the local algorithms of an SPDM context which may be negotiated.
+
+  They are the local algorithms, without the ones below MinSecurityStrength of the algorithm cost model.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Algorithm                    The local algorithms which may be negotiated.
+**/
+VOID
+SpdmGetNegotiableAlgorithm (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+     OUT SPDM_DEVICE_ALGORITHM        *Algorithm
+  )
+{
+  UINT16                     MinSecurityStrength;
+
+  CopyMem (Algorithm, &SpdmContext->LocalContext.Algorithm, sizeof(SPDM_DEVICE_ALGORITHM));
+  if (!SpdmContext->AlgorithmCostModelEnabled || (SpdmContext->AlgorithmCostModel.MinSecurityStrength == 0)) {
+    return ;
+  }
+
+  MinSecurityStrength = SpdmContext->AlgorithmCostModel.MinSecurityStrength;
+  Algorithm->BaseAsymAlgo = SpdmFilterAlgorithmByStrength (
+                              mSpdmAsymStrength,
+                              ARRAY_SIZE(mSpdmAsymStrength),
+                              Algorithm->BaseAsymAlgo,
+                              MinSecurityStrength
+                              );
+  Algorithm->BaseHashAlgo = SpdmFilterAlgorithmByStrength (
+                              mSpdmHashStrength,
+                              ARRAY_SIZE(mSpdmHashStrength),
+                              Algorithm->BaseHashAlgo,
+                              MinSecurityStrength
+                              );
+  Algorithm->DHENamedGroup = (UINT16)SpdmFilterAlgorithmByStrength (
+                               mSpdmDheStrength,
+                               ARRAY_SIZE(mSpdmDheStrength),
+                               Algorithm->DHENamedGroup,
+                               MinSecurityStrength
+                               );
+  Algorithm->AEADCipherSuite = (UINT16)SpdmFilterAlgorithmByStrength (
+                                 mSpdmAeadStrength,
+                                 ARRAY_SIZE(mSpdmAeadStrength),
+                                 Algorithm->AEADCipherSuite,
+                                 MinSecurityStrength
+                                 );
+  Algorithm->ReqBaseAsymAlg = (UINT16)SpdmFilterAlgorithmByStrength (
+                                mSpdmAsymStrength,
+                                ARRAY_SIZE(mSpdmAsymStrength),
+                                Algorithm->ReqBaseAsymAlg,
+                                MinSecurityStrength
+                                );
+}
+
+/**
+  Return the cost of an algorithm from a cost table of the algorithm cost model.
+
+  @param  CostTable                    The costs of the algorithm bitmask, indexed by the bit number.
+  @param  Algo                         The algorithm, one bit of the bitmask.
+
+  @return the cost of the algorithm, or MAX_UINT32 if it is unknown.
+**/
+UINT32
+SpdmGetAlgorithmCost (
+  IN     CONST UINT32                 *CostTable,
+  IN     UINT32                       Algo
+  )
+{
+  UINTN   Index;
+
+  for (Index = 0; Index < SPDM_ALGORITHM_COST_COUNT; Index++) {
+    if (Algo == ((UINT32)1 << Index)) {
+      if (CostTable[Index] == 0) {
+        break;
+      }
+      return CostTable[Index];
+    }
+  }
+  return MAX_UINT32;
+}
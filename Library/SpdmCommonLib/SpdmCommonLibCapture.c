@@ -0,0 +1,373 @@
+/** @file
+  SPDM common library.
+  It captures the transport layer messages sent and received, for SpdmDump.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmCommonLibInternal.h"
+#include <IndustryStandard/Pcap.h>
+
+#define SPDM_CAPTURE_RING_SIGNATURE  SIGNATURE_32('S', 'P', 'C', 'R')
+
+//
+// The timestamp resolution of the interface, 10^-7 seconds, the 100ns unit of SPDM_CAPTURE_GET_TIME_FUNC.
+//
+#define SPDM_CAPTURE_TSRESOL  7
+
+#define SPDM_CAPTURE_SNAP_LEN  0x00010000
+
+//
+// The capture ring is followed by DataSize bytes of enhanced packet blocks, from the oldest one at Head.
+// Used is the size of the blocks, which wrap around the end of the data.
+// A block is a multiple of 4 bytes and DataSize is a multiple of 4, so that the UINT32 fields of a block
+// never wrap around, though a block may.
+//
+typedef struct {
+  UINT32                     Signature;
+  UINT16                     LinkType;
+  UINT16                     Reserved;
+  UINTN                      DataSize;
+  UINTN                      Head;
+  UINTN                      Used;
+  UINT64                     DroppedCount;
+} SPDM_CAPTURE_RING;
+
+#pragma pack(1)
+
+//
+// The interface description block of the export, with the if_tsresol option.
+//
+typedef struct {
+  PCAPNG_INTERFACE_DESCRIPTION_BLOCK  Block;
+  PCAPNG_OPTION_HEADER                TsResolHeader;
+  UINT8                               TsResol;
+  UINT8                               TsResolPadding[3];
+  PCAPNG_OPTION_HEADER                EndOfOpt;
+  UINT32                              BlockTotalLength;
+} SPDM_CAPTURE_INTERFACE_DESCRIPTION;
+
+typedef struct {
+  PCAPNG_SECTION_HEADER_BLOCK         Block;
+  UINT32                              BlockTotalLength;
+} SPDM_CAPTURE_SECTION_HEADER;
+
+#pragma pack()
+
+/**
+  Register the capture function, called for each transport layer message sent or received successfully.
+
+  The messages are sampled by exchange: one message in SampleInterval is captured, with the message following it,
+  which is its response or its request. A SampleInterval of 0 or 1 captures all the messages.
+  The capture function of SpdmCaptureRingSink keeps the messages in a ring for an export to SpdmDump.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CaptureFunc                  The capture function, or NULL to stop the capture.
+  @param  CaptureContext               The context passed to the capture function.
+  @param  GetTimeFunc                  The function to return the time of the messages, or NULL for a time of 0.
+  @param  SampleInterval               The sampling interval of the messages.
+  @param  MaxCaptureSize               The size cap of a captured message, or 0 for no cap.
+**/
+VOID
+EFIAPI
+SpdmRegisterCaptureFunc (
+  IN     VOID                        *Context,
+  IN     SPDM_CAPTURE_FUNC           CaptureFunc OPTIONAL,
+  IN     VOID                        *CaptureContext OPTIONAL,
+  IN     SPDM_CAPTURE_GET_TIME_FUNC  GetTimeFunc OPTIONAL,
+  IN     UINT32                      SampleInterval,
+  IN     UINTN                       MaxCaptureSize
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->Capture.CaptureFunc = (UINTN)CaptureFunc;
+  SpdmContext->Capture.CaptureContext = CaptureContext;
+  SpdmContext->Capture.GetTimeFunc = (UINTN)GetTimeFunc;
+  SpdmContext->Capture.SampleInterval = SampleInterval;
+  SpdmContext->Capture.SampleCount = 0;
+  SpdmContext->Capture.SamplePending = FALSE;
+  SpdmContext->Capture.MaxCaptureSize = MaxCaptureSize;
+}
+
+/**
+  Pass a transport layer message sent or received to the capture function, if the message is sampled.
+
+  @param  SpdmContext                  A pointer to the SPDM context, with a capture function registered.
+  @param  IsSend                       TRUE for a message sent, FALSE for a message received.
+  @param  MessageSize                  Size in bytes of the message.
+  @param  Message                      A pointer to the message.
+**/
+VOID
+SpdmCaptureMessage (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     BOOLEAN                   IsSend,
+  IN     UINTN                     MessageSize,
+  IN     CONST VOID                *Message
+  )
+{
+  SPDM_CAPTURE_CONFIG         *Capture;
+  SPDM_CAPTURE_PACKET         Packet;
+  SPDM_CAPTURE_GET_TIME_FUNC  GetTimeFunc;
+
+  Capture = &SpdmContext->Capture;
+  if (Capture->SamplePending) {
+    Capture->SamplePending = FALSE;
+  } else {
+    Capture->SampleCount++;
+    if (Capture->SampleCount < Capture->SampleInterval) {
+      return ;
+    }
+    Capture->SampleCount = 0;
+    Capture->SamplePending = TRUE;
+  }
+
+  GetTimeFunc = (SPDM_CAPTURE_GET_TIME_FUNC)Capture->GetTimeFunc;
+  Packet.Timestamp = (GetTimeFunc != NULL) ? GetTimeFunc (SpdmContext) : 0;
+  Packet.IsSend = IsSend;
+  Packet.OriginalSize = MessageSize;
+  Packet.CapturedSize = MessageSize;
+  if ((Capture->MaxCaptureSize != 0) && (Packet.CapturedSize > Capture->MaxCaptureSize)) {
+    Packet.CapturedSize = Capture->MaxCaptureSize;
+  }
+  Packet.Message = Message;
+  ((SPDM_CAPTURE_FUNC)Capture->CaptureFunc) (SpdmContext, Capture->CaptureContext, &Packet);
+}
+
+/**
+  Copy bytes to the data of a capture ring, wrapping around the end of the data.
+
+  @param  Ring                         A pointer to the capture ring.
+  @param  Offset                       The offset in the data to copy to.
+  @param  Buffer                       The bytes to copy, or NULL to zero them.
+  @param  Size                         The number of bytes.
+
+  @return the offset in the data following the bytes.
+**/
+STATIC
+UINTN
+SpdmCaptureRingWrite (
+  IN OUT SPDM_CAPTURE_RING         *Ring,
+  IN     UINTN                     Offset,
+  IN     CONST VOID                *Buffer OPTIONAL,
+  IN     UINTN                     Size
+  )
+{
+  UINT8                     *Data;
+  UINTN                     Part;
+
+  Data = (UINT8 *)(Ring + 1);
+  while (Size != 0) {
+    Part = Ring->DataSize - Offset;
+    if (Part > Size) {
+      Part = Size;
+    }
+    if (Buffer != NULL) {
+      CopyMem (Data + Offset, Buffer, Part);
+      Buffer = (CONST UINT8 *)Buffer + Part;
+    } else {
+      ZeroMem (Data + Offset, Part);
+    }
+    Offset = (Offset + Part == Ring->DataSize) ? 0 : Offset + Part;
+    Size -= Part;
+  }
+  return Offset;
+}
+
+/**
+  Copy bytes from the data of a capture ring, wrapping around the end of the data.
+
+  @param  Ring                         A pointer to the capture ring.
+  @param  Offset                       The offset in the data to copy from.
+  @param  Buffer                       The buffer to copy to.
+  @param  Size                         The number of bytes.
+**/
+STATIC
+VOID
+SpdmCaptureRingRead (
+  IN     SPDM_CAPTURE_RING         *Ring,
+  IN     UINTN                     Offset,
+     OUT VOID                      *Buffer,
+  IN     UINTN                     Size
+  )
+{
+  UINT8                     *Data;
+  UINTN                     Part;
+
+  Data = (UINT8 *)(Ring + 1);
+  Part = Ring->DataSize - Offset;
+  if (Part > Size) {
+    Part = Size;
+  }
+  CopyMem (Buffer, Data + Offset, Part);
+  CopyMem ((UINT8 *)Buffer + Part, Data, Size - Part);
+}
+
+/**
+  Initialize a capture ring in a buffer, for SpdmCaptureRingSink.
+
+  The ring keeps the most recent messages: the oldest ones are overwritten once the ring is full.
+  It is not locked, so a ring is shared by the SPDM contexts of one thread only.
+
+  @param  Ring                         A pointer to the buffer of the capture ring.
+  @param  RingSize                     Size in bytes of the buffer.
+  @param  LinkType                     The pcap data link type of the transport layer, such as LINKTYPE_MCTP.
+
+  @retval RETURN_SUCCESS               The capture ring is initialized.
+  @retval RETURN_BUFFER_TOO_SMALL      RingSize is too small for a capture ring.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmCaptureRingInit (
+  OUT    VOID                      *Ring,
+  IN     UINTN                     RingSize,
+  IN     UINT16                    LinkType
+  )
+{
+  SPDM_CAPTURE_RING         *CaptureRing;
+
+  if (RingSize < sizeof(SPDM_CAPTURE_RING) + sizeof(PCAPNG_ENHANCED_PACKET_BLOCK) + sizeof(UINT32)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  CaptureRing = Ring;
+  CaptureRing->Signature = SPDM_CAPTURE_RING_SIGNATURE;
+  CaptureRing->LinkType = LinkType;
+  CaptureRing->Reserved = 0;
+  CaptureRing->DataSize = (RingSize - sizeof(SPDM_CAPTURE_RING)) & ~(UINTN)0x3;
+  CaptureRing->Head = 0;
+  CaptureRing->Used = 0;
+  CaptureRing->DroppedCount = 0;
+  return RETURN_SUCCESS;
+}
+
+/**
+  The capture function appending the message to the capture ring CaptureContext, as a pcapng packet block.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CaptureContext               A pointer to the capture ring.
+  @param  Packet                       The message.
+**/
+VOID
+EFIAPI
+SpdmCaptureRingSink (
+  IN     VOID                      *SpdmContext,
+  IN     VOID                      *CaptureContext,
+  IN     CONST SPDM_CAPTURE_PACKET *Packet
+  )
+{
+  SPDM_CAPTURE_RING             *Ring;
+  PCAPNG_ENHANCED_PACKET_BLOCK  EnhancedPacket;
+  PCAPNG_BLOCK_HEADER           OldestBlock;
+  UINTN                         CapturedSize;
+  UINTN                         BlockSize;
+  UINTN                         Offset;
+
+  Ring = CaptureContext;
+  ASSERT (Ring->Signature == SPDM_CAPTURE_RING_SIGNATURE);
+
+  CapturedSize = (Packet->CapturedSize > SPDM_CAPTURE_SNAP_LEN) ? SPDM_CAPTURE_SNAP_LEN : Packet->CapturedSize;
+  BlockSize = sizeof(EnhancedPacket) + ALIGN_VALUE (CapturedSize, sizeof(UINT32)) + sizeof(UINT32);
+  if (BlockSize > Ring->DataSize) {
+    Ring->DroppedCount++;
+    return ;
+  }
+
+  //
+  // Overwrite the oldest blocks.
+  //
+  while (Ring->DataSize - Ring->Used < BlockSize) {
+    SpdmCaptureRingRead (Ring, Ring->Head, &OldestBlock, sizeof(OldestBlock));
+    Ring->Head = (Ring->Head + OldestBlock.BlockTotalLength) % Ring->DataSize;
+    Ring->Used -= OldestBlock.BlockTotalLength;
+    Ring->DroppedCount++;
+  }
+
+  EnhancedPacket.Header.BlockType = PCAPNG_BLOCK_TYPE_ENHANCED_PACKET;
+  EnhancedPacket.Header.BlockTotalLength = (UINT32)BlockSize;
+  EnhancedPacket.InterfaceId = 0;
+  EnhancedPacket.TimestampHigh = (UINT32)(Packet->Timestamp >> 32);
+  EnhancedPacket.TimestampLow = (UINT32)Packet->Timestamp;
+  EnhancedPacket.CapturedPacketLength = (UINT32)CapturedSize;
+  EnhancedPacket.OriginalPacketLength = (UINT32)Packet->OriginalSize;
+
+  Offset = (Ring->Head + Ring->Used) % Ring->DataSize;
+  Offset = SpdmCaptureRingWrite (Ring, Offset, &EnhancedPacket, sizeof(EnhancedPacket));
+  Offset = SpdmCaptureRingWrite (Ring, Offset, Packet->Message, CapturedSize);
+  Offset = SpdmCaptureRingWrite (Ring, Offset, NULL, ALIGN_VALUE (CapturedSize, sizeof(UINT32)) - CapturedSize);
+  SpdmCaptureRingWrite (Ring, Offset, &EnhancedPacket.Header.BlockTotalLength, sizeof(UINT32));
+  Ring->Used += BlockSize;
+}
+
+/**
+  Export the messages of a capture ring as a pcapng file, from the oldest one.
+
+  The timestamp resolution of the interface is 100ns, the unit of SPDM_CAPTURE_GET_TIME_FUNC.
+
+  @param  Ring                         A pointer to the capture ring.
+  @param  PcapSize                     On input, the size in bytes of the Pcap buffer.
+                                       On output, the size in bytes of the pcapng file.
+  @param  Pcap                         A pointer to the buffer to export the pcapng file to.
+  @param  DroppedCount                 The number of messages overwritten or too large for the ring since
+                                       SpdmCaptureRingInit. It may be NULL.
+
+  @retval RETURN_SUCCESS               The pcapng file is exported.
+  @retval RETURN_BUFFER_TOO_SMALL      The Pcap buffer is too small. PcapSize is set to the required size.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmCaptureRingExport (
+  IN     VOID                      *Ring,
+  IN OUT UINTN                     *PcapSize,
+     OUT VOID                      *Pcap,
+     OUT UINT64                    *DroppedCount OPTIONAL
+  )
+{
+  SPDM_CAPTURE_RING                   *CaptureRing;
+  SPDM_CAPTURE_SECTION_HEADER         SectionHeader;
+  SPDM_CAPTURE_INTERFACE_DESCRIPTION  InterfaceDescription;
+  UINTN                               TotalSize;
+  UINT8                               *Ptr;
+
+  CaptureRing = Ring;
+  ASSERT (CaptureRing->Signature == SPDM_CAPTURE_RING_SIGNATURE);
+
+  if (DroppedCount != NULL) {
+    *DroppedCount = CaptureRing->DroppedCount;
+  }
+  TotalSize = sizeof(SectionHeader) + sizeof(InterfaceDescription) + CaptureRing->Used;
+  if (*PcapSize < TotalSize) {
+    *PcapSize = TotalSize;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *PcapSize = TotalSize;
+
+  SectionHeader.Block.Header.BlockType = PCAPNG_BLOCK_TYPE_SECTION_HEADER;
+  SectionHeader.Block.Header.BlockTotalLength = sizeof(SectionHeader);
+  SectionHeader.Block.ByteOrderMagic = PCAPNG_BYTE_ORDER_MAGIC;
+  SectionHeader.Block.VersionMajor = PCAPNG_SECTION_HEADER_VERSION_MAJOR;
+  SectionHeader.Block.VersionMinor = PCAPNG_SECTION_HEADER_VERSION_MINOR;
+  SectionHeader.Block.SectionLength = -1;
+  SectionHeader.BlockTotalLength = sizeof(SectionHeader);
+
+  ZeroMem (&InterfaceDescription, sizeof(InterfaceDescription));
+  InterfaceDescription.Block.Header.BlockType = PCAPNG_BLOCK_TYPE_INTERFACE_DESCRIPTION;
+  InterfaceDescription.Block.Header.BlockTotalLength = sizeof(InterfaceDescription);
+  InterfaceDescription.Block.LinkType = CaptureRing->LinkType;
+  InterfaceDescription.Block.SnapLen = SPDM_CAPTURE_SNAP_LEN;
+  InterfaceDescription.TsResolHeader.OptionCode = PCAPNG_OPTION_IF_TSRESOL;
+  InterfaceDescription.TsResolHeader.OptionLength = sizeof(UINT8);
+  InterfaceDescription.TsResol = SPDM_CAPTURE_TSRESOL;
+  InterfaceDescription.EndOfOpt.OptionCode = PCAPNG_OPTION_END_OF_OPT;
+  InterfaceDescription.BlockTotalLength = sizeof(InterfaceDescription);
+
+  Ptr = Pcap;
+  CopyMem (Ptr, &SectionHeader, sizeof(SectionHeader));
+  Ptr += sizeof(SectionHeader);
+  CopyMem (Ptr, &InterfaceDescription, sizeof(InterfaceDescription));
+  Ptr += sizeof(InterfaceDescription);
+  SpdmCaptureRingRead (CaptureRing, CaptureRing->Head, Ptr, CaptureRing->Used);
+  return RETURN_SUCCESS;
+}
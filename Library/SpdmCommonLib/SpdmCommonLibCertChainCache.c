@@ -0,0 +1,759 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmCommonLibInternal.h"
+
+/**
+  Acquire the lock of a certificate chain verification cache, if the cache has one.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+**/
+VOID
+SpdmCertChainCacheLock (
+  IN SPDM_CERT_CHAIN_CACHE        *Cache
+  )
+{
+  if (Cache->AcquireLock != NULL) {
+    Cache->AcquireLock (Cache->LockContext);
+  }
+}
+
+/**
+  Release the lock of a certificate chain verification cache, if the cache has one.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+**/
+VOID
+SpdmCertChainCacheUnlock (
+  IN SPDM_CERT_CHAIN_CACHE        *Cache
+  )
+{
+  if (Cache->ReleaseLock != NULL) {
+    Cache->ReleaseLock (Cache->LockContext);
+  }
+}
+
+/**
+  Release the public key held by a certificate chain verification cache entry.
+
+  @param  Entry                        A pointer to the cache entry.
+**/
+VOID
+SpdmCertChainCacheFreePublicKey (
+  IN OUT SPDM_CERT_CHAIN_CACHE_ENTRY  *Entry
+  )
+{
+  if (Entry->PublicKey != NULL) {
+    if (Entry->PublicKeyIsReqAsym) {
+      SpdmReqAsymFree ((UINT16)Entry->PublicKeyAsymAlgo, Entry->PublicKey);
+    } else {
+      SpdmAsymFree (Entry->PublicKeyAsymAlgo, Entry->PublicKey);
+    }
+  }
+  Entry->PublicKey = NULL;
+  Entry->PublicKeyIsReqAsym = FALSE;
+  Entry->PublicKeyAsymAlgo = 0;
+}
+
+/**
+  Find the entry of a verified certificate chain in a certificate chain verification cache.
+
+  The cache lock must be held by the caller.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo of CertChainHash.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+
+  @return the cache entry, or NULL if the certificate chain is not in the cache.
+**/
+SPDM_CERT_CHAIN_CACHE_ENTRY *
+SpdmCertChainCacheFindEntry (
+  IN SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN UINT32                       BaseHashAlgo,
+  IN CONST UINT8                  *CertChainHash
+  )
+{
+  SPDM_CERT_CHAIN_CACHE_ENTRY   *Entry;
+  UINTN                         Index;
+
+  Entry = (SPDM_CERT_CHAIN_CACHE_ENTRY *)(Cache + 1);
+  for (Index = 0; Index < Cache->EntryCount; Index++) {
+    if (Entry[Index].Valid &&
+        (Entry[Index].BaseHashAlgo == BaseHashAlgo) &&
+        (CompareMem (Entry[Index].CertChainHash, CertChainHash, GetSpdmHashSize (BaseHashAlgo)) == 0)) {
+      return &Entry[Index];
+    }
+  }
+  return NULL;
+}
+
+/**
+  Return the entries of a shared certificate chain verification cache.
+
+  @param  Shared                       A pointer to the shared certificate chain verification cache.
+
+  @return the first entry.
+**/
+SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY *
+SpdmSharedCertChainCacheGetEntries (
+  IN SPDM_SHARED_CERT_CHAIN_CACHE *Shared
+  )
+{
+  return (SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY *)(Shared + 1);
+}
+
+/**
+  Return the first entry probed for a certificate chain in a shared certificate chain verification cache.
+
+  @param  Shared                       A pointer to the shared certificate chain verification cache.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+
+  @return the index of the first probed entry.
+**/
+UINT32
+SpdmSharedCertChainCacheGetSlot (
+  IN SPDM_SHARED_CERT_CHAIN_CACHE *Shared,
+  IN CONST UINT8                  *CertChainHash
+  )
+{
+  UINT32                        Key;
+
+  Key = CertChainHash[0] | ((UINT32)CertChainHash[1] << 8) | ((UINT32)CertChainHash[2] << 16) | ((UINT32)CertChainHash[3] << 24);
+  return Key % Shared->EntryCount;
+}
+
+/**
+  Copy an entry of a shared certificate chain verification cache, without a lock, if it holds a certificate chain.
+
+  @param  Entry                        A pointer to the shared cache entry.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo of CertChainHash.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+  @param  Copy                         The consistent copy of the entry.
+
+  @retval TRUE  The entry holds the certificate chain, and is copied.
+  @retval FALSE The entry holds another certificate chain, or is being updated.
+**/
+BOOLEAN
+SpdmSharedCertChainCacheReadEntry (
+  IN     SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY  *Entry,
+  IN     UINT32                              BaseHashAlgo,
+  IN     CONST UINT8                         *CertChainHash,
+     OUT SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY  *Copy
+  )
+{
+  UINT32                        Sequence;
+  UINTN                         Retry;
+
+  for (Retry = 0; Retry < SPDM_SHARED_CERT_CHAIN_CACHE_READ_RETRY; Retry++) {
+    Sequence = SPDM_LOAD_ACQUIRE (&Entry->Sequence);
+    if (Sequence == 0) {
+      return FALSE;
+    }
+    if ((Sequence & 1) != 0) {
+      continue;
+    }
+    //
+    // The copy may be torn by a concurrent update. It is used only if Sequence is unchanged after it.
+    //
+    CopyMem (Copy, (VOID *)Entry, sizeof(SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY));
+    SPDM_ACQUIRE_FENCE ();
+    if (Entry->Sequence != Sequence) {
+      continue;
+    }
+    return (BOOLEAN)((Copy->BaseHashAlgo == BaseHashAlgo) &&
+                     (Copy->PublicKeyInfoSize <= MAX_SPDM_SHARED_PUBLIC_KEY_INFO_SIZE) &&
+                     (CompareMem (Copy->CertChainHash, CertChainHash, GetSpdmHashSize (BaseHashAlgo)) == 0));
+  }
+  return FALSE;
+}
+
+/**
+  Find a verified certificate chain in a shared certificate chain verification cache, without a lock.
+
+  @param  Shared                       A pointer to the shared certificate chain verification cache.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo of CertChainHash.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+  @param  Copy                         The consistent copy of the entry of the certificate chain.
+
+  @retval TRUE  The certificate chain is found.
+  @retval FALSE The certificate chain is not in the shared cache, or its entry is being updated.
+**/
+BOOLEAN
+SpdmSharedCertChainCacheFind (
+  IN     SPDM_SHARED_CERT_CHAIN_CACHE        *Shared,
+  IN     UINT32                              BaseHashAlgo,
+  IN     CONST UINT8                         *CertChainHash,
+     OUT SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY  *Copy
+  )
+{
+  SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY  *Entry;
+  UINT32                              Slot;
+  UINT32                              Probe;
+
+  Slot = SpdmSharedCertChainCacheGetSlot (Shared, CertChainHash);
+  for (Probe = 0; (Probe < SPDM_SHARED_CERT_CHAIN_CACHE_PROBE_COUNT) && (Probe < Shared->EntryCount); Probe++) {
+    Entry = &SpdmSharedCertChainCacheGetEntries (Shared)[(Slot + Probe) % Shared->EntryCount];
+    if (SpdmSharedCertChainCacheReadEntry (Entry, BaseHashAlgo, CertChainHash, Copy)) {
+      //
+      // LastUse only guides the replacement, so a lost update from concurrent readers is harmless.
+      //
+      Entry->LastUse = Shared->PublishCount;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Publish a verified certificate chain to a shared certificate chain verification cache.
+
+  The publication is skipped if another process is publishing. An empty entry is taken first, then the
+  least recently used one among the probed entries.
+
+  @param  Shared                       A pointer to the shared certificate chain verification cache.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo of CertChainHash and LeafCertHash.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+  @param  LeafCertHash                 The hash of the leaf certificate of the certificate chain.
+  @param  PublicKeyInfo                The DER-encoded SubjectPublicKeyInfo of the leaf certificate, or NULL.
+  @param  PublicKeyInfoSize            Size in bytes of the SubjectPublicKeyInfo.
+**/
+VOID
+SpdmSharedCertChainCachePublish (
+  IN SPDM_SHARED_CERT_CHAIN_CACHE *Shared,
+  IN UINT32                       BaseHashAlgo,
+  IN CONST UINT8                  *CertChainHash,
+  IN CONST UINT8                  *LeafCertHash,
+  IN CONST UINT8                  *PublicKeyInfo OPTIONAL,
+  IN UINTN                        PublicKeyInfoSize
+  )
+{
+  SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY  *Entry;
+  SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY  *Victim;
+  UINTN                               HashSize;
+  UINT32                              PublishCount;
+  UINT32                              Sequence;
+  UINT32                              Slot;
+  UINT32                              Probe;
+
+  if ((PublicKeyInfo == NULL) || (PublicKeyInfoSize > MAX_SPDM_SHARED_PUBLIC_KEY_INFO_SIZE)) {
+    PublicKeyInfoSize = 0;
+  }
+  HashSize = GetSpdmHashSize (BaseHashAlgo);
+  if (!SPDM_COMPARE_EXCHANGE_32 (&Shared->WriterLock, 0, 1)) {
+    return ;
+  }
+
+  //
+  // The entries only change under the writer lock, so the writer reads them directly.
+  //
+  PublishCount = Shared->PublishCount;
+  Victim = NULL;
+  Slot = SpdmSharedCertChainCacheGetSlot (Shared, CertChainHash);
+  for (Probe = 0; (Probe < SPDM_SHARED_CERT_CHAIN_CACHE_PROBE_COUNT) && (Probe < Shared->EntryCount); Probe++) {
+    Entry = &SpdmSharedCertChainCacheGetEntries (Shared)[(Slot + Probe) % Shared->EntryCount];
+    if (Entry->Sequence == 0) {
+      if ((Victim == NULL) || (Victim->Sequence != 0)) {
+        Victim = Entry;
+      }
+      continue;
+    }
+    if ((Entry->BaseHashAlgo == BaseHashAlgo) && (CompareMem (Entry->CertChainHash, CertChainHash, HashSize) == 0)) {
+      Victim = NULL;
+      break;
+    }
+    if ((Victim == NULL) ||
+        ((Victim->Sequence != 0) && (PublishCount - Entry->LastUse > PublishCount - Victim->LastUse))) {
+      Victim = Entry;
+    }
+  }
+
+  if (Victim != NULL) {
+    Sequence = Victim->Sequence;
+    Victim->Sequence = Sequence + 1;
+    SPDM_RELEASE_FENCE ();
+    Victim->BaseHashAlgo = BaseHashAlgo;
+    ZeroMem (Victim->CertChainHash, sizeof(Victim->CertChainHash));
+    CopyMem (Victim->CertChainHash, CertChainHash, HashSize);
+    ZeroMem (Victim->LeafCertHash, sizeof(Victim->LeafCertHash));
+    CopyMem (Victim->LeafCertHash, LeafCertHash, HashSize);
+    Victim->PublicKeyInfoSize = (UINT32)PublicKeyInfoSize;
+    if (PublicKeyInfoSize != 0) {
+      CopyMem (Victim->PublicKeyInfo, PublicKeyInfo, PublicKeyInfoSize);
+    }
+    Shared->PublishCount = PublishCount + 1;
+    Victim->LastUse = PublishCount + 1;
+    SPDM_STORE_RELEASE (&Victim->Sequence, Sequence + 2);
+  }
+  SPDM_STORE_RELEASE (&Shared->WriterLock, 0);
+}
+
+/**
+  Return the size in bytes of a certificate chain verification cache.
+
+  @param  EntryCount                   The number of certificate chains the cache can hold.
+
+  @return the size in bytes of the certificate chain verification cache.
+**/
+UINTN
+EFIAPI
+SpdmCertChainCacheGetSize (
+  IN     UINTN                             EntryCount
+  )
+{
+  return sizeof(SPDM_CERT_CHAIN_CACHE) + sizeof(SPDM_CERT_CHAIN_CACHE_ENTRY) * EntryCount;
+}
+
+/**
+  Initialize a certificate chain verification cache.
+
+  The size in bytes of the cache can be returned by SpdmCertChainCacheGetSize.
+  The cache may be shared by multiple SPDM contexts. If the contexts are used concurrently,
+  AcquireLock and ReleaseLock must be provided to serialize the access to the cache.
+
+  @param  CertChainCache               A pointer to the certificate chain verification cache.
+  @param  EntryCount                   The number of certificate chains the cache can hold.
+  @param  AcquireLock                  The function to acquire the cache lock, or NULL.
+  @param  ReleaseLock                  The function to release the cache lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+**/
+VOID
+EFIAPI
+SpdmCertChainCacheInit (
+  IN     VOID                              *CertChainCache,
+  IN     UINTN                             EntryCount,
+  IN     SPDM_CERT_CHAIN_CACHE_LOCK_FUNC   AcquireLock OPTIONAL,
+  IN     SPDM_CERT_CHAIN_CACHE_LOCK_FUNC   ReleaseLock OPTIONAL,
+  IN     VOID                              *LockContext OPTIONAL
+  )
+{
+  SPDM_CERT_CHAIN_CACHE         *Cache;
+
+  Cache = CertChainCache;
+  ZeroMem (Cache, SpdmCertChainCacheGetSize (EntryCount));
+  Cache->EntryCount = EntryCount;
+  Cache->AcquireLock = AcquireLock;
+  Cache->ReleaseLock = ReleaseLock;
+  Cache->LockContext = LockContext;
+}
+
+/**
+  Release the resources held by a certificate chain verification cache, such as the parsed public keys.
+
+  It must be called after all SPDM contexts using the cache are reset or discarded.
+
+  @param  CertChainCache               A pointer to the certificate chain verification cache.
+**/
+VOID
+EFIAPI
+SpdmCertChainCacheDeinit (
+  IN     VOID                              *CertChainCache
+  )
+{
+  SPDM_CERT_CHAIN_CACHE         *Cache;
+  SPDM_CERT_CHAIN_CACHE_ENTRY   *Entry;
+  UINTN                         Index;
+
+  Cache = CertChainCache;
+  Entry = (SPDM_CERT_CHAIN_CACHE_ENTRY *)(Cache + 1);
+  SpdmCertChainCacheLock (Cache);
+  for (Index = 0; Index < Cache->EntryCount; Index++) {
+    ASSERT (Entry[Index].RefCount == 0);
+    SpdmCertChainCacheFreePublicKey (&Entry[Index]);
+    ZeroMem (&Entry[Index], sizeof(SPDM_CERT_CHAIN_CACHE_ENTRY));
+  }
+  SpdmCertChainCacheUnlock (Cache);
+}
+
+/**
+  Register a certificate chain verification cache to an SPDM context.
+
+  A peer certificate chain found in the cache is not verified again.
+  A peer certificate chain verified successfully is added to the cache.
+  The requester does not send GET_CERTIFICATE for a slot whose GET_DIGESTS digest matches a cached certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CertChainCache               A pointer to the certificate chain verification cache, or NULL to stop using a cache.
+**/
+VOID
+EFIAPI
+SpdmRegisterCertChainCache (
+  IN     VOID                              *Context,
+  IN     VOID                              *CertChainCache OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmResetPeerPublicKey (SpdmContext);
+  SpdmContext->CertChainCache = CertChainCache;
+}
+
+/**
+  Return the size in bytes of a shared certificate chain verification cache.
+
+  @param  EntryCount                   The number of certificate chains the shared cache can hold.
+
+  @return the size in bytes of the shared certificate chain verification cache.
+**/
+UINTN
+EFIAPI
+SpdmSharedCertChainCacheGetSize (
+  IN     UINTN                             EntryCount
+  )
+{
+  return sizeof(SPDM_SHARED_CERT_CHAIN_CACHE) + sizeof(SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY) * EntryCount;
+}
+
+/**
+  Initialize a shared certificate chain verification cache.
+
+  The shared cache is meant to live in a memory segment shared by processes, and to be initialized once,
+  by the process creating the segment, before any process attaches to it.
+  It holds no pointer, so the processes may map it at different addresses.
+
+  @param  SharedCache                  A pointer to the shared certificate chain verification cache.
+  @param  SharedCacheSize              Size in bytes of the shared cache.
+  @param  EntryCount                   The number of certificate chains the shared cache can hold.
+
+  @retval RETURN_SUCCESS               The shared cache is initialized.
+  @retval RETURN_INVALID_PARAMETER     EntryCount is 0 or larger than MAX_UINT32.
+  @retval RETURN_BUFFER_TOO_SMALL      SharedCacheSize is smaller than SpdmSharedCertChainCacheGetSize (EntryCount).
+**/
+RETURN_STATUS
+EFIAPI
+SpdmSharedCertChainCacheInit (
+  IN     VOID                              *SharedCache,
+  IN     UINTN                             SharedCacheSize,
+  IN     UINTN                             EntryCount
+  )
+{
+  SPDM_SHARED_CERT_CHAIN_CACHE  *Shared;
+
+  if ((EntryCount == 0) || (EntryCount > MAX_UINT32)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (SharedCacheSize < SpdmSharedCertChainCacheGetSize (EntryCount)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  Shared = SharedCache;
+  ZeroMem (Shared, SpdmSharedCertChainCacheGetSize (EntryCount));
+  Shared->Version = SPDM_SHARED_CERT_CHAIN_CACHE_VERSION;
+  Shared->EntrySize = sizeof(SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY);
+  Shared->EntryCount = (UINT32)EntryCount;
+  //
+  // The signature is written last, so that a process attaching early does not see a partial header.
+  //
+  SPDM_STORE_RELEASE (&Shared->Signature, SPDM_SHARED_CERT_CHAIN_CACHE_SIGNATURE);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Put a shared certificate chain verification cache behind a certificate chain verification cache.
+
+  A certificate chain missing from the cache is looked up in the shared cache without a lock, so a certificate
+  chain verified by any process attached to the shared cache is not verified again. The public key of its leaf
+  certificate is parsed from the DER-encoded SubjectPublicKeyInfo kept in the shared cache.
+  A certificate chain verified by the process is published to the shared cache. One process publishes at a time,
+  and a publication is skipped while another process publishes.
+  The certificate chain itself is not shared, so GET_CERTIFICATE is still sent for a chain only in the shared cache.
+
+  It must be called before the cache is registered to an SPDM context.
+
+  @param  CertChainCache               A pointer to the certificate chain verification cache.
+  @param  SharedCache                  A pointer to the shared certificate chain verification cache, or NULL to detach.
+
+  @retval RETURN_SUCCESS               The shared cache is attached.
+  @retval RETURN_UNSUPPORTED           The shared cache is not initialized, or is initialized by a build with other limits.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmCertChainCacheAttachShared (
+  IN     VOID                              *CertChainCache,
+  IN     VOID                              *SharedCache OPTIONAL
+  )
+{
+  SPDM_CERT_CHAIN_CACHE         *Cache;
+  SPDM_SHARED_CERT_CHAIN_CACHE  *Shared;
+
+  Cache = CertChainCache;
+  Shared = SharedCache;
+  if (Shared != NULL) {
+    if ((SPDM_LOAD_ACQUIRE (&Shared->Signature) != SPDM_SHARED_CERT_CHAIN_CACHE_SIGNATURE) ||
+        (Shared->Version != SPDM_SHARED_CERT_CHAIN_CACHE_VERSION) ||
+        (Shared->EntrySize != sizeof(SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY)) ||
+        (Shared->EntryCount == 0)) {
+      return RETURN_UNSUPPORTED;
+    }
+  }
+  SpdmCertChainCacheLock (Cache);
+  Cache->Shared = Shared;
+  SpdmCertChainCacheUnlock (Cache);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Check if a certificate chain is in a certificate chain verification cache,
+  or in the shared cache behind it.
+
+  A cache hit marks the entry as the most recently used one.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo of CertChainHash.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+
+  @retval TRUE  The certificate chain has been verified before.
+  @retval FALSE The certificate chain is not in the cache.
+**/
+BOOLEAN
+SpdmCertChainCacheLookup (
+  IN SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN UINT32                       BaseHashAlgo,
+  IN CONST UINT8                  *CertChainHash
+  )
+{
+  SPDM_CERT_CHAIN_CACHE_ENTRY         *Entry;
+  SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY  SharedEntry;
+  SPDM_SHARED_CERT_CHAIN_CACHE        *Shared;
+
+  SpdmCertChainCacheLock (Cache);
+  Entry = SpdmCertChainCacheFindEntry (Cache, BaseHashAlgo, CertChainHash);
+  if (Entry != NULL) {
+    Entry->LastUse = ++Cache->UseCount;
+  }
+  Shared = Cache->Shared;
+  SpdmCertChainCacheUnlock (Cache);
+  if (Entry != NULL) {
+    return TRUE;
+  }
+  return (BOOLEAN)((Shared != NULL) && SpdmSharedCertChainCacheFind (Shared, BaseHashAlgo, CertChainHash, &SharedEntry));
+}
+
+/**
+  Take a reference to the entry of a verified certificate chain.
+
+  The entry is added if the certificate chain is not in the cache yet. The least recently used
+  entry that is not referenced is replaced if the cache is full.
+  The certificate chain is also published to the shared cache behind the cache, if any.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo of CertChainHash and LeafCertHash.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+  @param  LeafCertHash                 The hash of the leaf certificate of the certificate chain.
+  @param  CertChain                    The certificate chain buffer including SPDM_CERT_CHAIN header.
+  @param  CertChainSize                Size in bytes of the certificate chain buffer.
+  @param  PublicKeyInfo                The DER-encoded SubjectPublicKeyInfo of the leaf certificate, or NULL.
+  @param  PublicKeyInfoSize            Size in bytes of the SubjectPublicKeyInfo.
+
+  @return the referenced cache entry, or NULL if all entries are in use.
+**/
+SPDM_CERT_CHAIN_CACHE_ENTRY *
+SpdmCertChainCacheAcquire (
+  IN SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN UINT32                       BaseHashAlgo,
+  IN CONST UINT8                  *CertChainHash,
+  IN CONST UINT8                  *LeafCertHash,
+  IN CONST VOID                   *CertChain,
+  IN UINTN                        CertChainSize,
+  IN CONST UINT8                  *PublicKeyInfo OPTIONAL,
+  IN UINTN                        PublicKeyInfoSize
+  )
+{
+  SPDM_CERT_CHAIN_CACHE_ENTRY   *Entry;
+  SPDM_CERT_CHAIN_CACHE_ENTRY   *Victim;
+  SPDM_SHARED_CERT_CHAIN_CACHE  *Shared;
+  BOOLEAN                       Added;
+  UINTN                         HashSize;
+  UINTN                         Index;
+
+  if (CertChainSize > MAX_SPDM_CERT_CHAIN_SIZE) {
+    return NULL;
+  }
+  HashSize = GetSpdmHashSize (BaseHashAlgo);
+
+  Added = FALSE;
+  SpdmCertChainCacheLock (Cache);
+  Victim = SpdmCertChainCacheFindEntry (Cache, BaseHashAlgo, CertChainHash);
+  if (Victim == NULL) {
+    Entry = (SPDM_CERT_CHAIN_CACHE_ENTRY *)(Cache + 1);
+    for (Index = 0; Index < Cache->EntryCount; Index++) {
+      if (Entry[Index].RefCount != 0) {
+        continue;
+      }
+      if (!Entry[Index].Valid) {
+        Victim = &Entry[Index];
+        break;
+      }
+      if ((Victim == NULL) || (Entry[Index].LastUse < Victim->LastUse)) {
+        Victim = &Entry[Index];
+      }
+    }
+    if (Victim != NULL) {
+      SpdmCertChainCacheFreePublicKey (Victim);
+      ZeroMem (Victim, sizeof(SPDM_CERT_CHAIN_CACHE_ENTRY));
+      Victim->Valid = TRUE;
+      Victim->BaseHashAlgo = BaseHashAlgo;
+      CopyMem (Victim->CertChainHash, CertChainHash, HashSize);
+      CopyMem (Victim->LeafCertHash, LeafCertHash, HashSize);
+      CopyMem (Victim->CertChain, CertChain, CertChainSize);
+      Victim->CertChainSize = CertChainSize;
+      Added = TRUE;
+    }
+  }
+  if (Victim != NULL) {
+    Victim->RefCount++;
+    Victim->LastUse = ++Cache->UseCount;
+  }
+  Shared = Cache->Shared;
+  SpdmCertChainCacheUnlock (Cache);
+
+  if (Added && (Shared != NULL)) {
+    SpdmSharedCertChainCachePublish (Shared, BaseHashAlgo, CertChainHash, LeafCertHash, PublicKeyInfo, PublicKeyInfoSize);
+  }
+  return Victim;
+}
+
+/**
+  Copy a verified certificate chain out of a certificate chain verification cache.
+
+  A cache hit marks the entry as the most recently used one.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo of CertChainHash.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+  @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
+  @param  CertChainSize                On input, indicate the size in bytes of the destination buffer.
+                                       On output, indicate the size in bytes of the certificate chain.
+
+  @retval TRUE  The certificate chain is copied.
+  @retval FALSE The certificate chain is not in the cache, or the destination buffer is too small.
+**/
+BOOLEAN
+SpdmCertChainCacheGetCertChain (
+  IN     SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN     UINT32                       BaseHashAlgo,
+  IN     CONST UINT8                  *CertChainHash,
+     OUT VOID                         *CertChain,
+  IN OUT UINTN                        *CertChainSize
+  )
+{
+  SPDM_CERT_CHAIN_CACHE_ENTRY   *Entry;
+  BOOLEAN                       Result;
+
+  Result = FALSE;
+  SpdmCertChainCacheLock (Cache);
+  Entry = SpdmCertChainCacheFindEntry (Cache, BaseHashAlgo, CertChainHash);
+  if ((Entry != NULL) && (Entry->CertChainSize != 0) && (Entry->CertChainSize <= *CertChainSize)) {
+    CopyMem (CertChain, Entry->CertChain, Entry->CertChainSize);
+    *CertChainSize = Entry->CertChainSize;
+    Entry->LastUse = ++Cache->UseCount;
+    Result = TRUE;
+  }
+  SpdmCertChainCacheUnlock (Cache);
+  return Result;
+}
+
+/**
+  Drop a reference to a certificate chain verification cache entry.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  Entry                        A pointer to the cache entry, returned by SpdmCertChainCacheAcquire.
+**/
+VOID
+SpdmCertChainCacheRelease (
+  IN     SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN OUT SPDM_CERT_CHAIN_CACHE_ENTRY  *Entry
+  )
+{
+  SpdmCertChainCacheLock (Cache);
+  ASSERT (Entry->RefCount != 0);
+  Entry->RefCount--;
+  SpdmCertChainCacheUnlock (Cache);
+}
+
+/**
+  Return the public key of the leaf certificate of a cached certificate chain.
+
+  The key is parsed on first use and kept in the entry, so that other SPDM contexts presenting
+  the same certificate chain can use it. It is parsed from the SubjectPublicKeyInfo in the shared
+  cache behind the cache if there is one. The caller must hold a reference to the entry and
+  must not free the returned key.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  Entry                        A pointer to the cache entry, returned by SpdmCertChainCacheAcquire.
+  @param  IsReqAsym                    Indicate of the key for ReqBaseAsymAlg or for BaseAsymAlgo.
+  @param  AsymAlgo                     The asymmetric algorithm of the key.
+  @param  LeafCertHash                 The hash of CertBuffer.
+  @param  CertBuffer                   The leaf certificate.
+  @param  CertBufferSize               Size in bytes of the leaf certificate.
+  @param  Context                      Pointer to the public key context.
+
+  @retval TRUE  The public key is returned.
+  @retval FALSE The entry does not match the leaf certificate or the algorithm, or the key cannot be parsed.
+**/
+BOOLEAN
+SpdmCertChainCacheGetPublicKey (
+  IN     SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN OUT SPDM_CERT_CHAIN_CACHE_ENTRY  *Entry,
+  IN     BOOLEAN                      IsReqAsym,
+  IN     UINT32                       AsymAlgo,
+  IN     CONST UINT8                  *LeafCertHash,
+  IN     CONST UINT8                  *CertBuffer,
+  IN     UINTN                        CertBufferSize,
+     OUT VOID                         **Context
+  )
+{
+  SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY  SharedEntry;
+  UINTN                               HashSize;
+  BOOLEAN                             Result;
+
+  Result = FALSE;
+  HashSize = GetSpdmHashSize (Entry->BaseHashAlgo);
+  SpdmCertChainCacheLock (Cache);
+  if (CompareMem (Entry->LeafCertHash, LeafCertHash, HashSize) != 0) {
+    goto Done;
+  }
+  if ((Entry->PublicKey == NULL) && (Cache->Shared != NULL) &&
+      SpdmSharedCertChainCacheFind (Cache->Shared, Entry->BaseHashAlgo, Entry->CertChainHash, &SharedEntry) &&
+      (SharedEntry.PublicKeyInfoSize != 0) &&
+      (CompareMem (SharedEntry.LeafCertHash, LeafCertHash, HashSize) == 0)) {
+    if (IsReqAsym) {
+      Result = SpdmReqAsymGetPublicKeyFromDer ((UINT16)AsymAlgo, SharedEntry.PublicKeyInfo, SharedEntry.PublicKeyInfoSize, &Entry->PublicKey);
+    } else {
+      Result = SpdmAsymGetPublicKeyFromDer (AsymAlgo, SharedEntry.PublicKeyInfo, SharedEntry.PublicKeyInfoSize, &Entry->PublicKey);
+    }
+    if (!Result) {
+      Entry->PublicKey = NULL;
+    } else {
+      Entry->PublicKeyIsReqAsym = IsReqAsym;
+      Entry->PublicKeyAsymAlgo = AsymAlgo;
+    }
+  }
+  if (Entry->PublicKey == NULL) {
+    if (IsReqAsym) {
+      Result = SpdmReqAsymGetPublicKeyFromX509 ((UINT16)AsymAlgo, CertBuffer, CertBufferSize, &Entry->PublicKey);
+    } else {
+      Result = SpdmAsymGetPublicKeyFromX509 (AsymAlgo, CertBuffer, CertBufferSize, &Entry->PublicKey);
+    }
+    if (!Result) {
+      Entry->PublicKey = NULL;
+      goto Done;
+    }
+    Entry->PublicKeyIsReqAsym = IsReqAsym;
+    Entry->PublicKeyAsymAlgo = AsymAlgo;
+  }
+  if ((Entry->PublicKeyIsReqAsym == IsReqAsym) && (Entry->PublicKeyAsymAlgo == AsymAlgo)) {
+    *Context = Entry->PublicKey;
+    Result = TRUE;
+  } else {
+    Result = FALSE;
+  }
+Done:
+  SpdmCertChainCacheUnlock (Cache);
+  return Result;
+}
@@ -9,6 +9,15 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmCommonLibInternal.h"
 
+//
+// With a fixed suite, the local algorithms are limited to the suite.
+//
+#ifdef OPENSPDM_FIXED_SUITE
+#define SPDM_LOCAL_ALGO(Algo, FixedAlgo)  ((Algo) & (FixedAlgo))
+#else
+#define SPDM_LOCAL_ALGO(Algo, FixedAlgo)  (Algo)
+#endif
+
 /**
   Returns if an SPDM DataType requires session info.
 
@@ -26,6 +35,7 @@ NeedSessionInfoForData (
   case SpdmDataSessionUsePsk:
   case SpdmDataSessionMutAuthRequested:
   case SpdmDataSessionEndSessionAttributes:
+  case SpdmDataSessionKeyUpdatePolicy:
     return TRUE;
   }
   return FALSE;
@@ -42,7 +52,7 @@ NeedSessionInfoForData (
 
   @retval RETURN_SUCCESS               The SPDM context data is set successfully.
   @retval RETURN_INVALID_PARAMETER     The Data is NULL or the DataType is zero.
-  @retval RETURN_UNSUPPORTED           The DataType is unsupported.
+  @retval RETURN_UNSUPPORTED           The DataType is unsupported, or the Data is a SHA3 base hash.
   @retval RETURN_ACCESS_DENIED         The DataType cannot be set.
   @retval RETURN_NOT_READY             Data is not ready to set.
 **/
@@ -60,7 +70,10 @@ SpdmSetData (
   UINT32                     SessionId;
   SPDM_SESSION_INFO          *SessionInfo;
   UINT8                      SlotNum;
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   UINT8                      MutAuthRequested;
+#endif
+  UINTN                      Index;
 
   SpdmContext = Context;
 
@@ -114,6 +127,7 @@ SpdmSetData (
         Data,
         SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersionCount * sizeof(SPDM_VERSION_NUMBER)
         );
+      SpdmUpdateOpaqueData (SpdmContext);
     }
     break;
   case SpdmDataCapabilityFlags:
@@ -123,7 +137,7 @@ SpdmSetData (
     if (Parameter->Location == SpdmDataLocationConnection) {
       SpdmContext->ConnectionInfo.Capability.Flags = *(UINT32 *)Data;
     } else {
-      SpdmContext->LocalContext.Capability.Flags = *(UINT32 *)Data;
+      SpdmContext->LocalContext.Capability.Flags = *(UINT32 *)Data & ~SPDM_PRUNED_CAPABILITY_FLAGS;
     }
     break;
   case SpdmDataCapabilityCTExponent:
@@ -149,7 +163,7 @@ SpdmSetData (
     if (Parameter->Location == SpdmDataLocationConnection) {
       SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = *(UINT32 *)Data;
     } else {
-      SpdmContext->LocalContext.Algorithm.MeasurementHashAlgo = *(UINT32 *)Data;
+      SpdmContext->LocalContext.Algorithm.MeasurementHashAlgo = (UINT32)SPDM_LOCAL_ALGO (*(UINT32 *)Data, OPENSPDM_FIXED_MEASUREMENT_HASH_ALGO);
     }
     break;
   case SpdmDataBaseAsymAlgo:
@@ -159,17 +173,20 @@ SpdmSetData (
     if (Parameter->Location == SpdmDataLocationConnection) {
       SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = *(UINT32 *)Data;
     } else {
-      SpdmContext->LocalContext.Algorithm.BaseAsymAlgo = *(UINT32 *)Data;
+      SpdmContext->LocalContext.Algorithm.BaseAsymAlgo = (UINT32)SPDM_LOCAL_ALGO (*(UINT32 *)Data, OPENSPDM_FIXED_BASE_ASYM_ALGO);
     }
     break;
   case SpdmDataBaseHashAlgo:
     if (DataSize != sizeof(UINT32)) {
       return RETURN_INVALID_PARAMETER;
     }
+    if ((*(UINT32 *)Data & SPDM_SHA3_BASE_HASH_ALGO) != 0) {
+      return RETURN_UNSUPPORTED;
+    }
     if (Parameter->Location == SpdmDataLocationConnection) {
       SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = *(UINT32 *)Data;
     } else {
-      SpdmContext->LocalContext.Algorithm.BaseHashAlgo = *(UINT32 *)Data;
+      SpdmContext->LocalContext.Algorithm.BaseHashAlgo = (UINT32)SPDM_LOCAL_ALGO (*(UINT32 *)Data, OPENSPDM_FIXED_BASE_HASH_ALGO);
     }
     break;
   case SpdmDataDHENamedGroup:
@@ -179,7 +196,7 @@ SpdmSetData (
     if (Parameter->Location == SpdmDataLocationConnection) {
       SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = *(UINT16 *)Data;
     } else {
-      SpdmContext->LocalContext.Algorithm.DHENamedGroup = *(UINT16 *)Data;
+      SpdmContext->LocalContext.Algorithm.DHENamedGroup = (UINT16)SPDM_LOCAL_ALGO (*(UINT16 *)Data, OPENSPDM_FIXED_DHE_NAMED_GROUP);
     }
     break;
   case SpdmDataAEADCipherSuite:
@@ -189,7 +206,7 @@ SpdmSetData (
     if (Parameter->Location == SpdmDataLocationConnection) {
       SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = *(UINT16 *)Data;
     } else {
-      SpdmContext->LocalContext.Algorithm.AEADCipherSuite = *(UINT16 *)Data;
+      SpdmContext->LocalContext.Algorithm.AEADCipherSuite = (UINT16)SPDM_LOCAL_ALGO (*(UINT16 *)Data, OPENSPDM_FIXED_AEAD_CIPHER_SUITE);
     }
     break;
   case SpdmDataReqBaseAsymAlg:
@@ -199,7 +216,7 @@ SpdmSetData (
     if (Parameter->Location == SpdmDataLocationConnection) {
       SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg = *(UINT16 *)Data;
     } else {
-      SpdmContext->LocalContext.Algorithm.ReqBaseAsymAlg = *(UINT16 *)Data;
+      SpdmContext->LocalContext.Algorithm.ReqBaseAsymAlg = (UINT16)SPDM_LOCAL_ALGO (*(UINT16 *)Data, OPENSPDM_FIXED_REQ_BASE_ASYM_ALG);
     }
     break;
   case SpdmDataKeySchedule:
@@ -209,7 +226,7 @@ SpdmSetData (
     if (Parameter->Location == SpdmDataLocationConnection) {
       SpdmContext->ConnectionInfo.Algorithm.KeySchedule = *(UINT16 *)Data;
     } else {
-      SpdmContext->LocalContext.Algorithm.KeySchedule = *(UINT16 *)Data;
+      SpdmContext->LocalContext.Algorithm.KeySchedule = (UINT16)SPDM_LOCAL_ALGO (*(UINT16 *)Data, OPENSPDM_FIXED_KEY_SCHEDULE);
     }
     break;
   case SpdmDataConnectionState:
@@ -232,6 +249,14 @@ SpdmSetData (
     SpdmContext->LocalContext.PeerCertChainProvisionSize = DataSize;
     SpdmContext->LocalContext.PeerCertChainProvision = Data;
     break;
+  case SpdmDataPeerPublicKey:
+    SpdmContext->LocalContext.PeerPublicKeyProvisionSize = DataSize;
+    SpdmContext->LocalContext.PeerPublicKeyProvision = Data;
+    break;
+  case SpdmDataLocalPublicKey:
+    SpdmContext->LocalContext.LocalPublicKeyProvisionSize = DataSize;
+    SpdmContext->LocalContext.LocalPublicKeyProvision = Data;
+    break;
   case SpdmDataLocalSlotCount:
     if (DataSize != sizeof(UINT8)) {
       return RETURN_INVALID_PARAMETER;
@@ -241,6 +266,7 @@ SpdmSetData (
       return RETURN_INVALID_PARAMETER;
     }
     SpdmContext->LocalContext.SlotCount = SlotNum;
+    ZeroMem (SpdmContext->LocalCertChainDigest, sizeof(SpdmContext->LocalCertChainDigest));
     break;
   case SpdmDataLocalPublicCertChain:
     SlotNum = Parameter->AdditionalData[0];
@@ -249,6 +275,7 @@ SpdmSetData (
     }
     SpdmContext->LocalContext.LocalCertChainProvisionSize[SlotNum] = DataSize;
     SpdmContext->LocalContext.LocalCertChainProvision[SlotNum] = Data;
+    ZeroMem (&SpdmContext->LocalCertChainDigest[SlotNum], sizeof(SpdmContext->LocalCertChainDigest[SlotNum]));
     break;
   case SpdmDataLocalUsedCertChainBuffer:
     if (DataSize > MAX_SPDM_CERT_CHAIN_SIZE) {
@@ -258,12 +285,13 @@ SpdmSetData (
     SpdmContext->ConnectionInfo.LocalUsedCertChainBuffer = Data;
     break;
   case SpdmDataPeerUsedCertChainBuffer:
-    if (DataSize > MAX_SPDM_CERT_CHAIN_SIZE) {
+    if (DataSize > SpdmContext->ConnectionInfo.MaxPeerUsedCertChainBufferSize) {
       return RETURN_OUT_OF_RESOURCES;
     }
     SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = DataSize;
     CopyMem (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, Data, DataSize);
     break;
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   case SpdmDataBasicMutAuthRequested:
     if (DataSize != sizeof(BOOLEAN)) {
       return RETURN_INVALID_PARAMETER;
@@ -294,6 +322,8 @@ SpdmSetData (
     SpdmContext->EncapContext.RequestId = 0;
     SpdmContext->EncapContext.ReqSlotNum = Parameter->AdditionalData[0];
     break;
+#endif
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
   case SpdmDataPskHint:
     if (DataSize > MAX_SPDM_PSK_HINT_LENGTH) {
       return RETURN_INVALID_PARAMETER;
@@ -301,6 +331,67 @@ SpdmSetData (
     SpdmContext->LocalContext.PskHintSize = DataSize;
     SpdmContext->LocalContext.PskHint = Data;
     break;
+#endif
+  case SpdmDataMeasurementCacheMaxAge:
+    if (DataSize != sizeof(UINT32)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    SpdmContext->LocalContext.MeasurementCacheMaxAge = *(UINT32 *)Data;
+    break;
+  case SpdmDataTransportRoundTripTime:
+    if (DataSize != sizeof(UINT64)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    SpdmContext->LocalContext.TransportRoundTripTime = *(UINT64 *)Data;
+    break;
+  case SpdmDataTransportMaxMessageSize:
+    if (DataSize != sizeof(UINT32)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    if ((*(UINT32 *)Data != 0) && (*(UINT32 *)Data <= sizeof(SPDM_CERTIFICATE_RESPONSE))) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    SpdmContext->LocalContext.TransportMaxMessageSize = *(UINT32 *)Data;
+    break;
+  case SpdmDataTransportConnectionId:
+    if (DataSize != sizeof(UINT16)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    SpdmContext->LocalContext.TransportConnectionId = *(UINT16 *)Data;
+    break;
+#if OPENSPDM_REQUESTER_STATS_SUPPORT == 1
+  case SpdmDataRequesterStats:
+    if (DataSize != sizeof(SPDM_REQUESTER_STATS)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    CopyMem (&SpdmContext->RequesterStats, Data, DataSize);
+    break;
+#endif
+#if OPENSPDM_RESPONDER_STATS_SUPPORT == 1
+  case SpdmDataResponderStats:
+    if (DataSize != sizeof(SPDM_RESPONDER_STATS)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    CopyMem (&SpdmContext->ResponderStats, Data, DataSize);
+    break;
+#endif
+#if OPENSPDM_CRYPTO_STATS_SUPPORT == 1
+  case SpdmDataCryptoStats:
+    if (DataSize != sizeof(SPDM_CRYPTO_STATS)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    CopyMem (&SpdmContext->CryptoStats, Data, DataSize);
+    break;
+#endif
+  case SpdmDataDebugDumpMask:
+    if (DataSize != sizeof(UINT32)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    SpdmContext->LocalContext.DebugDumpMask = *(UINT32 *)Data;
+    for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+      SpdmSecuredMessageSetDebugDumpMask (SpdmContext->SessionInfo[Index].SecuredMessageContext, *(UINT32 *)Data);
+    }
+    break;
   case SpdmDataSessionUsePsk:
     if (DataSize != sizeof(BOOLEAN)) {
       return RETURN_INVALID_PARAMETER;
@@ -319,6 +410,12 @@ SpdmSetData (
     }
     SessionInfo->EndSessionAttributes = *(UINT8 *)Data;
     break;
+  case SpdmDataSessionKeyUpdatePolicy:
+    if (DataSize != sizeof(SPDM_KEY_UPDATE_POLICY)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    CopyMem (&SessionInfo->KeyUpdatePolicy, Data, sizeof(SPDM_KEY_UPDATE_POLICY));
+    break;
   default:
     return RETURN_UNSUPPORTED;
     break;
@@ -327,6 +424,106 @@ SpdmSetData (
   return RETURN_SUCCESS;
 }
 
+/**
+  Set the local configuration of an SPDM context from a configuration profile.
+
+  The whole profile is validated first, with the same rules as SpdmSetData, then all its fields are installed
+  in one pass, so that the SPDM context is either fully configured or left unchanged.
+  The other local data are kept, such as the transport connection ID, the private keys
+  and the opaque data of CHALLENGE_AUTH and MEASUREMENTS.
+  To configure many SPDM contexts with the same profile, the profile may be applied to one SPDM context
+  for SpdmDeviceProfileInit, and the device profile registered to the others with SpdmRegisterDeviceProfile.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Profile                      A pointer to the configuration profile.
+
+  @retval RETURN_SUCCESS               The configuration profile is applied.
+  @retval RETURN_INVALID_PARAMETER     A field of the configuration profile is invalid.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmApplyProfile (
+  IN     VOID                      *Context,
+  IN     CONST SPDM_CONFIG_PROFILE *Profile
+  )
+{
+  SPDM_DEVICE_CONTEXT        *SpdmContext;
+  SPDM_LOCAL_CONTEXT         *LocalContext;
+  UINTN                      Index;
+
+  SpdmContext = Context;
+  LocalContext = &SpdmContext->LocalContext;
+
+  if ((Profile->SpdmVersionCount > MAX_SPDM_VERSION_COUNT) ||
+      (Profile->SecuredMessageVersionCount > MAX_SPDM_VERSION_COUNT) ||
+      (Profile->LocalSlotCount > MAX_SPDM_SLOT_COUNT) ||
+      (Profile->PskHintSize > MAX_SPDM_PSK_HINT_LENGTH)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if ((Profile->BasicMutAuthRequested != 0) && (Profile->BasicMutAuthRequested != 1)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if ((Profile->MutAuthRequested != 0) &&
+      (Profile->MutAuthRequested != SPDM_KEY_EXCHANGE_RESPONSE_MUT_AUTH_REQUESTED) &&
+      (Profile->MutAuthRequested != SPDM_KEY_EXCHANGE_RESPONSE_MUT_AUTH_REQUESTED_WITH_ENCAP_REQUEST) &&
+      (Profile->MutAuthRequested != SPDM_KEY_EXCHANGE_RESPONSE_MUT_AUTH_REQUESTED_WITH_GET_DIGESTS)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if ((Profile->TransportMaxMessageSize != 0) && (Profile->TransportMaxMessageSize <= sizeof(SPDM_CERTIFICATE_RESPONSE))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  LocalContext->Version.SpdmVersionCount = Profile->SpdmVersionCount;
+  CopyMem (LocalContext->Version.SpdmVersion, Profile->SpdmVersion, sizeof(Profile->SpdmVersion));
+  LocalContext->SecuredMessageVersion.SpdmVersionCount = Profile->SecuredMessageVersionCount;
+  CopyMem (LocalContext->SecuredMessageVersion.SpdmVersion, Profile->SecuredMessageVersion, sizeof(Profile->SecuredMessageVersion));
+  SpdmUpdateOpaqueData (SpdmContext);
+
+  LocalContext->Capability.Flags = Profile->CapabilityFlags & ~SPDM_PRUNED_CAPABILITY_FLAGS;
+  LocalContext->Capability.CTExponent = Profile->CapabilityCTExponent;
+  LocalContext->Algorithm.MeasurementSpec = Profile->MeasurementSpec;
+  LocalContext->Algorithm.MeasurementHashAlgo = (UINT32)SPDM_LOCAL_ALGO (Profile->MeasurementHashAlgo, OPENSPDM_FIXED_MEASUREMENT_HASH_ALGO);
+  LocalContext->Algorithm.BaseAsymAlgo = (UINT32)SPDM_LOCAL_ALGO (Profile->BaseAsymAlgo, OPENSPDM_FIXED_BASE_ASYM_ALGO);
+  LocalContext->Algorithm.BaseHashAlgo = (UINT32)SPDM_LOCAL_ALGO (Profile->BaseHashAlgo, OPENSPDM_FIXED_BASE_HASH_ALGO);
+  LocalContext->Algorithm.DHENamedGroup = (UINT16)SPDM_LOCAL_ALGO (Profile->DHENamedGroup, OPENSPDM_FIXED_DHE_NAMED_GROUP);
+  LocalContext->Algorithm.AEADCipherSuite = (UINT16)SPDM_LOCAL_ALGO (Profile->AEADCipherSuite, OPENSPDM_FIXED_AEAD_CIPHER_SUITE);
+  LocalContext->Algorithm.ReqBaseAsymAlg = (UINT16)SPDM_LOCAL_ALGO (Profile->ReqBaseAsymAlg, OPENSPDM_FIXED_REQ_BASE_ASYM_ALG);
+  LocalContext->Algorithm.KeySchedule = (UINT16)SPDM_LOCAL_ALGO (Profile->KeySchedule, OPENSPDM_FIXED_KEY_SCHEDULE);
+
+  LocalContext->SlotCount = Profile->LocalSlotCount;
+  for (Index = 0; Index < MAX_SPDM_SLOT_COUNT; Index++) {
+    if (Index < Profile->LocalSlotCount) {
+      LocalContext->LocalCertChainProvision[Index] = Profile->LocalPublicCertChain[Index];
+      LocalContext->LocalCertChainProvisionSize[Index] = Profile->LocalPublicCertChainSize[Index];
+    } else {
+      LocalContext->LocalCertChainProvision[Index] = NULL;
+      LocalContext->LocalCertChainProvisionSize[Index] = 0;
+    }
+  }
+  ZeroMem (SpdmContext->LocalCertChainDigest, sizeof(SpdmContext->LocalCertChainDigest));
+  LocalContext->PeerRootCertHashProvision = Profile->PeerPublicRootCertHash;
+  LocalContext->PeerRootCertHashProvisionSize = Profile->PeerPublicRootCertHashSize;
+  LocalContext->PeerCertChainProvision = Profile->PeerPublicCertChains;
+  LocalContext->PeerCertChainProvisionSize = Profile->PeerPublicCertChainsSize;
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
+  LocalContext->PskHint = Profile->PskHint;
+  LocalContext->PskHintSize = Profile->PskHintSize;
+#endif
+
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
+  LocalContext->BasicMutAuthRequested = Profile->BasicMutAuthRequested;
+  LocalContext->MutAuthRequested = Profile->MutAuthRequested;
+  SpdmContext->EncapContext.ErrorState = 0;
+  SpdmContext->EncapContext.RequestId = 0;
+  SpdmContext->EncapContext.ReqSlotNum = Profile->MutAuthReqSlotNum;
+#endif
+
+  LocalContext->MeasurementCacheMaxAge = Profile->MeasurementCacheMaxAge;
+  LocalContext->TransportRoundTripTime = Profile->TransportRoundTripTime;
+  LocalContext->TransportMaxMessageSize = Profile->TransportMaxMessageSize;
+  return RETURN_SUCCESS;
+}
+
 /**
   Get an SPDM context data.
 
@@ -473,6 +670,44 @@ SpdmGetData (
     TargetDataSize = sizeof(UINT32);
     TargetData = &SpdmContext->ResponseState;
     break;
+  case SpdmDataMeasurementCacheMaxAge:
+    TargetDataSize = sizeof(UINT32);
+    TargetData = &SpdmContext->LocalContext.MeasurementCacheMaxAge;
+    break;
+  case SpdmDataTransportRoundTripTime:
+    TargetDataSize = sizeof(UINT64);
+    TargetData = &SpdmContext->LocalContext.TransportRoundTripTime;
+    break;
+  case SpdmDataTransportMaxMessageSize:
+    TargetDataSize = sizeof(UINT32);
+    TargetData = &SpdmContext->LocalContext.TransportMaxMessageSize;
+    break;
+  case SpdmDataTransportConnectionId:
+    TargetDataSize = sizeof(UINT16);
+    TargetData = &SpdmContext->LocalContext.TransportConnectionId;
+    break;
+#if OPENSPDM_REQUESTER_STATS_SUPPORT == 1
+  case SpdmDataRequesterStats:
+    TargetDataSize = sizeof(SPDM_REQUESTER_STATS);
+    TargetData = &SpdmContext->RequesterStats;
+    break;
+#endif
+#if OPENSPDM_RESPONDER_STATS_SUPPORT == 1
+  case SpdmDataResponderStats:
+    TargetDataSize = sizeof(SPDM_RESPONDER_STATS);
+    TargetData = &SpdmContext->ResponderStats;
+    break;
+#endif
+#if OPENSPDM_CRYPTO_STATS_SUPPORT == 1
+  case SpdmDataCryptoStats:
+    TargetDataSize = sizeof(SPDM_CRYPTO_STATS);
+    TargetData = &SpdmContext->CryptoStats;
+    break;
+#endif
+  case SpdmDataDebugDumpMask:
+    TargetDataSize = sizeof(UINT32);
+    TargetData = &SpdmContext->LocalContext.DebugDumpMask;
+    break;
   case SpdmDataSessionUsePsk:
     TargetDataSize = sizeof(BOOLEAN);
     TargetData = &SessionInfo->UsePsk;
@@ -485,6 +720,10 @@ SpdmGetData (
     TargetDataSize = sizeof(UINT8);
     TargetData = &SessionInfo->EndSessionAttributes;
     break;
+  case SpdmDataSessionKeyUpdatePolicy:
+    TargetDataSize = sizeof(SPDM_KEY_UPDATE_POLICY);
+    TargetData = &SessionInfo->KeyUpdatePolicy;
+    break;
   default:
     return RETURN_UNSUPPORTED;
     break;
@@ -515,6 +754,9 @@ SpdmResetMessageA (
 
   SpdmContext = Context;
   ResetManagedBuffer (&SpdmContext->Transcript.MessageA);
+#if OPENSPDM_MESSAGE_A_DIGEST_SUPPORT == 1
+  SpdmResetMessageADigest (SpdmContext);
+#endif
 }
 
 /**
@@ -532,6 +774,10 @@ SpdmResetMessageB (
 
   SpdmContext = Context;
   ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+  SpdmResetMessageDigest (&SpdmContext->Transcript.MessageBDigest);
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  ResetManagedBuffer (&SpdmContext->Evidence.MessageB);
+#endif
 }
 
 /**
@@ -562,10 +808,12 @@ SpdmResetMessageMutB (
   IN     VOID                                *Context
   )
 {
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   SPDM_DEVICE_CONTEXT        *SpdmContext;
 
   SpdmContext = Context;
   ResetManagedBuffer (&SpdmContext->Transcript.MessageMutB);
+#endif
 }
 
 /**
@@ -579,10 +827,175 @@ SpdmResetMessageMutC (
   IN     VOID                                *Context
   )
 {
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   SPDM_DEVICE_CONTEXT        *SpdmContext;
 
   SpdmContext = Context;
   ResetManagedBuffer (&SpdmContext->Transcript.MessageMutC);
+#endif
+}
+
+/**
+  Reset a running hash transcript.
+
+  @param  MessageDigest                A pointer to the running hash transcript.
+**/
+VOID
+SpdmResetMessageDigest (
+  IN OUT SPDM_MESSAGE_DIGEST   *MessageDigest
+  )
+{
+  if (MessageDigest->HashContext != NULL) {
+    SpdmHashFree (MessageDigest->BaseHashAlgo, MessageDigest->HashContext);
+  }
+  MessageDigest->HashContext = NULL;
+  MessageDigest->BaseHashAlgo = 0;
+  MessageDigest->BufferSize = 0;
+  MessageDigest->PendingBufferSize = 0;
+}
+
+#if OPENSPDM_MESSAGE_A_DIGEST_SUPPORT == 1
+/**
+  Free the running hashes of Message A in SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmResetMessageADigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext
+  )
+{
+  SPDM_MESSAGE_A_DIGEST      *MessageADigest;
+  UINTN                      Index;
+
+  MessageADigest = &SpdmContext->Transcript.MessageADigest;
+  for (Index = 0; Index < SPDM_MESSAGE_A_DIGEST_COUNT; Index++) {
+    if (MessageADigest->HashContext[Index] != NULL) {
+      SpdmHashFree ((UINT32)1 << Index, MessageADigest->HashContext[Index]);
+      MessageADigest->HashContext[Index] = NULL;
+    }
+  }
+  MessageADigest->BufferSize = 0;
+}
+
+/**
+  Add a message appended to Message A to the running hashes of Message A in SPDM context.
+
+  The running hashes are started for each local base hash algorithm with the first message.
+  A running hash is freed if it cannot be updated.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageASize                 Size in bytes of Message A before the message is appended.
+  @param  Message                      Message buffer.
+  @param  MessageSize                  Size in bytes of message buffer.
+**/
+VOID
+SpdmAppendMessageADigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINTN                 MessageASize,
+  IN     VOID                  *Message,
+  IN     UINTN                 MessageSize
+  )
+{
+  SPDM_MESSAGE_A_DIGEST      *MessageADigest;
+  UINT32                     BaseHashAlgo;
+  UINTN                      Index;
+
+  MessageADigest = &SpdmContext->Transcript.MessageADigest;
+  if (MessageASize == 0) {
+    SpdmResetMessageADigest (SpdmContext);
+    for (Index = 0; Index < SPDM_MESSAGE_A_DIGEST_COUNT; Index++) {
+      BaseHashAlgo = (UINT32)1 << Index;
+      if ((SpdmContext->LocalContext.Algorithm.BaseHashAlgo & BaseHashAlgo) != 0) {
+        MessageADigest->HashContext[Index] = SpdmHashNew (BaseHashAlgo);
+      }
+    }
+  } else if (MessageADigest->BufferSize != MessageASize) {
+    SpdmResetMessageADigest (SpdmContext);
+    return ;
+  }
+
+  for (Index = 0; Index < SPDM_MESSAGE_A_DIGEST_COUNT; Index++) {
+    if (MessageADigest->HashContext[Index] == NULL) {
+      continue;
+    }
+    BaseHashAlgo = (UINT32)1 << Index;
+    if (!SpdmHashUpdate (BaseHashAlgo, MessageADigest->HashContext[Index], Message, MessageSize)) {
+      SpdmHashFree (BaseHashAlgo, MessageADigest->HashContext[Index]);
+      MessageADigest->HashContext[Index] = NULL;
+    }
+  }
+  MessageADigest->BufferSize = MessageASize + MessageSize;
+}
+#endif
+
+/**
+  Keep only the running hash of Message A of the negotiated base hash algorithm, once ALGORITHMS is processed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmFinishMessageADigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext
+  )
+{
+#if OPENSPDM_MESSAGE_A_DIGEST_SUPPORT == 1
+  SPDM_MESSAGE_A_DIGEST      *MessageADigest;
+  UINT32                     BaseHashAlgo;
+  UINTN                      Index;
+
+  MessageADigest = &SpdmContext->Transcript.MessageADigest;
+  for (Index = 0; Index < SPDM_MESSAGE_A_DIGEST_COUNT; Index++) {
+    BaseHashAlgo = (UINT32)1 << Index;
+    if ((MessageADigest->HashContext[Index] != NULL) &&
+        (BaseHashAlgo != SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo)) {
+      SpdmHashFree (BaseHashAlgo, MessageADigest->HashContext[Index]);
+      MessageADigest->HashContext[Index] = NULL;
+    }
+  }
+#endif
+}
+
+/**
+  Update a new hash context with Message A in SPDM context.
+
+  Message A is the start of every transcript, so the hash context must not be updated before.
+  The running hash of Message A is copied to it if there is one for the hash algorithm,
+  otherwise Message A is hashed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  BaseHashAlgo                 The hash algorithm of the hash context.
+  @param  HashContext                  The new hash context.
+
+  @retval TRUE   The hash context is updated with Message A.
+  @retval FALSE  The hash context cannot be updated.
+**/
+BOOLEAN
+SpdmHashUpdateMessageA (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINT32                BaseHashAlgo,
+  IN OUT VOID                  *HashContext
+  )
+{
+#if OPENSPDM_MESSAGE_A_DIGEST_SUPPORT == 1
+  SPDM_MESSAGE_A_DIGEST      *MessageADigest;
+  UINTN                      Index;
+
+  MessageADigest = &SpdmContext->Transcript.MessageADigest;
+  if (MessageADigest->BufferSize == GetManagedBufferSize (&SpdmContext->Transcript.MessageA)) {
+    for (Index = 0; Index < SPDM_MESSAGE_A_DIGEST_COUNT; Index++) {
+      if ((BaseHashAlgo == ((UINT32)1 << Index)) && (MessageADigest->HashContext[Index] != NULL)) {
+        return SpdmHashDuplicate (BaseHashAlgo, MessageADigest->HashContext[Index], HashContext);
+      }
+    }
+  }
+#endif
+  return SpdmHashUpdate (
+           BaseHashAlgo,
+           HashContext,
+           GetManagedBuffer (&SpdmContext->Transcript.MessageA),
+           GetManagedBufferSize (&SpdmContext->Transcript.MessageA)
+           );
 }
 
 /**
@@ -599,7 +1012,10 @@ SpdmResetMessageM (
   SPDM_DEVICE_CONTEXT        *SpdmContext;
 
   SpdmContext = Context;
-  ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+  SpdmResetMessageDigest (&SpdmContext->Transcript.MessageM);
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  ResetManagedBuffer (&SpdmContext->Evidence.MessageM);
+#endif
 }
 
 /**
@@ -621,9 +1037,23 @@ SpdmAppendMessageA (
   )
 {
   SPDM_DEVICE_CONTEXT        *SpdmContext;
+#if OPENSPDM_MESSAGE_A_DIGEST_SUPPORT == 1
+  UINTN                      MessageASize;
+  RETURN_STATUS              Status;
+#endif
 
   SpdmContext = Context;
+#if OPENSPDM_MESSAGE_A_DIGEST_SUPPORT == 1
+  MessageASize = GetManagedBufferSize (&SpdmContext->Transcript.MessageA);
+  Status = AppendManagedBuffer (&SpdmContext->Transcript.MessageA, Message, MessageSize);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  SpdmAppendMessageADigest (SpdmContext, MessageASize, Message, MessageSize);
+  return RETURN_SUCCESS;
+#else
   return AppendManagedBuffer (&SpdmContext->Transcript.MessageA, Message, MessageSize);
+#endif
 }
 
 /**
@@ -683,6 +1113,7 @@ SpdmAppendMessageC (
 
   @return RETURN_SUCCESS          Message is appended.
   @return RETURN_OUT_OF_RESOURCES Message is not appended because the internal cache is full.
+  @return RETURN_UNSUPPORTED      OPENSPDM_MUT_AUTH_CAP_SUPPORT is 0.
 **/
 RETURN_STATUS
 EFIAPI
@@ -692,10 +1123,14 @@ SpdmAppendMessageMutB (
   IN     UINTN                               MessageSize
   )
 {
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   SPDM_DEVICE_CONTEXT        *SpdmContext;
 
   SpdmContext = Context;
   return AppendManagedBuffer (&SpdmContext->Transcript.MessageMutB, Message, MessageSize);
+#else
+  return RETURN_UNSUPPORTED;
+#endif
 }
 
 /**
@@ -707,6 +1142,7 @@ SpdmAppendMessageMutB (
 
   @return RETURN_SUCCESS          Message is appended.
   @return RETURN_OUT_OF_RESOURCES Message is not appended because the internal cache is full.
+  @return RETURN_UNSUPPORTED      OPENSPDM_MUT_AUTH_CAP_SUPPORT is 0.
 **/
 RETURN_STATUS
 EFIAPI
@@ -716,10 +1152,118 @@ SpdmAppendMessageMutC (
   IN     UINTN                               MessageSize
   )
 {
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   SPDM_DEVICE_CONTEXT        *SpdmContext;
 
   SpdmContext = Context;
   return AppendManagedBuffer (&SpdmContext->Transcript.MessageMutC, Message, MessageSize);
+#else
+  return RETURN_UNSUPPORTED;
+#endif
+}
+
+/**
+  Append a message to a running hash transcript.
+
+  The running hash is started with Message A if StartWithMessageA is TRUE, if the transcript is empty.
+  The transcript is reset if the hash cannot be updated.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageDigest                A pointer to the running hash transcript.
+  @param  StartWithMessageA            Message A is hashed before the first message.
+  @param  Message                      Message buffer.
+  @param  MessageSize                  Size in bytes of message buffer.
+
+  @return RETURN_SUCCESS          Message is appended.
+  @return RETURN_OUT_OF_RESOURCES Message is not appended because the hash context cannot be allocated.
+  @return RETURN_DEVICE_ERROR     Message is not appended because the hash cannot be updated.
+**/
+RETURN_STATUS
+SpdmAppendMessageDigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN OUT SPDM_MESSAGE_DIGEST   *MessageDigest,
+  IN     BOOLEAN               StartWithMessageA,
+  IN     VOID                  *Message,
+  IN     UINTN                 MessageSize
+  )
+{
+  BOOLEAN                    Result;
+
+  if (MessageSize == 0) {
+    return RETURN_SUCCESS;
+  }
+  if (Message == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  //
+  // Start a new running hash with the first message.
+  //
+  if (MessageDigest->BufferSize == 0) {
+    SpdmResetMessageDigest (MessageDigest);
+  }
+  if (MessageDigest->HashContext == NULL) {
+    if (MessageDigest->BufferSize != 0) {
+      return RETURN_DEVICE_ERROR;
+    }
+    MessageDigest->HashContext = SpdmHashNew (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
+    if (MessageDigest->HashContext == NULL) {
+      return RETURN_OUT_OF_RESOURCES;
+    }
+    MessageDigest->BaseHashAlgo = SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo;
+    if (StartWithMessageA) {
+      if (!SpdmHashUpdateMessageA (SpdmContext, MessageDigest->BaseHashAlgo, MessageDigest->HashContext)) {
+        SpdmResetMessageDigest (MessageDigest);
+        return RETURN_DEVICE_ERROR;
+      }
+    }
+  }
+
+  if (MessageDigest->PendingBufferSize != 0) {
+    Result = SpdmHashUpdate (MessageDigest->BaseHashAlgo, MessageDigest->HashContext, MessageDigest->PendingBuffer, MessageDigest->PendingBufferSize);
+    MessageDigest->PendingBufferSize = 0;
+    if (!Result) {
+      SpdmResetMessageDigest (MessageDigest);
+      return RETURN_DEVICE_ERROR;
+    }
+  }
+  if (MessageSize <= sizeof(MessageDigest->PendingBuffer)) {
+    CopyMem (MessageDigest->PendingBuffer, Message, MessageSize);
+    MessageDigest->PendingBufferSize = MessageSize;
+  } else {
+    Result = SpdmHashUpdate (MessageDigest->BaseHashAlgo, MessageDigest->HashContext, Message, MessageSize);
+    if (!Result) {
+      SpdmResetMessageDigest (MessageDigest);
+      return RETURN_DEVICE_ERROR;
+    }
+  }
+  MessageDigest->BufferSize += MessageSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Withdraw the last appended message from a running hash transcript.
+
+  The transcript is reset if the message cannot be withdrawn from the running hash.
+
+  @param  MessageDigest                A pointer to the running hash transcript.
+  @param  MessageSize                  Size in bytes of the last appended message.
+**/
+VOID
+SpdmShrinkMessageDigest (
+  IN OUT SPDM_MESSAGE_DIGEST   *MessageDigest,
+  IN     UINTN                 MessageSize
+  )
+{
+  if (MessageSize == 0) {
+    return ;
+  }
+  if (MessageSize > MessageDigest->PendingBufferSize) {
+    SpdmResetMessageDigest (MessageDigest);
+    return ;
+  }
+  MessageDigest->PendingBufferSize -= MessageSize;
+  MessageDigest->BufferSize -= MessageSize;
 }
 
 /**
@@ -729,8 +1273,11 @@ SpdmAppendMessageMutC (
   @param  Message                      Message buffer.
   @param  MessageSize                  Size in bytes of message buffer.
 
+  Message M is not cached. The message is added to the running hash of L1/L2 instead.
+
   @return RETURN_SUCCESS          Message is appended.
-  @return RETURN_OUT_OF_RESOURCES Message is not appended because the internal cache is full.
+  @return RETURN_OUT_OF_RESOURCES Message is not appended because the hash context cannot be allocated.
+  @return RETURN_DEVICE_ERROR     Message is not appended because the hash cannot be updated.
 **/
 RETURN_STATUS
 EFIAPI
@@ -743,7 +1290,130 @@ SpdmAppendMessageM (
   SPDM_DEVICE_CONTEXT        *SpdmContext;
 
   SpdmContext = Context;
-  return AppendManagedBuffer (&SpdmContext->Transcript.MessageM, Message, MessageSize);
+  return SpdmAppendMessageDigest (SpdmContext, &SpdmContext->Transcript.MessageM, FALSE, Message, MessageSize);
+}
+
+/**
+  Withdraw the last appended message from Message M cache in SPDM context.
+
+  Message M is reset if the message cannot be withdrawn from the running hash.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the last appended message.
+**/
+VOID
+SpdmShrinkMessageM (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINTN                 MessageSize
+  )
+{
+  SpdmShrinkMessageDigest (&SpdmContext->Transcript.MessageM, MessageSize);
+}
+
+/**
+  Append a message of the requester to Message M in SPDM context.
+
+  It is SpdmAppendMessageM, and also copies the message to the evidence if OPENSPDM_EVIDENCE_SUPPORT is 1.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Message                      Message buffer.
+  @param  MessageSize                  Size in bytes of message buffer.
+
+  @return RETURN_SUCCESS          Message is appended.
+  @return RETURN_OUT_OF_RESOURCES Message is not appended because the hash context cannot be allocated.
+  @return RETURN_DEVICE_ERROR     Message is not appended because the hash cannot be updated.
+**/
+RETURN_STATUS
+SpdmAppendRequesterMessageM (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     VOID                  *Message,
+  IN     UINTN                 MessageSize
+  )
+{
+  RETURN_STATUS              Status;
+
+  Status = SpdmAppendMessageM (SpdmContext, Message, MessageSize);
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  if (!RETURN_ERROR(Status)) {
+    SpdmAppendEvidenceMessage (&SpdmContext->Evidence.MessageM, &SpdmContext->Transcript.MessageM, Message, MessageSize);
+  }
+#endif
+  return Status;
+}
+
+/**
+  Withdraw the last message appended by SpdmAppendRequesterMessageM from Message M in SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the last appended message.
+**/
+VOID
+SpdmShrinkRequesterMessageM (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINTN                 MessageSize
+  )
+{
+  SpdmShrinkMessageM (SpdmContext, MessageSize);
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  SpdmShrinkEvidenceMessage (&SpdmContext->Evidence.MessageM, MessageSize);
+#endif
+}
+
+/**
+  Append a message of the requester to the running hash of Message B in SPDM context.
+
+  The running hash is started with Message A, so that it is the running hash of M2 before Message C.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Message                      Message buffer.
+  @param  MessageSize                  Size in bytes of message buffer.
+
+  @return RETURN_SUCCESS          Message is appended.
+  @return RETURN_OUT_OF_RESOURCES Message is not appended because the hash context cannot be allocated.
+  @return RETURN_DEVICE_ERROR     Message is not appended because the hash cannot be updated.
+**/
+RETURN_STATUS
+SpdmAppendMessageBDigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     VOID                  *Message,
+  IN     UINTN                 MessageSize
+  )
+{
+  RETURN_STATUS              Status;
+
+  Status = SpdmAppendMessageDigest (
+             SpdmContext,
+             &SpdmContext->Transcript.MessageBDigest,
+             TRUE,
+             Message,
+             MessageSize
+             );
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  if (!RETURN_ERROR(Status)) {
+    SpdmAppendEvidenceMessage (&SpdmContext->Evidence.MessageB, &SpdmContext->Transcript.MessageBDigest, Message, MessageSize);
+  }
+#endif
+  return Status;
+}
+
+/**
+  Withdraw the last appended message from the running hash of Message B in SPDM context.
+
+  The running hash of Message B is reset if the message cannot be withdrawn from it.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the last appended message.
+**/
+VOID
+SpdmShrinkMessageBDigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINTN                 MessageSize
+  )
+{
+  SpdmShrinkMessageDigest (&SpdmContext->Transcript.MessageBDigest, MessageSize);
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  SpdmShrinkEvidenceMessage (&SpdmContext->Evidence.MessageB, MessageSize);
+#endif
 }
 
 /**
@@ -765,9 +1435,26 @@ SpdmAppendMessageK (
   )
 {
   SPDM_SESSION_INFO       *SpdmSessionInfo;
+  SPDM_SESSION_TRANSCRIPT *Transcript;
+  RETURN_STATUS           Status;
 
   SpdmSessionInfo = SessionInfo;
-  return AppendManagedBuffer (&SpdmSessionInfo->SessionTranscript.MessageK, Message, MessageSize);
+  Transcript = &SpdmSessionInfo->SessionTranscript;
+  Status = AppendManagedBuffer (&Transcript->MessageK, Message, MessageSize);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  //
+  // Keep the running TH hash in step with the cached message.
+  //
+  if ((Transcript->DigestContextTH != NULL) && !Transcript->DigestIncludesMessageF &&
+      (Transcript->DigestedMessageKSize + MessageSize == GetManagedBufferSize (&Transcript->MessageK))) {
+    if (SpdmHashUpdate (Transcript->DigestBaseHashAlgo, Transcript->DigestContextTH, Message, MessageSize)) {
+      Transcript->DigestedMessageKSize += MessageSize;
+    }
+  }
+  return RETURN_SUCCESS;
 }
 
 /**
@@ -789,13 +1476,30 @@ SpdmAppendMessageF (
   )
 {
   SPDM_SESSION_INFO       *SpdmSessionInfo;
+  SPDM_SESSION_TRANSCRIPT *Transcript;
+  RETURN_STATUS           Status;
 
   SpdmSessionInfo = SessionInfo;
-  return AppendManagedBuffer (&SpdmSessionInfo->SessionTranscript.MessageF, Message, MessageSize);
-}
+  Transcript = &SpdmSessionInfo->SessionTranscript;
+  Status = AppendManagedBuffer (&Transcript->MessageF, Message, MessageSize);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
 
-/**
-  This function returns if a given version is supported based upon the GET_VERSION/VERSION.
+  //
+  // Keep the running TH hash in step with the cached message.
+  //
+  if ((Transcript->DigestContextTH != NULL) && Transcript->DigestIncludesMessageF &&
+      (Transcript->DigestedMessageFSize + MessageSize == GetManagedBufferSize (&Transcript->MessageF))) {
+    if (SpdmHashUpdate (Transcript->DigestBaseHashAlgo, Transcript->DigestContextTH, Message, MessageSize)) {
+      Transcript->DigestedMessageFSize += MessageSize;
+    }
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function returns if a given version is supported based upon the GET_VERSION/VERSION.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  Version                      The SPDM Version.
@@ -863,6 +1567,36 @@ SpdmIsCapabilitiesFlagSupported (
   }
 }
 
+/**
+  Return the largest length of a portion of a certificate chain in one CERTIFICATE response.
+
+  It follows the transport maximum message size, or is MAX_SPDM_CERT_CHAIN_BLOCK_LEN if it is not set.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MaxResponseSize              The size in bytes of the buffer of the CERTIFICATE response.
+
+  @return the largest length of a portion of a certificate chain.
+**/
+UINT16
+SpdmGetCertChainBlockLength (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     UINTN                     MaxResponseSize
+  )
+{
+  UINTN   MaxMessageSize;
+
+  if (SpdmContext->LocalContext.TransportMaxMessageSize == 0) {
+    MaxMessageSize = sizeof(SPDM_CERTIFICATE_RESPONSE) + MAX_SPDM_CERT_CHAIN_BLOCK_LEN;
+  } else {
+    MaxMessageSize = SpdmContext->LocalContext.TransportMaxMessageSize;
+  }
+  MaxMessageSize = MIN (MaxMessageSize, MaxResponseSize);
+  if (MaxMessageSize <= sizeof(SPDM_CERTIFICATE_RESPONSE)) {
+    return 0;
+  }
+  return (UINT16)MIN (MaxMessageSize - sizeof(SPDM_CERTIFICATE_RESPONSE), MAX_UINT16);
+}
+
 /**
   Register SPDM device input/output functions.
 
@@ -883,8 +1617,232 @@ SpdmRegisterDeviceIoFunc (
   SPDM_DEVICE_CONTEXT       *SpdmContext;
 
   SpdmContext = Context;
-  SpdmContext->SendMessage = SendMessage;
-  SpdmContext->ReceiveMessage = ReceiveMessage;
+  SpdmContext->TransportPath[0].SendMessage = SendMessage;
+  SpdmContext->TransportPath[0].ReceiveMessage = ReceiveMessage;
+  return ;
+}
+
+/**
+  Register SPDM device vectored input/output functions.
+
+  A registered vectored function is used instead of the function registered by SpdmRegisterDeviceIoFunc,
+  so that the device writes the segments of a message with writev, a DMA descriptor ring or a mailbox
+  directly, without gathering them to one buffer first.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SendMessageVector            The fuction to send an SPDM transport layer message from segments, or NULL.
+  @param  ReceiveMessageVector         The fuction to receive an SPDM transport layer message to segments, or NULL.
+**/
+VOID
+EFIAPI
+SpdmRegisterDeviceIoVectorFunc (
+  IN     VOID                                     *Context,
+  IN     SPDM_DEVICE_SEND_MESSAGE_VECTOR_FUNC     SendMessageVector OPTIONAL,
+  IN     SPDM_DEVICE_RECEIVE_MESSAGE_VECTOR_FUNC  ReceiveMessageVector OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->TransportPath[0].SendMessageVector = SendMessageVector;
+  SpdmContext->TransportPath[0].ReceiveMessageVector = ReceiveMessageVector;
+  return ;
+}
+
+/**
+  Register the context of the SPDM device input/output functions.
+
+  The device input/output functions get it with SpdmGetDeviceIoContext,
+  for example to find the mailbox of the device of the SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  DeviceIoContext              The context of the device input/output functions.
+**/
+VOID
+EFIAPI
+SpdmRegisterDeviceIoContext (
+  IN     VOID                              *Context,
+  IN     VOID                              *DeviceIoContext
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->TransportPath[0].DeviceIoContext = DeviceIoContext;
+  return ;
+}
+
+/**
+  Return the context of the SPDM device input/output functions.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the context registered by SpdmRegisterDeviceIoContext, or NULL.
+**/
+VOID *
+EFIAPI
+SpdmGetDeviceIoContext (
+  IN     VOID                              *Context
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  return SpdmContext->TransportPath[0].DeviceIoContext;
+}
+
+/**
+  Return the context of the device input/output function of the transport path a message is sent or received over.
+
+  A device send or receive function that may be registered to several transport paths calls it to find its device.
+  The path of a send and the path of a receive are kept apart, so that a send and a receive over
+  different paths may run on different threads.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsSend                       TRUE in a device send function, FALSE in a device receive function.
+
+  @return the DeviceIoContext of the transport path, or the context registered by SpdmRegisterDeviceIoContext for path 0.
+**/
+VOID *
+EFIAPI
+SpdmGetTransportPathDeviceIoContext (
+  IN     VOID                              *Context,
+  IN     BOOLEAN                           IsSend
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  if (IsSend) {
+    return SpdmContext->TransportPath[SpdmContext->SendTransportPath].DeviceIoContext;
+  }
+  return SpdmContext->TransportPath[SpdmContext->ReceiveTransportPath].DeviceIoContext;
+}
+
+/**
+  Send an SPDM transport layer message to the device of an SPDM context, over the path SendTransportPath.
+
+  The vectored send function is used if it is registered, with the message as one segment,
+  because the transport layer encodes the message in place in one buffer.
+  The message sent is passed to the registered capture function.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the message.
+  @param  Message                      A pointer to the message.
+  @param  Timeout                      The timeout, in 100ns units.
+
+  @return the status returned by the registered send function.
+**/
+RETURN_STATUS
+SpdmDeviceSendMessage (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     UINTN                     MessageSize,
+  IN     VOID                      *Message,
+  IN     UINT64                    Timeout
+  )
+{
+  SPDM_TRANSPORT_PATH_SLOT  *Path;
+  SPDM_IO_VECTOR            Vector;
+  RETURN_STATUS             Status;
+
+  Path = &SpdmContext->TransportPath[SpdmContext->SendTransportPath];
+  if (Path->SendMessageVector != NULL) {
+    Vector.Base = Message;
+    Vector.Length = MessageSize;
+    Status = Path->SendMessageVector (SpdmContext, 1, &Vector, Timeout);
+  } else {
+    Status = Path->SendMessage (SpdmContext, MessageSize, Message, Timeout);
+  }
+  if ((SpdmContext->Capture.CaptureFunc != 0) && !RETURN_ERROR(Status)) {
+    SpdmCaptureMessage (SpdmContext, TRUE, MessageSize, Message);
+  }
+  return Status;
+}
+
+/**
+  Receive an SPDM transport layer message from the device of an SPDM context, over the path ReceiveTransportPath.
+
+  The vectored receive function is used if it is registered, with the message buffer as one segment.
+  The message received is passed to the registered capture function.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the message received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units.
+
+  @return the status returned by the registered receive function.
+**/
+RETURN_STATUS
+SpdmDeviceReceiveMessage (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN OUT UINTN                     *MessageSize,
+  IN OUT VOID                      *Message,
+  IN     UINT64                    Timeout
+  )
+{
+  SPDM_TRANSPORT_PATH_SLOT  *Path;
+  SPDM_IO_VECTOR            Vector;
+  RETURN_STATUS             Status;
+
+  Path = &SpdmContext->TransportPath[SpdmContext->ReceiveTransportPath];
+  if (Path->ReceiveMessageVector != NULL) {
+    Vector.Base = Message;
+    Vector.Length = *MessageSize;
+    Status = Path->ReceiveMessageVector (SpdmContext, 1, &Vector, MessageSize, Timeout);
+  } else {
+    Status = Path->ReceiveMessage (SpdmContext, MessageSize, Message, Timeout);
+  }
+  if ((SpdmContext->Capture.CaptureFunc != 0) && !RETURN_ERROR(Status)) {
+    SpdmCaptureMessage (SpdmContext, FALSE, *MessageSize, Message);
+  }
+  return Status;
+}
+
+/**
+  Register an SPDM device stall function.
+
+  The stall function is optional. Without it, a retry is sent without waiting.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Stall                        The fuction to wait for a period of time.
+**/
+VOID
+EFIAPI
+SpdmRegisterDeviceStallFunc (
+  IN     VOID                              *Context,
+  IN     SPDM_DEVICE_STALL_FUNC            Stall
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->Stall = Stall;
+  return ;
+}
+
+/**
+  Register the function to read the cycle counter for the crypto statistics.
+
+  The cycle function is optional. Without it, the operations and the bytes are counted, but not the cycles.
+  It takes effect if OPENSPDM_CRYPTO_STATS_SUPPORT is 1.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  GetCycle                     The fuction to read the cycle counter.
+**/
+VOID
+EFIAPI
+SpdmRegisterCryptoCycleFunc (
+  IN     VOID                              *Context,
+  IN     SPDM_CRYPTO_GET_CYCLE_FUNC        GetCycle
+  )
+{
+#if OPENSPDM_CRYPTO_STATS_SUPPORT == 1
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->CryptoGetCycleFunc = (UINTN)GetCycle;
+#endif
   return ;
 }
 
@@ -908,8 +1866,198 @@ SpdmRegisterTransportLayerFunc (
   SPDM_DEVICE_CONTEXT       *SpdmContext;
 
   SpdmContext = Context;
-  SpdmContext->TransportEncodeMessage = TransportEncodeMessage;
-  SpdmContext->TransportDecodeMessage = TransportDecodeMessage;
+  SpdmContext->TransportPath[0].TransportEncodeMessage = TransportEncodeMessage;
+  SpdmContext->TransportPath[0].TransportDecodeMessage = TransportDecodeMessage;
+  return ;
+}
+
+/**
+  Register the SPDM transport layer function that returns the room of a transport layer message.
+
+  With it, the requester and the responder build each message at the headroom of the transport
+  message buffer, and the transport layer encodes it in place.
+
+  This function must be called after SpdmRegisterTransportLayerFunc, and before any SPDM communication.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  TransportGetMessageRoom      The fuction to return the room of a transport layer message.
+**/
+VOID
+EFIAPI
+SpdmRegisterTransportLayerMessageRoomFunc (
+  IN     VOID                                  *Context,
+  IN     SPDM_TRANSPORT_GET_MESSAGE_ROOM_FUNC  TransportGetMessageRoom
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->TransportPath[0].TransportGetMessageRoom = TransportGetMessageRoom;
+  return ;
+}
+
+/**
+  Register a DHE key pool to an SPDM context.
+
+  The responder takes the DHE key pair of KEY_EXCHANGE_RSP from the pool when the pool has one
+  for the negotiated DHENamedGroup, and so does the requester for SpdmPrestageKeyExchange.
+  The pool may be shared with other contexts and is refilled
+  by SpdmSecuredMessageDheKeyPoolRefill.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  DheKeyPool                   A pointer to the DHE key pool, or NULL to stop using a pool.
+**/
+VOID
+EFIAPI
+SpdmRegisterDheKeyPool (
+  IN     VOID                              *Context,
+  IN     VOID                              *DheKeyPool OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->DheKeyPool = DheKeyPool;
+  return ;
+}
+
+/**
+  Register the inline crypto engine offload functions to an SPDM context.
+
+  The functions are set to the secured message context of each session that is created afterwards,
+  so that the session keys are delivered to the engine, for example a NIC or a PCIe IDE engine.
+  See SpdmSecuredMessageSetOffloadOps.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  OffloadOps                   A pointer to the offload functions, or NULL to use software only.
+  @param  OffloadContext               The context passed to the offload functions.
+**/
+VOID
+EFIAPI
+SpdmRegisterSecuredMessageOffloadOps (
+  IN     VOID                              *Context,
+  IN     CONST SPDM_SECURED_MESSAGE_OFFLOAD_OPS  *OffloadOps OPTIONAL,
+  IN     VOID                              *OffloadContext OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->SecuredMessageOffloadOps = OffloadOps;
+  SpdmContext->SecuredMessageOffloadContext = OffloadContext;
+  return ;
+}
+
+/**
+  Register the asynchronous signing functions of the responder to an SPDM context.
+
+  The CHALLENGE_AUTH and KEY_EXCHANGE_RSP signatures are then generated by SignAsyncFunc
+  instead of SpdmResponderDataSignFunc. The MEASUREMENTS signature is still generated synchronously,
+  because only the hash of L1/L2 is kept. While a signing is pending, the responder answers
+  ERROR(ResponseNotReady) and completes the response when RESPOND_IF_READY finds the signing done.
+  Any other request abandons the pending signing.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SignAsyncFunc                The function to start a signing, or NULL to sign synchronously.
+  @param  SignPollFunc                 The function to poll a pending signing.
+**/
+VOID
+EFIAPI
+SpdmRegisterResponderDataSignAsyncFunc (
+  IN     VOID                                *Context,
+  IN     SPDM_RESPONDER_DATA_SIGN_ASYNC_FUNC SignAsyncFunc OPTIONAL,
+  IN     SPDM_RESPONDER_DATA_SIGN_POLL_FUNC  SignPollFunc OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->ResponderDataSignAsyncFunc = (UINTN)SignAsyncFunc;
+  SpdmContext->ResponderDataSignPollFunc = (UINTN)SignPollFunc;
+  SpdmContext->PendingSignature.Valid = FALSE;
+  return ;
+}
+
+/**
+  Register the yield function of the responder to an SPDM context.
+
+  As with the asynchronous signing, any request other than RESPOND_IF_READY abandons a yielded request.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  YieldFunc                    The function to decide whether to yield, or NULL to never yield.
+**/
+VOID
+EFIAPI
+SpdmRegisterResponderYieldFunc (
+  IN     VOID                                *Context,
+  IN     SPDM_RESPONDER_YIELD_FUNC           YieldFunc OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->ResponderYieldFunc = (UINTN)YieldFunc;
+  return ;
+}
+
+/**
+  Register the asynchronous signature verification functions of the requester to an SPDM context.
+
+  The CHALLENGE_AUTH and MEASUREMENTS signatures verified by SpdmStartChallenge and SpdmGetMeasurementsPipelined
+  are then verified by VerifyAsyncFunc, while the next request is sent. The other requests still verify
+  the signatures synchronously.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  VerifyAsyncFunc              The function to start a verification, or NULL to verify synchronously.
+  @param  VerifyPollFunc               The function to poll a pending verification.
+**/
+VOID
+EFIAPI
+SpdmRegisterRequesterVerifyAsyncFunc (
+  IN     VOID                                *Context,
+  IN     SPDM_REQUESTER_VERIFY_ASYNC_FUNC    VerifyAsyncFunc OPTIONAL,
+  IN     SPDM_REQUESTER_VERIFY_POLL_FUNC     VerifyPollFunc OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->RequesterVerifyAsyncFunc = (UINTN)VerifyAsyncFunc;
+  SpdmContext->RequesterVerifyPollFunc = (UINTN)VerifyPollFunc;
+  return ;
+}
+
+/**
+  Register a loaded private key handle to an SPDM context.
+
+  The handle is returned by SpdmResponderDataLoadKeyFunc or SpdmRequesterDataLoadKeyFunc.
+  It is used for signing while AsymAlgo matches the negotiated algorithm.
+  The SPDM context does not own the handle. The caller releases it after the context is no longer used.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsRequester                  Indicates if the handle is the requester private key.
+  @param  AsymAlgo                     The BaseAsymAlgo or ReqBaseAsymAlg of the private key.
+  @param  KeyHandle                    The private key handle, or NULL to load the private key per signing.
+**/
+VOID
+EFIAPI
+SpdmRegisterLocalPrivateKey (
+  IN     VOID                                *Context,
+  IN     BOOLEAN                             IsRequester,
+  IN     UINT32                              AsymAlgo,
+  IN     VOID                                *KeyHandle OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  if (IsRequester) {
+    SpdmContext->LocalContext.LocalReqPrivateKey = KeyHandle;
+    SpdmContext->LocalContext.LocalReqPrivateKeyAsymAlgo = (UINT16)AsymAlgo;
+  } else {
+    SpdmContext->LocalContext.LocalPrivateKey = KeyHandle;
+    SpdmContext->LocalContext.LocalPrivateKeyAsymAlgo = AsymAlgo;
+  }
   return ;
 }
 
@@ -970,6 +2118,210 @@ SpdmSetLastSpdmErrorStruct (
   CopyMem (&SpdmContext->LastSpdmError, LastSpdmError, sizeof(SPDM_ERROR_STRUCT));
 }
 
+//
+// The offsets of the variable-length regions after SPDM_DEVICE_CONTEXT.
+//
+typedef struct {
+  SPDM_CONTEXT_CONFIG       Config;
+  UINTN                     SessionIdListOffset;
+  UINTN                     SessionInfoOffset;
+  UINTN                     SecuredMessageContextOffset;
+  UINTN                     LastSpdmRequestOffset;
+  UINTN                     CachSpdmRequestOffset;
+  UINTN                     RequesterStepRequestOffset;
+  UINTN                     PendingSignatureResponseOffset;
+  UINTN                     PeerUsedCertChainBufferOffset;
+  UINTN                     TranscriptArenaOffset;
+  UINTN                     ScratchOffset;
+  UINTN                     ChunkBufferOffset;
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  UINTN                     SessionHashTableSize;
+  UINTN                     SessionHashTableOffset;
+  UINTN                     SessionFreeListOffset;
+#endif
+  UINTN                     ContextSize;
+} SPDM_CONTEXT_LAYOUT;
+
+/**
+  Lay out the variable-length regions of an SPDM context.
+
+  @param  Config                       The limits of the SPDM context, or NULL for the default limits.
+  @param  Layout                       The layout of the SPDM context.
+
+  @retval TRUE  the layout is returned.
+  @retval FALSE a limit in Config is out of range.
+**/
+BOOLEAN
+SpdmGetContextLayout (
+  IN     CONST SPDM_CONTEXT_CONFIG *Config OPTIONAL,
+     OUT SPDM_CONTEXT_LAYOUT       *Layout
+  )
+{
+  UINTN                     Offset;
+
+  Layout->Config.MaxSpdmMessageSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  Layout->Config.MaxCertChainSize   = MAX_SPDM_CERT_CHAIN_SIZE;
+  Layout->Config.MaxSessionCount    = MAX_SPDM_SESSION_COUNT;
+  Layout->Config.TranscriptArenaSize = 0;
+  Layout->Config.ScratchSize = SPDM_DEFAULT_SCRATCH_SIZE;
+  Layout->Config.ChunkBufferSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  if (Config != NULL) {
+    if ((Config->MaxSpdmMessageSize > MAX_SPDM_MESSAGE_BUFFER_SIZE) ||
+        ((Config->MaxCertChainSize > MAX_SPDM_CERT_CHAIN_SIZE) && (Config->MaxCertChainSize != SPDM_CONTEXT_CONFIG_NO_CERT_CHAIN_BUFFER)) ||
+        (Config->MaxSessionCount > MAX_SPDM_SESSION_SLOT_COUNT) ||
+        (Config->TranscriptArenaSize > MAX_UINT32) ||
+        (Config->ScratchSize > MAX_UINT32) ||
+        ((Config->ChunkBufferSize > MAX_SPDM_MESSAGE_BUFFER_SIZE) && (Config->ChunkBufferSize != SPDM_CONTEXT_CONFIG_NO_CHUNK_BUFFER))) {
+      return FALSE;
+    }
+    if (Config->MaxSpdmMessageSize != 0) {
+      Layout->Config.MaxSpdmMessageSize = Config->MaxSpdmMessageSize;
+    }
+    if (Config->MaxCertChainSize == SPDM_CONTEXT_CONFIG_NO_CERT_CHAIN_BUFFER) {
+      Layout->Config.MaxCertChainSize = 0;
+    } else if (Config->MaxCertChainSize != 0) {
+      Layout->Config.MaxCertChainSize = Config->MaxCertChainSize;
+    }
+    if (Config->MaxSessionCount != 0) {
+      Layout->Config.MaxSessionCount = Config->MaxSessionCount;
+    }
+    Layout->Config.TranscriptArenaSize = Config->TranscriptArenaSize;
+    if (Config->ScratchSize != 0) {
+      Layout->Config.ScratchSize = Config->ScratchSize;
+    }
+    if (Config->ChunkBufferSize == SPDM_CONTEXT_CONFIG_NO_CHUNK_BUFFER) {
+      Layout->Config.ChunkBufferSize = 0;
+    } else if (Config->ChunkBufferSize != 0) {
+      Layout->Config.ChunkBufferSize = Config->ChunkBufferSize;
+    }
+  }
+  if (Layout->Config.TranscriptArenaSize == 0) {
+    Layout->Config.TranscriptArenaSize = (2 + Layout->Config.MaxSessionCount) *
+                                         ((MAX_SPDM_MESSAGE_BUFFER_SIZE + SPDM_TRANSCRIPT_CHUNK_SIZE - 1) / SPDM_TRANSCRIPT_CHUNK_SIZE) *
+                                         sizeof(SPDM_TRANSCRIPT_CHUNK);
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+    Layout->Config.TranscriptArenaSize += SPDM_EVIDENCE_TRANSCRIPT_COUNT *
+                                          ((MAX_SPDM_MESSAGE_BUFFER_SIZE + SPDM_TRANSCRIPT_CHUNK_SIZE - 1) / SPDM_TRANSCRIPT_CHUNK_SIZE) *
+                                          sizeof(SPDM_TRANSCRIPT_CHUNK);
+#endif
+  }
+
+  //
+  // The session IDs follow the SPDM context, and the cold regions follow them.
+  //
+  Offset = ALIGN_VALUE (sizeof(SPDM_DEVICE_CONTEXT), sizeof(UINT64));
+  Layout->SessionIdListOffset = Offset;
+  Offset += ALIGN_VALUE (sizeof(UINT32) * Layout->Config.MaxSessionCount, sizeof(UINT64));
+  Layout->SessionInfoOffset = Offset;
+  Offset += ALIGN_VALUE (sizeof(SPDM_SESSION_INFO) * Layout->Config.MaxSessionCount, sizeof(UINT64));
+  Layout->SecuredMessageContextOffset = Offset;
+  Offset += ALIGN_VALUE (SpdmSecuredMessageGetContextSize(), sizeof(UINT64)) * Layout->Config.MaxSessionCount;
+  Layout->LastSpdmRequestOffset = Offset;
+  Offset += ALIGN_VALUE (Layout->Config.MaxSpdmMessageSize, sizeof(UINT64));
+  Layout->CachSpdmRequestOffset = Offset;
+  Offset += ALIGN_VALUE (Layout->Config.MaxSpdmMessageSize, sizeof(UINT64));
+  Layout->RequesterStepRequestOffset = Offset;
+  Offset += ALIGN_VALUE (Layout->Config.MaxSpdmMessageSize, sizeof(UINT64));
+  Layout->PendingSignatureResponseOffset = Offset;
+  Offset += ALIGN_VALUE (Layout->Config.MaxSpdmMessageSize, sizeof(UINT64));
+  Layout->PeerUsedCertChainBufferOffset = Offset;
+  Offset += ALIGN_VALUE (Layout->Config.MaxCertChainSize, sizeof(UINT64));
+  Layout->TranscriptArenaOffset = Offset;
+  Offset += ALIGN_VALUE (Layout->Config.TranscriptArenaSize, sizeof(UINT64));
+  Layout->ScratchOffset = Offset;
+  Offset += ALIGN_VALUE (Layout->Config.ScratchSize, sizeof(UINT64));
+  Layout->ChunkBufferOffset = Offset;
+  Offset += ALIGN_VALUE (Layout->Config.ChunkBufferSize, sizeof(UINT64));
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  //
+  // Keep the table at most half full, so that the probe sequences stay short.
+  //
+  Layout->SessionHashTableSize = 1;
+  while (Layout->SessionHashTableSize < Layout->Config.MaxSessionCount * 2) {
+    Layout->SessionHashTableSize <<= 1;
+  }
+  Layout->SessionHashTableOffset = Offset;
+  Offset += ALIGN_VALUE (sizeof(UINT16) * Layout->SessionHashTableSize, sizeof(UINT64));
+  Layout->SessionFreeListOffset = Offset;
+  Offset += ALIGN_VALUE (sizeof(UINT16) * Layout->Config.MaxSessionCount, sizeof(UINT64));
+#endif
+  Layout->ContextSize = Offset;
+  return TRUE;
+}
+
+/**
+  Initialize the session slots of an SPDM context to free slots.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Layout                       The layout of the SPDM context.
+**/
+VOID
+SpdmInitSessionSlots (
+  IN OUT SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     SPDM_CONTEXT_LAYOUT       *Layout
+  )
+{
+  VOID                      *SecuredMessageContext;
+  UINTN                     SecuredMessageContextSize;
+  UINTN                     Index;
+
+  SpdmContext->MaxSessionCount = Layout->Config.MaxSessionCount;
+  SpdmContext->SessionInfo = (VOID *)((UINT8 *)SpdmContext + Layout->SessionInfoOffset);
+  SpdmContext->SessionIdList = (VOID *)((UINT8 *)SpdmContext + Layout->SessionIdListOffset);
+  ZeroMem (SpdmContext->SessionIdList, sizeof(UINT32) * SpdmContext->MaxSessionCount);
+  SecuredMessageContext = (UINT8 *)SpdmContext + Layout->SecuredMessageContextOffset;
+  SecuredMessageContextSize = ALIGN_VALUE (SpdmSecuredMessageGetContextSize(), sizeof(UINT64));
+  ZeroMem (SpdmContext->SessionInfo, sizeof(SPDM_SESSION_INFO) * SpdmContext->MaxSessionCount);
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    InitSegmentedManagedBuffer (&SpdmContext->SessionInfo[Index].SessionTranscript.MessageK, &SpdmContext->TranscriptArena);
+    InitSegmentedManagedBuffer (&SpdmContext->SessionInfo[Index].SessionTranscript.MessageF, &SpdmContext->TranscriptArena);
+    SpdmContext->SessionInfo[Index].SecuredMessageContext = (VOID *)((UINTN)SecuredMessageContext + SecuredMessageContextSize * Index);
+    SpdmSecuredMessageInitContext (SpdmContext->SessionInfo[Index].SecuredMessageContext);
+  }
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  SpdmContext->SessionHashTableSize = Layout->SessionHashTableSize;
+  SpdmContext->SessionHashTable = (VOID *)((UINT8 *)SpdmContext + Layout->SessionHashTableOffset);
+  ZeroMem (SpdmContext->SessionHashTable, sizeof(UINT16) * SpdmContext->SessionHashTableSize);
+  SpdmContext->SessionFreeList = (VOID *)((UINT8 *)SpdmContext + Layout->SessionFreeListOffset);
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    SpdmContext->SessionFreeList[Index] = (UINT16)((Index + 1 < SpdmContext->MaxSessionCount) ? (Index + 2) : 0);
+  }
+  SpdmContext->SessionFreeHead = 1;
+#endif
+  SpdmContext->LatestSessionId = INVALID_SESSION_ID;
+}
+
+/**
+  Initialize the transcript arena of an SPDM context with the memory in the SPDM context,
+  and the segmented managed buffers of the transcript.
+
+  The session transcripts are initialized by SpdmInitSessionSlots.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Layout                       The layout of the SPDM context.
+**/
+VOID
+SpdmInitTranscriptArena (
+  IN OUT SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     SPDM_CONTEXT_LAYOUT       *Layout
+  )
+{
+  ZeroMem (&SpdmContext->TranscriptArena, sizeof(SpdmContext->TranscriptArena));
+  SpdmContext->TranscriptArenaSize = Layout->Config.TranscriptArenaSize;
+  SpdmTranscriptArenaAddMemory (
+    &SpdmContext->TranscriptArena,
+    (UINT8 *)SpdmContext + Layout->TranscriptArenaOffset,
+    Layout->Config.TranscriptArenaSize
+    );
+  InitSegmentedManagedBuffer (&SpdmContext->Transcript.MessageB, &SpdmContext->TranscriptArena);
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
+  InitSegmentedManagedBuffer (&SpdmContext->Transcript.MessageMutB, &SpdmContext->TranscriptArena);
+#endif
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  SpdmInitEvidence (SpdmContext);
+#endif
+}
+
 /**
   Initialize an SPDM context.
 
@@ -982,21 +2334,50 @@ EFIAPI
 SpdmInitContext (
   IN     VOID                      *Context
   )
+{
+  //
+  // The default limits are always valid.
+  //
+  SpdmInitContextEx (Context, NULL);
+}
+
+/**
+  Initialize an SPDM context with the limits of its variable-length regions.
+
+  The size in bytes of the SpdmContext can be returned by SpdmGetContextSizeEx with the same Config.
+
+  The secured message contexts of the sessions, with their secrets, and the scratch arena are regions of the SpdmContext,
+  so that the caller places them with the SpdmContext, such as in locked memory on the NUMA node of the thread which owns it.
+  The crypto contexts of the SpdmContext are pool allocations, placed by the allocator of SetPoolAllocator of the thread.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Config                       The limits of the SPDM context, or NULL for the default limits.
+
+  @retval RETURN_SUCCESS               The SPDM context is initialized.
+  @retval RETURN_INVALID_PARAMETER     A limit in Config is out of range.
+*/
+RETURN_STATUS
+EFIAPI
+SpdmInitContextEx (
+  IN     VOID                      *Context,
+  IN     CONST SPDM_CONTEXT_CONFIG *Config OPTIONAL
+  )
 {
   SPDM_DEVICE_CONTEXT       *SpdmContext;
-  VOID                      *SecuredMessageContext;
-  UINTN                     SecuredMessageContextSize;
-  UINTN                     Index;
+  SPDM_CONTEXT_LAYOUT       Layout;
+
+  if (!SpdmGetContextLayout (Config, &Layout)) {
+    return RETURN_INVALID_PARAMETER;
+  }
 
   SpdmContext = Context;
   ZeroMem (SpdmContext, sizeof(SPDM_DEVICE_CONTEXT));
   SpdmContext->Version = SPDM_DEVICE_CONTEXT_VERSION;
   SpdmContext->Transcript.MessageA.MaxBufferSize    = MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE;
-  SpdmContext->Transcript.MessageB.MaxBufferSize    = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SpdmContext->Transcript.MessageC.MaxBufferSize    = MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE;
-  SpdmContext->Transcript.MessageMutB.MaxBufferSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   SpdmContext->Transcript.MessageMutC.MaxBufferSize = MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE;
-  SpdmContext->Transcript.MessageM.MaxBufferSize    = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+#endif
   SpdmContext->RetryTimes                           = MAX_SPDM_REQUEST_RETRY_TIMES;
   SpdmContext->ResponseState                        = SpdmResponseStateNormal;
   SpdmContext->CurrentToken                         = 0;
@@ -1014,17 +2395,28 @@ SpdmInitContext (
   SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersion[0].MinorVersion        = 1;
   SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersion[0].Alpha               = 0;
   SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersion[0].UpdateVersionNumber = 0;
-  SpdmContext->EncapContext.CertificateChainBuffer.MaxBufferSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
-
-  SecuredMessageContext = (VOID *)((UINTN)(SpdmContext + 1));
-  SecuredMessageContextSize = SpdmSecuredMessageGetContextSize();
-  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
-    SpdmContext->SessionInfo[Index].SecuredMessageContext = (VOID *)((UINTN)SecuredMessageContext + SecuredMessageContextSize * Index);
-    SpdmSecuredMessageInitContext (SpdmContext->SessionInfo[Index].SecuredMessageContext);
-  }
+  SpdmUpdateOpaqueData (SpdmContext);
+  SpdmContext->LocalContext.DebugDumpMask = SPDM_DEBUG_DUMP_ALL;
+  SpdmRandomStreamInit (&SpdmContext->RandomStream);
+
+  SpdmContext->MaxSpdmMessageSize = Layout.Config.MaxSpdmMessageSize;
+  SpdmContext->LastSpdmRequest = (UINT8 *)SpdmContext + Layout.LastSpdmRequestOffset;
+  SpdmContext->CachSpdmRequest = (UINT8 *)SpdmContext + Layout.CachSpdmRequestOffset;
+  SpdmContext->RequesterStep.Request = (UINT8 *)SpdmContext + Layout.RequesterStepRequestOffset;
+  SpdmContext->PendingSignature.Response = (UINT8 *)SpdmContext + Layout.PendingSignatureResponseOffset;
+  SpdmContext->ConnectionInfo.PeerCertChainInlineBufferSize = Layout.Config.MaxCertChainSize;
+  SpdmContext->ConnectionInfo.MaxPeerUsedCertChainBufferSize = Layout.Config.MaxCertChainSize;
+  SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer = (UINT8 *)SpdmContext + Layout.PeerUsedCertChainBufferOffset;
+  SpdmInitTranscriptArena (SpdmContext, &Layout);
+  SpdmContext->Scratch = (UINT8 *)SpdmContext + Layout.ScratchOffset;
+  SpdmContext->ScratchSize = Layout.Config.ScratchSize;
+  SpdmContext->ScratchUsed = 0;
+  SpdmContext->ChunkBuffer = (UINT8 *)SpdmContext + Layout.ChunkBufferOffset;
+  SpdmContext->ChunkBufferSize = Layout.Config.ChunkBufferSize;
+  SpdmInitSessionSlots (SpdmContext, &Layout);
 
   RandomSeed (NULL, 0);
-  return ;
+  return RETURN_SUCCESS;
 }
 
 /**
@@ -1038,5 +2430,450 @@ SpdmGetContextSize (
   VOID
   )
 {
-  return sizeof(SPDM_DEVICE_CONTEXT) + SpdmSecuredMessageGetContextSize() * MAX_SPDM_SESSION_COUNT;
+  return SpdmGetContextSizeEx (NULL);
+}
+
+/**
+  Return the size in bytes of an SPDM context with the limits of its variable-length regions.
+
+  @param  Config                       The limits of the SPDM context, or NULL for the default limits.
+
+  @return the size in bytes of the SPDM context, or 0 if a limit in Config is out of range.
+**/
+UINTN
+EFIAPI
+SpdmGetContextSizeEx (
+  IN     CONST SPDM_CONTEXT_CONFIG *Config OPTIONAL
+  )
+{
+  SPDM_CONTEXT_LAYOUT       Layout;
+
+  if (!SpdmGetContextLayout (Config, &Layout)) {
+    return 0;
+  }
+  return Layout.ContextSize;
+}
+
+/**
+  Return the layout of an initialized SPDM context, from the limits it is initialized with.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Layout                       The layout of the SPDM context.
+**/
+VOID
+SpdmGetInitializedContextLayout (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+     OUT SPDM_CONTEXT_LAYOUT       *Layout
+  )
+{
+  SPDM_CONTEXT_CONFIG       Config;
+
+  Config.MaxSpdmMessageSize = SpdmContext->MaxSpdmMessageSize;
+  Config.MaxCertChainSize   = SpdmContext->ConnectionInfo.PeerCertChainInlineBufferSize;
+  if (Config.MaxCertChainSize == 0) {
+    Config.MaxCertChainSize = SPDM_CONTEXT_CONFIG_NO_CERT_CHAIN_BUFFER;
+  }
+  Config.MaxSessionCount    = SpdmContext->MaxSessionCount;
+  Config.TranscriptArenaSize = SpdmContext->TranscriptArenaSize;
+  Config.ScratchSize        = SpdmContext->ScratchSize;
+  Config.ChunkBufferSize    = SpdmContext->ChunkBufferSize;
+  if (Config.ChunkBufferSize == 0) {
+    Config.ChunkBufferSize = SPDM_CONTEXT_CONFIG_NO_CHUNK_BUFFER;
+  }
+  //
+  // The limits are in range, as the SPDM context is initialized with them.
+  //
+  SpdmGetContextLayout (&Config, Layout);
+}
+
+/**
+  Add memory to the transcript arena of an SPDM context.
+
+  The transcripts are kept in chunks of SPDM_TRANSCRIPT_CHUNK_SIZE bytes, taken from the arena as the messages
+  are appended and returned to it when the transcripts are reset, so that their size is only limited by the arena.
+  The memory must stay valid until the SPDM context is released. It is not used by a clone of the SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Buffer                       A pointer to the memory.
+  @param  BufferSize                   Size in bytes of the memory.
+
+  @retval RETURN_SUCCESS               The memory is added to the transcript arena.
+  @retval RETURN_INVALID_PARAMETER     Buffer is NULL, or the memory cannot hold a chunk.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAddTranscriptArenaMemory (
+  IN     VOID                      *Context,
+  IN     VOID                      *Buffer,
+  IN     UINTN                     BufferSize
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  if (Buffer == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (SpdmTranscriptArenaAddMemory (&SpdmContext->TranscriptArena, Buffer, BufferSize) == 0) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Take a temporary buffer from the scratch arena of an SPDM context.
+
+  The buffers are released by SpdmReleaseScratch in the reverse order they are taken.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Size                         Size in bytes of the buffer.
+
+  @return the address of the buffer, or NULL if the scratch arena is exhausted.
+**/
+VOID *
+SpdmAcquireScratch (
+  IN OUT SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     UINTN                     Size
+  )
+{
+  VOID                      *Buffer;
+
+  Size = ALIGN_VALUE (Size, sizeof(UINT64));
+  if (Size > SpdmContext->ScratchSize - SpdmContext->ScratchUsed) {
+    DEBUG((DEBUG_INFO, "SpdmAcquireScratch - 0x%x bytes, scratch arena exhausted\n", Size));
+    return NULL;
+  }
+  Buffer = SpdmContext->Scratch + SpdmContext->ScratchUsed;
+  SpdmContext->ScratchUsed += Size;
+  return Buffer;
+}
+
+/**
+  Return a temporary buffer to the scratch arena of an SPDM context.
+
+  The buffer and the buffers taken after it are released.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Buffer                       The buffer taken by SpdmAcquireScratch.
+**/
+VOID
+SpdmReleaseScratch (
+  IN OUT SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     VOID                      *Buffer
+  )
+{
+  ASSERT (((UINT8 *)Buffer >= SpdmContext->Scratch) &&
+          ((UINT8 *)Buffer <= SpdmContext->Scratch + SpdmContext->ScratchUsed));
+  SpdmContext->ScratchUsed = (UINT8 *)Buffer - SpdmContext->Scratch;
+}
+
+/**
+  Register a buffer to an SPDM context to hold the peer certificate chain, instead of its inline buffer.
+
+  The certificate chain got by GET_CERTIFICATE is collected in place in the buffer, so that its size
+  is only limited by the buffer and by the transcript, not by MAX_SPDM_CERT_CHAIN_SIZE.
+  The buffer must stay valid until another buffer is registered or the SPDM context is released.
+  Registering a buffer discards the current peer certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CertChainBuffer              A pointer to the peer certificate chain buffer, or NULL to use the inline buffer.
+  @param  CertChainBufferSize          Size in bytes of the peer certificate chain buffer, up to MAX_UINT16.
+
+  @retval RETURN_SUCCESS               The buffer is registered.
+  @retval RETURN_INVALID_PARAMETER     The CertChainBufferSize is out of range.
+  @retval RETURN_NOT_READY             An operation of SpdmRequesterStep is in progress.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRegisterPeerCertChainBuffer (
+  IN     VOID                      *Context,
+  IN     VOID                      *CertChainBuffer OPTIONAL,
+  IN     UINTN                     CertChainBufferSize
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+  SPDM_CONTEXT_LAYOUT       Layout;
+
+  SpdmContext = Context;
+  if ((CertChainBuffer != NULL) && ((CertChainBufferSize == 0) || (CertChainBufferSize > MAX_UINT16))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  //
+  // A GET_CERTIFICATE in progress collects the certificate chain in the current buffer.
+  //
+  if (SpdmContext->RequesterStep.Stage != SpdmRequesterStepStageNone) {
+    return RETURN_NOT_READY;
+  }
+
+  SpdmResetPeerPublicKey (SpdmContext);
+  if (CertChainBuffer == NULL) {
+    SpdmGetInitializedContextLayout (SpdmContext, &Layout);
+    SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer = (UINT8 *)SpdmContext + Layout.PeerUsedCertChainBufferOffset;
+    SpdmContext->ConnectionInfo.MaxPeerUsedCertChainBufferSize = SpdmContext->ConnectionInfo.PeerCertChainInlineBufferSize;
+  } else {
+    SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer = CertChainBuffer;
+    SpdmContext->ConnectionInfo.MaxPeerUsedCertChainBufferSize = CertChainBufferSize;
+  }
+  SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = 0;
+  SpdmContext->ConnectionInfo.PeerCertChainCollectedSize = 0;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Release the resources held by an SPDM context, such as the running transcript hashes,
+  the session keys and the cached peer public key.
+
+  It must be called before an initialized SPDM context is initialized again, is the Clone of SpdmCloneContext, or is discarded.
+  The resources registered by the integrator, such as the private keys and the shared caches, are not released.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+*/
+VOID
+EFIAPI
+SpdmDeinitContext (
+  IN     VOID                      *Context
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+  UINTN                     Index;
+
+  SpdmContext = Context;
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    SpdmResetSessionTranscriptDigest (&SpdmContext->SessionInfo[Index]);
+    SpdmSecuredMessageDeinitContext (SpdmContext->SessionInfo[Index].SecuredMessageContext);
+  }
+  SpdmResetMessageM (SpdmContext);
+#if OPENSPDM_MESSAGE_A_DIGEST_SUPPORT == 1
+  SpdmResetMessageADigest (SpdmContext);
+#endif
+  SpdmResetMessageDigest (&SpdmContext->Transcript.MessageBDigest);
+  SpdmResetPeerPublicKey (SpdmContext);
+  if (SpdmContext->RequesterStep.DHEContext != NULL) {
+    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, SpdmContext->RequesterStep.DHEContext);
+    SpdmContext->RequesterStep.DHEContext = NULL;
+  }
+  for (Index = 0; Index < MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT; Index++) {
+    if (SpdmContext->PrestagedKeyExchange[Index].Valid) {
+      SpdmSecuredMessageDheFree (SpdmContext->PrestagedKeyExchange[Index].DHENamedGroup, SpdmContext->PrestagedKeyExchange[Index].DHEContext);
+    }
+  }
+  ZeroMem (SpdmContext->PrestagedKeyExchange, sizeof(SpdmContext->PrestagedKeyExchange));
+  if (SpdmContext->PendingSignature.DHEContext != NULL) {
+    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, SpdmContext->PendingSignature.DHEContext);
+    SpdmContext->PendingSignature.DHEContext = NULL;
+  }
+}
+
+/**
+  Return a new hash context with the state of a running hash.
+
+  @param  BaseHashAlgo                 The hash algorithm of the running hash.
+  @param  HashContext                  The running hash context.
+
+  @return the new hash context, or NULL if it cannot be created.
+**/
+VOID *
+SpdmCloneHashContext (
+  IN     UINT32                    BaseHashAlgo,
+  IN     VOID                      *HashContext
+  )
+{
+  VOID                      *NewHashContext;
+
+  NewHashContext = SpdmHashNew (BaseHashAlgo);
+  if (NewHashContext == NULL) {
+    return NULL;
+  }
+  if (!SpdmHashDuplicate (BaseHashAlgo, HashContext, NewHashContext)) {
+    SpdmHashFree (BaseHashAlgo, NewHashContext);
+    return NULL;
+  }
+  return NewHashContext;
+}
+
+/**
+  Clone an SPDM context, such as a provisioned and negotiated template context, to another SPDM context.
+
+  The Clone gets the local settings, the registered functions, the connection state, the transcripts
+  and the verified peer certificate chain of the SpdmContext. The pointers into the SpdmContext are
+  moved into the Clone, and the Clone gets its own running transcript hashes and its own random stream.
+  The buffers and the resources registered by the integrator, such as the provisioned certificate chains,
+  the device IO context, the certificate chain verification cache and the DHE key pool, are shared.
+  The peer public key is parsed again by the Clone on first use,
+  and the KEY_EXCHANGE requests prepared by SpdmPrestageKeyExchange are not cloned.
+  A peer certificate chain buffer registered by SpdmRegisterPeerCertChainBuffer is shared too,
+  so the Clone must register its own buffer before it gets a peer certificate chain.
+
+  With SpdmCloneSecretsInclude, the Clone also gets the sessions with their keys and the registered private keys,
+  so that it can continue the sessions of the SpdmContext. The keys are installed again in the inline crypto engine
+  by the Clone on first use. The SpdmContext and the Clone must not both send secured messages in the same session,
+  because the sequence numbers would be reused.
+  With SpdmCloneSecretsExclude, the Clone has no session and no private key.
+
+  The Clone must be at least the size returned by SpdmGetContextSizeEx with the Config of the SpdmContext.
+  It must not be an initialized SPDM context, unless it is released by SpdmDeinitContext first.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SecretsPolicy                The policy of the secrets of the SpdmContext.
+  @param  CloneSize                    Size in bytes of the Clone buffer.
+  @param  Clone                        A pointer to the buffer of the cloned SPDM context.
+
+  @retval RETURN_SUCCESS               The SPDM context is cloned.
+  @retval RETURN_INVALID_PARAMETER     The SecretsPolicy is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The Clone buffer is too small.
+  @retval RETURN_NOT_READY             An operation of SpdmRequesterStep or an asynchronous signature is in progress.
+  @retval RETURN_OUT_OF_RESOURCES      The running transcript hashes cannot be cloned,
+                                       or the transcripts do not fit in the transcript arena of the Clone.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmCloneContext (
+  IN     VOID                      *Context,
+  IN     SPDM_CLONE_SECRETS_POLICY SecretsPolicy,
+  IN     UINTN                     CloneSize,
+     OUT VOID                      *Clone
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+  SPDM_DEVICE_CONTEXT       *CloneContext;
+  SPDM_CONTEXT_LAYOUT       Layout;
+  SPDM_SESSION_INFO         *SessionInfo;
+  SPDM_SESSION_INFO         *CloneSessionInfo;
+  UINTN                     Index;
+
+  SpdmContext = Context;
+  if ((SecretsPolicy != SpdmCloneSecretsExclude) && (SecretsPolicy != SpdmCloneSecretsInclude)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  SpdmGetInitializedContextLayout (SpdmContext, &Layout);
+  if (CloneSize < Layout.ContextSize) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  //
+  // The state of an operation in progress refers to the caller buffers and to a DHE key pair.
+  //
+  if ((SpdmContext->RequesterStep.Stage != SpdmRequesterStepStageNone) || SpdmContext->PendingSignature.Valid) {
+    return RETURN_NOT_READY;
+  }
+
+  CloneContext = Clone;
+  CopyMem (CloneContext, SpdmContext, Layout.ContextSize);
+  //
+  // The Clone takes the chunks of its transcripts from its own arena.
+  //
+  SpdmInitTranscriptArena (CloneContext, &Layout);
+  CloneContext->Scratch = (UINT8 *)CloneContext + Layout.ScratchOffset;
+  CloneContext->ChunkBuffer = (UINT8 *)CloneContext + Layout.ChunkBufferOffset;
+  CloneContext->LastSpdmRequest = (UINT8 *)CloneContext + Layout.LastSpdmRequestOffset;
+  CloneContext->CachSpdmRequest = (UINT8 *)CloneContext + Layout.CachSpdmRequestOffset;
+  CloneContext->RequesterStep.Request = (UINT8 *)CloneContext + Layout.RequesterStepRequestOffset;
+  CloneContext->PendingSignature.Response = (UINT8 *)CloneContext + Layout.PendingSignatureResponseOffset;
+  if (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer == (UINT8 *)SpdmContext + Layout.PeerUsedCertChainBufferOffset) {
+    CloneContext->ConnectionInfo.PeerUsedCertChainBuffer = (UINT8 *)CloneContext + Layout.PeerUsedCertChainBufferOffset;
+  }
+  SpdmRandomStreamInit (&CloneContext->RandomStream);
+
+  //
+  // The Clone holds no resource of the SpdmContext, before its own resources are created.
+  //
+  CloneContext->Transcript.MessageM.HashContext = NULL;
+  CloneContext->Transcript.MessageBDigest.HashContext = NULL;
+#if OPENSPDM_MESSAGE_A_DIGEST_SUPPORT == 1
+  //
+  // The Clone hashes Message A again.
+  //
+  ZeroMem (&CloneContext->Transcript.MessageADigest, sizeof(CloneContext->Transcript.MessageADigest));
+#endif
+  CloneContext->ConnectionInfo.PeerPublicKey = NULL;
+  CloneContext->ConnectionInfo.PeerPublicKeyShared = FALSE;
+  CloneContext->ConnectionInfo.PeerPublicKeyIsReqAsym = FALSE;
+  CloneContext->ConnectionInfo.PeerPublicKeyAsymAlgo = 0;
+  CloneContext->ConnectionInfo.PeerPublicKeyHashAlgo = 0;
+  ZeroMem (CloneContext->ConnectionInfo.PeerPublicKeyCertHash, sizeof(CloneContext->ConnectionInfo.PeerPublicKeyCertHash));
+  CloneContext->ConnectionInfo.PeerPreparedPublicKey = NULL;
+  CloneContext->ConnectionInfo.PeerPublicKeyVerifyCount = 0;
+  CloneContext->ConnectionInfo.PeerCertChainCacheEntry = NULL;
+  CloneContext->RequesterStep.DHEContext = NULL;
+  ZeroMem (CloneContext->PrestagedKeyExchange, sizeof(CloneContext->PrestagedKeyExchange));
+  SpdmInitSessionSlots (CloneContext, &Layout);
+  if (RETURN_ERROR(AppendManagedBufferData (&CloneContext->Transcript.MessageB, &SpdmContext->Transcript.MessageB))) {
+    SpdmDeinitContext (CloneContext);
+    return RETURN_OUT_OF_RESOURCES;
+  }
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
+  if (RETURN_ERROR(AppendManagedBufferData (&CloneContext->Transcript.MessageMutB, &SpdmContext->Transcript.MessageMutB))) {
+    SpdmDeinitContext (CloneContext);
+    return RETURN_OUT_OF_RESOURCES;
+  }
+#endif
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  if (RETURN_ERROR(SpdmCloneEvidence (CloneContext, SpdmContext))) {
+    SpdmDeinitContext (CloneContext);
+    return RETURN_OUT_OF_RESOURCES;
+  }
+#endif
+
+  if (SecretsPolicy == SpdmCloneSecretsExclude) {
+    CloneContext->LocalContext.LocalPrivateKey = NULL;
+    CloneContext->LocalContext.LocalReqPrivateKey = NULL;
+  } else {
+    for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+      SessionInfo = &SpdmContext->SessionInfo[Index];
+      CloneSessionInfo = &CloneContext->SessionInfo[Index];
+      CopyMem (CloneSessionInfo, SessionInfo, OFFSET_OF(SPDM_SESSION_INFO, SecuredMessageContext));
+      CloneContext->SessionIdList[Index] = SessionInfo->SessionId;
+      CloneSessionInfo->SessionTranscript.DigestContextTH = NULL;
+      InitSegmentedManagedBuffer (&CloneSessionInfo->SessionTranscript.MessageK, &CloneContext->TranscriptArena);
+      InitSegmentedManagedBuffer (&CloneSessionInfo->SessionTranscript.MessageF, &CloneContext->TranscriptArena);
+      SpdmSecuredMessageCloneContext (CloneSessionInfo->SecuredMessageContext, SessionInfo->SecuredMessageContext);
+      if (RETURN_ERROR(AppendManagedBufferData (&CloneSessionInfo->SessionTranscript.MessageK, &SessionInfo->SessionTranscript.MessageK)) ||
+          RETURN_ERROR(AppendManagedBufferData (&CloneSessionInfo->SessionTranscript.MessageF, &SessionInfo->SessionTranscript.MessageF))) {
+        SpdmDeinitContext (CloneContext);
+        return RETURN_OUT_OF_RESOURCES;
+      }
+    }
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+    CopyMem (CloneContext->SessionHashTable, SpdmContext->SessionHashTable, sizeof(UINT16) * SpdmContext->SessionHashTableSize);
+    CopyMem (CloneContext->SessionFreeList, SpdmContext->SessionFreeList, sizeof(UINT16) * SpdmContext->MaxSessionCount);
+    CloneContext->SessionFreeHead = SpdmContext->SessionFreeHead;
+#endif
+    CloneContext->LatestSessionId = SpdmContext->LatestSessionId;
+
+    for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+      SessionInfo = &SpdmContext->SessionInfo[Index];
+      if (SessionInfo->SessionTranscript.DigestContextTH == NULL) {
+        continue;
+      }
+      CloneContext->SessionInfo[Index].SessionTranscript.DigestContextTH = SpdmCloneHashContext (
+                                                                             SessionInfo->SessionTranscript.DigestBaseHashAlgo,
+                                                                             SessionInfo->SessionTranscript.DigestContextTH
+                                                                             );
+      if (CloneContext->SessionInfo[Index].SessionTranscript.DigestContextTH == NULL) {
+        SpdmDeinitContext (CloneContext);
+        return RETURN_OUT_OF_RESOURCES;
+      }
+    }
+  }
+
+  if (SpdmContext->Transcript.MessageM.HashContext != NULL) {
+    CloneContext->Transcript.MessageM.HashContext = SpdmCloneHashContext (
+                                                      SpdmContext->Transcript.MessageM.BaseHashAlgo,
+                                                      SpdmContext->Transcript.MessageM.HashContext
+                                                      );
+    if (CloneContext->Transcript.MessageM.HashContext == NULL) {
+      SpdmDeinitContext (CloneContext);
+      return RETURN_OUT_OF_RESOURCES;
+    }
+  }
+  if (SpdmContext->Transcript.MessageBDigest.HashContext != NULL) {
+    CloneContext->Transcript.MessageBDigest.HashContext = SpdmCloneHashContext (
+                                                            SpdmContext->Transcript.MessageBDigest.BaseHashAlgo,
+                                                            SpdmContext->Transcript.MessageBDigest.HashContext
+                                                            );
+    if (CloneContext->Transcript.MessageBDigest.HashContext == NULL) {
+      SpdmDeinitContext (CloneContext);
+      return RETURN_OUT_OF_RESOURCES;
+    }
+  }
+  return RETURN_SUCCESS;
 }
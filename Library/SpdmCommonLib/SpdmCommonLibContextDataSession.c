@@ -9,6 +9,165 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmCommonLibInternal.h"
 
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+
+/**
+  This function returns the home slot of a session ID in the session hash table.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SPDM session ID.
+
+  @return the home slot of the session ID.
+**/
+UINTN
+SpdmSessionHashTableHome (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     UINT32                  SessionId
+  )
+{
+  UINT32                     Hash;
+
+  //
+  // Both halves of the session ID are small slot based numbers, so mix them before masking.
+  //
+  Hash = SessionId ^ (SessionId >> 16);
+  Hash = Hash * 0x9E3779B1;
+  Hash = Hash ^ (Hash >> 16);
+  return (UINTN)Hash & (SpdmContext->SessionHashTableSize - 1);
+}
+
+/**
+  This function finds the session hash table slot of a session ID.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SPDM session ID.
+  @param  Slot                         The session hash table slot of the session ID, or the empty slot ending the probe.
+
+  @retval TRUE   The session ID is found.
+  @retval FALSE  The session ID is not found.
+**/
+BOOLEAN
+SpdmSessionHashTableFind (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     UINT32                  SessionId,
+     OUT UINTN                   *Slot
+  )
+{
+  UINTN                      Index;
+  UINT16                     Entry;
+
+  //
+  // The table is at most half full, so the probe always ends at an empty slot.
+  //
+  Index = SpdmSessionHashTableHome (SpdmContext, SessionId);
+  while ((Entry = SpdmContext->SessionHashTable[Index]) != 0) {
+    if (SpdmContext->SessionIdList[Entry - 1] == SessionId) {
+      *Slot = Index;
+      return TRUE;
+    }
+    Index = (Index + 1) & (SpdmContext->SessionHashTableSize - 1);
+  }
+  *Slot = Index;
+  return FALSE;
+}
+
+/**
+  This function returns a session slot to the free list, and removes its session ID from the session hash table.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  A pointer to the session slot, with its current session ID.
+**/
+VOID
+SpdmSessionTableRemove (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     SPDM_SESSION_INFO       *SessionInfo
+  )
+{
+  UINTN                      Mask;
+  UINTN                      Hole;
+  UINTN                      Index;
+  UINTN                      Home;
+  UINT16                     Entry;
+
+  if (SessionInfo->SessionId == INVALID_SESSION_ID) {
+    return;
+  }
+  if (!SpdmSessionHashTableFind (SpdmContext, SessionInfo->SessionId, &Hole)) {
+    ASSERT(FALSE);
+    return;
+  }
+
+  //
+  // Shift the following entries of the probe sequence back into the hole,
+  // unless their home slot lies cyclically in (Hole, Index].
+  //
+  Mask = SpdmContext->SessionHashTableSize - 1;
+  Index = Hole;
+  while (TRUE) {
+    Index = (Index + 1) & Mask;
+    Entry = SpdmContext->SessionHashTable[Index];
+    if (Entry == 0) {
+      break;
+    }
+    Home = SpdmSessionHashTableHome (SpdmContext, SpdmContext->SessionIdList[Entry - 1]);
+    if (((Index - Home) & Mask) >= ((Index - Hole) & Mask)) {
+      SpdmContext->SessionHashTable[Hole] = Entry;
+      Hole = Index;
+    }
+  }
+  SpdmContext->SessionHashTable[Hole] = 0;
+
+  Index = SessionInfo - SpdmContext->SessionInfo;
+  SpdmContext->SessionFreeList[Index] = (UINT16)SpdmContext->SessionFreeHead;
+  SpdmContext->SessionFreeHead = Index + 1;
+}
+
+/**
+  This function takes a session slot from the free list, and inserts its session ID into the session hash table.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  A pointer to the session slot, with its new session ID.
+**/
+VOID
+SpdmSessionTableInsert (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     SPDM_SESSION_INFO       *SessionInfo
+  )
+{
+  UINTN                      Index;
+  UINTN                      Prev;
+  UINTN                      Slot;
+
+  if (SessionInfo->SessionId == INVALID_SESSION_ID) {
+    return;
+  }
+
+  //
+  // The slot is normally the head of the free list, unless it is initialized directly.
+  //
+  Index = SessionInfo - SpdmContext->SessionInfo;
+  if (SpdmContext->SessionFreeHead == Index + 1) {
+    SpdmContext->SessionFreeHead = SpdmContext->SessionFreeList[Index];
+  } else {
+    Prev = SpdmContext->SessionFreeHead;
+    while ((Prev != 0) && (SpdmContext->SessionFreeList[Prev - 1] != Index + 1)) {
+      Prev = SpdmContext->SessionFreeList[Prev - 1];
+    }
+    if (Prev != 0) {
+      SpdmContext->SessionFreeList[Prev - 1] = SpdmContext->SessionFreeList[Index];
+    }
+  }
+  SpdmContext->SessionFreeList[Index] = 0;
+
+  if (SpdmSessionHashTableFind (SpdmContext, SessionInfo->SessionId, &Slot)) {
+    ASSERT(FALSE);
+    return;
+  }
+  SpdmContext->SessionHashTable[Slot] = (UINT16)(Index + 1);
+}
+
+#endif
+
 /**
   This function initializes the session info.
 
@@ -25,6 +184,7 @@ SpdmSessionInfoInit (
 {
   SPDM_SESSION_TYPE          SessionType;
   UINT32                     CapabilitiesFlag;
+  SPDM_SESSION_TRANSCRIPT    *SessionTranscript;
 
   CapabilitiesFlag = SpdmContext->ConnectionInfo.Capability.Flags & SpdmContext->LocalContext.Capability.Flags;
   switch (CapabilitiesFlag &
@@ -44,11 +204,37 @@ SpdmSessionInfoInit (
     break;
   }
 
-  ZeroMem (SessionInfo, OFFSET_OF(SPDM_SESSION_INFO, SecuredMessageContext));
-  SpdmSecuredMessageInitContext (SessionInfo->SecuredMessageContext);
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  SpdmSessionTableRemove (SpdmContext, SessionInfo);
+#endif
+
+  SpdmResetSessionTranscriptDigest (SessionInfo);
+  //
+  // The chunks of the transcripts are returned to the transcript arena, with only their used part zeroed.
+  //
+  SessionTranscript = &SessionInfo->SessionTranscript;
+  ResetManagedBuffer (&SessionTranscript->MessageK);
+  ResetManagedBuffer (&SessionTranscript->MessageF);
+  ZeroMem (SessionInfo, OFFSET_OF(SPDM_SESSION_INFO, SessionTranscript));
+  ZeroMem (
+    &SessionTranscript->DigestContextTH,
+    sizeof(SPDM_SESSION_TRANSCRIPT) - OFFSET_OF(SPDM_SESSION_TRANSCRIPT, DigestContextTH)
+    );
+  ZeroMem (
+    &SessionInfo->KeyUpdatePolicy,
+    OFFSET_OF(SPDM_SESSION_INFO, SecuredMessageContext) - OFFSET_OF(SPDM_SESSION_INFO, KeyUpdatePolicy)
+    );
+  SpdmSecuredMessageDeinitContext (SessionInfo->SecuredMessageContext);
+  SpdmSecuredMessageResetContext (SessionInfo->SecuredMessageContext);
   SessionInfo->SessionId = SessionId;
+  SpdmContext->SessionIdList[SessionInfo - SpdmContext->SessionInfo] = SessionId;
   SessionInfo->UsePsk    = UsePsk;
   SpdmSecuredMessageSetUsePsk (SessionInfo->SecuredMessageContext, UsePsk);
+  SpdmSecuredMessageSetHandshakeInTheClear (
+    SessionInfo->SecuredMessageContext,
+    (CapabilitiesFlag & SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP) != 0
+    );
+  SpdmSecuredMessageSetDebugDumpMask (SessionInfo->SecuredMessageContext, SpdmContext->LocalContext.DebugDumpMask);
   SpdmSecuredMessageSetSessionType (SessionInfo->SecuredMessageContext, SessionType);
   SpdmSecuredMessageSetAlgorithms (
     SessionInfo->SecuredMessageContext,
@@ -57,13 +243,25 @@ SpdmSessionInfoInit (
     SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite,
     SpdmContext->ConnectionInfo.Algorithm.KeySchedule
     );
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
   SpdmSecuredMessageSetPskHint (
     SessionInfo->SecuredMessageContext,
     SpdmContext->LocalContext.PskHint,
     SpdmContext->LocalContext.PskHintSize
     );
-  SessionInfo->SessionTranscript.MessageK.MaxBufferSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
-  SessionInfo->SessionTranscript.MessageF.MaxBufferSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+#endif
+  if (SessionId != INVALID_SESSION_ID) {
+    SpdmSecuredMessageSetOffloadOps (
+      SessionInfo->SecuredMessageContext,
+      SessionId,
+      SpdmContext->SecuredMessageOffloadOps,
+      SpdmContext->SecuredMessageOffloadContext
+      );
+  }
+
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  SpdmSessionTableInsert (SpdmContext, SessionInfo);
+#endif
 }
 
 /**
@@ -94,11 +292,17 @@ SpdmGetSessionInfoViaSessionId (
   SpdmContext = Context;
 
   SessionInfo = SpdmContext->SessionInfo;
-  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
-    if (SessionInfo[Index].SessionId == SessionId) {
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  if (SpdmSessionHashTableFind (SpdmContext, SessionId, &Index)) {
+    return &SessionInfo[SpdmContext->SessionHashTable[Index] - 1];
+  }
+#else
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SpdmContext->SessionIdList[Index] == SessionId) {
       return &SessionInfo[Index];
     }
   }
+#endif
 
   DEBUG ((DEBUG_ERROR, "SpdmGetSessionInfoViaSessionId - not found SessionId\n"));
   return NULL;
@@ -182,21 +386,36 @@ SpdmAssignSessionId (
 
   SessionInfo = SpdmContext->SessionInfo;
 
-  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
-    if (SessionInfo[Index].SessionId == SessionId) {
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  if (SpdmSessionHashTableFind (SpdmContext, SessionId, &Index)) {
+    DEBUG ((DEBUG_ERROR, "SpdmAssignSessionId - Duplicated SessionId\n"));
+    ASSERT(FALSE);
+    return NULL;
+  }
+
+  if (SpdmContext->SessionFreeHead != 0) {
+    Index = SpdmContext->SessionFreeHead - 1;
+    SpdmSessionInfoInit (SpdmContext, &SessionInfo[Index], SessionId, UsePsk);
+    SpdmContext->LatestSessionId = SessionId;
+    return &SessionInfo[Index];
+  }
+#else
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SpdmContext->SessionIdList[Index] == SessionId) {
       DEBUG ((DEBUG_ERROR, "SpdmAssignSessionId - Duplicated SessionId\n"));
       ASSERT(FALSE);
       return NULL;
     }
   }
 
-  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
-    if (SessionInfo[Index].SessionId == INVALID_SESSION_ID) {
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SpdmContext->SessionIdList[Index] == INVALID_SESSION_ID) {
       SpdmSessionInfoInit (SpdmContext, &SessionInfo[Index], SessionId, UsePsk);
       SpdmContext->LatestSessionId = SessionId;
       return &SessionInfo[Index];
     }
   }
+#endif
 
   DEBUG ((DEBUG_ERROR, "SpdmAssignSessionId - MAX SessionId\n"));
   return NULL;
@@ -215,16 +434,25 @@ SpdmAllocateReqSessionId (
   )
 {
   UINT16                     ReqSessionId;
-  SPDM_SESSION_INFO          *SessionInfo;
   UINTN                      Index;
 
-  SessionInfo = SpdmContext->SessionInfo;
-  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
-    if ((SessionInfo[Index].SessionId & 0xFFFF0000) == (INVALID_SESSION_ID & 0xFFFF0000)) {
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  //
+  // SpdmAssignSessionId takes the head of the free list, so the half session ID follows it.
+  //
+  if (SpdmContext->SessionFreeHead != 0) {
+    Index = SpdmContext->SessionFreeHead - 1;
+    ReqSessionId = (UINT16)(0xFFFF - Index);
+    return ReqSessionId;
+  }
+#else
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if ((SpdmContext->SessionIdList[Index] & 0xFFFF0000) == (INVALID_SESSION_ID & 0xFFFF0000)) {
       ReqSessionId = (UINT16)(0xFFFF - Index);
       return ReqSessionId;
     }
   }
+#endif
 
   DEBUG ((DEBUG_ERROR, "SpdmAllocateReqSessionId - MAX SessionId\n"));
   return (INVALID_SESSION_ID & 0xFFFF0000) >> 16;
@@ -243,16 +471,25 @@ SpdmAllocateRspSessionId (
   )
 {
   UINT16                     RspSessionId;
-  SPDM_SESSION_INFO          *SessionInfo;
   UINTN                      Index;
 
-  SessionInfo = SpdmContext->SessionInfo;
-  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
-    if ((SessionInfo[Index].SessionId & 0xFFFF) == (INVALID_SESSION_ID & 0xFFFF)) {
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  //
+  // SpdmAssignSessionId takes the head of the free list, so the half session ID follows it.
+  //
+  if (SpdmContext->SessionFreeHead != 0) {
+    Index = SpdmContext->SessionFreeHead - 1;
+    RspSessionId = (UINT16)(0xFFFF - Index);
+    return RspSessionId;
+  }
+#else
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if ((SpdmContext->SessionIdList[Index] & 0xFFFF) == (INVALID_SESSION_ID & 0xFFFF)) {
       RspSessionId = (UINT16)(0xFFFF - Index);
       return RspSessionId;
     }
   }
+#endif
 
   DEBUG ((DEBUG_ERROR, "SpdmAllocateRspSessionId - MAX SessionId\n"));
   return (INVALID_SESSION_ID & 0xFFFF);
@@ -286,12 +523,20 @@ SpdmFreeSessionId (
   }
 
   SessionInfo = SpdmContext->SessionInfo;
-  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
-    if (SessionInfo[Index].SessionId == SessionId) {
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  if (SpdmSessionHashTableFind (SpdmContext, SessionId, &Index)) {
+    Index = SpdmContext->SessionHashTable[Index] - 1;
+    SpdmSessionInfoInit (SpdmContext, &SessionInfo[Index], INVALID_SESSION_ID, FALSE);
+    return &SessionInfo[Index];
+  }
+#else
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SpdmContext->SessionIdList[Index] == SessionId) {
       SpdmSessionInfoInit (SpdmContext, &SessionInfo[Index], INVALID_SESSION_ID, FALSE);
       return &SessionInfo[Index];
     }
   }
+#endif
 
   DEBUG ((DEBUG_ERROR, "SpdmFreeSessionId - MAX SessionId\n"));
   ASSERT(FALSE);
@@ -46,6 +46,9 @@ SpdmGetPeerCertChainBuffer (
 /**
   This function returns peer certificate chain data without SPDM_CERT_CHAIN header.
 
+  If no peer certificate chain is available, the provisioned peer public key is returned,
+  so that the transcript covers the public key in place of the certificate chain data.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  CertChainData                Certitiface chain data without SPDM_CERT_CHAIN header.
   @param  CertChainDataSize            Size in bytes of the certitiface chain data.
@@ -69,6 +72,11 @@ SpdmGetPeerCertChainData (
 
   Result = SpdmGetPeerCertChainBuffer (SpdmContext, CertChainData, CertChainDataSize);
   if (!Result) {
+    if (SpdmContext->LocalContext.PeerPublicKeyProvisionSize != 0) {
+      *CertChainData = SpdmContext->LocalContext.PeerPublicKeyProvision;
+      *CertChainDataSize = SpdmContext->LocalContext.PeerPublicKeyProvisionSize;
+      return TRUE;
+    }
     return FALSE;
   }
 
@@ -111,6 +119,9 @@ SpdmGetLocalCertChainBuffer (
 /**
   This function returns local used certificate chain data without SPDM_CERT_CHAIN header.
 
+  If no local certificate chain is used, the provisioned local public key is returned,
+  so that the transcript covers the public key in place of the certificate chain data.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  CertChainData                Certitiface chain data without SPDM_CERT_CHAIN header.
   @param  CertChainDataSize            Size in bytes of the certitiface chain data.
@@ -134,6 +145,11 @@ SpdmGetLocalCertChainData (
 
   Result = SpdmGetLocalCertChainBuffer (SpdmContext, CertChainData, CertChainDataSize);
   if (!Result) {
+    if (SpdmContext->LocalContext.LocalPublicKeyProvisionSize != 0) {
+      *CertChainData = SpdmContext->LocalContext.LocalPublicKeyProvision;
+      *CertChainDataSize = SpdmContext->LocalContext.LocalPublicKeyProvisionSize;
+      return TRUE;
+    }
     return FALSE;
   }
 
@@ -167,108 +183,295 @@ SpdmCalculateM1M2 (
   RETURN_STATUS                 Status;
   UINT32                        HashSize;
   UINT8                         HashData[MAX_HASH_SIZE];
-  LARGE_MANAGED_BUFFER          M1M2;
+  UINTN                         M1M2Size;
 
   SpdmContext = Context;
 
-  InitManagedBuffer (&M1M2, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  M1M2Size = 0;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
 
   if (IsMut) {
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
 
-    DEBUG((DEBUG_INFO, "MessageMutB Data :\n"));
-    InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageMutB), GetManagedBufferSize(&SpdmContext->Transcript.MessageMutB));
-    Status = AppendManagedBuffer (&M1M2, GetManagedBuffer(&SpdmContext->Transcript.MessageMutB), GetManagedBufferSize(&SpdmContext->Transcript.MessageMutB));
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "MessageMutB Data :\n"));
+      InternalDumpManagedBuffer (&SpdmContext->Transcript.MessageMutB);
+    }
+    Status = AppendBufferManagedBufferData (M1M2Buffer, *M1M2BufferSize, &M1M2Size, &SpdmContext->Transcript.MessageMutB);
     if (RETURN_ERROR(Status)) {
       return FALSE;
     }
 
-    DEBUG((DEBUG_INFO, "MessageMutC Data :\n"));
-    InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageMutC), GetManagedBufferSize(&SpdmContext->Transcript.MessageMutC));
-    Status = AppendManagedBuffer (&M1M2, GetManagedBuffer(&SpdmContext->Transcript.MessageMutC), GetManagedBufferSize(&SpdmContext->Transcript.MessageMutC));
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "MessageMutC Data :\n"));
+      InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageMutC), GetManagedBufferSize(&SpdmContext->Transcript.MessageMutC));
+    }
+    Status = AppendBufferManagedBufferData (M1M2Buffer, *M1M2BufferSize, &M1M2Size, &SpdmContext->Transcript.MessageMutC);
     if (RETURN_ERROR(Status)) {
       return FALSE;
     }
 
-    // debug only
-    SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, GetManagedBuffer(&M1M2), GetManagedBufferSize(&M1M2), HashData);
-    DEBUG((DEBUG_INFO, "M1M2 Mut Hash - "));
-    InternalDumpData (HashData, HashSize);
-    DEBUG((DEBUG_INFO, "\n"));
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, M1M2Buffer, M1M2Size, HashData);
+      DEBUG((DEBUG_INFO, "M1M2 Mut Hash - "));
+      InternalDumpData (HashData, HashSize);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
+#else
+    return FALSE;
+#endif
 
   } else {
 
-    DEBUG((DEBUG_INFO, "MessageA Data :\n"));
-    InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageA), GetManagedBufferSize(&SpdmContext->Transcript.MessageA));
-    Status = AppendManagedBuffer (&M1M2, GetManagedBuffer(&SpdmContext->Transcript.MessageA), GetManagedBufferSize(&SpdmContext->Transcript.MessageA));
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "MessageA Data :\n"));
+      InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageA), GetManagedBufferSize(&SpdmContext->Transcript.MessageA));
+    }
+    Status = AppendBufferManagedBufferData (M1M2Buffer, *M1M2BufferSize, &M1M2Size, &SpdmContext->Transcript.MessageA);
     if (RETURN_ERROR(Status)) {
       return FALSE;
     }
 
-    DEBUG((DEBUG_INFO, "MessageB Data :\n"));
-    InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageB), GetManagedBufferSize(&SpdmContext->Transcript.MessageB));
-    Status = AppendManagedBuffer (&M1M2, GetManagedBuffer(&SpdmContext->Transcript.MessageB), GetManagedBufferSize(&SpdmContext->Transcript.MessageB));
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "MessageB Data :\n"));
+      InternalDumpManagedBuffer (&SpdmContext->Transcript.MessageB);
+    }
+    Status = AppendBufferManagedBufferData (M1M2Buffer, *M1M2BufferSize, &M1M2Size, &SpdmContext->Transcript.MessageB);
     if (RETURN_ERROR(Status)) {
       return FALSE;
     }
 
-    DEBUG((DEBUG_INFO, "MessageC Data :\n"));
-    InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageC), GetManagedBufferSize(&SpdmContext->Transcript.MessageC));
-    Status = AppendManagedBuffer (&M1M2, GetManagedBuffer(&SpdmContext->Transcript.MessageC), GetManagedBufferSize(&SpdmContext->Transcript.MessageC));
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "MessageC Data :\n"));
+      InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageC), GetManagedBufferSize(&SpdmContext->Transcript.MessageC));
+    }
+    Status = AppendBufferManagedBufferData (M1M2Buffer, *M1M2BufferSize, &M1M2Size, &SpdmContext->Transcript.MessageC);
     if (RETURN_ERROR(Status)) {
       return FALSE;
     }
 
-    // debug only
-    SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, GetManagedBuffer(&M1M2), GetManagedBufferSize(&M1M2), HashData);
-    DEBUG((DEBUG_INFO, "M1M2 Hash - "));
-    InternalDumpData (HashData, HashSize);
-    DEBUG((DEBUG_INFO, "\n"));
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, M1M2Buffer, M1M2Size, HashData);
+      DEBUG((DEBUG_INFO, "M1M2 Hash - "));
+      InternalDumpData (HashData, HashSize);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
+  }
+
+  *M1M2BufferSize = M1M2Size;
+
+  return TRUE;
+}
+
+/**
+  Continue a hash with the data of a managed buffer.
+
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  HashContext                  The hash context.
+  @param  ManagedBuffer                The managed buffer.
+
+  @retval TRUE   The hash is continued.
+  @retval FALSE  The hash cannot be continued.
+**/
+BOOLEAN
+SpdmHashUpdateManagedBuffer (
+  IN     UINT32                    BaseHashAlgo,
+  IN OUT VOID                      *HashContext,
+  IN     VOID                      *ManagedBuffer
+  )
+{
+  VOID                          *Segment;
+  UINTN                         SegmentSize;
+  UINTN                         Offset;
+
+  Offset = 0;
+  while ((Segment = GetManagedBufferSegment (ManagedBuffer, Offset, &SegmentSize)) != NULL) {
+    if (!SpdmHashUpdate (BaseHashAlgo, HashContext, Segment, SegmentSize)) {
+      return FALSE;
+    }
+    Offset += SegmentSize;
+  }
+  return TRUE;
+}
+
+/*
+  This function calculates M1M2 hash from the cached messages, without concatenating M1M2.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsMut                        Indicate if this is from mutual authentication.
+  @param  M1M2HashData                 The buffer to store the M1M2 hash.
+
+  @retval TRUE  M1M2 hash is calculated.
+  @retval FALSE M1M2 hash cannot be calculated.
+*/
+BOOLEAN
+SpdmCalculateM1M2Hash (
+  IN     SPDM_DEVICE_CONTEXT    *SpdmContext,
+  IN     BOOLEAN                IsMut,
+     OUT UINT8                  *M1M2HashData
+  )
+{
+  UINT32                        BaseHashAlgo;
+  VOID                          *HashContext;
+  BOOLEAN                       Result;
+  UINT32                        HashSize;
+
+  BaseHashAlgo = SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo;
+  HashContext = SpdmHashNew (BaseHashAlgo);
+  if (HashContext == NULL) {
+    return FALSE;
+  }
+  if (IsMut) {
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
+    Result = SpdmHashUpdateManagedBuffer (BaseHashAlgo, HashContext, &SpdmContext->Transcript.MessageMutB);
+    if (Result) {
+      Result = SpdmHashUpdateManagedBuffer (BaseHashAlgo, HashContext, &SpdmContext->Transcript.MessageMutC);
+    }
+#else
+    Result = FALSE;
+#endif
+  } else {
+    Result = SpdmHashUpdateMessageA (SpdmContext, BaseHashAlgo, HashContext);
+    if (Result) {
+      Result = SpdmHashUpdateManagedBuffer (BaseHashAlgo, HashContext, &SpdmContext->Transcript.MessageB);
+    }
+    if (Result) {
+      Result = SpdmHashUpdateManagedBuffer (BaseHashAlgo, HashContext, &SpdmContext->Transcript.MessageC);
+    }
+  }
+  if (Result) {
+    Result = SpdmHashFinal (BaseHashAlgo, HashContext, M1M2HashData);
+  }
+  SpdmHashFree (BaseHashAlgo, HashContext);
+  if (!Result) {
+    return FALSE;
   }
 
-  *M1M2BufferSize = GetManagedBufferSize(&M1M2);
-  CopyMem (M1M2Buffer, GetManagedBuffer(&M1M2), *M1M2BufferSize);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
+    DEBUG((DEBUG_INFO, IsMut ? "M1M2 Mut Hash - " : "M1M2 Hash - "));
+    InternalDumpData (M1M2HashData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   return TRUE;
 }
 
 /*
-  This function calculates L1L2.
+  This function calculates L1L2 hash from the running hash of Message M.
+
+  Message M is consumed and reset.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  L1L2BufferSize               Size in bytes of the L1L2
-  @param  L1L2Buffer                   The buffer to store the L1L2
+  @param  L1L2HashData                 The buffer to store the L1L2 hash.
 
-  @retval RETURN_SUCCESS  L1L2 is calculated.
+  @retval TRUE  L1L2 hash is calculated.
+  @retval FALSE L1L2 hash cannot be calculated.
 */
 BOOLEAN
 EFIAPI
-SpdmCalculateL1L2 (
+SpdmCalculateL1L2Hash (
   IN     VOID                   *Context,
-  IN OUT UINTN                  *L1L2BufferSize,
-     OUT VOID                   *L1L2Buffer
+     OUT UINT8                  *L1L2HashData
   )
 {
   SPDM_DEVICE_CONTEXT           *SpdmContext;
+  SPDM_MESSAGE_DIGEST           *MessageM;
   UINT32                        HashSize;
-  UINT8                         HashData[MAX_HASH_SIZE];
+  BOOLEAN                       Result;
 
   SpdmContext = Context;
+  MessageM = &SpdmContext->Transcript.MessageM;
 
-  HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
+  if ((MessageM->HashContext == NULL) ||
+      (MessageM->BaseHashAlgo != SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo)) {
+    SpdmResetMessageM (SpdmContext);
+    return FALSE;
+  }
+
+  HashSize = GetSpdmHashSize (MessageM->BaseHashAlgo);
+
+  Result = SpdmHashUpdate (MessageM->BaseHashAlgo, MessageM->HashContext, MessageM->PendingBuffer, MessageM->PendingBufferSize);
+  if (Result) {
+    Result = SpdmHashFinal (MessageM->BaseHashAlgo, MessageM->HashContext, L1L2HashData);
+  }
+  DEBUG((DEBUG_INFO, "MessageM Size - 0x%x\n", (UINT32)MessageM->BufferSize));
+  SpdmResetMessageM (SpdmContext);
+  if (!Result) {
+    return FALSE;
+  }
+
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "L1L2 Hash - "));
+    InternalDumpData (L1L2HashData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
+
+  return TRUE;
+}
+
+/*
+  This function calculates the M2 hash of the requester from the running hash of Message B and Message C.
+
+  The running hash of Message B is not consumed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  M2HashData                   The buffer to store the M2 hash.
+
+  @retval TRUE  M2 hash is calculated.
+  @retval FALSE M2 hash cannot be calculated.
+*/
+BOOLEAN
+SpdmCalculateM2Hash (
+  IN     SPDM_DEVICE_CONTEXT    *SpdmContext,
+     OUT UINT8                  *M2HashData
+  )
+{
+  SPDM_MESSAGE_DIGEST           *MessageB;
+  UINT32                        BaseHashAlgo;
+  VOID                          *HashContext;
+  BOOLEAN                       Result;
 
-  DEBUG((DEBUG_INFO, "MessageM Data :\n"));
-  InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageM), GetManagedBufferSize(&SpdmContext->Transcript.MessageM));
+  MessageB = &SpdmContext->Transcript.MessageBDigest;
+  BaseHashAlgo = SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo;
 
-  // debug only
-  SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, GetManagedBuffer(&SpdmContext->Transcript.MessageM), GetManagedBufferSize(&SpdmContext->Transcript.MessageM), HashData);
-  DEBUG((DEBUG_INFO, "L1L2 Hash - "));
-  InternalDumpData (HashData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  //
+  // M2 = Concatenate (A, B, C). Without any message in B, the running hash is not started.
+  //
+  if ((MessageB->BufferSize != 0) &&
+      ((MessageB->HashContext == NULL) || (MessageB->BaseHashAlgo != BaseHashAlgo))) {
+    return FALSE;
+  }
+  HashContext = SpdmHashNew (BaseHashAlgo);
+  if (HashContext == NULL) {
+    return FALSE;
+  }
+  if (MessageB->BufferSize != 0) {
+    Result = SpdmHashDuplicate (BaseHashAlgo, MessageB->HashContext, HashContext);
+    if (Result) {
+      Result = SpdmHashUpdate (BaseHashAlgo, HashContext, MessageB->PendingBuffer, MessageB->PendingBufferSize);
+    }
+  } else {
+    Result = SpdmHashUpdateMessageA (SpdmContext, BaseHashAlgo, HashContext);
+  }
+  if (Result) {
+    Result = SpdmHashUpdate (BaseHashAlgo, HashContext, GetManagedBuffer(&SpdmContext->Transcript.MessageC), GetManagedBufferSize(&SpdmContext->Transcript.MessageC));
+  }
+  if (Result) {
+    Result = SpdmHashFinal (BaseHashAlgo, HashContext, M2HashData);
+  }
+  SpdmHashFree (BaseHashAlgo, HashContext);
+  DEBUG((DEBUG_INFO, "MessageB Size - 0x%x\n", (UINT32)MessageB->BufferSize));
+  if (!Result) {
+    return FALSE;
+  }
 
-  *L1L2BufferSize = GetManagedBufferSize(&SpdmContext->Transcript.MessageM);
-  CopyMem (L1L2Buffer, GetManagedBuffer(&SpdmContext->Transcript.MessageM), *L1L2BufferSize);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "M1M2 Hash - "));
+    InternalDumpData (M2HashData, GetSpdmHashSize (BaseHashAlgo));
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   return TRUE;
 }
@@ -290,11 +493,114 @@ SpdmGenerateCertChainHash (
      OUT UINT8                        *Hash
   )
 {
+  SPDM_LOCAL_CERT_CHAIN_DIGEST  *Digest;
+
   ASSERT (SlotIndex < SpdmContext->LocalContext.SlotCount);
-  SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, SpdmContext->LocalContext.LocalCertChainProvision[SlotIndex], SpdmContext->LocalContext.LocalCertChainProvisionSize[SlotIndex], Hash);
+  if (SpdmDeviceProfileGetCertChainDigest (SpdmContext, SlotIndex, Hash)) {
+    return TRUE;
+  }
+  Digest = SpdmGetLocalCertChainDigest (SpdmContext, SlotIndex);
+  if (Digest == NULL) {
+    return FALSE;
+  }
+  CopyMem (Hash, Digest->CertChainHash, GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo));
   return TRUE;
 }
 
+/**
+  Return the digests of a local certificate chain for the negotiated BaseHashAlgo.
+
+  They are computed once per provisioned certificate chain, and cached in the SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotIndex                    The slot index of the certificate chain.
+
+  @return the digests of the local certificate chain, or NULL if the slot has no certificate chain
+          or the negotiated BaseHashAlgo is not supported.
+**/
+SPDM_LOCAL_CERT_CHAIN_DIGEST *
+SpdmGetLocalCertChainDigest (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     UINTN                        SlotIndex
+  )
+{
+  SPDM_LOCAL_CERT_CHAIN_DIGEST  *Digest;
+  UINT8                         *CertChain;
+  UINTN                         CertChainSize;
+  UINT32                        BaseHashAlgo;
+  UINTN                         HeaderSize;
+
+  CertChain = SpdmContext->LocalContext.LocalCertChainProvision[SlotIndex];
+  CertChainSize = SpdmContext->LocalContext.LocalCertChainProvisionSize[SlotIndex];
+  if (CertChain == NULL) {
+    return NULL;
+  }
+  BaseHashAlgo = SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo;
+  Digest = &SpdmContext->LocalCertChainDigest[SlotIndex];
+  if ((Digest->BaseHashAlgo == BaseHashAlgo) &&
+      (Digest->CertChain == CertChain) &&
+      (Digest->CertChainSize == CertChainSize)) {
+    return Digest;
+  }
+
+  ZeroMem (Digest, sizeof(SPDM_LOCAL_CERT_CHAIN_DIGEST));
+  if (!SpdmHashAll (BaseHashAlgo, CertChain, CertChainSize, Digest->CertChainHash)) {
+    return NULL;
+  }
+  HeaderSize = sizeof(SPDM_CERT_CHAIN) + GetSpdmHashSize (BaseHashAlgo);
+  if ((CertChainSize > HeaderSize) &&
+      !SpdmHashAll (BaseHashAlgo, CertChain + HeaderSize, CertChainSize - HeaderSize, Digest->CertChainDataHash)) {
+    return NULL;
+  }
+  Digest->BaseHashAlgo = BaseHashAlgo;
+  Digest->CertChain = CertChain;
+  Digest->CertChainSize = CertChainSize;
+  return Digest;
+}
+
+/**
+  Hash the certificate chain data of Ct.
+
+  The hash of a local certificate chain is taken from the digests cached in the SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CertChainData                Certitiface chain data without SPDM_CERT_CHAIN header.
+  @param  CertChainDataSize            Size in bytes of the certitiface chain data.
+  @param  Hash                         The buffer to store the hash.
+
+  @retval TRUE  the hash is calculated.
+  @retval FALSE the negotiated BaseHashAlgo is not supported.
+**/
+BOOLEAN
+SpdmHashCertChainData (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     UINT8                        *CertChainData,
+  IN     UINTN                        CertChainDataSize,
+     OUT UINT8                        *Hash
+  )
+{
+  SPDM_LOCAL_CERT_CHAIN_DIGEST  *Digest;
+  UINT8                         *CertChain;
+  UINTN                         HeaderSize;
+  UINTN                         SlotIndex;
+
+  HeaderSize = sizeof(SPDM_CERT_CHAIN) + GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
+  for (SlotIndex = 0; SlotIndex < SpdmContext->LocalContext.SlotCount; SlotIndex++) {
+    CertChain = SpdmContext->LocalContext.LocalCertChainProvision[SlotIndex];
+    if ((CertChain != NULL) &&
+        (CertChainData == CertChain + HeaderSize) &&
+        (CertChainDataSize + HeaderSize == SpdmContext->LocalContext.LocalCertChainProvisionSize[SlotIndex])) {
+      Digest = SpdmGetLocalCertChainDigest (SpdmContext, SlotIndex);
+      if (Digest == NULL) {
+        return FALSE;
+      }
+      CopyMem (Hash, Digest->CertChainDataHash, GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo));
+      return TRUE;
+    }
+  }
+  return SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, CertChainData, CertChainDataSize, Hash);
+}
+
 /**
   This function verifies the digest.
 
@@ -334,6 +640,83 @@ SpdmVerifyPeerDigests (
   return TRUE;
 }
 
+/**
+  This function records the peer certificate chain digests of a DIGESTS response.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotMask                     The slot mask of the DIGESTS response.
+  @param  Digest                       The digest data buffer, one digest per bit set in SlotMask.
+  @param  DigestSize                   Size in bytes of the digest data buffer.
+**/
+VOID
+SpdmRecordPeerDigests (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN UINT8                        SlotMask,
+  IN VOID                         *Digest,
+  IN UINTN                        DigestSize
+  )
+{
+  SpdmContext->ConnectionInfo.PeerDigestSlotMask = 0;
+  if (DigestSize > sizeof(SpdmContext->ConnectionInfo.PeerDigestBuffer)) {
+    return;
+  }
+  CopyMem (SpdmContext->ConnectionInfo.PeerDigestBuffer, Digest, DigestSize);
+  SpdmContext->ConnectionInfo.PeerDigestSlotMask = SlotMask;
+}
+
+/**
+  This function gets the peer certificate chain of a slot from the certificate chain verification cache,
+  if the recorded digest of the slot matches a cached certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  CertChainBuffer              A pointer to a destination buffer to store the certificate chain.
+  @param  CertChainBufferSize          On input, indicate the size in bytes of the destination buffer.
+                                       On output, indicate the size in bytes of the certificate chain.
+
+  @retval TRUE  The certificate chain is got from the cache.
+  @retval FALSE No digest is recorded for the slot, or the digest does not match a cached certificate chain.
+**/
+BOOLEAN
+SpdmGetPeerCertChainFromCache (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     UINT8                        SlotNum,
+     OUT VOID                         *CertChainBuffer,
+  IN OUT UINTN                        *CertChainBufferSize
+  )
+{
+  UINT8                                     SlotMask;
+  UINTN                                     DigestIndex;
+  UINTN                                     Index;
+  UINT32                                    BaseHashAlgo;
+
+  if (SpdmContext->CertChainCache == NULL) {
+    return FALSE;
+  }
+  SlotMask = SpdmContext->ConnectionInfo.PeerDigestSlotMask;
+  if ((SlotNum >= MAX_SPDM_SLOT_COUNT) || ((SlotMask & (1 << SlotNum)) == 0)) {
+    return FALSE;
+  }
+  //
+  // The digests are packed in the order of the slot mask bits.
+  //
+  DigestIndex = 0;
+  for (Index = 0; Index < SlotNum; Index++) {
+    if ((SlotMask & (1 << Index)) != 0) {
+      DigestIndex++;
+    }
+  }
+
+  BaseHashAlgo = SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo;
+  return SpdmCertChainCacheGetCertChain (
+           SpdmContext->CertChainCache,
+           BaseHashAlgo,
+           SpdmContext->ConnectionInfo.PeerDigestBuffer + GetSpdmHashSize (BaseHashAlgo) * DigestIndex,
+           CertChainBuffer,
+           CertChainBufferSize
+           );
+}
+
 /**
   This function verifies peer certificate chain buffer including SPDM_CERT_CHAIN header.
 
@@ -357,10 +740,32 @@ SpdmVerifyPeerCertChainBuffer (
   UINT8                                     *RootCertHash;
   UINTN                                     RootCertHashSize;
   BOOLEAN                                   Result;
+  UINT32                                    BaseHashAlgo;
+  UINT8                                     CertChainHash[MAX_HASH_SIZE];
+  UINT8                                     LeafCertHash[MAX_HASH_SIZE];
+  SPDM_CERT_CHAIN_VIEW                      View;
 
-  Result = SpdmVerifyCertificateChainBuffer (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, CertChainBuffer, CertChainBufferSize);
+  //
+  // A new peer certificate chain replaces the key parsed from the previous one.
+  //
+  SpdmResetPeerPublicKey (SpdmContext);
+
+  BaseHashAlgo = SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo;
+  Result = FALSE;
+  if (SpdmContext->CertChainCache != NULL) {
+    if (!SpdmHashAll (BaseHashAlgo, CertChainBuffer, CertChainBufferSize, CertChainHash)) {
+      return FALSE;
+    }
+    Result = SpdmCertChainCacheLookup (SpdmContext->CertChainCache, BaseHashAlgo, CertChainHash);
+    if (Result) {
+      DEBUG((DEBUG_INFO, "!!! VerifyPeerCertChainBuffer - cache hit !!!\n"));
+    }
+  }
   if (!Result) {
-    return FALSE;
+    Result = SpdmVerifyCertificateChainBuffer (BaseHashAlgo, CertChainBuffer, CertChainBufferSize);
+    if (!Result) {
+      return FALSE;
+    }
   }
 
   RootCertHash = SpdmContext->LocalContext.PeerRootCertHashProvision;
@@ -389,97 +794,659 @@ SpdmVerifyPeerCertChainBuffer (
     }
   }
 
+  if (SpdmContext->CertChainCache != NULL) {
+    HashSize = GetSpdmHashSize (BaseHashAlgo);
+    Result = SpdmCertChainViewInit (
+               &View,
+               (UINT8 *)CertChainBuffer + sizeof(SPDM_CERT_CHAIN) + HashSize,
+               CertChainBufferSize - (sizeof(SPDM_CERT_CHAIN) + HashSize)
+               );
+    if (Result) {
+      Result = SpdmHashAll (BaseHashAlgo, View.Leaf.Cert, View.Leaf.CertSize, LeafCertHash);
+    }
+    if (Result) {
+      //
+      // The SubjectPublicKeyInfo is the portable form of the leaf public key, for a shared cache.
+      //
+      if (!SpdmX509CertViewParseFields (&View.Leaf)) {
+        View.Leaf.SubjectPublicKeyInfo = NULL;
+        View.Leaf.SubjectPublicKeyInfoSize = 0;
+      }
+      SpdmContext->ConnectionInfo.PeerCertChainCacheEntry = SpdmCertChainCacheAcquire (
+                                                              SpdmContext->CertChainCache,
+                                                              BaseHashAlgo,
+                                                              CertChainHash,
+                                                              LeafCertHash,
+                                                              CertChainBuffer,
+                                                              CertChainBufferSize,
+                                                              View.Leaf.SubjectPublicKeyInfo,
+                                                              View.Leaf.SubjectPublicKeyInfoSize
+                                                              );
+    }
+  }
+
   DEBUG((DEBUG_INFO, "!!! VerifyPeerCertChainBuffer - PASS !!!\n"));
 
   return TRUE;
 }
 
 /**
-  This function generates the challenge signature based upon M1M2 for authentication.
+  This function collects a portion of the peer certificate chain got by GET_CERTIFICATE.
+
+  The portions are written in place in PeerUsedCertChainBuffer, at PeerCertChainCollectedSize.
+  The first portion invalidates the previous peer certificate chain.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  IsRequester                  Indicate of the signature generation for a requester or a responder.
-  @param  Signature                    The buffer to store the challenge signature.
+  @param  Portion                      A pointer to the portion of the certificate chain.
+  @param  PortionSize                  Size in bytes of the portion of the certificate chain.
 
-  @retval TRUE  challenge signature is generated.
-  @retval FALSE challenge signature is not generated.
+  @retval RETURN_SUCCESS               The portion is collected.
+  @retval RETURN_SECURITY_VIOLATION    The certificate chain is larger than PeerUsedCertChainBuffer.
 **/
-BOOLEAN
-SpdmGenerateChallengeAuthSignature (
-  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
-  IN     BOOLEAN                    IsRequester,
-     OUT UINT8                      *Signature
+RETURN_STATUS
+SpdmCollectPeerCertChain (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN VOID                         *Portion,
+  IN UINTN                        PortionSize
   )
 {
-  BOOLEAN                       Result;
-  UINTN                         SignatureSize;
-  UINT8                         M1M2Buffer[MAX_SPDM_MESSAGE_BUFFER_SIZE];
-  UINTN                         M1M2BufferSize;
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
 
-  M1M2BufferSize = sizeof(M1M2Buffer);
-  Result = SpdmCalculateM1M2 (SpdmContext, IsRequester, &M1M2BufferSize, &M1M2Buffer);
-  if (!Result) {
-    return FALSE;
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+  if (ConnectionInfo->PeerCertChainCollectedSize == 0) {
+    SpdmResetPeerPublicKey (SpdmContext);
+    ConnectionInfo->PeerUsedCertChainBufferSize = 0;
   }
-
-  if (IsRequester) {
-    SignatureSize = GetSpdmReqAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg);
-    Result = SpdmRequesterDataSignFunc (
-              SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
-              SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
-              M1M2Buffer,
-              M1M2BufferSize,
-              Signature,
-              &SignatureSize
-              );
-  } else {
-    SignatureSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
-    Result = SpdmResponderDataSignFunc (
-              SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
-              SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
-              M1M2Buffer,
-              M1M2BufferSize,
-              Signature,
-              &SignatureSize
-              );
+  if (PortionSize > ConnectionInfo->MaxPeerUsedCertChainBufferSize - ConnectionInfo->PeerCertChainCollectedSize) {
+    DEBUG((DEBUG_INFO, "!!! CollectPeerCertChain - FAIL (buffer too small) !!!\n"));
+    return RETURN_SECURITY_VIOLATION;
   }
-
-  return Result;
+  CopyMem (ConnectionInfo->PeerUsedCertChainBuffer + ConnectionInfo->PeerCertChainCollectedSize, Portion, PortionSize);
+  ConnectionInfo->PeerCertChainCollectedSize += PortionSize;
+  return RETURN_SUCCESS;
 }
 
 /**
-  This function verifies the certificate chain hash.
+  This function verifies the peer certificate chain collected in PeerUsedCertChainBuffer,
+  and makes it the peer certificate chain of the connection.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  CertificateChainHash         The certificate chain hash data buffer.
-  @param  CertificateChainHashSize     Size in bytes of the certificate chain hash data buffer.
 
-  @retval TRUE  hash verification pass.
-  @retval FALSE hash verification fail.
+  @retval TRUE  The collected certificate chain is verified.
+  @retval FALSE The collected certificate chain verification failed.
 **/
 BOOLEAN
-SpdmVerifyCertificateChainHash (
-  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
-  IN VOID                         *CertificateChainHash,
-  IN UINTN                        CertificateChainHashSize
+SpdmCompleteCollectPeerCertChain (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext
   )
 {
-  UINTN                                     HashSize;
-  UINT8                                     CertChainBufferHash[MAX_HASH_SIZE];
-  UINT8                                     *CertChainBuffer;
-  UINTN                                     CertChainBufferSize;
-  BOOLEAN                                   Result;
-
-  Result = SpdmGetPeerCertChainBuffer (SpdmContext, (VOID **)&CertChainBuffer, &CertChainBufferSize);
-  if (!Result) {
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
+  UINTN                                     CollectedSize;
+
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+  CollectedSize = ConnectionInfo->PeerCertChainCollectedSize;
+  ConnectionInfo->PeerCertChainCollectedSize = 0;
+  ConnectionInfo->PeerUsedCertChainBufferSize = 0;
+  if (!SpdmVerifyPeerCertChainBuffer (SpdmContext, ConnectionInfo->PeerUsedCertChainBuffer, CollectedSize)) {
     return FALSE;
   }
+  ConnectionInfo->PeerUsedCertChainBufferSize = CollectedSize;
+  return TRUE;
+}
 
-  HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
+/**
+  This function releases the cached peer public key.
 
-  SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, CertChainBuffer, CertChainBufferSize, CertChainBufferHash);
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmFreePeerPublicKey (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext
+  )
+{
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
 
-  if (HashSize != CertificateChainHashSize) {
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+  if (ConnectionInfo->PeerPreparedPublicKey != NULL) {
+    SpdmAsymFreePreparedPublicKey (ConnectionInfo->PeerPublicKeyAsymAlgo, ConnectionInfo->PeerPreparedPublicKey);
+  }
+  ConnectionInfo->PeerPreparedPublicKey = NULL;
+  ConnectionInfo->PeerPublicKeyVerifyCount = 0;
+  //
+  // A key shared through the certificate chain verification cache is owned by the cache entry.
+  //
+  if ((ConnectionInfo->PeerPublicKey != NULL) && !ConnectionInfo->PeerPublicKeyShared) {
+    if (ConnectionInfo->PeerPublicKeyIsReqAsym) {
+      SpdmReqAsymFree ((UINT16)ConnectionInfo->PeerPublicKeyAsymAlgo, ConnectionInfo->PeerPublicKey);
+    } else {
+      SpdmAsymFree (ConnectionInfo->PeerPublicKeyAsymAlgo, ConnectionInfo->PeerPublicKey);
+    }
+  }
+  ConnectionInfo->PeerPublicKey = NULL;
+  ConnectionInfo->PeerPublicKeyShared = FALSE;
+  ConnectionInfo->PeerPublicKeyIsReqAsym = FALSE;
+  ConnectionInfo->PeerPublicKeyAsymAlgo = 0;
+  ConnectionInfo->PeerPublicKeyHashAlgo = 0;
+  ZeroMem (ConnectionInfo->PeerPublicKeyCertHash, sizeof(ConnectionInfo->PeerPublicKeyCertHash));
+}
+
+/**
+  This function releases the cached peer public key and the certificate chain verification cache entry.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmResetPeerPublicKey (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext
+  )
+{
+  SpdmFreePeerPublicKey (SpdmContext);
+  if (SpdmContext->ConnectionInfo.PeerCertChainCacheEntry != NULL) {
+    SpdmCertChainCacheRelease (SpdmContext->CertChainCache, SpdmContext->ConnectionInfo.PeerCertChainCacheEntry);
+    SpdmContext->ConnectionInfo.PeerCertChainCacheEntry = NULL;
+  }
+}
+
+/**
+  This function returns the public key of the peer leaf certificate.
+
+  The key is parsed from the peer certificate chain on first use and kept in the connection info.
+  It is parsed again only if the leaf certificate or the negotiated algorithm changes.
+  If no peer certificate chain is available, the key is parsed from the provisioned peer public key.
+  If the peer certificate chain is in the certificate chain verification cache, the key is shared with the cache.
+  The caller must not free the returned key.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsRequester                  Indicate of the key for a requester (peer is responder) or a responder (peer is requester).
+  @param  Context                      Pointer to the peer public key context.
+
+  @retval TRUE  The peer public key is returned.
+  @retval FALSE The peer public key cannot be retrieved.
+**/
+BOOLEAN
+SpdmGetPeerPublicKey (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     BOOLEAN                      IsRequester,
+     OUT VOID                         **Context
+  )
+{
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
+  BOOLEAN                                   Result;
+  UINT8                                     *CertChainData;
+  UINTN                                     CertChainDataSize;
+  SPDM_CERT_CHAIN_VIEW                      View;
+  UINT8                                     *CertBuffer;
+  UINTN                                     CertBufferSize;
+  UINT8                                     CertHash[MAX_HASH_SIZE];
+  UINTN                                     HashSize;
+  UINT32                                    AsymAlgo;
+  UINT32                                    HashAlgo;
+  BOOLEAN                                   IsPublicKey;
+
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+  HashAlgo = ConnectionInfo->Algorithm.BaseHashAlgo;
+  if (IsRequester) {
+    AsymAlgo = ConnectionInfo->Algorithm.BaseAsymAlgo;
+  } else {
+    AsymAlgo = ConnectionInfo->Algorithm.ReqBaseAsymAlg;
+  }
+
+  IsPublicKey = !SpdmGetPeerCertChainBuffer (SpdmContext, (VOID **)&CertChainData, &CertChainDataSize);
+  if (IsPublicKey) {
+    //
+    // The provisioned public key is a DER-encoded SubjectPublicKeyInfo, not a certificate.
+    //
+    CertBuffer = SpdmContext->LocalContext.PeerPublicKeyProvision;
+    CertBufferSize = SpdmContext->LocalContext.PeerPublicKeyProvisionSize;
+    if (CertBufferSize == 0) {
+      return FALSE;
+    }
+  } else {
+    Result = SpdmGetPeerCertChainData (SpdmContext, (VOID **)&CertChainData, &CertChainDataSize);
+    if (!Result) {
+      return FALSE;
+    }
+
+    //
+    // Get leaf cert from cert chain
+    //
+    Result = SpdmCertChainViewInit (&View, CertChainData, CertChainDataSize);
+    if (!Result) {
+      return FALSE;
+    }
+    CertBuffer = View.Leaf.Cert;
+    CertBufferSize = View.Leaf.CertSize;
+  }
+
+  HashSize = GetSpdmHashSize (HashAlgo);
+  Result = SpdmHashAll (HashAlgo, CertBuffer, CertBufferSize, CertHash);
+  if (!Result) {
+    return FALSE;
+  }
+
+  if ((ConnectionInfo->PeerPublicKey != NULL) &&
+      (ConnectionInfo->PeerPublicKeyIsReqAsym == !IsRequester) &&
+      (ConnectionInfo->PeerPublicKeyAsymAlgo == AsymAlgo) &&
+      (ConnectionInfo->PeerPublicKeyHashAlgo == HashAlgo) &&
+      (CompareMem (ConnectionInfo->PeerPublicKeyCertHash, CertHash, HashSize) == 0)) {
+    *Context = ConnectionInfo->PeerPublicKey;
+    return TRUE;
+  }
+
+  SpdmFreePeerPublicKey (SpdmContext);
+
+  Result = FALSE;
+  if (!IsPublicKey && (ConnectionInfo->PeerCertChainCacheEntry != NULL)) {
+    Result = SpdmCertChainCacheGetPublicKey (SpdmContext->CertChainCache, ConnectionInfo->PeerCertChainCacheEntry, !IsRequester, AsymAlgo, CertHash, CertBuffer, CertBufferSize, Context);
+  }
+  ConnectionInfo->PeerPublicKeyShared = Result;
+  if (!Result) {
+    if (IsPublicKey) {
+      if (IsRequester) {
+        Result = SpdmAsymGetPublicKeyFromDer (AsymAlgo, CertBuffer, CertBufferSize, Context);
+      } else {
+        Result = SpdmReqAsymGetPublicKeyFromDer ((UINT16)AsymAlgo, CertBuffer, CertBufferSize, Context);
+      }
+    } else if (IsRequester) {
+      Result = SpdmAsymGetPublicKeyFromX509 (AsymAlgo, CertBuffer, CertBufferSize, Context);
+    } else {
+      Result = SpdmReqAsymGetPublicKeyFromX509 ((UINT16)AsymAlgo, CertBuffer, CertBufferSize, Context);
+    }
+    if (!Result) {
+      return FALSE;
+    }
+  }
+
+  ConnectionInfo->PeerPublicKey = *Context;
+  ConnectionInfo->PeerPublicKeyIsReqAsym = !IsRequester;
+  ConnectionInfo->PeerPublicKeyAsymAlgo = AsymAlgo;
+  ConnectionInfo->PeerPublicKeyHashAlgo = HashAlgo;
+  CopyMem (ConnectionInfo->PeerPublicKeyCertHash, CertHash, HashSize);
+  return TRUE;
+}
+
+/**
+  This function verifies a signature of the responder over a message hash with the responder public key.
+
+  The key is prepared for repeated verification once it verifies SPDM_PEER_PUBLIC_KEY_PREPARE_THRESHOLD
+  signatures, and the prepared public key is used until the key is released.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageHash                  The hash of the signed message.
+  @param  SignData                     The signature data buffer.
+  @param  SignDataSize                 Size in bytes of the signature data buffer.
+
+  @retval TRUE  signature verification pass.
+  @retval FALSE signature verification fail.
+**/
+BOOLEAN
+SpdmVerifyResponderSignatureHash (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN CONST UINT8                  *MessageHash,
+  IN CONST VOID                   *SignData,
+  IN UINTN                        SignDataSize
+  )
+{
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
+  BOOLEAN                                   Result;
+  VOID                                      *Context;
+
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+  Result = SpdmGetPeerPublicKey (SpdmContext, TRUE, &Context);
+  if (!Result) {
+    return FALSE;
+  }
+
+  //
+  // The preparation is tried once per key. The algorithms without a prepared public key keep it NULL.
+  //
+  if (ConnectionInfo->PeerPreparedPublicKey == NULL) {
+    ConnectionInfo->PeerPublicKeyVerifyCount++;
+    if (ConnectionInfo->PeerPublicKeyVerifyCount == SPDM_PEER_PUBLIC_KEY_PREPARE_THRESHOLD) {
+      ConnectionInfo->PeerPreparedPublicKey = SpdmAsymPreparePublicKey (ConnectionInfo->Algorithm.BaseAsymAlgo, Context);
+    }
+  }
+
+  if (ConnectionInfo->PeerPreparedPublicKey != NULL) {
+    return SpdmAsymVerifyHashPrepared (
+             ConnectionInfo->Algorithm.BaseAsymAlgo,
+             ConnectionInfo->Algorithm.BaseHashAlgo,
+             ConnectionInfo->PeerPreparedPublicKey,
+             MessageHash,
+             SignData,
+             SignDataSize
+             );
+  }
+  return SpdmAsymVerifyHash (
+           ConnectionInfo->Algorithm.BaseAsymAlgo,
+           ConnectionInfo->Algorithm.BaseHashAlgo,
+           Context,
+           MessageHash,
+           SignData,
+           SignDataSize
+           );
+}
+
+/**
+  This function signs a message with the responder private key.
+
+  If the asynchronous signing functions are registered and the signing is pending,
+  the sign token is recorded in the pending signature of the SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Message                      A pointer to a message to be signed (before hash).
+  @param  MessageSize                  The size in bytes of the message to be signed.
+  @param  Signature                    The buffer to store the signature.
+
+  @retval RETURN_SUCCESS               The signature is generated.
+  @retval RETURN_NOT_READY             The signing is pending.
+  @retval RETURN_DEVICE_ERROR          The signature is not generated.
+**/
+RETURN_STATUS
+SpdmResponderGenerateSignature (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     CONST UINT8                *Message,
+  IN     UINTN                      MessageSize,
+     OUT UINT8                      *Signature
+  )
+{
+  SPDM_RESPONDER_DATA_SIGN_ASYNC_FUNC  SignAsyncFunc;
+  UINTN                                SignatureSize;
+  BOOLEAN                              Result;
+  RETURN_STATUS                        Status;
+
+  SignatureSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
+  if (SpdmContext->ResponderDataSignAsyncFunc == 0) {
+    if ((SpdmContext->LocalContext.LocalPrivateKey != NULL) &&
+        (SpdmContext->LocalContext.LocalPrivateKeyAsymAlgo == SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo)) {
+      Result = SpdmResponderDataSignWithKeyFunc (
+                 SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
+                 SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+                 SpdmContext->LocalContext.LocalPrivateKey,
+                 Message,
+                 MessageSize,
+                 Signature,
+                 &SignatureSize
+                 );
+    } else {
+      Result = SpdmResponderDataSignFunc (
+                 SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
+                 SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+                 Message,
+                 MessageSize,
+                 Signature,
+                 &SignatureSize
+                 );
+    }
+    return Result ? RETURN_SUCCESS : RETURN_DEVICE_ERROR;
+  }
+
+  SignAsyncFunc = (SPDM_RESPONDER_DATA_SIGN_ASYNC_FUNC)SpdmContext->ResponderDataSignAsyncFunc;
+  Status = SignAsyncFunc (
+             SpdmContext,
+             SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
+             SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+             Message,
+             MessageSize,
+             Signature,
+             &SignatureSize,
+             &SpdmContext->PendingSignature.SignToken
+             );
+  if (Status == RETURN_NOT_READY) {
+    return RETURN_NOT_READY;
+  }
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function signs a message hash with the responder private key.
+
+  The signing is always synchronous, because the asynchronous signing functions take the message before hash.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    The buffer to store the signature.
+
+  @retval RETURN_SUCCESS               The signature is generated.
+  @retval RETURN_DEVICE_ERROR          The signature is not generated.
+**/
+RETURN_STATUS
+SpdmResponderGenerateSignatureFromHash (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     CONST UINT8                *MessageHash,
+     OUT UINT8                      *Signature
+  )
+{
+  UINTN                                SignatureSize;
+  BOOLEAN                              Result;
+
+  SignatureSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
+  if ((SpdmContext->LocalContext.LocalPrivateKey != NULL) &&
+      (SpdmContext->LocalContext.LocalPrivateKeyAsymAlgo == SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo)) {
+    Result = SpdmResponderDataSignHashWithKeyFunc (
+               SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
+               SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+               SpdmContext->LocalContext.LocalPrivateKey,
+               MessageHash,
+               Signature,
+               &SignatureSize
+               );
+  } else {
+    Result = SpdmResponderDataSignHashFunc (
+               SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
+               SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+               MessageHash,
+               Signature,
+               &SignatureSize
+               );
+  }
+  return Result ? RETURN_SUCCESS : RETURN_DEVICE_ERROR;
+}
+
+/**
+  This function signs a message with the requester private key.
+
+  The registered requester private key handle is used if it matches the negotiated algorithm.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Message                      A pointer to a message to be signed (before hash).
+  @param  MessageSize                  The size in bytes of the message to be signed.
+  @param  Signature                    The buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the signature buffer.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+SpdmRequesterGenerateSignature (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     CONST UINT8                *Message,
+  IN     UINTN                      MessageSize,
+     OUT UINT8                      *Signature,
+  IN OUT UINTN                      *SigSize
+  )
+{
+  if ((SpdmContext->LocalContext.LocalReqPrivateKey != NULL) &&
+      (SpdmContext->LocalContext.LocalReqPrivateKeyAsymAlgo == SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg)) {
+    return SpdmRequesterDataSignWithKeyFunc (
+             SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
+             SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+             SpdmContext->LocalContext.LocalReqPrivateKey,
+             Message,
+             MessageSize,
+             Signature,
+             SigSize
+             );
+  }
+  return SpdmRequesterDataSignFunc (
+           SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
+           SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+           Message,
+           MessageSize,
+           Signature,
+           SigSize
+           );
+}
+
+/**
+  This function signs a message hash with the requester private key.
+
+  The registered requester private key handle is used if it matches the negotiated algorithm.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    The buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the signature buffer.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+SpdmRequesterGenerateSignatureFromHash (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     CONST UINT8                *MessageHash,
+     OUT UINT8                      *Signature,
+  IN OUT UINTN                      *SigSize
+  )
+{
+  if ((SpdmContext->LocalContext.LocalReqPrivateKey != NULL) &&
+      (SpdmContext->LocalContext.LocalReqPrivateKeyAsymAlgo == SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg)) {
+    return SpdmRequesterDataSignHashWithKeyFunc (
+             SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
+             SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+             SpdmContext->LocalContext.LocalReqPrivateKey,
+             MessageHash,
+             Signature,
+             SigSize
+             );
+  }
+  return SpdmRequesterDataSignHashFunc (
+           SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
+           SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+           MessageHash,
+           Signature,
+           SigSize
+           );
+}
+
+/**
+  This function generates the challenge signature based upon M1M2 for authentication.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsRequester                  Indicate of the signature generation for a requester or a responder.
+  @param  Signature                    The buffer to store the challenge signature.
+
+  @retval RETURN_SUCCESS               challenge signature is generated.
+  @retval RETURN_NOT_READY             the responder signing is pending.
+  @retval RETURN_DEVICE_ERROR          challenge signature is not generated.
+**/
+RETURN_STATUS
+SpdmGenerateChallengeAuthSignature (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     BOOLEAN                    IsRequester,
+     OUT UINT8                      *Signature
+  )
+{
+  BOOLEAN                       Result;
+  RETURN_STATUS                 Status;
+  UINTN                         SignatureSize;
+  UINT8                         *M1M2Buffer;
+  UINTN                         M1M2BufferSize;
+  UINT8                         M1M2HashData[MAX_HASH_SIZE];
+
+  //
+  // Sign the M1M2 hash, unless the signing function takes the message before hash.
+  //
+  if (!IsRequester) {
+    if ((SpdmContext->ResponderDataSignAsyncFunc == 0) &&
+        SpdmAsymFuncNeedHash (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo)) {
+      if (!SpdmCalculateM1M2Hash (SpdmContext, FALSE, M1M2HashData)) {
+        return RETURN_DEVICE_ERROR;
+      }
+      return SpdmResponderGenerateSignatureFromHash (SpdmContext, M1M2HashData, Signature);
+    }
+  } else if (SpdmReqAsymFuncNeedHash (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg)) {
+    if (!SpdmCalculateM1M2Hash (SpdmContext, TRUE, M1M2HashData)) {
+      return RETURN_DEVICE_ERROR;
+    }
+    SignatureSize = GetSpdmReqAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg);
+    Result = SpdmRequesterGenerateSignatureFromHash (SpdmContext, M1M2HashData, Signature, &SignatureSize);
+    return Result ? RETURN_SUCCESS : RETURN_DEVICE_ERROR;
+  }
+
+  M1M2Buffer = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (M1M2Buffer == NULL) {
+    return RETURN_DEVICE_ERROR;
+  }
+  M1M2BufferSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  Result = SpdmCalculateM1M2 (SpdmContext, IsRequester, &M1M2BufferSize, M1M2Buffer);
+  if (!Result) {
+    SpdmReleaseScratch (SpdmContext, M1M2Buffer);
+    return RETURN_DEVICE_ERROR;
+  }
+
+  if (!IsRequester) {
+    Status = SpdmResponderGenerateSignature (SpdmContext, M1M2Buffer, M1M2BufferSize, Signature);
+    SpdmReleaseScratch (SpdmContext, M1M2Buffer);
+    return Status;
+  }
+
+  SignatureSize = GetSpdmReqAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg);
+  Result = SpdmRequesterGenerateSignature (
+            SpdmContext,
+            M1M2Buffer,
+            M1M2BufferSize,
+            Signature,
+            &SignatureSize
+            );
+  SpdmReleaseScratch (SpdmContext, M1M2Buffer);
+  return Result ? RETURN_SUCCESS : RETURN_DEVICE_ERROR;
+}
+
+/**
+  This function verifies the certificate chain hash.
+
+  If no peer certificate chain is available, the hash is verified against the provisioned peer public key.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CertificateChainHash         The certificate chain hash data buffer.
+  @param  CertificateChainHashSize     Size in bytes of the certificate chain hash data buffer.
+
+  @retval TRUE  hash verification pass.
+  @retval FALSE hash verification fail.
+**/
+BOOLEAN
+SpdmVerifyCertificateChainHash (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN VOID                         *CertificateChainHash,
+  IN UINTN                        CertificateChainHashSize
+  )
+{
+  UINTN                                     HashSize;
+  UINT8                                     CertChainBufferHash[MAX_HASH_SIZE];
+  UINT8                                     *CertChainBuffer;
+  UINTN                                     CertChainBufferSize;
+  BOOLEAN                                   Result;
+
+  Result = SpdmGetPeerCertChainBuffer (SpdmContext, (VOID **)&CertChainBuffer, &CertChainBufferSize);
+  if (!Result) {
+    CertChainBuffer = SpdmContext->LocalContext.PeerPublicKeyProvision;
+    CertChainBufferSize = SpdmContext->LocalContext.PeerPublicKeyProvisionSize;
+    if (CertChainBufferSize == 0) {
+      return FALSE;
+    }
+  }
+
+  HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
+
+  SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, CertChainBuffer, CertChainBufferSize, CertChainBufferHash);
+
+  if (HashSize != CertificateChainHashSize) {
     DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainHash - FAIL !!!\n"));
     return FALSE;
   }
@@ -511,55 +1478,54 @@ SpdmVerifyChallengeAuthSignature (
   )
 {
   BOOLEAN                                   Result;
-  UINT8                                     *CertBuffer;
-  UINTN                                     CertBufferSize;
   VOID                                      *Context;
-  UINT8                                     *CertChainData;
-  UINTN                                     CertChainDataSize;
-  UINT8                                     M1M2Buffer[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                                     *M1M2Buffer;
   UINTN                                     M1M2BufferSize;
+  UINT8                                     HashData[MAX_HASH_SIZE];
+  BOOLEAN                                   UseHash;
 
-  M1M2BufferSize = sizeof(M1M2Buffer);
-  Result = SpdmCalculateM1M2 (SpdmContext, !IsRequester, &M1M2BufferSize, &M1M2Buffer);
-  if (!Result) {
-    return FALSE;
+  //
+  // The requester keeps Message B as a running hash, and verifies the signature over the M2 hash.
+  // The responder verifies the signature over the M1M2 hash, without concatenating M1M2.
+  //
+  if (IsRequester) {
+    UseHash = TRUE;
+    Result = SpdmCalculateM2Hash (SpdmContext, HashData);
+  } else if (SpdmReqAsymFuncNeedHash (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg)) {
+    UseHash = TRUE;
+    Result = SpdmCalculateM1M2Hash (SpdmContext, TRUE, HashData);
+  } else {
+    UseHash = FALSE;
+    M1M2Buffer = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    if (M1M2Buffer == NULL) {
+      return FALSE;
+    }
+    M1M2BufferSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    Result = SpdmCalculateM1M2 (SpdmContext, !IsRequester, &M1M2BufferSize, M1M2Buffer);
   }
 
-  Result = SpdmGetPeerCertChainData (SpdmContext, (VOID **)&CertChainData, &CertChainDataSize);
-  if (!Result) {
-    return FALSE;
+  if (Result && !IsRequester) {
+    Result = SpdmGetPeerPublicKey (SpdmContext, IsRequester, &Context);
   }
-
-  //
-  // Get leaf cert from cert chain
-  //
-  Result = X509GetCertFromCertChain (CertChainData, CertChainDataSize, -1,  &CertBuffer, &CertBufferSize);
   if (!Result) {
+    if (!UseHash) {
+      SpdmReleaseScratch (SpdmContext, M1M2Buffer);
+    }
     return FALSE;
   }
 
   if (IsRequester) {
-    Result = SpdmAsymGetPublicKeyFromX509 (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo, CertBuffer, CertBufferSize, &Context);
-    if (!Result) {
-      return FALSE;
-    }
-
-    Result = SpdmAsymVerify (
-              SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
+    Result = SpdmVerifyResponderSignatureHash (SpdmContext, HashData, SignData, SignDataSize);
+  } else if (UseHash) {
+    Result = SpdmReqAsymVerifyHash (
+              SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
               SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
               Context,
-              M1M2Buffer,
-              M1M2BufferSize,
+              HashData,
               SignData,
               SignDataSize
               );
-    SpdmAsymFree (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo, Context);
   } else {
-    Result = SpdmReqAsymGetPublicKeyFromX509 (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg, CertBuffer, CertBufferSize, &Context);
-    if (!Result) {
-      return FALSE;
-    }
-
     Result = SpdmReqAsymVerify (
               SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
               SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
@@ -569,7 +1535,7 @@ SpdmVerifyChallengeAuthSignature (
               SignData,
               SignDataSize
               );
-    SpdmReqAsymFree (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg, Context);
+    SpdmReleaseScratch (SpdmContext, M1M2Buffer);
   }
 
   if (!Result) {
@@ -616,9 +1582,38 @@ SpdmGetMeasurementSummaryHashSize (
   return 0;
 }
 
+/**
+  This function checks if a measurement block is covered by a measurement summary hash.
+
+  @param  MeasurementSummaryHashType   The type of the measurement summary hash.
+  @param  MeasurementBlock             A pointer to the DMTF measurement block.
+
+  @retval TRUE  the measurement block is covered.
+  @retval FALSE the measurement block is not covered.
+**/
+BOOLEAN
+SpdmIsMeasurementBlockInSummaryHash (
+  IN     UINT8                        MeasurementSummaryHashType,
+  IN     SPDM_MEASUREMENT_BLOCK_DMTF  *MeasurementBlock
+  )
+{
+  UINT8                         MeasurementType;
+
+  MeasurementType = MeasurementBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueType & SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MASK;
+  if (MeasurementSummaryHashType == SPDM_CHALLENGE_REQUEST_ALL_MEASUREMENTS_HASH) {
+    return (BOOLEAN)(MeasurementType < SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MEASUREMENT_MANIFEST);
+  }
+  return (BOOLEAN)(MeasurementType == SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_IMMUTABLE_ROM);
+}
+
 /**
   This function calculate the measurement summary hash.
 
+  The covered measurement blocks are hashed one by one, from the measurement record,
+  or from the registered measurement block iterator.
+  The hash is kept per type and algorithms, and reused until SpdmMeasurementChanged reports a change,
+  so that CHALLENGE_AUTH and KEY_EXCHANGE_RSP do not collect the measurements each time.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  IsRequester                  Is the function called from a requester.
   @param  MeasurementSummaryHashType   The type of the measurement summary hash.
@@ -635,14 +1630,18 @@ SpdmGenerateMeasurementSummaryHash (
      OUT UINT8                *MeasurementSummaryHash
   )
 {
-  UINT8                         MeasurementData[MAX_SPDM_MEASUREMENT_RECORD_SIZE];
+  UINT32                        BaseHashAlgo;
+  VOID                          *HashContext;
+  SPDM_LOCAL_MEASUREMENT_CACHE  *MeasurementCache;
+  SPDM_MEASUREMENT_SUMMARY_HASH_CACHE  *SummaryHashCache;
+  UINT32                        ChangeCount;
   UINTN                         Index;
   SPDM_MEASUREMENT_BLOCK_DMTF   *CachedMeasurmentBlock;
-  UINTN                         MeasurmentDataSize;
   UINTN                         MeasurmentBlockSize;
-  UINT8                         DeviceMeasurement[MAX_SPDM_MEASUREMENT_RECORD_SIZE];
+  UINT8                         *DeviceMeasurement;
   UINT8                         DeviceMeasurementCount;
   UINTN                         DeviceMeasurementSize;
+  RETURN_STATUS                 Status;
   BOOLEAN                       Ret;
 
   if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, IsRequester, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP)) {
@@ -655,49 +1654,84 @@ SpdmGenerateMeasurementSummaryHash (
 
   case SPDM_CHALLENGE_REQUEST_TCB_COMPONENT_MEASUREMENT_HASH:
   case SPDM_CHALLENGE_REQUEST_ALL_MEASUREMENTS_HASH:
-    // get all measurement data
-    DeviceMeasurementSize = sizeof(DeviceMeasurement);
-    Ret = SpdmMeasurementCollectionFunc (
-            SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec,
-            SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo,
-            &DeviceMeasurementCount,
-            DeviceMeasurement,
-            &DeviceMeasurementSize
-            );
-    if (!Ret) {
-      return Ret;
+    BaseHashAlgo = SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo;
+    MeasurementCache = &SpdmContext->LocalMeasurementCache;
+    SummaryHashCache = &MeasurementCache->SummaryHash[(MeasurementSummaryHashType == SPDM_CHALLENGE_REQUEST_ALL_MEASUREMENTS_HASH) ? 1 : 0];
+    // a change notified while the hash is computed invalidates it
+    ChangeCount = MeasurementCache->ChangeCount;
+    if (SummaryHashCache->Valid &&
+        !SpdmIsMeasurementFresh (SpdmContext) &&
+        (SummaryHashCache->ChangeCount == ChangeCount) &&
+        (SummaryHashCache->BaseHashAlgo == BaseHashAlgo) &&
+        (SummaryHashCache->MeasurementSpec == SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec) &&
+        (SummaryHashCache->MeasurementHashAlgo == SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo)) {
+      CopyMem (MeasurementSummaryHash, SummaryHashCache->Hash, GetSpdmHashSize (BaseHashAlgo));
+      return TRUE;
     }
 
-    ASSERT(DeviceMeasurementCount <= MAX_SPDM_MEASUREMENT_BLOCK_COUNT);
-
-    // double confirm that MeasurmentData internal size is correct
-    MeasurmentDataSize = 0;
-    CachedMeasurmentBlock = (VOID *)DeviceMeasurement;
-    for (Index = 0; Index < DeviceMeasurementCount; Index++) {
-      MeasurmentBlockSize = sizeof(SPDM_MEASUREMENT_BLOCK_COMMON_HEADER) + CachedMeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize;
-      ASSERT (CachedMeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize == sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER) + CachedMeasurmentBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueSize);
-      MeasurmentDataSize += CachedMeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize;
-      CachedMeasurmentBlock = (VOID *)((UINTN)CachedMeasurmentBlock + MeasurmentBlockSize);
+    DeviceMeasurement = NULL;
+    if (SpdmContext->MeasurementBlockIteratorFunc != 0) {
+      // one block at a time, each fits in one SPDM message
+      DeviceMeasurement = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+      if (DeviceMeasurement == NULL) {
+        return FALSE;
+      }
+      DeviceMeasurementCount = SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS - 1;
+    } else {
+      // get all measurement data
+      Ret = SpdmGetMeasurementRecord (SpdmContext, &DeviceMeasurementCount, &DeviceMeasurement, &DeviceMeasurementSize);
+      if (!Ret) {
+        return Ret;
+      }
+      ASSERT(DeviceMeasurementCount <= MAX_SPDM_MEASUREMENT_BLOCK_COUNT);
     }
 
-    ASSERT (MeasurmentDataSize <= MAX_SPDM_MEASUREMENT_RECORD_SIZE);
+    HashContext = SpdmHashNew (BaseHashAlgo);
+    Ret = (BOOLEAN)(HashContext != NULL);
 
-    // get required data and hash them
+    // hash the covered blocks, as if they were concatenated
     CachedMeasurmentBlock = (VOID *)DeviceMeasurement;
-    MeasurmentDataSize = 0;
-    for (Index = 0; Index < DeviceMeasurementCount; Index++) {
-      MeasurmentBlockSize = sizeof(SPDM_MEASUREMENT_BLOCK_COMMON_HEADER) + CachedMeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize;
+    for (Index = 0; Ret && (Index < DeviceMeasurementCount); Index++) {
+      if (SpdmContext->MeasurementBlockIteratorFunc != 0) {
+        MeasurmentBlockSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+        Status = SpdmIterateMeasurementBlock (SpdmContext, (UINT8)(Index + 1), DeviceMeasurement, &MeasurmentBlockSize);
+        if (Status == RETURN_NOT_FOUND) {
+          break;
+        }
+        if (RETURN_ERROR(Status)) {
+          Ret = FALSE;
+          break;
+        }
+      } else {
+        MeasurmentBlockSize = sizeof(SPDM_MEASUREMENT_BLOCK_COMMON_HEADER) + CachedMeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize;
+        ASSERT (CachedMeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize == sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER) + CachedMeasurmentBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueSize);
+      }
       // filter unneeded data
-      if (((MeasurementSummaryHashType == SPDM_CHALLENGE_REQUEST_ALL_MEASUREMENTS_HASH) && 
-           ((CachedMeasurmentBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueType & SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MASK) < SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MEASUREMENT_MANIFEST)) ||
-          ((CachedMeasurmentBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueType & SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MASK) == SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_IMMUTABLE_ROM)) {
-        CopyMem (&MeasurementData[MeasurmentDataSize], &CachedMeasurmentBlock->MeasurementBlockDmtfHeader, CachedMeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize);
+      if (SpdmIsMeasurementBlockInSummaryHash (MeasurementSummaryHashType, CachedMeasurmentBlock)) {
+        Ret = SpdmHashUpdate (BaseHashAlgo, HashContext, &CachedMeasurmentBlock->MeasurementBlockDmtfHeader, CachedMeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize);
+      }
+      if (SpdmContext->MeasurementBlockIteratorFunc == 0) {
+        CachedMeasurmentBlock = (VOID *)((UINTN)CachedMeasurmentBlock + MeasurmentBlockSize);
       }
-      MeasurmentDataSize += CachedMeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize;
-      CachedMeasurmentBlock = (VOID *)((UINTN)CachedMeasurmentBlock + MeasurmentBlockSize);
     }
-    SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, MeasurementData, MeasurmentDataSize, MeasurementSummaryHash);
-    break;
+    if (Ret) {
+      Ret = SpdmHashFinal (BaseHashAlgo, HashContext, MeasurementSummaryHash);
+    }
+    if (Ret) {
+      SummaryHashCache->Valid = TRUE;
+      SummaryHashCache->BaseHashAlgo = BaseHashAlgo;
+      SummaryHashCache->MeasurementSpec = SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec;
+      SummaryHashCache->MeasurementHashAlgo = SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo;
+      SummaryHashCache->ChangeCount = ChangeCount;
+      CopyMem (SummaryHashCache->Hash, MeasurementSummaryHash, GetSpdmHashSize (BaseHashAlgo));
+    }
+    if (HashContext != NULL) {
+      SpdmHashFree (BaseHashAlgo, HashContext);
+    }
+    if (SpdmContext->MeasurementBlockIteratorFunc != 0) {
+      SpdmReleaseScratch (SpdmContext, DeviceMeasurement);
+    }
+    return Ret;
   default:
     return FALSE;
     break;
@@ -708,39 +1742,29 @@ SpdmGenerateMeasurementSummaryHash (
 /**
   This function generates the measurement signature to response message based upon L1L2.
 
+  The L1L2 hash is signed synchronously, even if the asynchronous signing functions are registered.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  Signature                    The buffer to store the Signature.
 
-  @retval TRUE  measurement signature is generated.
-  @retval FALSE measurement signature is not generated.
+  @retval RETURN_SUCCESS               measurement signature is generated.
+  @retval RETURN_DEVICE_ERROR          measurement signature is not generated.
 **/
-BOOLEAN
+RETURN_STATUS
 SpdmGenerateMeasurementSignature (
   IN     SPDM_DEVICE_CONTEXT    *SpdmContext,
      OUT UINT8                  *Signature
   )
 {
-  UINTN                         SignatureSize;
   BOOLEAN                       Result;
-  UINT8                         L1L2Buffer[MAX_SPDM_MESSAGE_BUFFER_SIZE];
-  UINTN                         L1L2BufferSize;
+  UINT8                         L1L2HashData[MAX_HASH_SIZE];
 
-  L1L2BufferSize = sizeof(L1L2Buffer);
-  Result = SpdmCalculateL1L2 (SpdmContext, &L1L2BufferSize, L1L2Buffer);
+  Result = SpdmCalculateL1L2Hash (SpdmContext, L1L2HashData);
   if (!Result) {
-    return FALSE;
+    return RETURN_DEVICE_ERROR;
   }
 
-  SignatureSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
-  Result = SpdmResponderDataSignFunc (
-             SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
-             SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
-             L1L2Buffer,
-             L1L2BufferSize,
-             Signature,
-             &SignatureSize
-             );
-  return Result;
+  return SpdmResponderGenerateSignatureFromHash (SpdmContext, L1L2HashData, Signature);
 }
 
 /**
@@ -761,54 +1785,185 @@ SpdmVerifyMeasurementSignature (
   )
 {
   BOOLEAN                                   Result;
-  UINT8                                     *CertBuffer;
-  UINTN                                     CertBufferSize;
-  VOID                                      *Context;
-  UINT8                                     *CertChainData;
-  UINTN                                     CertChainDataSize;
-  UINT8                                     L1L2Buffer[MAX_SPDM_MESSAGE_BUFFER_SIZE];
-  UINTN                                     L1L2BufferSize;
+  UINT8                                     L1L2HashData[MAX_HASH_SIZE];
 
-  L1L2BufferSize = sizeof(L1L2Buffer);
-  Result = SpdmCalculateL1L2 (SpdmContext, &L1L2BufferSize, L1L2Buffer);
+  Result = SpdmCalculateL1L2Hash (SpdmContext, L1L2HashData);
   if (!Result) {
     return FALSE;
   }
 
-  Result = SpdmGetPeerCertChainData (SpdmContext, (VOID **)&CertChainData, &CertChainDataSize);
+  Result = SpdmVerifyResponderSignatureHash (SpdmContext, L1L2HashData, SignData, SignDataSize);
   if (!Result) {
+    DEBUG((DEBUG_INFO, "!!! VerifyMeasurementSignature - FAIL !!!\n"));
     return FALSE;
   }
 
-  //
-  // Get leaf cert from cert chain
-  //
-  Result = X509GetCertFromCertChain (CertChainData, CertChainDataSize, -1,  &CertBuffer, &CertBufferSize);
-  if (!Result) {
-    return FALSE;
-  }
+  DEBUG((DEBUG_INFO, "!!! VerifyMeasurementSignature - PASS !!!\n"));
+  return TRUE;
+}
 
-  Result = SpdmAsymGetPublicKeyFromX509 (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo, CertBuffer, CertBufferSize, &Context);
-  if (!Result) {
-    return FALSE;
+/**
+  This function starts to verify a signature of the responder over a message hash, for the requester.
+
+  Without the asynchronous verification functions, the signature is verified synchronously.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageHash                  The hash of the signed message.
+  @param  SignData                     The signature data buffer.
+  @param  SignDataSize                 Size in bytes of the signature data buffer.
+  @param  PendingVerify                The pending verification, if RETURN_NOT_READY is returned.
+
+  @retval RETURN_SUCCESS               The signature is verified.
+  @retval RETURN_NOT_READY             The verification is pending.
+  @retval RETURN_SECURITY_VIOLATION    The signature is not verified.
+**/
+RETURN_STATUS
+SpdmStartVerifyResponderSignatureHash (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     CONST UINT8                  *MessageHash,
+  IN     CONST VOID                   *SignData,
+  IN     UINTN                        SignDataSize,
+     OUT SPDM_PENDING_VERIFY          *PendingVerify
+  )
+{
+  SPDM_REQUESTER_VERIFY_ASYNC_FUNC          VerifyAsyncFunc;
+  VOID                                      *Context;
+  RETURN_STATUS                             Status;
+
+  PendingVerify->Pending = FALSE;
+  if (SpdmContext->RequesterVerifyAsyncFunc == 0) {
+    if (!SpdmVerifyResponderSignatureHash (SpdmContext, MessageHash, SignData, SignDataSize)) {
+      return RETURN_SECURITY_VIOLATION;
+    }
+    return RETURN_SUCCESS;
   }
 
-  Result = SpdmAsymVerify (
+  if (!SpdmGetPeerPublicKey (SpdmContext, TRUE, &Context)) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+  VerifyAsyncFunc = (SPDM_REQUESTER_VERIFY_ASYNC_FUNC)SpdmContext->RequesterVerifyAsyncFunc;
+  Status = VerifyAsyncFunc (
+             SpdmContext,
              SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
              SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
              Context,
-             L1L2Buffer,
-             L1L2BufferSize,
+             MessageHash,
              SignData,
-             SignDataSize
+             SignDataSize,
+             &PendingVerify->VerifyToken
              );
-  SpdmAsymFree (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo, Context);
-  if (!Result) {
-    DEBUG((DEBUG_INFO, "!!! VerifyMeasurementSignature - FAIL !!!\n"));
-    return FALSE;
+  if (Status == RETURN_NOT_READY) {
+    PendingVerify->Pending = TRUE;
+    return RETURN_NOT_READY;
+  }
+  if (RETURN_ERROR(Status)) {
+    return RETURN_SECURITY_VIOLATION;
   }
+  return RETURN_SUCCESS;
+}
 
-  DEBUG((DEBUG_INFO, "!!! VerifyMeasurementSignature - PASS !!!\n"));
-  return TRUE;
+/**
+  This function starts to verify the challenge signature based upon M1M2, for the requester.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SignData                     The signature data buffer.
+  @param  SignDataSize                 Size in bytes of the signature data buffer.
+  @param  PendingVerify                The pending verification, if RETURN_NOT_READY is returned.
+
+  @retval RETURN_SUCCESS               The signature is verified.
+  @retval RETURN_NOT_READY             The verification is pending.
+  @retval RETURN_SECURITY_VIOLATION    The signature is not verified.
+**/
+RETURN_STATUS
+SpdmStartVerifyChallengeAuthSignature (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     VOID                         *SignData,
+  IN     UINTN                        SignDataSize,
+     OUT SPDM_PENDING_VERIFY          *PendingVerify
+  )
+{
+  UINT8                                     HashData[MAX_HASH_SIZE];
+
+  PendingVerify->Pending = FALSE;
+  if (!SpdmCalculateM2Hash (SpdmContext, HashData)) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+  return SpdmStartVerifyResponderSignatureHash (SpdmContext, HashData, SignData, SignDataSize, PendingVerify);
+}
+
+/**
+  This function starts to verify the measurement signature based upon L1L2.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SignData                     The signature data buffer.
+  @param  SignDataSize                 Size in bytes of the signature data buffer.
+  @param  PendingVerify                The pending verification, if RETURN_NOT_READY is returned.
+
+  @retval RETURN_SUCCESS               The signature is verified.
+  @retval RETURN_NOT_READY             The verification is pending.
+  @retval RETURN_SECURITY_VIOLATION    The signature is not verified.
+**/
+RETURN_STATUS
+SpdmStartVerifyMeasurementSignature (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     VOID                         *SignData,
+  IN     UINTN                        SignDataSize,
+     OUT SPDM_PENDING_VERIFY          *PendingVerify
+  )
+{
+  UINT8                                     L1L2HashData[MAX_HASH_SIZE];
+
+  PendingVerify->Pending = FALSE;
+  if (!SpdmCalculateL1L2Hash (SpdmContext, L1L2HashData)) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+  return SpdmStartVerifyResponderSignatureHash (SpdmContext, L1L2HashData, SignData, SignDataSize, PendingVerify);
+}
+
+/**
+  This function polls a pending signature verification of the requester.
+
+  The verification is no longer pending once a status other than RETURN_NOT_READY is returned.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  PendingVerify                The pending verification.
+  @param  Wait                         TRUE to wait until the verification is completed.
+
+  @retval RETURN_SUCCESS               The signature is verified, or no verification is pending.
+  @retval RETURN_NOT_READY             The verification is still pending. It is not returned if Wait is TRUE.
+  @retval RETURN_SECURITY_VIOLATION    The signature is not verified.
+**/
+RETURN_STATUS
+SpdmPollVerifySignature (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN OUT SPDM_PENDING_VERIFY          *PendingVerify,
+  IN     BOOLEAN                      Wait
+  )
+{
+  SPDM_REQUESTER_VERIFY_POLL_FUNC           VerifyPollFunc;
+  RETURN_STATUS                             Status;
+
+  if (!PendingVerify->Pending) {
+    return RETURN_SUCCESS;
+  }
+  if (SpdmContext->RequesterVerifyPollFunc == 0) {
+    PendingVerify->Pending = FALSE;
+    return RETURN_SECURITY_VIOLATION;
+  }
+  VerifyPollFunc = (SPDM_REQUESTER_VERIFY_POLL_FUNC)SpdmContext->RequesterVerifyPollFunc;
+  Status = VerifyPollFunc (SpdmContext, PendingVerify->VerifyToken, Wait);
+  if (Status == RETURN_NOT_READY) {
+    if (!Wait) {
+      return RETURN_NOT_READY;
+    }
+    Status = RETURN_SECURITY_VIOLATION;
+  }
+  PendingVerify->Pending = FALSE;
+  if (RETURN_ERROR(Status)) {
+    DEBUG((DEBUG_INFO, "!!! PollVerifySignature - FAIL !!!\n"));
+    return RETURN_SECURITY_VIOLATION;
+  }
+  DEBUG((DEBUG_INFO, "!!! PollVerifySignature - PASS !!!\n"));
+  return RETURN_SUCCESS;
 }
 
@@ -37,42 +37,47 @@ SpdmCalculateTHForExchange (
   UINT8                         CertChainDataHash[MAX_HASH_SIZE];
   UINT32                        HashSize;
   RETURN_STATUS                 Status;
-  LARGE_MANAGED_BUFFER          THCurr;
+  UINTN                         THCurrSize;
 
   SpdmContext = Context;
   SessionInfo = SpdmSessionInfo;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
 
-  ASSERT (*THDataBufferSize >= MAX_SPDM_MESSAGE_BUFFER_SIZE);
-  InitManagedBuffer (&THCurr, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  THCurrSize = 0;
 
-  DEBUG((DEBUG_INFO, "MessageA Data :\n"));
-  InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageA), GetManagedBufferSize(&SpdmContext->Transcript.MessageA));
-  Status = AppendManagedBuffer (&THCurr, GetManagedBuffer(&SpdmContext->Transcript.MessageA), GetManagedBufferSize(&SpdmContext->Transcript.MessageA));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "MessageA Data :\n"));
+    InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageA), GetManagedBufferSize(&SpdmContext->Transcript.MessageA));
+  }
+  Status = AppendBufferManagedBufferData (THDataBuffer, *THDataBufferSize, &THCurrSize, &SpdmContext->Transcript.MessageA);
   if (RETURN_ERROR(Status)) {
     return FALSE;
   }
 
   if (CertChainData != NULL) {
-    DEBUG((DEBUG_INFO, "THMessageCt Data :\n"));
-    InternalDumpHex (CertChainData, CertChainDataSize);
-    SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, CertChainData, CertChainDataSize, CertChainDataHash);
-    Status = AppendManagedBuffer (&THCurr, CertChainDataHash, HashSize);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_CERT)) {
+      DEBUG((DEBUG_INFO, "THMessageCt Data :\n"));
+      InternalDumpHex (CertChainData, CertChainDataSize);
+    }
+    SpdmHashCertChainData (SpdmContext, CertChainData, CertChainDataSize, CertChainDataHash);
+    Status = AppendBuffer (THDataBuffer, *THDataBufferSize, &THCurrSize, CertChainDataHash, HashSize);
     if (RETURN_ERROR(Status)) {
       return FALSE;
     }
   }
 
-  DEBUG((DEBUG_INFO, "MessageK Data :\n"));
-  InternalDumpHex (GetManagedBuffer(&SessionInfo->SessionTranscript.MessageK), GetManagedBufferSize(&SessionInfo->SessionTranscript.MessageK));
-  Status = AppendManagedBuffer (&THCurr, GetManagedBuffer(&SessionInfo->SessionTranscript.MessageK), GetManagedBufferSize(&SessionInfo->SessionTranscript.MessageK));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "MessageK Data :\n"));
+    InternalDumpManagedBuffer (&SessionInfo->SessionTranscript.MessageK);
+  }
+  Status = AppendBufferManagedBufferData (THDataBuffer, *THDataBufferSize, &THCurrSize, &SessionInfo->SessionTranscript.MessageK);
   if (RETURN_ERROR(Status)) {
     return FALSE;
   }
 
-  *THDataBufferSize = GetManagedBufferSize(&THCurr);
-  CopyMem (THDataBuffer, GetManagedBuffer(&THCurr), *THDataBufferSize);
+  SPDM_TRACEPOINT_CRYPTO (calculate_th_for_exchange, SessionInfo->SessionId, THCurrSize);
+  *THDataBufferSize = THCurrSize;
 
   return TRUE;
 }
@@ -110,59 +115,68 @@ SpdmCalculateTHForFinish (
   UINT8                         MutCertChainDataHash[MAX_HASH_SIZE];
   UINT32                        HashSize;
   RETURN_STATUS                 Status;
-  LARGE_MANAGED_BUFFER          THCurr;
+  UINTN                         THCurrSize;
 
   SpdmContext = Context;
   SessionInfo = SpdmSessionInfo;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
 
-  ASSERT (*THDataBufferSize >= MAX_SPDM_MESSAGE_BUFFER_SIZE);
-  InitManagedBuffer (&THCurr, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  THCurrSize = 0;
 
-  DEBUG((DEBUG_INFO, "MessageA Data :\n"));
-  InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageA), GetManagedBufferSize(&SpdmContext->Transcript.MessageA));
-  Status = AppendManagedBuffer (&THCurr, GetManagedBuffer(&SpdmContext->Transcript.MessageA), GetManagedBufferSize(&SpdmContext->Transcript.MessageA));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "MessageA Data :\n"));
+    InternalDumpHex (GetManagedBuffer(&SpdmContext->Transcript.MessageA), GetManagedBufferSize(&SpdmContext->Transcript.MessageA));
+  }
+  Status = AppendBufferManagedBufferData (THDataBuffer, *THDataBufferSize, &THCurrSize, &SpdmContext->Transcript.MessageA);
   if (RETURN_ERROR(Status)) {
     return FALSE;
   }
 
   if (CertChainData != NULL) {
-    DEBUG((DEBUG_INFO, "THMessageCt Data :\n"));
-    InternalDumpHex (CertChainData, CertChainDataSize);
-    SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, CertChainData, CertChainDataSize, CertChainDataHash);
-    Status = AppendManagedBuffer (&THCurr, CertChainDataHash, HashSize);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_CERT)) {
+      DEBUG((DEBUG_INFO, "THMessageCt Data :\n"));
+      InternalDumpHex (CertChainData, CertChainDataSize);
+    }
+    SpdmHashCertChainData (SpdmContext, CertChainData, CertChainDataSize, CertChainDataHash);
+    Status = AppendBuffer (THDataBuffer, *THDataBufferSize, &THCurrSize, CertChainDataHash, HashSize);
     if (RETURN_ERROR(Status)) {
       return FALSE;
     }
   }
 
-  DEBUG((DEBUG_INFO, "MessageK Data :\n"));
-  InternalDumpHex (GetManagedBuffer(&SessionInfo->SessionTranscript.MessageK), GetManagedBufferSize(&SessionInfo->SessionTranscript.MessageK));
-  Status = AppendManagedBuffer (&THCurr, GetManagedBuffer(&SessionInfo->SessionTranscript.MessageK), GetManagedBufferSize(&SessionInfo->SessionTranscript.MessageK));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "MessageK Data :\n"));
+    InternalDumpManagedBuffer (&SessionInfo->SessionTranscript.MessageK);
+  }
+  Status = AppendBufferManagedBufferData (THDataBuffer, *THDataBufferSize, &THCurrSize, &SessionInfo->SessionTranscript.MessageK);
   if (RETURN_ERROR(Status)) {
     return FALSE;
   }
 
   if (MutCertChainData != NULL) {
-    DEBUG((DEBUG_INFO, "THMessageCM Data :\n"));
-    InternalDumpHex (MutCertChainData, MutCertChainDataSize);
-    SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, MutCertChainData, MutCertChainDataSize, MutCertChainDataHash);
-    Status = AppendManagedBuffer (&THCurr, MutCertChainDataHash, HashSize);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_CERT)) {
+      DEBUG((DEBUG_INFO, "THMessageCM Data :\n"));
+      InternalDumpHex (MutCertChainData, MutCertChainDataSize);
+    }
+    SpdmHashCertChainData (SpdmContext, MutCertChainData, MutCertChainDataSize, MutCertChainDataHash);
+    Status = AppendBuffer (THDataBuffer, *THDataBufferSize, &THCurrSize, MutCertChainDataHash, HashSize);
     if (RETURN_ERROR(Status)) {
       return FALSE;
     }
   }
 
-  DEBUG((DEBUG_INFO, "MessageF Data :\n"));
-  InternalDumpHex (GetManagedBuffer(&SessionInfo->SessionTranscript.MessageF), GetManagedBufferSize(&SessionInfo->SessionTranscript.MessageF));
-  Status = AppendManagedBuffer (&THCurr, GetManagedBuffer(&SessionInfo->SessionTranscript.MessageF), GetManagedBufferSize(&SessionInfo->SessionTranscript.MessageF));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "MessageF Data :\n"));
+    InternalDumpManagedBuffer (&SessionInfo->SessionTranscript.MessageF);
+  }
+  Status = AppendBufferManagedBufferData (THDataBuffer, *THDataBufferSize, &THCurrSize, &SessionInfo->SessionTranscript.MessageF);
   if (RETURN_ERROR(Status)) {
     return FALSE;
   }
 
-  *THDataBufferSize = GetManagedBufferSize(&THCurr);
-  CopyMem (THDataBuffer, GetManagedBuffer(&THCurr), *THDataBufferSize);
+  SPDM_TRACEPOINT_CRYPTO (calculate_th_for_finish, SessionInfo->SessionId, THCurrSize);
+  *THDataBufferSize = THCurrSize;
 
   return TRUE;
 }
@@ -174,10 +188,11 @@ SpdmCalculateTHForFinish (
   @param  SessionInfo                  The session info of an SPDM session.
   @param  Signature                    The buffer to store the key exchange signature.
 
-  @retval TRUE  key exchange signature is generated.
-  @retval FALSE key exchange signature is not generated.
+  @retval RETURN_SUCCESS               key exchange signature is generated.
+  @retval RETURN_NOT_READY             the responder signing is pending.
+  @retval RETURN_DEVICE_ERROR          key exchange signature is not generated.
 **/
-BOOLEAN
+RETURN_STATUS
 SpdmGenerateKeyExchangeRspSignature (
   IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
   IN     SPDM_SESSION_INFO         *SessionInfo,
@@ -188,9 +203,10 @@ SpdmGenerateKeyExchangeRspSignature (
   UINT8                         *CertChainData;
   UINTN                         CertChainDataSize;
   BOOLEAN                       Result;
+  RETURN_STATUS                 Status;
   UINTN                         SignatureSize;
   UINT32                        HashSize;
-  UINT8                         THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                         *THCurrData;
   UINTN                         THCurrDataSize;
 
   SignatureSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
@@ -198,35 +214,53 @@ SpdmGenerateKeyExchangeRspSignature (
 
   Result = SpdmGetLocalCertChainData (SpdmContext, (VOID **)&CertChainData, &CertChainDataSize);
   if (!Result) {
-    return FALSE;
+    return RETURN_DEVICE_ERROR;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
-  Result = SpdmCalculateTHForExchange (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, &THCurrDataSize, THCurrData);
-  if (!Result) {
-    return FALSE;
-  }
+  //
+  // Sign the running TH hash, unless the signing function takes the message before hash.
+  //
+  if ((SpdmContext->ResponderDataSignAsyncFunc == 0) &&
+      SpdmAsymFuncNeedHash (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo) &&
+      SpdmCalculateTHHashFromDigest (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, NULL, 0, FALSE, HashData)) {
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "THCurr Hash - "));
+      InternalDumpData (HashData, HashSize);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
 
-  // debug only
-  SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, HashData);
-  DEBUG((DEBUG_INFO, "THCurr Hash - "));
-  InternalDumpData (HashData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
-
-  Result = SpdmResponderDataSignFunc (
-             SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
-             SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
-             THCurrData,
-             THCurrDataSize,
-             Signature,
-             &SignatureSize
-             );
-  if (Result) {
-    DEBUG((DEBUG_INFO, "Signature - "));
-    InternalDumpData (Signature, SignatureSize);
-    DEBUG((DEBUG_INFO, "\n"));
+    Status = SpdmResponderGenerateSignatureFromHash (SpdmContext, HashData, Signature);
+  } else {
+    THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    if (THCurrData == NULL) {
+      return RETURN_DEVICE_ERROR;
+    }
+    THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    Result = SpdmCalculateTHForExchange (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, &THCurrDataSize, THCurrData);
+    if (!Result) {
+      SpdmReleaseScratch (SpdmContext, THCurrData);
+      return RETURN_DEVICE_ERROR;
+    }
+
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, HashData);
+      DEBUG((DEBUG_INFO, "THCurr Hash - "));
+      InternalDumpData (HashData, HashSize);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
+
+    Status = SpdmResponderGenerateSignature (SpdmContext, THCurrData, THCurrDataSize, Signature);
+    SpdmReleaseScratch (SpdmContext, THCurrData);
   }
-  return Result;
+  if (Status == RETURN_SUCCESS) {
+    SPDM_TRACEPOINT_CRYPTO (generate_key_exchange_rsp_signature, SessionInfo->SessionId, SignatureSize);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "Signature - "));
+      InternalDumpData (Signature, SignatureSize);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
+  }
+  return Status;
 }
 
 /**
@@ -250,7 +284,7 @@ SpdmGenerateKeyExchangeRspHmac (
   UINT8                         *CertChainData;
   UINTN                         CertChainDataSize;
   UINT32                        HashSize;
-  UINT8                         THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                         *THCurrData;
   UINTN                         THCurrDataSize;
   BOOLEAN                       Result;
 
@@ -261,16 +295,25 @@ SpdmGenerateKeyExchangeRspHmac (
     return FALSE;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
+  THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (THCurrData == NULL) {
+    return FALSE;
+  }
+  THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   Result = SpdmCalculateTHForExchange (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, &THCurrDataSize, THCurrData);
   if (!Result) {
+    SpdmReleaseScratch (SpdmContext, THCurrData);
     return FALSE;
   }
 
   SpdmHmacAllWithResponseFinishedKey (SessionInfo->SecuredMessageContext, THCurrData, THCurrDataSize, HmacData);
-  DEBUG((DEBUG_INFO, "THCurr Hmac - "));
-  InternalDumpData (HmacData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  SPDM_TRACEPOINT_CRYPTO (generate_key_exchange_rsp_hmac, SessionInfo->SessionId, THCurrDataSize);
+  SpdmReleaseScratch (SpdmContext, THCurrData);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "THCurr Hmac - "));
+    InternalDumpData (HmacData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   CopyMem (Hmac, HmacData, HashSize);
 
@@ -301,11 +344,10 @@ SpdmVerifyKeyExchangeRspSignature (
   BOOLEAN                                   Result;
   UINT8                                     *CertChainData;
   UINTN                                     CertChainDataSize;
-  UINT8                                     *CertBuffer;
-  UINTN                                     CertBufferSize;
   VOID                                      *Context;
-  UINT8                                     THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                                     *THCurrData;
   UINTN                                     THCurrDataSize;
+  BOOLEAN                                   UseHash;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
 
@@ -314,49 +356,61 @@ SpdmVerifyKeyExchangeRspSignature (
     return FALSE;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
-  Result = SpdmCalculateTHForExchange (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, &THCurrDataSize, THCurrData);
-  if (!Result) {
-    return FALSE;
-  }
-
-  // debug only
-  SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, HashData);
-  DEBUG((DEBUG_INFO, "THCurr Hash - "));
-  InternalDumpData (HashData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
-
-  DEBUG((DEBUG_INFO, "Signature - "));
-  InternalDumpData (SignData, SignDataSize);
-  DEBUG((DEBUG_INFO, "\n"));
-
   //
-  // Get leaf cert from cert chain
+  // Verify the signature over the running TH hash, unless the algorithm signs the message before hash.
   //
-  Result = X509GetCertFromCertChain (CertChainData, CertChainDataSize, -1,  &CertBuffer, &CertBufferSize);
-  if (!Result) {
-    return FALSE;
+  UseHash = SpdmAsymFuncNeedHash (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo) &&
+            SpdmCalculateTHHashFromDigest (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, NULL, 0, FALSE, HashData);
+  if (!UseHash) {
+    THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    if (THCurrData == NULL) {
+      return FALSE;
+    }
+    THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    Result = SpdmCalculateTHForExchange (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, &THCurrDataSize, THCurrData);
+    if (!Result) {
+      SpdmReleaseScratch (SpdmContext, THCurrData);
+      return FALSE;
+    }
   }
 
-  Result = SpdmAsymGetPublicKeyFromX509 (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo, CertBuffer, CertBufferSize, &Context);
-  if (!Result) {
-    return FALSE;
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    if (!UseHash) {
+      SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, HashData);
+    }
+    DEBUG((DEBUG_INFO, "THCurr Hash - "));
+    InternalDumpData (HashData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
   }
 
-  Result = SpdmAsymVerify (
-             SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
-             SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
-             Context,
-             THCurrData,
-             THCurrDataSize,
-             SignData,
-             SignDataSize
-             );
-  SpdmAsymFree (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo, Context);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Signature - "));
+    InternalDumpData (SignData, SignDataSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
+
+  if (UseHash) {
+    Result = SpdmVerifyResponderSignatureHash (SpdmContext, HashData, SignData, SignDataSize);
+  } else {
+    Result = SpdmGetPeerPublicKey (SpdmContext, TRUE, &Context);
+    if (Result) {
+      Result = SpdmAsymVerify (
+                 SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo,
+                 SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+                 Context,
+                 THCurrData,
+                 THCurrDataSize,
+                 SignData,
+                 SignDataSize
+                 );
+    }
+    SpdmReleaseScratch (SpdmContext, THCurrData);
+  }
   if (!Result) {
     DEBUG((DEBUG_INFO, "!!! VerifyKeyExchangeSignature - FAIL !!!\n"));
     return FALSE;
   }
+  SPDM_TRACEPOINT_CRYPTO (verify_key_exchange_rsp_signature, SessionInfo->SessionId, SignDataSize);
   DEBUG((DEBUG_INFO, "!!! VerifyKeyExchangeSignature - PASS !!!\n"));
 
   return TRUE;
@@ -386,7 +440,7 @@ SpdmVerifyKeyExchangeRspHmac (
   UINT8                                     *CertChainData;
   UINTN                                     CertChainDataSize;
   BOOLEAN                                   Result;
-  UINT8                                     THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                                     *THCurrData;
   UINTN                                     THCurrDataSize;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
@@ -397,18 +451,27 @@ SpdmVerifyKeyExchangeRspHmac (
     return FALSE;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
+  THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (THCurrData == NULL) {
+    return FALSE;
+  }
+  THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   Result = SpdmCalculateTHForExchange (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, &THCurrDataSize, THCurrData);
   if (!Result) {
+    SpdmReleaseScratch (SpdmContext, THCurrData);
     return FALSE;
   }
 
   SpdmHmacAllWithResponseFinishedKey (SessionInfo->SecuredMessageContext, THCurrData, THCurrDataSize, CalcHmacData);
-  DEBUG((DEBUG_INFO, "THCurr Hmac - "));
-  InternalDumpData (CalcHmacData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  SPDM_TRACEPOINT_CRYPTO (verify_key_exchange_rsp_hmac, SessionInfo->SessionId, THCurrDataSize);
+  SpdmReleaseScratch (SpdmContext, THCurrData);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "THCurr Hmac - "));
+    InternalDumpData (CalcHmacData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
-  if (CompareMem (CalcHmacData, HmacData, HashSize) != 0) {
+  if (SpdmConstTimeCompareMem (CalcHmacData, HmacData, HashSize) != 0) {
     DEBUG((DEBUG_INFO, "!!! VerifyKeyExchangeHmac - FAIL !!!\n"));
     return FALSE;
   }
@@ -442,7 +505,7 @@ SpdmGenerateFinishReqSignature (
   BOOLEAN                       Result;
   UINTN                         SignatureSize;
   UINT32                        HashSize;
-  UINT8                         THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                         *THCurrData;
   UINTN                         THCurrDataSize;
 
   SignatureSize = GetSpdmReqAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg);
@@ -458,30 +521,53 @@ SpdmGenerateFinishReqSignature (
     return FALSE;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
-  Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, &THCurrDataSize, THCurrData);
-  if (!Result) {
-    return FALSE;
-  }
+  //
+  // Sign the running TH hash, unless the algorithm signs the message before hash.
+  //
+  if (SpdmReqAsymFuncNeedHash (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg) &&
+      SpdmCalculateTHHashFromDigest (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, TRUE, HashData)) {
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "THCurr Hash - "));
+      InternalDumpData (HashData, HashSize);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
+
+    Result = SpdmRequesterGenerateSignatureFromHash (SpdmContext, HashData, Signature, &SignatureSize);
+  } else {
+    THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    if (THCurrData == NULL) {
+      return FALSE;
+    }
+    THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, &THCurrDataSize, THCurrData);
+    if (!Result) {
+      SpdmReleaseScratch (SpdmContext, THCurrData);
+      return FALSE;
+    }
+
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, HashData);
+      DEBUG((DEBUG_INFO, "THCurr Hash - "));
+      InternalDumpData (HashData, HashSize);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
 
-  // debug only
-  SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, HashData);
-  DEBUG((DEBUG_INFO, "THCurr Hash - "));
-  InternalDumpData (HashData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
-
-  Result = SpdmRequesterDataSignFunc (
-             SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
-             SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
-             THCurrData,
-             THCurrDataSize,
-             Signature,
-             &SignatureSize
-             );
+    Result = SpdmRequesterGenerateSignature (
+               SpdmContext,
+               THCurrData,
+               THCurrDataSize,
+               Signature,
+               &SignatureSize
+               );
+    SpdmReleaseScratch (SpdmContext, THCurrData);
+  }
   if (Result) {
-    DEBUG((DEBUG_INFO, "Signature - "));
-    InternalDumpData (Signature, SignatureSize);
-    DEBUG((DEBUG_INFO, "\n"));
+    SPDM_TRACEPOINT_CRYPTO (generate_finish_req_signature, SessionInfo->SessionId, SignatureSize);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "Signature - "));
+      InternalDumpData (Signature, SignatureSize);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
   }
 
   return Result;
@@ -511,7 +597,7 @@ SpdmGenerateFinishReqHmac (
   UINT8                                     *MutCertChainData;
   UINTN                                     MutCertChainDataSize;
   BOOLEAN                                   Result;
-  UINT8                                     THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                                     *THCurrData;
   UINTN                                     THCurrDataSize;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
@@ -531,16 +617,25 @@ SpdmGenerateFinishReqHmac (
     MutCertChainDataSize = 0;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
+  THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (THCurrData == NULL) {
+    return FALSE;
+  }
+  THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, &THCurrDataSize, THCurrData);
   if (!Result) {
+    SpdmReleaseScratch (SpdmContext, THCurrData);
     return FALSE;
   }
 
   SpdmHmacAllWithRequestFinishedKey (SessionInfo->SecuredMessageContext, THCurrData, THCurrDataSize, CalcHmacData);
-  DEBUG((DEBUG_INFO, "THCurr Hmac - "));
-  InternalDumpData (CalcHmacData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  SPDM_TRACEPOINT_CRYPTO (generate_finish_req_hmac, SessionInfo->SessionId, THCurrDataSize);
+  SpdmReleaseScratch (SpdmContext, THCurrData);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "THCurr Hmac - "));
+    InternalDumpData (CalcHmacData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   CopyMem (Hmac, CalcHmacData, HashSize);
 
@@ -573,11 +668,11 @@ SpdmVerifyFinishReqSignature (
   UINTN                                     CertChainDataSize;
   UINT8                                     *MutCertChainData;
   UINTN                                     MutCertChainDataSize;
-  UINT8                                     *MutCertBuffer;
-  UINTN                                     MutCertBufferSize;
+  SPDM_CERT_CHAIN_VIEW                      MutCertChainView;
   VOID                                      *Context;
-  UINT8                                     THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                                     *THCurrData;
   UINTN                                     THCurrDataSize;
+  BOOLEAN                                   UseHash;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
 
@@ -591,49 +686,80 @@ SpdmVerifyFinishReqSignature (
     return FALSE;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
-  Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, &THCurrDataSize, THCurrData);
-  if (!Result) {
-    return FALSE;
+  //
+  // Verify the signature over the running TH hash, unless the algorithm signs the message before hash.
+  //
+  UseHash = SpdmReqAsymFuncNeedHash (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg) &&
+            SpdmCalculateTHHashFromDigest (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, TRUE, HashData);
+  if (!UseHash) {
+    THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    if (THCurrData == NULL) {
+      return FALSE;
+    }
+    THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, &THCurrDataSize, THCurrData);
+    if (!Result) {
+      SpdmReleaseScratch (SpdmContext, THCurrData);
+      return FALSE;
+    }
   }
 
-  // debug only
-  SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, HashData);
-  DEBUG((DEBUG_INFO, "THCurr Hash - "));
-  InternalDumpData (HashData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    if (!UseHash) {
+      SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, HashData);
+    }
+    DEBUG((DEBUG_INFO, "THCurr Hash - "));
+    InternalDumpData (HashData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
-  DEBUG((DEBUG_INFO, "Signature - "));
-  InternalDumpData (SignData, SignDataSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Signature - "));
+    InternalDumpData (SignData, SignDataSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   //
   // Get leaf cert from cert chain
   //
-  Result = X509GetCertFromCertChain (MutCertChainData, MutCertChainDataSize, -1,  &MutCertBuffer, &MutCertBufferSize);
-  if (!Result) {
-    return FALSE;
+  Result = SpdmCertChainViewInit (&MutCertChainView, MutCertChainData, MutCertChainDataSize);
+  if (Result) {
+    Result = SpdmReqAsymGetPublicKeyFromX509 (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg, MutCertChainView.Leaf.Cert, MutCertChainView.Leaf.CertSize, &Context);
   }
-
-  Result = SpdmReqAsymGetPublicKeyFromX509 (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg, MutCertBuffer, MutCertBufferSize, &Context);
   if (!Result) {
+    if (!UseHash) {
+      SpdmReleaseScratch (SpdmContext, THCurrData);
+    }
     return FALSE;
   }
 
-  Result = SpdmReqAsymVerify (
-             SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
-             SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
-             Context,
-             THCurrData,
-             THCurrDataSize,
-             SignData,
-             SignDataSize
-             );
+  if (UseHash) {
+    Result = SpdmReqAsymVerifyHash (
+               SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
+               SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+               Context,
+               HashData,
+               SignData,
+               SignDataSize
+               );
+  } else {
+    Result = SpdmReqAsymVerify (
+               SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg,
+               SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo,
+               Context,
+               THCurrData,
+               THCurrDataSize,
+               SignData,
+               SignDataSize
+               );
+    SpdmReleaseScratch (SpdmContext, THCurrData);
+  }
   SpdmReqAsymFree (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg, Context);
   if (!Result) {
     DEBUG((DEBUG_INFO, "!!! VerifyFinishSignature - FAIL !!!\n"));
     return FALSE;
   }
+  SPDM_TRACEPOINT_CRYPTO (verify_finish_req_signature, SessionInfo->SessionId, SignDataSize);
   DEBUG((DEBUG_INFO, "!!! VerifyFinishSignature - PASS !!!\n"));
 
   return TRUE;
@@ -665,7 +791,7 @@ SpdmVerifyFinishReqHmac (
   UINTN                         MutCertChainDataSize;
   UINTN                         HashSize;
   BOOLEAN                       Result;
-  UINT8                         THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                         *THCurrData;
   UINTN                         THCurrDataSize;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
@@ -686,18 +812,27 @@ SpdmVerifyFinishReqHmac (
     MutCertChainDataSize = 0;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
+  THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (THCurrData == NULL) {
+    return FALSE;
+  }
+  THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, &THCurrDataSize, THCurrData);
   if (!Result) {
+    SpdmReleaseScratch (SpdmContext, THCurrData);
     return FALSE;
   }
 
   SpdmHmacAllWithRequestFinishedKey (SessionInfo->SecuredMessageContext, THCurrData, THCurrDataSize, HmacData);
-  DEBUG((DEBUG_INFO, "THCurr Hmac - "));
-  InternalDumpData (HmacData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  SPDM_TRACEPOINT_CRYPTO (verify_finish_req_hmac, SessionInfo->SessionId, THCurrDataSize);
+  SpdmReleaseScratch (SpdmContext, THCurrData);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "THCurr Hmac - "));
+    InternalDumpData (HmacData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
-  if (CompareMem(Hmac, HmacData, HashSize) != 0) {
+  if (SpdmConstTimeCompareMem (Hmac, HmacData, HashSize) != 0) {
     DEBUG((DEBUG_INFO, "!!! VerifyFinishHmac - FAIL !!!\n"));
     return FALSE;
   }
@@ -729,7 +864,7 @@ SpdmGenerateFinishRspHmac (
   UINTN                         MutCertChainDataSize;
   UINT32                        HashSize;
   BOOLEAN                       Result;
-  UINT8                         THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                         *THCurrData;
   UINTN                         THCurrDataSize;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
@@ -749,16 +884,25 @@ SpdmGenerateFinishRspHmac (
     MutCertChainDataSize = 0;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
+  THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (THCurrData == NULL) {
+    return FALSE;
+  }
+  THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, &THCurrDataSize, THCurrData);
   if (!Result) {
+    SpdmReleaseScratch (SpdmContext, THCurrData);
     return FALSE;
   }
 
   SpdmHmacAllWithResponseFinishedKey (SessionInfo->SecuredMessageContext, THCurrData, THCurrDataSize, HmacData);
-  DEBUG((DEBUG_INFO, "THCurr Hmac - "));
-  InternalDumpData (HmacData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  SPDM_TRACEPOINT_CRYPTO (generate_finish_rsp_hmac, SessionInfo->SessionId, THCurrDataSize);
+  SpdmReleaseScratch (SpdmContext, THCurrData);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "THCurr Hmac - "));
+    InternalDumpData (HmacData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   CopyMem (Hmac, HmacData, HashSize);
 
@@ -791,7 +935,7 @@ SpdmVerifyFinishRspHmac (
   UINT8                                     *MutCertChainData;
   UINTN                                     MutCertChainDataSize;
   BOOLEAN                                   Result;
-  UINT8                                     THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                                     *THCurrData;
   UINTN                                     THCurrDataSize;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
@@ -812,18 +956,27 @@ SpdmVerifyFinishRspHmac (
     MutCertChainDataSize = 0;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
+  THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (THCurrData == NULL) {
+    return FALSE;
+  }
+  THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, &THCurrDataSize, THCurrData);
   if (!Result) {
+    SpdmReleaseScratch (SpdmContext, THCurrData);
     return FALSE;
   }
 
   SpdmHmacAllWithResponseFinishedKey (SessionInfo->SecuredMessageContext, THCurrData, THCurrDataSize, CalcHmacData);
-  DEBUG((DEBUG_INFO, "THCurr Hmac - "));
-  InternalDumpData (CalcHmacData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  SPDM_TRACEPOINT_CRYPTO (verify_finish_rsp_hmac, SessionInfo->SessionId, THCurrDataSize);
+  SpdmReleaseScratch (SpdmContext, THCurrData);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "THCurr Hmac - "));
+    InternalDumpData (CalcHmacData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
-  if (CompareMem (CalcHmacData, HmacData, HashSize) != 0) {
+  if (SpdmConstTimeCompareMem (CalcHmacData, HmacData, HashSize) != 0) {
     DEBUG((DEBUG_INFO, "!!! VerifyFinishRspHmac - FAIL !!!\n"));
     return FALSE;
   }
@@ -852,21 +1005,30 @@ SpdmGeneratePskExchangeRspHmac (
   UINT8                         HmacData[MAX_HASH_SIZE];
   UINT32                        HashSize;
   BOOLEAN                       Result;
-  UINT8                         THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                         *THCurrData;
   UINTN                         THCurrDataSize;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
 
-  THCurrDataSize = sizeof(THCurrData);
+  THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (THCurrData == NULL) {
+    return FALSE;
+  }
+  THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   Result = SpdmCalculateTHForExchange (SpdmContext, SessionInfo, NULL, 0, &THCurrDataSize, THCurrData);
   if (!Result) {
+    SpdmReleaseScratch (SpdmContext, THCurrData);
     return FALSE;
   }
 
   SpdmHmacAllWithResponseFinishedKey (SessionInfo->SecuredMessageContext, THCurrData, THCurrDataSize, HmacData);
-  DEBUG((DEBUG_INFO, "THCurr Hmac - "));
-  InternalDumpData (HmacData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  SPDM_TRACEPOINT_CRYPTO (generate_psk_exchange_rsp_hmac, SessionInfo->SessionId, THCurrDataSize);
+  SpdmReleaseScratch (SpdmContext, THCurrData);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "THCurr Hmac - "));
+    InternalDumpData (HmacData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   CopyMem (Hmac, HmacData, HashSize);
 
@@ -895,24 +1057,33 @@ SpdmVerifyPskExchangeRspHmac (
   UINTN                                     HashSize;
   UINT8                                     CalcHmacData[MAX_HASH_SIZE];
   BOOLEAN                                   Result;
-  UINT8                                     THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                                     *THCurrData;
   UINTN                                     THCurrDataSize;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
   ASSERT(HashSize == HmacDataSize);
 
-  THCurrDataSize = sizeof(THCurrData);
+  THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (THCurrData == NULL) {
+    return FALSE;
+  }
+  THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   Result = SpdmCalculateTHForExchange (SpdmContext, SessionInfo, NULL, 0, &THCurrDataSize, THCurrData);
   if (!Result) {
+    SpdmReleaseScratch (SpdmContext, THCurrData);
     return FALSE;
   }
 
   SpdmHmacAllWithResponseFinishedKey (SessionInfo->SecuredMessageContext, THCurrData, THCurrDataSize, CalcHmacData);
-  DEBUG((DEBUG_INFO, "THCurr Hmac - "));
-  InternalDumpData (CalcHmacData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  SPDM_TRACEPOINT_CRYPTO (verify_psk_exchange_rsp_hmac, SessionInfo->SessionId, THCurrDataSize);
+  SpdmReleaseScratch (SpdmContext, THCurrData);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "THCurr Hmac - "));
+    InternalDumpData (CalcHmacData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
-  if (CompareMem (CalcHmacData, HmacData, HashSize) != 0) {
+  if (SpdmConstTimeCompareMem (CalcHmacData, HmacData, HashSize) != 0) {
     DEBUG((DEBUG_INFO, "!!! VerifyPskExchangeHmac - FAIL !!!\n"));
     return FALSE;
   }
@@ -941,21 +1112,30 @@ SpdmGeneratePskFinishReqHmac (
   UINTN                                     HashSize;
   UINT8                                     CalcHmacData[MAX_HASH_SIZE];
   BOOLEAN                                   Result;
-  UINT8                                     THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                                     *THCurrData;
   UINTN                                     THCurrDataSize;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
 
-  THCurrDataSize = sizeof(THCurrData);
+  THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (THCurrData == NULL) {
+    return FALSE;
+  }
+  THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, NULL, 0, NULL, 0, &THCurrDataSize, THCurrData);
   if (!Result) {
+    SpdmReleaseScratch (SpdmContext, THCurrData);
     return FALSE;
   }
 
   SpdmHmacAllWithRequestFinishedKey (SessionInfo->SecuredMessageContext, THCurrData, THCurrDataSize, CalcHmacData);
-  DEBUG((DEBUG_INFO, "THCurr Hmac - "));
-  InternalDumpData (CalcHmacData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  SPDM_TRACEPOINT_CRYPTO (generate_psk_finish_req_hmac, SessionInfo->SessionId, THCurrDataSize);
+  SpdmReleaseScratch (SpdmContext, THCurrData);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "THCurr Hmac - "));
+    InternalDumpData (CalcHmacData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   CopyMem (Hmac, CalcHmacData, HashSize);
 
@@ -984,24 +1164,33 @@ SpdmVerifyPskFinishReqHmac (
   UINT8                         HmacData[MAX_HASH_SIZE];
   UINT32                        HashSize;
   BOOLEAN                       Result;
-  UINT8                         THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                         *THCurrData;
   UINTN                         THCurrDataSize;
 
   HashSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
   ASSERT (HmacSize == HashSize);
 
-  THCurrDataSize = sizeof(THCurrData);
+  THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (THCurrData == NULL) {
+    return FALSE;
+  }
+  THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, NULL, 0, NULL, 0, &THCurrDataSize, THCurrData);
   if (!Result) {
+    SpdmReleaseScratch (SpdmContext, THCurrData);
     return FALSE;
   }
 
   SpdmHmacAllWithRequestFinishedKey (SessionInfo->SecuredMessageContext, THCurrData, THCurrDataSize, HmacData);
-  DEBUG((DEBUG_INFO, "Calc THCurr Hmac - "));
-  InternalDumpData (HmacData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  SPDM_TRACEPOINT_CRYPTO (verify_psk_finish_req_hmac, SessionInfo->SessionId, THCurrDataSize);
+  SpdmReleaseScratch (SpdmContext, THCurrData);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Calc THCurr Hmac - "));
+    InternalDumpData (HmacData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
-  if (CompareMem(Hmac, HmacData, HashSize) != 0) {
+  if (SpdmConstTimeCompareMem (Hmac, HmacData, HashSize) != 0) {
     DEBUG((DEBUG_INFO, "!!! VerifyPskFinishHmac - FAIL !!!\n"));
     return FALSE;
   }
@@ -1009,6 +1198,164 @@ SpdmVerifyPskFinishReqHmac (
   return TRUE;
 }
 
+/**
+  This function releases the running TH hash of an SPDM session.
+
+  @param  SessionInfo                  The session info of an SPDM session.
+**/
+VOID
+SpdmResetSessionTranscriptDigest (
+  IN     SPDM_SESSION_INFO         *SessionInfo
+  )
+{
+  SPDM_SESSION_TRANSCRIPT        *Transcript;
+
+  Transcript = &SessionInfo->SessionTranscript;
+  if (Transcript->DigestContextTH != NULL) {
+    SpdmHashFree (Transcript->DigestBaseHashAlgo, Transcript->DigestContextTH);
+  }
+  Transcript->DigestContextTH = NULL;
+  Transcript->DigestBaseHashAlgo = 0;
+  Transcript->DigestedMessageKSize = 0;
+  Transcript->DigestedMessageFSize = 0;
+  Transcript->DigestIncludesMessageF = FALSE;
+}
+
+/**
+  This function appends the hash of a certificate chain to the running TH hash.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  HashContext                  The running TH hash context.
+  @param  CertChainData                Certitiface chain data without SPDM_CERT_CHAIN header.
+  @param  CertChainDataSize            Size in bytes of the certitiface chain data.
+
+  @retval TRUE  the certificate chain hash is appended.
+  @retval FALSE the certificate chain hash is not appended.
+**/
+BOOLEAN
+SpdmUpdateTHDigestWithCertChain (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     VOID                      *HashContext,
+  IN     UINT8                     *CertChainData,
+  IN     UINTN                     CertChainDataSize
+  )
+{
+  UINT8                          CertChainDataHash[MAX_HASH_SIZE];
+  UINT32                         BaseHashAlgo;
+
+  BaseHashAlgo = SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo;
+  if (!SpdmHashCertChainData (SpdmContext, CertChainData, CertChainDataSize, CertChainDataHash)) {
+    return FALSE;
+  }
+  return SpdmHashUpdate (BaseHashAlgo, HashContext, CertChainDataHash, GetSpdmHashSize (BaseHashAlgo));
+}
+
+/**
+  This function calculates current TH hash from the running TH hash of the session.
+
+  The running hash is seeded from the cached Message A and Message K the first time,
+  and Message F is added the first time a TH with Message F is requested.
+  The running hash is then forked, so that it can continue to be updated.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of an SPDM session.
+  @param  CertChainData                Certitiface chain data without SPDM_CERT_CHAIN header.
+  @param  CertChainDataSize            Size in bytes of the certitiface chain data.
+  @param  MutCertChainData             Certitiface chain data without SPDM_CERT_CHAIN header in mutual authentication.
+  @param  MutCertChainDataSize         Size in bytes of the certitiface chain data in mutual authentication.
+  @param  IncludeMessageF              Indicate if the TH includes Message F.
+  @param  THHashData                   The buffer to store the TH hash.
+
+  @retval TRUE  current TH hash is calculated.
+  @retval FALSE current TH hash cannot be calculated from the running TH hash.
+**/
+BOOLEAN
+SpdmCalculateTHHashFromDigest (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     SPDM_SESSION_INFO         *SessionInfo,
+  IN     UINT8                     *CertChainData, OPTIONAL
+  IN     UINTN                     CertChainDataSize, OPTIONAL
+  IN     UINT8                     *MutCertChainData, OPTIONAL
+  IN     UINTN                     MutCertChainDataSize, OPTIONAL
+  IN     BOOLEAN                   IncludeMessageF,
+     OUT UINT8                     *THHashData
+  )
+{
+  SPDM_SESSION_TRANSCRIPT        *Transcript;
+  UINT32                         BaseHashAlgo;
+  VOID                           *HashContext;
+  BOOLEAN                        Result;
+
+  Transcript = &SessionInfo->SessionTranscript;
+  BaseHashAlgo = SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo;
+
+  //
+  // Drop the running hash if it is out of step with the cached messages.
+  //
+  if ((Transcript->DigestContextTH != NULL) &&
+      ((Transcript->DigestBaseHashAlgo != BaseHashAlgo) ||
+       (Transcript->DigestedMessageKSize != GetManagedBufferSize (&Transcript->MessageK)) ||
+       (Transcript->DigestIncludesMessageF &&
+        (Transcript->DigestedMessageFSize != GetManagedBufferSize (&Transcript->MessageF))))) {
+    SpdmResetSessionTranscriptDigest (SessionInfo);
+  }
+  if (Transcript->DigestIncludesMessageF && !IncludeMessageF) {
+    return FALSE;
+  }
+
+  if (Transcript->DigestContextTH == NULL) {
+    HashContext = SpdmHashNew (BaseHashAlgo);
+    if (HashContext == NULL) {
+      return FALSE;
+    }
+    Transcript->DigestContextTH = HashContext;
+    Transcript->DigestBaseHashAlgo = BaseHashAlgo;
+
+    Result = SpdmHashUpdateMessageA (SpdmContext, BaseHashAlgo, HashContext);
+    if (Result && (CertChainData != NULL)) {
+      Result = SpdmUpdateTHDigestWithCertChain (SpdmContext, HashContext, CertChainData, CertChainDataSize);
+    }
+    if (Result) {
+      Result = SpdmHashUpdateManagedBuffer (BaseHashAlgo, HashContext, &Transcript->MessageK);
+    }
+    if (!Result) {
+      SpdmResetSessionTranscriptDigest (SessionInfo);
+      return FALSE;
+    }
+    Transcript->DigestedMessageKSize = GetManagedBufferSize(&Transcript->MessageK);
+  }
+
+  if (IncludeMessageF && !Transcript->DigestIncludesMessageF) {
+    Result = TRUE;
+    if (MutCertChainData != NULL) {
+      Result = SpdmUpdateTHDigestWithCertChain (SpdmContext, Transcript->DigestContextTH, MutCertChainData, MutCertChainDataSize);
+    }
+    if (Result) {
+      Result = SpdmHashUpdateManagedBuffer (BaseHashAlgo, Transcript->DigestContextTH, &Transcript->MessageF);
+    }
+    if (!Result) {
+      SpdmResetSessionTranscriptDigest (SessionInfo);
+      return FALSE;
+    }
+    Transcript->DigestedMessageFSize = GetManagedBufferSize(&Transcript->MessageF);
+    Transcript->DigestIncludesMessageF = TRUE;
+  }
+
+  //
+  // Fork the running hash, so that it can continue to be updated.
+  //
+  HashContext = SpdmHashNew (BaseHashAlgo);
+  if (HashContext == NULL) {
+    return FALSE;
+  }
+  Result = SpdmHashDuplicate (BaseHashAlgo, Transcript->DigestContextTH, HashContext);
+  if (Result) {
+    Result = SpdmHashFinal (BaseHashAlgo, HashContext, THHashData);
+  }
+  SpdmHashFree (BaseHashAlgo, HashContext);
+  return Result;
+}
+
 /*
   This function calculates TH1 hash.
 
@@ -1034,7 +1381,7 @@ SpdmCalculateTH1Hash (
   UINTN                          CertChainDataSize;
   SPDM_SESSION_INFO              *SessionInfo;
   BOOLEAN                        Result;
-  UINT8                          THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                          *THCurrData;
   UINTN                          THCurrDataSize;
 
   SpdmContext = Context;
@@ -1059,16 +1406,28 @@ SpdmCalculateTH1Hash (
     CertChainDataSize = 0;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
-  Result = SpdmCalculateTHForExchange (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, &THCurrDataSize, THCurrData);
+  Result = SpdmCalculateTHHashFromDigest (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, NULL, 0, FALSE, TH1HashData);
   if (!Result) {
-    return RETURN_SECURITY_VIOLATION;
-  }
+    THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    if (THCurrData == NULL) {
+      return RETURN_OUT_OF_RESOURCES;
+    }
+    THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    Result = SpdmCalculateTHForExchange (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, &THCurrDataSize, THCurrData);
+    if (!Result) {
+      SpdmReleaseScratch (SpdmContext, THCurrData);
+      return RETURN_SECURITY_VIOLATION;
+    }
 
-  SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, TH1HashData);
-  DEBUG((DEBUG_INFO, "TH1 Hash - "));
-  InternalDumpData (TH1HashData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+    SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, TH1HashData);
+    SpdmReleaseScratch (SpdmContext, THCurrData);
+  }
+  SPDM_TRACEPOINT_CRYPTO (calculate_th1_hash, SessionInfo->SessionId, HashSize);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "TH1 Hash - "));
+    InternalDumpData (TH1HashData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   return RETURN_SUCCESS;
 }
@@ -1100,7 +1459,7 @@ SpdmCalculateTH2Hash (
   UINTN                          MutCertChainDataSize;
   SPDM_SESSION_INFO              *SessionInfo;
   BOOLEAN                        Result;
-  UINT8                          THCurrData[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                          *THCurrData;
   UINTN                          THCurrDataSize;
 
   SpdmContext = Context;
@@ -1140,16 +1499,28 @@ SpdmCalculateTH2Hash (
     MutCertChainDataSize = 0;
   }
 
-  THCurrDataSize = sizeof(THCurrData);
-  Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, &THCurrDataSize, THCurrData);
+  Result = SpdmCalculateTHHashFromDigest (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, TRUE, TH2HashData);
   if (!Result) {
-    return RETURN_SECURITY_VIOLATION;
-  }
+    THCurrData = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    if (THCurrData == NULL) {
+      return RETURN_OUT_OF_RESOURCES;
+    }
+    THCurrDataSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    Result = SpdmCalculateTHForFinish (SpdmContext, SessionInfo, CertChainData, CertChainDataSize, MutCertChainData, MutCertChainDataSize, &THCurrDataSize, THCurrData);
+    if (!Result) {
+      SpdmReleaseScratch (SpdmContext, THCurrData);
+      return RETURN_SECURITY_VIOLATION;
+    }
 
-  SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, TH2HashData);
-  DEBUG((DEBUG_INFO, "TH2 Hash - "));
-  InternalDumpData (TH2HashData, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+    SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, THCurrData, THCurrDataSize, TH2HashData);
+    SpdmReleaseScratch (SpdmContext, THCurrData);
+  }
+  SPDM_TRACEPOINT_CRYPTO (calculate_th2_hash, SessionInfo->SessionId, HashSize);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "TH2 Hash - "));
+    InternalDumpData (TH2HashData, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   return RETURN_SUCCESS;
 }
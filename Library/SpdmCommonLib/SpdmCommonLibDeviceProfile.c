@@ -0,0 +1,156 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmCommonLibInternal.h"
+
+/**
+  Return the size in bytes of a device profile.
+
+  @return the size in bytes of the device profile.
+**/
+UINTN
+EFIAPI
+SpdmDeviceProfileGetSize (
+  VOID
+  )
+{
+  return sizeof(SPDM_DEVICE_PROFILE);
+}
+
+/**
+  Initialize a device profile from the local configuration of an SPDM context.
+
+  The local configuration is set to the SPDM context with SpdmSetData, such as the capabilities, the algorithms,
+  the local certificate chains and the opaque data. The digests of the local certificate chains are precomputed
+  for each BaseHashAlgo of the local algorithms.
+  The buffers referenced by the local configuration must be kept while the profile is used.
+
+  @param  DeviceProfile                A pointer to the device profile.
+  @param  SpdmContext                  A pointer to the SPDM context holding the local configuration.
+
+  @retval RETURN_SUCCESS               The device profile is initialized.
+  @retval RETURN_UNSUPPORTED           A BaseHashAlgo of the local algorithms is not supported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmDeviceProfileInit (
+     OUT VOID                         *DeviceProfile,
+  IN     VOID                         *Context
+  )
+{
+  SPDM_DEVICE_PROFILE       *Profile;
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+  UINT32                    BaseHashAlgo;
+  UINTN                     HashIndex;
+  UINTN                     SlotIndex;
+
+  Profile = DeviceProfile;
+  SpdmContext = Context;
+
+  ZeroMem (Profile, sizeof(SPDM_DEVICE_PROFILE));
+  CopyMem (&Profile->LocalContext, &SpdmContext->LocalContext, sizeof(SPDM_LOCAL_CONTEXT));
+  for (HashIndex = 0; HashIndex < SPDM_DEVICE_PROFILE_HASH_ALGO_COUNT; HashIndex++) {
+    BaseHashAlgo = BIT0 << HashIndex;
+    if ((Profile->LocalContext.Algorithm.BaseHashAlgo & BaseHashAlgo) == 0) {
+      continue;
+    }
+    for (SlotIndex = 0; SlotIndex < Profile->LocalContext.SlotCount; SlotIndex++) {
+      if (Profile->LocalContext.LocalCertChainProvision[SlotIndex] == NULL) {
+        continue;
+      }
+      if (!SpdmHashAll (
+             BaseHashAlgo,
+             Profile->LocalContext.LocalCertChainProvision[SlotIndex],
+             Profile->LocalContext.LocalCertChainProvisionSize[SlotIndex],
+             Profile->CertChainDigest[HashIndex][SlotIndex]
+             )) {
+        return RETURN_UNSUPPORTED;
+      }
+    }
+    Profile->CertChainDigestHashAlgo |= BaseHashAlgo;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Register a device profile to an SPDM context.
+
+  The local configuration of the SPDM context is set from the profile, and the digests of the local
+  certificate chains are taken from the profile instead of being computed for each request.
+  The profile may be shared by many SPDM contexts, one per peer. It is not modified by the contexts.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  DeviceProfile                A pointer to the device profile, or NULL to stop using a profile.
+**/
+VOID
+EFIAPI
+SpdmRegisterDeviceProfile (
+  IN     VOID                         *Context,
+  IN     CONST VOID                   *DeviceProfile OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+  CONST SPDM_DEVICE_PROFILE *Profile;
+
+  SpdmContext = Context;
+  Profile = DeviceProfile;
+  SpdmContext->DeviceProfile = Profile;
+  if (Profile != NULL) {
+    CopyMem (&SpdmContext->LocalContext, &Profile->LocalContext, sizeof(SPDM_LOCAL_CONTEXT));
+    ZeroMem (SpdmContext->LocalCertChainDigest, sizeof(SpdmContext->LocalCertChainDigest));
+  }
+}
+
+/**
+  Return the precomputed digest of a local certificate chain from the device profile of an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotIndex                    The slot index of the certificate chain.
+  @param  Hash                         The buffer to store the digest.
+
+  @retval TRUE   The digest is copied from the device profile.
+  @retval FALSE  No device profile is registered, or it has no digest of the certificate chain
+                 for the negotiated BaseHashAlgo.
+**/
+BOOLEAN
+SpdmDeviceProfileGetCertChainDigest (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     UINTN                        SlotIndex,
+     OUT UINT8                        *Hash
+  )
+{
+  CONST SPDM_DEVICE_PROFILE *Profile;
+  UINT32                    BaseHashAlgo;
+  UINTN                     HashIndex;
+
+  Profile = SpdmContext->DeviceProfile;
+  if (Profile == NULL) {
+    return FALSE;
+  }
+  BaseHashAlgo = SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo;
+  if ((Profile->CertChainDigestHashAlgo & BaseHashAlgo) == 0) {
+    return FALSE;
+  }
+  //
+  // The certificate chain may have been replaced with SpdmSetData after the profile is registered.
+  //
+  if ((SlotIndex >= Profile->LocalContext.SlotCount) ||
+      (Profile->LocalContext.LocalCertChainProvision[SlotIndex] == NULL) ||
+      (Profile->LocalContext.LocalCertChainProvision[SlotIndex] != SpdmContext->LocalContext.LocalCertChainProvision[SlotIndex]) ||
+      (Profile->LocalContext.LocalCertChainProvisionSize[SlotIndex] != SpdmContext->LocalContext.LocalCertChainProvisionSize[SlotIndex])) {
+    return FALSE;
+  }
+  for (HashIndex = 0; HashIndex < SPDM_DEVICE_PROFILE_HASH_ALGO_COUNT; HashIndex++) {
+    if (BaseHashAlgo == (BIT0 << HashIndex)) {
+      CopyMem (Hash, Profile->CertChainDigest[HashIndex][SlotIndex], GetSpdmHashSize (BaseHashAlgo));
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
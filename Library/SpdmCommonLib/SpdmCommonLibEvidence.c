@@ -0,0 +1,500 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmCommonLibInternal.h"
+
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+/**
+  Initialize the segmented managed buffers of the evidence in SPDM context, with the transcript arena.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmInitEvidence (
+  IN OUT SPDM_DEVICE_CONTEXT   *SpdmContext
+  )
+{
+  SPDM_EVIDENCE              *Evidence;
+  UINTN                      Index;
+
+  Evidence = &SpdmContext->Evidence;
+  InitSegmentedManagedBuffer (&Evidence->MessageB, &SpdmContext->TranscriptArena);
+  InitSegmentedManagedBuffer (&Evidence->MessageM, &SpdmContext->TranscriptArena);
+  for (Index = 0; Index < SPDM_EVIDENCE_TYPE_COUNT; Index++) {
+    InitSegmentedManagedBuffer (&Evidence->Record[Index].Transcript, &SpdmContext->TranscriptArena);
+  }
+}
+
+/**
+  Copy the evidence of an SPDM context to its clone, whose evidence is initialized by SpdmInitEvidence.
+
+  @param  CloneContext                 A pointer to the clone of the SPDM context.
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval RETURN_SUCCESS               The evidence is copied.
+  @retval RETURN_BUFFER_TOO_SMALL      The transcript arena of the clone has not enough free chunks.
+**/
+RETURN_STATUS
+SpdmCloneEvidence (
+  IN OUT SPDM_DEVICE_CONTEXT   *CloneContext,
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext
+  )
+{
+  RETURN_STATUS              Status;
+  UINTN                      Index;
+
+  Status = AppendManagedBufferData (&CloneContext->Evidence.MessageB, &SpdmContext->Evidence.MessageB);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Status = AppendManagedBufferData (&CloneContext->Evidence.MessageM, &SpdmContext->Evidence.MessageM);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  for (Index = 0; Index < SPDM_EVIDENCE_TYPE_COUNT; Index++) {
+    Status = AppendManagedBufferData (&CloneContext->Evidence.Record[Index].Transcript, &SpdmContext->Evidence.Record[Index].Transcript);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Add a message appended to a running hash transcript of the requester to its copy in the evidence.
+
+  The copy is started over with the message if the running hash is.
+  It must be called after the message is appended to the running hash.
+
+  @param  Copy                         The copy of the running hash transcript in the evidence.
+  @param  MessageDigest                The running hash transcript.
+  @param  Message                      Message buffer.
+  @param  MessageSize                  Size in bytes of message buffer.
+**/
+VOID
+SpdmAppendEvidenceMessage (
+  IN OUT SEGMENTED_MANAGED_BUFFER  *Copy,
+  IN     SPDM_MESSAGE_DIGEST       *MessageDigest,
+  IN     VOID                      *Message,
+  IN     UINTN                     MessageSize
+  )
+{
+  if (MessageDigest->BufferSize == MessageSize) {
+    ResetManagedBuffer (Copy);
+  }
+  //
+  // A copy that cannot be appended is shorter than its running hash from now on, and is not captured.
+  //
+  AppendManagedBuffer (Copy, Message, MessageSize);
+}
+
+/**
+  Withdraw the last message from the copy of a running hash transcript of the requester in the evidence.
+
+  @param  Copy                         The copy of the running hash transcript in the evidence.
+  @param  MessageSize                  Size in bytes of the last appended message.
+**/
+VOID
+SpdmShrinkEvidenceMessage (
+  IN OUT SEGMENTED_MANAGED_BUFFER  *Copy,
+  IN     UINTN                     MessageSize
+  )
+{
+  if (MessageSize > GetManagedBufferSize (Copy)) {
+    ResetManagedBuffer (Copy);
+    return ;
+  }
+  ShrinkManagedBuffer (Copy, MessageSize);
+}
+
+/**
+  Capture the signed transcript of a CHALLENGE_AUTH or a signed MEASUREMENTS before its signature is verified.
+
+  The transcript is Concatenate (A, B, C) for CHALLENGE_AUTH, and Message M for MEASUREMENTS.
+  The signed response must be the last message appended to the transcript. Message M is moved to the
+  evidence, so it must be captured before the L1L2 hash is calculated.
+  Nothing is captured if a copy is incomplete, or if the transcript arena has not enough free chunks.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Type                         SPDM_EVIDENCE_TYPE_CHALLENGE_AUTH or SPDM_EVIDENCE_TYPE_MEASUREMENTS.
+  @param  ResponseSize                 Size in bytes of the signed response without its signature.
+  @param  Signature                    The signature of the response.
+  @param  SignatureSize                Size in bytes of the signature.
+**/
+VOID
+SpdmCaptureEvidence (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINT8                 Type,
+  IN     UINTN                 ResponseSize,
+  IN     VOID                  *Signature,
+  IN     UINTN                 SignatureSize
+  )
+{
+  SPDM_EVIDENCE              *Evidence;
+  SPDM_EVIDENCE_RECORD       *Record;
+  SPDM_CONNECTION_INFO       *ConnectionInfo;
+  RETURN_STATUS              Status;
+  UINTN                      TranscriptSize;
+
+  ASSERT (Type < SPDM_EVIDENCE_TYPE_COUNT);
+  Evidence = &SpdmContext->Evidence;
+  Record = &Evidence->Record[Type];
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+
+  ResetManagedBuffer (&Record->Transcript);
+  Record->Verified = FALSE;
+  if ((ConnectionInfo->PeerUsedCertChainBufferSize == 0) || (SignatureSize > sizeof(Record->Signature))) {
+    return ;
+  }
+
+  if (Type == SPDM_EVIDENCE_TYPE_CHALLENGE_AUTH) {
+    if (GetManagedBufferSize (&Evidence->MessageB) != SpdmContext->Transcript.MessageBDigest.BufferSize) {
+      return ;
+    }
+    Status = AppendManagedBufferData (&Record->Transcript, &SpdmContext->Transcript.MessageA);
+    if (!RETURN_ERROR(Status)) {
+      Status = AppendManagedBufferData (&Record->Transcript, &Evidence->MessageB);
+    }
+    if (!RETURN_ERROR(Status)) {
+      Status = AppendManagedBufferData (&Record->Transcript, &SpdmContext->Transcript.MessageC);
+    }
+    if (RETURN_ERROR(Status)) {
+      ResetManagedBuffer (&Record->Transcript);
+      return ;
+    }
+  } else {
+    if (GetManagedBufferSize (&Evidence->MessageM) != SpdmContext->Transcript.MessageM.BufferSize) {
+      return ;
+    }
+    //
+    // Message M is reset once the L1L2 hash is calculated, so its chunks are handed over instead of copied.
+    //
+    CopyMem (&Record->Transcript, &Evidence->MessageM, sizeof(SEGMENTED_MANAGED_BUFFER));
+    InitSegmentedManagedBuffer (&Evidence->MessageM, &SpdmContext->TranscriptArena);
+  }
+
+  TranscriptSize = GetManagedBufferSize (&Record->Transcript);
+  if ((TranscriptSize < ResponseSize) ||
+      !SpdmHashAll (ConnectionInfo->Algorithm.BaseHashAlgo, ConnectionInfo->PeerUsedCertChainBuffer, ConnectionInfo->PeerUsedCertChainBufferSize, Record->PeerCertChainHash)) {
+    ResetManagedBuffer (&Record->Transcript);
+    return ;
+  }
+  Record->ResponseOffset = TranscriptSize - ResponseSize;
+  Record->SignatureSize = SignatureSize;
+  CopyMem (Record->Signature, Signature, SignatureSize);
+}
+
+/**
+  Mark the signed transcript captured by SpdmCaptureEvidence as verified.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Type                         SPDM_EVIDENCE_TYPE_CHALLENGE_AUTH or SPDM_EVIDENCE_TYPE_MEASUREMENTS.
+**/
+VOID
+SpdmCommitEvidence (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINT8                 Type
+  )
+{
+  SPDM_EVIDENCE_RECORD       *Record;
+
+  ASSERT (Type < SPDM_EVIDENCE_TYPE_COUNT);
+  Record = &SpdmContext->Evidence.Record[Type];
+  Record->Verified = (BOOLEAN)(GetManagedBufferSize (&Record->Transcript) != 0);
+}
+#endif
+
+/**
+  Export the evidence of the peer of a requester, to be verified by SpdmVerifyEvidence without any SPDM message.
+
+  The evidence is the negotiated algorithms, the peer certificate chain with its digest, and the signed transcripts
+  of the last CHALLENGE_AUTH and the last signed MEASUREMENTS whose signatures are verified by the requester
+  with this certificate chain. A signed MEASUREMENTS verified by SpdmGetMeasurementsPipelined is not kept.
+  It requires OPENSPDM_EVIDENCE_SUPPORT.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  EvidenceSize                 On input, the size in bytes of the Evidence buffer.
+                                       On output, the size in bytes of the exported evidence.
+  @param  Evidence                     A pointer to the buffer to export the evidence to.
+
+  @retval RETURN_SUCCESS               The evidence is exported.
+  @retval RETURN_NOT_STARTED           The peer certificate chain is not retrieved.
+  @retval RETURN_NOT_FOUND             No signed transcript is verified with the peer certificate chain.
+  @retval RETURN_BUFFER_TOO_SMALL      The Evidence buffer is too small. EvidenceSize is set to the required size.
+  @retval RETURN_UNSUPPORTED           OPENSPDM_EVIDENCE_SUPPORT is 0.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmExportEvidence (
+  IN     VOID                      *Context,
+  IN OUT UINTN                     *EvidenceSize,
+     OUT VOID                      *Evidence
+  )
+{
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
+  SPDM_EVIDENCE_RECORD                      *Record;
+  SPDM_EVIDENCE_HEADER                      *Header;
+  SPDM_EVIDENCE_ENTRY                       Entry;
+  UINT8                                     CertChainHash[MAX_HASH_SIZE];
+  BOOLEAN                                   Exported[SPDM_EVIDENCE_TYPE_COUNT];
+  UINTN                                     HashSize;
+  UINTN                                     EntryCount;
+  UINTN                                     TotalSize;
+  UINTN                                     Offset;
+  UINTN                                     Index;
+
+  SpdmContext = Context;
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+
+  if (ConnectionInfo->PeerUsedCertChainBufferSize == 0) {
+    return RETURN_NOT_STARTED;
+  }
+  HashSize = GetSpdmHashSize (ConnectionInfo->Algorithm.BaseHashAlgo);
+  if (!SpdmHashAll (ConnectionInfo->Algorithm.BaseHashAlgo, ConnectionInfo->PeerUsedCertChainBuffer, ConnectionInfo->PeerUsedCertChainBufferSize, CertChainHash)) {
+    return RETURN_NOT_STARTED;
+  }
+
+  //
+  // Only the transcripts signed with the key of the current peer certificate chain are exported.
+  //
+  EntryCount = 0;
+  TotalSize = sizeof(SPDM_EVIDENCE_HEADER) + HashSize + ConnectionInfo->PeerUsedCertChainBufferSize;
+  for (Index = 0; Index < SPDM_EVIDENCE_TYPE_COUNT; Index++) {
+    Record = &SpdmContext->Evidence.Record[Index];
+    Exported[Index] = (BOOLEAN)(Record->Verified && (CompareMem (Record->PeerCertChainHash, CertChainHash, HashSize) == 0));
+    if (Exported[Index]) {
+      TotalSize += sizeof(SPDM_EVIDENCE_ENTRY) + GetManagedBufferSize (&Record->Transcript) + Record->SignatureSize;
+      EntryCount++;
+    }
+  }
+  if (EntryCount == 0) {
+    return RETURN_NOT_FOUND;
+  }
+  if (*EvidenceSize < TotalSize) {
+    *EvidenceSize = TotalSize;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  Header = Evidence;
+  ZeroMem (Header, sizeof(SPDM_EVIDENCE_HEADER));
+  Header->Signature = SPDM_EVIDENCE_SIGNATURE;
+  Header->Version = SPDM_EVIDENCE_VERSION;
+  Header->MeasurementSpec = ConnectionInfo->Algorithm.MeasurementSpec;
+  Header->EntryCount = (UINT16)EntryCount;
+  Header->BaseHashAlgo = ConnectionInfo->Algorithm.BaseHashAlgo;
+  Header->BaseAsymAlgo = ConnectionInfo->Algorithm.BaseAsymAlgo;
+  Header->MeasurementHashAlgo = ConnectionInfo->Algorithm.MeasurementHashAlgo;
+  Header->PeerCertChainSize = (UINT32)ConnectionInfo->PeerUsedCertChainBufferSize;
+
+  Offset = sizeof(SPDM_EVIDENCE_HEADER);
+  AppendBuffer (Evidence, TotalSize, &Offset, CertChainHash, HashSize);
+  AppendBuffer (Evidence, TotalSize, &Offset, ConnectionInfo->PeerUsedCertChainBuffer, ConnectionInfo->PeerUsedCertChainBufferSize);
+  for (Index = 0; Index < SPDM_EVIDENCE_TYPE_COUNT; Index++) {
+    if (!Exported[Index]) {
+      continue;
+    }
+    Record = &SpdmContext->Evidence.Record[Index];
+    ZeroMem (&Entry, sizeof(Entry));
+    Entry.Type = (UINT8)Index;
+    Entry.TranscriptSize = (UINT32)GetManagedBufferSize (&Record->Transcript);
+    Entry.ResponseOffset = (UINT32)Record->ResponseOffset;
+    Entry.SignatureSize = (UINT32)Record->SignatureSize;
+    AppendBuffer (Evidence, TotalSize, &Offset, &Entry, sizeof(Entry));
+    AppendBufferManagedBufferData (Evidence, TotalSize, &Offset, &Record->Transcript);
+    AppendBuffer (Evidence, TotalSize, &Offset, Record->Signature, Record->SignatureSize);
+  }
+  ASSERT (Offset == TotalSize);
+
+  *EvidenceSize = TotalSize;
+  return RETURN_SUCCESS;
+#else
+  return RETURN_UNSUPPORTED;
+#endif
+}
+
+/**
+  Check the signed response of an entry of an evidence, before its signature is verified.
+
+  @param  Entry                        The entry of the evidence.
+  @param  Transcript                   The transcript of the entry.
+  @param  CertChainHash                The digest of the peer certificate chain of the evidence.
+  @param  HashSize                     Size in bytes of the digest.
+
+  @retval TRUE   The response is the signed response of the type of the entry.
+  @retval FALSE  The response is malformed, or the CertChainHash of a CHALLENGE_AUTH is not the one of the evidence.
+**/
+BOOLEAN
+SpdmCheckEvidenceResponse (
+  IN     SPDM_EVIDENCE_ENTRY       *Entry,
+  IN     UINT8                     *Transcript,
+  IN     UINT8                     *CertChainHash,
+  IN     UINTN                     HashSize
+  )
+{
+  SPDM_MESSAGE_HEADER                       *Response;
+  UINTN                                     ResponseSize;
+
+  if (Entry->ResponseOffset > Entry->TranscriptSize) {
+    return FALSE;
+  }
+  Response = (SPDM_MESSAGE_HEADER *)(Transcript + Entry->ResponseOffset);
+  ResponseSize = Entry->TranscriptSize - Entry->ResponseOffset;
+
+  switch (Entry->Type) {
+  case SPDM_EVIDENCE_TYPE_CHALLENGE_AUTH:
+    if ((ResponseSize < sizeof(SPDM_CHALLENGE_AUTH_RESPONSE) + HashSize) ||
+        (Response->RequestResponseCode != SPDM_CHALLENGE_AUTH)) {
+      return FALSE;
+    }
+    return (BOOLEAN)(CompareMem ((SPDM_CHALLENGE_AUTH_RESPONSE *)Response + 1, CertChainHash, HashSize) == 0);
+  case SPDM_EVIDENCE_TYPE_MEASUREMENTS:
+    return (BOOLEAN)((ResponseSize >= sizeof(SPDM_MEASUREMENTS_RESPONSE)) &&
+                     (Response->RequestResponseCode == SPDM_MEASUREMENTS));
+  default:
+    return FALSE;
+  }
+}
+
+/**
+  Verify an evidence exported by SpdmExportEvidence, without any SPDM message.
+
+  The peer certificate chain is verified, and its root certificate must have the digest RootCertHash.
+  Each signed transcript is verified with the public key of the leaf certificate.
+  The CertChainHash of a CHALLENGE_AUTH must be the digest of the peer certificate chain.
+  The measurement blocks are read from the MEASUREMENTS at the ResponseOffset of its entry once it is verified.
+
+  @param  EvidenceSize                 Size in bytes of the evidence.
+  @param  Evidence                     A pointer to the evidence.
+  @param  RootCertHash                 The digest of the trusted root certificate, with the BaseHashAlgo of the evidence.
+  @param  RootCertHashSize             Size in bytes of the digest of the trusted root certificate.
+
+  @retval RETURN_SUCCESS               The evidence is verified.
+  @retval RETURN_INVALID_PARAMETER     RootCertHash is NULL.
+  @retval RETURN_UNSUPPORTED           The evidence is malformed, exported by another version of the library,
+                                       or uses an algorithm that is not supported.
+  @retval RETURN_SECURITY_VIOLATION    The certificate chain or a signature cannot be verified.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmVerifyEvidence (
+  IN     UINTN                     EvidenceSize,
+  IN     VOID                      *Evidence,
+  IN     VOID                      *RootCertHash,
+  IN     UINTN                     RootCertHashSize
+  )
+{
+  SPDM_EVIDENCE_HEADER                      *Header;
+  SPDM_EVIDENCE_ENTRY                       *Entry;
+  UINT8                                     *Ptr;
+  UINT8                                     *End;
+  UINT8                                     *CertChainHash;
+  UINT8                                     *CertChain;
+  UINT8                                     *Transcript;
+  UINT8                                     *Signature;
+  UINT8                                     Hash[MAX_HASH_SIZE];
+  SPDM_CERT_CHAIN_VIEW                      View;
+  VOID                                      *PublicKey;
+  UINTN                                     HashSize;
+  UINTN                                     SignatureSize;
+  UINTN                                     Index;
+  RETURN_STATUS                             Status;
+
+  if (RootCertHash == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (EvidenceSize < sizeof(SPDM_EVIDENCE_HEADER)) {
+    return RETURN_UNSUPPORTED;
+  }
+  Header = Evidence;
+  if ((Header->Signature != SPDM_EVIDENCE_SIGNATURE) ||
+      (Header->Version != SPDM_EVIDENCE_VERSION) ||
+      (Header->EntryCount == 0)) {
+    return RETURN_UNSUPPORTED;
+  }
+  HashSize = GetSpdmHashSize (Header->BaseHashAlgo);
+  SignatureSize = GetSpdmAsymSignatureSize (Header->BaseAsymAlgo);
+  if ((HashSize == 0) || (SignatureSize == 0)) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  Ptr = (UINT8 *)(Header + 1);
+  End = (UINT8 *)Evidence + EvidenceSize;
+  if ((UINTN)(End - Ptr) < HashSize ||
+      (UINTN)(End - Ptr) - HashSize < Header->PeerCertChainSize ||
+      (Header->PeerCertChainSize <= sizeof(SPDM_CERT_CHAIN) + HashSize)) {
+    return RETURN_UNSUPPORTED;
+  }
+  CertChainHash = Ptr;
+  Ptr += HashSize;
+  CertChain = Ptr;
+  Ptr += Header->PeerCertChainSize;
+
+  //
+  // The certificate chain is trusted through its root certificate, as SpdmVerifyPeerCertChainBuffer does.
+  //
+  if (!SpdmHashAll (Header->BaseHashAlgo, CertChain, Header->PeerCertChainSize, Hash) ||
+      (CompareMem (Hash, CertChainHash, HashSize) != 0)) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+  if ((RootCertHashSize != HashSize) ||
+      (CompareMem (CertChain + sizeof(SPDM_CERT_CHAIN), RootCertHash, HashSize) != 0)) {
+    DEBUG((DEBUG_INFO, "!!! VerifyEvidence - FAIL (root hash mismatch) !!!\n"));
+    return RETURN_SECURITY_VIOLATION;
+  }
+  if (!SpdmVerifyCertificateChainBuffer (Header->BaseHashAlgo, CertChain, Header->PeerCertChainSize)) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+  if (!SpdmCertChainViewInit (&View, CertChain + sizeof(SPDM_CERT_CHAIN) + HashSize, Header->PeerCertChainSize - (sizeof(SPDM_CERT_CHAIN) + HashSize))) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+  if (!SpdmAsymGetPublicKeyFromX509 (Header->BaseAsymAlgo, View.Leaf.Cert, View.Leaf.CertSize, &PublicKey)) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+
+  Status = RETURN_SUCCESS;
+  for (Index = 0; Index < Header->EntryCount; Index++) {
+    if ((UINTN)(End - Ptr) < sizeof(SPDM_EVIDENCE_ENTRY)) {
+      Status = RETURN_UNSUPPORTED;
+      break;
+    }
+    Entry = (SPDM_EVIDENCE_ENTRY *)Ptr;
+    Ptr += sizeof(SPDM_EVIDENCE_ENTRY);
+    if ((Entry->SignatureSize != SignatureSize) ||
+        ((UINTN)(End - Ptr) < Entry->TranscriptSize) ||
+        ((UINTN)(End - Ptr) - Entry->TranscriptSize < Entry->SignatureSize)) {
+      Status = RETURN_UNSUPPORTED;
+      break;
+    }
+    Transcript = Ptr;
+    Ptr += Entry->TranscriptSize;
+    Signature = Ptr;
+    Ptr += Entry->SignatureSize;
+
+    if (!SpdmCheckEvidenceResponse (Entry, Transcript, CertChainHash, HashSize)) {
+      Status = RETURN_SECURITY_VIOLATION;
+      break;
+    }
+    if (!SpdmAsymVerify (Header->BaseAsymAlgo, Header->BaseHashAlgo, PublicKey, Transcript, Entry->TranscriptSize, Signature, Entry->SignatureSize)) {
+      DEBUG((DEBUG_INFO, "!!! VerifyEvidence - FAIL (entry %d) !!!\n", Index));
+      Status = RETURN_SECURITY_VIOLATION;
+      break;
+    }
+  }
+  if (!RETURN_ERROR(Status) && (Ptr != End)) {
+    Status = RETURN_UNSUPPORTED;
+  }
+  SpdmAsymFree (Header->BaseAsymAlgo, PublicKey);
+
+  if (!RETURN_ERROR(Status)) {
+    DEBUG((DEBUG_INFO, "!!! VerifyEvidence - PASS !!!\n"));
+  }
+  return Status;
+}
@@ -15,6 +15,157 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define INVALID_SESSION_ID  0
 
+//
+// The capability flags whose handlers are not built, cleared from the local capability flags.
+// The requester and responder flags of these capabilities are the same bits.
+//
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
+#define SPDM_PRUNED_PSK_CAP_FLAGS       0
+#else
+#define SPDM_PRUNED_PSK_CAP_FLAGS       SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP
+#endif
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
+#define SPDM_PRUNED_MUT_AUTH_CAP_FLAGS  0
+#else
+#define SPDM_PRUNED_MUT_AUTH_CAP_FLAGS  SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MUT_AUTH_CAP
+#endif
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
+#define SPDM_PRUNED_ENCAP_CAP_FLAGS     0
+#else
+#define SPDM_PRUNED_ENCAP_CAP_FLAGS     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCAP_CAP
+#endif
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
+#define SPDM_PRUNED_KEY_UPD_CAP_FLAGS   0
+#else
+#define SPDM_PRUNED_KEY_UPD_CAP_FLAGS   SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_UPD_CAP
+#endif
+#if OPENSPDM_HBEAT_CAP_SUPPORT == 1
+#define SPDM_PRUNED_HBEAT_CAP_FLAGS     0
+#else
+#define SPDM_PRUNED_HBEAT_CAP_FLAGS     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP
+#endif
+#define SPDM_PRUNED_CAPABILITY_FLAGS    (SPDM_PRUNED_PSK_CAP_FLAGS | SPDM_PRUNED_MUT_AUTH_CAP_FLAGS | SPDM_PRUNED_ENCAP_CAP_FLAGS | \
+                                         SPDM_PRUNED_KEY_UPD_CAP_FLAGS | SPDM_PRUNED_HBEAT_CAP_FLAGS)
+
+//
+// The SHA3 base hash algorithms. There is no HMAC or HKDF over SHA3, so they cannot be the base hash.
+//
+#define SPDM_SHA3_BASE_HASH_ALGO  (SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256 | \
+                                   SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384 | \
+                                   SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512)
+
+//
+// TRUE if the debug hex dumps of the Category are enabled, checked before any work is done for a dump.
+//
+#if !defined(MDEPKG_NDEBUG)
+#define SPDM_DEBUG_DUMP_ENABLED(SpdmContext, Category) \
+  ((((SpdmContext)->LocalContext.DebugDumpMask & (Category)) != 0) && DebugPrintLevelEnabled (DEBUG_INFO))
+#else
+#define SPDM_DEBUG_DUMP_ENABLED(SpdmContext, Category)  FALSE
+#endif
+
+//
+// The static tracepoints at the protocol phase boundaries. Name is a probe name, such as request_send.
+//   SPDM_TRACEPOINT_MESSAGE (Name, SessionId, RequestResponseCode, MessageSize)
+//   SPDM_TRACEPOINT_CODEC (Name, SessionId, MessageSize, TransportMessageSize)
+//   SPDM_TRACEPOINT_CRYPTO (Name, SessionId, DataSize)
+//   SPDM_TRACEPOINT_SESSION_STATE (SessionId, OldSessionState, NewSessionState)
+//
+#if (OPENSPDM_TRACEPOINT_SUPPORT == 1) && defined(__linux__)
+#include <sys/sdt.h>
+#define SPDM_TRACEPOINT_MESSAGE(Name, SessionId, Code, Size) \
+  DTRACE_PROBE3 (openspdm, Name, (UINT32)(SessionId), (UINT8)(Code), (UINTN)(Size))
+#define SPDM_TRACEPOINT_CODEC(Name, SessionId, Size, TransportSize) \
+  DTRACE_PROBE3 (openspdm, Name, (UINT32)(SessionId), (UINTN)(Size), (UINTN)(TransportSize))
+#define SPDM_TRACEPOINT_CRYPTO(Name, SessionId, Size) \
+  DTRACE_PROBE2 (openspdm, Name, (UINT32)(SessionId), (UINTN)(Size))
+#define SPDM_TRACEPOINT_SESSION_STATE(SessionId, OldState, NewState) \
+  DTRACE_PROBE3 (openspdm, session_state, (UINT32)(SessionId), (UINT32)(OldState), (UINT32)(NewState))
+#elif (OPENSPDM_TRACEPOINT_SUPPORT == 1) && defined(_MSC_VER)
+//
+// The TraceLogging events are written in SpdmCommonLibTracepoint.c, which includes the Windows headers.
+//
+VOID
+SpdmTracepointMessage (
+  IN CONST CHAR8  *Name,
+  IN UINT32       SessionId,
+  IN UINT8        Code,
+  IN UINTN        Size
+  );
+
+VOID
+SpdmTracepointCodec (
+  IN CONST CHAR8  *Name,
+  IN UINT32       SessionId,
+  IN UINTN        Size,
+  IN UINTN        TransportSize
+  );
+
+VOID
+SpdmTracepointCrypto (
+  IN CONST CHAR8  *Name,
+  IN UINT32       SessionId,
+  IN UINTN        Size
+  );
+
+VOID
+SpdmTracepointSessionState (
+  IN UINT32       SessionId,
+  IN UINT32       OldState,
+  IN UINT32       NewState
+  );
+
+#define SPDM_TRACEPOINT_MESSAGE(Name, SessionId, Code, Size) \
+  SpdmTracepointMessage (#Name, (UINT32)(SessionId), (UINT8)(Code), (UINTN)(Size))
+#define SPDM_TRACEPOINT_CODEC(Name, SessionId, Size, TransportSize) \
+  SpdmTracepointCodec (#Name, (UINT32)(SessionId), (UINTN)(Size), (UINTN)(TransportSize))
+#define SPDM_TRACEPOINT_CRYPTO(Name, SessionId, Size) \
+  SpdmTracepointCrypto (#Name, (UINT32)(SessionId), (UINTN)(Size))
+#define SPDM_TRACEPOINT_SESSION_STATE(SessionId, OldState, NewState) \
+  SpdmTracepointSessionState ((UINT32)(SessionId), (UINT32)(OldState), (UINT32)(NewState))
+#else
+#define SPDM_TRACEPOINT_MESSAGE(Name, SessionId, Code, Size)
+#define SPDM_TRACEPOINT_CODEC(Name, SessionId, Size, TransportSize)
+#define SPDM_TRACEPOINT_CRYPTO(Name, SessionId, Size)
+#define SPDM_TRACEPOINT_SESSION_STATE(SessionId, OldState, NewState)
+#endif
+
+//
+// The tag of the pool allocations of the current thread, with the phase values of POOL_ALLOCATION_PHASE_*.
+// SetPoolAllocationTag is provided by the MemoryAllocationLib of the OS.
+//
+#define SPDM_ALLOCATION_PHASE_REQUESTER  1
+#define SPDM_ALLOCATION_PHASE_RESPONDER  2
+
+#if OPENSPDM_ALLOCATION_AUDIT_SUPPORT == 1
+VOID
+EFIAPI
+SetPoolAllocationTag (
+  IN UINT8  RequestCode,
+  IN UINT8  Phase
+  );
+
+#define SPDM_ALLOCATION_TAG(RequestCode, Phase)  SetPoolAllocationTag ((UINT8)(RequestCode), (Phase))
+#else
+#define SPDM_ALLOCATION_TAG(RequestCode, Phase)
+#endif
+
+//
+// Bind the crypto statistics of an SPDM context to the current thread.
+//
+#if OPENSPDM_CRYPTO_STATS_SUPPORT == 1
+#define SPDM_CRYPTO_STATS_BIND(SpdmContext) \
+  SpdmCryptoStatsBind (&(SpdmContext)->CryptoStats, (SPDM_CRYPTO_GET_CYCLE_FUNC)(SpdmContext)->CryptoGetCycleFunc)
+#else
+#define SPDM_CRYPTO_STATS_BIND(SpdmContext)
+#endif
+
+//
+// The RequestResponseCode of an SPDM message, or 0 if the message is too small to carry one.
+//
+#define SPDM_TRACEPOINT_MESSAGE_CODE(Message, MessageSize) \
+  (((MessageSize) >= sizeof(SPDM_MESSAGE_HEADER)) ? ((SPDM_MESSAGE_HEADER *)(Message))->RequestResponseCode : 0)
+
 typedef struct {
   UINT8                SpdmVersionCount;
   SPDM_VERSION_NUMBER  SpdmVersion[MAX_SPDM_VERSION_COUNT];
@@ -36,6 +187,19 @@ typedef struct {
   UINT16               KeySchedule;
 } SPDM_DEVICE_ALGORITHM;
 
+//
+// The opaque data of KEY_EXCHANGE/PSK_EXCHANGE: one DMTF element with one secured message version, 4-byte aligned.
+//
+#define SPDM_OPAQUE_DATA_SUPPORTED_VERSION_UNPADDED_SIZE  (sizeof(SECURED_MESSAGE_GENERAL_OPAQUE_DATA_TABLE_HEADER) + \
+                                                           sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_TABLE_HEADER) + \
+                                                           sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_SUPPORTED_VERSION) + \
+                                                           sizeof(SPDM_VERSION_NUMBER))
+#define SPDM_OPAQUE_DATA_SUPPORTED_VERSION_SIZE           ((SPDM_OPAQUE_DATA_SUPPORTED_VERSION_UNPADDED_SIZE + 3) & ~3)
+#define SPDM_OPAQUE_DATA_VERSION_SELECTION_UNPADDED_SIZE  (sizeof(SECURED_MESSAGE_GENERAL_OPAQUE_DATA_TABLE_HEADER) + \
+                                                           sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_TABLE_HEADER) + \
+                                                           sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_VERSION_SELECTION))
+#define SPDM_OPAQUE_DATA_VERSION_SELECTION_SIZE           ((SPDM_OPAQUE_DATA_VERSION_SELECTION_UNPADDED_SIZE + 3) & ~3)
+
 typedef struct {
   //
   // Local device info
@@ -45,6 +209,15 @@ typedef struct {
   SPDM_DEVICE_ALGORITHM           Algorithm;
   SPDM_DEVICE_VERSION             SecuredMessageVersion;
   //
+  // The opaque data serialized from SecuredMessageVersion by SpdmUpdateOpaqueData,
+  // copied to KEY_EXCHANGE/PSK_EXCHANGE and compared with the peer opaque data.
+  // The size is 0 if SecuredMessageVersion is empty.
+  //
+  UINT8                           OpaqueDataSupportedVersion[SPDM_OPAQUE_DATA_SUPPORTED_VERSION_SIZE];
+  UINTN                           OpaqueDataSupportedVersionSize;
+  UINT8                           OpaqueDataVersionSelection[SPDM_OPAQUE_DATA_VERSION_SELECTION_SIZE];
+  UINTN                           OpaqueDataVersionSelectionSize;
+  //
   // My Certificate
   //
   VOID                            *LocalCertChainProvision[MAX_SPDM_SLOT_COUNT];
@@ -52,6 +225,16 @@ typedef struct {
   UINT8                           SlotCount;
   // My provisioned certificate (for SlotNum - 0xFF, default 0)
   UINT8                           ProvisionedSlotNum;
+  // My provisioned public key (for SlotNum - 0xFF, in place of the certificate)
+  VOID                            *LocalPublicKeyProvision;
+  UINTN                           LocalPublicKeyProvisionSize;
+  //
+  // My private key handles, loaded by the integrator (not owned by the context)
+  //
+  VOID                            *LocalPrivateKey;
+  UINT32                          LocalPrivateKeyAsymAlgo;
+  VOID                            *LocalReqPrivateKey;
+  UINT16                          LocalReqPrivateKeyAsymAlgo;
   //
   // Peer Root Certificate Hash
   //
@@ -62,11 +245,18 @@ typedef struct {
   //
   VOID                            *PeerCertChainProvision;
   UINTN                           PeerCertChainProvisionSize;
+  //
+  // Peer PublicKey (for SlotNum - 0xFF, in place of the certificate chain)
+  //
+  VOID                            *PeerPublicKeyProvision;
+  UINTN                           PeerPublicKeyProvisionSize;
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
   //
   // PSK provision locally
   //
   UINTN                           PskHintSize;
   VOID                            *PskHint;
+#endif
   //
   // OpaqueData provision locally
   //
@@ -74,19 +264,185 @@ typedef struct {
   UINT8                           *OpaqueChallengeAuthRsp;
   UINTN                           OpaqueMeasurementRspSize;
   UINT8                           *OpaqueMeasurementRsp;
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   //
   // Responder policy
   //
   BOOLEAN                         BasicMutAuthRequested;
   UINT8                           MutAuthRequested;
+#endif
+  //
+  // Requester policy
+  //
+  UINT32                          MeasurementCacheMaxAge;
+  UINT64                          TransportRoundTripTime;
+  //
+  // Transport limits
+  //
+  UINT32                          TransportMaxMessageSize;
+  //
+  // Transport connection
+  //
+  UINT16                          TransportConnectionId;
+  //
+  // The categories of the debug hex dumps
+  //
+  UINT32                          DebugDumpMask;
 } SPDM_LOCAL_CONTEXT;
 
+//
+// The digests of a local certificate chain for the negotiated BaseHashAlgo, computed on first use.
+// CertChainHash covers the SPDM_CERT_CHAIN header, as in DIGESTS, CHALLENGE_AUTH and KEY_EXCHANGE_RSP.
+// CertChainDataHash covers the certificate chain data without the header, as Ct in TH.
+// The entry is valid for the chain buffer it is computed from, until the slot is provisioned again.
+//
+typedef struct {
+  UINT32                          BaseHashAlgo;
+  CONST VOID                      *CertChain;
+  UINTN                           CertChainSize;
+  UINT8                           CertChainHash[MAX_HASH_SIZE];
+  UINT8                           CertChainDataHash[MAX_HASH_SIZE];
+} SPDM_LOCAL_CERT_CHAIN_DIGEST;
+
+//
+// A device profile precomputes the local certificate chain digests for each BaseHashAlgo bit.
+//
+#define SPDM_DEVICE_PROFILE_HASH_ALGO_COUNT  6
+
+typedef struct {
+  SPDM_LOCAL_CONTEXT              LocalContext;
+  //
+  // The digests of the local certificate chains, per BaseHashAlgo bit and slot.
+  // CertChainDigestHashAlgo is the bitmask of the BaseHashAlgo they are computed for.
+  //
+  UINT32                          CertChainDigestHashAlgo;
+  UINT8                           CertChainDigest[SPDM_DEVICE_PROFILE_HASH_ALGO_COUNT][MAX_SPDM_SLOT_COUNT][MAX_HASH_SIZE];
+} SPDM_DEVICE_PROFILE;
+
+//
+// One verified peer certificate chain in a certificate chain verification cache.
+// PublicKey is the leaf public key, shared by all connections referencing the entry.
+// CertChain is kept so that a matching GET_DIGESTS digest can skip GET_CERTIFICATE.
+//
+typedef struct {
+  BOOLEAN                         Valid;
+  UINT32                          BaseHashAlgo;
+  UINT8                           CertChainHash[MAX_HASH_SIZE];
+  UINT8                           CertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+  UINTN                           CertChainSize;
+  UINT8                           LeafCertHash[MAX_HASH_SIZE];
+  UINTN                           LastUse;
+  UINTN                           RefCount;
+  VOID                            *PublicKey;
+  BOOLEAN                         PublicKeyIsReqAsym;
+  UINT32                          PublicKeyAsymAlgo;
+} SPDM_CERT_CHAIN_CACHE_ENTRY;
+
+#define SPDM_SHARED_CERT_CHAIN_CACHE_SIGNATURE  SIGNATURE_32 ('S', 'P', 'S', 'C')
+#define SPDM_SHARED_CERT_CHAIN_CACHE_VERSION    1
+
+//
+// The size of a DER-encoded SubjectPublicKeyInfo of up to MAX_ASYM_KEY_SIZE, with its encoding overhead.
+//
+#define MAX_SPDM_SHARED_PUBLIC_KEY_INFO_SIZE    (MAX_ASYM_KEY_SIZE + 0x40)
+
+//
+// The number of entries probed for a certificate chain, from the entry selected by its hash.
+//
+#define SPDM_SHARED_CERT_CHAIN_CACHE_PROBE_COUNT  4
+
+//
+// The number of times a reader reads an entry being updated again, before it takes it as a miss.
+//
+#define SPDM_SHARED_CERT_CHAIN_CACHE_READ_RETRY   4
+
+//
+// One verified peer certificate chain in a shared certificate chain verification cache.
+// Sequence is odd while the writer updates the entry, and readers copy the entry until they see
+// the same even Sequence before and after the copy.
+// PublicKeyInfo is the DER-encoded SubjectPublicKeyInfo of the leaf certificate, which any process
+// can parse, or empty if it is not known.
+//
+typedef struct {
+  volatile UINT32                 Sequence;
+  volatile UINT32                 LastUse;
+  UINT32                          BaseHashAlgo;
+  UINT32                          PublicKeyInfoSize;
+  UINT8                           CertChainHash[MAX_HASH_SIZE];
+  UINT8                           LeafCertHash[MAX_HASH_SIZE];
+  UINT8                           PublicKeyInfo[MAX_SPDM_SHARED_PUBLIC_KEY_INFO_SIZE];
+} SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY;
+
+//
+// A certificate chain verification cache in memory shared by processes, which may map it at different addresses.
+// It holds no pointer. EntrySize lets a process built with other limits refuse to attach to it.
+// The entries follow the cache header.
+//
+typedef struct {
+  UINT32                          Signature;
+  UINT32                          Version;
+  UINT32                          EntrySize;
+  UINT32                          EntryCount;
+  volatile UINT32                 WriterLock;
+  volatile UINT32                 PublishCount;
+} SPDM_SHARED_CERT_CHAIN_CACHE;
+
+//
+// The entries follow the cache header.
+// Shared is the shared certificate chain verification cache behind the cache, or NULL.
+//
+typedef struct {
+  UINTN                           EntryCount;
+  UINTN                           UseCount;
+  SPDM_CERT_CHAIN_CACHE_LOCK_FUNC AcquireLock;
+  SPDM_CERT_CHAIN_CACHE_LOCK_FUNC ReleaseLock;
+  VOID                            *LockContext;
+  SPDM_SHARED_CERT_CHAIN_CACHE    *Shared;
+} SPDM_CERT_CHAIN_CACHE;
+
+//
+// One verified peer measurement block in the measurement cache of a connection.
+// Age counts the requests served from the entry since the block was verified.
+//
+typedef struct {
+  BOOLEAN                         Valid;
+  UINT32                          Age;
+  UINT32                          BlockSize;
+  UINT8                           Block[sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + MAX_HASH_SIZE];
+} SPDM_MEASUREMENT_CACHE_ENTRY;
+
+//
+// The entries are indexed by the measurement index - 1.
+// SummaryHash is the last measurement summary hash of CHALLENGE_AUTH or KEY_EXCHANGE_RSP.
+// LearnedBlockCount is the number of measurement blocks of the device, or 0 if it is not known yet,
+// and LearnedBlockSize is the size of each block in the last MEASUREMENTS carrying it, or 0.
+// They are learned whether the cache is enabled or not, for SpdmGetMeasurementRange.
+//
+typedef struct {
+  UINT8                           SummaryHashType;
+  UINT8                           SummaryHash[MAX_HASH_SIZE];
+  SPDM_MEASUREMENT_CACHE_ENTRY    Entry[MAX_SPDM_MEASUREMENT_BLOCK_COUNT];
+  UINT8                           LearnedBlockCount;
+  UINT32                          LearnedBlockSize[MAX_SPDM_MEASUREMENT_BLOCK_COUNT];
+} SPDM_MEASUREMENT_CACHE;
+
+//
+// Preparing an ECDSA public key costs about five verifications, so the responder public key is prepared
+// only once it verifies this number of signatures, such as a series of signed measurements.
+//
+#define SPDM_PEER_PUBLIC_KEY_PREPARE_THRESHOLD  4
+
 typedef struct {
   //
   // Connection State
   //
   SPDM_CONNECTION_STATE           ConnectionState;
   //
+  // TRUE if the negotiated state is imported by SpdmImportNegotiatedState,
+  // so that SpdmInitConnection does not run GET_VERSION, GET_CAPABILITIES and NEGOTIATE_ALGORITHMS again.
+  //
+  BOOLEAN                         NegotiatedStateImported;
+  //
   // Peer device info (negotiated)
   //
   SPDM_DEVICE_VERSION             Version;
@@ -95,16 +451,122 @@ typedef struct {
   SPDM_DEVICE_VERSION             SecuredMessageVersion;
   //
   // Peer CertificateChain
+  // PeerUsedCertChainBuffer is the inline region of the SPDM context, PeerCertChainInlineBufferSize bytes,
+  // or the buffer registered by SpdmRegisterPeerCertChainBuffer.
   //
-  UINT8                           PeerUsedCertChainBuffer[MAX_SPDM_CERT_CHAIN_SIZE];
+  UINT8                           *PeerUsedCertChainBuffer;
   UINTN                           PeerUsedCertChainBufferSize;
+  UINTN                           MaxPeerUsedCertChainBufferSize;
+  UINTN                           PeerCertChainInlineBufferSize;
+  //
+  // Size in bytes of the certificate chain portions collected in PeerUsedCertChainBuffer by GET_CERTIFICATE.
+  // PeerUsedCertChainBufferSize is 0 until the collected certificate chain is verified.
+  //
+  UINTN                           PeerCertChainCollectedSize;
   //
   // Local Used CertificateChain (for responder, or requester in mut auth)
   //
   UINT8                           *LocalUsedCertChainBuffer;
   UINTN                           LocalUsedCertChainBufferSize;
+  //
+  // Peer leaf public key, parsed once and reused for every signature of the connection.
+  // PeerPublicKeyCertHash is the hash of the leaf certificate the key was parsed from.
+  //
+  VOID                            *PeerPublicKey;
+  BOOLEAN                         PeerPublicKeyShared;
+  BOOLEAN                         PeerPublicKeyIsReqAsym;
+  UINT32                          PeerPublicKeyAsymAlgo;
+  UINT32                          PeerPublicKeyHashAlgo;
+  UINT8                           PeerPublicKeyCertHash[MAX_HASH_SIZE];
+  //
+  // The responder public key prepared for repeated verification, and the number of signatures it has verified.
+  // It is prepared once the key verifies SPDM_PEER_PUBLIC_KEY_PREPARE_THRESHOLD signatures, and released with the key.
+  //
+  VOID                            *PeerPreparedPublicKey;
+  UINTN                           PeerPublicKeyVerifyCount;
+  //
+  // The certificate chain verification cache entry of the peer certificate chain.
+  //
+  SPDM_CERT_CHAIN_CACHE_ENTRY     *PeerCertChainCacheEntry;
+  //
+  // Peer certificate chain digests of the last DIGESTS response, one per bit set in PeerDigestSlotMask.
+  //
+  UINT8                           PeerDigestSlotMask;
+  UINT8                           PeerDigestBuffer[MAX_HASH_SIZE * MAX_SPDM_SLOT_COUNT];
+  //
+  // Peer measurement blocks verified by SpdmGetMeasurement.
+  //
+  SPDM_MEASUREMENT_CACHE          MeasurementCache;
 } SPDM_CONNECTION_INFO;
 
+#define SPDM_EXPORTED_NEGOTIATED_STATE_SIGNATURE  SIGNATURE_32('S', 'P', 'N', 'S')
+#define SPDM_EXPORTED_NEGOTIATED_STATE_VERSION    1
+
+//
+// The negotiated state exported by SpdmExportNegotiatedState.
+// Message A and the peer certificate chain buffer follow the structure.
+//
+typedef struct {
+  UINT32                          Signature;
+  UINT32                          Version;
+  SPDM_DEVICE_VERSION             SpdmVersion;
+  SPDM_DEVICE_CAPABILITY          Capability;
+  SPDM_DEVICE_ALGORITHM           Algorithm;
+  SPDM_DEVICE_VERSION             SecuredMessageVersion;
+  UINT8                           PeerDigestSlotMask;
+  UINT8                           PeerDigestBuffer[MAX_HASH_SIZE * MAX_SPDM_SLOT_COUNT];
+  UINT32                          MessageASize;
+  UINT32                          PeerUsedCertChainBufferSize;
+//UINT8                           MessageA[MessageASize];
+//UINT8                           PeerUsedCertChainBuffer[PeerUsedCertChainBufferSize];
+} SPDM_EXPORTED_NEGOTIATED_STATE;
+
+#define SPDM_EXPORTED_SESSION_SIGNATURE  SIGNATURE_32('S', 'P', 'S', 'S')
+#define SPDM_EXPORTED_SESSION_VERSION    1
+
+//
+// The wrapping of an exported session, AES-256-GCM with the key of the caller.
+//
+#define SPDM_EXPORTED_SESSION_AEAD_CIPHER_SUITE  SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM
+#define SPDM_EXPORTED_SESSION_IV_SIZE            12
+#define SPDM_EXPORTED_SESSION_TAG_SIZE           16
+
+//
+// The session exported by SpdmExportSession.
+// The header is authenticated, and the SPDM_EXPORTED_SESSION_BODY that follows it is encrypted, with the wrapping key.
+//
+typedef struct {
+  UINT32                          Signature;
+  UINT32                          Version;
+  UINT32                          SessionId;
+  UINT32                          BodySize;
+  UINT8                           Iv[SPDM_EXPORTED_SESSION_IV_SIZE];
+//SPDM_EXPORTED_SESSION_BODY      Body;
+//UINT8                           Tag[SPDM_EXPORTED_SESSION_TAG_SIZE];
+} SPDM_EXPORTED_SESSION_HEADER;
+
+//
+// The connection and the session, with message A and the secrets and keys exported by the secured message library.
+//
+typedef struct {
+  SPDM_DEVICE_VERSION             SpdmVersion;
+  SPDM_DEVICE_CAPABILITY          Capability;
+  SPDM_DEVICE_ALGORITHM           Algorithm;
+  SPDM_DEVICE_VERSION             SecuredMessageVersion;
+  BOOLEAN                         UsePsk;
+  UINT8                           MutAuthRequested;
+  UINT8                           EndSessionAttributes;
+  UINT8                           HeartbeatPeriod;
+  BOOLEAN                         Privileged;
+  SPDM_KEY_UPDATE_POLICY          KeyUpdatePolicy;
+  UINT32                          MessageASize;
+  UINT32                          SecretsSize;
+  UINT32                          KeysSize;
+//UINT8                           MessageA[MessageASize];
+//UINT8                           Secrets[SecretsSize];
+//UINT8                           Keys[KeysSize];
+} SPDM_EXPORTED_SESSION_BODY;
+
 
 typedef struct {
   UINTN   MaxBufferSize;
@@ -124,6 +586,66 @@ typedef struct {
   UINT8   Buffer[MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
 } SMALL_MANAGED_BUFFER;
 
+typedef struct _SPDM_TRANSCRIPT_CHUNK SPDM_TRANSCRIPT_CHUNK;
+
+struct _SPDM_TRANSCRIPT_CHUNK {
+  SPDM_TRANSCRIPT_CHUNK  *Next;
+  UINT8                  Data[SPDM_TRANSCRIPT_CHUNK_SIZE];
+};
+
+//
+// The free chunks of an SPDM context, shared by all its segmented managed buffers.
+//
+typedef struct {
+  SPDM_TRANSCRIPT_CHUNK  *FreeList;
+  UINTN                  FreeCount;
+} SPDM_TRANSCRIPT_ARENA;
+
+//
+// The MaxBufferSize of a SEGMENTED_MANAGED_BUFFER.
+//
+#define SEGMENTED_MANAGED_BUFFER_MAX_SIZE  MAX_UINTN
+
+//
+// A managed buffer of chunks taken from the transcript arena on demand, and returned to it on reset.
+// It starts with the fields of MANAGED_BUFFER, so the managed buffer functions take it too,
+// except GetManagedBuffer. Its data is read with GetManagedBufferSegment.
+// All chunks but the Tail are full.
+//
+typedef struct {
+  UINTN                  MaxBufferSize;
+  UINTN                  BufferSize;
+  SPDM_TRANSCRIPT_ARENA  *Arena;
+  SPDM_TRANSCRIPT_CHUNK  *Head;
+  SPDM_TRANSCRIPT_CHUNK  *Tail;
+} SEGMENTED_MANAGED_BUFFER;
+
+//
+// A transcript that is kept as a running hash instead of a copy of the messages.
+// The last appended message is held back from the hash if it fits in PendingBuffer,
+// so that a request answered by an ERROR response can be withdrawn again.
+//
+typedef struct {
+  UINTN   BufferSize;
+  UINT32  BaseHashAlgo;
+  VOID    *HashContext;
+  UINTN   PendingBufferSize;
+  UINT8   PendingBuffer[sizeof(SPDM_GET_MEASUREMENTS_REQUEST)];
+} SPDM_MESSAGE_DIGEST;
+
+//
+// The running hashes of Message A, one for each base hash algorithm BIT0 to BIT5.
+// HashContext[Index] is the running hash of the base hash algorithm (1 << Index), or NULL.
+// BufferSize is the size in bytes of Message A that is hashed. The running hashes are not used
+// once it differs from the size of Message A, for example after a message is withdrawn.
+//
+#define SPDM_MESSAGE_A_DIGEST_COUNT  6
+
+typedef struct {
+  UINTN   BufferSize;
+  VOID    *HashContext[SPDM_MESSAGE_A_DIGEST_COUNT];
+} SPDM_MESSAGE_A_DIGEST;
+
 typedef struct {
   //
   // Signature = Sign(SK, Hash(M1))
@@ -138,11 +660,22 @@ typedef struct {
   // MutB = Concatenate (GET_DIGEST, DIGEST, GET_CERTFICATE, CERTIFICATE)
   // MutC = Concatenate (CHALLENGE, CHALLENGE_AUTH\Signature)
   //
+  // The requester only keeps B as the running hash of Concatenate (A, B) in MessageBDigest,
+  // so that the certificate chain messages are hashed as they arrive and M2 is not limited by the buffer size.
+  // BufferSize of MessageBDigest is the total size in bytes of the messages in B.
+  // The responder keeps B in MessageB, for the asynchronous signing functions which take M1 before hash.
+  //
   SMALL_MANAGED_BUFFER            MessageA;
-  LARGE_MANAGED_BUFFER            MessageB;
+#if OPENSPDM_MESSAGE_A_DIGEST_SUPPORT == 1
+  SPDM_MESSAGE_A_DIGEST           MessageADigest;
+#endif
+  SEGMENTED_MANAGED_BUFFER        MessageB;
+  SPDM_MESSAGE_DIGEST             MessageBDigest;
   SMALL_MANAGED_BUFFER            MessageC;
-  LARGE_MANAGED_BUFFER            MessageMutB;
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
+  SEGMENTED_MANAGED_BUFFER        MessageMutB;
   SMALL_MANAGED_BUFFER            MessageMutC;
+#endif
   //
   // Signature = Sign(SK, Hash(L1))
   // Verify(PK, Hash(L2), Signature)
@@ -150,7 +683,10 @@ typedef struct {
   // L1/L2 = Concatenate (M)
   // M = Concatenate (GET_MEASUREMENT, MEASUREMENT\Signature)
   //
-  LARGE_MANAGED_BUFFER            MessageM;
+  // M is only kept as a running hash, because any number of measurements can be retrieved before the signed one.
+  // BufferSize is the total size in bytes of the messages in M.
+  //
+  SPDM_MESSAGE_DIGEST             MessageM;
 } SPDM_TRANSCRIPT;
 
 typedef struct {
@@ -185,8 +721,8 @@ typedef struct {
   // CM = mutual certificate chain *
   // F  = Concatenate (FINISH request, FINISH response)
   //
-  LARGE_MANAGED_BUFFER            MessageK;
-  LARGE_MANAGED_BUFFER            MessageF;
+  SEGMENTED_MANAGED_BUFFER        MessageK;
+  SEGMENTED_MANAGED_BUFFER        MessageF;
   //
   // TH for PSK_EXCHANGE response HMAC: Concatenate (A, K)
   // K  = Concatenate (PSK_EXCHANGE request, PSK_EXCHANGE response\VerifyData)
@@ -206,17 +742,73 @@ typedef struct {
   // K  = Concatenate (PSK_EXCHANGE request, PSK_EXCHANGE response)
   // F  = Concatenate (PSK_FINISH request, PSK_FINISH response)
   //
+  //
+  // Running hash of TH, so that TH1/TH2 hash can be forked from it instead of rehashing the whole transcript.
+  // It covers Concatenate (A, Ct, K) until the first TH with F is calculated,
+  // and Concatenate (A, Ct, K, CM, F) from then on.
+  // SpdmAppendMessageK/SpdmAppendMessageF keep it up to date.
+  //
+  VOID                            *DigestContextTH;
+  UINT32                          DigestBaseHashAlgo;
+  UINTN                           DigestedMessageKSize;
+  UINTN                           DigestedMessageFSize;
+  BOOLEAN                         DigestIncludesMessageF;
 } SPDM_SESSION_TRANSCRIPT;
 
+//
+// The state of a session in the warm session pool of the requester.
+//
+typedef enum {
+  SpdmSessionPoolStateNone,
+  SpdmSessionPoolStateIdle,
+  SpdmSessionPoolStateInUse,
+} SPDM_SESSION_POOL_STATE;
+
 typedef struct {
   UINT32                               SessionId;
   BOOLEAN                              UsePsk;
   UINT8                                MutAuthRequested;
   UINT8                                EndSessionAttributes;
+  //
+  // The transport path of the last request of the session, to receive its response over (requester only).
+  //
+  UINT8                                RequestTransportPath;
   SPDM_SESSION_TRANSCRIPT              SessionTranscript;
+  //
+  // The secured records and bytes sent and received with the current keys, counted against KeyUpdatePolicy.
+  // The send and receive counters are separate, so that SpdmSendRequest and SpdmReceiveResponse
+  // can run on different threads.
+  //
+  SPDM_KEY_UPDATE_POLICY               KeyUpdatePolicy;
+  UINT64                               KeyUpdateSendRecordCount;
+  UINT64                               KeyUpdateSendByteCount;
+  UINT64                               KeyUpdateReceiveRecordCount;
+  UINT64                               KeyUpdateReceiveByteCount;
+  //
+  // The heartbeat period from the KEY_EXCHANGE_RSP or PSK_EXCHANGE_RSP response, in seconds, and
+  // the time the last secured message of the session is received, from the requester or responder time function.
+  // They are used by the requester to schedule the heartbeats of the session, and by the responder
+  // to reclaim the idle sessions.
+  //
+  UINT8                                HeartbeatPeriod;
+  UINT64                               LastActivityTime;
+  //
+  // The state of the session in the warm session pool (requester only).
+  // It is reset when the session is freed, so that an ended session leaves the pool.
+  //
+  SPDM_SESSION_POOL_STATE              PoolState;
+  //
+  // The session is created by a privileged requester, by the responder session privilege function (responder only).
+  //
+  BOOLEAN                              Privileged;
+  //
+  // The responder-initiated key update of the session is scheduled by SpdmScheduleKeyUpdate (responder only).
+  //
+  BOOLEAN                              KeyUpdateScheduled;
   VOID                                 *SecuredMessageContext;
 } SPDM_SESSION_INFO;
 
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
 #define MAX_ENCAP_REQUEST_OP_CODE_SEQUENCE_COUNT 3
 typedef struct {
   UINT32                               ErrorState;
@@ -229,53 +821,453 @@ typedef struct {
   UINT8                                ReqSlotNum;
   SPDM_MESSAGE_HEADER                  LastEncapRequestHeader;
   UINTN                                LastEncapRequestSize;
-  LARGE_MANAGED_BUFFER                 CertificateChainBuffer;
 } SPDM_ENCAP_CONTEXT;
+#endif
 
-#define SPDM_DEVICE_CONTEXT_VERSION 0x1
+typedef enum {
+  SpdmRequesterStepStageNone,
+  SpdmRequesterStepStageVersion,
+  SpdmRequesterStepStageCapabilities,
+  SpdmRequesterStepStageAlgorithms,
+  SpdmRequesterStepStageDigest,
+  SpdmRequesterStepStageCertificate,
+  SpdmRequesterStepStageChallenge,
+  SpdmRequesterStepStageKeyExchange,
+  SpdmRequesterStepStageFinish,
+  SpdmRequesterStepStagePskExchange,
+  SpdmRequesterStepStagePskFinish,
+  SpdmRequesterStepStageSendReceiveData,
+  SpdmRequesterStepStageMax,
+} SPDM_REQUESTER_STEP_STAGE;
 
 typedef struct {
-  UINT32                          Version;
+  SPDM_REQUESTER_STEP_STAGE            Stage;
+  // The request of the stage is sent, and its response is expected.
+  BOOLEAN                              RequestPending;
+  // The outstanding request is RESPOND_IF_READY for the request of the stage.
+  BOOLEAN                              RespondIfReady;
+  UINT8                                BusyRetryCount;
+  UINT8                                NotReadyRetryCount;
+  //
+  // Parameters of the operation
+  //
+  BOOLEAN                              GetVersionOnly;
+  BOOLEAN                              UsePsk;
+  BOOLEAN                              IsAppMessage;
+  BOOLEAN                              SessionIdValid;
+  UINT8                                SlotNum;
+  UINT8                                MeasurementHashType;
+  UINT8                                ReqSlotIdParam;
+  UINT32                               SessionId;
+  UINT8                                *SlotMask;
+  VOID                                 *TotalDigestBuffer;
+  UINTN                                *CertChainSize;
+  VOID                                 *CertChain;
+  VOID                                 *MeasurementHash;
+  UINT32                               *SessionIdOut;
+  UINT8                                *HeartbeatPeriod;
+  VOID                                 *AppRequest;
+  UINTN                                AppRequestSize;
+  VOID                                 *AppResponse;
+  UINTN                                *AppResponseSize;
+  //
+  // State of the stage
+  //
+  VOID                                 *DHEContext;
+  //
+  // MaxSpdmMessageSize bytes, laid out after the SPDM context.
+  //
+  UINT8                                *Request;
+  UINTN                                RequestSize;
+} SPDM_REQUESTER_STEP_CONTEXT;
+
+//
+// A KEY_EXCHANGE request prepared by SpdmPrestageKeyExchange (requester only).
+// The DHE key pair is generated for DHENamedGroup, and the entry is used only while it is the negotiated DHENamedGroup.
+//
+typedef struct {
+  BOOLEAN                              Valid;
+  UINT16                               DHENamedGroup;
+  VOID                                 *DHEContext;
+  UINT8                                RandomData[SPDM_RANDOM_DATA_SIZE];
+  UINT8                                ExchangeData[MAX_DHE_KEY_SIZE];
+  UINTN                                ExchangeDataSize;
+} SPDM_PRESTAGED_KEY_EXCHANGE;
+
+//
+// A response waiting for an asynchronous signature, or a request yielded by SPDM_RESPONDER_YIELD_FUNC (responder only).
+//
+typedef struct {
+  BOOLEAN                              Valid;
+  UINTN                                SignToken;
+  UINT8                                RequestCode;
+  UINT32                               SessionId;
+  UINTN                                SignatureOffset;
+  //
+  // MaxSpdmMessageSize bytes, laid out after the SPDM context.
+  //
+  UINT8                                *Response;
+  UINTN                                ResponseSize;
   //
-  // IO information
+  // The SPDM_RESPONDER_YIELD_POINT the request is continued after, 0 if the response waits for SignToken.
   //
-  SPDM_DEVICE_SEND_MESSAGE_FUNC     SendMessage;
-  SPDM_DEVICE_RECEIVE_MESSAGE_FUNC  ReceiveMessage;
+  UINT8                                YieldPoint;
   //
-  // Transport Layer infomration
+  // The state of a yielded KEY_EXCHANGE.
   //
-  SPDM_TRANSPORT_ENCODE_MESSAGE_FUNC  TransportEncodeMessage;
-  SPDM_TRANSPORT_DECODE_MESSAGE_FUNC  TransportDecodeMessage;
+  UINT8                                MeasurementHashType;
+  UINT8                                SlotNum;
+  VOID                                 *DHEContext;
+  UINT8                                PeerExchangeData[MAX_DHE_KEY_SIZE];
+} SPDM_PENDING_SIGNATURE;
+
+//
+// A signature verification of the requester, pending in SPDM_REQUESTER_VERIFY_ASYNC_FUNC if Pending is TRUE.
+//
+typedef struct {
+  BOOLEAN                              Pending;
+  UINTN                                VerifyToken;
+} SPDM_PENDING_VERIFY;
+
+//
+// A CHALLENGE_AUTH received by SpdmStartChallenge, committed by SpdmCompleteChallenge once its signature is verified.
+//
+typedef struct {
+  SPDM_PENDING_VERIFY                  Verify;
+  BOOLEAN                              Valid;
+  UINT8                                MeasurementHashType;
+  BOOLEAN                              BasicMutAuthRequested;
+  VOID                                 *MeasurementHash;
+  UINT8                                MeasurementSummaryHash[MAX_HASH_SIZE];
+} SPDM_PENDING_CHALLENGE;
+
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+//
+// A signed transcript of the requester, for SpdmExportEvidence.
+// The signed response without its signature ends the transcript, at ResponseOffset.
+// It is exported once Verified is set, and only with the peer certificate chain of digest PeerCertChainHash.
+//
+typedef struct {
+  SEGMENTED_MANAGED_BUFFER             Transcript;
+  UINTN                                ResponseOffset;
+  UINTN                                SignatureSize;
+  UINT8                                Signature[MAX_ASYM_KEY_SIZE];
+  UINT8                                PeerCertChainHash[MAX_HASH_SIZE];
+  BOOLEAN                              Verified;
+} SPDM_EVIDENCE_RECORD;
+
+//
+// The evidence of the requester.
+// MessageB and MessageM copy the messages added to the running hashes of Message B and Message M,
+// because the running hashes only give the signed digests. A copy is used only if it is as long as its running hash.
+//
+typedef struct {
+  SEGMENTED_MANAGED_BUFFER             MessageB;
+  SEGMENTED_MANAGED_BUFFER             MessageM;
+  SPDM_EVIDENCE_RECORD                 Record[SPDM_EVIDENCE_TYPE_COUNT];
+} SPDM_EVIDENCE;
+
+//
+// The number of segmented managed buffers of the evidence, that take chunks of the transcript arena.
+//
+#define SPDM_EVIDENCE_TRANSCRIPT_COUNT  (2 + SPDM_EVIDENCE_TYPE_COUNT)
+#endif
+
+//
+// The configuration of the warm session pool of the requester.
+// TargetCount sessions are kept established with the same parameters of SpdmStartSession.
+//
+typedef struct {
+  UINTN                                TargetCount;
+  BOOLEAN                              UsePsk;
+  UINT8                                MeasurementHashType;
+  UINT8                                SlotNum;
+} SPDM_SESSION_POOL_CONFIG;
+
+//
+// A session or connection state transition posted to the state event queue.
+//
+typedef struct {
+  BOOLEAN                              IsSessionEvent;
+  UINT32                               SessionId;
+  UINT32                               State;
+} SPDM_STATE_EVENT;
+
+//
+// Single-producer single-consumer ring of state transitions, without a lock.
+// Head and Tail run freely, and the entry of an index is Event[Index % MAX_SPDM_STATE_EVENT_QUEUE_DEPTH].
+// The responder writes Tail and DroppedCount, and the dispatcher writes Head and DroppedReported.
+// An entry is published by the release store of Tail, and released by the release store of Head.
+//
+typedef struct {
+  BOOLEAN                              Enabled;
+  volatile UINT32                      Head;
+  volatile UINT32                      Tail;
+  volatile UINT32                      DroppedCount;
+  UINT32                               DroppedReported;
+  SPDM_STATE_EVENT                     Event[MAX_SPDM_STATE_EVENT_QUEUE_DEPTH];
+} SPDM_STATE_EVENT_QUEUE;
+
+//
+// Load with acquire and store with release semantics, to hand entries over between threads.
+// Volatile accesses of MSVC have these semantics on x86 and x64 only, so MSVC for ARM64 uses LDAR and STLR,
+// and a DMB for the fences. Other MSVC targets are not supported.
+//
+// The fences order the plain accesses around them, and SPDM_COMPARE_EXCHANGE_32 is a full barrier
+// returning TRUE if *Ptr was Old and is replaced by New.
+//
+#if defined(__GNUC__) || defined(__clang__)
+#define SPDM_LOAD_ACQUIRE(Ptr)          __atomic_load_n ((Ptr), __ATOMIC_ACQUIRE)
+#define SPDM_STORE_RELEASE(Ptr, Value)  __atomic_store_n ((Ptr), (Value), __ATOMIC_RELEASE)
+#define SPDM_ACQUIRE_FENCE()            __atomic_thread_fence (__ATOMIC_ACQUIRE)
+#define SPDM_RELEASE_FENCE()            __atomic_thread_fence (__ATOMIC_RELEASE)
+#define SPDM_COMPARE_EXCHANGE_32(Ptr, Old, New)  ((BOOLEAN)__sync_bool_compare_and_swap ((Ptr), (Old), (New)))
+#elif defined(_M_IX86) || defined(_M_X64)
+long _InterlockedCompareExchange (long volatile *Destination, long Exchange, long Comparand);
+void _ReadWriteBarrier (void);
+#pragma intrinsic(_InterlockedCompareExchange, _ReadWriteBarrier)
+#define SPDM_LOAD_ACQUIRE(Ptr)          (*(Ptr))
+#define SPDM_STORE_RELEASE(Ptr, Value)  (*(Ptr) = (Value))
+#define SPDM_ACQUIRE_FENCE()            _ReadWriteBarrier ()
+#define SPDM_RELEASE_FENCE()            _ReadWriteBarrier ()
+#define SPDM_COMPARE_EXCHANGE_32(Ptr, Old, New)  \
+  ((BOOLEAN)((UINT32)_InterlockedCompareExchange ((long volatile *)(Ptr), (long)(New), (long)(Old)) == (UINT32)(Old)))
+#elif defined(_M_ARM64)
+long _InterlockedCompareExchange (long volatile *Destination, long Exchange, long Comparand);
+unsigned __int32 __ldar32 (unsigned __int32 volatile *Target);
+void __stlr32 (unsigned __int32 volatile *Target, unsigned __int32 Value);
+void __dmb (unsigned int Type);
+#pragma intrinsic(_InterlockedCompareExchange, __ldar32, __stlr32, __dmb)
+//
+// _ARM64_BARRIER_ISH of arm64intr.h
+//
+#define SPDM_ARM64_BARRIER_ISH          0xB
+#define SPDM_LOAD_ACQUIRE(Ptr)          __ldar32 ((unsigned __int32 volatile *)(Ptr))
+#define SPDM_STORE_RELEASE(Ptr, Value)  __stlr32 ((unsigned __int32 volatile *)(Ptr), (unsigned __int32)(Value))
+#define SPDM_ACQUIRE_FENCE()            __dmb (SPDM_ARM64_BARRIER_ISH)
+#define SPDM_RELEASE_FENCE()            __dmb (SPDM_ARM64_BARRIER_ISH)
+#define SPDM_COMPARE_EXCHANGE_32(Ptr, Old, New)  \
+  ((BOOLEAN)((UINT32)_InterlockedCompareExchange ((long volatile *)(Ptr), (long)(New), (long)(Old)) == (UINT32)(Old)))
+#else
+#error "SPDM_LOAD_ACQUIRE and SPDM_STORE_RELEASE are not defined for this compiler and target"
+#endif
+
+//
+// A measurement summary hash, computed when the ChangeCount of the measurement cache was ChangeCount.
+//
+typedef struct {
+  BOOLEAN                              Valid;
+  UINT32                               BaseHashAlgo;
+  UINT8                                MeasurementSpec;
+  UINT32                               MeasurementHashAlgo;
+  UINT32                               ChangeCount;
+  UINT8                                Hash[MAX_HASH_SIZE];
+} SPDM_MEASUREMENT_SUMMARY_HASH_CACHE;
+
+//
+// The TCB component and the all measurements summary hash.
+//
+#define SPDM_MEASUREMENT_SUMMARY_HASH_CACHE_COUNT  2
+
+//
+// The algorithms selected by the last NEGOTIATE_ALGORITHMS, for the local and offered algorithms
+// it was selected from. It is reused while both are unchanged.
+//
+typedef struct {
+  BOOLEAN                              Valid;
+  SPDM_DEVICE_ALGORITHM                Local;
+  SPDM_DEVICE_ALGORITHM                Offered;
+  SPDM_DEVICE_ALGORITHM                Selected;
+} SPDM_ALGORITHM_SELECTION_CACHE;
+
+//
+// The measurement record collected for the negotiated MeasurementSpec and MeasurementHashAlgo.
+// SpdmMeasurementChanged increases Generation[Index] of a changed block. The block is recollected
+// when Generation[Index] differs from BlockGeneration[Index], the generation it was collected at.
+// Likewise the whole record is recollected when RecordGeneration differs from CollectedRecordGeneration.
+// SpdmMeasurementChanged also increases ChangeCount, which invalidates the cached summary hashes.
+//
+typedef struct {
+  BOOLEAN                              Valid;
+  UINT8                                MeasurementSpec;
+  UINT32                               MeasurementHashAlgo;
+  UINT32                               RecordGeneration;
+  UINT32                               CollectedRecordGeneration;
+  UINT8                                BlockCount;
+  UINT32                               Generation[MAX_SPDM_MEASUREMENT_BLOCK_COUNT];
+  UINT32                               BlockGeneration[MAX_SPDM_MEASUREMENT_BLOCK_COUNT];
+  UINT8                                Record[MAX_SPDM_MEASUREMENT_RECORD_SIZE];
+  UINTN                                RecordSize;
+  UINT32                               ChangeCount;
+  SPDM_MEASUREMENT_SUMMARY_HASH_CACHE  SummaryHash[SPDM_MEASUREMENT_SUMMARY_HASH_CACHE_COUNT];
+} SPDM_LOCAL_MEASUREMENT_CACHE;
+
+//
+// At most Budget requests are admitted in each Period from WindowStart. Budget 0 admits all requests.
+//
+typedef struct {
+  UINT32                               Budget;
+  UINT64                               Period;
+  UINT64                               WindowStart;
+  UINT32                               Used;
+} SPDM_RATE_LIMIT;
+
+//
+// The request codes are 0x80 to 0xFF. The request handler of a request code is at (RequestCode - SPDM_REQUEST_CODE_BASE).
+//
+#define SPDM_REQUEST_CODE_BASE   0x80
+#define SPDM_REQUEST_CODE_COUNT  0x80
 
+typedef struct {
+  UINT16                               StandardId;
+  UINT8                                VendorIdLen;
+  UINT8                                VendorId[MAX_SPDM_VENDOR_ID_LENGTH];
+  // Either the whole request handler or the payload handler is set in a used entry.
+  UINTN                                GetResponseFunc;
+  UINTN                                PayloadFunc;
+} SPDM_VENDOR_DEFINED_HANDLER;
+
+//
+// The capture of the transport layer messages, registered by SpdmRegisterCaptureFunc.
+// SampleCount is the number of messages since the last sampled one, and SamplePending is TRUE
+// from a sampled message to the next message, which completes the sampled exchange.
+//
+typedef struct {
+  UINTN                                CaptureFunc;
+  VOID                                 *CaptureContext;
+  UINTN                                GetTimeFunc;
+  UINT32                               SampleInterval;
+  UINT32                               SampleCount;
+  BOOLEAN                              SamplePending;
+  UINTN                                MaxCaptureSize;
+} SPDM_CAPTURE_CONFIG;
+
+//
+// The functions of a transport path. TransportPath[0] of an SPDM context holds the ones of path 0,
+// registered by SpdmRegisterDeviceIoFunc and SpdmRegisterTransportLayerFunc.
+//
+typedef struct {
+  SPDM_DEVICE_SEND_MESSAGE_FUNC            SendMessage;
+  SPDM_DEVICE_RECEIVE_MESSAGE_FUNC         ReceiveMessage;
+  SPDM_DEVICE_SEND_MESSAGE_VECTOR_FUNC     SendMessageVector;
+  SPDM_DEVICE_RECEIVE_MESSAGE_VECTOR_FUNC  ReceiveMessageVector;
+  VOID                                     *DeviceIoContext;
+  SPDM_TRANSPORT_ENCODE_MESSAGE_FUNC       TransportEncodeMessage;
+  SPDM_TRANSPORT_DECODE_MESSAGE_FUNC       TransportDecodeMessage;
+  SPDM_TRANSPORT_GET_MESSAGE_ROOM_FUNC     TransportGetMessageRoom;
+  UINTN                                    MinPayloadSize;
+} SPDM_TRANSPORT_PATH_SLOT;
+
+#define SPDM_DEVICE_CONTEXT_VERSION 0x1
+
+//
+// The fields used for every message come first, and the fields used by some requests or by the set-up follow.
+// The buffers of MaxSpdmMessageSize bytes and the session slots are laid out after the SPDM context,
+// so that the hot fields of a context share a few cache lines.
+//
+typedef struct {
+  UINT32                          Version;
   //
   // Command Status
   //
   UINT32                          ErrorState;
+  //
+  // IO and transport layer information of path 0, and of the additional transport paths in
+  // TransportPath[1] to TransportPath[TransportPathCount].
+  // SendTransportPath and ReceiveTransportPath are the paths of the message being sent and received.
+  // They are separate and only written by the functions of their own direction, so that
+  // SpdmSendRequest and SpdmReceiveResponse can run on different threads over different paths.
+  //
+  SPDM_TRANSPORT_PATH_SLOT          TransportPath[MAX_SPDM_TRANSPORT_PATH_COUNT + 1];
+  UINT8                             TransportPathCount;
+  UINT8                             SendTransportPath;
+  UINT8                             ReceiveTransportPath;
+  SPDM_DEVICE_STALL_FUNC            Stall;
+  //
+  // Capture of the transport layer messages
+  //
+  SPDM_CAPTURE_CONFIG             Capture;
+
   //
   // Cached plain text command
   // If the command is cipher text, decrypt then cache it.
   //
-  UINT8                           LastSpdmRequest[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  // LastSpdmRequest and CachSpdmRequest hold MaxSpdmMessageSize bytes each.
+  //
+  UINTN                           MaxSpdmMessageSize;
+  UINT8                           *LastSpdmRequest;
   UINTN                           LastSpdmRequestSize;
   //
   // Cache SessionId in this SpdmMessage, only valid for secured message.
   //
   UINT32                          LastSpdmRequestSessionId;
   BOOLEAN                         LastSpdmRequestSessionIdValid;
+
   //
-  // Cache the error in SpdmProcessRequest. It is handled in SpdmBuildResponse.
+  // MaxSessionCount session slots, laid out after the SPDM context with the other variable-length regions.
+  // SessionIdList[Index] is the SessionId of SessionInfo[Index], so that a session ID is found without reading the session slots.
   //
-  SPDM_ERROR_STRUCT               LastSpdmError;
+  SPDM_SESSION_INFO               *SessionInfo;
+  UINT32                          *SessionIdList;
+  UINTN                           MaxSessionCount;
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+  //
+  // Open addressing table of session slots by SessionId, with SessionHashTableSize entries.
+  // An entry is the slot index + 1, or 0 if it is empty.
+  //
+  UINT16                          *SessionHashTable;
+  UINTN                           SessionHashTableSize;
+  //
+  // Free session slots, linked by SessionFreeList[Index] from SessionFreeHead.
+  // A link is the slot index + 1, or 0 at the end of the list.
+  //
+  UINT16                          *SessionFreeList;
+  UINTN                           SessionFreeHead;
+#endif
+  //
+  // Cache lastest session ID for HANDSHAKE_IN_THE_CLEAR
+  //
+  UINT32                          LatestSessionId;
+  //
+  // Register for Responder state, be initial to Normal (responder only)
+  //
+  SPDM_RESPONSE_STATE             ResponseState;
 
   //
   // Register GetResponse function (responder only)
   //
   UINTN                           GetResponseFunc;
+  //
+  // The connection state and the negotiated algorithms lead the connection info, the peer certificate chain
+  // and the peer measurements follow.
+  //
+  SPDM_CONNECTION_INFO            ConnectionInfo;
+
+  //
+  // Cache the error in SpdmProcessRequest. It is handled in SpdmBuildResponse.
+  //
+  SPDM_ERROR_STRUCT               LastSpdmError;
+  //
+  // Register the request handlers per request code, and the VENDOR_DEFINED_REQUEST handlers
+  // per standard ID and vendor ID, which take precedence over the built-in handlers (responder only)
+  //
+  UINTN                           RequestHandler[SPDM_REQUEST_CODE_COUNT];
+  SPDM_VENDOR_DEFINED_HANDLER     VendorDefinedHandler[MAX_SPDM_VENDOR_DEFINED_HANDLER_COUNT];
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
   //
   // Register GetEncapResponse function (requester only)
   //
   UINTN                           GetEncapResponseFunc;
   SPDM_ENCAP_CONTEXT              EncapContext;
+#endif
+  //
+  // Operation driven by SpdmRequesterStep (requester only)
+  //
+  SPDM_REQUESTER_STEP_CONTEXT     RequesterStep;
+  //
+  // KEY_EXCHANGE requests prepared ahead of the sessions (requester only)
+  //
+  SPDM_PRESTAGED_KEY_EXCHANGE     PrestagedKeyExchange[MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT];
   //
   // Register SpdmSessionStateCallback function (responder only)
   // Register can know the state after StartSession / EndSession.
@@ -286,49 +1278,205 @@ typedef struct {
   // Register can know the connection state such as negotiated.
   //
   UINTN                           SpdmConnectionStateCallback[MAX_SPDM_CONNECTION_STATE_CALLBACK_NUM];
+  //
+  // State transitions posted for SpdmDispatchStateEvents, instead of calling the callbacks above (responder only)
+  //
+  SPDM_STATE_EVENT_QUEUE          StateEventQueue;
 
   SPDM_LOCAL_CONTEXT              LocalContext;
+  SPDM_LOCAL_CERT_CHAIN_DIGEST    LocalCertChainDigest[MAX_SPDM_SLOT_COUNT];
 
-  SPDM_CONNECTION_INFO            ConnectionInfo;
   SPDM_TRANSCRIPT                 Transcript;
-
-  SPDM_SESSION_INFO               SessionInfo[MAX_SPDM_SESSION_COUNT];
   //
-  // Cache lastest session ID for HANDSHAKE_IN_THE_CLEAR
+  // The chunks of MessageB, MessageMutB and the MessageK and MessageF of the sessions.
+  // TranscriptArenaSize bytes are laid out after the SPDM context, and SpdmAddTranscriptArenaMemory adds more.
   //
-  UINT32                          LatestSessionId;
+  SPDM_TRANSCRIPT_ARENA           TranscriptArena;
+  UINTN                           TranscriptArenaSize;
   //
-  // Register for Responder state, be initial to Normal (responder only)
+  // The temporary message buffers, taken by SpdmAcquireScratch and released by SpdmReleaseScratch in LIFO order.
+  // ScratchSize bytes are laid out after the SPDM context.
   //
-  SPDM_RESPONSE_STATE             ResponseState;
+  UINT8                           *Scratch;
+  UINTN                           ScratchSize;
+  UINTN                           ScratchUsed;
+  //
+  // The large response retrieved by CHUNK_GET after ERROR(LargeResponse) (responder only).
+  // ChunkBufferSize bytes are laid out after the SPDM context. LargeResponseSize is 0 if no large response is pending.
+  // ChunkOffset and ChunkSeqNo are the offset and the sequence number of the next chunk.
+  //
+  UINT8                           *ChunkBuffer;
+  UINTN                           ChunkBufferSize;
+  UINT32                          LargeResponseSize;
+  UINT32                          ChunkOffset;
+  UINT16                          ChunkSeqNo;
+  UINT8                           ChunkHandle;
+  BOOLEAN                         LargeResponseSessionIdValid;
+  UINT32                          LargeResponseSessionId;
+  //
+  // Register certificate chain verification cache, may be shared with other contexts
+  //
+  SPDM_CERT_CHAIN_CACHE           *CertChainCache;
+  //
+  // Register DHE key pool, may be shared with other contexts
+  //
+  VOID                            *DheKeyPool;
+  //
+  // Register device profile, may be shared with other contexts
+  //
+  CONST SPDM_DEVICE_PROFILE       *DeviceProfile;
+  //
+  // Register inline crypto engine offload functions, set to each new session
+  //
+  CONST SPDM_SECURED_MESSAGE_OFFLOAD_OPS  *SecuredMessageOffloadOps;
+  VOID                            *SecuredMessageOffloadContext;
+  //
+  // The nonces and the random data of the SPDM messages
+  //
+  SPDM_RANDOM_STREAM              RandomStream;
   //
   // Cached data for SPDM_ERROR_CODE_RESPONSE_NOT_READY/SPDM_RESPOND_IF_READY
   //
   SPDM_ERROR_DATA_RESPONSE_NOT_READY  ErrorData;
-  UINT8                           CachSpdmRequest[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                           *CachSpdmRequest;
   UINTN                           CachSpdmRequestSize;
   UINT8                           CurrentToken;
   //
+  // Register asynchronous signing functions (responder only)
+  //
+  UINTN                           ResponderDataSignAsyncFunc;
+  UINTN                           ResponderDataSignPollFunc;
+  //
+  // Register the yield function (responder only)
+  //
+  UINTN                           ResponderYieldFunc;
+  //
+  // Response waiting for an asynchronous signature, completed by SPDM_RESPOND_IF_READY
+  //
+  SPDM_PENDING_SIGNATURE          PendingSignature;
+  //
+  // Register measurement block collection function, and the local measurement record GET_MEASUREMENTS is served from (responder only)
+  //
+  UINTN                           MeasurementBlockCollectionFunc;
+  SPDM_LOCAL_MEASUREMENT_CACHE    LocalMeasurementCache;
+  //
+  // Register measurement block iterator, which GET_MEASUREMENTS is served from instead of the local measurement record (responder only)
+  //
+  UINTN                           MeasurementBlockIteratorFunc;
+  //
+  // Register admission control of the requests needing a signing or a DHE operation (responder only)
+  // RateLimit is the budget of this peer. RateLimiter may be shared with other contexts.
+  //
+  UINTN                           ResponderGetTimeFunc;
+  UINTN                           ResponderAdmissionFunc;
+  SPDM_RATE_LIMIT                 RateLimit;
+  VOID                            *RateLimiter;
+  //
+  // The session lifecycle policy and the session privilege function (responder only)
+  //
+  SPDM_RESPONDER_SESSION_POLICY   ResponderSessionPolicy;
+  UINTN                           ResponderSessionPrivilegeFunc;
+  //
+  // The spacing of the scheduled key updates, and the time the next one may be started (responder only)
+  //
+  UINT64                          KeyUpdateSpacing;
+  UINT64                          KeyUpdateNextTime;
+  //
+  // The algorithm cost model, set by SpdmSetAlgorithmCostModel
+  //
+  BOOLEAN                         AlgorithmCostModelEnabled;
+  SPDM_ALGORITHM_COST_MODEL       AlgorithmCostModel;
+  //
+  // The algorithm selection of the last NEGOTIATE_ALGORITHMS (responder only)
+  //
+  SPDM_ALGORITHM_SELECTION_CACHE  AlgorithmSelectionCache;
+  //
+  // Register the lock of the connection state, the transcripts and the transport layer,
+  // taken by SpdmProcessMessage and the responder workers (responder only)
+  //
+  UINTN                           ResponderAcquireLock;
+  UINTN                           ResponderReleaseLock;
+  VOID                            *ResponderLockContext;
+  //
   // Register for the retry times when receive "BUSY" Error response (requester only)
   //
   UINT8                           RetryTimes;
-} SPDM_DEVICE_CONTEXT;
-
-/**
-  This function dump raw data.
-
-  @param  Data  raw data
-  @param  Size  raw data size
-**/
-VOID
-InternalDumpHexStr (
-  IN UINT8  *Data,
-  IN UINTN  Size
-  );
-
-/**
-  This function dump raw data.
-
+  //
+  // Response timing (requester only)
+  // ResponseTimeout is the timeout of the response to the last request, in 100ns units.
+  // BusyCount is the number of consecutive ERROR(BUSY), scaling the wait before the next retry.
+  //
+  UINT64                          ResponseTimeout;
+  UINT8                           BusyCount;
+  //
+  // Register requester monitor functions (requester only)
+  //
+  UINTN                           RequesterGetTimeFunc;
+  UINTN                           RequesterMonitorFunc;
+  //
+  // Register asynchronous signature verification functions, and the CHALLENGE_AUTH waiting for its verification (requester only)
+  //
+  UINTN                           RequesterVerifyAsyncFunc;
+  UINTN                           RequesterVerifyPollFunc;
+  SPDM_PENDING_CHALLENGE          PendingChallenge;
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  //
+  // The signed transcripts exported by SpdmExportEvidence (requester only)
+  //
+  SPDM_EVIDENCE                   Evidence;
+#endif
+  //
+  // The warm session pool, configured by SpdmConfigureSessionPool (requester only)
+  //
+  SPDM_SESSION_POOL_CONFIG        SessionPool;
+#if OPENSPDM_REQUESTER_STATS_SUPPORT == 1
+  //
+  // Requester statistics (requester only)
+  // StatsRequestCode is the request code of the last request sent, or 0 if there is none.
+  // StatsRetryRequestCode is the request code answered with ERROR(BUSY), or 0 if there is none.
+  // StatsSendTime and StatsReceiveTime are the time the last request is sent and the last response is received.
+  // StatsLocalTimePending is TRUE from a response being received to the next request being sent.
+  //
+  SPDM_REQUESTER_STATS            RequesterStats;
+  UINT8                           StatsRequestCode;
+  UINT8                           StatsRetryRequestCode;
+  UINT64                          StatsSendTime;
+  UINT64                          StatsReceiveTime;
+  BOOLEAN                         StatsLocalTimePending;
+#endif
+#if OPENSPDM_RESPONDER_STATS_SUPPORT == 1
+  //
+  // Responder statistics (responder only)
+  // StatsCryptoTime and StatsCallbackTime are the crypto time and the callback time of the request being processed.
+  //
+  SPDM_RESPONDER_STATS            ResponderStats;
+  UINT64                          StatsCryptoTime;
+  UINT64                          StatsCallbackTime;
+#endif
+#if OPENSPDM_CRYPTO_STATS_SUPPORT == 1
+  //
+  // Crypto statistics, and the registered cycle function
+  //
+  SPDM_CRYPTO_STATS               CryptoStats;
+  UINTN                           CryptoGetCycleFunc;
+#endif
+} SPDM_DEVICE_CONTEXT;
+
+/**
+  This function dump raw data.
+
+  @param  Data  raw data
+  @param  Size  raw data size
+**/
+VOID
+InternalDumpHexStr (
+  IN UINT8  *Data,
+  IN UINTN  Size
+  );
+
+/**
+  This function dump raw data.
+
   @param  Data  raw data
   @param  Size  raw data size
 **/
@@ -382,6 +1530,299 @@ ShrinkManagedBuffer (
   IN UINTN               BufferSize
   );
 
+/**
+  Reset a running hash transcript.
+
+  @param  MessageDigest                A pointer to the running hash transcript.
+**/
+VOID
+SpdmResetMessageDigest (
+  IN OUT SPDM_MESSAGE_DIGEST   *MessageDigest
+  );
+
+/**
+  Return the local algorithms of an SPDM context which may be negotiated.
+
+  They are the local algorithms, without the ones below MinSecurityStrength of the algorithm cost model.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Algorithm                    The local algorithms which may be negotiated.
+**/
+VOID
+SpdmGetNegotiableAlgorithm (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+     OUT SPDM_DEVICE_ALGORITHM        *Algorithm
+  );
+
+/**
+  Return the cost of an algorithm from a cost table of the algorithm cost model.
+
+  @param  CostTable                    The costs of the algorithm bitmask, indexed by the bit number.
+  @param  Algo                         The algorithm, one bit of the bitmask.
+
+  @return the cost of the algorithm, or MAX_UINT32 if it is unknown.
+**/
+UINT32
+SpdmGetAlgorithmCost (
+  IN     CONST UINT32                 *CostTable,
+  IN     UINT32                       Algo
+  );
+
+/**
+  Update a new hash context with Message A in SPDM context.
+
+  Message A is the start of every transcript, so the hash context must not be updated before.
+  The running hash of Message A is copied to it if there is one for the hash algorithm,
+  otherwise Message A is hashed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  BaseHashAlgo                 The hash algorithm of the hash context.
+  @param  HashContext                  The new hash context.
+
+  @retval TRUE   The hash context is updated with Message A.
+  @retval FALSE  The hash context cannot be updated.
+**/
+BOOLEAN
+SpdmHashUpdateMessageA (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINT32                BaseHashAlgo,
+  IN OUT VOID                  *HashContext
+  );
+
+#if OPENSPDM_MESSAGE_A_DIGEST_SUPPORT == 1
+/**
+  Free the running hashes of Message A in SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmResetMessageADigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext
+  );
+#endif
+
+/**
+  Keep only the running hash of Message A of the negotiated base hash algorithm, once ALGORITHMS is processed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmFinishMessageADigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext
+  );
+
+/**
+  Append a message to a running hash transcript.
+
+  The running hash is started with Message A if StartWithMessageA is TRUE, if the transcript is empty.
+  The transcript is reset if the hash cannot be updated.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageDigest                A pointer to the running hash transcript.
+  @param  StartWithMessageA            Message A is hashed before the first message.
+  @param  Message                      Message buffer.
+  @param  MessageSize                  Size in bytes of message buffer.
+
+  @return RETURN_SUCCESS          Message is appended.
+  @return RETURN_OUT_OF_RESOURCES Message is not appended because the hash context cannot be allocated.
+  @return RETURN_DEVICE_ERROR     Message is not appended because the hash cannot be updated.
+**/
+RETURN_STATUS
+SpdmAppendMessageDigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN OUT SPDM_MESSAGE_DIGEST   *MessageDigest,
+  IN     BOOLEAN               StartWithMessageA,
+  IN     VOID                  *Message,
+  IN     UINTN                 MessageSize
+  );
+
+/**
+  Withdraw the last appended message from a running hash transcript.
+
+  The transcript is reset if the message cannot be withdrawn from the running hash.
+
+  @param  MessageDigest                A pointer to the running hash transcript.
+  @param  MessageSize                  Size in bytes of the last appended message.
+**/
+VOID
+SpdmShrinkMessageDigest (
+  IN OUT SPDM_MESSAGE_DIGEST   *MessageDigest,
+  IN     UINTN                 MessageSize
+  );
+
+/**
+  Withdraw the last appended message from Message M cache in SPDM context.
+
+  Message M is reset if the message cannot be withdrawn from the running hash.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the last appended message.
+**/
+VOID
+SpdmShrinkMessageM (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINTN                 MessageSize
+  );
+
+/**
+  Append a message of the requester to the running hash of Message B in SPDM context.
+
+  The running hash is started with Message A, so that it is the running hash of M2 before Message C.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Message                      Message buffer.
+  @param  MessageSize                  Size in bytes of message buffer.
+
+  @return RETURN_SUCCESS          Message is appended.
+  @return RETURN_OUT_OF_RESOURCES Message is not appended because the hash context cannot be allocated.
+  @return RETURN_DEVICE_ERROR     Message is not appended because the hash cannot be updated.
+**/
+RETURN_STATUS
+SpdmAppendMessageBDigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     VOID                  *Message,
+  IN     UINTN                 MessageSize
+  );
+
+/**
+  Withdraw the last appended message from the running hash of Message B in SPDM context.
+
+  The running hash of Message B is reset if the message cannot be withdrawn from it.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the last appended message.
+**/
+VOID
+SpdmShrinkMessageBDigest (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINTN                 MessageSize
+  );
+
+/**
+  Append a message of the requester to Message M in SPDM context.
+
+  It is SpdmAppendMessageM, and also copies the message to the evidence if OPENSPDM_EVIDENCE_SUPPORT is 1.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Message                      Message buffer.
+  @param  MessageSize                  Size in bytes of message buffer.
+
+  @return RETURN_SUCCESS          Message is appended.
+  @return RETURN_OUT_OF_RESOURCES Message is not appended because the hash context cannot be allocated.
+  @return RETURN_DEVICE_ERROR     Message is not appended because the hash cannot be updated.
+**/
+RETURN_STATUS
+SpdmAppendRequesterMessageM (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     VOID                  *Message,
+  IN     UINTN                 MessageSize
+  );
+
+/**
+  Withdraw the last message appended by SpdmAppendRequesterMessageM from Message M in SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the last appended message.
+**/
+VOID
+SpdmShrinkRequesterMessageM (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINTN                 MessageSize
+  );
+
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+/**
+  Initialize the segmented managed buffers of the evidence in SPDM context, with the transcript arena.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmInitEvidence (
+  IN OUT SPDM_DEVICE_CONTEXT   *SpdmContext
+  );
+
+/**
+  Copy the evidence of an SPDM context to its clone, whose evidence is initialized by SpdmInitEvidence.
+
+  @param  CloneContext                 A pointer to the clone of the SPDM context.
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval RETURN_SUCCESS               The evidence is copied.
+  @retval RETURN_BUFFER_TOO_SMALL      The transcript arena of the clone has not enough free chunks.
+**/
+RETURN_STATUS
+SpdmCloneEvidence (
+  IN OUT SPDM_DEVICE_CONTEXT   *CloneContext,
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext
+  );
+
+/**
+  Add a message appended to a running hash transcript of the requester to its copy in the evidence.
+
+  The copy is started over with the message if the running hash is.
+  It must be called after the message is appended to the running hash.
+
+  @param  Copy                         The copy of the running hash transcript in the evidence.
+  @param  MessageDigest                The running hash transcript.
+  @param  Message                      Message buffer.
+  @param  MessageSize                  Size in bytes of message buffer.
+**/
+VOID
+SpdmAppendEvidenceMessage (
+  IN OUT SEGMENTED_MANAGED_BUFFER  *Copy,
+  IN     SPDM_MESSAGE_DIGEST       *MessageDigest,
+  IN     VOID                      *Message,
+  IN     UINTN                     MessageSize
+  );
+
+/**
+  Withdraw the last message from the copy of a running hash transcript of the requester in the evidence.
+
+  @param  Copy                         The copy of the running hash transcript in the evidence.
+  @param  MessageSize                  Size in bytes of the last appended message.
+**/
+VOID
+SpdmShrinkEvidenceMessage (
+  IN OUT SEGMENTED_MANAGED_BUFFER  *Copy,
+  IN     UINTN                     MessageSize
+  );
+
+/**
+  Capture the signed transcript of a CHALLENGE_AUTH or a signed MEASUREMENTS before its signature is verified.
+
+  The transcript is Concatenate (A, B, C) for CHALLENGE_AUTH, and Message M for MEASUREMENTS.
+  The signed response must be the last message appended to the transcript. Message M is moved to the
+  evidence, so it must be captured before the L1L2 hash is calculated.
+  Nothing is captured if a copy is incomplete, or if the transcript arena has not enough free chunks.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Type                         SPDM_EVIDENCE_TYPE_CHALLENGE_AUTH or SPDM_EVIDENCE_TYPE_MEASUREMENTS.
+  @param  ResponseSize                 Size in bytes of the signed response without its signature.
+  @param  Signature                    The signature of the response.
+  @param  SignatureSize                Size in bytes of the signature.
+**/
+VOID
+SpdmCaptureEvidence (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINT8                 Type,
+  IN     UINTN                 ResponseSize,
+  IN     VOID                  *Signature,
+  IN     UINTN                 SignatureSize
+  );
+
+/**
+  Mark the signed transcript captured by SpdmCaptureEvidence as verified.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Type                         SPDM_EVIDENCE_TYPE_CHALLENGE_AUTH or SPDM_EVIDENCE_TYPE_MEASUREMENTS.
+**/
+VOID
+SpdmCommitEvidence (
+  IN     SPDM_DEVICE_CONTEXT   *SpdmContext,
+  IN     UINT8                 Type
+  );
+#endif
+
 /**
   Reset the managed buffer.
   The BufferSize is reset to 0.
@@ -432,162 +1873,868 @@ InitManagedBuffer (
   );
 
 /**
-  This function initializes the session info.
+  Return a segment of the data of a managed buffer.
+
+  The data of a SEGMENTED_MANAGED_BUFFER is in more than one segment.
+  The data of the other managed buffers is in one segment.
+
+  @param  ManagedBuffer                The managed buffer.
+  @param  Offset                       The offset in bytes of the segment in the data of the managed buffer.
+  @param  SegmentSize                  The size in bytes of the segment.
+
+  @return the address of the segment, or NULL if Offset is not less than the size of the managed buffer.
+**/
+VOID *
+GetManagedBufferSegment (
+  IN     VOID            *ManagedBuffer,
+  IN     UINTN           Offset,
+     OUT UINTN           *SegmentSize
+  );
+
+/**
+  Append the data of a managed buffer to another managed buffer.
+
+  @param  ManagedBuffer                The managed buffer to be appended.
+  @param  SourceManagedBuffer          The managed buffer of the data to be appended.
+
+  @retval RETURN_SUCCESS               The data is appended to the managed buffer.
+  @retval RETURN_BUFFER_TOO_SMALL      The managed buffer is too small to be appended.
+**/
+RETURN_STATUS
+AppendManagedBufferData (
+  IN OUT VOID            *ManagedBuffer,
+  IN     VOID            *SourceManagedBuffer
+  );
+
+/**
+  This function dump the data of a managed buffer with colume format.
+
+  @param  ManagedBuffer                The managed buffer.
+**/
+VOID
+InternalDumpManagedBuffer (
+  IN VOID                *ManagedBuffer
+  );
+
+/**
+  Init a segmented managed buffer.
+
+  @param  ManagedBuffer                The segmented managed buffer.
+  @param  Arena                        The transcript arena of the chunks of the managed buffer.
+**/
+VOID
+InitSegmentedManagedBuffer (
+  IN OUT SEGMENTED_MANAGED_BUFFER  *ManagedBuffer,
+  IN     SPDM_TRANSCRIPT_ARENA     *Arena
+  );
+
+/**
+  Add memory to a transcript arena, as free chunks.
+
+  @param  Arena                        The transcript arena.
+  @param  Buffer                       The memory to add.
+  @param  BufferSize                   Size in bytes of the memory to add.
+
+  @return the number of chunks added.
+**/
+UINTN
+SpdmTranscriptArenaAddMemory (
+  IN OUT SPDM_TRANSCRIPT_ARENA     *Arena,
+  IN     VOID                      *Buffer,
+  IN     UINTN                     BufferSize
+  );
+
+/**
+  Take a temporary buffer from the scratch arena of an SPDM context.
+
+  The buffers are released by SpdmReleaseScratch in the reverse order they are taken.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  SessionId                    The SPDM session ID.
+  @param  Size                         Size in bytes of the buffer.
+
+  @return the address of the buffer, or NULL if the scratch arena is exhausted.
+**/
+VOID *
+SpdmAcquireScratch (
+  IN OUT SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     UINTN                     Size
+  );
+
+/**
+  Return a temporary buffer to the scratch arena of an SPDM context.
+
+  The buffer and the buffers taken after it are released.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Buffer                       The buffer taken by SpdmAcquireScratch.
 **/
 VOID
-SpdmSessionInfoInit (
-  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
-  IN     SPDM_SESSION_INFO       *SessionInfo,
-  IN     UINT32                  SessionId,
-  IN     BOOLEAN                 UsePsk
+SpdmReleaseScratch (
+  IN OUT SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     VOID                      *Buffer
+  );
+
+/**
+  Copy data to a buffer at an offset.
+
+  @param  Buffer                       The buffer.
+  @param  BufferSize                   Size in bytes of the buffer.
+  @param  Offset                       On input, the offset in bytes in the buffer to copy the data to.
+                                       On output, the offset in bytes after the data.
+  @param  Data                         The data to copy.
+  @param  DataSize                     Size in bytes of the data.
+
+  @retval RETURN_SUCCESS               The data is copied.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+**/
+RETURN_STATUS
+AppendBuffer (
+     OUT VOID            *Buffer,
+  IN     UINTN           BufferSize,
+  IN OUT UINTN           *Offset,
+  IN     CONST VOID      *Data,
+  IN     UINTN           DataSize
+  );
+
+/**
+  Copy the data of a managed buffer to a buffer at an offset.
+
+  @param  Buffer                       The buffer.
+  @param  BufferSize                   Size in bytes of the buffer.
+  @param  Offset                       On input, the offset in bytes in the buffer to copy the data to.
+                                       On output, the offset in bytes after the data.
+  @param  ManagedBuffer                The managed buffer of the data to copy.
+
+  @retval RETURN_SUCCESS               The data is copied.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+**/
+RETURN_STATUS
+AppendBufferManagedBufferData (
+     OUT VOID            *Buffer,
+  IN     UINTN           BufferSize,
+  IN OUT UINTN           *Offset,
+  IN     VOID            *ManagedBuffer
+  );
+
+/**
+  Continue a hash with the data of a managed buffer.
+
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  HashContext                  The hash context.
+  @param  ManagedBuffer                The managed buffer.
+
+  @retval TRUE   The hash is continued.
+  @retval FALSE  The hash cannot be continued.
+**/
+BOOLEAN
+SpdmHashUpdateManagedBuffer (
+  IN     UINT32                    BaseHashAlgo,
+  IN OUT VOID                      *HashContext,
+  IN     VOID                      *ManagedBuffer
+  );
+
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+
+/**
+  This function returns the home slot of a session ID in the session hash table.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SPDM session ID.
+
+  @return the home slot of the session ID.
+**/
+UINTN
+SpdmSessionHashTableHome (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     UINT32                  SessionId
+  );
+
+/**
+  This function finds the session hash table slot of a session ID.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SPDM session ID.
+  @param  Slot                         The session hash table slot of the session ID, or the empty slot ending the probe.
+
+  @retval TRUE   The session ID is found.
+  @retval FALSE  The session ID is not found.
+**/
+BOOLEAN
+SpdmSessionHashTableFind (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     UINT32                  SessionId,
+     OUT UINTN                   *Slot
+  );
+
+#endif
+
+/**
+  This function initializes the session info.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SPDM session ID.
+**/
+VOID
+SpdmSessionInfoInit (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     SPDM_SESSION_INFO       *SessionInfo,
+  IN     UINT32                  SessionId,
+  IN     BOOLEAN                 UsePsk
+  );
+
+/**
+  This function allocates half of session ID for a requester.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return half of session ID for a requester.
+**/
+UINT16
+SpdmAllocateReqSessionId (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext
+  );
+
+/**
+  This function allocates half of session ID for a responder.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return half of session ID for a responder.
+**/
+UINT16
+SpdmAllocateRspSessionId (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext
+  );
+
+/**
+  Send an SPDM transport layer message to the device of an SPDM context, over the path SendTransportPath.
+
+  The vectored send function is used if it is registered, with the message as one segment,
+  because the transport layer encodes the message in place in one buffer.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the message.
+  @param  Message                      A pointer to the message.
+  @param  Timeout                      The timeout, in 100ns units.
+
+  @return the status returned by the registered send function.
+**/
+RETURN_STATUS
+SpdmDeviceSendMessage (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     UINTN                     MessageSize,
+  IN     VOID                      *Message,
+  IN     UINT64                    Timeout
+  );
+
+/**
+  Receive an SPDM transport layer message from the device of an SPDM context, over the path ReceiveTransportPath.
+
+  The vectored receive function is used if it is registered, with the message buffer as one segment.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the message received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units.
+
+  @return the status returned by the registered receive function.
+**/
+RETURN_STATUS
+SpdmDeviceReceiveMessage (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN OUT UINTN                     *MessageSize,
+  IN OUT VOID                      *Message,
+  IN     UINT64                    Timeout
+  );
+
+/**
+  Return the transport path to send a message of an SPDM context over.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the message, or NULL for a normal message.
+  @param  PayloadSize                  Size in bytes of the message before it is encoded.
+
+  @return the index of the transport path. It is 0 for a normal message or a message of a session not established.
+**/
+UINT8
+SpdmSelectTransportPath (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     UINT32                    *SessionId,
+  IN     UINTN                     PayloadSize
+  );
+
+/**
+  Pass a transport layer message sent or received to the capture function, if the message is sampled.
+
+  @param  SpdmContext                  A pointer to the SPDM context, with a capture function registered.
+  @param  IsSend                       TRUE for a message sent, FALSE for a message received.
+  @param  MessageSize                  Size in bytes of the message.
+  @param  Message                      A pointer to the message.
+**/
+VOID
+SpdmCaptureMessage (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     BOOLEAN                   IsSend,
+  IN     UINTN                     MessageSize,
+  IN     CONST VOID                *Message
+  );
+
+/**
+  This function returns if a given version is supported based upon the GET_VERSION/VERSION.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Version                      The SPDM Version.
+
+  @retval TRUE  the version is supported.
+  @retval FALSE the version is not supported.
+**/
+BOOLEAN
+SpdmIsVersionSupported (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     UINT8                     Version
+  );
+
+/**
+  This function returns if a capablities flag is supported in current SPDM connection.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsRequester                  Is the function called from a requester.
+  @param  RequesterCapabilitiesFlag    The requester capabilities flag to be checked
+  @param  ResponderCapabilitiesFlag    The responder capabilities flag to be checked
+
+  @retval TRUE  the capablities flag is supported.
+  @retval FALSE the capablities flag is not supported.
+**/
+BOOLEAN
+SpdmIsCapabilitiesFlagSupported (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     BOOLEAN                   IsRequester,
+  IN     UINT32                    RequesterCapabilitiesFlag,
+  IN     UINT32                    ResponderCapabilitiesFlag
+  );
+
+/**
+  Return the largest length of a portion of a certificate chain in one CERTIFICATE response.
+
+  It follows the transport maximum message size, or is MAX_SPDM_CERT_CHAIN_BLOCK_LEN if it is not set.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MaxResponseSize              The size in bytes of the buffer of the CERTIFICATE response.
+
+  @return the largest length of a portion of a certificate chain.
+**/
+UINT16
+SpdmGetCertChainBlockLength (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     UINTN                     MaxResponseSize
+  );
+
+/*
+  This function calculates M1M2.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsMut                        Indicate if this is from mutual authentication.
+  @param  M1M2BufferSize               Size in bytes of the M1M2
+  @param  M1M2Buffer                   The buffer to store the M1M2
+
+  @retval RETURN_SUCCESS  M1M2 is calculated.
+*/
+BOOLEAN
+EFIAPI
+SpdmCalculateM1M2 (
+  IN     VOID                   *Context,
+  IN     BOOLEAN                IsMut,
+  IN OUT UINTN                  *M1M2BufferSize,
+     OUT VOID                   *M1M2Buffer
+  );
+
+/*
+  This function calculates L1L2 hash from the running hash of Message M.
+
+  Message M is consumed and reset.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  L1L2HashData                 The buffer to store the L1L2 hash.
+
+  @retval TRUE  L1L2 hash is calculated.
+  @retval FALSE L1L2 hash cannot be calculated.
+*/
+BOOLEAN
+EFIAPI
+SpdmCalculateL1L2Hash (
+  IN     VOID                   *Context,
+     OUT UINT8                  *L1L2HashData
+  );
+
+/*
+  This function calculates the M2 hash of the requester from the running hash of Message B and Message C.
+
+  The running hash of Message B is not consumed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  M2HashData                   The buffer to store the M2 hash.
+
+  @retval TRUE  M2 hash is calculated.
+  @retval FALSE M2 hash cannot be calculated.
+*/
+BOOLEAN
+SpdmCalculateM2Hash (
+  IN     SPDM_DEVICE_CONTEXT    *SpdmContext,
+     OUT UINT8                  *M2HashData
+  );
+
+/*
+  This function calculates M1M2 hash from the cached messages, without concatenating M1M2.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsMut                        Indicate if this is from mutual authentication.
+  @param  M1M2HashData                 The buffer to store the M1M2 hash.
+
+  @retval TRUE  M1M2 hash is calculated.
+  @retval FALSE M1M2 hash cannot be calculated.
+*/
+BOOLEAN
+SpdmCalculateM1M2Hash (
+  IN     SPDM_DEVICE_CONTEXT    *SpdmContext,
+  IN     BOOLEAN                IsMut,
+     OUT UINT8                  *M1M2HashData
+  );
+
+/**
+  This function generates the certificate chain hash.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotIndex                    The slot index of the certificate chain.
+  @param  Signature                    The buffer to store the certificate chain hash.
+
+  @retval TRUE  certificate chain hash is generated.
+  @retval FALSE certificate chain hash is not generated.
+**/
+BOOLEAN
+SpdmGenerateCertChainHash (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     UINTN                        SlotIndex,
+     OUT UINT8                        *Hash
+  );
+
+/**
+  Return the digests of a local certificate chain for the negotiated BaseHashAlgo.
+
+  They are computed once per provisioned certificate chain, and cached in the SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotIndex                    The slot index of the certificate chain.
+
+  @return the digests of the local certificate chain, or NULL if the slot has no certificate chain
+          or the negotiated BaseHashAlgo is not supported.
+**/
+SPDM_LOCAL_CERT_CHAIN_DIGEST *
+SpdmGetLocalCertChainDigest (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     UINTN                        SlotIndex
+  );
+
+/**
+  Hash the certificate chain data of Ct.
+
+  The hash of a local certificate chain is taken from the digests cached in the SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CertChainData                Certitiface chain data without SPDM_CERT_CHAIN header.
+  @param  CertChainDataSize            Size in bytes of the certitiface chain data.
+  @param  Hash                         The buffer to store the hash.
+
+  @retval TRUE  the hash is calculated.
+  @retval FALSE the negotiated BaseHashAlgo is not supported.
+**/
+BOOLEAN
+SpdmHashCertChainData (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     UINT8                        *CertChainData,
+  IN     UINTN                        CertChainDataSize,
+     OUT UINT8                        *Hash
+  );
+
+/**
+  Return the precomputed digest of a local certificate chain from the device profile of an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotIndex                    The slot index of the certificate chain.
+  @param  Hash                         The buffer to store the digest.
+
+  @retval TRUE   The digest is copied from the device profile.
+  @retval FALSE  No device profile is registered, or it has no digest of the certificate chain
+                 for the negotiated BaseHashAlgo.
+**/
+BOOLEAN
+SpdmDeviceProfileGetCertChainDigest (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     UINTN                        SlotIndex,
+     OUT UINT8                        *Hash
+  );
+
+/**
+  This function verifies the digest.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Digest                       The digest data buffer.
+  @param  DigestSize                   Size in bytes of the digest data buffer.
+
+  @retval TRUE  digest verification pass.
+  @retval FALSE digest verification fail.
+**/
+BOOLEAN
+SpdmVerifyPeerDigests (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN VOID                         *Digest,
+  IN UINTN                        DigestSize
+  );
+
+/**
+  This function records the peer certificate chain digests of a DIGESTS response.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotMask                     The slot mask of the DIGESTS response.
+  @param  Digest                       The digest data buffer, one digest per bit set in SlotMask.
+  @param  DigestSize                   Size in bytes of the digest data buffer.
+**/
+VOID
+SpdmRecordPeerDigests (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN UINT8                        SlotMask,
+  IN VOID                         *Digest,
+  IN UINTN                        DigestSize
+  );
+
+/**
+  This function gets the peer certificate chain of a slot from the certificate chain verification cache,
+  if the recorded digest of the slot matches a cached certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  CertChainBuffer              A pointer to a destination buffer to store the certificate chain.
+  @param  CertChainBufferSize          On input, indicate the size in bytes of the destination buffer.
+                                       On output, indicate the size in bytes of the certificate chain.
+
+  @retval TRUE  The certificate chain is got from the cache.
+  @retval FALSE No digest is recorded for the slot, or the digest does not match a cached certificate chain.
+**/
+BOOLEAN
+SpdmGetPeerCertChainFromCache (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     UINT8                        SlotNum,
+     OUT VOID                         *CertChainBuffer,
+  IN OUT UINTN                        *CertChainBufferSize
+  );
+
+/**
+  This function verifies peer certificate chain buffer including SPDM_CERT_CHAIN header.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CertChainBuffer              Certitiface chain buffer including SPDM_CERT_CHAIN header.
+  @param  CertChainBufferSize          Size in bytes of the certitiface chain buffer.
+
+  @retval TRUE  Peer certificate chain buffer verification passed.
+  @retval FALSE Peer certificate chain buffer verification failed.
+**/
+BOOLEAN
+SpdmVerifyPeerCertChainBuffer (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN VOID                         *CertChainBuffer,
+  IN UINTN                        CertChainBufferSize
+  );
+
+/**
+  This function collects a portion of the peer certificate chain got by GET_CERTIFICATE.
+
+  The portions are written in place in PeerUsedCertChainBuffer, at PeerCertChainCollectedSize.
+  The first portion invalidates the previous peer certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Portion                      A pointer to the portion of the certificate chain.
+  @param  PortionSize                  Size in bytes of the portion of the certificate chain.
+
+  @retval RETURN_SUCCESS               The portion is collected.
+  @retval RETURN_SECURITY_VIOLATION    The certificate chain is larger than PeerUsedCertChainBuffer.
+**/
+RETURN_STATUS
+SpdmCollectPeerCertChain (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN VOID                         *Portion,
+  IN UINTN                        PortionSize
+  );
+
+/**
+  This function verifies the peer certificate chain collected in PeerUsedCertChainBuffer,
+  and makes it the peer certificate chain of the connection.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval TRUE  The collected certificate chain is verified.
+  @retval FALSE The collected certificate chain verification failed.
+**/
+BOOLEAN
+SpdmCompleteCollectPeerCertChain (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext
+  );
+
+/**
+  This function returns the public key of the peer leaf certificate.
+
+  The key is parsed from the peer certificate chain on first use and kept in the connection info.
+  It is parsed again only if the leaf certificate or the negotiated algorithm changes.
+  If the peer certificate chain is in the certificate chain verification cache, the key is shared with the cache.
+  The caller must not free the returned key.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsRequester                  Indicate of the key for a requester (peer is responder) or a responder (peer is requester).
+  @param  Context                      Pointer to the peer public key context.
+
+  @retval TRUE  The peer public key is returned.
+  @retval FALSE The peer public key cannot be retrieved.
+**/
+BOOLEAN
+SpdmGetPeerPublicKey (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     BOOLEAN                      IsRequester,
+     OUT VOID                         **Context
   );
 
 /**
-  This function allocates half of session ID for a requester.
+  This function verifies a signature of the responder over a message hash with the responder public key.
+
+  The key is prepared for repeated verification once it verifies SPDM_PEER_PUBLIC_KEY_PREPARE_THRESHOLD
+  signatures, and the prepared public key is used until the key is released.
 
   @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageHash                  The hash of the signed message.
+  @param  SignData                     The signature data buffer.
+  @param  SignDataSize                 Size in bytes of the signature data buffer.
 
-  @return half of session ID for a requester.
+  @retval TRUE  signature verification pass.
+  @retval FALSE signature verification fail.
 **/
-UINT16
-SpdmAllocateReqSessionId (
-  IN     SPDM_DEVICE_CONTEXT       *SpdmContext
+BOOLEAN
+SpdmVerifyResponderSignatureHash (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN CONST UINT8                  *MessageHash,
+  IN CONST VOID                   *SignData,
+  IN UINTN                        SignDataSize
   );
 
 /**
-  This function allocates half of session ID for a responder.
+  This function releases the cached peer public key and the certificate chain verification cache entry.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-
-  @return half of session ID for a responder.
 **/
-UINT16
-SpdmAllocateRspSessionId (
-  IN     SPDM_DEVICE_CONTEXT       *SpdmContext
+VOID
+SpdmResetPeerPublicKey (
+  IN SPDM_DEVICE_CONTEXT          *SpdmContext
   );
 
 /**
-  This function returns if a given version is supported based upon the GET_VERSION/VERSION.
+  Check if a certificate chain is in a certificate chain verification cache.
 
-  @param  SpdmContext                  A pointer to the SPDM context.
-  @param  Version                      The SPDM Version.
+  A cache hit marks the entry as the most recently used one.
 
-  @retval TRUE  the version is supported.
-  @retval FALSE the version is not supported.
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo of CertChainHash.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+
+  @retval TRUE  The certificate chain has been verified before.
+  @retval FALSE The certificate chain is not in the cache.
 **/
 BOOLEAN
-SpdmIsVersionSupported (
-  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
-  IN     UINT8                     Version
+SpdmCertChainCacheLookup (
+  IN SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN UINT32                       BaseHashAlgo,
+  IN CONST UINT8                  *CertChainHash
   );
 
 /**
-  This function returns if a capablities flag is supported in current SPDM connection.
+  Take a reference to the entry of a verified certificate chain.
+
+  The entry is added if the certificate chain is not in the cache yet. The least recently used
+  entry that is not referenced is replaced if the cache is full.
+  The certificate chain is also published to the shared cache behind the cache, if any.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo of CertChainHash and LeafCertHash.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+  @param  LeafCertHash                 The hash of the leaf certificate of the certificate chain.
+  @param  CertChain                    The certificate chain buffer including SPDM_CERT_CHAIN header.
+  @param  CertChainSize                Size in bytes of the certificate chain buffer.
+  @param  PublicKeyInfo                The DER-encoded SubjectPublicKeyInfo of the leaf certificate, or NULL.
+  @param  PublicKeyInfoSize            Size in bytes of the SubjectPublicKeyInfo.
+
+  @return the referenced cache entry, or NULL if all entries are in use.
+**/
+SPDM_CERT_CHAIN_CACHE_ENTRY *
+SpdmCertChainCacheAcquire (
+  IN SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN UINT32                       BaseHashAlgo,
+  IN CONST UINT8                  *CertChainHash,
+  IN CONST UINT8                  *LeafCertHash,
+  IN CONST VOID                   *CertChain,
+  IN UINTN                        CertChainSize,
+  IN CONST UINT8                  *PublicKeyInfo OPTIONAL,
+  IN UINTN                        PublicKeyInfoSize
+  );
 
-  @param  SpdmContext                  A pointer to the SPDM context.
-  @param  IsRequester                  Is the function called from a requester.
-  @param  RequesterCapabilitiesFlag    The requester capabilities flag to be checked
-  @param  ResponderCapabilitiesFlag    The responder capabilities flag to be checked
+/**
+  Copy a verified certificate chain out of a certificate chain verification cache.
 
-  @retval TRUE  the capablities flag is supported.
-  @retval FALSE the capablities flag is not supported.
+  A cache hit marks the entry as the most recently used one.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo of CertChainHash.
+  @param  CertChainHash                The hash of the certificate chain buffer including SPDM_CERT_CHAIN header.
+  @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
+  @param  CertChainSize                On input, indicate the size in bytes of the destination buffer.
+                                       On output, indicate the size in bytes of the certificate chain.
+
+  @retval TRUE  The certificate chain is copied.
+  @retval FALSE The certificate chain is not in the cache, or the destination buffer is too small.
 **/
 BOOLEAN
-SpdmIsCapabilitiesFlagSupported (
-  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
-  IN     BOOLEAN                   IsRequester,
-  IN     UINT32                    RequesterCapabilitiesFlag,
-  IN     UINT32                    ResponderCapabilitiesFlag
+SpdmCertChainCacheGetCertChain (
+  IN     SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN     UINT32                       BaseHashAlgo,
+  IN     CONST UINT8                  *CertChainHash,
+     OUT VOID                         *CertChain,
+  IN OUT UINTN                        *CertChainSize
   );
 
-/*
-  This function calculates M1M2.
+/**
+  Drop a reference to a certificate chain verification cache entry.
 
-  @param  SpdmContext                  A pointer to the SPDM context.
-  @param  IsMut                        Indicate if this is from mutual authentication.
-  @param  M1M2BufferSize               Size in bytes of the M1M2
-  @param  M1M2Buffer                   The buffer to store the M1M2
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  Entry                        A pointer to the cache entry, returned by SpdmCertChainCacheAcquire.
+**/
+VOID
+SpdmCertChainCacheRelease (
+  IN     SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN OUT SPDM_CERT_CHAIN_CACHE_ENTRY  *Entry
+  );
 
-  @retval RETURN_SUCCESS  M1M2 is calculated.
-*/
+/**
+  Return the public key of the leaf certificate of a cached certificate chain.
+
+  The key is parsed on first use and kept in the entry, so that other SPDM contexts presenting
+  the same certificate chain can use it. The caller must hold a reference to the entry and
+  must not free the returned key.
+
+  @param  Cache                        A pointer to the certificate chain verification cache.
+  @param  Entry                        A pointer to the cache entry, returned by SpdmCertChainCacheAcquire.
+  @param  IsReqAsym                    Indicate of the key for ReqBaseAsymAlg or for BaseAsymAlgo.
+  @param  AsymAlgo                     The asymmetric algorithm of the key.
+  @param  LeafCertHash                 The hash of CertBuffer.
+  @param  CertBuffer                   The leaf certificate.
+  @param  CertBufferSize               Size in bytes of the leaf certificate.
+  @param  Context                      Pointer to the public key context.
+
+  @retval TRUE  The public key is returned.
+  @retval FALSE The entry does not match the leaf certificate or the algorithm, or the key cannot be parsed.
+**/
 BOOLEAN
-EFIAPI
-SpdmCalculateM1M2 (
-  IN     VOID                   *Context,
-  IN     BOOLEAN                IsMut,
-  IN OUT UINTN                  *M1M2BufferSize,
-     OUT VOID                   *M1M2Buffer
+SpdmCertChainCacheGetPublicKey (
+  IN     SPDM_CERT_CHAIN_CACHE        *Cache,
+  IN OUT SPDM_CERT_CHAIN_CACHE_ENTRY  *Entry,
+  IN     BOOLEAN                      IsReqAsym,
+  IN     UINT32                       AsymAlgo,
+  IN     CONST UINT8                  *LeafCertHash,
+  IN     CONST UINT8                  *CertBuffer,
+  IN     UINTN                        CertBufferSize,
+     OUT VOID                         **Context
   );
 
-/*
-  This function calculates L1L2.
+/**
+  This function signs a message with the responder private key.
+
+  If the asynchronous signing functions are registered and the signing is pending,
+  the sign token is recorded in the pending signature of the SPDM context.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  L1L2BufferSize               Size in bytes of the L1L2
-  @param  L1L2Buffer                   The buffer to store the L1L2
+  @param  Message                      A pointer to a message to be signed (before hash).
+  @param  MessageSize                  The size in bytes of the message to be signed.
+  @param  Signature                    The buffer to store the signature.
 
-  @retval RETURN_SUCCESS  L1L2 is calculated.
-*/
-BOOLEAN
-EFIAPI
-SpdmCalculateL1L2 (
-  IN     VOID                   *Context,
-  IN OUT UINTN                  *L1L2BufferSize,
-     OUT VOID                   *L1L2Buffer
+  @retval RETURN_SUCCESS               The signature is generated.
+  @retval RETURN_NOT_READY             The signing is pending.
+  @retval RETURN_DEVICE_ERROR          The signature is not generated.
+**/
+RETURN_STATUS
+SpdmResponderGenerateSignature (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     CONST UINT8                *Message,
+  IN     UINTN                      MessageSize,
+     OUT UINT8                      *Signature
   );
 
 /**
-  This function generates the certificate chain hash.
+  This function signs a message hash with the responder private key.
+
+  The signing is always synchronous, because the asynchronous signing functions take the message before hash.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  SlotIndex                    The slot index of the certificate chain.
-  @param  Signature                    The buffer to store the certificate chain hash.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    The buffer to store the signature.
 
-  @retval TRUE  certificate chain hash is generated.
-  @retval FALSE certificate chain hash is not generated.
+  @retval RETURN_SUCCESS               The signature is generated.
+  @retval RETURN_DEVICE_ERROR          The signature is not generated.
 **/
-BOOLEAN
-SpdmGenerateCertChainHash (
-  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
-  IN     UINTN                        SlotIndex,
-     OUT UINT8                        *Hash
+RETURN_STATUS
+SpdmResponderGenerateSignatureFromHash (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     CONST UINT8                *MessageHash,
+     OUT UINT8                      *Signature
   );
 
 /**
-  This function verifies the digest.
+  This function signs a message with the requester private key.
 
-  @param  SpdmContext                  A pointer to the SPDM context.
-  @param  Digest                       The digest data buffer.
-  @param  DigestSize                   Size in bytes of the digest data buffer.
+  The registered requester private key handle is used if it matches the negotiated algorithm.
 
-  @retval TRUE  digest verification pass.
-  @retval FALSE digest verification fail.
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Message                      A pointer to a message to be signed (before hash).
+  @param  MessageSize                  The size in bytes of the message to be signed.
+  @param  Signature                    The buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the signature buffer.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
 **/
 BOOLEAN
-SpdmVerifyPeerDigests (
-  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
-  IN VOID                         *Digest,
-  IN UINTN                        DigestSize
+SpdmRequesterGenerateSignature (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     CONST UINT8                *Message,
+  IN     UINTN                      MessageSize,
+     OUT UINT8                      *Signature,
+  IN OUT UINTN                      *SigSize
   );
 
 /**
-  This function verifies peer certificate chain buffer including SPDM_CERT_CHAIN header.
+  This function signs a message hash with the requester private key.
+
+  The registered requester private key handle is used if it matches the negotiated algorithm.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  CertChainBuffer              Certitiface chain buffer including SPDM_CERT_CHAIN header.
-  @param  CertChainBufferSize          Size in bytes of the certitiface chain buffer.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    The buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the signature buffer.
+                                       On output, indicates the size in bytes of the signature in the buffer.
 
-  @retval TRUE  Peer certificate chain buffer verification passed.
-  @retval FALSE Peer certificate chain buffer verification failed.
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
 **/
 BOOLEAN
-SpdmVerifyPeerCertChainBuffer (
-  IN SPDM_DEVICE_CONTEXT          *SpdmContext,
-  IN VOID                         *CertChainBuffer,
-  IN UINTN                        CertChainBufferSize
+SpdmRequesterGenerateSignatureFromHash (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     CONST UINT8                *MessageHash,
+     OUT UINT8                      *Signature,
+  IN OUT UINTN                      *SigSize
   );
 
 /**
@@ -597,10 +2744,11 @@ SpdmVerifyPeerCertChainBuffer (
   @param  IsRequester                  Indicate of the signature generation for a requester or a responder.
   @param  Signature                    The buffer to store the challenge signature.
 
-  @retval TRUE  challenge signature is generated.
-  @retval FALSE challenge signature is not generated.
+  @retval RETURN_SUCCESS               challenge signature is generated.
+  @retval RETURN_NOT_READY             the responder signing is pending.
+  @retval RETURN_DEVICE_ERROR          challenge signature is not generated.
 **/
-BOOLEAN
+RETURN_STATUS
 SpdmGenerateChallengeAuthSignature (
   IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
   IN     BOOLEAN                    IsRequester,
@@ -660,6 +2808,86 @@ SpdmGetMeasurementSummaryHashSize (
   IN     UINT8                MeasurementSummaryHashType
   );
 
+/**
+  Return if the measurements of the responder are recomputed for every request.
+
+  With MEAS_FRESH_CAP, the measurement record and the measurement summary hashes are recollected on every use.
+  Without it, they are the measurements collected once, and recollected only after SpdmMeasurementChanged.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval TRUE  the responder advertises MEAS_FRESH_CAP.
+  @retval FALSE the responder serves the measurements kept in the measurement cache.
+**/
+BOOLEAN
+SpdmIsMeasurementFresh (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  Return the measurement record of the device for the negotiated MeasurementSpec and MeasurementHashAlgo.
+
+  The record is served from the measurement cache of the SPDM context. Only the blocks changed since they
+  were collected are recollected, with the registered measurement block collection function if any.
+  Otherwise the whole record is recollected with SpdmMeasurementCollectionFunc.
+  If the responder advertises MEAS_FRESH_CAP, the whole record is recollected on every call.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  DeviceMeasurementCount       The count of the device measurement blocks.
+  @param  DeviceMeasurement            The concatenation of all device measurement blocks.
+                                       It is valid until the next call or SpdmMeasurementChanged.
+  @param  DeviceMeasurementSize        The size in bytes of all device measurement blocks.
+
+  @retval TRUE  the measurement record is returned.
+  @retval FALSE the measurement record is not collected.
+**/
+BOOLEAN
+SpdmGetMeasurementRecord (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+     OUT UINT8                *DeviceMeasurementCount,
+     OUT UINT8                **DeviceMeasurement,
+     OUT UINTN                *DeviceMeasurementSize
+  );
+
+/**
+  Collect one measurement block of the device with the registered measurement block iterator,
+  for the negotiated MeasurementSpec and MeasurementHashAlgo.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementIndex             The index of the measurement block, starting from 1.
+  @param  MeasurementBlock             A pointer to a destination buffer to store the measurement block.
+  @param  MeasurementBlockSize         On input, indicates the size in bytes of the destination buffer.
+                                       On output, indicates the size in bytes of the measurement block.
+
+  @retval RETURN_SUCCESS               The measurement block is returned.
+  @retval RETURN_NOT_FOUND             The device has no measurement block of the index.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the measurement block.
+  @retval RETURN_DEVICE_ERROR          The measurement block is not a valid DMTF measurement block.
+  @retval others                       The measurement block is not collected.
+**/
+RETURN_STATUS
+SpdmIterateMeasurementBlock (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementIndex,
+     OUT VOID                 *MeasurementBlock OPTIONAL,
+  IN OUT UINTN                *MeasurementBlockSize
+  );
+
+/**
+  Count the measurement blocks of the device with the registered measurement block iterator.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  DeviceMeasurementCount       The count of the device measurement blocks.
+
+  @retval RETURN_SUCCESS               The count is returned.
+  @retval others                       The iterator fails.
+**/
+RETURN_STATUS
+SpdmCountMeasurementBlocks (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+     OUT UINT8                *DeviceMeasurementCount
+  );
+
 /**
   This function calculate the measurement summary hash.
 
@@ -682,13 +2910,15 @@ SpdmGenerateMeasurementSummaryHash (
 /**
   This function generates the measurement signature to response message based upon L1L2.
 
+  The L1L2 hash is signed synchronously, even if the asynchronous signing functions are registered.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  Signature                    The buffer to store the Signature.
 
-  @retval TRUE  measurement signature is created.
-  @retval FALSE measurement signature is not created.
+  @retval RETURN_SUCCESS               measurement signature is created.
+  @retval RETURN_DEVICE_ERROR          measurement signature is not created.
 **/
-BOOLEAN
+RETURN_STATUS
 SpdmGenerateMeasurementSignature (
   IN     SPDM_DEVICE_CONTEXT    *SpdmContext,
      OUT UINT8                  *Signature
@@ -711,6 +2941,127 @@ SpdmVerifyMeasurementSignature (
   IN UINTN                        SignDataSize
   );
 
+/**
+  This function starts to verify a signature of the responder over a message hash, for the requester.
+
+  Without the asynchronous verification functions, the signature is verified synchronously.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageHash                  The hash of the signed message.
+  @param  SignData                     The signature data buffer.
+  @param  SignDataSize                 Size in bytes of the signature data buffer.
+  @param  PendingVerify                The pending verification, if RETURN_NOT_READY is returned.
+
+  @retval RETURN_SUCCESS               The signature is verified.
+  @retval RETURN_NOT_READY             The verification is pending.
+  @retval RETURN_SECURITY_VIOLATION    The signature is not verified.
+**/
+RETURN_STATUS
+SpdmStartVerifyResponderSignatureHash (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     CONST UINT8                  *MessageHash,
+  IN     CONST VOID                   *SignData,
+  IN     UINTN                        SignDataSize,
+     OUT SPDM_PENDING_VERIFY          *PendingVerify
+  );
+
+/**
+  This function starts to verify the challenge signature based upon M1M2, for the requester.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SignData                     The signature data buffer.
+  @param  SignDataSize                 Size in bytes of the signature data buffer.
+  @param  PendingVerify                The pending verification, if RETURN_NOT_READY is returned.
+
+  @retval RETURN_SUCCESS               The signature is verified.
+  @retval RETURN_NOT_READY             The verification is pending.
+  @retval RETURN_SECURITY_VIOLATION    The signature is not verified.
+**/
+RETURN_STATUS
+SpdmStartVerifyChallengeAuthSignature (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     VOID                         *SignData,
+  IN     UINTN                        SignDataSize,
+     OUT SPDM_PENDING_VERIFY          *PendingVerify
+  );
+
+/**
+  This function starts to verify the measurement signature based upon L1L2.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SignData                     The signature data buffer.
+  @param  SignDataSize                 Size in bytes of the signature data buffer.
+  @param  PendingVerify                The pending verification, if RETURN_NOT_READY is returned.
+
+  @retval RETURN_SUCCESS               The signature is verified.
+  @retval RETURN_NOT_READY             The verification is pending.
+  @retval RETURN_SECURITY_VIOLATION    The signature is not verified.
+**/
+RETURN_STATUS
+SpdmStartVerifyMeasurementSignature (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     VOID                         *SignData,
+  IN     UINTN                        SignDataSize,
+     OUT SPDM_PENDING_VERIFY          *PendingVerify
+  );
+
+/**
+  This function polls a pending signature verification of the requester.
+
+  The verification is no longer pending once a status other than RETURN_NOT_READY is returned.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  PendingVerify                The pending verification.
+  @param  Wait                         TRUE to wait until the verification is completed.
+
+  @retval RETURN_SUCCESS               The signature is verified, or no verification is pending.
+  @retval RETURN_NOT_READY             The verification is still pending. It is not returned if Wait is TRUE.
+  @retval RETURN_SECURITY_VIOLATION    The signature is not verified.
+**/
+RETURN_STATUS
+SpdmPollVerifySignature (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN OUT SPDM_PENDING_VERIFY          *PendingVerify,
+  IN     BOOLEAN                      Wait
+  );
+
+/**
+  This function releases the running TH hash of an SPDM session.
+
+  @param  SessionInfo                  The session info of an SPDM session.
+**/
+VOID
+SpdmResetSessionTranscriptDigest (
+  IN     SPDM_SESSION_INFO         *SessionInfo
+  );
+
+/**
+  This function calculates current TH hash from the running TH hash of the session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of an SPDM session.
+  @param  CertChainData                Certitiface chain data without SPDM_CERT_CHAIN header.
+  @param  CertChainDataSize            Size in bytes of the certitiface chain data.
+  @param  MutCertChainData             Certitiface chain data without SPDM_CERT_CHAIN header in mutual authentication.
+  @param  MutCertChainDataSize         Size in bytes of the certitiface chain data in mutual authentication.
+  @param  IncludeMessageF              Indicate if the TH includes Message F.
+  @param  THHashData                   The buffer to store the TH hash.
+
+  @retval TRUE  current TH hash is calculated.
+  @retval FALSE current TH hash cannot be calculated from the running TH hash.
+**/
+BOOLEAN
+SpdmCalculateTHHashFromDigest (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     SPDM_SESSION_INFO         *SessionInfo,
+  IN     UINT8                     *CertChainData, OPTIONAL
+  IN     UINTN                     CertChainDataSize, OPTIONAL
+  IN     UINT8                     *MutCertChainData, OPTIONAL
+  IN     UINTN                     MutCertChainDataSize, OPTIONAL
+  IN     BOOLEAN                   IncludeMessageF,
+     OUT UINT8                     *THHashData
+  );
+
 /**
   This function generates the key exchange signature based upon TH.
 
@@ -718,10 +3069,11 @@ SpdmVerifyMeasurementSignature (
   @param  SessionInfo                  The session info of an SPDM session.
   @param  Signature                    The buffer to store the key exchange signature.
 
-  @retval TRUE  key exchange signature is generated.
-  @retval FALSE key exchange signature is not generated.
+  @retval RETURN_SUCCESS               key exchange signature is generated.
+  @retval RETURN_NOT_READY             the responder signing is pending.
+  @retval RETURN_DEVICE_ERROR          key exchange signature is not generated.
 **/
-BOOLEAN
+RETURN_STATUS
 SpdmGenerateKeyExchangeRspSignature (
   IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
   IN     SPDM_SESSION_INFO         *SessionInfo,
@@ -963,6 +3315,18 @@ SpdmVerifyPskFinishReqHmac (
   IN  UINTN                     HmacSize
   );
 
+/**
+  Serialize the opaque data supported version and version selection from the local SecuredMessageVersion.
+
+  This function should be called whenever the local SecuredMessageVersion is set.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmUpdateOpaqueData (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
 /**
   Return the size in bytes of opaque data supproted version.
 
@@ -1065,4 +3429,153 @@ SpdmProcessOpaqueDataSupportedVersionData (
   IN     VOID                 *DataIn
   );
 
+//
+// The kind of a field of an SPDM message layout.
+//
+// SPDM_MESSAGE_FIELD_FIXED:    Size bytes.
+// SPDM_MESSAGE_FIELD_PARAM:    FieldParam[Size] bytes, for the fields sized by the negotiated algorithms.
+// SPDM_MESSAGE_FIELD_LENGTH16: a UINT16 length followed by that many bytes, of up to Size bytes if Size is not 0.
+// SPDM_MESSAGE_FIELD_LENGTH24: a 24-bit length followed by that many bytes, of up to Size bytes if Size is not 0.
+//
+#define SPDM_MESSAGE_FIELD_FIXED     0
+#define SPDM_MESSAGE_FIELD_PARAM     1
+#define SPDM_MESSAGE_FIELD_LENGTH16  2
+#define SPDM_MESSAGE_FIELD_LENGTH24  3
+
+//
+// One field of an SPDM message layout. A layout is an array of fields, in the order of the message.
+//
+typedef struct {
+  UINT8                Kind;
+  UINT32               Size;
+} SPDM_MESSAGE_FIELD;
+
+//
+// A typed view of one field of a message, pointing into the message buffer.
+// For a length field, Data points to the bytes after the length.
+//
+typedef struct {
+  UINT8                *Data;
+  UINTN                Size;
+} SPDM_MESSAGE_FIELD_VIEW;
+
+//
+// The FieldParam indexes of the algorithm sized fields.
+//
+#define SPDM_MESSAGE_PARAM_DHE_KEY_SIZE                  0
+#define SPDM_MESSAGE_PARAM_MEASUREMENT_SUMMARY_HASH_SIZE 1
+#define SPDM_MESSAGE_PARAM_SIGNATURE_SIZE                2
+#define SPDM_MESSAGE_PARAM_HMAC_SIZE                     3
+#define SPDM_MESSAGE_PARAM_COUNT                         4
+
+//
+// KEY_EXCHANGE: the request header, ExchangeData and OpaqueData.
+//
+#define SPDM_KEY_EXCHANGE_FIELD_HEADER                   0
+#define SPDM_KEY_EXCHANGE_FIELD_EXCHANGE_DATA            1
+#define SPDM_KEY_EXCHANGE_FIELD_OPAQUE_DATA              2
+#define SPDM_KEY_EXCHANGE_FIELD_COUNT                    3
+
+//
+// KEY_EXCHANGE_RSP: the response header, ExchangeData, MeasurementSummaryHash, OpaqueData,
+// Signature and ResponderVerifyData.
+//
+#define SPDM_KEY_EXCHANGE_RSP_FIELD_HEADER               0
+#define SPDM_KEY_EXCHANGE_RSP_FIELD_EXCHANGE_DATA        1
+#define SPDM_KEY_EXCHANGE_RSP_FIELD_MEASUREMENT_SUMMARY_HASH 2
+#define SPDM_KEY_EXCHANGE_RSP_FIELD_OPAQUE_DATA          3
+#define SPDM_KEY_EXCHANGE_RSP_FIELD_SIGNATURE            4
+#define SPDM_KEY_EXCHANGE_RSP_FIELD_VERIFY_DATA          5
+#define SPDM_KEY_EXCHANGE_RSP_FIELD_COUNT                6
+
+//
+// Measurement block: the Index and MeasurementSpecification, and the Measurement after MeasurementSize.
+//
+#define SPDM_MEASUREMENT_BLOCK_FIELD_HEADER              0
+#define SPDM_MEASUREMENT_BLOCK_FIELD_MEASUREMENT         1
+#define SPDM_MEASUREMENT_BLOCK_FIELD_COUNT               2
+
+extern CONST SPDM_MESSAGE_FIELD  mSpdmKeyExchangeLayout[SPDM_KEY_EXCHANGE_FIELD_COUNT];
+extern CONST SPDM_MESSAGE_FIELD  mSpdmKeyExchangeRspLayout[SPDM_KEY_EXCHANGE_RSP_FIELD_COUNT];
+extern CONST SPDM_MESSAGE_FIELD  mSpdmMeasurementBlockLayout[SPDM_MEASUREMENT_BLOCK_FIELD_COUNT];
+
+/**
+  Fill the FieldParam of the algorithm sized fields from the negotiated algorithms.
+
+  The DHE key, signature and HMAC sizes are those of the connection. The measurement summary hash size
+  is that of MeasurementHashType, and the HMAC size is 0 if the handshake is in the clear.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsRequester                  Is the function called from a requester.
+  @param  MeasurementHashType          The type of the measurement summary hash of the message.
+  @param  FieldParam                   The FieldParam, of SPDM_MESSAGE_PARAM_COUNT entries.
+**/
+VOID
+SpdmGetMessageFieldParam (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     BOOLEAN              IsRequester,
+  IN     UINT8                MeasurementHashType,
+     OUT UINTN                *FieldParam
+  );
+
+/**
+  Parse a message with its layout.
+
+  The size of the fixed part of the layout is checked once, and one more check is made for each length field.
+  No data is copied: the views point into the message.
+
+  @param  Layout                       The layout of the message.
+  @param  FieldCount                   The number of fields of the layout.
+  @param  FieldParam                   The sizes of the SPDM_MESSAGE_FIELD_PARAM fields. It may be NULL if there is none.
+  @param  Message                      A pointer to the message.
+  @param  MessageSize                  Size in bytes of the message.
+  @param  View                         The view of each field, of FieldCount entries.
+  @param  ParsedSize                   The size in bytes of the message by its layout.
+                                       The bytes after it in the message are not parsed.
+
+  @retval RETURN_SUCCESS               The message is parsed.
+  @retval RETURN_BAD_BUFFER_SIZE       The message is shorter than its layout, or a length is over its maximum.
+**/
+RETURN_STATUS
+SpdmParseMessage (
+  IN     CONST SPDM_MESSAGE_FIELD  *Layout,
+  IN     UINTN                     FieldCount,
+  IN     CONST UINTN               *FieldParam OPTIONAL,
+  IN     VOID                      *Message,
+  IN     UINTN                     MessageSize,
+     OUT SPDM_MESSAGE_FIELD_VIEW   *View,
+     OUT UINTN                     *ParsedSize OPTIONAL
+  );
+
+/**
+  Lay a message out in a buffer with its layout.
+
+  The total size is checked once against the buffer, and the lengths of the length fields are written.
+  The caller then writes each field in place at its view, so the message is built directly in the buffer.
+
+  @param  Layout                       The layout of the message.
+  @param  FieldCount                   The number of fields of the layout.
+  @param  FieldParam                   The sizes of the SPDM_MESSAGE_FIELD_PARAM fields. It may be NULL if there is none.
+  @param  Buffer                       A pointer to the buffer to build the message in.
+  @param  BufferSize                   Size in bytes of the buffer.
+  @param  View                         The view of each field, of FieldCount entries.
+                                       On input, the Size of each length field is its length.
+                                       On output, the Data and Size of each field in the buffer.
+  @param  MessageSize                  The size in bytes of the message.
+
+  @retval RETURN_SUCCESS               The message is laid out.
+  @retval RETURN_BAD_BUFFER_SIZE       A length is over its maximum.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the message.
+**/
+RETURN_STATUS
+SpdmLayoutMessage (
+  IN     CONST SPDM_MESSAGE_FIELD  *Layout,
+  IN     UINTN                     FieldCount,
+  IN     CONST UINTN               *FieldParam OPTIONAL,
+     OUT VOID                      *Buffer,
+  IN     UINTN                     BufferSize,
+  IN OUT SPDM_MESSAGE_FIELD_VIEW   *View,
+     OUT UINTN                     *MessageSize
+  );
+
 #endif
@@ -0,0 +1,394 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmCommonLibInternal.h"
+
+/**
+  Register the measurement block collection function of the responder to an SPDM context.
+
+  The responder serves GET_MEASUREMENTS and the measurement summary hash from the measurement record
+  collected with SpdmMeasurementCollectionFunc. The record is kept until SpdmMeasurementChanged reports a change,
+  unless the responder advertises MEAS_FRESH_CAP.
+  With CollectionFunc, only the changed measurement blocks are recollected. Without it, the whole record is recollected.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CollectionFunc               The function to collect one measurement block, or NULL to recollect the whole record.
+**/
+VOID
+EFIAPI
+SpdmRegisterMeasurementBlockCollectionFunc (
+  IN     VOID                                   *Context,
+  IN     SPDM_MEASUREMENT_BLOCK_COLLECTION_FUNC CollectionFunc OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->MeasurementBlockCollectionFunc = (UINTN)CollectionFunc;
+  SpdmContext->LocalMeasurementCache.ChangeCount++;
+  return ;
+}
+
+/**
+  Register the measurement block iterator of the responder to an SPDM context.
+
+  With IteratorFunc, GET_MEASUREMENTS and the measurement summary hash are served from the blocks collected
+  one by one with IteratorFunc, instead of the measurement record kept in the SPDM context.
+  A MEASUREMENTS response larger than the transport maximum message size is retrieved by CHUNK_GET.
+  The measurement summary hash is kept until SpdmMeasurementChanged reports a change.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IteratorFunc                 The function to collect one measurement block, or NULL to use the measurement record.
+**/
+VOID
+EFIAPI
+SpdmRegisterMeasurementBlockIteratorFunc (
+  IN     VOID                                 *Context,
+  IN     SPDM_MEASUREMENT_BLOCK_ITERATOR_FUNC IteratorFunc OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->MeasurementBlockIteratorFunc = (UINTN)IteratorFunc;
+  SpdmContext->LocalMeasurementCache.ChangeCount++;
+  return ;
+}
+
+/**
+  Notify an SPDM context that a measurement of the device changes.
+
+  The changed measurement block is recollected when the measurement record is used next.
+  The other measurement blocks are served from the measurement record kept in the SPDM context.
+  The measurement summary hashes are recomputed when they are used next.
+  A notification while the block is being recollected causes it to be recollected again.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementIndex             The index of the changed measurement block, starting from 1,
+                                       or SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS
+                                       if the count or all measurement blocks change.
+**/
+VOID
+EFIAPI
+SpdmMeasurementChanged (
+  IN     VOID                                *Context,
+  IN     UINT8                               MeasurementIndex
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+  SPDM_LOCAL_MEASUREMENT_CACHE  *MeasurementCache;
+
+  SpdmContext = Context;
+  MeasurementCache = &SpdmContext->LocalMeasurementCache;
+  MeasurementCache->ChangeCount++;
+
+  if ((MeasurementIndex == 0) || (MeasurementIndex > MeasurementCache->BlockCount) ||
+      (MeasurementIndex > MAX_SPDM_MEASUREMENT_BLOCK_COUNT)) {
+    MeasurementCache->RecordGeneration++;
+    return ;
+  }
+  MeasurementCache->Generation[MeasurementIndex - 1]++;
+  return ;
+}
+
+/**
+  Return if the measurements of the responder are recomputed for every request.
+
+  With MEAS_FRESH_CAP, the measurement record and the measurement summary hashes are recollected on every use.
+  Without it, they are the measurements collected once, and recollected only after SpdmMeasurementChanged.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval TRUE  the responder advertises MEAS_FRESH_CAP.
+  @retval FALSE the responder serves the measurements kept in the measurement cache.
+**/
+BOOLEAN
+SpdmIsMeasurementFresh (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  return (BOOLEAN)((SpdmContext->LocalContext.Capability.Flags & SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_FRESH_CAP) != 0);
+}
+
+/**
+  Collect the whole measurement record of the device to the measurement cache.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval TRUE  the measurement record is collected.
+  @retval FALSE the measurement record is not collected.
+**/
+BOOLEAN
+SpdmCollectMeasurementRecord (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_LOCAL_MEASUREMENT_CACHE  *MeasurementCache;
+  UINT32                        RecordGeneration;
+  UINT32                        Generation[MAX_SPDM_MEASUREMENT_BLOCK_COUNT];
+  UINT8                         DeviceMeasurementCount;
+  UINTN                         DeviceMeasurementSize;
+  BOOLEAN                       Ret;
+
+  MeasurementCache = &SpdmContext->LocalMeasurementCache;
+  MeasurementCache->Valid = FALSE;
+
+  RecordGeneration = MeasurementCache->RecordGeneration;
+  CopyMem (Generation, MeasurementCache->Generation, sizeof(Generation));
+
+  DeviceMeasurementSize = sizeof(MeasurementCache->Record);
+  Ret = SpdmMeasurementCollectionFunc (
+          SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec,
+          SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo,
+          &DeviceMeasurementCount,
+          MeasurementCache->Record,
+          &DeviceMeasurementSize
+          );
+  if (!Ret) {
+    return FALSE;
+  }
+  ASSERT(DeviceMeasurementCount <= MAX_SPDM_MEASUREMENT_BLOCK_COUNT);
+  if (DeviceMeasurementCount > MAX_SPDM_MEASUREMENT_BLOCK_COUNT) {
+    return FALSE;
+  }
+
+  MeasurementCache->MeasurementSpec = SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec;
+  MeasurementCache->MeasurementHashAlgo = SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo;
+  MeasurementCache->BlockCount = DeviceMeasurementCount;
+  MeasurementCache->RecordSize = DeviceMeasurementSize;
+  MeasurementCache->CollectedRecordGeneration = RecordGeneration;
+  CopyMem (MeasurementCache->BlockGeneration, Generation, sizeof(Generation));
+  MeasurementCache->Valid = TRUE;
+  return TRUE;
+}
+
+/**
+  Recollect the changed measurement blocks of the measurement cache with the measurement block collection function.
+
+  The measurement cache is left unchanged if a measurement block is not collected.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval TRUE  the changed measurement blocks are recollected.
+  @retval FALSE the changed measurement blocks are not recollected.
+**/
+BOOLEAN
+SpdmRecollectMeasurementBlocks (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_LOCAL_MEASUREMENT_CACHE            *MeasurementCache;
+  SPDM_MEASUREMENT_BLOCK_COLLECTION_FUNC  CollectionFunc;
+  UINT8                                   *Record;
+  UINTN                                   RecordSize;
+  UINT32                                  BlockGeneration[MAX_SPDM_MEASUREMENT_BLOCK_COUNT];
+  SPDM_MEASUREMENT_BLOCK_DMTF             *CachedMeasurmentBlock;
+  UINTN                                   MeasurmentBlockSize;
+  UINTN                                   Index;
+  BOOLEAN                                 Ret;
+
+  MeasurementCache = &SpdmContext->LocalMeasurementCache;
+  CollectionFunc = (SPDM_MEASUREMENT_BLOCK_COLLECTION_FUNC)SpdmContext->MeasurementBlockCollectionFunc;
+
+  Record = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MEASUREMENT_RECORD_SIZE);
+  if (Record == NULL) {
+    return FALSE;
+  }
+  RecordSize = 0;
+  CachedMeasurmentBlock = (VOID *)MeasurementCache->Record;
+  for (Index = 0; Index < MeasurementCache->BlockCount; Index++) {
+    MeasurmentBlockSize = sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + CachedMeasurmentBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueSize;
+    BlockGeneration[Index] = MeasurementCache->Generation[Index];
+    if (BlockGeneration[Index] == MeasurementCache->BlockGeneration[Index]) {
+      CopyMem (&Record[RecordSize], CachedMeasurmentBlock, MeasurmentBlockSize);
+      RecordSize += MeasurmentBlockSize;
+    } else {
+      MeasurmentBlockSize = MAX_SPDM_MEASUREMENT_RECORD_SIZE - RecordSize;
+      Ret = CollectionFunc (
+              SpdmContext,
+              MeasurementCache->MeasurementSpec,
+              MeasurementCache->MeasurementHashAlgo,
+              (UINT8)(Index + 1),
+              &Record[RecordSize],
+              &MeasurmentBlockSize
+              );
+      if (!Ret) {
+        SpdmReleaseScratch (SpdmContext, Record);
+        return FALSE;
+      }
+      RecordSize += MeasurmentBlockSize;
+    }
+    CachedMeasurmentBlock = (VOID *)((UINTN)CachedMeasurmentBlock + sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) +
+                                     CachedMeasurmentBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueSize);
+  }
+
+  CopyMem (MeasurementCache->Record, Record, RecordSize);
+  SpdmReleaseScratch (SpdmContext, Record);
+  MeasurementCache->RecordSize = RecordSize;
+  CopyMem (MeasurementCache->BlockGeneration, BlockGeneration, MeasurementCache->BlockCount * sizeof(UINT32));
+  return TRUE;
+}
+
+/**
+  Return the measurement record of the device for the negotiated MeasurementSpec and MeasurementHashAlgo.
+
+  The record is served from the measurement cache of the SPDM context. Only the blocks changed since they
+  were collected are recollected, with the registered measurement block collection function if any.
+  Otherwise the whole record is recollected with SpdmMeasurementCollectionFunc.
+  If the responder advertises MEAS_FRESH_CAP, the whole record is recollected on every call.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  DeviceMeasurementCount       The count of the device measurement blocks.
+  @param  DeviceMeasurement            The concatenation of all device measurement blocks.
+                                       It is valid until the next call or SpdmMeasurementChanged.
+  @param  DeviceMeasurementSize        The size in bytes of all device measurement blocks.
+
+  @retval TRUE  the measurement record is returned.
+  @retval FALSE the measurement record is not collected.
+**/
+BOOLEAN
+SpdmGetMeasurementRecord (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+     OUT UINT8                *DeviceMeasurementCount,
+     OUT UINT8                **DeviceMeasurement,
+     OUT UINTN                *DeviceMeasurementSize
+  )
+{
+  SPDM_LOCAL_MEASUREMENT_CACHE  *MeasurementCache;
+  BOOLEAN                       BlockChanged;
+  UINTN                         Index;
+  BOOLEAN                       Ret;
+
+  MeasurementCache = &SpdmContext->LocalMeasurementCache;
+
+  if ((!MeasurementCache->Valid) ||
+      SpdmIsMeasurementFresh (SpdmContext) ||
+      (MeasurementCache->CollectedRecordGeneration != MeasurementCache->RecordGeneration) ||
+      (MeasurementCache->MeasurementSpec != SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec) ||
+      (MeasurementCache->MeasurementHashAlgo != SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo)) {
+    Ret = SpdmCollectMeasurementRecord (SpdmContext);
+  } else {
+    BlockChanged = FALSE;
+    for (Index = 0; Index < MeasurementCache->BlockCount; Index++) {
+      if (MeasurementCache->Generation[Index] != MeasurementCache->BlockGeneration[Index]) {
+        BlockChanged = TRUE;
+        break;
+      }
+    }
+    if (!BlockChanged) {
+      Ret = TRUE;
+    } else if (SpdmContext->MeasurementBlockCollectionFunc != 0) {
+      Ret = SpdmRecollectMeasurementBlocks (SpdmContext);
+    } else {
+      Ret = SpdmCollectMeasurementRecord (SpdmContext);
+    }
+  }
+  if (!Ret) {
+    return FALSE;
+  }
+
+  *DeviceMeasurementCount = MeasurementCache->BlockCount;
+  *DeviceMeasurement = MeasurementCache->Record;
+  *DeviceMeasurementSize = MeasurementCache->RecordSize;
+  return TRUE;
+}
+
+/**
+  Collect one measurement block of the device with the registered measurement block iterator,
+  for the negotiated MeasurementSpec and MeasurementHashAlgo.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementIndex             The index of the measurement block, starting from 1.
+  @param  MeasurementBlock             A pointer to a destination buffer to store the measurement block.
+  @param  MeasurementBlockSize         On input, indicates the size in bytes of the destination buffer.
+                                       On output, indicates the size in bytes of the measurement block.
+
+  @retval RETURN_SUCCESS               The measurement block is returned.
+  @retval RETURN_NOT_FOUND             The device has no measurement block of the index.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the measurement block.
+  @retval RETURN_DEVICE_ERROR          The measurement block is not a valid DMTF measurement block.
+  @retval others                       The measurement block is not collected.
+**/
+RETURN_STATUS
+SpdmIterateMeasurementBlock (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementIndex,
+     OUT VOID                 *MeasurementBlock OPTIONAL,
+  IN OUT UINTN                *MeasurementBlockSize
+  )
+{
+  SPDM_MEASUREMENT_BLOCK_ITERATOR_FUNC    IteratorFunc;
+  SPDM_MEASUREMENT_BLOCK_DMTF             *MeasurmentBlock;
+  UINTN                                   BufferSize;
+  RETURN_STATUS                           Status;
+
+  IteratorFunc = (SPDM_MEASUREMENT_BLOCK_ITERATOR_FUNC)SpdmContext->MeasurementBlockIteratorFunc;
+  ASSERT (IteratorFunc != NULL);
+
+  BufferSize = *MeasurementBlockSize;
+  Status = IteratorFunc (
+             SpdmContext,
+             SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec,
+             SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo,
+             MeasurementIndex,
+             (BufferSize == 0) ? NULL : MeasurementBlock,
+             MeasurementBlockSize
+             );
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  MeasurmentBlock = MeasurementBlock;
+  if ((*MeasurementBlockSize > BufferSize) ||
+      (*MeasurementBlockSize < sizeof(SPDM_MEASUREMENT_BLOCK_DMTF)) ||
+      (*MeasurementBlockSize != sizeof(SPDM_MEASUREMENT_BLOCK_COMMON_HEADER) + MeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize) ||
+      (MeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize !=
+       sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER) + MeasurmentBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueSize)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Count the measurement blocks of the device with the registered measurement block iterator.
+
+  Each index is probed with an empty buffer, so no measurement block is collected.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  DeviceMeasurementCount       The count of the device measurement blocks.
+
+  @retval RETURN_SUCCESS               The count is returned.
+  @retval others                       The iterator fails.
+**/
+RETURN_STATUS
+SpdmCountMeasurementBlocks (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+     OUT UINT8                *DeviceMeasurementCount
+  )
+{
+  UINTN                                   Index;
+  UINTN                                   MeasurmentBlockSize;
+  RETURN_STATUS                           Status;
+
+  //
+  // Index 0xFF means all measurements, so the last index is 0xFE.
+  //
+  for (Index = 1; Index < SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS; Index++) {
+    MeasurmentBlockSize = 0;
+    Status = SpdmIterateMeasurementBlock (SpdmContext, (UINT8)Index, NULL, &MeasurmentBlockSize);
+    if (Status == RETURN_NOT_FOUND) {
+      break;
+    }
+    if (Status != RETURN_BUFFER_TOO_SMALL) {
+      return RETURN_ERROR(Status) ? Status : RETURN_DEVICE_ERROR;
+    }
+  }
+  *DeviceMeasurementCount = (UINT8)(Index - 1);
+  return RETURN_SUCCESS;
+}
@@ -0,0 +1,248 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmCommonLibInternal.h"
+
+CONST SPDM_MESSAGE_FIELD  mSpdmKeyExchangeLayout[SPDM_KEY_EXCHANGE_FIELD_COUNT] = {
+  {SPDM_MESSAGE_FIELD_FIXED,    sizeof(SPDM_KEY_EXCHANGE_REQUEST)},
+  {SPDM_MESSAGE_FIELD_PARAM,    SPDM_MESSAGE_PARAM_DHE_KEY_SIZE},
+  {SPDM_MESSAGE_FIELD_LENGTH16, MAX_SPDM_OPAQUE_DATA_SIZE},
+};
+
+CONST SPDM_MESSAGE_FIELD  mSpdmKeyExchangeRspLayout[SPDM_KEY_EXCHANGE_RSP_FIELD_COUNT] = {
+  {SPDM_MESSAGE_FIELD_FIXED,    sizeof(SPDM_KEY_EXCHANGE_RESPONSE)},
+  {SPDM_MESSAGE_FIELD_PARAM,    SPDM_MESSAGE_PARAM_DHE_KEY_SIZE},
+  {SPDM_MESSAGE_FIELD_PARAM,    SPDM_MESSAGE_PARAM_MEASUREMENT_SUMMARY_HASH_SIZE},
+  {SPDM_MESSAGE_FIELD_LENGTH16, MAX_SPDM_OPAQUE_DATA_SIZE},
+  {SPDM_MESSAGE_FIELD_PARAM,    SPDM_MESSAGE_PARAM_SIGNATURE_SIZE},
+  {SPDM_MESSAGE_FIELD_PARAM,    SPDM_MESSAGE_PARAM_HMAC_SIZE},
+};
+
+CONST SPDM_MESSAGE_FIELD  mSpdmMeasurementBlockLayout[SPDM_MEASUREMENT_BLOCK_FIELD_COUNT] = {
+  {SPDM_MESSAGE_FIELD_FIXED,    OFFSET_OF(SPDM_MEASUREMENT_BLOCK_COMMON_HEADER, MeasurementSize)},
+  {SPDM_MESSAGE_FIELD_LENGTH16, 0},
+};
+
+/**
+  Return the size in bytes of the length of a length field, or 0 for the other fields.
+
+  @param  Kind                         The kind of the field.
+
+  @return the size in bytes of the length.
+**/
+UINTN
+SpdmGetMessageFieldLengthSize (
+  IN     UINT8                Kind
+  )
+{
+  switch (Kind) {
+  case SPDM_MESSAGE_FIELD_LENGTH16:
+    return sizeof(UINT16);
+  case SPDM_MESSAGE_FIELD_LENGTH24:
+    return 3;
+  default:
+    return 0;
+  }
+}
+
+/**
+  Fill the FieldParam of the algorithm sized fields from the negotiated algorithms.
+
+  The DHE key, signature and HMAC sizes are those of the connection. The measurement summary hash size
+  is that of MeasurementHashType, and the HMAC size is 0 if the handshake is in the clear.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsRequester                  Is the function called from a requester.
+  @param  MeasurementHashType          The type of the measurement summary hash of the message.
+  @param  FieldParam                   The FieldParam, of SPDM_MESSAGE_PARAM_COUNT entries.
+**/
+VOID
+SpdmGetMessageFieldParam (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     BOOLEAN              IsRequester,
+  IN     UINT8                MeasurementHashType,
+     OUT UINTN                *FieldParam
+  )
+{
+  FieldParam[SPDM_MESSAGE_PARAM_DHE_KEY_SIZE] = GetSpdmDhePubKeySize (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup);
+  FieldParam[SPDM_MESSAGE_PARAM_MEASUREMENT_SUMMARY_HASH_SIZE] = SpdmGetMeasurementSummaryHashSize (SpdmContext, IsRequester, MeasurementHashType);
+  FieldParam[SPDM_MESSAGE_PARAM_SIGNATURE_SIZE] = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
+  FieldParam[SPDM_MESSAGE_PARAM_HMAC_SIZE] = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
+  if (SpdmIsCapabilitiesFlagSupported(SpdmContext, IsRequester, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP)) {
+    FieldParam[SPDM_MESSAGE_PARAM_HMAC_SIZE] = 0;
+  }
+}
+
+/**
+  Parse a message with its layout.
+
+  The size of the fixed part of the layout is checked once, and one more check is made for each length field.
+  No data is copied: the views point into the message.
+
+  @param  Layout                       The layout of the message.
+  @param  FieldCount                   The number of fields of the layout.
+  @param  FieldParam                   The sizes of the SPDM_MESSAGE_FIELD_PARAM fields. It may be NULL if there is none.
+  @param  Message                      A pointer to the message.
+  @param  MessageSize                  Size in bytes of the message.
+  @param  View                         The view of each field, of FieldCount entries.
+  @param  ParsedSize                   The size in bytes of the message by its layout.
+                                       The bytes after it in the message are not parsed.
+
+  @retval RETURN_SUCCESS               The message is parsed.
+  @retval RETURN_BAD_BUFFER_SIZE       The message is shorter than its layout, or a length is over its maximum.
+**/
+RETURN_STATUS
+SpdmParseMessage (
+  IN     CONST SPDM_MESSAGE_FIELD  *Layout,
+  IN     UINTN                     FieldCount,
+  IN     CONST UINTN               *FieldParam OPTIONAL,
+  IN     VOID                      *Message,
+  IN     UINTN                     MessageSize,
+     OUT SPDM_MESSAGE_FIELD_VIEW   *View,
+     OUT UINTN                     *ParsedSize OPTIONAL
+  )
+{
+  UINTN                Index;
+  UINTN                RequiredSize;
+  UINTN                Length;
+  UINT8                *Ptr;
+
+  //
+  // The fixed part: all fields but the data of the length fields.
+  //
+  RequiredSize = 0;
+  for (Index = 0; Index < FieldCount; Index++) {
+    switch (Layout[Index].Kind) {
+    case SPDM_MESSAGE_FIELD_FIXED:
+      RequiredSize += Layout[Index].Size;
+      break;
+    case SPDM_MESSAGE_FIELD_PARAM:
+      ASSERT (FieldParam != NULL);
+      RequiredSize += FieldParam[Layout[Index].Size];
+      break;
+    default:
+      RequiredSize += SpdmGetMessageFieldLengthSize (Layout[Index].Kind);
+      break;
+    }
+  }
+  if (MessageSize < RequiredSize) {
+    return RETURN_BAD_BUFFER_SIZE;
+  }
+
+  //
+  // A length is read only when all fields before it are within the checked size.
+  //
+  Ptr = Message;
+  for (Index = 0; Index < FieldCount; Index++) {
+    switch (Layout[Index].Kind) {
+    case SPDM_MESSAGE_FIELD_FIXED:
+      Length = Layout[Index].Size;
+      break;
+    case SPDM_MESSAGE_FIELD_PARAM:
+      Length = FieldParam[Layout[Index].Size];
+      break;
+    default:
+      if (Layout[Index].Kind == SPDM_MESSAGE_FIELD_LENGTH16) {
+        Length = *(UINT16 *)Ptr;
+      } else {
+        Length = SpdmReadUint24 (Ptr);
+      }
+      Ptr += SpdmGetMessageFieldLengthSize (Layout[Index].Kind);
+      if ((Layout[Index].Size != 0) && (Length > Layout[Index].Size)) {
+        return RETURN_BAD_BUFFER_SIZE;
+      }
+      RequiredSize += Length;
+      if (MessageSize < RequiredSize) {
+        return RETURN_BAD_BUFFER_SIZE;
+      }
+      break;
+    }
+    View[Index].Data = Ptr;
+    View[Index].Size = Length;
+    Ptr += Length;
+  }
+
+  if (ParsedSize != NULL) {
+    *ParsedSize = RequiredSize;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Lay a message out in a buffer with its layout.
+
+  The total size is checked once against the buffer, and the lengths of the length fields are written.
+  The caller then writes each field in place at its view, so the message is built directly in the buffer.
+
+  @param  Layout                       The layout of the message.
+  @param  FieldCount                   The number of fields of the layout.
+  @param  FieldParam                   The sizes of the SPDM_MESSAGE_FIELD_PARAM fields. It may be NULL if there is none.
+  @param  Buffer                       A pointer to the buffer to build the message in.
+  @param  BufferSize                   Size in bytes of the buffer.
+  @param  View                         The view of each field, of FieldCount entries.
+                                       On input, the Size of each length field is its length.
+                                       On output, the Data and Size of each field in the buffer.
+  @param  MessageSize                  The size in bytes of the message.
+
+  @retval RETURN_SUCCESS               The message is laid out.
+  @retval RETURN_BAD_BUFFER_SIZE       A length is over its maximum.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the message.
+**/
+RETURN_STATUS
+SpdmLayoutMessage (
+  IN     CONST SPDM_MESSAGE_FIELD  *Layout,
+  IN     UINTN                     FieldCount,
+  IN     CONST UINTN               *FieldParam OPTIONAL,
+     OUT VOID                      *Buffer,
+  IN     UINTN                     BufferSize,
+  IN OUT SPDM_MESSAGE_FIELD_VIEW   *View,
+     OUT UINTN                     *MessageSize
+  )
+{
+  UINTN                Index;
+  UINTN                TotalSize;
+  UINT8                *Ptr;
+
+  TotalSize = 0;
+  for (Index = 0; Index < FieldCount; Index++) {
+    switch (Layout[Index].Kind) {
+    case SPDM_MESSAGE_FIELD_FIXED:
+      View[Index].Size = Layout[Index].Size;
+      break;
+    case SPDM_MESSAGE_FIELD_PARAM:
+      ASSERT (FieldParam != NULL);
+      View[Index].Size = FieldParam[Layout[Index].Size];
+      break;
+    default:
+      if ((Layout[Index].Size != 0) && (View[Index].Size > Layout[Index].Size)) {
+        return RETURN_BAD_BUFFER_SIZE;
+      }
+      TotalSize += SpdmGetMessageFieldLengthSize (Layout[Index].Kind);
+      break;
+    }
+    TotalSize += View[Index].Size;
+  }
+  *MessageSize = TotalSize;
+  if (BufferSize < TotalSize) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  Ptr = Buffer;
+  for (Index = 0; Index < FieldCount; Index++) {
+    if (Layout[Index].Kind == SPDM_MESSAGE_FIELD_LENGTH16) {
+      *(UINT16 *)Ptr = (UINT16)View[Index].Size;
+    } else if (Layout[Index].Kind == SPDM_MESSAGE_FIELD_LENGTH24) {
+      SpdmWriteUint24 (Ptr, (UINT32)View[Index].Size);
+    }
+    Ptr += SpdmGetMessageFieldLengthSize (Layout[Index].Kind);
+    View[Index].Data = Ptr;
+    Ptr += View[Index].Size;
+  }
+  return RETURN_SUCCESS;
+}
@@ -0,0 +1,195 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmCommonLibInternal.h"
+
+/**
+  Export the negotiated state of an SPDM connection, to be kept across a reset of the requester or the responder.
+
+  The negotiated state is the version, the capabilities and the algorithms of the peer,
+  the VCA transcript (message A), and the verified peer certificate chain with the peer digests.
+  It can only be exported if the responder supports CACHE_CAP.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsRequester                  Indicates if the SPDM context is a requester.
+  @param  NegotiatedStateSize          On input, the size in bytes of the NegotiatedState buffer.
+                                       On output, the size in bytes of the exported negotiated state.
+  @param  NegotiatedState              A pointer to the buffer to export the negotiated state to.
+
+  @retval RETURN_SUCCESS               The negotiated state is exported.
+  @retval RETURN_NOT_STARTED           The connection is not negotiated.
+  @retval RETURN_UNSUPPORTED           The responder does not support CACHE_CAP.
+  @retval RETURN_BUFFER_TOO_SMALL      The NegotiatedState buffer is too small. NegotiatedStateSize is set to the required size.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmExportNegotiatedState (
+  IN     VOID                      *Context,
+  IN     BOOLEAN                   IsRequester,
+  IN OUT UINTN                     *NegotiatedStateSize,
+     OUT VOID                      *NegotiatedState
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
+  SPDM_EXPORTED_NEGOTIATED_STATE            *ExportedState;
+  UINTN                                     MessageASize;
+  UINTN                                     PeerUsedCertChainBufferSize;
+  UINTN                                     TotalSize;
+  UINT8                                     *Ptr;
+
+  SpdmContext = Context;
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+
+  if (ConnectionInfo->ConnectionState < SpdmConnectionStateNegotiated) {
+    return RETURN_NOT_STARTED;
+  }
+  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, IsRequester, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CACHE_CAP)) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  MessageASize = GetManagedBufferSize (&SpdmContext->Transcript.MessageA);
+  //
+  // The peer certificate chain is only verified once it is retrieved.
+  //
+  if (ConnectionInfo->ConnectionState >= SpdmConnectionStateAfterCertificate) {
+    PeerUsedCertChainBufferSize = ConnectionInfo->PeerUsedCertChainBufferSize;
+  } else {
+    PeerUsedCertChainBufferSize = 0;
+  }
+
+  TotalSize = sizeof(SPDM_EXPORTED_NEGOTIATED_STATE) + MessageASize + PeerUsedCertChainBufferSize;
+  if (*NegotiatedStateSize < TotalSize) {
+    *NegotiatedStateSize = TotalSize;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  ExportedState = NegotiatedState;
+  ZeroMem (ExportedState, sizeof(SPDM_EXPORTED_NEGOTIATED_STATE));
+  ExportedState->Signature = SPDM_EXPORTED_NEGOTIATED_STATE_SIGNATURE;
+  ExportedState->Version = SPDM_EXPORTED_NEGOTIATED_STATE_VERSION;
+  CopyMem (&ExportedState->SpdmVersion, &ConnectionInfo->Version, sizeof(SPDM_DEVICE_VERSION));
+  CopyMem (&ExportedState->Capability, &ConnectionInfo->Capability, sizeof(SPDM_DEVICE_CAPABILITY));
+  CopyMem (&ExportedState->Algorithm, &ConnectionInfo->Algorithm, sizeof(SPDM_DEVICE_ALGORITHM));
+  CopyMem (&ExportedState->SecuredMessageVersion, &ConnectionInfo->SecuredMessageVersion, sizeof(SPDM_DEVICE_VERSION));
+  if (PeerUsedCertChainBufferSize != 0) {
+    ExportedState->PeerDigestSlotMask = ConnectionInfo->PeerDigestSlotMask;
+    CopyMem (ExportedState->PeerDigestBuffer, ConnectionInfo->PeerDigestBuffer, sizeof(ExportedState->PeerDigestBuffer));
+  }
+  ExportedState->MessageASize = (UINT32)MessageASize;
+  ExportedState->PeerUsedCertChainBufferSize = (UINT32)PeerUsedCertChainBufferSize;
+
+  Ptr = (UINT8 *)(ExportedState + 1);
+  CopyMem (Ptr, GetManagedBuffer (&SpdmContext->Transcript.MessageA), MessageASize);
+  Ptr += MessageASize;
+  CopyMem (Ptr, ConnectionInfo->PeerUsedCertChainBuffer, PeerUsedCertChainBufferSize);
+
+  *NegotiatedStateSize = TotalSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Import the negotiated state exported by SpdmExportNegotiatedState to an SPDM context.
+
+  The connection state is restored to negotiated, so that GET_VERSION, GET_CAPABILITIES and NEGOTIATE_ALGORITHMS are skipped.
+  The next SpdmInitConnection of a requester returns without sending them.
+  If a peer certificate chain is imported, it is verified again with the local provision,
+  so that GET_DIGESTS and GET_CERTIFICATE can be skipped. The peer is authenticated again by CHALLENGE or KEY_EXCHANGE.
+
+  This function must be called after the local settings are set, and before any SPDM communication.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  NegotiatedStateSize          Size in bytes of the negotiated state.
+  @param  NegotiatedState              A pointer to the negotiated state.
+
+  @retval RETURN_SUCCESS               The negotiated state is imported.
+  @retval RETURN_UNSUPPORTED           The negotiated state is malformed, or exported by another version of the library.
+  @retval RETURN_OUT_OF_RESOURCES      The negotiated state does not fit in the SPDM context.
+  @retval RETURN_SECURITY_VIOLATION    The imported peer certificate chain cannot be verified.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmImportNegotiatedState (
+  IN     VOID                      *Context,
+  IN     UINTN                     NegotiatedStateSize,
+  IN     VOID                      *NegotiatedState
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
+  SPDM_EXPORTED_NEGOTIATED_STATE            *ExportedState;
+  UINT8                                     *Ptr;
+  RETURN_STATUS                             Status;
+
+  SpdmContext = Context;
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+
+  if (NegotiatedStateSize < sizeof(SPDM_EXPORTED_NEGOTIATED_STATE)) {
+    return RETURN_UNSUPPORTED;
+  }
+  ExportedState = NegotiatedState;
+  if ((ExportedState->Signature != SPDM_EXPORTED_NEGOTIATED_STATE_SIGNATURE) ||
+      (ExportedState->Version != SPDM_EXPORTED_NEGOTIATED_STATE_VERSION)) {
+    return RETURN_UNSUPPORTED;
+  }
+  if (NegotiatedStateSize != sizeof(SPDM_EXPORTED_NEGOTIATED_STATE) + (UINTN)ExportedState->MessageASize + (UINTN)ExportedState->PeerUsedCertChainBufferSize) {
+    return RETURN_UNSUPPORTED;
+  }
+  if ((ExportedState->SpdmVersion.SpdmVersionCount == 0) ||
+      (ExportedState->SpdmVersion.SpdmVersionCount > MAX_SPDM_VERSION_COUNT) ||
+      (ExportedState->SecuredMessageVersion.SpdmVersionCount > MAX_SPDM_VERSION_COUNT)) {
+    return RETURN_UNSUPPORTED;
+  }
+  if ((ExportedState->MessageASize > SpdmContext->Transcript.MessageA.MaxBufferSize) ||
+      (ExportedState->PeerUsedCertChainBufferSize > ConnectionInfo->MaxPeerUsedCertChainBufferSize)) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Start the connection over, as GET_VERSION does.
+  //
+  ConnectionInfo->ConnectionState = SpdmConnectionStateNotStarted;
+  ConnectionInfo->NegotiatedStateImported = FALSE;
+  SpdmResetPeerPublicKey (SpdmContext);
+  ZeroMem (&ConnectionInfo->MeasurementCache, sizeof(ConnectionInfo->MeasurementCache));
+  SpdmResetMessageA (SpdmContext);
+  SpdmResetMessageB (SpdmContext);
+  SpdmResetMessageC (SpdmContext);
+  SpdmResetMessageMutB (SpdmContext);
+  SpdmResetMessageMutC (SpdmContext);
+  SpdmResetMessageM (SpdmContext);
+
+  CopyMem (&ConnectionInfo->Version, &ExportedState->SpdmVersion, sizeof(SPDM_DEVICE_VERSION));
+  CopyMem (&ConnectionInfo->Capability, &ExportedState->Capability, sizeof(SPDM_DEVICE_CAPABILITY));
+  CopyMem (&ConnectionInfo->Algorithm, &ExportedState->Algorithm, sizeof(SPDM_DEVICE_ALGORITHM));
+  CopyMem (&ConnectionInfo->SecuredMessageVersion, &ExportedState->SecuredMessageVersion, sizeof(SPDM_DEVICE_VERSION));
+  ConnectionInfo->PeerDigestSlotMask = ExportedState->PeerDigestSlotMask;
+  CopyMem (ConnectionInfo->PeerDigestBuffer, ExportedState->PeerDigestBuffer, sizeof(ConnectionInfo->PeerDigestBuffer));
+
+  Ptr = (UINT8 *)(ExportedState + 1);
+  Status = SpdmAppendMessageA (SpdmContext, Ptr, ExportedState->MessageASize);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  Ptr += ExportedState->MessageASize;
+
+  ConnectionInfo->PeerUsedCertChainBufferSize = ExportedState->PeerUsedCertChainBufferSize;
+  CopyMem (ConnectionInfo->PeerUsedCertChainBuffer, Ptr, ExportedState->PeerUsedCertChainBufferSize);
+  if ((ConnectionInfo->PeerUsedCertChainBufferSize != 0) &&
+      !SpdmVerifyPeerCertChainBuffer (SpdmContext, ConnectionInfo->PeerUsedCertChainBuffer, ConnectionInfo->PeerUsedCertChainBufferSize)) {
+    ConnectionInfo->PeerUsedCertChainBufferSize = 0;
+    ConnectionInfo->PeerDigestSlotMask = 0;
+    SpdmResetMessageA (SpdmContext);
+    return RETURN_SECURITY_VIOLATION;
+  }
+
+  ConnectionInfo->ConnectionState = SpdmConnectionStateNegotiated;
+  ConnectionInfo->NegotiatedStateImported = TRUE;
+  return RETURN_SUCCESS;
+}
@@ -9,6 +9,81 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmCommonLibInternal.h"
 
+/**
+  Serialize the opaque data supported version and version selection from the local SecuredMessageVersion.
+
+  This function should be called whenever the local SecuredMessageVersion is set,
+  so that KEY_EXCHANGE/PSK_EXCHANGE only copy or compare the serialized opaque data.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmUpdateOpaqueData (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SECURED_MESSAGE_GENERAL_OPAQUE_DATA_TABLE_HEADER   *GeneralOpaqueDataTableHeader;
+  SECURED_MESSAGE_OPAQUE_ELEMENT_TABLE_HEADER        *OpaqueElementTableHeader;
+  SECURED_MESSAGE_OPAQUE_ELEMENT_SUPPORTED_VERSION   *OpaqueElementSupportVersion;
+  SECURED_MESSAGE_OPAQUE_ELEMENT_VERSION_SELECTION   *OpaqueElementVersionSection;
+  SPDM_VERSION_NUMBER                                *VersionsList;
+
+  // Zero Padding
+  ZeroMem (SpdmContext->LocalContext.OpaqueDataSupportedVersion, sizeof(SpdmContext->LocalContext.OpaqueDataSupportedVersion));
+  ZeroMem (SpdmContext->LocalContext.OpaqueDataVersionSelection, sizeof(SpdmContext->LocalContext.OpaqueDataVersionSelection));
+
+  if (SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersionCount == 0) {
+    SpdmContext->LocalContext.OpaqueDataSupportedVersionSize = 0;
+    SpdmContext->LocalContext.OpaqueDataVersionSelectionSize = 0;
+    return ;
+  }
+
+  GeneralOpaqueDataTableHeader = (VOID *)SpdmContext->LocalContext.OpaqueDataSupportedVersion;
+  GeneralOpaqueDataTableHeader->SpecId = SECURED_MESSAGE_OPAQUE_DATA_SPEC_ID;
+  GeneralOpaqueDataTableHeader->OpaqueVersion = SECURED_MESSAGE_OPAQUE_VERSION;
+  GeneralOpaqueDataTableHeader->TotalElements = 1;
+  GeneralOpaqueDataTableHeader->Reserved = 0;
+
+  OpaqueElementTableHeader = (VOID *)(GeneralOpaqueDataTableHeader + 1);
+  OpaqueElementTableHeader->Id = SPDM_REGISTRY_ID_DMTF;
+  OpaqueElementTableHeader->VendorLen = 0;
+  OpaqueElementTableHeader->OpaqueElementDataLen = sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_SUPPORTED_VERSION) + sizeof(SPDM_VERSION_NUMBER);
+
+  OpaqueElementSupportVersion = (VOID *)(OpaqueElementTableHeader + 1);
+  OpaqueElementSupportVersion->SMDataVersion = SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_DATA_VERSION;
+  OpaqueElementSupportVersion->SMDataID = SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_ID_SUPPORTED_VERSION;
+  OpaqueElementSupportVersion->VersionCount = 1;
+
+  VersionsList = (VOID *)(OpaqueElementSupportVersion + 1);
+  VersionsList->Alpha = 0;
+  VersionsList->UpdateVersionNumber = 0;
+  VersionsList->MinorVersion = 1;
+  VersionsList->MajorVersion = 1;
+
+  SpdmContext->LocalContext.OpaqueDataSupportedVersionSize = SPDM_OPAQUE_DATA_SUPPORTED_VERSION_SIZE;
+
+  GeneralOpaqueDataTableHeader = (VOID *)SpdmContext->LocalContext.OpaqueDataVersionSelection;
+  GeneralOpaqueDataTableHeader->SpecId = SECURED_MESSAGE_OPAQUE_DATA_SPEC_ID;
+  GeneralOpaqueDataTableHeader->OpaqueVersion = SECURED_MESSAGE_OPAQUE_VERSION;
+  GeneralOpaqueDataTableHeader->TotalElements = 1;
+  GeneralOpaqueDataTableHeader->Reserved = 0;
+
+  OpaqueElementTableHeader = (VOID *)(GeneralOpaqueDataTableHeader + 1);
+  OpaqueElementTableHeader->Id = SPDM_REGISTRY_ID_DMTF;
+  OpaqueElementTableHeader->VendorLen = 0;
+  OpaqueElementTableHeader->OpaqueElementDataLen = sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_VERSION_SELECTION);
+
+  OpaqueElementVersionSection = (VOID *)(OpaqueElementTableHeader + 1);
+  OpaqueElementVersionSection->SMDataVersion = SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_DATA_VERSION;
+  OpaqueElementVersionSection->SMDataID = SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_ID_VERSION_SELECTION;
+  OpaqueElementVersionSection->SelectedVersion.Alpha = 0;
+  OpaqueElementVersionSection->SelectedVersion.UpdateVersionNumber = 0;
+  OpaqueElementVersionSection->SelectedVersion.MinorVersion = 1;
+  OpaqueElementVersionSection->SelectedVersion.MajorVersion = 1;
+
+  SpdmContext->LocalContext.OpaqueDataVersionSelectionSize = SPDM_OPAQUE_DATA_VERSION_SELECTION_SIZE;
+}
+
 /**
   Return the size in bytes of opaque data version selection.
 
@@ -21,17 +96,7 @@ SpdmGetOpaqueDataVersionSelectionDataSize (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext
   )
 {
-  UINTN  Size;
-
-  if (SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersionCount == 0) {
-    return 0;
-  }
-
-  Size = sizeof(SECURED_MESSAGE_GENERAL_OPAQUE_DATA_TABLE_HEADER) +
-         sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_TABLE_HEADER) +
-         sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_VERSION_SELECTION);
-  // Add Padding
-  return (Size + 3) & ~3;
+  return SpdmContext->LocalContext.OpaqueDataVersionSelectionSize;
 }
 
 /**
@@ -46,24 +111,14 @@ SpdmGetOpaqueDataSupportedVersionDataSize (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext
   )
 {
-  UINTN  Size;
-
-  if (SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersionCount == 0) {
-    return 0;
-  }
-
-  Size = sizeof(SECURED_MESSAGE_GENERAL_OPAQUE_DATA_TABLE_HEADER) +
-         sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_TABLE_HEADER) +
-         sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_SUPPORTED_VERSION) +
-         sizeof(SPDM_VERSION_NUMBER);
-  // Add Padding
-  return (Size + 3) & ~3;
+  return SpdmContext->LocalContext.OpaqueDataSupportedVersionSize;
 }
 
 /**
   Build opaque data supported version.
 
   This function should be called in KEY_EXCHANGE/PSK_EXCHANGE request generation.
+  The opaque data is copied from the one serialized by SpdmUpdateOpaqueData.
 
   @param  DataOutSize                  Size in bytes of the DataOut.
                                        On input, it means the size in bytes of DataOut buffer.
@@ -81,49 +136,15 @@ SpdmBuildOpaqueDataSupportedVersionData (
      OUT VOID                 *DataOut
   )
 {
-  UINTN                                              FinalDataSize;
-  SECURED_MESSAGE_GENERAL_OPAQUE_DATA_TABLE_HEADER   *GeneralOpaqueDataTableHeader;
-  SECURED_MESSAGE_OPAQUE_ELEMENT_TABLE_HEADER        *OpaqueElementTableHeader;
-  SECURED_MESSAGE_OPAQUE_ELEMENT_SUPPORTED_VERSION   *OpaqueElementSupportVersion;
-  SPDM_VERSION_NUMBER                                *VersionsList;
-  VOID                                               *End;
+  UINTN  FinalDataSize;
 
-  if (SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersionCount == 0) {
-    *DataOutSize = 0;
-    return RETURN_SUCCESS;
-  }
-
-  FinalDataSize = SpdmGetOpaqueDataSupportedVersionDataSize (SpdmContext);
+  FinalDataSize = SpdmContext->LocalContext.OpaqueDataSupportedVersionSize;
   if (*DataOutSize < FinalDataSize) {
     *DataOutSize = FinalDataSize;
     return RETURN_BUFFER_TOO_SMALL;
   }
-
-  GeneralOpaqueDataTableHeader = DataOut;
-  GeneralOpaqueDataTableHeader->SpecId = SECURED_MESSAGE_OPAQUE_DATA_SPEC_ID;
-  GeneralOpaqueDataTableHeader->OpaqueVersion = SECURED_MESSAGE_OPAQUE_VERSION;
-  GeneralOpaqueDataTableHeader->TotalElements = 1;
-  GeneralOpaqueDataTableHeader->Reserved = 0;
-
-  OpaqueElementTableHeader = (VOID *)(GeneralOpaqueDataTableHeader + 1);
-  OpaqueElementTableHeader->Id = SPDM_REGISTRY_ID_DMTF;
-  OpaqueElementTableHeader->VendorLen = 0;
-  OpaqueElementTableHeader->OpaqueElementDataLen = sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_SUPPORTED_VERSION) + sizeof(SPDM_VERSION_NUMBER);
-
-  OpaqueElementSupportVersion = (VOID *)(OpaqueElementTableHeader + 1);
-  OpaqueElementSupportVersion->SMDataVersion = SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_DATA_VERSION;
-  OpaqueElementSupportVersion->SMDataID = SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_ID_SUPPORTED_VERSION;
-  OpaqueElementSupportVersion->VersionCount = 1;
-
-  VersionsList = (VOID *)(OpaqueElementSupportVersion + 1);
-  VersionsList->Alpha = 0;
-  VersionsList->UpdateVersionNumber = 0;
-  VersionsList->MinorVersion = 1;
-  VersionsList->MajorVersion = 1;
-
-  // Zero Padding
-  End = VersionsList + 1;
-  ZeroMem (End, (UINTN)DataOut + FinalDataSize - (UINTN)End);
+  *DataOutSize = FinalDataSize;
+  CopyMem (DataOut, SpdmContext->LocalContext.OpaqueDataSupportedVersion, FinalDataSize);
 
   return RETURN_SUCCESS;
 }
@@ -132,6 +153,8 @@ SpdmBuildOpaqueDataSupportedVersionData (
   Process opaque data supported version.
 
   This function should be called in KEY_EXCHANGE/PSK_EXCHANGE request parsing in responder.
+  The DataIn is compared in place with the one serialized by SpdmUpdateOpaqueData, up to the version number.
+  Only the major and minor version of the version number are checked, and the padding is not checked.
 
   @param  DataInSize                   Size in bytes of the DataIn.
   @param  DataIn                       A pointer to the buffer to store the opaque data supported version.
@@ -146,38 +169,23 @@ SpdmProcessOpaqueDataSupportedVersionData (
   IN     VOID                 *DataIn
   )
 {
-  SECURED_MESSAGE_GENERAL_OPAQUE_DATA_TABLE_HEADER   *GeneralOpaqueDataTableHeader;
-  SECURED_MESSAGE_OPAQUE_ELEMENT_TABLE_HEADER        *OpaqueElementTableHeader;
-  SECURED_MESSAGE_OPAQUE_ELEMENT_SUPPORTED_VERSION   *OpaqueElementSupportVersion;
-  SPDM_VERSION_NUMBER                                *VersionsList;
+  SPDM_VERSION_NUMBER  *VersionsList;
 
   if (SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersionCount == 0) {
     return RETURN_SUCCESS;
   }
 
-  if (DataInSize != SpdmGetOpaqueDataSupportedVersionDataSize (SpdmContext)) {
-    return RETURN_UNSUPPORTED;
-  }
-  GeneralOpaqueDataTableHeader = DataIn;
-  if ((GeneralOpaqueDataTableHeader->SpecId != SECURED_MESSAGE_OPAQUE_DATA_SPEC_ID) ||
-      (GeneralOpaqueDataTableHeader->OpaqueVersion != SECURED_MESSAGE_OPAQUE_VERSION) ||
-      (GeneralOpaqueDataTableHeader->TotalElements != 1) ||
-      (GeneralOpaqueDataTableHeader->Reserved != 0) ) {
-    return RETURN_UNSUPPORTED;
-  }
-  OpaqueElementTableHeader = (VOID *)(GeneralOpaqueDataTableHeader + 1);
-  if ((OpaqueElementTableHeader->Id != SPDM_REGISTRY_ID_DMTF) ||
-      (OpaqueElementTableHeader->VendorLen != 0) ||
-      (OpaqueElementTableHeader->OpaqueElementDataLen != sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_SUPPORTED_VERSION) + sizeof(SPDM_VERSION_NUMBER)) ) {
+  if (DataInSize != SpdmContext->LocalContext.OpaqueDataSupportedVersionSize) {
     return RETURN_UNSUPPORTED;
   }
-  OpaqueElementSupportVersion = (VOID *)(OpaqueElementTableHeader + 1);
-  if ((OpaqueElementSupportVersion->SMDataVersion != SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_DATA_VERSION) ||
-      (OpaqueElementSupportVersion->SMDataID != SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_ID_SUPPORTED_VERSION) ||
-      (OpaqueElementSupportVersion->VersionCount != 1) ) {
+  if (CompareMem (
+        DataIn,
+        SpdmContext->LocalContext.OpaqueDataSupportedVersion,
+        SPDM_OPAQUE_DATA_SUPPORTED_VERSION_UNPADDED_SIZE - sizeof(SPDM_VERSION_NUMBER)
+        ) != 0) {
     return RETURN_UNSUPPORTED;
   }
-  VersionsList = (VOID *)(OpaqueElementSupportVersion + 1);
+  VersionsList = (VOID *)((UINT8 *)DataIn + SPDM_OPAQUE_DATA_SUPPORTED_VERSION_UNPADDED_SIZE - sizeof(SPDM_VERSION_NUMBER));
   if ((VersionsList->MinorVersion != 1) ||
       (VersionsList->MajorVersion != 1) ) {
     return RETURN_UNSUPPORTED;
@@ -190,6 +198,7 @@ SpdmProcessOpaqueDataSupportedVersionData (
   Build opaque data version selection.
 
   This function should be called in KEY_EXCHANGE/PSK_EXCHANGE response generation.
+  The opaque data is copied from the one serialized by SpdmUpdateOpaqueData.
 
   @param  DataOutSize                  Size in bytes of the DataOut.
                                        On input, it means the size in bytes of DataOut buffer.
@@ -207,45 +216,15 @@ SpdmBuildOpaqueDataVersionSelectionData (
      OUT VOID                 *DataOut
   )
 {
-  UINTN                                              FinalDataSize;
-  SECURED_MESSAGE_GENERAL_OPAQUE_DATA_TABLE_HEADER   *GeneralOpaqueDataTableHeader;
-  SECURED_MESSAGE_OPAQUE_ELEMENT_TABLE_HEADER        *OpaqueElementTableHeader;
-  SECURED_MESSAGE_OPAQUE_ELEMENT_VERSION_SELECTION   *OpaqueElementVersionSection;
-  VOID                                               *End;
-
-  if (SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersionCount == 0) {
-    *DataOutSize = 0;
-    return RETURN_SUCCESS;
-  }
+  UINTN  FinalDataSize;
 
-  FinalDataSize = SpdmGetOpaqueDataVersionSelectionDataSize (SpdmContext);
+  FinalDataSize = SpdmContext->LocalContext.OpaqueDataVersionSelectionSize;
   if (*DataOutSize < FinalDataSize) {
     *DataOutSize = FinalDataSize;
     return RETURN_BUFFER_TOO_SMALL;
   }
-
-  GeneralOpaqueDataTableHeader = DataOut;
-  GeneralOpaqueDataTableHeader->SpecId = SECURED_MESSAGE_OPAQUE_DATA_SPEC_ID;
-  GeneralOpaqueDataTableHeader->OpaqueVersion = SECURED_MESSAGE_OPAQUE_VERSION;
-  GeneralOpaqueDataTableHeader->TotalElements = 1;
-  GeneralOpaqueDataTableHeader->Reserved = 0;
-
-  OpaqueElementTableHeader = (VOID *)(GeneralOpaqueDataTableHeader + 1);
-  OpaqueElementTableHeader->Id = SPDM_REGISTRY_ID_DMTF;
-  OpaqueElementTableHeader->VendorLen = 0;
-  OpaqueElementTableHeader->OpaqueElementDataLen = sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_VERSION_SELECTION);
-
-  OpaqueElementVersionSection = (VOID *)(OpaqueElementTableHeader + 1);
-  OpaqueElementVersionSection->SMDataVersion = SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_DATA_VERSION;
-  OpaqueElementVersionSection->SMDataID = SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_ID_VERSION_SELECTION;
-  OpaqueElementVersionSection->SelectedVersion.Alpha = 0;
-  OpaqueElementVersionSection->SelectedVersion.UpdateVersionNumber = 0;
-  OpaqueElementVersionSection->SelectedVersion.MinorVersion = 1;
-  OpaqueElementVersionSection->SelectedVersion.MajorVersion = 1;
-
-  // Zero Padding
-  End = OpaqueElementVersionSection + 1;
-  ZeroMem (End, (UINTN)DataOut + FinalDataSize - (UINTN)End);
+  *DataOutSize = FinalDataSize;
+  CopyMem (DataOut, SpdmContext->LocalContext.OpaqueDataVersionSelection, FinalDataSize);
 
   return RETURN_SUCCESS;
 }
@@ -254,6 +233,8 @@ SpdmBuildOpaqueDataVersionSelectionData (
   Process opaque data version selection.
 
   This function should be called in KEY_EXCHANGE/PSK_EXCHANGE response parsing in requester.
+  The DataIn is compared in place with the one serialized by SpdmUpdateOpaqueData, up to the selected version.
+  Only the major and minor version of the selected version are checked, and the padding is not checked.
 
   @param  DataInSize                   Size in bytes of the DataIn.
   @param  DataIn                       A pointer to the buffer to store the opaque data version selection.
@@ -268,35 +249,25 @@ SpdmProcessOpaqueDataVersionSelectionData (
   IN     VOID                 *DataIn
   )
 {
-  SECURED_MESSAGE_GENERAL_OPAQUE_DATA_TABLE_HEADER   *GeneralOpaqueDataTableHeader;
-  SECURED_MESSAGE_OPAQUE_ELEMENT_TABLE_HEADER        *OpaqueElementTableHeader;
-  SECURED_MESSAGE_OPAQUE_ELEMENT_VERSION_SELECTION   *OpaqueElementVersionSection;
+  SPDM_VERSION_NUMBER  *SelectedVersion;
 
   if (SpdmContext->LocalContext.SecuredMessageVersion.SpdmVersionCount == 0) {
     return RETURN_SUCCESS;
   }
 
-  if (DataInSize != SpdmGetOpaqueDataVersionSelectionDataSize (SpdmContext)) {
+  if (DataInSize != SpdmContext->LocalContext.OpaqueDataVersionSelectionSize) {
     return RETURN_UNSUPPORTED;
   }
-  GeneralOpaqueDataTableHeader = DataIn;
-  if ((GeneralOpaqueDataTableHeader->SpecId != SECURED_MESSAGE_OPAQUE_DATA_SPEC_ID) ||
-      (GeneralOpaqueDataTableHeader->OpaqueVersion != SECURED_MESSAGE_OPAQUE_VERSION) ||
-      (GeneralOpaqueDataTableHeader->TotalElements != 1) ||
-      (GeneralOpaqueDataTableHeader->Reserved != 0) ) {
+  if (CompareMem (
+        DataIn,
+        SpdmContext->LocalContext.OpaqueDataVersionSelection,
+        SPDM_OPAQUE_DATA_VERSION_SELECTION_UNPADDED_SIZE - sizeof(SPDM_VERSION_NUMBER)
+        ) != 0) {
     return RETURN_UNSUPPORTED;
   }
-  OpaqueElementTableHeader = (VOID *)(GeneralOpaqueDataTableHeader + 1);
-  if ((OpaqueElementTableHeader->Id != SPDM_REGISTRY_ID_DMTF) ||
-      (OpaqueElementTableHeader->VendorLen != 0) ||
-      (OpaqueElementTableHeader->OpaqueElementDataLen != sizeof(SECURED_MESSAGE_OPAQUE_ELEMENT_VERSION_SELECTION)) ) {
-    return RETURN_UNSUPPORTED;
-  }
-  OpaqueElementVersionSection = (VOID *)(OpaqueElementTableHeader + 1);
-  if ((OpaqueElementVersionSection->SMDataVersion != SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_DATA_VERSION) ||
-      (OpaqueElementVersionSection->SMDataID != SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_ID_VERSION_SELECTION) ||
-      (OpaqueElementVersionSection->SelectedVersion.MinorVersion != 1) ||
-      (OpaqueElementVersionSection->SelectedVersion.MajorVersion != 1) ) {
+  SelectedVersion = (VOID *)((UINT8 *)DataIn + SPDM_OPAQUE_DATA_VERSION_SELECTION_UNPADDED_SIZE - sizeof(SPDM_VERSION_NUMBER));
+  if ((SelectedVersion->MinorVersion != 1) ||
+      (SelectedVersion->MajorVersion != 1) ) {
     return RETURN_UNSUPPORTED;
   }
 
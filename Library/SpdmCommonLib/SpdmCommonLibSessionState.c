@@ -0,0 +1,407 @@
+/** @file
+  SPDM common library.
+  It exports an established session of an SPDM context, and imports it to another SPDM context.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmCommonLibInternal.h"
+
+/**
+  Export an established session, to be imported by SpdmImportSession in another SPDM context,
+  such as the SPDM context of a live migrated virtual machine.
+
+  The exported session has the version, the capabilities and the algorithms of the connection, message A,
+  the session attributes, and the secrets, the keys and the sequence numbers of the session.
+  It is encrypted and authenticated with AES-256-GCM and the wrapping key of the caller.
+
+  No message of the session may be in flight, and no KEY_UPDATE may be in progress. The session must not be used
+  by the SpdmContext after it is exported, because the sequence numbers would be reused. It may be freed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+  @param  WrappingKey                  A pointer to the wrapping key.
+  @param  WrappingKeySize              The size in bytes of the wrapping key. It must be SPDM_SESSION_WRAPPING_KEY_SIZE.
+  @param  SessionStateSize             On input, the size in bytes of the SessionState buffer.
+                                       On output, the size in bytes of the exported session.
+  @param  SessionState                 A pointer to the buffer to export the session to.
+
+  @retval RETURN_SUCCESS               The session is exported.
+  @retval RETURN_INVALID_PARAMETER     The wrapping key size is not SPDM_SESSION_WRAPPING_KEY_SIZE.
+  @retval RETURN_NOT_FOUND             The session is not found.
+  @retval RETURN_NOT_READY             The session is not established.
+  @retval RETURN_BUFFER_TOO_SMALL      The SessionState buffer is too small. SessionStateSize is set to the required size.
+  @retval RETURN_OUT_OF_RESOURCES      The session does not fit in the scratch buffer of the SPDM context.
+  @retval RETURN_DEVICE_ERROR          The session cannot be encrypted.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmExportSession (
+  IN     VOID                      *Context,
+  IN     UINT32                    SessionId,
+  IN     CONST UINT8               *WrappingKey,
+  IN     UINTN                     WrappingKeySize,
+  IN OUT UINTN                     *SessionStateSize,
+     OUT VOID                      *SessionState
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
+  SPDM_SESSION_INFO                         *SessionInfo;
+  VOID                                      *SecuredMessageContext;
+  SPDM_EXPORTED_SESSION_HEADER              *Header;
+  SPDM_EXPORTED_SESSION_BODY                *Body;
+  UINTN                                     MessageASize;
+  UINTN                                     SecretsSize;
+  UINTN                                     KeysSize;
+  UINTN                                     BodySize;
+  UINTN                                     TotalSize;
+  UINTN                                     EncryptedSize;
+  UINT8                                     *Ptr;
+  BOOLEAN                                   Result;
+
+  SpdmContext = Context;
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+
+  if (WrappingKeySize != SPDM_SESSION_WRAPPING_KEY_SIZE) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  if (SessionInfo == NULL) {
+    return RETURN_NOT_FOUND;
+  }
+  SecuredMessageContext = SessionInfo->SecuredMessageContext;
+  if (SpdmSecuredMessageGetSessionState (SecuredMessageContext) != SpdmSessionStateEstablished) {
+    return RETURN_NOT_READY;
+  }
+
+  //
+  // The secured message library returns the sizes of the secrets and the keys for an empty buffer.
+  //
+  MessageASize = GetManagedBufferSize (&SpdmContext->Transcript.MessageA);
+  SecretsSize = 0;
+  SpdmSecuredMessageExportSessionSecrets (SecuredMessageContext, NULL, &SecretsSize);
+  KeysSize = 0;
+  SpdmSecuredMessageExportSessionKeys (SecuredMessageContext, NULL, &KeysSize);
+  BodySize = sizeof(SPDM_EXPORTED_SESSION_BODY) + MessageASize + SecretsSize + KeysSize;
+  TotalSize = sizeof(SPDM_EXPORTED_SESSION_HEADER) + BodySize + SPDM_EXPORTED_SESSION_TAG_SIZE;
+  if (*SessionStateSize < TotalSize) {
+    *SessionStateSize = TotalSize;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  //
+  // The body is built in the scratch buffer, and only its encryption is written to the SessionState buffer.
+  //
+  Body = SpdmAcquireScratch (SpdmContext, BodySize);
+  if (Body == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  ZeroMem (Body, sizeof(SPDM_EXPORTED_SESSION_BODY));
+  CopyMem (&Body->SpdmVersion, &ConnectionInfo->Version, sizeof(SPDM_DEVICE_VERSION));
+  CopyMem (&Body->Capability, &ConnectionInfo->Capability, sizeof(SPDM_DEVICE_CAPABILITY));
+  CopyMem (&Body->Algorithm, &ConnectionInfo->Algorithm, sizeof(SPDM_DEVICE_ALGORITHM));
+  CopyMem (&Body->SecuredMessageVersion, &ConnectionInfo->SecuredMessageVersion, sizeof(SPDM_DEVICE_VERSION));
+  Body->UsePsk = SessionInfo->UsePsk;
+  Body->MutAuthRequested = SessionInfo->MutAuthRequested;
+  Body->EndSessionAttributes = SessionInfo->EndSessionAttributes;
+  Body->HeartbeatPeriod = SessionInfo->HeartbeatPeriod;
+  Body->Privileged = SessionInfo->Privileged;
+  CopyMem (&Body->KeyUpdatePolicy, &SessionInfo->KeyUpdatePolicy, sizeof(SPDM_KEY_UPDATE_POLICY));
+  Body->MessageASize = (UINT32)MessageASize;
+  Body->SecretsSize = (UINT32)SecretsSize;
+  Body->KeysSize = (UINT32)KeysSize;
+
+  Ptr = (UINT8 *)(Body + 1);
+  CopyMem (Ptr, GetManagedBuffer (&SpdmContext->Transcript.MessageA), MessageASize);
+  Ptr += MessageASize;
+  SpdmSecuredMessageExportSessionSecrets (SecuredMessageContext, Ptr, &SecretsSize);
+  Ptr += SecretsSize;
+  SpdmSecuredMessageExportSessionKeys (SecuredMessageContext, Ptr, &KeysSize);
+
+  Header = SessionState;
+  ZeroMem (Header, sizeof(SPDM_EXPORTED_SESSION_HEADER));
+  Header->Signature = SPDM_EXPORTED_SESSION_SIGNATURE;
+  Header->Version = SPDM_EXPORTED_SESSION_VERSION;
+  Header->SessionId = SessionId;
+  Header->BodySize = (UINT32)BodySize;
+  SpdmGetRandomNumber (sizeof(Header->Iv), Header->Iv);
+  EncryptedSize = BodySize;
+  Result = SpdmAeadEncryption (
+             SPDM_EXPORTED_SESSION_AEAD_CIPHER_SUITE,
+             WrappingKey,
+             WrappingKeySize,
+             Header->Iv,
+             sizeof(Header->Iv),
+             (UINT8 *)Header,
+             sizeof(SPDM_EXPORTED_SESSION_HEADER),
+             (UINT8 *)Body,
+             BodySize,
+             (UINT8 *)(Header + 1) + BodySize,
+             SPDM_EXPORTED_SESSION_TAG_SIZE,
+             (UINT8 *)(Header + 1),
+             &EncryptedSize
+             );
+  ZeroMem (Body, BodySize);
+  SpdmReleaseScratch (SpdmContext, Body);
+  if (!Result) {
+    ZeroMem (SessionState, TotalSize);
+    return RETURN_DEVICE_ERROR;
+  }
+
+  *SessionStateSize = TotalSize;
+  return RETURN_SUCCESS;
+}
+
+//
+// The connection of an SPDM context before SpdmImportSession restores it, to be put back if the import fails.
+//
+typedef struct {
+  SPDM_CONNECTION_STATE           ConnectionState;
+  SPDM_DEVICE_VERSION             Version;
+  SPDM_DEVICE_CAPABILITY          Capability;
+  SPDM_DEVICE_ALGORITHM           Algorithm;
+  SPDM_DEVICE_VERSION             SecuredMessageVersion;
+  SMALL_MANAGED_BUFFER            MessageA;
+} SPDM_IMPORT_SESSION_SAVED_CONNECTION;
+
+/**
+  Put back the connection of an SPDM context saved by SpdmImportSessionConnection.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SavedConnection              The connection before it was restored from the exported session.
+**/
+STATIC
+VOID
+SpdmImportSessionRollbackConnection (
+  IN OUT SPDM_DEVICE_CONTEXT                         *SpdmContext,
+  IN     CONST SPDM_IMPORT_SESSION_SAVED_CONNECTION  *SavedConnection
+  )
+{
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
+
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+  CopyMem (&ConnectionInfo->Version, &SavedConnection->Version, sizeof(SPDM_DEVICE_VERSION));
+  CopyMem (&ConnectionInfo->Capability, &SavedConnection->Capability, sizeof(SPDM_DEVICE_CAPABILITY));
+  CopyMem (&ConnectionInfo->Algorithm, &SavedConnection->Algorithm, sizeof(SPDM_DEVICE_ALGORITHM));
+  CopyMem (&ConnectionInfo->SecuredMessageVersion, &SavedConnection->SecuredMessageVersion, sizeof(SPDM_DEVICE_VERSION));
+  //
+  // The saved message A fits, because it was in the same buffer. Appending it again also rebuilds its digest.
+  //
+  SpdmResetMessageA (SpdmContext);
+  SpdmAppendMessageA (
+    SpdmContext,
+    GetManagedBuffer ((VOID *)&SavedConnection->MessageA),
+    GetManagedBufferSize ((VOID *)&SavedConnection->MessageA)
+    );
+  ConnectionInfo->ConnectionState = SavedConnection->ConnectionState;
+}
+
+/**
+  Restore the connection of an SPDM context from an exported session, or check that it matches the exported session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Body                         The decrypted body of the exported session.
+  @param  SavedConnection              Return the connection before it is restored, if ConnectionRestored is TRUE.
+  @param  ConnectionRestored           Return TRUE if the connection is restored from the exported session,
+                                       and FALSE if the connection was already negotiated or nothing is changed.
+
+  @retval RETURN_SUCCESS               The connection is negotiated with the algorithms of the exported session.
+  @retval RETURN_UNSUPPORTED           The negotiated algorithms are not the ones of the exported session.
+  @retval RETURN_OUT_OF_RESOURCES      Message A does not fit in the SPDM context.
+**/
+STATIC
+RETURN_STATUS
+SpdmImportSessionConnection (
+  IN OUT SPDM_DEVICE_CONTEXT                   *SpdmContext,
+  IN     CONST SPDM_EXPORTED_SESSION_BODY      *Body,
+     OUT SPDM_IMPORT_SESSION_SAVED_CONNECTION  *SavedConnection,
+     OUT BOOLEAN                               *ConnectionRestored
+  )
+{
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
+  RETURN_STATUS                             Status;
+
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+  *ConnectionRestored = FALSE;
+
+  if (ConnectionInfo->ConnectionState >= SpdmConnectionStateNegotiated) {
+    if ((ConnectionInfo->Algorithm.BaseHashAlgo != Body->Algorithm.BaseHashAlgo) ||
+        (ConnectionInfo->Algorithm.DHENamedGroup != Body->Algorithm.DHENamedGroup) ||
+        (ConnectionInfo->Algorithm.AEADCipherSuite != Body->Algorithm.AEADCipherSuite) ||
+        (ConnectionInfo->Algorithm.KeySchedule != Body->Algorithm.KeySchedule)) {
+      return RETURN_UNSUPPORTED;
+    }
+    return RETURN_SUCCESS;
+  }
+
+  if ((Body->SpdmVersion.SpdmVersionCount == 0) ||
+      (Body->SpdmVersion.SpdmVersionCount > MAX_SPDM_VERSION_COUNT) ||
+      (Body->SecuredMessageVersion.SpdmVersionCount > MAX_SPDM_VERSION_COUNT)) {
+    return RETURN_UNSUPPORTED;
+  }
+  if (Body->MessageASize > SpdmContext->Transcript.MessageA.MaxBufferSize) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  SavedConnection->ConnectionState = ConnectionInfo->ConnectionState;
+  CopyMem (&SavedConnection->Version, &ConnectionInfo->Version, sizeof(SPDM_DEVICE_VERSION));
+  CopyMem (&SavedConnection->Capability, &ConnectionInfo->Capability, sizeof(SPDM_DEVICE_CAPABILITY));
+  CopyMem (&SavedConnection->Algorithm, &ConnectionInfo->Algorithm, sizeof(SPDM_DEVICE_ALGORITHM));
+  CopyMem (&SavedConnection->SecuredMessageVersion, &ConnectionInfo->SecuredMessageVersion, sizeof(SPDM_DEVICE_VERSION));
+  CopyMem (&SavedConnection->MessageA, &SpdmContext->Transcript.MessageA, sizeof(SMALL_MANAGED_BUFFER));
+  *ConnectionRestored = TRUE;
+
+  SpdmResetMessageA (SpdmContext);
+  CopyMem (&ConnectionInfo->Version, &Body->SpdmVersion, sizeof(SPDM_DEVICE_VERSION));
+  CopyMem (&ConnectionInfo->Capability, &Body->Capability, sizeof(SPDM_DEVICE_CAPABILITY));
+  CopyMem (&ConnectionInfo->Algorithm, &Body->Algorithm, sizeof(SPDM_DEVICE_ALGORITHM));
+  CopyMem (&ConnectionInfo->SecuredMessageVersion, &Body->SecuredMessageVersion, sizeof(SPDM_DEVICE_VERSION));
+  Status = SpdmAppendMessageA (SpdmContext, (UINT8 *)(Body + 1), Body->MessageASize);
+  if (RETURN_ERROR(Status)) {
+    SpdmImportSessionRollbackConnection (SpdmContext, SavedConnection);
+    *ConnectionRestored = FALSE;
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  ConnectionInfo->ConnectionState = SpdmConnectionStateNegotiated;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Import a session exported by SpdmExportSession to an SPDM context, so that the secured messages of the session
+  continue without KEY_EXCHANGE or PSK_EXCHANGE.
+
+  If the connection of the SPDM context is not negotiated, it is restored from the exported session as negotiated,
+  without the peer certificate chain. Otherwise the connection must have the algorithms of the exported session,
+  and several sessions of one connection can be imported. If the import fails, the connection is left as it was.
+
+  The records of the session decoded before the export are not accepted after the import, if the replay window
+  of the secured messages is enabled.
+
+  This function must be called after the local settings are set.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  WrappingKey                  A pointer to the wrapping key of the export.
+  @param  WrappingKeySize              The size in bytes of the wrapping key. It must be SPDM_SESSION_WRAPPING_KEY_SIZE.
+  @param  ImportTime                   The time of the import, from the requester or responder time function, or 0.
+                                       The heartbeat and the idle time of the session are counted from it.
+  @param  SessionStateSize             Size in bytes of the exported session.
+  @param  SessionState                 A pointer to the exported session.
+
+  @retval RETURN_SUCCESS               The session is imported.
+  @retval RETURN_INVALID_PARAMETER     The wrapping key size is not SPDM_SESSION_WRAPPING_KEY_SIZE.
+  @retval RETURN_UNSUPPORTED           The exported session is malformed, exported by another version of the library,
+                                       or its algorithms are not the ones of the negotiated connection.
+  @retval RETURN_SECURITY_VIOLATION    The exported session cannot be authenticated with the wrapping key.
+  @retval RETURN_ALREADY_STARTED       The SPDM context already has a session with the session ID.
+  @retval RETURN_OUT_OF_RESOURCES      The exported session does not fit in the SPDM context.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmImportSession (
+  IN     VOID                      *Context,
+  IN     CONST UINT8               *WrappingKey,
+  IN     UINTN                     WrappingKeySize,
+  IN     UINT64                    ImportTime,
+  IN     UINTN                     SessionStateSize,
+  IN     VOID                      *SessionState
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_SESSION_INFO                         *SessionInfo;
+  VOID                                      *SecuredMessageContext;
+  SPDM_EXPORTED_SESSION_HEADER              *Header;
+  SPDM_EXPORTED_SESSION_BODY                *Body;
+  UINTN                                     BodySize;
+  UINT8                                     *Ptr;
+  SPDM_IMPORT_SESSION_SAVED_CONNECTION      SavedConnection;
+  BOOLEAN                                   ConnectionRestored;
+  RETURN_STATUS                             Status;
+
+  SpdmContext = Context;
+  ConnectionRestored = FALSE;
+
+  if (WrappingKeySize != SPDM_SESSION_WRAPPING_KEY_SIZE) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (SessionStateSize < sizeof(SPDM_EXPORTED_SESSION_HEADER) + sizeof(SPDM_EXPORTED_SESSION_BODY) + SPDM_EXPORTED_SESSION_TAG_SIZE) {
+    return RETURN_UNSUPPORTED;
+  }
+  Header = SessionState;
+  if ((Header->Signature != SPDM_EXPORTED_SESSION_SIGNATURE) ||
+      (Header->Version != SPDM_EXPORTED_SESSION_VERSION)) {
+    return RETURN_UNSUPPORTED;
+  }
+  if (SessionStateSize != sizeof(SPDM_EXPORTED_SESSION_HEADER) + (UINTN)Header->BodySize + SPDM_EXPORTED_SESSION_TAG_SIZE) {
+    return RETURN_UNSUPPORTED;
+  }
+  if (SpdmGetSessionInfoViaSessionId (SpdmContext, Header->SessionId) != NULL) {
+    return RETURN_ALREADY_STARTED;
+  }
+
+  Body = SpdmAcquireScratch (SpdmContext, Header->BodySize);
+  if (Body == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  BodySize = Header->BodySize;
+  if (!SpdmAeadDecryption (
+         SPDM_EXPORTED_SESSION_AEAD_CIPHER_SUITE,
+         WrappingKey,
+         WrappingKeySize,
+         Header->Iv,
+         sizeof(Header->Iv),
+         (UINT8 *)Header,
+         sizeof(SPDM_EXPORTED_SESSION_HEADER),
+         (UINT8 *)(Header + 1),
+         Header->BodySize,
+         (UINT8 *)(Header + 1) + Header->BodySize,
+         SPDM_EXPORTED_SESSION_TAG_SIZE,
+         (UINT8 *)Body,
+         &BodySize
+         )) {
+    SpdmReleaseScratch (SpdmContext, Body);
+    return RETURN_SECURITY_VIOLATION;
+  }
+
+  if (Header->BodySize != sizeof(SPDM_EXPORTED_SESSION_BODY) + (UINTN)Body->MessageASize + (UINTN)Body->SecretsSize + (UINTN)Body->KeysSize) {
+    Status = RETURN_UNSUPPORTED;
+    goto Done;
+  }
+  Status = SpdmImportSessionConnection (SpdmContext, Body, &SavedConnection, &ConnectionRestored);
+  if (RETURN_ERROR(Status)) {
+    goto Done;
+  }
+
+  SessionInfo = SpdmAssignSessionId (SpdmContext, Header->SessionId, Body->UsePsk);
+  if (SessionInfo == NULL) {
+    Status = RETURN_OUT_OF_RESOURCES;
+    goto Done;
+  }
+  SessionInfo->MutAuthRequested = Body->MutAuthRequested;
+  SessionInfo->EndSessionAttributes = Body->EndSessionAttributes;
+  SessionInfo->HeartbeatPeriod = Body->HeartbeatPeriod;
+  SessionInfo->Privileged = Body->Privileged;
+  CopyMem (&SessionInfo->KeyUpdatePolicy, &Body->KeyUpdatePolicy, sizeof(SPDM_KEY_UPDATE_POLICY));
+  SessionInfo->LastActivityTime = ImportTime;
+
+  SecuredMessageContext = SessionInfo->SecuredMessageContext;
+  Ptr = (UINT8 *)(Body + 1) + Body->MessageASize;
+  if (RETURN_ERROR(SpdmSecuredMessageImportSessionSecrets (SecuredMessageContext, Ptr, Body->SecretsSize)) ||
+      RETURN_ERROR(SpdmSecuredMessageImportSessionKeys (SecuredMessageContext, Ptr + Body->SecretsSize, Body->KeysSize))) {
+    SpdmFreeSessionId (SpdmContext, Header->SessionId);
+    Status = RETURN_UNSUPPORTED;
+    goto Done;
+  }
+  SpdmSecuredMessageSetSessionState (SecuredMessageContext, SpdmSessionStateEstablished);
+  Status = RETURN_SUCCESS;
+
+Done:
+  if (RETURN_ERROR(Status) && ConnectionRestored) {
+    SpdmImportSessionRollbackConnection (SpdmContext, &SavedConnection);
+  }
+  ZeroMem (Body, Header->BodySize);
+  SpdmReleaseScratch (SpdmContext, Body);
+  return Status;
+}
@@ -21,10 +21,7 @@ InternalDumpHexStr (
   IN UINTN  Size
   )
 {
-  UINTN  Index;
-  for (Index = 0; Index < Size; Index++) {
-    DEBUG ((DEBUG_INFO, "%02x", (UINTN)Data[Index]));
-  }
+  DEBUG_HEX ((DEBUG_INFO, Data, Size, FALSE));
 }
 
 /**
@@ -39,10 +36,7 @@ InternalDumpData (
   IN UINTN  Size
   )
 {
-  UINTN  Index;
-  for (Index = 0; Index < Size; Index++) {
-    DEBUG ((DEBUG_INFO, "%02x ", (UINTN)Data[Index]));
-  }
+  DEBUG_HEX ((DEBUG_INFO, Data, Size, TRUE));
 }
 
 /**
@@ -63,6 +57,10 @@ InternalDumpHex (
 
 #define COLUME_SIZE  (16 * 2)
 
+  if (!DebugPrintLevelEnabled (DEBUG_INFO)) {
+    return ;
+  }
+
   Count = Size / COLUME_SIZE;
   Left  = Size % COLUME_SIZE;
   for (Index = 0; Index < Count; Index++) {
@@ -115,6 +113,217 @@ SpdmWriteUint24 (
   return Value;
 }
 
+/**
+  Return the number of chunks of a segmented managed buffer of the given size.
+
+  @param  BufferSize                   The size in bytes of the segmented managed buffer.
+
+  @return the number of chunks.
+**/
+UINTN
+SpdmTranscriptChunkCount (
+  IN UINTN               BufferSize
+  )
+{
+  return (BufferSize + SPDM_TRANSCRIPT_CHUNK_SIZE - 1) / SPDM_TRANSCRIPT_CHUNK_SIZE;
+}
+
+/**
+  Return a list of chunks to the transcript arena.
+
+  The used part of each chunk is zeroed, so that the data beyond the size of a managed buffer stays zero.
+
+  @param  Arena                        The transcript arena.
+  @param  Chunk                        The first chunk of the list.
+  @param  UsedSize                     The size in bytes of the data in the list.
+**/
+VOID
+SpdmTranscriptArenaReleaseChunks (
+  IN OUT SPDM_TRANSCRIPT_ARENA *Arena,
+  IN     SPDM_TRANSCRIPT_CHUNK *Chunk,
+  IN     UINTN                 UsedSize
+  )
+{
+  SPDM_TRANSCRIPT_CHUNK  *Next;
+
+  while (Chunk != NULL) {
+    Next = Chunk->Next;
+    ZeroMem (Chunk->Data, MIN (UsedSize, SPDM_TRANSCRIPT_CHUNK_SIZE));
+    UsedSize -= MIN (UsedSize, SPDM_TRANSCRIPT_CHUNK_SIZE);
+    Chunk->Next = Arena->FreeList;
+    Arena->FreeList = Chunk;
+    Arena->FreeCount++;
+    Chunk = Next;
+  }
+}
+
+/**
+  Add memory to a transcript arena, as free chunks.
+
+  @param  Arena                        The transcript arena.
+  @param  Buffer                       The memory to add.
+  @param  BufferSize                   Size in bytes of the memory to add.
+
+  @return the number of chunks added.
+**/
+UINTN
+SpdmTranscriptArenaAddMemory (
+  IN OUT SPDM_TRANSCRIPT_ARENA     *Arena,
+  IN     VOID                      *Buffer,
+  IN     UINTN                     BufferSize
+  )
+{
+  SPDM_TRANSCRIPT_CHUNK  *Chunk;
+  UINTN                  Align;
+  UINTN                  Count;
+  UINTN                  Index;
+
+  Align = ALIGN_VALUE ((UINTN)Buffer, sizeof(UINT64)) - (UINTN)Buffer;
+  if (BufferSize < Align) {
+    return 0;
+  }
+  Chunk = (VOID *)((UINT8 *)Buffer + Align);
+  Count = (BufferSize - Align) / sizeof(SPDM_TRANSCRIPT_CHUNK);
+  ZeroMem (Chunk, Count * sizeof(SPDM_TRANSCRIPT_CHUNK));
+  for (Index = 0; Index < Count; Index++) {
+    Chunk[Index].Next = Arena->FreeList;
+    Arena->FreeList = &Chunk[Index];
+  }
+  Arena->FreeCount += Count;
+  return Count;
+}
+
+/**
+  Init a segmented managed buffer.
+
+  @param  ManagedBuffer                The segmented managed buffer.
+  @param  Arena                        The transcript arena of the chunks of the managed buffer.
+**/
+VOID
+InitSegmentedManagedBuffer (
+  IN OUT SEGMENTED_MANAGED_BUFFER  *ManagedBuffer,
+  IN     SPDM_TRANSCRIPT_ARENA     *Arena
+  )
+{
+  ManagedBuffer->MaxBufferSize = SEGMENTED_MANAGED_BUFFER_MAX_SIZE;
+  ManagedBuffer->BufferSize = 0;
+  ManagedBuffer->Arena = Arena;
+  ManagedBuffer->Head = NULL;
+  ManagedBuffer->Tail = NULL;
+}
+
+/**
+  Append a new data buffer to a segmented managed buffer.
+
+  The chunks are taken from the transcript arena. Nothing is appended if the arena has not enough free chunks.
+
+  @param  ManagedBuffer                The segmented managed buffer to be appended.
+  @param  Buffer                       The address of the data buffer to be appended to the managed buffer.
+  @param  BufferSize                   The size in bytes of the data buffer to be appended to the managed buffer.
+
+  @retval RETURN_SUCCESS               The new data buffer is appended to the managed buffer.
+  @retval RETURN_BUFFER_TOO_SMALL      The transcript arena has not enough free chunks.
+**/
+RETURN_STATUS
+AppendSegmentedManagedBuffer (
+  IN OUT SEGMENTED_MANAGED_BUFFER  *ManagedBuffer,
+  IN     UINT8                     *Buffer,
+  IN     UINTN                     BufferSize
+  )
+{
+  SPDM_TRANSCRIPT_ARENA  *Arena;
+  SPDM_TRANSCRIPT_CHUNK  *Chunk;
+  UINTN                  NewChunkCount;
+  UINTN                  Offset;
+  UINTN                  CopySize;
+
+  Arena = ManagedBuffer->Arena;
+  if (BufferSize > MAX_UINTN - SPDM_TRANSCRIPT_CHUNK_SIZE - ManagedBuffer->BufferSize) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  NewChunkCount = SpdmTranscriptChunkCount (ManagedBuffer->BufferSize + BufferSize) -
+                  SpdmTranscriptChunkCount (ManagedBuffer->BufferSize);
+  if (NewChunkCount > Arena->FreeCount) {
+    // Do not ASSERT here, because command processor will append message from external.
+    DEBUG ((DEBUG_ERROR, "AppendManagedBuffer 0x%x fail, 0x%x free chunks only\n", (UINT32)BufferSize, (UINT32)Arena->FreeCount));
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  while (BufferSize != 0) {
+    Offset = ManagedBuffer->BufferSize % SPDM_TRANSCRIPT_CHUNK_SIZE;
+    if (Offset == 0) {
+      //
+      // The Tail is full, or there is no chunk yet.
+      //
+      Chunk = Arena->FreeList;
+      Arena->FreeList = Chunk->Next;
+      Arena->FreeCount--;
+      Chunk->Next = NULL;
+      if (ManagedBuffer->Tail == NULL) {
+        ManagedBuffer->Head = Chunk;
+      } else {
+        ManagedBuffer->Tail->Next = Chunk;
+      }
+      ManagedBuffer->Tail = Chunk;
+    }
+    CopySize = MIN (BufferSize, SPDM_TRANSCRIPT_CHUNK_SIZE - Offset);
+    CopyMem (ManagedBuffer->Tail->Data + Offset, Buffer, CopySize);
+    ManagedBuffer->BufferSize += CopySize;
+    Buffer += CopySize;
+    BufferSize -= CopySize;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Shrink the size of a segmented managed buffer.
+
+  The chunks left empty are returned to the transcript arena.
+
+  @param  ManagedBuffer                The segmented managed buffer to be shrinked.
+  @param  BufferSize                   The size in bytes of the size of the buffer to be shrinked.
+**/
+VOID
+ShrinkSegmentedManagedBuffer (
+  IN OUT SEGMENTED_MANAGED_BUFFER  *ManagedBuffer,
+  IN     UINTN                     BufferSize
+  )
+{
+  SPDM_TRANSCRIPT_CHUNK  *Chunk;
+  UINTN                  NewSize;
+  UINTN                  ChunkCount;
+  UINTN                  TailSize;
+  UINTN                  OldTailSize;
+  UINTN                  Index;
+
+  NewSize = ManagedBuffer->BufferSize - BufferSize;
+  ChunkCount = SpdmTranscriptChunkCount (NewSize);
+  if (ChunkCount == 0) {
+    SpdmTranscriptArenaReleaseChunks (ManagedBuffer->Arena, ManagedBuffer->Head, ManagedBuffer->BufferSize);
+    ManagedBuffer->Head = NULL;
+    ManagedBuffer->Tail = NULL;
+    ManagedBuffer->BufferSize = 0;
+    return ;
+  }
+
+  Chunk = ManagedBuffer->Head;
+  for (Index = 1; Index < ChunkCount; Index++) {
+    Chunk = Chunk->Next;
+  }
+  //
+  // Chunk is the new Tail. The chunks after it are released.
+  //
+  TailSize = NewSize - (ChunkCount - 1) * SPDM_TRANSCRIPT_CHUNK_SIZE;
+  OldTailSize = MIN (ManagedBuffer->BufferSize - (ChunkCount - 1) * SPDM_TRANSCRIPT_CHUNK_SIZE, SPDM_TRANSCRIPT_CHUNK_SIZE);
+  ZeroMem (Chunk->Data + TailSize, OldTailSize - TailSize);
+  if (Chunk->Next != NULL) {
+    SpdmTranscriptArenaReleaseChunks (ManagedBuffer->Arena, Chunk->Next, ManagedBuffer->BufferSize - ChunkCount * SPDM_TRANSCRIPT_CHUNK_SIZE);
+    Chunk->Next = NULL;
+  }
+  ManagedBuffer->Tail = Chunk;
+  ManagedBuffer->BufferSize = NewSize;
+}
+
 /**
   Append a new data buffer to the managed buffer.
 
@@ -144,6 +353,9 @@ AppendManagedBuffer (
   }
   ASSERT (Buffer != NULL);
   ASSERT (BufferSize != 0);
+  if (ManagedBuffer->MaxBufferSize == SEGMENTED_MANAGED_BUFFER_MAX_SIZE) {
+    return AppendSegmentedManagedBuffer (MBuffer, Buffer, BufferSize);
+  }
   ASSERT ((ManagedBuffer->MaxBufferSize == MAX_SPDM_MESSAGE_BUFFER_SIZE) ||
           (ManagedBuffer->MaxBufferSize == MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE));
   ASSERT (ManagedBuffer->MaxBufferSize >= ManagedBuffer->BufferSize);
@@ -183,14 +395,20 @@ ShrinkManagedBuffer (
   }
   ASSERT (BufferSize != 0);
   ASSERT ((ManagedBuffer->MaxBufferSize == MAX_SPDM_MESSAGE_BUFFER_SIZE) ||
-          (ManagedBuffer->MaxBufferSize == MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE));
+          (ManagedBuffer->MaxBufferSize == MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE) ||
+          (ManagedBuffer->MaxBufferSize == SEGMENTED_MANAGED_BUFFER_MAX_SIZE));
   ASSERT (ManagedBuffer->MaxBufferSize >= ManagedBuffer->BufferSize);
   if (BufferSize > ManagedBuffer->BufferSize) {
     return RETURN_BUFFER_TOO_SMALL;
   }
   ASSERT (BufferSize <= ManagedBuffer->BufferSize);
 
+  if (ManagedBuffer->MaxBufferSize == SEGMENTED_MANAGED_BUFFER_MAX_SIZE) {
+    ShrinkSegmentedManagedBuffer (MBuffer, BufferSize);
+    return RETURN_SUCCESS;
+  }
   ManagedBuffer->BufferSize -= BufferSize;
+  ZeroMem ((UINT8 *)(ManagedBuffer + 1) + ManagedBuffer->BufferSize, BufferSize);
   return RETURN_SUCCESS;
 }
 
@@ -198,7 +416,8 @@ ShrinkManagedBuffer (
   Reset the managed buffer.
   The BufferSize is reset to 0.
   The MaxBufferSize is unchanged.
-  The Buffer is not freed.
+  The Buffer is not freed, but the chunks of a segmented managed buffer are returned to the transcript arena.
+  Only the used part of the Buffer is zeroed. The rest of it is never written.
 
   @param  ManagedBuffer                The managed buffer to be shrinked.
 **/
@@ -211,10 +430,17 @@ ResetManagedBuffer (
 
   ManagedBuffer = MBuffer;
 
+  if (ManagedBuffer->MaxBufferSize == SEGMENTED_MANAGED_BUFFER_MAX_SIZE) {
+    if (ManagedBuffer->BufferSize != 0) {
+      ShrinkSegmentedManagedBuffer (MBuffer, ManagedBuffer->BufferSize);
+    }
+    return ;
+  }
   ASSERT ((ManagedBuffer->MaxBufferSize == MAX_SPDM_MESSAGE_BUFFER_SIZE) ||
           (ManagedBuffer->MaxBufferSize == MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE));
+  ASSERT (ManagedBuffer->MaxBufferSize >= ManagedBuffer->BufferSize);
+  ZeroMem (ManagedBuffer + 1, ManagedBuffer->BufferSize);
   ManagedBuffer->BufferSize = 0;
-  ZeroMem (ManagedBuffer + 1, ManagedBuffer->MaxBufferSize);
 }
 
 /**
@@ -234,12 +460,14 @@ GetManagedBufferSize (
   ManagedBuffer = MBuffer;
 
   ASSERT ((ManagedBuffer->MaxBufferSize == MAX_SPDM_MESSAGE_BUFFER_SIZE) ||
-          (ManagedBuffer->MaxBufferSize == MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE));
+          (ManagedBuffer->MaxBufferSize == MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE) ||
+          (ManagedBuffer->MaxBufferSize == SEGMENTED_MANAGED_BUFFER_MAX_SIZE));
   return ManagedBuffer->BufferSize;
 }
 
 /**
   Return the address of managed buffer.
+  It must not be a segmented managed buffer, whose data is read with GetManagedBufferSegment.
 
   @param  ManagedBuffer                The managed buffer.
 
@@ -261,6 +489,7 @@ GetManagedBuffer (
 
 /**
   Init the managed buffer.
+  The Buffer is not zeroed, because only the part within BufferSize is ever read.
 
   @param  ManagedBuffer                The managed buffer.
   @param  MaxBufferSize                The maximum size in bytes of the managed buffer.
@@ -279,5 +508,168 @@ InitManagedBuffer (
           (MaxBufferSize == MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE));
 
   ManagedBuffer->MaxBufferSize = MaxBufferSize;
-  ResetManagedBuffer (MBuffer);
+  ManagedBuffer->BufferSize = 0;
+}
+
+/**
+  Return a segment of the data of a managed buffer.
+
+  The data of a SEGMENTED_MANAGED_BUFFER is in more than one segment.
+  The data of the other managed buffers is in one segment.
+
+  @param  ManagedBuffer                The managed buffer.
+  @param  Offset                       The offset in bytes of the segment in the data of the managed buffer.
+  @param  SegmentSize                  The size in bytes of the segment.
+
+  @return the address of the segment, or NULL if Offset is not less than the size of the managed buffer.
+**/
+VOID *
+GetManagedBufferSegment (
+  IN     VOID            *MBuffer,
+  IN     UINTN           Offset,
+     OUT UINTN           *SegmentSize
+  )
+{
+  MANAGED_BUFFER            *ManagedBuffer;
+  SEGMENTED_MANAGED_BUFFER  *SegmentedBuffer;
+  SPDM_TRANSCRIPT_CHUNK     *Chunk;
+  UINTN                     Index;
+
+  ManagedBuffer = MBuffer;
+
+  *SegmentSize = 0;
+  if (Offset >= ManagedBuffer->BufferSize) {
+    return NULL;
+  }
+  if (ManagedBuffer->MaxBufferSize != SEGMENTED_MANAGED_BUFFER_MAX_SIZE) {
+    *SegmentSize = ManagedBuffer->BufferSize - Offset;
+    return (UINT8 *)GetManagedBuffer (MBuffer) + Offset;
+  }
+
+  SegmentedBuffer = MBuffer;
+  Chunk = SegmentedBuffer->Head;
+  for (Index = 0; Index < Offset / SPDM_TRANSCRIPT_CHUNK_SIZE; Index++) {
+    Chunk = Chunk->Next;
+  }
+  Offset = Offset % SPDM_TRANSCRIPT_CHUNK_SIZE;
+  *SegmentSize = MIN (SPDM_TRANSCRIPT_CHUNK_SIZE - Offset, SegmentedBuffer->BufferSize - Index * SPDM_TRANSCRIPT_CHUNK_SIZE - Offset);
+  return Chunk->Data + Offset;
+}
+
+/**
+  Append the data of a managed buffer to another managed buffer.
+
+  @param  ManagedBuffer                The managed buffer to be appended.
+  @param  SourceManagedBuffer          The managed buffer of the data to be appended.
+
+  @retval RETURN_SUCCESS               The data is appended to the managed buffer.
+  @retval RETURN_BUFFER_TOO_SMALL      The managed buffer is too small to be appended.
+**/
+RETURN_STATUS
+AppendManagedBufferData (
+  IN OUT VOID            *MBuffer,
+  IN     VOID            *SourceMBuffer
+  )
+{
+  RETURN_STATUS  Status;
+  VOID           *Segment;
+  UINTN          SegmentSize;
+  UINTN          Offset;
+
+  Offset = 0;
+  while ((Segment = GetManagedBufferSegment (SourceMBuffer, Offset, &SegmentSize)) != NULL) {
+    Status = AppendManagedBuffer (MBuffer, Segment, SegmentSize);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    Offset += SegmentSize;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function dump the data of a managed buffer with colume format.
+
+  @param  ManagedBuffer                The managed buffer.
+**/
+VOID
+InternalDumpManagedBuffer (
+  IN VOID                *MBuffer
+  )
+{
+  VOID           *Segment;
+  UINTN          SegmentSize;
+  UINTN          Offset;
+
+  Offset = 0;
+  while ((Segment = GetManagedBufferSegment (MBuffer, Offset, &SegmentSize)) != NULL) {
+    InternalDumpHex (Segment, SegmentSize);
+    Offset += SegmentSize;
+  }
+}
+
+/**
+  Copy data to a buffer at an offset.
+
+  @param  Buffer                       The buffer.
+  @param  BufferSize                   Size in bytes of the buffer.
+  @param  Offset                       On input, the offset in bytes in the buffer to copy the data to.
+                                       On output, the offset in bytes after the data.
+  @param  Data                         The data to copy.
+  @param  DataSize                     Size in bytes of the data.
+
+  @retval RETURN_SUCCESS               The data is copied.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+**/
+RETURN_STATUS
+AppendBuffer (
+     OUT VOID            *Buffer,
+  IN     UINTN           BufferSize,
+  IN OUT UINTN           *Offset,
+  IN     CONST VOID      *Data,
+  IN     UINTN           DataSize
+  )
+{
+  if (DataSize > BufferSize - *Offset) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  CopyMem ((UINT8 *)Buffer + *Offset, Data, DataSize);
+  *Offset += DataSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Copy the data of a managed buffer to a buffer at an offset.
+
+  @param  Buffer                       The buffer.
+  @param  BufferSize                   Size in bytes of the buffer.
+  @param  Offset                       On input, the offset in bytes in the buffer to copy the data to.
+                                       On output, the offset in bytes after the data.
+  @param  ManagedBuffer                The managed buffer of the data to copy.
+
+  @retval RETURN_SUCCESS               The data is copied.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+**/
+RETURN_STATUS
+AppendBufferManagedBufferData (
+     OUT VOID            *Buffer,
+  IN     UINTN           BufferSize,
+  IN OUT UINTN           *Offset,
+  IN     VOID            *MBuffer
+  )
+{
+  VOID           *Segment;
+  UINTN          SegmentSize;
+  UINTN          SegmentOffset;
+
+  if (GetManagedBufferSize (MBuffer) > BufferSize - *Offset) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SegmentOffset = 0;
+  while ((Segment = GetManagedBufferSegment (MBuffer, SegmentOffset, &SegmentSize)) != NULL) {
+    CopyMem ((UINT8 *)Buffer + *Offset, Segment, SegmentSize);
+    *Offset += SegmentSize;
+    SegmentOffset += SegmentSize;
+  }
+  return RETURN_SUCCESS;
 }
\ No newline at end of file
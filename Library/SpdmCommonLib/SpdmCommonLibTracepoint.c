@@ -0,0 +1,138 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+//
+// The TraceLogging provider of the static tracepoints on Windows.
+// The Windows headers conflict with the base types of the library, so that only the configuration is included here.
+//
+#include <Library/SpdmLibConfig.h>
+
+#if (OPENSPDM_TRACEPOINT_SUPPORT == 1) && defined(_MSC_VER)
+
+#include <windows.h>
+#include <TraceLoggingProvider.h>
+
+//
+// {5c4f6b9e-3a8d-4e1f-9b27-0d6a1c8e7f43}
+//
+TRACELOGGING_DEFINE_PROVIDER (
+  mSpdmTraceProvider,
+  "OpenSpdm",
+  (0x5c4f6b9e, 0x3a8d, 0x4e1f, 0x9b, 0x27, 0x0d, 0x6a, 0x1c, 0x8e, 0x7f, 0x43)
+  );
+
+static volatile LONG  mSpdmTraceProviderState;
+
+/**
+  Register the TraceLogging provider on the first tracepoint.
+
+  @retval TRUE  The provider is registered.
+  @retval FALSE The provider is being registered by another thread, or it cannot be registered.
+**/
+static
+BOOLEAN
+SpdmTraceProviderReady (
+  VOID
+  )
+{
+  LONG  State;
+
+  State = InterlockedCompareExchange (&mSpdmTraceProviderState, 1, 0);
+  if (State == 0) {
+    if (SUCCEEDED (TraceLoggingRegister (mSpdmTraceProvider))) {
+      InterlockedExchange (&mSpdmTraceProviderState, 2);
+      return TRUE;
+    }
+    InterlockedExchange (&mSpdmTraceProviderState, 3);
+    return FALSE;
+  }
+  return (BOOLEAN)(State == 2);
+}
+
+//
+// The parameter types match the UINT32, UINT8 and UINTN of the declarations in SpdmCommonLibInternal.h.
+//
+
+VOID
+SpdmTracepointMessage (
+  IN CONST CHAR *Name,
+  IN UINT32     SessionId,
+  IN UINT8      Code,
+  IN SIZE_T     Size
+  )
+{
+  if (SpdmTraceProviderReady ()) {
+    TraceLoggingWrite (
+      mSpdmTraceProvider,
+      "Message",
+      TraceLoggingString (Name, "Name"),
+      TraceLoggingHexUInt32 (SessionId, "SessionId"),
+      TraceLoggingHexUInt8 (Code, "Code"),
+      TraceLoggingUInt64 ((UINT64)Size, "Size")
+      );
+  }
+}
+
+VOID
+SpdmTracepointCodec (
+  IN CONST CHAR *Name,
+  IN UINT32     SessionId,
+  IN SIZE_T     Size,
+  IN SIZE_T     TransportSize
+  )
+{
+  if (SpdmTraceProviderReady ()) {
+    TraceLoggingWrite (
+      mSpdmTraceProvider,
+      "Codec",
+      TraceLoggingString (Name, "Name"),
+      TraceLoggingHexUInt32 (SessionId, "SessionId"),
+      TraceLoggingUInt64 ((UINT64)Size, "Size"),
+      TraceLoggingUInt64 ((UINT64)TransportSize, "TransportSize")
+      );
+  }
+}
+
+VOID
+SpdmTracepointCrypto (
+  IN CONST CHAR *Name,
+  IN UINT32     SessionId,
+  IN SIZE_T     Size
+  )
+{
+  if (SpdmTraceProviderReady ()) {
+    TraceLoggingWrite (
+      mSpdmTraceProvider,
+      "Crypto",
+      TraceLoggingString (Name, "Name"),
+      TraceLoggingHexUInt32 (SessionId, "SessionId"),
+      TraceLoggingUInt64 ((UINT64)Size, "Size")
+      );
+  }
+}
+
+VOID
+SpdmTracepointSessionState (
+  IN UINT32     SessionId,
+  IN UINT32     OldState,
+  IN UINT32     NewState
+  )
+{
+  if (SpdmTraceProviderReady ()) {
+    TraceLoggingWrite (
+      mSpdmTraceProvider,
+      "SessionState",
+      TraceLoggingHexUInt32 (SessionId, "SessionId"),
+      TraceLoggingUInt32 (OldState, "OldState"),
+      TraceLoggingUInt32 (NewState, "NewState")
+      );
+  }
+}
+
+#endif
@@ -0,0 +1,127 @@
+/** @file
+  SPDM common library.
+  It spreads the records of the established sessions across the transport paths of an SPDM context.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmCommonLibInternal.h"
+
+/**
+  Register an additional transport path to an SPDM context.
+
+  Path 0 is the one registered by SpdmRegisterDeviceIoFunc and SpdmRegisterTransportLayerFunc.
+  It carries the messages outside a session and the handshake of a session.
+  Once a session is established, the requester sends each of its records over the path with the greatest
+  MinPayloadSize that the payload reaches, and path 0 if there is none. So control messages stay on a
+  low-latency path registered as path 0, and bulk APP messages go over a high-bandwidth path.
+  The response is received over the path of the request, and the responder sends it over the path of the request,
+  see SpdmResponderDispatchMessageOnPath.
+
+  The sequence numbers of a session are shared by its paths. If records of a session may be in flight over
+  several paths at once, OPENSPDM_REPLAY_WINDOW_SIZE must be set and the transports must carry the sequence number,
+  so that the records decoded out of order are accepted.
+
+  The device input/output functions of a path get its DeviceIoContext from SpdmGetTransportPathDeviceIoContext.
+  The paths in use are per direction, so a send and a receive may run on different threads over different paths.
+
+  This function must be called after SpdmRegisterTransportLayerFunc, and before any SPDM communication.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Path                         The transport path, or NULL to remove all the additional paths.
+  @param  PathIndex                    The index of the path registered, from 1.
+
+  @retval RETURN_SUCCESS               The transport path is registered.
+  @retval RETURN_INVALID_PARAMETER     A function of the transport path is NULL.
+  @retval RETURN_OUT_OF_RESOURCES      MAX_SPDM_TRANSPORT_PATH_COUNT paths are already registered.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRegisterTransportPath (
+  IN     VOID                                  *Context,
+  IN     CONST SPDM_TRANSPORT_PATH             *Path OPTIONAL,
+     OUT UINT8                                 *PathIndex OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+  SPDM_TRANSPORT_PATH_SLOT  *Slot;
+
+  SpdmContext = Context;
+  ASSERT ((SpdmContext->SendTransportPath == 0) && (SpdmContext->ReceiveTransportPath == 0));
+
+  if (Path == NULL) {
+    ZeroMem (&SpdmContext->TransportPath[1], sizeof(SpdmContext->TransportPath) - sizeof(SpdmContext->TransportPath[0]));
+    SpdmContext->TransportPathCount = 0;
+    return RETURN_SUCCESS;
+  }
+  if ((Path->SendMessage == NULL) || (Path->ReceiveMessage == NULL) ||
+      (Path->TransportEncodeMessage == NULL) || (Path->TransportDecodeMessage == NULL)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (SpdmContext->TransportPathCount >= MAX_SPDM_TRANSPORT_PATH_COUNT) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  SpdmContext->TransportPathCount++;
+  Slot = &SpdmContext->TransportPath[SpdmContext->TransportPathCount];
+  ZeroMem (Slot, sizeof(*Slot));
+  Slot->SendMessage = Path->SendMessage;
+  Slot->ReceiveMessage = Path->ReceiveMessage;
+  Slot->DeviceIoContext = Path->DeviceIoContext;
+  Slot->TransportEncodeMessage = Path->TransportEncodeMessage;
+  Slot->TransportDecodeMessage = Path->TransportDecodeMessage;
+  Slot->TransportGetMessageRoom = Path->TransportGetMessageRoom;
+  Slot->MinPayloadSize = Path->MinPayloadSize;
+  if (PathIndex != NULL) {
+    *PathIndex = SpdmContext->TransportPathCount;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return the transport path to send a message of an SPDM context over.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the message, or NULL for a normal message.
+  @param  PayloadSize                  Size in bytes of the message before it is encoded.
+
+  @return the index of the transport path. It is 0 for a normal message or a message of a session not established.
+**/
+UINT8
+SpdmSelectTransportPath (
+  IN     SPDM_DEVICE_CONTEXT       *SpdmContext,
+  IN     UINT32                    *SessionId,
+  IN     UINTN                     PayloadSize
+  )
+{
+  SPDM_SESSION_INFO         *SessionInfo;
+  SPDM_TRANSPORT_PATH_SLOT  *Slot;
+  UINT8                     Index;
+  UINT8                     PathIndex;
+
+  if ((SpdmContext->TransportPathCount == 0) || (SessionId == NULL)) {
+    return 0;
+  }
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, *SessionId);
+  if ((SessionInfo == NULL) ||
+      (SpdmSecuredMessageGetSessionState (SessionInfo->SecuredMessageContext) != SpdmSessionStateEstablished)) {
+    return 0;
+  }
+
+  //
+  // The first path registered wins a tie.
+  //
+  PathIndex = 0;
+  for (Index = 1; Index <= SpdmContext->TransportPathCount; Index++) {
+    Slot = &SpdmContext->TransportPath[Index];
+    if (PayloadSize < Slot->MinPayloadSize) {
+      continue;
+    }
+    if ((PathIndex == 0) || (Slot->MinPayloadSize > SpdmContext->TransportPath[PathIndex].MinPayloadSize)) {
+      PathIndex = Index;
+    }
+  }
+  return PathIndex;
+}
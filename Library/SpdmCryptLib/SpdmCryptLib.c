@@ -9,6 +9,123 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <Library/SpdmCryptLib.h>
 
+#if OPENSPDM_CRYPTO_STATS_SUPPORT == 1
+
+#if defined(_MSC_VER)
+#define SPDM_CRYPTO_STATS_THREAD_LOCAL  __declspec(thread)
+#else
+#define SPDM_CRYPTO_STATS_THREAD_LOCAL  __thread
+#endif
+
+//
+// The crypto statistics bound to the calling thread, and its cycle function.
+//
+SPDM_CRYPTO_STATS_THREAD_LOCAL SPDM_CRYPTO_STATS           *mSpdmCryptoStats;
+SPDM_CRYPTO_STATS_THREAD_LOCAL SPDM_CRYPTO_GET_CYCLE_FUNC  mSpdmCryptoGetCycle;
+
+/**
+  Count a crypto operation in the crypto statistics bound to the calling thread.
+
+  @param  Operation                    The crypto operation.
+  @param  Bytes                        The bytes the operation processes.
+
+  @return the cycle counter at the start of the operation, or 0 if the cycles are not counted.
+**/
+UINT64
+SpdmCryptoStatsBegin (
+  IN SPDM_CRYPTO_OPERATION        Operation,
+  IN UINTN                        Bytes
+  )
+{
+  if (mSpdmCryptoStats == NULL) {
+    return 0;
+  }
+  mSpdmCryptoStats->Operation[Operation].Count++;
+  mSpdmCryptoStats->Operation[Operation].Bytes += Bytes;
+  if (mSpdmCryptoGetCycle == NULL) {
+    return 0;
+  }
+  return mSpdmCryptoGetCycle ();
+}
+
+/**
+  Count the cycles of a crypto operation in the crypto statistics bound to the calling thread.
+
+  @param  Operation                    The crypto operation.
+  @param  StartCycle                   The cycle counter returned by SpdmCryptoStatsBegin.
+  @param  Result                       The result of the operation.
+
+  @return Result.
+**/
+BOOLEAN
+SpdmCryptoStatsEnd (
+  IN SPDM_CRYPTO_OPERATION        Operation,
+  IN UINT64                       StartCycle,
+  IN BOOLEAN                      Result
+  )
+{
+  if ((mSpdmCryptoStats != NULL) && (mSpdmCryptoGetCycle != NULL)) {
+    mSpdmCryptoStats->Operation[Operation].Cycles += mSpdmCryptoGetCycle () - StartCycle;
+  }
+  return Result;
+}
+
+/**
+  Return the total size of data segments, for the crypto statistics.
+
+  @param  Segments                     The data segments.
+  @param  SegmentCount                 The number of data segments.
+
+  @return the total size in bytes of the data segments.
+**/
+UINTN
+SpdmCryptoStatsSegmentsSize (
+  IN CONST CRYPT_DATA_SEGMENT     *Segments,
+  IN UINTN                        SegmentCount
+  )
+{
+  UINTN  Index;
+  UINTN  Size;
+
+  Size = 0;
+  for (Index = 0; Index < SegmentCount; Index++) {
+    Size += Segments[Index].Size;
+  }
+  return Size;
+}
+
+#define SPDM_CRYPTO_STATS_BEGIN(Operation, Bytes)              SpdmCryptoStatsBegin (Operation, Bytes)
+#define SPDM_CRYPTO_STATS_END(Operation, StartCycle, Result)   SpdmCryptoStatsEnd (Operation, StartCycle, Result)
+
+#else
+
+#define SPDM_CRYPTO_STATS_BEGIN(Operation, Bytes)              0
+#define SPDM_CRYPTO_STATS_END(Operation, StartCycle, Result)   ((VOID)(StartCycle), (Result))
+
+#endif
+
+/**
+  Bind the crypto statistics the crypto operations of the calling thread are counted in.
+
+  It takes effect if OPENSPDM_CRYPTO_STATS_SUPPORT is 1. The SPDM library binds the statistics of
+  an SPDM context whenever it sends, receives or processes a message of the context.
+
+  @param  Stats                        The statistics to count the operations in, or NULL not to count them.
+  @param  GetCycle                     The fuction to read the cycle counter, or NULL not to count the cycles.
+**/
+VOID
+EFIAPI
+SpdmCryptoStatsBind (
+  IN SPDM_CRYPTO_STATS            *Stats,    OPTIONAL
+  IN SPDM_CRYPTO_GET_CYCLE_FUNC   GetCycle   OPTIONAL
+  )
+{
+#if OPENSPDM_CRYPTO_STATS_SUPPORT == 1
+  mSpdmCryptoStats = Stats;
+  mSpdmCryptoGetCycle = GetCycle;
+#endif
+}
+
 /**
   This function returns the SPDM hash algorithm size.
 
@@ -100,10 +217,26 @@ GetSpdmHashFunc (
     break;
 #endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+#if OPENSPDM_SHA3_256_SUPPORT == 1
+    return Sha3_256HashAll;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+#if OPENSPDM_SHA3_384_SUPPORT == 1
+    return Sha3_384HashAll;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+#if OPENSPDM_SHA3_512_SUPPORT == 1
+    return Sha3_512HashAll;
+#else
     ASSERT (FALSE);
     break;
+#endif
   }
   ASSERT (FALSE);
   return NULL;
@@ -132,336 +265,366 @@ SpdmHashAll (
   )
 {
   HASH_ALL   HashFunction;
+  UINT64     StatsStart;
   HashFunction = GetSpdmHashFunc (BaseHashAlgo);
   if (HashFunction == NULL) {
     return FALSE;
   }
-  return HashFunction (Data, DataSize, HashValue);
-}
-
-/**
-  This function returns the SPDM measurement hash algorithm size.
-
-  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
-
-  @return SPDM measurement hash algorithm size.
-  @return 0xFFFFFFFF for RAW_BIT_STREAM_ONLY.
-**/
-UINT32
-EFIAPI
-GetSpdmMeasurementHashSize (
-  IN   UINT32                       MeasurementHashAlgo
-  )
-{
-  switch (MeasurementHashAlgo) {
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256:
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_256:
-    return 32;
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384:
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_384:
-    return 48;
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_512:
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_512:
-    return 64;
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_RAW_BIT_STREAM_ONLY:
-    return 0xFFFFFFFF;
-  }
-  return 0;
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationHash, DataSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationHash, StatsStart, HashFunction (Data, DataSize, HashValue));
 }
 
 /**
-  Return hash function, based upon the negotiated measurement hash algorithm.
+  Return hash new function, based upon the negotiated hash algorithm.
 
-  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
 
-  @return hash function
+  @return hash new function
 **/
-HASH_ALL
-GetSpdmMeasurementHashFunc (
-  IN   UINT32                       MeasurementHashAlgo
+HASH_NEW
+GetSpdmHashNewFunc (
+  IN      UINT32       BaseHashAlgo
   )
 {
-  switch (MeasurementHashAlgo) {
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256:
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
 #if OPENSPDM_SHA256_SUPPORT == 1
-    return Sha256HashAll;
+    return Sha256New;
 #else
     ASSERT (FALSE);
     break;
 #endif
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
 #if OPENSPDM_SHA384_SUPPORT == 1
-    return Sha384HashAll;
+    return Sha384New;
 #else
     ASSERT (FALSE);
     break;
 #endif
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_512:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
 #if OPENSPDM_SHA512_SUPPORT == 1
-    return Sha512HashAll;
+    return Sha512New;
 #else
     ASSERT (FALSE);
     break;
 #endif
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_256:
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_384:
-  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_512:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+#if OPENSPDM_SHA3_256_SUPPORT == 1
+    return Sha3_256New;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+#if OPENSPDM_SHA3_384_SUPPORT == 1
+    return Sha3_384New;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+#if OPENSPDM_SHA3_512_SUPPORT == 1
+    return Sha3_512New;
+#else
     ASSERT (FALSE);
     break;
+#endif
   }
   ASSERT (FALSE);
   return NULL;
 }
 
 /**
-  Computes the hash of a input data buffer, based upon the negotiated measurement hash algorithm.
-
-  This function performs the hash of a given data buffer, and return the hash value.
-
-  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
-  @param  Data                         Pointer to the buffer containing the data to be hashed.
-  @param  DataSize                     Size of Data buffer in bytes.
-  @param  HashValue                    Pointer to a buffer that receives the hash value.
-
-  @retval TRUE   Hash computation succeeded.
-  @retval FALSE  Hash computation failed.
-**/
-BOOLEAN
-EFIAPI
-SpdmMeasurementHashAll (
-  IN   UINT32                       MeasurementHashAlgo,
-  IN   CONST VOID                   *Data,
-  IN   UINTN                        DataSize,
-  OUT  UINT8                        *HashValue
-  )
-{
-  HASH_ALL   HashFunction;
-  HashFunction = GetSpdmMeasurementHashFunc (MeasurementHashAlgo);
-  if (HashFunction == NULL) {
-    return FALSE;
-  }
-  return HashFunction (Data, DataSize, HashValue);
-}
-
-/**
-  Return HMAC function, based upon the negotiated HMAC algorithm.
+  Return hash free function, based upon the negotiated hash algorithm.
 
-  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
 
-  @return HMAC function
+  @return hash free function
 **/
-HMAC_ALL
-GetSpdmHmacFunc (
-  IN   UINT32                       BaseHashAlgo
+HASH_FREE
+GetSpdmHashFreeFunc (
+  IN      UINT32       BaseHashAlgo
   )
 {
   switch (BaseHashAlgo) {
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
 #if OPENSPDM_SHA256_SUPPORT == 1
-    return HmacSha256All;
+    return Sha256Free;
 #else
     ASSERT (FALSE);
     break;
 #endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
 #if OPENSPDM_SHA384_SUPPORT == 1
-    return HmacSha384All;
+    return Sha384Free;
 #else
     ASSERT (FALSE);
     break;
 #endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
 #if OPENSPDM_SHA512_SUPPORT == 1
-    return HmacSha512All;
+    return Sha512Free;
 #else
     ASSERT (FALSE);
     break;
 #endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+#if OPENSPDM_SHA3_256_SUPPORT == 1
+    return Sha3_256Free;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+#if OPENSPDM_SHA3_384_SUPPORT == 1
+    return Sha3_384Free;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+#if OPENSPDM_SHA3_512_SUPPORT == 1
+    return Sha3_512Free;
+#else
     ASSERT (FALSE);
     break;
+#endif
   }
   ASSERT (FALSE);
   return NULL;
 }
 
 /**
-  Computes the HMAC of a input data buffer, based upon the negotiated HMAC algorithm.
-
-  This function performs the HMAC of a given data buffer, and return the hash value.
-
-  @param  BaseHashAlgo                 SPDM BaseHashAlgo
-  @param  Data                         Pointer to the buffer containing the data to be HMACed.
-  @param  DataSize                     Size of Data buffer in bytes.
-  @param  Key                          Pointer to the user-supplied key.
-  @param  KeySize                      Key size in bytes.
-  @param  HashValue                    Pointer to a buffer that receives the HMAC value.
-
-  @retval TRUE   HMAC computation succeeded.
-  @retval FALSE  HMAC computation failed.
-**/
-BOOLEAN
-EFIAPI
-SpdmHmacAll (
-  IN   UINT32                       BaseHashAlgo,
-  IN   CONST VOID                   *Data,
-  IN   UINTN                        DataSize,
-  IN   CONST UINT8                  *Key,
-  IN   UINTN                        KeySize,
-  OUT  UINT8                        *HmacValue
-  )
-{
-  HMAC_ALL   HmacFunction;
-  HmacFunction = GetSpdmHmacFunc (BaseHashAlgo);
-  if (HmacFunction == NULL) {
-    return FALSE;
-  }
-  return HmacFunction (Data, DataSize, Key, KeySize, HmacValue);
-}
-
-/**
-  Return HKDF expand function, based upon the negotiated HKDF algorithm.
+  Return hash init function, based upon the negotiated hash algorithm.
 
-  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
 
-  @return HKDF expand function
+  @return hash init function
 **/
-HKDF_EXPAND
-GetSpdmHkdfExpandFunc (
-  IN   UINT32                       BaseHashAlgo
+HASH_INIT
+GetSpdmHashInitFunc (
+  IN      UINT32       BaseHashAlgo
   )
 {
   switch (BaseHashAlgo) {
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
 #if OPENSPDM_SHA256_SUPPORT == 1
-    return HkdfSha256Expand;
+    return Sha256Init;
 #else
     ASSERT (FALSE);
     break;
 #endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
 #if OPENSPDM_SHA384_SUPPORT == 1
-    return HkdfSha384Expand;
+    return Sha384Init;
 #else
     ASSERT (FALSE);
     break;
 #endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
 #if OPENSPDM_SHA512_SUPPORT == 1
-    return HkdfSha512Expand;
+    return Sha512Init;
 #else
     ASSERT (FALSE);
     break;
 #endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+#if OPENSPDM_SHA3_256_SUPPORT == 1
+    return Sha3_256Init;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+#if OPENSPDM_SHA3_384_SUPPORT == 1
+    return Sha3_384Init;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+#if OPENSPDM_SHA3_512_SUPPORT == 1
+    return Sha3_512Init;
+#else
     ASSERT (FALSE);
     break;
+#endif
   }
   ASSERT (FALSE);
   return NULL;
 }
 
 /**
-  Derive HMAC-based Expand Key Derivation Function (HKDF) Expand, based upon the negotiated HKDF algorithm.
+  Return hash duplicate function, based upon the negotiated hash algorithm.
 
-  @param  BaseHashAlgo                 SPDM BaseHashAlgo
-  @param  Prk                          Pointer to the user-supplied key.
-  @param  PrkSize                      Key size in bytes.
-  @param  Info                         Pointer to the application specific info.
-  @param  InfoSize                     Info size in bytes.
-  @param  Out                          Pointer to buffer to receive hkdf value.
-  @param  OutSize                      Size of hkdf bytes to generate.
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
 
-  @retval TRUE   Hkdf generated successfully.
-  @retval FALSE  Hkdf generation failed.
+  @return hash duplicate function
 **/
-BOOLEAN
-EFIAPI
-SpdmHkdfExpand (
-  IN   UINT32                       BaseHashAlgo,
-  IN   CONST UINT8                  *Prk,
-  IN   UINTN                        PrkSize,
-  IN   CONST UINT8                  *Info,
-  IN   UINTN                        InfoSize,
-  OUT  UINT8                        *Out,
-  IN   UINTN                        OutSize
+HASH_DUPLICATE
+GetSpdmHashDuplicateFunc (
+  IN      UINT32       BaseHashAlgo
   )
 {
-  HKDF_EXPAND   HkdfExpandFunction;
-  HkdfExpandFunction = GetSpdmHkdfExpandFunc (BaseHashAlgo);
-  if (HkdfExpandFunction == NULL) {
-    return FALSE;
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return Sha256Duplicate;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return Sha384Duplicate;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return Sha512Duplicate;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+#if OPENSPDM_SHA3_256_SUPPORT == 1
+    return Sha3_256Duplicate;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+#if OPENSPDM_SHA3_384_SUPPORT == 1
+    return Sha3_384Duplicate;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+#if OPENSPDM_SHA3_512_SUPPORT == 1
+    return Sha3_512Duplicate;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   }
-  return HkdfExpandFunction (Prk, PrkSize, Info, InfoSize, Out, OutSize);
+  ASSERT (FALSE);
+  return NULL;
 }
 
 /**
-  This function returns the SPDM asymmetric algorithm size.
+  Return hash update function, based upon the negotiated hash algorithm.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
 
-  @return SPDM asymmetric algorithm size.
+  @return hash update function
 **/
-UINT32
-EFIAPI
-GetSpdmAsymSignatureSize (
-  IN   UINT32                       BaseAsymAlgo
+HASH_UPDATE
+GetSpdmHashUpdateFunc (
+  IN      UINT32       BaseHashAlgo
   )
 {
-  switch (BaseAsymAlgo) {
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
-    return 256;
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
-    return 384;
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
-    return 512;
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
-    return 32 * 2;
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
-    return 48 * 2;
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
-    return 66 * 2;
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return Sha256Update;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return Sha384Update;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return Sha512Update;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+#if OPENSPDM_SHA3_256_SUPPORT == 1
+    return Sha3_256Update;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+#if OPENSPDM_SHA3_384_SUPPORT == 1
+    return Sha3_384Update;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+#if OPENSPDM_SHA3_512_SUPPORT == 1
+    return Sha3_512Update;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   }
-  return 0;
+  ASSERT (FALSE);
+  return NULL;
 }
 
 /**
-  Return asymmetric GET_PUBLIC_KEY_FROM_X509 function, based upon the negotiated asymmetric algorithm.
+  Return hash final function, based upon the negotiated hash algorithm.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
 
-  @return asymmetric GET_PUBLIC_KEY_FROM_X509 function
+  @return hash final function
 **/
-ASYM_GET_PUBLIC_KEY_FROM_X509
-GetSpdmAsymGetPublicKeyFromX509 (
-  IN   UINT32                       BaseAsymAlgo
+HASH_FINAL
+GetSpdmHashFinalFunc (
+  IN      UINT32       BaseHashAlgo
   )
 {
-  switch (BaseAsymAlgo) {
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
-#if (OPENSPDM_RSA_SSA_SUPPORT == 1) || (OPENSPDM_RSA_PSS_SUPPORT == 1)
-    return RsaGetPublicKeyFromX509;
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return Sha256Final;
 #else
     ASSERT (FALSE);
     break;
 #endif
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
-#if OPENSPDM_ECDSA_SUPPORT == 1
-    return EcGetPublicKeyFromX509;
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return Sha384Final;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return Sha512Final;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+#if OPENSPDM_SHA3_256_SUPPORT == 1
+    return Sha3_256Final;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+#if OPENSPDM_SHA3_384_SUPPORT == 1
+    return Sha3_384Final;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+#if OPENSPDM_SHA3_512_SUPPORT == 1
+    return Sha3_512Final;
 #else
     ASSERT (FALSE);
     break;
@@ -472,330 +635,282 @@ GetSpdmAsymGetPublicKeyFromX509 (
 }
 
 /**
-  Retrieve the asymmetric Public Key from one DER-encoded X509 certificate,
-  based upon negotiated asymmetric algorithm.
+  Allocates and initializes one hash context for subsequent use,
+  based upon the negotiated hash algorithm.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
-  @param  Cert                         Pointer to the DER-encoded X509 certificate.
-  @param  CertSize                     Size of the X509 certificate in bytes.
-  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
-                                       Use SpdmAsymFree() function to free the resource.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
 
-  @retval  TRUE   Public Key was retrieved successfully.
-  @retval  FALSE  Fail to retrieve public key from X509 certificate.
+  @return  Pointer to the hash context that has been initialized.
+           If the allocations fails, NULL is returned.
 **/
-BOOLEAN
+VOID *
 EFIAPI
-SpdmAsymGetPublicKeyFromX509 (
-  IN   UINT32                       BaseAsymAlgo,
-  IN   CONST UINT8                  *Cert,
-  IN   UINTN                        CertSize,
-  OUT  VOID                         **Context
+SpdmHashNew (
+  IN   UINT32                       BaseHashAlgo
   )
 {
-  ASYM_GET_PUBLIC_KEY_FROM_X509   GetPublicKeyFromX509Function;
-  GetPublicKeyFromX509Function = GetSpdmAsymGetPublicKeyFromX509 (BaseAsymAlgo);
-  if (GetPublicKeyFromX509Function == NULL) {
-    return FALSE;
+  HASH_NEW   NewFunction;
+  HASH_INIT  InitFunction;
+  HASH_FREE  FreeFunction;
+  VOID       *HashContext;
+
+  NewFunction = GetSpdmHashNewFunc (BaseHashAlgo);
+  InitFunction = GetSpdmHashInitFunc (BaseHashAlgo);
+  FreeFunction = GetSpdmHashFreeFunc (BaseHashAlgo);
+  if ((NewFunction == NULL) || (InitFunction == NULL) || (FreeFunction == NULL)) {
+    return NULL;
   }
-  return GetPublicKeyFromX509Function (Cert, CertSize, Context);
-}
-
-/**
-  Return asymmetric free function, based upon the negotiated asymmetric algorithm.
-
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
-
-  @return asymmetric free function
-**/
-ASYM_FREE
-GetSpdmAsymFree (
-  IN   UINT32                       BaseAsymAlgo
-  )
-{
-  switch (BaseAsymAlgo) {
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
-#if (OPENSPDM_RSA_SSA_SUPPORT == 1) || (OPENSPDM_RSA_PSS_SUPPORT == 1)
-    return RsaFree;
-#else
-    ASSERT (FALSE);
-    break;
-#endif
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
-#if OPENSPDM_ECDSA_SUPPORT == 1
-    return EcFree;
-#else
-    ASSERT (FALSE);
-    break;
-#endif
+  HashContext = NewFunction ();
+  if (HashContext == NULL) {
+    return NULL;
   }
-  ASSERT (FALSE);
-  return NULL;
+  if (!InitFunction (HashContext)) {
+    FreeFunction (HashContext);
+    return NULL;
+  }
+  return HashContext;
 }
 
 /**
-  Release the specified asymmetric context,
-  based upon negotiated asymmetric algorithm.
+  Release the specified hash context,
+  based upon the negotiated hash algorithm.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
-  @param  Context                      Pointer to the asymmetric context to be released.
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HashContext                  Pointer to the hash context to be released.
 **/
 VOID
 EFIAPI
-SpdmAsymFree (
-  IN   UINT32                       BaseAsymAlgo,
-  IN   VOID                         *Context
+SpdmHashFree (
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *HashContext
   )
 {
-  ASYM_FREE   FreeFunction;
-  FreeFunction = GetSpdmAsymFree (BaseAsymAlgo);
+  HASH_FREE   FreeFunction;
+
+  if (HashContext == NULL) {
+    return ;
+  }
+  FreeFunction = GetSpdmHashFreeFunc (BaseHashAlgo);
   if (FreeFunction == NULL) {
     return ;
   }
-  FreeFunction (Context);
+  FreeFunction (HashContext);
 }
 
 /**
-  Return if asymmetric function need message hash.
+  Makes a copy of an existing hash context,
+  based upon the negotiated hash algorithm.
 
-  @param  BaseAsymAlgo               SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HashContext                  Pointer to hash context being copied.
+  @param  NewHashContext               Pointer to new hash context.
 
-  @retval TRUE  asymmetric function need message hash
-  @retval FALSE asymmetric function need raw message
+  @retval TRUE   Hash context copy succeeded.
+  @retval FALSE  Hash context copy failed.
 **/
 BOOLEAN
-SpdmAsymFuncNeedHash (
-  IN   UINT32                       BaseAsymAlgo
+EFIAPI
+SpdmHashDuplicate (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST VOID                   *HashContext,
+  OUT  VOID                         *NewHashContext
   )
 {
-  switch (BaseAsymAlgo) {
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
-    return TRUE;
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
-    return TRUE;
+  HASH_DUPLICATE   DuplicateFunction;
+  DuplicateFunction = GetSpdmHashDuplicateFunc (BaseHashAlgo);
+  if (DuplicateFunction == NULL) {
+    return FALSE;
   }
-  ASSERT (FALSE);
-  return FALSE;
+  return DuplicateFunction (HashContext, NewHashContext);
 }
 
 /**
-  Return asymmetric verify function, based upon the negotiated asymmetric algorithm.
+  Digests the input data and updates hash context,
+  based upon the negotiated hash algorithm.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  This function can be called multiple times to compute the digest of discontinuous data streams.
 
-  @return asymmetric verify function
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HashContext                  Pointer to the hash context.
+  @param  Data                         Pointer to the buffer containing the data to be hashed.
+  @param  DataSize                     Size of Data buffer in bytes.
+
+  @retval TRUE   Hash data digest succeeded.
+  @retval FALSE  Hash data digest failed.
 **/
-ASYM_VERIFY
-GetSpdmAsymVerify (
-  IN   UINT32                       BaseAsymAlgo
+BOOLEAN
+EFIAPI
+SpdmHashUpdate (
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *HashContext,
+  IN   CONST VOID                   *Data,
+  IN   UINTN                        DataSize
   )
 {
-  switch (BaseAsymAlgo) {
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
-#if OPENSPDM_RSA_SSA_SUPPORT == 1
-    return RsaPkcs1VerifyWithNid;
-#else
-    ASSERT (FALSE);
-    break;
-#endif
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
-#if OPENSPDM_RSA_PSS_SUPPORT == 1
-    return RsaPssVerify;
-#else
-    ASSERT (FALSE);
-    break;
-#endif
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
-#if OPENSPDM_ECDSA_SUPPORT == 1
-    return EcDsaVerify;
-#else
-    ASSERT (FALSE);
-    break;
-#endif
+  HASH_UPDATE   UpdateFunction;
+  UINT64        StatsStart;
+  UpdateFunction = GetSpdmHashUpdateFunc (BaseHashAlgo);
+  if (UpdateFunction == NULL) {
+    return FALSE;
   }
-  ASSERT (FALSE);
-  return NULL;
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationHash, DataSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationHash, StatsStart, UpdateFunction (HashContext, Data, DataSize));
 }
 
 /**
-  Verifies the asymmetric signature,
-  based upon negotiated asymmetric algorithm.
+  Completes computation of the hash digest value,
+  based upon the negotiated hash algorithm.
+
+  After this function has been called, the hash context cannot be used again.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
   @param  BaseHashAlgo                 SPDM BaseHashAlgo
-  @param  Context                      Pointer to asymmetric context for signature verification.
-  @param  Message                      Pointer to octet message to be checked (before hash).
-  @param  MessageSize                  Size of the message in bytes.
-  @param  Signature                    Pointer to asymmetric signature to be verified.
-  @param  SigSize                      Size of signature in bytes.
+  @param  HashContext                  Pointer to the hash context.
+  @param  HashValue                    Pointer to a buffer that receives the hash value.
 
-  @retval  TRUE   Valid asymmetric signature.
-  @retval  FALSE  Invalid asymmetric signature or invalid asymmetric context.
+  @retval TRUE   Hash digest computation succeeded.
+  @retval FALSE  Hash digest computation failed.
 **/
 BOOLEAN
 EFIAPI
-SpdmAsymVerify (
-  IN   UINT32                       BaseAsymAlgo,
+SpdmHashFinal (
   IN   UINT32                       BaseHashAlgo,
-  IN   VOID                         *Context,
-  IN   CONST UINT8                  *Message,
-  IN   UINTN                        MessageSize,
-  IN   CONST UINT8                  *Signature,
-  IN   UINTN                        SigSize
+  IN   VOID                         *HashContext,
+  OUT  UINT8                        *HashValue
   )
 {
-  ASYM_VERIFY   VerifyFunction;
-  BOOLEAN       NeedHash;
-  UINT8         MessageHash[MAX_HASH_SIZE];
-  UINTN         HashSize;
-  BOOLEAN       Result;
-  UINTN         HashNid;
-
-  HashNid = GetSpdmHashNid (BaseHashAlgo);
-  NeedHash = SpdmAsymFuncNeedHash (BaseAsymAlgo);
-
-  VerifyFunction = GetSpdmAsymVerify (BaseAsymAlgo);
-  if (VerifyFunction == NULL) {
+  HASH_FINAL   FinalFunction;
+  FinalFunction = GetSpdmHashFinalFunc (BaseHashAlgo);
+  if (FinalFunction == NULL) {
     return FALSE;
   }
-  if (NeedHash) {
-    HashSize = GetSpdmHashSize (BaseHashAlgo);
-    Result = SpdmHashAll (BaseHashAlgo, Message, MessageSize, MessageHash);
-    if (!Result) {
-      return FALSE;
-    }
-    return VerifyFunction (Context, HashNid, MessageHash, HashSize, Signature, SigSize);
-  } else {
-    return VerifyFunction (Context, HashNid, Message, MessageSize, Signature, SigSize);
-  }
+  return FinalFunction (HashContext, HashValue);
 }
 
 /**
-  Return asymmetric GET_PRIVATE_KEY_FROM_PEM function, based upon the asymmetric algorithm.
+  Computes the hash of a list of data segments, based upon the negotiated hash algorithm.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  The segments are hashed in order, as if they were one contiguous buffer.
 
-  @return asymmetric GET_PRIVATE_KEY_FROM_PEM function
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Segments                     Pointer to the list of data segments to be hashed.
+  @param  SegmentCount                 Number of entries in Segments.
+  @param  HashValue                    Pointer to a buffer that receives the hash value.
+
+  @retval TRUE   Hash computation succeeded.
+  @retval FALSE  Hash computation failed.
 **/
-ASYM_GET_PRIVATE_KEY_FROM_PEM
-GetSpdmAsymGetPrivateKeyFromPem (
-  IN   UINT32                       BaseAsymAlgo
+BOOLEAN
+EFIAPI
+SpdmHashAllSegments (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST CRYPT_DATA_SEGMENT     *Segments,
+  IN   UINTN                        SegmentCount,
+  OUT  UINT8                        *HashValue
   )
 {
-  switch (BaseAsymAlgo) {
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
-#if (OPENSPDM_RSA_SSA_SUPPORT == 1) || (OPENSPDM_RSA_PSS_SUPPORT == 1)
-    return RsaGetPrivateKeyFromPem;
-#else
-    ASSERT (FALSE);
-    break;
-#endif
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
-#if OPENSPDM_ECDSA_SUPPORT == 1
-    return EcGetPrivateKeyFromPem;
-#else
-    ASSERT (FALSE);
-    break;
-#endif
+  VOID       *HashContext;
+  UINTN      Index;
+  BOOLEAN    Result;
+
+  if ((Segments == NULL) && (SegmentCount != 0)) {
+    return FALSE;
   }
-  ASSERT (FALSE);
-  return NULL;
+  HashContext = SpdmHashNew (BaseHashAlgo);
+  if (HashContext == NULL) {
+    return FALSE;
+  }
+  Result = TRUE;
+  for (Index = 0; (Index < SegmentCount) && Result; Index++) {
+    Result = SpdmHashUpdate (BaseHashAlgo, HashContext, Segments[Index].Buffer, Segments[Index].Size);
+  }
+  if (Result) {
+    Result = SpdmHashFinal (BaseHashAlgo, HashContext, HashValue);
+  }
+  SpdmHashFree (BaseHashAlgo, HashContext);
+  return Result;
 }
 
 /**
-  Retrieve the Private Key from the password-protected PEM key data.
+  This function returns the SPDM measurement hash algorithm size.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
-  @param  PemData                      Pointer to the PEM-encoded key data to be retrieved.
-  @param  PemSize                      Size of the PEM key data in bytes.
-  @param  Password                     NULL-terminated passphrase used for encrypted PEM key data.
-  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved private key component.
-                                       Use SpdmAsymFree() function to free the resource.
+  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
 
-  @retval  TRUE   Private Key was retrieved successfully.
-  @retval  FALSE  Invalid PEM key data or incorrect password.
+  @return SPDM measurement hash algorithm size.
+  @return 0xFFFFFFFF for RAW_BIT_STREAM_ONLY.
 **/
-BOOLEAN
+UINT32
 EFIAPI
-SpdmAsymGetPrivateKeyFromPem (
-  IN   UINT32                       BaseAsymAlgo,
-  IN   CONST UINT8                  *PemData,
-  IN   UINTN                        PemSize,
-  IN   CONST CHAR8                  *Password,
-  OUT  VOID                         **Context
+GetSpdmMeasurementHashSize (
+  IN   UINT32                       MeasurementHashAlgo
   )
 {
-  ASYM_GET_PRIVATE_KEY_FROM_PEM   AsymGetPrivateKeyFromPem;
-  AsymGetPrivateKeyFromPem = GetSpdmAsymGetPrivateKeyFromPem (BaseAsymAlgo);
-  if (AsymGetPrivateKeyFromPem == NULL) {
-    return FALSE;
+  switch (MeasurementHashAlgo) {
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256:
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_256:
+    return 32;
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384:
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_384:
+    return 48;
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_512:
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_512:
+    return 64;
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_RAW_BIT_STREAM_ONLY:
+    return 0xFFFFFFFF;
   }
-  return AsymGetPrivateKeyFromPem (PemData, PemSize, Password, Context);
+  return 0;
 }
 
 /**
-  Return asymmetric sign function, based upon the asymmetric algorithm.
+  Return hash function, based upon the negotiated measurement hash algorithm.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
 
-  @return asymmetric sign function
+  @return hash function
 **/
-ASYM_SIGN
-GetSpdmAsymSign (
-  IN   UINT32                       BaseAsymAlgo
+HASH_ALL
+GetSpdmMeasurementHashFunc (
+  IN   UINT32                       MeasurementHashAlgo
   )
 {
-  switch (BaseAsymAlgo) {
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
-#if OPENSPDM_RSA_SSA_SUPPORT == 1
-    return RsaPkcs1SignWithNid;
+  switch (MeasurementHashAlgo) {
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return Sha256HashAll;
 #else
     ASSERT (FALSE);
     break;
 #endif
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
-#if OPENSPDM_RSA_PSS_SUPPORT == 1
-    return RsaPssSign;
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return Sha384HashAll;
 #else
     ASSERT (FALSE);
     break;
 #endif
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
-  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
-#if OPENSPDM_ECDSA_SUPPORT == 1
-    return EcDsaSign;
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return Sha512HashAll;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_256:
+#if OPENSPDM_SHA3_256_SUPPORT == 1
+    return Sha3_256HashAll;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_384:
+#if OPENSPDM_SHA3_384_SUPPORT == 1
+    return Sha3_384HashAll;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_512:
+#if OPENSPDM_SHA3_512_SUPPORT == 1
+    return Sha3_512HashAll;
 #else
     ASSERT (FALSE);
     break;
@@ -806,448 +921,2848 @@ GetSpdmAsymSign (
 }
 
 /**
-  Carries out the signature generation.
+  Computes the hash of a input data buffer, based upon the negotiated measurement hash algorithm.
 
-  If the Signature buffer is too small to hold the contents of signature, FALSE
-  is returned and SigSize is set to the required buffer size to obtain the signature.
+  This function performs the hash of a given data buffer, and return the hash value.
 
-  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
-  @param  BaseHashAlgo                 SPDM BaseHashAlgo
-  @param  Context                      Pointer to asymmetric context for signature generation.
-  @param  Message                      Pointer to octet message to be signed (before hash).
-  @param  MessageSize                  Size of the message in bytes.
-  @param  Signature                    Pointer to buffer to receive signature.
-  @param  SigSize                      On input, the size of Signature buffer in bytes.
-                                       On output, the size of data returned in Signature buffer in bytes.
+  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
+  @param  Data                         Pointer to the buffer containing the data to be hashed.
+  @param  DataSize                     Size of Data buffer in bytes.
+  @param  HashValue                    Pointer to a buffer that receives the hash value.
 
-  @retval  TRUE   Signature successfully generated.
-  @retval  FALSE  Signature generation failed.
-  @retval  FALSE  SigSize is too small.
+  @retval TRUE   Hash computation succeeded.
+  @retval FALSE  Hash computation failed.
 **/
 BOOLEAN
 EFIAPI
-SpdmAsymSign (
-  IN      UINT32                       BaseAsymAlgo,
-  IN      UINT32                       BaseHashAlgo,
-  IN      VOID                         *Context,
-  IN      CONST UINT8                  *Message,
-  IN      UINTN                        MessageSize,
-  OUT     UINT8                        *Signature,
-  IN OUT  UINTN                        *SigSize
-  )
-{
-  ASYM_SIGN     AsymSign;
-  BOOLEAN       NeedHash;
+SpdmMeasurementHashAll (
+  IN   UINT32                       MeasurementHashAlgo,
+  IN   CONST VOID                   *Data,
+  IN   UINTN                        DataSize,
+  OUT  UINT8                        *HashValue
+  )
+{
+  HASH_ALL   HashFunction;
+  HashFunction = GetSpdmMeasurementHashFunc (MeasurementHashAlgo);
+  if (HashFunction == NULL) {
+    return FALSE;
+  }
+  return HashFunction (Data, DataSize, HashValue);
+}
+
+/**
+  Return multi-buffer hash function, based upon the negotiated measurement hash algorithm.
+
+  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
+
+  @return multi-buffer hash function, or NULL if the algorithm has none.
+**/
+HASH_ALL_MULTI
+GetSpdmMeasurementHashMultiFunc (
+  IN   UINT32                       MeasurementHashAlgo
+  )
+{
+  switch (MeasurementHashAlgo) {
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return Sha256HashAllMulti;
+#else
+    break;
+#endif
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return Sha384HashAllMulti;
+#else
+    break;
+#endif
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_256:
+#if OPENSPDM_SHA3_256_SUPPORT == 1
+    return Sha3_256HashAllMulti;
+#else
+    break;
+#endif
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_384:
+#if OPENSPDM_SHA3_384_SUPPORT == 1
+    return Sha3_384HashAllMulti;
+#else
+    break;
+#endif
+  case SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA3_512:
+#if OPENSPDM_SHA3_512_SUPPORT == 1
+    return Sha3_512HashAllMulti;
+#else
+    break;
+#endif
+  }
+  return NULL;
+}
+
+/**
+  Computes the hashes of several independent data buffers, based upon the negotiated measurement hash algorithm.
+
+  The result is the same as calling SpdmMeasurementHashAll() on each buffer, but the crypto
+  backend may hash several buffers at once.
+
+  @param  MeasurementHashAlgo          SPDM MeasurementHashAlgo
+  @param  Count                        Number of data buffers.
+  @param  Data                         Array of Count data buffers to be hashed.
+  @param  HashValue                    Array of Count pointers to buffers that receive the hash values.
+
+  @retval TRUE   Hash computation succeeded.
+  @retval FALSE  Hash computation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmMeasurementHashMulti (
+  IN   UINT32                       MeasurementHashAlgo,
+  IN   UINTN                        Count,
+  IN   CONST CRYPT_DATA_SEGMENT     *Data,
+  IN   UINT8                        **HashValue
+  )
+{
+  HASH_ALL_MULTI  HashMultiFunction;
+  HASH_ALL        HashFunction;
+  UINTN           Index;
+
+  HashMultiFunction = GetSpdmMeasurementHashMultiFunc (MeasurementHashAlgo);
+  if (HashMultiFunction != NULL) {
+    return HashMultiFunction (Count, Data, HashValue);
+  }
+
+  HashFunction = GetSpdmMeasurementHashFunc (MeasurementHashAlgo);
+  if (HashFunction == NULL) {
+    return FALSE;
+  }
+  for (Index = 0; Index < Count; Index++) {
+    if (!HashFunction (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Return HMAC function, based upon the negotiated HMAC algorithm.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+
+  @return HMAC function
+**/
+HMAC_ALL
+GetSpdmHmacFunc (
+  IN   UINT32                       BaseHashAlgo
+  )
+{
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return HmacSha256All;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return HmacSha384All;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return HmacSha512All;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+    ASSERT (FALSE);
+    break;
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Computes the HMAC of a input data buffer, based upon the negotiated HMAC algorithm.
+
+  This function performs the HMAC of a given data buffer, and return the hash value.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Data                         Pointer to the buffer containing the data to be HMACed.
+  @param  DataSize                     Size of Data buffer in bytes.
+  @param  Key                          Pointer to the user-supplied key.
+  @param  KeySize                      Key size in bytes.
+  @param  HashValue                    Pointer to a buffer that receives the HMAC value.
+
+  @retval TRUE   HMAC computation succeeded.
+  @retval FALSE  HMAC computation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHmacAll (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST VOID                   *Data,
+  IN   UINTN                        DataSize,
+  IN   CONST UINT8                  *Key,
+  IN   UINTN                        KeySize,
+  OUT  UINT8                        *HmacValue
+  )
+{
+  HMAC_ALL   HmacFunction;
+  UINT64     StatsStart;
+  HmacFunction = GetSpdmHmacFunc (BaseHashAlgo);
+  if (HmacFunction == NULL) {
+    return FALSE;
+  }
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationHmac, DataSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationHmac, StatsStart, HmacFunction (Data, DataSize, Key, KeySize, HmacValue));
+}
+
+/**
+  Return HKDF expand function, based upon the negotiated HKDF algorithm.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+
+  @return HKDF expand function
+**/
+HKDF_EXPAND
+GetSpdmHkdfExpandFunc (
+  IN   UINT32                       BaseHashAlgo
+  )
+{
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return HkdfSha256Expand;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return HkdfSha384Expand;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return HkdfSha512Expand;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+    ASSERT (FALSE);
+    break;
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Derive HMAC-based Expand Key Derivation Function (HKDF) Expand, based upon the negotiated HKDF algorithm.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Prk                          Pointer to the user-supplied key.
+  @param  PrkSize                      Key size in bytes.
+  @param  Info                         Pointer to the application specific info.
+  @param  InfoSize                     Info size in bytes.
+  @param  Out                          Pointer to buffer to receive hkdf value.
+  @param  OutSize                      Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHkdfExpand (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST UINT8                  *Prk,
+  IN   UINTN                        PrkSize,
+  IN   CONST UINT8                  *Info,
+  IN   UINTN                        InfoSize,
+  OUT  UINT8                        *Out,
+  IN   UINTN                        OutSize
+  )
+{
+  HKDF_EXPAND   HkdfExpandFunction;
+  UINT64        StatsStart;
+  HkdfExpandFunction = GetSpdmHkdfExpandFunc (BaseHashAlgo);
+  if (HkdfExpandFunction == NULL) {
+    return FALSE;
+  }
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationHkdfExpand, OutSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationHkdfExpand, StatsStart, HkdfExpandFunction (Prk, PrkSize, Info, InfoSize, Out, OutSize));
+}
+
+/**
+  Return HMAC new function, based upon the negotiated HMAC algorithm.
+
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
+
+  @return HMAC new function
+**/
+HMAC_NEW
+GetSpdmHmacNewFunc (
+  IN   UINT32                       BaseHashAlgo
+  )
+{
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return HmacSha256New;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return HmacSha384New;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return HmacSha512New;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+    ASSERT (FALSE);
+    break;
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Return HMAC free function, based upon the negotiated HMAC algorithm.
+
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
+
+  @return HMAC free function
+**/
+HMAC_FREE
+GetSpdmHmacFreeFunc (
+  IN   UINT32                       BaseHashAlgo
+  )
+{
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return HmacSha256Free;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return HmacSha384Free;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return HmacSha512Free;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+    ASSERT (FALSE);
+    break;
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Return HMAC set key function, based upon the negotiated HMAC algorithm.
+
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
+
+  @return HMAC set key function
+**/
+HMAC_SET_KEY
+GetSpdmHmacSetKeyFunc (
+  IN   UINT32                       BaseHashAlgo
+  )
+{
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return HmacSha256SetKey;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return HmacSha384SetKey;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return HmacSha512SetKey;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+    ASSERT (FALSE);
+    break;
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Return HMAC duplicate function, based upon the negotiated HMAC algorithm.
+
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
+
+  @return HMAC duplicate function
+**/
+HMAC_DUPLICATE
+GetSpdmHmacDuplicateFunc (
+  IN   UINT32                       BaseHashAlgo
+  )
+{
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return HmacSha256Duplicate;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return HmacSha384Duplicate;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return HmacSha512Duplicate;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+    ASSERT (FALSE);
+    break;
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Return HMAC update function, based upon the negotiated HMAC algorithm.
+
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
+
+  @return HMAC update function
+**/
+HMAC_UPDATE
+GetSpdmHmacUpdateFunc (
+  IN   UINT32                       BaseHashAlgo
+  )
+{
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return HmacSha256Update;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return HmacSha384Update;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return HmacSha512Update;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+    ASSERT (FALSE);
+    break;
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Return HMAC final function, based upon the negotiated HMAC algorithm.
+
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
+
+  @return HMAC final function
+**/
+HMAC_FINAL
+GetSpdmHmacFinalFunc (
+  IN   UINT32                       BaseHashAlgo
+  )
+{
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return HmacSha256Final;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return HmacSha384Final;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    return HmacSha512Final;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+    ASSERT (FALSE);
+    break;
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Allocates one HMAC context and sets the user-supplied key,
+  based upon the negotiated HMAC algorithm.
+
+  The keyed context can be duplicated for each HMAC computation with the same key,
+  so that the key setup is only done once.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Key                          Pointer to the user-supplied key.
+  @param  KeySize                      Key size in bytes.
+
+  @return  Pointer to the keyed HMAC context.
+           If the allocations or the key setup fails, NULL is returned.
+**/
+VOID *
+EFIAPI
+SpdmHmacNewWithKey (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST UINT8                  *Key,
+  IN   UINTN                        KeySize
+  )
+{
+  HMAC_NEW       NewFunction;
+  HMAC_FREE      FreeFunction;
+  HMAC_SET_KEY   SetKeyFunction;
+  VOID           *HmacContext;
+
+  NewFunction = GetSpdmHmacNewFunc (BaseHashAlgo);
+  FreeFunction = GetSpdmHmacFreeFunc (BaseHashAlgo);
+  SetKeyFunction = GetSpdmHmacSetKeyFunc (BaseHashAlgo);
+  if ((NewFunction == NULL) || (FreeFunction == NULL) || (SetKeyFunction == NULL)) {
+    return NULL;
+  }
+  HmacContext = NewFunction ();
+  if (HmacContext == NULL) {
+    return NULL;
+  }
+  if (!SetKeyFunction (HmacContext, Key, KeySize)) {
+    FreeFunction (HmacContext);
+    return NULL;
+  }
+  return HmacContext;
+}
+
+/**
+  Release the specified HMAC context,
+  based upon the negotiated HMAC algorithm.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HmacContext                  Pointer to the HMAC context to be released.
+**/
+VOID
+EFIAPI
+SpdmHmacFree (
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *HmacContext
+  )
+{
+  HMAC_FREE   FreeFunction;
+
+  if (HmacContext == NULL) {
+    return ;
+  }
+  FreeFunction = GetSpdmHmacFreeFunc (BaseHashAlgo);
+  if (FreeFunction == NULL) {
+    return ;
+  }
+  FreeFunction (HmacContext);
+}
+
+/**
+  Computes the HMAC of a input data buffer with a keyed HMAC context,
+  based upon the negotiated HMAC algorithm.
+
+  The keyed HMAC context is duplicated, so it is not changed and can be used again.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  HmacContext                  Pointer to the keyed HMAC context, returned by SpdmHmacNewWithKey.
+  @param  Data                         Pointer to the buffer containing the data to be HMACed.
+  @param  DataSize                     Size of Data buffer in bytes.
+  @param  HmacValue                    Pointer to a buffer that receives the HMAC value.
+
+  @retval TRUE   HMAC computation succeeded.
+  @retval FALSE  HMAC computation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHmacAllWithContext (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST VOID                   *HmacContext,
+  IN   CONST VOID                   *Data,
+  IN   UINTN                        DataSize,
+  OUT  UINT8                        *HmacValue
+  )
+{
+  HMAC_NEW         NewFunction;
+  HMAC_FREE        FreeFunction;
+  HMAC_DUPLICATE   DuplicateFunction;
+  HMAC_UPDATE      UpdateFunction;
+  HMAC_FINAL       FinalFunction;
+  VOID             *NewHmacContext;
+  BOOLEAN          Result;
+  UINT64           StatsStart;
+
+  NewFunction = GetSpdmHmacNewFunc (BaseHashAlgo);
+  FreeFunction = GetSpdmHmacFreeFunc (BaseHashAlgo);
+  DuplicateFunction = GetSpdmHmacDuplicateFunc (BaseHashAlgo);
+  UpdateFunction = GetSpdmHmacUpdateFunc (BaseHashAlgo);
+  FinalFunction = GetSpdmHmacFinalFunc (BaseHashAlgo);
+  if ((NewFunction == NULL) || (FreeFunction == NULL) || (DuplicateFunction == NULL) ||
+      (UpdateFunction == NULL) || (FinalFunction == NULL)) {
+    return FALSE;
+  }
+
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationHmac, DataSize);
+  NewHmacContext = NewFunction ();
+  if (NewHmacContext == NULL) {
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationHmac, StatsStart, FALSE);
+  }
+  Result = DuplicateFunction (HmacContext, NewHmacContext);
+  if (Result) {
+    Result = UpdateFunction (NewHmacContext, Data, DataSize);
+  }
+  if (Result) {
+    Result = FinalFunction (NewHmacContext, HmacValue);
+  }
+  FreeFunction (NewHmacContext);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationHmac, StatsStart, Result);
+}
+
+/**
+  Derive HMAC-based Expand Key Derivation Function (HKDF) Expand with a keyed HMAC context,
+  based upon the negotiated HKDF algorithm.
+
+  The HMAC context must be keyed with the PRK. It is duplicated for every output block,
+  so it is not changed and can be used again for the next label.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  PrkHmacContext               Pointer to the HMAC context keyed with the PRK, returned by SpdmHmacNewWithKey.
+  @param  Info                         Pointer to the application specific info.
+  @param  InfoSize                     Info size in bytes.
+  @param  Out                          Pointer to buffer to receive hkdf value.
+  @param  OutSize                      Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHkdfExpandWithContext (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST VOID                   *PrkHmacContext,
+  IN   CONST UINT8                  *Info,
+  IN   UINTN                        InfoSize,
+  OUT  UINT8                        *Out,
+  IN   UINTN                        OutSize
+  )
+{
+  HMAC_NEW         NewFunction;
+  HMAC_FREE        FreeFunction;
+  HMAC_DUPLICATE   DuplicateFunction;
+  HMAC_UPDATE      UpdateFunction;
+  HMAC_FINAL       FinalFunction;
+  VOID             *NewHmacContext;
+  UINT8            Block[MAX_HASH_SIZE];
+  UINTN            HashSize;
+  UINTN            Offset;
+  UINTN            CopySize;
+  UINT8            Counter;
+  BOOLEAN          Result;
+  UINT64           StatsStart;
+
+  HashSize = GetSpdmHashSize (BaseHashAlgo);
+  //
+  // RFC 5869: OutSize must not exceed 255 * HashLen.
+  //
+  if ((HashSize == 0) || (OutSize > 255 * HashSize)) {
+    return FALSE;
+  }
+
+  NewFunction = GetSpdmHmacNewFunc (BaseHashAlgo);
+  FreeFunction = GetSpdmHmacFreeFunc (BaseHashAlgo);
+  DuplicateFunction = GetSpdmHmacDuplicateFunc (BaseHashAlgo);
+  UpdateFunction = GetSpdmHmacUpdateFunc (BaseHashAlgo);
+  FinalFunction = GetSpdmHmacFinalFunc (BaseHashAlgo);
+  if ((NewFunction == NULL) || (FreeFunction == NULL) || (DuplicateFunction == NULL) ||
+      (UpdateFunction == NULL) || (FinalFunction == NULL)) {
+    return FALSE;
+  }
+
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationHkdfExpand, OutSize);
+  NewHmacContext = NewFunction ();
+  if (NewHmacContext == NULL) {
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationHkdfExpand, StatsStart, FALSE);
+  }
+
+  //
+  // T(N) = HMAC (PRK, T(N-1) | Info | N)
+  //
+  Result = TRUE;
+  for (Offset = 0, Counter = 1; Result && (Offset < OutSize); Offset += CopySize, Counter++) {
+    Result = DuplicateFunction (PrkHmacContext, NewHmacContext);
+    if (Result && (Offset != 0)) {
+      Result = UpdateFunction (NewHmacContext, Block, HashSize);
+    }
+    if (Result) {
+      Result = UpdateFunction (NewHmacContext, Info, InfoSize);
+    }
+    if (Result) {
+      Result = UpdateFunction (NewHmacContext, &Counter, sizeof(Counter));
+    }
+    if (Result) {
+      Result = FinalFunction (NewHmacContext, Block);
+    }
+    CopySize = OutSize - Offset;
+    if (CopySize > HashSize) {
+      CopySize = HashSize;
+    }
+    if (Result) {
+      CopyMem (Out + Offset, Block, CopySize);
+    }
+  }
+  ZeroMem (Block, sizeof(Block));
+  FreeFunction (NewHmacContext);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationHkdfExpand, StatsStart, Result);
+}
+
+/**
+  Derive several HMAC-based Expand Key Derivation Function (HKDF) Expand outputs from one PRK,
+  based upon the negotiated HKDF algorithm.
+
+  The PRK is set up as HMAC key once and shared by all labels.
+
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Prk                          Pointer to the user-supplied key.
+  @param  PrkSize                      Key size in bytes.
+  @param  Label                        Array of LabelCount labels, each with its info and output buffer.
+  @param  LabelCount                   Number of labels.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmHkdfExpandMulti (
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST UINT8                  *Prk,
+  IN   UINTN                        PrkSize,
+  IN   CONST SPDM_HKDF_EXPAND_LABEL *Label,
+  IN   UINTN                        LabelCount
+  )
+{
+  VOID     *PrkHmacContext;
+  UINTN    Index;
+  BOOLEAN  Result;
+
+  PrkHmacContext = SpdmHmacNewWithKey (BaseHashAlgo, Prk, PrkSize);
+  if (PrkHmacContext == NULL) {
+    return FALSE;
+  }
+
+  Result = TRUE;
+  for (Index = 0; Result && (Index < LabelCount); Index++) {
+    Result = SpdmHkdfExpandWithContext (BaseHashAlgo, PrkHmacContext, Label[Index].Info, Label[Index].InfoSize, Label[Index].Out, Label[Index].OutSize);
+  }
+  SpdmHmacFree (BaseHashAlgo, PrkHmacContext);
+  return Result;
+}
+
+/**
+  This function returns the SPDM asymmetric algorithm size.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+
+  @return SPDM asymmetric algorithm size.
+**/
+UINT32
+EFIAPI
+GetSpdmAsymSignatureSize (
+  IN   UINT32                       BaseAsymAlgo
+  )
+{
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
+    return 256;
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
+    return 384;
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
+    return 512;
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+    return 32 * 2;
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+    return 48 * 2;
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+    return 66 * 2;
+  }
+  return 0;
+}
+
+/**
+  Return asymmetric GET_PUBLIC_KEY_FROM_X509 function, based upon the negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+
+  @return asymmetric GET_PUBLIC_KEY_FROM_X509 function
+**/
+ASYM_GET_PUBLIC_KEY_FROM_X509
+GetSpdmAsymGetPublicKeyFromX509 (
+  IN   UINT32                       BaseAsymAlgo
+  )
+{
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
+#if (OPENSPDM_RSA_SSA_SUPPORT == 1) || (OPENSPDM_RSA_PSS_SUPPORT == 1)
+    return RsaGetPublicKeyFromX509;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+#if OPENSPDM_ECDSA_SUPPORT == 1
+    return EcGetPublicKeyFromX509;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Retrieve the asymmetric Public Key from one DER-encoded X509 certificate,
+  based upon negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  Cert                         Pointer to the DER-encoded X509 certificate.
+  @param  CertSize                     Size of the X509 certificate in bytes.
+  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
+                                       Use SpdmAsymFree() function to free the resource.
+
+  @retval  TRUE   Public Key was retrieved successfully.
+  @retval  FALSE  Fail to retrieve public key from X509 certificate.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymGetPublicKeyFromX509 (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   CONST UINT8                  *Cert,
+  IN   UINTN                        CertSize,
+  OUT  VOID                         **Context
+  )
+{
+  ASYM_GET_PUBLIC_KEY_FROM_X509   GetPublicKeyFromX509Function;
+  GetPublicKeyFromX509Function = GetSpdmAsymGetPublicKeyFromX509 (BaseAsymAlgo);
+  if (GetPublicKeyFromX509Function == NULL) {
+    return FALSE;
+  }
+  return GetPublicKeyFromX509Function (Cert, CertSize, Context);
+}
+
+/**
+  Return asymmetric GET_PUBLIC_KEY_FROM_DER function, based upon the negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+
+  @return asymmetric GET_PUBLIC_KEY_FROM_DER function
+**/
+ASYM_GET_PUBLIC_KEY_FROM_DER
+GetSpdmAsymGetPublicKeyFromDer (
+  IN   UINT32                       BaseAsymAlgo
+  )
+{
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
+#if (OPENSPDM_RSA_SSA_SUPPORT == 1) || (OPENSPDM_RSA_PSS_SUPPORT == 1)
+    return RsaGetPublicKeyFromDer;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+#if OPENSPDM_ECDSA_SUPPORT == 1
+    return EcGetPublicKeyFromDer;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Retrieve the asymmetric Public Key from one DER-encoded SubjectPublicKeyInfo,
+  based upon negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  DerData                      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param  DerSize                      Size of the DER data in bytes.
+  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
+                                       Use SpdmAsymFree() function to free the resource.
+
+  @retval  TRUE   Public Key was retrieved successfully.
+  @retval  FALSE  Fail to retrieve public key from the DER data.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymGetPublicKeyFromDer (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   CONST UINT8                  *DerData,
+  IN   UINTN                        DerSize,
+  OUT  VOID                         **Context
+  )
+{
+  ASYM_GET_PUBLIC_KEY_FROM_DER    GetPublicKeyFromDerFunction;
+  GetPublicKeyFromDerFunction = GetSpdmAsymGetPublicKeyFromDer (BaseAsymAlgo);
+  if (GetPublicKeyFromDerFunction == NULL) {
+    return FALSE;
+  }
+  return GetPublicKeyFromDerFunction (DerData, DerSize, Context);
+}
+
+/**
+  Return asymmetric free function, based upon the negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+
+  @return asymmetric free function
+**/
+ASYM_FREE
+GetSpdmAsymFree (
+  IN   UINT32                       BaseAsymAlgo
+  )
+{
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
+#if (OPENSPDM_RSA_SSA_SUPPORT == 1) || (OPENSPDM_RSA_PSS_SUPPORT == 1)
+    return RsaFree;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+#if OPENSPDM_ECDSA_SUPPORT == 1
+    return EcFree;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Release the specified asymmetric context,
+  based upon negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  Context                      Pointer to the asymmetric context to be released.
+**/
+VOID
+EFIAPI
+SpdmAsymFree (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   VOID                         *Context
+  )
+{
+  ASYM_FREE   FreeFunction;
+  FreeFunction = GetSpdmAsymFree (BaseAsymAlgo);
+  if (FreeFunction == NULL) {
+    return ;
+  }
+  FreeFunction (Context);
+}
+
+/**
+  Return if asymmetric function need message hash.
+
+  @param  BaseAsymAlgo               SPDM BaseAsymAlgo
+
+  @retval TRUE  asymmetric function need message hash
+  @retval FALSE asymmetric function need raw message
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymFuncNeedHash (
+  IN   UINT32                       BaseAsymAlgo
+  )
+{
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
+    return TRUE;
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+    return TRUE;
+  }
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+/**
+  Return asymmetric verify function, based upon the negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+
+  @return asymmetric verify function
+**/
+ASYM_VERIFY
+GetSpdmAsymVerify (
+  IN   UINT32                       BaseAsymAlgo
+  )
+{
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
+#if OPENSPDM_RSA_SSA_SUPPORT == 1
+    return RsaPkcs1VerifyWithNid;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
+#if OPENSPDM_RSA_PSS_SUPPORT == 1
+    return RsaPssVerify;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+#if OPENSPDM_ECDSA_SUPPORT == 1
+    return EcDsaVerify;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Verifies the asymmetric signature,
+  based upon negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature verification.
+  @param  Message                      Pointer to octet message to be checked (before hash).
+  @param  MessageSize                  Size of the message in bytes.
+  @param  Signature                    Pointer to asymmetric signature to be verified.
+  @param  SigSize                      Size of signature in bytes.
+
+  @retval  TRUE   Valid asymmetric signature.
+  @retval  FALSE  Invalid asymmetric signature or invalid asymmetric context.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymVerify (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *Context,
+  IN   CONST UINT8                  *Message,
+  IN   UINTN                        MessageSize,
+  IN   CONST UINT8                  *Signature,
+  IN   UINTN                        SigSize
+  )
+{
+  ASYM_VERIFY   VerifyFunction;
+  UINT64        StatsStart;
+  BOOLEAN       NeedHash;
+  UINT8         MessageHash[MAX_HASH_SIZE];
+  UINTN         HashSize;
+  BOOLEAN       Result;
+  UINTN         HashNid;
+
+  HashNid = GetSpdmHashNid (BaseHashAlgo);
+  NeedHash = SpdmAsymFuncNeedHash (BaseAsymAlgo);
+
+  VerifyFunction = GetSpdmAsymVerify (BaseAsymAlgo);
+  if (VerifyFunction == NULL) {
+    return FALSE;
+  }
+  if (NeedHash) {
+    HashSize = GetSpdmHashSize (BaseHashAlgo);
+    Result = SpdmHashAll (BaseHashAlgo, Message, MessageSize, MessageHash);
+    if (!Result) {
+      return FALSE;
+    }
+    StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymVerify, HashSize);
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymVerify, StatsStart, VerifyFunction (Context, HashNid, MessageHash, HashSize, Signature, SigSize));
+  } else {
+    StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymVerify, MessageSize);
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymVerify, StatsStart, VerifyFunction (Context, HashNid, Message, MessageSize, Signature, SigSize));
+  }
+}
+
+/**
+  Verifies the asymmetric signature over a message hash,
+  based upon negotiated asymmetric algorithm.
+
+  This is only valid for the asymmetric algorithms which sign a hash of the message.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature verification.
+  @param  MessageHash                  Pointer to the hash of the message to be checked.
+  @param  Signature                    Pointer to asymmetric signature to be verified.
+  @param  SigSize                      Size of signature in bytes.
+
+  @retval  TRUE   Valid asymmetric signature.
+  @retval  FALSE  Invalid asymmetric signature or invalid asymmetric context.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymVerifyHash (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *Context,
+  IN   CONST UINT8                  *MessageHash,
+  IN   CONST UINT8                  *Signature,
+  IN   UINTN                        SigSize
+  )
+{
+  ASYM_VERIFY   VerifyFunction;
+  UINT64        StatsStart;
+
+  if (!SpdmAsymFuncNeedHash (BaseAsymAlgo)) {
+    ASSERT (FALSE);
+    return FALSE;
+  }
+
+  VerifyFunction = GetSpdmAsymVerify (BaseAsymAlgo);
+  if (VerifyFunction == NULL) {
+    return FALSE;
+  }
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymVerify, GetSpdmHashSize (BaseHashAlgo));
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymVerify, StatsStart, VerifyFunction (Context, GetSpdmHashNid (BaseHashAlgo), MessageHash, GetSpdmHashSize (BaseHashAlgo), Signature, SigSize));
+}
+
+/**
+  Return asymmetric prepare public key function, based upon the negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+
+  @return asymmetric prepare public key function, or NULL if the algorithm has no prepared public key.
+**/
+ASYM_PREPARE_PUBLIC_KEY
+GetSpdmAsymPreparePublicKey (
+  IN   UINT32                       BaseAsymAlgo
+  )
+{
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+#if OPENSPDM_ECDSA_SUPPORT == 1
+    return EcDsaPreparePublicKey;
+#else
+    break;
+#endif
+  }
+  //
+  // RSA verification is one modular exponentiation with a small public exponent.
+  // There is nothing worth precomputing.
+  //
+  return NULL;
+}
+
+/**
+  Prepares a public key for repeated signature verification,
+  based upon negotiated asymmetric algorithm.
+
+  The prepared public key holds precomputed values of the public key, so that
+  SpdmAsymVerifyHashPrepared() is faster than SpdmAsymVerifyHash().
+  It does not refer to Context, which may be released before the prepared public key.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  Context                      Pointer to asymmetric context holding the public key.
+
+  @return Pointer to the prepared public key. Use SpdmAsymFreePreparedPublicKey() function to free the resource.
+  @retval NULL  The algorithm has no prepared public key, or the public key cannot be prepared.
+**/
+VOID *
+EFIAPI
+SpdmAsymPreparePublicKey (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   VOID                         *Context
+  )
+{
+  ASYM_PREPARE_PUBLIC_KEY   PrepareFunction;
+
+  PrepareFunction = GetSpdmAsymPreparePublicKey (BaseAsymAlgo);
+  if (PrepareFunction == NULL) {
+    return NULL;
+  }
+  return PrepareFunction (Context);
+}
+
+/**
+  Release the specified prepared public key,
+  based upon negotiated asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  PreparedKey                  Pointer to the prepared public key to be released.
+**/
+VOID
+EFIAPI
+SpdmAsymFreePreparedPublicKey (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   VOID                         *PreparedKey
+  )
+{
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+#if OPENSPDM_ECDSA_SUPPORT == 1
+    EcDsaFreePreparedPublicKey (PreparedKey);
+    return ;
+#else
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+}
+
+/**
+  Verifies the asymmetric signature over a message hash with a prepared public key,
+  based upon negotiated asymmetric algorithm.
+
+  The result is the same as SpdmAsymVerifyHash() with the context the public key is prepared from.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  PreparedKey                  Pointer to the prepared public key for signature verification.
+  @param  MessageHash                  Pointer to the hash of the message to be checked.
+  @param  Signature                    Pointer to asymmetric signature to be verified.
+  @param  SigSize                      Size of signature in bytes.
+
+  @retval  TRUE   Valid asymmetric signature.
+  @retval  FALSE  Invalid asymmetric signature or invalid prepared public key.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymVerifyHashPrepared (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *PreparedKey,
+  IN   CONST UINT8                  *MessageHash,
+  IN   CONST UINT8                  *Signature,
+  IN   UINTN                        SigSize
+  )
+{
+  UINT64   StatsStart;
+
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+#if OPENSPDM_ECDSA_SUPPORT == 1
+    StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymVerify, GetSpdmHashSize (BaseHashAlgo));
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymVerify, StatsStart, EcDsaVerifyPrepared (PreparedKey, GetSpdmHashNid (BaseHashAlgo), MessageHash, GetSpdmHashSize (BaseHashAlgo), Signature, SigSize));
+#else
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return FALSE;
+}
+
+//
+// The number of message hashes computed at once by SpdmAsymVerifyBatch.
+//
+#define SPDM_ASYM_VERIFY_BATCH_SIZE  8
+
+/**
+  Return multi-buffer hash function, based upon the negotiated hash algorithm.
+
+  @param  BaseHashAlgo                  SPDM BaseHashAlgo
+
+  @return multi-buffer hash function, or NULL if the algorithm has none.
+**/
+HASH_ALL_MULTI
+GetSpdmHashMultiFunc (
+  IN      UINT32       BaseHashAlgo
+  )
+{
+  switch (BaseHashAlgo) {
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    return Sha256HashAllMulti;
+#else
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    return Sha384HashAllMulti;
+#else
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256:
+#if OPENSPDM_SHA3_256_SUPPORT == 1
+    return Sha3_256HashAllMulti;
+#else
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384:
+#if OPENSPDM_SHA3_384_SUPPORT == 1
+    return Sha3_384HashAllMulti;
+#else
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_512:
+#if OPENSPDM_SHA3_512_SUPPORT == 1
+    return Sha3_512HashAllMulti;
+#else
+    break;
+#endif
+  }
+  return NULL;
+}
+
+/**
+  Verifies several asymmetric signatures, based upon negotiated asymmetric algorithm.
+
+  The result is the same as calling SpdmAsymVerify() on each item, but the messages
+  of the algorithms which sign a hash are hashed several at once by the crypto backend.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Item                         Array of Count signatures to be verified.
+  @param  Count                        Number of signatures.
+  @param  Result                       Array of Count booleans that receive the result of each signature.
+                                       If it is NULL, the verification stops at the first invalid signature.
+
+  @retval  TRUE   All signatures are valid.
+  @retval  FALSE  At least one signature is invalid, or the messages cannot be hashed.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymVerifyBatch (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   UINT32                       BaseHashAlgo,
+  IN   CONST SPDM_ASYM_VERIFY_ITEM  *Item,
+  IN   UINTN                        Count,
+  OUT  BOOLEAN                      *Result OPTIONAL
+  )
+{
+  ASYM_VERIFY         VerifyFunction;
+  HASH_ALL_MULTI      HashMultiFunction;
+  CRYPT_DATA_SEGMENT  Data[SPDM_ASYM_VERIFY_BATCH_SIZE];
+  UINT8               MessageHash[SPDM_ASYM_VERIFY_BATCH_SIZE][MAX_HASH_SIZE];
+  UINT8               *HashValue[SPDM_ASYM_VERIFY_BATCH_SIZE];
+  UINTN               HashSize;
+  UINTN               HashNid;
+  UINTN               Index;
+  UINTN               BatchIndex;
+  UINTN               BatchCount;
+  BOOLEAN             Valid;
+  BOOLEAN             AllValid;
+  UINT64              StatsStart;
+
+  if (!SpdmAsymFuncNeedHash (BaseAsymAlgo)) {
+    HashMultiFunction = NULL;
+  } else {
+    HashMultiFunction = GetSpdmHashMultiFunc (BaseHashAlgo);
+  }
+  if (HashMultiFunction == NULL) {
+    AllValid = TRUE;
+    for (Index = 0; Index < Count; Index++) {
+      Valid = SpdmAsymVerify (BaseAsymAlgo, BaseHashAlgo, Item[Index].Context, Item[Index].Message, Item[Index].MessageSize, Item[Index].Signature, Item[Index].SigSize);
+      if (Result != NULL) {
+        Result[Index] = Valid;
+      } else if (!Valid) {
+        return FALSE;
+      }
+      AllValid = AllValid && Valid;
+    }
+    return AllValid;
+  }
+
+  VerifyFunction = GetSpdmAsymVerify (BaseAsymAlgo);
+  if (VerifyFunction == NULL) {
+    return FALSE;
+  }
+  HashNid = GetSpdmHashNid (BaseHashAlgo);
+  HashSize = GetSpdmHashSize (BaseHashAlgo);
+  for (BatchIndex = 0; BatchIndex < SPDM_ASYM_VERIFY_BATCH_SIZE; BatchIndex++) {
+    HashValue[BatchIndex] = MessageHash[BatchIndex];
+  }
+
+  AllValid = TRUE;
+  for (Index = 0; Index < Count; Index += BatchCount) {
+    BatchCount = MIN (Count - Index, SPDM_ASYM_VERIFY_BATCH_SIZE);
+    for (BatchIndex = 0; BatchIndex < BatchCount; BatchIndex++) {
+      Data[BatchIndex].Buffer = (VOID *)Item[Index + BatchIndex].Message;
+      Data[BatchIndex].Size = Item[Index + BatchIndex].MessageSize;
+    }
+    if (!HashMultiFunction (BatchCount, Data, HashValue)) {
+      return FALSE;
+    }
+    for (BatchIndex = 0; BatchIndex < BatchCount; BatchIndex++) {
+      StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymVerify, HashSize);
+      Valid = SPDM_CRYPTO_STATS_END (
+                SpdmCryptoOperationAsymVerify,
+                StatsStart,
+                VerifyFunction (Item[Index + BatchIndex].Context, HashNid, MessageHash[BatchIndex], HashSize, Item[Index + BatchIndex].Signature, Item[Index + BatchIndex].SigSize)
+                );
+      if (Result != NULL) {
+        Result[Index + BatchIndex] = Valid;
+      } else if (!Valid) {
+        return FALSE;
+      }
+      AllValid = AllValid && Valid;
+    }
+  }
+  return AllValid;
+}
+
+/**
+  Return asymmetric GET_PRIVATE_KEY_FROM_PEM function, based upon the asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+
+  @return asymmetric GET_PRIVATE_KEY_FROM_PEM function
+**/
+ASYM_GET_PRIVATE_KEY_FROM_PEM
+GetSpdmAsymGetPrivateKeyFromPem (
+  IN   UINT32                       BaseAsymAlgo
+  )
+{
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
+#if (OPENSPDM_RSA_SSA_SUPPORT == 1) || (OPENSPDM_RSA_PSS_SUPPORT == 1)
+    return RsaGetPrivateKeyFromPem;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+#if OPENSPDM_ECDSA_SUPPORT == 1
+    return EcGetPrivateKeyFromPem;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Retrieve the Private Key from the password-protected PEM key data.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  PemData                      Pointer to the PEM-encoded key data to be retrieved.
+  @param  PemSize                      Size of the PEM key data in bytes.
+  @param  Password                     NULL-terminated passphrase used for encrypted PEM key data.
+  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved private key component.
+                                       Use SpdmAsymFree() function to free the resource.
+
+  @retval  TRUE   Private Key was retrieved successfully.
+  @retval  FALSE  Invalid PEM key data or incorrect password.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymGetPrivateKeyFromPem (
+  IN   UINT32                       BaseAsymAlgo,
+  IN   CONST UINT8                  *PemData,
+  IN   UINTN                        PemSize,
+  IN   CONST CHAR8                  *Password,
+  OUT  VOID                         **Context
+  )
+{
+  ASYM_GET_PRIVATE_KEY_FROM_PEM   AsymGetPrivateKeyFromPem;
+  AsymGetPrivateKeyFromPem = GetSpdmAsymGetPrivateKeyFromPem (BaseAsymAlgo);
+  if (AsymGetPrivateKeyFromPem == NULL) {
+    return FALSE;
+  }
+  return AsymGetPrivateKeyFromPem (PemData, PemSize, Password, Context);
+}
+
+/**
+  Return asymmetric sign function, based upon the asymmetric algorithm.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+
+  @return asymmetric sign function
+**/
+ASYM_SIGN
+GetSpdmAsymSign (
+  IN   UINT32                       BaseAsymAlgo
+  )
+{
+  switch (BaseAsymAlgo) {
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096:
+#if OPENSPDM_RSA_SSA_SUPPORT == 1
+    return RsaPkcs1SignWithNid;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_4096:
+#if OPENSPDM_RSA_PSS_SUPPORT == 1
+    return RsaPssSign;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384:
+  case SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521:
+#if OPENSPDM_ECDSA_SUPPORT == 1
+    return EcDsaSign;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Carries out the signature generation.
+
+  If the Signature buffer is too small to hold the contents of signature, FALSE
+  is returned and SigSize is set to the required buffer size to obtain the signature.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature generation.
+  @param  Message                      Pointer to octet message to be signed (before hash).
+  @param  MessageSize                  Size of the message in bytes.
+  @param  Signature                    Pointer to buffer to receive signature.
+  @param  SigSize                      On input, the size of Signature buffer in bytes.
+                                       On output, the size of data returned in Signature buffer in bytes.
+
+  @retval  TRUE   Signature successfully generated.
+  @retval  FALSE  Signature generation failed.
+  @retval  FALSE  SigSize is too small.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymSign (
+  IN      UINT32                       BaseAsymAlgo,
+  IN      UINT32                       BaseHashAlgo,
+  IN      VOID                         *Context,
+  IN      CONST UINT8                  *Message,
+  IN      UINTN                        MessageSize,
+  OUT     UINT8                        *Signature,
+  IN OUT  UINTN                        *SigSize
+  )
+{
+  ASYM_SIGN     AsymSign;
+  UINT64        StatsStart;
+  BOOLEAN       NeedHash;
+  UINT8         MessageHash[MAX_HASH_SIZE];
+  UINTN         HashSize;
+  BOOLEAN       Result;
+  UINTN         HashNid;
+
+  HashNid = GetSpdmHashNid (BaseHashAlgo);
+  NeedHash = SpdmAsymFuncNeedHash (BaseAsymAlgo);
+
+  AsymSign = GetSpdmAsymSign (BaseAsymAlgo);
+  if (AsymSign == NULL) {
+    return FALSE;
+  }
+  if (NeedHash) {
+    HashSize = GetSpdmHashSize (BaseHashAlgo);
+    Result = SpdmHashAll (BaseHashAlgo, Message, MessageSize, MessageHash);
+    if (!Result) {
+      return FALSE;
+    }
+    StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymSign, HashSize);
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymSign, StatsStart, AsymSign (Context, HashNid, MessageHash, HashSize, Signature, SigSize));
+  } else {
+    StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymSign, MessageSize);
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymSign, StatsStart, AsymSign (Context, HashNid, Message, MessageSize, Signature, SigSize));
+  }
+}
+
+/**
+  Carries out the signature generation over a message hash.
+
+  This is only valid for the asymmetric algorithms which sign a hash of the message.
+  If the Signature buffer is too small to hold the contents of signature, FALSE
+  is returned and SigSize is set to the required buffer size to obtain the signature.
+
+  @param  BaseAsymAlgo                 SPDM BaseAsymAlgo
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature generation.
+  @param  MessageHash                  Pointer to the hash of the message to be signed.
+  @param  Signature                    Pointer to buffer to receive signature.
+  @param  SigSize                      On input, the size of Signature buffer in bytes.
+                                       On output, the size of data returned in Signature buffer in bytes.
+
+  @retval  TRUE   Signature successfully generated.
+  @retval  FALSE  Signature generation failed.
+  @retval  FALSE  SigSize is too small.
+**/
+BOOLEAN
+EFIAPI
+SpdmAsymSignHash (
+  IN      UINT32                       BaseAsymAlgo,
+  IN      UINT32                       BaseHashAlgo,
+  IN      VOID                         *Context,
+  IN      CONST UINT8                  *MessageHash,
+  OUT     UINT8                        *Signature,
+  IN OUT  UINTN                        *SigSize
+  )
+{
+  ASYM_SIGN     AsymSign;
+  UINT64        StatsStart;
+
+  if (!SpdmAsymFuncNeedHash (BaseAsymAlgo)) {
+    ASSERT (FALSE);
+    return FALSE;
+  }
+
+  AsymSign = GetSpdmAsymSign (BaseAsymAlgo);
+  if (AsymSign == NULL) {
+    return FALSE;
+  }
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymSign, GetSpdmHashSize (BaseHashAlgo));
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymSign, StatsStart, AsymSign (Context, GetSpdmHashNid (BaseHashAlgo), MessageHash, GetSpdmHashSize (BaseHashAlgo), Signature, SigSize));
+}
+
+/**
+  This function returns the SPDM requester asymmetric algorithm size.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+
+  @return SPDM requester asymmetric algorithm size.
+**/
+UINT32
+EFIAPI
+GetSpdmReqAsymSignatureSize (
+  IN   UINT16                       ReqBaseAsymAlg
+  )
+{
+  return GetSpdmAsymSignatureSize (ReqBaseAsymAlg);
+}
+
+/**
+  Return requester asymmetric GET_PUBLIC_KEY_FROM_X509 function, based upon the negotiated requester asymmetric algorithm.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+
+  @return requester asymmetric GET_PUBLIC_KEY_FROM_X509 function
+**/
+ASYM_GET_PUBLIC_KEY_FROM_X509
+GetSpdmReqAsymGetPublicKeyFromX509 (
+  IN   UINT16                       ReqBaseAsymAlg
+  )
+{
+  return GetSpdmAsymGetPublicKeyFromX509 (ReqBaseAsymAlg);
+}
+
+/**
+  Retrieve the asymmetric Public Key from one DER-encoded X509 certificate,
+  based upon negotiated requester asymmetric algorithm.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  Cert                         Pointer to the DER-encoded X509 certificate.
+  @param  CertSize                     Size of the X509 certificate in bytes.
+  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
+                                       Use SpdmAsymFree() function to free the resource.
+
+  @retval  TRUE   Public Key was retrieved successfully.
+  @retval  FALSE  Fail to retrieve public key from X509 certificate.
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymGetPublicKeyFromX509 (
+  IN   UINT16                       ReqBaseAsymAlg,
+  IN   CONST UINT8                  *Cert,
+  IN   UINTN                        CertSize,
+  OUT  VOID                         **Context
+  )
+{
+  ASYM_GET_PUBLIC_KEY_FROM_X509   GetPublicKeyFromX509Function;
+  GetPublicKeyFromX509Function = GetSpdmReqAsymGetPublicKeyFromX509 (ReqBaseAsymAlg);
+  if (GetPublicKeyFromX509Function == NULL) {
+    return FALSE;
+  }
+  return GetPublicKeyFromX509Function (Cert, CertSize, Context);
+}
+
+/**
+  Retrieve the asymmetric Public Key from one DER-encoded SubjectPublicKeyInfo,
+  based upon negotiated requester asymmetric algorithm.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  DerData                      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param  DerSize                      Size of the DER data in bytes.
+  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
+                                       Use SpdmAsymFree() function to free the resource.
+
+  @retval  TRUE   Public Key was retrieved successfully.
+  @retval  FALSE  Fail to retrieve public key from the DER data.
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymGetPublicKeyFromDer (
+  IN   UINT16                       ReqBaseAsymAlg,
+  IN   CONST UINT8                  *DerData,
+  IN   UINTN                        DerSize,
+  OUT  VOID                         **Context
+  )
+{
+  ASYM_GET_PUBLIC_KEY_FROM_DER    GetPublicKeyFromDerFunction;
+  GetPublicKeyFromDerFunction = GetSpdmAsymGetPublicKeyFromDer (ReqBaseAsymAlg);
+  if (GetPublicKeyFromDerFunction == NULL) {
+    return FALSE;
+  }
+  return GetPublicKeyFromDerFunction (DerData, DerSize, Context);
+}
+
+/**
+  Return requester asymmetric free function, based upon the negotiated requester asymmetric algorithm.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+
+  @return requester asymmetric free function
+**/
+ASYM_FREE
+GetSpdmReqAsymFree (
+  IN   UINT16                       ReqBaseAsymAlg
+  )
+{
+  return GetSpdmAsymFree (ReqBaseAsymAlg);
+}
+
+/**
+  Release the specified asymmetric context,
+  based upon negotiated requester asymmetric algorithm.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  Context                      Pointer to the asymmetric context to be released.
+**/
+VOID
+EFIAPI
+SpdmReqAsymFree (
+  IN   UINT16                       ReqBaseAsymAlg,
+  IN   VOID                         *Context
+  )
+{
+  ASYM_FREE   FreeFunction;
+  FreeFunction = GetSpdmReqAsymFree (ReqBaseAsymAlg);
+  if (FreeFunction == NULL) {
+    return ;
+  }
+  FreeFunction (Context);
+}
+
+/**
+  Return if requester asymmetric function need message hash.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+
+  @retval TRUE  requester asymmetric function need message hash
+  @retval FALSE requester asymmetric function need raw message
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymFuncNeedHash (
+  IN   UINT16                       ReqBaseAsymAlg
+  )
+{
+  return SpdmAsymFuncNeedHash (ReqBaseAsymAlg);
+}
+
+/**
+  Return requester asymmetric verify function, based upon the negotiated requester asymmetric algorithm.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+
+  @return requester asymmetric verify function
+**/
+ASYM_VERIFY
+GetSpdmReqAsymVerify (
+  IN   UINT16                       ReqBaseAsymAlg
+  )
+{
+  return GetSpdmAsymVerify (ReqBaseAsymAlg);
+}
+
+/**
+  Verifies the asymmetric signature,
+  based upon negotiated requester asymmetric algorithm.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature verification.
+  @param  Message                      Pointer to octet message to be checked (before hash).
+  @param  MessageSize                  Size of the message in bytes.
+  @param  Signature                    Pointer to asymmetric signature to be verified.
+  @param  SigSize                      Size of signature in bytes.
+
+  @retval  TRUE   Valid asymmetric signature.
+  @retval  FALSE  Invalid asymmetric signature or invalid asymmetric context.
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymVerify (
+  IN   UINT16                       ReqBaseAsymAlg,
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *Context,
+  IN   CONST UINT8                  *Message,
+  IN   UINTN                        MessageSize,
+  IN   CONST UINT8                  *Signature,
+  IN   UINTN                        SigSize
+  )
+{
+  ASYM_VERIFY   VerifyFunction;
+  UINT64        StatsStart;
+  BOOLEAN       NeedHash;
+  UINT8         MessageHash[MAX_HASH_SIZE];
+  UINTN         HashSize;
+  BOOLEAN       Result;
+  UINTN         HashNid;
+
+  HashNid = GetSpdmHashNid (BaseHashAlgo);
+  NeedHash = SpdmReqAsymFuncNeedHash (ReqBaseAsymAlg);
+
+  VerifyFunction = GetSpdmReqAsymVerify (ReqBaseAsymAlg);
+  if (VerifyFunction == NULL) {
+    return FALSE;
+  }
+  if (NeedHash) {
+    HashSize = GetSpdmHashSize (BaseHashAlgo);
+    Result = SpdmHashAll (BaseHashAlgo, Message, MessageSize, MessageHash);
+    if (!Result) {
+      return FALSE;
+    }
+    StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymVerify, HashSize);
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymVerify, StatsStart, VerifyFunction (Context, HashNid, MessageHash, HashSize, Signature, SigSize));
+  } else {
+    StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymVerify, MessageSize);
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymVerify, StatsStart, VerifyFunction (Context, HashNid, Message, MessageSize, Signature, SigSize));
+  }
+}
+
+/**
+  Verifies the asymmetric signature over a message hash,
+  based upon negotiated requester asymmetric algorithm.
+
+  This is only valid for the asymmetric algorithms which sign a hash of the message.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature verification.
+  @param  MessageHash                  Pointer to the hash of the message to be checked.
+  @param  Signature                    Pointer to asymmetric signature to be verified.
+  @param  SigSize                      Size of signature in bytes.
+
+  @retval  TRUE   Valid asymmetric signature.
+  @retval  FALSE  Invalid asymmetric signature or invalid asymmetric context.
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymVerifyHash (
+  IN   UINT16                       ReqBaseAsymAlg,
+  IN   UINT32                       BaseHashAlgo,
+  IN   VOID                         *Context,
+  IN   CONST UINT8                  *MessageHash,
+  IN   CONST UINT8                  *Signature,
+  IN   UINTN                        SigSize
+  )
+{
+  ASYM_VERIFY   VerifyFunction;
+  UINT64        StatsStart;
+
+  if (!SpdmReqAsymFuncNeedHash (ReqBaseAsymAlg)) {
+    ASSERT (FALSE);
+    return FALSE;
+  }
+
+  VerifyFunction = GetSpdmReqAsymVerify (ReqBaseAsymAlg);
+  if (VerifyFunction == NULL) {
+    return FALSE;
+  }
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymVerify, GetSpdmHashSize (BaseHashAlgo));
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymVerify, StatsStart, VerifyFunction (Context, GetSpdmHashNid (BaseHashAlgo), MessageHash, GetSpdmHashSize (BaseHashAlgo), Signature, SigSize));
+}
+
+/**
+  Return asymmetric GET_PRIVATE_KEY_FROM_PEM function, based upon the asymmetric algorithm.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+
+  @return asymmetric GET_PRIVATE_KEY_FROM_PEM function
+**/
+ASYM_GET_PRIVATE_KEY_FROM_PEM
+GetSpdmReqAsymGetPrivateKeyFromPem (
+  IN   UINT16                       ReqBaseAsymAlg
+  )
+{
+  return GetSpdmAsymGetPrivateKeyFromPem (ReqBaseAsymAlg);
+}
+
+/**
+  Retrieve the Private Key from the password-protected PEM key data.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  PemData                      Pointer to the PEM-encoded key data to be retrieved.
+  @param  PemSize                      Size of the PEM key data in bytes.
+  @param  Password                     NULL-terminated passphrase used for encrypted PEM key data.
+  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved private key component.
+                                       Use SpdmAsymFree() function to free the resource.
+
+  @retval  TRUE   Private Key was retrieved successfully.
+  @retval  FALSE  Invalid PEM key data or incorrect password.
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymGetPrivateKeyFromPem (
+  IN   UINT16                       ReqBaseAsymAlg,
+  IN   CONST UINT8                  *PemData,
+  IN   UINTN                        PemSize,
+  IN   CONST CHAR8                  *Password,
+  OUT  VOID                         **Context
+  )
+{
+  ASYM_GET_PRIVATE_KEY_FROM_PEM   AsymGetPrivateKeyFromPem;
+  AsymGetPrivateKeyFromPem = GetSpdmReqAsymGetPrivateKeyFromPem (ReqBaseAsymAlg);
+  if (AsymGetPrivateKeyFromPem == NULL) {
+    return FALSE;
+  }
+  return AsymGetPrivateKeyFromPem (PemData, PemSize, Password, Context);
+}
+
+/**
+  Return asymmetric sign function, based upon the asymmetric algorithm.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+
+  @return asymmetric sign function
+**/
+ASYM_SIGN
+GetSpdmReqAsymSign (
+  IN   UINT16                       ReqBaseAsymAlg
+  )
+{
+  return GetSpdmAsymSign (ReqBaseAsymAlg);
+}
+
+/**
+  Carries out the signature generation.
+
+  If the Signature buffer is too small to hold the contents of signature, FALSE
+  is returned and SigSize is set to the required buffer size to obtain the signature.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature generation.
+  @param  Message                      Pointer to octet message to be signed (before hash).
+  @param  MessageSize                  Size of the message in bytes.
+  @param  Signature                    Pointer to buffer to receive signature.
+  @param  SigSize                      On input, the size of Signature buffer in bytes.
+                                       On output, the size of data returned in Signature buffer in bytes.
+
+  @retval  TRUE   Signature successfully generated.
+  @retval  FALSE  Signature generation failed.
+  @retval  FALSE  SigSize is too small.
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymSign (
+  IN      UINT16                       ReqBaseAsymAlg,
+  IN      UINT32                       BaseHashAlgo,
+  IN      VOID                         *Context,
+  IN      CONST UINT8                  *Message,
+  IN      UINTN                        MessageSize,
+  OUT     UINT8                        *Signature,
+  IN OUT  UINTN                        *SigSize
+  )
+{
+  ASYM_SIGN     AsymSign;
+  UINT64        StatsStart;
+  BOOLEAN       NeedHash;
   UINT8         MessageHash[MAX_HASH_SIZE];
   UINTN         HashSize;
   BOOLEAN       Result;
   UINTN         HashNid;
 
-  HashNid = GetSpdmHashNid (BaseHashAlgo);
-  NeedHash = SpdmAsymFuncNeedHash (BaseAsymAlgo);
+  HashNid = GetSpdmHashNid (BaseHashAlgo);
+  NeedHash = SpdmReqAsymFuncNeedHash (ReqBaseAsymAlg);
+
+  AsymSign = GetSpdmReqAsymSign (ReqBaseAsymAlg);
+  if (AsymSign == NULL) {
+    return FALSE;
+  }
+  if (NeedHash) {
+    HashSize = GetSpdmHashSize (BaseHashAlgo);
+    Result = SpdmHashAll (BaseHashAlgo, Message, MessageSize, MessageHash);
+    if (!Result) {
+      return FALSE;
+    }
+    StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymSign, HashSize);
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymSign, StatsStart, AsymSign (Context, HashNid, MessageHash, HashSize, Signature, SigSize));
+  } else {
+    StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymSign, MessageSize);
+    return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymSign, StatsStart, AsymSign (Context, HashNid, Message, MessageSize, Signature, SigSize));
+  }
+}
+
+/**
+  Carries out the signature generation over a message hash.
+
+  This is only valid for the asymmetric algorithms which sign a hash of the message.
+  If the Signature buffer is too small to hold the contents of signature, FALSE
+  is returned and SigSize is set to the required buffer size to obtain the signature.
+
+  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  BaseHashAlgo                 SPDM BaseHashAlgo
+  @param  Context                      Pointer to asymmetric context for signature generation.
+  @param  MessageHash                  Pointer to the hash of the message to be signed.
+  @param  Signature                    Pointer to buffer to receive signature.
+  @param  SigSize                      On input, the size of Signature buffer in bytes.
+                                       On output, the size of data returned in Signature buffer in bytes.
+
+  @retval  TRUE   Signature successfully generated.
+  @retval  FALSE  Signature generation failed.
+  @retval  FALSE  SigSize is too small.
+**/
+BOOLEAN
+EFIAPI
+SpdmReqAsymSignHash (
+  IN      UINT16                       ReqBaseAsymAlg,
+  IN      UINT32                       BaseHashAlgo,
+  IN      VOID                         *Context,
+  IN      CONST UINT8                  *MessageHash,
+  OUT     UINT8                        *Signature,
+  IN OUT  UINTN                        *SigSize
+  )
+{
+  ASYM_SIGN     AsymSign;
+  UINT64        StatsStart;
+
+  if (!SpdmReqAsymFuncNeedHash (ReqBaseAsymAlg)) {
+    ASSERT (FALSE);
+    return FALSE;
+  }
+
+  AsymSign = GetSpdmReqAsymSign (ReqBaseAsymAlg);
+  if (AsymSign == NULL) {
+    return FALSE;
+  }
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAsymSign, GetSpdmHashSize (BaseHashAlgo));
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAsymSign, StatsStart, AsymSign (Context, GetSpdmHashNid (BaseHashAlgo), MessageHash, GetSpdmHashSize (BaseHashAlgo), Signature, SigSize));
+}
+
+/**
+  This function returns the SPDM DHE algorithm key size.
+
+  @param  DHENamedGroup                SPDM DHENamedGroup
+
+  @return SPDM DHE algorithm key size.
+**/
+UINT32
+EFIAPI
+GetSpdmDhePubKeySize (
+  IN   UINT16                       DHENamedGroup
+  )
+{
+  switch (DHENamedGroup) {
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
+    return 256;
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
+    return 384;
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
+    return 512;
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
+    return 32 * 2;
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
+    return 48 * 2;
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
+    return 66 * 2;
+  }
+  return 0;
+}
+
+/**
+  Return cipher ID, based upon the negotiated DHE algorithm.
+
+  @param  DHENamedGroup                SPDM DHENamedGroup
+
+  @return DHE cipher ID
+**/
+UINTN
+GetSpdmDheNid (
+  IN   UINT16                       DHENamedGroup
+  )
+{
+  switch (DHENamedGroup) {
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
+    return CRYPTO_NID_FFDHE2048;
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
+    return CRYPTO_NID_FFDHE3072;
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
+    return CRYPTO_NID_FFDHE4096;
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
+    return CRYPTO_NID_SECP256R1;
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
+    return CRYPTO_NID_SECP384R1;
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
+    return CRYPTO_NID_SECP521R1;
+  }
+  return CRYPTO_NID_NULL;
+}
+
+/**
+  Return DHE new by NID function, based upon the negotiated DHE algorithm.
+
+  @param  DHENamedGroup                SPDM DHENamedGroup
+
+  @return DHE new by NID function
+**/
+DHE_NEW_BY_NID
+GetSpdmDheNew (
+  IN   UINT16                       DHENamedGroup
+  )
+{
+  switch (DHENamedGroup) {
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
+#if OPENSPDM_FFDHE_SUPPORT == 1
+    return DhNewByNid;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
+#if OPENSPDM_ECDHE_SUPPORT == 1
+    return EcNewByNid;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Allocates and Initializes one Diffie-Hellman Ephemeral (DHE) Context for subsequent use,
+  based upon negotiated DHE algorithm.
+  
+  @param  DHENamedGroup                SPDM DHENamedGroup
+
+  @return  Pointer to the Diffie-Hellman Context that has been initialized.
+**/
+VOID *
+EFIAPI
+SpdmDheNew (
+  IN   UINT16                       DHENamedGroup
+  )
+{
+  DHE_NEW_BY_NID   NewFunction;
+  UINTN            Nid;
 
-  AsymSign = GetSpdmAsymSign (BaseAsymAlgo);
-  if (AsymSign == NULL) {
-    return FALSE;
+  NewFunction = GetSpdmDheNew (DHENamedGroup);
+  if (NewFunction == NULL) {
+    return NULL;
   }
-  if (NeedHash) {
-    HashSize = GetSpdmHashSize (BaseHashAlgo);
-    Result = SpdmHashAll (BaseHashAlgo, Message, MessageSize, MessageHash);
-    if (!Result) {
-      return FALSE;
-    }
-    return AsymSign (Context, HashNid, MessageHash, HashSize, Signature, SigSize);
-  } else {
-    return AsymSign (Context, HashNid, Message, MessageSize, Signature, SigSize);
+  Nid = GetSpdmDheNid (DHENamedGroup);
+  if (Nid == 0) {
+    return NULL;
   }
+  return NewFunction (Nid);
 }
 
 /**
-  This function returns the SPDM requester asymmetric algorithm size.
+  Return DHE free function, based upon the negotiated DHE algorithm.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  DHENamedGroup                SPDM DHENamedGroup
 
-  @return SPDM requester asymmetric algorithm size.
+  @return DHE free function
 **/
-UINT32
+DHE_FREE
+GetSpdmDheFree (
+  IN   UINT16                       DHENamedGroup
+  )
+{
+  switch (DHENamedGroup) {
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
+#if OPENSPDM_FFDHE_SUPPORT == 1
+    return DhFree;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
+#if OPENSPDM_ECDHE_SUPPORT == 1
+    return EcFree;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Release the specified DHE context,
+  based upon negotiated DHE algorithm.
+
+  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  Context                      Pointer to the DHE context to be released.
+**/
+VOID
 EFIAPI
-GetSpdmReqAsymSignatureSize (
-  IN   UINT16                       ReqBaseAsymAlg
+SpdmDheFree (
+  IN   UINT16                       DHENamedGroup,
+  IN   VOID                         *Context
   )
 {
-  return GetSpdmAsymSignatureSize (ReqBaseAsymAlg);
+  DHE_FREE   FreeFunction;
+  FreeFunction = GetSpdmDheFree (DHENamedGroup);
+  if (FreeFunction == NULL) {
+    return ;
+  }
+  FreeFunction (Context);
 }
 
 /**
-  Return requester asymmetric GET_PUBLIC_KEY_FROM_X509 function, based upon the negotiated requester asymmetric algorithm.
+  Return DHE generate key function, based upon the negotiated DHE algorithm.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  DHENamedGroup                SPDM DHENamedGroup
 
-  @return requester asymmetric GET_PUBLIC_KEY_FROM_X509 function
+  @return DHE generate key function
 **/
-ASYM_GET_PUBLIC_KEY_FROM_X509
-GetSpdmReqAsymGetPublicKeyFromX509 (
-  IN   UINT16                       ReqBaseAsymAlg
+DHE_GENERATE_KEY
+GetSpdmDheGenerateKey (
+  IN   UINT16                       DHENamedGroup
   )
 {
-  return GetSpdmAsymGetPublicKeyFromX509 (ReqBaseAsymAlg);
+  switch (DHENamedGroup) {
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
+#if OPENSPDM_FFDHE_SUPPORT == 1
+    return DhGenerateKey;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
+#if OPENSPDM_ECDHE_SUPPORT == 1
+    return EcGenerateKey;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
 }
 
 /**
-  Retrieve the asymmetric Public Key from one DER-encoded X509 certificate,
-  based upon negotiated requester asymmetric algorithm.
+  Generates DHE public key,
+  based upon negotiated DHE algorithm.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
-  @param  Cert                         Pointer to the DER-encoded X509 certificate.
-  @param  CertSize                     Size of the X509 certificate in bytes.
-  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved public key component.
-                                       Use SpdmAsymFree() function to free the resource.
+  This function generates random secret exponent, and computes the public key, which is
+  returned via parameter PublicKey and PublicKeySize. DH context is updated accordingly.
+  If the PublicKey buffer is too small to hold the public key, FALSE is returned and
+  PublicKeySize is set to the required buffer size to obtain the public key.
 
-  @retval  TRUE   Public Key was retrieved successfully.
-  @retval  FALSE  Fail to retrieve public key from X509 certificate.
+  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  Context                      Pointer to the DHE context.
+  @param  PublicKey                    Pointer to the buffer to receive generated public key.
+  @param  PublicKeySize                On input, the size of PublicKey buffer in bytes.
+                                       On output, the size of data returned in PublicKey buffer in bytes.
+
+  @retval TRUE   DHE public key generation succeeded.
+  @retval FALSE  DHE public key generation failed.
+  @retval FALSE  PublicKeySize is not large enough.
 **/
 BOOLEAN
 EFIAPI
-SpdmReqAsymGetPublicKeyFromX509 (
-  IN   UINT16                       ReqBaseAsymAlg,
-  IN   CONST UINT8                  *Cert,
-  IN   UINTN                        CertSize,
-  OUT  VOID                         **Context
+SpdmDheGenerateKey (
+  IN      UINT16                       DHENamedGroup,
+  IN OUT  VOID                         *Context,
+  OUT     UINT8                        *PublicKey,
+  IN OUT  UINTN                        *PublicKeySize
   )
 {
-  ASYM_GET_PUBLIC_KEY_FROM_X509   GetPublicKeyFromX509Function;
-  GetPublicKeyFromX509Function = GetSpdmReqAsymGetPublicKeyFromX509 (ReqBaseAsymAlg);
-  if (GetPublicKeyFromX509Function == NULL) {
+  DHE_GENERATE_KEY   GenerateKeyFunction;
+  UINT64             StatsStart;
+  GenerateKeyFunction = GetSpdmDheGenerateKey (DHENamedGroup);
+  if (GenerateKeyFunction == NULL) {
     return FALSE;
   }
-  return GetPublicKeyFromX509Function (Cert, CertSize, Context);
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationDheGenerateKey, 0);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationDheGenerateKey, StatsStart, GenerateKeyFunction (Context, PublicKey, PublicKeySize));
 }
 
 /**
-  Return requester asymmetric free function, based upon the negotiated requester asymmetric algorithm.
+  Return DHE compute key function, based upon the negotiated DHE algorithm.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  DHENamedGroup                SPDM DHENamedGroup
 
-  @return requester asymmetric free function
+  @return DHE compute key function
 **/
-ASYM_FREE
-GetSpdmReqAsymFree (
-  IN   UINT16                       ReqBaseAsymAlg
+DHE_COMPUTE_KEY
+GetSpdmDheComputeKey (
+  IN      UINT16                       DHENamedGroup
   )
 {
-  return GetSpdmAsymFree (ReqBaseAsymAlg);
+  switch (DHENamedGroup) {
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
+#if OPENSPDM_FFDHE_SUPPORT == 1
+    return DhComputeKey;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
+  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
+#if OPENSPDM_ECDHE_SUPPORT == 1
+    return EcComputeKey;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
 }
 
 /**
-  Release the specified asymmetric context,
-  based upon negotiated requester asymmetric algorithm.
+  Computes exchanged common key,
+  based upon negotiated DHE algorithm.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
-  @param  Context                      Pointer to the asymmetric context to be released.
+  Given peer's public key, this function computes the exchanged common key, based on its own
+  context including value of prime modulus and random secret exponent.
+
+  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  Context                      Pointer to the DHE context.
+  @param  PeerPublicKey                Pointer to the peer's public key.
+  @param  PeerPublicKeySize            Size of peer's public key in bytes.
+  @param  Key                          Pointer to the buffer to receive generated key.
+  @param  KeySize                      On input, the size of Key buffer in bytes.
+                                       On output, the size of data returned in Key buffer in bytes.
+
+  @retval TRUE   DHE exchanged key generation succeeded.
+  @retval FALSE  DHE exchanged key generation failed.
+  @retval FALSE  KeySize is not large enough.
 **/
-VOID
+BOOLEAN
 EFIAPI
-SpdmReqAsymFree (
-  IN   UINT16                       ReqBaseAsymAlg,
-  IN   VOID                         *Context
+SpdmDheComputeKey (
+  IN      UINT16                       DHENamedGroup,
+  IN OUT  VOID                         *Context,
+  IN      CONST UINT8                  *PeerPublic,
+  IN      UINTN                        PeerPublicSize,
+  OUT     UINT8                        *Key,
+  IN OUT  UINTN                        *KeySize
   )
 {
-  ASYM_FREE   FreeFunction;
-  FreeFunction = GetSpdmReqAsymFree (ReqBaseAsymAlg);
-  if (FreeFunction == NULL) {
-    return ;
+  DHE_COMPUTE_KEY   ComputeKeyFunction;
+  UINT64            StatsStart;
+  ComputeKeyFunction = GetSpdmDheComputeKey (DHENamedGroup);
+  if (ComputeKeyFunction == NULL) {
+    return FALSE;
+  }
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationDheComputeKey, PeerPublicSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationDheComputeKey, StatsStart, ComputeKeyFunction (Context, PeerPublic, PeerPublicSize, Key, KeySize));
+}
+
+/**
+  This function returns the SPDM AEAD algorithm key size.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+
+  @return SPDM AEAD algorithm key size.
+**/
+UINT32
+EFIAPI
+GetSpdmAeadKeySize (
+  IN   UINT16                       AEADCipherSuite
+  )
+{
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+    return 16;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+    return 32;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+    return 32;
   }
-  FreeFunction (Context);
+  return 0;
 }
 
 /**
-  Return if requester asymmetric function need message hash.
+  This function returns the SPDM AEAD algorithm iv size.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @retval TRUE  requester asymmetric function need message hash
-  @retval FALSE requester asymmetric function need raw message
+  @return SPDM AEAD algorithm iv size.
 **/
-BOOLEAN
-SpdmReqAsymFuncNeedHash (
-  IN   UINT16                       ReqBaseAsymAlg
+UINT32
+EFIAPI
+GetSpdmAeadIvSize (
+  IN   UINT16                       AEADCipherSuite
   )
 {
-  return SpdmAsymFuncNeedHash (ReqBaseAsymAlg);
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+    return 12;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+    return 12;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+    return 12;
+  }
+  return 0;
 }
 
 /**
-  Return requester asymmetric verify function, based upon the negotiated requester asymmetric algorithm.
+  This function returns the SPDM AEAD algorithm tag size.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return requester asymmetric verify function
+  @return SPDM AEAD algorithm tag size.
 **/
-ASYM_VERIFY
-GetSpdmReqAsymVerify (
-  IN   UINT16                       ReqBaseAsymAlg
+UINT32
+EFIAPI
+GetSpdmAeadTagSize (
+  IN   UINT16                       AEADCipherSuite
   )
 {
-  return GetSpdmAsymVerify (ReqBaseAsymAlg);
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+    return 16;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+    return 16;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+    return 16;
+  }
+  return 0;
 }
 
 /**
-  Verifies the asymmetric signature,
-  based upon negotiated requester asymmetric algorithm.
+  This function returns the SPDM AEAD algorithm block size.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
-  @param  BaseHashAlgo                 SPDM BaseHashAlgo
-  @param  Context                      Pointer to asymmetric context for signature verification.
-  @param  Message                      Pointer to octet message to be checked (before hash).
-  @param  MessageSize                  Size of the message in bytes.
-  @param  Signature                    Pointer to asymmetric signature to be verified.
-  @param  SigSize                      Size of signature in bytes.
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @retval  TRUE   Valid asymmetric signature.
-  @retval  FALSE  Invalid asymmetric signature or invalid asymmetric context.
+  @return SPDM AEAD algorithm block size.
 **/
-BOOLEAN
+UINT32
 EFIAPI
-SpdmReqAsymVerify (
-  IN   UINT16                       ReqBaseAsymAlg,
-  IN   UINT32                       BaseHashAlgo,
-  IN   VOID                         *Context,
-  IN   CONST UINT8                  *Message,
-  IN   UINTN                        MessageSize,
-  IN   CONST UINT8                  *Signature,
-  IN   UINTN                        SigSize
+GetSpdmAeadBlockSize (
+  IN   UINT16                       AEADCipherSuite
   )
 {
-  ASYM_VERIFY   VerifyFunction;
-  BOOLEAN       NeedHash;
-  UINT8         MessageHash[MAX_HASH_SIZE];
-  UINTN         HashSize;
-  BOOLEAN       Result;
-  UINTN         HashNid;
-
-  HashNid = GetSpdmHashNid (BaseHashAlgo);
-  NeedHash = SpdmReqAsymFuncNeedHash (ReqBaseAsymAlg);
-
-  VerifyFunction = GetSpdmReqAsymVerify (ReqBaseAsymAlg);
-  if (VerifyFunction == NULL) {
-    return FALSE;
-  }
-  if (NeedHash) {
-    HashSize = GetSpdmHashSize (BaseHashAlgo);
-    Result = SpdmHashAll (BaseHashAlgo, Message, MessageSize, MessageHash);
-    if (!Result) {
-      return FALSE;
-    }
-    return VerifyFunction (Context, HashNid, MessageHash, HashSize, Signature, SigSize);
-  } else {
-    return VerifyFunction (Context, HashNid, Message, MessageSize, Signature, SigSize);
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+    return 16;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+    return 16;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+    return 16;
   }
+  return 0;
 }
 
 /**
-  Return asymmetric GET_PRIVATE_KEY_FROM_PEM function, based upon the asymmetric algorithm.
+  Return AEAD encryption function, based upon the negotiated AEAD algorithm.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return asymmetric GET_PRIVATE_KEY_FROM_PEM function
+  @return AEAD encryption function
 **/
-ASYM_GET_PRIVATE_KEY_FROM_PEM
-GetSpdmReqAsymGetPrivateKeyFromPem (
-  IN   UINT16                       ReqBaseAsymAlg
+AEAD_ENCRYPT
+GetSpdmAeadEncFunc (
+  IN   UINT16                       AEADCipherSuite
   )
 {
-  return GetSpdmAsymGetPrivateKeyFromPem (ReqBaseAsymAlg);
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmEncrypt;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmEncrypt;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+#if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
+    return AeadChaCha20Poly1305Encrypt;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
 }
 
 /**
-  Retrieve the Private Key from the password-protected PEM key data.
+  Performs AEAD authenticated encryption on a data buffer and additional authenticated data (AAD),
+  based upon negotiated AEAD algorithm.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
-  @param  PemData                      Pointer to the PEM-encoded key data to be retrieved.
-  @param  PemSize                      Size of the PEM key data in bytes.
-  @param  Password                     NULL-terminated passphrase used for encrypted PEM key data.
-  @param  Context                      Pointer to new-generated asymmetric context which contain the retrieved private key component.
-                                       Use SpdmAsymFree() function to free the resource.
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  Key                          Pointer to the encryption key.
+  @param  KeySize                      Size of the encryption key in bytes.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be encrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the encryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @retval  TRUE   Private Key was retrieved successfully.
-  @retval  FALSE  Invalid PEM key data or incorrect password.
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
 **/
 BOOLEAN
 EFIAPI
-SpdmReqAsymGetPrivateKeyFromPem (
-  IN   UINT16                       ReqBaseAsymAlg,
-  IN   CONST UINT8                  *PemData,
-  IN   UINTN                        PemSize,
-  IN   CONST CHAR8                  *Password,
-  OUT  VOID                         **Context
+SpdmAeadEncryption (
+  IN   UINT16                       AEADCipherSuite,
+  IN   CONST UINT8*                 Key,
+  IN   UINTN                        KeySize,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 DataIn,
+  IN   UINTN                        DataInSize,
+  OUT  UINT8*                       TagOut,
+  IN   UINTN                        TagSize,
+  OUT  UINT8*                       DataOut,
+  OUT  UINTN*                       DataOutSize
   )
 {
-  ASYM_GET_PRIVATE_KEY_FROM_PEM   AsymGetPrivateKeyFromPem;
-  AsymGetPrivateKeyFromPem = GetSpdmReqAsymGetPrivateKeyFromPem (ReqBaseAsymAlg);
-  if (AsymGetPrivateKeyFromPem == NULL) {
+  AEAD_ENCRYPT   AeadEncFunction;
+  UINT64         StatsStart;
+  AeadEncFunction = GetSpdmAeadEncFunc (AEADCipherSuite);
+  if (AeadEncFunction == NULL) {
     return FALSE;
   }
-  return AsymGetPrivateKeyFromPem (PemData, PemSize, Password, Context);
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAeadEncrypt, ADataSize + DataInSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAeadEncrypt, StatsStart, AeadEncFunction (Key, KeySize, Iv, IvSize, AData, ADataSize, DataIn, DataInSize, TagOut, TagSize, DataOut, DataOutSize));
 }
 
 /**
-  Return asymmetric sign function, based upon the asymmetric algorithm.
+  Return AEAD decryption function, based upon the negotiated AEAD algorithm.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return asymmetric sign function
+  @return AEAD decryption function
 **/
-ASYM_SIGN
-GetSpdmReqAsymSign (
-  IN   UINT16                       ReqBaseAsymAlg
+AEAD_DECRYPT
+GetSpdmAeadDecFunc (
+  IN   UINT16                       AEADCipherSuite
   )
 {
-  return GetSpdmAsymSign (ReqBaseAsymAlg);
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmDecrypt;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmDecrypt;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+#if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
+    return AeadChaCha20Poly1305Decrypt;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  }
+  ASSERT (FALSE);
+  return NULL;
 }
 
 /**
-  Carries out the signature generation.
-
-  If the Signature buffer is too small to hold the contents of signature, FALSE
-  is returned and SigSize is set to the required buffer size to obtain the signature.
+  Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD),
+  based upon negotiated AEAD algorithm.
 
-  @param  ReqBaseAsymAlg               SPDM ReqBaseAsymAlg
-  @param  BaseHashAlgo                 SPDM BaseHashAlgo
-  @param  Context                      Pointer to asymmetric context for signature generation.
-  @param  Message                      Pointer to octet message to be signed (before hash).
-  @param  MessageSize                  Size of the message in bytes.
-  @param  Signature                    Pointer to buffer to receive signature.
-  @param  SigSize                      On input, the size of Signature buffer in bytes.
-                                       On output, the size of data returned in Signature buffer in bytes.
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  Key                          Pointer to the encryption key.
+  @param  KeySize                      Size of the encryption key in bytes.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the decryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @retval  TRUE   Signature successfully generated.
-  @retval  FALSE  Signature generation failed.
-  @retval  FALSE  SigSize is too small.
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
 **/
 BOOLEAN
 EFIAPI
-SpdmReqAsymSign (
-  IN      UINT16                       ReqBaseAsymAlg,
-  IN      UINT32                       BaseHashAlgo,
-  IN      VOID                         *Context,
-  IN      CONST UINT8                  *Message,
-  IN      UINTN                        MessageSize,
-  OUT     UINT8                        *Signature,
-  IN OUT  UINTN                        *SigSize
+SpdmAeadDecryption (
+  IN   UINT16                       AEADCipherSuite,
+  IN   CONST UINT8*                 Key,
+  IN   UINTN                        KeySize,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 DataIn,
+  IN   UINTN                        DataInSize,
+  IN   CONST UINT8*                 Tag,
+  IN   UINTN                        TagSize,
+  OUT  UINT8*                       DataOut,
+  OUT  UINTN*                       DataOutSize
   )
 {
-  ASYM_SIGN     AsymSign;
-  BOOLEAN       NeedHash;
-  UINT8         MessageHash[MAX_HASH_SIZE];
-  UINTN         HashSize;
-  BOOLEAN       Result;
-  UINTN         HashNid;
-
-  HashNid = GetSpdmHashNid (BaseHashAlgo);
-  NeedHash = SpdmReqAsymFuncNeedHash (ReqBaseAsymAlg);
-
-  AsymSign = GetSpdmReqAsymSign (ReqBaseAsymAlg);
-  if (AsymSign == NULL) {
+  AEAD_DECRYPT   AeadDecFunction;
+  UINT64         StatsStart;
+  AeadDecFunction = GetSpdmAeadDecFunc (AEADCipherSuite);
+  if (AeadDecFunction == NULL) {
     return FALSE;
   }
-  if (NeedHash) {
-    HashSize = GetSpdmHashSize (BaseHashAlgo);
-    Result = SpdmHashAll (BaseHashAlgo, Message, MessageSize, MessageHash);
-    if (!Result) {
-      return FALSE;
-    }
-    return AsymSign (Context, HashNid, MessageHash, HashSize, Signature, SigSize);
-  } else {
-    return AsymSign (Context, HashNid, Message, MessageSize, Signature, SigSize);
-  }
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAeadDecrypt, ADataSize + DataInSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAeadDecrypt, StatsStart, AeadDecFunction (Key, KeySize, Iv, IvSize, AData, ADataSize, DataIn, DataInSize, Tag, TagSize, DataOut, DataOutSize));
 }
 
 /**
-  This function returns the SPDM DHE algorithm key size.
+  Return AEAD context new function, based upon the negotiated AEAD algorithm.
 
-  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return SPDM DHE algorithm key size.
+  @return AEAD context new function
 **/
-UINT32
-EFIAPI
-GetSpdmDhePubKeySize (
-  IN   UINT16                       DHENamedGroup
+AEAD_NEW
+GetSpdmAeadNewFunc (
+  IN   UINT16                       AEADCipherSuite
   )
 {
-  switch (DHENamedGroup) {
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
-    return 256;
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
-    return 384;
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
-    return 512;
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
-    return 32 * 2;
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
-    return 48 * 2;
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
-    return 66 * 2;
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmNew;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmNew;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+#if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
+    return AeadChaCha20Poly1305New;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   }
-  return 0;
+  ASSERT (FALSE);
+  return NULL;
 }
 
 /**
-  Return cipher ID, based upon the negotiated DHE algorithm.
+  Allocates and initializes one AEAD context for subsequent use,
+  based upon negotiated AEAD algorithm.
 
-  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return DHE cipher ID
+  @return  Pointer to the AEAD context that has been initialized.
+           NULL if the allocation fails or the algorithm is not supported.
 **/
-UINTN
-GetSpdmDheNid (
-  IN   UINT16                       DHENamedGroup
+VOID *
+EFIAPI
+SpdmAeadNew (
+  IN   UINT16                       AEADCipherSuite
   )
 {
-  switch (DHENamedGroup) {
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
-    return CRYPTO_NID_FFDHE2048;
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
-    return CRYPTO_NID_FFDHE3072;
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
-    return CRYPTO_NID_FFDHE4096;
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
-    return CRYPTO_NID_SECP256R1;
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
-    return CRYPTO_NID_SECP384R1;
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
-    return CRYPTO_NID_SECP521R1;
+  AEAD_NEW   NewFunction;
+  NewFunction = GetSpdmAeadNewFunc (AEADCipherSuite);
+  if (NewFunction == NULL) {
+    return NULL;
   }
-  return CRYPTO_NID_NULL;
+  return NewFunction ();
 }
 
 /**
-  Return DHE new by NID function, based upon the negotiated DHE algorithm.
+  Return AEAD context free function, based upon the negotiated AEAD algorithm.
 
-  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return DHE new by NID function
+  @return AEAD context free function
 **/
-DHE_NEW_BY_NID
-GetSpdmDheNew (
-  IN   UINT16                       DHENamedGroup
+AEAD_FREE
+GetSpdmAeadFreeFunc (
+  IN   UINT16                       AEADCipherSuite
   )
 {
-  switch (DHENamedGroup) {
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
-#if OPENSPDM_FFDHE_SUPPORT == 1
-    return DhNewByNid;
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmFree;
 #else
     ASSERT (FALSE);
     break;
 #endif
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
-#if OPENSPDM_ECDHE_SUPPORT == 1
-    return EcNewByNid;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmFree;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+#if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
+    return AeadChaCha20Poly1305Free;
 #else
     ASSERT (FALSE);
     break;
@@ -1258,60 +3773,60 @@ GetSpdmDheNew (
 }
 
 /**
-  Allocates and Initializes one Diffie-Hellman Ephemeral (DHE) Context for subsequent use,
-  based upon negotiated DHE algorithm.
-  
-  @param  DHENamedGroup                SPDM DHENamedGroup
+  Release the specified AEAD context,
+  based upon negotiated AEAD algorithm.
 
-  @return  Pointer to the Diffie-Hellman Context that has been initialized.
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the AEAD context to be released.
 **/
-VOID *
+VOID
 EFIAPI
-SpdmDheNew (
-  IN   UINT16                       DHENamedGroup
+SpdmAeadFree (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext
   )
 {
-  DHE_NEW_BY_NID   NewFunction;
-  UINTN            Nid;
-
-  NewFunction = GetSpdmDheNew (DHENamedGroup);
-  if (NewFunction == NULL) {
-    return NULL;
+  AEAD_FREE   FreeFunction;
+  if (AeadContext == NULL) {
+    return ;
   }
-  Nid = GetSpdmDheNid (DHENamedGroup);
-  if (Nid == 0) {
-    return NULL;
+  FreeFunction = GetSpdmAeadFreeFunc (AEADCipherSuite);
+  if (FreeFunction == NULL) {
+    return ;
   }
-  return NewFunction (Nid);
+  FreeFunction (AeadContext);
 }
 
 /**
-  Return DHE free function, based upon the negotiated DHE algorithm.
+  Return AEAD set key function, based upon the negotiated AEAD algorithm.
 
-  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return DHE free function
+  @return AEAD set key function
 **/
-DHE_FREE
-GetSpdmDheFree (
-  IN   UINT16                       DHENamedGroup
+AEAD_SET_KEY
+GetSpdmAeadSetKeyFunc (
+  IN   UINT16                       AEADCipherSuite
   )
 {
-  switch (DHENamedGroup) {
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
-#if OPENSPDM_FFDHE_SUPPORT == 1
-    return DhFree;
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmSetKey;
 #else
     ASSERT (FALSE);
     break;
 #endif
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
-#if OPENSPDM_ECDHE_SUPPORT == 1
-    return EcFree;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmSetKey;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+#if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
+    return AeadChaCha20Poly1305SetKey;
 #else
     ASSERT (FALSE);
     break;
@@ -1322,54 +3837,65 @@ GetSpdmDheFree (
 }
 
 /**
-  Release the specified DHE context,
-  based upon negotiated DHE algorithm.
+  Set the key for the AEAD context, based upon negotiated AEAD algorithm.
 
-  @param  DHENamedGroup                SPDM DHENamedGroup
-  @param  Context                      Pointer to the DHE context to be released.
+  The key schedule runs once here. SpdmAeadSeal and SpdmAeadOpen only consume the IV.
+
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the AEAD context.
+  @param  Key                          Pointer to the encryption key.
+  @param  KeySize                      Size of the encryption key in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
 **/
-VOID
+BOOLEAN
 EFIAPI
-SpdmDheFree (
-  IN   UINT16                       DHENamedGroup,
-  IN   VOID                         *Context
+SpdmAeadSetKey (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext,
+  IN   CONST UINT8*                 Key,
+  IN   UINTN                        KeySize
   )
 {
-  DHE_FREE   FreeFunction;
-  FreeFunction = GetSpdmDheFree (DHENamedGroup);
-  if (FreeFunction == NULL) {
-    return ;
+  AEAD_SET_KEY   SetKeyFunction;
+  SetKeyFunction = GetSpdmAeadSetKeyFunc (AEADCipherSuite);
+  if (SetKeyFunction == NULL) {
+    return FALSE;
   }
-  FreeFunction (Context);
+  return SetKeyFunction (AeadContext, Key, KeySize);
 }
 
 /**
-  Return DHE generate key function, based upon the negotiated DHE algorithm.
+  Return AEAD seal function, based upon the negotiated AEAD algorithm.
 
-  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return DHE generate key function
+  @return AEAD seal function
 **/
-DHE_GENERATE_KEY
-GetSpdmDheGenerateKey (
-  IN   UINT16                       DHENamedGroup
-  )
-{
-  switch (DHENamedGroup) {
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
-#if OPENSPDM_FFDHE_SUPPORT == 1
-    return DhGenerateKey;
+AEAD_SEAL
+GetSpdmAeadSealFunc (
+  IN   UINT16                       AEADCipherSuite
+  )
+{
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmSeal;
 #else
     ASSERT (FALSE);
     break;
 #endif
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
-#if OPENSPDM_ECDHE_SUPPORT == 1
-    return EcGenerateKey;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmSeal;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+#if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
+    return AeadChaCha20Poly1305Seal;
 #else
     ASSERT (FALSE);
     break;
@@ -1380,68 +3906,82 @@ GetSpdmDheGenerateKey (
 }
 
 /**
-  Generates DHE public key,
-  based upon negotiated DHE algorithm.
-
-  This function generates random secret exponent, and computes the public key, which is
-  returned via parameter PublicKey and PublicKeySize. DH context is updated accordingly.
-  If the PublicKey buffer is too small to hold the public key, FALSE is returned and
-  PublicKeySize is set to the required buffer size to obtain the public key.
+  Performs AEAD authenticated encryption on a data buffer and additional authenticated data (AAD),
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
 
-  @param  DHENamedGroup                SPDM DHENamedGroup
-  @param  Context                      Pointer to the DHE context.
-  @param  PublicKey                    Pointer to the buffer to receive generated public key.
-  @param  PublicKeySize                On input, the size of PublicKey buffer in bytes.
-                                       On output, the size of data returned in PublicKey buffer in bytes.
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be encrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the encryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @retval TRUE   DHE public key generation succeeded.
-  @retval FALSE  DHE public key generation failed.
-  @retval FALSE  PublicKeySize is not large enough.
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
 **/
 BOOLEAN
 EFIAPI
-SpdmDheGenerateKey (
-  IN      UINT16                       DHENamedGroup,
-  IN OUT  VOID                         *Context,
-  OUT     UINT8                        *PublicKey,
-  IN OUT  UINTN                        *PublicKeySize
+SpdmAeadSeal (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 DataIn,
+  IN   UINTN                        DataInSize,
+  OUT  UINT8*                       TagOut,
+  IN   UINTN                        TagSize,
+  OUT  UINT8*                       DataOut,
+  OUT  UINTN*                       DataOutSize
   )
 {
-  DHE_GENERATE_KEY   GenerateKeyFunction;
-  GenerateKeyFunction = GetSpdmDheGenerateKey (DHENamedGroup);
-  if (GenerateKeyFunction == NULL) {
+  AEAD_SEAL   SealFunction;
+  UINT64      StatsStart;
+  SealFunction = GetSpdmAeadSealFunc (AEADCipherSuite);
+  if (SealFunction == NULL) {
     return FALSE;
   }
-  return GenerateKeyFunction (Context, PublicKey, PublicKeySize);
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAeadEncrypt, ADataSize + DataInSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAeadEncrypt, StatsStart, SealFunction (AeadContext, Iv, IvSize, AData, ADataSize, DataIn, DataInSize, TagOut, TagSize, DataOut, DataOutSize));
 }
 
 /**
-  Return DHE compute key function, based upon the negotiated DHE algorithm.
+  Return AEAD open function, based upon the negotiated AEAD algorithm.
 
-  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return DHE compute key function
+  @return AEAD open function
 **/
-DHE_COMPUTE_KEY
-GetSpdmDheComputeKey (
-  IN      UINT16                       DHENamedGroup
+AEAD_OPEN
+GetSpdmAeadOpenFunc (
+  IN   UINT16                       AEADCipherSuite
   )
 {
-  switch (DHENamedGroup) {
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096:
-#if OPENSPDM_FFDHE_SUPPORT == 1
-    return DhComputeKey;
+  switch (AEADCipherSuite) {
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmOpen;
 #else
     ASSERT (FALSE);
     break;
 #endif
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1:
-  case SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1:
-#if OPENSPDM_ECDHE_SUPPORT == 1
-    return EcComputeKey;
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmOpen;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
+  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
+#if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
+    return AeadChaCha20Poly1305Open;
 #else
     ASSERT (FALSE);
     break;
@@ -1452,169 +3992,261 @@ GetSpdmDheComputeKey (
 }
 
 /**
-  Computes exchanged common key,
-  based upon negotiated DHE algorithm.
-
-  Given peer's public key, this function computes the exchanged common key, based on its own
-  context including value of prime modulus and random secret exponent.
+  Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
 
-  @param  DHENamedGroup                SPDM DHENamedGroup
-  @param  Context                      Pointer to the DHE context.
-  @param  PeerPublicKey                Pointer to the peer's public key.
-  @param  PeerPublicKeySize            Size of peer's public key in bytes.
-  @param  Key                          Pointer to the buffer to receive generated key.
-  @param  KeySize                      On input, the size of Key buffer in bytes.
-                                       On output, the size of data returned in Key buffer in bytes.
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the decryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @retval TRUE   DHE exchanged key generation succeeded.
-  @retval FALSE  DHE exchanged key generation failed.
-  @retval FALSE  KeySize is not large enough.
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
 **/
 BOOLEAN
 EFIAPI
-SpdmDheComputeKey (
-  IN      UINT16                       DHENamedGroup,
-  IN OUT  VOID                         *Context,
-  IN      CONST UINT8                  *PeerPublic,
-  IN      UINTN                        PeerPublicSize,
-  OUT     UINT8                        *Key,
-  IN OUT  UINTN                        *KeySize
+SpdmAeadOpen (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 DataIn,
+  IN   UINTN                        DataInSize,
+  IN   CONST UINT8*                 Tag,
+  IN   UINTN                        TagSize,
+  OUT  UINT8*                       DataOut,
+  OUT  UINTN*                       DataOutSize
   )
 {
-  DHE_COMPUTE_KEY   ComputeKeyFunction;
-  ComputeKeyFunction = GetSpdmDheComputeKey (DHENamedGroup);
-  if (ComputeKeyFunction == NULL) {
+  AEAD_OPEN   OpenFunction;
+  UINT64      StatsStart;
+  OpenFunction = GetSpdmAeadOpenFunc (AEADCipherSuite);
+  if (OpenFunction == NULL) {
     return FALSE;
   }
-  return ComputeKeyFunction (Context, PeerPublic, PeerPublicSize, Key, KeySize);
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAeadDecrypt, ADataSize + DataInSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAeadDecrypt, StatsStart, OpenFunction (AeadContext, Iv, IvSize, AData, ADataSize, DataIn, DataInSize, Tag, TagSize, DataOut, DataOutSize));
 }
 
 /**
-  This function returns the SPDM AEAD algorithm key size.
+  Return AEAD seal segments function, based upon the negotiated AEAD algorithm.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return SPDM AEAD algorithm key size.
+  @return AEAD seal segments function
 **/
-UINT32
-EFIAPI
-GetSpdmAeadKeySize (
+AEAD_SEAL_SEGMENTS
+GetSpdmAeadSealSegmentsFunc (
   IN   UINT16                       AEADCipherSuite
   )
 {
   switch (AEADCipherSuite) {
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
-    return 16;
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmSealSegments;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
-    return 32;
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmSealSegments;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
-    return 32;
+#if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
+    return AeadChaCha20Poly1305SealSegments;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   }
-  return 0;
+  ASSERT (FALSE);
+  return NULL;
 }
 
 /**
-  This function returns the SPDM AEAD algorithm iv size.
+  Performs AEAD authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
+
+  The segments are encrypted in order, as if they were one contiguous buffer, into DataOut.
+  A segment may only overlap DataOut at the offset where its own cipher text is written.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the list of input data segments to be encrypted.
+  @param  DataInCount                  Number of entries in DataIn.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to a buffer that receives the encryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @return SPDM AEAD algorithm iv size.
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
 **/
-UINT32
+BOOLEAN
 EFIAPI
-GetSpdmAeadIvSize (
-  IN   UINT16                       AEADCipherSuite
+SpdmAeadSealSegments (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT*    DataIn,
+  IN   UINTN                        DataInCount,
+  OUT  UINT8*                       TagOut,
+  IN   UINTN                        TagSize,
+  OUT  UINT8*                       DataOut,
+  OUT  UINTN*                       DataOutSize
   )
 {
-  switch (AEADCipherSuite) {
-  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
-    return 12;
-  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
-    return 12;
-  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
-    return 12;
+  AEAD_SEAL_SEGMENTS   SealFunction;
+  UINT64               StatsStart;
+  SealFunction = GetSpdmAeadSealSegmentsFunc (AEADCipherSuite);
+  if (SealFunction == NULL) {
+    return FALSE;
   }
-  return 0;
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAeadEncrypt, ADataSize + SpdmCryptoStatsSegmentsSize (DataIn, DataInCount));
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAeadEncrypt, StatsStart, SealFunction (AeadContext, Iv, IvSize, AData, ADataSize, DataIn, DataInCount, TagOut, TagSize, DataOut, DataOutSize));
 }
 
 /**
-  This function returns the SPDM AEAD algorithm tag size.
+  Return AEAD open segments function, based upon the negotiated AEAD algorithm.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return SPDM AEAD algorithm tag size.
+  @return AEAD open segments function
 **/
-UINT32
-EFIAPI
-GetSpdmAeadTagSize (
+AEAD_OPEN_SEGMENTS
+GetSpdmAeadOpenSegmentsFunc (
   IN   UINT16                       AEADCipherSuite
   )
 {
   switch (AEADCipherSuite) {
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
-    return 16;
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmOpenSegments;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
-    return 16;
+#if OPENSPDM_AEAD_GCM_SUPPORT == 1
+    return AeadAesGcmOpenSegments;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
-    return 16;
+#if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
+    return AeadChaCha20Poly1305OpenSegments;
+#else
+    ASSERT (FALSE);
+    break;
+#endif
   }
-  return 0;
+  ASSERT (FALSE);
+  return NULL;
 }
 
 /**
-  This function returns the SPDM AEAD algorithm block size.
+  Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
+
+  The plain text is written in order across the DataOut segments, which must hold at least DataInSize bytes.
+  A segment may only overlap DataIn at the offset where its own cipher text is read.
+  If the authentication fails, the plain text written to the segments is zeroed.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  AeadContext                  Pointer to the keyed AEAD context.
+  @param  Iv                           Pointer to the IV value.
+  @param  IvSize                       Size of the IV value in bytes.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  TagSize                      Size of the authentication tag in bytes.
+  @param  DataOut                      Pointer to the list of segments that receive the decryption output.
+  @param  DataOutCount                 Number of entries in DataOut.
 
-  @return SPDM AEAD algorithm block size.
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
 **/
-UINT32
+BOOLEAN
 EFIAPI
-GetSpdmAeadBlockSize (
-  IN   UINT16                       AEADCipherSuite
+SpdmAeadOpenSegments (
+  IN   UINT16                       AEADCipherSuite,
+  IN   VOID                         *AeadContext,
+  IN   CONST UINT8*                 Iv,
+  IN   UINTN                        IvSize,
+  IN   CONST UINT8*                 AData,
+  IN   UINTN                        ADataSize,
+  IN   CONST UINT8*                 DataIn,
+  IN   UINTN                        DataInSize,
+  IN   CONST UINT8*                 Tag,
+  IN   UINTN                        TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT*    DataOut,
+  IN   UINTN                        DataOutCount
   )
 {
-  switch (AEADCipherSuite) {
-  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
-    return 16;
-  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
-    return 16;
-  case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
-    return 16;
+  AEAD_OPEN_SEGMENTS   OpenFunction;
+  UINT64               StatsStart;
+  OpenFunction = GetSpdmAeadOpenSegmentsFunc (AEADCipherSuite);
+  if (OpenFunction == NULL) {
+    return FALSE;
   }
-  return 0;
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAeadDecrypt, ADataSize + DataInSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAeadDecrypt, StatsStart, OpenFunction (AeadContext, Iv, IvSize, AData, ADataSize, DataIn, DataInSize, Tag, TagSize, DataOut, DataOutCount));
 }
 
 /**
-  Return AEAD encryption function, based upon the negotiated AEAD algorithm.
+  Return AEAD MAC function, based upon the negotiated AEAD algorithm.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return AEAD encryption function
+  @return AEAD MAC function
 **/
-AEAD_ENCRYPT
-GetSpdmAeadEncFunc (
+AEAD_MAC
+GetSpdmAeadMacFunc (
   IN   UINT16                       AEADCipherSuite
   )
 {
   switch (AEADCipherSuite) {
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
 #if OPENSPDM_AEAD_GCM_SUPPORT == 1
-    return AeadAesGcmEncrypt;
+    return AeadAesGcmMac;
 #else
     ASSERT (FALSE);
     break;
 #endif
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
 #if OPENSPDM_AEAD_GCM_SUPPORT == 1
-    return AeadAesGcmEncrypt;
+    return AeadAesGcmMac;
 #else
     ASSERT (FALSE);
     break;
 #endif
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
 #if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
-    return AeadChaCha20Poly1305Encrypt;
+    return AeadChaCha20Poly1305Mac;
 #else
     ASSERT (FALSE);
     break;
@@ -1625,82 +4257,76 @@ GetSpdmAeadEncFunc (
 }
 
 /**
-  Performs AEAD authenticated encryption on a data buffer and additional authenticated data (AAD),
-  based upon negotiated AEAD algorithm.
+  Generates the AEAD authentication tag of additional authenticated data (AAD) only,
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
+
+  It is equivalent to SpdmAeadSeal with an empty plain text. It is used by the MAC-only sessions.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
-  @param  Key                          Pointer to the encryption key.
-  @param  KeySize                      Size of the encryption key in bytes.
+  @param  AeadContext                  Pointer to the keyed AEAD context.
   @param  Iv                           Pointer to the IV value.
   @param  IvSize                       Size of the IV value in bytes.
   @param  AData                        Pointer to the additional authenticated data (AAD).
   @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
-  @param  DataIn                       Pointer to the input data buffer to be encrypted.
-  @param  DataInSize                   Size of the input data buffer in bytes.
   @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
   @param  TagSize                      Size of the authentication tag in bytes.
-  @param  DataOut                      Pointer to a buffer that receives the encryption output.
-  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @retval TRUE   AEAD authenticated encryption succeeded.
-  @retval FALSE  AEAD authenticated encryption failed.
+  @retval TRUE   AEAD authentication tag generation succeeded.
+  @retval FALSE  AEAD authentication tag generation failed.
 **/
 BOOLEAN
 EFIAPI
-SpdmAeadEncryption (
+SpdmAeadMac (
   IN   UINT16                       AEADCipherSuite,
-  IN   CONST UINT8*                 Key,
-  IN   UINTN                        KeySize,
+  IN   VOID                         *AeadContext,
   IN   CONST UINT8*                 Iv,
   IN   UINTN                        IvSize,
   IN   CONST UINT8*                 AData,
   IN   UINTN                        ADataSize,
-  IN   CONST UINT8*                 DataIn,
-  IN   UINTN                        DataInSize,
   OUT  UINT8*                       TagOut,
-  IN   UINTN                        TagSize,
-  OUT  UINT8*                       DataOut,
-  OUT  UINTN*                       DataOutSize
+  IN   UINTN                        TagSize
   )
 {
-  AEAD_ENCRYPT   AeadEncFunction;
-  AeadEncFunction = GetSpdmAeadEncFunc (AEADCipherSuite);
-  if (AeadEncFunction == NULL) {
+  AEAD_MAC             MacFunction;
+  UINT64               StatsStart;
+  MacFunction = GetSpdmAeadMacFunc (AEADCipherSuite);
+  if (MacFunction == NULL) {
     return FALSE;
   }
-  return AeadEncFunction (Key, KeySize, Iv, IvSize, AData, ADataSize, DataIn, DataInSize, TagOut, TagSize, DataOut, DataOutSize);
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAeadEncrypt, ADataSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAeadEncrypt, StatsStart, MacFunction (AeadContext, Iv, IvSize, AData, ADataSize, TagOut, TagSize));
 }
 
 /**
-  Return AEAD decryption function, based upon the negotiated AEAD algorithm.
+  Return AEAD verify MAC function, based upon the negotiated AEAD algorithm.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
 
-  @return AEAD decryption function
+  @return AEAD verify MAC function
 **/
-AEAD_DECRYPT
-GetSpdmAeadDecFunc (
+AEAD_VERIFY_MAC
+GetSpdmAeadVerifyMacFunc (
   IN   UINT16                       AEADCipherSuite
   )
 {
   switch (AEADCipherSuite) {
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM:
 #if OPENSPDM_AEAD_GCM_SUPPORT == 1
-    return AeadAesGcmDecrypt;
+    return AeadAesGcmVerifyMac;
 #else
     ASSERT (FALSE);
     break;
 #endif
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM:
 #if OPENSPDM_AEAD_GCM_SUPPORT == 1
-    return AeadAesGcmDecrypt;
+    return AeadAesGcmVerifyMac;
 #else
     ASSERT (FALSE);
     break;
 #endif
   case SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305:
 #if OPENSPDM_AEAD_CHACHA20_POLY1305_SUPPORT == 1
-    return AeadChaCha20Poly1305Decrypt;
+    return AeadChaCha20Poly1305VerifyMac;
 #else
     ASSERT (FALSE);
     break;
@@ -1711,50 +4337,81 @@ GetSpdmAeadDecFunc (
 }
 
 /**
-  Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD),
-  based upon negotiated AEAD algorithm.
+  Verifies the AEAD authentication tag of additional authenticated data (AAD) only,
+  with a keyed AEAD context, based upon negotiated AEAD algorithm.
+
+  It is equivalent to SpdmAeadOpen with an empty cipher text. It is used by the MAC-only sessions.
 
   @param  AEADCipherSuite              SPDM AEADCipherSuite
-  @param  Key                          Pointer to the encryption key.
-  @param  KeySize                      Size of the encryption key in bytes.
+  @param  AeadContext                  Pointer to the keyed AEAD context.
   @param  Iv                           Pointer to the IV value.
   @param  IvSize                       Size of the IV value in bytes.
   @param  AData                        Pointer to the additional authenticated data (AAD).
   @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
-  @param  DataIn                       Pointer to the input data buffer to be decrypted.
-  @param  DataInSize                   Size of the input data buffer in bytes.
   @param  Tag                          Pointer to a buffer that contains the authentication tag.
   @param  TagSize                      Size of the authentication tag in bytes.
-  @param  DataOut                      Pointer to a buffer that receives the decryption output.
-  @param  DataOutSize                  Size of the output data buffer in bytes.
 
-  @retval TRUE   AEAD authenticated decryption succeeded.
-  @retval FALSE  AEAD authenticated decryption failed.
+  @retval TRUE   AEAD authentication tag verification succeeded.
+  @retval FALSE  AEAD authentication tag verification failed.
 **/
 BOOLEAN
 EFIAPI
-SpdmAeadDecryption (
+SpdmAeadVerifyMac (
   IN   UINT16                       AEADCipherSuite,
-  IN   CONST UINT8*                 Key,
-  IN   UINTN                        KeySize,
+  IN   VOID                         *AeadContext,
   IN   CONST UINT8*                 Iv,
   IN   UINTN                        IvSize,
   IN   CONST UINT8*                 AData,
   IN   UINTN                        ADataSize,
-  IN   CONST UINT8*                 DataIn,
-  IN   UINTN                        DataInSize,
   IN   CONST UINT8*                 Tag,
-  IN   UINTN                        TagSize,
-  OUT  UINT8*                       DataOut,
-  OUT  UINTN*                       DataOutSize
+  IN   UINTN                        TagSize
   )
 {
-  AEAD_DECRYPT   AeadDecFunction;
-  AeadDecFunction = GetSpdmAeadDecFunc (AEADCipherSuite);
-  if (AeadDecFunction == NULL) {
+  AEAD_VERIFY_MAC      VerifyMacFunction;
+  UINT64               StatsStart;
+  VerifyMacFunction = GetSpdmAeadVerifyMacFunc (AEADCipherSuite);
+  if (VerifyMacFunction == NULL) {
     return FALSE;
   }
-  return AeadDecFunction (Key, KeySize, Iv, IvSize, AData, ADataSize, DataIn, DataInSize, Tag, TagSize, DataOut, DataOutSize);
+  StatsStart = SPDM_CRYPTO_STATS_BEGIN (SpdmCryptoOperationAeadDecrypt, ADataSize);
+  return SPDM_CRYPTO_STATS_END (SpdmCryptoOperationAeadDecrypt, StatsStart, VerifyMacFunction (AeadContext, Iv, IvSize, AData, ADataSize, Tag, TagSize));
+}
+
+/**
+  Compares the contents of two buffers in constant time.
+
+  The time of the comparison depends on Length only, not on the contents or the position of the
+  first mismatched byte, so that it is used to verify the secrets, such as the HMAC values.
+  Unlike CompareMem, the return value does not order the buffers.
+
+  @param  DestinationBuffer            A pointer to the destination buffer to compare.
+  @param  SourceBuffer                 A pointer to the source buffer to compare.
+  @param  Length                       The number of bytes to compare.
+
+  @return 0                            All Length bytes of the two buffers are identical.
+  @retval Non-zero                     The two buffers are different.
+**/
+INTN
+EFIAPI
+SpdmConstTimeCompareMem (
+  IN CONST VOID                   *DestinationBuffer,
+  IN CONST VOID                   *SourceBuffer,
+  IN UINTN                        Length
+  )
+{
+  volatile CONST UINT8  *PointerDst;
+  volatile CONST UINT8  *PointerSrc;
+  UINT8                 Delta;
+  UINTN                 Index;
+
+  PointerDst = (CONST UINT8 *)DestinationBuffer;
+  PointerSrc = (CONST UINT8 *)SourceBuffer;
+  Delta = 0;
+  for (Index = 0; Index < Length; Index++) {
+    Delta |= PointerDst[Index] ^ PointerSrc[Index];
+  }
+
+  return Delta;
 }
 
 /**
@@ -1776,6 +4433,73 @@ SpdmGetRandomNumber (
   return ;
 }
 
+/**
+  Initialize a random stream, or wipe the random bytes it holds.
+
+  @param  RandomStream                 A pointer to the random stream.
+**/
+VOID
+EFIAPI
+SpdmRandomStreamInit (
+  OUT SPDM_RANDOM_STREAM        *RandomStream
+  )
+{
+  ZeroMem (RandomStream, sizeof(SPDM_RANDOM_STREAM));
+#if OPENSPDM_RANDOM_STREAM_SIZE != 0
+  RandomStream->Offset = sizeof(RandomStream->Buffer);
+#endif
+}
+
+/**
+  Generates a random byte stream of the specified size from a random stream.
+
+  The bytes are taken from the buffer of the random stream, which is refilled with
+  OPENSPDM_RANDOM_STREAM_SIZE bytes at once. A request of at least OPENSPDM_RANDOM_STREAM_SIZE bytes
+  is passed to RandomBytes directly. The bytes are wiped from the buffer when they are taken.
+
+  @param  RandomStream                 A pointer to the random stream.
+  @param  Size                         Size of random bytes to generate.
+  @param  Rand                         Pointer to buffer to receive random value.
+**/
+VOID
+EFIAPI
+SpdmRandomStreamGetBytes (
+  IN OUT SPDM_RANDOM_STREAM     *RandomStream,
+  IN     UINTN                  Size,
+     OUT UINT8                  *Rand
+  )
+{
+#if OPENSPDM_RANDOM_STREAM_SIZE != 0
+  UINTN  Length;
+
+  if (Size >= sizeof(RandomStream->Buffer)) {
+    RandomBytes (Rand, Size);
+    return ;
+  }
+
+  while (Size > 0) {
+    if (RandomStream->Offset >= sizeof(RandomStream->Buffer)) {
+      if (RandomStream->RefillCount >= OPENSPDM_RANDOM_STREAM_RESEED_INTERVAL) {
+        RandomSeed (NULL, 0);
+        RandomStream->RefillCount = 0;
+      }
+      RandomBytes (RandomStream->Buffer, sizeof(RandomStream->Buffer));
+      RandomStream->RefillCount++;
+      RandomStream->Offset = 0;
+    }
+    Length = MIN (Size, sizeof(RandomStream->Buffer) - RandomStream->Offset);
+    CopyMem (Rand, RandomStream->Buffer + RandomStream->Offset, Length);
+    ZeroMem (RandomStream->Buffer + RandomStream->Offset, Length);
+    RandomStream->Offset += Length;
+    Rand += Length;
+    Size -= Length;
+  }
+#else
+  RandomBytes (Rand, Size);
+#endif
+  return ;
+}
+
 /**
   Check the X509 DataTime is within a valid range.
 
@@ -1971,6 +4695,30 @@ STATIC CONST UINT8 OID_subjectAltName[] = {
   0x55, 0x1D, 0x11
 };
 
+STATIC CONST UINT8 OID_subjectKeyIdentifier[] = {
+  0x55, 0x1D, 0x0E
+};
+
+STATIC CONST UINT8 OID_keyUsage[] = {
+  0x55, 0x1D, 0x0F
+};
+
+STATIC CONST UINT8 OID_basicConstraints[] = {
+  0x55, 0x1D, 0x13
+};
+
+STATIC CONST UINT8 OID_nameConstraints[] = {
+  0x55, 0x1D, 0x1E
+};
+
+STATIC CONST UINT8 OID_authorityKeyIdentifier[] = {
+  0x55, 0x1D, 0x23
+};
+
+STATIC CONST UINT8 OID_extKeyUsage[] = {
+  0x55, 0x1D, 0x25
+};
+
 /**
   Retrieve the SubjectAltName from SubjectAltName Bytes.
 
@@ -2045,33 +4793,394 @@ SpdmGetDMTFSubjectAltNameFromBytes (
     *OidSize = ObjLen;
   }
 
-  // Move to next element
-  Ptr += ObjLen;
+  // Move to next element
+  Ptr += ObjLen;
+
+  Ret = Asn1GetTag (
+    &Ptr, (UINT8 *)(Buffer + Length),
+    &ObjLen,
+    CRYPTO_ASN1_CONTEXT_SPECIFIC | CRYPTO_ASN1_CONSTRUCTED
+    );
+  Ret = Asn1GetTag (
+    &Ptr, (UINT8 *)(Buffer + Length),
+    &ObjLen,
+    CRYPTO_ASN1_UTF8_STRING);
+  if (!Ret) {
+    return RETURN_NOT_FOUND;
+  }
+
+  if (*NameBufferSize < (UINTN)ObjLen + 1) {
+    *NameBufferSize = (UINTN)ObjLen + 1;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  if (NameBuffer != NULL) {
+    CopyMem (NameBuffer, Ptr, ObjLen);
+    *NameBufferSize = ObjLen + 1;
+    NameBuffer[ObjLen] = 0;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Retrieve the tag and length of an element, and check that its content is inside the data.
+
+  @param Ptr      The position in the ASN.1 data, moved to the content of the element.
+  @param End      End of data
+  @param Length   The variable that will receive the length of the content
+  @param Tag      The expected tag
+
+  @retval TRUE    The element is found.
+  @retval FALSE   The tag does not match, or the element runs past the end of data.
+**/
+STATIC
+BOOLEAN
+InternalSpdmDerGetTag (
+  IN OUT UINT8                     **Ptr,
+  IN     UINT8                     *End,
+     OUT UINTN                     *Length,
+  IN     UINT32                    Tag
+  )
+{
+  UINT8  *PtrOld;
+
+  if (*Ptr >= End) {
+    return FALSE;
+  }
+  PtrOld = *Ptr;
+  if (!Asn1GetTag (Ptr, End, Length, Tag)) {
+    return FALSE;
+  }
+  if ((*Ptr > End) || (*Length > (UINTN)(End - *Ptr))) {
+    *Ptr = PtrOld;
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Initialize the view of one DER-encoded X.509 certificate.
+
+  The fields of the certificate are not parsed until SpdmX509CertViewParseFields is called.
+
+  @param[out] CertView         The view of the certificate.
+  @param[in]  Cert             Pointer to the DER-encoded X509 certificate.
+  @param[in]  CertSize         Size of the X509 certificate in bytes.
+**/
+VOID
+EFIAPI
+SpdmX509CertViewInit (
+  OUT SPDM_X509_CERT_VIEW          *CertView,
+  IN  UINT8                        *Cert,
+  IN  UINTN                        CertSize
+  )
+{
+  ZeroMem (CertView, sizeof(SPDM_X509_CERT_VIEW));
+  CertView->Cert = Cert;
+  CertView->CertSize = CertSize;
+}
+
+/**
+  Check whether an OID is the expected one.
+
+  @param[in]  Oid              The content of the OID.
+  @param[in]  OidSize          Size in bytes of the content of the OID.
+  @param[in]  Expected         The content of the expected OID.
+  @param[in]  ExpectedSize     Size in bytes of the content of the expected OID.
+
+  @retval TRUE   The OID is the expected one.
+  @retval FALSE  The OID is another one.
+**/
+STATIC
+BOOLEAN
+InternalSpdmIsOid (
+  IN CONST UINT8                   *Oid,
+  IN UINTN                         OidSize,
+  IN CONST UINT8                   *Expected,
+  IN UINTN                         ExpectedSize
+  )
+{
+  return (BOOLEAN)((OidSize == ExpectedSize) && (CompareMem (Oid, Expected, OidSize) == 0));
+}
+
+/**
+  Parse the fields of the certificate of a view, if they are not parsed yet.
+
+  @param[in,out] CertView      The view of the certificate.
+
+  @retval TRUE   The fields are parsed.
+  @retval FALSE  The certificate is not a valid DER-encoded X509 certificate.
+**/
+BOOLEAN
+EFIAPI
+SpdmX509CertViewParseFields (
+  IN OUT SPDM_X509_CERT_VIEW       *CertView
+  )
+{
+  UINT8       *Ptr;
+  UINT8       *End;
+  UINT8       *TbsEnd;
+  UINT8       *ExtensionsEnd;
+  UINT8       *ExtensionEnd;
+  UINT8       *Oid;
+  UINTN       OidSize;
+  UINTN       Length;
+  UINTN       Index;
+  UINT8       *Field[4];
+  UINTN       FieldSize[4];
+  BOOLEAN     Critical;
+
+  if (CertView->FieldsParsed) {
+    return TRUE;
+  }
+  if (CertView->Cert == NULL) {
+    return FALSE;
+  }
+
+  //
+  // Certificate ::= SEQUENCE { tbsCertificate, signatureAlgorithm, signatureValue }
+  //
+  Ptr = CertView->Cert;
+  End = CertView->Cert + CertView->CertSize;
+  if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  End = Ptr + Length;
+
+  CertView->Tbs = Ptr;
+  if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  TbsEnd = Ptr + Length;
+  CertView->TbsSize = TbsEnd - CertView->Tbs;
+
+  //
+  // version [0] EXPLICIT OPTIONAL, serialNumber INTEGER,
+  // signature, issuer, validity and subject SEQUENCE
+  //
+  if (InternalSpdmDerGetTag (&Ptr, TbsEnd, &Length, CRYPTO_ASN1_CONTEXT_SPECIFIC | CRYPTO_ASN1_CONSTRUCTED | 0)) {
+    Ptr += Length;
+  }
+  if (!InternalSpdmDerGetTag (&Ptr, TbsEnd, &Length, CRYPTO_ASN1_INTEGER)) {
+    return FALSE;
+  }
+  Ptr += Length;
+  for (Index = 0; Index < 4; Index++) {
+    Field[Index] = Ptr;
+    if (!InternalSpdmDerGetTag (&Ptr, TbsEnd, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+      return FALSE;
+    }
+    Ptr += Length;
+    FieldSize[Index] = Ptr - Field[Index];
+  }
+  CertView->TbsSignatureAlgorithm = Field[0];
+  CertView->TbsSignatureAlgorithmSize = FieldSize[0];
+  CertView->Issuer = Field[1];
+  CertView->IssuerSize = FieldSize[1];
+  CertView->Subject = Field[3];
+  CertView->SubjectSize = FieldSize[3];
+
+  CertView->SubjectPublicKeyInfo = Ptr;
+  if (!InternalSpdmDerGetTag (&Ptr, TbsEnd, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  Ptr += Length;
+  CertView->SubjectPublicKeyInfoSize = Ptr - CertView->SubjectPublicKeyInfo;
+
+  //
+  // issuerUniqueID [1] IMPLICIT OPTIONAL, subjectUniqueID [2] IMPLICIT OPTIONAL,
+  // extensions [3] EXPLICIT OPTIONAL
+  //
+  if (InternalSpdmDerGetTag (&Ptr, TbsEnd, &Length, CRYPTO_ASN1_CONTEXT_SPECIFIC | 1)) {
+    Ptr += Length;
+  }
+  if (InternalSpdmDerGetTag (&Ptr, TbsEnd, &Length, CRYPTO_ASN1_CONTEXT_SPECIFIC | 2)) {
+    Ptr += Length;
+  }
+  CertView->SubjectAltName = NULL;
+  CertView->SubjectAltNameSize = 0;
+  CertView->BasicConstraints = NULL;
+  CertView->BasicConstraintsSize = 0;
+  CertView->KeyUsage = NULL;
+  CertView->KeyUsageSize = 0;
+  CertView->SubjectKeyIdentifier = NULL;
+  CertView->SubjectKeyIdentifierSize = 0;
+  CertView->AuthorityKeyIdentifier = NULL;
+  CertView->AuthorityKeyIdentifierSize = 0;
+  CertView->NameConstraints = NULL;
+  CertView->NameConstraintsSize = 0;
+  CertView->OtherCriticalExtension = FALSE;
+  if (InternalSpdmDerGetTag (&Ptr, TbsEnd, &Length, CRYPTO_ASN1_CONTEXT_SPECIFIC | CRYPTO_ASN1_CONSTRUCTED | 3)) {
+    if (!InternalSpdmDerGetTag (&Ptr, Ptr + Length, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+      return FALSE;
+    }
+    ExtensionsEnd = Ptr + Length;
+    while (Ptr < ExtensionsEnd) {
+      //
+      // Extension ::= SEQUENCE { extnID OID, critical BOOLEAN DEFAULT FALSE, extnValue OCTET STRING }
+      //
+      if (!InternalSpdmDerGetTag (&Ptr, ExtensionsEnd, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+        return FALSE;
+      }
+      ExtensionEnd = Ptr + Length;
+      if (!InternalSpdmDerGetTag (&Ptr, ExtensionEnd, &OidSize, CRYPTO_ASN1_OID)) {
+        return FALSE;
+      }
+      Oid = Ptr;
+      Ptr += OidSize;
+      Critical = FALSE;
+      if (InternalSpdmDerGetTag (&Ptr, ExtensionEnd, &Length, CRYPTO_ASN1_BOOLEAN)) {
+        Critical = (BOOLEAN)((Length != 0) && (*Ptr != 0));
+        Ptr += Length;
+      }
+      if (!InternalSpdmDerGetTag (&Ptr, ExtensionEnd, &Length, CRYPTO_ASN1_OCTET_STRING)) {
+        return FALSE;
+      }
+      if (InternalSpdmIsOid (Oid, OidSize, OID_subjectAltName, sizeof(OID_subjectAltName))) {
+        CertView->SubjectAltName = Ptr;
+        CertView->SubjectAltNameSize = Length;
+      } else if (InternalSpdmIsOid (Oid, OidSize, OID_basicConstraints, sizeof(OID_basicConstraints))) {
+        CertView->BasicConstraints = Ptr;
+        CertView->BasicConstraintsSize = Length;
+      } else if (InternalSpdmIsOid (Oid, OidSize, OID_keyUsage, sizeof(OID_keyUsage))) {
+        CertView->KeyUsage = Ptr;
+        CertView->KeyUsageSize = Length;
+      } else if (InternalSpdmIsOid (Oid, OidSize, OID_subjectKeyIdentifier, sizeof(OID_subjectKeyIdentifier))) {
+        CertView->SubjectKeyIdentifier = Ptr;
+        CertView->SubjectKeyIdentifierSize = Length;
+      } else if (InternalSpdmIsOid (Oid, OidSize, OID_authorityKeyIdentifier, sizeof(OID_authorityKeyIdentifier))) {
+        CertView->AuthorityKeyIdentifier = Ptr;
+        CertView->AuthorityKeyIdentifierSize = Length;
+      } else if (InternalSpdmIsOid (Oid, OidSize, OID_nameConstraints, sizeof(OID_nameConstraints))) {
+        CertView->NameConstraints = Ptr;
+        CertView->NameConstraintsSize = Length;
+      } else if (Critical && !InternalSpdmIsOid (Oid, OidSize, OID_extKeyUsage, sizeof(OID_extKeyUsage))) {
+        CertView->OtherCriticalExtension = TRUE;
+      }
+      Ptr = ExtensionEnd;
+    }
+  }
+  Ptr = TbsEnd;
+
+  CertView->SignatureAlgorithm = Ptr;
+  if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  Ptr += Length;
+  CertView->SignatureAlgorithmSize = Ptr - CertView->SignatureAlgorithm;
+
+  if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_BIT_STRING) || (Length == 0)) {
+    return FALSE;
+  }
+  CertView->Signature = Ptr + 1;
+  CertView->SignatureSize = Length - 1;
+
+  CertView->FieldsParsed = TRUE;
+  return TRUE;
+}
+
+/**
+  Initialize the view of a certificate chain, by walking the chain once.
+
+  The walk stops at the first element which is not a certificate, as X509GetCertFromCertChain does.
+
+  @param[out] View               The view of the certificate chain.
+  @param[in]  CertChainData      The certificate chain data without SPDM_CERT_CHAIN header.
+  @param[in]  CertChainDataSize  Size in bytes of the certificate chain data.
+
+  @retval TRUE   The view is initialized.
+  @retval FALSE  The certificate chain data has no certificate.
+**/
+BOOLEAN
+EFIAPI
+SpdmCertChainViewInit (
+  OUT SPDM_CERT_CHAIN_VIEW         *View,
+  IN  UINT8                        *CertChainData,
+  IN  UINTN                        CertChainDataSize
+  )
+{
+  UINT8       *Ptr;
+  UINT8       *End;
+  UINT8       *Cert;
+  UINTN       Length;
+
+  ZeroMem (View, sizeof(SPDM_CERT_CHAIN_VIEW));
+  View->CertChainData = CertChainData;
+  View->CertChainDataSize = CertChainDataSize;
+  if (CertChainData == NULL) {
+    return FALSE;
+  }
+
+  Ptr = CertChainData;
+  End = CertChainData + CertChainDataSize;
+  while (TRUE) {
+    Cert = Ptr;
+    if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+      break;
+    }
+    Ptr += Length;
+    if (View->CertCount == 0) {
+      SpdmX509CertViewInit (&View->Root, Cert, Ptr - Cert);
+    }
+    SpdmX509CertViewInit (&View->Leaf, Cert, Ptr - Cert);
+    View->CertCount++;
+  }
+
+  return (BOOLEAN)(View->CertCount != 0);
+}
+
+/**
+  Get one certificate of the view of a certificate chain.
 
-  Ret = Asn1GetTag (
-    &Ptr, (UINT8 *)(Buffer + Length),
-    &ObjLen,
-    CRYPTO_ASN1_CONTEXT_SPECIFIC | CRYPTO_ASN1_CONSTRUCTED
-    );
-  Ret = Asn1GetTag (
-    &Ptr, (UINT8 *)(Buffer + Length),
-    &ObjLen,
-    CRYPTO_ASN1_UTF8_STRING);
-  if (!Ret) {
-    return RETURN_NOT_FOUND;
-  }
+  @param[in]  View             The view of the certificate chain.
+  @param[in]  CertIndex        Index of the certificate, 0 for the root and -1 for the leaf.
+  @param[out] Cert             The certificate at the index.
+  @param[out] CertSize         Size in bytes of the certificate.
 
-  if (*NameBufferSize < (UINTN)ObjLen + 1) {
-    *NameBufferSize = (UINTN)ObjLen + 1;
-    return RETURN_BUFFER_TOO_SMALL;
+  @retval TRUE   The certificate is returned.
+  @retval FALSE  The index is out of the chain.
+**/
+BOOLEAN
+EFIAPI
+SpdmCertChainViewGetCert (
+  IN  SPDM_CERT_CHAIN_VIEW         *View,
+  IN  INT32                        CertIndex,
+  OUT UINT8                        **Cert,
+  OUT UINTN                        *CertSize
+  )
+{
+  UINT8       *Ptr;
+  UINTN       Index;
+
+  if ((View->CertCount == 0) || (CertIndex < -1) || ((CertIndex >= 0) && ((UINTN)CertIndex >= View->CertCount))) {
+    return FALSE;
+  }
+  if (CertIndex == 0) {
+    *Cert = View->Root.Cert;
+    *CertSize = View->Root.CertSize;
+    return TRUE;
+  }
+  if ((CertIndex == -1) || ((UINTN)CertIndex == View->CertCount - 1)) {
+    *Cert = View->Leaf.Cert;
+    *CertSize = View->Leaf.CertSize;
+    return TRUE;
   }
 
-  if (NameBuffer != NULL) {
-    CopyMem (NameBuffer, Ptr, ObjLen);
-    *NameBufferSize = ObjLen + 1;
-    NameBuffer[ObjLen] = 0;
+  //
+  // The intermediate certificates are not recorded, walk to the one at the index.
+  // The walk cannot fail, the same certificates were walked by SpdmCertChainViewInit.
+  //
+  Ptr = View->Root.Cert + View->Root.CertSize;
+  for (Index = 1; ; Index++) {
+    *Cert = Ptr;
+    InternalSpdmDerGetTag (&Ptr, View->CertChainData + View->CertChainDataSize, CertSize, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED);
+    Ptr += *CertSize;
+    *CertSize = Ptr - *Cert;
+    if (Index == (UINTN)CertIndex) {
+      break;
+    }
   }
-  return RETURN_SUCCESS;
+  return TRUE;
 }
 
 /**
@@ -2112,23 +5221,599 @@ SpdmGetDMTFSubjectAltName (
   IN OUT  UINTN         *OidSize
   )
 {
-  RETURN_STATUS ReturnStatus;
-  UINTN ExtensionDataSize;
-  ExtensionDataSize = 0;
-  ReturnStatus = X509GetExtensionData(Cert, CertSize, (UINT8 *)OID_subjectAltName, sizeof (OID_subjectAltName), NULL, &ExtensionDataSize);
-  if (ReturnStatus != RETURN_BUFFER_TOO_SMALL) {
+  SPDM_X509_CERT_VIEW  CertView;
+
+  if ((Cert == NULL) || (CertSize <= 0) || (NameBufferSize == NULL) || (OidSize == NULL)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  //
+  // The subjectAltName is read in place in the certificate, it is not copied to NameBuffer first.
+  //
+  SpdmX509CertViewInit (&CertView, (UINT8 *)Cert, (UINTN)CertSize);
+  if (!SpdmX509CertViewParseFields (&CertView) || (CertView.SubjectAltName == NULL)) {
     return RETURN_NOT_FOUND;
   }
-  if (ExtensionDataSize > *NameBufferSize) {
-    *NameBufferSize = ExtensionDataSize;
+  if (CertView.SubjectAltNameSize > *NameBufferSize) {
+    *NameBufferSize = CertView.SubjectAltNameSize;
     return RETURN_BUFFER_TOO_SMALL;
   }
-  ReturnStatus = X509GetExtensionData(Cert, CertSize, (UINT8 *)OID_subjectAltName, sizeof (OID_subjectAltName), (UINT8 *)NameBuffer, NameBufferSize);
-  if (RETURN_ERROR(ReturnStatus)) {
-    return ReturnStatus;
+
+  return SpdmGetDMTFSubjectAltNameFromBytes(CertView.SubjectAltName, CertView.SubjectAltNameSize, NameBuffer, NameBufferSize, Oid, OidSize);
+}
+
+#if OPENSPDM_CERT_CHAIN_BATCH_VERIFY_SUPPORT == 1
+
+//
+// The number of certificate links whose signatures are verified in one SpdmAsymVerifyBatch.
+//
+#define SPDM_CERT_CHAIN_LINK_BATCH_SIZE  8
+
+//
+// The size in bytes of the r and s of a NIST P-521 ECDSA signature.
+//
+#define MAX_SPDM_ECDSA_SIGNATURE_SIZE    (66 * 2)
+
+STATIC CONST UINT8 OID_rsaEncryption[] = {
+  0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x01, 0x01
+};
+
+STATIC CONST UINT8 OID_sha256WithRSAEncryption[] = {
+  0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x01, 0x0B
+};
+
+STATIC CONST UINT8 OID_sha384WithRSAEncryption[] = {
+  0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x01, 0x0C
+};
+
+STATIC CONST UINT8 OID_sha512WithRSAEncryption[] = {
+  0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x01, 0x0D
+};
+
+STATIC CONST UINT8 OID_idEcPublicKey[] = {
+  0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x02, 0x01
+};
+
+STATIC CONST UINT8 OID_secp256r1[] = {
+  0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x03, 0x01, 0x07
+};
+
+STATIC CONST UINT8 OID_secp384r1[] = {
+  0x2B, 0x81, 0x04, 0x00, 0x22
+};
+
+STATIC CONST UINT8 OID_secp521r1[] = {
+  0x2B, 0x81, 0x04, 0x00, 0x23
+};
+
+STATIC CONST UINT8 OID_ecdsaWithSHA256[] = {
+  0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x04, 0x03, 0x02
+};
+
+STATIC CONST UINT8 OID_ecdsaWithSHA384[] = {
+  0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x04, 0x03, 0x03
+};
+
+STATIC CONST UINT8 OID_ecdsaWithSHA512[] = {
+  0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x04, 0x03, 0x04
+};
+
+//
+// The basicConstraints extnValue of a CA without pathLenConstraint: SEQUENCE { cA BOOLEAN TRUE }
+//
+STATIC CONST UINT8 BasicConstraintsCa[] = {
+  0x30, 0x03, 0x01, 0x01, 0xFF
+};
+
+/**
+  Return the SPDM BaseAsymAlgo of the key of a SubjectPublicKeyInfo.
+
+  @param[in]  SubjectPublicKeyInfo      The DER-encoded SubjectPublicKeyInfo.
+  @param[in]  SubjectPublicKeyInfoSize  Size in bytes of the SubjectPublicKeyInfo.
+  @param[out] BaseAsymAlgo              SPDM BaseAsymAlgo of the key.
+
+  @retval TRUE   The key is a RSA key of 2048, 3072 or 4096 bits, or a NIST P-256, P-384 or P-521 key,
+                 and the algorithm is supported.
+  @retval FALSE  The key is another one.
+**/
+STATIC
+BOOLEAN
+InternalSpdmX509GetKeyAsymAlgo (
+  IN  UINT8                        *SubjectPublicKeyInfo,
+  IN  UINTN                        SubjectPublicKeyInfoSize,
+  OUT UINT32                       *BaseAsymAlgo
+  )
+{
+  UINT8       *Ptr;
+  UINT8       *End;
+  UINT8       *AlgorithmEnd;
+  UINT8       *Oid;
+  UINTN       OidSize;
+  UINTN       Length;
+
+  //
+  // SubjectPublicKeyInfo ::= SEQUENCE { algorithm AlgorithmIdentifier, subjectPublicKey BIT STRING }
+  //
+  Ptr = SubjectPublicKeyInfo;
+  End = SubjectPublicKeyInfo + SubjectPublicKeyInfoSize;
+  if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  End = Ptr + Length;
+  if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  AlgorithmEnd = Ptr + Length;
+  if (!InternalSpdmDerGetTag (&Ptr, AlgorithmEnd, &OidSize, CRYPTO_ASN1_OID)) {
+    return FALSE;
+  }
+  Oid = Ptr;
+  Ptr += OidSize;
+
+  if (InternalSpdmIsOid (Oid, OidSize, OID_rsaEncryption, sizeof(OID_rsaEncryption))) {
+    //
+    // RSAPublicKey ::= SEQUENCE { modulus INTEGER, publicExponent INTEGER }
+    //
+    Ptr = AlgorithmEnd;
+    if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_BIT_STRING) || (Length == 0)) {
+      return FALSE;
+    }
+    Ptr++;
+    if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+      return FALSE;
+    }
+    if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_INTEGER)) {
+      return FALSE;
+    }
+    while ((Length > 0) && (*Ptr == 0)) {
+      Ptr++;
+      Length--;
+    }
+#if OPENSPDM_RSA_SSA_SUPPORT == 1
+    switch (Length) {
+    case 256:
+      *BaseAsymAlgo = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048;
+      return TRUE;
+    case 384:
+      *BaseAsymAlgo = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072;
+      return TRUE;
+    case 512:
+      *BaseAsymAlgo = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_4096;
+      return TRUE;
+    }
+#endif
+    return FALSE;
+  }
+
+#if OPENSPDM_ECDSA_SUPPORT == 1
+  if (InternalSpdmIsOid (Oid, OidSize, OID_idEcPublicKey, sizeof(OID_idEcPublicKey))) {
+    if (!InternalSpdmDerGetTag (&Ptr, AlgorithmEnd, &OidSize, CRYPTO_ASN1_OID)) {
+      return FALSE;
+    }
+    if (InternalSpdmIsOid (Ptr, OidSize, OID_secp256r1, sizeof(OID_secp256r1))) {
+      *BaseAsymAlgo = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256;
+      return TRUE;
+    }
+    if (InternalSpdmIsOid (Ptr, OidSize, OID_secp384r1, sizeof(OID_secp384r1))) {
+      *BaseAsymAlgo = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384;
+      return TRUE;
+    }
+    if (InternalSpdmIsOid (Ptr, OidSize, OID_secp521r1, sizeof(OID_secp521r1))) {
+      *BaseAsymAlgo = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521;
+      return TRUE;
+    }
+  }
+#endif
+
+  return FALSE;
+}
+
+/**
+  Return whether an SPDM BaseAsymAlgo is ECDSA.
+
+  @param[in]  BaseAsymAlgo     SPDM BaseAsymAlgo
+
+  @retval TRUE   The algorithm is ECDSA.
+  @retval FALSE  The algorithm is RSASSA.
+**/
+STATIC
+BOOLEAN
+InternalSpdmIsEcdsa (
+  IN UINT32                        BaseAsymAlgo
+  )
+{
+  return (BOOLEAN)((BaseAsymAlgo & (SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256 |
+                                    SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384 |
+                                    SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P521)) != 0);
+}
+
+/**
+  Return the SPDM BaseHashAlgo of the signatureAlgorithm of a certificate signed with a key.
+
+  @param[in]  SignatureAlgorithm      The DER-encoded signatureAlgorithm.
+  @param[in]  SignatureAlgorithmSize  Size in bytes of the signatureAlgorithm.
+  @param[in]  BaseAsymAlgo            SPDM BaseAsymAlgo of the key.
+  @param[out] BaseHashAlgo            SPDM BaseHashAlgo of the signature.
+
+  @retval TRUE   The signature is a PKCS#1 v1.5 signature of a RSA key, or an ECDSA signature of an EC key,
+                 with SHA-256, SHA-384 or SHA-512, and the hash algorithm is supported.
+  @retval FALSE  The signature is another one.
+**/
+STATIC
+BOOLEAN
+InternalSpdmX509GetSignatureHashAlgo (
+  IN  UINT8                        *SignatureAlgorithm,
+  IN  UINTN                        SignatureAlgorithmSize,
+  IN  UINT32                       BaseAsymAlgo,
+  OUT UINT32                       *BaseHashAlgo
+  )
+{
+  UINT8       *Ptr;
+  UINT8       *End;
+  UINT8       *Oid;
+  UINTN       OidSize;
+  UINTN       Length;
+  UINTN       Index;
+
+  Ptr = SignatureAlgorithm;
+  End = SignatureAlgorithm + SignatureAlgorithmSize;
+  if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  End = Ptr + Length;
+  if (!InternalSpdmDerGetTag (&Ptr, End, &OidSize, CRYPTO_ASN1_OID)) {
+    return FALSE;
+  }
+  Oid = Ptr;
+  Ptr += OidSize;
+
+  if (InternalSpdmIsEcdsa (BaseAsymAlgo)) {
+    //
+    // The ECDSA signature algorithms have no parameters.
+    //
+    if (Ptr != End) {
+      return FALSE;
+    }
+    if (InternalSpdmIsOid (Oid, OidSize, OID_ecdsaWithSHA256, sizeof(OID_ecdsaWithSHA256))) {
+      Index = 0;
+    } else if (InternalSpdmIsOid (Oid, OidSize, OID_ecdsaWithSHA384, sizeof(OID_ecdsaWithSHA384))) {
+      Index = 1;
+    } else if (InternalSpdmIsOid (Oid, OidSize, OID_ecdsaWithSHA512, sizeof(OID_ecdsaWithSHA512))) {
+      Index = 2;
+    } else {
+      return FALSE;
+    }
+  } else {
+    //
+    // The PKCS#1 v1.5 signature algorithms have NULL parameters.
+    //
+    if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_NULL) || (Length != 0) || (Ptr != End)) {
+      return FALSE;
+    }
+    if (InternalSpdmIsOid (Oid, OidSize, OID_sha256WithRSAEncryption, sizeof(OID_sha256WithRSAEncryption))) {
+      Index = 0;
+    } else if (InternalSpdmIsOid (Oid, OidSize, OID_sha384WithRSAEncryption, sizeof(OID_sha384WithRSAEncryption))) {
+      Index = 1;
+    } else if (InternalSpdmIsOid (Oid, OidSize, OID_sha512WithRSAEncryption, sizeof(OID_sha512WithRSAEncryption))) {
+      Index = 2;
+    } else {
+      return FALSE;
+    }
+  }
+
+  switch (Index) {
+  case 0:
+#if OPENSPDM_SHA256_SUPPORT == 1
+    *BaseHashAlgo = SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256;
+    return TRUE;
+#else
+    break;
+#endif
+  case 1:
+#if OPENSPDM_SHA384_SUPPORT == 1
+    *BaseHashAlgo = SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384;
+    return TRUE;
+#else
+    break;
+#endif
+  case 2:
+#if OPENSPDM_SHA512_SUPPORT == 1
+    *BaseHashAlgo = SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512;
+    return TRUE;
+#else
+    break;
+#endif
+  }
+  return FALSE;
+}
+
+/**
+  Convert the DER-encoded ECDSA signature of a certificate to the r and s of SPDM.
+
+  @param[in]  Signature        The DER-encoded Ecdsa-Sig-Value.
+  @param[in]  SignatureSize    Size in bytes of the Ecdsa-Sig-Value.
+  @param[out] RawSignature     The r and s, each of RawSignatureSize / 2 bytes.
+  @param[in]  RawSignatureSize Size in bytes of the r and s.
+
+  @retval TRUE   The signature is converted.
+  @retval FALSE  The signature is malformed, or r or s is too large.
+**/
+STATIC
+BOOLEAN
+InternalSpdmEcdsaSignatureFromDer (
+  IN  UINT8                        *Signature,
+  IN  UINTN                        SignatureSize,
+  OUT UINT8                        *RawSignature,
+  IN  UINTN                        RawSignatureSize
+  )
+{
+  UINT8       *Ptr;
+  UINT8       *End;
+  UINT8       *Integer;
+  UINTN       Length;
+  UINTN       HalfSize;
+  UINTN       Index;
+
+  //
+  // Ecdsa-Sig-Value ::= SEQUENCE { r INTEGER, s INTEGER }
+  //
+  Ptr = Signature;
+  End = Signature + SignatureSize;
+  if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED) || (Ptr + Length != End)) {
+    return FALSE;
+  }
+  HalfSize = RawSignatureSize / 2;
+  for (Index = 0; Index < 2; Index++) {
+    if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_INTEGER) || (Length == 0) || ((*Ptr & 0x80) != 0)) {
+      return FALSE;
+    }
+    Integer = Ptr;
+    Ptr += Length;
+    while ((Length > 0) && (*Integer == 0)) {
+      Integer++;
+      Length--;
+    }
+    if (Length > HalfSize) {
+      return FALSE;
+    }
+    ZeroMem (RawSignature + Index * HalfSize, HalfSize - Length);
+    CopyMem (RawSignature + Index * HalfSize + HalfSize - Length, Integer, Length);
+  }
+  return (BOOLEAN)(Ptr == End);
+}
+
+/**
+  Check that a certificate is issued by another one, except for the signature.
+
+  The checks are those of X509VerifyCertChain of both crypto backends, or stricter: the issuer name is
+  the same bytes as the subject name of the issuer, the issuer is a CA without path length constraint
+  nor name constraints, its key usage has keyCertSign, and the authority key identifier has only a key
+  identifier, which is the subject key identifier of the issuer. No other extension may be critical.
+
+  @param[in]  Issuer           The view of the issuer certificate.
+  @param[in]  Subject          The view of the issued certificate.
+
+  @retval TRUE   The certificate is issued by the issuer, if its signature is valid.
+  @retval FALSE  The certificate is not issued by the issuer, or the checks are not enough.
+**/
+STATIC
+BOOLEAN
+InternalSpdmX509CheckIssued (
+  IN SPDM_X509_CERT_VIEW           *Issuer,
+  IN SPDM_X509_CERT_VIEW           *Subject
+  )
+{
+  UINT8       *Ptr;
+  UINT8       *End;
+  UINT8       *KeyIdentifier;
+  UINTN       Length;
+  UINTN       KeyIdentifierSize;
+
+  if ((Subject->IssuerSize != Issuer->SubjectSize) ||
+      (CompareMem (Subject->Issuer, Issuer->Subject, Issuer->SubjectSize) != 0)) {
+    return FALSE;
+  }
+  if ((Subject->TbsSignatureAlgorithmSize != Subject->SignatureAlgorithmSize) ||
+      (CompareMem (Subject->TbsSignatureAlgorithm, Subject->SignatureAlgorithm, Subject->SignatureAlgorithmSize) != 0)) {
+    return FALSE;
+  }
+  if (Issuer->OtherCriticalExtension || Subject->OtherCriticalExtension || (Issuer->NameConstraints != NULL)) {
+    return FALSE;
+  }
+
+  if ((Issuer->BasicConstraintsSize != sizeof(BasicConstraintsCa)) ||
+      (CompareMem (Issuer->BasicConstraints, BasicConstraintsCa, sizeof(BasicConstraintsCa)) != 0)) {
+    return FALSE;
+  }
+
+  //
+  // KeyUsage ::= BIT STRING, keyCertSign is in the first octet after the unused bits octet.
+  //
+  if (Issuer->KeyUsage != NULL) {
+    Ptr = Issuer->KeyUsage;
+    End = Issuer->KeyUsage + Issuer->KeyUsageSize;
+    if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_BIT_STRING) || (Length < 2) ||
+        ((Ptr[1] & CRYPTO_X509_KU_KEY_CERT_SIGN) == 0)) {
+      return FALSE;
+    }
+  }
+
+  //
+  // AuthorityKeyIdentifier ::= SEQUENCE { keyIdentifier [0] IMPLICIT OPTIONAL, ... }
+  //
+  if (Subject->AuthorityKeyIdentifier != NULL) {
+    Ptr = Subject->AuthorityKeyIdentifier;
+    End = Subject->AuthorityKeyIdentifier + Subject->AuthorityKeyIdentifierSize;
+    if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED) || (Ptr + Length != End)) {
+      return FALSE;
+    }
+    if (Ptr != End) {
+      if (!InternalSpdmDerGetTag (&Ptr, End, &KeyIdentifierSize, CRYPTO_ASN1_CONTEXT_SPECIFIC | 0) ||
+          (Ptr + KeyIdentifierSize != End)) {
+        return FALSE;
+      }
+      KeyIdentifier = Ptr;
+      if (Issuer->SubjectKeyIdentifier != NULL) {
+        Ptr = Issuer->SubjectKeyIdentifier;
+        End = Issuer->SubjectKeyIdentifier + Issuer->SubjectKeyIdentifierSize;
+        if (!InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_OCTET_STRING) ||
+            (Length != KeyIdentifierSize) || (CompareMem (Ptr, KeyIdentifier, Length) != 0)) {
+          return FALSE;
+        }
+      }
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Verify the signature of each certificate of a chain with the key of the preceding certificate.
+
+  The links of the chain are extracted in one walk, and the signatures of SPDM_CERT_CHAIN_LINK_BATCH_SIZE links
+  are verified by one SpdmAsymVerifyBatch, which hashes their TBS certificates at once.
+  The root certificate is verified with its own key, as by X509VerifyCertChain.
+  The validity period is not checked, as by X509VerifyCertChain of the Openssl backend.
+
+  @param[in]  View             The view of the certificate chain.
+
+  @retval TRUE   Every link of the chain is verified.
+  @retval FALSE  A link is not verified, or its checks or its algorithms are not handled by InternalSpdmX509CheckIssued.
+**/
+STATIC
+BOOLEAN
+InternalSpdmVerifyCertChainLinks (
+  IN SPDM_CERT_CHAIN_VIEW          *View
+  )
+{
+  SPDM_X509_CERT_VIEW    Cert[SPDM_CERT_CHAIN_LINK_BATCH_SIZE + 1];
+  VOID                   *Key[SPDM_CERT_CHAIN_LINK_BATCH_SIZE];
+  UINT32                 BaseAsymAlgo[SPDM_CERT_CHAIN_LINK_BATCH_SIZE];
+  UINT32                 BaseHashAlgo[SPDM_CERT_CHAIN_LINK_BATCH_SIZE];
+  SPDM_ASYM_VERIFY_ITEM  Item[SPDM_CERT_CHAIN_LINK_BATCH_SIZE];
+  UINT8                  EcdsaSignature[SPDM_CERT_CHAIN_LINK_BATCH_SIZE][MAX_SPDM_ECDSA_SIGNATURE_SIZE];
+  UINT8                  *Ptr;
+  UINT8                  *End;
+  UINT8                  *CertStart;
+  UINTN                  Length;
+  UINTN                  Remaining;
+  UINTN                  Count;
+  UINTN                  Index;
+  UINTN                  Next;
+  BOOLEAN                Result;
+
+  ZeroMem (Key, sizeof(Key));
+  Result = FALSE;
+
+  //
+  // Cert[0] is the issuer of the first link of a batch, the root certificate for the first batch.
+  //
+  CopyMem (&Cert[0], &View->Root, sizeof(SPDM_X509_CERT_VIEW));
+  if (!SpdmX509CertViewParseFields (&Cert[0])) {
+    return FALSE;
+  }
+
+  Ptr = View->CertChainData;
+  End = View->CertChainData + View->CertChainDataSize;
+  for (Remaining = View->CertCount; Remaining > 0; Remaining -= Count) {
+    Count = MIN (Remaining, SPDM_CERT_CHAIN_LINK_BATCH_SIZE);
+    for (Index = 0; Index < Count; Index++) {
+      //
+      // The walk cannot fail, the same certificates were walked by SpdmCertChainViewInit.
+      //
+      CertStart = Ptr;
+      InternalSpdmDerGetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED);
+      Ptr += Length;
+      SpdmX509CertViewInit (&Cert[Index + 1], CertStart, Ptr - CertStart);
+      if (!SpdmX509CertViewParseFields (&Cert[Index + 1]) ||
+          !InternalSpdmX509CheckIssued (&Cert[Index], &Cert[Index + 1])) {
+        goto Done;
+      }
+
+      if (!InternalSpdmX509GetKeyAsymAlgo (Cert[Index].SubjectPublicKeyInfo, Cert[Index].SubjectPublicKeyInfoSize, &BaseAsymAlgo[Index]) ||
+          !InternalSpdmX509GetSignatureHashAlgo (Cert[Index + 1].SignatureAlgorithm, Cert[Index + 1].SignatureAlgorithmSize, BaseAsymAlgo[Index], &BaseHashAlgo[Index])) {
+        goto Done;
+      }
+      if (!SpdmAsymGetPublicKeyFromDer (BaseAsymAlgo[Index], Cert[Index].SubjectPublicKeyInfo, Cert[Index].SubjectPublicKeyInfoSize, &Key[Index])) {
+        Key[Index] = NULL;
+        goto Done;
+      }
+
+      Item[Index].Context = Key[Index];
+      Item[Index].Message = Cert[Index + 1].Tbs;
+      Item[Index].MessageSize = Cert[Index + 1].TbsSize;
+      if (InternalSpdmIsEcdsa (BaseAsymAlgo[Index])) {
+        Item[Index].SigSize = GetSpdmAsymSignatureSize (BaseAsymAlgo[Index]);
+        if (!InternalSpdmEcdsaSignatureFromDer (Cert[Index + 1].Signature, Cert[Index + 1].SignatureSize, EcdsaSignature[Index], Item[Index].SigSize)) {
+          goto Done;
+        }
+        Item[Index].Signature = EcdsaSignature[Index];
+      } else {
+        Item[Index].Signature = Cert[Index + 1].Signature;
+        Item[Index].SigSize = Cert[Index + 1].SignatureSize;
+      }
+    }
+
+    //
+    // The links of a chain usually have the same algorithms, each run of them is one batch.
+    //
+    for (Index = 0; Index < Count; Index = Next) {
+      for (Next = Index + 1; Next < Count; Next++) {
+        if ((BaseAsymAlgo[Next] != BaseAsymAlgo[Index]) || (BaseHashAlgo[Next] != BaseHashAlgo[Index])) {
+          break;
+        }
+      }
+      if (!SpdmAsymVerifyBatch (BaseAsymAlgo[Index], BaseHashAlgo[Index], &Item[Index], Next - Index, NULL)) {
+        goto Done;
+      }
+    }
+
+    for (Index = 0; Index < Count; Index++) {
+      SpdmAsymFree (BaseAsymAlgo[Index], Key[Index]);
+      Key[Index] = NULL;
+    }
+    //
+    // The last certificate of the batch is the issuer of the first link of the next batch.
+    //
+    CopyMem (&Cert[0], &Cert[Count], sizeof(SPDM_X509_CERT_VIEW));
+  }
+  Result = TRUE;
+
+Done:
+  for (Index = 0; Index < SPDM_CERT_CHAIN_LINK_BATCH_SIZE; Index++) {
+    if (Key[Index] != NULL) {
+      SpdmAsymFree (BaseAsymAlgo[Index], Key[Index]);
+    }
   }
+  return Result;
+}
+
+#endif
+
+/**
+  Verify that each certificate of a chain is issued by the preceding certificate.
+
+  @param[in]  View             The view of the certificate chain.
 
-  return SpdmGetDMTFSubjectAltNameFromBytes((CONST UINT8 *)NameBuffer, *NameBufferSize, NameBuffer, NameBufferSize, Oid, OidSize);
+  @retval TRUE   The certificate chain is verified.
+  @retval FALSE  The certificate chain is not verified.
+**/
+STATIC
+BOOLEAN
+InternalSpdmVerifyCertChain (
+  IN SPDM_CERT_CHAIN_VIEW          *View
+  )
+{
+#if OPENSPDM_CERT_CHAIN_BATCH_VERIFY_SUPPORT == 1
+  //
+  // A chain which is not verified by InternalSpdmVerifyCertChainLinks is verified again by X509VerifyCertChain,
+  // so that the result is the one of the crypto backend whenever the fast path cannot tell.
+  //
+  if (InternalSpdmVerifyCertChainLinks (View)) {
+    return TRUE;
+  }
+#endif
+  return X509VerifyCertChain (View->Root.Cert, View->Root.CertSize, View->CertChainData, View->CertChainDataSize);
 }
 
 /**
@@ -2147,32 +5832,27 @@ SpdmVerifyCertChainData (
   IN UINTN                        CertChainDataSize
   )
 {
-  UINT8                                     *RootCertBuffer;
-  UINTN                                     RootCertBufferSize;
-  UINT8                                     *LeafCertBuffer;
-  UINTN                                     LeafCertBufferSize;
+  SPDM_CERT_CHAIN_VIEW                      View;
 
   if (CertChainDataSize > MAX_UINT16 - (sizeof(SPDM_CERT_CHAIN) + MAX_HASH_SIZE)) {
     DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainData - FAIL (chain size too large) !!!\n"));
     return FALSE;
   }
 
-  if (!X509GetCertFromCertChain (CertChainData, CertChainDataSize, 0, &RootCertBuffer, &RootCertBufferSize)) {
+  //
+  // One walk of the chain finds both the root and the leaf certificate.
+  //
+  if (!SpdmCertChainViewInit (&View, CertChainData, CertChainDataSize)) {
     DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainData - FAIL (get root certificate failed)!!!\n"));
     return FALSE;
   }
 
-  if (!X509VerifyCertChain (RootCertBuffer, RootCertBufferSize, CertChainData, CertChainDataSize)) {
+  if (!InternalSpdmVerifyCertChain (&View)) {
     DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainData - FAIL (cert chain verify failed)!!!\n"));
     return FALSE;
   }
 
-  if (!X509GetCertFromCertChain (CertChainData, CertChainDataSize, -1, &LeafCertBuffer, &LeafCertBufferSize)) {
-    DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainData - FAIL (get leaf certificate failed)!!!\n"));
-    return FALSE;
-  }
-
-  if(!SpdmX509CertificateCheck (LeafCertBuffer, LeafCertBufferSize)) {
+  if(!SpdmX509CertificateCheck (View.Leaf.Cert, View.Leaf.CertSize)) {
     DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainData - FAIL (leaf certificate check failed)!!!\n"));
     return FALSE;
   }
@@ -2200,16 +5880,16 @@ SpdmVerifyCertificateChainBuffer (
 {
   UINT8                                     *CertChainData;
   UINTN                                     CertChainDataSize;
-  UINT8                                     *RootCertBuffer;
-  UINTN                                     RootCertBufferSize;
+  SPDM_CERT_CHAIN_VIEW                      View;
   UINTN                                     HashSize;
   UINT8                                     CalcRootCertHash[MAX_HASH_SIZE];
-  UINT8                                     *LeafCertBuffer;
-  UINTN                                     LeafCertBufferSize;
 
   HashSize = GetSpdmHashSize (BaseHashAlgo);
 
-  if (CertChainBufferSize > MAX_SPDM_MESSAGE_BUFFER_SIZE) {
+  //
+  // The Length of SPDM_CERT_CHAIN is 16 bits.
+  //
+  if (CertChainBufferSize > MAX_UINT16) {
     DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainBuffer - FAIL (buffer too large) !!!\n"));
     return FALSE;
   }
@@ -2221,28 +5901,23 @@ SpdmVerifyCertificateChainBuffer (
 
   CertChainData = (UINT8 *)CertChainBuffer + sizeof(SPDM_CERT_CHAIN) + HashSize;
   CertChainDataSize = CertChainBufferSize - sizeof(SPDM_CERT_CHAIN) - HashSize;
-  if (!X509GetCertFromCertChain (CertChainData, CertChainDataSize, 0, &RootCertBuffer, &RootCertBufferSize)) {
+  if (!SpdmCertChainViewInit (&View, CertChainData, CertChainDataSize)) {
     DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainBuffer - FAIL (get root certificate failed)!!!\n"));
     return FALSE;
   }
 
-  SpdmHashAll (BaseHashAlgo, RootCertBuffer, RootCertBufferSize, CalcRootCertHash);
+  SpdmHashAll (BaseHashAlgo, View.Root.Cert, View.Root.CertSize, CalcRootCertHash);
   if (CompareMem ((UINT8 *)CertChainBuffer + sizeof(SPDM_CERT_CHAIN), CalcRootCertHash, HashSize) != 0) {
     DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainBuffer - FAIL (cert root hash mismatch) !!!\n"));
     return FALSE;
   }
 
-  if (!X509VerifyCertChain (RootCertBuffer, RootCertBufferSize, CertChainData, CertChainDataSize)) {
+  if (!InternalSpdmVerifyCertChain (&View)) {
     DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainBuffer - FAIL (cert chain verify failed)!!!\n"));
     return FALSE;
   }
 
-  if (!X509GetCertFromCertChain (CertChainData, CertChainDataSize, -1, &LeafCertBuffer, &LeafCertBufferSize)) {
-    DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainBuffer - FAIL (get leaf certificate failed)!!!\n"));
-    return FALSE;
-  }
-
-  if(!SpdmX509CertificateCheck (LeafCertBuffer, LeafCertBufferSize)) {
+  if(!SpdmX509CertificateCheck (View.Leaf.Cert, View.Leaf.CertSize)) {
     DEBUG((DEBUG_INFO, "!!! VerifyCertificateChainBuffer - FAIL (leaf certificate check failed)!!!\n"));
     return FALSE;
   }
@@ -0,0 +1,103 @@
+/** @file
+  SPDM PCI IDE_KM library.
+  It runs the PCI IDE key management protocol as SPDM VENDOR_DEFINED messages of an SPDM session.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __SPDM_PCI_IDE_KM_LIB_INTERNAL_H__
+#define __SPDM_PCI_IDE_KM_LIB_INTERNAL_H__
+
+#include <Library/SpdmPciIdeKmLib.h>
+
+#pragma pack(1)
+
+//
+// The VENDOR_DEFINED message header before the IDE_KM object.
+//
+typedef struct {
+  SPDM_MESSAGE_HEADER  Header;
+  UINT16               StandardID;
+  UINT8                Len;
+  UINT16               VendorID;
+  UINT16               PayloadLength;
+  PCI_PROTOCOL_HEADER  PciProtocol;
+} SPDM_PCI_IDE_KM_MESSAGE_HEADER;
+
+//
+// KEY_PROG with its key and IFV.
+//
+typedef struct {
+  PCI_IDE_KM_KEY_PROG  KeyProg;
+  UINT8                Key[PCI_IDE_KM_KEY_SIZE];
+  UINT8                Ifv[PCI_IDE_KM_IFV_SIZE];
+} SPDM_PCI_IDE_KM_KEY_PROG_DATA;
+
+#pragma pack()
+
+//
+// The largest IDE_KM object sent or received.
+//
+#define SPDM_PCI_IDE_KM_MAX_OBJECT_SIZE  sizeof(SPDM_PCI_IDE_KM_KEY_PROG_DATA)
+
+//
+// Each stream has a Rx and a Tx key for each of its PR, NPR and CPL substreams.
+//
+#define SPDM_PCI_IDE_KM_KEYS_PER_STREAM  (PCI_IDE_KM_KEY_SUB_STREAM_COUNT * 2)
+
+/**
+  Build the IDE_KM object of the request of the given index in the pipeline.
+
+  @param  Context                      The context passed to SpdmPciIdeKmPipeline.
+  @param  Index                        The index of the request.
+  @param  Object                       The buffer to build the object in, of SPDM_PCI_IDE_KM_MAX_OBJECT_SIZE bytes.
+  @param  ObjectSize                   The size in bytes of the object.
+
+  @retval RETURN_SUCCESS               The object is built.
+  @retval others                       The object cannot be built.
+**/
+typedef
+RETURN_STATUS
+(*SPDM_PCI_IDE_KM_BUILD_REQUEST_FUNC) (
+  IN     VOID                 *Context,
+  IN     UINTN                Index,
+     OUT VOID                 *Object,
+     OUT UINTN                *ObjectSize
+  );
+
+/**
+  Check the IDE_KM object of the response to the request of the given index in the pipeline.
+
+  @param  Context                      The context passed to SpdmPciIdeKmPipeline.
+  @param  Index                        The index of the request.
+  @param  Object                       The IDE_KM object of the response.
+  @param  ObjectSize                   The size in bytes of the object.
+
+  @retval RETURN_SUCCESS               The response answers the request.
+  @retval RETURN_DEVICE_ERROR          The response does not answer the request.
+**/
+typedef
+RETURN_STATUS
+(*SPDM_PCI_IDE_KM_CHECK_RESPONSE_FUNC) (
+  IN     VOID                 *Context,
+  IN     UINTN                Index,
+  IN     VOID                 *Object,
+  IN     UINTN                ObjectSize
+  );
+
+//
+// The context of a pipeline of key objects: KEY_PROG, K_SET_GO or K_SET_STOP.
+//
+typedef struct {
+  UINT8                        ObjectId;
+  UINT8                        AckObjectId;
+  UINT8                        KeySet;
+  CONST SPDM_PCI_IDE_KM_STREAM *Stream;
+  // For KEY_PROG only.
+  UINT32                       BaseHashAlgo;
+  VOID                         *PrkHmacContext;
+} SPDM_PCI_IDE_KM_KEY_PIPELINE;
+
+#endif
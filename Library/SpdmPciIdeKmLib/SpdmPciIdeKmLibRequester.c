@@ -0,0 +1,550 @@
+/** @file
+  SPDM PCI IDE_KM library.
+  It runs the PCI IDE key management protocol as SPDM VENDOR_DEFINED messages of an SPDM session.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmPciIdeKmLibInternal.h"
+
+#define SPDM_PCI_IDE_KM_KEY_LABEL  "ide_km key"
+
+/**
+  Send an IDE_KM object in a VENDOR_DEFINED_REQUEST of the session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  Object                       The IDE_KM object.
+  @param  ObjectSize                   The size in bytes of the object.
+
+  @retval RETURN_SUCCESS               The request is sent.
+  @retval others                       The request cannot be sent.
+**/
+RETURN_STATUS
+SpdmPciIdeKmSendObject (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     VOID                 *Object,
+  IN     UINTN                ObjectSize
+  )
+{
+  UINT8                           Request[sizeof(SPDM_PCI_IDE_KM_MESSAGE_HEADER) + SPDM_PCI_IDE_KM_MAX_OBJECT_SIZE];
+  SPDM_PCI_IDE_KM_MESSAGE_HEADER  *Header;
+  RETURN_STATUS                   Status;
+
+  ASSERT (ObjectSize <= SPDM_PCI_IDE_KM_MAX_OBJECT_SIZE);
+
+  Header = (VOID *)Request;
+  Header->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+  Header->Header.RequestResponseCode = SPDM_VENDOR_DEFINED_REQUEST;
+  Header->Header.Param1 = 0;
+  Header->Header.Param2 = 0;
+  Header->StandardID = SPDM_STANDARD_ID_PCISIG;
+  Header->Len = sizeof(Header->VendorID);
+  Header->VendorID = SPDM_VENDOR_ID_PCISIG;
+  Header->PayloadLength = (UINT16)(sizeof(PCI_PROTOCOL_HEADER) + ObjectSize);
+  Header->PciProtocol.ProtocolId = PCI_PROTOCAL_ID_IDE_KM;
+  CopyMem (Header + 1, Object, ObjectSize);
+
+  Status = SpdmSendRequest (SpdmContext, &SessionId, FALSE, sizeof(SPDM_PCI_IDE_KM_MESSAGE_HEADER) + ObjectSize, Request);
+  //
+  // The request may hold a key.
+  //
+  ZeroMem (Request, sizeof(Request));
+  return Status;
+}
+
+/**
+  Receive an IDE_KM object in a VENDOR_DEFINED_RESPONSE of the session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  Object                       The buffer to receive the IDE_KM object, of SPDM_PCI_IDE_KM_MAX_OBJECT_SIZE bytes.
+  @param  ObjectSize                   The size in bytes of the object.
+
+  @retval RETURN_SUCCESS               An IDE_KM object is received.
+  @retval RETURN_DEVICE_ERROR          The response is not a PCI-SIG IDE_KM VENDOR_DEFINED_RESPONSE.
+  @retval others                       No response is received.
+**/
+RETURN_STATUS
+SpdmPciIdeKmReceiveObject (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               SessionId,
+     OUT VOID                 *Object,
+     OUT UINTN                *ObjectSize
+  )
+{
+  UINT8                           Response[sizeof(SPDM_PCI_IDE_KM_MESSAGE_HEADER) + SPDM_PCI_IDE_KM_MAX_OBJECT_SIZE];
+  UINTN                           ResponseSize;
+  SPDM_PCI_IDE_KM_MESSAGE_HEADER  *Header;
+  RETURN_STATUS                   Status;
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmReceiveResponse (SpdmContext, &SessionId, FALSE, &ResponseSize, Response);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  Header = (VOID *)Response;
+  if ((ResponseSize < sizeof(SPDM_PCI_IDE_KM_MESSAGE_HEADER) + sizeof(PCI_IDE_KM_HEADER)) ||
+      (Header->Header.RequestResponseCode != SPDM_VENDOR_DEFINED_RESPONSE) ||
+      (Header->StandardID != SPDM_STANDARD_ID_PCISIG) ||
+      (Header->Len != sizeof(Header->VendorID)) ||
+      (Header->VendorID != SPDM_VENDOR_ID_PCISIG) ||
+      (Header->PayloadLength != ResponseSize - OFFSET_OF(SPDM_PCI_IDE_KM_MESSAGE_HEADER, PciProtocol)) ||
+      (Header->PciProtocol.ProtocolId != PCI_PROTOCAL_ID_IDE_KM)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  *ObjectSize = ResponseSize - sizeof(SPDM_PCI_IDE_KM_MESSAGE_HEADER);
+  CopyMem (Object, Header + 1, *ObjectSize);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Send Count IDE_KM requests, with up to MaxOutstanding requests in flight.
+
+  The responder answers the requests of a session in order, so the next response
+  is checked against the oldest request in flight.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  Count                        The number of requests.
+  @param  MaxOutstanding               The maximum number of requests in flight.
+  @param  BuildRequest                 The function to build each request.
+  @param  CheckResponse                The function to check each response.
+  @param  Context                      The context passed to BuildRequest and CheckResponse.
+
+  @retval RETURN_SUCCESS               All requests are answered.
+  @retval others                       The status of the first request or response failing.
+**/
+RETURN_STATUS
+SpdmPciIdeKmPipeline (
+  IN     VOID                                 *SpdmContext,
+  IN     UINT32                               SessionId,
+  IN     UINTN                                Count,
+  IN     UINTN                                MaxOutstanding,
+  IN     SPDM_PCI_IDE_KM_BUILD_REQUEST_FUNC   BuildRequest,
+  IN     SPDM_PCI_IDE_KM_CHECK_RESPONSE_FUNC  CheckResponse,
+  IN     VOID                                 *Context
+  )
+{
+  UINT8          Object[SPDM_PCI_IDE_KM_MAX_OBJECT_SIZE];
+  UINTN          ObjectSize;
+  UINTN          SentCount;
+  UINTN          AnsweredCount;
+  RETURN_STATUS  Status;
+
+  SentCount = 0;
+  AnsweredCount = 0;
+  Status = RETURN_SUCCESS;
+  while (AnsweredCount < Count) {
+    while ((SentCount < Count) && (SentCount - AnsweredCount < MaxOutstanding)) {
+      Status = BuildRequest (Context, SentCount, Object, &ObjectSize);
+      if (!RETURN_ERROR(Status)) {
+        Status = SpdmPciIdeKmSendObject (SpdmContext, SessionId, Object, ObjectSize);
+      }
+      ZeroMem (Object, sizeof(Object));
+      if (RETURN_ERROR(Status)) {
+        return Status;
+      }
+      SentCount++;
+    }
+
+    Status = SpdmPciIdeKmReceiveObject (SpdmContext, SessionId, Object, &ObjectSize);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    Status = CheckResponse (Context, AnsweredCount, Object, ObjectSize);
+    if (RETURN_ERROR(Status)) {
+      DEBUG((DEBUG_INFO, "SpdmPciIdeKmPipeline[%x] - unexpected response to request %d\n", SessionId, AnsweredCount));
+      return Status;
+    }
+    AnsweredCount++;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Build the QUERY of the port of the given index.
+**/
+RETURN_STATUS
+SpdmPciIdeKmBuildQuery (
+  IN     VOID                 *Context,
+  IN     UINTN                Index,
+     OUT VOID                 *Object,
+     OUT UINTN                *ObjectSize
+  )
+{
+  PCI_IDE_KM_QUERY  *Query;
+
+  Query = Object;
+  ZeroMem (Query, sizeof(PCI_IDE_KM_QUERY));
+  Query->Header.ObjectId = PCI_IDE_KM_OBJECT_ID_QUERY;
+  Query->PortIndex = (UINT8)Index;
+  *ObjectSize = sizeof(PCI_IDE_KM_QUERY);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Check the QUERY_RESP of the port of the given index, and save it in the QUERY_RESP array.
+**/
+RETURN_STATUS
+SpdmPciIdeKmCheckQueryResp (
+  IN     VOID                 *Context,
+  IN     UINTN                Index,
+  IN     VOID                 *Object,
+  IN     UINTN                ObjectSize
+  )
+{
+  PCI_IDE_KM_QUERY_RESP  *QueryResp;
+
+  QueryResp = Object;
+  if ((ObjectSize < sizeof(PCI_IDE_KM_QUERY_RESP)) ||
+      (QueryResp->Header.ObjectId != PCI_IDE_KM_OBJECT_ID_QUERY_RESP) ||
+      (QueryResp->PortIndex != Index)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  CopyMem ((PCI_IDE_KM_QUERY_RESP *)Context + Index, QueryResp, sizeof(PCI_IDE_KM_QUERY_RESP));
+  return RETURN_SUCCESS;
+}
+
+/**
+  Query the IDE_KM ports of the device.
+
+  QUERY of port 0 returns the MaxPortIndex. The QUERY of the other ports are pipelined,
+  with up to MaxOutstanding requests in flight.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  MaxOutstanding               The maximum number of requests in flight. It must not be zero.
+  @param  PortCount                    On input, the number of entries in QueryResp.
+                                       On output, the number of ports of the device, which is MaxPortIndex + 1.
+  @param  QueryResp                    The QUERY_RESP of each port, indexed by PortIndex.
+
+  @retval RETURN_SUCCESS               All ports are queried.
+  @retval RETURN_INVALID_PARAMETER     MaxOutstanding is zero, or *PortCount is zero.
+  @retval RETURN_BUFFER_TOO_SMALL      *PortCount is too small. Only QueryResp[0] is returned.
+  @retval RETURN_DEVICE_ERROR          The response is not the QUERY_RESP of the port.
+  @retval others                       A request cannot be sent, or a response cannot be received.
+                                       The session should be ended, because the responses in flight are not received.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPciIdeKmQueryPorts (
+  IN     VOID                       *SpdmContext,
+  IN     UINT32                     SessionId,
+  IN     UINTN                      MaxOutstanding,
+  IN OUT UINTN                      *PortCount,
+     OUT PCI_IDE_KM_QUERY_RESP      *QueryResp
+  )
+{
+  RETURN_STATUS  Status;
+  UINTN          DevicePortCount;
+
+  if ((MaxOutstanding == 0) || (*PortCount == 0)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  //
+  // Only the QUERY_RESP of port 0 tells how many ports there are.
+  //
+  Status = SpdmPciIdeKmPipeline (SpdmContext, SessionId, 1, 1, SpdmPciIdeKmBuildQuery, SpdmPciIdeKmCheckQueryResp, QueryResp);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  DevicePortCount = (UINTN)QueryResp[0].MaxPortIndex + 1;
+  if (DevicePortCount > *PortCount) {
+    *PortCount = DevicePortCount;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *PortCount = DevicePortCount;
+
+  //
+  // Port 0 is queried again as request 0, so that the request index is the PortIndex.
+  //
+  if (DevicePortCount == 1) {
+    return RETURN_SUCCESS;
+  }
+  return SpdmPciIdeKmPipeline (
+           SpdmContext,
+           SessionId,
+           DevicePortCount,
+           MaxOutstanding,
+           SpdmPciIdeKmBuildQuery,
+           SpdmPciIdeKmCheckQueryResp,
+           QueryResp
+           );
+}
+
+/**
+  Return the KeySubStream of the key of the given index.
+
+  The keys of a stream are ordered as PR Rx, PR Tx, NPR Rx, NPR Tx, CPL Rx and CPL Tx.
+**/
+UINT8
+SpdmPciIdeKmGetKeySubStream (
+  IN     UINT8                KeySet,
+  IN     UINTN                Index
+  )
+{
+  UINTN  KeyIndex;
+
+  KeyIndex = Index % SPDM_PCI_IDE_KM_KEYS_PER_STREAM;
+  return (UINT8)(((KeyIndex / 2) << 4) |
+                 (((KeyIndex % 2) == 0) ? PCI_IDE_KM_KEY_DIRECTION_RX : PCI_IDE_KM_KEY_DIRECTION_TX) |
+                 KeySet);
+}
+
+/**
+  Build the KEY_PROG, K_SET_GO or K_SET_STOP of the key of the given index.
+  The key and IFV of KEY_PROG are derived from the ExportMasterSecret.
+**/
+RETURN_STATUS
+SpdmPciIdeKmBuildKeyObject (
+  IN     VOID                 *Context,
+  IN     UINTN                Index,
+     OUT VOID                 *Object,
+     OUT UINTN                *ObjectSize
+  )
+{
+  SPDM_PCI_IDE_KM_KEY_PIPELINE   *Pipeline;
+  CONST SPDM_PCI_IDE_KM_STREAM   *Stream;
+  SPDM_PCI_IDE_KM_KEY_PROG_DATA  *KeyProgData;
+  UINT8                          Info[sizeof(SPDM_PCI_IDE_KM_KEY_LABEL) - 1 + 3];
+  BOOLEAN                        Result;
+
+  Pipeline = Context;
+  Stream = &Pipeline->Stream[Index / SPDM_PCI_IDE_KM_KEYS_PER_STREAM];
+
+  //
+  // KEY_PROG, K_SET_GO and K_SET_STOP share the same layout before the key.
+  //
+  KeyProgData = Object;
+  ZeroMem (&KeyProgData->KeyProg, sizeof(PCI_IDE_KM_KEY_PROG));
+  KeyProgData->KeyProg.Header.ObjectId = Pipeline->ObjectId;
+  KeyProgData->KeyProg.StreamId = Stream->StreamId;
+  KeyProgData->KeyProg.KeySubStream = SpdmPciIdeKmGetKeySubStream (Pipeline->KeySet, Index);
+  KeyProgData->KeyProg.PortIndex = Stream->PortIndex;
+  if (Pipeline->ObjectId != PCI_IDE_KM_OBJECT_ID_KEY_PROG) {
+    *ObjectSize = sizeof(PCI_IDE_KM_K_SET_GO);
+    return RETURN_SUCCESS;
+  }
+
+  CopyMem (Info, SPDM_PCI_IDE_KM_KEY_LABEL, sizeof(SPDM_PCI_IDE_KM_KEY_LABEL) - 1);
+  Info[sizeof(SPDM_PCI_IDE_KM_KEY_LABEL) - 1] = KeyProgData->KeyProg.PortIndex;
+  Info[sizeof(SPDM_PCI_IDE_KM_KEY_LABEL)] = KeyProgData->KeyProg.StreamId;
+  Info[sizeof(SPDM_PCI_IDE_KM_KEY_LABEL) + 1] = KeyProgData->KeyProg.KeySubStream;
+  Result = SpdmHkdfExpandWithContext (
+             Pipeline->BaseHashAlgo,
+             Pipeline->PrkHmacContext,
+             Info,
+             sizeof(Info),
+             KeyProgData->Key,
+             sizeof(KeyProgData->Key) + sizeof(KeyProgData->Ifv)
+             );
+  if (!Result) {
+    return RETURN_DEVICE_ERROR;
+  }
+  *ObjectSize = sizeof(SPDM_PCI_IDE_KM_KEY_PROG_DATA);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Check the KP_ACK or K_GOSTOP_ACK of the key of the given index.
+**/
+RETURN_STATUS
+SpdmPciIdeKmCheckKeyAck (
+  IN     VOID                 *Context,
+  IN     UINTN                Index,
+  IN     VOID                 *Object,
+  IN     UINTN                ObjectSize
+  )
+{
+  SPDM_PCI_IDE_KM_KEY_PIPELINE  *Pipeline;
+  CONST SPDM_PCI_IDE_KM_STREAM  *Stream;
+  PCI_IDE_KM_KP_ACK             *Ack;
+
+  Pipeline = Context;
+  Stream = &Pipeline->Stream[Index / SPDM_PCI_IDE_KM_KEYS_PER_STREAM];
+
+  //
+  // KP_ACK and K_GOSTOP_ACK share the same layout.
+  //
+  Ack = Object;
+  if ((ObjectSize < sizeof(PCI_IDE_KM_KP_ACK)) ||
+      (Ack->Header.ObjectId != Pipeline->AckObjectId) ||
+      (Ack->StreamId != Stream->StreamId) ||
+      (Ack->KeySubStream != SpdmPciIdeKmGetKeySubStream (Pipeline->KeySet, Index)) ||
+      (Ack->PortIndex != Stream->PortIndex)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Program one key set of the IDE streams, and start to use it.
+
+  A KEY_PROG is sent for the Rx and Tx key of each PR, NPR and CPL substream of each stream.
+  The K_SET_GO are sent once all KP_ACK are received. Both are pipelined, with up to MaxOutstanding
+  requests in flight.
+
+  The keys and IFVs are derived from the ExportMasterSecret of the session with HKDF-Expand,
+  with the label "ide_km key" followed by the PortIndex, StreamId and KeySubStream.
+  Programming the same key set of the same stream again in the session programs the same keys.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  KeySet                       The key set to program, 0 or 1.
+  @param  Stream                       The streams to program.
+  @param  StreamCount                  The number of streams.
+  @param  MaxOutstanding               The maximum number of requests in flight. It must not be zero.
+
+  @retval RETURN_SUCCESS               All keys are programmed and in use.
+  @retval RETURN_INVALID_PARAMETER     KeySet is out of range, StreamCount is zero, or MaxOutstanding is zero.
+  @retval RETURN_NOT_FOUND             The session is not found.
+  @retval RETURN_DEVICE_ERROR          A response is not the acknowledgement of its request, or a key cannot be derived.
+  @retval others                       A request cannot be sent, or a response cannot be received.
+                                       The session should be ended, because the responses in flight are not received.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPciIdeKmProgramStreams (
+  IN     VOID                       *SpdmContext,
+  IN     UINT32                     SessionId,
+  IN     UINT8                      KeySet,
+  IN     CONST SPDM_PCI_IDE_KM_STREAM *Stream,
+  IN     UINTN                      StreamCount,
+  IN     UINTN                      MaxOutstanding
+  )
+{
+  SPDM_PCI_IDE_KM_KEY_PIPELINE  Pipeline;
+  SPDM_DATA_PARAMETER           Parameter;
+  VOID                          *SecuredMessageContext;
+  UINT8                         ExportMasterSecret[MAX_HASH_SIZE];
+  UINTN                         ExportMasterSecretSize;
+  UINTN                         DataSize;
+  RETURN_STATUS                 Status;
+
+  if (((KeySet & ~PCI_IDE_KM_KEY_SET_MASK) != 0) || (StreamCount == 0) || (MaxOutstanding == 0)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  SecuredMessageContext = SpdmGetSecuredMessageContextViaSessionId (SpdmContext, SessionId);
+  if (SecuredMessageContext == NULL) {
+    return RETURN_NOT_FOUND;
+  }
+
+  ZeroMem (&Pipeline, sizeof(Pipeline));
+  Pipeline.KeySet = KeySet;
+  Pipeline.Stream = Stream;
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationConnection;
+  DataSize = sizeof(Pipeline.BaseHashAlgo);
+  Status = SpdmGetData (SpdmContext, SpdmDataBaseHashAlgo, &Parameter, &Pipeline.BaseHashAlgo, &DataSize);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  //
+  // The ExportMasterSecret is keyed into one HMAC context shared by all keys.
+  //
+  ExportMasterSecretSize = sizeof(ExportMasterSecret);
+  Status = SpdmSecuredMessageExportMasterSecret (SecuredMessageContext, ExportMasterSecret, &ExportMasterSecretSize);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Pipeline.PrkHmacContext = SpdmHmacNewWithKey (Pipeline.BaseHashAlgo, ExportMasterSecret, ExportMasterSecretSize);
+  ZeroMem (ExportMasterSecret, sizeof(ExportMasterSecret));
+  if (Pipeline.PrkHmacContext == NULL) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  Pipeline.ObjectId = PCI_IDE_KM_OBJECT_ID_KEY_PROG;
+  Pipeline.AckObjectId = PCI_IDE_KM_OBJECT_ID_KP_ACK;
+  Status = SpdmPciIdeKmPipeline (
+             SpdmContext,
+             SessionId,
+             StreamCount * SPDM_PCI_IDE_KM_KEYS_PER_STREAM,
+             MaxOutstanding,
+             SpdmPciIdeKmBuildKeyObject,
+             SpdmPciIdeKmCheckKeyAck,
+             &Pipeline
+             );
+  SpdmHmacFree (Pipeline.BaseHashAlgo, Pipeline.PrkHmacContext);
+  Pipeline.PrkHmacContext = NULL;
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  //
+  // A key set can only be used once all its keys are programmed.
+  //
+  Pipeline.ObjectId = PCI_IDE_KM_OBJECT_ID_K_SET_GO;
+  Pipeline.AckObjectId = PCI_IDE_KM_OBJECT_ID_K_SET_GOSTOP_ACK;
+  return SpdmPciIdeKmPipeline (
+           SpdmContext,
+           SessionId,
+           StreamCount * SPDM_PCI_IDE_KM_KEYS_PER_STREAM,
+           MaxOutstanding,
+           SpdmPciIdeKmBuildKeyObject,
+           SpdmPciIdeKmCheckKeyAck,
+           &Pipeline
+           );
+}
+
+/**
+  Stop to use one key set of the IDE streams.
+
+  A K_SET_STOP is sent for the Rx and Tx key of each PR, NPR and CPL substream of each stream.
+  They are pipelined, with up to MaxOutstanding requests in flight.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  KeySet                       The key set to stop, 0 or 1.
+  @param  Stream                       The streams to stop.
+  @param  StreamCount                  The number of streams.
+  @param  MaxOutstanding               The maximum number of requests in flight. It must not be zero.
+
+  @retval RETURN_SUCCESS               The key set of all streams is stopped.
+  @retval RETURN_INVALID_PARAMETER     KeySet is out of range, StreamCount is zero, or MaxOutstanding is zero.
+  @retval RETURN_DEVICE_ERROR          A response is not the acknowledgement of its request.
+  @retval others                       A request cannot be sent, or a response cannot be received.
+                                       The session should be ended, because the responses in flight are not received.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPciIdeKmStopStreams (
+  IN     VOID                       *SpdmContext,
+  IN     UINT32                     SessionId,
+  IN     UINT8                      KeySet,
+  IN     CONST SPDM_PCI_IDE_KM_STREAM *Stream,
+  IN     UINTN                      StreamCount,
+  IN     UINTN                      MaxOutstanding
+  )
+{
+  SPDM_PCI_IDE_KM_KEY_PIPELINE  Pipeline;
+
+  if (((KeySet & ~PCI_IDE_KM_KEY_SET_MASK) != 0) || (StreamCount == 0) || (MaxOutstanding == 0)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  ZeroMem (&Pipeline, sizeof(Pipeline));
+  Pipeline.ObjectId = PCI_IDE_KM_OBJECT_ID_K_SET_STOP;
+  Pipeline.AckObjectId = PCI_IDE_KM_OBJECT_ID_K_SET_GOSTOP_ACK;
+  Pipeline.KeySet = KeySet;
+  Pipeline.Stream = Stream;
+  return SpdmPciIdeKmPipeline (
+           SpdmContext,
+           SessionId,
+           StreamCount * SPDM_PCI_IDE_KM_KEYS_PER_STREAM,
+           MaxOutstanding,
+           SpdmPciIdeKmBuildKeyObject,
+           SpdmPciIdeKmCheckKeyAck,
+           &Pipeline
+           );
+}
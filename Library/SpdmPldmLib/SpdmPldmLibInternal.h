@@ -0,0 +1,59 @@
+/** @file
+  SPDM PLDM library.
+  It runs PLDM over MCTP as the APP message of an SPDM session.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __SPDM_PLDM_LIB_INTERNAL_H__
+#define __SPDM_PLDM_LIB_INTERNAL_H__
+
+#include <Library/SpdmPldmLib.h>
+#include <IndustryStandard/MctpBinding.h>
+#include <IndustryStandard/Pldm.h>
+
+#pragma pack(1)
+
+//
+// The APP message of PLDM over MCTP.
+//
+typedef struct {
+  MCTP_MESSAGE_HEADER          MctpHeader;
+  PLDM_MESSAGE_HEADER          PldmHeader;
+} SPDM_PLDM_REQUEST_HEADER;
+
+typedef struct {
+  MCTP_MESSAGE_HEADER          MctpHeader;
+  PLDM_MESSAGE_HEADER          PldmHeader;
+  PLDM_MESSAGE_RESPONSE_HEADER PldmResponseHeader;
+} SPDM_PLDM_RESPONSE_HEADER;
+
+#pragma pack()
+
+//
+// A request in flight, indexed by its PLDM instance ID.
+//
+typedef struct {
+  BOOLEAN                      InFlight;
+  UINT8                        PldmType;
+  UINT8                        PldmCommandCode;
+  SPDM_PLDM_COMPLETION_FUNC    CompletionFunc;
+  VOID                         *CompletionContext;
+} SPDM_PLDM_REQUEST_ENTRY;
+
+typedef struct {
+  VOID                         *SpdmContext;
+  UINT32                       SessionId;
+  UINTN                        MaxOutstanding;
+  UINTN                        OutstandingCount;
+  // The instance ID the next request starts to look for a free one from,
+  // so that an instance ID is not reused right after its request completes.
+  UINT8                        NextInstanceId;
+  SPDM_PLDM_REQUEST_ENTRY      Request[PLDM_INSTANCE_ID_COUNT];
+  // The APP message sent or received.
+  UINT8                        Message[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+} SPDM_PLDM_REQUESTER;
+
+#endif
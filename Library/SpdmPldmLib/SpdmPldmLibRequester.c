@@ -0,0 +1,327 @@
+/** @file
+  SPDM PLDM library.
+  It runs PLDM over MCTP as the APP message of an SPDM session.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmPldmLibInternal.h"
+
+/**
+  Return the size in bytes of a PLDM requester.
+
+  @return the size in bytes of the PLDM requester.
+**/
+UINTN
+EFIAPI
+SpdmPldmRequesterGetSize (
+  VOID
+  )
+{
+  return sizeof(SPDM_PLDM_REQUESTER);
+}
+
+/**
+  Initialize a PLDM requester for an SPDM session.
+
+  The size in bytes of the requester can be returned by SpdmPldmRequesterGetSize.
+  The PLDM messages are sent and received as the APP messages of the session, with an MCTP message header.
+  Each outstanding request holds one PLDM instance ID, so that up to MaxOutstanding requests can be in flight,
+  and the responses are routed back to the requests by the instance ID.
+  The functions of one requester must not be called concurrently.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  MaxOutstanding               The maximum number of requests in flight, from 1 to PLDM_INSTANCE_ID_COUNT.
+
+  @retval RETURN_SUCCESS               The requester is initialized.
+  @retval RETURN_INVALID_PARAMETER     MaxOutstanding is out of range.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPldmRequesterInit (
+     OUT VOID                 *PldmRequester,
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINTN                MaxOutstanding
+  )
+{
+  SPDM_PLDM_REQUESTER  *Requester;
+
+  if ((MaxOutstanding == 0) || (MaxOutstanding > PLDM_INSTANCE_ID_COUNT)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Requester = PldmRequester;
+  ZeroMem (Requester, sizeof(SPDM_PLDM_REQUESTER));
+  Requester->SpdmContext = SpdmContext;
+  Requester->SessionId = SessionId;
+  Requester->MaxOutstanding = MaxOutstanding;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Send a PLDM request without waiting for its response.
+
+  The response is received by SpdmPldmProcessResponse, which calls CompletionFunc.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+  @param  PldmType                     The PLDM type of the request.
+  @param  PldmCommandCode              The PLDM command code of the request.
+  @param  RequestData                  A pointer to the request data after the PLDM message header.
+  @param  RequestDataSize              Size in bytes of the request data.
+  @param  CompletionFunc               The function to complete the request.
+  @param  CompletionContext            The context passed to CompletionFunc.
+  @param  InstanceId                   The PLDM instance ID of the request, if it is sent.
+
+  @retval RETURN_SUCCESS               The request is sent.
+  @retval RETURN_INVALID_PARAMETER     PldmType is out of range, or CompletionFunc is NULL.
+  @retval RETURN_BAD_BUFFER_SIZE       The request does not fit in an APP message.
+  @retval RETURN_NOT_READY             MaxOutstanding requests are in flight.
+                                       A response must be processed by SpdmPldmProcessResponse first.
+  @retval others                       The request cannot be sent, and it is not in flight.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPldmSendRequest (
+  IN     VOID                       *PldmRequester,
+  IN     UINT8                      PldmType,
+  IN     UINT8                      PldmCommandCode,
+  IN     VOID                       *RequestData OPTIONAL,
+  IN     UINTN                      RequestDataSize,
+  IN     SPDM_PLDM_COMPLETION_FUNC  CompletionFunc,
+  IN     VOID                       *CompletionContext OPTIONAL,
+     OUT UINT8                      *InstanceId OPTIONAL
+  )
+{
+  SPDM_PLDM_REQUESTER        *Requester;
+  SPDM_PLDM_REQUEST_HEADER   *Header;
+  SPDM_PLDM_REQUEST_ENTRY    *Entry;
+  RETURN_STATUS              Status;
+  UINT8                      Index;
+  UINT8                      FreeInstanceId;
+
+  Requester = PldmRequester;
+
+  if (((PldmType & ~PLDM_HEADER_TYPE_MASK) != 0) || (CompletionFunc == NULL)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (RequestDataSize > sizeof(Requester->Message) - sizeof(SPDM_PLDM_REQUEST_HEADER)) {
+    return RETURN_BAD_BUFFER_SIZE;
+  }
+  if (Requester->OutstandingCount >= Requester->MaxOutstanding) {
+    return RETURN_NOT_READY;
+  }
+
+  //
+  // There is a free instance ID, because MaxOutstanding does not exceed PLDM_INSTANCE_ID_COUNT.
+  //
+  FreeInstanceId = Requester->NextInstanceId;
+  for (Index = 0; Index < PLDM_INSTANCE_ID_COUNT; Index++) {
+    FreeInstanceId = (UINT8)((Requester->NextInstanceId + Index) & PLDM_HEADER_INSTANCE_ID_MASK);
+    if (!Requester->Request[FreeInstanceId].InFlight) {
+      break;
+    }
+  }
+  ASSERT (Index < PLDM_INSTANCE_ID_COUNT);
+
+  Header = (VOID *)Requester->Message;
+  Header->MctpHeader.MessageType = MCTP_MESSAGE_TYPE_PLDM;
+  Header->PldmHeader.InstanceID = PLDM_HEADER_REQUEST | FreeInstanceId;
+  Header->PldmHeader.PldmType = PldmType;
+  Header->PldmHeader.PldmCommandCode = PldmCommandCode;
+  if (RequestDataSize != 0) {
+    CopyMem (Header + 1, RequestData, RequestDataSize);
+  }
+
+  Status = SpdmSendRequest (Requester->SpdmContext, &Requester->SessionId, TRUE, sizeof(SPDM_PLDM_REQUEST_HEADER) + RequestDataSize, Requester->Message);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  Entry = &Requester->Request[FreeInstanceId];
+  Entry->InFlight = TRUE;
+  Entry->PldmType = PldmType;
+  Entry->PldmCommandCode = PldmCommandCode;
+  Entry->CompletionFunc = CompletionFunc;
+  Entry->CompletionContext = CompletionContext;
+  Requester->OutstandingCount++;
+  Requester->NextInstanceId = (UINT8)((FreeInstanceId + 1) & PLDM_HEADER_INSTANCE_ID_MASK);
+
+  if (InstanceId != NULL) {
+    *InstanceId = FreeInstanceId;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Receive one PLDM response, and complete the request it answers.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+
+  @retval RETURN_SUCCESS               A response is received, and its request is completed.
+  @retval RETURN_NOT_STARTED           No request is in flight.
+  @retval RETURN_NOT_FOUND             A message is received, but it is not a PLDM response to a request in flight.
+                                       It is dropped.
+  @retval others                       No response is received.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPldmProcessResponse (
+  IN     VOID                 *PldmRequester
+  )
+{
+  SPDM_PLDM_REQUESTER        *Requester;
+  SPDM_PLDM_RESPONSE_HEADER  *Header;
+  SPDM_PLDM_REQUEST_ENTRY    *Entry;
+  SPDM_PLDM_REQUEST_ENTRY    Completed;
+  RETURN_STATUS              Status;
+  UINTN                      MessageSize;
+  UINT8                      InstanceId;
+
+  Requester = PldmRequester;
+
+  if (Requester->OutstandingCount == 0) {
+    return RETURN_NOT_STARTED;
+  }
+
+  MessageSize = sizeof(Requester->Message);
+  Status = SpdmReceiveResponse (Requester->SpdmContext, &Requester->SessionId, TRUE, &MessageSize, Requester->Message);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  Header = (VOID *)Requester->Message;
+  if ((MessageSize < sizeof(SPDM_PLDM_RESPONSE_HEADER)) ||
+      (Header->MctpHeader.MessageType != MCTP_MESSAGE_TYPE_PLDM) ||
+      ((Header->PldmHeader.InstanceID & (PLDM_HEADER_REQUEST | PLDM_HEADER_DATAGRAM)) != 0)) {
+    DEBUG((DEBUG_INFO, "SpdmPldmProcessResponse[%x] - not a PLDM response\n", Requester->SessionId));
+    return RETURN_NOT_FOUND;
+  }
+
+  InstanceId = Header->PldmHeader.InstanceID & PLDM_HEADER_INSTANCE_ID_MASK;
+  Entry = &Requester->Request[InstanceId];
+  if ((!Entry->InFlight) ||
+      (Entry->PldmType != (Header->PldmHeader.PldmType & PLDM_HEADER_TYPE_MASK)) ||
+      (Entry->PldmCommandCode != Header->PldmHeader.PldmCommandCode)) {
+    DEBUG((DEBUG_INFO, "SpdmPldmProcessResponse[%x] - no request for InstanceID 0x%x\n", Requester->SessionId, InstanceId));
+    return RETURN_NOT_FOUND;
+  }
+
+  //
+  // The instance ID is released before the completion, so that the completion may send the next request.
+  //
+  CopyMem (&Completed, Entry, sizeof(Completed));
+  Entry->InFlight = FALSE;
+  Requester->OutstandingCount--;
+
+  Completed.CompletionFunc (
+              Completed.CompletionContext,
+              RETURN_SUCCESS,
+              InstanceId,
+              Completed.PldmType,
+              Completed.PldmCommandCode,
+              Header->PldmResponseHeader.PldmCompletionCode,
+              MessageSize - sizeof(SPDM_PLDM_RESPONSE_HEADER),
+              Header + 1
+              );
+  return RETURN_SUCCESS;
+}
+
+/**
+  Receive PLDM responses until no request is in flight.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+
+  @retval RETURN_SUCCESS               No request is in flight.
+  @retval others                       The status of the first SpdmPldmProcessResponse failing to receive a response.
+                                       The requests not completed are still in flight.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPldmRequesterFlush (
+  IN     VOID                 *PldmRequester
+  )
+{
+  SPDM_PLDM_REQUESTER  *Requester;
+  RETURN_STATUS        Status;
+
+  Requester = PldmRequester;
+
+  while (Requester->OutstandingCount != 0) {
+    Status = SpdmPldmProcessResponse (Requester);
+    //
+    // A stray response is dropped, and the next one is received.
+    //
+    if (Status == RETURN_NOT_FOUND) {
+      continue;
+    }
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Complete all requests in flight with RETURN_ABORTED, and release their instance IDs.
+
+  It is used when the session ends or the responses are lost.
+  A late response to an aborted request is dropped by SpdmPldmProcessResponse, unless its instance ID
+  is held by a new request again. The instance IDs are used in turn to make it unlikely.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+**/
+VOID
+EFIAPI
+SpdmPldmRequesterAbort (
+  IN     VOID                 *PldmRequester
+  )
+{
+  SPDM_PLDM_REQUESTER        *Requester;
+  SPDM_PLDM_REQUEST_ENTRY    *Entry;
+  UINT8                      InstanceId;
+
+  Requester = PldmRequester;
+
+  for (InstanceId = 0; InstanceId < PLDM_INSTANCE_ID_COUNT; InstanceId++) {
+    Entry = &Requester->Request[InstanceId];
+    if (!Entry->InFlight) {
+      continue;
+    }
+    Entry->InFlight = FALSE;
+    Requester->OutstandingCount--;
+    Entry->CompletionFunc (
+             Entry->CompletionContext,
+             RETURN_ABORTED,
+             InstanceId,
+             Entry->PldmType,
+             Entry->PldmCommandCode,
+             PLDM_BASE_CODE_ERROR,
+             0,
+             NULL
+             );
+  }
+}
+
+/**
+  Return the number of requests in flight.
+
+  @param  PldmRequester                A pointer to the PLDM requester.
+
+  @return the number of requests in flight.
+**/
+UINTN
+EFIAPI
+SpdmPldmRequesterGetOutstandingCount (
+  IN     VOID                 *PldmRequester
+  )
+{
+  SPDM_PLDM_REQUESTER  *Requester;
+
+  Requester = PldmRequester;
+  return Requester->OutstandingCount;
+}
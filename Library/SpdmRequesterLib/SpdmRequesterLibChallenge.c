@@ -24,50 +24,31 @@ typedef struct {
 #pragma pack()
 
 /**
-  This function sends CHALLENGE
-  to authenticate the device based upon the key in one slot.
-
-  This function verifies the signature in the challenge auth.
-
-  If basic mutual authentication is requested from the responder,
-  this function also perform the basic mutual authentication.
+  This function builds CHALLENGE.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SlotNum                      The number of slot for the challenge.
   @param  MeasurementHashType          The type of the measurement hash.
-  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
-
-  @retval RETURN_SUCCESS               The challenge auth is got successfully.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
-  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the CHALLENGE request.
+  @param  Request                      A pointer to a destination buffer to store the CHALLENGE request.
+
+  @retval RETURN_SUCCESS               The CHALLENGE request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state or the capabilities do not allow CHALLENGE.
+  @retval RETURN_INVALID_PARAMETER     The slot number is invalid.
 **/
 RETURN_STATUS
-TrySpdmChallenge (
-  IN     VOID                 *Context,
+SpdmBuildChallengeRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
   IN     UINT8                SlotNum,
   IN     UINT8                MeasurementHashType,
-     OUT VOID                 *MeasurementHash
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
   )
 {
-  RETURN_STATUS                             Status;
-  BOOLEAN                                   Result;
-  SPDM_CHALLENGE_REQUEST                    SpdmRequest;
-  SPDM_CHALLENGE_AUTH_RESPONSE_MAX          SpdmResponse;
-  UINTN                                     SpdmResponseSize;
-  UINT8                                     *Ptr;
-  VOID                                      *CertChainHash;
-  UINTN                                     HashSize;
-  UINTN                                     MeasurementSummaryHashSize;
-  VOID                                      *ServerNonce;
-  VOID                                      *MeasurementSummaryHash;
-  UINT16                                    OpaqueLength;
-  VOID                                      *Opaque;
-  VOID                                      *Signature;
-  UINTN                                     SignatureSize;
-  SPDM_DEVICE_CONTEXT                       *SpdmContext;
-  SPDM_CHALLENGE_AUTH_RESPONSE_ATTRIBUTE    AuthAttribute;
+  SPDM_CHALLENGE_REQUEST                    *SpdmRequest;
 
-  SpdmContext = Context;
   if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP)) {
     return RETURN_UNSUPPORTED;
   }
@@ -78,73 +59,159 @@ TrySpdmChallenge (
   if ((SlotNum >= MAX_SPDM_SLOT_COUNT) && (SlotNum != 0xFF)) {
     return RETURN_INVALID_PARAMETER;
   }
-  if ((SlotNum == 0xFF) && (SpdmContext->LocalContext.PeerCertChainProvisionSize == 0)) {
+  if ((SlotNum == 0xFF) &&
+      (SpdmContext->LocalContext.PeerCertChainProvisionSize == 0) &&
+      (SpdmContext->LocalContext.PeerPublicKeyProvisionSize == 0)) {
     return RETURN_INVALID_PARAMETER;
   }
 
+  if (*RequestSize < sizeof(SPDM_CHALLENGE_REQUEST)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SpdmRequest = Request;
+
   SpdmContext->ErrorState = SPDM_STATUS_ERROR_DEVICE_NO_CAPABILITIES;
 
   if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11)) {
-    SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+    SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
   } else {
-    SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
-  }
-  SpdmRequest.Header.RequestResponseCode = SPDM_CHALLENGE;
-  SpdmRequest.Header.Param1 = SlotNum;
-  SpdmRequest.Header.Param2 = MeasurementHashType;
-  SpdmGetRandomNumber (SPDM_NONCE_SIZE, SpdmRequest.Nonce);
-  DEBUG((DEBUG_INFO, "ClientNonce - "));
-  InternalDumpData (SpdmRequest.Nonce, SPDM_NONCE_SIZE);
-  DEBUG((DEBUG_INFO, "\n"));
-  Status = SpdmSendSpdmRequest (SpdmContext, NULL, sizeof(SpdmRequest), &SpdmRequest);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
+    SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+  }
+  SpdmRequest->Header.RequestResponseCode = SPDM_CHALLENGE;
+  SpdmRequest->Header.Param1 = SlotNum;
+  SpdmRequest->Header.Param2 = MeasurementHashType;
+  SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, SPDM_NONCE_SIZE, SpdmRequest->Nonce);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "ClientNonce - "));
+    InternalDumpData (SpdmRequest->Nonce, SPDM_NONCE_SIZE);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
+  *RequestSize = sizeof(SPDM_CHALLENGE_REQUEST);
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function commits a CHALLENGE_AUTH once its signature is verified.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  MeasurementSummaryHash       The measurement summary hash in the CHALLENGE_AUTH.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+**/
+VOID
+SpdmCommitChallengeAuth (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementHashType,
+  IN     VOID                 *MeasurementSummaryHash,
+     OUT VOID                 *MeasurementHash
+  )
+{
+  SpdmContext->ErrorState = SPDM_STATUS_SUCCESS;
+
+  if (MeasurementHash != NULL) {
+    CopyMem (MeasurementHash, MeasurementSummaryHash, SpdmGetMeasurementSummaryHashSize (SpdmContext, TRUE, MeasurementHashType));
   }
+  SpdmMeasurementCacheRecordSummaryHash (SpdmContext, MeasurementHashType, MeasurementSummaryHash);
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  SpdmCommitEvidence (SpdmContext, SPDM_EVIDENCE_TYPE_CHALLENGE_AUTH);
+#endif
+}
+
+/**
+  This function processes the response to a sent CHALLENGE, and verifies the signature in the challenge auth.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the challenge.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  RequestSize                  Size in bytes of the sent CHALLENGE request.
+  @param  Request                      A pointer to the sent CHALLENGE request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+  @param  BasicMutAuthRequested        Indicates if basic mutual authentication is requested from the responder.
+  @param  Deferred                     TRUE to verify the signature with the asynchronous verification functions.
+                                       If the verification is pending, the response is kept in the pending challenge
+                                       of the SPDM context, and committed by SpdmCompleteChallenge.
+
+  @retval RETURN_SUCCESS               The CHALLENGE_AUTH is received and verified.
+  @retval RETURN_NOT_READY             The CHALLENGE_AUTH is received, and its signature verification is pending.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid CHALLENGE_AUTH.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmProcessChallengeAuthResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                SlotNum,
+  IN     UINT8                MeasurementHashType,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response,
+     OUT VOID                 *MeasurementHash,
+     OUT BOOLEAN              *BasicMutAuthRequested,
+  IN     BOOLEAN              Deferred
+  )
+{
+  RETURN_STATUS                             Status;
+  BOOLEAN                                   Result;
+  SPDM_CHALLENGE_AUTH_RESPONSE_MAX          *SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+  UINT8                                     *Ptr;
+  VOID                                      *CertChainHash;
+  UINTN                                     HashSize;
+  UINTN                                     MeasurementSummaryHashSize;
+  VOID                                      *ServerNonce;
+  VOID                                      *MeasurementSummaryHash;
+  UINT16                                    OpaqueLength;
+  VOID                                      *Opaque;
+  VOID                                      *Signature;
+  UINTN                                     SignatureSize;
+  SPDM_CHALLENGE_AUTH_RESPONSE_ATTRIBUTE    AuthAttribute;
+  SPDM_PENDING_CHALLENGE                    *PendingChallenge;
+
+  SpdmResponse = Response;
+  SpdmResponseSize = ResponseSize;
 
   //
   // Cache data
   //
-  Status = SpdmAppendMessageC (SpdmContext, &SpdmRequest, sizeof(SpdmRequest));
+  Status = SpdmAppendMessageC (SpdmContext, Request, RequestSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
-  SpdmResponseSize = sizeof(SpdmResponse);
-  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
   if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-    Status = SpdmHandleErrorResponseMain(SpdmContext, NULL, &SpdmContext->Transcript.MessageC, sizeof(SpdmRequest), &SpdmResponseSize, &SpdmResponse, SPDM_CHALLENGE, SPDM_CHALLENGE_AUTH, sizeof(SPDM_CHALLENGE_AUTH_RESPONSE_MAX));
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
+    Status = SpdmHandleErrorResponseMain(SpdmContext, NULL, &SpdmContext->Transcript.MessageC, RequestSize, &SpdmResponseSize, SpdmResponse, SPDM_CHALLENGE, SPDM_CHALLENGE_AUTH, sizeof(SPDM_CHALLENGE_AUTH_RESPONSE_MAX));
     if (RETURN_ERROR(Status)) {
       return Status;
     }
-  } else if (SpdmResponse.Header.RequestResponseCode != SPDM_CHALLENGE_AUTH) {
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_CHALLENGE_AUTH) {
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponseSize < sizeof(SPDM_CHALLENGE_AUTH_RESPONSE)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponseSize > sizeof(SpdmResponse)) {
+  if (SpdmResponseSize > sizeof(SPDM_CHALLENGE_AUTH_RESPONSE_MAX)) {
     return RETURN_DEVICE_ERROR;
   }
-  *(UINT8 *)&AuthAttribute = SpdmResponse.Header.Param1;
+  *(UINT8 *)&AuthAttribute = SpdmResponse->Header.Param1;
   if (SlotNum == 0xFF) {
     if (AuthAttribute.SlotNum != 0xF) {
       return RETURN_DEVICE_ERROR;
     }
-    if (SpdmResponse.Header.Param2 != 0) {
+    if (SpdmResponse->Header.Param2 != 0) {
       return RETURN_DEVICE_ERROR;
     }
   } else {
     if (AuthAttribute.SlotNum != SlotNum) {
       return RETURN_DEVICE_ERROR;
     }
-    if (SpdmResponse.Header.Param2 != (1 << SlotNum)) {
+    if (SpdmResponse->Header.Param2 != (1 << SlotNum)) {
       return RETURN_DEVICE_ERROR;
     }
   }
@@ -165,13 +232,15 @@ TrySpdmChallenge (
     return RETURN_DEVICE_ERROR;
   }
 
-  Ptr = SpdmResponse.CertChainHash;
+  Ptr = SpdmResponse->CertChainHash;
 
   CertChainHash = Ptr;
   Ptr += HashSize;
-  DEBUG((DEBUG_INFO, "CertChainHash (0x%x) - ", HashSize));
-  InternalDumpData (CertChainHash, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_CERT)) {
+    DEBUG((DEBUG_INFO, "CertChainHash (0x%x) - ", HashSize));
+    InternalDumpData (CertChainHash, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
   Result = SpdmVerifyCertificateChainHash (SpdmContext, CertChainHash, HashSize);
   if (!Result) {
     SpdmContext->ErrorState = SPDM_STATUS_ERROR_CERTIFICATE_FAILURE;
@@ -179,16 +248,20 @@ TrySpdmChallenge (
   }
 
   ServerNonce = Ptr;
-  DEBUG((DEBUG_INFO, "ServerNonce (0x%x) - ", SPDM_NONCE_SIZE));
-  InternalDumpData (ServerNonce, SPDM_NONCE_SIZE);
-  DEBUG((DEBUG_INFO, "\n"));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "ServerNonce (0x%x) - ", SPDM_NONCE_SIZE));
+    InternalDumpData (ServerNonce, SPDM_NONCE_SIZE);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
   Ptr += SPDM_NONCE_SIZE;
 
   MeasurementSummaryHash = Ptr;
   Ptr += MeasurementSummaryHashSize;
-  DEBUG((DEBUG_INFO, "MeasurementSummaryHash (0x%x) - ", MeasurementSummaryHashSize));
-  InternalDumpData (MeasurementSummaryHash, MeasurementSummaryHashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "MeasurementSummaryHash (0x%x) - ", MeasurementSummaryHashSize));
+    InternalDumpData (MeasurementSummaryHash, MeasurementSummaryHashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   OpaqueLength = *(UINT16 *)Ptr;
   if (OpaqueLength > MAX_SPDM_OPAQUE_DATA_SIZE) {
@@ -212,32 +285,70 @@ TrySpdmChallenge (
                      sizeof(UINT16) +
                      OpaqueLength +
                      SignatureSize;
-  Status = SpdmAppendMessageC (SpdmContext, &SpdmResponse, SpdmResponseSize - SignatureSize);
+  Status = SpdmAppendMessageC (SpdmContext, SpdmResponse, SpdmResponseSize - SignatureSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
   Opaque = Ptr;
   Ptr += OpaqueLength;
-  DEBUG((DEBUG_INFO, "Opaque (0x%x):\n", OpaqueLength));
-  InternalDumpHex (Opaque, OpaqueLength);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Opaque (0x%x):\n", OpaqueLength));
+    InternalDumpHex (Opaque, OpaqueLength);
+  }
 
   Signature = Ptr;
-  DEBUG((DEBUG_INFO, "Signature (0x%x):\n", SignatureSize));
-  InternalDumpHex (Signature, SignatureSize);
-  Result = SpdmVerifyChallengeAuthSignature (SpdmContext, TRUE, Signature, SignatureSize);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Signature (0x%x):\n", SignatureSize));
+    InternalDumpHex (Signature, SignatureSize);
+  }
+  *BasicMutAuthRequested = (BOOLEAN)(AuthAttribute.BasicMutAuthReq == 1);
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+  SpdmCaptureEvidence (SpdmContext, SPDM_EVIDENCE_TYPE_CHALLENGE_AUTH, SpdmResponseSize - SignatureSize, Signature, SignatureSize);
+#endif
+  if (Deferred) {
+    PendingChallenge = &SpdmContext->PendingChallenge;
+    Status = SpdmStartVerifyChallengeAuthSignature (SpdmContext, Signature, SignatureSize, &PendingChallenge->Verify);
+    if (Status == RETURN_NOT_READY) {
+      PendingChallenge->Valid = TRUE;
+      PendingChallenge->MeasurementHashType = MeasurementHashType;
+      PendingChallenge->BasicMutAuthRequested = *BasicMutAuthRequested;
+      PendingChallenge->MeasurementHash = MeasurementHash;
+      CopyMem (PendingChallenge->MeasurementSummaryHash, MeasurementSummaryHash, MeasurementSummaryHashSize);
+      return RETURN_NOT_READY;
+    }
+    Result = (BOOLEAN)!RETURN_ERROR(Status);
+  } else {
+    Result = SpdmVerifyChallengeAuthSignature (SpdmContext, TRUE, Signature, SignatureSize);
+  }
   if (!Result) {
     SpdmContext->ErrorState = SPDM_STATUS_ERROR_CERTIFICATE_FAILURE;
     return RETURN_SECURITY_VIOLATION;
   }
 
-  SpdmContext->ErrorState = SPDM_STATUS_SUCCESS;
+  SpdmCommitChallengeAuth (SpdmContext, MeasurementHashType, MeasurementSummaryHash, MeasurementHash);
+  return RETURN_SUCCESS;
+}
 
-  if (MeasurementHash != NULL) {
-    CopyMem (MeasurementHash, MeasurementSummaryHash, MeasurementSummaryHashSize);
-  }
+/**
+  This function performs the basic mutual authentication if it is requested, once a CHALLENGE_AUTH is verified,
+  and authenticates the connection.
 
-  if (AuthAttribute.BasicMutAuthReq == 1) {
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  BasicMutAuthRequested        Indicates if basic mutual authentication is requested from the responder.
+
+  @retval RETURN_SUCCESS               The connection is authenticated.
+  @retval RETURN_SECURITY_VIOLATION    The basic mutual authentication fails.
+**/
+RETURN_STATUS
+SpdmChallengeMutAuth (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     BOOLEAN              BasicMutAuthRequested
+  )
+{
+  RETURN_STATUS                             Status;
+
+  if (BasicMutAuthRequested) {
     DEBUG((DEBUG_INFO, "BasicMutAuth :\n"));
     Status = SpdmEncapsulatedRequest (SpdmContext, NULL, 0, NULL);
     DEBUG ((DEBUG_INFO, "SpdmChallenge - SpdmEncapsulatedRequest - %p\n", Status));
@@ -252,6 +363,69 @@ TrySpdmChallenge (
   return RETURN_SUCCESS;
 }
 
+/**
+  This function sends CHALLENGE
+  to authenticate the device based upon the key in one slot.
+
+  This function verifies the signature in the challenge auth.
+
+  If basic mutual authentication is requested from the responder,
+  this function also perform the basic mutual authentication.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the challenge.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+  @param  Deferred                     TRUE to verify the signature with the asynchronous verification functions.
+
+  @retval RETURN_SUCCESS               The challenge auth is got successfully.
+  @retval RETURN_NOT_READY             The challenge auth is got, and its signature verification is pending.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+TrySpdmChallenge (
+  IN     VOID                 *Context,
+  IN     UINT8                SlotNum,
+  IN     UINT8                MeasurementHashType,
+     OUT VOID                 *MeasurementHash,
+  IN     BOOLEAN              Deferred
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_CHALLENGE_REQUEST                    SpdmRequest;
+  UINTN                                     SpdmRequestSize;
+  SPDM_CHALLENGE_AUTH_RESPONSE_MAX          SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+  BOOLEAN                                   BasicMutAuthRequested;
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+
+  SpdmContext = Context;
+
+  SpdmRequestSize = sizeof(SpdmRequest);
+  Status = SpdmBuildChallengeRequest (SpdmContext, SlotNum, MeasurementHashType, &SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  SpdmResponseSize = sizeof(SpdmResponse);
+  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  Status = SpdmProcessChallengeAuthResponse (SpdmContext, SlotNum, MeasurementHashType, SpdmRequestSize, &SpdmRequest, SpdmResponseSize, &SpdmResponse, MeasurementHash, &BasicMutAuthRequested, Deferred);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  return SpdmChallengeMutAuth (SpdmContext, BasicMutAuthRequested);
+}
+
 /**
   This function sends CHALLENGE
   to authenticate the device based upon the key in one slot.
@@ -286,7 +460,58 @@ SpdmChallenge (
   SpdmContext = Context;
   Retry = SpdmContext->RetryTimes;
   do {
-    Status = TrySpdmChallenge(SpdmContext, SlotNum, MeasurementHashType, MeasurementHash);
+    Status = TrySpdmChallenge(SpdmContext, SlotNum, MeasurementHashType, MeasurementHash, FALSE);
+    if (RETURN_NO_RESPONSE != Status) {
+      return Status;
+    }
+  } while (Retry-- != 0);
+
+  return Status;
+}
+
+
+/**
+  This function sends CHALLENGE to authenticate the device based upon the key in one slot,
+  and returns without waiting for the signature verification.
+
+  Once the asynchronous verification functions are registered with SpdmRegisterRequesterVerifyAsyncFunc,
+  the signature in the challenge auth is verified while the caller sends other requests, for example to
+  another device. The challenge auth is then committed by SpdmCompleteChallenge, which also performs the
+  basic mutual authentication if it is requested. No other request is sent on this connection until then.
+  Without the asynchronous verification functions, this function is the same as SpdmChallenge.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the challenge.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+                                       It is written by SpdmCompleteChallenge if the verification is pending.
+
+  @retval RETURN_SUCCESS               The challenge auth is got and verified successfully.
+  @retval RETURN_NOT_READY             The challenge auth is got, and its signature verification is pending.
+  @retval RETURN_ALREADY_STARTED       A challenge is pending already.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmStartChallenge (
+  IN     VOID                 *Context,
+  IN     UINT8                SlotNum,
+  IN     UINT8                MeasurementHashType,
+     OUT VOID                 *MeasurementHash
+  )
+{
+  SPDM_DEVICE_CONTEXT    *SpdmContext;
+  UINTN                   Retry;
+  RETURN_STATUS           Status;
+
+  SpdmContext = Context;
+  if (SpdmContext->PendingChallenge.Valid) {
+    return RETURN_ALREADY_STARTED;
+  }
+  Retry = SpdmContext->RetryTimes;
+  do {
+    Status = TrySpdmChallenge(SpdmContext, SlotNum, MeasurementHashType, MeasurementHash, TRUE);
     if (RETURN_NO_RESPONSE != Status) {
       return Status;
     }
@@ -295,3 +520,46 @@ SpdmChallenge (
   return Status;
 }
 
+/**
+  This function completes a challenge started by SpdmStartChallenge.
+
+  Once the signature in the challenge auth is verified, the measurement hash is returned,
+  the basic mutual authentication is performed if it is requested, and the connection is authenticated.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Wait                         TRUE to wait until the signature verification is completed.
+
+  @retval RETURN_SUCCESS               The challenge auth is verified, and the connection is authenticated.
+  @retval RETURN_NOT_READY             The signature verification is still pending. It is not returned if Wait is TRUE.
+  @retval RETURN_NOT_STARTED           No challenge is pending.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmCompleteChallenge (
+  IN     VOID                 *Context,
+  IN     BOOLEAN              Wait
+  )
+{
+  SPDM_DEVICE_CONTEXT    *SpdmContext;
+  SPDM_PENDING_CHALLENGE *PendingChallenge;
+  RETURN_STATUS           Status;
+
+  SpdmContext = Context;
+  PendingChallenge = &SpdmContext->PendingChallenge;
+  if (!PendingChallenge->Valid) {
+    return RETURN_NOT_STARTED;
+  }
+  Status = SpdmPollVerifySignature (SpdmContext, &PendingChallenge->Verify, Wait);
+  if (Status == RETURN_NOT_READY) {
+    return RETURN_NOT_READY;
+  }
+  PendingChallenge->Valid = FALSE;
+  if (RETURN_ERROR(Status)) {
+    SpdmContext->ErrorState = SPDM_STATUS_ERROR_CERTIFICATE_FAILURE;
+    return RETURN_SECURITY_VIOLATION;
+  }
+
+  SpdmCommitChallengeAuth (SpdmContext, PendingChallenge->MeasurementHashType, PendingChallenge->MeasurementSummaryHash, PendingChallenge->MeasurementHash);
+  return SpdmChallengeMutAuth (SpdmContext, PendingChallenge->BasicMutAuthRequested);
+}
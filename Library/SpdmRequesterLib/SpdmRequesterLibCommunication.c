@@ -16,6 +16,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
   Before this function, the requester configuration data can be set via SpdmSetData.
   After this function, the negotiated configuration data can be got via SpdmGetData.
 
+  If the negotiated state is imported by SpdmImportNegotiatedState and the connection is still negotiated,
+  no message is sent, because the responder preserved the negotiated state.
+
   @param  SpdmContext                  A pointer to the SPDM context.
 
   @retval RETURN_SUCCESS               The connection is initialized successfully.
@@ -33,6 +36,13 @@ SpdmInitConnection (
 
   SpdmContext = Context;
 
+  if (SpdmContext->ConnectionInfo.NegotiatedStateImported) {
+    SpdmContext->ConnectionInfo.NegotiatedStateImported = FALSE;
+    if (SpdmContext->ConnectionInfo.ConnectionState >= SpdmConnectionStateNegotiated) {
+      return RETURN_SUCCESS;
+    }
+  }
+
   Status = SpdmGetVersion (SpdmContext);
   if (RETURN_ERROR(Status)) {
     return Status;
@@ -70,6 +80,7 @@ SpdmInitConnection (
   @retval RETURN_SUCCESS               The SPDM session is started.
   @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
   @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval RETURN_UNSUPPORTED           UsePsk is TRUE and OPENSPDM_PSK_CAP_SUPPORT is 0.
 **/
 RETURN_STATUS
 EFIAPI
@@ -106,6 +117,7 @@ SpdmStartSession (
     switch (SessionInfo->MutAuthRequested) {
     case 0:
       break;
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
     case SPDM_KEY_EXCHANGE_RESPONSE_MUT_AUTH_REQUESTED:
       break;
     case SPDM_KEY_EXCHANGE_RESPONSE_MUT_AUTH_REQUESTED_WITH_ENCAP_REQUEST:
@@ -116,6 +128,7 @@ SpdmStartSession (
         return Status;
       }
       break;
+#endif
     default:
       DEBUG ((DEBUG_INFO, "SpdmStartSession - unknown MutAuthRequested - 0x%x\n", SessionInfo->MutAuthRequested));
       return RETURN_UNSUPPORTED;
@@ -127,6 +140,7 @@ SpdmStartSession (
     Status = SpdmSendReceiveFinish (SpdmContext, *SessionId, ReqSlotIdParam);
     DEBUG ((DEBUG_INFO, "SpdmStartSession - SpdmSendReceiveFinish - %p\n", Status));
   } else {
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
     Status = SpdmSendReceivePskExchange (SpdmContext, MeasurementHashType, SessionId, HeartbeatPeriod, MeasurementHash);
     if (RETURN_ERROR(Status)) {
       DEBUG ((DEBUG_INFO, "SpdmStartSession - SpdmSendReceivePskExchange - %p\n", Status));
@@ -138,6 +152,9 @@ SpdmStartSession (
       Status = SpdmSendReceivePskFinish (SpdmContext, *SessionId);
       DEBUG ((DEBUG_INFO, "SpdmStartSession - SpdmSendReceivePskFinish - %p\n", Status));
     }
+#else
+    Status = RETURN_UNSUPPORTED;
+#endif
   }
   return Status;
 }
@@ -217,6 +234,13 @@ SpdmSendReceiveData (
 
   SpdmContext = Context;
 
+  if (SessionId != NULL) {
+    Status = SpdmKeyUpdateByPolicy (SpdmContext, *SessionId);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+  }
+
   Status = SpdmSendRequest (SpdmContext, SessionId, IsAppMessage, RequestSize, Request);
   if (RETURN_ERROR(Status)) {
     return RETURN_DEVICE_ERROR;
@@ -229,3 +253,111 @@ SpdmSendReceiveData (
 
   return RETURN_SUCCESS;
 }
+
+/**
+  Return the room that SpdmSendReceiveDataStream needs around the APP messages of a session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  Headroom                     Size in bytes of the room before the APP message.
+  @param  Tailroom                     Size in bytes of the room after the APP message.
+
+  @retval RETURN_SUCCESS               The room is returned successfully.
+  @retval RETURN_UNSUPPORTED           The transport layer cannot encode the APP message in place.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetDataStreamRoom (
+  IN     VOID                 *Context,
+  IN     UINT32               SessionId,
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  )
+{
+  SPDM_DEVICE_CONTEXT           *SpdmContext;
+  RETURN_STATUS                 Status;
+
+  SpdmContext = Context;
+
+  if (SpdmContext->TransportPath[0].TransportGetMessageRoom == NULL) {
+    return RETURN_UNSUPPORTED;
+  }
+  Status = SpdmContext->TransportPath[0].TransportGetMessageRoom (SpdmContext, &SessionId, TRUE, Headroom, Tailroom);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_UNSUPPORTED;
+  }
+  //
+  // The record data overwritten by a header or a tail is saved in a small buffer while the record is in flight.
+  //
+  if ((*Headroom > MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE) || (*Tailroom > MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE)) {
+    return RETURN_UNSUPPORTED;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Send and receive an APP message of a session, in chained records encoded in place in the caller buffers.
+
+  Unlike SpdmSendReceiveData, the APP messages are not staged in a MAX_SPDM_MESSAGE_BUFFER_SIZE buffer,
+  so they can be larger than it.
+  An APP message is sent as consecutive records of RecordSize bytes, and ends with a record of less than
+  RecordSize bytes. An APP message of a multiple of RecordSize bytes ends with an empty record.
+  The response is received the same way.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  RecordSize                   Size in bytes of the APP message in each full record.
+  @param  Request                      A pointer to the request buffer of Headroom + RequestSize + Tailroom bytes,
+                                       with the request at Headroom bytes.
+                                       The request buffer is overwritten by the records sent.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Response                     A pointer to the response buffer.
+                                       On output, the response is at Headroom bytes.
+  @param  ResponseSize                 On input, it means the size in bytes of the response buffer.
+                                       On output, it means the size in bytes of the response.
+
+  @retval RETURN_SUCCESS               The APP message is sent and received successfully.
+  @retval RETURN_INVALID_PARAMETER     The RecordSize is zero.
+  @retval RETURN_UNSUPPORTED           The transport layer cannot encode the APP message in place.
+  @retval RETURN_BUFFER_TOO_SMALL      The response buffer is too small to hold the response.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmSendReceiveDataStream (
+  IN     VOID                 *Context,
+  IN     UINT32               SessionId,
+  IN     UINTN                RecordSize,
+  IN OUT VOID                 *Request,
+  IN     UINTN                RequestSize,
+  IN OUT VOID                 *Response,
+  IN OUT UINTN                *ResponseSize
+  )
+{
+  RETURN_STATUS                 Status;
+  SPDM_DEVICE_CONTEXT           *SpdmContext;
+  UINTN                         Headroom;
+  UINTN                         Tailroom;
+
+  SpdmContext = Context;
+
+  if (RecordSize == 0) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  Status = SpdmGetDataStreamRoom (SpdmContext, SessionId, &Headroom, &Tailroom);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  Status = SpdmKeyUpdateByPolicy (SpdmContext, SessionId);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  Status = SpdmSendDataStream (SpdmContext, &SessionId, Headroom, Tailroom, RecordSize, Request, RequestSize);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  return SpdmReceiveDataStream (SpdmContext, &SessionId, Headroom, RecordSize, Response, ResponseSize);
+}
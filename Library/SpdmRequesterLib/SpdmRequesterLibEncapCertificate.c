@@ -9,6 +9,7 @@
 
 #include "SpdmRequesterLibInternal.h"
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
 /**
   Process the SPDM encapsulated GET_CERTIFICATE request and return the response.
 
@@ -72,9 +73,7 @@ SpdmGetEncapResponseCertificate (
 
   Offset = SpdmRequest->Offset;
   Length = SpdmRequest->Length;
-  if (Length > MAX_SPDM_CERT_CHAIN_BLOCK_LEN) {
-    Length = MAX_SPDM_CERT_CHAIN_BLOCK_LEN;
-  }
+  Length = MIN (Length, SpdmGetCertChainBlockLength (SpdmContext, *ResponseSize));
   
   if (Offset >= SpdmContext->LocalContext.LocalCertChainProvisionSize[SlotNum]) {
     SpdmGenerateEncapErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
@@ -123,3 +122,4 @@ SpdmGetEncapResponseCertificate (
   return RETURN_SUCCESS;
 }
 
+#endif
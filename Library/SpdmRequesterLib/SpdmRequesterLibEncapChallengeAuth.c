@@ -9,6 +9,7 @@
 
 #include "SpdmRequesterLibInternal.h"
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
 /**
   Process the SPDM encapsulated CHALLENGE request and return the response.
 
@@ -38,7 +39,6 @@ SpdmGetEncapResponseChallengeAuth (
 {
   SPDM_CHALLENGE_REQUEST                    *SpdmRequest;
   SPDM_CHALLENGE_AUTH_RESPONSE              *SpdmResponse;
-  BOOLEAN                                   Result;
   UINTN                                     SignatureSize;
   UINT8                                     SlotNum;
   UINT32                                    HashSize;
@@ -106,17 +106,22 @@ SpdmGetEncapResponseChallengeAuth (
   AuthAttribute.BasicMutAuthReq = 0;
   SpdmResponse->Header.Param1 = *(UINT8 *)&AuthAttribute;
   SpdmResponse->Header.Param2 = (1 << SlotNum);
-  if (SlotNum == 0xFF) {
+  Ptr = (VOID *)(SpdmResponse + 1);
+  if ((SlotNum == 0xFF) && (SpdmContext->LocalContext.LocalPublicKeyProvisionSize != 0)) {
     SpdmResponse->Header.Param2 = 0;
 
-    SlotNum = SpdmContext->LocalContext.ProvisionedSlotNum;
-  }
+    SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, SpdmContext->LocalContext.LocalPublicKeyProvision, SpdmContext->LocalContext.LocalPublicKeyProvisionSize, Ptr);
+  } else {
+    if (SlotNum == 0xFF) {
+      SpdmResponse->Header.Param2 = 0;
 
-  Ptr = (VOID *)(SpdmResponse + 1);
-  SpdmGenerateCertChainHash (SpdmContext, SlotNum, Ptr);
+      SlotNum = SpdmContext->LocalContext.ProvisionedSlotNum;
+    }
+    SpdmGenerateCertChainHash (SpdmContext, SlotNum, Ptr);
+  }
   Ptr += HashSize;
 
-  SpdmGetRandomNumber (SPDM_NONCE_SIZE, Ptr);
+  SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, SPDM_NONCE_SIZE, Ptr);
   Ptr += SPDM_NONCE_SIZE;
 
   Ptr += MeasurementSummaryHashSize;
@@ -134,8 +139,8 @@ SpdmGetEncapResponseChallengeAuth (
     SpdmGenerateEncapErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
-  Result = SpdmGenerateChallengeAuthSignature (SpdmContext, TRUE, Ptr);
-  if (!Result) {
+  Status = SpdmGenerateChallengeAuthSignature (SpdmContext, TRUE, Ptr);
+  if (RETURN_ERROR(Status)) {
     SpdmGenerateEncapErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_CHALLENGE_AUTH, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
@@ -144,3 +149,4 @@ SpdmGetEncapResponseChallengeAuth (
   return RETURN_SUCCESS;
 }
 
+#endif
@@ -9,6 +9,7 @@
 
 #include "SpdmRequesterLibInternal.h"
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
 /**
   Process the SPDM encapsulated GET_DIGESTS request and return the response.
 
@@ -104,3 +105,4 @@ SpdmGetEncapResponseDigest (
   return RETURN_SUCCESS;
 }
 
+#endif
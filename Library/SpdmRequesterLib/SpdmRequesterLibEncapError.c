@@ -25,6 +25,7 @@
 
   @retval RETURN_SUCCESS               The error message is generated.
   @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+  @retval RETURN_UNSUPPORTED           OPENSPDM_ENCAP_CAP_SUPPORT is 0.
 **/
 RETURN_STATUS
 EFIAPI
@@ -36,6 +37,7 @@ SpdmGenerateEncapErrorResponse (
      OUT VOID                 *Response
   )
 {
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
   SPDM_ERROR_RESPONSE     *SpdmResponse;
 
   ASSERT (*ResponseSize >= sizeof(SPDM_ERROR_RESPONSE));
@@ -48,6 +50,9 @@ SpdmGenerateEncapErrorResponse (
   SpdmResponse->Header.Param2 = ErrorData;
 
   return RETURN_SUCCESS;
+#else
+  return RETURN_UNSUPPORTED;
+#endif
 }
 
 /**
@@ -68,6 +73,7 @@ SpdmGenerateEncapErrorResponse (
 
   @retval RETURN_SUCCESS               The error message is generated.
   @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+  @retval RETURN_UNSUPPORTED           OPENSPDM_ENCAP_CAP_SUPPORT is 0.
 **/
 RETURN_STATUS
 EFIAPI
@@ -81,6 +87,7 @@ SpdmGenerateEncapExtendedErrorResponse (
      OUT VOID                 *Response
   )
 {
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
   SPDM_ERROR_RESPONSE     *SpdmResponse;
 
   ASSERT (*ResponseSize >= sizeof(SPDM_ERROR_RESPONSE) + ExtendedErrorDataSize);
@@ -94,4 +101,7 @@ SpdmGenerateEncapExtendedErrorResponse (
   CopyMem (SpdmResponse + 1, ExtendedErrorData, ExtendedErrorDataSize);
 
   return RETURN_SUCCESS;
+#else
+  return RETURN_UNSUPPORTED;
+#endif
 }
@@ -9,6 +9,7 @@
 
 #include "SpdmRequesterLibInternal.h"
 
+#if (OPENSPDM_ENCAP_CAP_SUPPORT == 1) && (OPENSPDM_KEY_UPD_CAP_SUPPORT == 1)
 /**
   Process the SPDM encapsulated KEY_UPDATE request and return the response.
 
@@ -102,3 +103,4 @@ SpdmGetEncapResponseKeyUpdate (
   return RETURN_SUCCESS;
 }
 
+#endif
@@ -9,17 +9,23 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmRequesterLibInternal.h"
 
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
 typedef struct {
   UINT8                          RequestResponseCode;
   SPDM_GET_ENCAP_RESPONSE_FUNC   GetEncapResponseFunc;
 } SPDM_GET_ENCAP_RESPONSE_STRUCT;
 
 SPDM_GET_ENCAP_RESPONSE_STRUCT  mSpdmGetEncapResponseStruct[] = {
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   {SPDM_GET_DIGESTS,            SpdmGetEncapResponseDigest},
   {SPDM_GET_CERTIFICATE,        SpdmGetEncapResponseCertificate},
   {SPDM_CHALLENGE,              SpdmGetEncapResponseChallengeAuth},
+#endif
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
   {SPDM_KEY_UPDATE,             SpdmGetEncapResponseKeyUpdate},
+#endif
 };
+#endif
 
 /**
   Register an SPDM encapsulated message process function.
@@ -37,14 +43,17 @@ SpdmRegisterGetEncapResponseFunc (
   IN  SPDM_GET_ENCAP_RESPONSE_FUNC  GetEncapResponseFunc
   )
 {
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
   SPDM_DEVICE_CONTEXT     *SpdmContext;
 
   SpdmContext = Context;
   SpdmContext->GetEncapResponseFunc = (UINTN)GetEncapResponseFunc;
+#endif
 
   return ;
 }
 
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
 /**
   Return the GET_ENCAP_RESPONSE function via request code.
 
@@ -125,24 +134,26 @@ SpdmProcessEncapsulatedRequest (
                                        If SessionId is NOT NULL, it is a secured message.
   @param  MutAuthRequested             Indicate of the MutAuthRequested through KEY_EXCHANGE or CHALLENG response.
   @param  ReqSlotIdParam               ReqSlotIdParam from the RESPONSE_PAYLOAD_TYPE_REQ_SLOT_NUMBER.
+  @param  Request                      The buffer of the requests, of MAX_SPDM_MESSAGE_BUFFER_SIZE bytes.
+  @param  Response                     The buffer of the responses, of MAX_SPDM_MESSAGE_BUFFER_SIZE bytes.
 
   @retval RETURN_SUCCESS               The SPDM Encapsulated requests are sent and the responses are received.
   @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
 **/
 RETURN_STATUS
-SpdmEncapsulatedRequest (
+SpdmEncapsulatedRequestWithBuffers (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
   IN     UINT32               *SessionId,
   IN     UINT8                MutAuthRequested,
-     OUT UINT8                *ReqSlotIdParam
+     OUT UINT8                *ReqSlotIdParam,
+     OUT UINT8                *Request,
+     OUT UINT8                *Response
   )
 {
   RETURN_STATUS                               Status;
-  UINT8                                       Request[MAX_SPDM_MESSAGE_BUFFER_SIZE];
   UINTN                                       SpdmRequestSize;
   SPDM_GET_ENCAPSULATED_REQUEST_REQUEST       *SpdmGetEncapsulatedRequestRequest;
   SPDM_DELIVER_ENCAPSULATED_RESPONSE_REQUEST  *SpdmDeliverEncapsulatedResponseRequest;
-  UINT8                                       Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
   UINTN                                       SpdmResponseSize;
   SPDM_ENCAPSULATED_REQUEST_RESPONSE          *SpdmEncapsulatedRequestResponse;
   SPDM_ENCAPSULATED_RESPONSE_ACK_RESPONSE     *SpdmEncapsulatedResponseAckResponse;
@@ -171,11 +182,13 @@ SpdmEncapsulatedRequest (
     ASSERT (MutAuthRequested == 0);
   }
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   //
   // Cache
   //
   ResetManagedBuffer (&SpdmContext->Transcript.MessageMutB);
   ResetManagedBuffer (&SpdmContext->Transcript.MessageMutC);
+#endif
 
   if (SessionId == NULL) {
     SpdmContext->LastSpdmRequestSessionIdValid = FALSE;
@@ -207,8 +220,8 @@ SpdmEncapsulatedRequest (
     }
 
     SpdmEncapsulatedRequestResponse = (VOID *)Response;
-    SpdmResponseSize = sizeof(Response);
-    ZeroMem (&Response, sizeof(Response));
+    SpdmResponseSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    ZeroMem (Response, MAX_SPDM_MESSAGE_BUFFER_SIZE);
     Status = SpdmReceiveSpdmResponse (SpdmContext, SessionId, &SpdmResponseSize, SpdmEncapsulatedRequestResponse);
     if (RETURN_ERROR(Status)) {
       return RETURN_DEVICE_ERROR;
@@ -241,7 +254,7 @@ SpdmEncapsulatedRequest (
     SpdmDeliverEncapsulatedResponseRequest->Header.Param1 = RequestId;
     SpdmDeliverEncapsulatedResponseRequest->Header.Param2 = 0;
     EncapsulatedResponse = (VOID *)(SpdmDeliverEncapsulatedResponseRequest + 1);
-    EncapsulatedResponseSize = sizeof(Request) - sizeof(SPDM_DELIVER_ENCAPSULATED_RESPONSE_REQUEST);
+    EncapsulatedResponseSize = MAX_SPDM_MESSAGE_BUFFER_SIZE - sizeof(SPDM_DELIVER_ENCAPSULATED_RESPONSE_REQUEST);
 
     Status = SpdmProcessEncapsulatedRequest (SpdmContext, EncapsulatedRequestSize, EncapsulatedRequest, &EncapsulatedResponseSize, EncapsulatedResponse);
     if (RETURN_ERROR(Status)) {
@@ -255,8 +268,8 @@ SpdmEncapsulatedRequest (
     }
     
     SpdmEncapsulatedResponseAckResponse = (VOID *)Response;
-    SpdmResponseSize = sizeof(Response);
-    ZeroMem (&Response, sizeof(Response));
+    SpdmResponseSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    ZeroMem (Response, MAX_SPDM_MESSAGE_BUFFER_SIZE);
     Status = SpdmReceiveSpdmResponse (SpdmContext, SessionId, &SpdmResponseSize, SpdmEncapsulatedResponseAckResponse);
     if (RETURN_ERROR(Status)) {
       return RETURN_DEVICE_ERROR;
@@ -301,6 +314,56 @@ SpdmEncapsulatedRequest (
 
   return RETURN_SUCCESS;
 }
+#endif
+
+/**
+  This function executes a series of SPDM encapsulated requests and receives SPDM encapsulated responses.
+
+  This function starts with the first encapsulated request (such as GET_ENCAPSULATED_REQUEST)
+  and ends with last encapsulated response (such as RESPONSE_PAYLOAD_TYPE_ABSENT or RESPONSE_PAYLOAD_TYPE_SLOT_NUMBER).
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicate if the encapsulated request is a secured message.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  MutAuthRequested             Indicate of the MutAuthRequested through KEY_EXCHANGE or CHALLENG response.
+  @param  ReqSlotIdParam               ReqSlotIdParam from the RESPONSE_PAYLOAD_TYPE_REQ_SLOT_NUMBER.
+
+  @retval RETURN_SUCCESS               The SPDM Encapsulated requests are sent and the responses are received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
+  @retval RETURN_UNSUPPORTED           OPENSPDM_ENCAP_CAP_SUPPORT is 0.
+**/
+RETURN_STATUS
+SpdmEncapsulatedRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT8                MutAuthRequested,
+     OUT UINT8                *ReqSlotIdParam
+  )
+{
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
+  RETURN_STATUS                               Status;
+  UINT8                                       *Request;
+  UINT8                                       *Response;
+
+  Request = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (Request == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  Response = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (Response == NULL) {
+    SpdmReleaseScratch (SpdmContext, Request);
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  Status = SpdmEncapsulatedRequestWithBuffers (SpdmContext, SessionId, MutAuthRequested, ReqSlotIdParam, Request, Response);
+  SpdmReleaseScratch (SpdmContext, Response);
+  SpdmReleaseScratch (SpdmContext, Request);
+  return Status;
+#else
+  return RETURN_UNSUPPORTED;
+#endif
+}
 
 /**
   This function executes a series of SPDM encapsulated requests and receives SPDM encapsulated responses.
@@ -25,33 +25,37 @@ typedef struct {
 #pragma pack()
 
 /**
-  This function sends FINISH and receives FINISH_RSP for SPDM finish.
+  This function builds FINISH, and appends it to the session transcript with the signature and the HMAC.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    SessionId to the FINISH request.
   @param  ReqSlotIdParam               ReqSlotIdParam to the FINISH request.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the FINISH request.
+  @param  Request                      A pointer to a destination buffer to store the FINISH request.
 
-  @retval RETURN_SUCCESS               The FINISH is sent and the FINISH_RSP is received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SUCCESS               The FINISH request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The session state or the capabilities do not allow FINISH.
+  @retval RETURN_INVALID_PARAMETER     The ReqSlotIdParam is invalid.
+  @retval RETURN_SECURITY_VIOLATION    The signature or the HMAC cannot be generated.
 **/
 RETURN_STATUS
-TrySpdmSendReceiveFinish (
+SpdmBuildFinishRequest (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
   IN     UINT32               SessionId,
-  IN     UINT8                ReqSlotIdParam
+  IN     UINT8                ReqSlotIdParam,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
   )
 {
   RETURN_STATUS                             Status;
-  SPDM_FINISH_REQUEST_MINE                  SpdmRequest;
-  UINTN                                     SpdmRequestSize;
+  SPDM_FINISH_REQUEST_MINE                  *SpdmRequest;
   UINTN                                     SignatureSize;
   UINTN                                     HmacSize;
-  SPDM_FINISH_RESPONSE_MINE                 SpdmResponse;
-  UINTN                                     SpdmResponseSize;
   SPDM_SESSION_INFO                         *SessionInfo;
   UINT8                                     *Ptr;
   BOOLEAN                                   Result;
-  UINT8                                     TH2HashData[64];
   SPDM_SESSION_STATE                        SessionState;
 
   if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP)) {
@@ -72,46 +76,64 @@ TrySpdmSendReceiveFinish (
   }
 
   if (SessionInfo->MutAuthRequested != 0) {
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
     if ((ReqSlotIdParam >= SpdmContext->LocalContext.SlotCount) && (ReqSlotIdParam != 0xFF)) {
       return RETURN_INVALID_PARAMETER;
     }
+#else
+    return RETURN_UNSUPPORTED;
+#endif
   } else {
     if (ReqSlotIdParam != 0) {
       return RETURN_INVALID_PARAMETER;
     }
   }
 
+  if (*RequestSize < sizeof(SPDM_FINISH_REQUEST_MINE)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SpdmRequest = Request;
+
   SpdmContext->ErrorState = SPDM_STATUS_ERROR_DEVICE_NO_CAPABILITIES;
    
-  SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
-  SpdmRequest.Header.RequestResponseCode = SPDM_FINISH;
+  SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmRequest->Header.RequestResponseCode = SPDM_FINISH;
   if (SessionInfo->MutAuthRequested) {
-    SpdmRequest.Header.Param1 = SPDM_FINISH_REQUEST_ATTRIBUTES_SIGNATURE_INCLUDED;
-    SpdmRequest.Header.Param2 = ReqSlotIdParam;
+    SpdmRequest->Header.Param1 = SPDM_FINISH_REQUEST_ATTRIBUTES_SIGNATURE_INCLUDED;
+    SpdmRequest->Header.Param2 = ReqSlotIdParam;
     SignatureSize = GetSpdmReqAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg);
   } else {
-    SpdmRequest.Header.Param1 = 0;
-    SpdmRequest.Header.Param2 = 0;
+    SpdmRequest->Header.Param1 = 0;
+    SpdmRequest->Header.Param2 = 0;
     SignatureSize = 0;
   }
   
-  if (ReqSlotIdParam == 0xFF) {
+  if ((ReqSlotIdParam == 0xFF) && (SpdmContext->LocalContext.LocalPublicKeyProvisionSize == 0)) {
     ReqSlotIdParam = SpdmContext->LocalContext.ProvisionedSlotNum;
   }
 
   if (SessionInfo->MutAuthRequested) {
-    SpdmContext->ConnectionInfo.LocalUsedCertChainBuffer = SpdmContext->LocalContext.LocalCertChainProvision[ReqSlotIdParam];
-    SpdmContext->ConnectionInfo.LocalUsedCertChainBufferSize = SpdmContext->LocalContext.LocalCertChainProvisionSize[ReqSlotIdParam];
+    if (ReqSlotIdParam == 0xFF) {
+      //
+      // The TH covers the provisioned public key in place of the certificate chain.
+      //
+      SpdmContext->ConnectionInfo.LocalUsedCertChainBuffer = NULL;
+      SpdmContext->ConnectionInfo.LocalUsedCertChainBufferSize = 0;
+    } else {
+      SpdmContext->ConnectionInfo.LocalUsedCertChainBuffer = SpdmContext->LocalContext.LocalCertChainProvision[ReqSlotIdParam];
+      SpdmContext->ConnectionInfo.LocalUsedCertChainBufferSize = SpdmContext->LocalContext.LocalCertChainProvisionSize[ReqSlotIdParam];
+    }
   }
 
   HmacSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
-  SpdmRequestSize = sizeof(SPDM_FINISH_REQUEST) + SignatureSize + HmacSize;
-  Ptr = SpdmRequest.Signature;
+  *RequestSize = sizeof(SPDM_FINISH_REQUEST) + SignatureSize + HmacSize;
+  Ptr = SpdmRequest->Signature;
   
-  Status = SpdmAppendMessageF (SessionInfo, (UINT8 *)&SpdmRequest, sizeof(SPDM_FINISH_REQUEST));
+  Status = SpdmAppendMessageF (SessionInfo, (UINT8 *)SpdmRequest, sizeof(SPDM_FINISH_REQUEST));
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   if (SessionInfo->MutAuthRequested) {
     Result = SpdmGenerateFinishReqSignature (SpdmContext, SessionInfo, Ptr);
     if (!Result) {
@@ -123,6 +145,7 @@ TrySpdmSendReceiveFinish (
     }
     Ptr += SignatureSize;
   }
+#endif
 
   Result = SpdmGenerateFinishReqHmac (SpdmContext, SessionInfo, Ptr);
   if (!Result) {
@@ -134,26 +157,63 @@ TrySpdmSendReceiveFinish (
     return RETURN_SECURITY_VIOLATION;
   }
 
-  Status = SpdmSendSpdmRequest (SpdmContext, &SessionId, SpdmRequestSize, &SpdmRequest);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
+  return RETURN_SUCCESS;
+}
 
-  SpdmResponseSize = sizeof(SpdmResponse);
-  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-  Status = SpdmReceiveSpdmResponse (SpdmContext, &SessionId, &SpdmResponseSize, &SpdmResponse);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
+/**
+  This function processes FINISH_RSP, and generates the session data key.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    SessionId to the FINISH request.
+  @param  RequestSize                  Size in bytes of the sent FINISH request.
+  @param  Request                      A pointer to the sent FINISH request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+
+  @retval RETURN_SUCCESS               The FINISH_RSP is received and verified.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid FINISH_RSP.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmProcessFinishResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
+  )
+{
+  RETURN_STATUS                             Status;
+  UINTN                                     HmacSize;
+  SPDM_FINISH_RESPONSE_MINE                 *SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+  SPDM_SESSION_INFO                         *SessionInfo;
+  BOOLEAN                                   Result;
+  UINT8                                     TH2HashData[64];
+
+  SpdmResponse = Response;
+  SpdmResponseSize = ResponseSize;
+
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  if (SessionInfo == NULL) {
+    ASSERT (FALSE);
+    return RETURN_UNSUPPORTED;
   }
+
+  HmacSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
+
   if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-    Status = SpdmHandleErrorResponseMain(SpdmContext, &SessionId, &SessionInfo->SessionTranscript.MessageF, SpdmRequestSize, &SpdmResponseSize, &SpdmResponse, SPDM_FINISH, SPDM_FINISH_RSP, sizeof(SPDM_FINISH_RESPONSE_MINE));
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
+    Status = SpdmHandleErrorResponseMain(SpdmContext, &SessionId, &SessionInfo->SessionTranscript.MessageF, RequestSize, &SpdmResponseSize, SpdmResponse, SPDM_FINISH, SPDM_FINISH_RSP, sizeof(SPDM_FINISH_RESPONSE_MINE));
     if (RETURN_ERROR(Status)) {
       return Status;
     }
-  } else if (SpdmResponse.Header.RequestResponseCode != SPDM_FINISH_RSP) {
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_FINISH_RSP) {
     return RETURN_DEVICE_ERROR;
   }
 
@@ -165,20 +225,22 @@ TrySpdmSendReceiveFinish (
     return RETURN_DEVICE_ERROR;
   }
 
-  Status = SpdmAppendMessageF (SessionInfo, &SpdmResponse, sizeof(SPDM_FINISH_RESPONSE));
+  Status = SpdmAppendMessageF (SessionInfo, SpdmResponse, sizeof(SPDM_FINISH_RESPONSE));
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
   if (SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP)) {
-    DEBUG((DEBUG_INFO, "VerifyData (0x%x):\n", HmacSize));
-    InternalDumpHex (SpdmResponse.VerifyData, HmacSize);
-    Result = SpdmVerifyFinishRspHmac (SpdmContext, SessionInfo, SpdmResponse.VerifyData, HmacSize);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "VerifyData (0x%x):\n", HmacSize));
+      InternalDumpHex (SpdmResponse->VerifyData, HmacSize);
+    }
+    Result = SpdmVerifyFinishRspHmac (SpdmContext, SessionInfo, SpdmResponse->VerifyData, HmacSize);
     if (!Result) {
       return RETURN_SECURITY_VIOLATION;
     }
 
-    Status = SpdmAppendMessageF (SessionInfo, (UINT8 *)&SpdmResponse + sizeof(SPDM_FINISH_RESPONSE), HmacSize);
+    Status = SpdmAppendMessageF (SessionInfo, (UINT8 *)SpdmResponse + sizeof(SPDM_FINISH_RESPONSE), HmacSize);
     if (RETURN_ERROR(Status)) {
       return RETURN_SECURITY_VIOLATION;
     }
@@ -200,6 +262,49 @@ TrySpdmSendReceiveFinish (
   return RETURN_SUCCESS;
 }
 
+/**
+  This function sends FINISH and receives FINISH_RSP for SPDM finish.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    SessionId to the FINISH request.
+  @param  ReqSlotIdParam               ReqSlotIdParam to the FINISH request.
+
+  @retval RETURN_SUCCESS               The FINISH is sent and the FINISH_RSP is received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+TrySpdmSendReceiveFinish (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINT8                ReqSlotIdParam
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_FINISH_REQUEST_MINE                  SpdmRequest;
+  UINTN                                     SpdmRequestSize;
+  SPDM_FINISH_RESPONSE_MINE                 SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+
+  SPDM_CRYPTO_STATS_BIND (SpdmContext);
+  SpdmRequestSize = sizeof(SpdmRequest);
+  Status = SpdmBuildFinishRequest (SpdmContext, SessionId, ReqSlotIdParam, &SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Status = SpdmSendSpdmRequest (SpdmContext, &SessionId, SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  SpdmResponseSize = sizeof(SpdmResponse);
+  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+  Status = SpdmReceiveSpdmResponse (SpdmContext, &SessionId, &SpdmResponseSize, &SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return SpdmProcessFinishResponse (SpdmContext, SessionId, SpdmRequestSize, &SpdmRequest, SpdmResponseSize, &SpdmResponse);
+}
+
 RETURN_STATUS
 SpdmSendReceiveFinish (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
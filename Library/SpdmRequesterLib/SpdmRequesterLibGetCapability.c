@@ -95,104 +95,172 @@ SpdmCheckFlagCompability (
 }
 
 /**
-  This function sends GET_CAPABILITIES and receives CAPABILITIES.
+  This function builds GET_CAPABILITIES.
 
   @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the GET_CAPABILITIES request.
+  @param  Request                      A pointer to a destination buffer to store the GET_CAPABILITIES request.
 
-  @retval RETURN_SUCCESS               The GET_CAPABILITIES is sent and the CAPABILITIES is received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SUCCESS               The GET_CAPABILITIES request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state does not allow GET_CAPABILITIES.
 **/
 RETURN_STATUS
-TrySpdmGetCapabilities (
-  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+SpdmBuildGetCapabilitiesRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
   )
 {
-  RETURN_STATUS                             Status;
-  SPDM_GET_CAPABILITIES_REQUEST             SpdmRequest;
-  UINTN                                     SpdmRequestSize;
-  SPDM_CAPABILITIES_RESPONSE                SpdmResponse;
-  UINTN                                     SpdmResponseSize;
+  SPDM_GET_CAPABILITIES_REQUEST             *SpdmRequest;
 
   if (SpdmContext->ConnectionInfo.ConnectionState != SpdmConnectionStateAfterVersion) {
     return RETURN_UNSUPPORTED;
   }
 
-  ZeroMem (&SpdmRequest, sizeof(SpdmRequest));
+  if (*RequestSize < sizeof(SPDM_GET_CAPABILITIES_REQUEST)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SpdmRequest = Request;
+
+  ZeroMem (SpdmRequest, sizeof(SPDM_GET_CAPABILITIES_REQUEST));
   if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11)) {
-    SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
-    SpdmRequestSize = sizeof(SpdmRequest);
+    SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+    *RequestSize = sizeof(SPDM_GET_CAPABILITIES_REQUEST);
   } else {
-    SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
-    SpdmRequestSize = sizeof(SpdmRequest.Header);
-  }
-  SpdmRequest.Header.RequestResponseCode = SPDM_GET_CAPABILITIES;
-  SpdmRequest.Header.Param1 = 0;
-  SpdmRequest.Header.Param2 = 0;
-  SpdmRequest.CTExponent = SpdmContext->LocalContext.Capability.CTExponent;
-  SpdmRequest.Flags = SpdmContext->LocalContext.Capability.Flags;
-  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
+    SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+    *RequestSize = sizeof(SpdmRequest->Header);
   }
+  SpdmRequest->Header.RequestResponseCode = SPDM_GET_CAPABILITIES;
+  SpdmRequest->Header.Param1 = 0;
+  SpdmRequest->Header.Param2 = 0;
+  SpdmRequest->CTExponent = SpdmContext->LocalContext.Capability.CTExponent;
+  SpdmRequest->Flags = SpdmContext->LocalContext.Capability.Flags;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function processes the response to a sent GET_CAPABILITIES.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the sent GET_CAPABILITIES request.
+  @param  Request                      A pointer to the sent GET_CAPABILITIES request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+
+  @retval RETURN_SUCCESS               The CAPABILITIES is received.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid CAPABILITIES.
+**/
+RETURN_STATUS
+SpdmProcessCapabilitiesResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_GET_CAPABILITIES_REQUEST             *SpdmRequest;
+  SPDM_CAPABILITIES_RESPONSE                *SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+
+  SpdmRequest = Request;
+  SpdmResponse = Response;
+  SpdmResponseSize = ResponseSize;
 
   //
   // Cache data
   //
-  Status = SpdmAppendMessageA (SpdmContext, &SpdmRequest, SpdmRequestSize);
+  Status = SpdmAppendMessageA (SpdmContext, SpdmRequest, RequestSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
-  SpdmResponseSize = sizeof(SpdmResponse);
-  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
   if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-    ShrinkManagedBuffer(&SpdmContext->Transcript.MessageA, SpdmRequestSize);
-    Status = SpdmHandleSimpleErrorResponse(SpdmContext, SpdmResponse.Header.Param1);
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
+    ShrinkManagedBuffer(&SpdmContext->Transcript.MessageA, RequestSize);
+    Status = SpdmHandleSimpleErrorResponse(SpdmContext, SpdmResponse->Header.Param1);
     if (RETURN_ERROR(Status)) {
       return Status;
     }
-  } else if (SpdmResponse.Header.RequestResponseCode != SPDM_CAPABILITIES) {
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_CAPABILITIES) {
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponseSize < sizeof(SPDM_CAPABILITIES_RESPONSE)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponseSize > sizeof(SpdmResponse)) {
+  if (SpdmResponseSize > sizeof(SPDM_CAPABILITIES_RESPONSE)) {
     return RETURN_DEVICE_ERROR;
   }
   //Check if received message version matches sent message version
-  if (SpdmRequest.Header.SPDMVersion != SpdmResponse.Header.SPDMVersion) {
+  if (SpdmRequest->Header.SPDMVersion != SpdmResponse->Header.SPDMVersion) {
     return RETURN_DEVICE_ERROR;
   }
   SpdmResponseSize = sizeof(SPDM_CAPABILITIES_RESPONSE);
 
-  if(!SpdmCheckFlagCompability(SpdmResponse.Flags,SpdmResponse.Header.SPDMVersion)){
+  if(!SpdmCheckFlagCompability(SpdmResponse->Flags,SpdmResponse->Header.SPDMVersion)){
     return RETURN_DEVICE_ERROR;
   }
 
   //
   // Cache data
   //
-  Status = SpdmAppendMessageA (SpdmContext, &SpdmResponse, SpdmResponseSize);
+  Status = SpdmAppendMessageA (SpdmContext, SpdmResponse, SpdmResponseSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
-  SpdmContext->ConnectionInfo.Capability.CTExponent = SpdmResponse.CTExponent;
-  SpdmContext->ConnectionInfo.Capability.Flags = SpdmResponse.Flags;
+  SpdmContext->ConnectionInfo.Capability.CTExponent = SpdmResponse->CTExponent;
+  SpdmContext->ConnectionInfo.Capability.Flags = SpdmResponse->Flags;
 
   SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterCapabilities;
 
   return RETURN_SUCCESS;
 }
 
+/**
+  This function sends GET_CAPABILITIES and receives CAPABILITIES.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval RETURN_SUCCESS               The GET_CAPABILITIES is sent and the CAPABILITIES is received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+TrySpdmGetCapabilities (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_GET_CAPABILITIES_REQUEST             SpdmRequest;
+  UINTN                                     SpdmRequestSize;
+  SPDM_CAPABILITIES_RESPONSE                SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+
+  SpdmRequestSize = sizeof(SpdmRequest);
+  Status = SpdmBuildGetCapabilitiesRequest (SpdmContext, &SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  SpdmResponseSize = sizeof(SpdmResponse);
+  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return SpdmProcessCapabilitiesResponse (SpdmContext, SpdmRequestSize, &SpdmRequest, SpdmResponseSize, &SpdmResponse);
+}
+
 /**
   This function sends GET_CAPABILITIES and receives CAPABILITIES.
 
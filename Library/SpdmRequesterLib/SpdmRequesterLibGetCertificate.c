@@ -15,50 +15,64 @@ typedef struct {
   SPDM_MESSAGE_HEADER  Header;
   UINT16               PortionLength;
   UINT16               RemainderLength;
-  UINT8                CertChain[MAX_SPDM_CERT_CHAIN_BLOCK_LEN];
+  UINT8                CertChain[MAX_SPDM_MESSAGE_BUFFER_SIZE - sizeof(SPDM_CERTIFICATE_RESPONSE)];
 } SPDM_CERTIFICATE_RESPONSE_MAX;
 
 #pragma pack()
 
 /**
-  This function sends GET_CERTIFICATE
-  to get certificate chain in one slot from device.
+  Return the largest Length of a GET_CERTIFICATE request.
 
-  This function verify the integrity of the certificate chain.
-  RootHash -> Root certificate -> Intermediate certificate -> Leaf certificate.
+  It follows the transport maximum message size, so that the certificate chain is got in as few round trips as
+  the transport allows. The CERTIFICATE response and its transport layer wrapper are received in one
+  MAX_SPDM_MESSAGE_BUFFER_SIZE buffer.
 
-  If the peer root certificate hash is deployed,
-  this function also verifies the digest with the root hash in the certificate chain.
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the largest Length of a GET_CERTIFICATE request.
+**/
+UINT16
+SpdmGetCertificateRequestLength (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  UINTN                                     MaxResponseSize;
+  UINTN                                     Headroom;
+  UINTN                                     Tailroom;
+
+  MaxResponseSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  if ((SpdmContext->TransportPath[0].TransportGetMessageRoom != NULL) &&
+      !RETURN_ERROR(SpdmContext->TransportPath[0].TransportGetMessageRoom (SpdmContext, NULL, FALSE, &Headroom, &Tailroom)) &&
+      (Headroom + Tailroom < MaxResponseSize)) {
+    MaxResponseSize -= Headroom + Tailroom;
+  }
+  return SpdmGetCertChainBlockLength (SpdmContext, MaxResponseSize);
+}
+
+/**
+  This function checks if GET_CERTIFICATE can be sent, and starts to collect the certificate chain of one slot.
+
+  The certificate chain is collected in place in PeerUsedCertChainBuffer.
+  If the GET_DIGESTS digest of the slot matches a certificate chain verified before,
+  the certificate chain is collected from the cache, and no GET_CERTIFICATE needs to be sent.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SlotNum                      The number of slot for the certificate chain.
-  @param  Length                       Length parameter in the get_certificate message (limited by MAX_SPDM_CERT_CHAIN_BLOCK_LEN).
-  @param  CertChainSize                On input, indicate the size in bytes of the destination buffer to store the digest buffer.
-                                       On output, indicate the size in bytes of the certificate chain.
-  @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
+  @param  IsCached                     Indicates if the certificate chain is collected from the cache.
 
-  @retval RETURN_SUCCESS               The certificate chain is got successfully.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
-  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval RETURN_SUCCESS               The certificate chain collection is started.
+  @retval RETURN_UNSUPPORTED           The connection state or the capabilities do not allow GET_CERTIFICATE.
+  @retval RETURN_INVALID_PARAMETER     The slot number is invalid.
 **/
 RETURN_STATUS
-TrySpdmGetCertificate (
-  IN     VOID                 *Context,
+SpdmStartGetCertificate (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
   IN     UINT8                SlotNum,
-  IN     UINT16               Length,
-  IN OUT UINTN                *CertChainSize,
-     OUT VOID                 *CertChain
+     OUT BOOLEAN              *IsCached
   )
 {
-  BOOLEAN                                   Result;
-  RETURN_STATUS                             Status;
-  SPDM_GET_CERTIFICATE_REQUEST              SpdmRequest;
-  SPDM_CERTIFICATE_RESPONSE_MAX             SpdmResponse;
-  UINTN                                     SpdmResponseSize;
-  LARGE_MANAGED_BUFFER                      CertificateChainBuffer;
-  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  UINTN                                     CachedCertChainSize;
 
-  SpdmContext = Context;
   if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP)) {
     return RETURN_UNSUPPORTED;
   }
@@ -68,8 +82,7 @@ TrySpdmGetCertificate (
     return RETURN_UNSUPPORTED;
   }
 
-  InitManagedBuffer (&CertificateChainBuffer, MAX_SPDM_MESSAGE_BUFFER_SIZE);
-  Length = MIN(Length, MAX_SPDM_CERT_CHAIN_BLOCK_LEN);
+  SpdmContext->ConnectionInfo.PeerCertChainCollectedSize = 0;
 
   if (SlotNum >= MAX_SPDM_SLOT_COUNT) {
     return RETURN_INVALID_PARAMETER;
@@ -77,125 +90,294 @@ TrySpdmGetCertificate (
 
   SpdmContext->ErrorState = SPDM_STATUS_ERROR_DEVICE_NO_CAPABILITIES;
 
-  do {
-    if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11)) {
-      SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
-    } else {
-      SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
-    }
-    SpdmRequest.Header.RequestResponseCode = SPDM_GET_CERTIFICATE;
-    SpdmRequest.Header.Param1 = SlotNum;
-    SpdmRequest.Header.Param2 = 0;
-    SpdmRequest.Offset = (UINT16)GetManagedBufferSize (&CertificateChainBuffer);
-    SpdmRequest.Length = Length;
-    DEBUG((DEBUG_INFO, "Request (Offset 0x%x, Size 0x%x):\n", SpdmRequest.Offset, SpdmRequest.Length));
-
-    Status = SpdmSendSpdmRequest (SpdmContext, NULL, sizeof(SpdmRequest), &SpdmRequest);
-    if (RETURN_ERROR(Status)) {
-      Status = RETURN_DEVICE_ERROR;
-      goto Done;
-    }
+  *IsCached = FALSE;
+  //
+  // The GET_DIGESTS digest of the slot matches a certificate chain verified before.
+  // No CERTIFICATE message is exchanged, so none is added to MessageB, as on the responder side.
+  //
+  CachedCertChainSize = SpdmContext->ConnectionInfo.MaxPeerUsedCertChainBufferSize;
+  if (SpdmGetPeerCertChainFromCache (SpdmContext, SlotNum, SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, &CachedCertChainSize)) {
+    DEBUG((DEBUG_INFO, "Certificate chain (Slot 0x%x) from cache\n", SlotNum));
+    SpdmContext->ConnectionInfo.PeerCertChainCollectedSize = CachedCertChainSize;
+    SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterCertificate;
+    *IsCached = TRUE;
+  }
+  return RETURN_SUCCESS;
+}
 
-    //
-    // Cache data
-    //
-    Status = SpdmAppendMessageB (SpdmContext, &SpdmRequest, sizeof(SpdmRequest));
-    if (RETURN_ERROR(Status)) {
-      Status = RETURN_SECURITY_VIOLATION;
-      goto Done;
-    }
+/**
+  This function builds GET_CERTIFICATE for the next portion of the certificate chain.
 
-    SpdmResponseSize = sizeof(SpdmResponse);
-    ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-    Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
-    if (RETURN_ERROR(Status)) {
-      Status = RETURN_DEVICE_ERROR;
-      goto Done;
-    }
-    if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
-      Status = RETURN_DEVICE_ERROR;
-      goto Done;
-    }
-    if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-      Status = SpdmHandleErrorResponseMain(SpdmContext, NULL, &SpdmContext->Transcript.MessageB, sizeof(SpdmRequest), &SpdmResponseSize, &SpdmResponse, SPDM_GET_CERTIFICATE, SPDM_CERTIFICATE, sizeof(SPDM_CERTIFICATE_RESPONSE_MAX));
-      if (RETURN_ERROR(Status)) {
-        goto Done;
-      }
-    } else if (SpdmResponse.Header.RequestResponseCode != SPDM_CERTIFICATE) {
-      Status = RETURN_DEVICE_ERROR;
-      goto Done;
-    }
-    if (SpdmResponseSize < sizeof(SPDM_CERTIFICATE_RESPONSE)) {
-      Status = RETURN_DEVICE_ERROR;
-      goto Done;
-    }
-    if (SpdmResponseSize > sizeof(SpdmResponse)) {
-      Status = RETURN_DEVICE_ERROR;
-      goto Done;
-    }
-    if (SpdmResponse.PortionLength > MAX_SPDM_CERT_CHAIN_BLOCK_LEN) {
-      Status = RETURN_DEVICE_ERROR;
-      goto Done;
-    }
-    if (SpdmResponse.Header.Param1 != SlotNum) {
-      Status = RETURN_DEVICE_ERROR;
-      goto Done;
-    }
-    if (SpdmResponseSize < sizeof(SPDM_CERTIFICATE_RESPONSE) + SpdmResponse.PortionLength) {
-      Status = RETURN_DEVICE_ERROR;
-      goto Done;
-    }
-    SpdmResponseSize = sizeof(SPDM_CERTIFICATE_RESPONSE) + SpdmResponse.PortionLength;
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  Length                       Length parameter in the get_certificate message (limited by SpdmGetCertificateRequestLength).
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the GET_CERTIFICATE request.
+  @param  Request                      A pointer to a destination buffer to store the GET_CERTIFICATE request.
+
+  @retval RETURN_SUCCESS               The GET_CERTIFICATE request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+**/
+RETURN_STATUS
+SpdmBuildGetCertificateRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                SlotNum,
+  IN     UINT16               Length,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  )
+{
+  SPDM_GET_CERTIFICATE_REQUEST              *SpdmRequest;
+
+  if (*RequestSize < sizeof(SPDM_GET_CERTIFICATE_REQUEST)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SpdmRequest = Request;
+
+  if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11)) {
+    SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  } else {
+    SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+  }
+  SpdmRequest->Header.RequestResponseCode = SPDM_GET_CERTIFICATE;
+  SpdmRequest->Header.Param1 = SlotNum;
+  SpdmRequest->Header.Param2 = 0;
+  SpdmRequest->Offset = (UINT16)SpdmContext->ConnectionInfo.PeerCertChainCollectedSize;
+  SpdmRequest->Length = MIN(Length, SpdmGetCertificateRequestLength (SpdmContext));
+  DEBUG((DEBUG_INFO, "Request (Offset 0x%x, Size 0x%x):\n", SpdmRequest->Offset, SpdmRequest->Length));
+
+  *RequestSize = sizeof(SPDM_GET_CERTIFICATE_REQUEST);
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function processes the response to a sent GET_CERTIFICATE, and collects the portion of the certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  RequestSize                  Size in bytes of the sent GET_CERTIFICATE request.
+  @param  Request                      A pointer to the sent GET_CERTIFICATE request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+  @param  RemainderLength              The length of the certificate chain that remains to be got.
+
+  @retval RETURN_SUCCESS               The CERTIFICATE is received.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid CERTIFICATE.
+  @retval RETURN_SECURITY_VIOLATION    The certificate chain is too large.
+**/
+RETURN_STATUS
+SpdmProcessCertificateResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                SlotNum,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response,
+     OUT UINT16               *RemainderLength
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_GET_CERTIFICATE_REQUEST              *SpdmRequest;
+  SPDM_CERTIFICATE_RESPONSE_MAX             *SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+
+  SpdmRequest = Request;
+  SpdmResponse = Response;
+  SpdmResponseSize = ResponseSize;
+
+  //
+  // Cache data
+  //
+  Status = SpdmAppendMessageBDigest (SpdmContext, SpdmRequest, RequestSize);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+
+  if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
     //
-    // Cache data
+    // Message B is not a managed buffer, so the request is withdrawn here instead of by SpdmHandleErrorResponseMain.
     //
-    Status = SpdmAppendMessageB (SpdmContext, &SpdmResponse, SpdmResponseSize);
+    if (SpdmResponse->Header.Param1 != SPDM_ERROR_CODE_RESPONSE_NOT_READY) {
+      SpdmShrinkMessageBDigest (SpdmContext, RequestSize);
+    }
+    Status = SpdmHandleErrorResponseMain(SpdmContext, NULL, NULL, 0, &SpdmResponseSize, SpdmResponse, SPDM_GET_CERTIFICATE, SPDM_CERTIFICATE, sizeof(SPDM_CERTIFICATE_RESPONSE_MAX));
     if (RETURN_ERROR(Status)) {
-      Status = RETURN_SECURITY_VIOLATION;
-      goto Done;
+      return Status;
     }
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_CERTIFICATE) {
+    return RETURN_DEVICE_ERROR;
+  }
+  if (SpdmResponseSize < sizeof(SPDM_CERTIFICATE_RESPONSE)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  if (SpdmResponseSize > sizeof(SPDM_CERTIFICATE_RESPONSE_MAX)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  if (SpdmResponse->PortionLength > SpdmRequest->Length) {
+    return RETURN_DEVICE_ERROR;
+  }
+  if (SpdmResponse->Header.Param1 != SlotNum) {
+    return RETURN_DEVICE_ERROR;
+  }
+  if (SpdmResponseSize < sizeof(SPDM_CERTIFICATE_RESPONSE) + SpdmResponse->PortionLength) {
+    return RETURN_DEVICE_ERROR;
+  }
+  SpdmResponseSize = sizeof(SPDM_CERTIFICATE_RESPONSE) + SpdmResponse->PortionLength;
+  //
+  // Cache data
+  //
+  Status = SpdmAppendMessageBDigest (SpdmContext, SpdmResponse, SpdmResponseSize);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_SECURITY_VIOLATION;
+  }
 
-    DEBUG((DEBUG_INFO, "Certificate (Offset 0x%x, Size 0x%x):\n", SpdmRequest.Offset, SpdmResponse.PortionLength));
-    InternalDumpHex (SpdmResponse.CertChain, SpdmResponse.PortionLength);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_CERT)) {
+    DEBUG((DEBUG_INFO, "Certificate (Offset 0x%x, Size 0x%x):\n", SpdmRequest->Offset, SpdmResponse->PortionLength));
+    InternalDumpHex (SpdmResponse->CertChain, SpdmResponse->PortionLength);
+  }
 
-    Status = AppendManagedBuffer (&CertificateChainBuffer, SpdmResponse.CertChain, SpdmResponse.PortionLength);
-    if (RETURN_ERROR(Status)) {
-      Status = RETURN_SECURITY_VIOLATION;
-      goto Done;
-    }
-    SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterCertificate;
+  Status = SpdmCollectPeerCertChain (SpdmContext, SpdmResponse->CertChain, SpdmResponse->PortionLength);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterCertificate;
+
+  *RemainderLength = SpdmResponse->RemainderLength;
+  return RETURN_SUCCESS;
+}
 
-  } while (SpdmResponse.RemainderLength != 0);
+/**
+  This function verifies a collected certificate chain, and returns it.
 
-  Result = SpdmVerifyPeerCertChainBuffer (SpdmContext, GetManagedBuffer(&CertificateChainBuffer), GetManagedBufferSize(&CertificateChainBuffer));
+  This function verify the integrity of the certificate chain.
+  RootHash -> Root certificate -> Intermediate certificate -> Leaf certificate.
+
+  If the peer root certificate hash is deployed,
+  this function also verifies the digest with the root hash in the certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CertChainSize                On input, indicate the size in bytes of the destination buffer to store the digest buffer.
+                                       On output, indicate the size in bytes of the certificate chain.
+  @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
+
+  @retval RETURN_SUCCESS               The certificate chain is verified.
+  @retval RETURN_BUFFER_TOO_SMALL      The destination buffer is too small.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmCompleteGetCertificate (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *CertChainSize,
+     OUT VOID                 *CertChain
+  )
+{
+  BOOLEAN                                   Result;
+  SPDM_CONNECTION_INFO                      *ConnectionInfo;
+
+  ConnectionInfo = &SpdmContext->ConnectionInfo;
+  Result = SpdmCompleteCollectPeerCertChain (SpdmContext);
   if (!Result) {
     SpdmContext->ErrorState = SPDM_STATUS_ERROR_CERTIFICATE_FAILURE;
-    Status = RETURN_SECURITY_VIOLATION;
-    goto Done;
+    return RETURN_SECURITY_VIOLATION;
   }
-  SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = GetManagedBufferSize(&CertificateChainBuffer);
-  CopyMem (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, GetManagedBuffer(&CertificateChainBuffer), GetManagedBufferSize(&CertificateChainBuffer));
 
   SpdmContext->ErrorState = SPDM_STATUS_SUCCESS;
 
   if (CertChainSize != NULL) {
-    if (*CertChainSize < GetManagedBufferSize(&CertificateChainBuffer)) {
-      *CertChainSize = GetManagedBufferSize(&CertificateChainBuffer);
+    if (*CertChainSize < ConnectionInfo->PeerUsedCertChainBufferSize) {
+      *CertChainSize = ConnectionInfo->PeerUsedCertChainBufferSize;
       return RETURN_BUFFER_TOO_SMALL;
     }
-    *CertChainSize = GetManagedBufferSize(&CertificateChainBuffer);
+    *CertChainSize = ConnectionInfo->PeerUsedCertChainBufferSize;
     if (CertChain != NULL) {
       CopyMem (
         CertChain,
-        GetManagedBuffer(&CertificateChainBuffer),
-        GetManagedBufferSize(&CertificateChainBuffer)
+        ConnectionInfo->PeerUsedCertChainBuffer,
+        ConnectionInfo->PeerUsedCertChainBufferSize
         );
     }
   }
 
-  Status = RETURN_SUCCESS;
-Done:
-  return Status;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function sends GET_CERTIFICATE
+  to get certificate chain in one slot from device.
+
+  This function verify the integrity of the certificate chain.
+  RootHash -> Root certificate -> Intermediate certificate -> Leaf certificate.
+
+  If the peer root certificate hash is deployed,
+  this function also verifies the digest with the root hash in the certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  Length                       Length parameter in the get_certificate message (limited by SpdmGetCertificateRequestLength).
+  @param  CertChainSize                On input, indicate the size in bytes of the destination buffer to store the digest buffer.
+                                       On output, indicate the size in bytes of the certificate chain.
+  @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
+
+  @retval RETURN_SUCCESS               The certificate chain is got successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+TrySpdmGetCertificate (
+  IN     VOID                 *Context,
+  IN     UINT8                SlotNum,
+  IN     UINT16               Length,
+  IN OUT UINTN                *CertChainSize,
+     OUT VOID                 *CertChain
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_GET_CERTIFICATE_REQUEST              SpdmRequest;
+  UINTN                                     SpdmRequestSize;
+  SPDM_CERTIFICATE_RESPONSE_MAX             SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+  UINT16                                    RemainderLength;
+  BOOLEAN                                   IsCached;
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+
+  SpdmContext = Context;
+
+  Status = SpdmStartGetCertificate (SpdmContext, SlotNum, &IsCached);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  if (!IsCached) {
+    do {
+      SpdmRequestSize = sizeof(SpdmRequest);
+      Status = SpdmBuildGetCertificateRequest (SpdmContext, SlotNum, Length, &SpdmRequestSize, &SpdmRequest);
+      if (RETURN_ERROR(Status)) {
+        return Status;
+      }
+      Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
+      if (RETURN_ERROR(Status)) {
+        return RETURN_DEVICE_ERROR;
+      }
+
+      SpdmResponseSize = sizeof(SpdmResponse);
+      ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+      Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
+      if (RETURN_ERROR(Status)) {
+        return RETURN_DEVICE_ERROR;
+      }
+      Status = SpdmProcessCertificateResponse (SpdmContext, SlotNum, SpdmRequestSize, &SpdmRequest, SpdmResponseSize, &SpdmResponse, &RemainderLength);
+      if (RETURN_ERROR(Status)) {
+        return Status;
+      }
+    } while (RemainderLength != 0);
+  }
+
+  return SpdmCompleteGetCertificate (SpdmContext, CertChainSize, CertChain);
 }
 
 /**
@@ -227,7 +409,7 @@ SpdmGetCertificate (
      OUT VOID                 *CertChain
   )
 {
-  return SpdmGetCertificateChooseLength(Context, SlotNum, MAX_SPDM_CERT_CHAIN_BLOCK_LEN, CertChainSize, CertChain);
+  return SpdmGetCertificateChooseLength(Context, SlotNum, SpdmGetCertificateRequestLength (Context), CertChainSize, CertChain);
 }
 
 /**
@@ -242,7 +424,7 @@ SpdmGetCertificate (
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SlotNum                      The number of slot for the certificate chain.
-  @param  Length                       Length parameter in the get_certificate message (limited by MAX_SPDM_CERT_CHAIN_BLOCK_LEN).
+  @param  Length                       Length parameter in the get_certificate message (limited by SpdmGetCertificateRequestLength).
   @param  CertChainSize                On input, indicate the size in bytes of the destination buffer to store the digest buffer.
                                        On output, indicate the size in bytes of the certificate chain.
   @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
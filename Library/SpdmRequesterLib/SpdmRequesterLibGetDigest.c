@@ -19,102 +19,127 @@ typedef struct {
 #pragma pack()
 
 /**
-  This function sends GET_DIGEST
-  to get all digest of the certificate chains from device.
+  This function builds GET_DIGESTS.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the GET_DIGESTS request.
+  @param  Request                      A pointer to a destination buffer to store the GET_DIGESTS request.
+
+  @retval RETURN_SUCCESS               The GET_DIGESTS request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state or the capabilities do not allow GET_DIGESTS.
+**/
+RETURN_STATUS
+SpdmBuildGetDigestRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  )
+{
+  SPDM_GET_DIGESTS_REQUEST                  *SpdmRequest;
+
+  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP)) {
+    return RETURN_UNSUPPORTED;
+  }
+  if (SpdmContext->ConnectionInfo.ConnectionState != SpdmConnectionStateNegotiated) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  if (*RequestSize < sizeof(SPDM_GET_DIGESTS_REQUEST)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SpdmRequest = Request;
+
+  SpdmContext->ErrorState = SPDM_STATUS_ERROR_DEVICE_NO_CAPABILITIES;
+
+  if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11)) {
+    SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  } else {
+    SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+  }
+  SpdmRequest->Header.RequestResponseCode = SPDM_GET_DIGESTS;
+  SpdmRequest->Header.Param1 = 0;
+  SpdmRequest->Header.Param2 = 0;
+  *RequestSize = sizeof(SPDM_GET_DIGESTS_REQUEST);
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function processes the response to a sent GET_DIGESTS.
 
   If the peer certificate chain is deployed,
   this function also verifies the digest with the certificate chain.
 
-  TotalDigestSize = sizeof(Digest) * Count in SlotMask
+  The sent GET_DIGESTS request must already be appended to Message B.
 
   @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the sent GET_DIGESTS request.
+  @param  Request                      A pointer to the sent GET_DIGESTS request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
   @param  SlotMask                     The slots which deploy the CertificateChain.
   @param  TotalDigestBuffer            A pointer to a destination buffer to store the digest buffer.
 
-  @retval RETURN_SUCCESS               The digests are got successfully.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SUCCESS               The DIGESTS is received and verified.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid DIGESTS.
   @retval RETURN_SECURITY_VIOLATION    Any verification fails.
 **/
 RETURN_STATUS
-TrySpdmGetDigest (
-  IN     VOID                 *Context,
+SpdmProcessDigestResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response,
      OUT UINT8                *SlotMask,
      OUT VOID                 *TotalDigestBuffer
   )
 {
   BOOLEAN                                   Result;
   RETURN_STATUS                             Status;
-  SPDM_GET_DIGESTS_REQUEST                  SpdmRequest;
-  SPDM_DIGESTS_RESPONSE_MAX                 SpdmResponse;
+  SPDM_DIGESTS_RESPONSE_MAX                 *SpdmResponse;
   UINTN                                     SpdmResponseSize;
   UINTN                                     DigestSize;
   UINTN                                     DigestCount;
   UINTN                                     Index;
-  SPDM_DEVICE_CONTEXT                       *SpdmContext;
-
-  SpdmContext = Context;
-  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP)) {
-    return RETURN_UNSUPPORTED;
-  }
-  if (SpdmContext->ConnectionInfo.ConnectionState != SpdmConnectionStateNegotiated) {
-    return RETURN_UNSUPPORTED;
-  }
-
-  SpdmContext->ErrorState = SPDM_STATUS_ERROR_DEVICE_NO_CAPABILITIES;
 
-  if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11)) {
-    SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
-  } else {
-    SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
-  }
-  SpdmRequest.Header.RequestResponseCode = SPDM_GET_DIGESTS;
-  SpdmRequest.Header.Param1 = 0;
-  SpdmRequest.Header.Param2 = 0;
-
-  Status = SpdmSendSpdmRequest (SpdmContext, NULL, sizeof(SpdmRequest), &SpdmRequest);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
+  SpdmResponse = Response;
+  SpdmResponseSize = ResponseSize;
 
-  //
-  // Cache data
-  //
-  Status = SpdmAppendMessageB (SpdmContext, &SpdmRequest, sizeof(SpdmRequest));
-  if (RETURN_ERROR(Status)) {
-    return RETURN_SECURITY_VIOLATION;
-  }
-
-  SpdmResponseSize = sizeof(SpdmResponse);
-  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
   if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-    Status = SpdmHandleErrorResponseMain(SpdmContext, NULL, &SpdmContext->Transcript.MessageB, sizeof(SpdmRequest), &SpdmResponseSize, &SpdmResponse, SPDM_GET_DIGESTS, SPDM_DIGESTS, sizeof(SPDM_DIGESTS_RESPONSE_MAX));
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
+    //
+    // Message B is not a managed buffer, so the request is withdrawn here instead of by SpdmHandleErrorResponseMain.
+    //
+    if (SpdmResponse->Header.Param1 != SPDM_ERROR_CODE_RESPONSE_NOT_READY) {
+      SpdmShrinkMessageBDigest (SpdmContext, RequestSize);
+    }
+    Status = SpdmHandleErrorResponseMain(SpdmContext, NULL, NULL, 0, &SpdmResponseSize, SpdmResponse, SPDM_GET_DIGESTS, SPDM_DIGESTS, sizeof(SPDM_DIGESTS_RESPONSE_MAX));
     if (RETURN_ERROR(Status)) {
       return Status;
     }
-  } else if (SpdmResponse.Header.RequestResponseCode != SPDM_DIGESTS) {
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_DIGESTS) {
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponseSize < sizeof(SPDM_DIGESTS_RESPONSE)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponseSize > sizeof(SpdmResponse)) {
+  if (SpdmResponseSize > sizeof(SPDM_DIGESTS_RESPONSE_MAX)) {
     return RETURN_DEVICE_ERROR;
   }
 
   DigestSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
   if (SlotMask != NULL) {
-    *SlotMask = SpdmResponse.Header.Param2;
+    *SlotMask = SpdmResponse->Header.Param2;
   }
   DigestCount = 0;
   for (Index = 0; Index < MAX_SPDM_SLOT_COUNT; Index++) {
-    if (SpdmResponse.Header.Param2 & (1 << Index)) {
+    if (SpdmResponse->Header.Param2 & (1 << Index)) {
       DigestCount++;
     }
   }
@@ -128,33 +153,96 @@ TrySpdmGetDigest (
   //
   // Cache data
   //
-  Status = SpdmAppendMessageB (SpdmContext, &SpdmResponse, SpdmResponseSize);
+  Status = SpdmAppendMessageBDigest (SpdmContext, SpdmResponse, SpdmResponseSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
   for (Index = 0; Index < DigestCount; Index++) {
-    DEBUG((DEBUG_INFO, "Digest (0x%x) - ", Index));
-    InternalDumpData (&SpdmResponse.Digest[DigestSize * Index], DigestSize);
-    DEBUG((DEBUG_INFO, "\n"));
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_CERT)) {
+      DEBUG((DEBUG_INFO, "Digest (0x%x) - ", Index));
+      InternalDumpData (&SpdmResponse->Digest[DigestSize * Index], DigestSize);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
   }
 
-  Result = SpdmVerifyPeerDigests (SpdmContext, SpdmResponse.Digest, SpdmResponseSize - sizeof(SPDM_DIGESTS_RESPONSE));
+  Result = SpdmVerifyPeerDigests (SpdmContext, SpdmResponse->Digest, SpdmResponseSize - sizeof(SPDM_DIGESTS_RESPONSE));
   if (!Result) {
     SpdmContext->ErrorState = SPDM_STATUS_ERROR_CERTIFICATE_FAILURE;
     return RETURN_SECURITY_VIOLATION;
   }
+  SpdmRecordPeerDigests (SpdmContext, SpdmResponse->Header.Param2, SpdmResponse->Digest, DigestSize * DigestCount);
 
   SpdmContext->ErrorState = SPDM_STATUS_SUCCESS;
 
   if (TotalDigestBuffer != NULL) {
-    CopyMem (TotalDigestBuffer, SpdmResponse.Digest, DigestSize * DigestCount);
+    CopyMem (TotalDigestBuffer, SpdmResponse->Digest, DigestSize * DigestCount);
   }
 
   SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterDigests;
   return RETURN_SUCCESS;
 }
 
+/**
+  This function sends GET_DIGEST
+  to get all digest of the certificate chains from device.
+
+  If the peer certificate chain is deployed,
+  this function also verifies the digest with the certificate chain.
+
+  TotalDigestSize = sizeof(Digest) * Count in SlotMask
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotMask                     The slots which deploy the CertificateChain.
+  @param  TotalDigestBuffer            A pointer to a destination buffer to store the digest buffer.
+
+  @retval RETURN_SUCCESS               The digests are got successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+TrySpdmGetDigest (
+  IN     VOID                 *Context,
+     OUT UINT8                *SlotMask,
+     OUT VOID                 *TotalDigestBuffer
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_GET_DIGESTS_REQUEST                  SpdmRequest;
+  UINTN                                     SpdmRequestSize;
+  SPDM_DIGESTS_RESPONSE_MAX                 SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+
+  SpdmContext = Context;
+
+  SpdmRequestSize = sizeof(SpdmRequest);
+  Status = SpdmBuildGetDigestRequest (SpdmContext, &SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  //
+  // Cache data
+  //
+  Status = SpdmAppendMessageBDigest (SpdmContext, &SpdmRequest, SpdmRequestSize);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+
+  SpdmResponseSize = sizeof(SpdmResponse);
+  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return SpdmProcessDigestResponse (SpdmContext, SpdmRequestSize, &SpdmRequest, SpdmResponseSize, &SpdmResponse, SlotMask, TotalDigestBuffer);
+}
+
 /**
   This function sends GET_DIGEST
   to get all digest of the certificate chains from device.
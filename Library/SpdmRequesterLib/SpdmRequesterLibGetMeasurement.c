@@ -14,7 +14,7 @@ typedef struct {
   SPDM_MESSAGE_HEADER  Header;
   UINT8                NumberOfBlocks;
   UINT8                MeasurementRecordLength[3];
-  UINT8                MeasurementRecord[(sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + MAX_HASH_SIZE) * MAX_SPDM_MEASUREMENT_BLOCK_COUNT];
+  UINT8                MeasurementRecord[MAX_SPDM_MEASUREMENT_RECORD_SIZE];
   UINT8                Nonce[SPDM_NONCE_SIZE];
   UINT16               OpaqueLength;
   UINT8                OpaqueData[MAX_SPDM_OPAQUE_DATA_SIZE];
@@ -22,11 +22,23 @@ typedef struct {
 } SPDM_MEASUREMENTS_RESPONSE_MAX;
 #pragma pack()
 
+//
+// A measurement block of SpdmGetMeasurementsPipelined, stored in the measurement record
+// and waiting for its signature verification.
+//
+typedef struct {
+  SPDM_PENDING_VERIFY  Verify;
+  UINT32               RecordOffset;
+  UINT32               RecordLength;
+} SPDM_PIPELINED_MEASUREMENT;
+
 /**
   This function sends GET_MEASUREMENT
   to get measurement from the device.
 
   If the signature is requested, this function verifies the signature of the measurement.
+  With PendingVerify, the verification is started, and it may still be pending when the function returns,
+  even if an error is returned. The caller completes it with SpdmPollVerifySignature.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
@@ -38,7 +50,10 @@ typedef struct {
   @param  NumberOfBlocks               The number of blocks of the measurement record.
   @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
                                        On output, indicate the size in bytes of the measurement record.
-  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record,
+                                       or NULL to leave it in the MeasurementRecord of SpdmResponse.
+  @param  SpdmResponse                 A pointer to the buffer to receive the MEASUREMENTS response in.
+  @param  PendingVerify                The pending signature verification, or NULL to verify the signature synchronously.
 
   @retval RETURN_SUCCESS               The measurement is got successfully.
   @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
@@ -53,19 +68,22 @@ TrySpdmGetMeasurement (
   IN     UINT8                SlotIdParam,
      OUT UINT8                *NumberOfBlocks,
   IN OUT UINT32               *MeasurementRecordLength,
-     OUT VOID                 *MeasurementRecord
+     OUT VOID                 *MeasurementRecord,
+     OUT SPDM_MEASUREMENTS_RESPONSE_MAX *SpdmResponse,
+     OUT SPDM_PENDING_VERIFY  *PendingVerify OPTIONAL
   )
 {
   BOOLEAN                                   Result;
   RETURN_STATUS                             Status;
   SPDM_GET_MEASUREMENTS_REQUEST             SpdmRequest;
   UINTN                                     SpdmRequestSize;
-  SPDM_MEASUREMENTS_RESPONSE_MAX            SpdmResponse;
   UINTN                                     SpdmResponseSize;
   UINT32                                    MeasurementRecordDataLength;
   UINT8                                     *MeasurementRecordData;
   SPDM_MEASUREMENT_BLOCK_COMMON_HEADER      *MeasurementBlockHeader;
-  UINT32                                    MeasurementBlockSize;
+  UINTN                                     MeasurementBlockSize;
+  UINTN                                     Offset;
+  SPDM_MESSAGE_FIELD_VIEW                   BlockView[SPDM_MEASUREMENT_BLOCK_FIELD_COUNT];
   UINT8                                     MeasurementBlockCount;
   UINT8                                     *Ptr;
   VOID                                      *ServerNonce;
@@ -103,7 +121,9 @@ TrySpdmGetMeasurement (
   if ((SlotIdParam >= MAX_SPDM_SLOT_COUNT) && (SlotIdParam != 0xF)) {
     return RETURN_INVALID_PARAMETER;
   }
-  if ((SlotIdParam == 0xF) && (SpdmContext->LocalContext.PeerCertChainProvisionSize == 0)) {
+  if ((SlotIdParam == 0xF) &&
+      (SpdmContext->LocalContext.PeerCertChainProvisionSize == 0) &&
+      (SpdmContext->LocalContext.PeerPublicKeyProvisionSize == 0)) {
     return RETURN_INVALID_PARAMETER;
   }
 
@@ -135,10 +155,12 @@ TrySpdmGetMeasurement (
       SpdmRequestSize = sizeof(SpdmRequest) - sizeof(SpdmRequest.SlotIDParam);
     }
 
-    SpdmGetRandomNumber (SPDM_NONCE_SIZE, SpdmRequest.Nonce);
-    DEBUG((DEBUG_INFO, "ClientNonce - "));
-    InternalDumpData (SpdmRequest.Nonce, SPDM_NONCE_SIZE);
-    DEBUG((DEBUG_INFO, "\n"));
+    SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, SPDM_NONCE_SIZE, SpdmRequest.Nonce);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "ClientNonce - "));
+      InternalDumpData (SpdmRequest.Nonce, SPDM_NONCE_SIZE);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
     SpdmRequest.SlotIDParam = SlotIdParam;
   } else {
     SpdmRequestSize = sizeof(SpdmRequest.Header);
@@ -151,86 +173,94 @@ TrySpdmGetMeasurement (
   //
   // Cache data
   //
-  Status = SpdmAppendMessageM (SpdmContext, &SpdmRequest, SpdmRequestSize);
+  Status = SpdmAppendRequesterMessageM (SpdmContext, &SpdmRequest, SpdmRequestSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
-  SpdmResponseSize = sizeof(SpdmResponse);
-  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-  Status = SpdmReceiveSpdmResponse (SpdmContext, SessionId, &SpdmResponseSize, &SpdmResponse);
+  SpdmResponseSize = sizeof(SPDM_MEASUREMENTS_RESPONSE_MAX);
+  ZeroMem (SpdmResponse, sizeof(SPDM_MEASUREMENTS_RESPONSE_MAX));
+  Status = SpdmReceiveSpdmResponse (SpdmContext, SessionId, &SpdmResponseSize, SpdmResponse);
   if (RETURN_ERROR(Status)) {
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-    Status = SpdmHandleErrorResponseMain(SpdmContext, SessionId, &SpdmContext->Transcript.MessageM, SpdmRequestSize, &SpdmResponseSize, &SpdmResponse, SPDM_GET_MEASUREMENTS, SPDM_MEASUREMENTS, sizeof(SPDM_MEASUREMENTS_RESPONSE_MAX));
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
+    //
+    // Message M is not a managed buffer, so the request is withdrawn here instead of by SpdmHandleErrorResponseMain.
+    //
+    if (SpdmResponse->Header.Param1 != SPDM_ERROR_CODE_RESPONSE_NOT_READY) {
+      SpdmShrinkRequesterMessageM (SpdmContext, SpdmRequestSize);
+    }
+    Status = SpdmHandleErrorResponseMain(SpdmContext, SessionId, NULL, 0, &SpdmResponseSize, SpdmResponse, SPDM_GET_MEASUREMENTS, SPDM_MEASUREMENTS, sizeof(SPDM_MEASUREMENTS_RESPONSE_MAX));
     if (RETURN_ERROR(Status)) {
       return Status;
     }
-  } else if (SpdmResponse.Header.RequestResponseCode != SPDM_MEASUREMENTS) {
-    ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_MEASUREMENTS) {
+    SpdmResetMessageM (SpdmContext);
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponseSize < sizeof(SPDM_MEASUREMENTS_RESPONSE)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponseSize > sizeof(SpdmResponse)) {
+  if (SpdmResponseSize > sizeof(SPDM_MEASUREMENTS_RESPONSE_MAX)) {
     return RETURN_DEVICE_ERROR;
   }
 
   if (MeasurementOperation == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS) {
-    if (SpdmResponse.NumberOfBlocks != 0) {
-      ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+    if (SpdmResponse->NumberOfBlocks != 0) {
+      SpdmResetMessageM (SpdmContext);
       return RETURN_DEVICE_ERROR;
     }
   } else if (MeasurementOperation == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS) {
-    if (SpdmResponse.NumberOfBlocks == 0) {
+    if (SpdmResponse->NumberOfBlocks == 0) {
       return RETURN_DEVICE_ERROR;
     }
   } else {
-    if (SpdmResponse.NumberOfBlocks != 1) {
+    if (SpdmResponse->NumberOfBlocks != 1) {
       return RETURN_DEVICE_ERROR;
     }
   }
 
-  MeasurementRecordDataLength = SpdmReadUint24 (SpdmResponse.MeasurementRecordLength);
+  MeasurementRecordDataLength = SpdmReadUint24 (SpdmResponse->MeasurementRecordLength);
   if (MeasurementOperation == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS) {
     if (MeasurementRecordDataLength != 0) {
-      ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+      SpdmResetMessageM (SpdmContext);
       return RETURN_DEVICE_ERROR;
     }
   } else {
     if (SpdmResponseSize < sizeof(SPDM_MEASUREMENTS_RESPONSE) + MeasurementRecordDataLength) {
       return RETURN_DEVICE_ERROR;
     }
-    if (MeasurementRecordDataLength >= sizeof(SpdmResponse.MeasurementRecord)) {
+    if (MeasurementRecordDataLength >= sizeof(SpdmResponse->MeasurementRecord)) {
       return RETURN_DEVICE_ERROR;
     }
     DEBUG((DEBUG_INFO, "MeasurementRecordLength - 0x%06x\n", MeasurementRecordDataLength));
   }
 
-  MeasurementRecordData = SpdmResponse.MeasurementRecord;
+  MeasurementRecordData = SpdmResponse->MeasurementRecord;
 
   if (RequestAttribute == SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE) {
     if (SpdmResponseSize < sizeof(SPDM_MEASUREMENTS_RESPONSE) +
                            MeasurementRecordDataLength +
                            SPDM_NONCE_SIZE +
                            sizeof(UINT16)) {
-      ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+      SpdmResetMessageM (SpdmContext);
       return RETURN_DEVICE_ERROR;
     }
-    if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11) && SpdmResponse.Header.Param2 != SlotIdParam) {
-      ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+    if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11) && SpdmResponse->Header.Param2 != SlotIdParam) {
+      SpdmResetMessageM (SpdmContext);
       return RETURN_SECURITY_VIOLATION;
     }
     Ptr = MeasurementRecordData + MeasurementRecordDataLength;
     ServerNonce = Ptr;
-    DEBUG((DEBUG_INFO, "ServerNonce (0x%x) - ", SPDM_NONCE_SIZE));
-    InternalDumpData (ServerNonce, SPDM_NONCE_SIZE);
-    DEBUG((DEBUG_INFO, "\n"));
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "ServerNonce (0x%x) - ", SPDM_NONCE_SIZE));
+      InternalDumpData (ServerNonce, SPDM_NONCE_SIZE);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
     Ptr += SPDM_NONCE_SIZE;
 
     OpaqueLength = *(UINT16 *)Ptr;
@@ -253,29 +283,48 @@ TrySpdmGetMeasurement (
                        sizeof(UINT16) +
                        OpaqueLength +
                        SignatureSize;
-    Status = SpdmAppendMessageM (SpdmContext, &SpdmResponse, SpdmResponseSize - SignatureSize);
+    Status = SpdmAppendRequesterMessageM (SpdmContext, SpdmResponse, SpdmResponseSize - SignatureSize);
     if (RETURN_ERROR(Status)) {
-      ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+      SpdmResetMessageM (SpdmContext);
       return RETURN_SECURITY_VIOLATION;
     }
 
     Opaque = Ptr;
     Ptr += OpaqueLength;
-    DEBUG((DEBUG_INFO, "Opaque (0x%x):\n", OpaqueLength));
-    InternalDumpHex (Opaque, OpaqueLength);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "Opaque (0x%x):\n", OpaqueLength));
+      InternalDumpHex (Opaque, OpaqueLength);
+    }
 
     Signature = Ptr;
-    DEBUG((DEBUG_INFO, "Signature (0x%x):\n", SignatureSize));
-    InternalDumpHex (Signature, SignatureSize);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "Signature (0x%x):\n", SignatureSize));
+      InternalDumpHex (Signature, SignatureSize);
+    }
 
-    Result = SpdmVerifyMeasurementSignature (SpdmContext, Signature, SignatureSize);
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+    if (PendingVerify == NULL) {
+      SpdmCaptureEvidence (SpdmContext, SPDM_EVIDENCE_TYPE_MEASUREMENTS, SpdmResponseSize - SignatureSize, Signature, SignatureSize);
+    }
+#endif
+    if (PendingVerify != NULL) {
+      Status = SpdmStartVerifyMeasurementSignature (SpdmContext, Signature, SignatureSize, PendingVerify);
+      Result = (BOOLEAN)(!RETURN_ERROR(Status) || (Status == RETURN_NOT_READY));
+    } else {
+      Result = SpdmVerifyMeasurementSignature (SpdmContext, Signature, SignatureSize);
+    }
     if (!Result) {
       SpdmContext->ErrorState = SPDM_STATUS_ERROR_MEASUREMENT_AUTH_FAILURE;
-      ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+      SpdmResetMessageM (SpdmContext);
       return RETURN_SECURITY_VIOLATION;
     }
+#if OPENSPDM_EVIDENCE_SUPPORT == 1
+    if (PendingVerify == NULL) {
+      SpdmCommitEvidence (SpdmContext, SPDM_EVIDENCE_TYPE_MEASUREMENTS);
+    }
+#endif
 
-    ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+    SpdmResetMessageM (SpdmContext);
   } else {
     //
     // Nonce is absent if there is not signature
@@ -303,15 +352,15 @@ TrySpdmGetMeasurement (
                        MeasurementRecordDataLength +
                        sizeof(UINT16) +
                        OpaqueLength;
-    Status = SpdmAppendMessageM (SpdmContext, &SpdmResponse, SpdmResponseSize);
+    Status = SpdmAppendRequesterMessageM (SpdmContext, SpdmResponse, SpdmResponseSize);
     if (RETURN_ERROR(Status)) {
-      ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+      SpdmResetMessageM (SpdmContext);
       return RETURN_SECURITY_VIOLATION;
     }
   }
 
   if (MeasurementOperation == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS) {
-    *NumberOfBlocks = SpdmResponse.Header.Param1;
+    *NumberOfBlocks = SpdmResponse->Header.Param1;
     if (*NumberOfBlocks == 0xFF) {
       // the number of block cannot be 0xFF, because index 0xFF will brings confusing.
       return RETURN_DEVICE_ERROR;
@@ -321,7 +370,7 @@ TrySpdmGetMeasurement (
       return RETURN_DEVICE_ERROR;
     }
   } else {
-    *NumberOfBlocks = SpdmResponse.NumberOfBlocks;
+    *NumberOfBlocks = SpdmResponse->NumberOfBlocks;
     if (*MeasurementRecordLength < MeasurementRecordDataLength) {
       return RETURN_BUFFER_TOO_SMALL;
     }
@@ -329,11 +378,12 @@ TrySpdmGetMeasurement (
       return RETURN_DEVICE_ERROR;
     }
 
-    MeasurementBlockSize = 0;
+    Offset = 0;
     MeasurementBlockCount = 1;
-    while (MeasurementBlockSize < MeasurementRecordDataLength) {
-      MeasurementBlockHeader = (SPDM_MEASUREMENT_BLOCK_COMMON_HEADER*) &MeasurementRecordData[MeasurementBlockSize];
-      if (MeasurementBlockHeader->MeasurementSize > MeasurementRecordDataLength - ((UINT8 *)MeasurementBlockHeader - (UINT8 *)MeasurementRecordData)) {
+    while (Offset < MeasurementRecordDataLength) {
+      MeasurementBlockHeader = (SPDM_MEASUREMENT_BLOCK_COMMON_HEADER*) &MeasurementRecordData[Offset];
+      Status = SpdmParseMessage (mSpdmMeasurementBlockLayout, SPDM_MEASUREMENT_BLOCK_FIELD_COUNT, NULL, MeasurementBlockHeader, MeasurementRecordDataLength - Offset, BlockView, &MeasurementBlockSize);
+      if (RETURN_ERROR(Status)) {
         return RETURN_DEVICE_ERROR;
       }
       if (MeasurementBlockHeader->MeasurementSpecification == 0 || (MeasurementBlockHeader->MeasurementSpecification & (MeasurementBlockHeader->MeasurementSpecification-1))) {
@@ -349,17 +399,383 @@ TrySpdmGetMeasurement (
         return RETURN_DEVICE_ERROR;
       }
       MeasurementBlockCount++;
-      MeasurementBlockSize = (UINT32) (MeasurementBlockSize + sizeof(SPDM_MEASUREMENT_BLOCK_COMMON_HEADER) + MeasurementBlockHeader->MeasurementSize);
+      Offset += MeasurementBlockSize;
     }
 
     *MeasurementRecordLength = MeasurementRecordDataLength;
-    CopyMem (MeasurementRecord, MeasurementRecordData, MeasurementRecordDataLength);
+    if (MeasurementRecord != NULL) {
+      CopyMem (MeasurementRecord, MeasurementRecordData, MeasurementRecordDataLength);
+    }
   }
 
   SpdmContext->ErrorState = SPDM_STATUS_SUCCESS;
   return RETURN_SUCCESS;
 }
 
+/**
+  This function sends GET_MEASUREMENT
+  to get measurement from the device in a given response buffer, and retries if the device is busy.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestAttribute             The request attribute of the request message.
+  @param  MeasurementOperation         The measurement operation of the request message.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  NumberOfBlocks               The number of blocks of the measurement record.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record,
+                                       or NULL to leave it in the MeasurementRecord of SpdmResponse.
+  @param  SpdmResponse                 A pointer to the buffer to receive the MEASUREMENTS response in.
+  @param  PendingVerify                The pending signature verification, or NULL to verify the signature synchronously.
+
+  @retval RETURN_SUCCESS               The measurement is got successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmRetryGetMeasurement (
+  IN     SPDM_DEVICE_CONTEXT            *SpdmContext,
+  IN     UINT32                         *SessionId,
+  IN     UINT8                          RequestAttribute,
+  IN     UINT8                          MeasurementOperation,
+  IN     UINT8                          SlotIdParam,
+     OUT UINT8                          *NumberOfBlocks,
+  IN OUT UINT32                         *MeasurementRecordLength,
+     OUT VOID                           *MeasurementRecord OPTIONAL,
+     OUT SPDM_MEASUREMENTS_RESPONSE_MAX *SpdmResponse,
+     OUT SPDM_PENDING_VERIFY            *PendingVerify OPTIONAL
+  )
+{
+  UINTN                   Retry;
+  RETURN_STATUS           Status;
+
+  Retry = SpdmContext->RetryTimes;
+  do {
+    Status = TrySpdmGetMeasurement(SpdmContext, SessionId, RequestAttribute, MeasurementOperation, SlotIdParam, NumberOfBlocks, MeasurementRecordLength, MeasurementRecord, SpdmResponse, PendingVerify);
+    if (RETURN_NO_RESPONSE != Status) {
+      return Status;
+    }
+  } while (Retry-- != 0);
+
+  return Status;
+}
+
+/**
+  This function learns the number of measurement blocks of the device and the size of each block
+  from a MEASUREMENTS response, for SpdmGetMeasurementRange.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementOperation         The measurement operation of the request message.
+  @param  NumberOfBlocks               The number of blocks of the response.
+  @param  MeasurementRecordLength      Size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to the measurement record, or NULL.
+**/
+STATIC
+VOID
+SpdmMeasurementLearnRecord (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementOperation,
+  IN     UINT8                NumberOfBlocks,
+  IN     UINT32               MeasurementRecordLength,
+  IN     VOID                 *MeasurementRecord
+  )
+{
+  SPDM_MEASUREMENT_CACHE                    *Cache;
+  SPDM_MEASUREMENT_BLOCK_COMMON_HEADER      *MeasurementBlockHeader;
+  UINTN                                     MeasurementBlockSize;
+  UINT32                                    Offset;
+  UINT8                                     MeasurementBlockCount;
+  SPDM_MESSAGE_FIELD_VIEW                   BlockView[SPDM_MEASUREMENT_BLOCK_FIELD_COUNT];
+  RETURN_STATUS                             Status;
+
+  Cache = &SpdmContext->ConnectionInfo.MeasurementCache;
+  if (MeasurementOperation == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS) {
+    Cache->LearnedBlockCount = NumberOfBlocks;
+    return;
+  }
+  if (MeasurementRecord == NULL) {
+    return;
+  }
+
+  Offset = 0;
+  MeasurementBlockCount = 0;
+  while (Offset < MeasurementRecordLength) {
+    MeasurementBlockHeader = (SPDM_MEASUREMENT_BLOCK_COMMON_HEADER *)((UINT8 *)MeasurementRecord + Offset);
+    Status = SpdmParseMessage (mSpdmMeasurementBlockLayout, SPDM_MEASUREMENT_BLOCK_FIELD_COUNT, NULL, MeasurementBlockHeader, MeasurementRecordLength - Offset, BlockView, &MeasurementBlockSize);
+    if (RETURN_ERROR(Status)) {
+      return;
+    }
+    if ((MeasurementBlockHeader->Index != 0) && (MeasurementBlockHeader->Index <= MAX_SPDM_MEASUREMENT_BLOCK_COUNT)) {
+      Cache->LearnedBlockSize[MeasurementBlockHeader->Index - 1] = (UINT32)MeasurementBlockSize;
+    }
+    MeasurementBlockCount++;
+    Offset += (UINT32)MeasurementBlockSize;
+  }
+  if (MeasurementOperation == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS) {
+    Cache->LearnedBlockCount = MeasurementBlockCount;
+  }
+}
+
+/**
+  This function sends GET_MEASUREMENT
+  to get measurement from the device, and retries if the device is busy.
+
+  The measurement cache is not used.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestAttribute             The request attribute of the request message.
+  @param  MeasurementOperation         The measurement operation of the request message.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  NumberOfBlocks               The number of blocks of the measurement record.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+
+  @retval RETURN_SUCCESS               The measurement is got successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena is too small for the response.
+**/
+RETURN_STATUS
+SpdmSendReceiveGetMeasurement (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT8                RequestAttribute,
+  IN     UINT8                MeasurementOperation,
+  IN     UINT8                SlotIdParam,
+     OUT UINT8                *NumberOfBlocks,
+  IN OUT UINT32               *MeasurementRecordLength,
+     OUT VOID                 *MeasurementRecord
+  )
+{
+  RETURN_STATUS                  Status;
+  SPDM_MEASUREMENTS_RESPONSE_MAX *SpdmResponse;
+
+  //
+  // The response holds a whole measurement record, so it is too large for the stack.
+  //
+  SpdmResponse = SpdmAcquireScratch (SpdmContext, sizeof(SPDM_MEASUREMENTS_RESPONSE_MAX));
+  if (SpdmResponse == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  Status = SpdmRetryGetMeasurement (SpdmContext, SessionId, RequestAttribute, MeasurementOperation, SlotIdParam, NumberOfBlocks, MeasurementRecordLength, MeasurementRecord, SpdmResponse, NULL);
+  SpdmReleaseScratch (SpdmContext, SpdmResponse);
+  if (!RETURN_ERROR(Status)) {
+    SpdmMeasurementLearnRecord (SpdmContext, MeasurementOperation, *NumberOfBlocks, *MeasurementRecordLength, MeasurementRecord);
+  }
+  return Status;
+}
+
+/**
+  This function clears the measurement cache of the connection.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmMeasurementCacheReset (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  ZeroMem (&SpdmContext->ConnectionInfo.MeasurementCache, sizeof(SpdmContext->ConnectionInfo.MeasurementCache));
+}
+
+/**
+  This function invalidates all measurement blocks in the measurement cache of the connection.
+
+  The last measurement summary hash is kept.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmMeasurementCacheInvalidate (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_MEASUREMENT_CACHE                    *Cache;
+  UINTN                                     Index;
+
+  Cache = &SpdmContext->ConnectionInfo.MeasurementCache;
+  for (Index = 0; Index < MAX_SPDM_MEASUREMENT_BLOCK_COUNT; Index++) {
+    Cache->Entry[Index].Valid = FALSE;
+  }
+}
+
+/**
+  This function records a verified measurement summary hash of CHALLENGE_AUTH or KEY_EXCHANGE_RSP.
+
+  If the hash differs from the last one of the same type, the measurement blocks changed,
+  and the measurement cache is invalidated.
+  If the hash of all measurements is unchanged, the cached blocks are still current, and they are fresh again.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementHashType          The type of the measurement summary hash.
+  @param  MeasurementSummaryHash       A pointer to the measurement summary hash.
+**/
+VOID
+SpdmMeasurementCacheRecordSummaryHash (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementHashType,
+  IN     VOID                 *MeasurementSummaryHash
+  )
+{
+  SPDM_MEASUREMENT_CACHE                    *Cache;
+  UINT32                                    HashSize;
+  UINTN                                     Index;
+
+  HashSize = SpdmGetMeasurementSummaryHashSize (SpdmContext, TRUE, MeasurementHashType);
+  if (HashSize == 0) {
+    return;
+  }
+
+  Cache = &SpdmContext->ConnectionInfo.MeasurementCache;
+  if (Cache->SummaryHashType == MeasurementHashType) {
+    if (CompareMem (Cache->SummaryHash, MeasurementSummaryHash, HashSize) != 0) {
+      DEBUG((DEBUG_INFO, "MeasurementCache - summary hash changed\n"));
+      SpdmMeasurementCacheInvalidate (SpdmContext);
+    } else if (MeasurementHashType == SPDM_CHALLENGE_REQUEST_ALL_MEASUREMENTS_HASH) {
+      for (Index = 0; Index < MAX_SPDM_MEASUREMENT_BLOCK_COUNT; Index++) {
+        Cache->Entry[Index].Age = 0;
+      }
+    }
+  }
+  Cache->SummaryHashType = MeasurementHashType;
+  CopyMem (Cache->SummaryHash, MeasurementSummaryHash, HashSize);
+}
+
+/**
+  This function returns the cached measurement block of a measurement index.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementIndex             The measurement index.
+
+  @return the cache entry of the block, or NULL if the block is not cached.
+**/
+SPDM_MEASUREMENT_CACHE_ENTRY *
+SpdmMeasurementCacheGetEntry (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementIndex
+  )
+{
+  SPDM_MEASUREMENT_CACHE_ENTRY              *Entry;
+
+  if ((MeasurementIndex == 0) || (MeasurementIndex > MAX_SPDM_MEASUREMENT_BLOCK_COUNT)) {
+    return NULL;
+  }
+  Entry = &SpdmContext->ConnectionInfo.MeasurementCache.Entry[MeasurementIndex - 1];
+  if (!Entry->Valid) {
+    return NULL;
+  }
+  return Entry;
+}
+
+/**
+  This function checks if the cached measurement block of a measurement index can be reused.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementIndex             The measurement index.
+
+  @retval TRUE  The block is cached, and it is not older than the maximum age.
+  @retval FALSE The block needs to be fetched from the device.
+**/
+BOOLEAN
+SpdmMeasurementCacheIsFresh (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementIndex
+  )
+{
+  SPDM_MEASUREMENT_CACHE_ENTRY              *Entry;
+
+  if (SpdmContext->LocalContext.MeasurementCacheMaxAge == 0) {
+    return FALSE;
+  }
+  if (SpdmContext->ConnectionInfo.ConnectionState < SpdmConnectionStateNegotiated) {
+    return FALSE;
+  }
+  Entry = SpdmMeasurementCacheGetEntry (SpdmContext, MeasurementIndex);
+  if (Entry == NULL) {
+    return FALSE;
+  }
+  return (BOOLEAN)(Entry->Age < SpdmContext->LocalContext.MeasurementCacheMaxAge);
+}
+
+/**
+  This function caches the measurement blocks of a verified measurement record.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementRecordLength      Size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to the measurement record.
+**/
+VOID
+SpdmMeasurementCacheInsert (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               MeasurementRecordLength,
+  IN     VOID                 *MeasurementRecord
+  )
+{
+  SPDM_MEASUREMENT_BLOCK_COMMON_HEADER      *MeasurementBlockHeader;
+  SPDM_MEASUREMENT_CACHE_ENTRY              *Entry;
+  UINTN                                     MeasurementBlockSize;
+  UINT32                                    Offset;
+  SPDM_MESSAGE_FIELD_VIEW                   BlockView[SPDM_MEASUREMENT_BLOCK_FIELD_COUNT];
+  RETURN_STATUS                             Status;
+
+  if (SpdmContext->LocalContext.MeasurementCacheMaxAge == 0) {
+    return;
+  }
+
+  Offset = 0;
+  while (Offset < MeasurementRecordLength) {
+    MeasurementBlockHeader = (SPDM_MEASUREMENT_BLOCK_COMMON_HEADER *)((UINT8 *)MeasurementRecord + Offset);
+    Status = SpdmParseMessage (mSpdmMeasurementBlockLayout, SPDM_MEASUREMENT_BLOCK_FIELD_COUNT, NULL, MeasurementBlockHeader, MeasurementRecordLength - Offset, BlockView, &MeasurementBlockSize);
+    if (RETURN_ERROR(Status)) {
+      break;
+    }
+    if ((MeasurementBlockHeader->Index != 0) &&
+        (MeasurementBlockHeader->Index <= MAX_SPDM_MEASUREMENT_BLOCK_COUNT) &&
+        (MeasurementBlockSize <= sizeof(Entry->Block))) {
+      Entry = &SpdmContext->ConnectionInfo.MeasurementCache.Entry[MeasurementBlockHeader->Index - 1];
+      CopyMem (Entry->Block, MeasurementBlockHeader, MeasurementBlockSize);
+      Entry->BlockSize = (UINT32)MeasurementBlockSize;
+      Entry->Age = 0;
+      Entry->Valid = TRUE;
+    }
+    Offset += (UINT32)MeasurementBlockSize;
+  }
+}
+
+/**
+  This function sends GET_MEASUREMENT
+  to get measurement from the device.
+
+  If the signature is requested, this function verifies the signature of the measurement.
+
+  If the measurement cache is enabled with SpdmDataMeasurementCacheMaxAge, the blocks verified with a signature
+  or in a session are cached. A request for one measurement index without signature is served from the cache,
+  until the block is reused for the maximum age.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestAttribute             The request attribute of the request message.
+  @param  MeasurementOperation         The measurement operation of the request message.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  NumberOfBlocks               The number of blocks of the measurement record.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+
+  @retval RETURN_SUCCESS               The measurement is got successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
 RETURN_STATUS
 EFIAPI
 SpdmGetMeasurement (
@@ -373,19 +789,755 @@ SpdmGetMeasurement (
      OUT VOID                 *MeasurementRecord
   )
 {
-  SPDM_DEVICE_CONTEXT    *SpdmContext;
-  UINTN                   Retry;
-  RETURN_STATUS           Status;
+  return SpdmGetMeasurementEx (Context, SessionId, RequestAttribute, MeasurementOperation, SlotIdParam, NumberOfBlocks, MeasurementRecordLength, MeasurementRecord, NULL);
+}
+
+/**
+  This function sends GET_MEASUREMENT to get measurement from the device,
+  and returns how fresh the measurement is.
+
+  It is SpdmGetMeasurement with Freshness. A verifier which accepts the measurements of the last reset
+  can use the measurement cache on purpose, as the responder without MEAS_FRESH_CAP returns the same blocks
+  until it is reset or its measurements change at runtime.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestAttribute             The request attribute of the request message.
+  @param  MeasurementOperation         The measurement operation of the request message.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  NumberOfBlocks               The number of blocks of the measurement record.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+  @param  Freshness                    How fresh the measurement record is.
+
+  @retval RETURN_SUCCESS               The measurement is got successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetMeasurementEx (
+  IN     VOID                       *Context,
+  IN     UINT32                     *SessionId,
+  IN     UINT8                      RequestAttribute,
+  IN     UINT8                      MeasurementOperation,
+  IN     UINT8                      SlotIdParam,
+     OUT UINT8                      *NumberOfBlocks,
+  IN OUT UINT32                     *MeasurementRecordLength,
+     OUT VOID                       *MeasurementRecord,
+     OUT SPDM_MEASUREMENT_FRESHNESS *Freshness OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_MEASUREMENT_CACHE_ENTRY              *Entry;
+  RETURN_STATUS                             Status;
 
   SpdmContext = Context;
-  Retry = SpdmContext->RetryTimes;
-  do {
-    Status = TrySpdmGetMeasurement(SpdmContext, SessionId, RequestAttribute, MeasurementOperation, SlotIdParam, NumberOfBlocks, MeasurementRecordLength, MeasurementRecord);
-    if (RETURN_NO_RESPONSE != Status) {
+
+  if ((RequestAttribute == 0) && SpdmMeasurementCacheIsFresh (SpdmContext, MeasurementOperation)) {
+    Entry = SpdmMeasurementCacheGetEntry (SpdmContext, MeasurementOperation);
+    if (*MeasurementRecordLength < Entry->BlockSize) {
+      return RETURN_BUFFER_TOO_SMALL;
+    }
+    Entry->Age++;
+    *NumberOfBlocks = 1;
+    *MeasurementRecordLength = Entry->BlockSize;
+    CopyMem (MeasurementRecord, Entry->Block, Entry->BlockSize);
+    if (Freshness != NULL) {
+      *Freshness = SpdmMeasurementFreshnessCached;
+    }
+    return RETURN_SUCCESS;
+  }
+
+  Status = SpdmSendReceiveGetMeasurement (SpdmContext, SessionId, RequestAttribute, MeasurementOperation, SlotIdParam, NumberOfBlocks, MeasurementRecordLength, MeasurementRecord);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  if ((MeasurementOperation != SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS) &&
+      ((RequestAttribute == SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE) || (SessionId != NULL))) {
+    SpdmMeasurementCacheInsert (SpdmContext, *MeasurementRecordLength, MeasurementRecord);
+  }
+  if (Freshness != NULL) {
+    if (SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_FRESH_CAP)) {
+      *Freshness = SpdmMeasurementFreshnessFresh;
+    } else {
+      *Freshness = SpdmMeasurementFreshnessReset;
+    }
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function gets the measurement blocks of a list of measurement indices,
+  and fetches from the device only the blocks which are not fresh in the measurement cache.
+
+  The stale blocks are fetched with one GET_MEASUREMENTS per index. If the signature is requested,
+  only the last GET_MEASUREMENTS requests it, and the signature covers all blocks fetched before.
+  If every block is fresh, no message is sent.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestAttribute             The request attribute of the last request message.
+  @param  SlotIdParam                  The number of slot for the certificate chain.
+  @param  IndexCount                   The number of measurement indices in IndexList.
+  @param  IndexList                    The measurement indices, from 1 to 0xFE.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+                                       It holds one block per index, in the order of IndexList.
+
+  @retval RETURN_SUCCESS               The measurement is got successfully.
+  @retval RETURN_INVALID_PARAMETER     A measurement index is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The measurement record buffer is too small.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetCachedMeasurements (
+  IN     VOID                 *Context,
+  IN     UINT32               *SessionId,
+  IN     UINT8                RequestAttribute,
+  IN     UINT8                SlotIdParam,
+  IN     UINT8                IndexCount,
+  IN     UINT8                *IndexList,
+  IN OUT UINT32               *MeasurementRecordLength,
+     OUT VOID                 *MeasurementRecord
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_MEASUREMENT_CACHE_ENTRY              *Entry;
+  RETURN_STATUS                             Status;
+  BOOLEAN                                   Fresh[MAX_UINT8];
+  UINTN                                     LastStale;
+  UINTN                                     Index;
+  UINT32                                    Offset;
+  UINT32                                    BlockLength;
+  UINT8                                     NumberOfBlocks;
+  BOOLEAN                                   Verified;
+
+  SpdmContext = Context;
+
+  LastStale = IndexCount;
+  for (Index = 0; Index < IndexCount; Index++) {
+    if ((IndexList[Index] == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS) ||
+        (IndexList[Index] == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    Fresh[Index] = SpdmMeasurementCacheIsFresh (SpdmContext, IndexList[Index]);
+    if (!Fresh[Index]) {
+      LastStale = Index;
+    }
+  }
+  Verified = (BOOLEAN)((RequestAttribute == SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE) || (SessionId != NULL));
+
+  Offset = 0;
+  for (Index = 0; Index < IndexCount; Index++) {
+    BlockLength = *MeasurementRecordLength - Offset;
+    if (Fresh[Index]) {
+      Entry = SpdmMeasurementCacheGetEntry (SpdmContext, IndexList[Index]);
+      if (BlockLength < Entry->BlockSize) {
+        return RETURN_BUFFER_TOO_SMALL;
+      }
+      Entry->Age++;
+      BlockLength = Entry->BlockSize;
+      CopyMem ((UINT8 *)MeasurementRecord + Offset, Entry->Block, BlockLength);
+    } else {
+      Status = SpdmSendReceiveGetMeasurement (
+                 SpdmContext,
+                 SessionId,
+                 (Index == LastStale) ? RequestAttribute : 0,
+                 IndexList[Index],
+                 SlotIdParam,
+                 &NumberOfBlocks,
+                 &BlockLength,
+                 (UINT8 *)MeasurementRecord + Offset
+                 );
+      if (RETURN_ERROR(Status)) {
+        //
+        // The blocks fetched before are not covered by a signature.
+        //
+        if (SessionId == NULL) {
+          SpdmMeasurementCacheInvalidate (SpdmContext);
+        }
+        return Status;
+      }
+      //
+      // The block is verified by the signature of the last GET_MEASUREMENTS, or by the session.
+      //
+      if (Verified) {
+        SpdmMeasurementCacheInsert (SpdmContext, BlockLength, (UINT8 *)MeasurementRecord + Offset);
+      }
+    }
+    Offset += BlockLength;
+  }
+
+  *MeasurementRecordLength = Offset;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function returns the expected size of a measurement block of the device.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Index                        The measurement index.
+
+  @return the size in bytes of the block in the last MEASUREMENTS carrying it,
+          or the size of a DMTF block with a digest of the measurement hash algorithm.
+**/
+STATIC
+UINTN
+SpdmMeasurementRangeBlockSize (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                Index
+  )
+{
+  SPDM_MEASUREMENT_CACHE                    *Cache;
+
+  Cache = &SpdmContext->ConnectionInfo.MeasurementCache;
+  if ((Index != 0) && (Index <= MAX_SPDM_MEASUREMENT_BLOCK_COUNT) && (Cache->LearnedBlockSize[Index - 1] != 0)) {
+    return Cache->LearnedBlockSize[Index - 1];
+  }
+  return sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + GetSpdmMeasurementHashSize (SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo);
+}
+
+/**
+  This function returns the cost of one GET_MEASUREMENTS.
+
+  The cost is the request and response bytes, plus the transport maximum message size for each message
+  of the transport maximum message size the response takes, so that a round trip weighs as much as
+  a full message. Without a transport maximum message size, the response takes one round trip
+  of the small message buffer size.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SignatureRequired            TRUE if the signature is requested.
+  @param  MeasurementRecordLength      The expected size in bytes of the measurement record.
+
+  @return the cost of the GET_MEASUREMENTS.
+**/
+STATIC
+UINTN
+SpdmMeasurementRangeExchangeCost (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     BOOLEAN              SignatureRequired,
+  IN     UINTN                MeasurementRecordLength
+  )
+{
+  UINTN                                     RequestSize;
+  UINTN                                     ResponseSize;
+  UINTN                                     RoundTripSize;
+
+  if (SignatureRequired) {
+    RequestSize = sizeof(SPDM_GET_MEASUREMENTS_REQUEST);
+  } else {
+    RequestSize = sizeof(SPDM_MESSAGE_HEADER);
+  }
+  ResponseSize = sizeof(SPDM_MEASUREMENTS_RESPONSE) + MeasurementRecordLength + SPDM_NONCE_SIZE + sizeof(UINT16);
+  if (SignatureRequired) {
+    ResponseSize += GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
+  }
+
+  RoundTripSize = SpdmContext->LocalContext.TransportMaxMessageSize;
+  if (RoundTripSize == 0) {
+    return RequestSize + ResponseSize + MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE;
+  }
+  return RequestSize + ResponseSize + (ResponseSize + RoundTripSize - 1) / RoundTripSize * RoundTripSize;
+}
+
+/**
+  This function checks if SpdmGetMeasurementRange fetches a set of measurement indices with one GET_MEASUREMENTS
+  for all blocks, rather than with one GET_MEASUREMENTS per index.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SignatureRequired            TRUE if the signature of the measurements is requested.
+  @param  IndexCount                   The number of measurement indices in IndexList.
+  @param  IndexList                    The measurement indices.
+
+  @retval TRUE  All blocks are fetched at once.
+  @retval FALSE The blocks are fetched one per index.
+**/
+BOOLEAN
+SpdmMeasurementRangeUseAll (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     BOOLEAN              SignatureRequired,
+  IN     UINT8                IndexCount,
+  IN     UINT8                *IndexList
+  )
+{
+  SPDM_MEASUREMENT_CACHE                    *Cache;
+  UINTN                                     AllRecordLength;
+  UINTN                                     AllCost;
+  UINTN                                     PerIndexCost;
+  UINTN                                     Index;
+
+  Cache = &SpdmContext->ConnectionInfo.MeasurementCache;
+  if (IndexCount <= 1) {
+    return FALSE;
+  }
+  //
+  // Fetching all blocks learns the number of blocks and their sizes.
+  //
+  if (Cache->LearnedBlockCount == 0) {
+    return TRUE;
+  }
+
+  AllRecordLength = 0;
+  for (Index = 1; Index <= Cache->LearnedBlockCount; Index++) {
+    AllRecordLength += SpdmMeasurementRangeBlockSize (SpdmContext, (UINT8)Index);
+  }
+  AllCost = SpdmMeasurementRangeExchangeCost (SpdmContext, SignatureRequired, AllRecordLength);
+
+  PerIndexCost = 0;
+  for (Index = 0; Index < IndexCount; Index++) {
+    PerIndexCost += SpdmMeasurementRangeExchangeCost (
+                      SpdmContext,
+                      (BOOLEAN)(SignatureRequired && (Index == IndexCount - 1U)),
+                      SpdmMeasurementRangeBlockSize (SpdmContext, IndexList[Index])
+                      );
+  }
+
+  return (BOOLEAN)(AllCost <= PerIndexCost);
+}
+
+/**
+  This function finds the measurement block of a measurement index in a measurement record.
+
+  @param  MeasurementRecordLength      Size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to the measurement record.
+  @param  Index                        The measurement index.
+  @param  MeasurementBlock             The measurement block found.
+  @param  MeasurementBlockSize         Size in bytes of the measurement block found.
+
+  @retval RETURN_SUCCESS               The measurement block is found.
+  @retval RETURN_NOT_FOUND             The measurement record has no block of the measurement index.
+**/
+STATIC
+RETURN_STATUS
+SpdmMeasurementRangeFindBlock (
+  IN     UINT32                                MeasurementRecordLength,
+  IN     VOID                                  *MeasurementRecord,
+  IN     UINT8                                 Index,
+     OUT SPDM_MEASUREMENT_BLOCK_COMMON_HEADER  **MeasurementBlock,
+     OUT UINT32                                *MeasurementBlockSize
+  )
+{
+  SPDM_MEASUREMENT_BLOCK_COMMON_HEADER      *MeasurementBlockHeader;
+  UINTN                                     BlockSize;
+  UINT32                                    Offset;
+  SPDM_MESSAGE_FIELD_VIEW                   BlockView[SPDM_MEASUREMENT_BLOCK_FIELD_COUNT];
+  RETURN_STATUS                             Status;
+
+  Offset = 0;
+  while (Offset < MeasurementRecordLength) {
+    MeasurementBlockHeader = (SPDM_MEASUREMENT_BLOCK_COMMON_HEADER *)((UINT8 *)MeasurementRecord + Offset);
+    Status = SpdmParseMessage (mSpdmMeasurementBlockLayout, SPDM_MEASUREMENT_BLOCK_FIELD_COUNT, NULL, MeasurementBlockHeader, MeasurementRecordLength - Offset, BlockView, &BlockSize);
+    if (RETURN_ERROR(Status)) {
+      break;
+    }
+    if (MeasurementBlockHeader->Index == Index) {
+      *MeasurementBlock = MeasurementBlockHeader;
+      *MeasurementBlockSize = (UINT32)BlockSize;
+      return RETURN_SUCCESS;
+    }
+    Offset += (UINT32)BlockSize;
+  }
+  return RETURN_NOT_FOUND;
+}
+
+/**
+  This function gets the measurement blocks of a set of measurement indices, with the fewest round trips and bytes.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  SignatureRequired            TRUE to request the signature of the measurements.
+  @param  SlotIdParam                  The number of slot for the certificate chain.
+  @param  IndexCount                   The number of measurement indices in IndexList.
+  @param  IndexList                    The measurement indices, from 1 to 0xFE.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+                                       It holds one block per index, in the order of IndexList.
+  @param  BlockList                    A pointer to IndexCount parsed blocks, in the order of IndexList.
+                                       They point to the measurement record.
+
+  @retval RETURN_SUCCESS               The measurement is got successfully.
+  @retval RETURN_INVALID_PARAMETER     A measurement index is invalid.
+  @retval RETURN_NOT_FOUND             The device has no block of a measurement index.
+  @retval RETURN_BUFFER_TOO_SMALL      The measurement record buffer is too small.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena is too small for the response.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetMeasurementRange (
+  IN     VOID                         *Context,
+  IN     UINT32                       *SessionId,
+  IN     BOOLEAN                      SignatureRequired,
+  IN     UINT8                        SlotIdParam,
+  IN     UINT8                        IndexCount,
+  IN     UINT8                        *IndexList,
+  IN OUT UINT32                       *MeasurementRecordLength,
+     OUT VOID                         *MeasurementRecord,
+     OUT SPDM_MEASUREMENT_BLOCK_INFO  *BlockList
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_MEASUREMENT_BLOCK_COMMON_HEADER      *MeasurementBlockHeader;
+  SPDM_MEASUREMENT_BLOCK_DMTF_HEADER        *DmtfHeader;
+  RETURN_STATUS                             Status;
+  UINT8                                     RequestAttribute;
+  UINT8                                     NumberOfBlocks;
+  UINT8                                     *AllRecord;
+  UINT32                                    AllRecordLength;
+  UINTN                                     Index;
+  UINT32                                    Offset;
+  UINT32                                    BlockLength;
+
+  SpdmContext = Context;
+
+  for (Index = 0; Index < IndexCount; Index++) {
+    if ((IndexList[Index] == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS) ||
+        (IndexList[Index] == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+  }
+  RequestAttribute = SignatureRequired ? SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE : 0;
+
+  Offset = 0;
+  if (SpdmMeasurementRangeUseAll (SpdmContext, SignatureRequired, IndexCount, IndexList)) {
+    AllRecord = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MEASUREMENT_RECORD_SIZE);
+    if (AllRecord == NULL) {
+      return RETURN_OUT_OF_RESOURCES;
+    }
+    AllRecordLength = MAX_SPDM_MEASUREMENT_RECORD_SIZE;
+    Status = SpdmSendReceiveGetMeasurement (
+               SpdmContext,
+               SessionId,
+               RequestAttribute,
+               SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS,
+               SlotIdParam,
+               &NumberOfBlocks,
+               &AllRecordLength,
+               AllRecord
+               );
+    for (Index = 0; (Index < IndexCount) && !RETURN_ERROR(Status); Index++) {
+      Status = SpdmMeasurementRangeFindBlock (AllRecordLength, AllRecord, IndexList[Index], &MeasurementBlockHeader, &BlockLength);
+      if (RETURN_ERROR(Status)) {
+        break;
+      }
+      if (*MeasurementRecordLength - Offset < BlockLength) {
+        Status = RETURN_BUFFER_TOO_SMALL;
+        break;
+      }
+      CopyMem ((UINT8 *)MeasurementRecord + Offset, MeasurementBlockHeader, BlockLength);
+      Offset += BlockLength;
+    }
+    SpdmReleaseScratch (SpdmContext, AllRecord);
+    if (RETURN_ERROR(Status)) {
       return Status;
     }
-  } while (Retry-- != 0);
+  } else {
+    for (Index = 0; Index < IndexCount; Index++) {
+      BlockLength = *MeasurementRecordLength - Offset;
+      Status = SpdmSendReceiveGetMeasurement (
+                 SpdmContext,
+                 SessionId,
+                 (Index == IndexCount - 1U) ? RequestAttribute : 0,
+                 IndexList[Index],
+                 SlotIdParam,
+                 &NumberOfBlocks,
+                 &BlockLength,
+                 (UINT8 *)MeasurementRecord + Offset
+                 );
+      if (RETURN_ERROR(Status)) {
+        return Status;
+      }
+      Offset += BlockLength;
+    }
+  }
+  *MeasurementRecordLength = Offset;
 
+  //
+  // Each block is checked by TrySpdmGetMeasurement, so the record holds one well-formed block per index.
+  //
+  Offset = 0;
+  for (Index = 0; Index < IndexCount; Index++) {
+    MeasurementBlockHeader = (SPDM_MEASUREMENT_BLOCK_COMMON_HEADER *)((UINT8 *)MeasurementRecord + Offset);
+    ZeroMem (&BlockList[Index], sizeof(BlockList[Index]));
+    BlockList[Index].Index = MeasurementBlockHeader->Index;
+    BlockList[Index].MeasurementSpecification = MeasurementBlockHeader->MeasurementSpecification;
+    BlockList[Index].BlockSize = sizeof(SPDM_MEASUREMENT_BLOCK_COMMON_HEADER) + MeasurementBlockHeader->MeasurementSize;
+    BlockList[Index].Block = MeasurementBlockHeader;
+    if ((MeasurementBlockHeader->MeasurementSpecification == SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF) &&
+        (MeasurementBlockHeader->MeasurementSize >= sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER))) {
+      DmtfHeader = (SPDM_MEASUREMENT_BLOCK_DMTF_HEADER *)(MeasurementBlockHeader + 1);
+      if (DmtfHeader->DMTFSpecMeasurementValueSize <= MeasurementBlockHeader->MeasurementSize - sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER)) {
+        BlockList[Index].DmtfValueType = DmtfHeader->DMTFSpecMeasurementValueType;
+        BlockList[Index].DmtfValueSize = DmtfHeader->DMTFSpecMeasurementValueSize;
+        BlockList[Index].DmtfValue = (UINT8 *)(DmtfHeader + 1);
+      }
+    }
+    Offset += BlockList[Index].BlockSize;
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function gets the measurement blocks of the device one by one, and hands each block to BlockFunc as it arrives.
+
+  The count is fetched first, and then each block with one GET_MEASUREMENTS per index, in a response buffer
+  taken from the scratch arena. If the signature is requested, only the last GET_MEASUREMENTS requests it,
+  and the signature covers all blocks fetched before. No measurement record is assembled, so the total size
+  of the blocks is not bounded. Each block is bounded by one MEASUREMENTS response, which may be retrieved by CHUNK_GET.
+  The measurement cache is not used.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestAttribute             The request attribute of the last request message.
+  @param  SlotIdParam                  The number of slot for the certificate chain.
+  @param  BlockFunc                    The function to receive each measurement block.
+  @param  BlockContext                 The context passed to BlockFunc.
+  @param  NumberOfBlocks               The number of measurement blocks of the device.
+
+  @retval RETURN_SUCCESS               All measurement blocks are received, and verified if the signature is requested.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena is too small for the response.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval others                       The status returned by BlockFunc to stop the stream.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetMeasurementStream (
+  IN     VOID                         *Context,
+  IN     UINT32                       *SessionId,
+  IN     UINT8                        RequestAttribute,
+  IN     UINT8                        SlotIdParam,
+  IN     SPDM_MEASUREMENT_BLOCK_FUNC  BlockFunc,
+  IN     VOID                         *BlockContext OPTIONAL,
+     OUT UINT8                        *NumberOfBlocks
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_MEASUREMENTS_RESPONSE_MAX            *SpdmResponse;
+  RETURN_STATUS                             Status;
+  UINTN                                     Index;
+  UINT8                                     BlockCount;
+  UINT32                                    BlockLength;
+
+  SpdmContext = Context;
+
+  SpdmResponse = SpdmAcquireScratch (SpdmContext, sizeof(SPDM_MEASUREMENTS_RESPONSE_MAX));
+  if (SpdmResponse == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  BlockLength = 0;
+  Status = SpdmRetryGetMeasurement (
+             SpdmContext,
+             SessionId,
+             0,
+             SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS,
+             SlotIdParam,
+             NumberOfBlocks,
+             &BlockLength,
+             NULL,
+             SpdmResponse,
+             NULL
+             );
+  for (Index = 1; !RETURN_ERROR(Status) && (Index <= *NumberOfBlocks); Index++) {
+    BlockLength = sizeof(SpdmResponse->MeasurementRecord);
+    Status = SpdmRetryGetMeasurement (
+               SpdmContext,
+               SessionId,
+               (Index == *NumberOfBlocks) ? RequestAttribute : 0,
+               (UINT8)Index,
+               SlotIdParam,
+               &BlockCount,
+               &BlockLength,
+               NULL,
+               SpdmResponse,
+               NULL
+               );
+    if (!RETURN_ERROR(Status)) {
+      Status = BlockFunc (BlockContext, (UINT8)Index, BlockLength, SpdmResponse->MeasurementRecord);
+    }
+  }
+  if (RETURN_ERROR(Status)) {
+    //
+    // The blocks received before are not covered by a signature.
+    //
+    SpdmResetMessageM (SpdmContext);
+  }
+
+  SpdmReleaseScratch (SpdmContext, SpdmResponse);
   return Status;
 }
 
+/**
+  Complete the oldest measurement block in flight in SpdmGetMeasurementsPipelined.
+
+  The block is inserted to the measurement cache once its signature is verified, if all blocks before are verified.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  InFlight                     The measurement block in flight.
+  @param  MeasurementRecord            The measurement record the block is stored in.
+  @param  Status                       The status of the blocks before.
+
+  @return the status of the blocks up to this one.
+**/
+RETURN_STATUS
+SpdmCompletePipelinedMeasurement (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN OUT SPDM_PIPELINED_MEASUREMENT   *InFlight,
+  IN     VOID                         *MeasurementRecord,
+  IN     RETURN_STATUS                Status
+  )
+{
+  RETURN_STATUS                             VerifyStatus;
+
+  VerifyStatus = SpdmPollVerifySignature (SpdmContext, &InFlight->Verify, TRUE);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  if (RETURN_ERROR(VerifyStatus)) {
+    SpdmContext->ErrorState = SPDM_STATUS_ERROR_MEASUREMENT_AUTH_FAILURE;
+    return VerifyStatus;
+  }
+  SpdmMeasurementCacheInsert (SpdmContext, InFlight->RecordLength, (UINT8 *)MeasurementRecord + InFlight->RecordOffset);
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function gets the measurement blocks of a list of measurement indices, each with a signature,
+  and verifies each signature while the next GET_MEASUREMENTS is sent.
+
+  Each block is fetched with one GET_MEASUREMENTS requesting a signature over it. Once the asynchronous
+  verification functions are registered with SpdmRegisterRequesterVerifyAsyncFunc, up to
+  MAX_SPDM_PIPELINED_VERIFY_COUNT signatures are verified while the next requests are sent and received.
+  The L1L2 hash of each signature is taken before the next request, so the transcript is the same as with
+  SpdmGetMeasurement. The blocks are committed to the measurement cache in order, once they and all blocks
+  before are verified. Without the asynchronous verification functions, each signature is verified at once.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  SlotIdParam                  The number of slot for the certificate chain.
+  @param  IndexCount                   The number of measurement indices in IndexList.
+  @param  IndexList                    The measurement indices, from 1 to 0xFE.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+                                       It holds one block per index, in the order of IndexList.
+                                       It is valid only if RETURN_SUCCESS is returned.
+
+  @retval RETURN_SUCCESS               The measurement is got and verified successfully.
+  @retval RETURN_INVALID_PARAMETER     A measurement index is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The measurement record buffer is too small.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena is too small for the response.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetMeasurementsPipelined (
+  IN     VOID                 *Context,
+  IN     UINT32               *SessionId,
+  IN     UINT8                SlotIdParam,
+  IN     UINT8                IndexCount,
+  IN     UINT8                *IndexList,
+  IN OUT UINT32               *MeasurementRecordLength,
+     OUT VOID                 *MeasurementRecord
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_MEASUREMENTS_RESPONSE_MAX            *SpdmResponse;
+  SPDM_PIPELINED_MEASUREMENT                InFlight[MAX_SPDM_PIPELINED_VERIFY_COUNT];
+  UINTN                                     Head;
+  UINTN                                     Count;
+  SPDM_PIPELINED_MEASUREMENT                *Next;
+  RETURN_STATUS                             Status;
+  UINTN                                     Index;
+  UINT32                                    Offset;
+  UINT32                                    BlockLength;
+  UINT8                                     NumberOfBlocks;
+
+  SpdmContext = Context;
+
+  for (Index = 0; Index < IndexCount; Index++) {
+    if ((IndexList[Index] == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS) ||
+        (IndexList[Index] == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+  }
+
+  SpdmResponse = SpdmAcquireScratch (SpdmContext, sizeof(SPDM_MEASUREMENTS_RESPONSE_MAX));
+  if (SpdmResponse == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  Status = RETURN_SUCCESS;
+  Head = 0;
+  Count = 0;
+  Offset = 0;
+  for (Index = 0; Index < IndexCount; Index++) {
+    if (Count == MAX_SPDM_PIPELINED_VERIFY_COUNT) {
+      Status = SpdmCompletePipelinedMeasurement (SpdmContext, &InFlight[Head], MeasurementRecord, Status);
+      Head = (Head + 1) % MAX_SPDM_PIPELINED_VERIFY_COUNT;
+      Count--;
+      if (RETURN_ERROR(Status)) {
+        break;
+      }
+    }
+    Next = &InFlight[(Head + Count) % MAX_SPDM_PIPELINED_VERIFY_COUNT];
+    Next->Verify.Pending = FALSE;
+    BlockLength = *MeasurementRecordLength - Offset;
+    Status = SpdmRetryGetMeasurement (
+               SpdmContext,
+               SessionId,
+               SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE,
+               IndexList[Index],
+               SlotIdParam,
+               &NumberOfBlocks,
+               &BlockLength,
+               (UINT8 *)MeasurementRecord + Offset,
+               SpdmResponse,
+               &Next->Verify
+               );
+    if (RETURN_ERROR(Status)) {
+      SpdmPollVerifySignature (SpdmContext, &Next->Verify, TRUE);
+      break;
+    }
+    Next->RecordOffset = Offset;
+    Next->RecordLength = BlockLength;
+    Count++;
+    Offset += BlockLength;
+  }
+
+  //
+  // The verifications in flight are completed even after a failure, so that no token is left pending.
+  //
+  while (Count != 0) {
+    Status = SpdmCompletePipelinedMeasurement (SpdmContext, &InFlight[Head], MeasurementRecord, Status);
+    Head = (Head + 1) % MAX_SPDM_PIPELINED_VERIFY_COUNT;
+    Count--;
+  }
+  SpdmReleaseScratch (SpdmContext, SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  *MeasurementRecordLength = Offset;
+  return RETURN_SUCCESS;
+}
@@ -19,102 +19,135 @@ typedef struct {
 #pragma pack()
 
 /**
-  This function sends GET_VERSION and receives VERSION.
+  This function builds GET_VERSION.
 
   @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the GET_VERSION request.
+  @param  Request                      A pointer to a destination buffer to store the GET_VERSION request.
 
-  @retval RETURN_SUCCESS               The GET_VERSION is sent and the VERSION is received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SUCCESS               The GET_VERSION request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
 **/
 RETURN_STATUS
-TrySpdmGetVersion (
-  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+SpdmBuildGetVersionRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  )
+{
+  SPDM_GET_VERSION_REQUEST                  *SpdmRequest;
+
+  if (*RequestSize < sizeof(SPDM_GET_VERSION_REQUEST)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SpdmRequest = Request;
+
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNotStarted;
+  SpdmContext->ConnectionInfo.NegotiatedStateImported = FALSE;
+  SpdmResetPeerPublicKey (SpdmContext);
+  SpdmContext->ConnectionInfo.PeerDigestSlotMask = 0;
+  SpdmMeasurementCacheReset (SpdmContext);
+
+  SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+  SpdmRequest->Header.RequestResponseCode = SPDM_GET_VERSION;
+  SpdmRequest->Header.Param1 = 0;
+  SpdmRequest->Header.Param2 = 0;
+  *RequestSize = sizeof(SPDM_GET_VERSION_REQUEST);
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function processes the response to a sent GET_VERSION.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the sent GET_VERSION request.
+  @param  Request                      A pointer to the sent GET_VERSION request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+
+  @retval RETURN_SUCCESS               The VERSION is received.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid VERSION.
+**/
+RETURN_STATUS
+SpdmProcessVersionResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
   )
 {
   RETURN_STATUS                             Status;
-  SPDM_GET_VERSION_REQUEST                  SpdmRequest;
-  SPDM_VERSION_RESPONSE_MAX                 SpdmResponse;
+  SPDM_VERSION_RESPONSE_MAX                 *SpdmResponse;
   UINTN                                     SpdmResponseSize;
   UINTN                                     Index;
   UINT8                                     Version;
   UINT8                                     CompatibleVersionCount;
   SPDM_VERSION_NUMBER                       CompatibleVersionNumberEntry[MAX_SPDM_VERSION_COUNT];
 
-  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNotStarted;
-
-  SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
-  SpdmRequest.Header.RequestResponseCode = SPDM_GET_VERSION;
-  SpdmRequest.Header.Param1 = 0;
-  SpdmRequest.Header.Param2 = 0;
-  Status = SpdmSendSpdmRequest (SpdmContext, NULL, sizeof(SpdmRequest), &SpdmRequest);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
+  SpdmResponse = Response;
+  SpdmResponseSize = ResponseSize;
 
   //
   // Cache data
   //
   ResetManagedBuffer (&SpdmContext->Transcript.MessageA);
-  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+  SpdmResetMessageB (SpdmContext);
   ResetManagedBuffer (&SpdmContext->Transcript.MessageC);
-  Status = SpdmAppendMessageA (SpdmContext, &SpdmRequest, sizeof(SpdmRequest));
+  Status = SpdmAppendMessageA (SpdmContext, Request, RequestSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
-  SpdmResponseSize = sizeof(SpdmResponse);
-  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
   if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.SPDMVersion != SPDM_MESSAGE_VERSION_10) {
+  if (SpdmResponse->Header.SPDMVersion != SPDM_MESSAGE_VERSION_10) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-    ShrinkManagedBuffer(&SpdmContext->Transcript.MessageA, sizeof(SpdmRequest));
-    Status = SpdmHandleSimpleErrorResponse(SpdmContext, SpdmResponse.Header.Param1);
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
+    ShrinkManagedBuffer(&SpdmContext->Transcript.MessageA, RequestSize);
+    Status = SpdmHandleSimpleErrorResponse(SpdmContext, SpdmResponse->Header.Param1);
     if (RETURN_ERROR(Status)) {
       return Status;
     }
-  } else if (SpdmResponse.Header.RequestResponseCode != SPDM_VERSION) {
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_VERSION) {
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponseSize < sizeof(SPDM_VERSION_RESPONSE)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponseSize > sizeof(SpdmResponse)) {
+  if (SpdmResponseSize > sizeof(SPDM_VERSION_RESPONSE_MAX)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.VersionNumberEntryCount > MAX_SPDM_VERSION_COUNT) {
+  if (SpdmResponse->VersionNumberEntryCount > MAX_SPDM_VERSION_COUNT) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.VersionNumberEntryCount == 0) {
+  if (SpdmResponse->VersionNumberEntryCount == 0) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponseSize < sizeof(SPDM_VERSION_RESPONSE) + SpdmResponse.VersionNumberEntryCount * sizeof(SPDM_VERSION_NUMBER)) {
+  if (SpdmResponseSize < sizeof(SPDM_VERSION_RESPONSE) + SpdmResponse->VersionNumberEntryCount * sizeof(SPDM_VERSION_NUMBER)) {
     return RETURN_DEVICE_ERROR;
   }
-  SpdmResponseSize = sizeof(SPDM_VERSION_RESPONSE) + SpdmResponse.VersionNumberEntryCount * sizeof(SPDM_VERSION_NUMBER);
+  SpdmResponseSize = sizeof(SPDM_VERSION_RESPONSE) + SpdmResponse->VersionNumberEntryCount * sizeof(SPDM_VERSION_NUMBER);
   //
   // Cache data
   //
-  Status = SpdmAppendMessageA (SpdmContext, &SpdmResponse, SpdmResponseSize);
+  Status = SpdmAppendMessageA (SpdmContext, SpdmResponse, SpdmResponseSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
   CompatibleVersionCount = 0;
 
   ZeroMem (&CompatibleVersionNumberEntry, sizeof(CompatibleVersionNumberEntry));
-  for (Index = 0; Index < SpdmResponse.VersionNumberEntryCount; Index++) {
-    Version = (UINT8)((SpdmResponse.VersionNumberEntry[Index].MajorVersion << 4) |
-                                                         SpdmResponse.VersionNumberEntry[Index].MinorVersion);
+  for (Index = 0; Index < SpdmResponse->VersionNumberEntryCount; Index++) {
+    Version = (UINT8)((SpdmResponse->VersionNumberEntry[Index].MajorVersion << 4) |
+                                                         SpdmResponse->VersionNumberEntry[Index].MinorVersion);
 
     if (Version == SPDM_MESSAGE_VERSION_11 || Version == SPDM_MESSAGE_VERSION_10) {
-      CompatibleVersionNumberEntry[CompatibleVersionCount] = SpdmResponse.VersionNumberEntry[Index];
+      CompatibleVersionNumberEntry[CompatibleVersionCount] = SpdmResponse->VersionNumberEntry[Index];
       CompatibleVersionCount++;
     }
   }
@@ -128,6 +161,44 @@ TrySpdmGetVersion (
   return RETURN_SUCCESS;
 }
 
+/**
+  This function sends GET_VERSION and receives VERSION.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval RETURN_SUCCESS               The GET_VERSION is sent and the VERSION is received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+TrySpdmGetVersion (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_GET_VERSION_REQUEST                  SpdmRequest;
+  UINTN                                     SpdmRequestSize;
+  SPDM_VERSION_RESPONSE_MAX                 SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+
+  SpdmRequestSize = sizeof(SpdmRequest);
+  Status = SpdmBuildGetVersionRequest (SpdmContext, &SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  SpdmResponseSize = sizeof(SpdmResponse);
+  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return SpdmProcessVersionResponse (SpdmContext, SpdmRequestSize, &SpdmRequest, SpdmResponseSize, &SpdmResponse);
+}
+
 /**
   This function sends GET_VERSION and receives VERSION.
 
@@ -30,6 +30,7 @@ typedef struct {
   @param  ExpectedResponseSize         Indicate the expected response size.
 
   @retval RETURN_SUCCESS               The RESPOND_IF_READY is sent and an expected SPDM response is received.
+  @retval RETURN_NOT_READY             The RESPOND_IF_READY is sent and another RESPONSE_NOT_READY is received.
   @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
 **/
 RETURN_STATUS
@@ -71,6 +72,11 @@ SpdmRequesterRespondIfReady (
   if (*ResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     return RETURN_DEVICE_ERROR;
   }
+  if ((SpdmResponse->RequestResponseCode == SPDM_ERROR) &&
+      (SpdmResponse->Param1 == SPDM_ERROR_CODE_RESPONSE_NOT_READY) &&
+      (*ResponseSize == sizeof(SPDM_ERROR_RESPONSE) + sizeof(SPDM_ERROR_DATA_RESPONSE_NOT_READY))) {
+    return RETURN_NOT_READY;
+  }
   if (SpdmResponse->RequestResponseCode != ExpectedResponseCode) {
     return RETURN_DEVICE_ERROR;
   }
@@ -110,6 +116,7 @@ SpdmHandleSimpleErrorResponse (
   }
 
   if (ErrorCode == SPDM_ERROR_CODE_BUSY) {
+    SpdmRequesterBackoffBusy (SpdmContext);
     return RETURN_NO_RESPONSE;
   }
 
@@ -148,20 +155,52 @@ SpdmHandleResponseNotReady (
 {
   SPDM_ERROR_RESPONSE                  *SpdmResponse;
   SPDM_ERROR_DATA_RESPONSE_NOT_READY   *ExtendErrorData;
+  RETURN_STATUS                        Status;
+  UINTN                                Retry;
+  UINT64                               WaitTime;
+  UINT64                               RemainingWaitTime;
 
   SpdmResponse = Response;
   ExtendErrorData = (SPDM_ERROR_DATA_RESPONSE_NOT_READY*)(SpdmResponse + 1);
-  ASSERT(SpdmResponse->Header.RequestResponseCode == SPDM_ERROR);
-  ASSERT(SpdmResponse->Header.Param1 == SPDM_ERROR_CODE_RESPONSE_NOT_READY);
-  ASSERT(*ResponseSize == sizeof(SPDM_ERROR_RESPONSE) + sizeof(SPDM_ERROR_DATA_RESPONSE_NOT_READY));
-  ASSERT(ExtendErrorData->RequestCode == OriginalRequestCode);
 
-  SpdmContext->ErrorData.RDTExponent = ExtendErrorData->RDTExponent;
-  SpdmContext->ErrorData.RequestCode = ExtendErrorData->RequestCode;
-  SpdmContext->ErrorData.Token       = ExtendErrorData->Token;
-  SpdmContext->ErrorData.RDTM        = ExtendErrorData->RDTM;
+  //
+  // The responder may answer RESPOND_IF_READY with another RESPONSE_NOT_READY, such as for a pending signing.
+  // With a stall function, RESPOND_IF_READY is sent after WT, then after twice the last wait each time,
+  // until WT * RDTM is waited for. Without it, RESPOND_IF_READY is retried RetryTimes.
+  //
+  Retry = (UINTN)SpdmContext->RetryTimes + 1;
+  WaitTime = SpdmGetTimingExponentValue (ExtendErrorData->RDTExponent);
+  RemainingWaitTime = WaitTime * MAX (ExtendErrorData->RDTM, 1);
+  while (TRUE) {
+    ASSERT(SpdmResponse->Header.RequestResponseCode == SPDM_ERROR);
+    ASSERT(SpdmResponse->Header.Param1 == SPDM_ERROR_CODE_RESPONSE_NOT_READY);
+    ASSERT(*ResponseSize == sizeof(SPDM_ERROR_RESPONSE) + sizeof(SPDM_ERROR_DATA_RESPONSE_NOT_READY));
+    ASSERT(ExtendErrorData->RequestCode == OriginalRequestCode);
+
+    SpdmContext->ErrorData.RDTExponent = ExtendErrorData->RDTExponent;
+    SpdmContext->ErrorData.RequestCode = ExtendErrorData->RequestCode;
+    SpdmContext->ErrorData.Token       = ExtendErrorData->Token;
+    SpdmContext->ErrorData.RDTM        = ExtendErrorData->RDTM;
+
+    if (SpdmContext->Stall != NULL) {
+      if (RemainingWaitTime == 0) {
+        break;
+      }
+      WaitTime = MIN (WaitTime, RemainingWaitTime);
+      SpdmRequesterStall (SpdmContext, WaitTime);
+      RemainingWaitTime -= WaitTime;
+      WaitTime = WaitTime * 2;
+    } else if (Retry-- == 0) {
+      break;
+    }
+
+    Status = SpdmRequesterRespondIfReady(SpdmContext, SessionId, ResponseSize, Response, ExpectedResponseCode, ExpectedResponseSize);
+    if (Status != RETURN_NOT_READY) {
+      return Status;
+    }
+  }
 
-  return SpdmRequesterRespondIfReady(SpdmContext, SessionId, ResponseSize, Response, ExpectedResponseCode, ExpectedResponseSize);
+  return RETURN_DEVICE_ERROR;
 }
 
 /**
@@ -9,6 +9,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmRequesterLibInternal.h"
 
+//
+// The heartbeat period is in seconds, and the requester time function returns 100ns units.
+//
+#define SPDM_HEARTBEAT_PERIOD_UNIT  10000000
+
+#if OPENSPDM_HBEAT_CAP_SUPPORT == 1
 #pragma pack(1)
 
 typedef struct {
@@ -92,6 +98,7 @@ TrySpdmHeartbeat (
 
   return RETURN_SUCCESS;
 }
+#endif
 
 RETURN_STATUS
 EFIAPI
@@ -100,6 +107,7 @@ SpdmHeartbeat (
   IN     UINT32               SessionId
   )
 {
+#if OPENSPDM_HBEAT_CAP_SUPPORT == 1
   UINTN                   Retry;
   RETURN_STATUS           Status;
   SPDM_DEVICE_CONTEXT     *SpdmContext;
@@ -114,5 +122,127 @@ SpdmHeartbeat (
   } while (Retry-- != 0);
 
   return Status;
+#else
+  return RETURN_UNSUPPORTED;
+#endif
+}
+
+
+/**
+  Record that a secured message of a session is received, so that its next heartbeat is postponed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the message.
+**/
+VOID
+SpdmRefreshHeartbeat (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId
+  )
+{
+  SPDM_SESSION_INFO                  *SessionInfo;
+
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  if ((SessionInfo == NULL) || (SessionInfo->HeartbeatPeriod == 0)) {
+    return;
+  }
+  SessionInfo->LastActivityTime = SpdmRequesterGetTime (SpdmContext);
 }
 
+/**
+  Return if the heartbeat of a session is due.
+
+  @param  SessionInfo                  The session info of the session.
+  @param  Now                          The current time, from SpdmRequesterGetTime.
+
+  @retval TRUE   Half of the heartbeat period passed since the last secured message received in the session.
+  @retval FALSE  The heartbeat is not due, or the session has no heartbeat.
+**/
+BOOLEAN
+SpdmIsHeartbeatDue (
+  IN     SPDM_SESSION_INFO    *SessionInfo,
+  IN     UINT64               Now
+  )
+{
+  UINT64                                    Period;
+
+  if (SessionInfo->HeartbeatPeriod == 0) {
+    return FALSE;
+  }
+  Period = (UINT64)SessionInfo->HeartbeatPeriod * SPDM_HEARTBEAT_PERIOD_UNIT;
+  return (BOOLEAN)(Now >= SessionInfo->LastActivityTime + Period / 2);
+}
+
+/**
+  Send the heartbeats due for the sessions of an SPDM context.
+
+  The heartbeat of an established session with a heartbeat period is due once half of the period passed
+  since the last secured message received in the session, and it must be sent before the whole period passed.
+  So the application messages of a session postpone its heartbeat, and the heartbeats of all sessions
+  which are due are sent on one wakeup, the earliest time a heartbeat must be sent.
+  The time function must be registered by SpdmRegisterRequesterMonitorFunc.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  NextWakeupTime               Return the earliest time a heartbeat must be sent, in 100ns units,
+                                       or 0 if no session has a heartbeat.
+                                       It is already passed if the heartbeat of a session failed.
+
+  @retval RETURN_SUCCESS               The due heartbeats are sent, or OPENSPDM_HBEAT_CAP_SUPPORT is 0.
+  @retval RETURN_NOT_STARTED           No time function is registered.
+  @retval others                       The status of the first heartbeat failing. The other heartbeats are still sent.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRunHeartbeats (
+  IN     VOID                 *Context,
+     OUT UINT64               *NextWakeupTime
+  )
+{
+#if OPENSPDM_HBEAT_CAP_SUPPORT == 1
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_SESSION_INFO                         *SessionInfo;
+  RETURN_STATUS                             Status;
+  RETURN_STATUS                             HeartbeatStatus;
+  UINT64                                    Now;
+  UINT64                                    Period;
+  UINTN                                     Index;
+
+  SpdmContext = Context;
+  *NextWakeupTime = 0;
+  if (SpdmContext->RequesterGetTimeFunc == 0) {
+    return RETURN_NOT_STARTED;
+  }
+  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP)) {
+    return RETURN_SUCCESS;
+  }
+
+  Status = RETURN_SUCCESS;
+  Now = SpdmRequesterGetTime (SpdmContext);
+  SessionInfo = SpdmContext->SessionInfo;
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if ((SessionInfo[Index].SessionId == INVALID_SESSION_ID) || (SessionInfo[Index].HeartbeatPeriod == 0)) {
+      continue;
+    }
+    if (SpdmSecuredMessageGetSessionState (SessionInfo[Index].SecuredMessageContext) != SpdmSessionStateEstablished) {
+      continue;
+    }
+    Period = (UINT64)SessionInfo[Index].HeartbeatPeriod * SPDM_HEARTBEAT_PERIOD_UNIT;
+    if (SpdmIsHeartbeatDue (&SessionInfo[Index], Now)) {
+      HeartbeatStatus = SpdmHeartbeat (SpdmContext, SessionInfo[Index].SessionId);
+      if (RETURN_ERROR(HeartbeatStatus)) {
+        DEBUG((DEBUG_INFO, "SpdmRunHeartbeats[%x] - %p\n", SessionInfo[Index].SessionId, HeartbeatStatus));
+        if (!RETURN_ERROR(Status)) {
+          Status = HeartbeatStatus;
+        }
+      }
+    }
+    if ((*NextWakeupTime == 0) || (SessionInfo[Index].LastActivityTime + Period < *NextWakeupTime)) {
+      *NextWakeupTime = SessionInfo[Index].LastActivityTime + Period;
+    }
+  }
+  return Status;
+#else
+  *NextWakeupTime = 0;
+  return RETURN_SUCCESS;
+#endif
+}
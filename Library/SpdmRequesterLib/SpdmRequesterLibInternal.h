@@ -14,6 +14,86 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/SpdmSecuredMessageLib.h>
 #include "SpdmCommonLibInternal.h"
 
+//
+// The operations run by SpdmRequesterPoolRun for each endpoint, in order.
+//
+typedef enum {
+  SpdmRequesterPoolOperationInitConnection,
+  SpdmRequesterPoolOperationGetDigest,
+  SpdmRequesterPoolOperationGetCertificate,
+  SpdmRequesterPoolOperationChallenge,
+  SpdmRequesterPoolOperationMax,
+} SPDM_REQUESTER_POOL_OPERATION;
+
+typedef struct {
+  SPDM_DEVICE_CONTEXT                  *SpdmContext;
+  SPDM_REQUESTER_POOL_OPERATION        Operation;
+  // The attestation is set by SpdmRequesterPoolSetAttestation.
+  BOOLEAN                              Configured;
+  // The operation is started, and the response to the outgoing message is expected.
+  BOOLEAN                              Started;
+  // A worker is servicing the endpoint.
+  BOOLEAN                              Claimed;
+  BOOLEAN                              Done;
+  RETURN_STATUS                        Status;
+  UINT8                                SlotNum;
+  UINT8                                MeasurementHashType;
+  UINTN                                *CertChainSize;
+  VOID                                 *CertChain;
+  VOID                                 *MeasurementHash;
+  UINT8                                IncomingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                                OutgoingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+} SPDM_REQUESTER_POOL_ENDPOINT;
+
+//
+// The endpoints follow the pool header, and the SPDM contexts follow the endpoints.
+//
+typedef struct {
+  UINTN                                EndpointCount;
+  UINTN                                DoneCount;
+  // The endpoint the next worker starts to look for work from.
+  UINTN                                NextEndpoint;
+  UINT64                               PollTimeout;
+  SPDM_REQUESTER_POOL_LOCK_FUNC        AcquireLock;
+  SPDM_REQUESTER_POOL_LOCK_FUNC        ReleaseLock;
+  VOID                                 *LockContext;
+} SPDM_REQUESTER_POOL;
+
+//
+// The finish tag of a bulk request grows by its cost shifted by SPDM_MUX_COST_SHIFT and divided by the channel weight,
+// so that the small costs of the heavy channels are not rounded to 0.
+//
+#define SPDM_MUX_COST_SHIFT  8
+
+typedef struct {
+  BOOLEAN                              IsControl;
+  UINT32                               Weight;
+  // The finish tag of the last request queued on the channel.
+  UINT64                               LastFinishTag;
+  UINTN                                Head;
+  UINTN                                Count;
+} SPDM_MUX_CHANNEL;
+
+typedef struct {
+  SPDM_MUX_REQUEST                     *Request;
+  UINT64                               FinishTag;
+} SPDM_MUX_QUEUE_ENTRY;
+
+//
+// The channels follow the multiplexer header, and the queue of each channel, of QueueDepth entries, follows the channels.
+//
+typedef struct {
+  SPDM_DEVICE_CONTEXT                  *SpdmContext;
+  UINT32                               SessionId;
+  UINTN                                ChannelCount;
+  UINTN                                QueueDepth;
+  // The finish tag of the last bulk request dispatched.
+  UINT64                               VirtualTime;
+  SPDM_REQUESTER_POOL_LOCK_FUNC        AcquireLock;
+  SPDM_REQUESTER_POOL_LOCK_FUNC        ReleaseLock;
+  VOID                                 *LockContext;
+} SPDM_MUX;
+
 /**
   This function handles simple error code.
 
@@ -116,63 +196,666 @@ SpdmNegotiateAlgorithms (
   );
 
 /**
-  This function sends KEY_EXCHANGE and receives KEY_EXCHANGE_RSP for SPDM key exchange.
+  This function builds GET_VERSION.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the GET_VERSION request.
+  @param  Request                      A pointer to a destination buffer to store the GET_VERSION request.
+
+  @retval RETURN_SUCCESS               The GET_VERSION request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+**/
+RETURN_STATUS
+SpdmBuildGetVersionRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  );
+
+/**
+  This function processes the response to a sent GET_VERSION.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the sent GET_VERSION request.
+  @param  Request                      A pointer to the sent GET_VERSION request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+
+  @retval RETURN_SUCCESS               The VERSION is received.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid VERSION.
+**/
+RETURN_STATUS
+SpdmProcessVersionResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
+  );
+
+/**
+  This function builds GET_CAPABILITIES.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the GET_CAPABILITIES request.
+  @param  Request                      A pointer to a destination buffer to store the GET_CAPABILITIES request.
+
+  @retval RETURN_SUCCESS               The GET_CAPABILITIES request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state does not allow GET_CAPABILITIES.
+**/
+RETURN_STATUS
+SpdmBuildGetCapabilitiesRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  );
+
+/**
+  This function processes the response to a sent GET_CAPABILITIES.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the sent GET_CAPABILITIES request.
+  @param  Request                      A pointer to the sent GET_CAPABILITIES request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+
+  @retval RETURN_SUCCESS               The CAPABILITIES is received.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid CAPABILITIES.
+**/
+RETURN_STATUS
+SpdmProcessCapabilitiesResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
+  );
+
+/**
+  This function builds NEGOTIATE_ALGORITHMS.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the NEGOTIATE_ALGORITHMS request.
+  @param  Request                      A pointer to a destination buffer to store the NEGOTIATE_ALGORITHMS request.
+
+  @retval RETURN_SUCCESS               The NEGOTIATE_ALGORITHMS request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state does not allow NEGOTIATE_ALGORITHMS.
+**/
+RETURN_STATUS
+SpdmBuildNegotiateAlgorithmsRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  );
+
+/**
+  This function processes the response to a sent NEGOTIATE_ALGORITHMS.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the sent NEGOTIATE_ALGORITHMS request.
+  @param  Request                      A pointer to the sent NEGOTIATE_ALGORITHMS request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+
+  @retval RETURN_SUCCESS               The ALGORITHMS is received.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid ALGORITHMS.
+  @retval RETURN_SECURITY_VIOLATION    The selected algorithms are not supported.
+**/
+RETURN_STATUS
+SpdmProcessAlgorithmsResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
+  );
+
+/**
+  This function builds GET_DIGESTS.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the GET_DIGESTS request.
+  @param  Request                      A pointer to a destination buffer to store the GET_DIGESTS request.
+
+  @retval RETURN_SUCCESS               The GET_DIGESTS request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state or the capabilities do not allow GET_DIGESTS.
+**/
+RETURN_STATUS
+SpdmBuildGetDigestRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  );
+
+/**
+  This function processes the response to a sent GET_DIGESTS.
+
+  If the peer certificate chain is deployed,
+  this function also verifies the digest with the certificate chain.
+
+  The sent GET_DIGESTS request must already be appended to Message B.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the sent GET_DIGESTS request.
+  @param  Request                      A pointer to the sent GET_DIGESTS request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+  @param  SlotMask                     The slots which deploy the CertificateChain.
+  @param  TotalDigestBuffer            A pointer to a destination buffer to store the digest buffer.
+
+  @retval RETURN_SUCCESS               The DIGESTS is received and verified.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid DIGESTS.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmProcessDigestResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response,
+     OUT UINT8                *SlotMask,
+     OUT VOID                 *TotalDigestBuffer
+  );
+
+/**
+  Return the largest Length of a GET_CERTIFICATE request.
+
+  It follows the transport maximum message size, so that the certificate chain is got in as few round trips as
+  the transport allows. The CERTIFICATE response and its transport layer wrapper are received in one
+  MAX_SPDM_MESSAGE_BUFFER_SIZE buffer.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the largest Length of a GET_CERTIFICATE request.
+**/
+UINT16
+SpdmGetCertificateRequestLength (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  This function checks if GET_CERTIFICATE can be sent, and starts to collect the certificate chain of one slot.
+
+  The certificate chain is collected in place in PeerUsedCertChainBuffer.
+  If the GET_DIGESTS digest of the slot matches a certificate chain verified before,
+  the certificate chain is collected from the cache, and no GET_CERTIFICATE needs to be sent.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  IsCached                     Indicates if the certificate chain is collected from the cache.
+
+  @retval RETURN_SUCCESS               The certificate chain collection is started.
+  @retval RETURN_UNSUPPORTED           The connection state or the capabilities do not allow GET_CERTIFICATE.
+  @retval RETURN_INVALID_PARAMETER     The slot number is invalid.
+**/
+RETURN_STATUS
+SpdmStartGetCertificate (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                SlotNum,
+     OUT BOOLEAN              *IsCached
+  );
+
+/**
+  This function builds GET_CERTIFICATE for the next portion of the certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  Length                       Length parameter in the get_certificate message (limited by SpdmGetCertificateRequestLength).
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the GET_CERTIFICATE request.
+  @param  Request                      A pointer to a destination buffer to store the GET_CERTIFICATE request.
+
+  @retval RETURN_SUCCESS               The GET_CERTIFICATE request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+**/
+RETURN_STATUS
+SpdmBuildGetCertificateRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                SlotNum,
+  IN     UINT16               Length,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  );
+
+/**
+  This function processes the response to a sent GET_CERTIFICATE, and collects the portion of the certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  RequestSize                  Size in bytes of the sent GET_CERTIFICATE request.
+  @param  Request                      A pointer to the sent GET_CERTIFICATE request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+  @param  RemainderLength              The length of the certificate chain that remains to be got.
+
+  @retval RETURN_SUCCESS               The CERTIFICATE is received.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid CERTIFICATE.
+  @retval RETURN_SECURITY_VIOLATION    The certificate chain is too large.
+**/
+RETURN_STATUS
+SpdmProcessCertificateResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                SlotNum,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response,
+     OUT UINT16               *RemainderLength
+  );
+
+/**
+  This function verifies a collected certificate chain, and returns it.
+
+  This function verify the integrity of the certificate chain.
+  RootHash -> Root certificate -> Intermediate certificate -> Leaf certificate.
+
+  If the peer root certificate hash is deployed,
+  this function also verifies the digest with the root hash in the certificate chain.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CertChainSize                On input, indicate the size in bytes of the destination buffer to store the digest buffer.
+                                       On output, indicate the size in bytes of the certificate chain.
+  @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
+
+  @retval RETURN_SUCCESS               The certificate chain is verified.
+  @retval RETURN_BUFFER_TOO_SMALL      The destination buffer is too small.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmCompleteGetCertificate (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *CertChainSize,
+     OUT VOID                 *CertChain
+  );
+
+/**
+  This function builds CHALLENGE.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the challenge.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the CHALLENGE request.
+  @param  Request                      A pointer to a destination buffer to store the CHALLENGE request.
+
+  @retval RETURN_SUCCESS               The CHALLENGE request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state or the capabilities do not allow CHALLENGE.
+  @retval RETURN_INVALID_PARAMETER     The slot number is invalid.
+**/
+RETURN_STATUS
+SpdmBuildChallengeRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                SlotNum,
+  IN     UINT8                MeasurementHashType,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  );
+
+/**
+  This function processes the response to a sent CHALLENGE, and verifies the signature in the challenge auth.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the challenge.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  RequestSize                  Size in bytes of the sent CHALLENGE request.
+  @param  Request                      A pointer to the sent CHALLENGE request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+  @param  BasicMutAuthRequested        Indicates if basic mutual authentication is requested from the responder.
+  @param  Deferred                     TRUE to verify the signature with the asynchronous verification functions.
+                                       If the verification is pending, the response is kept in the pending challenge
+                                       of the SPDM context, and committed by SpdmCompleteChallenge.
+
+  @retval RETURN_SUCCESS               The CHALLENGE_AUTH is received and verified.
+  @retval RETURN_NOT_READY             The CHALLENGE_AUTH is received, and its signature verification is pending.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid CHALLENGE_AUTH.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmProcessChallengeAuthResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                SlotNum,
+  IN     UINT8                MeasurementHashType,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response,
+     OUT VOID                 *MeasurementHash,
+     OUT BOOLEAN              *BasicMutAuthRequested,
+  IN     BOOLEAN              Deferred
+  );
+
+/**
+  This function sends GET_MEASUREMENT
+  to get measurement from the device, and retries if the device is busy.
+
+  The measurement cache is not used.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestAttribute             The request attribute of the request message.
+  @param  MeasurementOperation         The measurement operation of the request message.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  NumberOfBlocks               The number of blocks of the measurement record.
+  @param  MeasurementRecordLength      On input, indicate the size in bytes of the destination buffer to store the measurement record.
+                                       On output, indicate the size in bytes of the measurement record.
+  @param  MeasurementRecord            A pointer to a destination buffer to store the measurement record.
+
+  @retval RETURN_SUCCESS               The measurement is got successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmSendReceiveGetMeasurement (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT8                RequestAttribute,
+  IN     UINT8                MeasurementOperation,
+  IN     UINT8                SlotIdParam,
+     OUT UINT8                *NumberOfBlocks,
+  IN OUT UINT32               *MeasurementRecordLength,
+     OUT VOID                 *MeasurementRecord
+  );
+
+/**
+  This function clears the measurement cache of the connection.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmMeasurementCacheReset (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  This function checks if SpdmGetMeasurementRange fetches a set of measurement indices with one GET_MEASUREMENTS
+  for all blocks, rather than with one GET_MEASUREMENTS per index.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SignatureRequired            TRUE if the signature of the measurements is requested.
+  @param  IndexCount                   The number of measurement indices in IndexList.
+  @param  IndexList                    The measurement indices.
+
+  @retval TRUE  All blocks are fetched at once.
+  @retval FALSE The blocks are fetched one per index.
+**/
+BOOLEAN
+SpdmMeasurementRangeUseAll (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     BOOLEAN              SignatureRequired,
+  IN     UINT8                IndexCount,
+  IN     UINT8                *IndexList
+  );
+
+/**
+  This function records a verified measurement summary hash of CHALLENGE_AUTH or KEY_EXCHANGE_RSP.
+
+  If the hash differs from the last one of the same type, the measurement blocks changed,
+  and the measurement cache is invalidated.
+  If the hash of all measurements is unchanged, the cached blocks are still current, and they are fresh again.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementHashType          The type of the measurement summary hash.
+  @param  MeasurementSummaryHash       A pointer to the measurement summary hash.
+**/
+VOID
+SpdmMeasurementCacheRecordSummaryHash (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementHashType,
+  IN     VOID                 *MeasurementSummaryHash
+  );
+
+/**
+  This function sends KEY_EXCHANGE and receives KEY_EXCHANGE_RSP for SPDM key exchange.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementHashType          MeasurementHashType to the KEY_EXCHANGE request.
+  @param  SlotNum                      SlotNum to the KEY_EXCHANGE request.
+  @param  HeartbeatPeriod              HeartbeatPeriod from the KEY_EXCHANGE_RSP response.
+  @param  SessionId                    SessionId from the KEY_EXCHANGE_RSP response.
+  @param  ReqSlotIdParam               ReqSlotIdParam from the KEY_EXCHANGE_RSP response.
+  @param  MeasurementHash              MeasurementHash from the KEY_EXCHANGE_RSP response.
+
+  @retval RETURN_SUCCESS               The KEY_EXCHANGE is sent and the KEY_EXCHANGE_RSP is received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+SpdmSendReceiveKeyExchange (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementHashType,
+  IN     UINT8                SlotNum,
+     OUT UINT32               *SessionId,
+     OUT UINT8                *HeartbeatPeriod,
+     OUT UINT8                *ReqSlotIdParam,
+     OUT VOID                 *MeasurementHash
+  );
+
+/**
+  This function builds KEY_EXCHANGE, and generates the requester DHE key pair.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementHashType          MeasurementHashType to the KEY_EXCHANGE request.
+  @param  SlotNum                      SlotNum to the KEY_EXCHANGE request.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the KEY_EXCHANGE request.
+  @param  Request                      A pointer to a destination buffer to store the KEY_EXCHANGE request.
+  @param  DHEContext                   The DHE context of the requester key pair. The caller passes it back to
+                                       SpdmProcessKeyExchangeResponse, or frees it if the exchange is abandoned.
+
+  @retval RETURN_SUCCESS               The KEY_EXCHANGE request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state or the capabilities do not allow KEY_EXCHANGE.
+  @retval RETURN_INVALID_PARAMETER     The slot number is invalid.
+**/
+RETURN_STATUS
+SpdmBuildKeyExchangeRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementHashType,
+  IN     UINT8                SlotNum,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request,
+     OUT VOID                 **DHEContext
+  );
+
+/**
+  This function processes KEY_EXCHANGE_RSP, and generates the session handshake key.
+
+  The DHE context is freed on all paths.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementHashType          MeasurementHashType to the KEY_EXCHANGE request.
+  @param  RequestSize                  Size in bytes of the sent KEY_EXCHANGE request.
+  @param  Request                      A pointer to the sent KEY_EXCHANGE request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+  @param  DHEContext                   The DHE context returned by SpdmBuildKeyExchangeRequest.
+  @param  SessionId                    SessionId from the KEY_EXCHANGE_RSP response.
+  @param  HeartbeatPeriod              HeartbeatPeriod from the KEY_EXCHANGE_RSP response.
+  @param  ReqSlotIdParam               ReqSlotIdParam from the KEY_EXCHANGE_RSP response.
+  @param  MeasurementHash              MeasurementHash from the KEY_EXCHANGE_RSP response.
+
+  @retval RETURN_SUCCESS               The KEY_EXCHANGE_RSP is received and verified.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid KEY_EXCHANGE_RSP.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmProcessKeyExchangeResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementHashType,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response,
+  IN     VOID                 *DHEContext,
+     OUT UINT32               *SessionId,
+     OUT UINT8                *HeartbeatPeriod,
+     OUT UINT8                *ReqSlotIdParam,
+     OUT VOID                 *MeasurementHash
+  );
+
+/**
+  This function sends FINISH and receives FINISH_RSP for SPDM finish.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    SessionId to the FINISH request.
+  @param  ReqSlotIdParam               ReqSlotIdParam to the FINISH request.
+
+  @retval RETURN_SUCCESS               The FINISH is sent and the FINISH_RSP is received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+SpdmSendReceiveFinish (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINT8                ReqSlotIdParam
+  );
+
+/**
+  This function builds FINISH, and appends it to the session transcript with the signature and the HMAC.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    SessionId to the FINISH request.
+  @param  ReqSlotIdParam               ReqSlotIdParam to the FINISH request.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the FINISH request.
+  @param  Request                      A pointer to a destination buffer to store the FINISH request.
+
+  @retval RETURN_SUCCESS               The FINISH request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The session state or the capabilities do not allow FINISH.
+  @retval RETURN_INVALID_PARAMETER     The ReqSlotIdParam is invalid.
+  @retval RETURN_SECURITY_VIOLATION    The signature or the HMAC cannot be generated.
+**/
+RETURN_STATUS
+SpdmBuildFinishRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINT8                ReqSlotIdParam,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  );
+
+/**
+  This function processes FINISH_RSP, and generates the session data key.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    SessionId to the FINISH request.
+  @param  RequestSize                  Size in bytes of the sent FINISH request.
+  @param  Request                      A pointer to the sent FINISH request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+
+  @retval RETURN_SUCCESS               The FINISH_RSP is received and verified.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid FINISH_RSP.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmProcessFinishResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
+  );
+
+/**
+  This function sends PSK_EXCHANGE and receives PSK_EXCHANGE_RSP for SPDM PSK exchange.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  MeasurementHashType          MeasurementHashType to the KEY_EXCHANGE request.
-  @param  SlotNum                      SlotNum to the KEY_EXCHANGE request.
-  @param  HeartbeatPeriod              HeartbeatPeriod from the KEY_EXCHANGE_RSP response.
-  @param  SessionId                    SessionId from the KEY_EXCHANGE_RSP response.
-  @param  ReqSlotIdParam               ReqSlotIdParam from the KEY_EXCHANGE_RSP response.
-  @param  MeasurementHash              MeasurementHash from the KEY_EXCHANGE_RSP response.
+  @param  MeasurementHashType          MeasurementHashType to the PSK_EXCHANGE request.
+  @param  HeartbeatPeriod              HeartbeatPeriod from the PSK_EXCHANGE_RSP response.
+  @param  SessionId                    SessionId from the PSK_EXCHANGE_RSP response.
+  @param  MeasurementHash              MeasurementHash from the PSK_EXCHANGE_RSP response.
 
-  @retval RETURN_SUCCESS               The KEY_EXCHANGE is sent and the KEY_EXCHANGE_RSP is received.
+  @retval RETURN_SUCCESS               The PSK_EXCHANGE is sent and the PSK_EXCHANGE_RSP is received.
   @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
 **/
 RETURN_STATUS
-SpdmSendReceiveKeyExchange (
+SpdmSendReceivePskExchange (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
   IN     UINT8                MeasurementHashType,
-  IN     UINT8                SlotNum,
      OUT UINT32               *SessionId,
      OUT UINT8                *HeartbeatPeriod,
-     OUT UINT8                *ReqSlotIdParam,
      OUT VOID                 *MeasurementHash
   );
 
 /**
-  This function sends FINISH and receives FINISH_RSP for SPDM finish.
+  This function builds PSK_EXCHANGE.
 
   @param  SpdmContext                  A pointer to the SPDM context.
-  @param  SessionId                    SessionId to the FINISH request.
-  @param  ReqSlotIdParam               ReqSlotIdParam to the FINISH request.
+  @param  MeasurementHashType          MeasurementHashType to the PSK_EXCHANGE request.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the PSK_EXCHANGE request.
+  @param  Request                      A pointer to a destination buffer to store the PSK_EXCHANGE request.
 
-  @retval RETURN_SUCCESS               The FINISH is sent and the FINISH_RSP is received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SUCCESS               The PSK_EXCHANGE request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state or the capabilities do not allow PSK_EXCHANGE.
+  @retval RETURN_DEVICE_ERROR          The negotiated algorithms do not allow PSK_EXCHANGE.
 **/
 RETURN_STATUS
-SpdmSendReceiveFinish (
+SpdmBuildPskExchangeRequest (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
-  IN     UINT32               SessionId,
-  IN     UINT8                ReqSlotIdParam
+  IN     UINT8                MeasurementHashType,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
   );
 
 /**
-  This function sends PSK_EXCHANGE and receives PSK_EXCHANGE_RSP for SPDM PSK exchange.
+  This function processes PSK_EXCHANGE_RSP, and generates the session handshake key.
+
+  If the responder does not support PSK_FINISH, the session data key is also generated.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  MeasurementHashType          MeasurementHashType to the PSK_EXCHANGE request.
-  @param  HeartbeatPeriod              HeartbeatPeriod from the PSK_EXCHANGE_RSP response.
+  @param  RequestSize                  Size in bytes of the sent PSK_EXCHANGE request.
+  @param  Request                      A pointer to the sent PSK_EXCHANGE request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
   @param  SessionId                    SessionId from the PSK_EXCHANGE_RSP response.
+  @param  HeartbeatPeriod              HeartbeatPeriod from the PSK_EXCHANGE_RSP response.
   @param  MeasurementHash              MeasurementHash from the PSK_EXCHANGE_RSP response.
 
-  @retval RETURN_SUCCESS               The PSK_EXCHANGE is sent and the PSK_EXCHANGE_RSP is received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SUCCESS               The PSK_EXCHANGE_RSP is received and verified.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid PSK_EXCHANGE_RSP.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
 **/
 RETURN_STATUS
-SpdmSendReceivePskExchange (
+SpdmProcessPskExchangeResponse (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
   IN     UINT8                MeasurementHashType,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response,
      OUT UINT32               *SessionId,
      OUT UINT8                *HeartbeatPeriod,
      OUT VOID                 *MeasurementHash
@@ -193,6 +876,53 @@ SpdmSendReceivePskFinish (
   IN     UINT32               SessionId
   );
 
+/**
+  This function builds PSK_FINISH, and appends it to the session transcript with the HMAC.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    SessionId to the PSK_FINISH request.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the PSK_FINISH request.
+  @param  Request                      A pointer to a destination buffer to store the PSK_FINISH request.
+
+  @retval RETURN_SUCCESS               The PSK_FINISH request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The session state or the capabilities do not allow PSK_FINISH.
+**/
+RETURN_STATUS
+SpdmBuildPskFinishRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
+  );
+
+/**
+  This function processes PSK_FINISH_RSP, and generates the session data key.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    SessionId to the PSK_FINISH request.
+  @param  RequestSize                  Size in bytes of the sent PSK_FINISH request.
+  @param  Request                      A pointer to the sent PSK_FINISH request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+
+  @retval RETURN_SUCCESS               The PSK_FINISH_RSP is received.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid PSK_FINISH_RSP.
+  @retval RETURN_SECURITY_VIOLATION    The session data key cannot be generated.
+**/
+RETURN_STATUS
+SpdmProcessPskFinishResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
+  );
+
 /**
   This function sends END_SESSION and receives END_SESSION_ACK for SPDM session end.
 
@@ -388,4 +1118,359 @@ SpdmReceiveSpdmResponse (
      OUT VOID                 *Response
   );
 
+/**
+  Send an APP message of a session in chained records, encoded in place in the request buffer.
+
+  Each record is encoded at the offset of its APP message data in the request buffer.
+  Its header overwrites the records already sent, and the data after it that its tail overwrites is restored
+  once it is sent.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  Headroom                     Size in bytes of the room before the APP message.
+  @param  Tailroom                     Size in bytes of the room after the APP message.
+  @param  RecordSize                   Size in bytes of the APP message in each full record.
+  @param  Request                      A pointer to the request buffer, with the request at Headroom bytes.
+  @param  RequestSize                  Size in bytes of the request.
+
+  @retval RETURN_SUCCESS               The APP message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the APP message is sent to the device.
+**/
+RETURN_STATUS
+SpdmSendDataStream (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINTN                Headroom,
+  IN     UINTN                Tailroom,
+  IN     UINTN                RecordSize,
+  IN OUT UINT8                *Request,
+  IN     UINTN                RequestSize
+  );
+
+/**
+  Receive an APP message of a session in chained records, decoded in place in the response buffer.
+
+  Each record is received at the offset of its APP message data in the response buffer.
+  The data received before it that its header overwrites is restored once it is decoded.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  Headroom                     Size in bytes of the room before the APP message.
+  @param  RecordSize                   Size in bytes of the APP message in each full record.
+  @param  Response                     A pointer to the response buffer.
+                                       On output, the response is at Headroom bytes.
+  @param  ResponseSize                 On input, it means the size in bytes of the response buffer.
+                                       On output, it means the size in bytes of the response.
+
+  @retval RETURN_SUCCESS               The APP message is received successfully.
+  @retval RETURN_BUFFER_TOO_SMALL      The response buffer is too small to hold the response.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the APP message is received from the device.
+**/
+RETURN_STATUS
+SpdmReceiveDataStream (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINTN                Headroom,
+  IN     UINTN                RecordSize,
+     OUT UINT8                *Response,
+  IN OUT UINTN                *ResponseSize
+  );
+
+/**
+  Encode an SPDM or an APP request to a transport layer message.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    Indicate if the request is a secured message.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  RequestSize                  Size in bytes of the request data buffer.
+  @param  Request                      A pointer to a source buffer to store the request.
+  @param  MessageSize                  Size in bytes of the transport layer message buffer.
+                                       On input, it means the size in bytes of message buffer.
+                                       On output, it means the size in bytes of the transport layer message.
+  @param  Message                      A pointer to a destination buffer to store the transport layer message.
+
+  @retval RETURN_SUCCESS               The SPDM request is encoded successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM request is encoded.
+**/
+RETURN_STATUS
+SpdmEncodeRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  );
+
+/**
+  Decode an SPDM or an APP response from a transport layer message.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    Indicate if the response is a secured message.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  MessageSize                  Size in bytes of the transport layer message.
+  @param  Message                      A pointer to a source buffer to store the transport layer message.
+  @param  ResponseSize                 Size in bytes of the response data buffer.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of the response.
+  @param  Response                     A pointer to a destination buffer to store the response.
+
+  @retval RETURN_SUCCESS               The SPDM response is decoded successfully.
+  @retval RETURN_DEVICE_ERROR          The transport layer message is not the expected response.
+**/
+RETURN_STATUS
+SpdmDecodeResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  );
+
+/**
+  Return the session ID to protect an SPDM message of a session with.
+
+  The handshake messages of a KEY_EXCHANGE session are sent in the clear,
+  if HANDSHAKE_IN_THE_CLEAR_CAP is negotiated.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    On input, the session ID of the SPDM message, or NULL for a normal message.
+                                       On output, the session ID to protect the SPDM message with,
+                                       or NULL if the SPDM message is sent in the clear.
+
+  @retval RETURN_SUCCESS               The session ID is returned.
+  @retval RETURN_DEVICE_ERROR          The session ID is not found.
+**/
+RETURN_STATUS
+SpdmGetSpdmMessageSessionId (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINT32               **SessionId
+  );
+
+/**
+  Count a secured record against the key update policy of its session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the record.
+  @param  IsSend                       Indicates if the record is sent or received.
+  @param  RecordSize                   Size in bytes of the message in the record.
+**/
+VOID
+SpdmCountKeyUpdateBudget (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     BOOLEAN              IsSend,
+  IN     UINTN                RecordSize
+  );
+
+/**
+  Record that a secured message of a session is received, so that its next heartbeat is postponed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the message.
+**/
+VOID
+SpdmRefreshHeartbeat (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId
+  );
+
+/**
+  Return if the heartbeat of a session is due.
+
+  @param  SessionInfo                  The session info of the session.
+  @param  Now                          The current time, from SpdmRequesterGetTime.
+
+  @retval TRUE   Half of the heartbeat period passed since the last secured message received in the session.
+  @retval FALSE  The heartbeat is not due, or the session has no heartbeat.
+**/
+BOOLEAN
+SpdmIsHeartbeatDue (
+  IN     SPDM_SESSION_INFO    *SessionInfo,
+  IN     UINT64               Now
+  );
+
+/**
+  This function runs the key update policy of a session before a secured message is exchanged.
+
+  The next generation of keys is prepared once three quarters of a budget is used,
+  so that the KEY_UPDATE sent once a budget is used up only installs it.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+
+  @retval RETURN_SUCCESS               No key update is due, or the keys of the session are updated.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmKeyUpdateByPolicy (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId
+  );
+
+/**
+  This function runs the key update policy of an idle session ahead of time.
+
+  The keys are updated once three quarters of a budget is used, instead of once it is used up,
+  so that the KEY_UPDATE is not sent before the next secured message of the session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+
+  @retval RETURN_SUCCESS               No key update is due, or the keys of the session are updated.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmKeyUpdateIdleSessionByPolicy (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId
+  );
+
+/**
+  Return the time of a CTExponent or an RDTExponent.
+
+  @param  Exponent                     The CTExponent or the RDTExponent.
+
+  @return the time, 2^Exponent, in microseconds.
+**/
+UINT64
+SpdmGetTimingExponentValue (
+  IN     UINT8                Exponent
+  );
+
+/**
+  Return the timeout of the response to an SPDM request.
+
+  The timeout is RTT + CT for a request with cryptographic processing, and RTT + ST1 otherwise.
+  CT is from the CTExponent of the CAPABILITIES response, and is never shorter than ST1.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the request.
+
+  @return the timeout of the response, in 100ns units, or 0 if the response is waited for indefinitely.
+**/
+UINT64
+SpdmGetResponseTimeout (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request
+  );
+
+/**
+  Wait for a period of time with the registered stall function.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  WaitTime                     The time to wait, in microseconds.
+**/
+VOID
+SpdmRequesterStall (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT64               WaitTime
+  );
+
+/**
+  Wait before a request answered with ERROR(BUSY) is retried.
+
+  The wait is ST1, and doubles with each consecutive ERROR(BUSY) up to MAX_SPDM_BUSY_BACKOFF_SHIFT times,
+  so that a device busy for a short time is retried soon, and a device busy for a long time is not flooded.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmRequesterBackoffBusy (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  Return the time with the registered requester time function.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the time, in 100ns units, or 0 if no time function is registered.
+**/
+UINT64
+SpdmRequesterGetTime (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+#if OPENSPDM_REQUESTER_STATS_SUPPORT == 1
+/**
+  Return the statistics of an SPDM request code.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+
+  @return the statistics of the request code, or NULL if it is not a request code.
+**/
+SPDM_REQUESTER_REQUEST_STATS *
+SpdmGetRequesterRequestStats (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                RequestCode
+  );
+
+/**
+  Add a latency to a latency histogram.
+
+  @param  Latency                      The latency, in 100ns units.
+  @param  Histogram                    The latency histogram with SPDM_REQUESTER_STATS_LATENCY_BUCKET_COUNT buckets.
+**/
+VOID
+SpdmRecordRequesterLatency (
+  IN     UINT64               Latency,
+  IN OUT UINT32               *Histogram
+  );
+#endif
+
+/**
+  Record an SPDM request sent in the requester statistics, and notify the requester monitor function.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of a secured message, or NULL for a normal message.
+  @param  SendTime                     The time the request is sent, from SpdmRequesterGetTime.
+  @param  Status                       The status of sending the request.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the request.
+**/
+VOID
+SpdmRequesterRecordRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT64               SendTime,
+  IN     RETURN_STATUS        Status,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request
+  );
+
+/**
+  Record an SPDM response received in the requester statistics, and notify the requester monitor function.
+
+  The response is accounted to the last request sent.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of a secured message, or NULL for a normal message.
+  @param  ReceiveTime                  The time the response is received, from SpdmRequesterGetTime.
+  @param  Status                       The status of receiving the response.
+  @param  ResponseSize                 Size in bytes of the response.
+  @param  Response                     A pointer to the response.
+**/
+VOID
+SpdmRequesterRecordResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT64               ReceiveTime,
+  IN     RETURN_STATUS        Status,
+  IN     UINTN                ResponseSize,
+  IN     VOID                 *Response
+  );
+
 #endif
@@ -38,24 +38,170 @@ typedef struct {
 #pragma pack()
 
 /**
-  This function sends KEY_EXCHANGE and receives KEY_EXCHANGE_RSP for SPDM key exchange.
+  Take a KEY_EXCHANGE request prepared by SpdmPrestageKeyExchange for the negotiated DHENamedGroup.
+
+  The request is no longer prepared after it is taken. Its DHE context is owned by the caller.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  ExchangeDataSize             The size in bytes of the ExchangeData field.
+
+  @return The prepared request, or NULL if there is none.
+**/
+STATIC
+SPDM_PRESTAGED_KEY_EXCHANGE *
+SpdmTakePrestagedKeyExchange (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                ExchangeDataSize
+  )
+{
+  UINTN                                     Index;
+  SPDM_PRESTAGED_KEY_EXCHANGE               *Prestaged;
+
+  for (Index = 0; Index < MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT; Index++) {
+    Prestaged = &SpdmContext->PrestagedKeyExchange[Index];
+    if (Prestaged->Valid &&
+        (Prestaged->DHENamedGroup == SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup) &&
+        (Prestaged->ExchangeDataSize == ExchangeDataSize)) {
+      Prestaged->Valid = FALSE;
+      return Prestaged;
+    }
+  }
+  return NULL;
+}
+
+/**
+  This function builds KEY_EXCHANGE, and generates the requester DHE key pair.
+
+  The random data and the DHE key pair of a request prepared by SpdmPrestageKeyExchange are used if there is one.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  MeasurementHashType          MeasurementHashType to the KEY_EXCHANGE request.
   @param  SlotNum                      SlotNum to the KEY_EXCHANGE request.
-  @param  HeartbeatPeriod              HeartbeatPeriod from the KEY_EXCHANGE_RSP response.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the KEY_EXCHANGE request.
+  @param  Request                      A pointer to a destination buffer to store the KEY_EXCHANGE request.
+  @param  DHEContext                   The DHE context of the requester key pair. The caller passes it back to
+                                       SpdmProcessKeyExchangeResponse, or frees it if the exchange is abandoned.
+
+  @retval RETURN_SUCCESS               The KEY_EXCHANGE request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state or the capabilities do not allow KEY_EXCHANGE.
+  @retval RETURN_INVALID_PARAMETER     The slot number is invalid.
+**/
+RETURN_STATUS
+SpdmBuildKeyExchangeRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementHashType,
+  IN     UINT8                SlotNum,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request,
+     OUT VOID                 **DHEContext
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_KEY_EXCHANGE_REQUEST_MINE            *SpdmRequest;
+  UINTN                                     DheKeySize;
+  UINTN                                     FieldParam[SPDM_MESSAGE_PARAM_COUNT];
+  SPDM_MESSAGE_FIELD_VIEW                   View[SPDM_KEY_EXCHANGE_FIELD_COUNT];
+  SPDM_PRESTAGED_KEY_EXCHANGE               *Prestaged;
+
+  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP)) {
+    return RETURN_UNSUPPORTED;
+  }
+  if (SpdmContext->ConnectionInfo.ConnectionState < SpdmConnectionStateNegotiated) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  if ((SlotNum >= MAX_SPDM_SLOT_COUNT) && (SlotNum != 0xFF)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if ((SlotNum == 0xFF) &&
+      (SpdmContext->LocalContext.PeerCertChainProvisionSize == 0) &&
+      (SpdmContext->LocalContext.PeerPublicKeyProvisionSize == 0)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  SpdmGetMessageFieldParam (SpdmContext, TRUE, MeasurementHashType, FieldParam);
+  View[SPDM_KEY_EXCHANGE_FIELD_OPAQUE_DATA].Size = SpdmGetOpaqueDataSupportedVersionDataSize (SpdmContext);
+  Status = SpdmLayoutMessage (mSpdmKeyExchangeLayout, SPDM_KEY_EXCHANGE_FIELD_COUNT, FieldParam, Request, *RequestSize, View, RequestSize);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SpdmRequest = Request;
+
+  SpdmContext->ErrorState = SPDM_STATUS_ERROR_DEVICE_NO_CAPABILITIES;
+
+  SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmRequest->Header.RequestResponseCode = SPDM_KEY_EXCHANGE;
+  SpdmRequest->Header.Param1 = MeasurementHashType;
+  SpdmRequest->Header.Param2 = SlotNum;
+  Prestaged = SpdmTakePrestagedKeyExchange (SpdmContext, View[SPDM_KEY_EXCHANGE_FIELD_EXCHANGE_DATA].Size);
+  if (Prestaged != NULL) {
+    CopyMem (SpdmRequest->RandomData, Prestaged->RandomData, SPDM_RANDOM_DATA_SIZE);
+  } else {
+    SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, SPDM_RANDOM_DATA_SIZE, SpdmRequest->RandomData);
+  }
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "ClientRandomData (0x%x) - ", SPDM_RANDOM_DATA_SIZE));
+    InternalDumpData (SpdmRequest->RandomData, SPDM_RANDOM_DATA_SIZE);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
+
+  SpdmRequest->ReqSessionID = SpdmAllocateReqSessionId (SpdmContext);
+  SpdmRequest->Reserved = 0;
+
+  DheKeySize = View[SPDM_KEY_EXCHANGE_FIELD_EXCHANGE_DATA].Size;
+  if (Prestaged != NULL) {
+    CopyMem (View[SPDM_KEY_EXCHANGE_FIELD_EXCHANGE_DATA].Data, Prestaged->ExchangeData, DheKeySize);
+    *DHEContext = Prestaged->DHEContext;
+    ZeroMem (Prestaged, sizeof(SPDM_PRESTAGED_KEY_EXCHANGE));
+  } else {
+    *DHEContext = SpdmSecuredMessageDheNew (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup);
+    SpdmSecuredMessageDheGenerateKey (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, *DHEContext, View[SPDM_KEY_EXCHANGE_FIELD_EXCHANGE_DATA].Data, &DheKeySize);
+  }
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_KEY)) {
+    DEBUG((DEBUG_INFO, "ClientKey (0x%x):\n", DheKeySize));
+    InternalDumpHex (View[SPDM_KEY_EXCHANGE_FIELD_EXCHANGE_DATA].Data, DheKeySize);
+  }
+
+  Status = SpdmBuildOpaqueDataSupportedVersionData (SpdmContext, &View[SPDM_KEY_EXCHANGE_FIELD_OPAQUE_DATA].Size, View[SPDM_KEY_EXCHANGE_FIELD_OPAQUE_DATA].Data);
+  ASSERT_RETURN_ERROR(Status);
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function processes KEY_EXCHANGE_RSP, and generates the session handshake key.
+
+  The DHE context is freed on all paths.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementHashType          MeasurementHashType to the KEY_EXCHANGE request.
+  @param  RequestSize                  Size in bytes of the sent KEY_EXCHANGE request.
+  @param  Request                      A pointer to the sent KEY_EXCHANGE request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+  @param  DHEContext                   The DHE context returned by SpdmBuildKeyExchangeRequest.
   @param  SessionId                    SessionId from the KEY_EXCHANGE_RSP response.
+  @param  HeartbeatPeriod              HeartbeatPeriod from the KEY_EXCHANGE_RSP response.
   @param  ReqSlotIdParam               ReqSlotIdParam from the KEY_EXCHANGE_RSP response.
   @param  MeasurementHash              MeasurementHash from the KEY_EXCHANGE_RSP response.
 
-  @retval RETURN_SUCCESS               The KEY_EXCHANGE is sent and the KEY_EXCHANGE_RSP is received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SUCCESS               The KEY_EXCHANGE_RSP is received and verified.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid KEY_EXCHANGE_RSP.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
 **/
 RETURN_STATUS
-TrySpdmSendReceiveKeyExchange (
+SpdmProcessKeyExchangeResponse (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
   IN     UINT8                MeasurementHashType,
-  IN     UINT8                SlotNum,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response,
+  IN     VOID                 *DHEContext,
      OUT UINT32               *SessionId,
      OUT UINT8                *HeartbeatPeriod,
      OUT UINT8                *ReqSlotIdParam,
@@ -64,95 +210,38 @@ TrySpdmSendReceiveKeyExchange (
 {
   BOOLEAN                                   Result;
   RETURN_STATUS                             Status;
-  SPDM_KEY_EXCHANGE_REQUEST_MINE            SpdmRequest;
-  UINTN                                     SpdmRequestSize;
-  SPDM_KEY_EXCHANGE_RESPONSE_MAX            SpdmResponse;
+  SPDM_KEY_EXCHANGE_RESPONSE_MAX            *SpdmResponse;
   UINTN                                     SpdmResponseSize;
   UINTN                                     DheKeySize;
   UINT32                                    MeasurementSummaryHashSize;
   UINT32                                    SignatureSize;
   UINT32                                    HmacSize;
-  UINT8                                     *Ptr;
   VOID                                      *MeasurementSummaryHash;
-  UINT16                                    OpaqueLength;
   UINT8                                     *Signature;
   UINT8                                     *VerifyData;
-  VOID                                      *DHEContext;
   UINT16                                    ReqSessionId;
   UINT16                                    RspSessionId;
   SPDM_SESSION_INFO                         *SessionInfo;
-  UINTN                                     OpaqueKeyExchangeReqSize;
   UINT8                                     TH1HashData[64];
+  UINTN                                     FieldParam[SPDM_MESSAGE_PARAM_COUNT];
+  SPDM_MESSAGE_FIELD_VIEW                   View[SPDM_KEY_EXCHANGE_RSP_FIELD_COUNT];
 
-  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP)) {
-    return RETURN_UNSUPPORTED;
-  }
-  if (SpdmContext->ConnectionInfo.ConnectionState < SpdmConnectionStateNegotiated) {
-    return RETURN_UNSUPPORTED;
-  }
-
-  if ((SlotNum >= MAX_SPDM_SLOT_COUNT) && (SlotNum != 0xFF)) {
-    return RETURN_INVALID_PARAMETER;
-  }
-  if ((SlotNum == 0xFF) && (SpdmContext->LocalContext.PeerCertChainProvisionSize == 0)) {
-    return RETURN_INVALID_PARAMETER;
-  }
-
-  SpdmContext->ErrorState = SPDM_STATUS_ERROR_DEVICE_NO_CAPABILITIES;
-
-  SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
-  SpdmRequest.Header.RequestResponseCode = SPDM_KEY_EXCHANGE;
-  SpdmRequest.Header.Param1 = MeasurementHashType;
-  SpdmRequest.Header.Param2 = SlotNum;
-  SpdmGetRandomNumber (SPDM_RANDOM_DATA_SIZE, SpdmRequest.RandomData);
-  DEBUG((DEBUG_INFO, "ClientRandomData (0x%x) - ", SPDM_RANDOM_DATA_SIZE));
-  InternalDumpData (SpdmRequest.RandomData, SPDM_RANDOM_DATA_SIZE);
-  DEBUG((DEBUG_INFO, "\n"));
-
-  ReqSessionId = SpdmAllocateReqSessionId (SpdmContext);
-  SpdmRequest.ReqSessionID = ReqSessionId;
-  SpdmRequest.Reserved = 0;
-
-  Ptr = SpdmRequest.ExchangeData;
+  SpdmResponse = Response;
+  SpdmResponseSize = ResponseSize;
+  ReqSessionId = ((SPDM_KEY_EXCHANGE_REQUEST_MINE *)Request)->ReqSessionID;
   DheKeySize = GetSpdmDhePubKeySize (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup);
-  DHEContext = SpdmSecuredMessageDheNew (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup);
-  SpdmSecuredMessageDheGenerateKey (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext, Ptr, &DheKeySize);
-  DEBUG((DEBUG_INFO, "ClientKey (0x%x):\n", DheKeySize));
-  InternalDumpHex (Ptr, DheKeySize);
-  Ptr += DheKeySize;
-
-  OpaqueKeyExchangeReqSize = SpdmGetOpaqueDataSupportedVersionDataSize (SpdmContext);
-  *(UINT16 *)Ptr = (UINT16)OpaqueKeyExchangeReqSize;
-  Ptr += sizeof(UINT16);
-  Status = SpdmBuildOpaqueDataSupportedVersionData (SpdmContext, &OpaqueKeyExchangeReqSize, Ptr);
-  ASSERT_RETURN_ERROR(Status);
-  Ptr += OpaqueKeyExchangeReqSize;
-
-  SpdmRequestSize = (UINTN)Ptr - (UINTN)&SpdmRequest;
-  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
-  if (RETURN_ERROR(Status)) {
-    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
-    return RETURN_DEVICE_ERROR;
-  }
 
-  SpdmResponseSize = sizeof(SpdmResponse);
-  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
-  if (RETURN_ERROR(Status)) {
-    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
-    return RETURN_DEVICE_ERROR;
-  }
   if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-    Status = SpdmHandleErrorResponseMain(SpdmContext, NULL, NULL, 0, &SpdmResponseSize, &SpdmResponse, SPDM_KEY_EXCHANGE, SPDM_KEY_EXCHANGE_RSP, sizeof(SPDM_KEY_EXCHANGE_RESPONSE_MAX));
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
+    Status = SpdmHandleErrorResponseMain(SpdmContext, NULL, NULL, 0, &SpdmResponseSize, SpdmResponse, SPDM_KEY_EXCHANGE, SPDM_KEY_EXCHANGE_RSP, sizeof(SPDM_KEY_EXCHANGE_RESPONSE_MAX));
     if (RETURN_ERROR(Status)) {
       SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
       return Status;
     }
-  } else if (SpdmResponse.Header.RequestResponseCode != SPDM_KEY_EXCHANGE_RSP) {
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_KEY_EXCHANGE_RSP) {
     SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
     return RETURN_DEVICE_ERROR;
   }
@@ -160,124 +249,100 @@ TrySpdmSendReceiveKeyExchange (
     SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponseSize > sizeof(SpdmResponse)) {
+  if (SpdmResponseSize > sizeof(SPDM_KEY_EXCHANGE_RESPONSE_MAX)) {
     SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
     return RETURN_DEVICE_ERROR;
   }
 
   if (HeartbeatPeriod != NULL) {
-    *HeartbeatPeriod = SpdmResponse.Header.Param1;
+    *HeartbeatPeriod = SpdmResponse->Header.Param1;
   }
-  *ReqSlotIdParam = SpdmResponse.ReqSlotIDParam;
-  if (SpdmResponse.MutAuthRequested != 0) {
+  *ReqSlotIdParam = SpdmResponse->ReqSlotIDParam;
+  if (SpdmResponse->MutAuthRequested != 0) {
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
     if ((*ReqSlotIdParam != 0xF) && (*ReqSlotIdParam >= SpdmContext->LocalContext.SlotCount)) {
       SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
       return RETURN_DEVICE_ERROR;
     }
+#else
+    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
+    return RETURN_DEVICE_ERROR;
+#endif
   } else {
     if (*ReqSlotIdParam != 0) {
       SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
       return RETURN_DEVICE_ERROR;
     }
   }
-  RspSessionId = SpdmResponse.RspSessionID;
+  RspSessionId = SpdmResponse->RspSessionID;
   *SessionId = (ReqSessionId << 16) | RspSessionId;
   SessionInfo = SpdmAssignSessionId (SpdmContext, *SessionId, FALSE);
   if (SessionInfo == NULL) {
     SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
     return RETURN_DEVICE_ERROR;
   }
+  SessionInfo->HeartbeatPeriod = SpdmResponse->Header.Param1;
+  SessionInfo->LastActivityTime = SpdmRequesterGetTime (SpdmContext);
 
   //
   // Cache session data
   //
-  Status = SpdmAppendMessageK (SessionInfo, &SpdmRequest, SpdmRequestSize);
+  Status = SpdmAppendMessageK (SessionInfo, Request, RequestSize);
   if (RETURN_ERROR(Status)) {
     SpdmFreeSessionId (SpdmContext, *SessionId);
     SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
     return RETURN_SECURITY_VIOLATION;
   }
 
-  SignatureSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
-  MeasurementSummaryHashSize = SpdmGetMeasurementSummaryHashSize (SpdmContext, TRUE, MeasurementHashType);
-  HmacSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
+  SpdmGetMessageFieldParam (SpdmContext, TRUE, MeasurementHashType, FieldParam);
+  MeasurementSummaryHashSize = (UINT32)FieldParam[SPDM_MESSAGE_PARAM_MEASUREMENT_SUMMARY_HASH_SIZE];
+  SignatureSize = (UINT32)FieldParam[SPDM_MESSAGE_PARAM_SIGNATURE_SIZE];
+  HmacSize = (UINT32)FieldParam[SPDM_MESSAGE_PARAM_HMAC_SIZE];
 
-  if (SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP)) {
-    HmacSize = 0;
-  }
-
-  if (SpdmResponseSize <  sizeof(SPDM_KEY_EXCHANGE_RESPONSE) +
-                          DheKeySize +
-                          MeasurementSummaryHashSize +
-                          sizeof(UINT16) +
-                          SignatureSize +
-                          HmacSize) {
+  Status = SpdmParseMessage (mSpdmKeyExchangeRspLayout, SPDM_KEY_EXCHANGE_RSP_FIELD_COUNT, FieldParam, SpdmResponse, SpdmResponseSize, View, &SpdmResponseSize);
+  if (RETURN_ERROR(Status)) {
     SpdmFreeSessionId (SpdmContext, *SessionId);
     SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
     return RETURN_DEVICE_ERROR;
   }
 
-  DEBUG((DEBUG_INFO, "ServerRandomData (0x%x) - ", SPDM_RANDOM_DATA_SIZE));
-  InternalDumpData (SpdmResponse.RandomData, SPDM_RANDOM_DATA_SIZE);
-  DEBUG((DEBUG_INFO, "\n"));
-
-  DEBUG((DEBUG_INFO, "ServerKey (0x%x):\n", DheKeySize));
-  InternalDumpHex (SpdmResponse.ExchangeData, DheKeySize);
-
-  Ptr = SpdmResponse.ExchangeData;
-  Ptr += DheKeySize;
-
-  MeasurementSummaryHash = Ptr;
-  DEBUG((DEBUG_INFO, "MeasurementSummaryHash (0x%x) - ", MeasurementSummaryHashSize));
-  InternalDumpData (MeasurementSummaryHash, MeasurementSummaryHashSize);
-  DEBUG((DEBUG_INFO, "\n"));
-
-  Ptr += MeasurementSummaryHashSize;
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "ServerRandomData (0x%x) - ", SPDM_RANDOM_DATA_SIZE));
+    InternalDumpData (SpdmResponse->RandomData, SPDM_RANDOM_DATA_SIZE);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
-  OpaqueLength = *(UINT16 *)Ptr;
-  if (OpaqueLength > MAX_SPDM_OPAQUE_DATA_SIZE) {
-    return RETURN_SECURITY_VIOLATION;
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_KEY)) {
+    DEBUG((DEBUG_INFO, "ServerKey (0x%x):\n", DheKeySize));
+    InternalDumpHex (SpdmResponse->ExchangeData, DheKeySize);
   }
-  Ptr += sizeof(UINT16);
-  if (SpdmResponseSize < sizeof(SPDM_KEY_EXCHANGE_RESPONSE) +
-                         DheKeySize +
-                         MeasurementSummaryHashSize +
-                         sizeof(UINT16) +
-                         OpaqueLength +
-                         SignatureSize +
-                         HmacSize) {
-    SpdmFreeSessionId (SpdmContext, *SessionId);
-    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
-    return RETURN_DEVICE_ERROR;
+
+  MeasurementSummaryHash = View[SPDM_KEY_EXCHANGE_RSP_FIELD_MEASUREMENT_SUMMARY_HASH].Data;
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "MeasurementSummaryHash (0x%x) - ", MeasurementSummaryHashSize));
+    InternalDumpData (MeasurementSummaryHash, MeasurementSummaryHashSize);
+    DEBUG((DEBUG_INFO, "\n"));
   }
-  Status = SpdmProcessOpaqueDataVersionSelectionData (SpdmContext, OpaqueLength, Ptr);
+
+  Status = SpdmProcessOpaqueDataVersionSelectionData (SpdmContext, View[SPDM_KEY_EXCHANGE_RSP_FIELD_OPAQUE_DATA].Size, View[SPDM_KEY_EXCHANGE_RSP_FIELD_OPAQUE_DATA].Data);
   if (RETURN_ERROR(Status)) {
     SpdmFreeSessionId (SpdmContext, *SessionId);
     SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
     return RETURN_UNSUPPORTED;
   }
 
-  Ptr += OpaqueLength;
-
-  SpdmResponseSize = sizeof(SPDM_KEY_EXCHANGE_RESPONSE) +
-                     DheKeySize +
-                     MeasurementSummaryHashSize +
-                     sizeof(UINT16) +
-                     OpaqueLength +
-                     SignatureSize +
-                     HmacSize;
-
-  Status = SpdmAppendMessageK (SessionInfo, &SpdmResponse, SpdmResponseSize - SignatureSize - HmacSize);
+  Status = SpdmAppendMessageK (SessionInfo, SpdmResponse, SpdmResponseSize - SignatureSize - HmacSize);
   if (RETURN_ERROR(Status)) {
     SpdmFreeSessionId (SpdmContext, *SessionId);
     SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
     return RETURN_SECURITY_VIOLATION;
   }
 
-  Signature = Ptr;
-  DEBUG((DEBUG_INFO, "Signature (0x%x):\n", SignatureSize));
-  InternalDumpHex (Signature, SignatureSize);
-  Ptr += SignatureSize;
+  Signature = View[SPDM_KEY_EXCHANGE_RSP_FIELD_SIGNATURE].Data;
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Signature (0x%x):\n", SignatureSize));
+    InternalDumpHex (Signature, SignatureSize);
+  }
   Result = SpdmVerifyKeyExchangeRspSignature (SpdmContext, SessionInfo, Signature, SignatureSize);
   if (!Result) {
     SpdmFreeSessionId (SpdmContext, *SessionId);
@@ -296,7 +361,7 @@ TrySpdmSendReceiveKeyExchange (
   //
   // Fill data to calc Secret for HMAC verification
   //
-  Result = SpdmSecuredMessageDheComputeKey (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext, SpdmResponse.ExchangeData, DheKeySize, SessionInfo->SecuredMessageContext);
+  Result = SpdmSecuredMessageDheComputeKey (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext, SpdmResponse->ExchangeData, DheKeySize, SessionInfo->SecuredMessageContext);
   SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
   if (!Result) {
     SpdmFreeSessionId (SpdmContext, *SessionId);
@@ -316,17 +381,17 @@ TrySpdmSendReceiveKeyExchange (
   }
 
   if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP)) {
-    VerifyData = Ptr;
-    DEBUG((DEBUG_INFO, "VerifyData (0x%x):\n", HmacSize));
-    InternalDumpHex (VerifyData, HmacSize);
+    VerifyData = View[SPDM_KEY_EXCHANGE_RSP_FIELD_VERIFY_DATA].Data;
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+      DEBUG((DEBUG_INFO, "VerifyData (0x%x):\n", HmacSize));
+      InternalDumpHex (VerifyData, HmacSize);
+    }
     Result = SpdmVerifyKeyExchangeRspHmac (SpdmContext, SessionInfo, VerifyData, HmacSize);
     if (!Result) {
       SpdmFreeSessionId (SpdmContext, *SessionId);
       SpdmContext->ErrorState = SPDM_STATUS_ERROR_KEY_EXCHANGE_FAILURE;
       return RETURN_SECURITY_VIOLATION;
     }
-    Ptr += HmacSize;
-
     Status = SpdmAppendMessageK (SessionInfo, VerifyData, HmacSize);
     if (RETURN_ERROR(Status)) {
       SpdmFreeSessionId (SpdmContext, *SessionId);
@@ -337,7 +402,8 @@ TrySpdmSendReceiveKeyExchange (
   if (MeasurementHash != NULL) {
     CopyMem (MeasurementHash, MeasurementSummaryHash, MeasurementSummaryHashSize);
   }
-  SessionInfo->MutAuthRequested = SpdmResponse.MutAuthRequested;
+  SpdmMeasurementCacheRecordSummaryHash (SpdmContext, MeasurementHashType, MeasurementSummaryHash);
+  SessionInfo->MutAuthRequested = SpdmResponse->MutAuthRequested;
 
   SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SpdmSessionStateHandshaking);
   SpdmContext->ErrorState = SPDM_STATUS_SUCCESS;
@@ -345,6 +411,60 @@ TrySpdmSendReceiveKeyExchange (
   return RETURN_SUCCESS;
 }
 
+/**
+  This function sends KEY_EXCHANGE and receives KEY_EXCHANGE_RSP for SPDM key exchange.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementHashType          MeasurementHashType to the KEY_EXCHANGE request.
+  @param  SlotNum                      SlotNum to the KEY_EXCHANGE request.
+  @param  HeartbeatPeriod              HeartbeatPeriod from the KEY_EXCHANGE_RSP response.
+  @param  SessionId                    SessionId from the KEY_EXCHANGE_RSP response.
+  @param  ReqSlotIdParam               ReqSlotIdParam from the KEY_EXCHANGE_RSP response.
+  @param  MeasurementHash              MeasurementHash from the KEY_EXCHANGE_RSP response.
+
+  @retval RETURN_SUCCESS               The KEY_EXCHANGE is sent and the KEY_EXCHANGE_RSP is received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+TrySpdmSendReceiveKeyExchange (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementHashType,
+  IN     UINT8                SlotNum,
+     OUT UINT32               *SessionId,
+     OUT UINT8                *HeartbeatPeriod,
+     OUT UINT8                *ReqSlotIdParam,
+     OUT VOID                 *MeasurementHash
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_KEY_EXCHANGE_REQUEST_MINE            SpdmRequest;
+  UINTN                                     SpdmRequestSize;
+  SPDM_KEY_EXCHANGE_RESPONSE_MAX            SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+  VOID                                      *DHEContext;
+
+  SPDM_CRYPTO_STATS_BIND (SpdmContext);
+  SpdmRequestSize = sizeof(SpdmRequest);
+  Status = SpdmBuildKeyExchangeRequest (SpdmContext, MeasurementHashType, SlotNum, &SpdmRequestSize, &SpdmRequest, &DHEContext);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
+    return RETURN_DEVICE_ERROR;
+  }
+
+  SpdmResponseSize = sizeof(SpdmResponse);
+  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
+    return RETURN_DEVICE_ERROR;
+  }
+  return SpdmProcessKeyExchangeResponse (SpdmContext, MeasurementHashType, SpdmRequestSize, &SpdmRequest, SpdmResponseSize, &SpdmResponse, DHEContext, SessionId, HeartbeatPeriod, ReqSlotIdParam, MeasurementHash);
+}
+
 RETURN_STATUS
 SpdmSendReceiveKeyExchange (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
@@ -370,3 +490,75 @@ SpdmSendReceiveKeyExchange (
   return Status;
 }
 
+/**
+  This function prepares KEY_EXCHANGE requests ahead of SpdmStartSession.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Count                        The number of prepared requests to have, up to MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT.
+
+  @retval RETURN_SUCCESS               Count requests are prepared.
+  @retval RETURN_INVALID_PARAMETER     Count is larger than MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT.
+  @retval RETURN_UNSUPPORTED           The algorithms are not negotiated, or KEY_EXCHANGE is not supported.
+  @retval RETURN_OUT_OF_RESOURCES      A DHE key pair cannot be generated.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPrestageKeyExchange (
+  IN     VOID                 *Context,
+  IN     UINTN                Count
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_PRESTAGED_KEY_EXCHANGE               *Prestaged;
+  UINT16                                    DHENamedGroup;
+  UINTN                                     ValidCount;
+  UINTN                                     Index;
+
+  SpdmContext = Context;
+  if (Count > MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP)) {
+    return RETURN_UNSUPPORTED;
+  }
+  if (SpdmContext->ConnectionInfo.ConnectionState < SpdmConnectionStateNegotiated) {
+    return RETURN_UNSUPPORTED;
+  }
+  DHENamedGroup = SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup;
+
+  //
+  // Free the requests of another DHENamedGroup, then count those left.
+  //
+  ValidCount = 0;
+  for (Index = 0; Index < MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT; Index++) {
+    Prestaged = &SpdmContext->PrestagedKeyExchange[Index];
+    if (!Prestaged->Valid) {
+      continue;
+    }
+    if (Prestaged->DHENamedGroup != DHENamedGroup) {
+      SpdmSecuredMessageDheFree (Prestaged->DHENamedGroup, Prestaged->DHEContext);
+      ZeroMem (Prestaged, sizeof(SPDM_PRESTAGED_KEY_EXCHANGE));
+      continue;
+    }
+    ValidCount++;
+  }
+
+  for (Index = 0; (Index < MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT) && (ValidCount < Count); Index++) {
+    Prestaged = &SpdmContext->PrestagedKeyExchange[Index];
+    if (Prestaged->Valid) {
+      continue;
+    }
+    Prestaged->ExchangeDataSize = GetSpdmDhePubKeySize (DHENamedGroup);
+    Prestaged->DHEContext = SpdmSecuredMessageDheNewFromPool (SpdmContext->DheKeyPool, DHENamedGroup, Prestaged->ExchangeData, &Prestaged->ExchangeDataSize);
+    if (Prestaged->DHEContext == NULL) {
+      ZeroMem (Prestaged, sizeof(SPDM_PRESTAGED_KEY_EXCHANGE));
+      return RETURN_OUT_OF_RESOURCES;
+    }
+    SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, SPDM_RANDOM_DATA_SIZE, Prestaged->RandomData);
+    Prestaged->DHENamedGroup = DHENamedGroup;
+    Prestaged->Valid = TRUE;
+    ValidCount++;
+  }
+
+  return RETURN_SUCCESS;
+}
@@ -32,6 +32,7 @@ SpdmKeyUpdate (
   IN     BOOLEAN              SingleDirection
   )
 {
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
   RETURN_STATUS                      Status;
   SPDM_KEY_UPDATE_REQUEST            SpdmRequest;
   SPDM_KEY_UPDATE_RESPONSE           SpdmResponse;
@@ -75,7 +76,7 @@ SpdmKeyUpdate (
     SpdmRequest.Header.Param1 = SPDM_KEY_UPDATE_OPERATIONS_TABLE_UPDATE_ALL_KEYS;
   }
   SpdmRequest.Header.Param2 = 0;
-  SpdmGetRandomNumber (sizeof(SpdmRequest.Header.Param2), &SpdmRequest.Header.Param2);
+  SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, sizeof(SpdmRequest.Header.Param2), &SpdmRequest.Header.Param2);
 
   // Create new key
   if ((Action & SpdmKeyUpdateActionResponder) != 0) {
@@ -112,6 +113,10 @@ SpdmKeyUpdate (
   SpdmCreateUpdateSessionDataKey (SessionInfo->SecuredMessageContext, SpdmKeyUpdateActionRequester);
   DEBUG ((DEBUG_INFO, "SpdmActivateUpdateSessionDataKey[%x] Requester new\n", SessionId));
   SpdmActivateUpdateSessionDataKey (SessionInfo->SecuredMessageContext, SpdmKeyUpdateActionRequester, TRUE);
+  SessionInfo->KeyUpdateSendRecordCount = 0;
+  SessionInfo->KeyUpdateSendByteCount = 0;
+  SessionInfo->KeyUpdateReceiveRecordCount = 0;
+  SessionInfo->KeyUpdateReceiveByteCount = 0;
 
   //
   // Verify Key
@@ -120,7 +125,7 @@ SpdmKeyUpdate (
   SpdmRequest.Header.RequestResponseCode = SPDM_KEY_UPDATE;
   SpdmRequest.Header.Param1 = SPDM_KEY_UPDATE_OPERATIONS_TABLE_VERIFY_NEW_KEY;
   SpdmRequest.Header.Param2 = 1;
-  SpdmGetRandomNumber (sizeof(SpdmRequest.Header.Param2), &SpdmRequest.Header.Param2);
+  SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, sizeof(SpdmRequest.Header.Param2), &SpdmRequest.Header.Param2);
 
   Status = SpdmSendSpdmRequest (SpdmContext, &SessionId, sizeof(SpdmRequest), &SpdmRequest);
   if (RETURN_ERROR(Status)) {
@@ -141,5 +146,200 @@ SpdmKeyUpdate (
   DEBUG ((DEBUG_INFO, "SpdmVerifyKey[%x] Success\n", SessionId));
 
   return RETURN_SUCCESS;
+#else
+  return RETURN_UNSUPPORTED;
+#endif
 }
 
+
+/**
+  Count a secured record against the key update policy of its session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the record.
+  @param  IsSend                       Indicates if the record is sent or received.
+  @param  RecordSize                   Size in bytes of the message in the record.
+**/
+VOID
+SpdmCountKeyUpdateBudget (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     BOOLEAN              IsSend,
+  IN     UINTN                RecordSize
+  )
+{
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
+  SPDM_SESSION_INFO                  *SessionInfo;
+
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  if (SessionInfo == NULL) {
+    return;
+  }
+  if (IsSend) {
+    SessionInfo->KeyUpdateSendRecordCount++;
+    SessionInfo->KeyUpdateSendByteCount += RecordSize;
+  } else {
+    SessionInfo->KeyUpdateReceiveRecordCount++;
+    SessionInfo->KeyUpdateReceiveByteCount += RecordSize;
+  }
+#endif
+}
+
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
+/**
+  Return if a budget of the key update policy is used up to a fraction.
+
+  @param  Count                        The amount of the budget that is used.
+  @param  Budget                       The budget. 0 is not limited.
+  @param  Numerator                    The numerator of the fraction.
+  @param  Denominator                  The denominator of the fraction.
+
+  @retval TRUE   The budget is used up to the fraction.
+  @retval FALSE  The budget is not used up to the fraction, or it is not limited.
+**/
+BOOLEAN
+SpdmIsKeyUpdateBudgetUsed (
+  IN     UINT64               Count,
+  IN     UINT64               Budget,
+  IN     UINT64               Numerator,
+  IN     UINT64               Denominator
+  )
+{
+  if (Budget == 0) {
+    return FALSE;
+  }
+  return (BOOLEAN)(Count >= Budget / Denominator * Numerator + Budget % Denominator * Numerator / Denominator);
+}
+
+/**
+  Return if the key update policy of a session applies.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of the session.
+
+  @retval TRUE   The session is established with a limited key update policy, and KEY_UPDATE is supported.
+  @retval FALSE  The key update policy does not apply.
+**/
+BOOLEAN
+SpdmIsKeyUpdatePolicyEnabled (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     SPDM_SESSION_INFO    *SessionInfo
+  )
+{
+  SPDM_KEY_UPDATE_POLICY             *Policy;
+
+  Policy = &SessionInfo->KeyUpdatePolicy;
+  if ((Policy->MaxRecordCount == 0) && (Policy->MaxByteCount == 0)) {
+    return FALSE;
+  }
+  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_UPD_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_UPD_CAP)) {
+    return FALSE;
+  }
+  if (SpdmSecuredMessageGetSessionState (SessionInfo->SecuredMessageContext) != SpdmSessionStateEstablished) {
+    return FALSE;
+  }
+  return TRUE;
+}
+#endif
+
+/**
+  This function runs the key update policy of a session before a secured message is exchanged.
+
+  The next generation of keys is prepared once three quarters of a budget is used,
+  so that the KEY_UPDATE sent once a budget is used up only installs it.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+
+  @retval RETURN_SUCCESS               No key update is due, or the keys of the session are updated.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmKeyUpdateByPolicy (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId
+  )
+{
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
+  SPDM_SESSION_INFO                  *SessionInfo;
+  SPDM_KEY_UPDATE_POLICY             *Policy;
+  SPDM_KEY_UPDATE_ACTION             Action;
+  UINT64                             RecordCount;
+  UINT64                             ByteCount;
+
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  if (SessionInfo == NULL) {
+    return RETURN_SUCCESS;
+  }
+  if (!SpdmIsKeyUpdatePolicyEnabled (SpdmContext, SessionInfo)) {
+    return RETURN_SUCCESS;
+  }
+  Policy = &SessionInfo->KeyUpdatePolicy;
+
+  if (Policy->UpdateAllKeys) {
+    Action = SpdmKeyUpdateActionAll;
+  } else {
+    Action = SpdmKeyUpdateActionRequester;
+  }
+
+  RecordCount = SessionInfo->KeyUpdateSendRecordCount + SessionInfo->KeyUpdateReceiveRecordCount;
+  ByteCount = SessionInfo->KeyUpdateSendByteCount + SessionInfo->KeyUpdateReceiveByteCount;
+  if (SpdmIsKeyUpdateBudgetUsed (RecordCount, Policy->MaxRecordCount, 1, 1) ||
+      SpdmIsKeyUpdateBudgetUsed (ByteCount, Policy->MaxByteCount, 1, 1)) {
+    DEBUG ((DEBUG_INFO, "SpdmKeyUpdateByPolicy[%x]\n", SessionId));
+    return SpdmKeyUpdate (SpdmContext, SessionId, !Policy->UpdateAllKeys);
+  }
+
+  if (SpdmIsKeyUpdateBudgetUsed (RecordCount, Policy->MaxRecordCount, 3, 4) ||
+      SpdmIsKeyUpdateBudgetUsed (ByteCount, Policy->MaxByteCount, 3, 4)) {
+    SpdmPrepareUpdateSessionDataKey (SessionInfo->SecuredMessageContext, Action);
+  }
+#endif
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function runs the key update policy of an idle session ahead of time.
+
+  The keys are updated once three quarters of a budget is used, instead of once it is used up,
+  so that the KEY_UPDATE is not sent before the next secured message of the session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+
+  @retval RETURN_SUCCESS               No key update is due, or the keys of the session are updated.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmKeyUpdateIdleSessionByPolicy (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId
+  )
+{
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
+  SPDM_SESSION_INFO                  *SessionInfo;
+  SPDM_KEY_UPDATE_POLICY             *Policy;
+  UINT64                             RecordCount;
+  UINT64                             ByteCount;
+
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  if (SessionInfo == NULL) {
+    return RETURN_SUCCESS;
+  }
+  if (!SpdmIsKeyUpdatePolicyEnabled (SpdmContext, SessionInfo)) {
+    return RETURN_SUCCESS;
+  }
+  Policy = &SessionInfo->KeyUpdatePolicy;
+
+  RecordCount = SessionInfo->KeyUpdateSendRecordCount + SessionInfo->KeyUpdateReceiveRecordCount;
+  ByteCount = SessionInfo->KeyUpdateSendByteCount + SessionInfo->KeyUpdateReceiveByteCount;
+  if (SpdmIsKeyUpdateBudgetUsed (RecordCount, Policy->MaxRecordCount, 3, 4) ||
+      SpdmIsKeyUpdateBudgetUsed (ByteCount, Policy->MaxByteCount, 3, 4)) {
+    DEBUG ((DEBUG_INFO, "SpdmKeyUpdateIdleSessionByPolicy[%x]\n", SessionId));
+    return SpdmKeyUpdate (SpdmContext, SessionId, !Policy->UpdateAllKeys);
+  }
+#endif
+  return RETURN_SUCCESS;
+}
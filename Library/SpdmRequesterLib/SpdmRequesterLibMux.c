@@ -0,0 +1,388 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmRequesterLibInternal.h"
+
+/**
+  Return a channel of a session multiplexer.
+
+  @param  Mux                          A pointer to the session multiplexer.
+  @param  ChannelIndex                 The index of the channel.
+
+  @return the channel.
+**/
+SPDM_MUX_CHANNEL *
+SpdmMuxGetChannel (
+  IN     SPDM_MUX             *Mux,
+  IN     UINTN                ChannelIndex
+  )
+{
+  return (SPDM_MUX_CHANNEL *)(Mux + 1) + ChannelIndex;
+}
+
+/**
+  Return an entry of the queue of a channel of a session multiplexer.
+
+  @param  Mux                          A pointer to the session multiplexer.
+  @param  ChannelIndex                 The index of the channel.
+  @param  EntryIndex                   The index of the entry in the queue.
+
+  @return the queue entry.
+**/
+SPDM_MUX_QUEUE_ENTRY *
+SpdmMuxGetQueueEntry (
+  IN     SPDM_MUX             *Mux,
+  IN     UINTN                ChannelIndex,
+  IN     UINTN                EntryIndex
+  )
+{
+  return (SPDM_MUX_QUEUE_ENTRY *)SpdmMuxGetChannel (Mux, Mux->ChannelCount) +
+         ChannelIndex * Mux->QueueDepth + EntryIndex;
+}
+
+/**
+  Acquire the lock of a session multiplexer, if the multiplexer has one.
+
+  @param  Mux                          A pointer to the session multiplexer.
+**/
+VOID
+SpdmMuxLock (
+  IN     SPDM_MUX             *Mux
+  )
+{
+  if (Mux->AcquireLock != NULL) {
+    Mux->AcquireLock (Mux->LockContext);
+  }
+}
+
+/**
+  Release the lock of a session multiplexer, if the multiplexer has one.
+
+  @param  Mux                          A pointer to the session multiplexer.
+**/
+VOID
+SpdmMuxUnlock (
+  IN     SPDM_MUX             *Mux
+  )
+{
+  if (Mux->ReleaseLock != NULL) {
+    Mux->ReleaseLock (Mux->LockContext);
+  }
+}
+
+/**
+  Take the next request to dispatch out of the queues of a session multiplexer.
+
+  The first control channel with a request wins. Otherwise the bulk channel whose first request has the lowest
+  finish tag wins, and the virtual time moves to that finish tag. The lock must be held.
+
+  @param  Mux                          A pointer to the session multiplexer.
+
+  @return the request to dispatch, or NULL if no request is queued.
+**/
+SPDM_MUX_REQUEST *
+SpdmMuxDequeue (
+  IN     SPDM_MUX             *Mux
+  )
+{
+  SPDM_MUX_CHANNEL                          *Channel;
+  SPDM_MUX_CHANNEL                          *Selected;
+  SPDM_MUX_QUEUE_ENTRY                      *Entry;
+  SPDM_MUX_QUEUE_ENTRY                      *SelectedEntry;
+  UINTN                                     SelectedIndex;
+  UINTN                                     Index;
+
+  Selected = NULL;
+  SelectedEntry = NULL;
+  SelectedIndex = 0;
+  for (Index = 0; Index < Mux->ChannelCount; Index++) {
+    Channel = SpdmMuxGetChannel (Mux, Index);
+    if (Channel->IsControl && (Channel->Count != 0)) {
+      Selected = Channel;
+      SelectedIndex = Index;
+      SelectedEntry = SpdmMuxGetQueueEntry (Mux, Index, Channel->Head);
+      break;
+    }
+  }
+  if (Selected == NULL) {
+    for (Index = 0; Index < Mux->ChannelCount; Index++) {
+      Channel = SpdmMuxGetChannel (Mux, Index);
+      if (Channel->IsControl || (Channel->Count == 0)) {
+        continue;
+      }
+      Entry = SpdmMuxGetQueueEntry (Mux, Index, Channel->Head);
+      if ((SelectedEntry == NULL) || (Entry->FinishTag < SelectedEntry->FinishTag)) {
+        Selected = Channel;
+        SelectedIndex = Index;
+        SelectedEntry = Entry;
+      }
+    }
+    if (Selected == NULL) {
+      return NULL;
+    }
+    Mux->VirtualTime = SelectedEntry->FinishTag;
+  }
+
+  Selected->Head = (Selected->Head + 1) % Mux->QueueDepth;
+  Selected->Count--;
+  DEBUG((DEBUG_INFO, "SpdmMuxDequeue - Channel %d\n", SelectedIndex));
+  return SelectedEntry->Request;
+}
+
+/**
+  Return the size in bytes of a session multiplexer.
+
+  @param  ChannelCount                 The number of channels of the multiplexer.
+  @param  QueueDepth                   The number of requests each channel can queue.
+
+  @return the size in bytes of the session multiplexer.
+**/
+UINTN
+EFIAPI
+SpdmMuxGetSize (
+  IN     UINTN                ChannelCount,
+  IN     UINTN                QueueDepth
+  )
+{
+  return sizeof(SPDM_MUX) +
+         (sizeof(SPDM_MUX_CHANNEL) + sizeof(SPDM_MUX_QUEUE_ENTRY) * QueueDepth) * ChannelCount;
+}
+
+/**
+  Initialize a session multiplexer over an established session.
+
+  The multiplexer shares the session between logical channels. The requests of the control channels are
+  dispatched first, in the order of the channels, and the requests of the bulk channels share the rest
+  by weighted fair queuing. All channels are bulk channels of weight 1 until SpdmMuxConfigureChannel.
+  The size in bytes of the multiplexer can be returned by SpdmMuxGetSize.
+  If SpdmMuxSubmit is called concurrently with SpdmMuxDispatch or SpdmMuxRun,
+  AcquireLock and ReleaseLock must be provided to serialize the queues.
+
+  @param  Mux                          A pointer to the session multiplexer.
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  ChannelCount                 The number of channels of the multiplexer.
+  @param  QueueDepth                   The number of requests each channel can queue.
+  @param  AcquireLock                  The function to acquire the queue lock, or NULL.
+  @param  ReleaseLock                  The function to release the queue lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+
+  @retval RETURN_SUCCESS               The multiplexer is initialized.
+  @retval RETURN_INVALID_PARAMETER     ChannelCount or QueueDepth is 0.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmMuxInit (
+  IN     VOID                           *Mux,
+  IN     VOID                           *SpdmContext,
+  IN     UINT32                         SessionId,
+  IN     UINTN                          ChannelCount,
+  IN     UINTN                          QueueDepth,
+  IN     SPDM_REQUESTER_POOL_LOCK_FUNC  AcquireLock OPTIONAL,
+  IN     SPDM_REQUESTER_POOL_LOCK_FUNC  ReleaseLock OPTIONAL,
+  IN     VOID                           *LockContext OPTIONAL
+  )
+{
+  SPDM_MUX                                  *MuxHeader;
+  UINTN                                     Index;
+
+  if ((ChannelCount == 0) || (QueueDepth == 0)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  MuxHeader = Mux;
+  ZeroMem (MuxHeader, SpdmMuxGetSize (ChannelCount, QueueDepth));
+  MuxHeader->SpdmContext = SpdmContext;
+  MuxHeader->SessionId = SessionId;
+  MuxHeader->ChannelCount = ChannelCount;
+  MuxHeader->QueueDepth = QueueDepth;
+  MuxHeader->AcquireLock = AcquireLock;
+  MuxHeader->ReleaseLock = ReleaseLock;
+  MuxHeader->LockContext = LockContext;
+  for (Index = 0; Index < ChannelCount; Index++) {
+    SpdmMuxGetChannel (MuxHeader, Index)->Weight = 1;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Configure a channel of a session multiplexer.
+
+  @param  Mux                          A pointer to the session multiplexer.
+  @param  ChannelIndex                 The index of the channel.
+  @param  IsControl                    TRUE for a control channel, dispatched before all bulk channels.
+  @param  Weight                       The share of a bulk channel, relative to the other bulk channels.
+                                       It is ignored for a control channel.
+
+  @retval RETURN_SUCCESS               The channel is configured.
+  @retval RETURN_INVALID_PARAMETER     ChannelIndex is out of range, or Weight is 0 for a bulk channel.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmMuxConfigureChannel (
+  IN     VOID                 *Mux,
+  IN     UINTN                ChannelIndex,
+  IN     BOOLEAN              IsControl,
+  IN     UINT32               Weight
+  )
+{
+  SPDM_MUX                                  *MuxHeader;
+  SPDM_MUX_CHANNEL                          *Channel;
+
+  MuxHeader = Mux;
+  if ((ChannelIndex >= MuxHeader->ChannelCount) || (!IsControl && (Weight == 0))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  SpdmMuxLock (MuxHeader);
+  Channel = SpdmMuxGetChannel (MuxHeader, ChannelIndex);
+  Channel->IsControl = IsControl;
+  Channel->Weight = IsControl ? 1 : Weight;
+  SpdmMuxUnlock (MuxHeader);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Queue a request on a channel of a session multiplexer.
+
+  The cost of a request on a bulk channel is its RequestSize plus the size of its response buffer.
+
+  @param  Mux                          A pointer to the session multiplexer.
+  @param  ChannelIndex                 The index of the channel.
+  @param  Request                      The request. Its Status is RETURN_NOT_READY until it is dispatched.
+
+  @retval RETURN_SUCCESS               The request is queued.
+  @retval RETURN_INVALID_PARAMETER     ChannelIndex is out of range.
+  @retval RETURN_OUT_OF_RESOURCES      The queue of the channel is full.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmMuxSubmit (
+  IN     VOID                 *Mux,
+  IN     UINTN                ChannelIndex,
+  IN OUT SPDM_MUX_REQUEST     *Request
+  )
+{
+  SPDM_MUX                                  *MuxHeader;
+  SPDM_MUX_CHANNEL                          *Channel;
+  SPDM_MUX_QUEUE_ENTRY                      *Entry;
+  UINT64                                    Cost;
+
+  MuxHeader = Mux;
+  if (ChannelIndex >= MuxHeader->ChannelCount) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  SpdmMuxLock (MuxHeader);
+  Channel = SpdmMuxGetChannel (MuxHeader, ChannelIndex);
+  if (Channel->Count == MuxHeader->QueueDepth) {
+    SpdmMuxUnlock (MuxHeader);
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  Entry = SpdmMuxGetQueueEntry (MuxHeader, ChannelIndex, (Channel->Head + Channel->Count) % MuxHeader->QueueDepth);
+  Entry->Request = Request;
+  Entry->FinishTag = 0;
+  if (!Channel->IsControl) {
+    //
+    // A channel which was idle starts at the virtual time, so it gets no credit for the time it was idle.
+    //
+    Cost = (UINT64)Request->RequestSize + *Request->ResponseSize;
+    Entry->FinishTag = MAX (MuxHeader->VirtualTime, Channel->LastFinishTag) +
+                       (Cost << SPDM_MUX_COST_SHIFT) / Channel->Weight;
+    Channel->LastFinishTag = Entry->FinishTag;
+  }
+  Channel->Count++;
+  Request->Status = RETURN_NOT_READY;
+  SpdmMuxUnlock (MuxHeader);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Dispatch the next request of a session multiplexer with SpdmSendReceiveData.
+
+  The due heartbeats are sent first by SpdmRunHeartbeats, if a time function is registered.
+  Then the first request of the first control channel with a request is dispatched. Otherwise the bulk request
+  with the lowest finish tag is dispatched, which is the time it would finish if the bulk channels with requests
+  were served in parallel in proportion to their weights.
+  A request being dispatched is not preempted, so a control request waits for at most one bulk request,
+  of up to MAX_SPDM_MESSAGE_BUFFER_SIZE bytes each way, and the control requests before it.
+  The functions of one SPDM context must not be called concurrently.
+
+  @param  Mux                          A pointer to the session multiplexer.
+
+  @retval RETURN_SUCCESS               A request is dispatched. Its result is in its Status.
+  @retval RETURN_NOT_FOUND             No request is queued.
+  @retval others                       A heartbeat fails. No request is dispatched.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmMuxDispatch (
+  IN     VOID                 *Mux
+  )
+{
+  SPDM_MUX                                  *MuxHeader;
+  SPDM_MUX_REQUEST                          *Request;
+  RETURN_STATUS                             Status;
+  UINT64                                    NextWakeupTime;
+  UINT32                                    SessionId;
+
+  MuxHeader = Mux;
+  if (MuxHeader->SpdmContext->RequesterGetTimeFunc != 0) {
+    Status = SpdmRunHeartbeats (MuxHeader->SpdmContext, &NextWakeupTime);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+  }
+
+  SpdmMuxLock (MuxHeader);
+  Request = SpdmMuxDequeue (MuxHeader);
+  SpdmMuxUnlock (MuxHeader);
+  if (Request == NULL) {
+    return RETURN_NOT_FOUND;
+  }
+
+  SessionId = MuxHeader->SessionId;
+  Request->Status = SpdmSendReceiveData (
+                      MuxHeader->SpdmContext,
+                      &SessionId,
+                      Request->IsAppMessage,
+                      Request->Request,
+                      Request->RequestSize,
+                      Request->Response,
+                      Request->ResponseSize
+                      );
+  return RETURN_SUCCESS;
+}
+
+/**
+  Dispatch the requests of a session multiplexer with SpdmMuxDispatch, until no request is queued.
+
+  @param  Mux                          A pointer to the session multiplexer.
+
+  @retval RETURN_SUCCESS               All requests are dispatched. The result of each request is in its Status.
+  @retval others                       A heartbeat fails. The requests not dispatched are still queued.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmMuxRun (
+  IN     VOID                 *Mux
+  )
+{
+  RETURN_STATUS                             Status;
+
+  while (TRUE) {
+    Status = SpdmMuxDispatch (Mux);
+    if (Status == RETURN_NOT_FOUND) {
+      return RETURN_SUCCESS;
+    }
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+  }
+}
@@ -43,121 +43,155 @@ typedef struct {
 #pragma pack()
 
 /**
-  This function sends NEGOTIATE_ALGORITHMS and receives ALGORITHMS.
+  This function builds NEGOTIATE_ALGORITHMS.
 
   @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the NEGOTIATE_ALGORITHMS request.
+  @param  Request                      A pointer to a destination buffer to store the NEGOTIATE_ALGORITHMS request.
 
-  @retval RETURN_SUCCESS               The NEGOTIATE_ALGORITHMS is sent and the ALGORITHMS is received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SUCCESS               The NEGOTIATE_ALGORITHMS request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state does not allow NEGOTIATE_ALGORITHMS.
 **/
 RETURN_STATUS
-TrySpdmNegotiateAlgorithms (
-  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+SpdmBuildNegotiateAlgorithmsRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
   )
 {
-  RETURN_STATUS                                  Status;
-  SPDM_NEGOTIATE_ALGORITHMS_REQUEST_MINE         SpdmRequest;
-  SPDM_ALGORITHMS_RESPONSE_MAX                   SpdmResponse;
-  UINTN                                          SpdmResponseSize;
-  UINT32                                         AlgoSize;
-  UINTN                                          Index;
-  SPDM_NEGOTIATE_ALGORITHMS_COMMON_STRUCT_TABLE  *StructTable;
-  UINT8                                          FixedAlgSize;
-  UINT8                                          ExtAlgCount;
+  SPDM_NEGOTIATE_ALGORITHMS_REQUEST_MINE    *SpdmRequest;
+  SPDM_DEVICE_ALGORITHM                     Algorithm;
 
   if (SpdmContext->ConnectionInfo.ConnectionState != SpdmConnectionStateAfterCapabilities) {
     return RETURN_UNSUPPORTED;
   }
 
-  ZeroMem (&SpdmRequest, sizeof(SpdmRequest));
+  if (*RequestSize < sizeof(SPDM_NEGOTIATE_ALGORITHMS_REQUEST_MINE)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SpdmRequest = Request;
+
+  ZeroMem (SpdmRequest, sizeof(SPDM_NEGOTIATE_ALGORITHMS_REQUEST_MINE));
   if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11)) {
-    SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
-    SpdmRequest.Length = sizeof(SpdmRequest);
-    SpdmRequest.Header.Param1 = 4; // Number of Algorithms Structure Tables
+    SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+    SpdmRequest->Length = sizeof(SPDM_NEGOTIATE_ALGORITHMS_REQUEST_MINE);
+    SpdmRequest->Header.Param1 = 4; // Number of Algorithms Structure Tables
   } else {
-    SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
-    SpdmRequest.Length = sizeof(SpdmRequest) - sizeof(SpdmRequest.StructTable);
-    SpdmRequest.Header.Param1 = 0;
-  }
-  SpdmRequest.Header.RequestResponseCode = SPDM_NEGOTIATE_ALGORITHMS;
-  SpdmRequest.Header.Param2 = 0;
-  SpdmRequest.MeasurementSpecification = SpdmContext->LocalContext.Algorithm.MeasurementSpec;
-  SpdmRequest.BaseAsymAlgo = SpdmContext->LocalContext.Algorithm.BaseAsymAlgo;
-  SpdmRequest.BaseHashAlgo = SpdmContext->LocalContext.Algorithm.BaseHashAlgo;
-  SpdmRequest.ExtAsymCount = 0;
-  SpdmRequest.ExtHashCount = 0;
-  SpdmRequest.StructTable[0].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_DHE;
-  SpdmRequest.StructTable[0].AlgCount = 0x20;
-  SpdmRequest.StructTable[0].AlgSupported = SpdmContext->LocalContext.Algorithm.DHENamedGroup;
-  SpdmRequest.StructTable[1].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_AEAD;
-  SpdmRequest.StructTable[1].AlgCount = 0x20;
-  SpdmRequest.StructTable[1].AlgSupported = SpdmContext->LocalContext.Algorithm.AEADCipherSuite;
-  SpdmRequest.StructTable[2].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_REQ_BASE_ASYM_ALG;
-  SpdmRequest.StructTable[2].AlgCount = 0x20;
-  SpdmRequest.StructTable[2].AlgSupported = SpdmContext->LocalContext.Algorithm.ReqBaseAsymAlg;
-  SpdmRequest.StructTable[3].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_KEY_SCHEDULE;
-  SpdmRequest.StructTable[3].AlgCount = 0x20;
-  SpdmRequest.StructTable[3].AlgSupported = SpdmContext->LocalContext.Algorithm.KeySchedule;
-  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequest.Length, &SpdmRequest);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
+    SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+    SpdmRequest->Length = sizeof(SPDM_NEGOTIATE_ALGORITHMS_REQUEST_MINE) - sizeof(SpdmRequest->StructTable);
+    SpdmRequest->Header.Param1 = 0;
   }
+  SpdmRequest->Header.RequestResponseCode = SPDM_NEGOTIATE_ALGORITHMS;
+  SpdmRequest->Header.Param2 = 0;
+  SpdmGetNegotiableAlgorithm (SpdmContext, &Algorithm);
+  SpdmRequest->MeasurementSpecification = Algorithm.MeasurementSpec;
+  SpdmRequest->BaseAsymAlgo = Algorithm.BaseAsymAlgo;
+  SpdmRequest->BaseHashAlgo = Algorithm.BaseHashAlgo;
+  SpdmRequest->ExtAsymCount = 0;
+  SpdmRequest->ExtHashCount = 0;
+  SpdmRequest->StructTable[0].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_DHE;
+  SpdmRequest->StructTable[0].AlgCount = 0x20;
+  SpdmRequest->StructTable[0].AlgSupported = Algorithm.DHENamedGroup;
+  SpdmRequest->StructTable[1].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_AEAD;
+  SpdmRequest->StructTable[1].AlgCount = 0x20;
+  SpdmRequest->StructTable[1].AlgSupported = Algorithm.AEADCipherSuite;
+  SpdmRequest->StructTable[2].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_REQ_BASE_ASYM_ALG;
+  SpdmRequest->StructTable[2].AlgCount = 0x20;
+  SpdmRequest->StructTable[2].AlgSupported = Algorithm.ReqBaseAsymAlg;
+  SpdmRequest->StructTable[3].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_KEY_SCHEDULE;
+  SpdmRequest->StructTable[3].AlgCount = 0x20;
+  SpdmRequest->StructTable[3].AlgSupported = Algorithm.KeySchedule;
+  *RequestSize = SpdmRequest->Length;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function processes the response to a sent NEGOTIATE_ALGORITHMS.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the sent NEGOTIATE_ALGORITHMS request.
+  @param  Request                      A pointer to the sent NEGOTIATE_ALGORITHMS request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+
+  @retval RETURN_SUCCESS               The ALGORITHMS is received.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid ALGORITHMS.
+  @retval RETURN_SECURITY_VIOLATION    The selected algorithms are not supported.
+**/
+RETURN_STATUS
+SpdmProcessAlgorithmsResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
+  )
+{
+  RETURN_STATUS                                 Status;
+  SPDM_ALGORITHMS_RESPONSE_MAX                  *SpdmResponse;
+  UINTN                                         SpdmResponseSize;
+  UINT32                                        AlgoSize;
+  UINTN                                         Index;
+  SPDM_NEGOTIATE_ALGORITHMS_COMMON_STRUCT_TABLE *StructTable;
+  UINT8                                         FixedAlgSize;
+  UINT8                                         ExtAlgCount;
+  SPDM_DEVICE_ALGORITHM                         Algorithm;
+
+  SpdmResponse = Response;
+  SpdmResponseSize = ResponseSize;
 
   //
   // Cache data
   //
-  Status = SpdmAppendMessageA (SpdmContext, &SpdmRequest, SpdmRequest.Length);
+  Status = SpdmAppendMessageA (SpdmContext, Request, RequestSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
-  SpdmResponseSize = sizeof(SpdmResponse);
-  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
   if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-    ShrinkManagedBuffer(&SpdmContext->Transcript.MessageA, SpdmRequest.Length);
-    Status = SpdmHandleSimpleErrorResponse(SpdmContext, SpdmResponse.Header.Param1);
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
+    ShrinkManagedBuffer(&SpdmContext->Transcript.MessageA, RequestSize);
+    Status = SpdmHandleSimpleErrorResponse(SpdmContext, SpdmResponse->Header.Param1);
     if (RETURN_ERROR(Status)) {
       return Status;
     }
-  } else if (SpdmResponse.Header.RequestResponseCode != SPDM_ALGORITHMS) {
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_ALGORITHMS) {
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponseSize < sizeof(SPDM_ALGORITHMS_RESPONSE)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponseSize > sizeof(SpdmResponse)) {
+  if (SpdmResponseSize > sizeof(SPDM_ALGORITHMS_RESPONSE_MAX)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.ExtAsymSelCount > 1) {
+  if (SpdmResponse->ExtAsymSelCount > 1) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.ExtHashSelCount > 1) {
+  if (SpdmResponse->ExtHashSelCount > 1) {
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponseSize < sizeof(SPDM_ALGORITHMS_RESPONSE) + 
-                         sizeof(UINT32) * SpdmResponse.ExtAsymSelCount +
-                         sizeof(UINT32) * SpdmResponse.ExtHashSelCount +
-                         sizeof(SPDM_NEGOTIATE_ALGORITHMS_COMMON_STRUCT_TABLE) * SpdmResponse.Header.Param1) {
+                         sizeof(UINT32) * SpdmResponse->ExtAsymSelCount +
+                         sizeof(UINT32) * SpdmResponse->ExtHashSelCount +
+                         sizeof(SPDM_NEGOTIATE_ALGORITHMS_COMMON_STRUCT_TABLE) * SpdmResponse->Header.Param1) {
     return RETURN_DEVICE_ERROR;
   }
-  StructTable = (VOID *)((UINTN)&SpdmResponse +
+  StructTable = (VOID *)((UINTN)SpdmResponse +
                             sizeof(SPDM_ALGORITHMS_RESPONSE) +
-                            sizeof(UINT32) * SpdmResponse.ExtAsymSelCount +
-                            sizeof(UINT32) * SpdmResponse.ExtHashSelCount
+                            sizeof(UINT32) * SpdmResponse->ExtAsymSelCount +
+                            sizeof(UINT32) * SpdmResponse->ExtHashSelCount
                             );
-  if (SpdmResponse.Header.SPDMVersion >= SPDM_MESSAGE_VERSION_11) {
-    for (Index = 0; Index < SpdmResponse.Header.Param1; Index++) {
-      if ((UINTN)&SpdmResponse + SpdmResponseSize < (UINTN)StructTable) {
+  if (SpdmResponse->Header.SPDMVersion >= SPDM_MESSAGE_VERSION_11) {
+    for (Index = 0; Index < SpdmResponse->Header.Param1; Index++) {
+      if ((UINTN)SpdmResponse + SpdmResponseSize < (UINTN)StructTable) {
         return RETURN_DEVICE_ERROR;
       }
-      if ((UINTN)&SpdmResponse + SpdmResponseSize - (UINTN)StructTable < sizeof(SPDM_NEGOTIATE_ALGORITHMS_COMMON_STRUCT_TABLE)) {
+      if ((UINTN)SpdmResponse + SpdmResponseSize - (UINTN)StructTable < sizeof(SPDM_NEGOTIATE_ALGORITHMS_COMMON_STRUCT_TABLE)) {
         return RETURN_DEVICE_ERROR;
       }
       FixedAlgSize = (StructTable->AlgCount >> 4) & 0xF;
@@ -168,29 +202,29 @@ TrySpdmNegotiateAlgorithms (
       if (ExtAlgCount > 1) {
         return RETURN_DEVICE_ERROR;
       }
-      if ((UINTN)&SpdmResponse + SpdmResponseSize - (UINTN)StructTable - sizeof(SPDM_NEGOTIATE_ALGORITHMS_COMMON_STRUCT_TABLE) < sizeof(UINT32) * ExtAlgCount) {
+      if ((UINTN)SpdmResponse + SpdmResponseSize - (UINTN)StructTable - sizeof(SPDM_NEGOTIATE_ALGORITHMS_COMMON_STRUCT_TABLE) < sizeof(UINT32) * ExtAlgCount) {
         return RETURN_DEVICE_ERROR;
       }
       StructTable = (VOID *)((UINTN)StructTable + sizeof (SPDM_NEGOTIATE_ALGORITHMS_COMMON_STRUCT_TABLE) + sizeof(UINT32) * ExtAlgCount);
     }
   }
-  SpdmResponseSize = (UINTN)StructTable - (UINTN)&SpdmResponse;
-  if (SpdmResponseSize != SpdmResponse.Length) {
+  SpdmResponseSize = (UINTN)StructTable - (UINTN)SpdmResponse;
+  if (SpdmResponseSize != SpdmResponse->Length) {
     return RETURN_DEVICE_ERROR;
   }
 
   //
   // Cache data
   //
-  Status = SpdmAppendMessageA (SpdmContext, &SpdmResponse, SpdmResponseSize);
+  Status = SpdmAppendMessageA (SpdmContext, SpdmResponse, SpdmResponseSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
-  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = SpdmResponse.MeasurementSpecificationSel;
-  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = SpdmResponse.MeasurementHashAlgo;
-  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = SpdmResponse.BaseAsymSel;
-  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = SpdmResponse.BaseHashSel;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = SpdmResponse->MeasurementSpecificationSel;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = SpdmResponse->MeasurementHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = SpdmResponse->BaseAsymSel;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = SpdmResponse->BaseHashSel;
 
   if (SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP)) {
     if (SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec != SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF) {
@@ -205,6 +239,9 @@ TrySpdmNegotiateAlgorithms (
   if (AlgoSize == 0) {
     return RETURN_SECURITY_VIOLATION;
   }
+  if ((SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo & SPDM_SHA3_BASE_HASH_ALGO) != 0) {
+    return RETURN_SECURITY_VIOLATION;
+  }
   if (SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP)) {
     AlgoSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
     if (AlgoSize == 0) {
@@ -212,13 +249,13 @@ TrySpdmNegotiateAlgorithms (
     }
   }
 
-  if (SpdmResponse.Header.SPDMVersion >= SPDM_MESSAGE_VERSION_11) {
-    StructTable = (VOID *)((UINTN)&SpdmResponse +
+  if (SpdmResponse->Header.SPDMVersion >= SPDM_MESSAGE_VERSION_11) {
+    StructTable = (VOID *)((UINTN)SpdmResponse +
                             sizeof(SPDM_ALGORITHMS_RESPONSE) +
-                            sizeof(UINT32) * SpdmResponse.ExtAsymSelCount +
-                            sizeof(UINT32) * SpdmResponse.ExtHashSelCount
+                            sizeof(UINT32) * SpdmResponse->ExtAsymSelCount +
+                            sizeof(UINT32) * SpdmResponse->ExtHashSelCount
                             );
-    for (Index = 0; Index < SpdmResponse.Header.Param1; Index++) {
+    for (Index = 0; Index < SpdmResponse->Header.Param1; Index++) {
       switch (StructTable->AlgType) {
       case SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_DHE:
         SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = StructTable->AlgSupported;
@@ -269,10 +306,77 @@ TrySpdmNegotiateAlgorithms (
     SpdmContext->ConnectionInfo.Algorithm.KeySchedule = 0;
   }
 
+  //
+  // The responder may only select the offered algorithms of the minimum security strength.
+  //
+  if (SpdmContext->AlgorithmCostModelEnabled && (SpdmContext->AlgorithmCostModel.MinSecurityStrength != 0)) {
+    SpdmGetNegotiableAlgorithm (SpdmContext, &Algorithm);
+    if (((SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo & ~Algorithm.BaseAsymAlgo) != 0) ||
+        ((SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo & ~Algorithm.BaseHashAlgo) != 0) ||
+        ((SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup & ~Algorithm.DHENamedGroup) != 0) ||
+        ((SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite & ~Algorithm.AEADCipherSuite) != 0) ||
+        ((SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg & ~Algorithm.ReqBaseAsymAlg) != 0)) {
+      return RETURN_SECURITY_VIOLATION;
+    }
+  }
+
+#ifdef OPENSPDM_FIXED_SUITE
+  //
+  // Only the crypto of the fixed suite is built.
+  //
+  if (((SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo & ~OPENSPDM_FIXED_MEASUREMENT_HASH_ALGO) != 0) ||
+      ((SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo & ~OPENSPDM_FIXED_BASE_ASYM_ALGO) != 0) ||
+      ((SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo & ~OPENSPDM_FIXED_BASE_HASH_ALGO) != 0) ||
+      ((SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup & ~OPENSPDM_FIXED_DHE_NAMED_GROUP) != 0) ||
+      ((SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite & ~OPENSPDM_FIXED_AEAD_CIPHER_SUITE) != 0) ||
+      ((SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg & ~OPENSPDM_FIXED_REQ_BASE_ASYM_ALG) != 0)) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+#endif
+
+  SpdmFinishMessageADigest (SpdmContext);
   SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
   return RETURN_SUCCESS;
 }
 
+/**
+  This function sends NEGOTIATE_ALGORITHMS and receives ALGORITHMS.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval RETURN_SUCCESS               The NEGOTIATE_ALGORITHMS is sent and the ALGORITHMS is received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+TrySpdmNegotiateAlgorithms (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_NEGOTIATE_ALGORITHMS_REQUEST_MINE    SpdmRequest;
+  UINTN                                     SpdmRequestSize;
+  SPDM_ALGORITHMS_RESPONSE_MAX              SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+
+  SpdmRequestSize = sizeof(SpdmRequest);
+  Status = SpdmBuildNegotiateAlgorithmsRequest (SpdmContext, &SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  SpdmResponseSize = sizeof(SpdmResponse);
+  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return SpdmProcessAlgorithmsResponse (SpdmContext, SpdmRequestSize, &SpdmRequest, SpdmResponseSize, &SpdmResponse);
+}
+
 /**
   This function sends NEGOTIATE_ALGORITHMS and receives ALGORITHMS.
 
@@ -0,0 +1,542 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmRequesterLibInternal.h"
+
+/**
+  Return the size in bytes of the SPDM context of an endpoint in a requester pool.
+
+  @return the size in bytes of the SPDM context, aligned for the next context.
+**/
+UINTN
+SpdmRequesterPoolGetContextSize (
+  VOID
+  )
+{
+  return ALIGN_VALUE (SpdmGetContextSize (), sizeof(UINT64));
+}
+
+/**
+  Return an endpoint of a requester pool.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  EndpointIndex                The index of the endpoint.
+
+  @return the endpoint.
+**/
+SPDM_REQUESTER_POOL_ENDPOINT *
+SpdmRequesterPoolGetEndpoint (
+  IN     SPDM_REQUESTER_POOL  *Pool,
+  IN     UINTN                EndpointIndex
+  )
+{
+  return (SPDM_REQUESTER_POOL_ENDPOINT *)(Pool + 1) + EndpointIndex;
+}
+
+/**
+  Acquire the lock of a requester pool, if the pool has one.
+
+  @param  Pool                         A pointer to the requester pool.
+**/
+VOID
+SpdmRequesterPoolLock (
+  IN     SPDM_REQUESTER_POOL  *Pool
+  )
+{
+  if (Pool->AcquireLock != NULL) {
+    Pool->AcquireLock (Pool->LockContext);
+  }
+}
+
+/**
+  Release the lock of a requester pool, if the pool has one.
+
+  @param  Pool                         A pointer to the requester pool.
+**/
+VOID
+SpdmRequesterPoolUnlock (
+  IN     SPDM_REQUESTER_POOL  *Pool
+  )
+{
+  if (Pool->ReleaseLock != NULL) {
+    Pool->ReleaseLock (Pool->LockContext);
+  }
+}
+
+/**
+  Return the size in bytes of a requester pool.
+
+  @param  EndpointCount                The number of endpoints in the pool.
+
+  @return the size in bytes of the requester pool.
+**/
+UINTN
+EFIAPI
+SpdmRequesterPoolGetSize (
+  IN     UINTN                EndpointCount
+  )
+{
+  return sizeof(SPDM_REQUESTER_POOL) +
+         (sizeof(SPDM_REQUESTER_POOL_ENDPOINT) + SpdmRequesterPoolGetContextSize ()) * EndpointCount;
+}
+
+/**
+  Initialize a requester pool.
+
+  The size in bytes of the pool can be returned by SpdmRequesterPoolGetSize.
+  The pool holds one SPDM context per endpoint, initialized by SpdmInitContext.
+  If SpdmRequesterPoolRun is called by multiple workers concurrently,
+  AcquireLock and ReleaseLock must be provided to serialize the scheduling of the endpoints.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  EndpointCount                The number of endpoints in the pool.
+  @param  PollTimeout                  The timeout passed to ReceiveMessage to poll an endpoint, in units of 100ns.
+                                       It must not be 0, because 0 waits for the response indefinitely.
+  @param  AcquireLock                  The function to acquire the pool lock, or NULL.
+  @param  ReleaseLock                  The function to release the pool lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+
+  @retval RETURN_SUCCESS               The pool is initialized.
+  @retval RETURN_INVALID_PARAMETER     EndpointCount or PollTimeout is 0.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolInit (
+  IN     VOID                           *Pool,
+  IN     UINTN                          EndpointCount,
+  IN     UINT64                         PollTimeout,
+  IN     SPDM_REQUESTER_POOL_LOCK_FUNC  AcquireLock OPTIONAL,
+  IN     SPDM_REQUESTER_POOL_LOCK_FUNC  ReleaseLock OPTIONAL,
+  IN     VOID                           *LockContext OPTIONAL
+  )
+{
+  SPDM_REQUESTER_POOL                       *PoolHeader;
+  SPDM_REQUESTER_POOL_ENDPOINT              *Endpoint;
+  UINT8                                     *SpdmContext;
+  UINTN                                     Index;
+
+  if ((EndpointCount == 0) || (PollTimeout == 0)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  PoolHeader = Pool;
+  ZeroMem (PoolHeader, sizeof(SPDM_REQUESTER_POOL) + sizeof(SPDM_REQUESTER_POOL_ENDPOINT) * EndpointCount);
+  PoolHeader->EndpointCount = EndpointCount;
+  PoolHeader->PollTimeout = PollTimeout;
+  PoolHeader->AcquireLock = AcquireLock;
+  PoolHeader->ReleaseLock = ReleaseLock;
+  PoolHeader->LockContext = LockContext;
+
+  SpdmContext = (UINT8 *)SpdmRequesterPoolGetEndpoint (PoolHeader, EndpointCount);
+  for (Index = 0; Index < EndpointCount; Index++) {
+    Endpoint = SpdmRequesterPoolGetEndpoint (PoolHeader, Index);
+    Endpoint->SpdmContext = (SPDM_DEVICE_CONTEXT *)SpdmContext;
+    Endpoint->Operation = SpdmRequesterPoolOperationInitConnection;
+    SpdmInitContext (Endpoint->SpdmContext);
+    SpdmContext += SpdmRequesterPoolGetContextSize ();
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return the SPDM context of an endpoint in a requester pool.
+
+  The caller registers the device IO and the transport layer functions of the endpoint with the context.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  EndpointIndex                The index of the endpoint.
+
+  @return the SPDM context of the endpoint, or NULL if EndpointIndex is out of range.
+**/
+VOID *
+EFIAPI
+SpdmRequesterPoolGetContext (
+  IN     VOID                 *Pool,
+  IN     UINTN                EndpointIndex
+  )
+{
+  SPDM_REQUESTER_POOL                       *PoolHeader;
+
+  PoolHeader = Pool;
+  if (EndpointIndex >= PoolHeader->EndpointCount) {
+    return NULL;
+  }
+  return SpdmRequesterPoolGetEndpoint (PoolHeader, EndpointIndex)->SpdmContext;
+}
+
+/**
+  Set the local configuration shared by all endpoints of a requester pool.
+
+  It calls SpdmSetData for the SPDM context of each endpoint, such as the capabilities, the algorithms,
+  the local certificate chains and the peer root certificate hash.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  DataType                     Type of the SPDM context data.
+  @param  Parameter                    Type specific parameter of the SPDM context data.
+  @param  Data                         A pointer to the SPDM context data.
+  @param  DataSize                     Size in bytes of the SPDM context data.
+
+  @retval RETURN_SUCCESS               The SPDM context data is set for all endpoints.
+  @retval others                       SpdmSetData fails for an endpoint.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolSetData (
+  IN     VOID                 *Pool,
+  IN     SPDM_DATA_TYPE       DataType,
+  IN     SPDM_DATA_PARAMETER  *Parameter,
+  IN     VOID                 *Data,
+  IN     UINTN                DataSize
+  )
+{
+  SPDM_REQUESTER_POOL                       *PoolHeader;
+  RETURN_STATUS                             Status;
+  UINTN                                     Index;
+
+  PoolHeader = Pool;
+  for (Index = 0; Index < PoolHeader->EndpointCount; Index++) {
+    Status = SpdmSetData (SpdmRequesterPoolGetEndpoint (PoolHeader, Index)->SpdmContext, DataType, Parameter, Data, DataSize);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Set the attestation of an endpoint of a requester pool.
+
+  SpdmRequesterPoolRun attests the endpoint with InitConnection, GetDigest, GetCertificate and Challenge.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  EndpointIndex                The index of the endpoint.
+  @param  SlotNum                      The number of slot for the certificate chain and the challenge.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  CertChainSize                On input, indicate the size in bytes of the destination buffer to store the certificate chain.
+                                       On output, indicate the size in bytes of the certificate chain.
+  @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+
+  @retval RETURN_SUCCESS               The attestation is set.
+  @retval RETURN_INVALID_PARAMETER     EndpointIndex is out of range.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolSetAttestation (
+  IN     VOID                 *Pool,
+  IN     UINTN                EndpointIndex,
+  IN     UINT8                SlotNum,
+  IN     UINT8                MeasurementHashType,
+  IN OUT UINTN                *CertChainSize,
+     OUT VOID                 *CertChain,
+     OUT VOID                 *MeasurementHash
+  )
+{
+  SPDM_REQUESTER_POOL                       *PoolHeader;
+  SPDM_REQUESTER_POOL_ENDPOINT              *Endpoint;
+
+  PoolHeader = Pool;
+  if (EndpointIndex >= PoolHeader->EndpointCount) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Endpoint = SpdmRequesterPoolGetEndpoint (PoolHeader, EndpointIndex);
+  Endpoint->SlotNum = SlotNum;
+  Endpoint->MeasurementHashType = MeasurementHashType;
+  Endpoint->CertChainSize = CertChainSize;
+  Endpoint->CertChain = CertChain;
+  Endpoint->MeasurementHash = MeasurementHash;
+  Endpoint->Configured = TRUE;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Start the current operation of an endpoint with a SpdmRequesterBegin function.
+
+  @param  Endpoint                     A pointer to the endpoint.
+
+  @return the status of the SpdmRequesterBegin function.
+**/
+RETURN_STATUS
+SpdmRequesterPoolBeginOperation (
+  IN     SPDM_REQUESTER_POOL_ENDPOINT  *Endpoint
+  )
+{
+  switch (Endpoint->Operation) {
+  case SpdmRequesterPoolOperationInitConnection:
+    return SpdmRequesterBeginInitConnection (Endpoint->SpdmContext, FALSE);
+  case SpdmRequesterPoolOperationGetDigest:
+    return SpdmRequesterBeginGetDigest (Endpoint->SpdmContext, NULL, NULL);
+  case SpdmRequesterPoolOperationGetCertificate:
+    return SpdmRequesterBeginGetCertificate (Endpoint->SpdmContext, Endpoint->SlotNum, Endpoint->CertChainSize, Endpoint->CertChain);
+  case SpdmRequesterPoolOperationChallenge:
+    return SpdmRequesterBeginChallenge (Endpoint->SpdmContext, Endpoint->SlotNum, Endpoint->MeasurementHashType, Endpoint->MeasurementHash);
+  default:
+    ASSERT (FALSE);
+    return RETURN_UNSUPPORTED;
+  }
+}
+
+/**
+  Claim the next endpoint which needs to be serviced, in turn from the last claimed one.
+
+  The caller must hold the pool lock.
+
+  @param  Pool                         A pointer to the requester pool.
+
+  @return the index of the claimed endpoint, or EndpointCount if all endpoints are claimed or done.
+**/
+UINTN
+SpdmRequesterPoolClaimEndpoint (
+  IN     SPDM_REQUESTER_POOL  *Pool
+  )
+{
+  SPDM_REQUESTER_POOL_ENDPOINT              *Endpoint;
+  UINTN                                     Index;
+  UINTN                                     EndpointIndex;
+
+  for (Index = 0; Index < Pool->EndpointCount; Index++) {
+    EndpointIndex = (Pool->NextEndpoint + Index) % Pool->EndpointCount;
+    Endpoint = SpdmRequesterPoolGetEndpoint (Pool, EndpointIndex);
+    if (!Endpoint->Claimed && !Endpoint->Done) {
+      Endpoint->Claimed = TRUE;
+      Pool->NextEndpoint = (EndpointIndex + 1) % Pool->EndpointCount;
+      return EndpointIndex;
+    }
+  }
+  return Pool->EndpointCount;
+}
+
+/**
+  Service an endpoint of a requester pool by one message.
+
+  If the endpoint waits for a response, ReceiveMessage polls it with the pool timeout,
+  and the endpoint is left to the next turn if the response is not received yet.
+  Otherwise, the response is verified by SpdmRequesterStep, and the next request is sent.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  EndpointIndex                The index of the endpoint claimed by the caller.
+**/
+VOID
+SpdmRequesterPoolService (
+  IN     SPDM_REQUESTER_POOL  *Pool,
+  IN     UINTN                EndpointIndex
+  )
+{
+  SPDM_REQUESTER_POOL_ENDPOINT              *Endpoint;
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  RETURN_STATUS                             Status;
+  UINTN                                     IncomingMessageSize;
+  UINTN                                     OutgoingMessageSize;
+
+  Endpoint = SpdmRequesterPoolGetEndpoint (Pool, EndpointIndex);
+  SpdmContext = Endpoint->SpdmContext;
+
+  if (!Endpoint->Configured) {
+    Endpoint->Status = RETURN_NOT_STARTED;
+    Endpoint->Done = TRUE;
+    return;
+  }
+
+  OutgoingMessageSize = sizeof(Endpoint->OutgoingMessage);
+  if (!Endpoint->Started) {
+    Status = SpdmRequesterPoolBeginOperation (Endpoint);
+    if (!RETURN_ERROR(Status)) {
+      Status = SpdmRequesterStep (SpdmContext, 0, NULL, &OutgoingMessageSize, Endpoint->OutgoingMessage);
+    }
+  } else {
+    IncomingMessageSize = sizeof(Endpoint->IncomingMessage);
+    Status = SpdmDeviceReceiveMessage (SpdmContext, &IncomingMessageSize, Endpoint->IncomingMessage, Pool->PollTimeout);
+    if (Status == RETURN_TIMEOUT) {
+      return;
+    }
+    if (RETURN_ERROR(Status)) {
+      SpdmRequesterAbort (SpdmContext);
+      Status = RETURN_DEVICE_ERROR;
+    } else {
+      Status = SpdmRequesterStep (SpdmContext, IncomingMessageSize, Endpoint->IncomingMessage, &OutgoingMessageSize, Endpoint->OutgoingMessage);
+    }
+  }
+
+  if (Status == RETURN_NOT_READY) {
+    Status = SpdmDeviceSendMessage (SpdmContext, OutgoingMessageSize, Endpoint->OutgoingMessage, 0);
+    if (!RETURN_ERROR(Status)) {
+      Endpoint->Started = TRUE;
+      return;
+    }
+    SpdmRequesterAbort (SpdmContext);
+    Status = RETURN_DEVICE_ERROR;
+  }
+
+  Endpoint->Started = FALSE;
+  if (RETURN_ERROR(Status)) {
+    DEBUG((DEBUG_INFO, "SpdmRequesterPool[%x] Operation(%x) - %p\n", EndpointIndex, Endpoint->Operation, Status));
+    Endpoint->Status = Status;
+    Endpoint->Done = TRUE;
+    return;
+  }
+  Endpoint->Operation++;
+  if (Endpoint->Operation == SpdmRequesterPoolOperationMax) {
+    Endpoint->Status = RETURN_SUCCESS;
+    Endpoint->Done = TRUE;
+  }
+}
+
+/**
+  Attest all endpoints of a requester pool.
+
+  The endpoints are driven by SpdmRequesterStep in turn. While one endpoint waits for its response,
+  the others send requests and verify responses, so that the IO waits overlap with the verification.
+  Multiple workers may call this function with the same pool concurrently. It returns when all endpoints are done.
+
+  @param  Pool                         A pointer to the requester pool.
+
+  @retval RETURN_SUCCESS               All endpoints are attested.
+  @retval others                       The status of the first endpoint failing the attestation.
+                                       The status of each endpoint can be returned by SpdmRequesterPoolGetStatus.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolRun (
+  IN     VOID                 *Pool
+  )
+{
+  SPDM_REQUESTER_POOL                       *PoolHeader;
+  SPDM_REQUESTER_POOL_ENDPOINT              *Endpoint;
+  UINTN                                     EndpointIndex;
+  UINTN                                     Index;
+
+  PoolHeader = Pool;
+  while (TRUE) {
+    SpdmRequesterPoolLock (PoolHeader);
+    if (PoolHeader->DoneCount == PoolHeader->EndpointCount) {
+      SpdmRequesterPoolUnlock (PoolHeader);
+      break;
+    }
+    EndpointIndex = SpdmRequesterPoolClaimEndpoint (PoolHeader);
+    SpdmRequesterPoolUnlock (PoolHeader);
+    if (EndpointIndex == PoolHeader->EndpointCount) {
+      //
+      // The remaining endpoints are serviced by other workers.
+      //
+      continue;
+    }
+
+    SpdmRequesterPoolService (PoolHeader, EndpointIndex);
+
+    Endpoint = SpdmRequesterPoolGetEndpoint (PoolHeader, EndpointIndex);
+    SpdmRequesterPoolLock (PoolHeader);
+    Endpoint->Claimed = FALSE;
+    if (Endpoint->Done) {
+      PoolHeader->DoneCount++;
+    }
+    SpdmRequesterPoolUnlock (PoolHeader);
+  }
+
+  for (Index = 0; Index < PoolHeader->EndpointCount; Index++) {
+    Endpoint = SpdmRequesterPoolGetEndpoint (PoolHeader, Index);
+    if (RETURN_ERROR(Endpoint->Status) && (Endpoint->Status != RETURN_NOT_STARTED)) {
+      return Endpoint->Status;
+    }
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return the attestation status of an endpoint of a requester pool.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  EndpointIndex                The index of the endpoint.
+
+  @retval RETURN_SUCCESS               The endpoint is attested.
+  @retval RETURN_NOT_READY             The attestation of the endpoint is in progress, or is not run.
+  @retval RETURN_NOT_STARTED           The attestation of the endpoint is not set by SpdmRequesterPoolSetAttestation.
+  @retval RETURN_INVALID_PARAMETER     EndpointIndex is out of range.
+  @retval others                       The attestation of the endpoint fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolGetStatus (
+  IN     VOID                 *Pool,
+  IN     UINTN                EndpointIndex
+  )
+{
+  SPDM_REQUESTER_POOL                       *PoolHeader;
+  SPDM_REQUESTER_POOL_ENDPOINT              *Endpoint;
+
+  PoolHeader = Pool;
+  if (EndpointIndex >= PoolHeader->EndpointCount) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Endpoint = SpdmRequesterPoolGetEndpoint (PoolHeader, EndpointIndex);
+  if (!Endpoint->Configured) {
+    return RETURN_NOT_STARTED;
+  }
+  if (!Endpoint->Done) {
+    return RETURN_NOT_READY;
+  }
+  return Endpoint->Status;
+}
+
+/**
+  Send the heartbeats due for the sessions of all endpoints of a requester pool.
+
+  It calls SpdmRunHeartbeats for each endpoint which is not serviced by a worker of SpdmRequesterPoolRun,
+  so that the heartbeats of all endpoints are sent on one wakeup.
+
+  @param  Pool                         A pointer to the requester pool.
+  @param  NextWakeupTime               Return the earliest time a heartbeat must be sent, in 100ns units,
+                                       or 0 if no session has a heartbeat.
+
+  @retval RETURN_SUCCESS               The due heartbeats are sent.
+  @retval others                       The status of the first endpoint failing a heartbeat.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterPoolRunHeartbeats (
+  IN     VOID                 *Pool,
+     OUT UINT64               *NextWakeupTime
+  )
+{
+  SPDM_REQUESTER_POOL                       *PoolHeader;
+  SPDM_REQUESTER_POOL_ENDPOINT              *Endpoint;
+  RETURN_STATUS                             Status;
+  RETURN_STATUS                             EndpointStatus;
+  UINT64                                    EndpointWakeupTime;
+  UINTN                                     Index;
+
+  PoolHeader = Pool;
+  *NextWakeupTime = 0;
+  Status = RETURN_SUCCESS;
+  for (Index = 0; Index < PoolHeader->EndpointCount; Index++) {
+    Endpoint = SpdmRequesterPoolGetEndpoint (PoolHeader, Index);
+    SpdmRequesterPoolLock (PoolHeader);
+    if (Endpoint->Claimed) {
+      SpdmRequesterPoolUnlock (PoolHeader);
+      continue;
+    }
+    Endpoint->Claimed = TRUE;
+    SpdmRequesterPoolUnlock (PoolHeader);
+
+    EndpointStatus = SpdmRunHeartbeats (Endpoint->SpdmContext, &EndpointWakeupTime);
+
+    SpdmRequesterPoolLock (PoolHeader);
+    Endpoint->Claimed = FALSE;
+    SpdmRequesterPoolUnlock (PoolHeader);
+
+    if (RETURN_ERROR(EndpointStatus) && !RETURN_ERROR(Status)) {
+      Status = EndpointStatus;
+    }
+    if ((EndpointWakeupTime != 0) && ((*NextWakeupTime == 0) || (EndpointWakeupTime < *NextWakeupTime))) {
+      *NextWakeupTime = EndpointWakeupTime;
+    }
+  }
+  return Status;
+}
@@ -9,6 +9,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmRequesterLibInternal.h"
 
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
+
 #pragma pack(1)
 
 typedef struct {
@@ -37,43 +39,31 @@ typedef struct {
 #pragma pack()
 
 /**
-  This function sends PSK_EXCHANGE and receives PSK_EXCHANGE_RSP for SPDM PSK exchange.
+  This function builds PSK_EXCHANGE.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  MeasurementHashType          MeasurementHashType to the PSK_EXCHANGE request.
-  @param  HeartbeatPeriod              HeartbeatPeriod from the PSK_EXCHANGE_RSP response.
-  @param  SessionId                    SessionId from the PSK_EXCHANGE_RSP response.
-  @param  MeasurementHash              MeasurementHash from the PSK_EXCHANGE_RSP response.
-
-  @retval RETURN_SUCCESS               The PSK_EXCHANGE is sent and the PSK_EXCHANGE_RSP is received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the PSK_EXCHANGE request.
+  @param  Request                      A pointer to a destination buffer to store the PSK_EXCHANGE request.
+
+  @retval RETURN_SUCCESS               The PSK_EXCHANGE request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The connection state or the capabilities do not allow PSK_EXCHANGE.
+  @retval RETURN_DEVICE_ERROR          The negotiated algorithms do not allow PSK_EXCHANGE.
 **/
 RETURN_STATUS
-TrySpdmSendReceivePskExchange (
+SpdmBuildPskExchangeRequest (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
   IN     UINT8                MeasurementHashType,
-     OUT UINT32               *SessionId,
-     OUT UINT8                *HeartbeatPeriod,
-     OUT VOID                 *MeasurementHash
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
   )
 {
-  BOOLEAN                                   Result;
   RETURN_STATUS                             Status;
-  SPDM_PSK_EXCHANGE_REQUEST_MINE            SpdmRequest;
-  UINTN                                     SpdmRequestSize;
-  SPDM_PSK_EXCHANGE_RESPONSE_MAX            SpdmResponse;
-  UINTN                                     SpdmResponseSize;
-  UINT32                                    MeasurementSummaryHashSize;
-  UINT32                                    HmacSize;
+  SPDM_PSK_EXCHANGE_REQUEST_MINE            *SpdmRequest;
   UINT8                                     *Ptr;
-  VOID                                      *MeasurementSummaryHash;
-  UINT8                                     *VerifyData;
-  UINT16                                    ReqSessionId;
-  UINT16                                    RspSessionId;
-  SPDM_SESSION_INFO                         *SessionInfo;
   UINTN                                     OpaquePskExchangeReqSize;
-  UINT8                                     TH1HashData[64];
-  UINT8                                     TH2HashData[64];
   UINT32                                    AlgoSize;
 
   // Check capabilities even if GET_CAPABILITIES is not sent.
@@ -105,80 +95,135 @@ TrySpdmSendReceivePskExchange (
     }
   }
 
+  if (*RequestSize < sizeof(SPDM_PSK_EXCHANGE_REQUEST_MINE)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SpdmRequest = Request;
+
   SpdmContext->ErrorState = SPDM_STATUS_ERROR_DEVICE_NO_CAPABILITIES;
 
-  SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
-  SpdmRequest.Header.RequestResponseCode = SPDM_PSK_EXCHANGE;
-  SpdmRequest.Header.Param1 = MeasurementHashType;
-  SpdmRequest.Header.Param2 = 0;
-  SpdmRequest.PSKHintLength = (UINT16)SpdmContext->LocalContext.PskHintSize;
-  SpdmRequest.RequesterContextLength = DEFAULT_CONTEXT_LENGTH;
+  SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmRequest->Header.RequestResponseCode = SPDM_PSK_EXCHANGE;
+  SpdmRequest->Header.Param1 = MeasurementHashType;
+  SpdmRequest->Header.Param2 = 0;
+  SpdmRequest->PSKHintLength = (UINT16)SpdmContext->LocalContext.PskHintSize;
+  SpdmRequest->RequesterContextLength = DEFAULT_CONTEXT_LENGTH;
   OpaquePskExchangeReqSize = SpdmGetOpaqueDataSupportedVersionDataSize (SpdmContext);
-  SpdmRequest.OpaqueLength = (UINT16)OpaquePskExchangeReqSize;
+  SpdmRequest->OpaqueLength = (UINT16)OpaquePskExchangeReqSize;
 
-  ReqSessionId = SpdmAllocateReqSessionId (SpdmContext);
-  SpdmRequest.ReqSessionID = ReqSessionId;
+  SpdmRequest->ReqSessionID = SpdmAllocateReqSessionId (SpdmContext);
 
-  Ptr = SpdmRequest.PSKHint;
+  Ptr = SpdmRequest->PSKHint;
   CopyMem (Ptr, SpdmContext->LocalContext.PskHint, SpdmContext->LocalContext.PskHintSize);
-  DEBUG((DEBUG_INFO, "PskHint (0x%x) - ", SpdmRequest.PSKHintLength));
-  InternalDumpData (Ptr, SpdmRequest.PSKHintLength);
-  DEBUG((DEBUG_INFO, "\n"));
-  Ptr += SpdmRequest.PSKHintLength;
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_KEY)) {
+    DEBUG((DEBUG_INFO, "PskHint (0x%x) - ", SpdmRequest->PSKHintLength));
+    InternalDumpData (Ptr, SpdmRequest->PSKHintLength);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
+  Ptr += SpdmRequest->PSKHintLength;
 
-  SpdmGetRandomNumber (DEFAULT_CONTEXT_LENGTH, Ptr);
-  DEBUG((DEBUG_INFO, "ClientRandomData (0x%x) - ", SpdmRequest.RequesterContextLength));
-  InternalDumpData (Ptr, SpdmRequest.RequesterContextLength);
-  DEBUG((DEBUG_INFO, "\n"));
-  Ptr += SpdmRequest.RequesterContextLength;
+  SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, DEFAULT_CONTEXT_LENGTH, Ptr);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "ClientRandomData (0x%x) - ", SpdmRequest->RequesterContextLength));
+    InternalDumpData (Ptr, SpdmRequest->RequesterContextLength);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
+  Ptr += SpdmRequest->RequesterContextLength;
 
   Status = SpdmBuildOpaqueDataSupportedVersionData (SpdmContext, &OpaquePskExchangeReqSize, Ptr);
   ASSERT_RETURN_ERROR(Status);
   Ptr += OpaquePskExchangeReqSize;
 
-  SpdmRequestSize = (UINTN)Ptr - (UINTN)&SpdmRequest;
-  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
+  *RequestSize = (UINTN)Ptr - (UINTN)SpdmRequest;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function processes PSK_EXCHANGE_RSP, and generates the session handshake key.
+
+  If the responder does not support PSK_FINISH, the session data key is also generated.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementHashType          MeasurementHashType to the PSK_EXCHANGE request.
+  @param  RequestSize                  Size in bytes of the sent PSK_EXCHANGE request.
+  @param  Request                      A pointer to the sent PSK_EXCHANGE request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+  @param  SessionId                    SessionId from the PSK_EXCHANGE_RSP response.
+  @param  HeartbeatPeriod              HeartbeatPeriod from the PSK_EXCHANGE_RSP response.
+  @param  MeasurementHash              MeasurementHash from the PSK_EXCHANGE_RSP response.
+
+  @retval RETURN_SUCCESS               The PSK_EXCHANGE_RSP is received and verified.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid PSK_EXCHANGE_RSP.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+SpdmProcessPskExchangeResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementHashType,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response,
+     OUT UINT32               *SessionId,
+     OUT UINT8                *HeartbeatPeriod,
+     OUT VOID                 *MeasurementHash
+  )
+{
+  BOOLEAN                                   Result;
+  RETURN_STATUS                             Status;
+  SPDM_PSK_EXCHANGE_RESPONSE_MAX            *SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+  UINT32                                    MeasurementSummaryHashSize;
+  UINT32                                    HmacSize;
+  UINT8                                     *Ptr;
+  VOID                                      *MeasurementSummaryHash;
+  UINT8                                     *VerifyData;
+  UINT16                                    ReqSessionId;
+  UINT16                                    RspSessionId;
+  SPDM_SESSION_INFO                         *SessionInfo;
+  UINT8                                     TH1HashData[64];
+  UINT8                                     TH2HashData[64];
+
+  SpdmResponse = Response;
+  SpdmResponseSize = ResponseSize;
+  ReqSessionId = ((SPDM_PSK_EXCHANGE_REQUEST_MINE *)Request)->ReqSessionID;
 
-  SpdmResponseSize = sizeof(SpdmResponse);
-  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
   if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-    Status = SpdmHandleErrorResponseMain(SpdmContext, NULL, NULL, 0, &SpdmResponseSize, &SpdmResponse, SPDM_PSK_EXCHANGE, SPDM_PSK_EXCHANGE_RSP, sizeof(SPDM_PSK_EXCHANGE_RESPONSE_MAX));
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
+    Status = SpdmHandleErrorResponseMain(SpdmContext, NULL, NULL, 0, &SpdmResponseSize, SpdmResponse, SPDM_PSK_EXCHANGE, SPDM_PSK_EXCHANGE_RSP, sizeof(SPDM_PSK_EXCHANGE_RESPONSE_MAX));
     if (RETURN_ERROR(Status)) {
       return Status;
     }
-  } else if (SpdmResponse.Header.RequestResponseCode != SPDM_PSK_EXCHANGE_RSP) {
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_PSK_EXCHANGE_RSP) {
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponseSize < sizeof(SPDM_PSK_EXCHANGE_RESPONSE)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponseSize > sizeof(SpdmResponse)) {
+  if (SpdmResponseSize > sizeof(SPDM_PSK_EXCHANGE_RESPONSE_MAX)) {
     return RETURN_DEVICE_ERROR;
   }
   if (HeartbeatPeriod != NULL) {
-    *HeartbeatPeriod = SpdmResponse.Header.Param1;
+    *HeartbeatPeriod = SpdmResponse->Header.Param1;
   }
-  RspSessionId = SpdmResponse.RspSessionID;
+  RspSessionId = SpdmResponse->RspSessionID;
   *SessionId = (ReqSessionId << 16) | RspSessionId;
   SessionInfo = SpdmAssignSessionId (SpdmContext, *SessionId, TRUE);
   if (SessionInfo == NULL) {
     return RETURN_DEVICE_ERROR;
   }
+  SessionInfo->HeartbeatPeriod = SpdmResponse->Header.Param1;
+  SessionInfo->LastActivityTime = SpdmRequesterGetTime (SpdmContext);
 
   //
   // Cache session data
   //
-  Status = SpdmAppendMessageK (SessionInfo, &SpdmRequest, SpdmRequestSize);
+  Status = SpdmAppendMessageK (SessionInfo, Request, RequestSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
@@ -187,44 +232,48 @@ TrySpdmSendReceivePskExchange (
   HmacSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
 
   if (SpdmResponseSize < sizeof(SPDM_PSK_EXCHANGE_RESPONSE) +
-                         SpdmResponse.ResponderContextLength +
-                         SpdmResponse.OpaqueLength +
+                         SpdmResponse->ResponderContextLength +
+                         SpdmResponse->OpaqueLength +
                          MeasurementSummaryHashSize +
                          HmacSize) {
     SpdmFreeSessionId (SpdmContext, *SessionId);
     return RETURN_DEVICE_ERROR;
   }
 
-  Ptr = (UINT8 *)&SpdmResponse + sizeof(SPDM_PSK_EXCHANGE_RESPONSE) + MeasurementSummaryHashSize + SpdmResponse.ResponderContextLength;
-  Status = SpdmProcessOpaqueDataVersionSelectionData (SpdmContext, SpdmResponse.OpaqueLength, Ptr);
+  Ptr = (UINT8 *)SpdmResponse + sizeof(SPDM_PSK_EXCHANGE_RESPONSE) + MeasurementSummaryHashSize + SpdmResponse->ResponderContextLength;
+  Status = SpdmProcessOpaqueDataVersionSelectionData (SpdmContext, SpdmResponse->OpaqueLength, Ptr);
   if (RETURN_ERROR(Status)) {
     SpdmFreeSessionId (SpdmContext, *SessionId);
     return RETURN_UNSUPPORTED;
   }
 
   SpdmResponseSize = sizeof(SPDM_PSK_EXCHANGE_RESPONSE) +
-                     SpdmResponse.ResponderContextLength +
-                     SpdmResponse.OpaqueLength +
+                     SpdmResponse->ResponderContextLength +
+                     SpdmResponse->OpaqueLength +
                      MeasurementSummaryHashSize +
                      HmacSize;
 
-  Ptr = (UINT8 *)(SpdmResponse.MeasurementSummaryHash);
+  Ptr = (UINT8 *)(SpdmResponse->MeasurementSummaryHash);
   MeasurementSummaryHash = Ptr;
-  DEBUG((DEBUG_INFO, "MeasurementSummaryHash (0x%x) - ", MeasurementSummaryHashSize));
-  InternalDumpData (MeasurementSummaryHash, MeasurementSummaryHashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "MeasurementSummaryHash (0x%x) - ", MeasurementSummaryHashSize));
+    InternalDumpData (MeasurementSummaryHash, MeasurementSummaryHashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   Ptr += MeasurementSummaryHashSize;
 
-  DEBUG((DEBUG_INFO, "ServerRandomData (0x%x) - ", SpdmResponse.ResponderContextLength));
-  InternalDumpData (Ptr, SpdmResponse.ResponderContextLength);
-  DEBUG((DEBUG_INFO, "\n"));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "ServerRandomData (0x%x) - ", SpdmResponse->ResponderContextLength));
+    InternalDumpData (Ptr, SpdmResponse->ResponderContextLength);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
-  Ptr += SpdmResponse.ResponderContextLength;
+  Ptr += SpdmResponse->ResponderContextLength;
 
-  Ptr += SpdmResponse.OpaqueLength;
+  Ptr += SpdmResponse->OpaqueLength;
 
-  Status = SpdmAppendMessageK (SessionInfo, &SpdmResponse, SpdmResponseSize - HmacSize);
+  Status = SpdmAppendMessageK (SessionInfo, SpdmResponse, SpdmResponseSize - HmacSize);
   if (RETURN_ERROR(Status)) {
     SpdmFreeSessionId (SpdmContext, *SessionId);
     return RETURN_SECURITY_VIOLATION;
@@ -243,8 +292,10 @@ TrySpdmSendReceivePskExchange (
   }
 
   VerifyData = Ptr;
-  DEBUG((DEBUG_INFO, "VerifyData (0x%x):\n", HmacSize));
-  InternalDumpHex (VerifyData, HmacSize);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "VerifyData (0x%x):\n", HmacSize));
+    InternalDumpHex (VerifyData, HmacSize);
+  }
   Result = SpdmVerifyPskExchangeRspHmac (SpdmContext, SessionInfo, VerifyData, HmacSize);
   if (!Result) {
     SpdmFreeSessionId (SpdmContext, *SessionId);
@@ -284,6 +335,53 @@ TrySpdmSendReceivePskExchange (
   return RETURN_SUCCESS;
 }
 
+/**
+  This function sends PSK_EXCHANGE and receives PSK_EXCHANGE_RSP for SPDM PSK exchange.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MeasurementHashType          MeasurementHashType to the PSK_EXCHANGE request.
+  @param  HeartbeatPeriod              HeartbeatPeriod from the PSK_EXCHANGE_RSP response.
+  @param  SessionId                    SessionId from the PSK_EXCHANGE_RSP response.
+  @param  MeasurementHash              MeasurementHash from the PSK_EXCHANGE_RSP response.
+
+  @retval RETURN_SUCCESS               The PSK_EXCHANGE is sent and the PSK_EXCHANGE_RSP is received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+TrySpdmSendReceivePskExchange (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                MeasurementHashType,
+     OUT UINT32               *SessionId,
+     OUT UINT8                *HeartbeatPeriod,
+     OUT VOID                 *MeasurementHash
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_PSK_EXCHANGE_REQUEST_MINE            SpdmRequest;
+  UINTN                                     SpdmRequestSize;
+  SPDM_PSK_EXCHANGE_RESPONSE_MAX            SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+
+  SPDM_CRYPTO_STATS_BIND (SpdmContext);
+  SpdmRequestSize = sizeof(SpdmRequest);
+  Status = SpdmBuildPskExchangeRequest (SpdmContext, MeasurementHashType, &SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Status = SpdmSendSpdmRequest (SpdmContext, NULL, SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  SpdmResponseSize = sizeof(SpdmResponse);
+  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+  Status = SpdmReceiveSpdmResponse (SpdmContext, NULL, &SpdmResponseSize, &SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return SpdmProcessPskExchangeResponse (SpdmContext, MeasurementHashType, SpdmRequestSize, &SpdmRequest, SpdmResponseSize, &SpdmResponse, SessionId, HeartbeatPeriod, MeasurementHash);
+}
+
 RETURN_STATUS
 SpdmSendReceivePskExchange (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
@@ -307,3 +405,4 @@ SpdmSendReceivePskExchange (
   return Status;
 }
 
+#endif
@@ -9,6 +9,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmRequesterLibInternal.h"
 
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
+
 #pragma pack(1)
 
 typedef struct {
@@ -24,28 +26,30 @@ typedef struct {
 #pragma pack()
 
 /**
-  This function sends PSK_FINISH and receives PSK_FINISH_RSP for SPDM PSK finish.
+  This function builds PSK_FINISH, and appends it to the session transcript with the HMAC.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    SessionId to the PSK_FINISH request.
+  @param  RequestSize                  On input, the size in bytes of the request buffer.
+                                       On output, the size in bytes of the PSK_FINISH request.
+  @param  Request                      A pointer to a destination buffer to store the PSK_FINISH request.
 
-  @retval RETURN_SUCCESS               The PSK_FINISH is sent and the PSK_FINISH_RSP is received.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SUCCESS               The PSK_FINISH request is built.
+  @retval RETURN_BUFFER_TOO_SMALL      The request buffer is too small.
+  @retval RETURN_UNSUPPORTED           The session state or the capabilities do not allow PSK_FINISH.
 **/
 RETURN_STATUS
-TrySpdmSendReceivePskFinish (
+SpdmBuildPskFinishRequest (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
-  IN     UINT32               SessionId
+  IN     UINT32               SessionId,
+  IN OUT UINTN                *RequestSize,
+     OUT VOID                 *Request
   )
 {
   RETURN_STATUS                             Status;
-  SPDM_PSK_FINISH_REQUEST_MINE              SpdmRequest;
-  UINTN                                     SpdmRequestSize;
+  SPDM_PSK_FINISH_REQUEST_MINE              *SpdmRequest;
   UINTN                                     HmacSize;
-  SPDM_PSK_FINISH_RESPONSE_MINE             SpdmResponse;
-  UINTN                                     SpdmResponseSize;
   SPDM_SESSION_INFO                         *SessionInfo;
-  UINT8                                     TH2HashData[64];
   SPDM_SESSION_STATE                        SessionState;
 
   if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_PSK_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP)) {
@@ -65,55 +69,93 @@ TrySpdmSendReceivePskFinish (
     return RETURN_UNSUPPORTED;
   }
 
+  if (*RequestSize < sizeof(SPDM_PSK_FINISH_REQUEST_MINE)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  SpdmRequest = Request;
+
   SpdmContext->ErrorState = SPDM_STATUS_ERROR_DEVICE_NO_CAPABILITIES;
    
-  SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
-  SpdmRequest.Header.RequestResponseCode = SPDM_PSK_FINISH;
-  SpdmRequest.Header.Param1 = 0;
-  SpdmRequest.Header.Param2 = 0;
+  SpdmRequest->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmRequest->Header.RequestResponseCode = SPDM_PSK_FINISH;
+  SpdmRequest->Header.Param1 = 0;
+  SpdmRequest->Header.Param2 = 0;
   
   HmacSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
-  SpdmRequestSize = sizeof(SPDM_FINISH_REQUEST) + HmacSize;
+  *RequestSize = sizeof(SPDM_FINISH_REQUEST) + HmacSize;
   
-  Status = SpdmAppendMessageF (SessionInfo, (UINT8 *)&SpdmRequest, SpdmRequestSize - HmacSize);
+  Status = SpdmAppendMessageF (SessionInfo, (UINT8 *)SpdmRequest, *RequestSize - HmacSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
-  SpdmGeneratePskFinishReqHmac (SpdmContext, SessionInfo, SpdmRequest.VerifyData);
+  SpdmGeneratePskFinishReqHmac (SpdmContext, SessionInfo, SpdmRequest->VerifyData);
 
-  Status = SpdmAppendMessageF (SessionInfo, (UINT8 *)&SpdmRequest + SpdmRequestSize - HmacSize, HmacSize);
+  Status = SpdmAppendMessageF (SessionInfo, (UINT8 *)SpdmRequest + *RequestSize - HmacSize, HmacSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
 
-  Status = SpdmSendSpdmRequest (SpdmContext, &SessionId, SpdmRequestSize, &SpdmRequest);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
-  }
+  return RETURN_SUCCESS;
+}
 
-  SpdmResponseSize = sizeof(SpdmResponse);
-  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
-  Status = SpdmReceiveSpdmResponse (SpdmContext, &SessionId, &SpdmResponseSize, &SpdmResponse);
-  if (RETURN_ERROR(Status)) {
-    return RETURN_DEVICE_ERROR;
+/**
+  This function processes PSK_FINISH_RSP, and generates the session data key.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    SessionId to the PSK_FINISH request.
+  @param  RequestSize                  Size in bytes of the sent PSK_FINISH request.
+  @param  Request                      A pointer to the sent PSK_FINISH request.
+  @param  ResponseSize                 Size in bytes of the received response.
+  @param  Response                     A pointer to the received response.
+                                       It may be overwritten by the response to RESPOND_IF_READY.
+
+  @retval RETURN_SUCCESS               The PSK_FINISH_RSP is received.
+  @retval RETURN_NO_RESPONSE           The responder is busy.
+  @retval RETURN_DEVICE_ERROR          The response is not a valid PSK_FINISH_RSP.
+  @retval RETURN_SECURITY_VIOLATION    The session data key cannot be generated.
+**/
+RETURN_STATUS
+SpdmProcessPskFinishResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_PSK_FINISH_RESPONSE_MINE             *SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+  SPDM_SESSION_INFO                         *SessionInfo;
+  UINT8                                     TH2HashData[64];
+
+  SpdmResponse = Response;
+  SpdmResponseSize = ResponseSize;
+
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  if (SessionInfo == NULL) {
+    ASSERT (FALSE);
+    return RETURN_UNSUPPORTED;
   }
+
   if (SpdmResponseSize < sizeof(SPDM_MESSAGE_HEADER)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse.Header.RequestResponseCode == SPDM_ERROR) {
-    Status = SpdmHandleErrorResponseMain(SpdmContext, &SessionId, &SessionInfo->SessionTranscript.MessageF, SpdmRequestSize, &SpdmResponseSize, &SpdmResponse, SPDM_PSK_FINISH, SPDM_PSK_FINISH_RSP, sizeof(SPDM_PSK_FINISH_RESPONSE_MINE));
+  if (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) {
+    Status = SpdmHandleErrorResponseMain(SpdmContext, &SessionId, &SessionInfo->SessionTranscript.MessageF, RequestSize, &SpdmResponseSize, SpdmResponse, SPDM_PSK_FINISH, SPDM_PSK_FINISH_RSP, sizeof(SPDM_PSK_FINISH_RESPONSE_MINE));
     if (RETURN_ERROR(Status)) {
       return Status;
     }
-  } else if (SpdmResponse.Header.RequestResponseCode != SPDM_PSK_FINISH_RSP) {
+  } else if (SpdmResponse->Header.RequestResponseCode != SPDM_PSK_FINISH_RSP) {
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponseSize != sizeof(SPDM_PSK_FINISH_RESPONSE)) {
     return RETURN_DEVICE_ERROR;
   }
   
-  Status = SpdmAppendMessageF (SessionInfo, &SpdmResponse, SpdmResponseSize);
+  Status = SpdmAppendMessageF (SessionInfo, SpdmResponse, SpdmResponseSize);
   if (RETURN_ERROR(Status)) {
     return RETURN_SECURITY_VIOLATION;
   }
@@ -134,6 +176,47 @@ TrySpdmSendReceivePskFinish (
   return RETURN_SUCCESS;
 }
 
+/**
+  This function sends PSK_FINISH and receives PSK_FINISH_RSP for SPDM PSK finish.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    SessionId to the PSK_FINISH request.
+
+  @retval RETURN_SUCCESS               The PSK_FINISH is sent and the PSK_FINISH_RSP is received.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+**/
+RETURN_STATUS
+TrySpdmSendReceivePskFinish (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_PSK_FINISH_REQUEST_MINE              SpdmRequest;
+  UINTN                                     SpdmRequestSize;
+  SPDM_PSK_FINISH_RESPONSE_MINE             SpdmResponse;
+  UINTN                                     SpdmResponseSize;
+
+  SPDM_CRYPTO_STATS_BIND (SpdmContext);
+  SpdmRequestSize = sizeof(SpdmRequest);
+  Status = SpdmBuildPskFinishRequest (SpdmContext, SessionId, &SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  Status = SpdmSendSpdmRequest (SpdmContext, &SessionId, SpdmRequestSize, &SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  SpdmResponseSize = sizeof(SpdmResponse);
+  ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+  Status = SpdmReceiveSpdmResponse (SpdmContext, &SessionId, &SpdmResponseSize, &SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return SpdmProcessPskFinishResponse (SpdmContext, SessionId, SpdmRequestSize, &SpdmRequest, SpdmResponseSize, &SpdmResponse);
+}
+
 RETURN_STATUS
 SpdmSendReceivePskFinish (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
@@ -154,3 +237,4 @@ SpdmSendReceivePskFinish (
   return Status;
 }
 
+#endif
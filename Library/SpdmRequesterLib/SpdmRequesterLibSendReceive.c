@@ -9,9 +9,75 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmRequesterLibInternal.h"
 
+/**
+  Encode an SPDM or an APP request to a transport layer message, with the transport layer of the path SendTransportPath.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    Indicate if the request is a secured message.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  RequestSize                  Size in bytes of the request data buffer.
+  @param  Request                      A pointer to a source buffer to store the request.
+  @param  MessageSize                  Size in bytes of the transport layer message buffer.
+                                       On input, it means the size in bytes of message buffer.
+                                       On output, it means the size in bytes of the transport layer message.
+  @param  Message                      A pointer to a destination buffer to store the transport layer message.
+
+  @retval RETURN_SUCCESS               The SPDM request is encoded successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM request is encoded.
+**/
+RETURN_STATUS
+SpdmEncodeRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  )
+{
+  RETURN_STATUS                      Status;
+  SPDM_TRANSPORT_PATH_SLOT           *Path;
+  UINTN                              Headroom;
+  UINTN                              Tailroom;
+
+  Path = &SpdmContext->TransportPath[SpdmContext->SendTransportPath];
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_WIRE)) {
+    DEBUG((DEBUG_INFO, "SpdmSendSpdmRequest[%x] (0x%x): \n", (SessionId != NULL) ? *SessionId : 0x0, RequestSize));
+    InternalDumpHex (Request, RequestSize);
+  }
+
+  //
+  // Copy the request to the headroom of the transport message once, and let the transport layer encode it in place.
+  // A request already at the headroom is encoded in place without the copy.
+  //
+  if ((Path->TransportGetMessageRoom != NULL) &&
+      !RETURN_ERROR(Path->TransportGetMessageRoom (SpdmContext, SessionId, IsAppMessage, &Headroom, &Tailroom)) &&
+      (Headroom + RequestSize + Tailroom <= *MessageSize)) {
+    if ((UINT8 *)Request != (UINT8 *)Message + Headroom) {
+      CopyMem ((UINT8 *)Message + Headroom, Request, RequestSize);
+      Request = (UINT8 *)Message + Headroom;
+    }
+  }
+
+  Status = Path->TransportEncodeMessage (SpdmContext, SessionId, IsAppMessage, TRUE, RequestSize, Request, MessageSize, Message);
+  if (RETURN_ERROR(Status)) {
+    DEBUG((DEBUG_INFO, "TransportEncodeMessage Status - %p\n", Status));
+  } else {
+    SPDM_TRACEPOINT_CODEC (encode, (SessionId != NULL) ? *SessionId : INVALID_SESSION_ID, RequestSize, *MessageSize);
+  }
+  return Status;
+}
+
 /**
   Send an SPDM or an APP request to a device.
 
+  A request of an established session is sent over the transport path selected by its size,
+  and the response is received over the same path.
+  Only the send path of the SPDM context is changed, so SpdmReceiveResponse may run on another thread.
+
   @param  SpdmContext                  The SPDM context for the device.
   @param  SessionId                    Indicate if the request is a secured message.
                                        If SessionId is NULL, it is a normal message.
@@ -24,6 +90,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
   @retval RETURN_SUCCESS               The SPDM request is sent successfully.
   @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM request is sent to the device.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
 **/
 RETURN_STATUS
 EFIAPI
@@ -37,76 +104,96 @@ SpdmSendRequest (
 {
   SPDM_DEVICE_CONTEXT                *SpdmContext;
   RETURN_STATUS                      Status;
-  UINT8                              Message[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                              *Message;
   UINTN                              MessageSize;
+  UINT64                             SendTime;
+  SPDM_SESSION_INFO                  *SessionInfo;
+  UINT8                              PathIndex;
 
   SpdmContext = Context;
+  SPDM_CRYPTO_STATS_BIND (SpdmContext);
 
-  DEBUG((DEBUG_INFO, "SpdmSendSpdmRequest[%x] (0x%x): \n", (SessionId != NULL) ? *SessionId : 0x0, RequestSize));
-  InternalDumpHex (Request, RequestSize);
+  //
+  // The response time of an APP message is not defined by SPDM.
+  //
+  if (IsAppMessage) {
+    SpdmContext->ResponseTimeout = 0;
+  } else {
+    SpdmContext->ResponseTimeout = SpdmGetResponseTimeout (SpdmContext, RequestSize, Request);
+  }
 
-  MessageSize = sizeof(Message);
-  Status = SpdmContext->TransportEncodeMessage (SpdmContext, SessionId, IsAppMessage, TRUE, RequestSize, Request, &MessageSize, Message);
+  Message = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (Message == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  PathIndex = SpdmSelectTransportPath (SpdmContext, SessionId, RequestSize);
+  if (SessionId != NULL) {
+    SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, *SessionId);
+    if (SessionInfo != NULL) {
+      SessionInfo->RequestTransportPath = PathIndex;
+    }
+  }
+  SpdmContext->SendTransportPath = PathIndex;
+  MessageSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  Status = SpdmEncodeRequest (SpdmContext, SessionId, IsAppMessage, RequestSize, Request, &MessageSize, Message);
   if (RETURN_ERROR(Status)) {
-    DEBUG((DEBUG_INFO, "TransportEncodeMessage Status - %p\n", Status));
+    SpdmContext->SendTransportPath = 0;
+    SpdmReleaseScratch (SpdmContext, Message);
     return Status;
   }
 
-  Status = SpdmContext->SendMessage (SpdmContext, MessageSize, Message, 0);
+  SendTime = SpdmRequesterGetTime (SpdmContext);
+  Status = SpdmDeviceSendMessage (SpdmContext, MessageSize, Message, 0);
+  SpdmContext->SendTransportPath = 0;
+  SpdmReleaseScratch (SpdmContext, Message);
   if (RETURN_ERROR(Status)) {
     DEBUG((DEBUG_INFO, "SpdmSendSpdmRequest[%x] Status - %p\n", (SessionId != NULL) ? *SessionId : 0x0, Status));
+  } else if (SessionId != NULL) {
+    SpdmCountKeyUpdateBudget (SpdmContext, *SessionId, TRUE, RequestSize);
+  }
+  if (!IsAppMessage) {
+    SpdmRequesterRecordRequest (SpdmContext, SessionId, SendTime, Status, RequestSize, Request);
   }
 
   return Status;
 }
 
 /**
-  Receive an SPDM or an APP response from a device.
-  
+  Decode an SPDM or an APP response from a transport layer message, with the transport layer of the path ReceiveTransportPath.
+
   @param  SpdmContext                  The SPDM context for the device.
   @param  SessionId                    Indicate if the response is a secured message.
                                        If SessionId is NULL, it is a normal message.
                                        If SessionId is NOT NULL, it is a secured message.
   @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  MessageSize                  Size in bytes of the transport layer message.
+  @param  Message                      A pointer to a source buffer to store the transport layer message.
   @param  ResponseSize                 Size in bytes of the response data buffer.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of the response.
   @param  Response                     A pointer to a destination buffer to store the response.
-                                       The caller is responsible for having
-                                       either implicit or explicit ownership of the buffer.
 
-  @retval RETURN_SUCCESS               The SPDM response is received successfully.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM response is received from the device.
+  @retval RETURN_SUCCESS               The SPDM response is decoded successfully.
+  @retval RETURN_DEVICE_ERROR          The transport layer message is not the expected response.
 **/
 RETURN_STATUS
-EFIAPI
-SpdmReceiveResponse (
-  IN     VOID                 *Context,
+SpdmDecodeResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
   IN     UINT32               *SessionId,
   IN     BOOLEAN              IsAppMessage,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
   IN OUT UINTN                *ResponseSize,
      OUT VOID                 *Response
   )
 {
-  SPDM_DEVICE_CONTEXT       *SpdmContext;
   RETURN_STATUS             Status;
-  UINT8                     Message[MAX_SPDM_MESSAGE_BUFFER_SIZE];
-  UINTN                     MessageSize;
   UINT32                    *MessageSessionId;
   BOOLEAN                   IsMessageAppMessage;
 
-  SpdmContext = Context;
-
-  ASSERT (*ResponseSize <= MAX_SPDM_MESSAGE_BUFFER_SIZE);
-
-  MessageSize = sizeof(Message);
-  Status = SpdmContext->ReceiveMessage (SpdmContext, &MessageSize, Message, 0);
-  if (RETURN_ERROR(Status)) {
-    DEBUG((DEBUG_INFO, "SpdmReceiveSpdmResponse[%x] Status - %p\n", (SessionId != NULL) ? *SessionId : 0x0, Status));
-    return Status;
-  }
-
   MessageSessionId = NULL;
   IsMessageAppMessage = FALSE;
-  Status = SpdmContext->TransportDecodeMessage (SpdmContext, &MessageSessionId, &IsMessageAppMessage, FALSE, MessageSize, Message, ResponseSize, Response);
+  Status = SpdmContext->TransportPath[SpdmContext->ReceiveTransportPath].TransportDecodeMessage (SpdmContext, &MessageSessionId, &IsMessageAppMessage, FALSE, MessageSize, Message, ResponseSize, Response);
 
   if (SessionId != NULL) {
     if (MessageSessionId == NULL) {
@@ -134,56 +221,403 @@ SpdmReceiveResponse (
   if (RETURN_ERROR(Status)) {
     DEBUG((DEBUG_INFO, "SpdmReceiveSpdmResponse[%x] Status - %p\n", (SessionId != NULL) ? *SessionId : 0x0, Status));    
   } else {
-    InternalDumpHex (Response, *ResponseSize);
+    SPDM_TRACEPOINT_CODEC (decode, (SessionId != NULL) ? *SessionId : INVALID_SESSION_ID, *ResponseSize, MessageSize);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_WIRE)) {
+      InternalDumpHex (Response, *ResponseSize);
+    }
+    if (SessionId != NULL) {
+      SpdmCountKeyUpdateBudget (SpdmContext, *SessionId, FALSE, *ResponseSize);
+      SpdmRefreshHeartbeat (SpdmContext, *SessionId);
+    }
   }
   return Status;
 }
 
 /**
-  Send an SPDM request to a device.
+  Receive an SPDM or an APP response from a device.
+
+  The response of a session is received over the transport path its last request is sent over.
+  Only the receive path of the SPDM context is changed, so SpdmSendRequest may run on another thread.
 
   @param  SpdmContext                  The SPDM context for the device.
-  @param  SessionId                    Indicate if the request is a secured message.
+  @param  SessionId                    Indicate if the response is a secured message.
                                        If SessionId is NULL, it is a normal message.
                                        If SessionId is NOT NULL, it is a secured message.
-  @param  RequestSize                  Size in bytes of the request data buffer.
-  @param  Request                      A pointer to a destination buffer to store the request.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  ResponseSize                 Size in bytes of the response data buffer.
+  @param  Response                     A pointer to a destination buffer to store the response.
                                        The caller is responsible for having
                                        either implicit or explicit ownership of the buffer.
 
-  @retval RETURN_SUCCESS               The SPDM request is sent successfully.
-  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM request is sent to the device.
+  @retval RETURN_SUCCESS               The SPDM response is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM response is received from the device.
+  @retval RETURN_TIMEOUT               The SPDM response is not received within the response time of the request.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
 **/
 RETURN_STATUS
-SpdmSendSpdmRequest (
+EFIAPI
+SpdmReceiveResponse (
+  IN     VOID                 *Context,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+  RETURN_STATUS             Status;
+  UINT8                     *Message;
+  UINTN                     MessageSize;
+  UINT64                    ReceiveTime;
+  SPDM_SESSION_INFO         *SessionInfo;
+
+  SpdmContext = Context;
+  SPDM_CRYPTO_STATS_BIND (SpdmContext);
+
+  ASSERT (*ResponseSize <= MAX_SPDM_MESSAGE_BUFFER_SIZE);
+
+  Message = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (Message == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  if (SessionId != NULL) {
+    SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, *SessionId);
+    if ((SessionInfo != NULL) && (SessionInfo->RequestTransportPath <= SpdmContext->TransportPathCount)) {
+      SpdmContext->ReceiveTransportPath = SessionInfo->RequestTransportPath;
+    }
+  }
+  MessageSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  Status = SpdmDeviceReceiveMessage (SpdmContext, &MessageSize, Message, SpdmContext->ResponseTimeout);
+  ReceiveTime = SpdmRequesterGetTime (SpdmContext);
+  if (RETURN_ERROR(Status)) {
+    DEBUG((DEBUG_INFO, "SpdmReceiveSpdmResponse[%x] Status - %p\n", (SessionId != NULL) ? *SessionId : 0x0, Status));
+  } else {
+    Status = SpdmDecodeResponse (SpdmContext, SessionId, IsAppMessage, MessageSize, Message, ResponseSize, Response);
+  }
+  SpdmContext->ReceiveTransportPath = 0;
+  SpdmReleaseScratch (SpdmContext, Message);
+  if (!IsAppMessage) {
+    SpdmRequesterRecordResponse (SpdmContext, SessionId, ReceiveTime, Status, *ResponseSize, Response);
+  }
+
+  return Status;
+}
+
+/**
+  Send an APP message of a session in chained records, encoded in place in the request buffer.
+
+  Each record is encoded at the offset of its APP message data in the request buffer.
+  Its header overwrites the records already sent, and the data after it that its tail overwrites is restored
+  once it is sent.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  Headroom                     Size in bytes of the room before the APP message.
+  @param  Tailroom                     Size in bytes of the room after the APP message.
+  @param  RecordSize                   Size in bytes of the APP message in each full record.
+  @param  Request                      A pointer to the request buffer, with the request at Headroom bytes.
+  @param  RequestSize                  Size in bytes of the request.
+
+  @retval RETURN_SUCCESS               The APP message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the APP message is sent to the device.
+**/
+RETURN_STATUS
+SpdmSendDataStream (
   IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
   IN     UINT32               *SessionId,
-  IN     UINTN                RequestSize,
-  IN     VOID                 *Request
+  IN     UINTN                Headroom,
+  IN     UINTN                Tailroom,
+  IN     UINTN                RecordSize,
+  IN OUT UINT8                *Request,
+  IN     UINTN                RequestSize
+  )
+{
+  RETURN_STATUS                      Status;
+  UINT8                              TailData[MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                              Offset;
+  UINTN                              DataSize;
+  UINT8                              *Message;
+  UINTN                              MessageSize;
+
+  ASSERT (Tailroom <= sizeof(TailData));
+
+  SpdmContext->ResponseTimeout = 0;
+  Offset = 0;
+  do {
+    DataSize = MIN (RecordSize, RequestSize - Offset);
+    Message = Request + Offset;
+    CopyMem (TailData, Message + Headroom + DataSize, Tailroom);
+
+    MessageSize = Headroom + DataSize + Tailroom;
+    Status = SpdmEncodeRequest (SpdmContext, SessionId, TRUE, DataSize, Message + Headroom, &MessageSize, Message);
+    if (!RETURN_ERROR(Status)) {
+      Status = SpdmDeviceSendMessage (SpdmContext, MessageSize, Message, 0);
+    }
+    if (RETURN_ERROR(Status)) {
+      DEBUG((DEBUG_INFO, "SpdmSendDataStream[%x] Status - %p\n", *SessionId, Status));
+      return RETURN_DEVICE_ERROR;
+    }
+    SpdmCountKeyUpdateBudget (SpdmContext, *SessionId, TRUE, DataSize);
+
+    CopyMem (Message + Headroom + DataSize, TailData, Tailroom);
+    Offset += DataSize;
+  } while (DataSize == RecordSize);
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Receive an APP message of a session in chained records, decoded in place in the response buffer.
+
+  Each record is received at the offset of its APP message data in the response buffer.
+  The data received before it that its header overwrites is restored once it is decoded.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  Headroom                     Size in bytes of the room before the APP message.
+  @param  RecordSize                   Size in bytes of the APP message in each full record.
+  @param  Response                     A pointer to the response buffer.
+                                       On output, the response is at Headroom bytes.
+  @param  ResponseSize                 On input, it means the size in bytes of the response buffer.
+                                       On output, it means the size in bytes of the response.
+
+  @retval RETURN_SUCCESS               The APP message is received successfully.
+  @retval RETURN_BUFFER_TOO_SMALL      The response buffer is too small to hold the response.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the APP message is received from the device.
+**/
+RETURN_STATUS
+SpdmReceiveDataStream (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINTN                Headroom,
+  IN     UINTN                RecordSize,
+     OUT UINT8                *Response,
+  IN OUT UINTN                *ResponseSize
+  )
+{
+  RETURN_STATUS                      Status;
+  UINT8                              HeadData[MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                              HeadDataSize;
+  UINTN                              Offset;
+  UINTN                              DataSize;
+  UINT8                              *Message;
+  UINTN                              MessageSize;
+
+  ASSERT (Headroom <= sizeof(HeadData));
+
+  Offset = 0;
+  do {
+    if (*ResponseSize - Offset <= Headroom) {
+      return RETURN_BUFFER_TOO_SMALL;
+    }
+    Message = Response + Offset;
+    HeadDataSize = MIN (Offset, Headroom);
+    CopyMem (HeadData, Message + Headroom - HeadDataSize, HeadDataSize);
+
+    MessageSize = *ResponseSize - Offset;
+    Status = SpdmDeviceReceiveMessage (SpdmContext, &MessageSize, Message, 0);
+    if (!RETURN_ERROR(Status)) {
+      DataSize = *ResponseSize - Offset - Headroom;
+      Status = SpdmDecodeResponse (SpdmContext, SessionId, TRUE, MessageSize, Message, &DataSize, Message + Headroom);
+    }
+    if (RETURN_ERROR(Status)) {
+      DEBUG((DEBUG_INFO, "SpdmReceiveDataStream[%x] Status - %p\n", *SessionId, Status));
+      return RETURN_DEVICE_ERROR;
+    }
+
+    CopyMem (Message + Headroom - HeadDataSize, HeadData, HeadDataSize);
+    Offset += DataSize;
+  } while (DataSize >= RecordSize);
+
+  *ResponseSize = Offset;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return the session ID to protect an SPDM message of a session with.
+
+  The handshake messages of a KEY_EXCHANGE session are sent in the clear,
+  if HANDSHAKE_IN_THE_CLEAR_CAP is negotiated.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    On input, the session ID of the SPDM message, or NULL for a normal message.
+                                       On output, the session ID to protect the SPDM message with,
+                                       or NULL if the SPDM message is sent in the clear.
+
+  @retval RETURN_SUCCESS               The session ID is returned.
+  @retval RETURN_DEVICE_ERROR          The session ID is not found.
+**/
+RETURN_STATUS
+SpdmGetSpdmMessageSessionId (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINT32               **SessionId
   )
 {
   SPDM_SESSION_INFO                         *SessionInfo;
   SPDM_SESSION_STATE                        SessionState;
 
-  if ((SessionId != NULL) &&
+  if ((*SessionId != NULL) &&
       SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP)) {
-    SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, *SessionId);
+    SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, **SessionId);
     ASSERT (SessionInfo != NULL);
     if (SessionInfo == NULL) {
       return RETURN_DEVICE_ERROR;
     }
     SessionState = SpdmSecuredMessageGetSessionState (SessionInfo->SecuredMessageContext);
     if ((SessionState == SpdmSessionStateHandshaking) && !SessionInfo->UsePsk) {
-      SessionId = NULL;
+      *SessionId = NULL;
     }
   }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Send an SPDM request to a device.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    Indicate if the request is a secured message.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  RequestSize                  Size in bytes of the request data buffer.
+  @param  Request                      A pointer to a destination buffer to store the request.
+                                       The caller is responsible for having
+                                       either implicit or explicit ownership of the buffer.
+
+  @retval RETURN_SUCCESS               The SPDM request is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM request is sent to the device.
+**/
+RETURN_STATUS
+SpdmSendSpdmRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request
+  )
+{
+  RETURN_STATUS                             Status;
+
+  Status = SpdmGetSpdmMessageSessionId (SpdmContext, &SessionId);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
 
+  SPDM_ALLOCATION_TAG (SPDM_TRACEPOINT_MESSAGE_CODE (Request, RequestSize), SPDM_ALLOCATION_PHASE_REQUESTER);
+  SPDM_TRACEPOINT_MESSAGE (
+    request_send,
+    (SessionId != NULL) ? *SessionId : INVALID_SESSION_ID,
+    SPDM_TRACEPOINT_MESSAGE_CODE (Request, RequestSize),
+    RequestSize
+    );
   return SpdmSendRequest (SpdmContext, SessionId, FALSE, RequestSize, Request);
 }
 
+/**
+  Retrieve a large response in chunks by CHUNK_GET, after ERROR(LargeResponse).
+
+  The chunks are received in a buffer from the scratch arena, and reassembled in the response buffer.
+
+  @param  SpdmContext                  The SPDM context for the device.
+  @param  SessionId                    The session ID to protect the CHUNK_GET with, or NULL for a normal message.
+  @param  Handle                       The handle of the large response.
+  @param  MaxResponseSize              Size in bytes of the response data buffer.
+  @param  ResponseSize                 Size in bytes of the large response.
+  @param  Response                     A pointer to a destination buffer to store the large response.
+
+  @retval RETURN_SUCCESS               The large response is retrieved successfully.
+  @retval RETURN_DEVICE_ERROR          A chunk does not follow the previous chunks, or the large response does not fit in the buffer.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
+  @retval others                       A CHUNK_GET cannot be sent, or a CHUNK_RESPONSE cannot be received.
+**/
+RETURN_STATUS
+SpdmReceiveLargeResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT8                Handle,
+  IN     UINTN                MaxResponseSize,
+     OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_CHUNK_GET_REQUEST                    SpdmRequest;
+  SPDM_CHUNK_RESPONSE_RESPONSE              *ChunkResponse;
+  UINT8                                     *ChunkBuffer;
+  UINTN                                     ChunkResponseSize;
+  UINTN                                     HeaderSize;
+  UINT32                                    LargeMessageSize;
+  UINT32                                    Offset;
+  UINT16                                    ChunkSeqNo;
+
+  ChunkBuffer = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (ChunkBuffer == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  LargeMessageSize = 0;
+  Offset = 0;
+  ChunkSeqNo = 0;
+  while (TRUE) {
+    SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+    SpdmRequest.Header.RequestResponseCode = SPDM_CHUNK_GET;
+    SpdmRequest.Header.Param1 = 0;
+    SpdmRequest.Header.Param2 = Handle;
+    SpdmRequest.ChunkSeqNo = ChunkSeqNo;
+    Status = SpdmSendRequest (SpdmContext, SessionId, FALSE, sizeof(SpdmRequest), &SpdmRequest);
+    if (RETURN_ERROR(Status)) {
+      break;
+    }
+    ChunkResponseSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    Status = SpdmReceiveResponse (SpdmContext, SessionId, FALSE, &ChunkResponseSize, ChunkBuffer);
+    if (RETURN_ERROR(Status)) {
+      break;
+    }
+
+    Status = RETURN_DEVICE_ERROR;
+    ChunkResponse = (VOID *)ChunkBuffer;
+    HeaderSize = sizeof(SPDM_CHUNK_RESPONSE_RESPONSE);
+    if (ChunkSeqNo == 0) {
+      HeaderSize += sizeof(UINT32);
+    }
+    if ((ChunkResponseSize < HeaderSize) ||
+        (ChunkResponse->Header.RequestResponseCode != SPDM_CHUNK_RESPONSE) ||
+        (ChunkResponse->Header.Param2 != Handle) ||
+        (ChunkResponse->ChunkSeqNo != ChunkSeqNo) ||
+        (ChunkResponse->ChunkSize == 0) ||
+        (ChunkResponse->ChunkSize > ChunkResponseSize - HeaderSize)) {
+      break;
+    }
+    if (ChunkSeqNo == 0) {
+      LargeMessageSize = *(UINT32 *)(ChunkResponse + 1);
+      if ((LargeMessageSize < sizeof(SPDM_MESSAGE_HEADER)) || (LargeMessageSize > MaxResponseSize)) {
+        break;
+      }
+    }
+    if (ChunkResponse->ChunkSize > LargeMessageSize - Offset) {
+      break;
+    }
+    CopyMem ((UINT8 *)Response + Offset, ChunkBuffer + HeaderSize, ChunkResponse->ChunkSize);
+    Offset += ChunkResponse->ChunkSize;
+
+    if ((ChunkResponse->Header.Param1 & SPDM_CHUNK_RESPONSE_ATTRIBUTE_LAST_CHUNK) != 0) {
+      if (Offset == LargeMessageSize) {
+        *ResponseSize = LargeMessageSize;
+        Status = RETURN_SUCCESS;
+      }
+      break;
+    }
+    ChunkSeqNo++;
+  }
+
+  SpdmReleaseScratch (SpdmContext, ChunkBuffer);
+  return Status;
+}
+
 /**
   Receive an SPDM response from a device.
 
+  A response larger than the transport maximum message size is retrieved in chunks,
+  if CHUNK_CAP is negotiated.
+
   @param  SpdmContext                  The SPDM context for the device.
   @param  SessionId                    Indicate if the response is a secured message.
                                        If SessionId is NULL, it is a normal message.
@@ -195,6 +629,7 @@ SpdmSendSpdmRequest (
 
   @retval RETURN_SUCCESS               The SPDM response is received successfully.
   @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM response is received from the device.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
 **/
 RETURN_STATUS
 SpdmReceiveSpdmResponse (
@@ -204,21 +639,44 @@ SpdmReceiveSpdmResponse (
      OUT VOID                 *Response
   )
 {
-  SPDM_SESSION_INFO                         *SessionInfo;
-  SPDM_SESSION_STATE                        SessionState;
+  RETURN_STATUS                             Status;
+  SPDM_MESSAGE_HEADER                       *SpdmResponse;
+  UINTN                                     MaxResponseSize;
 
-  if ((SessionId != NULL) &&
-      SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP)) {
-    SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, *SessionId);
-    ASSERT (SessionInfo != NULL);
-    if (SessionInfo == NULL) {
-      return RETURN_DEVICE_ERROR;
-    }
-    SessionState = SpdmSecuredMessageGetSessionState (SessionInfo->SecuredMessageContext);
-    if ((SessionState == SpdmSessionStateHandshaking) && !SessionInfo->UsePsk) {
-      SessionId = NULL;
+  Status = SpdmGetSpdmMessageSessionId (SpdmContext, &SessionId);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  MaxResponseSize = *ResponseSize;
+  Status = SpdmReceiveResponse (SpdmContext, SessionId, FALSE, ResponseSize, Response);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  SpdmResponse = Response;
+  if ((*ResponseSize >= sizeof(SPDM_ERROR_RESPONSE_DATA_LARGE_RESPONSE)) &&
+      (SpdmResponse->RequestResponseCode == SPDM_ERROR) &&
+      (SpdmResponse->Param1 == SPDM_ERROR_CODE_LARGE_RESPONSE) &&
+      SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CHUNK_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHUNK_CAP)) {
+    Status = SpdmReceiveLargeResponse (SpdmContext, SessionId, ((SPDM_ERROR_RESPONSE_DATA_LARGE_RESPONSE *)Response)->ExtendErrorData.Handle, MaxResponseSize, ResponseSize, Response);
+    if (RETURN_ERROR(Status)) {
+      return Status;
     }
   }
 
-  return SpdmReceiveResponse (SpdmContext, SessionId, FALSE, ResponseSize, Response);
+  //
+  // The ERROR(BUSY) backoff restarts once the device answers.
+  //
+  if ((*ResponseSize >= sizeof(SPDM_MESSAGE_HEADER)) &&
+      ((SpdmResponse->RequestResponseCode != SPDM_ERROR) || (SpdmResponse->Param1 != SPDM_ERROR_CODE_BUSY))) {
+    SpdmContext->BusyCount = 0;
+  }
+  SPDM_TRACEPOINT_MESSAGE (
+    response_receive,
+    (SessionId != NULL) ? *SessionId : INVALID_SESSION_ID,
+    SPDM_TRACEPOINT_MESSAGE_CODE (Response, *ResponseSize),
+    *ResponseSize
+    );
+  return RETURN_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,364 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmRequesterLibInternal.h"
+
+/**
+  Return the number of sessions in the warm session pool, idle or in use.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the number of sessions in the pool.
+**/
+UINTN
+SpdmGetPooledSessionCount (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  UINTN                                     Index;
+  UINTN                                     Count;
+
+  Count = 0;
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SpdmContext->SessionInfo[Index].PoolState != SpdmSessionPoolStateNone) {
+      Count++;
+    }
+  }
+  return Count;
+}
+
+/**
+  Free a session of the warm session pool without END_SESSION, such as after its session is lost.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of the session.
+**/
+VOID
+SpdmDropPooledSession (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     SPDM_SESSION_INFO    *SessionInfo
+  )
+{
+  DEBUG ((DEBUG_INFO, "SpdmDropPooledSession[%x]\n", SessionInfo->SessionId));
+  SessionInfo->PoolState = SpdmSessionPoolStateNone;
+  SpdmFreeSessionId (SpdmContext, SessionInfo->SessionId);
+}
+
+/**
+  End a session with END_SESSION, and free it even if END_SESSION fails.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+
+  @return the status of END_SESSION.
+**/
+RETURN_STATUS
+SpdmEndPooledSession (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId
+  )
+{
+  RETURN_STATUS                             Status;
+
+  Status = SpdmStopSession (SpdmContext, SessionId, 0);
+  if (RETURN_ERROR(Status) && (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId) != NULL)) {
+    SpdmFreeSessionId (SpdmContext, SessionId);
+  }
+  return Status;
+}
+
+/**
+  Establish a session with the configuration of the warm session pool, and add it to the pool.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  PoolState                    The state of the session in the pool.
+  @param  SessionId                    Return the session ID of the session.
+
+  @retval RETURN_SUCCESS               The session is established.
+  @retval others                       The session cannot be established. It is freed.
+**/
+RETURN_STATUS
+SpdmStartPooledSession (
+  IN     SPDM_DEVICE_CONTEXT      *SpdmContext,
+  IN     SPDM_SESSION_POOL_STATE  PoolState,
+     OUT UINT32                   *SessionId
+  )
+{
+  RETURN_STATUS                             Status;
+  SPDM_SESSION_INFO                         *SessionInfo;
+  UINT8                                     HeartbeatPeriod;
+  UINT8                                     MeasurementHash[MAX_HASH_SIZE];
+
+  *SessionId = INVALID_SESSION_ID;
+  Status = SpdmStartSession (
+             SpdmContext,
+             SpdmContext->SessionPool.UsePsk,
+             SpdmContext->SessionPool.MeasurementHashType,
+             SpdmContext->SessionPool.SlotNum,
+             SessionId,
+             &HeartbeatPeriod,
+             MeasurementHash
+             );
+  if (*SessionId == INVALID_SESSION_ID) {
+    return RETURN_ERROR(Status) ? Status : RETURN_DEVICE_ERROR;
+  }
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, *SessionId);
+  if (RETURN_ERROR(Status)) {
+    //
+    // A session which fails after KEY_EXCHANGE or PSK_EXCHANGE is still assigned.
+    //
+    if (SessionInfo != NULL) {
+      SpdmFreeSessionId (SpdmContext, *SessionId);
+    }
+    DEBUG ((DEBUG_INFO, "SpdmStartPooledSession - %p\n", Status));
+    return Status;
+  }
+  if (SessionInfo == NULL) {
+    return RETURN_DEVICE_ERROR;
+  }
+  SessionInfo->PoolState = PoolState;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Configure the warm session pool of an SPDM context.
+
+  The pool keeps TargetCount sessions established ahead of time, so that SpdmAcquirePooledSession
+  hands out a session without the KEY_EXCHANGE/FINISH or PSK_EXCHANGE/PSK_FINISH latency.
+  The sessions are established and maintained by SpdmRunSessionPool.
+  A TargetCount of 0 disables the pool. The idle sessions beyond TargetCount are ended by SpdmRunSessionPool.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  TargetCount                  The number of sessions to keep established, up to the session count of the context.
+  @param  UsePsk                       FALSE means to use KEY_EXCHANGE/FINISH to start a session.
+                                       TRUE means to use PSK_EXCHANGE/PSK_FINISH to start a session.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  SlotNum                      The number of slot for the certificate chain.
+
+  @retval RETURN_SUCCESS               The pool is configured.
+  @retval RETURN_INVALID_PARAMETER     TargetCount is larger than the session count of the context.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmConfigureSessionPool (
+  IN     VOID                 *Context,
+  IN     UINTN                TargetCount,
+  IN     BOOLEAN              UsePsk,
+  IN     UINT8                MeasurementHashType,
+  IN     UINT8                SlotNum
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+
+  SpdmContext = Context;
+  if (TargetCount > SpdmContext->MaxSessionCount) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  SpdmContext->SessionPool.TargetCount = TargetCount;
+  SpdmContext->SessionPool.UsePsk = UsePsk;
+  SpdmContext->SessionPool.MeasurementHashType = MeasurementHashType;
+  SpdmContext->SessionPool.SlotNum = SlotNum;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Maintain the warm session pool of an SPDM context.
+
+  The idle sessions which are no longer established are dropped, and the keys of the idle sessions
+  are updated ahead of time by their key update policy. Then new sessions are established up to the target count,
+  and the due heartbeats are sent by SpdmRunHeartbeats. The idle sessions whose heartbeat failed are dropped,
+  to be established again on the next run.
+
+  The library does not run it in the background. The integrator calls it from an idle loop or a timer,
+  before NextWakeupTime. The functions of one SPDM context must not be called concurrently.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  NextWakeupTime               Return the earliest time a heartbeat must be sent, in 100ns units,
+                                       or 0 if no session has a heartbeat.
+                                       It is already passed if the heartbeat of a session failed.
+
+  @retval RETURN_SUCCESS               The pool has the target count of sessions.
+  @retval others                       The status of the first failure. The pool may have fewer sessions than
+                                       the target count, and the other sessions are still maintained.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRunSessionPool (
+  IN     VOID                 *Context,
+     OUT UINT64               *NextWakeupTime
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_SESSION_INFO                         *SessionInfo;
+  RETURN_STATUS                             Status;
+  RETURN_STATUS                             SessionStatus;
+  UINTN                                     PooledCount;
+  UINTN                                     Index;
+  UINT32                                    SessionId;
+  UINT64                                    Now;
+
+  SpdmContext = Context;
+  Status = RETURN_SUCCESS;
+  SessionInfo = SpdmContext->SessionInfo;
+
+  //
+  // The sessions in use are left to their callers. The idle sessions beyond the target count are ended.
+  //
+  PooledCount = 0;
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SessionInfo[Index].PoolState == SpdmSessionPoolStateInUse) {
+      PooledCount++;
+    }
+  }
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SessionInfo[Index].PoolState != SpdmSessionPoolStateIdle) {
+      continue;
+    }
+    if (SpdmSecuredMessageGetSessionState (SessionInfo[Index].SecuredMessageContext) != SpdmSessionStateEstablished) {
+      SpdmDropPooledSession (SpdmContext, &SessionInfo[Index]);
+      continue;
+    }
+    SessionId = SessionInfo[Index].SessionId;
+    if (PooledCount >= SpdmContext->SessionPool.TargetCount) {
+      SessionInfo[Index].PoolState = SpdmSessionPoolStateNone;
+      SpdmEndPooledSession (SpdmContext, SessionId);
+      continue;
+    }
+    SessionStatus = SpdmKeyUpdateIdleSessionByPolicy (SpdmContext, SessionId);
+    if (RETURN_ERROR(SessionStatus)) {
+      if (!RETURN_ERROR(Status)) {
+        Status = SessionStatus;
+      }
+      SpdmDropPooledSession (SpdmContext, &SessionInfo[Index]);
+      continue;
+    }
+    PooledCount++;
+  }
+
+  while (PooledCount < SpdmContext->SessionPool.TargetCount) {
+    SessionStatus = SpdmStartPooledSession (SpdmContext, SpdmSessionPoolStateIdle, &SessionId);
+    if (RETURN_ERROR(SessionStatus)) {
+      if (!RETURN_ERROR(Status)) {
+        Status = SessionStatus;
+      }
+      break;
+    }
+    PooledCount++;
+  }
+
+  SessionStatus = SpdmRunHeartbeats (SpdmContext, NextWakeupTime);
+  if (SessionStatus == RETURN_NOT_STARTED) {
+    return Status;
+  }
+  if (RETURN_ERROR(SessionStatus)) {
+    if (!RETURN_ERROR(Status)) {
+      Status = SessionStatus;
+    }
+    //
+    // A successful heartbeat postpones the next one, so an idle session still due has failed its heartbeat.
+    //
+    Now = SpdmRequesterGetTime (SpdmContext);
+    for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+      if ((SessionInfo[Index].PoolState == SpdmSessionPoolStateIdle) && SpdmIsHeartbeatDue (&SessionInfo[Index], Now)) {
+        SpdmDropPooledSession (SpdmContext, &SessionInfo[Index]);
+      }
+    }
+  }
+  return Status;
+}
+
+/**
+  Take an idle session of the warm session pool, for SpdmSendReceiveData.
+
+  If no session is idle, and the pool has fewer sessions than the target count,
+  a session is established on demand.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Return the session ID of the session.
+
+  @retval RETURN_SUCCESS               The session is taken. It must be returned by SpdmReleasePooledSession.
+  @retval RETURN_NOT_STARTED           The pool is not configured.
+  @retval RETURN_NOT_READY             All sessions of the pool are in use.
+  @retval others                       No session is idle, and a session cannot be established on demand.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmAcquirePooledSession (
+  IN     VOID                 *Context,
+     OUT UINT32               *SessionId
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_SESSION_INFO                         *SessionInfo;
+  UINTN                                     Index;
+
+  SpdmContext = Context;
+  if (SpdmContext->SessionPool.TargetCount == 0) {
+    return RETURN_NOT_STARTED;
+  }
+
+  SessionInfo = SpdmContext->SessionInfo;
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SessionInfo[Index].PoolState != SpdmSessionPoolStateIdle) {
+      continue;
+    }
+    if (SpdmSecuredMessageGetSessionState (SessionInfo[Index].SecuredMessageContext) != SpdmSessionStateEstablished) {
+      SpdmDropPooledSession (SpdmContext, &SessionInfo[Index]);
+      continue;
+    }
+    SessionInfo[Index].PoolState = SpdmSessionPoolStateInUse;
+    *SessionId = SessionInfo[Index].SessionId;
+    return RETURN_SUCCESS;
+  }
+
+  if (SpdmGetPooledSessionCount (SpdmContext) >= SpdmContext->SessionPool.TargetCount) {
+    return RETURN_NOT_READY;
+  }
+  return SpdmStartPooledSession (SpdmContext, SpdmSessionPoolStateInUse, SessionId);
+}
+
+/**
+  Return a session taken by SpdmAcquirePooledSession to the warm session pool.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the session.
+  @param  EndSession                   TRUE to end the session with END_SESSION, such as after a failure in the session.
+                                       SpdmRunSessionPool establishes a new session in its place.
+
+  @retval RETURN_SUCCESS               The session is returned to the pool, or ended.
+  @retval RETURN_NOT_FOUND             The session is not taken from the pool, or it is already ended.
+  @retval others                       END_SESSION fails. The session is freed anyway.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmReleasePooledSession (
+  IN     VOID                 *Context,
+  IN     UINT32               SessionId,
+  IN     BOOLEAN              EndSession
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_SESSION_INFO                         *SessionInfo;
+
+  SpdmContext = Context;
+  if (SessionId == INVALID_SESSION_ID) {
+    return RETURN_NOT_FOUND;
+  }
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  if ((SessionInfo == NULL) || (SessionInfo->PoolState != SpdmSessionPoolStateInUse)) {
+    return RETURN_NOT_FOUND;
+  }
+
+  if (!EndSession) {
+    SessionInfo->PoolState = SpdmSessionPoolStateIdle;
+    return RETURN_SUCCESS;
+  }
+  SessionInfo->PoolState = SpdmSessionPoolStateNone;
+  return SpdmEndPooledSession (SpdmContext, SessionId);
+}
@@ -0,0 +1,226 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmRequesterLibInternal.h"
+
+/**
+  Register the requester monitor functions.
+
+  Both functions are optional.
+  The time function enables the latencies of the requester statistics, if OPENSPDM_REQUESTER_STATS_SUPPORT is 1.
+  The monitor function is called for each SPDM request sent and each SPDM response received.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  GetTimeFunc                  The function to return the time, or NULL.
+  @param  MonitorFunc                  The function to notify the SPDM messages, or NULL.
+**/
+VOID
+EFIAPI
+SpdmRegisterRequesterMonitorFunc (
+  IN  VOID                          *Context,
+  IN  SPDM_REQUESTER_GET_TIME_FUNC  GetTimeFunc,
+  IN  SPDM_REQUESTER_MONITOR_FUNC   MonitorFunc
+  )
+{
+  SPDM_DEVICE_CONTEXT     *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->RequesterGetTimeFunc = (UINTN)GetTimeFunc;
+  SpdmContext->RequesterMonitorFunc = (UINTN)MonitorFunc;
+
+  return ;
+}
+
+/**
+  Return the time with the registered requester time function.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the time, in 100ns units, or 0 if no time function is registered.
+**/
+UINT64
+SpdmRequesterGetTime (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  if (SpdmContext->RequesterGetTimeFunc == 0) {
+    return 0;
+  }
+  return ((SPDM_REQUESTER_GET_TIME_FUNC)SpdmContext->RequesterGetTimeFunc) (SpdmContext);
+}
+
+#if OPENSPDM_REQUESTER_STATS_SUPPORT == 1
+
+/**
+  Return the statistics of an SPDM request code.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+
+  @return the statistics of the request code, or NULL if it is not a request code.
+**/
+SPDM_REQUESTER_REQUEST_STATS *
+SpdmGetRequesterRequestStats (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                RequestCode
+  )
+{
+  if (RequestCode < 0x80) {
+    return NULL;
+  }
+  return &SpdmContext->RequesterStats.Request[RequestCode - 0x80];
+}
+
+/**
+  Add a latency to a latency histogram.
+
+  @param  Latency                      The latency, in 100ns units.
+  @param  Histogram                    The latency histogram with SPDM_REQUESTER_STATS_LATENCY_BUCKET_COUNT buckets.
+**/
+VOID
+SpdmRecordRequesterLatency (
+  IN     UINT64               Latency,
+  IN OUT UINT32               *Histogram
+  )
+{
+  UINT64                    Value;
+  UINTN                     Index;
+
+  Value = Latency / 10;
+  for (Index = 0; (Index < SPDM_REQUESTER_STATS_LATENCY_BUCKET_COUNT - 1) && (Value >= 4); Index++) {
+    Value >>= 2;
+  }
+  Histogram[Index] ++;
+}
+
+#endif
+
+/**
+  Record an SPDM request sent in the requester statistics, and notify the requester monitor function.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of a secured message, or NULL for a normal message.
+  @param  SendTime                     The time the request is sent, from SpdmRequesterGetTime.
+  @param  Status                       The status of sending the request.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the request.
+**/
+VOID
+SpdmRequesterRecordRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT64               SendTime,
+  IN     RETURN_STATUS        Status,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request
+  )
+{
+#if OPENSPDM_REQUESTER_STATS_SUPPORT == 1
+  SPDM_REQUESTER_REQUEST_STATS              *Stats;
+  UINT64                                    LocalTime;
+  UINT8                                     RequestCode;
+
+  //
+  // The local time of the last request ends when this request is sent.
+  //
+  if (SpdmContext->StatsLocalTimePending) {
+    SpdmContext->StatsLocalTimePending = FALSE;
+    Stats = SpdmGetRequesterRequestStats (SpdmContext, SpdmContext->StatsRequestCode);
+    if ((Stats != NULL) && (SpdmContext->RequesterGetTimeFunc != 0) && (SendTime >= SpdmContext->StatsReceiveTime)) {
+      LocalTime = SendTime - SpdmContext->StatsReceiveTime;
+      Stats->LocalTime += LocalTime;
+      SpdmRecordRequesterLatency (LocalTime, Stats->LocalLatency);
+    }
+  }
+
+  RequestCode = 0;
+  if (RequestSize >= sizeof(SPDM_MESSAGE_HEADER)) {
+    RequestCode = ((SPDM_MESSAGE_HEADER *)Request)->RequestResponseCode;
+  }
+  SpdmContext->StatsRequestCode = RequestCode;
+  SpdmContext->StatsSendTime = SendTime;
+
+  Stats = SpdmGetRequesterRequestStats (SpdmContext, RequestCode);
+  if (Stats != NULL) {
+    Stats->RequestCount ++;
+    Stats->RequestBytes += RequestSize;
+    if (SpdmContext->StatsRetryRequestCode == RequestCode) {
+      Stats->RetryCount ++;
+    }
+    if (RETURN_ERROR(Status)) {
+      Stats->FailureCount ++;
+    }
+  }
+  SpdmContext->StatsRetryRequestCode = 0;
+#endif
+
+  if (SpdmContext->RequesterMonitorFunc != 0) {
+    ((SPDM_REQUESTER_MONITOR_FUNC)SpdmContext->RequesterMonitorFunc) (SpdmContext, SessionId, TRUE, Status, RequestSize, Request);
+  }
+}
+
+/**
+  Record an SPDM response received in the requester statistics, and notify the requester monitor function.
+
+  The response is accounted to the last request sent.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of a secured message, or NULL for a normal message.
+  @param  ReceiveTime                  The time the response is received, from SpdmRequesterGetTime.
+  @param  Status                       The status of receiving the response.
+  @param  ResponseSize                 Size in bytes of the response.
+  @param  Response                     A pointer to the response.
+**/
+VOID
+SpdmRequesterRecordResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT64               ReceiveTime,
+  IN     RETURN_STATUS        Status,
+  IN     UINTN                ResponseSize,
+  IN     VOID                 *Response
+  )
+{
+#if OPENSPDM_REQUESTER_STATS_SUPPORT == 1
+  SPDM_REQUESTER_REQUEST_STATS              *Stats;
+  SPDM_MESSAGE_HEADER                       *SpdmResponse;
+  UINT64                                    TransportTime;
+
+  Stats = SpdmGetRequesterRequestStats (SpdmContext, SpdmContext->StatsRequestCode);
+  if (Stats != NULL) {
+    if (RETURN_ERROR(Status)) {
+      Stats->FailureCount ++;
+    } else {
+      Stats->ResponseCount ++;
+      Stats->ResponseBytes += ResponseSize;
+
+      SpdmResponse = Response;
+      if ((ResponseSize >= sizeof(SPDM_MESSAGE_HEADER)) && (SpdmResponse->RequestResponseCode == SPDM_ERROR)) {
+        Stats->ErrorCount[SPDM_REQUESTER_STATS_ERROR_CODE_INDEX(SpdmResponse->Param1)] ++;
+        Stats->LastErrorCode = SpdmResponse->Param1;
+        if (SpdmResponse->Param1 == SPDM_ERROR_CODE_BUSY) {
+          SpdmContext->StatsRetryRequestCode = SpdmContext->StatsRequestCode;
+        }
+      }
+
+      if ((SpdmContext->RequesterGetTimeFunc != 0) && (ReceiveTime >= SpdmContext->StatsSendTime)) {
+        TransportTime = ReceiveTime - SpdmContext->StatsSendTime;
+        Stats->TransportTime += TransportTime;
+        SpdmRecordRequesterLatency (TransportTime, Stats->TransportLatency);
+      }
+      SpdmContext->StatsReceiveTime = ReceiveTime;
+      SpdmContext->StatsLocalTimePending = TRUE;
+    }
+  }
+#endif
+
+  if (SpdmContext->RequesterMonitorFunc != 0) {
+    ((SPDM_REQUESTER_MONITOR_FUNC)SpdmContext->RequesterMonitorFunc) (SpdmContext, SessionId, FALSE, Status, ResponseSize, Response);
+  }
+}
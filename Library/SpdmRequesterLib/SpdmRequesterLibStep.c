@@ -0,0 +1,852 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmRequesterLibInternal.h"
+
+/**
+  This function ends the operation driven by SpdmRequesterStep.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmRequesterStepReset (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_REQUESTER_STEP_CONTEXT               *Step;
+
+  Step = &SpdmContext->RequesterStep;
+  if (Step->DHEContext != NULL) {
+    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, Step->DHEContext);
+    Step->DHEContext = NULL;
+  }
+  Step->Stage = SpdmRequesterStepStageNone;
+  Step->RequestPending = FALSE;
+  Step->RespondIfReady = FALSE;
+}
+
+/**
+  This function checks if an operation can be started by SpdmRequesterStep.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval RETURN_SUCCESS               No operation is in progress.
+  @retval RETURN_ALREADY_STARTED       An operation is in progress.
+**/
+RETURN_STATUS
+SpdmRequesterStepCheckIdle (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  if (SpdmContext->RequesterStep.Stage != SpdmRequesterStepStageNone) {
+    return RETURN_ALREADY_STARTED;
+  }
+  SpdmContext->RequesterStep.RequestPending = FALSE;
+  SpdmContext->RequesterStep.RespondIfReady = FALSE;
+  SpdmContext->RequesterStep.DHEContext = NULL;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function builds the request of the current stage.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval RETURN_NOT_READY             The request is built, and it needs to be sent.
+  @retval others                       The request cannot be built.
+**/
+RETURN_STATUS
+SpdmRequesterStepBuild (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_REQUESTER_STEP_CONTEXT               *Step;
+  RETURN_STATUS                             Status;
+
+  Step = &SpdmContext->RequesterStep;
+  Step->RespondIfReady = FALSE;
+  Step->RequestSize = SpdmContext->MaxSpdmMessageSize;
+
+  switch (Step->Stage) {
+  case SpdmRequesterStepStageVersion:
+    Status = SpdmBuildGetVersionRequest (SpdmContext, &Step->RequestSize, Step->Request);
+    break;
+  case SpdmRequesterStepStageCapabilities:
+    Status = SpdmBuildGetCapabilitiesRequest (SpdmContext, &Step->RequestSize, Step->Request);
+    break;
+  case SpdmRequesterStepStageAlgorithms:
+    Status = SpdmBuildNegotiateAlgorithmsRequest (SpdmContext, &Step->RequestSize, Step->Request);
+    break;
+  case SpdmRequesterStepStageDigest:
+    Status = SpdmBuildGetDigestRequest (SpdmContext, &Step->RequestSize, Step->Request);
+    break;
+  case SpdmRequesterStepStageCertificate:
+    Status = SpdmBuildGetCertificateRequest (SpdmContext, Step->SlotNum, SpdmGetCertificateRequestLength (SpdmContext), &Step->RequestSize, Step->Request);
+    break;
+  case SpdmRequesterStepStageChallenge:
+    Status = SpdmBuildChallengeRequest (SpdmContext, Step->SlotNum, Step->MeasurementHashType, &Step->RequestSize, Step->Request);
+    break;
+  case SpdmRequesterStepStageKeyExchange:
+    Status = SpdmBuildKeyExchangeRequest (SpdmContext, Step->MeasurementHashType, Step->SlotNum, &Step->RequestSize, Step->Request, &Step->DHEContext);
+    break;
+  case SpdmRequesterStepStageFinish:
+    Status = SpdmBuildFinishRequest (SpdmContext, Step->SessionId, Step->ReqSlotIdParam, &Step->RequestSize, Step->Request);
+    break;
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
+  case SpdmRequesterStepStagePskExchange:
+    Status = SpdmBuildPskExchangeRequest (SpdmContext, Step->MeasurementHashType, &Step->RequestSize, Step->Request);
+    break;
+  case SpdmRequesterStepStagePskFinish:
+    Status = SpdmBuildPskFinishRequest (SpdmContext, Step->SessionId, &Step->RequestSize, Step->Request);
+    break;
+#endif
+  case SpdmRequesterStepStageSendReceiveData:
+    //
+    // The request is the APP or SPDM message of the caller.
+    //
+    Status = RETURN_SUCCESS;
+    break;
+  default:
+    ASSERT (FALSE);
+    Status = RETURN_UNSUPPORTED;
+    break;
+  }
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  return RETURN_NOT_READY;
+}
+
+/**
+  This function enters a stage, and builds its first request.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Stage                        The stage to enter.
+
+  @retval RETURN_NOT_READY             The request of the stage is built, and it needs to be sent.
+  @retval RETURN_SUCCESS               The operation completes without any message exchanged.
+  @retval others                       The operation fails.
+**/
+RETURN_STATUS
+SpdmRequesterStepEnterStage (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     SPDM_REQUESTER_STEP_STAGE  Stage
+  );
+
+/**
+  This function moves to the next stage once the current stage completes.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval RETURN_NOT_READY             The request of the next stage is built, and it needs to be sent.
+  @retval RETURN_SUCCESS               The operation completes.
+  @retval others                       The operation fails.
+**/
+RETURN_STATUS
+SpdmRequesterStepCompleteStage (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_REQUESTER_STEP_CONTEXT               *Step;
+  SPDM_SESSION_INFO                         *SessionInfo;
+
+  Step = &SpdmContext->RequesterStep;
+
+  switch (Step->Stage) {
+  case SpdmRequesterStepStageVersion:
+    if (Step->GetVersionOnly) {
+      return RETURN_SUCCESS;
+    }
+    return SpdmRequesterStepEnterStage (SpdmContext, SpdmRequesterStepStageCapabilities);
+  case SpdmRequesterStepStageCapabilities:
+    return SpdmRequesterStepEnterStage (SpdmContext, SpdmRequesterStepStageAlgorithms);
+  case SpdmRequesterStepStageCertificate:
+    return SpdmCompleteGetCertificate (SpdmContext, Step->CertChainSize, Step->CertChain);
+  case SpdmRequesterStepStageChallenge:
+    SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAuthenticated;
+    return RETURN_SUCCESS;
+  case SpdmRequesterStepStageKeyExchange:
+    SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, Step->SessionId);
+    if (SessionInfo == NULL) {
+      ASSERT (FALSE);
+      return RETURN_UNSUPPORTED;
+    }
+    //
+    // The encapsulated mutual authentication is not driven by SpdmRequesterStep.
+    //
+    if ((SessionInfo->MutAuthRequested != 0) &&
+        (SessionInfo->MutAuthRequested != SPDM_KEY_EXCHANGE_RESPONSE_MUT_AUTH_REQUESTED)) {
+      DEBUG ((DEBUG_INFO, "SpdmRequesterStep - unsupported MutAuthRequested - 0x%x\n", SessionInfo->MutAuthRequested));
+      SpdmFreeSessionId (SpdmContext, Step->SessionId);
+      return RETURN_UNSUPPORTED;
+    }
+    if (Step->ReqSlotIdParam == 0xF) {
+      Step->ReqSlotIdParam = 0xFF;
+    }
+    return SpdmRequesterStepEnterStage (SpdmContext, SpdmRequesterStepStageFinish);
+  case SpdmRequesterStepStagePskExchange:
+    // send PSK_FINISH only if Responder supports Context.
+    if (SpdmIsCapabilitiesFlagSupported(SpdmContext, TRUE, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP_RESPONDER_WITH_CONTEXT)) {
+      return SpdmRequesterStepEnterStage (SpdmContext, SpdmRequesterStepStagePskFinish);
+    }
+    return RETURN_SUCCESS;
+  case SpdmRequesterStepStageAlgorithms:
+  case SpdmRequesterStepStageDigest:
+  case SpdmRequesterStepStageFinish:
+  case SpdmRequesterStepStagePskFinish:
+  case SpdmRequesterStepStageSendReceiveData:
+    return RETURN_SUCCESS;
+  default:
+    ASSERT (FALSE);
+    return RETURN_UNSUPPORTED;
+  }
+}
+
+/**
+  This function enters a stage, and builds its first request.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Stage                        The stage to enter.
+
+  @retval RETURN_NOT_READY             The request of the stage is built, and it needs to be sent.
+  @retval RETURN_SUCCESS               The operation completes without any message exchanged.
+  @retval others                       The operation fails.
+**/
+RETURN_STATUS
+SpdmRequesterStepEnterStage (
+  IN     SPDM_DEVICE_CONTEXT        *SpdmContext,
+  IN     SPDM_REQUESTER_STEP_STAGE  Stage
+  )
+{
+  SPDM_REQUESTER_STEP_CONTEXT               *Step;
+  RETURN_STATUS                             Status;
+  BOOLEAN                                   IsCached;
+
+  Step = &SpdmContext->RequesterStep;
+  Step->Stage = Stage;
+  Step->BusyRetryCount = 0;
+  Step->NotReadyRetryCount = 0;
+
+  if (Stage == SpdmRequesterStepStageCertificate) {
+    Status = SpdmStartGetCertificate (SpdmContext, Step->SlotNum, &IsCached);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    if (IsCached) {
+      return SpdmRequesterStepCompleteStage (SpdmContext);
+    }
+  }
+
+  return SpdmRequesterStepBuild (SpdmContext);
+}
+
+/**
+  This function gets the session ID to encode and decode the messages of the current stage.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the messages, or NULL for normal messages.
+
+  @retval RETURN_SUCCESS               The session ID is got.
+  @retval RETURN_DEVICE_ERROR          The session is not found.
+**/
+RETURN_STATUS
+SpdmRequesterStepGetSessionId (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+     OUT UINT32               **SessionId
+  )
+{
+  SPDM_REQUESTER_STEP_CONTEXT               *Step;
+
+  Step = &SpdmContext->RequesterStep;
+
+  switch (Step->Stage) {
+  case SpdmRequesterStepStageFinish:
+  case SpdmRequesterStepStagePskFinish:
+    *SessionId = &Step->SessionId;
+    return SpdmGetSpdmMessageSessionId (SpdmContext, SessionId);
+  case SpdmRequesterStepStageSendReceiveData:
+    *SessionId = Step->SessionIdValid ? &Step->SessionId : NULL;
+    return RETURN_SUCCESS;
+  default:
+    *SessionId = NULL;
+    return RETURN_SUCCESS;
+  }
+}
+
+/**
+  This function encodes the request of the current stage to a transport layer message.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the transport layer message.
+  @param  Message                      A pointer to a destination buffer to store the transport layer message.
+
+  @retval RETURN_NOT_READY             The request is encoded, and it needs to be sent.
+  @retval others                       The request cannot be encoded.
+**/
+RETURN_STATUS
+SpdmRequesterStepEncode (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  )
+{
+  SPDM_REQUESTER_STEP_CONTEXT               *Step;
+  RETURN_STATUS                             Status;
+  UINT32                                    *SessionId;
+  SPDM_MESSAGE_HEADER                       RespondIfReadyRequest;
+  BOOLEAN                                   IsAppMessage;
+  VOID                                      *Request;
+  UINTN                                     RequestSize;
+
+  Step = &SpdmContext->RequesterStep;
+
+  Status = SpdmRequesterStepGetSessionId (SpdmContext, &SessionId);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  IsAppMessage = FALSE;
+  if (Step->RespondIfReady) {
+    if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11)) {
+      RespondIfReadyRequest.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+    } else {
+      RespondIfReadyRequest.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+    }
+    RespondIfReadyRequest.RequestResponseCode = SPDM_RESPOND_IF_READY;
+    RespondIfReadyRequest.Param1 = SpdmContext->ErrorData.RequestCode;
+    RespondIfReadyRequest.Param2 = SpdmContext->ErrorData.Token;
+    Request = &RespondIfReadyRequest;
+    RequestSize = sizeof(RespondIfReadyRequest);
+  } else if (Step->Stage == SpdmRequesterStepStageSendReceiveData) {
+    IsAppMessage = Step->IsAppMessage;
+    Request = Step->AppRequest;
+    RequestSize = Step->AppRequestSize;
+  } else {
+    Request = Step->Request;
+    RequestSize = Step->RequestSize;
+  }
+
+  Status = SpdmEncodeRequest (SpdmContext, SessionId, IsAppMessage, RequestSize, Request, MessageSize, Message);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  if (SessionId != NULL) {
+    SpdmCountKeyUpdateBudget (SpdmContext, *SessionId, TRUE, RequestSize);
+  }
+
+  Step->RequestPending = TRUE;
+  return RETURN_NOT_READY;
+}
+
+/**
+  This function processes the SPDM response to the request of the current stage.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  ResponseSize                 Size in bytes of the SPDM response.
+  @param  Response                     A pointer to the SPDM response.
+
+  @retval RETURN_NOT_READY             The next request is built, and it needs to be sent.
+  @retval RETURN_SUCCESS               The operation completes.
+  @retval others                       The operation fails.
+**/
+RETURN_STATUS
+SpdmRequesterStepProcess (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                ResponseSize,
+  IN OUT VOID                 *Response
+  )
+{
+  SPDM_REQUESTER_STEP_CONTEXT               *Step;
+  RETURN_STATUS                             Status;
+  SPDM_ERROR_RESPONSE                       *SpdmResponse;
+  SPDM_ERROR_DATA_RESPONSE_NOT_READY        *ExtendErrorData;
+  UINT16                                    RemainderLength;
+  BOOLEAN                                   BasicMutAuthRequested;
+
+  Step = &SpdmContext->RequesterStep;
+  SpdmResponse = Response;
+
+  //
+  // RESPONSE_NOT_READY of a long latency command is answered by RESPOND_IF_READY here,
+  // and the expected response comes back through the same stage.
+  //
+  if ((ResponseSize >= sizeof(SPDM_MESSAGE_HEADER)) &&
+      (SpdmResponse->Header.RequestResponseCode == SPDM_ERROR) &&
+      (SpdmResponse->Header.Param1 == SPDM_ERROR_CODE_RESPONSE_NOT_READY) &&
+      (Step->Stage >= SpdmRequesterStepStageCertificate) &&
+      (Step->Stage <= SpdmRequesterStepStagePskFinish)) {
+    if (ResponseSize != sizeof(SPDM_ERROR_RESPONSE) + sizeof(SPDM_ERROR_DATA_RESPONSE_NOT_READY)) {
+      return RETURN_DEVICE_ERROR;
+    }
+    ExtendErrorData = (SPDM_ERROR_DATA_RESPONSE_NOT_READY *)(SpdmResponse + 1);
+    if (ExtendErrorData->RequestCode != ((SPDM_MESSAGE_HEADER *)Step->Request)->RequestResponseCode) {
+      return RETURN_DEVICE_ERROR;
+    }
+    if (Step->NotReadyRetryCount > SpdmContext->RetryTimes) {
+      return RETURN_DEVICE_ERROR;
+    }
+    Step->NotReadyRetryCount++;
+
+    SpdmContext->ErrorData.RDTExponent = ExtendErrorData->RDTExponent;
+    SpdmContext->ErrorData.RequestCode = ExtendErrorData->RequestCode;
+    SpdmContext->ErrorData.Token       = ExtendErrorData->Token;
+    SpdmContext->ErrorData.RDTM        = ExtendErrorData->RDTM;
+    Step->RespondIfReady = TRUE;
+    return RETURN_NOT_READY;
+  }
+
+  switch (Step->Stage) {
+  case SpdmRequesterStepStageVersion:
+    Status = SpdmProcessVersionResponse (SpdmContext, Step->RequestSize, Step->Request, ResponseSize, Response);
+    break;
+  case SpdmRequesterStepStageCapabilities:
+    Status = SpdmProcessCapabilitiesResponse (SpdmContext, Step->RequestSize, Step->Request, ResponseSize, Response);
+    break;
+  case SpdmRequesterStepStageAlgorithms:
+    Status = SpdmProcessAlgorithmsResponse (SpdmContext, Step->RequestSize, Step->Request, ResponseSize, Response);
+    break;
+  case SpdmRequesterStepStageDigest:
+    //
+    // The request is cached only once its response arrives, so a pending request can still be abandoned.
+    //
+    Status = SpdmAppendMessageBDigest (SpdmContext, Step->Request, Step->RequestSize);
+    if (RETURN_ERROR(Status)) {
+      Status = RETURN_SECURITY_VIOLATION;
+      break;
+    }
+    Status = SpdmProcessDigestResponse (SpdmContext, Step->RequestSize, Step->Request, ResponseSize, Response, Step->SlotMask, Step->TotalDigestBuffer);
+    break;
+  case SpdmRequesterStepStageCertificate:
+    Status = SpdmProcessCertificateResponse (SpdmContext, Step->SlotNum, Step->RequestSize, Step->Request, ResponseSize, Response, &RemainderLength);
+    if (!RETURN_ERROR(Status) && (RemainderLength != 0)) {
+      Step->BusyRetryCount = 0;
+      Step->NotReadyRetryCount = 0;
+      return SpdmRequesterStepBuild (SpdmContext);
+    }
+    break;
+  case SpdmRequesterStepStageChallenge:
+    Status = SpdmProcessChallengeAuthResponse (SpdmContext, Step->SlotNum, Step->MeasurementHashType, Step->RequestSize, Step->Request, ResponseSize, Response, Step->MeasurementHash, &BasicMutAuthRequested, FALSE);
+    if (!RETURN_ERROR(Status) && BasicMutAuthRequested) {
+      //
+      // The basic mutual authentication is not driven by SpdmRequesterStep.
+      //
+      DEBUG ((DEBUG_INFO, "SpdmRequesterStep - unsupported BasicMutAuth\n"));
+      Status = RETURN_UNSUPPORTED;
+    }
+    break;
+  case SpdmRequesterStepStageKeyExchange:
+    //
+    // The DHE context is freed by SpdmProcessKeyExchangeResponse.
+    //
+    Status = SpdmProcessKeyExchangeResponse (SpdmContext, Step->MeasurementHashType, Step->RequestSize, Step->Request, ResponseSize, Response, Step->DHEContext, &Step->SessionId, Step->HeartbeatPeriod, &Step->ReqSlotIdParam, Step->MeasurementHash);
+    Step->DHEContext = NULL;
+    if (!RETURN_ERROR(Status)) {
+      *Step->SessionIdOut = Step->SessionId;
+    }
+    break;
+  case SpdmRequesterStepStageFinish:
+    Status = SpdmProcessFinishResponse (SpdmContext, Step->SessionId, Step->RequestSize, Step->Request, ResponseSize, Response);
+    break;
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
+  case SpdmRequesterStepStagePskExchange:
+    Status = SpdmProcessPskExchangeResponse (SpdmContext, Step->MeasurementHashType, Step->RequestSize, Step->Request, ResponseSize, Response, &Step->SessionId, Step->HeartbeatPeriod, Step->MeasurementHash);
+    if (!RETURN_ERROR(Status)) {
+      *Step->SessionIdOut = Step->SessionId;
+    }
+    break;
+  case SpdmRequesterStepStagePskFinish:
+    Status = SpdmProcessPskFinishResponse (SpdmContext, Step->SessionId, Step->RequestSize, Step->Request, ResponseSize, Response);
+    break;
+#endif
+  default:
+    ASSERT (FALSE);
+    Status = RETURN_UNSUPPORTED;
+    break;
+  }
+
+  //
+  // BUSY: send the request of the stage again, as many times as the blocking functions do.
+  //
+  if (Status == RETURN_NO_RESPONSE) {
+    if (Step->BusyRetryCount >= SpdmContext->RetryTimes) {
+      return Status;
+    }
+    Step->BusyRetryCount++;
+    Step->NotReadyRetryCount = 0;
+    return SpdmRequesterStepBuild (SpdmContext);
+  }
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  return SpdmRequesterStepCompleteStage (SpdmContext);
+}
+
+/**
+  This function starts to initialize an SPDM connection with SpdmRequesterStep.
+
+  The messages are the same as SpdmInitConnection.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  GetVersionOnly               If the requester sends GET_VERSION only or not.
+
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterBeginInitConnection (
+  IN     VOID                 *Context,
+  IN     BOOLEAN              GetVersionOnly
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  RETURN_STATUS                             Status;
+
+  SpdmContext = Context;
+  Status = SpdmRequesterStepCheckIdle (SpdmContext);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  SpdmContext->RequesterStep.GetVersionOnly = GetVersionOnly;
+  SpdmContext->RequesterStep.Stage = SpdmRequesterStepStageVersion;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function starts to get all digest of the certificate chains with SpdmRequesterStep.
+
+  The messages are the same as SpdmGetDigest.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotMask                     The slots which deploy the CertificateChain.
+  @param  TotalDigestBuffer            A pointer to a destination buffer to store the digest buffer.
+
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterBeginGetDigest (
+  IN     VOID                 *Context,
+     OUT UINT8                *SlotMask,
+     OUT VOID                 *TotalDigestBuffer
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  RETURN_STATUS                             Status;
+
+  SpdmContext = Context;
+  Status = SpdmRequesterStepCheckIdle (SpdmContext);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  SpdmContext->RequesterStep.SlotMask = SlotMask;
+  SpdmContext->RequesterStep.TotalDigestBuffer = TotalDigestBuffer;
+  SpdmContext->RequesterStep.Stage = SpdmRequesterStepStageDigest;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function starts to get the certificate chain of one slot with SpdmRequesterStep.
+
+  The messages are the same as SpdmGetCertificate.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  CertChainSize                On input, indicate the size in bytes of the destination buffer to store the digest buffer.
+                                       On output, indicate the size in bytes of the certificate chain.
+  @param  CertChain                    A pointer to a destination buffer to store the certificate chain.
+
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterBeginGetCertificate (
+  IN     VOID                 *Context,
+  IN     UINT8                SlotNum,
+  IN OUT UINTN                *CertChainSize,
+     OUT VOID                 *CertChain
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  RETURN_STATUS                             Status;
+
+  SpdmContext = Context;
+  Status = SpdmRequesterStepCheckIdle (SpdmContext);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  SpdmContext->RequesterStep.SlotNum = SlotNum;
+  SpdmContext->RequesterStep.CertChainSize = CertChainSize;
+  SpdmContext->RequesterStep.CertChain = CertChain;
+  SpdmContext->RequesterStep.Stage = SpdmRequesterStepStageCertificate;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function starts to authenticate the device with CHALLENGE with SpdmRequesterStep.
+
+  The messages are the same as SpdmChallenge.
+  The basic mutual authentication is not supported, and RETURN_UNSUPPORTED is returned if the responder requests it.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SlotNum                      The number of slot for the challenge.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterBeginChallenge (
+  IN     VOID                 *Context,
+  IN     UINT8                SlotNum,
+  IN     UINT8                MeasurementHashType,
+     OUT VOID                 *MeasurementHash
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  RETURN_STATUS                             Status;
+
+  SpdmContext = Context;
+  Status = SpdmRequesterStepCheckIdle (SpdmContext);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  SpdmContext->RequesterStep.SlotNum = SlotNum;
+  SpdmContext->RequesterStep.MeasurementHashType = MeasurementHashType;
+  SpdmContext->RequesterStep.MeasurementHash = MeasurementHash;
+  SpdmContext->RequesterStep.Stage = SpdmRequesterStepStageChallenge;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function starts to start an SPDM session with SpdmRequesterStep.
+
+  The messages are the same as SpdmStartSession.
+  The encapsulated mutual authentication is not supported, and RETURN_UNSUPPORTED is returned if the responder requests it.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  UsePsk                       FALSE means to use KEY_EXCHANGE/FINISH to start a session.
+                                       TRUE means to use PSK_EXCHANGE/PSK_FINISH to start a session.
+  @param  MeasurementHashType          The type of the measurement hash.
+  @param  SlotNum                      The number of slot for the certificate chain.
+  @param  SessionId                    The session ID of the session.
+  @param  HeartbeatPeriod              The heartbeat period for the session.
+  @param  MeasurementHash              A pointer to a destination buffer to store the measurement hash.
+
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
+  @retval RETURN_UNSUPPORTED           UsePsk is TRUE and OPENSPDM_PSK_CAP_SUPPORT is 0.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterBeginStartSession (
+  IN     VOID                 *Context,
+  IN     BOOLEAN              UsePsk,
+  IN     UINT8                MeasurementHashType,
+  IN     UINT8                SlotNum,
+     OUT UINT32               *SessionId,
+     OUT UINT8                *HeartbeatPeriod,
+     OUT VOID                 *MeasurementHash
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  RETURN_STATUS                             Status;
+
+  SpdmContext = Context;
+#if OPENSPDM_PSK_CAP_SUPPORT == 0
+  if (UsePsk) {
+    return RETURN_UNSUPPORTED;
+  }
+#endif
+  Status = SpdmRequesterStepCheckIdle (SpdmContext);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  SpdmContext->RequesterStep.UsePsk = UsePsk;
+  SpdmContext->RequesterStep.MeasurementHashType = MeasurementHashType;
+  SpdmContext->RequesterStep.SlotNum = SlotNum;
+  SpdmContext->RequesterStep.SessionIdOut = SessionId;
+  SpdmContext->RequesterStep.HeartbeatPeriod = HeartbeatPeriod;
+  SpdmContext->RequesterStep.MeasurementHash = MeasurementHash;
+  if (UsePsk) {
+    SpdmContext->RequesterStep.Stage = SpdmRequesterStepStagePskExchange;
+  } else {
+    SpdmContext->RequesterStep.Stage = SpdmRequesterStepStageKeyExchange;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function starts to send and receive an SPDM or APP message with SpdmRequesterStep.
+
+  The messages are the same as SpdmSendReceiveData, except that the key update policy of the session is not run.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  Request                      A pointer to the request data.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Response                     A pointer to the response data.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer once the operation completes.
+
+  @retval RETURN_SUCCESS               The operation is started.
+  @retval RETURN_ALREADY_STARTED       Another operation is in progress.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterBeginSendReceiveData (
+  IN     VOID                 *Context,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     VOID                 *Request,
+  IN     UINTN                RequestSize,
+     OUT VOID                 *Response,
+  IN OUT UINTN                *ResponseSize
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  RETURN_STATUS                             Status;
+
+  SpdmContext = Context;
+  Status = SpdmRequesterStepCheckIdle (SpdmContext);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  SpdmContext->RequesterStep.SessionIdValid = (BOOLEAN)(SessionId != NULL);
+  if (SessionId != NULL) {
+    SpdmContext->RequesterStep.SessionId = *SessionId;
+  }
+  SpdmContext->RequesterStep.IsAppMessage = IsAppMessage;
+  SpdmContext->RequesterStep.AppRequest = Request;
+  SpdmContext->RequesterStep.AppRequestSize = RequestSize;
+  SpdmContext->RequesterStep.AppResponse = Response;
+  SpdmContext->RequesterStep.AppResponseSize = ResponseSize;
+  SpdmContext->RequesterStep.Stage = SpdmRequesterStepStageSendReceiveData;
+  return RETURN_SUCCESS;
+}
+
+/**
+  This function aborts the operation started by a SpdmRequesterBegin function.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+EFIAPI
+SpdmRequesterAbort (
+  IN     VOID                 *Context
+  )
+{
+  SpdmRequesterStepReset (Context);
+}
+
+/**
+  This function drives the operation started by a SpdmRequesterBegin function by one message.
+
+  The caller owns the transport. It sends each outgoing message, and passes each received message back,
+  so that the requester never blocks in SendMessage or ReceiveMessage.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IncomingMessageSize          Size in bytes of the incoming transport layer message.
+  @param  IncomingMessage              A pointer to the transport layer message received for the last outgoing message.
+                                       It is NULL for the first call after a SpdmRequesterBegin function.
+  @param  OutgoingMessageSize          On input, the size in bytes of the outgoing message buffer.
+                                       On output, the size in bytes of the outgoing transport layer message,
+                                       or 0 if there is no message to send.
+  @param  OutgoingMessage              A pointer to a destination buffer to store the outgoing transport layer message.
+
+  @retval RETURN_NOT_READY             The outgoing message needs to be sent, and its response passed to the next call.
+  @retval RETURN_SUCCESS               The operation completes.
+  @retval RETURN_NOT_STARTED           No operation is in progress.
+  @retval RETURN_INVALID_PARAMETER     The incoming message is missing, or is not expected.
+  @retval others                       The operation fails, and it ends.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRequesterStep (
+  IN     VOID                 *Context,
+  IN     UINTN                IncomingMessageSize,
+  IN     VOID                 *IncomingMessage OPTIONAL,
+  IN OUT UINTN                *OutgoingMessageSize,
+     OUT VOID                 *OutgoingMessage
+  )
+{
+  SPDM_DEVICE_CONTEXT                       *SpdmContext;
+  SPDM_REQUESTER_STEP_CONTEXT               *Step;
+  RETURN_STATUS                             Status;
+  UINT32                                    *SessionId;
+  UINT8                                     *Response;
+  UINTN                                     ResponseSize;
+
+  SpdmContext = Context;
+  Step = &SpdmContext->RequesterStep;
+
+  if (Step->Stage == SpdmRequesterStepStageNone) {
+    return RETURN_NOT_STARTED;
+  }
+  if ((IncomingMessage == NULL) == Step->RequestPending) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if (IncomingMessage == NULL) {
+    Status = SpdmRequesterStepEnterStage (SpdmContext, Step->Stage);
+  } else {
+    Step->RequestPending = FALSE;
+    Status = SpdmRequesterStepGetSessionId (SpdmContext, &SessionId);
+    if (!RETURN_ERROR(Status)) {
+      if (Step->Stage == SpdmRequesterStepStageSendReceiveData) {
+        Status = SpdmDecodeResponse (SpdmContext, SessionId, Step->IsAppMessage, IncomingMessageSize, IncomingMessage, Step->AppResponseSize, Step->AppResponse);
+        if (RETURN_ERROR(Status)) {
+          Status = RETURN_DEVICE_ERROR;
+        }
+      } else {
+        Response = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+        if (Response == NULL) {
+          Status = RETURN_OUT_OF_RESOURCES;
+        } else {
+          ResponseSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+          ZeroMem (Response, ResponseSize);
+          Status = SpdmDecodeResponse (SpdmContext, SessionId, FALSE, IncomingMessageSize, IncomingMessage, &ResponseSize, Response);
+          if (RETURN_ERROR(Status)) {
+            Status = RETURN_DEVICE_ERROR;
+          } else {
+            Status = SpdmRequesterStepProcess (SpdmContext, ResponseSize, Response);
+          }
+          SpdmReleaseScratch (SpdmContext, Response);
+        }
+      }
+    }
+  }
+
+  if (Status == RETURN_NOT_READY) {
+    Status = SpdmRequesterStepEncode (SpdmContext, OutgoingMessageSize, OutgoingMessage);
+    if (Status == RETURN_NOT_READY) {
+      return Status;
+    }
+  }
+
+  *OutgoingMessageSize = 0;
+  SpdmRequesterStepReset (SpdmContext);
+  return Status;
+}
@@ -0,0 +1,117 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmRequesterLibInternal.h"
+
+/**
+  Return the time of a CTExponent or an RDTExponent.
+
+  @param  Exponent                     The CTExponent or the RDTExponent.
+
+  @return the time, 2^Exponent, in microseconds.
+**/
+UINT64
+SpdmGetTimingExponentValue (
+  IN     UINT8                Exponent
+  )
+{
+  return (UINT64)1 << MIN (Exponent, MAX_SPDM_TIMING_EXPONENT);
+}
+
+/**
+  Return the timeout of the response to an SPDM request.
+
+  The timeout is RTT + CT for a request with cryptographic processing, and RTT + ST1 otherwise.
+  CT is from the CTExponent of the CAPABILITIES response, and is never shorter than ST1.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the request.
+
+  @return the timeout of the response, in 100ns units, or 0 if the response is waited for indefinitely.
+**/
+UINT64
+SpdmGetResponseTimeout (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request
+  )
+{
+  SPDM_MESSAGE_HEADER                       *SpdmRequest;
+  BOOLEAN                                   IsCryptoRequest;
+  UINT64                                    ResponseTime;
+
+  if (SpdmContext->LocalContext.TransportRoundTripTime == 0) {
+    return 0;
+  }
+
+  SpdmRequest = Request;
+  IsCryptoRequest = FALSE;
+  if (RequestSize >= sizeof(SPDM_MESSAGE_HEADER)) {
+    switch (SpdmRequest->RequestResponseCode) {
+    case SPDM_GET_MEASUREMENTS:
+      IsCryptoRequest = ((SpdmRequest->Param1 & SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE) != 0);
+      break;
+    case SPDM_CHALLENGE:
+    case SPDM_KEY_EXCHANGE:
+    case SPDM_FINISH:
+    case SPDM_PSK_EXCHANGE:
+    case SPDM_PSK_FINISH:
+      IsCryptoRequest = TRUE;
+      break;
+    default:
+      break;
+    }
+  }
+
+  ResponseTime = SPDM_ST1_VALUE_US;
+  if (IsCryptoRequest) {
+    ResponseTime = MAX (ResponseTime, SpdmGetTimingExponentValue (SpdmContext->ConnectionInfo.Capability.CTExponent));
+  }
+
+  return (SpdmContext->LocalContext.TransportRoundTripTime + ResponseTime) * 10;
+}
+
+/**
+  Wait for a period of time with the registered stall function.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  WaitTime                     The time to wait, in microseconds.
+**/
+VOID
+SpdmRequesterStall (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT64               WaitTime
+  )
+{
+  if (SpdmContext->Stall == NULL) {
+    return ;
+  }
+  DEBUG((DEBUG_INFO, "SpdmRequesterStall - %ldus\n", WaitTime));
+  SpdmContext->Stall (SpdmContext, WaitTime * 10);
+}
+
+/**
+  Wait before a request answered with ERROR(BUSY) is retried.
+
+  The wait is ST1, and doubles with each consecutive ERROR(BUSY) up to MAX_SPDM_BUSY_BACKOFF_SHIFT times,
+  so that a device busy for a short time is retried soon, and a device busy for a long time is not flooded.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmRequesterBackoffBusy (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SpdmRequesterStall (SpdmContext, (UINT64)SPDM_ST1_VALUE_US << SpdmContext->BusyCount);
+  if (SpdmContext->BusyCount < MAX_SPDM_BUSY_BACKOFF_SHIFT) {
+    SpdmContext->BusyCount ++;
+  }
+}
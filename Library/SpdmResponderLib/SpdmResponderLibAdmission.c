@@ -0,0 +1,281 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmResponderLibInternal.h"
+
+/**
+  Register the admission control functions of the responder to an SPDM context.
+
+  CHALLENGE, KEY_EXCHANGE and GET_MEASUREMENTS with signature are the requests needing a signing or a DHE operation.
+  They are answered with ERROR(Busy) if AdmissionFunc refuses them, or if the budget set by SpdmSetResponderRateLimit
+  or the budget of the rate limiter registered by SpdmRegisterResponderRateLimiter is used up.
+  The budgets apply once GetTimeFunc is registered. GetTimeFunc also enables the latencies of the responder statistics,
+  if OPENSPDM_RESPONDER_STATS_SUPPORT is 1.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  GetTimeFunc                  The function to return the time, or NULL.
+  @param  AdmissionFunc                The function to decide if a request is served, or NULL.
+**/
+VOID
+EFIAPI
+SpdmRegisterResponderAdmissionFunc (
+  IN  VOID                           *Context,
+  IN  SPDM_RESPONDER_GET_TIME_FUNC   GetTimeFunc OPTIONAL,
+  IN  SPDM_RESPONDER_ADMISSION_FUNC  AdmissionFunc OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT      *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->ResponderGetTimeFunc = (UINTN)GetTimeFunc;
+  SpdmContext->ResponderAdmissionFunc = (UINTN)AdmissionFunc;
+  return ;
+}
+
+/**
+  Initialize a rate limit.
+
+  @param  RateLimit                    A pointer to the rate limit.
+  @param  Budget                       The number of requests admitted in each period, or 0 for no limit.
+  @param  Period                       The period, in 100ns units.
+**/
+VOID
+SpdmRateLimitInit (
+     OUT SPDM_RATE_LIMIT      *RateLimit,
+  IN     UINT32               Budget,
+  IN     UINT64               Period
+  )
+{
+  RateLimit->Budget = Budget;
+  RateLimit->Period = Period;
+  RateLimit->WindowStart = 0;
+  RateLimit->Used = 0;
+}
+
+/**
+  Check if a rate limit admits one more request, starting a new period if the current one is over.
+
+  @param  RateLimit                    A pointer to the rate limit.
+  @param  Now                          The current time, in 100ns units.
+
+  @retval TRUE   one more request is admitted.
+  @retval FALSE  the budget of the current period is used up.
+**/
+BOOLEAN
+SpdmRateLimitAvailable (
+  IN OUT SPDM_RATE_LIMIT      *RateLimit,
+  IN     UINT64               Now
+  )
+{
+  if (RateLimit->Budget == 0) {
+    return TRUE;
+  }
+  if ((RateLimit->Used == 0) || (Now < RateLimit->WindowStart) || (Now - RateLimit->WindowStart >= RateLimit->Period)) {
+    RateLimit->WindowStart = Now;
+    RateLimit->Used = 0;
+  }
+  return (BOOLEAN)(RateLimit->Used < RateLimit->Budget);
+}
+
+/**
+  Take one request from the budget of a rate limit.
+
+  @param  RateLimit                    A pointer to the rate limit.
+**/
+VOID
+SpdmRateLimitConsume (
+  IN OUT SPDM_RATE_LIMIT      *RateLimit
+  )
+{
+  if (RateLimit->Budget != 0) {
+    RateLimit->Used++;
+  }
+}
+
+/**
+  Set the budget of the requests needing a signing or a DHE operation from the peer of an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Budget                       The number of such requests served in each period, or 0 for no limit.
+  @param  Period                       The period, in 100ns units.
+**/
+VOID
+EFIAPI
+SpdmSetResponderRateLimit (
+  IN  VOID                           *Context,
+  IN  UINT32                         Budget,
+  IN  UINT64                         Period
+  )
+{
+  SPDM_DEVICE_CONTEXT      *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmRateLimitInit (&SpdmContext->RateLimit, Budget, Period);
+  return ;
+}
+
+/**
+  Return the size in bytes of a responder rate limiter.
+
+  @return the size in bytes of the responder rate limiter.
+**/
+UINTN
+EFIAPI
+SpdmResponderRateLimiterGetSize (
+  VOID
+  )
+{
+  return sizeof(SPDM_RESPONDER_RATE_LIMITER);
+}
+
+/**
+  Initialize a responder rate limiter.
+
+  The rate limiter holds the budget of the requests needing a signing or a DHE operation from all peers.
+  It may be shared by multiple SPDM contexts. If the contexts are used concurrently,
+  AcquireLock and ReleaseLock must be provided to serialize the access to the rate limiter.
+
+  @param  RateLimiter                  A pointer to the responder rate limiter.
+  @param  Budget                       The number of such requests served in each period, or 0 for no limit.
+  @param  Period                       The period, in 100ns units.
+  @param  AcquireLock                  The function to acquire the lock, or NULL.
+  @param  ReleaseLock                  The function to release the lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+**/
+VOID
+EFIAPI
+SpdmResponderRateLimiterInit (
+  IN     VOID                                   *RateLimiter,
+  IN     UINT32                                 Budget,
+  IN     UINT64                                 Period,
+  IN     SPDM_RESPONDER_RATE_LIMITER_LOCK_FUNC  AcquireLock OPTIONAL,
+  IN     SPDM_RESPONDER_RATE_LIMITER_LOCK_FUNC  ReleaseLock OPTIONAL,
+  IN     VOID                                   *LockContext OPTIONAL
+  )
+{
+  SPDM_RESPONDER_RATE_LIMITER  *Limiter;
+
+  Limiter = RateLimiter;
+  ZeroMem (Limiter, sizeof(SPDM_RESPONDER_RATE_LIMITER));
+  SpdmRateLimitInit (&Limiter->RateLimit, Budget, Period);
+  Limiter->AcquireLock = AcquireLock;
+  Limiter->ReleaseLock = ReleaseLock;
+  Limiter->LockContext = LockContext;
+}
+
+/**
+  Register a responder rate limiter to an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RateLimiter                  A pointer to the responder rate limiter, or NULL to stop using a rate limiter.
+**/
+VOID
+EFIAPI
+SpdmRegisterResponderRateLimiter (
+  IN     VOID                 *Context,
+  IN     VOID                 *RateLimiter OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT      *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->RateLimiter = RateLimiter;
+  return ;
+}
+
+/**
+  Check if a request needs a signing or a DHE operation.
+
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Request                      A pointer to the request data.
+
+  @retval TRUE   the request needs a signing or a DHE operation.
+  @retval FALSE  the request does not need a signing or a DHE operation.
+**/
+BOOLEAN
+SpdmResponderIsExpensiveRequest (
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request
+  )
+{
+  SPDM_MESSAGE_HEADER      *SpdmRequest;
+
+  SpdmRequest = Request;
+  if (RequestSize < sizeof(SPDM_MESSAGE_HEADER)) {
+    return FALSE;
+  }
+  switch (SpdmRequest->RequestResponseCode) {
+  case SPDM_CHALLENGE:
+  case SPDM_KEY_EXCHANGE:
+    return TRUE;
+  case SPDM_GET_MEASUREMENTS:
+    return (BOOLEAN)((SpdmRequest->Param1 & SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE) != 0);
+  default:
+    return FALSE;
+  }
+}
+
+/**
+  Decide if a request is served now, by the admission control of the responder.
+
+  A request needing a signing or a DHE operation takes one from the budget of the peer
+  and of the registered rate limiter, if it is served.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Request                      A pointer to the request data.
+
+  @retval TRUE   the request is served.
+  @retval FALSE  the request is answered with ERROR(Busy).
+**/
+BOOLEAN
+SpdmResponderAdmitRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request
+  )
+{
+  SPDM_RESPONDER_RATE_LIMITER  *Limiter;
+  UINT64                       Now;
+  BOOLEAN                      Admitted;
+
+  if (!SpdmResponderIsExpensiveRequest (RequestSize, Request)) {
+    return TRUE;
+  }
+  if ((SpdmContext->ResponderAdmissionFunc != 0) &&
+      !((SPDM_RESPONDER_ADMISSION_FUNC)SpdmContext->ResponderAdmissionFunc) (SpdmContext, ((SPDM_MESSAGE_HEADER *)Request)->RequestResponseCode)) {
+    return FALSE;
+  }
+  if (SpdmContext->ResponderGetTimeFunc == 0) {
+    return TRUE;
+  }
+
+  Now = ((SPDM_RESPONDER_GET_TIME_FUNC)SpdmContext->ResponderGetTimeFunc) (SpdmContext);
+  if (!SpdmRateLimitAvailable (&SpdmContext->RateLimit, Now)) {
+    return FALSE;
+  }
+  Limiter = SpdmContext->RateLimiter;
+  if (Limiter != NULL) {
+    if (Limiter->AcquireLock != NULL) {
+      Limiter->AcquireLock (Limiter->LockContext);
+    }
+    Admitted = SpdmRateLimitAvailable (&Limiter->RateLimit, Now);
+    if (Admitted) {
+      SpdmRateLimitConsume (&Limiter->RateLimit);
+    }
+    if (Limiter->ReleaseLock != NULL) {
+      Limiter->ReleaseLock (Limiter->LockContext);
+    }
+    if (!Admitted) {
+      return FALSE;
+    }
+  }
+  SpdmRateLimitConsume (&SpdmContext->RateLimit);
+  return TRUE;
+}
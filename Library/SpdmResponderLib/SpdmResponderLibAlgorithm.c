@@ -149,6 +149,174 @@ SpdmPrioritizeAlgorithm (
   return 0;
 }
 
+/**
+  Select the algorithm with the lowest cost, or the preferred one according to the PriorityTable
+  among the algorithms with the same cost.
+
+  @param  PriorityTable                The priority table.
+  @param  PriorityTableCount           The count of the priroty table entry.
+  @param  LocalAlgo                    Local supported algorithm.
+  @param  PeerAlgo                     Peer supported algorithm.
+  @param  CostTable                    The costs of the algorithms, or NULL to select by the PriorityTable only.
+
+  @return final selected supported algorithm
+**/
+UINT32
+SpdmPrioritizeAlgorithmByCost (
+  IN UINT32            *PriorityTable,
+  IN UINTN             PriorityTableCount,
+  IN UINT32            LocalAlgo,
+  IN UINT32            PeerAlgo,
+  IN CONST UINT32      *CostTable OPTIONAL
+  )
+{
+  UINT32 CommonAlgo;
+  UINT32 SelectedAlgo;
+  UINT32 SelectedCost;
+  UINT32 Cost;
+  UINTN  Index;
+
+  if (CostTable == NULL) {
+    return SpdmPrioritizeAlgorithm (PriorityTable, PriorityTableCount, LocalAlgo, PeerAlgo);
+  }
+
+  CommonAlgo = (LocalAlgo & PeerAlgo);
+  SelectedAlgo = 0;
+  SelectedCost = MAX_UINT32;
+  for (Index = 0; Index < PriorityTableCount; Index++) {
+    if ((CommonAlgo & PriorityTable[Index]) == 0) {
+      continue;
+    }
+    Cost = SpdmGetAlgorithmCost (CostTable, PriorityTable[Index]);
+    if ((SelectedAlgo == 0) || (Cost < SelectedCost)) {
+      SelectedAlgo = PriorityTable[Index];
+      SelectedCost = Cost;
+    }
+  }
+
+  return SelectedAlgo;
+}
+
+/**
+  Check if two algorithm sets are the same.
+
+  @param  Algorithm1                   The first algorithm set.
+  @param  Algorithm2                   The second algorithm set.
+
+  @retval TRUE   The algorithm sets are the same.
+  @retval FALSE  The algorithm sets are different.
+**/
+BOOLEAN
+SpdmIsSameAlgorithmSet (
+  IN CONST SPDM_DEVICE_ALGORITHM  *Algorithm1,
+  IN CONST SPDM_DEVICE_ALGORITHM  *Algorithm2
+  )
+{
+  return (Algorithm1->MeasurementSpec == Algorithm2->MeasurementSpec) &&
+         (Algorithm1->MeasurementHashAlgo == Algorithm2->MeasurementHashAlgo) &&
+         (Algorithm1->BaseAsymAlgo == Algorithm2->BaseAsymAlgo) &&
+         (Algorithm1->BaseHashAlgo == Algorithm2->BaseHashAlgo) &&
+         (Algorithm1->DHENamedGroup == Algorithm2->DHENamedGroup) &&
+         (Algorithm1->AEADCipherSuite == Algorithm2->AEADCipherSuite) &&
+         (Algorithm1->ReqBaseAsymAlg == Algorithm2->ReqBaseAsymAlg) &&
+         (Algorithm1->KeySchedule == Algorithm2->KeySchedule);
+}
+
+/**
+  Select the preferred algorithms from the local algorithms and the algorithms offered by the peer.
+
+  The local algorithms below the minimum security strength of the algorithm cost model are not selected,
+  and the algorithms with the lowest cost are preferred if there is an algorithm cost model.
+  The selection is cached in the SPDM context. The requesters of a fleet offer the same algorithms,
+  so a reconnecting requester reuses the selection of the previous one.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Offered                      The algorithms offered by the peer.
+  @param  Selected                     The selected algorithms.
+**/
+VOID
+SpdmSelectAlgorithm (
+  IN     SPDM_DEVICE_CONTEXT          *SpdmContext,
+  IN     CONST SPDM_DEVICE_ALGORITHM  *Offered,
+     OUT SPDM_DEVICE_ALGORITHM        *Selected
+  )
+{
+  SPDM_ALGORITHM_SELECTION_CACHE  *Cache;
+  SPDM_DEVICE_ALGORITHM           LocalAlgorithm;
+  SPDM_DEVICE_ALGORITHM           *Local;
+  SPDM_ALGORITHM_COST_MODEL       *CostModel;
+
+  Cache = &SpdmContext->AlgorithmSelectionCache;
+  SpdmGetNegotiableAlgorithm (SpdmContext, &LocalAlgorithm);
+  Local = &LocalAlgorithm;
+  CostModel = SpdmContext->AlgorithmCostModelEnabled ? &SpdmContext->AlgorithmCostModel : NULL;
+  if (Cache->Valid &&
+      SpdmIsSameAlgorithmSet (&Cache->Local, Local) &&
+      SpdmIsSameAlgorithmSet (&Cache->Offered, Offered)) {
+    CopyMem (Selected, &Cache->Selected, sizeof(SPDM_DEVICE_ALGORITHM));
+    return ;
+  }
+
+  Selected->MeasurementSpec = (UINT8)SpdmPrioritizeAlgorithm (
+                                mMeasurementSpecPriorityTable,
+                                ARRAY_SIZE(mMeasurementSpecPriorityTable),
+                                Local->MeasurementSpec,
+                                Offered->MeasurementSpec
+                                );
+  Selected->MeasurementHashAlgo = SpdmPrioritizeAlgorithm (
+                                    mMeasurementHashPriorityTable,
+                                    ARRAY_SIZE(mMeasurementHashPriorityTable),
+                                    Local->MeasurementHashAlgo,
+                                    Offered->MeasurementHashAlgo
+                                    );
+  Selected->BaseAsymAlgo = SpdmPrioritizeAlgorithmByCost (
+                                   mAsymPriorityTable,
+                                   ARRAY_SIZE(mAsymPriorityTable),
+                                   Local->BaseAsymAlgo,
+                                   Offered->BaseAsymAlgo,
+                                   (CostModel == NULL) ? NULL : CostModel->BaseAsymAlgoCost
+                                   );
+  Selected->BaseHashAlgo = SpdmPrioritizeAlgorithmByCost (
+                                   mHashPriorityTable,
+                                   ARRAY_SIZE(mHashPriorityTable),
+                                   Local->BaseHashAlgo,
+                                   Offered->BaseHashAlgo,
+                                   (CostModel == NULL) ? NULL : CostModel->BaseHashAlgoCost
+                                   );
+  Selected->DHENamedGroup = (UINT16)SpdmPrioritizeAlgorithmByCost (
+                                    mDhePriorityTable,
+                                    ARRAY_SIZE(mDhePriorityTable),
+                                    Local->DHENamedGroup,
+                                    Offered->DHENamedGroup,
+                                    (CostModel == NULL) ? NULL : CostModel->DHENamedGroupCost
+                                    );
+  Selected->AEADCipherSuite = (UINT16)SpdmPrioritizeAlgorithmByCost (
+                                      mAeadPriorityTable,
+                                      ARRAY_SIZE(mAeadPriorityTable),
+                                      Local->AEADCipherSuite,
+                                      Offered->AEADCipherSuite,
+                                      (CostModel == NULL) ? NULL : CostModel->AEADCipherSuiteCost
+                                      );
+  Selected->ReqBaseAsymAlg = (UINT16)SpdmPrioritizeAlgorithmByCost (
+                                     mReqAsymPriorityTable,
+                                     ARRAY_SIZE(mReqAsymPriorityTable),
+                                     Local->ReqBaseAsymAlg,
+                                     Offered->ReqBaseAsymAlg,
+                                     (CostModel == NULL) ? NULL : CostModel->ReqBaseAsymAlgCost
+                                     );
+  Selected->KeySchedule = (UINT16)SpdmPrioritizeAlgorithm (
+                            mKeySchedulePriorityTable,
+                            ARRAY_SIZE(mKeySchedulePriorityTable),
+                            Local->KeySchedule,
+                            Offered->KeySchedule
+                            );
+
+  CopyMem (&Cache->Local, Local, sizeof(SPDM_DEVICE_ALGORITHM));
+  CopyMem (&Cache->Offered, Offered, sizeof(SPDM_DEVICE_ALGORITHM));
+  CopyMem (&Cache->Selected, Selected, sizeof(SPDM_DEVICE_ALGORITHM));
+  Cache->Valid = TRUE;
+}
+
 /**
   Process the SPDM NEGOTIATE_ALGORITHMS request and return the response.
 
@@ -186,6 +354,7 @@ SpdmGetResponseAlgorithm (
   UINT32                                         AlgoSize;
   UINT8                                          FixedAlgSize;
   UINT8                                          ExtAlgCount;
+  SPDM_DEVICE_ALGORITHM                          Selected;
 
   SpdmContext = Context;
   SpdmRequest = Request;
@@ -299,62 +468,23 @@ SpdmGetResponseAlgorithm (
     }
   }
 
-  SpdmResponse->MeasurementSpecificationSel = (UINT8)SpdmPrioritizeAlgorithm (
-                                                mMeasurementSpecPriorityTable,
-                                                ARRAY_SIZE(mMeasurementSpecPriorityTable),
-                                                SpdmContext->LocalContext.Algorithm.MeasurementSpec,
-                                                SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec
-                                                );
-  SpdmResponse->MeasurementHashAlgo = SpdmPrioritizeAlgorithm (
-                                        mMeasurementHashPriorityTable,
-                                        ARRAY_SIZE(mMeasurementHashPriorityTable),
-                                        SpdmContext->LocalContext.Algorithm.MeasurementHashAlgo,
-                                        SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo
-                                        );
-  SpdmResponse->BaseAsymSel = SpdmPrioritizeAlgorithm (
-                                mAsymPriorityTable,
-                                ARRAY_SIZE(mAsymPriorityTable),
-                                SpdmContext->LocalContext.Algorithm.BaseAsymAlgo,
-                                SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo
-                                );
-  SpdmResponse->BaseHashSel = SpdmPrioritizeAlgorithm (
-                                mHashPriorityTable,
-                                ARRAY_SIZE(mHashPriorityTable),
-                                SpdmContext->LocalContext.Algorithm.BaseHashAlgo,
-                                SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo
-                                );
+  SpdmSelectAlgorithm (SpdmContext, &SpdmContext->ConnectionInfo.Algorithm, &Selected);
+  SpdmResponse->MeasurementSpecificationSel = Selected.MeasurementSpec;
+  SpdmResponse->MeasurementHashAlgo = Selected.MeasurementHashAlgo;
+  SpdmResponse->BaseAsymSel = Selected.BaseAsymAlgo;
+  SpdmResponse->BaseHashSel = Selected.BaseHashAlgo;
   SpdmResponse->StructTable[0].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_DHE;
   SpdmResponse->StructTable[0].AlgCount = 0x20;
-  SpdmResponse->StructTable[0].AlgSupported = (UINT16)SpdmPrioritizeAlgorithm (
-                                                mDhePriorityTable,
-                                                ARRAY_SIZE(mDhePriorityTable),
-                                                SpdmContext->LocalContext.Algorithm.DHENamedGroup,
-                                                SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup
-                                                );
+  SpdmResponse->StructTable[0].AlgSupported = Selected.DHENamedGroup;
   SpdmResponse->StructTable[1].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_AEAD;
   SpdmResponse->StructTable[1].AlgCount = 0x20;
-  SpdmResponse->StructTable[1].AlgSupported = (UINT16)SpdmPrioritizeAlgorithm (
-                                                mAeadPriorityTable,
-                                                ARRAY_SIZE(mAeadPriorityTable),
-                                                SpdmContext->LocalContext.Algorithm.AEADCipherSuite,
-                                                SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite
-                                                );
+  SpdmResponse->StructTable[1].AlgSupported = Selected.AEADCipherSuite;
   SpdmResponse->StructTable[2].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_REQ_BASE_ASYM_ALG;
   SpdmResponse->StructTable[2].AlgCount = 0x20;
-  SpdmResponse->StructTable[2].AlgSupported = (UINT16)SpdmPrioritizeAlgorithm (
-                                                mReqAsymPriorityTable,
-                                                ARRAY_SIZE(mReqAsymPriorityTable),
-                                                SpdmContext->LocalContext.Algorithm.ReqBaseAsymAlg,
-                                                SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg
-                                                );
+  SpdmResponse->StructTable[2].AlgSupported = Selected.ReqBaseAsymAlg;
   SpdmResponse->StructTable[3].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_KEY_SCHEDULE;
   SpdmResponse->StructTable[3].AlgCount = 0x20;
-  SpdmResponse->StructTable[3].AlgSupported = (UINT16)SpdmPrioritizeAlgorithm (
-                                                mKeySchedulePriorityTable,
-                                                ARRAY_SIZE(mKeySchedulePriorityTable),
-                                                SpdmContext->LocalContext.Algorithm.KeySchedule,
-                                                SpdmContext->ConnectionInfo.Algorithm.KeySchedule
-                                                );
+  SpdmResponse->StructTable[3].AlgSupported = Selected.KeySchedule;
   //
   // Cache
   //
@@ -433,6 +563,7 @@ SpdmGetResponseAlgorithm (
     SpdmContext->ConnectionInfo.Algorithm.ReqBaseAsymAlg = 0;
     SpdmContext->ConnectionInfo.Algorithm.KeySchedule = 0;
   }
+  SpdmFinishMessageADigest (SpdmContext);
   SpdmSetConnectionState (SpdmContext, SpdmConnectionStateNegotiated);
 
   return RETURN_SUCCESS;
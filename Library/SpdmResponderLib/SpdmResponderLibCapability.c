@@ -132,6 +132,7 @@ SpdmGetResponseCapability (
   UINTN                          SpdmRequestSize;
   SPDM_CAPABILITIES_RESPONSE     *SpdmResponse;
   SPDM_DEVICE_CONTEXT            *SpdmContext;
+  RETURN_STATUS                  Status;
 
   SpdmContext = Context;
   SpdmRequest = Request;
@@ -164,7 +165,11 @@ SpdmGetResponseCapability (
   //
   // Cache
   //
-  AppendManagedBuffer (&SpdmContext->Transcript.MessageA, SpdmRequest, SpdmRequestSize);
+  Status = SpdmAppendMessageA (SpdmContext, SpdmRequest, SpdmRequestSize);
+  if (RETURN_ERROR(Status)) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
 
   ASSERT (*ResponseSize >= sizeof(SPDM_CAPABILITIES_RESPONSE));
   *ResponseSize = sizeof(SPDM_CAPABILITIES_RESPONSE);
@@ -181,10 +186,18 @@ SpdmGetResponseCapability (
   SpdmResponse->Header.Param2 = 0;
   SpdmResponse->CTExponent = SpdmContext->LocalContext.Capability.CTExponent;
   SpdmResponse->Flags = SpdmContext->LocalContext.Capability.Flags;
+  // fresh measurements are only meaningful with measurements
+  if ((SpdmResponse->Flags & SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP) == 0) {
+    SpdmResponse->Flags &= ~SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_FRESH_CAP;
+  }
   //
   // Cache
   //
-  AppendManagedBuffer (&SpdmContext->Transcript.MessageA, SpdmResponse, *ResponseSize);
+  Status = SpdmAppendMessageA (SpdmContext, SpdmResponse, *ResponseSize);
+  if (RETURN_ERROR(Status)) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
 
   if (SpdmResponse->Header.SPDMVersion >= SPDM_MESSAGE_VERSION_11) {
     SpdmContext->ConnectionInfo.Capability.CTExponent = SpdmRequest->CTExponent;
@@ -90,10 +90,7 @@ SpdmGetResponseCertificate (
   }
 
   Offset = SpdmRequest->Offset;
-  Length = SpdmRequest->Length;
-  if (Length > MAX_SPDM_CERT_CHAIN_BLOCK_LEN) {
-    Length = MAX_SPDM_CERT_CHAIN_BLOCK_LEN;
-  }
+  Length = MIN (SpdmRequest->Length, SpdmGetCertChainBlockLength (SpdmContext, *ResponseSize));
   
   if (Offset >= SpdmContext->LocalContext.LocalCertChainProvisionSize[SlotNum]) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
@@ -107,7 +104,11 @@ SpdmGetResponseCertificate (
 
   ASSERT (*ResponseSize >= sizeof(SPDM_CERTIFICATE_RESPONSE) + Length);
   *ResponseSize = sizeof(SPDM_CERTIFICATE_RESPONSE) + Length;
-  ZeroMem (Response, *ResponseSize);
+  //
+  // Only the header is cleared. The portion is copied once from the provisioned certificate chain,
+  // into the transport message directly if SpdmBuildResponse builds the response at its headroom.
+  //
+  ZeroMem (Response, sizeof(SPDM_CERTIFICATE_RESPONSE));
   SpdmResponse = Response;
 
   if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11)) {
@@ -49,6 +49,7 @@ SpdmGetResponseChallengeAuth (
   SPDM_DEVICE_CONTEXT                       *SpdmContext;
   SPDM_CHALLENGE_AUTH_RESPONSE_ATTRIBUTE    AuthAttribute;
   RETURN_STATUS                             Status;
+  UINT64                                    StartTime;
 
   SpdmContext = Context;
   SpdmRequest = Request;
@@ -112,6 +113,7 @@ SpdmGetResponseChallengeAuth (
   AuthAttribute.SlotNum = (UINT8)(SlotNum & 0xF);
   AuthAttribute.Reserved = 0;
   AuthAttribute.BasicMutAuthReq = 0;
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   if (SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MUT_AUTH_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MUT_AUTH_CAP) &&
       SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CHAL_CAP, 0) &&
       (SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CERT_CAP, 0) ||
@@ -121,23 +123,31 @@ SpdmGetResponseChallengeAuth (
   if (AuthAttribute.BasicMutAuthReq != 0) {
     SpdmInitBasicMutAuthEncapState (Context, AuthAttribute.BasicMutAuthReq);
   }
+#endif
 
   SpdmResponse->Header.Param1 = *(UINT8 *)&AuthAttribute;
   SpdmResponse->Header.Param2 = (1 << SlotNum);
-  if (SlotNum == 0xFF) {
+  Ptr = (VOID *)(SpdmResponse + 1);
+  if ((SlotNum == 0xFF) && (SpdmContext->LocalContext.LocalPublicKeyProvisionSize != 0)) {
     SpdmResponse->Header.Param2 = 0;
 
-    SlotNum = SpdmContext->LocalContext.ProvisionedSlotNum;
-  }
+    SpdmHashAll (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, SpdmContext->LocalContext.LocalPublicKeyProvision, SpdmContext->LocalContext.LocalPublicKeyProvisionSize, Ptr);
+  } else {
+    if (SlotNum == 0xFF) {
+      SpdmResponse->Header.Param2 = 0;
 
-  Ptr = (VOID *)(SpdmResponse + 1);
-  SpdmGenerateCertChainHash (SpdmContext, SlotNum, Ptr);
+      SlotNum = SpdmContext->LocalContext.ProvisionedSlotNum;
+    }
+    SpdmGenerateCertChainHash (SpdmContext, SlotNum, Ptr);
+  }
   Ptr += HashSize;
 
-  SpdmGetRandomNumber (SPDM_NONCE_SIZE, Ptr);
+  SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, SPDM_NONCE_SIZE, Ptr);
   Ptr += SPDM_NONCE_SIZE;
 
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
   Result = SpdmGenerateMeasurementSummaryHash (SpdmContext, FALSE, SpdmRequest->Header.Param2, Ptr);
+  SpdmResponderStatsAddCallbackTime (SpdmContext, StartTime);
   if (!Result) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
@@ -157,8 +167,13 @@ SpdmGetResponseChallengeAuth (
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
-  Result = SpdmGenerateChallengeAuthSignature (SpdmContext, FALSE, Ptr);
-  if (!Result) {
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
+  Status = SpdmGenerateChallengeAuthSignature (SpdmContext, FALSE, Ptr);
+  SpdmResponderStatsAddCallbackTime (SpdmContext, StartTime);
+  if (Status == RETURN_NOT_READY) {
+    return SpdmResponderDeferSignature (SpdmContext, SPDM_CHALLENGE, INVALID_SESSION_ID, (UINTN)Ptr - (UINTN)SpdmResponse, ResponseSize, Response);
+  }
+  if (RETURN_ERROR(Status)) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_CHALLENGE_AUTH, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
@@ -0,0 +1,152 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmResponderLibInternal.h"
+
+/**
+  Keep a response larger than the transport maximum message size to be retrieved by CHUNK_GET,
+  and replace it by ERROR(LargeResponse).
+
+  The response is sent as is if CHUNK_CAP is not negotiated, if the transport maximum message size
+  cannot hold a chunk, or if the response does not fit in the chunk buffer.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the response, or NULL if it is not a secured message.
+  @param  ResponseSize                 On input, the size in bytes of the response.
+                                       On output, the size in bytes of the response to send.
+  @param  Response                     A pointer to the response.
+**/
+VOID
+SpdmResponderHoldLargeResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN OUT UINTN                *ResponseSize,
+  IN OUT VOID                 *Response
+  )
+{
+  SPDM_ERROR_DATA_LARGE_RESPONSE  ExtendErrorData;
+  UINT32                          MaxMessageSize;
+
+  MaxMessageSize = SpdmContext->LocalContext.TransportMaxMessageSize;
+  if ((MaxMessageSize == 0) || (*ResponseSize <= MaxMessageSize)) {
+    return;
+  }
+  if ((MaxMessageSize <= sizeof(SPDM_CHUNK_RESPONSE_RESPONSE) + sizeof(UINT32)) ||
+      (*ResponseSize > SpdmContext->ChunkBufferSize) ||
+      !SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CHUNK_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHUNK_CAP)) {
+    return;
+  }
+
+  CopyMem (SpdmContext->ChunkBuffer, Response, *ResponseSize);
+  SpdmContext->LargeResponseSize = (UINT32)*ResponseSize;
+  SpdmContext->ChunkOffset = 0;
+  SpdmContext->ChunkSeqNo = 0;
+  SpdmContext->ChunkHandle++;
+  SpdmContext->LargeResponseSessionIdValid = (BOOLEAN)(SessionId != NULL);
+  SpdmContext->LargeResponseSessionId = (SessionId != NULL) ? *SessionId : 0;
+
+  ExtendErrorData.Handle = SpdmContext->ChunkHandle;
+  SpdmGenerateExtendedErrorResponse (SpdmContext, SPDM_ERROR_CODE_LARGE_RESPONSE, 0, sizeof(ExtendErrorData), (UINT8 *)&ExtendErrorData, ResponseSize, Response);
+}
+
+/**
+  Process the SPDM CHUNK_GET request and return the response.
+
+  Each CHUNK_RESPONSE carries the next chunk of the large response, sized to the transport maximum message size.
+  The large response is released after its last chunk is sent.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Request                      A pointer to the request data.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+  @param  Response                     A pointer to the response data.
+
+  @retval RETURN_SUCCESS               The request is processed and the response is returned.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetResponseChunkGet (
+  IN     VOID                 *Context,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  SPDM_CHUNK_GET_REQUEST        *SpdmRequest;
+  SPDM_CHUNK_RESPONSE_RESPONSE  *SpdmResponse;
+  SPDM_DEVICE_CONTEXT           *SpdmContext;
+  UINTN                         HeaderSize;
+  UINTN                         MaxMessageSize;
+  UINTN                         ChunkSize;
+  UINT8                         *Ptr;
+
+  SpdmContext = Context;
+  SpdmRequest = Request;
+
+  if (RequestSize != sizeof(SPDM_CHUNK_GET_REQUEST)) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
+  if ((SpdmContext->LargeResponseSize == 0) ||
+      (SpdmContext->LargeResponseSessionIdValid != SpdmContext->LastSpdmRequestSessionIdValid) ||
+      (SpdmContext->LargeResponseSessionIdValid && (SpdmContext->LargeResponseSessionId != SpdmContext->LastSpdmRequestSessionId))) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNEXPECTED_REQUEST, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
+  if ((SpdmRequest->Header.Param2 != SpdmContext->ChunkHandle) ||
+      (SpdmRequest->ChunkSeqNo != SpdmContext->ChunkSeqNo)) {
+    SpdmContext->LargeResponseSize = 0;
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
+
+  HeaderSize = sizeof(SPDM_CHUNK_RESPONSE_RESPONSE);
+  if (SpdmContext->ChunkSeqNo == 0) {
+    HeaderSize += sizeof(UINT32);
+  }
+  MaxMessageSize = MIN (SpdmContext->LocalContext.TransportMaxMessageSize, *ResponseSize);
+  if (MaxMessageSize <= HeaderSize) {
+    SpdmContext->LargeResponseSize = 0;
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSPECIFIED, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
+  ChunkSize = MIN (MaxMessageSize - HeaderSize, SpdmContext->LargeResponseSize - SpdmContext->ChunkOffset);
+
+  *ResponseSize = HeaderSize + ChunkSize;
+  SpdmResponse = Response;
+  SpdmResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmResponse->Header.RequestResponseCode = SPDM_CHUNK_RESPONSE;
+  SpdmResponse->Header.Param1 = 0;
+  SpdmResponse->Header.Param2 = SpdmContext->ChunkHandle;
+  SpdmResponse->ChunkSeqNo = SpdmContext->ChunkSeqNo;
+  SpdmResponse->Reserved = 0;
+  SpdmResponse->ChunkSize = (UINT32)ChunkSize;
+  Ptr = (VOID *)(SpdmResponse + 1);
+  if (SpdmContext->ChunkSeqNo == 0) {
+    *(UINT32 *)Ptr = SpdmContext->LargeResponseSize;
+    Ptr += sizeof(UINT32);
+  }
+  CopyMem (Ptr, SpdmContext->ChunkBuffer + SpdmContext->ChunkOffset, ChunkSize);
+
+  SpdmContext->ChunkOffset += (UINT32)ChunkSize;
+  SpdmContext->ChunkSeqNo++;
+  if (SpdmContext->ChunkOffset == SpdmContext->LargeResponseSize) {
+    SpdmResponse->Header.Param1 = SPDM_CHUNK_RESPONSE_ATTRIBUTE_LAST_CHUNK;
+    SpdmContext->LargeResponseSize = 0;
+  }
+
+  return RETURN_SUCCESS;
+}
@@ -18,6 +18,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
   This function is called in SpdmResponderDispatchMessage to process the message.
   The alternative is: an SPDM responder may receive the request message directly
   and call this function to process it, then send the response message.
+  It holds the lock registered by SpdmRegisterResponderLockFunc while the message is processed.
 
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
@@ -53,12 +54,12 @@ SpdmProcessMessage (
 
   SpdmContext = Context;
 
+  SpdmResponderLock (SpdmContext);
   Status = SpdmProcessRequest (SpdmContext, SessionId, &IsAppMessage, RequestSize, Request);
-  if (RETURN_ERROR(Status)) {
-    return Status;
+  if (!RETURN_ERROR(Status)) {
+    Status = SpdmBuildResponse (SpdmContext, *SessionId, IsAppMessage, ResponseSize, Response);
   }
-
-  Status = SpdmBuildResponse (SpdmContext, *SessionId, IsAppMessage, ResponseSize, Response);
+  SpdmResponderUnlock (SpdmContext);
   if (RETURN_ERROR(Status)) {
     return Status;
   }
@@ -77,36 +78,79 @@ SpdmProcessMessage (
   @retval RETURN_SUCCESS               One SPDM request message is processed.
   @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
   @retval RETURN_UNSUPPORTED           One request message is not supported.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
 **/
 RETURN_STATUS
 EFIAPI
 SpdmResponderDispatchMessage (
   IN     VOID                 *Context
   )
+{
+  return SpdmResponderDispatchMessageOnPath (Context, 0);
+}
+
+/**
+  Dispatch function of an SPDM responder for a transport path registered by SpdmRegisterTransportPath.
+
+  It receives one request message over the transport path, processes it and sends the response message
+  over the same path.
+  The transport paths of an SPDM context are dispatched from one thread, for example once a poll
+  on their devices returns the path with a request pending.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  PathIndex                    The index of the transport path, 0 for the path of SpdmRegisterDeviceIoFunc.
+
+  @retval RETURN_SUCCESS               One SPDM request message is processed.
+  @retval RETURN_INVALID_PARAMETER     The transport path is not registered.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_UNSUPPORTED           One request message is not supported.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmResponderDispatchMessageOnPath (
+  IN     VOID                 *Context,
+  IN     UINT8                PathIndex
+  )
 {
   RETURN_STATUS             Status;
   SPDM_DEVICE_CONTEXT       *SpdmContext;
-  UINT8                     Request[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                     *Request;
   UINTN                     RequestSize;
-  UINT8                     Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                     *Response;
   UINTN                     ResponseSize;
   UINT32                    *SessionId;
 
   SpdmContext = Context;
-
-  RequestSize = sizeof(Request);
-  Status = SpdmContext->ReceiveMessage (SpdmContext, &RequestSize, Request, 0);
-  if (RETURN_ERROR(Status)) {
-    return Status;
+  if (PathIndex > SpdmContext->TransportPathCount) {
+    return RETURN_INVALID_PARAMETER;
   }
 
-  ResponseSize = sizeof(Response);
-  Status = SpdmProcessMessage (SpdmContext, &SessionId, Request, RequestSize, Response, &ResponseSize);
-  if (RETURN_ERROR(Status)) {
-    return Status;
+  Request = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (Request == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  Response = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  if (Response == NULL) {
+    SpdmReleaseScratch (SpdmContext, Request);
+    return RETURN_OUT_OF_RESOURCES;
   }
 
-  Status = SpdmContext->SendMessage (SpdmContext, ResponseSize, Response, 0);
+  SpdmContext->ReceiveTransportPath = PathIndex;
+  SpdmContext->SendTransportPath = PathIndex;
+  RequestSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  Status = SpdmDeviceReceiveMessage (SpdmContext, &RequestSize, Request, 0);
+  if (!RETURN_ERROR(Status)) {
+    ResponseSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    Status = SpdmProcessMessage (SpdmContext, &SessionId, Request, RequestSize, Response, &ResponseSize);
+  }
+  if (!RETURN_ERROR(Status)) {
+    Status = SpdmDeviceSendMessage (SpdmContext, ResponseSize, Response, 0);
+  }
+  SpdmContext->SendTransportPath = 0;
+  SpdmContext->ReceiveTransportPath = 0;
 
+  SpdmReleaseScratch (SpdmContext, Response);
+  SpdmReleaseScratch (SpdmContext, Request);
   return Status;
 }
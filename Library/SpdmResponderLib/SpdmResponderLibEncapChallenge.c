@@ -9,6 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmResponderLibInternal.h"
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
 /**
   Get the SPDM encapsulated CHALLENGE request.
 
@@ -52,10 +53,12 @@ SpdmGetEncapReqestChallenge (
   SpdmRequest->Header.RequestResponseCode = SPDM_CHALLENGE;
   SpdmRequest->Header.Param1 = SpdmContext->EncapContext.ReqSlotNum;
   SpdmRequest->Header.Param2 = SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH;
-  SpdmGetRandomNumber (SPDM_NONCE_SIZE, SpdmRequest->Nonce);
-  DEBUG((DEBUG_INFO, "Encap ClientNonce - "));
-  InternalDumpData (SpdmRequest->Nonce, SPDM_NONCE_SIZE);
-  DEBUG((DEBUG_INFO, "\n"));
+  SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, SPDM_NONCE_SIZE, SpdmRequest->Nonce);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Encap ClientNonce - "));
+    InternalDumpData (SpdmRequest->Nonce, SPDM_NONCE_SIZE);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   //
   // Cache data
@@ -160,9 +163,11 @@ SpdmProcessEncapResponseChallengeAuth (
 
   CertChainHash = Ptr;
   Ptr += HashSize;
-  DEBUG((DEBUG_INFO, "Encap CertChainHash (0x%x) - ", HashSize));
-  InternalDumpData (CertChainHash, HashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_CERT)) {
+    DEBUG((DEBUG_INFO, "Encap CertChainHash (0x%x) - ", HashSize));
+    InternalDumpData (CertChainHash, HashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
   Result = SpdmVerifyCertificateChainHash (SpdmContext, CertChainHash, HashSize);
   if (!Result) {
     SpdmContext->EncapContext.ErrorState = SPDM_STATUS_ERROR_CERTIFICATE_FAILURE;
@@ -170,16 +175,20 @@ SpdmProcessEncapResponseChallengeAuth (
   }
 
   ServerNonce = Ptr;
-  DEBUG((DEBUG_INFO, "Encap ServerNonce (0x%x) - ", SPDM_NONCE_SIZE));
-  InternalDumpData (ServerNonce, SPDM_NONCE_SIZE);
-  DEBUG((DEBUG_INFO, "\n"));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Encap ServerNonce (0x%x) - ", SPDM_NONCE_SIZE));
+    InternalDumpData (ServerNonce, SPDM_NONCE_SIZE);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
   Ptr += SPDM_NONCE_SIZE;
 
   MeasurementSummaryHash = Ptr;
   Ptr += MeasurementSummaryHashSize;
-  DEBUG((DEBUG_INFO, "Encap MeasurementSummaryHash (0x%x) - ", MeasurementSummaryHashSize));
-  InternalDumpData (MeasurementSummaryHash, MeasurementSummaryHashSize);
-  DEBUG((DEBUG_INFO, "\n"));
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Encap MeasurementSummaryHash (0x%x) - ", MeasurementSummaryHashSize));
+    InternalDumpData (MeasurementSummaryHash, MeasurementSummaryHashSize);
+    DEBUG((DEBUG_INFO, "\n"));
+  }
 
   OpaqueLength = *(UINT16 *)Ptr;
   if (OpaqueLength > MAX_SPDM_OPAQUE_DATA_SIZE) {
@@ -210,12 +219,16 @@ SpdmProcessEncapResponseChallengeAuth (
 
   Opaque = Ptr;
   Ptr += OpaqueLength;
-  DEBUG((DEBUG_INFO, "Encap Opaque (0x%x):\n", OpaqueLength));
-  InternalDumpHex (Opaque, OpaqueLength);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Encap Opaque (0x%x):\n", OpaqueLength));
+    InternalDumpHex (Opaque, OpaqueLength);
+  }
 
   Signature = Ptr;
-  DEBUG((DEBUG_INFO, "Encap Signature (0x%x):\n", SignatureSize));
-  InternalDumpHex (Signature, SignatureSize);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_TRANSCRIPT)) {
+    DEBUG((DEBUG_INFO, "Encap Signature (0x%x):\n", SignatureSize));
+    InternalDumpHex (Signature, SignatureSize);
+  }
   Result = SpdmVerifyChallengeAuthSignature (SpdmContext, FALSE, Signature, SignatureSize);
   if (!Result) {
     SpdmContext->EncapContext.ErrorState = SPDM_STATUS_ERROR_CERTIFICATE_FAILURE;
@@ -229,3 +242,5 @@ SpdmProcessEncapResponseChallengeAuth (
 
   return RETURN_SUCCESS;
 }
+
+#endif
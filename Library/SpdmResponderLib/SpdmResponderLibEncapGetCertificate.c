@@ -9,6 +9,48 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmResponderLibInternal.h"
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
+/**
+  Return the largest Length of an encapsulated GET_CERTIFICATE request.
+
+  It follows the transport maximum message size, so that the certificate chain is got in as few round trips as
+  the transport allows. The CERTIFICATE response is received in one DELIVER_ENCAPSULATED_RESPONSE request,
+  with its transport layer wrapper, in one MAX_SPDM_MESSAGE_BUFFER_SIZE buffer.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the largest Length of an encapsulated GET_CERTIFICATE request.
+**/
+UINT16
+SpdmGetEncapCertificateRequestLength (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  UINTN                                     MaxResponseSize;
+  UINTN                                     Headroom;
+  UINTN                                     Tailroom;
+  UINT32                                    *SessionId;
+
+  SessionId = NULL;
+  if (SpdmContext->LastSpdmRequestSessionIdValid) {
+    SessionId = &SpdmContext->LastSpdmRequestSessionId;
+  }
+  MaxResponseSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  if ((SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportGetMessageRoom != NULL) &&
+      !RETURN_ERROR(SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportGetMessageRoom (SpdmContext, SessionId, FALSE, &Headroom, &Tailroom)) &&
+      (Headroom + Tailroom < MaxResponseSize)) {
+    MaxResponseSize -= Headroom + Tailroom;
+  }
+  if ((SpdmContext->LocalContext.TransportMaxMessageSize != 0) &&
+      (SpdmContext->LocalContext.TransportMaxMessageSize < MaxResponseSize)) {
+    MaxResponseSize = SpdmContext->LocalContext.TransportMaxMessageSize;
+  }
+  if (MaxResponseSize <= sizeof(SPDM_DELIVER_ENCAPSULATED_RESPONSE_REQUEST)) {
+    return 0;
+  }
+  return SpdmGetCertChainBlockLength (SpdmContext, MaxResponseSize - sizeof(SPDM_DELIVER_ENCAPSULATED_RESPONSE_REQUEST));
+}
+
 /**
   Get the SPDM encapsulated GET_CERTIFICATE request.
 
@@ -52,8 +94,8 @@ SpdmGetEncapReqestGetCertificate (
   SpdmRequest->Header.RequestResponseCode = SPDM_GET_CERTIFICATE;
   SpdmRequest->Header.Param1 = SpdmContext->EncapContext.ReqSlotNum;
   SpdmRequest->Header.Param2 = 0;
-  SpdmRequest->Offset = (UINT16)GetManagedBufferSize (&SpdmContext->EncapContext.CertificateChainBuffer);
-  SpdmRequest->Length = MAX_SPDM_CERT_CHAIN_BLOCK_LEN;
+  SpdmRequest->Offset = (UINT16)SpdmContext->ConnectionInfo.PeerCertChainCollectedSize;
+  SpdmRequest->Length = SpdmGetEncapCertificateRequestLength (SpdmContext);
   DEBUG((DEBUG_INFO, "Request (Offset 0x%x, Size 0x%x):\n", SpdmRequest->Offset, SpdmRequest->Length));
 
   //
@@ -115,7 +157,7 @@ SpdmProcessEncapResponseCertificate (
   if (EncapResponseSize < sizeof(SPDM_CERTIFICATE_RESPONSE)) {
     return RETURN_DEVICE_ERROR;
   }
-  if (SpdmResponse->PortionLength > MAX_SPDM_CERT_CHAIN_BLOCK_LEN) {
+  if (SpdmResponse->PortionLength > SpdmGetEncapCertificateRequestLength (SpdmContext)) {
     return RETURN_DEVICE_ERROR;
   }
   if (SpdmResponse->Header.Param1 != SpdmContext->EncapContext.ReqSlotNum) {
@@ -133,12 +175,14 @@ SpdmProcessEncapResponseCertificate (
     return RETURN_SECURITY_VIOLATION;
   }
 
-  DEBUG((DEBUG_INFO, "Certificate (Offset 0x%x, Size 0x%x):\n", GetManagedBufferSize (&SpdmContext->EncapContext.CertificateChainBuffer), SpdmResponse->PortionLength));
-  InternalDumpHex ((VOID *)(SpdmResponse + 1), SpdmResponse->PortionLength);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_CERT)) {
+    DEBUG((DEBUG_INFO, "Certificate (Offset 0x%x, Size 0x%x):\n", SpdmContext->ConnectionInfo.PeerCertChainCollectedSize, SpdmResponse->PortionLength));
+    InternalDumpHex ((VOID *)(SpdmResponse + 1), SpdmResponse->PortionLength);
+  }
 
-  Status = AppendManagedBuffer (&SpdmContext->EncapContext.CertificateChainBuffer, (VOID *)(SpdmResponse + 1), SpdmResponse->PortionLength);
+  Status = SpdmCollectPeerCertChain (SpdmContext, (VOID *)(SpdmResponse + 1), SpdmResponse->PortionLength);
   if (RETURN_ERROR(Status)) {
-    return RETURN_SECURITY_VIOLATION;
+    return Status;
   }
 
   if (SpdmResponse->RemainderLength != 0) {
@@ -147,15 +191,15 @@ SpdmProcessEncapResponseCertificate (
   }
 
   *Continue = FALSE;
-  Result = SpdmVerifyPeerCertChainBuffer (SpdmContext, GetManagedBuffer(&SpdmContext->EncapContext.CertificateChainBuffer), GetManagedBufferSize(&SpdmContext->EncapContext.CertificateChainBuffer));
+  Result = SpdmCompleteCollectPeerCertChain (SpdmContext);
   if (!Result) {
     SpdmContext->EncapContext.ErrorState = SPDM_STATUS_ERROR_CERTIFICATE_FAILURE;
     return RETURN_SECURITY_VIOLATION;
   }
-  SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = GetManagedBufferSize(&SpdmContext->EncapContext.CertificateChainBuffer);
-  CopyMem (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, GetManagedBuffer(&SpdmContext->EncapContext.CertificateChainBuffer), GetManagedBufferSize(&SpdmContext->EncapContext.CertificateChainBuffer));
 
   SpdmContext->EncapContext.ErrorState = SPDM_STATUS_SUCCESS;
 
   return RETURN_SUCCESS;
 }
+
+#endif
@@ -9,6 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmResponderLibInternal.h"
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
 /**
   Get the SPDM encapsulated GET_DIGESTS request.
 
@@ -67,6 +68,48 @@ SpdmGetEncapReqestGetDigest (
   return RETURN_SUCCESS;
 }
 
+/**
+  Collect the requester certificate chain from the certificate chain verification cache,
+  if GET_CERTIFICATE follows GET_DIGESTS in the encapsulated request sequence, and the DIGESTS digest
+  of the requester slot matches a certificate chain verified before.
+
+  No GET_CERTIFICATE and CERTIFICATE are exchanged then, so none is added to MessageMutB, as on the requester side.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval TRUE  The certificate chain is collected from the cache, and GET_CERTIFICATE is skipped.
+  @retval FALSE The certificate chain is got with GET_CERTIFICATE.
+**/
+BOOLEAN
+SpdmEncapGetPeerCertChainFromCache (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  UINTN                                     Index;
+  UINTN                                     CachedCertChainSize;
+
+  for (Index = 0; Index + 1 < SpdmContext->EncapContext.RequestOpCodeCount; Index++) {
+    if (SpdmContext->EncapContext.RequestOpCodeSequence[Index] == SPDM_GET_DIGESTS) {
+      break;
+    }
+  }
+  if ((Index + 1 >= SpdmContext->EncapContext.RequestOpCodeCount) ||
+      (SpdmContext->EncapContext.RequestOpCodeSequence[Index + 1] != SPDM_GET_CERTIFICATE)) {
+    return FALSE;
+  }
+
+  CachedCertChainSize = SpdmContext->ConnectionInfo.MaxPeerUsedCertChainBufferSize;
+  if (!SpdmGetPeerCertChainFromCache (SpdmContext, SpdmContext->EncapContext.ReqSlotNum, SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, &CachedCertChainSize)) {
+    return FALSE;
+  }
+  if (!SpdmVerifyPeerCertChainBuffer (SpdmContext, SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, CachedCertChainSize)) {
+    return FALSE;
+  }
+  DEBUG((DEBUG_INFO, "Certificate chain (Slot 0x%x) from cache\n", SpdmContext->EncapContext.ReqSlotNum));
+  SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = CachedCertChainSize;
+  return TRUE;
+}
+
 /**
   Process the SPDM encapsulated DIGESTS response.
 
@@ -134,17 +177,28 @@ SpdmProcessEncapResponseDigest (
 
   Digest = (VOID *)(SpdmResponse + 1);
   for (Index = 0; Index < DigestCount; Index++) {
-    DEBUG((DEBUG_INFO, "Digest (0x%x) - ", Index));
-    InternalDumpData (&Digest[DigestSize * Index], DigestSize);
-    DEBUG((DEBUG_INFO, "\n"));
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_CERT)) {
+      DEBUG((DEBUG_INFO, "Digest (0x%x) - ", Index));
+      InternalDumpData (&Digest[DigestSize * Index], DigestSize);
+      DEBUG((DEBUG_INFO, "\n"));
+    }
   }
 
   Result = SpdmVerifyPeerDigests (SpdmContext, Digest, DigestCount * DigestSize);
   if (!Result) {
     return RETURN_SECURITY_VIOLATION;
   }
+  SpdmRecordPeerDigests (SpdmContext, SpdmResponse->Header.Param2, Digest, DigestCount * DigestSize);
 
   *Continue = FALSE;
+  if (SpdmEncapGetPeerCertChainFromCache (SpdmContext)) {
+    //
+    // The encapsulated request sequence moves past the current request code, so GET_CERTIFICATE is skipped.
+    //
+    SpdmContext->EncapContext.CurrentRequestOpCode = SPDM_GET_CERTIFICATE;
+  }
 
   return RETURN_SUCCESS;
 }
+
+#endif
@@ -9,6 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmResponderLibInternal.h"
 
+#if (OPENSPDM_ENCAP_CAP_SUPPORT == 1) && (OPENSPDM_KEY_UPD_CAP_SUPPORT == 1)
 /**
   Get the SPDM encapsulated KEY_UPDATE request.
 
@@ -64,11 +65,11 @@ SpdmGetEncapReqestKeyUpdate (
   if (SpdmContext->EncapContext.LastEncapRequestHeader.RequestResponseCode != SPDM_KEY_UPDATE) {
     SpdmRequest->Header.Param1 = SPDM_KEY_UPDATE_OPERATIONS_TABLE_UPDATE_KEY;
     SpdmRequest->Header.Param2 = 0;
-    SpdmGetRandomNumber (sizeof(SpdmRequest->Header.Param2), &SpdmRequest->Header.Param2);
+    SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, sizeof(SpdmRequest->Header.Param2), &SpdmRequest->Header.Param2);
   } else {
     SpdmRequest->Header.Param1 = SPDM_KEY_UPDATE_OPERATIONS_TABLE_VERIFY_NEW_KEY;
     SpdmRequest->Header.Param2 = 1;
-    SpdmGetRandomNumber (sizeof(SpdmRequest->Header.Param2), &SpdmRequest->Header.Param2);
+    SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, sizeof(SpdmRequest->Header.Param2), &SpdmRequest->Header.Param2);
 
     // Create new key
     DEBUG ((DEBUG_INFO, "SpdmCreateUpdateSessionDataKey[%x] Responder\n", SessionId));
@@ -145,9 +146,156 @@ SpdmProcessEncapResponseKeyUpdate (
     *Continue = TRUE;
   } else {
     DEBUG ((DEBUG_INFO, "SpdmVerifyKey[%x] Success\n", SessionId));
+    SessionInfo->KeyUpdateScheduled = FALSE;
     *Continue = FALSE;
   }
 
 
   return RETURN_SUCCESS;
 }
+
+/**
+  Return if the session of the last request has a scheduled key update.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval TRUE   The session of the last request has a scheduled key update.
+  @retval FALSE  The last request is not in a session, or its session has no scheduled key update.
+**/
+BOOLEAN
+SpdmIsKeyUpdateScheduled (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_SESSION_INFO            *SessionInfo;
+
+  if (!SpdmContext->LastSpdmRequestSessionIdValid) {
+    return FALSE;
+  }
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SpdmContext->LastSpdmRequestSessionId);
+  if (SessionInfo == NULL) {
+    return FALSE;
+  }
+  return SessionInfo->KeyUpdateScheduled;
+}
+#endif
+
+/**
+  Schedule a responder-initiated key update of all the established sessions of an SPDM context.
+
+  The next responder DataKey of every scheduled session is derived at once, so that each key update
+  only installs it. A scheduled session runs its key update through the encapsulated flow when its
+  requester sends GET_ENCAPSULATED_REQUEST in the session. The integrator decides when to tell the requester,
+  with SpdmIsKeyUpdateDue, for example in the transport of an application response of the session.
+  A session is no longer scheduled after its key update, or after a KEY_UPDATE with UpdateAllKeys from its requester.
+  It takes the lock registered by SpdmRegisterResponderLockFunc.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Spacing                      The minimum time between two key updates, in 100ns units.
+                                       It applies once the time function is registered by SpdmRegisterResponderAdmissionFunc.
+  @param  SessionCount                 The number of sessions newly scheduled.
+
+  @retval RETURN_SUCCESS               The established sessions are scheduled.
+  @retval RETURN_UNSUPPORTED           KEY_UPD_CAP or ENCAP_CAP is not supported by both sides.
+  @retval RETURN_UNSUPPORTED           OPENSPDM_ENCAP_CAP_SUPPORT or OPENSPDM_KEY_UPD_CAP_SUPPORT is 0.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmScheduleKeyUpdate (
+  IN     VOID                 *Context,
+  IN     UINT64               Spacing,
+     OUT UINTN                *SessionCount OPTIONAL
+  )
+{
+#if (OPENSPDM_ENCAP_CAP_SUPPORT == 1) && (OPENSPDM_KEY_UPD_CAP_SUPPORT == 1)
+  SPDM_DEVICE_CONTEXT          *SpdmContext;
+  SPDM_SESSION_INFO            *SessionInfo;
+  UINTN                        Count;
+  UINTN                        Index;
+
+  SpdmContext = Context;
+  if (SessionCount != NULL) {
+    *SessionCount = 0;
+  }
+  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_UPD_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_UPD_CAP) ||
+      !SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCAP_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCAP_CAP)) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  SpdmResponderLock (SpdmContext);
+  SpdmContext->KeyUpdateSpacing = Spacing;
+
+  Count = 0;
+  SessionInfo = SpdmContext->SessionInfo;
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if ((SessionInfo[Index].SessionId == INVALID_SESSION_ID) || SessionInfo[Index].KeyUpdateScheduled) {
+      continue;
+    }
+    if (SpdmSecuredMessageGetSessionState (SessionInfo[Index].SecuredMessageContext) != SpdmSessionStateEstablished) {
+      continue;
+    }
+    SpdmPrepareUpdateSessionDataKey (SessionInfo[Index].SecuredMessageContext, SpdmKeyUpdateActionResponder);
+    SessionInfo[Index].KeyUpdateScheduled = TRUE;
+    Count++;
+  }
+  SpdmResponderUnlock (SpdmContext);
+
+  DEBUG ((DEBUG_INFO, "SpdmScheduleKeyUpdate - %d sessions\n", Count));
+  if (SessionCount != NULL) {
+    *SessionCount = Count;
+  }
+  return RETURN_SUCCESS;
+#else
+  if (SessionCount != NULL) {
+    *SessionCount = 0;
+  }
+  return RETURN_UNSUPPORTED;
+#endif
+}
+
+/**
+  Return if the requester of a session should be told to start the scheduled key update of the session now.
+
+  The key updates are started one at a time, because the encapsulated flow of the responder answers
+  the other requests with ERROR(RequestInFlight). They are spread by the spacing of SpdmScheduleKeyUpdate:
+  once TRUE is returned, it returns FALSE for any session until the spacing has elapsed.
+  It is called from the thread dispatching the messages of the SPDM context, between two messages.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SessionId of the session.
+
+  @retval TRUE   The key update of the session is due. Its requester should send GET_ENCAPSULATED_REQUEST.
+  @retval FALSE  The session is not scheduled, or it is not its turn.
+**/
+BOOLEAN
+EFIAPI
+SpdmIsKeyUpdateDue (
+  IN     VOID                 *Context,
+  IN     UINT32               SessionId
+  )
+{
+#if (OPENSPDM_ENCAP_CAP_SUPPORT == 1) && (OPENSPDM_KEY_UPD_CAP_SUPPORT == 1)
+  SPDM_DEVICE_CONTEXT          *SpdmContext;
+  SPDM_SESSION_INFO            *SessionInfo;
+  UINT64                       Now;
+
+  SpdmContext = Context;
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  if ((SessionInfo == NULL) || !SessionInfo->KeyUpdateScheduled) {
+    return FALSE;
+  }
+  if (SpdmContext->ResponseState != SpdmResponseStateNormal) {
+    return FALSE;
+  }
+  if (SpdmContext->ResponderGetTimeFunc != 0) {
+    Now = ((SPDM_RESPONDER_GET_TIME_FUNC)SpdmContext->ResponderGetTimeFunc) (SpdmContext);
+    if (Now < SpdmContext->KeyUpdateNextTime) {
+      return FALSE;
+    }
+    SpdmContext->KeyUpdateNextTime = Now + SpdmContext->KeyUpdateSpacing;
+  }
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
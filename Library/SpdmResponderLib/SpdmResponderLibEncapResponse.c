@@ -9,6 +9,7 @@
 
 #include "SpdmResponderLibInternal.h"
 
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
 /**
   Get the SPDM encapsulated request.
 
@@ -58,10 +59,14 @@ typedef struct {
 } SPDM_ENCAP_RESPONSE_STRUCT;
 
 SPDM_ENCAP_RESPONSE_STRUCT mEncapResponsestruct[] = {
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   {SPDM_GET_DIGESTS,     SpdmGetEncapReqestGetDigest,      SpdmProcessEncapResponseDigest},
   {SPDM_GET_CERTIFICATE, SpdmGetEncapReqestGetCertificate, SpdmProcessEncapResponseCertificate},
   {SPDM_CHALLENGE,       SpdmGetEncapReqestChallenge,      SpdmProcessEncapResponseChallengeAuth},
+#endif
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
   {SPDM_KEY_UPDATE,      SpdmGetEncapReqestKeyUpdate,      SpdmProcessEncapResponseKeyUpdate},
+#endif
 };
 
 SPDM_ENCAP_RESPONSE_STRUCT *
@@ -174,6 +179,7 @@ SpdmProcessEncapsulatedResponse (
   return Status;
 }
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
 /**
   This function initializes the mut_auth encapsulated state.
 
@@ -194,7 +200,7 @@ SpdmInitMutAuthEncapState (
   SpdmContext->EncapContext.RequestId = 0;
   SpdmContext->EncapContext.LastEncapRequestSize = 0;
   ZeroMem (&SpdmContext->EncapContext.LastEncapRequestHeader, sizeof(SpdmContext->EncapContext.LastEncapRequestHeader));
-  SpdmContext->EncapContext.CertificateChainBuffer.BufferSize = 0;
+  SpdmContext->ConnectionInfo.PeerCertChainCollectedSize = 0;
   SpdmContext->ResponseState = SpdmResponseStateProcessingEncap;
 
   //
@@ -243,7 +249,7 @@ SpdmInitBasicMutAuthEncapState (
   SpdmContext->EncapContext.RequestId = 0;
   SpdmContext->EncapContext.LastEncapRequestSize = 0;
   ZeroMem (&SpdmContext->EncapContext.LastEncapRequestHeader, sizeof(SpdmContext->EncapContext.LastEncapRequestHeader));
-  SpdmContext->EncapContext.CertificateChainBuffer.BufferSize = 0;
+  SpdmContext->ConnectionInfo.PeerCertChainCollectedSize = 0;
   SpdmContext->ResponseState = SpdmResponseStateProcessingEncap;
 
   //
@@ -275,9 +281,12 @@ SpdmInitBasicMutAuthEncapState (
     SpdmContext->EncapContext.RequestOpCodeSequence[1] = SPDM_CHALLENGE;
   }
 }
+#endif
+#endif
 
 /**
   This function initializes the key_update encapsulated state.
+  It does nothing if OPENSPDM_ENCAP_CAP_SUPPORT or OPENSPDM_KEY_UPD_CAP_SUPPORT is 0.
 
   @param  SpdmContext                  A pointer to the SPDM context.
 **/
@@ -287,6 +296,7 @@ SpdmInitKeyUpdateEncapState (
   IN     VOID                 *Context
   )
 {
+#if (OPENSPDM_ENCAP_CAP_SUPPORT == 1) && (OPENSPDM_KEY_UPD_CAP_SUPPORT == 1)
   SPDM_DEVICE_CONTEXT  *SpdmContext;
 
   SpdmContext = Context;
@@ -296,17 +306,21 @@ SpdmInitKeyUpdateEncapState (
   SpdmContext->EncapContext.RequestId = 0;
   SpdmContext->EncapContext.LastEncapRequestSize = 0;
   ZeroMem (&SpdmContext->EncapContext.LastEncapRequestHeader, sizeof(SpdmContext->EncapContext.LastEncapRequestHeader));
-  SpdmContext->EncapContext.CertificateChainBuffer.BufferSize = 0;
+  SpdmContext->ConnectionInfo.PeerCertChainCollectedSize = 0;
   SpdmContext->ResponseState = SpdmResponseStateProcessingEncap;
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   ResetManagedBuffer (&SpdmContext->Transcript.MessageMutB);
   ResetManagedBuffer (&SpdmContext->Transcript.MessageMutC);
+#endif
 
   ZeroMem (SpdmContext->EncapContext.RequestOpCodeSequence, sizeof(SpdmContext->EncapContext.RequestOpCodeSequence));
   SpdmContext->EncapContext.RequestOpCodeCount = 1;
   SpdmContext->EncapContext.RequestOpCodeSequence[0] = SPDM_KEY_UPDATE;
+#endif
 }
 
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
 /**
   Process the SPDM ENCAPSULATED_REQUEST request and return the response.
 
@@ -348,6 +362,11 @@ SpdmGetResponseEncapsulatedRequest (
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_GET_ENCAPSULATED_REQUEST, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
+  if ((SpdmContext->ResponseState == SpdmResponseStateNormal) && SpdmIsKeyUpdateScheduled (SpdmContext)) {
+    SpdmInitKeyUpdateEncapState (SpdmContext);
+  }
+#endif
   if (SpdmContext->ResponseState != SpdmResponseStateProcessingEncap) {
     if (SpdmContext->ResponseState == SpdmResponseStateNormal) {
       SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNEXPECTED_REQUEST, 0, ResponseSize, Response);
@@ -527,3 +546,4 @@ SpdmHandleEncapErrorResponseMain (
   ShrinkManagedBuffer(MBuffer, ShrinkBufferSize);
   return RETURN_DEVICE_ERROR;
 }
+#endif
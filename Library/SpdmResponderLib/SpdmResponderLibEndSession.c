@@ -74,6 +74,12 @@ SpdmGetResponseEndSession (
   }
 
   SessionInfo->EndSessionAttributes = SpdmRequest->Header.Param1;
+  //
+  // The negotiated state can only be preserved if the responder supports CACHE_CAP.
+  //
+  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CACHE_CAP)) {
+    SessionInfo->EndSessionAttributes |= SPDM_END_SESSION_REQUEST_ATTRIBUTES_PRESERVE_NEGOTIATED_STATE_CLEAR;
+  }
 
   ASSERT (*ResponseSize >= sizeof(SPDM_END_SESSION_RESPONSE));
   *ResponseSize = sizeof(SPDM_END_SESSION_RESPONSE);
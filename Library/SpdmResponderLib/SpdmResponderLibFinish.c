@@ -48,6 +48,7 @@ SpdmGetResponseFinish (
   UINT8                    TH2HashData[64];
   RETURN_STATUS            Status;
   SPDM_SESSION_STATE       SessionState;
+  UINT64                   StartTime;
 
   SpdmContext = Context;
   SpdmRequest = Request;
@@ -115,10 +116,14 @@ SpdmGetResponseFinish (
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   if (ReqSlotNum == 0xFF) {
     ReqSlotNum = SpdmContext->EncapContext.ReqSlotNum;
   }
   if (ReqSlotNum != SpdmContext->EncapContext.ReqSlotNum) {
+#else
+  if ((ReqSlotNum != 0xFF) && (ReqSlotNum != 0)) {
+#endif
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
@@ -128,8 +133,11 @@ SpdmGetResponseFinish (
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   if (SessionInfo->MutAuthRequested) {
+    StartTime = SpdmResponderStatsGetTime (SpdmContext);
     Result = SpdmVerifyFinishReqSignature (SpdmContext, SessionInfo, (UINT8 *)Request + sizeof(SPDM_FINISH_REQUEST), SignatureSize);
+    SpdmResponderStatsAddCryptoTime (SpdmContext, StartTime);
     if (!Result) {
       SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_DECRYPT_ERROR, 0, ResponseSize, Response);
       return RETURN_SUCCESS;
@@ -140,6 +148,7 @@ SpdmGetResponseFinish (
       return RETURN_SUCCESS;
     }
   }
+#endif
 
   Result = SpdmVerifyFinishReqHmac (SpdmContext, SessionInfo, (UINT8 *)Request + SignatureSize + sizeof(SPDM_FINISH_REQUEST), HmacSize);
   if (!Result) {
@@ -188,12 +197,14 @@ SpdmGetResponseFinish (
   }
 
   DEBUG ((DEBUG_INFO, "SpdmGenerateSessionDataKey[%x]\n", SessionId));
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
   Status = SpdmCalculateTH2Hash (SpdmContext, SessionInfo, FALSE, TH2HashData);
   if (RETURN_ERROR(Status)) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
   Status = SpdmGenerateSessionDataKey (SessionInfo->SecuredMessageContext, TH2HashData);
+  SpdmResponderStatsAddCryptoTime (SpdmContext, StartTime);
   if (RETURN_ERROR(Status)) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
@@ -50,11 +50,7 @@ SpdmResponderHandleResponseState (
   case SpdmResponseStateNotReady:
     SpdmContext->CachSpdmRequestSize = SpdmContext->LastSpdmRequestSize;
     CopyMem (SpdmContext->CachSpdmRequest, SpdmContext->LastSpdmRequest, SpdmContext->LastSpdmRequestSize);
-    SpdmContext->ErrorData.RDTExponent = 1;
-    SpdmContext->ErrorData.RDTM        = 1;
-    SpdmContext->ErrorData.RequestCode = RequestCode;
-    SpdmContext->ErrorData.Token       = SpdmContext->CurrentToken++;
-    SpdmGenerateExtendedErrorResponse (SpdmContext, SPDM_ERROR_CODE_RESPONSE_NOT_READY, 0, sizeof(SPDM_ERROR_DATA_RESPONSE_NOT_READY), (UINT8*)(void*)&SpdmContext->ErrorData, ResponseSize, Response);
+    SpdmResponderGenerateResponseNotReady (SpdmContext, RequestCode, 1, ResponseSize, Response);
     // NOTE: Need to reset status to Normal in up level
     return RETURN_SUCCESS;
   case SpdmResponseStateProcessingEncap:
@@ -66,3 +62,184 @@ SpdmResponderHandleResponseState (
   }
 }
 
+/**
+  Build the ResponseNotReady error response for a request.
+
+  A new token is taken and recorded with the request code for the following RESPOND_IF_READY.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  RDTExponent                  The exponent of the estimated time to complete the request.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+  @param  Response                     A pointer to the response data.
+**/
+VOID
+SpdmResponderGenerateResponseNotReady (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                RequestCode,
+  IN     UINT8                RDTExponent,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  SpdmContext->ErrorData.RDTExponent = RDTExponent;
+  SpdmContext->ErrorData.RDTM        = 1;
+  SpdmContext->ErrorData.RequestCode = RequestCode;
+  SpdmContext->ErrorData.Token       = SpdmContext->CurrentToken++;
+  SpdmGenerateExtendedErrorResponse (SpdmContext, SPDM_ERROR_CODE_RESPONSE_NOT_READY, 0, sizeof(SPDM_ERROR_DATA_RESPONSE_NOT_READY), (UINT8*)(void*)&SpdmContext->ErrorData, ResponseSize, Response);
+}
+
+/**
+  Keep a response waiting for an asynchronous signature and return the ResponseNotReady error response instead.
+
+  The response is completed by the RESPOND_IF_READY request once the signing is done.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  SessionId                    The SessionId of the session created by the request, or INVALID_SESSION_ID.
+  @param  SignatureOffset              The offset in bytes of the signature in the response.
+  @param  ResponseSize                 On input, the size in bytes of the response waiting for the signature.
+                                       On output, the size in bytes of the ResponseNotReady error response.
+  @param  Response                     On input, the response waiting for the signature.
+                                       On output, the ResponseNotReady error response.
+
+  @retval RETURN_SUCCESS               The ResponseNotReady error response is returned.
+**/
+RETURN_STATUS
+SpdmResponderDeferSignature (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                RequestCode,
+  IN     UINT32               SessionId,
+  IN     UINTN                SignatureOffset,
+  IN OUT UINTN                *ResponseSize,
+  IN OUT VOID                 *Response
+  )
+{
+  SPDM_PENDING_SIGNATURE      *PendingSignature;
+
+  PendingSignature = &SpdmContext->PendingSignature;
+  ASSERT (*ResponseSize <= SpdmContext->MaxSpdmMessageSize);
+  ASSERT (SignatureOffset + GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo) <= *ResponseSize);
+
+  PendingSignature->Valid           = TRUE;
+  PendingSignature->RequestCode     = RequestCode;
+  PendingSignature->SessionId       = SessionId;
+  PendingSignature->SignatureOffset = SignatureOffset;
+  PendingSignature->YieldPoint      = 0;
+  PendingSignature->ResponseSize    = *ResponseSize;
+  CopyMem (PendingSignature->Response, Response, *ResponseSize);
+
+  //
+  // Expect the signing to take about the crypto timeout.
+  //
+  SpdmResponderGenerateResponseNotReady (SpdmContext, RequestCode, SpdmContext->LocalContext.Capability.CTExponent, ResponseSize, Response);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Abandon the response waiting for an asynchronous signature, if any.
+
+  The session created by a pending KEY_EXCHANGE is freed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmResponderCancelPendingSignature (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_PENDING_SIGNATURE      *PendingSignature;
+
+  PendingSignature = &SpdmContext->PendingSignature;
+  if (!PendingSignature->Valid) {
+    return ;
+  }
+  DEBUG((DEBUG_INFO, "SpdmResponderCancelPendingSignature - 0x%02x\n", PendingSignature->RequestCode));
+  if (PendingSignature->RequestCode == SPDM_KEY_EXCHANGE) {
+    SpdmFreeSessionId (SpdmContext, PendingSignature->SessionId);
+  }
+  if (PendingSignature->DHEContext != NULL) {
+    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, PendingSignature->DHEContext);
+    PendingSignature->DHEContext = NULL;
+  }
+  PendingSignature->Valid = FALSE;
+  PendingSignature->YieldPoint = 0;
+  ZeroMem (PendingSignature->Response, PendingSignature->ResponseSize);
+}
+
+/**
+  Ask the registered SPDM_RESPONDER_YIELD_FUNC whether the request yields after a step.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  YieldPoint                   The step just completed.
+
+  @retval TRUE                         The request yields.
+  @retval FALSE                        The request continues, or no yield function is registered.
+**/
+BOOLEAN
+SpdmResponderShouldYield (
+  IN     SPDM_DEVICE_CONTEXT         *SpdmContext,
+  IN     UINT8                       RequestCode,
+  IN     SPDM_RESPONDER_YIELD_POINT  YieldPoint
+  )
+{
+  SPDM_RESPONDER_YIELD_FUNC   YieldFunc;
+
+  YieldFunc = (SPDM_RESPONDER_YIELD_FUNC)SpdmContext->ResponderYieldFunc;
+  if (YieldFunc == NULL) {
+    return FALSE;
+  }
+  return YieldFunc (SpdmContext, RequestCode, YieldPoint);
+}
+
+/**
+  Keep a partially built response of a yielded request and return the ResponseNotReady error response instead.
+
+  The request is continued after YieldPoint by the RESPOND_IF_READY request.
+  The caller keeps the state of the request that is not in the response in SpdmContext->PendingSignature.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  YieldPoint                   The step just completed.
+  @param  SessionId                    The SessionId of the session created by the request, or INVALID_SESSION_ID.
+  @param  ResponseSize                 On input, the size in bytes of the partially built response.
+                                       On output, the size in bytes of the ResponseNotReady error response.
+  @param  Response                     On input, the partially built response.
+                                       On output, the ResponseNotReady error response.
+
+  @retval RETURN_SUCCESS               The ResponseNotReady error response is returned.
+**/
+RETURN_STATUS
+SpdmResponderYield (
+  IN     SPDM_DEVICE_CONTEXT         *SpdmContext,
+  IN     UINT8                       RequestCode,
+  IN     SPDM_RESPONDER_YIELD_POINT  YieldPoint,
+  IN     UINT32                      SessionId,
+  IN OUT UINTN                       *ResponseSize,
+  IN OUT VOID                        *Response
+  )
+{
+  SPDM_PENDING_SIGNATURE      *PendingSignature;
+
+  PendingSignature = &SpdmContext->PendingSignature;
+  ASSERT (*ResponseSize <= SpdmContext->MaxSpdmMessageSize);
+
+  DEBUG((DEBUG_INFO, "SpdmResponderYield - 0x%02x after %d\n", RequestCode, YieldPoint));
+  PendingSignature->Valid           = TRUE;
+  PendingSignature->RequestCode     = RequestCode;
+  PendingSignature->SessionId       = SessionId;
+  PendingSignature->SignatureOffset = 0;
+  PendingSignature->YieldPoint      = (UINT8)YieldPoint;
+  PendingSignature->ResponseSize    = *ResponseSize;
+  CopyMem (PendingSignature->Response, Response, *ResponseSize);
+
+  //
+  // The next step takes about the crypto timeout.
+  //
+  SpdmResponderGenerateResponseNotReady (SpdmContext, RequestCode, SpdmContext->LocalContext.Capability.CTExponent, ResponseSize, Response);
+  return RETURN_SUCCESS;
+}
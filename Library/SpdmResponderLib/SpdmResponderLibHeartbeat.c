@@ -9,6 +9,7 @@
 
 #include "SpdmResponderLibInternal.h"
 
+#if OPENSPDM_HBEAT_CAP_SUPPORT == 1
 /**
   Process the SPDM HEARTBEAT request and return the response.
 
@@ -90,3 +91,4 @@ SpdmGetResponseHeartbeat (
   return RETURN_SUCCESS;
 }
 
+#endif
@@ -66,6 +66,287 @@ SpdmResponderHandleResponseState (
      OUT VOID                 *Response
   );
 
+/**
+  Build the ResponseNotReady error response for a request.
+
+  A new token is taken and recorded with the request code for the following RESPOND_IF_READY.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  RDTExponent                  The exponent of the estimated time to complete the request.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+  @param  Response                     A pointer to the response data.
+**/
+VOID
+SpdmResponderGenerateResponseNotReady (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                RequestCode,
+  IN     UINT8                RDTExponent,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  );
+
+/**
+  Keep a response waiting for an asynchronous signature and return the ResponseNotReady error response instead.
+
+  The response is completed by the RESPOND_IF_READY request once the signing is done.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  SessionId                    The SessionId of the session created by the request, or INVALID_SESSION_ID.
+  @param  SignatureOffset              The offset in bytes of the signature in the response.
+  @param  ResponseSize                 On input, the size in bytes of the response waiting for the signature.
+                                       On output, the size in bytes of the ResponseNotReady error response.
+  @param  Response                     On input, the response waiting for the signature.
+                                       On output, the ResponseNotReady error response.
+
+  @retval RETURN_SUCCESS               The ResponseNotReady error response is returned.
+**/
+RETURN_STATUS
+SpdmResponderDeferSignature (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                RequestCode,
+  IN     UINT32               SessionId,
+  IN     UINTN                SignatureOffset,
+  IN OUT UINTN                *ResponseSize,
+  IN OUT VOID                 *Response
+  );
+
+/**
+  Abandon the response waiting for an asynchronous signature, if any.
+
+  The session created by a pending KEY_EXCHANGE is freed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmResponderCancelPendingSignature (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  Ask the registered SPDM_RESPONDER_YIELD_FUNC whether the request yields after a step.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  YieldPoint                   The step just completed.
+
+  @retval TRUE                         The request yields.
+  @retval FALSE                        The request continues, or no yield function is registered.
+**/
+BOOLEAN
+SpdmResponderShouldYield (
+  IN     SPDM_DEVICE_CONTEXT         *SpdmContext,
+  IN     UINT8                       RequestCode,
+  IN     SPDM_RESPONDER_YIELD_POINT  YieldPoint
+  );
+
+/**
+  Keep a partially built response of a yielded request and return the ResponseNotReady error response instead.
+
+  The request is continued after YieldPoint by the RESPOND_IF_READY request.
+  The caller keeps the state of the request that is not in the response in SpdmContext->PendingSignature.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  YieldPoint                   The step just completed.
+  @param  SessionId                    The SessionId of the session created by the request, or INVALID_SESSION_ID.
+  @param  ResponseSize                 On input, the size in bytes of the partially built response.
+                                       On output, the size in bytes of the ResponseNotReady error response.
+  @param  Response                     On input, the partially built response.
+                                       On output, the ResponseNotReady error response.
+
+  @retval RETURN_SUCCESS               The ResponseNotReady error response is returned.
+**/
+RETURN_STATUS
+SpdmResponderYield (
+  IN     SPDM_DEVICE_CONTEXT         *SpdmContext,
+  IN     UINT8                       RequestCode,
+  IN     SPDM_RESPONDER_YIELD_POINT  YieldPoint,
+  IN     UINT32                      SessionId,
+  IN OUT UINTN                       *ResponseSize,
+  IN OUT VOID                        *Response
+  );
+
+typedef struct {
+  SPDM_RATE_LIMIT                        RateLimit;
+  SPDM_RESPONDER_RATE_LIMITER_LOCK_FUNC  AcquireLock;
+  SPDM_RESPONDER_RATE_LIMITER_LOCK_FUNC  ReleaseLock;
+  VOID                                   *LockContext;
+} SPDM_RESPONDER_RATE_LIMITER;
+
+typedef struct {
+  SPDM_DEVICE_CONTEXT                    *SpdmContext;
+  UINT32                                 SessionId;
+  UINT8                                  Request[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                                  RequestSize;
+  UINT8                                  Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+} SPDM_RESPONDER_WORKER;
+
+//
+// An entry of the request validation table, checked by SpdmResponderRejectMalformedRequest.
+// CheckStateFirst is set if the handler checks the connection state before the capabilities.
+//
+typedef struct {
+  UINT8                                  RequestCode;
+  UINT16                                 MinRequestSize;
+  SPDM_CONNECTION_STATE                  MinConnectionState;
+  BOOLEAN                                SessionOnly;
+  BOOLEAN                                CheckStateFirst;
+  UINT32                                 RequesterCapabilitiesFlag;
+  UINT32                                 ResponderCapabilitiesFlag;
+  UINT8                                  ErrorCode;
+  UINT8                                  ErrorData;
+} SPDM_REQUEST_VALIDATION_STRUCT;
+
+extern SPDM_REQUEST_VALIDATION_STRUCT  mRequestValidationStruct[];
+extern UINTN                           mRequestValidationStructCount;
+
+/**
+  Reject a malformed request before it is dispatched, by the request validation table.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the request.
+  @param  ResponseSize                 Size in bytes of the response.
+  @param  Response                     A pointer to the response.
+
+  @retval TRUE   the request is rejected, and the ERROR is generated in the response.
+  @retval FALSE  the request is passed to its handler.
+**/
+BOOLEAN
+SpdmResponderRejectMalformedRequest (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     UINTN                   RequestSize,
+  IN     VOID                    *Request,
+  IN OUT UINTN                   *ResponseSize,
+     OUT VOID                    *Response
+  );
+
+/**
+  Return if the session of the last request has a scheduled key update.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @retval TRUE   The session of the last request has a scheduled key update.
+  @retval FALSE  The last request is not in a session, or its session has no scheduled key update.
+**/
+BOOLEAN
+SpdmIsKeyUpdateScheduled (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  Acquire the lock of an SPDM context in a responder, if the lock functions are registered.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmResponderLock (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  Release the lock of an SPDM context in a responder, if the lock functions are registered.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmResponderUnlock (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  Decide if a request is served now, by the admission control of the responder.
+
+  A request needing a signing or a DHE operation takes one from the budget of the peer
+  and of the registered rate limiter, if it is served.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Request                      A pointer to the request data.
+
+  @retval TRUE   the request is served.
+  @retval FALSE  the request is answered with ERROR(Busy).
+**/
+BOOLEAN
+SpdmResponderAdmitRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request
+  );
+
+/**
+  Return the time for the responder statistics, with the time function registered by SpdmRegisterResponderAdmissionFunc.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the time, in 100ns units, or 0 if the responder statistics are not collected or no time function is registered.
+**/
+UINT64
+SpdmResponderStatsGetTime (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  Add the time from StartTime to the crypto time of the request being processed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StartTime                    The time the crypto operation starts, from SpdmResponderStatsGetTime.
+**/
+VOID
+SpdmResponderStatsAddCryptoTime (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT64               StartTime
+  );
+
+/**
+  Add the time from StartTime to the callback time of the request being processed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StartTime                    The time the callback starts, from SpdmResponderStatsGetTime.
+**/
+VOID
+SpdmResponderStatsAddCallbackTime (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT64               StartTime
+  );
+
+/**
+  Start the responder statistics of a request being processed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the time the request is processed, from SpdmResponderStatsGetTime.
+**/
+UINT64
+SpdmResponderStatsBeginRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  Record an SPDM request and its response in the responder statistics.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StartTime                    The time the request is processed, from SpdmResponderStatsBeginRequest.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the request.
+  @param  ResponseSize                 Size in bytes of the response.
+  @param  Response                     A pointer to the response.
+**/
+VOID
+SpdmResponderStatsRecordResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT64               StartTime,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN     VOID                 *Response
+  );
+
 /**
   Process the SPDM RESPONSE_IF_READY request and return the response.
 
@@ -309,6 +590,55 @@ SpdmGetResponseKeyExchange (
      OUT VOID                 *Response
   );
 
+/**
+  Complete the KEY_EXCHANGE_RSP after its signature is generated.
+
+  The signature is appended to the session transcript, the handshake keys are derived and the
+  ResponderVerifyData is generated. On failure the session is freed and an error response is returned.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SessionId of the session created by the KEY_EXCHANGE request.
+  @param  SignatureOffset              The offset in bytes of the signature in the response.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+  @param  Response                     A pointer to the KEY_EXCHANGE_RSP with the signature.
+
+  @retval RETURN_SUCCESS               The response is returned.
+**/
+RETURN_STATUS
+SpdmResponderCompleteKeyExchangeRsp (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINTN                SignatureOffset,
+  IN OUT UINTN                *ResponseSize,
+  IN OUT VOID                 *Response
+  );
+
+/**
+  Continue a KEY_EXCHANGE yielded by SPDM_RESPONDER_YIELD_FUNC.
+
+  The state of the KEY_EXCHANGE is taken from SpdmContext->PendingSignature.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  YieldPoint                   The step the KEY_EXCHANGE yielded after.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of the partially built KEY_EXCHANGE_RSP.
+                                       On output, it means the size in bytes of the response.
+  @param  Response                     On input, the partially built KEY_EXCHANGE_RSP.
+                                       On output, the response.
+
+  @retval RETURN_SUCCESS               The response is returned.
+**/
+RETURN_STATUS
+SpdmResponderResumeKeyExchange (
+  IN     SPDM_DEVICE_CONTEXT         *SpdmContext,
+  IN     SPDM_RESPONDER_YIELD_POINT  YieldPoint,
+  IN OUT UINTN                       *ResponseSize,
+  IN OUT VOID                        *Response
+  );
+
 /**
   Process the SPDM FINISH request and return the response.
 
@@ -471,6 +801,51 @@ SpdmGetResponseKeyUpdate (
      OUT VOID                 *Response
   );
 
+/**
+  Process the SPDM CHUNK_GET request and return the response.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Request                      A pointer to the request data.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+  @param  Response                     A pointer to the response data.
+
+  @retval RETURN_SUCCESS               The request is processed and the response is returned.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetResponseChunkGet (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  );
+
+/**
+  Keep a response larger than the transport maximum message size to be retrieved by CHUNK_GET,
+  and replace it by ERROR(LargeResponse).
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The session ID of the response, or NULL if it is not a secured message.
+  @param  ResponseSize                 On input, the size in bytes of the response.
+                                       On output, the size in bytes of the response to send.
+  @param  Response                     A pointer to the response.
+**/
+VOID
+SpdmResponderHoldLargeResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN OUT UINTN                *ResponseSize,
+  IN OUT VOID                 *Response
+  );
+
 /**
   Process the SPDM ENCAPSULATED_REQUEST request and return the response.
 
@@ -705,6 +1080,25 @@ SpdmGetResponseFuncViaRequestCode (
   IN     UINT8                    RequestCode
   );
 
+/**
+  Return the registered handler of a request.
+
+  A VENDOR_DEFINED_REQUEST is routed by its standard ID and vendor ID first.
+  Other requests, and the VENDOR_DEFINED_REQUEST without a matching vendor handler, are routed by the request code.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the request.
+
+  @return the registered handler of the request, or NULL if no handler is registered for it.
+**/
+SPDM_GET_RESPONSE_FUNC
+SpdmGetRegisteredRequestHandler (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     UINTN                   RequestSize,
+  IN     VOID                    *Request
+  );
+
 /**
   This function initializes the mut_auth encapsulated state.
 
@@ -748,6 +1142,50 @@ SpdmHandleEncapErrorResponseMain (
   IN     UINT8                ErrorCode
   );
 
+/**
+  Post a state transition to the state event queue, to be dispatched by SpdmDispatchStateEvents.
+
+  If the queue is full, the transition is dropped and counted.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsSessionEvent               TRUE for a session state, FALSE for a connection state.
+  @param  SessionId                    The SessionId of the session, for a session state.
+  @param  State                        The new SPDM_SESSION_STATE or SPDM_CONNECTION_STATE.
+**/
+VOID
+SpdmPostStateEvent (
+  IN     SPDM_DEVICE_CONTEXT      *SpdmContext,
+  IN     BOOLEAN                  IsSessionEvent,
+  IN     UINT32                   SessionId,
+  IN     UINT32                   State
+  );
+
+/**
+  Notify the session state to a session APP.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SessionId of a session.
+  @param  SessionState                 The state of a session.
+**/
+VOID
+SpdmTriggerSessionStateCallback (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     SPDM_SESSION_STATE   SessionState
+  );
+
+/**
+  Notify the connection state to an SPDM context register.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  ConnectionState              Indicate the SPDM connection state.
+**/
+VOID
+SpdmTriggerConnectionStateCallback (
+  IN     SPDM_DEVICE_CONTEXT      *SpdmContext,
+  IN     SPDM_CONNECTION_STATE    ConnectionState
+  );
+
 /**
   Set SessionState to an SPDM secured message context and trigger callback.
 
@@ -774,4 +1212,63 @@ SpdmSetConnectionState (
   IN     SPDM_CONNECTION_STATE    ConnectionState
   );
 
+/**
+  Return the heartbeat period to return in KEY_EXCHANGE_RSP or PSK_EXCHANGE_RSP.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the heartbeat period in seconds, or 0 if HBEAT_CAP is not supported.
+**/
+UINT8
+SpdmGetResponderHeartbeatPeriod (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  );
+
+/**
+  Record that a request of a session is received, so that the session is not idle.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of the session.
+**/
+VOID
+SpdmResponderTouchSession (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     SPDM_SESSION_INFO    *SessionInfo
+  );
+
+/**
+  Make a session slot available for a KEY_EXCHANGE or PSK_EXCHANGE, by the session lifecycle policy.
+
+  The expired sessions are ended first, and then the least recently used idle sessions are evicted.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code, KEY_EXCHANGE or PSK_EXCHANGE.
+  @param  Privileged                   Return if the requester is privileged.
+
+  @retval TRUE   A session slot is free for the requester.
+  @retval FALSE  No session slot may be used by the requester.
+**/
+BOOLEAN
+SpdmResponderReserveSessionSlot (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                RequestCode,
+     OUT BOOLEAN              *Privileged
+  );
+
+/**
+  Initialize the lifecycle of a session created by KEY_EXCHANGE or PSK_EXCHANGE.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of the session.
+  @param  Privileged                   The session is created by a privileged requester.
+  @param  HeartbeatPeriod              The heartbeat period returned in the response.
+**/
+VOID
+SpdmResponderInitSessionLifecycle (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     SPDM_SESSION_INFO    *SessionInfo,
+  IN     BOOLEAN              Privileged,
+  IN     UINT8                HeartbeatPeriod
+  );
+
 #endif
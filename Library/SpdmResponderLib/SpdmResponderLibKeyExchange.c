@@ -9,6 +9,170 @@
 
 #include "SpdmResponderLibInternal.h"
 
+/**
+  Keep the state of a KEY_EXCHANGE yielded after YieldPoint and return the ResponseNotReady error response.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  YieldPoint                   The step just completed.
+  @param  SessionId                    The SessionId of the session created by the KEY_EXCHANGE request.
+  @param  MeasurementHashType          MeasurementHashType of the KEY_EXCHANGE request.
+  @param  SlotNum                      The slot number of the certificate chain.
+  @param  DHEContext                   The DHE context of the responder key pair, or NULL once the shared secret is computed.
+  @param  PeerExchangeData             The ExchangeData of the KEY_EXCHANGE request.
+  @param  ResponseSize                 On input, the size in bytes of the partially built KEY_EXCHANGE_RSP.
+                                       On output, the size in bytes of the ResponseNotReady error response.
+  @param  Response                     On input, the partially built KEY_EXCHANGE_RSP.
+                                       On output, the ResponseNotReady error response.
+
+  @retval RETURN_SUCCESS               The ResponseNotReady error response is returned.
+**/
+STATIC
+RETURN_STATUS
+SpdmResponderYieldKeyExchange (
+  IN     SPDM_DEVICE_CONTEXT         *SpdmContext,
+  IN     SPDM_RESPONDER_YIELD_POINT  YieldPoint,
+  IN     UINT32                      SessionId,
+  IN     UINT8                       MeasurementHashType,
+  IN     UINT8                       SlotNum,
+  IN     VOID                        *DHEContext,
+  IN     CONST UINT8                 *PeerExchangeData,
+  IN OUT UINTN                       *ResponseSize,
+  IN OUT VOID                        *Response
+  )
+{
+  SPDM_PENDING_SIGNATURE        *PendingSignature;
+
+  PendingSignature = &SpdmContext->PendingSignature;
+  PendingSignature->MeasurementHashType = MeasurementHashType;
+  PendingSignature->SlotNum = SlotNum;
+  PendingSignature->DHEContext = DHEContext;
+  if (DHEContext != NULL) {
+    CopyMem (PendingSignature->PeerExchangeData, PeerExchangeData, GetSpdmDhePubKeySize (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup));
+  }
+  return SpdmResponderYield (SpdmContext, SPDM_KEY_EXCHANGE, YieldPoint, SessionId, ResponseSize, Response);
+}
+
+/**
+  Build the KEY_EXCHANGE_RSP from the step after YieldPoint.
+
+  The response asks SPDM_RESPONDER_YIELD_FUNC whether to yield after each step.
+  On failure the session is freed and an error response is returned.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  YieldPoint                   The last step completed.
+  @param  SessionId                    The SessionId of the session created by the KEY_EXCHANGE request.
+  @param  MeasurementHashType          MeasurementHashType of the KEY_EXCHANGE request.
+  @param  SlotNum                      The slot number of the certificate chain.
+  @param  DHEContext                   The DHE context of the responder key pair, if YieldPoint is SpdmResponderYieldPointDheKeyGenerated.
+                                       It is freed on all paths.
+  @param  PeerExchangeData             The ExchangeData of the KEY_EXCHANGE request, if YieldPoint is SpdmResponderYieldPointDheKeyGenerated.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of the partially built KEY_EXCHANGE_RSP.
+                                       On output, it means the size in bytes of the response.
+  @param  Response                     On input, the partially built KEY_EXCHANGE_RSP.
+                                       On output, the response.
+
+  @retval RETURN_SUCCESS               The response is returned.
+**/
+STATIC
+RETURN_STATUS
+SpdmResponderContinueKeyExchange (
+  IN     SPDM_DEVICE_CONTEXT         *SpdmContext,
+  IN     SPDM_RESPONDER_YIELD_POINT  YieldPoint,
+  IN     UINT32                      SessionId,
+  IN     UINT8                       MeasurementHashType,
+  IN     UINT8                       SlotNum,
+  IN     VOID                        *DHEContext,
+  IN     CONST UINT8                 *PeerExchangeData,
+  IN OUT UINTN                       *ResponseSize,
+  IN OUT VOID                        *Response
+  )
+{
+  SPDM_KEY_EXCHANGE_RESPONSE    *SpdmResponse;
+  SPDM_SESSION_INFO             *SessionInfo;
+  UINTN                         DheKeySize;
+  UINT8                         *Ptr;
+  BOOLEAN                       Result;
+  RETURN_STATUS                 Status;
+  UINTN                         FieldParam[SPDM_MESSAGE_PARAM_COUNT];
+  SPDM_MESSAGE_FIELD_VIEW       ResponseView[SPDM_KEY_EXCHANGE_RSP_FIELD_COUNT];
+  UINT64                        StartTime;
+
+  SpdmResponse = Response;
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  ASSERT (SessionInfo != NULL);
+
+  SpdmGetMessageFieldParam (SpdmContext, FALSE, MeasurementHashType, FieldParam);
+  DheKeySize = FieldParam[SPDM_MESSAGE_PARAM_DHE_KEY_SIZE];
+  ResponseView[SPDM_KEY_EXCHANGE_RSP_FIELD_OPAQUE_DATA].Size = SpdmGetOpaqueDataVersionSelectionDataSize (SpdmContext);
+  Status = SpdmLayoutMessage (mSpdmKeyExchangeRspLayout, SPDM_KEY_EXCHANGE_RSP_FIELD_COUNT, FieldParam, Response, *ResponseSize, ResponseView, ResponseSize);
+  ASSERT_RETURN_ERROR(Status);
+
+  if (YieldPoint < SpdmResponderYieldPointDheSecretComputed) {
+    StartTime = SpdmResponderStatsGetTime (SpdmContext);
+    Result = SpdmSecuredMessageDheComputeKey (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext, PeerExchangeData, DheKeySize, SessionInfo->SecuredMessageContext);
+    SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
+    SpdmResponderStatsAddCryptoTime (SpdmContext, StartTime);
+    if (!Result) {
+      SpdmFreeSessionId (SpdmContext, SessionId);
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+      return RETURN_SUCCESS;
+    }
+    if (SpdmResponderShouldYield (SpdmContext, SPDM_KEY_EXCHANGE, SpdmResponderYieldPointDheSecretComputed)) {
+      return SpdmResponderYieldKeyExchange (SpdmContext, SpdmResponderYieldPointDheSecretComputed, SessionId, MeasurementHashType, SlotNum, NULL, NULL, ResponseSize, Response);
+    }
+  }
+
+  Ptr = ResponseView[SPDM_KEY_EXCHANGE_RSP_FIELD_SIGNATURE].Data;
+  if (YieldPoint < SpdmResponderYieldPointSigned) {
+    StartTime = SpdmResponderStatsGetTime (SpdmContext);
+    Result = SpdmGenerateMeasurementSummaryHash (SpdmContext, FALSE, MeasurementHashType, ResponseView[SPDM_KEY_EXCHANGE_RSP_FIELD_MEASUREMENT_SUMMARY_HASH].Data);
+    SpdmResponderStatsAddCallbackTime (SpdmContext, StartTime);
+    if (!Result) {
+      SpdmFreeSessionId (SpdmContext, SessionId);
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+      return RETURN_SUCCESS;
+    }
+
+    Status = SpdmBuildOpaqueDataVersionSelectionData (SpdmContext, &ResponseView[SPDM_KEY_EXCHANGE_RSP_FIELD_OPAQUE_DATA].Size, ResponseView[SPDM_KEY_EXCHANGE_RSP_FIELD_OPAQUE_DATA].Data);
+    ASSERT_RETURN_ERROR(Status);
+
+    if (SlotNum == 0xFF) {
+      //
+      // The TH covers the provisioned public key in place of the certificate chain.
+      //
+      SpdmContext->ConnectionInfo.LocalUsedCertChainBuffer = NULL;
+      SpdmContext->ConnectionInfo.LocalUsedCertChainBufferSize = 0;
+    } else {
+      SpdmContext->ConnectionInfo.LocalUsedCertChainBuffer = SpdmContext->LocalContext.LocalCertChainProvision[SlotNum];
+      SpdmContext->ConnectionInfo.LocalUsedCertChainBufferSize = SpdmContext->LocalContext.LocalCertChainProvisionSize[SlotNum];
+    }
+
+    Status = SpdmAppendMessageK (SessionInfo, SpdmResponse, (UINTN)Ptr - (UINTN)SpdmResponse);
+    if (RETURN_ERROR(Status)) {
+      SpdmFreeSessionId (SpdmContext, SessionId);
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+      return RETURN_SUCCESS;
+    }
+    StartTime = SpdmResponderStatsGetTime (SpdmContext);
+    Status = SpdmGenerateKeyExchangeRspSignature (SpdmContext, SessionInfo, Ptr);
+    SpdmResponderStatsAddCallbackTime (SpdmContext, StartTime);
+    if (Status == RETURN_NOT_READY) {
+      return SpdmResponderDeferSignature (SpdmContext, SPDM_KEY_EXCHANGE, SessionId, (UINTN)Ptr - (UINTN)SpdmResponse, ResponseSize, Response);
+    }
+    if (RETURN_ERROR(Status)) {
+      SpdmFreeSessionId (SpdmContext, SessionId);
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_KEY_EXCHANGE_RSP, ResponseSize, Response);
+      return RETURN_SUCCESS;
+    }
+    if (SpdmResponderShouldYield (SpdmContext, SPDM_KEY_EXCHANGE, SpdmResponderYieldPointSigned)) {
+      return SpdmResponderYieldKeyExchange (SpdmContext, SpdmResponderYieldPointSigned, SessionId, MeasurementHashType, SlotNum, NULL, NULL, ResponseSize, Response);
+    }
+  }
+
+  return SpdmResponderCompleteKeyExchangeRsp (SpdmContext, SessionId, (UINTN)Ptr - (UINTN)SpdmResponse, ResponseSize, Response);
+}
+
 /**
   Process the SPDM KEY_EXCHANGE request and return the response.
 
@@ -39,23 +203,20 @@ SpdmGetResponseKeyExchange (
   SPDM_KEY_EXCHANGE_REQUEST     *SpdmRequest;
   SPDM_KEY_EXCHANGE_RESPONSE    *SpdmResponse;
   UINTN                         DheKeySize;
-  UINT32                        MeasurementSummaryHashSize;
-  UINT32                        SignatureSize;
-  UINT32                        HmacSize;
   UINT8                         *Ptr;
-  UINT16                        OpaqueDataLength;
-  BOOLEAN                       Result;
   UINT8                         SlotNum;
   UINT32                        SessionId;
   VOID                          *DHEContext;
   SPDM_SESSION_INFO             *SessionInfo;
-  UINTN                         TotalSize;
   SPDM_DEVICE_CONTEXT           *SpdmContext;
   UINT16                        ReqSessionId;
   UINT16                        RspSessionId;
+  BOOLEAN                       Privileged;
   RETURN_STATUS                 Status;
-  UINTN                         OpaqueKeyExchangeRspSize;
-  UINT8                         TH1HashData[64];
+  UINTN                         FieldParam[SPDM_MESSAGE_PARAM_COUNT];
+  SPDM_MESSAGE_FIELD_VIEW       RequestView[SPDM_KEY_EXCHANGE_FIELD_COUNT];
+  SPDM_MESSAGE_FIELD_VIEW       ResponseView[SPDM_KEY_EXCHANGE_RSP_FIELD_COUNT];
+  UINT64                        StartTime;
 
   SpdmContext = Context;
   SpdmRequest = Request;
@@ -72,6 +233,7 @@ SpdmGetResponseKeyExchange (
     return RETURN_SUCCESS;
   }
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   if (SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MUT_AUTH_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MUT_AUTH_CAP)) {
     if (SpdmContext->EncapContext.ErrorState != SPDM_STATUS_SUCCESS) {
       DEBUG((DEBUG_INFO, "SpdmGetResponseKeyExchange fail due to Mutual Auth fail\n"));
@@ -79,6 +241,7 @@ SpdmGetResponseKeyExchange (
       return RETURN_SUCCESS;
     }
   }
+#endif
 
   SlotNum = SpdmRequest->Header.Param2;
   if ((SlotNum != 0xFF) && (SlotNum >= SpdmContext->LocalContext.SlotCount)) {
@@ -86,64 +249,42 @@ SpdmGetResponseKeyExchange (
     return RETURN_SUCCESS;
   }
 
-  if (SlotNum == 0xFF) {
+  if ((SlotNum == 0xFF) && (SpdmContext->LocalContext.LocalPublicKeyProvisionSize == 0)) {
     SlotNum = SpdmContext->LocalContext.ProvisionedSlotNum;
   }
 
-  SignatureSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
-  HmacSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
-  DheKeySize = GetSpdmDhePubKeySize (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup);
-  MeasurementSummaryHashSize = SpdmGetMeasurementSummaryHashSize (SpdmContext, FALSE, SpdmRequest->Header.Param1);
+  SpdmGetMessageFieldParam (SpdmContext, FALSE, SpdmRequest->Header.Param1, FieldParam);
+  DheKeySize = FieldParam[SPDM_MESSAGE_PARAM_DHE_KEY_SIZE];
 
-  if (RequestSize < sizeof(SPDM_KEY_EXCHANGE_REQUEST) +
-                    DheKeySize +
-                    sizeof(UINT16)) {
-    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
-    return RETURN_SUCCESS;
-  }
-  OpaqueDataLength = *(UINT16 *)((UINT8 *)Request + sizeof(SPDM_KEY_EXCHANGE_REQUEST) + DheKeySize);
-  if (RequestSize < sizeof(SPDM_KEY_EXCHANGE_REQUEST) +
-                    DheKeySize +
-                    sizeof(UINT16) +
-                    OpaqueDataLength) {
+  Status = SpdmParseMessage (mSpdmKeyExchangeLayout, SPDM_KEY_EXCHANGE_FIELD_COUNT, FieldParam, Request, RequestSize, RequestView, &RequestSize);
+  if (RETURN_ERROR(Status)) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
-  RequestSize = sizeof(SPDM_KEY_EXCHANGE_REQUEST) +
-                DheKeySize +
-                sizeof(UINT16) +
-                OpaqueDataLength;
 
-  Ptr = (UINT8 *)Request + sizeof(SPDM_KEY_EXCHANGE_REQUEST) + DheKeySize + sizeof(UINT16);
-  Status = SpdmProcessOpaqueDataSupportedVersionData (SpdmContext, OpaqueDataLength, Ptr);
+  Status = SpdmProcessOpaqueDataSupportedVersionData (SpdmContext, RequestView[SPDM_KEY_EXCHANGE_FIELD_OPAQUE_DATA].Size, RequestView[SPDM_KEY_EXCHANGE_FIELD_OPAQUE_DATA].Data);
   if (RETURN_ERROR(Status)) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
 
-  OpaqueKeyExchangeRspSize = SpdmGetOpaqueDataVersionSelectionDataSize (SpdmContext);
-
-  if (SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP)) {
-    HmacSize = 0;
-  }
-
-  TotalSize = sizeof(SPDM_KEY_EXCHANGE_RESPONSE) +
-              DheKeySize +
-              MeasurementSummaryHashSize +
-              sizeof(UINT16) +
-              OpaqueKeyExchangeRspSize +
-              SignatureSize +
-              HmacSize;
-
-  ASSERT (*ResponseSize >= TotalSize);
-  *ResponseSize = TotalSize;
-  ZeroMem (Response, *ResponseSize);
+  //
+  // Every field after the header is written in place, so only the header is zeroed.
+  //
+  ResponseView[SPDM_KEY_EXCHANGE_RSP_FIELD_OPAQUE_DATA].Size = SpdmGetOpaqueDataVersionSelectionDataSize (SpdmContext);
+  Status = SpdmLayoutMessage (mSpdmKeyExchangeRspLayout, SPDM_KEY_EXCHANGE_RSP_FIELD_COUNT, FieldParam, Response, *ResponseSize, ResponseView, ResponseSize);
+  ASSERT_RETURN_ERROR(Status);
+  ZeroMem (Response, sizeof(SPDM_KEY_EXCHANGE_RESPONSE));
   SpdmResponse = Response;
 
   SpdmResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
   SpdmResponse->Header.RequestResponseCode = SPDM_KEY_EXCHANGE_RSP;
-  SpdmResponse->Header.Param1 = 0;
+  SpdmResponse->Header.Param1 = SpdmGetResponderHeartbeatPeriod (SpdmContext);
 
+  if (!SpdmResponderReserveSessionSlot (SpdmContext, SPDM_KEY_EXCHANGE, &Privileged)) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_SESSION_LIMIT_EXCEEDED, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
   ReqSessionId = SpdmRequest->ReqSessionID;
   RspSessionId = SpdmAllocateRspSessionId (SpdmContext);
   if (RspSessionId == (INVALID_SESSION_ID & 0xFFFF)) {
@@ -156,6 +297,7 @@ SpdmGetResponseKeyExchange (
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_SESSION_LIMIT_EXCEEDED, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
+  SpdmResponderInitSessionLifecycle (SpdmContext, SessionInfo, Privileged, SpdmResponse->Header.Param1);
 
   Status = SpdmAppendMessageK (SessionInfo, Request, RequestSize);
   if (RETURN_ERROR(Status)) {
@@ -167,6 +309,8 @@ SpdmGetResponseKeyExchange (
   SpdmResponse->RspSessionID = RspSessionId;
 
   SpdmResponse->MutAuthRequested = 0;
+  SpdmResponse->ReqSlotIDParam = 0;
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   if (SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MUT_AUTH_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MUT_AUTH_CAP) &&
       (SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CERT_CAP, 0) ||
        SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_PUB_KEY_ID_CAP, 0))) {
@@ -175,60 +319,126 @@ SpdmGetResponseKeyExchange (
   if (SpdmResponse->MutAuthRequested != 0) {
     SpdmInitMutAuthEncapState (Context, SpdmResponse->MutAuthRequested);
     SpdmResponse->ReqSlotIDParam = (SpdmContext->EncapContext.ReqSlotNum & 0xF);
-  } else {
-    SpdmResponse->ReqSlotIDParam = 0;
   }
+#endif
 
-  SpdmGetRandomNumber (SPDM_RANDOM_DATA_SIZE, SpdmResponse->RandomData);
-
-  Ptr = (VOID *)(SpdmResponse + 1);
-  DHEContext = SpdmSecuredMessageDheNew (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup);
-  SpdmSecuredMessageDheGenerateKey (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext, Ptr, &DheKeySize);
-  DEBUG((DEBUG_INFO, "Calc SelfKey (0x%x):\n", DheKeySize));
-  InternalDumpHex (Ptr, DheKeySize);
-
-  DEBUG((DEBUG_INFO, "Calc PeerKey (0x%x):\n", DheKeySize));
-  InternalDumpHex ((UINT8 *)Request + sizeof(SPDM_KEY_EXCHANGE_REQUEST), DheKeySize);
+  SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, SPDM_RANDOM_DATA_SIZE, SpdmResponse->RandomData);
 
-  Result = SpdmSecuredMessageDheComputeKey (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext, (UINT8 *)Request + sizeof(SPDM_KEY_EXCHANGE_REQUEST), DheKeySize, SessionInfo->SecuredMessageContext);
-  SpdmSecuredMessageDheFree (SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, DHEContext);
-  if (!Result) {
+  Ptr = ResponseView[SPDM_KEY_EXCHANGE_RSP_FIELD_EXCHANGE_DATA].Data;
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
+  DHEContext = SpdmSecuredMessageDheNewFromPool (SpdmContext->DheKeyPool, SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup, Ptr, &DheKeySize);
+  if (DHEContext == NULL) {
+    SpdmResponderStatsAddCryptoTime (SpdmContext, StartTime);
     SpdmFreeSessionId (SpdmContext, SessionId);
-    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSPECIFIED, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
+  SpdmResponderStatsAddCryptoTime (SpdmContext, StartTime);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_KEY)) {
+    DEBUG((DEBUG_INFO, "Calc SelfKey (0x%x):\n", DheKeySize));
+    InternalDumpHex (Ptr, DheKeySize);
+  }
 
-  Ptr += DheKeySize;
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_KEY)) {
+    DEBUG((DEBUG_INFO, "Calc PeerKey (0x%x):\n", DheKeySize));
+    InternalDumpHex (RequestView[SPDM_KEY_EXCHANGE_FIELD_EXCHANGE_DATA].Data, DheKeySize);
+  }
 
-  Result = SpdmGenerateMeasurementSummaryHash (SpdmContext, FALSE, SpdmRequest->Header.Param1, Ptr);
-  if (!Result) {
-    SpdmFreeSessionId (SpdmContext, SessionId);
-    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
-    return RETURN_SUCCESS;
+  if (SpdmResponderShouldYield (SpdmContext, SPDM_KEY_EXCHANGE, SpdmResponderYieldPointDheKeyGenerated)) {
+    return SpdmResponderYieldKeyExchange (SpdmContext, SpdmResponderYieldPointDheKeyGenerated, SessionId, SpdmRequest->Header.Param1, SlotNum, DHEContext, RequestView[SPDM_KEY_EXCHANGE_FIELD_EXCHANGE_DATA].Data, ResponseSize, Response);
   }
-  Ptr += MeasurementSummaryHashSize;
+  return SpdmResponderContinueKeyExchange (SpdmContext, SpdmResponderYieldPointDheKeyGenerated, SessionId, SpdmRequest->Header.Param1, SlotNum, DHEContext, RequestView[SPDM_KEY_EXCHANGE_FIELD_EXCHANGE_DATA].Data, ResponseSize, Response);
+}
 
-  *(UINT16 *)Ptr = (UINT16)OpaqueKeyExchangeRspSize;
-  Ptr += sizeof(UINT16);
-  Status = SpdmBuildOpaqueDataVersionSelectionData (SpdmContext, &OpaqueKeyExchangeRspSize, Ptr);
-  ASSERT_RETURN_ERROR(Status);
-  Ptr += OpaqueKeyExchangeRspSize;
+/**
+  Continue a KEY_EXCHANGE yielded by SPDM_RESPONDER_YIELD_FUNC.
 
-  SpdmContext->ConnectionInfo.LocalUsedCertChainBuffer = SpdmContext->LocalContext.LocalCertChainProvision[SlotNum];
-  SpdmContext->ConnectionInfo.LocalUsedCertChainBufferSize = SpdmContext->LocalContext.LocalCertChainProvisionSize[SlotNum];
+  The state of the KEY_EXCHANGE is taken from SpdmContext->PendingSignature.
 
-  Status = SpdmAppendMessageK (SessionInfo, SpdmResponse, (UINTN)Ptr - (UINTN)SpdmResponse);
-  if (RETURN_ERROR(Status)) {
-    SpdmFreeSessionId (SpdmContext, SessionId);
-    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
-    return RETURN_SUCCESS;
-  }
-  Result = SpdmGenerateKeyExchangeRspSignature (SpdmContext, SessionInfo, Ptr);
-  if (!Result) {
-    SpdmFreeSessionId (SpdmContext, SessionId);
-    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_KEY_EXCHANGE_RSP, ResponseSize, Response);
-    return RETURN_SUCCESS;
-  }
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  YieldPoint                   The step the KEY_EXCHANGE yielded after.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of the partially built KEY_EXCHANGE_RSP.
+                                       On output, it means the size in bytes of the response.
+  @param  Response                     On input, the partially built KEY_EXCHANGE_RSP.
+                                       On output, the response.
+
+  @retval RETURN_SUCCESS               The response is returned.
+**/
+RETURN_STATUS
+SpdmResponderResumeKeyExchange (
+  IN     SPDM_DEVICE_CONTEXT         *SpdmContext,
+  IN     SPDM_RESPONDER_YIELD_POINT  YieldPoint,
+  IN OUT UINTN                       *ResponseSize,
+  IN OUT VOID                        *Response
+  )
+{
+  SPDM_PENDING_SIGNATURE        *PendingSignature;
+  VOID                          *DHEContext;
+
+  //
+  // The DHE context is owned by the continued KEY_EXCHANGE again.
+  //
+  PendingSignature = &SpdmContext->PendingSignature;
+  DHEContext = PendingSignature->DHEContext;
+  PendingSignature->DHEContext = NULL;
+
+  return SpdmResponderContinueKeyExchange (
+           SpdmContext,
+           YieldPoint,
+           PendingSignature->SessionId,
+           PendingSignature->MeasurementHashType,
+           PendingSignature->SlotNum,
+           DHEContext,
+           PendingSignature->PeerExchangeData,
+           ResponseSize,
+           Response
+           );
+}
+
+/**
+  Complete the KEY_EXCHANGE_RSP after its signature is generated.
+
+  The signature is appended to the session transcript, the handshake keys are derived and the
+  ResponderVerifyData is generated. On failure the session is freed and an error response is returned.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SessionId of the session created by the KEY_EXCHANGE request.
+  @param  SignatureOffset              The offset in bytes of the signature in the response.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+  @param  Response                     A pointer to the KEY_EXCHANGE_RSP with the signature.
+
+  @retval RETURN_SUCCESS               The response is returned.
+**/
+RETURN_STATUS
+SpdmResponderCompleteKeyExchangeRsp (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     UINTN                SignatureOffset,
+  IN OUT UINTN                *ResponseSize,
+  IN OUT VOID                 *Response
+  )
+{
+  SPDM_KEY_EXCHANGE_RESPONSE    *SpdmResponse;
+  SPDM_SESSION_INFO             *SessionInfo;
+  UINT32                        SignatureSize;
+  UINT32                        HmacSize;
+  UINT8                         *Ptr;
+  BOOLEAN                       Result;
+  RETURN_STATUS                 Status;
+  UINT8                         TH1HashData[64];
+  UINT64                        StartTime;
+
+  SpdmResponse = Response;
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  ASSERT (SessionInfo != NULL);
+
+  SignatureSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
+  HmacSize = GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo);
+  Ptr = (UINT8 *)Response + SignatureOffset;
 
   Status = SpdmAppendMessageK (SessionInfo, Ptr, SignatureSize);
   if (RETURN_ERROR(Status)) {
@@ -238,6 +448,7 @@ SpdmGetResponseKeyExchange (
   }
 
   DEBUG ((DEBUG_INFO, "SpdmGenerateSessionHandshakeKey[%x]\n", SessionId));
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
   Status = SpdmCalculateTH1Hash (SpdmContext, SessionInfo, FALSE, TH1HashData);
   if (RETURN_ERROR(Status)) {
     SpdmFreeSessionId (SpdmContext, SessionId);
@@ -245,6 +456,7 @@ SpdmGetResponseKeyExchange (
     return RETURN_SUCCESS;
   }
   Status = SpdmGenerateSessionHandshakeKey (SessionInfo->SecuredMessageContext, TH1HashData);
+  SpdmResponderStatsAddCryptoTime (SpdmContext, StartTime);
   if (RETURN_ERROR(Status)) {
     SpdmFreeSessionId (SpdmContext, SessionId);
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
@@ -9,6 +9,7 @@
 
 #include "SpdmResponderLibInternal.h"
 
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
 /**
   Process the SPDM KEY_UPDATE request and return the response.
 
@@ -92,6 +93,10 @@ SpdmGetResponseKeyUpdate (
 
     DEBUG ((DEBUG_INFO, "SpdmActivateUpdateSessionDataKey[%x] Responder new\n", SessionId));
     SpdmActivateUpdateSessionDataKey (SessionInfo->SecuredMessageContext, SpdmKeyUpdateActionResponder, TRUE);
+    //
+    // The responder DataKey is updated, so the scheduled key update is done.
+    //
+    SessionInfo->KeyUpdateScheduled = FALSE;
     break;
   case SPDM_KEY_UPDATE_OPERATIONS_TABLE_VERIFY_NEW_KEY:
     DEBUG ((DEBUG_INFO, "SpdmActivateUpdateSessionDataKey[%x] Requester new\n", SessionId));
@@ -115,3 +120,4 @@ SpdmGetResponseKeyUpdate (
   return RETURN_SUCCESS;
 }
 
+#endif
@@ -15,10 +15,10 @@
   @param  ResponseMessage              The measurement response message with empty signature to be filled.
   @param  ResponseMessageSize          Total size in bytes of the response message including signature.
 
-  @retval TRUE  measurement signature is created.
-  @retval FALSE measurement signature is not created.
+  @retval RETURN_SUCCESS               measurement signature is created.
+  @retval RETURN_DEVICE_ERROR          measurement signature is not created.
 **/
-BOOLEAN
+RETURN_STATUS
 SpdmCreateMeasurementSignature (
   IN     SPDM_DEVICE_CONTEXT    *SpdmContext,
   IN OUT VOID                   *ResponseMessage,
@@ -28,8 +28,8 @@ SpdmCreateMeasurementSignature (
   UINT8                         *Ptr;
   UINTN                         MeasurmentSigSize;
   UINTN                         SignatureSize;
-  BOOLEAN                       Result;
   RETURN_STATUS                 Status;
+  UINT64                        StartTime;
 
   SignatureSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
   MeasurmentSigSize = SPDM_NONCE_SIZE +
@@ -39,7 +39,7 @@ SpdmCreateMeasurementSignature (
   ASSERT (ResponseMessageSize > MeasurmentSigSize);
   Ptr = (VOID *)((UINT8 *)ResponseMessage + ResponseMessageSize - MeasurmentSigSize);
   
-  SpdmGetRandomNumber (SPDM_NONCE_SIZE, Ptr);
+  SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, SPDM_NONCE_SIZE, Ptr);
   Ptr += SPDM_NONCE_SIZE;
 
   *(UINT16 *)Ptr = (UINT16)SpdmContext->LocalContext.OpaqueMeasurementRspSize;
@@ -49,12 +49,13 @@ SpdmCreateMeasurementSignature (
 
   Status = SpdmAppendMessageM (SpdmContext, ResponseMessage, ResponseMessageSize - SignatureSize);
   if (RETURN_ERROR(Status)) {
-    return FALSE;
+    return RETURN_DEVICE_ERROR;
   }
 
-  Result = SpdmGenerateMeasurementSignature (SpdmContext, Ptr);
-
-  return Result;
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
+  Status = SpdmGenerateMeasurementSignature (SpdmContext, Ptr);
+  SpdmResponderStatsAddCallbackTime (SpdmContext, StartTime);
+  return Status;
 }
 
 /**
@@ -86,6 +87,169 @@ SpdmCreateMeasurementOpaque (
   return ;
 }
 
+/**
+  Build the MEASUREMENTS response from the blocks collected one by one with the measurement block iterator.
+
+  The blocks are collected straight into the response, instead of the measurement record kept in the SPDM context,
+  so their count and total size are bounded only by the response buffer. A response larger than the transport
+  maximum message size is then retrieved by CHUNK_GET.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SpdmRequest                  A pointer to the GET_MEASUREMENTS request.
+  @param  RequestSize                  Size in bytes of the request covered by the signature.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer.
+  @param  Response                     A pointer to the response data.
+
+  @retval RETURN_SUCCESS               The response is returned. It may be an ERROR response.
+**/
+RETURN_STATUS
+SpdmBuildMeasurementsFromIterator (
+  IN     SPDM_DEVICE_CONTEXT            *SpdmContext,
+  IN     SPDM_GET_MEASUREMENTS_REQUEST  *SpdmRequest,
+  IN     UINTN                          RequestSize,
+  IN OUT UINTN                          *ResponseSize,
+     OUT VOID                           *Response
+  )
+{
+  SPDM_MEASUREMENTS_RESPONSE     *SpdmResponse;
+  UINTN                          SpdmResponseSize;
+  RETURN_STATUS                  Status;
+  UINTN                          MeasurmentTailSize;
+  UINTN                          MeasurmentRecordSize;
+  UINTN                          MeasurmentBlockSize;
+  SPDM_MEASUREMENT_BLOCK_DMTF    *MeasurmentBlock;
+  UINT8                          DeviceMeasurementCount;
+  UINTN                          FirstIndex;
+  UINTN                          LastIndex;
+  UINTN                          Index;
+  UINT8                          SlotIdParam;
+  BOOLEAN                        GenerateSignature;
+  UINT64                         StartTime;
+
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
+  Status = SpdmCountMeasurementBlocks (SpdmContext, &DeviceMeasurementCount);
+  SpdmResponderStatsAddCallbackTime (SpdmContext, StartTime);
+  if (RETURN_ERROR(Status)) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNEXPECTED_REQUEST, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
+
+  //
+  // Cache
+  //
+  Status = SpdmAppendMessageM (SpdmContext, SpdmRequest, RequestSize);
+  if (RETURN_ERROR(Status)) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
+
+  switch (SpdmRequest->Header.Param2) {
+  case SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS:
+    FirstIndex = 1;
+    LastIndex = 0;
+    break;
+  case SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS:
+    FirstIndex = 1;
+    LastIndex = DeviceMeasurementCount;
+    break;
+  default:
+    if (SpdmRequest->Header.Param2 > DeviceMeasurementCount) {
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+      SpdmResetMessageM (SpdmContext);
+      return RETURN_SUCCESS;
+    }
+    FirstIndex = SpdmRequest->Header.Param2;
+    LastIndex = SpdmRequest->Header.Param2;
+    break;
+  }
+
+  GenerateSignature = (BOOLEAN)((SpdmRequest->Header.Param1 & SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE) != 0);
+  if (GenerateSignature) {
+    MeasurmentTailSize = SPDM_NONCE_SIZE +
+                         sizeof(UINT16) +
+                         SpdmContext->LocalContext.OpaqueMeasurementRspSize +
+                         GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
+  } else {
+    MeasurmentTailSize = sizeof(UINT16) +
+                         SpdmContext->LocalContext.OpaqueMeasurementRspSize;
+  }
+  ASSERT (*ResponseSize >= sizeof(SPDM_MEASUREMENTS_RESPONSE) + MeasurmentTailSize);
+
+  MeasurmentRecordSize = 0;
+  for (Index = FirstIndex; Index <= LastIndex; Index++) {
+    MeasurmentBlock = (VOID *)((UINT8 *)Response + sizeof(SPDM_MEASUREMENTS_RESPONSE) + MeasurmentRecordSize);
+    MeasurmentBlockSize = *ResponseSize - sizeof(SPDM_MEASUREMENTS_RESPONSE) - MeasurmentTailSize - MeasurmentRecordSize;
+    StartTime = SpdmResponderStatsGetTime (SpdmContext);
+    Status = SpdmIterateMeasurementBlock (SpdmContext, (UINT8)Index, MeasurmentBlock, &MeasurmentBlockSize);
+    SpdmResponderStatsAddCallbackTime (SpdmContext, StartTime);
+    if (RETURN_ERROR(Status)) {
+      // The record does not fit in the response, or the block is not collected.
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSPECIFIED, 0, ResponseSize, Response);
+      SpdmResetMessageM (SpdmContext);
+      return RETURN_SUCCESS;
+    }
+    if (FirstIndex == LastIndex) {
+      MeasurmentBlock->MeasurementBlockCommonHeader.Index = 1; // always set to 1, since we only have 1 block.
+    }
+    MeasurmentRecordSize += MeasurmentBlockSize;
+  }
+
+  SpdmResponseSize = sizeof(SPDM_MEASUREMENTS_RESPONSE) + MeasurmentRecordSize + MeasurmentTailSize;
+  ZeroMem ((UINT8 *)Response + sizeof(SPDM_MEASUREMENTS_RESPONSE) + MeasurmentRecordSize, MeasurmentTailSize);
+  *ResponseSize = SpdmResponseSize;
+  SpdmResponse = Response;
+
+  if (SpdmIsVersionSupported (SpdmContext, SPDM_MESSAGE_VERSION_11)) {
+    SpdmResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  } else {
+    SpdmResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+  }
+  SpdmResponse->Header.RequestResponseCode = SPDM_MEASUREMENTS;
+  if (SpdmRequest->Header.Param2 == SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_TOTAL_NUMBER_OF_MEASUREMENTS) {
+    SpdmResponse->Header.Param1 = DeviceMeasurementCount;
+    SpdmResponse->NumberOfBlocks = 0;
+  } else {
+    SpdmResponse->Header.Param1 = 0;
+    SpdmResponse->NumberOfBlocks = (UINT8)(LastIndex - FirstIndex + 1);
+  }
+  SpdmResponse->Header.Param2 = 0;
+  SpdmWriteUint24 (SpdmResponse->MeasurementRecordLength, (UINT32)MeasurmentRecordSize);
+
+  if (GenerateSignature) {
+    if (SpdmResponse->Header.SPDMVersion >= SPDM_MESSAGE_VERSION_11) {
+      SlotIdParam = SpdmRequest->SlotIDParam;
+      if ((SlotIdParam != 0xF) && (SlotIdParam >= SpdmContext->LocalContext.SlotCount)) {
+        SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+        SpdmResetMessageM (SpdmContext);
+        return RETURN_SUCCESS;
+      }
+      SpdmResponse->Header.Param2 = SlotIdParam;
+    }
+    Status = SpdmCreateMeasurementSignature (SpdmContext, SpdmResponse, SpdmResponseSize);
+    if (RETURN_ERROR(Status)) {
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_GET_MEASUREMENTS, ResponseSize, Response);
+      SpdmResetMessageM (SpdmContext);
+      return RETURN_SUCCESS;
+    }
+    //
+    // Reset
+    //
+    SpdmResetMessageM (SpdmContext);
+  } else {
+    SpdmCreateMeasurementOpaque (SpdmContext, SpdmResponse, SpdmResponseSize);
+    Status = SpdmAppendMessageM (SpdmContext, SpdmResponse, SpdmResponseSize);
+    if (RETURN_ERROR(Status)) {
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+      SpdmResetMessageM (SpdmContext);
+      return RETURN_SUCCESS;
+    }
+  }
+
+  return RETURN_SUCCESS;
+}
+
 /**
   Process the SPDM GET_MEASUREMENT request and return the response.
 
@@ -127,12 +291,13 @@ SpdmGetResponseMeasurement (
   SPDM_MEASUREMENT_BLOCK_DMTF    *CachedMeasurmentBlock;
   SPDM_DEVICE_CONTEXT            *SpdmContext;
   UINT8                          SlotIdParam;
-  UINT8                          DeviceMeasurement[MAX_SPDM_MEASUREMENT_RECORD_SIZE];
+  UINT8                          *DeviceMeasurement;
   UINT8                          DeviceMeasurementCount;
   UINTN                          DeviceMeasurementSize;
   BOOLEAN                        Ret;
   SPDM_SESSION_INFO              *SessionInfo;
   SPDM_SESSION_STATE             SessionState;
+  UINT64                         StartTime;
 
   SpdmContext = Context;
   SpdmRequest = Request;
@@ -195,14 +360,13 @@ SpdmGetResponseMeasurement (
     }
   }
 
-  DeviceMeasurementSize = sizeof(DeviceMeasurement);
-  Ret = SpdmMeasurementCollectionFunc (
-          SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec,
-          SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo,
-          &DeviceMeasurementCount,
-          DeviceMeasurement,
-          &DeviceMeasurementSize
-          );
+  if (SpdmContext->MeasurementBlockIteratorFunc != 0) {
+    return SpdmBuildMeasurementsFromIterator (SpdmContext, SpdmRequest, RequestSize, ResponseSize, Response);
+  }
+
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
+  Ret = SpdmGetMeasurementRecord (SpdmContext, &DeviceMeasurementCount, &DeviceMeasurement, &DeviceMeasurementSize);
+  SpdmResponderStatsAddCallbackTime (SpdmContext, StartTime);
   if (!Ret) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNEXPECTED_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
@@ -257,7 +421,7 @@ SpdmGetResponseMeasurement (
         SlotIdParam = SpdmRequest->SlotIDParam;
         if ((SlotIdParam != 0xF) && (SlotIdParam >= SpdmContext->LocalContext.SlotCount)) {
           SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
-          ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+          SpdmResetMessageM (SpdmContext);
           return RETURN_SUCCESS;
         }
         SpdmResponse->Header.Param2 = SlotIdParam;
@@ -265,7 +429,7 @@ SpdmGetResponseMeasurement (
       Status = SpdmCreateMeasurementSignature (SpdmContext, SpdmResponse, SpdmResponseSize);
       if (RETURN_ERROR(Status)) {
         SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_GET_MEASUREMENTS, ResponseSize, Response);
-        ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+        SpdmResetMessageM (SpdmContext);
         return RETURN_SUCCESS;
       }
     } else {
@@ -319,7 +483,7 @@ SpdmGetResponseMeasurement (
         SlotIdParam = SpdmRequest->SlotIDParam;
         if ((SlotIdParam != 0xF) && (SlotIdParam >= SpdmContext->LocalContext.SlotCount)) {
           SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
-          ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+          SpdmResetMessageM (SpdmContext);
           return RETURN_SUCCESS;
         }
         SpdmResponse->Header.Param2 = SlotIdParam;
@@ -327,7 +491,7 @@ SpdmGetResponseMeasurement (
       Status = SpdmCreateMeasurementSignature (SpdmContext, SpdmResponse, SpdmResponseSize);
       if (RETURN_ERROR(Status)) {
         SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_GET_MEASUREMENTS, ResponseSize, Response);
-        ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+        SpdmResetMessageM (SpdmContext);
         return RETURN_SUCCESS;
       }
     } else {
@@ -388,7 +552,7 @@ SpdmGetResponseMeasurement (
           SlotIdParam = SpdmRequest->SlotIDParam;
           if ((SlotIdParam != 0xF) && (SlotIdParam >= SpdmContext->LocalContext.SlotCount)) {
             SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
-            ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+            SpdmResetMessageM (SpdmContext);
             return RETURN_SUCCESS;
           }
           SpdmResponse->Header.Param2 = SlotIdParam;
@@ -396,7 +560,7 @@ SpdmGetResponseMeasurement (
         Status = SpdmCreateMeasurementSignature (SpdmContext, SpdmResponse, SpdmResponseSize);
         if (RETURN_ERROR(Status)) {
           SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_GET_MEASUREMENTS, ResponseSize, Response);
-          ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+          SpdmResetMessageM (SpdmContext);
           return RETURN_SUCCESS;
         }
       } else {
@@ -404,7 +568,7 @@ SpdmGetResponseMeasurement (
       }
     } else {
       SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
-      ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+      SpdmResetMessageM (SpdmContext);
       return RETURN_SUCCESS;
     }
     break;
@@ -413,12 +577,12 @@ SpdmGetResponseMeasurement (
     //
     // Reset
     //
-    ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+    SpdmResetMessageM (SpdmContext);
   } else {
     Status = SpdmAppendMessageM (SpdmContext, SpdmResponse, *ResponseSize);
     if (RETURN_ERROR(Status)) {
       SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
-      ResetManagedBuffer (&SpdmContext->Transcript.MessageM);
+      SpdmResetMessageM (SpdmContext);
       return RETURN_SUCCESS;
     }
   }
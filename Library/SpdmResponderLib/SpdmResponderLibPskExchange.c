@@ -9,6 +9,7 @@
 
 #include "SpdmResponderLibInternal.h"
 
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
 /**
   Process the SPDM PSK_EXCHANGE request and return the response.
 
@@ -49,12 +50,14 @@ SpdmGetResponsePskExchange (
   SPDM_DEVICE_CONTEXT           *SpdmContext;
   UINT16                        ReqSessionId;
   UINT16                        RspSessionId;
+  BOOLEAN                       Privileged;
   RETURN_STATUS                 Status;
   UINTN                         OpaquePskExchangeRspSize;
   UINT8                         TH1HashData[64];
   UINT8                         TH2HashData[64];
   UINT32                        AlgoSize;
   UINT16                        ResponderContextLength;
+  UINT64                        StartTime;
 
   SpdmContext = Context;
   SpdmRequest = Request;
@@ -97,6 +100,7 @@ SpdmGetResponsePskExchange (
     }
   }
 
+#if OPENSPDM_MUT_AUTH_CAP_SUPPORT == 1
   if (SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MUT_AUTH_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MUT_AUTH_CAP)) {
     if (SpdmContext->EncapContext.ErrorState != SPDM_STATUS_SUCCESS) {
       DEBUG((DEBUG_INFO, "SpdmGetResponsePskExchange fail due to Mutual Auth fail\n"));
@@ -104,6 +108,7 @@ SpdmGetResponsePskExchange (
       return RETURN_SUCCESS;
     }
   }
+#endif
 
   SlotNum = SpdmRequest->Header.Param2;
   if (SlotNum >= SpdmContext->LocalContext.SlotCount) {
@@ -156,8 +161,12 @@ SpdmGetResponsePskExchange (
 
   SpdmResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
   SpdmResponse->Header.RequestResponseCode = SPDM_PSK_EXCHANGE_RSP;
-  SpdmResponse->Header.Param1 = 0;
+  SpdmResponse->Header.Param1 = SpdmGetResponderHeartbeatPeriod (SpdmContext);
 
+  if (!SpdmResponderReserveSessionSlot (SpdmContext, SPDM_PSK_EXCHANGE, &Privileged)) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_SESSION_LIMIT_EXCEEDED, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
   ReqSessionId = SpdmRequest->ReqSessionID;
   RspSessionId = SpdmAllocateRspSessionId (SpdmContext);
   if (RspSessionId == (INVALID_SESSION_ID & 0xFFFF)) {
@@ -170,6 +179,7 @@ SpdmGetResponsePskExchange (
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_SESSION_LIMIT_EXCEEDED, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
+  SpdmResponderInitSessionLifecycle (SpdmContext, SessionInfo, Privileged, SpdmResponse->Header.Param1);
 
   Status = SpdmAppendMessageK (SessionInfo, Request, RequestSize);
   if (RETURN_ERROR(Status)) {
@@ -186,7 +196,9 @@ SpdmGetResponsePskExchange (
 
   Ptr = (VOID *)(SpdmResponse + 1);
   
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
   Result = SpdmGenerateMeasurementSummaryHash (SpdmContext, FALSE, SpdmRequest->Header.Param1, Ptr);
+  SpdmResponderStatsAddCallbackTime (SpdmContext, StartTime);
   if (!Result) {
     SpdmFreeSessionId (SpdmContext, SessionId);
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
@@ -195,7 +207,7 @@ SpdmGetResponsePskExchange (
   Ptr += MeasurementSummaryHashSize;
   
   if (ResponderContextLength != 0) {
-    SpdmGetRandomNumber (ResponderContextLength, Ptr);
+    SpdmRandomStreamGetBytes (&SpdmContext->RandomStream, ResponderContextLength, Ptr);
     Ptr += ResponderContextLength;
   }
 
@@ -211,6 +223,7 @@ SpdmGetResponsePskExchange (
   }
 
   DEBUG ((DEBUG_INFO, "SpdmGenerateSessionHandshakeKey[%x]\n", SessionId));
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
   Status = SpdmCalculateTH1Hash (SpdmContext, SessionInfo, FALSE, TH1HashData);
   if (RETURN_ERROR(Status)) {
     SpdmFreeSessionId (SpdmContext, SessionId);
@@ -218,6 +231,7 @@ SpdmGetResponsePskExchange (
     return RETURN_SUCCESS;
   }
   Status = SpdmGenerateSessionHandshakeKey (SessionInfo->SecuredMessageContext, TH1HashData);
+  SpdmResponderStatsAddCryptoTime (SpdmContext, StartTime);
   if (RETURN_ERROR(Status)) {
     SpdmFreeSessionId (SpdmContext, SessionId);
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
@@ -244,12 +258,14 @@ SpdmGetResponsePskExchange (
     // No need to receive PSK_FINISH, enter application phase directly.
 
     DEBUG ((DEBUG_INFO, "SpdmGenerateSessionDataKey[%x]\n", SessionId));
+    StartTime = SpdmResponderStatsGetTime (SpdmContext);
     Status = SpdmCalculateTH2Hash (SpdmContext, SessionInfo, FALSE, TH2HashData);
     if (RETURN_ERROR(Status)) {
       SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
       return RETURN_SUCCESS;
     }
     Status = SpdmGenerateSessionDataKey (SessionInfo->SecuredMessageContext, TH2HashData);
+    SpdmResponderStatsAddCryptoTime (SpdmContext, StartTime);
     if (RETURN_ERROR(Status)) {
       SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
       return RETURN_SUCCESS;
@@ -261,3 +277,4 @@ SpdmGetResponsePskExchange (
   return RETURN_SUCCESS;
 }
 
+#endif
@@ -9,6 +9,7 @@
 
 #include "SpdmResponderLibInternal.h"
 
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
 /**
   Process the SPDM PSK_FINISH request and return the response.
 
@@ -46,6 +47,7 @@ SpdmGetResponsePskFinish (
   SPDM_PSK_FINISH_REQUEST      *SpdmRequest;
   RETURN_STATUS                Status;
   SPDM_SESSION_STATE           SessionState;
+  UINT64                       StartTime;
 
   SpdmContext = Context;
   SpdmRequest = Request;
@@ -120,12 +122,14 @@ SpdmGetResponsePskFinish (
   }
 
   DEBUG ((DEBUG_INFO, "SpdmGenerateSessionDataKey[%x]\n", SessionId));
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
   Status = SpdmCalculateTH2Hash (SpdmContext, SessionInfo, FALSE, TH2HashData);
   if (RETURN_ERROR(Status)) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
   }
   Status = SpdmGenerateSessionDataKey (SessionInfo->SecuredMessageContext, TH2HashData);
+  SpdmResponderStatsAddCryptoTime (SpdmContext, StartTime);
   if (RETURN_ERROR(Status)) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
     return RETURN_SUCCESS;
@@ -133,3 +137,5 @@ SpdmGetResponsePskFinish (
 
   return RETURN_SUCCESS;
 }
+
+#endif
@@ -9,35 +9,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmResponderLibInternal.h"
 
-typedef struct {
-  UINT8                            RequestResponseCode;
-  SPDM_GET_SPDM_RESPONSE_FUNC      GetResponseFunc;
-} SPDM_GET_RESPONSE_STRUCT;
-
-SPDM_GET_RESPONSE_STRUCT  mSpdmGetResponseStruct[] = {
-  {SPDM_GET_VERSION,                    SpdmGetResponseVersion},
-  {SPDM_GET_CAPABILITIES,               SpdmGetResponseCapability},
-  {SPDM_NEGOTIATE_ALGORITHMS,           SpdmGetResponseAlgorithm},
-  {SPDM_GET_DIGESTS,                    SpdmGetResponseDigest},
-  {SPDM_GET_CERTIFICATE,                SpdmGetResponseCertificate},
-  {SPDM_CHALLENGE,                      SpdmGetResponseChallengeAuth},
-  {SPDM_GET_MEASUREMENTS,               SpdmGetResponseMeasurement},
-  {SPDM_KEY_EXCHANGE,                   SpdmGetResponseKeyExchange},
-  {SPDM_PSK_EXCHANGE,                   SpdmGetResponsePskExchange},
-  {SPDM_GET_ENCAPSULATED_REQUEST,       SpdmGetResponseEncapsulatedRequest},
-  {SPDM_DELIVER_ENCAPSULATED_RESPONSE,  SpdmGetResponseEncapsulatedResponseAck},
-  {SPDM_RESPOND_IF_READY,               SpdmGetResponseRespondIfReady},
-
-  {SPDM_FINISH,                         SpdmGetResponseFinish},
-  {SPDM_PSK_FINISH,                     SpdmGetResponsePskFinish},
-  {SPDM_END_SESSION,                    SpdmGetResponseEndSession},
-  {SPDM_HEARTBEAT,                      SpdmGetResponseHeartbeat},
-  {SPDM_KEY_UPDATE,                     SpdmGetResponseKeyUpdate},
-};
-
 /**
   Return the GET_SPDM_RESPONSE function via request code.
 
+  The switch is dense on the request codes, so that it is compiled to a jump table.
+
   @param  RequestCode                  The SPDM request code.
 
   @return GET_SPDM_RESPONSE function according to the request code.
@@ -47,17 +23,323 @@ SpdmGetResponseFuncViaRequestCode (
   IN     UINT8                    RequestCode
   )
 {
-  UINTN                Index;
-
   ASSERT(RequestCode != SPDM_RESPOND_IF_READY);
-  for (Index = 0; Index < sizeof(mSpdmGetResponseStruct)/sizeof(mSpdmGetResponseStruct[0]); Index++) {
-    if (RequestCode == mSpdmGetResponseStruct[Index].RequestResponseCode) {
-      return mSpdmGetResponseStruct[Index].GetResponseFunc;
+  switch (RequestCode) {
+  case SPDM_GET_VERSION:
+    return SpdmGetResponseVersion;
+  case SPDM_GET_CAPABILITIES:
+    return SpdmGetResponseCapability;
+  case SPDM_NEGOTIATE_ALGORITHMS:
+    return SpdmGetResponseAlgorithm;
+  case SPDM_GET_DIGESTS:
+    return SpdmGetResponseDigest;
+  case SPDM_GET_CERTIFICATE:
+    return SpdmGetResponseCertificate;
+  case SPDM_CHALLENGE:
+    return SpdmGetResponseChallengeAuth;
+  case SPDM_GET_MEASUREMENTS:
+    return SpdmGetResponseMeasurement;
+  case SPDM_KEY_EXCHANGE:
+    return SpdmGetResponseKeyExchange;
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
+  case SPDM_PSK_EXCHANGE:
+    return SpdmGetResponsePskExchange;
+#endif
+#if OPENSPDM_ENCAP_CAP_SUPPORT == 1
+  case SPDM_GET_ENCAPSULATED_REQUEST:
+    return SpdmGetResponseEncapsulatedRequest;
+  case SPDM_DELIVER_ENCAPSULATED_RESPONSE:
+    return SpdmGetResponseEncapsulatedResponseAck;
+#endif
+  case SPDM_RESPOND_IF_READY:
+    return SpdmGetResponseRespondIfReady;
+
+  case SPDM_FINISH:
+    return SpdmGetResponseFinish;
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
+  case SPDM_PSK_FINISH:
+    return SpdmGetResponsePskFinish;
+#endif
+  case SPDM_END_SESSION:
+    return SpdmGetResponseEndSession;
+#if OPENSPDM_HBEAT_CAP_SUPPORT == 1
+  case SPDM_HEARTBEAT:
+    return SpdmGetResponseHeartbeat;
+#endif
+#if OPENSPDM_KEY_UPD_CAP_SUPPORT == 1
+  case SPDM_KEY_UPDATE:
+    return SpdmGetResponseKeyUpdate;
+#endif
+  case SPDM_CHUNK_GET:
+    return SpdmGetResponseChunkGet;
+  default:
+    return NULL;
+  }
+}
+
+/**
+  Return the registered handler entry of a VENDOR_DEFINED_REQUEST, by its standard ID and vendor ID.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the VENDOR_DEFINED_REQUEST.
+
+  @return the registered handler entry of the request, or NULL if no handler is registered for it.
+**/
+SPDM_VENDOR_DEFINED_HANDLER *
+SpdmGetVendorDefinedHandler (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     UINTN                   RequestSize,
+  IN     VOID                    *Request
+  )
+{
+  SPDM_VENDOR_DEFINED_REQUEST_MSG    *VendorRequest;
+  SPDM_VENDOR_DEFINED_HANDLER        *VendorHandler;
+  UINTN                              Index;
+
+  if (RequestSize < sizeof(SPDM_VENDOR_DEFINED_REQUEST_MSG)) {
+    return NULL;
+  }
+  VendorRequest = Request;
+  if (RequestSize < sizeof(SPDM_VENDOR_DEFINED_REQUEST_MSG) + VendorRequest->Len) {
+    return NULL;
+  }
+  for (Index = 0; Index < MAX_SPDM_VENDOR_DEFINED_HANDLER_COUNT; Index++) {
+    VendorHandler = &SpdmContext->VendorDefinedHandler[Index];
+    if (((VendorHandler->GetResponseFunc != 0) || (VendorHandler->PayloadFunc != 0)) &&
+        (VendorHandler->StandardId == VendorRequest->StandardID) &&
+        (VendorHandler->VendorIdLen == VendorRequest->Len) &&
+        (CompareMem (VendorHandler->VendorId, VendorRequest + 1, VendorRequest->Len) == 0)) {
+      return VendorHandler;
     }
   }
   return NULL;
 }
 
+/**
+  Process a VENDOR_DEFINED_REQUEST with its registered payload handler.
+
+  The request payload is passed as a view into the request, and the response payload is built
+  right after the VENDOR_DEFINED_RESPONSE header in the response buffer.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Request                      A pointer to the request data.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer.
+  @param  Response                     A pointer to the response data.
+
+  @retval RETURN_SUCCESS               The request is processed and the response is returned.
+  @retval others                       The status of the payload handler.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmGetResponseVendorPayload (
+  IN     VOID                 *Context,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  SPDM_DEVICE_CONTEXT                *SpdmContext;
+  SPDM_VENDOR_DEFINED_HANDLER        *VendorHandler;
+  SPDM_VENDOR_DEFINED_REQUEST_MSG    *VendorRequest;
+  SPDM_VENDOR_DEFINED_RESPONSE_MSG   *VendorResponse;
+  UINTN                              HeaderSize;
+  UINT16                             RequestPayloadLength;
+  UINTN                              ResponsePayloadSize;
+  RETURN_STATUS                      Status;
+
+  SpdmContext = Context;
+  VendorHandler = SpdmGetVendorDefinedHandler (SpdmContext, RequestSize, Request);
+  ASSERT ((VendorHandler != NULL) && (VendorHandler->PayloadFunc != 0));
+
+  //
+  // VENDOR_DEFINED_REQUEST and VENDOR_DEFINED_RESPONSE share the same header, with the PayloadLength after the vendor ID.
+  //
+  VendorRequest = Request;
+  HeaderSize = sizeof(SPDM_VENDOR_DEFINED_REQUEST_MSG) + VendorRequest->Len + sizeof(UINT16);
+  if (RequestSize < HeaderSize) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
+  RequestPayloadLength = *(UINT16 *)((UINT8 *)Request + HeaderSize - sizeof(UINT16));
+  if (RequestPayloadLength > RequestSize - HeaderSize) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
+  ASSERT (*ResponseSize >= HeaderSize);
+
+  ResponsePayloadSize = MIN (*ResponseSize - HeaderSize, MAX_UINT16);
+  Status = ((SPDM_VENDOR_PAYLOAD_FUNC)VendorHandler->PayloadFunc) (
+             SpdmContext,
+             SessionId,
+             VendorRequest->StandardID,
+             VendorRequest->Len,
+             VendorRequest + 1,
+             RequestPayloadLength,
+             (UINT8 *)Request + HeaderSize,
+             &ResponsePayloadSize,
+             (UINT8 *)Response + HeaderSize
+             );
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  ASSERT (ResponsePayloadSize <= MIN (*ResponseSize - HeaderSize, MAX_UINT16));
+
+  VendorResponse = Response;
+  VendorResponse->Header.SPDMVersion = VendorRequest->Header.SPDMVersion;
+  VendorResponse->Header.RequestResponseCode = SPDM_VENDOR_DEFINED_RESPONSE;
+  VendorResponse->Header.Param1 = 0;
+  VendorResponse->Header.Param2 = 0;
+  VendorResponse->StandardID = VendorRequest->StandardID;
+  VendorResponse->Len = VendorRequest->Len;
+  CopyMem (VendorResponse + 1, VendorRequest + 1, VendorRequest->Len);
+  *(UINT16 *)((UINT8 *)Response + HeaderSize - sizeof(UINT16)) = (UINT16)ResponsePayloadSize;
+  *ResponseSize = HeaderSize + ResponsePayloadSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return the registered handler of a request.
+
+  A VENDOR_DEFINED_REQUEST is routed by its standard ID and vendor ID first.
+  Other requests, and the VENDOR_DEFINED_REQUEST without a matching vendor handler, are routed by the request code.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the request.
+
+  @return the registered handler of the request, or NULL if no handler is registered for it.
+**/
+SPDM_GET_RESPONSE_FUNC
+SpdmGetRegisteredRequestHandler (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     UINTN                   RequestSize,
+  IN     VOID                    *Request
+  )
+{
+  SPDM_VENDOR_DEFINED_HANDLER        *VendorHandler;
+  UINT8                              RequestCode;
+
+  RequestCode = ((SPDM_MESSAGE_HEADER *)Request)->RequestResponseCode;
+  if (RequestCode < SPDM_REQUEST_CODE_BASE) {
+    return NULL;
+  }
+  if (RequestCode == SPDM_VENDOR_DEFINED_REQUEST) {
+    VendorHandler = SpdmGetVendorDefinedHandler (SpdmContext, RequestSize, Request);
+    if (VendorHandler != NULL) {
+      if (VendorHandler->GetResponseFunc != 0) {
+        return (SPDM_GET_RESPONSE_FUNC)VendorHandler->GetResponseFunc;
+      }
+      return SpdmGetResponseVendorPayload;
+    }
+  }
+  return (SPDM_GET_RESPONSE_FUNC)SpdmContext->RequestHandler[RequestCode - SPDM_REQUEST_CODE_BASE];
+}
+
+//
+// The ErrorCode and ErrorData of each entry are the ERROR its handler generates for a missing capability.
+//
+SPDM_REQUEST_VALIDATION_STRUCT mRequestValidationStruct[] = {
+  {SPDM_GET_CAPABILITIES,     sizeof(SPDM_MESSAGE_HEADER),               SpdmConnectionStateAfterVersion,      FALSE, FALSE, 0,                                              0,                                               0,                                   0},
+  {SPDM_NEGOTIATE_ALGORITHMS, sizeof(SPDM_NEGOTIATE_ALGORITHMS_REQUEST), SpdmConnectionStateAfterCapabilities, FALSE, FALSE, 0,                                              0,                                               0,                                   0},
+  {SPDM_GET_DIGESTS,          sizeof(SPDM_GET_DIGESTS_REQUEST),          SpdmConnectionStateNegotiated,        FALSE, FALSE, 0,                                              SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP,    SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_GET_DIGESTS},
+  {SPDM_GET_CERTIFICATE,      sizeof(SPDM_GET_CERTIFICATE_REQUEST),      SpdmConnectionStateNegotiated,        FALSE, TRUE,  0,                                              SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP,    SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_GET_CERTIFICATE},
+  {SPDM_CHALLENGE,            sizeof(SPDM_CHALLENGE_REQUEST),            SpdmConnectionStateNegotiated,        FALSE, FALSE, 0,                                              SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP,    SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_CHALLENGE},
+  {SPDM_GET_MEASUREMENTS,     sizeof(SPDM_MESSAGE_HEADER),               SpdmConnectionStateNegotiated,        FALSE, FALSE, 0,                                              SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP,    SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_GET_MEASUREMENTS},
+  {SPDM_KEY_EXCHANGE,         sizeof(SPDM_KEY_EXCHANGE_REQUEST),         SpdmConnectionStateNegotiated,        FALSE, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP,  SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP,  SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_KEY_EXCHANGE},
+  {SPDM_FINISH,               sizeof(SPDM_FINISH_REQUEST),               SpdmConnectionStateNegotiated,        FALSE, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP,  SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP,  SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_KEY_EXCHANGE},
+  {SPDM_PSK_EXCHANGE,         sizeof(SPDM_PSK_EXCHANGE_REQUEST),         SpdmConnectionStateNegotiated,        FALSE, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_PSK_CAP,     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP,     SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_PSK_EXCHANGE},
+  {SPDM_PSK_FINISH,           sizeof(SPDM_PSK_FINISH_REQUEST),           SpdmConnectionStateNegotiated,        TRUE,  FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_PSK_CAP,     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP,     SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_PSK_EXCHANGE},
+  {SPDM_HEARTBEAT,            sizeof(SPDM_HEARTBEAT_REQUEST),            SpdmConnectionStateNegotiated,        TRUE,  FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP,   SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP,   SPDM_ERROR_CODE_UNEXPECTED_REQUEST,  0},
+  {SPDM_KEY_UPDATE,           sizeof(SPDM_KEY_UPDATE_REQUEST),           SpdmConnectionStateNegotiated,        TRUE,  FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_UPD_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_UPD_CAP, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_KEY_UPDATE},
+  {SPDM_END_SESSION,          sizeof(SPDM_END_SESSION_REQUEST),          SpdmConnectionStateNegotiated,        TRUE,  FALSE, 0,                                              0,                                               0,                                   0},
+  {SPDM_CHUNK_GET,            sizeof(SPDM_CHUNK_GET_REQUEST),            SpdmConnectionStateNotStarted,        FALSE, FALSE, 0,                                              0,                                               0,                                   0},
+};
+
+UINTN mRequestValidationStructCount = ARRAY_SIZE(mRequestValidationStruct);
+
+/**
+  Reject a malformed request before it is dispatched, by the request validation table.
+
+  It runs at dispatch time, after the transport layer has decoded the request into LastSpdmRequest.
+  The SPDM version is checked against the negotiated versions first, which the handlers do not do.
+  The capabilities, the connection state, the session and the request size are then checked
+  in the order of the request handlers, so that in a negotiated connection the rejected request
+  gets the ERROR its handler would generate.
+  A request without an entry in the table is left to its handler.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the request.
+  @param  ResponseSize                 Size in bytes of the response.
+  @param  Response                     A pointer to the response.
+
+  @retval TRUE   the request is rejected, and the ERROR is generated in the response.
+  @retval FALSE  the request is passed to its handler.
+**/
+BOOLEAN
+SpdmResponderRejectMalformedRequest (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     UINTN                   RequestSize,
+  IN     VOID                    *Request,
+  IN OUT UINTN                   *ResponseSize,
+     OUT VOID                    *Response
+  )
+{
+  SPDM_MESSAGE_HEADER                *SpdmRequest;
+  SPDM_REQUEST_VALIDATION_STRUCT     *Validation;
+  UINTN                              Index;
+
+  SpdmRequest = Request;
+  Validation = NULL;
+  for (Index = 0; Index < ARRAY_SIZE(mRequestValidationStruct); Index++) {
+    if (mRequestValidationStruct[Index].RequestCode == SpdmRequest->RequestResponseCode) {
+      Validation = &mRequestValidationStruct[Index];
+      break;
+    }
+  }
+  if (Validation == NULL) {
+    return FALSE;
+  }
+
+  if ((SpdmContext->ConnectionInfo.ConnectionState >= SpdmConnectionStateAfterVersion) &&
+      !SpdmIsVersionSupported (SpdmContext, SpdmRequest->SPDMVersion)) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_MAJOR_VERSION_MISMATCH, 0, ResponseSize, Response);
+    return TRUE;
+  }
+  if (Validation->CheckStateFirst &&
+      (SpdmContext->ConnectionInfo.ConnectionState < Validation->MinConnectionState)) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNEXPECTED_REQUEST, 0, ResponseSize, Response);
+    return TRUE;
+  }
+  if (((Validation->RequesterCapabilitiesFlag != 0) || (Validation->ResponderCapabilitiesFlag != 0)) &&
+      !SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, Validation->RequesterCapabilitiesFlag, Validation->ResponderCapabilitiesFlag)) {
+    SpdmGenerateErrorResponse (SpdmContext, Validation->ErrorCode, Validation->ErrorData, ResponseSize, Response);
+    return TRUE;
+  }
+  if (SpdmContext->ConnectionInfo.ConnectionState < Validation->MinConnectionState) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNEXPECTED_REQUEST, 0, ResponseSize, Response);
+    return TRUE;
+  }
+  if (Validation->SessionOnly && !SpdmContext->LastSpdmRequestSessionIdValid) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+    return TRUE;
+  }
+  if (RequestSize < Validation->MinRequestSize) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
+    return TRUE;
+  }
+  return FALSE;
+}
+
 /**
   Return the GET_SPDM_RESPONSE function via last request.
 
@@ -108,6 +390,7 @@ SpdmProcessRequest (
   UINT32                    *MessageSessionId;
 
   SpdmContext = Context;
+  SPDM_CRYPTO_STATS_BIND (SpdmContext);
 
   if (Request == NULL) {
     return RETURN_INVALID_PARAMETER;
@@ -118,10 +401,14 @@ SpdmProcessRequest (
 
   DEBUG((DEBUG_INFO, "SpdmReceiveRequest[.] ...\n"));
 
+  //
+  // The decoding is attributed to no request code, until the request code is known.
+  //
+  SPDM_ALLOCATION_TAG (0, SPDM_ALLOCATION_PHASE_RESPONDER);
   MessageSessionId = NULL;
   SpdmContext->LastSpdmRequestSessionIdValid = FALSE;
-  SpdmContext->LastSpdmRequestSize = sizeof(SpdmContext->LastSpdmRequest);
-  Status = SpdmContext->TransportDecodeMessage (SpdmContext, &MessageSessionId, IsAppMessage, TRUE, RequestSize, Request, &SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest);
+  SpdmContext->LastSpdmRequestSize = SpdmContext->MaxSpdmMessageSize;
+  Status = SpdmContext->TransportPath[SpdmContext->ReceiveTransportPath].TransportDecodeMessage (SpdmContext, &MessageSessionId, IsAppMessage, TRUE, RequestSize, Request, &SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest);
   if (RETURN_ERROR(Status)) {
     DEBUG((DEBUG_INFO, "TransportDecodeMessage : %p\n", Status));
     if (SpdmContext->LastSpdmError.ErrorCode != 0) {
@@ -148,10 +435,29 @@ SpdmProcessRequest (
     }
     SpdmContext->LastSpdmRequestSessionId = *MessageSessionId;
     SpdmContext->LastSpdmRequestSessionIdValid = TRUE;
+    SpdmResponderTouchSession (SpdmContext, SessionInfo);
   } 
 
-  DEBUG((DEBUG_INFO, "SpdmReceiveRequest[%x] (0x%x): \n", (MessageSessionId != NULL) ? *MessageSessionId : 0, SpdmContext->LastSpdmRequestSize));
-  InternalDumpHex ((UINT8 *)SpdmContext->LastSpdmRequest, SpdmContext->LastSpdmRequestSize);
+  SPDM_TRACEPOINT_CODEC (
+    decode,
+    (MessageSessionId != NULL) ? *MessageSessionId : INVALID_SESSION_ID,
+    SpdmContext->LastSpdmRequestSize,
+    RequestSize
+    );
+  if (!*IsAppMessage) {
+    SPDM_ALLOCATION_TAG (((SPDM_MESSAGE_HEADER *)SpdmContext->LastSpdmRequest)->RequestResponseCode, SPDM_ALLOCATION_PHASE_RESPONDER);
+  }
+  SPDM_TRACEPOINT_MESSAGE (
+    request_receive,
+    (MessageSessionId != NULL) ? *MessageSessionId : INVALID_SESSION_ID,
+    *IsAppMessage ? 0 : ((SPDM_MESSAGE_HEADER *)SpdmContext->LastSpdmRequest)->RequestResponseCode,
+    SpdmContext->LastSpdmRequestSize
+    );
+
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_WIRE)) {
+    DEBUG((DEBUG_INFO, "SpdmReceiveRequest[%x] (0x%x): \n", (MessageSessionId != NULL) ? *MessageSessionId : 0, SpdmContext->LastSpdmRequestSize));
+    InternalDumpHex ((UINT8 *)SpdmContext->LastSpdmRequest, SpdmContext->LastSpdmRequestSize);
+  }
 
   return RETURN_SUCCESS;
 }
@@ -182,6 +488,8 @@ SpdmTriggerSessionStateCallback (
 /**
   Set SessionState to an SPDM secured message context and trigger callback.
 
+  If the state event queue is enabled, the callbacks are called later by SpdmDispatchStateEvents.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicate the SPDM session ID.
   @param  SessionState                 Indicate the SPDM session state.
@@ -204,8 +512,13 @@ SpdmSetSessionState (
 
   OldSessionState = SpdmSecuredMessageGetSessionState (SessionInfo->SecuredMessageContext);
   if (OldSessionState != SessionState) {
+    SPDM_TRACEPOINT_SESSION_STATE (SessionInfo->SessionId, OldSessionState, SessionState);
     SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SessionState);
-    SpdmTriggerSessionStateCallback (SpdmContext, SessionInfo->SessionId, SessionState);
+    if (SpdmContext->StateEventQueue.Enabled) {
+      SpdmPostStateEvent (SpdmContext, TRUE, SessionInfo->SessionId, SessionState);
+    } else {
+      SpdmTriggerSessionStateCallback (SpdmContext, SessionInfo->SessionId, SessionState);
+    }
   }
 }
 
@@ -233,6 +546,8 @@ SpdmTriggerConnectionStateCallback (
 /**
   Set ConnectionState to an SPDM context and trigger callback.
 
+  If the state event queue is enabled, the callbacks are called later by SpdmDispatchStateEvents.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  ConnectionState              Indicate the SPDM connection state.
 */
@@ -244,8 +559,116 @@ SpdmSetConnectionState (
 {
   if (SpdmContext->ConnectionInfo.ConnectionState != ConnectionState) {
     SpdmContext->ConnectionInfo.ConnectionState = ConnectionState;
-    SpdmTriggerConnectionStateCallback (SpdmContext, ConnectionState);
+    if (SpdmContext->StateEventQueue.Enabled) {
+      SpdmPostStateEvent (SpdmContext, FALSE, 0, ConnectionState);
+    } else {
+      SpdmTriggerConnectionStateCallback (SpdmContext, ConnectionState);
+    }
+  }
+}
+
+/**
+  Build the response to a HEARTBEAT or an END_SESSION in an established session, without the request dispatch.
+
+  Both requests have no payload, and their ACK is a bare header. The request is accepted only if its handler
+  would return the ACK, so the result is the same as the normal path: the ACK is written at the headroom of
+  the transport message and encoded in place, without the response staging buffer or the handler lookup.
+  Any other case, including a request handler registered for the request code, takes the normal path.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of the session of the request.
+  @param  ResponseSize                 Size in bytes of the response data buffer.
+  @param  Response                     A pointer to a destination buffer to store the response.
+  @param  Status                       The status of the encoding, if the response is built.
+
+  @retval TRUE   The response is built, or its encoding failed with Status.
+  @retval FALSE  The request takes the normal path.
+**/
+BOOLEAN
+SpdmBuildSessionControlResponse (
+  IN     SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN     SPDM_SESSION_INFO       *SessionInfo,
+  IN OUT UINTN                   *ResponseSize,
+     OUT VOID                    *Response,
+     OUT RETURN_STATUS           *Status
+  )
+{
+  SPDM_MESSAGE_HEADER               *SpdmRequest;
+  SPDM_MESSAGE_HEADER               *SpdmResponse;
+  SPDM_MESSAGE_HEADER               LocalResponse;
+  UINT8                             RequestCode;
+  UINT32                            SessionId;
+  UINTN                             Headroom;
+  UINTN                             Tailroom;
+  UINT64                            StartTime;
+
+  SpdmRequest = (VOID *)SpdmContext->LastSpdmRequest;
+  RequestCode = SpdmRequest->RequestResponseCode;
+  if (((RequestCode != SPDM_HEARTBEAT) && (RequestCode != SPDM_END_SESSION)) ||
+      (SpdmContext->LastSpdmRequestSize != sizeof(SPDM_MESSAGE_HEADER))) {
+    return FALSE;
+  }
+  if ((SpdmContext->ResponseState != SpdmResponseStateNormal) ||
+      (SpdmContext->ConnectionInfo.ConnectionState < SpdmConnectionStateNegotiated) ||
+      !SpdmIsVersionSupported (SpdmContext, SpdmRequest->SPDMVersion) ||
+      (SpdmGetRegisteredRequestHandler (SpdmContext, SpdmContext->LastSpdmRequestSize, SpdmRequest) != NULL)) {
+    return FALSE;
+  }
+  if ((RequestCode == SPDM_HEARTBEAT) &&
+      !SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP)) {
+    return FALSE;
+  }
+  if (SpdmSecuredMessageGetSessionState (SessionInfo->SecuredMessageContext) != SpdmSessionStateEstablished) {
+    return FALSE;
+  }
+
+  SpdmResponderCancelPendingSignature (SpdmContext);
+  SpdmContext->LargeResponseSize = 0;
+
+  SpdmResponse = &LocalResponse;
+  if ((SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportGetMessageRoom != NULL) &&
+      !RETURN_ERROR(SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportGetMessageRoom (SpdmContext, &SessionInfo->SessionId, FALSE, &Headroom, &Tailroom)) &&
+      (*ResponseSize > Headroom + Tailroom + sizeof(SPDM_MESSAGE_HEADER))) {
+    SpdmResponse = (VOID *)((UINT8 *)Response + Headroom);
+  }
+
+  StartTime = SpdmResponderStatsBeginRequest (SpdmContext);
+  SpdmResponse->SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  if (RequestCode == SPDM_HEARTBEAT) {
+    SpdmResponse->RequestResponseCode = SPDM_HEARTBEAT_ACK;
+  } else {
+    SpdmResponse->RequestResponseCode = SPDM_END_SESSION_ACK;
+    SessionInfo->EndSessionAttributes = SpdmRequest->Param1;
+    if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, 0, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CACHE_CAP)) {
+      SessionInfo->EndSessionAttributes |= SPDM_END_SESSION_REQUEST_ATTRIBUTES_PRESERVE_NEGOTIATED_STATE_CLEAR;
+    }
+  }
+  SpdmResponse->Param1 = 0;
+  SpdmResponse->Param2 = 0;
+  SpdmResponderStatsRecordResponse (SpdmContext, StartTime, SpdmContext->LastSpdmRequestSize, SpdmRequest, sizeof(SPDM_MESSAGE_HEADER), SpdmResponse);
+
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_WIRE)) {
+    DEBUG((DEBUG_INFO, "SpdmSendResponse[%x] (0x%x): \n", SessionInfo->SessionId, sizeof(SPDM_MESSAGE_HEADER)));
+    InternalDumpHex ((UINT8 *)SpdmResponse, sizeof(SPDM_MESSAGE_HEADER));
   }
+
+  //
+  // The session info is freed after END_SESSION_ACK, so keep its SessionId.
+  //
+  SessionId = SessionInfo->SessionId;
+  SPDM_TRACEPOINT_MESSAGE (response_send, SessionId, RequestCode == SPDM_HEARTBEAT ? SPDM_HEARTBEAT_ACK : SPDM_END_SESSION_ACK, sizeof(SPDM_MESSAGE_HEADER));
+  *Status = SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportEncodeMessage (SpdmContext, &SessionId, FALSE, FALSE, sizeof(SPDM_MESSAGE_HEADER), SpdmResponse, ResponseSize, Response);
+  if (RETURN_ERROR(*Status)) {
+    DEBUG((DEBUG_INFO, "TransportEncodeMessage : %p\n", *Status));
+    return TRUE;
+  }
+  SPDM_TRACEPOINT_CODEC (encode, SessionId, sizeof(SPDM_MESSAGE_HEADER), *ResponseSize);
+
+  if (RequestCode == SPDM_END_SESSION) {
+    SpdmSetSessionState (SpdmContext, SessionId, SpdmSessionStateNotStarted);
+    SpdmFreeSessionId (SpdmContext, SessionId);
+  }
+  return TRUE;
 }
 
 /**
@@ -263,6 +686,7 @@ SpdmSetConnectionState (
 
   @retval RETURN_SUCCESS               The SPDM response is sent successfully.
   @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM response is sent to the device.
+  @retval RETURN_OUT_OF_RESOURCES      The scratch arena of the SPDM context is exhausted.
 **/
 RETURN_STATUS
 EFIAPI
@@ -275,22 +699,34 @@ SpdmBuildResponse (
   )
 {
   SPDM_DEVICE_CONTEXT               *SpdmContext;
-  UINT8                             MyResponse[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                             *MyResponseBuffer;
+  UINT8                             *MyResponse;
   UINTN                             MyResponseSize;
+  UINTN                             Headroom;
+  UINTN                             Tailroom;
   RETURN_STATUS                     Status;
   SPDM_GET_SPDM_RESPONSE_FUNC       GetResponseFunc;
+  SPDM_GET_RESPONSE_FUNC            RequestHandler;
   SPDM_SESSION_INFO                 *SessionInfo;
   SPDM_MESSAGE_HEADER               *SpdmRequest;
-  SPDM_MESSAGE_HEADER               *SpdmResponse;
+  SPDM_MESSAGE_HEADER               SpdmResponse;
+  BOOLEAN                           Admitted;
+  UINT64                            StartTime;
 
   SpdmContext = Context;
+  SPDM_CRYPTO_STATS_BIND (SpdmContext);
 
   if (SpdmContext->LastSpdmError.ErrorCode != 0) {
     //
     // Error in SpdmProcessRequest(), and we need send error message directly.
     //
-    MyResponseSize = sizeof(MyResponse);
-    ZeroMem (MyResponse, sizeof(MyResponse));
+    MyResponseBuffer = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    if (MyResponseBuffer == NULL) {
+      return RETURN_OUT_OF_RESOURCES;
+    }
+    MyResponse = MyResponseBuffer;
+    MyResponseSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    ZeroMem (MyResponse, MyResponseSize);
     switch (SpdmContext->LastSpdmError.ErrorCode) {
     case SPDM_ERROR_CODE_DECRYPT_ERROR:
       // session ID is valid. Use it to encrypt the error message.
@@ -303,17 +739,28 @@ SpdmBuildResponse (
       break;
     default:
       ASSERT(FALSE);
+      SpdmReleaseScratch (SpdmContext, MyResponseBuffer);
       return RETURN_UNSUPPORTED;
     }
     
-    DEBUG((DEBUG_INFO, "SpdmSendResponse[%x] (0x%x): \n", (SessionId != NULL) ? *SessionId : 0, MyResponseSize));
-    InternalDumpHex (MyResponse, MyResponseSize);
+    if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_WIRE)) {
+      DEBUG((DEBUG_INFO, "SpdmSendResponse[%x] (0x%x): \n", (SessionId != NULL) ? *SessionId : 0, MyResponseSize));
+      InternalDumpHex (MyResponse, MyResponseSize);
+    }
 
-    Status = SpdmContext->TransportEncodeMessage (SpdmContext, SessionId, FALSE, FALSE, MyResponseSize, MyResponse, ResponseSize, Response);
+    SPDM_TRACEPOINT_MESSAGE (
+      response_send,
+      (SessionId != NULL) ? *SessionId : INVALID_SESSION_ID,
+      SPDM_ERROR,
+      MyResponseSize
+      );
+    Status = SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportEncodeMessage (SpdmContext, SessionId, FALSE, FALSE, MyResponseSize, MyResponse, ResponseSize, Response);
+    SpdmReleaseScratch (SpdmContext, MyResponseBuffer);
     if (RETURN_ERROR(Status)) {
       DEBUG((DEBUG_INFO, "TransportEncodeMessage : %p\n", Status));
       return Status;
     }
+    SPDM_TRACEPOINT_CODEC (encode, (SessionId != NULL) ? *SessionId : INVALID_SESSION_ID, MyResponseSize, *ResponseSize);
 
     ZeroMem (&SpdmContext->LastSpdmError, sizeof(SpdmContext->LastSpdmError));
     return RETURN_SUCCESS;
@@ -343,17 +790,66 @@ SpdmBuildResponse (
   if (SpdmContext->LastSpdmRequestSize == 0) {
     return RETURN_NOT_READY;
   }
+  if ((SessionId != NULL) && !IsAppMessage &&
+      SpdmBuildSessionControlResponse (SpdmContext, SessionInfo, ResponseSize, Response, &Status)) {
+    return Status;
+  }
+  if (!IsAppMessage && (SpdmRequest->RequestResponseCode != SPDM_RESPOND_IF_READY)) {
+    SpdmResponderCancelPendingSignature (SpdmContext);
+  }
+  if (!IsAppMessage && (SpdmRequest->RequestResponseCode != SPDM_CHUNK_GET)) {
+    SpdmContext->LargeResponseSize = 0;
+  }
 
-  MyResponseSize = sizeof(MyResponse);
-  ZeroMem (MyResponse, sizeof(MyResponse));
+  //
+  // Build the response at the headroom of the transport message, so that the transport layer encodes it in place.
+  // Otherwise it is built in a buffer from the scratch arena.
+  //
+  MyResponseBuffer = NULL;
+  if ((SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportGetMessageRoom != NULL) &&
+      !RETURN_ERROR(SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportGetMessageRoom (SpdmContext, SessionId, IsAppMessage, &Headroom, &Tailroom)) &&
+      (*ResponseSize > Headroom + Tailroom)) {
+    MyResponse = (UINT8 *)Response + Headroom;
+    MyResponseSize = MIN (*ResponseSize - Headroom - Tailroom, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  } else {
+    MyResponseBuffer = SpdmAcquireScratch (SpdmContext, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    if (MyResponseBuffer == NULL) {
+      return RETURN_OUT_OF_RESOURCES;
+    }
+    MyResponse = MyResponseBuffer;
+    MyResponseSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  }
+  ZeroMem (MyResponse, MyResponseSize);
+  StartTime = SpdmResponderStatsBeginRequest (SpdmContext);
   GetResponseFunc = NULL;
-  if (!IsAppMessage) {
-    GetResponseFunc = SpdmGetResponseFuncViaLastRequest (SpdmContext);
-    if (GetResponseFunc != NULL) {
-      Status = GetResponseFunc (SpdmContext, SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest, &MyResponseSize, MyResponse);
+  RequestHandler = NULL;
+  if (!IsAppMessage && (SpdmContext->ResponseState == SpdmResponseStateNormal) &&
+      (SpdmGetRegisteredRequestHandler (SpdmContext, SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest) == NULL) &&
+      SpdmResponderRejectMalformedRequest (SpdmContext, SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest, &MyResponseSize, MyResponse)) {
+    //
+    // A malformed request is answered with ERROR, without the admission control and the handler.
+    //
+    Admitted = FALSE;
+    Status = RETURN_SUCCESS;
+  } else {
+    Admitted = IsAppMessage || SpdmResponderAdmitRequest (SpdmContext, SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest);
+    if (!Admitted) {
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_BUSY, 0, &MyResponseSize, MyResponse);
+      Status = RETURN_SUCCESS;
+    }
+  }
+  if (Admitted && !IsAppMessage) {
+    RequestHandler = SpdmGetRegisteredRequestHandler (SpdmContext, SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest);
+    if (RequestHandler != NULL) {
+      Status = RequestHandler (SpdmContext, SessionId, FALSE, SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest, &MyResponseSize, MyResponse);
+    } else {
+      GetResponseFunc = SpdmGetResponseFuncViaLastRequest (SpdmContext);
+      if (GetResponseFunc != NULL) {
+        Status = GetResponseFunc (SpdmContext, SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest, &MyResponseSize, MyResponse);
+      }
     }
   }
-  if (IsAppMessage || (GetResponseFunc == NULL)) {
+  if (Admitted && (IsAppMessage || ((RequestHandler == NULL) && (GetResponseFunc == NULL)))) {
     if (SpdmContext->GetResponseFunc != 0) {
       Status = ((SPDM_GET_RESPONSE_FUNC)SpdmContext->GetResponseFunc) (SpdmContext, SessionId, IsAppMessage, SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest, &MyResponseSize, MyResponse);
     } else {
@@ -363,19 +859,38 @@ SpdmBuildResponse (
   if (Status != RETURN_SUCCESS) {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SpdmRequest->RequestResponseCode, &MyResponseSize, MyResponse);
   }
+  if (!IsAppMessage) {
+    SpdmResponderStatsRecordResponse (SpdmContext, StartTime, SpdmContext->LastSpdmRequestSize, SpdmContext->LastSpdmRequest, MyResponseSize, MyResponse);
+    SpdmResponderHoldLargeResponse (SpdmContext, SessionId, &MyResponseSize, MyResponse);
+  }
 
-  DEBUG((DEBUG_INFO, "SpdmSendResponse[%x] (0x%x): \n", (SessionId != NULL) ? *SessionId : 0, MyResponseSize));
-  InternalDumpHex (MyResponse, MyResponseSize);
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_WIRE)) {
+    DEBUG((DEBUG_INFO, "SpdmSendResponse[%x] (0x%x): \n", (SessionId != NULL) ? *SessionId : 0, MyResponseSize));
+    InternalDumpHex (MyResponse, MyResponseSize);
+  }
 
-  Status = SpdmContext->TransportEncodeMessage (SpdmContext, SessionId, IsAppMessage, FALSE, MyResponseSize, MyResponse, ResponseSize, Response);
+  //
+  // Keep the response header, because an in place encoding encrypts it.
+  //
+  CopyMem (&SpdmResponse, MyResponse, sizeof(SpdmResponse));
+  SPDM_TRACEPOINT_MESSAGE (
+    response_send,
+    (SessionId != NULL) ? *SessionId : INVALID_SESSION_ID,
+    IsAppMessage ? 0 : SPDM_TRACEPOINT_MESSAGE_CODE (MyResponse, MyResponseSize),
+    MyResponseSize
+    );
+  Status = SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportEncodeMessage (SpdmContext, SessionId, IsAppMessage, FALSE, MyResponseSize, MyResponse, ResponseSize, Response);
+  if (MyResponseBuffer != NULL) {
+    SpdmReleaseScratch (SpdmContext, MyResponseBuffer);
+  }
   if (RETURN_ERROR(Status)) {
     DEBUG((DEBUG_INFO, "TransportEncodeMessage : %p\n", Status));
     return Status;
   }
+  SPDM_TRACEPOINT_CODEC (encode, (SessionId != NULL) ? *SessionId : INVALID_SESSION_ID, MyResponseSize, *ResponseSize);
 
-  SpdmResponse = (VOID *)MyResponse;
   if (SessionId != NULL) {
-    switch (SpdmResponse->RequestResponseCode) {
+    switch (SpdmResponse.RequestResponseCode) {
     case SPDM_FINISH_RSP:
       if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP)) {
         SpdmSetSessionState (SpdmContext, *SessionId, SpdmSessionStateEstablished);
@@ -390,7 +905,7 @@ SpdmBuildResponse (
       break;
     }
   } else {
-    switch (SpdmResponse->RequestResponseCode) {
+    switch (SpdmResponse.RequestResponseCode) {
     case SPDM_FINISH_RSP:
       if (SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP)) {
         SpdmSetSessionState (SpdmContext, SpdmContext->LatestSessionId, SpdmSessionStateEstablished);
@@ -426,6 +941,159 @@ SpdmRegisterGetResponseFunc (
   return ;
 }
 
+/**
+  Register the handler of an SPDM request code.
+
+  The handler takes precedence over the built-in handler of the request code and over the function
+  registered by SpdmRegisterGetResponseFunc. The request is dispatched to it directly by its request code.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+  @param  RequestHandler               The function to process the request, or NULL to restore the built-in handler.
+
+  @retval RETURN_SUCCESS               The handler is registered.
+  @retval RETURN_INVALID_PARAMETER     RequestCode is not a request code, or it is RESPOND_IF_READY.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRegisterRequestHandler (
+  IN  VOID                    *Context,
+  IN  UINT8                   RequestCode,
+  IN  SPDM_GET_RESPONSE_FUNC  RequestHandler
+  )
+{
+  SPDM_DEVICE_CONTEXT      *SpdmContext;
+
+  SpdmContext = Context;
+  if ((RequestCode < SPDM_REQUEST_CODE_BASE) || (RequestCode == SPDM_RESPOND_IF_READY)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  SpdmContext->RequestHandler[RequestCode - SPDM_REQUEST_CODE_BASE] = (UINTN)RequestHandler;
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Set the handler of the VENDOR_DEFINED_REQUEST of a standard ID and a vendor ID.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StandardId                   The standard ID of the request.
+  @param  VendorIdLen                  Size in bytes of the vendor ID.
+  @param  VendorId                     A pointer to the vendor ID.
+  @param  GetResponseFunc              The function to process the whole request.
+  @param  PayloadFunc                  The function to process the request payload.
+                                       If both are 0, the handler is unregistered.
+
+  @retval RETURN_SUCCESS               The handler is registered or unregistered.
+  @retval RETURN_INVALID_PARAMETER     VendorIdLen is larger than MAX_SPDM_VENDOR_ID_LENGTH.
+  @retval RETURN_NOT_FOUND             The handler to unregister is not registered.
+  @retval RETURN_ALREADY_STARTED       No enough memory to register the handler.
+**/
+RETURN_STATUS
+SpdmSetVendorDefinedHandler (
+  IN  SPDM_DEVICE_CONTEXT     *SpdmContext,
+  IN  UINT16                  StandardId,
+  IN  UINT8                   VendorIdLen,
+  IN  VOID                    *VendorId,
+  IN  UINTN                   GetResponseFunc,
+  IN  UINTN                   PayloadFunc
+  )
+{
+  SPDM_VENDOR_DEFINED_HANDLER  *VendorHandler;
+  UINTN                        Index;
+
+  if (VendorIdLen > MAX_SPDM_VENDOR_ID_LENGTH) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  for (Index = 0; Index < MAX_SPDM_VENDOR_DEFINED_HANDLER_COUNT; Index++) {
+    VendorHandler = &SpdmContext->VendorDefinedHandler[Index];
+    if (((VendorHandler->GetResponseFunc != 0) || (VendorHandler->PayloadFunc != 0)) &&
+        (VendorHandler->StandardId == StandardId) &&
+        (VendorHandler->VendorIdLen == VendorIdLen) &&
+        (CompareMem (VendorHandler->VendorId, VendorId, VendorIdLen) == 0)) {
+      VendorHandler->GetResponseFunc = GetResponseFunc;
+      VendorHandler->PayloadFunc = PayloadFunc;
+      return RETURN_SUCCESS;
+    }
+  }
+  if ((GetResponseFunc == 0) && (PayloadFunc == 0)) {
+    return RETURN_NOT_FOUND;
+  }
+  for (Index = 0; Index < MAX_SPDM_VENDOR_DEFINED_HANDLER_COUNT; Index++) {
+    VendorHandler = &SpdmContext->VendorDefinedHandler[Index];
+    if ((VendorHandler->GetResponseFunc == 0) && (VendorHandler->PayloadFunc == 0)) {
+      VendorHandler->StandardId = StandardId;
+      VendorHandler->VendorIdLen = VendorIdLen;
+      CopyMem (VendorHandler->VendorId, VendorId, VendorIdLen);
+      VendorHandler->GetResponseFunc = GetResponseFunc;
+      VendorHandler->PayloadFunc = PayloadFunc;
+      return RETURN_SUCCESS;
+    }
+  }
+
+  return RETURN_ALREADY_STARTED;
+}
+
+/**
+  Register the handler of the VENDOR_DEFINED_REQUEST of a standard ID and a vendor ID.
+
+  The handler takes precedence over the handler registered for the VENDOR_DEFINED_REQUEST request code.
+  Registering the same standard ID and vendor ID again overrides the handler.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StandardId                   The standard ID of the request.
+  @param  VendorIdLen                  Size in bytes of the vendor ID.
+  @param  VendorId                     A pointer to the vendor ID.
+  @param  RequestHandler               The function to process the request, or NULL to unregister the handler.
+
+  @retval RETURN_SUCCESS               The handler is registered or unregistered.
+  @retval RETURN_INVALID_PARAMETER     VendorIdLen is larger than MAX_SPDM_VENDOR_ID_LENGTH.
+  @retval RETURN_NOT_FOUND             The handler to unregister is not registered.
+  @retval RETURN_ALREADY_STARTED       No enough memory to register the handler.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRegisterVendorDefinedHandler (
+  IN  VOID                    *Context,
+  IN  UINT16                  StandardId,
+  IN  UINT8                   VendorIdLen,
+  IN  VOID                    *VendorId,
+  IN  SPDM_GET_RESPONSE_FUNC  RequestHandler
+  )
+{
+  return SpdmSetVendorDefinedHandler (Context, StandardId, VendorIdLen, VendorId, (UINTN)RequestHandler, 0);
+}
+
+/**
+  Register the payload handler of the VENDOR_DEFINED_REQUEST of a standard ID and a vendor ID.
+
+  It shares the table of SpdmRegisterVendorDefinedHandler. Registering the same standard ID and vendor ID
+  again, by either function, overrides the handler.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StandardId                   The standard ID of the request.
+  @param  VendorIdLen                  Size in bytes of the vendor ID.
+  @param  VendorId                     A pointer to the vendor ID.
+  @param  PayloadHandler               The function to process the request payload, or NULL to unregister the handler.
+
+  @retval RETURN_SUCCESS               The handler is registered or unregistered.
+  @retval RETURN_INVALID_PARAMETER     VendorIdLen is larger than MAX_SPDM_VENDOR_ID_LENGTH.
+  @retval RETURN_NOT_FOUND             The handler to unregister is not registered.
+  @retval RETURN_ALREADY_STARTED       No enough memory to register the handler.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmRegisterVendorPayloadHandler (
+  IN  VOID                      *Context,
+  IN  UINT16                    StandardId,
+  IN  UINT8                     VendorIdLen,
+  IN  VOID                      *VendorId,
+  IN  SPDM_VENDOR_PAYLOAD_FUNC  PayloadHandler
+  )
+{
+  return SpdmSetVendorDefinedHandler (Context, StandardId, VendorIdLen, VendorId, 0, (UINTN)PayloadHandler);
+}
+
 /**
   Register an SPDM session state callback function.
 
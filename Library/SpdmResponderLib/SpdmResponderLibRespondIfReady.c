@@ -9,6 +9,123 @@
 
 #include "SpdmResponderLibInternal.h"
 
+/**
+  Complete the response waiting for an asynchronous signature.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+  @param  Response                     A pointer to the response data.
+
+  @retval RETURN_SUCCESS               The completed response, or another ResponseNotReady error response, is returned.
+**/
+RETURN_STATUS
+SpdmResponderCompletePendingSignature (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  SPDM_PENDING_SIGNATURE                    *PendingSignature;
+  SPDM_RESPONDER_DATA_SIGN_POLL_FUNC        SignPollFunc;
+  SPDM_CHALLENGE_AUTH_RESPONSE_ATTRIBUTE    AuthAttribute;
+  UINTN                                     SignatureSize;
+  RETURN_STATUS                             Status;
+  UINT64                                    StartTime;
+
+  PendingSignature = &SpdmContext->PendingSignature;
+  SignPollFunc = (SPDM_RESPONDER_DATA_SIGN_POLL_FUNC)SpdmContext->ResponderDataSignPollFunc;
+  SignatureSize = GetSpdmAsymSignatureSize (SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo);
+  StartTime = SpdmResponderStatsGetTime (SpdmContext);
+  Status = SignPollFunc (SpdmContext, PendingSignature->SignToken, PendingSignature->Response + PendingSignature->SignatureOffset, &SignatureSize);
+  SpdmResponderStatsAddCallbackTime (SpdmContext, StartTime);
+  if (Status == RETURN_NOT_READY) {
+    SpdmResponderGenerateResponseNotReady (SpdmContext, PendingSignature->RequestCode, SpdmContext->LocalContext.Capability.CTExponent, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
+  if (RETURN_ERROR(Status)) {
+    DEBUG((DEBUG_INFO, "SpdmResponderCompletePendingSignature - %p\n", Status));
+    switch (PendingSignature->RequestCode) {
+    case SPDM_CHALLENGE:
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_CHALLENGE_AUTH, ResponseSize, Response);
+      break;
+    case SPDM_KEY_EXCHANGE:
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, SPDM_KEY_EXCHANGE_RSP, ResponseSize, Response);
+      break;
+    default:
+      SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, PendingSignature->RequestCode, ResponseSize, Response);
+      break;
+    }
+    SpdmResponderCancelPendingSignature (SpdmContext);
+    return RETURN_SUCCESS;
+  }
+
+  PendingSignature->Valid = FALSE;
+  ASSERT (*ResponseSize >= PendingSignature->ResponseSize);
+  *ResponseSize = PendingSignature->ResponseSize;
+  CopyMem (Response, PendingSignature->Response, PendingSignature->ResponseSize);
+  ZeroMem (PendingSignature->Response, PendingSignature->ResponseSize);
+
+  switch (PendingSignature->RequestCode) {
+  case SPDM_CHALLENGE:
+    CopyMem (&AuthAttribute, &((SPDM_MESSAGE_HEADER *)Response)->Param1, sizeof(AuthAttribute));
+    if (AuthAttribute.BasicMutAuthReq == 0) {
+      SpdmSetConnectionState (SpdmContext, SpdmConnectionStateAuthenticated);
+    }
+    break;
+  case SPDM_KEY_EXCHANGE:
+    return SpdmResponderCompleteKeyExchangeRsp (SpdmContext, PendingSignature->SessionId, PendingSignature->SignatureOffset, ResponseSize, Response);
+  default:
+    break;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Continue the request yielded by SPDM_RESPONDER_YIELD_FUNC.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+  @param  Response                     A pointer to the response data.
+
+  @retval RETURN_SUCCESS               The response, or another ResponseNotReady error response, is returned.
+**/
+STATIC
+RETURN_STATUS
+SpdmResponderResumeYield (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  SPDM_PENDING_SIGNATURE                    *PendingSignature;
+  SPDM_RESPONDER_YIELD_POINT                YieldPoint;
+
+  PendingSignature = &SpdmContext->PendingSignature;
+  YieldPoint = (SPDM_RESPONDER_YIELD_POINT)PendingSignature->YieldPoint;
+
+  PendingSignature->Valid = FALSE;
+  PendingSignature->YieldPoint = 0;
+  ASSERT (*ResponseSize >= PendingSignature->ResponseSize);
+  *ResponseSize = PendingSignature->ResponseSize;
+  CopyMem (Response, PendingSignature->Response, PendingSignature->ResponseSize);
+  ZeroMem (PendingSignature->Response, PendingSignature->ResponseSize);
+
+  switch (PendingSignature->RequestCode) {
+  case SPDM_KEY_EXCHANGE:
+    return SpdmResponderResumeKeyExchange (SpdmContext, YieldPoint, ResponseSize, Response);
+  default:
+    ASSERT (FALSE);
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSPECIFIED, 0, ResponseSize, Response);
+    return RETURN_SUCCESS;
+  }
+}
+
 /**
   Process the SPDM RESPONSE_IF_READY request and return the response.
 
@@ -67,6 +184,13 @@ SpdmGetResponseRespondIfReady (
     return RETURN_SUCCESS;
   }
 
+  if (SpdmContext->PendingSignature.Valid) {
+    if (SpdmContext->PendingSignature.YieldPoint != 0) {
+      return SpdmResponderResumeYield (SpdmContext, ResponseSize, Response);
+    }
+    return SpdmResponderCompletePendingSignature (SpdmContext, ResponseSize, Response);
+  }
+
   GetResponseFunc = NULL;
   GetResponseFunc = SpdmGetResponseFuncViaRequestCode(SpdmRequest->Param1);
   if (GetResponseFunc == NULL) {
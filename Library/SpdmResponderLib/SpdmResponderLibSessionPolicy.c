@@ -0,0 +1,344 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmResponderLibInternal.h"
+
+//
+// The heartbeat period is in seconds, and the responder time function returns 100ns units.
+//
+#define SPDM_HEARTBEAT_PERIOD_UNIT  10000000
+
+/**
+  Set the session lifecycle policy of a responder.
+
+  HeartbeatPeriod is returned in KEY_EXCHANGE_RSP and PSK_EXCHANGE_RSP if HBEAT_CAP is supported.
+  A session without any request for twice its heartbeat period, or for IdleTimeout, is expired.
+  The expired sessions are ended when a session slot is needed, or by SpdmReclaimExpiredSessions.
+  If no slot is free, the least recently used session idle for at least EvictIdleTime is evicted.
+  ReservedCount slots are kept for the privileged requesters: a requester which is not privileged
+  creates a session only if more than ReservedCount slots are free, and it evicts only sessions
+  which are not privileged. Without PrivilegeFunc, every requester is privileged.
+
+  The times are from the time function registered by SpdmRegisterResponderAdmissionFunc.
+  Without it, no session expires or is evicted. The ended sessions notify the session state callbacks
+  with SpdmSessionStateNotStarted. With responder workers, EvictIdleTime must be longer than
+  the time to handle an APP message, because the APP messages are handled without the lock.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Policy                       The session lifecycle policy.
+  @param  PrivilegeFunc                The function to decide if a requester is privileged, or NULL.
+**/
+VOID
+EFIAPI
+SpdmSetResponderSessionPolicy (
+  IN     VOID                                   *Context,
+  IN     CONST SPDM_RESPONDER_SESSION_POLICY    *Policy,
+  IN     SPDM_RESPONDER_SESSION_PRIVILEGE_FUNC  PrivilegeFunc OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT      *SpdmContext;
+
+  SpdmContext = Context;
+  CopyMem (&SpdmContext->ResponderSessionPolicy, Policy, sizeof(SPDM_RESPONDER_SESSION_POLICY));
+  SpdmContext->ResponderSessionPrivilegeFunc = (UINTN)PrivilegeFunc;
+  return ;
+}
+
+/**
+  Return the heartbeat period to return in KEY_EXCHANGE_RSP or PSK_EXCHANGE_RSP.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the heartbeat period in seconds, or 0 if HBEAT_CAP is not supported.
+**/
+UINT8
+SpdmGetResponderHeartbeatPeriod (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  if (!SpdmIsCapabilitiesFlagSupported(SpdmContext, FALSE, SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP)) {
+    return 0;
+  }
+  return SpdmContext->ResponderSessionPolicy.HeartbeatPeriod;
+}
+
+/**
+  Record that a request of a session is received, so that the session is not idle.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of the session.
+**/
+VOID
+SpdmResponderTouchSession (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     SPDM_SESSION_INFO    *SessionInfo
+  )
+{
+  if (SpdmContext->ResponderGetTimeFunc != 0) {
+    SessionInfo->LastActivityTime = ((SPDM_RESPONDER_GET_TIME_FUNC)SpdmContext->ResponderGetTimeFunc) (SpdmContext);
+  }
+}
+
+/**
+  Return the time since the last request of a session.
+
+  @param  SessionInfo                  The session info of the session.
+  @param  Now                          The current time.
+
+  @return the idle time of the session, in 100ns units.
+**/
+UINT64
+SpdmGetResponderSessionIdleTime (
+  IN     SPDM_SESSION_INFO    *SessionInfo,
+  IN     UINT64               Now
+  )
+{
+  if (Now < SessionInfo->LastActivityTime) {
+    return 0;
+  }
+  return Now - SessionInfo->LastActivityTime;
+}
+
+/**
+  Return if a session slot holds a session which the responder may end.
+
+  The session of the request being processed, and the session waiting for an asynchronous signature, are kept.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of the session slot.
+
+  @retval TRUE   The slot holds a session which may be ended.
+  @retval FALSE  The slot is free, or its session must be kept.
+**/
+BOOLEAN
+SpdmCanEndResponderSession (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     SPDM_SESSION_INFO    *SessionInfo
+  )
+{
+  if (SessionInfo->SessionId == INVALID_SESSION_ID) {
+    return FALSE;
+  }
+  if (SpdmContext->LastSpdmRequestSessionIdValid && (SpdmContext->LastSpdmRequestSessionId == SessionInfo->SessionId)) {
+    return FALSE;
+  }
+  if (SpdmContext->PendingSignature.Valid && (SpdmContext->PendingSignature.SessionId == SessionInfo->SessionId)) {
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  End a session of the responder without END_SESSION, and notify the session state callbacks.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of the session.
+**/
+VOID
+SpdmResponderEndIdleSession (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     SPDM_SESSION_INFO    *SessionInfo
+  )
+{
+  UINT32                   SessionId;
+
+  SessionId = SessionInfo->SessionId;
+  DEBUG((DEBUG_INFO, "SpdmResponderEndIdleSession[%x]\n", SessionId));
+  SpdmSetSessionState (SpdmContext, SessionId, SpdmSessionStateNotStarted);
+  SpdmFreeSessionId (SpdmContext, SessionId);
+}
+
+/**
+  End the expired sessions of a responder, with the lock held.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the number of sessions ended.
+**/
+UINTN
+SpdmResponderReclaimExpiredSessions (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_RESPONDER_SESSION_POLICY  *Policy;
+  SPDM_SESSION_INFO              *SessionInfo;
+  UINT64                         Now;
+  UINT64                         IdleTime;
+  UINTN                          Index;
+  UINTN                          Count;
+
+  if (SpdmContext->ResponderGetTimeFunc == 0) {
+    return 0;
+  }
+  Policy = &SpdmContext->ResponderSessionPolicy;
+  Now = ((SPDM_RESPONDER_GET_TIME_FUNC)SpdmContext->ResponderGetTimeFunc) (SpdmContext);
+
+  Count = 0;
+  SessionInfo = SpdmContext->SessionInfo;
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (!SpdmCanEndResponderSession (SpdmContext, &SessionInfo[Index])) {
+      continue;
+    }
+    IdleTime = SpdmGetResponderSessionIdleTime (&SessionInfo[Index], Now);
+    if (((SessionInfo[Index].HeartbeatPeriod != 0) &&
+         (IdleTime >= (UINT64)SessionInfo[Index].HeartbeatPeriod * SPDM_HEARTBEAT_PERIOD_UNIT * 2)) ||
+        ((Policy->IdleTimeout != 0) && (IdleTime >= Policy->IdleTimeout))) {
+      SpdmResponderEndIdleSession (SpdmContext, &SessionInfo[Index]);
+      Count++;
+    }
+  }
+  return Count;
+}
+
+/**
+  End the expired sessions of a responder.
+
+  It may be called periodically, so that the sessions of the requesters which are gone
+  are ended before their slots are needed. It takes the lock registered by SpdmRegisterResponderLockFunc.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the number of sessions ended.
+**/
+UINTN
+EFIAPI
+SpdmReclaimExpiredSessions (
+  IN     VOID                 *Context
+  )
+{
+  SPDM_DEVICE_CONTEXT      *SpdmContext;
+  UINTN                    Count;
+
+  SpdmContext = Context;
+  SpdmResponderLock (SpdmContext);
+  Count = SpdmResponderReclaimExpiredSessions (SpdmContext);
+  SpdmResponderUnlock (SpdmContext);
+  return Count;
+}
+
+/**
+  Return the least recently used session which may be evicted for a new session.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Privileged                   The new session is created by a privileged requester.
+
+  @return the session info of the session to evict, or NULL if no session may be evicted.
+**/
+SPDM_SESSION_INFO *
+SpdmGetResponderEvictableSession (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     BOOLEAN              Privileged
+  )
+{
+  SPDM_SESSION_INFO              *SessionInfo;
+  SPDM_SESSION_INFO              *Victim;
+  UINT64                         Now;
+  UINTN                          Index;
+
+  if ((SpdmContext->ResponderGetTimeFunc == 0) || (SpdmContext->ResponderSessionPolicy.EvictIdleTime == 0)) {
+    return NULL;
+  }
+  Now = ((SPDM_RESPONDER_GET_TIME_FUNC)SpdmContext->ResponderGetTimeFunc) (SpdmContext);
+
+  Victim = NULL;
+  SessionInfo = SpdmContext->SessionInfo;
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (!SpdmCanEndResponderSession (SpdmContext, &SessionInfo[Index])) {
+      continue;
+    }
+    if (SessionInfo[Index].Privileged && !Privileged) {
+      continue;
+    }
+    if (SpdmGetResponderSessionIdleTime (&SessionInfo[Index], Now) < SpdmContext->ResponderSessionPolicy.EvictIdleTime) {
+      continue;
+    }
+    if ((Victim == NULL) || (SessionInfo[Index].LastActivityTime < Victim->LastActivityTime)) {
+      Victim = &SessionInfo[Index];
+    }
+  }
+  return Victim;
+}
+
+/**
+  Make a session slot available for a KEY_EXCHANGE or PSK_EXCHANGE, by the session lifecycle policy.
+
+  The expired sessions are ended first, and then the least recently used idle sessions are evicted.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code, KEY_EXCHANGE or PSK_EXCHANGE.
+  @param  Privileged                   Return if the requester is privileged.
+
+  @retval TRUE   A session slot is free for the requester.
+  @retval FALSE  No session slot may be used by the requester.
+**/
+BOOLEAN
+SpdmResponderReserveSessionSlot (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                RequestCode,
+     OUT BOOLEAN              *Privileged
+  )
+{
+  SPDM_SESSION_INFO              *Victim;
+  UINTN                          FreeCount;
+  UINTN                          NeededCount;
+  UINTN                          Index;
+
+  if (SpdmContext->ResponderSessionPrivilegeFunc != 0) {
+    *Privileged = ((SPDM_RESPONDER_SESSION_PRIVILEGE_FUNC)SpdmContext->ResponderSessionPrivilegeFunc) (SpdmContext, RequestCode);
+  } else {
+    *Privileged = TRUE;
+  }
+  NeededCount = 1;
+  if (!*Privileged) {
+    NeededCount += SpdmContext->ResponderSessionPolicy.ReservedCount;
+  }
+
+  FreeCount = 0;
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SpdmContext->SessionInfo[Index].SessionId == INVALID_SESSION_ID) {
+      FreeCount++;
+    }
+  }
+  if (FreeCount >= NeededCount) {
+    return TRUE;
+  }
+
+  FreeCount += SpdmResponderReclaimExpiredSessions (SpdmContext);
+  while (FreeCount < NeededCount) {
+    Victim = SpdmGetResponderEvictableSession (SpdmContext, *Privileged);
+    if (Victim == NULL) {
+      DEBUG((DEBUG_INFO, "SpdmResponderReserveSessionSlot - no slot for 0x%02x\n", RequestCode));
+      return FALSE;
+    }
+    SpdmResponderEndIdleSession (SpdmContext, Victim);
+    FreeCount++;
+  }
+  return TRUE;
+}
+
+/**
+  Initialize the lifecycle of a session created by KEY_EXCHANGE or PSK_EXCHANGE.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionInfo                  The session info of the session.
+  @param  Privileged                   The session is created by a privileged requester.
+  @param  HeartbeatPeriod              The heartbeat period returned in the response.
+**/
+VOID
+SpdmResponderInitSessionLifecycle (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     SPDM_SESSION_INFO    *SessionInfo,
+  IN     BOOLEAN              Privileged,
+  IN     UINT8                HeartbeatPeriod
+  )
+{
+  SessionInfo->Privileged = Privileged;
+  SessionInfo->HeartbeatPeriod = HeartbeatPeriod;
+  SpdmResponderTouchSession (SpdmContext, SessionInfo);
+}
@@ -0,0 +1,141 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmResponderLibInternal.h"
+
+/**
+  Enable or disable the state event queue of an SPDM context.
+
+  With the queue, a session or connection state transition is posted to a queue in the SPDM context,
+  instead of calling the registered state callbacks while the request is processed, so that the response
+  is sent before slow callbacks run. The callbacks are called by SpdmDispatchStateEvents.
+  The transitions already posted stay in the queue when it is disabled.
+
+  It must not be called while a message is processed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Enable                       TRUE to post the state transitions, FALSE to call the callbacks at once.
+**/
+VOID
+EFIAPI
+SpdmEnableStateEventQueue (
+  IN     VOID                 *Context,
+  IN     BOOLEAN              Enable
+  )
+{
+  SPDM_DEVICE_CONTEXT      *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->StateEventQueue.Enabled = Enable;
+  return ;
+}
+
+/**
+  Post a state transition to the state event queue, to be dispatched by SpdmDispatchStateEvents.
+
+  If the queue is full, the transition is dropped and counted.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  IsSessionEvent               TRUE for a session state, FALSE for a connection state.
+  @param  SessionId                    The SessionId of the session, for a session state.
+  @param  State                        The new SPDM_SESSION_STATE or SPDM_CONNECTION_STATE.
+**/
+VOID
+SpdmPostStateEvent (
+  IN     SPDM_DEVICE_CONTEXT      *SpdmContext,
+  IN     BOOLEAN                  IsSessionEvent,
+  IN     UINT32                   SessionId,
+  IN     UINT32                   State
+  )
+{
+  SPDM_STATE_EVENT_QUEUE   *Queue;
+  SPDM_STATE_EVENT         *Event;
+  UINT32                   Tail;
+
+  Queue = &SpdmContext->StateEventQueue;
+  Tail = Queue->Tail;
+  if (Tail - SPDM_LOAD_ACQUIRE (&Queue->Head) >= MAX_SPDM_STATE_EVENT_QUEUE_DEPTH) {
+    DEBUG((DEBUG_INFO, "SpdmPostStateEvent - queue full, drop (%d, 0x%x, %d)\n", IsSessionEvent, SessionId, State));
+    SPDM_STORE_RELEASE (&Queue->DroppedCount, Queue->DroppedCount + 1);
+    return ;
+  }
+
+  Event = &Queue->Event[Tail % MAX_SPDM_STATE_EVENT_QUEUE_DEPTH];
+  Event->IsSessionEvent = IsSessionEvent;
+  Event->SessionId = SessionId;
+  Event->State = State;
+  SPDM_STORE_RELEASE (&Queue->Tail, Tail + 1);
+}
+
+/**
+  Call the registered state callbacks for the state transitions posted to the state event queue.
+
+  The transitions are dispatched in the order they happened, across all sessions and the connection,
+  and each one is dispatched once. The callbacks run on the caller's thread. By then the session or
+  connection may be in a later state, and a session may have ended.
+  It may run concurrently with the processing of messages, but not with another SpdmDispatchStateEvents
+  of the same SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MaxEventCount                The maximum number of transitions to dispatch, or 0 for all posted transitions.
+  @param  EventCount                   The number of dispatched transitions.
+
+  @retval RETURN_SUCCESS               The transitions are dispatched.
+  @retval RETURN_OUT_OF_RESOURCES      The transitions are dispatched, but some transitions were dropped because the queue
+                                       was full since the last call. The current states should be read with SpdmGetData.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmDispatchStateEvents (
+  IN     VOID                 *Context,
+  IN     UINTN                MaxEventCount,
+     OUT UINTN                *EventCount OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT      *SpdmContext;
+  SPDM_STATE_EVENT_QUEUE   *Queue;
+  SPDM_STATE_EVENT         Event;
+  UINT32                   Head;
+  UINT32                   DroppedCount;
+  UINTN                    Count;
+
+  SpdmContext = Context;
+  Queue = &SpdmContext->StateEventQueue;
+
+  Count = 0;
+  Head = Queue->Head;
+  while ((MaxEventCount == 0) || (Count < MaxEventCount)) {
+    if (Head == SPDM_LOAD_ACQUIRE (&Queue->Tail)) {
+      break;
+    }
+    //
+    // Copy the entry and release it before the callbacks run, so that the responder can post again.
+    //
+    CopyMem (&Event, &Queue->Event[Head % MAX_SPDM_STATE_EVENT_QUEUE_DEPTH], sizeof(Event));
+    Head++;
+    SPDM_STORE_RELEASE (&Queue->Head, Head);
+
+    if (Event.IsSessionEvent) {
+      SpdmTriggerSessionStateCallback (SpdmContext, Event.SessionId, (SPDM_SESSION_STATE)Event.State);
+    } else {
+      SpdmTriggerConnectionStateCallback (SpdmContext, (SPDM_CONNECTION_STATE)Event.State);
+    }
+    Count++;
+  }
+  if (EventCount != NULL) {
+    *EventCount = Count;
+  }
+
+  DroppedCount = SPDM_LOAD_ACQUIRE (&Queue->DroppedCount);
+  if (DroppedCount != Queue->DroppedReported) {
+    Queue->DroppedReported = DroppedCount;
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  return RETURN_SUCCESS;
+}
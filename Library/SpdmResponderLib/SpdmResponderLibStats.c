@@ -0,0 +1,199 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmResponderLibInternal.h"
+
+/**
+  Return the time for the responder statistics, with the time function registered by SpdmRegisterResponderAdmissionFunc.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the time, in 100ns units, or 0 if the responder statistics are not collected or no time function is registered.
+**/
+UINT64
+SpdmResponderStatsGetTime (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+#if OPENSPDM_RESPONDER_STATS_SUPPORT == 1
+  if (SpdmContext->ResponderGetTimeFunc != 0) {
+    return ((SPDM_RESPONDER_GET_TIME_FUNC)SpdmContext->ResponderGetTimeFunc) (SpdmContext);
+  }
+#endif
+  return 0;
+}
+
+#if OPENSPDM_RESPONDER_STATS_SUPPORT == 1
+
+/**
+  Return the statistics of an SPDM request code.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  RequestCode                  The SPDM request code.
+
+  @return the statistics of the request code, or NULL if it is not a request code.
+**/
+SPDM_RESPONDER_REQUEST_STATS *
+SpdmGetResponderRequestStats (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                RequestCode
+  )
+{
+  if (RequestCode < 0x80) {
+    return NULL;
+  }
+  return &SpdmContext->ResponderStats.Request[RequestCode - 0x80];
+}
+
+/**
+  Add a latency to a latency histogram.
+
+  @param  Latency                      The latency, in 100ns units.
+  @param  Histogram                    The latency histogram with SPDM_RESPONDER_STATS_LATENCY_BUCKET_COUNT buckets.
+**/
+VOID
+SpdmRecordResponderLatency (
+  IN     UINT64               Latency,
+  IN OUT UINT32               *Histogram
+  )
+{
+  UINT64                    Value;
+  UINTN                     Index;
+
+  Value = Latency / 10;
+  for (Index = 0; (Index < SPDM_RESPONDER_STATS_LATENCY_BUCKET_COUNT - 1) && (Value >= 4); Index++) {
+    Value >>= 2;
+  }
+  Histogram[Index] ++;
+}
+
+#endif
+
+/**
+  Add the time from StartTime to the crypto time of the request being processed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StartTime                    The time the crypto operation starts, from SpdmResponderStatsGetTime.
+**/
+VOID
+SpdmResponderStatsAddCryptoTime (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT64               StartTime
+  )
+{
+#if OPENSPDM_RESPONDER_STATS_SUPPORT == 1
+  UINT64                    Now;
+
+  Now = SpdmResponderStatsGetTime (SpdmContext);
+  if (Now > StartTime) {
+    SpdmContext->StatsCryptoTime += Now - StartTime;
+  }
+#endif
+}
+
+/**
+  Add the time from StartTime to the callback time of the request being processed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StartTime                    The time the callback starts, from SpdmResponderStatsGetTime.
+**/
+VOID
+SpdmResponderStatsAddCallbackTime (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT64               StartTime
+  )
+{
+#if OPENSPDM_RESPONDER_STATS_SUPPORT == 1
+  UINT64                    Now;
+
+  Now = SpdmResponderStatsGetTime (SpdmContext);
+  if (Now > StartTime) {
+    SpdmContext->StatsCallbackTime += Now - StartTime;
+  }
+#endif
+}
+
+/**
+  Start the responder statistics of a request being processed.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the time the request is processed, from SpdmResponderStatsGetTime.
+**/
+UINT64
+SpdmResponderStatsBeginRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+#if OPENSPDM_RESPONDER_STATS_SUPPORT == 1
+  SpdmContext->StatsCryptoTime = 0;
+  SpdmContext->StatsCallbackTime = 0;
+#endif
+  return SpdmResponderStatsGetTime (SpdmContext);
+}
+
+/**
+  Record an SPDM request and its response in the responder statistics.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  StartTime                    The time the request is processed, from SpdmResponderStatsBeginRequest.
+  @param  RequestSize                  Size in bytes of the request.
+  @param  Request                      A pointer to the request.
+  @param  ResponseSize                 Size in bytes of the response.
+  @param  Response                     A pointer to the response.
+**/
+VOID
+SpdmResponderStatsRecordResponse (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT64               StartTime,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN     UINTN                ResponseSize,
+  IN     VOID                 *Response
+  )
+{
+#if OPENSPDM_RESPONDER_STATS_SUPPORT == 1
+  SPDM_RESPONDER_REQUEST_STATS              *Stats;
+  SPDM_MESSAGE_HEADER                       *SpdmResponse;
+  UINT64                                    Now;
+
+  if (RequestSize < sizeof(SPDM_MESSAGE_HEADER)) {
+    return ;
+  }
+  Stats = SpdmGetResponderRequestStats (SpdmContext, ((SPDM_MESSAGE_HEADER *)Request)->RequestResponseCode);
+  if (Stats == NULL) {
+    return ;
+  }
+  Stats->RequestCount ++;
+  Stats->RequestBytes += RequestSize;
+  Stats->ResponseBytes += ResponseSize;
+
+  SpdmResponse = Response;
+  if ((ResponseSize >= sizeof(SPDM_MESSAGE_HEADER)) && (SpdmResponse->RequestResponseCode == SPDM_ERROR)) {
+    Stats->ErrorCount[SPDM_RESPONDER_STATS_ERROR_CODE_INDEX(SpdmResponse->Param1)] ++;
+    Stats->LastErrorCode = SpdmResponse->Param1;
+    if (SpdmResponse->Param1 == SPDM_ERROR_CODE_RESPONSE_NOT_READY) {
+      Stats->ResponseNotReadyCount ++;
+    }
+  }
+
+  if (SpdmContext->ResponderGetTimeFunc != 0) {
+    Now = SpdmResponderStatsGetTime (SpdmContext);
+    if (Now >= StartTime) {
+      Stats->ProcessingTime += Now - StartTime;
+      SpdmRecordResponderLatency (Now - StartTime, Stats->ProcessingLatency);
+    }
+    Stats->CryptoTime += SpdmContext->StatsCryptoTime;
+    if (SpdmContext->StatsCallbackTime != 0) {
+      Stats->CallbackTime += SpdmContext->StatsCallbackTime;
+      SpdmRecordResponderLatency (SpdmContext->StatsCallbackTime, Stats->CallbackLatency);
+    }
+  }
+#endif
+}
@@ -55,6 +55,7 @@ SpdmGetResponseVersion (
   SpdmRequest = Request;
 
   SpdmSetConnectionState (SpdmContext, SpdmConnectionStateNotStarted);
+  SpdmResetPeerPublicKey (SpdmContext);
 
   if (SpdmRequest->Header.SPDMVersion != SPDM_MESSAGE_VERSION_10)  {
     SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_INVALID_REQUEST, 0, ResponseSize, Response);
@@ -0,0 +1,241 @@
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmResponderLibInternal.h"
+
+/**
+  Register the lock functions of an SPDM context in a responder.
+
+  The lock serializes SpdmProcessMessage and the responder workers of the SPDM context.
+  It protects the connection state, the response state, the transcripts and the transport layer.
+  The APP message of a session processed by a responder worker is handled without the lock.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  AcquireLock                  The function to acquire the lock, or NULL.
+  @param  ReleaseLock                  The function to release the lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+**/
+VOID
+EFIAPI
+SpdmRegisterResponderLockFunc (
+  IN     VOID                      *Context,
+  IN     SPDM_RESPONDER_LOCK_FUNC  AcquireLock OPTIONAL,
+  IN     SPDM_RESPONDER_LOCK_FUNC  ReleaseLock OPTIONAL,
+  IN     VOID                      *LockContext OPTIONAL
+  )
+{
+  SPDM_DEVICE_CONTEXT      *SpdmContext;
+
+  SpdmContext = Context;
+  SpdmContext->ResponderAcquireLock = (UINTN)AcquireLock;
+  SpdmContext->ResponderReleaseLock = (UINTN)ReleaseLock;
+  SpdmContext->ResponderLockContext = LockContext;
+  return ;
+}
+
+/**
+  Acquire the lock of an SPDM context in a responder, if the lock functions are registered.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmResponderLock (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  if (SpdmContext->ResponderAcquireLock != 0) {
+    ((SPDM_RESPONDER_LOCK_FUNC)SpdmContext->ResponderAcquireLock) (SpdmContext->ResponderLockContext);
+  }
+}
+
+/**
+  Release the lock of an SPDM context in a responder, if the lock functions are registered.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmResponderUnlock (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  if (SpdmContext->ResponderReleaseLock != 0) {
+    ((SPDM_RESPONDER_LOCK_FUNC)SpdmContext->ResponderReleaseLock) (SpdmContext->ResponderLockContext);
+  }
+}
+
+/**
+  Return the size in bytes of a responder worker.
+
+  @return the size in bytes of the responder worker.
+**/
+UINTN
+EFIAPI
+SpdmResponderWorkerGetSize (
+  VOID
+  )
+{
+  return sizeof(SPDM_RESPONDER_WORKER);
+}
+
+/**
+  Initialize a responder worker of an SPDM context.
+
+  A responder worker holds the APP message being processed, so that the APP messages of different sessions
+  are processed concurrently, one worker per thread. The lock functions must be registered to the SPDM context
+  by SpdmRegisterResponderLockFunc.
+
+  @param  ResponderWorker              A pointer to the responder worker.
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+EFIAPI
+SpdmResponderWorkerInit (
+     OUT VOID                 *ResponderWorker,
+  IN     VOID                 *SpdmContext
+  )
+{
+  SPDM_RESPONDER_WORKER    *Worker;
+
+  Worker = ResponderWorker;
+  ZeroMem (Worker, sizeof(SPDM_RESPONDER_WORKER));
+  Worker->SpdmContext = SpdmContext;
+}
+
+/**
+  Handle the APP message of a session held by a responder worker, without the lock of the SPDM context.
+
+  @param  Worker                       A pointer to the responder worker.
+  @param  ResponseSize                 On input, the size in bytes of the transport message buffer.
+                                       On output, the size in bytes of the APP response.
+  @param  Response                     The transport message buffer.
+  @param  AppResponse                  The APP response, at the headroom of Response or in the responder worker.
+**/
+VOID
+SpdmResponderWorkerHandleAppMessage (
+  IN     SPDM_RESPONDER_WORKER  *Worker,
+  IN OUT UINTN                  *ResponseSize,
+     OUT VOID                   *Response,
+     OUT UINT8                  **AppResponse
+  )
+{
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+  UINT8                     *MyResponse;
+  UINTN                     MyResponseSize;
+  UINTN                     Headroom;
+  UINTN                     Tailroom;
+  RETURN_STATUS             Status;
+
+  SpdmContext = Worker->SpdmContext;
+
+  MyResponse = Worker->Response;
+  MyResponseSize = sizeof(Worker->Response);
+  if ((SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportGetMessageRoom != NULL) &&
+      !RETURN_ERROR(SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportGetMessageRoom (SpdmContext, &Worker->SessionId, TRUE, &Headroom, &Tailroom)) &&
+      (*ResponseSize > Headroom + Tailroom)) {
+    MyResponse = (UINT8 *)Response + Headroom;
+    MyResponseSize = MIN (*ResponseSize - Headroom - Tailroom, sizeof(Worker->Response));
+  }
+  ZeroMem (MyResponse, MyResponseSize);
+  if (SpdmContext->GetResponseFunc != 0) {
+    Status = ((SPDM_GET_RESPONSE_FUNC)SpdmContext->GetResponseFunc) (SpdmContext, &Worker->SessionId, TRUE, Worker->RequestSize, Worker->Request, &MyResponseSize, MyResponse);
+  } else {
+    Status = RETURN_NOT_FOUND;
+  }
+  if (Status != RETURN_SUCCESS) {
+    SpdmGenerateErrorResponse (SpdmContext, SPDM_ERROR_CODE_UNSUPPORTED_REQUEST, ((SPDM_MESSAGE_HEADER *)Worker->Request)->RequestResponseCode, &MyResponseSize, MyResponse);
+  }
+
+  *ResponseSize = MyResponseSize;
+  *AppResponse = MyResponse;
+}
+
+/**
+  Process a transport layer message with a responder worker.
+
+  The message is decoded with the lock of the SPDM context. An APP message of a session is then handled
+  by the function registered with SpdmRegisterGetResponseFunc without the lock, and its response is encoded
+  with the lock. Any other message is processed as SpdmProcessMessage does, with the lock.
+  The messages of one session must be processed one at a time, for example by dispatching them by the session ID.
+
+  @param  ResponderWorker              A pointer to the responder worker.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If *SessionId is NULL, it is a normal message.
+                                       If *SessionId is NOT NULL, it is a secured message.
+  @param  Request                      A pointer to the request data.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Response                     A pointer to the response data.
+  @param  ResponseSize                 Size in bytes of the response data.
+                                       On input, it means the size in bytes of response data buffer.
+                                       On output, it means the size in bytes of copied response data buffer if RETURN_SUCCESS is returned,
+                                       and means the size in bytes of desired response data buffer if RETURN_BUFFER_TOO_SMALL is returned.
+
+  @retval RETURN_SUCCESS               The SPDM request is set successfully.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the data.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when communicates with the device.
+  @retval RETURN_SECURITY_VIOLATION    Any verification fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmResponderWorkerProcessMessage (
+  IN     VOID                 *ResponderWorker,
+  IN OUT UINT32               **SessionId,
+  IN     VOID                 *Request,
+  IN     UINTN                RequestSize,
+     OUT VOID                 *Response,
+  IN OUT UINTN                *ResponseSize
+  )
+{
+  SPDM_RESPONDER_WORKER     *Worker;
+  SPDM_DEVICE_CONTEXT       *SpdmContext;
+  RETURN_STATUS             Status;
+  BOOLEAN                   IsAppMessage;
+  UINT8                     *AppResponse;
+  UINTN                     AppResponseSize;
+
+  Worker = ResponderWorker;
+  SpdmContext = Worker->SpdmContext;
+
+  SpdmResponderLock (SpdmContext);
+  Status = SpdmProcessRequest (SpdmContext, SessionId, &IsAppMessage, RequestSize, Request);
+  if (RETURN_ERROR(Status)) {
+    SpdmResponderUnlock (SpdmContext);
+    return Status;
+  }
+  if (!IsAppMessage || (*SessionId == NULL) || (SpdmContext->LastSpdmRequestSize > sizeof(Worker->Request))) {
+    Status = SpdmBuildResponse (SpdmContext, *SessionId, IsAppMessage, ResponseSize, Response);
+    SpdmResponderUnlock (SpdmContext);
+    return Status;
+  }
+  //
+  // Take the APP message of the session out of the SPDM context, and handle it without the lock.
+  //
+  Worker->SessionId = **SessionId;
+  Worker->RequestSize = SpdmContext->LastSpdmRequestSize;
+  CopyMem (Worker->Request, SpdmContext->LastSpdmRequest, Worker->RequestSize);
+  SpdmContext->LastSpdmRequestSize = 0;
+  SpdmResponderUnlock (SpdmContext);
+
+  *SessionId = &Worker->SessionId;
+  AppResponseSize = *ResponseSize;
+  SpdmResponderWorkerHandleAppMessage (Worker, &AppResponseSize, Response, &AppResponse);
+
+  if (SPDM_DEBUG_DUMP_ENABLED (SpdmContext, SPDM_DEBUG_DUMP_WIRE)) {
+    DEBUG((DEBUG_INFO, "SpdmSendResponse[%x] (0x%x): \n", Worker->SessionId, AppResponseSize));
+    InternalDumpHex (AppResponse, AppResponseSize);
+  }
+
+  SpdmResponderLock (SpdmContext);
+  Status = SpdmContext->TransportPath[SpdmContext->SendTransportPath].TransportEncodeMessage (SpdmContext, &Worker->SessionId, TRUE, FALSE, AppResponseSize, AppResponse, ResponseSize, Response);
+  SpdmResponderUnlock (SpdmContext);
+  if (RETURN_ERROR(Status)) {
+    DEBUG((DEBUG_INFO, "TransportEncodeMessage : %p\n", Status));
+    return Status;
+  }
+  return RETURN_SUCCESS;
+}
@@ -1,376 +1,743 @@
-/** @file
-  SPDM common library.
-  It follows the SPDM Specification.
-
-Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
-SPDX-License-Identifier: BSD-2-Clause-Patent
-
-**/
-
-#include "SpdmSecuredMessageLibInternal.h"
-
-/**
-  Return the size in bytes of the SPDM secured message context.
-
-  @return the size in bytes of the SPDM secured message context.
-**/
-UINTN
-EFIAPI
-SpdmSecuredMessageGetContextSize (
-  VOID
-  )
-{
-  return sizeof(SPDM_SECURED_MESSAGE_CONTEXT);
-}
-
-/**
-  Initialize an SPDM secured message context.
-
-  The size in bytes of the SpdmSecuredMessageContext can be returned by SpdmSecuredMessageGetContextSize.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-*/
-VOID
-EFIAPI
-SpdmSecuredMessageInitContext (
-  IN     VOID                     *SpdmSecuredMessageContext
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  ZeroMem (SecuredMessageContext, sizeof(SPDM_SECURED_MESSAGE_CONTEXT));
-
-  RandomSeed (NULL, 0);
-}
-
-/**
-  Set UsePsk to an SPDM secured message context.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-  @param  UsePsk                       Indicate if the SPDM session use PSK.
-*/
-VOID
-EFIAPI
-SpdmSecuredMessageSetUsePsk (
-  IN VOID                         *SpdmSecuredMessageContext,
-  IN BOOLEAN                      UsePsk
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  SecuredMessageContext->UsePsk = UsePsk;
-}
-
-/**
-  Set SessionState to an SPDM secured message context.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-  @param  SessionState                 Indicate the SPDM session state.
-*/
-VOID
-EFIAPI
-SpdmSecuredMessageSetSessionState (
-  IN VOID                         *SpdmSecuredMessageContext,
-  IN SPDM_SESSION_STATE           SessionState
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  SecuredMessageContext->SessionState = SessionState;
-}
-
-/**
-  Return SessionState of an SPDM secured message context.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-
-  @return the SPDM session state.
-*/
-SPDM_SESSION_STATE
-EFIAPI
-SpdmSecuredMessageGetSessionState (
-  IN VOID                         *SpdmSecuredMessageContext
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  return SecuredMessageContext->SessionState;
-}
-
-/**
-  Set SessionType to an SPDM secured message context.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-  @param  SessionType                  Indicate the SPDM session type.
-*/
-VOID
-EFIAPI
-SpdmSecuredMessageSetSessionType (
-  IN VOID                         *SpdmSecuredMessageContext,
-  IN SPDM_SESSION_TYPE            SessionType
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  SecuredMessageContext->SessionType = SessionType;
-}
-
-/**
-  Set Algorithm to an SPDM secured message context.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-  @param  BaseHashAlgo                 Indicate the negotiated BaseHashAlgo for the SPDM session.
-  @param  DHENamedGroup                Indicate the negotiated DHENamedGroup for the SPDM session.
-  @param  AEADCipherSuite              Indicate the negotiated AEADCipherSuite for the SPDM session.
-  @param  KeySchedule                  Indicate the negotiated KeySchedule for the SPDM session.
-*/
-VOID
-EFIAPI
-SpdmSecuredMessageSetAlgorithms (
-  IN VOID                         *SpdmSecuredMessageContext,
-  IN UINT32                       BaseHashAlgo,
-  IN UINT16                       DHENamedGroup,
-  IN UINT16                       AEADCipherSuite,
-  IN UINT16                       KeySchedule
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  SecuredMessageContext->BaseHashAlgo = BaseHashAlgo;
-  SecuredMessageContext->DHENamedGroup = DHENamedGroup;
-  SecuredMessageContext->AEADCipherSuite = AEADCipherSuite;
-  SecuredMessageContext->KeySchedule = KeySchedule;
-  
-  SecuredMessageContext->HashSize      = GetSpdmHashSize (SecuredMessageContext->BaseHashAlgo);
-  SecuredMessageContext->DheKeySize    = GetSpdmDhePubKeySize (SecuredMessageContext->DHENamedGroup);
-  SecuredMessageContext->AeadKeySize   = GetSpdmAeadKeySize (SecuredMessageContext->AEADCipherSuite);
-  SecuredMessageContext->AeadIvSize    = GetSpdmAeadIvSize (SecuredMessageContext->AEADCipherSuite);
-  SecuredMessageContext->AeadBlockSize = GetSpdmAeadBlockSize (SecuredMessageContext->AEADCipherSuite);
-  SecuredMessageContext->AeadTagSize   = GetSpdmAeadTagSize (SecuredMessageContext->AEADCipherSuite);
-}
-
-/**
-  Set the PskHint to an SPDM secured message context.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-  @param  PskHint                      Indicate the PSK hint.
-  @param  PskHintSize                  The size in bytes of the PSK hint.
-*/
-VOID
-EFIAPI
-SpdmSecuredMessageSetPskHint (
-  IN VOID                         *SpdmSecuredMessageContext,
-  IN VOID                         *PskHint,
-  IN UINTN                        PskHintSize
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  SecuredMessageContext->PskHint     = PskHint;
-  SecuredMessageContext->PskHintSize = PskHintSize;
-}
-
-/**
-  Import the DHE Secret to an SPDM secured message context.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-  @param  DheSecret                    Indicate the DHE secret.
-  @param  DheSecretSize                The size in bytes of the DHE secret.
-
-  @retval RETURN_SUCCESS  DHE Secret is imported.
-*/
-RETURN_STATUS
-EFIAPI
-SpdmSecuredMessageImportDheSecret (
-  IN VOID                         *SpdmSecuredMessageContext,
-  IN VOID                         *DheSecret,
-  IN UINTN                        DheSecretSize
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  if (DheSecretSize > SecuredMessageContext->DheKeySize) {
-    return RETURN_OUT_OF_RESOURCES;
-  }
-  SecuredMessageContext->DheKeySize = DheSecretSize;
-  CopyMem (SecuredMessageContext->MasterSecret.DheSecret, DheSecret, DheSecretSize);
-  return RETURN_SUCCESS;
-}
-
-/**
-  Export the ExportMasterSecret from an SPDM secured message context.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-  @param  ExportMasterSecret           Indicate the buffer to store the ExportMasterSecret.
-  @param  ExportMasterSecretSize       The size in bytes of the ExportMasterSecret.
-
-  @retval RETURN_SUCCESS  ExportMasterSecret is exported.
-*/
-RETURN_STATUS
-EFIAPI
-SpdmSecuredMessageExportMasterSecret (
-  IN     VOID                         *SpdmSecuredMessageContext,
-     OUT VOID                         *ExportMasterSecret,
-  IN OUT UINTN                        *ExportMasterSecretSize
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  if (*ExportMasterSecretSize < SecuredMessageContext->HashSize) {
-    *ExportMasterSecretSize = SecuredMessageContext->HashSize;
-    return RETURN_BUFFER_TOO_SMALL;
-  }
-  *ExportMasterSecretSize = SecuredMessageContext->HashSize;
-  CopyMem (ExportMasterSecret, SecuredMessageContext->HandshakeSecret.ExportMasterSecret, SecuredMessageContext->HashSize);
-  return RETURN_SUCCESS;
-}
-
-/**
-  Export the SessionKeys from an SPDM secured message context.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-  @param  SessionKeys                  Indicate the buffer to store the SessionKeys in SPDM_SECURE_SESSION_KEYS_STRUCT.
-  @param  SessionKeysSize              The size in bytes of the SessionKeys in SPDM_SECURE_SESSION_KEYS_STRUCT.
-
-  @retval RETURN_SUCCESS  SessionKeys are exported.
-*/
-RETURN_STATUS
-EFIAPI
-SpdmSecuredMessageExportSessionKeys (
-  IN     VOID                         *SpdmSecuredMessageContext,
-     OUT VOID                         *SessionKeys,
-  IN OUT UINTN                        *SessionKeysSize
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-  UINTN                                  StructSize;
-  SPDM_SECURE_SESSION_KEYS_STRUCT        *SessionkeysStruct;
-  UINT8                                  *Ptr;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  StructSize = sizeof(SPDM_SECURE_SESSION_KEYS_STRUCT) + (SecuredMessageContext->AeadKeySize + SecuredMessageContext->AeadIvSize + sizeof(UINT64)) * 2;
-
-  if (*SessionKeysSize < StructSize) {
-    *SessionKeysSize = StructSize;
-    return RETURN_BUFFER_TOO_SMALL;
-  }
-
-  SessionkeysStruct = SessionKeys;
-  SessionkeysStruct->Version = SPDM_SECURE_SESSION_KEYS_STRUCT_VERSION;
-  SessionkeysStruct->AeadKeySize = (UINT32)SecuredMessageContext->AeadKeySize;
-  SessionkeysStruct->AeadIvSize = (UINT32)SecuredMessageContext->AeadIvSize;
-
-  Ptr = (VOID *)(SessionkeysStruct + 1);
-  CopyMem (Ptr, SecuredMessageContext->ApplicationSecret.RequestDataEncryptionKey, SecuredMessageContext->AeadKeySize);
-  Ptr += SecuredMessageContext->AeadKeySize;
-  CopyMem (Ptr, SecuredMessageContext->ApplicationSecret.RequestDataSalt, SecuredMessageContext->AeadIvSize);
-  Ptr += SecuredMessageContext->AeadIvSize;
-  CopyMem (Ptr, &SecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber, sizeof(UINT64));
-  Ptr += sizeof(UINT64);
-  CopyMem (Ptr, SecuredMessageContext->ApplicationSecret.ResponseDataEncryptionKey, SecuredMessageContext->AeadKeySize);
-  Ptr += SecuredMessageContext->AeadKeySize;
-  CopyMem (Ptr, SecuredMessageContext->ApplicationSecret.ResponseDataSalt, SecuredMessageContext->AeadIvSize);
-  Ptr += SecuredMessageContext->AeadIvSize;
-  CopyMem (Ptr, &SecuredMessageContext->ApplicationSecret.ResponseDataSequenceNumber, sizeof(UINT64));
-  Ptr += sizeof(UINT64);
-  return RETURN_SUCCESS;
-}
-
-/**
-  Import the SessionKeys from an SPDM secured message context.
-
-  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-  @param  SessionKeys                  Indicate the buffer to store the SessionKeys in SPDM_SECURE_SESSION_KEYS_STRUCT.
-  @param  SessionKeysSize              The size in bytes of the SessionKeys in SPDM_SECURE_SESSION_KEYS_STRUCT.
-
-  @retval RETURN_SUCCESS  SessionKeys are imported.
-*/
-RETURN_STATUS
-EFIAPI
-SpdmSecuredMessageImportSessionKeys (
-  IN     VOID                         *SpdmSecuredMessageContext,
-  IN     VOID                         *SessionKeys,
-  IN     UINTN                        SessionKeysSize
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-  UINTN                                  StructSize;
-  SPDM_SECURE_SESSION_KEYS_STRUCT        *SessionkeysStruct;
-  UINT8                                  *Ptr;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  StructSize = sizeof(SPDM_SECURE_SESSION_KEYS_STRUCT) + (SecuredMessageContext->AeadKeySize + SecuredMessageContext->AeadIvSize + sizeof(UINT64)) * 2;
-
-  if (SessionKeysSize != StructSize) {
-    return RETURN_INVALID_PARAMETER;
-  }
-
-  SessionkeysStruct = SessionKeys;
-  if ((SessionkeysStruct->Version != SPDM_SECURE_SESSION_KEYS_STRUCT_VERSION) ||
-      (SessionkeysStruct->AeadKeySize != SecuredMessageContext->AeadKeySize) ||
-      (SessionkeysStruct->AeadIvSize != SecuredMessageContext->AeadIvSize) ) {
-    return RETURN_INVALID_PARAMETER;
-  }
-
-  Ptr = (VOID *)(SessionkeysStruct + 1);
-  CopyMem (SecuredMessageContext->ApplicationSecret.RequestDataEncryptionKey, Ptr, SecuredMessageContext->AeadKeySize);
-  Ptr += SecuredMessageContext->AeadKeySize;
-  CopyMem (SecuredMessageContext->ApplicationSecret.RequestDataSalt, Ptr, SecuredMessageContext->AeadIvSize);
-  Ptr += SecuredMessageContext->AeadIvSize;
-  CopyMem (&SecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber, Ptr, sizeof(UINT64));
-  Ptr += sizeof(UINT64);
-  CopyMem (SecuredMessageContext->ApplicationSecret.ResponseDataEncryptionKey, Ptr, SecuredMessageContext->AeadKeySize);
-  Ptr += SecuredMessageContext->AeadKeySize;
-  CopyMem (SecuredMessageContext->ApplicationSecret.ResponseDataSalt, Ptr, SecuredMessageContext->AeadIvSize);
-  Ptr += SecuredMessageContext->AeadIvSize;
-  CopyMem (&SecuredMessageContext->ApplicationSecret.ResponseDataSequenceNumber, Ptr, sizeof(UINT64));
-  Ptr += sizeof(UINT64);
-  return RETURN_SUCCESS;
-}
-
-/**
-  Get the last SPDM error struct of an SPDM context.
-
-  @param  SpdmContext                  A pointer to the SPDM context.
-  @param  LastSpdmError                Last SPDM error struct of an SPDM context.
-*/
-VOID
-EFIAPI
-SpdmSecuredMessageGetLastSpdmErrorStruct (
-  IN     VOID                      *SpdmSecuredMessageContext,
-     OUT SPDM_ERROR_STRUCT         *LastSpdmError
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  CopyMem (LastSpdmError, &SecuredMessageContext->LastSpdmError, sizeof(SPDM_ERROR_STRUCT));
-}
-
-/**
-  Set the last SPDM error struct of an SPDM context.
-
-  @param  SpdmContext                  A pointer to the SPDM context.
-  @param  LastSpdmError                Last SPDM error struct of an SPDM context.
-*/
-VOID
-EFIAPI
-SpdmSecuredMessageSetLastSpdmErrorStruct (
-  IN     VOID                      *SpdmSecuredMessageContext,
-  IN     SPDM_ERROR_STRUCT         *LastSpdmError
-  )
-{
-  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
-
-  SecuredMessageContext = SpdmSecuredMessageContext;
-  CopyMem (&SecuredMessageContext->LastSpdmError, LastSpdmError, sizeof(SPDM_ERROR_STRUCT));
-}
+/** @file
+  SPDM common library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmSecuredMessageLibInternal.h"
+
+/**
+  Return the size in bytes of the SPDM secured message context.
+
+  @return the size in bytes of the SPDM secured message context.
+**/
+UINTN
+EFIAPI
+SpdmSecuredMessageGetContextSize (
+  VOID
+  )
+{
+  return sizeof(SPDM_SECURED_MESSAGE_CONTEXT);
+}
+
+/**
+  Initialize an SPDM secured message context.
+
+  The size in bytes of the SpdmSecuredMessageContext can be returned by SpdmSecuredMessageGetContextSize.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageInitContext (
+  IN     VOID                     *SpdmSecuredMessageContext
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  ZeroMem (
+    &SecuredMessageContext->MasterSecret,
+    OFFSET_OF(SPDM_SECURED_MESSAGE_CONTEXT, RequestDataNextReady) - OFFSET_OF(SPDM_SECURED_MESSAGE_CONTEXT, MasterSecret)
+    );
+  SpdmSecuredMessageResetContext (SecuredMessageContext);
+}
+
+/**
+  Reset an SPDM secured message context released by SpdmSecuredMessageDeinitContext, for a new session.
+
+  SpdmSecuredMessageDeinitContext wipes the bytes of the secrets written by the key schedule, and the rest
+  of the secrets is never written. So the secrets are not zeroed again: only the fields before and after them,
+  and the sequence numbers and replay windows kept beside them.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageResetContext (
+  IN     VOID                     *SpdmSecuredMessageContext
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+  SPDM_SESSION_INFO_APPLICATION_SECRET   *ApplicationSecret[3];
+  UINTN                                  Index;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  ZeroMem (SecuredMessageContext, OFFSET_OF(SPDM_SECURED_MESSAGE_CONTEXT, MasterSecret));
+  ZeroMem (
+    &SecuredMessageContext->RequestDataNextReady,
+    sizeof(SPDM_SECURED_MESSAGE_CONTEXT) - OFFSET_OF(SPDM_SECURED_MESSAGE_CONTEXT, RequestDataNextReady)
+    );
+
+  SecuredMessageContext->HandshakeSecret.RequestHandshakeSequenceNumber = 0;
+  SecuredMessageContext->HandshakeSecret.ResponseHandshakeSequenceNumber = 0;
+  ApplicationSecret[0] = &SecuredMessageContext->ApplicationSecret;
+  ApplicationSecret[1] = &SecuredMessageContext->ApplicationSecretBackup;
+  ApplicationSecret[2] = &SecuredMessageContext->ApplicationSecretNext;
+  for (Index = 0; Index < ARRAY_SIZE(ApplicationSecret); Index++) {
+    ApplicationSecret[Index]->RequestDataSequenceNumber = 0;
+    ApplicationSecret[Index]->ResponseDataSequenceNumber = 0;
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+    ApplicationSecret[Index]->RequestDataReplayWindow = 0;
+    ApplicationSecret[Index]->ResponseDataReplayWindow = 0;
+#endif
+  }
+
+  SecuredMessageContext->DebugDumpMask = SPDM_DEBUG_DUMP_ALL;
+  SpdmRandomStreamInit (&SecuredMessageContext->RandomStream);
+
+  RandomSeed (NULL, 0);
+}
+
+/**
+  Wipe the secrets of an SPDM secured message context.
+
+  Only the bytes written by the key schedule are wiped, according to the sizes of the negotiated algorithms.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+**/
+VOID
+SpdmSecuredMessageClearSecrets (
+  IN OUT SPDM_SECURED_MESSAGE_CONTEXT  *SecuredMessageContext
+  )
+{
+  SPDM_SESSION_INFO_MASTER_SECRET        *MasterSecret;
+  SPDM_SESSION_INFO_HANDSHAKE_SECRET     *HandshakeSecret;
+  SPDM_SESSION_INFO_APPLICATION_SECRET   *ApplicationSecret[3];
+  UINTN                                  HashSize;
+  UINTN                                  KeySize;
+  UINTN                                  IvSize;
+  UINTN                                  Index;
+
+  HashSize = MIN (SecuredMessageContext->HashSize, MAX_HASH_SIZE);
+  KeySize = MIN (SecuredMessageContext->AeadKeySize, MAX_AEAD_KEY_SIZE);
+  IvSize = MIN (SecuredMessageContext->AeadIvSize, MAX_AEAD_IV_SIZE);
+
+  MasterSecret = &SecuredMessageContext->MasterSecret;
+  ZeroMem (MasterSecret->DheSecret, MIN (SecuredMessageContext->DheKeySize, MAX_DHE_KEY_SIZE));
+  ZeroMem (MasterSecret->HandshakeSecret, HashSize);
+  ZeroMem (MasterSecret->MasterSecret, HashSize);
+
+  HandshakeSecret = &SecuredMessageContext->HandshakeSecret;
+  ZeroMem (HandshakeSecret->RequestHandshakeSecret, HashSize);
+  ZeroMem (HandshakeSecret->ResponseHandshakeSecret, HashSize);
+  ZeroMem (HandshakeSecret->ExportMasterSecret, HashSize);
+  ZeroMem (HandshakeSecret->RequestFinishedKey, HashSize);
+  ZeroMem (HandshakeSecret->ResponseFinishedKey, HashSize);
+  ZeroMem (HandshakeSecret->RequestHandshakeEncryptionKey, KeySize);
+  ZeroMem (HandshakeSecret->RequestHandshakeSalt, IvSize);
+  ZeroMem (HandshakeSecret->ResponseHandshakeEncryptionKey, KeySize);
+  ZeroMem (HandshakeSecret->ResponseHandshakeSalt, IvSize);
+
+  ApplicationSecret[0] = &SecuredMessageContext->ApplicationSecret;
+  ApplicationSecret[1] = &SecuredMessageContext->ApplicationSecretBackup;
+  ApplicationSecret[2] = &SecuredMessageContext->ApplicationSecretNext;
+  for (Index = 0; Index < ARRAY_SIZE(ApplicationSecret); Index++) {
+    ZeroMem (ApplicationSecret[Index]->RequestDataSecret, HashSize);
+    ZeroMem (ApplicationSecret[Index]->RequestDataEncryptionKey, KeySize);
+    ZeroMem (ApplicationSecret[Index]->RequestDataSalt, IvSize);
+    ZeroMem (ApplicationSecret[Index]->ResponseDataSecret, HashSize);
+    ZeroMem (ApplicationSecret[Index]->ResponseDataEncryptionKey, KeySize);
+    ZeroMem (ApplicationSecret[Index]->ResponseDataSalt, IvSize);
+  }
+}
+
+/**
+  Release the resources held by an SPDM secured message context, such as the keyed AEAD and HMAC handles
+  and the keys installed in the inline crypto engine.
+
+  It must be called before an initialized SPDM secured message context is initialized again or discarded.
+  The secrets of the context are wiped.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageDeinitContext (
+  IN     VOID                     *SpdmSecuredMessageContext
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  SpdmSecuredMessageClearOffloadKeys (SecuredMessageContext);
+  SpdmSecuredMessageFreeAeadContext (&SecuredMessageContext->RequestHandshakeAead);
+  SpdmSecuredMessageFreeAeadContext (&SecuredMessageContext->ResponseHandshakeAead);
+  SpdmSecuredMessageFreeAeadContext (&SecuredMessageContext->RequestDataAead);
+  SpdmSecuredMessageFreeAeadContext (&SecuredMessageContext->ResponseDataAead);
+  SpdmSecuredMessageFreeAeadContext (&SecuredMessageContext->RequestDataAeadNext);
+  SpdmSecuredMessageFreeAeadContext (&SecuredMessageContext->ResponseDataAeadNext);
+  SpdmSecuredMessageFreeHmacContext (&SecuredMessageContext->RequestFinishedHmac);
+  SpdmSecuredMessageFreeHmacContext (&SecuredMessageContext->ResponseFinishedHmac);
+  SpdmSecuredMessageClearSecrets (SecuredMessageContext);
+  SpdmRandomStreamInit (&SecuredMessageContext->RandomStream);
+}
+
+/**
+  Clone an SPDM secured message context, with the session state and the secrets.
+
+  The Clone creates its own keyed AEAD and HMAC handles and installs the keys in the inline crypto engine on first use,
+  and it has its own random stream.
+  The Clone must not be an initialized SPDM secured message context, unless it is released by SpdmSecuredMessageDeinitContext first.
+
+  @param  SpdmSecuredMessageContextClone  A pointer to the cloned SPDM secured message context.
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageCloneContext (
+     OUT VOID                     *SpdmSecuredMessageContextClone,
+  IN     VOID                     *SpdmSecuredMessageContext
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *CloneContext;
+
+  CloneContext = SpdmSecuredMessageContextClone;
+  CopyMem (CloneContext, SpdmSecuredMessageContext, sizeof(SPDM_SECURED_MESSAGE_CONTEXT));
+  ZeroMem (&CloneContext->RequestHandshakeAead, sizeof(CloneContext->RequestHandshakeAead));
+  ZeroMem (&CloneContext->ResponseHandshakeAead, sizeof(CloneContext->ResponseHandshakeAead));
+  ZeroMem (&CloneContext->RequestDataAead, sizeof(CloneContext->RequestDataAead));
+  ZeroMem (&CloneContext->ResponseDataAead, sizeof(CloneContext->ResponseDataAead));
+  ZeroMem (&CloneContext->RequestDataAeadNext, sizeof(CloneContext->RequestDataAeadNext));
+  ZeroMem (&CloneContext->ResponseDataAeadNext, sizeof(CloneContext->ResponseDataAeadNext));
+  ZeroMem (&CloneContext->RequestFinishedHmac, sizeof(CloneContext->RequestFinishedHmac));
+  ZeroMem (&CloneContext->ResponseFinishedHmac, sizeof(CloneContext->ResponseFinishedHmac));
+  ZeroMem (&CloneContext->RequestOffloadKey, sizeof(CloneContext->RequestOffloadKey));
+  ZeroMem (&CloneContext->ResponseOffloadKey, sizeof(CloneContext->ResponseOffloadKey));
+  SpdmRandomStreamInit (&CloneContext->RandomStream);
+}
+
+/**
+  Set UsePsk to an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  UsePsk                       Indicate if the SPDM session use PSK.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageSetUsePsk (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN BOOLEAN                      UsePsk
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  SecuredMessageContext->UsePsk = UsePsk;
+}
+
+/**
+  Set HandshakeInTheClear to an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  HandshakeInTheClear          Indicate if the handshake messages of the SPDM session are sent in the clear.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageSetHandshakeInTheClear (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN BOOLEAN                      HandshakeInTheClear
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  SecuredMessageContext->HandshakeInTheClear = HandshakeInTheClear;
+}
+
+/**
+  Set the debug dump mask to an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  DebugDumpMask                The categories of the debug hex dumps, as SPDM_DEBUG_DUMP_*.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageSetDebugDumpMask (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN UINT32                       DebugDumpMask
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  SecuredMessageContext->DebugDumpMask = DebugDumpMask;
+}
+
+/**
+  Set SessionState to an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionState                 Indicate the SPDM session state.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageSetSessionState (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN SPDM_SESSION_STATE           SessionState
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  SecuredMessageContext->SessionState = SessionState;
+}
+
+/**
+  Return SessionState of an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+
+  @return the SPDM session state.
+*/
+SPDM_SESSION_STATE
+EFIAPI
+SpdmSecuredMessageGetSessionState (
+  IN VOID                         *SpdmSecuredMessageContext
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  return SecuredMessageContext->SessionState;
+}
+
+/**
+  Set SessionType to an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionType                  Indicate the SPDM session type.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageSetSessionType (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN SPDM_SESSION_TYPE            SessionType
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  SecuredMessageContext->SessionType = SessionType;
+}
+
+/**
+  Set Algorithm to an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  BaseHashAlgo                 Indicate the negotiated BaseHashAlgo for the SPDM session.
+  @param  DHENamedGroup                Indicate the negotiated DHENamedGroup for the SPDM session.
+  @param  AEADCipherSuite              Indicate the negotiated AEADCipherSuite for the SPDM session.
+  @param  KeySchedule                  Indicate the negotiated KeySchedule for the SPDM session.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageSetAlgorithms (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN UINT32                       BaseHashAlgo,
+  IN UINT16                       DHENamedGroup,
+  IN UINT16                       AEADCipherSuite,
+  IN UINT16                       KeySchedule
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  SecuredMessageContext->BaseHashAlgo = BaseHashAlgo;
+  SecuredMessageContext->DHENamedGroup = DHENamedGroup;
+  SecuredMessageContext->AEADCipherSuite = AEADCipherSuite;
+  SecuredMessageContext->KeySchedule = KeySchedule;
+  
+  SecuredMessageContext->HashSize      = GetSpdmHashSize (SecuredMessageContext->BaseHashAlgo);
+  SecuredMessageContext->DheKeySize    = GetSpdmDhePubKeySize (SecuredMessageContext->DHENamedGroup);
+  SecuredMessageContext->AeadKeySize   = GetSpdmAeadKeySize (SecuredMessageContext->AEADCipherSuite);
+  SecuredMessageContext->AeadIvSize    = GetSpdmAeadIvSize (SecuredMessageContext->AEADCipherSuite);
+  SecuredMessageContext->AeadBlockSize = GetSpdmAeadBlockSize (SecuredMessageContext->AEADCipherSuite);
+  SecuredMessageContext->AeadTagSize   = GetSpdmAeadTagSize (SecuredMessageContext->AEADCipherSuite);
+}
+
+/**
+  Set the PskHint to an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  PskHint                      Indicate the PSK hint.
+  @param  PskHintSize                  The size in bytes of the PSK hint.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageSetPskHint (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN VOID                         *PskHint,
+  IN UINTN                        PskHintSize
+  )
+{
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  SecuredMessageContext->PskHint     = PskHint;
+  SecuredMessageContext->PskHintSize = PskHintSize;
+#endif
+}
+
+/**
+  Import the DHE Secret to an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  DheSecret                    Indicate the DHE secret.
+  @param  DheSecretSize                The size in bytes of the DHE secret.
+
+  @retval RETURN_SUCCESS  DHE Secret is imported.
+*/
+RETURN_STATUS
+EFIAPI
+SpdmSecuredMessageImportDheSecret (
+  IN VOID                         *SpdmSecuredMessageContext,
+  IN VOID                         *DheSecret,
+  IN UINTN                        DheSecretSize
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  if (DheSecretSize > SecuredMessageContext->DheKeySize) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  SecuredMessageContext->DheKeySize = DheSecretSize;
+  CopyMem (SecuredMessageContext->MasterSecret.DheSecret, DheSecret, DheSecretSize);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Export the ExportMasterSecret from an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  ExportMasterSecret           Indicate the buffer to store the ExportMasterSecret.
+  @param  ExportMasterSecretSize       The size in bytes of the ExportMasterSecret.
+
+  @retval RETURN_SUCCESS  ExportMasterSecret is exported.
+*/
+RETURN_STATUS
+EFIAPI
+SpdmSecuredMessageExportMasterSecret (
+  IN     VOID                         *SpdmSecuredMessageContext,
+     OUT VOID                         *ExportMasterSecret,
+  IN OUT UINTN                        *ExportMasterSecretSize
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  if (*ExportMasterSecretSize < SecuredMessageContext->HashSize) {
+    *ExportMasterSecretSize = SecuredMessageContext->HashSize;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *ExportMasterSecretSize = SecuredMessageContext->HashSize;
+  CopyMem (ExportMasterSecret, SecuredMessageContext->HandshakeSecret.ExportMasterSecret, SecuredMessageContext->HashSize);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Export the SessionKeys from an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionKeys                  Indicate the buffer to store the SessionKeys in SPDM_SECURE_SESSION_KEYS_STRUCT.
+  @param  SessionKeysSize              The size in bytes of the SessionKeys in SPDM_SECURE_SESSION_KEYS_STRUCT.
+
+  @retval RETURN_SUCCESS  SessionKeys are exported.
+*/
+RETURN_STATUS
+EFIAPI
+SpdmSecuredMessageExportSessionKeys (
+  IN     VOID                         *SpdmSecuredMessageContext,
+     OUT VOID                         *SessionKeys,
+  IN OUT UINTN                        *SessionKeysSize
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+  UINTN                                  StructSize;
+  SPDM_SECURE_SESSION_KEYS_STRUCT        *SessionkeysStruct;
+  UINT8                                  *Ptr;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  StructSize = sizeof(SPDM_SECURE_SESSION_KEYS_STRUCT) + (SecuredMessageContext->AeadKeySize + SecuredMessageContext->AeadIvSize + sizeof(UINT64)) * 2;
+
+  if (*SessionKeysSize < StructSize) {
+    *SessionKeysSize = StructSize;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  SessionkeysStruct = SessionKeys;
+  SessionkeysStruct->Version = SPDM_SECURE_SESSION_KEYS_STRUCT_VERSION;
+  SessionkeysStruct->AeadKeySize = (UINT32)SecuredMessageContext->AeadKeySize;
+  SessionkeysStruct->AeadIvSize = (UINT32)SecuredMessageContext->AeadIvSize;
+
+  Ptr = (VOID *)(SessionkeysStruct + 1);
+  CopyMem (Ptr, SecuredMessageContext->ApplicationSecret.RequestDataEncryptionKey, SecuredMessageContext->AeadKeySize);
+  Ptr += SecuredMessageContext->AeadKeySize;
+  CopyMem (Ptr, SecuredMessageContext->ApplicationSecret.RequestDataSalt, SecuredMessageContext->AeadIvSize);
+  Ptr += SecuredMessageContext->AeadIvSize;
+  CopyMem (Ptr, &SecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber, sizeof(UINT64));
+  Ptr += sizeof(UINT64);
+  CopyMem (Ptr, SecuredMessageContext->ApplicationSecret.ResponseDataEncryptionKey, SecuredMessageContext->AeadKeySize);
+  Ptr += SecuredMessageContext->AeadKeySize;
+  CopyMem (Ptr, SecuredMessageContext->ApplicationSecret.ResponseDataSalt, SecuredMessageContext->AeadIvSize);
+  Ptr += SecuredMessageContext->AeadIvSize;
+  CopyMem (Ptr, &SecuredMessageContext->ApplicationSecret.ResponseDataSequenceNumber, sizeof(UINT64));
+  Ptr += sizeof(UINT64);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Import the SessionKeys from an SPDM secured message context.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionKeys                  Indicate the buffer to store the SessionKeys in SPDM_SECURE_SESSION_KEYS_STRUCT.
+  @param  SessionKeysSize              The size in bytes of the SessionKeys in SPDM_SECURE_SESSION_KEYS_STRUCT.
+
+  @retval RETURN_SUCCESS  SessionKeys are imported.
+*/
+RETURN_STATUS
+EFIAPI
+SpdmSecuredMessageImportSessionKeys (
+  IN     VOID                         *SpdmSecuredMessageContext,
+  IN     VOID                         *SessionKeys,
+  IN     UINTN                        SessionKeysSize
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+  UINTN                                  StructSize;
+  SPDM_SECURE_SESSION_KEYS_STRUCT        *SessionkeysStruct;
+  UINT8                                  *Ptr;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  StructSize = sizeof(SPDM_SECURE_SESSION_KEYS_STRUCT) + (SecuredMessageContext->AeadKeySize + SecuredMessageContext->AeadIvSize + sizeof(UINT64)) * 2;
+
+  if (SessionKeysSize != StructSize) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  SessionkeysStruct = SessionKeys;
+  if ((SessionkeysStruct->Version != SPDM_SECURE_SESSION_KEYS_STRUCT_VERSION) ||
+      (SessionkeysStruct->AeadKeySize != SecuredMessageContext->AeadKeySize) ||
+      (SessionkeysStruct->AeadIvSize != SecuredMessageContext->AeadIvSize) ) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Ptr = (VOID *)(SessionkeysStruct + 1);
+  CopyMem (SecuredMessageContext->ApplicationSecret.RequestDataEncryptionKey, Ptr, SecuredMessageContext->AeadKeySize);
+  Ptr += SecuredMessageContext->AeadKeySize;
+  CopyMem (SecuredMessageContext->ApplicationSecret.RequestDataSalt, Ptr, SecuredMessageContext->AeadIvSize);
+  Ptr += SecuredMessageContext->AeadIvSize;
+  CopyMem (&SecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber, Ptr, sizeof(UINT64));
+  Ptr += sizeof(UINT64);
+  CopyMem (SecuredMessageContext->ApplicationSecret.ResponseDataEncryptionKey, Ptr, SecuredMessageContext->AeadKeySize);
+  Ptr += SecuredMessageContext->AeadKeySize;
+  CopyMem (SecuredMessageContext->ApplicationSecret.ResponseDataSalt, Ptr, SecuredMessageContext->AeadIvSize);
+  Ptr += SecuredMessageContext->AeadIvSize;
+  CopyMem (&SecuredMessageContext->ApplicationSecret.ResponseDataSequenceNumber, Ptr, sizeof(UINT64));
+  Ptr += sizeof(UINT64);
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+  //
+  // The records below the imported sequence numbers may have been decoded before the export,
+  // so all of them are marked as decoded.
+  //
+  SecuredMessageContext->ApplicationSecret.RequestDataReplayWindow = MAX_UINT64;
+  SecuredMessageContext->ApplicationSecret.ResponseDataReplayWindow = MAX_UINT64;
+#endif
+  return RETURN_SUCCESS;
+}
+
+/**
+  Copy the secrets between an SPDM secured message context and an SPDM_SECURE_SESSION_SECRETS_STRUCT.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  SessionSecretsStruct         A pointer to the SPDM_SECURE_SESSION_SECRETS_STRUCT.
+  @param  Export                       TRUE to copy from the context, FALSE to copy to the context.
+**/
+VOID
+SpdmSecuredMessageCopySessionSecrets (
+  IN OUT SPDM_SECURED_MESSAGE_CONTEXT         *SecuredMessageContext,
+  IN OUT SPDM_SECURE_SESSION_SECRETS_STRUCT   *SessionSecretsStruct,
+  IN     BOOLEAN                              Export
+  )
+{
+  struct {
+    UINT8   *Secret;
+    UINTN   Size;
+  }       Field[17];
+  UINTN   Index;
+  UINT8   *Ptr;
+
+  Field[0].Secret  = SecuredMessageContext->MasterSecret.HandshakeSecret;
+  Field[1].Secret  = SecuredMessageContext->HandshakeSecret.RequestHandshakeSecret;
+  Field[2].Secret  = SecuredMessageContext->HandshakeSecret.RequestFinishedKey;
+  Field[3].Secret  = SecuredMessageContext->HandshakeSecret.RequestHandshakeEncryptionKey;
+  Field[4].Secret  = SecuredMessageContext->HandshakeSecret.RequestHandshakeSalt;
+  Field[5].Secret  = SecuredMessageContext->HandshakeSecret.ResponseHandshakeSecret;
+  Field[6].Secret  = SecuredMessageContext->HandshakeSecret.ResponseFinishedKey;
+  Field[7].Secret  = SecuredMessageContext->HandshakeSecret.ResponseHandshakeEncryptionKey;
+  Field[8].Secret  = SecuredMessageContext->HandshakeSecret.ResponseHandshakeSalt;
+  Field[9].Secret  = SecuredMessageContext->MasterSecret.MasterSecret;
+  Field[10].Secret = SecuredMessageContext->HandshakeSecret.ExportMasterSecret;
+  Field[11].Secret = SecuredMessageContext->ApplicationSecret.RequestDataSecret;
+  Field[12].Secret = SecuredMessageContext->ApplicationSecret.RequestDataEncryptionKey;
+  Field[13].Secret = SecuredMessageContext->ApplicationSecret.RequestDataSalt;
+  Field[14].Secret = SecuredMessageContext->ApplicationSecret.ResponseDataSecret;
+  Field[15].Secret = SecuredMessageContext->ApplicationSecret.ResponseDataEncryptionKey;
+  Field[16].Secret = SecuredMessageContext->ApplicationSecret.ResponseDataSalt;
+  for (Index = 0; Index < ARRAY_SIZE(Field); Index++) {
+    Field[Index].Size = SecuredMessageContext->HashSize;
+  }
+  Field[3].Size  = SecuredMessageContext->AeadKeySize;
+  Field[4].Size  = SecuredMessageContext->AeadIvSize;
+  Field[7].Size  = SecuredMessageContext->AeadKeySize;
+  Field[8].Size  = SecuredMessageContext->AeadIvSize;
+  Field[12].Size = SecuredMessageContext->AeadKeySize;
+  Field[13].Size = SecuredMessageContext->AeadIvSize;
+  Field[15].Size = SecuredMessageContext->AeadKeySize;
+  Field[16].Size = SecuredMessageContext->AeadIvSize;
+
+  Ptr = (VOID *)(SessionSecretsStruct + 1);
+  for (Index = 0; Index < ARRAY_SIZE(Field); Index++) {
+    if (Export) {
+      CopyMem (Ptr, Field[Index].Secret, Field[Index].Size);
+    } else {
+      CopyMem (Field[Index].Secret, Ptr, Field[Index].Size);
+    }
+    Ptr += Field[Index].Size;
+  }
+}
+
+/**
+  Export the derived secrets of the key schedule from an SPDM secured message context.
+
+  The secrets are the handshake secrets, the master secrets and the current generation of the data secrets,
+  with their keys. The DHE secret and the sequence numbers are not exported.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionSecrets               Indicate the buffer to store the SessionSecrets in SPDM_SECURE_SESSION_SECRETS_STRUCT.
+  @param  SessionSecretsSize           The size in bytes of the SessionSecrets in SPDM_SECURE_SESSION_SECRETS_STRUCT.
+
+  @retval RETURN_SUCCESS  SessionSecrets are exported.
+*/
+RETURN_STATUS
+EFIAPI
+SpdmSecuredMessageExportSessionSecrets (
+  IN     VOID                         *SpdmSecuredMessageContext,
+     OUT VOID                         *SessionSecrets,
+  IN OUT UINTN                        *SessionSecretsSize
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+  UINTN                                  StructSize;
+  SPDM_SECURE_SESSION_SECRETS_STRUCT     *SessionSecretsStruct;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  StructSize = sizeof(SPDM_SECURE_SESSION_SECRETS_STRUCT) +
+               SecuredMessageContext->HashSize * 9 + (SecuredMessageContext->AeadKeySize + SecuredMessageContext->AeadIvSize) * 4;
+
+  if (*SessionSecretsSize < StructSize) {
+    *SessionSecretsSize = StructSize;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *SessionSecretsSize = StructSize;
+
+  SessionSecretsStruct = SessionSecrets;
+  SessionSecretsStruct->Version = SPDM_SECURE_SESSION_SECRETS_STRUCT_VERSION;
+  SessionSecretsStruct->HashSize = (UINT32)SecuredMessageContext->HashSize;
+  SessionSecretsStruct->AeadKeySize = (UINT32)SecuredMessageContext->AeadKeySize;
+  SessionSecretsStruct->AeadIvSize = (UINT32)SecuredMessageContext->AeadIvSize;
+  SpdmSecuredMessageCopySessionSecrets (SecuredMessageContext, SessionSecretsStruct, TRUE);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Import the derived secrets of the key schedule to an SPDM secured message context,
+  instead of generating them from the DHE secret.
+
+  The sequence numbers are not changed.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionSecrets               Indicate the buffer to store the SessionSecrets in SPDM_SECURE_SESSION_SECRETS_STRUCT.
+  @param  SessionSecretsSize           The size in bytes of the SessionSecrets in SPDM_SECURE_SESSION_SECRETS_STRUCT.
+
+  @retval RETURN_SUCCESS  SessionSecrets are imported.
+*/
+RETURN_STATUS
+EFIAPI
+SpdmSecuredMessageImportSessionSecrets (
+  IN     VOID                         *SpdmSecuredMessageContext,
+  IN     VOID                         *SessionSecrets,
+  IN     UINTN                        SessionSecretsSize
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+  UINTN                                  StructSize;
+  SPDM_SECURE_SESSION_SECRETS_STRUCT     *SessionSecretsStruct;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  StructSize = sizeof(SPDM_SECURE_SESSION_SECRETS_STRUCT) +
+               SecuredMessageContext->HashSize * 9 + (SecuredMessageContext->AeadKeySize + SecuredMessageContext->AeadIvSize) * 4;
+
+  if (SessionSecretsSize != StructSize) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  SessionSecretsStruct = SessionSecrets;
+  if ((SessionSecretsStruct->Version != SPDM_SECURE_SESSION_SECRETS_STRUCT_VERSION) ||
+      (SessionSecretsStruct->HashSize != SecuredMessageContext->HashSize) ||
+      (SessionSecretsStruct->AeadKeySize != SecuredMessageContext->AeadKeySize) ||
+      (SessionSecretsStruct->AeadIvSize != SecuredMessageContext->AeadIvSize) ) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  SpdmSecuredMessageCopySessionSecrets (SecuredMessageContext, SessionSecretsStruct, FALSE);
+  //
+  // The next generation of the DataKey was derived from the previous data secrets.
+  //
+  SecuredMessageContext->RequestDataNextReady = FALSE;
+  SecuredMessageContext->ResponseDataNextReady = FALSE;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Get the last SPDM error struct of an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  LastSpdmError                Last SPDM error struct of an SPDM context.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageGetLastSpdmErrorStruct (
+  IN     VOID                      *SpdmSecuredMessageContext,
+     OUT SPDM_ERROR_STRUCT         *LastSpdmError
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  CopyMem (LastSpdmError, &SecuredMessageContext->LastSpdmError, sizeof(SPDM_ERROR_STRUCT));
+}
+
+/**
+  Set the last SPDM error struct of an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  LastSpdmError                Last SPDM error struct of an SPDM context.
+*/
+VOID
+EFIAPI
+SpdmSecuredMessageSetLastSpdmErrorStruct (
+  IN     VOID                      *SpdmSecuredMessageContext,
+  IN     SPDM_ERROR_STRUCT         *LastSpdmError
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  CopyMem (&SecuredMessageContext->LastSpdmError, LastSpdmError, sizeof(SPDM_ERROR_STRUCT));
+}
@@ -10,142 +10,767 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "SpdmSecuredMessageLibInternal.h"
 
 /**
-  Encode an application message to a secured message.
+  Performs AEAD authenticated encryption for one record, with the keyed AEAD handle of the direction.
+
+  If the key of the direction is offloaded, the inline crypto engine is used instead.
+  If the keyed AEAD handle is not available, the one-shot SpdmAeadEncryption is used with Key.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot of the direction.
+  @param  Key                          Pointer to the encryption key.
+  @param  Iv                           Pointer to the IV value.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be encrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  DataOut                      Pointer to a buffer that receives the encryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
+**/
+BOOLEAN
+SpdmSecuredMessageAeadEncryption (
+  IN   SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN   SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN   CONST UINT8                        *Key,
+  IN   CONST UINT8                        *Iv,
+  IN   CONST UINT8                        *AData,
+  IN   UINTN                              ADataSize,
+  IN   CONST UINT8                        *DataIn,
+  IN   UINTN                              DataInSize,
+  OUT  UINT8                              *TagOut,
+  OUT  UINT8                              *DataOut,
+  OUT  UINTN                              *DataOutSize
+  )
+{
+  VOID     *AeadHandle;
+  BOOLEAN  IsRequester;
+
+  if (SpdmSecuredMessageIsOffloaded (SecuredMessageContext, AeadContext, Key, &IsRequester)) {
+    return SecuredMessageContext->OffloadOps->Seal (
+             SecuredMessageContext->OffloadContext,
+             SecuredMessageContext->SessionId,
+             IsRequester,
+             Iv,
+             SecuredMessageContext->AeadIvSize,
+             AData,
+             ADataSize,
+             DataIn,
+             DataInSize,
+             TagOut,
+             SecuredMessageContext->AeadTagSize,
+             DataOut,
+             DataOutSize
+             );
+  }
+
+  AeadHandle = SpdmSecuredMessageGetAeadContext (SecuredMessageContext, AeadContext, Key);
+  if (AeadHandle != NULL) {
+    return SpdmAeadSeal (
+             SecuredMessageContext->AEADCipherSuite,
+             AeadHandle,
+             Iv,
+             SecuredMessageContext->AeadIvSize,
+             AData,
+             ADataSize,
+             DataIn,
+             DataInSize,
+             TagOut,
+             SecuredMessageContext->AeadTagSize,
+             DataOut,
+             DataOutSize
+             );
+  }
+  return SpdmAeadEncryption (
+           SecuredMessageContext->AEADCipherSuite,
+           Key,
+           SecuredMessageContext->AeadKeySize,
+           Iv,
+           SecuredMessageContext->AeadIvSize,
+           AData,
+           ADataSize,
+           DataIn,
+           DataInSize,
+           TagOut,
+           SecuredMessageContext->AeadTagSize,
+           DataOut,
+           DataOutSize
+           );
+}
+
+/**
+  Performs AEAD authenticated decryption for one record, with the keyed AEAD handle of the direction.
+
+  If the key of the direction is offloaded, the inline crypto engine is used instead.
+  If the keyed AEAD handle is not available, the one-shot SpdmAeadDecryption is used with Key.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot of the direction.
+  @param  Key                          Pointer to the encryption key.
+  @param  Iv                           Pointer to the IV value.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  DataOut                      Pointer to a buffer that receives the decryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
+**/
+BOOLEAN
+SpdmSecuredMessageAeadDecryption (
+  IN   SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN   SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN   CONST UINT8                        *Key,
+  IN   CONST UINT8                        *Iv,
+  IN   CONST UINT8                        *AData,
+  IN   UINTN                              ADataSize,
+  IN   CONST UINT8                        *DataIn,
+  IN   UINTN                              DataInSize,
+  IN   CONST UINT8                        *Tag,
+  OUT  UINT8                              *DataOut,
+  OUT  UINTN                              *DataOutSize
+  )
+{
+  VOID     *AeadHandle;
+  BOOLEAN  IsRequester;
+
+  if (SpdmSecuredMessageIsOffloaded (SecuredMessageContext, AeadContext, Key, &IsRequester)) {
+    return SecuredMessageContext->OffloadOps->Open (
+             SecuredMessageContext->OffloadContext,
+             SecuredMessageContext->SessionId,
+             IsRequester,
+             Iv,
+             SecuredMessageContext->AeadIvSize,
+             AData,
+             ADataSize,
+             DataIn,
+             DataInSize,
+             Tag,
+             SecuredMessageContext->AeadTagSize,
+             DataOut,
+             DataOutSize
+             );
+  }
+
+  AeadHandle = SpdmSecuredMessageGetAeadContext (SecuredMessageContext, AeadContext, Key);
+  if (AeadHandle != NULL) {
+    return SpdmAeadOpen (
+             SecuredMessageContext->AEADCipherSuite,
+             AeadHandle,
+             Iv,
+             SecuredMessageContext->AeadIvSize,
+             AData,
+             ADataSize,
+             DataIn,
+             DataInSize,
+             Tag,
+             SecuredMessageContext->AeadTagSize,
+             DataOut,
+             DataOutSize
+             );
+  }
+  return SpdmAeadDecryption (
+           SecuredMessageContext->AEADCipherSuite,
+           Key,
+           SecuredMessageContext->AeadKeySize,
+           Iv,
+           SecuredMessageContext->AeadIvSize,
+           AData,
+           ADataSize,
+           DataIn,
+           DataInSize,
+           Tag,
+           SecuredMessageContext->AeadTagSize,
+           DataOut,
+           DataOutSize
+           );
+}
+
+/**
+  Generates the AEAD authentication tag for one MAC-only record, with the keyed AEAD handle of the direction.
+
+  No plain text is encrypted, so only the AAD is authenticated, e.g. GMAC for AES-GCM.
+  If the key of the direction is offloaded, the inline crypto engine is used with an empty plain text instead.
+  If the keyed AEAD handle is not available, the one-shot SpdmAeadEncryption is used with Key.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot of the direction.
+  @param  Key                          Pointer to the encryption key.
+  @param  Iv                           Pointer to the IV value.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+
+  @retval TRUE   AEAD authentication tag generation succeeded.
+  @retval FALSE  AEAD authentication tag generation failed.
+**/
+BOOLEAN
+SpdmSecuredMessageAeadMac (
+  IN   SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN   SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN   CONST UINT8                        *Key,
+  IN   CONST UINT8                        *Iv,
+  IN   CONST UINT8                        *AData,
+  IN   UINTN                              ADataSize,
+  OUT  UINT8                              *TagOut
+  )
+{
+  VOID     *AeadHandle;
+  BOOLEAN  IsRequester;
+
+  if (SpdmSecuredMessageIsOffloaded (SecuredMessageContext, AeadContext, Key, &IsRequester)) {
+    return SecuredMessageContext->OffloadOps->Seal (
+             SecuredMessageContext->OffloadContext,
+             SecuredMessageContext->SessionId,
+             IsRequester,
+             Iv,
+             SecuredMessageContext->AeadIvSize,
+             AData,
+             ADataSize,
+             NULL,
+             0,
+             TagOut,
+             SecuredMessageContext->AeadTagSize,
+             NULL,
+             NULL
+             );
+  }
+
+  AeadHandle = SpdmSecuredMessageGetAeadContext (SecuredMessageContext, AeadContext, Key);
+  if (AeadHandle != NULL) {
+    return SpdmAeadMac (
+             SecuredMessageContext->AEADCipherSuite,
+             AeadHandle,
+             Iv,
+             SecuredMessageContext->AeadIvSize,
+             AData,
+             ADataSize,
+             TagOut,
+             SecuredMessageContext->AeadTagSize
+             );
+  }
+  return SpdmAeadEncryption (
+           SecuredMessageContext->AEADCipherSuite,
+           Key,
+           SecuredMessageContext->AeadKeySize,
+           Iv,
+           SecuredMessageContext->AeadIvSize,
+           AData,
+           ADataSize,
+           NULL,
+           0,
+           TagOut,
+           SecuredMessageContext->AeadTagSize,
+           NULL,
+           NULL
+           );
+}
+
+/**
+  Verifies the AEAD authentication tag of one MAC-only record, with the keyed AEAD handle of the direction.
+
+  No cipher text is decrypted, so only the AAD is authenticated, e.g. GMAC for AES-GCM.
+  If the key of the direction is offloaded, the inline crypto engine is used with an empty cipher text instead.
+  If the keyed AEAD handle is not available, the one-shot SpdmAeadDecryption is used with Key.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot of the direction.
+  @param  Key                          Pointer to the encryption key.
+  @param  Iv                           Pointer to the IV value.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+
+  @retval TRUE   AEAD authentication tag verification succeeded.
+  @retval FALSE  AEAD authentication tag verification failed.
+**/
+BOOLEAN
+SpdmSecuredMessageAeadVerifyMac (
+  IN   SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN   SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN   CONST UINT8                        *Key,
+  IN   CONST UINT8                        *Iv,
+  IN   CONST UINT8                        *AData,
+  IN   UINTN                              ADataSize,
+  IN   CONST UINT8                        *Tag
+  )
+{
+  VOID     *AeadHandle;
+  BOOLEAN  IsRequester;
+
+  if (SpdmSecuredMessageIsOffloaded (SecuredMessageContext, AeadContext, Key, &IsRequester)) {
+    return SecuredMessageContext->OffloadOps->Open (
+             SecuredMessageContext->OffloadContext,
+             SecuredMessageContext->SessionId,
+             IsRequester,
+             Iv,
+             SecuredMessageContext->AeadIvSize,
+             AData,
+             ADataSize,
+             NULL,
+             0,
+             Tag,
+             SecuredMessageContext->AeadTagSize,
+             NULL,
+             NULL
+             );
+  }
+
+  AeadHandle = SpdmSecuredMessageGetAeadContext (SecuredMessageContext, AeadContext, Key);
+  if (AeadHandle != NULL) {
+    return SpdmAeadVerifyMac (
+             SecuredMessageContext->AEADCipherSuite,
+             AeadHandle,
+             Iv,
+             SecuredMessageContext->AeadIvSize,
+             AData,
+             ADataSize,
+             Tag,
+             SecuredMessageContext->AeadTagSize
+             );
+  }
+  return SpdmAeadDecryption (
+           SecuredMessageContext->AEADCipherSuite,
+           Key,
+           SecuredMessageContext->AeadKeySize,
+           Iv,
+           SecuredMessageContext->AeadIvSize,
+           AData,
+           ADataSize,
+           NULL,
+           0,
+           Tag,
+           SecuredMessageContext->AeadTagSize,
+           NULL,
+           NULL
+           );
+}
+
+/**
+  Performs AEAD authenticated encryption for one record whose plain text is a list of segments,
+  with the keyed AEAD handle of the direction.
+
+  The cipher text is written contiguously to DataOut. A segment may only overlap DataOut
+  at the offset where its own cipher text is written.
+  If the key of the direction is offloaded or the keyed AEAD handle is not available,
+  the segments are gathered into DataOut, and the inline crypto engine or the one-shot
+  SpdmAeadEncryption is used in place.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot of the direction.
+  @param  Key                          Pointer to the encryption key.
+  @param  Iv                           Pointer to the IV value.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the list of input data segments to be encrypted.
+  @param  DataInCount                  Number of entries in DataIn.
+  @param  TagOut                       Pointer to a buffer that receives the authentication tag output.
+  @param  DataOut                      Pointer to a buffer that receives the encryption output.
+  @param  DataOutSize                  Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
+**/
+BOOLEAN
+SpdmSecuredMessageAeadEncryptionSegments (
+  IN   SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN   SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN   CONST UINT8                        *Key,
+  IN   CONST UINT8                        *Iv,
+  IN   CONST UINT8                        *AData,
+  IN   UINTN                              ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT           *DataIn,
+  IN   UINTN                              DataInCount,
+  OUT  UINT8                              *TagOut,
+  OUT  UINT8                              *DataOut,
+  IN OUT UINTN                            *DataOutSize
+  )
+{
+  VOID     *AeadHandle;
+  BOOLEAN  IsRequester;
+  UINTN    Index;
+  UINTN    Offset;
+
+  AeadHandle = NULL;
+  if (!SpdmSecuredMessageIsOffloaded (SecuredMessageContext, AeadContext, Key, &IsRequester)) {
+    AeadHandle = SpdmSecuredMessageGetAeadContext (SecuredMessageContext, AeadContext, Key);
+  }
+  if (AeadHandle != NULL) {
+    return SpdmAeadSealSegments (
+             SecuredMessageContext->AEADCipherSuite,
+             AeadHandle,
+             Iv,
+             SecuredMessageContext->AeadIvSize,
+             AData,
+             ADataSize,
+             DataIn,
+             DataInCount,
+             TagOut,
+             SecuredMessageContext->AeadTagSize,
+             DataOut,
+             DataOutSize
+             );
+  }
+
+  Offset = 0;
+  for (Index = 0; Index < DataInCount; Index++) {
+    if (DataIn[Index].Size > *DataOutSize - Offset) {
+      return FALSE;
+    }
+    CopyMem (DataOut + Offset, DataIn[Index].Buffer, DataIn[Index].Size);
+    Offset += DataIn[Index].Size;
+  }
+  return SpdmSecuredMessageAeadEncryption (
+           SecuredMessageContext,
+           AeadContext,
+           Key,
+           Iv,
+           AData,
+           ADataSize,
+           DataOut,
+           Offset,
+           TagOut,
+           DataOut,
+           DataOutSize
+           );
+}
+
+/**
+  Performs AEAD authenticated decryption for one record into a staging buffer,
+  and scatters the plain text over a list of segments.
+
+  Plain text that does not fit in the segments is discarded.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot of the direction.
+  @param  Key                          Pointer to the encryption key.
+  @param  Iv                           Pointer to the IV value.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  DataOut                      Pointer to the list of segments that receive the decryption output.
+  @param  DataOutCount                 Number of entries in DataOut.
+
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
+**/
+BOOLEAN
+SpdmSecuredMessageAeadDecryptionStaged (
+  IN   SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN   SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN   CONST UINT8                        *Key,
+  IN   CONST UINT8                        *Iv,
+  IN   CONST UINT8                        *AData,
+  IN   UINTN                              ADataSize,
+  IN   CONST UINT8                        *DataIn,
+  IN   UINTN                              DataInSize,
+  IN   CONST UINT8                        *Tag,
+  IN   CONST CRYPT_DATA_SEGMENT           *DataOut,
+  IN   UINTN                              DataOutCount
+  )
+{
+  BOOLEAN  Result;
+  UINTN    Index;
+  UINTN    Offset;
+  UINTN    Length;
+  UINTN    DecMessageSize;
+  UINT8    DecMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+
+  if (DataInSize > sizeof(DecMessage)) {
+    return FALSE;
+  }
+  DecMessageSize = DataInSize;
+  Result = SpdmSecuredMessageAeadDecryption (
+             SecuredMessageContext,
+             AeadContext,
+             Key,
+             Iv,
+             AData,
+             ADataSize,
+             DataIn,
+             DataInSize,
+             Tag,
+             DecMessage,
+             &DecMessageSize
+             );
+  if (Result) {
+    Offset = 0;
+    for (Index = 0; (Index < DataOutCount) && (Offset < DecMessageSize); Index++) {
+      Length = MIN (DataOut[Index].Size, DecMessageSize - Offset);
+      CopyMem (DataOut[Index].Buffer, DecMessage + Offset, Length);
+      Offset += Length;
+    }
+  }
+  ZeroMem (DecMessage, DataInSize);
+  return Result;
+}
+
+/**
+  Performs AEAD authenticated decryption for one record into a list of segments,
+  with the keyed AEAD handle of the direction.
+
+  Plain text that does not fit in the segments is discarded after it is authenticated.
+  If the key of the direction is offloaded, the keyed AEAD handle is not available,
+  or the segments cannot hold the whole plain text, a staging buffer is used.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot of the direction.
+  @param  Key                          Pointer to the encryption key.
+  @param  Iv                           Pointer to the IV value.
+  @param  AData                        Pointer to the additional authenticated data (AAD).
+  @param  ADataSize                    Size of the additional authenticated data (AAD) in bytes.
+  @param  DataIn                       Pointer to the input data buffer to be decrypted.
+  @param  DataInSize                   Size of the input data buffer in bytes.
+  @param  Tag                          Pointer to a buffer that contains the authentication tag.
+  @param  DataOut                      Pointer to the list of segments that receive the decryption output.
+  @param  DataOutCount                 Number of entries in DataOut.
+
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
+**/
+BOOLEAN
+SpdmSecuredMessageAeadDecryptionSegments (
+  IN   SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN   SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN   CONST UINT8                        *Key,
+  IN   CONST UINT8                        *Iv,
+  IN   CONST UINT8                        *AData,
+  IN   UINTN                              ADataSize,
+  IN   CONST UINT8                        *DataIn,
+  IN   UINTN                              DataInSize,
+  IN   CONST UINT8                        *Tag,
+  IN   CONST CRYPT_DATA_SEGMENT           *DataOut,
+  IN   UINTN                              DataOutCount
+  )
+{
+  VOID     *AeadHandle;
+  BOOLEAN  IsRequester;
+  UINTN    Index;
+  UINTN    Capacity;
+
+  Capacity = 0;
+  for (Index = 0; (Index < DataOutCount) && (Capacity < DataInSize); Index++) {
+    Capacity += MIN (DataOut[Index].Size, DataInSize - Capacity);
+  }
+
+  AeadHandle = NULL;
+  if (!SpdmSecuredMessageIsOffloaded (SecuredMessageContext, AeadContext, Key, &IsRequester)) {
+    AeadHandle = SpdmSecuredMessageGetAeadContext (SecuredMessageContext, AeadContext, Key);
+  }
+  if ((AeadHandle != NULL) && (Capacity == DataInSize)) {
+    return SpdmAeadOpenSegments (
+             SecuredMessageContext->AEADCipherSuite,
+             AeadHandle,
+             Iv,
+             SecuredMessageContext->AeadIvSize,
+             AData,
+             ADataSize,
+             DataIn,
+             DataInSize,
+             Tag,
+             SecuredMessageContext->AeadTagSize,
+             DataOut,
+             DataOutCount
+             );
+  }
+  return SpdmSecuredMessageAeadDecryptionStaged (
+           SecuredMessageContext,
+           AeadContext,
+           Key,
+           Iv,
+           AData,
+           ADataSize,
+           DataIn,
+           DataInSize,
+           Tag,
+           DataOut,
+           DataOutCount
+           );
+}
+
+/**
+  Return the room that a secured message needs around its application message.
+
+  An application message at Headroom bytes into a buffer, followed by at least Tailroom spare bytes,
+  can be encoded to a secured message in place at the start of that buffer.
+  A secured message at the start of a buffer can be decoded in place to an application message
+  at Headroom bytes into that buffer.
 
   @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
-  @param  SessionId                    The session ID of the SPDM session.
-  @param  IsRequester                  Indicates if it is a requester message.
-  @param  AppMessageSize               Size in bytes of the application message data buffer.
-  @param  AppMessage                   A pointer to a source buffer to store the application message.
-  @param  SecuredMessageSize           Size in bytes of the secured message data buffer.
-  @param  SecuredMessage               A pointer to a destination buffer to store the secured message.
   @param  SpdmSecuredMessageCallbacks  A pointer to a secured message callback functions structure.
-
-  @retval RETURN_SUCCESS               The application message is encoded successfully.
-  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+  @param  Headroom                     Size in bytes of the secured message data before the application message.
+  @param  Tailroom                     Max size in bytes of the secured message data after the application message.
 **/
-RETURN_STATUS
+VOID
 EFIAPI
-SpdmEncodeSecuredMessage (
+SpdmSecuredMessageGetMessageRoom (
   IN     VOID                           *SpdmSecuredMessageContext,
-  IN     UINT32                         SessionId,
-  IN     BOOLEAN                        IsRequester,
-  IN     UINTN                          AppMessageSize,
-  IN     VOID                           *AppMessage,
-  IN OUT UINTN                          *SecuredMessageSize,
-     OUT VOID                           *SecuredMessage,
-  IN     SPDM_SECURED_MESSAGE_CALLBACKS *SpdmSecuredMessageCallbacks
+  IN     SPDM_SECURED_MESSAGE_CALLBACKS *SpdmSecuredMessageCallbacks,
+     OUT UINTN                          *Headroom,
+     OUT UINTN                          *Tailroom
   )
 {
   SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext;
-  UINTN                              TotalSecuredMessageSize;
-  UINTN                              PlainTextSize;
-  UINTN                              CipherTextSize;
-  UINTN                              AeadPadSize;
-  UINTN                              AeadBlockSize;
-  UINTN                              AeadTagSize;
-  UINTN                              AeadKeySize;
-  UINTN                              AeadIvSize;
-  UINT8                              *AData;
-  UINT8                              *EncMsg;
-  UINT8                              *DecMsg;
-  UINT8                              *Tag;
-  SPDM_SECURED_MESSAGE_ADATA_HEADER_1 *RecordHeader1;
-  SPDM_SECURED_MESSAGE_ADATA_HEADER_2 *RecordHeader2;
-  UINTN                              RecordHeaderSize;
-  SPDM_SECURED_MESSAGE_CIPHER_HEADER *EncMsgHeader;
-  BOOLEAN                            Result;
-  UINT8                              Key[MAX_AEAD_KEY_SIZE];
-  UINT8                              Salt[MAX_AEAD_IV_SIZE];
-  UINT64                             SequenceNumber;
   UINT64                             SequenceNumInHeader;
   UINT8                              SequenceNumInHeaderSize;
-  SPDM_SESSION_TYPE                  SessionType;
-  UINT32                             RandCount;
-  UINT32                             MaxRandCount;
-  SPDM_SESSION_STATE                 SessionState;
 
   SecuredMessageContext = SpdmSecuredMessageContext;
 
-  SessionType = SecuredMessageContext->SessionType;
-  ASSERT ((SessionType == SpdmSessionTypeMacOnly) || (SessionType == SpdmSessionTypeEncMac));
-  SessionState = SecuredMessageContext->SessionState;
-  ASSERT ((SessionState == SpdmSessionStateHandshaking) || (SessionState == SpdmSessionStateEstablished));
+  SequenceNumInHeader = 0;
+  SequenceNumInHeaderSize = SpdmSecuredMessageCallbacks->GetSequenceNumber (0, (UINT8 *)&SequenceNumInHeader);
+  ASSERT (SequenceNumInHeaderSize <= sizeof(SequenceNumInHeader));
 
-  AeadBlockSize = SecuredMessageContext->AeadBlockSize;
-  AeadTagSize = SecuredMessageContext->AeadTagSize;
-  AeadKeySize = SecuredMessageContext->AeadKeySize;
-  AeadIvSize = SecuredMessageContext->AeadIvSize;
+  *Headroom = sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_1) + SequenceNumInHeaderSize + sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_2);
+  *Tailroom = SecuredMessageContext->AeadTagSize;
+  if (SecuredMessageContext->SessionType == SpdmSessionTypeEncMac) {
+    *Headroom += sizeof(SPDM_SECURED_MESSAGE_CIPHER_HEADER);
+    *Tailroom += SpdmSecuredMessageCallbacks->GetMaxRandomNumberCount () + SecuredMessageContext->AeadBlockSize - 1;
+  }
+}
+
+/**
+  Return the key, the salt, the sequence number and the AEAD handle slot of one direction
+  in the current state of a session.
+
+  The key is installed in the inline crypto engine first, if one is registered.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  Key                          Return the encryption key of the direction.
+  @param  Salt                         Return the salt of the direction.
+  @param  SequenceNumber               Return the sequence number of the direction.
+  @param  AeadContext                  Return the AEAD handle slot of the direction.
 
-  switch (SessionState) {
+  @retval RETURN_SUCCESS               The direction is returned.
+  @retval RETURN_UNSUPPORTED           The session state has no secured messages,
+                                       or the handshake messages are sent in the clear.
+**/
+RETURN_STATUS
+SpdmSecuredMessageGetDirection (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN     BOOLEAN                            IsRequester,
+     OUT UINT8                              **Key,
+     OUT UINT8                              **Salt,
+     OUT UINT64                             **SequenceNumber,
+     OUT SPDM_SECURED_MESSAGE_AEAD_CONTEXT  **AeadContext
+  )
+{
+  switch (SecuredMessageContext->SessionState) {
   case SpdmSessionStateHandshaking:
+    if (SecuredMessageContext->HandshakeInTheClear && !SecuredMessageContext->UsePsk) {
+      return RETURN_UNSUPPORTED;
+    }
     if (IsRequester) {
-      CopyMem (Key, SecuredMessageContext->HandshakeSecret.RequestHandshakeEncryptionKey, SecuredMessageContext->AeadKeySize);
-      CopyMem (Salt, SecuredMessageContext->HandshakeSecret.RequestHandshakeSalt, SecuredMessageContext->AeadIvSize);
-      SequenceNumber = SecuredMessageContext->HandshakeSecret.RequestHandshakeSequenceNumber;
+      *Key = SecuredMessageContext->HandshakeSecret.RequestHandshakeEncryptionKey;
+      *Salt = SecuredMessageContext->HandshakeSecret.RequestHandshakeSalt;
+      *SequenceNumber = &SecuredMessageContext->HandshakeSecret.RequestHandshakeSequenceNumber;
+      *AeadContext = &SecuredMessageContext->RequestHandshakeAead;
     } else {
-      CopyMem (Key, SecuredMessageContext->HandshakeSecret.ResponseHandshakeEncryptionKey, SecuredMessageContext->AeadKeySize);
-      CopyMem (Salt, SecuredMessageContext->HandshakeSecret.ResponseHandshakeSalt, SecuredMessageContext->AeadIvSize);
-      SequenceNumber = SecuredMessageContext->HandshakeSecret.ResponseHandshakeSequenceNumber;
+      *Key = SecuredMessageContext->HandshakeSecret.ResponseHandshakeEncryptionKey;
+      *Salt = SecuredMessageContext->HandshakeSecret.ResponseHandshakeSalt;
+      *SequenceNumber = &SecuredMessageContext->HandshakeSecret.ResponseHandshakeSequenceNumber;
+      *AeadContext = &SecuredMessageContext->ResponseHandshakeAead;
     }
     break;
   case SpdmSessionStateEstablished:
     if (IsRequester) {
-      CopyMem (Key, SecuredMessageContext->ApplicationSecret.RequestDataEncryptionKey, SecuredMessageContext->AeadKeySize);
-      CopyMem (Salt, SecuredMessageContext->ApplicationSecret.RequestDataSalt, SecuredMessageContext->AeadIvSize);
-      SequenceNumber = SecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber;
+      *Key = SecuredMessageContext->ApplicationSecret.RequestDataEncryptionKey;
+      *Salt = SecuredMessageContext->ApplicationSecret.RequestDataSalt;
+      *SequenceNumber = &SecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber;
+      *AeadContext = &SecuredMessageContext->RequestDataAead;
     } else {
-      CopyMem (Key, SecuredMessageContext->ApplicationSecret.ResponseDataEncryptionKey, SecuredMessageContext->AeadKeySize);
-      CopyMem (Salt, SecuredMessageContext->ApplicationSecret.ResponseDataSalt, SecuredMessageContext->AeadIvSize);
-      SequenceNumber = SecuredMessageContext->ApplicationSecret.ResponseDataSequenceNumber;
+      *Key = SecuredMessageContext->ApplicationSecret.ResponseDataEncryptionKey;
+      *Salt = SecuredMessageContext->ApplicationSecret.ResponseDataSalt;
+      *SequenceNumber = &SecuredMessageContext->ApplicationSecret.ResponseDataSequenceNumber;
+      *AeadContext = &SecuredMessageContext->ResponseDataAead;
     }
     break;
   default:
     ASSERT(FALSE);
     return RETURN_UNSUPPORTED;
-    break;
   }
+  //
+  // If the key cannot be installed in the inline crypto engine, the software AEAD is used.
+  //
+  SpdmSecuredMessageOffloadKey (SecuredMessageContext, IsRequester, *Key, *Salt);
+  return RETURN_SUCCESS;
+}
 
-  if (SequenceNumber == (UINT64)-1) {
-    return RETURN_OUT_OF_RESOURCES;
-  }
+/**
+  Encode an application message to one secured message record with a reserved sequence number.
 
-  *(UINT64 *)Salt = *(UINT64 *)Salt ^ SequenceNumber;
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot of the direction.
+  @param  Key                          Pointer to the encryption key of the direction.
+  @param  Salt                         Pointer to the salt of the direction.
+  @param  SequenceNumber               The sequence number of the record.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  AppMessageSize               Size in bytes of the application message data buffer.
+  @param  AppMessage                   A pointer to a source buffer to store the application message.
+  @param  RandCount                    Number of random bytes after the application message, for EncMac sessions.
+  @param  RandomData                   A pointer to RandCount random bytes, or NULL to draw them into the record.
+  @param  SecuredMessageSize           Size in bytes of the secured message data buffer.
+  @param  SecuredMessage               A pointer to a destination buffer to store the secured message.
+  @param  SequenceNumInHeaderSize      Size in bytes of the sequence number in the record header.
+  @param  SequenceNumInHeader          The sequence number in the record header.
 
-  SequenceNumInHeader = 0;
-  SequenceNumInHeaderSize = SpdmSecuredMessageCallbacks->GetSequenceNumber (SequenceNumber, (UINT8 *)&SequenceNumInHeader);
-  ASSERT (SequenceNumInHeaderSize <= sizeof(SequenceNumInHeader));
+  @retval RETURN_SUCCESS               The application message is encoded successfully.
+  @retval RETURN_BUFFER_TOO_SMALL      The SecuredMessage buffer is too small.
+  @retval RETURN_OUT_OF_RESOURCES      The AEAD encryption failed.
+**/
+RETURN_STATUS
+SpdmEncodeSecuredMessageRecord (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN     SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN     CONST UINT8                        *Key,
+  IN     CONST UINT8                        *Salt,
+  IN     UINT64                             SequenceNumber,
+  IN     UINT32                             SessionId,
+  IN     UINTN                              AppMessageSize,
+  IN     VOID                               *AppMessage,
+  IN     UINT32                             RandCount,
+  IN     CONST UINT8                        *RandomData OPTIONAL,
+  IN OUT UINTN                              *SecuredMessageSize,
+     OUT VOID                               *SecuredMessage,
+  IN     UINT8                              SequenceNumInHeaderSize,
+  IN     UINT64                             SequenceNumInHeader
+  )
+{
+  UINTN                              TotalSecuredMessageSize;
+  UINTN                              PlainTextSize;
+  UINTN                              CipherTextSize;
+  UINTN                              AeadPadSize;
+  UINTN                              AeadBlockSize;
+  UINTN                              AeadTagSize;
+  UINT8                              *AData;
+  UINT8                              *EncMsg;
+  UINT8                              *Tag;
+  SPDM_SECURED_MESSAGE_ADATA_HEADER_1 *RecordHeader1;
+  SPDM_SECURED_MESSAGE_ADATA_HEADER_2 *RecordHeader2;
+  UINTN                              RecordHeaderSize;
+  SPDM_SECURED_MESSAGE_CIPHER_HEADER *EncMsgHeader;
+  SPDM_SECURED_MESSAGE_CIPHER_HEADER CipherHeader;
+  CRYPT_DATA_SEGMENT                 PlainText[3];
+  BOOLEAN                            Result;
+  UINT8                              Iv[MAX_AEAD_IV_SIZE];
 
-  SequenceNumber++;
-  switch (SessionState) {
-  case SpdmSessionStateHandshaking:
-    if (IsRequester) {
-      SecuredMessageContext->HandshakeSecret.RequestHandshakeSequenceNumber = SequenceNumber;
-    } else {
-      SecuredMessageContext->HandshakeSecret.ResponseHandshakeSequenceNumber = SequenceNumber;
-    }
-    break;
-  case SpdmSessionStateEstablished:
-    if (IsRequester) {
-      SecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber = SequenceNumber;
-    } else {
-      SecuredMessageContext->ApplicationSecret.ResponseDataSequenceNumber = SequenceNumber;
-    }
-    break;
-  }
+  AeadBlockSize = SecuredMessageContext->AeadBlockSize;
+  AeadTagSize = SecuredMessageContext->AeadTagSize;
+
+  CopyMem (Iv, Salt, SecuredMessageContext->AeadIvSize);
+  *(UINT64 *)Iv = *(UINT64 *)Iv ^ SequenceNumber;
 
   RecordHeaderSize = sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_1) + SequenceNumInHeaderSize + sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_2);
 
-  switch (SessionType) {
+  switch (SecuredMessageContext->SessionType) {
   case SpdmSessionTypeEncMac:
-    MaxRandCount = SpdmSecuredMessageCallbacks->GetMaxRandomNumberCount ();
-    if (MaxRandCount != 0) {
-      RandomBytes ((UINT8 *)&RandCount, sizeof(RandCount));
-      RandCount = (UINT8)((RandCount % MaxRandCount) + 1);
-    } else {
-      RandCount = 0;
-    }
-
     PlainTextSize = sizeof(SPDM_SECURED_MESSAGE_CIPHER_HEADER) + AppMessageSize + RandCount;
     CipherTextSize = (PlainTextSize + AeadBlockSize - 1) / AeadBlockSize * AeadBlockSize;
     AeadPadSize = CipherTextSize - PlainTextSize;
@@ -163,28 +788,38 @@ SpdmEncodeSecuredMessage (
     CopyMem (RecordHeader1 + 1, &SequenceNumInHeader, SequenceNumInHeaderSize);
     RecordHeader2->Length = (UINT16)(CipherTextSize + AeadTagSize);
     EncMsgHeader = (VOID *)(RecordHeader2 + 1);
-    EncMsgHeader->ApplicationDataLength = (UINT16)AppMessageSize;
-    CopyMem (EncMsgHeader + 1, AppMessage, AppMessageSize);
-    RandomBytes ((UINT8 *)EncMsgHeader + sizeof(SPDM_SECURED_MESSAGE_CIPHER_HEADER) + AppMessageSize, RandCount);
+    //
+    // The application message is encrypted straight from the caller buffer. Only the
+    // random bytes and the pad are written to the record first, at their final offset.
+    //
+    if (RandomData != NULL) {
+      CopyMem ((UINT8 *)EncMsgHeader + sizeof(SPDM_SECURED_MESSAGE_CIPHER_HEADER) + AppMessageSize, RandomData, RandCount);
+    } else {
+      SpdmRandomStreamGetBytes (&SecuredMessageContext->RandomStream, RandCount, (UINT8 *)EncMsgHeader + sizeof(SPDM_SECURED_MESSAGE_CIPHER_HEADER) + AppMessageSize);
+    }
     ZeroMem ((UINT8 *)EncMsgHeader + PlainTextSize, AeadPadSize);
+    CipherHeader.ApplicationDataLength = (UINT16)AppMessageSize;
+    PlainText[0].Buffer = &CipherHeader;
+    PlainText[0].Size = sizeof(CipherHeader);
+    PlainText[1].Buffer = AppMessage;
+    PlainText[1].Size = AppMessageSize;
+    PlainText[2].Buffer = (UINT8 *)EncMsgHeader + sizeof(SPDM_SECURED_MESSAGE_CIPHER_HEADER) + AppMessageSize;
+    PlainText[2].Size = RandCount + AeadPadSize;
 
     AData = (UINT8 *)RecordHeader1;
     EncMsg = (UINT8 *)EncMsgHeader;
-    DecMsg = (UINT8 *)EncMsgHeader;
     Tag = (UINT8 *)RecordHeader1 + RecordHeaderSize + CipherTextSize;
 
-    Result = SpdmAeadEncryption (
-              SecuredMessageContext->AEADCipherSuite,
+    Result = SpdmSecuredMessageAeadEncryptionSegments (
+              SecuredMessageContext,
+              AeadContext,
               Key,
-              AeadKeySize,
-              Salt,
-              AeadIvSize,
+              Iv,
               (UINT8 *)AData,
               RecordHeaderSize,
-              DecMsg,
-              CipherTextSize,
+              PlainText,
+              ARRAY_SIZE(PlainText),
               Tag,
-              AeadTagSize,
               EncMsg,
               &CipherTextSize
               );
@@ -208,20 +843,14 @@ SpdmEncodeSecuredMessage (
     AData = (UINT8 *)RecordHeader1;
     Tag = (UINT8 *)RecordHeader1 + RecordHeaderSize + AppMessageSize;
 
-    Result = SpdmAeadEncryption (
-              SecuredMessageContext->AEADCipherSuite,
+    Result = SpdmSecuredMessageAeadMac (
+              SecuredMessageContext,
+              AeadContext,
               Key,
-              AeadKeySize,
-              Salt,
-              AeadIvSize,
+              Iv,
               (UINT8 *)AData,
               RecordHeaderSize + AppMessageSize,
-              NULL,
-              0,
-              Tag,
-              AeadTagSize,
-              NULL,
-              NULL
+              Tag
               );
     break;
 
@@ -229,6 +858,7 @@ SpdmEncodeSecuredMessage (
     ASSERT(FALSE);
     return RETURN_UNSUPPORTED;
   }
+  ZeroMem (Iv, sizeof(Iv));
   if (!Result) {
     return RETURN_OUT_OF_RESOURCES;
   }
@@ -236,66 +866,53 @@ SpdmEncodeSecuredMessage (
 }
 
 /**
-  Decode an application message from a secured message.
+  Encode an application message to a secured message.
+
+  The AppMessage buffer must not overlap the SecuredMessage buffer,
+  unless it is at the headroom returned by SpdmSecuredMessageGetMessageRoom to encode in place.
+
+  Encoding the records of one direction of a session may run concurrently with decoding the records
+  of the other direction of the same session, without a lock. The calls for one direction must be
+  serialized, and no key update or session state change may run concurrently with them.
 
   @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
   @param  SessionId                    The session ID of the SPDM session.
   @param  IsRequester                  Indicates if it is a requester message.
-  @param  SecuredMessageSize           Size in bytes of the secured message data buffer.
-  @param  SecuredMessage               A pointer to a source buffer to store the secured message.
   @param  AppMessageSize               Size in bytes of the application message data buffer.
-  @param  AppMessage                   A pointer to a destination buffer to store the application message.
+  @param  AppMessage                   A pointer to a source buffer to store the application message.
+  @param  SecuredMessageSize           Size in bytes of the secured message data buffer.
+  @param  SecuredMessage               A pointer to a destination buffer to store the secured message.
   @param  SpdmSecuredMessageCallbacks  A pointer to a secured message callback functions structure.
 
-  @retval RETURN_SUCCESS               The application message is decoded successfully.
+  @retval RETURN_SUCCESS               The application message is encoded successfully.
   @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
-  @retval RETURN_UNSUPPORTED           The SecuredMessage is unsupported.
 **/
 RETURN_STATUS
 EFIAPI
-SpdmDecodeSecuredMessage (
+SpdmEncodeSecuredMessage (
   IN     VOID                           *SpdmSecuredMessageContext,
   IN     UINT32                         SessionId,
   IN     BOOLEAN                        IsRequester,
-  IN     UINTN                          SecuredMessageSize,
-  IN     VOID                           *SecuredMessage,
-  IN OUT UINTN                          *AppMessageSize,
-     OUT VOID                           *AppMessage,
+  IN     UINTN                          AppMessageSize,
+  IN     VOID                           *AppMessage,
+  IN OUT UINTN                          *SecuredMessageSize,
+     OUT VOID                           *SecuredMessage,
   IN     SPDM_SECURED_MESSAGE_CALLBACKS *SpdmSecuredMessageCallbacks
   )
 {
   SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext;
-  UINTN                              PlainTextSize;
-  UINTN                              CipherTextSize;
-  UINTN                              AeadBlockSize;
-  UINTN                              AeadTagSize;
-  UINTN                              AeadKeySize;
-  UINTN                              AeadIvSize;
-  UINT8                              *AData;
-  UINT8                              *EncMsg;
-  UINT8                              *DecMsg;
-  UINT8                              *Tag;
-  SPDM_SECURED_MESSAGE_ADATA_HEADER_1 *RecordHeader1;
-  SPDM_SECURED_MESSAGE_ADATA_HEADER_2 *RecordHeader2;
-  UINTN                              RecordHeaderSize;
-  SPDM_SECURED_MESSAGE_CIPHER_HEADER *EncMsgHeader;
-  BOOLEAN                            Result;
-  UINT8                              Key[MAX_AEAD_KEY_SIZE];
-  UINT8                              Salt[MAX_AEAD_IV_SIZE];
+  RETURN_STATUS                      Status;
+  UINT8                              *Key;
+  UINT8                              *Salt;
+  UINT64                             *SequenceNumberPtr;
+  SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext;
   UINT64                             SequenceNumber;
   UINT64                             SequenceNumInHeader;
   UINT8                              SequenceNumInHeaderSize;
   SPDM_SESSION_TYPE                  SessionType;
+  UINT32                             RandCount;
+  UINT32                             MaxRandCount;
   SPDM_SESSION_STATE                 SessionState;
-  SPDM_ERROR_STRUCT                  SpdmError;
-  UINT8                              DecMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
-
-  SpdmError.ErrorCode = 0;
-  SpdmError.SessionId = 0;
-  SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-
-  SpdmError.ErrorCode = SPDM_ERROR_CODE_DECRYPT_ERROR;
-  SpdmError.SessionId = SessionId;
 
   SecuredMessageContext = SpdmSecuredMessageContext;
 
@@ -304,198 +921,650 @@ SpdmDecodeSecuredMessage (
   SessionState = SecuredMessageContext->SessionState;
   ASSERT ((SessionState == SpdmSessionStateHandshaking) || (SessionState == SpdmSessionStateEstablished));
 
-  AeadBlockSize = SecuredMessageContext->AeadBlockSize;
-  AeadTagSize = SecuredMessageContext->AeadTagSize;
-  AeadKeySize = SecuredMessageContext->AeadKeySize;
-  AeadIvSize = SecuredMessageContext->AeadIvSize;
+  Status = SpdmSecuredMessageGetDirection (SecuredMessageContext, IsRequester, &Key, &Salt, &SequenceNumberPtr, &AeadContext);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
 
-  switch (SessionState) {
-  case SpdmSessionStateHandshaking:
-    if (IsRequester) {
-      CopyMem (Key, SecuredMessageContext->HandshakeSecret.RequestHandshakeEncryptionKey, SecuredMessageContext->AeadKeySize);
-      CopyMem (Salt, SecuredMessageContext->HandshakeSecret.RequestHandshakeSalt, SecuredMessageContext->AeadIvSize);
-      SequenceNumber = SecuredMessageContext->HandshakeSecret.RequestHandshakeSequenceNumber;
-    } else {
-      CopyMem (Key, SecuredMessageContext->HandshakeSecret.ResponseHandshakeEncryptionKey, SecuredMessageContext->AeadKeySize);
-      CopyMem (Salt, SecuredMessageContext->HandshakeSecret.ResponseHandshakeSalt, SecuredMessageContext->AeadIvSize);
-      SequenceNumber = SecuredMessageContext->HandshakeSecret.ResponseHandshakeSequenceNumber;
+  SequenceNumber = *SequenceNumberPtr;
+  if (SequenceNumber == (UINT64)-1) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  SequenceNumInHeader = 0;
+  SequenceNumInHeaderSize = SpdmSecuredMessageCallbacks->GetSequenceNumber (SequenceNumber, (UINT8 *)&SequenceNumInHeader);
+  ASSERT (SequenceNumInHeaderSize <= sizeof(SequenceNumInHeader));
+
+  *SequenceNumberPtr = SequenceNumber + 1;
+
+  RandCount = 0;
+  if (SessionType == SpdmSessionTypeEncMac) {
+    MaxRandCount = SpdmSecuredMessageCallbacks->GetMaxRandomNumberCount ();
+    if (MaxRandCount != 0) {
+      SpdmRandomStreamGetBytes (&SecuredMessageContext->RandomStream, sizeof(RandCount), (UINT8 *)&RandCount);
+      RandCount = (UINT8)((RandCount % MaxRandCount) + 1);
     }
-    break;
-  case SpdmSessionStateEstablished:
-    if (IsRequester) {
-      CopyMem (Key, SecuredMessageContext->ApplicationSecret.RequestDataEncryptionKey, SecuredMessageContext->AeadKeySize);
-      CopyMem (Salt, SecuredMessageContext->ApplicationSecret.RequestDataSalt, SecuredMessageContext->AeadIvSize);
-      SequenceNumber = SecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber;
-    } else {
-      CopyMem (Key, SecuredMessageContext->ApplicationSecret.ResponseDataEncryptionKey, SecuredMessageContext->AeadKeySize);
-      CopyMem (Salt, SecuredMessageContext->ApplicationSecret.ResponseDataSalt, SecuredMessageContext->AeadIvSize);
-      SequenceNumber = SecuredMessageContext->ApplicationSecret.ResponseDataSequenceNumber;
+  }
+
+  return SpdmEncodeSecuredMessageRecord (
+           SecuredMessageContext,
+           AeadContext,
+           Key,
+           Salt,
+           SequenceNumber,
+           SessionId,
+           AppMessageSize,
+           AppMessage,
+           RandCount,
+           NULL,
+           SecuredMessageSize,
+           SecuredMessage,
+           SequenceNumInHeaderSize,
+           SequenceNumInHeader
+           );
+}
+
+/**
+  Encode a list of application messages to consecutive secured messages of one session.
+
+  The sequence numbers of all records are reserved at once, the random data of the records
+  is drawn from a pool of SPDM_SECURED_MESSAGE_BATCH_RANDOM_POOL_SIZE bytes per draw from the random stream,
+  and the records are sealed back to back with the keyed AEAD handle of the direction.
+  Each AppMessage entry must not overlap any SecuredMessage entry,
+  unless it is at the headroom of its own entry as in SpdmEncodeSecuredMessage.
+
+  If an entry fails, the entries before it are encoded, and the sequence numbers of the entries
+  after it stay consumed.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  MessageCount                 Number of entries in AppMessage and SecuredMessage.
+  @param  AppMessage                   A pointer to the list of application messages.
+  @param  SecuredMessage               A pointer to the list of destination buffers of the secured messages.
+                                       On output, the Size of each encoded entry is the size of its secured message.
+  @param  SpdmSecuredMessageCallbacks  A pointer to a secured message callback functions structure.
+  @param  EncodedCount                 Return the number of entries that are encoded.
+
+  @retval RETURN_SUCCESS               All application messages are encoded successfully.
+  @retval RETURN_OUT_OF_RESOURCES      Not enough sequence numbers are left, or the AEAD encryption failed.
+  @retval RETURN_BUFFER_TOO_SMALL      A SecuredMessage entry is too small.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmEncodeSecuredMessageBatch (
+  IN     VOID                           *SpdmSecuredMessageContext,
+  IN     UINT32                         SessionId,
+  IN     BOOLEAN                        IsRequester,
+  IN     UINTN                          MessageCount,
+  IN     CONST CRYPT_DATA_SEGMENT       *AppMessage,
+  IN OUT CRYPT_DATA_SEGMENT             *SecuredMessage,
+  IN     SPDM_SECURED_MESSAGE_CALLBACKS *SpdmSecuredMessageCallbacks,
+     OUT UINTN                          *EncodedCount OPTIONAL
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext;
+  RETURN_STATUS                      Status;
+  UINT8                              *Key;
+  UINT8                              *Salt;
+  UINT64                             *SequenceNumberPtr;
+  SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext;
+  UINT64                             SequenceNumber;
+  UINT64                             SequenceNumInHeader;
+  UINT8                              SequenceNumInHeaderSize;
+  SPDM_SESSION_TYPE                  SessionType;
+  SPDM_SESSION_STATE                 SessionState;
+  UINT32                             RandCount;
+  UINT32                             MaxRandCount;
+  UINTN                              RandomNeed;
+  UINT8                              RandomPool[SPDM_SECURED_MESSAGE_BATCH_RANDOM_POOL_SIZE];
+  UINTN                              RandomOffset;
+  CONST UINT8                        *RandomData;
+  UINTN                              Index;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+
+  if (EncodedCount != NULL) {
+    *EncodedCount = 0;
+  }
+
+  SessionType = SecuredMessageContext->SessionType;
+  ASSERT ((SessionType == SpdmSessionTypeMacOnly) || (SessionType == SpdmSessionTypeEncMac));
+  SessionState = SecuredMessageContext->SessionState;
+  ASSERT ((SessionState == SpdmSessionStateHandshaking) || (SessionState == SpdmSessionStateEstablished));
+
+  Status = SpdmSecuredMessageGetDirection (SecuredMessageContext, IsRequester, &Key, &Salt, &SequenceNumberPtr, &AeadContext);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+
+  //
+  // Reserve the sequence numbers of all records. (UINT64)-1 is never used, as in SpdmEncodeSecuredMessage.
+  //
+  SequenceNumber = *SequenceNumberPtr;
+  if (MessageCount > (UINT64)-1 - SequenceNumber) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  *SequenceNumberPtr = SequenceNumber + MessageCount;
+
+  MaxRandCount = 0;
+  if (SessionType == SpdmSessionTypeEncMac) {
+    MaxRandCount = SpdmSecuredMessageCallbacks->GetMaxRandomNumberCount ();
+  }
+  //
+  // Each record takes its random count and at most MaxRandCount random bytes from the pool.
+  //
+  RandomNeed = sizeof(RandCount) + MaxRandCount;
+  RandomOffset = sizeof(RandomPool);
+
+  Status = RETURN_SUCCESS;
+  for (Index = 0; Index < MessageCount; Index++, SequenceNumber++) {
+    RandCount = 0;
+    RandomData = NULL;
+    if (MaxRandCount != 0) {
+      if (RandomNeed <= sizeof(RandomPool)) {
+        if (sizeof(RandomPool) - RandomOffset < RandomNeed) {
+          SpdmRandomStreamGetBytes (&SecuredMessageContext->RandomStream, sizeof(RandomPool), RandomPool);
+          RandomOffset = 0;
+        }
+        CopyMem (&RandCount, RandomPool + RandomOffset, sizeof(RandCount));
+        RandomOffset += sizeof(RandCount);
+        RandCount = (UINT8)((RandCount % MaxRandCount) + 1);
+        RandomData = RandomPool + RandomOffset;
+        RandomOffset += RandCount;
+      } else {
+        SpdmRandomStreamGetBytes (&SecuredMessageContext->RandomStream, sizeof(RandCount), (UINT8 *)&RandCount);
+        RandCount = (UINT8)((RandCount % MaxRandCount) + 1);
+      }
+    }
+
+    SequenceNumInHeader = 0;
+    SequenceNumInHeaderSize = SpdmSecuredMessageCallbacks->GetSequenceNumber (SequenceNumber, (UINT8 *)&SequenceNumInHeader);
+    ASSERT (SequenceNumInHeaderSize <= sizeof(SequenceNumInHeader));
+
+    Status = SpdmEncodeSecuredMessageRecord (
+               SecuredMessageContext,
+               AeadContext,
+               Key,
+               Salt,
+               SequenceNumber,
+               SessionId,
+               AppMessage[Index].Size,
+               AppMessage[Index].Buffer,
+               RandCount,
+               RandomData,
+               &SecuredMessage[Index].Size,
+               SecuredMessage[Index].Buffer,
+               SequenceNumInHeaderSize,
+               SequenceNumInHeader
+               );
+    if (RETURN_ERROR(Status)) {
+      break;
+    }
+    if (EncodedCount != NULL) {
+      *EncodedCount = Index + 1;
     }
-    break;
-  default:
-    ASSERT(FALSE);
-    return RETURN_UNSUPPORTED;
   }
+  ZeroMem (RandomPool, sizeof(RandomPool));
+  return Status;
+}
 
-  if (SequenceNumber == (UINT64)-1) {
-    SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-    return RETURN_SECURITY_VIOLATION;
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+/**
+  Recover the sequence number of a record from the sequence number in its header,
+  and check it against the replay window of the direction.
+
+  The sequence number nearest to NextSequenceNumber that ends with the header bytes is used.
+
+  @param  NextSequenceNumber           The sequence number after the highest one decoded.
+  @param  ReplayWindow                 The replay window of the direction.
+  @param  SequenceNumInHeader          The sequence number in the record header.
+  @param  SequenceNumInHeaderSize      Size in bytes of the sequence number in the record header.
+  @param  SequenceNumber               Return the sequence number of the record.
+
+  @retval TRUE   The sequence number is not decoded yet, and it is inside the replay window or above it.
+  @retval FALSE  The sequence number is replayed, too old, or exhausted.
+**/
+BOOLEAN
+SpdmSecuredMessageCheckReplayWindow (
+  IN     UINT64                             NextSequenceNumber,
+  IN     UINT64                             ReplayWindow,
+  IN     UINT64                             SequenceNumInHeader,
+  IN     UINT8                              SequenceNumInHeaderSize,
+     OUT UINT64                             *SequenceNumber
+  )
+{
+  UINT64  Range;
+  UINT64  Candidate;
+  UINT64  Distance;
+
+  if (SequenceNumInHeaderSize >= sizeof(UINT64)) {
+    Candidate = SequenceNumInHeader;
+  } else {
+    Range = (UINT64)1 << (SequenceNumInHeaderSize * 8);
+    Candidate = (NextSequenceNumber & ~(Range - 1)) | SequenceNumInHeader;
+    if ((Candidate > NextSequenceNumber) && (Candidate - NextSequenceNumber > Range / 2) && (Candidate >= Range)) {
+      Candidate -= Range;
+    } else if ((Candidate < NextSequenceNumber) && (NextSequenceNumber - Candidate > Range / 2) && (Candidate <= (UINT64)-1 - Range)) {
+      Candidate += Range;
+    }
+  }
+
+  if (Candidate == (UINT64)-1) {
+    return FALSE;
+  }
+  if (Candidate < NextSequenceNumber) {
+    Distance = NextSequenceNumber - 1 - Candidate;
+    if (Distance >= OPENSPDM_REPLAY_WINDOW_SIZE) {
+      return FALSE;
+    }
+    if ((ReplayWindow & ((UINT64)1 << Distance)) != 0) {
+      return FALSE;
+    }
+  }
+  *SequenceNumber = Candidate;
+  return TRUE;
+}
+
+/**
+  Record an authenticated sequence number in the replay window of the direction.
+
+  @param  NextSequenceNumber           The sequence number after the highest one decoded.
+  @param  ReplayWindow                 The replay window of the direction.
+  @param  SequenceNumber               The sequence number of the authenticated record.
+**/
+VOID
+SpdmSecuredMessageUpdateReplayWindow (
+  IN OUT UINT64                             *NextSequenceNumber,
+  IN OUT UINT64                             *ReplayWindow,
+  IN     UINT64                             SequenceNumber
+  )
+{
+  UINT64  Shift;
+
+  if (SequenceNumber >= *NextSequenceNumber) {
+    Shift = SequenceNumber - *NextSequenceNumber + 1;
+    if (Shift >= 64) {
+      *ReplayWindow = 0;
+    } else {
+      *ReplayWindow = *ReplayWindow << Shift;
+    }
+    *ReplayWindow |= 1;
+    *NextSequenceNumber = SequenceNumber + 1;
+  } else {
+    *ReplayWindow |= (UINT64)1 << (*NextSequenceNumber - 1 - SequenceNumber);
   }
+}
+#endif
+
+/**
+  Check the header and the sequence number of a secured message, and locate its AAD, cipher text and tag.
 
-  *(UINT64 *)Salt = *(UINT64 *)Salt ^ SequenceNumber;
+  The sequence number of a record decoded in order is consumed, even if the record is not authenticated.
+  SpdmDecodeSecuredMessage is this step followed by SpdmDecodeSecuredMessageOpen and SpdmDecodeSecuredMessageFinish.
+  Records of different sessions may be interleaved between the steps.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  SecuredMessageSize           Size in bytes of the secured message data buffer.
+  @param  SecuredMessage               A pointer to a source buffer to store the secured message.
+  @param  AppMessageSize               Size in bytes of the application message data buffer.
+  @param  AppMessage                   A pointer to a destination buffer to store the application message.
+  @param  SpdmSecuredMessageCallbacks  A pointer to a secured message callback functions structure.
+  @param  State                        Return the record being decoded.
+
+  @retval RETURN_SUCCESS               The record is ready to be authenticated.
+  @retval RETURN_UNSUPPORTED           The session state has no secured messages.
+  @retval RETURN_SECURITY_VIOLATION    The record is malformed or replayed.
+**/
+RETURN_STATUS
+SpdmDecodeSecuredMessagePrepare (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN     UINT32                             SessionId,
+  IN     BOOLEAN                            IsRequester,
+  IN     UINTN                              SecuredMessageSize,
+  IN     VOID                               *SecuredMessage,
+  IN     UINTN                              AppMessageSize,
+     OUT VOID                               *AppMessage,
+  IN     SPDM_SECURED_MESSAGE_CALLBACKS     *SpdmSecuredMessageCallbacks,
+     OUT SPDM_SECURED_MESSAGE_DECODE_STATE  *State
+  )
+{
+  UINTN                              AeadBlockSize;
+  UINTN                              AeadTagSize;
+  SPDM_SECURED_MESSAGE_ADATA_HEADER_1 *RecordHeader1;
+  SPDM_SECURED_MESSAGE_ADATA_HEADER_2 *RecordHeader2;
+  UINTN                              RecordHeaderSize;
+  RETURN_STATUS                      Status;
+  UINT8                              *DirectionSalt;
+  UINT64                             SequenceNumInHeader;
+  UINT8                              SequenceNumInHeaderSize;
+  SPDM_SESSION_TYPE                  SessionType;
+  SPDM_SESSION_STATE                 SessionState;
+  SPDM_ERROR_STRUCT                  SpdmError;
+
+  SpdmError.ErrorCode = 0;
+  SpdmError.SessionId = 0;
+  SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+
+  SpdmError.ErrorCode = SPDM_ERROR_CODE_DECRYPT_ERROR;
+  SpdmError.SessionId = SessionId;
+
+  SessionType = SecuredMessageContext->SessionType;
+  ASSERT ((SessionType == SpdmSessionTypeMacOnly) || (SessionType == SpdmSessionTypeEncMac));
+  SessionState = SecuredMessageContext->SessionState;
+  ASSERT ((SessionState == SpdmSessionStateHandshaking) || (SessionState == SpdmSessionStateEstablished));
+
+  AeadBlockSize = SecuredMessageContext->AeadBlockSize;
+  AeadTagSize = SecuredMessageContext->AeadTagSize;
+
+  State->SecuredMessageContext = SecuredMessageContext;
+  State->SessionId = SessionId;
+  Status = SpdmSecuredMessageGetDirection (SecuredMessageContext, IsRequester, &State->Key, &DirectionSalt, &State->SequenceNumberPtr, &State->AeadContext);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  CopyMem (State->Iv, DirectionSalt, SecuredMessageContext->AeadIvSize);
+  State->SequenceNumber = *State->SequenceNumberPtr;
 
   SequenceNumInHeader = 0;
-  SequenceNumInHeaderSize = SpdmSecuredMessageCallbacks->GetSequenceNumber (SequenceNumber, (UINT8 *)&SequenceNumInHeader);
+  SequenceNumInHeaderSize = SpdmSecuredMessageCallbacks->GetSequenceNumber (State->SequenceNumber, (UINT8 *)&SequenceNumInHeader);
   ASSERT (SequenceNumInHeaderSize <= sizeof(SequenceNumInHeader));
 
-  SequenceNumber++;
-  switch (SessionState) {
-  case SpdmSessionStateHandshaking:
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+  //
+  // The application records carry their sequence number, so that they are accepted in any order inside the window.
+  //
+  State->ReplayWindow = NULL;
+  if ((SessionState == SpdmSessionStateEstablished) && (SequenceNumInHeaderSize != 0)) {
     if (IsRequester) {
-      SecuredMessageContext->HandshakeSecret.RequestHandshakeSequenceNumber = SequenceNumber;
+      State->ReplayWindow = &SecuredMessageContext->ApplicationSecret.RequestDataReplayWindow;
     } else {
-      SecuredMessageContext->HandshakeSecret.ResponseHandshakeSequenceNumber = SequenceNumber;
+      State->ReplayWindow = &SecuredMessageContext->ApplicationSecret.ResponseDataReplayWindow;
     }
-    break;
-  case SpdmSessionStateEstablished:
-    if (IsRequester) {
-      SecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber = SequenceNumber;
-    } else {
-      SecuredMessageContext->ApplicationSecret.ResponseDataSequenceNumber = SequenceNumber;
+    if (SecuredMessageSize < sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_1) + SequenceNumInHeaderSize) {
+      SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+      return RETURN_SECURITY_VIOLATION;
+    }
+    SequenceNumInHeader = 0;
+    CopyMem (&SequenceNumInHeader, (UINT8 *)SecuredMessage + sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_1), SequenceNumInHeaderSize);
+    if (!SpdmSecuredMessageCheckReplayWindow (State->SequenceNumber, *State->ReplayWindow, SequenceNumInHeader, SequenceNumInHeaderSize, &State->SequenceNumber)) {
+      SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+      return RETURN_SECURITY_VIOLATION;
     }
-    break;
   }
+#endif
+
+  if (State->SequenceNumber == (UINT64)-1) {
+    SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+    return RETURN_SECURITY_VIOLATION;
+  }
+
+  *(UINT64 *)State->Iv = *(UINT64 *)State->Iv ^ State->SequenceNumber;
+
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+  //
+  // A record inside the window is only recorded after it is authenticated.
+  //
+  if (State->ReplayWindow == NULL) {
+    *State->SequenceNumberPtr = State->SequenceNumber + 1;
+  }
+#else
+  *State->SequenceNumberPtr = State->SequenceNumber + 1;
+#endif
 
   RecordHeaderSize = sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_1) + SequenceNumInHeaderSize + sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_2);
 
   switch (SessionType) {
   case SpdmSessionTypeEncMac:
     if (SecuredMessageSize < RecordHeaderSize + AeadBlockSize + AeadTagSize) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
+      SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
       return RETURN_SECURITY_VIOLATION;
     }
-    RecordHeader1 = (VOID *)SecuredMessage;
-    RecordHeader2 = (VOID *)((UINT8 *)RecordHeader1 + sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_1) + SequenceNumInHeaderSize);
-    if (RecordHeader1->SessionId != SessionId) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-      return RETURN_SECURITY_VIOLATION;
-    }
-    if (CompareMem (RecordHeader1 + 1, &SequenceNumInHeader, SequenceNumInHeaderSize) != 0) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-      return RETURN_SECURITY_VIOLATION;
-    }
-    if (RecordHeader2->Length > SecuredMessageSize - RecordHeaderSize) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
+    break;
+  case SpdmSessionTypeMacOnly:
+    if (SecuredMessageSize < RecordHeaderSize + AeadTagSize) {
+      SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
       return RETURN_SECURITY_VIOLATION;
     }
-    if (RecordHeader2->Length < AeadTagSize) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
+    break;
+  default:
+    ASSERT(FALSE);
+    return RETURN_UNSUPPORTED;
+  }
+
+  RecordHeader1 = (VOID *)SecuredMessage;
+  RecordHeader2 = (VOID *)((UINT8 *)RecordHeader1 + sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_1) + SequenceNumInHeaderSize);
+  if (RecordHeader1->SessionId != SessionId) {
+    SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+    return RETURN_SECURITY_VIOLATION;
+  }
+  if (CompareMem (RecordHeader1 + 1, &SequenceNumInHeader, SequenceNumInHeaderSize) != 0) {
+    SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+    return RETURN_SECURITY_VIOLATION;
+  }
+  if (RecordHeader2->Length > SecuredMessageSize - RecordHeaderSize) {
+    SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+    return RETURN_SECURITY_VIOLATION;
+  }
+  if (RecordHeader2->Length < AeadTagSize) {
+    SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+    return RETURN_SECURITY_VIOLATION;
+  }
+  State->AData = (UINT8 *)RecordHeader1;
+
+  if (SessionType == SpdmSessionTypeEncMac) {
+    State->CipherTextSize = (RecordHeader2->Length - AeadTagSize) / AeadBlockSize * AeadBlockSize;
+    if (State->CipherTextSize < sizeof(SPDM_SECURED_MESSAGE_CIPHER_HEADER)) {
+      SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
       return RETURN_SECURITY_VIOLATION;
     }
-    CipherTextSize = (RecordHeader2->Length - AeadTagSize) / AeadBlockSize * AeadBlockSize;
-    if (CipherTextSize > sizeof(DecMessage)) {
-      return RETURN_OUT_OF_RESOURCES;
-    }
-    ZeroMem (DecMessage, sizeof(DecMessage));
-    EncMsgHeader = (VOID *)(RecordHeader2 + 1);
-    AData = (UINT8 *)RecordHeader1;
-    EncMsg = (UINT8 *)EncMsgHeader;
-    DecMsg = (UINT8 *)DecMessage;
-    EncMsgHeader = (VOID *)DecMsg;
-    Tag = (UINT8 *)RecordHeader1 + RecordHeaderSize + CipherTextSize;
-    Result = SpdmAeadDecryption (
-              SecuredMessageContext->AEADCipherSuite,
-              Key,
-              AeadKeySize,
-              Salt,
-              AeadIvSize,
-              (UINT8 *)AData,
-              RecordHeaderSize,
-              EncMsg,
-              CipherTextSize,
-              Tag,
-              AeadTagSize,
-              DecMsg,
-              &CipherTextSize
-              );
-    if (!Result) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-      return RETURN_SECURITY_VIOLATION;
+    State->ADataSize = RecordHeaderSize;
+    State->EncMsg = (UINT8 *)(RecordHeader2 + 1);
+    State->Tag = (UINT8 *)RecordHeader1 + RecordHeaderSize + State->CipherTextSize;
+    //
+    // The plain text is decrypted straight into the caller buffer, behind a local cipher header.
+    //
+    State->PlainText[0].Buffer = &State->CipherHeader;
+    State->PlainText[0].Size = sizeof(State->CipherHeader);
+    State->PlainText[1].Buffer = AppMessage;
+    State->PlainText[1].Size = MIN (AppMessageSize, State->CipherTextSize - sizeof(SPDM_SECURED_MESSAGE_CIPHER_HEADER));
+  } else {
+    State->ADataSize = RecordHeaderSize + RecordHeader2->Length - AeadTagSize;
+    State->Tag = (UINT8 *)RecordHeader1 + State->ADataSize;
+    State->MacOnlyData = (UINT8 *)(RecordHeader2 + 1);
+    State->MacOnlyDataSize = RecordHeader2->Length - AeadTagSize;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Authenticate a secured message checked by SpdmDecodeSecuredMessagePrepare, and decrypt it for an EncMac session.
+
+  @param  State                        The record being decoded.
+
+  @retval TRUE   The record is authenticated.
+  @retval FALSE  The record is not authenticated.
+**/
+BOOLEAN
+SpdmDecodeSecuredMessageOpen (
+  IN OUT SPDM_SECURED_MESSAGE_DECODE_STATE  *State
+  )
+{
+  if (State->SecuredMessageContext->SessionType == SpdmSessionTypeEncMac) {
+    return SpdmSecuredMessageAeadDecryptionSegments (
+             State->SecuredMessageContext,
+             State->AeadContext,
+             State->Key,
+             State->Iv,
+             State->AData,
+             State->ADataSize,
+             State->EncMsg,
+             State->CipherTextSize,
+             State->Tag,
+             State->PlainText,
+             ARRAY_SIZE(State->PlainText)
+             );
+  }
+  return SpdmSecuredMessageAeadVerifyMac (
+           State->SecuredMessageContext,
+           State->AeadContext,
+           State->Key,
+           State->Iv,
+           State->AData,
+           State->ADataSize,
+           State->Tag
+           );
+}
+
+/**
+  Return the application message of a secured message authenticated by SpdmDecodeSecuredMessageOpen,
+  and record its sequence number in the replay window.
+
+  @param  State                        The record being decoded.
+  @param  Authenticated                The result of SpdmDecodeSecuredMessageOpen.
+  @param  AppMessageSize               On input, the size in bytes of the application message data buffer.
+                                       On output, the size in bytes of the application message.
+  @param  AppMessage                   A pointer to a destination buffer to store the application message.
+
+  @retval RETURN_SUCCESS               The application message is decoded successfully.
+  @retval RETURN_SECURITY_VIOLATION    The record is not authenticated, malformed or replayed.
+  @retval RETURN_BUFFER_TOO_SMALL      The AppMessage buffer is too small.
+**/
+RETURN_STATUS
+SpdmDecodeSecuredMessageFinish (
+  IN OUT SPDM_SECURED_MESSAGE_DECODE_STATE  *State,
+  IN     BOOLEAN                            Authenticated,
+  IN OUT UINTN                              *AppMessageSize,
+     OUT VOID                               *AppMessage
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext;
+  UINTN                              PlainTextSize;
+  SPDM_ERROR_STRUCT                  SpdmError;
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+  UINT64                             SequenceNumber;
+#endif
+
+  SecuredMessageContext = State->SecuredMessageContext;
+  SpdmError.ErrorCode = SPDM_ERROR_CODE_DECRYPT_ERROR;
+  SpdmError.SessionId = State->SessionId;
+
+  if (!Authenticated) {
+    SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+    return RETURN_SECURITY_VIOLATION;
+  }
+
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+  //
+  // Another record of the session, prepared before this one, may have recorded the same sequence number since.
+  //
+  if ((State->ReplayWindow != NULL) &&
+      !SpdmSecuredMessageCheckReplayWindow (*State->SequenceNumberPtr, *State->ReplayWindow, State->SequenceNumber, sizeof(UINT64), &SequenceNumber)) {
+    if (SecuredMessageContext->SessionType == SpdmSessionTypeEncMac) {
+      ZeroMem (AppMessage, State->PlainText[1].Size);
     }
-    PlainTextSize = EncMsgHeader->ApplicationDataLength;
-    if (PlainTextSize > CipherTextSize) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
+    SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+    return RETURN_SECURITY_VIOLATION;
+  }
+#endif
+
+  if (SecuredMessageContext->SessionType == SpdmSessionTypeEncMac) {
+    PlainTextSize = State->CipherHeader.ApplicationDataLength;
+    if (PlainTextSize > State->CipherTextSize - sizeof(SPDM_SECURED_MESSAGE_CIPHER_HEADER)) {
+      ZeroMem (AppMessage, State->PlainText[1].Size);
+      SpdmSecuredMessageSetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
       return RETURN_SECURITY_VIOLATION;
     }
 
     ASSERT (*AppMessageSize >= PlainTextSize);
     if (*AppMessageSize < PlainTextSize) {
+      ZeroMem (AppMessage, State->PlainText[1].Size);
       *AppMessageSize = PlainTextSize;
       return RETURN_BUFFER_TOO_SMALL;
     }
+    //
+    // Wipe the random bytes and the pad that followed the application data.
+    //
+    ZeroMem ((UINT8 *)AppMessage + PlainTextSize, State->PlainText[1].Size - PlainTextSize);
     *AppMessageSize = PlainTextSize;
-    CopyMem (AppMessage, EncMsgHeader + 1, PlainTextSize);
-    break;
-
-  case SpdmSessionTypeMacOnly:
-    if (SecuredMessageSize < RecordHeaderSize + AeadTagSize) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-      return RETURN_SECURITY_VIOLATION;
-    }
-    RecordHeader1 = (VOID *)SecuredMessage;
-    RecordHeader2 = (VOID *)((UINT8 *)RecordHeader1 + sizeof(SPDM_SECURED_MESSAGE_ADATA_HEADER_1) + SequenceNumInHeaderSize);
-    if (RecordHeader1->SessionId != SessionId) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-      return RETURN_SECURITY_VIOLATION;
-    }
-    if (CompareMem (RecordHeader1 + 1, &SequenceNumInHeader, SequenceNumInHeaderSize) != 0) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-      return RETURN_SECURITY_VIOLATION;
-    }
-    if (RecordHeader2->Length > SecuredMessageSize - RecordHeaderSize) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-      return RETURN_SECURITY_VIOLATION;
-    }
-    if (RecordHeader2->Length < AeadTagSize) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-      return RETURN_SECURITY_VIOLATION;
-    }
-    AData = (UINT8 *)RecordHeader1;
-    Tag = (UINT8 *)RecordHeader1 + RecordHeaderSize + RecordHeader2->Length - AeadTagSize;
-    Result = SpdmAeadDecryption (
-              SecuredMessageContext->AEADCipherSuite,
-              Key,
-              AeadKeySize,
-              Salt,
-              AeadIvSize,
-              (UINT8 *)AData,
-              RecordHeaderSize + RecordHeader2->Length - AeadTagSize,
-              NULL,
-              0,
-              Tag,
-              AeadTagSize,
-              NULL,
-              NULL
-              );
-    if (!Result) {
-      SpdmSecuredMessageSetLastSpdmErrorStruct (SpdmSecuredMessageContext, &SpdmError);
-      return RETURN_SECURITY_VIOLATION;
-    }
-
-    PlainTextSize = RecordHeader2->Length - AeadTagSize;
+  } else {
+    PlainTextSize = State->MacOnlyDataSize;
     ASSERT (*AppMessageSize >= PlainTextSize);
     if (*AppMessageSize < PlainTextSize) {
       *AppMessageSize = PlainTextSize;
       return RETURN_BUFFER_TOO_SMALL;
     }
     *AppMessageSize = PlainTextSize;
-    CopyMem (AppMessage, RecordHeader2 + 1, PlainTextSize);
-    break;
-
-  default:
-    ASSERT(FALSE);
-    return RETURN_UNSUPPORTED;
+    CopyMem (AppMessage, State->MacOnlyData, PlainTextSize);
   }
 
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+  if (State->ReplayWindow != NULL) {
+    SpdmSecuredMessageUpdateReplayWindow (State->SequenceNumberPtr, State->ReplayWindow, State->SequenceNumber);
+  }
+#endif
   return RETURN_SUCCESS;
 }
+
+/**
+  Decode an application message from a secured message.
+
+  The AppMessage buffer must not overlap the SecuredMessage buffer,
+  unless it is at the headroom returned by SpdmSecuredMessageGetMessageRoom to decode in place.
+
+  If OPENSPDM_REPLAY_WINDOW_SIZE is not 0 and the transport carries the sequence number in the record,
+  the application secured messages of a session may be decoded in any order inside the replay window.
+  The calls for one session must still be serialized.
+
+  Encoding the records of one direction of a session may run concurrently with decoding the records
+  of the other direction of the same session, without a lock. The calls for one direction must be
+  serialized, and no key update or session state change may run concurrently with them.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  SecuredMessageSize           Size in bytes of the secured message data buffer.
+  @param  SecuredMessage               A pointer to a source buffer to store the secured message.
+  @param  AppMessageSize               Size in bytes of the application message data buffer.
+  @param  AppMessage                   A pointer to a destination buffer to store the application message.
+  @param  SpdmSecuredMessageCallbacks  A pointer to a secured message callback functions structure.
+
+  @retval RETURN_SUCCESS               The application message is decoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+  @retval RETURN_UNSUPPORTED           The SecuredMessage is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmDecodeSecuredMessage (
+  IN     VOID                           *SpdmSecuredMessageContext,
+  IN     UINT32                         SessionId,
+  IN     BOOLEAN                        IsRequester,
+  IN     UINTN                          SecuredMessageSize,
+  IN     VOID                           *SecuredMessage,
+  IN OUT UINTN                          *AppMessageSize,
+     OUT VOID                           *AppMessage,
+  IN     SPDM_SECURED_MESSAGE_CALLBACKS *SpdmSecuredMessageCallbacks
+  )
+{
+  SPDM_SECURED_MESSAGE_DECODE_STATE  State;
+  RETURN_STATUS                      Status;
+
+  Status = SpdmDecodeSecuredMessagePrepare (
+             SpdmSecuredMessageContext,
+             SessionId,
+             IsRequester,
+             SecuredMessageSize,
+             SecuredMessage,
+             *AppMessageSize,
+             AppMessage,
+             SpdmSecuredMessageCallbacks,
+             &State
+             );
+  if (!RETURN_ERROR(Status)) {
+    Status = SpdmDecodeSecuredMessageFinish (&State, SpdmDecodeSecuredMessageOpen (&State), AppMessageSize, AppMessage);
+  }
+  ZeroMem (&State.CipherHeader, sizeof(State.CipherHeader));
+  return Status;
+}
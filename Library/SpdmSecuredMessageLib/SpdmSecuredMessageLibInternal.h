@@ -1,72 +1,462 @@
-/** @file
-  SPDM Secured Message library.
-  It follows the SPDM Specification.
-
-Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
-SPDX-License-Identifier: BSD-2-Clause-Patent
-
-**/
-
-#ifndef __SPDM_SECURED_MESSAGE_LIB_INTERNAL_H__
-#define __SPDM_SECURED_MESSAGE_LIB_INTERNAL_H__
-
-#include <Library/SpdmSecuredMessageLib.h>
-
-typedef struct {
-  UINT8                DheSecret[MAX_DHE_KEY_SIZE];
-  UINT8                HandshakeSecret[MAX_HASH_SIZE];
-  UINT8                MasterSecret[MAX_HASH_SIZE];
-} SPDM_SESSION_INFO_MASTER_SECRET;
-
-typedef struct {
-  UINT8                RequestHandshakeSecret[MAX_HASH_SIZE];
-  UINT8                ResponseHandshakeSecret[MAX_HASH_SIZE];
-  UINT8                ExportMasterSecret[MAX_HASH_SIZE];
-  UINT8                RequestFinishedKey[MAX_HASH_SIZE];
-  UINT8                ResponseFinishedKey[MAX_HASH_SIZE];
-  UINT8                RequestHandshakeEncryptionKey[MAX_AEAD_KEY_SIZE];
-  UINT8                RequestHandshakeSalt[MAX_AEAD_IV_SIZE];
-  UINT64               RequestHandshakeSequenceNumber;
-  UINT8                ResponseHandshakeEncryptionKey[MAX_AEAD_KEY_SIZE];
-  UINT8                ResponseHandshakeSalt[MAX_AEAD_IV_SIZE];
-  UINT64               ResponseHandshakeSequenceNumber;
-} SPDM_SESSION_INFO_HANDSHAKE_SECRET;
-
-typedef struct {
-  UINT8                RequestDataSecret[MAX_HASH_SIZE];
-  UINT8                ResponseDataSecret[MAX_HASH_SIZE];
-  UINT8                RequestDataEncryptionKey[MAX_AEAD_KEY_SIZE];
-  UINT8                RequestDataSalt[MAX_AEAD_IV_SIZE];
-  UINT64               RequestDataSequenceNumber;
-  UINT8                ResponseDataEncryptionKey[MAX_AEAD_KEY_SIZE];
-  UINT8                ResponseDataSalt[MAX_AEAD_IV_SIZE];
-  UINT64               ResponseDataSequenceNumber;
-} SPDM_SESSION_INFO_APPLICATION_SECRET;
-
-typedef struct {
-  SPDM_SESSION_TYPE                    SessionType;
-  UINT32                               BaseHashAlgo;
-  UINT16                               DHENamedGroup;
-  UINT16                               AEADCipherSuite;
-  UINT16                               KeySchedule;
-  UINTN                                HashSize;
-  UINTN                                DheKeySize;
-  UINTN                                AeadKeySize;
-  UINTN                                AeadIvSize;
-  UINTN                                AeadBlockSize;
-  UINTN                                AeadTagSize;
-  BOOLEAN                              UsePsk;
-  SPDM_SESSION_STATE                   SessionState;
-  SPDM_SESSION_INFO_MASTER_SECRET      MasterSecret;
-  SPDM_SESSION_INFO_HANDSHAKE_SECRET   HandshakeSecret;
-  SPDM_SESSION_INFO_APPLICATION_SECRET ApplicationSecret;
-  SPDM_SESSION_INFO_APPLICATION_SECRET ApplicationSecretBackup;
-  UINTN                                PskHintSize;
-  VOID                                 *PskHint;
-  //
-  // Cache the error in SpdmDecodeSecuredMessage. It is handled in SpdmBuildResponse.
-  //
-  SPDM_ERROR_STRUCT                    LastSpdmError;
-} SPDM_SECURED_MESSAGE_CONTEXT;
-
+/** @file
+  SPDM Secured Message library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __SPDM_SECURED_MESSAGE_LIB_INTERNAL_H__
+#define __SPDM_SECURED_MESSAGE_LIB_INTERNAL_H__
+
+#include <Library/SpdmSecuredMessageLib.h>
+
+#if OPENSPDM_REPLAY_WINDOW_SIZE > 64
+#error "OPENSPDM_REPLAY_WINDOW_SIZE shall be no greater than 64"
+#endif
+
+//
+// The state of the request direction and the state of the response direction are kept at least
+// this many bytes apart, so that the encoder of one direction and the decoder of the other direction
+// never write to the same cache line.
+//
+#define SPDM_SECURED_MESSAGE_CACHE_LINE_SIZE  64
+
+//
+// TRUE if the debug hex dumps of the Category are enabled, checked before any work is done for a dump.
+//
+#if !defined(MDEPKG_NDEBUG)
+#define SPDM_SECURED_MESSAGE_DEBUG_DUMP_ENABLED(SecuredMessageContext, Category) \
+  ((((SecuredMessageContext)->DebugDumpMask & (Category)) != 0) && DebugPrintLevelEnabled (DEBUG_INFO))
+#else
+#define SPDM_SECURED_MESSAGE_DEBUG_DUMP_ENABLED(SecuredMessageContext, Category)  FALSE
+#endif
+
+typedef struct {
+  UINT8                DheSecret[MAX_DHE_KEY_SIZE];
+  UINT8                HandshakeSecret[MAX_HASH_SIZE];
+  UINT8                MasterSecret[MAX_HASH_SIZE];
+} SPDM_SESSION_INFO_MASTER_SECRET;
+
+typedef struct {
+  UINT8                RequestHandshakeSecret[MAX_HASH_SIZE];
+  UINT8                ResponseHandshakeSecret[MAX_HASH_SIZE];
+  UINT8                ExportMasterSecret[MAX_HASH_SIZE];
+  UINT8                RequestFinishedKey[MAX_HASH_SIZE];
+  UINT8                ResponseFinishedKey[MAX_HASH_SIZE];
+  UINT8                RequestHandshakeEncryptionKey[MAX_AEAD_KEY_SIZE];
+  UINT8                RequestHandshakeSalt[MAX_AEAD_IV_SIZE];
+  UINT64               RequestHandshakeSequenceNumber;
+  UINT8                DirectionPadding[SPDM_SECURED_MESSAGE_CACHE_LINE_SIZE];
+  UINT8                ResponseHandshakeEncryptionKey[MAX_AEAD_KEY_SIZE];
+  UINT8                ResponseHandshakeSalt[MAX_AEAD_IV_SIZE];
+  UINT64               ResponseHandshakeSequenceNumber;
+} SPDM_SESSION_INFO_HANDSHAKE_SECRET;
+
+//
+// The request direction fields come first and the response direction fields last,
+// with a cache line between them.
+// Bit N of a DataReplayWindow is set if the record with sequence number (DataSequenceNumber - 1 - N) is decoded.
+//
+typedef struct {
+  UINT8                RequestDataSecret[MAX_HASH_SIZE];
+  UINT8                RequestDataEncryptionKey[MAX_AEAD_KEY_SIZE];
+  UINT8                RequestDataSalt[MAX_AEAD_IV_SIZE];
+  UINT64               RequestDataSequenceNumber;
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+  UINT64               RequestDataReplayWindow;
+#endif
+  UINT8                DirectionPadding[SPDM_SECURED_MESSAGE_CACHE_LINE_SIZE];
+  UINT8                ResponseDataSecret[MAX_HASH_SIZE];
+  UINT8                ResponseDataEncryptionKey[MAX_AEAD_KEY_SIZE];
+  UINT8                ResponseDataSalt[MAX_AEAD_IV_SIZE];
+  UINT64               ResponseDataSequenceNumber;
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+  UINT64               ResponseDataReplayWindow;
+#endif
+} SPDM_SESSION_INFO_APPLICATION_SECRET;
+
+//
+// Size in bytes of the random data drawn at once for the records of SpdmEncodeSecuredMessageBatch.
+//
+#define SPDM_SECURED_MESSAGE_BATCH_RANDOM_POOL_SIZE  256
+
+//
+// A keyed AEAD handle, reused for every record of one direction.
+// Key holds the key installed in Context, so that a key change is detected on use.
+//
+typedef struct {
+  VOID                 *Context;
+  UINT16               AEADCipherSuite;
+  BOOLEAN              Keyed;
+  UINT8                Key[MAX_AEAD_KEY_SIZE];
+} SPDM_SECURED_MESSAGE_AEAD_CONTEXT;
+
+//
+// A keyed HMAC handle, duplicated for every HMAC computation with one finished key.
+// Key holds the key installed in Context, so that a key change is detected on use.
+//
+typedef struct {
+  VOID                 *Context;
+  UINT32               BaseHashAlgo;
+  BOOLEAN              Keyed;
+  UINT8                Key[MAX_HASH_SIZE];
+} SPDM_SECURED_MESSAGE_HMAC_CONTEXT;
+
+//
+// The AEAD key of one direction as installed in the inline crypto engine.
+//
+typedef struct {
+  BOOLEAN              Installed;
+  UINT8                Key[MAX_AEAD_KEY_SIZE];
+  UINT8                Salt[MAX_AEAD_IV_SIZE];
+} SPDM_SECURED_MESSAGE_OFFLOAD_KEY;
+
+typedef struct {
+  SPDM_SESSION_TYPE                    SessionType;
+  UINT32                               BaseHashAlgo;
+  UINT16                               DHENamedGroup;
+  UINT16                               AEADCipherSuite;
+  UINT16                               KeySchedule;
+  UINTN                                HashSize;
+  UINTN                                DheKeySize;
+  UINTN                                AeadKeySize;
+  UINTN                                AeadIvSize;
+  UINTN                                AeadBlockSize;
+  UINTN                                AeadTagSize;
+  BOOLEAN                              UsePsk;
+  //
+  // The handshake messages are sent in the clear. No handshake encryption key is derived.
+  //
+  BOOLEAN                              HandshakeInTheClear;
+  SPDM_SESSION_STATE                   SessionState;
+  UINT32                               DebugDumpMask;
+  SPDM_SESSION_INFO_MASTER_SECRET      MasterSecret;
+  SPDM_SESSION_INFO_HANDSHAKE_SECRET   HandshakeSecret;
+  SPDM_SESSION_INFO_APPLICATION_SECRET ApplicationSecret;
+  SPDM_SESSION_INFO_APPLICATION_SECRET ApplicationSecretBackup;
+  //
+  // The next generation of the DataKey, prepared by SpdmPrepareUpdateSessionDataKey.
+  // After a key update, the next AEAD handle slots hold the handles of the backup generation.
+  //
+  SPDM_SESSION_INFO_APPLICATION_SECRET ApplicationSecretNext;
+  BOOLEAN                              RequestDataNextReady;
+  BOOLEAN                              ResponseDataNextReady;
+  //
+  // The inline crypto engine registered by SpdmSecuredMessageSetOffloadOps.
+  //
+  CONST SPDM_SECURED_MESSAGE_OFFLOAD_OPS  *OffloadOps;
+  VOID                                 *OffloadContext;
+  UINT32                               SessionId;
+  //
+  // The AEAD handle slots and the offloaded key of each direction are kept on their own cache lines.
+  //
+  SPDM_SECURED_MESSAGE_AEAD_CONTEXT    RequestHandshakeAead;
+  SPDM_SECURED_MESSAGE_AEAD_CONTEXT    RequestDataAead;
+  SPDM_SECURED_MESSAGE_AEAD_CONTEXT    RequestDataAeadNext;
+  SPDM_SECURED_MESSAGE_OFFLOAD_KEY     RequestOffloadKey;
+  UINT8                                RequestDirectionPadding[SPDM_SECURED_MESSAGE_CACHE_LINE_SIZE];
+  SPDM_SECURED_MESSAGE_AEAD_CONTEXT    ResponseHandshakeAead;
+  SPDM_SECURED_MESSAGE_AEAD_CONTEXT    ResponseDataAead;
+  SPDM_SECURED_MESSAGE_AEAD_CONTEXT    ResponseDataAeadNext;
+  SPDM_SECURED_MESSAGE_OFFLOAD_KEY     ResponseOffloadKey;
+  UINT8                                ResponseDirectionPadding[SPDM_SECURED_MESSAGE_CACHE_LINE_SIZE];
+  SPDM_SECURED_MESSAGE_HMAC_CONTEXT    RequestFinishedHmac;
+  SPDM_SECURED_MESSAGE_HMAC_CONTEXT    ResponseFinishedHmac;
+#if OPENSPDM_PSK_CAP_SUPPORT == 1
+  UINTN                                PskHintSize;
+  VOID                                 *PskHint;
+#endif
+  //
+  // The random data of the encoded records.
+  //
+  SPDM_RANDOM_STREAM                   RandomStream;
+  //
+  // Cache the error in SpdmDecodeSecuredMessage. It is handled in SpdmBuildResponse.
+  // Only the decoder writes it, so it is kept away from the fields that the encoder reads.
+  //
+  UINT8                                DecodePadding[SPDM_SECURED_MESSAGE_CACHE_LINE_SIZE];
+  SPDM_ERROR_STRUCT                    LastSpdmError;
+} SPDM_SECURED_MESSAGE_CONTEXT;
+
+//
+// A secured message record being decoded, from the check of its header to its authentication.
+//
+typedef struct {
+  SPDM_SECURED_MESSAGE_CONTEXT         *SecuredMessageContext;
+  UINT32                               SessionId;
+  SPDM_SECURED_MESSAGE_AEAD_CONTEXT    *AeadContext;
+  UINT8                                *Key;
+  UINT8                                Iv[MAX_AEAD_IV_SIZE];
+  UINT64                               *SequenceNumberPtr;
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+  //
+  // The replay window of the direction, or NULL if the record is decoded in order.
+  //
+  UINT64                               *ReplayWindow;
+#endif
+  UINT64                               SequenceNumber;
+  UINT8                                *AData;
+  UINTN                                ADataSize;
+  UINT8                                *EncMsg;
+  UINTN                                CipherTextSize;
+  UINT8                                *Tag;
+  //
+  // The data after the record header of an MacOnly record.
+  //
+  UINT8                                *MacOnlyData;
+  UINTN                                MacOnlyDataSize;
+  //
+  // The plain text of an EncMac record, decrypted straight into the caller buffer behind a local cipher header.
+  //
+  SPDM_SECURED_MESSAGE_CIPHER_HEADER   CipherHeader;
+  CRYPT_DATA_SEGMENT                   PlainText[2];
+} SPDM_SECURED_MESSAGE_DECODE_STATE;
+
+/**
+  Check the header and the sequence number of a secured message, and locate its AAD, cipher text and tag.
+
+  The sequence number of a record decoded in order is consumed, even if the record is not authenticated.
+  SpdmDecodeSecuredMessage is this step followed by SpdmDecodeSecuredMessageOpen and SpdmDecodeSecuredMessageFinish.
+  Records of different sessions may be interleaved between the steps.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  SecuredMessageSize           Size in bytes of the secured message data buffer.
+  @param  SecuredMessage               A pointer to a source buffer to store the secured message.
+  @param  AppMessageSize               Size in bytes of the application message data buffer.
+  @param  AppMessage                   A pointer to a destination buffer to store the application message.
+  @param  SpdmSecuredMessageCallbacks  A pointer to a secured message callback functions structure.
+  @param  State                        Return the record being decoded.
+
+  @retval RETURN_SUCCESS               The record is ready to be authenticated.
+  @retval RETURN_UNSUPPORTED           The session state has no secured messages.
+  @retval RETURN_SECURITY_VIOLATION    The record is malformed or replayed.
+**/
+RETURN_STATUS
+SpdmDecodeSecuredMessagePrepare (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN     UINT32                             SessionId,
+  IN     BOOLEAN                            IsRequester,
+  IN     UINTN                              SecuredMessageSize,
+  IN     VOID                               *SecuredMessage,
+  IN     UINTN                              AppMessageSize,
+     OUT VOID                               *AppMessage,
+  IN     SPDM_SECURED_MESSAGE_CALLBACKS     *SpdmSecuredMessageCallbacks,
+     OUT SPDM_SECURED_MESSAGE_DECODE_STATE  *State
+  );
+
+/**
+  Authenticate a secured message checked by SpdmDecodeSecuredMessagePrepare, and decrypt it for an EncMac session.
+
+  @param  State                        The record being decoded.
+
+  @retval TRUE   The record is authenticated.
+  @retval FALSE  The record is not authenticated.
+**/
+BOOLEAN
+SpdmDecodeSecuredMessageOpen (
+  IN OUT SPDM_SECURED_MESSAGE_DECODE_STATE  *State
+  );
+
+/**
+  Return the application message of a secured message authenticated by SpdmDecodeSecuredMessageOpen,
+  and record its sequence number in the replay window.
+
+  @param  State                        The record being decoded.
+  @param  Authenticated                The result of SpdmDecodeSecuredMessageOpen.
+  @param  AppMessageSize               On input, the size in bytes of the application message data buffer.
+                                       On output, the size in bytes of the application message.
+  @param  AppMessage                   A pointer to a destination buffer to store the application message.
+
+  @retval RETURN_SUCCESS               The application message is decoded successfully.
+  @retval RETURN_SECURITY_VIOLATION    The record is not authenticated, malformed or replayed.
+  @retval RETURN_BUFFER_TOO_SMALL      The AppMessage buffer is too small.
+**/
+RETURN_STATUS
+SpdmDecodeSecuredMessageFinish (
+  IN OUT SPDM_SECURED_MESSAGE_DECODE_STATE  *State,
+  IN     BOOLEAN                            Authenticated,
+  IN OUT UINTN                              *AppMessageSize,
+     OUT VOID                               *AppMessage
+  );
+
+#if OPENSPDM_REPLAY_WINDOW_SIZE != 0
+/**
+  Recover the sequence number of a record from the sequence number in its header,
+  and check it against the replay window of the direction.
+
+  The sequence number nearest to NextSequenceNumber that ends with the header bytes is used.
+
+  @param  NextSequenceNumber           The sequence number after the highest one decoded.
+  @param  ReplayWindow                 The replay window of the direction.
+  @param  SequenceNumInHeader          The sequence number in the record header.
+  @param  SequenceNumInHeaderSize      Size in bytes of the sequence number in the record header.
+  @param  SequenceNumber               Return the sequence number of the record.
+
+  @retval TRUE   The sequence number is not decoded yet, and it is inside the replay window or above it.
+  @retval FALSE  The sequence number is replayed, too old, or exhausted.
+**/
+BOOLEAN
+SpdmSecuredMessageCheckReplayWindow (
+  IN     UINT64                             NextSequenceNumber,
+  IN     UINT64                             ReplayWindow,
+  IN     UINT64                             SequenceNumInHeader,
+  IN     UINT8                              SequenceNumInHeaderSize,
+     OUT UINT64                             *SequenceNumber
+  );
+
+/**
+  Record an authenticated sequence number in the replay window of the direction.
+
+  @param  NextSequenceNumber           The sequence number after the highest one decoded.
+  @param  ReplayWindow                 The replay window of the direction.
+  @param  SequenceNumber               The sequence number of the authenticated record.
+**/
+VOID
+SpdmSecuredMessageUpdateReplayWindow (
+  IN OUT UINT64                             *NextSequenceNumber,
+  IN OUT UINT64                             *ReplayWindow,
+  IN     UINT64                             SequenceNumber
+  );
+#endif
+
+typedef enum {
+  SpdmDheKeyPoolEntryFree,
+  SpdmDheKeyPoolEntryGenerating,
+  SpdmDheKeyPoolEntryReady,
+} SPDM_DHE_KEY_POOL_ENTRY_STATE;
+
+//
+// One DHE context with a generated key pair.
+//
+typedef struct {
+  SPDM_DHE_KEY_POOL_ENTRY_STATE   State;
+  UINT16                          DHENamedGroup;
+  VOID                            *DheContext;
+  UINTN                           PublicKeySize;
+  UINT8                           PublicKey[MAX_DHE_KEY_SIZE];
+} SPDM_DHE_KEY_POOL_ENTRY;
+
+//
+// The entries follow the pool header.
+//
+typedef struct {
+  UINTN                           EntryCount;
+  SPDM_SECURED_MESSAGE_LOCK_FUNC  AcquireLock;
+  SPDM_SECURED_MESSAGE_LOCK_FUNC  ReleaseLock;
+  VOID                            *LockContext;
+  UINT64                          HitCount;
+  UINT64                          MissCount;
+} SPDM_DHE_KEY_POOL;
+
+/**
+  Return the keyed AEAD handle for one direction of a session.
+
+  The handle is allocated on first use. The key schedule is only computed again
+  when Key differs from the key that is already installed.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot.
+  @param  Key                          A pointer to the current AEAD key of this direction.
+
+  @return the keyed AEAD handle, or NULL if no handle can be allocated or keyed.
+**/
+VOID *
+SpdmSecuredMessageGetAeadContext (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN OUT SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN     CONST UINT8                        *Key
+  );
+
+/**
+  Release the AEAD handle held in an AEAD handle slot and wipe the cached key.
+
+  @param  AeadContext                  A pointer to the AEAD handle slot.
+**/
+VOID
+SpdmSecuredMessageFreeAeadContext (
+  IN OUT SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext
+  );
+
+/**
+  Return the keyed HMAC handle for one finished key of a session.
+
+  The handle is allocated on first use. The key is only set again
+  when Key differs from the key that is already installed.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  HmacContext                  A pointer to the HMAC handle slot.
+  @param  Key                          A pointer to the current finished key.
+
+  @return the keyed HMAC handle, or NULL if no handle can be allocated or keyed.
+**/
+VOID *
+SpdmSecuredMessageGetHmacContext (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN OUT SPDM_SECURED_MESSAGE_HMAC_CONTEXT  *HmacContext,
+  IN     CONST UINT8                        *Key
+  );
+
+/**
+  Release the HMAC handle held in an HMAC handle slot and wipe the cached key.
+
+  @param  HmacContext                  A pointer to the HMAC handle slot.
+**/
+VOID
+SpdmSecuredMessageFreeHmacContext (
+  IN OUT SPDM_SECURED_MESSAGE_HMAC_CONTEXT  *HmacContext
+  );
+
+/**
+  Install the current key of one direction into the inline crypto engine, if it is not installed yet.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  IsRequester                  Indicates if it is the requester direction.
+  @param  Key                          A pointer to the current AEAD key of this direction.
+  @param  Salt                         A pointer to the current salt of this direction.
+
+  @retval TRUE   The key is installed in the inline crypto engine.
+  @retval FALSE  No inline crypto engine is registered, or the key cannot be installed.
+**/
+BOOLEAN
+SpdmSecuredMessageOffloadKey (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN     BOOLEAN                            IsRequester,
+  IN     CONST UINT8                        *Key,
+  IN     CONST UINT8                        *Salt
+  );
+
+/**
+  Return if the records protected with an AEAD handle slot and a key are encrypted and decrypted
+  by the inline crypto engine.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot of the direction.
+  @param  Key                          A pointer to the AEAD key of the record.
+  @param  IsRequester                  Return if the AEAD handle slot is of the requester direction.
+
+  @retval TRUE   The record is encrypted and decrypted by the inline crypto engine.
+  @retval FALSE  The record is encrypted and decrypted in software.
+**/
+BOOLEAN
+SpdmSecuredMessageIsOffloaded (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN     SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN     CONST UINT8                        *Key,
+     OUT BOOLEAN                            *IsRequester
+  );
+
+/**
+  Remove the keys installed in the inline crypto engine and wipe the cached copies.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+**/
+VOID
+SpdmSecuredMessageClearOffloadKeys (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext
+  );
+
 #endif
\ No newline at end of file
@@ -74,6 +74,291 @@ SpdmSecuredMessageDheGenerateKey (
   return SpdmDheGenerateKey (DHENamedGroup, DheContext, PublicKey, PublicKeySize);
 }
 
+/**
+  Acquire the lock of a DHE key pool, if the pool has one.
+
+  @param  Pool                         A pointer to the DHE key pool.
+**/
+VOID
+SpdmDheKeyPoolLock (
+  IN SPDM_DHE_KEY_POOL            *Pool
+  )
+{
+  if (Pool->AcquireLock != NULL) {
+    Pool->AcquireLock (Pool->LockContext);
+  }
+}
+
+/**
+  Release the lock of a DHE key pool, if the pool has one.
+
+  @param  Pool                         A pointer to the DHE key pool.
+**/
+VOID
+SpdmDheKeyPoolUnlock (
+  IN SPDM_DHE_KEY_POOL            *Pool
+  )
+{
+  if (Pool->ReleaseLock != NULL) {
+    Pool->ReleaseLock (Pool->LockContext);
+  }
+}
+
+/**
+  Return the size in bytes of a DHE key pool.
+
+  @param  EntryCount                   The number of DHE key pairs the pool can hold.
+
+  @return the size in bytes of the DHE key pool.
+**/
+UINTN
+EFIAPI
+SpdmSecuredMessageDheKeyPoolGetSize (
+  IN      UINTN                        EntryCount
+  )
+{
+  return sizeof(SPDM_DHE_KEY_POOL) + sizeof(SPDM_DHE_KEY_POOL_ENTRY) * EntryCount;
+}
+
+/**
+  Initialize a DHE key pool.
+
+  The pool holds DHE contexts with a generated key pair, so that the key generation can be
+  moved out of KEY_EXCHANGE processing. The size in bytes of the pool can be returned by
+  SpdmSecuredMessageDheKeyPoolGetSize. If the pool is refilled from another thread,
+  AcquireLock and ReleaseLock must be provided to serialize the access to the pool.
+
+  @param  DheKeyPool                   A pointer to the DHE key pool.
+  @param  EntryCount                   The number of DHE key pairs the pool can hold.
+  @param  AcquireLock                  The function to acquire the pool lock, or NULL.
+  @param  ReleaseLock                  The function to release the pool lock, or NULL.
+  @param  LockContext                  The context passed to AcquireLock and ReleaseLock.
+**/
+VOID
+EFIAPI
+SpdmSecuredMessageDheKeyPoolInit (
+  IN      VOID                         *DheKeyPool,
+  IN      UINTN                        EntryCount,
+  IN      SPDM_SECURED_MESSAGE_LOCK_FUNC  AcquireLock OPTIONAL,
+  IN      SPDM_SECURED_MESSAGE_LOCK_FUNC  ReleaseLock OPTIONAL,
+  IN      VOID                         *LockContext OPTIONAL
+  )
+{
+  SPDM_DHE_KEY_POOL             *Pool;
+
+  Pool = DheKeyPool;
+  ZeroMem (Pool, SpdmSecuredMessageDheKeyPoolGetSize (EntryCount));
+  Pool->EntryCount = EntryCount;
+  Pool->AcquireLock = AcquireLock;
+  Pool->ReleaseLock = ReleaseLock;
+  Pool->LockContext = LockContext;
+}
+
+/**
+  Release the DHE key pairs held by a DHE key pool.
+
+  No refill may be in progress.
+
+  @param  DheKeyPool                   A pointer to the DHE key pool.
+**/
+VOID
+EFIAPI
+SpdmSecuredMessageDheKeyPoolDeinit (
+  IN      VOID                         *DheKeyPool
+  )
+{
+  SPDM_DHE_KEY_POOL             *Pool;
+  SPDM_DHE_KEY_POOL_ENTRY       *Entry;
+  UINTN                         Index;
+
+  Pool = DheKeyPool;
+  Entry = (SPDM_DHE_KEY_POOL_ENTRY *)(Pool + 1);
+  SpdmDheKeyPoolLock (Pool);
+  for (Index = 0; Index < Pool->EntryCount; Index++) {
+    ASSERT (Entry[Index].State != SpdmDheKeyPoolEntryGenerating);
+    if (Entry[Index].State == SpdmDheKeyPoolEntryReady) {
+      SpdmDheFree (Entry[Index].DHENamedGroup, Entry[Index].DheContext);
+    }
+    ZeroMem (&Entry[Index], sizeof(SPDM_DHE_KEY_POOL_ENTRY));
+  }
+  SpdmDheKeyPoolUnlock (Pool);
+}
+
+/**
+  Generate DHE key pairs for the free entries of a DHE key pool.
+
+  This function is intended to be called from an idle hook or a background thread.
+  The pool lock is not held during the key generation.
+
+  @param  DheKeyPool                   A pointer to the DHE key pool.
+  @param  DHENamedGroup                SPDM DHENamedGroup of the key pairs to generate.
+  @param  MaxCount                     The maximum number of key pairs to generate.
+
+  @return the number of key pairs generated.
+**/
+UINTN
+EFIAPI
+SpdmSecuredMessageDheKeyPoolRefill (
+  IN      VOID                         *DheKeyPool,
+  IN      UINT16                       DHENamedGroup,
+  IN      UINTN                        MaxCount
+  )
+{
+  SPDM_DHE_KEY_POOL             *Pool;
+  SPDM_DHE_KEY_POOL_ENTRY       *Entry;
+  SPDM_DHE_KEY_POOL_ENTRY       *FreeEntry;
+  UINTN                         Index;
+  UINTN                         Count;
+  VOID                          *DheContext;
+  UINT8                         PublicKey[MAX_DHE_KEY_SIZE];
+  UINTN                         PublicKeySize;
+  BOOLEAN                       Result;
+
+  Pool = DheKeyPool;
+  Entry = (SPDM_DHE_KEY_POOL_ENTRY *)(Pool + 1);
+  for (Count = 0; Count < MaxCount; Count++) {
+    FreeEntry = NULL;
+    SpdmDheKeyPoolLock (Pool);
+    for (Index = 0; Index < Pool->EntryCount; Index++) {
+      if (Entry[Index].State == SpdmDheKeyPoolEntryFree) {
+        FreeEntry = &Entry[Index];
+        FreeEntry->State = SpdmDheKeyPoolEntryGenerating;
+        break;
+      }
+    }
+    SpdmDheKeyPoolUnlock (Pool);
+    if (FreeEntry == NULL) {
+      break;
+    }
+
+    Result = FALSE;
+    PublicKeySize = sizeof(PublicKey);
+    DheContext = SpdmDheNew (DHENamedGroup);
+    if (DheContext != NULL) {
+      Result = SpdmDheGenerateKey (DHENamedGroup, DheContext, PublicKey, &PublicKeySize);
+      if (!Result) {
+        SpdmDheFree (DHENamedGroup, DheContext);
+      }
+    }
+
+    SpdmDheKeyPoolLock (Pool);
+    if (Result) {
+      FreeEntry->DHENamedGroup = DHENamedGroup;
+      FreeEntry->DheContext = DheContext;
+      FreeEntry->PublicKeySize = PublicKeySize;
+      CopyMem (FreeEntry->PublicKey, PublicKey, PublicKeySize);
+      FreeEntry->State = SpdmDheKeyPoolEntryReady;
+    } else {
+      FreeEntry->State = SpdmDheKeyPoolEntryFree;
+    }
+    SpdmDheKeyPoolUnlock (Pool);
+    if (!Result) {
+      break;
+    }
+  }
+  return Count;
+}
+
+/**
+  Return the occupancy of a DHE key pool.
+
+  @param  DheKeyPool                   A pointer to the DHE key pool.
+  @param  Stats                        The occupancy of the DHE key pool.
+**/
+VOID
+EFIAPI
+SpdmSecuredMessageDheKeyPoolGetStats (
+  IN      VOID                         *DheKeyPool,
+  OUT     SPDM_DHE_KEY_POOL_STATS      *Stats
+  )
+{
+  SPDM_DHE_KEY_POOL             *Pool;
+  SPDM_DHE_KEY_POOL_ENTRY       *Entry;
+  UINTN                         Index;
+
+  Pool = DheKeyPool;
+  Entry = (SPDM_DHE_KEY_POOL_ENTRY *)(Pool + 1);
+  ZeroMem (Stats, sizeof(SPDM_DHE_KEY_POOL_STATS));
+  SpdmDheKeyPoolLock (Pool);
+  Stats->EntryCount = Pool->EntryCount;
+  for (Index = 0; Index < Pool->EntryCount; Index++) {
+    if (Entry[Index].State == SpdmDheKeyPoolEntryReady) {
+      Stats->ReadyCount++;
+    }
+  }
+  Stats->HitCount = Pool->HitCount;
+  Stats->MissCount = Pool->MissCount;
+  SpdmDheKeyPoolUnlock (Pool);
+}
+
+/**
+  Return a DHE context with a generated key pair,
+  based upon negotiated DHE algorithm.
+
+  The key pair is taken from the DHE key pool if the pool has one for DHENamedGroup.
+  Otherwise a new DHE context is allocated and its key pair is generated.
+  The DHE context must be released by SpdmSecuredMessageDheFree.
+
+  @param  DheKeyPool                   A pointer to the DHE key pool, or NULL.
+  @param  DHENamedGroup                SPDM DHENamedGroup
+  @param  PublicKey                    Pointer to the buffer to receive generated public key.
+  @param  PublicKeySize                On input, the size of PublicKey buffer in bytes.
+                                       On output, the size of data returned in PublicKey buffer in bytes.
+
+  @return  Pointer to the DHE context, or NULL if the key pair cannot be generated.
+**/
+VOID *
+EFIAPI
+SpdmSecuredMessageDheNewFromPool (
+  IN      VOID                         *DheKeyPool OPTIONAL,
+  IN      UINT16                       DHENamedGroup,
+  OUT     UINT8                        *PublicKey,
+  IN OUT  UINTN                        *PublicKeySize
+  )
+{
+  SPDM_DHE_KEY_POOL             *Pool;
+  SPDM_DHE_KEY_POOL_ENTRY       *Entry;
+  UINTN                         Index;
+  VOID                          *DheContext;
+
+  DheContext = NULL;
+  Pool = DheKeyPool;
+  if (Pool != NULL) {
+    Entry = (SPDM_DHE_KEY_POOL_ENTRY *)(Pool + 1);
+    SpdmDheKeyPoolLock (Pool);
+    for (Index = 0; Index < Pool->EntryCount; Index++) {
+      if ((Entry[Index].State == SpdmDheKeyPoolEntryReady) &&
+          (Entry[Index].DHENamedGroup == DHENamedGroup) &&
+          (Entry[Index].PublicKeySize <= *PublicKeySize)) {
+        DheContext = Entry[Index].DheContext;
+        CopyMem (PublicKey, Entry[Index].PublicKey, Entry[Index].PublicKeySize);
+        *PublicKeySize = Entry[Index].PublicKeySize;
+        ZeroMem (&Entry[Index], sizeof(SPDM_DHE_KEY_POOL_ENTRY));
+        break;
+      }
+    }
+    if (DheContext != NULL) {
+      Pool->HitCount++;
+    } else {
+      Pool->MissCount++;
+    }
+    SpdmDheKeyPoolUnlock (Pool);
+    if (DheContext != NULL) {
+      return DheContext;
+    }
+  }
+
+  DheContext = SpdmDheNew (DHENamedGroup);
+  if (DheContext == NULL) {
+    return NULL;
+  }
+  if (!SpdmDheGenerateKey (DHENamedGroup, DheContext, PublicKey, PublicKeySize)) {
+    SpdmDheFree (DHENamedGroup, DheContext);
+    return NULL;
+  }
+  return DheContext;
+}
+
 /**
   Computes exchanged common key,
   based upon negotiated DHE algorithm.
@@ -0,0 +1,208 @@
+/** @file
+  SPDM Secured Message library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmSecuredMessageLibInternal.h"
+
+/**
+  Set the inline crypto engine offload functions to an SPDM secured message context.
+
+  The current key of each direction is installed by OffloadOps->SetKey before the first record
+  of the direction is encoded or decoded with it, so that a handshake key, a data key, a key update
+  or imported session keys reach the engine without a software copy.
+  If OffloadOps provides Seal and Open, the records of a direction with an installed key are encrypted
+  and decrypted by the engine instead of the software AEAD. If SetKey fails, the software AEAD is used.
+  The installed keys are removed by OffloadOps->ClearKey in SpdmSecuredMessageDeinitContext.
+
+  @param  SpdmSecuredMessageContext    A pointer to the SPDM secured message context.
+  @param  SessionId                    The session ID of the SPDM session.
+  @param  OffloadOps                   A pointer to the offload functions, or NULL to use software only.
+  @param  OffloadContext               The context passed to the offload functions.
+**/
+VOID
+EFIAPI
+SpdmSecuredMessageSetOffloadOps (
+  IN     VOID                                    *SpdmSecuredMessageContext,
+  IN     UINT32                                  SessionId,
+  IN     CONST SPDM_SECURED_MESSAGE_OFFLOAD_OPS  *OffloadOps OPTIONAL,
+  IN     VOID                                    *OffloadContext OPTIONAL
+  )
+{
+  SPDM_SECURED_MESSAGE_CONTEXT           *SecuredMessageContext;
+
+  SecuredMessageContext = SpdmSecuredMessageContext;
+  SpdmSecuredMessageClearOffloadKeys (SecuredMessageContext);
+
+  if ((OffloadOps != NULL) &&
+      ((OffloadOps->Version != SPDM_SECURED_MESSAGE_OFFLOAD_OPS_VERSION) ||
+       (OffloadOps->SetKey == NULL) ||
+       ((OffloadOps->Seal == NULL) != (OffloadOps->Open == NULL)))) {
+    ASSERT (FALSE);
+    OffloadOps = NULL;
+  }
+  SecuredMessageContext->OffloadOps     = OffloadOps;
+  SecuredMessageContext->OffloadContext = OffloadContext;
+  SecuredMessageContext->SessionId      = SessionId;
+}
+
+/**
+  Return the offloaded key of one direction.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  IsRequester                  Indicates if it is the requester direction.
+
+  @return the offloaded key of the direction.
+**/
+SPDM_SECURED_MESSAGE_OFFLOAD_KEY *
+SpdmSecuredMessageGetOffloadKey (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN     BOOLEAN                            IsRequester
+  )
+{
+  if (IsRequester) {
+    return &SecuredMessageContext->RequestOffloadKey;
+  } else {
+    return &SecuredMessageContext->ResponseOffloadKey;
+  }
+}
+
+/**
+  Install the current key of one direction into the inline crypto engine, if it is not installed yet.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  IsRequester                  Indicates if it is the requester direction.
+  @param  Key                          A pointer to the current AEAD key of this direction.
+  @param  Salt                         A pointer to the current salt of this direction.
+
+  @retval TRUE   The key is installed in the inline crypto engine.
+  @retval FALSE  No inline crypto engine is registered, or the key cannot be installed.
+**/
+BOOLEAN
+SpdmSecuredMessageOffloadKey (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN     BOOLEAN                            IsRequester,
+  IN     CONST UINT8                        *Key,
+  IN     CONST UINT8                        *Salt
+  )
+{
+  SPDM_SECURED_MESSAGE_OFFLOAD_KEY  *OffloadKey;
+  RETURN_STATUS                     Status;
+
+  if (SecuredMessageContext->OffloadOps == NULL) {
+    return FALSE;
+  }
+
+  OffloadKey = SpdmSecuredMessageGetOffloadKey (SecuredMessageContext, IsRequester);
+  if (OffloadKey->Installed &&
+      (SpdmConstTimeCompareMem (OffloadKey->Key, Key, SecuredMessageContext->AeadKeySize) == 0) &&
+      (SpdmConstTimeCompareMem (OffloadKey->Salt, Salt, SecuredMessageContext->AeadIvSize) == 0)) {
+    return TRUE;
+  }
+
+  Status = SecuredMessageContext->OffloadOps->SetKey (
+             SecuredMessageContext->OffloadContext,
+             SecuredMessageContext->SessionId,
+             IsRequester,
+             SecuredMessageContext->AEADCipherSuite,
+             Key,
+             SecuredMessageContext->AeadKeySize,
+             Salt,
+             SecuredMessageContext->AeadIvSize
+             );
+  if (RETURN_ERROR(Status)) {
+    OffloadKey->Installed = FALSE;
+    ZeroMem (OffloadKey->Key, sizeof(OffloadKey->Key));
+    ZeroMem (OffloadKey->Salt, sizeof(OffloadKey->Salt));
+    return FALSE;
+  }
+  OffloadKey->Installed = TRUE;
+  CopyMem (OffloadKey->Key, Key, SecuredMessageContext->AeadKeySize);
+  CopyMem (OffloadKey->Salt, Salt, SecuredMessageContext->AeadIvSize);
+  return TRUE;
+}
+
+/**
+  Return if the records protected with an AEAD handle slot and a key are encrypted and decrypted
+  by the inline crypto engine.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  AeadContext                  A pointer to the AEAD handle slot of the direction.
+  @param  Key                          A pointer to the AEAD key of the record.
+  @param  IsRequester                  Return if the AEAD handle slot is of the requester direction.
+
+  @retval TRUE   The record is encrypted and decrypted by the inline crypto engine.
+  @retval FALSE  The record is encrypted and decrypted in software.
+**/
+BOOLEAN
+SpdmSecuredMessageIsOffloaded (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN     SPDM_SECURED_MESSAGE_AEAD_CONTEXT  *AeadContext,
+  IN     CONST UINT8                        *Key,
+     OUT BOOLEAN                            *IsRequester
+  )
+{
+  SPDM_SECURED_MESSAGE_OFFLOAD_KEY  *OffloadKey;
+
+  if ((SecuredMessageContext->OffloadOps == NULL) ||
+      (SecuredMessageContext->OffloadOps->Seal == NULL)) {
+    return FALSE;
+  }
+
+  if ((AeadContext == &SecuredMessageContext->RequestHandshakeAead) ||
+      (AeadContext == &SecuredMessageContext->RequestDataAead)) {
+    *IsRequester = TRUE;
+  } else if ((AeadContext == &SecuredMessageContext->ResponseHandshakeAead) ||
+             (AeadContext == &SecuredMessageContext->ResponseDataAead)) {
+    *IsRequester = FALSE;
+  } else {
+    return FALSE;
+  }
+
+  OffloadKey = SpdmSecuredMessageGetOffloadKey (SecuredMessageContext, *IsRequester);
+  return OffloadKey->Installed &&
+         (SpdmConstTimeCompareMem (OffloadKey->Key, Key, SecuredMessageContext->AeadKeySize) == 0);
+}
+
+/**
+  Remove the key of one direction from the inline crypto engine and wipe the cached copy.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+  @param  IsRequester                  Indicates if it is the requester direction.
+**/
+VOID
+SpdmSecuredMessageClearOffloadKey (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext,
+  IN     BOOLEAN                            IsRequester
+  )
+{
+  SPDM_SECURED_MESSAGE_OFFLOAD_KEY  *OffloadKey;
+
+  OffloadKey = SpdmSecuredMessageGetOffloadKey (SecuredMessageContext, IsRequester);
+  if (OffloadKey->Installed && (SecuredMessageContext->OffloadOps->ClearKey != NULL)) {
+    SecuredMessageContext->OffloadOps->ClearKey (
+      SecuredMessageContext->OffloadContext,
+      SecuredMessageContext->SessionId,
+      IsRequester
+      );
+  }
+  ZeroMem (OffloadKey, sizeof(SPDM_SECURED_MESSAGE_OFFLOAD_KEY));
+}
+
+/**
+  Remove the keys installed in the inline crypto engine and wipe the cached copies.
+
+  @param  SecuredMessageContext        A pointer to the SPDM secured message context.
+**/
+VOID
+SpdmSecuredMessageClearOffloadKeys (
+  IN     SPDM_SECURED_MESSAGE_CONTEXT       *SecuredMessageContext
+  )
+{
+  SpdmSecuredMessageClearOffloadKey (SecuredMessageContext, TRUE);
+  SpdmSecuredMessageClearOffloadKey (SecuredMessageContext, FALSE);
+}
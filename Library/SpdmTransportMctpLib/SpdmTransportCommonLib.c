@@ -10,6 +10,18 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/SpdmTransportMctpLib.h>
 #include <Library/SpdmSecuredMessageLib.h>
 
+/**
+  Return the room that the MCTP wrapper needs around a message.
+
+  @param  Headroom                     Size in bytes of the MCTP header before the message.
+  @param  Tailroom                     Max size in bytes of the MCTP padding after the message.
+**/
+VOID
+MctpGetMessageRoom (
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  );
+
 /**
   Encode a normal message or secured message to a transport message.
 
@@ -113,6 +125,9 @@ RETURN_STATUS
   The APP message format is defined by the transport layer.
   Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
 
+  A secured message is encoded in place at the headroom returned by SpdmTransportMctpGetMessageRoom
+  in TransportMessage. If Message is elsewhere, it is copied to the headroom first.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
                                        If SessionId is NULL, it is a normal message.
@@ -142,13 +157,16 @@ SpdmTransportMctpEncodeMessage (
 {
   RETURN_STATUS                       Status;
   TRANSPORT_ENCODE_MESSAGE_FUNC       TransportEncodeMessage;
-  UINT8                               AppMessageBuffer[MAX_SPDM_MESSAGE_BUFFER_SIZE];
   VOID                                *AppMessage;
   UINTN                               AppMessageSize;
-  UINT8                               SecuredMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  VOID                                *SecuredMessage;
   UINTN                               SecuredMessageSize;
   SPDM_SECURED_MESSAGE_CALLBACKS      SpdmSecuredMessageCallbacks;
   VOID                                *SecuredMessageContext;
+  UINTN                               Headroom;
+  UINTN                               Tailroom;
+  UINTN                               TransportHeadroom;
+  UINTN                               TransportTailroom;
 
   SpdmSecuredMessageCallbacks.Version = SPDM_SECURED_MESSAGE_CALLBACKS_VERSION;
   SpdmSecuredMessageCallbacks.GetSequenceNumber = MctpGetSequenceNumber;
@@ -166,16 +184,34 @@ SpdmTransportMctpEncodeMessage (
       return RETURN_UNSUPPORTED;
     }
 
+    //
+    // The message is wrapped in place at the headroom of the transport message,
+    // each layer writing its header and trailer around the previous one.
+    // A message elsewhere is copied to the headroom first, so that it is the only copy.
+    //
+    Status = SpdmTransportMctpGetMessageRoom (SpdmContext, SessionId, IsAppMessage, &Headroom, &Tailroom);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    if (*TransportMessageSize < Headroom + MessageSize) {
+      return RETURN_BUFFER_TOO_SMALL;
+    }
+    if ((UINT8 *)Message != (UINT8 *)TransportMessage + Headroom) {
+      CopyMem ((UINT8 *)TransportMessage + Headroom, Message, MessageSize);
+      Message = (UINT8 *)TransportMessage + Headroom;
+    }
+    MctpGetMessageRoom (&TransportHeadroom, &TransportTailroom);
+
     if (!IsAppMessage) {
       // SPDM message to APP message
-      AppMessage = AppMessageBuffer;
-      AppMessageSize = sizeof(AppMessageBuffer);
+      AppMessage = (UINT8 *)Message - TransportHeadroom;
+      AppMessageSize = *TransportMessageSize - (Headroom - TransportHeadroom);
       Status = TransportEncodeMessage (
                  NULL,
                  MessageSize,
                  Message,
                  &AppMessageSize,
-                 AppMessageBuffer
+                 AppMessage
                  );
       if (RETURN_ERROR(Status)) {
         DEBUG ((DEBUG_ERROR, "TransportEncodeMessage - %p\n", Status));
@@ -186,7 +222,8 @@ SpdmTransportMctpEncodeMessage (
       AppMessageSize = MessageSize;
     }
     // APP message to secured message
-    SecuredMessageSize = sizeof(SecuredMessage);
+    SecuredMessage = (UINT8 *)TransportMessage + TransportHeadroom;
+    SecuredMessageSize = *TransportMessageSize - TransportHeadroom;
     Status = SpdmEncodeSecuredMessage (
                SecuredMessageContext,
                *SessionId,
@@ -243,6 +280,10 @@ SpdmTransportMctpEncodeMessage (
   The APP message format is defined by the transport layer.
   Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
 
+  A secured message is decoded directly in Message. If Message overlaps TransportMessage,
+  it is decoded in place at the headroom returned by SpdmTransportMctpGetMessageRoom
+  and TransportMessage is overwritten.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
                                        If *SessionId is NULL, it is a normal message.
@@ -274,13 +315,17 @@ SpdmTransportMctpDecodeMessage (
   RETURN_STATUS                       Status;
   TRANSPORT_DECODE_MESSAGE_FUNC       TransportDecodeMessage;
   UINT32                              *SecuredMessageSessionId;
-  UINT8                               SecuredMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  VOID                                *SecuredMessage;
   UINTN                               SecuredMessageSize;
-  UINT8                               AppMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  VOID                                *AppMessage;
   UINTN                               AppMessageSize;
   SPDM_SECURED_MESSAGE_CALLBACKS      SpdmSecuredMessageCallbacks;
   VOID                                *SecuredMessageContext;
   SPDM_ERROR_STRUCT                   SpdmError;
+  UINTN                               Headroom;
+  UINTN                               Tailroom;
+  UINTN                               TransportHeadroom;
+  UINTN                               TransportTailroom;
 
   SpdmError.ErrorCode = 0;
   SpdmError.SessionId = 0;
@@ -295,10 +340,15 @@ SpdmTransportMctpDecodeMessage (
   }
 
   TransportDecodeMessage = MctpDecodeMessage;
+  MctpGetMessageRoom (&TransportHeadroom, &TransportTailroom);
+  if (TransportMessageSize <= TransportHeadroom) {
+    return RETURN_UNSUPPORTED;
+  }
 
   SecuredMessageSessionId = NULL;
-  // Detect received message
-  SecuredMessageSize = sizeof(SecuredMessage);
+  // Detect received message, leaving the secured message in the transport message
+  SecuredMessage = (UINT8 *)TransportMessage + TransportHeadroom;
+  SecuredMessageSize = TransportMessageSize - TransportHeadroom;
   Status = TransportDecodeMessage (
               &SecuredMessageSessionId,
               TransportMessageSize,
@@ -322,8 +372,22 @@ SpdmTransportMctpDecodeMessage (
       return RETURN_UNSUPPORTED;
     }
 
-    // Secured message to APP message
-    AppMessageSize = sizeof(AppMessage);
+    //
+    // Secured message to APP message, in place at the headroom of the transport message
+    // if Message overlaps the transport message, or else directly in Message.
+    //
+    Status = SpdmTransportMctpGetMessageRoom (SpdmContext, SecuredMessageSessionId, TRUE, &Headroom, &Tailroom);
+    if (RETURN_ERROR(Status) || (TransportMessageSize < Headroom)) {
+      return RETURN_UNSUPPORTED;
+    }
+    if (((UINT8 *)Message < (UINT8 *)TransportMessage + TransportMessageSize) &&
+        ((UINT8 *)Message + *MessageSize > (UINT8 *)TransportMessage)) {
+      AppMessage = (UINT8 *)TransportMessage + Headroom;
+      AppMessageSize = TransportMessageSize - Headroom;
+    } else {
+      AppMessage = Message;
+      AppMessageSize = *MessageSize;
+    }
     Status = SpdmDecodeSecuredMessage (
                SecuredMessageContext,
                *SecuredMessageSessionId,
@@ -388,3 +452,70 @@ SpdmTransportMctpDecodeMessage (
     return RETURN_SUCCESS;
   }
 }
+
+/**
+  Return the room that a transport layer message needs around an SPDM or APP message.
+
+  An SPDM or APP message at Headroom bytes into a buffer, followed by at least Tailroom spare bytes,
+  is encoded in place by SpdmTransportMctpEncodeMessage with that buffer as the transport message.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  Headroom                     Size in bytes of the transport message data before the message.
+  @param  Tailroom                     Max size in bytes of the transport message data after the message.
+
+  @retval RETURN_SUCCESS               The room is returned successfully.
+  @retval RETURN_UNSUPPORTED           The message is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpGetMessageRoom (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  )
+{
+  SPDM_SECURED_MESSAGE_CALLBACKS      SpdmSecuredMessageCallbacks;
+  VOID                                *SecuredMessageContext;
+  UINTN                               TransportHeadroom;
+  UINTN                               TransportTailroom;
+  UINTN                               SecuredMessageHeadroom;
+  UINTN                               SecuredMessageTailroom;
+
+  SpdmSecuredMessageCallbacks.Version = SPDM_SECURED_MESSAGE_CALLBACKS_VERSION;
+  SpdmSecuredMessageCallbacks.GetSequenceNumber = MctpGetSequenceNumber;
+  SpdmSecuredMessageCallbacks.GetMaxRandomNumberCount = MctpGetMaxRandomNumberCount;
+
+  if (IsAppMessage && (SessionId == NULL)) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  MctpGetMessageRoom (&TransportHeadroom, &TransportTailroom);
+  *Headroom = TransportHeadroom;
+  *Tailroom = TransportTailroom;
+  if (SessionId == NULL) {
+    return RETURN_SUCCESS;
+  }
+
+  SecuredMessageContext = SpdmGetSecuredMessageContextViaSessionId (SpdmContext, *SessionId);
+  if (SecuredMessageContext == NULL) {
+    return RETURN_UNSUPPORTED;
+  }
+  SpdmSecuredMessageGetMessageRoom (SecuredMessageContext, &SpdmSecuredMessageCallbacks, &SecuredMessageHeadroom, &SecuredMessageTailroom);
+  *Headroom += SecuredMessageHeadroom;
+  *Tailroom += SecuredMessageTailroom;
+  if (!IsAppMessage) {
+    //
+    // The SPDM message is wrapped to an APP message inside the secured message.
+    //
+    *Headroom += TransportHeadroom;
+    *Tailroom += TransportTailroom;
+  }
+
+  return RETURN_SUCCESS;
+}
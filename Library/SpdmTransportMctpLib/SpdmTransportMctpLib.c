@@ -55,6 +55,22 @@ MctpGetMaxRandomNumberCount (
   return MCTP_MAX_RANDOM_NUMBER_COUNT;
 }
 
+/**
+  Return the room that the MCTP wrapper needs around a message.
+
+  @param  Headroom                     Size in bytes of the MCTP header before the message.
+  @param  Tailroom                     Max size in bytes of the MCTP padding after the message.
+**/
+VOID
+MctpGetMessageRoom (
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  )
+{
+  *Headroom = sizeof(MCTP_MESSAGE_HEADER);
+  *Tailroom = MCTP_ALIGNMENT - 1;
+}
+
 /**
   Encode a normal message or secured message to a transport message.
 
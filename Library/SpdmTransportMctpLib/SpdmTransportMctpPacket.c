@@ -0,0 +1,346 @@
+/** @file
+  SPDM transport library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/SpdmTransportMctpLib.h>
+#include <IndustryStandard/MctpBinding.h>
+
+#define MCTP_PACKET_SEQUENCE_NUMBER_COUNT 4
+
+typedef enum {
+  MctpReassemblyStateFree,
+  MctpReassemblyStateInProgress,
+  MctpReassemblyStateComplete,
+} MCTP_REASSEMBLY_STATE;
+
+typedef struct {
+  UINT8                  *Buffer;
+  UINTN                  BufferSize;
+  MCTP_REASSEMBLY_STATE  State;
+  UINT8                  SourceId;
+  UINT8                  MessageTag;
+  UINT8                  NextSequenceNumber;
+  UINTN                  MessageSize;
+} MCTP_REASSEMBLY_MESSAGE;
+
+typedef struct {
+  UINTN                    TransmissionUnit;
+  UINTN                    MessageCount;
+  MCTP_REASSEMBLY_MESSAGE  Message[MAX_MCTP_REASSEMBLY_MESSAGE_COUNT];
+} MCTP_REASSEMBLY_CONTEXT;
+
+/**
+  Return the number of MCTP packets of an MCTP message.
+
+  @param  MessageSize                  Size in bytes of the MCTP message, from the MCTP message header.
+  @param  TransmissionUnit             Size in bytes of the payload of each packet after the MCTP header,
+                                       at least MCTP_BASELINE_TRANSMISSION_UNIT.
+
+  @return the number of MCTP packets of the MCTP message.
+**/
+UINTN
+EFIAPI
+SpdmTransportMctpGetPacketCount (
+  IN     UINTN                MessageSize,
+  IN     UINTN                TransmissionUnit
+  )
+{
+  if ((MessageSize == 0) || (TransmissionUnit == 0)) {
+    return 0;
+  }
+  return (MessageSize + TransmissionUnit - 1) / TransmissionUnit;
+}
+
+/**
+  Build one MCTP packet of an MCTP message.
+
+  The MCTP header of the packet is built with SOM, EOM and the packet sequence number of PacketIndex,
+  and the payload of the packet is copied from the MCTP message, so that the packets are sent
+  from the transport message encoded by SpdmTransportMctpEncodeMessage without another copy of it.
+
+  @param  DestinationId                The destination EID.
+  @param  SourceId                     The source EID.
+  @param  MessageTag                   The message tag, with MCTP_TAG_OWNER if the tag is owned by the source.
+  @param  TransmissionUnit             Size in bytes of the payload of each packet after the MCTP header,
+                                       at least MCTP_BASELINE_TRANSMISSION_UNIT.
+  @param  MessageSize                  Size in bytes of the MCTP message, from the MCTP message header.
+  @param  Message                      A pointer to the MCTP message.
+  @param  PacketIndex                  The index of the packet, less than SpdmTransportMctpGetPacketCount.
+  @param  PacketSize                   On input, the size in bytes of the packet buffer.
+                                       On output, the size in bytes of the packet.
+  @param  Packet                       A pointer to the packet buffer.
+
+  @retval RETURN_SUCCESS               The packet is built successfully.
+  @retval RETURN_INVALID_PARAMETER     The TransmissionUnit or the PacketIndex is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The packet buffer is too small to hold the packet.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpGetPacket (
+  IN     UINT8                DestinationId,
+  IN     UINT8                SourceId,
+  IN     UINT8                MessageTag,
+  IN     UINTN                TransmissionUnit,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINTN                PacketIndex,
+  IN OUT UINTN                *PacketSize,
+     OUT VOID                 *Packet
+  )
+{
+  MCTP_HEADER                 *MctpHeader;
+  UINTN                       PacketCount;
+  UINTN                       Offset;
+  UINTN                       PayloadSize;
+
+  if (TransmissionUnit < MCTP_BASELINE_TRANSMISSION_UNIT) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  PacketCount = SpdmTransportMctpGetPacketCount (MessageSize, TransmissionUnit);
+  if (PacketIndex >= PacketCount) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Offset = PacketIndex * TransmissionUnit;
+  PayloadSize = MIN (MessageSize - Offset, TransmissionUnit);
+  if (*PacketSize < sizeof(MCTP_HEADER) + PayloadSize) {
+    *PacketSize = sizeof(MCTP_HEADER) + PayloadSize;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *PacketSize = sizeof(MCTP_HEADER) + PayloadSize;
+
+  MctpHeader = Packet;
+  MctpHeader->HeaderVersion = MCTP_HEADER_VERSION;
+  MctpHeader->DestinationId = DestinationId;
+  MctpHeader->SourceId = SourceId;
+  MctpHeader->MessageTag = (UINT8)((MessageTag & (MCTP_MESSAGE_TAG_MASK | MCTP_TAG_OWNER)) |
+                                   (((PacketIndex % MCTP_PACKET_SEQUENCE_NUMBER_COUNT) << MCTP_PACKET_SEQUENCE_NUMBER_SHIFT) & MCTP_PACKET_SEQUENCE_NUMBER_MASK));
+  if (PacketIndex == 0) {
+    MctpHeader->MessageTag |= MCTP_START_OF_MESSAGE;
+  }
+  if (PacketIndex == PacketCount - 1) {
+    MctpHeader->MessageTag |= MCTP_END_OF_MESSAGE;
+  }
+  CopyMem (MctpHeader + 1, (UINT8 *)Message + Offset, PayloadSize);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return the size in bytes of an MCTP reassembly context.
+
+  @return the size in bytes of the MCTP reassembly context.
+**/
+UINTN
+EFIAPI
+SpdmTransportMctpReassemblyGetSize (
+  VOID
+  )
+{
+  return sizeof(MCTP_REASSEMBLY_CONTEXT);
+}
+
+/**
+  Initialize an MCTP reassembly context.
+
+  The reassembly context reassembles up to MAX_MCTP_REASSEMBLY_MESSAGE_COUNT MCTP messages at the same time,
+  one per source EID and message tag, into the buffers added by SpdmTransportMctpReassemblyAddBuffer.
+
+  @param  Reassembly                   A pointer to the MCTP reassembly context.
+  @param  TransmissionUnit             Size in bytes of the payload of each packet after the MCTP header,
+                                       at least MCTP_BASELINE_TRANSMISSION_UNIT.
+**/
+VOID
+EFIAPI
+SpdmTransportMctpReassemblyInit (
+     OUT VOID                 *Reassembly,
+  IN     UINTN                TransmissionUnit
+  )
+{
+  MCTP_REASSEMBLY_CONTEXT     *Context;
+
+  Context = Reassembly;
+  ZeroMem (Context, sizeof(MCTP_REASSEMBLY_CONTEXT));
+  Context->TransmissionUnit = MAX (TransmissionUnit, MCTP_BASELINE_TRANSMISSION_UNIT);
+}
+
+/**
+  Add a buffer to an MCTP reassembly context, to reassemble one MCTP message into.
+
+  @param  Reassembly                   A pointer to the MCTP reassembly context.
+  @param  Buffer                       A pointer to the buffer.
+  @param  BufferSize                   Size in bytes of the buffer.
+
+  @retval RETURN_SUCCESS               The buffer is added successfully.
+  @retval RETURN_OUT_OF_RESOURCES      MAX_MCTP_REASSEMBLY_MESSAGE_COUNT buffers are added already.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpReassemblyAddBuffer (
+  IN OUT VOID                 *Reassembly,
+  IN     VOID                 *Buffer,
+  IN     UINTN                BufferSize
+  )
+{
+  MCTP_REASSEMBLY_CONTEXT     *Context;
+  MCTP_REASSEMBLY_MESSAGE     *ReassemblyMessage;
+
+  Context = Reassembly;
+  if (Context->MessageCount >= MAX_MCTP_REASSEMBLY_MESSAGE_COUNT) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  ReassemblyMessage = &Context->Message[Context->MessageCount];
+  ReassemblyMessage->Buffer = Buffer;
+  ReassemblyMessage->BufferSize = BufferSize;
+  ReassemblyMessage->State = MctpReassemblyStateFree;
+  Context->MessageCount++;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Reassemble an MCTP packet received.
+
+  The payload of the packet is copied to its offset in the buffer of the message of its source EID and message tag.
+  A packet with SOM starts a new message, and drops the unfinished message of the same source EID and message tag.
+  A packet out of sequence, a packet whose size differs from the transmission unit without EOM, or a packet
+  exceeding the buffer drops the unfinished message, as a lost packet does, according to DSP0236.
+
+  A reassembled message stays in its buffer until SpdmTransportMctpReassemblyReleaseMessage is called.
+  It can be decoded by SpdmTransportMctpDecodeMessage in place.
+
+  @param  Reassembly                   A pointer to the MCTP reassembly context.
+  @param  PacketSize                   Size in bytes of the packet, from the MCTP header.
+  @param  Packet                       A pointer to the packet.
+  @param  SourceId                     The source EID of the reassembled message.
+  @param  MessageTag                   The message tag of the reassembled message, with MCTP_TAG_OWNER.
+  @param  MessageSize                  Size in bytes of the reassembled message.
+  @param  Message                      A pointer to the reassembled message, in a buffer of the reassembly context.
+
+  @retval RETURN_SUCCESS               The packet completes a message, and the message is returned.
+  @retval RETURN_NOT_READY             The packet is reassembled, and more packets are needed.
+  @retval RETURN_ABORTED               The packet is dropped, with the unfinished message of its source EID and message tag.
+  @retval RETURN_OUT_OF_RESOURCES      The packet starts a message, but no buffer is free.
+  @retval RETURN_UNSUPPORTED           The packet is not a valid MCTP packet.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpReassemblyPushPacket (
+  IN OUT VOID                 *Reassembly,
+  IN     UINTN                PacketSize,
+  IN     VOID                 *Packet,
+     OUT UINT8                *SourceId,
+     OUT UINT8                *MessageTag,
+     OUT UINTN                *MessageSize,
+     OUT VOID                 **Message
+  )
+{
+  MCTP_REASSEMBLY_CONTEXT     *Context;
+  MCTP_REASSEMBLY_MESSAGE     *ReassemblyMessage;
+  MCTP_HEADER                 *MctpHeader;
+  UINT8                       Tag;
+  UINT8                       SequenceNumber;
+  UINTN                       PayloadSize;
+  UINTN                       Index;
+
+  Context = Reassembly;
+  MctpHeader = Packet;
+  if ((PacketSize <= sizeof(MCTP_HEADER)) ||
+      ((MctpHeader->HeaderVersion & MCTP_HEADER_VERSION_MASK) != MCTP_HEADER_VERSION)) {
+    return RETURN_UNSUPPORTED;
+  }
+  PayloadSize = PacketSize - sizeof(MCTP_HEADER);
+  if (PayloadSize > Context->TransmissionUnit) {
+    return RETURN_UNSUPPORTED;
+  }
+  Tag = MctpHeader->MessageTag & (MCTP_MESSAGE_TAG_MASK | MCTP_TAG_OWNER);
+  SequenceNumber = (MctpHeader->MessageTag & MCTP_PACKET_SEQUENCE_NUMBER_MASK) >> MCTP_PACKET_SEQUENCE_NUMBER_SHIFT;
+
+  ReassemblyMessage = NULL;
+  for (Index = 0; Index < Context->MessageCount; Index++) {
+    if ((Context->Message[Index].State == MctpReassemblyStateInProgress) &&
+        (Context->Message[Index].SourceId == MctpHeader->SourceId) &&
+        (Context->Message[Index].MessageTag == Tag)) {
+      ReassemblyMessage = &Context->Message[Index];
+      break;
+    }
+  }
+
+  if ((MctpHeader->MessageTag & MCTP_START_OF_MESSAGE) != 0) {
+    if (ReassemblyMessage == NULL) {
+      for (Index = 0; Index < Context->MessageCount; Index++) {
+        if (Context->Message[Index].State == MctpReassemblyStateFree) {
+          ReassemblyMessage = &Context->Message[Index];
+          break;
+        }
+      }
+      if (ReassemblyMessage == NULL) {
+        return RETURN_OUT_OF_RESOURCES;
+      }
+    }
+    ReassemblyMessage->State = MctpReassemblyStateInProgress;
+    ReassemblyMessage->SourceId = MctpHeader->SourceId;
+    ReassemblyMessage->MessageTag = Tag;
+    ReassemblyMessage->MessageSize = 0;
+  } else {
+    if (ReassemblyMessage == NULL) {
+      return RETURN_ABORTED;
+    }
+    if (SequenceNumber != ReassemblyMessage->NextSequenceNumber) {
+      ReassemblyMessage->State = MctpReassemblyStateFree;
+      return RETURN_ABORTED;
+    }
+  }
+
+  if (((MctpHeader->MessageTag & MCTP_END_OF_MESSAGE) == 0) && (PayloadSize != Context->TransmissionUnit)) {
+    ReassemblyMessage->State = MctpReassemblyStateFree;
+    return RETURN_ABORTED;
+  }
+  if (ReassemblyMessage->MessageSize + PayloadSize > ReassemblyMessage->BufferSize) {
+    ReassemblyMessage->State = MctpReassemblyStateFree;
+    return RETURN_ABORTED;
+  }
+  CopyMem (ReassemblyMessage->Buffer + ReassemblyMessage->MessageSize, MctpHeader + 1, PayloadSize);
+  ReassemblyMessage->MessageSize += PayloadSize;
+  ReassemblyMessage->NextSequenceNumber = (SequenceNumber + 1) % MCTP_PACKET_SEQUENCE_NUMBER_COUNT;
+
+  if ((MctpHeader->MessageTag & MCTP_END_OF_MESSAGE) == 0) {
+    return RETURN_NOT_READY;
+  }
+  ReassemblyMessage->State = MctpReassemblyStateComplete;
+  *SourceId = ReassemblyMessage->SourceId;
+  *MessageTag = ReassemblyMessage->MessageTag;
+  *MessageSize = ReassemblyMessage->MessageSize;
+  *Message = ReassemblyMessage->Buffer;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Release a reassembled message, so that its buffer reassembles another message.
+
+  @param  Reassembly                   A pointer to the MCTP reassembly context.
+  @param  Message                      A pointer to the reassembled message.
+**/
+VOID
+EFIAPI
+SpdmTransportMctpReassemblyReleaseMessage (
+  IN OUT VOID                 *Reassembly,
+  IN     VOID                 *Message
+  )
+{
+  MCTP_REASSEMBLY_CONTEXT     *Context;
+  UINTN                       Index;
+
+  Context = Reassembly;
+  for (Index = 0; Index < Context->MessageCount; Index++) {
+    if ((Context->Message[Index].State == MctpReassemblyStateComplete) &&
+        (Context->Message[Index].Buffer == Message)) {
+      Context->Message[Index].State = MctpReassemblyStateFree;
+      return ;
+    }
+  }
+  ASSERT (FALSE);
+}
@@ -0,0 +1,215 @@
+/** @file
+  SPDM transport library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/SpdmTransportMctpLib.h>
+#include <IndustryStandard/MctpBinding.h>
+
+//
+// ByteCount is one byte, and counts the source slave address and the MCTP header.
+//
+#define MCTP_SMBUS_MAX_TRANSMISSION_UNIT  (MAX_UINT8 - sizeof(UINT8) - sizeof(MCTP_HEADER))
+
+//
+// CRC-8 of each byte value, with the polynomial x^8 + x^2 + x + 1.
+//
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 mMctpSmbusPecTable[256] = {
+  0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31, 0x24, 0x23, 0x2a, 0x2d,
+  0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65, 0x48, 0x4f, 0x46, 0x41, 0x54, 0x53, 0x5a, 0x5d,
+  0xe0, 0xe7, 0xee, 0xe9, 0xfc, 0xfb, 0xf2, 0xf5, 0xd8, 0xdf, 0xd6, 0xd1, 0xc4, 0xc3, 0xca, 0xcd,
+  0x90, 0x97, 0x9e, 0x99, 0x8c, 0x8b, 0x82, 0x85, 0xa8, 0xaf, 0xa6, 0xa1, 0xb4, 0xb3, 0xba, 0xbd,
+  0xc7, 0xc0, 0xc9, 0xce, 0xdb, 0xdc, 0xd5, 0xd2, 0xff, 0xf8, 0xf1, 0xf6, 0xe3, 0xe4, 0xed, 0xea,
+  0xb7, 0xb0, 0xb9, 0xbe, 0xab, 0xac, 0xa5, 0xa2, 0x8f, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9d, 0x9a,
+  0x27, 0x20, 0x29, 0x2e, 0x3b, 0x3c, 0x35, 0x32, 0x1f, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0d, 0x0a,
+  0x57, 0x50, 0x59, 0x5e, 0x4b, 0x4c, 0x45, 0x42, 0x6f, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7d, 0x7a,
+  0x89, 0x8e, 0x87, 0x80, 0x95, 0x92, 0x9b, 0x9c, 0xb1, 0xb6, 0xbf, 0xb8, 0xad, 0xaa, 0xa3, 0xa4,
+  0xf9, 0xfe, 0xf7, 0xf0, 0xe5, 0xe2, 0xeb, 0xec, 0xc1, 0xc6, 0xcf, 0xc8, 0xdd, 0xda, 0xd3, 0xd4,
+  0x69, 0x6e, 0x67, 0x60, 0x75, 0x72, 0x7b, 0x7c, 0x51, 0x56, 0x5f, 0x58, 0x4d, 0x4a, 0x43, 0x44,
+  0x19, 0x1e, 0x17, 0x10, 0x05, 0x02, 0x0b, 0x0c, 0x21, 0x26, 0x2f, 0x28, 0x3d, 0x3a, 0x33, 0x34,
+  0x4e, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5c, 0x5b, 0x76, 0x71, 0x78, 0x7f, 0x6a, 0x6d, 0x64, 0x63,
+  0x3e, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2c, 0x2b, 0x06, 0x01, 0x08, 0x0f, 0x1a, 0x1d, 0x14, 0x13,
+  0xae, 0xa9, 0xa0, 0xa7, 0xb2, 0xb5, 0xbc, 0xbb, 0x96, 0x91, 0x98, 0x9f, 0x8a, 0x8d, 0x84, 0x83,
+  0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef, 0xfa, 0xfd, 0xf4, 0xf3,
+};
+
+/**
+  Calculate the SMBus packet error code (PEC), a CRC-8 with the polynomial x^8 + x^2 + x + 1.
+
+  @param  Pec                          The PEC of the previous bytes, or 0 for the first bytes.
+  @param  Size                         Size in bytes of the data.
+  @param  Data                         A pointer to the data.
+
+  @return the PEC of the previous bytes and the data.
+**/
+UINT8
+EFIAPI
+SpdmTransportMctpSmbusCalculatePec (
+  IN     UINT8                Pec,
+  IN     UINTN                Size,
+  IN     VOID                 *Data
+  )
+{
+  UINT8                       *Byte;
+  UINTN                       Index;
+
+  Byte = Data;
+  for (Index = 0; Index < Size; Index++) {
+    Pec = mMctpSmbusPecTable[Pec ^ Byte[Index]];
+  }
+  return Pec;
+}
+
+/**
+  Build consecutive MCTP SMBus/I2C packets of an MCTP message, back to back in a buffer.
+
+  Each packet is an MCTP_SMBUS_HEADER, from the destination slave address, followed by the MCTP packet
+  built in place by SpdmTransportMctpGetPacket and by the PEC. The last packet carries only the rest of
+  the message and is not padded to the transmission unit. The size of each packet is its ByteCount
+  plus the bytes up to ByteCount and the PEC, so that a driver issues one SMBus block write per packet.
+  A driver whose controller sends the slave address itself skips the first byte of each packet.
+
+  @param  DestinationSlaveAddress      The 7-bit destination slave address.
+  @param  SourceSlaveAddress           The 7-bit source slave address.
+  @param  DestinationId                The destination EID.
+  @param  SourceId                     The source EID.
+  @param  MessageTag                   The message tag, with MCTP_TAG_OWNER if the tag is owned by the source.
+  @param  TransmissionUnit             Size in bytes of the payload of each packet after the MCTP header,
+                                       from MCTP_BASELINE_TRANSMISSION_UNIT to 250.
+  @param  MessageSize                  Size in bytes of the MCTP message, from the MCTP message header.
+  @param  Message                      A pointer to the MCTP message.
+  @param  PacketIndex                  On input, the index of the first packet to build.
+                                       On output, the index of the next packet to build.
+  @param  BufferSize                   On input, the size in bytes of the buffer.
+                                       On output, the size in bytes of the packets built.
+  @param  Buffer                       A pointer to the buffer.
+
+  @retval RETURN_SUCCESS               At least one packet is built, and as many as fit in the buffer.
+  @retval RETURN_INVALID_PARAMETER     The TransmissionUnit or the PacketIndex is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The buffer is too small to hold the first packet.
+                                       BufferSize returns the size of that packet.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpSmbusGetPackets (
+  IN     UINT8                DestinationSlaveAddress,
+  IN     UINT8                SourceSlaveAddress,
+  IN     UINT8                DestinationId,
+  IN     UINT8                SourceId,
+  IN     UINT8                MessageTag,
+  IN     UINTN                TransmissionUnit,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *PacketIndex,
+  IN OUT UINTN                *BufferSize,
+     OUT VOID                 *Buffer
+  )
+{
+  MCTP_SMBUS_HEADER           *SmbusHeader;
+  RETURN_STATUS               Status;
+  UINTN                       PacketCount;
+  UINTN                       Offset;
+  UINTN                       Room;
+  UINTN                       MctpPacketSize;
+  UINTN                       PacketSize;
+
+  if (TransmissionUnit > MCTP_SMBUS_MAX_TRANSMISSION_UNIT) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  PacketCount = SpdmTransportMctpGetPacketCount (MessageSize, TransmissionUnit);
+  if (*PacketIndex >= PacketCount) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Offset = 0;
+  while (*PacketIndex < PacketCount) {
+    SmbusHeader = (MCTP_SMBUS_HEADER *)((UINT8 *)Buffer + Offset);
+    Room = *BufferSize - Offset;
+    if (Room > sizeof(MCTP_SMBUS_HEADER) + MCTP_SMBUS_PEC_SIZE) {
+      MctpPacketSize = Room - sizeof(MCTP_SMBUS_HEADER) - MCTP_SMBUS_PEC_SIZE;
+    } else {
+      MctpPacketSize = 0;
+    }
+    Status = SpdmTransportMctpGetPacket (
+               DestinationId,
+               SourceId,
+               MessageTag,
+               TransmissionUnit,
+               MessageSize,
+               Message,
+               *PacketIndex,
+               &MctpPacketSize,
+               SmbusHeader + 1
+               );
+    if (Status == RETURN_BUFFER_TOO_SMALL) {
+      if (Offset == 0) {
+        *BufferSize = sizeof(MCTP_SMBUS_HEADER) + MctpPacketSize + MCTP_SMBUS_PEC_SIZE;
+        return RETURN_BUFFER_TOO_SMALL;
+      }
+      break;
+    }
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+
+    SmbusHeader->DestinationSlaveAddress = (UINT8)(DestinationSlaveAddress << 1);
+    SmbusHeader->CommandCode = MCTP_SMBUS_COMMAND_CODE;
+    SmbusHeader->ByteCount = (UINT8)(sizeof(SmbusHeader->SourceSlaveAddress) + MctpPacketSize);
+    SmbusHeader->SourceSlaveAddress = (UINT8)((SourceSlaveAddress << 1) | 1);
+    PacketSize = sizeof(MCTP_SMBUS_HEADER) + MctpPacketSize;
+    *((UINT8 *)SmbusHeader + PacketSize) = SpdmTransportMctpSmbusCalculatePec (0, PacketSize, SmbusHeader);
+
+    Offset += PacketSize + MCTP_SMBUS_PEC_SIZE;
+    *PacketIndex += 1;
+  }
+
+  *BufferSize = Offset;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Check an MCTP SMBus/I2C packet received, and return the MCTP packet in it.
+
+  The MCTP packet is not copied, so that it is pushed by SpdmTransportMctpReassemblyPushPacket from the SMBus packet.
+
+  @param  PacketSize                   Size in bytes of the SMBus packet, from the destination slave address to the PEC.
+  @param  Packet                       A pointer to the SMBus packet.
+  @param  SourceSlaveAddress           The 7-bit source slave address.
+  @param  MctpPacketSize               Size in bytes of the MCTP packet.
+  @param  MctpPacket                   A pointer to the MCTP packet, in the SMBus packet.
+
+  @retval RETURN_SUCCESS               The SMBus packet is valid.
+  @retval RETURN_UNSUPPORTED           The SMBus packet is not an MCTP packet, or its ByteCount is invalid.
+  @retval RETURN_CRC_ERROR             The PEC of the SMBus packet is invalid.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportMctpSmbusDecodePacket (
+  IN     UINTN                PacketSize,
+  IN     VOID                 *Packet,
+     OUT UINT8                *SourceSlaveAddress,
+     OUT UINTN                *MctpPacketSize,
+     OUT VOID                 **MctpPacket
+  )
+{
+  MCTP_SMBUS_HEADER           *SmbusHeader;
+
+  SmbusHeader = Packet;
+  if ((PacketSize <= sizeof(MCTP_SMBUS_HEADER) + sizeof(MCTP_HEADER) + MCTP_SMBUS_PEC_SIZE) ||
+      (SmbusHeader->CommandCode != MCTP_SMBUS_COMMAND_CODE) ||
+      (OFFSET_OF(MCTP_SMBUS_HEADER, SourceSlaveAddress) + SmbusHeader->ByteCount + MCTP_SMBUS_PEC_SIZE != PacketSize)) {
+    return RETURN_UNSUPPORTED;
+  }
+  if (SpdmTransportMctpSmbusCalculatePec (0, PacketSize - MCTP_SMBUS_PEC_SIZE, Packet) != *((UINT8 *)Packet + PacketSize - MCTP_SMBUS_PEC_SIZE)) {
+    return RETURN_CRC_ERROR;
+  }
+
+  *SourceSlaveAddress = SmbusHeader->SourceSlaveAddress >> 1;
+  *MctpPacketSize = PacketSize - sizeof(MCTP_SMBUS_HEADER) - MCTP_SMBUS_PEC_SIZE;
+  *MctpPacket = SmbusHeader + 1;
+  return RETURN_SUCCESS;
+}
@@ -10,6 +10,18 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/SpdmTransportPciDoeLib.h>
 #include <Library/SpdmSecuredMessageLib.h>
 
+/**
+  Return the room that the PCI DOE wrapper needs around a message.
+
+  @param  Headroom                     Size in bytes of the PCI DOE header before the message.
+  @param  Tailroom                     Max size in bytes of the PCI DOE padding after the message.
+**/
+VOID
+PciDoeGetMessageRoom (
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  );
+
 /**
   Encode a normal message or secured message to a transport message.
 
@@ -113,6 +125,9 @@ RETURN_STATUS
   The APP message format is defined by the transport layer.
   Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
 
+  A secured message is encoded in place at the headroom returned by SpdmTransportPciDoeGetMessageRoom
+  in TransportMessage. If Message is elsewhere, it is copied to the headroom first.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
                                        If SessionId is NULL, it is a normal message.
@@ -142,10 +157,14 @@ SpdmTransportPciDoeEncodeMessage (
 {
   RETURN_STATUS                       Status;
   TRANSPORT_ENCODE_MESSAGE_FUNC       TransportEncodeMessage;
-  UINT8                               SecuredMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  VOID                                *SecuredMessage;
   UINTN                               SecuredMessageSize;
   SPDM_SECURED_MESSAGE_CALLBACKS      SpdmSecuredMessageCallbacks;
   VOID                                *SecuredMessageContext;
+  UINTN                               Headroom;
+  UINTN                               Tailroom;
+  UINTN                               TransportHeadroom;
+  UINTN                               TransportTailroom;
 
   SpdmSecuredMessageCallbacks.Version = SPDM_SECURED_MESSAGE_CALLBACKS_VERSION;
   SpdmSecuredMessageCallbacks.GetSequenceNumber = PciDoeGetSequenceNumber;
@@ -163,8 +182,27 @@ SpdmTransportPciDoeEncodeMessage (
       return RETURN_UNSUPPORTED;
     }
 
+    //
+    // The message is wrapped in place at the headroom of the transport message,
+    // each layer writing its header and trailer around the previous one.
+    // A message elsewhere is copied to the headroom first, so that it is the only copy.
+    //
+    Status = SpdmTransportPciDoeGetMessageRoom (SpdmContext, SessionId, IsAppMessage, &Headroom, &Tailroom);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    if (*TransportMessageSize < Headroom + MessageSize) {
+      return RETURN_BUFFER_TOO_SMALL;
+    }
+    if ((UINT8 *)Message != (UINT8 *)TransportMessage + Headroom) {
+      CopyMem ((UINT8 *)TransportMessage + Headroom, Message, MessageSize);
+      Message = (UINT8 *)TransportMessage + Headroom;
+    }
+    PciDoeGetMessageRoom (&TransportHeadroom, &TransportTailroom);
+    SecuredMessage = (UINT8 *)TransportMessage + TransportHeadroom;
+    SecuredMessageSize = *TransportMessageSize - TransportHeadroom;
+
     // message to secured message
-    SecuredMessageSize = sizeof(SecuredMessage);
     Status = SpdmEncodeSecuredMessage (
                SecuredMessageContext,
                *SessionId,
@@ -221,6 +259,10 @@ SpdmTransportPciDoeEncodeMessage (
   The APP message format is defined by the transport layer.
   Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
 
+  A secured message is decoded directly in Message. If Message overlaps TransportMessage,
+  it is decoded in place at the headroom returned by SpdmTransportPciDoeGetMessageRoom
+  and TransportMessage is overwritten.
+
   @param  SpdmContext                  A pointer to the SPDM context.
   @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
                                        If *SessionId is NULL, it is a normal message.
@@ -252,11 +294,17 @@ SpdmTransportPciDoeDecodeMessage (
   RETURN_STATUS                       Status;
   TRANSPORT_DECODE_MESSAGE_FUNC       TransportDecodeMessage;
   UINT32                              *SecuredMessageSessionId;
-  UINT8                               SecuredMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  VOID                                *SecuredMessage;
   UINTN                               SecuredMessageSize;
+  VOID                                *DecodedMessage;
+  UINTN                               DecodedMessageSize;
   SPDM_SECURED_MESSAGE_CALLBACKS      SpdmSecuredMessageCallbacks;
   VOID                                *SecuredMessageContext;
   SPDM_ERROR_STRUCT                   SpdmError;
+  UINTN                               Headroom;
+  UINTN                               Tailroom;
+  UINTN                               TransportHeadroom;
+  UINTN                               TransportTailroom;
 
   SpdmError.ErrorCode = 0;
   SpdmError.SessionId = 0;
@@ -272,10 +320,15 @@ SpdmTransportPciDoeDecodeMessage (
   *IsAppMessage = FALSE;
 
   TransportDecodeMessage = PciDoeDecodeMessage;
+  PciDoeGetMessageRoom (&TransportHeadroom, &TransportTailroom);
+  if (TransportMessageSize <= TransportHeadroom) {
+    return RETURN_UNSUPPORTED;
+  }
 
   SecuredMessageSessionId = NULL;
-  // Detect received message
-  SecuredMessageSize = sizeof(SecuredMessage);
+  // Detect received message, leaving the secured message in the transport message
+  SecuredMessage = (UINT8 *)TransportMessage + TransportHeadroom;
+  SecuredMessageSize = TransportMessageSize - TransportHeadroom;
   Status = TransportDecodeMessage (
               &SecuredMessageSessionId,
               TransportMessageSize,
@@ -299,15 +352,30 @@ SpdmTransportPciDoeDecodeMessage (
       return RETURN_UNSUPPORTED;
     }
 
-    // Secured message to message
+    //
+    // Secured message to message, in place at the headroom of the transport message
+    // if Message overlaps the transport message, or else directly in Message.
+    //
+    Status = SpdmTransportPciDoeGetMessageRoom (SpdmContext, SecuredMessageSessionId, FALSE, &Headroom, &Tailroom);
+    if (RETURN_ERROR(Status) || (TransportMessageSize < Headroom)) {
+      return RETURN_UNSUPPORTED;
+    }
+    if (((UINT8 *)Message < (UINT8 *)TransportMessage + TransportMessageSize) &&
+        ((UINT8 *)Message + *MessageSize > (UINT8 *)TransportMessage)) {
+      DecodedMessage = (UINT8 *)TransportMessage + Headroom;
+      DecodedMessageSize = TransportMessageSize - Headroom;
+    } else {
+      DecodedMessage = Message;
+      DecodedMessageSize = *MessageSize;
+    }
     Status = SpdmDecodeSecuredMessage (
                SecuredMessageContext,
                *SecuredMessageSessionId,
                IsRequester,
                SecuredMessageSize,
                SecuredMessage,
-               MessageSize,
-               Message,
+               &DecodedMessageSize,
+               DecodedMessage,
                &SpdmSecuredMessageCallbacks
                );
     if (RETURN_ERROR(Status)) {
@@ -316,6 +384,12 @@ SpdmTransportPciDoeDecodeMessage (
       SpdmSetLastSpdmErrorStruct (SpdmContext, &SpdmError);
       return RETURN_UNSUPPORTED;
     }
+    if (*MessageSize < DecodedMessageSize) {
+      *MessageSize = DecodedMessageSize;
+      return RETURN_BUFFER_TOO_SMALL;
+    }
+    *MessageSize = DecodedMessageSize;
+    CopyMem (Message, DecodedMessage, DecodedMessageSize);
     return RETURN_SUCCESS;
   } else {
     // get non-secured message
@@ -335,3 +409,63 @@ SpdmTransportPciDoeDecodeMessage (
     return RETURN_SUCCESS;
   }
 }
+
+/**
+  Return the room that a transport layer message needs around an SPDM or APP message.
+
+  An SPDM or APP message at Headroom bytes into a buffer, followed by at least Tailroom spare bytes,
+  is encoded in place by SpdmTransportPciDoeEncodeMessage with that buffer as the transport message.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  Headroom                     Size in bytes of the transport message data before the message.
+  @param  Tailroom                     Max size in bytes of the transport message data after the message.
+
+  @retval RETURN_SUCCESS               The room is returned successfully.
+  @retval RETURN_UNSUPPORTED           The message is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeGetMessageRoom (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  )
+{
+  SPDM_SECURED_MESSAGE_CALLBACKS      SpdmSecuredMessageCallbacks;
+  VOID                                *SecuredMessageContext;
+  UINTN                               TransportHeadroom;
+  UINTN                               TransportTailroom;
+  UINTN                               SecuredMessageHeadroom;
+  UINTN                               SecuredMessageTailroom;
+
+  SpdmSecuredMessageCallbacks.Version = SPDM_SECURED_MESSAGE_CALLBACKS_VERSION;
+  SpdmSecuredMessageCallbacks.GetSequenceNumber = PciDoeGetSequenceNumber;
+  SpdmSecuredMessageCallbacks.GetMaxRandomNumberCount = PciDoeGetMaxRandomNumberCount;
+
+  if (IsAppMessage) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  PciDoeGetMessageRoom (&TransportHeadroom, &TransportTailroom);
+  *Headroom = TransportHeadroom;
+  *Tailroom = TransportTailroom;
+  if (SessionId == NULL) {
+    return RETURN_SUCCESS;
+  }
+
+  SecuredMessageContext = SpdmGetSecuredMessageContextViaSessionId (SpdmContext, *SessionId);
+  if (SecuredMessageContext == NULL) {
+    return RETURN_UNSUPPORTED;
+  }
+  SpdmSecuredMessageGetMessageRoom (SecuredMessageContext, &SpdmSecuredMessageCallbacks, &SecuredMessageHeadroom, &SecuredMessageTailroom);
+  *Headroom += SecuredMessageHeadroom;
+  *Tailroom += SecuredMessageTailroom;
+
+  return RETURN_SUCCESS;
+}
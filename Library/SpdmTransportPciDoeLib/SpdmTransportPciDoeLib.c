@@ -55,6 +55,22 @@ PciDoeGetMaxRandomNumberCount (
   return PCI_DOE_MAX_RANDOM_NUMBER_COUNT;
 }
 
+/**
+  Return the room that the PCI DOE wrapper needs around a message.
+
+  @param  Headroom                     Size in bytes of the PCI DOE header before the message.
+  @param  Tailroom                     Max size in bytes of the PCI DOE padding after the message.
+**/
+VOID
+PciDoeGetMessageRoom (
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  )
+{
+  *Headroom = sizeof(PCI_DOE_DATA_OBJECT_HEADER);
+  *Tailroom = PCI_DOE_ALIGNMENT - 1;
+}
+
 /**
   Encode a normal message or secured message to a transport message.
 
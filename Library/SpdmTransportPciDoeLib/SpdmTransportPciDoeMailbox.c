@@ -0,0 +1,902 @@
+/** @file
+  SPDM transport library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/SpdmTransportPciDoeLib.h>
+#include <IndustryStandard/PciDoeBinding.h>
+
+typedef struct {
+  PCI_DOE_MAILBOX_ACCESSOR  Accessor;
+  UINT32                    CapabilityOffset;
+  UINTN                     MaxPollCount;
+  UINTN                     MaxRetryCount;
+  UINTN                     ProtocolCount;
+  PCI_DOE_DISCOVERY_RESPONSE Protocol[MAX_PCI_DOE_PROTOCOL_COUNT];
+} PCI_DOE_MAILBOX;
+
+typedef struct {
+  PCI_DOE_MAILBOX           *Mailbox;
+  UINTN                     BindingCount;
+} PCI_DOE_DISPATCHER_MAILBOX;
+
+//
+// The mailboxes follow the dispatcher header.
+//
+typedef struct {
+  UINTN                     MaxMailboxCount;
+  UINTN                     MailboxCount;
+} PCI_DOE_DISPATCHER;
+
+typedef struct {
+  PCI_DOE_DISPATCHER        *Dispatcher;
+  PCI_DOE_MAILBOX           *ControlMailbox;
+  PCI_DOE_MAILBOX           *SecuredMailbox;
+  PCI_DOE_MAILBOX           *PendingMailbox;
+} PCI_DOE_BINDING;
+
+/**
+  Return the size in bytes of a DOE mailbox.
+
+  @return the size in bytes of the DOE mailbox.
+**/
+UINTN
+EFIAPI
+SpdmTransportPciDoeMailboxGetSize (
+  VOID
+  )
+{
+  return sizeof(PCI_DOE_MAILBOX);
+}
+
+/**
+  Initialize a DOE mailbox.
+
+  The DOE mailbox is registered to an SPDM context by SpdmRegisterDeviceIoContext, so that
+  SpdmTransportPciDoeMailboxSendMessage and SpdmTransportPciDoeMailboxReceiveMessage
+  are registered by SpdmRegisterDeviceIoFunc as the device input/output functions.
+  They may also be the functions of a path registered by SpdmRegisterTransportPath,
+  with the DOE mailbox as its DeviceIoContext.
+
+  @param  Mailbox                      A pointer to the DOE mailbox.
+  @param  Accessor                     A pointer to the configuration space accessor of the DOE function.
+  @param  CapabilityOffset             The offset of the DOE Extended Capability in the configuration space.
+  @param  MaxPollCount                 The number of reads of the DOE Status register before a timeout,
+                                       if the DOE interrupt is not used. 0 means to poll indefinitely.
+  @param  MaxRetryCount                The number of times a data object is written again after the DOE is aborted.
+**/
+VOID
+EFIAPI
+SpdmTransportPciDoeMailboxInit (
+     OUT VOID                      *Mailbox,
+  IN     PCI_DOE_MAILBOX_ACCESSOR  *Accessor,
+  IN     UINT32                    CapabilityOffset,
+  IN     UINTN                     MaxPollCount,
+  IN     UINTN                     MaxRetryCount
+  )
+{
+  PCI_DOE_MAILBOX           *DoeMailbox;
+
+  DoeMailbox = Mailbox;
+  ZeroMem (DoeMailbox, sizeof(PCI_DOE_MAILBOX));
+  CopyMem (&DoeMailbox->Accessor, Accessor, sizeof(PCI_DOE_MAILBOX_ACCESSOR));
+  DoeMailbox->CapabilityOffset = CapabilityOffset;
+  DoeMailbox->MaxPollCount = MaxPollCount;
+  DoeMailbox->MaxRetryCount = MaxRetryCount;
+}
+
+/**
+  Read a register of the DOE Extended Capability.
+
+  @param  DoeMailbox                   A pointer to the DOE mailbox.
+  @param  Offset                       The offset of the register in the DOE Extended Capability.
+  @param  Value                        The value read.
+
+  @return the status returned by the configuration space accessor.
+**/
+RETURN_STATUS
+PciDoeMailboxRead (
+  IN     PCI_DOE_MAILBOX      *DoeMailbox,
+  IN     UINT32               Offset,
+     OUT UINT32               *Value
+  )
+{
+  return DoeMailbox->Accessor.ConfigRead (DoeMailbox->Accessor.AccessContext, DoeMailbox->CapabilityOffset + Offset, Value);
+}
+
+/**
+  Write a register of the DOE Extended Capability.
+
+  @param  DoeMailbox                   A pointer to the DOE mailbox.
+  @param  Offset                       The offset of the register in the DOE Extended Capability.
+  @param  Value                        The value to write.
+
+  @return the status returned by the configuration space accessor.
+**/
+RETURN_STATUS
+PciDoeMailboxWrite (
+  IN     PCI_DOE_MAILBOX      *DoeMailbox,
+  IN     UINT32               Offset,
+  IN     UINT32               Value
+  )
+{
+  return DoeMailbox->Accessor.ConfigWrite (DoeMailbox->Accessor.AccessContext, DoeMailbox->CapabilityOffset + Offset, Value);
+}
+
+/**
+  Abort the data object exchange of a DOE, and wait for the DOE to be idle.
+
+  @param  DoeMailbox                   A pointer to the DOE mailbox.
+
+  @retval RETURN_SUCCESS               The DOE is aborted.
+  @retval RETURN_DEVICE_ERROR          The DOE stays busy or in error.
+**/
+RETURN_STATUS
+PciDoeMailboxAbort (
+  IN     PCI_DOE_MAILBOX      *DoeMailbox
+  )
+{
+  RETURN_STATUS             Status;
+  UINT32                    DoeStatus;
+  UINTN                     PollCount;
+
+  Status = PciDoeMailboxWrite (DoeMailbox, PCI_DOE_CONTROL_OFFSET, PCI_DOE_CONTROL_DOE_ABORT);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  for (PollCount = 0; (DoeMailbox->MaxPollCount == 0) || (PollCount < DoeMailbox->MaxPollCount); PollCount++) {
+    Status = PciDoeMailboxRead (DoeMailbox, PCI_DOE_STATUS_OFFSET, &DoeStatus);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    if ((DoeStatus & (PCI_DOE_STATUS_DOE_BUSY | PCI_DOE_STATUS_DOE_ERROR)) == 0) {
+      return RETURN_SUCCESS;
+    }
+  }
+  return RETURN_DEVICE_ERROR;
+}
+
+/**
+  Wait for the DOE Status register of a DOE to match a value.
+
+  The DOE interrupt is waited for between the reads of the DOE Status register, if the accessor supports it.
+
+  @param  DoeMailbox                   A pointer to the DOE mailbox.
+  @param  Mask                         The bits of the DOE Status register to check.
+  @param  Value                        The value of the bits to wait for.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The DOE Status register matches the value.
+  @retval RETURN_DEVICE_ERROR          The DOE reports an error.
+  @retval RETURN_TIMEOUT               The DOE Status register does not match the value within Timeout.
+**/
+RETURN_STATUS
+PciDoeMailboxWaitStatus (
+  IN     PCI_DOE_MAILBOX      *DoeMailbox,
+  IN     UINT32               Mask,
+  IN     UINT32               Value,
+  IN     UINT64               Timeout
+  )
+{
+  RETURN_STATUS             Status;
+  UINT32                    DoeStatus;
+  UINTN                     PollCount;
+
+  for (PollCount = 0; ; PollCount++) {
+    Status = PciDoeMailboxRead (DoeMailbox, PCI_DOE_STATUS_OFFSET, &DoeStatus);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    if ((DoeStatus & PCI_DOE_STATUS_DOE_ERROR) != 0) {
+      return RETURN_DEVICE_ERROR;
+    }
+    if ((DoeStatus & Mask) == Value) {
+      return RETURN_SUCCESS;
+    }
+    if (DoeMailbox->Accessor.WaitInterrupt != NULL) {
+      Status = DoeMailbox->Accessor.WaitInterrupt (DoeMailbox->Accessor.AccessContext, Timeout);
+      if (RETURN_ERROR(Status)) {
+        return Status;
+      }
+      //
+      // DOE Interrupt Status is RW1C.
+      //
+      PciDoeMailboxWrite (DoeMailbox, PCI_DOE_STATUS_OFFSET, PCI_DOE_STATUS_DOE_INTERRUPT_STATUS);
+    } else if ((DoeMailbox->MaxPollCount != 0) && (PollCount >= DoeMailbox->MaxPollCount)) {
+      return RETURN_TIMEOUT;
+    }
+  }
+}
+
+/**
+  Write DWORDs to the DOE Write Data Mailbox, in a burst if the accessor supports it.
+
+  @param  DoeMailbox                   A pointer to the DOE mailbox.
+  @param  Count                        The number of DWORDs to write.
+  @param  Data                         A pointer to the DWORDs to write.
+
+  @return the status returned by the configuration space accessor.
+**/
+RETURN_STATUS
+PciDoeMailboxWriteData (
+  IN     PCI_DOE_MAILBOX      *DoeMailbox,
+  IN     UINTN                Count,
+  IN     UINT8                *Data
+  )
+{
+  RETURN_STATUS             Status;
+  UINT32                    Dword;
+  UINTN                     Index;
+
+  if ((DoeMailbox->Accessor.ConfigWriteBurst != NULL) && (((UINTN)Data & (sizeof(UINT32) - 1)) == 0)) {
+    return DoeMailbox->Accessor.ConfigWriteBurst (
+             DoeMailbox->Accessor.AccessContext,
+             DoeMailbox->CapabilityOffset + PCI_DOE_WRITE_DATA_MAILBOX_OFFSET,
+             Count,
+             (UINT32 *)Data
+             );
+  }
+  for (Index = 0; Index < Count; Index++) {
+    CopyMem (&Dword, Data + Index * sizeof(UINT32), sizeof(UINT32));
+    Status = PciDoeMailboxWrite (DoeMailbox, PCI_DOE_WRITE_DATA_MAILBOX_OFFSET, Dword);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Read DWORDs from the DOE Read Data Mailbox, in a burst if the accessor supports it.
+
+  @param  DoeMailbox                   A pointer to the DOE mailbox.
+  @param  Count                        The number of DWORDs to read.
+  @param  Data                         A pointer to the DWORDs read.
+
+  @return the status returned by the configuration space accessor.
+**/
+RETURN_STATUS
+PciDoeMailboxReadData (
+  IN     PCI_DOE_MAILBOX      *DoeMailbox,
+  IN     UINTN                Count,
+     OUT UINT8                *Data
+  )
+{
+  RETURN_STATUS             Status;
+  UINT32                    Dword;
+  UINTN                     Index;
+
+  if ((DoeMailbox->Accessor.ConfigReadBurst != NULL) && (((UINTN)Data & (sizeof(UINT32) - 1)) == 0)) {
+    return DoeMailbox->Accessor.ConfigReadBurst (
+             DoeMailbox->Accessor.AccessContext,
+             DoeMailbox->CapabilityOffset + PCI_DOE_READ_DATA_MAILBOX_OFFSET,
+             Count,
+             (UINT32 *)Data
+             );
+  }
+  for (Index = 0; Index < Count; Index++) {
+    Status = PciDoeMailboxRead (DoeMailbox, PCI_DOE_READ_DATA_MAILBOX_OFFSET, &Dword);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    CopyMem (Data + Index * sizeof(UINT32), &Dword, sizeof(UINT32));
+    //
+    // Any write to the DOE Read Data Mailbox pops the next DWORD.
+    //
+    Status = PciDoeMailboxWrite (DoeMailbox, PCI_DOE_READ_DATA_MAILBOX_OFFSET, 0);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Send a data object to a DOE mailbox.
+
+  The data object is written to the DOE Write Data Mailbox in a burst, then DOE Go is set once.
+  If the DOE reports an error or stays busy, the DOE is aborted and the data object is written again.
+
+  @param  DoeMailbox                   A pointer to the DOE mailbox.
+  @param  MessageSize                  Size in bytes of the data object, a multiple of 4.
+  @param  Message                      A pointer to the data object.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The data object is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the data object is sent to the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid.
+  @retval RETURN_TIMEOUT               The DOE stays busy.
+**/
+RETURN_STATUS
+PciDoeMailboxSendDataObject (
+  IN     PCI_DOE_MAILBOX      *DoeMailbox,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  RETURN_STATUS             Status;
+  UINT32                    Control;
+  UINTN                     RetryCount;
+
+  if ((Message == NULL) || (MessageSize < sizeof(PCI_DOE_DATA_OBJECT_HEADER)) ||
+      ((MessageSize & (sizeof(UINT32) - 1)) != 0) || (MessageSize > PCI_DOE_MAX_SIZE_IN_BYTE)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Control = PCI_DOE_CONTROL_DOE_GO;
+  if (DoeMailbox->Accessor.WaitInterrupt != NULL) {
+    Control |= PCI_DOE_CONTROL_DOE_INTERRUPT_ENABLE;
+  }
+  for (RetryCount = 0; ; RetryCount++) {
+    Status = PciDoeMailboxWaitStatus (DoeMailbox, PCI_DOE_STATUS_DOE_BUSY, 0, Timeout);
+    if (!RETURN_ERROR(Status)) {
+      Status = PciDoeMailboxWriteData (DoeMailbox, MessageSize / sizeof(UINT32), Message);
+    }
+    if (!RETURN_ERROR(Status)) {
+      //
+      // One write of the DOE Control register rings the doorbell for the whole data object.
+      //
+      Status = PciDoeMailboxWrite (DoeMailbox, PCI_DOE_CONTROL_OFFSET, Control);
+    }
+    if (!RETURN_ERROR(Status)) {
+      return RETURN_SUCCESS;
+    }
+    if (RetryCount >= DoeMailbox->MaxRetryCount) {
+      PciDoeMailboxAbort (DoeMailbox);
+      return Status;
+    }
+    DEBUG((DEBUG_INFO, "PciDoeMailboxSendDataObject - abort and retry (%p)\n", Status));
+    if (RETURN_ERROR(PciDoeMailboxAbort (DoeMailbox))) {
+      return RETURN_DEVICE_ERROR;
+    }
+  }
+}
+
+/**
+  Receive a data object from a DOE mailbox.
+
+  The function waits for Data Object Ready, with the DOE interrupt if the accessor supports it,
+  then reads the data object from the DOE Read Data Mailbox in bursts.
+
+  @param  DoeMailbox                   A pointer to the DOE mailbox.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the data object received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The data object is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the data object is received from the device.
+  @retval RETURN_BUFFER_TOO_SMALL      The data object is larger than the message buffer, and it is aborted.
+  @retval RETURN_TIMEOUT               The data object is not ready within Timeout.
+**/
+RETURN_STATUS
+PciDoeMailboxReceiveDataObject (
+  IN     PCI_DOE_MAILBOX      *DoeMailbox,
+  IN OUT UINTN                *MessageSize,
+  IN OUT VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  RETURN_STATUS               Status;
+  PCI_DOE_DATA_OBJECT_HEADER  DoeHeader;
+  UINTN                       Length;
+
+  if ((Message == NULL) || (MessageSize == NULL) || (*MessageSize < sizeof(PCI_DOE_DATA_OBJECT_HEADER))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Status = PciDoeMailboxWaitStatus (DoeMailbox, PCI_DOE_STATUS_DATA_OBJECT_READY, PCI_DOE_STATUS_DATA_OBJECT_READY, Timeout);
+  if (RETURN_ERROR(Status)) {
+    if (Status == RETURN_DEVICE_ERROR) {
+      PciDoeMailboxAbort (DoeMailbox);
+    }
+    return Status;
+  }
+
+  Status = PciDoeMailboxReadData (DoeMailbox, sizeof(DoeHeader) / sizeof(UINT32), (UINT8 *)&DoeHeader);
+  if (RETURN_ERROR(Status)) {
+    PciDoeMailboxAbort (DoeMailbox);
+    return Status;
+  }
+  if ((DoeHeader.Length & (PCI_DOE_MAX_SIZE_IN_DW - 1)) == 0) {
+    Length = PCI_DOE_MAX_SIZE_IN_BYTE;
+  } else {
+    Length = (DoeHeader.Length & (PCI_DOE_MAX_SIZE_IN_DW - 1)) * sizeof(UINT32);
+  }
+  if (Length < sizeof(DoeHeader)) {
+    PciDoeMailboxAbort (DoeMailbox);
+    return RETURN_DEVICE_ERROR;
+  }
+  if (Length > *MessageSize) {
+    PciDoeMailboxAbort (DoeMailbox);
+    *MessageSize = Length;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  CopyMem (Message, &DoeHeader, sizeof(DoeHeader));
+  Status = PciDoeMailboxReadData (DoeMailbox, (Length - sizeof(DoeHeader)) / sizeof(UINT32), (UINT8 *)Message + sizeof(DoeHeader));
+  if (RETURN_ERROR(Status)) {
+    PciDoeMailboxAbort (DoeMailbox);
+    return Status;
+  }
+  *MessageSize = Length;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Send an SPDM transport layer message to the DOE mailbox registered to an SPDM context.
+
+  The data object is written to the DOE Write Data Mailbox in a burst, then DOE Go is set once.
+  If the DOE reports an error or stays busy, the DOE is aborted and the data object is written again.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the message data buffer, a multiple of 4.
+  @param  Message                      A pointer to the message, a PCI DOE data object.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is sent to the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid.
+  @retval RETURN_TIMEOUT               The DOE stays busy.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeMailboxSendMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  PCI_DOE_MAILBOX           *DoeMailbox;
+
+  DoeMailbox = SpdmGetTransportPathDeviceIoContext (SpdmContext, TRUE);
+  if (DoeMailbox == NULL) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return PciDoeMailboxSendDataObject (DoeMailbox, MessageSize, Message, Timeout);
+}
+
+/**
+  Receive an SPDM transport layer message from the DOE mailbox registered to an SPDM context.
+
+  The function waits for Data Object Ready, with the DOE interrupt if the accessor supports it,
+  then reads the data object from the DOE Read Data Mailbox in bursts.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the message received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is received from the device.
+  @retval RETURN_BUFFER_TOO_SMALL      The data object is larger than the message buffer, and it is aborted.
+  @retval RETURN_TIMEOUT               The data object is not ready within Timeout.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeMailboxReceiveMessage (
+  IN     VOID                 *SpdmContext,
+  IN OUT UINTN                *MessageSize,
+  IN OUT VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  PCI_DOE_MAILBOX           *DoeMailbox;
+
+  DoeMailbox = SpdmGetTransportPathDeviceIoContext (SpdmContext, FALSE);
+  if (DoeMailbox == NULL) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return PciDoeMailboxReceiveDataObject (DoeMailbox, MessageSize, Message, Timeout);
+}
+
+/**
+  Discover the data object protocols supported by a DOE mailbox, with DOE Discovery.
+
+  The protocols are kept in the DOE mailbox, for SpdmTransportPciDoeMailboxIsProtocolSupported.
+
+  @param  Mailbox                      A pointer to the DOE mailbox.
+  @param  Timeout                      The timeout of each data object, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The protocols are discovered.
+  @retval RETURN_DEVICE_ERROR          The DOE Discovery response is invalid.
+  @retval RETURN_OUT_OF_RESOURCES      The DOE mailbox supports more than MAX_PCI_DOE_PROTOCOL_COUNT protocols.
+  @return the status of the data object exchange, if it fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeMailboxDiscover (
+  IN OUT VOID                 *Mailbox,
+  IN     UINT64               Timeout
+  )
+{
+  PCI_DOE_MAILBOX           *DoeMailbox;
+  RETURN_STATUS             Status;
+  struct {
+    PCI_DOE_DATA_OBJECT_HEADER  DoeHeader;
+    PCI_DOE_DISCOVERY_REQUEST   Discovery;
+  } Request;
+  struct {
+    PCI_DOE_DATA_OBJECT_HEADER  DoeHeader;
+    PCI_DOE_DISCOVERY_RESPONSE  Discovery;
+  } Response;
+  UINTN                     ResponseSize;
+
+  DoeMailbox = Mailbox;
+  DoeMailbox->ProtocolCount = 0;
+
+  ZeroMem (&Request, sizeof(Request));
+  Request.DoeHeader.VendorId = PCI_DOE_VENDOR_ID_PCISIG;
+  Request.DoeHeader.DataObjectType = PCI_DOE_DATA_OBJECT_TYPE_DOE_DISCOVERY;
+  Request.DoeHeader.Length = sizeof(Request) / sizeof(UINT32);
+  do {
+    Status = PciDoeMailboxSendDataObject (DoeMailbox, sizeof(Request), &Request, Timeout);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    ResponseSize = sizeof(Response);
+    Status = PciDoeMailboxReceiveDataObject (DoeMailbox, &ResponseSize, &Response, Timeout);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    if ((ResponseSize != sizeof(Response)) ||
+        (Response.DoeHeader.VendorId != PCI_DOE_VENDOR_ID_PCISIG) ||
+        (Response.DoeHeader.DataObjectType != PCI_DOE_DATA_OBJECT_TYPE_DOE_DISCOVERY)) {
+      return RETURN_DEVICE_ERROR;
+    }
+    if (DoeMailbox->ProtocolCount >= MAX_PCI_DOE_PROTOCOL_COUNT) {
+      return RETURN_OUT_OF_RESOURCES;
+    }
+    CopyMem (&DoeMailbox->Protocol[DoeMailbox->ProtocolCount], &Response.Discovery, sizeof(PCI_DOE_DISCOVERY_RESPONSE));
+    DoeMailbox->ProtocolCount++;
+    //
+    // The indexes only go up, so that a device cannot make the discovery loop.
+    //
+    if ((Response.Discovery.NextIndex != 0) && (Response.Discovery.NextIndex <= Request.Discovery.Index)) {
+      return RETURN_DEVICE_ERROR;
+    }
+    Request.Discovery.Index = Response.Discovery.NextIndex;
+  } while (Request.Discovery.Index != 0);
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Check whether a DOE mailbox supports a data object protocol, after SpdmTransportPciDoeMailboxDiscover.
+
+  @param  Mailbox                      A pointer to the DOE mailbox.
+  @param  VendorId                     The vendor ID of the data object protocol.
+  @param  DataObjectType               The data object type of the data object protocol.
+
+  @retval TRUE                         The DOE mailbox supports the data object protocol.
+  @retval FALSE                        The DOE mailbox does not support the data object protocol.
+**/
+BOOLEAN
+EFIAPI
+SpdmTransportPciDoeMailboxIsProtocolSupported (
+  IN     VOID                 *Mailbox,
+  IN     UINT16               VendorId,
+  IN     UINT8                DataObjectType
+  )
+{
+  PCI_DOE_MAILBOX           *DoeMailbox;
+  UINTN                     Index;
+
+  DoeMailbox = Mailbox;
+  for (Index = 0; Index < DoeMailbox->ProtocolCount; Index++) {
+    if ((DoeMailbox->Protocol[Index].VendorId == VendorId) &&
+        (DoeMailbox->Protocol[Index].DataObjectType == DataObjectType)) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Return the size in bytes of a DOE dispatcher.
+
+  @param  MaxMailboxCount              The number of DOE mailboxes of the dispatcher.
+
+  @return the size in bytes of the DOE dispatcher.
+**/
+UINTN
+EFIAPI
+SpdmTransportPciDoeDispatcherGetSize (
+  IN     UINTN                MaxMailboxCount
+  )
+{
+  return sizeof(PCI_DOE_DISPATCHER) + sizeof(PCI_DOE_DISPATCHER_MAILBOX) * MaxMailboxCount;
+}
+
+/**
+  Initialize a DOE dispatcher, which spreads the SPDM contexts of a device over its DOE mailboxes.
+
+  @param  Dispatcher                   A pointer to the DOE dispatcher.
+  @param  MaxMailboxCount              The number of DOE mailboxes of the dispatcher.
+**/
+VOID
+EFIAPI
+SpdmTransportPciDoeDispatcherInit (
+     OUT VOID                 *Dispatcher,
+  IN     UINTN                MaxMailboxCount
+  )
+{
+  PCI_DOE_DISPATCHER        *DoeDispatcher;
+
+  DoeDispatcher = Dispatcher;
+  ZeroMem (DoeDispatcher, SpdmTransportPciDoeDispatcherGetSize (MaxMailboxCount));
+  DoeDispatcher->MaxMailboxCount = MaxMailboxCount;
+}
+
+/**
+  Discover the data object protocols of a DOE mailbox, and add it to a DOE dispatcher
+  if it supports SPDM or secured SPDM data objects.
+
+  @param  Dispatcher                   A pointer to the DOE dispatcher.
+  @param  Mailbox                      A pointer to the DOE mailbox, initialized by SpdmTransportPciDoeMailboxInit.
+  @param  Timeout                      The timeout of each data object, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The DOE mailbox is added.
+  @retval RETURN_UNSUPPORTED           The DOE mailbox supports neither SPDM nor secured SPDM data objects.
+  @retval RETURN_OUT_OF_RESOURCES      MaxMailboxCount DOE mailboxes are added already.
+  @return the status of SpdmTransportPciDoeMailboxDiscover, if it fails.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeDispatcherAddMailbox (
+  IN OUT VOID                 *Dispatcher,
+  IN     VOID                 *Mailbox,
+  IN     UINT64               Timeout
+  )
+{
+  PCI_DOE_DISPATCHER        *DoeDispatcher;
+  PCI_DOE_DISPATCHER_MAILBOX *DispatcherMailbox;
+  RETURN_STATUS             Status;
+
+  DoeDispatcher = Dispatcher;
+  if (DoeDispatcher->MailboxCount >= DoeDispatcher->MaxMailboxCount) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  Status = SpdmTransportPciDoeMailboxDiscover (Mailbox, Timeout);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  if (!SpdmTransportPciDoeMailboxIsProtocolSupported (Mailbox, PCI_DOE_VENDOR_ID_PCISIG, PCI_DOE_DATA_OBJECT_TYPE_SPDM) &&
+      !SpdmTransportPciDoeMailboxIsProtocolSupported (Mailbox, PCI_DOE_VENDOR_ID_PCISIG, PCI_DOE_DATA_OBJECT_TYPE_SECURED_SPDM)) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  DispatcherMailbox = (PCI_DOE_DISPATCHER_MAILBOX *)(DoeDispatcher + 1) + DoeDispatcher->MailboxCount;
+  DispatcherMailbox->Mailbox = Mailbox;
+  DispatcherMailbox->BindingCount = 0;
+  DoeDispatcher->MailboxCount++;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Select the DOE mailbox of a DOE dispatcher supporting a data object type with the fewest bindings.
+
+  @param  DoeDispatcher                A pointer to the DOE dispatcher.
+  @param  DataObjectType               The PCI-SIG data object type.
+  @param  Exclude                      A DOE mailbox selected only if no other one supports the type, or NULL.
+
+  @return the DOE dispatcher mailbox, or NULL if no DOE mailbox supports the type.
+**/
+PCI_DOE_DISPATCHER_MAILBOX *
+PciDoeDispatcherSelectMailbox (
+  IN     PCI_DOE_DISPATCHER   *DoeDispatcher,
+  IN     UINT8                DataObjectType,
+  IN     PCI_DOE_MAILBOX      *Exclude
+  )
+{
+  PCI_DOE_DISPATCHER_MAILBOX *DispatcherMailbox;
+  PCI_DOE_DISPATCHER_MAILBOX *Selected;
+  UINTN                     Index;
+
+  Selected = NULL;
+  for (Index = 0; Index < DoeDispatcher->MailboxCount; Index++) {
+    DispatcherMailbox = (PCI_DOE_DISPATCHER_MAILBOX *)(DoeDispatcher + 1) + Index;
+    if (!SpdmTransportPciDoeMailboxIsProtocolSupported (DispatcherMailbox->Mailbox, PCI_DOE_VENDOR_ID_PCISIG, DataObjectType)) {
+      continue;
+    }
+    if (Selected != NULL) {
+      if ((DispatcherMailbox->Mailbox == Exclude) && (Selected->Mailbox != Exclude)) {
+        continue;
+      }
+      if (((DispatcherMailbox->Mailbox == Exclude) == (Selected->Mailbox == Exclude)) &&
+          (DispatcherMailbox->BindingCount >= Selected->BindingCount)) {
+        continue;
+      }
+    }
+    Selected = DispatcherMailbox;
+  }
+  return Selected;
+}
+
+/**
+  Return the size in bytes of a DOE binding.
+
+  @return the size in bytes of the DOE binding.
+**/
+UINTN
+EFIAPI
+SpdmTransportPciDoeBindingGetSize (
+  VOID
+  )
+{
+  return sizeof(PCI_DOE_BINDING);
+}
+
+/**
+  Bind an SPDM context to the DOE mailboxes of a DOE dispatcher.
+
+  The SPDM data objects of the binding go to the DOE mailbox supporting them with the fewest bindings.
+  The secured SPDM data objects go to the DOE mailbox supporting them with the fewest bindings,
+  another one than for SPDM data objects if any, so that bulk secured traffic does not wait behind control traffic.
+
+  The DOE binding is registered to the SPDM context by SpdmRegisterDeviceIoContext, so that
+  SpdmTransportPciDoeBindingSendMessage and SpdmTransportPciDoeBindingReceiveMessage
+  are registered by SpdmRegisterDeviceIoFunc as the device input/output functions.
+  SPDM contexts whose bindings share no DOE mailbox can be used concurrently.
+
+  @param  Dispatcher                   A pointer to the DOE dispatcher.
+  @param  Binding                      A pointer to the DOE binding.
+
+  @retval RETURN_SUCCESS               The DOE binding is bound.
+  @retval RETURN_UNSUPPORTED           No DOE mailbox of the dispatcher supports SPDM data objects.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeDispatcherBind (
+  IN OUT VOID                 *Dispatcher,
+     OUT VOID                 *Binding
+  )
+{
+  PCI_DOE_DISPATCHER        *DoeDispatcher;
+  PCI_DOE_BINDING           *DoeBinding;
+  PCI_DOE_DISPATCHER_MAILBOX *ControlMailbox;
+  PCI_DOE_DISPATCHER_MAILBOX *SecuredMailbox;
+
+  DoeDispatcher = Dispatcher;
+  DoeBinding = Binding;
+  ControlMailbox = PciDoeDispatcherSelectMailbox (DoeDispatcher, PCI_DOE_DATA_OBJECT_TYPE_SPDM, NULL);
+  if (ControlMailbox == NULL) {
+    return RETURN_UNSUPPORTED;
+  }
+  SecuredMailbox = PciDoeDispatcherSelectMailbox (DoeDispatcher, PCI_DOE_DATA_OBJECT_TYPE_SECURED_SPDM, ControlMailbox->Mailbox);
+  if (SecuredMailbox == NULL) {
+    SecuredMailbox = ControlMailbox;
+  }
+
+  ZeroMem (DoeBinding, sizeof(PCI_DOE_BINDING));
+  DoeBinding->Dispatcher = DoeDispatcher;
+  DoeBinding->ControlMailbox = ControlMailbox->Mailbox;
+  DoeBinding->SecuredMailbox = SecuredMailbox->Mailbox;
+  ControlMailbox->BindingCount++;
+  if (SecuredMailbox != ControlMailbox) {
+    SecuredMailbox->BindingCount++;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Unbind an SPDM context from the DOE mailboxes of a DOE dispatcher.
+
+  @param  Binding                      A pointer to the DOE binding.
+**/
+VOID
+EFIAPI
+SpdmTransportPciDoeDispatcherUnbind (
+  IN OUT VOID                 *Binding
+  )
+{
+  PCI_DOE_BINDING           *DoeBinding;
+  PCI_DOE_DISPATCHER_MAILBOX *DispatcherMailbox;
+  UINTN                     Index;
+
+  DoeBinding = Binding;
+  if (DoeBinding->Dispatcher == NULL) {
+    return ;
+  }
+  for (Index = 0; Index < DoeBinding->Dispatcher->MailboxCount; Index++) {
+    DispatcherMailbox = (PCI_DOE_DISPATCHER_MAILBOX *)(DoeBinding->Dispatcher + 1) + Index;
+    if ((DispatcherMailbox->Mailbox == DoeBinding->ControlMailbox) ||
+        (DispatcherMailbox->Mailbox == DoeBinding->SecuredMailbox)) {
+      ASSERT (DispatcherMailbox->BindingCount != 0);
+      DispatcherMailbox->BindingCount--;
+    }
+  }
+  ZeroMem (DoeBinding, sizeof(PCI_DOE_BINDING));
+}
+
+/**
+  Send an SPDM transport layer message to the DOE mailbox of its data object type,
+  in the DOE binding registered to an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the message data buffer, a multiple of 4.
+  @param  Message                      A pointer to the message, a PCI DOE data object.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is sent to the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid.
+  @retval RETURN_TIMEOUT               The DOE stays busy.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeBindingSendMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  PCI_DOE_BINDING           *DoeBinding;
+  PCI_DOE_MAILBOX           *DoeMailbox;
+
+  DoeBinding = SpdmGetTransportPathDeviceIoContext (SpdmContext, TRUE);
+  if ((DoeBinding == NULL) || (DoeBinding->Dispatcher == NULL)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  if ((Message == NULL) || (MessageSize < sizeof(PCI_DOE_DATA_OBJECT_HEADER))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if (((PCI_DOE_DATA_OBJECT_HEADER *)Message)->DataObjectType == PCI_DOE_DATA_OBJECT_TYPE_SECURED_SPDM) {
+    DoeMailbox = DoeBinding->SecuredMailbox;
+  } else {
+    DoeMailbox = DoeBinding->ControlMailbox;
+  }
+  //
+  // The response comes on the DOE mailbox of the request.
+  //
+  DoeBinding->PendingMailbox = DoeMailbox;
+  return PciDoeMailboxSendDataObject (DoeMailbox, MessageSize, Message, Timeout);
+}
+
+/**
+  Receive an SPDM transport layer message from the DOE mailbox of the last message sent,
+  in the DOE binding registered to an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the message received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is received from the device.
+  @retval RETURN_BUFFER_TOO_SMALL      The data object is larger than the message buffer, and it is aborted.
+  @retval RETURN_TIMEOUT               The data object is not ready within Timeout.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportPciDoeBindingReceiveMessage (
+  IN     VOID                 *SpdmContext,
+  IN OUT UINTN                *MessageSize,
+  IN OUT VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  PCI_DOE_BINDING           *DoeBinding;
+  PCI_DOE_MAILBOX           *DoeMailbox;
+
+  DoeBinding = SpdmGetTransportPathDeviceIoContext (SpdmContext, FALSE);
+  if ((DoeBinding == NULL) || (DoeBinding->Dispatcher == NULL)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  DoeMailbox = DoeBinding->PendingMailbox;
+  if (DoeMailbox == NULL) {
+    DoeMailbox = DoeBinding->ControlMailbox;
+  }
+  return PciDoeMailboxReceiveDataObject (DoeMailbox, MessageSize, Message, Timeout);
+}
@@ -0,0 +1,471 @@
+/** @file
+  SPDM transport library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/SpdmTransportStorageLib.h>
+#include <Library/SpdmSecuredMessageLib.h>
+
+/**
+  Return the room that the storage wrapper needs around a message.
+
+  @param  Headroom                     Size in bytes of the storage header before the message.
+  @param  Tailroom                     Max size in bytes of the storage padding after the message.
+**/
+VOID
+StorageGetMessageRoom (
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  );
+
+/**
+  Encode a normal message or secured message to a transport message.
+
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a source buffer to store the message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a destination buffer to store the transport message.
+
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+**/
+RETURN_STATUS
+StorageEncodeMessage (
+  IN     UINT32               *SessionId,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  );
+
+/**
+  Decode a transport message to a normal message or secured message.
+
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If *SessionId is NULL, it is a normal message.
+                                       If *SessionId is NOT NULL, it is a secured message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a source buffer to store the transport message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a destination buffer to store the message.
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+**/
+RETURN_STATUS
+StorageDecodeMessage (
+     OUT UINT32               **SessionId,
+  IN     UINTN                TransportMessageSize,
+  IN     VOID                 *TransportMessage,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  );
+
+/**
+  Encode a normal message or secured message to a transport message.
+
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a source buffer to store the message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a destination buffer to store the transport message.
+
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+**/
+typedef
+RETURN_STATUS
+(*TRANSPORT_ENCODE_MESSAGE_FUNC) (
+  IN     UINT32               *SessionId,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  );
+
+/**
+  Decode a transport message to a normal message or secured message.
+
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If *SessionId is NULL, it is a normal message.
+                                       If *SessionId is NOT NULL, it is a secured message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a source buffer to store the transport message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a destination buffer to store the message.
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+**/
+typedef
+RETURN_STATUS
+(*TRANSPORT_DECODE_MESSAGE_FUNC) (
+     OUT UINT32               **SessionId,
+  IN     UINTN                TransportMessageSize,
+  IN     VOID                 *TransportMessage,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  );
+
+/**
+  Encode an SPDM or APP message to a transport layer message.
+
+  For normal SPDM message, it adds the transport layer wrapper.
+  For secured SPDM message, it encrypts a secured message then adds the transport layer wrapper.
+  For secured APP message, it encrypts a secured message then adds the transport layer wrapper.
+
+  The APP message is encoded to a secured message directly in SPDM session.
+  The APP message format is defined by the transport layer.
+  Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
+
+  A secured message is encoded in place at the headroom returned by SpdmTransportStorageGetMessageRoom
+  in TransportMessage. If Message is elsewhere, it is copied to the headroom first.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a source buffer to store the message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a destination buffer to store the transport message.
+
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportStorageEncodeMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  )
+{
+  RETURN_STATUS                       Status;
+  TRANSPORT_ENCODE_MESSAGE_FUNC       TransportEncodeMessage;
+  VOID                                *SecuredMessage;
+  UINTN                               SecuredMessageSize;
+  SPDM_SECURED_MESSAGE_CALLBACKS      SpdmSecuredMessageCallbacks;
+  VOID                                *SecuredMessageContext;
+  UINTN                               Headroom;
+  UINTN                               Tailroom;
+  UINTN                               TransportHeadroom;
+  UINTN                               TransportTailroom;
+
+  SpdmSecuredMessageCallbacks.Version = SPDM_SECURED_MESSAGE_CALLBACKS_VERSION;
+  SpdmSecuredMessageCallbacks.GetSequenceNumber = StorageGetSequenceNumber;
+  SpdmSecuredMessageCallbacks.GetMaxRandomNumberCount = StorageGetMaxRandomNumberCount;
+
+  if (IsAppMessage) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  TransportEncodeMessage = StorageEncodeMessage;
+  if (SessionId != NULL) {
+
+    SecuredMessageContext = SpdmGetSecuredMessageContextViaSessionId (SpdmContext, *SessionId);
+    if (SecuredMessageContext == NULL) {
+      return RETURN_UNSUPPORTED;
+    }
+
+    //
+    // The message is wrapped in place at the headroom of the transport message,
+    // each layer writing its header and trailer around the previous one.
+    // A message elsewhere is copied to the headroom first, so that it is the only copy.
+    //
+    Status = SpdmTransportStorageGetMessageRoom (SpdmContext, SessionId, IsAppMessage, &Headroom, &Tailroom);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    if (*TransportMessageSize < Headroom + MessageSize) {
+      return RETURN_BUFFER_TOO_SMALL;
+    }
+    if ((UINT8 *)Message != (UINT8 *)TransportMessage + Headroom) {
+      CopyMem ((UINT8 *)TransportMessage + Headroom, Message, MessageSize);
+      Message = (UINT8 *)TransportMessage + Headroom;
+    }
+    StorageGetMessageRoom (&TransportHeadroom, &TransportTailroom);
+    SecuredMessage = (UINT8 *)TransportMessage + TransportHeadroom;
+    SecuredMessageSize = *TransportMessageSize - TransportHeadroom;
+
+    // message to secured message
+    Status = SpdmEncodeSecuredMessage (
+               SecuredMessageContext,
+               *SessionId,
+               IsRequester,
+               MessageSize,
+               Message,
+               &SecuredMessageSize,
+               SecuredMessage,
+               &SpdmSecuredMessageCallbacks
+               );
+    if (RETURN_ERROR(Status)) {
+      DEBUG ((DEBUG_ERROR, "SpdmEncodeSecuredMessage - %p\n", Status));
+      return Status;
+    }
+
+    // secured message to secured storage message
+    Status = TransportEncodeMessage (
+                SessionId,
+                SecuredMessageSize,
+                SecuredMessage,
+                TransportMessageSize,
+                TransportMessage
+                );
+    if (RETURN_ERROR(Status)) {
+      DEBUG ((DEBUG_ERROR, "TransportEncodeMessage - %p\n", Status));
+      return RETURN_UNSUPPORTED;
+    }
+  } else {
+    // SPDM message to normal storage message
+    Status = TransportEncodeMessage (
+                NULL,
+                MessageSize,
+                Message,
+                TransportMessageSize,
+                TransportMessage
+                );
+    if (RETURN_ERROR(Status)) {
+      DEBUG ((DEBUG_ERROR, "TransportEncodeMessage - %p\n", Status));
+      return RETURN_UNSUPPORTED;
+    }
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decode an SPDM or APP message from a transport layer message.
+
+  For normal SPDM message, it removes the transport layer wrapper,
+  For secured SPDM message, it removes the transport layer wrapper, then decrypts and verifies a secured message.
+  For secured APP message, it removes the transport layer wrapper, then decrypts and verifies a secured message.
+
+  The APP message is decoded from a secured message directly in SPDM session.
+  The APP message format is defined by the transport layer.
+  Take MCTP as example: APP message == MCTP header (MCTP_MESSAGE_TYPE_SPDM) + SPDM message
+
+  A secured message is decoded directly in Message. If Message overlaps TransportMessage,
+  it is decoded in place at the headroom returned by SpdmTransportStorageGetMessageRoom
+  and TransportMessage is overwritten.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If *SessionId is NULL, it is a normal message.
+                                       If *SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  IsRequester                  Indicates if it is a requester message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a source buffer to store the transport message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a destination buffer to store the message.
+
+  @retval RETURN_SUCCESS               The message is decoded successfully.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is zero.
+  @retval RETURN_UNSUPPORTED           The TransportMessage is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportStorageDecodeMessage (
+  IN     VOID                 *SpdmContext,
+     OUT UINT32               **SessionId,
+     OUT BOOLEAN              *IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                TransportMessageSize,
+  IN     VOID                 *TransportMessage,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  )
+{
+  RETURN_STATUS                       Status;
+  TRANSPORT_DECODE_MESSAGE_FUNC       TransportDecodeMessage;
+  UINT32                              *SecuredMessageSessionId;
+  VOID                                *SecuredMessage;
+  UINTN                               SecuredMessageSize;
+  VOID                                *DecodedMessage;
+  UINTN                               DecodedMessageSize;
+  SPDM_SECURED_MESSAGE_CALLBACKS      SpdmSecuredMessageCallbacks;
+  VOID                                *SecuredMessageContext;
+  SPDM_ERROR_STRUCT                   SpdmError;
+  UINTN                               Headroom;
+  UINTN                               Tailroom;
+  UINTN                               TransportHeadroom;
+  UINTN                               TransportTailroom;
+
+  SpdmError.ErrorCode = 0;
+  SpdmError.SessionId = 0;
+  SpdmSetLastSpdmErrorStruct (SpdmContext, &SpdmError);
+
+  SpdmSecuredMessageCallbacks.Version = SPDM_SECURED_MESSAGE_CALLBACKS_VERSION;
+  SpdmSecuredMessageCallbacks.GetSequenceNumber = StorageGetSequenceNumber;
+  SpdmSecuredMessageCallbacks.GetMaxRandomNumberCount = StorageGetMaxRandomNumberCount;
+
+  if ((SessionId == NULL) || (IsAppMessage == NULL)) {
+    return RETURN_UNSUPPORTED;
+  }
+  *IsAppMessage = FALSE;
+
+  TransportDecodeMessage = StorageDecodeMessage;
+  StorageGetMessageRoom (&TransportHeadroom, &TransportTailroom);
+  if (TransportMessageSize <= TransportHeadroom) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  SecuredMessageSessionId = NULL;
+  // Detect received message, leaving the secured message in the transport message
+  SecuredMessage = (UINT8 *)TransportMessage + TransportHeadroom;
+  SecuredMessageSize = TransportMessageSize - TransportHeadroom;
+  Status = TransportDecodeMessage (
+              &SecuredMessageSessionId,
+              TransportMessageSize,
+              TransportMessage,
+              &SecuredMessageSize,
+              SecuredMessage
+              );
+  if (RETURN_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "TransportDecodeMessage - %p\n", Status));
+    return RETURN_UNSUPPORTED;
+  }
+
+  if (SecuredMessageSessionId != NULL) {
+    *SessionId = SecuredMessageSessionId;
+    
+    SecuredMessageContext = SpdmGetSecuredMessageContextViaSessionId (SpdmContext, *SecuredMessageSessionId);
+    if (SecuredMessageContext == NULL) {
+      SpdmError.ErrorCode = SPDM_ERROR_CODE_INVALID_SESSION;
+      SpdmError.SessionId = *SecuredMessageSessionId;
+      SpdmSetLastSpdmErrorStruct (SpdmContext, &SpdmError);
+      return RETURN_UNSUPPORTED;
+    }
+
+    //
+    // Secured message to message, in place at the headroom of the transport message
+    // if Message overlaps the transport message, or else directly in Message.
+    //
+    Status = SpdmTransportStorageGetMessageRoom (SpdmContext, SecuredMessageSessionId, FALSE, &Headroom, &Tailroom);
+    if (RETURN_ERROR(Status) || (TransportMessageSize < Headroom)) {
+      return RETURN_UNSUPPORTED;
+    }
+    if (((UINT8 *)Message < (UINT8 *)TransportMessage + TransportMessageSize) &&
+        ((UINT8 *)Message + *MessageSize > (UINT8 *)TransportMessage)) {
+      DecodedMessage = (UINT8 *)TransportMessage + Headroom;
+      DecodedMessageSize = TransportMessageSize - Headroom;
+    } else {
+      DecodedMessage = Message;
+      DecodedMessageSize = *MessageSize;
+    }
+    Status = SpdmDecodeSecuredMessage (
+               SecuredMessageContext,
+               *SecuredMessageSessionId,
+               IsRequester,
+               SecuredMessageSize,
+               SecuredMessage,
+               &DecodedMessageSize,
+               DecodedMessage,
+               &SpdmSecuredMessageCallbacks
+               );
+    if (RETURN_ERROR(Status)) {
+      DEBUG ((DEBUG_ERROR, "SpdmDecodeSecuredMessage - %p\n", Status));
+      SpdmSecuredMessageGetLastSpdmErrorStruct (SecuredMessageContext, &SpdmError);
+      SpdmSetLastSpdmErrorStruct (SpdmContext, &SpdmError);
+      return RETURN_UNSUPPORTED;
+    }
+    if (*MessageSize < DecodedMessageSize) {
+      *MessageSize = DecodedMessageSize;
+      return RETURN_BUFFER_TOO_SMALL;
+    }
+    *MessageSize = DecodedMessageSize;
+    CopyMem (Message, DecodedMessage, DecodedMessageSize);
+    return RETURN_SUCCESS;
+  } else {
+    // get non-secured message
+    Status = TransportDecodeMessage (
+                &SecuredMessageSessionId,
+                TransportMessageSize,
+                TransportMessage,
+                MessageSize,
+                Message
+                );
+    if (RETURN_ERROR(Status)) {
+      DEBUG ((DEBUG_ERROR, "TransportDecodeMessage - %p\n", Status));
+      return RETURN_UNSUPPORTED;
+    }
+    ASSERT (SecuredMessageSessionId == NULL);
+    *SessionId = NULL;
+    return RETURN_SUCCESS;
+  }
+}
+
+/**
+  Return the room that a transport layer message needs around an SPDM or APP message.
+
+  An SPDM or APP message at Headroom bytes into a buffer, followed by at least Tailroom spare bytes,
+  is encoded in place by SpdmTransportStorageEncodeMessage with that buffer as the transport message.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  Headroom                     Size in bytes of the transport message data before the message.
+  @param  Tailroom                     Max size in bytes of the transport message data after the message.
+
+  @retval RETURN_SUCCESS               The room is returned successfully.
+  @retval RETURN_UNSUPPORTED           The message is unsupported.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportStorageGetMessageRoom (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  )
+{
+  SPDM_SECURED_MESSAGE_CALLBACKS      SpdmSecuredMessageCallbacks;
+  VOID                                *SecuredMessageContext;
+  UINTN                               TransportHeadroom;
+  UINTN                               TransportTailroom;
+  UINTN                               SecuredMessageHeadroom;
+  UINTN                               SecuredMessageTailroom;
+
+  SpdmSecuredMessageCallbacks.Version = SPDM_SECURED_MESSAGE_CALLBACKS_VERSION;
+  SpdmSecuredMessageCallbacks.GetSequenceNumber = StorageGetSequenceNumber;
+  SpdmSecuredMessageCallbacks.GetMaxRandomNumberCount = StorageGetMaxRandomNumberCount;
+
+  if (IsAppMessage) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  StorageGetMessageRoom (&TransportHeadroom, &TransportTailroom);
+  *Headroom = TransportHeadroom;
+  *Tailroom = TransportTailroom;
+  if (SessionId == NULL) {
+    return RETURN_SUCCESS;
+  }
+
+  SecuredMessageContext = SpdmGetSecuredMessageContextViaSessionId (SpdmContext, *SessionId);
+  if (SecuredMessageContext == NULL) {
+    return RETURN_UNSUPPORTED;
+  }
+  SpdmSecuredMessageGetMessageRoom (SecuredMessageContext, &SpdmSecuredMessageCallbacks, &SecuredMessageHeadroom, &SecuredMessageTailroom);
+  *Headroom += SecuredMessageHeadroom;
+  *Tailroom += SecuredMessageTailroom;
+
+  return RETURN_SUCCESS;
+}
@@ -0,0 +1,238 @@
+/** @file
+  SPDM transport library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/SpdmTransportStorageLib.h>
+#include <IndustryStandard/StorageBinding.h>
+
+typedef struct {
+  STORAGE_SECURITY_ACCESSOR Accessor;
+  UINT32                    MaxTransferLength;
+  UINT16                    SecurityProtocolSpecific;
+  VOID                      *PendingCommand;
+} STORAGE_DEVICE;
+
+/**
+  Return the size in bytes of a storage device.
+
+  @return the size in bytes of the storage device.
+**/
+UINTN
+EFIAPI
+SpdmTransportStorageDeviceGetSize (
+  VOID
+  )
+{
+  return sizeof(STORAGE_DEVICE);
+}
+
+/**
+  Initialize a storage device.
+
+  The storage device is registered to an SPDM context by SpdmRegisterDeviceIoContext, so that
+  SpdmTransportStorageDeviceSendMessage and SpdmTransportStorageDeviceReceiveMessage
+  are registered by SpdmRegisterDeviceIoFunc as the device input/output functions.
+  SpdmDataTransportMaxMessageSize should be set to MaxTransferLength, so that the certificate chain
+  and the measurements are transferred in as few commands as the device allows.
+
+  @param  Device                       A pointer to the storage device.
+  @param  Accessor                     A pointer to the security command accessor of the storage device.
+  @param  MaxTransferLength            The maximum data transfer size of a command, in bytes.
+**/
+VOID
+EFIAPI
+SpdmTransportStorageDeviceInit (
+     OUT VOID                       *Device,
+  IN     STORAGE_SECURITY_ACCESSOR  *Accessor,
+  IN     UINT32                     MaxTransferLength
+  )
+{
+  STORAGE_DEVICE            *StorageDevice;
+
+  StorageDevice = Device;
+  ZeroMem (StorageDevice, sizeof(STORAGE_DEVICE));
+  CopyMem (&StorageDevice->Accessor, Accessor, sizeof(STORAGE_SECURITY_ACCESSOR));
+  StorageDevice->MaxTransferLength = MaxTransferLength;
+  StorageDevice->SecurityProtocolSpecific = STORAGE_SECURITY_PROTOCOL_SPECIFIC_SPDM;
+}
+
+/**
+  Wait for the completion of the command pending on a storage device, if any.
+
+  @param  StorageDevice                A pointer to the storage device.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+  @param  TransferredLength            The number of bytes of data transferred.
+
+  @return the status of the command.
+**/
+RETURN_STATUS
+StorageDeviceWaitPendingCommand (
+  IN OUT STORAGE_DEVICE       *StorageDevice,
+  IN     UINT64               Timeout,
+     OUT UINT32               *TransferredLength
+  )
+{
+  VOID                      *Command;
+
+  *TransferredLength = 0;
+  if (StorageDevice->PendingCommand == NULL) {
+    return RETURN_SUCCESS;
+  }
+  Command = StorageDevice->PendingCommand;
+  StorageDevice->PendingCommand = NULL;
+  return StorageDevice->Accessor.Wait (StorageDevice->Accessor.DeviceContext, Command, Timeout, TransferredLength);
+}
+
+/**
+  Send an SPDM transport layer message to the storage device registered to an SPDM context.
+
+  The Security Send command is submitted with the data following the storage transport header in Message,
+  and the function returns without waiting for its completion, which SpdmTransportStorageDeviceReceiveMessage
+  waits for before it submits the Security Receive command. Message must not be modified until then.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to the message, a storage transport header and its data.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is sent to the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid,
+                                       or the message is larger than the maximum data transfer size.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportStorageDeviceSendMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  STORAGE_DEVICE            *StorageDevice;
+  STORAGE_SECURITY_HEADER   *StorageHeader;
+  RETURN_STATUS             Status;
+  UINT32                    TransferredLength;
+
+  StorageDevice = SpdmGetTransportPathDeviceIoContext (SpdmContext, TRUE);
+  if (StorageDevice == NULL) {
+    return RETURN_DEVICE_ERROR;
+  }
+  if ((Message == NULL) || (MessageSize <= sizeof(STORAGE_SECURITY_HEADER))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  StorageHeader = Message;
+  if ((StorageHeader->Length != MessageSize - sizeof(STORAGE_SECURITY_HEADER)) ||
+      (StorageHeader->Length > StorageDevice->MaxTransferLength)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  //
+  // A Security Send whose response was never received completes first.
+  //
+  Status = StorageDeviceWaitPendingCommand (StorageDevice, Timeout, &TransferredLength);
+  if (RETURN_ERROR(Status)) {
+    DEBUG((DEBUG_INFO, "StorageDeviceWaitPendingCommand - %p\n", Status));
+  }
+
+  Status = StorageDevice->Accessor.Submit (
+             StorageDevice->Accessor.DeviceContext,
+             TRUE,
+             StorageHeader->SecurityProtocol,
+             StorageHeader->SecurityProtocolSpecific,
+             StorageHeader->Length,
+             StorageHeader + 1,
+             &StorageDevice->PendingCommand
+             );
+  if (RETURN_ERROR(Status)) {
+    StorageDevice->PendingCommand = NULL;
+    return RETURN_DEVICE_ERROR;
+  }
+  //
+  // The response is of the same kind as the request, secured or not.
+  //
+  StorageDevice->SecurityProtocolSpecific = StorageHeader->SecurityProtocolSpecific;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Receive an SPDM transport layer message from the storage device registered to an SPDM context.
+
+  The function waits for the completion of the Security Send command of the request, then submits
+  a Security Receive command, with the data received directly after the storage transport header in Message,
+  in one command of up to the maximum data transfer size.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the message received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is received from the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid.
+  @retval RETURN_TIMEOUT               A command does not complete within Timeout.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportStorageDeviceReceiveMessage (
+  IN     VOID                 *SpdmContext,
+  IN OUT UINTN                *MessageSize,
+  IN OUT VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  STORAGE_DEVICE            *StorageDevice;
+  STORAGE_SECURITY_HEADER   *StorageHeader;
+  RETURN_STATUS             Status;
+  UINT32                    AllocationLength;
+  UINT32                    TransferredLength;
+
+  StorageDevice = SpdmGetTransportPathDeviceIoContext (SpdmContext, FALSE);
+  if (StorageDevice == NULL) {
+    return RETURN_DEVICE_ERROR;
+  }
+  if ((Message == NULL) || (MessageSize == NULL) || (*MessageSize <= sizeof(STORAGE_SECURITY_HEADER))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Status = StorageDeviceWaitPendingCommand (StorageDevice, Timeout, &TransferredLength);
+  if (RETURN_ERROR(Status)) {
+    return (Status == RETURN_TIMEOUT) ? RETURN_TIMEOUT : RETURN_DEVICE_ERROR;
+  }
+
+  AllocationLength = (UINT32)MIN (*MessageSize - sizeof(STORAGE_SECURITY_HEADER), StorageDevice->MaxTransferLength);
+  StorageHeader = Message;
+  Status = StorageDevice->Accessor.Submit (
+             StorageDevice->Accessor.DeviceContext,
+             FALSE,
+             STORAGE_SECURITY_PROTOCOL_SPDM,
+             StorageDevice->SecurityProtocolSpecific,
+             AllocationLength,
+             StorageHeader + 1,
+             &StorageDevice->PendingCommand
+             );
+  if (RETURN_ERROR(Status)) {
+    StorageDevice->PendingCommand = NULL;
+    return RETURN_DEVICE_ERROR;
+  }
+  Status = StorageDeviceWaitPendingCommand (StorageDevice, Timeout, &TransferredLength);
+  if (RETURN_ERROR(Status)) {
+    return (Status == RETURN_TIMEOUT) ? RETURN_TIMEOUT : RETURN_DEVICE_ERROR;
+  }
+  if ((TransferredLength == 0) || (TransferredLength > AllocationLength)) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  StorageHeader->SecurityProtocol = STORAGE_SECURITY_PROTOCOL_SPDM;
+  StorageHeader->Reserved = 0;
+  StorageHeader->SecurityProtocolSpecific = StorageDevice->SecurityProtocolSpecific;
+  StorageHeader->Length = TransferredLength;
+  *MessageSize = sizeof(STORAGE_SECURITY_HEADER) + TransferredLength;
+  return RETURN_SUCCESS;
+}
@@ -0,0 +1,199 @@
+/** @file
+  SPDM transport library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/SpdmTransportStorageLib.h>
+#include <IndustryStandard/StorageBinding.h>
+
+//
+// Each message is the data of one command, completed in order, so the secured messages need no sequence number.
+//
+#define STORAGE_SEQUENCE_NUMBER_COUNT 0
+#define STORAGE_MAX_RANDOM_NUMBER_COUNT 0
+
+/**
+  Get sequence number in an SPDM secure message.
+
+  This value is transport layer specific.
+
+  @param SequenceNumber        The current sequence number used to encode or decode message.
+  @param SequenceNumberBuffer  A buffer to hold the sequence number output used in the secured message.
+                               The size in byte of the output buffer shall be 8.
+
+  @return Size in byte of the SequenceNumberBuffer.
+          It shall be no greater than 8.
+          0 means no sequence number is required.
+**/
+UINT8
+EFIAPI
+StorageGetSequenceNumber (
+  IN     UINT64     SequenceNumber,
+  IN OUT UINT8      *SequenceNumberBuffer
+  )
+{
+  CopyMem (SequenceNumberBuffer, &SequenceNumber, STORAGE_SEQUENCE_NUMBER_COUNT);
+  return STORAGE_SEQUENCE_NUMBER_COUNT;
+}
+
+/**
+  Return max random number count in an SPDM secure message.
+
+  This value is transport layer specific.
+
+  @return Max random number count in an SPDM secured message.
+          0 means no randum number is required.
+**/
+UINT32
+EFIAPI
+StorageGetMaxRandomNumberCount (
+  VOID
+  )
+{
+  return STORAGE_MAX_RANDOM_NUMBER_COUNT;
+}
+
+/**
+  Return the room that the storage transport header needs around a message.
+
+  @param  Headroom                     Size in bytes of the storage transport header before the message.
+  @param  Tailroom                     Max size in bytes of the storage transport message after the message.
+**/
+VOID
+StorageGetMessageRoom (
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  )
+{
+  *Headroom = sizeof(STORAGE_SECURITY_HEADER);
+  *Tailroom = 0;
+}
+
+/**
+  Encode a normal message or secured message to a storage transport message.
+
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a source buffer to store the message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a destination buffer to store the transport message.
+
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_BUFFER_TOO_SMALL      The transport message buffer is too small.
+  @retval RETURN_OUT_OF_RESOURCES      The message is larger than a command.
+**/
+RETURN_STATUS
+StorageEncodeMessage (
+  IN     UINT32               *SessionId,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  )
+{
+  STORAGE_SECURITY_HEADER     *StorageHeader;
+
+  if ((UINT64)MessageSize > MAX_UINT32) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  ASSERT (*TransportMessageSize >= MessageSize + sizeof(STORAGE_SECURITY_HEADER));
+  if (*TransportMessageSize < MessageSize + sizeof(STORAGE_SECURITY_HEADER)) {
+    *TransportMessageSize = MessageSize + sizeof(STORAGE_SECURITY_HEADER);
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *TransportMessageSize = MessageSize + sizeof(STORAGE_SECURITY_HEADER);
+  StorageHeader = TransportMessage;
+  if (SessionId != NULL) {
+    StorageHeader->SecurityProtocolSpecific = STORAGE_SECURITY_PROTOCOL_SPECIFIC_SECURED_SPDM;
+    ASSERT (*SessionId == *(UINT32 *)(Message));
+    if (*SessionId != *(UINT32 *)(Message)) {
+      return RETURN_UNSUPPORTED;
+    }
+  } else {
+    StorageHeader->SecurityProtocolSpecific = STORAGE_SECURITY_PROTOCOL_SPECIFIC_SPDM;
+  }
+  StorageHeader->SecurityProtocol = STORAGE_SECURITY_PROTOCOL_SPDM;
+  StorageHeader->Reserved = 0;
+  StorageHeader->Length = (UINT32)MessageSize;
+
+  if ((UINT8 *)Message != (UINT8 *)TransportMessage + sizeof(STORAGE_SECURITY_HEADER)) {
+    CopyMem ((UINT8 *)TransportMessage + sizeof(STORAGE_SECURITY_HEADER), Message, MessageSize);
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decode a storage transport message to a normal message or secured message.
+
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If *SessionId is NULL, it is a normal message.
+                                       If *SessionId is NOT NULL, it is a secured message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a source buffer to store the transport message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a destination buffer to store the message.
+                                       It is not copied if Message is the data of the storage transport message.
+
+  @retval RETURN_SUCCESS               The message is decoded successfully.
+  @retval RETURN_UNSUPPORTED           The storage transport message is invalid.
+  @retval RETURN_BUFFER_TOO_SMALL      The message buffer is too small.
+**/
+RETURN_STATUS
+StorageDecodeMessage (
+     OUT UINT32               **SessionId,
+  IN     UINTN                TransportMessageSize,
+  IN     VOID                 *TransportMessage,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  )
+{
+  STORAGE_SECURITY_HEADER     *StorageHeader;
+
+  ASSERT (TransportMessageSize > sizeof(STORAGE_SECURITY_HEADER));
+  if (TransportMessageSize <= sizeof(STORAGE_SECURITY_HEADER)) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  StorageHeader = TransportMessage;
+  if ((StorageHeader->SecurityProtocol != STORAGE_SECURITY_PROTOCOL_SPDM) ||
+      (StorageHeader->Reserved != 0) ||
+      (StorageHeader->Length != TransportMessageSize - sizeof(STORAGE_SECURITY_HEADER))) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  switch (StorageHeader->SecurityProtocolSpecific) {
+  case STORAGE_SECURITY_PROTOCOL_SPECIFIC_SECURED_SPDM:
+    ASSERT (SessionId != NULL);
+    if (SessionId == NULL) {
+      return RETURN_UNSUPPORTED;
+    }
+    if (TransportMessageSize <= sizeof(STORAGE_SECURITY_HEADER) + sizeof(UINT32)) {
+      return RETURN_UNSUPPORTED;
+    }
+    *SessionId = (UINT32 *)((UINT8 *)TransportMessage + sizeof(STORAGE_SECURITY_HEADER));
+    break;
+  case STORAGE_SECURITY_PROTOCOL_SPECIFIC_SPDM:
+    if (SessionId != NULL) {
+      *SessionId = NULL;
+    }
+    break;
+  default:
+    return RETURN_UNSUPPORTED;
+  }
+
+  if (*MessageSize < StorageHeader->Length) {
+    *MessageSize = StorageHeader->Length;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *MessageSize = StorageHeader->Length;
+  if ((UINT8 *)Message != (UINT8 *)TransportMessage + sizeof(STORAGE_SECURITY_HEADER)) {
+    CopyMem (Message, (UINT8 *)TransportMessage + sizeof(STORAGE_SECURITY_HEADER), *MessageSize);
+  }
+  return RETURN_SUCCESS;
+}
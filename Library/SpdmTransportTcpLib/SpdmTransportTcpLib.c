@@ -0,0 +1,226 @@
+/** @file
+  SPDM transport library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmTransportTcpLibInternal.h"
+
+//
+// TCP delivers the records reliably and in order, so the secured messages need no sequence number.
+//
+#define TCP_SEQUENCE_NUMBER_COUNT 0
+#define TCP_MAX_RANDOM_NUMBER_COUNT 0
+
+/**
+  Get sequence number in an SPDM secure message.
+
+  This value is transport layer specific.
+
+  @param SequenceNumber        The current sequence number used to encode or decode message.
+  @param SequenceNumberBuffer  A buffer to hold the sequence number output used in the secured message.
+                               The size in byte of the output buffer shall be 8.
+
+  @return Size in byte of the SequenceNumberBuffer.
+          It shall be no greater than 8.
+          0 means no sequence number is required.
+**/
+UINT8
+EFIAPI
+TcpGetSequenceNumber (
+  IN     UINT64     SequenceNumber,
+  IN OUT UINT8      *SequenceNumberBuffer
+  )
+{
+  CopyMem (SequenceNumberBuffer, &SequenceNumber, TCP_SEQUENCE_NUMBER_COUNT);
+  return TCP_SEQUENCE_NUMBER_COUNT;
+}
+
+/**
+  Return max random number count in an SPDM secure message.
+
+  This value is transport layer specific.
+
+  @return Max random number count in an SPDM secured message.
+          0 means no randum number is required.
+**/
+UINT32
+EFIAPI
+TcpGetMaxRandomNumberCount (
+  VOID
+  )
+{
+  return TCP_MAX_RANDOM_NUMBER_COUNT;
+}
+
+/**
+  Return the ID of the SPDM connection of an SPDM context on its TCP link.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the SpdmDataTransportConnectionId of the SPDM context.
+**/
+UINT16
+TcpGetConnectionId (
+  IN     VOID                 *SpdmContext
+  )
+{
+  SPDM_DATA_PARAMETER         Parameter;
+  UINT16                      ConnectionId;
+  UINTN                       DataSize;
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  ConnectionId = 0;
+  DataSize = sizeof(ConnectionId);
+  SpdmGetData (SpdmContext, SpdmDataTransportConnectionId, &Parameter, &ConnectionId, &DataSize);
+  return ConnectionId;
+}
+
+/**
+  Return the room that the TCP record header needs around a message.
+
+  @param  Headroom                     Size in bytes of the TCP record header before the message.
+  @param  Tailroom                     Max size in bytes of the TCP record after the message.
+**/
+VOID
+TcpGetMessageRoom (
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  )
+{
+  *Headroom = sizeof(TCP_RECORD_HEADER);
+  *Tailroom = 0;
+}
+
+/**
+  Encode a normal message or secured message to a TCP record.
+
+  @param  ConnectionId                 The ID of the SPDM connection of the record.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a source buffer to store the message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a destination buffer to store the transport message.
+
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_BUFFER_TOO_SMALL      The transport message buffer is too small.
+  @retval RETURN_OUT_OF_RESOURCES      The message is larger than a record.
+**/
+RETURN_STATUS
+TcpEncodeMessage (
+  IN     UINT16               ConnectionId,
+  IN     UINT32               *SessionId,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  )
+{
+  TCP_RECORD_HEADER           *TcpRecordHeader;
+
+  if (MessageSize > TCP_MAX_RECORD_PAYLOAD_SIZE) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+  ASSERT (*TransportMessageSize >= MessageSize + sizeof(TCP_RECORD_HEADER));
+  if (*TransportMessageSize < MessageSize + sizeof(TCP_RECORD_HEADER)) {
+    *TransportMessageSize = MessageSize + sizeof(TCP_RECORD_HEADER);
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *TransportMessageSize = MessageSize + sizeof(TCP_RECORD_HEADER);
+  TcpRecordHeader = TransportMessage;
+  if (SessionId != NULL) {
+    TcpRecordHeader->MessageType = TCP_MESSAGE_TYPE_SECURED_SPDM;
+    ASSERT (*SessionId == *(UINT32 *)(Message));
+    if (*SessionId != *(UINT32 *)(Message)) {
+      return RETURN_UNSUPPORTED;
+    }
+  } else {
+    TcpRecordHeader->MessageType = TCP_MESSAGE_TYPE_SPDM;
+  }
+  TcpRecordHeader->Length = (UINT32)MessageSize;
+  TcpRecordHeader->ConnectionId = ConnectionId;
+  TcpRecordHeader->Reserved = 0;
+
+  if ((UINT8 *)Message != (UINT8 *)TransportMessage + sizeof(TCP_RECORD_HEADER)) {
+    CopyMem ((UINT8 *)TransportMessage + sizeof(TCP_RECORD_HEADER), Message, MessageSize);
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decode a TCP record to a normal message or secured message.
+
+  @param  ConnectionId                 The ID of the SPDM connection expected.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If *SessionId is NULL, it is a normal message.
+                                       If *SessionId is NOT NULL, it is a secured message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a source buffer to store the transport message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a destination buffer to store the message.
+                                       It is not copied if Message is the payload of the record.
+
+  @retval RETURN_SUCCESS               The message is decoded successfully.
+  @retval RETURN_UNSUPPORTED           The record is invalid, or of another connection.
+  @retval RETURN_BUFFER_TOO_SMALL      The message buffer is too small.
+**/
+RETURN_STATUS
+TcpDecodeMessage (
+  IN     UINT16               ConnectionId,
+     OUT UINT32               **SessionId,
+  IN     UINTN                TransportMessageSize,
+  IN     VOID                 *TransportMessage,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  )
+{
+  TCP_RECORD_HEADER           *TcpRecordHeader;
+
+  ASSERT (TransportMessageSize > sizeof(TCP_RECORD_HEADER));
+  if (TransportMessageSize <= sizeof(TCP_RECORD_HEADER)) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  TcpRecordHeader = TransportMessage;
+  if ((TcpRecordHeader->Reserved != 0) ||
+      (TcpRecordHeader->ConnectionId != ConnectionId) ||
+      (TcpRecordHeader->Length != TransportMessageSize - sizeof(TCP_RECORD_HEADER))) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  switch (TcpRecordHeader->MessageType) {
+  case TCP_MESSAGE_TYPE_SECURED_SPDM:
+    ASSERT (SessionId != NULL);
+    if (SessionId == NULL) {
+      return RETURN_UNSUPPORTED;
+    }
+    if (TransportMessageSize <= sizeof(TCP_RECORD_HEADER) + sizeof(UINT32)) {
+      return RETURN_UNSUPPORTED;
+    }
+    *SessionId = (UINT32 *)((UINT8 *)TransportMessage + sizeof(TCP_RECORD_HEADER));
+    break;
+  case TCP_MESSAGE_TYPE_SPDM:
+    if (SessionId != NULL) {
+      *SessionId = NULL;
+    }
+    break;
+  default:
+    return RETURN_UNSUPPORTED;
+  }
+
+  if (*MessageSize < TcpRecordHeader->Length) {
+    *MessageSize = TcpRecordHeader->Length;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *MessageSize = TcpRecordHeader->Length;
+  if ((UINT8 *)Message != (UINT8 *)TransportMessage + sizeof(TCP_RECORD_HEADER)) {
+    CopyMem (Message, (UINT8 *)TransportMessage + sizeof(TCP_RECORD_HEADER), *MessageSize);
+  }
+  return RETURN_SUCCESS;
+}
@@ -0,0 +1,93 @@
+/** @file
+  SPDM TCP Transport library.
+  It follows the SPDM over TCP binding in IndustryStandard/TcpBinding.h.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __TCP_TRANSPORT_LIB_INTERNAL_H__
+#define __TCP_TRANSPORT_LIB_INTERNAL_H__
+
+#include <Library/SpdmTransportTcpLib.h>
+#include <IndustryStandard/TcpBinding.h>
+
+/**
+  Return the ID of the SPDM connection of an SPDM context on its TCP link.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the SpdmDataTransportConnectionId of the SPDM context.
+**/
+UINT16
+TcpGetConnectionId (
+  IN     VOID                 *SpdmContext
+  );
+
+/**
+  Return the room that the TCP record header needs around a message.
+
+  @param  Headroom                     Size in bytes of the TCP record header before the message.
+  @param  Tailroom                     Max size in bytes of the TCP record after the message.
+**/
+VOID
+TcpGetMessageRoom (
+     OUT UINTN                *Headroom,
+     OUT UINTN                *Tailroom
+  );
+
+/**
+  Encode a normal message or secured message to a TCP record.
+
+  @param  ConnectionId                 The ID of the SPDM connection of the record.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If SessionId is NULL, it is a normal message.
+                                       If SessionId is NOT NULL, it is a secured message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a source buffer to store the message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a destination buffer to store the transport message.
+
+  @retval RETURN_SUCCESS               The message is encoded successfully.
+  @retval RETURN_BUFFER_TOO_SMALL      The transport message buffer is too small.
+  @retval RETURN_OUT_OF_RESOURCES      The message is larger than a record.
+**/
+RETURN_STATUS
+TcpEncodeMessage (
+  IN     UINT16               ConnectionId,
+  IN     UINT32               *SessionId,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  );
+
+/**
+  Decode a TCP record to a normal message or secured message.
+
+  @param  ConnectionId                 The ID of the SPDM connection expected.
+  @param  SessionId                    Indicates if it is a secured message protected via SPDM session.
+                                       If *SessionId is NULL, it is a normal message.
+                                       If *SessionId is NOT NULL, it is a secured message.
+  @param  TransportMessageSize         Size in bytes of the transport message data buffer.
+  @param  TransportMessage             A pointer to a source buffer to store the transport message.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to a destination buffer to store the message.
+                                       It is not copied if Message is the payload of the record.
+
+  @retval RETURN_SUCCESS               The message is decoded successfully.
+  @retval RETURN_UNSUPPORTED           The record is invalid, or of another connection.
+  @retval RETURN_BUFFER_TOO_SMALL      The message buffer is too small.
+**/
+RETURN_STATUS
+TcpDecodeMessage (
+  IN     UINT16               ConnectionId,
+     OUT UINT32               **SessionId,
+  IN     UINTN                TransportMessageSize,
+  IN     VOID                 *TransportMessage,
+  IN OUT UINTN                *MessageSize,
+     OUT VOID                 *Message
+  );
+
+#endif
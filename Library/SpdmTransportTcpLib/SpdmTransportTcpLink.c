@@ -0,0 +1,257 @@
+/** @file
+  SPDM transport library.
+  It follows the SPDM Specification.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmTransportTcpLibInternal.h"
+
+//
+// A record received for an SPDM connection while another one was waiting for its record.
+//
+typedef struct {
+  BOOLEAN                   Pending;
+  UINTN                     RecordSize;
+} TCP_LINK_CONNECTION;
+
+//
+// The connections follow the link header, and the record buffer of each connection,
+// of MaxRecordSize bytes, follows the connections.
+//
+typedef struct {
+  TCP_LINK_ACCESSOR         Accessor;
+  UINTN                     ConnectionCount;
+  UINTN                     MaxRecordSize;
+} TCP_LINK;
+
+/**
+  Return a connection of a TCP link.
+
+  @param  Link                         A pointer to the TCP link.
+  @param  ConnectionId                 The ID of the SPDM connection.
+
+  @return the connection.
+**/
+TCP_LINK_CONNECTION *
+TcpLinkGetConnection (
+  IN     TCP_LINK             *Link,
+  IN     UINTN                ConnectionId
+  )
+{
+  return (TCP_LINK_CONNECTION *)(Link + 1) + ConnectionId;
+}
+
+/**
+  Return the record buffer of a connection of a TCP link.
+
+  @param  Link                         A pointer to the TCP link.
+  @param  ConnectionId                 The ID of the SPDM connection.
+
+  @return the record buffer of the connection.
+**/
+UINT8 *
+TcpLinkGetRecordBuffer (
+  IN     TCP_LINK             *Link,
+  IN     UINTN                ConnectionId
+  )
+{
+  return (UINT8 *)TcpLinkGetConnection (Link, Link->ConnectionCount) + ConnectionId * Link->MaxRecordSize;
+}
+
+/**
+  Return the size in bytes of a TCP link.
+
+  @param  ConnectionCount              The number of SPDM connections on the link.
+  @param  MaxRecordSize                The size in bytes of the largest record received, with its header.
+
+  @return the size in bytes of the TCP link.
+**/
+UINTN
+EFIAPI
+SpdmTransportTcpLinkGetSize (
+  IN     UINTN                ConnectionCount,
+  IN     UINTN                MaxRecordSize
+  )
+{
+  return sizeof(TCP_LINK) + (sizeof(TCP_LINK_CONNECTION) + MaxRecordSize) * ConnectionCount;
+}
+
+/**
+  Initialize a TCP link, which multiplexes several SPDM connections over one TCP connection.
+
+  The TCP link is registered to the SPDM context of each connection by SpdmRegisterDeviceIoContext, so that
+  SpdmTransportTcpLinkSendMessage and SpdmTransportTcpLinkReceiveMessage are registered by SpdmRegisterDeviceIoFunc
+  as the device input/output functions. Each SPDM context sets a different SpdmDataTransportConnectionId,
+  less than ConnectionCount.
+  The functions of the SPDM contexts sharing a TCP link must not be called concurrently.
+
+  @param  Link                         A pointer to the TCP link.
+  @param  Accessor                     A pointer to the TCP connection.
+  @param  ConnectionCount              The number of SPDM connections on the link.
+  @param  MaxRecordSize                The size in bytes of the largest record received, with its header.
+
+  @retval RETURN_SUCCESS               The TCP link is initialized.
+  @retval RETURN_INVALID_PARAMETER     ConnectionCount is 0 or larger than 0x10000,
+                                       or MaxRecordSize is not larger than a record header.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportTcpLinkInit (
+     OUT VOID                 *Link,
+  IN     TCP_LINK_ACCESSOR    *Accessor,
+  IN     UINTN                ConnectionCount,
+  IN     UINTN                MaxRecordSize
+  )
+{
+  TCP_LINK                  *TcpLink;
+
+  if ((ConnectionCount == 0) || (ConnectionCount > MAX_UINT16 + 1) || (MaxRecordSize <= sizeof(TCP_RECORD_HEADER))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  TcpLink = Link;
+  ZeroMem (TcpLink, sizeof(TCP_LINK) + sizeof(TCP_LINK_CONNECTION) * ConnectionCount);
+  CopyMem (&TcpLink->Accessor, Accessor, sizeof(TCP_LINK_ACCESSOR));
+  TcpLink->ConnectionCount = ConnectionCount;
+  TcpLink->MaxRecordSize = MaxRecordSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Send an SPDM transport layer message to the TCP link registered to an SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  Size in bytes of the message data buffer.
+  @param  Message                      A pointer to the message, a TCP record.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is sent successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs when the SPDM message is sent to the device.
+  @retval RETURN_INVALID_PARAMETER     The Message is NULL or the MessageSize is invalid.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportTcpLinkSendMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  TCP_LINK                  *TcpLink;
+  RETURN_STATUS             Status;
+
+  if ((Message == NULL) || (MessageSize <= sizeof(TCP_RECORD_HEADER))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  TcpLink = SpdmGetTransportPathDeviceIoContext (SpdmContext, TRUE);
+  Status = TcpLink->Accessor.Send (TcpLink->Accessor.SocketContext, MessageSize, Message);
+  if (RETURN_ERROR(Status)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Receive an SPDM transport layer message of an SPDM context from the TCP link registered to it.
+
+  The record header is received first. The payload of a record of the SPDM context is received directly
+  in Message, after the header, so that it is not copied. A record of another SPDM connection of the link
+  is kept for that connection, and the next record is received.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  MessageSize                  On input, the size in bytes of the message buffer.
+                                       On output, the size in bytes of the message received.
+  @param  Message                      A pointer to the message buffer.
+  @param  Timeout                      The timeout, in 100ns units. 0 means to wait indefinitely.
+
+  @retval RETURN_SUCCESS               The SPDM message is received successfully.
+  @retval RETURN_DEVICE_ERROR          A device error occurs, or the TCP byte stream has an invalid record.
+                                       The TCP connection should be closed.
+  @retval RETURN_BUFFER_TOO_SMALL      The record is larger than the message buffer. It is kept.
+  @retval RETURN_TIMEOUT               No record is received within Timeout.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmTransportTcpLinkReceiveMessage (
+  IN     VOID                 *SpdmContext,
+  IN OUT UINTN                *MessageSize,
+  IN OUT VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  TCP_LINK                  *TcpLink;
+  TCP_LINK_CONNECTION       *Connection;
+  TCP_RECORD_HEADER         Header;
+  UINT8                     *RecordBuffer;
+  UINTN                     RecordSize;
+  UINT16                    ConnectionId;
+  RETURN_STATUS             Status;
+
+  TcpLink = SpdmGetTransportPathDeviceIoContext (SpdmContext, FALSE);
+  ConnectionId = TcpGetConnectionId (SpdmContext);
+  if (ConnectionId >= TcpLink->ConnectionCount) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  Connection = TcpLinkGetConnection (TcpLink, ConnectionId);
+  if (Connection->Pending) {
+    if (*MessageSize < Connection->RecordSize) {
+      *MessageSize = Connection->RecordSize;
+      return RETURN_BUFFER_TOO_SMALL;
+    }
+    *MessageSize = Connection->RecordSize;
+    CopyMem (Message, TcpLinkGetRecordBuffer (TcpLink, ConnectionId), Connection->RecordSize);
+    Connection->Pending = FALSE;
+    return RETURN_SUCCESS;
+  }
+
+  while (TRUE) {
+    Status = TcpLink->Accessor.Receive (TcpLink->Accessor.SocketContext, sizeof(Header), &Header, Timeout);
+    if (Status == RETURN_TIMEOUT) {
+      return RETURN_TIMEOUT;
+    }
+    if (RETURN_ERROR(Status) ||
+        (Header.Length > TCP_MAX_RECORD_PAYLOAD_SIZE) || (Header.ConnectionId >= TcpLink->ConnectionCount)) {
+      return RETURN_DEVICE_ERROR;
+    }
+    RecordSize = sizeof(Header) + Header.Length;
+
+    //
+    // The record of this connection is received in place.
+    //
+    if ((Header.ConnectionId == ConnectionId) && (RecordSize <= *MessageSize)) {
+      CopyMem (Message, &Header, sizeof(Header));
+      Status = TcpLink->Accessor.Receive (TcpLink->Accessor.SocketContext, Header.Length, (UINT8 *)Message + sizeof(Header), Timeout);
+      if (RETURN_ERROR(Status)) {
+        return RETURN_DEVICE_ERROR;
+      }
+      *MessageSize = RecordSize;
+      return RETURN_SUCCESS;
+    }
+
+    //
+    // The record is kept for its connection, which has at most one record outstanding.
+    //
+    Connection = TcpLinkGetConnection (TcpLink, Header.ConnectionId);
+    if (Connection->Pending || (RecordSize > TcpLink->MaxRecordSize)) {
+      return RETURN_DEVICE_ERROR;
+    }
+    RecordBuffer = TcpLinkGetRecordBuffer (TcpLink, Header.ConnectionId);
+    CopyMem (RecordBuffer, &Header, sizeof(Header));
+    Status = TcpLink->Accessor.Receive (TcpLink->Accessor.SocketContext, Header.Length, RecordBuffer + sizeof(Header), Timeout);
+    if (RETURN_ERROR(Status)) {
+      return RETURN_DEVICE_ERROR;
+    }
+    Connection->Pending = TRUE;
+    Connection->RecordSize = RecordSize;
+    if (Header.ConnectionId == ConnectionId) {
+      *MessageSize = RecordSize;
+      return RETURN_BUFFER_TOO_SMALL;
+    }
+  }
+}
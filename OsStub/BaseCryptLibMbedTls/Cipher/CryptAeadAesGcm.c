@@ -196,3 +196,697 @@ AeadAesGcmDecrypt (
 }
 
 
+
+/**
+  Allocates and initializes one AEAD AES-GCM context for subsequent use.
+
+  @return  Pointer to the AEAD AES-GCM context that has been initialized.
+           If the allocations fails, AeadAesGcmNew() returns NULL.
+
+**/
+VOID *
+EFIAPI
+AeadAesGcmNew (
+  VOID
+  )
+{
+  mbedtls_gcm_context *ctx;
+
+  ctx = AllocateZeroPool (sizeof(mbedtls_gcm_context));
+  if (ctx == NULL) {
+    return NULL;
+  }
+  mbedtls_gcm_init (ctx);
+  return ctx;
+}
+
+/**
+  Release the specified AEAD AES-GCM context.
+
+  @param[in]  AeadContext  Pointer to the AEAD AES-GCM context to be released.
+
+**/
+VOID
+EFIAPI
+AeadAesGcmFree (
+  IN  VOID  *AeadContext
+  )
+{
+  if (AeadContext == NULL) {
+    return ;
+  }
+  mbedtls_gcm_free (AeadContext);
+  FreePool (AeadContext);
+}
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to AeadAesGcmSeal() or AeadAesGcmOpen().
+
+  If AeadContext is NULL, then return FALSE.
+  KeySize must be 16, 24 or 32, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the AEAD AES-GCM context.
+  @param[in]       Key          Pointer to the user-supplied key.
+  @param[in]       KeySize      Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmSetKey (
+  IN OUT  VOID         *AeadContext,
+  IN      CONST UINT8  *Key,
+  IN      UINTN        KeySize
+  )
+{
+  INT32               Ret;
+
+  if (AeadContext == NULL || Key == NULL) {
+    return FALSE;
+  }
+  switch (KeySize) {
+  case 16:
+  case 24:
+  case 32:
+    break;
+  default:
+    return FALSE;
+  }
+
+  Ret = mbedtls_gcm_setkey (AeadContext, MBEDTLS_CIPHER_ID_AES, Key, (UINT32)(KeySize * 8));
+  if (Ret != 0) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Performs AEAD AES-GCM authenticated encryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD AES-GCM context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be encrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD AES-GCM authenticated encryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmSeal (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  OUT  UINT8        *TagOut,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  )
+{
+  INT32               Ret;
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (DataInSize > INT_MAX) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if ((TagSize != 12) && (TagSize != 13) && (TagSize != 14) && (TagSize != 15) && (TagSize != 16)) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    if ((*DataOutSize > INT_MAX) || (*DataOutSize < DataInSize)) {
+      return FALSE;
+    }
+  }
+
+  Ret = mbedtls_gcm_crypt_and_tag (AeadContext, MBEDTLS_GCM_ENCRYPT, (UINT32)DataInSize,
+                                   Iv, (UINT32)IvSize, AData, (UINT32)ADataSize, DataIn, DataOut,
+                                   TagSize, TagOut);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    *DataOutSize = DataInSize;
+  }
+
+  return TRUE;
+}
+
+/**
+  Performs AEAD AES-GCM authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD AES-GCM context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the decryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD AES-GCM authenticated decryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmOpen (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  IN   CONST UINT8  *Tag,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  )
+{
+  INT32               Ret;
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (DataInSize > INT_MAX) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if ((TagSize != 12) && (TagSize != 13) && (TagSize != 14) && (TagSize != 15) && (TagSize != 16)) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    if ((*DataOutSize > INT_MAX) || (*DataOutSize < DataInSize)) {
+      return FALSE;
+    }
+  }
+
+  Ret = mbedtls_gcm_auth_decrypt (AeadContext, (UINT32)DataInSize,
+                                  Iv, (UINT32)IvSize, AData, (UINT32)ADataSize,
+                                  Tag, (UINT32)TagSize, DataIn, DataOut);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    *DataOutSize = DataInSize;
+  }
+
+  return TRUE;
+}
+
+/**
+  Zero the first Size bytes spread over a list of data segments.
+
+  @param[in]  Segments      Pointer to the list of data segments.
+  @param[in]  SegmentCount  Number of entries in Segments.
+  @param[in]  Size          Number of bytes to be zeroed.
+
+**/
+STATIC
+VOID
+ZeroSegments (
+  IN CONST CRYPT_DATA_SEGMENT  *Segments,
+  IN UINTN                     SegmentCount,
+  IN UINTN                     Size
+  )
+{
+  UINTN  Index;
+  UINTN  Length;
+
+  for (Index = 0; (Index < SegmentCount) && (Size != 0); Index++) {
+    Length = MIN (Segments[Index].Size, Size);
+    ZeroMem (Segments[Index].Buffer, Length);
+    Size -= Length;
+  }
+}
+
+/**
+  Performs AEAD AES-GCM authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with the key held in the AEAD AES-GCM context.
+
+  The segments are encrypted in order, as if they were one contiguous buffer, into DataOut.
+  A segment may only overlap DataOut at the offset where its own cipher text is written.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the list of input data segments to be encrypted.
+  @param[in]   DataInCount Number of entries in DataIn.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD AES-GCM authenticated encryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmSealSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataIn,
+  IN   UINTN                       DataInCount,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize,
+  OUT  UINT8                       *DataOut,
+  OUT  UINTN                       *DataOutSize
+  )
+{
+  INT32               Ret;
+  UINTN               Index;
+  UINTN               DataInSize;
+  UINTN               Offset;
+  UINTN               Length;
+  UINTN               Size;
+  CONST UINT8         *Data;
+  UINT8               Block[16];
+  UINTN               BlockSize;
+
+  if (AeadContext == NULL || (DataIn == NULL && DataInCount != 0)) {
+    return FALSE;
+  }
+  DataInSize = 0;
+  for (Index = 0; Index < DataInCount; Index++) {
+    if (DataIn[Index].Size > INT_MAX - DataInSize) {
+      return FALSE;
+    }
+    DataInSize += DataIn[Index].Size;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if ((TagSize != 12) && (TagSize != 13) && (TagSize != 14) && (TagSize != 15) && (TagSize != 16)) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    if ((*DataOutSize > INT_MAX) || (*DataOutSize < DataInSize)) {
+      return FALSE;
+    }
+  }
+
+  Ret = mbedtls_gcm_starts (AeadContext, MBEDTLS_GCM_ENCRYPT, Iv, IvSize, AData, ADataSize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+
+  //
+  // mbedtls_gcm_update() only accepts a partial block on its last call, so a block
+  // that straddles two segments is gathered into a local buffer first.
+  //
+  Offset = 0;
+  BlockSize = 0;
+  for (Index = 0; Index < DataInCount; Index++) {
+    Data = DataIn[Index].Buffer;
+    Size = DataIn[Index].Size;
+    if (BlockSize != 0) {
+      Length = MIN (Size, sizeof(Block) - BlockSize);
+      CopyMem (Block + BlockSize, Data, Length);
+      BlockSize += Length;
+      Data += Length;
+      Size -= Length;
+      if (BlockSize < sizeof(Block)) {
+        continue;
+      }
+      Ret = mbedtls_gcm_update (AeadContext, sizeof(Block), Block, DataOut + Offset);
+      if (Ret != 0) {
+        goto Done;
+      }
+      Offset += sizeof(Block);
+      BlockSize = 0;
+    }
+    Length = Size & ~(sizeof(Block) - 1);
+    if (Length != 0) {
+      Ret = mbedtls_gcm_update (AeadContext, Length, Data, DataOut + Offset);
+      if (Ret != 0) {
+        goto Done;
+      }
+      Offset += Length;
+      Data += Length;
+      Size -= Length;
+    }
+    if (Size != 0) {
+      CopyMem (Block, Data, Size);
+      BlockSize = Size;
+    }
+  }
+  if (BlockSize != 0) {
+    Ret = mbedtls_gcm_update (AeadContext, BlockSize, Block, DataOut + Offset);
+    if (Ret != 0) {
+      goto Done;
+    }
+  }
+
+  Ret = mbedtls_gcm_finish (AeadContext, TagOut, TagSize);
+  if ((Ret == 0) && (DataOutSize != NULL)) {
+    *DataOutSize = DataInSize;
+  }
+
+Done:
+  ZeroMem (Block, sizeof(Block));
+  return (BOOLEAN)(Ret == 0);
+}
+
+/**
+  Performs AEAD AES-GCM authenticated decryption on a data buffer and additional authenticated data (AAD)
+  into a list of data segments, with the key held in the AEAD AES-GCM context.
+
+  The plain text is written in order across the segments, which must hold at least DataInSize bytes.
+  A segment may only overlap DataIn at the offset where its own cipher text is read.
+  If the authentication fails, the plain text written to the segments is zeroed.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[in]   DataOut     Pointer to the list of segments that receive the decryption output.
+  @param[in]   DataOutCount Number of entries in DataOut.
+
+  @retval TRUE   AEAD AES-GCM authenticated decryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmOpenSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *DataIn,
+  IN   UINTN                       DataInSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataOut,
+  IN   UINTN                       DataOutCount
+  )
+{
+  INT32               Ret;
+  UINTN               Index;
+  UINTN               Capacity;
+  UINTN               Offset;
+  UINTN               Used;
+  UINTN               Length;
+  UINTN               Copied;
+  UINT8               Block[16];
+  UINTN               BlockSize;
+  UINT8               CheckTag[16];
+  UINT8               Diff;
+
+  if (AeadContext == NULL || (DataOut == NULL && DataOutCount != 0)) {
+    return FALSE;
+  }
+  if (DataInSize > INT_MAX) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if ((TagSize != 12) && (TagSize != 13) && (TagSize != 14) && (TagSize != 15) && (TagSize != 16)) {
+    return FALSE;
+  }
+  Capacity = 0;
+  for (Index = 0; (Index < DataOutCount) && (Capacity < DataInSize); Index++) {
+    Capacity += MIN (DataOut[Index].Size, DataInSize - Capacity);
+  }
+  if (Capacity < DataInSize) {
+    return FALSE;
+  }
+
+  Ret = mbedtls_gcm_starts (AeadContext, MBEDTLS_GCM_DECRYPT, Iv, IvSize, AData, ADataSize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+
+  //
+  // Decrypt whole blocks straight into each segment. A block that straddles two
+  // segments is decrypted into a local buffer and then scattered.
+  //
+  Index = 0;
+  Used = 0;
+  Offset = 0;
+  while (Offset < DataInSize) {
+    while (Used == DataOut[Index].Size) {
+      Index++;
+      Used = 0;
+    }
+    Length = MIN (DataOut[Index].Size - Used, DataInSize - Offset);
+    if (Offset + Length < DataInSize) {
+      Length &= ~(sizeof(Block) - 1);
+    }
+    if (Length != 0) {
+      Ret = mbedtls_gcm_update (AeadContext, Length, DataIn + Offset, (UINT8 *)DataOut[Index].Buffer + Used);
+      if (Ret != 0) {
+        goto Done;
+      }
+      Used += Length;
+      Offset += Length;
+      continue;
+    }
+
+    BlockSize = MIN (sizeof(Block), DataInSize - Offset);
+    Ret = mbedtls_gcm_update (AeadContext, BlockSize, DataIn + Offset, Block);
+    if (Ret != 0) {
+      goto Done;
+    }
+    Offset += BlockSize;
+    for (Copied = 0; Copied < BlockSize; Copied += Length) {
+      while (Used == DataOut[Index].Size) {
+        Index++;
+        Used = 0;
+      }
+      Length = MIN (DataOut[Index].Size - Used, BlockSize - Copied);
+      CopyMem ((UINT8 *)DataOut[Index].Buffer + Used, Block + Copied, Length);
+      Used += Length;
+    }
+  }
+
+  Ret = mbedtls_gcm_finish (AeadContext, CheckTag, TagSize);
+  if (Ret != 0) {
+    goto Done;
+  }
+
+  //
+  // Check the tag in constant time.
+  //
+  Diff = 0;
+  for (Length = 0; Length < TagSize; Length++) {
+    Diff |= Tag[Length] ^ CheckTag[Length];
+  }
+  if (Diff != 0) {
+    Ret = MBEDTLS_ERR_GCM_AUTH_FAILED;
+  }
+
+Done:
+  ZeroMem (Block, sizeof(Block));
+  ZeroMem (CheckTag, sizeof(CheckTag));
+  if (Ret != 0) {
+    ZeroSegments (DataOut, DataOutCount, DataInSize);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Generates the AEAD AES-GCM authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD AES-GCM context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD AES-GCM authentication tag generation succeeded.
+  @retval FALSE  AEAD AES-GCM authentication tag generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmMac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize
+  )
+{
+  INT32               Ret;
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if ((TagSize != 12) && (TagSize != 13) && (TagSize != 14) && (TagSize != 15) && (TagSize != 16)) {
+    return FALSE;
+  }
+
+  Ret = mbedtls_gcm_starts (AeadContext, MBEDTLS_GCM_ENCRYPT, Iv, IvSize, AData, ADataSize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_gcm_finish (AeadContext, TagOut, TagSize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Verifies the AEAD AES-GCM authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD AES-GCM context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD AES-GCM authentication tag verification succeeded.
+  @retval FALSE  AEAD AES-GCM authentication tag verification failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmVerifyMac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize
+  )
+{
+  INT32               Ret;
+  UINT8               CheckTag[16];
+  UINT8               Diff;
+  UINTN               Index;
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if ((TagSize != 12) && (TagSize != 13) && (TagSize != 14) && (TagSize != 15) && (TagSize != 16)) {
+    return FALSE;
+  }
+
+  Ret = mbedtls_gcm_starts (AeadContext, MBEDTLS_GCM_DECRYPT, Iv, IvSize, AData, ADataSize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_gcm_finish (AeadContext, CheckTag, TagSize);
+  if (Ret != 0) {
+    goto Done;
+  }
+
+  //
+  // Check the tag in constant time.
+  //
+  Diff = 0;
+  for (Index = 0; Index < TagSize; Index++) {
+    Diff |= Tag[Index] ^ CheckTag[Index];
+  }
+  if (Diff != 0) {
+    Ret = MBEDTLS_ERR_GCM_AUTH_FAILED;
+  }
+
+Done:
+  ZeroMem (CheckTag, sizeof(CheckTag));
+  if (Ret != 0) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
@@ -183,3 +183,622 @@ AeadChaCha20Poly1305Decrypt(
   return TRUE;
 }
 
+
+/**
+  Allocates and initializes one AEAD ChaCha20Poly1305 context for subsequent use.
+
+  @return  Pointer to the AEAD ChaCha20Poly1305 context that has been initialized.
+           If the allocations fails, AeadChaCha20Poly1305New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+AeadChaCha20Poly1305New (
+  VOID
+  )
+{
+  mbedtls_chachapoly_context *ctx;
+
+  ctx = AllocateZeroPool (sizeof(mbedtls_chachapoly_context));
+  if (ctx == NULL) {
+    return NULL;
+  }
+  mbedtls_chachapoly_init (ctx);
+  return ctx;
+}
+
+/**
+  Release the specified AEAD ChaCha20Poly1305 context.
+
+  @param[in]  AeadContext  Pointer to the AEAD ChaCha20Poly1305 context to be released.
+
+**/
+VOID
+EFIAPI
+AeadChaCha20Poly1305Free (
+  IN  VOID  *AeadContext
+  )
+{
+  if (AeadContext == NULL) {
+    return ;
+  }
+  mbedtls_chachapoly_free (AeadContext);
+  FreePool (AeadContext);
+}
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to AeadChaCha20Poly1305Seal() or AeadChaCha20Poly1305Open().
+
+  If AeadContext is NULL, then return FALSE.
+  KeySize must be 32, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the AEAD ChaCha20Poly1305 context.
+  @param[in]       Key          Pointer to the user-supplied key.
+  @param[in]       KeySize      Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305SetKey (
+  IN OUT  VOID         *AeadContext,
+  IN      CONST UINT8  *Key,
+  IN      UINTN        KeySize
+  )
+{
+  INT32               Ret;
+
+  if (AeadContext == NULL || Key == NULL) {
+    return FALSE;
+  }
+  if (KeySize != 32) {
+    return FALSE;
+  }
+
+  Ret = mbedtls_chachapoly_setkey (AeadContext, Key);
+  if (Ret != 0) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated encryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be encrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated encryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305Seal (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  OUT  UINT8        *TagOut,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  )
+{
+  INT32               Ret;
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (DataInSize > INT_MAX) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    if ((*DataOutSize > INT_MAX) || (*DataOutSize < DataInSize)) {
+      return FALSE;
+    }
+  }
+
+  Ret = mbedtls_chachapoly_encrypt_and_tag (AeadContext, (UINT32)DataInSize,
+                                            Iv, AData, (UINT32)ADataSize, DataIn, DataOut, TagOut);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    *DataOutSize = DataInSize;
+  }
+
+  return TRUE;
+}
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the decryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated decryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305Open (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  IN   CONST UINT8  *Tag,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  )
+{
+  INT32               Ret;
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (DataInSize > INT_MAX) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    if ((*DataOutSize > INT_MAX) || (*DataOutSize < DataInSize)) {
+      return FALSE;
+    }
+  }
+
+  Ret = mbedtls_chachapoly_auth_decrypt (AeadContext, (UINT32)DataInSize,
+                                         Iv, AData, (UINT32)ADataSize, Tag, DataIn, DataOut);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    *DataOutSize = DataInSize;
+  }
+
+  return TRUE;
+}
+
+/**
+  Zero the first Size bytes spread over a list of data segments.
+
+  @param[in]  Segments      Pointer to the list of data segments.
+  @param[in]  SegmentCount  Number of entries in Segments.
+  @param[in]  Size          Number of bytes to be zeroed.
+
+**/
+STATIC
+VOID
+ZeroSegments (
+  IN CONST CRYPT_DATA_SEGMENT  *Segments,
+  IN UINTN                     SegmentCount,
+  IN UINTN                     Size
+  )
+{
+  UINTN  Index;
+  UINTN  Length;
+
+  for (Index = 0; (Index < SegmentCount) && (Size != 0); Index++) {
+    Length = MIN (Segments[Index].Size, Size);
+    ZeroMem (Segments[Index].Buffer, Length);
+    Size -= Length;
+  }
+}
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  The segments are encrypted in order, as if they were one contiguous buffer, into DataOut.
+  A segment may only overlap DataOut at the offset where its own cipher text is written.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the list of input data segments to be encrypted.
+  @param[in]   DataInCount Number of entries in DataIn.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated encryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305SealSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataIn,
+  IN   UINTN                       DataInCount,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize,
+  OUT  UINT8                       *DataOut,
+  OUT  UINTN                       *DataOutSize
+  )
+{
+  INT32               Ret;
+  UINTN               Index;
+  UINTN               DataInSize;
+  UINTN               Offset;
+
+  if (AeadContext == NULL || (DataIn == NULL && DataInCount != 0)) {
+    return FALSE;
+  }
+  DataInSize = 0;
+  for (Index = 0; Index < DataInCount; Index++) {
+    if (DataIn[Index].Size > INT_MAX - DataInSize) {
+      return FALSE;
+    }
+    DataInSize += DataIn[Index].Size;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    if ((*DataOutSize > INT_MAX) || (*DataOutSize < DataInSize)) {
+      return FALSE;
+    }
+  }
+
+  Ret = mbedtls_chachapoly_starts (AeadContext, Iv, MBEDTLS_CHACHAPOLY_ENCRYPT);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_chachapoly_update_aad (AeadContext, AData, ADataSize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Offset = 0;
+  for (Index = 0; Index < DataInCount; Index++) {
+    Ret = mbedtls_chachapoly_update (AeadContext, DataIn[Index].Size, DataIn[Index].Buffer, DataOut + Offset);
+    if (Ret != 0) {
+      return FALSE;
+    }
+    Offset += DataIn[Index].Size;
+  }
+  Ret = mbedtls_chachapoly_finish (AeadContext, TagOut);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    *DataOutSize = DataInSize;
+  }
+
+  return TRUE;
+}
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated decryption on a data buffer and additional authenticated data (AAD)
+  into a list of data segments, with the key held in the AEAD ChaCha20Poly1305 context.
+
+  The plain text is written in order across the segments, which must hold at least DataInSize bytes.
+  A segment may only overlap DataIn at the offset where its own cipher text is read.
+  If the authentication fails, the plain text written to the segments is zeroed.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[in]   DataOut     Pointer to the list of segments that receive the decryption output.
+  @param[in]   DataOutCount Number of entries in DataOut.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated decryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305OpenSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *DataIn,
+  IN   UINTN                       DataInSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataOut,
+  IN   UINTN                       DataOutCount
+  )
+{
+  INT32               Ret;
+  UINTN               Index;
+  UINTN               Capacity;
+  UINTN               Offset;
+  UINTN               Length;
+  UINT8               CheckTag[16];
+  UINT8               Diff;
+
+  if (AeadContext == NULL || (DataOut == NULL && DataOutCount != 0)) {
+    return FALSE;
+  }
+  if (DataInSize > INT_MAX) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+  Capacity = 0;
+  for (Index = 0; (Index < DataOutCount) && (Capacity < DataInSize); Index++) {
+    Capacity += MIN (DataOut[Index].Size, DataInSize - Capacity);
+  }
+  if (Capacity < DataInSize) {
+    return FALSE;
+  }
+
+  Ret = mbedtls_chachapoly_starts (AeadContext, Iv, MBEDTLS_CHACHAPOLY_DECRYPT);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_chachapoly_update_aad (AeadContext, AData, ADataSize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Offset = 0;
+  for (Index = 0; (Index < DataOutCount) && (Offset < DataInSize); Index++) {
+    Length = MIN (DataOut[Index].Size, DataInSize - Offset);
+    Ret = mbedtls_chachapoly_update (AeadContext, Length, DataIn + Offset, DataOut[Index].Buffer);
+    if (Ret != 0) {
+      goto Done;
+    }
+    Offset += Length;
+  }
+  Ret = mbedtls_chachapoly_finish (AeadContext, CheckTag);
+  if (Ret != 0) {
+    goto Done;
+  }
+
+  //
+  // Check the tag in constant time.
+  //
+  Diff = 0;
+  for (Length = 0; Length < TagSize; Length++) {
+    Diff |= Tag[Length] ^ CheckTag[Length];
+  }
+  if (Diff != 0) {
+    Ret = MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED;
+  }
+
+Done:
+  ZeroMem (CheckTag, sizeof(CheckTag));
+  if (Ret != 0) {
+    ZeroSegments (DataOut, DataOutCount, DataInSize);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Generates the AEAD ChaCha20Poly1305 authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authentication tag generation succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authentication tag generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305Mac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize
+  )
+{
+  INT32               Ret;
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+
+  Ret = mbedtls_chachapoly_starts (AeadContext, Iv, MBEDTLS_CHACHAPOLY_ENCRYPT);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_chachapoly_update_aad (AeadContext, AData, ADataSize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_chachapoly_finish (AeadContext, TagOut);
+  if (Ret != 0) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Verifies the AEAD ChaCha20Poly1305 authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authentication tag verification succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authentication tag verification failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305VerifyMac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize
+  )
+{
+  INT32               Ret;
+  UINT8               CheckTag[16];
+  UINT8               Diff;
+  UINTN               Index;
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+
+  Ret = mbedtls_chachapoly_starts (AeadContext, Iv, MBEDTLS_CHACHAPOLY_DECRYPT);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_chachapoly_update_aad (AeadContext, AData, ADataSize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_chachapoly_finish (AeadContext, CheckTag);
+  if (Ret != 0) {
+    goto Done;
+  }
+
+  //
+  // Check the tag in constant time.
+  //
+  Diff = 0;
+  for (Index = 0; Index < TagSize; Index++) {
+    Diff |= Tag[Index] ^ CheckTag[Index];
+  }
+  if (Diff != 0) {
+    Ret = MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED;
+  }
+
+Done:
+  ZeroMem (CheckTag, sizeof(CheckTag));
+  if (Ret != 0) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
@@ -8,6 +8,50 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "InternalCryptLib.h"
 #include <mbedtls/sha256.h>
+#if defined(MBEDTLS_ACCEL_SHA256_MULTI)
+#include <mbedtls/sha256_multi.h>
+
+//
+// Number of buffers handed to the multi-buffer kernel per call.
+//
+#define SHA256_MULTI_BATCH  8
+#endif
+
+/**
+  Allocates one SHA-256 context for subsequent use.
+  The context must be initialized by Sha256Init() before it is used.
+
+  @return  Pointer to the SHA-256 context that has been allocated.
+           If the allocations fails, Sha256New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha256New (
+  VOID
+  )
+{
+  return AllocateZeroPool (sizeof (mbedtls_sha256_context));
+}
+
+/**
+  Release the specified SHA-256 context.
+
+  @param[in]  Sha256Context  Pointer to the SHA-256 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha256Free (
+  IN  VOID  *Sha256Context
+  )
+{
+  if (Sha256Context == NULL) {
+    return;
+  }
+  mbedtls_sha256_free (Sha256Context);
+  FreePool (Sha256Context);
+}
 
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-256 hash operations.
@@ -217,3 +261,76 @@ Sha256HashAll (
   }
   return TRUE;
 }
+
+/**
+  Computes the SHA-256 message digests of several independent data buffers.
+
+  The result is the same as calling Sha256HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA-256 digest values (32 bytes each).
+
+  @retval TRUE   SHA-256 digest computation succeeded.
+  @retval FALSE  SHA-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN        Index;
+#if defined(MBEDTLS_ACCEL_SHA256_MULTI)
+  CONST UINT8  *Input[SHA256_MULTI_BATCH];
+  size_t       InputSize[SHA256_MULTI_BATCH];
+  UINT8        *Output[SHA256_MULTI_BATCH];
+  UINTN        Batch;
+  UINTN        Lane;
+#endif
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+#if defined(MBEDTLS_ACCEL_SHA256_MULTI)
+  for (Index = 0; Index < Count; Index++) {
+    if (HashValue[Index] == NULL) {
+      return FALSE;
+    }
+    if (Data[Index].Buffer == NULL && Data[Index].Size != 0) {
+      return FALSE;
+    }
+    if (Data[Index].Size > INT_MAX) {
+      return FALSE;
+    }
+  }
+
+  for (Index = 0; Index < Count; Index += Batch) {
+    Batch = MIN (Count - Index, SHA256_MULTI_BATCH);
+    for (Lane = 0; Lane < Batch; Lane++) {
+      Input[Lane] = Data[Index + Lane].Buffer;
+      InputSize[Lane] = Data[Index + Lane].Size;
+      Output[Lane] = HashValue[Index + Lane];
+    }
+    if (mbedtls_accel_sha256_multi (Batch, Input, InputSize, Output) != 0) {
+      return FALSE;
+    }
+  }
+#else
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha256HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+#endif
+  return TRUE;
+}
@@ -2,17 +2,441 @@
   SHA3-256/384/512 and Shake-256 Digest Wrapper
   Implementation over MbedTls.
 
+  MbedTls 2.16 has no SHA3, so the Keccak-f[1600] permutation is
+  implemented here. The batch interfaces absorb several buffers side by
+  side with mbedtls_accel_keccak_absorb_multi() when the MbedTls build
+  provides it.
+
 Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
 #include "InternalCryptLib.h"
+#if defined(MBEDTLS_ACCEL_KECCAK_MULTI)
+#include <mbedtls/keccak_multi.h>
+
+//
+// Largest number of states mbedtls_accel_keccak_lanes() returns.
+//
+#define SHA3_MULTI_MAX_LANES  4
+#endif
+
+#define SHA3_STATE_SIZE  200
+#define SHA3_SUFFIX      0x06
+#define SHAKE_SUFFIX     0x1F
+
+#define SHA3_256_DIGEST_SIZE  32
+#define SHA3_384_DIGEST_SIZE  48
+#define SHA3_512_DIGEST_SIZE  64
+#define SHAKE256_DIGEST_SIZE  32
+
+//
+// The context of SHA3-256/384/512 and SHAKE256. Input bytes are XORed into
+// the state directly, so there is no block buffer. BufferSize counts the
+// bytes absorbed into the current block.
+//
+typedef struct {
+  UINT64  State[SHA3_STATE_SIZE / sizeof (UINT64)];
+  UINTN   BlockSize;
+  UINTN   DigestSize;
+  UINTN   BufferSize;
+  UINT8   Suffix;
+} SHA3_CONTEXT;
+
+STATIC CONST UINT64 mKeccakRoundConstants[24] = {
+  0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808AULL, 0x8000000080008000ULL,
+  0x000000000000808BULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+  0x000000000000008AULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000AULL,
+  0x000000008000808BULL, 0x800000000000008BULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+  0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800AULL, 0x800000008000000AULL,
+  0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+#define KECCAK_ROTL(x, n)  (((x) << (n)) | ((x) >> (64 - (n))))
+
+/**
+  Applies the Keccak-f[1600] permutation.
+
+  The 25 lanes stay in locals for all 24 rounds. Lanes 1, 2, 8, 12, 17 and
+  20 are held complemented ("lane complementing"), which turns 19 of the 25
+  NOTs of chi into plain AND or OR; the complement pattern of each row is
+  chosen so that the same lanes are complemented after every round.
+
+  @param[in, out]  State  The 25 lanes, lane x + 5 * y holding A[x][y].
+
+**/
+STATIC
+VOID
+KeccakF1600 (
+  IN OUT  UINT64  *State
+  )
+{
+  UINT64  A00, A01, A02, A03, A04, A05, A06, A07, A08, A09, A10, A11, A12;
+  UINT64  A13, A14, A15, A16, A17, A18, A19, A20, A21, A22, A23, A24;
+  UINT64  E00, E01, E02, E03, E04, E05, E06, E07, E08, E09, E10, E11, E12;
+  UINT64  E13, E14, E15, E16, E17, E18, E19, E20, E21, E22, E23, E24;
+  UINT64  C0, C1, C2, C3, C4;
+  UINT64  D0, D1, D2, D3, D4;
+  UINT64  B0, B1, B2, B3, B4;
+  UINTN   Round;
+
+  A00 = State[0];  A01 = ~State[1];  A02 = ~State[2];  A03 = State[3];  A04 = State[4];
+  A05 = State[5];  A06 = State[6];  A07 = State[7];  A08 = ~State[8];  A09 = State[9];
+  A10 = State[10];  A11 = State[11];  A12 = ~State[12];  A13 = State[13];  A14 = State[14];
+  A15 = State[15];  A16 = State[16];  A17 = ~State[17];  A18 = State[18];  A19 = State[19];
+  A20 = ~State[20];  A21 = State[21];  A22 = State[22];  A23 = State[23];  A24 = State[24];
+
+  for (Round = 0; Round < 24; Round++) {
+    //
+    // Theta.
+    //
+    C0 = A00 ^ A05 ^ A10 ^ A15 ^ A20;
+    C1 = A01 ^ A06 ^ A11 ^ A16 ^ A21;
+    C2 = A02 ^ A07 ^ A12 ^ A17 ^ A22;
+    C3 = A03 ^ A08 ^ A13 ^ A18 ^ A23;
+    C4 = A04 ^ A09 ^ A14 ^ A19 ^ A24;
+    D0 = C4 ^ KECCAK_ROTL (C1, 1);
+    D1 = C0 ^ KECCAK_ROTL (C2, 1);
+    D2 = C1 ^ KECCAK_ROTL (C3, 1);
+    D3 = C2 ^ KECCAK_ROTL (C4, 1);
+    D4 = C3 ^ KECCAK_ROTL (C0, 1);
+
+    //
+    // Rho and pi gather one output row into B0 ... B4, then chi and iota.
+    //
+    B0 = A00 ^ D0;
+    B1 = KECCAK_ROTL (A06 ^ D1, 44);
+    B2 = KECCAK_ROTL (A12 ^ D2, 43);
+    B3 = KECCAK_ROTL (A18 ^ D3, 21);
+    B4 = KECCAK_ROTL (A24 ^ D4, 14);
+    E00 = B0 ^ (B1 | B2) ^ mKeccakRoundConstants[Round];
+    E01 = B1 ^ (~B2 | B3);
+    E02 = B2 ^ (B3 & B4);
+    E03 = B3 ^ (B4 | B0);
+    E04 = B4 ^ (B0 & B1);
+
+    B0 = KECCAK_ROTL (A03 ^ D3, 28);
+    B1 = KECCAK_ROTL (A09 ^ D4, 20);
+    B2 = KECCAK_ROTL (A10 ^ D0, 3);
+    B3 = KECCAK_ROTL (A16 ^ D1, 45);
+    B4 = KECCAK_ROTL (A22 ^ D2, 61);
+    E05 = B0 ^ (B1 | B2);
+    E06 = B1 ^ (B2 & B3);
+    E07 = B2 ^ (B3 | ~B4);
+    E08 = B3 ^ (B4 | B0);
+    E09 = B4 ^ (B0 & B1);
+
+    B0 = KECCAK_ROTL (A01 ^ D1, 1);
+    B1 = KECCAK_ROTL (A07 ^ D2, 6);
+    B2 = KECCAK_ROTL (A13 ^ D3, 25);
+    B3 = KECCAK_ROTL (A19 ^ D4, 8);
+    B4 = KECCAK_ROTL (A20 ^ D0, 18);
+    E10 = B0 ^ (B1 | B2);
+    E11 = B1 ^ (B2 & B3);
+    E12 = B2 ^ (~B3 & B4);
+    E13 = ~B3 ^ (B4 | B0);
+    E14 = B4 ^ (B0 & B1);
+
+    B0 = KECCAK_ROTL (A04 ^ D4, 27);
+    B1 = KECCAK_ROTL (A05 ^ D0, 36);
+    B2 = KECCAK_ROTL (A11 ^ D1, 10);
+    B3 = KECCAK_ROTL (A17 ^ D2, 15);
+    B4 = KECCAK_ROTL (A23 ^ D3, 56);
+    E15 = B0 ^ (B1 & B2);
+    E16 = B1 ^ (B2 | B3);
+    E17 = B2 ^ (~B3 | B4);
+    E18 = ~B3 ^ (B4 & B0);
+    E19 = B4 ^ (B0 | B1);
+
+    B0 = KECCAK_ROTL (A02 ^ D2, 62);
+    B1 = KECCAK_ROTL (A08 ^ D3, 55);
+    B2 = KECCAK_ROTL (A14 ^ D4, 39);
+    B3 = KECCAK_ROTL (A15 ^ D0, 41);
+    B4 = KECCAK_ROTL (A21 ^ D1, 2);
+    E20 = B0 ^ (~B1 & B2);
+    E21 = ~B1 ^ (B2 | B3);
+    E22 = B2 ^ (B3 & B4);
+    E23 = B3 ^ (B4 | B0);
+    E24 = B4 ^ (B0 & B1);
+
+    A00 = E00;  A01 = E01;  A02 = E02;  A03 = E03;  A04 = E04;
+    A05 = E05;  A06 = E06;  A07 = E07;  A08 = E08;  A09 = E09;
+    A10 = E10;  A11 = E11;  A12 = E12;  A13 = E13;  A14 = E14;
+    A15 = E15;  A16 = E16;  A17 = E17;  A18 = E18;  A19 = E19;
+    A20 = E20;  A21 = E21;  A22 = E22;  A23 = E23;  A24 = E24;
+  }
+
+  State[0] = A00;  State[1] = ~A01;  State[2] = ~A02;  State[3] = A03;  State[4] = A04;
+  State[5] = A05;  State[6] = A06;  State[7] = A07;  State[8] = ~A08;  State[9] = A09;
+  State[10] = A10;  State[11] = A11;  State[12] = ~A12;  State[13] = A13;  State[14] = A14;
+  State[15] = A15;  State[16] = A16;  State[17] = ~A17;  State[18] = A18;  State[19] = A19;
+  State[20] = ~A20;  State[21] = A21;  State[22] = A22;  State[23] = A23;  State[24] = A24;
+}
+
+/**
+  Initializes a SHA3 or SHAKE context.
+
+  @param[out]  Context     The context.
+  @param[in]   DigestSize  The digest size in bytes; the rate is
+                           200 - 2 * DigestSize.
+  @param[in]   Suffix      The domain separation bits and the first padding bit.
+
+**/
+STATIC
+VOID
+Sha3ContextInit (
+  OUT  SHA3_CONTEXT  *Context,
+  IN   UINTN         DigestSize,
+  IN   UINT8         Suffix
+  )
+{
+  ZeroMem (Context, sizeof (SHA3_CONTEXT));
+  Context->BlockSize = SHA3_STATE_SIZE - 2 * DigestSize;
+  Context->DigestSize = DigestSize;
+  Context->Suffix = Suffix;
+}
+
+/**
+  Absorbs data into a SHA3 or SHAKE context.
+
+  Lane bytes are addressed through a byte pointer, which gives the Keccak
+  byte order on the little-endian CPUs this library supports.
+
+  @param[in, out]  Context   The context.
+  @param[in]       Data      The data.
+  @param[in]       DataSize  The size of Data in bytes.
+
+**/
+STATIC
+VOID
+Sha3ContextUpdate (
+  IN OUT  SHA3_CONTEXT  *Context,
+  IN      CONST UINT8   *Data,
+  IN      UINTN         DataSize
+  )
+{
+  UINT8   *StateBytes;
+  UINT64  Lane;
+  UINTN   Index;
+
+  StateBytes = (UINT8 *)Context->State;
+
+  while (Context->BufferSize != 0 && DataSize != 0) {
+    StateBytes[Context->BufferSize++] ^= *Data++;
+    DataSize--;
+    if (Context->BufferSize == Context->BlockSize) {
+      KeccakF1600 (Context->State);
+      Context->BufferSize = 0;
+    }
+  }
+
+  while (DataSize >= Context->BlockSize) {
+    for (Index = 0; Index < Context->BlockSize / sizeof (UINT64); Index++) {
+      CopyMem (&Lane, Data + Index * sizeof (UINT64), sizeof (UINT64));
+      Context->State[Index] ^= Lane;
+    }
+    KeccakF1600 (Context->State);
+    Data += Context->BlockSize;
+    DataSize -= Context->BlockSize;
+  }
+
+  while (DataSize != 0) {
+    StateBytes[Context->BufferSize++] ^= *Data++;
+    DataSize--;
+  }
+}
+
+/**
+  Pads the last block, applies the final permutation and squeezes the
+  digest. The context is cleared afterwards.
+
+  @param[in, out]  Context    The context.
+  @param[out]      HashValue  The digest, DigestSize bytes.
+
+**/
+STATIC
+VOID
+Sha3ContextFinal (
+  IN OUT  SHA3_CONTEXT  *Context,
+  OUT     UINT8         *HashValue
+  )
+{
+  UINT8  *StateBytes;
+
+  StateBytes = (UINT8 *)Context->State;
+  StateBytes[Context->BufferSize] ^= Context->Suffix;
+  StateBytes[Context->BlockSize - 1] ^= 0x80;
+  KeccakF1600 (Context->State);
+
+  //
+  // Every digest size used here fits in one block, so one squeeze is enough.
+  //
+  CopyMem (HashValue, StateBytes, Context->DigestSize);
+  ZeroMem (Context, sizeof (SHA3_CONTEXT));
+}
+
+/**
+  Computes the SHA3 or SHAKE digest of a buffer.
+
+  @param[in]   Data        The data.
+  @param[in]   DataSize    The size of Data in bytes.
+  @param[in]   DigestSize  The digest size in bytes.
+  @param[in]   Suffix      The domain separation bits.
+  @param[out]  HashValue   The digest.
+
+  @retval TRUE   The digest was computed.
+  @retval FALSE  A parameter is invalid.
+
+**/
+STATIC
+BOOLEAN
+Sha3HashAllInternal (
+  IN   CONST VOID  *Data,
+  IN   UINTN       DataSize,
+  IN   UINTN       DigestSize,
+  IN   UINT8       Suffix,
+  OUT  UINT8       *HashValue
+  )
+{
+  SHA3_CONTEXT  Context;
+
+  if (HashValue == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+
+  Sha3ContextInit (&Context, DigestSize, Suffix);
+  Sha3ContextUpdate (&Context, Data, DataSize);
+  Sha3ContextFinal (&Context, HashValue);
+  return TRUE;
+}
 
 /**
-  Retrieves the size, in bytes, of the context buffer required for SHA-256 hash operations.
+  Computes the SHA3 digests of several independent buffers.
 
-  @return  The size, in bytes, of the context buffer required for SHA-256 hash operations.
+  With MBEDTLS_ACCEL_KECCAK_MULTI, the whole blocks that every buffer of a
+  batch has in common are absorbed side by side, and the rest of each
+  buffer is absorbed and padded on its own. Otherwise, or when the CPU has
+  no multi-lane kernel, the buffers are hashed one by one.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers.
+  @param[in]   DigestSize  The digest size in bytes.
+  @param[in]   HashValue   Array of Count pointers to the digests.
+
+  @retval TRUE   The digests were computed.
+  @retval FALSE  A parameter is invalid.
+
+**/
+STATIC
+BOOLEAN
+Sha3HashAllMultiInternal (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINTN                     DigestSize,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN                Index;
+#if defined(MBEDTLS_ACCEL_KECCAK_MULTI)
+  SHA3_CONTEXT         Context[SHA3_MULTI_MAX_LANES];
+  uint64_t             *State[SHA3_MULTI_MAX_LANES];
+  CONST unsigned char  *Input[SHA3_MULTI_MAX_LANES];
+  UINTN                Lanes;
+  UINTN                Batch;
+  UINTN                Lane;
+  UINTN                Blocks;
+  UINTN                Absorbed;
+#endif
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+  for (Index = 0; Index < Count; Index++) {
+    if (HashValue[Index] == NULL) {
+      return FALSE;
+    }
+    if (Data[Index].Buffer == NULL && Data[Index].Size != 0) {
+      return FALSE;
+    }
+  }
+
+#if defined(MBEDTLS_ACCEL_KECCAK_MULTI)
+  Lanes = MIN (mbedtls_accel_keccak_lanes (), SHA3_MULTI_MAX_LANES);
+  if (Lanes >= 2) {
+    for (Index = 0; Index < Count; Index += Batch) {
+      Batch = MIN (Count - Index, Lanes);
+      Blocks = MAX_UINTN;
+      for (Lane = 0; Lane < Batch; Lane++) {
+        Sha3ContextInit (&Context[Lane], DigestSize, SHA3_SUFFIX);
+        State[Lane] = (uint64_t *)Context[Lane].State;
+        Input[Lane] = Data[Index + Lane].Buffer;
+        Blocks = MIN (Blocks, Data[Index + Lane].Size / Context[Lane].BlockSize);
+      }
+      mbedtls_accel_keccak_absorb_multi (Batch, State, Input, Context[0].BlockSize, Blocks);
+
+      Absorbed = Blocks * Context[0].BlockSize;
+      for (Lane = 0; Lane < Batch; Lane++) {
+        Sha3ContextUpdate (
+          &Context[Lane],
+          (CONST UINT8 *)Data[Index + Lane].Buffer + Absorbed,
+          Data[Index + Lane].Size - Absorbed
+          );
+        Sha3ContextFinal (&Context[Lane], HashValue[Index + Lane]);
+      }
+    }
+    return TRUE;
+  }
+#endif
+
+  for (Index = 0; Index < Count; Index++) {
+    Sha3HashAllInternal (Data[Index].Buffer, Data[Index].Size, DigestSize, SHA3_SUFFIX, HashValue[Index]);
+  }
+  return TRUE;
+}
+
+/**
+  Allocates one SHA3-256 context for subsequent use.
+  The context must be initialized by Sha3_256Init() before it is used.
+
+  @return  Pointer to the SHA3-256 context that has been allocated.
+           If the allocations fails, Sha3_256New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_256New (
+  VOID
+  )
+{
+  return AllocateZeroPool (sizeof (SHA3_CONTEXT));
+}
+
+/**
+  Release the specified SHA3-256 context.
+
+  @param[in]  Sha3_256Context  Pointer to the SHA3-256 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_256Free (
+  IN  VOID  *Sha3_256Context
+  )
+{
+  if (Sha3_256Context == NULL) {
+    return;
+  }
+  FreePool (Sha3_256Context);
+}
+
+/**
+  Retrieves the size, in bytes, of the context buffer required for SHA3-256 hash operations.
+
+  @return  The size, in bytes, of the context buffer required for SHA3-256 hash operations.
 
 **/
 UINTN
@@ -21,7 +445,7 @@ Sha3_256GetContextSize (
   VOID
   )
 {
-  return 0;
+  return (UINTN) (sizeof (SHA3_CONTEXT));
 }
 
 /**
@@ -42,7 +466,12 @@ Sha3_256Init (
   OUT  VOID  *Sha3_256Context
   )
 {
-  return FALSE;
+  if (Sha3_256Context == NULL) {
+    return FALSE;
+  }
+
+  Sha3ContextInit (Sha3_256Context, SHA3_256_DIGEST_SIZE, SHA3_SUFFIX);
+  return TRUE;
 }
 
 /**
@@ -67,7 +496,12 @@ Sha3_256Duplicate (
   OUT  VOID        *NewSha3_256Context
   )
 {
-  return FALSE;
+  if (Sha3_256Context == NULL || NewSha3_256Context == NULL) {
+    return FALSE;
+  }
+
+  CopyMem (NewSha3_256Context, Sha3_256Context, sizeof (SHA3_CONTEXT));
+  return TRUE;
 }
 
 /**
@@ -96,7 +530,15 @@ Sha3_256Update (
   IN      UINTN       DataSize
   )
 {
-  return FALSE;
+  if (Sha3_256Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+
+  Sha3ContextUpdate (Sha3_256Context, Data, DataSize);
+  return TRUE;
 }
 
 /**
@@ -126,7 +568,12 @@ Sha3_256Final (
   OUT     UINT8  *HashValue
   )
 {
-  return FALSE;
+  if (Sha3_256Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+
+  Sha3ContextFinal (Sha3_256Context, HashValue);
+  return TRUE;
 }
 
 /**
@@ -155,13 +602,77 @@ Sha3_256HashAll (
   OUT  UINT8       *HashValue
   )
 {
-  return FALSE;
+  return Sha3HashAllInternal (Data, DataSize, SHA3_256_DIGEST_SIZE, SHA3_SUFFIX, HashValue);
 }
 
 /**
-  Retrieves the size, in bytes, of the context buffer required for SHA-384 hash operations.
+  Computes the SHA3-256 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_256HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
 
-  @return  The size, in bytes, of the context buffer required for SHA-384 hash operations.
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-256 digest values (256 / 8 bytes each).
+
+  @retval TRUE   SHA3-256 digest computation succeeded.
+  @retval FALSE  SHA3-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_256HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  return Sha3HashAllMultiInternal (Count, Data, SHA3_256_DIGEST_SIZE, HashValue);
+}
+
+/**
+  Allocates one SHA3-384 context for subsequent use.
+  The context must be initialized by Sha3_384Init() before it is used.
+
+  @return  Pointer to the SHA3-384 context that has been allocated.
+           If the allocations fails, Sha3_384New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_384New (
+  VOID
+  )
+{
+  return AllocateZeroPool (sizeof (SHA3_CONTEXT));
+}
+
+/**
+  Release the specified SHA3-384 context.
+
+  @param[in]  Sha3_384Context  Pointer to the SHA3-384 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_384Free (
+  IN  VOID  *Sha3_384Context
+  )
+{
+  if (Sha3_384Context == NULL) {
+    return;
+  }
+  FreePool (Sha3_384Context);
+}
+
+/**
+  Retrieves the size, in bytes, of the context buffer required for SHA3-384 hash operations.
+
+  @return  The size, in bytes, of the context buffer required for SHA3-384 hash operations.
 
 **/
 UINTN
@@ -170,7 +681,7 @@ Sha3_384GetContextSize (
   VOID
   )
 {
-  return 0;
+  return (UINTN) (sizeof (SHA3_CONTEXT));
 }
 
 /**
@@ -191,7 +702,12 @@ Sha3_384Init (
   OUT  VOID  *Sha3_384Context
   )
 {
-  return FALSE;
+  if (Sha3_384Context == NULL) {
+    return FALSE;
+  }
+
+  Sha3ContextInit (Sha3_384Context, SHA3_384_DIGEST_SIZE, SHA3_SUFFIX);
+  return TRUE;
 }
 
 /**
@@ -216,7 +732,12 @@ Sha3_384Duplicate (
   OUT  VOID        *NewSha3_384Context
   )
 {
-  return FALSE;
+  if (Sha3_384Context == NULL || NewSha3_384Context == NULL) {
+    return FALSE;
+  }
+
+  CopyMem (NewSha3_384Context, Sha3_384Context, sizeof (SHA3_CONTEXT));
+  return TRUE;
 }
 
 /**
@@ -245,7 +766,15 @@ Sha3_384Update (
   IN      UINTN       DataSize
   )
 {
-  return FALSE;
+  if (Sha3_384Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+
+  Sha3ContextUpdate (Sha3_384Context, Data, DataSize);
+  return TRUE;
 }
 
 /**
@@ -275,7 +804,12 @@ Sha3_384Final (
   OUT     UINT8  *HashValue
   )
 {
-  return FALSE;
+  if (Sha3_384Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+
+  Sha3ContextFinal (Sha3_384Context, HashValue);
+  return TRUE;
 }
 
 /**
@@ -304,7 +838,71 @@ Sha3_384HashAll (
   OUT  UINT8       *HashValue
   )
 {
-  return FALSE;
+  return Sha3HashAllInternal (Data, DataSize, SHA3_384_DIGEST_SIZE, SHA3_SUFFIX, HashValue);
+}
+
+/**
+  Computes the SHA3-384 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_384HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-384 digest values (384 / 8 bytes each).
+
+  @retval TRUE   SHA3-384 digest computation succeeded.
+  @retval FALSE  SHA3-384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_384HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  return Sha3HashAllMultiInternal (Count, Data, SHA3_384_DIGEST_SIZE, HashValue);
+}
+
+/**
+  Allocates one SHA3-512 context for subsequent use.
+  The context must be initialized by Sha3_512Init() before it is used.
+
+  @return  Pointer to the SHA3-512 context that has been allocated.
+           If the allocations fails, Sha3_512New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_512New (
+  VOID
+  )
+{
+  return AllocateZeroPool (sizeof (SHA3_CONTEXT));
+}
+
+/**
+  Release the specified SHA3-512 context.
+
+  @param[in]  Sha3_512Context  Pointer to the SHA3-512 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_512Free (
+  IN  VOID  *Sha3_512Context
+  )
+{
+  if (Sha3_512Context == NULL) {
+    return;
+  }
+  FreePool (Sha3_512Context);
 }
 
 /**
@@ -319,7 +917,7 @@ Sha3_512GetContextSize (
   VOID
   )
 {
-  return 0;
+  return (UINTN) (sizeof (SHA3_CONTEXT));
 }
 
 /**
@@ -340,7 +938,12 @@ Sha3_512Init (
   OUT  VOID  *Sha3_512Context
   )
 {
-  return FALSE;
+  if (Sha3_512Context == NULL) {
+    return FALSE;
+  }
+
+  Sha3ContextInit (Sha3_512Context, SHA3_512_DIGEST_SIZE, SHA3_SUFFIX);
+  return TRUE;
 }
 
 /**
@@ -365,7 +968,12 @@ Sha3_512Duplicate (
   OUT  VOID        *NewSha3_512Context
   )
 {
-  return FALSE;
+  if (Sha3_512Context == NULL || NewSha3_512Context == NULL) {
+    return FALSE;
+  }
+
+  CopyMem (NewSha3_512Context, Sha3_512Context, sizeof (SHA3_CONTEXT));
+  return TRUE;
 }
 
 /**
@@ -394,7 +1002,15 @@ Sha3_512Update (
   IN      UINTN       DataSize
   )
 {
-  return FALSE;
+  if (Sha3_512Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+
+  Sha3ContextUpdate (Sha3_512Context, Data, DataSize);
+  return TRUE;
 }
 
 /**
@@ -424,7 +1040,12 @@ Sha3_512Final (
   OUT     UINT8  *HashValue
   )
 {
-  return FALSE;
+  if (Sha3_512Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+
+  Sha3ContextFinal (Sha3_512Context, HashValue);
+  return TRUE;
 }
 
 /**
@@ -453,7 +1074,36 @@ Sha3_512HashAll (
   OUT  UINT8       *HashValue
   )
 {
-  return FALSE;
+  return Sha3HashAllInternal (Data, DataSize, SHA3_512_DIGEST_SIZE, SHA3_SUFFIX, HashValue);
+}
+
+/**
+  Computes the SHA3-512 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_512HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-512 digest values (512 / 8 bytes each).
+
+  @retval TRUE   SHA3-512 digest computation succeeded.
+  @retval FALSE  SHA3-512 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_512HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  return Sha3HashAllMultiInternal (Count, Data, SHA3_512_DIGEST_SIZE, HashValue);
 }
 
 /**
@@ -468,7 +1118,7 @@ Shake256GetContextSize (
   VOID
   )
 {
-  return 0;
+  return (UINTN) (sizeof (SHA3_CONTEXT));
 }
 
 /**
@@ -489,7 +1139,12 @@ Shake256Init (
   OUT  VOID  *Shake256Context
   )
 {
-  return FALSE;
+  if (Shake256Context == NULL) {
+    return FALSE;
+  }
+
+  Sha3ContextInit (Shake256Context, SHAKE256_DIGEST_SIZE, SHAKE_SUFFIX);
+  return TRUE;
 }
 
 /**
@@ -514,7 +1169,12 @@ Shake256Duplicate (
   OUT  VOID        *NewShake256Context
   )
 {
-  return FALSE;
+  if (Shake256Context == NULL || NewShake256Context == NULL) {
+    return FALSE;
+  }
+
+  CopyMem (NewShake256Context, Shake256Context, sizeof (SHA3_CONTEXT));
+  return TRUE;
 }
 
 /**
@@ -543,7 +1203,15 @@ Shake256Update (
   IN      UINTN       DataSize
   )
 {
-  return FALSE;
+  if (Shake256Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+
+  Sha3ContextUpdate (Shake256Context, Data, DataSize);
+  return TRUE;
 }
 
 /**
@@ -573,7 +1241,12 @@ Shake256Final (
   OUT     UINT8  *HashValue
   )
 {
-  return FALSE;
+  if (Shake256Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+
+  Sha3ContextFinal (Shake256Context, HashValue);
+  return TRUE;
 }
 
 /**
@@ -602,5 +1275,5 @@ Shake256HashAll (
   OUT  UINT8       *HashValue
   )
 {
-  return FALSE;
+  return Sha3HashAllInternal (Data, DataSize, SHAKE256_DIGEST_SIZE, SHAKE_SUFFIX, HashValue);
 }
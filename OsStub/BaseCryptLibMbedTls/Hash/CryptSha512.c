@@ -9,6 +9,42 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "InternalCryptLib.h"
 #include <mbedtls/sha512.h>
 
+/**
+  Allocates one SHA-384 context for subsequent use.
+  The context must be initialized by Sha384Init() before it is used.
+
+  @return  Pointer to the SHA-384 context that has been allocated.
+           If the allocations fails, Sha384New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha384New (
+  VOID
+  )
+{
+  return AllocateZeroPool (sizeof (mbedtls_sha512_context));
+}
+
+/**
+  Release the specified SHA-384 context.
+
+  @param[in]  Sha384Context  Pointer to the SHA-384 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha384Free (
+  IN  VOID  *Sha384Context
+  )
+{
+  if (Sha384Context == NULL) {
+    return;
+  }
+  mbedtls_sha512_free (Sha384Context);
+  FreePool (Sha384Context);
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-384 hash operations.
 
@@ -220,6 +256,82 @@ Sha384HashAll (
   return TRUE;
 }
 
+/**
+  Computes the SHA-384 message digests of several independent data buffers.
+
+  The result is the same as calling Sha384HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA-384 digest values (48 bytes each).
+
+  @retval TRUE   SHA-384 digest computation succeeded.
+  @retval FALSE  SHA-384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha384HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Allocates one SHA-512 context for subsequent use.
+  The context must be initialized by Sha512Init() before it is used.
+
+  @return  Pointer to the SHA-512 context that has been allocated.
+           If the allocations fails, Sha512New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha512New (
+  VOID
+  )
+{
+  return AllocateZeroPool (sizeof (mbedtls_sha512_context));
+}
+
+/**
+  Release the specified SHA-512 context.
+
+  @param[in]  Sha512Context  Pointer to the SHA-512 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha512Free (
+  IN  VOID  *Sha512Context
+  )
+{
+  if (Sha512Context == NULL) {
+    return;
+  }
+  mbedtls_sha512_free (Sha512Context);
+  FreePool (Sha512Context);
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-512 hash operations.
 
@@ -42,7 +42,11 @@ HmacMdFree (
   IN  VOID  *HmacMdCtx
   )
 {
+  if (HmacMdCtx == NULL) {
+    return ;
+  }
   mbedtls_md_free (HmacMdCtx);
+  FreePool (HmacMdCtx);
 }
 
 /**
@@ -118,6 +122,16 @@ HmacMdDuplicate (
     return FALSE;
   }
 
+  //
+  // mbedtls_md_clone() requires the destination to be set up with the same digest.
+  //
+  if (((mbedtls_md_context_t *)NewHmacMdContext)->md_info == NULL) {
+    Ret = mbedtls_md_setup (NewHmacMdContext, ((CONST mbedtls_md_context_t *)HmacMdContext)->md_info, 1);
+    if (Ret != 0) {
+      return FALSE;
+    }
+  }
+
   Ret = mbedtls_md_clone (NewHmacMdContext, HmacMdContext);
   if (Ret != 0) {
     return FALSE;
@@ -123,6 +123,8 @@ RsaGetPrivateKeyFromPem (
   return TRUE;
 }
 
+#ifndef BASE_CRYPT_LIB_PSA
+
 /**
   Retrieve the EC Private Key from the password-protected PEM key data.
 
@@ -216,6 +218,31 @@ EcGetPrivateKeyFromPem (
   return TRUE;
 }
 
+/**
+  Retrieve the EC Private Key held by the crypto implementation, such as a persistent key
+  provisioned in a secure element.
+
+  This interface is not supported, so it always returns FALSE.
+
+  @param[in]  KeyId        The key identifier of the crypto implementation.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which refer to the
+                           EC private key.
+
+  @retval  FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPrivateKeyFromKeyId (
+  IN   UINT32       KeyId,
+  OUT  VOID         **EcContext
+  )
+{
+  return FALSE;
+}
+
+#endif
+
 
 /**
   Retrieve the Ed Private Key from the password-protected PEM key data.
@@ -19,6 +19,114 @@ static const unsigned char mffehde2048_G[] = MBEDTLS_DHM_RFC7919_FFDHE2048_G_BIN
 static const unsigned char mffehde3072_G[] = MBEDTLS_DHM_RFC7919_FFDHE3072_G_BIN;
 static const unsigned char mffehde4096_G[] = MBEDTLS_DHM_RFC7919_FFDHE4096_G_BIN;
 
+//
+// An FFDHE group of RFC 7919, parsed, checked and with its Montgomery constant computed once,
+// and copied to each DH context of the group.
+// PrivateKeySize is the size in bytes of the private exponent. RFC 7919 section 5.2 allows a
+// short exponent of twice the security level of the group: 225, 275 and 325 bits.
+//
+typedef struct {
+  UINTN                Nid;
+  CONST UINT8          *P;
+  UINTN                PSize;
+  CONST UINT8          *G;
+  UINTN                GSize;
+  UINTN                PrivateKeySize;
+  BOOLEAN              Ready;
+  mbedtls_mpi          CachedP;
+  mbedtls_mpi          CachedG;
+  mbedtls_mpi          CachedRP;
+} FFDHE_GROUP;
+
+STATIC FFDHE_GROUP mFfdheGroup[] = {
+  {CRYPTO_NID_FFDHE2048, mffehde2048_P, sizeof(mffehde2048_P), mffehde2048_G, sizeof(mffehde2048_G), (225 + 7) / 8},
+  {CRYPTO_NID_FFDHE3072, mffehde3072_P, sizeof(mffehde3072_P), mffehde3072_G, sizeof(mffehde3072_G), (275 + 7) / 8},
+  {CRYPTO_NID_FFDHE4096, mffehde4096_P, sizeof(mffehde4096_P), mffehde4096_G, sizeof(mffehde4096_G), (325 + 7) / 8},
+};
+
+/**
+  Return the FFDHE group of the NID, with its cached parameters.
+
+  The parameters are parsed and checked on first use.
+
+  @param Nid cipher NID
+
+  @return  Pointer to the FFDHE group, or NULL if the NID is not an FFDHE group or its parameters are invalid.
+
+**/
+STATIC
+FFDHE_GROUP *
+GetFfdheGroup (
+  IN UINTN  Nid
+  )
+{
+  FFDHE_GROUP  *Group;
+  mbedtls_mpi  One;
+  mbedtls_mpi  Tmp;
+  UINTN        Index;
+  INT32        Ret;
+
+  Group = NULL;
+  for (Index = 0; Index < ARRAY_SIZE(mFfdheGroup); Index++) {
+    if (mFfdheGroup[Index].Nid == Nid) {
+      Group = &mFfdheGroup[Index];
+      break;
+    }
+  }
+  if (Group == NULL) {
+    return NULL;
+  }
+  if (Group->Ready) {
+    return Group;
+  }
+
+  mbedtls_mpi_init (&Group->CachedP);
+  mbedtls_mpi_init (&Group->CachedG);
+  mbedtls_mpi_init (&Group->CachedRP);
+  mbedtls_mpi_init (&One);
+  mbedtls_mpi_init (&Tmp);
+  Ret = mbedtls_mpi_read_binary (&Group->CachedP, Group->P, Group->PSize);
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_read_binary (&Group->CachedG, Group->G, Group->GSize);
+  }
+  //
+  // The prime is odd and of full size, and the generator is in [2, P - 2].
+  //
+  if (Ret == 0) {
+    if (mbedtls_mpi_size (&Group->CachedP) != Group->PSize || mbedtls_mpi_get_bit (&Group->CachedP, 0) != 1 ||
+        mbedtls_mpi_cmp_int (&Group->CachedG, 2) < 0) {
+      Ret = MBEDTLS_ERR_DHM_BAD_INPUT_DATA;
+    }
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_sub_int (&Tmp, &Group->CachedP, 2);
+  }
+  if (Ret == 0) {
+    if (mbedtls_mpi_cmp_mpi (&Group->CachedG, &Tmp) > 0) {
+      Ret = MBEDTLS_ERR_DHM_BAD_INPUT_DATA;
+    }
+  }
+  //
+  // The first exponentiation computes the Montgomery constant R^2 mod P into CachedRP.
+  //
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_lset (&One, 1);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_exp_mod (&Tmp, &Group->CachedG, &One, &Group->CachedP, &Group->CachedRP);
+  }
+  mbedtls_mpi_free (&One);
+  mbedtls_mpi_free (&Tmp);
+  if (Ret != 0) {
+    mbedtls_mpi_free (&Group->CachedP);
+    mbedtls_mpi_free (&Group->CachedG);
+    mbedtls_mpi_free (&Group->CachedRP);
+    return NULL;
+  }
+  Group->Ready = TRUE;
+  return Group;
+}
+
 /**
   Allocates and Initializes one Diffie-Hellman Context for subsequent use
   with the NID.
@@ -36,8 +144,14 @@ DhNewByNid (
   )
 {
   mbedtls_dhm_context *ctx;
+  FFDHE_GROUP         *Group;
   INT32               Ret;
 
+  Group = GetFfdheGroup (Nid);
+  if (Group == NULL) {
+    return NULL;
+  }
+
   ctx = AllocateZeroPool (sizeof(mbedtls_dhm_context));
   if (ctx == NULL) {
     return NULL;
@@ -45,43 +159,22 @@ DhNewByNid (
 
   mbedtls_dhm_init (ctx);
 
-  switch (Nid) {
-  case CRYPTO_NID_FFDHE2048:
-    Ret = mbedtls_mpi_read_binary (&ctx->P, mffehde2048_P, sizeof(mffehde2048_P));
-    if (Ret != 0) {
-      goto Error;
-    }
-    Ret = mbedtls_mpi_read_binary (&ctx->G, mffehde2048_G, sizeof(mffehde2048_G));
-    if (Ret != 0) {
-      goto Error;
-    }
-    break;
-  case CRYPTO_NID_FFDHE3072:
-    Ret = mbedtls_mpi_read_binary (&ctx->P, mffehde3072_P, sizeof(mffehde3072_P));
-    if (Ret != 0) {
-      goto Error;
-    }
-    Ret = mbedtls_mpi_read_binary (&ctx->G, mffehde3072_G, sizeof(mffehde3072_G));
-    if (Ret != 0) {
-      goto Error;
-    }
-    break;
-  case CRYPTO_NID_FFDHE4096:
-    Ret = mbedtls_mpi_read_binary (&ctx->P, mffehde4096_P, sizeof(mffehde4096_P));
-    if (Ret != 0) {
-      goto Error;
-    }
-    Ret = mbedtls_mpi_read_binary (&ctx->G, mffehde4096_G, sizeof(mffehde4096_G));
-    if (Ret != 0) {
-      goto Error;
-    }
-    break;
-  default:
+  Ret = mbedtls_mpi_copy (&ctx->P, &Group->CachedP);
+  if (Ret != 0) {
+    goto Error;
+  }
+  Ret = mbedtls_mpi_copy (&ctx->G, &Group->CachedG);
+  if (Ret != 0) {
+    goto Error;
+  }
+  Ret = mbedtls_mpi_copy (&ctx->RP, &Group->CachedRP);
+  if (Ret != 0) {
     goto Error;
   }
   ctx->len = mbedtls_mpi_size (&ctx->P);
   return ctx;
 Error:
+  mbedtls_dhm_free (ctx);
   FreePool (ctx);
   return NULL;
 }
@@ -207,6 +300,7 @@ DhGenerateKey (
 {
   INT32               Ret;
   mbedtls_dhm_context *ctx;
+  FFDHE_GROUP         *Group;
   UINTN               FinalPubKeySize;
 
   //
@@ -224,16 +318,22 @@ DhGenerateKey (
   switch (mbedtls_mpi_size (&ctx->P)) {
   case 256:
     FinalPubKeySize = 256;
+    Group = GetFfdheGroup (CRYPTO_NID_FFDHE2048);
     break;
   case 384:
     FinalPubKeySize = 384;
+    Group = GetFfdheGroup (CRYPTO_NID_FFDHE3072);
     break;
   case 512:
     FinalPubKeySize = 512;
+    Group = GetFfdheGroup (CRYPTO_NID_FFDHE4096);
     break;
   default:
     return FALSE;
   }
+  if (Group == NULL) {
+    return FALSE;
+  }
   if (*PublicKeySize < FinalPubKeySize) {
     *PublicKeySize = FinalPubKeySize;
     return FALSE;
@@ -241,7 +341,7 @@ DhGenerateKey (
   *PublicKeySize = FinalPubKeySize;
   ZeroMem (PublicKey, *PublicKeySize);
 
-  Ret = mbedtls_dhm_make_public (DhContext, (UINT32)*PublicKeySize, PublicKey, (UINT32)*PublicKeySize, myrand, NULL);
+  Ret = mbedtls_dhm_make_public (DhContext, (UINT32)Group->PrivateKeySize, PublicKey, (UINT32)*PublicKeySize, myrand, NULL);
   if (Ret != 0) {
     return FALSE;
   }
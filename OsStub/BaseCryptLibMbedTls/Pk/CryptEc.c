@@ -685,3 +685,301 @@ EcDsaVerify (
 
   return TRUE;
 }
+
+//
+// A public key prepared for repeated EC-DSA verification.
+// PublicKeyGroup is the curve with the public key point as its generator.
+// mbedtls_ecp_mul() keeps the precomputed multiples of the generator in its group,
+// so that both groups compute them once.
+// A loaded group refers to the static curve data, which mbedtls_ecp_group_free() does not free,
+// so the generator of PublicKeyGroup is freed separately once it is replaced.
+//
+typedef struct {
+  mbedtls_ecp_group  Group;
+  mbedtls_ecp_group  PublicKeyGroup;
+  BOOLEAN            PublicKeyGeneratorSet;
+  UINTN              HalfSize;
+} EC_PREPARED_PUBLIC_KEY;
+
+/**
+  Release the specified prepared public key.
+
+  @param[in]  PreparedKey  Pointer to the prepared public key to be released.
+
+**/
+VOID
+EFIAPI
+EcDsaFreePreparedPublicKey (
+  IN  VOID         *PreparedKey
+  )
+{
+  EC_PREPARED_PUBLIC_KEY  *Prepared;
+
+  if (PreparedKey == NULL) {
+    return ;
+  }
+  Prepared = PreparedKey;
+  if (Prepared->PublicKeyGeneratorSet) {
+    mbedtls_ecp_point_free (&Prepared->PublicKeyGroup.G);
+  }
+  mbedtls_ecp_group_free (&Prepared->Group);
+  mbedtls_ecp_group_free (&Prepared->PublicKeyGroup);
+  FreePool (Prepared);
+}
+
+/**
+  Prepares the public key of an EC context for repeated EC-DSA verification.
+
+  The prepared public key holds precomputed multiples of the public key point and of
+  the curve generator, so that EcDsaVerifyPrepared() is faster than EcDsaVerify().
+  It does not refer to EcContext, which may be released before the prepared public key.
+
+  If EcContext is NULL, then return NULL.
+
+  @param[in]  EcContext    Pointer to EC context holding the public key.
+
+  @return  Pointer to the prepared public key.
+           If the public key is invalid or the allocations fails, EcDsaPreparePublicKey() returns NULL.
+
+**/
+VOID *
+EFIAPI
+EcDsaPreparePublicKey (
+  IN  VOID         *EcContext
+  )
+{
+  mbedtls_ecdh_context    *ctx;
+  EC_PREPARED_PUBLIC_KEY  *Prepared;
+  mbedtls_mpi             One;
+  mbedtls_ecp_point       Point;
+  INT32                   Ret;
+
+  if (EcContext == NULL) {
+    return NULL;
+  }
+
+  ctx = EcContext;
+  if (mbedtls_ecp_check_pubkey (&ctx->grp, &ctx->Q) != 0) {
+    return NULL;
+  }
+
+  Prepared = AllocateZeroPool (sizeof(EC_PREPARED_PUBLIC_KEY));
+  if (Prepared == NULL) {
+    return NULL;
+  }
+  mbedtls_ecp_group_init (&Prepared->Group);
+  mbedtls_ecp_group_init (&Prepared->PublicKeyGroup);
+  switch (ctx->grp.id) {
+  case MBEDTLS_ECP_DP_SECP256R1:
+    Prepared->HalfSize = 32;
+    break;
+  case MBEDTLS_ECP_DP_SECP384R1:
+    Prepared->HalfSize = 48;
+    break;
+  case MBEDTLS_ECP_DP_SECP521R1:
+    Prepared->HalfSize = 66;
+    break;
+  default:
+    EcDsaFreePreparedPublicKey (Prepared);
+    return NULL;
+  }
+
+  mbedtls_mpi_init (&One);
+  mbedtls_ecp_point_init (&Point);
+  Ret = mbedtls_ecp_group_load (&Prepared->Group, ctx->grp.id);
+  if (Ret == 0) {
+    Ret = mbedtls_ecp_group_load (&Prepared->PublicKeyGroup, ctx->grp.id);
+  }
+  if (Ret == 0) {
+    mbedtls_ecp_point_init (&Prepared->PublicKeyGroup.G);
+    Prepared->PublicKeyGeneratorSet = TRUE;
+    Ret = mbedtls_ecp_copy (&Prepared->PublicKeyGroup.G, &ctx->Q);
+  }
+  //
+  // A multiplication of the generator computes and keeps its precomputed multiples.
+  //
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_lset (&One, 1);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_ecp_mul (&Prepared->Group, &Point, &One, &Prepared->Group.G, NULL, NULL);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_ecp_mul (&Prepared->PublicKeyGroup, &Point, &One, &Prepared->PublicKeyGroup.G, NULL, NULL);
+  }
+  mbedtls_mpi_free (&One);
+  mbedtls_ecp_point_free (&Point);
+  if (Ret != 0) {
+    EcDsaFreePreparedPublicKey (Prepared);
+    return NULL;
+  }
+  return Prepared;
+}
+
+/**
+  Verifies the EC-DSA signature with a prepared public key.
+
+  The result is the same as EcDsaVerify() with the EC context the public key is prepared from.
+
+  If PreparedKey is NULL, then return FALSE.
+  If MessageHash is NULL, then return FALSE.
+  If Signature is NULL, then return FALSE.
+  If HashSize need match the HashNid. HashNid could be SHA256, SHA384, SHA512.
+
+  @param[in]  PreparedKey  Pointer to the prepared public key for signature verification.
+  @param[in]  HashNid      hash NID
+  @param[in]  MessageHash  Pointer to octet message hash to be checked.
+  @param[in]  HashSize     Size of the message hash in bytes.
+  @param[in]  Signature    Pointer to EC-DSA signature to be verified.
+  @param[in]  SigSize      Size of signature in bytes.
+
+  @retval  TRUE   Valid signature encoded in EC-DSA.
+  @retval  FALSE  Invalid signature or invalid prepared public key.
+
+**/
+BOOLEAN
+EFIAPI
+EcDsaVerifyPrepared (
+  IN  VOID         *PreparedKey,
+  IN  UINTN        HashNid,
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize
+  )
+{
+  EC_PREPARED_PUBLIC_KEY  *Prepared;
+  mbedtls_ecp_group       *grp;
+  mbedtls_mpi             R;
+  mbedtls_mpi             S;
+  mbedtls_mpi             E;
+  mbedtls_mpi             W;
+  mbedtls_mpi             U1;
+  mbedtls_mpi             U2;
+  mbedtls_mpi             One;
+  mbedtls_ecp_point       Point1;
+  mbedtls_ecp_point       Point2;
+  INT32                   Ret;
+
+  if (PreparedKey == NULL || MessageHash == NULL || Signature == NULL) {
+    return FALSE;
+  }
+
+  Prepared = PreparedKey;
+  grp = &Prepared->Group;
+  if (SigSize != Prepared->HalfSize * 2) {
+    return FALSE;
+  }
+
+  switch (HashNid) {
+  case CRYPTO_NID_SHA256:
+    if (HashSize != SHA256_DIGEST_SIZE) {
+      return FALSE;
+    }
+    break;
+
+  case CRYPTO_NID_SHA384:
+    if (HashSize != SHA384_DIGEST_SIZE) {
+      return FALSE;
+    }
+    break;
+
+  case CRYPTO_NID_SHA512:
+    if (HashSize != SHA512_DIGEST_SIZE) {
+      return FALSE;
+    }
+    break;
+
+  default:
+    return FALSE;
+  }
+
+  mbedtls_mpi_init (&R);
+  mbedtls_mpi_init (&S);
+  mbedtls_mpi_init (&E);
+  mbedtls_mpi_init (&W);
+  mbedtls_mpi_init (&U1);
+  mbedtls_mpi_init (&U2);
+  mbedtls_mpi_init (&One);
+  mbedtls_ecp_point_init (&Point1);
+  mbedtls_ecp_point_init (&Point2);
+
+  Ret = mbedtls_mpi_read_binary (&R, Signature, Prepared->HalfSize);
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_read_binary (&S, Signature + Prepared->HalfSize, Prepared->HalfSize);
+  }
+  //
+  // R and S must be in [1, n - 1].
+  //
+  if (Ret == 0) {
+    if (mbedtls_mpi_cmp_int (&R, 1) < 0 || mbedtls_mpi_cmp_mpi (&R, &grp->N) >= 0 ||
+        mbedtls_mpi_cmp_int (&S, 1) < 0 || mbedtls_mpi_cmp_mpi (&S, &grp->N) >= 0) {
+      Ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    }
+  }
+  //
+  // E is the leftmost bits of the message hash, as many as the bits of the order.
+  //
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_read_binary (&E, MessageHash, HashSize);
+  }
+  if (Ret == 0 && HashSize * 8 > grp->nbits) {
+    Ret = mbedtls_mpi_shift_r (&E, HashSize * 8 - grp->nbits);
+  }
+  //
+  // U1 = E / S, U2 = R / S, and the signature is valid if R = (U1 * G + U2 * Q).x mod n.
+  // Both multiplications use the precomputed multiples of the generator of their group.
+  //
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_inv_mod (&W, &S, &grp->N);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_mul_mpi (&U1, &E, &W);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_mod_mpi (&U1, &U1, &grp->N);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_mul_mpi (&U2, &R, &W);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_mod_mpi (&U2, &U2, &grp->N);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_ecp_mul (grp, &Point1, &U1, &grp->G, NULL, NULL);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_ecp_mul (&Prepared->PublicKeyGroup, &Point2, &U2, &Prepared->PublicKeyGroup.G, NULL, NULL);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_lset (&One, 1);
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_ecp_muladd (grp, &Point1, &One, &Point1, &One, &Point2);
+  }
+  if (Ret == 0) {
+    if (mbedtls_ecp_is_zero (&Point1)) {
+      Ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    }
+  }
+  if (Ret == 0) {
+    Ret = mbedtls_mpi_mod_mpi (&Point1.X, &Point1.X, &grp->N);
+  }
+  if (Ret == 0) {
+    if (mbedtls_mpi_cmp_mpi (&Point1.X, &R) != 0) {
+      Ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    }
+  }
+
+  mbedtls_mpi_free (&R);
+  mbedtls_mpi_free (&S);
+  mbedtls_mpi_free (&E);
+  mbedtls_mpi_free (&W);
+  mbedtls_mpi_free (&U1);
+  mbedtls_mpi_free (&U2);
+  mbedtls_mpi_free (&One);
+  mbedtls_ecp_point_free (&Point1);
+  mbedtls_ecp_point_free (&Point2);
+
+  return (BOOLEAN)(Ret == 0);
+}
@@ -0,0 +1,297 @@
+/** @file
+  Montgomery-Curve Wrapper Implementation over MbedTls.
+
+  RFC 7748 - Elliptic Curves for Security (X25519 and X448)
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <mbedtls/ecp.h>
+#include <mbedtls/ecdh.h>
+#include <mbedtls/bignum.h>
+
+#define ECX_MAX_KEY_SIZE  56
+
+/**
+  Return the size in bytes of the public key and the exchanged key of the curve.
+
+  @param  ctx  Pointer to the Montgomery-Curve context.
+
+  @return the size in bytes, or 0 if the curve is not supported.
+**/
+STATIC
+UINTN
+EcxGetKeySize (
+  IN mbedtls_ecdh_context *ctx
+  )
+{
+  switch (ctx->grp.id) {
+  case MBEDTLS_ECP_DP_CURVE25519:
+    return 32;
+  case MBEDTLS_ECP_DP_CURVE448:
+    return 56;
+  default:
+    return 0;
+  }
+}
+
+/**
+  Reverse the bytes of a buffer, to convert between the little-endian
+  u-coordinate of RFC 7748 and the big-endian MPI.
+
+  @param  Buffer  Pointer to the buffer.
+  @param  Size    Size of the buffer in bytes.
+**/
+STATIC
+VOID
+EcxReverseBytes (
+  IN OUT UINT8  *Buffer,
+  IN     UINTN  Size
+  )
+{
+  UINTN  Index;
+  UINT8  Byte;
+
+  for (Index = 0; Index < Size / 2; Index++) {
+    Byte = Buffer[Index];
+    Buffer[Index] = Buffer[Size - 1 - Index];
+    Buffer[Size - 1 - Index] = Byte;
+  }
+}
+
+/**
+  Allocates and Initializes one Montgomery-Curve Context for subsequent use
+  with the NID.
+
+  @param Nid cipher NID, CRYPTO_NID_X25519 or CRYPTO_NID_X448.
+
+  @return  Pointer to the Montgomery-Curve Context that has been initialized.
+           If the allocations fails, EcxNewByNid() returns NULL.
+
+**/
+VOID *
+EFIAPI
+EcxNewByNid (
+  IN UINTN  Nid
+  )
+{
+  mbedtls_ecdh_context *ctx;
+  mbedtls_ecp_group_id grp_id;
+  INT32                Ret;
+
+  ctx = AllocateZeroPool (sizeof(mbedtls_ecdh_context));
+  if (ctx == NULL) {
+    return NULL;
+  }
+  switch (Nid) {
+  case CRYPTO_NID_X25519:
+    grp_id = MBEDTLS_ECP_DP_CURVE25519;
+    break;
+  case CRYPTO_NID_X448:
+    grp_id = MBEDTLS_ECP_DP_CURVE448;
+    break;
+  default:
+    goto Error;
+  }
+
+  Ret = mbedtls_ecdh_setup (ctx, grp_id);
+  if (Ret != 0) {
+    goto Error;
+  }
+  return ctx;
+Error:
+  FreePool (ctx);
+  return NULL;
+}
+
+/**
+  Release the specified Montgomery-Curve context.
+
+  @param[in]  EcxContext  Pointer to the Montgomery-Curve context to be released.
+
+**/
+VOID
+EFIAPI
+EcxFree (
+  IN  VOID  *EcxContext
+  )
+{
+  if (EcxContext == NULL) {
+    return ;
+  }
+  mbedtls_ecdh_free (EcxContext);
+  FreePool (EcxContext);
+}
+
+/**
+  Generates Montgomery-Curve key and returns the public key.
+
+  This function generates random secret, and computes the public key, which is
+  returned via parameter Public, PublicSize.
+  The public key is the u-coordinate in little-endian, as defined in RFC 7748.
+  If the Public buffer is too small to hold the public key, FALSE is returned and
+  PublicSize is set to the required buffer size to obtain the public key.
+
+  For X25519, the PublicSize is 32.
+  For X448, the PublicSize is 56.
+
+  If EcxContext is NULL, then return FALSE.
+  If PublicSize is NULL, then return FALSE.
+  If PublicSize is large enough but Public is NULL, then return FALSE.
+
+  @param[in, out]  EcxContext     Pointer to the Montgomery-Curve context.
+  @param[out]      Public         Pointer to the buffer to receive generated public key.
+  @param[in, out]  PublicSize     On input, the size of Public buffer in bytes.
+                                  On output, the size of data returned in Public buffer in bytes.
+
+  @retval TRUE   Montgomery-Curve public key generation succeeded.
+  @retval FALSE  Montgomery-Curve public key generation failed.
+  @retval FALSE  PublicSize is not large enough.
+
+**/
+BOOLEAN
+EFIAPI
+EcxGenerateKey (
+  IN OUT  VOID   *EcxContext,
+  OUT     UINT8  *Public,
+  IN OUT  UINTN  *PublicSize
+  )
+{
+  mbedtls_ecdh_context *ctx;
+  INT32                Ret;
+  UINTN                KeySize;
+
+  if (EcxContext == NULL || PublicSize == NULL) {
+    return FALSE;
+  }
+
+  if (Public == NULL && *PublicSize != 0) {
+    return FALSE;
+  }
+
+  ctx = EcxContext;
+  KeySize = EcxGetKeySize (ctx);
+  if (KeySize == 0) {
+    return FALSE;
+  }
+  if (*PublicSize < KeySize) {
+    *PublicSize = KeySize;
+    return FALSE;
+  }
+
+  Ret = mbedtls_ecdh_gen_public (&ctx->grp, &ctx->d, &ctx->Q, myrand, NULL);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_mpi_write_binary (&ctx->Q.X, Public, KeySize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  EcxReverseBytes (Public, KeySize);
+  *PublicSize = KeySize;
+  return TRUE;
+}
+
+/**
+  Computes exchanged common key.
+
+  Given peer's public key, this function computes the exchanged common key,
+  based on its own context including value of curve parameter and random secret.
+  The peer's public key is the u-coordinate in little-endian, as defined in RFC 7748.
+  The exchanged key is rejected if it is all zero, which is the result of a
+  low-order peer's public key.
+
+  If EcxContext is NULL, then return FALSE.
+  If PeerPublic is NULL, then return FALSE.
+  If PeerPublicSize is not the size of the public key, then return FALSE.
+  If Key is NULL, then return FALSE.
+  If KeySize is not large enough, then return FALSE.
+
+  For X25519, the PeerPublicSize and KeySize are 32.
+  For X448, the PeerPublicSize and KeySize are 56.
+
+  @param[in, out]  EcxContext         Pointer to the Montgomery-Curve context.
+  @param[in]       PeerPublic         Pointer to the peer's public key.
+  @param[in]       PeerPublicSize     Size of peer's public key in bytes.
+  @param[out]      Key                Pointer to the buffer to receive generated key.
+  @param[in, out]  KeySize            On input, the size of Key buffer in bytes.
+                                      On output, the size of data returned in Key buffer in bytes.
+
+  @retval TRUE   Montgomery-Curve exchanged key generation succeeded.
+  @retval FALSE  Montgomery-Curve exchanged key generation failed.
+  @retval FALSE  KeySize is not large enough.
+
+**/
+BOOLEAN
+EFIAPI
+EcxComputeKey (
+  IN OUT  VOID         *EcxContext,
+  IN      CONST UINT8  *PeerPublic,
+  IN      UINTN        PeerPublicSize,
+  OUT     UINT8        *Key,
+  IN OUT  UINTN        *KeySize
+  )
+{
+  mbedtls_ecdh_context *ctx;
+  INT32                Ret;
+  UINTN                EcxKeySize;
+  UINT8                Buffer[ECX_MAX_KEY_SIZE];
+  UINT8                NonZero;
+  UINTN                Index;
+
+  if (EcxContext == NULL || PeerPublic == NULL || KeySize == NULL || Key == NULL) {
+    return FALSE;
+  }
+
+  ctx = EcxContext;
+  EcxKeySize = EcxGetKeySize (ctx);
+  if (EcxKeySize == 0 || PeerPublicSize != EcxKeySize) {
+    return FALSE;
+  }
+  if (*KeySize < EcxKeySize) {
+    *KeySize = EcxKeySize;
+    return FALSE;
+  }
+
+  CopyMem (Buffer, PeerPublic, EcxKeySize);
+  if (ctx->grp.id == MBEDTLS_ECP_DP_CURVE25519) {
+    //
+    // RFC 7748 masks the unused most significant bit of the X25519 u-coordinate.
+    //
+    Buffer[EcxKeySize - 1] &= 0x7F;
+  }
+  EcxReverseBytes (Buffer, EcxKeySize);
+  Ret = mbedtls_mpi_read_binary (&ctx->Qp.X, Buffer, EcxKeySize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_mpi_lset (&ctx->Qp.Z, 1);
+  if (Ret != 0) {
+    return FALSE;
+  }
+
+  Ret = mbedtls_ecdh_compute_shared (&ctx->grp, &ctx->z, &ctx->Qp,
+                                             &ctx->d, myrand, NULL);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  Ret = mbedtls_mpi_write_binary (&ctx->z, Key, EcxKeySize);
+  if (Ret != 0) {
+    return FALSE;
+  }
+  EcxReverseBytes (Key, EcxKeySize);
+
+  NonZero = 0;
+  for (Index = 0; Index < EcxKeySize; Index++) {
+    NonZero |= Key[Index];
+  }
+  if (NonZero == 0) {
+    return FALSE;
+  }
+
+  *KeySize = EcxKeySize;
+  return TRUE;
+}
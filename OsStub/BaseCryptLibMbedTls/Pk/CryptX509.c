@@ -501,6 +501,69 @@ RsaGetPublicKeyFromX509 (
   return TRUE;
 }
 
+/**
+  Retrieve the RSA Public Key from one DER-encoded SubjectPublicKeyInfo.
+
+  @param[in]  DerData      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param[in]  DerSize      Size of the DER data in bytes.
+  @param[out] RsaContext   Pointer to new-generated RSA context which contain the retrieved
+                           RSA public key component. Use RsaFree() function to free the
+                           resource.
+
+  If DerData is NULL, then return FALSE.
+  If RsaContext is NULL, then return FALSE.
+
+  @retval  TRUE   RSA Public Key was retrieved successfully.
+  @retval  FALSE  Invalid DER data, or the key is not an RSA key.
+
+**/
+BOOLEAN
+EFIAPI
+RsaGetPublicKeyFromDer (
+  IN   CONST UINT8  *DerData,
+  IN   UINTN        DerSize,
+  OUT  VOID         **RsaContext
+  )
+{
+  mbedtls_pk_context  pk;
+  mbedtls_rsa_context *rsa;
+  INT32               Ret;
+
+  if (DerData == NULL || RsaContext == NULL) {
+    return FALSE;
+  }
+
+  mbedtls_pk_init (&pk);
+
+  if (mbedtls_pk_parse_public_key (&pk, DerData, DerSize) != 0) {
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+
+  if (mbedtls_pk_get_type (&pk) != MBEDTLS_PK_RSA) {
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+
+  rsa = RsaNew ();
+  if (rsa == NULL) {
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+  Ret = mbedtls_rsa_copy (rsa, mbedtls_pk_rsa (pk));
+  if (Ret != 0) {
+    RsaFree (rsa);
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+  mbedtls_pk_free (&pk);
+
+  *RsaContext = rsa;
+  return TRUE;
+}
+
+#ifndef BASE_CRYPT_LIB_PSA
+
 /**
   Retrieve the EC Public Key from one DER-encoded X509 certificate.
 
@@ -560,6 +623,72 @@ EcGetPublicKeyFromX509 (
   return TRUE;
 }
 
+/**
+  Retrieve the EC Public Key from one DER-encoded SubjectPublicKeyInfo.
+
+  @param[in]  DerData      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param[in]  DerSize      Size of the DER data in bytes.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which contain the retrieved
+                           EC public key component. Use EcFree() function to free the
+                           resource.
+
+  If DerData is NULL, then return FALSE.
+  If EcContext is NULL, then return FALSE.
+
+  @retval  TRUE   EC Public Key was retrieved successfully.
+  @retval  FALSE  Invalid DER data, or the key is not an EC key.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPublicKeyFromDer (
+  IN   CONST UINT8  *DerData,
+  IN   UINTN        DerSize,
+  OUT  VOID         **EcContext
+  )
+{
+  mbedtls_pk_context     pk;
+  mbedtls_ecdh_context   *ecdh;
+  INT32                  Ret;
+
+  if (DerData == NULL || EcContext == NULL) {
+    return FALSE;
+  }
+
+  mbedtls_pk_init (&pk);
+
+  if (mbedtls_pk_parse_public_key (&pk, DerData, DerSize) != 0) {
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+
+  if (mbedtls_pk_get_type (&pk) != MBEDTLS_PK_ECKEY) {
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+
+  ecdh = AllocateZeroPool (sizeof(mbedtls_ecdh_context));
+  if (ecdh == NULL) {
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+  mbedtls_ecdh_init (ecdh);
+
+  Ret = mbedtls_ecdh_get_params (ecdh, mbedtls_pk_ec (pk), MBEDTLS_ECDH_OURS);
+  if (Ret != 0) {
+    mbedtls_ecdh_free (ecdh);
+    FreePool (ecdh);
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+  mbedtls_pk_free (&pk);
+
+  *EcContext = ecdh;
+  return TRUE;
+}
+
+#endif
+
 /**
   Retrieve the Ed Public Key from one DER-encoded X509 certificate.
 
@@ -73,3 +73,46 @@ void mbedtls_free (void *ptr)
     FreePool (PoolHdr);
   }
 }
+
+//
+// -- Scratch Arena Routines --
+//
+
+/**
+  Sets a caller-provided scratch arena for the transient allocations of the crypto operations.
+
+  @param[in]  Arena       Pointer to the arena buffer, or NULL to allocate from the heap.
+  @param[in]  ArenaSize   Size of the arena buffer in bytes.
+  @param[in]  Strict      If TRUE, an allocation fails when the arena cannot serve it,
+                          instead of falling back to the heap.
+
+  @retval TRUE   The scratch arena is set.
+  @retval FALSE  The allocations of the crypto backend cannot be redirected,
+                 or a context allocated from the current arena is outstanding.
+
+**/
+BOOLEAN
+EFIAPI
+CryptSetScratchArena (
+  IN  VOID     *Arena  OPTIONAL,
+  IN  UINTN    ArenaSize,
+  IN  BOOLEAN  Strict
+  )
+{
+  return SetPoolArena (Arena, ArenaSize, Strict);
+}
+
+/**
+  Returns the peak size in bytes used in the scratch arena since it was set.
+
+  @return The peak size in bytes used in the scratch arena.
+
+**/
+UINTN
+EFIAPI
+CryptGetScratchArenaPeakSize (
+  VOID
+  )
+{
+  return GetPoolArenaPeakSize ();
+}
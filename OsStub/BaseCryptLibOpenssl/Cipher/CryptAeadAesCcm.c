@@ -70,13 +70,13 @@ AeadAesCcmEncrypt (
   }
   switch (KeySize) {
   case 16:
-    Cipher = EVP_aes_128_ccm();
+    Cipher = InternalCryptGetCipher (CryptCipherAes128Ccm);
     break;
   case 24:
-    Cipher = EVP_aes_192_ccm();
+    Cipher = InternalCryptGetCipher (CryptCipherAes192Ccm);
     break;
   case 32:
-    Cipher = EVP_aes_256_ccm();
+    Cipher = InternalCryptGetCipher (CryptCipherAes256Ccm);
     break;
   default:
     return FALSE;
@@ -91,7 +91,7 @@ AeadAesCcmEncrypt (
     }
   }
 
-  Ctx = EVP_CIPHER_CTX_new();
+  Ctx = InternalCryptAcquireCipherCtx ();
   if (Ctx == NULL) {
     return FALSE;
   }
@@ -139,7 +139,7 @@ AeadAesCcmEncrypt (
   RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_CCM_GET_TAG, (INT32)TagSize, (VOID *)TagOut);
 
 Done:
-  EVP_CIPHER_CTX_free(Ctx);
+  InternalCryptReleaseCipherCtx (Ctx);
   if (!RetValue) {
     return RetValue;
   }
@@ -209,13 +209,13 @@ AeadAesCcmDecrypt (
   }
   switch (KeySize) {
   case 16:
-    Cipher = EVP_aes_128_ccm();
+    Cipher = InternalCryptGetCipher (CryptCipherAes128Ccm);
     break;
   case 24:
-    Cipher = EVP_aes_192_ccm();
+    Cipher = InternalCryptGetCipher (CryptCipherAes192Ccm);
     break;
   case 32:
-    Cipher = EVP_aes_256_ccm();
+    Cipher = InternalCryptGetCipher (CryptCipherAes256Ccm);
     break;
   default:
     return FALSE;
@@ -230,7 +230,7 @@ AeadAesCcmDecrypt (
     }
   }
 
-  Ctx = EVP_CIPHER_CTX_new();
+  Ctx = InternalCryptAcquireCipherCtx ();
   if (Ctx == NULL) {
     return FALSE;
   }
@@ -273,7 +273,7 @@ AeadAesCcmDecrypt (
   RetValue = (BOOLEAN) EVP_DecryptFinal_ex(Ctx, DataOut, (INT32 *)&TempOutSize);
 
 Done:
-  EVP_CIPHER_CTX_free(Ctx);
+  InternalCryptReleaseCipherCtx (Ctx);
   if (!RetValue) {
     return RetValue;
   }
@@ -79,12 +79,12 @@ AeadChaCha20Poly1305Encrypt(
     }
   }
 
-  Ctx = EVP_CIPHER_CTX_new();
+  Ctx = InternalCryptAcquireCipherCtx ();
   if (Ctx == NULL) {
     return FALSE;
   }
 
-  RetValue = (BOOLEAN) EVP_EncryptInit_ex(Ctx, EVP_chacha20_poly1305(), NULL, NULL, NULL);
+  RetValue = (BOOLEAN) EVP_EncryptInit_ex(Ctx, InternalCryptGetCipher (CryptCipherChaCha20Poly1305), NULL, NULL, NULL);
   if (!RetValue) {
     goto Done;
   }
@@ -122,7 +122,7 @@ AeadChaCha20Poly1305Encrypt(
   RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_GET_TAG, (INT32)TagSize, (VOID *)TagOut);
 
 Done:
-  EVP_CIPHER_CTX_free(Ctx);
+  InternalCryptReleaseCipherCtx (Ctx);
   if (!RetValue) {
     return RetValue;
   }
@@ -201,12 +201,12 @@ AeadChaCha20Poly1305Decrypt(
     }
   }
 
-  Ctx = EVP_CIPHER_CTX_new();
+  Ctx = InternalCryptAcquireCipherCtx ();
   if (Ctx == NULL) {
     return FALSE;
   }
 
-  RetValue = (BOOLEAN) EVP_DecryptInit_ex(Ctx, EVP_chacha20_poly1305(), NULL, NULL, NULL);
+  RetValue = (BOOLEAN) EVP_DecryptInit_ex(Ctx, InternalCryptGetCipher (CryptCipherChaCha20Poly1305), NULL, NULL, NULL);
   if (!RetValue) {
     goto Done;
   }
@@ -239,7 +239,7 @@ AeadChaCha20Poly1305Decrypt(
   RetValue = (BOOLEAN) EVP_DecryptFinal_ex(Ctx, DataOut, (INT32 *)&TempOutSize);
 
 Done:
-  EVP_CIPHER_CTX_free(Ctx);
+  InternalCryptReleaseCipherCtx (Ctx);
   if (!RetValue) {
     return RetValue;
   }
@@ -251,3 +251,712 @@ Done:
   return RetValue;
 }
 
+
+/**
+  Allocates and initializes one AEAD ChaCha20Poly1305 context for subsequent use.
+
+  @return  Pointer to the AEAD ChaCha20Poly1305 context that has been initialized.
+           If the allocations fails, AeadChaCha20Poly1305New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+AeadChaCha20Poly1305New (
+  VOID
+  )
+{
+  return (VOID *) EVP_CIPHER_CTX_new ();
+}
+
+/**
+  Release the specified AEAD ChaCha20Poly1305 context.
+
+  @param[in]  AeadContext  Pointer to the AEAD ChaCha20Poly1305 context to be released.
+
+**/
+VOID
+EFIAPI
+AeadChaCha20Poly1305Free (
+  IN  VOID  *AeadContext
+  )
+{
+  EVP_CIPHER_CTX_free ((EVP_CIPHER_CTX *)AeadContext);
+}
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to AeadChaCha20Poly1305Seal() or AeadChaCha20Poly1305Open().
+
+  If AeadContext is NULL, then return FALSE.
+  KeySize must be 32, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the AEAD ChaCha20Poly1305 context.
+  @param[in]       Key          Pointer to the user-supplied key.
+  @param[in]       KeySize      Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305SetKey (
+  IN OUT  VOID         *AeadContext,
+  IN      CONST UINT8  *Key,
+  IN      UINTN        KeySize
+  )
+{
+  EVP_CIPHER_CTX   *Ctx;
+
+  if (AeadContext == NULL || Key == NULL) {
+    return FALSE;
+  }
+  if (KeySize != 32) {
+    return FALSE;
+  }
+
+  Ctx = (EVP_CIPHER_CTX *)AeadContext;
+
+  if (EVP_CipherInit_ex(Ctx, InternalCryptGetCipher (CryptCipherChaCha20Poly1305), NULL, NULL, NULL, 1) != 1) {
+    return FALSE;
+  }
+  if (EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_SET_IVLEN, 12, NULL) != 1) {
+    return FALSE;
+  }
+  //
+  // Load the key only once. Every record later supplies the nonce only.
+  //
+  if (EVP_CipherInit_ex(Ctx, NULL, NULL, Key, NULL, -1) != 1) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated encryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be encrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated encryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305Seal (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  OUT  UINT8        *TagOut,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  )
+{
+  EVP_CIPHER_CTX   *Ctx;
+  UINTN            TempOutSize;
+  BOOLEAN          RetValue;
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (DataInSize > INT_MAX) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    if ((*DataOutSize > INT_MAX) || (*DataOutSize < DataInSize)) {
+      return FALSE;
+    }
+  }
+
+  Ctx = (EVP_CIPHER_CTX *)AeadContext;
+
+  RetValue = (BOOLEAN) EVP_CipherInit_ex(Ctx, NULL, NULL, NULL, Iv, 1);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_SET_TAG, (INT32)TagSize, NULL);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_EncryptUpdate(Ctx, NULL, (INT32 *)&TempOutSize, AData, (INT32)ADataSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_EncryptUpdate(Ctx, DataOut, (INT32 *)&TempOutSize, DataIn, (INT32)DataInSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_EncryptFinal_ex(Ctx, DataOut, (INT32 *)&TempOutSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_GET_TAG, (INT32)TagSize, (VOID *)TagOut);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  if (DataOutSize != NULL) {
+    *DataOutSize = DataInSize;
+  }
+
+  return TRUE;
+}
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the decryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated decryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305Open (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  IN   CONST UINT8  *Tag,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  )
+{
+  EVP_CIPHER_CTX   *Ctx;
+  UINTN            TempOutSize;
+  BOOLEAN          RetValue;
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (DataInSize > INT_MAX) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    if ((*DataOutSize > INT_MAX) || (*DataOutSize < DataInSize)) {
+      return FALSE;
+    }
+  }
+
+  Ctx = (EVP_CIPHER_CTX *)AeadContext;
+
+  RetValue = (BOOLEAN) EVP_CipherInit_ex(Ctx, NULL, NULL, NULL, Iv, 0);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_DecryptUpdate(Ctx, NULL, (INT32 *)&TempOutSize, AData, (INT32)ADataSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_DecryptUpdate(Ctx, DataOut, (INT32 *)&TempOutSize, DataIn, (INT32)DataInSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_SET_TAG, (INT32)TagSize, (VOID *)Tag);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_DecryptFinal_ex(Ctx, DataOut, (INT32 *)&TempOutSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  if (DataOutSize != NULL) {
+    *DataOutSize = DataInSize;
+  }
+
+  return TRUE;
+}
+
+/**
+  Zero the first Size bytes spread over a list of data segments.
+
+  @param[in]  Segments      Pointer to the list of data segments.
+  @param[in]  SegmentCount  Number of entries in Segments.
+  @param[in]  Size          Number of bytes to be zeroed.
+
+**/
+STATIC
+VOID
+ZeroSegments (
+  IN CONST CRYPT_DATA_SEGMENT  *Segments,
+  IN UINTN                     SegmentCount,
+  IN UINTN                     Size
+  )
+{
+  UINTN  Index;
+  UINTN  Length;
+
+  for (Index = 0; (Index < SegmentCount) && (Size != 0); Index++) {
+    Length = MIN (Segments[Index].Size, Size);
+    ZeroMem (Segments[Index].Buffer, Length);
+    Size -= Length;
+  }
+}
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  The segments are encrypted in order, as if they were one contiguous buffer, into DataOut.
+  A segment may only overlap DataOut at the offset where its own cipher text is written.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the list of input data segments to be encrypted.
+  @param[in]   DataInCount Number of entries in DataIn.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated encryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305SealSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataIn,
+  IN   UINTN                       DataInCount,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize,
+  OUT  UINT8                       *DataOut,
+  OUT  UINTN                       *DataOutSize
+  )
+{
+  EVP_CIPHER_CTX   *Ctx;
+  UINTN            TempOutSize;
+  BOOLEAN          RetValue;
+  UINTN            Index;
+  UINTN            DataInSize;
+  UINTN            Offset;
+
+  if (AeadContext == NULL || (DataIn == NULL && DataInCount != 0)) {
+    return FALSE;
+  }
+  DataInSize = 0;
+  for (Index = 0; Index < DataInCount; Index++) {
+    if (DataIn[Index].Size > INT_MAX - DataInSize) {
+      return FALSE;
+    }
+    DataInSize += DataIn[Index].Size;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+  if (DataOutSize != NULL) {
+    if ((*DataOutSize > INT_MAX) || (*DataOutSize < DataInSize)) {
+      return FALSE;
+    }
+  }
+
+  Ctx = (EVP_CIPHER_CTX *)AeadContext;
+
+  RetValue = (BOOLEAN) EVP_CipherInit_ex(Ctx, NULL, NULL, NULL, Iv, 1);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_SET_TAG, (INT32)TagSize, NULL);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_EncryptUpdate(Ctx, NULL, (INT32 *)&TempOutSize, AData, (INT32)ADataSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  Offset = 0;
+  for (Index = 0; Index < DataInCount; Index++) {
+    if (DataIn[Index].Size == 0) {
+      continue;
+    }
+    RetValue = (BOOLEAN) EVP_EncryptUpdate(Ctx, DataOut + Offset, (INT32 *)&TempOutSize, DataIn[Index].Buffer, (INT32)DataIn[Index].Size);
+    if (!RetValue) {
+      return FALSE;
+    }
+    Offset += DataIn[Index].Size;
+  }
+
+  RetValue = (BOOLEAN) EVP_EncryptFinal_ex(Ctx, DataOut + Offset, (INT32 *)&TempOutSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_GET_TAG, (INT32)TagSize, (VOID *)TagOut);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  if (DataOutSize != NULL) {
+    *DataOutSize = DataInSize;
+  }
+
+  return TRUE;
+}
+
+/**
+  Performs AEAD ChaCha20Poly1305 authenticated decryption on a data buffer and additional authenticated data (AAD)
+  into a list of data segments, with the key held in the AEAD ChaCha20Poly1305 context.
+
+  The plain text is written in order across the segments, which must hold at least DataInSize bytes.
+  A segment may only overlap DataIn at the offset where its own cipher text is read.
+  If the authentication fails, the plain text written to the segments is zeroed.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[in]   DataOut     Pointer to the list of segments that receive the decryption output.
+  @param[in]   DataOutCount Number of entries in DataOut.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authenticated decryption succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305OpenSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *DataIn,
+  IN   UINTN                       DataInSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataOut,
+  IN   UINTN                       DataOutCount
+  )
+{
+  EVP_CIPHER_CTX   *Ctx;
+  UINTN            TempOutSize;
+  BOOLEAN          RetValue;
+  UINTN            Index;
+  UINTN            Capacity;
+  UINTN            Offset;
+  UINTN            Length;
+  UINT8            Dummy[16];
+
+  if (AeadContext == NULL || (DataOut == NULL && DataOutCount != 0)) {
+    return FALSE;
+  }
+  if (DataInSize > INT_MAX) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+  Capacity = 0;
+  for (Index = 0; (Index < DataOutCount) && (Capacity < DataInSize); Index++) {
+    Capacity += MIN (DataOut[Index].Size, DataInSize - Capacity);
+  }
+  if (Capacity < DataInSize) {
+    return FALSE;
+  }
+
+  Ctx = (EVP_CIPHER_CTX *)AeadContext;
+
+  RetValue = (BOOLEAN) EVP_CipherInit_ex(Ctx, NULL, NULL, NULL, Iv, 0);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_DecryptUpdate(Ctx, NULL, (INT32 *)&TempOutSize, AData, (INT32)ADataSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  Offset = 0;
+  for (Index = 0; (Index < DataOutCount) && (Offset < DataInSize); Index++) {
+    Length = MIN (DataOut[Index].Size, DataInSize - Offset);
+    if (Length == 0) {
+      continue;
+    }
+    RetValue = (BOOLEAN) EVP_DecryptUpdate(Ctx, DataOut[Index].Buffer, (INT32 *)&TempOutSize, DataIn + Offset, (INT32)Length);
+    if (!RetValue) {
+      goto Done;
+    }
+    Offset += Length;
+  }
+
+  RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_SET_TAG, (INT32)TagSize, (VOID *)Tag);
+  if (!RetValue) {
+    goto Done;
+  }
+
+  //
+  // A stream mode produces no output in the final call.
+  //
+  RetValue = (BOOLEAN) EVP_DecryptFinal_ex(Ctx, Dummy, (INT32 *)&TempOutSize);
+
+Done:
+  if (!RetValue) {
+    ZeroSegments (DataOut, DataOutCount, DataInSize);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Generates the AEAD ChaCha20Poly1305 authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authentication tag generation succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authentication tag generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305Mac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize
+  )
+{
+  EVP_CIPHER_CTX   *Ctx;
+  UINTN            TempOutSize;
+  BOOLEAN          RetValue;
+  UINT8            Dummy[16];
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+
+  Ctx = (EVP_CIPHER_CTX *)AeadContext;
+
+  RetValue = (BOOLEAN) EVP_CipherInit_ex(Ctx, NULL, NULL, NULL, Iv, 1);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_SET_TAG, (INT32)TagSize, NULL);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_EncryptUpdate(Ctx, NULL, (INT32 *)&TempOutSize, AData, (INT32)ADataSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  //
+  // No cipher text is produced, the final call only computes the tag.
+  //
+  RetValue = (BOOLEAN) EVP_EncryptFinal_ex(Ctx, Dummy, (INT32 *)&TempOutSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_GET_TAG, (INT32)TagSize, (VOID *)TagOut);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Verifies the AEAD ChaCha20Poly1305 authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD ChaCha20Poly1305 context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD ChaCha20Poly1305 context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD ChaCha20Poly1305 authentication tag verification succeeded.
+  @retval FALSE  AEAD ChaCha20Poly1305 authentication tag verification failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadChaCha20Poly1305VerifyMac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize
+  )
+{
+  EVP_CIPHER_CTX   *Ctx;
+  UINTN            TempOutSize;
+  BOOLEAN          RetValue;
+  UINT8            Dummy[16];
+
+  if (AeadContext == NULL) {
+    return FALSE;
+  }
+  if (ADataSize > INT_MAX) {
+    return FALSE;
+  }
+  if (IvSize != 12) {
+    return FALSE;
+  }
+  if (TagSize != 16) {
+    return FALSE;
+  }
+
+  Ctx = (EVP_CIPHER_CTX *)AeadContext;
+
+  RetValue = (BOOLEAN) EVP_CipherInit_ex(Ctx, NULL, NULL, NULL, Iv, 0);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_DecryptUpdate(Ctx, NULL, (INT32 *)&TempOutSize, AData, (INT32)ADataSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  RetValue = (BOOLEAN) EVP_CIPHER_CTX_ctrl(Ctx, EVP_CTRL_AEAD_SET_TAG, (INT32)TagSize, (VOID *)Tag);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  //
+  // No plain text is produced, the final call only checks the tag.
+  //
+  RetValue = (BOOLEAN) EVP_DecryptFinal_ex(Ctx, Dummy, (INT32 *)&TempOutSize);
+  if (!RetValue) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
@@ -9,6 +9,44 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "InternalCryptLib.h"
 #include <openssl/sha.h>
 
+/**
+  Allocates one SHA-256 context for subsequent use.
+  The context must be initialized by Sha256Init() before it is used.
+
+  @return  Pointer to the SHA-256 context that has been allocated.
+           If the allocations fails, Sha256New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha256New (
+  VOID
+  )
+{
+  //
+  // Allocates OpenSSL SHA-256 Context
+  //
+  return AllocatePool (sizeof (SHA256_CTX));
+}
+
+/**
+  Release the specified SHA-256 context.
+
+  @param[in]  Sha256Context  Pointer to the SHA-256 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha256Free (
+  IN  VOID  *Sha256Context
+  )
+{
+  if (Sha256Context == NULL) {
+    return;
+  }
+  FreePool (Sha256Context);
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-256 hash operations.
 
@@ -221,3 +259,43 @@ Sha256HashAll (
     return TRUE;
   }
 }
+
+/**
+  Computes the SHA-256 message digests of several independent data buffers.
+
+  The result is the same as calling Sha256HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA-256 digest values (32 bytes each).
+
+  @retval TRUE   SHA-256 digest computation succeeded.
+  @retval FALSE  SHA-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha256HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
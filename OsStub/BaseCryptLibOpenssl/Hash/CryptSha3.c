@@ -18,6 +18,44 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 ///
 #define INTERNAL_MAX_CONTEXT_SIZE_FOR_HASHALL_USE 1024
 
+/**
+  Allocates one SHA3-256 context for subsequent use.
+  The context must be initialized by Sha3_256Init() before it is used.
+
+  @return  Pointer to the SHA3-256 context that has been allocated.
+           If the allocations fails, Sha3_256New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_256New (
+  VOID
+  )
+{
+  //
+  // Allocates OpenSSL SHA3-256 Context
+  //
+  return AllocatePool (Sha3_256GetContextSize ());
+}
+
+/**
+  Release the specified SHA3-256 context.
+
+  @param[in]  Sha3_256Context  Pointer to the SHA3-256 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_256Free (
+  IN  VOID  *Sha3_256Context
+  )
+{
+  if (Sha3_256Context == NULL) {
+    return;
+  }
+  FreePool (Sha3_256Context);
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-256 hash operations.
 
@@ -101,6 +139,12 @@ Sha3_256Duplicate (
 
   CtxSize = Sha3_256GetContextSize();
   CopyMem (NewSha3_256Context, Sha3_256Context, CtxSize);
+
+  //
+  // md_data points into the context it belongs to; the copy must not keep
+  // updating the state of the original.
+  //
+  ((struct evp_md_ctx_st *)NewSha3_256Context)->md_data = (UINT8 *)NewSha3_256Context + sizeof (struct evp_md_ctx_st);
   return TRUE;
 }
 
@@ -222,6 +266,84 @@ Sha3_256HashAll (
   return Status;
 }
 
+/**
+  Computes the SHA3-256 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_256HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-256 digest values (256 / 8 bytes each).
+
+  @retval TRUE   SHA3-256 digest computation succeeded.
+  @retval FALSE  SHA3-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_256HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha3_256HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Allocates one SHA3-384 context for subsequent use.
+  The context must be initialized by Sha3_384Init() before it is used.
+
+  @return  Pointer to the SHA3-384 context that has been allocated.
+           If the allocations fails, Sha3_384New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_384New (
+  VOID
+  )
+{
+  //
+  // Allocates OpenSSL SHA3-384 Context
+  //
+  return AllocatePool (Sha3_384GetContextSize ());
+}
+
+/**
+  Release the specified SHA3-384 context.
+
+  @param[in]  Sha3_384Context  Pointer to the SHA3-384 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_384Free (
+  IN  VOID  *Sha3_384Context
+  )
+{
+  if (Sha3_384Context == NULL) {
+    return;
+  }
+  FreePool (Sha3_384Context);
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-384 hash operations.
 
@@ -305,6 +427,12 @@ Sha3_384Duplicate (
 
   CtxSize = Sha3_384GetContextSize();
   CopyMem (NewSha3_384Context, Sha3_384Context, CtxSize);
+
+  //
+  // md_data points into the context it belongs to; the copy must not keep
+  // updating the state of the original.
+  //
+  ((struct evp_md_ctx_st *)NewSha3_384Context)->md_data = (UINT8 *)NewSha3_384Context + sizeof (struct evp_md_ctx_st);
   return TRUE;
 }
 
@@ -426,6 +554,84 @@ Sha3_384HashAll (
   return Status;
 }
 
+/**
+  Computes the SHA3-384 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_384HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-384 digest values (384 / 8 bytes each).
+
+  @retval TRUE   SHA3-384 digest computation succeeded.
+  @retval FALSE  SHA3-384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_384HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha3_384HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Allocates one SHA3-512 context for subsequent use.
+  The context must be initialized by Sha3_512Init() before it is used.
+
+  @return  Pointer to the SHA3-512 context that has been allocated.
+           If the allocations fails, Sha3_512New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_512New (
+  VOID
+  )
+{
+  //
+  // Allocates OpenSSL SHA3-512 Context
+  //
+  return AllocatePool (Sha3_512GetContextSize ());
+}
+
+/**
+  Release the specified SHA3-512 context.
+
+  @param[in]  Sha3_512Context  Pointer to the SHA3-512 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_512Free (
+  IN  VOID  *Sha3_512Context
+  )
+{
+  if (Sha3_512Context == NULL) {
+    return;
+  }
+  FreePool (Sha3_512Context);
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA3-512 hash operations.
 
@@ -509,6 +715,12 @@ Sha3_512Duplicate (
 
   CtxSize = Sha3_512GetContextSize();
   CopyMem (NewSha3_512Context, Sha3_512Context, CtxSize);
+
+  //
+  // md_data points into the context it belongs to; the copy must not keep
+  // updating the state of the original.
+  //
+  ((struct evp_md_ctx_st *)NewSha3_512Context)->md_data = (UINT8 *)NewSha3_512Context + sizeof (struct evp_md_ctx_st);
   return TRUE;
 }
 
@@ -630,6 +842,46 @@ Sha3_512HashAll (
   return Status;
 }
 
+/**
+  Computes the SHA3-512 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_512HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-512 digest values (512 / 8 bytes each).
+
+  @retval TRUE   SHA3-512 digest computation succeeded.
+  @retval FALSE  SHA3-512 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_512HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha3_512HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHAKE256 hash operations.
 
@@ -713,6 +965,12 @@ Shake256Duplicate (
 
   CtxSize = Shake256GetContextSize();
   CopyMem (NewShake256Context, Shake256Context, CtxSize);
+
+  //
+  // md_data points into the context it belongs to; the copy must not keep
+  // updating the state of the original.
+  //
+  ((struct evp_md_ctx_st *)NewShake256Context)->md_data = (UINT8 *)NewShake256Context + sizeof (struct evp_md_ctx_st);
   return TRUE;
 }
 
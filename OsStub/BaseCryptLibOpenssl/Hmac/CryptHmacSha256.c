@@ -246,15 +246,11 @@ HmacMdAll (
   HMAC_CTX  *Ctx;
   BOOLEAN   RetVal;
 
-  Ctx = HMAC_CTX_new ();
+  Ctx = InternalCryptAcquireHmacCtx ();
   if (Ctx == NULL) {
     return FALSE;
   }
-  
-  RetVal = (BOOLEAN) HMAC_CTX_reset (Ctx);
-  if (!RetVal) {
-    goto Done;
-  }
+
   RetVal = (BOOLEAN) HMAC_Init_ex (Ctx, Key, (UINT32) KeySize, Md, NULL);
   if (!RetVal) {
     goto Done;
@@ -269,7 +265,7 @@ HmacMdAll (
   }
 
 Done:
-  HMAC_CTX_free (Ctx);
+  InternalCryptReleaseHmacCtx (Ctx);
 
   return RetVal;
 }
@@ -327,7 +323,7 @@ HmacSha256SetKey (
   IN   UINTN        KeySize
   )
 {
-  return HmacMdSetKey (EVP_sha256(), HmacSha256Context, Key, KeySize);
+  return HmacMdSetKey (InternalCryptGetMd (CryptMdSha256), HmacSha256Context, Key, KeySize);
 }
 
 /**
@@ -442,7 +438,7 @@ HmacSha256All (
   OUT  UINT8       *HmacValue
   )
 {
-  return HmacMdAll (EVP_sha256(), Data, DataSize, Key, KeySize, HmacValue);
+  return HmacMdAll (InternalCryptGetMd (CryptMdSha256), Data, DataSize, Key, KeySize, HmacValue);
 }
 
 /**
@@ -500,7 +496,7 @@ HmacSha384SetKey (
   IN   UINTN        KeySize
   )
 {
-  return HmacMdSetKey (EVP_sha384(), HmacSha384Context, Key, KeySize);
+  return HmacMdSetKey (InternalCryptGetMd (CryptMdSha384), HmacSha384Context, Key, KeySize);
 }
 
 /**
@@ -621,7 +617,7 @@ HmacSha384All (
   OUT  UINT8        *HmacValue
   )
 {
-  return HmacMdAll (EVP_sha384(), Data, DataSize, Key, KeySize, HmacValue);
+  return HmacMdAll (InternalCryptGetMd (CryptMdSha384), Data, DataSize, Key, KeySize, HmacValue);
 }
 
 /**
@@ -679,7 +675,7 @@ HmacSha512SetKey (
   IN   UINTN        KeySize
   )
 {
-  return HmacMdSetKey (EVP_sha512(), HmacSha512Context, Key, KeySize);
+  return HmacMdSetKey (InternalCryptGetMd (CryptMdSha512), HmacSha512Context, Key, KeySize);
 }
 
 /**
@@ -800,5 +796,5 @@ HmacSha512All (
   OUT  UINT8        *HmacValue
   )
 {
-  return HmacMdAll (EVP_sha512(), Data, DataSize, Key, KeySize, HmacValue);
+  return HmacMdAll (InternalCryptGetMd (CryptMdSha512), Data, DataSize, Key, KeySize, HmacValue);
 }
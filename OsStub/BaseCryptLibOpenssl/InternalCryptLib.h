@@ -21,6 +21,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "CrtLibSupport.h"
 
 #include <openssl/opensslv.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
 
 #if OPENSSL_VERSION_NUMBER < 0x10100000L
 #define OBJ_get0_data(o) ((o)->data)
@@ -59,4 +61,136 @@ WrapPkcs7Data (
   OUT UINTN        *WrapDataSize
   );
 
+//
+// The message digests fetched once by the OpenSSL wrappers.
+//
+typedef enum {
+  CryptMdSha256,
+  CryptMdSha384,
+  CryptMdSha512,
+  CryptMdSha3_256,
+  CryptMdSha3_384,
+  CryptMdSha3_512,
+  CryptMdSm3,
+  CryptMdMax
+} CRYPT_MD_INDEX;
+
+//
+// The ciphers fetched once by the OpenSSL wrappers.
+//
+typedef enum {
+  CryptCipherAes128Gcm,
+  CryptCipherAes192Gcm,
+  CryptCipherAes256Gcm,
+  CryptCipherAes128Ccm,
+  CryptCipherAes192Ccm,
+  CryptCipherAes256Ccm,
+  CryptCipherAes128Cbc,
+  CryptCipherAes192Cbc,
+  CryptCipherAes256Cbc,
+  CryptCipherChaCha20Poly1305,
+  CryptCipherMax
+} CRYPT_CIPHER_INDEX;
+
+/**
+  Get a message digest of the OpenSSL wrappers.
+
+  With OpenSSL 3.0 or later, the message digest is fetched from the default library context
+  the first time, and the same EVP_MD is returned afterwards, so that an EVP_DigestInit_ex()
+  or HMAC_Init_ex() with it does not fetch it again under the provider store lock.
+  With an earlier OpenSSL, it is the static EVP_MD of EVP_sha256() and similar.
+
+  @param[in]  Index  The message digest.
+
+  @return  The message digest, or NULL if it is not available.
+**/
+CONST EVP_MD *
+InternalCryptGetMd (
+  IN  CRYPT_MD_INDEX  Index
+  );
+
+/**
+  Get a cipher of the OpenSSL wrappers.
+
+  With OpenSSL 3.0 or later, the cipher is fetched from the default library context the first
+  time, and the same EVP_CIPHER is returned afterwards.
+  With an earlier OpenSSL, it is the static EVP_CIPHER of EVP_aes_256_gcm() and similar.
+
+  @param[in]  Index  The cipher.
+
+  @return  The cipher, or NULL if it is not available.
+**/
+CONST EVP_CIPHER *
+InternalCryptGetCipher (
+  IN  CRYPT_CIPHER_INDEX  Index
+  );
+
+/**
+  Acquire an EVP_CIPHER_CTX for a one-shot cipher operation.
+
+  The context cached for the calling thread is returned if it is not already acquired,
+  otherwise a new context is allocated.
+
+  @return  The cipher context, or NULL if it cannot be allocated.
+**/
+EVP_CIPHER_CTX *
+InternalCryptAcquireCipherCtx (
+  VOID
+  );
+
+/**
+  Release an EVP_CIPHER_CTX acquired by InternalCryptAcquireCipherCtx().
+
+  The context is reset, which cleanses the key, and cached for the calling thread
+  if the thread has no cached context, otherwise it is freed.
+
+  @param[in]  Ctx  The cipher context. It may be NULL.
+**/
+VOID
+InternalCryptReleaseCipherCtx (
+  IN  EVP_CIPHER_CTX  *Ctx
+  );
+
+/**
+  Acquire an HMAC_CTX for a one-shot HMAC operation.
+
+  The context cached for the calling thread is returned if it is not already acquired,
+  otherwise a new context is allocated.
+
+  @return  The HMAC context, or NULL if it cannot be allocated.
+**/
+HMAC_CTX *
+InternalCryptAcquireHmacCtx (
+  VOID
+  );
+
+/**
+  Release an HMAC_CTX acquired by InternalCryptAcquireHmacCtx().
+
+  The context is reset, which cleanses the key, and cached for the calling thread
+  if the thread has no cached context, otherwise it is freed.
+
+  @param[in]  Ctx  The HMAC context. It may be NULL.
+**/
+VOID
+InternalCryptReleaseHmacCtx (
+  IN  HMAC_CTX  *Ctx
+  );
+
+/**
+  Prepare an SM2 context for Sm2Sign() and Sm2Verify(), by caching the Z value of its public key.
+
+  It is called when the SM2 context is created or its public key changes. A context that is not prepared
+  still signs and verifies, computing the Z value every time.
+
+  @param[in, out]  Sm2Context  Pointer to the SM2 context.
+
+  @retval  TRUE   The SM2 context is prepared.
+  @retval  FALSE  The SM2 context has no public key, or the preparation failed.
+**/
+BOOLEAN
+Sm2PrepareKey (
+  IN OUT  VOID  *Sm2Context
+  );
+
 #endif
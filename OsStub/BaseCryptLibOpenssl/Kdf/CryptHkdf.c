@@ -230,7 +230,7 @@ HkdfSha256ExtractAndExpand (
   IN   UINTN        OutSize
   )
 {
-  return HkdfMdExtractAndExpand (EVP_sha256(), Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
+  return HkdfMdExtractAndExpand (InternalCryptGetMd (CryptMdSha256), Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
 }
 
 /**
@@ -258,7 +258,7 @@ HkdfSha256Extract (
   IN   UINTN        PrkOutSize
   )
 {
-  return HkdfMdExtract (EVP_sha256(), Key, KeySize, Salt, SaltSize, PrkOut, PrkOutSize);
+  return HkdfMdExtract (InternalCryptGetMd (CryptMdSha256), Key, KeySize, Salt, SaltSize, PrkOut, PrkOutSize);
 }
 
 /**
@@ -286,7 +286,7 @@ HkdfSha256Expand (
   IN   UINTN        OutSize
   )
 {
-  return HkdfMdExpand (EVP_sha256(), Prk, PrkSize, Info, InfoSize, Out, OutSize);
+  return HkdfMdExpand (InternalCryptGetMd (CryptMdSha256), Prk, PrkSize, Info, InfoSize, Out, OutSize);
 }
 
 /**
@@ -318,7 +318,7 @@ HkdfSha384ExtractAndExpand (
   IN   UINTN        OutSize
   )
 {
-  return HkdfMdExtractAndExpand (EVP_sha384(), Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
+  return HkdfMdExtractAndExpand (InternalCryptGetMd (CryptMdSha384), Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
 }
 
 /**
@@ -346,7 +346,7 @@ HkdfSha384Extract (
   IN   UINTN        PrkOutSize
   )
 {
-  return HkdfMdExtract (EVP_sha384(), Key, KeySize, Salt, SaltSize, PrkOut, PrkOutSize);
+  return HkdfMdExtract (InternalCryptGetMd (CryptMdSha384), Key, KeySize, Salt, SaltSize, PrkOut, PrkOutSize);
 }
 
 /**
@@ -374,7 +374,7 @@ HkdfSha384Expand (
   IN   UINTN        OutSize
   )
 {
-  return HkdfMdExpand (EVP_sha384(), Prk, PrkSize, Info, InfoSize, Out, OutSize);
+  return HkdfMdExpand (InternalCryptGetMd (CryptMdSha384), Prk, PrkSize, Info, InfoSize, Out, OutSize);
 }
 
 /**
@@ -406,7 +406,7 @@ HkdfSha512ExtractAndExpand (
   IN   UINTN        OutSize
   )
 {
-  return HkdfMdExtractAndExpand (EVP_sha512(), Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
+  return HkdfMdExtractAndExpand (InternalCryptGetMd (CryptMdSha512), Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
 }
 
 /**
@@ -434,7 +434,7 @@ HkdfSha512Extract (
   IN   UINTN        PrkOutSize
   )
 {
-  return HkdfMdExtract (EVP_sha512(), Key, KeySize, Salt, SaltSize, PrkOut, PrkOutSize);
+  return HkdfMdExtract (InternalCryptGetMd (CryptMdSha512), Key, KeySize, Salt, SaltSize, PrkOut, PrkOutSize);
 }
 
 /**
@@ -462,5 +462,5 @@ HkdfSha512Expand (
   IN   UINTN        OutSize
   )
 {
-  return HkdfMdExpand (EVP_sha512(), Prk, PrkSize, Info, InfoSize, Out, OutSize);
+  return HkdfMdExpand (InternalCryptGetMd (CryptMdSha512), Prk, PrkSize, Info, InfoSize, Out, OutSize);
 }
@@ -83,13 +83,13 @@ CmacAesInit (
   
   switch (KeySize) {
   case 16:
-    Cipher = EVP_aes_128_cbc();
+    Cipher = InternalCryptGetCipher (CryptCipherAes128Cbc);
     break;
   case 24:
-    Cipher = EVP_aes_192_cbc();
+    Cipher = InternalCryptGetCipher (CryptCipherAes192Cbc);
     break;
   case 32:
-    Cipher = EVP_aes_256_cbc();
+    Cipher = InternalCryptGetCipher (CryptCipherAes256Cbc);
     break;
   default:
     return FALSE;
@@ -274,13 +274,13 @@ CmacAesAll (
   
   switch (KeySize) {
   case 16:
-    Cipher = EVP_aes_128_cbc();
+    Cipher = InternalCryptGetCipher (CryptCipherAes128Cbc);
     break;
   case 24:
-    Cipher = EVP_aes_192_cbc();
+    Cipher = InternalCryptGetCipher (CryptCipherAes192Cbc);
     break;
   case 32:
-    Cipher = EVP_aes_256_cbc();
+    Cipher = InternalCryptGetCipher (CryptCipherAes256Cbc);
     break;
   default:
     return FALSE;
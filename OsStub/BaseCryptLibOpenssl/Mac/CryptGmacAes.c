@@ -109,13 +109,13 @@ GmacAesInit (
   
   switch (KeySize) {
   case 16:
-    Gctx->Cipher = EVP_aes_128_gcm();
+    Gctx->Cipher = InternalCryptGetCipher (CryptCipherAes128Gcm);
     break;
   case 24:
-    Gctx->Cipher = EVP_aes_192_gcm();
+    Gctx->Cipher = InternalCryptGetCipher (CryptCipherAes192Gcm);
     break;
   case 32:
-    Gctx->Cipher = EVP_aes_256_gcm();
+    Gctx->Cipher = InternalCryptGetCipher (CryptCipherAes256Gcm);
     break;
   default:
     return FALSE;
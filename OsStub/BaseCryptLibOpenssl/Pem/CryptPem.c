@@ -227,6 +227,29 @@ _Exit:
   return Status;
 }
 
+/**
+  Retrieve the EC Private Key held by the crypto implementation, such as a persistent key
+  provisioned in a secure element.
+
+  This interface is not supported, so it always returns FALSE.
+
+  @param[in]  KeyId        The key identifier of the crypto implementation.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which refer to the
+                           EC private key.
+
+  @retval  FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPrivateKeyFromKeyId (
+  IN   UINT32       KeyId,
+  OUT  VOID         **EcContext
+  )
+{
+  return FALSE;
+}
+
 /**
   Retrieve the Ed Private Key from the password-protected PEM key data.
 
@@ -394,6 +417,7 @@ Sm2GetPrivateKeyFromPem (
   if (Result == 0) {
     goto _Exit;
   }
+  Sm2PrepareKey (Pkey);
 
   *Sm2Context = Pkey;
   Status = TRUE;
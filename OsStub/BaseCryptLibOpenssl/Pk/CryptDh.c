@@ -48,6 +48,10 @@ DhNewByNid (
   IN UINTN  Nid
   )
 {
+  //
+  // DH_new_by_nid() shares the RFC 7919 prime and generator across contexts, and sets the private
+  // key length of the group to 225, 275 and 325 bits, as allowed by RFC 7919 section 5.2.
+  //
   switch (Nid) {
   case CRYPTO_NID_FFDHE2048:
     return DH_new_by_nid (NID_ffdhe2048);
@@ -815,3 +815,282 @@ EcDsaVerify (
 
   return (Result == 1);
 }
+
+//
+// A public key prepared for repeated EC-DSA verification.
+// PublicKeyGroup is the curve with the public key point as its generator,
+// so that both groups keep the precomputed multiples of their generator.
+//
+typedef struct {
+  EC_GROUP   *Group;
+  EC_GROUP   *PublicKeyGroup;
+  UINT8      HalfSize;
+} EC_PREPARED_PUBLIC_KEY;
+
+/**
+  Release the specified prepared public key.
+
+  @param[in]  PreparedKey  Pointer to the prepared public key to be released.
+
+**/
+VOID
+EFIAPI
+EcDsaFreePreparedPublicKey (
+  IN  VOID         *PreparedKey
+  )
+{
+  EC_PREPARED_PUBLIC_KEY  *Prepared;
+
+  if (PreparedKey == NULL) {
+    return ;
+  }
+  Prepared = PreparedKey;
+  if (Prepared->Group != NULL) {
+    EC_GROUP_free (Prepared->Group);
+  }
+  if (Prepared->PublicKeyGroup != NULL) {
+    EC_GROUP_free (Prepared->PublicKeyGroup);
+  }
+  FreePool (Prepared);
+}
+
+/**
+  Prepares the public key of an EC context for repeated EC-DSA verification.
+
+  The prepared public key holds precomputed multiples of the public key point and of
+  the curve generator, so that EcDsaVerifyPrepared() is faster than EcDsaVerify().
+  It does not refer to EcContext, which may be released before the prepared public key.
+
+  If EcContext is NULL, then return NULL.
+
+  @param[in]  EcContext    Pointer to EC context holding the public key.
+
+  @return  Pointer to the prepared public key.
+           If the public key is invalid or the allocations fails, EcDsaPreparePublicKey() returns NULL.
+
+**/
+VOID *
+EFIAPI
+EcDsaPreparePublicKey (
+  IN  VOID         *EcContext
+  )
+{
+  EC_KEY                  *EcKey;
+  CONST EC_GROUP          *KeyGroup;
+  CONST EC_POINT          *PublicKey;
+  EC_PREPARED_PUBLIC_KEY  *Prepared;
+  BN_CTX                  *Ctx;
+
+  if (EcContext == NULL) {
+    return NULL;
+  }
+
+  EcKey = (EC_KEY *) EcContext;
+  KeyGroup = EC_KEY_get0_group (EcKey);
+  PublicKey = EC_KEY_get0_public_key (EcKey);
+  if (KeyGroup == NULL || PublicKey == NULL) {
+    return NULL;
+  }
+  if (EC_KEY_check_key (EcKey) != 1) {
+    return NULL;
+  }
+
+  Prepared = AllocateZeroPool (sizeof(EC_PREPARED_PUBLIC_KEY));
+  if (Prepared == NULL) {
+    return NULL;
+  }
+  switch (EC_GROUP_get_curve_name (KeyGroup)) {
+  case NID_X9_62_prime256v1:
+    Prepared->HalfSize = 32;
+    break;
+  case NID_secp384r1:
+    Prepared->HalfSize = 48;
+    break;
+  case NID_secp521r1:
+    Prepared->HalfSize = 66;
+    break;
+  default:
+    goto Error;
+  }
+
+  Ctx = BN_CTX_new ();
+  if (Ctx == NULL) {
+    goto Error;
+  }
+  Prepared->Group = EC_GROUP_dup (KeyGroup);
+  Prepared->PublicKeyGroup = EC_GROUP_dup (KeyGroup);
+  if (Prepared->Group == NULL || Prepared->PublicKeyGroup == NULL ||
+      EC_GROUP_set_generator (Prepared->PublicKeyGroup, PublicKey, EC_GROUP_get0_order (KeyGroup), EC_GROUP_get0_cofactor (KeyGroup)) != 1 ||
+      EC_GROUP_precompute_mult (Prepared->Group, Ctx) != 1 ||
+      EC_GROUP_precompute_mult (Prepared->PublicKeyGroup, Ctx) != 1) {
+    BN_CTX_free (Ctx);
+    goto Error;
+  }
+  BN_CTX_free (Ctx);
+  return Prepared;
+
+Error:
+  EcDsaFreePreparedPublicKey (Prepared);
+  return NULL;
+}
+
+/**
+  Verifies the EC-DSA signature with a prepared public key.
+
+  The result is the same as EcDsaVerify() with the EC context the public key is prepared from.
+
+  If PreparedKey is NULL, then return FALSE.
+  If MessageHash is NULL, then return FALSE.
+  If Signature is NULL, then return FALSE.
+  If HashSize need match the HashNid. HashNid could be SHA256, SHA384, SHA512.
+
+  @param[in]  PreparedKey  Pointer to the prepared public key for signature verification.
+  @param[in]  HashNid      hash NID
+  @param[in]  MessageHash  Pointer to octet message hash to be checked.
+  @param[in]  HashSize     Size of the message hash in bytes.
+  @param[in]  Signature    Pointer to EC-DSA signature to be verified.
+  @param[in]  SigSize      Size of signature in bytes.
+
+  @retval  TRUE   Valid signature encoded in EC-DSA.
+  @retval  FALSE  Invalid signature or invalid prepared public key.
+
+**/
+BOOLEAN
+EFIAPI
+EcDsaVerifyPrepared (
+  IN  VOID         *PreparedKey,
+  IN  UINTN        HashNid,
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize
+  )
+{
+  EC_PREPARED_PUBLIC_KEY  *Prepared;
+  CONST BIGNUM            *Order;
+  INTN                    OrderBits;
+  BN_CTX                  *Ctx;
+  BIGNUM                  *R;
+  BIGNUM                  *S;
+  BIGNUM                  *E;
+  BIGNUM                  *W;
+  BIGNUM                  *U1;
+  BIGNUM                  *U2;
+  BIGNUM                  *X;
+  BIGNUM                  *Zero;
+  EC_POINT                *Point1;
+  EC_POINT                *Point2;
+  BOOLEAN                 RetVal;
+
+  if (PreparedKey == NULL || MessageHash == NULL || Signature == NULL) {
+    return FALSE;
+  }
+
+  Prepared = PreparedKey;
+  if (SigSize != (UINTN)(Prepared->HalfSize * 2)) {
+    return FALSE;
+  }
+
+  switch (HashNid) {
+  case CRYPTO_NID_SHA256:
+    if (HashSize != SHA256_DIGEST_SIZE) {
+      return FALSE;
+    }
+    break;
+
+  case CRYPTO_NID_SHA384:
+    if (HashSize != SHA384_DIGEST_SIZE) {
+      return FALSE;
+    }
+    break;
+
+  case CRYPTO_NID_SHA512:
+    if (HashSize != SHA512_DIGEST_SIZE) {
+      return FALSE;
+    }
+    break;
+
+  default:
+    return FALSE;
+  }
+
+  Ctx = BN_CTX_new ();
+  if (Ctx == NULL) {
+    return FALSE;
+  }
+  BN_CTX_start (Ctx);
+  R = BN_CTX_get (Ctx);
+  S = BN_CTX_get (Ctx);
+  E = BN_CTX_get (Ctx);
+  W = BN_CTX_get (Ctx);
+  U1 = BN_CTX_get (Ctx);
+  U2 = BN_CTX_get (Ctx);
+  X = BN_CTX_get (Ctx);
+  Zero = BN_CTX_get (Ctx);
+  Point1 = EC_POINT_new (Prepared->Group);
+  Point2 = EC_POINT_new (Prepared->Group);
+  RetVal = FALSE;
+  if (Zero == NULL || Point1 == NULL || Point2 == NULL) {
+    goto Done;
+  }
+
+  //
+  // R and S must be in [1, n - 1].
+  //
+  Order = EC_GROUP_get0_order (Prepared->Group);
+  if (BN_bin2bn (Signature, (UINT32) Prepared->HalfSize, R) == NULL ||
+      BN_bin2bn (Signature + Prepared->HalfSize, (UINT32) Prepared->HalfSize, S) == NULL) {
+    goto Done;
+  }
+  if (BN_is_zero (R) || BN_is_zero (S) || BN_ucmp (R, Order) >= 0 || BN_ucmp (S, Order) >= 0) {
+    goto Done;
+  }
+
+  //
+  // E is the leftmost bits of the message hash, as many as the bits of the order.
+  //
+  if (BN_bin2bn (MessageHash, (UINT32) HashSize, E) == NULL) {
+    goto Done;
+  }
+  OrderBits = BN_num_bits (Order);
+  if ((INTN)(HashSize * 8) > OrderBits) {
+    if (BN_rshift (E, E, (INT32)(HashSize * 8 - OrderBits)) != 1) {
+      goto Done;
+    }
+  }
+
+  //
+  // U1 = E / S, U2 = R / S, and the signature is valid if R = (U1 * G + U2 * Q).x mod n.
+  // Both multiplications use the precomputed multiples of the generator of their group.
+  // A generator only multiplication is done by the constant time ladder, which does not use
+  // the precomputed multiples, so a zero multiple of a point is added to select the wNAF method.
+  //
+  BN_zero (Zero);
+  if (BN_mod_inverse (W, S, Order, Ctx) == NULL ||
+      BN_mod_mul (U1, E, W, Order, Ctx) != 1 ||
+      BN_mod_mul (U2, R, W, Order, Ctx) != 1 ||
+      EC_POINT_mul (Prepared->Group, Point1, U1, EC_GROUP_get0_generator (Prepared->Group), Zero, Ctx) != 1 ||
+      EC_POINT_mul (Prepared->PublicKeyGroup, Point2, U2, EC_GROUP_get0_generator (Prepared->Group), Zero, Ctx) != 1 ||
+      EC_POINT_add (Prepared->Group, Point1, Point1, Point2, Ctx) != 1) {
+    goto Done;
+  }
+  if (EC_POINT_is_at_infinity (Prepared->Group, Point1)) {
+    goto Done;
+  }
+  if (EC_POINT_get_affine_coordinates (Prepared->Group, Point1, X, NULL, Ctx) != 1 ||
+      BN_nnmod (X, X, Order, Ctx) != 1) {
+    goto Done;
+  }
+  RetVal = (BOOLEAN)(BN_ucmp (X, R) == 0);
+
+Done:
+  if (Point1 != NULL) {
+    EC_POINT_free (Point1);
+  }
+  if (Point2 != NULL) {
+    EC_POINT_free (Point2);
+  }
+  BN_CTX_end (Ctx);
+  BN_CTX_free (Ctx);
+  return RetVal;
+}
@@ -0,0 +1,250 @@
+/** @file
+  Montgomery-Curve Wrapper Implementation over OpenSSL.
+
+  RFC 7748 - Elliptic Curves for Security (X25519 and X448)
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <openssl/evp.h>
+
+///
+/// The key is generated by EcxGenerateKey, so the context holds the curve until then.
+///
+typedef struct {
+  INT32     OpenSslPkeyType;
+  UINTN     KeySize;
+  EVP_PKEY  *Pkey;
+} ECX_CONTEXT;
+
+/**
+  Allocates and Initializes one Montgomery-Curve Context for subsequent use
+  with the NID.
+
+  @param Nid cipher NID, CRYPTO_NID_X25519 or CRYPTO_NID_X448.
+
+  @return  Pointer to the Montgomery-Curve Context that has been initialized.
+           If the allocations fails, EcxNewByNid() returns NULL.
+
+**/
+VOID *
+EFIAPI
+EcxNewByNid (
+  IN UINTN  Nid
+  )
+{
+  ECX_CONTEXT  *EcxContext;
+
+  EcxContext = AllocateZeroPool (sizeof(ECX_CONTEXT));
+  if (EcxContext == NULL) {
+    return NULL;
+  }
+  switch (Nid) {
+  case CRYPTO_NID_X25519:
+    EcxContext->OpenSslPkeyType = EVP_PKEY_X25519;
+    EcxContext->KeySize = 32;
+    break;
+  case CRYPTO_NID_X448:
+    EcxContext->OpenSslPkeyType = EVP_PKEY_X448;
+    EcxContext->KeySize = 56;
+    break;
+  default:
+    FreePool (EcxContext);
+    return NULL;
+  }
+  return EcxContext;
+}
+
+/**
+  Release the specified Montgomery-Curve context.
+
+  @param[in]  EcxContext  Pointer to the Montgomery-Curve context to be released.
+
+**/
+VOID
+EFIAPI
+EcxFree (
+  IN  VOID  *EcxContext
+  )
+{
+  ECX_CONTEXT  *Context;
+
+  if (EcxContext == NULL) {
+    return ;
+  }
+  Context = EcxContext;
+  EVP_PKEY_free (Context->Pkey);
+  FreePool (Context);
+}
+
+/**
+  Generates Montgomery-Curve key and returns the public key.
+
+  This function generates random secret, and computes the public key, which is
+  returned via parameter Public, PublicSize.
+  The public key is the u-coordinate in little-endian, as defined in RFC 7748.
+  If the Public buffer is too small to hold the public key, FALSE is returned and
+  PublicSize is set to the required buffer size to obtain the public key.
+
+  For X25519, the PublicSize is 32.
+  For X448, the PublicSize is 56.
+
+  If EcxContext is NULL, then return FALSE.
+  If PublicSize is NULL, then return FALSE.
+  If PublicSize is large enough but Public is NULL, then return FALSE.
+
+  @param[in, out]  EcxContext     Pointer to the Montgomery-Curve context.
+  @param[out]      Public         Pointer to the buffer to receive generated public key.
+  @param[in, out]  PublicSize     On input, the size of Public buffer in bytes.
+                                  On output, the size of data returned in Public buffer in bytes.
+
+  @retval TRUE   Montgomery-Curve public key generation succeeded.
+  @retval FALSE  Montgomery-Curve public key generation failed.
+  @retval FALSE  PublicSize is not large enough.
+
+**/
+BOOLEAN
+EFIAPI
+EcxGenerateKey (
+  IN OUT  VOID   *EcxContext,
+  OUT     UINT8  *Public,
+  IN OUT  UINTN  *PublicSize
+  )
+{
+  ECX_CONTEXT   *Context;
+  EVP_PKEY_CTX  *Pctx;
+  EVP_PKEY      *Pkey;
+  size_t        Size;
+  INT32         Result;
+
+  if (EcxContext == NULL || PublicSize == NULL) {
+    return FALSE;
+  }
+  if (Public == NULL && *PublicSize != 0) {
+    return FALSE;
+  }
+  Context = EcxContext;
+  if (*PublicSize < Context->KeySize) {
+    *PublicSize = Context->KeySize;
+    return FALSE;
+  }
+
+  Pctx = EVP_PKEY_CTX_new_id (Context->OpenSslPkeyType, NULL);
+  if (Pctx == NULL) {
+    return FALSE;
+  }
+  Result = EVP_PKEY_keygen_init (Pctx);
+  if (Result <= 0) {
+    EVP_PKEY_CTX_free (Pctx);
+    return FALSE;
+  }
+  Pkey = NULL;
+  Result = EVP_PKEY_keygen (Pctx, &Pkey);
+  EVP_PKEY_CTX_free (Pctx);
+  if (Result <= 0) {
+    return FALSE;
+  }
+
+  Size = Context->KeySize;
+  Result = EVP_PKEY_get_raw_public_key (Pkey, Public, &Size);
+  if (Result <= 0 || Size != Context->KeySize) {
+    EVP_PKEY_free (Pkey);
+    return FALSE;
+  }
+
+  EVP_PKEY_free (Context->Pkey);
+  Context->Pkey = Pkey;
+  *PublicSize = Context->KeySize;
+  return TRUE;
+}
+
+/**
+  Computes exchanged common key.
+
+  Given peer's public key, this function computes the exchanged common key,
+  based on its own context including value of curve parameter and random secret.
+  The peer's public key is the u-coordinate in little-endian, as defined in RFC 7748.
+  The exchanged key is rejected if it is all zero, which is the result of a
+  low-order peer's public key.
+
+  If EcxContext is NULL, then return FALSE.
+  If PeerPublic is NULL, then return FALSE.
+  If PeerPublicSize is not the size of the public key, then return FALSE.
+  If Key is NULL, then return FALSE.
+  If KeySize is not large enough, then return FALSE.
+
+  For X25519, the PeerPublicSize and KeySize are 32.
+  For X448, the PeerPublicSize and KeySize are 56.
+
+  @param[in, out]  EcxContext         Pointer to the Montgomery-Curve context.
+  @param[in]       PeerPublic         Pointer to the peer's public key.
+  @param[in]       PeerPublicSize     Size of peer's public key in bytes.
+  @param[out]      Key                Pointer to the buffer to receive generated key.
+  @param[in, out]  KeySize            On input, the size of Key buffer in bytes.
+                                      On output, the size of data returned in Key buffer in bytes.
+
+  @retval TRUE   Montgomery-Curve exchanged key generation succeeded.
+  @retval FALSE  Montgomery-Curve exchanged key generation failed.
+  @retval FALSE  KeySize is not large enough.
+
+**/
+BOOLEAN
+EFIAPI
+EcxComputeKey (
+  IN OUT  VOID         *EcxContext,
+  IN      CONST UINT8  *PeerPublic,
+  IN      UINTN        PeerPublicSize,
+  OUT     UINT8        *Key,
+  IN OUT  UINTN        *KeySize
+  )
+{
+  ECX_CONTEXT   *Context;
+  EVP_PKEY      *PeerPkey;
+  EVP_PKEY_CTX  *Pctx;
+  size_t        Size;
+  INT32         Result;
+
+  if (EcxContext == NULL || PeerPublic == NULL || KeySize == NULL || Key == NULL) {
+    return FALSE;
+  }
+  Context = EcxContext;
+  if (Context->Pkey == NULL || PeerPublicSize != Context->KeySize) {
+    return FALSE;
+  }
+  if (*KeySize < Context->KeySize) {
+    *KeySize = Context->KeySize;
+    return FALSE;
+  }
+
+  PeerPkey = EVP_PKEY_new_raw_public_key (Context->OpenSslPkeyType, NULL, PeerPublic, PeerPublicSize);
+  if (PeerPkey == NULL) {
+    return FALSE;
+  }
+  Pctx = EVP_PKEY_CTX_new (Context->Pkey, NULL);
+  if (Pctx == NULL) {
+    EVP_PKEY_free (PeerPkey);
+    return FALSE;
+  }
+  //
+  // The derivation fails if the shared secret is all zero.
+  //
+  Size = *KeySize;
+  Result = EVP_PKEY_derive_init (Pctx);
+  if (Result > 0) {
+    Result = EVP_PKEY_derive_set_peer (Pctx, PeerPkey);
+  }
+  if (Result > 0) {
+    Result = EVP_PKEY_derive (Pctx, Key, &Size);
+  }
+  EVP_PKEY_CTX_free (Pctx);
+  EVP_PKEY_free (PeerPkey);
+  if (Result <= 0) {
+    return FALSE;
+  }
+
+  *KeySize = Size;
+  return TRUE;
+}
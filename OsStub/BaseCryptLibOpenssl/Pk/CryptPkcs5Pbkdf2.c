@@ -69,7 +69,7 @@ Pkcs5HashPassword (
   //
   switch (DigestSize) {
   case SHA256_DIGEST_SIZE:
-    HashAlg = EVP_sha256();
+    HashAlg = InternalCryptGetMd (CryptMdSha256);
     break;
   default:
     return FALSE;
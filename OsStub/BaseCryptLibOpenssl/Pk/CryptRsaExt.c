@@ -506,42 +506,42 @@ RsaPssSign (
 
   switch (HashNid) {
   case CRYPTO_NID_SHA256:
-    HashAlg = EVP_sha256();
+    HashAlg = InternalCryptGetMd (CryptMdSha256);
     if (HashSize != SHA256_DIGEST_SIZE) {
       return FALSE;
     }
     break;
 
   case CRYPTO_NID_SHA384:
-    HashAlg = EVP_sha384();
+    HashAlg = InternalCryptGetMd (CryptMdSha384);
     if (HashSize != SHA384_DIGEST_SIZE) {
       return FALSE;
     }
     break;
 
   case CRYPTO_NID_SHA512:
-    HashAlg = EVP_sha512();
+    HashAlg = InternalCryptGetMd (CryptMdSha512);
     if (HashSize != SHA512_DIGEST_SIZE) {
       return FALSE;
     }
     break;
 
   case CRYPTO_NID_SHA3_256:
-    HashAlg = EVP_sha3_256();
+    HashAlg = InternalCryptGetMd (CryptMdSha3_256);
     if (HashSize != SHA3_256_DIGEST_SIZE) {
       return FALSE;
     }
     break;
 
   case CRYPTO_NID_SHA3_384:
-    HashAlg = EVP_sha3_384();
+    HashAlg = InternalCryptGetMd (CryptMdSha3_384);
     if (HashSize != SHA3_384_DIGEST_SIZE) {
       return FALSE;
     }
     break;
 
   case CRYPTO_NID_SHA3_512:
-    HashAlg = EVP_sha3_512();
+    HashAlg = InternalCryptGetMd (CryptMdSha3_512);
     if (HashSize != SHA3_512_DIGEST_SIZE) {
       return FALSE;
     }
@@ -550,6 +550,9 @@ RsaPssSign (
   default:
     return FALSE;
   }
+  if (HashAlg == NULL) {
+    return FALSE;
+  }
 
   Buffer = AllocatePool (Size);
   if (Buffer == NULL) {
@@ -11,9 +11,308 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <openssl/ec.h>
 #include <openssl/bn.h>
 #include <openssl/objects.h>
+#include <openssl/crypto.h>
 
 #define DEFAULT_SM2_ID "1234567812345678"
 
+#define SM2_FIELD_SIZE  32
+
+//
+// The Z value of an SM2 key, H(ENTL || ID || a || b || xG || yG || xA || yA), kept in the ex_data of its EC_KEY.
+// It is set when the key is loaded or its public key changes, and only read by Sm2Sign() and Sm2Verify(),
+// so a key shared by several threads does not need a lock.
+//
+typedef struct {
+  UINT8  Z[SM3_256_DIGEST_SIZE];
+} SM2_KEY_CACHE;
+
+STATIC CRYPTO_ONCE  mSm2KeyCacheOnce = CRYPTO_ONCE_STATIC_INIT;
+STATIC INT32        mSm2KeyCacheIndex = -1;
+
+/**
+  Duplicate the SM2 key cache when its EC_KEY is duplicated.
+**/
+STATIC
+INT32
+Sm2KeyCacheDup (
+  CRYPTO_EX_DATA        *To,
+  CONST CRYPTO_EX_DATA  *From,
+  VOID                  *FromData,
+  INT32                 Index,
+  long                  Argl,
+  VOID                  *Argp
+  )
+{
+  VOID  **Cache;
+  VOID  *NewCache;
+
+  //
+  // FromData points to the pointer that is set in the duplicated EC_KEY.
+  //
+  Cache = FromData;
+  if (*Cache != NULL) {
+    NewCache = AllocatePool (sizeof(SM2_KEY_CACHE));
+    if (NewCache == NULL) {
+      return 0;
+    }
+    CopyMem (NewCache, *Cache, sizeof(SM2_KEY_CACHE));
+    *Cache = NewCache;
+  }
+  return 1;
+}
+
+/**
+  Release the SM2 key cache when its EC_KEY is released.
+**/
+STATIC
+VOID
+Sm2KeyCacheFree (
+  VOID                  *Parent,
+  VOID                  *Cache,
+  CRYPTO_EX_DATA        *ExData,
+  INT32                 Index,
+  long                  Argl,
+  VOID                  *Argp
+  )
+{
+  if (Cache != NULL) {
+    FreePool (Cache);
+  }
+}
+
+STATIC
+VOID
+Sm2KeyCacheInitIndex (
+  VOID
+  )
+{
+  mSm2KeyCacheIndex = EC_KEY_get_ex_new_index (0, NULL, NULL, Sm2KeyCacheDup, Sm2KeyCacheFree);
+}
+
+/**
+  Return the EC_KEY of an SM2 context.
+
+  @param[in]  Pkey  Pointer to the SM2 context.
+
+  @return the EC_KEY of the SM2 context.
+**/
+STATIC
+EC_KEY *
+Sm2GetEcKey (
+  IN  EVP_PKEY  *Pkey
+  )
+{
+  EC_KEY  *EcKey;
+
+  EVP_PKEY_set_alias_type(Pkey, EVP_PKEY_EC);
+  EcKey = EVP_PKEY_get0_EC_KEY(Pkey);
+  EVP_PKEY_set_alias_type(Pkey, EVP_PKEY_SM2);
+  return EcKey;
+}
+
+/**
+  Add a big number, padded to the field size, to an SM3 hash.
+
+  @param[in]  HashCtx  The SM3 hash context.
+  @param[in]  Bn       The big number.
+
+  @retval  TRUE   The big number is hashed.
+  @retval  FALSE  The big number is larger than the field size.
+**/
+STATIC
+BOOLEAN
+Sm2HashBn (
+  IN  EVP_MD_CTX    *HashCtx,
+  IN  CONST BIGNUM  *Bn
+  )
+{
+  UINT8  Buffer[SM2_FIELD_SIZE];
+
+  if (BN_bn2binpad (Bn, Buffer, sizeof(Buffer)) != sizeof(Buffer)) {
+    return FALSE;
+  }
+  return (BOOLEAN) EVP_DigestUpdate (HashCtx, Buffer, sizeof(Buffer));
+}
+
+/**
+  Compute the Z value of an SM2 key with the default ID.
+
+  @param[in]   EcKey  The EC_KEY of the SM2 key.
+  @param[out]  Z      Pointer to the buffer to receive the Z value.
+
+  @retval  TRUE   The Z value is computed.
+  @retval  FALSE  The key has no public key, or the computation failed.
+**/
+STATIC
+BOOLEAN
+Sm2ComputeZ (
+  IN   CONST EC_KEY  *EcKey,
+  OUT  UINT8         *Z
+  )
+{
+  CONST EC_GROUP  *Group;
+  CONST EC_POINT  *PublicKey;
+  BN_CTX          *BnCtx;
+  BIGNUM          *P;
+  BIGNUM          *A;
+  BIGNUM          *B;
+  BIGNUM          *X;
+  BIGNUM          *Y;
+  EVP_MD_CTX      *HashCtx;
+  UINT8           Entl[2];
+  BOOLEAN         RetVal;
+
+  Group = EC_KEY_get0_group (EcKey);
+  PublicKey = EC_KEY_get0_public_key (EcKey);
+  if (Group == NULL || PublicKey == NULL) {
+    return FALSE;
+  }
+
+  BnCtx = BN_CTX_new ();
+  HashCtx = EVP_MD_CTX_new ();
+  if (BnCtx == NULL || HashCtx == NULL) {
+    RetVal = FALSE;
+    goto Done;
+  }
+  BN_CTX_start (BnCtx);
+  P = BN_CTX_get (BnCtx);
+  A = BN_CTX_get (BnCtx);
+  B = BN_CTX_get (BnCtx);
+  X = BN_CTX_get (BnCtx);
+  Y = BN_CTX_get (BnCtx);
+  if (Y == NULL) {
+    RetVal = FALSE;
+    goto Done;
+  }
+
+  //
+  // ENTL is the length of the ID in bits, in 2 bytes.
+  //
+  Entl[0] = (UINT8)(((sizeof(DEFAULT_SM2_ID) - 1) * 8) >> 8);
+  Entl[1] = (UINT8)((sizeof(DEFAULT_SM2_ID) - 1) * 8);
+  RetVal = (BOOLEAN) (EVP_DigestInit_ex (HashCtx, InternalCryptGetMd (CryptMdSm3), NULL) == 1 &&
+                      EVP_DigestUpdate (HashCtx, Entl, sizeof(Entl)) == 1 &&
+                      EVP_DigestUpdate (HashCtx, DEFAULT_SM2_ID, sizeof(DEFAULT_SM2_ID) - 1) == 1 &&
+                      EC_GROUP_get_curve (Group, P, A, B, BnCtx) == 1 &&
+                      Sm2HashBn (HashCtx, A) &&
+                      Sm2HashBn (HashCtx, B) &&
+                      EC_POINT_get_affine_coordinates (Group, EC_GROUP_get0_generator (Group), X, Y, BnCtx) == 1 &&
+                      Sm2HashBn (HashCtx, X) &&
+                      Sm2HashBn (HashCtx, Y) &&
+                      EC_POINT_get_affine_coordinates (Group, PublicKey, X, Y, BnCtx) == 1 &&
+                      Sm2HashBn (HashCtx, X) &&
+                      Sm2HashBn (HashCtx, Y) &&
+                      EVP_DigestFinal_ex (HashCtx, Z, NULL) == 1);
+
+Done:
+  if (BnCtx != NULL) {
+    BN_CTX_end (BnCtx);
+    BN_CTX_free (BnCtx);
+  }
+  if (HashCtx != NULL) {
+    EVP_MD_CTX_free (HashCtx);
+  }
+  return RetVal;
+}
+
+/**
+  Prepare an SM2 context for Sm2Sign() and Sm2Verify(), by caching the Z value of its public key.
+
+  It is called when the SM2 context is created or its public key changes. A context that is not prepared
+  still signs and verifies, computing the Z value every time.
+
+  @param[in, out]  Sm2Context  Pointer to the SM2 context.
+
+  @retval  TRUE   The SM2 context is prepared.
+  @retval  FALSE  The SM2 context has no public key, or the preparation failed.
+**/
+BOOLEAN
+Sm2PrepareKey (
+  IN OUT  VOID  *Sm2Context
+  )
+{
+  EC_KEY         *EcKey;
+  SM2_KEY_CACHE  *Cache;
+
+  if (CRYPTO_THREAD_run_once (&mSm2KeyCacheOnce, Sm2KeyCacheInitIndex) != 1 || mSm2KeyCacheIndex < 0) {
+    return FALSE;
+  }
+  EcKey = Sm2GetEcKey ((EVP_PKEY *)Sm2Context);
+  if (EcKey == NULL) {
+    return FALSE;
+  }
+
+  Cache = EC_KEY_get_ex_data (EcKey, mSm2KeyCacheIndex);
+  if (Cache == NULL) {
+    Cache = AllocateZeroPool (sizeof(SM2_KEY_CACHE));
+    if (Cache == NULL) {
+      return FALSE;
+    }
+    if (EC_KEY_set_ex_data (EcKey, mSm2KeyCacheIndex, Cache) != 1) {
+      FreePool (Cache);
+      return FALSE;
+    }
+  }
+  if (!Sm2ComputeZ (EcKey, Cache->Z)) {
+    EC_KEY_set_ex_data (EcKey, mSm2KeyCacheIndex, NULL);
+    FreePool (Cache);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Compute the digest signed by SM2, H(Z || Message), with the cached Z value if the SM2 context is prepared.
+
+  @param[in]   Pkey     Pointer to the SM2 context.
+  @param[in]   Message  Pointer to the message.
+  @param[in]   Size     Size of the message in bytes.
+  @param[out]  Digest   Pointer to the buffer to receive the digest.
+
+  @retval  TRUE   The digest is computed.
+  @retval  FALSE  The computation failed.
+**/
+STATIC
+BOOLEAN
+Sm2ComputeMessageDigest (
+  IN   EVP_PKEY     *Pkey,
+  IN   CONST UINT8  *Message,
+  IN   UINTN        Size,
+  OUT  UINT8        *Digest
+  )
+{
+  EC_KEY         *EcKey;
+  SM2_KEY_CACHE  *Cache;
+  UINT8          Z[SM3_256_DIGEST_SIZE];
+  EVP_MD_CTX     *HashCtx;
+  BOOLEAN        RetVal;
+
+  EcKey = Sm2GetEcKey (Pkey);
+  if (EcKey == NULL) {
+    return FALSE;
+  }
+  Cache = NULL;
+  if (CRYPTO_THREAD_run_once (&mSm2KeyCacheOnce, Sm2KeyCacheInitIndex) == 1 && mSm2KeyCacheIndex >= 0) {
+    Cache = EC_KEY_get_ex_data (EcKey, mSm2KeyCacheIndex);
+  }
+  if (Cache != NULL) {
+    CopyMem (Z, Cache->Z, sizeof(Z));
+  } else if (!Sm2ComputeZ (EcKey, Z)) {
+    return FALSE;
+  }
+
+  HashCtx = EVP_MD_CTX_new ();
+  if (HashCtx == NULL) {
+    return FALSE;
+  }
+  RetVal = (BOOLEAN) (EVP_DigestInit_ex (HashCtx, InternalCryptGetMd (CryptMdSm3), NULL) == 1 &&
+                      EVP_DigestUpdate (HashCtx, Z, sizeof(Z)) == 1 &&
+                      EVP_DigestUpdate (HashCtx, Message, Size) == 1 &&
+                      EVP_DigestFinal_ex (HashCtx, Digest, NULL) == 1);
+  EVP_MD_CTX_free (HashCtx);
+  return RetVal;
+}
+
 /**
   Allocates and Initializes one Shang-Mi2 Context for subsequent use.
 
@@ -83,6 +382,7 @@ Sm2New (
     EVP_PKEY_free (Pkey);
     return NULL;
   }
+  Sm2PrepareKey (Pkey);
 
   return (VOID *)Pkey;
 }
@@ -181,6 +481,7 @@ Sm2SetPubKey (
   if (!RetVal) {
     goto Done;
   }
+  Sm2PrepareKey (Pkey);
 
   RetVal = TRUE;
 
@@ -414,6 +715,7 @@ Sm2GenerateKey (
   if (!RetVal) {
     return FALSE;
   }
+  Sm2PrepareKey (Pkey);
   OpenSslNid = EC_GROUP_get_curve_name(EC_KEY_get0_group(EcKey));
   switch (OpenSslNid) {
   case NID_sm2:
@@ -755,9 +1057,9 @@ Sm2Sign (
 {
   EVP_PKEY_CTX  *Pctx;
   EVP_PKEY      *Pkey;
-  EVP_MD_CTX    *Ctx;
   UINTN         HalfSize;
   INT32         Result;
+  UINT8         Digest[SM3_256_DIGEST_SIZE];
   UINT8         DerSignature[32 * 2 + 8];
   UINTN         DerSigSize;
 
@@ -792,38 +1094,27 @@ Sm2Sign (
     return FALSE;
   }
 
-  Ctx = EVP_MD_CTX_new();
-  if (Ctx == NULL) {
+  //
+  // The digest H(Z || Message) is signed directly, so that the Z value cached by Sm2PrepareKey() is reused.
+  //
+  if (!Sm2ComputeMessageDigest (Pkey, Message, Size, Digest)) {
     return FALSE;
   }
   Pctx = EVP_PKEY_CTX_new(Pkey, NULL);
   if (Pctx == NULL) {
-    EVP_MD_CTX_free(Ctx);
-    return FALSE;
-  }
-  Result = EVP_PKEY_CTX_set1_id(Pctx, DEFAULT_SM2_ID, sizeof(DEFAULT_SM2_ID) - 1);
-  if (Result <= 0) {
-    EVP_MD_CTX_free(Ctx);
-    EVP_PKEY_CTX_free(Pctx);
     return FALSE;
   }
-  EVP_MD_CTX_set_pkey_ctx(Ctx, Pctx);
-
-  Result = EVP_DigestSignInit(Ctx, NULL, EVP_sm3(), NULL, Pkey);
+  Result = EVP_PKEY_sign_init(Pctx);
   if (Result != 1) {
-    EVP_MD_CTX_free(Ctx);
     EVP_PKEY_CTX_free(Pctx);
     return FALSE;
   }
   DerSigSize = sizeof(DerSignature);
-  Result = EVP_DigestSign(Ctx, DerSignature, &DerSigSize, Message, Size);
+  Result = EVP_PKEY_sign(Pctx, DerSignature, &DerSigSize, Digest, sizeof(Digest));
+  EVP_PKEY_CTX_free(Pctx);
   if (Result != 1) {
-    EVP_MD_CTX_free(Ctx);
-    EVP_PKEY_CTX_free(Pctx);
     return FALSE;
   }
-  EVP_MD_CTX_free(Ctx);
-  EVP_PKEY_CTX_free(Pctx);
 
   EccSignatureDerToBin (DerSignature, DerSigSize, Signature, *SigSize);
 
@@ -864,9 +1155,9 @@ Sm2Verify (
 {
   EVP_PKEY_CTX  *Pctx;
   EVP_PKEY      *Pkey;
-  EVP_MD_CTX    *Ctx;
   UINTN         HalfSize;
   INT32         Result;
+  UINT8         Digest[SM3_256_DIGEST_SIZE];
   UINT8         DerSignature[32 * 2 + 8];
   UINTN         DerSigSize;
 
@@ -901,37 +1192,25 @@ Sm2Verify (
   DerSigSize = sizeof(DerSignature);
   EccSignatureBinToDer ((UINT8 *)Signature, SigSize, DerSignature, &DerSigSize);
 
-  Ctx = EVP_MD_CTX_new();
-  if (Ctx == NULL) {
+  //
+  // The digest H(Z || Message) is verified directly, so that the Z value cached by Sm2PrepareKey() is reused.
+  //
+  if (!Sm2ComputeMessageDigest (Pkey, Message, Size, Digest)) {
     return FALSE;
   }
   Pctx = EVP_PKEY_CTX_new(Pkey, NULL);
   if (Pctx == NULL) {
-    EVP_MD_CTX_free(Ctx);
     return FALSE;
   }
-  Result = EVP_PKEY_CTX_set1_id(Pctx, DEFAULT_SM2_ID, sizeof(DEFAULT_SM2_ID) - 1);
-  if (Result <= 0) {
-    EVP_MD_CTX_free(Ctx);
-    EVP_PKEY_CTX_free(Pctx);
-    return FALSE;
-  }
-  EVP_MD_CTX_set_pkey_ctx(Ctx, Pctx);
-
-  Result = EVP_DigestVerifyInit(Ctx, NULL, EVP_sm3(), NULL, Pkey);
+  Result = EVP_PKEY_verify_init(Pctx);
   if (Result != 1) {
-    EVP_MD_CTX_free(Ctx);
     EVP_PKEY_CTX_free(Pctx);
     return FALSE;
   }
-  Result = EVP_DigestVerify(Ctx, DerSignature, (UINT32)DerSigSize, Message, Size);
+  Result = EVP_PKEY_verify(Pctx, DerSignature, DerSigSize, Digest, sizeof(Digest));
+  EVP_PKEY_CTX_free(Pctx);
   if (Result != 1) {
-    EVP_MD_CTX_free(Ctx);
-    EVP_PKEY_CTX_free(Pctx);
     return FALSE;
   }
-
-  EVP_MD_CTX_free(Ctx);
-  EVP_PKEY_CTX_free(Pctx);
   return TRUE;
 }
@@ -1604,6 +1604,63 @@ _Exit:
   return Status;
 }
 
+/**
+  Retrieve the RSA Public Key from one DER-encoded SubjectPublicKeyInfo.
+
+  @param[in]  DerData      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param[in]  DerSize      Size of the DER data in bytes.
+  @param[out] RsaContext   Pointer to new-generated RSA context which contain the retrieved
+                           RSA public key component. Use RsaFree() function to free the
+                           resource.
+
+  If DerData is NULL, then return FALSE.
+  If RsaContext is NULL, then return FALSE.
+
+  @retval  TRUE   RSA Public Key was retrieved successfully.
+  @retval  FALSE  Invalid DER data, or the key is not an RSA key.
+
+**/
+BOOLEAN
+EFIAPI
+RsaGetPublicKeyFromDer (
+  IN   CONST UINT8  *DerData,
+  IN   UINTN        DerSize,
+  OUT  VOID         **RsaContext
+  )
+{
+  BOOLEAN      Status;
+  EVP_PKEY     *Pkey;
+  CONST UINT8  *Temp;
+
+  //
+  // Check input parameters.
+  //
+  if (DerData == NULL || RsaContext == NULL || DerSize > INT_MAX) {
+    return FALSE;
+  }
+
+  //
+  // The whole buffer must be one SubjectPublicKeyInfo.
+  //
+  Temp = DerData;
+  Pkey = d2i_PUBKEY (NULL, &Temp, (long) DerSize);
+  if ((Pkey == NULL) || (Temp != DerData + DerSize) || (EVP_PKEY_id (Pkey) != EVP_PKEY_RSA)) {
+    EVP_PKEY_free (Pkey);
+    return FALSE;
+  }
+
+  //
+  // Duplicate RSA Context from the retrieved EVP_PKEY.
+  //
+  Status = FALSE;
+  if ((*RsaContext = RSAPublicKey_dup (EVP_PKEY_get0_RSA (Pkey))) != NULL) {
+    Status = TRUE;
+  }
+
+  EVP_PKEY_free (Pkey);
+  return Status;
+}
+
 /**
   Retrieve the EC Public Key from one DER-encoded X509 certificate.
 
@@ -1683,6 +1740,63 @@ _Exit:
   return Status;
 }
 
+/**
+  Retrieve the EC Public Key from one DER-encoded SubjectPublicKeyInfo.
+
+  @param[in]  DerData      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param[in]  DerSize      Size of the DER data in bytes.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which contain the retrieved
+                           EC public key component. Use EcFree() function to free the
+                           resource.
+
+  If DerData is NULL, then return FALSE.
+  If EcContext is NULL, then return FALSE.
+
+  @retval  TRUE   EC Public Key was retrieved successfully.
+  @retval  FALSE  Invalid DER data, or the key is not an EC key.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPublicKeyFromDer (
+  IN   CONST UINT8  *DerData,
+  IN   UINTN        DerSize,
+  OUT  VOID         **EcContext
+  )
+{
+  BOOLEAN      Status;
+  EVP_PKEY     *Pkey;
+  CONST UINT8  *Temp;
+
+  //
+  // Check input parameters.
+  //
+  if (DerData == NULL || EcContext == NULL || DerSize > INT_MAX) {
+    return FALSE;
+  }
+
+  //
+  // The whole buffer must be one SubjectPublicKeyInfo.
+  //
+  Temp = DerData;
+  Pkey = d2i_PUBKEY (NULL, &Temp, (long) DerSize);
+  if ((Pkey == NULL) || (Temp != DerData + DerSize) || (EVP_PKEY_id (Pkey) != EVP_PKEY_EC)) {
+    EVP_PKEY_free (Pkey);
+    return FALSE;
+  }
+
+  //
+  // Duplicate EC Context from the retrieved EVP_PKEY.
+  //
+  Status = FALSE;
+  if ((*EcContext = EC_KEY_dup (EVP_PKEY_get0_EC_KEY (Pkey))) != NULL) {
+    Status = TRUE;
+  }
+
+  EVP_PKEY_free (Pkey);
+  return Status;
+}
+
 /**
   Retrieve the Ed Public Key from one DER-encoded X509 certificate.
 
@@ -1827,6 +1941,7 @@ Sm2GetPublicKeyFromX509 (
   if (Result == 0) {
     goto _Exit;
   }
+  Sm2PrepareKey (Pkey);
 
   *Sm2Context = Pkey;
   Status = TRUE;
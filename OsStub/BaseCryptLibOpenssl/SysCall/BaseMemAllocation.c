@@ -0,0 +1,176 @@
+/** @file
+  Base Memory Allocation Routines Wrapper for Crypto library over OpenSSL.
+
+  The OpenSSL memory functions are redirected to the pool allocation functions,
+  so that the scratch arena also serves the allocations inside OpenSSL.
+
+Copyright (c) 2009 - 2017, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <openssl/crypto.h>
+
+//
+// Extra header to record the memory buffer size from malloc routine.
+//
+#define CRYPTMEM_HEAD_SIGNATURE    SIGNATURE_32('c','m','h','d')
+typedef struct {
+  UINT32    Signature;
+  UINT32    Reserved;
+  UINTN     Size;
+} CRYPTMEM_HEAD;
+
+#define CRYPTMEM_OVERHEAD      sizeof(CRYPTMEM_HEAD)
+
+BOOLEAN  mCryptMemFunctionsSet = FALSE;
+
+//
+// -- Memory-Allocation Routines --
+//
+
+/* Allocates memory blocks */
+STATIC
+void *
+CryptMalloc (
+  size_t      size,
+  const char  *file,
+  int         line
+  )
+{
+  CRYPTMEM_HEAD  *PoolHdr;
+  UINTN          NewSize;
+  VOID           *Data;
+
+  //
+  // Adjust the size by the buffer header overhead
+  //
+  NewSize = (UINTN)(size) + CRYPTMEM_OVERHEAD;
+
+  Data  = AllocatePool (NewSize);
+  if (Data != NULL) {
+    PoolHdr = (CRYPTMEM_HEAD *)Data;
+    //
+    // Record the memory brief information
+    //
+    PoolHdr->Signature = CRYPTMEM_HEAD_SIGNATURE;
+    PoolHdr->Size      = size;
+
+    return (VOID *)(PoolHdr + 1);
+  } else {
+    //
+    // The buffer allocation failed.
+    //
+    return NULL;
+  }
+}
+
+/* De-allocates or frees a memory block */
+STATIC
+void
+CryptFree (
+  void        *ptr,
+  const char  *file,
+  int         line
+  )
+{
+  CRYPTMEM_HEAD  *PoolHdr;
+
+  //
+  // In Standard C, free() handles a null pointer argument transparently. This
+  // is not true of FreePool() below, so protect it.
+  //
+  if (ptr != NULL) {
+    PoolHdr = (CRYPTMEM_HEAD *)ptr - 1;
+    ASSERT (PoolHdr->Signature == CRYPTMEM_HEAD_SIGNATURE);
+    FreePool (PoolHdr);
+  }
+}
+
+/* Reallocate memory blocks */
+STATIC
+void *
+CryptRealloc (
+  void        *ptr,
+  size_t      size,
+  const char  *file,
+  int         line
+  )
+{
+  CRYPTMEM_HEAD  *OldPoolHdr;
+  VOID           *Data;
+  UINTN          OldSize;
+
+  Data = CryptMalloc (size, file, line);
+  if (Data == NULL) {
+    return NULL;
+  }
+
+  if (ptr != NULL) {
+    OldPoolHdr = (CRYPTMEM_HEAD *)ptr - 1;
+    ASSERT (OldPoolHdr->Signature == CRYPTMEM_HEAD_SIGNATURE);
+    OldSize = OldPoolHdr->Size;
+
+    CopyMem (Data, ptr, MIN (OldSize, size));
+    CryptFree (ptr, file, line);
+  }
+
+  return Data;
+}
+
+//
+// -- Scratch Arena Routines --
+//
+
+/**
+  Sets a caller-provided scratch arena for the transient allocations of the crypto operations.
+
+  @param[in]  Arena       Pointer to the arena buffer, or NULL to allocate from the heap.
+  @param[in]  ArenaSize   Size of the arena buffer in bytes.
+  @param[in]  Strict      If TRUE, an allocation fails when the arena cannot serve it,
+                          instead of falling back to the heap.
+
+  @retval TRUE   The scratch arena is set.
+  @retval FALSE  The allocations of the crypto backend cannot be redirected,
+                 or a context allocated from the current arena is outstanding.
+
+**/
+BOOLEAN
+EFIAPI
+CryptSetScratchArena (
+  IN  VOID     *Arena  OPTIONAL,
+  IN  UINTN    ArenaSize,
+  IN  BOOLEAN  Strict
+  )
+{
+  //
+  // OpenSSL accepts the memory functions only before its first allocation.
+  //
+  if (!mCryptMemFunctionsSet) {
+    if (CRYPTO_set_mem_functions (CryptMalloc, CryptRealloc, CryptFree) == 0) {
+      return FALSE;
+    }
+    mCryptMemFunctionsSet = TRUE;
+    //
+    // Keep the global state of OpenSSL out of the arena.
+    //
+    OPENSSL_init_crypto (0, NULL);
+  }
+  return SetPoolArena (Arena, ArenaSize, Strict);
+}
+
+/**
+  Returns the peak size in bytes used in the scratch arena since it was set.
+
+  @return The peak size in bytes used in the scratch arena.
+
+**/
+UINTN
+EFIAPI
+CryptGetScratchArenaPeakSize (
+  VOID
+  )
+{
+  return GetPoolArenaPeakSize ();
+}
@@ -0,0 +1,333 @@
+/** @file
+  Algorithm and Context Cache for Crypto library over OpenSSL.
+
+  With OpenSSL 3.0, EVP_sha256(), EVP_aes_256_gcm() and similar return objects that
+  every EVP_*Init_ex() fetches again from the providers, under the store lock.
+  The algorithms are fetched here once and shared by all the threads.
+  The one-shot AEAD and HMAC wrappers also reuse one context per thread instead of
+  allocating a new one for every call.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <openssl/crypto.h>
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+
+STATIC CONST CHAR8  *mCryptMdName[CryptMdMax] = {
+  "SHA2-256",
+  "SHA2-384",
+  "SHA2-512",
+  "SHA3-256",
+  "SHA3-384",
+  "SHA3-512",
+  "SM3",
+};
+
+STATIC CONST CHAR8  *mCryptCipherName[CryptCipherMax] = {
+  "AES-128-GCM",
+  "AES-192-GCM",
+  "AES-256-GCM",
+  "AES-128-CCM",
+  "AES-192-CCM",
+  "AES-256-CCM",
+  "AES-128-CBC",
+  "AES-192-CBC",
+  "AES-256-CBC",
+  "ChaCha20-Poly1305",
+};
+
+//
+// The fetched algorithms are read-only after CRYPTO_THREAD_run_once(), so they are shared without a lock.
+// An algorithm that the providers do not have stays NULL.
+//
+STATIC EVP_MD      *mCryptMd[CryptMdMax];
+STATIC EVP_CIPHER  *mCryptCipher[CryptCipherMax];
+
+#endif
+
+STATIC CRYPTO_ONCE          mCryptCacheOnce = CRYPTO_ONCE_STATIC_INIT;
+STATIC BOOLEAN              mCryptCacheReady = FALSE;
+STATIC CRYPTO_THREAD_LOCAL  mCryptCipherCtxKey;
+STATIC CRYPTO_THREAD_LOCAL  mCryptHmacCtxKey;
+
+/**
+  Free the cipher context cached by a thread when the thread exits.
+**/
+STATIC
+VOID
+InternalCryptFreeCipherCtx (
+  VOID  *Ctx
+  )
+{
+  EVP_CIPHER_CTX_free ((EVP_CIPHER_CTX *)Ctx);
+}
+
+/**
+  Free the HMAC context cached by a thread when the thread exits.
+**/
+STATIC
+VOID
+InternalCryptFreeHmacCtx (
+  VOID  *Ctx
+  )
+{
+  HMAC_CTX_free ((HMAC_CTX *)Ctx);
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+
+/**
+  Free the fetched algorithms in OPENSSL_cleanup(), before the providers are unloaded.
+**/
+STATIC
+VOID
+InternalCryptCacheFree (
+  VOID
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < CryptMdMax; Index++) {
+    EVP_MD_free (mCryptMd[Index]);
+    mCryptMd[Index] = NULL;
+  }
+  for (Index = 0; Index < CryptCipherMax; Index++) {
+    EVP_CIPHER_free (mCryptCipher[Index]);
+    mCryptCipher[Index] = NULL;
+  }
+}
+
+#endif
+
+STATIC
+VOID
+InternalCryptCacheInit (
+  VOID
+  )
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  UINTN  Index;
+
+  for (Index = 0; Index < CryptMdMax; Index++) {
+    mCryptMd[Index] = EVP_MD_fetch (NULL, mCryptMdName[Index], NULL);
+  }
+  for (Index = 0; Index < CryptCipherMax; Index++) {
+    mCryptCipher[Index] = EVP_CIPHER_fetch (NULL, mCryptCipherName[Index], NULL);
+  }
+  OPENSSL_atexit (InternalCryptCacheFree);
+#endif
+
+  if (!CRYPTO_THREAD_init_local (&mCryptCipherCtxKey, InternalCryptFreeCipherCtx)) {
+    return;
+  }
+  if (!CRYPTO_THREAD_init_local (&mCryptHmacCtxKey, InternalCryptFreeHmacCtx)) {
+    return;
+  }
+  mCryptCacheReady = TRUE;
+}
+
+/**
+  Get a message digest of the OpenSSL wrappers.
+
+  With OpenSSL 3.0 or later, the message digest is fetched from the default library context
+  the first time, and the same EVP_MD is returned afterwards, so that an EVP_DigestInit_ex()
+  or HMAC_Init_ex() with it does not fetch it again under the provider store lock.
+  With an earlier OpenSSL, it is the static EVP_MD of EVP_sha256() and similar.
+
+  @param[in]  Index  The message digest.
+
+  @return  The message digest, or NULL if it is not available.
+**/
+CONST EVP_MD *
+InternalCryptGetMd (
+  IN  CRYPT_MD_INDEX  Index
+  )
+{
+  if (Index >= CryptMdMax) {
+    return NULL;
+  }
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  if (!CRYPTO_THREAD_run_once (&mCryptCacheOnce, InternalCryptCacheInit)) {
+    return NULL;
+  }
+  return mCryptMd[Index];
+#else
+  switch (Index) {
+  case CryptMdSha256:
+    return EVP_sha256 ();
+  case CryptMdSha384:
+    return EVP_sha384 ();
+  case CryptMdSha512:
+    return EVP_sha512 ();
+  case CryptMdSha3_256:
+    return EVP_sha3_256 ();
+  case CryptMdSha3_384:
+    return EVP_sha3_384 ();
+  case CryptMdSha3_512:
+    return EVP_sha3_512 ();
+  case CryptMdSm3:
+    return EVP_sm3 ();
+  default:
+    return NULL;
+  }
+#endif
+}
+
+/**
+  Get a cipher of the OpenSSL wrappers.
+
+  With OpenSSL 3.0 or later, the cipher is fetched from the default library context the first
+  time, and the same EVP_CIPHER is returned afterwards.
+  With an earlier OpenSSL, it is the static EVP_CIPHER of EVP_aes_256_gcm() and similar.
+
+  @param[in]  Index  The cipher.
+
+  @return  The cipher, or NULL if it is not available.
+**/
+CONST EVP_CIPHER *
+InternalCryptGetCipher (
+  IN  CRYPT_CIPHER_INDEX  Index
+  )
+{
+  if (Index >= CryptCipherMax) {
+    return NULL;
+  }
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  if (!CRYPTO_THREAD_run_once (&mCryptCacheOnce, InternalCryptCacheInit)) {
+    return NULL;
+  }
+  return mCryptCipher[Index];
+#else
+  switch (Index) {
+  case CryptCipherAes128Gcm:
+    return EVP_aes_128_gcm ();
+  case CryptCipherAes192Gcm:
+    return EVP_aes_192_gcm ();
+  case CryptCipherAes256Gcm:
+    return EVP_aes_256_gcm ();
+  case CryptCipherAes128Ccm:
+    return EVP_aes_128_ccm ();
+  case CryptCipherAes192Ccm:
+    return EVP_aes_192_ccm ();
+  case CryptCipherAes256Ccm:
+    return EVP_aes_256_ccm ();
+  case CryptCipherAes128Cbc:
+    return EVP_aes_128_cbc ();
+  case CryptCipherAes192Cbc:
+    return EVP_aes_192_cbc ();
+  case CryptCipherAes256Cbc:
+    return EVP_aes_256_cbc ();
+  case CryptCipherChaCha20Poly1305:
+    return EVP_chacha20_poly1305 ();
+  default:
+    return NULL;
+  }
+#endif
+}
+
+/**
+  Acquire an EVP_CIPHER_CTX for a one-shot cipher operation.
+
+  The context cached for the calling thread is returned if it is not already acquired,
+  otherwise a new context is allocated.
+
+  @return  The cipher context, or NULL if it cannot be allocated.
+**/
+EVP_CIPHER_CTX *
+InternalCryptAcquireCipherCtx (
+  VOID
+  )
+{
+  EVP_CIPHER_CTX  *Ctx;
+
+  //
+  // The cached context is taken out of the thread slot, so that a nested acquire gets a new one.
+  //
+  if (CRYPTO_THREAD_run_once (&mCryptCacheOnce, InternalCryptCacheInit) && mCryptCacheReady) {
+    Ctx = CRYPTO_THREAD_get_local (&mCryptCipherCtxKey);
+    if ((Ctx != NULL) && CRYPTO_THREAD_set_local (&mCryptCipherCtxKey, NULL)) {
+      return Ctx;
+    }
+  }
+  return EVP_CIPHER_CTX_new ();
+}
+
+/**
+  Release an EVP_CIPHER_CTX acquired by InternalCryptAcquireCipherCtx().
+
+  The context is reset, which cleanses the key, and cached for the calling thread
+  if the thread has no cached context, otherwise it is freed.
+
+  @param[in]  Ctx  The cipher context. It may be NULL.
+**/
+VOID
+InternalCryptReleaseCipherCtx (
+  IN  EVP_CIPHER_CTX  *Ctx
+  )
+{
+  if (Ctx == NULL) {
+    return;
+  }
+  if (mCryptCacheReady &&
+      (EVP_CIPHER_CTX_reset (Ctx) == 1) &&
+      (CRYPTO_THREAD_get_local (&mCryptCipherCtxKey) == NULL) &&
+      CRYPTO_THREAD_set_local (&mCryptCipherCtxKey, Ctx)) {
+    return;
+  }
+  EVP_CIPHER_CTX_free (Ctx);
+}
+
+/**
+  Acquire an HMAC_CTX for a one-shot HMAC operation.
+
+  The context cached for the calling thread is returned if it is not already acquired,
+  otherwise a new context is allocated.
+
+  @return  The HMAC context, or NULL if it cannot be allocated.
+**/
+HMAC_CTX *
+InternalCryptAcquireHmacCtx (
+  VOID
+  )
+{
+  HMAC_CTX  *Ctx;
+
+  if (CRYPTO_THREAD_run_once (&mCryptCacheOnce, InternalCryptCacheInit) && mCryptCacheReady) {
+    Ctx = CRYPTO_THREAD_get_local (&mCryptHmacCtxKey);
+    if ((Ctx != NULL) && CRYPTO_THREAD_set_local (&mCryptHmacCtxKey, NULL)) {
+      return Ctx;
+    }
+  }
+  return HMAC_CTX_new ();
+}
+
+/**
+  Release an HMAC_CTX acquired by InternalCryptAcquireHmacCtx().
+
+  The context is reset, which cleanses the key, and cached for the calling thread
+  if the thread has no cached context, otherwise it is freed.
+
+  @param[in]  Ctx  The HMAC context. It may be NULL.
+**/
+VOID
+InternalCryptReleaseHmacCtx (
+  IN  HMAC_CTX  *Ctx
+  )
+{
+  if (Ctx == NULL) {
+    return;
+  }
+  if (mCryptCacheReady &&
+      (HMAC_CTX_reset (Ctx) == 1) &&
+      (CRYPTO_THREAD_get_local (&mCryptHmacCtxKey) == NULL) &&
+      CRYPTO_THREAD_set_local (&mCryptHmacCtxKey, Ctx)) {
+    return;
+  }
+  HMAC_CTX_free (Ctx);
+}
@@ -0,0 +1,298 @@
+/** @file
+  AEAD Wrapper Implementation over the multipart PSA Crypto AEAD operation.
+
+  The AES-GCM, AES-CCM and ChaCha20Poly1305 wrappers share these functions.
+
+  RFC 5116 - An Interface and Algorithms for Authenticated Encryption
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+
+/**
+  Zero the first Size bytes spread over a list of data segments.
+
+  @param[in]  Segments      Pointer to the list of data segments.
+  @param[in]  SegmentCount  Number of entries in Segments.
+  @param[in]  Size          Number of bytes to be zeroed.
+
+**/
+STATIC
+VOID
+ZeroSegments (
+  IN CONST CRYPT_DATA_SEGMENT  *Segments,
+  IN UINTN                     SegmentCount,
+  IN UINTN                     Size
+  )
+{
+  UINTN  Index;
+  UINTN  Length;
+
+  for (Index = 0; (Index < SegmentCount) && (Size != 0); Index++) {
+    Length = MIN (Segments[Index].Size, Size);
+    ZeroMem (Segments[Index].Buffer, Length);
+    Size -= Length;
+  }
+}
+
+/**
+  Import the key of an AEAD context, and destroy the key it held before.
+
+  The key may be used with any tag size from MinTagSize of the AEAD context.
+
+  @param[in, out]  AeadContext  Pointer to the AEAD context.
+  @param[in]       Key          Pointer to the user-supplied key.
+  @param[in]       KeySize      Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+InternalAeadPsaSetKey (
+  IN OUT  PSA_AEAD_CONTEXT  *AeadContext,
+  IN      CONST UINT8       *Key,
+  IN      UINTN             KeySize
+  )
+{
+  psa_key_attributes_t  Attributes;
+  psa_status_t          Status;
+
+  InternalAeadPsaDestroyKey (AeadContext);
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  Attributes = psa_key_attributes_init ();
+  psa_set_key_type (&Attributes, AeadContext->KeyType);
+  psa_set_key_bits (&Attributes, KeySize * 8);
+  psa_set_key_usage_flags (&Attributes, PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT);
+#if defined(PSA_ALG_AEAD_WITH_AT_LEAST_THIS_LENGTH_TAG)
+  psa_set_key_algorithm (&Attributes, PSA_ALG_AEAD_WITH_AT_LEAST_THIS_LENGTH_TAG (AeadContext->Alg, AeadContext->MinTagSize));
+#else
+  //
+  // Before PSA Crypto 1.0.1, a key policy permits one tag size, which is the default one here.
+  //
+  psa_set_key_algorithm (&Attributes, AeadContext->Alg);
+#endif
+
+  Status = psa_import_key (&Attributes, Key, KeySize, &AeadContext->KeyId);
+  psa_reset_key_attributes (&Attributes);
+  if (Status != PSA_SUCCESS) {
+    AeadContext->KeyId = PSA_KEY_ID_NULL;
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Destroy the key of an AEAD context.
+
+  @param[in, out]  AeadContext  Pointer to the AEAD context.
+
+**/
+VOID
+InternalAeadPsaDestroyKey (
+  IN OUT  PSA_AEAD_CONTEXT  *AeadContext
+  )
+{
+  if (AeadContext->KeyId != PSA_KEY_ID_NULL) {
+    psa_destroy_key (AeadContext->KeyId);
+    AeadContext->KeyId = PSA_KEY_ID_NULL;
+  }
+}
+
+/**
+  Performs AEAD authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with the multipart PSA AEAD operation.
+
+  The segments are encrypted in order, as if they were one contiguous buffer, into DataOut.
+  With no segment, only the authentication tag of the AAD is generated.
+
+  @param[in]   AeadContext  Pointer to the keyed AEAD context.
+  @param[in]   Iv           Pointer to the IV value.
+  @param[in]   IvSize       Size of the IV value in bytes.
+  @param[in]   AData        Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize    Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn       Pointer to the list of input data segments to be encrypted.
+  @param[in]   DataInCount  Number of entries in DataIn.
+  @param[out]  TagOut       Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize      Size of the authentication tag in bytes.
+  @param[out]  DataOut      Pointer to a buffer that receives the encryption output.
+  @param[in]   DataOutSize  Size of the output data buffer in bytes, the total size of the segments.
+
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
+
+**/
+BOOLEAN
+InternalAeadPsaSeal (
+  IN   PSA_AEAD_CONTEXT            *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataIn,
+  IN   UINTN                       DataInCount,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize,
+  OUT  UINT8                       *DataOut,
+  IN   UINTN                       DataOutSize
+  )
+{
+  psa_aead_operation_t  Operation;
+  psa_status_t          Status;
+  UINTN                 Index;
+  UINTN                 Offset;
+  size_t                OutputLength;
+  size_t                TagLength;
+
+  if (AeadContext->KeyId == PSA_KEY_ID_NULL) {
+    return FALSE;
+  }
+
+  //
+  // The lengths are set first, as AES-CCM requires them before the data.
+  //
+  Operation = psa_aead_operation_init ();
+  Status = psa_aead_encrypt_setup (&Operation, AeadContext->KeyId,
+                                   PSA_ALG_AEAD_WITH_SHORTENED_TAG (AeadContext->Alg, TagSize));
+  if (Status == PSA_SUCCESS) {
+    Status = psa_aead_set_lengths (&Operation, ADataSize, DataOutSize);
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_aead_set_nonce (&Operation, Iv, IvSize);
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_aead_update_ad (&Operation, AData, ADataSize);
+  }
+
+  Offset = 0;
+  for (Index = 0; (Status == PSA_SUCCESS) && (Index < DataInCount); Index++) {
+    Status = psa_aead_update (&Operation, DataIn[Index].Buffer, DataIn[Index].Size,
+                              DataOut + Offset, DataOutSize - Offset, &OutputLength);
+    if (Status == PSA_SUCCESS) {
+      Offset += OutputLength;
+    }
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_aead_finish (&Operation, DataOut + Offset, DataOutSize - Offset, &OutputLength,
+                              TagOut, TagSize, &TagLength);
+  }
+  if ((Status == PSA_SUCCESS) && ((Offset + OutputLength != DataOutSize) || (TagLength != TagSize))) {
+    Status = PSA_ERROR_GENERIC_ERROR;
+  }
+
+  if (Status != PSA_SUCCESS) {
+    psa_aead_abort (&Operation);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD)
+  into a list of data segments, with the multipart PSA AEAD operation.
+
+  The plain text is written in order across the segments, which must hold at least DataInSize bytes.
+  If the authentication fails, the plain text written to the segments is zeroed.
+  With no data, only the authentication tag of the AAD is verified.
+
+  @param[in]   AeadContext   Pointer to the keyed AEAD context.
+  @param[in]   Iv            Pointer to the IV value.
+  @param[in]   IvSize        Size of the IV value in bytes.
+  @param[in]   AData         Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize     Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn        Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize    Size of the input data buffer in bytes.
+  @param[in]   Tag           Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize       Size of the authentication tag in bytes.
+  @param[in]   DataOut       Pointer to the list of segments that receive the decryption output.
+  @param[in]   DataOutCount  Number of entries in DataOut.
+
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
+
+**/
+BOOLEAN
+InternalAeadPsaOpen (
+  IN   PSA_AEAD_CONTEXT            *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *DataIn,
+  IN   UINTN                       DataInSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataOut,
+  IN   UINTN                       DataOutCount
+  )
+{
+  psa_aead_operation_t  Operation;
+  psa_status_t          Status;
+  UINTN                 Index;
+  UINTN                 Capacity;
+  UINTN                 Offset;
+  UINTN                 Used;
+  UINTN                 Length;
+  size_t                OutputLength;
+
+  if (AeadContext->KeyId == PSA_KEY_ID_NULL || (DataOut == NULL && DataOutCount != 0)) {
+    return FALSE;
+  }
+  Capacity = 0;
+  for (Index = 0; (Index < DataOutCount) && (Capacity < DataInSize); Index++) {
+    Capacity += MIN (DataOut[Index].Size, DataInSize - Capacity);
+  }
+  if (Capacity < DataInSize) {
+    return FALSE;
+  }
+
+  Operation = psa_aead_operation_init ();
+  Status = psa_aead_decrypt_setup (&Operation, AeadContext->KeyId,
+                                   PSA_ALG_AEAD_WITH_SHORTENED_TAG (AeadContext->Alg, TagSize));
+  if (Status == PSA_SUCCESS) {
+    Status = psa_aead_set_lengths (&Operation, ADataSize, DataInSize);
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_aead_set_nonce (&Operation, Iv, IvSize);
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_aead_update_ad (&Operation, AData, ADataSize);
+  }
+
+  //
+  // Each segment receives as many bytes as it is given, as the AEAD of PSA Crypto are streaming.
+  //
+  Index = 0;
+  Used = 0;
+  Offset = 0;
+  while ((Status == PSA_SUCCESS) && (Offset < DataInSize)) {
+    while (Used == DataOut[Index].Size) {
+      Index++;
+      Used = 0;
+    }
+    Length = MIN (DataOut[Index].Size - Used, DataInSize - Offset);
+    Status = psa_aead_update (&Operation, DataIn + Offset, Length,
+                              (UINT8 *)DataOut[Index].Buffer + Used, Length, &OutputLength);
+    if ((Status == PSA_SUCCESS) && (OutputLength != Length)) {
+      Status = PSA_ERROR_GENERIC_ERROR;
+    }
+    Used += Length;
+    Offset += Length;
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_aead_verify (&Operation, NULL, 0, &OutputLength, Tag, TagSize);
+  }
+
+  if (Status != PSA_SUCCESS) {
+    psa_aead_abort (&Operation);
+    ZeroSegments (DataOut, DataOutCount, DataInSize);
+    return FALSE;
+  }
+  return TRUE;
+}
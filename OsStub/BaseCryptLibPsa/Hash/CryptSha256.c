@@ -0,0 +1,281 @@
+/** @file
+  SHA-256 Digest Wrapper Implementation over PSA Crypto.
+
+Copyright (c) 2009 - 2016, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+
+/**
+  Allocates one SHA-256 context for subsequent use.
+  The context must be initialized by Sha256Init() before it is used.
+
+  @return  Pointer to the SHA-256 context that has been allocated.
+           If the allocations fails, Sha256New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha256New (
+  VOID
+  )
+{
+  return AllocateZeroPool (sizeof (psa_hash_operation_t));
+}
+
+/**
+  Release the specified SHA-256 context.
+
+  @param[in]  Sha256Context  Pointer to the SHA-256 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha256Free (
+  IN  VOID  *Sha256Context
+  )
+{
+  if (Sha256Context == NULL) {
+    return;
+  }
+  psa_hash_abort (Sha256Context);
+  FreePool (Sha256Context);
+}
+
+/**
+  Retrieves the size, in bytes, of the context buffer required for SHA-256 hash operations.
+
+  @return  The size, in bytes, of the context buffer required for SHA-256 hash operations.
+
+**/
+UINTN
+EFIAPI
+Sha256GetContextSize (
+  VOID
+  )
+{
+  return (UINTN) (sizeof (psa_hash_operation_t));
+}
+
+/**
+  Initializes user-supplied memory pointed by Sha256Context as SHA-256 hash context for
+  subsequent use.
+
+  If Sha256Context is NULL, then return FALSE.
+
+  @param[out]  Sha256Context  Pointer to SHA-256 context being initialized.
+
+  @retval TRUE   SHA-256 context initialization succeeded.
+  @retval FALSE  SHA-256 context initialization failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256Init (
+  OUT  VOID  *Sha256Context
+  )
+{
+  psa_hash_operation_t  *Operation;
+
+  if (Sha256Context == NULL) {
+    return FALSE;
+  }
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  Operation = Sha256Context;
+  *Operation = psa_hash_operation_init ();
+  return (BOOLEAN)(psa_hash_setup (Operation, PSA_ALG_SHA_256) == PSA_SUCCESS);
+}
+
+/**
+  Makes a copy of an existing SHA-256 context.
+
+  If Sha256Context is NULL, then return FALSE.
+  If NewSha256Context is NULL, then return FALSE.
+
+  @param[in]  Sha256Context     Pointer to SHA-256 context being copied.
+  @param[out] NewSha256Context  Pointer to new SHA-256 context.
+
+  @retval TRUE   SHA-256 context copy succeeded.
+  @retval FALSE  SHA-256 context copy failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256Duplicate (
+  IN   CONST VOID  *Sha256Context,
+  OUT  VOID        *NewSha256Context
+  )
+{
+  psa_hash_operation_t  *NewOperation;
+
+  if (Sha256Context == NULL || NewSha256Context == NULL) {
+    return FALSE;
+  }
+
+  NewOperation = NewSha256Context;
+  *NewOperation = psa_hash_operation_init ();
+  return (BOOLEAN)(psa_hash_clone (Sha256Context, NewOperation) == PSA_SUCCESS);
+}
+
+/**
+  Digests the input data and updates SHA-256 context.
+
+  This function performs SHA-256 digest on a data buffer of the specified size.
+  It can be called multiple times to compute the digest of long or discontinuous data streams.
+  SHA-256 context should be already correctly initialized by Sha256Init(), and should not be finalized
+  by Sha256Final(). Behavior with invalid context is undefined.
+
+  If Sha256Context is NULL, then return FALSE.
+
+  @param[in, out]  Sha256Context  Pointer to the SHA-256 context.
+  @param[in]       Data           Pointer to the buffer containing the data to be hashed.
+  @param[in]       DataSize       Size of Data buffer in bytes.
+
+  @retval TRUE   SHA-256 data digest succeeded.
+  @retval FALSE  SHA-256 data digest failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256Update (
+  IN OUT  VOID        *Sha256Context,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  if (Sha256Context == NULL) {
+    return FALSE;
+  }
+
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(psa_hash_update (Sha256Context, Data, DataSize) == PSA_SUCCESS);
+}
+
+/**
+  Completes computation of the SHA-256 digest value.
+
+  This function completes SHA-256 hash computation and retrieves the digest value into
+  the specified memory. After this function has been called, the SHA-256 context cannot
+  be used again.
+  SHA-256 context should be already correctly initialized by Sha256Init(), and should not be
+  finalized by Sha256Final(). Behavior with invalid SHA-256 context is undefined.
+
+  If Sha256Context is NULL, then return FALSE.
+  If HashValue is NULL, then return FALSE.
+
+  @param[in, out]  Sha256Context  Pointer to the SHA-256 context.
+  @param[out]      HashValue      Pointer to a buffer that receives the SHA-256 digest
+                                  value (32 bytes).
+
+  @retval TRUE   SHA-256 digest computation succeeded.
+  @retval FALSE  SHA-256 digest computation failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256Final (
+  IN OUT  VOID   *Sha256Context,
+  OUT     UINT8  *HashValue
+  )
+{
+  size_t  HashLength;
+
+  if (Sha256Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+
+  if (psa_hash_finish (Sha256Context, HashValue, SHA256_DIGEST_SIZE, &HashLength) != PSA_SUCCESS) {
+    psa_hash_abort (Sha256Context);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Computes the SHA-256 message digest of a input data buffer.
+
+  This function performs the SHA-256 message digest of a given data buffer, and places
+  the digest value into the specified memory.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Data        Pointer to the buffer containing the data to be hashed.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[out]  HashValue   Pointer to a buffer that receives the SHA-256 digest
+                           value (32 bytes).
+
+  @retval TRUE   SHA-256 digest computation succeeded.
+  @retval FALSE  SHA-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashAll (
+  IN   CONST VOID  *Data,
+  IN   UINTN       DataSize,
+  OUT  UINT8       *HashValue
+  )
+{
+  size_t  HashLength;
+
+  if (HashValue == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(psa_hash_compute (PSA_ALG_SHA_256, Data, DataSize, HashValue, SHA256_DIGEST_SIZE, &HashLength) == PSA_SUCCESS);
+}
+
+/**
+  Computes the SHA-256 message digests of several independent data buffers.
+
+  The result is the same as calling Sha256HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA-256 digest values (32 bytes each).
+
+  @retval TRUE   SHA-256 digest computation succeeded.
+  @retval FALSE  SHA-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha256HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
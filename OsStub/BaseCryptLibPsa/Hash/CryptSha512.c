@@ -0,0 +1,517 @@
+/** @file
+  SHA-384 and SHA-512 Digest Wrapper Implementations over PSA Crypto.
+
+Copyright (c) 2014 - 2016, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+
+/**
+  Allocates one SHA-384 context for subsequent use.
+  The context must be initialized by Sha384Init() before it is used.
+
+  @return  Pointer to the SHA-384 context that has been allocated.
+           If the allocations fails, Sha384New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha384New (
+  VOID
+  )
+{
+  return AllocateZeroPool (sizeof (psa_hash_operation_t));
+}
+
+/**
+  Release the specified SHA-384 context.
+
+  @param[in]  Sha384Context  Pointer to the SHA-384 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha384Free (
+  IN  VOID  *Sha384Context
+  )
+{
+  if (Sha384Context == NULL) {
+    return;
+  }
+  psa_hash_abort (Sha384Context);
+  FreePool (Sha384Context);
+}
+
+/**
+  Retrieves the size, in bytes, of the context buffer required for SHA-384 hash operations.
+
+  @return  The size, in bytes, of the context buffer required for SHA-384 hash operations.
+
+**/
+UINTN
+EFIAPI
+Sha384GetContextSize (
+  VOID
+  )
+{
+  return (UINTN) (sizeof (psa_hash_operation_t));
+}
+
+/**
+  Initializes user-supplied memory pointed by Sha384Context as SHA-384 hash context for
+  subsequent use.
+
+  If Sha384Context is NULL, then return FALSE.
+
+  @param[out]  Sha384Context  Pointer to SHA-384 context being initialized.
+
+  @retval TRUE   SHA-384 context initialization succeeded.
+  @retval FALSE  SHA-384 context initialization failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384Init (
+  OUT  VOID  *Sha384Context
+  )
+{
+  psa_hash_operation_t  *Operation;
+
+  if (Sha384Context == NULL) {
+    return FALSE;
+  }
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  Operation = Sha384Context;
+  *Operation = psa_hash_operation_init ();
+  return (BOOLEAN)(psa_hash_setup (Operation, PSA_ALG_SHA_384) == PSA_SUCCESS);
+}
+
+/**
+  Makes a copy of an existing SHA-384 context.
+
+  If Sha384Context is NULL, then return FALSE.
+  If NewSha384Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in]  Sha384Context     Pointer to SHA-384 context being copied.
+  @param[out] NewSha384Context  Pointer to new SHA-384 context.
+
+  @retval TRUE   SHA-384 context copy succeeded.
+  @retval FALSE  SHA-384 context copy failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384Duplicate (
+  IN   CONST VOID  *Sha384Context,
+  OUT  VOID        *NewSha384Context
+  )
+{
+  psa_hash_operation_t  *NewOperation;
+
+  if (Sha384Context == NULL || NewSha384Context == NULL) {
+    return FALSE;
+  }
+
+  NewOperation = NewSha384Context;
+  *NewOperation = psa_hash_operation_init ();
+  return (BOOLEAN)(psa_hash_clone (Sha384Context, NewOperation) == PSA_SUCCESS);
+}
+
+/**
+  Digests the input data and updates SHA-384 context.
+
+  This function performs SHA-384 digest on a data buffer of the specified size.
+  It can be called multiple times to compute the digest of long or discontinuous data streams.
+  SHA-384 context should be already correctly initialized by Sha384Init(), and should not be finalized
+  by Sha384Final(). Behavior with invalid context is undefined.
+
+  If Sha384Context is NULL, then return FALSE.
+
+  @param[in, out]  Sha384Context  Pointer to the SHA-384 context.
+  @param[in]       Data           Pointer to the buffer containing the data to be hashed.
+  @param[in]       DataSize       Size of Data buffer in bytes.
+
+  @retval TRUE   SHA-384 data digest succeeded.
+  @retval FALSE  SHA-384 data digest failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384Update (
+  IN OUT  VOID        *Sha384Context,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  if (Sha384Context == NULL) {
+    return FALSE;
+  }
+
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(psa_hash_update (Sha384Context, Data, DataSize) == PSA_SUCCESS);
+}
+
+/**
+  Completes computation of the SHA-384 digest value.
+
+  This function completes SHA-384 hash computation and retrieves the digest value into
+  the specified memory. After this function has been called, the SHA-384 context cannot
+  be used again.
+  SHA-384 context should be already correctly initialized by Sha384Init(), and should not be
+  finalized by Sha384Final(). Behavior with invalid SHA-384 context is undefined.
+
+  If Sha384Context is NULL, then return FALSE.
+  If HashValue is NULL, then return FALSE.
+
+  @param[in, out]  Sha384Context  Pointer to the SHA-384 context.
+  @param[out]      HashValue      Pointer to a buffer that receives the SHA-384 digest
+                                  value (48 bytes).
+
+  @retval TRUE   SHA-384 digest computation succeeded.
+  @retval FALSE  SHA-384 digest computation failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384Final (
+  IN OUT  VOID   *Sha384Context,
+  OUT     UINT8  *HashValue
+  )
+{
+  size_t  HashLength;
+
+  if (Sha384Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+
+  if (psa_hash_finish (Sha384Context, HashValue, SHA384_DIGEST_SIZE, &HashLength) != PSA_SUCCESS) {
+    psa_hash_abort (Sha384Context);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Computes the SHA-384 message digest of a input data buffer.
+
+  This function performs the SHA-384 message digest of a given data buffer, and places
+  the digest value into the specified memory.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Data        Pointer to the buffer containing the data to be hashed.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[out]  HashValue   Pointer to a buffer that receives the SHA-384 digest
+                           value (48 bytes).
+
+  @retval TRUE   SHA-384 digest computation succeeded.
+  @retval FALSE  SHA-384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384HashAll (
+  IN   CONST VOID  *Data,
+  IN   UINTN       DataSize,
+  OUT  UINT8       *HashValue
+  )
+{
+  size_t  HashLength;
+
+  if (HashValue == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(psa_hash_compute (PSA_ALG_SHA_384, Data, DataSize, HashValue, SHA384_DIGEST_SIZE, &HashLength) == PSA_SUCCESS);
+}
+
+/**
+  Computes the SHA-384 message digests of several independent data buffers.
+
+  The result is the same as calling Sha384HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA-384 digest values (48 bytes each).
+
+  @retval TRUE   SHA-384 digest computation succeeded.
+  @retval FALSE  SHA-384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha384HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Allocates one SHA-512 context for subsequent use.
+  The context must be initialized by Sha512Init() before it is used.
+
+  @return  Pointer to the SHA-512 context that has been allocated.
+           If the allocations fails, Sha512New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha512New (
+  VOID
+  )
+{
+  return AllocateZeroPool (sizeof (psa_hash_operation_t));
+}
+
+/**
+  Release the specified SHA-512 context.
+
+  @param[in]  Sha512Context  Pointer to the SHA-512 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha512Free (
+  IN  VOID  *Sha512Context
+  )
+{
+  if (Sha512Context == NULL) {
+    return;
+  }
+  psa_hash_abort (Sha512Context);
+  FreePool (Sha512Context);
+}
+
+/**
+  Retrieves the size, in bytes, of the context buffer required for SHA-512 hash operations.
+
+  @return  The size, in bytes, of the context buffer required for SHA-512 hash operations.
+
+**/
+UINTN
+EFIAPI
+Sha512GetContextSize (
+  VOID
+  )
+{
+  return (UINTN) (sizeof (psa_hash_operation_t));
+}
+
+/**
+  Initializes user-supplied memory pointed by Sha512Context as SHA-512 hash context for
+  subsequent use.
+
+  If Sha512Context is NULL, then return FALSE.
+
+  @param[out]  Sha512Context  Pointer to SHA-512 context being initialized.
+
+  @retval TRUE   SHA-512 context initialization succeeded.
+  @retval FALSE  SHA-512 context initialization failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha512Init (
+  OUT  VOID  *Sha512Context
+  )
+{
+  psa_hash_operation_t  *Operation;
+
+  if (Sha512Context == NULL) {
+    return FALSE;
+  }
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  Operation = Sha512Context;
+  *Operation = psa_hash_operation_init ();
+  return (BOOLEAN)(psa_hash_setup (Operation, PSA_ALG_SHA_512) == PSA_SUCCESS);
+}
+
+/**
+  Makes a copy of an existing SHA-512 context.
+
+  If Sha512Context is NULL, then return FALSE.
+  If NewSha512Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in]  Sha512Context     Pointer to SHA-512 context being copied.
+  @param[out] NewSha512Context  Pointer to new SHA-512 context.
+
+  @retval TRUE   SHA-512 context copy succeeded.
+  @retval FALSE  SHA-512 context copy failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha512Duplicate (
+  IN   CONST VOID  *Sha512Context,
+  OUT  VOID        *NewSha512Context
+  )
+{
+  psa_hash_operation_t  *NewOperation;
+
+  if (Sha512Context == NULL || NewSha512Context == NULL) {
+    return FALSE;
+  }
+
+  NewOperation = NewSha512Context;
+  *NewOperation = psa_hash_operation_init ();
+  return (BOOLEAN)(psa_hash_clone (Sha512Context, NewOperation) == PSA_SUCCESS);
+}
+
+/**
+  Digests the input data and updates SHA-512 context.
+
+  This function performs SHA-512 digest on a data buffer of the specified size.
+  It can be called multiple times to compute the digest of long or discontinuous data streams.
+  SHA-512 context should be already correctly initialized by Sha512Init(), and should not be finalized
+  by Sha512Final(). Behavior with invalid context is undefined.
+
+  If Sha512Context is NULL, then return FALSE.
+
+  @param[in, out]  Sha512Context  Pointer to the SHA-512 context.
+  @param[in]       Data           Pointer to the buffer containing the data to be hashed.
+  @param[in]       DataSize       Size of Data buffer in bytes.
+
+  @retval TRUE   SHA-512 data digest succeeded.
+  @retval FALSE  SHA-512 data digest failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha512Update (
+  IN OUT  VOID        *Sha512Context,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  if (Sha512Context == NULL) {
+    return FALSE;
+  }
+
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(psa_hash_update (Sha512Context, Data, DataSize) == PSA_SUCCESS);
+}
+
+/**
+  Completes computation of the SHA-512 digest value.
+
+  This function completes SHA-512 hash computation and retrieves the digest value into
+  the specified memory. After this function has been called, the SHA-512 context cannot
+  be used again.
+  SHA-512 context should be already correctly initialized by Sha512Init(), and should not be
+  finalized by Sha512Final(). Behavior with invalid SHA-512 context is undefined.
+
+  If Sha512Context is NULL, then return FALSE.
+  If HashValue is NULL, then return FALSE.
+
+  @param[in, out]  Sha512Context  Pointer to the SHA-512 context.
+  @param[out]      HashValue      Pointer to a buffer that receives the SHA-512 digest
+                                  value (64 bytes).
+
+  @retval TRUE   SHA-512 digest computation succeeded.
+  @retval FALSE  SHA-512 digest computation failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha512Final (
+  IN OUT  VOID   *Sha512Context,
+  OUT     UINT8  *HashValue
+  )
+{
+  size_t  HashLength;
+
+  if (Sha512Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+
+  if (psa_hash_finish (Sha512Context, HashValue, SHA512_DIGEST_SIZE, &HashLength) != PSA_SUCCESS) {
+    psa_hash_abort (Sha512Context);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Computes the SHA-512 message digest of a input data buffer.
+
+  This function performs the SHA-512 message digest of a given data buffer, and places
+  the digest value into the specified memory.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Data        Pointer to the buffer containing the data to be hashed.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[out]  HashValue   Pointer to a buffer that receives the SHA-512 digest
+                           value (64 bytes).
+
+  @retval TRUE   SHA-512 digest computation succeeded.
+  @retval FALSE  SHA-512 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha512HashAll (
+  IN   CONST VOID  *Data,
+  IN   UINTN       DataSize,
+  OUT  UINT8       *HashValue
+  )
+{
+  size_t  HashLength;
+
+  if (HashValue == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(psa_hash_compute (PSA_ALG_SHA_512, Data, DataSize, HashValue, SHA512_DIGEST_SIZE, &HashLength) == PSA_SUCCESS);
+}
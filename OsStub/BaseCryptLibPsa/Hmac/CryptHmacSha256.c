@@ -0,0 +1,871 @@
+/** @file
+  HMAC-SHA256/384/512 Wrapper Implementation over PSA Crypto.
+
+Copyright (c) 2016 - 2017, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+
+//
+// PSA Crypto has no clone of a MAC operation, which HmacSha256Duplicate() requires, so the HMAC
+// is computed on the PSA hash operations (RFC 2104), which psa_hash_clone() copies.
+// The hash operations run on the hash accelerator like the other digests.
+//
+#define HMAC_PSA_MAX_BLOCK_SIZE   128
+
+/**
+  Retrieves the block size, in bytes, of a PSA hash algorithm.
+
+  @param[in]  HashAlg  The PSA hash algorithm.
+
+  @return  The block size in bytes, or 0 if the hash algorithm is not supported.
+
+**/
+STATIC
+UINTN
+HmacPsaBlockSize (
+  IN  psa_algorithm_t  HashAlg
+  )
+{
+  switch (HashAlg) {
+  case PSA_ALG_SHA_256:
+    return 64;
+  case PSA_ALG_SHA_384:
+  case PSA_ALG_SHA_512:
+    return 128;
+  default:
+    return 0;
+  }
+}
+
+/**
+  Allocates and initializes one HMAC context for subsequent HMAC use.
+
+  @return  Pointer to the HMAC context that has been initialized.
+           If the allocations fails, HmacPsaNew() returns NULL.
+
+**/
+VOID *
+HmacPsaNew (
+  VOID
+  )
+{
+  //
+  // Zeroed PSA hash operations are inactive, as after psa_hash_operation_init().
+  //
+  return AllocateZeroPool (sizeof(PSA_HMAC_CONTEXT));
+}
+
+/**
+  Release the specified HMAC context.
+
+  @param[in]  HmacPsaCtx  Pointer to the HMAC context to be released.
+
+**/
+VOID
+HmacPsaFree (
+  IN  VOID  *HmacPsaCtx
+  )
+{
+  PSA_HMAC_CONTEXT  *Context;
+
+  if (HmacPsaCtx == NULL) {
+    return ;
+  }
+  Context = HmacPsaCtx;
+  psa_hash_abort (&Context->Inner);
+  psa_hash_abort (&Context->Outer);
+  FreePool (Context);
+}
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to HmacPsaUpdate().
+
+  If HmacPsaContext is NULL, then return FALSE.
+
+  @param[in]   HashAlg            The PSA hash algorithm.
+  @param[out]  HmacPsaContext     Pointer to HMAC context.
+  @param[in]   Key                Pointer to the user-supplied key.
+  @param[in]   KeySize            Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+HmacPsaSetKey (
+  IN   psa_algorithm_t  HashAlg,
+  OUT  VOID             *HmacPsaContext,
+  IN   CONST UINT8      *Key,
+  IN   UINTN            KeySize
+  )
+{
+  PSA_HMAC_CONTEXT  *Context;
+  UINT8             KeyBlock[HMAC_PSA_MAX_BLOCK_SIZE];
+  UINT8             Pad[HMAC_PSA_MAX_BLOCK_SIZE];
+  UINTN             BlockSize;
+  UINTN             Index;
+  size_t            KeyLength;
+  psa_status_t      Status;
+
+  if (HmacPsaContext == NULL || (Key == NULL && KeySize != 0)) {
+    return FALSE;
+  }
+  BlockSize = HmacPsaBlockSize (HashAlg);
+  if (BlockSize == 0) {
+    return FALSE;
+  }
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  Context = HmacPsaContext;
+  psa_hash_abort (&Context->Inner);
+  psa_hash_abort (&Context->Outer);
+
+  //
+  // A key longer than the block is replaced by its digest.
+  //
+  ZeroMem (KeyBlock, sizeof(KeyBlock));
+  Status = PSA_SUCCESS;
+  if (KeySize > BlockSize) {
+    Status = psa_hash_compute (HashAlg, Key, KeySize, KeyBlock, sizeof(KeyBlock), &KeyLength);
+  } else {
+    CopyMem (KeyBlock, Key, KeySize);
+  }
+
+  for (Index = 0; Index < BlockSize; Index++) {
+    Pad[Index] = KeyBlock[Index] ^ 0x36;
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_hash_setup (&Context->Inner, HashAlg);
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_hash_update (&Context->Inner, Pad, BlockSize);
+  }
+
+  for (Index = 0; Index < BlockSize; Index++) {
+    Pad[Index] = KeyBlock[Index] ^ 0x5c;
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_hash_setup (&Context->Outer, HashAlg);
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_hash_update (&Context->Outer, Pad, BlockSize);
+  }
+
+  ZeroMem (KeyBlock, sizeof(KeyBlock));
+  ZeroMem (Pad, sizeof(Pad));
+  if (Status != PSA_SUCCESS) {
+    psa_hash_abort (&Context->Inner);
+    psa_hash_abort (&Context->Outer);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Makes a copy of an existing HMAC context.
+
+  If HmacPsaContext is NULL, then return FALSE.
+  If NewHmacPsaContext is NULL, then return FALSE.
+
+  @param[in]  HmacPsaContext     Pointer to HMAC context being copied.
+  @param[out] NewHmacPsaContext  Pointer to new HMAC context.
+
+  @retval TRUE   HMAC context copy succeeded.
+  @retval FALSE  HMAC context copy failed.
+
+**/
+BOOLEAN
+HmacPsaDuplicate (
+  IN   CONST VOID  *HmacPsaContext,
+  OUT  VOID        *NewHmacPsaContext
+  )
+{
+  CONST PSA_HMAC_CONTEXT  *Context;
+  PSA_HMAC_CONTEXT        *NewContext;
+  psa_status_t            Status;
+
+  if (HmacPsaContext == NULL || NewHmacPsaContext == NULL) {
+    return FALSE;
+  }
+
+  Context = HmacPsaContext;
+  NewContext = NewHmacPsaContext;
+  psa_hash_abort (&NewContext->Inner);
+  psa_hash_abort (&NewContext->Outer);
+
+  Status = psa_hash_clone (&Context->Inner, &NewContext->Inner);
+  if (Status == PSA_SUCCESS) {
+    Status = psa_hash_clone (&Context->Outer, &NewContext->Outer);
+  }
+  if (Status != PSA_SUCCESS) {
+    psa_hash_abort (&NewContext->Inner);
+    psa_hash_abort (&NewContext->Outer);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Digests the input data and updates HMAC context.
+
+  This function performs HMAC digest on a data buffer of the specified size.
+  It can be called multiple times to compute the digest of long or discontinuous data streams.
+  HMAC context should be initialized by HmacPsaNew(), and should not be finalized
+  by HmacPsaFinal(). Behavior with invalid context is undefined.
+
+  If HmacPsaContext is NULL, then return FALSE.
+
+  @param[in, out]  HmacPsaContext    Pointer to the HMAC context.
+  @param[in]       Data              Pointer to the buffer containing the data to be digested.
+  @param[in]       DataSize          Size of Data buffer in bytes.
+
+  @retval TRUE   HMAC data digest succeeded.
+  @retval FALSE  HMAC data digest failed.
+
+**/
+BOOLEAN
+HmacPsaUpdate (
+  IN OUT  VOID        *HmacPsaContext,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  PSA_HMAC_CONTEXT  *Context;
+
+  if (HmacPsaContext == NULL) {
+    return FALSE;
+  }
+
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+
+  Context = HmacPsaContext;
+  return (BOOLEAN)(psa_hash_update (&Context->Inner, Data, DataSize) == PSA_SUCCESS);
+}
+
+/**
+  Completes computation of the HMAC digest value.
+
+  This function completes HMAC hash computation and retrieves the digest value into
+  the specified memory. After this function has been called, the HMAC context cannot
+  be used again.
+  HMAC context should be initialized by HmacPsaNew(), and should not be finalized
+  by HmacPsaFinal(). Behavior with invalid HMAC context is undefined.
+
+  If HmacPsaContext is NULL, then return FALSE.
+  If HmacValue is NULL, then return FALSE.
+
+  @param[in, out]  HmacPsaContext     Pointer to the HMAC context.
+  @param[out]      HmacValue          Pointer to a buffer that receives the HMAC digest
+                                      value.
+
+  @retval TRUE   HMAC digest computation succeeded.
+  @retval FALSE  HMAC digest computation failed.
+
+**/
+BOOLEAN
+HmacPsaFinal (
+  IN OUT  VOID   *HmacPsaContext,
+  OUT     UINT8  *HmacValue
+  )
+{
+  PSA_HMAC_CONTEXT  *Context;
+  UINT8             Digest[SHA512_DIGEST_SIZE];
+  size_t            DigestLength;
+  psa_status_t      Status;
+
+  if (HmacPsaContext == NULL || HmacValue == NULL) {
+    return FALSE;
+  }
+
+  Context = HmacPsaContext;
+  Status = psa_hash_finish (&Context->Inner, Digest, sizeof(Digest), &DigestLength);
+  if (Status == PSA_SUCCESS) {
+    Status = psa_hash_update (&Context->Outer, Digest, DigestLength);
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_hash_finish (&Context->Outer, HmacValue, DigestLength, &DigestLength);
+  }
+
+  ZeroMem (Digest, sizeof(Digest));
+  if (Status != PSA_SUCCESS) {
+    psa_hash_abort (&Context->Inner);
+    psa_hash_abort (&Context->Outer);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Computes the HMAC of a input data buffer with the PSA hash operations.
+
+  @param[in]   HashAlg     The PSA hash algorithm.
+  @param[in]   Data        Pointer to the buffer containing the data to be digested.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[in]   Key         Pointer to the user-supplied key.
+  @param[in]   KeySize     Key size in bytes.
+  @param[out]  HmacValue   Pointer to a buffer that receives the HMAC digest value.
+
+  @retval TRUE   HMAC digest computation succeeded.
+  @retval FALSE  HMAC digest computation failed.
+
+**/
+BOOLEAN
+HmacPsaAll (
+  IN   psa_algorithm_t  HashAlg,
+  IN   CONST VOID       *Data,
+  IN   UINTN            DataSize,
+  IN   CONST UINT8      *Key,
+  IN   UINTN            KeySize,
+  OUT  UINT8            *HmacValue
+  )
+{
+  PSA_HMAC_CONTEXT  Context;
+
+  ZeroMem (&Context, sizeof(Context));
+  if (!HmacPsaSetKey (HashAlg, &Context, Key, KeySize)) {
+    return FALSE;
+  }
+  if (!HmacPsaUpdate (&Context, Data, DataSize)) {
+    psa_hash_abort (&Context.Inner);
+    psa_hash_abort (&Context.Outer);
+    return FALSE;
+  }
+  return HmacPsaFinal (&Context, HmacValue);
+}
+
+/**
+  Allocates and initializes one HMAC_CTX context for subsequent HMAC-SHA256 use.
+
+  @return  Pointer to the HMAC_CTX context that has been initialized.
+           If the allocations fails, HmacSha256New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+HmacSha256New (
+  VOID
+  )
+{
+  return HmacPsaNew ();
+}
+
+/**
+  Release the specified HMAC_CTX context.
+
+  @param[in]  HmacSha256Ctx  Pointer to the HMAC_CTX context to be released.
+
+**/
+VOID
+EFIAPI
+HmacSha256Free (
+  IN  VOID  *HmacSha256Ctx
+  )
+{
+  HmacPsaFree (HmacSha256Ctx);
+}
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to HmacSha256Update().
+
+  If HmacSha256Context is NULL, then return FALSE.
+
+  @param[out]  HmacSha256Context  Pointer to HMAC-SHA256 context.
+  @param[in]   Key                Pointer to the user-supplied key.
+  @param[in]   KeySize            Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha256SetKey (
+  OUT  VOID         *HmacSha256Context,
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize
+  )
+{
+  return HmacPsaSetKey (PSA_ALG_SHA_256, HmacSha256Context, Key, KeySize);
+}
+
+/**
+  Makes a copy of an existing HMAC-SHA256 context.
+
+  If HmacSha256Context is NULL, then return FALSE.
+  If NewHmacSha256Context is NULL, then return FALSE.
+
+  @param[in]  HmacSha256Context     Pointer to HMAC-SHA256 context being copied.
+  @param[out] NewHmacSha256Context  Pointer to new HMAC-SHA256 context.
+
+  @retval TRUE   HMAC-SHA256 context copy succeeded.
+  @retval FALSE  HMAC-SHA256 context copy failed.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha256Duplicate (
+  IN   CONST VOID  *HmacSha256Context,
+  OUT  VOID        *NewHmacSha256Context
+  )
+{
+  return HmacPsaDuplicate (HmacSha256Context, NewHmacSha256Context);
+}
+
+/**
+  Digests the input data and updates HMAC-SHA256 context.
+
+  This function performs HMAC-SHA256 digest on a data buffer of the specified size.
+  It can be called multiple times to compute the digest of long or discontinuous data streams.
+  HMAC-SHA256 context should be initialized by HmacSha256New(), and should not be finalized
+  by HmacSha256Final(). Behavior with invalid context is undefined.
+
+  If HmacSha256Context is NULL, then return FALSE.
+
+  @param[in, out]  HmacSha256Context Pointer to the HMAC-SHA256 context.
+  @param[in]       Data              Pointer to the buffer containing the data to be digested.
+  @param[in]       DataSize          Size of Data buffer in bytes.
+
+  @retval TRUE   HMAC-SHA256 data digest succeeded.
+  @retval FALSE  HMAC-SHA256 data digest failed.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha256Update (
+  IN OUT  VOID        *HmacSha256Context,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  return HmacPsaUpdate (HmacSha256Context, Data, DataSize);
+}
+
+/**
+  Completes computation of the HMAC-SHA256 digest value.
+
+  This function completes HMAC-SHA256 hash computation and retrieves the digest value into
+  the specified memory. After this function has been called, the HMAC-SHA256 context cannot
+  be used again.
+  HMAC-SHA256 context should be initialized by HmacSha256New(), and should not be finalized
+  by HmacSha256Final(). Behavior with invalid HMAC-SHA256 context is undefined.
+
+  If HmacSha256Context is NULL, then return FALSE.
+  If HmacValue is NULL, then return FALSE.
+
+  @param[in, out]  HmacSha256Context  Pointer to the HMAC-SHA256 context.
+  @param[out]      HmacValue          Pointer to a buffer that receives the HMAC-SHA256 digest
+                                      value (32 bytes).
+
+  @retval TRUE   HMAC-SHA256 digest computation succeeded.
+  @retval FALSE  HMAC-SHA256 digest computation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha256Final (
+  IN OUT  VOID   *HmacSha256Context,
+  OUT     UINT8  *HmacValue
+  )
+{
+  return HmacPsaFinal (HmacSha256Context, HmacValue);
+}
+
+/**
+  Computes the HMAC-SHA256 digest of a input data buffer.
+
+  This function performs the HMAC-SHA256 digest of a given data buffer, and places
+  the digest value into the specified memory.
+
+  If this interface is not supported, then return FALSE.
+  
+  @param[in]   Data        Pointer to the buffer containing the data to be digested.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[in]   Key         Pointer to the user-supplied key.
+  @param[in]   KeySize     Key size in bytes.
+  @param[out]  HashValue   Pointer to a buffer that receives the HMAC-SHA256 digest
+                           value (32 bytes).
+
+  @retval TRUE   HMAC-SHA256 digest computation succeeded.
+  @retval FALSE  HMAC-SHA256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha256All (
+  IN   CONST VOID   *Data,
+  IN   UINTN        DataSize,
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  OUT  UINT8       *HmacValue
+  )
+{
+  return HmacPsaAll (PSA_ALG_SHA_256, Data, DataSize, Key, KeySize, HmacValue);
+}
+
+/**
+  Allocates and initializes one HMAC_CTX context for subsequent HMAC-SHA384 use.
+
+  @return  Pointer to the HMAC_CTX context that has been initialized.
+           If the allocations fails, HmacSha384New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+HmacSha384New (
+  VOID
+  )
+{
+  return HmacPsaNew ();
+}
+
+/**
+  Release the specified HMAC_CTX context.
+
+  @param[in]  HmacSha384Ctx  Pointer to the HMAC_CTX context to be released.
+
+**/
+VOID
+EFIAPI
+HmacSha384Free (
+  IN  VOID  *HmacSha384Ctx
+  )
+{
+  HmacPsaFree (HmacSha384Ctx);
+}
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to HmacSha384Update().
+
+  If HmacSha384Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[out]  HmacSha384Context  Pointer to HMAC-SHA384 context.
+  @param[in]   Key                Pointer to the user-supplied key.
+  @param[in]   KeySize            Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha384SetKey (
+  OUT  VOID         *HmacSha384Context,
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize
+  )
+{
+  return HmacPsaSetKey (PSA_ALG_SHA_384, HmacSha384Context, Key, KeySize);
+}
+
+/**
+  Makes a copy of an existing HMAC-SHA384 context.
+
+  If HmacSha384Context is NULL, then return FALSE.
+  If NewHmacSha384Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in]  HmacSha384Context     Pointer to HMAC-SHA384 context being copied.
+  @param[out] NewHmacSha384Context  Pointer to new HMAC-SHA384 context.
+
+  @retval TRUE   HMAC-SHA384 context copy succeeded.
+  @retval FALSE  HMAC-SHA384 context copy failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha384Duplicate (
+  IN   CONST VOID  *HmacSha384Context,
+  OUT  VOID        *NewHmacSha384Context
+  )
+{
+  return HmacPsaDuplicate (HmacSha384Context, NewHmacSha384Context);
+}
+
+/**
+  Digests the input data and updates HMAC-SHA384 context.
+
+  This function performs HMAC-SHA384 digest on a data buffer of the specified size.
+  It can be called multiple times to compute the digest of long or discontinuous data streams.
+  HMAC-SHA384 context should be initialized by HmacSha384New(), and should not be finalized
+  by HmacSha384Final(). Behavior with invalid context is undefined.
+
+  If HmacSha384Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in, out]  HmacSha384Context Pointer to the HMAC-SHA384 context.
+  @param[in]       Data              Pointer to the buffer containing the data to be digested.
+  @param[in]       DataSize          Size of Data buffer in bytes.
+
+  @retval TRUE   HMAC-SHA384 data digest succeeded.
+  @retval FALSE  HMAC-SHA384 data digest failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha384Update (
+  IN OUT  VOID        *HmacSha384Context,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  return HmacPsaUpdate (HmacSha384Context, Data, DataSize);
+}
+
+/**
+  Completes computation of the HMAC-SHA384 digest value.
+
+  This function completes HMAC-SHA384 hash computation and retrieves the digest value into
+  the specified memory. After this function has been called, the HMAC-SHA384 context cannot
+  be used again.
+  HMAC-SHA384 context should be initialized by HmacSha384New(), and should not be finalized
+  by HmacSha384Final(). Behavior with invalid HMAC-SHA384 context is undefined.
+
+  If HmacSha384Context is NULL, then return FALSE.
+  If HmacValue is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in, out]  HmacSha384Context  Pointer to the HMAC-SHA384 context.
+  @param[out]      HmacValue          Pointer to a buffer that receives the HMAC-SHA384 digest
+                                      value (48 bytes).
+
+  @retval TRUE   HMAC-SHA384 digest computation succeeded.
+  @retval FALSE  HMAC-SHA384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha384Final (
+  IN OUT  VOID   *HmacSha384Context,
+  OUT     UINT8  *HmacValue
+  )
+{
+  return HmacPsaFinal (HmacSha384Context, HmacValue);
+}
+
+/**
+  Computes the HMAC-SHA384 digest of a input data buffer.
+
+  This function performs the HMAC-SHA384 digest of a given data buffer, and places
+  the digest value into the specified memory.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Data        Pointer to the buffer containing the data to be digested.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[in]   Key         Pointer to the user-supplied key.
+  @param[in]   KeySize     Key size in bytes.
+  @param[out]  HashValue   Pointer to a buffer that receives the HMAC-SHA384 digest
+                           value (48 bytes).
+
+  @retval TRUE   HMAC-SHA384 digest computation succeeded.
+  @retval FALSE  HMAC-SHA384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha384All (
+  IN   CONST VOID   *Data,
+  IN   UINTN        DataSize,
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  OUT  UINT8        *HmacValue
+  )
+{
+  return HmacPsaAll (PSA_ALG_SHA_384, Data, DataSize, Key, KeySize, HmacValue);
+}
+
+/**
+  Allocates and initializes one HMAC_CTX context for subsequent HMAC-SHA512 use.
+
+  @return  Pointer to the HMAC_CTX context that has been initialized.
+           If the allocations fails, HmacSha512New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+HmacSha512New (
+  VOID
+  )
+{
+  return HmacPsaNew ();
+}
+
+/**
+  Release the specified HMAC_CTX context.
+
+  @param[in]  HmacSha512Ctx  Pointer to the HMAC_CTX context to be released.
+
+**/
+VOID
+EFIAPI
+HmacSha512Free (
+  IN  VOID  *HmacSha512Ctx
+  )
+{
+  HmacPsaFree (HmacSha512Ctx);
+}
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to HmacSha512Update().
+
+  If HmacSha512Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[out]  HmacSha512Context  Pointer to HMAC-SHA512 context.
+  @param[in]   Key                Pointer to the user-supplied key.
+  @param[in]   KeySize            Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha512SetKey (
+  OUT  VOID         *HmacSha512Context,
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize
+  )
+{
+  return HmacPsaSetKey (PSA_ALG_SHA_512, HmacSha512Context, Key, KeySize);
+}
+
+/**
+  Makes a copy of an existing HMAC-SHA512 context.
+
+  If HmacSha512Context is NULL, then return FALSE.
+  If NewHmacSha512Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in]  HmacSha512Context     Pointer to HMAC-SHA512 context being copied.
+  @param[out] NewHmacSha512Context  Pointer to new HMAC-SHA512 context.
+
+  @retval TRUE   HMAC-SHA512 context copy succeeded.
+  @retval FALSE  HMAC-SHA512 context copy failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha512Duplicate (
+  IN   CONST VOID  *HmacSha512Context,
+  OUT  VOID        *NewHmacSha512Context
+  )
+{
+  return HmacPsaDuplicate (HmacSha512Context, NewHmacSha512Context);
+}
+
+/**
+  Digests the input data and updates HMAC-SHA512 context.
+
+  This function performs HMAC-SHA512 digest on a data buffer of the specified size.
+  It can be called multiple times to compute the digest of long or discontinuous data streams.
+  HMAC-SHA512 context should be initialized by HmacSha512New(), and should not be finalized
+  by HmacSha512Final(). Behavior with invalid context is undefined.
+
+  If HmacSha512Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in, out]  HmacSha512Context Pointer to the HMAC-SHA512 context.
+  @param[in]       Data              Pointer to the buffer containing the data to be digested.
+  @param[in]       DataSize          Size of Data buffer in bytes.
+
+  @retval TRUE   HMAC-SHA512 data digest succeeded.
+  @retval FALSE  HMAC-SHA512 data digest failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha512Update (
+  IN OUT  VOID        *HmacSha512Context,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  return HmacPsaUpdate (HmacSha512Context, Data, DataSize);
+}
+
+/**
+  Completes computation of the HMAC-SHA512 digest value.
+
+  This function completes HMAC-SHA512 hash computation and retrieves the digest value into
+  the specified memory. After this function has been called, the HMAC-SHA512 context cannot
+  be used again.
+  HMAC-SHA512 context should be initialized by HmacSha512New(), and should not be finalized
+  by HmacSha512Final(). Behavior with invalid HMAC-SHA512 context is undefined.
+
+  If HmacSha512Context is NULL, then return FALSE.
+  If HmacValue is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in, out]  HmacSha512Context  Pointer to the HMAC-SHA512 context.
+  @param[out]      HmacValue          Pointer to a buffer that receives the HMAC-SHA512 digest
+                                      value (64 bytes).
+
+  @retval TRUE   HMAC-SHA512 digest computation succeeded.
+  @retval FALSE  HMAC-SHA512 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha512Final (
+  IN OUT  VOID   *HmacSha512Context,
+  OUT     UINT8  *HmacValue
+  )
+{
+  return HmacPsaFinal (HmacSha512Context, HmacValue);
+}
+
+/**
+  Computes the HMAC-SHA512 digest of a input data buffer.
+
+  This function performs the HMAC-SHA512 digest of a given data buffer, and places
+  the digest value into the specified memory.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Data        Pointer to the buffer containing the data to be digested.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[in]   Key         Pointer to the user-supplied key.
+  @param[in]   KeySize     Key size in bytes.
+  @param[out]  HashValue   Pointer to a buffer that receives the HMAC-SHA512 digest
+                           value (64 bytes).
+
+  @retval TRUE   HMAC-SHA512 digest computation succeeded.
+  @retval FALSE  HMAC-SHA512 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+HmacSha512All (
+  IN   CONST VOID   *Data,
+  IN   UINTN        DataSize,
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  OUT  UINT8        *HmacValue
+  )
+{
+  return HmacPsaAll (PSA_ALG_SHA_512, Data, DataSize, Key, KeySize, HmacValue);
+}
@@ -0,0 +1,273 @@
+/** @file
+  Internal include file for BaseCryptLib over PSA Crypto.
+
+  The hash, HMAC, HKDF, AEAD, EC and random functions call the PSA Crypto API,
+  so that they run on the accelerator drivers or the secure element behind it.
+  The other functions are shared with BaseCryptLibMbedTls, so this file is also
+  the InternalCryptLib.h of these MbedTls sources.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __INTERNAL_CRYPT_LIB_H__
+#define __INTERNAL_CRYPT_LIB_H__
+
+#include <Base.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseCryptLib.h>
+#include <stdio.h>
+
+//
+// We should alwasy add mbedtls/config.h here
+// to ensure the config override takes effect.
+//
+#include <mbedtls/config.h>
+
+#include <psa/crypto.h>
+
+//
+// The shared BaseCryptLibMbedTls sources leave out the functions that BaseCryptLibPsa implements itself.
+//
+#define BASE_CRYPT_LIB_PSA
+
+int myrand( void *rng_state, unsigned char *output, size_t len );
+
+/**
+  Initialize the PSA Crypto implementation, the first time it is called.
+
+  @retval TRUE   The PSA Crypto implementation is initialized.
+  @retval FALSE  The PSA Crypto implementation cannot be initialized.
+
+**/
+BOOLEAN
+InternalCryptPsaInit (
+  VOID
+  );
+
+//
+// An HMAC context. The inner hash operation has absorbed the key XOR ipad, and the outer
+// hash operation the key XOR opad, so that the key is not kept.
+//
+typedef struct {
+  psa_hash_operation_t  Inner;
+  psa_hash_operation_t  Outer;
+} PSA_HMAC_CONTEXT;
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to HmacPsaUpdate().
+
+  @param[in]   HashAlg            The PSA hash algorithm.
+  @param[out]  HmacPsaContext     Pointer to HMAC context.
+  @param[in]   Key                Pointer to the user-supplied key.
+  @param[in]   KeySize            Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+HmacPsaSetKey (
+  IN   psa_algorithm_t  HashAlg,
+  OUT  VOID             *HmacPsaContext,
+  IN   CONST UINT8      *Key,
+  IN   UINTN            KeySize
+  );
+
+/**
+  Makes a copy of an existing HMAC context.
+
+  @param[in]  HmacPsaContext     Pointer to HMAC context being copied.
+  @param[out] NewHmacPsaContext  Pointer to new HMAC context.
+
+  @retval TRUE   HMAC context copy succeeded.
+  @retval FALSE  HMAC context copy failed.
+
+**/
+BOOLEAN
+HmacPsaDuplicate (
+  IN   CONST VOID  *HmacPsaContext,
+  OUT  VOID        *NewHmacPsaContext
+  );
+
+/**
+  Digests the input data and updates HMAC context.
+
+  @param[in, out]  HmacPsaContext    Pointer to the HMAC context.
+  @param[in]       Data              Pointer to the buffer containing the data to be digested.
+  @param[in]       DataSize          Size of Data buffer in bytes.
+
+  @retval TRUE   HMAC data digest succeeded.
+  @retval FALSE  HMAC data digest failed.
+
+**/
+BOOLEAN
+HmacPsaUpdate (
+  IN OUT  VOID        *HmacPsaContext,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  );
+
+/**
+  Completes computation of the HMAC digest value.
+
+  @param[in, out]  HmacPsaContext     Pointer to the HMAC context.
+  @param[out]      HmacValue          Pointer to a buffer that receives the HMAC digest
+                                      value.
+
+  @retval TRUE   HMAC digest computation succeeded.
+  @retval FALSE  HMAC digest computation failed.
+
+**/
+BOOLEAN
+HmacPsaFinal (
+  IN OUT  VOID   *HmacPsaContext,
+  OUT     UINT8  *HmacValue
+  );
+
+/**
+  Computes the HMAC of a input data buffer with the PSA hash operations.
+
+  @param[in]   HashAlg     The PSA hash algorithm.
+  @param[in]   Data        Pointer to the buffer containing the data to be digested.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[in]   Key         Pointer to the user-supplied key.
+  @param[in]   KeySize     Key size in bytes.
+  @param[out]  HmacValue   Pointer to a buffer that receives the HMAC digest value.
+
+  @retval TRUE   HMAC digest computation succeeded.
+  @retval FALSE  HMAC digest computation failed.
+
+**/
+BOOLEAN
+HmacPsaAll (
+  IN   psa_algorithm_t  HashAlg,
+  IN   CONST VOID       *Data,
+  IN   UINTN            DataSize,
+  IN   CONST UINT8      *Key,
+  IN   UINTN            KeySize,
+  OUT  UINT8            *HmacValue
+  );
+
+//
+// An AEAD context. The key is imported once by the SetKey function, and the PSA Crypto
+// implementation holds it until the context is released.
+//
+typedef struct {
+  psa_key_id_t     KeyId;
+  psa_key_type_t   KeyType;
+  psa_algorithm_t  Alg;
+  UINTN            MinTagSize;
+} PSA_AEAD_CONTEXT;
+
+/**
+  Import the key of an AEAD context, and destroy the key it held before.
+
+  @param[in, out]  AeadContext  Pointer to the AEAD context.
+  @param[in]       Key          Pointer to the user-supplied key.
+  @param[in]       KeySize      Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+InternalAeadPsaSetKey (
+  IN OUT  PSA_AEAD_CONTEXT  *AeadContext,
+  IN      CONST UINT8       *Key,
+  IN      UINTN             KeySize
+  );
+
+/**
+  Destroy the key of an AEAD context.
+
+  @param[in, out]  AeadContext  Pointer to the AEAD context.
+
+**/
+VOID
+InternalAeadPsaDestroyKey (
+  IN OUT  PSA_AEAD_CONTEXT  *AeadContext
+  );
+
+/**
+  Performs AEAD authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with the multipart PSA AEAD operation.
+
+  The segments are encrypted in order, as if they were one contiguous buffer, into DataOut.
+  With no segment, only the authentication tag of the AAD is generated.
+
+  @param[in]   AeadContext  Pointer to the keyed AEAD context.
+  @param[in]   Iv           Pointer to the IV value.
+  @param[in]   IvSize       Size of the IV value in bytes.
+  @param[in]   AData        Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize    Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn       Pointer to the list of input data segments to be encrypted.
+  @param[in]   DataInCount  Number of entries in DataIn.
+  @param[out]  TagOut       Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize      Size of the authentication tag in bytes.
+  @param[out]  DataOut      Pointer to a buffer that receives the encryption output.
+  @param[in]   DataOutSize  Size of the output data buffer in bytes, the total size of the segments.
+
+  @retval TRUE   AEAD authenticated encryption succeeded.
+  @retval FALSE  AEAD authenticated encryption failed.
+
+**/
+BOOLEAN
+InternalAeadPsaSeal (
+  IN   PSA_AEAD_CONTEXT            *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataIn,
+  IN   UINTN                       DataInCount,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize,
+  OUT  UINT8                       *DataOut,
+  IN   UINTN                       DataOutSize
+  );
+
+/**
+  Performs AEAD authenticated decryption on a data buffer and additional authenticated data (AAD)
+  into a list of data segments, with the multipart PSA AEAD operation.
+
+  The plain text is written in order across the segments, which must hold at least DataInSize bytes.
+  If the authentication fails, the plain text written to the segments is zeroed.
+  With no data, only the authentication tag of the AAD is verified.
+
+  @param[in]   AeadContext   Pointer to the keyed AEAD context.
+  @param[in]   Iv            Pointer to the IV value.
+  @param[in]   IvSize        Size of the IV value in bytes.
+  @param[in]   AData         Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize     Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn        Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize    Size of the input data buffer in bytes.
+  @param[in]   Tag           Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize       Size of the authentication tag in bytes.
+  @param[in]   DataOut       Pointer to the list of segments that receive the decryption output.
+  @param[in]   DataOutCount  Number of entries in DataOut.
+
+  @retval TRUE   AEAD authenticated decryption succeeded.
+  @retval FALSE  AEAD authenticated decryption failed.
+
+**/
+BOOLEAN
+InternalAeadPsaOpen (
+  IN   PSA_AEAD_CONTEXT            *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *DataIn,
+  IN   UINTN                       DataInSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataOut,
+  IN   UINTN                       DataOutCount
+  );
+
+#endif
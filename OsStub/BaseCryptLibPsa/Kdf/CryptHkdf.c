@@ -0,0 +1,494 @@
+/** @file
+  HMAC-SHA256/384/512 KDF Wrapper Implementation over PSA Crypto.
+
+  RFC 5869: HMAC-based Extract-and-Expand Key Derivation Function (HKDF)
+
+Copyright (c) 2018 - 2019, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+
+/**
+  Retrieves the digest size, in bytes, of a PSA hash algorithm.
+
+  @param[in]  HashAlg  The PSA hash algorithm.
+
+  @return  The digest size in bytes, or 0 if the hash algorithm is not supported.
+
+**/
+STATIC
+UINTN
+HkdfPsaDigestSize (
+  IN  psa_algorithm_t  HashAlg
+  )
+{
+  switch (HashAlg) {
+  case PSA_ALG_SHA_256:
+    return SHA256_DIGEST_SIZE;
+  case PSA_ALG_SHA_384:
+    return SHA384_DIGEST_SIZE;
+  case PSA_ALG_SHA_512:
+    return SHA512_DIGEST_SIZE;
+  default:
+    return 0;
+  }
+}
+
+/**
+  Derive HMAC-based Extract-and-Expand Key Derivation Function (HKDF).
+
+  The derivation is a PSA key derivation operation. PSA Crypto 1.0 has no separate
+  HKDF extract and expand, so HkdfPsaExtract() and HkdfPsaExpand() are computed on the
+  PSA hash operations of the HMAC wrapper.
+
+  @param[in]   HashAlg          The PSA hash algorithm.
+  @param[in]   Key              Pointer to the user-supplied key.
+  @param[in]   KeySize          Key size in bytes.
+  @param[in]   Salt             Pointer to the salt(non-secret) value.
+  @param[in]   SaltSize         Salt size in bytes.
+  @param[in]   Info             Pointer to the application specific info.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+HkdfPsaExtractAndExpand (
+  IN   psa_algorithm_t  HashAlg,
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Salt,
+  IN   UINTN        SaltSize,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  psa_key_derivation_operation_t  Operation;
+  psa_status_t                    Status;
+
+  if (Key == NULL || Salt == NULL || Info == NULL || Out == NULL ||
+    KeySize > INT_MAX || SaltSize > INT_MAX || InfoSize > INT_MAX || OutSize > INT_MAX ) {
+    return FALSE;
+  }
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  Operation = psa_key_derivation_operation_init ();
+  Status = psa_key_derivation_setup (&Operation, PSA_ALG_HKDF (HashAlg));
+  if (Status == PSA_SUCCESS) {
+    Status = psa_key_derivation_input_bytes (&Operation, PSA_KEY_DERIVATION_INPUT_SALT, Salt, SaltSize);
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_key_derivation_input_bytes (&Operation, PSA_KEY_DERIVATION_INPUT_SECRET, Key, KeySize);
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_key_derivation_input_bytes (&Operation, PSA_KEY_DERIVATION_INPUT_INFO, Info, InfoSize);
+  }
+  if (Status == PSA_SUCCESS) {
+    Status = psa_key_derivation_output_bytes (&Operation, Out, OutSize);
+  }
+  psa_key_derivation_abort (&Operation);
+
+  return (BOOLEAN)(Status == PSA_SUCCESS);
+}
+
+/**
+  Derive HMAC-based Extract Key Derivation Function (HKDF).
+
+  @param[in]   HashAlg          The PSA hash algorithm.
+  @param[in]   Key              Pointer to the user-supplied key.
+  @param[in]   KeySize          Key size in bytes.
+  @param[in]   Salt             Pointer to the salt(non-secret) value.
+  @param[in]   SaltSize         Salt size in bytes.
+  @param[out]  PrkOut           Pointer to buffer to receive hkdf value.
+  @param[in]   PrkOutSize       Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+HkdfPsaExtract (
+  IN   psa_algorithm_t  HashAlg,
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Salt,
+  IN   UINTN        SaltSize,
+  OUT  UINT8        *PrkOut,
+  IN   UINTN        PrkOutSize
+  )
+{
+  if (Key == NULL || Salt == NULL || PrkOut == NULL ||
+    KeySize > INT_MAX || SaltSize > INT_MAX || PrkOutSize > INT_MAX ) {
+    return FALSE;
+  }
+
+  if (PrkOutSize != HkdfPsaDigestSize (HashAlg)) {
+    return FALSE;
+  }
+
+  //
+  // PRK = HMAC-Hash (Salt, IKM)
+  //
+  return HmacPsaAll (HashAlg, Key, KeySize, Salt, SaltSize, PrkOut);
+}
+
+/**
+  Derive HMAC-based Expand Key Derivation Function (HKDF).
+
+  @param[in]   HashAlg          The PSA hash algorithm.
+  @param[in]   Prk              Pointer to the user-supplied key.
+  @param[in]   PrkSize          Key size in bytes.
+  @param[in]   Info             Pointer to the application specific info.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+HkdfPsaExpand (
+  IN   psa_algorithm_t  HashAlg,
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  PSA_HMAC_CONTEXT  PrkContext;
+  PSA_HMAC_CONTEXT  Context;
+  UINT8             Block[SHA512_DIGEST_SIZE];
+  UINTN             MdSize;
+  UINTN             Offset;
+  UINTN             Length;
+  UINT8             Counter;
+  BOOLEAN           Result;
+
+  if (Prk == NULL || Info == NULL || Out == NULL ||
+    PrkSize > INT_MAX || InfoSize > INT_MAX || OutSize > INT_MAX ) {
+    return FALSE;
+  }
+
+  MdSize = HkdfPsaDigestSize (HashAlg);
+  if (MdSize == 0 || PrkSize != MdSize) {
+    return FALSE;
+  }
+  if (OutSize > 255 * MdSize) {
+    return FALSE;
+  }
+
+  //
+  // T(N) = HMAC-Hash (PRK, T(N - 1) | Info | N). The HMAC context keyed with PRK
+  // is duplicated for each block, so that the key is only absorbed once.
+  //
+  ZeroMem (&PrkContext, sizeof(PrkContext));
+  ZeroMem (&Context, sizeof(Context));
+  Result = HmacPsaSetKey (HashAlg, &PrkContext, Prk, PrkSize);
+  Offset = 0;
+  for (Counter = 1; Result && (Offset < OutSize); Counter++) {
+    Result = HmacPsaDuplicate (&PrkContext, &Context);
+    if (Result && (Offset != 0)) {
+      Result = HmacPsaUpdate (&Context, Block, MdSize);
+    }
+    if (Result) {
+      Result = HmacPsaUpdate (&Context, Info, InfoSize);
+    }
+    if (Result) {
+      Result = HmacPsaUpdate (&Context, &Counter, sizeof(Counter));
+    }
+    if (Result) {
+      Result = HmacPsaFinal (&Context, Block);
+    }
+    if (Result) {
+      Length = MIN (MdSize, OutSize - Offset);
+      CopyMem (Out + Offset, Block, Length);
+      Offset += Length;
+    }
+  }
+
+  psa_hash_abort (&PrkContext.Inner);
+  psa_hash_abort (&PrkContext.Outer);
+  psa_hash_abort (&Context.Inner);
+  psa_hash_abort (&Context.Outer);
+  ZeroMem (Block, sizeof(Block));
+  if (!Result) {
+    ZeroMem (Out, OutSize);
+  }
+  return Result;
+}
+
+/**
+  Derive SHA256 HMAC-based Extract-and-Expand Key Derivation Function (HKDF).
+
+  @param[in]   Key              Pointer to the user-supplied key.
+  @param[in]   KeySize          Key size in bytes.
+  @param[in]   Salt             Pointer to the salt(non-secret) value.
+  @param[in]   SaltSize         Salt size in bytes.
+  @param[in]   Info             Pointer to the application specific info.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfSha256ExtractAndExpand (
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Salt,
+  IN   UINTN        SaltSize,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  return HkdfPsaExtractAndExpand (PSA_ALG_SHA_256, Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
+}
+
+/**
+  Derive SHA256 HMAC-based Extract Key Derivation Function (HKDF).
+
+  @param[in]   Key              Pointer to the user-supplied key.
+  @param[in]   KeySize          Key size in bytes.
+  @param[in]   Salt             Pointer to the salt(non-secret) value.
+  @param[in]   SaltSize         Salt size in bytes.
+  @param[out]  PrkOut           Pointer to buffer to receive hkdf value.
+  @param[in]   PrkOutSize       Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfSha256Extract (
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Salt,
+  IN   UINTN        SaltSize,
+  OUT  UINT8        *PrkOut,
+  IN   UINTN        PrkOutSize
+  )
+{
+  return HkdfPsaExtract (PSA_ALG_SHA_256, Key, KeySize, Salt, SaltSize, PrkOut, PrkOutSize);
+}
+
+/**
+  Derive SHA256 HMAC-based Expand Key Derivation Function (HKDF).
+
+  @param[in]   Prk              Pointer to the user-supplied key.
+  @param[in]   PrkSize          Key size in bytes.
+  @param[in]   Info             Pointer to the application specific info.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfSha256Expand (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  return HkdfPsaExpand (PSA_ALG_SHA_256, Prk, PrkSize, Info, InfoSize, Out, OutSize);
+}
+
+/**
+  Derive SHA384 HMAC-based Extract-and-Expand Key Derivation Function (HKDF).
+
+  @param[in]   Key              Pointer to the user-supplied key.
+  @param[in]   KeySize          Key size in bytes.
+  @param[in]   Salt             Pointer to the salt(non-secret) value.
+  @param[in]   SaltSize         Salt size in bytes.
+  @param[in]   Info             Pointer to the application specific info.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfSha384ExtractAndExpand (
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Salt,
+  IN   UINTN        SaltSize,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  return HkdfPsaExtractAndExpand (PSA_ALG_SHA_384, Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
+}
+
+/**
+  Derive SHA384 HMAC-based Extract Key Derivation Function (HKDF).
+
+  @param[in]   Key              Pointer to the user-supplied key.
+  @param[in]   KeySize          Key size in bytes.
+  @param[in]   Salt             Pointer to the salt(non-secret) value.
+  @param[in]   SaltSize         Salt size in bytes.
+  @param[out]  PrkOut           Pointer to buffer to receive hkdf value.
+  @param[in]   PrkOutSize       Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfSha384Extract (
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Salt,
+  IN   UINTN        SaltSize,
+  OUT  UINT8        *PrkOut,
+  IN   UINTN        PrkOutSize
+  )
+{
+  return HkdfPsaExtract (PSA_ALG_SHA_384, Key, KeySize, Salt, SaltSize, PrkOut, PrkOutSize);
+}
+
+/**
+  Derive SHA384 HMAC-based Expand Key Derivation Function (HKDF).
+
+  @param[in]   Prk              Pointer to the user-supplied key.
+  @param[in]   PrkSize          Key size in bytes.
+  @param[in]   Info             Pointer to the application specific info.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfSha384Expand (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  return HkdfPsaExpand (PSA_ALG_SHA_384, Prk, PrkSize, Info, InfoSize, Out, OutSize);
+}
+
+/**
+  Derive SHA512 HMAC-based Extract-and-Expand Key Derivation Function (HKDF).
+
+  @param[in]   Key              Pointer to the user-supplied key.
+  @param[in]   KeySize          Key size in bytes.
+  @param[in]   Salt             Pointer to the salt(non-secret) value.
+  @param[in]   SaltSize         Salt size in bytes.
+  @param[in]   Info             Pointer to the application specific info.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfSha512ExtractAndExpand (
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Salt,
+  IN   UINTN        SaltSize,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  return HkdfPsaExtractAndExpand (PSA_ALG_SHA_512, Key, KeySize, Salt, SaltSize, Info, InfoSize, Out, OutSize);
+}
+
+/**
+  Derive SHA512 HMAC-based Extract Key Derivation Function (HKDF).
+
+  @param[in]   Key              Pointer to the user-supplied key.
+  @param[in]   KeySize          Key size in bytes.
+  @param[in]   Salt             Pointer to the salt(non-secret) value.
+  @param[in]   SaltSize         Salt size in bytes.
+  @param[out]  PrkOut           Pointer to buffer to receive hkdf value.
+  @param[in]   PrkOutSize       Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfSha512Extract (
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize,
+  IN   CONST UINT8  *Salt,
+  IN   UINTN        SaltSize,
+  OUT  UINT8        *PrkOut,
+  IN   UINTN        PrkOutSize
+  )
+{
+  return HkdfPsaExtract (PSA_ALG_SHA_512, Key, KeySize, Salt, SaltSize, PrkOut, PrkOutSize);
+}
+
+/**
+  Derive SHA512 HMAC-based Expand Key Derivation Function (HKDF).
+
+  @param[in]   Prk              Pointer to the user-supplied key.
+  @param[in]   PrkSize          Key size in bytes.
+  @param[in]   Info             Pointer to the application specific info.
+  @param[in]   InfoSize         Info size in bytes.
+  @param[out]  Out              Pointer to buffer to receive hkdf value.
+  @param[in]   OutSize          Size of hkdf bytes to generate.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+HkdfSha512Expand (
+  IN   CONST UINT8  *Prk,
+  IN   UINTN        PrkSize,
+  IN   CONST UINT8  *Info,
+  IN   UINTN        InfoSize,
+  OUT  UINT8        *Out,
+  IN   UINTN        OutSize
+  )
+{
+  return HkdfPsaExpand (PSA_ALG_SHA_512, Prk, PrkSize, Info, InfoSize, Out, OutSize);
+}
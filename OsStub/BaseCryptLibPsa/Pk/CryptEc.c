@@ -0,0 +1,1047 @@
+/** @file
+  Elliptic Curve Wrapper Implementation over PSA Crypto.
+
+  RFC 8422 - Elliptic Curve Cryptography (ECC) Cipher Suites
+  FIPS 186-4 - Digital Signature Standard (DSS)
+
+  The EC keys are PSA keys, so that a private key may stay in the secure element.
+  The certificate and PEM parsing is still done by MbedTls, and the key is imported afterwards.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+#include <mbedtls/ecp.h>
+#include <mbedtls/pk.h>
+#include <mbedtls/x509_crt.h>
+
+#define EC_PSA_MAX_HALF_SIZE  66
+
+//
+// An EC context. KeyId is PSA_KEY_ID_NULL until a public key is set or a key is generated.
+// PublicKey caches the public key in the uncompressed format 0x04 || X || Y, so that
+// EcGetPubKey() does not call the PSA Crypto implementation.
+// A key retrieved by EcGetPrivateKeyFromKeyId() is not owned, and EcFree() does not destroy it.
+//
+typedef struct {
+  UINTN         Nid;
+  UINTN         Bits;
+  UINTN         HalfSize;
+  psa_key_id_t  KeyId;
+  BOOLEAN       KeyOwned;
+  UINT8         PublicKey[1 + EC_PSA_MAX_HALF_SIZE * 2];
+  UINTN         PublicKeySize;
+} PSA_EC_CONTEXT;
+
+/**
+  Get the PSA algorithm of an EC-DSA signature and check the size of the message hash.
+
+  @param[in]  HashNid   hash NID
+  @param[in]  HashSize  Size of the message hash in bytes.
+
+  @return  The PSA EC-DSA algorithm, or 0 if the hash NID is not supported or HashSize does not match.
+
+**/
+STATIC
+psa_algorithm_t
+EcPsaDsaAlg (
+  IN  UINTN  HashNid,
+  IN  UINTN  HashSize
+  )
+{
+  switch (HashNid) {
+  case CRYPTO_NID_SHA256:
+    if (HashSize != SHA256_DIGEST_SIZE) {
+      return 0;
+    }
+    return PSA_ALG_ECDSA (PSA_ALG_SHA_256);
+
+  case CRYPTO_NID_SHA384:
+    if (HashSize != SHA384_DIGEST_SIZE) {
+      return 0;
+    }
+    return PSA_ALG_ECDSA (PSA_ALG_SHA_384);
+
+  case CRYPTO_NID_SHA512:
+    if (HashSize != SHA512_DIGEST_SIZE) {
+      return 0;
+    }
+    return PSA_ALG_ECDSA (PSA_ALG_SHA_512);
+
+  default:
+    return 0;
+  }
+}
+
+/**
+  Destroy the key of an EC context if the context owns it.
+
+  @param[in, out]  Ctx  Pointer to the EC context.
+
+**/
+STATIC
+VOID
+EcPsaDestroyKey (
+  IN OUT  PSA_EC_CONTEXT  *Ctx
+  )
+{
+  if ((Ctx->KeyId != PSA_KEY_ID_NULL) && Ctx->KeyOwned) {
+    psa_destroy_key (Ctx->KeyId);
+  }
+  Ctx->KeyId = PSA_KEY_ID_NULL;
+  Ctx->KeyOwned = FALSE;
+  Ctx->PublicKeySize = 0;
+}
+
+/**
+  Import a key to an EC context, and destroy the key it held before.
+
+  @param[in, out]  Ctx      Pointer to the EC context.
+  @param[in]       Private  TRUE to import a private key, FALSE to import a public key.
+  @param[in]       Data     The private key, or the public key in the uncompressed format.
+  @param[in]       DataSize Size of Data in bytes.
+
+  @retval  TRUE   The key is imported.
+  @retval  FALSE  The key is invalid, or cannot be imported.
+
+**/
+STATIC
+BOOLEAN
+EcPsaImportKey (
+  IN OUT  PSA_EC_CONTEXT  *Ctx,
+  IN      BOOLEAN         Private,
+  IN      CONST UINT8     *Data,
+  IN      UINTN           DataSize
+  )
+{
+  psa_key_attributes_t  Attributes;
+  psa_status_t          Status;
+  size_t                PublicKeySize;
+
+  EcPsaDestroyKey (Ctx);
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  Attributes = psa_key_attributes_init ();
+  psa_set_key_bits (&Attributes, Ctx->Bits);
+  if (Private) {
+    psa_set_key_type (&Attributes, PSA_KEY_TYPE_ECC_KEY_PAIR (PSA_ECC_FAMILY_SECP_R1));
+    psa_set_key_usage_flags (&Attributes, PSA_KEY_USAGE_SIGN_HASH | PSA_KEY_USAGE_VERIFY_HASH);
+  } else {
+    psa_set_key_type (&Attributes, PSA_KEY_TYPE_ECC_PUBLIC_KEY (PSA_ECC_FAMILY_SECP_R1));
+    psa_set_key_usage_flags (&Attributes, PSA_KEY_USAGE_VERIFY_HASH);
+  }
+  psa_set_key_algorithm (&Attributes, PSA_ALG_ECDSA (PSA_ALG_ANY_HASH));
+
+  Status = psa_import_key (&Attributes, Data, DataSize, &Ctx->KeyId);
+  psa_reset_key_attributes (&Attributes);
+  if (Status != PSA_SUCCESS) {
+    Ctx->KeyId = PSA_KEY_ID_NULL;
+    return FALSE;
+  }
+  Ctx->KeyOwned = TRUE;
+
+  Status = psa_export_public_key (Ctx->KeyId, Ctx->PublicKey, sizeof(Ctx->PublicKey), &PublicKeySize);
+  if ((Status != PSA_SUCCESS) || (PublicKeySize != 1 + Ctx->HalfSize * 2)) {
+    EcPsaDestroyKey (Ctx);
+    return FALSE;
+  }
+  Ctx->PublicKeySize = PublicKeySize;
+  return TRUE;
+}
+
+/**
+  Allocates and Initializes one Elliptic Curve Context for subsequent use
+  with the NID.
+
+  @param Nid cipher NID
+
+  @return  Pointer to the Elliptic Curve Context that has been initialized.
+           If the allocations fails, EcNewByNid() returns NULL.
+
+**/
+VOID *
+EFIAPI
+EcNewByNid (
+  IN UINTN  Nid
+  )
+{
+  PSA_EC_CONTEXT  *Ctx;
+  UINTN           Bits;
+
+  switch (Nid) {
+  case CRYPTO_NID_SECP256R1:
+    Bits = 256;
+    break;
+  case CRYPTO_NID_SECP384R1:
+    Bits = 384;
+    break;
+  case CRYPTO_NID_SECP521R1:
+    Bits = 521;
+    break;
+  default:
+    return NULL;
+  }
+
+  Ctx = AllocateZeroPool (sizeof(PSA_EC_CONTEXT));
+  if (Ctx == NULL) {
+    return NULL;
+  }
+  Ctx->Nid = Nid;
+  Ctx->Bits = Bits;
+  Ctx->HalfSize = (Bits + 7) / 8;
+  Ctx->KeyId = PSA_KEY_ID_NULL;
+  return Ctx;
+}
+
+/**
+  Release the specified EC context.
+
+  @param[in]  EcContext  Pointer to the EC context to be released.
+
+**/
+VOID
+EFIAPI
+EcFree (
+  IN  VOID  *EcContext
+  )
+{
+  if (EcContext == NULL) {
+    return ;
+  }
+  EcPsaDestroyKey (EcContext);
+  FreePool (EcContext);
+}
+
+/**
+  Sets the public key component into the established EC context.
+
+  For P-256, the PublicSize is 64. First 32-byte is X, Second 32-byte is Y.
+  For P-384, the PublicSize is 96. First 48-byte is X, Second 48-byte is Y.
+  For P-521, the PublicSize is 132. First 66-byte is X, Second 66-byte is Y.
+
+  @param[in, out]  EcContext      Pointer to EC context being set.
+  @param[in]       Public         Pointer to the buffer to receive generated public X,Y.
+  @param[in]       PublicSize     The size of Public buffer in bytes.
+
+  @retval  TRUE   EC public key component was set successfully.
+  @retval  FALSE  Invalid EC public key component.
+
+**/
+BOOLEAN
+EFIAPI
+EcSetPubKey (
+  IN OUT  VOID   *EcContext,
+  IN      UINT8  *PublicKey,
+  IN      UINTN  PublicKeySize
+  )
+{
+  PSA_EC_CONTEXT  *Ctx;
+  UINT8           Point[1 + EC_PSA_MAX_HALF_SIZE * 2];
+
+  if (EcContext == NULL || PublicKey == NULL) {
+    return FALSE;
+  }
+
+  Ctx = EcContext;
+  if (PublicKeySize != Ctx->HalfSize * 2) {
+    return FALSE;
+  }
+
+  Point[0] = 0x04;
+  CopyMem (&Point[1], PublicKey, PublicKeySize);
+  return EcPsaImportKey (Ctx, FALSE, Point, 1 + PublicKeySize);
+}
+
+/**
+  Gets the public key component from the established EC context.
+
+  For P-256, the PublicSize is 64. First 32-byte is X, Second 32-byte is Y.
+  For P-384, the PublicSize is 96. First 48-byte is X, Second 48-byte is Y.
+  For P-521, the PublicSize is 132. First 66-byte is X, Second 66-byte is Y.
+
+  @param[in, out]  EcContext      Pointer to EC context being set.
+  @param[out]      Public         Pointer to the buffer to receive generated public X,Y.
+  @param[in, out]  PublicSize     On input, the size of Public buffer in bytes.
+                                  On output, the size of data returned in Public buffer in bytes.
+
+  @retval  TRUE   EC key component was retrieved successfully.
+  @retval  FALSE  Invalid EC key component.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPubKey (
+  IN OUT  VOID   *EcContext,
+  OUT     UINT8  *PublicKey,
+  IN OUT  UINTN  *PublicKeySize
+  )
+{
+  PSA_EC_CONTEXT  *Ctx;
+
+  if (EcContext == NULL || PublicKeySize == NULL) {
+    return FALSE;
+  }
+
+  if (PublicKey == NULL && *PublicKeySize != 0) {
+    return FALSE;
+  }
+
+  Ctx = EcContext;
+  if (Ctx->PublicKeySize == 0) {
+    return FALSE;
+  }
+  if (*PublicKeySize < Ctx->HalfSize * 2) {
+    *PublicKeySize = Ctx->HalfSize * 2;
+    return FALSE;
+  }
+  *PublicKeySize = Ctx->HalfSize * 2;
+  CopyMem (PublicKey, &Ctx->PublicKey[1], *PublicKeySize);
+  return TRUE;
+}
+
+/**
+  Validates key components of EC context.
+  NOTE: This function performs integrity checks on all the EC key material, so
+        the EC key structure must contain all the private key data.
+
+  The PSA Crypto implementation validates a key when it is imported or generated,
+  so an EC context with a key is valid.
+
+  If EcContext is NULL, then return FALSE.
+
+  @param[in]  EcContext  Pointer to EC context to check.
+
+  @retval  TRUE   EC key components are valid.
+  @retval  FALSE  EC key components are not valid.
+
+**/
+BOOLEAN
+EFIAPI
+EcCheckKey (
+  IN  VOID  *EcContext
+  )
+{
+  if (EcContext == NULL) {
+    return FALSE;
+  }
+  return (BOOLEAN)(((PSA_EC_CONTEXT *)EcContext)->KeyId != PSA_KEY_ID_NULL);
+}
+
+/**
+  Generates EC key and returns EC public key (X, Y).
+
+  This function generates random secret, and computes the public key (X, Y), which is
+  returned via parameter Public, PublicSize.
+  X is the first half of Public with size being PublicSize / 2,
+  Y is the second half of Public with size being PublicSize / 2.
+  EC context is updated accordingly.
+  If the Public buffer is too small to hold the public X, Y, FALSE is returned and
+  PublicSize is set to the required buffer size to obtain the public X, Y.
+
+  The random secret is a PSA key for ECDH only, and it is not exported.
+
+  For P-256, the PublicSize is 64. First 32-byte is X, Second 32-byte is Y.
+  For P-384, the PublicSize is 96. First 48-byte is X, Second 48-byte is Y.
+  For P-521, the PublicSize is 132. First 66-byte is X, Second 66-byte is Y.
+
+  If EcContext is NULL, then return FALSE.
+  If PublicSize is NULL, then return FALSE.
+  If PublicSize is large enough but Public is NULL, then return FALSE.
+
+  @param[in, out]  EcContext      Pointer to the EC context.
+  @param[out]      Public         Pointer to the buffer to receive generated public X,Y.
+  @param[in, out]  PublicSize     On input, the size of Public buffer in bytes.
+                                  On output, the size of data returned in Public buffer in bytes.
+
+  @retval TRUE   EC public X,Y generation succeeded.
+  @retval FALSE  EC public X,Y generation failed.
+  @retval FALSE  PublicSize is not large enough.
+
+**/
+BOOLEAN
+EFIAPI
+EcGenerateKey (
+  IN OUT  VOID   *EcContext,
+  OUT     UINT8  *Public,
+  IN OUT  UINTN  *PublicSize
+  )
+{
+  PSA_EC_CONTEXT        *Ctx;
+  psa_key_attributes_t  Attributes;
+  psa_status_t          Status;
+  size_t                PublicKeySize;
+
+  if (EcContext == NULL || PublicSize == NULL) {
+    return FALSE;
+  }
+
+  if (Public == NULL && *PublicSize != 0) {
+    return FALSE;
+  }
+
+  Ctx = EcContext;
+  if (*PublicSize < Ctx->HalfSize * 2) {
+    *PublicSize = Ctx->HalfSize * 2;
+    return FALSE;
+  }
+
+  EcPsaDestroyKey (Ctx);
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  Attributes = psa_key_attributes_init ();
+  psa_set_key_type (&Attributes, PSA_KEY_TYPE_ECC_KEY_PAIR (PSA_ECC_FAMILY_SECP_R1));
+  psa_set_key_bits (&Attributes, Ctx->Bits);
+  psa_set_key_usage_flags (&Attributes, PSA_KEY_USAGE_DERIVE);
+  psa_set_key_algorithm (&Attributes, PSA_ALG_ECDH);
+  Status = psa_generate_key (&Attributes, &Ctx->KeyId);
+  psa_reset_key_attributes (&Attributes);
+  if (Status != PSA_SUCCESS) {
+    Ctx->KeyId = PSA_KEY_ID_NULL;
+    return FALSE;
+  }
+  Ctx->KeyOwned = TRUE;
+
+  Status = psa_export_public_key (Ctx->KeyId, Ctx->PublicKey, sizeof(Ctx->PublicKey), &PublicKeySize);
+  if ((Status != PSA_SUCCESS) || (PublicKeySize != 1 + Ctx->HalfSize * 2)) {
+    EcPsaDestroyKey (Ctx);
+    return FALSE;
+  }
+  Ctx->PublicKeySize = PublicKeySize;
+
+  *PublicSize = Ctx->HalfSize * 2;
+  CopyMem (Public, &Ctx->PublicKey[1], *PublicSize);
+  return TRUE;
+}
+
+/**
+  Computes exchanged common key.
+
+  Given peer's public key (X, Y), this function computes the exchanged common key,
+  based on its own context including value of curve parameter and random secret.
+  X is the first half of PeerPublic with size being PeerPublicSize / 2,
+  Y is the second half of PeerPublic with size being PeerPublicSize / 2.
+
+  If EcContext is NULL, then return FALSE.
+  If PeerPublic is NULL, then return FALSE.
+  If PeerPublicSize is 0, then return FALSE.
+  If Key is NULL, then return FALSE.
+  If KeySize is not large enough, then return FALSE.
+
+  For P-256, the PeerPublicSize is 64. First 32-byte is X, Second 32-byte is Y.
+  For P-384, the PeerPublicSize is 96. First 48-byte is X, Second 48-byte is Y.
+  For P-521, the PeerPublicSize is 132. First 66-byte is X, Second 66-byte is Y.
+
+  @param[in, out]  EcContext          Pointer to the EC context.
+  @param[in]       PeerPublic         Pointer to the peer's public X,Y.
+  @param[in]       PeerPublicSize     Size of peer's public X,Y in bytes.
+  @param[out]      Key                Pointer to the buffer to receive generated key.
+  @param[in, out]  KeySize            On input, the size of Key buffer in bytes.
+                                      On output, the size of data returned in Key buffer in bytes.
+
+  @retval TRUE   EC exchanged key generation succeeded.
+  @retval FALSE  EC exchanged key generation failed.
+  @retval FALSE  KeySize is not large enough.
+
+**/
+BOOLEAN
+EFIAPI
+EcComputeKey (
+  IN OUT  VOID         *EcContext,
+  IN      CONST UINT8  *PeerPublic,
+  IN      UINTN        PeerPublicSize,
+  OUT     UINT8        *Key,
+  IN OUT  UINTN        *KeySize
+  )
+{
+  PSA_EC_CONTEXT  *Ctx;
+  UINT8           Point[1 + EC_PSA_MAX_HALF_SIZE * 2];
+  psa_status_t    Status;
+  size_t          OutputLength;
+
+  if (EcContext == NULL || PeerPublic == NULL || KeySize == NULL || Key == NULL) {
+    return FALSE;
+  }
+
+  if (PeerPublicSize > INT_MAX) {
+    return FALSE;
+  }
+
+  Ctx = EcContext;
+  if (Ctx->KeyId == PSA_KEY_ID_NULL) {
+    return FALSE;
+  }
+  if (PeerPublicSize != Ctx->HalfSize * 2) {
+    return FALSE;
+  }
+  if (*KeySize < Ctx->HalfSize) {
+    return FALSE;
+  }
+
+  Point[0] = 0x04;
+  CopyMem (&Point[1], PeerPublic, PeerPublicSize);
+  Status = psa_raw_key_agreement (PSA_ALG_ECDH, Ctx->KeyId, Point, 1 + PeerPublicSize,
+                                  Key, *KeySize, &OutputLength);
+  if (Status != PSA_SUCCESS) {
+    return FALSE;
+  }
+
+  *KeySize = OutputLength;
+  return TRUE;
+}
+
+/**
+  Carries out the EC-DSA signature.
+
+  This function carries out the EC-DSA signature.
+  If the Signature buffer is too small to hold the contents of signature, FALSE
+  is returned and SigSize is set to the required buffer size to obtain the signature.
+
+  If EcContext is NULL, then return FALSE.
+  If MessageHash is NULL, then return FALSE.
+  If HashSize need match the HashNid. HashNid could be SHA256, SHA384, SHA512.
+  If SigSize is large enough but Signature is NULL, then return FALSE.
+
+  For P-256, the SigSize is 64. First 32-byte is R, Second 32-byte is S.
+  For P-384, the SigSize is 96. First 48-byte is R, Second 48-byte is S.
+  For P-521, the SigSize is 132. First 66-byte is R, Second 66-byte is S.
+
+  @param[in]       EcContext    Pointer to EC context for signature generation.
+  @param[in]       HashNid      hash NID
+  @param[in]       MessageHash  Pointer to octet message hash to be signed.
+  @param[in]       HashSize     Size of the message hash in bytes.
+  @param[out]      Signature    Pointer to buffer to receive EC-DSA signature.
+  @param[in, out]  SigSize      On input, the size of Signature buffer in bytes.
+                                On output, the size of data returned in Signature buffer in bytes.
+
+  @retval  TRUE   Signature successfully generated in EC-DSA.
+  @retval  FALSE  Signature generation failed.
+  @retval  FALSE  SigSize is too small.
+
+**/
+BOOLEAN
+EFIAPI
+EcDsaSign (
+  IN      VOID         *EcContext,
+  IN      UINTN        HashNid,
+  IN      CONST UINT8  *MessageHash,
+  IN      UINTN        HashSize,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  PSA_EC_CONTEXT   *Ctx;
+  psa_algorithm_t  Alg;
+  psa_status_t     Status;
+  size_t           SignatureLength;
+
+  if (EcContext == NULL || MessageHash == NULL) {
+    return FALSE;
+  }
+
+  if (Signature == NULL) {
+    return FALSE;
+  }
+
+  Ctx = EcContext;
+  if (*SigSize < (UINTN)(Ctx->HalfSize * 2)) {
+    *SigSize = Ctx->HalfSize * 2;
+    return FALSE;
+  }
+  *SigSize = Ctx->HalfSize * 2;
+  ZeroMem (Signature, *SigSize);
+
+  Alg = EcPsaDsaAlg (HashNid, HashSize);
+  if (Alg == 0) {
+    return FALSE;
+  }
+  if (Ctx->KeyId == PSA_KEY_ID_NULL) {
+    return FALSE;
+  }
+
+  Status = psa_sign_hash (Ctx->KeyId, Alg, MessageHash, HashSize, Signature, *SigSize, &SignatureLength);
+  if ((Status != PSA_SUCCESS) || (SignatureLength != *SigSize)) {
+    ZeroMem (Signature, *SigSize);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Verifies the EC-DSA signature.
+
+  If EcContext is NULL, then return FALSE.
+  If MessageHash is NULL, then return FALSE.
+  If Signature is NULL, then return FALSE.
+  If HashSize need match the HashNid. HashNid could be SHA256, SHA384, SHA512.
+
+  For P-256, the SigSize is 64. First 32-byte is R, Second 32-byte is S.
+  For P-384, the SigSize is 96. First 48-byte is R, Second 48-byte is S.
+  For P-521, the SigSize is 132. First 66-byte is R, Second 66-byte is S.
+
+  @param[in]  EcContext    Pointer to EC context for signature verification.
+  @param[in]  HashNid      hash NID
+  @param[in]  MessageHash  Pointer to octet message hash to be checked.
+  @param[in]  HashSize     Size of the message hash in bytes.
+  @param[in]  Signature    Pointer to EC-DSA signature to be verified.
+  @param[in]  SigSize      Size of signature in bytes.
+
+  @retval  TRUE   Valid signature encoded in EC-DSA.
+  @retval  FALSE  Invalid signature or invalid EC context.
+
+**/
+BOOLEAN
+EFIAPI
+EcDsaVerify (
+  IN  VOID         *EcContext,
+  IN  UINTN        HashNid,
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize
+  )
+{
+  PSA_EC_CONTEXT   *Ctx;
+  psa_algorithm_t  Alg;
+
+  if (EcContext == NULL || MessageHash == NULL || Signature == NULL) {
+    return FALSE;
+  }
+
+  if (SigSize > INT_MAX || SigSize == 0) {
+    return FALSE;
+  }
+
+  Ctx = EcContext;
+  if (SigSize != (UINTN)(Ctx->HalfSize * 2)) {
+    return FALSE;
+  }
+
+  Alg = EcPsaDsaAlg (HashNid, HashSize);
+  if (Alg == 0) {
+    return FALSE;
+  }
+  if (Ctx->KeyId == PSA_KEY_ID_NULL) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(psa_verify_hash (Ctx->KeyId, Alg, MessageHash, HashSize, Signature, SigSize) == PSA_SUCCESS);
+}
+
+/**
+  Release the specified prepared public key.
+
+  @param[in]  PreparedKey  Pointer to the prepared public key to be released.
+
+**/
+VOID
+EFIAPI
+EcDsaFreePreparedPublicKey (
+  IN  VOID         *PreparedKey
+  )
+{
+  EcFree (PreparedKey);
+}
+
+/**
+  Prepares the public key of an EC context for repeated EC-DSA verification.
+
+  The PSA Crypto implementation keeps whatever it precomputes for an imported key,
+  so the prepared public key is a copy of the public key of EcContext, imported once.
+  It does not refer to EcContext, which may be released before the prepared public key.
+
+  If EcContext is NULL, then return NULL.
+
+  @param[in]  EcContext    Pointer to EC context holding the public key.
+
+  @return  Pointer to the prepared public key.
+           If the public key is invalid or the allocations fails, EcDsaPreparePublicKey() returns NULL.
+
+**/
+VOID *
+EFIAPI
+EcDsaPreparePublicKey (
+  IN  VOID         *EcContext
+  )
+{
+  PSA_EC_CONTEXT  *Ctx;
+  PSA_EC_CONTEXT  *Prepared;
+
+  if (EcContext == NULL) {
+    return NULL;
+  }
+
+  Ctx = EcContext;
+  if (Ctx->PublicKeySize == 0) {
+    return NULL;
+  }
+  Prepared = EcNewByNid (Ctx->Nid);
+  if (Prepared == NULL) {
+    return NULL;
+  }
+  if (!EcPsaImportKey (Prepared, FALSE, Ctx->PublicKey, Ctx->PublicKeySize)) {
+    EcFree (Prepared);
+    return NULL;
+  }
+  return Prepared;
+}
+
+/**
+  Verifies the EC-DSA signature with a prepared public key.
+
+  The result is the same as EcDsaVerify() with the EC context the public key is prepared from.
+
+  If PreparedKey is NULL, then return FALSE.
+  If MessageHash is NULL, then return FALSE.
+  If Signature is NULL, then return FALSE.
+  If HashSize need match the HashNid. HashNid could be SHA256, SHA384, SHA512.
+
+  @param[in]  PreparedKey  Pointer to the prepared public key for signature verification.
+  @param[in]  HashNid      hash NID
+  @param[in]  MessageHash  Pointer to octet message hash to be checked.
+  @param[in]  HashSize     Size of the message hash in bytes.
+  @param[in]  Signature    Pointer to EC-DSA signature to be verified.
+  @param[in]  SigSize      Size of signature in bytes.
+
+  @retval  TRUE   Valid signature encoded in EC-DSA.
+  @retval  FALSE  Invalid signature or invalid prepared public key.
+
+**/
+BOOLEAN
+EFIAPI
+EcDsaVerifyPrepared (
+  IN  VOID         *PreparedKey,
+  IN  UINTN        HashNid,
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize
+  )
+{
+  return EcDsaVerify (PreparedKey, HashNid, MessageHash, HashSize, Signature, SigSize);
+}
+
+/**
+  Create an EC context from an EC key parsed by MbedTls.
+
+  @param[in]   EcKey      The EC key parsed by MbedTls.
+  @param[in]   Private    TRUE to import the private key, FALSE to import the public key.
+  @param[out]  EcContext  Pointer to the new EC context.
+
+  @retval  TRUE   The EC context is created.
+  @retval  FALSE  The curve is not supported, or the key cannot be imported.
+
+**/
+STATIC
+BOOLEAN
+EcPsaNewFromMbedTls (
+  IN   mbedtls_ecp_keypair  *EcKey,
+  IN   BOOLEAN              Private,
+  OUT  VOID                 **EcContext
+  )
+{
+  PSA_EC_CONTEXT  *Ctx;
+  UINT8           Data[1 + EC_PSA_MAX_HALF_SIZE * 2];
+  size_t          DataSize;
+  UINTN           Nid;
+  INT32           Ret;
+  BOOLEAN         Result;
+
+  switch (EcKey->grp.id) {
+  case MBEDTLS_ECP_DP_SECP256R1:
+    Nid = CRYPTO_NID_SECP256R1;
+    break;
+  case MBEDTLS_ECP_DP_SECP384R1:
+    Nid = CRYPTO_NID_SECP384R1;
+    break;
+  case MBEDTLS_ECP_DP_SECP521R1:
+    Nid = CRYPTO_NID_SECP521R1;
+    break;
+  default:
+    return FALSE;
+  }
+
+  Ctx = EcNewByNid (Nid);
+  if (Ctx == NULL) {
+    return FALSE;
+  }
+  if (Private) {
+    DataSize = Ctx->HalfSize;
+    Ret = mbedtls_mpi_write_binary (&EcKey->d, Data, DataSize);
+  } else {
+    Ret = mbedtls_ecp_point_write_binary (&EcKey->grp, &EcKey->Q, MBEDTLS_ECP_PF_UNCOMPRESSED,
+                                          &DataSize, Data, sizeof(Data));
+  }
+  Result = (BOOLEAN)(Ret == 0) && EcPsaImportKey (Ctx, Private, Data, DataSize);
+  ZeroMem (Data, sizeof(Data));
+  if (!Result) {
+    EcFree (Ctx);
+    return FALSE;
+  }
+
+  *EcContext = Ctx;
+  return TRUE;
+}
+
+/**
+  Retrieve the EC Private Key from the password-protected PEM key data.
+
+  The private key is imported to the PSA Crypto implementation, and it is zeroed in the memory of MbedTls.
+
+  @param[in]  PemData      Pointer to the PEM-encoded key data to be retrieved.
+  @param[in]  PemSize      Size of the PEM key data in bytes.
+  @param[in]  Password     NULL-terminated passphrase used for encrypted PEM key data.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which contain the retrieved
+                           EC private key component. Use EcFree() function to free the
+                           resource.
+
+  If PemData is NULL, then return FALSE.
+  If EcContext is NULL, then return FALSE.
+
+  @retval  TRUE   EC Private Key was retrieved successfully.
+  @retval  FALSE  Invalid PEM key data or incorrect password.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPrivateKeyFromPem (
+  IN   CONST UINT8  *PemData,
+  IN   UINTN        PemSize,
+  IN   CONST CHAR8  *Password,
+  OUT  VOID         **EcContext
+  )
+{
+  INT32               Ret;
+  mbedtls_pk_context  pk;
+  UINT8               *NewPemData;
+  UINTN               PasswordLen;
+  BOOLEAN             Result;
+
+  if (PemData == NULL || EcContext == NULL || PemSize == 0 || PemSize > INT_MAX) {
+    return FALSE;
+  }
+
+  NewPemData = NULL;
+  if (PemData[PemSize - 1] != 0) {
+    NewPemData = AllocatePool (PemSize + 1);
+    if (NewPemData == NULL) {
+      return FALSE;
+    }
+    CopyMem (NewPemData, PemData, PemSize);
+    NewPemData[PemSize] = 0;
+    PemData = NewPemData;
+    PemSize += 1;
+  }
+
+  mbedtls_pk_init (&pk);
+
+  if (Password != NULL) {
+    PasswordLen = AsciiStrLen (Password);
+  } else {
+    PasswordLen = 0;
+  }
+
+  Ret = mbedtls_pk_parse_key (&pk, PemData, PemSize, (CONST UINT8 *)Password, PasswordLen);
+
+  if (NewPemData != NULL) {
+    ZeroMem (NewPemData, PemSize);
+    FreePool (NewPemData);
+    NewPemData = NULL;
+  }
+
+  if (Ret != 0) {
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+
+  if (mbedtls_pk_get_type (&pk) != MBEDTLS_PK_ECKEY) {
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+
+  Result = EcPsaNewFromMbedTls (mbedtls_pk_ec (pk), TRUE, EcContext);
+  mbedtls_pk_free (&pk);
+  return Result;
+}
+
+/**
+  Retrieve the EC Private Key held by the PSA Crypto implementation, such as a persistent key
+  provisioned in a secure element.
+
+  The key is used in place, and EcFree() does not destroy it.
+  It must be an ECC key pair of the SECP-R1 family, P-256, P-384 or P-521,
+  with a usage policy that allows psa_sign_hash() for EC-DSA.
+
+  If EcContext is NULL, then return FALSE.
+
+  @param[in]  KeyId        The PSA key identifier.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which refer to the
+                           EC private key. Use EcFree() function to free the resource.
+
+  @retval  TRUE   EC Private Key was retrieved successfully.
+  @retval  FALSE  The key does not exist, or it is not a supported EC key pair.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPrivateKeyFromKeyId (
+  IN   UINT32       KeyId,
+  OUT  VOID         **EcContext
+  )
+{
+  psa_key_attributes_t  Attributes;
+  PSA_EC_CONTEXT        *Ctx;
+  UINTN                 Nid;
+  psa_status_t          Status;
+  size_t                PublicKeySize;
+
+  if (EcContext == NULL || KeyId == PSA_KEY_ID_NULL) {
+    return FALSE;
+  }
+  if (!InternalCryptPsaInit ()) {
+    return FALSE;
+  }
+
+  Attributes = psa_key_attributes_init ();
+  Status = psa_get_key_attributes ((psa_key_id_t)KeyId, &Attributes);
+  if (Status != PSA_SUCCESS) {
+    return FALSE;
+  }
+  if (psa_get_key_type (&Attributes) != PSA_KEY_TYPE_ECC_KEY_PAIR (PSA_ECC_FAMILY_SECP_R1)) {
+    psa_reset_key_attributes (&Attributes);
+    return FALSE;
+  }
+  switch (psa_get_key_bits (&Attributes)) {
+  case 256:
+    Nid = CRYPTO_NID_SECP256R1;
+    break;
+  case 384:
+    Nid = CRYPTO_NID_SECP384R1;
+    break;
+  case 521:
+    Nid = CRYPTO_NID_SECP521R1;
+    break;
+  default:
+    psa_reset_key_attributes (&Attributes);
+    return FALSE;
+  }
+  psa_reset_key_attributes (&Attributes);
+
+  Ctx = EcNewByNid (Nid);
+  if (Ctx == NULL) {
+    return FALSE;
+  }
+  Ctx->KeyId = (psa_key_id_t)KeyId;
+  Ctx->KeyOwned = FALSE;
+  Status = psa_export_public_key (Ctx->KeyId, Ctx->PublicKey, sizeof(Ctx->PublicKey), &PublicKeySize);
+  if ((Status != PSA_SUCCESS) || (PublicKeySize != 1 + Ctx->HalfSize * 2)) {
+    EcFree (Ctx);
+    return FALSE;
+  }
+  Ctx->PublicKeySize = PublicKeySize;
+
+  *EcContext = Ctx;
+  return TRUE;
+}
+
+/**
+  Retrieve the EC Public Key from one DER-encoded X509 certificate.
+
+  @param[in]  Cert         Pointer to the DER-encoded X509 certificate.
+  @param[in]  CertSize     Size of the X509 certificate in bytes.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which contain the retrieved
+                           EC public key component. Use EcFree() function to free the
+                           resource.
+
+  If Cert is NULL, then return FALSE.
+  If EcContext is NULL, then return FALSE.
+
+  @retval  TRUE   EC Public Key was retrieved successfully.
+  @retval  FALSE  Fail to retrieve EC public key from X509 certificate.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPublicKeyFromX509 (
+  IN   CONST UINT8  *Cert,
+  IN   UINTN        CertSize,
+  OUT  VOID         **EcContext
+  )
+{
+  mbedtls_x509_crt  crt;
+  BOOLEAN           Result;
+
+  if (Cert == NULL || EcContext == NULL) {
+    return FALSE;
+  }
+
+  mbedtls_x509_crt_init (&crt);
+
+  if (mbedtls_x509_crt_parse_der (&crt, Cert, CertSize) != 0) {
+    mbedtls_x509_crt_free (&crt);
+    return FALSE;
+  }
+
+  if (mbedtls_pk_get_type (&crt.pk) != MBEDTLS_PK_ECKEY) {
+    mbedtls_x509_crt_free (&crt);
+    return FALSE;
+  }
+
+  Result = EcPsaNewFromMbedTls (mbedtls_pk_ec (crt.pk), FALSE, EcContext);
+  mbedtls_x509_crt_free (&crt);
+  return Result;
+}
+
+/**
+  Retrieve the EC Public Key from one DER-encoded SubjectPublicKeyInfo.
+
+  @param[in]  DerData      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param[in]  DerSize      Size of the DER data in bytes.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which contain the retrieved
+                           EC public key component. Use EcFree() function to free the
+                           resource.
+
+  If DerData is NULL, then return FALSE.
+  If EcContext is NULL, then return FALSE.
+
+  @retval  TRUE   EC Public Key was retrieved successfully.
+  @retval  FALSE  Invalid DER data, or the key is not an EC key.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPublicKeyFromDer (
+  IN   CONST UINT8  *DerData,
+  IN   UINTN        DerSize,
+  OUT  VOID         **EcContext
+  )
+{
+  mbedtls_pk_context  pk;
+  BOOLEAN             Result;
+
+  if (DerData == NULL || EcContext == NULL) {
+    return FALSE;
+  }
+
+  mbedtls_pk_init (&pk);
+
+  if (mbedtls_pk_parse_public_key (&pk, DerData, DerSize) != 0) {
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+
+  if (mbedtls_pk_get_type (&pk) != MBEDTLS_PK_ECKEY) {
+    mbedtls_pk_free (&pk);
+    return FALSE;
+  }
+
+  Result = EcPsaNewFromMbedTls (mbedtls_pk_ec (pk), FALSE, EcContext);
+  mbedtls_pk_free (&pk);
+  return Result;
+}
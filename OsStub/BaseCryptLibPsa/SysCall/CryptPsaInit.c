@@ -0,0 +1,37 @@
+/** @file
+  PSA Crypto initialization for Crypto library over PSA Crypto.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+
+STATIC volatile BOOLEAN  mCryptPsaReady = FALSE;
+
+/**
+  Initialize the PSA Crypto implementation, the first time it is called.
+
+  Every wrapper calls this function before its first PSA call. psa_crypto_init() is not
+  required to be thread safe, so a multi-threaded application should make the first call,
+  such as RandomSeed(), before it starts the other threads.
+
+  @retval TRUE   The PSA Crypto implementation is initialized.
+  @retval FALSE  The PSA Crypto implementation cannot be initialized.
+
+**/
+BOOLEAN
+InternalCryptPsaInit (
+  VOID
+  )
+{
+  if (mCryptPsaReady) {
+    return TRUE;
+  }
+  if (psa_crypto_init () != PSA_SUCCESS) {
+    return FALSE;
+  }
+  mCryptPsaReady = TRUE;
+  return TRUE;
+}
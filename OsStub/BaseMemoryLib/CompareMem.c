@@ -6,7 +6,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
-#include "Base.h"
+#include "MemLibInternals.h"
 
 /**
   Compares the contents of two buffers.
@@ -16,6 +16,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
   value returned is the first mismatched byte in SourceBuffer subtracted from the first
   mismatched byte in DestinationBuffer.
 
+  The time of the comparison depends on the position of the first mismatched byte.
+  The secrets, such as the HMAC values, are compared with SpdmConstTimeCompareMem instead.
+
   If Length > 0 and DestinationBuffer is NULL, then ASSERT().
   If Length > 0 and SourceBuffer is NULL, then ASSERT().
   If Length is greater than (MAX_ADDRESS - DestinationBuffer + 1), then ASSERT().
@@ -38,16 +41,62 @@ CompareMem (
   IN UINTN       Length
   )
 {
-  volatile UINT8  *PointerDst;
-  volatile UINT8  *PointerSrc;
-  INTN            Delta;
-
-  PointerDst = (UINT8 *)DestinationBuffer;
-  PointerSrc = (UINT8 *)SourceBuffer;
-  Delta = 0;
-  while ((Length-- != 0) && (Delta == 0)) {
-    Delta = *(PointerDst++) - *(PointerSrc++);
+  CONST UINT8  *PointerDst;
+  CONST UINT8  *PointerSrc;
+
+  PointerDst = (CONST UINT8 *)DestinationBuffer;
+  PointerSrc = (CONST UINT8 *)SourceBuffer;
+
+  //
+  // Skip the identical vectors and words. The mismatched byte is located by the byte loop.
+  //
+#if defined(MEM_LIB_SSE2)
+  while (Length >= MEM_LIB_VECTOR_SIZE) {
+    if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_loadu_si128 ((CONST __m128i *)PointerDst),
+                                           _mm_loadu_si128 ((CONST __m128i *)PointerSrc))) != 0xFFFF) {
+      break;
+    }
+    PointerDst += MEM_LIB_VECTOR_SIZE;
+    PointerSrc += MEM_LIB_VECTOR_SIZE;
+    Length -= MEM_LIB_VECTOR_SIZE;
+  }
+#elif defined(MEM_LIB_NEON)
+  while (Length >= MEM_LIB_VECTOR_SIZE) {
+    uint64x2_t  Delta;
+
+    Delta = vreinterpretq_u64_u8 (veorq_u8 (vld1q_u8 (PointerDst), vld1q_u8 (PointerSrc)));
+    if ((vgetq_lane_u64 (Delta, 0) | vgetq_lane_u64 (Delta, 1)) != 0) {
+      break;
+    }
+    PointerDst += MEM_LIB_VECTOR_SIZE;
+    PointerSrc += MEM_LIB_VECTOR_SIZE;
+    Length -= MEM_LIB_VECTOR_SIZE;
+  }
+#endif
+
+  if (MEM_LIB_IS_SAME_ALIGNMENT (PointerDst, PointerSrc)) {
+    while (!MEM_LIB_IS_WORD_ALIGNED (PointerDst) && (Length != 0)) {
+      if (*PointerDst != *PointerSrc) {
+        return (INTN)*PointerDst - (INTN)*PointerSrc;
+      }
+      PointerDst++;
+      PointerSrc++;
+      Length--;
+    }
+    while ((Length >= sizeof(UINTN)) && (*(CONST UINTN *)PointerDst == *(CONST UINTN *)PointerSrc)) {
+      PointerDst += sizeof(UINTN);
+      PointerSrc += sizeof(UINTN);
+      Length -= sizeof(UINTN);
+    }
+  }
+
+  while (Length-- != 0) {
+    if (*PointerDst != *PointerSrc) {
+      return (INTN)*PointerDst - (INTN)*PointerSrc;
+    }
+    PointerDst++;
+    PointerSrc++;
   }
 
-  return Delta;
+  return 0;
 }
@@ -6,7 +6,112 @@
 
 **/
 
-#include "Base.h"
+#include "MemLibInternals.h"
+
+/**
+  Copies a source buffer to a destination buffer from the first byte to the last byte.
+
+  Each vector or word is read before it is written, so that the destination may overlap the source
+  if it is before the source.
+
+  @param  PointerDst          A pointer to the destination buffer of the memory copy.
+  @param  PointerSrc          A pointer to the source buffer of the memory copy.
+  @param  Length              The number of bytes to copy.
+**/
+VOID
+InternalMemCopyForward (
+  OUT UINT8       *PointerDst,
+  IN CONST UINT8  *PointerSrc,
+  IN UINTN        Length
+  )
+{
+#if defined(MEM_LIB_SSE2)
+  while (Length >= MEM_LIB_VECTOR_SIZE) {
+    _mm_storeu_si128 ((__m128i *)PointerDst, _mm_loadu_si128 ((CONST __m128i *)PointerSrc));
+    PointerDst += MEM_LIB_VECTOR_SIZE;
+    PointerSrc += MEM_LIB_VECTOR_SIZE;
+    Length -= MEM_LIB_VECTOR_SIZE;
+  }
+#elif defined(MEM_LIB_NEON)
+  while (Length >= MEM_LIB_VECTOR_SIZE) {
+    vst1q_u8 (PointerDst, vld1q_u8 (PointerSrc));
+    PointerDst += MEM_LIB_VECTOR_SIZE;
+    PointerSrc += MEM_LIB_VECTOR_SIZE;
+    Length -= MEM_LIB_VECTOR_SIZE;
+  }
+#endif
+
+  if (MEM_LIB_IS_SAME_ALIGNMENT (PointerDst, PointerSrc)) {
+    while (!MEM_LIB_IS_WORD_ALIGNED (PointerDst) && (Length != 0)) {
+      *(volatile UINT8 *)(PointerDst++) = *(PointerSrc++);
+      Length--;
+    }
+    while (Length >= sizeof(UINTN)) {
+      *(volatile UINTN *)PointerDst = *(CONST UINTN *)PointerSrc;
+      PointerDst += sizeof(UINTN);
+      PointerSrc += sizeof(UINTN);
+      Length -= sizeof(UINTN);
+    }
+  }
+
+  while (Length-- != 0) {
+    *(volatile UINT8 *)(PointerDst++) = *(PointerSrc++);
+  }
+}
+
+/**
+  Copies a source buffer to a destination buffer from the last byte to the first byte.
+
+  Each vector or word is read before it is written, so that the destination may overlap the source
+  if it is after the source.
+
+  @param  PointerDst          A pointer to the destination buffer of the memory copy.
+  @param  PointerSrc          A pointer to the source buffer of the memory copy.
+  @param  Length              The number of bytes to copy.
+**/
+VOID
+InternalMemCopyBackward (
+  OUT UINT8       *PointerDst,
+  IN CONST UINT8  *PointerSrc,
+  IN UINTN        Length
+  )
+{
+  PointerDst += Length;
+  PointerSrc += Length;
+
+#if defined(MEM_LIB_SSE2)
+  while (Length >= MEM_LIB_VECTOR_SIZE) {
+    PointerDst -= MEM_LIB_VECTOR_SIZE;
+    PointerSrc -= MEM_LIB_VECTOR_SIZE;
+    Length -= MEM_LIB_VECTOR_SIZE;
+    _mm_storeu_si128 ((__m128i *)PointerDst, _mm_loadu_si128 ((CONST __m128i *)PointerSrc));
+  }
+#elif defined(MEM_LIB_NEON)
+  while (Length >= MEM_LIB_VECTOR_SIZE) {
+    PointerDst -= MEM_LIB_VECTOR_SIZE;
+    PointerSrc -= MEM_LIB_VECTOR_SIZE;
+    Length -= MEM_LIB_VECTOR_SIZE;
+    vst1q_u8 (PointerDst, vld1q_u8 (PointerSrc));
+  }
+#endif
+
+  if (MEM_LIB_IS_SAME_ALIGNMENT (PointerDst, PointerSrc)) {
+    while (!MEM_LIB_IS_WORD_ALIGNED (PointerDst) && (Length != 0)) {
+      *(volatile UINT8 *)(--PointerDst) = *(--PointerSrc);
+      Length--;
+    }
+    while (Length >= sizeof(UINTN)) {
+      PointerDst -= sizeof(UINTN);
+      PointerSrc -= sizeof(UINTN);
+      Length -= sizeof(UINTN);
+      *(volatile UINTN *)PointerDst = *(CONST UINTN *)PointerSrc;
+    }
+  }
+
+  while (Length-- != 0) {
+    *(volatile UINT8 *)(--PointerDst) = *(--PointerSrc);
+  }
+}
 
 /**
   Copies a source buffer to a destination buffer, and returns the destination buffer.
@@ -33,13 +138,21 @@ CopyMem (
   IN UINTN       Length
   )
 {
-  volatile UINT8  *PointerDst;
-  volatile UINT8  *PointerSrc;
+  UINT8        *PointerDst;
+  CONST UINT8  *PointerSrc;
 
   PointerDst = (UINT8 *)DestinationBuffer;
-  PointerSrc = (UINT8 *)SourceBuffer;
-  while (Length-- != 0) {
-    *(PointerDst++) = *(PointerSrc++);
+  PointerSrc = (CONST UINT8 *)SourceBuffer;
+  if ((PointerDst == PointerSrc) || (Length == 0)) {
+    return DestinationBuffer;
+  }
+  if ((PointerDst > PointerSrc) && (PointerDst < PointerSrc + Length)) {
+    //
+    // Copy backward if the destination overlaps the end of the source.
+    //
+    InternalMemCopyBackward (PointerDst, PointerSrc, Length);
+  } else {
+    InternalMemCopyForward (PointerDst, PointerSrc, Length);
   }
 
   return DestinationBuffer;
@@ -0,0 +1,41 @@
+/** @file
+  Declaration of internal macros for BaseMemoryLib.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __MEM_LIB_INTERNALS__
+#define __MEM_LIB_INTERNALS__
+
+#include "Base.h"
+
+//
+// The buffers are copied, filled and compared a 128-bit vector at a time with SSE2 or NEON,
+// then a UINTN at a time, then a byte at a time.
+//
+// The vector loads and stores are unaligned. The UINTN accesses are aligned, so that they are
+// used only if both buffers have the same alignment.
+//
+// The model checking and symbolic execution builds use the portable loops only.
+//
+#if !defined(CBMC) && !defined(CBMC_CC) && !defined(TEST_WITH_KLEE)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MEM_LIB_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define MEM_LIB_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#define MEM_LIB_VECTOR_SIZE  16
+
+#define MEM_LIB_WORD_MASK  (sizeof(UINTN) - 1)
+
+#define MEM_LIB_IS_WORD_ALIGNED(Address)  ((((UINTN)(Address)) & MEM_LIB_WORD_MASK) == 0)
+
+#define MEM_LIB_IS_SAME_ALIGNMENT(Address1, Address2)  (((((UINTN)(Address1)) ^ ((UINTN)(Address2))) & MEM_LIB_WORD_MASK) == 0)
+
+#endif
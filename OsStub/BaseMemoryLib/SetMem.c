@@ -5,7 +5,7 @@
 
 **/
 
-#include "Base.h"
+#include "MemLibInternals.h"
 
 /**
   Fills a target buffer with a byte value, and returns the target buffer.
@@ -29,11 +29,53 @@ SetMem (
   IN UINT8  Value
   )
 {
-  volatile UINT8  *Pointer;
+  UINT8  *Pointer;
+  UINTN  Pattern;
 
   Pointer = (UINT8 *)Buffer;
+
+#if defined(MEM_LIB_SSE2)
+  if (Length >= MEM_LIB_VECTOR_SIZE) {
+    __m128i  Vector;
+
+    Vector = _mm_set1_epi8 ((CHAR8)Value);
+    while (Length >= MEM_LIB_VECTOR_SIZE) {
+      _mm_storeu_si128 ((__m128i *)Pointer, Vector);
+      Pointer += MEM_LIB_VECTOR_SIZE;
+      Length -= MEM_LIB_VECTOR_SIZE;
+    }
+  }
+#elif defined(MEM_LIB_NEON)
+  if (Length >= MEM_LIB_VECTOR_SIZE) {
+    uint8x16_t  Vector;
+
+    Vector = vdupq_n_u8 (Value);
+    while (Length >= MEM_LIB_VECTOR_SIZE) {
+      vst1q_u8 (Pointer, Vector);
+      Pointer += MEM_LIB_VECTOR_SIZE;
+      Length -= MEM_LIB_VECTOR_SIZE;
+    }
+  }
+#endif
+
+  while (!MEM_LIB_IS_WORD_ALIGNED (Pointer) && (Length != 0)) {
+    *(volatile UINT8 *)(Pointer++) = Value;
+    Length--;
+  }
+  if (Length >= sizeof(UINTN)) {
+    //
+    // Value in every byte of a UINTN.
+    //
+    Pattern = (MAX_UINTN / MAX_UINT8) * Value;
+    while (Length >= sizeof(UINTN)) {
+      *(volatile UINTN *)Pointer = Pattern;
+      Pointer += sizeof(UINTN);
+      Length -= sizeof(UINTN);
+    }
+  }
+
   while (Length-- != 0) {
-    *(Pointer++) = Value;
+    *(volatile UINT8 *)(Pointer++) = Value;
   }
 
   return Buffer;
@@ -6,7 +6,7 @@
 
 **/
 
-#include "Base.h"
+#include "MemLibInternals.h"
 
 /**
   Fills a target buffer with zeros, and returns the target buffer.
@@ -29,11 +29,25 @@ ZeroMem (
   IN UINTN  Length
   )
 {
-  volatile UINT8  *Pointer;
+  UINT8  *Pointer;
 
+  //
+  // ZeroMem wipes the secrets before their buffers go out of scope, so every store is volatile,
+  // including the UINTN stores, and none of them is removed as a dead store after inlining.
+  // The vector stores of SetMem are not used for this reason.
+  //
   Pointer = (UINT8 *)Buffer;
+  while (!MEM_LIB_IS_WORD_ALIGNED (Pointer) && (Length != 0)) {
+    *(volatile UINT8 *)(Pointer++) = 0;
+    Length--;
+  }
+  while (Length >= sizeof(UINTN)) {
+    *(volatile UINTN *)Pointer = 0;
+    Pointer += sizeof(UINTN);
+    Length -= sizeof(UINTN);
+  }
   while (Length-- != 0) {
-    *(Pointer++) = 0;
+    *(volatile UINT8 *)(Pointer++) = 0;
   }
 
   return Buffer;
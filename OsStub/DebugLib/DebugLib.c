@@ -79,3 +79,46 @@ DebugPrint (
 
   printf ("%s", Buffer);
 }
+
+BOOLEAN
+EFIAPI
+DebugPrintLevelEnabled (
+  IN  CONST UINTN        ErrorLevel
+  )
+{
+  return (BOOLEAN)((ErrorLevel & DEBUG_LEVEL_CONFIG) != 0);
+}
+
+VOID
+EFIAPI
+DebugPrintHex (
+  IN UINTN        ErrorLevel,
+  IN CONST VOID   *Data,
+  IN UINTN        Size,
+  IN BOOLEAN      Separated
+  )
+{
+  CHAR8        Buffer[MAX_DEBUG_MESSAGE_LENGTH];
+  CONST UINT8  *Byte;
+  UINTN        Index;
+  UINTN        Length;
+
+  if ((ErrorLevel & DEBUG_LEVEL_CONFIG) == 0) {
+    return ;
+  }
+
+  Byte = Data;
+  Length = 0;
+  for (Index = 0; Index < Size; Index++) {
+    if (Length + 3 > sizeof(Buffer)) {
+      fwrite (Buffer, 1, Length, stdout);
+      Length = 0;
+    }
+    Buffer[Length++] = "0123456789abcdef"[Byte[Index] >> 4];
+    Buffer[Length++] = "0123456789abcdef"[Byte[Index] & 0xF];
+    if (Separated) {
+      Buffer[Length++] = ' ';
+    }
+  }
+  fwrite (Buffer, 1, Length, stdout);
+}
@@ -26,3 +26,23 @@ DebugPrint (
   )
 {
 }
+
+BOOLEAN
+EFIAPI
+DebugPrintLevelEnabled (
+  IN  CONST UINTN        ErrorLevel
+  )
+{
+  return FALSE;
+}
+
+VOID
+EFIAPI
+DebugPrintHex (
+  IN UINTN        ErrorLevel,
+  IN CONST VOID   *Data,
+  IN UINTN        Size,
+  IN BOOLEAN      Separated
+  )
+{
+}
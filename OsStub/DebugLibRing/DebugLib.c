@@ -0,0 +1,1054 @@
+/** @file
+  Ring buffer implementation of the Debug Library, with deferred formatting.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdarg.h>
+
+#include <Library/DebugLib.h>
+
+//
+// DebugPrint does not format the message. It writes a record of the format pointer and the raw
+// arguments into a ring, and DebugPrintHex writes a record of the raw bytes. The strings of "%s"
+// are copied into the record, since they may be gone when it is formatted. The format strings
+// must be literals, as they are for DEBUG ().
+//
+// With GCC and CLANG, each thread has its own ring, which it writes without any lock, and a drain
+// thread formats the records of all the rings and writes them to stdout. A thread waits for the
+// drain thread when its ring is full. The ring of a thread which exits is reused by a new thread
+// once it is drained. With MSVC, or when the drain thread cannot be started, the threads share one
+// ring under a lock, and it is formatted by the thread which fills it to half.
+//
+// The rings are drained when the program exits and before an assert message is printed, so the
+// messages are not lost, but they are printed behind the printf output of the program.
+//
+#define MAX_DEBUG_MESSAGE_LENGTH  0x100
+
+#define DEBUG_ASSERT_NATIVE      0
+#define DEBUG_ASSERT_DEADLOOP    1
+#define DEBUG_ASSERT_BREAKPOINT  2
+
+#ifndef DEBUG_ASSERT_CONFIG
+#define DEBUG_ASSERT_CONFIG      DEBUG_ASSERT_DEADLOOP
+#endif
+
+#ifndef DEBUG_LEVEL_CONFIG
+#define DEBUG_LEVEL_CONFIG       (DEBUG_INFO | DEBUG_ERROR)
+#endif
+
+//
+// The size in bytes of a ring, a power of 2.
+//
+#ifndef DEBUG_RING_SIZE
+#define DEBUG_RING_SIZE          SIZE_64KB
+#endif
+
+#define DEBUG_RING_MASK          (DEBUG_RING_SIZE - 1)
+
+#define DEBUG_RING_MAX_ARGUMENTS  32
+#define DEBUG_RING_MAX_STRING     MAX_DEBUG_MESSAGE_LENGTH
+#define DEBUG_RING_MAX_HEX        0x200
+
+#define DEBUG_RING_DRAIN_INTERVAL_US  1000
+
+#if !defined(_MSC_VER) && !defined(CBMC) && !defined(CBMC_CC) && !defined(TEST_WITH_KLEE)
+#define DEBUG_RING_THREADS
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#define DEBUG_RING_RECORD_PAD    0
+#define DEBUG_RING_RECORD_PRINT  1
+#define DEBUG_RING_RECORD_HEX    2
+
+///
+/// A record is followed by the format pointer and the arguments of a DEBUG_RING_RECORD_PRINT,
+/// each as a UINT64, then by the copied strings, or by the bytes of a DEBUG_RING_RECORD_HEX.
+/// The size of a record is a multiple of 8 bytes, so that a DEBUG_RING_RECORD_PAD always fits
+/// at the end of the ring.
+///
+typedef struct {
+  UINT32  Size;
+  UINT16  Type;
+  UINT16  Count;
+} DEBUG_RING_RECORD;
+
+typedef struct _DEBUG_RING {
+  volatile UINTN      Head;
+  volatile UINTN      Tail;
+  volatile BOOLEAN    Exited;
+  struct _DEBUG_RING  *Next;
+  UINT64              Buffer[DEBUG_RING_SIZE / sizeof(UINT64)];
+} DEBUG_RING;
+
+#define DEBUG_RING_ARGUMENT_LITERAL   0
+#define DEBUG_RING_ARGUMENT_SIGNED    1
+#define DEBUG_RING_ARGUMENT_UNSIGNED  2
+#define DEBUG_RING_ARGUMENT_CHAR      3
+#define DEBUG_RING_ARGUMENT_POINTER   4
+#define DEBUG_RING_ARGUMENT_STRING    5
+#define DEBUG_RING_ARGUMENT_DOUBLE    6
+
+#define DEBUG_RING_LENGTH_NONE  0
+#define DEBUG_RING_LENGTH_HH    1
+#define DEBUG_RING_LENGTH_H     2
+#define DEBUG_RING_LENGTH_L     3
+#define DEBUG_RING_LENGTH_LL    4
+#define DEBUG_RING_LENGTH_Z     5
+#define DEBUG_RING_LENGTH_J     6
+#define DEBUG_RING_LENGTH_T     7
+
+///
+/// A conversion specification of a format, from its '%'.
+///
+typedef struct {
+  UINTN  Size;
+  UINTN  Type;
+  UINTN  Length;
+  UINTN  StarCount;
+  UINTN  LengthOffset;
+  UINTN  LengthSize;
+} DEBUG_RING_SPEC;
+
+#if defined(DEBUG_RING_THREADS)
+
+#define DEBUG_RING_LOAD_ACQUIRE(Variable)         __atomic_load_n (&(Variable), __ATOMIC_ACQUIRE)
+#define DEBUG_RING_STORE_RELEASE(Variable, Value)  __atomic_store_n (&(Variable), (Value), __ATOMIC_RELEASE)
+
+pthread_mutex_t  mDebugRingListLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t  mDebugRingDrainLock = PTHREAD_MUTEX_INITIALIZER;
+
+#define DEBUG_RING_DRAIN_LOCK()    pthread_mutex_lock (&mDebugRingDrainLock)
+#define DEBUG_RING_DRAIN_UNLOCK()  pthread_mutex_unlock (&mDebugRingDrainLock)
+
+pthread_once_t   mDebugRingOnce = PTHREAD_ONCE_INIT;
+pthread_key_t    mDebugRingKey;
+BOOLEAN          mDebugRingKeyReady;
+volatile BOOLEAN mDebugRingDrainStarted;
+volatile BOOLEAN mDebugRingDrainRunning;
+
+__thread DEBUG_RING  *mDebugThreadRing;
+__thread BOOLEAN     mDebugThreadRingExited;
+
+#elif defined(_MSC_VER) && !defined(CBMC) && !defined(CBMC_CC)
+
+long _InterlockedExchange (long volatile *Target, long Value);
+#pragma intrinsic(_InterlockedExchange)
+void _ReadWriteBarrier (void);
+#pragma intrinsic(_ReadWriteBarrier)
+
+//
+// The ring is written under the lock, so a compiler barrier is enough.
+//
+#define DEBUG_RING_LOAD_ACQUIRE(Variable)         (Variable)
+#define DEBUG_RING_STORE_RELEASE(Variable, Value)  do { _ReadWriteBarrier (); (Variable) = (Value); } while (FALSE)
+
+volatile long  mDebugRingLock;
+
+#define DEBUG_RING_DRAIN_LOCK()    while (_InterlockedExchange (&mDebugRingLock, 1) != 0) { }
+#define DEBUG_RING_DRAIN_UNLOCK()  _InterlockedExchange (&mDebugRingLock, 0)
+
+#else
+
+#define DEBUG_RING_LOAD_ACQUIRE(Variable)         (Variable)
+#define DEBUG_RING_STORE_RELEASE(Variable, Value)  ((Variable) = (Value))
+
+#define DEBUG_RING_DRAIN_LOCK()
+#define DEBUG_RING_DRAIN_UNLOCK()
+
+#endif
+
+//
+// The shared ring, used without the drain thread.
+//
+DEBUG_RING          mDebugSharedRing;
+BOOLEAN             mDebugSharedRingRegistered;
+BOOLEAN             mDebugRingAtExitRegistered;
+
+DEBUG_RING *volatile  mDebugRingList;
+
+//
+// Once the rings are drained at exit, the messages are printed synchronously.
+//
+volatile BOOLEAN    mDebugRingSynchronous;
+
+CHAR8               mDebugRingOutput[0x1000];
+UINTN               mDebugRingOutputLength;
+
+/**
+  Parses a conversion specification of a format.
+
+  @param  Format                The format, from the '%' of the specification.
+  @param  Spec                  The conversion specification.
+**/
+VOID
+InternalDebugRingParseSpec (
+  IN  CONST CHAR8      *Format,
+  OUT DEBUG_RING_SPEC  *Spec
+  )
+{
+  UINTN  Index;
+
+  memset (Spec, 0, sizeof(DEBUG_RING_SPEC));
+  Spec->Type = DEBUG_RING_ARGUMENT_LITERAL;
+  Index = 1;
+  while ((Format[Index] != 0) && (strchr ("-+ #0", Format[Index]) != NULL)) {
+    Index++;
+  }
+  if (Format[Index] == '*') {
+    Spec->StarCount++;
+    Index++;
+  }
+  while ((Format[Index] >= '0') && (Format[Index] <= '9')) {
+    Index++;
+  }
+  if (Format[Index] == '.') {
+    Index++;
+    if (Format[Index] == '*') {
+      Spec->StarCount++;
+      Index++;
+    }
+    while ((Format[Index] >= '0') && (Format[Index] <= '9')) {
+      Index++;
+    }
+  }
+
+  Spec->LengthOffset = Index;
+  switch (Format[Index]) {
+  case 'h':
+    Spec->Length = (Format[Index + 1] == 'h') ? DEBUG_RING_LENGTH_HH : DEBUG_RING_LENGTH_H;
+    break;
+  case 'l':
+    Spec->Length = (Format[Index + 1] == 'l') ? DEBUG_RING_LENGTH_LL : DEBUG_RING_LENGTH_L;
+    break;
+  case 'z':
+    Spec->Length = DEBUG_RING_LENGTH_Z;
+    break;
+  case 'j':
+    Spec->Length = DEBUG_RING_LENGTH_J;
+    break;
+  case 't':
+    Spec->Length = DEBUG_RING_LENGTH_T;
+    break;
+  default:
+    break;
+  }
+  if ((Spec->Length == DEBUG_RING_LENGTH_HH) || (Spec->Length == DEBUG_RING_LENGTH_LL)) {
+    Spec->LengthSize = 2;
+  } else if (Spec->Length != DEBUG_RING_LENGTH_NONE) {
+    Spec->LengthSize = 1;
+  }
+  Index += Spec->LengthSize;
+
+  switch (Format[Index]) {
+  case 'd':
+  case 'i':
+    Spec->Type = DEBUG_RING_ARGUMENT_SIGNED;
+    break;
+  case 'u':
+  case 'o':
+  case 'x':
+  case 'X':
+    Spec->Type = DEBUG_RING_ARGUMENT_UNSIGNED;
+    break;
+  case 'c':
+    Spec->Type = DEBUG_RING_ARGUMENT_CHAR;
+    break;
+  case 'p':
+    Spec->Type = DEBUG_RING_ARGUMENT_POINTER;
+    break;
+  case 's':
+    Spec->Type = DEBUG_RING_ARGUMENT_STRING;
+    break;
+  case 'e':
+  case 'E':
+  case 'f':
+  case 'F':
+  case 'g':
+  case 'G':
+    Spec->Type = DEBUG_RING_ARGUMENT_DOUBLE;
+    break;
+  default:
+    //
+    // "%%", or a conversion which is not supported, such as "%r", is printed as it is,
+    // without an argument.
+    //
+    Spec->StarCount = 0;
+    Spec->Size = (Format[Index] == 0) ? Index : Index + 1;
+    return ;
+  }
+  Spec->Size = Index + 1;
+}
+
+/**
+  Writes the formatted records to stdout.
+**/
+VOID
+InternalDebugRingFlushOutput (
+  VOID
+  )
+{
+  if (mDebugRingOutputLength != 0) {
+    fwrite (mDebugRingOutput, 1, mDebugRingOutputLength, stdout);
+    mDebugRingOutputLength = 0;
+  }
+}
+
+VOID
+InternalDebugRingAppendOutput (
+  IN CONST CHAR8  *Data,
+  IN UINTN        Size
+  )
+{
+  if (mDebugRingOutputLength + Size > sizeof(mDebugRingOutput)) {
+    InternalDebugRingFlushOutput ();
+    if (Size > sizeof(mDebugRingOutput)) {
+      fwrite (Data, 1, Size, stdout);
+      return ;
+    }
+  }
+  memcpy (mDebugRingOutput + mDebugRingOutputLength, Data, Size);
+  mDebugRingOutputLength += Size;
+}
+
+/**
+  Formats a DEBUG_RING_RECORD_PRINT, one conversion specification at a time.
+
+  @param  Record                The record.
+**/
+VOID
+InternalDebugRingFormatPrint (
+  IN DEBUG_RING_RECORD  *Record
+  )
+{
+  UINT64           *Argument;
+  UINTN            ArgumentIndex;
+  CONST CHAR8      *Format;
+  CONST CHAR8      *Percent;
+  DEBUG_RING_SPEC  Spec;
+  CHAR8            SpecBuffer[32];
+  UINTN            SpecLength;
+  UINTN            Index;
+  CHAR8            Message[MAX_DEBUG_MESSAGE_LENGTH];
+  UINTN            Length;
+  INTN             Result;
+  double           Double;
+
+  Argument = (UINT64 *)(Record + 1);
+  Format = (CONST CHAR8 *)(UINTN)Argument[0];
+  ArgumentIndex = 1;
+  Length = 0;
+
+  while ((*Format != 0) && (Length < sizeof(Message) - 1)) {
+    Percent = strchr (Format, '%');
+    if (Percent == NULL) {
+      Percent = Format + strlen (Format);
+    }
+    if (Percent != Format) {
+      Index = MIN ((UINTN)(Percent - Format), sizeof(Message) - 1 - Length);
+      memcpy (Message + Length, Format, Index);
+      Length += Index;
+      Format = Percent;
+      continue;
+    }
+
+    InternalDebugRingParseSpec (Format, &Spec);
+    if ((Spec.Type == DEBUG_RING_ARGUMENT_LITERAL) ||
+        (Spec.Size + 2 * 12 > sizeof(SpecBuffer)) ||
+        (ArgumentIndex + Spec.StarCount + 1 > (UINTN)Record->Count + 1)) {
+      if ((Spec.Size == 2) && (Format[1] == '%')) {
+        Message[Length++] = '%';
+      } else {
+        Index = MIN (Spec.Size, sizeof(Message) - 1 - Length);
+        memcpy (Message + Length, Format, Index);
+        Length += Index;
+      }
+      Format += Spec.Size;
+      continue;
+    }
+
+    //
+    // Rebuild the specification with the width and the precision of '*', and with "ll" for the
+    // integers, which are recorded as 64-bit.
+    //
+    SpecLength = 0;
+    for (Index = 0; Index < Spec.Size - 1; Index++) {
+      if ((Index >= Spec.LengthOffset) && (Index < Spec.LengthOffset + Spec.LengthSize)) {
+        continue;
+      }
+      if (Format[Index] == '*') {
+        SpecLength += snprintf (SpecBuffer + SpecLength, sizeof(SpecBuffer) - SpecLength, "%d",
+                                (INT32)Argument[ArgumentIndex++]);
+        continue;
+      }
+      SpecBuffer[SpecLength++] = Format[Index];
+    }
+    if ((Spec.Type == DEBUG_RING_ARGUMENT_SIGNED) || (Spec.Type == DEBUG_RING_ARGUMENT_UNSIGNED)) {
+      SpecBuffer[SpecLength++] = 'l';
+      SpecBuffer[SpecLength++] = 'l';
+    }
+    SpecBuffer[SpecLength++] = Format[Spec.Size - 1];
+    SpecBuffer[SpecLength] = 0;
+
+    switch (Spec.Type) {
+    case DEBUG_RING_ARGUMENT_SIGNED:
+      Result = snprintf (Message + Length, sizeof(Message) - Length, SpecBuffer, (long long)Argument[ArgumentIndex]);
+      break;
+    case DEBUG_RING_ARGUMENT_UNSIGNED:
+      Result = snprintf (Message + Length, sizeof(Message) - Length, SpecBuffer, (unsigned long long)Argument[ArgumentIndex]);
+      break;
+    case DEBUG_RING_ARGUMENT_CHAR:
+      Result = snprintf (Message + Length, sizeof(Message) - Length, SpecBuffer, (int)Argument[ArgumentIndex]);
+      break;
+    case DEBUG_RING_ARGUMENT_POINTER:
+      Result = snprintf (Message + Length, sizeof(Message) - Length, SpecBuffer, (VOID *)(UINTN)Argument[ArgumentIndex]);
+      break;
+    case DEBUG_RING_ARGUMENT_STRING:
+      Result = snprintf (Message + Length, sizeof(Message) - Length, SpecBuffer, (CHAR8 *)Record + Argument[ArgumentIndex]);
+      break;
+    default:
+      memcpy (&Double, &Argument[ArgumentIndex], sizeof(Double));
+      Result = snprintf (Message + Length, sizeof(Message) - Length, SpecBuffer, Double);
+      break;
+    }
+    ArgumentIndex++;
+    if (Result > 0) {
+      Length = MIN (Length + (UINTN)Result, sizeof(Message) - 1);
+    }
+    Format += Spec.Size;
+  }
+
+  InternalDebugRingAppendOutput (Message, Length);
+}
+
+/**
+  Formats a DEBUG_RING_RECORD_HEX.
+
+  @param  Record                The record.
+**/
+VOID
+InternalDebugRingFormatHex (
+  IN DEBUG_RING_RECORD  *Record
+  )
+{
+  UINT8  *Data;
+  UINTN  Size;
+  UINTN  Index;
+  CHAR8  Hex[3];
+  UINTN  HexSize;
+
+  Data = (UINT8 *)(Record + 1);
+  Size = Record->Count & MAX_UINT16;
+  HexSize = ((Record->Type == DEBUG_RING_RECORD_HEX) && ((Record->Size & 0x4) != 0)) ? 3 : 2;
+  for (Index = 0; Index < Size; Index++) {
+    Hex[0] = "0123456789abcdef"[Data[Index] >> 4];
+    Hex[1] = "0123456789abcdef"[Data[Index] & 0xF];
+    Hex[2] = ' ';
+    InternalDebugRingAppendOutput (Hex, HexSize);
+  }
+}
+
+/**
+  Formats the records of a ring. The caller holds the drain lock.
+
+  @param  Ring                  The ring.
+
+  @retval TRUE   Some records are formatted.
+  @retval FALSE  The ring is empty.
+**/
+BOOLEAN
+InternalDebugRingDrain (
+  IN DEBUG_RING  *Ring
+  )
+{
+  UINTN              Head;
+  UINTN              Tail;
+  DEBUG_RING_RECORD  *Record;
+
+  Head = DEBUG_RING_LOAD_ACQUIRE (Ring->Head);
+  Tail = Ring->Tail;
+  if (Head == Tail) {
+    return FALSE;
+  }
+  while (Tail != Head) {
+    Record = (DEBUG_RING_RECORD *)((UINT8 *)Ring->Buffer + (Tail & DEBUG_RING_MASK));
+    if (Record->Type == DEBUG_RING_RECORD_PRINT) {
+      InternalDebugRingFormatPrint (Record);
+    } else if (Record->Type == DEBUG_RING_RECORD_HEX) {
+      InternalDebugRingFormatHex (Record);
+    }
+    Tail += Record->Size & ~(UINT32)0x7;
+  }
+  DEBUG_RING_STORE_RELEASE (Ring->Tail, Tail);
+  return TRUE;
+}
+
+/**
+  Formats the records of all the rings. The caller holds the drain lock.
+
+  @retval TRUE   Some records are formatted.
+  @retval FALSE  The rings are empty.
+**/
+BOOLEAN
+InternalDebugRingDrainAll (
+  VOID
+  )
+{
+  DEBUG_RING  *Ring;
+  BOOLEAN     Drained;
+
+  Drained = FALSE;
+  for (Ring = DEBUG_RING_LOAD_ACQUIRE (mDebugRingList); Ring != NULL; Ring = Ring->Next) {
+    if (InternalDebugRingDrain (Ring)) {
+      Drained = TRUE;
+    }
+  }
+  if (Drained) {
+    InternalDebugRingFlushOutput ();
+    fflush (stdout);
+  }
+  return Drained;
+}
+
+/**
+  Formats the records of all the rings, then prints the next messages synchronously.
+  It is called when the program exits.
+**/
+VOID
+InternalDebugRingExit (
+  VOID
+  )
+{
+  DEBUG_RING_DRAIN_LOCK ();
+  mDebugRingSynchronous = TRUE;
+  InternalDebugRingDrainAll ();
+  DEBUG_RING_DRAIN_UNLOCK ();
+}
+
+#if defined(DEBUG_RING_THREADS)
+
+/**
+  The drain thread, which formats the records of the rings until the program exits.
+**/
+VOID *
+InternalDebugRingDrainThread (
+  IN VOID  *Context
+  )
+{
+  BOOLEAN  Drained;
+
+  while (TRUE) {
+    DEBUG_RING_DRAIN_LOCK ();
+    Drained = InternalDebugRingDrainAll ();
+    DEBUG_RING_DRAIN_UNLOCK ();
+    if (!Drained) {
+      usleep (DEBUG_RING_DRAIN_INTERVAL_US);
+    }
+  }
+  return NULL;
+}
+
+/**
+  Starts the drain thread, once in each process.
+**/
+VOID
+InternalDebugRingStartDrain (
+  VOID
+  )
+{
+  pthread_t       Thread;
+  pthread_attr_t  Attribute;
+
+  pthread_mutex_lock (&mDebugRingListLock);
+  if (!mDebugRingDrainStarted) {
+    mDebugRingDrainStarted = TRUE;
+    if ((pthread_attr_init (&Attribute) == 0) &&
+        (pthread_attr_setdetachstate (&Attribute, PTHREAD_CREATE_DETACHED) == 0) &&
+        (pthread_create (&Thread, &Attribute, InternalDebugRingDrainThread, NULL) == 0)) {
+      DEBUG_RING_STORE_RELEASE (mDebugRingDrainRunning, TRUE);
+    }
+  }
+  pthread_mutex_unlock (&mDebugRingListLock);
+}
+
+/**
+  The destructor of the ring key, called when a thread exits.
+
+  @param  Ring                  The ring of the thread.
+**/
+VOID
+InternalDebugRingThreadExit (
+  IN VOID  *Ring
+  )
+{
+  mDebugThreadRing = NULL;
+  mDebugThreadRingExited = TRUE;
+  DEBUG_RING_STORE_RELEASE (((DEBUG_RING *)Ring)->Exited, TRUE);
+}
+
+/**
+  In the child of a fork, only the forking thread exists, without the drain thread. The records in
+  the rings are formatted by the parent, so they are dropped, and the rings of the other threads
+  are reused.
+**/
+VOID
+InternalDebugRingForkChild (
+  VOID
+  )
+{
+  DEBUG_RING  *Ring;
+
+  pthread_mutex_init (&mDebugRingListLock, NULL);
+  pthread_mutex_init (&mDebugRingDrainLock, NULL);
+  mDebugRingDrainStarted = FALSE;
+  mDebugRingDrainRunning = FALSE;
+  for (Ring = mDebugRingList; Ring != NULL; Ring = Ring->Next) {
+    Ring->Tail = Ring->Head;
+    if (Ring != mDebugThreadRing) {
+      Ring->Exited = TRUE;
+    }
+  }
+}
+
+VOID
+InternalDebugRingInitialize (
+  VOID
+  )
+{
+  mDebugRingKeyReady = (pthread_key_create (&mDebugRingKey, InternalDebugRingThreadExit) == 0);
+  pthread_atfork (NULL, NULL, InternalDebugRingForkChild);
+  atexit (InternalDebugRingExit);
+}
+
+/**
+  Returns the ring of the current thread, reusing the ring of an exited thread or allocating one
+  on its first use.
+
+  @return The ring of the thread, or NULL if the thread cannot have one.
+**/
+DEBUG_RING *
+InternalDebugRingGetThreadRing (
+  VOID
+  )
+{
+  DEBUG_RING  *Ring;
+
+  if (mDebugThreadRing != NULL) {
+    return mDebugThreadRing;
+  }
+  if (mDebugThreadRingExited) {
+    return NULL;
+  }
+
+  pthread_once (&mDebugRingOnce, InternalDebugRingInitialize);
+  if (!mDebugRingKeyReady) {
+    return NULL;
+  }
+
+  pthread_mutex_lock (&mDebugRingListLock);
+  for (Ring = mDebugRingList; Ring != NULL; Ring = Ring->Next) {
+    if (DEBUG_RING_LOAD_ACQUIRE (Ring->Exited) &&
+        (DEBUG_RING_LOAD_ACQUIRE (Ring->Tail) == Ring->Head)) {
+      Ring->Exited = FALSE;
+      break;
+    }
+  }
+  if (Ring == NULL) {
+    Ring = calloc (1, sizeof(DEBUG_RING));
+    if (Ring != NULL) {
+      Ring->Next = mDebugRingList;
+      DEBUG_RING_STORE_RELEASE (mDebugRingList, Ring);
+    }
+  }
+  pthread_mutex_unlock (&mDebugRingListLock);
+  if (Ring == NULL) {
+    return NULL;
+  }
+  if (pthread_setspecific (mDebugRingKey, Ring) != 0) {
+    DEBUG_RING_STORE_RELEASE (Ring->Exited, TRUE);
+    return NULL;
+  }
+  mDebugThreadRing = Ring;
+  return Ring;
+}
+
+#endif
+
+/**
+  Reserves room for a record in a ring, waiting for the drain thread or formatting the records of the
+  shared ring when it is full.
+
+  @param  Ring                  The ring.
+  @param  Size                  The size in bytes of the record, a multiple of 8.
+  @param  Head                  The new head of the ring, once the record is written.
+
+  @return The record.
+**/
+DEBUG_RING_RECORD *
+InternalDebugRingReserve (
+  IN  DEBUG_RING  *Ring,
+  IN  UINTN       Size,
+  OUT UINTN       *Head
+  )
+{
+  UINTN              Offset;
+  UINTN              Contiguous;
+  UINTN              Needed;
+  DEBUG_RING_RECORD  *Pad;
+
+  Offset = Ring->Head & DEBUG_RING_MASK;
+  Contiguous = DEBUG_RING_SIZE - Offset;
+  Needed = (Contiguous < Size) ? Contiguous + Size : Size;
+
+  while (DEBUG_RING_SIZE - (Ring->Head - DEBUG_RING_LOAD_ACQUIRE (Ring->Tail)) < Needed) {
+#if defined(DEBUG_RING_THREADS)
+    if ((Ring != &mDebugSharedRing) && DEBUG_RING_LOAD_ACQUIRE (mDebugRingDrainRunning)) {
+      sched_yield ();
+      continue;
+    }
+#endif
+    InternalDebugRingDrain (Ring);
+    InternalDebugRingFlushOutput ();
+  }
+
+  if (Contiguous < Size) {
+    Pad = (DEBUG_RING_RECORD *)((UINT8 *)Ring->Buffer + Offset);
+    Pad->Size = (UINT32)Contiguous;
+    Pad->Type = DEBUG_RING_RECORD_PAD;
+    Pad->Count = 0;
+    Offset = 0;
+  }
+  *Head = Ring->Head + Needed;
+  return (DEBUG_RING_RECORD *)((UINT8 *)Ring->Buffer + Offset);
+}
+
+/**
+  Returns the ring of the current thread, or the shared ring with the drain lock held.
+
+  @param  Shared                TRUE if the shared ring is returned, with the drain lock held.
+
+  @return The ring, or NULL if the message is printed synchronously.
+**/
+DEBUG_RING *
+InternalDebugRingAcquire (
+  OUT BOOLEAN  *Shared
+  )
+{
+#if defined(DEBUG_RING_THREADS)
+  DEBUG_RING  *Ring;
+#endif
+
+  *Shared = FALSE;
+  if (mDebugRingSynchronous) {
+    return NULL;
+  }
+
+#if defined(DEBUG_RING_THREADS)
+  if (!mDebugRingDrainStarted) {
+    InternalDebugRingStartDrain ();
+  }
+  if (DEBUG_RING_LOAD_ACQUIRE (mDebugRingDrainRunning)) {
+    Ring = InternalDebugRingGetThreadRing ();
+    if (Ring != NULL) {
+      return Ring;
+    }
+  }
+#endif
+
+  DEBUG_RING_DRAIN_LOCK ();
+  if (mDebugRingSynchronous) {
+    DEBUG_RING_DRAIN_UNLOCK ();
+    return NULL;
+  }
+  if (!mDebugSharedRingRegistered) {
+    mDebugSharedRing.Next = mDebugRingList;
+    DEBUG_RING_STORE_RELEASE (mDebugRingList, &mDebugSharedRing);
+    mDebugSharedRingRegistered = TRUE;
+#if !defined(DEBUG_RING_THREADS)
+    atexit (InternalDebugRingExit);
+#endif
+  }
+  *Shared = TRUE;
+  return &mDebugSharedRing;
+}
+
+/**
+  Publishes a record to the drain thread, or formats the shared ring once it is half full, then
+  releases the drain lock of the shared ring.
+
+  @param  Ring                  The ring.
+  @param  Head                  The new head of the ring.
+  @param  Shared                TRUE if the ring is the shared ring.
+**/
+VOID
+InternalDebugRingCommit (
+  IN DEBUG_RING  *Ring,
+  IN UINTN       Head,
+  IN BOOLEAN     Shared
+  )
+{
+  DEBUG_RING_STORE_RELEASE (Ring->Head, Head);
+  if (Shared) {
+    if (Ring->Head - Ring->Tail >= DEBUG_RING_SIZE / 2) {
+      InternalDebugRingDrain (Ring);
+      InternalDebugRingFlushOutput ();
+      fflush (stdout);
+    }
+    DEBUG_RING_DRAIN_UNLOCK ();
+  }
+}
+
+VOID
+EFIAPI
+DebugAssert (
+  IN CONST CHAR8  *FileName,
+  IN UINTN        LineNumber,
+  IN CONST CHAR8  *Description
+  )
+{
+  DEBUG_RING_DRAIN_LOCK ();
+  InternalDebugRingDrainAll ();
+  DEBUG_RING_DRAIN_UNLOCK ();
+
+  printf ("ASSERT: %s(%d): %s\n", FileName, (INT32)(UINT32)LineNumber, Description);
+
+#if (DEBUG_ASSERT_CONFIG == DEBUG_ASSERT_DEADLOOP)
+  {volatile INTN ___i = 1; while (___i);}
+#elif (DEBUG_ASSERT_CONFIG == DEBUG_ASSERT_BREAKPOINT)
+#if defined(_MSC_EXTENSIONS)
+  __debugbreak();
+#endif
+#if defined(__GNUC__)
+  __asm__ __volatile__("int $3");
+#endif
+#endif
+
+  assert (FALSE);
+}
+
+VOID
+EFIAPI
+DebugPrint (
+  IN  UINTN        ErrorLevel,
+  IN  CONST CHAR8  *Format,
+  ...
+  )
+{
+  CHAR8              Buffer[MAX_DEBUG_MESSAGE_LENGTH];
+  va_list            Marker;
+  UINT64             Argument[DEBUG_RING_MAX_ARGUMENTS + 1];
+  UINTN              ArgumentCount;
+  CONST CHAR8        *String[DEBUG_RING_MAX_ARGUMENTS];
+  UINTN              StringSize[DEBUG_RING_MAX_ARGUMENTS];
+  UINTN              StringTotal;
+  CONST CHAR8        *Percent;
+  DEBUG_RING_SPEC    Spec;
+  UINTN              Index;
+  double             Double;
+  DEBUG_RING         *Ring;
+  BOOLEAN            Shared;
+  DEBUG_RING_RECORD  *Record;
+  UINTN              Head;
+  UINTN              Offset;
+
+  if ((ErrorLevel & DEBUG_LEVEL_CONFIG) == 0) {
+    return ;
+  }
+
+  Ring = InternalDebugRingAcquire (&Shared);
+  if (Ring == NULL) {
+    va_start (Marker, Format);
+    vsnprintf (Buffer, sizeof(Buffer), Format, Marker);
+    va_end (Marker);
+    printf ("%s", Buffer);
+    return ;
+  }
+
+  //
+  // Collect the arguments as the format specifies them.
+  //
+  Argument[0] = (UINT64)(UINTN)Format;
+  ArgumentCount = 0;
+  StringTotal = 0;
+  va_start (Marker, Format);
+  Percent = Format;
+  while ((Percent = strchr (Percent, '%')) != NULL) {
+    InternalDebugRingParseSpec (Percent, &Spec);
+    Percent += Spec.Size;
+    if (Spec.Type == DEBUG_RING_ARGUMENT_LITERAL) {
+      continue;
+    }
+    if (ArgumentCount + Spec.StarCount + 1 > DEBUG_RING_MAX_ARGUMENTS) {
+      break;
+    }
+    for (Index = 0; Index < Spec.StarCount; Index++) {
+      String[ArgumentCount] = NULL;
+      Argument[++ArgumentCount] = (UINT64)(INT64)va_arg (Marker, int);
+    }
+    String[ArgumentCount] = NULL;
+    switch (Spec.Type) {
+    case DEBUG_RING_ARGUMENT_SIGNED:
+      switch (Spec.Length) {
+      case DEBUG_RING_LENGTH_HH:
+        Argument[ArgumentCount + 1] = (UINT64)(INT64)(INT8)va_arg (Marker, int);
+        break;
+      case DEBUG_RING_LENGTH_H:
+        Argument[ArgumentCount + 1] = (UINT64)(INT64)(INT16)va_arg (Marker, int);
+        break;
+      case DEBUG_RING_LENGTH_L:
+        Argument[ArgumentCount + 1] = (UINT64)(INT64)va_arg (Marker, long);
+        break;
+      case DEBUG_RING_LENGTH_LL:
+      case DEBUG_RING_LENGTH_J:
+        Argument[ArgumentCount + 1] = (UINT64)va_arg (Marker, long long);
+        break;
+      case DEBUG_RING_LENGTH_Z:
+      case DEBUG_RING_LENGTH_T:
+        Argument[ArgumentCount + 1] = (UINT64)(INT64)va_arg (Marker, INTN);
+        break;
+      default:
+        Argument[ArgumentCount + 1] = (UINT64)(INT64)va_arg (Marker, int);
+        break;
+      }
+      break;
+    case DEBUG_RING_ARGUMENT_UNSIGNED:
+      switch (Spec.Length) {
+      case DEBUG_RING_LENGTH_HH:
+        Argument[ArgumentCount + 1] = (UINT8)va_arg (Marker, unsigned int);
+        break;
+      case DEBUG_RING_LENGTH_H:
+        Argument[ArgumentCount + 1] = (UINT16)va_arg (Marker, unsigned int);
+        break;
+      case DEBUG_RING_LENGTH_L:
+        Argument[ArgumentCount + 1] = va_arg (Marker, unsigned long);
+        break;
+      case DEBUG_RING_LENGTH_LL:
+      case DEBUG_RING_LENGTH_J:
+        Argument[ArgumentCount + 1] = va_arg (Marker, unsigned long long);
+        break;
+      case DEBUG_RING_LENGTH_Z:
+      case DEBUG_RING_LENGTH_T:
+        Argument[ArgumentCount + 1] = va_arg (Marker, UINTN);
+        break;
+      default:
+        Argument[ArgumentCount + 1] = va_arg (Marker, unsigned int);
+        break;
+      }
+      break;
+    case DEBUG_RING_ARGUMENT_CHAR:
+      Argument[ArgumentCount + 1] = (UINT64)(INT64)va_arg (Marker, int);
+      break;
+    case DEBUG_RING_ARGUMENT_POINTER:
+      Argument[ArgumentCount + 1] = (UINT64)(UINTN)va_arg (Marker, VOID *);
+      break;
+    case DEBUG_RING_ARGUMENT_STRING:
+      String[ArgumentCount] = va_arg (Marker, CONST CHAR8 *);
+      if (String[ArgumentCount] == NULL) {
+        String[ArgumentCount] = "(null)";
+      }
+      StringSize[ArgumentCount] = strlen (String[ArgumentCount]);
+      if (StringSize[ArgumentCount] > DEBUG_RING_MAX_STRING - 1) {
+        StringSize[ArgumentCount] = DEBUG_RING_MAX_STRING - 1;
+      }
+      StringTotal += StringSize[ArgumentCount] + 1;
+      break;
+    default:
+      Double = va_arg (Marker, double);
+      memcpy (&Argument[ArgumentCount + 1], &Double, sizeof(Double));
+      break;
+    }
+    ArgumentCount++;
+  }
+  va_end (Marker);
+
+  Record = InternalDebugRingReserve (
+             Ring,
+             ALIGN_VALUE (sizeof(DEBUG_RING_RECORD) + (ArgumentCount + 1) * sizeof(UINT64) + StringTotal, 8),
+             &Head
+             );
+  Record->Size = (UINT32)ALIGN_VALUE (sizeof(DEBUG_RING_RECORD) + (ArgumentCount + 1) * sizeof(UINT64) + StringTotal, 8);
+  Record->Type = DEBUG_RING_RECORD_PRINT;
+  Record->Count = (UINT16)ArgumentCount;
+  Offset = sizeof(DEBUG_RING_RECORD) + (ArgumentCount + 1) * sizeof(UINT64);
+  for (Index = 0; Index < ArgumentCount; Index++) {
+    if (String[Index] != NULL) {
+      memcpy ((UINT8 *)Record + Offset, String[Index], StringSize[Index]);
+      *((UINT8 *)Record + Offset + StringSize[Index]) = 0;
+      Argument[Index + 1] = Offset;
+      Offset += StringSize[Index] + 1;
+    }
+  }
+  memcpy (Record + 1, Argument, (ArgumentCount + 1) * sizeof(UINT64));
+  InternalDebugRingCommit (Ring, Head, Shared);
+}
+
+BOOLEAN
+EFIAPI
+DebugPrintLevelEnabled (
+  IN  CONST UINTN        ErrorLevel
+  )
+{
+  return (BOOLEAN)((ErrorLevel & DEBUG_LEVEL_CONFIG) != 0);
+}
+
+VOID
+EFIAPI
+DebugPrintHex (
+  IN UINTN        ErrorLevel,
+  IN CONST VOID   *Data,
+  IN UINTN        Size,
+  IN BOOLEAN      Separated
+  )
+{
+  CONST UINT8        *Byte;
+  UINTN              Index;
+  UINTN              Length;
+  CHAR8              Hex[3];
+  DEBUG_RING         *Ring;
+  BOOLEAN            Shared;
+  DEBUG_RING_RECORD  *Record;
+  UINTN              Head;
+  UINTN              RecordSize;
+
+  if ((ErrorLevel & DEBUG_LEVEL_CONFIG) == 0) {
+    return ;
+  }
+
+  Byte = Data;
+  while (Size != 0) {
+    Length = MIN (Size, DEBUG_RING_MAX_HEX);
+    Ring = InternalDebugRingAcquire (&Shared);
+    if (Ring == NULL) {
+      for (Index = 0; Index < Length; Index++) {
+        Hex[0] = "0123456789abcdef"[Byte[Index] >> 4];
+        Hex[1] = "0123456789abcdef"[Byte[Index] & 0xF];
+        Hex[2] = ' ';
+        fwrite (Hex, 1, Separated ? 3 : 2, stdout);
+      }
+    } else {
+      //
+      // The size of a record is a multiple of 8 bytes, so bit 2 of the size is free to record
+      // if the bytes are separated.
+      //
+      RecordSize = ALIGN_VALUE (sizeof(DEBUG_RING_RECORD) + Length, 8);
+      Record = InternalDebugRingReserve (Ring, RecordSize, &Head);
+      Record->Size = (UINT32)(RecordSize | (Separated ? 0x4 : 0));
+      Record->Type = DEBUG_RING_RECORD_HEX;
+      Record->Count = (UINT16)Length;
+      memcpy (Record + 1, Byte, Length);
+      InternalDebugRingCommit (Ring, Head, Shared);
+    }
+    Byte += Length;
+    Size -= Length;
+  }
+}
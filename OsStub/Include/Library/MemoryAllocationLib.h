@@ -71,4 +71,230 @@ FreePool (
   IN VOID   *Buffer
   );
 
+/**
+  Sets a caller-provided arena for the pool allocations.
+
+  The pool allocations are served from the arena while it is set.
+  The arena can only be changed when no block allocated from it is outstanding.
+
+  @param  Arena                 The arena buffer, or NULL to allocate from the heap.
+  @param  ArenaSize             The size in bytes of the arena buffer.
+  @param  Strict                If TRUE, an allocation fails when the arena cannot serve it,
+                                instead of falling back to the heap.
+
+  @retval TRUE  the arena is set.
+  @retval FALSE a block allocated from the current arena is outstanding.
+**/
+BOOLEAN
+EFIAPI
+SetPoolArena (
+  IN VOID     *Arena OPTIONAL,
+  IN UINTN    ArenaSize,
+  IN BOOLEAN  Strict
+  );
+
+/**
+  Returns the peak size in bytes used in the arena since it was set.
+
+  @return The peak size in bytes used in the arena.
+**/
+UINTN
+EFIAPI
+GetPoolArenaPeakSize (
+  VOID
+  );
+
+/**
+  Allocates a buffer for the pool allocations.
+
+  @param  Context               The Context of the POOL_ALLOCATOR.
+  @param  Size                  The number of bytes to allocate.
+
+  @return A pointer to the buffer, aligned on 16 bytes, or NULL if allocation fails.
+**/
+typedef
+VOID *
+(EFIAPI *POOL_ALLOCATOR_ALLOCATE) (
+  IN VOID   *Context,
+  IN UINTN  Size
+  );
+
+/**
+  Frees a buffer returned by the POOL_ALLOCATOR_ALLOCATE of the same allocator.
+
+  @param  Context               The Context of the POOL_ALLOCATOR.
+  @param  Buffer                Pointer to the buffer to free.
+  @param  Size                  The number of bytes allocated.
+**/
+typedef
+VOID
+(EFIAPI *POOL_ALLOCATOR_FREE) (
+  IN VOID   *Context,
+  IN VOID   *Buffer,
+  IN UINTN  Size
+  );
+
+///
+/// A caller-provided allocator for the pool allocations, such as one which places them
+/// in locked memory on the NUMA node of the thread.
+///
+typedef struct {
+  POOL_ALLOCATOR_ALLOCATE  Allocate;
+  POOL_ALLOCATOR_FREE      Free;
+  VOID                     *Context;
+} POOL_ALLOCATOR;
+
+/**
+  Sets a caller-provided allocator for the pool allocations of the current thread.
+
+  The pool allocations of the thread which the arena of SetPoolArena does not serve are allocated
+  by the allocator while it is set, and an allocation fails when the allocator cannot serve it.
+  The hash, HMAC and AEAD contexts of the crypto backends, which hold the session secrets, are pool
+  allocations, so that a thread which owns a set of SPDM contexts can keep them in its own memory.
+
+  A block is freed to the allocator which allocated it, by whichever thread frees it. The allocator
+  must stay valid until all its blocks are freed.
+
+  @param  Allocator             The allocator, or NULL to allocate from the pools.
+
+  @retval TRUE  the allocator is set.
+  @retval FALSE the MemoryAllocationLib does not support the allocators.
+**/
+BOOLEAN
+EFIAPI
+SetPoolAllocator (
+  IN CONST POOL_ALLOCATOR  *Allocator OPTIONAL
+  );
+
+/**
+  Returns the number of pool allocations since the program started.
+
+  It counts every AllocatePool and AllocateZeroPool call, whether it is served from the arena or the heap.
+
+  @return The number of pool allocations.
+**/
+UINTN
+EFIAPI
+GetPoolAllocationCount (
+  VOID
+  );
+
+///
+/// The statistics of the pool allocations.
+///
+/// The sizes are in bytes. A block has the requested size, plus its head and the rounding to its
+/// size class. The reserved size is the size of the blocks taken from the heap or the static arena,
+/// whether they are allocated or free.
+///
+typedef struct {
+  UINTN  AllocationCount;
+  UINTN  FreeCount;
+  UINTN  FailureCount;
+  UINTN  CurrentSize;
+  UINTN  PeakSize;
+  UINTN  BlockSize;
+  UINTN  PeakBlockSize;
+  UINTN  ReservedSize;
+  UINTN  PeakReservedSize;
+  ///
+  /// BlockSize - CurrentSize: the heads and the rounding of the allocated blocks.
+  ///
+  UINTN  InternalFragmentationSize;
+  ///
+  /// ReservedSize - BlockSize: the free blocks kept for reuse.
+  ///
+  UINTN  ExternalFragmentationSize;
+} POOL_STATISTICS;
+
+/**
+  Returns the statistics of the pool allocations since the program started.
+
+  The allocations served from the arena of SetPoolArena or by the allocator of SetPoolAllocator are not counted.
+  The MemoryAllocationLib which allocates from the heap only counts the allocations, the frees and
+  the failures, and reports the sizes as 0.
+
+  @param  Statistics            The statistics of the pool allocations.
+**/
+VOID
+EFIAPI
+GetPoolStatistics (
+  OUT POOL_STATISTICS  *Statistics
+  );
+
+///
+/// The phases of the SPDM library which the pool allocations are attributed to.
+///
+#define POOL_ALLOCATION_PHASE_NONE       0
+///
+/// The requester sends a request, and processes its response.
+///
+#define POOL_ALLOCATION_PHASE_REQUESTER  1
+///
+/// The responder processes a request, and builds its response.
+///
+#define POOL_ALLOCATION_PHASE_RESPONDER  2
+#define POOL_ALLOCATION_PHASE_COUNT      3
+
+///
+/// The pool allocations attributed to one SPDM request code in one phase.
+///
+/// A free is attributed to the tag of the allocation, so that the live blocks are those of the
+/// operation which allocated them. The sizes are the requested sizes in bytes.
+///
+typedef struct {
+  UINTN  AllocationCount;
+  UINTN  AllocationSize;
+  UINTN  FreeCount;
+  UINTN  LiveCount;
+  UINTN  LiveSize;
+  UINTN  PeakLiveSize;
+} POOL_AUDIT_RECORD;
+
+/**
+  Sets the tag of the pool allocations of the current thread.
+
+  The SPDM library sets it when OPENSPDM_ALLOCATION_AUDIT_SUPPORT is 1, with the request code of the
+  message being processed. The tag stays until the next message of the thread.
+  Only the MemoryAllocationLib of the allocation audit records it.
+
+  @param  RequestCode           The SPDM request code, or 0 if none.
+  @param  Phase                 The phase, one of POOL_ALLOCATION_PHASE_*.
+**/
+VOID
+EFIAPI
+SetPoolAllocationTag (
+  IN UINT8  RequestCode,
+  IN UINT8  Phase
+  );
+
+/**
+  Returns the pool allocations attributed to one SPDM request code in one phase since the program started,
+  or since ResetPoolAudit.
+
+  @param  RequestCode           The SPDM request code, or 0 for the allocations without a request code.
+  @param  Phase                 The phase, one of POOL_ALLOCATION_PHASE_*.
+  @param  Record                The pool allocations of the request code in the phase.
+
+  @retval TRUE  the record is returned.
+  @retval FALSE the MemoryAllocationLib does not audit the allocations, or the Phase is invalid.
+**/
+BOOLEAN
+EFIAPI
+GetPoolAuditRecord (
+  IN  UINT8              RequestCode,
+  IN  UINT8              Phase,
+  OUT POOL_AUDIT_RECORD  *Record
+  );
+
+/**
+  Clears the counts of the pool allocations of all request codes and phases.
+
+  The live blocks are kept, so that a block allocated before and freed after is still accounted.
+**/
+VOID
+EFIAPI
+ResetPoolAudit (
+  VOID
+  );
+
 #endif
@@ -0,0 +1,133 @@
+/** @file
+  Provides the monotonic time source, the delays and the deadlines.
+
+  The SPDM library takes its time from the functions registered by SpdmRegisterRequesterMonitorFunc,
+  SpdmRegisterResponderAdmissionFunc and SpdmRegisterCaptureFunc, in 100ns units. An integrator
+  returns GetTimeInNanoSecond (GetPerformanceCounter ()) / 100 from them, with this library on a hosted
+  platform, or with a TimerLib over the timer of the platform in a firmware.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __TIMER_LIB_H__
+#define __TIMER_LIB_H__
+
+/**
+  Stalls the CPU for at least the given number of microseconds.
+
+  @param  MicroSeconds          The minimum number of microseconds to delay.
+
+  @return The value of MicroSeconds input.
+
+**/
+UINTN
+EFIAPI
+MicroSecondDelay (
+  IN      UINTN                     MicroSeconds
+  );
+
+/**
+  Stalls the CPU for at least the given number of nanoseconds.
+
+  @param  NanoSeconds           The minimum number of nanoseconds to delay.
+
+  @return The value of NanoSeconds input.
+
+**/
+UINTN
+EFIAPI
+NanoSecondDelay (
+  IN      UINTN                     NanoSeconds
+  );
+
+/**
+  Retrieves the current value of a 64-bit free running performance counter.
+
+  The counter is monotonic: it does not go back when the wall clock of the platform is set.
+
+  @return The current value of the free running performance counter.
+
+**/
+UINT64
+EFIAPI
+GetPerformanceCounter (
+  VOID
+  );
+
+/**
+  Retrieves the 64-bit frequency in Hz and the range of performance counter
+  values.
+
+  @param  StartValue            The value the performance counter starts with when it rolls over.
+  @param  EndValue              The value that the performance counter ends with before it rolls over.
+
+  @return The frequency in Hz.
+
+**/
+UINT64
+EFIAPI
+GetPerformanceCounterProperties (
+  OUT      UINT64                    *StartValue,  OPTIONAL
+  OUT      UINT64                    *EndValue     OPTIONAL
+  );
+
+/**
+  Converts elapsed ticks of the performance counter to time in nanoseconds.
+
+  @param  Ticks                 The number of elapsed ticks of the performance counter.
+
+  @return The elapsed time in nanoseconds.
+
+**/
+UINT64
+EFIAPI
+GetTimeInNanoSecond (
+  IN      UINT64                     Ticks
+  );
+
+/**
+  Returns the deadline a timeout from now.
+
+  @param  Timeout               The timeout, in nanoseconds. 0 means no deadline.
+
+  @return The deadline, in nanoseconds of the performance counter, or MAX_UINT64 for no deadline.
+
+**/
+UINT64
+EFIAPI
+GetDeadline (
+  IN      UINT64                     Timeout
+  );
+
+/**
+  Returns the time left until a deadline.
+
+  @param  Deadline              The deadline, from GetDeadline.
+
+  @return The time left, in nanoseconds, 0 if the deadline has passed, or MAX_UINT64 for no deadline.
+
+**/
+UINT64
+EFIAPI
+GetDeadlineRemaining (
+  IN      UINT64                     Deadline
+  );
+
+/**
+  Checks if a deadline has passed.
+
+  @param  Deadline              The deadline, from GetDeadline.
+
+  @retval TRUE   the deadline has passed.
+  @retval FALSE  the deadline has not passed, or there is no deadline.
+
+**/
+BOOLEAN
+EFIAPI
+IsDeadlineExpired (
+  IN      UINT64                     Deadline
+  );
+
+#endif  // __TIMER_LIB_H__
@@ -0,0 +1,327 @@
+/** @file
+  AES block functions for MBEDTLS_AES_ENCRYPT_ALT and MBEDTLS_AES_DECRYPT_ALT.
+
+  The round keys are the ones prepared by the generic mbedtls_aes_setkey_enc()
+  and mbedtls_aes_setkey_dec(): the FIPS-197 key schedule stored as
+  little-endian words, and the equivalent inverse cipher schedule for
+  decryption. On a little-endian CPU that is byte for byte what AES-NI and
+  the ARMv8 AES instructions expect.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "AccelInternal.h"
+
+#if defined(MBEDTLS_AES_C) && (defined(MBEDTLS_AES_ENCRYPT_ALT) || defined(MBEDTLS_AES_DECRYPT_ALT))
+
+#include "mbedtls/aes.h"
+
+#if defined(MBEDTLS_ACCEL_X86)
+#include <immintrin.h>
+#elif defined(MBEDTLS_ACCEL_AARCH64)
+#include <arm_neon.h>
+#endif
+
+//
+// Tables for the portable code, built on first use like the generic MbedTLS
+// tables are.
+//
+static unsigned char mbedtls_accel_aes_fsb[256];
+static unsigned char mbedtls_accel_aes_rsb[256];
+static uint32_t mbedtls_accel_aes_ft[256];
+static uint32_t mbedtls_accel_aes_rt[256];
+static int mbedtls_accel_aes_tables_done;
+
+#define AES_XTIME(x)  ((((x) << 1) ^ (((x) & 0x80) ? 0x1B : 0x00)) & 0xFF)
+#define AES_ROTL8(x)  (((x) << 8) | ((x) >> 24))
+
+/**
+  Build the S-boxes and the round tables of the portable code.
+**/
+static void
+mbedtls_accel_aes_gen_tables (
+  void
+  )
+{
+  unsigned int pow[256];
+  unsigned int log[256];
+  unsigned int i;
+  unsigned int x;
+  unsigned int y;
+  unsigned int z;
+
+  for (i = 0, x = 1; i < 256; i++) {
+    pow[i] = x;
+    log[x] = i;
+    x = (x ^ AES_XTIME (x)) & 0xFF;
+  }
+
+  mbedtls_accel_aes_fsb[0x00] = 0x63;
+  mbedtls_accel_aes_rsb[0x63] = 0x00;
+  for (i = 1; i < 256; i++) {
+    x = pow[255 - log[i]];
+    y = ((x << 1) | (x >> 7)) & 0xFF;
+    x ^= y;
+    y = ((y << 1) | (y >> 7)) & 0xFF;
+    x ^= y;
+    y = ((y << 1) | (y >> 7)) & 0xFF;
+    x ^= y;
+    y = ((y << 1) | (y >> 7)) & 0xFF;
+    x ^= y ^ 0x63;
+    mbedtls_accel_aes_fsb[i] = (unsigned char)x;
+    mbedtls_accel_aes_rsb[x] = (unsigned char)i;
+  }
+
+#define AES_MUL(a, b)  (((a) != 0 && (b) != 0) ? pow[(log[(a)] + log[(b)]) % 255] : 0)
+  for (i = 0; i < 256; i++) {
+    x = mbedtls_accel_aes_fsb[i];
+    y = AES_XTIME (x);
+    z = y ^ x;
+    mbedtls_accel_aes_ft[i] = (uint32_t)y ^ ((uint32_t)x << 8) ^ ((uint32_t)x << 16) ^ ((uint32_t)z << 24);
+
+    x = mbedtls_accel_aes_rsb[i];
+    mbedtls_accel_aes_rt[i] = (uint32_t)AES_MUL (0x0E, x) ^ ((uint32_t)AES_MUL (0x09, x) << 8) ^
+                              ((uint32_t)AES_MUL (0x0D, x) << 16) ^ ((uint32_t)AES_MUL (0x0B, x) << 24);
+  }
+#undef AES_MUL
+
+  mbedtls_accel_aes_tables_done = 1;
+}
+
+static uint32_t
+mbedtls_accel_aes_load32 (
+  const unsigned char *p
+  )
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void
+mbedtls_accel_aes_store32 (
+  unsigned char *p,
+  uint32_t      v
+  )
+{
+  p[0] = (unsigned char)v;
+  p[1] = (unsigned char)(v >> 8);
+  p[2] = (unsigned char)(v >> 16);
+  p[3] = (unsigned char)(v >> 24);
+}
+
+//
+// One table, rotated, replaces the four tables of the generic code.
+//
+#define AES_FT(a, b, c, d)                                                     \
+  (mbedtls_accel_aes_ft[(a) & 0xFF] ^                                          \
+   AES_ROTL8 (mbedtls_accel_aes_ft[((b) >> 8) & 0xFF]) ^                       \
+   AES_ROTL8 (AES_ROTL8 (mbedtls_accel_aes_ft[((c) >> 16) & 0xFF])) ^          \
+   AES_ROTL8 (AES_ROTL8 (AES_ROTL8 (mbedtls_accel_aes_ft[((d) >> 24) & 0xFF]))))
+
+#define AES_RT(a, b, c, d)                                                     \
+  (mbedtls_accel_aes_rt[(a) & 0xFF] ^                                          \
+   AES_ROTL8 (mbedtls_accel_aes_rt[((b) >> 8) & 0xFF]) ^                       \
+   AES_ROTL8 (AES_ROTL8 (mbedtls_accel_aes_rt[((c) >> 16) & 0xFF])) ^          \
+   AES_ROTL8 (AES_ROTL8 (AES_ROTL8 (mbedtls_accel_aes_rt[((d) >> 24) & 0xFF]))))
+
+#define AES_SB(sb, a, b, c, d)                                                 \
+  ((uint32_t)sb[(a) & 0xFF] ^ ((uint32_t)sb[((b) >> 8) & 0xFF] << 8) ^         \
+   ((uint32_t)sb[((c) >> 16) & 0xFF] << 16) ^ ((uint32_t)sb[((d) >> 24) & 0xFF] << 24))
+
+/**
+  Portable AES block encryption or decryption.
+
+  @param  rk                           The round keys.
+  @param  nr                           The number of rounds.
+  @param  decrypt                      Non-zero to run the inverse cipher.
+  @param  input                        The input block.
+  @param  output                       The output block.
+**/
+static void
+mbedtls_accel_aes_block_c (
+  const uint32_t      *rk,
+  int                 nr,
+  int                 decrypt,
+  const unsigned char input[16],
+  unsigned char       output[16]
+  )
+{
+  uint32_t x0;
+  uint32_t x1;
+  uint32_t x2;
+  uint32_t x3;
+  uint32_t y0;
+  uint32_t y1;
+  uint32_t y2;
+  uint32_t y3;
+  int round;
+
+  if (!mbedtls_accel_aes_tables_done) {
+    mbedtls_accel_aes_gen_tables ();
+  }
+
+  x0 = mbedtls_accel_aes_load32 (input) ^ *rk++;
+  x1 = mbedtls_accel_aes_load32 (input + 4) ^ *rk++;
+  x2 = mbedtls_accel_aes_load32 (input + 8) ^ *rk++;
+  x3 = mbedtls_accel_aes_load32 (input + 12) ^ *rk++;
+
+  for (round = 1; round < nr; round++) {
+    if (!decrypt) {
+      y0 = *rk++ ^ AES_FT (x0, x1, x2, x3);
+      y1 = *rk++ ^ AES_FT (x1, x2, x3, x0);
+      y2 = *rk++ ^ AES_FT (x2, x3, x0, x1);
+      y3 = *rk++ ^ AES_FT (x3, x0, x1, x2);
+    } else {
+      y0 = *rk++ ^ AES_RT (x0, x3, x2, x1);
+      y1 = *rk++ ^ AES_RT (x1, x0, x3, x2);
+      y2 = *rk++ ^ AES_RT (x2, x1, x0, x3);
+      y3 = *rk++ ^ AES_RT (x3, x2, x1, x0);
+    }
+    x0 = y0;
+    x1 = y1;
+    x2 = y2;
+    x3 = y3;
+  }
+
+  if (!decrypt) {
+    y0 = *rk++ ^ AES_SB (mbedtls_accel_aes_fsb, x0, x1, x2, x3);
+    y1 = *rk++ ^ AES_SB (mbedtls_accel_aes_fsb, x1, x2, x3, x0);
+    y2 = *rk++ ^ AES_SB (mbedtls_accel_aes_fsb, x2, x3, x0, x1);
+    y3 = *rk++ ^ AES_SB (mbedtls_accel_aes_fsb, x3, x0, x1, x2);
+  } else {
+    y0 = *rk++ ^ AES_SB (mbedtls_accel_aes_rsb, x0, x3, x2, x1);
+    y1 = *rk++ ^ AES_SB (mbedtls_accel_aes_rsb, x1, x0, x3, x2);
+    y2 = *rk++ ^ AES_SB (mbedtls_accel_aes_rsb, x2, x1, x0, x3);
+    y3 = *rk++ ^ AES_SB (mbedtls_accel_aes_rsb, x3, x2, x1, x0);
+  }
+
+  mbedtls_accel_aes_store32 (output, y0);
+  mbedtls_accel_aes_store32 (output + 4, y1);
+  mbedtls_accel_aes_store32 (output + 8, y2);
+  mbedtls_accel_aes_store32 (output + 12, y3);
+}
+
+#if defined(MBEDTLS_ACCEL_X86)
+
+/**
+  AES block encryption or decryption with AES-NI.
+
+  @param  rk                           The round keys.
+  @param  nr                           The number of rounds.
+  @param  decrypt                      Non-zero to run the inverse cipher.
+  @param  input                        The input block.
+  @param  output                       The output block.
+**/
+MBEDTLS_ACCEL_TARGET_AES
+static void
+mbedtls_accel_aes_block_hw (
+  const uint32_t      *rk,
+  int                 nr,
+  int                 decrypt,
+  const unsigned char input[16],
+  unsigned char       output[16]
+  )
+{
+  const __m128i *key;
+  __m128i state;
+  int round;
+
+  key = (const __m128i *)rk;
+  state = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)input), _mm_loadu_si128 (&key[0]));
+  if (!decrypt) {
+    for (round = 1; round < nr; round++) {
+      state = _mm_aesenc_si128 (state, _mm_loadu_si128 (&key[round]));
+    }
+    state = _mm_aesenclast_si128 (state, _mm_loadu_si128 (&key[nr]));
+  } else {
+    for (round = 1; round < nr; round++) {
+      state = _mm_aesdec_si128 (state, _mm_loadu_si128 (&key[round]));
+    }
+    state = _mm_aesdeclast_si128 (state, _mm_loadu_si128 (&key[nr]));
+  }
+  _mm_storeu_si128 ((__m128i *)output, state);
+}
+
+#elif defined(MBEDTLS_ACCEL_AARCH64)
+
+/**
+  AES block encryption or decryption with the ARMv8 AES extension.
+
+  AESE/AESD add the round key before the substitution step, so the last
+  round key is added separately.
+
+  @param  rk                           The round keys.
+  @param  nr                           The number of rounds.
+  @param  decrypt                      Non-zero to run the inverse cipher.
+  @param  input                        The input block.
+  @param  output                       The output block.
+**/
+MBEDTLS_ACCEL_TARGET_AES
+static void
+mbedtls_accel_aes_block_hw (
+  const uint32_t      *rk,
+  int                 nr,
+  int                 decrypt,
+  const unsigned char input[16],
+  unsigned char       output[16]
+  )
+{
+  const unsigned char *key;
+  uint8x16_t state;
+  int round;
+
+  key = (const unsigned char *)rk;
+  state = vld1q_u8 (input);
+  if (!decrypt) {
+    for (round = 0; round < nr - 1; round++) {
+      state = vaesmcq_u8 (vaeseq_u8 (state, vld1q_u8 (key + 16 * round)));
+    }
+    state = vaeseq_u8 (state, vld1q_u8 (key + 16 * (nr - 1)));
+  } else {
+    for (round = 0; round < nr - 1; round++) {
+      state = vaesimcq_u8 (vaesdq_u8 (state, vld1q_u8 (key + 16 * round)));
+    }
+    state = vaesdq_u8 (state, vld1q_u8 (key + 16 * (nr - 1)));
+  }
+  state = veorq_u8 (state, vld1q_u8 (key + 16 * nr));
+  vst1q_u8 (output, state);
+}
+
+#endif
+
+#if defined(MBEDTLS_AES_ENCRYPT_ALT)
+int
+mbedtls_internal_aes_encrypt (
+  mbedtls_aes_context *ctx,
+  const unsigned char input[16],
+  unsigned char       output[16]
+  )
+{
+  if ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_AES) != 0) {
+    mbedtls_accel_aes_block_hw (ctx->rk, ctx->nr, 0, input, output);
+  } else {
+    mbedtls_accel_aes_block_c (ctx->rk, ctx->nr, 0, input, output);
+  }
+  return 0;
+}
+#endif
+
+#if defined(MBEDTLS_AES_DECRYPT_ALT)
+int
+mbedtls_internal_aes_decrypt (
+  mbedtls_aes_context *ctx,
+  const unsigned char input[16],
+  unsigned char       output[16]
+  )
+{
+  if ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_AES) != 0) {
+    mbedtls_accel_aes_block_hw (ctx->rk, ctx->nr, 1, input, output);
+  } else {
+    mbedtls_accel_aes_block_c (ctx->rk, ctx->nr, 1, input, output);
+  }
+  return 0;
+}
+#endif
+
+#endif
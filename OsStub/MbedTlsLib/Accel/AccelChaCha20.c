@@ -0,0 +1,821 @@
+/** @file
+  ChaCha20 (RFC 8439) for MBEDTLS_CHACHA20_ALT.
+
+  The SIMD kernels compute several consecutive blocks at once: register i
+  holds word i of every block, so the quarter rounds are the scalar ones
+  applied lane-wise, and the lanes are transposed back into blocks when the
+  keystream is added to the input. SSE2 and NEON run four blocks, AVX2
+  eight, and the RISC-V vector kernel as many as the vector length allows,
+  up to eight. Remaining whole blocks and the final partial block use the
+  portable code.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "AccelInternal.h"
+
+#if defined(MBEDTLS_CHACHA20_C) && defined(MBEDTLS_CHACHA20_ALT)
+
+#include "mbedtls/chacha20.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_ACCEL_X86)
+#include <immintrin.h>
+#elif defined(MBEDTLS_ACCEL_NEON)
+#include <arm_neon.h>
+#elif defined(MBEDTLS_ACCEL_RVV)
+#include <riscv_vector.h>
+#endif
+
+#define CHACHA20_BLOCK_SIZE_BYTES  64
+#define CHACHA20_CTR_INDEX         12
+
+//
+// The quarter round and the double round, for any representation of the
+// sixteen state words x0 ... x15 that provides ADD, XOR and ROTL.
+//
+#define CHACHA20_QUARTER_ROUND(a, b, c, d)                                    \
+  do {                                                                        \
+    a = CHACHA20_ADD (a, b); d = CHACHA20_XOR (d, a); d = CHACHA20_ROTL (d, 16); \
+    c = CHACHA20_ADD (c, d); b = CHACHA20_XOR (b, c); b = CHACHA20_ROTL (b, 12); \
+    a = CHACHA20_ADD (a, b); d = CHACHA20_XOR (d, a); d = CHACHA20_ROTL (d, 8);  \
+    c = CHACHA20_ADD (c, d); b = CHACHA20_XOR (b, c); b = CHACHA20_ROTL (b, 7);  \
+  } while (0)
+
+#define CHACHA20_DOUBLE_ROUND()                                               \
+  do {                                                                        \
+    CHACHA20_QUARTER_ROUND (x0, x4, x8,  x12);                                \
+    CHACHA20_QUARTER_ROUND (x1, x5, x9,  x13);                                \
+    CHACHA20_QUARTER_ROUND (x2, x6, x10, x14);                                \
+    CHACHA20_QUARTER_ROUND (x3, x7, x11, x15);                                \
+    CHACHA20_QUARTER_ROUND (x0, x5, x10, x15);                                \
+    CHACHA20_QUARTER_ROUND (x1, x6, x11, x12);                                \
+    CHACHA20_QUARTER_ROUND (x2, x7, x8,  x13);                                \
+    CHACHA20_QUARTER_ROUND (x3, x4, x9,  x14);                                \
+  } while (0)
+
+static uint32_t
+mbedtls_accel_chacha20_load32 (
+  const unsigned char *p
+  )
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void
+mbedtls_accel_chacha20_store32 (
+  unsigned char *p,
+  uint32_t      v
+  )
+{
+  p[0] = (unsigned char)v;
+  p[1] = (unsigned char)(v >> 8);
+  p[2] = (unsigned char)(v >> 16);
+  p[3] = (unsigned char)(v >> 24);
+}
+
+/**
+  Portable ChaCha20 block function.
+
+  @param  state                        The state; the block counter is not advanced.
+  @param  keystream                    Receives the 64-byte keystream block.
+**/
+static void
+mbedtls_accel_chacha20_block (
+  const uint32_t state[16],
+  unsigned char  keystream[64]
+  )
+{
+  uint32_t x0;
+  uint32_t x1;
+  uint32_t x2;
+  uint32_t x3;
+  uint32_t x4;
+  uint32_t x5;
+  uint32_t x6;
+  uint32_t x7;
+  uint32_t x8;
+  uint32_t x9;
+  uint32_t x10;
+  uint32_t x11;
+  uint32_t x12;
+  uint32_t x13;
+  uint32_t x14;
+  uint32_t x15;
+  uint32_t i;
+
+  x0 = state[0];
+  x1 = state[1];
+  x2 = state[2];
+  x3 = state[3];
+  x4 = state[4];
+  x5 = state[5];
+  x6 = state[6];
+  x7 = state[7];
+  x8 = state[8];
+  x9 = state[9];
+  x10 = state[10];
+  x11 = state[11];
+  x12 = state[12];
+  x13 = state[13];
+  x14 = state[14];
+  x15 = state[15];
+
+#define CHACHA20_ADD(a, b)   ((a) + (b))
+#define CHACHA20_XOR(a, b)   ((a) ^ (b))
+#define CHACHA20_ROTL(a, n)  (((a) << (n)) | ((a) >> (32 - (n))))
+  for (i = 0; i < 10; i++) {
+    CHACHA20_DOUBLE_ROUND ();
+  }
+#undef CHACHA20_ADD
+#undef CHACHA20_XOR
+#undef CHACHA20_ROTL
+
+  mbedtls_accel_chacha20_store32 (keystream + 0, x0 + state[0]);
+  mbedtls_accel_chacha20_store32 (keystream + 4, x1 + state[1]);
+  mbedtls_accel_chacha20_store32 (keystream + 8, x2 + state[2]);
+  mbedtls_accel_chacha20_store32 (keystream + 12, x3 + state[3]);
+  mbedtls_accel_chacha20_store32 (keystream + 16, x4 + state[4]);
+  mbedtls_accel_chacha20_store32 (keystream + 20, x5 + state[5]);
+  mbedtls_accel_chacha20_store32 (keystream + 24, x6 + state[6]);
+  mbedtls_accel_chacha20_store32 (keystream + 28, x7 + state[7]);
+  mbedtls_accel_chacha20_store32 (keystream + 32, x8 + state[8]);
+  mbedtls_accel_chacha20_store32 (keystream + 36, x9 + state[9]);
+  mbedtls_accel_chacha20_store32 (keystream + 40, x10 + state[10]);
+  mbedtls_accel_chacha20_store32 (keystream + 44, x11 + state[11]);
+  mbedtls_accel_chacha20_store32 (keystream + 48, x12 + state[12]);
+  mbedtls_accel_chacha20_store32 (keystream + 52, x13 + state[13]);
+  mbedtls_accel_chacha20_store32 (keystream + 56, x14 + state[14]);
+  mbedtls_accel_chacha20_store32 (keystream + 60, x15 + state[15]);
+}
+
+#if defined(MBEDTLS_ACCEL_X86)
+
+//
+// Transpose words 4g ... 4g+3 of four blocks and add them to the input.
+//
+#define CHACHA20_SSE2_OUTPUT(g, a0, a1, a2, a3)                               \
+  do {                                                                        \
+    __m128i t0_ = _mm_unpacklo_epi32 (a0, a1);                                \
+    __m128i t1_ = _mm_unpackhi_epi32 (a0, a1);                                \
+    __m128i t2_ = _mm_unpacklo_epi32 (a2, a3);                                \
+    __m128i t3_ = _mm_unpackhi_epi32 (a2, a3);                                \
+    CHACHA20_SSE2_XOR_STORE (0, g, _mm_unpacklo_epi64 (t0_, t2_));            \
+    CHACHA20_SSE2_XOR_STORE (1, g, _mm_unpackhi_epi64 (t0_, t2_));            \
+    CHACHA20_SSE2_XOR_STORE (2, g, _mm_unpacklo_epi64 (t1_, t3_));            \
+    CHACHA20_SSE2_XOR_STORE (3, g, _mm_unpackhi_epi64 (t1_, t3_));            \
+  } while (0)
+
+#define CHACHA20_SSE2_XOR_STORE(k, g, v)                                      \
+  _mm_storeu_si128 ((__m128i *)(output + 64 * (k) + 16 * (g)),                \
+                    _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)(input + 64 * (k) + 16 * (g))), v))
+
+/**
+  ChaCha20 on four consecutive blocks with SSE2.
+
+  @param  state                        The state; the block counter is not advanced.
+  @param  input                        The 256 bytes of input.
+  @param  output                       The 256 bytes of output, may alias input.
+**/
+MBEDTLS_ACCEL_TARGET_SIMD
+static void
+mbedtls_accel_chacha20_x4_sse2 (
+  const uint32_t      state[16],
+  const unsigned char *input,
+  unsigned char       *output
+  )
+{
+  __m128i x0;
+  __m128i x1;
+  __m128i x2;
+  __m128i x3;
+  __m128i x4;
+  __m128i x5;
+  __m128i x6;
+  __m128i x7;
+  __m128i x8;
+  __m128i x9;
+  __m128i x10;
+  __m128i x11;
+  __m128i x12;
+  __m128i x13;
+  __m128i x14;
+  __m128i x15;
+  __m128i ctr;
+  uint32_t i;
+
+  ctr = _mm_add_epi32 (_mm_set1_epi32 ((int)state[12]), _mm_setr_epi32 (0, 1, 2, 3));
+  x0 = _mm_set1_epi32 ((int)state[0]);
+  x1 = _mm_set1_epi32 ((int)state[1]);
+  x2 = _mm_set1_epi32 ((int)state[2]);
+  x3 = _mm_set1_epi32 ((int)state[3]);
+  x4 = _mm_set1_epi32 ((int)state[4]);
+  x5 = _mm_set1_epi32 ((int)state[5]);
+  x6 = _mm_set1_epi32 ((int)state[6]);
+  x7 = _mm_set1_epi32 ((int)state[7]);
+  x8 = _mm_set1_epi32 ((int)state[8]);
+  x9 = _mm_set1_epi32 ((int)state[9]);
+  x10 = _mm_set1_epi32 ((int)state[10]);
+  x11 = _mm_set1_epi32 ((int)state[11]);
+  x12 = ctr;
+  x13 = _mm_set1_epi32 ((int)state[13]);
+  x14 = _mm_set1_epi32 ((int)state[14]);
+  x15 = _mm_set1_epi32 ((int)state[15]);
+
+#define CHACHA20_ADD(a, b)   _mm_add_epi32 (a, b)
+#define CHACHA20_XOR(a, b)   _mm_xor_si128 (a, b)
+#define CHACHA20_ROTL(a, n)  _mm_or_si128 (_mm_slli_epi32 (a, n), _mm_srli_epi32 (a, 32 - (n)))
+  for (i = 0; i < 10; i++) {
+    CHACHA20_DOUBLE_ROUND ();
+  }
+#undef CHACHA20_ADD
+#undef CHACHA20_XOR
+#undef CHACHA20_ROTL
+
+  x0 = _mm_add_epi32 (x0, _mm_set1_epi32 ((int)state[0]));
+  x1 = _mm_add_epi32 (x1, _mm_set1_epi32 ((int)state[1]));
+  x2 = _mm_add_epi32 (x2, _mm_set1_epi32 ((int)state[2]));
+  x3 = _mm_add_epi32 (x3, _mm_set1_epi32 ((int)state[3]));
+  x4 = _mm_add_epi32 (x4, _mm_set1_epi32 ((int)state[4]));
+  x5 = _mm_add_epi32 (x5, _mm_set1_epi32 ((int)state[5]));
+  x6 = _mm_add_epi32 (x6, _mm_set1_epi32 ((int)state[6]));
+  x7 = _mm_add_epi32 (x7, _mm_set1_epi32 ((int)state[7]));
+  x8 = _mm_add_epi32 (x8, _mm_set1_epi32 ((int)state[8]));
+  x9 = _mm_add_epi32 (x9, _mm_set1_epi32 ((int)state[9]));
+  x10 = _mm_add_epi32 (x10, _mm_set1_epi32 ((int)state[10]));
+  x11 = _mm_add_epi32 (x11, _mm_set1_epi32 ((int)state[11]));
+  x12 = _mm_add_epi32 (x12, ctr);
+  x13 = _mm_add_epi32 (x13, _mm_set1_epi32 ((int)state[13]));
+  x14 = _mm_add_epi32 (x14, _mm_set1_epi32 ((int)state[14]));
+  x15 = _mm_add_epi32 (x15, _mm_set1_epi32 ((int)state[15]));
+
+  CHACHA20_SSE2_OUTPUT (0, x0, x1, x2, x3);
+  CHACHA20_SSE2_OUTPUT (1, x4, x5, x6, x7);
+  CHACHA20_SSE2_OUTPUT (2, x8, x9, x10, x11);
+  CHACHA20_SSE2_OUTPUT (3, x12, x13, x14, x15);
+}
+
+//
+// Transpose words 4g ... 4g+7 of eight blocks and add them to the input.
+// After the in-lane transpose, the low 128 bits of b_k hold block k and the
+// high 128 bits block k+4; words 4g ... 4g+3 and 4g+4 ... 4g+7 of a block
+// are then joined into one 32-byte store.
+//
+#define CHACHA20_AVX2_OUTPUT(g, a0, a1, a2, a3, a4, a5, a6, a7)               \
+  do {                                                                        \
+    __m256i t0_ = _mm256_unpacklo_epi32 (a0, a1);                             \
+    __m256i t1_ = _mm256_unpackhi_epi32 (a0, a1);                             \
+    __m256i t2_ = _mm256_unpacklo_epi32 (a2, a3);                             \
+    __m256i t3_ = _mm256_unpackhi_epi32 (a2, a3);                             \
+    __m256i t4_ = _mm256_unpacklo_epi32 (a4, a5);                             \
+    __m256i t5_ = _mm256_unpackhi_epi32 (a4, a5);                             \
+    __m256i t6_ = _mm256_unpacklo_epi32 (a6, a7);                             \
+    __m256i t7_ = _mm256_unpackhi_epi32 (a6, a7);                             \
+    CHACHA20_AVX2_XOR_STORE (0, g, _mm256_unpacklo_epi64 (t0_, t2_), _mm256_unpacklo_epi64 (t4_, t6_)); \
+    CHACHA20_AVX2_XOR_STORE (1, g, _mm256_unpackhi_epi64 (t0_, t2_), _mm256_unpackhi_epi64 (t4_, t6_)); \
+    CHACHA20_AVX2_XOR_STORE (2, g, _mm256_unpacklo_epi64 (t1_, t3_), _mm256_unpacklo_epi64 (t5_, t7_)); \
+    CHACHA20_AVX2_XOR_STORE (3, g, _mm256_unpackhi_epi64 (t1_, t3_), _mm256_unpackhi_epi64 (t5_, t7_)); \
+  } while (0)
+
+#define CHACHA20_AVX2_XOR_STORE(k, g, lo, hi)                                 \
+  do {                                                                        \
+    __m256i v0_ = _mm256_permute2x128_si256 (lo, hi, 0x20);                   \
+    __m256i v1_ = _mm256_permute2x128_si256 (lo, hi, 0x31);                   \
+    _mm256_storeu_si256 ((__m256i *)(output + 64 * (k) + 16 * (g)),           \
+                         _mm256_xor_si256 (_mm256_loadu_si256 ((const __m256i *)(input + 64 * (k) + 16 * (g))), v0_)); \
+    _mm256_storeu_si256 ((__m256i *)(output + 64 * ((k) + 4) + 16 * (g)),     \
+                         _mm256_xor_si256 (_mm256_loadu_si256 ((const __m256i *)(input + 64 * ((k) + 4) + 16 * (g))), v1_)); \
+  } while (0)
+
+/**
+  ChaCha20 on eight consecutive blocks with AVX2.
+
+  @param  state                        The state; the block counter is not advanced.
+  @param  input                        The 512 bytes of input.
+  @param  output                       The 512 bytes of output, may alias input.
+**/
+MBEDTLS_ACCEL_TARGET_AVX2
+static void
+mbedtls_accel_chacha20_x8_avx2 (
+  const uint32_t      state[16],
+  const unsigned char *input,
+  unsigned char       *output
+  )
+{
+  const __m256i rot16 = _mm256_setr_epi8 (2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                          2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+  const __m256i rot8 = _mm256_setr_epi8 (3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                         3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+  __m256i x0;
+  __m256i x1;
+  __m256i x2;
+  __m256i x3;
+  __m256i x4;
+  __m256i x5;
+  __m256i x6;
+  __m256i x7;
+  __m256i x8;
+  __m256i x9;
+  __m256i x10;
+  __m256i x11;
+  __m256i x12;
+  __m256i x13;
+  __m256i x14;
+  __m256i x15;
+  __m256i ctr;
+  uint32_t i;
+
+  ctr = _mm256_add_epi32 (_mm256_set1_epi32 ((int)state[12]), _mm256_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7));
+  x0 = _mm256_set1_epi32 ((int)state[0]);
+  x1 = _mm256_set1_epi32 ((int)state[1]);
+  x2 = _mm256_set1_epi32 ((int)state[2]);
+  x3 = _mm256_set1_epi32 ((int)state[3]);
+  x4 = _mm256_set1_epi32 ((int)state[4]);
+  x5 = _mm256_set1_epi32 ((int)state[5]);
+  x6 = _mm256_set1_epi32 ((int)state[6]);
+  x7 = _mm256_set1_epi32 ((int)state[7]);
+  x8 = _mm256_set1_epi32 ((int)state[8]);
+  x9 = _mm256_set1_epi32 ((int)state[9]);
+  x10 = _mm256_set1_epi32 ((int)state[10]);
+  x11 = _mm256_set1_epi32 ((int)state[11]);
+  x12 = ctr;
+  x13 = _mm256_set1_epi32 ((int)state[13]);
+  x14 = _mm256_set1_epi32 ((int)state[14]);
+  x15 = _mm256_set1_epi32 ((int)state[15]);
+
+#define CHACHA20_ADD(a, b)   _mm256_add_epi32 (a, b)
+#define CHACHA20_XOR(a, b)   _mm256_xor_si256 (a, b)
+#define CHACHA20_ROTL(a, n)                                                   \
+  ((n) == 16 ? _mm256_shuffle_epi8 (a, rot16) :                               \
+   (n) == 8 ? _mm256_shuffle_epi8 (a, rot8) :                                 \
+   _mm256_or_si256 (_mm256_slli_epi32 (a, n), _mm256_srli_epi32 (a, 32 - (n))))
+  for (i = 0; i < 10; i++) {
+    CHACHA20_DOUBLE_ROUND ();
+  }
+#undef CHACHA20_ADD
+#undef CHACHA20_XOR
+#undef CHACHA20_ROTL
+
+  x0 = _mm256_add_epi32 (x0, _mm256_set1_epi32 ((int)state[0]));
+  x1 = _mm256_add_epi32 (x1, _mm256_set1_epi32 ((int)state[1]));
+  x2 = _mm256_add_epi32 (x2, _mm256_set1_epi32 ((int)state[2]));
+  x3 = _mm256_add_epi32 (x3, _mm256_set1_epi32 ((int)state[3]));
+  x4 = _mm256_add_epi32 (x4, _mm256_set1_epi32 ((int)state[4]));
+  x5 = _mm256_add_epi32 (x5, _mm256_set1_epi32 ((int)state[5]));
+  x6 = _mm256_add_epi32 (x6, _mm256_set1_epi32 ((int)state[6]));
+  x7 = _mm256_add_epi32 (x7, _mm256_set1_epi32 ((int)state[7]));
+  x8 = _mm256_add_epi32 (x8, _mm256_set1_epi32 ((int)state[8]));
+  x9 = _mm256_add_epi32 (x9, _mm256_set1_epi32 ((int)state[9]));
+  x10 = _mm256_add_epi32 (x10, _mm256_set1_epi32 ((int)state[10]));
+  x11 = _mm256_add_epi32 (x11, _mm256_set1_epi32 ((int)state[11]));
+  x12 = _mm256_add_epi32 (x12, ctr);
+  x13 = _mm256_add_epi32 (x13, _mm256_set1_epi32 ((int)state[13]));
+  x14 = _mm256_add_epi32 (x14, _mm256_set1_epi32 ((int)state[14]));
+  x15 = _mm256_add_epi32 (x15, _mm256_set1_epi32 ((int)state[15]));
+
+  CHACHA20_AVX2_OUTPUT (0, x0, x1, x2, x3, x4, x5, x6, x7);
+  CHACHA20_AVX2_OUTPUT (2, x8, x9, x10, x11, x12, x13, x14, x15);
+}
+
+#elif defined(MBEDTLS_ACCEL_NEON)
+
+//
+// Transpose words 4g ... 4g+3 of four blocks and add them to the input.
+//
+#define CHACHA20_NEON_OUTPUT(g, a0, a1, a2, a3)                               \
+  do {                                                                        \
+    uint32x4x2_t t01_ = vtrnq_u32 (a0, a1);                                   \
+    uint32x4x2_t t23_ = vtrnq_u32 (a2, a3);                                   \
+    CHACHA20_NEON_XOR_STORE (0, g, vcombine_u32 (vget_low_u32 (t01_.val[0]), vget_low_u32 (t23_.val[0])));   \
+    CHACHA20_NEON_XOR_STORE (1, g, vcombine_u32 (vget_low_u32 (t01_.val[1]), vget_low_u32 (t23_.val[1])));   \
+    CHACHA20_NEON_XOR_STORE (2, g, vcombine_u32 (vget_high_u32 (t01_.val[0]), vget_high_u32 (t23_.val[0]))); \
+    CHACHA20_NEON_XOR_STORE (3, g, vcombine_u32 (vget_high_u32 (t01_.val[1]), vget_high_u32 (t23_.val[1]))); \
+  } while (0)
+
+#define CHACHA20_NEON_XOR_STORE(k, g, v)                                      \
+  vst1q_u8 (output + 64 * (k) + 16 * (g),                                     \
+            veorq_u8 (vld1q_u8 (input + 64 * (k) + 16 * (g)), vreinterpretq_u8_u32 (v)))
+
+/**
+  ChaCha20 on four consecutive blocks with NEON.
+
+  @param  state                        The state; the block counter is not advanced.
+  @param  input                        The 256 bytes of input.
+  @param  output                       The 256 bytes of output, may alias input.
+**/
+static void
+mbedtls_accel_chacha20_x4_neon (
+  const uint32_t      state[16],
+  const unsigned char *input,
+  unsigned char       *output
+  )
+{
+  static const uint32_t lanes[4] = { 0, 1, 2, 3 };
+  uint32x4_t x0;
+  uint32x4_t x1;
+  uint32x4_t x2;
+  uint32x4_t x3;
+  uint32x4_t x4;
+  uint32x4_t x5;
+  uint32x4_t x6;
+  uint32x4_t x7;
+  uint32x4_t x8;
+  uint32x4_t x9;
+  uint32x4_t x10;
+  uint32x4_t x11;
+  uint32x4_t x12;
+  uint32x4_t x13;
+  uint32x4_t x14;
+  uint32x4_t x15;
+  uint32x4_t ctr;
+  uint32_t i;
+
+  ctr = vaddq_u32 (vdupq_n_u32 (state[12]), vld1q_u32 (lanes));
+  x0 = vdupq_n_u32 (state[0]);
+  x1 = vdupq_n_u32 (state[1]);
+  x2 = vdupq_n_u32 (state[2]);
+  x3 = vdupq_n_u32 (state[3]);
+  x4 = vdupq_n_u32 (state[4]);
+  x5 = vdupq_n_u32 (state[5]);
+  x6 = vdupq_n_u32 (state[6]);
+  x7 = vdupq_n_u32 (state[7]);
+  x8 = vdupq_n_u32 (state[8]);
+  x9 = vdupq_n_u32 (state[9]);
+  x10 = vdupq_n_u32 (state[10]);
+  x11 = vdupq_n_u32 (state[11]);
+  x12 = ctr;
+  x13 = vdupq_n_u32 (state[13]);
+  x14 = vdupq_n_u32 (state[14]);
+  x15 = vdupq_n_u32 (state[15]);
+
+#define CHACHA20_ADD(a, b)   vaddq_u32 (a, b)
+#define CHACHA20_XOR(a, b)   veorq_u32 (a, b)
+#define CHACHA20_ROTL(a, n)                                                   \
+  ((n) == 16 ? vreinterpretq_u32_u16 (vrev32q_u16 (vreinterpretq_u16_u32 (a))) : \
+   vsriq_n_u32 (vshlq_n_u32 (a, n), a, 32 - (n)))
+  for (i = 0; i < 10; i++) {
+    CHACHA20_DOUBLE_ROUND ();
+  }
+#undef CHACHA20_ADD
+#undef CHACHA20_XOR
+#undef CHACHA20_ROTL
+
+  x0 = vaddq_u32 (x0, vdupq_n_u32 (state[0]));
+  x1 = vaddq_u32 (x1, vdupq_n_u32 (state[1]));
+  x2 = vaddq_u32 (x2, vdupq_n_u32 (state[2]));
+  x3 = vaddq_u32 (x3, vdupq_n_u32 (state[3]));
+  x4 = vaddq_u32 (x4, vdupq_n_u32 (state[4]));
+  x5 = vaddq_u32 (x5, vdupq_n_u32 (state[5]));
+  x6 = vaddq_u32 (x6, vdupq_n_u32 (state[6]));
+  x7 = vaddq_u32 (x7, vdupq_n_u32 (state[7]));
+  x8 = vaddq_u32 (x8, vdupq_n_u32 (state[8]));
+  x9 = vaddq_u32 (x9, vdupq_n_u32 (state[9]));
+  x10 = vaddq_u32 (x10, vdupq_n_u32 (state[10]));
+  x11 = vaddq_u32 (x11, vdupq_n_u32 (state[11]));
+  x12 = vaddq_u32 (x12, ctr);
+  x13 = vaddq_u32 (x13, vdupq_n_u32 (state[13]));
+  x14 = vaddq_u32 (x14, vdupq_n_u32 (state[14]));
+  x15 = vaddq_u32 (x15, vdupq_n_u32 (state[15]));
+
+  CHACHA20_NEON_OUTPUT (0, x0, x1, x2, x3);
+  CHACHA20_NEON_OUTPUT (1, x4, x5, x6, x7);
+  CHACHA20_NEON_OUTPUT (2, x8, x9, x10, x11);
+  CHACHA20_NEON_OUTPUT (3, x12, x13, x14, x15);
+}
+
+#elif defined(MBEDTLS_ACCEL_RVV)
+
+/**
+  ChaCha20 on up to eight consecutive blocks with the RISC-V vector extension.
+
+  The keystream is scattered into blocks with strided stores to an aligned
+  buffer, then added to the input bytewise, since vector word accesses to
+  unaligned buffers may trap.
+
+  @param  state                        The state; the block counter is not advanced.
+  @param  input                        The input, blocks * 64 bytes.
+  @param  output                       The output, may alias input.
+  @param  blocks                       The number of blocks available.
+
+  @return the number of blocks processed, at least one.
+**/
+static size_t
+mbedtls_accel_chacha20_rvv (
+  const uint32_t      state[16],
+  const unsigned char *input,
+  unsigned char       *output,
+  size_t              blocks
+  )
+{
+  uint32_t keystream[16 * 8];
+  vuint32m1_t x0;
+  vuint32m1_t x1;
+  vuint32m1_t x2;
+  vuint32m1_t x3;
+  vuint32m1_t x4;
+  vuint32m1_t x5;
+  vuint32m1_t x6;
+  vuint32m1_t x7;
+  vuint32m1_t x8;
+  vuint32m1_t x9;
+  vuint32m1_t x10;
+  vuint32m1_t x11;
+  vuint32m1_t x12;
+  vuint32m1_t x13;
+  vuint32m1_t x14;
+  vuint32m1_t x15;
+  vuint8m8_t data;
+  size_t vl;
+  size_t bytes;
+  size_t offset;
+  size_t n;
+  uint32_t i;
+
+  vl = __riscv_vsetvl_e32m1 (blocks < 8 ? blocks : 8);
+
+  x0 = __riscv_vmv_v_x_u32m1 (state[0], vl);
+  x1 = __riscv_vmv_v_x_u32m1 (state[1], vl);
+  x2 = __riscv_vmv_v_x_u32m1 (state[2], vl);
+  x3 = __riscv_vmv_v_x_u32m1 (state[3], vl);
+  x4 = __riscv_vmv_v_x_u32m1 (state[4], vl);
+  x5 = __riscv_vmv_v_x_u32m1 (state[5], vl);
+  x6 = __riscv_vmv_v_x_u32m1 (state[6], vl);
+  x7 = __riscv_vmv_v_x_u32m1 (state[7], vl);
+  x8 = __riscv_vmv_v_x_u32m1 (state[8], vl);
+  x9 = __riscv_vmv_v_x_u32m1 (state[9], vl);
+  x10 = __riscv_vmv_v_x_u32m1 (state[10], vl);
+  x11 = __riscv_vmv_v_x_u32m1 (state[11], vl);
+  x12 = __riscv_vadd_vx_u32m1 (__riscv_vid_v_u32m1 (vl), state[12], vl);
+  x13 = __riscv_vmv_v_x_u32m1 (state[13], vl);
+  x14 = __riscv_vmv_v_x_u32m1 (state[14], vl);
+  x15 = __riscv_vmv_v_x_u32m1 (state[15], vl);
+
+#define CHACHA20_ADD(a, b)   __riscv_vadd_vv_u32m1 (a, b, vl)
+#define CHACHA20_XOR(a, b)   __riscv_vxor_vv_u32m1 (a, b, vl)
+#define CHACHA20_ROTL(a, n)  __riscv_vor_vv_u32m1 (__riscv_vsll_vx_u32m1 (a, n, vl), __riscv_vsrl_vx_u32m1 (a, 32 - (n), vl), vl)
+  for (i = 0; i < 10; i++) {
+    CHACHA20_DOUBLE_ROUND ();
+  }
+#undef CHACHA20_ADD
+#undef CHACHA20_XOR
+#undef CHACHA20_ROTL
+
+#define CHACHA20_RVV_STORE(w, x, add)                                         \
+  __riscv_vsse32_v_u32m1 (&keystream[w], CHACHA20_BLOCK_SIZE_BYTES, __riscv_vadd_vv_u32m1 (x, add, vl), vl)
+  CHACHA20_RVV_STORE (0, x0, __riscv_vmv_v_x_u32m1 (state[0], vl));
+  CHACHA20_RVV_STORE (1, x1, __riscv_vmv_v_x_u32m1 (state[1], vl));
+  CHACHA20_RVV_STORE (2, x2, __riscv_vmv_v_x_u32m1 (state[2], vl));
+  CHACHA20_RVV_STORE (3, x3, __riscv_vmv_v_x_u32m1 (state[3], vl));
+  CHACHA20_RVV_STORE (4, x4, __riscv_vmv_v_x_u32m1 (state[4], vl));
+  CHACHA20_RVV_STORE (5, x5, __riscv_vmv_v_x_u32m1 (state[5], vl));
+  CHACHA20_RVV_STORE (6, x6, __riscv_vmv_v_x_u32m1 (state[6], vl));
+  CHACHA20_RVV_STORE (7, x7, __riscv_vmv_v_x_u32m1 (state[7], vl));
+  CHACHA20_RVV_STORE (8, x8, __riscv_vmv_v_x_u32m1 (state[8], vl));
+  CHACHA20_RVV_STORE (9, x9, __riscv_vmv_v_x_u32m1 (state[9], vl));
+  CHACHA20_RVV_STORE (10, x10, __riscv_vmv_v_x_u32m1 (state[10], vl));
+  CHACHA20_RVV_STORE (11, x11, __riscv_vmv_v_x_u32m1 (state[11], vl));
+  CHACHA20_RVV_STORE (12, x12, __riscv_vadd_vx_u32m1 (__riscv_vid_v_u32m1 (vl), state[12], vl));
+  CHACHA20_RVV_STORE (13, x13, __riscv_vmv_v_x_u32m1 (state[13], vl));
+  CHACHA20_RVV_STORE (14, x14, __riscv_vmv_v_x_u32m1 (state[14], vl));
+  CHACHA20_RVV_STORE (15, x15, __riscv_vmv_v_x_u32m1 (state[15], vl));
+#undef CHACHA20_RVV_STORE
+
+  bytes = vl * CHACHA20_BLOCK_SIZE_BYTES;
+  for (offset = 0; offset < bytes; offset += n) {
+    n = __riscv_vsetvl_e8m8 (bytes - offset);
+    data = __riscv_vxor_vv_u8m8 (__riscv_vle8_v_u8m8 (input + offset, n),
+                                 __riscv_vle8_v_u8m8 ((const uint8_t *)keystream + offset, n), n);
+    __riscv_vse8_v_u8m8 (output + offset, data, n);
+  }
+
+  mbedtls_platform_zeroize (keystream, sizeof(keystream));
+  return vl;
+}
+
+#endif
+
+/**
+  Add the keystream of whole blocks to the input and advance the block counter.
+
+  @param  state                        The state.
+  @param  input                        The input, blocks * 64 bytes.
+  @param  output                       The output, may alias input.
+  @param  blocks                       The number of blocks.
+**/
+static void
+mbedtls_accel_chacha20_xor_blocks (
+  uint32_t            state[16],
+  const unsigned char *input,
+  unsigned char       *output,
+  size_t              blocks
+  )
+{
+  unsigned char keystream[CHACHA20_BLOCK_SIZE_BYTES];
+  size_t i;
+
+#if defined(MBEDTLS_ACCEL_X86)
+  if ((blocks >= 8) && ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_AVX2) != 0)) {
+    while (blocks >= 8) {
+      mbedtls_accel_chacha20_x8_avx2 (state, input, output);
+      state[CHACHA20_CTR_INDEX] += 8;
+      input += 8 * CHACHA20_BLOCK_SIZE_BYTES;
+      output += 8 * CHACHA20_BLOCK_SIZE_BYTES;
+      blocks -= 8;
+    }
+  }
+  if ((blocks >= 4) && ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_SIMD) != 0)) {
+    while (blocks >= 4) {
+      mbedtls_accel_chacha20_x4_sse2 (state, input, output);
+      state[CHACHA20_CTR_INDEX] += 4;
+      input += 4 * CHACHA20_BLOCK_SIZE_BYTES;
+      output += 4 * CHACHA20_BLOCK_SIZE_BYTES;
+      blocks -= 4;
+    }
+  }
+#elif defined(MBEDTLS_ACCEL_NEON)
+  if ((blocks >= 4) && ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_SIMD) != 0)) {
+    while (blocks >= 4) {
+      mbedtls_accel_chacha20_x4_neon (state, input, output);
+      state[CHACHA20_CTR_INDEX] += 4;
+      input += 4 * CHACHA20_BLOCK_SIZE_BYTES;
+      output += 4 * CHACHA20_BLOCK_SIZE_BYTES;
+      blocks -= 4;
+    }
+  }
+#elif defined(MBEDTLS_ACCEL_RVV)
+  if ((blocks >= 2) && ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_SIMD) != 0)) {
+    while (blocks >= 2) {
+      size_t done;
+
+      done = mbedtls_accel_chacha20_rvv (state, input, output, blocks);
+      state[CHACHA20_CTR_INDEX] += (uint32_t)done;
+      input += done * CHACHA20_BLOCK_SIZE_BYTES;
+      output += done * CHACHA20_BLOCK_SIZE_BYTES;
+      blocks -= done;
+    }
+  }
+#endif
+
+  while (blocks > 0) {
+    mbedtls_accel_chacha20_block (state, keystream);
+    state[CHACHA20_CTR_INDEX]++;
+    for (i = 0; i < CHACHA20_BLOCK_SIZE_BYTES; i++) {
+      output[i] = input[i] ^ keystream[i];
+    }
+    input += CHACHA20_BLOCK_SIZE_BYTES;
+    output += CHACHA20_BLOCK_SIZE_BYTES;
+    blocks--;
+  }
+
+  mbedtls_platform_zeroize (keystream, sizeof(keystream));
+}
+
+void
+mbedtls_chacha20_init (
+  mbedtls_chacha20_context *ctx
+  )
+{
+  mbedtls_platform_zeroize (ctx->state, sizeof(ctx->state));
+  mbedtls_platform_zeroize (ctx->keystream8, sizeof(ctx->keystream8));
+
+  //
+  // Initially, there's no keystream bytes available.
+  //
+  ctx->keystream_bytes_used = CHACHA20_BLOCK_SIZE_BYTES;
+}
+
+void
+mbedtls_chacha20_free (
+  mbedtls_chacha20_context *ctx
+  )
+{
+  if (ctx != NULL) {
+    mbedtls_platform_zeroize (ctx, sizeof(mbedtls_chacha20_context));
+  }
+}
+
+int
+mbedtls_chacha20_setkey (
+  mbedtls_chacha20_context *ctx,
+  const unsigned char      key[32]
+  )
+{
+  uint32_t i;
+
+  //
+  // "expand 32-byte k"
+  //
+  ctx->state[0] = 0x61707865;
+  ctx->state[1] = 0x3320646e;
+  ctx->state[2] = 0x79622d32;
+  ctx->state[3] = 0x6b206574;
+  for (i = 0; i < 8; i++) {
+    ctx->state[4 + i] = mbedtls_accel_chacha20_load32 (key + 4 * i);
+  }
+
+  return 0;
+}
+
+int
+mbedtls_chacha20_starts (
+  mbedtls_chacha20_context *ctx,
+  const unsigned char      nonce[12],
+  uint32_t                 counter
+  )
+{
+  ctx->state[12] = counter;
+  ctx->state[13] = mbedtls_accel_chacha20_load32 (nonce);
+  ctx->state[14] = mbedtls_accel_chacha20_load32 (nonce + 4);
+  ctx->state[15] = mbedtls_accel_chacha20_load32 (nonce + 8);
+
+  mbedtls_platform_zeroize (ctx->keystream8, sizeof(ctx->keystream8));
+
+  //
+  // Initially, there's no keystream bytes available.
+  //
+  ctx->keystream_bytes_used = CHACHA20_BLOCK_SIZE_BYTES;
+
+  return 0;
+}
+
+int
+mbedtls_chacha20_update (
+  mbedtls_chacha20_context *ctx,
+  size_t                   size,
+  const unsigned char      *input,
+  unsigned char            *output
+  )
+{
+  size_t offset;
+  size_t blocks;
+  size_t i;
+
+  offset = 0;
+
+  //
+  // Use leftover keystream bytes, if available.
+  //
+  while ((size > 0) && (ctx->keystream_bytes_used < CHACHA20_BLOCK_SIZE_BYTES)) {
+    output[offset] = input[offset] ^ ctx->keystream8[ctx->keystream_bytes_used];
+    ctx->keystream_bytes_used++;
+    offset++;
+    size--;
+  }
+
+  blocks = size / CHACHA20_BLOCK_SIZE_BYTES;
+  if (blocks > 0) {
+    mbedtls_accel_chacha20_xor_blocks (ctx->state, input + offset, output + offset, blocks);
+    offset += blocks * CHACHA20_BLOCK_SIZE_BYTES;
+    size -= blocks * CHACHA20_BLOCK_SIZE_BYTES;
+  }
+
+  //
+  // Last (partial) block.
+  //
+  if (size > 0) {
+    mbedtls_accel_chacha20_block (ctx->state, ctx->keystream8);
+    ctx->state[CHACHA20_CTR_INDEX]++;
+    for (i = 0; i < size; i++) {
+      output[offset + i] = input[offset + i] ^ ctx->keystream8[i];
+    }
+    ctx->keystream_bytes_used = size;
+  }
+
+  return 0;
+}
+
+int
+mbedtls_chacha20_crypt (
+  const unsigned char key[32],
+  const unsigned char nonce[12],
+  uint32_t            counter,
+  size_t              data_len,
+  const unsigned char *input,
+  unsigned char       *output
+  )
+{
+  mbedtls_chacha20_context ctx;
+  int ret;
+
+  mbedtls_chacha20_init (&ctx);
+
+  ret = mbedtls_chacha20_setkey (&ctx, key);
+  if (ret != 0) {
+    goto cleanup;
+  }
+  ret = mbedtls_chacha20_starts (&ctx, nonce, counter);
+  if (ret != 0) {
+    goto cleanup;
+  }
+  ret = mbedtls_chacha20_update (&ctx, data_len, input, output);
+
+cleanup:
+  mbedtls_chacha20_free (&ctx);
+  return ret;
+}
+
+#endif
@@ -0,0 +1,261 @@
+/** @file
+  Runtime CPU feature detection for the MbedTLS hardware acceleration kernels.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "AccelInternal.h"
+
+#if defined(MBEDTLS_ACCEL_X86) || defined(MBEDTLS_ACCEL_AARCH64) || \
+    defined(MBEDTLS_ACCEL_ARM) || defined(MBEDTLS_ACCEL_RISCV)
+
+#if defined(MBEDTLS_ACCEL_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+static unsigned int mbedtls_accel_features;
+static int mbedtls_accel_features_done;
+
+#if defined(MBEDTLS_ACCEL_X86)
+
+/**
+  Execute CPUID.
+
+  @param  leaf                         The CPUID leaf (EAX).
+  @param  subleaf                      The CPUID subleaf (ECX).
+  @param  regs                         Receives EAX, EBX, ECX and EDX.
+**/
+static void
+mbedtls_accel_cpuid (
+  unsigned int leaf,
+  unsigned int subleaf,
+  unsigned int regs[4]
+  )
+{
+#if defined(_MSC_VER)
+  int info[4];
+
+  __cpuidex (info, (int)leaf, (int)subleaf);
+  regs[0] = (unsigned int)info[0];
+  regs[1] = (unsigned int)info[1];
+  regs[2] = (unsigned int)info[2];
+  regs[3] = (unsigned int)info[3];
+#else
+  __cpuid_count (leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/**
+  Read XCR0, the register state the OS saves on a context switch.
+
+  @return XCR0.
+**/
+static uint64_t
+mbedtls_accel_xgetbv (
+  void
+  )
+{
+#if defined(_MSC_VER)
+  return _xgetbv (0);
+#else
+  uint32_t eax;
+  uint32_t edx;
+
+  __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+  return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+static unsigned int
+mbedtls_accel_query_cpu (
+  void
+  )
+{
+  unsigned int regs[4];
+  unsigned int max_leaf;
+  unsigned int leaf1_ecx;
+  unsigned int leaf7_ebx;
+  unsigned int features;
+
+  features = 0;
+
+  mbedtls_accel_cpuid (0, 0, regs);
+  max_leaf = regs[0];
+  if (max_leaf < 1) {
+    return 0;
+  }
+
+  mbedtls_accel_cpuid (1, 0, regs);
+  leaf1_ecx = regs[2];
+  if ((regs[3] & (1u << 26)) != 0) {
+    features |= MBEDTLS_ACCEL_CPU_SIMD;
+  }
+  leaf7_ebx = 0;
+  if (max_leaf >= 7) {
+    mbedtls_accel_cpuid (7, 0, regs);
+    leaf7_ebx = regs[1];
+  }
+
+  //
+  // AVX2 also needs the OS to save the YMM registers (OSXSAVE, XCR0 bits 1-2).
+  //
+  if (((leaf1_ecx & (1u << 27)) != 0) && ((leaf1_ecx & (1u << 28)) != 0) &&
+      ((mbedtls_accel_xgetbv () & 0x6) == 0x6) && ((leaf7_ebx & (1u << 5)) != 0)) {
+    features |= MBEDTLS_ACCEL_CPU_AVX2;
+  }
+
+  //
+  // The AES, GHASH and SHA kernels need SSSE3 for the byte shuffles.
+  //
+  if ((leaf1_ecx & (1u << 9)) == 0) {
+    return features;
+  }
+  if ((leaf1_ecx & (1u << 25)) != 0) {
+    features |= MBEDTLS_ACCEL_CPU_AES;
+  }
+  if ((leaf1_ecx & (1u << 1)) != 0) {
+    features |= MBEDTLS_ACCEL_CPU_CLMUL;
+  }
+  if (((leaf1_ecx & (1u << 19)) != 0) && ((leaf7_ebx & (1u << 29)) != 0)) {
+    features |= MBEDTLS_ACCEL_CPU_SHA256;
+  }
+
+  return features;
+}
+
+#elif defined(MBEDTLS_ACCEL_AARCH64)
+
+#if defined(__linux__)
+#ifndef HWCAP_AES
+#define HWCAP_AES     (1 << 3)
+#endif
+#ifndef HWCAP_PMULL
+#define HWCAP_PMULL   (1 << 4)
+#endif
+#ifndef HWCAP_SHA2
+#define HWCAP_SHA2    (1 << 6)
+#endif
+#ifndef HWCAP_SHA512
+#define HWCAP_SHA512  (1 << 21)
+#endif
+#endif
+
+static unsigned int
+mbedtls_accel_query_cpu (
+  void
+  )
+{
+  unsigned int features;
+
+  //
+  // Advanced SIMD is mandatory in AArch64.
+  //
+  features = MBEDTLS_ACCEL_CPU_SIMD;
+
+#if defined(__linux__)
+  {
+    unsigned long hwcap;
+
+    hwcap = getauxval (AT_HWCAP);
+    if ((hwcap & HWCAP_AES) != 0) {
+      features |= MBEDTLS_ACCEL_CPU_AES;
+    }
+    if ((hwcap & HWCAP_PMULL) != 0) {
+      features |= MBEDTLS_ACCEL_CPU_CLMUL;
+    }
+    if ((hwcap & HWCAP_SHA2) != 0) {
+      features |= MBEDTLS_ACCEL_CPU_SHA256;
+    }
+    if ((hwcap & HWCAP_SHA512) != 0) {
+      features |= MBEDTLS_ACCEL_CPU_SHA512;
+    }
+  }
+#else
+  //
+  // Without an OS interface, trust what the compiler was told about the target.
+  //
+#if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES)
+  features |= MBEDTLS_ACCEL_CPU_AES | MBEDTLS_ACCEL_CPU_CLMUL;
+#endif
+#if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2)
+  features |= MBEDTLS_ACCEL_CPU_SHA256;
+#endif
+#if defined(__ARM_FEATURE_SHA512)
+  features |= MBEDTLS_ACCEL_CPU_SHA512;
+#endif
+#endif
+
+  return features;
+}
+
+#else
+
+#if defined(__linux__)
+#if defined(MBEDTLS_ACCEL_ARM) && !defined(HWCAP_NEON)
+#define HWCAP_NEON    (1 << 12)
+#endif
+#if defined(MBEDTLS_ACCEL_RISCV) && !defined(COMPAT_HWCAP_ISA_V)
+#define COMPAT_HWCAP_ISA_V  (1 << ('V' - 'A'))
+#endif
+#endif
+
+static unsigned int
+mbedtls_accel_query_cpu (
+  void
+  )
+{
+  unsigned int features;
+
+  features = 0;
+
+  //
+  // The SIMD kernels are only built when the compiler targets NEON or the
+  // vector extension; the OS can still tell that the CPU lacks them.
+  //
+#if defined(MBEDTLS_ACCEL_NEON) || defined(MBEDTLS_ACCEL_RVV)
+  features |= MBEDTLS_ACCEL_CPU_SIMD;
+#if defined(__linux__)
+  {
+    unsigned long hwcap;
+
+    hwcap = getauxval (AT_HWCAP);
+#if defined(MBEDTLS_ACCEL_ARM)
+    if ((hwcap & HWCAP_NEON) == 0) {
+#else
+    if ((hwcap & COMPAT_HWCAP_ISA_V) == 0) {
+#endif
+      features &= ~MBEDTLS_ACCEL_CPU_SIMD;
+    }
+  }
+#endif
+#endif
+
+  return features;
+}
+
+#endif
+
+unsigned int
+mbedtls_accel_cpu_features (
+  void
+  )
+{
+  //
+  // Racing callers compute the same value, so no lock is needed.
+  //
+  if (!mbedtls_accel_features_done) {
+    mbedtls_accel_features = mbedtls_accel_query_cpu ();
+    mbedtls_accel_features_done = 1;
+  }
+  return mbedtls_accel_features;
+}
+
+#endif
@@ -0,0 +1,655 @@
+/** @file
+  GCM for MBEDTLS_GCM_ALT.
+
+  The mode handling follows the generic MbedTLS gcm.c. The GHASH multiply
+  uses PCLMULQDQ or the ARMv8 PMULL instruction when the CPU has it, and the
+  4-bit table method of the generic code otherwise.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "AccelInternal.h"
+
+#if defined(MBEDTLS_GCM_C) && defined(MBEDTLS_GCM_ALT)
+
+#include "mbedtls/gcm.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_ACCEL_X86)
+#include <immintrin.h>
+#elif defined(MBEDTLS_ACCEL_AARCH64)
+#include <arm_neon.h>
+#endif
+
+static uint32_t
+mbedtls_accel_gcm_load32_be (
+  const unsigned char *p
+  )
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void
+mbedtls_accel_gcm_store32_be (
+  unsigned char *p,
+  uint32_t      v
+  )
+{
+  p[0] = (unsigned char)(v >> 24);
+  p[1] = (unsigned char)(v >> 16);
+  p[2] = (unsigned char)(v >> 8);
+  p[3] = (unsigned char)v;
+}
+
+static unsigned char
+mbedtls_accel_gcm_rbit8 (
+  unsigned char b
+  )
+{
+  b = (unsigned char)(((b & 0xF0) >> 4) | ((b & 0x0F) << 4));
+  b = (unsigned char)(((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+  b = (unsigned char)(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+  return b;
+}
+
+/**
+  Precompute the 4-bit multiplication table of the portable code from H.
+
+  @param  ctx                          The GCM context.
+  @param  h                            The hash subkey H = E(K, 0^128).
+**/
+static void
+mbedtls_accel_gcm_gen_table (
+  mbedtls_gcm_context *ctx,
+  const unsigned char h[16]
+  )
+{
+  uint64_t vh;
+  uint64_t vl;
+  uint64_t *hi_l;
+  uint64_t *hi_h;
+  uint32_t t;
+  int i;
+  int j;
+
+  vh = ((uint64_t)mbedtls_accel_gcm_load32_be (h) << 32) | mbedtls_accel_gcm_load32_be (h + 4);
+  vl = ((uint64_t)mbedtls_accel_gcm_load32_be (h + 8) << 32) | mbedtls_accel_gcm_load32_be (h + 12);
+
+  //
+  // 8 = 1000 corresponds to 1 in GF(2^128).
+  //
+  ctx->HL[8] = vl;
+  ctx->HH[8] = vh;
+  ctx->HH[0] = 0;
+  ctx->HL[0] = 0;
+
+  for (i = 4; i > 0; i >>= 1) {
+    t = (uint32_t)(vl & 1) * 0xE1000000U;
+    vl = (vh << 63) | (vl >> 1);
+    vh = (vh >> 1) ^ ((uint64_t)t << 32);
+    ctx->HL[i] = vl;
+    ctx->HH[i] = vh;
+  }
+
+  for (i = 2; i <= 8; i *= 2) {
+    hi_l = ctx->HL + i;
+    hi_h = ctx->HH + i;
+    vh = *hi_h;
+    vl = *hi_l;
+    for (j = 1; j < i; j++) {
+      hi_h[j] = vh ^ ctx->HH[j];
+      hi_l[j] = vl ^ ctx->HL[j];
+    }
+  }
+}
+
+static const uint64_t mbedtls_accel_gcm_last4[16] = {
+  0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+  0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+/**
+  Portable GHASH multiply: output = x * H.
+
+  @param  ctx                          The GCM context.
+  @param  x                            The multiplicand.
+  @param  output                       The product, may alias x.
+**/
+static void
+mbedtls_accel_gcm_mult_c (
+  const mbedtls_gcm_context *ctx,
+  const unsigned char       x[16],
+  unsigned char             output[16]
+  )
+{
+  unsigned char lo;
+  unsigned char hi;
+  unsigned char rem;
+  uint64_t zh;
+  uint64_t zl;
+  int i;
+
+  lo = x[15] & 0x0F;
+  zh = ctx->HH[lo];
+  zl = ctx->HL[lo];
+
+  for (i = 15; i >= 0; i--) {
+    lo = x[i] & 0x0F;
+    hi = (x[i] >> 4) & 0x0F;
+
+    if (i != 15) {
+      rem = (unsigned char)zl & 0x0F;
+      zl = (zh << 60) | (zl >> 4);
+      zh = (zh >> 4);
+      zh ^= mbedtls_accel_gcm_last4[rem] << 48;
+      zh ^= ctx->HH[lo];
+      zl ^= ctx->HL[lo];
+    }
+
+    rem = (unsigned char)zl & 0x0F;
+    zl = (zh << 60) | (zl >> 4);
+    zh = (zh >> 4);
+    zh ^= mbedtls_accel_gcm_last4[rem] << 48;
+    zh ^= ctx->HH[hi];
+    zl ^= ctx->HL[hi];
+  }
+
+  mbedtls_accel_gcm_store32_be (output, (uint32_t)(zh >> 32));
+  mbedtls_accel_gcm_store32_be (output + 4, (uint32_t)zh);
+  mbedtls_accel_gcm_store32_be (output + 8, (uint32_t)(zl >> 32));
+  mbedtls_accel_gcm_store32_be (output + 12, (uint32_t)zl);
+}
+
+//
+// The carry-less kernels reverse the bits of every byte. A GCM block then
+// reads as a little-endian 128-bit polynomial with the x^0 coefficient in
+// bit 0, so the product is a plain 128x128 carry-less multiply followed by
+// a reduction modulo x^128 + x^7 + x^2 + x + 1 (x^128 = 0x87).
+//
+
+#if defined(MBEDTLS_ACCEL_X86)
+
+MBEDTLS_ACCEL_TARGET_CLMUL
+static __m128i
+mbedtls_accel_gcm_rbit_x86 (
+  __m128i x
+  )
+{
+  const __m128i rev_lo = _mm_setr_epi8 (0x00, 0x08, 0x04, 0x0C, 0x02, 0x0A, 0x06, 0x0E,
+                                        0x01, 0x09, 0x05, 0x0D, 0x03, 0x0B, 0x07, 0x0F);
+  const __m128i rev_hi = _mm_setr_epi8 (0x00, (char)0x80, 0x40, (char)0xC0, 0x20, (char)0xA0, 0x60, (char)0xE0,
+                                        0x10, (char)0x90, 0x50, (char)0xD0, 0x30, (char)0xB0, 0x70, (char)0xF0);
+  const __m128i nibble = _mm_set1_epi8 (0x0F);
+
+  return _mm_or_si128 (_mm_shuffle_epi8 (rev_hi, _mm_and_si128 (x, nibble)),
+                       _mm_shuffle_epi8 (rev_lo, _mm_and_si128 (_mm_srli_epi16 (x, 4), nibble)));
+}
+
+/**
+  GHASH multiply with PCLMULQDQ: output = x * H.
+
+  @param  ctx                          The GCM context.
+  @param  x                            The multiplicand.
+  @param  output                       The product, may alias x.
+**/
+MBEDTLS_ACCEL_TARGET_CLMUL
+static void
+mbedtls_accel_gcm_mult_clmul (
+  const mbedtls_gcm_context *ctx,
+  const unsigned char       x[16],
+  unsigned char             output[16]
+  )
+{
+  const __m128i poly = _mm_setr_epi32 (0x87, 0, 0, 0);
+  __m128i a;
+  __m128i b;
+  __m128i lo;
+  __m128i mid;
+  __m128i hi;
+  __m128i t;
+
+  a = mbedtls_accel_gcm_rbit_x86 (_mm_loadu_si128 ((const __m128i *)x));
+  b = _mm_loadu_si128 ((const __m128i *)ctx->h_rev);
+
+  lo = _mm_clmulepi64_si128 (a, b, 0x00);
+  hi = _mm_clmulepi64_si128 (a, b, 0x11);
+  mid = _mm_xor_si128 (_mm_clmulepi64_si128 (a, b, 0x01), _mm_clmulepi64_si128 (a, b, 0x10));
+  lo = _mm_xor_si128 (lo, _mm_slli_si128 (mid, 8));
+  hi = _mm_xor_si128 (hi, _mm_srli_si128 (mid, 8));
+
+  //
+  // Fold bits 192..255, then bits 128..191, back into the low 128 bits.
+  //
+  t = _mm_clmulepi64_si128 (hi, poly, 0x01);
+  lo = _mm_xor_si128 (lo, _mm_slli_si128 (t, 8));
+  hi = _mm_xor_si128 (hi, _mm_srli_si128 (t, 8));
+  t = _mm_clmulepi64_si128 (hi, poly, 0x00);
+  lo = _mm_xor_si128 (lo, t);
+
+  _mm_storeu_si128 ((__m128i *)output, mbedtls_accel_gcm_rbit_x86 (lo));
+}
+
+#elif defined(MBEDTLS_ACCEL_AARCH64)
+
+/**
+  GHASH multiply with PMULL: output = x * H.
+
+  @param  ctx                          The GCM context.
+  @param  x                            The multiplicand.
+  @param  output                       The product, may alias x.
+**/
+MBEDTLS_ACCEL_TARGET_CLMUL
+static void
+mbedtls_accel_gcm_mult_clmul (
+  const mbedtls_gcm_context *ctx,
+  const unsigned char       x[16],
+  unsigned char             output[16]
+  )
+{
+  const poly64_t poly = (poly64_t)0x87;
+  uint64x2_t a;
+  uint64x2_t b;
+  uint64x2_t lo;
+  uint64x2_t mid;
+  uint64x2_t hi;
+  uint64x2_t t;
+  uint64x2_t zero;
+
+  zero = vdupq_n_u64 (0);
+  a = vreinterpretq_u64_u8 (vrbitq_u8 (vld1q_u8 (x)));
+  b = vreinterpretq_u64_u8 (vld1q_u8 (ctx->h_rev));
+
+  lo = vreinterpretq_u64_p128 (vmull_p64 ((poly64_t)vgetq_lane_u64 (a, 0), (poly64_t)vgetq_lane_u64 (b, 0)));
+  hi = vreinterpretq_u64_p128 (vmull_p64 ((poly64_t)vgetq_lane_u64 (a, 1), (poly64_t)vgetq_lane_u64 (b, 1)));
+  mid = veorq_u64 (vreinterpretq_u64_p128 (vmull_p64 ((poly64_t)vgetq_lane_u64 (a, 0), (poly64_t)vgetq_lane_u64 (b, 1))),
+                   vreinterpretq_u64_p128 (vmull_p64 ((poly64_t)vgetq_lane_u64 (a, 1), (poly64_t)vgetq_lane_u64 (b, 0))));
+  lo = veorq_u64 (lo, vextq_u64 (zero, mid, 1));
+  hi = veorq_u64 (hi, vextq_u64 (mid, zero, 1));
+
+  //
+  // Fold bits 192..255, then bits 128..191, back into the low 128 bits.
+  //
+  t = vreinterpretq_u64_p128 (vmull_p64 ((poly64_t)vgetq_lane_u64 (hi, 1), poly));
+  lo = veorq_u64 (lo, vextq_u64 (zero, t, 1));
+  hi = veorq_u64 (hi, vextq_u64 (t, zero, 1));
+  t = vreinterpretq_u64_p128 (vmull_p64 ((poly64_t)vgetq_lane_u64 (hi, 0), poly));
+  lo = veorq_u64 (lo, t);
+
+  vst1q_u8 (output, vrbitq_u8 (vreinterpretq_u8_u64 (lo)));
+}
+
+#endif
+
+/**
+  GHASH multiply: output = x * H.
+
+  @param  ctx                          The GCM context.
+  @param  x                            The multiplicand.
+  @param  output                       The product, may alias x.
+**/
+static void
+mbedtls_accel_gcm_mult (
+  const mbedtls_gcm_context *ctx,
+  const unsigned char       x[16],
+  unsigned char             output[16]
+  )
+{
+#if defined(MBEDTLS_ACCEL_X86) || defined(MBEDTLS_ACCEL_AARCH64)
+  if (ctx->use_clmul) {
+    mbedtls_accel_gcm_mult_clmul (ctx, x, output);
+    return;
+  }
+#endif
+  mbedtls_accel_gcm_mult_c (ctx, x, output);
+}
+
+void
+mbedtls_gcm_init (
+  mbedtls_gcm_context *ctx
+  )
+{
+  memset (ctx, 0, sizeof(mbedtls_gcm_context));
+}
+
+int
+mbedtls_gcm_setkey (
+  mbedtls_gcm_context       *ctx,
+  mbedtls_cipher_id_t       cipher,
+  const unsigned char       *key,
+  unsigned int              keybits
+  )
+{
+  const mbedtls_cipher_info_t *cipher_info;
+  unsigned char h[16];
+  size_t olen;
+  int ret;
+  int i;
+
+  if ((ctx == NULL) || (key == NULL)) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+  if ((keybits != 128) && (keybits != 192) && (keybits != 256)) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+
+  cipher_info = mbedtls_cipher_info_from_values (cipher, keybits, MBEDTLS_MODE_ECB);
+  if (cipher_info == NULL) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+  if (cipher_info->block_size != 16) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+
+  mbedtls_cipher_free (&ctx->cipher_ctx);
+
+  ret = mbedtls_cipher_setup (&ctx->cipher_ctx, cipher_info);
+  if (ret != 0) {
+    return ret;
+  }
+  ret = mbedtls_cipher_setkey (&ctx->cipher_ctx, key, keybits, MBEDTLS_ENCRYPT);
+  if (ret != 0) {
+    return ret;
+  }
+
+  memset (h, 0, sizeof(h));
+  ret = mbedtls_cipher_update (&ctx->cipher_ctx, h, 16, h, &olen);
+  if (ret != 0) {
+    return ret;
+  }
+
+  mbedtls_accel_gcm_gen_table (ctx, h);
+  for (i = 0; i < 16; i++) {
+    ctx->h_rev[i] = mbedtls_accel_gcm_rbit8 (h[i]);
+  }
+  ctx->use_clmul = (mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_CLMUL) != 0;
+  mbedtls_platform_zeroize (h, sizeof(h));
+
+  return 0;
+}
+
+int
+mbedtls_gcm_starts (
+  mbedtls_gcm_context       *ctx,
+  int                       mode,
+  const unsigned char       *iv,
+  size_t                    iv_len,
+  const unsigned char       *add,
+  size_t                    add_len
+  )
+{
+  unsigned char work_buf[16];
+  const unsigned char *p;
+  size_t use_len;
+  size_t olen;
+  size_t i;
+  int ret;
+
+  if ((ctx == NULL) || (iv == NULL) || ((add_len != 0) && (add == NULL))) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+
+  //
+  // IV and AD are limited to 2^64 bits, so 2^61 bytes.
+  // IV is not allowed to be zero length.
+  //
+  if ((iv_len == 0) || (((uint64_t)iv_len) >> 61 != 0) || (((uint64_t)add_len) >> 61 != 0)) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+
+  memset (ctx->y, 0x00, sizeof(ctx->y));
+  memset (ctx->buf, 0x00, sizeof(ctx->buf));
+
+  ctx->mode = mode;
+  ctx->len = 0;
+  ctx->add_len = 0;
+
+  if (iv_len == 12) {
+    memcpy (ctx->y, iv, iv_len);
+    ctx->y[15] = 1;
+  } else {
+    memset (work_buf, 0x00, 16);
+    mbedtls_accel_gcm_store32_be (work_buf + 12, (uint32_t)(iv_len * 8));
+
+    p = iv;
+    while (iv_len > 0) {
+      use_len = (iv_len < 16) ? iv_len : 16;
+      for (i = 0; i < use_len; i++) {
+        ctx->y[i] ^= p[i];
+      }
+      mbedtls_accel_gcm_mult (ctx, ctx->y, ctx->y);
+      iv_len -= use_len;
+      p += use_len;
+    }
+
+    for (i = 0; i < 16; i++) {
+      ctx->y[i] ^= work_buf[i];
+    }
+    mbedtls_accel_gcm_mult (ctx, ctx->y, ctx->y);
+  }
+
+  ret = mbedtls_cipher_update (&ctx->cipher_ctx, ctx->y, 16, ctx->base_ectr, &olen);
+  if (ret != 0) {
+    return ret;
+  }
+
+  ctx->add_len = add_len;
+  p = add;
+  while (add_len > 0) {
+    use_len = (add_len < 16) ? add_len : 16;
+    for (i = 0; i < use_len; i++) {
+      ctx->buf[i] ^= p[i];
+    }
+    mbedtls_accel_gcm_mult (ctx, ctx->buf, ctx->buf);
+    add_len -= use_len;
+    p += use_len;
+  }
+
+  return 0;
+}
+
+int
+mbedtls_gcm_update (
+  mbedtls_gcm_context       *ctx,
+  size_t                    length,
+  const unsigned char       *input,
+  unsigned char             *output
+  )
+{
+  unsigned char ectr[16];
+  const unsigned char *p;
+  unsigned char *out_p;
+  size_t use_len;
+  size_t olen;
+  size_t i;
+  int ret;
+
+  if ((ctx == NULL) || ((length != 0) && ((input == NULL) || (output == NULL)))) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+
+  out_p = output;
+  if ((output > input) && ((size_t)(output - input) < length)) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+
+  //
+  // Total length is restricted to 2^39 - 256 bits, ie 2^36 - 2^5 bytes.
+  // Also check for possible overflow.
+  //
+  if ((ctx->len + length < ctx->len) || ((uint64_t)ctx->len + length > 0xFFFFFFFE0ull)) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+
+  ctx->len += length;
+
+  p = input;
+  while (length > 0) {
+    use_len = (length < 16) ? length : 16;
+
+    for (i = 16; i > 12; i--) {
+      if (++ctx->y[i - 1] != 0) {
+        break;
+      }
+    }
+
+    ret = mbedtls_cipher_update (&ctx->cipher_ctx, ctx->y, 16, ectr, &olen);
+    if (ret != 0) {
+      return ret;
+    }
+
+    for (i = 0; i < use_len; i++) {
+      if (ctx->mode == MBEDTLS_GCM_DECRYPT) {
+        ctx->buf[i] ^= p[i];
+      }
+      out_p[i] = ectr[i] ^ p[i];
+      if (ctx->mode == MBEDTLS_GCM_ENCRYPT) {
+        ctx->buf[i] ^= out_p[i];
+      }
+    }
+
+    mbedtls_accel_gcm_mult (ctx, ctx->buf, ctx->buf);
+
+    length -= use_len;
+    p += use_len;
+    out_p += use_len;
+  }
+
+  return 0;
+}
+
+int
+mbedtls_gcm_finish (
+  mbedtls_gcm_context       *ctx,
+  unsigned char             *tag,
+  size_t                    tag_len
+  )
+{
+  unsigned char work_buf[16];
+  uint64_t orig_len;
+  uint64_t orig_add_len;
+  size_t i;
+
+  if ((ctx == NULL) || (tag == NULL)) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+
+  orig_len = ctx->len * 8;
+  orig_add_len = ctx->add_len * 8;
+
+  if ((tag_len > 16) || (tag_len < 4)) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+
+  memcpy (tag, ctx->base_ectr, tag_len);
+
+  if ((orig_len != 0) || (orig_add_len != 0)) {
+    memset (work_buf, 0x00, 16);
+
+    mbedtls_accel_gcm_store32_be (work_buf, (uint32_t)(orig_add_len >> 32));
+    mbedtls_accel_gcm_store32_be (work_buf + 4, (uint32_t)orig_add_len);
+    mbedtls_accel_gcm_store32_be (work_buf + 8, (uint32_t)(orig_len >> 32));
+    mbedtls_accel_gcm_store32_be (work_buf + 12, (uint32_t)orig_len);
+
+    for (i = 0; i < 16; i++) {
+      ctx->buf[i] ^= work_buf[i];
+    }
+
+    mbedtls_accel_gcm_mult (ctx, ctx->buf, ctx->buf);
+
+    for (i = 0; i < tag_len; i++) {
+      tag[i] ^= ctx->buf[i];
+    }
+  }
+
+  return 0;
+}
+
+int
+mbedtls_gcm_crypt_and_tag (
+  mbedtls_gcm_context       *ctx,
+  int                       mode,
+  size_t                    length,
+  const unsigned char       *iv,
+  size_t                    iv_len,
+  const unsigned char       *add,
+  size_t                    add_len,
+  const unsigned char       *input,
+  unsigned char             *output,
+  size_t                    tag_len,
+  unsigned char             *tag
+  )
+{
+  int ret;
+
+  ret = mbedtls_gcm_starts (ctx, mode, iv, iv_len, add, add_len);
+  if (ret != 0) {
+    return ret;
+  }
+  ret = mbedtls_gcm_update (ctx, length, input, output);
+  if (ret != 0) {
+    return ret;
+  }
+  return mbedtls_gcm_finish (ctx, tag, tag_len);
+}
+
+int
+mbedtls_gcm_auth_decrypt (
+  mbedtls_gcm_context       *ctx,
+  size_t                    length,
+  const unsigned char       *iv,
+  size_t                    iv_len,
+  const unsigned char       *add,
+  size_t                    add_len,
+  const unsigned char       *tag,
+  size_t                    tag_len,
+  const unsigned char       *input,
+  unsigned char             *output
+  )
+{
+  unsigned char check_tag[16];
+  size_t i;
+  int diff;
+  int ret;
+
+  if ((ctx == NULL) || (tag == NULL) || (tag_len > sizeof(check_tag))) {
+    return MBEDTLS_ERR_GCM_BAD_INPUT;
+  }
+
+  ret = mbedtls_gcm_crypt_and_tag (ctx, MBEDTLS_GCM_DECRYPT, length, iv, iv_len, add, add_len,
+                                   input, output, tag_len, check_tag);
+  if (ret != 0) {
+    return ret;
+  }
+
+  //
+  // Check tag in "constant-time".
+  //
+  for (diff = 0, i = 0; i < tag_len; i++) {
+    diff |= tag[i] ^ check_tag[i];
+  }
+
+  if (diff != 0) {
+    mbedtls_platform_zeroize (output, length);
+    return MBEDTLS_ERR_GCM_AUTH_FAILED;
+  }
+
+  return 0;
+}
+
+void
+mbedtls_gcm_free (
+  mbedtls_gcm_context *ctx
+  )
+{
+  if (ctx == NULL) {
+    return;
+  }
+  mbedtls_cipher_free (&ctx->cipher_ctx);
+  mbedtls_platform_zeroize (ctx, sizeof(mbedtls_gcm_context));
+}
+
+#endif
@@ -0,0 +1,77 @@
+/** @file
+  Internal include file for the MbedTLS hardware acceleration kernels.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __MBEDTLS_ACCEL_INTERNAL_H__
+#define __MBEDTLS_ACCEL_INTERNAL_H__
+
+#include "mbedtls/config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_ACCEL_CPU_AES     0x01  /* AES-NI / ARMv8 AES */
+#define MBEDTLS_ACCEL_CPU_CLMUL   0x02  /* PCLMULQDQ / ARMv8 PMULL */
+#define MBEDTLS_ACCEL_CPU_SHA256  0x04  /* SHA extensions / ARMv8 SHA2 */
+#define MBEDTLS_ACCEL_CPU_SHA512  0x08  /* ARMv8.2 SHA512 */
+#define MBEDTLS_ACCEL_CPU_SIMD    0x10  /* SSE2 / NEON / RISC-V V */
+#define MBEDTLS_ACCEL_CPU_AVX2    0x20  /* AVX2 */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MBEDTLS_ACCEL_TARGET(x)  __attribute__((target(x)))
+#else
+#define MBEDTLS_ACCEL_TARGET(x)
+#endif
+
+#if defined(MBEDTLS_ACCEL_X86)
+#define MBEDTLS_ACCEL_TARGET_AES     MBEDTLS_ACCEL_TARGET("sse2,ssse3,aes")
+#define MBEDTLS_ACCEL_TARGET_CLMUL   MBEDTLS_ACCEL_TARGET("sse2,ssse3,pclmul")
+#define MBEDTLS_ACCEL_TARGET_SHA256  MBEDTLS_ACCEL_TARGET("sse2,ssse3,sse4.1,sha")
+#define MBEDTLS_ACCEL_TARGET_SIMD    MBEDTLS_ACCEL_TARGET("sse2")
+#define MBEDTLS_ACCEL_TARGET_AVX2    MBEDTLS_ACCEL_TARGET("avx,avx2")
+#elif defined(MBEDTLS_ACCEL_AARCH64) && defined(__clang__)
+#define MBEDTLS_ACCEL_TARGET_AES     MBEDTLS_ACCEL_TARGET("aes")
+#define MBEDTLS_ACCEL_TARGET_CLMUL   MBEDTLS_ACCEL_TARGET("aes")
+#define MBEDTLS_ACCEL_TARGET_SHA256  MBEDTLS_ACCEL_TARGET("sha2")
+#define MBEDTLS_ACCEL_TARGET_SHA512  MBEDTLS_ACCEL_TARGET("sha3")
+#elif defined(MBEDTLS_ACCEL_AARCH64)
+#define MBEDTLS_ACCEL_TARGET_AES     MBEDTLS_ACCEL_TARGET("+crypto")
+#define MBEDTLS_ACCEL_TARGET_CLMUL   MBEDTLS_ACCEL_TARGET("+crypto")
+#define MBEDTLS_ACCEL_TARGET_SHA256  MBEDTLS_ACCEL_TARGET("+crypto")
+#define MBEDTLS_ACCEL_TARGET_SHA512  MBEDTLS_ACCEL_TARGET("arch=armv8.2-a+sha3")
+#endif
+
+//
+// NEON is part of AArch64. ARM and RISC-V use their SIMD kernels only when
+// the compiler already targets NEON or the vector extension, since their
+// intrinsics headers cannot be enabled per function; the CPU is still
+// checked at runtime where the OS reports it.
+//
+#if defined(MBEDTLS_ACCEL_AARCH64) || (defined(MBEDTLS_ACCEL_ARM) && defined(__ARM_NEON))
+#define MBEDTLS_ACCEL_NEON
+#elif defined(MBEDTLS_ACCEL_RISCV) && defined(__riscv_vector) && \
+      defined(__riscv_v_intrinsic) && (__riscv_v_intrinsic >= 12000)
+#define MBEDTLS_ACCEL_RVV
+#endif
+
+#if !defined(MBEDTLS_ACCEL_TARGET_SIMD)
+#define MBEDTLS_ACCEL_TARGET_SIMD
+#endif
+
+/**
+  Return the MBEDTLS_ACCEL_CPU_* extensions usable on the running CPU.
+
+  The CPU is queried once; later calls return the cached value.
+
+  @return the MBEDTLS_ACCEL_CPU_* bit mask.
+**/
+unsigned int
+mbedtls_accel_cpu_features (
+  void
+  );
+
+#endif
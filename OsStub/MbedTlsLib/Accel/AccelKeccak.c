@@ -0,0 +1,301 @@
+/** @file
+  Multi-lane Keccak-f[1600] absorption for MBEDTLS_ACCEL_KECCAK_MULTI.
+
+  Lane i of every state is held in one SIMD register, so one permutation
+  runs on four states with AVX2 and on two with NEON. Keccak only uses XOR,
+  AND-NOT and rotations, all of which are lane-wise, so the round is the
+  scalar one applied to vectors.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "AccelInternal.h"
+
+#if defined(MBEDTLS_ACCEL_KECCAK_MULTI)
+
+#include "mbedtls/keccak_multi.h"
+
+#include <string.h>
+
+#if defined(MBEDTLS_ACCEL_X86)
+#include <immintrin.h>
+#elif defined(MBEDTLS_ACCEL_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(MBEDTLS_ACCEL_X86) || defined(MBEDTLS_ACCEL_NEON)
+
+static const uint64_t mbedtls_accel_keccak_rc[24] = {
+  0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808AULL, 0x8000000080008000ULL,
+  0x000000000000808BULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+  0x000000000000008AULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000AULL,
+  0x000000008000808BULL, 0x800000000000008BULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+  0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800AULL, 0x800000008000000AULL,
+  0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+static uint64_t
+mbedtls_accel_keccak_load64 (
+  const unsigned char *p
+  )
+{
+  uint64_t v;
+
+  //
+  // Both targets are little-endian.
+  //
+  memcpy (&v, p, sizeof(v));
+  return v;
+}
+
+//
+// One round on the state A[25], with B[25], C[5] and D[5] as scratch, for
+// any vector type that provides XOR, ROTL, ANDN (~a & b) and XOR_RC.
+//
+#define KECCAK_CHI_ROW(r)                                                     \
+  do {                                                                        \
+    A[5 * (r) + 0] = KECCAK_XOR (B[5 * (r) + 0], KECCAK_ANDN (B[5 * (r) + 1], B[5 * (r) + 2])); \
+    A[5 * (r) + 1] = KECCAK_XOR (B[5 * (r) + 1], KECCAK_ANDN (B[5 * (r) + 2], B[5 * (r) + 3])); \
+    A[5 * (r) + 2] = KECCAK_XOR (B[5 * (r) + 2], KECCAK_ANDN (B[5 * (r) + 3], B[5 * (r) + 4])); \
+    A[5 * (r) + 3] = KECCAK_XOR (B[5 * (r) + 3], KECCAK_ANDN (B[5 * (r) + 4], B[5 * (r) + 0])); \
+    A[5 * (r) + 4] = KECCAK_XOR (B[5 * (r) + 4], KECCAK_ANDN (B[5 * (r) + 0], B[5 * (r) + 1])); \
+  } while (0)
+
+#define KECCAK_ROUND(rc)                                                      \
+  do {                                                                        \
+    C[0] = KECCAK_XOR (KECCAK_XOR (KECCAK_XOR (A[0], A[5]), KECCAK_XOR (A[10], A[15])), A[20]); \
+    C[1] = KECCAK_XOR (KECCAK_XOR (KECCAK_XOR (A[1], A[6]), KECCAK_XOR (A[11], A[16])), A[21]); \
+    C[2] = KECCAK_XOR (KECCAK_XOR (KECCAK_XOR (A[2], A[7]), KECCAK_XOR (A[12], A[17])), A[22]); \
+    C[3] = KECCAK_XOR (KECCAK_XOR (KECCAK_XOR (A[3], A[8]), KECCAK_XOR (A[13], A[18])), A[23]); \
+    C[4] = KECCAK_XOR (KECCAK_XOR (KECCAK_XOR (A[4], A[9]), KECCAK_XOR (A[14], A[19])), A[24]); \
+    D[0] = KECCAK_XOR (C[4], KECCAK_ROTL (C[1], 1));                          \
+    D[1] = KECCAK_XOR (C[0], KECCAK_ROTL (C[2], 1));                          \
+    D[2] = KECCAK_XOR (C[1], KECCAK_ROTL (C[3], 1));                          \
+    D[3] = KECCAK_XOR (C[2], KECCAK_ROTL (C[4], 1));                          \
+    D[4] = KECCAK_XOR (C[3], KECCAK_ROTL (C[0], 1));                          \
+    B[0] = KECCAK_XOR (A[0], D[0]);                                           \
+    B[1] = KECCAK_ROTL (KECCAK_XOR (A[6], D[1]), 44);                         \
+    B[2] = KECCAK_ROTL (KECCAK_XOR (A[12], D[2]), 43);                        \
+    B[3] = KECCAK_ROTL (KECCAK_XOR (A[18], D[3]), 21);                        \
+    B[4] = KECCAK_ROTL (KECCAK_XOR (A[24], D[4]), 14);                        \
+    B[5] = KECCAK_ROTL (KECCAK_XOR (A[3], D[3]), 28);                         \
+    B[6] = KECCAK_ROTL (KECCAK_XOR (A[9], D[4]), 20);                         \
+    B[7] = KECCAK_ROTL (KECCAK_XOR (A[10], D[0]), 3);                         \
+    B[8] = KECCAK_ROTL (KECCAK_XOR (A[16], D[1]), 45);                        \
+    B[9] = KECCAK_ROTL (KECCAK_XOR (A[22], D[2]), 61);                        \
+    B[10] = KECCAK_ROTL (KECCAK_XOR (A[1], D[1]), 1);                         \
+    B[11] = KECCAK_ROTL (KECCAK_XOR (A[7], D[2]), 6);                         \
+    B[12] = KECCAK_ROTL (KECCAK_XOR (A[13], D[3]), 25);                       \
+    B[13] = KECCAK_ROTL (KECCAK_XOR (A[19], D[4]), 8);                        \
+    B[14] = KECCAK_ROTL (KECCAK_XOR (A[20], D[0]), 18);                       \
+    B[15] = KECCAK_ROTL (KECCAK_XOR (A[4], D[4]), 27);                        \
+    B[16] = KECCAK_ROTL (KECCAK_XOR (A[5], D[0]), 36);                        \
+    B[17] = KECCAK_ROTL (KECCAK_XOR (A[11], D[1]), 10);                       \
+    B[18] = KECCAK_ROTL (KECCAK_XOR (A[17], D[2]), 15);                       \
+    B[19] = KECCAK_ROTL (KECCAK_XOR (A[23], D[3]), 56);                       \
+    B[20] = KECCAK_ROTL (KECCAK_XOR (A[2], D[2]), 62);                        \
+    B[21] = KECCAK_ROTL (KECCAK_XOR (A[8], D[3]), 55);                        \
+    B[22] = KECCAK_ROTL (KECCAK_XOR (A[14], D[4]), 39);                       \
+    B[23] = KECCAK_ROTL (KECCAK_XOR (A[15], D[0]), 41);                       \
+    B[24] = KECCAK_ROTL (KECCAK_XOR (A[21], D[1]), 2);                        \
+    KECCAK_CHI_ROW (0);                                                       \
+    KECCAK_CHI_ROW (1);                                                       \
+    KECCAK_CHI_ROW (2);                                                       \
+    KECCAK_CHI_ROW (3);                                                       \
+    KECCAK_CHI_ROW (4);                                                       \
+    A[0] = KECCAK_XOR_RC (A[0], rc);                                          \
+  } while (0)
+
+#endif
+
+#if defined(MBEDTLS_ACCEL_X86)
+
+/**
+  Absorb whole blocks into up to four states with AVX2.
+
+  @param  count                        The number of states, 1 to 4.
+  @param  state                        The states.
+  @param  input                        The inputs.
+  @param  rate                         The rate in bytes.
+  @param  blocks                       The number of blocks.
+**/
+MBEDTLS_ACCEL_TARGET_AVX2
+static void
+mbedtls_accel_keccak_absorb_x4_avx2 (
+  size_t                     count,
+  uint64_t *const            state[],
+  const unsigned char *const input[],
+  size_t                     rate,
+  size_t                     blocks
+  )
+{
+  uint64_t            unused[25];
+  uint64_t            *s[4];
+  const unsigned char *in[4];
+  uint64_t            lanes[4];
+  __m256i             A[25];
+  __m256i             B[25];
+  __m256i             C[5];
+  __m256i             D[5];
+  size_t              block;
+  size_t              i;
+  unsigned int        lane;
+
+  //
+  // Missing lanes permute a scratch state over the first input.
+  //
+  memset (unused, 0, sizeof(unused));
+  for (lane = 0; lane < 4; lane++) {
+    s[lane] = (lane < count) ? state[lane] : unused;
+    in[lane] = (lane < count) ? input[lane] : input[0];
+  }
+
+  for (i = 0; i < 25; i++) {
+    A[i] = _mm256_set_epi64x ((long long)s[3][i], (long long)s[2][i], (long long)s[1][i], (long long)s[0][i]);
+  }
+
+#define KECCAK_XOR(a, b)     _mm256_xor_si256 (a, b)
+#define KECCAK_ANDN(a, b)    _mm256_andnot_si256 (a, b)
+#define KECCAK_ROTL(a, n)    _mm256_or_si256 (_mm256_slli_epi64 (a, n), _mm256_srli_epi64 (a, 64 - (n)))
+#define KECCAK_XOR_RC(a, rc) _mm256_xor_si256 (a, _mm256_set1_epi64x ((long long)(rc)))
+  for (block = 0; block < blocks; block++) {
+    for (i = 0; i < rate / 8; i++) {
+      A[i] = _mm256_xor_si256 (A[i], _mm256_set_epi64x ((long long)mbedtls_accel_keccak_load64 (in[3] + 8 * i),
+                                                        (long long)mbedtls_accel_keccak_load64 (in[2] + 8 * i),
+                                                        (long long)mbedtls_accel_keccak_load64 (in[1] + 8 * i),
+                                                        (long long)mbedtls_accel_keccak_load64 (in[0] + 8 * i)));
+    }
+    for (i = 0; i < 24; i++) {
+      KECCAK_ROUND (mbedtls_accel_keccak_rc[i]);
+    }
+    for (lane = 0; lane < 4; lane++) {
+      in[lane] += rate;
+    }
+  }
+#undef KECCAK_XOR
+#undef KECCAK_ANDN
+#undef KECCAK_ROTL
+#undef KECCAK_XOR_RC
+
+  for (i = 0; i < 25; i++) {
+    _mm256_storeu_si256 ((__m256i *)lanes, A[i]);
+    for (lane = 0; lane < 4; lane++) {
+      s[lane][i] = lanes[lane];
+    }
+  }
+}
+
+#elif defined(MBEDTLS_ACCEL_NEON)
+
+/**
+  Absorb whole blocks into up to two states with NEON.
+
+  @param  count                        The number of states, 1 or 2.
+  @param  state                        The states.
+  @param  input                        The inputs.
+  @param  rate                         The rate in bytes.
+  @param  blocks                       The number of blocks.
+**/
+static void
+mbedtls_accel_keccak_absorb_x2_neon (
+  size_t                     count,
+  uint64_t *const            state[],
+  const unsigned char *const input[],
+  size_t                     rate,
+  size_t                     blocks
+  )
+{
+  uint64_t            unused[25];
+  uint64_t            *s[2];
+  const unsigned char *in[2];
+  uint64x2_t          A[25];
+  uint64x2_t          B[25];
+  uint64x2_t          C[5];
+  uint64x2_t          D[5];
+  size_t              block;
+  size_t              i;
+
+  //
+  // A missing lane permutes a scratch state over the first input.
+  //
+  memset (unused, 0, sizeof(unused));
+  s[0] = state[0];
+  s[1] = (count > 1) ? state[1] : unused;
+  in[0] = input[0];
+  in[1] = (count > 1) ? input[1] : input[0];
+
+  for (i = 0; i < 25; i++) {
+    A[i] = vcombine_u64 (vcreate_u64 (s[0][i]), vcreate_u64 (s[1][i]));
+  }
+
+#define KECCAK_XOR(a, b)     veorq_u64 (a, b)
+#define KECCAK_ANDN(a, b)    vbicq_u64 (b, a)
+#define KECCAK_ROTL(a, n)    vsriq_n_u64 (vshlq_n_u64 (a, n), a, 64 - (n))
+#define KECCAK_XOR_RC(a, rc) veorq_u64 (a, vdupq_n_u64 (rc))
+  for (block = 0; block < blocks; block++) {
+    for (i = 0; i < rate / 8; i++) {
+      A[i] = veorq_u64 (A[i], vcombine_u64 (vcreate_u64 (mbedtls_accel_keccak_load64 (in[0] + 8 * i)),
+                                            vcreate_u64 (mbedtls_accel_keccak_load64 (in[1] + 8 * i))));
+    }
+    for (i = 0; i < 24; i++) {
+      KECCAK_ROUND (mbedtls_accel_keccak_rc[i]);
+    }
+    in[0] += rate;
+    in[1] += rate;
+  }
+#undef KECCAK_XOR
+#undef KECCAK_ANDN
+#undef KECCAK_ROTL
+#undef KECCAK_XOR_RC
+
+  for (i = 0; i < 25; i++) {
+    s[0][i] = vgetq_lane_u64 (A[i], 0);
+    s[1][i] = vgetq_lane_u64 (A[i], 1);
+  }
+}
+
+#endif
+
+size_t
+mbedtls_accel_keccak_lanes (
+  void
+  )
+{
+#if defined(MBEDTLS_ACCEL_X86)
+  if ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_AVX2) != 0) {
+    return 4;
+  }
+#elif defined(MBEDTLS_ACCEL_NEON)
+  if ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_SIMD) != 0) {
+    return 2;
+  }
+#endif
+  return 0;
+}
+
+void
+mbedtls_accel_keccak_absorb_multi (
+  size_t                     count,
+  uint64_t *const            state[],
+  const unsigned char *const input[],
+  size_t                     rate,
+  size_t                     blocks
+  )
+{
+  if ((count == 0) || (count > mbedtls_accel_keccak_lanes ()) || (blocks == 0)) {
+    return;
+  }
+#if defined(MBEDTLS_ACCEL_X86)
+  mbedtls_accel_keccak_absorb_x4_avx2 (count, state, input, rate, blocks);
+#elif defined(MBEDTLS_ACCEL_NEON)
+  mbedtls_accel_keccak_absorb_x2_neon (count, state, input, rate, blocks);
+#else
+  (void)state;
+  (void)input;
+  (void)rate;
+#endif
+}
+
+#endif
@@ -0,0 +1,585 @@
+/** @file
+  Poly1305 (RFC 8439) for MBEDTLS_POLY1305_ALT.
+
+  Poly1305 is a chain of multiplications modulo 2^130 - 5 in which every
+  block depends on the previous one, so it does not spread over SIMD lanes
+  for the short messages SPDM sends. Instead the accumulator is held in
+  limbs that make every product one native multiply: three 44-bit limbs and
+  64x64->128 multiplies when the compiler has a 128-bit integer type (the
+  64-bit targets), five 26-bit limbs and 32x32->64 multiplies otherwise.
+  Both need one reduction per block, where the generic MbedTLS code works on
+  32-bit limbs with carries propagated through 64-bit sums.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "AccelInternal.h"
+
+#if defined(MBEDTLS_POLY1305_C) && defined(MBEDTLS_POLY1305_ALT)
+
+#include "mbedtls/poly1305.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+#define POLY1305_BLOCK_SIZE_BYTES  16
+
+static uint32_t
+mbedtls_accel_poly1305_load32 (
+  const unsigned char *p
+  )
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void
+mbedtls_accel_poly1305_store32 (
+  unsigned char *p,
+  uint32_t      v
+  )
+{
+  p[0] = (unsigned char)v;
+  p[1] = (unsigned char)(v >> 8);
+  p[2] = (unsigned char)(v >> 16);
+  p[3] = (unsigned char)(v >> 24);
+}
+
+#if defined(__SIZEOF_INT128__)
+
+typedef unsigned __int128 mbedtls_accel_uint128;
+
+#define POLY1305_MASK44  0xFFFFFFFFFFFull
+#define POLY1305_MASK42  0x3FFFFFFFFFFull
+
+static uint64_t
+mbedtls_accel_poly1305_load64 (
+  const unsigned char *p
+  )
+{
+  return (uint64_t)mbedtls_accel_poly1305_load32 (p) | ((uint64_t)mbedtls_accel_poly1305_load32 (p + 4) << 32);
+}
+
+/**
+  Split the clamped r into 44-bit limbs.
+
+  @param  ctx                          The Poly1305 context.
+  @param  key                          The low 16 bytes of the key.
+**/
+static void
+mbedtls_accel_poly1305_set_r (
+  mbedtls_poly1305_context *ctx,
+  const unsigned char      key[16]
+  )
+{
+  uint64_t t0;
+  uint64_t t1;
+
+  t0 = mbedtls_accel_poly1305_load64 (key);
+  t1 = mbedtls_accel_poly1305_load64 (key + 8);
+  ctx->r[0] = t0 & 0xFFC0FFFFFFFull;
+  ctx->r[1] = ((t0 >> 44) | (t1 << 20)) & 0xFFFFFC0FFFFull;
+  ctx->r[2] = (t1 >> 24) & 0x00FFFFFFC0Full;
+}
+
+/**
+  Process whole blocks: h = (h + m) * r mod 2^130 - 5.
+
+  @param  ctx                          The Poly1305 context.
+  @param  input                        The blocks.
+  @param  nblocks                      The number of blocks.
+  @param  hibit                        1 for a whole block, 0 for the padded final block.
+**/
+static void
+mbedtls_accel_poly1305_blocks (
+  mbedtls_poly1305_context *ctx,
+  const unsigned char      *input,
+  size_t                   nblocks,
+  uint32_t                 hibit
+  )
+{
+  uint64_t r0;
+  uint64_t r1;
+  uint64_t r2;
+  uint64_t s1;
+  uint64_t s2;
+  uint64_t h0;
+  uint64_t h1;
+  uint64_t h2;
+  uint64_t t0;
+  uint64_t t1;
+  uint64_t c;
+  mbedtls_accel_uint128 d0;
+  mbedtls_accel_uint128 d1;
+  mbedtls_accel_uint128 d2;
+
+  r0 = ctx->r[0];
+  r1 = ctx->r[1];
+  r2 = ctx->r[2];
+  //
+  // 2^132 = 4 * 5 mod 2^130 - 5.
+  //
+  s1 = r1 * (5 << 2);
+  s2 = r2 * (5 << 2);
+  h0 = ctx->h[0];
+  h1 = ctx->h[1];
+  h2 = ctx->h[2];
+
+  while (nblocks > 0) {
+    t0 = mbedtls_accel_poly1305_load64 (input);
+    t1 = mbedtls_accel_poly1305_load64 (input + 8);
+    h0 += t0 & POLY1305_MASK44;
+    h1 += ((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44;
+    h2 += ((t1 >> 24) & POLY1305_MASK42) | ((uint64_t)hibit << 40);
+
+    d0 = (mbedtls_accel_uint128)h0 * r0 + (mbedtls_accel_uint128)h1 * s2 + (mbedtls_accel_uint128)h2 * s1;
+    d1 = (mbedtls_accel_uint128)h0 * r1 + (mbedtls_accel_uint128)h1 * r0 + (mbedtls_accel_uint128)h2 * s2;
+    d2 = (mbedtls_accel_uint128)h0 * r2 + (mbedtls_accel_uint128)h1 * r1 + (mbedtls_accel_uint128)h2 * r0;
+
+    c = (uint64_t)(d0 >> 44);
+    h0 = (uint64_t)d0 & POLY1305_MASK44;
+    d1 += c;
+    c = (uint64_t)(d1 >> 44);
+    h1 = (uint64_t)d1 & POLY1305_MASK44;
+    d2 += c;
+    c = (uint64_t)(d2 >> 42);
+    h2 = (uint64_t)d2 & POLY1305_MASK42;
+    h0 += c * 5;
+    c = h0 >> 44;
+    h0 &= POLY1305_MASK44;
+    h1 += c;
+
+    input += POLY1305_BLOCK_SIZE_BYTES;
+    nblocks--;
+  }
+
+  ctx->h[0] = h0;
+  ctx->h[1] = h1;
+  ctx->h[2] = h2;
+}
+
+/**
+  Reduce h fully and compute the tag (h + s) mod 2^128.
+
+  @param  ctx                          The Poly1305 context.
+  @param  mac                          Receives the tag.
+**/
+static void
+mbedtls_accel_poly1305_emit (
+  mbedtls_poly1305_context *ctx,
+  unsigned char            mac[16]
+  )
+{
+  uint64_t h0;
+  uint64_t h1;
+  uint64_t h2;
+  uint64_t g0;
+  uint64_t g1;
+  uint64_t g2;
+  uint64_t s0;
+  uint64_t s1;
+  uint64_t c;
+  uint64_t mask;
+
+  h0 = ctx->h[0];
+  h1 = ctx->h[1];
+  h2 = ctx->h[2];
+
+  c = h1 >> 44;
+  h1 &= POLY1305_MASK44;
+  h2 += c;
+  c = h2 >> 42;
+  h2 &= POLY1305_MASK42;
+  h0 += c * 5;
+  c = h0 >> 44;
+  h0 &= POLY1305_MASK44;
+  h1 += c;
+  c = h1 >> 44;
+  h1 &= POLY1305_MASK44;
+  h2 += c;
+  c = h2 >> 42;
+  h2 &= POLY1305_MASK42;
+  h0 += c * 5;
+  c = h0 >> 44;
+  h0 &= POLY1305_MASK44;
+  h1 += c;
+
+  //
+  // g = h + 5 - 2^130; use it instead of h when it does not borrow.
+  //
+  g0 = h0 + 5;
+  c = g0 >> 44;
+  g0 &= POLY1305_MASK44;
+  g1 = h1 + c;
+  c = g1 >> 44;
+  g1 &= POLY1305_MASK44;
+  g2 = h2 + c - ((uint64_t)1 << 42);
+
+  mask = (g2 >> 63) - 1;
+  h0 = (h0 & ~mask) | (g0 & mask);
+  h1 = (h1 & ~mask) | (g1 & mask);
+  h2 = (h2 & ~mask) | (g2 & mask);
+
+  s0 = (uint64_t)ctx->s[0] | ((uint64_t)ctx->s[1] << 32);
+  s1 = (uint64_t)ctx->s[2] | ((uint64_t)ctx->s[3] << 32);
+  h0 += s0 & POLY1305_MASK44;
+  c = h0 >> 44;
+  h0 &= POLY1305_MASK44;
+  h1 += (((s0 >> 44) | (s1 << 20)) & POLY1305_MASK44) + c;
+  c = h1 >> 44;
+  h1 &= POLY1305_MASK44;
+  h2 += (s1 >> 24) + c;
+
+  h0 = h0 | (h1 << 44);
+  h1 = (h1 >> 20) | (h2 << 24);
+  mbedtls_accel_poly1305_store32 (mac, (uint32_t)h0);
+  mbedtls_accel_poly1305_store32 (mac + 4, (uint32_t)(h0 >> 32));
+  mbedtls_accel_poly1305_store32 (mac + 8, (uint32_t)h1);
+  mbedtls_accel_poly1305_store32 (mac + 12, (uint32_t)(h1 >> 32));
+}
+
+#else
+
+#define POLY1305_MASK26  0x3FFFFFFu
+
+/**
+  Split the clamped r into 26-bit limbs.
+
+  @param  ctx                          The Poly1305 context.
+  @param  key                          The low 16 bytes of the key.
+**/
+static void
+mbedtls_accel_poly1305_set_r (
+  mbedtls_poly1305_context *ctx,
+  const unsigned char      key[16]
+  )
+{
+  ctx->r[0] = (mbedtls_accel_poly1305_load32 (key)) & 0x3FFFFFF;
+  ctx->r[1] = (mbedtls_accel_poly1305_load32 (key + 3) >> 2) & 0x3FFFF03;
+  ctx->r[2] = (mbedtls_accel_poly1305_load32 (key + 6) >> 4) & 0x3FFC0FF;
+  ctx->r[3] = (mbedtls_accel_poly1305_load32 (key + 9) >> 6) & 0x3F03FFF;
+  ctx->r[4] = (mbedtls_accel_poly1305_load32 (key + 12) >> 8) & 0x00FFFFF;
+}
+
+/**
+  Process whole blocks: h = (h + m) * r mod 2^130 - 5.
+
+  @param  ctx                          The Poly1305 context.
+  @param  input                        The blocks.
+  @param  nblocks                      The number of blocks.
+  @param  hibit                        1 for a whole block, 0 for the padded final block.
+**/
+static void
+mbedtls_accel_poly1305_blocks (
+  mbedtls_poly1305_context *ctx,
+  const unsigned char      *input,
+  size_t                   nblocks,
+  uint32_t                 hibit
+  )
+{
+  uint32_t r0;
+  uint32_t r1;
+  uint32_t r2;
+  uint32_t r3;
+  uint32_t r4;
+  uint32_t s1;
+  uint32_t s2;
+  uint32_t s3;
+  uint32_t s4;
+  uint32_t h0;
+  uint32_t h1;
+  uint32_t h2;
+  uint32_t h3;
+  uint32_t h4;
+  uint32_t c;
+  uint64_t d0;
+  uint64_t d1;
+  uint64_t d2;
+  uint64_t d3;
+  uint64_t d4;
+
+  r0 = (uint32_t)ctx->r[0];
+  r1 = (uint32_t)ctx->r[1];
+  r2 = (uint32_t)ctx->r[2];
+  r3 = (uint32_t)ctx->r[3];
+  r4 = (uint32_t)ctx->r[4];
+  //
+  // 2^130 = 5 mod 2^130 - 5.
+  //
+  s1 = r1 * 5;
+  s2 = r2 * 5;
+  s3 = r3 * 5;
+  s4 = r4 * 5;
+  h0 = (uint32_t)ctx->h[0];
+  h1 = (uint32_t)ctx->h[1];
+  h2 = (uint32_t)ctx->h[2];
+  h3 = (uint32_t)ctx->h[3];
+  h4 = (uint32_t)ctx->h[4];
+
+  while (nblocks > 0) {
+    h0 += (mbedtls_accel_poly1305_load32 (input)) & POLY1305_MASK26;
+    h1 += (mbedtls_accel_poly1305_load32 (input + 3) >> 2) & POLY1305_MASK26;
+    h2 += (mbedtls_accel_poly1305_load32 (input + 6) >> 4) & POLY1305_MASK26;
+    h3 += (mbedtls_accel_poly1305_load32 (input + 9) >> 6) & POLY1305_MASK26;
+    h4 += (mbedtls_accel_poly1305_load32 (input + 12) >> 8) | (hibit << 24);
+
+    d0 = (uint64_t)h0 * r0 + (uint64_t)h1 * s4 + (uint64_t)h2 * s3 + (uint64_t)h3 * s2 + (uint64_t)h4 * s1;
+    d1 = (uint64_t)h0 * r1 + (uint64_t)h1 * r0 + (uint64_t)h2 * s4 + (uint64_t)h3 * s3 + (uint64_t)h4 * s2;
+    d2 = (uint64_t)h0 * r2 + (uint64_t)h1 * r1 + (uint64_t)h2 * r0 + (uint64_t)h3 * s4 + (uint64_t)h4 * s3;
+    d3 = (uint64_t)h0 * r3 + (uint64_t)h1 * r2 + (uint64_t)h2 * r1 + (uint64_t)h3 * r0 + (uint64_t)h4 * s4;
+    d4 = (uint64_t)h0 * r4 + (uint64_t)h1 * r3 + (uint64_t)h2 * r2 + (uint64_t)h3 * r1 + (uint64_t)h4 * r0;
+
+    c = (uint32_t)(d0 >> 26);
+    h0 = (uint32_t)d0 & POLY1305_MASK26;
+    d1 += c;
+    c = (uint32_t)(d1 >> 26);
+    h1 = (uint32_t)d1 & POLY1305_MASK26;
+    d2 += c;
+    c = (uint32_t)(d2 >> 26);
+    h2 = (uint32_t)d2 & POLY1305_MASK26;
+    d3 += c;
+    c = (uint32_t)(d3 >> 26);
+    h3 = (uint32_t)d3 & POLY1305_MASK26;
+    d4 += c;
+    c = (uint32_t)(d4 >> 26);
+    h4 = (uint32_t)d4 & POLY1305_MASK26;
+    h0 += c * 5;
+    c = h0 >> 26;
+    h0 &= POLY1305_MASK26;
+    h1 += c;
+
+    input += POLY1305_BLOCK_SIZE_BYTES;
+    nblocks--;
+  }
+
+  ctx->h[0] = h0;
+  ctx->h[1] = h1;
+  ctx->h[2] = h2;
+  ctx->h[3] = h3;
+  ctx->h[4] = h4;
+}
+
+/**
+  Reduce h fully and compute the tag (h + s) mod 2^128.
+
+  @param  ctx                          The Poly1305 context.
+  @param  mac                          Receives the tag.
+**/
+static void
+mbedtls_accel_poly1305_emit (
+  mbedtls_poly1305_context *ctx,
+  unsigned char            mac[16]
+  )
+{
+  uint32_t h0;
+  uint32_t h1;
+  uint32_t h2;
+  uint32_t h3;
+  uint32_t h4;
+  uint32_t g0;
+  uint32_t g1;
+  uint32_t g2;
+  uint32_t g3;
+  uint32_t g4;
+  uint32_t c;
+  uint32_t mask;
+  uint64_t f;
+
+  h0 = (uint32_t)ctx->h[0];
+  h1 = (uint32_t)ctx->h[1];
+  h2 = (uint32_t)ctx->h[2];
+  h3 = (uint32_t)ctx->h[3];
+  h4 = (uint32_t)ctx->h[4];
+
+  c = h1 >> 26;
+  h1 &= POLY1305_MASK26;
+  h2 += c;
+  c = h2 >> 26;
+  h2 &= POLY1305_MASK26;
+  h3 += c;
+  c = h3 >> 26;
+  h3 &= POLY1305_MASK26;
+  h4 += c;
+  c = h4 >> 26;
+  h4 &= POLY1305_MASK26;
+  h0 += c * 5;
+  c = h0 >> 26;
+  h0 &= POLY1305_MASK26;
+  h1 += c;
+
+  //
+  // g = h + 5 - 2^130; use it instead of h when it does not borrow.
+  //
+  g0 = h0 + 5;
+  c = g0 >> 26;
+  g0 &= POLY1305_MASK26;
+  g1 = h1 + c;
+  c = g1 >> 26;
+  g1 &= POLY1305_MASK26;
+  g2 = h2 + c;
+  c = g2 >> 26;
+  g2 &= POLY1305_MASK26;
+  g3 = h3 + c;
+  c = g3 >> 26;
+  g3 &= POLY1305_MASK26;
+  g4 = h4 + c - (1u << 26);
+
+  mask = (g4 >> 31) - 1;
+  h0 = (h0 & ~mask) | (g0 & mask);
+  h1 = (h1 & ~mask) | (g1 & mask);
+  h2 = (h2 & ~mask) | (g2 & mask);
+  h3 = (h3 & ~mask) | (g3 & mask);
+  h4 = (h4 & ~mask) | (g4 & mask);
+
+  h0 = h0 | (h1 << 26);
+  h1 = (h1 >> 6) | (h2 << 20);
+  h2 = (h2 >> 12) | (h3 << 14);
+  h3 = (h3 >> 18) | (h4 << 8);
+
+  f = (uint64_t)h0 + ctx->s[0];
+  mbedtls_accel_poly1305_store32 (mac, (uint32_t)f);
+  f = (uint64_t)h1 + ctx->s[1] + (f >> 32);
+  mbedtls_accel_poly1305_store32 (mac + 4, (uint32_t)f);
+  f = (uint64_t)h2 + ctx->s[2] + (f >> 32);
+  mbedtls_accel_poly1305_store32 (mac + 8, (uint32_t)f);
+  f = (uint64_t)h3 + ctx->s[3] + (f >> 32);
+  mbedtls_accel_poly1305_store32 (mac + 12, (uint32_t)f);
+}
+
+#endif
+
+void
+mbedtls_poly1305_init (
+  mbedtls_poly1305_context *ctx
+  )
+{
+  mbedtls_platform_zeroize (ctx, sizeof(mbedtls_poly1305_context));
+}
+
+void
+mbedtls_poly1305_free (
+  mbedtls_poly1305_context *ctx
+  )
+{
+  if (ctx != NULL) {
+    mbedtls_platform_zeroize (ctx, sizeof(mbedtls_poly1305_context));
+  }
+}
+
+int
+mbedtls_poly1305_starts (
+  mbedtls_poly1305_context *ctx,
+  const unsigned char      key[32]
+  )
+{
+  mbedtls_platform_zeroize (ctx, sizeof(mbedtls_poly1305_context));
+
+  mbedtls_accel_poly1305_set_r (ctx, key);
+  ctx->s[0] = mbedtls_accel_poly1305_load32 (key + 16);
+  ctx->s[1] = mbedtls_accel_poly1305_load32 (key + 20);
+  ctx->s[2] = mbedtls_accel_poly1305_load32 (key + 24);
+  ctx->s[3] = mbedtls_accel_poly1305_load32 (key + 28);
+
+  return 0;
+}
+
+int
+mbedtls_poly1305_update (
+  mbedtls_poly1305_context *ctx,
+  const unsigned char      *input,
+  size_t                   ilen
+  )
+{
+  size_t queue_free_len;
+  size_t nblocks;
+
+  if ((ctx->queue_len > 0) && (ilen > 0)) {
+    queue_free_len = POLY1305_BLOCK_SIZE_BYTES - ctx->queue_len;
+    if (ilen < queue_free_len) {
+      //
+      // Not enough data to complete the block.
+      //
+      memcpy (&ctx->queue[ctx->queue_len], input, ilen);
+      ctx->queue_len += ilen;
+      return 0;
+    }
+
+    //
+    // Enough data to produce a complete block.
+    //
+    memcpy (&ctx->queue[ctx->queue_len], input, queue_free_len);
+    ctx->queue_len = 0;
+    mbedtls_accel_poly1305_blocks (ctx, ctx->queue, 1, 1);
+    input += queue_free_len;
+    ilen -= queue_free_len;
+  }
+
+  nblocks = ilen / POLY1305_BLOCK_SIZE_BYTES;
+  if (nblocks > 0) {
+    mbedtls_accel_poly1305_blocks (ctx, input, nblocks, 1);
+    input += nblocks * POLY1305_BLOCK_SIZE_BYTES;
+    ilen -= nblocks * POLY1305_BLOCK_SIZE_BYTES;
+  }
+
+  if (ilen > 0) {
+    //
+    // Store partial block.
+    //
+    ctx->queue_len = ilen;
+    memcpy (ctx->queue, input, ilen);
+  }
+
+  return 0;
+}
+
+int
+mbedtls_poly1305_finish (
+  mbedtls_poly1305_context *ctx,
+  unsigned char            mac[16]
+  )
+{
+  //
+  // Process any leftover data, padded with a 1 bit and zeros.
+  //
+  if (ctx->queue_len > 0) {
+    ctx->queue[ctx->queue_len] = 1;
+    ctx->queue_len++;
+    memset (&ctx->queue[ctx->queue_len], 0, POLY1305_BLOCK_SIZE_BYTES - ctx->queue_len);
+    mbedtls_accel_poly1305_blocks (ctx, ctx->queue, 1, 0);
+  }
+
+  mbedtls_accel_poly1305_emit (ctx, mac);
+
+  return 0;
+}
+
+int
+mbedtls_poly1305_mac (
+  const unsigned char key[32],
+  const unsigned char *input,
+  size_t              ilen,
+  unsigned char       mac[16]
+  )
+{
+  mbedtls_poly1305_context ctx;
+  int ret;
+
+  mbedtls_poly1305_init (&ctx);
+
+  ret = mbedtls_poly1305_starts (&ctx, key);
+  if (ret != 0) {
+    goto cleanup;
+  }
+  ret = mbedtls_poly1305_update (&ctx, input, ilen);
+  if (ret != 0) {
+    goto cleanup;
+  }
+  ret = mbedtls_poly1305_finish (&ctx, mac);
+
+cleanup:
+  mbedtls_poly1305_free (&ctx);
+  return ret;
+}
+
+#endif
@@ -0,0 +1,497 @@
+/** @file
+  SHA-256 block function for MBEDTLS_SHA256_PROCESS_ALT, and a multi-buffer
+  one-shot hash for MBEDTLS_ACCEL_SHA256_MULTI.
+
+  Uses the x86 SHA extensions or the ARMv8 SHA2 extension when the CPU has
+  them, and a portable implementation otherwise.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "AccelInternal.h"
+
+#if defined(MBEDTLS_SHA256_C) && defined(MBEDTLS_SHA256_PROCESS_ALT)
+
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha256_multi.h"
+
+#if defined(MBEDTLS_ACCEL_X86)
+#include <immintrin.h>
+#elif defined(MBEDTLS_ACCEL_AARCH64)
+#include <arm_neon.h>
+#endif
+
+static const uint32_t mbedtls_accel_sha256_k[64] = {
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+#define SHA256_ROTR(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+#define SHA256_S0(x)       (SHA256_ROTR (x, 7) ^ SHA256_ROTR (x, 18) ^ ((x) >> 3))
+#define SHA256_S1(x)       (SHA256_ROTR (x, 17) ^ SHA256_ROTR (x, 19) ^ ((x) >> 10))
+#define SHA256_S2(x)       (SHA256_ROTR (x, 2) ^ SHA256_ROTR (x, 13) ^ SHA256_ROTR (x, 22))
+#define SHA256_S3(x)       (SHA256_ROTR (x, 6) ^ SHA256_ROTR (x, 11) ^ SHA256_ROTR (x, 25))
+#define SHA256_CH(x, y, z)   ((z) ^ ((x) & ((y) ^ (z))))
+#define SHA256_MAJ(x, y, z)  (((x) & (y)) | ((z) & ((x) | (y))))
+
+/**
+  Portable SHA-256 compression function.
+
+  @param  state                        The eight SHA-256 state words.
+  @param  data                         One 64-byte block.
+**/
+static void
+mbedtls_accel_sha256_block_c (
+  uint32_t            state[8],
+  const unsigned char data[64]
+  )
+{
+  uint32_t w[64];
+  uint32_t a[8];
+  uint32_t t1;
+  uint32_t t2;
+  unsigned int i;
+
+  for (i = 0; i < 16; i++) {
+    w[i] = ((uint32_t)data[4 * i] << 24) | ((uint32_t)data[4 * i + 1] << 16) |
+           ((uint32_t)data[4 * i + 2] << 8) | (uint32_t)data[4 * i + 3];
+  }
+  for (i = 16; i < 64; i++) {
+    w[i] = SHA256_S1 (w[i - 2]) + w[i - 7] + SHA256_S0 (w[i - 15]) + w[i - 16];
+  }
+
+  for (i = 0; i < 8; i++) {
+    a[i] = state[i];
+  }
+  for (i = 0; i < 64; i++) {
+    t1 = a[7] + SHA256_S3 (a[4]) + SHA256_CH (a[4], a[5], a[6]) + mbedtls_accel_sha256_k[i] + w[i];
+    t2 = SHA256_S2 (a[0]) + SHA256_MAJ (a[0], a[1], a[2]);
+    a[7] = a[6];
+    a[6] = a[5];
+    a[5] = a[4];
+    a[4] = a[3] + t1;
+    a[3] = a[2];
+    a[2] = a[1];
+    a[1] = a[0];
+    a[0] = t1 + t2;
+  }
+  for (i = 0; i < 8; i++) {
+    state[i] += a[i];
+  }
+}
+
+#if defined(MBEDTLS_ACCEL_X86)
+
+/**
+  SHA-256 compression function using the x86 SHA extensions.
+
+  @param  state                        The eight SHA-256 state words.
+  @param  data                         One 64-byte block.
+**/
+MBEDTLS_ACCEL_TARGET_SHA256
+static void
+mbedtls_accel_sha256_block_x86 (
+  uint32_t            state[8],
+  const unsigned char data[64]
+  )
+{
+  static const unsigned char bswap_mask[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+  __m128i mask;
+  __m128i state0;
+  __m128i state1;
+  __m128i abef_save;
+  __m128i cdgh_save;
+  __m128i msg;
+  __m128i tmp;
+  __m128i w[4];
+  unsigned int i;
+
+  mask = _mm_loadu_si128 ((const __m128i *)bswap_mask);
+
+  //
+  // The SHA-NI round instruction works on {ABEF} and {CDGH}.
+  //
+  tmp = _mm_loadu_si128 ((const __m128i *)&state[0]);
+  state1 = _mm_loadu_si128 ((const __m128i *)&state[4]);
+  tmp = _mm_shuffle_epi32 (tmp, 0xB1);
+  state1 = _mm_shuffle_epi32 (state1, 0x1B);
+  state0 = _mm_alignr_epi8 (tmp, state1, 8);
+  state1 = _mm_blend_epi16 (state1, tmp, 0xF0);
+
+  abef_save = state0;
+  cdgh_save = state1;
+
+  for (i = 0; i < 16; i++) {
+    if (i < 4) {
+      w[i] = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *)(data + 16 * i)), mask);
+    } else {
+      //
+      // W[4i..4i+3] from the four previous message groups.
+      //
+      tmp = _mm_sha256msg1_epu32 (w[i & 3], w[(i + 1) & 3]);
+      tmp = _mm_add_epi32 (tmp, _mm_alignr_epi8 (w[(i + 3) & 3], w[(i + 2) & 3], 4));
+      w[i & 3] = _mm_sha256msg2_epu32 (tmp, w[(i + 3) & 3]);
+    }
+
+    msg = _mm_add_epi32 (w[i & 3], _mm_loadu_si128 ((const __m128i *)&mbedtls_accel_sha256_k[4 * i]));
+    state1 = _mm_sha256rnds2_epu32 (state1, state0, msg);
+    msg = _mm_shuffle_epi32 (msg, 0x0E);
+    state0 = _mm_sha256rnds2_epu32 (state0, state1, msg);
+  }
+
+  state0 = _mm_add_epi32 (state0, abef_save);
+  state1 = _mm_add_epi32 (state1, cdgh_save);
+
+  tmp = _mm_shuffle_epi32 (state0, 0x1B);
+  state1 = _mm_shuffle_epi32 (state1, 0xB1);
+  state0 = _mm_blend_epi16 (tmp, state1, 0xF0);
+  state1 = _mm_alignr_epi8 (state1, tmp, 8);
+
+  _mm_storeu_si128 ((__m128i *)&state[0], state0);
+  _mm_storeu_si128 ((__m128i *)&state[4], state1);
+}
+
+/**
+  Two independent SHA-256 compression functions using the x86 SHA extensions.
+
+  The round instructions of one lane have a latency of several cycles; issuing
+  the rounds of a second message in between keeps the SHA unit busy.
+
+  @param  state_a                      The eight SHA-256 state words of lane A.
+  @param  data_a                       One 64-byte block of lane A.
+  @param  state_b                      The eight SHA-256 state words of lane B.
+  @param  data_b                       One 64-byte block of lane B.
+**/
+MBEDTLS_ACCEL_TARGET_SHA256
+static void
+mbedtls_accel_sha256_block2_x86 (
+  uint32_t            state_a[8],
+  const unsigned char data_a[64],
+  uint32_t            state_b[8],
+  const unsigned char data_b[64]
+  )
+{
+  static const unsigned char bswap_mask[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+  __m128i mask;
+  __m128i k;
+  __m128i state0_a;
+  __m128i state1_a;
+  __m128i state0_b;
+  __m128i state1_b;
+  __m128i abef_save_a;
+  __m128i cdgh_save_a;
+  __m128i abef_save_b;
+  __m128i cdgh_save_b;
+  __m128i msg_a;
+  __m128i msg_b;
+  __m128i tmp_a;
+  __m128i tmp_b;
+  __m128i w_a[4];
+  __m128i w_b[4];
+  unsigned int i;
+
+  mask = _mm_loadu_si128 ((const __m128i *)bswap_mask);
+
+  tmp_a = _mm_loadu_si128 ((const __m128i *)&state_a[0]);
+  tmp_b = _mm_loadu_si128 ((const __m128i *)&state_b[0]);
+  state1_a = _mm_loadu_si128 ((const __m128i *)&state_a[4]);
+  state1_b = _mm_loadu_si128 ((const __m128i *)&state_b[4]);
+  tmp_a = _mm_shuffle_epi32 (tmp_a, 0xB1);
+  tmp_b = _mm_shuffle_epi32 (tmp_b, 0xB1);
+  state1_a = _mm_shuffle_epi32 (state1_a, 0x1B);
+  state1_b = _mm_shuffle_epi32 (state1_b, 0x1B);
+  state0_a = _mm_alignr_epi8 (tmp_a, state1_a, 8);
+  state0_b = _mm_alignr_epi8 (tmp_b, state1_b, 8);
+  state1_a = _mm_blend_epi16 (state1_a, tmp_a, 0xF0);
+  state1_b = _mm_blend_epi16 (state1_b, tmp_b, 0xF0);
+
+  abef_save_a = state0_a;
+  cdgh_save_a = state1_a;
+  abef_save_b = state0_b;
+  cdgh_save_b = state1_b;
+
+  for (i = 0; i < 16; i++) {
+    if (i < 4) {
+      w_a[i] = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *)(data_a + 16 * i)), mask);
+      w_b[i] = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *)(data_b + 16 * i)), mask);
+    } else {
+      tmp_a = _mm_sha256msg1_epu32 (w_a[i & 3], w_a[(i + 1) & 3]);
+      tmp_b = _mm_sha256msg1_epu32 (w_b[i & 3], w_b[(i + 1) & 3]);
+      tmp_a = _mm_add_epi32 (tmp_a, _mm_alignr_epi8 (w_a[(i + 3) & 3], w_a[(i + 2) & 3], 4));
+      tmp_b = _mm_add_epi32 (tmp_b, _mm_alignr_epi8 (w_b[(i + 3) & 3], w_b[(i + 2) & 3], 4));
+      w_a[i & 3] = _mm_sha256msg2_epu32 (tmp_a, w_a[(i + 3) & 3]);
+      w_b[i & 3] = _mm_sha256msg2_epu32 (tmp_b, w_b[(i + 3) & 3]);
+    }
+
+    k = _mm_loadu_si128 ((const __m128i *)&mbedtls_accel_sha256_k[4 * i]);
+    msg_a = _mm_add_epi32 (w_a[i & 3], k);
+    msg_b = _mm_add_epi32 (w_b[i & 3], k);
+    state1_a = _mm_sha256rnds2_epu32 (state1_a, state0_a, msg_a);
+    state1_b = _mm_sha256rnds2_epu32 (state1_b, state0_b, msg_b);
+    msg_a = _mm_shuffle_epi32 (msg_a, 0x0E);
+    msg_b = _mm_shuffle_epi32 (msg_b, 0x0E);
+    state0_a = _mm_sha256rnds2_epu32 (state0_a, state1_a, msg_a);
+    state0_b = _mm_sha256rnds2_epu32 (state0_b, state1_b, msg_b);
+  }
+
+  state0_a = _mm_add_epi32 (state0_a, abef_save_a);
+  state1_a = _mm_add_epi32 (state1_a, cdgh_save_a);
+  state0_b = _mm_add_epi32 (state0_b, abef_save_b);
+  state1_b = _mm_add_epi32 (state1_b, cdgh_save_b);
+
+  tmp_a = _mm_shuffle_epi32 (state0_a, 0x1B);
+  tmp_b = _mm_shuffle_epi32 (state0_b, 0x1B);
+  state1_a = _mm_shuffle_epi32 (state1_a, 0xB1);
+  state1_b = _mm_shuffle_epi32 (state1_b, 0xB1);
+  state0_a = _mm_blend_epi16 (tmp_a, state1_a, 0xF0);
+  state0_b = _mm_blend_epi16 (tmp_b, state1_b, 0xF0);
+  state1_a = _mm_alignr_epi8 (state1_a, tmp_a, 8);
+  state1_b = _mm_alignr_epi8 (state1_b, tmp_b, 8);
+
+  _mm_storeu_si128 ((__m128i *)&state_a[0], state0_a);
+  _mm_storeu_si128 ((__m128i *)&state_a[4], state1_a);
+  _mm_storeu_si128 ((__m128i *)&state_b[0], state0_b);
+  _mm_storeu_si128 ((__m128i *)&state_b[4], state1_b);
+}
+
+#elif defined(MBEDTLS_ACCEL_AARCH64)
+
+/**
+  SHA-256 compression function using the ARMv8 SHA2 extension.
+
+  @param  state                        The eight SHA-256 state words.
+  @param  data                         One 64-byte block.
+**/
+MBEDTLS_ACCEL_TARGET_SHA256
+static void
+mbedtls_accel_sha256_block_arm (
+  uint32_t            state[8],
+  const unsigned char data[64]
+  )
+{
+  uint32x4_t state0;
+  uint32x4_t state1;
+  uint32x4_t abcd_save;
+  uint32x4_t efgh_save;
+  uint32x4_t abcd;
+  uint32x4_t wk;
+  uint32x4_t w[4];
+  unsigned int i;
+
+  state0 = vld1q_u32 (&state[0]);
+  state1 = vld1q_u32 (&state[4]);
+  abcd_save = state0;
+  efgh_save = state1;
+
+  for (i = 0; i < 16; i++) {
+    if (i < 4) {
+      w[i] = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data + 16 * i)));
+    } else {
+      w[i & 3] = vsha256su1q_u32 (vsha256su0q_u32 (w[i & 3], w[(i + 1) & 3]), w[(i + 2) & 3], w[(i + 3) & 3]);
+    }
+
+    wk = vaddq_u32 (w[i & 3], vld1q_u32 (&mbedtls_accel_sha256_k[4 * i]));
+    abcd = state0;
+    state0 = vsha256hq_u32 (state0, state1, wk);
+    state1 = vsha256h2q_u32 (state1, abcd, wk);
+  }
+
+  vst1q_u32 (&state[0], vaddq_u32 (state0, abcd_save));
+  vst1q_u32 (&state[4], vaddq_u32 (state1, efgh_save));
+}
+
+/**
+  Two independent SHA-256 compression functions using the ARMv8 SHA2 extension.
+
+  @param  state_a                      The eight SHA-256 state words of lane A.
+  @param  data_a                       One 64-byte block of lane A.
+  @param  state_b                      The eight SHA-256 state words of lane B.
+  @param  data_b                       One 64-byte block of lane B.
+**/
+MBEDTLS_ACCEL_TARGET_SHA256
+static void
+mbedtls_accel_sha256_block2_arm (
+  uint32_t            state_a[8],
+  const unsigned char data_a[64],
+  uint32_t            state_b[8],
+  const unsigned char data_b[64]
+  )
+{
+  uint32x4_t state0_a;
+  uint32x4_t state1_a;
+  uint32x4_t state0_b;
+  uint32x4_t state1_b;
+  uint32x4_t abcd_save_a;
+  uint32x4_t efgh_save_a;
+  uint32x4_t abcd_save_b;
+  uint32x4_t efgh_save_b;
+  uint32x4_t abcd_a;
+  uint32x4_t abcd_b;
+  uint32x4_t k;
+  uint32x4_t wk_a;
+  uint32x4_t wk_b;
+  uint32x4_t w_a[4];
+  uint32x4_t w_b[4];
+  unsigned int i;
+
+  state0_a = vld1q_u32 (&state_a[0]);
+  state1_a = vld1q_u32 (&state_a[4]);
+  state0_b = vld1q_u32 (&state_b[0]);
+  state1_b = vld1q_u32 (&state_b[4]);
+  abcd_save_a = state0_a;
+  efgh_save_a = state1_a;
+  abcd_save_b = state0_b;
+  efgh_save_b = state1_b;
+
+  for (i = 0; i < 16; i++) {
+    if (i < 4) {
+      w_a[i] = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data_a + 16 * i)));
+      w_b[i] = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data_b + 16 * i)));
+    } else {
+      w_a[i & 3] = vsha256su1q_u32 (vsha256su0q_u32 (w_a[i & 3], w_a[(i + 1) & 3]), w_a[(i + 2) & 3], w_a[(i + 3) & 3]);
+      w_b[i & 3] = vsha256su1q_u32 (vsha256su0q_u32 (w_b[i & 3], w_b[(i + 1) & 3]), w_b[(i + 2) & 3], w_b[(i + 3) & 3]);
+    }
+
+    k = vld1q_u32 (&mbedtls_accel_sha256_k[4 * i]);
+    wk_a = vaddq_u32 (w_a[i & 3], k);
+    wk_b = vaddq_u32 (w_b[i & 3], k);
+    abcd_a = state0_a;
+    abcd_b = state0_b;
+    state0_a = vsha256hq_u32 (state0_a, state1_a, wk_a);
+    state0_b = vsha256hq_u32 (state0_b, state1_b, wk_b);
+    state1_a = vsha256h2q_u32 (state1_a, abcd_a, wk_a);
+    state1_b = vsha256h2q_u32 (state1_b, abcd_b, wk_b);
+  }
+
+  vst1q_u32 (&state_a[0], vaddq_u32 (state0_a, abcd_save_a));
+  vst1q_u32 (&state_a[4], vaddq_u32 (state1_a, efgh_save_a));
+  vst1q_u32 (&state_b[0], vaddq_u32 (state0_b, abcd_save_b));
+  vst1q_u32 (&state_b[4], vaddq_u32 (state1_b, efgh_save_b));
+}
+
+#endif
+
+int
+mbedtls_internal_sha256_process (
+  mbedtls_sha256_context *ctx,
+  const unsigned char    data[64]
+  )
+{
+  if ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_SHA256) != 0) {
+#if defined(MBEDTLS_ACCEL_X86)
+    mbedtls_accel_sha256_block_x86 (ctx->state, data);
+    return 0;
+#elif defined(MBEDTLS_ACCEL_AARCH64)
+    mbedtls_accel_sha256_block_arm (ctx->state, data);
+    return 0;
+#endif
+  }
+
+  mbedtls_accel_sha256_block_c (ctx->state, data);
+  return 0;
+}
+
+#if defined(MBEDTLS_ACCEL_SHA256_MULTI)
+
+/**
+  Hash two messages, running the full 64-byte blocks they have in common
+  through the two-lane kernel, and finish each one separately.
+
+  @param  input                        The two messages.
+  @param  ilen                         The two message lengths in bytes.
+  @param  output                       The two 32-byte digest buffers.
+
+  @return 0 on success, or an MbedTLS error code.
+**/
+static int
+mbedtls_accel_sha256_pair (
+  const unsigned char *const input[2],
+  const size_t               ilen[2],
+  unsigned char *const       output[2]
+  )
+{
+  mbedtls_sha256_context ctx[2];
+  size_t                 done;
+  size_t                 offset;
+  unsigned int           lane;
+  int                    ret;
+
+  done = ((ilen[0] < ilen[1]) ? ilen[0] : ilen[1]) & ~(size_t)63;
+
+  ret = 0;
+  for (lane = 0; lane < 2; lane++) {
+    mbedtls_sha256_init (&ctx[lane]);
+    if (ret == 0) {
+      ret = mbedtls_sha256_starts_ret (&ctx[lane], 0);
+    }
+  }
+
+  if (ret == 0) {
+    for (offset = 0; offset < done; offset += 64) {
+#if defined(MBEDTLS_ACCEL_X86)
+      mbedtls_accel_sha256_block2_x86 (ctx[0].state, input[0] + offset, ctx[1].state, input[1] + offset);
+#elif defined(MBEDTLS_ACCEL_AARCH64)
+      mbedtls_accel_sha256_block2_arm (ctx[0].state, input[0] + offset, ctx[1].state, input[1] + offset);
+#endif
+    }
+
+    //
+    // Account for the blocks processed above, then let MbedTLS hash the
+    // remainder and the padding of each lane.
+    //
+    for (lane = 0; lane < 2 && ret == 0; lane++) {
+      ctx[lane].total[0] = (uint32_t)done;
+      ctx[lane].total[1] = (uint32_t)((uint64_t)done >> 32);
+      ret = mbedtls_sha256_update_ret (&ctx[lane], input[lane] + done, ilen[lane] - done);
+      if (ret == 0) {
+        ret = mbedtls_sha256_finish_ret (&ctx[lane], output[lane]);
+      }
+    }
+  }
+
+  mbedtls_sha256_free (&ctx[0]);
+  mbedtls_sha256_free (&ctx[1]);
+  return ret;
+}
+
+int
+mbedtls_accel_sha256_multi (
+  size_t                     count,
+  const unsigned char *const input[],
+  const size_t               ilen[],
+  unsigned char *const       output[]
+  )
+{
+  size_t index;
+  int    ret;
+
+  index = 0;
+  if ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_SHA256) != 0) {
+    for (; index + 1 < count; index += 2) {
+      ret = mbedtls_accel_sha256_pair (&input[index], &ilen[index], &output[index]);
+      if (ret != 0) {
+        return ret;
+      }
+    }
+  }
+
+  for (; index < count; index++) {
+    ret = mbedtls_sha256_ret (input[index], ilen[index], output[index], 0);
+    if (ret != 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,195 @@
+/** @file
+  SHA-512 block function for MBEDTLS_SHA512_PROCESS_ALT.
+
+  Uses the ARMv8.2 SHA512 extension when the CPU has it, and a portable
+  implementation otherwise.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "AccelInternal.h"
+
+#if defined(MBEDTLS_SHA512_C) && defined(MBEDTLS_SHA512_PROCESS_ALT)
+
+#include "mbedtls/sha512.h"
+
+#if defined(MBEDTLS_ACCEL_AARCH64)
+#include <arm_neon.h>
+#endif
+
+static const uint64_t mbedtls_accel_sha512_k[80] = {
+  0x428A2F98D728AE22ULL, 0x7137449123EF65CDULL, 0xB5C0FBCFEC4D3B2FULL, 0xE9B5DBA58189DBBCULL,
+  0x3956C25BF348B538ULL, 0x59F111F1B605D019ULL, 0x923F82A4AF194F9BULL, 0xAB1C5ED5DA6D8118ULL,
+  0xD807AA98A3030242ULL, 0x12835B0145706FBEULL, 0x243185BE4EE4B28CULL, 0x550C7DC3D5FFB4E2ULL,
+  0x72BE5D74F27B896FULL, 0x80DEB1FE3B1696B1ULL, 0x9BDC06A725C71235ULL, 0xC19BF174CF692694ULL,
+  0xE49B69C19EF14AD2ULL, 0xEFBE4786384F25E3ULL, 0x0FC19DC68B8CD5B5ULL, 0x240CA1CC77AC9C65ULL,
+  0x2DE92C6F592B0275ULL, 0x4A7484AA6EA6E483ULL, 0x5CB0A9DCBD41FBD4ULL, 0x76F988DA831153B5ULL,
+  0x983E5152EE66DFABULL, 0xA831C66D2DB43210ULL, 0xB00327C898FB213FULL, 0xBF597FC7BEEF0EE4ULL,
+  0xC6E00BF33DA88FC2ULL, 0xD5A79147930AA725ULL, 0x06CA6351E003826FULL, 0x142929670A0E6E70ULL,
+  0x27B70A8546D22FFCULL, 0x2E1B21385C26C926ULL, 0x4D2C6DFC5AC42AEDULL, 0x53380D139D95B3DFULL,
+  0x650A73548BAF63DEULL, 0x766A0ABB3C77B2A8ULL, 0x81C2C92E47EDAEE6ULL, 0x92722C851482353BULL,
+  0xA2BFE8A14CF10364ULL, 0xA81A664BBC423001ULL, 0xC24B8B70D0F89791ULL, 0xC76C51A30654BE30ULL,
+  0xD192E819D6EF5218ULL, 0xD69906245565A910ULL, 0xF40E35855771202AULL, 0x106AA07032BBD1B8ULL,
+  0x19A4C116B8D2D0C8ULL, 0x1E376C085141AB53ULL, 0x2748774CDF8EEB99ULL, 0x34B0BCB5E19B48A8ULL,
+  0x391C0CB3C5C95A63ULL, 0x4ED8AA4AE3418ACBULL, 0x5B9CCA4F7763E373ULL, 0x682E6FF3D6B2B8A3ULL,
+  0x748F82EE5DEFB2FCULL, 0x78A5636F43172F60ULL, 0x84C87814A1F0AB72ULL, 0x8CC702081A6439ECULL,
+  0x90BEFFFA23631E28ULL, 0xA4506CEBDE82BDE9ULL, 0xBEF9A3F7B2C67915ULL, 0xC67178F2E372532BULL,
+  0xCA273ECEEA26619CULL, 0xD186B8C721C0C207ULL, 0xEADA7DD6CDE0EB1EULL, 0xF57D4F7FEE6ED178ULL,
+  0x06F067AA72176FBAULL, 0x0A637DC5A2C898A6ULL, 0x113F9804BEF90DAEULL, 0x1B710B35131C471BULL,
+  0x28DB77F523047D84ULL, 0x32CAAB7B40C72493ULL, 0x3C9EBE0A15C9BEBCULL, 0x431D67C49C100D4CULL,
+  0x4CC5D4BECB3E42B6ULL, 0x597F299CFC657E2AULL, 0x5FCB6FAB3AD6FAECULL, 0x6C44198C4A475817ULL,
+};
+
+#define SHA512_ROTR(x, n)  (((x) >> (n)) | ((x) << (64 - (n))))
+#define SHA512_S0(x)       (SHA512_ROTR (x, 1) ^ SHA512_ROTR (x, 8) ^ ((x) >> 7))
+#define SHA512_S1(x)       (SHA512_ROTR (x, 19) ^ SHA512_ROTR (x, 61) ^ ((x) >> 6))
+#define SHA512_S2(x)       (SHA512_ROTR (x, 28) ^ SHA512_ROTR (x, 34) ^ SHA512_ROTR (x, 39))
+#define SHA512_S3(x)       (SHA512_ROTR (x, 14) ^ SHA512_ROTR (x, 18) ^ SHA512_ROTR (x, 41))
+#define SHA512_CH(x, y, z)   ((z) ^ ((x) & ((y) ^ (z))))
+#define SHA512_MAJ(x, y, z)  (((x) & (y)) | ((z) & ((x) | (y))))
+
+/**
+  Portable SHA-512 compression function.
+
+  @param  state                        The eight SHA-512 state words.
+  @param  data                         One 128-byte block.
+**/
+static void
+mbedtls_accel_sha512_block_c (
+  uint64_t            state[8],
+  const unsigned char data[128]
+  )
+{
+  uint64_t w[80];
+  uint64_t a[8];
+  uint64_t t1;
+  uint64_t t2;
+  unsigned int i;
+  unsigned int j;
+
+  for (i = 0; i < 16; i++) {
+    w[i] = 0;
+    for (j = 0; j < 8; j++) {
+      w[i] = (w[i] << 8) | data[8 * i + j];
+    }
+  }
+  for (i = 16; i < 80; i++) {
+    w[i] = SHA512_S1 (w[i - 2]) + w[i - 7] + SHA512_S0 (w[i - 15]) + w[i - 16];
+  }
+
+  for (i = 0; i < 8; i++) {
+    a[i] = state[i];
+  }
+  for (i = 0; i < 80; i++) {
+    t1 = a[7] + SHA512_S3 (a[4]) + SHA512_CH (a[4], a[5], a[6]) + mbedtls_accel_sha512_k[i] + w[i];
+    t2 = SHA512_S2 (a[0]) + SHA512_MAJ (a[0], a[1], a[2]);
+    a[7] = a[6];
+    a[6] = a[5];
+    a[5] = a[4];
+    a[4] = a[3] + t1;
+    a[3] = a[2];
+    a[2] = a[1];
+    a[1] = a[0];
+    a[0] = t1 + t2;
+  }
+  for (i = 0; i < 8; i++) {
+    state[i] += a[i];
+  }
+}
+
+#if defined(MBEDTLS_ACCEL_AARCH64)
+
+//
+// Two rounds. The four state registers rotate by one position every call,
+// which the callers below express by permuting the arguments.
+//
+#define SHA512_ARM_ROUNDS(s0, s1, s2, s3, w, k)                                      \
+  do {                                                                                 \
+    uint64x2_t sum_;                                                                   \
+    uint64x2_t intermed_;                                                              \
+    sum_ = vaddq_u64 (w, vld1q_u64 (k));                                               \
+    sum_ = vaddq_u64 (vextq_u64 (sum_, sum_, 1), s3);                                  \
+    intermed_ = vsha512hq_u64 (sum_, vextq_u64 (s2, s3, 1), vextq_u64 (s1, s2, 1));     \
+    s3 = vsha512h2q_u64 (intermed_, s1, s0);                                           \
+    s1 = vaddq_u64 (s1, intermed_);                                                    \
+  } while (0)
+
+/**
+  SHA-512 compression function using the ARMv8.2 SHA512 extension.
+
+  @param  state                        The eight SHA-512 state words.
+  @param  data                         One 128-byte block.
+**/
+MBEDTLS_ACCEL_TARGET_SHA512
+static void
+mbedtls_accel_sha512_block_arm (
+  uint64_t            state[8],
+  const unsigned char data[128]
+  )
+{
+  uint64x2_t ab;
+  uint64x2_t cd;
+  uint64x2_t ef;
+  uint64x2_t gh;
+  uint64x2_t w[8];
+  unsigned int i;
+  unsigned int t;
+
+  ab = vld1q_u64 (&state[0]);
+  cd = vld1q_u64 (&state[2]);
+  ef = vld1q_u64 (&state[4]);
+  gh = vld1q_u64 (&state[6]);
+
+  for (i = 0; i < 8; i++) {
+    w[i] = vreinterpretq_u64_u8 (vrev64q_u8 (vld1q_u8 (data + 16 * i)));
+  }
+
+  for (t = 0; t < 80; t += 16) {
+    if (t != 0) {
+      //
+      // Slot i holds message pair i mod 8; updating the slots in order
+      // leaves every operand at the round it is needed for.
+      //
+      for (i = 0; i < 8; i++) {
+        w[i] = vsha512su1q_u64 (vsha512su0q_u64 (w[i], w[(i + 1) & 7]), w[(i + 7) & 7],
+                                vextq_u64 (w[(i + 4) & 7], w[(i + 5) & 7], 1));
+      }
+    }
+    SHA512_ARM_ROUNDS (ab, cd, ef, gh, w[0], &mbedtls_accel_sha512_k[t + 0]);
+    SHA512_ARM_ROUNDS (gh, ab, cd, ef, w[1], &mbedtls_accel_sha512_k[t + 2]);
+    SHA512_ARM_ROUNDS (ef, gh, ab, cd, w[2], &mbedtls_accel_sha512_k[t + 4]);
+    SHA512_ARM_ROUNDS (cd, ef, gh, ab, w[3], &mbedtls_accel_sha512_k[t + 6]);
+    SHA512_ARM_ROUNDS (ab, cd, ef, gh, w[4], &mbedtls_accel_sha512_k[t + 8]);
+    SHA512_ARM_ROUNDS (gh, ab, cd, ef, w[5], &mbedtls_accel_sha512_k[t + 10]);
+    SHA512_ARM_ROUNDS (ef, gh, ab, cd, w[6], &mbedtls_accel_sha512_k[t + 12]);
+    SHA512_ARM_ROUNDS (cd, ef, gh, ab, w[7], &mbedtls_accel_sha512_k[t + 14]);
+  }
+
+  vst1q_u64 (&state[0], vaddq_u64 (ab, vld1q_u64 (&state[0])));
+  vst1q_u64 (&state[2], vaddq_u64 (cd, vld1q_u64 (&state[2])));
+  vst1q_u64 (&state[4], vaddq_u64 (ef, vld1q_u64 (&state[4])));
+  vst1q_u64 (&state[6], vaddq_u64 (gh, vld1q_u64 (&state[6])));
+}
+
+#endif
+
+int
+mbedtls_internal_sha512_process (
+  mbedtls_sha512_context *ctx,
+  const unsigned char    data[128]
+  )
+{
+#if defined(MBEDTLS_ACCEL_AARCH64)
+  if ((mbedtls_accel_cpu_features () & MBEDTLS_ACCEL_CPU_SHA512) != 0) {
+    mbedtls_accel_sha512_block_arm (ctx->state, data);
+    return 0;
+  }
+#endif
+
+  mbedtls_accel_sha512_block_c (ctx->state, data);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * \file accel_config.h
+ *
+ * \brief Hardware acceleration for the openspdm MbedTLS backend.
+ *
+ * The MBEDTLS_ACCEL=ON build option passes this file as
+ * MBEDTLS_USER_CONFIG_FILE, so it is applied on top of config.h in every
+ * unit that includes an MbedTLS header. The kernels live
+ * in OsStub/MbedTlsLib/Accel and pick an instruction set at runtime, so a
+ * binary built with MBEDTLS_ACCEL still runs on CPUs without the
+ * extensions. On ARC only the portable ChaCha20 and Poly1305 code and the
+ * bignum kernels below replace the generic MbedTLS code.
+ *
+ * Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+#ifndef MBEDTLS_ACCEL_CONFIG_H
+#define MBEDTLS_ACCEL_CONFIG_H
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MBEDTLS_ACCEL_X86
+#elif defined(__aarch64__) && !defined(__AARCH64EB__)
+#define MBEDTLS_ACCEL_AARCH64
+#elif defined(__arm__) && defined(__ARMEL__)
+#define MBEDTLS_ACCEL_ARM
+#elif defined(__riscv)
+#define MBEDTLS_ACCEL_RISCV
+#endif
+
+/*
+ * x86:     AES-NI, PCLMULQDQ and the SHA extensions (SHA-256 only).
+ * AArch64: the ARMv8 AES, PMULL and SHA2 extensions, and SHA512 (ARMv8.2).
+ *
+ * MbedTLS keeps its own AES-NI path for x86-64 GCC builds (MBEDTLS_AESNI_C),
+ * which runs before MBEDTLS_AES_ENCRYPT_ALT is reached.
+ *
+ * MBEDTLS_ACCEL_SHA256_MULTI provides mbedtls_accel_sha256_multi() from
+ * mbedtls/sha256_multi.h, which BaseCryptLib uses for Sha256HashAllMulti().
+ */
+#if defined(MBEDTLS_ACCEL_X86) || defined(MBEDTLS_ACCEL_AARCH64)
+#define MBEDTLS_AES_ENCRYPT_ALT
+#define MBEDTLS_AES_DECRYPT_ALT
+#define MBEDTLS_GCM_ALT
+#define MBEDTLS_SHA256_PROCESS_ALT
+#define MBEDTLS_ACCEL_SHA256_MULTI
+#endif
+
+#if defined(MBEDTLS_ACCEL_AARCH64)
+#define MBEDTLS_SHA512_PROCESS_ALT
+#endif
+
+/*
+ * ChaCha20 runs several blocks at once in SIMD registers: SSE2 and AVX2 on
+ * x86, NEON on AArch64 and on ARM when the compiler targets NEON, and the
+ * vector extension on RISC-V when the compiler targets it. Poly1305 uses
+ * 44-bit limbs where the compiler has a 128-bit integer type, and 26-bit
+ * limbs elsewhere. Both have a portable path, so they are replaced on every
+ * architecture; this is the AEAD cipher suite for CPUs without AES
+ * instructions.
+ */
+#define MBEDTLS_CHACHA20_ALT
+#define MBEDTLS_POLY1305_ALT
+
+/*
+ * MBEDTLS_ACCEL_KECCAK_MULTI provides mbedtls/keccak_multi.h, which absorbs
+ * into four Keccak states at once with AVX2 and two with NEON. BaseCryptLib
+ * uses it for Sha3_256HashAllMulti() and the other SHA3 batch hashes; the
+ * single-buffer SHA3 code is BaseCryptLib's own.
+ */
+#if defined(MBEDTLS_ACCEL_X86) || defined(MBEDTLS_ACCEL_AARCH64) || \
+    defined(MBEDTLS_ACCEL_ARM)
+#define MBEDTLS_ACCEL_KECCAK_MULTI
+#endif
+
+/*
+ * MbedTLS has no bignum assembly for RISC-V and ARC. bn_mul_accel.h
+ * provides the multiply-accumulate step of the bignum multiplication and of
+ * the Montgomery multiplication for them (RV32/RV64 with the M extension,
+ * ARC with a multiplier), which RSA, FFDHE and ECDSA/ECDHE spend most of
+ * their time in.
+ */
+#if defined(MBEDTLS_ACCEL_RISCV) || defined(__arc__)
+#include "bn_mul_accel.h"
+#endif
+
+#endif /* MBEDTLS_ACCEL_CONFIG_H */
@@ -0,0 +1,126 @@
+/**
+ * \file bn_mul_accel.h
+ *
+ * \brief Multiply-accumulate kernels for the MbedTLS bignum code on RISC-V
+ *        and ARC.
+ *
+ * bn_mul.h only provides assembly for the architectures it knows, and uses
+ * its portable C for any other one unless MULADDC_CORE is already defined.
+ * accel_config.h includes this file, so these macros are defined before
+ * bignum.c includes bn_mul.h, and mpi_mul_hlp() - the inner loop of
+ * mbedtls_mpi_mul_mpi() and of the Montgomery multiplication behind
+ * mbedtls_mpi_exp_mod() (RSA, FFDHE) - and the ECP field arithmetic run
+ * them instead.
+ *
+ * The macros follow bn_mul.h: MULADDC_INIT opens one asm statement,
+ * every MULADDC_CORE computes d[0] += s[0] * b + c for one limb, leaving
+ * the carry in c and advancing s and d, and MULADDC_STOP closes the
+ * statement. MbedTLS 2.16 uses 32-bit limbs on RV32, RV64 and ARC; the
+ * kernels check that at compile time.
+ *
+ * Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+#ifndef MBEDTLS_BN_MUL_ACCEL_H
+#define MBEDTLS_BN_MUL_ACCEL_H
+
+#define MBEDTLS_BN_MUL_ACCEL_LIMB_CHECK                                 \
+    (void) sizeof( char[ ( sizeof( mbedtls_mpi_uint ) == 4 ) ? 1 : -1 ] );
+
+#if defined(__riscv) && defined(__riscv_mul) && ( __riscv_xlen == 32 )
+
+/*
+ * RV32IM: mul and mulhu give the two halves of the product; the carries of
+ * the two additions come from sltu.
+ */
+#define MULADDC_INIT                                \
+    { MBEDTLS_BN_MUL_ACCEL_LIMB_CHECK               \
+    asm volatile (
+
+#define MULADDC_CORE                                \
+        "lw     t0, 0(%[s])         \n\t"           \
+        "lw     t1, 0(%[d])         \n\t"           \
+        "mul    t2, t0, %[b]        \n\t"           \
+        "mulhu  t3, t0, %[b]        \n\t"           \
+        "add    t2, t2, %[c]        \n\t"           \
+        "sltu   t4, t2, %[c]        \n\t"           \
+        "add    t3, t3, t4          \n\t"           \
+        "add    t2, t2, t1          \n\t"           \
+        "sltu   t4, t2, t1          \n\t"           \
+        "add    %[c], t3, t4        \n\t"           \
+        "sw     t2, 0(%[d])         \n\t"           \
+        "addi   %[s], %[s], 4       \n\t"           \
+        "addi   %[d], %[d], 4       \n\t"
+
+#define MULADDC_STOP                                \
+        : [c] "+r" (c), [s] "+r" (s), [d] "+r" (d)  \
+        : [b] "r" (b)                               \
+        : "t0", "t1", "t2", "t3", "t4", "memory"    \
+    ); }
+
+#elif defined(__riscv) && defined(__riscv_mul) && ( __riscv_xlen == 64 )
+
+/*
+ * RV64IM with 32-bit limbs: s[0] * b + d[0] + c is at most 2^64 - 1, so one
+ * 64-bit multiply and two adds compute the whole limb with no carry
+ * handling. b and the carry are zero-extended once in t5 and t6, since the
+ * ABI keeps 32-bit values sign-extended in registers.
+ */
+#define MULADDC_INIT                                \
+    { MBEDTLS_BN_MUL_ACCEL_LIMB_CHECK               \
+    asm volatile (                                  \
+        "slli   t5, %[b], 32        \n\t"           \
+        "srli   t5, t5, 32          \n\t"           \
+        "slli   t6, %[c], 32        \n\t"           \
+        "srli   t6, t6, 32          \n\t"
+
+#define MULADDC_CORE                                \
+        "lwu    t0, 0(%[s])         \n\t"           \
+        "lwu    t1, 0(%[d])         \n\t"           \
+        "mul    t0, t0, t5          \n\t"           \
+        "add    t0, t0, t1          \n\t"           \
+        "add    t0, t0, t6          \n\t"           \
+        "sw     t0, 0(%[d])         \n\t"           \
+        "srli   t6, t0, 32          \n\t"           \
+        "addi   %[s], %[s], 4       \n\t"           \
+        "addi   %[d], %[d], 4       \n\t"
+
+#define MULADDC_STOP                                \
+        "sext.w %[c], t6            \n\t"           \
+        : [c] "+r" (c), [s] "+r" (s), [d] "+r" (d)  \
+        : [b] "r" (b)                               \
+        : "t0", "t1", "t5", "t6", "memory"          \
+    ); }
+
+#elif defined(__arc__) && defined(__ARC_MPY__) && !defined(__BIG_ENDIAN__)
+
+/*
+ * ARC with a 32x32 multiplier (ARC HS, or ARC700 built with -mmpy): mpy
+ * and mpymu give the two halves of the product, and add.f/adc chain the
+ * carries. The loads and the store post-increment s and d.
+ */
+#define MULADDC_INIT                                \
+    { MBEDTLS_BN_MUL_ACCEL_LIMB_CHECK               \
+    asm volatile (
+
+#define MULADDC_CORE                                \
+        "ld.ab  r8, [%[s], 4]       \n\t"           \
+        "ld     r9, [%[d]]          \n\t"           \
+        "mpy    r10, r8, %[b]       \n\t"           \
+        "mpymu  r11, r8, %[b]       \n\t"           \
+        "add.f  r10, r10, %[c]      \n\t"           \
+        "adc    r11, r11, 0         \n\t"           \
+        "add.f  r10, r10, r9        \n\t"           \
+        "adc    %[c], r11, 0        \n\t"           \
+        "st.ab  r10, [%[d], 4]      \n\t"
+
+#define MULADDC_STOP                                \
+        : [c] "+r" (c), [s] "+r" (s), [d] "+r" (d)  \
+        : [b] "r" (b)                               \
+        : "r8", "r9", "r10", "r11", "cc", "memory"  \
+    ); }
+
+#endif
+
+#endif /* MBEDTLS_BN_MUL_ACCEL_H */
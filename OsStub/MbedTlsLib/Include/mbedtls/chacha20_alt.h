@@ -0,0 +1,34 @@
+/**
+ * \file chacha20_alt.h
+ *
+ * \brief ChaCha20 context for the MBEDTLS_ACCEL ChaCha20 kernels.
+ *
+ * Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+#ifndef MBEDTLS_CHACHA20_ALT_H
+#define MBEDTLS_CHACHA20_ALT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          The ChaCha20 context structure.
+ *
+ *                 Same layout as the generic MbedTLS context.
+ */
+typedef struct mbedtls_chacha20_context
+{
+    uint32_t state[16];          /*!< The state (before round operations). */
+    uint8_t  keystream8[64];     /*!< Leftover keystream bytes. */
+    size_t keystream_bytes_used; /*!< Number of keystream bytes already used. */
+}
+mbedtls_chacha20_context;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_CHACHA20_ALT_H */
@@ -0,0 +1,57 @@
+/**
+ * \file keccak_multi.h
+ *
+ * \brief Multi-lane Keccak-f[1600] absorption for the MBEDTLS_ACCEL build.
+ *
+ * Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+#ifndef MBEDTLS_KECCAK_MULTI_H
+#define MBEDTLS_KECCAK_MULTI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          Return the number of Keccak states the running CPU can
+ *                 permute at once.
+ *
+ * \return         4 with AVX2, 2 with NEON, or 0 when there is no
+ *                 multi-lane kernel; the caller then absorbs one state at
+ *                 a time.
+ */
+size_t mbedtls_accel_keccak_lanes( void );
+
+/**
+ * \brief          Absorb whole blocks into several independent
+ *                 Keccak-f[1600] states.
+ *
+ *                 For each state, every block is XORed into the first
+ *                 \p rate bytes and the state is permuted, with the states
+ *                 permuted side by side in SIMD registers. The result is
+ *                 the same as absorbing the blocks one state at a time.
+ *
+ * \param count    The number of states, from 1 to
+ *                 mbedtls_accel_keccak_lanes().
+ * \param state    The \p count states, 25 lanes each, lane x + 5 * y
+ *                 holding A[x][y] as a native integer.
+ * \param input    The \p count inputs, \p blocks * \p rate bytes each.
+ * \param rate     The rate in bytes, a multiple of 8 below 200.
+ * \param blocks   The number of blocks absorbed into each state.
+ */
+void mbedtls_accel_keccak_absorb_multi( size_t count,
+                                        uint64_t *const state[],
+                                        const unsigned char *const input[],
+                                        size_t rate,
+                                        size_t blocks );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_KECCAK_MULTI_H */
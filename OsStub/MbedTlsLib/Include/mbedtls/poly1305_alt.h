@@ -0,0 +1,38 @@
+/**
+ * \file poly1305_alt.h
+ *
+ * \brief Poly1305 context for the MBEDTLS_ACCEL Poly1305 code.
+ *
+ * Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+#ifndef MBEDTLS_POLY1305_ALT_H
+#define MBEDTLS_POLY1305_ALT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          The Poly1305 context structure.
+ *
+ *                 The key and the accumulator are held in three 44-bit
+ *                 limbs when the compiler has a 128-bit integer type, and
+ *                 in five 26-bit limbs otherwise.
+ */
+typedef struct mbedtls_poly1305_context
+{
+    uint64_t r[5];            /*!< The value for 'r' (low 128 bits of the key). */
+    uint64_t h[5];            /*!< The accumulator number. */
+    uint32_t s[4];            /*!< The value for 's' (high 128 bits of the key). */
+    uint8_t queue[16];        /*!< The current partial block of data. */
+    size_t queue_len;         /*!< The number of bytes stored in 'queue'. */
+}
+mbedtls_poly1305_context;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_POLY1305_ALT_H */
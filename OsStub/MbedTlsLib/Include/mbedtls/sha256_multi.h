@@ -0,0 +1,44 @@
+/**
+ * \file sha256_multi.h
+ *
+ * \brief Multi-buffer SHA-256 for the MBEDTLS_ACCEL build.
+ *
+ * Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ */
+
+#ifndef MBEDTLS_SHA256_MULTI_H
+#define MBEDTLS_SHA256_MULTI_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          Calculate the SHA-256 checksum of several independent
+ *                 buffers.
+ *
+ *                 Buffers are hashed two at a time with interleaved rounds
+ *                 when the CPU has the SHA-256 extensions, so the result is
+ *                 the same as calling mbedtls_sha256_ret() on each one.
+ *
+ * \param count    The number of buffers.
+ * \param input    The \p count buffers to hash.
+ * \param ilen     The length in bytes of each input buffer.
+ * \param output   The \p count 32-byte buffers receiving the checksums.
+ *
+ * \return         \c 0 on success.
+ * \return         A negative error code on failure.
+ */
+int mbedtls_accel_sha256_multi( size_t count,
+                                const unsigned char *const input[],
+                                const size_t ilen[],
+                                unsigned char *const output[] );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBEDTLS_SHA256_MULTI_H */
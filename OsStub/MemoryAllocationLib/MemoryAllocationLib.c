@@ -6,19 +6,264 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include <Base.h>
+#include <Library/MemoryAllocationLib.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 
+//
+// The pool arena is a bump allocator over a caller-provided buffer.
+// A freed block is given back when it is the last block, and the whole arena
+// is given back when no block is outstanding.
+//
+#define POOL_ARENA_ALIGNMENT  16
+
+typedef struct {
+  UINTN    Size;
+  UINTN    Reserved;
+} POOL_ARENA_HEAD;
+
+typedef struct {
+  UINT8    *Base;
+  UINTN    Size;
+  UINTN    Top;
+  UINTN    PeakSize;
+  UINTN    Count;
+  BOOLEAN  Strict;
+} POOL_ARENA;
+
+POOL_ARENA  mPoolArena;
+
+UINTN       mPoolAllocationCount;
+
+POOL_STATISTICS  mPoolStatistics;
+
+/**
+  Sets a caller-provided arena for the pool allocations.
+
+  The pool allocations are served from the arena while it is set.
+  The arena can only be changed when no block allocated from it is outstanding.
+
+  @param  Arena                 The arena buffer, or NULL to allocate from the heap.
+  @param  ArenaSize             The size in bytes of the arena buffer.
+  @param  Strict                If TRUE, an allocation fails when the arena cannot serve it,
+                                instead of falling back to the heap.
+
+  @retval TRUE  the arena is set.
+  @retval FALSE a block allocated from the current arena is outstanding.
+**/
+BOOLEAN
+EFIAPI
+SetPoolArena (
+  IN VOID     *Arena OPTIONAL,
+  IN UINTN    ArenaSize,
+  IN BOOLEAN  Strict
+  )
+{
+  if (mPoolArena.Count != 0) {
+    return FALSE;
+  }
+
+  mPoolArena.Base = Arena;
+  mPoolArena.Size = (Arena == NULL) ? 0 : ArenaSize;
+  mPoolArena.Top = 0;
+  mPoolArena.PeakSize = 0;
+  mPoolArena.Count = 0;
+  mPoolArena.Strict = Strict;
+  return TRUE;
+}
+
+/**
+  Returns the peak size in bytes used in the arena since it was set.
+
+  @return The peak size in bytes used in the arena.
+**/
+UINTN
+EFIAPI
+GetPoolArenaPeakSize (
+  VOID
+  )
+{
+  return mPoolArena.PeakSize;
+}
+
+/**
+  Sets a caller-provided allocator for the pool allocations of the current thread.
+
+  The pools are allocated from the heap without a block head to route a free, so that only NULL is accepted.
+
+  @param  Allocator             The allocator, or NULL to allocate from the heap.
+
+  @retval TRUE  the allocator is NULL.
+  @retval FALSE the allocators are not supported.
+**/
+BOOLEAN
+EFIAPI
+SetPoolAllocator (
+  IN CONST POOL_ALLOCATOR  *Allocator OPTIONAL
+  )
+{
+  return (BOOLEAN)(Allocator == NULL);
+}
+
+/**
+  Returns the number of pool allocations since the program started.
+
+  It counts every AllocatePool and AllocateZeroPool call, whether it is served from the arena or the heap.
+
+  @return The number of pool allocations.
+**/
+UINTN
+EFIAPI
+GetPoolAllocationCount (
+  VOID
+  )
+{
+  return mPoolAllocationCount;
+}
+
+/**
+  Returns the statistics of the pool allocations since the program started.
+
+  The allocations served from the arena of SetPoolArena are not counted.
+  The heap does not report the size of a block, so only the counts are reported.
+
+  @param  Statistics            The statistics of the pool allocations.
+**/
+VOID
+EFIAPI
+GetPoolStatistics (
+  OUT POOL_STATISTICS  *Statistics
+  )
+{
+  *Statistics = mPoolStatistics;
+}
+
+/**
+  Sets the tag of the pool allocations of the current thread.
+
+  The allocations are not audited, so that the tag is ignored.
+
+  @param  RequestCode           The SPDM request code, or 0 if none.
+  @param  Phase                 The phase, one of POOL_ALLOCATION_PHASE_*.
+**/
+VOID
+EFIAPI
+SetPoolAllocationTag (
+  IN UINT8  RequestCode,
+  IN UINT8  Phase
+  )
+{
+}
+
+/**
+  Returns the pool allocations attributed to one SPDM request code in one phase.
+
+  @param  RequestCode           The SPDM request code, or 0 for the allocations without a request code.
+  @param  Phase                 The phase, one of POOL_ALLOCATION_PHASE_*.
+  @param  Record                The pool allocations of the request code in the phase.
+
+  @retval FALSE the allocations are not audited.
+**/
+BOOLEAN
+EFIAPI
+GetPoolAuditRecord (
+  IN  UINT8              RequestCode,
+  IN  UINT8              Phase,
+  OUT POOL_AUDIT_RECORD  *Record
+  )
+{
+  return FALSE;
+}
+
+/**
+  Clears the counts of the pool allocations of all request codes and phases.
+**/
+VOID
+EFIAPI
+ResetPoolAudit (
+  VOID
+  )
+{
+}
+
+/**
+  Allocates a buffer from the arena.
+
+  @param  AllocationSize        The number of bytes to allocate.
+
+  @return A pointer to the allocated buffer or NULL if the arena is exhausted.
+**/
+VOID *
+InternalAllocateArenaPool (
+  IN UINTN  AllocationSize
+  )
+{
+  POOL_ARENA_HEAD  *PoolHdr;
+  UINTN            BlockSize;
+
+  if (AllocationSize > mPoolArena.Size) {
+    return NULL;
+  }
+  BlockSize = sizeof(POOL_ARENA_HEAD) + ALIGN_VALUE (AllocationSize, POOL_ARENA_ALIGNMENT);
+  if (BlockSize > mPoolArena.Size - mPoolArena.Top) {
+    return NULL;
+  }
+
+  PoolHdr = (POOL_ARENA_HEAD *)(mPoolArena.Base + mPoolArena.Top);
+  PoolHdr->Size = BlockSize;
+  mPoolArena.Top += BlockSize;
+  mPoolArena.Count++;
+  if (mPoolArena.Top > mPoolArena.PeakSize) {
+    mPoolArena.PeakSize = mPoolArena.Top;
+  }
+  return PoolHdr + 1;
+}
+
+/**
+  Returns if a buffer is allocated from the arena.
+
+  @param  Buffer                Pointer to the buffer.
+
+  @retval TRUE  the buffer is allocated from the arena.
+  @retval FALSE the buffer is not allocated from the arena.
+**/
+BOOLEAN
+InternalIsArenaPool (
+  IN VOID   *Buffer
+  )
+{
+  return ((UINT8 *)Buffer >= mPoolArena.Base) &&
+         ((UINT8 *)Buffer < mPoolArena.Base + mPoolArena.Size);
+}
+
 VOID *
 EFIAPI
 AllocatePool (
   IN UINTN  AllocationSize
   )
 {
-  return malloc (AllocationSize);
+  VOID *Buffer;
+
+  mPoolAllocationCount++;
+  if (mPoolArena.Size != 0) {
+    Buffer = InternalAllocateArenaPool (AllocationSize);
+    if (Buffer != NULL) {
+      return Buffer;
+    }
+  }
+  if (mPoolArena.Strict) {
+    return NULL;
+  }
+  Buffer = malloc (AllocationSize);
+  if (Buffer == NULL) {
+    mPoolStatistics.FailureCount++;
+  } else {
+    mPoolStatistics.AllocationCount++;
+  }
+  return Buffer;
 }
 
 VOID *
@@ -28,7 +273,7 @@ AllocateZeroPool (
   )
 {
   VOID *Buffer;
-  Buffer = malloc (AllocationSize);
+  Buffer = AllocatePool (AllocationSize);
   if (Buffer == NULL) {
     return NULL;
   }
@@ -42,5 +287,22 @@ FreePool (
   IN VOID   *Buffer
   )
 {
-  free (Buffer);
+  POOL_ARENA_HEAD  *PoolHdr;
+
+  if (!InternalIsArenaPool (Buffer)) {
+    if (Buffer != NULL) {
+      mPoolStatistics.FreeCount++;
+    }
+    free (Buffer);
+    return ;
+  }
+
+  PoolHdr = (POOL_ARENA_HEAD *)Buffer - 1;
+  assert (mPoolArena.Count != 0);
+  mPoolArena.Count--;
+  if (mPoolArena.Count == 0) {
+    mPoolArena.Top = 0;
+  } else if ((UINT8 *)PoolHdr + PoolHdr->Size == mPoolArena.Base + mPoolArena.Top) {
+    mPoolArena.Top -= PoolHdr->Size;
+  }
 }
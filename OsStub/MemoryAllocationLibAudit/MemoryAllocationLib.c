@@ -0,0 +1,398 @@
+/** @file
+  The MemoryAllocationLib of the allocation audit.
+
+  It allocates every pool from the heap, or from the arena of SetPoolArena, as OsStub/MemoryAllocationLib does.
+  Each block has a head with its size and the tag of the thread which allocated it, as set by
+  SetPoolAllocationTag, so that the allocations, the bytes and the live blocks are reported per
+  SPDM request code and phase by GetPoolAuditRecord.
+  The records are updated without a lock, as the counters of OsStub/MemoryAllocationLib, so that
+  a program with several threads allocating at once only gets approximate counts.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/MemoryAllocationLib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+//
+// The pool arena is a bump allocator over a caller-provided buffer.
+// A freed block is given back when it is the last block, and the whole arena
+// is given back when no block is outstanding.
+//
+#define POOL_ARENA_ALIGNMENT  16
+
+typedef struct {
+  UINTN    Size;
+  UINTN    Reserved;
+} POOL_ARENA_HEAD;
+
+typedef struct {
+  UINT8    *Base;
+  UINTN    Size;
+  UINTN    Top;
+  UINTN    PeakSize;
+  UINTN    Count;
+  BOOLEAN  Strict;
+} POOL_ARENA;
+
+POOL_ARENA  mPoolArena;
+
+//
+// The head of a block, after the head of the arena if it is allocated from the arena.
+// Its size keeps the alignment of the heap.
+//
+#define POOL_AUDIT_SIGNATURE  SIGNATURE_32 ('p', 'a', 'u', 'd')
+
+typedef struct {
+  UINT32   Signature;
+  UINT8    RequestCode;
+  UINT8    Phase;
+  UINT16   Reserved;
+  UINT64   Size;
+} POOL_AUDIT_HEAD;
+
+#if defined(_MSC_VER)
+#define POOL_THREAD_LOCAL  __declspec(thread)
+#else
+#define POOL_THREAD_LOCAL  __thread
+#endif
+
+//
+// The tag of the current thread: the request code, and the phase.
+//
+POOL_THREAD_LOCAL UINT8  mPoolAllocationRequestCode;
+POOL_THREAD_LOCAL UINT8  mPoolAllocationPhase;
+
+POOL_AUDIT_RECORD  mPoolAudit[POOL_ALLOCATION_PHASE_COUNT][256];
+
+UINTN       mPoolAllocationCount;
+
+POOL_STATISTICS  mPoolStatistics;
+
+/**
+  Sets a caller-provided arena for the pool allocations.
+
+  The pool allocations are served from the arena while it is set.
+  The arena can only be changed when no block allocated from it is outstanding.
+
+  @param  Arena                 The arena buffer, or NULL to allocate from the heap.
+  @param  ArenaSize             The size in bytes of the arena buffer.
+  @param  Strict                If TRUE, an allocation fails when the arena cannot serve it,
+                                instead of falling back to the heap.
+
+  @retval TRUE  the arena is set.
+  @retval FALSE a block allocated from the current arena is outstanding.
+**/
+BOOLEAN
+EFIAPI
+SetPoolArena (
+  IN VOID     *Arena OPTIONAL,
+  IN UINTN    ArenaSize,
+  IN BOOLEAN  Strict
+  )
+{
+  if (mPoolArena.Count != 0) {
+    return FALSE;
+  }
+
+  mPoolArena.Base = Arena;
+  mPoolArena.Size = (Arena == NULL) ? 0 : ArenaSize;
+  mPoolArena.Top = 0;
+  mPoolArena.PeakSize = 0;
+  mPoolArena.Count = 0;
+  mPoolArena.Strict = Strict;
+  return TRUE;
+}
+
+/**
+  Returns the peak size in bytes used in the arena since it was set.
+
+  @return The peak size in bytes used in the arena.
+**/
+UINTN
+EFIAPI
+GetPoolArenaPeakSize (
+  VOID
+  )
+{
+  return mPoolArena.PeakSize;
+}
+
+/**
+  Sets a caller-provided allocator for the pool allocations of the current thread.
+
+  The allocation audit only allocates from the heap, so that only NULL is accepted.
+
+  @param  Allocator             The allocator, or NULL to allocate from the heap.
+
+  @retval TRUE  the allocator is NULL.
+  @retval FALSE the allocators are not supported.
+**/
+BOOLEAN
+EFIAPI
+SetPoolAllocator (
+  IN CONST POOL_ALLOCATOR  *Allocator OPTIONAL
+  )
+{
+  return (BOOLEAN)(Allocator == NULL);
+}
+
+/**
+  Returns the number of pool allocations since the program started.
+
+  It counts every AllocatePool and AllocateZeroPool call, whether it is served from the arena or the heap.
+
+  @return The number of pool allocations.
+**/
+UINTN
+EFIAPI
+GetPoolAllocationCount (
+  VOID
+  )
+{
+  return mPoolAllocationCount;
+}
+
+/**
+  Returns the statistics of the pool allocations since the program started.
+
+  The allocations served from the arena of SetPoolArena are not counted.
+  The heap does not report the size of a block, so only the counts are reported.
+
+  @param  Statistics            The statistics of the pool allocations.
+**/
+VOID
+EFIAPI
+GetPoolStatistics (
+  OUT POOL_STATISTICS  *Statistics
+  )
+{
+  *Statistics = mPoolStatistics;
+}
+
+/**
+  Sets the tag of the pool allocations of the current thread.
+
+  @param  RequestCode           The SPDM request code, or 0 if none.
+  @param  Phase                 The phase, one of POOL_ALLOCATION_PHASE_*.
+**/
+VOID
+EFIAPI
+SetPoolAllocationTag (
+  IN UINT8  RequestCode,
+  IN UINT8  Phase
+  )
+{
+  if (Phase >= POOL_ALLOCATION_PHASE_COUNT) {
+    RequestCode = 0;
+    Phase = POOL_ALLOCATION_PHASE_NONE;
+  }
+  mPoolAllocationRequestCode = RequestCode;
+  mPoolAllocationPhase = Phase;
+}
+
+/**
+  Returns the pool allocations attributed to one SPDM request code in one phase since the program started,
+  or since ResetPoolAudit.
+
+  @param  RequestCode           The SPDM request code, or 0 for the allocations without a request code.
+  @param  Phase                 The phase, one of POOL_ALLOCATION_PHASE_*.
+  @param  Record                The pool allocations of the request code in the phase.
+
+  @retval TRUE  the record is returned.
+  @retval FALSE the Phase is invalid.
+**/
+BOOLEAN
+EFIAPI
+GetPoolAuditRecord (
+  IN  UINT8              RequestCode,
+  IN  UINT8              Phase,
+  OUT POOL_AUDIT_RECORD  *Record
+  )
+{
+  if (Phase >= POOL_ALLOCATION_PHASE_COUNT) {
+    return FALSE;
+  }
+  *Record = mPoolAudit[Phase][RequestCode];
+  return TRUE;
+}
+
+/**
+  Clears the counts of the pool allocations of all request codes and phases.
+
+  The live blocks are kept, so that a block allocated before and freed after is still accounted.
+**/
+VOID
+EFIAPI
+ResetPoolAudit (
+  VOID
+  )
+{
+  POOL_AUDIT_RECORD  *Record;
+  UINTN              Index;
+
+  Record = &mPoolAudit[0][0];
+  for (Index = 0; Index < POOL_ALLOCATION_PHASE_COUNT * 256; Index++) {
+    Record[Index].AllocationCount = 0;
+    Record[Index].AllocationSize = 0;
+    Record[Index].FreeCount = 0;
+    Record[Index].PeakLiveSize = Record[Index].LiveSize;
+  }
+}
+
+/**
+  Allocates a buffer from the arena.
+
+  @param  AllocationSize        The number of bytes to allocate.
+
+  @return A pointer to the allocated buffer or NULL if the arena is exhausted.
+**/
+VOID *
+InternalAllocateArenaPool (
+  IN UINTN  AllocationSize
+  )
+{
+  POOL_ARENA_HEAD  *PoolHdr;
+  UINTN            BlockSize;
+
+  if (AllocationSize > mPoolArena.Size) {
+    return NULL;
+  }
+  BlockSize = sizeof(POOL_ARENA_HEAD) + ALIGN_VALUE (AllocationSize, POOL_ARENA_ALIGNMENT);
+  if (BlockSize > mPoolArena.Size - mPoolArena.Top) {
+    return NULL;
+  }
+
+  PoolHdr = (POOL_ARENA_HEAD *)(mPoolArena.Base + mPoolArena.Top);
+  PoolHdr->Size = BlockSize;
+  mPoolArena.Top += BlockSize;
+  mPoolArena.Count++;
+  if (mPoolArena.Top > mPoolArena.PeakSize) {
+    mPoolArena.PeakSize = mPoolArena.Top;
+  }
+  return PoolHdr + 1;
+}
+
+/**
+  Returns if a buffer is allocated from the arena.
+
+  @param  Buffer                Pointer to the buffer.
+
+  @retval TRUE  the buffer is allocated from the arena.
+  @retval FALSE the buffer is not allocated from the arena.
+**/
+BOOLEAN
+InternalIsArenaPool (
+  IN VOID   *Buffer
+  )
+{
+  return ((UINT8 *)Buffer >= mPoolArena.Base) &&
+         ((UINT8 *)Buffer < mPoolArena.Base + mPoolArena.Size);
+}
+
+VOID *
+EFIAPI
+AllocatePool (
+  IN UINTN  AllocationSize
+  )
+{
+  POOL_AUDIT_HEAD    *AuditHdr;
+  POOL_AUDIT_RECORD  *Record;
+
+  mPoolAllocationCount++;
+  if (AllocationSize > MAX_UINTN - sizeof(POOL_AUDIT_HEAD)) {
+    mPoolStatistics.FailureCount++;
+    return NULL;
+  }
+  AuditHdr = NULL;
+  if (mPoolArena.Size != 0) {
+    AuditHdr = InternalAllocateArenaPool (sizeof(POOL_AUDIT_HEAD) + AllocationSize);
+  }
+  if (AuditHdr == NULL) {
+    if (mPoolArena.Strict) {
+      return NULL;
+    }
+    AuditHdr = malloc (sizeof(POOL_AUDIT_HEAD) + AllocationSize);
+    if (AuditHdr == NULL) {
+      mPoolStatistics.FailureCount++;
+      return NULL;
+    }
+    mPoolStatistics.AllocationCount++;
+  }
+
+  AuditHdr->Signature = POOL_AUDIT_SIGNATURE;
+  AuditHdr->RequestCode = mPoolAllocationRequestCode;
+  AuditHdr->Phase = mPoolAllocationPhase;
+  AuditHdr->Reserved = 0;
+  AuditHdr->Size = AllocationSize;
+
+  Record = &mPoolAudit[AuditHdr->Phase][AuditHdr->RequestCode];
+  Record->AllocationCount++;
+  Record->AllocationSize += AllocationSize;
+  Record->LiveCount++;
+  Record->LiveSize += AllocationSize;
+  if (Record->LiveSize > Record->PeakLiveSize) {
+    Record->PeakLiveSize = Record->LiveSize;
+  }
+  return AuditHdr + 1;
+}
+
+VOID *
+EFIAPI
+AllocateZeroPool (
+  IN UINTN  AllocationSize
+  )
+{
+  VOID *Buffer;
+  Buffer = AllocatePool (AllocationSize);
+  if (Buffer == NULL) {
+    return NULL;
+  }
+  memset (Buffer, 0, AllocationSize);
+  return Buffer;
+}
+
+VOID
+EFIAPI
+FreePool (
+  IN VOID   *Buffer
+  )
+{
+  POOL_AUDIT_HEAD    *AuditHdr;
+  POOL_AUDIT_RECORD  *Record;
+  POOL_ARENA_HEAD    *PoolHdr;
+
+  if (Buffer == NULL) {
+    return ;
+  }
+  AuditHdr = (POOL_AUDIT_HEAD *)Buffer - 1;
+  assert (AuditHdr->Signature == POOL_AUDIT_SIGNATURE);
+  AuditHdr->Signature = 0;
+
+  Record = &mPoolAudit[AuditHdr->Phase][AuditHdr->RequestCode];
+  Record->FreeCount++;
+  Record->LiveCount--;
+  Record->LiveSize -= (UINTN)AuditHdr->Size;
+
+  if (!InternalIsArenaPool (AuditHdr)) {
+    mPoolStatistics.FreeCount++;
+    free (AuditHdr);
+    return ;
+  }
+
+  PoolHdr = (POOL_ARENA_HEAD *)AuditHdr - 1;
+  assert (mPoolArena.Count != 0);
+  mPoolArena.Count--;
+  if (mPoolArena.Count == 0) {
+    mPoolArena.Top = 0;
+  } else if ((UINT8 *)PoolHdr + PoolHdr->Size == mPoolArena.Base + mPoolArena.Top) {
+    mPoolArena.Top -= PoolHdr->Size;
+  }
+}
@@ -0,0 +1,1063 @@
+/** @file
+  Size-class pool implementation of the Memory Allocation Library.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/MemoryAllocationLib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+//
+// The pool blocks are served from size classes of 16, 32, 64 ... bytes, each with a free list,
+// so that the small blocks which the crypto backends allocate and free at a high rate during a
+// handshake are recycled from a free list in constant time instead of going to malloc.
+// A block has a POOL_BLOCK_HEAD recording its size class.
+//
+// On the hosted builds, the blocks are carved from POOL_CHUNK_SIZE chunks allocated from the heap,
+// and a block larger than the largest size class is allocated from the heap. With GCC and CLANG,
+// each thread has a cache of free blocks for each size class, so that the lock of the shared free
+// lists is taken once for a batch of blocks. The cache is given back to the shared free lists when
+// the thread exits. With MSVC, the shared free lists are used under a spin lock.
+//
+// On the firmware builds, MEMORY_ALLOCATION_POOL_ARENA_SIZE is defined to the size in bytes of a
+// static arena, then the blocks are carved from the arena and nothing is allocated from the heap.
+// The size classes go up to POOL_ARENA_MAX_CLASS_SIZE, and a larger allocation fails.
+//
+// The carved blocks are never given back to the heap or the arena: a freed block is kept in the
+// free list of its size class. GetPoolStatistics reports the high-water and the fragmentation
+// counters, such as the peak ReservedSize which a firmware build needs as its arena size.
+//
+// While a thread has an allocator set by SetPoolAllocator, its blocks are allocated by the allocator
+// instead, with a POOL_PLACED_HEAD holding the allocator before their POOL_BLOCK_HEAD, so that
+// FreePool gives them back to it from any thread. They are not kept in the free lists.
+//
+#if defined(MEMORY_ALLOCATION_POOL_ARENA_SIZE)
+#define POOL_STATIC_ARENA
+#elif !defined(_MSC_VER) && !defined(CBMC) && !defined(CBMC_CC) && !defined(TEST_WITH_KLEE)
+#define POOL_THREAD_CACHE
+#include <pthread.h>
+#endif
+
+#define POOL_SIGNATURE  SIGNATURE_32 ('p', 'o', 'o', 'l')
+
+#define POOL_MIN_CLASS_SHIFT  4
+#if defined(POOL_STATIC_ARENA)
+#define POOL_CLASS_COUNT      13
+#else
+#define POOL_CLASS_COUNT      9
+#endif
+#define POOL_ARENA_MAX_CLASS_SIZE  SIZE_64KB
+#define POOL_CLASS_LARGE      POOL_CLASS_COUNT
+#define POOL_CLASS_PLACED     (POOL_CLASS_COUNT + 1)
+
+#define POOL_CLASS_SIZE(Class)   (((UINTN)1) << ((Class) + POOL_MIN_CLASS_SHIFT))
+#define POOL_BLOCK_SIZE(Class)   (sizeof(POOL_BLOCK_HEAD) + POOL_CLASS_SIZE (Class))
+
+#define POOL_CHUNK_SIZE  SIZE_64KB
+
+//
+// The blocks cached by a thread for a size class. Half of them are moved at once between
+// the cache and the shared free list.
+//
+#define POOL_CACHE_SIZE  SIZE_8KB
+#define POOL_CACHE_LIMIT(Class)  ((POOL_CACHE_SIZE / POOL_BLOCK_SIZE (Class) > 2) ? \
+                                  (POOL_CACHE_SIZE / POOL_BLOCK_SIZE (Class)) : 2)
+
+typedef struct {
+  UINT32   Signature;
+  UINT32   Class;
+  UINT64   Size;
+} POOL_BLOCK_HEAD;
+
+//
+// The size keeps the block head aligned on 16 bytes, on the 32-bit builds too.
+//
+typedef union {
+  POOL_ALLOCATOR  Allocator;
+  UINT64          Reserved[4];
+} POOL_PLACED_HEAD;
+
+#define POOL_PLACED_OVERHEAD  (sizeof(POOL_PLACED_HEAD) + sizeof(POOL_BLOCK_HEAD))
+
+typedef struct _POOL_FREE_BLOCK {
+  POOL_BLOCK_HEAD          Head;
+  struct _POOL_FREE_BLOCK  *Next;
+} POOL_FREE_BLOCK;
+
+typedef struct {
+  POOL_FREE_BLOCK  *Free[POOL_CLASS_COUNT];
+  UINTN            Count[POOL_CLASS_COUNT];
+} POOL_FREE_LISTS;
+
+//
+// The pool arena is a bump allocator over a caller-provided buffer.
+// A freed block is given back when it is the last block, and the whole arena
+// is given back when no block is outstanding.
+//
+#define POOL_ARENA_ALIGNMENT  16
+
+typedef struct {
+  UINTN    Size;
+  UINTN    Reserved;
+} POOL_ARENA_HEAD;
+
+typedef struct {
+  UINT8    *Base;
+  UINTN    Size;
+  UINTN    Top;
+  UINTN    PeakSize;
+  UINTN    Count;
+  BOOLEAN  Strict;
+} POOL_ARENA;
+
+POOL_ARENA       mPoolArena;
+
+POOL_FREE_LISTS  mPoolFreeLists;
+UINT8            *mPoolChunkTop;
+UINT8            *mPoolChunkEnd;
+VOID             *mPoolChunkList;
+
+POOL_STATISTICS  mPoolStatistics;
+UINTN            mPoolArenaAllocationCount;
+UINTN            mPoolPlacedAllocationCount;
+
+#if defined(POOL_STATIC_ARENA)
+
+UINT64  mPoolStaticArena[MEMORY_ALLOCATION_POOL_ARENA_SIZE / sizeof(UINT64)];
+
+#define POOL_LOCK()
+#define POOL_UNLOCK()
+
+#elif defined(POOL_THREAD_CACHE)
+
+pthread_mutex_t  mPoolLock = PTHREAD_MUTEX_INITIALIZER;
+
+#define POOL_LOCK()    pthread_mutex_lock (&mPoolLock)
+#define POOL_UNLOCK()  pthread_mutex_unlock (&mPoolLock)
+
+#define POOL_THREAD_CACHE_UNUSED  0
+#define POOL_THREAD_CACHE_ACTIVE  1
+#define POOL_THREAD_CACHE_EXITED  2
+
+pthread_once_t   mPoolThreadCacheKeyOnce = PTHREAD_ONCE_INIT;
+pthread_key_t    mPoolThreadCacheKey;
+BOOLEAN          mPoolThreadCacheKeyReady;
+
+#define POOL_THREAD_COUNTERS_FOLD  64
+
+typedef struct {
+  UINTN  AllocationCount;
+  UINTN  FreeCount;
+  UINTN  CurrentSize;
+  UINTN  BlockSize;
+  UINTN  Pending;
+} POOL_THREAD_COUNTERS;
+
+CONST UINTN  mPoolCacheLimit[POOL_CLASS_COUNT] = {
+  POOL_CACHE_LIMIT (0), POOL_CACHE_LIMIT (1), POOL_CACHE_LIMIT (2),
+  POOL_CACHE_LIMIT (3), POOL_CACHE_LIMIT (4), POOL_CACHE_LIMIT (5),
+  POOL_CACHE_LIMIT (6), POOL_CACHE_LIMIT (7), POOL_CACHE_LIMIT (8),
+};
+
+__thread POOL_FREE_LISTS       mPoolThreadCache;
+__thread UINTN                 mPoolThreadCacheState;
+__thread POOL_THREAD_COUNTERS  mPoolThreadCounters;
+__thread POOL_ALLOCATOR        mPoolAllocator;
+
+#elif defined(_MSC_VER) && !defined(CBMC) && !defined(CBMC_CC)
+
+long _InterlockedExchange (long volatile *Target, long Value);
+#pragma intrinsic(_InterlockedExchange)
+
+volatile long  mPoolLock;
+
+#define POOL_LOCK()    while (_InterlockedExchange (&mPoolLock, 1) != 0) { }
+#define POOL_UNLOCK()  _InterlockedExchange (&mPoolLock, 0)
+
+#else
+
+#define POOL_LOCK()
+#define POOL_UNLOCK()
+
+#endif
+
+#if !defined(POOL_THREAD_CACHE)
+//
+// Without the thread caches, the allocator is shared by all the threads.
+//
+POOL_ALLOCATOR  mPoolAllocator;
+#endif
+
+//
+// With the thread caches, a thread counts its allocations and frees in its own counters, which are
+// added to the atomic statistics every POOL_THREAD_COUNTERS_FOLD operations and when the thread
+// exits, so that the shared statistics are not written by every allocation. The statistics then lag
+// behind the other threads by a few operations, and the high-water counters are sampled when the
+// counters are added. Otherwise, the statistics are updated under the lock.
+//
+#if defined(POOL_THREAD_CACHE)
+#define POOL_STATISTICS_LOCK()
+#define POOL_STATISTICS_UNLOCK()
+#define POOL_COUNTER_ADD(Counter, Value)  __atomic_add_fetch (&(Counter), (Value), __ATOMIC_RELAXED)
+#define POOL_COUNTER_SUB(Counter, Value)  __atomic_sub_fetch (&(Counter), (Value), __ATOMIC_RELAXED)
+#else
+#define POOL_STATISTICS_LOCK()    POOL_LOCK ()
+#define POOL_STATISTICS_UNLOCK()  POOL_UNLOCK ()
+#define POOL_COUNTER_ADD(Counter, Value)  ((Counter) += (Value))
+#define POOL_COUNTER_SUB(Counter, Value)  ((Counter) -= (Value))
+#endif
+
+/**
+  Raise a high-water counter to a new value.
+
+  @param  Peak                  The high-water counter.
+  @param  Value                 The new value of the counter it follows.
+**/
+VOID
+InternalPoolRaisePeak (
+  IN OUT UINTN  *Peak,
+  IN     UINTN  Value
+  )
+{
+#if defined(POOL_THREAD_CACHE)
+  UINTN  OldPeak;
+
+  //
+  // A block freed by another thread than the one which allocated it may be subtracted before
+  // it is added, then the counter is transiently below 0.
+  //
+  if ((INTN)Value < 0) {
+    return ;
+  }
+  OldPeak = __atomic_load_n (Peak, __ATOMIC_RELAXED);
+  while ((Value > OldPeak) &&
+         !__atomic_compare_exchange_n (Peak, &OldPeak, Value, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+#else
+  if (Value > *Peak) {
+    *Peak = Value;
+  }
+#endif
+}
+
+#if defined(POOL_THREAD_CACHE)
+
+/**
+  Add the counters of the current thread to the statistics.
+**/
+VOID
+InternalPoolFoldThreadCounters (
+  VOID
+  )
+{
+  POOL_THREAD_COUNTERS  *Counters;
+
+  Counters = &mPoolThreadCounters;
+  if (Counters->Pending == 0) {
+    return ;
+  }
+  POOL_COUNTER_ADD (mPoolStatistics.AllocationCount, Counters->AllocationCount);
+  POOL_COUNTER_ADD (mPoolStatistics.FreeCount, Counters->FreeCount);
+  InternalPoolRaisePeak (&mPoolStatistics.PeakSize, POOL_COUNTER_ADD (mPoolStatistics.CurrentSize, Counters->CurrentSize));
+  InternalPoolRaisePeak (&mPoolStatistics.PeakBlockSize, POOL_COUNTER_ADD (mPoolStatistics.BlockSize, Counters->BlockSize));
+  memset (Counters, 0, sizeof(POOL_THREAD_COUNTERS));
+}
+
+#endif
+
+/**
+  Count an allocated block in the statistics.
+
+  @param  BlockSize             The size in bytes of the block, with its head.
+  @param  Size                  The number of bytes requested.
+**/
+VOID
+InternalPoolCountAllocation (
+  IN UINTN  BlockSize,
+  IN UINTN  Size
+  )
+{
+#if defined(POOL_THREAD_CACHE)
+  POOL_THREAD_COUNTERS  *Counters;
+
+  if (mPoolThreadCacheState == POOL_THREAD_CACHE_ACTIVE) {
+    Counters = &mPoolThreadCounters;
+    Counters->AllocationCount++;
+    Counters->CurrentSize += Size;
+    Counters->BlockSize += BlockSize;
+    if (++Counters->Pending >= POOL_THREAD_COUNTERS_FOLD) {
+      InternalPoolFoldThreadCounters ();
+    }
+    return ;
+  }
+#endif
+  POOL_COUNTER_ADD (mPoolStatistics.AllocationCount, 1);
+  InternalPoolRaisePeak (&mPoolStatistics.PeakSize, POOL_COUNTER_ADD (mPoolStatistics.CurrentSize, Size));
+  InternalPoolRaisePeak (&mPoolStatistics.PeakBlockSize, POOL_COUNTER_ADD (mPoolStatistics.BlockSize, BlockSize));
+}
+
+/**
+  Count a freed block in the statistics.
+
+  @param  BlockSize             The size in bytes of the block, with its head.
+  @param  Size                  The number of bytes requested.
+**/
+VOID
+InternalPoolCountFree (
+  IN UINTN  BlockSize,
+  IN UINTN  Size
+  )
+{
+#if defined(POOL_THREAD_CACHE)
+  POOL_THREAD_COUNTERS  *Counters;
+
+  if (mPoolThreadCacheState == POOL_THREAD_CACHE_ACTIVE) {
+    Counters = &mPoolThreadCounters;
+    Counters->FreeCount++;
+    Counters->CurrentSize -= Size;
+    Counters->BlockSize -= BlockSize;
+    if (++Counters->Pending >= POOL_THREAD_COUNTERS_FOLD) {
+      InternalPoolFoldThreadCounters ();
+    }
+    return ;
+  }
+#endif
+  POOL_COUNTER_ADD (mPoolStatistics.FreeCount, 1);
+  POOL_COUNTER_SUB (mPoolStatistics.CurrentSize, Size);
+  POOL_COUNTER_SUB (mPoolStatistics.BlockSize, BlockSize);
+}
+
+/**
+  Returns the size class of an allocation.
+
+  @param  AllocationSize        The number of bytes to allocate.
+
+  @return The size class, or POOL_CLASS_LARGE if it is larger than the largest size class.
+**/
+UINTN
+InternalPoolSizeClass (
+  IN UINTN  AllocationSize
+  )
+{
+  UINTN  Class;
+
+  for (Class = 0; Class < POOL_CLASS_COUNT; Class++) {
+    if (AllocationSize <= POOL_CLASS_SIZE (Class)) {
+      return Class;
+    }
+  }
+  return POOL_CLASS_LARGE;
+}
+
+/**
+  Carves a new block from the current chunk, or from the static arena. The caller holds the lock.
+
+  @param  Class                 The size class of the block.
+
+  @return The block, or NULL if the heap or the arena is exhausted.
+**/
+POOL_FREE_BLOCK *
+InternalPoolCarveBlock (
+  IN UINTN  Class
+  )
+{
+  POOL_FREE_BLOCK  *Block;
+#if !defined(POOL_STATIC_ARENA)
+  UINT8            *Chunk;
+#endif
+
+#if defined(POOL_STATIC_ARENA)
+  if (mPoolChunkEnd == NULL) {
+    mPoolChunkTop = (UINT8 *)mPoolStaticArena;
+    mPoolChunkEnd = (UINT8 *)mPoolStaticArena + sizeof(mPoolStaticArena);
+  }
+  if ((UINTN)(mPoolChunkEnd - mPoolChunkTop) < POOL_BLOCK_SIZE (Class)) {
+    return NULL;
+  }
+#else
+  if ((UINTN)(mPoolChunkEnd - mPoolChunkTop) < POOL_BLOCK_SIZE (Class)) {
+    //
+    // The chunks are linked through their first bytes, and the tail of the previous chunk
+    // is left unused.
+    //
+    Chunk = malloc (POOL_CHUNK_SIZE);
+    if (Chunk == NULL) {
+      return NULL;
+    }
+    *(VOID **)Chunk = mPoolChunkList;
+    mPoolChunkList = Chunk;
+    mPoolChunkTop = Chunk + sizeof(POOL_BLOCK_HEAD);
+    mPoolChunkEnd = Chunk + POOL_CHUNK_SIZE;
+  }
+#endif
+
+  Block = (POOL_FREE_BLOCK *)mPoolChunkTop;
+  mPoolChunkTop += POOL_BLOCK_SIZE (Class);
+  Block->Head.Signature = POOL_SIGNATURE;
+  Block->Head.Class = (UINT32)Class;
+  InternalPoolRaisePeak (&mPoolStatistics.PeakReservedSize,
+    POOL_COUNTER_ADD (mPoolStatistics.ReservedSize, POOL_BLOCK_SIZE (Class)));
+  return Block;
+}
+
+/**
+  Takes a free block of a size class from the shared free list, or carves a new one.
+  The caller holds the lock.
+
+  @param  Class                 The size class of the block.
+
+  @return The block, or NULL if the heap or the arena is exhausted.
+**/
+POOL_FREE_BLOCK *
+InternalPoolTakeBlock (
+  IN UINTN  Class
+  )
+{
+  POOL_FREE_BLOCK  *Block;
+
+  Block = mPoolFreeLists.Free[Class];
+  if (Block == NULL) {
+    return InternalPoolCarveBlock (Class);
+  }
+  mPoolFreeLists.Free[Class] = Block->Next;
+  mPoolFreeLists.Count[Class]--;
+  return Block;
+}
+
+#if defined(POOL_THREAD_CACHE)
+
+/**
+  Gives the cache of a thread back to the shared free lists.
+
+  @param  Cache                 The cache of the thread.
+**/
+VOID
+InternalPoolFlushThreadCache (
+  IN POOL_FREE_LISTS  *Cache
+  )
+{
+  UINTN            Class;
+  POOL_FREE_BLOCK  *Block;
+
+  POOL_LOCK ();
+  for (Class = 0; Class < POOL_CLASS_COUNT; Class++) {
+    while ((Block = Cache->Free[Class]) != NULL) {
+      Cache->Free[Class] = Block->Next;
+      Block->Next = mPoolFreeLists.Free[Class];
+      mPoolFreeLists.Free[Class] = Block;
+      mPoolFreeLists.Count[Class]++;
+    }
+    Cache->Count[Class] = 0;
+  }
+  POOL_UNLOCK ();
+}
+
+/**
+  The destructor of the thread cache key, called when a thread exits.
+
+  @param  Cache                 The cache of the thread.
+**/
+VOID
+InternalPoolThreadExit (
+  IN VOID  *Cache
+  )
+{
+  //
+  // The blocks freed by the later destructors of the thread go to the shared free lists.
+  //
+  InternalPoolFoldThreadCounters ();
+  mPoolThreadCacheState = POOL_THREAD_CACHE_EXITED;
+  InternalPoolFlushThreadCache (Cache);
+}
+
+VOID
+InternalPoolCreateThreadCacheKey (
+  VOID
+  )
+{
+  mPoolThreadCacheKeyReady = (pthread_key_create (&mPoolThreadCacheKey, InternalPoolThreadExit) == 0);
+}
+
+/**
+  Returns the cache of the current thread, registering it on its first use.
+
+  @return The cache of the thread, or NULL if the thread cannot have one.
+**/
+POOL_FREE_LISTS *
+InternalPoolGetThreadCache (
+  VOID
+  )
+{
+  if (mPoolThreadCacheState == POOL_THREAD_CACHE_ACTIVE) {
+    return &mPoolThreadCache;
+  }
+  if (mPoolThreadCacheState == POOL_THREAD_CACHE_EXITED) {
+    return NULL;
+  }
+
+  //
+  // Without the destructor, the cache would be lost when the thread exits.
+  //
+  pthread_once (&mPoolThreadCacheKeyOnce, InternalPoolCreateThreadCacheKey);
+  if (!mPoolThreadCacheKeyReady ||
+      (pthread_setspecific (mPoolThreadCacheKey, &mPoolThreadCache) != 0)) {
+    mPoolThreadCacheState = POOL_THREAD_CACHE_EXITED;
+    return NULL;
+  }
+  mPoolThreadCacheState = POOL_THREAD_CACHE_ACTIVE;
+  return &mPoolThreadCache;
+}
+
+/**
+  Allocates a block of a size class from the cache of the thread, refilling the cache with a batch
+  of blocks when it is empty.
+
+  @param  Class                 The size class of the block.
+
+  @return The block, or NULL if the heap is exhausted.
+**/
+POOL_FREE_BLOCK *
+InternalPoolAllocateBlock (
+  IN UINTN  Class
+  )
+{
+  POOL_FREE_LISTS  *Cache;
+  POOL_FREE_BLOCK  *Block;
+  UINTN            Index;
+
+  Cache = InternalPoolGetThreadCache ();
+  if (Cache == NULL) {
+    POOL_LOCK ();
+    Block = InternalPoolTakeBlock (Class);
+    POOL_UNLOCK ();
+    return Block;
+  }
+
+  if (Cache->Free[Class] == NULL) {
+    POOL_LOCK ();
+    for (Index = 0; Index < mPoolCacheLimit[Class] / 2; Index++) {
+      Block = InternalPoolTakeBlock (Class);
+      if (Block == NULL) {
+        break;
+      }
+      Block->Next = Cache->Free[Class];
+      Cache->Free[Class] = Block;
+      Cache->Count[Class]++;
+    }
+    POOL_UNLOCK ();
+    if (Cache->Free[Class] == NULL) {
+      return NULL;
+    }
+  }
+
+  Block = Cache->Free[Class];
+  Cache->Free[Class] = Block->Next;
+  Cache->Count[Class]--;
+  return Block;
+}
+
+/**
+  Frees a block of a size class to the cache of the thread, giving a batch of blocks back to the
+  shared free list when the cache is full.
+
+  @param  Block                 The block.
+**/
+VOID
+InternalPoolFreeBlock (
+  IN POOL_FREE_BLOCK  *Block
+  )
+{
+  POOL_FREE_LISTS  *Cache;
+  UINTN            Class;
+  UINTN            Index;
+  POOL_FREE_BLOCK  *Next;
+
+  Class = Block->Head.Class;
+  Cache = InternalPoolGetThreadCache ();
+  if (Cache == NULL) {
+    POOL_LOCK ();
+    Block->Next = mPoolFreeLists.Free[Class];
+    mPoolFreeLists.Free[Class] = Block;
+    mPoolFreeLists.Count[Class]++;
+    POOL_UNLOCK ();
+    return ;
+  }
+
+  Block->Next = Cache->Free[Class];
+  Cache->Free[Class] = Block;
+  Cache->Count[Class]++;
+  if (Cache->Count[Class] < mPoolCacheLimit[Class]) {
+    return ;
+  }
+
+  POOL_LOCK ();
+  for (Index = 0; Index < mPoolCacheLimit[Class] / 2; Index++) {
+    Next = Cache->Free[Class]->Next;
+    Cache->Free[Class]->Next = mPoolFreeLists.Free[Class];
+    mPoolFreeLists.Free[Class] = Cache->Free[Class];
+    mPoolFreeLists.Count[Class]++;
+    Cache->Free[Class] = Next;
+    Cache->Count[Class]--;
+  }
+  POOL_UNLOCK ();
+}
+
+#else
+
+/**
+  Allocates a block of a size class from the shared free list.
+
+  @param  Class                 The size class of the block.
+
+  @return The block, or NULL if the heap or the arena is exhausted.
+**/
+POOL_FREE_BLOCK *
+InternalPoolAllocateBlock (
+  IN UINTN  Class
+  )
+{
+  POOL_FREE_BLOCK  *Block;
+
+  POOL_LOCK ();
+  Block = InternalPoolTakeBlock (Class);
+  POOL_UNLOCK ();
+  return Block;
+}
+
+/**
+  Frees a block of a size class to the shared free list.
+
+  @param  Block                 The block.
+**/
+VOID
+InternalPoolFreeBlock (
+  IN POOL_FREE_BLOCK  *Block
+  )
+{
+  UINTN  Class;
+
+  Class = Block->Head.Class;
+  POOL_LOCK ();
+  Block->Next = mPoolFreeLists.Free[Class];
+  mPoolFreeLists.Free[Class] = Block;
+  mPoolFreeLists.Count[Class]++;
+  POOL_UNLOCK ();
+}
+
+#endif
+
+/**
+  Sets a caller-provided arena for the pool allocations.
+
+  The pool allocations are served from the arena while it is set.
+  The arena can only be changed when no block allocated from it is outstanding.
+
+  @param  Arena                 The arena buffer, or NULL to allocate from the pools.
+  @param  ArenaSize             The size in bytes of the arena buffer.
+  @param  Strict                If TRUE, an allocation fails when the arena cannot serve it,
+                                instead of falling back to the pools.
+
+  @retval TRUE  the arena is set.
+  @retval FALSE a block allocated from the current arena is outstanding.
+**/
+BOOLEAN
+EFIAPI
+SetPoolArena (
+  IN VOID     *Arena OPTIONAL,
+  IN UINTN    ArenaSize,
+  IN BOOLEAN  Strict
+  )
+{
+  if (mPoolArena.Count != 0) {
+    return FALSE;
+  }
+
+  mPoolArena.Base = Arena;
+  mPoolArena.Size = (Arena == NULL) ? 0 : ArenaSize;
+  mPoolArena.Top = 0;
+  mPoolArena.PeakSize = 0;
+  mPoolArena.Count = 0;
+  mPoolArena.Strict = Strict;
+  return TRUE;
+}
+
+/**
+  Returns the peak size in bytes used in the arena since it was set.
+
+  @return The peak size in bytes used in the arena.
+**/
+UINTN
+EFIAPI
+GetPoolArenaPeakSize (
+  VOID
+  )
+{
+  return mPoolArena.PeakSize;
+}
+
+/**
+  Sets a caller-provided allocator for the pool allocations of the current thread.
+
+  With GCC and CLANG, each thread has its own allocator. Otherwise, the allocator is shared by all the threads.
+
+  @param  Allocator             The allocator, or NULL to allocate from the pools.
+
+  @retval TRUE  the allocator is set.
+  @retval FALSE the functions of the allocator are NULL.
+**/
+BOOLEAN
+EFIAPI
+SetPoolAllocator (
+  IN CONST POOL_ALLOCATOR  *Allocator OPTIONAL
+  )
+{
+  if (Allocator == NULL) {
+    memset (&mPoolAllocator, 0, sizeof(mPoolAllocator));
+    return TRUE;
+  }
+  if ((Allocator->Allocate == NULL) || (Allocator->Free == NULL)) {
+    return FALSE;
+  }
+  mPoolAllocator = *Allocator;
+  return TRUE;
+}
+
+/**
+  Returns the number of pool allocations since the program started.
+
+  It counts every AllocatePool and AllocateZeroPool call, whether it is served from the arena, the allocator or the pools.
+
+  @return The number of pool allocations.
+**/
+UINTN
+EFIAPI
+GetPoolAllocationCount (
+  VOID
+  )
+{
+  POOL_STATISTICS  Statistics;
+
+  GetPoolStatistics (&Statistics);
+  return mPoolArenaAllocationCount + mPoolPlacedAllocationCount + Statistics.AllocationCount + Statistics.FailureCount;
+}
+
+/**
+  Returns the statistics of the pool allocations since the program started.
+
+  The allocations served from the arena of SetPoolArena or by the allocator of SetPoolAllocator are not counted.
+
+  @param  Statistics            The statistics of the pool allocations.
+**/
+VOID
+EFIAPI
+GetPoolStatistics (
+  OUT POOL_STATISTICS  *Statistics
+  )
+{
+#if defined(POOL_THREAD_CACHE)
+  InternalPoolFoldThreadCounters ();
+#endif
+  POOL_STATISTICS_LOCK ();
+  *Statistics = mPoolStatistics;
+  POOL_STATISTICS_UNLOCK ();
+  if ((INTN)Statistics->CurrentSize < 0) {
+    Statistics->CurrentSize = 0;
+  }
+  if ((INTN)Statistics->BlockSize < 0) {
+    Statistics->BlockSize = 0;
+  }
+  Statistics->InternalFragmentationSize = (Statistics->BlockSize > Statistics->CurrentSize) ?
+                                          (Statistics->BlockSize - Statistics->CurrentSize) : 0;
+  Statistics->ExternalFragmentationSize = (Statistics->ReservedSize > Statistics->BlockSize) ?
+                                          (Statistics->ReservedSize - Statistics->BlockSize) : 0;
+}
+
+/**
+  Sets the tag of the pool allocations of the current thread.
+
+  The allocations are not audited, so that the tag is ignored.
+
+  @param  RequestCode           The SPDM request code, or 0 if none.
+  @param  Phase                 The phase, one of POOL_ALLOCATION_PHASE_*.
+**/
+VOID
+EFIAPI
+SetPoolAllocationTag (
+  IN UINT8  RequestCode,
+  IN UINT8  Phase
+  )
+{
+}
+
+/**
+  Returns the pool allocations attributed to one SPDM request code in one phase.
+
+  @param  RequestCode           The SPDM request code, or 0 for the allocations without a request code.
+  @param  Phase                 The phase, one of POOL_ALLOCATION_PHASE_*.
+  @param  Record                The pool allocations of the request code in the phase.
+
+  @retval FALSE the allocations are not audited.
+**/
+BOOLEAN
+EFIAPI
+GetPoolAuditRecord (
+  IN  UINT8              RequestCode,
+  IN  UINT8              Phase,
+  OUT POOL_AUDIT_RECORD  *Record
+  )
+{
+  return FALSE;
+}
+
+/**
+  Clears the counts of the pool allocations of all request codes and phases.
+**/
+VOID
+EFIAPI
+ResetPoolAudit (
+  VOID
+  )
+{
+}
+
+/**
+  Allocates a buffer from the arena.
+
+  @param  AllocationSize        The number of bytes to allocate.
+
+  @return A pointer to the allocated buffer or NULL if the arena is exhausted.
+**/
+VOID *
+InternalAllocateArenaPool (
+  IN UINTN  AllocationSize
+  )
+{
+  POOL_ARENA_HEAD  *PoolHdr;
+  UINTN            BlockSize;
+
+  if (AllocationSize > mPoolArena.Size) {
+    return NULL;
+  }
+  BlockSize = sizeof(POOL_ARENA_HEAD) + ALIGN_VALUE (AllocationSize, POOL_ARENA_ALIGNMENT);
+  if (BlockSize > mPoolArena.Size - mPoolArena.Top) {
+    return NULL;
+  }
+
+  PoolHdr = (POOL_ARENA_HEAD *)(mPoolArena.Base + mPoolArena.Top);
+  PoolHdr->Size = BlockSize;
+  mPoolArena.Top += BlockSize;
+  mPoolArena.Count++;
+  if (mPoolArena.Top > mPoolArena.PeakSize) {
+    mPoolArena.PeakSize = mPoolArena.Top;
+  }
+  return PoolHdr + 1;
+}
+
+/**
+  Returns if a buffer is allocated from the arena.
+
+  @param  Buffer                Pointer to the buffer.
+
+  @retval TRUE  the buffer is allocated from the arena.
+  @retval FALSE the buffer is not allocated from the arena.
+**/
+BOOLEAN
+InternalIsArenaPool (
+  IN VOID   *Buffer
+  )
+{
+  return ((UINT8 *)Buffer >= mPoolArena.Base) &&
+         ((UINT8 *)Buffer < mPoolArena.Base + mPoolArena.Size);
+}
+
+/**
+  Allocates a buffer from the pools.
+
+  @param  AllocationSize        The number of bytes to allocate.
+
+  @return A pointer to the allocated buffer or NULL if allocation fails.
+**/
+VOID *
+InternalAllocatePool (
+  IN UINTN  AllocationSize
+  )
+{
+  UINTN            Class;
+  POOL_FREE_BLOCK  *Block;
+
+  Class = InternalPoolSizeClass (AllocationSize);
+  if (Class == POOL_CLASS_LARGE) {
+#if defined(POOL_STATIC_ARENA)
+    Block = NULL;
+#else
+    if (AllocationSize > MAX_UINTN - sizeof(POOL_BLOCK_HEAD)) {
+      Block = NULL;
+    } else {
+      Block = malloc (sizeof(POOL_BLOCK_HEAD) + AllocationSize);
+    }
+    if (Block != NULL) {
+      Block->Head.Signature = POOL_SIGNATURE;
+      Block->Head.Class = POOL_CLASS_LARGE;
+    }
+#endif
+  } else {
+    Block = InternalPoolAllocateBlock (Class);
+  }
+
+  POOL_STATISTICS_LOCK ();
+  if (Block == NULL) {
+    POOL_COUNTER_ADD (mPoolStatistics.FailureCount, 1);
+  } else if (Class == POOL_CLASS_LARGE) {
+    InternalPoolRaisePeak (&mPoolStatistics.PeakReservedSize,
+      POOL_COUNTER_ADD (mPoolStatistics.ReservedSize, sizeof(POOL_BLOCK_HEAD) + AllocationSize));
+    InternalPoolCountAllocation (sizeof(POOL_BLOCK_HEAD) + AllocationSize, AllocationSize);
+  } else {
+    InternalPoolCountAllocation (POOL_BLOCK_SIZE (Class), AllocationSize);
+  }
+  POOL_STATISTICS_UNLOCK ();
+  if (Block == NULL) {
+    return NULL;
+  }
+  Block->Head.Size = AllocationSize;
+  return &Block->Head + 1;
+}
+
+/**
+  Allocates a buffer from the allocator of the current thread.
+
+  @param  AllocationSize        The number of bytes to allocate.
+
+  @return A pointer to the allocated buffer or NULL if the allocator cannot serve it.
+**/
+VOID *
+InternalAllocatePlacedPool (
+  IN UINTN  AllocationSize
+  )
+{
+  POOL_PLACED_HEAD  *Placed;
+  POOL_BLOCK_HEAD   *Head;
+
+  POOL_STATISTICS_LOCK ();
+  POOL_COUNTER_ADD (mPoolPlacedAllocationCount, 1);
+  POOL_STATISTICS_UNLOCK ();
+  if (AllocationSize > MAX_UINTN - POOL_PLACED_OVERHEAD) {
+    return NULL;
+  }
+  Placed = mPoolAllocator.Allocate (mPoolAllocator.Context, POOL_PLACED_OVERHEAD + AllocationSize);
+  if (Placed == NULL) {
+    return NULL;
+  }
+  Placed->Allocator = mPoolAllocator;
+  Head = (POOL_BLOCK_HEAD *)(Placed + 1);
+  Head->Signature = POOL_SIGNATURE;
+  Head->Class = POOL_CLASS_PLACED;
+  Head->Size = AllocationSize;
+  return Head + 1;
+}
+
+VOID *
+EFIAPI
+AllocatePool (
+  IN UINTN  AllocationSize
+  )
+{
+  VOID *Buffer;
+
+  //
+  // The arena is used by a single thread.
+  //
+  if (mPoolArena.Size != 0) {
+    Buffer = InternalAllocateArenaPool (AllocationSize);
+    if (Buffer != NULL) {
+      mPoolArenaAllocationCount++;
+      return Buffer;
+    }
+  }
+  if (mPoolArena.Strict) {
+    mPoolArenaAllocationCount++;
+    return NULL;
+  }
+  if (mPoolAllocator.Allocate != NULL) {
+    return InternalAllocatePlacedPool (AllocationSize);
+  }
+  return InternalAllocatePool (AllocationSize);
+}
+
+VOID *
+EFIAPI
+AllocateZeroPool (
+  IN UINTN  AllocationSize
+  )
+{
+  VOID *Buffer;
+  Buffer = AllocatePool (AllocationSize);
+  if (Buffer == NULL) {
+    return NULL;
+  }
+  memset (Buffer, 0, AllocationSize);
+  return Buffer;
+}
+
+VOID
+EFIAPI
+FreePool (
+  IN VOID   *Buffer
+  )
+{
+  POOL_ARENA_HEAD  *PoolHdr;
+  POOL_FREE_BLOCK  *Block;
+  POOL_PLACED_HEAD *Placed;
+  UINTN            Class;
+  UINTN            Size;
+
+  if (Buffer == NULL) {
+    return ;
+  }
+
+  if (InternalIsArenaPool (Buffer)) {
+    PoolHdr = (POOL_ARENA_HEAD *)Buffer - 1;
+    assert (mPoolArena.Count != 0);
+    mPoolArena.Count--;
+    if (mPoolArena.Count == 0) {
+      mPoolArena.Top = 0;
+    } else if ((UINT8 *)PoolHdr + PoolHdr->Size == mPoolArena.Base + mPoolArena.Top) {
+      mPoolArena.Top -= PoolHdr->Size;
+    }
+    return ;
+  }
+
+  Block = (POOL_FREE_BLOCK *)((POOL_BLOCK_HEAD *)Buffer - 1);
+  assert (Block->Head.Signature == POOL_SIGNATURE);
+  Class = Block->Head.Class;
+  Size = (UINTN)Block->Head.Size;
+
+  if (Class == POOL_CLASS_PLACED) {
+    Placed = (POOL_PLACED_HEAD *)&Block->Head - 1;
+    Block->Head.Signature = 0;
+    Placed->Allocator.Free (Placed->Allocator.Context, Placed, POOL_PLACED_OVERHEAD + Size);
+    return ;
+  }
+
+  POOL_STATISTICS_LOCK ();
+  if (Class == POOL_CLASS_LARGE) {
+    InternalPoolCountFree (sizeof(POOL_BLOCK_HEAD) + Size, Size);
+    POOL_COUNTER_SUB (mPoolStatistics.ReservedSize, sizeof(POOL_BLOCK_HEAD) + Size);
+  } else {
+    InternalPoolCountFree (POOL_BLOCK_SIZE (Class), Size);
+  }
+  POOL_STATISTICS_UNLOCK ();
+
+  if (Class == POOL_CLASS_LARGE) {
+    Block->Head.Signature = 0;
+    free (Block);
+  } else {
+    InternalPoolFreeBlock (Block);
+  }
+}
@@ -0,0 +1,352 @@
+/** @file
+  ChaCha20 DRBG implementation of the Random Number Generator Library.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#if defined(_MSC_VER)
+#define _CRT_RAND_S
+#endif
+
+#include <Base.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// The random numbers are the keystream of ChaCha20, generated RNG_DRBG_BUFFER_SIZE bytes at a time
+// into a buffer, then served from the buffer. The first RNG_DRBG_KEY_SIZE bytes of a buffer are not
+// served: they are the key of the next buffer, so that the served bytes cannot be computed back from
+// the state, and the served bytes are wiped from the buffer ("fast key erasure").
+//
+// The key is seeded from the entropy of the OS: getrandom on Linux, /dev/urandom on the other POSIX
+// systems and rand_s with MSVC. It is reseeded after RNG_DRBG_RESEED_INTERVAL bytes, by mixing new
+// entropy into it, and in the child of a fork, so that the parent and the child do not share the
+// random numbers.
+//
+// With GCC, CLANG and MSVC, each thread has its own state, which it uses without any lock. The
+// model checking and symbolic execution builds have one state.
+//
+#define RNG_DRBG_KEY_SIZE          32
+#define RNG_DRBG_BLOCK_SIZE        64
+#define RNG_DRBG_BUFFER_SIZE       SIZE_1KB
+#define RNG_DRBG_RESEED_INTERVAL   SIZE_1MB
+
+#if !defined(_MSC_VER) && !defined(CBMC) && !defined(CBMC_CC) && !defined(TEST_WITH_KLEE)
+#define RNG_DRBG_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+typedef struct {
+  UINT8    Buffer[RNG_DRBG_BUFFER_SIZE];
+  UINTN    Offset;
+  UINTN    Generated;
+  UINTN    ForkGeneration;
+  BOOLEAN  Seeded;
+} RNG_DRBG_STATE;
+
+#if defined(RNG_DRBG_THREADS)
+
+pthread_once_t    mRngDrbgOnce = PTHREAD_ONCE_INIT;
+pthread_key_t     mRngDrbgKey;
+BOOLEAN           mRngDrbgKeyReady;
+volatile UINTN    mRngDrbgForkGeneration;
+
+__thread RNG_DRBG_STATE  mRngDrbgState;
+
+#elif defined(_MSC_VER) && !defined(CBMC) && !defined(CBMC_CC)
+
+__declspec(thread) RNG_DRBG_STATE  mRngDrbgState;
+
+#else
+
+RNG_DRBG_STATE  mRngDrbgState;
+
+#endif
+
+#define RNG_DRBG_ROTATE(Value, Count)  (((Value) << (Count)) | ((Value) >> (32 - (Count))))
+
+#define RNG_DRBG_QUARTER_ROUND(A, B, C, D)  \
+  do { \
+    A += B; D ^= A; D = RNG_DRBG_ROTATE (D, 16); \
+    C += D; B ^= C; B = RNG_DRBG_ROTATE (B, 12); \
+    A += B; D ^= A; D = RNG_DRBG_ROTATE (D, 8); \
+    C += D; B ^= C; B = RNG_DRBG_ROTATE (B, 7); \
+  } while (FALSE)
+
+/**
+  Reads a little endian UINT32.
+**/
+UINT32
+InternalRngDrbgRead32 (
+  IN CONST UINT8  *Buffer
+  )
+{
+  return (UINT32)Buffer[0] | ((UINT32)Buffer[1] << 8) | ((UINT32)Buffer[2] << 16) | ((UINT32)Buffer[3] << 24);
+}
+
+/**
+  Writes a little endian UINT32.
+**/
+VOID
+InternalRngDrbgWrite32 (
+  OUT UINT8   *Buffer,
+  IN  UINT32  Value
+  )
+{
+  Buffer[0] = (UINT8)Value;
+  Buffer[1] = (UINT8)(Value >> 8);
+  Buffer[2] = (UINT8)(Value >> 16);
+  Buffer[3] = (UINT8)(Value >> 24);
+}
+
+/**
+  Generates one ChaCha20 block, as defined in RFC 8439.
+
+  @param  Input                        The 16 words of the initial state.
+  @param  Output                       The RNG_DRBG_BLOCK_SIZE bytes of the block.
+**/
+VOID
+InternalRngDrbgChaCha20Block (
+  IN  CONST UINT32  *Input,
+  OUT UINT8         *Output
+  )
+{
+  UINT32  X[16];
+  UINTN   Index;
+
+  for (Index = 0; Index < 16; Index++) {
+    X[Index] = Input[Index];
+  }
+  for (Index = 0; Index < 10; Index++) {
+    RNG_DRBG_QUARTER_ROUND (X[0], X[4], X[8],  X[12]);
+    RNG_DRBG_QUARTER_ROUND (X[1], X[5], X[9],  X[13]);
+    RNG_DRBG_QUARTER_ROUND (X[2], X[6], X[10], X[14]);
+    RNG_DRBG_QUARTER_ROUND (X[3], X[7], X[11], X[15]);
+    RNG_DRBG_QUARTER_ROUND (X[0], X[5], X[10], X[15]);
+    RNG_DRBG_QUARTER_ROUND (X[1], X[6], X[11], X[12]);
+    RNG_DRBG_QUARTER_ROUND (X[2], X[7], X[8],  X[13]);
+    RNG_DRBG_QUARTER_ROUND (X[3], X[4], X[9],  X[14]);
+  }
+  for (Index = 0; Index < 16; Index++) {
+    InternalRngDrbgWrite32 (Output + Index * sizeof(UINT32), X[Index] + Input[Index]);
+  }
+  memset (X, 0, sizeof(X));
+}
+
+/**
+  Refills the buffer with the keystream of the key at the start of the buffer, with a zero nonce.
+  The key is replaced by the first bytes of the keystream, which are not served.
+
+  @param  State                        The DRBG state.
+**/
+VOID
+InternalRngDrbgRefill (
+  IN OUT RNG_DRBG_STATE  *State
+  )
+{
+  UINT32  Input[16];
+  UINTN   Index;
+
+  Input[0] = 0x61707865;
+  Input[1] = 0x3320646e;
+  Input[2] = 0x79622d32;
+  Input[3] = 0x6b206574;
+  for (Index = 0; Index < RNG_DRBG_KEY_SIZE / sizeof(UINT32); Index++) {
+    Input[4 + Index] = InternalRngDrbgRead32 (State->Buffer + Index * sizeof(UINT32));
+  }
+  Input[12] = 0;
+  Input[13] = 0;
+  Input[14] = 0;
+  Input[15] = 0;
+  for (Index = 0; Index < RNG_DRBG_BUFFER_SIZE / RNG_DRBG_BLOCK_SIZE; Index++) {
+    Input[12] = (UINT32)Index;
+    InternalRngDrbgChaCha20Block (Input, State->Buffer + Index * RNG_DRBG_BLOCK_SIZE);
+  }
+  memset (Input, 0, sizeof(Input));
+
+  State->Offset = RNG_DRBG_KEY_SIZE;
+  State->Generated += RNG_DRBG_BUFFER_SIZE;
+}
+
+/**
+  Reads entropy from the OS.
+
+  @param  Buffer                       The buffer to receive the entropy.
+  @param  Size                         The size in bytes of the buffer.
+
+  @retval TRUE   The buffer is filled.
+  @retval FALSE  The OS has no entropy to give.
+**/
+BOOLEAN
+InternalRngDrbgGetEntropy (
+  OUT UINT8  *Buffer,
+  IN  UINTN  Size
+  )
+{
+#if defined(_MSC_VER)
+  UINTN         Index;
+  unsigned int  Value;
+
+  for (Index = 0; Index < Size; Index += sizeof(Value)) {
+    if (rand_s (&Value) != 0) {
+      return FALSE;
+    }
+    memcpy (Buffer + Index, &Value, MIN (sizeof(Value), Size - Index));
+  }
+  Value = 0;
+  return TRUE;
+#else
+  FILE   *FpIn;
+  UINTN  ReadSize;
+#if defined(RNG_DRBG_THREADS) && defined(__linux__) && defined(SYS_getrandom)
+  long   Result;
+
+  ReadSize = 0;
+  while (ReadSize < Size) {
+    Result = syscall (SYS_getrandom, Buffer + ReadSize, Size - ReadSize, 0);
+    if (Result > 0) {
+      ReadSize += Result;
+    } else if ((Result < 0) && (errno != EINTR)) {
+      break;
+    }
+  }
+  if (ReadSize == Size) {
+    return TRUE;
+  }
+  //
+  // The kernel is older than getrandom.
+  //
+#endif
+
+  if ((FpIn = fopen ("/dev/urandom", "rb")) == NULL) {
+    return FALSE;
+  }
+  ReadSize = fread (Buffer, 1, Size, FpIn);
+  fclose (FpIn);
+  return (BOOLEAN)(ReadSize == Size);
+#endif
+}
+
+#if defined(RNG_DRBG_THREADS)
+
+/**
+  Wipes the state of a thread when it exits.
+**/
+VOID
+InternalRngDrbgThreadExit (
+  IN VOID  *Context
+  )
+{
+  memset (Context, 0, sizeof(RNG_DRBG_STATE));
+}
+
+/**
+  In the child of a fork, the other states are gone, and the state of the forking thread is the same
+  as in the parent. It is reseeded on its next use.
+**/
+VOID
+InternalRngDrbgForkChild (
+  VOID
+  )
+{
+  mRngDrbgForkGeneration++;
+}
+
+VOID
+InternalRngDrbgInitialize (
+  VOID
+  )
+{
+  mRngDrbgKeyReady = (pthread_key_create (&mRngDrbgKey, InternalRngDrbgThreadExit) == 0);
+  pthread_atfork (NULL, NULL, InternalRngDrbgForkChild);
+}
+
+#endif
+
+/**
+  Seeds the state on its first use, or reseeds it by mixing new entropy into its key.
+
+  @param  State                        The DRBG state.
+
+  @retval TRUE   The state is seeded.
+  @retval FALSE  The OS has no entropy to give.
+**/
+BOOLEAN
+InternalRngDrbgSeed (
+  IN OUT RNG_DRBG_STATE  *State
+  )
+{
+  UINT8  Entropy[RNG_DRBG_KEY_SIZE];
+  UINTN  Index;
+
+#if defined(RNG_DRBG_THREADS)
+  pthread_once (&mRngDrbgOnce, InternalRngDrbgInitialize);
+  if (!State->Seeded && mRngDrbgKeyReady) {
+    pthread_setspecific (mRngDrbgKey, State);
+  }
+  State->ForkGeneration = mRngDrbgForkGeneration;
+#endif
+
+  if (!InternalRngDrbgGetEntropy (Entropy, sizeof(Entropy))) {
+    return FALSE;
+  }
+  for (Index = 0; Index < RNG_DRBG_KEY_SIZE; Index++) {
+    State->Buffer[Index] ^= Entropy[Index];
+  }
+  memset (Entropy, 0, sizeof(Entropy));
+
+  State->Generated = 0;
+  InternalRngDrbgRefill (State);
+  State->Seeded = TRUE;
+  return TRUE;
+}
+
+/**
+  Generates a 64-bit random number.
+
+  if Rand is NULL, then ASSERT().
+
+  @param[out] Rand     Buffer pointer to store the 64-bit random value.
+
+  @retval TRUE         Random number generated successfully.
+  @retval FALSE        Failed to generate the random number.
+
+**/
+BOOLEAN
+EFIAPI
+GetRandomNumber64 (
+  OUT     UINT64                    *Rand
+  )
+{
+  RNG_DRBG_STATE  *State;
+
+  State = &mRngDrbgState;
+#if defined(RNG_DRBG_THREADS)
+  if (State->Seeded && (State->ForkGeneration != mRngDrbgForkGeneration)) {
+    State->Seeded = FALSE;
+  }
+#endif
+  if (!State->Seeded || (State->Generated >= RNG_DRBG_RESEED_INTERVAL)) {
+    if (!InternalRngDrbgSeed (State)) {
+      return FALSE;
+    }
+  }
+  if (State->Offset + sizeof(UINT64) > RNG_DRBG_BUFFER_SIZE) {
+    InternalRngDrbgRefill (State);
+  }
+
+  memcpy (Rand, State->Buffer + State->Offset, sizeof(UINT64));
+  memset (State->Buffer + State->Offset, 0, sizeof(UINT64));
+  State->Offset += sizeof(UINT64);
+
+  return TRUE;
+}
@@ -65,6 +65,32 @@ SpdmRequesterDataSignFunc (
   return FALSE;
 }
 
+/**
+  Sign the hash of an SPDM message data.
+
+  @param  ReqBaseAsymAlg               Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmRequesterDataSignHashFunc (
+  IN      UINT16       ReqBaseAsymAlg,
+  IN      UINT32       BaseHashAlgo,
+  IN      CONST UINT8  *MessageHash,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  return FALSE;
+}
+
 /**
   Sign an SPDM message data.
 
@@ -93,6 +119,248 @@ SpdmResponderDataSignFunc (
   return FALSE;
 }
 
+/**
+  Sign the hash of an SPDM message data.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmResponderDataSignHashFunc (
+  IN      UINT32       BaseAsymAlgo,
+  IN      UINT32       BaseHashAlgo,
+  IN      CONST UINT8  *MessageHash,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  return FALSE;
+}
+
+/**
+  Sign several hashes of SPDM message data in one transaction with the device.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  Request                      Array of RequestCount requests. On input, SigSize is the size in bytes of
+                                       the Signature buffer. On output, it is the size in bytes of the signature.
+  @param  RequestCount                 Number of requests.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmResponderDataSignHashMultiFunc (
+  IN      UINT32                  BaseAsymAlgo,
+  IN      UINT32                  BaseHashAlgo,
+  IN OUT  SPDM_SIGN_HASH_REQUEST  *Request,
+  IN      UINTN                   RequestCount
+  )
+{
+  return FALSE;
+}
+
+/**
+  Load the requester private key once for repeated signing.
+
+  The returned handle is passed to SpdmRequesterDataSignWithKeyFunc and
+  must be released with SpdmRequesterDataReleaseKeyFunc.
+
+  @param  ReqBaseAsymAlg               Indicates the signing algorithm.
+  @param  KeyHandle                    Pointer to receive the parsed private key handle.
+
+  @retval TRUE  the private key is loaded.
+  @retval FALSE the private key cannot be loaded.
+**/
+BOOLEAN
+EFIAPI
+SpdmRequesterDataLoadKeyFunc (
+  IN      UINT16       ReqBaseAsymAlg,
+     OUT  VOID         **KeyHandle
+  )
+{
+  return FALSE;
+}
+
+/**
+  Sign an SPDM message data with a private key loaded by SpdmRequesterDataLoadKeyFunc.
+
+  @param  ReqBaseAsymAlg               Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  KeyHandle                    The private key handle.
+  @param  Message                      A pointer to a message to be signed (before hash).
+  @param  MessageSize                  The size in bytes of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmRequesterDataSignWithKeyFunc (
+  IN      UINT16       ReqBaseAsymAlg,
+  IN      UINT32       BaseHashAlgo,
+  IN      VOID         *KeyHandle,
+  IN      CONST UINT8  *Message,
+  IN      UINTN        MessageSize,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  return FALSE;
+}
+
+/**
+  Sign the hash of an SPDM message data with a private key loaded by SpdmRequesterDataLoadKeyFunc.
+
+  @param  ReqBaseAsymAlg               Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  KeyHandle                    The private key handle.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmRequesterDataSignHashWithKeyFunc (
+  IN      UINT16       ReqBaseAsymAlg,
+  IN      UINT32       BaseHashAlgo,
+  IN      VOID         *KeyHandle,
+  IN      CONST UINT8  *MessageHash,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  return FALSE;
+}
+
+/**
+  Release a private key loaded by SpdmRequesterDataLoadKeyFunc.
+
+  @param  ReqBaseAsymAlg               Indicates the signing algorithm.
+  @param  KeyHandle                    The private key handle.
+**/
+VOID
+EFIAPI
+SpdmRequesterDataReleaseKeyFunc (
+  IN      UINT16       ReqBaseAsymAlg,
+  IN      VOID         *KeyHandle
+  )
+{
+  return ;
+}
+
+/**
+  Load the responder private key once for repeated signing.
+
+  The returned handle is passed to SpdmResponderDataSignWithKeyFunc and
+  must be released with SpdmResponderDataReleaseKeyFunc.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  KeyHandle                    Pointer to receive the parsed private key handle.
+
+  @retval TRUE  the private key is loaded.
+  @retval FALSE the private key cannot be loaded.
+**/
+BOOLEAN
+EFIAPI
+SpdmResponderDataLoadKeyFunc (
+  IN      UINT32       BaseAsymAlgo,
+     OUT  VOID         **KeyHandle
+  )
+{
+  return FALSE;
+}
+
+/**
+  Sign an SPDM message data with a private key loaded by SpdmResponderDataLoadKeyFunc.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  KeyHandle                    The private key handle.
+  @param  Message                      A pointer to a message to be signed (before hash).
+  @param  MessageSize                  The size in bytes of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmResponderDataSignWithKeyFunc (
+  IN      UINT32       BaseAsymAlgo,
+  IN      UINT32       BaseHashAlgo,
+  IN      VOID         *KeyHandle,
+  IN      CONST UINT8  *Message,
+  IN      UINTN        MessageSize,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  return FALSE;
+}
+
+/**
+  Sign the hash of an SPDM message data with a private key loaded by SpdmResponderDataLoadKeyFunc.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  KeyHandle                    The private key handle.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmResponderDataSignHashWithKeyFunc (
+  IN      UINT32       BaseAsymAlgo,
+  IN      UINT32       BaseHashAlgo,
+  IN      VOID         *KeyHandle,
+  IN      CONST UINT8  *MessageHash,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  return FALSE;
+}
+
+/**
+  Release a private key loaded by SpdmResponderDataLoadKeyFunc.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  KeyHandle                    The private key handle.
+**/
+VOID
+EFIAPI
+SpdmResponderDataReleaseKeyFunc (
+  IN      UINT32       BaseAsymAlgo,
+  IN      VOID         *KeyHandle
+  )
+{
+  return ;
+}
+
 /**
   Derive HMAC-based Expand Key Derivation Function (HKDF) Expand, based upon the negotiated HKDF algorithm.
 
@@ -122,6 +390,31 @@ SpdmPskHandshakeSecretHkdfExpandFunc (
   return FALSE;
 }
 
+/**
+  Derive several HMAC-based Expand Key Derivation Function (HKDF) Expand outputs, based upon the negotiated HKDF algorithm.
+
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  PskHint                      Pointer to the user-supplied PSK Hint.
+  @param  PskHintSize                  PSK Hint size in bytes.
+  @param  Label                        Array of LabelCount labels, each with its info and output buffer.
+  @param  LabelCount                   Number of labels.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmPskHandshakeSecretHkdfExpandMultiFunc (
+  IN      UINT32                        BaseHashAlgo,
+  IN      CONST UINT8                   *PskHint, OPTIONAL
+  IN      UINTN                         PskHintSize, OPTIONAL
+  IN      CONST SPDM_HKDF_EXPAND_LABEL  *Label,
+  IN      UINTN                         LabelCount
+  )
+{
+  return FALSE;
+}
+
 /**
   Derive HMAC-based Expand Key Derivation Function (HKDF) Expand, based upon the negotiated HKDF algorithm.
 
@@ -151,3 +444,28 @@ SpdmPskMasterSecretHkdfExpandFunc (
   return FALSE;
 }
 
+/**
+  Derive several HMAC-based Expand Key Derivation Function (HKDF) Expand outputs, based upon the negotiated HKDF algorithm.
+
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  PskHint                      Pointer to the user-supplied PSK Hint.
+  @param  PskHintSize                  PSK Hint size in bytes.
+  @param  Label                        Array of LabelCount labels, each with its info and output buffer.
+  @param  LabelCount                   Number of labels.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmPskMasterSecretHkdfExpandMultiFunc (
+  IN      UINT32                        BaseHashAlgo,
+  IN      CONST UINT8                   *PskHint, OPTIONAL
+  IN      UINTN                         PskHintSize, OPTIONAL
+  IN      CONST SPDM_HKDF_EXPAND_LABEL  *Label,
+  IN      UINTN                         LabelCount
+  )
+{
+  return FALSE;
+}
+
@@ -0,0 +1,382 @@
+/** @file
+  SPDM measurement hash library.
+  It helps a SPDM_MEASUREMENT_COLLECTION_FUNC to hash large measurement regions on a worker pool.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// The file regions are mapped with mmap on POSIX systems, so that the pages are read by the thread
+// which hashes them, and read into an allocated buffer with MSVC.
+//
+// The regions are hashed by a pool of threads, each of which takes the next largest region not
+// started yet. A region is never split across threads: a tree or segmented hash of a region is not
+// the digest of the region, and the verifier compares the digest with the reference value of the
+// region. The model checking and symbolic execution builds hash the regions in the calling thread.
+//
+#if !defined(_MSC_VER) && !defined(CBMC) && !defined(CBMC_CC) && !defined(TEST_WITH_KLEE)
+#define SPDM_MEASUREMENT_HASH_THREADS
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <Library/SpdmMeasurementHashLib.h>
+
+#define SPDM_MEASUREMENT_HASH_MAX_REGION_COUNT  0xFE
+#define SPDM_MEASUREMENT_HASH_MAX_RAW_SIZE      (0xFFFF - sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER))
+
+///
+/// A region in memory, and the value of its measurement block.
+///
+typedef struct {
+  CONST UINT8  *Data;
+  UINTN        Size;
+  // Data is mapped from a file, or allocated to read a file.
+  BOOLEAN      FromFile;
+  UINT8        *Value;
+} SPDM_MEASUREMENT_HASH_JOB;
+
+typedef struct {
+  UINT32                     MeasurementHashAlgo;
+  SPDM_MEASUREMENT_HASH_JOB  *Job;
+  UINTN                      *Order;
+  UINTN                      JobCount;
+  volatile UINTN             Next;
+  volatile BOOLEAN           Failed;
+} SPDM_MEASUREMENT_HASH_POOL;
+
+/**
+  Map a file region into memory.
+
+  @param  FileName                     The name of the file.
+  @param  Job                          The job to receive the data and the size of the file.
+
+  @retval TRUE  the file is mapped.
+  @retval FALSE the file cannot be read.
+**/
+BOOLEAN
+InternalMeasurementHashMapFile (
+  IN     CONST CHAR8                *FileName,
+  IN OUT SPDM_MEASUREMENT_HASH_JOB  *Job
+  )
+{
+#if defined(SPDM_MEASUREMENT_HASH_THREADS)
+  int          Fd;
+  struct stat  Stat;
+  VOID         *Data;
+
+  Fd = open (FileName, O_RDONLY);
+  if (Fd < 0) {
+    return FALSE;
+  }
+  if ((fstat (Fd, &Stat) != 0) || (Stat.st_size < 0)) {
+    close (Fd);
+    return FALSE;
+  }
+  Job->Size = (UINTN)Stat.st_size;
+  if (Job->Size == 0) {
+    close (Fd);
+    return TRUE;
+  }
+  Data = mmap (NULL, Job->Size, PROT_READ, MAP_PRIVATE, Fd, 0);
+  close (Fd);
+  if (Data == MAP_FAILED) {
+    return FALSE;
+  }
+  madvise (Data, Job->Size, MADV_SEQUENTIAL);
+  Job->Data = Data;
+  Job->FromFile = TRUE;
+  return TRUE;
+#else
+  FILE   *File;
+  long   Size;
+  UINT8  *Data;
+
+  File = fopen (FileName, "rb");
+  if (File == NULL) {
+    return FALSE;
+  }
+  if ((fseek (File, 0, SEEK_END) != 0) || ((Size = ftell (File)) < 0) || (fseek (File, 0, SEEK_SET) != 0)) {
+    fclose (File);
+    return FALSE;
+  }
+  Job->Size = (UINTN)Size;
+  if (Job->Size == 0) {
+    fclose (File);
+    return TRUE;
+  }
+  Data = malloc (Job->Size);
+  if (Data == NULL) {
+    fclose (File);
+    return FALSE;
+  }
+  if (fread (Data, 1, Job->Size, File) != Job->Size) {
+    free (Data);
+    fclose (File);
+    return FALSE;
+  }
+  fclose (File);
+  Job->Data = Data;
+  Job->FromFile = TRUE;
+  return TRUE;
+#endif
+}
+
+/**
+  Release a file region mapped by InternalMeasurementHashMapFile.
+
+  @param  Job                          The job of the region.
+**/
+VOID
+InternalMeasurementHashUnmapFile (
+  IN SPDM_MEASUREMENT_HASH_JOB  *Job
+  )
+{
+  if (!Job->FromFile) {
+    return ;
+  }
+#if defined(SPDM_MEASUREMENT_HASH_THREADS)
+  munmap ((VOID *)Job->Data, Job->Size);
+#else
+  free ((VOID *)Job->Data);
+#endif
+}
+
+/**
+  Hash the regions of the pool, the largest first, until all are started.
+
+  @param  Context                      The SPDM_MEASUREMENT_HASH_POOL.
+
+  @return NULL.
+**/
+VOID *
+InternalMeasurementHashWorker (
+  IN VOID  *Context
+  )
+{
+  SPDM_MEASUREMENT_HASH_POOL  *Pool;
+  SPDM_MEASUREMENT_HASH_JOB   *Job;
+  UINTN                       Index;
+
+  Pool = Context;
+  while (TRUE) {
+#if defined(SPDM_MEASUREMENT_HASH_THREADS)
+    Index = __atomic_fetch_add (&Pool->Next, 1, __ATOMIC_RELAXED);
+#else
+    Index = Pool->Next++;
+#endif
+    if (Index >= Pool->JobCount) {
+      break;
+    }
+    Job = &Pool->Job[Pool->Order[Index]];
+    if (!SpdmMeasurementHashAll (Pool->MeasurementHashAlgo, Job->Data, Job->Size, Job->Value)) {
+      Pool->Failed = TRUE;
+    }
+  }
+  return NULL;
+}
+
+/**
+  Hash the regions of the pool with up to ThreadCount threads, including the calling thread.
+
+  @param  Pool                         The pool of regions.
+  @param  ThreadCount                  The maximum number of threads.
+**/
+VOID
+InternalMeasurementHashRun (
+  IN SPDM_MEASUREMENT_HASH_POOL  *Pool,
+  IN UINTN                       ThreadCount
+  )
+{
+#if defined(SPDM_MEASUREMENT_HASH_THREADS)
+  pthread_t  *Thread;
+  UINTN      Created;
+  UINTN      Index;
+
+  if (ThreadCount > Pool->JobCount) {
+    ThreadCount = Pool->JobCount;
+  }
+  Thread = NULL;
+  Created = 0;
+  if (ThreadCount > 1) {
+    Thread = malloc (sizeof(pthread_t) * (ThreadCount - 1));
+  }
+  if (Thread != NULL) {
+    //
+    // If a thread cannot be created, the regions are hashed by the threads already created.
+    //
+    for (Created = 0; Created < ThreadCount - 1; Created++) {
+      if (pthread_create (&Thread[Created], NULL, InternalMeasurementHashWorker, Pool) != 0) {
+        break;
+      }
+    }
+  }
+  InternalMeasurementHashWorker (Pool);
+  for (Index = 0; Index < Created; Index++) {
+    pthread_join (Thread[Index], NULL);
+  }
+  free (Thread);
+#else
+  InternalMeasurementHashWorker (Pool);
+#endif
+}
+
+/**
+  Collect the DMTF measurement blocks of the measurement regions.
+
+  The block of Region[Index] has the measurement index Index + 1. Its value is the digest of the region
+  with MeasurementHashAlgo, or the raw bit stream of the region for RAW_BIT_STREAM_ONLY.
+  The regions are hashed in parallel by up to ThreadCount threads, including the calling thread.
+  The largest regions are hashed first, so that a large region does not start last. Each region
+  is hashed by one thread as one message, because the digest must match the reference value of
+  the region.
+
+  The function can be called by a SPDM_MEASUREMENT_COLLECTION_FUNC. It is thread safe, as long as
+  the crypto library is.
+
+  @param  MeasurementSpecification     Indicates the measurement specification.
+                                       It must be SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF.
+  @param  MeasurementHashAlgo          Indicates the measurement hash algorithm.
+                                       It must align with MeasurementHashAlgo (SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_*)
+  @param  RegionCount                  The count of the measurement regions, from 1 to 0xFE.
+  @param  Region                       The measurement regions.
+  @param  ThreadCount                  The maximum number of threads. 0 or 1 hashes the regions in the calling thread.
+  @param  DeviceMeasurementCount       The count of the device measurement block.
+  @param  DeviceMeasurement            A pointer to a destination buffer to store the concatenation of all device measurement blocks.
+  @param  DeviceMeasurementSize        On input, indicates the size in bytes of the destination buffer.
+                                       On output, indicates the size in bytes of all device measurement blocks in the buffer,
+                                       or the size in bytes required if the buffer is too small.
+
+  @retval TRUE  the device measurement collection success and measurement is returned.
+  @retval FALSE the device measurement collection fail, a region cannot be read, a raw bit stream region
+                is larger than 0xFFFF bytes, or the destination buffer is too small.
+**/
+BOOLEAN
+EFIAPI
+SpdmMeasurementHashRegions (
+  IN      UINT8                          MeasurementSpecification,
+  IN      UINT32                         MeasurementHashAlgo,
+  IN      UINTN                          RegionCount,
+  IN      CONST SPDM_MEASUREMENT_REGION  *Region,
+  IN      UINTN                          ThreadCount,
+     OUT  UINT8                          *DeviceMeasurementCount,
+     OUT  VOID                           *DeviceMeasurement,
+  IN OUT  UINTN                          *DeviceMeasurementSize
+  )
+{
+  SPDM_MEASUREMENT_HASH_POOL   Pool;
+  SPDM_MEASUREMENT_HASH_JOB    *Job;
+  SPDM_MEASUREMENT_BLOCK_DMTF  *MeasurementBlock;
+  UINT32                       HashSize;
+  BOOLEAN                      RawBitStream;
+  UINTN                        ValueSize;
+  UINTN                        TotalSize;
+  UINTN                        Index;
+  UINTN                        OrderIndex;
+  BOOLEAN                      Result;
+
+  if ((MeasurementSpecification != SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF) ||
+      (RegionCount == 0) || (RegionCount > SPDM_MEASUREMENT_HASH_MAX_REGION_COUNT) ||
+      (Region == NULL) || (DeviceMeasurementCount == NULL) || (DeviceMeasurementSize == NULL)) {
+    return FALSE;
+  }
+  HashSize = GetSpdmMeasurementHashSize (MeasurementHashAlgo);
+  if (HashSize == 0) {
+    return FALSE;
+  }
+  RawBitStream = (BOOLEAN)(HashSize == 0xFFFFFFFF);
+
+  ZeroMem (&Pool, sizeof(Pool));
+  Pool.MeasurementHashAlgo = MeasurementHashAlgo;
+  Pool.Job = calloc (RegionCount, sizeof(SPDM_MEASUREMENT_HASH_JOB));
+  Pool.Order = calloc (RegionCount, sizeof(UINTN));
+  Result = (BOOLEAN)((Pool.Job != NULL) && (Pool.Order != NULL));
+
+  //
+  // Map the regions and compute the size of the blocks.
+  //
+  TotalSize = 0;
+  for (Index = 0; Result && (Index < RegionCount); Index++) {
+    Job = &Pool.Job[Index];
+    if (Region[Index].Buffer != NULL) {
+      Job->Data = Region[Index].Buffer;
+      Job->Size = Region[Index].Size;
+    } else if ((Region[Index].FileName == NULL) ||
+               !InternalMeasurementHashMapFile (Region[Index].FileName, Job)) {
+      Result = FALSE;
+      break;
+    }
+    if (RawBitStream) {
+      if (Job->Size > SPDM_MEASUREMENT_HASH_MAX_RAW_SIZE) {
+        Result = FALSE;
+        break;
+      }
+      ValueSize = Job->Size;
+    } else {
+      ValueSize = HashSize;
+    }
+    TotalSize += sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + ValueSize;
+  }
+  if (Result && ((DeviceMeasurement == NULL) || (*DeviceMeasurementSize < TotalSize))) {
+    *DeviceMeasurementSize = TotalSize;
+    Result = FALSE;
+  }
+
+  if (Result) {
+    MeasurementBlock = DeviceMeasurement;
+    for (Index = 0; Index < RegionCount; Index++) {
+      Job = &Pool.Job[Index];
+      ValueSize = RawBitStream ? Job->Size : HashSize;
+      MeasurementBlock->MeasurementBlockCommonHeader.Index = (UINT8)(Index + 1);
+      MeasurementBlock->MeasurementBlockCommonHeader.MeasurementSpecification = SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF;
+      MeasurementBlock->MeasurementBlockCommonHeader.MeasurementSize = (UINT16)(sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER) + ValueSize);
+      MeasurementBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueType = Region[Index].ValueType;
+      MeasurementBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueSize = (UINT16)ValueSize;
+      Job->Value = (VOID *)(MeasurementBlock + 1);
+      if (RawBitStream) {
+        MeasurementBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueType |= SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_RAW_BIT_STREAM;
+        CopyMem (Job->Value, Job->Data, Job->Size);
+      } else {
+        //
+        // Insert the region into the order, the largest first.
+        //
+        for (OrderIndex = Pool.JobCount; OrderIndex > 0; OrderIndex--) {
+          if (Pool.Job[Pool.Order[OrderIndex - 1]].Size >= Job->Size) {
+            break;
+          }
+          Pool.Order[OrderIndex] = Pool.Order[OrderIndex - 1];
+        }
+        Pool.Order[OrderIndex] = Index;
+        Pool.JobCount++;
+      }
+      MeasurementBlock = (VOID *)((UINT8 *)(MeasurementBlock + 1) + ValueSize);
+    }
+
+    InternalMeasurementHashRun (&Pool, ThreadCount);
+    Result = (BOOLEAN)!Pool.Failed;
+    if (Result) {
+      *DeviceMeasurementCount = (UINT8)RegionCount;
+      *DeviceMeasurementSize = TotalSize;
+    }
+  }
+
+  if (Pool.Job != NULL) {
+    for (Index = 0; Index < RegionCount; Index++) {
+      InternalMeasurementHashUnmapFile (&Pool.Job[Index]);
+    }
+  }
+  free (Pool.Order);
+  free (Pool.Job);
+  return Result;
+}
@@ -0,0 +1,248 @@
+/** @file
+  Monotonic clock implementation of the Timer Library for the hosted platforms.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/TimerLib.h>
+
+//
+// The performance counter is CLOCK_MONOTONIC in nanoseconds on the POSIX systems, and
+// QueryPerformanceCounter with MSVC. Neither goes back when the wall clock is set.
+// The delays sleep, then spin the part shorter than the resolution of the sleep.
+//
+#if defined(_MSC_VER)
+
+__declspec(dllimport) int __stdcall QueryPerformanceCounter (long long *PerformanceCount);
+__declspec(dllimport) int __stdcall QueryPerformanceFrequency (long long *Frequency);
+__declspec(dllimport) void __stdcall Sleep (unsigned long Milliseconds);
+
+#else
+
+#include <time.h>
+
+#endif
+
+#define TIMER_NANOSECONDS_PER_SECOND  1000000000ull
+
+/**
+  Retrieves the current value of a 64-bit free running performance counter.
+
+  @return The current value of the free running performance counter.
+
+**/
+UINT64
+EFIAPI
+GetPerformanceCounter (
+  VOID
+  )
+{
+#if defined(_MSC_VER)
+  long long  Counter;
+
+  QueryPerformanceCounter (&Counter);
+  return (UINT64)Counter;
+#else
+  struct timespec  Time;
+
+  clock_gettime (CLOCK_MONOTONIC, &Time);
+  return (UINT64)Time.tv_sec * TIMER_NANOSECONDS_PER_SECOND + (UINT64)Time.tv_nsec;
+#endif
+}
+
+/**
+  Retrieves the 64-bit frequency in Hz and the range of performance counter
+  values.
+
+  @param  StartValue            The value the performance counter starts with when it rolls over.
+  @param  EndValue              The value that the performance counter ends with before it rolls over.
+
+  @return The frequency in Hz.
+
+**/
+UINT64
+EFIAPI
+GetPerformanceCounterProperties (
+  OUT      UINT64                    *StartValue,  OPTIONAL
+  OUT      UINT64                    *EndValue     OPTIONAL
+  )
+{
+#if defined(_MSC_VER)
+  long long  Frequency;
+#endif
+
+  if (StartValue != NULL) {
+    *StartValue = 0;
+  }
+  if (EndValue != NULL) {
+    *EndValue = MAX_UINT64;
+  }
+#if defined(_MSC_VER)
+  QueryPerformanceFrequency (&Frequency);
+  return (UINT64)Frequency;
+#else
+  return TIMER_NANOSECONDS_PER_SECOND;
+#endif
+}
+
+/**
+  Converts elapsed ticks of the performance counter to time in nanoseconds.
+
+  @param  Ticks                 The number of elapsed ticks of the performance counter.
+
+  @return The elapsed time in nanoseconds.
+
+**/
+UINT64
+EFIAPI
+GetTimeInNanoSecond (
+  IN      UINT64                     Ticks
+  )
+{
+  UINT64  Frequency;
+
+  Frequency = GetPerformanceCounterProperties (NULL, NULL);
+  if (Frequency == TIMER_NANOSECONDS_PER_SECOND) {
+    return Ticks;
+  }
+  //
+  // The whole seconds and the rest are converted apart, so that the product does not overflow.
+  //
+  return (Ticks / Frequency) * TIMER_NANOSECONDS_PER_SECOND +
+         (Ticks % Frequency) * TIMER_NANOSECONDS_PER_SECOND / Frequency;
+}
+
+/**
+  Stalls the CPU for at least the given number of nanoseconds.
+
+  @param  NanoSeconds           The minimum number of nanoseconds to delay.
+
+  @return The value of NanoSeconds input.
+
+**/
+UINTN
+EFIAPI
+NanoSecondDelay (
+  IN      UINTN                     NanoSeconds
+  )
+{
+  UINT64           Deadline;
+  UINT64           Remaining;
+#if !defined(_MSC_VER)
+  struct timespec  Delay;
+#endif
+
+  if (NanoSeconds == 0) {
+    return NanoSeconds;
+  }
+  Deadline = GetDeadline (NanoSeconds);
+  while ((Remaining = GetDeadlineRemaining (Deadline)) != 0) {
+#if defined(_MSC_VER)
+    //
+    // Sleep() has a resolution of a millisecond, so the rest is spun.
+    //
+    if (Remaining >= 1000000) {
+      Sleep ((unsigned long)(Remaining / 1000000));
+    }
+#else
+    Delay.tv_sec = (time_t)(Remaining / TIMER_NANOSECONDS_PER_SECOND);
+    Delay.tv_nsec = (long)(Remaining % TIMER_NANOSECONDS_PER_SECOND);
+    nanosleep (&Delay, NULL);
+#endif
+  }
+  return NanoSeconds;
+}
+
+/**
+  Stalls the CPU for at least the given number of microseconds.
+
+  @param  MicroSeconds          The minimum number of microseconds to delay.
+
+  @return The value of MicroSeconds input.
+
+**/
+UINTN
+EFIAPI
+MicroSecondDelay (
+  IN      UINTN                     MicroSeconds
+  )
+{
+  UINT64  Deadline;
+  UINT64  Remaining;
+
+  Deadline = GetDeadline ((UINT64)MicroSeconds * 1000);
+  while ((Remaining = GetDeadlineRemaining (Deadline)) != 0) {
+    NanoSecondDelay ((UINTN)MIN (Remaining, MAX_UINT32));
+  }
+  return MicroSeconds;
+}
+
+/**
+  Returns the deadline a timeout from now.
+
+  @param  Timeout               The timeout, in nanoseconds. 0 means no deadline.
+
+  @return The deadline, in nanoseconds of the performance counter, or MAX_UINT64 for no deadline.
+
+**/
+UINT64
+EFIAPI
+GetDeadline (
+  IN      UINT64                     Timeout
+  )
+{
+  UINT64  Now;
+
+  if (Timeout == 0) {
+    return MAX_UINT64;
+  }
+  Now = GetTimeInNanoSecond (GetPerformanceCounter ());
+  if (Timeout >= MAX_UINT64 - Now) {
+    return MAX_UINT64;
+  }
+  return Now + Timeout;
+}
+
+/**
+  Returns the time left until a deadline.
+
+  @param  Deadline              The deadline, from GetDeadline.
+
+  @return The time left, in nanoseconds, 0 if the deadline has passed, or MAX_UINT64 for no deadline.
+
+**/
+UINT64
+EFIAPI
+GetDeadlineRemaining (
+  IN      UINT64                     Deadline
+  )
+{
+  UINT64  Now;
+
+  if (Deadline == MAX_UINT64) {
+    return MAX_UINT64;
+  }
+  Now = GetTimeInNanoSecond (GetPerformanceCounter ());
+  return (Now >= Deadline) ? 0 : (Deadline - Now);
+}
+
+/**
+  Checks if a deadline has passed.
+
+  @param  Deadline              The deadline, from GetDeadline.
+
+  @retval TRUE   the deadline has passed.
+  @retval FALSE  the deadline has not passed, or there is no deadline.
+
+**/
+BOOLEAN
+EFIAPI
+IsDeadlineExpired (
+  IN      UINT64                     Deadline
+  )
+{
+  return (BOOLEAN)(GetDeadlineRemaining (Deadline) == 0);
+}
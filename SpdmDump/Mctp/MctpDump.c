@@ -21,6 +21,8 @@ DISPATCH_TABLE_ENTRY mMctpDispatch[] = {
   {MCTP_MESSAGE_TYPE_VENDOR_DEFINED_IANA,  "VendorDefinedIana",  NULL},
 };
 
+DISPATCH_TABLE mMctpDispatchTable = DISPATCH_TABLE_INIT (mMctpDispatch);
+
 VOID
 DumpMctpMessage (
   IN VOID    *Buffer,
@@ -42,7 +44,7 @@ DumpMctpMessage (
   if (mParamDumpVendorApp ||
       (MctpMessageHeader->MessageType == MCTP_MESSAGE_TYPE_SPDM) ||
       (MctpMessageHeader->MessageType == MCTP_MESSAGE_TYPE_SECURED_MCTP)) {
-    DumpDispatchMessage (mMctpDispatch, ARRAY_SIZE(mMctpDispatch), MctpMessageHeader->MessageType, (UINT8 *)Buffer + HeaderSize, BufferSize - HeaderSize);
+    DumpDispatchMessage (&mMctpDispatchTable, MctpMessageHeader->MessageType, (UINT8 *)Buffer + HeaderSize, BufferSize - HeaderSize);
 
     if (mParamDumpHex &&
         (MctpMessageHeader->MessageType != MCTP_MESSAGE_TYPE_SPDM) &&
@@ -56,6 +56,8 @@ DISPATCH_TABLE_ENTRY mPldmControlDispatch[] = {
   {PLDM_CONTROL_DISCOVERY_COMMAND_GET_PLDM_COMMANDS, "GetPLDMCommands", NULL},
 };
 
+DISPATCH_TABLE mPldmControlDispatchTable = DISPATCH_TABLE_INIT (mPldmControlDispatch);
+
 VOID
 DumpPldmControl (
   IN VOID    *Buffer,
@@ -68,7 +70,7 @@ DumpPldmControl (
 
   PldmMessageHeader = Buffer;
 
-  DumpDispatchMessage (mPldmControlDispatch, ARRAY_SIZE(mPldmControlDispatch), PldmMessageHeader->PldmCommandCode, (UINT8 *)Buffer, BufferSize);
+  DumpDispatchMessage (&mPldmControlDispatchTable, PldmMessageHeader->PldmCommandCode, (UINT8 *)Buffer, BufferSize);
 }
 
 DISPATCH_TABLE_ENTRY mPldmDispatch[] = {
@@ -82,6 +84,8 @@ DISPATCH_TABLE_ENTRY mPldmDispatch[] = {
   {MCTP_MESSAGE_TYPE_OEM,                         "OEM",              NULL},
 };
 
+DISPATCH_TABLE mPldmDispatchTable = DISPATCH_TABLE_INIT (mPldmDispatch);
+
 VOID
 DumpPldmMessage (
   IN VOID    *Buffer,
@@ -131,5 +135,5 @@ DumpPldmMessage (
       );
   }
 
-  DumpDispatchMessage (mPldmDispatch, ARRAY_SIZE(mPldmDispatch), PldmMessageHeader->PldmType & 0x3F, (UINT8 *)Buffer, BufferSize);
+  DumpDispatchMessage (&mPldmDispatchTable, PldmMessageHeader->PldmType & 0x3F, (UINT8 *)Buffer, BufferSize);
 }
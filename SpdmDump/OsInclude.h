@@ -46,6 +46,8 @@ typedef UINT32 size_t ;
 #include "windows.h"
 #include "windowsx.h"
 #include <WS2tcpip.h>
+#include <io.h>
+#include <fcntl.h>
 
 #undef GUID
 #undef _LIST_ENTRY
@@ -73,11 +75,20 @@ typedef UINT32 size_t ;
 
 #else
 // GCC
+//
+// The captures may be larger than 2 GB, also on a 32-bit host.
+//
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
 #include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include <arpa/inet.h>
 typedef int SOCKET;
 #define closesocket(x) close(x)
@@ -15,6 +15,8 @@ DISPATCH_TABLE_ENTRY mPciDoeDispatch[] = {
   {PCI_DOE_DATA_OBJECT_TYPE_SECURED_SPDM,  "SecuredSPDM",   DumpSecuredSpdmMessage},
 };
 
+DISPATCH_TABLE mPciDoeDispatchTable = DISPATCH_TABLE_INIT (mPciDoeDispatch);
+
 VOID
 DumpPciDoePacket (
   IN VOID    *Buffer,
@@ -41,7 +43,7 @@ DumpPciDoePacket (
   if (mParamDumpVendorApp ||
       (PciDoeHeader->DataObjectType == PCI_DOE_DATA_OBJECT_TYPE_SPDM) ||
       (PciDoeHeader->DataObjectType == PCI_DOE_DATA_OBJECT_TYPE_SECURED_SPDM)) {
-    DumpDispatchMessage (mPciDoeDispatch, ARRAY_SIZE(mPciDoeDispatch), PciDoeHeader->DataObjectType, (UINT8 *)Buffer + HeaderSize, BufferSize - HeaderSize);
+    DumpDispatchMessage (&mPciDoeDispatchTable, PciDoeHeader->DataObjectType, (UINT8 *)Buffer + HeaderSize, BufferSize - HeaderSize);
 
     if (mParamDumpHex &&
         (PciDoeHeader->DataObjectType != PCI_DOE_DATA_OBJECT_TYPE_SPDM) &&
@@ -123,6 +123,8 @@ DISPATCH_TABLE_ENTRY mPciIdeKmDispatch[] = {
   {PCI_IDE_KM_OBJECT_ID_K_SET_GOSTOP_ACK,  "K_SET_GOSTOP_ACK",  DumpPciIdeKmKeySetGoStopAck},
 };
 
+DISPATCH_TABLE mPciIdeKmDispatchTable = DISPATCH_TABLE_INIT (mPciIdeKmDispatch);
+
 VOID
 DumpPciIdeKmMessage (
   IN VOID    *Buffer,
@@ -139,5 +141,5 @@ DumpPciIdeKmMessage (
 
   printf ("IDE_KM(0x%02x) ", PciIdeKmHeader->ObjectId);
 
-  DumpDispatchMessage (mPciIdeKmDispatch, ARRAY_SIZE(mPciIdeKmDispatch), PciIdeKmHeader->ObjectId, (UINT8 *)Buffer, BufferSize);
+  DumpDispatchMessage (&mPciIdeKmDispatchTable, PciIdeKmHeader->ObjectId, (UINT8 *)Buffer, BufferSize);
 }
@@ -13,6 +13,8 @@ DISPATCH_TABLE_ENTRY mSpdmPciProtocolDispatch[] = {
   {PCI_PROTOCAL_ID_IDE_KM,    "IDE_KM",    DumpPciIdeKmMessage},
 };
 
+DISPATCH_TABLE mSpdmPciProtocolDispatchTable = DISPATCH_TABLE_INIT (mSpdmPciProtocolDispatch);
+
 #pragma pack(1)
 
 typedef struct {
@@ -68,7 +70,7 @@ DumpSpdmVendorPci (
   }
 
   DumpDispatchMessage (
-    mSpdmPciProtocolDispatch, ARRAY_SIZE(mSpdmPciProtocolDispatch),
+    &mSpdmPciProtocolDispatchTable,
     VendorDefinedPciHeader->PciProtocol.ProtocolId,
     (UINT8 *)Buffer + sizeof(SPDM_VENDOR_DEFINED_PCI_HEADER),
     VendorDefinedPciHeader->PayloadLength - sizeof(PCI_PROTOCOL_HEADER)
@@ -81,6 +81,8 @@ DISPATCH_TABLE_ENTRY mSpdmOpaqueDispatch[] = {
   {SECURED_MESSAGE_OPAQUE_ELEMENT_SMDATA_ID_SUPPORTED_VERSION,  "SUPPORTED_VERSION",  DumpSpdmOpaqueSupportedVersion},
 };
 
+DISPATCH_TABLE mSpdmOpaqueDispatchTable = DISPATCH_TABLE_INIT (mSpdmOpaqueDispatch);
+
 VOID
 DumpSpdmOpaqueData (
   IN UINT8    *OpaqueData,
@@ -141,7 +143,7 @@ DumpSpdmOpaqueData (
     SecuredMessageElement = (VOID *)(SecuredMessageElementTable + 1);
     printf ("Element(Ver=0x%02x, Id=0x%02x) ", SecuredMessageElement->SMDataVersion, SecuredMessageElement->SMDataID);
 
-    DumpDispatchMessage (mSpdmOpaqueDispatch, ARRAY_SIZE(mSpdmOpaqueDispatch), SecuredMessageElement->SMDataID, (UINT8 *)SecuredMessageElement, SecuredMessageElementTable->OpaqueElementDataLen);
+    DumpDispatchMessage (&mSpdmOpaqueDispatchTable, SecuredMessageElement->SMDataID, (UINT8 *)SecuredMessageElement, SecuredMessageElementTable->OpaqueElementDataLen);
 
     SecuredMessageElementTable = (VOID *)EndOfElementTable;
   }
@@ -152,6 +154,8 @@ DISPATCH_TABLE_ENTRY mSecuredSpdmDispatch[] = {
   {LINKTYPE_PCI_DOE, "", DumpSpdmMessage},
 };
 
+DISPATCH_TABLE mSecuredSpdmDispatchTable = DISPATCH_TABLE_INIT (mSecuredSpdmDispatch);
+
 VOID
 DumpSecuredSpdmMessage (
   IN VOID    *Buffer,
@@ -194,9 +198,18 @@ DumpSecuredSpdmMessage (
     return ;
   }
 
+  RecordHeader1 = Buffer;
+  if (!mDumpPacketOwned) {
+    //
+    // Another worker decrypts this session. Only track the current session, for the ERROR in the clear.
+    //
+    mCurrentSessionInfo = SpdmGetSessionInfoViaSessionId (mSpdmContext, RecordHeader1->SessionId);
+    mCurrentSessionId = RecordHeader1->SessionId;
+    return ;
+  }
+
   IsRequester = (BOOLEAN)(!IsRequester);
 
-  RecordHeader1 = Buffer;
   SequenceNum = 0;
   if (DataLinkType == LINKTYPE_MCTP) {
     SequenceNum = *(UINT16 *)(RecordHeader1 + 1);
@@ -205,6 +218,7 @@ DumpSecuredSpdmMessage (
   mCurrentSessionInfo = SpdmGetSessionInfoViaSessionId (mSpdmContext, RecordHeader1->SessionId);
   mCurrentSessionId = RecordHeader1->SessionId;
   Status = RETURN_UNSUPPORTED;
+  MessageSize = 0;
   if (mCurrentSessionInfo != NULL) {
     SecuredMessageContext = SpdmGetSecuredMessageContextViaSessionId (mSpdmContext, RecordHeader1->SessionId);
     if (SecuredMessageContext != NULL) {
@@ -240,6 +254,10 @@ DumpSecuredSpdmMessage (
     }
   }
 
+  if (!SpdmDumpFilterDecryptedMessage (RETURN_ERROR(Status) ? NULL : mSpdmDecMessageBuffer, MessageSize)) {
+    return ;
+  }
+
   if (!RETURN_ERROR(Status)) {
     if (IsRequester) {
       printf ("REQ->RSP ");
@@ -253,7 +271,7 @@ DumpSecuredSpdmMessage (
     printf (") ");
 
     mDecrypted = TRUE;
-    DumpDispatchMessage (mSecuredSpdmDispatch, ARRAY_SIZE(mSecuredSpdmDispatch), GetDataLinkType(), mSpdmDecMessageBuffer, MessageSize);
+    DumpDispatchMessage (&mSecuredSpdmDispatchTable, GetDataLinkType(), mSpdmDecMessageBuffer, MessageSize);
     mDecrypted = FALSE;
   } else {
     printf ("(?)->(?) ");
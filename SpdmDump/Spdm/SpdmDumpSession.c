@@ -63,9 +63,15 @@ SpdmDumpSessionDataProvision (
 
   if (!UsePsk) {
     if (mDheSecretBuffer == NULL || mDheSecretBufferSize == 0) {
-      return RETURN_UNSUPPORTED;
+      //
+      // The secrets may be imported from the key cache.
+      //
+      if (mParamKeyCacheFileName == NULL) {
+        return RETURN_UNSUPPORTED;
+      }
+    } else {
+      SpdmSecuredMessageImportDheSecret (SecuredMessageContext, mDheSecretBuffer, mDheSecretBufferSize);
     }
-    SpdmSecuredMessageImportDheSecret (SecuredMessageContext, mDheSecretBuffer, mDheSecretBufferSize);
 
     if (IsRequester) {
       if (NeedMutAuth && MutAuthRequested) {
@@ -108,7 +114,10 @@ SpdmDumpSessionDataProvision (
     }
   } else {
     if (mPskBuffer == NULL || mPskBufferSize == 0) {
-      return RETURN_UNSUPPORTED;
+      if (mParamKeyCacheFileName == NULL) {
+        return RETURN_UNSUPPORTED;
+      }
+      return RETURN_SUCCESS;
     }
     if (mPskBufferSize > MAX_DHE_KEY_SIZE) {
       printf ("BUGBUG: PSK size is too large. It will be supported later.\n");
@@ -148,7 +157,7 @@ SpdmDumpSessionDataCheck (
   SpdmGetData (SpdmContext, SpdmDataSessionMutAuthRequested, &Parameter, &MutAuthRequested, &DataSize);
 
   if (!UsePsk) {
-    if (mDheSecretBuffer == NULL || mDheSecretBufferSize == 0) {
+    if ((mDheSecretBuffer == NULL || mDheSecretBufferSize == 0) && (mParamKeyCacheFileName == NULL)) {
       return RETURN_UNSUPPORTED;
     }
     if (IsRequester) {
@@ -171,10 +180,44 @@ SpdmDumpSessionDataCheck (
       }
     }
   } else {
-    if (mPskBuffer == NULL || mPskBufferSize == 0) {
+    if ((mPskBuffer == NULL || mPskBufferSize == 0) && (mParamKeyCacheFileName == NULL)) {
       return RETURN_UNSUPPORTED;
     }
   }
 
   return RETURN_SUCCESS;
 }
+
+/**
+  Check if the DHE secret or the PSK of a session is provided, to run the key schedule
+  for the secrets which are not in the key cache.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    The SessionId of the session.
+
+  @retval TRUE   The secret of the session is provided.
+  @retval FALSE  The secret of the session is not provided.
+**/
+BOOLEAN
+SpdmDumpSessionSecretAvailable (
+  IN VOID                         *SpdmContext,
+  IN UINT32                       SessionId
+  )
+{
+  SPDM_DATA_PARAMETER            Parameter;
+  BOOLEAN                        UsePsk;
+  UINTN                          DataSize;
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationSession;
+  *(UINT32 *)Parameter.AdditionalData = SessionId;
+  UsePsk = FALSE;
+  DataSize = sizeof(UsePsk);
+  SpdmGetData (SpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, &DataSize);
+
+  if (!UsePsk) {
+    return (BOOLEAN)(mDheSecretBuffer != NULL && mDheSecretBufferSize != 0);
+  } else {
+    return (BOOLEAN)(mPskBuffer != NULL && mPskBufferSize != 0);
+  }
+}
@@ -14,6 +14,11 @@ VOID               *mSpdmContext;
 
 VOID               *mSpdmLastMessageBuffer;
 UINTN              mSpdmLastMessageBufferSize;
+//
+// A copy of message A of the SPDM context, for the checkpoints.
+//
+UINT8              mSpdmMessageABuffer[MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+UINTN              mSpdmMessageABufferSize;
 UINT8              mCachedGetMeasurementRequestAttribute;
 UINT8              mCachedGetMeasurementOperation;
 UINT8              mCachedMeasurementSummaryHashType;
@@ -55,6 +60,8 @@ DISPATCH_TABLE_ENTRY mSpdmVendorDispatch[] = {
   {SPDM_REGISTRY_ID_JEDEC,   "JEDEC",   NULL},
 };
 
+DISPATCH_TABLE mSpdmVendorDispatchTable = DISPATCH_TABLE_INIT (mSpdmVendorDispatch);
+
 VALUE_STRING_ENTRY  mSpdmRequesterCapabilitiesStringTable[] = {
   {SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CERT_CAP,                   "CERT"},
   {SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CHAL_CAP,                   "CHAL"},
@@ -219,6 +226,27 @@ SpdmDumpGetMeasurementSummaryHashSize (
   return 0;
 }
 
+/**
+  Append a message to message A of the SPDM context, and to the copy of message A for the checkpoints.
+
+  @param  Message                      A pointer to the message.
+  @param  MessageSize                  The size in bytes of the message.
+**/
+VOID
+SpdmDumpAppendMessageA (
+  IN VOID    *Message,
+  IN UINTN   MessageSize
+  )
+{
+  if (RETURN_ERROR (SpdmAppendMessageA (mSpdmContext, Message, MessageSize))) {
+    return ;
+  }
+  if (MessageSize <= sizeof(mSpdmMessageABuffer) - mSpdmMessageABufferSize) {
+    CopyMem (mSpdmMessageABuffer + mSpdmMessageABufferSize, Message, MessageSize);
+    mSpdmMessageABufferSize += MessageSize;
+  }
+}
+
 VOID
 DumpSpdmGetVersion (
   IN VOID    *Buffer,
@@ -244,7 +272,8 @@ DumpSpdmGetVersion (
   SpdmResetMessageA (mSpdmContext);
   SpdmResetMessageB (mSpdmContext);
   SpdmResetMessageC (mSpdmContext);
-  SpdmAppendMessageA (mSpdmContext, Buffer, MessageSize);
+  mSpdmMessageABufferSize = 0;
+  SpdmDumpAppendMessageA (Buffer, MessageSize);
 }
 
 VOID
@@ -291,7 +320,7 @@ DumpSpdmVersion (
   }
   printf ("\n");
 
-  SpdmAppendMessageA (mSpdmContext, Buffer, MessageSize);
+  SpdmDumpAppendMessageA (Buffer, MessageSize);
 }
 
 VOID
@@ -346,7 +375,7 @@ DumpSpdmGetCapabilities (
     SpdmSetData (mSpdmContext, SpdmDataCapabilityFlags, &Parameter, &mSpdmRequesterCapabilitiesFlags, sizeof(UINT32));
   }
 
-  SpdmAppendMessageA (mSpdmContext, Buffer, MessageSize);
+  SpdmDumpAppendMessageA (Buffer, MessageSize);
 }
 
 VOID
@@ -387,7 +416,7 @@ DumpSpdmCapabilities (
   Parameter.Location = SpdmDataLocationConnection;
   SpdmSetData (mSpdmContext, SpdmDataCapabilityFlags, &Parameter, &mSpdmResponderCapabilitiesFlags, sizeof(UINT32));
 
-  SpdmAppendMessageA (mSpdmContext, Buffer, MessageSize);
+  SpdmDumpAppendMessageA (Buffer, MessageSize);
 }
 
 VOID
@@ -465,7 +494,7 @@ DumpSpdmNegotiateAlgorithms (
 
   printf ("\n");
 
-  SpdmAppendMessageA (mSpdmContext, Buffer, MessageSize);
+  SpdmDumpAppendMessageA (Buffer, MessageSize);
 }
 
 VOID
@@ -588,7 +617,7 @@ DumpSpdmAlgorithms (
   SpdmSetData (mSpdmContext, SpdmDataReqBaseAsymAlg, &Parameter, &mSpdmReqBaseAsymAlg, sizeof(UINT16));
   SpdmSetData (mSpdmContext, SpdmDataKeySchedule, &Parameter, &mSpdmKeySchedule, sizeof(UINT16));
 
-  SpdmAppendMessageA (mSpdmContext, Buffer, MessageSize);
+  SpdmDumpAppendMessageA (Buffer, MessageSize);
 }
 
 VOID
@@ -1247,7 +1276,7 @@ DumpSpdmVendorDefinedRequest (
   }
 
   if (mParamDumpVendorApp) {
-    DumpDispatchMessage (mSpdmVendorDispatch, ARRAY_SIZE(mSpdmVendorDispatch), SpdmRequest->StandardID, (UINT8 *)Buffer + HeaderSize, BufferSize - HeaderSize);
+    DumpDispatchMessage (&mSpdmVendorDispatchTable, SpdmRequest->StandardID, (UINT8 *)Buffer + HeaderSize, BufferSize - HeaderSize);
   } else {
     printf ("\n");
   }
@@ -1277,7 +1306,7 @@ DumpSpdmVendorDefinedResponse (
   }
 
   if (mParamDumpVendorApp) {
-    DumpDispatchMessage (mSpdmVendorDispatch, ARRAY_SIZE(mSpdmVendorDispatch), SpdmResponse->StandardID, (UINT8 *)Buffer + HeaderSize, BufferSize - HeaderSize);
+    DumpDispatchMessage (&mSpdmVendorDispatchTable, SpdmResponse->StandardID, (UINT8 *)Buffer + HeaderSize, BufferSize - HeaderSize);
   } else {
     printf ("\n");
   }
@@ -1457,6 +1486,7 @@ DumpSpdmKeyExchangeRsp (
     return ;
   }
   mCurrentSessionId = mCachedSessionId;
+  SpdmDumpCheckpointAddSession (mCurrentSessionId);
 
   MutAuthRequested = SpdmResponse->MutAuthRequested;
   ZeroMem (&Parameter, sizeof(Parameter));
@@ -1477,7 +1507,13 @@ DumpSpdmKeyExchangeRsp (
     return ;
   }
   SpdmCalculateTH1Hash (mSpdmContext, mCurrentSessionInfo, TRUE, TH1HashData);
-  SpdmGenerateSessionHandshakeKey (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TH1HashData);
+  if (!SpdmDumpKeyCacheImport (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), mCurrentSessionId, SPDM_DUMP_KEY_CACHE_STAGE_HANDSHAKE, TH1HashData)) {
+    if (!SpdmDumpSessionSecretAvailable (mSpdmContext, mCurrentSessionId)) {
+      return ;
+    }
+    SpdmGenerateSessionHandshakeKey (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TH1HashData);
+    SpdmDumpKeyCacheSave (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), mCurrentSessionId, SPDM_DUMP_KEY_CACHE_STAGE_HANDSHAKE, TH1HashData);
+  }
   if (IncludeHmac) {
     SpdmAppendMessageK (mCurrentSessionInfo, (UINT8 *)Buffer + MessageSize - HmacSize, HmacSize);
   }
@@ -1613,7 +1649,13 @@ DumpSpdmFinishRsp (
     return ;
   }
   SpdmCalculateTH2Hash (mSpdmContext, mCurrentSessionInfo, TRUE, TH2HashData);
-  SpdmGenerateSessionDataKey (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TH2HashData);
+  if (!SpdmDumpKeyCacheImport (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), mCurrentSessionId, SPDM_DUMP_KEY_CACHE_STAGE_DATA, TH2HashData)) {
+    if (!SpdmDumpSessionSecretAvailable (mSpdmContext, mCurrentSessionId)) {
+      return ;
+    }
+    SpdmGenerateSessionDataKey (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TH2HashData);
+    SpdmDumpKeyCacheSave (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), mCurrentSessionId, SPDM_DUMP_KEY_CACHE_STAGE_DATA, TH2HashData);
+  }
   SpdmSecuredMessageSetSessionState (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), SpdmSessionStateEstablished);
 }
 
@@ -1750,6 +1792,7 @@ DumpSpdmPskExchangeRsp (
     return ;
   }
   mCurrentSessionId = mCachedSessionId;
+  SpdmDumpCheckpointAddSession (mCurrentSessionId);
 
   SpdmAppendMessageK (mCurrentSessionInfo, mSpdmLastMessageBuffer, mSpdmLastMessageBufferSize);
   SpdmAppendMessageK (mCurrentSessionInfo, Buffer, MessageSize - HmacSize);
@@ -1759,31 +1802,10 @@ DumpSpdmPskExchangeRsp (
     return ;
   }
   SpdmCalculateTH1Hash (mSpdmContext, mCurrentSessionInfo, TRUE, TH1HashData);
-  SpdmSecuredMessageSetUsePsk (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), FALSE);
-
-  UsePsk = FALSE;
-  ZeroMem (&Parameter, sizeof(Parameter));
-  Parameter.Location = SpdmDataLocationSession;
-  *(UINT32 *)Parameter.AdditionalData = mCurrentSessionId;
-  SpdmSetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, sizeof(UsePsk));
-
-  SpdmGenerateSessionHandshakeKey (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TH1HashData);
-
-  UsePsk = TRUE;
-  ZeroMem (&Parameter, sizeof(Parameter));
-  Parameter.Location = SpdmDataLocationSession;
-  *(UINT32 *)Parameter.AdditionalData = mCurrentSessionId;
-  SpdmSetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, sizeof(UsePsk));
-
-  SpdmSecuredMessageSetUsePsk (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TRUE);
-  SpdmAppendMessageK (mCurrentSessionInfo, (UINT8 *)Buffer + MessageSize - HmacSize, HmacSize);
-
-  SpdmSecuredMessageSetSessionState (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), SpdmSessionStateHandshaking);
-
-  if ((mSpdmResponderCapabilitiesFlags & SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP_RESPONDER_WITH_CONTEXT) == 0) {
-    // No need to receive PSK_FINISH, enter application phase directly.
-
-    SpdmCalculateTH2Hash (mSpdmContext, mCurrentSessionInfo, TRUE, TH2HashData);
+  if (!SpdmDumpKeyCacheImport (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), mCurrentSessionId, SPDM_DUMP_KEY_CACHE_STAGE_HANDSHAKE, TH1HashData)) {
+    if (!SpdmDumpSessionSecretAvailable (mSpdmContext, mCurrentSessionId)) {
+      return ;
+    }
     SpdmSecuredMessageSetUsePsk (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), FALSE);
 
     UsePsk = FALSE;
@@ -1792,7 +1814,7 @@ DumpSpdmPskExchangeRsp (
     *(UINT32 *)Parameter.AdditionalData = mCurrentSessionId;
     SpdmSetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, sizeof(UsePsk));
 
-    SpdmGenerateSessionDataKey (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TH2HashData);
+    SpdmGenerateSessionHandshakeKey (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TH1HashData);
 
     UsePsk = TRUE;
     ZeroMem (&Parameter, sizeof(Parameter));
@@ -1801,6 +1823,39 @@ DumpSpdmPskExchangeRsp (
     SpdmSetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, sizeof(UsePsk));
 
     SpdmSecuredMessageSetUsePsk (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TRUE);
+    SpdmDumpKeyCacheSave (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), mCurrentSessionId, SPDM_DUMP_KEY_CACHE_STAGE_HANDSHAKE, TH1HashData);
+  }
+  SpdmAppendMessageK (mCurrentSessionInfo, (UINT8 *)Buffer + MessageSize - HmacSize, HmacSize);
+
+  SpdmSecuredMessageSetSessionState (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), SpdmSessionStateHandshaking);
+
+  if ((mSpdmResponderCapabilitiesFlags & SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP_RESPONDER_WITH_CONTEXT) == 0) {
+    // No need to receive PSK_FINISH, enter application phase directly.
+
+    SpdmCalculateTH2Hash (mSpdmContext, mCurrentSessionInfo, TRUE, TH2HashData);
+    if (!SpdmDumpKeyCacheImport (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), mCurrentSessionId, SPDM_DUMP_KEY_CACHE_STAGE_DATA, TH2HashData)) {
+      if (!SpdmDumpSessionSecretAvailable (mSpdmContext, mCurrentSessionId)) {
+        return ;
+      }
+      SpdmSecuredMessageSetUsePsk (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), FALSE);
+
+      UsePsk = FALSE;
+      ZeroMem (&Parameter, sizeof(Parameter));
+      Parameter.Location = SpdmDataLocationSession;
+      *(UINT32 *)Parameter.AdditionalData = mCurrentSessionId;
+      SpdmSetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, sizeof(UsePsk));
+
+      SpdmGenerateSessionDataKey (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TH2HashData);
+
+      UsePsk = TRUE;
+      ZeroMem (&Parameter, sizeof(Parameter));
+      Parameter.Location = SpdmDataLocationSession;
+      *(UINT32 *)Parameter.AdditionalData = mCurrentSessionId;
+      SpdmSetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, sizeof(UsePsk));
+
+      SpdmSecuredMessageSetUsePsk (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TRUE);
+      SpdmDumpKeyCacheSave (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), mCurrentSessionId, SPDM_DUMP_KEY_CACHE_STAGE_DATA, TH2HashData);
+    }
     SpdmSecuredMessageSetSessionState (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), SpdmSessionStateEstablished);
   }
 }
@@ -1888,23 +1943,29 @@ DumpSpdmPskFinishRsp (
     return ;
   }
   SpdmCalculateTH2Hash (mSpdmContext, mCurrentSessionInfo, TRUE, TH2HashData);
-  SpdmSecuredMessageSetUsePsk (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), FALSE);
+  if (!SpdmDumpKeyCacheImport (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), mCurrentSessionId, SPDM_DUMP_KEY_CACHE_STAGE_DATA, TH2HashData)) {
+    if (!SpdmDumpSessionSecretAvailable (mSpdmContext, mCurrentSessionId)) {
+      return ;
+    }
+    SpdmSecuredMessageSetUsePsk (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), FALSE);
 
-  UsePsk = FALSE;
-  ZeroMem (&Parameter, sizeof(Parameter));
-  Parameter.Location = SpdmDataLocationSession;
-  *(UINT32 *)Parameter.AdditionalData = mCurrentSessionId;
-  SpdmSetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, sizeof(UsePsk));
+    UsePsk = FALSE;
+    ZeroMem (&Parameter, sizeof(Parameter));
+    Parameter.Location = SpdmDataLocationSession;
+    *(UINT32 *)Parameter.AdditionalData = mCurrentSessionId;
+    SpdmSetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, sizeof(UsePsk));
 
-  SpdmGenerateSessionDataKey (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TH2HashData);
+    SpdmGenerateSessionDataKey (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TH2HashData);
 
-  UsePsk = TRUE;
-  ZeroMem (&Parameter, sizeof(Parameter));
-  Parameter.Location = SpdmDataLocationSession;
-  *(UINT32 *)Parameter.AdditionalData = mCurrentSessionId;
-  SpdmSetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, sizeof(UsePsk));
+    UsePsk = TRUE;
+    ZeroMem (&Parameter, sizeof(Parameter));
+    Parameter.Location = SpdmDataLocationSession;
+    *(UINT32 *)Parameter.AdditionalData = mCurrentSessionId;
+    SpdmSetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, sizeof(UsePsk));
 
-  SpdmSecuredMessageSetUsePsk (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TRUE);
+    SpdmSecuredMessageSetUsePsk (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), TRUE);
+    SpdmDumpKeyCacheSave (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), mCurrentSessionId, SPDM_DUMP_KEY_CACHE_STAGE_DATA, TH2HashData);
+  }
   SpdmSecuredMessageSetSessionState (SpdmGetSecuredMessageContextViaSessionInfo (mCurrentSessionInfo), SpdmSessionStateEstablished);
 }
 
@@ -2230,6 +2291,8 @@ DISPATCH_TABLE_ENTRY mSpdmDispatch[] = {
   {SPDM_END_SESSION,                   "SPDM_END_SESSION",                   DumpSpdmEndSession},
 };
 
+DISPATCH_TABLE mSpdmDispatchTable = DISPATCH_TABLE_INIT (mSpdmDispatch);
+
 VOID
 DumpSpdmMessage (
   IN VOID    *Buffer,
@@ -2245,6 +2308,15 @@ DumpSpdmMessage (
 
   SpdmHeader = Buffer;
 
+  if (!SpdmDumpFilterIsOutputMuted ()) {
+    if (mParamStatistics) {
+      SpdmDumpStatisticsRecordMessage (Buffer, BufferSize);
+    }
+    if (mParamOutputFormat == SPDM_DUMP_OUTPUT_FORMAT_JSONL) {
+      SpdmDumpJsonRecordMessage (Buffer, BufferSize);
+    }
+  }
+
   if (!mEncapsulated && !mDecrypted) {
     if ((SpdmHeader->RequestResponseCode & 0x80) != 0) {
       printf ("REQ->RSP ");
@@ -2254,7 +2326,7 @@ DumpSpdmMessage (
   }
   printf ("SPDM(%x, 0x%02x) ", SpdmHeader->SPDMVersion, SpdmHeader->RequestResponseCode);
 
-  DumpDispatchMessage (mSpdmDispatch, ARRAY_SIZE(mSpdmDispatch), SpdmHeader->RequestResponseCode, (UINT8 *)Buffer, BufferSize);
+  DumpDispatchMessage (&mSpdmDispatchTable, SpdmHeader->RequestResponseCode, (UINT8 *)Buffer, BufferSize);
 
   if (mParamDumpHex) {
     if (!mEncapsulated) {
@@ -2266,6 +2338,23 @@ DumpSpdmMessage (
   }
 }
 
+/**
+  Get the name of an SPDM request code or response code.
+**/
+CHAR8 *
+GetSpdmMessageName (
+  IN UINT8  RequestResponseCode
+  )
+{
+  DISPATCH_TABLE_ENTRY  *Entry;
+
+  Entry = GetDispatchEntryById (&mSpdmDispatchTable, RequestResponseCode);
+  if ((Entry == NULL) || (Entry->Name == NULL)) {
+    return "<Unknown>";
+  }
+  return Entry->Name;
+}
+
 BOOLEAN
 InitSpdmDump (
   VOID
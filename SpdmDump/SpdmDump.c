@@ -13,6 +13,19 @@ BOOLEAN  mParamQuiteMode;
 BOOLEAN  mParamAllMode;
 BOOLEAN  mParamDumpVendorApp;
 BOOLEAN  mParamDumpHex;
+UINT32   mParamWorkerCount = 1;
+CHAR8    *mParamIndexFileName;
+BOOLEAN  mParamSessionFilter;
+UINT32   mParamSessionId;
+BOOLEAN  mParamStatistics;
+UINT32   mParamOutputFormat = SPDM_DUMP_OUTPUT_FORMAT_TEXT;
+CHAR8    *mParamPcapFileName;
+CHAR8    *mParamStatisticsCsvFileName;
+CHAR8    *mParamKeyCacheFileName;
+CHAR8    *mParamCheckpointFileName;
+UINT32   mParamCheckpointInterval = 10000;
+BOOLEAN  mParamResume;
+UINT32   mParamResumeTime;
 CHAR8    *mParamOutRspCertChainFileName;
 CHAR8    *mParamOutReqCertChainFileName;
 
@@ -46,18 +59,58 @@ extern UINTN               mSpdmKeyScheduleValueStringTableCount;
 extern VALUE_STRING_ENTRY  mSpdmMeasurementSpecValueStringTable[];
 extern UINTN               mSpdmMeasurementSpecValueStringTableCount;
 
+/**
+  Build the direct index of a dispatch table.
+
+  The first entry of an ID is indexed, as it is found by a linear search.
+**/
+VOID
+BuildDispatchTableIndex (
+  IN DISPATCH_TABLE  *DispatchTable
+  )
+{
+  UINTN   Index;
+  UINT32  Offset;
+
+  DispatchTable->IdBase = MAX_UINT32;
+  for (Index = 0; Index < DispatchTable->EntryCount; Index++) {
+    if (DispatchTable->Entries[Index].Id < DispatchTable->IdBase) {
+      DispatchTable->IdBase = DispatchTable->Entries[Index].Id;
+    }
+  }
+  ZeroMem (DispatchTable->DirectIndex, sizeof(DispatchTable->DirectIndex));
+  for (Index = DispatchTable->EntryCount; Index > 0; Index--) {
+    Offset = DispatchTable->Entries[Index - 1].Id - DispatchTable->IdBase;
+    if ((Offset < DISPATCH_DIRECT_INDEX_COUNT) && (Index <= MAX_UINT8)) {
+      DispatchTable->DirectIndex[Offset] = (UINT8)Index;
+    }
+  }
+  DispatchTable->IndexReady = TRUE;
+}
+
 DISPATCH_TABLE_ENTRY *
 GetDispatchEntryById (
-  IN DISPATCH_TABLE_ENTRY  *DispatchTable,
-  IN UINTN                 DispatchTableCount,
+  IN DISPATCH_TABLE        *DispatchTable,
   IN UINT32                Id
   )
 {
-  UINTN  Index;
+  UINTN   Index;
+  UINT32  Offset;
 
-  for (Index = 0; Index < DispatchTableCount; Index++) {
-    if (DispatchTable[Index].Id == Id) {
-      return &DispatchTable[Index];
+  if (!DispatchTable->IndexReady) {
+    BuildDispatchTableIndex (DispatchTable);
+  }
+
+  Offset = Id - DispatchTable->IdBase;
+  if ((Id >= DispatchTable->IdBase) && (Offset < DISPATCH_DIRECT_INDEX_COUNT) &&
+      (DispatchTable->EntryCount <= MAX_UINT8)) {
+    Index = DispatchTable->DirectIndex[Offset];
+    return (Index == 0) ? NULL : &DispatchTable->Entries[Index - 1];
+  }
+
+  for (Index = 0; Index < DispatchTable->EntryCount; Index++) {
+    if (DispatchTable->Entries[Index].Id == Id) {
+      return &DispatchTable->Entries[Index];
     }
   }
   return NULL;
@@ -65,8 +118,7 @@ GetDispatchEntryById (
 
 VOID
 DumpDispatchMessage (
-  IN DISPATCH_TABLE_ENTRY  *DispatchTable,
-  IN UINTN                 DispatchTableCount,
+  IN DISPATCH_TABLE        *DispatchTable,
   IN UINT32                Id,
   IN VOID                  *Buffer,
   IN UINTN                 BufferSize
@@ -74,7 +126,7 @@ DumpDispatchMessage (
 {
   DISPATCH_TABLE_ENTRY *Entry;
 
-  Entry = GetDispatchEntryById (DispatchTable, DispatchTableCount, Id);
+  Entry = GetDispatchEntryById (DispatchTable, Id);
   if (Entry != NULL) {
     if (Entry->DumpFunc != NULL) {
       Entry->DumpFunc (Buffer, BufferSize);
@@ -219,8 +271,19 @@ PrintUsage (
   printf ("   [-a] (all mode, dump all fields)\n");
   printf ("   [-d] (dump application message)\n");
   printf ("   [-x] (dump message in hex)\n");
+  printf ("   [--jobs <WorkerCount>]\n");
+  printf ("   [--index <IndexFileName>]\n");
+  printf ("   [--session <SessionId>]\n");
+  printf ("   [--filter <FilterExpression>]\n");
+  printf ("   [--stats]\n");
+  printf ("   [--stats_csv <CsvFileName>]\n");
+  printf ("   [--format text|jsonl]\n");
   printf ("   [--psk <pre-shared key>]\n");
   printf ("   [--dhe_secret <session DHE secret>]\n");
+  printf ("   [--key_cache <KeyCacheFileName>]\n");
+  printf ("   [--checkpoint <CheckpointFileName>]\n");
+  printf ("   [--checkpoint_interval <PacketCount>]\n");
+  printf ("   [--resume <Sec>]\n");
   printf ("   [--req_cap       CERT|CHAL|                                ENCRYPT|MAC|MUT_AUTH|KEY_EX|PSK|                 ENCAP|HBEAT|KEY_UPD|HANDSHAKE_IN_CLEAR|PUB_KEY_ID]\n");
   printf ("   [--rsp_cap CACHE|CERT|CHAL|MEAS_NO_SIG|MEAS_SIG|MEAS_FRESH|ENCRYPT|MAC|MUT_AUTH|KEY_EX|PSK|PSK_WITH_CONTEXT|ENCAP|HBEAT|KEY_UPD|HANDSHAKE_IN_CLEAR|PUB_KEY_ID]\n");
   printf ("   [--hash SHA_256|SHA_384|SHA_512|SHA3_256|SHA3_384|SHA3_512]\n");
@@ -251,6 +314,49 @@ PrintUsage (
   printf ("      Capabilities and algorithms are required if GET_CAPABILITIES or NEGOTIATE_ALGORITHMS is not sent.\n");
   printf ("              For example, the negotiated state session or quick PSK session.\n");
   printf ("\n");
+  printf ("   [--jobs] is the count of the workers decoding the sessions in parallel. By default, 1 is used.\n");
+  printf ("      The capture is split by session, and the secured messages of each session are decrypted by one worker.\n");
+  printf ("      The output is in packet order, the same as the serial decode. It needs a regular pcap file.\n");
+  printf ("\n");
+  printf ("   [--index] is the side index of the packet offsets, session IDs and request codes of the capture.\n");
+  printf ("      It is built and saved if it does not match the capture, otherwise it is used instead of a scan.\n");
+  printf ("   [--session] decodes only the packets of one session, and the packets out of any session.\n");
+  printf ("      Format: A hex value, such as 0xFFFEFFFF. The packets are located with the index.\n");
+  printf ("\n");
+  printf ("   [--filter] prints only the packets matching all the terms, separated by ','.\n");
+  printf ("      Format: session=<SessionId>, code=<RequestCode>, addr=<MctpEndpointId>, time=<StartSec>-<EndSec>, error\n");
+  printf ("              A term can have multiple values. Please use '|' for them. For example: code=0xE0|0x81,error\n");
+  printf ("      The packets are skipped at the transport layer if possible, before the decryption and the dump.\n");
+  printf ("      The packets the SPDM context depends on are still decoded, without output.\n");
+  printf ("\n");
+  printf ("   [--stats] prints the statistics of the capture instead of the packets.\n");
+  printf ("      Each request is paired with its response by the pcap timestamps, for the count, the latency percentiles\n");
+  printf ("      and the ResponseNotReady, Busy and other errors of each request code, the durations of the VCA,\n");
+  printf ("      handshake and session phases, and the packets and bytes of each session.\n");
+  printf ("      It can be combined with [--filter]. The capture is decoded serially.\n");
+  printf ("   [--stats_csv] writes the statistics to a CSV file, with one line for each request code, phase or session.\n");
+  printf ("\n");
+  printf ("   [--format] is the format of the output. By default, text is used.\n");
+  printf ("      jsonl prints one JSON record per line for each SPDM message, with the packet index, the timestamp,\n");
+  printf ("      the session ID, the header fields and the message in hex, and one record for each other packet.\n");
+  printf ("      The other messages of the tool are printed to stderr.\n");
+  printf ("\n");
+  printf ("   [--key_cache] is the file of the secrets derived by the key schedule of the sessions, by SessionId and transcript hash.\n");
+  printf ("      The secrets are saved as the sessions are decrypted, and imported directly by the later runs,\n");
+  printf ("      so that [--psk] and [--dhe_secret] are not required again for the same capture.\n");
+  printf ("      The file has the session secrets in the clear. Please protect it as the DHE secret and the PSK.\n");
+  printf ("\n");
+  printf ("   [--checkpoint] is the file of the decode state at every [--checkpoint_interval] packets, 10000 by default.\n");
+  printf ("      It has the negotiated state, and the secrets, the keys and the sequence numbers of the sessions.\n");
+  printf ("      The capture is decoded serially. It needs a regular pcap file.\n");
+  printf ("      The file has the session secrets in the clear. Please protect it as the DHE secret and the PSK.\n");
+  printf ("   [--resume] decodes from the last checkpoint at or before a time, in seconds of the pcap timestamp,\n");
+  printf ("      instead of from the first packet. For example: --resume <Sec> --filter time=<Sec>-\n");
+  printf ("\n");
+  printf ("   [-r] accepts a pcap or pcapng file. '-' reads the capture from stdin.\n");
+  printf ("      If it is stdin, a FIFO or a pipe, the packets are decoded as they arrive, for a live capture.\n");
+  printf ("      For example: SpdmResponderEmu --pcap spdm.fifo & SpdmDump -r spdm.fifo\n");
+  printf ("\n");
   printf ("   [--req_cert_chain] is required to if encapsulated GET_CERTIFICATE is not sent\n");
   printf ("   [--rsp_cert_chain] is required to if GET_CERTIFICATE is not sent\n");
   printf ("   [--out_req_cert_chain] can be used if encapsulated GET_CERTIFICATE is sent\n");
@@ -267,12 +373,9 @@ ProcessArgs (
   char  *argv[ ]
   )
 {
-  CHAR8   *PcapFileName;
   UINT32  Data32;
   BOOLEAN Res;
 
-  PcapFileName = NULL;
-
   if (argc == 1) {
     return ;
   }
@@ -289,7 +392,7 @@ ProcessArgs (
   while (argc > 0) {
     if (strcmp (argv[0], "-r") == 0) {
       if (argc >= 2) {
-        PcapFileName = argv[1];
+        mParamPcapFileName = argv[1];
         argc -= 2;
         argv += 2;
         continue;
@@ -328,6 +431,168 @@ ProcessArgs (
       continue;
     }
 
+    if (strcmp (argv[0], "--jobs") == 0) {
+      if (argc >= 2) {
+        mParamWorkerCount = (UINT32)strtoul (argv[1], NULL, 0);
+        if (mParamWorkerCount == 0) {
+          printf ("invalid --jobs %s\n", argv[1]);
+          PrintUsage ();
+          exit (0);
+        }
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --jobs\n");
+        PrintUsage ();
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--index") == 0) {
+      if (argc >= 2) {
+        mParamIndexFileName = argv[1];
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --index\n");
+        PrintUsage ();
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--session") == 0) {
+      if (argc >= 2) {
+        mParamSessionId = (UINT32)strtoul (argv[1], NULL, 16);
+        mParamSessionFilter = TRUE;
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --session\n");
+        PrintUsage ();
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--filter") == 0) {
+      if (argc >= 2) {
+        if (!SpdmDumpParseFilter (argv[1])) {
+          printf ("invalid --filter %s\n", argv[1]);
+          PrintUsage ();
+          exit (0);
+        }
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --filter\n");
+        PrintUsage ();
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--stats") == 0) {
+      mParamStatistics = TRUE;
+      argc -= 1;
+      argv += 1;
+      continue;
+    }
+
+    if (strcmp (argv[0], "--stats_csv") == 0) {
+      if (argc >= 2) {
+        mParamStatistics = TRUE;
+        mParamStatisticsCsvFileName = argv[1];
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --stats_csv\n");
+        PrintUsage ();
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--format") == 0) {
+      if (argc >= 2) {
+        if (strcmp (argv[1], "text") == 0) {
+          mParamOutputFormat = SPDM_DUMP_OUTPUT_FORMAT_TEXT;
+        } else if (strcmp (argv[1], "jsonl") == 0) {
+          mParamOutputFormat = SPDM_DUMP_OUTPUT_FORMAT_JSONL;
+        } else {
+          printf ("invalid --format %s\n", argv[1]);
+          PrintUsage ();
+          exit (0);
+        }
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --format\n");
+        PrintUsage ();
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--key_cache") == 0) {
+      if (argc >= 2) {
+        mParamKeyCacheFileName = argv[1];
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --key_cache\n");
+        PrintUsage ();
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--checkpoint") == 0) {
+      if (argc >= 2) {
+        mParamCheckpointFileName = argv[1];
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --checkpoint\n");
+        PrintUsage ();
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--checkpoint_interval") == 0) {
+      if (argc >= 2) {
+        mParamCheckpointInterval = (UINT32)strtoul (argv[1], NULL, 0);
+        if (mParamCheckpointInterval == 0) {
+          printf ("invalid --checkpoint_interval %s\n", argv[1]);
+          PrintUsage ();
+          exit (0);
+        }
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --checkpoint_interval\n");
+        PrintUsage ();
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--resume") == 0) {
+      if (argc >= 2) {
+        mParamResumeTime = (UINT32)strtoul (argv[1], NULL, 0);
+        mParamResume = TRUE;
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --resume\n");
+        PrintUsage ();
+        exit (0);
+      }
+    }
+
     if (strcmp (argv[0], "--psk") == 0) {
       if (argc >= 2) {
         if (!HexStringToBuffer (argv[1], &mPskBuffer, &mPskBufferSize)) {
@@ -632,11 +897,28 @@ ProcessArgs (
     exit (0);
   }
 
-  if (PcapFileName != NULL) {
-    if (!OpenPcapPacketFile (PcapFileName)) {
-      PrintUsage ();
-      exit (0);
-    }
+  //
+  // The statistics are collected in one process.
+  //
+  if (mParamStatistics) {
+    mParamWorkerCount = 1;
+  }
+
+  //
+  // The checkpoints are taken by the serial decode of all the packets.
+  //
+  if (mParamResume && (mParamCheckpointFileName == NULL)) {
+    printf ("--resume needs --checkpoint\n");
+    PrintUsage ();
+    exit (0);
+  }
+  if ((mParamCheckpointFileName != NULL) && ((mParamIndexFileName != NULL) || mParamSessionFilter)) {
+    printf ("--checkpoint cannot be used with --index or --session\n");
+    PrintUsage ();
+    exit (0);
+  }
+  if (mParamCheckpointFileName != NULL) {
+    mParamWorkerCount = 1;
   }
 }
 
@@ -645,19 +927,37 @@ int main (
   char *argv[ ]
   )
 {
+  ProcessArgs (argc, argv);
+
+  //
+  // The banner is printed once the output format is known, so that it goes to stderr for --format jsonl.
+  //
   printf ("%s version 0.1\n", "SpdmDump");
 
-  ProcessArgs (argc, argv);
+  if (mParamPcapFileName != NULL) {
+    if (!OpenPcapPacketFile (mParamPcapFileName)) {
+      PrintUsage ();
+      exit (0);
+    }
+  }
 
   if (!InitSpdmDump ()) {
     ClosePcapPacketFile ();
     return 0;
   }
 
+  SpdmDumpKeyCacheOpen ();
+
   DumpPcap ();
 
+  DumpPcapStatistics ();
+
   DeinitSpdmDump ();
 
+  SpdmDumpKeyCacheClose ();
+
+  SpdmDumpCheckpointClose ();
+
   ClosePcapPacketFile ();
 
   if (mRequesterCertChainBuffer != NULL) {
@@ -29,6 +29,24 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "stdlib.h"
 #include "string.h"
 
+//
+// The output goes through SpdmDumpPrint, so that the filter of --filter can drop the output of
+// the packets which are decoded only to keep the SPDM context in sync.
+//
+int
+SpdmDumpPrint (
+  IN CONST CHAR8  *Format,
+  ...
+  );
+
+#define printf  SpdmDumpPrint
+
+//
+// The output format of --format.
+//
+#define SPDM_DUMP_OUTPUT_FORMAT_TEXT   0
+#define SPDM_DUMP_OUTPUT_FORMAT_JSONL  1
+
 typedef
 VOID
 (*DUMP_MESSAGE) (
@@ -42,17 +60,32 @@ typedef struct {
   DUMP_MESSAGE  DumpFunc;
 } DISPATCH_TABLE_ENTRY;
 
+//
+// The entries of a dispatch table are looked up by a direct index of the IDs from the lowest ID,
+// built at the first lookup. An ID beyond the direct index is looked up in the entries.
+//
+#define DISPATCH_DIRECT_INDEX_COUNT  0x100
+
+typedef struct {
+  DISPATCH_TABLE_ENTRY  *Entries;
+  UINTN                 EntryCount;
+  BOOLEAN               IndexReady;
+  UINT32                IdBase;
+  // The index of the entry of each ID plus one, or 0 if there is no entry.
+  UINT8                 DirectIndex[DISPATCH_DIRECT_INDEX_COUNT];
+} DISPATCH_TABLE;
+
+#define DISPATCH_TABLE_INIT(Entries)  {(Entries), ARRAY_SIZE(Entries)}
+
 DISPATCH_TABLE_ENTRY *
 GetDispatchEntryById (
-  IN DISPATCH_TABLE_ENTRY  *DispatchTable,
-  IN UINTN                 DispatchTableCount,
+  IN DISPATCH_TABLE        *DispatchTable,
   IN UINT32                Id
   );
 
 VOID
 DumpDispatchMessage (
-  IN DISPATCH_TABLE_ENTRY  *DispatchTable,
-  IN UINTN                 DispatchTableCount,
+  IN DISPATCH_TABLE        *DispatchTable,
   IN UINT32                Id,
   IN VOID                  *Buffer,
   IN UINTN                 BufferSize
@@ -109,6 +142,195 @@ DumpPcap (
   VOID
   );
 
+RETURN_STATUS
+GetPcapPacket (
+  OUT PCAP_PACKET_HEADER  *PcapPacketHeader,
+  OUT UINT8               **Data
+  );
+
+VOID
+RewindPcapPacketFile (
+  VOID
+  );
+
+UINT64
+GetPcapPacketOffset (
+  VOID
+  );
+
+BOOLEAN
+SeekPcapPacketFile (
+  IN UINT64  Offset,
+  IN UINT32  DataLinkType
+  );
+
+BOOLEAN
+GetPcapFileIdentity (
+  OUT UINT64  *FileSize,
+  OUT UINT64  *ModifyTime
+  );
+
+UINT64
+GetPcapPacketTime (
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader
+  );
+
+VOID
+DumpPcapPacketHeader (
+  IN UINTN               Index,
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader
+  );
+
+VOID
+DumpPcapPacket (
+  IN VOID    *Buffer,
+  IN UINTN   BufferSize
+  );
+
+BOOLEAN
+ScanPcapPacket (
+  IN  UINT8   *Buffer,
+  IN  UINTN   BufferSize,
+  OUT UINT32  *SessionId,
+  OUT UINT8   **SpdmMessage,
+  OUT UINTN   *SpdmMessageSize
+  );
+
+BOOLEAN
+DumpPcapIndexed (
+  VOID
+  );
+
+BOOLEAN
+SpdmDumpParseFilter (
+  IN CHAR8  *Expression
+  );
+
+BOOLEAN
+SpdmDumpFilterPacket (
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader,
+  IN UINT8               *Buffer,
+  IN UINTN               BufferSize
+  );
+
+BOOLEAN
+SpdmDumpFilterDecryptedMessage (
+  IN UINT8  *DecryptedMessage, OPTIONAL
+  IN UINTN  DecryptedMessageSize
+  );
+
+VOID
+SpdmDumpFilterEndPacket (
+  VOID
+  );
+
+BOOLEAN
+SpdmDumpFilterIsOutputMuted (
+  VOID
+  );
+
+VOID
+SpdmDumpStatisticsBeginPacket (
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader,
+  IN UINT8               *Buffer
+  );
+
+VOID
+SpdmDumpStatisticsRecordMessage (
+  IN UINT8  *SpdmMessage,
+  IN UINTN  SpdmMessageSize
+  );
+
+VOID
+DumpPcapStatistics (
+  VOID
+  );
+
+CHAR8 *
+GetSpdmMessageName (
+  IN UINT8  RequestResponseCode
+  );
+
+VOID
+SpdmDumpJsonBeginPacket (
+  IN UINTN               Index,
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader,
+  IN UINT8               *Buffer
+  );
+
+VOID
+SpdmDumpJsonRecordMessage (
+  IN UINT8  *SpdmMessage,
+  IN UINTN  SpdmMessageSize
+  );
+
+VOID
+SpdmDumpJsonEndPacket (
+  VOID
+  );
+
+BOOLEAN
+SpdmDumpJsonIsInPacket (
+  VOID
+  );
+
+#define SPDM_DUMP_KEY_CACHE_STAGE_HANDSHAKE  1
+#define SPDM_DUMP_KEY_CACHE_STAGE_DATA       2
+
+VOID
+SpdmDumpKeyCacheOpen (
+  VOID
+  );
+
+BOOLEAN
+SpdmDumpKeyCacheImport (
+  IN VOID    *SecuredMessageContext,
+  IN UINT32  SessionId,
+  IN UINT8   Stage,
+  IN UINT8   *TranscriptHash
+  );
+
+VOID
+SpdmDumpKeyCacheSave (
+  IN VOID    *SecuredMessageContext,
+  IN UINT32  SessionId,
+  IN UINT8   Stage,
+  IN UINT8   *TranscriptHash
+  );
+
+VOID
+SpdmDumpKeyCacheClose (
+  VOID
+  );
+
+VOID
+SpdmDumpCheckpointAddSession (
+  IN UINT32  SessionId
+  );
+
+UINTN
+SpdmDumpCheckpointOpen (
+  VOID
+  );
+
+VOID
+SpdmDumpCheckpointPacket (
+  IN UINTN               PacketIndex,
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader
+  );
+
+VOID
+SpdmDumpCheckpointClose (
+  VOID
+  );
+
+VOID
+DumpPcapPacketFiltered (
+  IN UINTN               Index,
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader,
+  IN UINT8               *Data
+  );
+
 UINT32
 GetDataLinkType (
   VOID
@@ -212,6 +434,12 @@ SpdmDumpSessionDataCheck (
   IN BOOLEAN                      IsRequester
   );
 
+BOOLEAN
+SpdmDumpSessionSecretAvailable (
+  IN VOID                         *SpdmContext,
+  IN UINT32                       SessionId
+  );
+
 BOOLEAN
 HexStringToBuffer (
   IN  CHAR8   *HexString,
@@ -242,6 +470,19 @@ extern BOOLEAN  mParamQuiteMode;
 extern BOOLEAN  mParamAllMode;
 extern BOOLEAN  mParamDumpVendorApp;
 extern BOOLEAN  mParamDumpHex;
+extern UINT32   mParamWorkerCount;
+extern CHAR8    *mParamIndexFileName;
+extern BOOLEAN  mParamSessionFilter;
+extern UINT32   mParamSessionId;
+extern BOOLEAN  mParamStatistics;
+extern UINT32   mParamOutputFormat;
+extern CHAR8    *mParamStatisticsCsvFileName;
+extern CHAR8    *mParamKeyCacheFileName;
+extern CHAR8    *mParamCheckpointFileName;
+extern UINT32   mParamCheckpointInterval;
+extern BOOLEAN  mParamResume;
+extern UINT32   mParamResumeTime;
+extern BOOLEAN  mDumpPacketOwned;
 extern CHAR8    *mParamOutRspCertChainFileName;
 extern CHAR8    *mParamOutReqCertChainFileName;
 
@@ -0,0 +1,591 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmDump.h"
+
+//
+// The checkpoints of --checkpoint have the decode state at a packet of the capture, so that --resume starts
+// to decode at that packet instead of the first packet of the capture. A checkpoint is taken before the packet,
+// every mParamCheckpointInterval packets of the serial decode, and it is appended to the file.
+//
+// The decode state is the negotiated capabilities and algorithms, message A, the request the next response is
+// decoded with, the certificate chain being retrieved, and the sessions. A session is saved with the secrets
+// derived by the key schedule, which are the current generation of the data secrets after a KEY_UPDATE, and with
+// the data keys and sequence numbers. The transcript of a handshake is not saved, so a checkpoint waits until
+// no session is in its handshake. A session still in its handshake after another interval is not saved.
+//
+// The file is bound to the capture by its size and modification time, as the index of --index. The file of
+// another capture is created again.
+//
+#define SPDM_DUMP_CHECKPOINT_SIGNATURE  SIGNATURE_64 ('S', 'P', 'D', 'M', 'C', 'K', 'P', 'T')
+#define SPDM_DUMP_CHECKPOINT_VERSION    1
+
+#define SPDM_DUMP_CHECKPOINT_MAX_SECRETS_SIZE  (sizeof(SPDM_SECURE_SESSION_SECRETS_STRUCT) + \
+                                                MAX_HASH_SIZE * 9 + (MAX_AEAD_KEY_SIZE + MAX_AEAD_IV_SIZE) * 4)
+#define SPDM_DUMP_CHECKPOINT_MAX_KEYS_SIZE     (sizeof(SPDM_SECURE_SESSION_KEYS_STRUCT) + \
+                                                (MAX_AEAD_KEY_SIZE + MAX_AEAD_IV_SIZE + sizeof(UINT64)) * 2)
+
+#pragma pack(1)
+
+typedef struct {
+  UINT64  Signature;
+  UINT32  Version;
+  UINT32  Reserved;
+  UINT64  CaptureSize;
+  UINT64  CaptureModifyTime;
+//SPDM_DUMP_CHECKPOINT  Checkpoint[];
+} SPDM_DUMP_CHECKPOINT_HEADER;
+
+typedef struct {
+  UINT32  CheckpointSize;
+  UINT32  DataLinkType;
+  UINT64  PacketIndex;
+  UINT64  PacketOffset;
+  UINT64  PacketTime;
+  UINT32  RequesterCapabilitiesFlags;
+  UINT32  ResponderCapabilitiesFlags;
+  UINT32  MeasurementHashAlgo;
+  UINT32  BaseAsymAlgo;
+  UINT32  BaseHashAlgo;
+  UINT16  DHENamedGroup;
+  UINT16  AEADCipherSuite;
+  UINT16  ReqBaseAsymAlg;
+  UINT16  KeySchedule;
+  UINT8   MeasurementSpec;
+  UINT8   CachedGetMeasurementRequestAttribute;
+  UINT8   CachedGetMeasurementOperation;
+  UINT8   CachedMeasurementSummaryHashType;
+  UINT32  CachedSessionId;
+  UINT32  CurrentSessionId;
+  UINT32  MessageASize;
+  UINT32  LastMessageSize;
+  UINT32  CertChainOffset;
+  UINT32  CertChainSize;
+  UINT32  SessionCount;
+//UINT8                         MessageA[MessageASize];
+//UINT8                         LastMessage[LastMessageSize];
+//UINT8                         CertChain[CertChainSize];
+//SPDM_DUMP_CHECKPOINT_SESSION  Session[SessionCount];
+} SPDM_DUMP_CHECKPOINT;
+
+typedef struct {
+  UINT32  SessionId;
+  UINT8   UsePsk;
+  UINT8   MutAuthRequested;
+  UINT16  Reserved;
+  UINT32  SecretsSize;
+  UINT32  KeysSize;
+//UINT8   Secrets[SecretsSize];
+//UINT8   Keys[KeysSize];
+} SPDM_DUMP_CHECKPOINT_SESSION;
+
+#pragma pack()
+
+extern VOID     *mSpdmContext;
+extern VOID     *mSpdmLastMessageBuffer;
+extern UINTN    mSpdmLastMessageBufferSize;
+extern UINT8    mSpdmMessageABuffer[MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+extern UINTN    mSpdmMessageABufferSize;
+extern VOID     *mSpdmCertChainBuffer;
+extern UINTN    mSpdmCertChainBufferSize;
+extern UINTN    mCachedSpdmCertChainBufferOffset;
+extern UINT8    mCachedGetMeasurementRequestAttribute;
+extern UINT8    mCachedGetMeasurementOperation;
+extern UINT8    mCachedMeasurementSummaryHashType;
+extern UINT32   mCachedSessionId;
+extern VOID     *mCurrentSessionInfo;
+extern UINT32   mCurrentSessionId;
+extern UINT32   mSpdmRequesterCapabilitiesFlags;
+extern UINT32   mSpdmResponderCapabilitiesFlags;
+extern UINT8    mSpdmMeasurementSpec;
+extern UINT32   mSpdmMeasurementHashAlgo;
+extern UINT32   mSpdmBaseAsymAlgo;
+extern UINT32   mSpdmBaseHashAlgo;
+extern UINT16   mSpdmDHENamedGroup;
+extern UINT16   mSpdmAEADCipherSuite;
+extern UINT16   mSpdmReqBaseAsymAlg;
+extern UINT16   mSpdmKeySchedule;
+
+FILE     *mCheckpointFile;
+UINT8    *mCheckpointBuffer;
+UINTN    mCheckpointBufferSize;
+UINTN    mCheckpointLastPacket;
+//
+// The sessions assigned in the SPDM context, or 0. The SPDM context has at most MAX_SPDM_SESSION_COUNT sessions.
+//
+UINT32   mCheckpointSessionId[MAX_SPDM_SESSION_COUNT];
+
+/**
+  Record a session assigned in the SPDM context, to be saved by the checkpoints.
+
+  @param  SessionId                    The SessionId of the session.
+**/
+VOID
+SpdmDumpCheckpointAddSession (
+  IN UINT32  SessionId
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    if (mCheckpointSessionId[Index] == SessionId) {
+      return ;
+    }
+  }
+  //
+  // The session replaces a session which is freed.
+  //
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    if ((mCheckpointSessionId[Index] == 0) ||
+        (SpdmGetSessionInfoViaSessionId (mSpdmContext, mCheckpointSessionId[Index]) == NULL)) {
+      mCheckpointSessionId[Index] = SessionId;
+      return ;
+    }
+  }
+}
+
+/**
+  Set the negotiated capabilities and algorithms to the SPDM context, as InitSpdmDump does.
+**/
+VOID
+SpdmDumpCheckpointProvision (
+  VOID
+  )
+{
+  SPDM_DATA_PARAMETER  Parameter;
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  SpdmSetData (mSpdmContext, SpdmDataCapabilityFlags, &Parameter, &mSpdmRequesterCapabilitiesFlags, sizeof(UINT32));
+  Parameter.Location = SpdmDataLocationConnection;
+  SpdmSetData (mSpdmContext, SpdmDataCapabilityFlags, &Parameter, &mSpdmResponderCapabilitiesFlags, sizeof(UINT32));
+  SpdmSetData (mSpdmContext, SpdmDataMeasurementSpec, &Parameter, &mSpdmMeasurementSpec, sizeof(UINT8));
+  SpdmSetData (mSpdmContext, SpdmDataMeasurementHashAlgo, &Parameter, &mSpdmMeasurementHashAlgo, sizeof(UINT32));
+  SpdmSetData (mSpdmContext, SpdmDataBaseAsymAlgo, &Parameter, &mSpdmBaseAsymAlgo, sizeof(UINT32));
+  SpdmSetData (mSpdmContext, SpdmDataBaseHashAlgo, &Parameter, &mSpdmBaseHashAlgo, sizeof(UINT32));
+  SpdmSetData (mSpdmContext, SpdmDataDHENamedGroup, &Parameter, &mSpdmDHENamedGroup, sizeof(UINT16));
+  SpdmSetData (mSpdmContext, SpdmDataAEADCipherSuite, &Parameter, &mSpdmAEADCipherSuite, sizeof(UINT16));
+  SpdmSetData (mSpdmContext, SpdmDataReqBaseAsymAlg, &Parameter, &mSpdmReqBaseAsymAlg, sizeof(UINT16));
+  SpdmSetData (mSpdmContext, SpdmDataKeySchedule, &Parameter, &mSpdmKeySchedule, sizeof(UINT16));
+}
+
+/**
+  Restore the decode state of a checkpoint, to the SPDM context just initialized.
+
+  A session whose secrets cannot be imported is freed, so its secured messages are not decrypted.
+
+  @param  Checkpoint                   The checkpoint, of CheckpointSize bytes.
+
+  @retval TRUE   the decode state is restored.
+  @retval FALSE  the checkpoint is malformed, and the decode state is not changed.
+**/
+BOOLEAN
+SpdmDumpCheckpointRestore (
+  IN SPDM_DUMP_CHECKPOINT  *Checkpoint
+  )
+{
+  SPDM_DUMP_CHECKPOINT_SESSION  *Session;
+  SPDM_DATA_PARAMETER           Parameter;
+  UINT8                         *Ptr;
+  UINT8                         *End;
+  VOID                          *SessionInfo;
+  VOID                          *SecuredMessageContext;
+  UINT8                         MutAuthRequested;
+  UINTN                         Index;
+
+  //
+  // Check all the sizes before the decode state is changed.
+  //
+  End = (UINT8 *)Checkpoint + Checkpoint->CheckpointSize;
+  Ptr = (UINT8 *)(Checkpoint + 1);
+  if ((Checkpoint->MessageASize > sizeof(mSpdmMessageABuffer)) ||
+      (Checkpoint->LastMessageSize > GetMaxPacketLength ()) ||
+      (Checkpoint->CertChainSize > MAX_SPDM_CERT_CHAIN_SIZE) ||
+      (Checkpoint->CertChainOffset > MAX_SPDM_CERT_CHAIN_SIZE) ||
+      (Checkpoint->SessionCount > MAX_SPDM_SESSION_COUNT) ||
+      ((UINTN)Checkpoint->MessageASize + Checkpoint->LastMessageSize + Checkpoint->CertChainSize > (UINTN)(End - Ptr))) {
+    return FALSE;
+  }
+  Ptr += Checkpoint->MessageASize + Checkpoint->LastMessageSize + Checkpoint->CertChainSize;
+  for (Index = 0; Index < Checkpoint->SessionCount; Index++) {
+    Session = (VOID *)Ptr;
+    if ((sizeof(SPDM_DUMP_CHECKPOINT_SESSION) > (UINTN)(End - Ptr)) ||
+        ((UINTN)Session->SecretsSize + Session->KeysSize > (UINTN)(End - Ptr) - sizeof(SPDM_DUMP_CHECKPOINT_SESSION))) {
+      return FALSE;
+    }
+    Ptr += sizeof(SPDM_DUMP_CHECKPOINT_SESSION) + Session->SecretsSize + Session->KeysSize;
+  }
+
+  mSpdmRequesterCapabilitiesFlags = Checkpoint->RequesterCapabilitiesFlags;
+  mSpdmResponderCapabilitiesFlags = Checkpoint->ResponderCapabilitiesFlags;
+  mSpdmMeasurementSpec = Checkpoint->MeasurementSpec;
+  mSpdmMeasurementHashAlgo = Checkpoint->MeasurementHashAlgo;
+  mSpdmBaseAsymAlgo = Checkpoint->BaseAsymAlgo;
+  mSpdmBaseHashAlgo = Checkpoint->BaseHashAlgo;
+  mSpdmDHENamedGroup = Checkpoint->DHENamedGroup;
+  mSpdmAEADCipherSuite = Checkpoint->AEADCipherSuite;
+  mSpdmReqBaseAsymAlg = Checkpoint->ReqBaseAsymAlg;
+  mSpdmKeySchedule = Checkpoint->KeySchedule;
+  mCachedGetMeasurementRequestAttribute = Checkpoint->CachedGetMeasurementRequestAttribute;
+  mCachedGetMeasurementOperation = Checkpoint->CachedGetMeasurementOperation;
+  mCachedMeasurementSummaryHashType = Checkpoint->CachedMeasurementSummaryHashType;
+  mCachedSessionId = Checkpoint->CachedSessionId;
+  SpdmDumpCheckpointProvision ();
+
+  Ptr = (UINT8 *)(Checkpoint + 1);
+  SpdmResetMessageA (mSpdmContext);
+  SpdmAppendMessageA (mSpdmContext, Ptr, Checkpoint->MessageASize);
+  CopyMem (mSpdmMessageABuffer, Ptr, Checkpoint->MessageASize);
+  mSpdmMessageABufferSize = Checkpoint->MessageASize;
+  Ptr += Checkpoint->MessageASize;
+  CopyMem (mSpdmLastMessageBuffer, Ptr, Checkpoint->LastMessageSize);
+  mSpdmLastMessageBufferSize = Checkpoint->LastMessageSize;
+  Ptr += Checkpoint->LastMessageSize;
+  CopyMem (mSpdmCertChainBuffer, Ptr, Checkpoint->CertChainSize);
+  mSpdmCertChainBufferSize = Checkpoint->CertChainSize;
+  mCachedSpdmCertChainBufferOffset = Checkpoint->CertChainOffset;
+  Ptr += Checkpoint->CertChainSize;
+
+  for (Index = 0; Index < Checkpoint->SessionCount; Index++) {
+    Session = (VOID *)Ptr;
+    Ptr += sizeof(SPDM_DUMP_CHECKPOINT_SESSION) + Session->SecretsSize + Session->KeysSize;
+
+    SessionInfo = SpdmAssignSessionId (mSpdmContext, Session->SessionId, Session->UsePsk);
+    if (SessionInfo == NULL) {
+      printf ("!!!Unable to restore session 0x%08x!!!\n", Session->SessionId);
+      continue;
+    }
+    MutAuthRequested = Session->MutAuthRequested;
+    ZeroMem (&Parameter, sizeof(Parameter));
+    Parameter.Location = SpdmDataLocationSession;
+    *(UINT32 *)Parameter.AdditionalData = Session->SessionId;
+    SpdmSetData (mSpdmContext, SpdmDataSessionMutAuthRequested, &Parameter, &MutAuthRequested, sizeof(MutAuthRequested));
+
+    SecuredMessageContext = SpdmGetSecuredMessageContextViaSessionInfo (SessionInfo);
+    if (RETURN_ERROR (SpdmSecuredMessageImportSessionSecrets (SecuredMessageContext, Session + 1, Session->SecretsSize)) ||
+        RETURN_ERROR (SpdmSecuredMessageImportSessionKeys (SecuredMessageContext, (UINT8 *)(Session + 1) + Session->SecretsSize, Session->KeysSize))) {
+      printf ("!!!Unable to restore session 0x%08x!!!\n", Session->SessionId);
+      SpdmFreeSessionId (mSpdmContext, Session->SessionId);
+      continue;
+    }
+    SpdmSecuredMessageSetSessionState (SecuredMessageContext, SpdmSessionStateEstablished);
+    SpdmDumpCheckpointAddSession (Session->SessionId);
+  }
+
+  mCurrentSessionId = Checkpoint->CurrentSessionId;
+  mCurrentSessionInfo = SpdmGetSessionInfoViaSessionId (mSpdmContext, mCurrentSessionId);
+  return TRUE;
+}
+
+/**
+  Restore the last checkpoint before the time of --resume, and move to its packet.
+
+  @param  FileData                     The checkpoint file.
+  @param  FileSize                     The size in bytes of the checkpoint file.
+
+  @return the index of the packet to decode next, or 1 if no checkpoint is restored.
+**/
+UINTN
+SpdmDumpCheckpointResume (
+  IN UINT8  *FileData,
+  IN UINTN  FileSize
+  )
+{
+  SPDM_DUMP_CHECKPOINT  *Checkpoint;
+  SPDM_DUMP_CHECKPOINT  *ResumeCheckpoint;
+  UINT64                ResumeTime;
+  UINTN                 Offset;
+
+  ResumeTime = (UINT64)mParamResumeTime * 1000000;
+  ResumeCheckpoint = NULL;
+  Offset = sizeof(SPDM_DUMP_CHECKPOINT_HEADER);
+  while (Offset + sizeof(SPDM_DUMP_CHECKPOINT) <= FileSize) {
+    Checkpoint = (VOID *)(FileData + Offset);
+    if ((Checkpoint->CheckpointSize < sizeof(SPDM_DUMP_CHECKPOINT)) ||
+        (Checkpoint->CheckpointSize > FileSize - Offset)) {
+      //
+      // A truncated checkpoint, from a run which was interrupted.
+      //
+      break;
+    }
+    if ((Checkpoint->PacketTime <= ResumeTime) &&
+        ((ResumeCheckpoint == NULL) || (Checkpoint->PacketIndex > ResumeCheckpoint->PacketIndex))) {
+      ResumeCheckpoint = Checkpoint;
+    }
+    Offset += Checkpoint->CheckpointSize;
+  }
+
+  if (ResumeCheckpoint == NULL) {
+    printf ("!!!No checkpoint before the time of --resume, the capture is decoded from the first packet!!!\n");
+    return 1;
+  }
+  if (!SeekPcapPacketFile (ResumeCheckpoint->PacketOffset, ResumeCheckpoint->DataLinkType) ||
+      !SpdmDumpCheckpointRestore (ResumeCheckpoint)) {
+    RewindPcapPacketFile ();
+    printf ("!!!The checkpoint is invalid, the capture is decoded from the first packet!!!\n");
+    return 1;
+  }
+  return (UINTN)ResumeCheckpoint->PacketIndex;
+}
+
+/**
+  Open the checkpoint file of --checkpoint, before the serial decode of the capture,
+  and restore the checkpoint of --resume.
+
+  @return the index of the packet to decode next, or 1 to decode from the first packet.
+**/
+UINTN
+SpdmDumpCheckpointOpen (
+  VOID
+  )
+{
+  FILE                         *FpIn;
+  SPDM_DUMP_CHECKPOINT_HEADER  Header;
+  UINT64                       CaptureSize;
+  UINT64                       CaptureModifyTime;
+  UINT8                        *FileData;
+  UINTN                        FileSize;
+  UINTN                        PacketIndex;
+
+  if (mParamCheckpointFileName == NULL) {
+    return 1;
+  }
+  if (!GetPcapFileIdentity (&CaptureSize, &CaptureModifyTime)) {
+    printf ("!!!--checkpoint needs a regular pcap file, the capture is decoded from the first packet!!!\n");
+    return 1;
+  }
+
+  mCheckpointBufferSize = sizeof(SPDM_DUMP_CHECKPOINT) + MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE + GetMaxPacketLength () +
+                          MAX_SPDM_CERT_CHAIN_SIZE + MAX_SPDM_SESSION_COUNT * (sizeof(SPDM_DUMP_CHECKPOINT_SESSION) +
+                          SPDM_DUMP_CHECKPOINT_MAX_SECRETS_SIZE + SPDM_DUMP_CHECKPOINT_MAX_KEYS_SIZE);
+  mCheckpointBuffer = malloc (mCheckpointBufferSize);
+  if (mCheckpointBuffer == NULL) {
+    printf ("!!!Unable to allocate the checkpoint, the capture is decoded from the first packet!!!\n");
+    return 1;
+  }
+
+  PacketIndex = 1;
+  FileData = NULL;
+  FileSize = 0;
+  if ((FpIn = fopen (mParamCheckpointFileName, "rb")) != NULL) {
+    fseek (FpIn, 0, SEEK_END);
+    FileSize = ftell (FpIn);
+    fseek (FpIn, 0, SEEK_SET);
+    if (FileSize != 0) {
+      FileData = malloc (FileSize);
+      if ((FileData != NULL) && (fread (FileData, 1, FileSize, FpIn) != FileSize)) {
+        free (FileData);
+        FileData = NULL;
+      }
+      if (FileData == NULL) {
+        //
+        // Do not create again a file which cannot be read.
+        //
+        printf ("!!!Unable to read the checkpoint file %s!!!\n", mParamCheckpointFileName);
+        fclose (FpIn);
+        free (mCheckpointBuffer);
+        mCheckpointBuffer = NULL;
+        return 1;
+      }
+    }
+    fclose (FpIn);
+  }
+
+  if ((FileData != NULL) && (FileSize >= sizeof(SPDM_DUMP_CHECKPOINT_HEADER)) &&
+      (((SPDM_DUMP_CHECKPOINT_HEADER *)FileData)->Signature == SPDM_DUMP_CHECKPOINT_SIGNATURE) &&
+      (((SPDM_DUMP_CHECKPOINT_HEADER *)FileData)->Version == SPDM_DUMP_CHECKPOINT_VERSION) &&
+      (((SPDM_DUMP_CHECKPOINT_HEADER *)FileData)->CaptureSize == CaptureSize) &&
+      (((SPDM_DUMP_CHECKPOINT_HEADER *)FileData)->CaptureModifyTime == CaptureModifyTime)) {
+    if (mParamResume) {
+      PacketIndex = SpdmDumpCheckpointResume (FileData, FileSize);
+    }
+    mCheckpointFile = fopen (mParamCheckpointFileName, "ab");
+  } else if ((FileData != NULL) && (FileSize >= sizeof(UINT64)) &&
+             (((SPDM_DUMP_CHECKPOINT_HEADER *)FileData)->Signature != SPDM_DUMP_CHECKPOINT_SIGNATURE)) {
+    //
+    // Do not overwrite a file which is not a checkpoint file.
+    //
+    printf ("!!!%s is not a checkpoint file!!!\n", mParamCheckpointFileName);
+  } else {
+    //
+    // The checkpoints of another capture are dropped.
+    //
+    if (mParamResume) {
+      printf ("!!!No checkpoint of the capture, the capture is decoded from the first packet!!!\n");
+    }
+    ZeroMem (&Header, sizeof(Header));
+    Header.Signature = SPDM_DUMP_CHECKPOINT_SIGNATURE;
+    Header.Version = SPDM_DUMP_CHECKPOINT_VERSION;
+    Header.CaptureSize = CaptureSize;
+    Header.CaptureModifyTime = CaptureModifyTime;
+    mCheckpointFile = fopen (mParamCheckpointFileName, "wb");
+    if ((mCheckpointFile != NULL) && (fwrite (&Header, 1, sizeof(Header), mCheckpointFile) != sizeof(Header))) {
+      fclose (mCheckpointFile);
+      mCheckpointFile = NULL;
+    }
+  }
+  if (FileData != NULL) {
+    ZeroMem (FileData, FileSize);
+    free (FileData);
+  }
+  if (mCheckpointFile == NULL) {
+    printf ("!!!Unable to write the checkpoint file %s!!!\n", mParamCheckpointFileName);
+  }
+
+  mCheckpointLastPacket = PacketIndex;
+  return PacketIndex;
+}
+
+/**
+  Take a checkpoint before a packet is decoded, if the interval of --checkpoint_interval has passed.
+
+  @param  PacketIndex                  The index of the packet.
+  @param  PcapPacketHeader             The pcap packet header of the packet, read by GetPcapPacket.
+**/
+VOID
+SpdmDumpCheckpointPacket (
+  IN UINTN               PacketIndex,
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader
+  )
+{
+  SPDM_DUMP_CHECKPOINT          *Checkpoint;
+  SPDM_DUMP_CHECKPOINT_SESSION  *Session;
+  SPDM_DATA_PARAMETER           Parameter;
+  VOID                          *SessionInfo;
+  VOID                          *SecuredMessageContext;
+  BOOLEAN                       UsePsk;
+  UINT8                         MutAuthRequested;
+  UINTN                         DataSize;
+  UINTN                         SecretsSize;
+  UINTN                         KeysSize;
+  UINT8                         *Ptr;
+  UINTN                         Index;
+  BOOLEAN                       Overdue;
+
+  if ((mCheckpointFile == NULL) || (PacketIndex - mCheckpointLastPacket < mParamCheckpointInterval)) {
+    return ;
+  }
+  Overdue = (BOOLEAN)(PacketIndex - mCheckpointLastPacket >= (UINTN)mParamCheckpointInterval * 2);
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    if (mCheckpointSessionId[Index] == 0) {
+      continue;
+    }
+    SessionInfo = SpdmGetSessionInfoViaSessionId (mSpdmContext, mCheckpointSessionId[Index]);
+    if (SessionInfo == NULL) {
+      mCheckpointSessionId[Index] = 0;
+      continue;
+    }
+    if (!Overdue &&
+        (SpdmSecuredMessageGetSessionState (SpdmGetSecuredMessageContextViaSessionInfo (SessionInfo)) == SpdmSessionStateHandshaking)) {
+      return ;
+    }
+  }
+
+  Checkpoint = (VOID *)mCheckpointBuffer;
+  ZeroMem (Checkpoint, sizeof(SPDM_DUMP_CHECKPOINT));
+  Checkpoint->DataLinkType = GetDataLinkType ();
+  Checkpoint->PacketIndex = PacketIndex;
+  Checkpoint->PacketOffset = GetPcapPacketOffset ();
+  Checkpoint->PacketTime = GetPcapPacketTime (PcapPacketHeader);
+  Checkpoint->RequesterCapabilitiesFlags = mSpdmRequesterCapabilitiesFlags;
+  Checkpoint->ResponderCapabilitiesFlags = mSpdmResponderCapabilitiesFlags;
+  Checkpoint->MeasurementHashAlgo = mSpdmMeasurementHashAlgo;
+  Checkpoint->BaseAsymAlgo = mSpdmBaseAsymAlgo;
+  Checkpoint->BaseHashAlgo = mSpdmBaseHashAlgo;
+  Checkpoint->DHENamedGroup = mSpdmDHENamedGroup;
+  Checkpoint->AEADCipherSuite = mSpdmAEADCipherSuite;
+  Checkpoint->ReqBaseAsymAlg = mSpdmReqBaseAsymAlg;
+  Checkpoint->KeySchedule = mSpdmKeySchedule;
+  Checkpoint->MeasurementSpec = mSpdmMeasurementSpec;
+  Checkpoint->CachedGetMeasurementRequestAttribute = mCachedGetMeasurementRequestAttribute;
+  Checkpoint->CachedGetMeasurementOperation = mCachedGetMeasurementOperation;
+  Checkpoint->CachedMeasurementSummaryHashType = mCachedMeasurementSummaryHashType;
+  Checkpoint->CachedSessionId = mCachedSessionId;
+  Checkpoint->CurrentSessionId = mCurrentSessionId;
+  Checkpoint->MessageASize = (UINT32)mSpdmMessageABufferSize;
+  Checkpoint->LastMessageSize = (UINT32)mSpdmLastMessageBufferSize;
+  Checkpoint->CertChainOffset = (UINT32)mCachedSpdmCertChainBufferOffset;
+  Checkpoint->CertChainSize = (UINT32)mSpdmCertChainBufferSize;
+
+  Ptr = (UINT8 *)(Checkpoint + 1);
+  CopyMem (Ptr, mSpdmMessageABuffer, mSpdmMessageABufferSize);
+  Ptr += mSpdmMessageABufferSize;
+  CopyMem (Ptr, mSpdmLastMessageBuffer, mSpdmLastMessageBufferSize);
+  Ptr += mSpdmLastMessageBufferSize;
+  CopyMem (Ptr, mSpdmCertChainBuffer, mSpdmCertChainBufferSize);
+  Ptr += mSpdmCertChainBufferSize;
+
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    if (mCheckpointSessionId[Index] == 0) {
+      continue;
+    }
+    SessionInfo = SpdmGetSessionInfoViaSessionId (mSpdmContext, mCheckpointSessionId[Index]);
+    SecuredMessageContext = SpdmGetSecuredMessageContextViaSessionInfo (SessionInfo);
+    if (SpdmSecuredMessageGetSessionState (SecuredMessageContext) != SpdmSessionStateEstablished) {
+      continue;
+    }
+
+    ZeroMem (&Parameter, sizeof(Parameter));
+    Parameter.Location = SpdmDataLocationSession;
+    *(UINT32 *)Parameter.AdditionalData = mCheckpointSessionId[Index];
+    UsePsk = FALSE;
+    DataSize = sizeof(UsePsk);
+    SpdmGetData (mSpdmContext, SpdmDataSessionUsePsk, &Parameter, &UsePsk, &DataSize);
+    MutAuthRequested = 0;
+    DataSize = sizeof(MutAuthRequested);
+    SpdmGetData (mSpdmContext, SpdmDataSessionMutAuthRequested, &Parameter, &MutAuthRequested, &DataSize);
+
+    Session = (VOID *)Ptr;
+    SecretsSize = SPDM_DUMP_CHECKPOINT_MAX_SECRETS_SIZE;
+    KeysSize = SPDM_DUMP_CHECKPOINT_MAX_KEYS_SIZE;
+    if (RETURN_ERROR (SpdmSecuredMessageExportSessionSecrets (SecuredMessageContext, Session + 1, &SecretsSize)) ||
+        RETURN_ERROR (SpdmSecuredMessageExportSessionKeys (SecuredMessageContext, (UINT8 *)(Session + 1) + SecretsSize, &KeysSize))) {
+      continue;
+    }
+    Session->SessionId = mCheckpointSessionId[Index];
+    Session->UsePsk = UsePsk;
+    Session->MutAuthRequested = MutAuthRequested;
+    Session->Reserved = 0;
+    Session->SecretsSize = (UINT32)SecretsSize;
+    Session->KeysSize = (UINT32)KeysSize;
+    Ptr += sizeof(SPDM_DUMP_CHECKPOINT_SESSION) + SecretsSize + KeysSize;
+    Checkpoint->SessionCount++;
+  }
+  Checkpoint->CheckpointSize = (UINT32)(Ptr - mCheckpointBuffer);
+
+  //
+  // One write per checkpoint, flushed, so that an interrupted run leaves at most one truncated checkpoint.
+  //
+  if ((fwrite (Checkpoint, 1, Checkpoint->CheckpointSize, mCheckpointFile) != Checkpoint->CheckpointSize) ||
+      (fflush (mCheckpointFile) != 0)) {
+    printf ("!!!Unable to write the checkpoint file %s!!!\n", mParamCheckpointFileName);
+    fclose (mCheckpointFile);
+    mCheckpointFile = NULL;
+  }
+  ZeroMem (Checkpoint, Checkpoint->CheckpointSize);
+  mCheckpointLastPacket = PacketIndex;
+}
+
+/**
+  Close the checkpoint file.
+**/
+VOID
+SpdmDumpCheckpointClose (
+  VOID
+  )
+{
+  if (mCheckpointFile != NULL) {
+    fclose (mCheckpointFile);
+    mCheckpointFile = NULL;
+  }
+  if (mCheckpointBuffer != NULL) {
+    free (mCheckpointBuffer);
+    mCheckpointBuffer = NULL;
+  }
+}
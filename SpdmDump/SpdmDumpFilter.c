@@ -0,0 +1,577 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmDump.h"
+#include <stdarg.h>
+
+//
+// The filter of --filter is a list of terms separated by ',', and a packet is printed if it matches all the terms.
+// The values of a term are separated by '|', and the term matches if one value matches.
+//
+//   session=<SessionId>    The secured messages of the session, and the handshake messages establishing it.
+//   code=<Code>            The SPDM messages of the request code, and their responses, in the clear or decrypted.
+//   addr=<Address>         The MCTP packets from or to the endpoint ID.
+//   time=<Start>-<End>     The packets captured in the time window, in seconds of the pcap timestamp.
+//   error                  The SPDM_ERROR responses.
+//
+// Each term is evaluated at the cheapest layer which can decide it, so that most of the packets are skipped
+// before the secured message decryption and the detailed dump. The time, the address and the session are
+// decided by the pcap and transport headers, and the code of a secured message is decided after decryption.
+// A packet which does not match is still decoded, with the output dropped, if the SPDM context depends on it,
+// such as the messages of the connection, the handshake of a selected session and the secured messages of
+// a selected session, whose sequence numbers must be kept in sync.
+//
+#define SPDM_DUMP_FILTER_MAX_VALUE_COUNT  16
+
+typedef struct {
+  BOOLEAN  Enabled;
+  UINT32   SessionId[SPDM_DUMP_FILTER_MAX_VALUE_COUNT];
+  UINTN    SessionIdCount;
+  UINT8    Code[256 / 8];
+  BOOLEAN  HasCode;
+  UINT8    Address[SPDM_DUMP_FILTER_MAX_VALUE_COUNT];
+  UINTN    AddressCount;
+  BOOLEAN  HasTime;
+  UINT32   TimeStart;
+  UINT32   TimeEnd;
+  BOOLEAN  ErrorOnly;
+} SPDM_DUMP_FILTER;
+
+typedef enum {
+  SpdmDumpOutputPrint,
+  SpdmDumpOutputMute,
+  SpdmDumpOutputHold,
+} SPDM_DUMP_OUTPUT_MODE;
+
+SPDM_DUMP_FILTER       mSpdmDumpFilter;
+
+SPDM_DUMP_OUTPUT_MODE  mSpdmDumpOutputMode = SpdmDumpOutputPrint;
+CHAR8                  *mSpdmDumpHoldBuffer;
+UINTN                  mSpdmDumpHoldBufferSize;
+UINTN                  mSpdmDumpHoldLength;
+
+//
+// The handshake in the clear, to select its messages by session.
+//
+UINT16                 mSpdmDumpFilterReqSessionId;
+BOOLEAN                mSpdmDumpFilterHandshakeSelected = TRUE;
+
+extern VOID            *mSpdmContext;
+extern VOID            *mCurrentSessionInfo;
+extern UINT32          mCurrentSessionId;
+
+//
+// The SPDM messages which update the SPDM context of the dump, or the cache used by the dump of the response.
+//
+UINT8  mSpdmDumpFilterStateCode[] = {
+  SPDM_GET_VERSION,
+  SPDM_VERSION,
+  SPDM_GET_CAPABILITIES,
+  SPDM_CAPABILITIES,
+  SPDM_NEGOTIATE_ALGORITHMS,
+  SPDM_ALGORITHMS,
+  SPDM_GET_CERTIFICATE,
+  SPDM_CERTIFICATE,
+  SPDM_CHALLENGE,
+  SPDM_GET_MEASUREMENTS,
+  SPDM_ERROR,
+  SPDM_KEY_EXCHANGE,
+  SPDM_KEY_EXCHANGE_RSP,
+  SPDM_FINISH,
+  SPDM_FINISH_RSP,
+  SPDM_PSK_EXCHANGE,
+  SPDM_PSK_EXCHANGE_RSP,
+  SPDM_PSK_FINISH,
+  SPDM_PSK_FINISH_RSP,
+  SPDM_KEY_UPDATE,
+  SPDM_KEY_UPDATE_ACK,
+  SPDM_END_SESSION,
+  SPDM_END_SESSION_ACK,
+  SPDM_GET_ENCAPSULATED_REQUEST,
+  SPDM_ENCAPSULATED_REQUEST,
+  SPDM_DELIVER_ENCAPSULATED_RESPONSE,
+  SPDM_ENCAPSULATED_RESPONSE_ACK,
+};
+
+/**
+  Print to stdout, or hold or drop the output of the packet, according to the filter.
+**/
+int
+SpdmDumpPrint (
+  IN CONST CHAR8  *Format,
+  ...
+  )
+{
+  va_list  Marker;
+  va_list  MarkerCopy;
+  int      Length;
+  CHAR8    *HoldBuffer;
+  UINTN    HoldBufferSize;
+
+  //
+  // The statistics of --stats replace the trace of the packets.
+  //
+  if (mParamStatistics) {
+    return 0;
+  }
+
+  //
+  // The records of --format jsonl replace the text of the packets, and the other messages go to stderr.
+  //
+  if (mParamOutputFormat == SPDM_DUMP_OUTPUT_FORMAT_JSONL) {
+    if (SpdmDumpJsonIsInPacket ()) {
+      return 0;
+    }
+    va_start (Marker, Format);
+    Length = vfprintf (stderr, Format, Marker);
+    va_end (Marker);
+    return Length;
+  }
+
+  switch (mSpdmDumpOutputMode) {
+  case SpdmDumpOutputMute:
+    return 0;
+  case SpdmDumpOutputHold:
+    va_start (Marker, Format);
+    va_copy (MarkerCopy, Marker);
+    Length = vsnprintf (NULL, 0, Format, Marker);
+    va_end (Marker);
+    if (Length < 0) {
+      va_end (MarkerCopy);
+      return Length;
+    }
+    if (mSpdmDumpHoldLength + Length + 1 > mSpdmDumpHoldBufferSize) {
+      HoldBufferSize = (mSpdmDumpHoldLength + Length + 1) * 2;
+      HoldBuffer = realloc (mSpdmDumpHoldBuffer, HoldBufferSize);
+      if (HoldBuffer == NULL) {
+        va_end (MarkerCopy);
+        return -1;
+      }
+      mSpdmDumpHoldBuffer = HoldBuffer;
+      mSpdmDumpHoldBufferSize = HoldBufferSize;
+    }
+    vsnprintf (mSpdmDumpHoldBuffer + mSpdmDumpHoldLength, Length + 1, Format, MarkerCopy);
+    va_end (MarkerCopy);
+    mSpdmDumpHoldLength += Length;
+    return Length;
+  default:
+    va_start (Marker, Format);
+    Length = vprintf (Format, Marker);
+    va_end (Marker);
+    return Length;
+  }
+}
+
+/**
+  Parse one value of a filter term.
+
+  @param  String                       The value.
+  @param  End                          The end of the value.
+  @param  Value                        The value parsed.
+
+  @retval TRUE   the value is parsed.
+  @retval FALSE  the value is invalid.
+**/
+BOOLEAN
+SpdmDumpParseFilterValue (
+  IN  CHAR8   *String,
+  IN  CHAR8   *End,
+  OUT UINT32  *Value
+  )
+{
+  CHAR8  *ValueEnd;
+
+  if (String == End) {
+    return FALSE;
+  }
+  *Value = (UINT32)strtoul (String, &ValueEnd, 0);
+  return (BOOLEAN)(ValueEnd == End);
+}
+
+/**
+  Parse the filter expression of --filter.
+
+  @param  Expression                   The filter expression.
+
+  @retval TRUE   the filter is parsed.
+  @retval FALSE  the filter is invalid.
+**/
+BOOLEAN
+SpdmDumpParseFilter (
+  IN CHAR8  *Expression
+  )
+{
+  CHAR8   *Term;
+  CHAR8   *TermEnd;
+  CHAR8   *Value;
+  CHAR8   *ValueEnd;
+  CHAR8   *Separator;
+  UINT32  Data32;
+  UINT32  TimeEnd;
+
+  ZeroMem (&mSpdmDumpFilter, sizeof(mSpdmDumpFilter));
+  mSpdmDumpFilter.Enabled = TRUE;
+
+  for (Term = Expression; *Term != 0; Term = (*TermEnd == 0) ? TermEnd : TermEnd + 1) {
+    TermEnd = strchr (Term, ',');
+    if (TermEnd == NULL) {
+      TermEnd = Term + strlen (Term);
+    }
+    if ((UINTN)(TermEnd - Term) == sizeof("error") - 1 && strncmp (Term, "error", sizeof("error") - 1) == 0) {
+      mSpdmDumpFilter.ErrorOnly = TRUE;
+      continue;
+    }
+    Value = memchr (Term, '=', TermEnd - Term);
+    if (Value == NULL) {
+      printf ("invalid filter term %.*s\n", (int)(TermEnd - Term), Term);
+      return FALSE;
+    }
+    Value++;
+    if (Value == TermEnd) {
+      printf ("invalid filter term %.*s\n", (int)(TermEnd - Term), Term);
+      return FALSE;
+    }
+
+    if (strncmp (Term, "time=", sizeof("time=") - 1) == 0) {
+      Separator = memchr (Value, '-', TermEnd - Value);
+      if (Separator == NULL) {
+        printf ("invalid filter term %.*s\n", (int)(TermEnd - Term), Term);
+        return FALSE;
+      }
+      mSpdmDumpFilter.HasTime = TRUE;
+      mSpdmDumpFilter.TimeStart = 0;
+      mSpdmDumpFilter.TimeEnd = MAX_UINT32;
+      if (((Separator != Value) && !SpdmDumpParseFilterValue (Value, Separator, &mSpdmDumpFilter.TimeStart)) ||
+          ((Separator + 1 != TermEnd) && !SpdmDumpParseFilterValue (Separator + 1, TermEnd, &TimeEnd))) {
+        printf ("invalid filter term %.*s\n", (int)(TermEnd - Term), Term);
+        return FALSE;
+      }
+      if (Separator + 1 != TermEnd) {
+        mSpdmDumpFilter.TimeEnd = TimeEnd;
+      }
+      continue;
+    }
+
+    for (; Value < TermEnd; Value = ValueEnd + 1) {
+      ValueEnd = memchr (Value, '|', TermEnd - Value);
+      if (ValueEnd == NULL) {
+        ValueEnd = TermEnd;
+      }
+      if (!SpdmDumpParseFilterValue (Value, ValueEnd, &Data32)) {
+        printf ("invalid filter term %.*s\n", (int)(TermEnd - Term), Term);
+        return FALSE;
+      }
+      if ((strncmp (Term, "session=", sizeof("session=") - 1) == 0) &&
+          (mSpdmDumpFilter.SessionIdCount < SPDM_DUMP_FILTER_MAX_VALUE_COUNT)) {
+        mSpdmDumpFilter.SessionId[mSpdmDumpFilter.SessionIdCount++] = Data32;
+      } else if ((strncmp (Term, "code=", sizeof("code=") - 1) == 0) && (Data32 <= MAX_UINT8)) {
+        mSpdmDumpFilter.Code[Data32 / 8] |= (UINT8)(1 << (Data32 % 8));
+        mSpdmDumpFilter.HasCode = TRUE;
+      } else if ((strncmp (Term, "addr=", sizeof("addr=") - 1) == 0) && (Data32 <= MAX_UINT8) &&
+                 (mSpdmDumpFilter.AddressCount < SPDM_DUMP_FILTER_MAX_VALUE_COUNT)) {
+        mSpdmDumpFilter.Address[mSpdmDumpFilter.AddressCount++] = (UINT8)Data32;
+      } else {
+        printf ("invalid filter term %.*s\n", (int)(TermEnd - Term), Term);
+        return FALSE;
+      }
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Check if the SPDM message updates the SPDM context of the dump.
+**/
+BOOLEAN
+SpdmDumpFilterIsStateCode (
+  IN UINT8  Code
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE(mSpdmDumpFilterStateCode); Index++) {
+    if (mSpdmDumpFilterStateCode[Index] == Code) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Check if a request code or a response code matches the code and the error terms.
+
+  @param  SpdmMessage                  The SPDM message, or NULL if it is not an SPDM message.
+  @param  SpdmMessageSize              Size in bytes of the SPDM message.
+**/
+BOOLEAN
+SpdmDumpFilterMatchCode (
+  IN UINT8  *SpdmMessage, OPTIONAL
+  IN UINTN  SpdmMessageSize
+  )
+{
+  UINT8  Code;
+
+  if ((SpdmMessage == NULL) || (SpdmMessageSize < sizeof(SPDM_MESSAGE_HEADER))) {
+    return (BOOLEAN)(!mSpdmDumpFilter.HasCode && !mSpdmDumpFilter.ErrorOnly);
+  }
+  Code = ((SPDM_MESSAGE_HEADER *)SpdmMessage)->RequestResponseCode;
+  if (mSpdmDumpFilter.ErrorOnly && (Code != SPDM_ERROR)) {
+    return FALSE;
+  }
+  if (mSpdmDumpFilter.HasCode &&
+      ((mSpdmDumpFilter.Code[Code / 8] & (1 << (Code % 8))) == 0) &&
+      ((mSpdmDumpFilter.Code[(Code | 0x80) / 8] & (1 << ((Code | 0x80) % 8))) == 0)) {
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Check if a session is selected by the session term.
+
+  @param  SessionId                    The SessionId.
+  @param  ReqSessionIdOnly             Only the ReqSessionID of the SessionId is known.
+**/
+BOOLEAN
+SpdmDumpFilterMatchSession (
+  IN UINT32   SessionId,
+  IN BOOLEAN  ReqSessionIdOnly
+  )
+{
+  UINTN  Index;
+
+  if (mSpdmDumpFilter.SessionIdCount == 0) {
+    return TRUE;
+  }
+  for (Index = 0; Index < mSpdmDumpFilter.SessionIdCount; Index++) {
+    if (ReqSessionIdOnly ? ((mSpdmDumpFilter.SessionId[Index] >> 16) == (SessionId >> 16)) :
+                           (mSpdmDumpFilter.SessionId[Index] == SessionId)) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Check if the time and the address terms match the pcap packet.
+**/
+BOOLEAN
+SpdmDumpFilterMatchTransport (
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader,
+  IN UINT8               *Buffer,
+  IN UINTN               BufferSize
+  )
+{
+  MCTP_HEADER  *MctpHeader;
+  UINTN        Index;
+
+  if (mSpdmDumpFilter.HasTime &&
+      ((PcapPacketHeader->TsSec < mSpdmDumpFilter.TimeStart) || (PcapPacketHeader->TsSec > mSpdmDumpFilter.TimeEnd))) {
+    return FALSE;
+  }
+  if (mSpdmDumpFilter.AddressCount != 0) {
+    if ((GetDataLinkType () != LINKTYPE_MCTP) || (BufferSize < sizeof(MCTP_HEADER))) {
+      return FALSE;
+    }
+    MctpHeader = (VOID *)Buffer;
+    for (Index = 0; Index < mSpdmDumpFilter.AddressCount; Index++) {
+      if ((mSpdmDumpFilter.Address[Index] == MctpHeader->SourceId) ||
+          (mSpdmDumpFilter.Address[Index] == MctpHeader->DestinationId)) {
+        break;
+      }
+    }
+    if (Index == mSpdmDumpFilter.AddressCount) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Evaluate the filter on the pcap and transport headers of a packet, before it is decoded.
+
+  The output of the packet is printed, held until the secured message is decrypted, or dropped.
+  SpdmDumpFilterEndPacket must be called once the packet is decoded.
+
+  @param  PcapPacketHeader             The pcap packet header.
+  @param  Buffer                       The pcap packet.
+  @param  BufferSize                   Size in bytes of the pcap packet.
+
+  @retval TRUE   the packet is decoded.
+  @retval FALSE  the packet is skipped, because it is not printed and the SPDM context does not depend on it.
+**/
+BOOLEAN
+SpdmDumpFilterPacket (
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader,
+  IN UINT8               *Buffer,
+  IN UINTN               BufferSize
+  )
+{
+  BOOLEAN  TransportMatch;
+  BOOLEAN  SessionMatch;
+  UINT32   SessionId;
+  UINT8    *SpdmMessage;
+  UINTN    SpdmMessageSize;
+  UINT8    Code;
+  UINT16   RspSessionId;
+
+  mSpdmDumpOutputMode = SpdmDumpOutputPrint;
+  if (!mSpdmDumpFilter.Enabled) {
+    return TRUE;
+  }
+
+  TransportMatch = SpdmDumpFilterMatchTransport (PcapPacketHeader, Buffer, BufferSize);
+
+  if (ScanPcapPacket (Buffer, BufferSize, &SessionId, &SpdmMessage, &SpdmMessageSize)) {
+    if (!SpdmDumpFilterMatchSession (SessionId, FALSE)) {
+      //
+      // The session is not decrypted. Only track the current session, for the ERROR in the clear.
+      //
+      mCurrentSessionInfo = SpdmGetSessionInfoViaSessionId (mSpdmContext, SessionId);
+      mCurrentSessionId = SessionId;
+      return FALSE;
+    }
+    if (!TransportMatch) {
+      mSpdmDumpOutputMode = SpdmDumpOutputMute;
+    } else if (mSpdmDumpFilter.HasCode || mSpdmDumpFilter.ErrorOnly) {
+      mSpdmDumpOutputMode = SpdmDumpOutputHold;
+      mSpdmDumpHoldLength = 0;
+    }
+    return TRUE;
+  }
+
+  if (SpdmMessage == NULL) {
+    //
+    // It is not an SPDM message, and it is only matched by the transport layer terms.
+    //
+    return (BOOLEAN)(TransportMatch && SpdmDumpFilterMatchCode (NULL, 0) && (mSpdmDumpFilter.SessionIdCount == 0));
+  }
+
+  Code = ((SPDM_MESSAGE_HEADER *)SpdmMessage)->RequestResponseCode;
+  SessionMatch = (BOOLEAN)(mSpdmDumpFilter.SessionIdCount == 0);
+  switch (Code) {
+  case SPDM_KEY_EXCHANGE:
+  case SPDM_PSK_EXCHANGE:
+    if (SpdmMessageSize >= sizeof(SPDM_MESSAGE_HEADER) + sizeof(UINT16)) {
+      CopyMem (&mSpdmDumpFilterReqSessionId, SpdmMessage + sizeof(SPDM_MESSAGE_HEADER), sizeof(UINT16));
+    }
+    SessionMatch = SpdmDumpFilterMatchSession ((UINT32)mSpdmDumpFilterReqSessionId << 16, TRUE);
+    break;
+  case SPDM_KEY_EXCHANGE_RSP:
+  case SPDM_PSK_EXCHANGE_RSP:
+    SessionId = (UINT32)mSpdmDumpFilterReqSessionId << 16;
+    if (SpdmMessageSize >= sizeof(SPDM_MESSAGE_HEADER) + sizeof(UINT16)) {
+      CopyMem (&RspSessionId, SpdmMessage + sizeof(SPDM_MESSAGE_HEADER), sizeof(UINT16));
+      SessionId |= RspSessionId;
+    }
+    //
+    // The session keys are not derived for a session which is not selected.
+    //
+    mSpdmDumpFilterHandshakeSelected = SpdmDumpFilterMatchSession (SessionId, FALSE);
+    if (!mSpdmDumpFilterHandshakeSelected) {
+      return FALSE;
+    }
+    SessionMatch = TRUE;
+    break;
+  case SPDM_FINISH:
+  case SPDM_FINISH_RSP:
+    if (!mSpdmDumpFilterHandshakeSelected) {
+      return FALSE;
+    }
+    SessionMatch = TRUE;
+    break;
+  default:
+    break;
+  }
+
+  if (TransportMatch && SessionMatch && SpdmDumpFilterMatchCode (SpdmMessage, SpdmMessageSize)) {
+    return TRUE;
+  }
+  if (SpdmDumpFilterIsStateCode (Code)) {
+    mSpdmDumpOutputMode = SpdmDumpOutputMute;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/**
+  Evaluate the filter on a decrypted secured message, before it is dumped.
+
+  @param  DecryptedMessage             The decrypted message, or NULL if it cannot be decrypted.
+  @param  DecryptedMessageSize         Size in bytes of the decrypted message.
+
+  @retval TRUE   the decrypted message is decoded.
+  @retval FALSE  the decrypted message is skipped, because it is not printed and the SPDM context does not depend on it.
+**/
+BOOLEAN
+SpdmDumpFilterDecryptedMessage (
+  IN UINT8  *DecryptedMessage, OPTIONAL
+  IN UINTN  DecryptedMessageSize
+  )
+{
+  UINT8  *SpdmMessage;
+  UINTN  SpdmMessageSize;
+
+  if (mSpdmDumpOutputMode == SpdmDumpOutputPrint) {
+    return TRUE;
+  }
+
+  SpdmMessage = DecryptedMessage;
+  SpdmMessageSize = DecryptedMessageSize;
+  if ((DecryptedMessage != NULL) && (GetDataLinkType () == LINKTYPE_MCTP)) {
+    if ((DecryptedMessageSize < sizeof(MCTP_MESSAGE_HEADER)) ||
+        (((MCTP_MESSAGE_HEADER *)DecryptedMessage)->MessageType != MCTP_MESSAGE_TYPE_SPDM)) {
+      SpdmMessage = NULL;
+    } else {
+      SpdmMessage += sizeof(MCTP_MESSAGE_HEADER);
+      SpdmMessageSize -= sizeof(MCTP_MESSAGE_HEADER);
+    }
+  }
+
+  if (mSpdmDumpOutputMode == SpdmDumpOutputHold) {
+    if (SpdmDumpFilterMatchCode (SpdmMessage, SpdmMessageSize)) {
+      mSpdmDumpOutputMode = SpdmDumpOutputPrint;
+      if (mSpdmDumpHoldLength != 0) {
+        fwrite (mSpdmDumpHoldBuffer, 1, mSpdmDumpHoldLength, stdout);
+        mSpdmDumpHoldLength = 0;
+      }
+      return TRUE;
+    }
+    mSpdmDumpOutputMode = SpdmDumpOutputMute;
+    mSpdmDumpHoldLength = 0;
+  }
+
+  if ((SpdmMessage == NULL) || (SpdmMessageSize < sizeof(SPDM_MESSAGE_HEADER))) {
+    return FALSE;
+  }
+  return SpdmDumpFilterIsStateCode (((SPDM_MESSAGE_HEADER *)SpdmMessage)->RequestResponseCode);
+}
+
+/**
+  End the output of a packet. The output held by SpdmDumpFilterPacket is dropped if it is not decided.
+**/
+VOID
+SpdmDumpFilterEndPacket (
+  VOID
+  )
+{
+  mSpdmDumpOutputMode = SpdmDumpOutputPrint;
+  mSpdmDumpHoldLength = 0;
+}
+
+/**
+  Check if the message being decoded is not selected by the filter, and it is decoded only for the SPDM context.
+**/
+BOOLEAN
+SpdmDumpFilterIsOutputMuted (
+  VOID
+  )
+{
+  return (BOOLEAN)(mSpdmDumpOutputMode == SpdmDumpOutputMute);
+}
@@ -0,0 +1,304 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmDump.h"
+
+//
+// The index of a capture has one entry per packet, in packet order, with the offset of the packet in
+// the capture, the session of the packet and its request or response code. It is saved by --index, and
+// is used again as long as the size and the modification time of the capture do not change, so that
+// --session reads only the packets it decodes instead of scanning the capture again.
+//
+// The session of a packet is the SessionId of a secured message, or the session established by a
+// KEY_EXCHANGE or PSK_EXCHANGE, for the exchange and the FINISH in the clear. The other normal messages
+// are out of any session. They are decoded for every session, because the session keys depend on them.
+//
+#define SPDM_DUMP_INDEX_SIGNATURE  SIGNATURE_64 ('S', 'P', 'D', 'M', 'I', 'N', 'D', 'X')
+#define SPDM_DUMP_INDEX_VERSION    1
+
+#define SPDM_DUMP_INDEX_FLAG_SECURED     BIT0
+#define SPDM_DUMP_INDEX_FLAG_BAD_PACKET  BIT1
+
+#pragma pack(1)
+
+typedef struct {
+  UINT64  Signature;
+  UINT32  Version;
+  UINT32  EntrySize;
+  UINT64  CaptureSize;
+  UINT64  CaptureModifyTime;
+  UINT64  PacketCount;
+//SPDM_DUMP_INDEX_ENTRY  Entry[PacketCount];
+} SPDM_DUMP_INDEX_HEADER;
+
+typedef struct {
+  UINT64  Offset;
+  UINT32  SessionId;
+  UINT32  DataLinkType;
+  UINT8   RequestResponseCode;
+  UINT8   Flags;
+  UINT8   Reserved[6];
+} SPDM_DUMP_INDEX_ENTRY;
+
+#pragma pack()
+
+/**
+  Scan the pcap file, and build its index.
+
+  @param  CaptureSize                  The size in bytes of the pcap file.
+  @param  CaptureModifyTime            The modification time of the pcap file.
+
+  @return the index, to be freed by the caller, or NULL if the memory is out of resources.
+**/
+SPDM_DUMP_INDEX_HEADER *
+BuildPcapIndex (
+  IN UINT64  CaptureSize,
+  IN UINT64  CaptureModifyTime
+  )
+{
+  SPDM_DUMP_INDEX_HEADER  *IndexHeader;
+  SPDM_DUMP_INDEX_HEADER  *NewIndexHeader;
+  SPDM_DUMP_INDEX_ENTRY   *Entry;
+  UINTN                   MaxPacketCount;
+  UINTN                   PacketCount;
+  UINTN                   ExchangePacket;
+  PCAP_PACKET_HEADER      PcapPacketHeader;
+  UINT8                   *Data;
+  RETURN_STATUS           Status;
+  UINT32                  SessionId;
+  UINT32                  CurrentSessionId;
+  UINT16                  ReqSessionId;
+  UINT8                   *SpdmMessage;
+  UINTN                   SpdmMessageSize;
+
+  IndexHeader = NULL;
+  MaxPacketCount = 0;
+  PacketCount = 0;
+  ExchangePacket = MAX_UINTN;
+  CurrentSessionId = 0;
+  ReqSessionId = 0;
+
+  RewindPcapPacketFile ();
+  while (TRUE) {
+    Status = GetPcapPacket (&PcapPacketHeader, &Data);
+    if (Status == RETURN_END_OF_FILE) {
+      break;
+    }
+    if (PacketCount == MaxPacketCount) {
+      MaxPacketCount = (MaxPacketCount == 0) ? 0x10000 : MaxPacketCount * 2;
+      NewIndexHeader = realloc (IndexHeader, sizeof(SPDM_DUMP_INDEX_HEADER) + MaxPacketCount * sizeof(SPDM_DUMP_INDEX_ENTRY));
+      if (NewIndexHeader == NULL) {
+        free (IndexHeader);
+        return NULL;
+      }
+      IndexHeader = NewIndexHeader;
+    }
+    Entry = (SPDM_DUMP_INDEX_ENTRY *)(IndexHeader + 1) + PacketCount;
+    PacketCount++;
+    ZeroMem (Entry, sizeof(SPDM_DUMP_INDEX_ENTRY));
+    Entry->Offset = GetPcapPacketOffset ();
+    Entry->DataLinkType = GetDataLinkType ();
+    if (RETURN_ERROR(Status)) {
+      Entry->Flags |= SPDM_DUMP_INDEX_FLAG_BAD_PACKET;
+      break;
+    }
+
+    if (ScanPcapPacket (Data, PcapPacketHeader.InclLen, &SessionId, &SpdmMessage, &SpdmMessageSize)) {
+      Entry->Flags |= SPDM_DUMP_INDEX_FLAG_SECURED;
+      Entry->SessionId = SessionId;
+      continue;
+    }
+    if (SpdmMessage == NULL) {
+      continue;
+    }
+
+    Entry->RequestResponseCode = ((SPDM_MESSAGE_HEADER *)SpdmMessage)->RequestResponseCode;
+    switch (Entry->RequestResponseCode) {
+    case SPDM_KEY_EXCHANGE:
+      if (SpdmMessageSize >= sizeof(SPDM_KEY_EXCHANGE_REQUEST)) {
+        ReqSessionId = ((SPDM_KEY_EXCHANGE_REQUEST *)SpdmMessage)->ReqSessionID;
+        ExchangePacket = PacketCount - 1;
+      }
+      break;
+    case SPDM_PSK_EXCHANGE:
+      if (SpdmMessageSize >= sizeof(SPDM_PSK_EXCHANGE_REQUEST)) {
+        ReqSessionId = ((SPDM_PSK_EXCHANGE_REQUEST *)SpdmMessage)->ReqSessionID;
+        ExchangePacket = PacketCount - 1;
+      }
+      break;
+    case SPDM_KEY_EXCHANGE_RSP:
+      if (SpdmMessageSize >= sizeof(SPDM_KEY_EXCHANGE_RESPONSE)) {
+        CurrentSessionId = ((UINT32)ReqSessionId << 16) | ((SPDM_KEY_EXCHANGE_RESPONSE *)SpdmMessage)->RspSessionID;
+      }
+      break;
+    case SPDM_PSK_EXCHANGE_RSP:
+      if (SpdmMessageSize >= sizeof(SPDM_PSK_EXCHANGE_RESPONSE)) {
+        CurrentSessionId = ((UINT32)ReqSessionId << 16) | ((SPDM_PSK_EXCHANGE_RESPONSE *)SpdmMessage)->RspSessionID;
+      }
+      break;
+    case SPDM_FINISH:
+    case SPDM_FINISH_RSP:
+      //
+      // FINISH in the clear belongs to the session of the last KEY_EXCHANGE.
+      //
+      Entry->SessionId = CurrentSessionId;
+      break;
+    default:
+      break;
+    }
+
+    if ((Entry->RequestResponseCode == SPDM_KEY_EXCHANGE_RSP) ||
+        (Entry->RequestResponseCode == SPDM_PSK_EXCHANGE_RSP)) {
+      Entry->SessionId = CurrentSessionId;
+      if (ExchangePacket != MAX_UINTN) {
+        ((SPDM_DUMP_INDEX_ENTRY *)(IndexHeader + 1))[ExchangePacket].SessionId = CurrentSessionId;
+        ExchangePacket = MAX_UINTN;
+      }
+    }
+  }
+  RewindPcapPacketFile ();
+
+  if (IndexHeader == NULL) {
+    IndexHeader = malloc (sizeof(SPDM_DUMP_INDEX_HEADER));
+    if (IndexHeader == NULL) {
+      return NULL;
+    }
+  }
+  IndexHeader->Signature = SPDM_DUMP_INDEX_SIGNATURE;
+  IndexHeader->Version = SPDM_DUMP_INDEX_VERSION;
+  IndexHeader->EntrySize = sizeof(SPDM_DUMP_INDEX_ENTRY);
+  IndexHeader->CaptureSize = CaptureSize;
+  IndexHeader->CaptureModifyTime = CaptureModifyTime;
+  IndexHeader->PacketCount = PacketCount;
+  return IndexHeader;
+}
+
+/**
+  Load the index of the pcap file.
+
+  @param  IndexFileName                The name of the index file.
+  @param  CaptureSize                  The size in bytes of the pcap file.
+  @param  CaptureModifyTime            The modification time of the pcap file.
+
+  @return the index, to be freed by the caller, or NULL if the index file does not exist or does not match.
+**/
+SPDM_DUMP_INDEX_HEADER *
+LoadPcapIndex (
+  IN CHAR8   *IndexFileName,
+  IN UINT64  CaptureSize,
+  IN UINT64  CaptureModifyTime
+  )
+{
+  FILE                    *FpIn;
+  SPDM_DUMP_INDEX_HEADER  Header;
+  SPDM_DUMP_INDEX_HEADER  *IndexHeader;
+
+  if ((FpIn = fopen (IndexFileName, "rb")) == NULL) {
+    return NULL;
+  }
+  if ((fread (&Header, 1, sizeof(Header), FpIn) != sizeof(Header)) ||
+      (Header.Signature != SPDM_DUMP_INDEX_SIGNATURE) ||
+      (Header.Version != SPDM_DUMP_INDEX_VERSION) ||
+      (Header.EntrySize != sizeof(SPDM_DUMP_INDEX_ENTRY)) ||
+      (Header.CaptureSize != CaptureSize) ||
+      (Header.CaptureModifyTime != CaptureModifyTime) ||
+      (Header.PacketCount > (MAX_UINTN - sizeof(Header)) / sizeof(SPDM_DUMP_INDEX_ENTRY))) {
+    fclose (FpIn);
+    return NULL;
+  }
+
+  IndexHeader = malloc (sizeof(Header) + (UINTN)Header.PacketCount * sizeof(SPDM_DUMP_INDEX_ENTRY));
+  if (IndexHeader == NULL) {
+    fclose (FpIn);
+    return NULL;
+  }
+  CopyMem (IndexHeader, &Header, sizeof(Header));
+  if (fread (IndexHeader + 1, sizeof(SPDM_DUMP_INDEX_ENTRY), (UINTN)Header.PacketCount, FpIn) != (UINTN)Header.PacketCount) {
+    free (IndexHeader);
+    fclose (FpIn);
+    return NULL;
+  }
+  fclose (FpIn);
+  return IndexHeader;
+}
+
+/**
+  Load or build the index of the pcap file, and decode the packets of the session selected by --session.
+
+  The index is saved to mParamIndexFileName if it is built.
+
+  @retval TRUE   the packets of the session are decoded.
+  @retval FALSE  the pcap file is not decoded, and the packets are decoded as usual.
+**/
+BOOLEAN
+DumpPcapIndexed (
+  VOID
+  )
+{
+  SPDM_DUMP_INDEX_HEADER  *IndexHeader;
+  SPDM_DUMP_INDEX_ENTRY   *Entry;
+  UINT64                  CaptureSize;
+  UINT64                  CaptureModifyTime;
+  UINTN                   Index;
+  PCAP_PACKET_HEADER      PcapPacketHeader;
+  UINT8                   *Data;
+  RETURN_STATUS           Status;
+
+  if (!GetPcapFileIdentity (&CaptureSize, &CaptureModifyTime)) {
+    printf ("!!!--index and --session need a regular pcap file, all the packets are decoded!!!\n");
+    return FALSE;
+  }
+
+  IndexHeader = NULL;
+  if (mParamIndexFileName != NULL) {
+    IndexHeader = LoadPcapIndex (mParamIndexFileName, CaptureSize, CaptureModifyTime);
+  }
+  if (IndexHeader == NULL) {
+    IndexHeader = BuildPcapIndex (CaptureSize, CaptureModifyTime);
+    if (IndexHeader == NULL) {
+      printf ("!!!Unable to build the index, all the packets are decoded!!!\n");
+      return FALSE;
+    }
+    if (mParamIndexFileName != NULL) {
+      WriteOutputFile (
+        mParamIndexFileName,
+        IndexHeader,
+        sizeof(SPDM_DUMP_INDEX_HEADER) + (UINTN)IndexHeader->PacketCount * sizeof(SPDM_DUMP_INDEX_ENTRY)
+        );
+    }
+  }
+
+  if (!mParamSessionFilter) {
+    free (IndexHeader);
+    return FALSE;
+  }
+
+  Entry = (SPDM_DUMP_INDEX_ENTRY *)(IndexHeader + 1);
+  for (Index = 0; Index < (UINTN)IndexHeader->PacketCount; Index++) {
+    if ((Entry[Index].SessionId != 0) && (Entry[Index].SessionId != mParamSessionId)) {
+      continue;
+    }
+    if (!SeekPcapPacketFile (Entry[Index].Offset, Entry[Index].DataLinkType)) {
+      break;
+    }
+    Status = GetPcapPacket (&PcapPacketHeader, &Data);
+    if (Status == RETURN_END_OF_FILE) {
+      break;
+    }
+    if (RETURN_ERROR(Status)) {
+      DumpPcapPacketHeader (Index + 1, &PcapPacketHeader);
+      break;
+    }
+    DumpPcapPacketFiltered (Index + 1, &PcapPacketHeader, Data);
+  }
+
+  free (IndexHeader);
+  RewindPcapPacketFile ();
+  return TRUE;
+}
@@ -0,0 +1,311 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmDump.h"
+
+//
+// The JSON Lines output of --format jsonl has one record for each SPDM message, in the clear, decrypted or
+// encapsulated, and one record for each packet without an SPDM message, such as a secured message which
+// cannot be decrypted. For example:
+//
+//   {"packet":3,"time_us":2000000,"length":102,"version":17,"code":228,"name":"SPDM_KEY_EXCHANGE","param1":0,"param2":0,"message":"11e4..."}
+//   {"packet":5,"time_us":4000000,"length":31,"session":"0x01000200","version":17,"code":232,...}
+//   {"packet":9,"time_us":8000000,"length":31,"session":"0x01010201","data":"010000c806..."}
+//
+// The records of a packet are built in one buffer, with a hex table instead of printf, and written to
+// stdout once the packet is decoded, so that the output of the parallel workers is merged in packet order.
+// The text of the dump routines is dropped, and the messages outside the packets are printed to stderr.
+//
+#define JSON_BUFFER_INITIAL_SIZE  0x10000
+
+CHAR8    *mJsonBuffer;
+UINTN    mJsonBufferSize;
+UINTN    mJsonLength;
+BOOLEAN  mJsonWriteFailed;
+
+CHAR8    mJsonHexTable[MAX_UINT8 + 1][2];
+BOOLEAN  mJsonHexTableReady;
+
+BOOLEAN  mJsonInPacket;
+UINTN    mJsonPacketIndex;
+UINT64   mJsonPacketTime;
+UINTN    mJsonPacketSize;
+UINT8    *mJsonPacketData;
+UINTN    mJsonPacketRecordCount;
+UINT32   mJsonPacketSessionId;
+BOOLEAN  mJsonPacketSecured;
+
+extern UINT32   mCurrentSessionId;
+extern BOOLEAN  mEncapsulated;
+extern BOOLEAN  mDecrypted;
+
+/**
+  Make room for Size more bytes in the buffer of the records.
+**/
+BOOLEAN
+JsonReserve (
+  IN UINTN  Size
+  )
+{
+  CHAR8  *NewBuffer;
+  UINTN  NewBufferSize;
+
+  if (mJsonLength + Size <= mJsonBufferSize) {
+    return TRUE;
+  }
+  NewBufferSize = (mJsonBufferSize == 0) ? JSON_BUFFER_INITIAL_SIZE : mJsonBufferSize;
+  while (NewBufferSize < mJsonLength + Size) {
+    NewBufferSize *= 2;
+  }
+  NewBuffer = realloc (mJsonBuffer, NewBufferSize);
+  if (NewBuffer == NULL) {
+    mJsonWriteFailed = TRUE;
+    return FALSE;
+  }
+  mJsonBuffer = NewBuffer;
+  mJsonBufferSize = NewBufferSize;
+  return TRUE;
+}
+
+VOID
+JsonAppend (
+  IN CONST CHAR8  *Data,
+  IN UINTN        Size
+  )
+{
+  if (!JsonReserve (Size)) {
+    return ;
+  }
+  CopyMem (mJsonBuffer + mJsonLength, Data, Size);
+  mJsonLength += Size;
+}
+
+/**
+  Append a string. The strings are names of this tool, so they are not escaped.
+**/
+VOID
+JsonAppendString (
+  IN CONST CHAR8  *String
+  )
+{
+  JsonAppend ("\"", 1);
+  JsonAppend (String, strlen (String));
+  JsonAppend ("\"", 1);
+}
+
+VOID
+JsonAppendUint64 (
+  IN UINT64  Value
+  )
+{
+  CHAR8  Digit[20];
+  UINTN  Index;
+
+  Index = sizeof(Digit);
+  do {
+    Digit[--Index] = (CHAR8)('0' + (Value % 10));
+    Value /= 10;
+  } while (Value != 0);
+  JsonAppend (Digit + Index, sizeof(Digit) - Index);
+}
+
+VOID
+JsonAppendHexDigits (
+  IN UINT8  *Data,
+  IN UINTN  Size
+  )
+{
+  UINTN  Index;
+  CHAR8  *Hex;
+
+  if (!JsonReserve (Size * 2)) {
+    return ;
+  }
+  Hex = mJsonBuffer + mJsonLength;
+  for (Index = 0; Index < Size; Index++) {
+    *Hex++ = mJsonHexTable[Data[Index]][0];
+    *Hex++ = mJsonHexTable[Data[Index]][1];
+  }
+  mJsonLength += Size * 2;
+}
+
+VOID
+JsonAppendHex (
+  IN UINT8  *Data,
+  IN UINTN  Size
+  )
+{
+  JsonAppend ("\"", 1);
+  JsonAppendHexDigits (Data, Size);
+  JsonAppend ("\"", 1);
+}
+
+/**
+  Append the key of a field, with the leading ',' except for the first field of a record.
+**/
+VOID
+JsonAppendKey (
+  IN CONST CHAR8  *Key
+  )
+{
+  JsonAppend (Key, strlen (Key));
+}
+
+VOID
+JsonAppendSessionId (
+  IN UINT32  SessionId
+  )
+{
+  UINT8  Data[sizeof(UINT32)];
+
+  Data[0] = (UINT8)(SessionId >> 24);
+  Data[1] = (UINT8)(SessionId >> 16);
+  Data[2] = (UINT8)(SessionId >> 8);
+  Data[3] = (UINT8)SessionId;
+  JsonAppendKey (",\"session\":\"0x");
+  JsonAppendHexDigits (Data, sizeof(Data));
+  JsonAppend ("\"", 1);
+}
+
+/**
+  Append the fields of the pcap packet of a record.
+**/
+VOID
+JsonAppendPacket (
+  VOID
+  )
+{
+  JsonAppendKey ("{\"packet\":");
+  JsonAppendUint64 (mJsonPacketIndex);
+  JsonAppendKey (",\"time_us\":");
+  JsonAppendUint64 (mJsonPacketTime);
+  JsonAppendKey (",\"length\":");
+  JsonAppendUint64 (mJsonPacketSize);
+}
+
+/**
+  Start the records of a pcap packet.
+
+  @param  Index                        The index of the packet, from 1.
+  @param  PcapPacketHeader             The pcap packet header.
+  @param  Buffer                       The pcap packet.
+**/
+VOID
+SpdmDumpJsonBeginPacket (
+  IN UINTN               Index,
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader,
+  IN UINT8               *Buffer
+  )
+{
+  UINTN  HexIndex;
+  UINT8  *SpdmMessage;
+  UINTN  SpdmMessageSize;
+
+  if (!mJsonHexTableReady) {
+    for (HexIndex = 0; HexIndex < ARRAY_SIZE(mJsonHexTable); HexIndex++) {
+      mJsonHexTable[HexIndex][0] = "0123456789abcdef"[HexIndex >> 4];
+      mJsonHexTable[HexIndex][1] = "0123456789abcdef"[HexIndex & 0xF];
+    }
+    mJsonHexTableReady = TRUE;
+  }
+
+  mJsonInPacket = TRUE;
+  mJsonPacketIndex = Index;
+  mJsonPacketTime = GetPcapPacketTime (PcapPacketHeader);
+  mJsonPacketSize = PcapPacketHeader->InclLen;
+  mJsonPacketData = Buffer;
+  mJsonPacketRecordCount = 0;
+  mJsonPacketSecured = ScanPcapPacket (Buffer, PcapPacketHeader->InclLen, &mJsonPacketSessionId, &SpdmMessage, &SpdmMessageSize);
+  mJsonLength = 0;
+}
+
+/**
+  Append the record of an SPDM message, in the clear, decrypted or encapsulated.
+
+  @param  SpdmMessage                  The SPDM message.
+  @param  SpdmMessageSize              Size in bytes of the SPDM message.
+**/
+VOID
+SpdmDumpJsonRecordMessage (
+  IN UINT8  *SpdmMessage,
+  IN UINTN  SpdmMessageSize
+  )
+{
+  SPDM_MESSAGE_HEADER  *SpdmHeader;
+
+  if (!mJsonInPacket || (SpdmMessageSize < sizeof(SPDM_MESSAGE_HEADER))) {
+    return ;
+  }
+  SpdmHeader = (VOID *)SpdmMessage;
+  mJsonPacketRecordCount++;
+
+  JsonAppendPacket ();
+  if (mDecrypted) {
+    JsonAppendSessionId (mCurrentSessionId);
+  }
+  if (mEncapsulated) {
+    JsonAppendKey (",\"encapsulated\":true");
+  }
+  JsonAppendKey (",\"version\":");
+  JsonAppendUint64 (SpdmHeader->SPDMVersion);
+  JsonAppendKey (",\"code\":");
+  JsonAppendUint64 (SpdmHeader->RequestResponseCode);
+  JsonAppendKey (",\"name\":");
+  JsonAppendString (GetSpdmMessageName (SpdmHeader->RequestResponseCode));
+  JsonAppendKey (",\"param1\":");
+  JsonAppendUint64 (SpdmHeader->Param1);
+  JsonAppendKey (",\"param2\":");
+  JsonAppendUint64 (SpdmHeader->Param2);
+  JsonAppendKey (",\"message\":");
+  JsonAppendHex (SpdmMessage, SpdmMessageSize);
+  JsonAppendKey ("}\n");
+}
+
+/**
+  Write the records of the pcap packet to stdout. A packet without an SPDM message has a record of the raw data.
+**/
+VOID
+SpdmDumpJsonEndPacket (
+  VOID
+  )
+{
+  if (!mJsonInPacket) {
+    return ;
+  }
+  mJsonInPacket = FALSE;
+
+  if ((mJsonPacketRecordCount == 0) && !SpdmDumpFilterIsOutputMuted ()) {
+    JsonAppendPacket ();
+    if (mJsonPacketSecured) {
+      JsonAppendSessionId (mJsonPacketSessionId);
+    }
+    JsonAppendKey (",\"data\":");
+    JsonAppendHex (mJsonPacketData, mJsonPacketSize);
+    JsonAppendKey ("}\n");
+  }
+
+  if (mJsonWriteFailed) {
+    fprintf (stderr, "!!!Unable to allocate the JSON record of packet %d!!!\n", (UINT32)mJsonPacketIndex);
+    mJsonWriteFailed = FALSE;
+  } else if (mJsonLength != 0) {
+    fwrite (mJsonBuffer, 1, mJsonLength, stdout);
+  }
+  mJsonLength = 0;
+}
+
+/**
+  Check if the records of a pcap packet are being built, so that the text of the dump routines is dropped.
+**/
+BOOLEAN
+SpdmDumpJsonIsInPacket (
+  VOID
+  )
+{
+  return mJsonInPacket;
+}
@@ -0,0 +1,265 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmDump.h"
+
+//
+// The key cache of --key_cache has the secrets derived by the key schedule of each session, so that a later
+// run imports them instead of importing the DHE secret or the PSK and running the key schedule again.
+//
+// An entry is keyed by the SessionId and the transcript hash the secrets are derived from: TH1 for the
+// handshake secrets, after KEY_EXCHANGE_RSP or PSK_EXCHANGE_RSP, and TH2 for the data secrets, after
+// FINISH_RSP or PSK_FINISH_RSP. The transcript hash binds the entry to the messages of the session, so that
+// a reused SessionId does not import the secrets of another session. The file is read, or created with its
+// header, before the capture is decoded, and the new entries are appended to it as the sessions are decoded.
+//
+// The KEY_UPDATE secrets are derived from the data secrets, so they are not cached.
+//
+#define SPDM_DUMP_KEY_CACHE_SIGNATURE  SIGNATURE_64 ('S', 'P', 'D', 'M', 'K', 'E', 'Y', 'C')
+#define SPDM_DUMP_KEY_CACHE_VERSION    1
+
+#define SPDM_DUMP_KEY_CACHE_MAX_SECRETS_SIZE  (sizeof(SPDM_SECURE_SESSION_SECRETS_STRUCT) + \
+                                               MAX_HASH_SIZE * 9 + (MAX_AEAD_KEY_SIZE + MAX_AEAD_IV_SIZE) * 4)
+
+#pragma pack(1)
+
+typedef struct {
+  UINT64  Signature;
+  UINT32  Version;
+  UINT32  Reserved;
+//SPDM_DUMP_KEY_CACHE_ENTRY  Entry[];
+} SPDM_DUMP_KEY_CACHE_HEADER;
+
+typedef struct {
+  UINT32  SessionId;
+  UINT8   Stage;
+  UINT8   Reserved;
+  UINT16  TranscriptHashSize;
+  UINT8   TranscriptHash[MAX_HASH_SIZE];
+  UINT32  SecretsSize;
+//UINT8   Secrets[SecretsSize];
+} SPDM_DUMP_KEY_CACHE_ENTRY;
+
+#pragma pack()
+
+extern UINT32  mSpdmBaseHashAlgo;
+
+UINT8    *mKeyCacheBuffer;
+UINTN    mKeyCacheBufferSize;
+BOOLEAN  mKeyCacheInvalid;
+
+/**
+  Create an empty key cache file, with its header.
+**/
+VOID
+SpdmDumpKeyCacheCreate (
+  VOID
+  )
+{
+  SPDM_DUMP_KEY_CACHE_HEADER  Header;
+
+  ZeroMem (&Header, sizeof(Header));
+  Header.Signature = SPDM_DUMP_KEY_CACHE_SIGNATURE;
+  Header.Version = SPDM_DUMP_KEY_CACHE_VERSION;
+  if (!WriteOutputFile (mParamKeyCacheFileName, &Header, sizeof(Header))) {
+    printf ("!!!Unable to create the key cache %s!!!\n", mParamKeyCacheFileName);
+    mKeyCacheInvalid = TRUE;
+  }
+}
+
+/**
+  Read the key cache file of --key_cache, before the capture is decoded, so that the parallel workers
+  share it. A missing or empty file is created as an empty cache.
+**/
+VOID
+SpdmDumpKeyCacheOpen (
+  VOID
+  )
+{
+  FILE                        *FpIn;
+  SPDM_DUMP_KEY_CACHE_HEADER  *Header;
+
+  if (mParamKeyCacheFileName == NULL) {
+    return ;
+  }
+
+  if ((FpIn = fopen (mParamKeyCacheFileName, "rb")) == NULL) {
+    SpdmDumpKeyCacheCreate ();
+    return ;
+  }
+  fseek (FpIn, 0, SEEK_END);
+  mKeyCacheBufferSize = ftell (FpIn);
+  fseek (FpIn, 0, SEEK_SET);
+  if (mKeyCacheBufferSize == 0) {
+    fclose (FpIn);
+    SpdmDumpKeyCacheCreate ();
+    return ;
+  }
+
+  mKeyCacheBuffer = malloc (mKeyCacheBufferSize);
+  if (mKeyCacheBuffer == NULL) {
+    printf ("!!!Unable to allocate the key cache %s!!!\n", mParamKeyCacheFileName);
+    fclose (FpIn);
+    mKeyCacheBufferSize = 0;
+    mKeyCacheInvalid = TRUE;
+    return ;
+  }
+  if (fread (mKeyCacheBuffer, 1, mKeyCacheBufferSize, FpIn) != mKeyCacheBufferSize) {
+    printf ("!!!Unable to read the key cache %s!!!\n", mParamKeyCacheFileName);
+    free (mKeyCacheBuffer);
+    mKeyCacheBuffer = NULL;
+    mKeyCacheBufferSize = 0;
+    mKeyCacheInvalid = TRUE;
+  }
+  fclose (FpIn);
+  if (mKeyCacheBuffer == NULL) {
+    return ;
+  }
+
+  Header = (VOID *)mKeyCacheBuffer;
+  if ((mKeyCacheBufferSize < sizeof(SPDM_DUMP_KEY_CACHE_HEADER)) ||
+      (Header->Signature != SPDM_DUMP_KEY_CACHE_SIGNATURE) ||
+      (Header->Version != SPDM_DUMP_KEY_CACHE_VERSION)) {
+    //
+    // Do not append to a file which is not a key cache.
+    //
+    printf ("!!!%s is not a key cache!!!\n", mParamKeyCacheFileName);
+    free (mKeyCacheBuffer);
+    mKeyCacheBuffer = NULL;
+    mKeyCacheBufferSize = 0;
+    mKeyCacheInvalid = TRUE;
+  }
+}
+
+/**
+  Import the secrets of a session from the key cache, instead of running the key schedule.
+
+  @param  SecuredMessageContext        The secured message context of the session.
+  @param  SessionId                    The SessionId of the session.
+  @param  Stage                        SPDM_DUMP_KEY_CACHE_STAGE_HANDSHAKE or SPDM_DUMP_KEY_CACHE_STAGE_DATA.
+  @param  TranscriptHash               TH1 for the handshake stage, or TH2 for the data stage.
+
+  @retval TRUE   The secrets are imported.
+  @retval FALSE  The key cache is not enabled or it does not have the secrets.
+**/
+BOOLEAN
+SpdmDumpKeyCacheImport (
+  IN VOID    *SecuredMessageContext,
+  IN UINT32  SessionId,
+  IN UINT8   Stage,
+  IN UINT8   *TranscriptHash
+  )
+{
+  UINTN                      HashSize;
+  UINTN                      Offset;
+  SPDM_DUMP_KEY_CACHE_ENTRY  *Entry;
+
+  if (mKeyCacheBuffer == NULL) {
+    return FALSE;
+  }
+
+  HashSize = GetSpdmHashSize (mSpdmBaseHashAlgo);
+  Offset = sizeof(SPDM_DUMP_KEY_CACHE_HEADER);
+  while (Offset + sizeof(SPDM_DUMP_KEY_CACHE_ENTRY) <= mKeyCacheBufferSize) {
+    Entry = (VOID *)(mKeyCacheBuffer + Offset);
+    if (Entry->SecretsSize > mKeyCacheBufferSize - Offset - sizeof(SPDM_DUMP_KEY_CACHE_ENTRY)) {
+      //
+      // A truncated entry, from a run which was interrupted.
+      //
+      break;
+    }
+    if ((Entry->SessionId == SessionId) &&
+        (Entry->Stage == Stage) &&
+        (Entry->TranscriptHashSize == HashSize) &&
+        (CompareMem (Entry->TranscriptHash, TranscriptHash, HashSize) == 0)) {
+      if (RETURN_ERROR (SpdmSecuredMessageImportSessionSecrets (SecuredMessageContext, Entry + 1, Entry->SecretsSize))) {
+        printf ("!!!Unable to import the cached secrets of session 0x%08x!!!\n", SessionId);
+        return FALSE;
+      }
+      return TRUE;
+    }
+    Offset += sizeof(SPDM_DUMP_KEY_CACHE_ENTRY) + Entry->SecretsSize;
+  }
+  return FALSE;
+}
+
+/**
+  Append the secrets of a session to the key cache, once they are derived by the key schedule.
+
+  @param  SecuredMessageContext        The secured message context of the session.
+  @param  SessionId                    The SessionId of the session.
+  @param  Stage                        SPDM_DUMP_KEY_CACHE_STAGE_HANDSHAKE or SPDM_DUMP_KEY_CACHE_STAGE_DATA.
+  @param  TranscriptHash               TH1 for the handshake stage, or TH2 for the data stage.
+**/
+VOID
+SpdmDumpKeyCacheSave (
+  IN VOID    *SecuredMessageContext,
+  IN UINT32  SessionId,
+  IN UINT8   Stage,
+  IN UINT8   *TranscriptHash
+  )
+{
+  FILE                        *FpOut;
+  UINT8                       Buffer[sizeof(SPDM_DUMP_KEY_CACHE_ENTRY) + SPDM_DUMP_KEY_CACHE_MAX_SECRETS_SIZE];
+  SPDM_DUMP_KEY_CACHE_ENTRY   *Entry;
+  UINTN                       SecretsSize;
+  UINTN                       HashSize;
+
+  //
+  // The parallel workers decode the handshake of a session in every worker. It is saved by the worker
+  // which owns the packet.
+  //
+  if ((mParamKeyCacheFileName == NULL) || mKeyCacheInvalid || !mDumpPacketOwned) {
+    return ;
+  }
+
+  ZeroMem (Buffer, sizeof(Buffer));
+  Entry = (VOID *)Buffer;
+  SecretsSize = SPDM_DUMP_KEY_CACHE_MAX_SECRETS_SIZE;
+  if (RETURN_ERROR (SpdmSecuredMessageExportSessionSecrets (SecuredMessageContext, Entry + 1, &SecretsSize))) {
+    return ;
+  }
+  HashSize = GetSpdmHashSize (mSpdmBaseHashAlgo);
+  Entry->SessionId = SessionId;
+  Entry->Stage = Stage;
+  Entry->TranscriptHashSize = (UINT16)HashSize;
+  CopyMem (Entry->TranscriptHash, TranscriptHash, HashSize);
+  Entry->SecretsSize = (UINT32)SecretsSize;
+
+  if ((FpOut = fopen (mParamKeyCacheFileName, "ab")) == NULL) {
+    printf ("!!!Unable to open the key cache %s!!!\n", mParamKeyCacheFileName);
+    mKeyCacheInvalid = TRUE;
+    ZeroMem (Buffer, sizeof(Buffer));
+    return ;
+  }
+  //
+  // One write per entry, so that the entries of the parallel workers are not interleaved.
+  //
+  if (fwrite (Buffer, 1, sizeof(SPDM_DUMP_KEY_CACHE_ENTRY) + SecretsSize, FpOut) != sizeof(SPDM_DUMP_KEY_CACHE_ENTRY) + SecretsSize) {
+    printf ("!!!Unable to write the key cache %s!!!\n", mParamKeyCacheFileName);
+  }
+  fclose (FpOut);
+  ZeroMem (Buffer, sizeof(Buffer));
+}
+
+/**
+  Free the key cache.
+**/
+VOID
+SpdmDumpKeyCacheClose (
+  VOID
+  )
+{
+  if (mKeyCacheBuffer != NULL) {
+    ZeroMem (mKeyCacheBuffer, mKeyCacheBufferSize);
+    free (mKeyCacheBuffer);
+    mKeyCacheBuffer = NULL;
+  }
+  mKeyCacheBufferSize = 0;
+}
@@ -9,15 +9,49 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmDump.h"
 
+extern VOID               *mSpdmContext;
+
+//
+// The pcap file is mapped if it is a regular file, and the packets are decoded in place.
+// Otherwise, for stdin, a FIFO or a pipe, it is streamed into mPcapReadBuffer, and each packet is
+// decoded in place as soon as it is complete. The read buffer grows up to PCAP_READ_MAX_SIZE.
+//
+#define PCAP_READ_BLOCK_SIZE  (4 * 1024 * 1024)
+#define PCAP_READ_MAX_SIZE    (64 * 1024 * 1024)
+
+//
+// The pcapng interfaces of the current section, and the SnapLen used if the first interface has no limit.
+//
+#define PCAPNG_MAX_INTERFACE_COUNT  16
+#define PCAPNG_DEFAULT_SNAP_LEN     0x00040000
+
 PCAP_GLOBAL_HEADER  mPcapGlobalHeader;
 FILE                *mPcapFile;
-VOID                *mPcapPacketDataBuffer;
+UINT8               *mPcapFileMapping;
+UINTN               mPcapFileMappingSize;
+UINT8               *mPcapReadBuffer;
+UINTN               mPcapReadBufferSize;
+UINTN               mPcapReadOffset;
+UINTN               mPcapReadLength;
+BOOLEAN             mPcapStreaming;
+UINTN               mPcapFirstPacketOffset;
+UINTN               mPcapPacketOffset;
+BOOLEAN             mPcapIsNg;
+UINT32              mPcapNgInterfaceLinkType[PCAPNG_MAX_INTERFACE_COUNT];
+UINTN               mPcapNgInterfaceCount;
+
+//
+// FALSE if the secured messages of the current packet are decoded by another worker of --jobs.
+//
+BOOLEAN             mDumpPacketOwned = TRUE;
 
 DISPATCH_TABLE_ENTRY mPcapDispatch[] = {
   {LINKTYPE_MCTP,    "MCTP",    DumpMctpPacket},
   {LINKTYPE_PCI_DOE, "PCI_DOE", DumpPciDoePacket},
 };
 
+DISPATCH_TABLE mPcapDispatchTable = DISPATCH_TABLE_INIT (mPcapDispatch);
+
 CHAR8 *
 DataLinkTypeToString (
   IN UINT32  DataLinkType
@@ -65,46 +99,461 @@ DumpPcapGlobalHeader (
     );
 }
 
+/**
+  Map the opened pcap file, if it is a regular file.
+
+  The mapping is private and writable, because the decoders may update a packet in place.
+
+  @retval TRUE   the pcap file is mapped to mPcapFileMapping.
+  @retval FALSE  the pcap file cannot be mapped, and it is streamed.
+**/
+BOOLEAN
+MapPcapPacketFile (
+  VOID
+  )
+{
+#ifdef _MSC_VER
+  return FALSE;
+#else
+  struct stat  FileStat;
+  VOID         *Mapping;
+
+  if ((fstat (fileno (mPcapFile), &FileStat) != 0) || !S_ISREG(FileStat.st_mode) ||
+      (FileStat.st_size == 0) || ((UINT64)FileStat.st_size > (UINT64)MAX_UINTN)) {
+    return FALSE;
+  }
+  Mapping = mmap (NULL, (size_t)FileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno (mPcapFile), 0);
+  if (Mapping == MAP_FAILED) {
+    return FALSE;
+  }
+  madvise (Mapping, (size_t)FileStat.st_size, MADV_SEQUENTIAL);
+  mPcapFileMapping = Mapping;
+  mPcapFileMappingSize = (UINTN)FileStat.st_size;
+  return TRUE;
+#endif
+}
+
+/**
+  Make the next Size bytes of the pcap file available in place, without taking them.
+
+  When the pcap file is streamed, it waits until the bytes arrive. The pointers returned before are no longer valid.
+
+  @param  Size                         The bytes needed.
+
+  @return a pointer to the bytes, in the mapping or in the read buffer, or NULL at the end of the file.
+**/
+UINT8 *
+PeekPcapFileData (
+  IN UINTN   Size
+  )
+{
+  UINT8  *Buffer;
+  UINTN  BufferSize;
+  INTN   ReadSize;
+
+  if (mPcapFileMapping != NULL) {
+    if (mPcapFileMappingSize - mPcapReadOffset < Size) {
+      return NULL;
+    }
+    return mPcapFileMapping + mPcapReadOffset;
+  }
+
+  if (mPcapReadLength < Size) {
+    if (mPcapReadBufferSize < Size) {
+      if (Size > PCAP_READ_MAX_SIZE) {
+        printf ("!!!pcap record too large (0x%x)!!!\n", (UINT32)Size);
+        return NULL;
+      }
+      BufferSize = (Size + PCAP_READ_BLOCK_SIZE - 1) / PCAP_READ_BLOCK_SIZE * PCAP_READ_BLOCK_SIZE;
+      Buffer = (VOID *)malloc (BufferSize);
+      if (Buffer == NULL) {
+        printf ("!!!memory out of resources!!!\n");
+        return NULL;
+      }
+      CopyMem (Buffer, mPcapReadBuffer + mPcapReadOffset, mPcapReadLength);
+      free (mPcapReadBuffer);
+      mPcapReadBuffer = Buffer;
+      mPcapReadBufferSize = BufferSize;
+    } else {
+      //
+      // Move the partial record to the start of the read buffer.
+      //
+      memmove (mPcapReadBuffer, mPcapReadBuffer + mPcapReadOffset, mPcapReadLength);
+    }
+    mPcapReadOffset = 0;
+
+    //
+    // Take whatever has arrived, so that a packet is decoded as soon as it is complete.
+    //
+    while (mPcapReadLength < Size) {
+#ifdef _MSC_VER
+      ReadSize = _read (_fileno (mPcapFile), mPcapReadBuffer + mPcapReadLength, (UINT32)(mPcapReadBufferSize - mPcapReadLength));
+#else
+      ReadSize = read (fileno (mPcapFile), mPcapReadBuffer + mPcapReadLength, mPcapReadBufferSize - mPcapReadLength);
+      if ((ReadSize < 0) && (errno == EINTR)) {
+        continue;
+      }
+#endif
+      if (ReadSize <= 0) {
+        return NULL;
+      }
+      mPcapReadLength += (UINTN)ReadSize;
+    }
+  }
+  return mPcapReadBuffer + mPcapReadOffset;
+}
+
+/**
+  Take the next Size bytes of the pcap file in place.
+
+  @param  Size                         The bytes needed.
+
+  @return a pointer to the bytes, in the mapping or in the read buffer, or NULL at the end of the file.
+**/
+UINT8 *
+GetPcapFileData (
+  IN UINTN   Size
+  )
+{
+  UINT8  *Data;
+
+  Data = PeekPcapFileData (Size);
+  if (Data == NULL) {
+    return NULL;
+  }
+  mPcapReadOffset += Size;
+  if (mPcapFileMapping == NULL) {
+    mPcapReadLength -= Size;
+  }
+  return Data;
+}
+
+/**
+  Read the next pcapng block. The section header and interface description blocks are handled here.
+
+  @param  BlockHeader                  The header of the block.
+
+  @return a pointer to the block, or NULL at the end of the file.
+**/
+UINT8 *
+GetPcapNgBlock (
+  OUT PCAPNG_BLOCK_HEADER  *BlockHeader
+  )
+{
+  UINT8                               *Block;
+  PCAPNG_SECTION_HEADER_BLOCK         *SectionHeader;
+  PCAPNG_INTERFACE_DESCRIPTION_BLOCK  *InterfaceDescription;
+
+  Block = PeekPcapFileData (sizeof(PCAPNG_BLOCK_HEADER));
+  if (Block == NULL) {
+    return NULL;
+  }
+  CopyMem (BlockHeader, Block, sizeof(PCAPNG_BLOCK_HEADER));
+  if ((BlockHeader->BlockTotalLength < sizeof(PCAPNG_BLOCK_HEADER) + sizeof(UINT32)) ||
+      ((BlockHeader->BlockTotalLength & 0x3) != 0)) {
+    printf ("!!!pcapng block length invalid (0x%x)!!!\n", BlockHeader->BlockTotalLength);
+    return NULL;
+  }
+  Block = GetPcapFileData (BlockHeader->BlockTotalLength);
+  if (Block == NULL) {
+    return NULL;
+  }
+
+  switch (BlockHeader->BlockType) {
+  case PCAPNG_BLOCK_TYPE_SECTION_HEADER:
+    if (BlockHeader->BlockTotalLength < sizeof(PCAPNG_SECTION_HEADER_BLOCK) + sizeof(UINT32)) {
+      return NULL;
+    }
+    SectionHeader = (VOID *)Block;
+    if (SectionHeader->ByteOrderMagic != PCAPNG_BYTE_ORDER_MAGIC) {
+      printf ("!!!pcapng byte order magic unsupported '%x'!!!\n", SectionHeader->ByteOrderMagic);
+      return NULL;
+    }
+    if (mPcapGlobalHeader.VersionMajor == 0) {
+      mPcapGlobalHeader.VersionMajor = SectionHeader->VersionMajor;
+      mPcapGlobalHeader.VersionMinor = SectionHeader->VersionMinor;
+    }
+    mPcapNgInterfaceCount = 0;
+    break;
+  case PCAPNG_BLOCK_TYPE_INTERFACE_DESCRIPTION:
+    if (BlockHeader->BlockTotalLength < sizeof(PCAPNG_INTERFACE_DESCRIPTION_BLOCK) + sizeof(UINT32)) {
+      return NULL;
+    }
+    InterfaceDescription = (VOID *)Block;
+    if (mPcapGlobalHeader.SnapLen == 0) {
+      mPcapGlobalHeader.Network = InterfaceDescription->LinkType;
+      mPcapGlobalHeader.SnapLen = (InterfaceDescription->SnapLen == 0) ? PCAPNG_DEFAULT_SNAP_LEN : InterfaceDescription->SnapLen;
+    }
+    if (mPcapNgInterfaceCount < PCAPNG_MAX_INTERFACE_COUNT) {
+      mPcapNgInterfaceLinkType[mPcapNgInterfaceCount++] = InterfaceDescription->LinkType;
+    }
+    break;
+  default:
+    break;
+  }
+  return Block;
+}
+
+/**
+  Read the next packet of the pcap file in place.
+
+  For pcapng, the data link type of the interface of the packet is set to mPcapGlobalHeader.Network.
+
+  @param  PcapPacketHeader             The pcap packet header of the packet.
+  @param  Data                         A pointer to the packet data, valid until the next packet is read.
+
+  @retval RETURN_SUCCESS               The packet is read.
+  @retval RETURN_END_OF_FILE           There is no packet any more.
+  @retval RETURN_BAD_BUFFER_SIZE       The packet header is read, but the packet data is invalid or truncated.
+**/
+RETURN_STATUS
+GetPcapPacket (
+  OUT PCAP_PACKET_HEADER  *PcapPacketHeader,
+  OUT UINT8               **Data
+  )
+{
+  UINT8                         *Block;
+  PCAPNG_BLOCK_HEADER           BlockHeader;
+  PCAPNG_ENHANCED_PACKET_BLOCK  EnhancedPacket;
+  UINT64                        Timestamp;
+  UINT32                        MaxDataLength;
+
+  if (!mPcapIsNg) {
+    mPcapPacketOffset = mPcapReadOffset;
+    Block = GetPcapFileData (sizeof(PCAP_PACKET_HEADER));
+    if (Block == NULL) {
+      return RETURN_END_OF_FILE;
+    }
+    CopyMem (PcapPacketHeader, Block, sizeof(PCAP_PACKET_HEADER));
+    if ((PcapPacketHeader->InclLen == 0) || (PcapPacketHeader->InclLen > mPcapGlobalHeader.SnapLen)) {
+      return RETURN_BAD_BUFFER_SIZE;
+    }
+    *Data = GetPcapFileData (PcapPacketHeader->InclLen);
+    if (*Data == NULL) {
+      return RETURN_BAD_BUFFER_SIZE;
+    }
+    return RETURN_SUCCESS;
+  }
+
+  while (TRUE) {
+    mPcapPacketOffset = mPcapReadOffset;
+    Block = GetPcapNgBlock (&BlockHeader);
+    if (Block == NULL) {
+      return RETURN_END_OF_FILE;
+    }
+    ZeroMem (PcapPacketHeader, sizeof(PCAP_PACKET_HEADER));
+    if ((BlockHeader.BlockType == PCAPNG_BLOCK_TYPE_ENHANCED_PACKET) &&
+        (BlockHeader.BlockTotalLength >= sizeof(PCAPNG_ENHANCED_PACKET_BLOCK) + sizeof(UINT32))) {
+      CopyMem (&EnhancedPacket, Block, sizeof(EnhancedPacket));
+      MaxDataLength = BlockHeader.BlockTotalLength - sizeof(PCAPNG_ENHANCED_PACKET_BLOCK) - sizeof(UINT32);
+      //
+      // The timestamp is in microseconds, the default if_tsresol.
+      //
+      Timestamp = ((UINT64)EnhancedPacket.TimestampHigh << 32) | EnhancedPacket.TimestampLow;
+      PcapPacketHeader->TsSec = (UINT32)(Timestamp / 1000000);
+      PcapPacketHeader->TsUsec = (UINT32)(Timestamp % 1000000);
+      PcapPacketHeader->InclLen = EnhancedPacket.CapturedPacketLength;
+      PcapPacketHeader->OrigLen = EnhancedPacket.OriginalPacketLength;
+      if (EnhancedPacket.InterfaceId < mPcapNgInterfaceCount) {
+        mPcapGlobalHeader.Network = mPcapNgInterfaceLinkType[EnhancedPacket.InterfaceId];
+      }
+      *Data = Block + sizeof(PCAPNG_ENHANCED_PACKET_BLOCK);
+    } else if ((BlockHeader.BlockType == PCAPNG_BLOCK_TYPE_SIMPLE_PACKET) &&
+               (BlockHeader.BlockTotalLength >= sizeof(PCAPNG_SIMPLE_PACKET_BLOCK) + sizeof(UINT32))) {
+      MaxDataLength = BlockHeader.BlockTotalLength - sizeof(PCAPNG_SIMPLE_PACKET_BLOCK) - sizeof(UINT32);
+      PcapPacketHeader->OrigLen = ((PCAPNG_SIMPLE_PACKET_BLOCK *)Block)->OriginalPacketLength;
+      PcapPacketHeader->InclLen = (PcapPacketHeader->OrigLen < MaxDataLength) ? PcapPacketHeader->OrigLen : MaxDataLength;
+      if (mPcapNgInterfaceCount != 0) {
+        mPcapGlobalHeader.Network = mPcapNgInterfaceLinkType[0];
+      }
+      *Data = Block + sizeof(PCAPNG_SIMPLE_PACKET_BLOCK);
+    } else {
+      continue;
+    }
+
+    if ((PcapPacketHeader->InclLen == 0) || (PcapPacketHeader->InclLen > MaxDataLength) ||
+        (PcapPacketHeader->InclLen > mPcapGlobalHeader.SnapLen)) {
+      return RETURN_BAD_BUFFER_SIZE;
+    }
+    return RETURN_SUCCESS;
+  }
+}
+
+/**
+  Move back to the first packet of the mapped pcap file.
+**/
+VOID
+RewindPcapPacketFile (
+  VOID
+  )
+{
+  mPcapReadOffset = mPcapFirstPacketOffset;
+  if (mPcapIsNg) {
+    mPcapNgInterfaceCount = 1;
+    mPcapGlobalHeader.Network = mPcapNgInterfaceLinkType[0];
+  }
+}
+
+/**
+  Get the offset of the last packet read by GetPcapPacket in the mapped pcap file.
+
+  @return the offset of the last packet.
+**/
+UINT64
+GetPcapPacketOffset (
+  VOID
+  )
+{
+  return (UINT64)mPcapPacketOffset;
+}
+
+/**
+  Move to a packet of the mapped pcap file.
+
+  For pcapng, the interfaces before the packet are not read again, so the data link type of
+  the packet is given by the caller.
+
+  @param  Offset                       The offset of the packet, from GetPcapPacketOffset.
+  @param  DataLinkType                 The data link type of the packet.
+
+  @retval TRUE   the next packet is the packet at Offset.
+  @retval FALSE  the pcap file is not mapped, or Offset is out of the pcap file.
+**/
+BOOLEAN
+SeekPcapPacketFile (
+  IN UINT64  Offset,
+  IN UINT32  DataLinkType
+  )
+{
+  if ((mPcapFileMapping == NULL) || (Offset < mPcapFirstPacketOffset) || (Offset > mPcapFileMappingSize)) {
+    return FALSE;
+  }
+  mPcapReadOffset = (UINTN)Offset;
+  mPcapGlobalHeader.Network = DataLinkType;
+  if (mPcapIsNg) {
+    mPcapNgInterfaceCount = 0;
+  }
+  return TRUE;
+}
+
+/**
+  Get the size and the modification time of the mapped pcap file, to check if an index matches it.
+
+  @param  FileSize                     The size in bytes of the pcap file.
+  @param  ModifyTime                   The modification time of the pcap file.
+
+  @retval TRUE   the pcap file is mapped, and the identity is returned.
+  @retval FALSE  the pcap file is not mapped.
+**/
+BOOLEAN
+GetPcapFileIdentity (
+  OUT UINT64  *FileSize,
+  OUT UINT64  *ModifyTime
+  )
+{
+#ifdef _MSC_VER
+  return FALSE;
+#else
+  struct stat  FileStat;
+
+  if ((mPcapFileMapping == NULL) || (fstat (fileno (mPcapFile), &FileStat) != 0)) {
+    return FALSE;
+  }
+  *FileSize = (UINT64)FileStat.st_size;
+  *ModifyTime = (UINT64)FileStat.st_mtime;
+  return TRUE;
+#endif
+}
+
 BOOLEAN
 OpenPcapPacketFile (
   IN CHAR8  *PcapFileName
   )
 {
+  UINT8                *Data;
+  UINT32               MagicNumber;
+  PCAPNG_BLOCK_HEADER  BlockHeader;
 
   if (PcapFileName == NULL) {
     return FALSE;
   }
 
-  if ((mPcapFile = fopen (PcapFileName, "rb")) == NULL) {
+  if (strcmp (PcapFileName, "-") == 0) {
+    mPcapFile = stdin;
+#ifdef _MSC_VER
+    _setmode (_fileno (stdin), _O_BINARY);
+#endif
+  } else if ((mPcapFile = fopen (PcapFileName, "rb")) == NULL) {
     printf ("!!!Unable to open pcap file %s!!!\n", PcapFileName);
     return FALSE;
   }
 
-  if (fread (&mPcapGlobalHeader, 1, sizeof(PCAP_GLOBAL_HEADER), mPcapFile) != sizeof(PCAP_GLOBAL_HEADER)) {
+  mPcapStreaming = (BOOLEAN)!MapPcapPacketFile ();
+  if (mPcapStreaming) {
+    mPcapReadBufferSize = PCAP_READ_BLOCK_SIZE;
+    mPcapReadBuffer = (VOID *)malloc (mPcapReadBufferSize);
+    if (mPcapReadBuffer == NULL) {
+      printf ("!!!memory out of resources!!!\n");
+      return FALSE;
+    }
+    mPcapReadOffset = 0;
+    mPcapReadLength = 0;
+  }
+
+  Data = PeekPcapFileData (sizeof(UINT32));
+  if (Data == NULL) {
     printf ("!!!Unable to read the pcap global header!!!\n");
     return FALSE;
   }
+  CopyMem (&MagicNumber, Data, sizeof(UINT32));
 
-  if ((mPcapGlobalHeader.MagicNumber != PCAP_GLOBAL_HEADER_MAGIC) &&
-      (mPcapGlobalHeader.MagicNumber != PCAP_GLOBAL_HEADER_MAGIC_SWAPPED) &&
-      (mPcapGlobalHeader.MagicNumber != PCAP_GLOBAL_HEADER_MAGIC_NANO) &&
-      (mPcapGlobalHeader.MagicNumber != PCAP_GLOBAL_HEADER_MAGIC_NANO_SWAPPED) ) {
-    printf ("!!!pcap file magic invalid '%x'!!!\n", mPcapGlobalHeader.MagicNumber);
-    return FALSE;
+  if (MagicNumber == PCAPNG_BLOCK_TYPE_SECTION_HEADER) {
+    //
+    // The global header is taken from the first interface of the first section.
+    //
+    mPcapIsNg = TRUE;
+    ZeroMem (&mPcapGlobalHeader, sizeof(mPcapGlobalHeader));
+    mPcapGlobalHeader.MagicNumber = MagicNumber;
+    while (mPcapNgInterfaceCount == 0) {
+      Data = PeekPcapFileData (sizeof(PCAPNG_BLOCK_HEADER));
+      if (Data == NULL) {
+        break;
+      }
+      CopyMem (&BlockHeader, Data, sizeof(PCAPNG_BLOCK_HEADER));
+      if ((BlockHeader.BlockType == PCAPNG_BLOCK_TYPE_ENHANCED_PACKET) ||
+          (BlockHeader.BlockType == PCAPNG_BLOCK_TYPE_SIMPLE_PACKET) ||
+          (GetPcapNgBlock (&BlockHeader) == NULL)) {
+        break;
+      }
+    }
+    if (mPcapNgInterfaceCount == 0) {
+      printf ("!!!Unable to read the pcapng interface description!!!\n");
+      return FALSE;
+    }
+  } else {
+    Data = GetPcapFileData (sizeof(PCAP_GLOBAL_HEADER));
+    if (Data == NULL) {
+      printf ("!!!Unable to read the pcap global header!!!\n");
+      return FALSE;
+    }
+    CopyMem (&mPcapGlobalHeader, Data, sizeof(PCAP_GLOBAL_HEADER));
+
+    if ((mPcapGlobalHeader.MagicNumber != PCAP_GLOBAL_HEADER_MAGIC) &&
+        (mPcapGlobalHeader.MagicNumber != PCAP_GLOBAL_HEADER_MAGIC_SWAPPED) &&
+        (mPcapGlobalHeader.MagicNumber != PCAP_GLOBAL_HEADER_MAGIC_NANO) &&
+        (mPcapGlobalHeader.MagicNumber != PCAP_GLOBAL_HEADER_MAGIC_NANO_SWAPPED) ) {
+      printf ("!!!pcap file magic invalid '%x'!!!\n", mPcapGlobalHeader.MagicNumber);
+      return FALSE;
+    }
   }
-  
+  mPcapFirstPacketOffset = mPcapReadOffset;
+
   DumpPcapGlobalHeader (&mPcapGlobalHeader);
 
   if (mPcapGlobalHeader.SnapLen == 0) {
     return FALSE;
   }
 
-  mPcapPacketDataBuffer = (VOID *)malloc (mPcapGlobalHeader.SnapLen);
-  if (mPcapPacketDataBuffer == NULL) {
-    printf ("!!!memory out of resources!!!\n");
-    return FALSE;
-  }
-
   return TRUE;
 }
 
@@ -113,14 +562,37 @@ ClosePcapPacketFile (
   VOID
   )
 {
+#ifndef _MSC_VER
+  if (mPcapFileMapping != NULL) {
+    munmap (mPcapFileMapping, mPcapFileMappingSize);
+    mPcapFileMapping = NULL;
+  }
+#endif
   if (mPcapFile != NULL) {
-    fclose (mPcapFile);
+    if (mPcapFile != stdin) {
+      fclose (mPcapFile);
+    }
     mPcapFile = NULL;
   }
-  if (mPcapPacketDataBuffer != NULL) {
-    free (mPcapPacketDataBuffer);
-    mPcapPacketDataBuffer = NULL;
+  if (mPcapReadBuffer != NULL) {
+    free (mPcapReadBuffer);
+    mPcapReadBuffer = NULL;
+  }
+}
+
+/**
+  Get the timestamp of a pcap packet, in microseconds.
+**/
+UINT64
+GetPcapPacketTime (
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader
+  )
+{
+  if ((mPcapGlobalHeader.MagicNumber == PCAP_GLOBAL_HEADER_MAGIC_NANO) ||
+      (mPcapGlobalHeader.MagicNumber == PCAP_GLOBAL_HEADER_MAGIC_NANO_SWAPPED)) {
+    return (UINT64)PcapPacketHeader->TsSec * 1000000 + PcapPacketHeader->TsUsec / 1000;
   }
+  return (UINT64)PcapPacketHeader->TsSec * 1000000 + PcapPacketHeader->TsUsec;
 }
 
 VOID
@@ -142,9 +614,533 @@ DumpPcapPacket (
   IN UINTN   BufferSize
   )
 {
-  DumpDispatchMessage (mPcapDispatch, ARRAY_SIZE(mPcapDispatch), mPcapGlobalHeader.Network, Buffer, BufferSize);
+  DumpDispatchMessage (&mPcapDispatchTable, mPcapGlobalHeader.Network, Buffer, BufferSize);
 }
 
+/**
+  Get the SessionId of a secured message, or the SPDM message of a normal message, in a pcap packet.
+
+  @param  Buffer                       The pcap packet.
+  @param  BufferSize                   Size in bytes of the pcap packet.
+  @param  SessionId                    The SessionId of a secured message.
+  @param  SpdmMessage                  The SPDM message of a normal message, or NULL.
+  @param  SpdmMessageSize              Size in bytes of the SPDM message.
+
+  @retval TRUE   the packet is a secured message.
+  @retval FALSE  the packet is a normal message, or it is not an SPDM message.
+**/
+BOOLEAN
+ScanPcapPacket (
+  IN  UINT8   *Buffer,
+  IN  UINTN   BufferSize,
+  OUT UINT32  *SessionId,
+  OUT UINT8   **SpdmMessage,
+  OUT UINTN   *SpdmMessageSize
+  )
+{
+  PCI_DOE_DATA_OBJECT_HEADER  *PciDoeHeader;
+  UINTN                       HeaderSize;
+  BOOLEAN                     IsSecured;
+
+  *SpdmMessage = NULL;
+  switch (mPcapGlobalHeader.Network) {
+  case LINKTYPE_MCTP:
+    HeaderSize = sizeof(MCTP_HEADER) + sizeof(MCTP_MESSAGE_HEADER);
+    if (BufferSize < HeaderSize) {
+      return FALSE;
+    }
+    IsSecured = (BOOLEAN)(Buffer[sizeof(MCTP_HEADER)] == MCTP_MESSAGE_TYPE_SECURED_MCTP);
+    if (!IsSecured && (Buffer[sizeof(MCTP_HEADER)] != MCTP_MESSAGE_TYPE_SPDM)) {
+      return FALSE;
+    }
+    break;
+  case LINKTYPE_PCI_DOE:
+    HeaderSize = sizeof(PCI_DOE_DATA_OBJECT_HEADER);
+    if (BufferSize < HeaderSize) {
+      return FALSE;
+    }
+    PciDoeHeader = (VOID *)Buffer;
+    if (PciDoeHeader->VendorId != PCI_DOE_VENDOR_ID_PCISIG) {
+      return FALSE;
+    }
+    IsSecured = (BOOLEAN)(PciDoeHeader->DataObjectType == PCI_DOE_DATA_OBJECT_TYPE_SECURED_SPDM);
+    if (!IsSecured && (PciDoeHeader->DataObjectType != PCI_DOE_DATA_OBJECT_TYPE_SPDM)) {
+      return FALSE;
+    }
+    break;
+  default:
+    return FALSE;
+  }
+
+  if (IsSecured) {
+    if (BufferSize < HeaderSize + sizeof(UINT32)) {
+      return FALSE;
+    }
+    CopyMem (SessionId, Buffer + HeaderSize, sizeof(UINT32));
+    return TRUE;
+  }
+  if (BufferSize < HeaderSize + sizeof(SPDM_MESSAGE_HEADER)) {
+    return FALSE;
+  }
+  *SpdmMessage = Buffer + HeaderSize;
+  *SpdmMessageSize = BufferSize - HeaderSize;
+  return FALSE;
+}
+
+/**
+  Dump a pcap packet, if it is selected by the filter of --filter.
+
+  @param  Index                        The index of the packet, from 1.
+  @param  PcapPacketHeader             The pcap packet header.
+  @param  Data                         The pcap packet data.
+**/
+VOID
+DumpPcapPacketFiltered (
+  IN UINTN               Index,
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader,
+  IN UINT8               *Data
+  )
+{
+  if (!SpdmDumpFilterPacket (PcapPacketHeader, Data, PcapPacketHeader->InclLen)) {
+    return ;
+  }
+  if (mParamStatistics) {
+    SpdmDumpStatisticsBeginPacket (PcapPacketHeader, Data);
+  }
+  if (mParamOutputFormat == SPDM_DUMP_OUTPUT_FORMAT_JSONL) {
+    SpdmDumpJsonBeginPacket (Index, PcapPacketHeader, Data);
+  }
+  DumpPcapPacketHeader (Index, PcapPacketHeader);
+  DumpPcapPacket (Data, PcapPacketHeader->InclLen);
+  if (mParamOutputFormat == SPDM_DUMP_OUTPUT_FORMAT_JSONL) {
+    SpdmDumpJsonEndPacket ();
+  }
+  SpdmDumpFilterEndPacket ();
+}
+
+#ifndef _MSC_VER
+
+//
+// The parallel decode splits the capture by session. The messages out of the sessions, including the
+// handshake messages deriving the session keys, are decoded by every worker to keep the SPDM context of
+// each worker in sync, and are printed by worker 0. The secured messages of a session are only decrypted
+// and printed by the worker the session is assigned to.
+//
+// Each worker is a child process with its own copy of the SPDM context, because the decode state is global.
+// Each worker prints to its own temporary file, and the outputs are merged in packet order at the end.
+//
+#define SPDM_DUMP_ACTIVE_SESSION_COUNT  64
+
+typedef struct {
+  UINT32  Worker;
+  UINT32  EndSessionId;
+  UINT32  EndSessionWorker;
+  UINT64  OutputSize;
+} SPDM_DUMP_PACKET_INFO;
+
+typedef struct {
+  UINT32  SessionId;
+  UINT32  Worker;
+  UINTN   LastPacket;
+} SPDM_DUMP_SESSION_LANE;
+
+typedef struct {
+  UINT32                  WorkerCount;
+  SPDM_DUMP_SESSION_LANE  *Lane;
+  UINTN                   LaneCount;
+  UINTN                   LaneMaxCount;
+  UINTN                   ActiveLane[SPDM_DUMP_ACTIVE_SESSION_COUNT];
+  UINTN                   ActiveLaneCount;
+} SPDM_DUMP_SCAN_CONTEXT;
+
+/**
+  Find the latest session lane of a SessionId.
+
+  @param  ScanContext                  The scan context.
+  @param  SessionId                    The SessionId.
+
+  @return the index of the session lane, or ScanContext->LaneCount if it is not found.
+**/
+UINTN
+FindSessionLane (
+  IN SPDM_DUMP_SCAN_CONTEXT  *ScanContext,
+  IN UINT32                  SessionId
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ScanContext->ActiveLaneCount; Index++) {
+    if (ScanContext->Lane[ScanContext->ActiveLane[Index]].SessionId == SessionId) {
+      return ScanContext->ActiveLane[Index];
+    }
+  }
+  return ScanContext->LaneCount;
+}
+
+/**
+  Start a new session lane, and assign it to the next worker in turn.
+
+  @param  ScanContext                  The scan context.
+  @param  SessionId                    The SessionId of the new session.
+  @param  PacketIndex                  The index of the first packet of the session.
+
+  @return the index of the session lane, or ScanContext->LaneCount if the memory is out of resources.
+**/
+UINTN
+AddSessionLane (
+  IN OUT SPDM_DUMP_SCAN_CONTEXT  *ScanContext,
+  IN     UINT32                  SessionId,
+  IN     UINTN                   PacketIndex
+  )
+{
+  SPDM_DUMP_SESSION_LANE  *Lane;
+  UINTN                   Index;
+
+  if (ScanContext->LaneCount == ScanContext->LaneMaxCount) {
+    ScanContext->LaneMaxCount = (ScanContext->LaneMaxCount == 0) ? 256 : ScanContext->LaneMaxCount * 2;
+    Lane = realloc (ScanContext->Lane, ScanContext->LaneMaxCount * sizeof(SPDM_DUMP_SESSION_LANE));
+    if (Lane == NULL) {
+      return ScanContext->LaneCount;
+    }
+    ScanContext->Lane = Lane;
+  }
+  Lane = &ScanContext->Lane[ScanContext->LaneCount];
+  Lane->SessionId = SessionId;
+  Lane->Worker = (UINT32)(ScanContext->LaneCount % ScanContext->WorkerCount);
+  Lane->LastPacket = PacketIndex;
+
+  //
+  // A SessionId used again replaces its active lane, otherwise the oldest active lane is replaced.
+  //
+  for (Index = 0; Index < ScanContext->ActiveLaneCount; Index++) {
+    if (ScanContext->Lane[ScanContext->ActiveLane[Index]].SessionId == SessionId) {
+      break;
+    }
+  }
+  if (Index == ScanContext->ActiveLaneCount) {
+    if (ScanContext->ActiveLaneCount < SPDM_DUMP_ACTIVE_SESSION_COUNT) {
+      ScanContext->ActiveLaneCount++;
+    } else {
+      Index = ScanContext->LaneCount % SPDM_DUMP_ACTIVE_SESSION_COUNT;
+    }
+  }
+  ScanContext->ActiveLane[Index] = ScanContext->LaneCount;
+  return ScanContext->LaneCount++;
+}
+
+/**
+  Scan the pcap file, and assign the packets of each session to a worker.
+
+  @param  PacketInfo                   The info of each packet, or NULL to count the packets only.
+  @param  WorkerCount                  The count of the workers.
+
+  @return the count of the packets, or 0 if there is no packet or the memory is out of resources.
+**/
+UINTN
+ScanPcap (
+  OUT SPDM_DUMP_PACKET_INFO  *PacketInfo, OPTIONAL
+  IN  UINT32                 WorkerCount
+  )
+{
+  PCAP_PACKET_HEADER      PcapPacketHeader;
+  SPDM_DUMP_SCAN_CONTEXT  ScanContext;
+  UINT8                   *Data;
+  UINTN                   PacketCount;
+  UINTN                   LaneIndex;
+  UINTN                   CurrentLane;
+  UINTN                   Index;
+  UINT32                  SessionId;
+  UINT16                  ReqSessionId;
+  UINT8                   *SpdmMessage;
+  UINTN                   SpdmMessageSize;
+  RETURN_STATUS           Status;
+
+  ZeroMem (&ScanContext, sizeof(ScanContext));
+  ScanContext.WorkerCount = WorkerCount;
+  RewindPcapPacketFile ();
+  PacketCount = 0;
+  CurrentLane = 0;
+  ReqSessionId = 0;
+
+  //
+  // Walk the packets the same way as DumpPcap, including the last header of a truncated capture.
+  //
+  while (TRUE) {
+    Status = GetPcapPacket (&PcapPacketHeader, &Data);
+    if (Status == RETURN_END_OF_FILE) {
+      break;
+    }
+    if (PacketInfo != NULL) {
+      ZeroMem (&PacketInfo[PacketCount], sizeof(SPDM_DUMP_PACKET_INFO));
+    }
+    PacketCount++;
+    if (RETURN_ERROR(Status)) {
+      break;
+    }
+    if (PacketInfo == NULL) {
+      continue;
+    }
+
+    if (ScanPcapPacket (Data, PcapPacketHeader.InclLen, &SessionId, &SpdmMessage, &SpdmMessageSize)) {
+      LaneIndex = FindSessionLane (&ScanContext, SessionId);
+      if (LaneIndex == ScanContext.LaneCount) {
+        //
+        // The session is established before the capture.
+        //
+        LaneIndex = AddSessionLane (&ScanContext, SessionId, PacketCount - 1);
+        if (LaneIndex == ScanContext.LaneCount) {
+          free (ScanContext.Lane);
+          return 0;
+        }
+      }
+      ScanContext.Lane[LaneIndex].LastPacket = PacketCount - 1;
+      PacketInfo[PacketCount - 1].Worker = ScanContext.Lane[LaneIndex].Worker;
+      continue;
+    }
+    if (SpdmMessage == NULL) {
+      continue;
+    }
+
+    switch (((SPDM_MESSAGE_HEADER *)SpdmMessage)->RequestResponseCode) {
+    case SPDM_KEY_EXCHANGE:
+      if (SpdmMessageSize >= sizeof(SPDM_KEY_EXCHANGE_REQUEST)) {
+        ReqSessionId = ((SPDM_KEY_EXCHANGE_REQUEST *)SpdmMessage)->ReqSessionID;
+      }
+      break;
+    case SPDM_PSK_EXCHANGE:
+      if (SpdmMessageSize >= sizeof(SPDM_PSK_EXCHANGE_REQUEST)) {
+        ReqSessionId = ((SPDM_PSK_EXCHANGE_REQUEST *)SpdmMessage)->ReqSessionID;
+      }
+      break;
+    case SPDM_KEY_EXCHANGE_RSP:
+    case SPDM_PSK_EXCHANGE_RSP:
+      if (((SPDM_MESSAGE_HEADER *)SpdmMessage)->RequestResponseCode == SPDM_KEY_EXCHANGE_RSP) {
+        if (SpdmMessageSize < sizeof(SPDM_KEY_EXCHANGE_RESPONSE)) {
+          break;
+        }
+        SessionId = ((UINT32)ReqSessionId << 16) | ((SPDM_KEY_EXCHANGE_RESPONSE *)SpdmMessage)->RspSessionID;
+      } else {
+        if (SpdmMessageSize < sizeof(SPDM_PSK_EXCHANGE_RESPONSE)) {
+          break;
+        }
+        SessionId = ((UINT32)ReqSessionId << 16) | ((SPDM_PSK_EXCHANGE_RESPONSE *)SpdmMessage)->RspSessionID;
+      }
+      CurrentLane = AddSessionLane (&ScanContext, SessionId, PacketCount - 1);
+      if (CurrentLane == ScanContext.LaneCount) {
+        free (ScanContext.Lane);
+        return 0;
+      }
+      break;
+    case SPDM_FINISH:
+    case SPDM_FINISH_RSP:
+      //
+      // FINISH in the clear belongs to the session of the last KEY_EXCHANGE.
+      //
+      if (CurrentLane < ScanContext.LaneCount) {
+        ScanContext.Lane[CurrentLane].LastPacket = PacketCount - 1;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  if (PacketInfo != NULL) {
+    for (Index = 0; Index < ScanContext.LaneCount; Index++) {
+      PacketInfo[ScanContext.Lane[Index].LastPacket].EndSessionId = ScanContext.Lane[Index].SessionId;
+      PacketInfo[ScanContext.Lane[Index].LastPacket].EndSessionWorker = ScanContext.Lane[Index].Worker;
+    }
+  }
+  free (ScanContext.Lane);
+  return PacketCount;
+}
+
+/**
+  Decode the pcap file in a worker, and print the packets assigned to the worker.
+
+  The output of the other packets is dropped, by moving the file position back.
+
+  @param  Worker                       The index of the worker.
+  @param  PacketInfo                   The info of each packet. The output size of the packets of the worker is set.
+  @param  PacketCount                  The count of the packets.
+**/
+VOID
+DumpPcapWorker (
+  IN     UINT32                 Worker,
+  IN OUT SPDM_DUMP_PACKET_INFO  *PacketInfo,
+  IN     UINTN                  PacketCount
+  )
+{
+  PCAP_PACKET_HEADER  PcapPacketHeader;
+  UINTN               Index;
+  UINT8               *Data;
+  off_t               Position;
+
+  RewindPcapPacketFile ();
+  Position = 0;
+
+  for (Index = 0; Index < PacketCount; Index++) {
+    mDumpPacketOwned = (BOOLEAN)(PacketInfo[Index].Worker == Worker);
+
+    if (GetPcapPacket (&PcapPacketHeader, &Data) == RETURN_SUCCESS) {
+      DumpPcapPacketFiltered (Index + 1, &PcapPacketHeader, Data);
+    } else {
+      DumpPcapPacketHeader (Index + 1, &PcapPacketHeader);
+    }
+
+    fflush (stdout);
+    if (mDumpPacketOwned) {
+      PacketInfo[Index].OutputSize = (UINT64)(ftello (stdout) - Position);
+      Position = ftello (stdout);
+    } else {
+      fseeko (stdout, Position, SEEK_SET);
+    }
+
+    //
+    // The session ended by the END_SESSION of another worker is freed here.
+    //
+    if ((PacketInfo[Index].EndSessionId != 0) && (PacketInfo[Index].EndSessionWorker != Worker) &&
+        (SpdmGetSessionInfoViaSessionId (mSpdmContext, PacketInfo[Index].EndSessionId) != NULL)) {
+      SpdmFreeSessionId (mSpdmContext, PacketInfo[Index].EndSessionId);
+    }
+  }
+  mDumpPacketOwned = TRUE;
+}
+
+/**
+  Decode the pcap file with mParamWorkerCount workers, and print the packets in order.
+
+  @retval TRUE   the pcap file is decoded.
+  @retval FALSE  the pcap file cannot be decoded in parallel, and it is not consumed.
+**/
+BOOLEAN
+DumpPcapParallel (
+  VOID
+  )
+{
+  SPDM_DUMP_PACKET_INFO  *PacketInfo;
+  UINTN                  PacketInfoSize;
+  UINTN                  PacketCount;
+  FILE                   **WorkerFile;
+  pid_t                  *WorkerPid;
+  UINT32                 Worker;
+  UINT32                 StartedCount;
+  UINTN                  Index;
+  INT32                  Status;
+  BOOLEAN                Result;
+  UINT8                  *CopyBuffer;
+  UINT64                 OutputSize;
+  UINTN                  CopySize;
+
+  if (mPcapFileMapping == NULL) {
+    printf ("!!!--jobs needs a regular pcap file, the packets are decoded serially!!!\n");
+    return FALSE;
+  }
+
+  PacketCount = ScanPcap (NULL, mParamWorkerCount);
+  RewindPcapPacketFile ();
+  if (PacketCount == 0) {
+    return FALSE;
+  }
+
+  //
+  // The packet info is shared with the workers, to collect the output size of each packet.
+  //
+  PacketInfoSize = PacketCount * sizeof(SPDM_DUMP_PACKET_INFO);
+  PacketInfo = mmap (NULL, PacketInfoSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (PacketInfo == MAP_FAILED) {
+    return FALSE;
+  }
+  WorkerFile = calloc (mParamWorkerCount, sizeof(FILE *));
+  WorkerPid = calloc (mParamWorkerCount, sizeof(pid_t));
+  CopyBuffer = malloc (PCAP_READ_BLOCK_SIZE);
+  Result = FALSE;
+  StartedCount = 0;
+  if ((WorkerFile == NULL) || (WorkerPid == NULL) || (CopyBuffer == NULL)) {
+    goto Done;
+  }
+  if (ScanPcap (PacketInfo, mParamWorkerCount) != PacketCount) {
+    goto Done;
+  }
+  for (Worker = 0; Worker < mParamWorkerCount; Worker++) {
+    WorkerFile[Worker] = tmpfile ();
+    if (WorkerFile[Worker] == NULL) {
+      goto Done;
+    }
+  }
+
+  fflush (stdout);
+  for (Worker = 0; Worker < mParamWorkerCount; Worker++) {
+    WorkerPid[Worker] = fork ();
+    if (WorkerPid[Worker] < 0) {
+      break;
+    }
+    if (WorkerPid[Worker] == 0) {
+      if (dup2 (fileno (WorkerFile[Worker]), STDOUT_FILENO) < 0) {
+        _exit (1);
+      }
+      fseeko (stdout, 0, SEEK_SET);
+      DumpPcapWorker (Worker, PacketInfo, PacketCount);
+      fflush (stdout);
+      _exit (0);
+    }
+    StartedCount++;
+  }
+
+  Result = (BOOLEAN)(StartedCount == mParamWorkerCount);
+  for (Worker = 0; Worker < StartedCount; Worker++) {
+    if ((waitpid (WorkerPid[Worker], &Status, 0) != WorkerPid[Worker]) ||
+        !WIFEXITED(Status) || (WEXITSTATUS(Status) != 0)) {
+      printf ("!!!SpdmDump worker %d failed!!!\n", Worker);
+      Result = FALSE;
+    }
+  }
+  if (!Result) {
+    printf ("!!!The packets are decoded serially!!!\n");
+    goto Done;
+  }
+
+  //
+  // Merge the outputs of the workers in packet order.
+  //
+  for (Worker = 0; Worker < mParamWorkerCount; Worker++) {
+    rewind (WorkerFile[Worker]);
+  }
+  for (Index = 0; Index < PacketCount; Index++) {
+    OutputSize = PacketInfo[Index].OutputSize;
+    while (OutputSize != 0) {
+      CopySize = (OutputSize > PCAP_READ_BLOCK_SIZE) ? PCAP_READ_BLOCK_SIZE : (UINTN)OutputSize;
+      CopySize = fread (CopyBuffer, 1, CopySize, WorkerFile[PacketInfo[Index].Worker]);
+      if (CopySize == 0) {
+        break;
+      }
+      fwrite (CopyBuffer, 1, CopySize, stdout);
+      OutputSize -= CopySize;
+    }
+  }
+
+Done:
+  if (WorkerFile != NULL) {
+    for (Worker = 0; Worker < mParamWorkerCount; Worker++) {
+      if (WorkerFile[Worker] != NULL) {
+        fclose (WorkerFile[Worker]);
+      }
+    }
+    free (WorkerFile);
+  }
+  if (WorkerPid != NULL) {
+    free (WorkerPid);
+  }
+  if (CopyBuffer != NULL) {
+    free (CopyBuffer);
+  }
+  munmap (PacketInfo, PacketInfoSize);
+  RewindPcapPacketFile ();
+  return Result;
+}
+
+#endif
+
 VOID
 DumpPcap (
   VOID
@@ -152,21 +1148,38 @@ DumpPcap (
 {
   PCAP_PACKET_HEADER  PcapPacketHeader;
   UINTN               Index;
+  UINT8               *Data;
+  RETURN_STATUS       Status;
 
-  Index = 1;
+  if (((mParamIndexFileName != NULL) || mParamSessionFilter) && DumpPcapIndexed ()) {
+    return ;
+  }
+
+#ifndef _MSC_VER
+  if ((mParamWorkerCount > 1) && DumpPcapParallel ()) {
+    return ;
+  }
+#endif
+
+  Index = SpdmDumpCheckpointOpen ();
 
   while (TRUE) {
-    if (fread (&PcapPacketHeader, 1, sizeof(PCAP_PACKET_HEADER), mPcapFile) != sizeof(PCAP_PACKET_HEADER)) {
+    Status = GetPcapPacket (&PcapPacketHeader, &Data);
+    if (Status == RETURN_END_OF_FILE) {
       return ;
     }
-    DumpPcapPacketHeader (Index++, &PcapPacketHeader);
-    if (PcapPacketHeader.InclLen == 0) {
+    if (RETURN_ERROR(Status)) {
+      DumpPcapPacketHeader (Index, &PcapPacketHeader);
       return ;
     }
-    if (fread (mPcapPacketDataBuffer, 1, PcapPacketHeader.InclLen, mPcapFile) != PcapPacketHeader.InclLen) {
-      return ;
+    SpdmDumpCheckpointPacket (Index, &PcapPacketHeader);
+    DumpPcapPacketFiltered (Index++, &PcapPacketHeader, Data);
+    if (mPcapStreaming) {
+      //
+      // Show each packet as soon as it is decoded, for a live capture.
+      //
+      fflush (stdout);
     }
-    DumpPcapPacket (mPcapPacketDataBuffer, PcapPacketHeader.InclLen);
   }
 }
 
@@ -0,0 +1,526 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmDump.h"
+
+//
+// The statistics of --stats pair each SPDM request with its response, by the pcap timestamps.
+// A requester has at most one outstanding request, so the pending request is tracked per connection for
+// the messages in the clear, and per session for the secured messages. The encapsulated messages are not paired.
+//
+// The phases are:
+//   VCA            GET_VERSION to ALGORITHMS.
+//   KEY_EXCHANGE   KEY_EXCHANGE to FINISH_RSP.
+//   PSK_EXCHANGE   PSK_EXCHANGE to PSK_FINISH_RSP.
+//   SESSION        KEY_EXCHANGE or PSK_EXCHANGE to END_SESSION_ACK.
+//
+#define STATISTICS_TIME_UNKNOWN  MAX_UINT64
+
+typedef struct {
+  UINT64  *Sample;
+  UINTN   Count;
+  UINTN   MaxCount;
+} STATISTICS_SAMPLE;
+
+typedef struct {
+  UINT32             Count;
+  UINT32             ResponseCount;
+  UINT32             NotReadyCount;
+  UINT32             BusyCount;
+  UINT32             ErrorCount;
+  UINT64             Bytes;
+  STATISTICS_SAMPLE  Latency;
+} STATISTICS_REQUEST;
+
+typedef struct {
+  BOOLEAN  Valid;
+  UINT8    RequestCode;
+  UINT64   Time;
+} STATISTICS_PENDING;
+
+typedef struct {
+  UINT32              SessionId;
+  BOOLEAN             Ended;
+  UINT32              PacketCount;
+  UINT64              Bytes;
+  UINT64              StartTime;
+  UINT64              HandshakeEndTime;
+  UINT64              EndTime;
+  STATISTICS_PENDING  Pending;
+} STATISTICS_SESSION;
+
+typedef enum {
+  StatisticsPhaseVca,
+  StatisticsPhaseKeyExchange,
+  StatisticsPhasePskExchange,
+  StatisticsPhaseSession,
+  StatisticsPhaseMax,
+} STATISTICS_PHASE;
+
+CHAR8  *mStatisticsPhaseName[StatisticsPhaseMax] = {
+  "VCA",
+  "KEY_EXCHANGE",
+  "PSK_EXCHANGE",
+  "SESSION",
+};
+
+STATISTICS_REQUEST  mStatisticsRequest[MAX_UINT8 + 1];
+STATISTICS_SAMPLE   mStatisticsPhase[StatisticsPhaseMax];
+
+STATISTICS_SESSION  *mStatisticsSession;
+UINTN               mStatisticsSessionCount;
+UINTN               mStatisticsSessionMaxCount;
+
+STATISTICS_PENDING  mStatisticsPending;
+UINT64              mStatisticsVcaStartTime = STATISTICS_TIME_UNKNOWN;
+UINT16              mStatisticsReqSessionId;
+UINT8               mStatisticsHandshakeCode;
+UINT64              mStatisticsHandshakeStartTime = STATISTICS_TIME_UNKNOWN;
+UINTN               mStatisticsHandshakeSession = MAX_UINTN;
+
+UINT64              mStatisticsPacketTime;
+UINTN               mStatisticsPacketSize;
+UINT32              mStatisticsPacketCount;
+UINT64              mStatisticsFirstTime = STATISTICS_TIME_UNKNOWN;
+
+extern UINT32   mCurrentSessionId;
+extern BOOLEAN  mEncapsulated;
+extern BOOLEAN  mDecrypted;
+
+/**
+  Append a sample, in microseconds.
+**/
+VOID
+StatisticsAddSample (
+  IN OUT STATISTICS_SAMPLE  *Sample,
+  IN     UINT64             Value
+  )
+{
+  UINT64  *NewSample;
+  UINTN   NewMaxCount;
+
+  if (Sample->Count == Sample->MaxCount) {
+    NewMaxCount = (Sample->MaxCount == 0) ? 64 : Sample->MaxCount * 2;
+    NewSample = realloc (Sample->Sample, NewMaxCount * sizeof(UINT64));
+    if (NewSample == NULL) {
+      return ;
+    }
+    Sample->Sample = NewSample;
+    Sample->MaxCount = NewMaxCount;
+  }
+  Sample->Sample[Sample->Count++] = Value;
+}
+
+int
+StatisticsCompareSample (
+  IN CONST VOID  *Left,
+  IN CONST VOID  *Right
+  )
+{
+  UINT64  LeftValue;
+  UINT64  RightValue;
+
+  LeftValue = *(CONST UINT64 *)Left;
+  RightValue = *(CONST UINT64 *)Right;
+  return (LeftValue < RightValue) ? -1 : ((LeftValue > RightValue) ? 1 : 0);
+}
+
+/**
+  Get a percentile of the sorted samples, by the nearest rank.
+**/
+UINT64
+StatisticsGetPercentile (
+  IN STATISTICS_SAMPLE  *Sample,
+  IN UINTN              Percent
+  )
+{
+  UINTN  Rank;
+
+  Rank = (Sample->Count * Percent + 99) / 100;
+  if (Rank == 0) {
+    Rank = 1;
+  }
+  return Sample->Sample[Rank - 1];
+}
+
+/**
+  Get the session of a SessionId, or create it.
+
+  @param  SessionId                    The SessionId.
+  @param  Create                       Create a new session, even if the SessionId is used by an ended session.
+
+  @return The index of the session, or MAX_UINTN if it is out of resource.
+**/
+UINTN
+StatisticsGetSession (
+  IN UINT32   SessionId,
+  IN BOOLEAN  Create
+  )
+{
+  UINTN               Index;
+  STATISTICS_SESSION  *NewSession;
+  UINTN               NewMaxCount;
+
+  //
+  // The most recent session is searched first, because a SessionId might be reused after END_SESSION.
+  //
+  for (Index = mStatisticsSessionCount; Index > 0; Index--) {
+    if (mStatisticsSession[Index - 1].SessionId == SessionId) {
+      if (!Create || !mStatisticsSession[Index - 1].Ended) {
+        return Index - 1;
+      }
+      break;
+    }
+  }
+
+  if (mStatisticsSessionCount == mStatisticsSessionMaxCount) {
+    NewMaxCount = (mStatisticsSessionMaxCount == 0) ? 16 : mStatisticsSessionMaxCount * 2;
+    NewSession = realloc (mStatisticsSession, NewMaxCount * sizeof(STATISTICS_SESSION));
+    if (NewSession == NULL) {
+      return MAX_UINTN;
+    }
+    mStatisticsSession = NewSession;
+    mStatisticsSessionMaxCount = NewMaxCount;
+  }
+  NewSession = &mStatisticsSession[mStatisticsSessionCount];
+  ZeroMem (NewSession, sizeof(STATISTICS_SESSION));
+  NewSession->SessionId = SessionId;
+  NewSession->StartTime = STATISTICS_TIME_UNKNOWN;
+  NewSession->HandshakeEndTime = STATISTICS_TIME_UNKNOWN;
+  NewSession->EndTime = STATISTICS_TIME_UNKNOWN;
+  return mStatisticsSessionCount++;
+}
+
+/**
+  Record the pcap timestamp and the size of a packet, before it is decoded.
+
+  @param  PcapPacketHeader             The pcap packet header.
+  @param  Buffer                       The pcap packet.
+**/
+VOID
+SpdmDumpStatisticsBeginPacket (
+  IN PCAP_PACKET_HEADER  *PcapPacketHeader,
+  IN UINT8               *Buffer
+  )
+{
+  UINT32  SessionId;
+  UINT8   *SpdmMessage;
+  UINTN   SpdmMessageSize;
+  UINTN   Index;
+
+  mStatisticsPacketTime = GetPcapPacketTime (PcapPacketHeader);
+  mStatisticsPacketSize = PcapPacketHeader->InclLen;
+  mStatisticsPacketCount++;
+  if (mStatisticsFirstTime == STATISTICS_TIME_UNKNOWN) {
+    mStatisticsFirstTime = mStatisticsPacketTime;
+  }
+
+  if (ScanPcapPacket (Buffer, PcapPacketHeader->InclLen, &SessionId, &SpdmMessage, &SpdmMessageSize)) {
+    Index = StatisticsGetSession (SessionId, FALSE);
+    if (Index != MAX_UINTN) {
+      mStatisticsSession[Index].PacketCount++;
+      mStatisticsSession[Index].Bytes += mStatisticsPacketSize;
+    }
+  }
+}
+
+/**
+  Record the phases of the connection and the sessions.
+**/
+VOID
+StatisticsRecordPhase (
+  IN UINT8  *SpdmMessage,
+  IN UINTN  SpdmMessageSize
+  )
+{
+  UINT8               Code;
+  UINT16              RspSessionId;
+  STATISTICS_SESSION  *Session;
+
+  Code = ((SPDM_MESSAGE_HEADER *)SpdmMessage)->RequestResponseCode;
+  Session = NULL;
+  if (mDecrypted) {
+    mStatisticsHandshakeSession = StatisticsGetSession (mCurrentSessionId, FALSE);
+  }
+  if (mStatisticsHandshakeSession != MAX_UINTN) {
+    Session = &mStatisticsSession[mStatisticsHandshakeSession];
+  }
+
+  switch (Code) {
+  case SPDM_GET_VERSION:
+    mStatisticsVcaStartTime = mStatisticsPacketTime;
+    break;
+  case SPDM_ALGORITHMS:
+    if (mStatisticsVcaStartTime != STATISTICS_TIME_UNKNOWN) {
+      StatisticsAddSample (&mStatisticsPhase[StatisticsPhaseVca], mStatisticsPacketTime - mStatisticsVcaStartTime);
+      mStatisticsVcaStartTime = STATISTICS_TIME_UNKNOWN;
+    }
+    break;
+  case SPDM_KEY_EXCHANGE:
+  case SPDM_PSK_EXCHANGE:
+    mStatisticsReqSessionId = 0;
+    if (SpdmMessageSize >= sizeof(SPDM_MESSAGE_HEADER) + sizeof(UINT16)) {
+      CopyMem (&mStatisticsReqSessionId, SpdmMessage + sizeof(SPDM_MESSAGE_HEADER), sizeof(UINT16));
+    }
+    mStatisticsHandshakeCode = Code;
+    mStatisticsHandshakeStartTime = mStatisticsPacketTime;
+    break;
+  case SPDM_KEY_EXCHANGE_RSP:
+  case SPDM_PSK_EXCHANGE_RSP:
+    RspSessionId = 0;
+    if (SpdmMessageSize >= sizeof(SPDM_MESSAGE_HEADER) + sizeof(UINT16)) {
+      CopyMem (&RspSessionId, SpdmMessage + sizeof(SPDM_MESSAGE_HEADER), sizeof(UINT16));
+    }
+    mStatisticsHandshakeSession = StatisticsGetSession (((UINT32)mStatisticsReqSessionId << 16) | RspSessionId, TRUE);
+    if (mStatisticsHandshakeSession != MAX_UINTN) {
+      Session = &mStatisticsSession[mStatisticsHandshakeSession];
+      Session->StartTime = mStatisticsHandshakeStartTime;
+    }
+    break;
+  case SPDM_FINISH_RSP:
+  case SPDM_PSK_FINISH_RSP:
+    if ((Session != NULL) && (Session->StartTime != STATISTICS_TIME_UNKNOWN) &&
+        (Session->HandshakeEndTime == STATISTICS_TIME_UNKNOWN)) {
+      Session->HandshakeEndTime = mStatisticsPacketTime;
+      StatisticsAddSample (
+        &mStatisticsPhase[(mStatisticsHandshakeCode == SPDM_KEY_EXCHANGE) ? StatisticsPhaseKeyExchange : StatisticsPhasePskExchange],
+        Session->HandshakeEndTime - Session->StartTime
+        );
+    }
+    break;
+  case SPDM_END_SESSION_ACK:
+    if ((Session != NULL) && !Session->Ended) {
+      Session->Ended = TRUE;
+      Session->EndTime = mStatisticsPacketTime;
+      if (Session->StartTime != STATISTICS_TIME_UNKNOWN) {
+        StatisticsAddSample (&mStatisticsPhase[StatisticsPhaseSession], Session->EndTime - Session->StartTime);
+      }
+    }
+    break;
+  default:
+    break;
+  }
+
+  //
+  // The bytes of the handshake in the clear are counted in the session.
+  //
+  if (!mDecrypted && (Session != NULL) &&
+      ((Code == SPDM_KEY_EXCHANGE_RSP) || (Code == SPDM_PSK_EXCHANGE_RSP) ||
+       (Code == SPDM_FINISH) || (Code == SPDM_FINISH_RSP) || (Code == SPDM_PSK_FINISH) || (Code == SPDM_PSK_FINISH_RSP))) {
+    Session->PacketCount++;
+    Session->Bytes += mStatisticsPacketSize;
+  }
+}
+
+/**
+  Record an SPDM message, in the clear or decrypted, for the statistics.
+
+  @param  SpdmMessage                  The SPDM message.
+  @param  SpdmMessageSize              Size in bytes of the SPDM message.
+**/
+VOID
+SpdmDumpStatisticsRecordMessage (
+  IN UINT8  *SpdmMessage,
+  IN UINTN  SpdmMessageSize
+  )
+{
+  UINT8                Code;
+  STATISTICS_PENDING   *Pending;
+  STATISTICS_REQUEST   *Request;
+  SPDM_ERROR_RESPONSE  *ErrorResponse;
+  UINTN                Index;
+
+  if (mEncapsulated || (SpdmMessageSize < sizeof(SPDM_MESSAGE_HEADER))) {
+    return ;
+  }
+
+  Pending = &mStatisticsPending;
+  if (mDecrypted) {
+    Index = StatisticsGetSession (mCurrentSessionId, FALSE);
+    if (Index != MAX_UINTN) {
+      Pending = &mStatisticsSession[Index].Pending;
+    }
+  }
+
+  Code = ((SPDM_MESSAGE_HEADER *)SpdmMessage)->RequestResponseCode;
+  if ((Code & 0x80) != 0) {
+    Request = &mStatisticsRequest[Code];
+    Request->Count++;
+    Request->Bytes += mStatisticsPacketSize;
+    Pending->Valid = TRUE;
+    Pending->RequestCode = Code;
+    Pending->Time = mStatisticsPacketTime;
+  } else if (Pending->Valid) {
+    Pending->Valid = FALSE;
+    Request = &mStatisticsRequest[Pending->RequestCode];
+    Request->ResponseCount++;
+    Request->Bytes += mStatisticsPacketSize;
+    StatisticsAddSample (&Request->Latency, mStatisticsPacketTime - Pending->Time);
+    if ((Code == SPDM_ERROR) && (SpdmMessageSize >= sizeof(SPDM_ERROR_RESPONSE))) {
+      ErrorResponse = (VOID *)SpdmMessage;
+      switch (ErrorResponse->Header.Param1) {
+      case SPDM_ERROR_CODE_RESPONSE_NOT_READY:
+        Request->NotReadyCount++;
+        break;
+      case SPDM_ERROR_CODE_BUSY:
+        Request->BusyCount++;
+        break;
+      default:
+        Request->ErrorCount++;
+        break;
+      }
+    }
+  }
+
+  StatisticsRecordPhase (SpdmMessage, SpdmMessageSize);
+}
+
+/**
+  Sort the samples, and get the minimum, the 50th, 90th and 99th percentiles, and the maximum.
+
+  @retval TRUE   the distribution is returned.
+  @retval FALSE  there is no sample.
+**/
+BOOLEAN
+StatisticsGetDistribution (
+  IN  STATISTICS_SAMPLE  *Sample,
+  OUT UINT64             Distribution[5]
+  )
+{
+  if (Sample->Count == 0) {
+    return FALSE;
+  }
+  qsort (Sample->Sample, Sample->Count, sizeof(UINT64), StatisticsCompareSample);
+  Distribution[0] = Sample->Sample[0];
+  Distribution[1] = StatisticsGetPercentile (Sample, 50);
+  Distribution[2] = StatisticsGetPercentile (Sample, 90);
+  Distribution[3] = StatisticsGetPercentile (Sample, 99);
+  Distribution[4] = Sample->Sample[Sample->Count - 1];
+  return TRUE;
+}
+
+/**
+  Print the distribution of the samples, as columns of the summary or fields of the CSV file.
+**/
+VOID
+StatisticsPrintDistribution (
+  IN FILE               *File,
+  IN BOOLEAN            IsCsv,
+  IN STATISTICS_SAMPLE  *Sample
+  )
+{
+  UINT64  Distribution[5];
+  UINTN   Index;
+
+  if (!StatisticsGetDistribution (Sample, Distribution)) {
+    fprintf (File, IsCsv ? ",,,,," : "        -        -        -        -        -");
+    return ;
+  }
+  for (Index = 0; Index < ARRAY_SIZE(Distribution); Index++) {
+    fprintf (File, IsCsv ? ",%llu" : " %8llu", (unsigned long long)Distribution[Index]);
+  }
+}
+
+/**
+  Print a duration in microseconds, or nothing if it is not known.
+**/
+VOID
+StatisticsPrintDuration (
+  IN FILE     *File,
+  IN BOOLEAN  IsCsv,
+  IN UINT64   StartTime,
+  IN UINT64   EndTime
+  )
+{
+  if ((StartTime == STATISTICS_TIME_UNKNOWN) || (EndTime == STATISTICS_TIME_UNKNOWN)) {
+    fprintf (File, IsCsv ? "," : " %13s", "-");
+  } else {
+    fprintf (File, IsCsv ? ",%llu" : " %13llu", (unsigned long long)(EndTime - StartTime));
+  }
+}
+
+/**
+  Print the statistics of the capture, as a summary on stdout, or as a CSV file if --stats_csv is used.
+
+  Each line of the CSV file is a request code, a phase or a session, as in the Type field.
+**/
+VOID
+DumpPcapStatistics (
+  VOID
+  )
+{
+  FILE                *File;
+  BOOLEAN             IsCsv;
+  UINTN               Index;
+  STATISTICS_REQUEST  *Request;
+  STATISTICS_SESSION  *Session;
+  CHAR8               Name[64];
+
+  if (!mParamStatistics) {
+    return ;
+  }
+
+  IsCsv = (BOOLEAN)(mParamStatisticsCsvFileName != NULL);
+  if (IsCsv) {
+    if ((File = fopen (mParamStatisticsCsvFileName, "w")) == NULL) {
+      fprintf (stdout, "!!!Unable to open statistics file %s!!!\n", mParamStatisticsCsvFileName);
+      return ;
+    }
+    fprintf (File, "Type,Name,Count,Responses,NotReady,Busy,Errors,Bytes,MinUs,P50Us,P90Us,P99Us,MaxUs,HandshakeUs,LifetimeUs\n");
+  } else {
+    File = stdout;
+    fprintf (File, "Statistics - Packets %u, Duration %llu us\n", mStatisticsPacketCount,
+      (unsigned long long)((mStatisticsPacketCount == 0) ? 0 : mStatisticsPacketTime - mStatisticsFirstTime));
+    fprintf (File, "\n%-38s %6s %6s %8s %6s %6s %10s %8s %8s %8s %8s %8s\n",
+      "Request", "Count", "Resp", "NotReady", "Busy", "Error", "Bytes", "Min(us)", "P50(us)", "P90(us)", "P99(us)", "Max(us)");
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE(mStatisticsRequest); Index++) {
+    Request = &mStatisticsRequest[Index];
+    if (Request->Count == 0) {
+      continue;
+    }
+    snprintf (Name, sizeof(Name), "%s (0x%02x)", GetSpdmMessageName ((UINT8)Index), (UINT32)Index);
+    fprintf (File, IsCsv ? "request,%s,%u,%u,%u,%u,%u,%llu" : "%-38s %6u %6u %8u %6u %6u %10llu",
+      Name, Request->Count, Request->ResponseCount,
+      Request->NotReadyCount, Request->BusyCount, Request->ErrorCount, (unsigned long long)Request->Bytes);
+    StatisticsPrintDistribution (File, IsCsv, &Request->Latency);
+    fprintf (File, IsCsv ? ",,\n" : "\n");
+  }
+
+  if (!IsCsv) {
+    fprintf (File, "\n%-38s %6s %8s %8s %8s %8s %8s\n",
+      "Phase", "Count", "Min(us)", "P50(us)", "P90(us)", "P99(us)", "Max(us)");
+  }
+  for (Index = 0; Index < StatisticsPhaseMax; Index++) {
+    if (mStatisticsPhase[Index].Count == 0) {
+      continue;
+    }
+    fprintf (File, IsCsv ? "phase,%s,%u,,,,,," : "%-38s %6u", mStatisticsPhaseName[Index], (UINT32)mStatisticsPhase[Index].Count);
+    StatisticsPrintDistribution (File, IsCsv, &mStatisticsPhase[Index]);
+    fprintf (File, IsCsv ? ",,\n" : "\n");
+  }
+
+  if (!IsCsv) {
+    fprintf (File, "\n%-38s %6s %10s %13s %13s\n", "Session", "Count", "Bytes", "Handshake(us)", "Lifetime(us)");
+  }
+  for (Index = 0; Index < mStatisticsSessionCount; Index++) {
+    Session = &mStatisticsSession[Index];
+    snprintf (Name, sizeof(Name), "0x%08x", Session->SessionId);
+    fprintf (File, IsCsv ? "session,%s,%u,,,,,%llu,,,,," : "%-38s %6u %10llu",
+      Name, Session->PacketCount, (unsigned long long)Session->Bytes);
+    StatisticsPrintDuration (File, IsCsv, Session->StartTime, Session->HandshakeEndTime);
+    StatisticsPrintDuration (File, IsCsv, Session->StartTime, Session->EndTime);
+    fprintf (File, "\n");
+  }
+
+  if (IsCsv) {
+    fclose (File);
+  }
+}
@@ -21,6 +21,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 #include "SpdmDeviceSecretLibInternal.h"
 
+DEVICE_DELAY_FUNC  mDeviceDelayFunc = NULL;
+UINT32             mDeviceSignDelay = 0;
+UINT32             mDeviceMeasurementDelay = 0;
+DEVICE_LOCK_FUNC   mDeviceAcquireLockFunc = NULL;
+DEVICE_LOCK_FUNC   mDeviceReleaseLockFunc = NULL;
+
 BOOLEAN
 ReadResponderPrivateCertificate (
   IN  UINT32  BaseAsymAlgo,
@@ -116,12 +122,19 @@ SpdmMeasurementCollectionFunc (
   UINTN                        HashSize;
   UINT8                        Index;
   UINT8                        Data[MEASUREMENT_MANIFEST_SIZE];
+  UINT8                        HashData[MEASUREMENT_BLOCK_NUMBER][MEASUREMENT_MANIFEST_SIZE];
+  CRYPT_DATA_SEGMENT           HashInput[MEASUREMENT_BLOCK_NUMBER];
+  UINT8                        *HashOutput[MEASUREMENT_BLOCK_NUMBER];
+  UINTN                        HashCount;
   UINTN                        TotalSize;
 
   ASSERT (MeasurementSpecification == SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF);
   if (MeasurementSpecification != SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF) {
     return FALSE;
   }
+  if (mDeviceDelayFunc != NULL) {
+    mDeviceDelayFunc (mDeviceMeasurementDelay);
+  }
 
   HashSize = GetSpdmMeasurementHashSize (MeasurementHashAlgo);
   ASSERT (HashSize != 0);
@@ -137,6 +150,10 @@ SpdmMeasurementCollectionFunc (
   ASSERT (*DeviceMeasurementSize >= TotalSize);
   *DeviceMeasurementSize = TotalSize;
 
+  //
+  // The digests are computed in one batch after all block headers are built.
+  //
+  HashCount = 0;
   MeasurementBlock = DeviceMeasurement;
   for (Index = 0; Index < MEASUREMENT_BLOCK_NUMBER; Index++) {
     MeasurementBlock->MeasurementBlockCommonHeader.Index = Index + 1;
@@ -150,16 +167,23 @@ SpdmMeasurementCollectionFunc (
     }
     MeasurementBlock->MeasurementBlockCommonHeader.MeasurementSize = (UINT16)(sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER) + 
                                                                      MeasurementBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueSize);
-    SetMem (Data, sizeof(Data), (UINT8)(Index + 1));
     if ((Index < 4) && (HashSize != 0xFFFFFFFF)) {
-      SpdmMeasurementHashAll (MeasurementHashAlgo, Data, sizeof(Data), (VOID *)(MeasurementBlock + 1));
+      SetMem (HashData[HashCount], sizeof(HashData[HashCount]), (UINT8)(Index + 1));
+      HashInput[HashCount].Buffer = HashData[HashCount];
+      HashInput[HashCount].Size = sizeof(HashData[HashCount]);
+      HashOutput[HashCount] = (VOID *)(MeasurementBlock + 1);
+      HashCount++;
       MeasurementBlock = (VOID *)((UINT8 *)MeasurementBlock + sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + HashSize);
     } else {
+      SetMem (Data, sizeof(Data), (UINT8)(Index + 1));
       CopyMem ((VOID *)(MeasurementBlock + 1), Data, sizeof(Data));
       MeasurementBlock = (VOID *)((UINT8 *)MeasurementBlock + sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + sizeof(Data));
     }
   }
 
+  if (HashCount != 0) {
+    return SpdmMeasurementHashMulti (MeasurementHashAlgo, HashCount, HashInput, HashOutput);
+  }
   return TRUE;
 }
 
@@ -189,30 +213,65 @@ SpdmRequesterDataSignFunc (
   )
 {
   VOID                          *Context;
-  VOID                          *PrivatePem;
-  UINTN                         PrivatePemSize;
   BOOLEAN                       Result;
 
-  Result = ReadRequesterPrivateCertificate (ReqBaseAsymAlg, &PrivatePem, &PrivatePemSize);
+  Result = SpdmRequesterDataLoadKeyFunc (ReqBaseAsymAlg, &Context);
   if (!Result) {
     return FALSE;
   }
+  Result = SpdmRequesterDataSignWithKeyFunc (
+             ReqBaseAsymAlg,
+             BaseHashAlgo,
+             Context,
+             Message,
+             MessageSize,
+             Signature,
+             SigSize
+             );
+  SpdmRequesterDataReleaseKeyFunc (ReqBaseAsymAlg, Context);
+
+  return Result;
+}
+
+/**
+  Sign the hash of an SPDM message data.
+
+  @param  ReqBaseAsymAlg               Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmRequesterDataSignHashFunc (
+  IN      UINT16       ReqBaseAsymAlg,
+  IN      UINT32       BaseHashAlgo,
+  IN      CONST UINT8  *MessageHash,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  VOID                          *Context;
+  BOOLEAN                       Result;
 
-  Result = SpdmReqAsymGetPrivateKeyFromPem (ReqBaseAsymAlg, PrivatePem, PrivatePemSize, NULL, &Context);
+  Result = SpdmRequesterDataLoadKeyFunc (ReqBaseAsymAlg, &Context);
   if (!Result) {
     return FALSE;
   }
-  Result = SpdmReqAsymSign (
+  Result = SpdmRequesterDataSignHashWithKeyFunc (
              ReqBaseAsymAlg,
              BaseHashAlgo,
              Context,
-             Message,
-             MessageSize,
+             MessageHash,
              Signature,
              SigSize
              );
-  SpdmReqAsymFree (ReqBaseAsymAlg, Context);
-  free (PrivatePem);
+  SpdmRequesterDataReleaseKeyFunc (ReqBaseAsymAlg, Context);
 
   return Result;
 }
@@ -243,20 +302,13 @@ SpdmResponderDataSignFunc (
   )
 {
   VOID                          *Context;
-  VOID                          *PrivatePem;
-  UINTN                         PrivatePemSize;
   BOOLEAN                       Result;
 
-  Result = ReadResponderPrivateCertificate (BaseAsymAlgo, &PrivatePem, &PrivatePemSize);
+  Result = SpdmResponderDataLoadKeyFunc (BaseAsymAlgo, &Context);
   if (!Result) {
     return FALSE;
   }
-
-  Result = SpdmAsymGetPrivateKeyFromPem (BaseAsymAlgo, PrivatePem, PrivatePemSize, NULL, &Context);
-  if (!Result) {
-    return FALSE;
-  }
-  Result = SpdmAsymSign (
+  Result = SpdmResponderDataSignWithKeyFunc (
              BaseAsymAlgo,
              BaseHashAlgo,
              Context,
@@ -265,50 +317,414 @@ SpdmResponderDataSignFunc (
              Signature,
              SigSize
              );
-  SpdmAsymFree (BaseAsymAlgo, Context);
+  SpdmResponderDataReleaseKeyFunc (BaseAsymAlgo, Context);
+
+  return Result;
+}
+
+/**
+  Sign the hash of an SPDM message data.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmResponderDataSignHashFunc (
+  IN      UINT32       BaseAsymAlgo,
+  IN      UINT32       BaseHashAlgo,
+  IN      CONST UINT8  *MessageHash,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  SPDM_SIGN_HASH_REQUEST        Request;
+  BOOLEAN                       Result;
+
+  Request.MessageHash = MessageHash;
+  Request.Signature = Signature;
+  Request.SigSize = *SigSize;
+  Result = SpdmResponderDataSignHashMultiFunc (BaseAsymAlgo, BaseHashAlgo, &Request, 1);
+  *SigSize = Request.SigSize;
+
+  return Result;
+}
+
+/**
+  Sign several hashes of SPDM message data in one transaction with the device.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  Request                      Array of RequestCount requests. On input, SigSize is the size in bytes of
+                                       the Signature buffer. On output, it is the size in bytes of the signature.
+  @param  RequestCount                 Number of requests.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmResponderDataSignHashMultiFunc (
+  IN      UINT32                  BaseAsymAlgo,
+  IN      UINT32                  BaseHashAlgo,
+  IN OUT  SPDM_SIGN_HASH_REQUEST  *Request,
+  IN      UINTN                   RequestCount
+  )
+{
+  VOID                          *Context;
+  BOOLEAN                       Result;
+  UINTN                         Index;
+
+  Result = SpdmResponderDataLoadKeyFunc (BaseAsymAlgo, &Context);
+  if (!Result) {
+    return FALSE;
+  }
+  for (Index = 0; (Index < RequestCount) && Result; Index++) {
+    Result = SpdmResponderDataSignHashWithKeyFunc (
+               BaseAsymAlgo,
+               BaseHashAlgo,
+               Context,
+               Request[Index].MessageHash,
+               Request[Index].Signature,
+               &Request[Index].SigSize
+               );
+  }
+  SpdmResponderDataReleaseKeyFunc (BaseAsymAlgo, Context);
+
+  return Result;
+}
+
+/**
+  Load the requester private key once for repeated signing.
+
+  The returned handle is passed to SpdmRequesterDataSignWithKeyFunc and
+  must be released with SpdmRequesterDataReleaseKeyFunc.
+
+  @param  ReqBaseAsymAlg               Indicates the signing algorithm.
+  @param  KeyHandle                    Pointer to receive the parsed private key handle.
+
+  @retval TRUE  the private key is loaded.
+  @retval FALSE the private key cannot be loaded.
+**/
+BOOLEAN
+EFIAPI
+SpdmRequesterDataLoadKeyFunc (
+  IN      UINT16       ReqBaseAsymAlg,
+     OUT  VOID         **KeyHandle
+  )
+{
+  VOID                          *PrivatePem;
+  UINTN                         PrivatePemSize;
+  BOOLEAN                       Result;
+
+  Result = ReadRequesterPrivateCertificate (ReqBaseAsymAlg, &PrivatePem, &PrivatePemSize);
+  if (!Result) {
+    return FALSE;
+  }
+
+  Result = SpdmReqAsymGetPrivateKeyFromPem (ReqBaseAsymAlg, PrivatePem, PrivatePemSize, NULL, KeyHandle);
+  ZeroMem (PrivatePem, PrivatePemSize);
+  free (PrivatePem);
+
+  return Result;
+}
+
+/**
+  Sign an SPDM message data with a private key loaded by SpdmRequesterDataLoadKeyFunc.
+
+  @param  ReqBaseAsymAlg               Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  KeyHandle                    The private key handle.
+  @param  Message                      A pointer to a message to be signed (before hash).
+  @param  MessageSize                  The size in bytes of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmRequesterDataSignWithKeyFunc (
+  IN      UINT16       ReqBaseAsymAlg,
+  IN      UINT32       BaseHashAlgo,
+  IN      VOID         *KeyHandle,
+  IN      CONST UINT8  *Message,
+  IN      UINTN        MessageSize,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  if (KeyHandle == NULL) {
+    return FALSE;
+  }
+  return SpdmReqAsymSign (
+           ReqBaseAsymAlg,
+           BaseHashAlgo,
+           KeyHandle,
+           Message,
+           MessageSize,
+           Signature,
+           SigSize
+           );
+}
+
+/**
+  Sign the hash of an SPDM message data with a private key loaded by SpdmRequesterDataLoadKeyFunc.
+
+  @param  ReqBaseAsymAlg               Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  KeyHandle                    The private key handle.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmRequesterDataSignHashWithKeyFunc (
+  IN      UINT16       ReqBaseAsymAlg,
+  IN      UINT32       BaseHashAlgo,
+  IN      VOID         *KeyHandle,
+  IN      CONST UINT8  *MessageHash,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  if (KeyHandle == NULL) {
+    return FALSE;
+  }
+  return SpdmReqAsymSignHash (
+           ReqBaseAsymAlg,
+           BaseHashAlgo,
+           KeyHandle,
+           MessageHash,
+           Signature,
+           SigSize
+           );
+}
+
+/**
+  Release a private key loaded by SpdmRequesterDataLoadKeyFunc.
+
+  @param  ReqBaseAsymAlg               Indicates the signing algorithm.
+  @param  KeyHandle                    The private key handle.
+**/
+VOID
+EFIAPI
+SpdmRequesterDataReleaseKeyFunc (
+  IN      UINT16       ReqBaseAsymAlg,
+  IN      VOID         *KeyHandle
+  )
+{
+  if (KeyHandle == NULL) {
+    return ;
+  }
+  SpdmReqAsymFree (ReqBaseAsymAlg, KeyHandle);
+}
+
+/**
+  Load the responder private key once for repeated signing.
+
+  The returned handle is passed to SpdmResponderDataSignWithKeyFunc and
+  must be released with SpdmResponderDataReleaseKeyFunc.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  KeyHandle                    Pointer to receive the parsed private key handle.
+
+  @retval TRUE  the private key is loaded.
+  @retval FALSE the private key cannot be loaded.
+**/
+BOOLEAN
+EFIAPI
+SpdmResponderDataLoadKeyFunc (
+  IN      UINT32       BaseAsymAlgo,
+     OUT  VOID         **KeyHandle
+  )
+{
+  VOID                          *PrivatePem;
+  UINTN                         PrivatePemSize;
+  BOOLEAN                       Result;
+
+  Result = ReadResponderPrivateCertificate (BaseAsymAlgo, &PrivatePem, &PrivatePemSize);
+  if (!Result) {
+    return FALSE;
+  }
+
+  Result = SpdmAsymGetPrivateKeyFromPem (BaseAsymAlgo, PrivatePem, PrivatePemSize, NULL, KeyHandle);
+  ZeroMem (PrivatePem, PrivatePemSize);
   free (PrivatePem);
 
   return Result;
 }
 
+/**
+  Sign an SPDM message data with a private key loaded by SpdmResponderDataLoadKeyFunc.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  KeyHandle                    The private key handle.
+  @param  Message                      A pointer to a message to be signed (before hash).
+  @param  MessageSize                  The size in bytes of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmResponderDataSignWithKeyFunc (
+  IN      UINT32       BaseAsymAlgo,
+  IN      UINT32       BaseHashAlgo,
+  IN      VOID         *KeyHandle,
+  IN      CONST UINT8  *Message,
+  IN      UINTN        MessageSize,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  if (KeyHandle == NULL) {
+    return FALSE;
+  }
+  if (mDeviceDelayFunc != NULL) {
+    mDeviceDelayFunc (mDeviceSignDelay);
+  }
+  return SpdmAsymSign (
+           BaseAsymAlgo,
+           BaseHashAlgo,
+           KeyHandle,
+           Message,
+           MessageSize,
+           Signature,
+           SigSize
+           );
+}
+
+/**
+  Sign the hash of an SPDM message data with a private key loaded by SpdmResponderDataLoadKeyFunc.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  KeyHandle                    The private key handle.
+  @param  MessageHash                  A pointer to the hash of the message to be signed.
+  @param  Signature                    A pointer to a destination buffer to store the signature.
+  @param  SigSize                      On input, indicates the size in bytes of the destination buffer to store the signature.
+                                       On output, indicates the size in bytes of the signature in the buffer.
+
+  @retval TRUE  signing success.
+  @retval FALSE signing fail.
+**/
+BOOLEAN
+EFIAPI
+SpdmResponderDataSignHashWithKeyFunc (
+  IN      UINT32       BaseAsymAlgo,
+  IN      UINT32       BaseHashAlgo,
+  IN      VOID         *KeyHandle,
+  IN      CONST UINT8  *MessageHash,
+  OUT     UINT8        *Signature,
+  IN OUT  UINTN        *SigSize
+  )
+{
+  if (KeyHandle == NULL) {
+    return FALSE;
+  }
+  if (mDeviceDelayFunc != NULL) {
+    mDeviceDelayFunc (mDeviceSignDelay);
+  }
+  return SpdmAsymSignHash (
+           BaseAsymAlgo,
+           BaseHashAlgo,
+           KeyHandle,
+           MessageHash,
+           Signature,
+           SigSize
+           );
+}
+
+/**
+  Release a private key loaded by SpdmResponderDataLoadKeyFunc.
+
+  @param  BaseAsymAlgo                 Indicates the signing algorithm.
+  @param  KeyHandle                    The private key handle.
+**/
+VOID
+EFIAPI
+SpdmResponderDataReleaseKeyFunc (
+  IN      UINT32       BaseAsymAlgo,
+  IN      VOID         *KeyHandle
+  )
+{
+  if (KeyHandle == NULL) {
+    return ;
+  }
+  SpdmAsymFree (BaseAsymAlgo, KeyHandle);
+}
+
 UINT8  mMyZeroFilledBuffer[64];
-UINT8  gBinStr0[0x11] = {
-       0x00, 0x00, // Length - To be filled
+CONST UINT8  gBinStr0[0x11] = {
+       0x00, 0x00, // Length - filled in a copy
        0x73, 0x70, 0x64, 0x6d, 0x31, 0x2e, 0x31, 0x20, // Version: 'spdm1.1 '
        0x64, 0x65, 0x72, 0x69, 0x76, 0x65, 0x64,       // label: 'derived'
        };
 
+//
+// The PSK secrets extracted per PSK hint, kept so that a new PSK session with the same PSK hint
+// only runs HKDF-Expand. They do not depend on the session, only on the PSK and the hash algorithm.
+// The cache is shared by the threads of the concurrent server, under mDeviceAcquireLockFunc.
+//
+#define PSK_SECRET_CACHE_COUNT  4
+
+typedef struct {
+  BOOLEAN                       Valid;
+  UINT32                        BaseHashAlgo;
+  UINTN                         PskHintSize;
+  UINT8                         PskHint[MAX_SPDM_PSK_HINT_LENGTH];
+  UINT8                         HandshakeSecret[64];
+  UINT8                         MasterSecret[64];
+} PSK_SECRET_CACHE_ENTRY;
+
+PSK_SECRET_CACHE_ENTRY  mPskSecretCache[PSK_SECRET_CACHE_COUNT];
+UINTN                   mPskSecretCacheNext;
+
 /**
-  Derive HMAC-based Expand Key Derivation Function (HKDF) Expand, based upon the negotiated HKDF algorithm.
+  Find or add the PSK secret cache entry of a PSK hint. It is called with the lock of the cache held.
+
+  HandshakeSecret = HMAC(0, PSK). MasterSecret = HMAC(0, HKDF-Expand(HandshakeSecret, "derived")).
 
   @param  BaseHashAlgo                 Indicates the hash algorithm.
   @param  PskHint                      Pointer to the user-supplied PSK Hint.
   @param  PskHintSize                  PSK Hint size in bytes.
-  @param  Info                         Pointer to the application specific info.
-  @param  InfoSize                     Info size in bytes.
-  @param  Out                          Pointer to buffer to receive hkdf value.
-  @param  OutSize                      Size of hkdf bytes to generate.
 
-  @retval TRUE   Hkdf generated successfully.
-  @retval FALSE  Hkdf generation failed.
+  @return the PSK secret cache entry of the PSK hint, or NULL if the PSK hint is unknown.
 **/
-BOOLEAN
-EFIAPI
-SpdmPskHandshakeSecretHkdfExpandFunc (
-  IN      UINT32       BaseHashAlgo,
-  IN      CONST UINT8  *PskHint, OPTIONAL
-  IN      UINTN        PskHintSize, OPTIONAL
-  IN      CONST UINT8  *Info,
-  IN      UINTN        InfoSize,
-     OUT  UINT8        *Out,
-  IN      UINTN        OutSize
+PSK_SECRET_CACHE_ENTRY *
+SpdmFindPskSecret (
+  IN      UINT32                        BaseHashAlgo,
+  IN      CONST UINT8                   *PskHint, OPTIONAL
+  IN      UINTN                         PskHintSize OPTIONAL
   )
 {
   VOID                          *Psk;
   UINTN                         PskSize;
   UINTN                         HashSize;
   BOOLEAN                       Result;
-  UINT8                         HandshakeSecret[64];
+  UINT8                         Salt1[64];
+  UINT8                         BinStr0[sizeof(gBinStr0)];
+  UINTN                         Index;
+  PSK_SECRET_CACHE_ENTRY        *Entry;
 
   if ((PskHint == NULL) && (PskHintSize == 0)) {
     Psk = TEST_PSK_DATA_STRING;
@@ -319,22 +735,128 @@ SpdmPskHandshakeSecretHkdfExpandFunc (
     Psk = TEST_PSK_DATA_STRING;
     PskSize = sizeof(TEST_PSK_DATA_STRING);
   } else {
-    return FALSE;
+    return NULL;
+  }
+
+  for (Index = 0; Index < PSK_SECRET_CACHE_COUNT; Index++) {
+    Entry = &mPskSecretCache[Index];
+    if (Entry->Valid &&
+        (Entry->BaseHashAlgo == BaseHashAlgo) &&
+        (Entry->PskHintSize == PskHintSize) &&
+        ((PskHintSize == 0) || (CompareMem (Entry->PskHint, PskHint, PskHintSize) == 0))) {
+      return Entry;
+    }
   }
+
   printf ("[PSK]: ");
   DumpHexStr (Psk, PskSize);
   printf ("\n");
 
+  if (PskHintSize > MAX_SPDM_PSK_HINT_LENGTH) {
+    return NULL;
+  }
+  Entry = &mPskSecretCache[mPskSecretCacheNext];
+  mPskSecretCacheNext = (mPskSecretCacheNext + 1) % PSK_SECRET_CACHE_COUNT;
+  ZeroMem (Entry, sizeof(PSK_SECRET_CACHE_ENTRY));
+
   HashSize = GetSpdmHashSize (BaseHashAlgo);
 
-  Result = SpdmHmacAll (BaseHashAlgo, mMyZeroFilledBuffer, HashSize, Psk, PskSize, HandshakeSecret);
+  Result = SpdmHmacAll (BaseHashAlgo, mMyZeroFilledBuffer, HashSize, Psk, PskSize, Entry->HandshakeSecret);
+  if (!Result) {
+    return NULL;
+  }
+
+  CopyMem (BinStr0, gBinStr0, sizeof(BinStr0));
+  *(UINT16 *)BinStr0 = (UINT16)HashSize;
+  Result = SpdmHkdfExpand (BaseHashAlgo, Entry->HandshakeSecret, HashSize, BinStr0, sizeof(BinStr0), Salt1, HashSize);
   if (!Result) {
-    return Result;
+    ZeroMem (Entry, sizeof(PSK_SECRET_CACHE_ENTRY));
+    return NULL;
+  }
+
+  Result = SpdmHmacAll (BaseHashAlgo, mMyZeroFilledBuffer, HashSize, Salt1, HashSize, Entry->MasterSecret);
+  ZeroMem (Salt1, HashSize);
+  if (!Result) {
+    ZeroMem (Entry, sizeof(PSK_SECRET_CACHE_ENTRY));
+    return NULL;
+  }
+
+  Entry->BaseHashAlgo = BaseHashAlgo;
+  Entry->PskHintSize = PskHintSize;
+  CopyMem (Entry->PskHint, PskHint, PskHintSize);
+  Entry->Valid = TRUE;
+  return Entry;
+}
+
+/**
+  Copy a PSK secret of a PSK hint, from the PSK secret cache or extracted from the PSK.
+
+  The secret is copied out under the lock of the cache, because another thread may replace the entry.
+
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  PskHint                      Pointer to the user-supplied PSK Hint.
+  @param  PskHintSize                  PSK Hint size in bytes.
+  @param  IsMasterSecret               TRUE for the master secret, FALSE for the handshake secret.
+  @param  Secret                       The buffer of the secret, of the hash size.
+
+  @retval TRUE   The secret is copied.
+  @retval FALSE  The PSK hint is unknown, or the secret cannot be extracted.
+**/
+BOOLEAN
+SpdmGetPskSecret (
+  IN      UINT32                        BaseHashAlgo,
+  IN      CONST UINT8                   *PskHint, OPTIONAL
+  IN      UINTN                         PskHintSize, OPTIONAL
+  IN      BOOLEAN                       IsMasterSecret,
+     OUT  UINT8                         *Secret
+  )
+{
+  PSK_SECRET_CACHE_ENTRY        *Entry;
+
+  if (mDeviceAcquireLockFunc != NULL) {
+    mDeviceAcquireLockFunc ();
+  }
+  Entry = SpdmFindPskSecret (BaseHashAlgo, PskHint, PskHintSize);
+  if (Entry != NULL) {
+    CopyMem (Secret, IsMasterSecret ? Entry->MasterSecret : Entry->HandshakeSecret, GetSpdmHashSize (BaseHashAlgo));
   }
+  if (mDeviceReleaseLockFunc != NULL) {
+    mDeviceReleaseLockFunc ();
+  }
+  return (BOOLEAN)(Entry != NULL);
+}
+
+/**
+  Derive several HMAC-based Expand Key Derivation Function (HKDF) Expand outputs, based upon the negotiated HKDF algorithm.
+
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  PskHint                      Pointer to the user-supplied PSK Hint.
+  @param  PskHintSize                  PSK Hint size in bytes.
+  @param  Label                        Array of LabelCount labels, each with its info and output buffer.
+  @param  LabelCount                   Number of labels.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmPskHandshakeSecretHkdfExpandMultiFunc (
+  IN      UINT32                        BaseHashAlgo,
+  IN      CONST UINT8                   *PskHint, OPTIONAL
+  IN      UINTN                         PskHintSize, OPTIONAL
+  IN      CONST SPDM_HKDF_EXPAND_LABEL  *Label,
+  IN      UINTN                         LabelCount
+  )
+{
+  UINT8                         Secret[64];
+  BOOLEAN                       Result;
 
-  Result = SpdmHkdfExpand (BaseHashAlgo, HandshakeSecret, HashSize, Info, InfoSize, Out, OutSize);
-  ZeroMem (HandshakeSecret, HashSize);
+  if (!SpdmGetPskSecret (BaseHashAlgo, PskHint, PskHintSize, FALSE, Secret)) {
+    return FALSE;
+  }
 
+  Result = SpdmHkdfExpandMulti (BaseHashAlgo, Secret, GetSpdmHashSize (BaseHashAlgo), Label, LabelCount);
+  ZeroMem (Secret, sizeof(Secret));
   return Result;
 }
 
@@ -354,7 +876,7 @@ SpdmPskHandshakeSecretHkdfExpandFunc (
 **/
 BOOLEAN
 EFIAPI
-SpdmPskMasterSecretHkdfExpandFunc (
+SpdmPskHandshakeSecretHkdfExpandFunc (
   IN      UINT32       BaseHashAlgo,
   IN      CONST UINT8  *PskHint, OPTIONAL
   IN      UINTN        PskHintSize, OPTIONAL
@@ -364,49 +886,81 @@ SpdmPskMasterSecretHkdfExpandFunc (
   IN      UINTN        OutSize
   )
 {
-  VOID                          *Psk;
-  UINTN                         PskSize;
-  UINTN                         HashSize;
+  SPDM_HKDF_EXPAND_LABEL        Label;
+
+  Label.Info = Info;
+  Label.InfoSize = InfoSize;
+  Label.Out = Out;
+  Label.OutSize = OutSize;
+  return SpdmPskHandshakeSecretHkdfExpandMultiFunc (BaseHashAlgo, PskHint, PskHintSize, &Label, 1);
+}
+
+/**
+  Derive several HMAC-based Expand Key Derivation Function (HKDF) Expand outputs, based upon the negotiated HKDF algorithm.
+
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  PskHint                      Pointer to the user-supplied PSK Hint.
+  @param  PskHintSize                  PSK Hint size in bytes.
+  @param  Label                        Array of LabelCount labels, each with its info and output buffer.
+  @param  LabelCount                   Number of labels.
+
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmPskMasterSecretHkdfExpandMultiFunc (
+  IN      UINT32                        BaseHashAlgo,
+  IN      CONST UINT8                   *PskHint, OPTIONAL
+  IN      UINTN                         PskHintSize, OPTIONAL
+  IN      CONST SPDM_HKDF_EXPAND_LABEL  *Label,
+  IN      UINTN                         LabelCount
+  )
+{
+  UINT8                         Secret[64];
   BOOLEAN                       Result;
-  UINT8                         HandshakeSecret[64];
-  UINT8                         Salt1[64];
-  UINT8                         MasterSecret[64];
 
-  if ((PskHint == NULL) && (PskHintSize == 0)) {
-    Psk = TEST_PSK_DATA_STRING;
-    PskSize = sizeof(TEST_PSK_DATA_STRING);
-  } else if ((PskHint != NULL) && (PskHintSize != 0) &&
-             (strcmp((const char *)PskHint, TEST_PSK_HINT_STRING) == 0) &&
-             (PskHintSize == sizeof(TEST_PSK_HINT_STRING))) {
-    Psk = TEST_PSK_DATA_STRING;
-    PskSize = sizeof(TEST_PSK_DATA_STRING);
-  } else {
+  if (!SpdmGetPskSecret (BaseHashAlgo, PskHint, PskHintSize, TRUE, Secret)) {
     return FALSE;
   }
 
-  HashSize = GetSpdmHashSize (BaseHashAlgo);
-
-  Result = SpdmHmacAll (BaseHashAlgo, mMyZeroFilledBuffer, HashSize, Psk, PskSize, HandshakeSecret);
-  if (!Result) {
-    return Result;
-  }
+  Result = SpdmHkdfExpandMulti (BaseHashAlgo, Secret, GetSpdmHashSize (BaseHashAlgo), Label, LabelCount);
+  ZeroMem (Secret, sizeof(Secret));
+  return Result;
+}
 
-  *(UINT16 *)gBinStr0 = (UINT16)HashSize;
-  Result = SpdmHkdfExpand (BaseHashAlgo, HandshakeSecret, HashSize, gBinStr0, sizeof(gBinStr0), Salt1, HashSize);
-  ZeroMem (HandshakeSecret, HashSize);
-  if (!Result) {
-    return Result;
-  }
+/**
+  Derive HMAC-based Expand Key Derivation Function (HKDF) Expand, based upon the negotiated HKDF algorithm.
 
-  Result = SpdmHmacAll (BaseHashAlgo, mMyZeroFilledBuffer, HashSize, Salt1, HashSize, MasterSecret);
-  ZeroMem (Salt1, HashSize);
-  if (!Result) {
-    return Result;
-  }
+  @param  BaseHashAlgo                 Indicates the hash algorithm.
+  @param  PskHint                      Pointer to the user-supplied PSK Hint.
+  @param  PskHintSize                  PSK Hint size in bytes.
+  @param  Info                         Pointer to the application specific info.
+  @param  InfoSize                     Info size in bytes.
+  @param  Out                          Pointer to buffer to receive hkdf value.
+  @param  OutSize                      Size of hkdf bytes to generate.
 
-  Result = SpdmHkdfExpand (BaseHashAlgo, MasterSecret, HashSize, Info, InfoSize, Out, OutSize);
-  ZeroMem (MasterSecret, HashSize);
+  @retval TRUE   Hkdf generated successfully.
+  @retval FALSE  Hkdf generation failed.
+**/
+BOOLEAN
+EFIAPI
+SpdmPskMasterSecretHkdfExpandFunc (
+  IN      UINT32       BaseHashAlgo,
+  IN      CONST UINT8  *PskHint, OPTIONAL
+  IN      UINTN        PskHintSize, OPTIONAL
+  IN      CONST UINT8  *Info,
+  IN      UINTN        InfoSize,
+     OUT  UINT8        *Out,
+  IN      UINTN        OutSize
+  )
+{
+  SPDM_HKDF_EXPAND_LABEL        Label;
 
-  return Result;
+  Label.Info = Info;
+  Label.InfoSize = InfoSize;
+  Label.Out = Out;
+  Label.OutSize = OutSize;
+  return SpdmPskMasterSecretHkdfExpandMultiFunc (BaseHashAlgo, PskHint, PskHintSize, &Label, 1);
 }
 
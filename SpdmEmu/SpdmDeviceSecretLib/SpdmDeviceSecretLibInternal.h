@@ -18,6 +18,33 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define TEST_PSK_DATA_STRING  "TestPskData"
 #define TEST_PSK_HINT_STRING  "TestPskHint"
 
+//
+// The device cost model of the emulators. The signing of the responder and the measurement collection
+// call mDeviceDelayFunc with their delay in microseconds, if it is not NULL.
+//
+typedef
+VOID
+(*DEVICE_DELAY_FUNC) (
+  IN UINT32  Microseconds
+  );
+
+extern DEVICE_DELAY_FUNC  mDeviceDelayFunc;
+extern UINT32             mDeviceSignDelay;
+extern UINT32             mDeviceMeasurementDelay;
+
+//
+// The lock of the PSK secret cache, shared by the SPDM contexts of the process.
+// The concurrent server sets them to its server lock. They are NULL when one thread uses the library.
+//
+typedef
+VOID
+(*DEVICE_LOCK_FUNC) (
+  VOID
+  );
+
+extern DEVICE_LOCK_FUNC   mDeviceAcquireLockFunc;
+extern DEVICE_LOCK_FUNC   mDeviceReleaseLockFunc;
+
 #define TEST_CERT_MAXINT16  1
 #define TEST_CERT_MAXUINT16 2
 #define TEST_CERT_MAXUINT16_LARGER 3
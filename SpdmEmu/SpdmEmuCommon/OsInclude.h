@@ -58,6 +58,8 @@ typedef UINT32 size_t ;
 
 #define VOID void
 
+#define THREAD_LOCAL __declspec(thread)
+
 //
 // Prevent collisions with Windows API name macros that deal with Unicode/Not issues
 //
@@ -73,16 +75,29 @@ typedef UINT32 size_t ;
 
 #else
 // GCC
+//
+// The captures may be larger than 2 GB, also on a 32-bit host.
+//
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/resource.h>
 typedef int SOCKET;
 #define closesocket(x) close(x)
 #define INVALID_SOCKET (-1)
 #define SOCKET_ERROR (-1)
+#define THREAD_LOCAL __thread
 #endif
 
 
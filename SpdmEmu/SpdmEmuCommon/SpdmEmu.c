@@ -15,6 +15,58 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 */
 UINT32  mExeMode = EXE_MODE_SHUTDOWN;
 
+/*
+  SERVER_MODE_SERIAL
+  SERVER_MODE_CONCURRENT
+  SERVER_MODE_SHARDED
+*/
+UINT32  mServerMode = SERVER_MODE_SERIAL;
+
+//
+// The number of shards of the sharded server. 0 means one shard per online processor.
+//
+UINT32  mShardCount = 0;
+
+//
+// The load generator of the requester runs if mLoadOperation is not 0.
+//
+UINT32  mLoadOperation = 0;
+UINT32  mLoadConnectionCount = 0;
+UINT32  mLoadParallelCount = 1;
+UINT32  mLoadDuration = 10;
+
+/*
+  LOAD_IO_THREAD,
+  LOAD_IO_URING,
+  LOAD_IO_EPOLL
+*/
+UINT32  mLoadIo = LOAD_IO_THREAD;
+
+//
+// The responder replays the requests of the capture if mReplayFileName is not NULL.
+//
+CHAR8   *mReplayFileName = NULL;
+
+/*
+  REPLAY_PACE_FAST,
+  REPLAY_PACE_ORIGINAL
+*/
+UINT32  mReplayPace = REPLAY_PACE_FAST;
+UINT32  mReplayLoopCount = 1;
+
+//
+// The certificates are loaded from mProvisionFileName if it is not NULL,
+// or written to mProvisionBuildFileName if it is not NULL.
+//
+CHAR8   *mProvisionFileName = NULL;
+CHAR8   *mProvisionBuildFileName = NULL;
+
+//
+// The responder takes the DHE key pairs of KEY_EXCHANGE_RSP from mDheKeyPool if mDheKeyPoolSize is not 0.
+//
+UINT32  mDheKeyPoolSize = 0;
+VOID    *mDheKeyPool = NULL;
+
 UINT32  mExeConnection = (0 |
                           // EXE_CONNECTION_VERSION_ONLY |
                           EXE_CONNECTION_DIGEST |
@@ -62,6 +114,32 @@ PrintUsage (
   printf ("   [--exe_conn VER_ONLY|DIGEST|CERT|CHAL|MEAS]\n");
   printf ("   [--exe_session KEY_EX|PSK|NO_END|KEY_UPDATE|HEARTBEAT|MEAS]\n");
   printf ("   [--pcap <PcapFileName>]\n");
+  printf ("   [--pcap_mode SYNC|ASYNC]\n");
+  printf ("   [--trace <TraceFileName>]\n");
+  printf ("   [--metrics <MetricsFileName>]\n");
+  printf ("   [--metrics_interval <Seconds>]\n");
+  printf ("   [--dhe_pool <EntryCount>]\n");
+  printf ("   [--link SMBUS|I3C|PCIE_VDM|DOE|LOOPBACK]\n");
+  printf ("   [--link_bandwidth <BitsPerSecond>]\n");
+  printf ("   [--link_latency <Microseconds>]\n");
+  printf ("   [--link_mtu <Bytes>]\n");
+  printf ("   [--sign_delay <Microseconds>]\n");
+  printf ("   [--meas_delay <Microseconds>]\n");
+  printf ("   [--dhe_delay <Microseconds>]\n");
+  printf ("   [--shm <SharedMemoryName>]\n");
+  printf ("   [--io_dump YES|NO]\n");
+  printf ("   [--server_mode SERIAL|CONCURRENT|SHARDED]\n");
+  printf ("   [--shard_count <ShardCount>]\n");
+  printf ("   [--load_op VCA|AUTH|KEY_EX|PSK|APP]\n");
+  printf ("   [--load_conn <ConnectionCount>]\n");
+  printf ("   [--load_parallel <ParallelCount>]\n");
+  printf ("   [--load_duration <Seconds>]\n");
+  printf ("   [--load_io THREAD|URING|EPOLL]\n");
+  printf ("   [--replay <PcapFileName>]\n");
+  printf ("   [--replay_pace FAST|ORIGINAL]\n");
+  printf ("   [--replay_loop <LoopCount>]\n");
+  printf ("   [--provision <ProvisionImageFileName>]\n");
+  printf ("   [--provision_build <ProvisionImageFileName>]\n");
   printf ("\n");
   printf ("NOTE:\n");
   printf ("   [--trans] is used to select transport layer message. By default, MCTP is used.\n");
@@ -90,16 +168,17 @@ PrintUsage (
   printf ("           0xFF must be used to if PUB_KEY_ID is set. No GET_DIGEST/GET_CERTIFICATE is sent.\n");
   printf ("   [--slot_count] is to select the local slot count. By default, 3 is used.\n");
   printf ("   [--save_state] is to save the current negotiated state to a write-only file.\n");
-  printf ("           The requester and responder will save state after GET_VERSION/GET_CAPABILLITIES/NEGOTIATE_ALGORITHMS.\n");
-  printf ("           (negotiated state == ver|cap|hash|meas_spec|meas_hash|asym|req_asym|dhe|aead|key_schedule)\n");
+  printf ("           The requester and responder will save state after END_SESSION.\n");
+  printf ("           (negotiated state == ver|cap|hash|meas_spec|meas_hash|asym|req_asym|dhe|aead|key_schedule, VCA transcript and peer certificate chain)\n");
   printf ("           The responder should set CACHE capabilities, otherwise the state will not be saved.\n");
   printf ("           The requester will clear PRESERVE_NEGOTIATED_STATE_CLEAR bit in END_SESSION to preserve, otherwise this bit is set.\n");
   printf ("           The responder will save empty state, if the requester sets PRESERVE_NEGOTIATED_STATE_CLEAR bit in END_SESSION.\n");
   printf ("   [--load_state] is to load the negotiated state to current session from a read-only file.\n");
-  printf ("           The requester and responder will provision the state just after SPDM context is created.\n");
-  printf ("           The user need guarantee the state file is gnerated correctly.\n");
-  printf ("           The command line input - ver|cap|hash|meas_spec|meas_hash|asym|req_asym|dhe|aead|key_schedule are ignored.\n");
-  printf ("           The requester will skip GET_VERSION/GET_CAPABILLITIES/NEGOTIATE_ALGORITHMS.\n");
+  printf ("           The requester and responder will provision the state just after the local settings are set.\n");
+  printf ("           The user need guarantee the state file is saved with the same peer and the same command line input.\n");
+  printf ("           The negotiated ver|cap|hash|meas_spec|meas_hash|asym|req_asym|dhe|aead|key_schedule are loaded from the state.\n");
+  printf ("           The requester will skip GET_VERSION/GET_CAPABILLITIES/NEGOTIATE_ALGORITHMS,\n");
+  printf ("           and GET_DIGEST/GET_CERTIFICATE if the certificate chain of the responder is preserved.\n");
   printf ("   [--exe_mode] is used to control the execution mode. By default, it is SHUTDOWN.\n");
   printf ("           SHUTDOWN means the requester asks the responder to stop.\n");
   printf ("           CONTINUE means the requester asks the responder to preserve the current SPDM context.\n");
@@ -117,6 +196,80 @@ PrintUsage (
   printf ("           HEARTBEAT means to send HEARTBEAT in session.\n");
   printf ("           MEAS means send GET_MEASUREMENT command in session.\n");
   printf ("   [--pcap] is used to generate PCAP dump file for offline analysis.\n");
+  printf ("           If the file name ends with .pcapng, the pcapng format is used.\n");
+  printf ("   [--pcap_mode] is used to control how the packets are written to the PCAP file. By default, SYNC is used.\n");
+  printf ("           SYNC means to write each packet to the file when it is sent or received.\n");
+  printf ("           ASYNC means to copy each packet to a ring, written to the file by a writer thread. The packets are dropped if the ring is full.\n");
+  printf ("           ASYNC can be used with --load_op and --server_mode CONCURRENT or SHARDED. The packets of the connections are interleaved in the file.\n");
+  printf ("   [--trace] is used to generate the per-message timing trace in the Chrome trace event format, for chrome://tracing or Perfetto.\n");
+  printf ("           The requester records the transport time of each request, and the local time between the requests.\n");
+  printf ("           The responder records the processing time of each request, with the crypto and callback time if the stats are supported.\n");
+  printf ("           Both use the monotonic clock of the host, so the two trace files can be merged, e.g. with: jq -s add <Files>.\n");
+  printf ("           It cannot be used with --load_op or --server_mode CONCURRENT or SHARDED.\n");
+  printf ("   [--metrics] is used to publish the statistics in the OpenMetrics text format, for a Prometheus textfile collector or the CI.\n");
+  printf ("           The file is replaced every --metrics_interval and at exit. It has the latency histograms and the counters of each request code,\n");
+  printf ("           the crypto operations, the sessions and the DHE key pool, as far as the SPDM library is built with the statistics.\n");
+  printf ("           It works with --load_op and --server_mode CONCURRENT or SHARDED. The statistics of all the connections are summed.\n");
+  printf ("   [--metrics_interval] is the interval of --metrics, in seconds. By default, 10 is used.\n");
+  printf ("   [--dhe_pool] is the number of DHE key pairs the responder generates ahead of KEY_EXCHANGE. By default, 0 means no pool.\n");
+  printf ("           The pool is shared by all the connections, and refilled with the negotiated DHE group after each response.\n");
+  printf ("   [--link] is used to model the link of a real transport over the platform socket, with rough figures of its bandwidth, latency and MTU.\n");
+  printf ("           Each emulator delays the messages it sends by the time they take on the link, so please give both emulators the same link.\n");
+  printf ("           A message is split in packets of the MTU, sent one after another. Each packet takes the latency, and all of them take the bandwidth.\n");
+  printf ("           SMBUS means MCTP over SMBus at 100 kHz. I3C means MCTP over I3C at 12.5 MHz. PCIE_VDM means MCTP over PCIe VDM.\n");
+  printf ("           DOE means a PCIe DOE mailbox. LOOPBACK means no delay, which is the default.\n");
+  printf ("           It cannot be used with --load_io URING or EPOLL.\n");
+  printf ("   [--link_bandwidth] is the bandwidth of the link, in bits per second. 0 means no limit. It overrides the bandwidth of --link given before.\n");
+  printf ("   [--link_latency] is the latency of each packet on the link, in microseconds. It overrides the latency of --link given before.\n");
+  printf ("   [--link_mtu] is the maximum size of a packet on the link, in bytes. 0 means one packet per message. It overrides the MTU of --link given before.\n");
+  printf ("   [--sign_delay] is the time the responder device takes to sign, e.g. in an HSM, in microseconds. By default, 0 is used.\n");
+  printf ("           It is added to each CHALLENGE_AUTH, KEY_EXCHANGE_RSP and MEASUREMENTS signing.\n");
+  printf ("   [--meas_delay] is the time the responder device takes to collect its measurements, in microseconds. By default, 0 is used.\n");
+  printf ("   [--dhe_delay] is the time the responder device takes for each DHE step of KEY_EXCHANGE, in microseconds. By default, 0 is used.\n");
+  printf ("           It is added after the DHE key pair generation and after the DHE shared secret computation.\n");
+  printf ("   [--shm] is used to exchange the messages via the shared memory /dev/shm/<SharedMemoryName> instead of the platform socket.\n");
+  printf ("           It works with any --trans. The responder must be started first.\n");
+  printf ("   [--io_dump] is used to dump each platform message field. By default, YES is used.\n");
+  printf ("           NO means to skip the dump, to measure the throughput and the latency.\n");
+  printf ("   [--server_mode] is used to control how the responder serves the clients. By default, SERIAL is used.\n");
+  printf ("           SERIAL means to serve one client after another with one SPDM context.\n");
+  printf ("           CONCURRENT means to serve each client in its own thread with its own SPDM context, until the responder is killed.\n");
+  printf ("           SHARDED means to serve the clients with one shard per processor, until the responder is killed.\n");
+  printf ("           Each shard has its own listening socket on the same port (SO_REUSEPORT), its own thread on its own processor,\n");
+  printf ("           and its own SPDM context, serving its clients one after another. The kernel spreads the clients to the shards.\n");
+  printf ("           CONCURRENT and SHARDED cannot be used with --shm, --pcap SYNC, --save_state or --load_state.\n");
+  printf ("           SHARDED is not supported on Windows.\n");
+  printf ("   [--shard_count] is the number of shards of --server_mode SHARDED. By default, 0 means one shard per online processor.\n");
+  printf ("   [--load_op] is used to run the requester as a load generator. Multiple operations can be set together. Please use ',' for them.\n");
+  printf ("           Each connection runs VCA, then the selected operations in order, then sends CONTINUE.\n");
+  printf ("           VCA means GET_VERSION, GET_CAPABILITIES and NEGOTIATE_ALGORITHMS only.\n");
+  printf ("           AUTH means GET_DIGESTS, GET_CERTIFICATE and CHALLENGE, as selected by --exe_conn.\n");
+  printf ("           KEY_EX means to setup and end a KEY_EXCHANGE session.\n");
+  printf ("           PSK means to setup and end a PSK_EXCHANGE session.\n");
+  printf ("           APP means to send one APP message in each session. It implies KEY_EX if PSK is not set.\n");
+  printf ("           It cannot be used with --shm, --pcap SYNC, --save_state or --load_state.\n");
+  printf ("   [--load_conn] is the number of connections of the load generator. By default, 0 means no limit.\n");
+  printf ("   [--load_parallel] is the number of connections run in parallel by the load generator. By default, 1 is used.\n");
+  printf ("   [--load_duration] is the maximum duration of the load generator, in seconds. By default, 10 is used. 0 means no limit.\n");
+  printf ("   [--load_io] is used to control how the load generator drives the connections. By default, THREAD is used.\n");
+  printf ("           THREAD means to run each parallel connection in its own thread with the blocking socket.\n");
+  printf ("           URING means to drive all the parallel connections from one thread with io_uring, or with epoll if io_uring is not available.\n");
+  printf ("           EPOLL means to drive all the parallel connections from one thread with epoll.\n");
+  printf ("           URING and EPOLL support all the --load_op operations. The sessions are not ended by END_SESSION.\n");
+  printf ("   [--replay] is used to run the responder as a benchmark, on the requests of a PCAP or PCAPNG file of --trans, instead of serving the clients.\n");
+  printf ("           The requests are given to the responder in order, and each response is compared with the captured response.\n");
+  printf ("           VERSION, CAPABILITIES, ALGORITHMS, DIGESTS, CERTIFICATE and ERROR are compared byte by byte, the other responses by their code only.\n");
+  printf ("           The secured messages are skipped, because their session keys cannot be reproduced.\n");
+  printf ("           It cannot be used with --shm, --pcap, --trace or --server_mode CONCURRENT or SHARDED.\n");
+  printf ("   [--replay_pace] is used to control when the requests are replayed. By default, FAST is used.\n");
+  printf ("           FAST means to give each request as soon as the previous one is answered, to measure the throughput.\n");
+  printf ("           ORIGINAL means to give each request at its captured time, relative to the first request.\n");
+  printf ("   [--replay_loop] is the number of times the capture is replayed. By default, 1 is used.\n");
+  printf ("   [--provision] is used to load all the certificates at startup from a provisioning image, instead of the certificate files.\n");
+  printf ("           The certificate chains and the root certificate hashes are used as they are in the image.\n");
+  printf ("           The certificates missing from the image are still read from the certificate files.\n");
+  printf ("   [--provision_build] is used to build a provisioning image from the certificate files, then exit.\n");
+  printf ("           The image has the certificates of each algorithm of --hash, --asym and --req_asym.\n");
 }
 
 typedef struct {
@@ -285,6 +438,36 @@ VALUE_STRING_ENTRY  mExeModeStringTable[] = {
   {EXE_MODE_CONTINUE, "CONTINUE"},
 };
 
+VALUE_STRING_ENTRY  mServerModeStringTable[] = {
+  {SERVER_MODE_SERIAL,     "SERIAL"},
+  {SERVER_MODE_CONCURRENT, "CONCURRENT"},
+  {SERVER_MODE_SHARDED,    "SHARDED"},
+};
+
+VALUE_STRING_ENTRY  mLoadOperationStringTable[] = {
+  {LOAD_OPERATION_VCA,    "VCA"},
+  {LOAD_OPERATION_AUTH,   "AUTH"},
+  {LOAD_OPERATION_KEY_EX, "KEY_EX"},
+  {LOAD_OPERATION_PSK,    "PSK"},
+  {LOAD_OPERATION_APP,    "APP"},
+};
+
+VALUE_STRING_ENTRY  mLoadIoStringTable[] = {
+  {LOAD_IO_THREAD, "THREAD"},
+  {LOAD_IO_URING,  "URING"},
+  {LOAD_IO_EPOLL,  "EPOLL"},
+};
+
+VALUE_STRING_ENTRY  mPcapModeStringTable[] = {
+  {PCAP_MODE_SYNC,  "SYNC"},
+  {PCAP_MODE_ASYNC, "ASYNC"},
+};
+
+VALUE_STRING_ENTRY  mReplayPaceStringTable[] = {
+  {REPLAY_PACE_FAST,     "FAST"},
+  {REPLAY_PACE_ORIGINAL, "ORIGINAL"},
+};
+
 VALUE_STRING_ENTRY  mExeConnectionStringTable[] = {
   {EXE_CONNECTION_VERSION_ONLY,    "VER_ONLY"},
   {EXE_CONNECTION_DIGEST,          "DIGEST"},
@@ -373,6 +556,7 @@ ProcessArgs (
 {
   UINT32  Data32;
   CHAR8   *PcapFileName;
+  CHAR8   *EndOfNumber;
 
   PcapFileName = NULL;
 
@@ -764,6 +948,7 @@ ProcessArgs (
     if (strcmp (argv[0], "--save_state") == 0) {
       if (argc >= 2) {
         mSaveStateFileName = argv[1];
+        mEndSessionAttributes = 0;
         argc -= 2;
         argv += 2;
         continue;
@@ -854,11 +1039,372 @@ ProcessArgs (
       }
     }
 
+    if (strcmp (argv[0], "--pcap_mode") == 0) {
+      if (argc >= 2) {
+        if (!GetValueFromName (mPcapModeStringTable, ARRAY_SIZE(mPcapModeStringTable), argv[1], &mPcapMode)) {
+          printf ("invalid --pcap_mode %s\n", argv[1]);
+          PrintUsage (ProgramName);
+          exit (0);
+        }
+        printf ("pcap_mode - 0x%08x\n", mPcapMode);
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --pcap_mode\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--trace") == 0) {
+      if (argc >= 2) {
+        mTraceFileName = argv[1];
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --trace\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--metrics") == 0) {
+      if (argc >= 2) {
+        mMetricsFileName = argv[1];
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --metrics\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--shm") == 0) {
+      if (argc >= 2) {
+        mSharedMemoryName = argv[1];
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --shm\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--server_mode") == 0) {
+      if (argc >= 2) {
+        if (!GetValueFromName (mServerModeStringTable, ARRAY_SIZE(mServerModeStringTable), argv[1], &mServerMode)) {
+          printf ("invalid --server_mode %s\n", argv[1]);
+          PrintUsage (ProgramName);
+          exit (0);
+        }
+        printf ("server_mode - 0x%08x\n", mServerMode);
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --server_mode\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--load_op") == 0) {
+      if (argc >= 2) {
+        if (!GetFlagsFromName (mLoadOperationStringTable, ARRAY_SIZE(mLoadOperationStringTable), argv[1], &mLoadOperation)) {
+          printf ("invalid --load_op %s\n", argv[1]);
+          PrintUsage (ProgramName);
+          exit (0);
+        }
+        printf ("load_op - 0x%08x\n", mLoadOperation);
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --load_op\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if ((strcmp (argv[0], "--load_conn") == 0) ||
+        (strcmp (argv[0], "--load_parallel") == 0) ||
+        (strcmp (argv[0], "--load_duration") == 0) ||
+        (strcmp (argv[0], "--shard_count") == 0) ||
+        (strcmp (argv[0], "--metrics_interval") == 0) ||
+        (strcmp (argv[0], "--dhe_pool") == 0) ||
+        (strcmp (argv[0], "--link_bandwidth") == 0) ||
+        (strcmp (argv[0], "--link_latency") == 0) ||
+        (strcmp (argv[0], "--link_mtu") == 0) ||
+        (strcmp (argv[0], "--sign_delay") == 0) ||
+        (strcmp (argv[0], "--meas_delay") == 0) ||
+        (strcmp (argv[0], "--dhe_delay") == 0)) {
+      if (argc >= 2) {
+        Data32 = (UINT32)strtoul (argv[1], &EndOfNumber, 0);
+        if ((*argv[1] == 0) || (*EndOfNumber != 0) ||
+            (((strcmp (argv[0], "--load_parallel") == 0) || (strcmp (argv[0], "--metrics_interval") == 0)) && (Data32 == 0))) {
+          printf ("invalid %s %s\n", argv[0], argv[1]);
+          PrintUsage (ProgramName);
+          exit (0);
+        }
+        if (strcmp (argv[0], "--load_conn") == 0) {
+          mLoadConnectionCount = Data32;
+        } else if (strcmp (argv[0], "--load_parallel") == 0) {
+          mLoadParallelCount = Data32;
+        } else if (strcmp (argv[0], "--shard_count") == 0) {
+          mShardCount = Data32;
+        } else if (strcmp (argv[0], "--metrics_interval") == 0) {
+          mMetricsInterval = Data32;
+        } else if (strcmp (argv[0], "--dhe_pool") == 0) {
+          mDheKeyPoolSize = Data32;
+        } else if (strcmp (argv[0], "--link_bandwidth") == 0) {
+          mLinkBandwidth = Data32;
+        } else if (strcmp (argv[0], "--link_latency") == 0) {
+          mLinkLatency = Data32;
+        } else if (strcmp (argv[0], "--link_mtu") == 0) {
+          mLinkMtu = Data32;
+        } else if (strcmp (argv[0], "--sign_delay") == 0) {
+          mDeviceSignDelay = Data32;
+        } else if (strcmp (argv[0], "--meas_delay") == 0) {
+          mDeviceMeasurementDelay = Data32;
+        } else if (strcmp (argv[0], "--dhe_delay") == 0) {
+          mDheDelay = Data32;
+        } else {
+          mLoadDuration = Data32;
+        }
+        printf ("%s - %d\n", argv[0] + 2, Data32);
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid %s\n", argv[0]);
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--link") == 0) {
+      if (argc >= 2) {
+        if (!CostModelSetLinkPreset (argv[1])) {
+          printf ("invalid --link %s\n", argv[1]);
+          PrintUsage (ProgramName);
+          exit (0);
+        }
+        printf ("link - %s\n", argv[1]);
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --link\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--load_io") == 0) {
+      if (argc >= 2) {
+        if (!GetValueFromName (mLoadIoStringTable, ARRAY_SIZE(mLoadIoStringTable), argv[1], &mLoadIo)) {
+          printf ("invalid --load_io %s\n", argv[1]);
+          PrintUsage (ProgramName);
+          exit (0);
+        }
+        printf ("load_io - 0x%08x\n", mLoadIo);
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --load_io\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--replay") == 0) {
+      if (argc >= 2) {
+        mReplayFileName = argv[1];
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --replay\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--provision") == 0) {
+      if (argc >= 2) {
+        mProvisionFileName = argv[1];
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --provision\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--provision_build") == 0) {
+      if (argc >= 2) {
+        mProvisionBuildFileName = argv[1];
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --provision_build\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--replay_pace") == 0) {
+      if (argc >= 2) {
+        if (!GetValueFromName (mReplayPaceStringTable, ARRAY_SIZE(mReplayPaceStringTable), argv[1], &mReplayPace)) {
+          printf ("invalid --replay_pace %s\n", argv[1]);
+          PrintUsage (ProgramName);
+          exit (0);
+        }
+        printf ("replay_pace - 0x%08x\n", mReplayPace);
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --replay_pace\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--replay_loop") == 0) {
+      if (argc >= 2) {
+        mReplayLoopCount = (UINT32)strtoul (argv[1], &EndOfNumber, 0);
+        if ((*argv[1] == 0) || (*EndOfNumber != 0) || (mReplayLoopCount == 0)) {
+          printf ("invalid --replay_loop %s\n", argv[1]);
+          PrintUsage (ProgramName);
+          exit (0);
+        }
+        printf ("replay_loop - %d\n", mReplayLoopCount);
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --replay_loop\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
+    if (strcmp (argv[0], "--io_dump") == 0) {
+      if (argc >= 2) {
+        if (strcmp (argv[1], "YES") == 0) {
+          mDumpPlatformData = TRUE;
+        } else if (strcmp (argv[1], "NO") == 0) {
+          mDumpPlatformData = FALSE;
+        } else {
+          printf ("invalid --io_dump %s\n", argv[1]);
+          PrintUsage (ProgramName);
+          exit (0);
+        }
+        printf ("io_dump - %s\n", argv[1]);
+        argc -= 2;
+        argv += 2;
+        continue;
+      } else {
+        printf ("invalid --io_dump\n");
+        PrintUsage (ProgramName);
+        exit (0);
+      }
+    }
+
     printf ("invalid %s\n", argv[0]);
     PrintUsage (ProgramName);
     exit (0);
   }
 
+  //
+  // Only the ring of the asynchronous PCAP writer is shared by several threads.
+  //
+  if ((mLoadOperation != 0) &&
+      ((mSharedMemoryName != NULL) || ((PcapFileName != NULL) && (mPcapMode == PCAP_MODE_SYNC)) ||
+       (mSaveStateFileName != NULL) || (mLoadStateFileName != NULL))) {
+    printf ("invalid --load_op with --shm, --pcap SYNC, --save_state or --load_state\n");
+    PrintUsage (ProgramName);
+    exit (0);
+  }
+
+  //
+  // The link delay blocks the sender, which would stall all the connections of one I/O thread.
+  //
+  if ((mLoadIo != LOAD_IO_THREAD) && CostModelLinkEnabled ()) {
+    printf ("invalid --link with --load_io %s\n", (mLoadIo == LOAD_IO_URING) ? "URING" : "EPOLL");
+    PrintUsage (ProgramName);
+    exit (0);
+  }
+  if ((mDeviceSignDelay != 0) || (mDeviceMeasurementDelay != 0)) {
+    mDeviceDelayFunc = CostModelDelay;
+  }
+
+  //
+  // The concurrent clients cannot share the shared memory rings, the synchronous PCAP file or the state file.
+  //
+  if ((mServerMode != SERVER_MODE_SERIAL) &&
+      ((mSharedMemoryName != NULL) || ((PcapFileName != NULL) && (mPcapMode == PCAP_MODE_SYNC)) ||
+       (mSaveStateFileName != NULL) || (mLoadStateFileName != NULL))) {
+    printf ("invalid --server_mode %s with --shm, --pcap SYNC, --save_state or --load_state\n",
+      (mServerMode == SERVER_MODE_CONCURRENT) ? "CONCURRENT" : "SHARDED");
+    PrintUsage (ProgramName);
+    exit (0);
+  }
+
+#ifdef _MSC_VER
+  //
+  // Winsock has no SO_REUSEPORT to balance the clients of one port over multiple listening sockets.
+  //
+  if (mServerMode == SERVER_MODE_SHARDED) {
+    printf ("invalid --server_mode SHARDED on Windows\n");
+    PrintUsage (ProgramName);
+    exit (0);
+  }
+#endif
+
+  //
+  // The trace records one message at a time, from one SPDM context.
+  //
+  if ((mTraceFileName != NULL) && ((mLoadOperation != 0) || (mServerMode != SERVER_MODE_SERIAL))) {
+    printf ("invalid --trace with --load_op or --server_mode CONCURRENT or SHARDED\n");
+    PrintUsage (ProgramName);
+    exit (0);
+  }
+
+  //
+  // The replay gives the captured requests to one SPDM context, without any client.
+  //
+  if ((mReplayFileName != NULL) &&
+      ((mSharedMemoryName != NULL) || (PcapFileName != NULL) || (mTraceFileName != NULL) || (mServerMode != SERVER_MODE_SERIAL))) {
+    printf ("invalid --replay with --shm, --pcap, --trace or --server_mode CONCURRENT or SHARDED\n");
+    PrintUsage (ProgramName);
+    exit (0);
+  }
+
+  //
+  // The provisioning image is built offline, with the algorithms of the command line.
+  //
+  if (mProvisionBuildFileName != NULL) {
+    exit (BuildProvisionImage (mProvisionBuildFileName) ? 0 : 1);
+  }
+  if (mProvisionFileName != NULL) {
+    if (!LoadProvisionImage (mProvisionFileName)) {
+      PrintUsage (ProgramName);
+      exit (0);
+    }
+  }
+
   //
   // Open PCAP file as last option, after the user indicates transport type.
   //
@@ -868,6 +1414,18 @@ ProcessArgs (
       exit (0);
     }
   }
+  if (mTraceFileName != NULL) {
+    if (!OpenTraceFile (mTraceFileName, ProgramName)) {
+      PrintUsage (ProgramName);
+      exit (0);
+    }
+  }
+  if (mMetricsFileName != NULL) {
+    if (!OpenMetricsFile (mMetricsFileName, ProgramName)) {
+      PrintUsage (ProgramName);
+      exit (0);
+    }
+  }
 
   return ;
 }
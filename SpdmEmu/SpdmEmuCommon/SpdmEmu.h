@@ -13,6 +13,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Base.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/SpdmCommonLib.h>
+#include <Library/TimerLib.h>
 #include <IndustryStandard/MctpBinding.h>
 #include <IndustryStandard/Pldm.h>
 #include <IndustryStandard/PciDoeBinding.h>
@@ -29,6 +30,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "SpdmEmuNvStorage.h"
 
 extern UINT32  mUseTransportLayer;
+extern CHAR8   *mSharedMemoryName;
+extern BOOLEAN mDumpPlatformData;
 extern UINT8   mUseVersion;
 extern UINT8   mUseSecuredMessageVersion;
 extern UINT32  mUseRequesterCapabilityFlags;
@@ -68,6 +71,52 @@ extern CHAR8 *mSaveStateFileName;
 #define EXE_MODE_CONTINUE  1
 extern UINT32  mExeMode;
 
+#define SERVER_MODE_SERIAL      0
+#define SERVER_MODE_CONCURRENT  1
+#define SERVER_MODE_SHARDED     2
+extern UINT32  mServerMode;
+extern UINT32  mShardCount;
+
+#define LOAD_OPERATION_VCA              0x1
+#define LOAD_OPERATION_AUTH             0x2
+#define LOAD_OPERATION_KEY_EX           0x4
+#define LOAD_OPERATION_PSK              0x8
+#define LOAD_OPERATION_APP              0x10
+extern UINT32  mLoadOperation;
+extern UINT32  mLoadConnectionCount;
+extern UINT32  mLoadParallelCount;
+extern UINT32  mLoadDuration;
+
+#define LOAD_IO_THREAD                  0
+#define LOAD_IO_URING                   1
+#define LOAD_IO_EPOLL                   2
+extern UINT32  mLoadIo;
+
+#define TRACE_TRACK_REQUESTER_TRANSPORT 1
+#define TRACE_TRACK_REQUESTER_LOCAL     2
+#define TRACE_TRACK_RESPONDER           3
+#define TRACE_TIME_UNKNOWN              ((UINT64)-1)
+extern CHAR8   *mTraceFileName;
+
+extern CHAR8   *mMetricsFileName;
+extern UINT32  mMetricsInterval;
+extern UINT32  mDheKeyPoolSize;
+extern VOID    *mDheKeyPool;
+
+#define REPLAY_PACE_FAST                0
+#define REPLAY_PACE_ORIGINAL            1
+extern CHAR8   *mReplayFileName;
+extern UINT32  mReplayPace;
+extern UINT32  mReplayLoopCount;
+
+extern CHAR8   *mProvisionFileName;
+extern CHAR8   *mProvisionBuildFileName;
+
+extern UINT32  mLinkBandwidth;
+extern UINT32  mLinkLatency;
+extern UINT32  mLinkMtu;
+extern UINT32  mDheDelay;
+
 #define EXE_CONNECTION_VERSION_ONLY     0x1
 #define EXE_CONNECTION_DIGEST           0x2
 #define EXE_CONNECTION_CERT             0x4
@@ -101,6 +150,11 @@ DumpHex (
   IN UINTN BufferSize
   );
 
+VOID
+InitPlatformSocket (
+  IN SOCKET           Socket
+  );
+
 BOOLEAN
 SendPlatformData (
   IN SOCKET           Socket,
@@ -117,6 +171,119 @@ ReceivePlatformData (
   IN OUT UINTN         *BytesToReceive
   );
 
+BOOLEAN
+SharedMemoryInit (
+  IN BOOLEAN          IsServer
+  );
+
+VOID
+SharedMemoryClose (
+  VOID
+  );
+
+BOOLEAN
+SharedMemorySendPlatformData (
+  IN UINT32           Command,
+  IN UINT8            *SendBuffer,
+  IN UINTN            BytesToSend
+  );
+
+BOOLEAN
+SharedMemoryReceivePlatformData (
+  OUT UINT32          *Command,
+  OUT UINT8           *ReceiveBuffer,
+  IN OUT UINTN        *BytesToReceive
+  );
+
+#define ASYNC_IO_BACKEND_URING  1
+#define ASYNC_IO_BACKEND_EPOLL  2
+
+typedef struct {
+  VOID     *Connection;
+  VOID     *Context;
+  BOOLEAN  Result;
+  UINT32   Command;
+  UINT8    *Payload;
+  UINTN    PayloadSize;
+} ASYNC_IO_EVENT;
+
+BOOLEAN
+AsyncIoInit (
+  IN UINT32           Backend,
+  IN UINT32           MaxConnectionCount
+  );
+
+VOID
+AsyncIoClose (
+  VOID
+  );
+
+UINT32
+AsyncIoGetBackend (
+  VOID
+  );
+
+VOID *
+AsyncIoAddConnection (
+  IN SOCKET           Socket,
+  IN VOID             *Context
+  );
+
+VOID
+AsyncIoRemoveConnection (
+  IN VOID             *Connection
+  );
+
+UINT8 *
+AsyncIoGetSendBuffer (
+  IN  VOID            *Connection,
+  OUT UINTN           *BufferSize
+  );
+
+BOOLEAN
+AsyncIoQueueSend (
+  IN VOID             *Connection,
+  IN UINT32           Command,
+  IN UINTN            PayloadSize
+  );
+
+BOOLEAN
+AsyncIoQueueReceive (
+  IN VOID             *Connection
+  );
+
+UINT32
+AsyncIoWait (
+  OUT ASYNC_IO_EVENT  *Events,
+  IN  UINT32          MaxEventCount
+  );
+
+#define CERT_KIND_RESPONDER_CHAIN   0
+#define CERT_KIND_RESPONDER_ROOT    1
+#define CERT_KIND_REQUESTER_CHAIN   2
+#define CERT_KIND_REQUESTER_ROOT    3
+
+BOOLEAN
+ReadCachedCertificate (
+  IN  UINT32               Kind,
+  IN  UINT32               HashAlgo,
+  IN  UINT32               AsymAlgo,
+  OUT VOID                 **Data,
+  OUT UINTN                *DataSize,
+  OUT VOID                 **Hash,
+  OUT UINTN                *HashSize
+  );
+
+BOOLEAN
+BuildProvisionImage (
+  IN CHAR8   *FileName
+  );
+
+BOOLEAN
+LoadProvisionImage (
+  IN CHAR8   *FileName
+  );
+
 BOOLEAN
 ReadInputFile (
   IN CHAR8    *FileName,
@@ -131,6 +298,10 @@ WriteOutputFile (
   IN UINTN   FileSize
   );
 
+#define PCAP_MODE_SYNC   0
+#define PCAP_MODE_ASYNC  1
+extern UINT32  mPcapMode;
+
 BOOLEAN
 OpenPcapPacketFile (
   IN CHAR8  *PcapFileName
@@ -149,6 +320,96 @@ AppendPcapPacketData (
   IN UINTN   Size
   );
 
+BOOLEAN
+OpenTraceFile (
+  IN CHAR8   *TraceFileName,
+  IN CHAR8   *ProcessName
+  );
+
+VOID
+CloseTraceFile (
+  VOID
+  );
+
+UINT64
+TraceGetTime (
+  VOID
+  );
+
+BOOLEAN
+TraceParseTransportMessage (
+  IN  UINTN   MessageSize,
+  IN  VOID    *Message,
+  OUT UINT8   *RequestResponseCode,
+  OUT UINT32  *SessionId
+  );
+
+VOID
+TraceAppendMessage (
+  IN UINT32  Track,
+  IN UINT64  StartTime,
+  IN UINT64  EndTime,
+  IN UINT8   RequestCode,
+  IN UINT32  *SessionId, OPTIONAL
+  IN UINTN   RequestSize,
+  IN UINTN   ResponseSize,
+  IN UINT64  CryptoTime,
+  IN UINT64  CallbackTime
+  );
+
+CHAR8 *
+TraceGetRequestCodeName (
+  IN UINT8   RequestCode
+  );
+
+BOOLEAN
+OpenMetricsFile (
+  IN CHAR8   *MetricsFileName,
+  IN CHAR8   *ProcessName
+  );
+
+VOID
+CloseMetricsFile (
+  VOID
+  );
+
+UINT64
+EFIAPI
+MetricsGetTime (
+  IN VOID    *SpdmContext
+  );
+
+VOID
+MetricsCollect (
+  IN VOID        *SpdmContext,
+  IN OUT UINT64  *CollectTime OPTIONAL
+  );
+
+VOID
+MetricsCountSession (
+  IN SPDM_SESSION_STATE  SessionState
+  );
+
+BOOLEAN
+CostModelSetLinkPreset (
+  IN CHAR8   *Name
+  );
+
+BOOLEAN
+CostModelLinkEnabled (
+  VOID
+  );
+
+VOID
+CostModelDelay (
+  IN UINT32  Microseconds
+  );
+
+VOID
+CostModelLinkDelay (
+  IN UINTN   MessageSize
+  );
+
 void
 ProcessArgs (
   char  *ProgramName,
@@ -0,0 +1,1029 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmEmu.h"
+
+//
+// The async I/O backend lets one thread drive many platform sockets. Each connection owns
+// one send buffer and one receive buffer, carved from one arena. With io_uring, the arena
+// is registered to the kernel, every send and receive is a fixed-buffer operation, and the
+// operations queued between two AsyncIoWait calls are submitted by one io_uring_enter.
+// With epoll, the queued sends are flushed together at the beginning of AsyncIoWait.
+//
+// A received message is returned in place, pointing into the receive buffer, so it is passed
+// to the SPDM receive path without a copy. A message is built in place in the send buffer
+// returned by AsyncIoGetSendBuffer.
+//
+// Buffer layout:
+//   Command: 4 bytes (big endian)
+//   TransportType: 4 bytes (big endian)
+//   PayloadSize: 4 bytes (big endian)
+//   Payload: up to MAX_SPDM_MESSAGE_BUFFER_SIZE bytes
+//
+
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#ifdef __NR_io_uring_setup
+#include <linux/io_uring.h>
+#endif
+
+#define ASYNC_IO_HEADER_SIZE   (sizeof(UINT32) * 3)
+#define ASYNC_IO_BUFFER_SIZE   ((ASYNC_IO_HEADER_SIZE + MAX_SPDM_MESSAGE_BUFFER_SIZE + 0x3F) & ~0x3F)
+
+//
+// The operation kept in the low bit of the io_uring user data. The rest is the connection.
+//
+#define ASYNC_IO_OP_RECEIVE    0
+#define ASYNC_IO_OP_SEND       1
+
+typedef struct {
+  SOCKET   Socket;
+  VOID     *Context;
+  BOOLEAN  InUse;
+  BOOLEAN  Removed;
+  BOOLEAN  Failed;
+  BOOLEAN  ReceiveArmed;
+  BOOLEAN  InReadyList;
+  BOOLEAN  InSendList;
+  UINT8    *SendBuffer;
+  UINT32   SendSize;
+  UINT32   SentSize;
+  UINT8    *ReceiveBuffer;
+  UINT32   ReceivedSize;
+  UINT32   ConsumedSize;
+  UINT32   InFlight;
+  UINT32   EpollEvents;
+} ASYNC_IO_CONNECTION;
+
+UINT32               mAsyncIoBackend;
+UINT32               mAsyncIoMaxConnectionCount;
+ASYNC_IO_CONNECTION  *mAsyncIoConnection;
+ASYNC_IO_CONNECTION  **mAsyncIoFreeList;
+UINT32               mAsyncIoFreeCount;
+ASYNC_IO_CONNECTION  **mAsyncIoReadyList;
+UINT32               mAsyncIoReadyCount;
+ASYNC_IO_CONNECTION  **mAsyncIoSendList;
+UINT32               mAsyncIoSendCount;
+UINT8                *mAsyncIoArena;
+UINTN                mAsyncIoArenaSize;
+
+INT32                mAsyncIoEpollFd = -1;
+
+#ifdef __NR_io_uring_setup
+INT32                mAsyncIoUringFd = -1;
+BOOLEAN              mAsyncIoUringFixedBuffer;
+UINT32               mAsyncIoUringToSubmit;
+UINT8                *mAsyncIoUringSqRing;
+UINTN                mAsyncIoUringSqRingSize;
+UINT8                *mAsyncIoUringCqRing;
+UINTN                mAsyncIoUringCqRingSize;
+struct io_uring_sqe  *mAsyncIoUringSqes;
+UINTN                mAsyncIoUringSqesSize;
+UINT32               *mAsyncIoUringSqHead;
+UINT32               *mAsyncIoUringSqTail;
+UINT32               *mAsyncIoUringSqMask;
+UINT32               *mAsyncIoUringSqEntries;
+UINT32               *mAsyncIoUringSqArray;
+UINT32               *mAsyncIoUringCqHead;
+UINT32               *mAsyncIoUringCqTail;
+UINT32               *mAsyncIoUringCqMask;
+struct io_uring_cqe  *mAsyncIoUringCqes;
+
+/**
+  Release the io_uring instance.
+**/
+VOID
+AsyncIoUringClose (
+  VOID
+  )
+{
+  if ((mAsyncIoUringSqes != NULL) && (mAsyncIoUringSqes != MAP_FAILED)) {
+    munmap (mAsyncIoUringSqes, mAsyncIoUringSqesSize);
+  }
+  if ((mAsyncIoUringCqRing != NULL) && (mAsyncIoUringCqRing != MAP_FAILED) && (mAsyncIoUringCqRing != mAsyncIoUringSqRing)) {
+    munmap (mAsyncIoUringCqRing, mAsyncIoUringCqRingSize);
+  }
+  if ((mAsyncIoUringSqRing != NULL) && (mAsyncIoUringSqRing != MAP_FAILED)) {
+    munmap (mAsyncIoUringSqRing, mAsyncIoUringSqRingSize);
+  }
+  if (mAsyncIoUringFd >= 0) {
+    close (mAsyncIoUringFd);
+  }
+  mAsyncIoUringSqes = NULL;
+  mAsyncIoUringCqRing = NULL;
+  mAsyncIoUringSqRing = NULL;
+  mAsyncIoUringFd = -1;
+}
+
+/**
+  Create the io_uring instance, map its rings and register the buffer arena.
+
+  @retval TRUE   io_uring is ready.
+  @retval FALSE  io_uring is not available, for example it is not supported by the kernel.
+**/
+BOOLEAN
+AsyncIoUringInit (
+  VOID
+  )
+{
+  struct io_uring_params  Params;
+  struct iovec            Iov;
+
+  ZeroMem (&Params, sizeof(Params));
+  mAsyncIoUringFd = (INT32)syscall (__NR_io_uring_setup, mAsyncIoMaxConnectionCount * 2, &Params);
+  if (mAsyncIoUringFd < 0) {
+    printf ("io_uring_setup error - 0x%x\n", errno);
+    mAsyncIoUringFd = -1;
+    return FALSE;
+  }
+
+  mAsyncIoUringSqRingSize = Params.sq_off.array + Params.sq_entries * sizeof(UINT32);
+  mAsyncIoUringCqRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(struct io_uring_cqe);
+  if ((Params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    mAsyncIoUringSqRingSize = MAX (mAsyncIoUringSqRingSize, mAsyncIoUringCqRingSize);
+  }
+  mAsyncIoUringSqRing = mmap (NULL, mAsyncIoUringSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mAsyncIoUringFd, IORING_OFF_SQ_RING);
+  if (mAsyncIoUringSqRing == MAP_FAILED) {
+    AsyncIoUringClose ();
+    return FALSE;
+  }
+  if ((Params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    mAsyncIoUringCqRing = mAsyncIoUringSqRing;
+  } else {
+    mAsyncIoUringCqRing = mmap (NULL, mAsyncIoUringCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mAsyncIoUringFd, IORING_OFF_CQ_RING);
+    if (mAsyncIoUringCqRing == MAP_FAILED) {
+      AsyncIoUringClose ();
+      return FALSE;
+    }
+  }
+  mAsyncIoUringSqesSize = Params.sq_entries * sizeof(struct io_uring_sqe);
+  mAsyncIoUringSqes = mmap (NULL, mAsyncIoUringSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mAsyncIoUringFd, IORING_OFF_SQES);
+  if (mAsyncIoUringSqes == MAP_FAILED) {
+    AsyncIoUringClose ();
+    return FALSE;
+  }
+
+  mAsyncIoUringSqHead = (UINT32 *)(mAsyncIoUringSqRing + Params.sq_off.head);
+  mAsyncIoUringSqTail = (UINT32 *)(mAsyncIoUringSqRing + Params.sq_off.tail);
+  mAsyncIoUringSqMask = (UINT32 *)(mAsyncIoUringSqRing + Params.sq_off.ring_mask);
+  mAsyncIoUringSqEntries = (UINT32 *)(mAsyncIoUringSqRing + Params.sq_off.ring_entries);
+  mAsyncIoUringSqArray = (UINT32 *)(mAsyncIoUringSqRing + Params.sq_off.array);
+  mAsyncIoUringCqHead = (UINT32 *)(mAsyncIoUringCqRing + Params.cq_off.head);
+  mAsyncIoUringCqTail = (UINT32 *)(mAsyncIoUringCqRing + Params.cq_off.tail);
+  mAsyncIoUringCqMask = (UINT32 *)(mAsyncIoUringCqRing + Params.cq_off.ring_mask);
+  mAsyncIoUringCqes = (struct io_uring_cqe *)(mAsyncIoUringCqRing + Params.cq_off.cqes);
+  mAsyncIoUringToSubmit = 0;
+
+  //
+  // The registration pins the arena. It may exceed RLIMIT_MEMLOCK, and then the plain
+  // read and write operations are used on the same buffers.
+  //
+  Iov.iov_base = mAsyncIoArena;
+  Iov.iov_len = mAsyncIoArenaSize;
+  mAsyncIoUringFixedBuffer = (BOOLEAN)(syscall (__NR_io_uring_register, mAsyncIoUringFd, IORING_REGISTER_BUFFERS, &Iov, 1) == 0);
+  if (!mAsyncIoUringFixedBuffer) {
+    printf ("io_uring buffer registration error - 0x%x, the buffers are not fixed\n", errno);
+  }
+  return TRUE;
+}
+
+/**
+  Submit the queued operations, and optionally wait for one completion.
+
+  @param  WaitCompletion               TRUE to wait until at least one completion is available.
+**/
+BOOLEAN
+AsyncIoUringEnter (
+  IN BOOLEAN          WaitCompletion
+  )
+{
+  INT32   Result;
+  UINT32  ToSubmit;
+
+  ToSubmit = mAsyncIoUringToSubmit;
+  do {
+    Result = (INT32)syscall (__NR_io_uring_enter, mAsyncIoUringFd, ToSubmit, WaitCompletion ? 1 : 0,
+                             WaitCompletion ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+  } while ((Result < 0) && (errno == EINTR));
+  if (Result < 0) {
+    printf ("io_uring_enter error - 0x%x\n", errno);
+    return FALSE;
+  }
+  mAsyncIoUringToSubmit -= MIN ((UINT32)Result, mAsyncIoUringToSubmit);
+  return TRUE;
+}
+
+/**
+  Queue one receive or send operation of a connection. It is submitted by the next AsyncIoWait.
+**/
+BOOLEAN
+AsyncIoUringQueue (
+  IN ASYNC_IO_CONNECTION  *Connection,
+  IN UINT32               Operation
+  )
+{
+  UINT32               Tail;
+  UINT32               Index;
+  struct io_uring_sqe  *Sqe;
+
+  Tail = *mAsyncIoUringSqTail;
+  while (Tail - __atomic_load_n (mAsyncIoUringSqHead, __ATOMIC_ACQUIRE) >= *mAsyncIoUringSqEntries) {
+    if (!AsyncIoUringEnter (FALSE)) {
+      return FALSE;
+    }
+  }
+  Index = Tail & *mAsyncIoUringSqMask;
+  Sqe = &mAsyncIoUringSqes[Index];
+  ZeroMem (Sqe, sizeof(*Sqe));
+  Sqe->fd = Connection->Socket;
+  if (Operation == ASYNC_IO_OP_RECEIVE) {
+    Sqe->opcode = mAsyncIoUringFixedBuffer ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    Sqe->addr = (UINT64)(UINTN)(Connection->ReceiveBuffer + Connection->ReceivedSize);
+    Sqe->len = ASYNC_IO_BUFFER_SIZE - Connection->ReceivedSize;
+  } else {
+    Sqe->opcode = mAsyncIoUringFixedBuffer ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    Sqe->addr = (UINT64)(UINTN)(Connection->SendBuffer + Connection->SentSize);
+    Sqe->len = Connection->SendSize - Connection->SentSize;
+  }
+  Sqe->buf_index = 0;
+  Sqe->user_data = (UINT64)(UINTN)Connection | Operation;
+  mAsyncIoUringSqArray[Index] = Index;
+  __atomic_store_n (mAsyncIoUringSqTail, Tail + 1, __ATOMIC_RELEASE);
+  mAsyncIoUringToSubmit++;
+  Connection->InFlight++;
+  return TRUE;
+}
+#endif
+
+/**
+  Return a connection to the free list.
+**/
+VOID
+AsyncIoFreeConnection (
+  IN ASYNC_IO_CONNECTION  *Connection
+  )
+{
+  Connection->InUse = FALSE;
+  mAsyncIoFreeList[mAsyncIoFreeCount++] = Connection;
+}
+
+/**
+  Remove a connection from a pending list.
+**/
+VOID
+AsyncIoRemoveFromList (
+  IN ASYNC_IO_CONNECTION  **List,
+  IN OUT UINT32           *Count,
+  IN ASYNC_IO_CONNECTION  *Connection
+  )
+{
+  UINT32  Index;
+
+  for (Index = 0; Index < *Count; Index++) {
+    if (List[Index] == Connection) {
+      List[Index] = List[*Count - 1];
+      (*Count)--;
+      return;
+    }
+  }
+}
+
+/**
+  Update the epoll interest of a connection: readable if a receive is armed,
+  writable if a send is not complete.
+**/
+VOID
+AsyncIoEpollUpdate (
+  IN ASYNC_IO_CONNECTION  *Connection
+  )
+{
+  struct epoll_event  Event;
+  UINT32              Events;
+
+  Events = 0;
+  if (Connection->ReceiveArmed) {
+    Events |= EPOLLIN;
+  }
+  if ((Connection->SendSize != 0) && !Connection->InSendList) {
+    Events |= EPOLLOUT;
+  }
+  if (Events == Connection->EpollEvents) {
+    return;
+  }
+  Event.events = Events;
+  Event.data.ptr = Connection;
+  epoll_ctl (mAsyncIoEpollFd, EPOLL_CTL_MOD, Connection->Socket, &Event);
+  Connection->EpollEvents = Events;
+}
+
+/**
+  Report the failure of a connection, once.
+
+  @retval TRUE   the event is filled.
+  @retval FALSE  the failure is already reported.
+**/
+BOOLEAN
+AsyncIoFail (
+  IN  ASYNC_IO_CONNECTION  *Connection,
+  OUT ASYNC_IO_EVENT       *Event
+  )
+{
+  if (Connection->Failed) {
+    return FALSE;
+  }
+  Connection->Failed = TRUE;
+  Connection->ReceiveArmed = FALSE;
+  Connection->SendSize = 0;
+  if (mAsyncIoBackend == ASYNC_IO_BACKEND_EPOLL) {
+    epoll_ctl (mAsyncIoEpollFd, EPOLL_CTL_DEL, Connection->Socket, NULL);
+    Connection->EpollEvents = 0;
+  }
+  Event->Connection = Connection;
+  Event->Context = Connection->Context;
+  Event->Result = FALSE;
+  Event->Command = SOCKET_SPDM_COMMAND_UNKOWN;
+  Event->Payload = NULL;
+  Event->PayloadSize = 0;
+  return TRUE;
+}
+
+/**
+  Check if the receive buffer of an armed connection holds a whole message, and return it.
+
+  @retval TRUE   the event is filled, with a message or with a failure.
+  @retval FALSE  more bytes are needed.
+**/
+BOOLEAN
+AsyncIoParseMessage (
+  IN  ASYNC_IO_CONNECTION  *Connection,
+  OUT ASYNC_IO_EVENT       *Event
+  )
+{
+  UINT32  *Header;
+  UINT32  PayloadSize;
+
+  if (Connection->ReceivedSize < ASYNC_IO_HEADER_SIZE) {
+    return FALSE;
+  }
+  Header = (UINT32 *)Connection->ReceiveBuffer;
+  PayloadSize = ntohl (Header[2]);
+  if ((ntohl (Header[1]) != mUseTransportLayer) || (PayloadSize > ASYNC_IO_BUFFER_SIZE - ASYNC_IO_HEADER_SIZE)) {
+    printf ("Async I/O receive invalid message header\n");
+    return AsyncIoFail (Connection, Event);
+  }
+  if (Connection->ReceivedSize < ASYNC_IO_HEADER_SIZE + PayloadSize) {
+    return FALSE;
+  }
+  Connection->ReceiveArmed = FALSE;
+  Connection->ConsumedSize = ASYNC_IO_HEADER_SIZE + PayloadSize;
+  Event->Connection = Connection;
+  Event->Context = Connection->Context;
+  Event->Result = TRUE;
+  Event->Command = ntohl (Header[0]);
+  Event->Payload = Connection->ReceiveBuffer + ASYNC_IO_HEADER_SIZE;
+  Event->PayloadSize = PayloadSize;
+  return TRUE;
+}
+
+/**
+  Initialize the async I/O backend.
+
+  @param  Backend                      ASYNC_IO_BACKEND_URING or ASYNC_IO_BACKEND_EPOLL.
+                                       ASYNC_IO_BACKEND_URING falls back to epoll if io_uring is not available.
+  @param  MaxConnectionCount           The maximum number of the connections added at the same time.
+
+  @retval TRUE   the backend is ready. AsyncIoGetBackend returns the backend in use.
+  @retval FALSE  the backend cannot be initialized.
+**/
+BOOLEAN
+AsyncIoInit (
+  IN UINT32           Backend,
+  IN UINT32           MaxConnectionCount
+  )
+{
+  UINT32  Index;
+
+  mAsyncIoMaxConnectionCount = MaxConnectionCount;
+  mAsyncIoConnection = calloc (MaxConnectionCount, sizeof(ASYNC_IO_CONNECTION));
+  mAsyncIoFreeList = calloc (MaxConnectionCount, sizeof(ASYNC_IO_CONNECTION *));
+  mAsyncIoReadyList = calloc (MaxConnectionCount, sizeof(ASYNC_IO_CONNECTION *));
+  mAsyncIoSendList = calloc (MaxConnectionCount, sizeof(ASYNC_IO_CONNECTION *));
+  mAsyncIoArenaSize = (UINTN)MaxConnectionCount * ASYNC_IO_BUFFER_SIZE * 2;
+  mAsyncIoArena = mmap (NULL, mAsyncIoArenaSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mAsyncIoArena == MAP_FAILED) {
+    mAsyncIoArena = NULL;
+  }
+  if ((mAsyncIoConnection == NULL) || (mAsyncIoFreeList == NULL) || (mAsyncIoReadyList == NULL) ||
+      (mAsyncIoSendList == NULL) || (mAsyncIoArena == NULL)) {
+    printf ("Async I/O allocation fail\n");
+    AsyncIoClose ();
+    return FALSE;
+  }
+  //
+  // The free list is a stack, so the first connections are taken in order.
+  //
+  for (Index = 0; Index < MaxConnectionCount; Index++) {
+    mAsyncIoConnection[Index].SendBuffer = mAsyncIoArena + (UINTN)Index * ASYNC_IO_BUFFER_SIZE * 2;
+    mAsyncIoConnection[Index].ReceiveBuffer = mAsyncIoConnection[Index].SendBuffer + ASYNC_IO_BUFFER_SIZE;
+    mAsyncIoFreeList[Index] = &mAsyncIoConnection[MaxConnectionCount - 1 - Index];
+  }
+  mAsyncIoFreeCount = MaxConnectionCount;
+  mAsyncIoReadyCount = 0;
+  mAsyncIoSendCount = 0;
+
+#ifdef __NR_io_uring_setup
+  if (Backend == ASYNC_IO_BACKEND_URING) {
+    if (AsyncIoUringInit ()) {
+      mAsyncIoBackend = ASYNC_IO_BACKEND_URING;
+      return TRUE;
+    }
+    printf ("io_uring is not available, epoll is used\n");
+  }
+#endif
+
+  mAsyncIoEpollFd = epoll_create1 (0);
+  if (mAsyncIoEpollFd < 0) {
+    printf ("epoll_create1 error - 0x%x\n", errno);
+    AsyncIoClose ();
+    return FALSE;
+  }
+  mAsyncIoBackend = ASYNC_IO_BACKEND_EPOLL;
+  return TRUE;
+}
+
+/**
+  Release the async I/O backend. All the connections must be removed.
+**/
+VOID
+AsyncIoClose (
+  VOID
+  )
+{
+#ifdef __NR_io_uring_setup
+  AsyncIoUringClose ();
+#endif
+  if (mAsyncIoEpollFd >= 0) {
+    close (mAsyncIoEpollFd);
+    mAsyncIoEpollFd = -1;
+  }
+  if (mAsyncIoArena != NULL) {
+    munmap (mAsyncIoArena, mAsyncIoArenaSize);
+    mAsyncIoArena = NULL;
+  }
+  free (mAsyncIoConnection);
+  free (mAsyncIoFreeList);
+  free (mAsyncIoReadyList);
+  free (mAsyncIoSendList);
+  mAsyncIoConnection = NULL;
+  mAsyncIoFreeList = NULL;
+  mAsyncIoReadyList = NULL;
+  mAsyncIoSendList = NULL;
+  mAsyncIoBackend = 0;
+}
+
+/**
+  Return the backend in use, ASYNC_IO_BACKEND_URING or ASYNC_IO_BACKEND_EPOLL.
+**/
+UINT32
+AsyncIoGetBackend (
+  VOID
+  )
+{
+  return mAsyncIoBackend;
+}
+
+/**
+  Add a connected platform socket to the async I/O backend.
+
+  @param  Socket                       The platform socket. It is set to non-blocking mode for epoll.
+  @param  Context                      The context returned in the events of the connection.
+
+  @return the connection, or NULL if the maximum number of the connections is reached.
+**/
+VOID *
+AsyncIoAddConnection (
+  IN SOCKET           Socket,
+  IN VOID             *Context
+  )
+{
+  ASYNC_IO_CONNECTION  *Connection;
+  struct epoll_event   Event;
+
+  if (mAsyncIoFreeCount == 0) {
+    return NULL;
+  }
+  if (mAsyncIoBackend == ASYNC_IO_BACKEND_EPOLL) {
+    if (fcntl (Socket, F_SETFL, fcntl (Socket, F_GETFL, 0) | O_NONBLOCK) < 0) {
+      return NULL;
+    }
+    Event.events = 0;
+    Event.data.ptr = mAsyncIoFreeList[mAsyncIoFreeCount - 1];
+    if (epoll_ctl (mAsyncIoEpollFd, EPOLL_CTL_ADD, Socket, &Event) < 0) {
+      printf ("epoll_ctl error - 0x%x\n", errno);
+      return NULL;
+    }
+  }
+  Connection = mAsyncIoFreeList[--mAsyncIoFreeCount];
+  Connection->Socket = Socket;
+  Connection->Context = Context;
+  Connection->InUse = TRUE;
+  Connection->Removed = FALSE;
+  Connection->Failed = FALSE;
+  Connection->ReceiveArmed = FALSE;
+  Connection->InReadyList = FALSE;
+  Connection->InSendList = FALSE;
+  Connection->SendSize = 0;
+  Connection->SentSize = 0;
+  Connection->ReceivedSize = 0;
+  Connection->ConsumedSize = 0;
+  Connection->InFlight = 0;
+  Connection->EpollEvents = 0;
+  return Connection;
+}
+
+/**
+  Remove a connection from the async I/O backend. No more event is returned for it.
+
+  The socket is shut down if an io_uring operation is still in flight, so that the operation completes.
+  The caller closes the socket after this function returns.
+
+  @param  Connection                   The connection returned by AsyncIoAddConnection.
+**/
+VOID
+AsyncIoRemoveConnection (
+  IN VOID             *Connection
+  )
+{
+  ASYNC_IO_CONNECTION  *AsyncConnection;
+
+  AsyncConnection = Connection;
+  if (AsyncConnection->InReadyList) {
+    AsyncIoRemoveFromList (mAsyncIoReadyList, &mAsyncIoReadyCount, AsyncConnection);
+  }
+  if (AsyncConnection->InSendList) {
+    AsyncIoRemoveFromList (mAsyncIoSendList, &mAsyncIoSendCount, AsyncConnection);
+  }
+  AsyncConnection->Removed = TRUE;
+  if (mAsyncIoBackend == ASYNC_IO_BACKEND_EPOLL) {
+    if (!AsyncConnection->Failed) {
+      epoll_ctl (mAsyncIoEpollFd, EPOLL_CTL_DEL, AsyncConnection->Socket, NULL);
+    }
+    AsyncIoFreeConnection (AsyncConnection);
+    return;
+  }
+  if (AsyncConnection->InFlight != 0) {
+    shutdown (AsyncConnection->Socket, SHUT_RDWR);
+    return;
+  }
+  AsyncIoFreeConnection (AsyncConnection);
+}
+
+/**
+  Return the send buffer of a connection. The payload of the next message is built in place.
+
+  @param  Connection                   The connection returned by AsyncIoAddConnection.
+  @param  BufferSize                   The size in bytes of the send buffer.
+**/
+UINT8 *
+AsyncIoGetSendBuffer (
+  IN  VOID            *Connection,
+  OUT UINTN           *BufferSize
+  )
+{
+  *BufferSize = ASYNC_IO_BUFFER_SIZE - ASYNC_IO_HEADER_SIZE;
+  return ((ASYNC_IO_CONNECTION *)Connection)->SendBuffer + ASYNC_IO_HEADER_SIZE;
+}
+
+/**
+  Queue the message built in the send buffer of a connection. It is sent by the next AsyncIoWait.
+
+  @param  Connection                   The connection returned by AsyncIoAddConnection.
+  @param  Command                      The platform command.
+  @param  PayloadSize                  The size in bytes of the payload in the send buffer.
+
+  @retval TRUE   the message is queued.
+  @retval FALSE  the previous message is not sent yet, the payload is too large, or the connection failed.
+**/
+BOOLEAN
+AsyncIoQueueSend (
+  IN VOID             *Connection,
+  IN UINT32           Command,
+  IN UINTN            PayloadSize
+  )
+{
+  ASYNC_IO_CONNECTION  *AsyncConnection;
+  UINT32               *Header;
+
+  AsyncConnection = Connection;
+  if (AsyncConnection->Failed || (AsyncConnection->SendSize != 0) ||
+      (PayloadSize > ASYNC_IO_BUFFER_SIZE - ASYNC_IO_HEADER_SIZE)) {
+    return FALSE;
+  }
+  Header = (UINT32 *)AsyncConnection->SendBuffer;
+  Header[0] = htonl (Command);
+  Header[1] = htonl (mUseTransportLayer);
+  Header[2] = htonl ((UINT32)PayloadSize);
+  AsyncConnection->SendSize = (UINT32)(ASYNC_IO_HEADER_SIZE + PayloadSize);
+  AsyncConnection->SentSize = 0;
+#ifdef __NR_io_uring_setup
+  if (mAsyncIoBackend == ASYNC_IO_BACKEND_URING) {
+    return AsyncIoUringQueue (AsyncConnection, ASYNC_IO_OP_SEND);
+  }
+#endif
+  AsyncConnection->InSendList = TRUE;
+  mAsyncIoSendList[mAsyncIoSendCount++] = AsyncConnection;
+  return TRUE;
+}
+
+/**
+  Arm the receive of the next message of a connection. It is returned by AsyncIoWait.
+
+  The payload of the previous message of the connection is no longer valid.
+
+  @param  Connection                   The connection returned by AsyncIoAddConnection.
+
+  @retval TRUE   the receive is armed.
+  @retval FALSE  the receive is already armed, or the connection failed.
+**/
+BOOLEAN
+AsyncIoQueueReceive (
+  IN VOID             *Connection
+  )
+{
+  ASYNC_IO_CONNECTION  *AsyncConnection;
+
+  AsyncConnection = Connection;
+  if (AsyncConnection->Failed || AsyncConnection->ReceiveArmed) {
+    return FALSE;
+  }
+  if (AsyncConnection->ConsumedSize != 0) {
+    AsyncConnection->ReceivedSize -= AsyncConnection->ConsumedSize;
+    memmove (AsyncConnection->ReceiveBuffer, AsyncConnection->ReceiveBuffer + AsyncConnection->ConsumedSize, AsyncConnection->ReceivedSize);
+    AsyncConnection->ConsumedSize = 0;
+  }
+  AsyncConnection->ReceiveArmed = TRUE;
+
+  //
+  // The bytes received after the previous message may hold this one already.
+  //
+  if (AsyncConnection->ReceivedSize >= ASYNC_IO_HEADER_SIZE) {
+    AsyncConnection->InReadyList = TRUE;
+    mAsyncIoReadyList[mAsyncIoReadyCount++] = AsyncConnection;
+    return TRUE;
+  }
+#ifdef __NR_io_uring_setup
+  if (mAsyncIoBackend == ASYNC_IO_BACKEND_URING) {
+    return AsyncIoUringQueue (AsyncConnection, ASYNC_IO_OP_RECEIVE);
+  }
+#endif
+  AsyncIoEpollUpdate (AsyncConnection);
+  return TRUE;
+}
+
+/**
+  Handle the bytes received by one operation of an armed connection.
+
+  @retval TRUE   the event is filled.
+  @retval FALSE  no event, the receive goes on.
+**/
+BOOLEAN
+AsyncIoReceived (
+  IN  ASYNC_IO_CONNECTION  *Connection,
+  IN  INT32                Result,
+  OUT ASYNC_IO_EVENT       *Event
+  )
+{
+  if (Result <= 0) {
+    return AsyncIoFail (Connection, Event);
+  }
+  Connection->ReceivedSize += Result;
+  if (AsyncIoParseMessage (Connection, Event)) {
+    return TRUE;
+  }
+  if (Connection->ReceivedSize == ASYNC_IO_BUFFER_SIZE) {
+    return AsyncIoFail (Connection, Event);
+  }
+#ifdef __NR_io_uring_setup
+  if (mAsyncIoBackend == ASYNC_IO_BACKEND_URING) {
+    if (!AsyncIoUringQueue (Connection, ASYNC_IO_OP_RECEIVE)) {
+      return AsyncIoFail (Connection, Event);
+    }
+  }
+#endif
+  return FALSE;
+}
+
+/**
+  Handle the bytes sent by one operation of a connection.
+
+  @retval TRUE   the event is filled with a failure.
+  @retval FALSE  no event.
+**/
+BOOLEAN
+AsyncIoSent (
+  IN  ASYNC_IO_CONNECTION  *Connection,
+  IN  INT32                Result,
+  OUT ASYNC_IO_EVENT       *Event
+  )
+{
+  if (Result < 0) {
+    return AsyncIoFail (Connection, Event);
+  }
+  Connection->SentSize += Result;
+  if (Connection->SentSize == Connection->SendSize) {
+    Connection->SendSize = 0;
+    return FALSE;
+  }
+#ifdef __NR_io_uring_setup
+  if (mAsyncIoBackend == ASYNC_IO_BACKEND_URING) {
+    if (!AsyncIoUringQueue (Connection, ASYNC_IO_OP_SEND)) {
+      return AsyncIoFail (Connection, Event);
+    }
+  }
+#endif
+  return FALSE;
+}
+
+/**
+  Try to send the rest of the queued message of an epoll connection, without blocking.
+**/
+BOOLEAN
+AsyncIoEpollSend (
+  IN  ASYNC_IO_CONNECTION  *Connection,
+  OUT ASYNC_IO_EVENT       *Event
+  )
+{
+  ssize_t  Result;
+
+  while (Connection->SendSize != 0) {
+    Result = send (Connection->Socket, Connection->SendBuffer + Connection->SentSize,
+                   Connection->SendSize - Connection->SentSize, MSG_NOSIGNAL);
+    if (Result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        break;
+      }
+    }
+    if (AsyncIoSent (Connection, (INT32)Result, Event)) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Receive the available bytes of an armed epoll connection, without blocking.
+**/
+BOOLEAN
+AsyncIoEpollReceive (
+  IN  ASYNC_IO_CONNECTION  *Connection,
+  OUT ASYNC_IO_EVENT       *Event
+  )
+{
+  ssize_t  Result;
+
+  while (Connection->ReceiveArmed) {
+    Result = recv (Connection->Socket, Connection->ReceiveBuffer + Connection->ReceivedSize,
+                   ASYNC_IO_BUFFER_SIZE - Connection->ReceivedSize, 0);
+    if (Result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        break;
+      }
+    }
+    if (AsyncIoReceived (Connection, (INT32)Result, Event)) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Send the queued messages, and wait until at least one armed connection receives a whole message or fails.
+
+  @param  Events                       The events of the connections.
+  @param  MaxEventCount                The maximum number of the events.
+
+  @return the number of the events, or 0 if the backend fails.
+**/
+UINT32
+AsyncIoWait (
+  OUT ASYNC_IO_EVENT  *Events,
+  IN  UINT32          MaxEventCount
+  )
+{
+  UINT32               EventCount;
+  ASYNC_IO_CONNECTION  *Connection;
+  struct epoll_event   EpollEvents[64];
+  INT32                EpollCount;
+  INT32                Index;
+#ifdef __NR_io_uring_setup
+  UINT32               Head;
+  struct io_uring_cqe  *Cqe;
+  UINT64               UserData;
+#endif
+
+  EventCount = 0;
+  while ((mAsyncIoReadyCount != 0) && (EventCount < MaxEventCount)) {
+    Connection = mAsyncIoReadyList[--mAsyncIoReadyCount];
+    Connection->InReadyList = FALSE;
+    if (AsyncIoParseMessage (Connection, &Events[EventCount])) {
+      EventCount++;
+    } else {
+#ifdef __NR_io_uring_setup
+      if (mAsyncIoBackend == ASYNC_IO_BACKEND_URING) {
+        if (!AsyncIoUringQueue (Connection, ASYNC_IO_OP_RECEIVE) && AsyncIoFail (Connection, &Events[EventCount])) {
+          EventCount++;
+        }
+        continue;
+      }
+#endif
+      AsyncIoEpollUpdate (Connection);
+    }
+  }
+
+#ifdef __NR_io_uring_setup
+  if (mAsyncIoBackend == ASYNC_IO_BACKEND_URING) {
+    while (TRUE) {
+      Head = *mAsyncIoUringCqHead;
+      while ((Head != __atomic_load_n (mAsyncIoUringCqTail, __ATOMIC_ACQUIRE)) && (EventCount < MaxEventCount)) {
+        Cqe = &mAsyncIoUringCqes[Head & *mAsyncIoUringCqMask];
+        UserData = Cqe->user_data;
+        Connection = (ASYNC_IO_CONNECTION *)(UINTN)(UserData & ~(UINT64)1);
+        Connection->InFlight--;
+        if (Connection->Removed) {
+          if (Connection->InFlight == 0) {
+            AsyncIoFreeConnection (Connection);
+          }
+        } else if ((UserData & 1) == ASYNC_IO_OP_SEND) {
+          if (AsyncIoSent (Connection, Cqe->res, &Events[EventCount])) {
+            EventCount++;
+          }
+        } else {
+          if (AsyncIoReceived (Connection, Cqe->res, &Events[EventCount])) {
+            EventCount++;
+          }
+        }
+        Head++;
+        __atomic_store_n (mAsyncIoUringCqHead, Head, __ATOMIC_RELEASE);
+      }
+      if ((EventCount != 0) && (mAsyncIoUringToSubmit == 0)) {
+        return EventCount;
+      }
+      //
+      // All the operations queued since the last call are submitted together.
+      //
+      if (!AsyncIoUringEnter ((BOOLEAN)(EventCount == 0))) {
+        return EventCount;
+      }
+    }
+  }
+#endif
+
+  //
+  // The queued messages are flushed together, before waiting for the responses.
+  //
+  while ((mAsyncIoSendCount != 0) && (EventCount < MaxEventCount)) {
+    Connection = mAsyncIoSendList[--mAsyncIoSendCount];
+    Connection->InSendList = FALSE;
+    if (AsyncIoEpollSend (Connection, &Events[EventCount])) {
+      EventCount++;
+    } else if (!Connection->Failed) {
+      AsyncIoEpollUpdate (Connection);
+    }
+  }
+
+  while (EventCount == 0) {
+    EpollCount = epoll_wait (mAsyncIoEpollFd, EpollEvents, ARRAY_SIZE(EpollEvents), -1);
+    if (EpollCount < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      printf ("epoll_wait error - 0x%x\n", errno);
+      return 0;
+    }
+    for (Index = 0; (Index < EpollCount) && (EventCount < MaxEventCount); Index++) {
+      Connection = EpollEvents[Index].data.ptr;
+      if (!Connection->InUse || Connection->Failed) {
+        continue;
+      }
+      if ((EpollEvents[Index].events & EPOLLOUT) != 0) {
+        if (AsyncIoEpollSend (Connection, &Events[EventCount])) {
+          EventCount++;
+          continue;
+        }
+      }
+      if ((EpollEvents[Index].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0) {
+        if (Connection->ReceiveArmed) {
+          if (AsyncIoEpollReceive (Connection, &Events[EventCount])) {
+            EventCount++;
+            continue;
+          }
+        } else if ((EpollEvents[Index].events & (EPOLLERR | EPOLLHUP)) != 0) {
+          if (AsyncIoFail (Connection, &Events[EventCount])) {
+            EventCount++;
+          }
+          continue;
+        }
+      }
+      AsyncIoEpollUpdate (Connection);
+    }
+  }
+  return EventCount;
+}
+
+#else
+
+BOOLEAN
+AsyncIoInit (
+  IN UINT32           Backend,
+  IN UINT32           MaxConnectionCount
+  )
+{
+  printf ("Async I/O is not supported\n");
+  return FALSE;
+}
+
+VOID
+AsyncIoClose (
+  VOID
+  )
+{
+}
+
+UINT32
+AsyncIoGetBackend (
+  VOID
+  )
+{
+  return 0;
+}
+
+VOID *
+AsyncIoAddConnection (
+  IN SOCKET           Socket,
+  IN VOID             *Context
+  )
+{
+  return NULL;
+}
+
+VOID
+AsyncIoRemoveConnection (
+  IN VOID             *Connection
+  )
+{
+}
+
+UINT8 *
+AsyncIoGetSendBuffer (
+  IN  VOID            *Connection,
+  OUT UINTN           *BufferSize
+  )
+{
+  *BufferSize = 0;
+  return NULL;
+}
+
+BOOLEAN
+AsyncIoQueueSend (
+  IN VOID             *Connection,
+  IN UINT32           Command,
+  IN UINTN            PayloadSize
+  )
+{
+  return FALSE;
+}
+
+BOOLEAN
+AsyncIoQueueReceive (
+  IN VOID             *Connection
+  )
+{
+  return FALSE;
+}
+
+UINT32
+AsyncIoWait (
+  OUT ASYNC_IO_EVENT  *Events,
+  IN  UINT32          MaxEventCount
+  )
+{
+  return 0;
+}
+
+#endif
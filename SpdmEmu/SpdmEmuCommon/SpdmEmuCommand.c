@@ -9,11 +9,54 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmEmu.h"
 
-UINT32  mUseTransportLayer = SOCKET_TRANSPORT_TYPE_MCTP;
+UINT32   mUseTransportLayer = SOCKET_TRANSPORT_TYPE_MCTP;
+BOOLEAN  mDumpPlatformData = TRUE;
+
+#define SOCKET_RECEIVE_BUFFER_SIZE  0x4000
+
+//
+// The bytes received from the platform socket, but not consumed yet.
+// One recv usually brings a whole message, and its fields are then read from this buffer.
+// The buffer is per thread, because a concurrent responder serves each socket in its own thread.
+//
+THREAD_LOCAL UINT8   mSocketReceiveBuffer[SOCKET_RECEIVE_BUFFER_SIZE];
+THREAD_LOCAL UINT32  mSocketReceiveHead;
+THREAD_LOCAL UINT32  mSocketReceiveTail;
+
+/**
+  Prepare a connected platform socket.
+
+  Nagle's algorithm is disabled, because every message is a request waiting for its response.
+  The bytes buffered from the previous socket are dropped.
+**/
+VOID
+InitPlatformSocket (
+  IN SOCKET           Socket
+  )
+{
+  INT32  NoDelay;
+
+  NoDelay = 1;
+  if (setsockopt (Socket, IPPROTO_TCP, TCP_NODELAY, (CHAR8 *)&NoDelay, sizeof(NoDelay)) == SOCKET_ERROR) {
+    printf ("Set TCP_NODELAY error - 0x%x\n",
+#ifdef _MSC_VER
+      WSAGetLastError()
+#else
+      errno
+#endif
+      );
+  }
+  mSocketReceiveHead = 0;
+  mSocketReceiveTail = 0;
+}
 
 /**
   Read number of bytes data in blocking mode.
 
+  The data is taken from the receive buffer first. When the receive buffer is empty,
+  it is refilled by one recv of all the available data. A read larger than the receive buffer
+  goes to the caller buffer directly.
+
   If there is no enough data in socket, this function will wait.
   This function will return if enough data is read, or socket error.
 **/
@@ -26,93 +69,109 @@ ReadBytes (
 {
   INT32                 Result;
   UINT32                NumberReceived;
+  UINT32                CopySize;
+  BOOLEAN               Direct;
 
   NumberReceived = 0;
   while (NumberReceived < NumberOfBytes) {
-    Result = recv (Socket, (CHAR8 *)(Buffer + NumberReceived), NumberOfBytes - NumberReceived, 0);
-    if (Result == -1) {
-      printf ("Receive error - 0x%x\n",
+    if (mSocketReceiveHead == mSocketReceiveTail) {
+      mSocketReceiveHead = 0;
+      mSocketReceiveTail = 0;
+      Direct = (BOOLEAN)(NumberOfBytes - NumberReceived >= sizeof(mSocketReceiveBuffer));
+      if (Direct) {
+        Result = recv (Socket, (CHAR8 *)(Buffer + NumberReceived), NumberOfBytes - NumberReceived, 0);
+      } else {
+        Result = recv (Socket, (CHAR8 *)mSocketReceiveBuffer, sizeof(mSocketReceiveBuffer), 0);
+      }
+      if (Result == -1) {
+        printf ("Receive error - 0x%x\n",
 #ifdef _MSC_VER
-        WSAGetLastError()
+          WSAGetLastError()
 #else
-        errno
+          errno
 #endif
-        );
-      return FALSE;
-    }
-    if (Result == 0) {
-      return FALSE;
+          );
+        return FALSE;
+      }
+      if (Result == 0) {
+        return FALSE;
+      }
+      if (Direct) {
+        NumberReceived += Result;
+        continue;
+      }
+      mSocketReceiveTail = Result;
     }
-    NumberReceived += Result;
+    CopySize = MIN (NumberOfBytes - NumberReceived, mSocketReceiveTail - mSocketReceiveHead);
+    CopyMem (Buffer + NumberReceived, mSocketReceiveBuffer + mSocketReceiveHead, CopySize);
+    mSocketReceiveHead += CopySize;
+    NumberReceived += CopySize;
   }
   return TRUE;
 }
 
 BOOLEAN
-ReadData32 (
-  IN SOCKET           Socket,
-  OUT UINT32          *Data
+SocketReceivePlatformData (
+  IN  SOCKET           Socket,
+  OUT UINT32           *Command,
+  OUT UINT8            *ReceiveBuffer,
+  IN OUT UINTN         *BytesToReceive
   )
 {
   BOOLEAN  Result;
+  UINT32   Header[3];
+  UINT32   TransportType;
+  UINT32   BytesReceived;
 
-  Result = ReadBytes (Socket, (UINT8 *)Data, sizeof(UINT32));
+  //
+  // Command, TransportType and PayloadSize are read together.
+  //
+  Result = ReadBytes (Socket, (UINT8 *)Header, sizeof(Header));
   if (!Result) {
     return Result;
   }
-  *Data = ntohl (*Data);
-  return TRUE;
-}
-
-/**
-  Read multiple bytes in blocking mode.
-
-  The length is presented as first 4 bytes in big endian.
-  The data follows the length.
-
-  If there is no enough data in socket, this function will wait.
-  This function will return if enough data is read, or socket error.
-**/
-BOOLEAN
-ReadMultipleBytes (
-  IN SOCKET           Socket,
-  OUT UINT8           *Buffer,
-  OUT UINT32          *BytesReceived,
-  IN UINT32           MaxBufferLength
-  )
-{
-  UINT32               Length;
-  BOOLEAN              Result;
-
-  Result = ReadData32 (Socket, &Length);
-  if (!Result) {
-    return Result;
+  if (mDumpPlatformData) {
+    printf ("Platform Port Receive Command: ");
+    DumpData ((UINT8 *)&Header[0], sizeof(UINT32));
+    printf ("\n");
+    printf ("Platform Port Receive TransportType: ");
+    DumpData ((UINT8 *)&Header[1], sizeof(UINT32));
+    printf ("\n");
+    printf ("Platform Port Receive Size: ");
+    DumpData ((UINT8 *)&Header[2], sizeof(UINT32));
+    printf ("\n");
   }
-  printf ("Platform Port Receive Size: ");
-  Length = ntohl(Length);
-  DumpData ((UINT8 *)&Length, sizeof(UINT32));
-  printf ("\n");
-  Length = ntohl(Length);
-
-  *BytesReceived = Length;
-  if (*BytesReceived > MaxBufferLength) {
-    printf ("Buffer too small (0x%x). Expected - 0x%x\n", MaxBufferLength, *BytesReceived);
+  *Command = ntohl (Header[0]);
+  TransportType = ntohl (Header[1]);
+  BytesReceived = ntohl (Header[2]);
+
+  if (TransportType != mUseTransportLayer) {
+    printf ("TransportType mismatch\n");
     return FALSE;
   }
-  if (Length == 0) {
-    return TRUE;
+  if (BytesReceived > *BytesToReceive) {
+    printf ("Buffer too small (0x%x). Expected - 0x%x\n", (UINT32)*BytesToReceive, BytesReceived);
+    return FALSE;
   }
-  Result = ReadBytes (Socket, Buffer, Length);
-  if (!Result) {
-    return Result;
+  if (BytesReceived != 0) {
+    Result = ReadBytes (Socket, ReceiveBuffer, BytesReceived);
+    if (!Result) {
+      return Result;
+    }
+    if (mDumpPlatformData) {
+      printf ("Platform Port Receive Buffer:\n    ");
+      DumpData (ReceiveBuffer, BytesReceived);
+      printf ("\n");
+    }
   }
-  printf ("Platform Port Receive Buffer:\n    ");
-  DumpData (Buffer, Length);
-  printf ("\n");
+  *BytesToReceive = BytesReceived;
 
-  return TRUE;
+  return Result;
 }
 
+/**
+  Receive the platform data from the platform socket, or from the shared memory if --shm is used.
+**/
 BOOLEAN
 ReceivePlatformData (
   IN  SOCKET           Socket,
@@ -122,44 +181,24 @@ ReceivePlatformData (
   )
 {
   BOOLEAN  Result;
-  UINT32   Response;
-  UINT32   TransportType;
-  UINT32   BytesReceived;
-
-  Result = ReadData32 (Socket, &Response);
-  if (!Result) {
-    return Result;
-  }
-  *Command = Response;
-  printf ("Platform Port Receive Command: ");
-  Response = ntohl(Response);
-  DumpData ((UINT8 *)&Response, sizeof(UINT32));
-  printf ("\n");
 
-  Result = ReadData32 (Socket, &TransportType);
-  if (!Result) {
-    return Result;
+  if (mSharedMemoryName != NULL) {
+    Result = SharedMemoryReceivePlatformData (Command, ReceiveBuffer, BytesToReceive);
+  } else {
+    Result = SocketReceivePlatformData (Socket, Command, ReceiveBuffer, BytesToReceive);
   }
-  printf ("Platform Port Receive TransportType: ");
-  TransportType = ntohl(TransportType);
-  DumpData ((UINT8 *)&TransportType, sizeof(UINT32));
-  printf ("\n");
-  TransportType = ntohl(TransportType);
-  if (TransportType != mUseTransportLayer) {
-    printf ("TransportType mismatch\n");
-    return FALSE;
-  }
-
-  BytesReceived = 0;
-  Result = ReadMultipleBytes (Socket, ReceiveBuffer, &BytesReceived, (UINT32)*BytesToReceive);
   if (!Result) {
     return Result;
   }
-  *BytesToReceive = BytesReceived;
 
   switch (*Command) {
   case SOCKET_SPDM_COMMAND_SHUTDOWN:
-    ClosePcapPacketFile ();
+    //
+    // A SHUTDOWN only ends its own client of the concurrent or sharded server, which still captures the other clients.
+    //
+    if (mServerMode == SERVER_MODE_SERIAL) {
+      ClosePcapPacketFile ();
+    }
     break;
   case SOCKET_SPDM_COMMAND_NORMAL:
     if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_MCTP) {
@@ -171,9 +210,9 @@ ReceivePlatformData (
       MctpHeader.DestinationId = 0;
       MctpHeader.SourceId = 0;
       MctpHeader.MessageTag = 0xC0;
-      AppendPcapPacketData (&MctpHeader, sizeof(MctpHeader), ReceiveBuffer, BytesReceived);
+      AppendPcapPacketData (&MctpHeader, sizeof(MctpHeader), ReceiveBuffer, *BytesToReceive);
     } else {
-      AppendPcapPacketData (NULL, 0, ReceiveBuffer, BytesReceived);
+      AppendPcapPacketData (NULL, 0, ReceiveBuffer, *BytesToReceive);
     }
     break;
   }
@@ -182,23 +221,44 @@ ReceivePlatformData (
 }
 
 /**
-  Write number of bytes data in blocking mode.
+  Write a header and a payload in blocking mode, with one gathered send.
 
   This function will return if data is written, or socket error.
 **/
 BOOLEAN
-WriteBytes(
+WriteBytesVector (
   IN  SOCKET           Socket,
-  IN  UINT8            *Buffer,
-  IN  UINT32           NumberOfBytes
+  IN  UINT8            *Header,
+  IN  UINT32           HeaderSize,
+  IN  UINT8            *Payload,
+  IN  UINT32           PayloadSize
   )
 {
   INT32                Result;
-  UINT32               NumberSent;
+#ifdef _MSC_VER
+  WSABUF               Vector[2];
+  DWORD                NumberSent;
+#else
+  struct iovec         Vector[2];
+#endif
 
-  NumberSent = 0;
-  while (NumberSent < NumberOfBytes) {
-    Result = send (Socket, (CHAR8 *)(Buffer + NumberSent), NumberOfBytes - NumberSent, 0);
+  while (HeaderSize + PayloadSize != 0) {
+#ifdef _MSC_VER
+    Vector[0].buf = (CHAR8 *)Header;
+    Vector[0].len = HeaderSize;
+    Vector[1].buf = (CHAR8 *)Payload;
+    Vector[1].len = PayloadSize;
+    Result = WSASend (Socket, Vector, 2, &NumberSent, 0, NULL, NULL);
+    if (Result == 0) {
+      Result = (INT32)NumberSent;
+    }
+#else
+    Vector[0].iov_base = Header;
+    Vector[0].iov_len = HeaderSize;
+    Vector[1].iov_base = Payload;
+    Vector[1].iov_len = PayloadSize;
+    Result = (INT32)writev (Socket, Vector, 2);
+#endif
     if (Result == -1) {
 #ifdef _MSC_VER
       if (WSAGetLastError() == 0x2745) {
@@ -217,56 +277,59 @@ WriteBytes(
 #endif
       return FALSE;
     }
-    NumberSent += Result;
+    if ((UINT32)Result >= HeaderSize) {
+      Result -= HeaderSize;
+      Header += HeaderSize;
+      HeaderSize = 0;
+      Payload += Result;
+      PayloadSize -= Result;
+    } else {
+      Header += Result;
+      HeaderSize -= Result;
+    }
   }
   return TRUE;
 }
 
 BOOLEAN
-WriteData32 (
-  IN SOCKET           Socket,
-  IN UINT32           Data
-  )
-{
-  Data = htonl(Data);
-  return WriteBytes (Socket, (UINT8 *)&Data, sizeof(UINT32));
-}
-
-/**
-  Write multiple bytes.
-
-  The length is presented as first 4 bytes in big endian.
-  The data follows the length.
-**/
-BOOLEAN
-WriteMultipleBytes (
+SocketSendPlatformData (
   IN SOCKET           Socket,
-  IN UINT8            *Buffer,
-  IN UINT32           BytesToSend
+  IN UINT32           Command,
+  IN UINT8            *SendBuffer,
+  IN UINTN            BytesToSend
   )
 {
   BOOLEAN  Result;
+  UINT32   Header[3];
 
-  Result = WriteData32 (Socket, BytesToSend);
+  Header[0] = htonl (Command);
+  Header[1] = htonl (mUseTransportLayer);
+  Header[2] = htonl ((UINT32)BytesToSend);
+  Result = WriteBytesVector (Socket, (UINT8 *)Header, sizeof(Header), SendBuffer, (UINT32)BytesToSend);
   if (!Result) {
     return Result;
   }
-  printf ("Platform Port Transmit Size: ");
-  BytesToSend = htonl(BytesToSend);
-  DumpData ((UINT8 *)&BytesToSend, sizeof(UINT32));
-  printf ("\n");
-  BytesToSend = htonl(BytesToSend);
 
-  Result = WriteBytes (Socket, Buffer, BytesToSend);
-  if (!Result) {
-    return Result;
+  if (mDumpPlatformData) {
+    printf ("Platform Port Transmit Command: ");
+    DumpData ((UINT8 *)&Header[0], sizeof(UINT32));
+    printf ("\n");
+    printf ("Platform Port Transmit TransportType: ");
+    DumpData ((UINT8 *)&Header[1], sizeof(UINT32));
+    printf ("\n");
+    printf ("Platform Port Transmit Size: ");
+    DumpData ((UINT8 *)&Header[2], sizeof(UINT32));
+    printf ("\n");
+    printf ("Platform Port Transmit Buffer:\n    ");
+    DumpData (SendBuffer, BytesToSend);
+    printf ("\n");
   }
-  printf ("Platform Port Transmit Buffer:\n    ");
-  DumpData (Buffer, BytesToSend);
-  printf ("\n");
   return TRUE;
 }
 
+/**
+  Send the platform data to the platform socket, or to the shared memory if --shm is used.
+**/
 BOOLEAN
 SendPlatformData (
   IN SOCKET           Socket,
@@ -276,36 +339,31 @@ SendPlatformData (
   )
 {
   BOOLEAN  Result;
-  UINT32   Request;
-  UINT32   TransportType;
 
-  Request = Command;
-  Result = WriteData32 (Socket, Request);
-  if (!Result) {
-    return Result;
+  //
+  // The message arrives at the peer after the time it takes on the link of the cost model.
+  //
+  if (Command == SOCKET_SPDM_COMMAND_NORMAL) {
+    CostModelLinkDelay (BytesToSend);
   }
-  printf ("Platform Port Transmit Command: ");
-  Request = htonl(Request);
-  DumpData ((UINT8 *)&Request, sizeof(UINT32));
-  printf ("\n");
 
-  Result = WriteData32 (Socket, mUseTransportLayer);
-  if (!Result) {
-    return Result;
+  if (mSharedMemoryName != NULL) {
+    Result = SharedMemorySendPlatformData (Command, SendBuffer, BytesToSend);
+  } else {
+    Result = SocketSendPlatformData (Socket, Command, SendBuffer, BytesToSend);
   }
-  printf ("Platform Port Transmit TransportType: ");
-  TransportType = ntohl(mUseTransportLayer);
-  DumpData ((UINT8 *)&TransportType, sizeof(UINT32));
-  printf ("\n");
-
-  Result = WriteMultipleBytes (Socket, SendBuffer, (UINT32)BytesToSend);
   if (!Result) {
     return Result;
   }
 
   switch (Command) {
   case SOCKET_SPDM_COMMAND_SHUTDOWN:
-    ClosePcapPacketFile ();
+    //
+    // A SHUTDOWN only ends its own client of the concurrent or sharded server, which still captures the other clients.
+    //
+    if (mServerMode == SERVER_MODE_SERIAL) {
+      ClosePcapPacketFile ();
+    }
     break;
   case SOCKET_SPDM_COMMAND_NORMAL:
     if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_MCTP) {
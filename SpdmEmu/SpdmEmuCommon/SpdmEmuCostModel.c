@@ -0,0 +1,157 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmEmu.h"
+
+//
+// The cost model makes the emulators as slow as a real link and a real device, over the loopback socket.
+// Each emulator delays the messages it sends by the time they take on the modelled link,
+// so both emulators are given the same link options to model both directions.
+// The responder also delays its signing, its measurement collection and its DHE steps.
+//
+
+//
+// The bandwidth of the link in bits per second, 0 for no limit.
+//
+UINT32  mLinkBandwidth = 0;
+//
+// The latency of each packet on the link in microseconds.
+//
+UINT32  mLinkLatency = 0;
+//
+// The maximum size in bytes of a packet on the link, 0 to send each message in one packet.
+//
+UINT32  mLinkMtu = 0;
+//
+// The delay of each DHE step of the responder in microseconds.
+//
+UINT32  mDheDelay = 0;
+
+///
+/// The rough figures of a link, for --link.
+///
+typedef struct {
+  CHAR8   *Name;
+  UINT32  Bandwidth;
+  UINT32  Latency;
+  UINT32  Mtu;
+} LINK_PRESET;
+
+LINK_PRESET  mLinkPresetTable[] = {
+  //
+  // MCTP over SMBus at 100 kHz, with the baseline transmission unit.
+  //
+  {"SMBUS",    100000,     500, 64},
+  //
+  // MCTP over I3C at 12.5 MHz SDR, with the baseline transmission unit.
+  //
+  {"I3C",      12500000,   20,  64},
+  //
+  // MCTP over PCIe VDM, with the baseline transmission unit.
+  //
+  {"PCIE_VDM", 2000000000, 2,   64},
+  //
+  // A PCIe DOE mailbox, written one DWORD per configuration access, and polled for the response.
+  //
+  {"DOE",      32000000,   50,  0},
+  //
+  // No delay.
+  //
+  {"LOOPBACK", 0,          0,   0},
+};
+
+/**
+  Set the link of the cost model from the name of a preset.
+
+  @param  Name                         The name of the preset.
+
+  @retval TRUE   The link is set.
+  @retval FALSE  There is no preset of the name.
+**/
+BOOLEAN
+CostModelSetLinkPreset (
+  IN CHAR8  *Name
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE(mLinkPresetTable); Index++) {
+    if (strcmp (Name, mLinkPresetTable[Index].Name) == 0) {
+      mLinkBandwidth = mLinkPresetTable[Index].Bandwidth;
+      mLinkLatency = mLinkPresetTable[Index].Latency;
+      mLinkMtu = mLinkPresetTable[Index].Mtu;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Check if the cost model delays the messages.
+
+  @retval TRUE   The messages are delayed.
+  @retval FALSE  The messages are sent at once.
+**/
+BOOLEAN
+CostModelLinkEnabled (
+  VOID
+  )
+{
+  return (BOOLEAN)((mLinkBandwidth != 0) || (mLinkLatency != 0));
+}
+
+/**
+  Wait for a number of microseconds of the monotonic clock of the host.
+
+  It is the delay function of the device cost model of SpdmDeviceSecretLib.
+
+  @param  Microseconds                 The delay, in microseconds.
+**/
+VOID
+CostModelDelay (
+  IN UINT32  Microseconds
+  )
+{
+  MicroSecondDelay (Microseconds);
+}
+
+/**
+  Wait for the time a message takes on the link of the cost model.
+
+  The message is split in packets of the MTU. The packets are sent one after another,
+  each taking the latency of the link, and all of them take the bandwidth of the link.
+
+  @param  MessageSize                  The size in bytes of the message.
+**/
+VOID
+CostModelLinkDelay (
+  IN UINTN  MessageSize
+  )
+{
+  UINT64  PacketCount;
+  UINT64  Delay;
+
+  if (!CostModelLinkEnabled ()) {
+    return;
+  }
+
+  if ((mLinkMtu == 0) || (MessageSize == 0)) {
+    PacketCount = 1;
+  } else {
+    PacketCount = ((UINT64)MessageSize + mLinkMtu - 1) / mLinkMtu;
+  }
+  Delay = PacketCount * mLinkLatency;
+  if (mLinkBandwidth != 0) {
+    Delay += (UINT64)MessageSize * 8 * 1000000 / mLinkBandwidth;
+  }
+  if (Delay > MAX_UINT32) {
+    Delay = MAX_UINT32;
+  }
+  CostModelDelay ((UINT32)Delay);
+}
@@ -157,3 +157,360 @@ UINT16  mSupportAeadAlgo = SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM |
   SPDM_ALGORITHMS_KEY_SCHEDULE_HMAC_HASH,
 */
 UINT16  mSupportKeyScheduleAlgo = SPDM_ALGORITHMS_KEY_SCHEDULE_HMAC_HASH;
+
+#define MAX_CERT_CACHE_ENTRY_COUNT  64
+
+///
+/// A certificate read once and shared by all SPDM contexts.
+///
+typedef struct {
+  UINT32   Kind;
+  UINT32   HashAlgo;
+  UINT32   AsymAlgo;
+  BOOLEAN  Result;
+  VOID     *Data;
+  UINTN    DataSize;
+  VOID     *Hash;
+  UINTN    HashSize;
+} SPDM_EMU_CERT_CACHE_ENTRY;
+
+SPDM_EMU_CERT_CACHE_ENTRY  mCertCache[MAX_CERT_CACHE_ENTRY_COUNT];
+UINTN                      mCertCacheCount;
+
+/**
+  Read a certificate of a kind from the test key files.
+**/
+BOOLEAN
+ReadCertificate (
+  IN  UINT32               Kind,
+  IN  UINT32               HashAlgo,
+  IN  UINT32               AsymAlgo,
+  OUT VOID                 **Data,
+  OUT UINTN                *DataSize,
+  OUT VOID                 **Hash,
+  OUT UINTN                *HashSize
+  )
+{
+  switch (Kind) {
+  case CERT_KIND_RESPONDER_CHAIN:
+    return ReadResponderPublicCertificateChain (HashAlgo, AsymAlgo, Data, DataSize, NULL, NULL);
+  case CERT_KIND_RESPONDER_ROOT:
+    return ReadResponderRootPublicCertificate (HashAlgo, AsymAlgo, Data, DataSize, Hash, HashSize);
+  case CERT_KIND_REQUESTER_CHAIN:
+    return ReadRequesterPublicCertificateChain (HashAlgo, (UINT16)AsymAlgo, Data, DataSize, NULL, NULL);
+  case CERT_KIND_REQUESTER_ROOT:
+    return ReadRequesterRootPublicCertificate (HashAlgo, (UINT16)AsymAlgo, Data, DataSize, Hash, HashSize);
+  default:
+    return FALSE;
+  }
+}
+
+/**
+  Read a certificate, or return the copy read for a previous SPDM context.
+
+  The caller must hold the server lock. The certificate is never freed,
+  because the SPDM contexts keep pointing to it.
+**/
+BOOLEAN
+ReadCachedCertificate (
+  IN  UINT32               Kind,
+  IN  UINT32               HashAlgo,
+  IN  UINT32               AsymAlgo,
+  OUT VOID                 **Data,
+  OUT UINTN                *DataSize,
+  OUT VOID                 **Hash,
+  OUT UINTN                *HashSize
+  )
+{
+  SPDM_EMU_CERT_CACHE_ENTRY  *Entry;
+  SPDM_EMU_CERT_CACHE_ENTRY  NewEntry;
+  UINTN                      Index;
+
+  for (Index = 0; Index < mCertCacheCount; Index++) {
+    Entry = &mCertCache[Index];
+    if ((Entry->Kind == Kind) && (Entry->HashAlgo == HashAlgo) && (Entry->AsymAlgo == AsymAlgo)) {
+      break;
+    }
+  }
+  if (Index == mCertCacheCount) {
+    ZeroMem (&NewEntry, sizeof(NewEntry));
+    NewEntry.Kind = Kind;
+    NewEntry.HashAlgo = HashAlgo;
+    NewEntry.AsymAlgo = AsymAlgo;
+    if (Kind > CERT_KIND_REQUESTER_ROOT) {
+      return FALSE;
+    }
+    NewEntry.Result = ReadCertificate (Kind, HashAlgo, AsymAlgo, &NewEntry.Data, &NewEntry.DataSize, &NewEntry.Hash, &NewEntry.HashSize);
+    if (mCertCacheCount == MAX_CERT_CACHE_ENTRY_COUNT) {
+      //
+      // Not cached, so the certificate of this SPDM context is never freed either.
+      //
+      Entry = &NewEntry;
+    } else {
+      Entry = &mCertCache[mCertCacheCount];
+      CopyMem (Entry, &NewEntry, sizeof(NewEntry));
+      mCertCacheCount++;
+    }
+  }
+
+  *Data = Entry->Data;
+  *DataSize = Entry->DataSize;
+  if (Hash != NULL) {
+    *Hash = Entry->Hash;
+    *HashSize = Entry->HashSize;
+  }
+  return Entry->Result;
+}
+
+#define SPDM_EMU_PROVISION_SIGNATURE  SIGNATURE_64('S', 'P', 'D', 'M', 'P', 'R', 'O', 'V')
+#define SPDM_EMU_PROVISION_VERSION    1
+
+//
+// The hash and asymmetric algorithms of the test key files.
+//
+#define SPDM_EMU_PROVISION_HASH_ALGO  (SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256 | \
+                                       SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384 | \
+                                       SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512)
+#define SPDM_EMU_PROVISION_ASYM_ALGO  (SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048 | \
+                                       SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048 | \
+                                       SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072 | \
+                                       SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072 | \
+                                       SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256 | \
+                                       SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384)
+
+#pragma pack(1)
+
+///
+/// The provisioning image starts with the header, followed by the entry table and the entry data.
+///
+typedef struct {
+  UINT64   Signature;
+  UINT32   Version;
+  UINT32   EntryCount;
+  UINT32   ImageSize;
+  UINT32   Reserved;
+} SPDM_EMU_PROVISION_HEADER;
+
+///
+/// A certificate of the image, as returned by ReadCachedCertificate.
+/// The offsets are relative to the start of the image. The data is 8-byte aligned.
+/// The hash, if any, is the hash of the root certificate, within the data.
+///
+typedef struct {
+  UINT32   Kind;
+  UINT32   HashAlgo;
+  UINT32   AsymAlgo;
+  UINT32   DataOffset;
+  UINT32   DataSize;
+  UINT32   HashOffset;
+  UINT32   HashSize;
+  UINT32   Reserved;
+} SPDM_EMU_PROVISION_ENTRY;
+
+#pragma pack()
+
+/**
+  Build a provisioning image of all the certificates of the supported algorithms.
+
+  The certificate chains are built, and their root certificates hashed, once offline,
+  for each hash algorithm of --hash and each asymmetric algorithm of --asym and --req_asym.
+
+  @param  FileName                     The name of the provisioning image file.
+
+  @retval TRUE  the provisioning image is written.
+  @retval FALSE the provisioning image cannot be built or written.
+**/
+BOOLEAN
+BuildProvisionImage (
+  IN CHAR8   *FileName
+  )
+{
+  SPDM_EMU_CERT_CACHE_ENTRY  Certificate[MAX_CERT_CACHE_ENTRY_COUNT];
+  UINTN                      CertificateCount;
+  SPDM_EMU_PROVISION_HEADER  *Header;
+  SPDM_EMU_PROVISION_ENTRY   *Entry;
+  UINT8                      *Image;
+  UINTN                      ImageSize;
+  UINTN                      Offset;
+  UINT32                     Kind;
+  UINT32                     HashAlgo;
+  UINT32                     AsymAlgo;
+  UINT32                     AsymAlgoSet;
+  UINTN                      Index;
+  BOOLEAN                    Result;
+
+  CertificateCount = 0;
+  ImageSize = sizeof(SPDM_EMU_PROVISION_HEADER);
+  for (Kind = CERT_KIND_RESPONDER_CHAIN; Kind <= CERT_KIND_REQUESTER_ROOT; Kind++) {
+    if ((Kind == CERT_KIND_RESPONDER_CHAIN) || (Kind == CERT_KIND_RESPONDER_ROOT)) {
+      AsymAlgoSet = mSupportAsymAlgo & SPDM_EMU_PROVISION_ASYM_ALGO;
+    } else {
+      AsymAlgoSet = mSupportReqAsymAlgo & SPDM_EMU_PROVISION_ASYM_ALGO;
+    }
+    for (HashAlgo = 1; HashAlgo != 0; HashAlgo <<= 1) {
+      if ((mSupportHashAlgo & SPDM_EMU_PROVISION_HASH_ALGO & HashAlgo) == 0) {
+        continue;
+      }
+      for (AsymAlgo = 1; AsymAlgo != 0; AsymAlgo <<= 1) {
+        if ((AsymAlgoSet & AsymAlgo) == 0) {
+          continue;
+        }
+        if (CertificateCount == MAX_CERT_CACHE_ENTRY_COUNT) {
+          printf ("provision_build - too many certificates, %d at most\n", MAX_CERT_CACHE_ENTRY_COUNT);
+          Result = FALSE;
+          goto Done;
+        }
+        ZeroMem (&Certificate[CertificateCount], sizeof(Certificate[CertificateCount]));
+        Certificate[CertificateCount].Kind = Kind;
+        Certificate[CertificateCount].HashAlgo = HashAlgo;
+        Certificate[CertificateCount].AsymAlgo = AsymAlgo;
+        if (!ReadCertificate (
+               Kind,
+               HashAlgo,
+               AsymAlgo,
+               &Certificate[CertificateCount].Data,
+               &Certificate[CertificateCount].DataSize,
+               &Certificate[CertificateCount].Hash,
+               &Certificate[CertificateCount].HashSize
+               )) {
+          printf ("provision_build - skip certificate kind %d, hash 0x%08x, asym 0x%08x\n", Kind, HashAlgo, AsymAlgo);
+          continue;
+        }
+        ImageSize += sizeof(SPDM_EMU_PROVISION_ENTRY);
+        CertificateCount++;
+      }
+    }
+  }
+
+  ImageSize = ALIGN_VALUE (ImageSize, 8);
+  for (Index = 0; Index < CertificateCount; Index++) {
+    ImageSize += ALIGN_VALUE (Certificate[Index].DataSize, 8);
+  }
+  Image = (VOID *)malloc (ImageSize);
+  if (Image == NULL) {
+    Result = FALSE;
+    goto Done;
+  }
+  ZeroMem (Image, ImageSize);
+
+  Header = (VOID *)Image;
+  Header->Signature = SPDM_EMU_PROVISION_SIGNATURE;
+  Header->Version = SPDM_EMU_PROVISION_VERSION;
+  Header->EntryCount = (UINT32)CertificateCount;
+  Header->ImageSize = (UINT32)ImageSize;
+  Entry = (VOID *)(Header + 1);
+  Offset = ALIGN_VALUE (sizeof(SPDM_EMU_PROVISION_HEADER) + CertificateCount * sizeof(SPDM_EMU_PROVISION_ENTRY), 8);
+  for (Index = 0; Index < CertificateCount; Index++) {
+    Entry[Index].Kind = Certificate[Index].Kind;
+    Entry[Index].HashAlgo = Certificate[Index].HashAlgo;
+    Entry[Index].AsymAlgo = Certificate[Index].AsymAlgo;
+    Entry[Index].DataOffset = (UINT32)Offset;
+    Entry[Index].DataSize = (UINT32)Certificate[Index].DataSize;
+    if (Certificate[Index].Hash != NULL) {
+      Entry[Index].HashOffset = (UINT32)(Offset + ((UINT8 *)Certificate[Index].Hash - (UINT8 *)Certificate[Index].Data));
+      Entry[Index].HashSize = (UINT32)Certificate[Index].HashSize;
+    }
+    CopyMem (Image + Offset, Certificate[Index].Data, Certificate[Index].DataSize);
+    Offset += ALIGN_VALUE (Certificate[Index].DataSize, 8);
+  }
+
+  Result = WriteOutputFile (FileName, Image, ImageSize);
+  if (Result) {
+    printf ("provision_build - %d certificates, %d bytes\n", (UINT32)CertificateCount, (UINT32)ImageSize);
+  }
+  free (Image);
+
+Done:
+  for (Index = 0; Index < CertificateCount; Index++) {
+    free (Certificate[Index].Data);
+  }
+  return Result;
+}
+
+/**
+  Load a provisioning image built by BuildProvisionImage.
+
+  The image is read in one piece, and its certificates are installed in the certificate cache
+  in place, so that ReadCachedCertificate returns them without reading, building or hashing anything.
+  The certificates missing from the image are still read from the files on demand.
+
+  @param  FileName                     The name of the provisioning image file.
+
+  @retval TRUE  the provisioning image is loaded.
+  @retval FALSE the provisioning image cannot be read, or it is invalid.
+**/
+BOOLEAN
+LoadProvisionImage (
+  IN CHAR8   *FileName
+  )
+{
+  SPDM_EMU_PROVISION_HEADER  *Header;
+  SPDM_EMU_PROVISION_ENTRY   *Entry;
+  SPDM_EMU_CERT_CACHE_ENTRY  *CacheEntry;
+  UINT8                      *Image;
+  UINTN                      ImageSize;
+  UINTN                      Index;
+
+  if (!ReadInputFile (FileName, (VOID **)&Image, &ImageSize)) {
+    return FALSE;
+  }
+
+  //
+  // Validate the whole image before installing any certificate.
+  //
+  Header = (VOID *)Image;
+  if ((ImageSize < sizeof(SPDM_EMU_PROVISION_HEADER)) ||
+      (Header->Signature != SPDM_EMU_PROVISION_SIGNATURE) ||
+      (Header->ImageSize != ImageSize)) {
+    printf ("provision - %s is not a provisioning image\n", FileName);
+    goto Error;
+  }
+  if (Header->Version != SPDM_EMU_PROVISION_VERSION) {
+    printf ("provision - unsupported version %d\n", Header->Version);
+    goto Error;
+  }
+  if ((Header->EntryCount > MAX_CERT_CACHE_ENTRY_COUNT - mCertCacheCount) ||
+      (Header->EntryCount > (ImageSize - sizeof(SPDM_EMU_PROVISION_HEADER)) / sizeof(SPDM_EMU_PROVISION_ENTRY))) {
+    printf ("provision - invalid entry count %d\n", Header->EntryCount);
+    goto Error;
+  }
+  Entry = (VOID *)(Header + 1);
+  for (Index = 0; Index < Header->EntryCount; Index++) {
+    if ((Entry[Index].Kind > CERT_KIND_REQUESTER_ROOT) ||
+        ((Entry[Index].DataOffset & 0x7) != 0) ||
+        (Entry[Index].DataOffset > ImageSize) ||
+        (Entry[Index].DataSize > ImageSize - Entry[Index].DataOffset) ||
+        ((Entry[Index].HashSize != 0) &&
+         ((Entry[Index].HashOffset < Entry[Index].DataOffset) ||
+          (Entry[Index].HashOffset > Entry[Index].DataOffset + Entry[Index].DataSize) ||
+          (Entry[Index].HashSize > Entry[Index].DataOffset + Entry[Index].DataSize - Entry[Index].HashOffset)))) {
+      printf ("provision - invalid entry %d\n", (UINT32)Index);
+      goto Error;
+    }
+  }
+
+  //
+  // The certificate cache points to the image, which is never freed.
+  //
+  for (Index = 0; Index < Header->EntryCount; Index++) {
+    CacheEntry = &mCertCache[mCertCacheCount];
+    ZeroMem (CacheEntry, sizeof(SPDM_EMU_CERT_CACHE_ENTRY));
+    CacheEntry->Kind = Entry[Index].Kind;
+    CacheEntry->HashAlgo = Entry[Index].HashAlgo;
+    CacheEntry->AsymAlgo = Entry[Index].AsymAlgo;
+    CacheEntry->Result = TRUE;
+    CacheEntry->Data = Image + Entry[Index].DataOffset;
+    CacheEntry->DataSize = Entry[Index].DataSize;
+    if (Entry[Index].HashSize != 0) {
+      CacheEntry->Hash = Image + Entry[Index].HashOffset;
+      CacheEntry->HashSize = Entry[Index].HashSize;
+    }
+    mCertCacheCount++;
+  }
+  printf ("provision - %d certificates\n", Header->EntryCount);
+  return TRUE;
+
+Error:
+  free (Image);
+  return FALSE;
+}
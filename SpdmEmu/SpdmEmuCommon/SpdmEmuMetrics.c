@@ -0,0 +1,633 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmEmu.h"
+
+//
+// The metrics file is in the OpenMetrics text format, and can be read by the textfile collector
+// of the Prometheus node exporter, or parsed by the CI after a load test.
+// The statistics of each SPDM context are added to the process totals by the thread running the context,
+// at most once per interval and when the connection ends, and reset in the context.
+// The file is written to <MetricsFileName>.tmp then renamed, so that a reader never sees a partial file.
+//
+
+CHAR8   *mMetricsFileName = NULL;
+UINT32  mMetricsInterval = 10;
+
+CHAR8   *mMetricsProcessName;
+UINT64  mMetricsWriteTime;
+
+#ifdef _MSC_VER
+CRITICAL_SECTION      mMetricsLock;
+#else
+pthread_mutex_t       mMetricsLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+//
+// The process totals, and the snapshot of one SPDM context being added to them.
+//
+BOOLEAN               mMetricsRequesterStatsValid;
+SPDM_REQUESTER_STATS  mMetricsRequesterStats;
+SPDM_REQUESTER_STATS  mMetricsNewRequesterStats;
+BOOLEAN               mMetricsResponderStatsValid;
+SPDM_RESPONDER_STATS  mMetricsResponderStats;
+SPDM_RESPONDER_STATS  mMetricsNewResponderStats;
+BOOLEAN               mMetricsCryptoStatsValid;
+SPDM_CRYPTO_STATS     mMetricsCryptoStats;
+SPDM_CRYPTO_STATS     mMetricsNewCryptoStats;
+
+UINT64                mMetricsSessionStartedCount;
+UINT64                mMetricsSessionEstablishedCount;
+UINT64                mMetricsSessionEndedCount;
+
+///
+/// A counter of SPDM_REQUESTER_REQUEST_STATS or SPDM_RESPONDER_REQUEST_STATS, labelled by the request code.
+/// A time in 100ns units is published in seconds.
+///
+typedef struct {
+  CHAR8   *Name;
+  CHAR8   *Help;
+  UINTN   Offset;
+  UINTN   Size;
+  BOOLEAN IsTime;
+} METRICS_REQUEST_COUNTER;
+
+METRICS_REQUEST_COUNTER  mMetricsRequesterCounter[] = {
+  {"spdm_requester_requests",        "SPDM requests sent.",                     OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, RequestCount),  sizeof(UINT32), FALSE},
+  {"spdm_requester_responses",       "SPDM responses received.",                OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, ResponseCount), sizeof(UINT32), FALSE},
+  {"spdm_requester_request_bytes",   "Bytes of the SPDM requests sent.",        OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, RequestBytes),  sizeof(UINT64), FALSE},
+  {"spdm_requester_response_bytes",  "Bytes of the SPDM responses received.",   OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, ResponseBytes), sizeof(UINT64), FALSE},
+  {"spdm_requester_retries",         "SPDM requests sent again after BUSY.",    OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, RetryCount),    sizeof(UINT32), FALSE},
+  {"spdm_requester_failures",        "SPDM requests failed in the transport.",  OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, FailureCount),  sizeof(UINT32), FALSE},
+};
+
+METRICS_REQUEST_COUNTER  mMetricsResponderCounter[] = {
+  {"spdm_responder_requests",            "SPDM requests processed.",                       OFFSET_OF(SPDM_RESPONDER_REQUEST_STATS, RequestCount),          sizeof(UINT32), FALSE},
+  {"spdm_responder_request_bytes",       "Bytes of the SPDM requests processed.",          OFFSET_OF(SPDM_RESPONDER_REQUEST_STATS, RequestBytes),          sizeof(UINT64), FALSE},
+  {"spdm_responder_response_bytes",      "Bytes of the SPDM responses built.",             OFFSET_OF(SPDM_RESPONDER_REQUEST_STATS, ResponseBytes),         sizeof(UINT64), FALSE},
+  {"spdm_responder_response_not_ready",  "ERROR(ResponseNotReady) responses.",             OFFSET_OF(SPDM_RESPONDER_REQUEST_STATS, ResponseNotReadyCount), sizeof(UINT32), FALSE},
+  {"spdm_responder_crypto_seconds",      "Time in the DHE, verification and key schedule.", OFFSET_OF(SPDM_RESPONDER_REQUEST_STATS, CryptoTime),           sizeof(UINT64), TRUE},
+};
+
+CHAR8  *mMetricsCryptoOperationName[SpdmCryptoOperationMax] = {
+  "hash",
+  "hmac",
+  "hkdf_expand",
+  "asym_sign",
+  "asym_verify",
+  "dhe_generate_key",
+  "dhe_compute_key",
+  "aead_encrypt",
+  "aead_decrypt",
+};
+
+/**
+  Acquire the lock protecting the process totals and the metrics file.
+**/
+VOID
+AcquireMetricsLock (
+  VOID
+  )
+{
+#ifdef _MSC_VER
+  EnterCriticalSection (&mMetricsLock);
+#else
+  pthread_mutex_lock (&mMetricsLock);
+#endif
+}
+
+/**
+  Release the lock protecting the process totals and the metrics file.
+**/
+VOID
+ReleaseMetricsLock (
+  VOID
+  )
+{
+#ifdef _MSC_VER
+  LeaveCriticalSection (&mMetricsLock);
+#else
+  pthread_mutex_unlock (&mMetricsLock);
+#endif
+}
+
+/**
+  Return the time used by the SPDM library statistics, in 100ns units.
+**/
+UINT64
+EFIAPI
+MetricsGetTime (
+  IN VOID             *SpdmContext
+  )
+{
+  return TraceGetTime () / 100;
+}
+
+/**
+  Return the value of a counter of the statistics of one request code.
+**/
+UINT64
+MetricsGetCounter (
+  IN VOID                     *RequestStats,
+  IN METRICS_REQUEST_COUNTER  *Counter
+  )
+{
+  UINT8   *Field;
+
+  Field = (UINT8 *)RequestStats + Counter->Offset;
+  if (Counter->Size == sizeof(UINT32)) {
+    return *(UINT32 *)Field;
+  }
+  return *(UINT64 *)Field;
+}
+
+/**
+  Get the label value of an SPDM request code.
+**/
+VOID
+MetricsGetCodeName (
+  IN  UINTN            Index,
+  OUT CHAR8            *Name,
+  IN  UINTN            NameSize
+  )
+{
+  CHAR8   *KnownName;
+
+  KnownName = TraceGetRequestCodeName ((UINT8)(Index + 0x80));
+  if (KnownName != NULL) {
+    snprintf (Name, NameSize, "%s", KnownName);
+  } else {
+    snprintf (Name, NameSize, "0x%02X", (UINT32)(Index + 0x80));
+  }
+}
+
+/**
+  Get the label value of an index of the ErrorCount of the request statistics.
+**/
+VOID
+MetricsGetErrorName (
+  IN  UINTN            Index,
+  OUT CHAR8            *Name,
+  IN  UINTN            NameSize
+  )
+{
+  if (Index == 0) {
+    snprintf (Name, NameSize, "other");
+  } else if (Index < 0xD) {
+    snprintf (Name, NameSize, "0x%02X", (UINT32)Index);
+  } else {
+    snprintf (Name, NameSize, "0x%02X", (UINT32)(Index - 0xD + SPDM_ERROR_CODE_MAJOR_VERSION_MISMATCH));
+  }
+}
+
+/**
+  Add the statistics of one SPDM context to the process totals, and reset them in the context.
+  The caller holds the metrics lock.
+**/
+VOID
+MetricsAddContextStats (
+  IN VOID             *SpdmContext
+  )
+{
+  SPDM_DATA_PARAMETER            Parameter;
+  UINTN                          DataSize;
+  UINTN                          Index;
+  UINTN                          Bucket;
+  SPDM_REQUESTER_REQUEST_STATS   *Requester;
+  SPDM_REQUESTER_REQUEST_STATS   *NewRequester;
+  SPDM_RESPONDER_REQUEST_STATS   *Responder;
+  SPDM_RESPONDER_REQUEST_STATS   *NewResponder;
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+
+  DataSize = sizeof(mMetricsNewRequesterStats);
+  if (!RETURN_ERROR(SpdmGetData (SpdmContext, SpdmDataRequesterStats, &Parameter, &mMetricsNewRequesterStats, &DataSize))) {
+    mMetricsRequesterStatsValid = TRUE;
+    for (Index = 0; Index < SPDM_REQUESTER_STATS_REQUEST_CODE_COUNT; Index++) {
+      Requester = &mMetricsRequesterStats.Request[Index];
+      NewRequester = &mMetricsNewRequesterStats.Request[Index];
+      if ((NewRequester->RequestCount == 0) && (NewRequester->FailureCount == 0)) {
+        continue;
+      }
+      Requester->RequestCount += NewRequester->RequestCount;
+      Requester->ResponseCount += NewRequester->ResponseCount;
+      Requester->RequestBytes += NewRequester->RequestBytes;
+      Requester->ResponseBytes += NewRequester->ResponseBytes;
+      Requester->RetryCount += NewRequester->RetryCount;
+      Requester->FailureCount += NewRequester->FailureCount;
+      for (Bucket = 0; Bucket < SPDM_REQUESTER_STATS_ERROR_CODE_COUNT; Bucket++) {
+        Requester->ErrorCount[Bucket] += NewRequester->ErrorCount[Bucket];
+      }
+      Requester->TransportTime += NewRequester->TransportTime;
+      Requester->LocalTime += NewRequester->LocalTime;
+      for (Bucket = 0; Bucket < SPDM_REQUESTER_STATS_LATENCY_BUCKET_COUNT; Bucket++) {
+        Requester->TransportLatency[Bucket] += NewRequester->TransportLatency[Bucket];
+        Requester->LocalLatency[Bucket] += NewRequester->LocalLatency[Bucket];
+      }
+    }
+    ZeroMem (&mMetricsNewRequesterStats, sizeof(mMetricsNewRequesterStats));
+    SpdmSetData (SpdmContext, SpdmDataRequesterStats, &Parameter, &mMetricsNewRequesterStats, sizeof(mMetricsNewRequesterStats));
+  }
+
+  DataSize = sizeof(mMetricsNewResponderStats);
+  if (!RETURN_ERROR(SpdmGetData (SpdmContext, SpdmDataResponderStats, &Parameter, &mMetricsNewResponderStats, &DataSize))) {
+    mMetricsResponderStatsValid = TRUE;
+    for (Index = 0; Index < SPDM_RESPONDER_STATS_REQUEST_CODE_COUNT; Index++) {
+      Responder = &mMetricsResponderStats.Request[Index];
+      NewResponder = &mMetricsNewResponderStats.Request[Index];
+      if (NewResponder->RequestCount == 0) {
+        continue;
+      }
+      Responder->RequestCount += NewResponder->RequestCount;
+      Responder->RequestBytes += NewResponder->RequestBytes;
+      Responder->ResponseBytes += NewResponder->ResponseBytes;
+      for (Bucket = 0; Bucket < SPDM_RESPONDER_STATS_ERROR_CODE_COUNT; Bucket++) {
+        Responder->ErrorCount[Bucket] += NewResponder->ErrorCount[Bucket];
+      }
+      Responder->ResponseNotReadyCount += NewResponder->ResponseNotReadyCount;
+      Responder->ProcessingTime += NewResponder->ProcessingTime;
+      Responder->CryptoTime += NewResponder->CryptoTime;
+      Responder->CallbackTime += NewResponder->CallbackTime;
+      for (Bucket = 0; Bucket < SPDM_RESPONDER_STATS_LATENCY_BUCKET_COUNT; Bucket++) {
+        Responder->ProcessingLatency[Bucket] += NewResponder->ProcessingLatency[Bucket];
+        Responder->CallbackLatency[Bucket] += NewResponder->CallbackLatency[Bucket];
+      }
+    }
+    ZeroMem (&mMetricsNewResponderStats, sizeof(mMetricsNewResponderStats));
+    SpdmSetData (SpdmContext, SpdmDataResponderStats, &Parameter, &mMetricsNewResponderStats, sizeof(mMetricsNewResponderStats));
+  }
+
+  DataSize = sizeof(mMetricsNewCryptoStats);
+  if (!RETURN_ERROR(SpdmGetData (SpdmContext, SpdmDataCryptoStats, &Parameter, &mMetricsNewCryptoStats, &DataSize))) {
+    mMetricsCryptoStatsValid = TRUE;
+    for (Index = 0; Index < SpdmCryptoOperationMax; Index++) {
+      mMetricsCryptoStats.Operation[Index].Count += mMetricsNewCryptoStats.Operation[Index].Count;
+      mMetricsCryptoStats.Operation[Index].Bytes += mMetricsNewCryptoStats.Operation[Index].Bytes;
+      mMetricsCryptoStats.Operation[Index].Cycles += mMetricsNewCryptoStats.Operation[Index].Cycles;
+    }
+    ZeroMem (&mMetricsNewCryptoStats, sizeof(mMetricsNewCryptoStats));
+    SpdmSetData (SpdmContext, SpdmDataCryptoStats, &Parameter, &mMetricsNewCryptoStats, sizeof(mMetricsNewCryptoStats));
+  }
+}
+
+/**
+  Write the counter families of the request statistics, one sample per request code with requests.
+**/
+VOID
+MetricsWriteRequestCounters (
+  IN FILE                     *File,
+  IN METRICS_REQUEST_COUNTER  *Counter,
+  IN UINTN                    CounterCount,
+  IN VOID                     *Stats,
+  IN UINTN                    StatsSize,
+  IN UINTN                    CodeCount
+  )
+{
+  UINTN   Index;
+  UINTN   CounterIndex;
+  VOID    *RequestStats;
+  UINT64  Value;
+  CHAR8   CodeName[sizeof("DELIVER_ENCAPSULATED_RESPONSE")];
+
+  for (CounterIndex = 0; CounterIndex < CounterCount; CounterIndex++) {
+    fprintf (File, "# TYPE %s counter\n", Counter[CounterIndex].Name);
+    if (Counter[CounterIndex].IsTime) {
+      fprintf (File, "# UNIT %s seconds\n", Counter[CounterIndex].Name);
+    }
+    fprintf (File, "# HELP %s %s\n", Counter[CounterIndex].Name, Counter[CounterIndex].Help);
+    for (Index = 0; Index < CodeCount; Index++) {
+      RequestStats = (UINT8 *)Stats + StatsSize * Index;
+      //
+      // RequestCount is the first field of the request statistics.
+      //
+      if ((*(UINT32 *)RequestStats == 0) && (MetricsGetCounter (RequestStats, &Counter[CounterIndex]) == 0)) {
+        continue;
+      }
+      MetricsGetCodeName (Index, CodeName, sizeof(CodeName));
+      Value = MetricsGetCounter (RequestStats, &Counter[CounterIndex]);
+      if (Counter[CounterIndex].IsTime) {
+        fprintf (File, "%s_total{code=\"%s\"} %.7f\n", Counter[CounterIndex].Name, CodeName, (double)Value / 10000000.0);
+      } else {
+        fprintf (File, "%s_total{code=\"%s\"} %llu\n", Counter[CounterIndex].Name, CodeName, (unsigned long long)Value);
+      }
+    }
+  }
+}
+
+/**
+  Write the ERROR responses of the request statistics, by request code and error code.
+**/
+VOID
+MetricsWriteErrorCounters (
+  IN FILE             *File,
+  IN CHAR8            *Name,
+  IN CHAR8            *Help,
+  IN VOID             *Stats,
+  IN UINTN            StatsSize,
+  IN UINTN            ErrorCountOffset,
+  IN UINTN            CodeCount
+  )
+{
+  UINTN   Index;
+  UINTN   ErrorIndex;
+  UINT32  *ErrorCount;
+  CHAR8   CodeName[sizeof("DELIVER_ENCAPSULATED_RESPONSE")];
+  CHAR8   ErrorName[sizeof("other")];
+
+  fprintf (File, "# TYPE %s counter\n", Name);
+  fprintf (File, "# HELP %s %s\n", Name, Help);
+  for (Index = 0; Index < CodeCount; Index++) {
+    ErrorCount = (UINT32 *)((UINT8 *)Stats + StatsSize * Index + ErrorCountOffset);
+    for (ErrorIndex = 0; ErrorIndex < SPDM_REQUESTER_STATS_ERROR_CODE_COUNT; ErrorIndex++) {
+      if (ErrorCount[ErrorIndex] == 0) {
+        continue;
+      }
+      MetricsGetCodeName (Index, CodeName, sizeof(CodeName));
+      MetricsGetErrorName (ErrorIndex, ErrorName, sizeof(ErrorName));
+      fprintf (File, "%s_total{code=\"%s\",error=\"%s\"} %u\n", Name, CodeName, ErrorName, ErrorCount[ErrorIndex]);
+    }
+  }
+}
+
+/**
+  Write a latency histogram family of the request statistics, one histogram per request code with requests.
+
+  Bucket N of the statistics counts the latencies from 4^N to 4^(N+1) microseconds, so its upper bound is 4^(N+1) microseconds.
+  The first bucket also counts the shorter latencies, and the last bucket the longer ones.
+**/
+VOID
+MetricsWriteLatencyHistogram (
+  IN FILE             *File,
+  IN CHAR8            *Name,
+  IN CHAR8            *Help,
+  IN VOID             *Stats,
+  IN UINTN            StatsSize,
+  IN UINTN            LatencyOffset,
+  IN UINTN            TimeOffset,
+  IN UINTN            CodeCount
+  )
+{
+  UINTN   Index;
+  UINTN   Bucket;
+  UINT8   *RequestStats;
+  UINT32  *Latency;
+  UINT64  Count;
+  CHAR8   CodeName[sizeof("DELIVER_ENCAPSULATED_RESPONSE")];
+
+  fprintf (File, "# TYPE %s histogram\n", Name);
+  fprintf (File, "# UNIT %s seconds\n", Name);
+  fprintf (File, "# HELP %s %s\n", Name, Help);
+  for (Index = 0; Index < CodeCount; Index++) {
+    RequestStats = (UINT8 *)Stats + StatsSize * Index;
+    if (*(UINT32 *)RequestStats == 0) {
+      continue;
+    }
+    MetricsGetCodeName (Index, CodeName, sizeof(CodeName));
+    Latency = (UINT32 *)(RequestStats + LatencyOffset);
+    Count = 0;
+    for (Bucket = 0; Bucket < SPDM_REQUESTER_STATS_LATENCY_BUCKET_COUNT; Bucket++) {
+      Count += Latency[Bucket];
+      if (Bucket == SPDM_REQUESTER_STATS_LATENCY_BUCKET_COUNT - 1) {
+        fprintf (File, "%s_bucket{code=\"%s\",le=\"+Inf\"} %llu\n", Name, CodeName, (unsigned long long)Count);
+      } else {
+        fprintf (File, "%s_bucket{code=\"%s\",le=\"%.6f\"} %llu\n", Name, CodeName,
+          (double)(1ull << (2 * Bucket + 2)) / 1000000.0, (unsigned long long)Count);
+      }
+    }
+    fprintf (File, "%s_count{code=\"%s\"} %llu\n", Name, CodeName, (unsigned long long)Count);
+    fprintf (File, "%s_sum{code=\"%s\"} %.7f\n", Name, CodeName, (double)*(UINT64 *)(RequestStats + TimeOffset) / 10000000.0);
+  }
+}
+
+/**
+  Write the process totals to the metrics file. The caller holds the metrics lock.
+**/
+VOID
+MetricsWriteFile (
+  VOID
+  )
+{
+  FILE                     *File;
+  CHAR8                    TempFileName[512];
+  UINTN                    Index;
+  SPDM_DHE_KEY_POOL_STATS  PoolStats;
+
+  snprintf (TempFileName, sizeof(TempFileName), "%s.tmp", mMetricsFileName);
+  if ((File = fopen (TempFileName, "w")) == NULL) {
+    printf ("!!!Unable to write metrics file %s!!!\n", TempFileName);
+    return;
+  }
+
+  fprintf (File, "# TYPE spdm_emu info\n");
+  fprintf (File, "# HELP spdm_emu The SPDM emulator publishing the metrics.\n");
+  fprintf (File, "spdm_emu_info{program=\"%s\"} 1\n", mMetricsProcessName);
+
+  if (mMetricsRequesterStatsValid) {
+    MetricsWriteRequestCounters (File, mMetricsRequesterCounter, ARRAY_SIZE(mMetricsRequesterCounter),
+      mMetricsRequesterStats.Request, sizeof(SPDM_REQUESTER_REQUEST_STATS), SPDM_REQUESTER_STATS_REQUEST_CODE_COUNT);
+    MetricsWriteErrorCounters (File, "spdm_requester_errors", "SPDM ERROR responses received.",
+      mMetricsRequesterStats.Request, sizeof(SPDM_REQUESTER_REQUEST_STATS),
+      OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, ErrorCount), SPDM_REQUESTER_STATS_REQUEST_CODE_COUNT);
+    MetricsWriteLatencyHistogram (File, "spdm_requester_transport_latency_seconds",
+      "Time from the SPDM request sent to its response received.",
+      mMetricsRequesterStats.Request, sizeof(SPDM_REQUESTER_REQUEST_STATS),
+      OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, TransportLatency), OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, TransportTime),
+      SPDM_REQUESTER_STATS_REQUEST_CODE_COUNT);
+    MetricsWriteLatencyHistogram (File, "spdm_requester_local_latency_seconds",
+      "Time from the previous SPDM response received to the SPDM request sent.",
+      mMetricsRequesterStats.Request, sizeof(SPDM_REQUESTER_REQUEST_STATS),
+      OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, LocalLatency), OFFSET_OF(SPDM_REQUESTER_REQUEST_STATS, LocalTime),
+      SPDM_REQUESTER_STATS_REQUEST_CODE_COUNT);
+  }
+
+  if (mMetricsResponderStatsValid) {
+    MetricsWriteRequestCounters (File, mMetricsResponderCounter, ARRAY_SIZE(mMetricsResponderCounter),
+      mMetricsResponderStats.Request, sizeof(SPDM_RESPONDER_REQUEST_STATS), SPDM_RESPONDER_STATS_REQUEST_CODE_COUNT);
+    MetricsWriteErrorCounters (File, "spdm_responder_errors", "SPDM ERROR responses built.",
+      mMetricsResponderStats.Request, sizeof(SPDM_RESPONDER_REQUEST_STATS),
+      OFFSET_OF(SPDM_RESPONDER_REQUEST_STATS, ErrorCount), SPDM_RESPONDER_STATS_REQUEST_CODE_COUNT);
+    MetricsWriteLatencyHistogram (File, "spdm_responder_processing_latency_seconds",
+      "Time from the SPDM request decoded to its response built.",
+      mMetricsResponderStats.Request, sizeof(SPDM_RESPONDER_REQUEST_STATS),
+      OFFSET_OF(SPDM_RESPONDER_REQUEST_STATS, ProcessingLatency), OFFSET_OF(SPDM_RESPONDER_REQUEST_STATS, ProcessingTime),
+      SPDM_RESPONDER_STATS_REQUEST_CODE_COUNT);
+    MetricsWriteLatencyHistogram (File, "spdm_responder_callback_latency_seconds",
+      "Time in the measurement collection and the signing of the SPDM request.",
+      mMetricsResponderStats.Request, sizeof(SPDM_RESPONDER_REQUEST_STATS),
+      OFFSET_OF(SPDM_RESPONDER_REQUEST_STATS, CallbackLatency), OFFSET_OF(SPDM_RESPONDER_REQUEST_STATS, CallbackTime),
+      SPDM_RESPONDER_STATS_REQUEST_CODE_COUNT);
+  }
+
+  if (mMetricsCryptoStatsValid) {
+    fprintf (File, "# TYPE spdm_crypto_operations counter\n");
+    fprintf (File, "# HELP spdm_crypto_operations Crypto operations.\n");
+    for (Index = 0; Index < SpdmCryptoOperationMax; Index++) {
+      fprintf (File, "spdm_crypto_operations_total{op=\"%s\"} %llu\n",
+        mMetricsCryptoOperationName[Index], (unsigned long long)mMetricsCryptoStats.Operation[Index].Count);
+    }
+    fprintf (File, "# TYPE spdm_crypto_bytes counter\n");
+    fprintf (File, "# HELP spdm_crypto_bytes Bytes given to the crypto operations.\n");
+    for (Index = 0; Index < SpdmCryptoOperationMax; Index++) {
+      fprintf (File, "spdm_crypto_bytes_total{op=\"%s\"} %llu\n",
+        mMetricsCryptoOperationName[Index], (unsigned long long)mMetricsCryptoStats.Operation[Index].Bytes);
+    }
+    fprintf (File, "# TYPE spdm_crypto_cycles counter\n");
+    fprintf (File, "# HELP spdm_crypto_cycles Cycles spent in the crypto operations, if a cycle function is registered.\n");
+    for (Index = 0; Index < SpdmCryptoOperationMax; Index++) {
+      fprintf (File, "spdm_crypto_cycles_total{op=\"%s\"} %llu\n",
+        mMetricsCryptoOperationName[Index], (unsigned long long)mMetricsCryptoStats.Operation[Index].Cycles);
+    }
+  }
+
+  fprintf (File, "# TYPE spdm_sessions_started counter\n");
+  fprintf (File, "# HELP spdm_sessions_started SPDM sessions started.\n");
+  fprintf (File, "spdm_sessions_started_total %llu\n", (unsigned long long)mMetricsSessionStartedCount);
+  fprintf (File, "# TYPE spdm_sessions_established counter\n");
+  fprintf (File, "# HELP spdm_sessions_established SPDM sessions established.\n");
+  fprintf (File, "spdm_sessions_established_total %llu\n", (unsigned long long)mMetricsSessionEstablishedCount);
+  fprintf (File, "# TYPE spdm_sessions_ended counter\n");
+  fprintf (File, "# HELP spdm_sessions_ended SPDM sessions ended, or failed in the handshake.\n");
+  fprintf (File, "spdm_sessions_ended_total %llu\n", (unsigned long long)mMetricsSessionEndedCount);
+  fprintf (File, "# TYPE spdm_sessions_active gauge\n");
+  fprintf (File, "# HELP spdm_sessions_active SPDM sessions started and not ended.\n");
+  fprintf (File, "spdm_sessions_active %llu\n", (unsigned long long)(mMetricsSessionStartedCount - mMetricsSessionEndedCount));
+
+  if (mDheKeyPool != NULL) {
+    SpdmSecuredMessageDheKeyPoolGetStats (mDheKeyPool, &PoolStats);
+    fprintf (File, "# TYPE spdm_dhe_key_pool_entries gauge\n");
+    fprintf (File, "# HELP spdm_dhe_key_pool_entries DHE key pairs the pool can hold.\n");
+    fprintf (File, "spdm_dhe_key_pool_entries %llu\n", (unsigned long long)PoolStats.EntryCount);
+    fprintf (File, "# TYPE spdm_dhe_key_pool_ready gauge\n");
+    fprintf (File, "# HELP spdm_dhe_key_pool_ready DHE key pairs generated and not taken yet.\n");
+    fprintf (File, "spdm_dhe_key_pool_ready %llu\n", (unsigned long long)PoolStats.ReadyCount);
+    fprintf (File, "# TYPE spdm_dhe_key_pool_hits counter\n");
+    fprintf (File, "# HELP spdm_dhe_key_pool_hits DHE key pairs taken from the pool.\n");
+    fprintf (File, "spdm_dhe_key_pool_hits_total %llu\n", (unsigned long long)PoolStats.HitCount);
+    fprintf (File, "# TYPE spdm_dhe_key_pool_misses counter\n");
+    fprintf (File, "# HELP spdm_dhe_key_pool_misses DHE key pairs generated because the pool had none.\n");
+    fprintf (File, "spdm_dhe_key_pool_misses_total %llu\n", (unsigned long long)PoolStats.MissCount);
+  }
+
+  fprintf (File, "# EOF\n");
+  fclose (File);
+
+#ifdef _MSC_VER
+  remove (mMetricsFileName);
+#endif
+  if (rename (TempFileName, mMetricsFileName) != 0) {
+    printf ("!!!Unable to write metrics file %s!!!\n", mMetricsFileName);
+  }
+}
+
+BOOLEAN
+OpenMetricsFile (
+  IN CHAR8            *MetricsFileName,
+  IN CHAR8            *ProcessName
+  )
+{
+  FILE    *File;
+
+  if ((File = fopen (MetricsFileName, "a")) == NULL) {
+    printf ("!!!Unable to open metrics file %s!!!\n", MetricsFileName);
+    return FALSE;
+  }
+  fclose (File);
+#ifdef _MSC_VER
+  InitializeCriticalSection (&mMetricsLock);
+#endif
+  mMetricsProcessName = ProcessName;
+  mMetricsWriteTime = TraceGetTime ();
+  MetricsWriteFile ();
+  return TRUE;
+}
+
+VOID
+CloseMetricsFile (
+  VOID
+  )
+{
+  if (mMetricsFileName != NULL) {
+    AcquireMetricsLock ();
+    MetricsWriteFile ();
+    ReleaseMetricsLock ();
+  }
+}
+
+/**
+  Add the statistics of an SPDM context to the process totals, and write the metrics file if it is due.
+
+  It must be called by the thread running the SPDM context, between two messages.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  CollectTime                  The time the statistics of the SPDM context were last added, in nanoseconds.
+                                       They are only added again once the metrics interval passed.
+                                       NULL to add them at once, when the connection ends.
+**/
+VOID
+MetricsCollect (
+  IN VOID             *SpdmContext,
+  IN OUT UINT64       *CollectTime OPTIONAL
+  )
+{
+  UINT64  Now;
+  UINT64  Interval;
+
+  if (mMetricsFileName == NULL) {
+    return;
+  }
+  Now = TraceGetTime ();
+  Interval = (UINT64)mMetricsInterval * 1000000000ull;
+  if (CollectTime != NULL) {
+    if ((*CollectTime != 0) && (Now - *CollectTime < Interval)) {
+      return;
+    }
+    *CollectTime = Now;
+  }
+
+  AcquireMetricsLock ();
+  MetricsAddContextStats (SpdmContext);
+  if (Now - mMetricsWriteTime >= Interval) {
+    mMetricsWriteTime = Now;
+    MetricsWriteFile ();
+  }
+  ReleaseMetricsLock ();
+}
+
+/**
+  Count a change of the state of an SPDM session.
+
+  @param  SessionState                 SpdmSessionStateHandshaking when a session is started,
+                                       SpdmSessionStateEstablished when it is established,
+                                       SpdmSessionStateNotStarted when it is ended, or fails in the handshake.
+**/
+VOID
+MetricsCountSession (
+  IN SPDM_SESSION_STATE  SessionState
+  )
+{
+  if (mMetricsFileName == NULL) {
+    return;
+  }
+  AcquireMetricsLock ();
+  switch (SessionState) {
+  case SpdmSessionStateHandshaking:
+    mMetricsSessionStartedCount++;
+    break;
+  case SpdmSessionStateEstablished:
+    mMetricsSessionEstablishedCount++;
+    break;
+  case SpdmSessionStateNotStarted:
+    mMetricsSessionEndedCount++;
+    break;
+  default:
+    break;
+  }
+  ReleaseMetricsLock ();
+}
@@ -13,41 +13,21 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Base.h>
 #include <IndustryStandard/Spdm.h>
 
-#define SPDM_NEGOTIATED_STATE_STRUCT_SIGNATURE  SIGNATURE_32('S', 'P', 'D', 'M')
-#define SPDM_NEGOTIATED_STATE_STRUCT_VERSION  1
-
-#pragma pack(1)
-typedef struct {
-  UINT32               Signature;
-  UINT32               Version;
-  UINT8                SpdmVersion;
-  UINT8                RequesterCapCTExponent;
-  UINT32               RequesterCapFlags;
-  UINT8                ResponderCapCTExponent;
-  UINT32               ResponderCapFlags;
-  UINT8                MeasurementSpec;
-  UINT32               MeasurementHashAlgo;
-  UINT32               BaseAsymAlgo;
-  UINT32               BaseHashAlgo;
-  UINT16               DHENamedGroup;
-  UINT16               AEADCipherSuite;
-  UINT16               ReqBaseAsymAlg;
-  UINT16               KeySchedule;
-} SPDM_NEGOTIATED_STATE_STRUCT;
-#pragma pack()
-
 /**
   Load the NegotiatedState from NV storage to an SPDM context.
+
+  The state is imported by SpdmImportNegotiatedState, so it must be called after the local settings are set.
 */
 RETURN_STATUS
 EFIAPI
 SpdmLoadNegotiatedState (
-  IN VOID                         *SpdmContext,
-  IN BOOLEAN                      IsRequester
+  IN VOID                         *SpdmContext
   );
 
 /**
   Save the NegotiatedState to NV storage from an SPDM context.
+
+  The state is exported by SpdmExportNegotiatedState. It is cleared if the responder has no CACHE_CAP.
 */
 RETURN_STATUS
 EFIAPI
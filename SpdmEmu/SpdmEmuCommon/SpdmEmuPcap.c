@@ -11,9 +11,334 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <IndustryStandard/Pcap.h>
 #include <IndustryStandard/LinkTypeEx.h>
 
+#ifndef _MSC_VER
+#include <sys/stat.h>
+#endif
+
 #define PCAP_PACKET_MAX_SIZE  0x00010000
 
-FILE   *mPcapFile;
+FILE     *mPcapFile;
+//
+// If the pcap file is a FIFO, for example read by SpdmDump as a live capture,
+// each packet is flushed once it is written.
+//
+BOOLEAN  mPcapFileIsFifo;
+//
+// If the pcap file name ends with .pcapng, the file has one section with one interface,
+// and each packet is an enhanced packet block.
+//
+BOOLEAN  mPcapFileIsNg;
+
+/*
+  PCAP_MODE_SYNC,
+  PCAP_MODE_ASYNC
+*/
+UINT32   mPcapMode = PCAP_MODE_SYNC;
+
+//
+// A piece of a packet record, written to the pcap file after the previous piece.
+//
+typedef struct {
+  VOID     *Data;
+  UINTN    Size;
+} PCAP_RECORD_PIECE;
+
+#define PCAP_RECORD_PIECE_COUNT  5
+
+#ifndef _MSC_VER
+
+//
+// In PCAP_MODE_ASYNC, the threads sending and receiving the messages only copy each packet record
+// to a ring, and a writer thread writes the records to the pcap file with a large stdio buffer,
+// so the capture adds no file IO to the message path.
+//
+// The ring has several producers and one consumer. A producer reserves the space of its record
+// by moving Reserve with a compare-and-swap, writes the record, then publishes it by storing
+// the position of the record plus one in its header, so that the zeroed ring holds no record.
+// The consumer writes the records in order, as soon as the header of the record at Tail holds
+// Tail plus one, then moves Tail.
+// The record is dropped if the ring is full. A record does not wrap around the end of the ring:
+// a padding record fills the end of the ring instead.
+//
+#define PCAP_RING_SIZE          0x400000
+#define PCAP_RING_ALIGNMENT     sizeof(PCAP_RING_RECORD_HEADER)
+#define PCAP_WRITE_BUFFER_SIZE  0x100000
+#define PCAP_WRITER_IDLE_US     1000
+
+//
+// Size is the size of the record with its header. The next record is at Size aligned to PCAP_RING_ALIGNMENT.
+//
+typedef struct {
+  UINT64  Sequence;
+  UINT32  Size;
+  UINT32  IsPadding;
+} PCAP_RING_RECORD_HEADER;
+
+typedef struct {
+  //
+  // Written by the producers only.
+  //
+  UINT64   Reserve;
+  UINT64   DropCount;
+  UINT8    Reserved0[48];
+  //
+  // Written by the consumer only.
+  //
+  UINT64   Tail;
+  UINT8    Reserved1[56];
+  UINT8    Data[PCAP_RING_SIZE];
+} PCAP_RING;
+
+PCAP_RING  mPcapRing;
+BOOLEAN    mPcapRingActive;
+BOOLEAN    mPcapWriterStop;
+pthread_t  mPcapWriterThread;
+
+/**
+  Copy a packet record to the ring, for the writer thread.
+
+  @param  Pieces                       The pieces of the packet record.
+  @param  PieceCount                   The number of pieces.
+**/
+VOID
+PcapRingAppend (
+  IN PCAP_RECORD_PIECE  *Pieces,
+  IN UINTN              PieceCount
+  )
+{
+  PCAP_RING_RECORD_HEADER  *RecordHeader;
+  UINT64                   Reserve;
+  UINTN                    Offset;
+  UINTN                    PaddingSize;
+  UINTN                    RecordSize;
+  UINTN                    Index;
+  UINT8                    *Buffer;
+
+  RecordSize = sizeof(PCAP_RING_RECORD_HEADER);
+  for (Index = 0; Index < PieceCount; Index++) {
+    RecordSize += Pieces[Index].Size;
+  }
+  RecordSize = (RecordSize + PCAP_RING_ALIGNMENT - 1) & ~(UINTN)(PCAP_RING_ALIGNMENT - 1);
+
+  Reserve = __atomic_load_n (&mPcapRing.Reserve, __ATOMIC_ACQUIRE);
+  do {
+    Offset = (UINTN)(Reserve % PCAP_RING_SIZE);
+    PaddingSize = (Offset + RecordSize > PCAP_RING_SIZE) ? PCAP_RING_SIZE - Offset : 0;
+    if (Reserve + PaddingSize + RecordSize - __atomic_load_n (&mPcapRing.Tail, __ATOMIC_ACQUIRE) > PCAP_RING_SIZE) {
+      __atomic_fetch_add (&mPcapRing.DropCount, 1, __ATOMIC_RELAXED);
+      return ;
+    }
+  } while (!__atomic_compare_exchange_n (&mPcapRing.Reserve, &Reserve, Reserve + PaddingSize + RecordSize,
+                                         FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+  if (PaddingSize != 0) {
+    RecordHeader = (VOID *)(mPcapRing.Data + Offset);
+    RecordHeader->Size = (UINT32)PaddingSize;
+    RecordHeader->IsPadding = TRUE;
+    __atomic_store_n (&RecordHeader->Sequence, Reserve + 1, __ATOMIC_RELEASE);
+    Reserve += PaddingSize;
+    Offset = 0;
+  }
+
+  RecordHeader = (VOID *)(mPcapRing.Data + Offset);
+  RecordHeader->IsPadding = FALSE;
+  Buffer = (UINT8 *)(RecordHeader + 1);
+  for (Index = 0; Index < PieceCount; Index++) {
+    if (Pieces[Index].Size != 0) {
+      CopyMem (Buffer, Pieces[Index].Data, Pieces[Index].Size);
+      Buffer += Pieces[Index].Size;
+    }
+  }
+  RecordHeader->Size = (UINT32)(Buffer - (UINT8 *)RecordHeader);
+  __atomic_store_n (&RecordHeader->Sequence, Reserve + 1, __ATOMIC_RELEASE);
+}
+
+/**
+  Write the records of the ring to the pcap file, until the pcap file is closed.
+**/
+VOID *
+PcapWriterThread (
+  IN VOID  *Context
+  )
+{
+  PCAP_RING_RECORD_HEADER  *RecordHeader;
+  UINT64                   Tail;
+  UINTN                    RecordSize;
+  BOOLEAN                  Written;
+  BOOLEAN                  WriteError;
+
+  Tail = 0;
+  Written = FALSE;
+  WriteError = FALSE;
+  while (TRUE) {
+    RecordHeader = (VOID *)(mPcapRing.Data + (UINTN)(Tail % PCAP_RING_SIZE));
+    if (__atomic_load_n (&RecordHeader->Sequence, __ATOMIC_ACQUIRE) == Tail + 1) {
+      if (RecordHeader->IsPadding) {
+        RecordSize = RecordHeader->Size;
+      } else {
+        RecordSize = (RecordHeader->Size + PCAP_RING_ALIGNMENT - 1) & ~(UINTN)(PCAP_RING_ALIGNMENT - 1);
+        if (!WriteError &&
+            (fwrite (RecordHeader + 1, 1, RecordHeader->Size - sizeof(PCAP_RING_RECORD_HEADER), mPcapFile) !=
+             RecordHeader->Size - sizeof(PCAP_RING_RECORD_HEADER))) {
+          printf ("!!!Write pcap file error!!!\n");
+          WriteError = TRUE;
+        }
+        Written = TRUE;
+      }
+      Tail += RecordSize;
+      __atomic_store_n (&mPcapRing.Tail, Tail, __ATOMIC_RELEASE);
+      continue;
+    }
+
+    //
+    // The ring is empty, or the record at Tail is still being written.
+    //
+    if (Written && !WriteError) {
+      fflush (mPcapFile);
+    }
+    Written = FALSE;
+    if (__atomic_load_n (&mPcapWriterStop, __ATOMIC_ACQUIRE) &&
+        (Tail == __atomic_load_n (&mPcapRing.Reserve, __ATOMIC_ACQUIRE))) {
+      break;
+    }
+    usleep (PCAP_WRITER_IDLE_US);
+  }
+  return NULL;
+}
+
+/**
+  Start the writer thread of the pcap file.
+
+  @retval TRUE   the writer thread is started.
+  @retval FALSE  the writer thread cannot be started.
+**/
+BOOLEAN
+PcapWriterStart (
+  VOID
+  )
+{
+  setvbuf (mPcapFile, NULL, _IOFBF, PCAP_WRITE_BUFFER_SIZE);
+  mPcapWriterStop = FALSE;
+  if (pthread_create (&mPcapWriterThread, NULL, PcapWriterThread, NULL) != 0) {
+    printf ("!!!Unable to create pcap writer thread!!!\n");
+    return FALSE;
+  }
+  __atomic_store_n (&mPcapRingActive, TRUE, __ATOMIC_RELEASE);
+  return TRUE;
+}
+
+/**
+  Stop the writer thread of the pcap file, once it has written all the records of the ring.
+**/
+VOID
+PcapWriterStop (
+  VOID
+  )
+{
+  if (!__atomic_exchange_n (&mPcapRingActive, FALSE, __ATOMIC_ACQ_REL)) {
+    return ;
+  }
+  __atomic_store_n (&mPcapWriterStop, TRUE, __ATOMIC_RELEASE);
+  pthread_join (mPcapWriterThread, NULL);
+  if (mPcapRing.DropCount != 0) {
+    printf ("pcap ring full - %lld packets dropped\n", (long long)mPcapRing.DropCount);
+  }
+}
+
+#else
+
+BOOLEAN  mPcapRingActive;
+
+VOID
+PcapRingAppend (
+  IN PCAP_RECORD_PIECE  *Pieces,
+  IN UINTN              PieceCount
+  )
+{
+}
+
+BOOLEAN
+PcapWriterStart (
+  VOID
+  )
+{
+  printf ("Async pcap writer is not supported\n");
+  return FALSE;
+}
+
+VOID
+PcapWriterStop (
+  VOID
+  )
+{
+}
+
+#endif
+
+/**
+  Write data to the pcap file. The pcap file is closed on error.
+
+  @param  Data                         A pointer to the data.
+  @param  Size                         Size in bytes of the data.
+
+  @retval TRUE   the data is written.
+  @retval FALSE  the data cannot be written, and the pcap file is closed.
+**/
+BOOLEAN
+WritePcapFileData (
+  IN VOID   *Data,
+  IN UINTN  Size
+  )
+{
+  if ((fwrite (Data, 1, Size, mPcapFile)) != Size) {
+    printf ("!!!Write pcap file error!!!\n");
+    ClosePcapPacketFile ();
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Write the section header block and the interface description block of a pcapng file.
+
+  @param  DataLinkType                 The data link type of the interface.
+
+  @retval TRUE   the blocks are written.
+  @retval FALSE  the blocks cannot be written, and the pcap file is closed.
+**/
+BOOLEAN
+WritePcapNgHeader (
+  IN UINT32  DataLinkType
+  )
+{
+  PCAPNG_SECTION_HEADER_BLOCK         SectionHeader;
+  PCAPNG_INTERFACE_DESCRIPTION_BLOCK  InterfaceDescription;
+  UINT32                              BlockTotalLength;
+
+  BlockTotalLength = sizeof(SectionHeader) + sizeof(UINT32);
+  SectionHeader.Header.BlockType = PCAPNG_BLOCK_TYPE_SECTION_HEADER;
+  SectionHeader.Header.BlockTotalLength = BlockTotalLength;
+  SectionHeader.ByteOrderMagic = PCAPNG_BYTE_ORDER_MAGIC;
+  SectionHeader.VersionMajor = PCAPNG_SECTION_HEADER_VERSION_MAJOR;
+  SectionHeader.VersionMinor = PCAPNG_SECTION_HEADER_VERSION_MINOR;
+  SectionHeader.SectionLength = -1;
+  if (!WritePcapFileData (&SectionHeader, sizeof(SectionHeader)) ||
+      !WritePcapFileData (&BlockTotalLength, sizeof(BlockTotalLength))) {
+    return FALSE;
+  }
+
+  BlockTotalLength = sizeof(InterfaceDescription) + sizeof(UINT32);
+  InterfaceDescription.Header.BlockType = PCAPNG_BLOCK_TYPE_INTERFACE_DESCRIPTION;
+  InterfaceDescription.Header.BlockTotalLength = BlockTotalLength;
+  InterfaceDescription.LinkType = (UINT16)DataLinkType;
+  InterfaceDescription.Reserved = 0;
+  InterfaceDescription.SnapLen = PCAP_PACKET_MAX_SIZE;
+  if (!WritePcapFileData (&InterfaceDescription, sizeof(InterfaceDescription)) ||
+      !WritePcapFileData (&BlockTotalLength, sizeof(BlockTotalLength))) {
+    return FALSE;
+  }
+  return TRUE;
+}
 
 BOOLEAN
 OpenPcapPacketFile (
@@ -21,10 +346,17 @@ OpenPcapPacketFile (
   )
 {
   PCAP_GLOBAL_HEADER  PcapGlobalHeader;
+  UINTN               NameLength;
+#ifndef _MSC_VER
+  struct stat         FileStat;
+#endif
 
   if (PcapFileName == NULL) {
     return FALSE;
   }
+  NameLength = strlen (PcapFileName);
+  mPcapFileIsNg = (BOOLEAN)((NameLength >= sizeof(".pcapng") - 1) &&
+                            (strcmp (PcapFileName + NameLength - (sizeof(".pcapng") - 1), ".pcapng") == 0));
 
   PcapGlobalHeader.MagicNumber  = PCAP_GLOBAL_HEADER_MAGIC;
   PcapGlobalHeader.VersionMajor = PCAP_GLOBAL_HEADER_VERSION_MAJOR;
@@ -44,13 +376,32 @@ OpenPcapPacketFile (
     printf ("!!!Unable to open pcap file %s!!!\n", PcapFileName);
     return FALSE;
   }
+  mPcapFileIsFifo = FALSE;
+#ifndef _MSC_VER
+  if ((fstat (fileno (mPcapFile), &FileStat) == 0) && S_ISFIFO (FileStat.st_mode)) {
+    mPcapFileIsFifo = TRUE;
+  }
+#endif
 
-  if ((fwrite (&PcapGlobalHeader, 1, sizeof(PcapGlobalHeader), mPcapFile)) != sizeof(PcapGlobalHeader)) {
-    printf ("!!!Write pcap file error!!!\n");
-    ClosePcapPacketFile ();
-    return FALSE;
+  if (mPcapFileIsNg) {
+    if (!WritePcapNgHeader (PcapGlobalHeader.Network)) {
+      return FALSE;
+    }
+  } else {
+    if (!WritePcapFileData (&PcapGlobalHeader, sizeof(PcapGlobalHeader))) {
+      return FALSE;
+    }
+  }
+  if (mPcapFileIsFifo) {
+    fflush (mPcapFile);
   }
 
+  if (mPcapMode == PCAP_MODE_ASYNC) {
+    if (!PcapWriterStart ()) {
+      ClosePcapPacketFile ();
+      return FALSE;
+    }
+  }
   return TRUE;
 }
 
@@ -59,6 +410,7 @@ ClosePcapPacketFile (
   VOID
   )
 {
+  PcapWriterStop ();
   if (mPcapFile != NULL) {
     fclose (mPcapFile);
     mPcapFile = NULL;
@@ -73,12 +425,19 @@ AppendPcapPacketData (
   IN UINTN   Size
   )
 {
-  PCAP_PACKET_HEADER  PcapPacketHeader;
-  UINTN               TotalSize;
+  PCAP_PACKET_HEADER            PcapPacketHeader;
+  PCAPNG_ENHANCED_PACKET_BLOCK  EnhancedPacket;
+  PCAP_RECORD_PIECE             Pieces[PCAP_RECORD_PIECE_COUNT];
+  UINTN                         PieceCount;
+  UINTN                         Index;
+  UINTN                         TotalSize;
+  UINT64                        Timestamp;
+  UINT32                        Padding;
+  UINT32                        PaddingSize;
 
   TotalSize = HeaderSize + Size;
 
-  if (mPcapFile != NULL) {
+  if (mPcapRingActive || (mPcapFile != NULL)) {
     time_t rawtime;
     time (&rawtime);
 
@@ -88,28 +447,57 @@ AppendPcapPacketData (
     PcapPacketHeader.InclLen = (UINT32)((TotalSize > PCAP_PACKET_MAX_SIZE) ? PCAP_PACKET_MAX_SIZE : TotalSize);
     PcapPacketHeader.OrigLen = (UINT32)TotalSize;
 
-    if ((fwrite (&PcapPacketHeader, 1, sizeof(PcapPacketHeader), mPcapFile)) != sizeof(PcapPacketHeader)) {
-      printf ("!!!Write pcap file error!!!\n");
-      ClosePcapPacketFile ();
-      return ;
+    //
+    // Only the captured length is written, the data after it is dropped.
+    //
+    if (HeaderSize > PcapPacketHeader.InclLen) {
+      HeaderSize = PcapPacketHeader.InclLen;
+    }
+    Size = PcapPacketHeader.InclLen - HeaderSize;
+
+    if (mPcapFileIsNg) {
+      PaddingSize = (UINT32)((4 - (PcapPacketHeader.InclLen & 0x3)) & 0x3);
+      Timestamp = (UINT64)rawtime * 1000000;
+      EnhancedPacket.Header.BlockType = PCAPNG_BLOCK_TYPE_ENHANCED_PACKET;
+      EnhancedPacket.Header.BlockTotalLength = sizeof(EnhancedPacket) + PcapPacketHeader.InclLen + PaddingSize + sizeof(UINT32);
+      EnhancedPacket.InterfaceId = 0;
+      EnhancedPacket.TimestampHigh = (UINT32)(Timestamp >> 32);
+      EnhancedPacket.TimestampLow = (UINT32)Timestamp;
+      EnhancedPacket.CapturedPacketLength = PcapPacketHeader.InclLen;
+      EnhancedPacket.OriginalPacketLength = PcapPacketHeader.OrigLen;
+      Pieces[0].Data = &EnhancedPacket;
+      Pieces[0].Size = sizeof(EnhancedPacket);
+    } else {
+      PaddingSize = 0;
+      Pieces[0].Data = &PcapPacketHeader;
+      Pieces[0].Size = sizeof(PcapPacketHeader);
+    }
+    Pieces[1].Data = Header;
+    Pieces[1].Size = HeaderSize;
+    Pieces[2].Data = Data;
+    Pieces[2].Size = Size;
+    PieceCount = 3;
+    if (mPcapFileIsNg) {
+      Padding = 0;
+      Pieces[3].Data = &Padding;
+      Pieces[3].Size = PaddingSize;
+      Pieces[4].Data = &EnhancedPacket.Header.BlockTotalLength;
+      Pieces[4].Size = sizeof(UINT32);
+      PieceCount = 5;
     }
 
-    if (TotalSize > PCAP_PACKET_MAX_SIZE) {
-      TotalSize = PCAP_PACKET_MAX_SIZE;
+    if (mPcapRingActive) {
+      PcapRingAppend (Pieces, PieceCount);
+      return ;
     }
 
-    if (HeaderSize != 0) {
-      if ((fwrite (Header, 1, HeaderSize, mPcapFile)) != HeaderSize) {
-        printf ("!!!Write pcap file error!!!\n");
-        ClosePcapPacketFile ();
+    for (Index = 0; Index < PieceCount; Index++) {
+      if ((Pieces[Index].Size != 0) && !WritePcapFileData (Pieces[Index].Data, Pieces[Index].Size)) {
         return ;
       }
     }
-
-    if ((fwrite (Data, 1, Size, mPcapFile)) != Size) {
-      printf ("!!!Write pcap file error!!!\n");
-      ClosePcapPacketFile ();
-      return ;
+    if (mPcapFileIsFifo) {
+      fflush (mPcapFile);
     }
   }
 }
@@ -0,0 +1,422 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmEmu.h"
+
+//
+// The shared memory transport replaces the platform socket when the requester and the responder
+// run on the same host. The region holds one ring per direction. Each ring has a single producer
+// and a single consumer, so the ring is lock-free: the producer only writes Head and the consumer
+// only writes Tail. A doorbell word next to each index is bumped after the index moves, and the
+// peer sleeps on it (futex) when the ring is empty or full.
+//
+// Ring record:
+//   Command: 4 bytes
+//   TransportType: 4 bytes
+//   PayloadSize: 4 bytes
+//   Payload (the message encoded by the selected transport layer, MCTP or PCI DOE): PayloadSize
+//
+
+CHAR8  *mSharedMemoryName = NULL;
+
+#ifndef _MSC_VER
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#define SHARED_MEMORY_MAGIC        0x4D485353
+#define SHARED_MEMORY_RING_SIZE    0x8000
+#define SHARED_MEMORY_SPIN_COUNT   0x400
+#define SHARED_MEMORY_PATH_PREFIX  "/dev/shm/"
+
+#pragma pack(1)
+typedef struct {
+  UINT32  Command;
+  UINT32  TransportType;
+  UINT32  PayloadSize;
+} SHARED_MEMORY_RECORD_HEADER;
+#pragma pack()
+
+typedef struct {
+  //
+  // Written by the producer only.
+  //
+  UINT32  Head;
+  UINT32  DataDoorbell;
+  UINT8   Reserved0[56];
+  //
+  // Written by the consumer only.
+  //
+  UINT32  Tail;
+  UINT32  SpaceDoorbell;
+  UINT8   Reserved1[56];
+  UINT8   Data[SHARED_MEMORY_RING_SIZE];
+} SHARED_MEMORY_RING;
+
+typedef struct {
+  UINT32              Magic;
+  UINT32              RingSize;
+  UINT8               Reserved[56];
+  SHARED_MEMORY_RING  ClientToServer;
+  SHARED_MEMORY_RING  ServerToClient;
+} SHARED_MEMORY_REGION;
+
+SHARED_MEMORY_REGION  *mSharedMemoryRegion;
+SHARED_MEMORY_RING    *mSharedMemorySendRing;
+SHARED_MEMORY_RING    *mSharedMemoryReceiveRing;
+INT32                 mSharedMemoryFd = -1;
+BOOLEAN               mSharedMemoryIsServer;
+CHAR8                 mSharedMemoryPath[256];
+
+/**
+  Sleep until the doorbell is rung, if it still holds the value seen by the caller.
+**/
+VOID
+SharedMemoryDoorbellWait (
+  IN UINT32           *Doorbell,
+  IN UINT32           Value
+  )
+{
+#ifdef __linux__
+  syscall (SYS_futex, Doorbell, FUTEX_WAIT, Value, NULL, NULL, 0);
+#else
+  usleep (10);
+#endif
+}
+
+/**
+  Ring the doorbell and wake up the peer sleeping on it.
+**/
+VOID
+SharedMemoryDoorbellRing (
+  IN UINT32           *Doorbell
+  )
+{
+  __atomic_fetch_add (Doorbell, 1, __ATOMIC_RELEASE);
+#ifdef __linux__
+  syscall (SYS_futex, Doorbell, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
+
+/**
+  Wait until the condition checked by the caller may have changed.
+
+  The caller reads the doorbell before checking the ring, so a doorbell rung in between
+  makes the wait return immediately. The ring is polled for a while before sleeping,
+  because the peer usually answers quickly.
+**/
+VOID
+SharedMemoryWait (
+  IN UINT32           *Doorbell,
+  IN UINT32           Value,
+  IN OUT UINT32       *SpinCount
+  )
+{
+  if (*SpinCount < SHARED_MEMORY_SPIN_COUNT) {
+    *SpinCount += 1;
+    return;
+  }
+  SharedMemoryDoorbellWait (Doorbell, Value);
+}
+
+/**
+  Copy data into a ring at a free-running index, wrapping at the end of the ring.
+**/
+VOID
+SharedMemoryRingWrite (
+  IN SHARED_MEMORY_RING  *Ring,
+  IN UINT32              Index,
+  IN VOID                *Buffer,
+  IN UINT32              Size
+  )
+{
+  UINT32  Offset;
+  UINT32  FirstSize;
+
+  Offset = Index & (SHARED_MEMORY_RING_SIZE - 1);
+  FirstSize = MIN (Size, SHARED_MEMORY_RING_SIZE - Offset);
+  CopyMem (Ring->Data + Offset, Buffer, FirstSize);
+  CopyMem (Ring->Data, (UINT8 *)Buffer + FirstSize, Size - FirstSize);
+}
+
+/**
+  Copy data out of a ring at a free-running index, wrapping at the end of the ring.
+**/
+VOID
+SharedMemoryRingRead (
+  IN  SHARED_MEMORY_RING  *Ring,
+  IN  UINT32              Index,
+  OUT VOID                *Buffer,
+  IN  UINT32              Size
+  )
+{
+  UINT32  Offset;
+  UINT32  FirstSize;
+
+  Offset = Index & (SHARED_MEMORY_RING_SIZE - 1);
+  FirstSize = MIN (Size, SHARED_MEMORY_RING_SIZE - Offset);
+  CopyMem (Buffer, Ring->Data + Offset, FirstSize);
+  CopyMem ((UINT8 *)Buffer + FirstSize, Ring->Data, Size - FirstSize);
+}
+
+/**
+  Map the shared memory region named by mSharedMemoryName.
+
+  The responder creates and initializes the region. The requester attaches to it,
+  so the responder must be started first.
+
+  @param  IsServer                     TRUE for the responder, FALSE for the requester.
+
+  @retval TRUE   the region is mapped.
+  @retval FALSE  the region cannot be mapped.
+**/
+BOOLEAN
+SharedMemoryInit (
+  IN BOOLEAN          IsServer
+  )
+{
+  struct stat  FileStat;
+  VOID         *Address;
+
+  snprintf (mSharedMemoryPath, sizeof(mSharedMemoryPath), "%s%s", SHARED_MEMORY_PATH_PREFIX, mSharedMemoryName);
+  mSharedMemoryIsServer = IsServer;
+
+  if (IsServer) {
+    mSharedMemoryFd = open (mSharedMemoryPath, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if ((mSharedMemoryFd != -1) && (ftruncate (mSharedMemoryFd, sizeof(SHARED_MEMORY_REGION)) != 0)) {
+      close (mSharedMemoryFd);
+      mSharedMemoryFd = -1;
+    }
+  } else {
+    mSharedMemoryFd = open (mSharedMemoryPath, O_RDWR);
+    if ((mSharedMemoryFd != -1) &&
+        ((fstat (mSharedMemoryFd, &FileStat) != 0) || (FileStat.st_size < (off_t)sizeof(SHARED_MEMORY_REGION)))) {
+      close (mSharedMemoryFd);
+      mSharedMemoryFd = -1;
+    }
+  }
+  if (mSharedMemoryFd == -1) {
+    printf ("Open shared memory %s error - 0x%x\n", mSharedMemoryPath, errno);
+    return FALSE;
+  }
+
+  Address = mmap (NULL, sizeof(SHARED_MEMORY_REGION), PROT_READ | PROT_WRITE, MAP_SHARED, mSharedMemoryFd, 0);
+  if (Address == MAP_FAILED) {
+    printf ("Map shared memory %s error - 0x%x\n", mSharedMemoryPath, errno);
+    close (mSharedMemoryFd);
+    mSharedMemoryFd = -1;
+    return FALSE;
+  }
+  mSharedMemoryRegion = Address;
+
+  if (IsServer) {
+    ZeroMem (mSharedMemoryRegion, sizeof(SHARED_MEMORY_REGION));
+    mSharedMemoryRegion->RingSize = SHARED_MEMORY_RING_SIZE;
+    __atomic_store_n (&mSharedMemoryRegion->Magic, SHARED_MEMORY_MAGIC, __ATOMIC_RELEASE);
+    mSharedMemorySendRing = &mSharedMemoryRegion->ServerToClient;
+    mSharedMemoryReceiveRing = &mSharedMemoryRegion->ClientToServer;
+  } else {
+    if ((__atomic_load_n (&mSharedMemoryRegion->Magic, __ATOMIC_ACQUIRE) != SHARED_MEMORY_MAGIC) ||
+        (mSharedMemoryRegion->RingSize != SHARED_MEMORY_RING_SIZE)) {
+      printf ("Shared memory %s is not initialized by the responder\n", mSharedMemoryPath);
+      SharedMemoryClose ();
+      return FALSE;
+    }
+    mSharedMemorySendRing = &mSharedMemoryRegion->ClientToServer;
+    mSharedMemoryReceiveRing = &mSharedMemoryRegion->ServerToClient;
+  }
+
+  printf ("Shared memory %s mapped\n", mSharedMemoryPath);
+  return TRUE;
+}
+
+/**
+  Unmap the shared memory region. The responder also removes it.
+**/
+VOID
+SharedMemoryClose (
+  VOID
+  )
+{
+  if (mSharedMemoryRegion != NULL) {
+    munmap (mSharedMemoryRegion, sizeof(SHARED_MEMORY_REGION));
+    mSharedMemoryRegion = NULL;
+    mSharedMemorySendRing = NULL;
+    mSharedMemoryReceiveRing = NULL;
+  }
+  if (mSharedMemoryFd != -1) {
+    close (mSharedMemoryFd);
+    mSharedMemoryFd = -1;
+    if (mSharedMemoryIsServer) {
+      unlink (mSharedMemoryPath);
+    }
+  }
+}
+
+/**
+  Write one record to the send ring, waiting for the free space if the ring is full.
+**/
+BOOLEAN
+SharedMemorySendPlatformData (
+  IN UINT32           Command,
+  IN UINT8            *SendBuffer,
+  IN UINTN            BytesToSend
+  )
+{
+  SHARED_MEMORY_RING           *Ring;
+  SHARED_MEMORY_RECORD_HEADER  RecordHeader;
+  UINT32                       RecordSize;
+  UINT32                       Head;
+  UINT32                       Doorbell;
+  UINT32                       SpinCount;
+
+  Ring = mSharedMemorySendRing;
+  if (Ring == NULL) {
+    return FALSE;
+  }
+  if (BytesToSend > SHARED_MEMORY_RING_SIZE - sizeof(RecordHeader)) {
+    printf ("Shared memory ring too small (0x%x). Expected - 0x%x\n", SHARED_MEMORY_RING_SIZE, (UINT32)(BytesToSend + sizeof(RecordHeader)));
+    return FALSE;
+  }
+  RecordSize = (UINT32)(sizeof(RecordHeader) + BytesToSend);
+
+  Head = Ring->Head;
+  SpinCount = 0;
+  while (TRUE) {
+    Doorbell = __atomic_load_n (&Ring->SpaceDoorbell, __ATOMIC_ACQUIRE);
+    if (SHARED_MEMORY_RING_SIZE - (Head - __atomic_load_n (&Ring->Tail, __ATOMIC_ACQUIRE)) >= RecordSize) {
+      break;
+    }
+    SharedMemoryWait (&Ring->SpaceDoorbell, Doorbell, &SpinCount);
+  }
+
+  RecordHeader.Command = Command;
+  RecordHeader.TransportType = mUseTransportLayer;
+  RecordHeader.PayloadSize = (UINT32)BytesToSend;
+  SharedMemoryRingWrite (Ring, Head, &RecordHeader, sizeof(RecordHeader));
+  if (BytesToSend != 0) {
+    SharedMemoryRingWrite (Ring, Head + sizeof(RecordHeader), SendBuffer, (UINT32)BytesToSend);
+  }
+  __atomic_store_n (&Ring->Head, Head + RecordSize, __ATOMIC_RELEASE);
+  SharedMemoryDoorbellRing (&Ring->DataDoorbell);
+
+  if (mDumpPlatformData) {
+    printf ("Shared Memory Transmit Command: 0x%08x, Size: 0x%x\n", Command, (UINT32)BytesToSend);
+  }
+  return TRUE;
+}
+
+/**
+  Read one record from the receive ring, waiting for it if the ring is empty.
+
+  A record not fitting the receive buffer is dropped, so that the ring stays usable.
+**/
+BOOLEAN
+SharedMemoryReceivePlatformData (
+  OUT UINT32          *Command,
+  OUT UINT8           *ReceiveBuffer,
+  IN OUT UINTN        *BytesToReceive
+  )
+{
+  SHARED_MEMORY_RING           *Ring;
+  SHARED_MEMORY_RECORD_HEADER  RecordHeader;
+  UINT32                       Tail;
+  UINT32                       Doorbell;
+  UINT32                       SpinCount;
+  BOOLEAN                      Result;
+
+  Ring = mSharedMemoryReceiveRing;
+  if (Ring == NULL) {
+    return FALSE;
+  }
+
+  //
+  // The producer publishes a record as a whole, so the payload is ready once the header is.
+  //
+  Tail = Ring->Tail;
+  SpinCount = 0;
+  while (TRUE) {
+    Doorbell = __atomic_load_n (&Ring->DataDoorbell, __ATOMIC_ACQUIRE);
+    if (__atomic_load_n (&Ring->Head, __ATOMIC_ACQUIRE) - Tail >= sizeof(RecordHeader)) {
+      break;
+    }
+    SharedMemoryWait (&Ring->DataDoorbell, Doorbell, &SpinCount);
+  }
+
+  SharedMemoryRingRead (Ring, Tail, &RecordHeader, sizeof(RecordHeader));
+  if (RecordHeader.PayloadSize > SHARED_MEMORY_RING_SIZE - sizeof(RecordHeader)) {
+    printf ("Shared memory record corrupted - 0x%x\n", RecordHeader.PayloadSize);
+    return FALSE;
+  }
+
+  Result = TRUE;
+  if (RecordHeader.TransportType != mUseTransportLayer) {
+    printf ("TransportType mismatch\n");
+    Result = FALSE;
+  } else if (RecordHeader.PayloadSize > *BytesToReceive) {
+    printf ("Buffer too small (0x%x). Expected - 0x%x\n", (UINT32)*BytesToReceive, RecordHeader.PayloadSize);
+    Result = FALSE;
+  } else {
+    SharedMemoryRingRead (Ring, Tail + sizeof(RecordHeader), ReceiveBuffer, RecordHeader.PayloadSize);
+    *Command = RecordHeader.Command;
+    *BytesToReceive = RecordHeader.PayloadSize;
+  }
+  __atomic_store_n (&Ring->Tail, Tail + sizeof(RecordHeader) + RecordHeader.PayloadSize, __ATOMIC_RELEASE);
+  SharedMemoryDoorbellRing (&Ring->SpaceDoorbell);
+
+  if (Result && mDumpPlatformData) {
+    printf ("Shared Memory Receive Command: 0x%08x, Size: 0x%x\n", *Command, RecordHeader.PayloadSize);
+  }
+  return Result;
+}
+
+#else
+
+BOOLEAN
+SharedMemoryInit (
+  IN BOOLEAN          IsServer
+  )
+{
+  printf ("Shared memory transport is not supported\n");
+  return FALSE;
+}
+
+VOID
+SharedMemoryClose (
+  VOID
+  )
+{
+}
+
+BOOLEAN
+SharedMemorySendPlatformData (
+  IN UINT32           Command,
+  IN UINT8            *SendBuffer,
+  IN UINTN            BytesToSend
+  )
+{
+  return FALSE;
+}
+
+BOOLEAN
+SharedMemoryReceivePlatformData (
+  OUT UINT32          *Command,
+  OUT UINT8           *ReceiveBuffer,
+  IN OUT UINTN        *BytesToReceive
+  )
+{
+  return FALSE;
+}
+
+#endif
@@ -0,0 +1,262 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmEmu.h"
+
+//
+// The trace file is in the Chrome trace event format (JSON array), and can be opened by
+// chrome://tracing or Perfetto. Each SPDM message is one complete ("X") event.
+// The timestamps are taken from the monotonic clock of the host, so that the traces of
+// the requester and the responder running on the same host line up once merged,
+// for example with: jq -s add Requester.json Responder.json > Session.json
+//
+
+CHAR8   *mTraceFileName = NULL;
+
+FILE    *mTraceFile;
+UINT32  mTraceEventCount;
+UINT32  mTraceProcessId;
+UINT32  mTraceTrackNamed;
+
+typedef struct {
+  UINT8   RequestCode;
+  CHAR8   *Name;
+} TRACE_REQUEST_CODE_NAME;
+
+TRACE_REQUEST_CODE_NAME  mTraceRequestCodeName[] = {
+  {SPDM_GET_DIGESTS,                   "GET_DIGESTS"},
+  {SPDM_GET_CERTIFICATE,               "GET_CERTIFICATE"},
+  {SPDM_CHALLENGE,                     "CHALLENGE"},
+  {SPDM_GET_VERSION,                   "GET_VERSION"},
+  {SPDM_GET_MEASUREMENTS,              "GET_MEASUREMENTS"},
+  {SPDM_GET_CAPABILITIES,              "GET_CAPABILITIES"},
+  {SPDM_NEGOTIATE_ALGORITHMS,          "NEGOTIATE_ALGORITHMS"},
+  {SPDM_KEY_EXCHANGE,                  "KEY_EXCHANGE"},
+  {SPDM_FINISH,                        "FINISH"},
+  {SPDM_PSK_EXCHANGE,                  "PSK_EXCHANGE"},
+  {SPDM_PSK_FINISH,                    "PSK_FINISH"},
+  {SPDM_HEARTBEAT,                     "HEARTBEAT"},
+  {SPDM_KEY_UPDATE,                    "KEY_UPDATE"},
+  {SPDM_GET_ENCAPSULATED_REQUEST,      "GET_ENCAPSULATED_REQUEST"},
+  {SPDM_DELIVER_ENCAPSULATED_RESPONSE, "DELIVER_ENCAPSULATED_RESPONSE"},
+  {SPDM_END_SESSION,                   "END_SESSION"},
+  {SPDM_VENDOR_DEFINED_REQUEST,        "VENDOR_DEFINED_REQUEST"},
+  {SPDM_RESPOND_IF_READY,              "RESPOND_IF_READY"},
+};
+
+CHAR8  *mTraceTrackName[] = {
+  "",
+  "Requester transport",
+  "Requester local",
+  "Responder processing",
+};
+
+/**
+  Return the monotonic time, in nanoseconds.
+**/
+UINT64
+TraceGetTime (
+  VOID
+  )
+{
+  return GetTimeInNanoSecond (GetPerformanceCounter ());
+}
+
+/**
+  Return the name of an SPDM request code, or NULL if it is not known.
+**/
+CHAR8 *
+TraceGetRequestCodeName (
+  IN UINT8            RequestCode
+  )
+{
+  UINTN   Index;
+
+  for (Index = 0; Index < ARRAY_SIZE(mTraceRequestCodeName); Index++) {
+    if (mTraceRequestCodeName[Index].RequestCode == RequestCode) {
+      return mTraceRequestCodeName[Index].Name;
+    }
+  }
+  return NULL;
+}
+
+/**
+  Write one event to the trace file, with the separator of the JSON array.
+**/
+VOID
+TraceWriteSeparator (
+  VOID
+  )
+{
+  fprintf (mTraceFile, (mTraceEventCount == 0) ? "\n" : ",\n");
+  mTraceEventCount++;
+}
+
+BOOLEAN
+OpenTraceFile (
+  IN CHAR8            *TraceFileName,
+  IN CHAR8            *ProcessName
+  )
+{
+  if ((mTraceFile = fopen (TraceFileName, "w")) == NULL) {
+    printf ("!!!Unable to open trace file %s!!!\n", TraceFileName);
+    return FALSE;
+  }
+#ifdef _MSC_VER
+  mTraceProcessId = (UINT32)GetCurrentProcessId ();
+#else
+  mTraceProcessId = (UINT32)getpid ();
+#endif
+  mTraceEventCount = 0;
+  mTraceTrackNamed = 0;
+
+  fprintf (mTraceFile, "[");
+  TraceWriteSeparator ();
+  fprintf (mTraceFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"%s\"}}",
+    mTraceProcessId, ProcessName);
+  return TRUE;
+}
+
+VOID
+CloseTraceFile (
+  VOID
+  )
+{
+  if (mTraceFile != NULL) {
+    fprintf (mTraceFile, "\n]\n");
+    fclose (mTraceFile);
+    mTraceFile = NULL;
+  }
+}
+
+/**
+  Get the SPDM request code and the session ID of a message encoded by the transport layer.
+
+  @param  MessageSize                  Size in bytes of the transport layer message.
+  @param  Message                      A pointer to the transport layer message.
+  @param  RequestResponseCode          The request or response code of a normal message, or 0 if it is secured.
+  @param  SessionId                    The session ID of a secured message.
+
+  @retval TRUE   the message is a secured message.
+  @retval FALSE  the message is a normal message, or it is not an SPDM message.
+**/
+BOOLEAN
+TraceParseTransportMessage (
+  IN  UINTN           MessageSize,
+  IN  VOID            *Message,
+  OUT UINT8           *RequestResponseCode,
+  OUT UINT32          *SessionId
+  )
+{
+  UINT8                       *Buffer;
+  UINTN                       HeaderSize;
+  BOOLEAN                     IsSecured;
+  PCI_DOE_DATA_OBJECT_HEADER  *DoeHeader;
+
+  Buffer = Message;
+  *RequestResponseCode = 0;
+  *SessionId = 0;
+  if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_MCTP) {
+    if (MessageSize < sizeof(MCTP_MESSAGE_HEADER)) {
+      return FALSE;
+    }
+    HeaderSize = sizeof(MCTP_MESSAGE_HEADER);
+    IsSecured = (BOOLEAN)(Buffer[0] == MCTP_MESSAGE_TYPE_SECURED_MCTP);
+    if (!IsSecured && (Buffer[0] != MCTP_MESSAGE_TYPE_SPDM)) {
+      return FALSE;
+    }
+  } else {
+    if (MessageSize < sizeof(PCI_DOE_DATA_OBJECT_HEADER)) {
+      return FALSE;
+    }
+    DoeHeader = Message;
+    HeaderSize = sizeof(PCI_DOE_DATA_OBJECT_HEADER);
+    IsSecured = (BOOLEAN)(DoeHeader->DataObjectType == PCI_DOE_DATA_OBJECT_TYPE_SECURED_SPDM);
+    if (!IsSecured && (DoeHeader->DataObjectType != PCI_DOE_DATA_OBJECT_TYPE_SPDM)) {
+      return FALSE;
+    }
+  }
+
+  if (IsSecured) {
+    if (MessageSize >= HeaderSize + sizeof(UINT32)) {
+      CopyMem (SessionId, Buffer + HeaderSize, sizeof(UINT32));
+    }
+    return TRUE;
+  }
+  if (MessageSize >= HeaderSize + sizeof(SPDM_MESSAGE_HEADER)) {
+    *RequestResponseCode = ((SPDM_MESSAGE_HEADER *)(Buffer + HeaderSize))->RequestResponseCode;
+  }
+  return FALSE;
+}
+
+/**
+  Append the event of one SPDM message to the trace file.
+
+  @param  Track                        The track of the event, as TRACE_TRACK_*.
+  @param  StartTime                    The start time of the event, in nanoseconds.
+  @param  EndTime                      The end time of the event, in nanoseconds.
+  @param  RequestCode                  The SPDM request code, or 0 if it is not known.
+  @param  SessionId                    The session ID of a secured message, or NULL for a normal message.
+  @param  RequestSize                  Size in bytes of the transport layer request.
+  @param  ResponseSize                 Size in bytes of the transport layer response.
+  @param  CryptoTime                   The crypto time of the responder, in nanoseconds, or TRACE_TIME_UNKNOWN.
+  @param  CallbackTime                 The callback time of the responder, in nanoseconds, or TRACE_TIME_UNKNOWN.
+**/
+VOID
+TraceAppendMessage (
+  IN UINT32           Track,
+  IN UINT64           StartTime,
+  IN UINT64           EndTime,
+  IN UINT8            RequestCode,
+  IN UINT32           *SessionId OPTIONAL,
+  IN UINTN            RequestSize,
+  IN UINTN            ResponseSize,
+  IN UINT64           CryptoTime,
+  IN UINT64           CallbackTime
+  )
+{
+  CHAR8   *Name;
+  CHAR8   UnknownName[sizeof("0x00")];
+
+  if (mTraceFile == NULL) {
+    return;
+  }
+
+  if ((mTraceTrackNamed & (1 << Track)) == 0) {
+    mTraceTrackNamed |= (1 << Track);
+    TraceWriteSeparator ();
+    fprintf (mTraceFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+      mTraceProcessId, Track, mTraceTrackName[Track]);
+  }
+
+  Name = (SessionId != NULL) ? "SECURED" : "UNKNOWN";
+  if (RequestCode != 0) {
+    Name = TraceGetRequestCodeName (RequestCode);
+    if (Name == NULL) {
+      snprintf (UnknownName, sizeof(UnknownName), "0x%02X", RequestCode);
+      Name = UnknownName;
+    }
+  }
+
+  TraceWriteSeparator ();
+  fprintf (mTraceFile, "{\"name\":\"%s\",\"cat\":\"spdm\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+    Name, mTraceProcessId, Track, (double)StartTime / 1000.0, (double)(EndTime - StartTime) / 1000.0);
+  fprintf (mTraceFile, "\"request_code\":\"0x%02X\",\"request_size\":%u,\"response_size\":%u",
+    RequestCode, (UINT32)RequestSize, (UINT32)ResponseSize);
+  if (SessionId != NULL) {
+    fprintf (mTraceFile, ",\"session_id\":\"0x%08X\"", *SessionId);
+  }
+  if (CryptoTime != TRACE_TIME_UNKNOWN) {
+    fprintf (mTraceFile, ",\"crypto_us\":%.3f", (double)CryptoTime / 1000.0);
+  }
+  if (CallbackTime != TRACE_TIME_UNKNOWN) {
+    fprintf (mTraceFile, ",\"callback_us\":%.3f", (double)CallbackTime / 1000.0);
+  }
+  fprintf (mTraceFile, "}}");
+}
@@ -10,8 +10,16 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "SpdmRequesterEmu.h"
 
 VOID                          *mSpdmContext;
+VOID                          *mSpdmPrivateKey;
 SOCKET                        mSocket;
 
+UINT64                        mTraceSendTime;
+UINT64                        mTraceReceiveTime;
+UINTN                         mTraceRequestSize;
+UINT8                         mTraceRequestCode;
+BOOLEAN                       mTraceIsSecured;
+UINT32                        mTraceSessionId;
+
 BOOLEAN
 CommunicatePlatformData (
   IN SOCKET           Socket,
@@ -60,9 +68,17 @@ SpdmDeviceSendMessage (
   IN     UINT64                                 Timeout
   )
 {
+  SOCKET  *Socket;
   BOOLEAN Result;
 
-  Result = SendPlatformData (mSocket, SOCKET_SPDM_COMMAND_NORMAL, Request, (UINT32)RequestSize);
+  if (mTraceFileName != NULL) {
+    mTraceSendTime = TraceGetTime ();
+    mTraceRequestSize = RequestSize;
+    mTraceIsSecured = TraceParseTransportMessage (RequestSize, Request, &mTraceRequestCode, &mTraceSessionId);
+  }
+
+  Socket = SpdmGetDeviceIoContext (SpdmContext);
+  Result = SendPlatformData (*Socket, SOCKET_SPDM_COMMAND_NORMAL, Request, (UINT32)RequestSize);
   if (!Result) {
     printf ("SendPlatformData Error - %x\n",
 #ifdef _MSC_VER
@@ -85,10 +101,13 @@ SpdmDeviceReceiveMessage (
   IN     UINT64                                 Timeout
   )
 {
+  SOCKET  *Socket;
   BOOLEAN Result;
   UINT32  Command;
+  UINT64  ReceiveTime;
 
-  Result = ReceivePlatformData (mSocket, &Command, Response, ResponseSize);
+  Socket = SpdmGetDeviceIoContext (SpdmContext);
+  Result = ReceivePlatformData (*Socket, &Command, Response, ResponseSize);
   if (!Result) {
     printf ("ReceivePlatformData Error - %x\n",
 #ifdef _MSC_VER
@@ -99,47 +118,107 @@ SpdmDeviceReceiveMessage (
       );
     return RETURN_DEVICE_ERROR;
   }
+
+  if (mTraceFileName != NULL) {
+    ReceiveTime = TraceGetTime ();
+    TraceAppendMessage (
+      TRACE_TRACK_REQUESTER_TRANSPORT,
+      mTraceSendTime,
+      ReceiveTime,
+      mTraceRequestCode,
+      mTraceIsSecured ? &mTraceSessionId : NULL,
+      mTraceRequestSize,
+      *ResponseSize,
+      TRACE_TIME_UNKNOWN,
+      TRACE_TIME_UNKNOWN
+      );
+    if (mTraceReceiveTime != 0) {
+      //
+      // The local time is spent by the requester between the previous response and this request.
+      //
+      TraceAppendMessage (
+        TRACE_TRACK_REQUESTER_LOCAL,
+        mTraceReceiveTime,
+        mTraceSendTime,
+        mTraceRequestCode,
+        mTraceIsSecured ? &mTraceSessionId : NULL,
+        mTraceRequestSize,
+        0,
+        TRACE_TIME_UNKNOWN,
+        TRACE_TIME_UNKNOWN
+        );
+    }
+    mTraceReceiveTime = ReceiveTime;
+  }
   return RETURN_SUCCESS;
 }
 
+/**
+  Get the request code of a secured message for the trace, once it is sent in plain text.
+**/
+VOID
+EFIAPI
+SpdmTraceRequesterMonitor (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsRequester,
+  IN     RETURN_STATUS        Status,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message
+  )
+{
+  if (IsRequester && !RETURN_ERROR(Status) && (MessageSize >= sizeof(SPDM_MESSAGE_HEADER))) {
+    mTraceRequestCode = ((SPDM_MESSAGE_HEADER *)Message)->RequestResponseCode;
+  }
+}
+
+/**
+  Create an SPDM context for the requester, and set its local settings.
+
+  @param  Socket                       A pointer to the platform socket used by the SPDM context.
+
+  @return the SPDM context, or NULL.
+**/
 VOID *
-SpdmClientInit (
-  VOID
+SpdmClientCreateContext (
+  IN SOCKET           *Socket
   )
 {
   VOID                         *SpdmContext;
-  UINT8                        Index;
-  RETURN_STATUS                Status;
-  BOOLEAN                      Res;
-  VOID                         *Data;
-  UINTN                        DataSize;
   SPDM_DATA_PARAMETER          Parameter;
   UINT8                        Data8;
   UINT16                       Data16;
   UINT32                       Data32;
-  VOID                         *Hash;
-  UINTN                        HashSize;
   SPDM_VERSION_NUMBER          SpdmVersion;
 
-  mSpdmContext = (VOID *)malloc (SpdmGetContextSize());
-  if (mSpdmContext == NULL) {
+  SpdmContext = (VOID *)malloc (SpdmGetContextSize());
+  if (SpdmContext == NULL) {
     return NULL;
   }
-  SpdmContext = mSpdmContext;
   SpdmInitContext (SpdmContext);
   SpdmRegisterDeviceIoFunc (SpdmContext, SpdmDeviceSendMessage, SpdmDeviceReceiveMessage);
+  SpdmRegisterDeviceIoContext (SpdmContext, Socket);
+  if ((mTraceFileName != NULL) || (mMetricsFileName != NULL)) {
+    //
+    // The time function enables the latencies of the requester statistics.
+    //
+    SpdmRegisterRequesterMonitorFunc (
+      SpdmContext,
+      (mMetricsFileName != NULL) ? MetricsGetTime : NULL,
+      (mTraceFileName != NULL) ? SpdmTraceRequesterMonitor : NULL
+      );
+  }
   if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_MCTP) {
     SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportMctpEncodeMessage, SpdmTransportMctpDecodeMessage);
+    SpdmRegisterTransportLayerMessageRoomFunc (SpdmContext, SpdmTransportMctpGetMessageRoom);
   } else if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_PCI_DOE) {
     SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportPciDoeEncodeMessage, SpdmTransportPciDoeDecodeMessage);
+    SpdmRegisterTransportLayerMessageRoomFunc (SpdmContext, SpdmTransportPciDoeGetMessageRoom);
   } else {
+    free (SpdmContext);
     return NULL;
   }
 
-  if (mLoadStateFileName != NULL) {
-    SpdmLoadNegotiatedState (SpdmContext, TRUE);
-  }
-
   if (mUseVersion != SPDM_MESSAGE_VERSION_11) {
     ZeroMem (&Parameter, sizeof(Parameter));
     Parameter.Location = SpdmDataLocationLocal;
@@ -167,6 +246,14 @@ SpdmClientInit (
   ZeroMem (&Parameter, sizeof(Parameter));
   Parameter.Location = SpdmDataLocationLocal;
 
+  if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_PCI_DOE) {
+    //
+    // A DOE data object holds up to 1MB, so a CERTIFICATE portion is only limited by the message buffer.
+    //
+    Data32 = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    SpdmSetData (SpdmContext, SpdmDataTransportMaxMessageSize, &Parameter, &Data32, sizeof(Data32));
+  }
+
   Data8 = 0;
   SpdmSetData (SpdmContext, SpdmDataCapabilityCTExponent, &Parameter, &Data8, sizeof(Data8));
   Data32 = mUseRequesterCapabilityFlags;
@@ -190,16 +277,34 @@ SpdmClientInit (
   Data16 = mSupportKeyScheduleAlgo;
   SpdmSetData (SpdmContext, SpdmDataKeySchedule, &Parameter, &Data16, sizeof(Data16));
 
-  if (mLoadStateFileName == NULL) {
-    // Skip if state is loaded
-    Status = SpdmInitConnection (SpdmContext, (mExeConnection & EXE_CONNECTION_VERSION_ONLY) != 0);
-    if (RETURN_ERROR(Status)) {
-      printf ("SpdmInitConnection - 0x%x\n", (UINT32)Status);
-      free (mSpdmContext);
-      mSpdmContext = NULL;
-      return NULL;
-    }
-  }
+  return SpdmContext;
+}
+
+/**
+  Provision the certificates, the private key and the PSK hint of a negotiated SPDM context.
+
+  The concurrent callers must be serialized, because the negotiated algorithms are kept in globals.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  PrivateKey                   On output, the parsed private key of the requester, or NULL.
+**/
+VOID
+SpdmClientProvision (
+  IN  VOID            *SpdmContext,
+  OUT VOID            **PrivateKey
+  )
+{
+  UINT8                        Index;
+  RETURN_STATUS                Status;
+  BOOLEAN                      Res;
+  VOID                         *Data;
+  UINTN                        DataSize;
+  SPDM_DATA_PARAMETER          Parameter;
+  UINT8                        Data8;
+  UINT16                       Data16;
+  UINT32                       Data32;
+  VOID                         *Hash;
+  UINTN                        HashSize;
 
   ZeroMem (&Parameter, sizeof(Parameter));
   Parameter.Location = SpdmDataLocationConnection;
@@ -222,7 +327,7 @@ SpdmClientInit (
   mUseReqAsymAlgo = Data16;
 
   if ((mUseSlotId == 0xFF) || ((mUseRequesterCapabilityFlags & SPDM_GET_CAPABILITIES_REQUEST_FLAGS_PUB_KEY_ID_CAP) != 0)) {
-    Res = ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, NULL, NULL);
+    Res = ReadCachedCertificate (CERT_KIND_RESPONDER_CHAIN, mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, NULL, NULL);
     if (Res) {
       ZeroMem (&Parameter, sizeof(Parameter));
       Parameter.Location = SpdmDataLocationLocal;
@@ -230,7 +335,7 @@ SpdmClientInit (
       // Do not free it.
     }
   } else {
-    Res = ReadResponderRootPublicCertificate (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+    Res = ReadCachedCertificate (CERT_KIND_RESPONDER_ROOT, mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
     if (Res) {
       ZeroMem (&Parameter, sizeof(Parameter));
       Parameter.Location = SpdmDataLocationLocal;
@@ -239,7 +344,7 @@ SpdmClientInit (
     }
   }
 
-  Res = ReadRequesterPublicCertificateChain (mUseHashAlgo, mUseReqAsymAlgo, &Data, &DataSize, NULL, NULL);
+  Res = ReadCachedCertificate (CERT_KIND_REQUESTER_CHAIN, mUseHashAlgo, mUseReqAsymAlgo, &Data, &DataSize, NULL, NULL);
   if (Res) {
     ZeroMem (&Parameter, sizeof(Parameter));
     Parameter.Location = SpdmDataLocationLocal;
@@ -253,14 +358,57 @@ SpdmClientInit (
     // do not free it
   }
 
+  //
+  // Parse the private key once, instead of per signing.
+  //
+  *PrivateKey = NULL;
+  if (SpdmRequesterDataLoadKeyFunc (mUseReqAsymAlgo, PrivateKey)) {
+    SpdmRegisterLocalPrivateKey (SpdmContext, TRUE, mUseReqAsymAlgo, *PrivateKey);
+  }
+
   Status = SpdmSetData (SpdmContext, SpdmDataPskHint, NULL, TEST_PSK_HINT_STRING, sizeof(TEST_PSK_HINT_STRING));
   if (RETURN_ERROR(Status)) {
     printf ("SpdmSetData - %x\n", (UINT32)Status);
   }
+}
+
+VOID *
+SpdmClientInit (
+  VOID
+  )
+{
+  VOID                         *SpdmContext;
+  RETURN_STATUS                Status;
+  VOID                         *CertChain;
+  UINTN                        CertChainSize;
 
-  if (mSaveStateFileName != NULL) {
-    SpdmSaveNegotiatedState (SpdmContext, TRUE);
+  SpdmContext = SpdmClientCreateContext (&mSocket);
+  if (SpdmContext == NULL) {
+    return NULL;
   }
 
+  if (mLoadStateFileName != NULL) {
+    Status = SpdmLoadNegotiatedState (SpdmContext);
+    if (!RETURN_ERROR(Status) && SpdmGetPeerCertChainBuffer (SpdmContext, &CertChain, &CertChainSize)) {
+      //
+      // The verified certificate chain of the responder is preserved too.
+      //
+      mExeConnection &= ~(EXE_CONNECTION_DIGEST | EXE_CONNECTION_CERT);
+    }
+  }
+
+  //
+  // It returns at once if the negotiated state is loaded.
+  //
+  Status = SpdmInitConnection (SpdmContext, (mExeConnection & EXE_CONNECTION_VERSION_ONLY) != 0);
+  if (RETURN_ERROR(Status)) {
+    printf ("SpdmInitConnection - 0x%x\n", (UINT32)Status);
+    free (SpdmContext);
+    return NULL;
+  }
+
+  SpdmClientProvision (SpdmContext, &mSpdmPrivateKey);
+
+  mSpdmContext = SpdmContext;
   return mSpdmContext;
 }
\ No newline at end of file
@@ -21,6 +21,7 @@ UINT8  mReceiveBuffer[MAX_SPDM_MESSAGE_BUFFER_SIZE];
 extern SOCKET                       mSocket;
 
 extern VOID          *mSpdmContext;
+extern VOID          *mSpdmPrivateKey;
 
 VOID *
 SpdmClientInit (
@@ -53,6 +54,11 @@ DoSessionViaSpdm (
   IN     BOOLEAN              UsePsk
   );
 
+BOOLEAN
+PlatformLoadRoutine (
+  IN UINT16 PortNumber
+  );
+
 BOOLEAN
 InitClient (
   OUT SOCKET  *Socket,
@@ -93,7 +99,10 @@ InitClient (
     return FALSE;
   }
 
-  printf ("connect success!\n");
+  if (mLoadOperation == 0) {
+    printf ("connect success!\n");
+  }
+  InitPlatformSocket (ClientSocket);
 
   *Socket = ClientSocket;
   return TRUE;
@@ -129,7 +138,12 @@ PlatformClientRoutine (
     return FALSE;
   }
 #endif
-  Result = InitClient (&PlatformSocket, PortNumber);
+  if (mSharedMemoryName != NULL) {
+    PlatformSocket = INVALID_SOCKET;
+    Result = SharedMemoryInit (FALSE);
+  } else {
+    Result = InitClient (&PlatformSocket, PortNumber);
+  }
   if (!Result) {
     return FALSE;
   }
@@ -231,10 +245,18 @@ Done:
             );
 
   if (mSpdmContext != NULL) {
+    MetricsCollect (mSpdmContext, NULL);
     free (mSpdmContext);
   }
+  if (mSpdmPrivateKey != NULL) {
+    SpdmRequesterDataReleaseKeyFunc (mUseReqAsymAlgo, mSpdmPrivateKey);
+  }
 
-  closesocket (PlatformSocket);
+  if (mSharedMemoryName != NULL) {
+    SharedMemoryClose ();
+  } else {
+    closesocket (PlatformSocket);
+  }
   
 #ifdef _MSC_VER
   WSACleanup();
@@ -253,9 +275,15 @@ int main (
 
   ProcessArgs ("SpdmRequesterEmu", argc, argv);
 
-  PlatformClientRoutine (DEFAULT_SPDM_PLATFORM_PORT);
+  if (mLoadOperation != 0) {
+    PlatformLoadRoutine (DEFAULT_SPDM_PLATFORM_PORT);
+  } else {
+    PlatformClientRoutine (DEFAULT_SPDM_PLATFORM_PORT);
+  }
   printf ("Client stopped\n");
 
   ClosePcapPacketFile ();
+  CloseTraceFile ();
+  CloseMetricsFile ();
   return 0;
 }
\ No newline at end of file
@@ -15,6 +15,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/SpdmRequesterLib.h>
 #include <Library/SpdmTransportMctpLib.h>
 #include <Library/SpdmTransportPciDoeLib.h>
+#include <Library/SpdmPldmLib.h>
+#include <Library/SpdmPciIdeKmLib.h>
 
 #include "OsInclude.h"
 #include "stdio.h"
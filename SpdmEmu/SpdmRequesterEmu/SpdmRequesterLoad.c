@@ -0,0 +1,1066 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmRequesterEmu.h"
+
+#define LOAD_PHASE_CONNECT      0
+#define LOAD_PHASE_VCA          1
+#define LOAD_PHASE_AUTH         2
+#define LOAD_PHASE_KEY_EX       3
+#define LOAD_PHASE_PSK          4
+#define LOAD_PHASE_APP          5
+#define LOAD_PHASE_END_SESSION  6
+#define LOAD_PHASE_COUNT        7
+
+//
+// The latency samples kept for each phase. The phases beyond it are counted, but not sampled.
+//
+#define MAX_LOAD_SAMPLE_COUNT   0x100000
+
+//
+// The states of a connection driven by the async I/O backend, in order.
+//
+#define LOAD_ASYNC_STATE_VCA         0
+#define LOAD_ASYNC_STATE_DIGEST      1
+#define LOAD_ASYNC_STATE_CERT        2
+#define LOAD_ASYNC_STATE_CHAL        3
+#define LOAD_ASYNC_STATE_KEY_EX      4
+#define LOAD_ASYNC_STATE_KEY_EX_APP  5
+#define LOAD_ASYNC_STATE_PSK         6
+#define LOAD_ASYNC_STATE_PSK_APP     7
+#define LOAD_ASYNC_STATE_END         8
+
+#define LOAD_ASYNC_EVENT_COUNT       64
+#define LOAD_ASYNC_APP_RESPONSE_SIZE 0x100
+
+typedef struct {
+  UINT64   *Sample;
+  UINTN    SampleCount;
+  UINTN    MaxSampleCount;
+  UINTN    Count;
+  UINTN    FailureCount;
+} SPDM_LOAD_PHASE_STAT;
+
+CHAR8  *mLoadPhaseName[LOAD_PHASE_COUNT] = {
+  "CONNECT",
+  "VCA",
+  "AUTH",
+  "KEY_EX",
+  "PSK",
+  "APP",
+  "END_SESSION",
+};
+
+typedef struct {
+  SOCKET   Socket;
+  VOID     *Connection;
+  VOID     *SpdmContext;
+  VOID     *PrivateKey;
+  UINTN    State;
+  UINT64   Start;
+  BOOLEAN  Failed;
+  UINT32   SessionId;
+  //
+  // The sessions established by the connection, ended when the connection is released.
+  //
+  UINT32   SessionCount;
+  UINT8    HeartbeatPeriod;
+  UINT8    MeasurementHash[MAX_HASH_SIZE];
+  UINT8    SlotMask;
+  UINT8    TotalDigestBuffer[MAX_HASH_SIZE * MAX_SPDM_SLOT_COUNT];
+  UINTN    CertChainSize;
+  UINT8    CertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+  UINTN    AppResponseSize;
+  UINT8    AppResponse[LOAD_ASYNC_APP_RESPONSE_SIZE];
+} SPDM_LOAD_ASYNC_CONNECTION;
+
+SPDM_LOAD_PHASE_STAT  mLoadPhaseStat[LOAD_PHASE_COUNT];
+UINT32                mLoadConnectionStarted;
+UINT32                mLoadConnectionSucceeded;
+UINT32                mLoadConnectionFailed;
+UINT32                mLoadSessionCount;
+UINT64                mLoadStartTime;
+
+#ifdef _MSC_VER
+CRITICAL_SECTION      mLoadLock;
+#else
+pthread_mutex_t       mLoadLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+BOOLEAN
+InitClient (
+  OUT SOCKET  *Socket,
+  IN  UINT16  Port
+  );
+
+VOID *
+SpdmClientCreateContext (
+  IN SOCKET           *Socket
+  );
+
+VOID
+SpdmClientProvision (
+  IN  VOID            *SpdmContext,
+  OUT VOID            **PrivateKey
+  );
+
+BOOLEAN
+CommunicatePlatformData (
+  IN SOCKET           Socket,
+  IN UINT32           Command,
+  IN UINT8            *SendBuffer,
+  IN UINTN            BytesToSend,
+  OUT UINT32          *Response,
+  IN OUT UINTN        *BytesToReceive,
+  OUT UINT8           *ReceiveBuffer
+  );
+
+RETURN_STATUS
+SpdmAuthentication (
+  IN     VOID                 *Context,
+     OUT UINT8                *SlotMask,
+     OUT VOID                 *TotalDigestBuffer,
+  IN     UINT8                SlotNum,
+  IN OUT UINTN                *CertChainSize,
+     OUT VOID                 *CertChain,
+  IN     UINT8                MeasurementHashType,
+     OUT VOID                 *MeasurementHash
+  );
+
+RETURN_STATUS
+DoAppSessionViaSpdm (
+  IN VOID                            *SpdmContext,
+  IN UINT32                          SessionId
+  );
+
+extern SPDM_VENDOR_DEFINED_REQUEST_MINE  mVendorDefinedRequest;
+extern SECURE_SESSION_REQUEST_MINE       mSecureSessionRequest;
+
+/**
+  Acquire the lock protecting the state shared by the load workers.
+**/
+VOID
+AcquireLoadLock (
+  VOID
+  )
+{
+#ifdef _MSC_VER
+  EnterCriticalSection (&mLoadLock);
+#else
+  pthread_mutex_lock (&mLoadLock);
+#endif
+}
+
+/**
+  Release the lock protecting the state shared by the load workers.
+**/
+VOID
+ReleaseLoadLock (
+  VOID
+  )
+{
+#ifdef _MSC_VER
+  LeaveCriticalSection (&mLoadLock);
+#else
+  pthread_mutex_unlock (&mLoadLock);
+#endif
+}
+
+/**
+  Return the monotonic time, in nanoseconds.
+**/
+UINT64
+LoadGetTime (
+  VOID
+  )
+{
+#ifdef _MSC_VER
+  LARGE_INTEGER  Counter;
+  LARGE_INTEGER  Frequency;
+
+  QueryPerformanceCounter (&Counter);
+  QueryPerformanceFrequency (&Frequency);
+  return (UINT64)((double)Counter.QuadPart * 1000000000.0 / (double)Frequency.QuadPart);
+#else
+  struct timespec  Time;
+
+  clock_gettime (CLOCK_MONOTONIC, &Time);
+  return (UINT64)Time.tv_sec * 1000000000ull + (UINT64)Time.tv_nsec;
+#endif
+}
+
+/**
+  Return the CPU time (user and kernel) used by the requester process, in nanoseconds.
+**/
+UINT64
+LoadGetProcessCpuTime (
+  VOID
+  )
+{
+#ifdef _MSC_VER
+  FILETIME        CreationTime;
+  FILETIME        ExitTime;
+  FILETIME        KernelTime;
+  FILETIME        UserTime;
+
+  if (!GetProcessTimes (GetCurrentProcess (), &CreationTime, &ExitTime, &KernelTime, &UserTime)) {
+    return 0;
+  }
+  return ((((UINT64)KernelTime.dwHighDateTime << 32) | KernelTime.dwLowDateTime) +
+          (((UINT64)UserTime.dwHighDateTime << 32) | UserTime.dwLowDateTime)) * 100;
+#else
+  struct rusage   Usage;
+
+  if (getrusage (RUSAGE_SELF, &Usage) != 0) {
+    return 0;
+  }
+  return ((UINT64)Usage.ru_utime.tv_sec + (UINT64)Usage.ru_stime.tv_sec) * 1000000000ull +
+         ((UINT64)Usage.ru_utime.tv_usec + (UINT64)Usage.ru_stime.tv_usec) * 1000;
+#endif
+}
+
+/**
+  Record the result of one phase.
+
+  @param  Phase                        The phase, as LOAD_PHASE_*.
+  @param  Latency                      The latency of the phase, in nanoseconds.
+  @param  Success                      TRUE if the phase succeeds. Only the latencies of the successful phases are sampled.
+**/
+VOID
+LoadRecordPhase (
+  IN UINTN            Phase,
+  IN UINT64           Latency,
+  IN BOOLEAN          Success
+  )
+{
+  SPDM_LOAD_PHASE_STAT  *Stat;
+  UINT64                *Sample;
+  UINTN                 MaxSampleCount;
+
+  Stat = &mLoadPhaseStat[Phase];
+  AcquireLoadLock ();
+  if (!Success) {
+    Stat->FailureCount++;
+    ReleaseLoadLock ();
+    return;
+  }
+  Stat->Count++;
+  if ((Stat->SampleCount == Stat->MaxSampleCount) && (Stat->MaxSampleCount < MAX_LOAD_SAMPLE_COUNT)) {
+    MaxSampleCount = (Stat->MaxSampleCount == 0) ? 0x400 : Stat->MaxSampleCount * 2;
+    Sample = realloc (Stat->Sample, MaxSampleCount * sizeof(UINT64));
+    if (Sample != NULL) {
+      Stat->Sample = Sample;
+      Stat->MaxSampleCount = MaxSampleCount;
+    }
+  }
+  if (Stat->SampleCount < Stat->MaxSampleCount) {
+    Stat->Sample[Stat->SampleCount++] = Latency;
+  }
+  ReleaseLoadLock ();
+}
+
+/**
+  Claim the next connection of the load, if the connection count and the duration are not reached.
+
+  @retval TRUE   the caller runs one more connection.
+  @retval FALSE  the load is complete.
+**/
+BOOLEAN
+LoadClaimConnection (
+  VOID
+  )
+{
+  BOOLEAN  Claimed;
+
+  AcquireLoadLock ();
+  Claimed = TRUE;
+  if ((mLoadConnectionCount != 0) && (mLoadConnectionStarted >= mLoadConnectionCount)) {
+    Claimed = FALSE;
+  }
+  if ((mLoadDuration != 0) && (LoadGetTime () - mLoadStartTime >= (UINT64)mLoadDuration * 1000000000ull)) {
+    Claimed = FALSE;
+  }
+  if (Claimed) {
+    mLoadConnectionStarted++;
+  }
+  ReleaseLoadLock ();
+  return Claimed;
+}
+
+/**
+  Run one SPDM session of the load, and its application record.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  UsePsk                       TRUE for a PSK_EXCHANGE session, FALSE for a KEY_EXCHANGE session.
+
+  @retval RETURN_SUCCESS               The session is started and stopped successfully.
+**/
+RETURN_STATUS
+LoadRunSession (
+  IN VOID             *SpdmContext,
+  IN BOOLEAN          UsePsk
+  )
+{
+  RETURN_STATUS  Status;
+  UINT32         SessionId;
+  UINT8          HeartbeatPeriod;
+  UINT8          MeasurementHash[MAX_HASH_SIZE];
+  UINT64         Start;
+
+  HeartbeatPeriod = 0;
+  MetricsCountSession (SpdmSessionStateHandshaking);
+  Start = LoadGetTime ();
+  Status = SpdmStartSession (
+             SpdmContext,
+             UsePsk,
+             mUseMeasurementSummaryHashType,
+             mUseSlotId,
+             &SessionId,
+             &HeartbeatPeriod,
+             MeasurementHash
+             );
+  LoadRecordPhase (UsePsk ? LOAD_PHASE_PSK : LOAD_PHASE_KEY_EX, LoadGetTime () - Start, (BOOLEAN)!RETURN_ERROR(Status));
+  if (RETURN_ERROR(Status)) {
+    MetricsCountSession (SpdmSessionStateNotStarted);
+    return Status;
+  }
+  MetricsCountSession (SpdmSessionStateEstablished);
+
+  if ((mLoadOperation & LOAD_OPERATION_APP) != 0) {
+    Start = LoadGetTime ();
+    Status = DoAppSessionViaSpdm (SpdmContext, SessionId);
+    LoadRecordPhase (LOAD_PHASE_APP, LoadGetTime () - Start, (BOOLEAN)!RETURN_ERROR(Status));
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+  }
+
+  Start = LoadGetTime ();
+  Status = SpdmStopSession (SpdmContext, SessionId, mEndSessionAttributes);
+  LoadRecordPhase (LOAD_PHASE_END_SESSION, LoadGetTime () - Start, (BOOLEAN)!RETURN_ERROR(Status));
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  MetricsCountSession (SpdmSessionStateNotStarted);
+
+  AcquireLoadLock ();
+  mLoadSessionCount++;
+  ReleaseLoadLock ();
+  return RETURN_SUCCESS;
+}
+
+/**
+  Run one connection of the load, with its own socket and SPDM context.
+
+  @param  PortNumber                   The port of the responder.
+
+  @retval TRUE   all the operations of the connection succeed.
+  @retval FALSE  one operation of the connection fails.
+**/
+BOOLEAN
+LoadRunConnection (
+  IN UINT16           PortNumber
+  )
+{
+  SOCKET         Socket;
+  VOID           *SpdmContext;
+  VOID           *PrivateKey;
+  RETURN_STATUS  Status;
+  BOOLEAN        Result;
+  UINT64         Start;
+  UINT8          SlotMask;
+  UINT8          TotalDigestBuffer[MAX_HASH_SIZE * MAX_SPDM_SLOT_COUNT];
+  UINT8          MeasurementHash[MAX_HASH_SIZE];
+  UINTN          CertChainSize;
+  UINT8          CertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+  UINT32         Response;
+  UINTN          ResponseSize;
+
+  Start = LoadGetTime ();
+  Result = InitClient (&Socket, PortNumber);
+  LoadRecordPhase (LOAD_PHASE_CONNECT, LoadGetTime () - Start, Result);
+  if (!Result) {
+    return FALSE;
+  }
+
+  PrivateKey = NULL;
+  SpdmContext = SpdmClientCreateContext (&Socket);
+  if (SpdmContext == NULL) {
+    closesocket (Socket);
+    return FALSE;
+  }
+
+  Start = LoadGetTime ();
+  Status = SpdmInitConnection (SpdmContext, FALSE);
+  LoadRecordPhase (LOAD_PHASE_VCA, LoadGetTime () - Start, (BOOLEAN)!RETURN_ERROR(Status));
+  if (RETURN_ERROR(Status)) {
+    goto Done;
+  }
+
+  //
+  // The negotiated algorithms are kept in globals used by the provisioning.
+  //
+  AcquireLoadLock ();
+  SpdmClientProvision (SpdmContext, &PrivateKey);
+  ReleaseLoadLock ();
+
+  if ((mLoadOperation & LOAD_OPERATION_AUTH) != 0) {
+    ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
+    CertChainSize = sizeof(CertChain);
+    ZeroMem (CertChain, sizeof(CertChain));
+    ZeroMem (MeasurementHash, sizeof(MeasurementHash));
+    Start = LoadGetTime ();
+    Status = SpdmAuthentication (SpdmContext, &SlotMask, TotalDigestBuffer, mUseSlotId, &CertChainSize, CertChain, mUseMeasurementSummaryHashType, MeasurementHash);
+    LoadRecordPhase (LOAD_PHASE_AUTH, LoadGetTime () - Start, (BOOLEAN)!RETURN_ERROR(Status));
+    if (RETURN_ERROR(Status)) {
+      goto Done;
+    }
+  }
+
+  if ((mLoadOperation & (LOAD_OPERATION_KEY_EX | LOAD_OPERATION_PSK | LOAD_OPERATION_APP)) != 0) {
+    if (mUseVersion < SPDM_MESSAGE_VERSION_11) {
+      Status = RETURN_UNSUPPORTED;
+      goto Done;
+    }
+    //
+    // An application record needs a session, and runs in a KEY_EXCHANGE session unless PSK is chosen.
+    //
+    if (((mLoadOperation & LOAD_OPERATION_KEY_EX) != 0) ||
+        ((mLoadOperation & (LOAD_OPERATION_PSK | LOAD_OPERATION_APP)) == LOAD_OPERATION_APP)) {
+      Status = LoadRunSession (SpdmContext, FALSE);
+      if (RETURN_ERROR(Status)) {
+        goto Done;
+      }
+    }
+    if ((mLoadOperation & LOAD_OPERATION_PSK) != 0) {
+      Status = LoadRunSession (SpdmContext, TRUE);
+      if (RETURN_ERROR(Status)) {
+        goto Done;
+      }
+    }
+  }
+
+Done:
+  ResponseSize = 0;
+  Result = CommunicatePlatformData (
+             Socket,
+             SOCKET_SPDM_COMMAND_CONTINUE,
+             NULL,
+             0,
+             &Response,
+             &ResponseSize,
+             NULL
+             );
+  closesocket (Socket);
+  MetricsCollect (SpdmContext, NULL);
+  free (SpdmContext);
+  if (PrivateKey != NULL) {
+    SpdmRequesterDataReleaseKeyFunc (mUseReqAsymAlgo, PrivateKey);
+  }
+  return (BOOLEAN)(!RETURN_ERROR(Status) && Result);
+}
+
+/**
+  Run the connections of the load, until the load is complete.
+**/
+#ifdef _MSC_VER
+DWORD
+WINAPI
+#else
+VOID *
+#endif
+LoadWorkerThread (
+  IN VOID             *Context
+  )
+{
+  UINT16   PortNumber;
+  BOOLEAN  Result;
+
+  PortNumber = (UINT16)(UINTN)Context;
+  while (LoadClaimConnection ()) {
+    Result = LoadRunConnection (PortNumber);
+    AcquireLoadLock ();
+    if (Result) {
+      mLoadConnectionSucceeded++;
+    } else {
+      mLoadConnectionFailed++;
+    }
+    ReleaseLoadLock ();
+  }
+  return 0;
+}
+
+/**
+  Check if a state of the async connection is selected by --load_op.
+**/
+BOOLEAN
+LoadAsyncIsStateSelected (
+  IN UINTN            State
+  )
+{
+  BOOLEAN  UseKeyEx;
+
+  //
+  // An application record needs a session, and runs in a KEY_EXCHANGE session unless PSK is chosen.
+  //
+  UseKeyEx = (BOOLEAN)(((mLoadOperation & LOAD_OPERATION_KEY_EX) != 0) ||
+                       ((mLoadOperation & (LOAD_OPERATION_PSK | LOAD_OPERATION_APP)) == LOAD_OPERATION_APP));
+  switch (State) {
+  case LOAD_ASYNC_STATE_DIGEST:
+    return (BOOLEAN)(((mLoadOperation & LOAD_OPERATION_AUTH) != 0) && ((mExeConnection & EXE_CONNECTION_DIGEST) != 0));
+  case LOAD_ASYNC_STATE_CERT:
+    return (BOOLEAN)(((mLoadOperation & LOAD_OPERATION_AUTH) != 0) && ((mExeConnection & EXE_CONNECTION_CERT) != 0) && (mUseSlotId != 0xFF));
+  case LOAD_ASYNC_STATE_CHAL:
+    return (BOOLEAN)(((mLoadOperation & LOAD_OPERATION_AUTH) != 0) && ((mExeConnection & EXE_CONNECTION_CHAL) != 0));
+  case LOAD_ASYNC_STATE_KEY_EX:
+    return UseKeyEx;
+  case LOAD_ASYNC_STATE_KEY_EX_APP:
+    return (BOOLEAN)(UseKeyEx && ((mLoadOperation & LOAD_OPERATION_APP) != 0));
+  case LOAD_ASYNC_STATE_PSK:
+    return (BOOLEAN)((mLoadOperation & LOAD_OPERATION_PSK) != 0);
+  case LOAD_ASYNC_STATE_PSK_APP:
+    return (BOOLEAN)((mLoadOperation & (LOAD_OPERATION_PSK | LOAD_OPERATION_APP)) == (LOAD_OPERATION_PSK | LOAD_OPERATION_APP));
+  default:
+    return TRUE;
+  }
+}
+
+/**
+  Return the phase measured in a state of the async connection.
+**/
+UINTN
+LoadAsyncGetPhase (
+  IN UINTN            State
+  )
+{
+  switch (State) {
+  case LOAD_ASYNC_STATE_VCA:
+    return LOAD_PHASE_VCA;
+  case LOAD_ASYNC_STATE_DIGEST:
+  case LOAD_ASYNC_STATE_CERT:
+  case LOAD_ASYNC_STATE_CHAL:
+    return LOAD_PHASE_AUTH;
+  case LOAD_ASYNC_STATE_KEY_EX:
+    return LOAD_PHASE_KEY_EX;
+  case LOAD_ASYNC_STATE_PSK:
+    return LOAD_PHASE_PSK;
+  default:
+    return LOAD_PHASE_APP;
+  }
+}
+
+/**
+  Drive the operation of an async connection by one message, and queue the outgoing message.
+
+  The incoming message is the payload in the receive buffer of the async I/O backend,
+  and the outgoing message is built in its send buffer.
+
+  @param  Connection                   A pointer to the async connection.
+  @param  IncomingMessageSize          Size in bytes of the incoming message.
+  @param  IncomingMessage              A pointer to the incoming message, or NULL for the first message of the operation.
+
+  @retval RETURN_NOT_READY             The outgoing message is queued.
+  @retval RETURN_SUCCESS               The operation completes.
+  @retval others                       The operation fails.
+**/
+RETURN_STATUS
+LoadAsyncStep (
+  IN SPDM_LOAD_ASYNC_CONNECTION  *Connection,
+  IN UINTN                       IncomingMessageSize,
+  IN VOID                        *IncomingMessage OPTIONAL
+  )
+{
+  RETURN_STATUS  Status;
+  UINT8          *OutgoingMessage;
+  UINTN          OutgoingMessageSize;
+
+  OutgoingMessage = AsyncIoGetSendBuffer (Connection->Connection, &OutgoingMessageSize);
+  Status = SpdmRequesterStep (Connection->SpdmContext, IncomingMessageSize, IncomingMessage, &OutgoingMessageSize, OutgoingMessage);
+  if (Status != RETURN_NOT_READY) {
+    return Status;
+  }
+  if (!AsyncIoQueueSend (Connection->Connection, SOCKET_SPDM_COMMAND_NORMAL, OutgoingMessageSize) ||
+      !AsyncIoQueueReceive (Connection->Connection)) {
+    SpdmRequesterAbort (Connection->SpdmContext);
+    return RETURN_DEVICE_ERROR;
+  }
+  return RETURN_NOT_READY;
+}
+
+/**
+  Start the operations of the async connection from its current state, until one message is queued.
+
+  The connection goes to LOAD_ASYNC_STATE_END, and queues CONTINUE, once all the operations are done or one fails.
+  The consecutive states of one phase, such as GET_DIGESTS, GET_CERTIFICATE and CHALLENGE of AUTH, are measured together.
+
+  @param  Connection                   A pointer to the async connection.
+  @param  Status                       The result of the operation of the current state,
+                                       or RETURN_NOT_STARTED if the operation of the current state is not started.
+
+  @retval TRUE   one message is queued.
+  @retval FALSE  no message can be queued, and the connection is finished by the caller.
+**/
+BOOLEAN
+LoadAsyncAdvance (
+  IN SPDM_LOAD_ASYNC_CONNECTION  *Connection,
+  IN RETURN_STATUS               Status
+  )
+{
+  BOOLEAN        IsApp;
+  VOID           *Request;
+  UINTN          RequestSize;
+  UINTN          Phase;
+  BOOLEAN        SamePhase;
+
+  while (TRUE) {
+    SamePhase = FALSE;
+    if (Status != RETURN_NOT_STARTED) {
+      Phase = LoadAsyncGetPhase (Connection->State);
+      if ((Connection->State == LOAD_ASYNC_STATE_KEY_EX) || (Connection->State == LOAD_ASYNC_STATE_PSK)) {
+        MetricsCountSession (RETURN_ERROR(Status) ? SpdmSessionStateNotStarted : SpdmSessionStateEstablished);
+      }
+      if (RETURN_ERROR(Status)) {
+        LoadRecordPhase (Phase, LoadGetTime () - Connection->Start, FALSE);
+        Connection->Failed = TRUE;
+        break;
+      }
+      if (Connection->State == LOAD_ASYNC_STATE_VCA) {
+        SpdmClientProvision (Connection->SpdmContext, &Connection->PrivateKey);
+      }
+      if ((Connection->State == LOAD_ASYNC_STATE_KEY_EX) || (Connection->State == LOAD_ASYNC_STATE_PSK)) {
+        mLoadSessionCount++;
+        Connection->SessionCount++;
+      }
+      do {
+        Connection->State++;
+      } while ((Connection->State < LOAD_ASYNC_STATE_END) && !LoadAsyncIsStateSelected (Connection->State));
+      SamePhase = (BOOLEAN)((Connection->State < LOAD_ASYNC_STATE_END) && (LoadAsyncGetPhase (Connection->State) == Phase));
+      if (!SamePhase) {
+        LoadRecordPhase (Phase, LoadGetTime () - Connection->Start, TRUE);
+      }
+      if (Connection->State == LOAD_ASYNC_STATE_END) {
+        break;
+      }
+      if ((Connection->State >= LOAD_ASYNC_STATE_KEY_EX) && (mUseVersion < SPDM_MESSAGE_VERSION_11)) {
+        Connection->Failed = TRUE;
+        break;
+      }
+    }
+
+    switch (Connection->State) {
+    case LOAD_ASYNC_STATE_VCA:
+      Status = SpdmRequesterBeginInitConnection (Connection->SpdmContext, FALSE);
+      break;
+    case LOAD_ASYNC_STATE_DIGEST:
+      ZeroMem (Connection->TotalDigestBuffer, sizeof(Connection->TotalDigestBuffer));
+      Status = SpdmRequesterBeginGetDigest (Connection->SpdmContext, &Connection->SlotMask, Connection->TotalDigestBuffer);
+      break;
+    case LOAD_ASYNC_STATE_CERT:
+      Connection->CertChainSize = sizeof(Connection->CertChain);
+      Status = SpdmRequesterBeginGetCertificate (Connection->SpdmContext, mUseSlotId, &Connection->CertChainSize, Connection->CertChain);
+      break;
+    case LOAD_ASYNC_STATE_CHAL:
+      ZeroMem (Connection->MeasurementHash, sizeof(Connection->MeasurementHash));
+      Status = SpdmRequesterBeginChallenge (Connection->SpdmContext, mUseSlotId, mUseMeasurementSummaryHashType, Connection->MeasurementHash);
+      break;
+    case LOAD_ASYNC_STATE_KEY_EX:
+    case LOAD_ASYNC_STATE_PSK:
+      Connection->HeartbeatPeriod = 0;
+      MetricsCountSession (SpdmSessionStateHandshaking);
+      Status = SpdmRequesterBeginStartSession (
+                 Connection->SpdmContext,
+                 (BOOLEAN)(Connection->State == LOAD_ASYNC_STATE_PSK),
+                 mUseMeasurementSummaryHashType,
+                 mUseSlotId,
+                 &Connection->SessionId,
+                 &Connection->HeartbeatPeriod,
+                 Connection->MeasurementHash
+                 );
+      break;
+    default:
+      if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_PCI_DOE) {
+        IsApp = FALSE;
+        Request = &mVendorDefinedRequest;
+        RequestSize = sizeof(mVendorDefinedRequest);
+      } else {
+        IsApp = TRUE;
+        Request = &mSecureSessionRequest;
+        RequestSize = sizeof(mSecureSessionRequest);
+      }
+      Connection->AppResponseSize = sizeof(Connection->AppResponse);
+      Status = SpdmRequesterBeginSendReceiveData (
+                 Connection->SpdmContext,
+                 &Connection->SessionId,
+                 IsApp,
+                 Request,
+                 RequestSize,
+                 Connection->AppResponse,
+                 &Connection->AppResponseSize
+                 );
+      break;
+    }
+    if (!SamePhase) {
+      Connection->Start = LoadGetTime ();
+    }
+    if (!RETURN_ERROR(Status)) {
+      Status = LoadAsyncStep (Connection, 0, NULL);
+      if (Status == RETURN_NOT_READY) {
+        return TRUE;
+      }
+    }
+  }
+
+  Connection->State = LOAD_ASYNC_STATE_END;
+  if (!AsyncIoQueueSend (Connection->Connection, SOCKET_SPDM_COMMAND_CONTINUE, 0) ||
+      !AsyncIoQueueReceive (Connection->Connection)) {
+    Connection->Failed = TRUE;
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Release the socket and the SPDM context of an async connection, and count its result.
+**/
+VOID
+LoadAsyncFinish (
+  IN SPDM_LOAD_ASYNC_CONNECTION  *Connection
+  )
+{
+  if (Connection->Connection != NULL) {
+    AsyncIoRemoveConnection (Connection->Connection);
+    Connection->Connection = NULL;
+  }
+  closesocket (Connection->Socket);
+  for (; Connection->SessionCount > 0; Connection->SessionCount--) {
+    MetricsCountSession (SpdmSessionStateNotStarted);
+  }
+  if (Connection->SpdmContext != NULL) {
+    MetricsCollect (Connection->SpdmContext, NULL);
+  }
+  free (Connection->SpdmContext);
+  Connection->SpdmContext = NULL;
+  if (Connection->PrivateKey != NULL) {
+    SpdmRequesterDataReleaseKeyFunc (mUseReqAsymAlgo, Connection->PrivateKey);
+    Connection->PrivateKey = NULL;
+  }
+  if (Connection->Failed) {
+    mLoadConnectionFailed++;
+  } else {
+    mLoadConnectionSucceeded++;
+  }
+}
+
+/**
+  Start the next connection of the load in an async connection slot.
+
+  @retval TRUE   the connection is started, and its first message is queued.
+  @retval FALSE  the load is complete.
+**/
+BOOLEAN
+LoadAsyncStart (
+  IN SPDM_LOAD_ASYNC_CONNECTION  *Connection,
+  IN UINT16                      PortNumber
+  )
+{
+  BOOLEAN  Result;
+  UINT64   Start;
+
+  while (LoadClaimConnection ()) {
+    Start = LoadGetTime ();
+    Result = InitClient (&Connection->Socket, PortNumber);
+    LoadRecordPhase (LOAD_PHASE_CONNECT, LoadGetTime () - Start, Result);
+    if (!Result) {
+      mLoadConnectionFailed++;
+      continue;
+    }
+    Connection->Failed = FALSE;
+    Connection->PrivateKey = NULL;
+    Connection->SessionCount = 0;
+    Connection->State = LOAD_ASYNC_STATE_VCA;
+    Connection->SpdmContext = SpdmClientCreateContext (&Connection->Socket);
+    Connection->Connection = AsyncIoAddConnection (Connection->Socket, Connection);
+    if ((Connection->SpdmContext == NULL) || (Connection->Connection == NULL)) {
+      Connection->Failed = TRUE;
+      LoadAsyncFinish (Connection);
+      continue;
+    }
+    if (!LoadAsyncAdvance (Connection, RETURN_NOT_STARTED)) {
+      LoadAsyncFinish (Connection);
+      continue;
+    }
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/**
+  Drive --load_parallel connections from one thread with the async I/O backend,
+  so that the number of the parallel connections is not bound by the number of the threads.
+
+  @param  PortNumber                   The port of the responder.
+
+  @retval TRUE   the load is run.
+  @retval FALSE  the async I/O backend cannot be used.
+**/
+BOOLEAN
+LoadRunAsync (
+  IN UINT16           PortNumber
+  )
+{
+  SPDM_LOAD_ASYNC_CONNECTION  *Connection;
+  SPDM_LOAD_ASYNC_CONNECTION  *Slot;
+  ASYNC_IO_EVENT              Events[LOAD_ASYNC_EVENT_COUNT];
+  UINT32                      EventCount;
+  UINT32                      Index;
+  UINT32                      ActiveCount;
+  RETURN_STATUS               Status;
+
+  if (!AsyncIoInit ((mLoadIo == LOAD_IO_URING) ? ASYNC_IO_BACKEND_URING : ASYNC_IO_BACKEND_EPOLL, mLoadParallelCount)) {
+    return FALSE;
+  }
+  printf ("Load async I/O - %s\n", (AsyncIoGetBackend () == ASYNC_IO_BACKEND_URING) ? "io_uring" : "epoll");
+
+  Connection = calloc (mLoadParallelCount, sizeof(SPDM_LOAD_ASYNC_CONNECTION));
+  if (Connection == NULL) {
+    AsyncIoClose ();
+    return FALSE;
+  }
+
+  ActiveCount = 0;
+  for (Index = 0; Index < mLoadParallelCount; Index++) {
+    if (!LoadAsyncStart (&Connection[Index], PortNumber)) {
+      break;
+    }
+    ActiveCount++;
+  }
+
+  while (ActiveCount != 0) {
+    EventCount = AsyncIoWait (Events, ARRAY_SIZE(Events));
+    if (EventCount == 0) {
+      break;
+    }
+    for (Index = 0; Index < EventCount; Index++) {
+      Slot = Events[Index].Context;
+      if (!Events[Index].Result) {
+        if (Slot->State != LOAD_ASYNC_STATE_END) {
+          SpdmRequesterAbort (Slot->SpdmContext);
+          LoadRecordPhase (LoadAsyncGetPhase (Slot->State), 0, FALSE);
+        }
+        Slot->Failed = TRUE;
+      } else if (Slot->State != LOAD_ASYNC_STATE_END) {
+        Status = LoadAsyncStep (Slot, Events[Index].PayloadSize, Events[Index].Payload);
+        if ((Status == RETURN_NOT_READY) || LoadAsyncAdvance (Slot, Status)) {
+          continue;
+        }
+      }
+      LoadAsyncFinish (Slot);
+      ActiveCount--;
+      if (LoadAsyncStart (Slot, PortNumber)) {
+        ActiveCount++;
+      }
+    }
+  }
+
+  for (Index = 0; Index < mLoadParallelCount; Index++) {
+    if (Connection[Index].SpdmContext != NULL) {
+      Connection[Index].Failed = TRUE;
+      LoadAsyncFinish (&Connection[Index]);
+    }
+  }
+  free (Connection);
+  AsyncIoClose ();
+  return TRUE;
+}
+
+int
+LoadCompareSample (
+  IN CONST VOID       *Left,
+  IN CONST VOID       *Right
+  )
+{
+  UINT64  LeftSample;
+  UINT64  RightSample;
+
+  LeftSample = *(CONST UINT64 *)Left;
+  RightSample = *(CONST UINT64 *)Right;
+  if (LeftSample < RightSample) {
+    return -1;
+  }
+  return (LeftSample > RightSample) ? 1 : 0;
+}
+
+/**
+  Return a percentile of the sorted latency samples of a phase, in microseconds.
+
+  @param  Stat                         A pointer to the phase statistics.
+  @param  PerMille                     The percentile, in per mille.
+**/
+double
+LoadGetPercentile (
+  IN SPDM_LOAD_PHASE_STAT  *Stat,
+  IN UINTN                 PerMille
+  )
+{
+  UINTN  Index;
+
+  Index = (Stat->SampleCount * PerMille) / 1000;
+  if (Index >= Stat->SampleCount) {
+    Index = Stat->SampleCount - 1;
+  }
+  return (double)Stat->Sample[Index] / 1000.0;
+}
+
+/**
+  Print the throughput, the latency percentiles of each phase and the CPU cost of the load.
+
+  @param  Elapsed                      The wall time of the load, in nanoseconds.
+  @param  CpuTime                      The CPU time used by the requester process during the load, in nanoseconds.
+**/
+VOID
+LoadPrintReport (
+  IN UINT64           Elapsed,
+  IN UINT64           CpuTime
+  )
+{
+  UINTN                 Phase;
+  SPDM_LOAD_PHASE_STAT  *Stat;
+  double                Seconds;
+  UINT32                Operations;
+
+  Seconds = (double)Elapsed / 1000000000.0;
+  if (Seconds <= 0) {
+    Seconds = 1e-9;
+  }
+  printf ("Load report - %d parallel connection(s), %.3f second(s)\n", mLoadParallelCount, Seconds);
+  printf ("  connections: %d succeeded, %d failed, %.1f/s\n",
+    mLoadConnectionSucceeded, mLoadConnectionFailed, (double)mLoadConnectionSucceeded / Seconds);
+  printf ("  sessions:    %d, %.1f/s\n", mLoadSessionCount, (double)mLoadSessionCount / Seconds);
+  printf ("  %-12s %10s %8s %12s %12s %12s\n", "phase", "count", "failed", "p50(us)", "p99(us)", "p99.9(us)");
+  for (Phase = 0; Phase < LOAD_PHASE_COUNT; Phase++) {
+    Stat = &mLoadPhaseStat[Phase];
+    if ((Stat->Count == 0) && (Stat->FailureCount == 0)) {
+      continue;
+    }
+    if (Stat->SampleCount == 0) {
+      printf ("  %-12s %10d %8d\n", mLoadPhaseName[Phase], (UINT32)Stat->Count, (UINT32)Stat->FailureCount);
+      continue;
+    }
+    qsort (Stat->Sample, Stat->SampleCount, sizeof(UINT64), LoadCompareSample);
+    printf ("  %-12s %10d %8d %12.1f %12.1f %12.1f\n",
+      mLoadPhaseName[Phase], (UINT32)Stat->Count, (UINT32)Stat->FailureCount,
+      LoadGetPercentile (Stat, 500), LoadGetPercentile (Stat, 990), LoadGetPercentile (Stat, 999));
+  }
+
+  Operations = mLoadConnectionSucceeded + mLoadConnectionFailed;
+  if (Operations != 0) {
+    printf ("  requester CPU: %.1f us/connection", (double)CpuTime / 1000.0 / (double)Operations);
+    if (mLoadSessionCount != 0) {
+      printf (", %.1f us/session", (double)CpuTime / 1000.0 / (double)mLoadSessionCount);
+    }
+    printf (", %.1f%% of one core\n", (double)CpuTime * 100.0 / (double)Elapsed);
+  }
+}
+
+/**
+  Drive the responder with the connections and the sessions chosen by --load_op,
+  from --load_parallel workers or async connections, until --load_conn connections are run or --load_duration is over.
+
+  @param  PortNumber                   The port of the responder.
+
+  @retval TRUE   all the connections succeed.
+  @retval FALSE  a worker cannot be started, or one connection fails.
+**/
+BOOLEAN
+PlatformLoadRoutine (
+  IN UINT16 PortNumber
+  )
+{
+  UINT32     Index;
+  UINT32     ThreadCount;
+  UINT64     CpuTime;
+  UINT64     Elapsed;
+  UINTN      Phase;
+  BOOLEAN    Result;
+#ifdef _MSC_VER
+  HANDLE     *Thread;
+  WSADATA    Ws;
+
+  if (WSAStartup(MAKEWORD(2,2), &Ws) != 0) {
+    printf ("Init Windows Socket Failed - %x\n", WSAGetLastError());
+    return FALSE;
+  }
+  InitializeCriticalSection (&mLoadLock);
+#else
+  pthread_t  *Thread;
+#endif
+
+  //
+  // The dumps of each message would dominate the cost being measured.
+  //
+  mDumpPlatformData = FALSE;
+
+  Thread = NULL;
+  if (mLoadIo == LOAD_IO_THREAD) {
+    Thread = (VOID *)malloc (mLoadParallelCount * sizeof(*Thread));
+    if (Thread == NULL) {
+      return FALSE;
+    }
+  }
+
+  printf ("Load started - %d parallel connection(s)\n", mLoadParallelCount);
+  mLoadStartTime = LoadGetTime ();
+  CpuTime = LoadGetProcessCpuTime ();
+  ThreadCount = 0;
+  for (Index = 0; (Thread != NULL) && (Index < mLoadParallelCount); Index++) {
+#ifdef _MSC_VER
+    Thread[ThreadCount] = CreateThread (NULL, 0, LoadWorkerThread, (VOID *)(UINTN)PortNumber, 0, NULL);
+    if (Thread[ThreadCount] == NULL) {
+      printf ("Create load worker fail\n");
+      break;
+    }
+#else
+    if (pthread_create (&Thread[ThreadCount], NULL, LoadWorkerThread, (VOID *)(UINTN)PortNumber) != 0) {
+      printf ("Create load worker fail\n");
+      break;
+    }
+#endif
+    ThreadCount++;
+  }
+  for (Index = 0; Index < ThreadCount; Index++) {
+#ifdef _MSC_VER
+    WaitForSingleObject (Thread[Index], INFINITE);
+    CloseHandle (Thread[Index]);
+#else
+    pthread_join (Thread[Index], NULL);
+#endif
+  }
+  if (Thread != NULL) {
+    Result = (BOOLEAN)(ThreadCount == mLoadParallelCount);
+  } else {
+    Result = LoadRunAsync (PortNumber);
+  }
+  Elapsed = LoadGetTime () - mLoadStartTime;
+  CpuTime = LoadGetProcessCpuTime () - CpuTime;
+  free (Thread);
+
+  LoadPrintReport (Elapsed, CpuTime);
+  for (Phase = 0; Phase < LOAD_PHASE_COUNT; Phase++) {
+    if (mLoadPhaseStat[Phase].Sample != NULL) {
+      free (mLoadPhaseStat[Phase].Sample);
+    }
+  }
+
+#ifdef _MSC_VER
+  DeleteCriticalSection (&mLoadLock);
+  WSACleanup();
+#endif
+
+  return (BOOLEAN)(Result && (mLoadConnectionFailed == 0));
+}
@@ -68,49 +68,110 @@ SECURE_SESSION_REQUEST_MINE  mSecureSessionRequest = {
   },
 };
 
+#define PLDM_REQUEST_PIPELINE_DEPTH    4
+#define IDE_KM_REQUEST_PIPELINE_DEPTH  16
+
+VOID
+EFIAPI
+PldmGetTidCompletion (
+  IN     VOID                 *CompletionContext,
+  IN     RETURN_STATUS        Status,
+  IN     UINT8                InstanceId,
+  IN     UINT8                PldmType,
+  IN     UINT8                PldmCommandCode,
+  IN     UINT8                PldmCompletionCode,
+  IN     UINTN                ResponseDataSize,
+  IN     VOID                 *ResponseData
+  )
+{
+  UINTN  *CompletedCount;
+
+  ASSERT_RETURN_ERROR(Status);
+  ASSERT (PldmType == PLDM_MESSAGE_TYPE_CONTROL_DISCOVERY);
+  ASSERT (PldmCommandCode == PLDM_CONTROL_DISCOVERY_COMMAND_GET_TID);
+  ASSERT (PldmCompletionCode == PLDM_BASE_CODE_SUCCESS);
+  ASSERT (ResponseDataSize == sizeof(UINT8));
+
+  CompletedCount = CompletionContext;
+  if (!RETURN_ERROR(Status) && (PldmCompletionCode == PLDM_BASE_CODE_SUCCESS)) {
+    (*CompletedCount)++;
+  }
+}
+
 RETURN_STATUS
 DoAppSessionViaSpdm (
+  IN VOID                            *SpdmContext,
   IN UINT32                          SessionId
   )
 {
-  VOID                               *SpdmContext;
   RETURN_STATUS                      Status;
-  SPDM_VENDOR_DEFINED_REQUEST_MINE   Request;
-  UINTN                              RequestSize;
-  SPDM_VENDOR_DEFINED_RESPONSE_MINE  Response;
-  UINTN                              ResponseSize;
-  SECURE_SESSION_RESPONSE_MINE       AppResponse;
-  UINTN                              AppResponseSize;
-
-  SpdmContext = mSpdmContext;
+  PCI_IDE_KM_QUERY_RESP              QueryResp[8];
+  SPDM_PCI_IDE_KM_STREAM             IdeStream[8];
+  UINTN                              PortCount;
+  VOID                               *PldmRequester;
+  UINTN                              CompletedCount;
+  UINTN                              Index;
 
   if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_PCI_DOE) {
-    CopyMem (&Request, &mVendorDefinedRequest, sizeof(Request));
-
-    RequestSize = sizeof(Request);
-    ResponseSize = sizeof(Response);
-    Status = SpdmSendReceiveData (SpdmContext, &SessionId, FALSE, &Request, RequestSize, &Response, &ResponseSize);
+    PortCount = ARRAY_SIZE(QueryResp);
+    Status = SpdmPciIdeKmQueryPorts (SpdmContext, SessionId, IDE_KM_REQUEST_PIPELINE_DEPTH, &PortCount, QueryResp);
     ASSERT_RETURN_ERROR(Status);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
 
-    ASSERT (ResponseSize == sizeof(SPDM_VENDOR_DEFINED_RESPONSE_MINE));
-    ASSERT (Response.Header.RequestResponseCode == SPDM_VENDOR_DEFINED_RESPONSE);
-    ASSERT (Response.StandardID == SPDM_REGISTRY_ID_PCISIG);
-    ASSERT (Response.VendorID == SPDM_VENDOR_ID_PCISIG);
-    ASSERT (Response.PayloadLength == sizeof(PCI_PROTOCOL_HEADER) + sizeof(PCI_IDE_KM_QUERY_RESP));
-    ASSERT (Response.PciProtocol.ProtocolId == PCI_PROTOCAL_ID_IDE_KM);
-    ASSERT (Response.PciIdeKmQueryResp.Header.ObjectId == PCI_IDE_KM_OBJECT_ID_QUERY_RESP);
+    //
+    // Key stream 0 of every port, with all keys in flight at once.
+    //
+    for (Index = 0; Index < PortCount; Index++) {
+      IdeStream[Index].PortIndex = QueryResp[Index].PortIndex;
+      IdeStream[Index].StreamId = 0;
+    }
+    Status = SpdmPciIdeKmProgramStreams (SpdmContext, SessionId, 0, IdeStream, PortCount, IDE_KM_REQUEST_PIPELINE_DEPTH);
+    ASSERT_RETURN_ERROR(Status);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
   }
 
   if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_MCTP) {
-    AppResponseSize = sizeof(AppResponse);
-    Status = SpdmSendReceiveData (SpdmContext, &SessionId, TRUE, &mSecureSessionRequest, sizeof(mSecureSessionRequest), &AppResponse, &AppResponseSize);
+    PldmRequester = (VOID *)malloc (SpdmPldmRequesterGetSize ());
+    if (PldmRequester == NULL) {
+      return RETURN_OUT_OF_RESOURCES;
+    }
+    Status = SpdmPldmRequesterInit (PldmRequester, SpdmContext, SessionId, PLDM_REQUEST_PIPELINE_DEPTH);
     ASSERT_RETURN_ERROR(Status);
 
-    ASSERT (AppResponseSize == sizeof(AppResponse));
-    ASSERT (AppResponse.MctpHeader.MessageType == MCTP_MESSAGE_TYPE_PLDM);
-    ASSERT (AppResponse.PldmHeader.PldmType == PLDM_MESSAGE_TYPE_CONTROL_DISCOVERY);
-    ASSERT (AppResponse.PldmHeader.PldmCommandCode == PLDM_CONTROL_DISCOVERY_COMMAND_GET_TID);
-    ASSERT (AppResponse.PldmResponseHeader.PldmCompletionCode == PLDM_BASE_CODE_SUCCESS);
+    //
+    // Keep the pipeline full, then drain the responses in whatever order they arrive.
+    //
+    CompletedCount = 0;
+    for (Index = 0; Index < PLDM_REQUEST_PIPELINE_DEPTH; Index++) {
+      Status = SpdmPldmSendRequest (
+                 PldmRequester,
+                 PLDM_MESSAGE_TYPE_CONTROL_DISCOVERY,
+                 PLDM_CONTROL_DISCOVERY_COMMAND_GET_TID,
+                 NULL,
+                 0,
+                 PldmGetTidCompletion,
+                 &CompletedCount,
+                 NULL
+                 );
+      ASSERT_RETURN_ERROR(Status);
+      if (RETURN_ERROR(Status)) {
+        break;
+      }
+    }
+    Status = SpdmPldmRequesterFlush (PldmRequester);
+    ASSERT_RETURN_ERROR(Status);
+    if (RETURN_ERROR(Status)) {
+      SpdmPldmRequesterAbort (PldmRequester);
+    }
+    free (PldmRequester);
+    if (RETURN_ERROR(Status)) {
+      return Status;
+    }
+    ASSERT (CompletedCount == PLDM_REQUEST_PIPELINE_DEPTH);
   }
 
   return RETURN_SUCCESS;
@@ -134,6 +195,7 @@ DoSessionViaSpdm (
 
   HeartbeatPeriod = 0;
   ZeroMem(MeasurementHash, sizeof(MeasurementHash));
+  MetricsCountSession (SpdmSessionStateHandshaking);
   Status = SpdmStartSession (
              SpdmContext,
              UsePsk,
@@ -145,10 +207,12 @@ DoSessionViaSpdm (
              );
   if (RETURN_ERROR(Status)) {
     printf ("SpdmStartSession - %x\n", (UINT32)Status);
+    MetricsCountSession (SpdmSessionStateNotStarted);
     return Status;
   }
+  MetricsCountSession (SpdmSessionStateEstablished);
 
-  DoAppSessionViaSpdm (SessionId);
+  DoAppSessionViaSpdm (SpdmContext, SessionId);
 
   if ((mExeSession & EXE_SESSION_HEARTBEAT) != 0) {
     Status = SpdmHeartbeat (SpdmContext, SessionId);
@@ -213,6 +277,18 @@ DoSessionViaSpdm (
       printf ("SpdmStopSession - %x\n", (UINT32)Status);
       return Status;
     }
+    MetricsCountSession (SpdmSessionStateNotStarted);
+
+    //
+    // The responder preserves the negotiated state too, if it has CACHE_CAP.
+    //
+    if (mSaveStateFileName != NULL) {
+      if ((mEndSessionAttributes & SPDM_END_SESSION_REQUEST_ATTRIBUTES_PRESERVE_NEGOTIATED_STATE_CLEAR) != 0) {
+        SpdmClearNegotiatedState (SpdmContext);
+      } else {
+        SpdmSaveNegotiatedState (SpdmContext, TRUE);
+      }
+    }
   }
 
   return Status;
@@ -9,14 +9,6 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmResponderEmu.h"
 
-VOID                              *mSpdmContext;
-
-extern UINT32 mCommand;
-extern UINTN  mReceiveBufferSize;
-extern UINT8  mReceiveBuffer[MAX_SPDM_MESSAGE_BUFFER_SIZE];
-
-extern SOCKET mServerSocket;
-
 /**
   Notify the session state to a session APP.
 
@@ -57,6 +49,104 @@ SpdmGetResponseVendorDefinedRequest (
      OUT VOID                 *Response
   );
 
+RETURN_STATUS
+EFIAPI
+SpdmPciIdeKmPayloadCallback (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT16               StandardId,
+  IN     UINT8                VendorIdLen,
+  IN     CONST VOID           *VendorId,
+  IN     UINTN                RequestPayloadSize,
+  IN     CONST VOID           *RequestPayload,
+  IN OUT UINTN                *ResponsePayloadSize,
+     OUT VOID                 *ResponsePayload
+  );
+
+BOOLEAN                       mTraceReceived;
+UINT64                        mTraceReceiveTime;
+UINTN                         mTraceRequestSize;
+UINT8                         mTraceRequestCode;
+BOOLEAN                       mTraceIsSecured;
+UINT32                        mTraceSessionId;
+BOOLEAN                       mTraceStatsValid;
+SPDM_RESPONDER_STATS          mTraceStats;
+SPDM_RESPONDER_STATS          mTraceNewStats;
+
+/**
+  Return the time used by the responder statistics for the trace, in 100ns units.
+**/
+UINT64
+EFIAPI
+SpdmTraceResponderGetTime (
+  IN     VOID                 *SpdmContext
+  )
+{
+  return TraceGetTime () / 100;
+}
+
+/**
+  Take a snapshot of the responder statistics, if they are supported.
+**/
+BOOLEAN
+SpdmTraceGetStats (
+  IN     VOID                 *SpdmContext,
+  OUT    SPDM_RESPONDER_STATS *Stats
+  )
+{
+  SPDM_DATA_PARAMETER          Parameter;
+  UINTN                        DataSize;
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  DataSize = sizeof(*Stats);
+  return (BOOLEAN)!RETURN_ERROR(SpdmGetData (SpdmContext, SpdmDataResponderStats, &Parameter, Stats, &DataSize));
+}
+
+/**
+  Append the trace event of the request being answered.
+
+  The request code of a secured message and the crypto and callback time are taken from the change of the
+  responder statistics since the request was received.
+**/
+VOID
+SpdmTraceResponse (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                ResponseSize
+  )
+{
+  UINT64   SendTime;
+  UINT64   CryptoTime;
+  UINT64   CallbackTime;
+  UINTN    Index;
+
+  SendTime = TraceGetTime ();
+  CryptoTime = TRACE_TIME_UNKNOWN;
+  CallbackTime = TRACE_TIME_UNKNOWN;
+  if (mTraceStatsValid && SpdmTraceGetStats (SpdmContext, &mTraceNewStats)) {
+    for (Index = 0; Index < SPDM_RESPONDER_STATS_REQUEST_CODE_COUNT; Index++) {
+      if (mTraceNewStats.Request[Index].RequestCount != mTraceStats.Request[Index].RequestCount) {
+        mTraceRequestCode = (UINT8)(0x80 + Index);
+        CryptoTime = (mTraceNewStats.Request[Index].CryptoTime - mTraceStats.Request[Index].CryptoTime) * 100;
+        CallbackTime = (mTraceNewStats.Request[Index].CallbackTime - mTraceStats.Request[Index].CallbackTime) * 100;
+        break;
+      }
+    }
+  }
+
+  TraceAppendMessage (
+    TRACE_TRACK_RESPONDER,
+    mTraceReceiveTime,
+    SendTime,
+    mTraceRequestCode,
+    mTraceIsSecured ? &mTraceSessionId : NULL,
+    mTraceRequestSize,
+    ResponseSize,
+    CryptoTime,
+    CallbackTime
+    );
+}
+
 RETURN_STATUS
 EFIAPI
 SpdmDeviceSendMessage (
@@ -66,9 +156,16 @@ SpdmDeviceSendMessage (
   IN     UINT64                                 Timeout
   )
 {
-  BOOLEAN Result;
+  SPDM_EMU_CONNECTION  *Connection;
+  BOOLEAN              Result;
+
+  if ((mTraceFileName != NULL) && mTraceReceived) {
+    mTraceReceived = FALSE;
+    SpdmTraceResponse (SpdmContext, RequestSize);
+  }
 
-  Result = SendPlatformData (mServerSocket, SOCKET_SPDM_COMMAND_NORMAL, Request, (UINT32)RequestSize);
+  Connection = SpdmGetDeviceIoContext (SpdmContext);
+  Result = SendPlatformData (Connection->Socket, SOCKET_SPDM_COMMAND_NORMAL, Request, (UINT32)RequestSize);
   if (!Result) {
     printf ("SendPlatformData Error - %x\n",
 #ifdef _MSC_VER
@@ -91,10 +188,12 @@ SpdmDeviceReceiveMessage (
   IN     UINT64                                 Timeout
   )
 {
-  BOOLEAN Result;
+  SPDM_EMU_CONNECTION  *Connection;
+  BOOLEAN              Result;
 
-  mReceiveBufferSize = sizeof(mReceiveBuffer);
-  Result = ReceivePlatformData (mServerSocket, &mCommand, mReceiveBuffer, &mReceiveBufferSize);
+  Connection = SpdmGetDeviceIoContext (SpdmContext);
+  Connection->ReceiveBufferSize = sizeof(Connection->ReceiveBuffer);
+  Result = ReceivePlatformData (Connection->Socket, &Connection->Command, Connection->ReceiveBuffer, &Connection->ReceiveBufferSize);
   if (!Result) {
     printf ("ReceivePlatformData Error - %x\n",
 #ifdef _MSC_VER
@@ -105,7 +204,7 @@ SpdmDeviceReceiveMessage (
       );
     return RETURN_DEVICE_ERROR;
   }
-  if (mCommand == SOCKET_SPDM_COMMAND_NORMAL) {
+  if (Connection->Command == SOCKET_SPDM_COMMAND_NORMAL) {
     //
     // Cache the message in case it is not for SPDM.
     //
@@ -115,18 +214,157 @@ SpdmDeviceReceiveMessage (
     //
     return RETURN_UNSUPPORTED;
   }
-  if (*ResponseSize < mReceiveBufferSize) {
-    *ResponseSize = mReceiveBufferSize;
+  if (*ResponseSize < Connection->ReceiveBufferSize) {
+    *ResponseSize = Connection->ReceiveBufferSize;
     return RETURN_BUFFER_TOO_SMALL;
   }
-  *ResponseSize = mReceiveBufferSize;
-  CopyMem (Response, mReceiveBuffer, mReceiveBufferSize);
+  *ResponseSize = Connection->ReceiveBufferSize;
+  CopyMem (Response, Connection->ReceiveBuffer, Connection->ReceiveBufferSize);
+
+  if (mTraceFileName != NULL) {
+    mTraceReceived = TRUE;
+    mTraceReceiveTime = TraceGetTime ();
+    mTraceRequestSize = *ResponseSize;
+    mTraceIsSecured = TraceParseTransportMessage (*ResponseSize, Response, &mTraceRequestCode, &mTraceSessionId);
+    mTraceStatsValid = SpdmTraceGetStats (SpdmContext, &mTraceStats);
+  }
   return RETURN_SUCCESS;
 }
 
+/**
+  Acquire the lock of the DHE key pool shared by the connections.
+**/
+VOID
+EFIAPI
+SpdmServerAcquireDheKeyPoolLock (
+  IN     VOID                 *LockContext
+  )
+{
+  AcquireServerLock ();
+}
+
+/**
+  Release the lock of the DHE key pool shared by the connections.
+**/
+VOID
+EFIAPI
+SpdmServerReleaseDheKeyPoolLock (
+  IN     VOID                 *LockContext
+  )
+{
+  ReleaseServerLock ();
+}
+
+/**
+  Allocate the DHE key pool of --dhe_pool, shared by the SPDM contexts of all the connections.
+
+  @retval TRUE  the pool is allocated, or no pool is used.
+  @retval FALSE the pool cannot be allocated.
+**/
+BOOLEAN
+SpdmServerInitDheKeyPool (
+  VOID
+  )
+{
+  if (mDheKeyPoolSize == 0) {
+    return TRUE;
+  }
+  mDheKeyPool = (VOID *)malloc (SpdmSecuredMessageDheKeyPoolGetSize (mDheKeyPoolSize));
+  if (mDheKeyPool == NULL) {
+    printf ("Allocate DHE key pool fail\n");
+    return FALSE;
+  }
+  SpdmSecuredMessageDheKeyPoolInit (
+    mDheKeyPool,
+    mDheKeyPoolSize,
+    SpdmServerAcquireDheKeyPoolLock,
+    SpdmServerReleaseDheKeyPoolLock,
+    NULL
+    );
+  return TRUE;
+}
+
+/**
+  Generate one DHE key pair of the negotiated DHE group for the DHE key pool, if the pool has a free entry.
+
+  It is called after each response is sent, while the requester processes the response.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+**/
+VOID
+SpdmServerRefillDheKeyPool (
+  IN     VOID                 *SpdmContext
+  )
+{
+  SPDM_DATA_PARAMETER          Parameter;
+  UINT16                       Data16;
+  UINTN                        DataSize;
+
+  if (mDheKeyPool == NULL) {
+    return;
+  }
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationConnection;
+  Data16 = 0;
+  DataSize = sizeof(Data16);
+  if (RETURN_ERROR(SpdmGetData (SpdmContext, SpdmDataDHENamedGroup, &Parameter, &Data16, &DataSize)) || (Data16 == 0)) {
+    return;
+  }
+  SpdmSecuredMessageDheKeyPoolRefill (mDheKeyPool, Data16, 1);
+}
+
+/**
+  Release the DHE key pool of --dhe_pool.
+**/
+VOID
+SpdmServerDeinitDheKeyPool (
+  VOID
+  )
+{
+  if (mDheKeyPool != NULL) {
+    SpdmSecuredMessageDheKeyPoolDeinit (mDheKeyPool);
+    free (mDheKeyPool);
+    mDheKeyPool = NULL;
+  }
+}
+
+/**
+  Release the private key loaded for a client connection.
+**/
+VOID
+SpdmServerReleaseConnection (
+  IN SPDM_EMU_CONNECTION  *Connection
+  )
+{
+  if (Connection->PrivateKey != NULL) {
+    SpdmResponderDataReleaseKeyFunc (Connection->PrivateKeyAsymAlgo, Connection->PrivateKey);
+    Connection->PrivateKey = NULL;
+  }
+}
+
+/**
+  Delay each DHE step of KEY_EXCHANGE by --dhe_delay, as the yield function of the responder.
+
+  @return FALSE, so that the responder continues at once.
+**/
+BOOLEAN
+EFIAPI
+SpdmServerDheDelayYield (
+  IN VOID                        *SpdmContext,
+  IN UINT8                       RequestCode,
+  IN SPDM_RESPONDER_YIELD_POINT  YieldPoint
+  )
+{
+  if ((YieldPoint == SpdmResponderYieldPointDheKeyGenerated) ||
+      (YieldPoint == SpdmResponderYieldPointDheSecretComputed)) {
+    CostModelDelay (mDheDelay);
+  }
+  return FALSE;
+}
+
 VOID *
 SpdmServerInit (
-  VOID
+  IN SPDM_EMU_CONNECTION  *Connection
   )
 {
   VOID                         *SpdmContext;
@@ -136,25 +374,24 @@ SpdmServerInit (
   UINT32                       Data32;
   SPDM_VERSION_NUMBER          SpdmVersion;
 
-  mSpdmContext = (VOID *)malloc (SpdmGetContextSize());
-  if (mSpdmContext == NULL) {
+  SpdmContext = (VOID *)malloc (SpdmGetContextSize());
+  if (SpdmContext == NULL) {
     return NULL;
   }
-  SpdmContext = mSpdmContext;
+  Connection->SpdmContext = SpdmContext;
   SpdmInitContext (SpdmContext);
   SpdmRegisterDeviceIoFunc (SpdmContext, SpdmDeviceSendMessage, SpdmDeviceReceiveMessage);
+  SpdmRegisterDeviceIoContext (SpdmContext, Connection);
   if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_MCTP) {
     SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportMctpEncodeMessage, SpdmTransportMctpDecodeMessage);
+    SpdmRegisterTransportLayerMessageRoomFunc (SpdmContext, SpdmTransportMctpGetMessageRoom);
   } else if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_PCI_DOE) {
     SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportPciDoeEncodeMessage, SpdmTransportPciDoeDecodeMessage);
+    SpdmRegisterTransportLayerMessageRoomFunc (SpdmContext, SpdmTransportPciDoeGetMessageRoom);
   } else {
     return NULL;
   }
 
-  if (mLoadStateFileName != NULL) {
-    SpdmLoadNegotiatedState (SpdmContext, FALSE);
-  }
-
   if (mUseVersion != SPDM_MESSAGE_VERSION_11) {
     ZeroMem (&Parameter, sizeof(Parameter));
     Parameter.Location = SpdmDataLocationLocal;
@@ -182,6 +419,14 @@ SpdmServerInit (
   ZeroMem (&Parameter, sizeof(Parameter));
   Parameter.Location = SpdmDataLocationLocal;
 
+  if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_PCI_DOE) {
+    //
+    // A DOE data object holds up to 1MB, so a CERTIFICATE portion is only limited by the message buffer.
+    //
+    Data32 = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+    SpdmSetData (SpdmContext, SpdmDataTransportMaxMessageSize, &Parameter, &Data32, sizeof(Data32));
+  }
+
   Data8 = 0;
   SpdmSetData (SpdmContext, SpdmDataCapabilityCTExponent, &Parameter, &Data8, sizeof(Data8));
   Data32 = mUseResponderCapabilityFlags;
@@ -208,16 +453,33 @@ SpdmServerInit (
   SpdmSetData (SpdmContext, SpdmDataKeySchedule, &Parameter, &Data16, sizeof(Data16));
 
   SpdmRegisterGetResponseFunc (SpdmContext, SpdmGetResponseVendorDefinedRequest);
+  Data16 = SPDM_VENDOR_ID_PCISIG;
+  SpdmRegisterVendorPayloadHandler (SpdmContext, SPDM_REGISTRY_ID_PCISIG, sizeof(Data16), &Data16, SpdmPciIdeKmPayloadCallback);
 
   SpdmRegisterSessionStateCallback (SpdmContext, SpdmServerSessionStateCallback);
   SpdmRegisterConnectionStateCallback (SpdmContext, SpdmServerConnectionStateCallback);
 
+  if ((mTraceFileName != NULL) || (mMetricsFileName != NULL)) {
+    //
+    // The time function enables the latencies and the crypto and callback time of the responder statistics.
+    //
+    SpdmRegisterResponderAdmissionFunc (SpdmContext, SpdmTraceResponderGetTime, NULL);
+  }
+  if (mDheKeyPool != NULL) {
+    SpdmRegisterDheKeyPool (SpdmContext, mDheKeyPool);
+  }
+  if (mDheDelay != 0) {
+    SpdmRegisterResponderYieldFunc (SpdmContext, SpdmServerDheDelayYield);
+  }
+
   if (mLoadStateFileName != NULL) {
-    // Invoke callback to provision the rest
-    SpdmServerConnectionStateCallback (SpdmContext, SpdmConnectionStateNegotiated);
+    if (!RETURN_ERROR(SpdmLoadNegotiatedState (SpdmContext))) {
+      // Invoke callback to provision the rest
+      SpdmServerConnectionStateCallback (SpdmContext, SpdmConnectionStateNegotiated);
+    }
   }
 
-  return mSpdmContext;
+  return SpdmContext;
 }
 
 /**
@@ -244,6 +506,7 @@ SpdmServerConnectionStateCallback (
   VOID                         *Hash;
   UINTN                        HashSize;
   UINT8                        Index;
+  SPDM_EMU_CONNECTION          *Connection;
 
   switch (ConnectionState) {
   case SpdmConnectionStateNotStarted:
@@ -258,7 +521,11 @@ SpdmServerConnectionStateCallback (
   case SpdmConnectionStateNegotiated:
     //
     // Provision new content
+    // The server lock serializes the concurrent clients, because the negotiated algorithms are kept in globals.
     //
+    Connection = SpdmGetDeviceIoContext (SpdmContext);
+    AcquireServerLock ();
+
     ZeroMem (&Parameter, sizeof(Parameter));
     Parameter.Location = SpdmDataLocationConnection;
 
@@ -275,7 +542,7 @@ SpdmServerConnectionStateCallback (
     SpdmGetData (SpdmContext, SpdmDataReqBaseAsymAlg, &Parameter, &Data16, &DataSize);
     mUseReqAsymAlgo = Data16;
 
-    Res = ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, NULL, NULL);
+    Res = ReadCachedCertificate (CERT_KIND_RESPONDER_CHAIN, mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, NULL, NULL);
     if (Res) {
       ZeroMem (&Parameter, sizeof(Parameter));
       Parameter.Location = SpdmDataLocationLocal;
@@ -289,8 +556,23 @@ SpdmServerConnectionStateCallback (
       // do not free it
     }
 
+    //
+    // Parse the private key once for the negotiated algorithm, instead of per signing.
+    // The parsed key is per connection, because a key object may not be used by multiple threads.
+    //
+    if ((Connection->PrivateKey != NULL) && (Connection->PrivateKeyAsymAlgo != mUseAsymAlgo)) {
+      SpdmRegisterLocalPrivateKey (SpdmContext, FALSE, 0, NULL);
+      SpdmServerReleaseConnection (Connection);
+    }
+    if (Connection->PrivateKey == NULL) {
+      if (SpdmResponderDataLoadKeyFunc (mUseAsymAlgo, &Connection->PrivateKey)) {
+        Connection->PrivateKeyAsymAlgo = mUseAsymAlgo;
+        SpdmRegisterLocalPrivateKey (SpdmContext, FALSE, Connection->PrivateKeyAsymAlgo, Connection->PrivateKey);
+      }
+    }
+
     if ((mUseSlotId == 0xFF) || ((mUseResponderCapabilityFlags & SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PUB_KEY_ID_CAP) != 0)) {
-      Res = ReadRequesterPublicCertificateChain (mUseHashAlgo, mUseReqAsymAlgo, &Data, &DataSize, NULL, NULL);
+      Res = ReadCachedCertificate (CERT_KIND_REQUESTER_CHAIN, mUseHashAlgo, mUseReqAsymAlgo, &Data, &DataSize, NULL, NULL);
       if (Res) {
         ZeroMem (&Parameter, sizeof(Parameter));
         Parameter.Location = SpdmDataLocationLocal;
@@ -298,7 +580,7 @@ SpdmServerConnectionStateCallback (
         // Do not free it.
       }
     } else {
-      Res = ReadRequesterRootPublicCertificate (mUseHashAlgo, mUseReqAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+      Res = ReadCachedCertificate (CERT_KIND_REQUESTER_ROOT, mUseHashAlgo, mUseReqAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
       if (Res) {
         ZeroMem (&Parameter, sizeof(Parameter));
         Parameter.Location = SpdmDataLocationLocal;
@@ -322,10 +604,7 @@ SpdmServerConnectionStateCallback (
       printf ("SpdmSetData - %x\n", (UINT32)Status);
     }
 
-    if (mSaveStateFileName != NULL) {
-      SpdmSaveNegotiatedState (SpdmContext, FALSE);
-    }
-
+    ReleaseServerLock ();
     break;
 
   default:
@@ -354,6 +633,8 @@ SpdmServerSessionStateCallback (
   SPDM_DATA_PARAMETER          Parameter;
   UINT8                        Data8;
 
+  MetricsCountSession (SessionState);
+
   switch (SessionState) {
   case SpdmSessionStateNotStarted :
     // Session End
@@ -369,8 +650,8 @@ SpdmServerSessionStateCallback (
         // clear
         SpdmClearNegotiatedState (SpdmContext);
       } else {
-        // preserve - already done in SpdmConnectionStateNegotiated.
-        // SpdmSaveNegotiatedState (SpdmContext, FALSE);
+        // preserve, with the certificate chain of the requester if it is retrieved in the session.
+        SpdmSaveNegotiatedState (SpdmContext, FALSE);
       }
     }
     break;
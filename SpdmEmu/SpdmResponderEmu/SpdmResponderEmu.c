@@ -7,20 +7,58 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
+#ifdef __linux__
+//
+// For the processor affinity of the sharded server.
+//
+#define _GNU_SOURCE
+#endif
 #include "SpdmResponderEmu.h"
+#ifdef __linux__
+#include <sched.h>
+#endif
 
-UINT32 mCommand;
-UINTN  mReceiveBufferSize;
-UINT8  mReceiveBuffer[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+//
+// The connection of the serial server. The concurrent server allocates one connection per client,
+// and the sharded server one connection per shard.
+//
+SPDM_EMU_CONNECTION  mConnection;
 
-SOCKET mServerSocket;
+#ifdef _MSC_VER
+CRITICAL_SECTION     mServerLock;
+#else
+pthread_mutex_t      mServerLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
-extern VOID *mSpdmContext;
+/**
+  Acquire the lock protecting the state shared by the clients of the concurrent or sharded server.
+**/
+VOID
+AcquireServerLock (
+  VOID
+  )
+{
+#ifdef _MSC_VER
+  EnterCriticalSection (&mServerLock);
+#else
+  pthread_mutex_lock (&mServerLock);
+#endif
+}
 
-VOID *
-SpdmServerInit (
+/**
+  Release the lock protecting the state shared by the clients of the concurrent or sharded server.
+**/
+VOID
+ReleaseServerLock (
   VOID
-  );
+  )
+{
+#ifdef _MSC_VER
+  LeaveCriticalSection (&mServerLock);
+#else
+  pthread_mutex_unlock (&mServerLock);
+#endif
+}
 
 BOOLEAN
 CreateSocket(
@@ -30,6 +68,9 @@ CreateSocket(
 {
   struct               sockaddr_in MyAddress;
   INT32                Res;
+#ifndef _MSC_VER
+  INT32                ReusePort;
+#endif
 
   // Initialize Winsock
 #ifdef _MSC_VER
@@ -53,6 +94,21 @@ CreateSocket(
     return FALSE;
   }
 
+#ifndef _MSC_VER
+  //
+  // Each shard of the sharded server listens on the same port, and the kernel spreads the clients to them.
+  //
+  if (mServerMode == SERVER_MODE_SHARDED) {
+    ReusePort = 1;
+    Res = setsockopt(*ListenSocket, SOL_SOCKET, SO_REUSEPORT, &ReusePort, sizeof(ReusePort));
+    if(Res == SOCKET_ERROR) {
+      printf("Set SO_REUSEPORT error.  Error is 0x%x\n", errno);
+      closesocket(*ListenSocket);
+      return FALSE;
+    }
+  }
+#endif
+
   ZeroMem(&MyAddress, sizeof(MyAddress));
   MyAddress.sin_port = htons((short)PortNumber);
   MyAddress.sin_family = AF_INET;
@@ -70,7 +126,7 @@ CreateSocket(
     return FALSE;
   }
 
-  Res = listen(*ListenSocket, 3);
+  Res = listen(*ListenSocket, (mServerMode != SERVER_MODE_SERIAL) ? SOMAXCONN : 3);
   if(Res == SOCKET_ERROR) {
     printf("Listen error.  Error is 0x%x\n",
 #ifdef _MSC_VER
@@ -101,16 +157,18 @@ DOE_DISCOVERY_RESPONSE_MINE   mDoeResponse = {
 
 BOOLEAN
 PlatformServer (
-  IN SOCKET           Socket
+  IN SPDM_EMU_CONNECTION  *Connection
   )
 {
   BOOLEAN            Result;
   RETURN_STATUS      Status;
 
   while (TRUE) {
-    Status = SpdmResponderDispatchMessage (mSpdmContext);
+    Status = SpdmResponderDispatchMessage (Connection->SpdmContext);
     if (Status == RETURN_SUCCESS) {
       // success dispatch SPDM message
+      SpdmServerRefillDheKeyPool (Connection->SpdmContext);
+      MetricsCollect (Connection->SpdmContext, &Connection->MetricsCollectTime);
     }
     if (Status == RETURN_DEVICE_ERROR) {
       printf ("Server Critical Error - STOP\n");
@@ -119,10 +177,10 @@ PlatformServer (
     if (Status != RETURN_UNSUPPORTED) {
       continue;
     }
-    switch(mCommand) {
+    switch(Connection->Command) {
     case SOCKET_SPDM_COMMAND_TEST:
       Result = SendPlatformData (
-                 Socket,
+                 Connection->Socket,
                  SOCKET_SPDM_COMMAND_TEST,
                  (UINT8 *)"Server Hello!",
                  sizeof("Server Hello!")
@@ -140,8 +198,8 @@ PlatformServer (
       break;
 
     case SOCKET_SPDM_COMMAND_OOB_ENCAP_KEY_UPDATE:
-      SpdmInitKeyUpdateEncapState (mSpdmContext);
-      Result = SendPlatformData (Socket, SOCKET_SPDM_COMMAND_OOB_ENCAP_KEY_UPDATE, NULL, 0);
+      SpdmInitKeyUpdateEncapState (Connection->SpdmContext);
+      Result = SendPlatformData (Connection->Socket, SOCKET_SPDM_COMMAND_OOB_ENCAP_KEY_UPDATE, NULL, 0);
       if (!Result) {
         printf ("SendPlatformData Error - %x\n",
 #ifdef _MSC_VER
@@ -155,7 +213,7 @@ PlatformServer (
       break;
 
     case SOCKET_SPDM_COMMAND_SHUTDOWN:
-      Result = SendPlatformData (Socket, SOCKET_SPDM_COMMAND_SHUTDOWN, NULL, 0);
+      Result = SendPlatformData (Connection->Socket, SOCKET_SPDM_COMMAND_SHUTDOWN, NULL, 0);
       if (!Result) {
         printf ("SendPlatformData Error - %x\n",
 #ifdef _MSC_VER
@@ -170,7 +228,7 @@ PlatformServer (
       break;
 
     case SOCKET_SPDM_COMMAND_CONTINUE:
-      Result = SendPlatformData (Socket, SOCKET_SPDM_COMMAND_CONTINUE, NULL, 0);
+      Result = SendPlatformData (Connection->Socket, SOCKET_SPDM_COMMAND_CONTINUE, NULL, 0);
       if (!Result) {
         printf ("SendPlatformData Error - %x\n",
 #ifdef _MSC_VER
@@ -188,13 +246,13 @@ PlatformServer (
       if (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_PCI_DOE) {
         DOE_DISCOVERY_REQUEST_MINE  *DoeRequest;
 
-        DoeRequest = (VOID *)mReceiveBuffer;
+        DoeRequest = (VOID *)Connection->ReceiveBuffer;
         if ((DoeRequest->DoeHeader.VendorId != PCI_DOE_VENDOR_ID_PCISIG) ||
             (DoeRequest->DoeHeader.DataObjectType != PCI_DOE_DATA_OBJECT_TYPE_DOE_DISCOVERY)) {
           // unknown message
           return TRUE;
         }
-        ASSERT (mReceiveBufferSize == sizeof(DOE_DISCOVERY_REQUEST_MINE));
+        ASSERT (Connection->ReceiveBufferSize == sizeof(DOE_DISCOVERY_REQUEST_MINE));
         ASSERT (DoeRequest->DoeHeader.Length == sizeof(*DoeRequest) / sizeof(UINT32));
 
         switch (DoeRequest->DoeDiscoveryRequest.Index) {
@@ -214,7 +272,7 @@ PlatformServer (
         }
 
         Result = SendPlatformData (
-                  Socket,
+                  Connection->Socket,
                   SOCKET_SPDM_COMMAND_NORMAL,
                   (UINT8 *)&mDoeResponse,
                   sizeof(mDoeResponse)
@@ -236,8 +294,8 @@ PlatformServer (
       break;
 
     default:
-      printf ("Unrecognized platform interface command %x\n", mCommand);
-      Result = SendPlatformData (Socket, SOCKET_SPDM_COMMAND_UNKOWN, NULL, 0);
+      printf ("Unrecognized platform interface command %x\n", Connection->Command);
+      Result = SendPlatformData (Connection->Socket, SOCKET_SPDM_COMMAND_UNKOWN, NULL, 0);
       if (!Result) {
         printf ("SendPlatformData Error - %x\n",
 #ifdef _MSC_VER
@@ -253,6 +311,280 @@ PlatformServer (
   }
 }
 
+/**
+  Serve one client of the concurrent server with its own SPDM context, then release the connection.
+**/
+#ifdef _MSC_VER
+DWORD
+WINAPI
+#else
+VOID *
+#endif
+PlatformServerThread (
+  IN VOID             *Context
+  )
+{
+  SPDM_EMU_CONNECTION  *Connection;
+
+  Connection = Context;
+  InitPlatformSocket (Connection->Socket);
+  if (SpdmServerInit (Connection) != NULL) {
+    PlatformServer (Connection);
+  } else {
+    printf ("SpdmServerInit fail\n");
+  }
+  closesocket (Connection->Socket);
+  printf ("Client disconnected\n");
+
+  if (Connection->SpdmContext != NULL) {
+    MetricsCollect (Connection->SpdmContext, NULL);
+    free (Connection->SpdmContext);
+  }
+  SpdmServerReleaseConnection (Connection);
+  free (Connection);
+  return 0;
+}
+
+/**
+  Accept the clients, and serve each of them in a new thread.
+
+  A SHUTDOWN or CONTINUE command only ends the connection of the client sending it.
+**/
+BOOLEAN
+PlatformConcurrentServer (
+  IN SOCKET           ListenSocket
+  )
+{
+  SOCKET               ClientSocket;
+  struct               sockaddr_in PeerAddress;
+  UINT32               Length;
+  SPDM_EMU_CONNECTION  *Connection;
+#ifdef _MSC_VER
+  HANDLE               Thread;
+#else
+  pthread_t            Thread;
+#endif
+
+  while (TRUE) {
+    Length = sizeof(PeerAddress);
+    ClientSocket = accept(ListenSocket, (struct sockaddr*) &PeerAddress, (socklen_t *)&Length);
+    if (ClientSocket == INVALID_SOCKET) {
+      printf ("Accept error.  Error is 0x%x\n",
+#ifdef _MSC_VER
+        WSAGetLastError()
+#else
+        errno
+#endif
+        );
+      return FALSE;
+    }
+    printf ("Client accepted\n");
+
+    Connection = (VOID *)malloc (sizeof(SPDM_EMU_CONNECTION));
+    if (Connection == NULL) {
+      printf ("Allocate client connection fail\n");
+      closesocket (ClientSocket);
+      continue;
+    }
+    ZeroMem (Connection, sizeof(SPDM_EMU_CONNECTION));
+    Connection->Socket = ClientSocket;
+
+#ifdef _MSC_VER
+    Thread = CreateThread (NULL, 0, PlatformServerThread, Connection, 0, NULL);
+    if (Thread != NULL) {
+      CloseHandle (Thread);
+      continue;
+    }
+#else
+    if (pthread_create (&Thread, NULL, PlatformServerThread, Connection) == 0) {
+      pthread_detach (Thread);
+      continue;
+    }
+#endif
+    printf ("Create client thread fail\n");
+    closesocket (ClientSocket);
+    free (Connection);
+  }
+}
+
+#ifndef _MSC_VER
+///
+/// One shard of the sharded server.
+///
+typedef struct {
+  UINT32               Index;
+  //
+  // The processor running the shard thread, or -1 if the thread is not bound to a processor.
+  //
+  INT32                Processor;
+  SOCKET               ListenSocket;
+  pthread_t            Thread;
+  BOOLEAN              ThreadCreated;
+  SPDM_EMU_CONNECTION  Connection;
+} SPDM_EMU_SHARD;
+
+/**
+  Serve the clients of one shard of the sharded server, one after another.
+
+  The shard has its own listening socket, its own SPDM context and its own private key. Like the serial server,
+  a client reuses the SPDM context of the previous client, and its private key if the algorithm is the same.
+  Unlike the serial server, a SHUTDOWN or CONTINUE command only ends the connection of the client sending it.
+  The certificate chains are read-only, so they are shared by all the shards.
+**/
+VOID *
+PlatformShardThread (
+  IN VOID             *Context
+  )
+{
+  SPDM_EMU_SHARD       *Shard;
+  struct               sockaddr_in PeerAddress;
+  UINT32               Length;
+#ifdef __linux__
+  cpu_set_t            CpuSet;
+
+  Shard = Context;
+  if (Shard->Processor >= 0) {
+    CPU_ZERO (&CpuSet);
+    CPU_SET (Shard->Processor, &CpuSet);
+    if (pthread_setaffinity_np (pthread_self (), sizeof(CpuSet), &CpuSet) != 0) {
+      printf ("Bind shard %d to processor %d fail\n", Shard->Index, Shard->Processor);
+    }
+  }
+#else
+  Shard = Context;
+#endif
+
+  //
+  // The SPDM context is allocated by the shard thread after the binding, so that it is local to the processor.
+  //
+  if (SpdmServerInit (&Shard->Connection) == NULL) {
+    printf ("SpdmServerInit fail\n");
+  } else {
+    while (TRUE) {
+      Length = sizeof(PeerAddress);
+      Shard->Connection.Socket = accept(Shard->ListenSocket, (struct sockaddr*) &PeerAddress, (socklen_t *)&Length);
+      if (Shard->Connection.Socket == INVALID_SOCKET) {
+        printf ("Accept error.  Error is 0x%x\n", errno);
+        break;
+      }
+      InitPlatformSocket (Shard->Connection.Socket);
+      PlatformServer (&Shard->Connection);
+      closesocket (Shard->Connection.Socket);
+      MetricsCollect (Shard->Connection.SpdmContext, NULL);
+    }
+  }
+
+  //
+  // Leave the port, so that the kernel gives the next clients to the other shards.
+  //
+  closesocket (Shard->ListenSocket);
+  Shard->ListenSocket = INVALID_SOCKET;
+  return NULL;
+}
+
+/**
+  Serve the clients with one shard per processor, until the responder is killed.
+
+  Each shard listens on the port with SO_REUSEPORT and runs in its own thread, so that no accept loop,
+  connection allocation or thread creation is shared by the clients.
+**/
+BOOLEAN
+PlatformShardedServer (
+  IN  UINT16           PortNumber
+  )
+{
+  SPDM_EMU_SHARD       *Shard;
+  UINT32               ShardCount;
+  UINT32               Index;
+  INT32                Processor;
+  BOOLEAN              Result;
+#ifdef __linux__
+  cpu_set_t            CpuSet;
+  BOOLEAN              HasAffinity;
+
+  CPU_ZERO (&CpuSet);
+  HasAffinity = (BOOLEAN)(sched_getaffinity (0, sizeof(CpuSet), &CpuSet) == 0);
+#endif
+
+  ShardCount = mShardCount;
+  if (ShardCount == 0) {
+#ifdef __linux__
+    if (HasAffinity) {
+      ShardCount = (UINT32)CPU_COUNT (&CpuSet);
+    }
+#endif
+    if (ShardCount == 0) {
+      ShardCount = (UINT32)sysconf (_SC_NPROCESSORS_ONLN);
+    }
+    if ((INT32)ShardCount <= 0) {
+      ShardCount = 1;
+    }
+  }
+
+  Shard = (VOID *)malloc (sizeof(SPDM_EMU_SHARD) * ShardCount);
+  if (Shard == NULL) {
+    printf ("Allocate shards fail\n");
+    return FALSE;
+  }
+  ZeroMem (Shard, sizeof(SPDM_EMU_SHARD) * ShardCount);
+
+  //
+  // The shards are bound to the processors the responder may run on, in turn.
+  //
+  Processor = -1;
+  Result = TRUE;
+  for (Index = 0; Index < ShardCount; Index++) {
+    Shard[Index].Index = Index;
+    Shard[Index].Processor = -1;
+    Shard[Index].Connection.Socket = INVALID_SOCKET;
+#ifdef __linux__
+    if (HasAffinity) {
+      do {
+        Processor = (Processor + 1) % CPU_SETSIZE;
+      } while (!CPU_ISSET (Processor, &CpuSet));
+      Shard[Index].Processor = Processor;
+    }
+#endif
+    if (!CreateSocket (PortNumber, &Shard[Index].ListenSocket)) {
+      Shard[Index].ListenSocket = INVALID_SOCKET;
+      Result = FALSE;
+      break;
+    }
+  }
+
+  if (Result) {
+    printf ("Platform server listening on port %d, with %d shards\n", PortNumber, ShardCount);
+    for (Index = 0; Index < ShardCount; Index++) {
+      if (pthread_create (&Shard[Index].Thread, NULL, PlatformShardThread, &Shard[Index]) != 0) {
+        printf ("Create shard thread fail\n");
+        closesocket (Shard[Index].ListenSocket);
+        Shard[Index].ListenSocket = INVALID_SOCKET;
+        continue;
+      }
+      Shard[Index].ThreadCreated = TRUE;
+    }
+    for (Index = 0; Index < ShardCount; Index++) {
+      if (Shard[Index].ThreadCreated) {
+        pthread_join (Shard[Index].Thread, NULL);
+      }
+    }
+    Result = FALSE;
+  }
+
+  for (Index = 0; Index < ShardCount; Index++) {
+    if (Shard[Index].ListenSocket != INVALID_SOCKET) {
+      closesocket (Shard[Index].ListenSocket);
+    }
+    if (Shard[Index].Connection.SpdmContext != NULL) {
+      free (Shard[Index].Connection.SpdmContext);
+    }
+    SpdmServerReleaseConnection (&Shard[Index].Connection);
+  }
+  free (Shard);
+  return Result;
+}
+#endif
+
 BOOLEAN
 PlatformServerRoutine (
   IN  UINT16           PortNumber
@@ -264,18 +596,49 @@ PlatformServerRoutine (
   UINT32               Length;
   BOOLEAN              ContinueServing;
 
+  if (mSharedMemoryName != NULL) {
+    Result = SharedMemoryInit (TRUE);
+    if (!Result) {
+      printf ("Create platform service shared memory fail\n");
+      return Result;
+    }
+    mConnection.Socket = INVALID_SOCKET;
+    do {
+      printf ("Platform server listening on shared memory %s\n", mSharedMemoryName);
+      ContinueServing = PlatformServer(&mConnection);
+    } while(ContinueServing);
+    SharedMemoryClose ();
+    return TRUE;
+  }
+
+#ifndef _MSC_VER
+  if (mServerMode == SERVER_MODE_SHARDED) {
+    return PlatformShardedServer (PortNumber);
+  }
+#endif
+
   Result = CreateSocket(PortNumber, &ListenSocket);
   if (!Result) {
     printf ("Create platform service socket fail\n");
     return Result;
   }
 
+  if (mServerMode == SERVER_MODE_CONCURRENT) {
+    printf ("Platform server listening on port %d, concurrently\n", PortNumber);
+    Result = PlatformConcurrentServer (ListenSocket);
+#ifdef _MSC_VER
+    WSACleanup();
+#endif
+    closesocket(ListenSocket);
+    return Result;
+  }
+
   do {
     printf ("Platform server listening on port %d\n", PortNumber);
 
     Length = sizeof(PeerAddress);
-    mServerSocket = accept(ListenSocket, (struct sockaddr*) &PeerAddress, (socklen_t *)&Length);
-    if (mServerSocket == INVALID_SOCKET) {
+    mConnection.Socket = accept(ListenSocket, (struct sockaddr*) &PeerAddress, (socklen_t *)&Length);
+    if (mConnection.Socket == INVALID_SOCKET) {
       printf ("Accept error.  Error is 0x%x\n",
 #ifdef _MSC_VER
         WSAGetLastError()
@@ -290,9 +653,11 @@ PlatformServerRoutine (
       return FALSE;
     }
     printf ("Client accepted\n");
+    InitPlatformSocket (mConnection.Socket);
 
-    ContinueServing = PlatformServer(mServerSocket);
-    closesocket(mServerSocket);
+    ContinueServing = PlatformServer(&mConnection);
+    closesocket(mConnection.Socket);
+    MetricsCollect (mConnection.SpdmContext, NULL);
 
   } while(ContinueServing);
 #ifdef _MSC_VER
@@ -312,18 +677,48 @@ int main (
 
   ProcessArgs ("SpdmResponderEmu", argc, argv);
 
-  mSpdmContext = SpdmServerInit ();
-  if (mSpdmContext == NULL) {
+#ifdef _MSC_VER
+  InitializeCriticalSection (&mServerLock);
+#endif
+
+  //
+  // The threads of the concurrent and the sharded servers share the PSK secret cache.
+  //
+  if (mServerMode != SERVER_MODE_SERIAL) {
+    mDeviceAcquireLockFunc = AcquireServerLock;
+    mDeviceReleaseLockFunc = ReleaseServerLock;
+  }
+
+  if (!SpdmServerInitDheKeyPool ()) {
     return 0;
   }
 
-  PlatformServerRoutine (DEFAULT_SPDM_PLATFORM_PORT);
+  //
+  // The concurrent server creates one SPDM context per client instead, and the sharded server one per shard.
+  //
+  if (mServerMode == SERVER_MODE_SERIAL) {
+    if (SpdmServerInit (&mConnection) == NULL) {
+      return 0;
+    }
+  }
+
+  if (mReplayFileName != NULL) {
+    ReplayCapture (&mConnection);
+  } else {
+    PlatformServerRoutine (DEFAULT_SPDM_PLATFORM_PORT);
+  }
 
-  free (mSpdmContext);
+  if (mConnection.SpdmContext != NULL) {
+    MetricsCollect (mConnection.SpdmContext, NULL);
+    free (mConnection.SpdmContext);
+  }
+  SpdmServerReleaseConnection (&mConnection);
 
   printf ("Server stopped\n");
 
   ClosePcapPacketFile ();
+  CloseTraceFile ();
+  CloseMetricsFile ();
+  SpdmServerDeinitDheKeyPool ();
   return 0;
 }
-
@@ -20,4 +20,62 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "stdio.h"
 #include "SpdmEmu.h"
 
+///
+/// The state of the platform connection to one client.
+/// It is registered as the device IO context of the SPDM context serving the client.
+///
+typedef struct {
+  SOCKET   Socket;
+  VOID     *SpdmContext;
+  UINT32   Command;
+  UINTN    ReceiveBufferSize;
+  UINT8    ReceiveBuffer[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  VOID     *PrivateKey;
+  UINT32   PrivateKeyAsymAlgo;
+  //
+  // The time the statistics of the SPDM context were last added to the metrics.
+  //
+  UINT64   MetricsCollectTime;
+} SPDM_EMU_CONNECTION;
+
+VOID *
+SpdmServerInit (
+  IN SPDM_EMU_CONNECTION  *Connection
+  );
+
+VOID
+SpdmServerReleaseConnection (
+  IN SPDM_EMU_CONNECTION  *Connection
+  );
+
+BOOLEAN
+SpdmServerInitDheKeyPool (
+  VOID
+  );
+
+VOID
+SpdmServerRefillDheKeyPool (
+  IN VOID                 *SpdmContext
+  );
+
+VOID
+SpdmServerDeinitDheKeyPool (
+  VOID
+  );
+
+BOOLEAN
+ReplayCapture (
+  IN SPDM_EMU_CONNECTION  *Connection
+  );
+
+VOID
+AcquireServerLock (
+  VOID
+  );
+
+VOID
+ReleaseServerLock (
+  VOID
+  );
+
 #endif
\ No newline at end of file
@@ -0,0 +1,565 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmResponderEmu.h"
+#include <IndustryStandard/Pcap.h>
+#include <IndustryStandard/LinkTypeEx.h>
+
+#define REPLAY_MAX_INTERFACE_COUNT  8
+
+//
+// A normal SPDM message of the capture, encoded by the transport layer.
+// The MCTP packets of a message are reassembled, without their MCTP header.
+//
+typedef struct {
+  UINT8    *Message;
+  UINTN    MessageSize;
+  UINT64   Time;
+  UINT8    RequestResponseCode;
+} REPLAY_MESSAGE;
+
+typedef struct {
+  VOID            *FileData;
+  UINTN           FileSize;
+  UINT32          DataLinkType;
+  REPLAY_MESSAGE  *Messages;
+  UINTN           MessageCount;
+  UINTN           MaxMessageCount;
+  UINTN           SkippedCount;
+  //
+  // The reassembly buffer of the MCTP messages.
+  //
+  UINT8           *MessageBuffer;
+  UINTN           MessageBufferSize;
+  BOOLEAN         InMessage;
+  UINT8           *MessageStart;
+  UINT64          MessageTime;
+  //
+  // The request given to the responder, and its response.
+  //
+  REPLAY_MESSAGE  *Request;
+  UINTN           ResponseSize;
+  UINT8           Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+} REPLAY_CAPTURE;
+
+REPLAY_CAPTURE  mReplay;
+
+/**
+  Add a transport layer message of the capture.
+
+  The secured messages are skipped, because their session keys cannot be reproduced,
+  and so are the messages other than SPDM, such as the DOE discovery.
+**/
+VOID
+ReplayAddMessage (
+  IN UINT8   *Message,
+  IN UINTN   MessageSize,
+  IN UINT64  Time
+  )
+{
+  REPLAY_MESSAGE  *ReplayMessage;
+  UINT8           RequestResponseCode;
+  UINT32          SessionId;
+
+  if (TraceParseTransportMessage (MessageSize, Message, &RequestResponseCode, &SessionId) ||
+      (RequestResponseCode == 0) || (mReplay.MessageCount == mReplay.MaxMessageCount)) {
+    mReplay.SkippedCount++;
+    return;
+  }
+  ReplayMessage = &mReplay.Messages[mReplay.MessageCount++];
+  ReplayMessage->Message = Message;
+  ReplayMessage->MessageSize = MessageSize;
+  ReplayMessage->Time = Time;
+  ReplayMessage->RequestResponseCode = RequestResponseCode;
+}
+
+/**
+  Add a packet of the capture.
+
+  @param  Packet                       A pointer to the packet data.
+  @param  PacketSize                   Size in bytes of the packet data.
+  @param  Time                         The capture time of the packet, in nanoseconds.
+**/
+VOID
+ReplayAddPacket (
+  IN UINT8   *Packet,
+  IN UINTN   PacketSize,
+  IN UINT64  Time
+  )
+{
+  MCTP_HEADER  *MctpHeader;
+  UINTN        PayloadSize;
+
+  if (mReplay.DataLinkType == LINKTYPE_PCI_DOE) {
+    ReplayAddMessage (Packet, PacketSize, Time);
+    return;
+  }
+
+  if (PacketSize < sizeof(MCTP_HEADER)) {
+    mReplay.SkippedCount++;
+    return;
+  }
+  MctpHeader = (VOID *)Packet;
+  PayloadSize = PacketSize - sizeof(MCTP_HEADER);
+  if ((MctpHeader->MessageTag & MCTP_START_OF_MESSAGE) != 0) {
+    if (mReplay.InMessage) {
+      mReplay.SkippedCount++;
+    }
+    mReplay.InMessage = TRUE;
+    mReplay.MessageStart = mReplay.MessageBuffer + mReplay.MessageBufferSize;
+    mReplay.MessageTime = Time;
+  } else if (!mReplay.InMessage) {
+    mReplay.SkippedCount++;
+    return;
+  }
+  CopyMem (mReplay.MessageBuffer + mReplay.MessageBufferSize, MctpHeader + 1, PayloadSize);
+  mReplay.MessageBufferSize += PayloadSize;
+  if ((MctpHeader->MessageTag & MCTP_END_OF_MESSAGE) != 0) {
+    mReplay.InMessage = FALSE;
+    ReplayAddMessage (
+      mReplay.MessageStart,
+      mReplay.MessageBuffer + mReplay.MessageBufferSize - mReplay.MessageStart,
+      mReplay.MessageTime
+      );
+  }
+}
+
+/**
+  Parse the packets of a PCAP file.
+
+  @retval TRUE   the packets are parsed.
+  @retval FALSE  the file is invalid, or its data link type is not the transport layer of --trans.
+**/
+BOOLEAN
+ReplayParsePcap (
+  VOID
+  )
+{
+  PCAP_GLOBAL_HEADER  *GlobalHeader;
+  PCAP_PACKET_HEADER  *PacketHeader;
+  UINT8               *Buffer;
+  UINTN               Offset;
+  UINT64              TimeUnit;
+
+  Buffer = mReplay.FileData;
+  if (mReplay.FileSize < sizeof(PCAP_GLOBAL_HEADER)) {
+    printf ("replay file is too small\n");
+    return FALSE;
+  }
+  GlobalHeader = (VOID *)Buffer;
+  if (GlobalHeader->MagicNumber == PCAP_GLOBAL_HEADER_MAGIC) {
+    TimeUnit = 1000;
+  } else if (GlobalHeader->MagicNumber == PCAP_GLOBAL_HEADER_MAGIC_NANO) {
+    TimeUnit = 1;
+  } else {
+    printf ("replay file magic 0x%08x is not supported\n", GlobalHeader->MagicNumber);
+    return FALSE;
+  }
+  if (GlobalHeader->Network != mReplay.DataLinkType) {
+    printf ("replay file data link type %d does not match --trans\n", GlobalHeader->Network);
+    return FALSE;
+  }
+
+  Offset = sizeof(PCAP_GLOBAL_HEADER);
+  while (Offset + sizeof(PCAP_PACKET_HEADER) <= mReplay.FileSize) {
+    PacketHeader = (VOID *)(Buffer + Offset);
+    Offset += sizeof(PCAP_PACKET_HEADER);
+    if (PacketHeader->InclLen > mReplay.FileSize - Offset) {
+      printf ("replay file is truncated\n");
+      break;
+    }
+    ReplayAddPacket (
+      Buffer + Offset,
+      PacketHeader->InclLen,
+      (UINT64)PacketHeader->TsSec * 1000000000ull + (UINT64)PacketHeader->TsUsec * TimeUnit
+      );
+    Offset += PacketHeader->InclLen;
+  }
+  return TRUE;
+}
+
+/**
+  Parse the enhanced packet blocks of a PCAPNG file.
+
+  The timestamps are in microseconds, the default if_tsresol.
+  The packets of an interface of another data link type than the transport layer of --trans are skipped.
+
+  @retval TRUE   the packets are parsed.
+  @retval FALSE  the file is invalid.
+**/
+BOOLEAN
+ReplayParsePcapNg (
+  VOID
+  )
+{
+  PCAPNG_BLOCK_HEADER                 *BlockHeader;
+  PCAPNG_SECTION_HEADER_BLOCK         *SectionHeader;
+  PCAPNG_INTERFACE_DESCRIPTION_BLOCK  *InterfaceDescription;
+  PCAPNG_ENHANCED_PACKET_BLOCK        *EnhancedPacket;
+  UINT32                              InterfaceLinkType[REPLAY_MAX_INTERFACE_COUNT];
+  UINTN                               InterfaceCount;
+  UINT8                               *Buffer;
+  UINTN                               Offset;
+
+  Buffer = mReplay.FileData;
+  InterfaceCount = 0;
+  Offset = 0;
+  while (Offset + sizeof(PCAPNG_BLOCK_HEADER) <= mReplay.FileSize) {
+    BlockHeader = (VOID *)(Buffer + Offset);
+    if ((BlockHeader->BlockTotalLength < sizeof(PCAPNG_BLOCK_HEADER) + sizeof(UINT32)) ||
+        (BlockHeader->BlockTotalLength > mReplay.FileSize - Offset) ||
+        ((BlockHeader->BlockTotalLength & 0x3) != 0)) {
+      printf ("replay file is truncated\n");
+      break;
+    }
+
+    switch (BlockHeader->BlockType) {
+    case PCAPNG_BLOCK_TYPE_SECTION_HEADER:
+      SectionHeader = (VOID *)BlockHeader;
+      if ((BlockHeader->BlockTotalLength < sizeof(PCAPNG_SECTION_HEADER_BLOCK)) ||
+          (SectionHeader->ByteOrderMagic != PCAPNG_BYTE_ORDER_MAGIC)) {
+        printf ("replay file section is not supported\n");
+        return FALSE;
+      }
+      InterfaceCount = 0;
+      break;
+
+    case PCAPNG_BLOCK_TYPE_INTERFACE_DESCRIPTION:
+      InterfaceDescription = (VOID *)BlockHeader;
+      if ((BlockHeader->BlockTotalLength < sizeof(PCAPNG_INTERFACE_DESCRIPTION_BLOCK)) ||
+          (InterfaceCount == REPLAY_MAX_INTERFACE_COUNT)) {
+        printf ("replay file interface is not supported\n");
+        return FALSE;
+      }
+      InterfaceLinkType[InterfaceCount++] = InterfaceDescription->LinkType;
+      break;
+
+    case PCAPNG_BLOCK_TYPE_ENHANCED_PACKET:
+      EnhancedPacket = (VOID *)BlockHeader;
+      if ((BlockHeader->BlockTotalLength < sizeof(PCAPNG_ENHANCED_PACKET_BLOCK) + sizeof(UINT32)) ||
+          (EnhancedPacket->CapturedPacketLength >
+           BlockHeader->BlockTotalLength - sizeof(PCAPNG_ENHANCED_PACKET_BLOCK) - sizeof(UINT32)) ||
+          (EnhancedPacket->InterfaceId >= InterfaceCount)) {
+        printf ("replay file packet is invalid\n");
+        return FALSE;
+      }
+      if (InterfaceLinkType[EnhancedPacket->InterfaceId] != mReplay.DataLinkType) {
+        mReplay.SkippedCount++;
+        break;
+      }
+      ReplayAddPacket (
+        (UINT8 *)(EnhancedPacket + 1),
+        EnhancedPacket->CapturedPacketLength,
+        (((UINT64)EnhancedPacket->TimestampHigh << 32) | EnhancedPacket->TimestampLow) * 1000
+        );
+      break;
+
+    default:
+      break;
+    }
+    Offset += BlockHeader->BlockTotalLength;
+  }
+  return TRUE;
+}
+
+/**
+  Release the capture.
+**/
+VOID
+ReplayReleaseCapture (
+  VOID
+  )
+{
+  if (mReplay.FileData != NULL) {
+    free (mReplay.FileData);
+  }
+  if (mReplay.Messages != NULL) {
+    free (mReplay.Messages);
+  }
+  if (mReplay.MessageBuffer != NULL) {
+    free (mReplay.MessageBuffer);
+  }
+  ZeroMem (&mReplay, OFFSET_OF(REPLAY_CAPTURE, Request));
+}
+
+/**
+  Load the normal SPDM messages of the capture.
+
+  @retval TRUE   the capture is loaded.
+  @retval FALSE  the capture cannot be loaded.
+**/
+BOOLEAN
+ReplayLoadCapture (
+  IN CHAR8  *FileName
+  )
+{
+  BOOLEAN  Result;
+
+  ZeroMem (&mReplay, OFFSET_OF(REPLAY_CAPTURE, Request));
+  if (!ReadInputFile (FileName, &mReplay.FileData, &mReplay.FileSize)) {
+    return FALSE;
+  }
+  mReplay.DataLinkType = (mUseTransportLayer == SOCKET_TRANSPORT_TYPE_MCTP) ? LINKTYPE_MCTP : LINKTYPE_PCI_DOE;
+
+  //
+  // Each packet has a packet header, and the reassembled messages are not larger than their packets.
+  //
+  mReplay.MaxMessageCount = mReplay.FileSize / sizeof(PCAP_PACKET_HEADER) + 1;
+  mReplay.Messages = (VOID *)malloc (mReplay.MaxMessageCount * sizeof(REPLAY_MESSAGE));
+  mReplay.MessageBuffer = (VOID *)malloc (mReplay.FileSize);
+  if ((mReplay.Messages == NULL) || (mReplay.MessageBuffer == NULL)) {
+    printf ("replay file is too large\n");
+    ReplayReleaseCapture ();
+    return FALSE;
+  }
+
+  if ((mReplay.FileSize >= sizeof(UINT32)) && (*(UINT32 *)mReplay.FileData == PCAPNG_BLOCK_TYPE_SECTION_HEADER)) {
+    Result = ReplayParsePcapNg ();
+  } else {
+    Result = ReplayParsePcap ();
+  }
+  if (!Result) {
+    ReplayReleaseCapture ();
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Give the request being replayed to the responder, as the device receive function.
+**/
+RETURN_STATUS
+EFIAPI
+ReplayDeviceReceiveMessage (
+  IN     VOID                 *SpdmContext,
+  IN OUT UINTN                *MessageSize,
+  IN OUT VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  if (mReplay.Request == NULL) {
+    return RETURN_DEVICE_ERROR;
+  }
+  if (*MessageSize < mReplay.Request->MessageSize) {
+    *MessageSize = mReplay.Request->MessageSize;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  *MessageSize = mReplay.Request->MessageSize;
+  CopyMem (Message, mReplay.Request->Message, mReplay.Request->MessageSize);
+  mReplay.Request = NULL;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Keep the response of the request being replayed, as the device send function.
+**/
+RETURN_STATUS
+EFIAPI
+ReplayDeviceSendMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN     UINT64               Timeout
+  )
+{
+  if (MessageSize > sizeof(mReplay.Response)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  CopyMem (mReplay.Response, Message, MessageSize);
+  mReplay.ResponseSize = MessageSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return if a response depends only on the request and the configuration of the responder,
+  so that it can be compared byte by byte with the captured response.
+  The other responses carry a nonce, a signature or an ephemeral key.
+**/
+BOOLEAN
+ReplayIsDeterministicResponse (
+  IN UINT8  ResponseCode
+  )
+{
+  switch (ResponseCode) {
+  case SPDM_VERSION:
+  case SPDM_CAPABILITIES:
+  case SPDM_ALGORITHMS:
+  case SPDM_DIGESTS:
+  case SPDM_CERTIFICATE:
+  case SPDM_ERROR:
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+/**
+  Compare the response of a request with the captured response.
+
+  @param  Request                      The request replayed.
+  @param  CapturedResponse             The captured response of the request.
+  @param  Verbose                      Print the difference.
+
+  @retval TRUE   the response matches the captured response.
+  @retval FALSE  the response does not match the captured response.
+**/
+BOOLEAN
+ReplayCheckResponse (
+  IN REPLAY_MESSAGE  *Request,
+  IN REPLAY_MESSAGE  *CapturedResponse,
+  IN BOOLEAN         Verbose
+  )
+{
+  UINT8   ResponseCode;
+  UINT32  SessionId;
+
+  ResponseCode = 0;
+  if (mReplay.ResponseSize != 0) {
+    TraceParseTransportMessage (mReplay.ResponseSize, mReplay.Response, &ResponseCode, &SessionId);
+  }
+  if (ResponseCode != CapturedResponse->RequestResponseCode) {
+    if (Verbose) {
+      printf ("replay request 0x%02x - response 0x%02x, captured 0x%02x\n",
+        Request->RequestResponseCode, ResponseCode, CapturedResponse->RequestResponseCode);
+    }
+    return FALSE;
+  }
+  if (ReplayIsDeterministicResponse (ResponseCode) &&
+      ((mReplay.ResponseSize != CapturedResponse->MessageSize) ||
+       (CompareMem (mReplay.Response, CapturedResponse->Message, mReplay.ResponseSize) != 0))) {
+    if (Verbose) {
+      printf ("replay request 0x%02x - response 0x%02x differs from the captured one\n",
+        Request->RequestResponseCode, ResponseCode);
+      DumpHex (mReplay.Response, mReplay.ResponseSize);
+      DumpHex (CapturedResponse->Message, CapturedResponse->MessageSize);
+    }
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Wait until a time of the monotonic clock of the host.
+
+  @param  Time                         The time, in nanoseconds.
+**/
+VOID
+ReplayWaitUntil (
+  IN UINT64  Time
+  )
+{
+  UINT64  Now;
+
+  while ((Now = TraceGetTime ()) < Time) {
+    NanoSecondDelay ((UINTN)MIN (Time - Now, MAX_UINT32));
+  }
+}
+
+/**
+  Replay the requests of the capture --replay to the SPDM context of a connection, instead of serving the clients.
+
+  The requests are given in order by the device receive function, at the pace of --replay_pace,
+  and each response is compared with the response following its request in the capture, if any.
+  The throughput of the responder is printed at the end.
+
+  @param  Connection                   The connection whose SPDM context answers the requests.
+
+  @retval TRUE   all the responses match the capture.
+  @retval FALSE  the capture cannot be replayed, or a response does not match the capture.
+**/
+BOOLEAN
+ReplayCapture (
+  IN SPDM_EMU_CONNECTION  *Connection
+  )
+{
+  REPLAY_MESSAGE  *Request;
+  REPLAY_MESSAGE  *CapturedResponse;
+  RETURN_STATUS   Status;
+  UINT64          FirstRequestTime;
+  UINT64          StartTime;
+  UINT64          LoopStartTime;
+  UINT64          ElapsedTime;
+  UINTN           Index;
+  UINT32          Loop;
+  UINTN           RequestCount;
+  UINTN           MatchCount;
+  UINTN           MismatchCount;
+  UINTN           UncheckedCount;
+
+  if (!ReplayLoadCapture (mReplayFileName)) {
+    return FALSE;
+  }
+  FirstRequestTime = 0;
+  RequestCount = 0;
+  for (Index = 0; Index < mReplay.MessageCount; Index++) {
+    if ((mReplay.Messages[Index].RequestResponseCode & 0x80) != 0) {
+      if (RequestCount == 0) {
+        FirstRequestTime = mReplay.Messages[Index].Time;
+      }
+      RequestCount++;
+    }
+  }
+  printf ("Replay %s - %d requests, %d packets or messages skipped\n",
+    mReplayFileName, (UINT32)RequestCount, (UINT32)mReplay.SkippedCount);
+
+  SpdmRegisterDeviceIoFunc (Connection->SpdmContext, ReplayDeviceSendMessage, ReplayDeviceReceiveMessage);
+
+  RequestCount = 0;
+  MatchCount = 0;
+  MismatchCount = 0;
+  UncheckedCount = 0;
+  Status = RETURN_SUCCESS;
+  StartTime = TraceGetTime ();
+  for (Loop = 0; (Loop < mReplayLoopCount) && (Status != RETURN_DEVICE_ERROR); Loop++) {
+    LoopStartTime = TraceGetTime ();
+    for (Index = 0; Index < mReplay.MessageCount; Index++) {
+      Request = &mReplay.Messages[Index];
+      if ((Request->RequestResponseCode & 0x80) == 0) {
+        continue;
+      }
+      if ((mReplayPace == REPLAY_PACE_ORIGINAL) && (Request->Time > FirstRequestTime)) {
+        ReplayWaitUntil (LoopStartTime + (Request->Time - FirstRequestTime));
+      }
+
+      mReplay.Request = Request;
+      mReplay.ResponseSize = 0;
+      Status = SpdmResponderDispatchMessage (Connection->SpdmContext);
+      RequestCount++;
+      if (Status == RETURN_DEVICE_ERROR) {
+        printf ("Server Critical Error - STOP\n");
+        break;
+      }
+
+      CapturedResponse = NULL;
+      if ((Index + 1 < mReplay.MessageCount) && ((mReplay.Messages[Index + 1].RequestResponseCode & 0x80) == 0)) {
+        CapturedResponse = &mReplay.Messages[Index + 1];
+      }
+      if (CapturedResponse == NULL) {
+        UncheckedCount++;
+      } else if (ReplayCheckResponse (Request, CapturedResponse, (BOOLEAN)(Loop == 0))) {
+        MatchCount++;
+      } else {
+        MismatchCount++;
+      }
+    }
+  }
+  ElapsedTime = TraceGetTime () - StartTime;
+
+  printf ("Replay %d requests in %d.%03d ms",
+    (UINT32)RequestCount, (UINT32)(ElapsedTime / 1000000), (UINT32)(ElapsedTime / 1000 % 1000));
+  if (ElapsedTime != 0) {
+    printf (" - %d requests/s", (UINT32)((UINT64)RequestCount * 1000000000ull / ElapsedTime));
+  }
+  printf ("\n");
+  printf ("Replay responses - %d match, %d mismatch, %d not captured\n",
+    (UINT32)MatchCount, (UINT32)MismatchCount, (UINT32)UncheckedCount);
+
+  ReplayReleaseCapture ();
+  return (BOOLEAN)((Status != RETURN_DEVICE_ERROR) && (MismatchCount == 0));
+}
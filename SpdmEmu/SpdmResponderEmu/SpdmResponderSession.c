@@ -9,31 +9,16 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmResponderEmu.h"
 
-SPDM_VENDOR_DEFINED_RESPONSE_MINE  mVendorDefinedResponse = {
+PCI_IDE_KM_QUERY_RESP  mPciIdeKmQueryResp = {
   {
-    SPDM_MESSAGE_VERSION_10,
-    SPDM_VENDOR_DEFINED_RESPONSE,
-    0, // Param1
-    0, // Param2
+    PCI_IDE_KM_OBJECT_ID_QUERY_RESP,
   },
-  SPDM_REGISTRY_ID_PCISIG, // StandardID
-  2, // Len
-  SPDM_VENDOR_ID_PCISIG, // VendorID
-  sizeof(PCI_PROTOCOL_HEADER) + sizeof(PCI_IDE_KM_QUERY_RESP), // PayloadLength
-  {
-    PCI_PROTOCAL_ID_IDE_KM,
-  },
-  {
-    {
-      PCI_IDE_KM_OBJECT_ID_QUERY_RESP,
-    },
-    0, // Reserved
-    0, // PortIndex
-    0, // DevFuncNum
-    0, // BusNum
-    0, // Segment
-    7, // MaxPortIndex
-  }
+  0, // Reserved
+  0, // PortIndex
+  0, // DevFuncNum
+  0, // BusNum
+  0, // Segment
+  7, // MaxPortIndex
 };
 
 SECURE_SESSION_RESPONSE_MINE  mSecureSessionResponse = {
@@ -84,21 +69,13 @@ TestSpdmProcessPacketCallback (
   IN OUT UINTN                        *ResponseSize
   )
 {
-  SPDM_VENDOR_DEFINED_REQUEST_MINE   *SpmdRequest;
   SECURE_SESSION_REQUEST_MINE        *AppRequest;
 
   if (!IsAppMessage) {
-    SpmdRequest = Request;
-    ASSERT ((RequestSize >= sizeof(SPDM_VENDOR_DEFINED_REQUEST_MINE)) && (RequestSize < sizeof(SPDM_VENDOR_DEFINED_REQUEST_MINE) + 4));
-    ASSERT (SpmdRequest->Header.RequestResponseCode == SPDM_VENDOR_DEFINED_REQUEST);
-    ASSERT (SpmdRequest->StandardID == SPDM_REGISTRY_ID_PCISIG);
-    ASSERT (SpmdRequest->VendorID == SPDM_VENDOR_ID_PCISIG);
-    ASSERT (SpmdRequest->PayloadLength == sizeof(PCI_PROTOCOL_HEADER) + sizeof(PCI_IDE_KM_QUERY));
-    ASSERT (SpmdRequest->PciProtocol.ProtocolId == PCI_PROTOCAL_ID_IDE_KM);
-    ASSERT (SpmdRequest->PciIdeKmQuery.Header.ObjectId == PCI_IDE_KM_OBJECT_ID_QUERY);
-
-    CopyMem (Response, &mVendorDefinedResponse, sizeof(mVendorDefinedResponse));
-    *ResponseSize = sizeof(mVendorDefinedResponse);
+    //
+    // The PCI-SIG VENDOR_DEFINED_REQUEST is handled by SpdmPciIdeKmPayloadCallback.
+    //
+    return RETURN_UNSUPPORTED;
   } else {
     AppRequest = Request;
     ASSERT (RequestSize == sizeof(SECURE_SESSION_REQUEST_MINE));
@@ -107,12 +84,105 @@ TestSpdmProcessPacketCallback (
     ASSERT (AppRequest->PldmHeader.PldmCommandCode == PLDM_CONTROL_DISCOVERY_COMMAND_GET_TID);
 
     CopyMem (Response, &mSecureSessionResponse, sizeof(mSecureSessionResponse));
+    //
+    // Echo the instance ID, so that the requester can match pipelined responses.
+    //
+    ((SECURE_SESSION_RESPONSE_MINE *)Response)->PldmHeader.InstanceID = AppRequest->PldmHeader.InstanceID & PLDM_HEADER_INSTANCE_ID_MASK;
     *ResponseSize = sizeof(mSecureSessionResponse);
   }
 
   return RETURN_SUCCESS;
 }
 
+/**
+  Process the payload of a PCI-SIG VENDOR_DEFINED_REQUEST, which is an IDE_KM object.
+
+  The IDE_KM response object is built in place in the response payload.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  SessionId                    ID of the session.
+  @param  StandardId                   The standard ID of the request.
+  @param  VendorIdLen                  Size in bytes of the vendor ID.
+  @param  VendorId                     A pointer to the vendor ID.
+  @param  RequestPayloadSize           Size in bytes of the request payload.
+  @param  RequestPayload               A pointer to the request payload.
+  @param  ResponsePayloadSize          On input, the size in bytes of the response payload buffer.
+                                       On output, the size in bytes of the response payload.
+  @param  ResponsePayload              A pointer to the response payload buffer.
+
+  @retval RETURN_SUCCESS               The response payload is returned.
+  @retval RETURN_UNSUPPORTED           The request payload is not a supported IDE_KM object.
+**/
+RETURN_STATUS
+EFIAPI
+SpdmPciIdeKmPayloadCallback (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     UINT16               StandardId,
+  IN     UINT8                VendorIdLen,
+  IN     CONST VOID           *VendorId,
+  IN     UINTN                RequestPayloadSize,
+  IN     CONST VOID           *RequestPayload,
+  IN OUT UINTN                *ResponsePayloadSize,
+     OUT VOID                 *ResponsePayload
+  )
+{
+  CONST PCI_PROTOCOL_HEADER  *RequestProtocol;
+  CONST PCI_IDE_KM_HEADER    *RequestObject;
+  PCI_PROTOCOL_HEADER        *ResponseProtocol;
+  PCI_IDE_KM_QUERY_RESP      *QueryResp;
+  PCI_IDE_KM_KP_ACK          *KeyAck;
+  UINTN                      RequestObjectSize;
+
+  if (RequestPayloadSize < sizeof(PCI_PROTOCOL_HEADER) + sizeof(PCI_IDE_KM_HEADER)) {
+    return RETURN_UNSUPPORTED;
+  }
+  RequestProtocol = RequestPayload;
+  if (RequestProtocol->ProtocolId != PCI_PROTOCAL_ID_IDE_KM) {
+    return RETURN_UNSUPPORTED;
+  }
+  RequestObject = (CONST VOID *)(RequestProtocol + 1);
+  RequestObjectSize = RequestPayloadSize - sizeof(PCI_PROTOCOL_HEADER);
+  ASSERT (*ResponsePayloadSize >= sizeof(PCI_PROTOCOL_HEADER) + sizeof(PCI_IDE_KM_QUERY_RESP));
+
+  ResponseProtocol = ResponsePayload;
+  ResponseProtocol->ProtocolId = PCI_PROTOCAL_ID_IDE_KM;
+
+  switch (RequestObject->ObjectId) {
+  case PCI_IDE_KM_OBJECT_ID_QUERY:
+    if (RequestObjectSize != sizeof(PCI_IDE_KM_QUERY)) {
+      return RETURN_UNSUPPORTED;
+    }
+    QueryResp = (VOID *)(ResponseProtocol + 1);
+    CopyMem (QueryResp, &mPciIdeKmQueryResp, sizeof(mPciIdeKmQueryResp));
+    QueryResp->PortIndex = ((CONST PCI_IDE_KM_QUERY *)RequestObject)->PortIndex;
+    *ResponsePayloadSize = sizeof(PCI_PROTOCOL_HEADER) + sizeof(PCI_IDE_KM_QUERY_RESP);
+    return RETURN_SUCCESS;
+
+  case PCI_IDE_KM_OBJECT_ID_KEY_PROG:
+  case PCI_IDE_KM_OBJECT_ID_K_SET_GO:
+  case PCI_IDE_KM_OBJECT_ID_K_SET_STOP:
+    //
+    // Acknowledge the key object. KEY_PROG, K_SET_GO, K_SET_STOP and their ACKs share the same layout.
+    //
+    if (RequestObjectSize < sizeof(PCI_IDE_KM_KP_ACK)) {
+      return RETURN_UNSUPPORTED;
+    }
+    KeyAck = (VOID *)(ResponseProtocol + 1);
+    CopyMem (KeyAck, RequestObject, sizeof(PCI_IDE_KM_KP_ACK));
+    if (RequestObject->ObjectId == PCI_IDE_KM_OBJECT_ID_KEY_PROG) {
+      KeyAck->Header.ObjectId = PCI_IDE_KM_OBJECT_ID_KP_ACK;
+    } else {
+      KeyAck->Header.ObjectId = PCI_IDE_KM_OBJECT_ID_K_SET_GOSTOP_ACK;
+    }
+    *ResponsePayloadSize = sizeof(PCI_PROTOCOL_HEADER) + sizeof(PCI_IDE_KM_KP_ACK);
+    return RETURN_SUCCESS;
+
+  default:
+    return RETURN_UNSUPPORTED;
+  }
+}
+
 RETURN_STATUS
 EFIAPI
 SpdmGetResponseVendorDefinedRequest (
@@ -0,0 +1,162 @@
+/** @file
+  Benchmark for AEAD primitives.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptBench.h"
+
+typedef struct {
+  UINT16    AEADCipherSuite;
+  CHAR8     *Name;
+} CRYPT_BENCH_AEAD_ALGO;
+
+CRYPT_BENCH_AEAD_ALGO  mCryptBenchAeadAlgo[] = {
+  {SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM,       "AES-128-GCM"},
+  {SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM,       "AES-256-GCM"},
+  {SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305, "CHACHA20-POLY1305"},
+};
+
+//
+// Size in bytes of the secured message header authenticated as AAD.
+//
+#define CRYPT_BENCH_AEAD_ADATA_SIZE  16
+
+#define CRYPT_BENCH_AEAD_TAG_SIZE    16
+
+typedef struct {
+  UINT16    AEADCipherSuite;
+  VOID      *AeadContext;
+  UINT8     Key[MAX_AEAD_KEY_SIZE];
+  UINT8     Iv[MAX_AEAD_IV_SIZE];
+  UINT8     AData[CRYPT_BENCH_AEAD_ADATA_SIZE];
+  UINT8     Tag[CRYPT_BENCH_AEAD_TAG_SIZE];
+  UINT8     *Data;
+  UINTN     DataSize;
+  UINT8     *Cipher;
+  UINT8     *Plain;
+} CRYPT_BENCH_AEAD_CONTEXT;
+
+BOOLEAN
+BenchAeadEncrypt (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_AEAD_CONTEXT  *Aead;
+  UINTN                     OutSize;
+
+  Aead = Context;
+  OutSize = Aead->DataSize;
+  return SpdmAeadEncryption (
+           Aead->AEADCipherSuite,
+           Aead->Key, GetSpdmAeadKeySize (Aead->AEADCipherSuite),
+           Aead->Iv, GetSpdmAeadIvSize (Aead->AEADCipherSuite),
+           Aead->AData, sizeof(Aead->AData),
+           Aead->Data, Aead->DataSize,
+           Aead->Tag, GetSpdmAeadTagSize (Aead->AEADCipherSuite),
+           Aead->Cipher, &OutSize
+           );
+}
+
+BOOLEAN
+BenchAeadDecrypt (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_AEAD_CONTEXT  *Aead;
+  UINTN                     OutSize;
+
+  Aead = Context;
+  OutSize = Aead->DataSize;
+  return SpdmAeadDecryption (
+           Aead->AEADCipherSuite,
+           Aead->Key, GetSpdmAeadKeySize (Aead->AEADCipherSuite),
+           Aead->Iv, GetSpdmAeadIvSize (Aead->AEADCipherSuite),
+           Aead->AData, sizeof(Aead->AData),
+           Aead->Cipher, Aead->DataSize,
+           Aead->Tag, GetSpdmAeadTagSize (Aead->AEADCipherSuite),
+           Aead->Plain, &OutSize
+           );
+}
+
+BOOLEAN
+BenchAeadSeal (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_AEAD_CONTEXT  *Aead;
+  UINTN                     OutSize;
+
+  Aead = Context;
+  OutSize = Aead->DataSize;
+  return SpdmAeadSeal (
+           Aead->AEADCipherSuite,
+           Aead->AeadContext,
+           Aead->Iv, GetSpdmAeadIvSize (Aead->AEADCipherSuite),
+           Aead->AData, sizeof(Aead->AData),
+           Aead->Data, Aead->DataSize,
+           Aead->Tag, GetSpdmAeadTagSize (Aead->AEADCipherSuite),
+           Aead->Cipher, &OutSize
+           );
+}
+
+/**
+  Benchmark AES-GCM and ChaCha20-Poly1305.
+
+  Both the one-shot interface, which runs the key schedule for every record,
+  and the keyed context interface used by secured messages are measured.
+**/
+VOID
+BenchCryptAead (
+  VOID
+  )
+{
+  CRYPT_BENCH_AEAD_CONTEXT  Aead;
+  UINT8                     *Buffer;
+  UINTN                     AlgoIndex;
+  UINTN                     SizeIndex;
+
+  Buffer = AllocatePool (CRYPT_BENCH_MAX_RECORD_SIZE * 3);
+  if (Buffer == NULL) {
+    return ;
+  }
+  ZeroMem (&Aead, sizeof(Aead));
+  Aead.Data = Buffer;
+  Aead.Cipher = Buffer + CRYPT_BENCH_MAX_RECORD_SIZE;
+  Aead.Plain = Buffer + CRYPT_BENCH_MAX_RECORD_SIZE * 2;
+  SpdmGetRandomNumber (CRYPT_BENCH_MAX_RECORD_SIZE, Aead.Data);
+  SpdmGetRandomNumber (sizeof(Aead.Key), Aead.Key);
+  SpdmGetRandomNumber (sizeof(Aead.Iv), Aead.Iv);
+  SpdmGetRandomNumber (sizeof(Aead.AData), Aead.AData);
+
+  for (AlgoIndex = 0; AlgoIndex < ARRAY_SIZE(mCryptBenchAeadAlgo); AlgoIndex++) {
+    Aead.AEADCipherSuite = mCryptBenchAeadAlgo[AlgoIndex].AEADCipherSuite;
+    for (SizeIndex = 0; SizeIndex < CRYPT_BENCH_RECORD_SIZE_COUNT; SizeIndex++) {
+      Aead.DataSize = mCryptBenchRecordSize[SizeIndex];
+      CryptBenchRun ("AEAD-Encrypt", mCryptBenchAeadAlgo[AlgoIndex].Name, Aead.DataSize, BenchAeadEncrypt, &Aead);
+      //
+      // Decrypt the record encrypted by the last run, so that the tag check passes.
+      //
+      CryptBenchRun ("AEAD-Decrypt", mCryptBenchAeadAlgo[AlgoIndex].Name, Aead.DataSize, BenchAeadDecrypt, &Aead);
+    }
+
+    Aead.AeadContext = SpdmAeadNew (Aead.AEADCipherSuite);
+    if ((Aead.AeadContext == NULL) ||
+        !SpdmAeadSetKey (Aead.AEADCipherSuite, Aead.AeadContext, Aead.Key, GetSpdmAeadKeySize (Aead.AEADCipherSuite))) {
+      CryptBenchReportUnsupported ("AEAD-Seal", mCryptBenchAeadAlgo[AlgoIndex].Name);
+    } else {
+      for (SizeIndex = 0; SizeIndex < CRYPT_BENCH_RECORD_SIZE_COUNT; SizeIndex++) {
+        Aead.DataSize = mCryptBenchRecordSize[SizeIndex];
+        CryptBenchRun ("AEAD-Seal", mCryptBenchAeadAlgo[AlgoIndex].Name, Aead.DataSize, BenchAeadSeal, &Aead);
+      }
+    }
+    if (Aead.AeadContext != NULL) {
+      SpdmAeadFree (Aead.AEADCipherSuite, Aead.AeadContext);
+      Aead.AeadContext = NULL;
+    }
+  }
+
+  FreePool (Buffer);
+}
@@ -0,0 +1,302 @@
+/** @file
+  Benchmark for signature primitives.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptBench.h"
+
+typedef struct {
+  UINT32    BaseAsymAlgo;
+  UINT32    BaseHashAlgo;
+  CHAR8     *Name;
+  CHAR8     *KeyFile;
+  CHAR8     *CertFile;
+} CRYPT_BENCH_ASYM_ALGO;
+
+//
+// The keys are the responder test keys in SpdmEmu/TestKey, copied next to the executable.
+//
+CRYPT_BENCH_ASYM_ALGO  mCryptBenchAsymAlgo[] = {
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048,         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, "RSASSA-2048", "Rsa2048/end_responder.key", "Rsa2048/end_responder.cert.der"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072,         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384, "RSASSA-3072", "Rsa3072/end_responder.key", "Rsa3072/end_responder.cert.der"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048,         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, "RSAPSS-2048", "Rsa2048/end_responder.key", "Rsa2048/end_responder.cert.der"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072,         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384, "RSAPSS-3072", "Rsa3072/end_responder.key", "Rsa3072/end_responder.cert.der"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256, SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, "ECDSA-P256",  "EcP256/end_responder.key",  "EcP256/end_responder.cert.der"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384, SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384, "ECDSA-P384",  "EcP384/end_responder.key",  "EcP384/end_responder.cert.der"},
+};
+
+//
+// SPDM signs the hash of the transcript, which is a few KB at most.
+//
+#define CRYPT_BENCH_ASYM_MESSAGE_SIZE  1024
+
+//
+// The number of signatures verified by one SpdmAsymVerifyBatch.
+//
+#define CRYPT_BENCH_ASYM_BATCH_SIZE  16
+
+typedef struct {
+  UINT32    BaseAsymAlgo;
+  UINT32    BaseHashAlgo;
+  VOID      *PrivateKey;
+  VOID      *PublicKey;
+  VOID      *PreparedKey;
+  UINT8     Message[CRYPT_BENCH_ASYM_MESSAGE_SIZE];
+  UINT8     Signature[MAX_ASYM_KEY_SIZE];
+  UINTN     SigSize;
+} CRYPT_BENCH_ASYM_CONTEXT;
+
+BOOLEAN
+BenchAsymSign (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_ASYM_CONTEXT  *Asym;
+
+  Asym = Context;
+  Asym->SigSize = sizeof(Asym->Signature);
+  return SpdmAsymSign (Asym->BaseAsymAlgo, Asym->BaseHashAlgo, Asym->PrivateKey, Asym->Message, sizeof(Asym->Message), Asym->Signature, &Asym->SigSize);
+}
+
+BOOLEAN
+BenchAsymVerify (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_ASYM_CONTEXT  *Asym;
+
+  Asym = Context;
+  return SpdmAsymVerify (Asym->BaseAsymAlgo, Asym->BaseHashAlgo, Asym->PublicKey, Asym->Message, sizeof(Asym->Message), Asym->Signature, Asym->SigSize);
+}
+
+BOOLEAN
+BenchAsymVerifyBatch (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_ASYM_CONTEXT  *Asym;
+  SPDM_ASYM_VERIFY_ITEM     Item[CRYPT_BENCH_ASYM_BATCH_SIZE];
+  UINTN                     Index;
+
+  Asym = Context;
+  for (Index = 0; Index < CRYPT_BENCH_ASYM_BATCH_SIZE; Index++) {
+    Item[Index].Context = Asym->PublicKey;
+    Item[Index].Message = Asym->Message;
+    Item[Index].MessageSize = sizeof(Asym->Message);
+    Item[Index].Signature = Asym->Signature;
+    Item[Index].SigSize = Asym->SigSize;
+  }
+  return SpdmAsymVerifyBatch (Asym->BaseAsymAlgo, Asym->BaseHashAlgo, Item, CRYPT_BENCH_ASYM_BATCH_SIZE, NULL);
+}
+
+BOOLEAN
+BenchAsymVerifyPrepared (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_ASYM_CONTEXT  *Asym;
+  UINT8                     MessageHash[MAX_HASH_SIZE];
+
+  Asym = Context;
+  if (!SpdmHashAll (Asym->BaseHashAlgo, Asym->Message, sizeof(Asym->Message), MessageHash)) {
+    return FALSE;
+  }
+  return SpdmAsymVerifyHashPrepared (Asym->BaseAsymAlgo, Asym->BaseHashAlgo, Asym->PreparedKey, MessageHash, Asym->Signature, Asym->SigSize);
+}
+
+BOOLEAN
+BenchEdDsaSign (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_ASYM_CONTEXT  *Asym;
+
+  Asym = Context;
+  Asym->SigSize = sizeof(Asym->Signature);
+  return EdDsaSign (Asym->PrivateKey, CRYPTO_NID_NULL, Asym->Message, sizeof(Asym->Message), Asym->Signature, &Asym->SigSize);
+}
+
+BOOLEAN
+BenchEdDsaVerify (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_ASYM_CONTEXT  *Asym;
+
+  Asym = Context;
+  return EdDsaVerify (Asym->PublicKey, CRYPTO_NID_NULL, Asym->Message, sizeof(Asym->Message), Asym->Signature, Asym->SigSize);
+}
+
+BOOLEAN
+BenchSm2Sign (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_ASYM_CONTEXT  *Asym;
+
+  Asym = Context;
+  Asym->SigSize = sizeof(Asym->Signature);
+  return Sm2Sign (Asym->PrivateKey, CRYPTO_NID_SM3_256, Asym->Message, sizeof(Asym->Message), Asym->Signature, &Asym->SigSize);
+}
+
+BOOLEAN
+BenchSm2Verify (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_ASYM_CONTEXT  *Asym;
+
+  Asym = Context;
+  return Sm2Verify (Asym->PublicKey, CRYPTO_NID_SM3_256, Asym->Message, sizeof(Asym->Message), Asym->Signature, Asym->SigSize);
+}
+
+/**
+  Read the PEM private key and the DER certificate of one test key.
+
+  @param  KeyFile                      The PEM private key file.
+  @param  CertFile                     The DER certificate file.
+  @param  PemData                      The PEM private key data, to be freed by the caller.
+  @param  PemSize                      Size in bytes of the PEM private key data.
+  @param  CertData                     The DER certificate data, to be freed by the caller.
+  @param  CertSize                     Size in bytes of the DER certificate data.
+
+  @retval TRUE   Both files are read.
+  @retval FALSE  One file cannot be read.
+**/
+BOOLEAN
+BenchReadTestKey (
+  IN  CHAR8    *KeyFile,
+  IN  CHAR8    *CertFile,
+  OUT VOID     **PemData,
+  OUT UINTN    *PemSize,
+  OUT VOID     **CertData,
+  OUT UINTN    *CertSize
+  )
+{
+  if (!ReadInputFile (KeyFile, PemData, PemSize)) {
+    return FALSE;
+  }
+  if (!ReadInputFile (CertFile, CertData, CertSize)) {
+    free (*PemData);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Benchmark RSASSA, RSAPSS, ECDSA, EdDSA and SM2 signature generation and verification.
+**/
+VOID
+BenchCryptAsym (
+  VOID
+  )
+{
+  CRYPT_BENCH_ASYM_CONTEXT  Asym;
+  VOID                      *PemData;
+  UINTN                     PemSize;
+  VOID                      *CertData;
+  UINTN                     CertSize;
+  UINTN                     AlgoIndex;
+
+  ZeroMem (&Asym, sizeof(Asym));
+  SpdmGetRandomNumber (sizeof(Asym.Message), Asym.Message);
+
+  for (AlgoIndex = 0; AlgoIndex < ARRAY_SIZE(mCryptBenchAsymAlgo); AlgoIndex++) {
+    Asym.BaseAsymAlgo = mCryptBenchAsymAlgo[AlgoIndex].BaseAsymAlgo;
+    Asym.BaseHashAlgo = mCryptBenchAsymAlgo[AlgoIndex].BaseHashAlgo;
+    Asym.PrivateKey = NULL;
+    Asym.PublicKey = NULL;
+    Asym.PreparedKey = NULL;
+    if (BenchReadTestKey (mCryptBenchAsymAlgo[AlgoIndex].KeyFile, mCryptBenchAsymAlgo[AlgoIndex].CertFile, &PemData, &PemSize, &CertData, &CertSize)) {
+      if (!SpdmAsymGetPrivateKeyFromPem (Asym.BaseAsymAlgo, PemData, PemSize, NULL, &Asym.PrivateKey)) {
+        Asym.PrivateKey = NULL;
+      }
+      if (!SpdmAsymGetPublicKeyFromX509 (Asym.BaseAsymAlgo, CertData, CertSize, &Asym.PublicKey)) {
+        Asym.PublicKey = NULL;
+      }
+      free (PemData);
+      free (CertData);
+    }
+    if ((Asym.PrivateKey == NULL) || (Asym.PublicKey == NULL)) {
+      CryptBenchReportUnsupported ("Sign", mCryptBenchAsymAlgo[AlgoIndex].Name);
+      CryptBenchReportUnsupported ("Verify", mCryptBenchAsymAlgo[AlgoIndex].Name);
+      CryptBenchReportUnsupported ("VerifyBatch16", mCryptBenchAsymAlgo[AlgoIndex].Name);
+      CryptBenchReportUnsupported ("VerifyPrepared", mCryptBenchAsymAlgo[AlgoIndex].Name);
+    } else {
+      CryptBenchRun ("Sign", mCryptBenchAsymAlgo[AlgoIndex].Name, 0, BenchAsymSign, &Asym);
+      CryptBenchRun ("Verify", mCryptBenchAsymAlgo[AlgoIndex].Name, 0, BenchAsymVerify, &Asym);
+      CryptBenchRun ("VerifyBatch16", mCryptBenchAsymAlgo[AlgoIndex].Name, 0, BenchAsymVerifyBatch, &Asym);
+      Asym.PreparedKey = SpdmAsymPreparePublicKey (Asym.BaseAsymAlgo, Asym.PublicKey);
+      if (Asym.PreparedKey == NULL) {
+        CryptBenchReportUnsupported ("VerifyPrepared", mCryptBenchAsymAlgo[AlgoIndex].Name);
+      } else {
+        CryptBenchRun ("VerifyPrepared", mCryptBenchAsymAlgo[AlgoIndex].Name, 0, BenchAsymVerifyPrepared, &Asym);
+        SpdmAsymFreePreparedPublicKey (Asym.BaseAsymAlgo, Asym.PreparedKey);
+      }
+    }
+    if (Asym.PrivateKey != NULL) {
+      SpdmAsymFree (Asym.BaseAsymAlgo, Asym.PrivateKey);
+    }
+    if (Asym.PublicKey != NULL) {
+      SpdmAsymFree (Asym.BaseAsymAlgo, Asym.PublicKey);
+    }
+  }
+
+  //
+  // SpdmCryptLib has no BaseAsymAlgo for EdDSA and SM2 yet, so BaseCryptLib is called directly.
+  //
+  Asym.PrivateKey = NULL;
+  Asym.PublicKey = NULL;
+  if (BenchReadTestKey ("Ed25519/end_responder.key", "Ed25519/end_responder.cert.der", &PemData, &PemSize, &CertData, &CertSize)) {
+    if (!EdGetPrivateKeyFromPem (PemData, PemSize, NULL, &Asym.PrivateKey)) {
+      Asym.PrivateKey = NULL;
+    }
+    if (!EdGetPublicKeyFromX509 (CertData, CertSize, &Asym.PublicKey)) {
+      Asym.PublicKey = NULL;
+    }
+    free (PemData);
+    free (CertData);
+  }
+  if ((Asym.PrivateKey == NULL) || (Asym.PublicKey == NULL)) {
+    CryptBenchReportUnsupported ("Sign", "EDDSA-ED25519");
+    CryptBenchReportUnsupported ("Verify", "EDDSA-ED25519");
+  } else {
+    CryptBenchRun ("Sign", "EDDSA-ED25519", 0, BenchEdDsaSign, &Asym);
+    CryptBenchRun ("Verify", "EDDSA-ED25519", 0, BenchEdDsaVerify, &Asym);
+  }
+  if (Asym.PrivateKey != NULL) {
+    EdFree (Asym.PrivateKey);
+  }
+  if (Asym.PublicKey != NULL) {
+    EdFree (Asym.PublicKey);
+  }
+
+  Asym.PrivateKey = NULL;
+  Asym.PublicKey = NULL;
+  if (BenchReadTestKey ("Sm2/end_responder.key", "Sm2/end_responder.cert.der", &PemData, &PemSize, &CertData, &CertSize)) {
+    if (!Sm2GetPrivateKeyFromPem (PemData, PemSize, NULL, &Asym.PrivateKey)) {
+      Asym.PrivateKey = NULL;
+    }
+    if (!Sm2GetPublicKeyFromX509 (CertData, CertSize, &Asym.PublicKey)) {
+      Asym.PublicKey = NULL;
+    }
+    free (PemData);
+    free (CertData);
+  }
+  if ((Asym.PrivateKey == NULL) || (Asym.PublicKey == NULL)) {
+    CryptBenchReportUnsupported ("Sign", "SM2-P256");
+    CryptBenchReportUnsupported ("Verify", "SM2-P256");
+  } else {
+    CryptBenchRun ("Sign", "SM2-P256", 0, BenchSm2Sign, &Asym);
+    CryptBenchRun ("Verify", "SM2-P256", 0, BenchSm2Verify, &Asym);
+  }
+  if (Asym.PrivateKey != NULL) {
+    Sm2Free (Asym.PrivateKey);
+  }
+  if (Asym.PublicKey != NULL) {
+    Sm2Free (Asym.PublicKey);
+  }
+}
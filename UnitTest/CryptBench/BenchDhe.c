@@ -0,0 +1,191 @@
+/** @file
+  Benchmark for DHE primitives.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptBench.h"
+
+typedef struct {
+  UINT16    DHENamedGroup;
+  CHAR8     *Name;
+} CRYPT_BENCH_DHE_ALGO;
+
+CRYPT_BENCH_DHE_ALGO  mCryptBenchDheAlgo[] = {
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048,  "FFDHE-2048"},
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072,  "FFDHE-3072"},
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_4096,  "FFDHE-4096"},
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1, "SECP-256R1"},
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1, "SECP-384R1"},
+  {SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_521_R1, "SECP-521R1"},
+};
+
+typedef struct {
+  UINTN     Nid;
+  CHAR8     *Name;
+} CRYPT_BENCH_ECX_ALGO;
+
+CRYPT_BENCH_ECX_ALGO  mCryptBenchEcxAlgo[] = {
+  {CRYPTO_NID_X25519, "X25519"},
+  {CRYPTO_NID_X448,   "X448"},
+};
+
+typedef struct {
+  UINT16    DHENamedGroup;
+  UINTN     Nid;
+  VOID      *Context;
+  UINT8     PeerPublic[MAX_DHE_KEY_SIZE];
+  UINTN     PeerPublicSize;
+  UINT8     Key[MAX_DHE_KEY_SIZE];
+  UINTN     KeySize;
+} CRYPT_BENCH_DHE_CONTEXT;
+
+/**
+  Measure what a KEY_EXCHANGE responder pays per session: a new context and a new key pair.
+**/
+BOOLEAN
+BenchDheGenerateKey (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_DHE_CONTEXT  *Dhe;
+  VOID                     *DheContext;
+  UINT8                    PublicKey[MAX_DHE_KEY_SIZE];
+  UINTN                    PublicKeySize;
+  BOOLEAN                  Result;
+
+  Dhe = Context;
+  DheContext = SpdmDheNew (Dhe->DHENamedGroup);
+  if (DheContext == NULL) {
+    return FALSE;
+  }
+  PublicKeySize = GetSpdmDhePubKeySize (Dhe->DHENamedGroup);
+  Result = SpdmDheGenerateKey (Dhe->DHENamedGroup, DheContext, PublicKey, &PublicKeySize);
+  SpdmDheFree (Dhe->DHENamedGroup, DheContext);
+  return Result;
+}
+
+BOOLEAN
+BenchDheComputeKey (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_DHE_CONTEXT  *Dhe;
+
+  Dhe = Context;
+  Dhe->KeySize = sizeof(Dhe->Key);
+  return SpdmDheComputeKey (Dhe->DHENamedGroup, Dhe->Context, Dhe->PeerPublic, Dhe->PeerPublicSize, Dhe->Key, &Dhe->KeySize);
+}
+
+BOOLEAN
+BenchEcxGenerateKey (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_DHE_CONTEXT  *Dhe;
+  VOID                     *EcxContext;
+  UINT8                    PublicKey[MAX_DHE_KEY_SIZE];
+  UINTN                    PublicKeySize;
+  BOOLEAN                  Result;
+
+  Dhe = Context;
+  EcxContext = EcxNewByNid (Dhe->Nid);
+  if (EcxContext == NULL) {
+    return FALSE;
+  }
+  PublicKeySize = sizeof(PublicKey);
+  Result = EcxGenerateKey (EcxContext, PublicKey, &PublicKeySize);
+  EcxFree (EcxContext);
+  return Result;
+}
+
+BOOLEAN
+BenchEcxComputeKey (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_DHE_CONTEXT  *Dhe;
+
+  Dhe = Context;
+  Dhe->KeySize = sizeof(Dhe->Key);
+  return EcxComputeKey (Dhe->Context, Dhe->PeerPublic, Dhe->PeerPublicSize, Dhe->Key, &Dhe->KeySize);
+}
+
+/**
+  Benchmark FFDHE and ECDHE key generation and shared secret computation.
+**/
+VOID
+BenchCryptDhe (
+  VOID
+  )
+{
+  CRYPT_BENCH_DHE_CONTEXT  Dhe;
+  VOID                     *PeerContext;
+  UINT8                    PublicKey[MAX_DHE_KEY_SIZE];
+  UINTN                    PublicKeySize;
+  UINTN                    AlgoIndex;
+  BOOLEAN                  Result;
+
+  ZeroMem (&Dhe, sizeof(Dhe));
+
+  for (AlgoIndex = 0; AlgoIndex < ARRAY_SIZE(mCryptBenchDheAlgo); AlgoIndex++) {
+    Dhe.DHENamedGroup = mCryptBenchDheAlgo[AlgoIndex].DHENamedGroup;
+    Dhe.Context = SpdmDheNew (Dhe.DHENamedGroup);
+    PeerContext = SpdmDheNew (Dhe.DHENamedGroup);
+    Result = (Dhe.Context != NULL) && (PeerContext != NULL);
+    if (Result) {
+      PublicKeySize = GetSpdmDhePubKeySize (Dhe.DHENamedGroup);
+      Result = SpdmDheGenerateKey (Dhe.DHENamedGroup, Dhe.Context, PublicKey, &PublicKeySize);
+    }
+    if (Result) {
+      Dhe.PeerPublicSize = GetSpdmDhePubKeySize (Dhe.DHENamedGroup);
+      Result = SpdmDheGenerateKey (Dhe.DHENamedGroup, PeerContext, Dhe.PeerPublic, &Dhe.PeerPublicSize);
+    }
+
+    if (!Result) {
+      CryptBenchReportUnsupported ("DHE-GenerateKey", mCryptBenchDheAlgo[AlgoIndex].Name);
+      CryptBenchReportUnsupported ("DHE-ComputeKey", mCryptBenchDheAlgo[AlgoIndex].Name);
+    } else {
+      CryptBenchRun ("DHE-GenerateKey", mCryptBenchDheAlgo[AlgoIndex].Name, 0, BenchDheGenerateKey, &Dhe);
+      CryptBenchRun ("DHE-ComputeKey", mCryptBenchDheAlgo[AlgoIndex].Name, 0, BenchDheComputeKey, &Dhe);
+    }
+
+    if (Dhe.Context != NULL) {
+      SpdmDheFree (Dhe.DHENamedGroup, Dhe.Context);
+    }
+    if (PeerContext != NULL) {
+      SpdmDheFree (Dhe.DHENamedGroup, PeerContext);
+    }
+  }
+
+  //
+  // SpdmCryptLib has no DHENamedGroup for X25519 and X448 yet, so BaseCryptLib is called directly.
+  //
+  for (AlgoIndex = 0; AlgoIndex < ARRAY_SIZE(mCryptBenchEcxAlgo); AlgoIndex++) {
+    Dhe.Nid = mCryptBenchEcxAlgo[AlgoIndex].Nid;
+    Dhe.Context = EcxNewByNid (Dhe.Nid);
+    PeerContext = EcxNewByNid (Dhe.Nid);
+    Result = (Dhe.Context != NULL) && (PeerContext != NULL);
+    if (Result) {
+      PublicKeySize = sizeof(PublicKey);
+      Result = EcxGenerateKey (Dhe.Context, PublicKey, &PublicKeySize);
+    }
+    if (Result) {
+      Dhe.PeerPublicSize = sizeof(Dhe.PeerPublic);
+      Result = EcxGenerateKey (PeerContext, Dhe.PeerPublic, &Dhe.PeerPublicSize);
+    }
+
+    if (!Result) {
+      CryptBenchReportUnsupported ("DHE-GenerateKey", mCryptBenchEcxAlgo[AlgoIndex].Name);
+      CryptBenchReportUnsupported ("DHE-ComputeKey", mCryptBenchEcxAlgo[AlgoIndex].Name);
+    } else {
+      CryptBenchRun ("DHE-GenerateKey", mCryptBenchEcxAlgo[AlgoIndex].Name, 0, BenchEcxGenerateKey, &Dhe);
+      CryptBenchRun ("DHE-ComputeKey", mCryptBenchEcxAlgo[AlgoIndex].Name, 0, BenchEcxComputeKey, &Dhe);
+    }
+
+    EcxFree (Dhe.Context);
+    EcxFree (PeerContext);
+  }
+}
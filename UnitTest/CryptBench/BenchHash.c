@@ -0,0 +1,110 @@
+/** @file
+  Benchmark for hash, HMAC and HKDF primitives.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptBench.h"
+
+typedef struct {
+  UINT32    BaseHashAlgo;
+  CHAR8     *Name;
+} CRYPT_BENCH_HASH_ALGO;
+
+CRYPT_BENCH_HASH_ALGO  mCryptBenchHashAlgo[] = {
+  {SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, "256"},
+  {SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384, "384"},
+  {SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_512, "512"},
+};
+
+typedef struct {
+  UINT32    BaseHashAlgo;
+  UINT8     *Data;
+  UINTN     DataSize;
+  UINT8     Key[MAX_HASH_SIZE];
+  UINTN     KeySize;
+  UINT8     Out[MAX_HASH_SIZE * 2];
+  UINTN     OutSize;
+} CRYPT_BENCH_HASH_CONTEXT;
+
+BOOLEAN
+BenchHashAll (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_HASH_CONTEXT  *HashContext;
+
+  HashContext = Context;
+  return SpdmHashAll (HashContext->BaseHashAlgo, HashContext->Data, HashContext->DataSize, HashContext->Out);
+}
+
+BOOLEAN
+BenchHmacAll (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_HASH_CONTEXT  *HashContext;
+
+  HashContext = Context;
+  return SpdmHmacAll (HashContext->BaseHashAlgo, HashContext->Data, HashContext->DataSize, HashContext->Key, HashContext->KeySize, HashContext->Out);
+}
+
+BOOLEAN
+BenchHkdfExpand (
+  IN VOID    *Context
+  )
+{
+  CRYPT_BENCH_HASH_CONTEXT  *HashContext;
+
+  HashContext = Context;
+  return SpdmHkdfExpand (HashContext->BaseHashAlgo, HashContext->Key, HashContext->KeySize, HashContext->Data, HashContext->DataSize, HashContext->Out, HashContext->OutSize);
+}
+
+/**
+  Benchmark SHA-256/384/512, HMAC and HKDF-Expand.
+**/
+VOID
+BenchCryptHash (
+  VOID
+  )
+{
+  CRYPT_BENCH_HASH_CONTEXT  HashContext;
+  UINT8                     *Data;
+  UINTN                     AlgoIndex;
+  UINTN                     SizeIndex;
+
+  Data = AllocatePool (CRYPT_BENCH_MAX_RECORD_SIZE);
+  if (Data == NULL) {
+    return ;
+  }
+  SpdmGetRandomNumber (CRYPT_BENCH_MAX_RECORD_SIZE, Data);
+
+  for (AlgoIndex = 0; AlgoIndex < ARRAY_SIZE(mCryptBenchHashAlgo); AlgoIndex++) {
+    ZeroMem (&HashContext, sizeof(HashContext));
+    HashContext.BaseHashAlgo = mCryptBenchHashAlgo[AlgoIndex].BaseHashAlgo;
+    HashContext.Data = Data;
+    HashContext.KeySize = GetSpdmHashSize (HashContext.BaseHashAlgo);
+    SpdmGetRandomNumber (HashContext.KeySize, HashContext.Key);
+
+    for (SizeIndex = 0; SizeIndex < CRYPT_BENCH_RECORD_SIZE_COUNT; SizeIndex++) {
+      HashContext.DataSize = mCryptBenchRecordSize[SizeIndex];
+      CryptBenchRun ("SHA", mCryptBenchHashAlgo[AlgoIndex].Name, HashContext.DataSize, BenchHashAll, &HashContext);
+    }
+    for (SizeIndex = 0; SizeIndex < CRYPT_BENCH_RECORD_SIZE_COUNT; SizeIndex++) {
+      HashContext.DataSize = mCryptBenchRecordSize[SizeIndex];
+      CryptBenchRun ("HMAC-SHA", mCryptBenchHashAlgo[AlgoIndex].Name, HashContext.DataSize, BenchHmacAll, &HashContext);
+    }
+
+    //
+    // The SPDM key schedule expands one hash-sized secret, or a small AEAD key or IV,
+    // from a short bin_concat label.
+    //
+    HashContext.DataSize = 32;
+    HashContext.OutSize = HashContext.KeySize;
+    CryptBenchRun ("HKDF-Expand-SHA", mCryptBenchHashAlgo[AlgoIndex].Name, HashContext.OutSize, BenchHkdfExpand, &HashContext);
+  }
+
+  FreePool (Data);
+}
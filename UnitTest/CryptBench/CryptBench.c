@@ -0,0 +1,124 @@
+/** @file
+  Application for Cryptographic Primitives Benchmark.
+
+  Every primitive dispatched by SpdmCryptLib is measured with the crypto backend
+  the application is linked with. One CSV line is printed per measurement:
+  backend,primitive,parameter,size,iterations,ns_per_op,mb_per_s,status
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptBench.h"
+
+UINTN  mCryptBenchRecordSize[CRYPT_BENCH_RECORD_SIZE_COUNT] = {64, 256, 1024, CRYPT_BENCH_MAX_RECORD_SIZE};
+
+//
+// Minimum measurement time of one operation, in nanoseconds.
+//
+UINT64 mCryptBenchMinTimeNs = 200000000ull;
+
+/**
+  Measure one operation and report one result line.
+
+  The operation is repeated until the minimum measurement time is reached.
+
+  @param  Primitive                    The name of the primitive, such as "SHA".
+  @param  Parameter                    The name of the algorithm parameter, such as "256".
+  @param  DataSize                     The size in bytes of the data processed by one operation, or 0.
+  @param  Func                         The operation.
+  @param  Context                      The context of the operation.
+**/
+VOID
+CryptBenchRun (
+  IN CHAR8            *Primitive,
+  IN CHAR8            *Parameter,
+  IN UINTN            DataSize,
+  IN CRYPT_BENCH_FUNC Func,
+  IN VOID             *Context
+  )
+{
+  UINT64   Iterations;
+  UINT64   Batch;
+  UINT64   Index;
+  UINT64   Start;
+  UINT64   Elapsed;
+  double   NsPerOp;
+  double   MbPerSec;
+
+  //
+  // Warm up, and check that the operation works at all with this backend.
+  //
+  if (!Func (Context)) {
+    printf ("%s,%s,%s,%u,0,0,0,fail\n", CRYPT_BENCH_BACKEND_NAME, Primitive, Parameter, (UINT32)DataSize);
+    return ;
+  }
+
+  Iterations = 0;
+  Batch = 1;
+  Start = CryptBenchGetTimeNs ();
+  do {
+    for (Index = 0; Index < Batch; Index++) {
+      if (!Func (Context)) {
+        printf ("%s,%s,%s,%u,0,0,0,fail\n", CRYPT_BENCH_BACKEND_NAME, Primitive, Parameter, (UINT32)DataSize);
+        return ;
+      }
+    }
+    Iterations += Batch;
+    Batch *= 2;
+    Elapsed = CryptBenchGetTimeNs () - Start;
+  } while (Elapsed < mCryptBenchMinTimeNs);
+
+  NsPerOp = (double)Elapsed / (double)Iterations;
+  MbPerSec = 0;
+  if (DataSize != 0) {
+    MbPerSec = ((double)DataSize * (double)Iterations * 1000.0) / (double)Elapsed;
+  }
+  printf (
+    "%s,%s,%s,%u,%llu,%.1f,%.2f,ok\n",
+    CRYPT_BENCH_BACKEND_NAME,
+    Primitive,
+    Parameter,
+    (UINT32)DataSize,
+    (unsigned long long)Iterations,
+    NsPerOp,
+    MbPerSec
+    );
+}
+
+/**
+  Report a primitive which cannot be measured with this crypto backend.
+
+  @param  Primitive                    The name of the primitive.
+  @param  Parameter                    The name of the algorithm parameter.
+**/
+VOID
+CryptBenchReportUnsupported (
+  IN CHAR8            *Primitive,
+  IN CHAR8            *Parameter
+  )
+{
+  printf ("%s,%s,%s,0,0,0,0,unsupported\n", CRYPT_BENCH_BACKEND_NAME, Primitive, Parameter);
+}
+
+/**
+  Entry Point of Cryptographic Benchmark Utility.
+
+  An optional argument gives the minimum measurement time of one operation, in milliseconds.
+**/
+int main(int argc, char *argv[])
+{
+  if (argc > 1) {
+    mCryptBenchMinTimeNs = (UINT64)strtoul (argv[1], NULL, 0) * 1000000ull;
+  }
+
+  RandomSeed (NULL, 0);
+
+  printf ("backend,primitive,parameter,size,iterations,ns_per_op,mb_per_s,status\n");
+  BenchCryptHash ();
+  BenchCryptAead ();
+  BenchCryptAsym ();
+  BenchCryptDhe ();
+  return 0;
+}
@@ -0,0 +1,142 @@
+/** @file
+  Application for Cryptographic Primitives Benchmark.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __CRYPT_BENCH_H__
+#define __CRYPT_BENCH_H__
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#undef NULL
+
+#include <Base.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/BaseCryptLib.h>
+#include <Library/SpdmCryptLib.h>
+
+//
+// The build passes CRYPTBENCH_BACKEND_<CRYPTO> to name the crypto backend in the report.
+//
+#if defined(CRYPTBENCH_BACKEND_Openssl)
+#define CRYPT_BENCH_BACKEND_NAME  "Openssl"
+#elif defined(CRYPTBENCH_BACKEND_MbedTls)
+#define CRYPT_BENCH_BACKEND_NAME  "MbedTls"
+#else
+#define CRYPT_BENCH_BACKEND_NAME  "Unknown"
+#endif
+
+//
+// SPDM record sizes used for the bulk primitives, up to MAX_SPDM_MESSAGE_BUFFER_SIZE.
+//
+#define CRYPT_BENCH_RECORD_SIZE_COUNT  4
+extern UINTN  mCryptBenchRecordSize[CRYPT_BENCH_RECORD_SIZE_COUNT];
+
+#define CRYPT_BENCH_MAX_RECORD_SIZE    4096
+
+/**
+  One operation to be measured.
+
+  @param  Context                      The context of the operation.
+
+  @retval TRUE   The operation succeeded.
+  @retval FALSE  The operation failed.
+**/
+typedef
+BOOLEAN
+(*CRYPT_BENCH_FUNC) (
+  IN VOID    *Context
+  );
+
+/**
+  Measure one operation and report one result line.
+
+  The operation is repeated until the minimum measurement time is reached.
+
+  @param  Primitive                    The name of the primitive, such as "SHA".
+  @param  Parameter                    The name of the algorithm parameter, such as "256".
+  @param  DataSize                     The size in bytes of the data processed by one operation, or 0.
+  @param  Func                         The operation.
+  @param  Context                      The context of the operation.
+**/
+VOID
+CryptBenchRun (
+  IN CHAR8            *Primitive,
+  IN CHAR8            *Parameter,
+  IN UINTN            DataSize,
+  IN CRYPT_BENCH_FUNC Func,
+  IN VOID             *Context
+  );
+
+/**
+  Report a primitive which cannot be measured with this crypto backend.
+
+  @param  Primitive                    The name of the primitive.
+  @param  Parameter                    The name of the algorithm parameter.
+**/
+VOID
+CryptBenchReportUnsupported (
+  IN CHAR8            *Primitive,
+  IN CHAR8            *Parameter
+  );
+
+/**
+  Return a monotonic enough time stamp in nanoseconds.
+
+  @return the time stamp in nanoseconds.
+**/
+UINT64
+CryptBenchGetTimeNs (
+  VOID
+  );
+
+BOOLEAN
+ReadInputFile (
+  IN CHAR8    *FileName,
+  OUT VOID    **FileData,
+  OUT UINTN   *FileSize
+  );
+
+/**
+  Benchmark SHA-256/384/512, HMAC and HKDF-Expand.
+**/
+VOID
+BenchCryptHash (
+  VOID
+  );
+
+/**
+  Benchmark AES-GCM and ChaCha20-Poly1305.
+**/
+VOID
+BenchCryptAead (
+  VOID
+  );
+
+/**
+  Benchmark RSASSA, RSAPSS, ECDSA, EdDSA and SM2 signature generation and verification.
+**/
+VOID
+BenchCryptAsym (
+  VOID
+  );
+
+/**
+  Benchmark FFDHE and ECDHE key generation and shared secret computation.
+**/
+VOID
+BenchCryptDhe (
+  VOID
+  );
+
+#endif
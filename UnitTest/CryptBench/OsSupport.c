@@ -0,0 +1,67 @@
+/** @file
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CryptBench.h"
+
+#include <stdio.h>
+#include <time.h>
+
+BOOLEAN
+ReadInputFile (
+  IN CHAR8    *FileName,
+  OUT VOID    **FileData,
+  OUT UINTN   *FileSize
+  )
+{
+  FILE                        *FpIn;
+  UINTN                       TempResult;
+
+  if ((FpIn = fopen (FileName, "rb")) == NULL) {
+    printf ("# Unable to open file %s\n", FileName);
+    *FileData = NULL;
+    return FALSE;
+  }
+
+  fseek (FpIn, 0, SEEK_END);
+  *FileSize = ftell (FpIn);
+
+  *FileData = (VOID *) malloc (*FileSize);
+  if (NULL == *FileData) {
+    printf ("# No sufficient memory to allocate %s\n", FileName);
+    fclose (FpIn);
+    return FALSE;
+  }
+
+  fseek (FpIn, 0, SEEK_SET);
+  TempResult = fread (*FileData, 1, *FileSize, FpIn);
+  if (TempResult != *FileSize) {
+    printf ("# Read input file error %s\n", FileName);
+    free ((VOID *)*FileData);
+    fclose (FpIn);
+    return FALSE;
+  }
+
+  fclose (FpIn);
+
+  return TRUE;
+}
+
+/**
+  Return a monotonic enough time stamp in nanoseconds.
+
+  @return the time stamp in nanoseconds.
+**/
+UINT64
+CryptBenchGetTimeNs (
+  VOID
+  )
+{
+  struct timespec             Time;
+
+  timespec_get (&Time, TIME_UTC);
+  return (UINT64)Time.tv_sec * 1000000000ull + (UINT64)Time.tv_nsec;
+}
@@ -123,6 +123,12 @@ int main(int argc, char **argv)
 
   FileName = argv[1];
 
+#ifdef __AFL_LOOP
+  //
+  // With afl-clang-fast, one process runs many inputs in persistent mode.
+  //
+  while (__AFL_LOOP (1000)) {
+#endif
   // 1. Initialize TestBuffer
   Res = InitTestBuffer (FileName, GetMaxBufferSize(), &TestBuffer, &TestBufferSize);
   if (!Res) {
@@ -133,6 +139,9 @@ int main(int argc, char **argv)
   RunTestHarness (TestBuffer, TestBufferSize);
   // 3. Clean up
   free (TestBuffer);
+#ifdef __AFL_LOOP
+  }
+#endif
   return 0;
 }
 #endif
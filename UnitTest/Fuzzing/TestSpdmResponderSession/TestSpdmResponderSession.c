@@ -0,0 +1,925 @@
+/**
+@file
+UEFI OS based application.
+
+Persistent mode fuzzing of the SPDM responder with a sequence of messages.
+
+The requester and the responder SPDM contexts are prepared once per process, and snapshots of
+both are captured in some states of the flow by SpdmCloneContext. Each run restores one snapshot, then
+gives the messages of the input to SpdmProcessMessage of the responder, so that the run starts
+from a deep state at the cost of a copy, instead of a new context and a handshake.
+
+The input is:
+  UINT8   Snapshot                     The index of the snapshot, modulo TEST_SPDM_SNAPSHOT_COUNT.
+Followed by up to TEST_SPDM_MAX_MESSAGE_COUNT records of:
+  UINT8   Kind                         TEST_SPDM_MESSAGE_KIND_*, modulo 4.
+  UINT16  Length                       The length of Message, in little endian.
+  UINT8   Message[Length]              The SPDM message, or the transport message for TEST_SPDM_MESSAGE_KIND_RAW.
+
+The secured messages are encoded by the requester context in the session of the snapshot, so that
+the responder decodes them and processes the SPDM message inside, such as HEARTBEAT, KEY_UPDATE,
+END_SESSION, FINISH, PSK_FINISH or the encapsulated requests of the handshake.
+
+The certificates and the keys are read from the current directory, as in the unit tests.
+If they cannot be read, the snapshots which need them are not available.
+
+With libFuzzer, LLVMFuzzerCustomMutator and LLVMFuzzerCustomCrossOver mutate the input record by record,
+so that the mutations reach the handlers instead of failing the size and header checks.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmUnitFuzzing.h"
+#include "ToolChainHarness.h"
+#include <SpdmDeviceSecretLibInternal.h>
+
+#define TEST_SPDM_MAX_INPUT_SIZE             SIZE_64KB
+#define TEST_SPDM_MAX_MESSAGE_COUNT          16
+#define TEST_SPDM_TRANSPORT_BUFFER_SIZE      (MAX_SPDM_MESSAGE_BUFFER_SIZE + 0x100)
+
+#define TEST_SPDM_MESSAGE_KIND_PLAIN         0
+#define TEST_SPDM_MESSAGE_KIND_SECURED       1
+#define TEST_SPDM_MESSAGE_KIND_SECURED_APP   2
+#define TEST_SPDM_MESSAGE_KIND_RAW           3
+
+//
+// The snapshots, in the order of the flow.
+// Negotiated:  after GET_VERSION, GET_CAPABILITIES and NEGOTIATE_ALGORITHMS.
+// KeyExchange: after KEY_EXCHANGE with mutual authentication, before the encapsulated requests and FINISH.
+// PskExchange: after PSK_EXCHANGE, before PSK_FINISH.
+// Session:     in an established PSK session.
+//
+#define TEST_SPDM_SNAPSHOT_NEGOTIATED        0
+#define TEST_SPDM_SNAPSHOT_KEY_EXCHANGE      1
+#define TEST_SPDM_SNAPSHOT_PSK_EXCHANGE      2
+#define TEST_SPDM_SNAPSHOT_SESSION           3
+#define TEST_SPDM_SNAPSHOT_COUNT             4
+
+#define TEST_SPDM_REQUESTER_CAPABILITY_FLAGS  (SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CERT_CAP | \
+                                               SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CHAL_CAP | \
+                                               SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCRYPT_CAP | \
+                                               SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP | \
+                                               SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MUT_AUTH_CAP | \
+                                               SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP | \
+                                               SPDM_GET_CAPABILITIES_REQUEST_FLAGS_PSK_CAP_REQUESTER | \
+                                               SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCAP_CAP | \
+                                               SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP | \
+                                               SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_UPD_CAP)
+
+#define TEST_SPDM_RESPONDER_CAPABILITY_FLAGS  (SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP_SIG | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_FRESH_CAP | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCRYPT_CAP | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MAC_CAP | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MUT_AUTH_CAP | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP_RESPONDER_WITH_CONTEXT | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCAP_CAP | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP | \
+                                               SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_UPD_CAP)
+
+//
+// The clones of the requester and the responder contexts, with their secrets.
+//
+typedef struct {
+  BOOLEAN                 Valid;
+  UINT32                  SessionId;
+  VOID                    *Requester;
+  VOID                    *Responder;
+} TEST_SPDM_SNAPSHOT;
+
+SPDM_TEST_CONTEXT       mTestSpdmRequesterContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  TRUE,
+};
+
+SPDM_TEST_CONTEXT       mTestSpdmResponderContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  FALSE,
+};
+
+BOOLEAN                 mTestSpdmInitialized;
+UINTN                   mTestSpdmContextSize;
+TEST_SPDM_SNAPSHOT      mTestSpdmSnapshot[TEST_SPDM_SNAPSHOT_COUNT];
+//
+// The snapshot captured by the requester transport on its first secured message, if not NULL.
+//
+TEST_SPDM_SNAPSHOT      *mTestSpdmCapture;
+
+UINT8                   mTestSpdmResponse[TEST_SPDM_TRANSPORT_BUFFER_SIZE];
+UINTN                   mTestSpdmResponseSize;
+UINT8                   mTestSpdmTransportMessage[TEST_SPDM_TRANSPORT_BUFFER_SIZE];
+UINT8                   mTestSpdmCertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+
+UINTN
+EFIAPI
+GetMaxBufferSize (
+  VOID
+  )
+{
+  return TEST_SPDM_MAX_INPUT_SIZE;
+}
+
+BOOLEAN
+ReadInputFile (
+  IN CHAR8    *FileName,
+  OUT VOID    **FileData,
+  OUT UINTN   *FileSize
+  )
+{
+  FILE                        *FpIn;
+  UINTN                       TempResult;
+
+  if ((FpIn = fopen (FileName, "rb")) == NULL) {
+    *FileData = NULL;
+    return FALSE;
+  }
+
+  fseek (FpIn, 0, SEEK_END);
+  *FileSize = ftell (FpIn);
+
+  *FileData = (VOID *) malloc (*FileSize);
+  if (NULL == *FileData) {
+    fclose (FpIn);
+    return FALSE;
+  }
+
+  fseek (FpIn, 0, SEEK_SET);
+  TempResult = fread (*FileData, 1, *FileSize, FpIn);
+  if (TempResult != *FileSize) {
+    free ((VOID *)*FileData);
+    fclose (FpIn);
+    return FALSE;
+  }
+
+  fclose (FpIn);
+
+  return TRUE;
+}
+
+/**
+  Clone an SPDM context with its secrets.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+
+  @return the clone, or NULL if the SPDM context cannot be cloned.
+**/
+VOID *
+TestSpdmCloneContext (
+  IN VOID  *SpdmContext
+  )
+{
+  VOID  *Clone;
+
+  Clone = malloc (mTestSpdmContextSize);
+  if (Clone == NULL) {
+    return NULL;
+  }
+  if (RETURN_ERROR(SpdmCloneContext (SpdmContext, SpdmCloneSecretsInclude, mTestSpdmContextSize, Clone))) {
+    free (Clone);
+    return NULL;
+  }
+  return Clone;
+}
+
+/**
+  Capture a snapshot of the requester and the responder.
+
+  @param  Snapshot                     The snapshot.
+  @param  SessionId                    The session of the secured messages, or INVALID_SESSION_ID.
+**/
+VOID
+TestSpdmCaptureSnapshot (
+  IN OUT TEST_SPDM_SNAPSHOT  *Snapshot,
+  IN     UINT32              SessionId
+  )
+{
+  Snapshot->SessionId = SessionId;
+  Snapshot->Requester = TestSpdmCloneContext (mTestSpdmRequesterContext.SpdmContext);
+  Snapshot->Responder = TestSpdmCloneContext (mTestSpdmResponderContext.SpdmContext);
+  Snapshot->Valid = (BOOLEAN)((Snapshot->Requester != NULL) && (Snapshot->Responder != NULL));
+}
+
+/**
+  Restore a snapshot of the requester and the responder.
+
+  @param  Snapshot                     The snapshot.
+**/
+VOID
+TestSpdmRestoreSnapshot (
+  IN TEST_SPDM_SNAPSHOT  *Snapshot
+  )
+{
+  SpdmDeinitContext (mTestSpdmRequesterContext.SpdmContext);
+  SpdmCloneContext (Snapshot->Requester, SpdmCloneSecretsInclude, mTestSpdmContextSize, mTestSpdmRequesterContext.SpdmContext);
+  SpdmDeinitContext (mTestSpdmResponderContext.SpdmContext);
+  SpdmCloneContext (Snapshot->Responder, SpdmCloneSecretsInclude, mTestSpdmContextSize, mTestSpdmResponderContext.SpdmContext);
+}
+
+RETURN_STATUS
+EFIAPI
+TestSpdmSendMessage (
+  IN     VOID                                   *SpdmContext,
+  IN     UINTN                                  RequestSize,
+  IN     VOID                                   *Request,
+  IN     UINT64                                 Timeout
+  )
+{
+  UINT32  *SessionId;
+
+  SessionId = NULL;
+  mTestSpdmResponseSize = sizeof(mTestSpdmResponse);
+  if (RETURN_ERROR(SpdmProcessMessage (mTestSpdmResponderContext.SpdmContext, &SessionId, Request, RequestSize, mTestSpdmResponse, &mTestSpdmResponseSize))) {
+    mTestSpdmResponseSize = 0;
+    return RETURN_DEVICE_ERROR;
+  }
+  return RETURN_SUCCESS;
+}
+
+RETURN_STATUS
+EFIAPI
+TestSpdmReceiveMessage (
+  IN     VOID                                   *SpdmContext,
+  IN OUT UINTN                                  *ResponseSize,
+  IN OUT VOID                                   *Response,
+  IN     UINT64                                 Timeout
+  )
+{
+  if ((mTestSpdmResponseSize == 0) || (*ResponseSize < mTestSpdmResponseSize)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  CopyMem (Response, mTestSpdmResponse, mTestSpdmResponseSize);
+  *ResponseSize = mTestSpdmResponseSize;
+  mTestSpdmResponseSize = 0;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Encode a message of the requester. When a snapshot is to be captured, the first secured message
+  is not sent: the snapshot is captured instead, in the state of the handshake before it.
+**/
+RETURN_STATUS
+EFIAPI
+TestSpdmRequesterEncodeMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                MessageSize,
+  IN     VOID                 *Message,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  )
+{
+  if ((mTestSpdmCapture != NULL) && (SessionId != NULL)) {
+    TestSpdmCaptureSnapshot (mTestSpdmCapture, *SessionId);
+    mTestSpdmCapture = NULL;
+    return RETURN_DEVICE_ERROR;
+  }
+  return SpdmTransportTestEncodeMessage (SpdmContext, SessionId, IsAppMessage, IsRequester, MessageSize, Message, TransportMessageSize, TransportMessage);
+}
+
+VOID
+TestSpdmSetupContext (
+  IN VOID    *SpdmContext,
+  IN UINT32  CapabilityFlags
+  )
+{
+  SPDM_DATA_PARAMETER  Parameter;
+  UINT8                Data8;
+  UINT16               Data16;
+  UINT32               Data32;
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+
+  Data8 = 0;
+  SpdmSetData (SpdmContext, SpdmDataCapabilityCTExponent, &Parameter, &Data8, sizeof(Data8));
+  Data32 = CapabilityFlags;
+  SpdmSetData (SpdmContext, SpdmDataCapabilityFlags, &Parameter, &Data32, sizeof(Data32));
+
+  Data8 = SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF;
+  SpdmSetData (SpdmContext, SpdmDataMeasurementSpec, &Parameter, &Data8, sizeof(Data8));
+  Data32 = SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256;
+  SpdmSetData (SpdmContext, SpdmDataMeasurementHashAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data32 = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256;
+  SpdmSetData (SpdmContext, SpdmDataBaseAsymAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data32 = SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256;
+  SpdmSetData (SpdmContext, SpdmDataBaseHashAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data16 = SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1;
+  SpdmSetData (SpdmContext, SpdmDataDHENamedGroup, &Parameter, &Data16, sizeof(Data16));
+  Data16 = SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM;
+  SpdmSetData (SpdmContext, SpdmDataAEADCipherSuite, &Parameter, &Data16, sizeof(Data16));
+  Data16 = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048;
+  SpdmSetData (SpdmContext, SpdmDataReqBaseAsymAlg, &Parameter, &Data16, sizeof(Data16));
+  Data16 = SPDM_ALGORITHMS_KEY_SCHEDULE_HMAC_HASH;
+  SpdmSetData (SpdmContext, SpdmDataKeySchedule, &Parameter, &Data16, sizeof(Data16));
+
+  SpdmSetData (SpdmContext, SpdmDataPskHint, NULL, TEST_PSK_HINT_STRING, sizeof(TEST_PSK_HINT_STRING));
+}
+
+/**
+  Provision the certificate chain and the private key of the responder, and the root certificate hash
+  of the requester. The buffers are kept for the whole process.
+
+  @retval TRUE   The peers are provisioned.
+  @retval FALSE  The certificates or the keys cannot be read.
+**/
+BOOLEAN
+TestSpdmProvision (
+  VOID
+  )
+{
+  SPDM_DATA_PARAMETER  Parameter;
+  VOID                 *Data;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+  VOID                 *PrivateKey;
+  UINT8                Data8;
+
+  if (!ReadResponderPublicCertificateChain (SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256, &Data, &DataSize, NULL, NULL)) {
+    return FALSE;
+  }
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  Data8 = 1;
+  SpdmSetData (mTestSpdmResponderContext.SpdmContext, SpdmDataLocalSlotCount, &Parameter, &Data8, sizeof(Data8));
+  Parameter.AdditionalData[0] = 0;
+  SpdmSetData (mTestSpdmResponderContext.SpdmContext, SpdmDataLocalPublicCertChain, &Parameter, Data, DataSize);
+
+  if (!SpdmResponderDataLoadKeyFunc (SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256, &PrivateKey)) {
+    return FALSE;
+  }
+  SpdmRegisterLocalPrivateKey (mTestSpdmResponderContext.SpdmContext, FALSE, SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256, PrivateKey);
+
+  if (!ReadResponderRootPublicCertificate (SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256, &Data, &DataSize, &Hash, &HashSize)) {
+    return FALSE;
+  }
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  SpdmSetData (mTestSpdmRequesterContext.SpdmContext, SpdmDataPeerPublicRootCertHash, &Parameter, Hash, HashSize);
+
+  //
+  // The responder asks for the mutual authentication, so that the encapsulated requests can be reached.
+  //
+  Parameter.AdditionalData[0] = 0;
+  Data8 = SPDM_KEY_EXCHANGE_RESPONSE_MUT_AUTH_REQUESTED_WITH_ENCAP_REQUEST;
+  SpdmSetData (mTestSpdmResponderContext.SpdmContext, SpdmDataMutAuthRequested, &Parameter, &Data8, sizeof(Data8));
+  Data8 = 1;
+  SpdmSetData (mTestSpdmResponderContext.SpdmContext, SpdmDataBasicMutAuthRequested, &Parameter, &Data8, sizeof(Data8));
+  return TRUE;
+}
+
+/**
+  Prepare the requester and the responder, and capture the snapshots of the flow.
+
+  @retval TRUE   The snapshot TEST_SPDM_SNAPSHOT_NEGOTIATED at least is captured.
+  @retval FALSE  The contexts cannot be prepared.
+**/
+BOOLEAN
+TestSpdmInitialize (
+  VOID
+  )
+{
+  VOID     *State;
+  UINT32   SessionId;
+  UINT8    HeartbeatPeriod;
+  UINT8    MeasurementHash[MAX_HASH_SIZE];
+  UINT8    SlotMask;
+  UINTN    CertChainSize;
+  BOOLEAN  Provisioned;
+
+  mTestSpdmContextSize = SpdmGetContextSize ();
+
+  mTestSpdmRequesterContext.SendMessage = TestSpdmSendMessage;
+  mTestSpdmRequesterContext.ReceiveMessage = TestSpdmReceiveMessage;
+  SetupSpdmTestContext (&mTestSpdmRequesterContext);
+  if (SpdmUnitTestGroupSetup (&State) != 0) {
+    return FALSE;
+  }
+  SetupSpdmTestContext (&mTestSpdmResponderContext);
+  if (SpdmUnitTestGroupSetup (&State) != 0) {
+    return FALSE;
+  }
+  SpdmRegisterTransportLayerFunc (mTestSpdmRequesterContext.SpdmContext, TestSpdmRequesterEncodeMessage, SpdmTransportTestDecodeMessage);
+
+  TestSpdmSetupContext (mTestSpdmRequesterContext.SpdmContext, TEST_SPDM_REQUESTER_CAPABILITY_FLAGS);
+  TestSpdmSetupContext (mTestSpdmResponderContext.SpdmContext, TEST_SPDM_RESPONDER_CAPABILITY_FLAGS);
+  Provisioned = TestSpdmProvision ();
+
+  if (RETURN_ERROR(SpdmInitConnection (mTestSpdmRequesterContext.SpdmContext, FALSE))) {
+    return FALSE;
+  }
+  TestSpdmCaptureSnapshot (&mTestSpdmSnapshot[TEST_SPDM_SNAPSHOT_NEGOTIATED], INVALID_SESSION_ID);
+  if (!mTestSpdmSnapshot[TEST_SPDM_SNAPSHOT_NEGOTIATED].Valid) {
+    return FALSE;
+  }
+
+  //
+  // The handshakes are stopped by TestSpdmRequesterEncodeMessage at their first secured message.
+  //
+  if (Provisioned) {
+    //
+    // KEY_EXCHANGE_RSP is verified with the certificate chain of the responder.
+    //
+    CertChainSize = sizeof(mTestSpdmCertChain);
+    SpdmGetDigest (mTestSpdmRequesterContext.SpdmContext, &SlotMask, mTestSpdmCertChain);
+    SpdmGetCertificate (mTestSpdmRequesterContext.SpdmContext, 0, &CertChainSize, mTestSpdmCertChain);
+    mTestSpdmCapture = &mTestSpdmSnapshot[TEST_SPDM_SNAPSHOT_KEY_EXCHANGE];
+    SpdmStartSession (mTestSpdmRequesterContext.SpdmContext, FALSE, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, 0, &SessionId, &HeartbeatPeriod, MeasurementHash);
+    mTestSpdmCapture = NULL;
+    TestSpdmRestoreSnapshot (&mTestSpdmSnapshot[TEST_SPDM_SNAPSHOT_NEGOTIATED]);
+  }
+
+  mTestSpdmCapture = &mTestSpdmSnapshot[TEST_SPDM_SNAPSHOT_PSK_EXCHANGE];
+  SpdmStartSession (mTestSpdmRequesterContext.SpdmContext, TRUE, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, 0, &SessionId, &HeartbeatPeriod, MeasurementHash);
+  mTestSpdmCapture = NULL;
+  TestSpdmRestoreSnapshot (&mTestSpdmSnapshot[TEST_SPDM_SNAPSHOT_NEGOTIATED]);
+
+  if (!RETURN_ERROR(SpdmStartSession (mTestSpdmRequesterContext.SpdmContext, TRUE, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, 0, &SessionId, &HeartbeatPeriod, MeasurementHash))) {
+    TestSpdmCaptureSnapshot (&mTestSpdmSnapshot[TEST_SPDM_SNAPSHOT_SESSION], SessionId);
+  }
+  return TRUE;
+}
+
+/**
+  Give one message of the input to the responder.
+
+  @param  Snapshot                     The snapshot of the run.
+  @param  Kind                         TEST_SPDM_MESSAGE_KIND_*.
+  @param  Message                      The message.
+  @param  MessageSize                  The size in bytes of the message.
+**/
+VOID
+TestSpdmResponderSessionMessage (
+  IN TEST_SPDM_SNAPSHOT  *Snapshot,
+  IN UINT8               Kind,
+  IN UINT8               *Message,
+  IN UINTN               MessageSize
+  )
+{
+  RETURN_STATUS  Status;
+  UINT32         SessionId;
+  UINT32         *SessionIdPtr;
+  UINTN          TransportMessageSize;
+  UINTN          ResponseSize;
+
+  SessionId = Snapshot->SessionId;
+  if ((Kind != TEST_SPDM_MESSAGE_KIND_RAW) && (SessionId == INVALID_SESSION_ID)) {
+    Kind = TEST_SPDM_MESSAGE_KIND_PLAIN;
+  }
+
+  if (Kind == TEST_SPDM_MESSAGE_KIND_RAW) {
+    CopyMem (mTestSpdmTransportMessage, Message, MessageSize);
+    TransportMessageSize = MessageSize;
+  } else {
+    TransportMessageSize = sizeof(mTestSpdmTransportMessage);
+    Status = SpdmTransportTestEncodeMessage (
+               mTestSpdmRequesterContext.SpdmContext,
+               (Kind == TEST_SPDM_MESSAGE_KIND_PLAIN) ? NULL : &SessionId,
+               (BOOLEAN)(Kind == TEST_SPDM_MESSAGE_KIND_SECURED_APP),
+               TRUE,
+               MessageSize,
+               Message,
+               &TransportMessageSize,
+               mTestSpdmTransportMessage
+               );
+    if (RETURN_ERROR(Status)) {
+      return ;
+    }
+  }
+
+  SessionIdPtr = NULL;
+  ResponseSize = sizeof(mTestSpdmResponse);
+  SpdmProcessMessage (mTestSpdmResponderContext.SpdmContext, &SessionIdPtr, mTestSpdmTransportMessage, TransportMessageSize, mTestSpdmResponse, &ResponseSize);
+}
+
+VOID
+EFIAPI
+RunTestHarness(
+  IN VOID  *TestBuffer,
+  IN UINTN TestBufferSize
+  )
+{
+  UINT8               *Buffer;
+  UINTN               Offset;
+  UINTN               Count;
+  UINT8               Kind;
+  UINTN               Length;
+  TEST_SPDM_SNAPSHOT  *Snapshot;
+
+  if (!mTestSpdmInitialized) {
+    if (!TestSpdmInitialize ()) {
+      printf ("error - fail to prepare the SPDM contexts\n");
+      exit (1);
+    }
+    mTestSpdmInitialized = TRUE;
+  }
+  if (TestBufferSize < 1) {
+    return ;
+  }
+
+  Buffer = TestBuffer;
+  Snapshot = &mTestSpdmSnapshot[Buffer[0] % TEST_SPDM_SNAPSHOT_COUNT];
+  if (!Snapshot->Valid) {
+    Snapshot = &mTestSpdmSnapshot[TEST_SPDM_SNAPSHOT_NEGOTIATED];
+  }
+  TestSpdmRestoreSnapshot (Snapshot);
+
+  Offset = 1;
+  for (Count = 0; (Count < TEST_SPDM_MAX_MESSAGE_COUNT) && (Offset + 3 <= TestBufferSize); Count++) {
+    Kind = Buffer[Offset] & 0x3;
+    Length = Buffer[Offset + 1] | (Buffer[Offset + 2] << 8);
+    Offset += 3;
+    Length = MIN (Length, TestBufferSize - Offset);
+    Length = MIN (Length, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    TestSpdmResponderSessionMessage (Snapshot, Kind, Buffer + Offset, Length);
+    Offset += Length;
+  }
+}
+
+#ifdef TEST_WITH_LIBFUZZER
+
+//
+// The structure-aware mutator of libFuzzer.
+//
+// The input is mutated as a sequence of records, so that each record keeps a consistent Length,
+// and each SPDM message keeps a valid SPDM version, a request code of the responder, the minimum size
+// of its request and the length fields of its body. The records of the secured kinds are encrypted
+// by RunTestHarness with the session keys of the snapshot, so the mutator only handles plain SPDM messages.
+//
+
+//
+// The size of the ExchangeData of KEY_EXCHANGE, for SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1.
+//
+#define TEST_SPDM_DHE_EXCHANGE_SIZE          64
+
+#define TEST_SPDM_MUTATION_SNAPSHOT          0
+#define TEST_SPDM_MUTATION_BODY              1
+#define TEST_SPDM_MUTATION_CODE              2
+#define TEST_SPDM_MUTATION_PARAM             3
+#define TEST_SPDM_MUTATION_KIND              4
+#define TEST_SPDM_MUTATION_INSERT            5
+#define TEST_SPDM_MUTATION_DELETE            6
+#define TEST_SPDM_MUTATION_DUPLICATE         7
+#define TEST_SPDM_MUTATION_SWAP              8
+#define TEST_SPDM_MUTATION_COUNT             9
+
+typedef struct {
+  UINT8   RequestCode;
+  UINT16  MinSize;
+} TEST_SPDM_REQUEST_TEMPLATE;
+
+TEST_SPDM_REQUEST_TEMPLATE  mTestSpdmRequestTemplate[] = {
+  {SPDM_GET_VERSION,                   sizeof(SPDM_GET_VERSION_REQUEST)},
+  {SPDM_GET_CAPABILITIES,              sizeof(SPDM_GET_CAPABILITIES_REQUEST)},
+  {SPDM_NEGOTIATE_ALGORITHMS,          sizeof(SPDM_NEGOTIATE_ALGORITHMS_REQUEST)},
+  {SPDM_GET_DIGESTS,                   sizeof(SPDM_GET_DIGESTS_REQUEST)},
+  {SPDM_GET_CERTIFICATE,               sizeof(SPDM_GET_CERTIFICATE_REQUEST)},
+  {SPDM_CHALLENGE,                     sizeof(SPDM_CHALLENGE_REQUEST)},
+  {SPDM_GET_MEASUREMENTS,              sizeof(SPDM_GET_MEASUREMENTS_REQUEST)},
+  {SPDM_KEY_EXCHANGE,                  sizeof(SPDM_KEY_EXCHANGE_REQUEST) + TEST_SPDM_DHE_EXCHANGE_SIZE + sizeof(UINT16)},
+  {SPDM_FINISH,                        sizeof(SPDM_FINISH_REQUEST)},
+  {SPDM_PSK_EXCHANGE,                  sizeof(SPDM_PSK_EXCHANGE_REQUEST)},
+  {SPDM_PSK_FINISH,                    sizeof(SPDM_PSK_FINISH_REQUEST)},
+  {SPDM_HEARTBEAT,                     sizeof(SPDM_HEARTBEAT_REQUEST)},
+  {SPDM_KEY_UPDATE,                    sizeof(SPDM_KEY_UPDATE_REQUEST)},
+  {SPDM_GET_ENCAPSULATED_REQUEST,      sizeof(SPDM_GET_ENCAPSULATED_REQUEST_REQUEST)},
+  {SPDM_DELIVER_ENCAPSULATED_RESPONSE, sizeof(SPDM_DELIVER_ENCAPSULATED_RESPONSE_REQUEST)},
+  {SPDM_END_SESSION,                   sizeof(SPDM_END_SESSION_REQUEST)},
+  {SPDM_CHUNK_SEND,                    sizeof(SPDM_CHUNK_SEND_REQUEST)},
+  {SPDM_CHUNK_GET,                     sizeof(SPDM_CHUNK_GET_REQUEST)},
+  {SPDM_RESPOND_IF_READY,              sizeof(SPDM_MESSAGE_HEADER)},
+  {SPDM_VENDOR_DEFINED_REQUEST,        sizeof(SPDM_MESSAGE_HEADER)},
+};
+
+typedef struct {
+  UINT8   Kind;
+  UINTN   Length;
+  UINT8   Message[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+} TEST_SPDM_RECORD;
+
+UINT8                   mTestSpdmMutateSnapshot;
+TEST_SPDM_RECORD        mTestSpdmRecord[TEST_SPDM_MAX_MESSAGE_COUNT];
+UINTN                   mTestSpdmRecordCount;
+TEST_SPDM_RECORD        mTestSpdmCrossRecord[TEST_SPDM_MAX_MESSAGE_COUNT];
+UINTN                   mTestSpdmCrossRecordCount;
+TEST_SPDM_RECORD        mTestSpdmSwapRecord;
+
+size_t
+LLVMFuzzerMutate (
+  uint8_t  *Data,
+  size_t   Size,
+  size_t   MaxSize
+  );
+
+/**
+  Return a pseudo random number of the mutator, from the seed given by libFuzzer.
+**/
+UINT32
+TestSpdmMutateRandom (
+  IN OUT UINT32  *State
+  )
+{
+  *State ^= *State << 13;
+  *State ^= *State >> 17;
+  *State ^= *State << 5;
+  return *State;
+}
+
+/**
+  Parse an input into records, as RunTestHarness does.
+
+  @return the number of records.
+**/
+UINTN
+TestSpdmParseRecords (
+  IN  CONST UINT8       *Data,
+  IN  UINTN             Size,
+  OUT UINT8             *Snapshot,
+  OUT TEST_SPDM_RECORD  *Record
+  )
+{
+  UINTN  Offset;
+  UINTN  Count;
+
+  *Snapshot = (Size >= 1) ? Data[0] : 0;
+  Offset = 1;
+  for (Count = 0; (Count < TEST_SPDM_MAX_MESSAGE_COUNT) && (Offset + 3 <= Size); Count++) {
+    Record[Count].Kind = Data[Offset] & 0x3;
+    Record[Count].Length = Data[Offset + 1] | (Data[Offset + 2] << 8);
+    Offset += 3;
+    Record[Count].Length = MIN (Record[Count].Length, Size - Offset);
+    Record[Count].Length = MIN (Record[Count].Length, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    CopyMem (Record[Count].Message, Data + Offset, Record[Count].Length);
+    Offset += Record[Count].Length;
+  }
+  return Count;
+}
+
+/**
+  Serialize records into an input, dropping the records beyond MaxSize.
+
+  @return the size of the input.
+**/
+UINTN
+TestSpdmSerializeRecords (
+  IN  UINT8             Snapshot,
+  IN  TEST_SPDM_RECORD  *Record,
+  IN  UINTN             Count,
+  OUT UINT8             *Data,
+  IN  UINTN             MaxSize
+  )
+{
+  UINTN  Offset;
+  UINTN  Index;
+
+  if (MaxSize < 1) {
+    return 0;
+  }
+  Data[0] = Snapshot;
+  Offset = 1;
+  for (Index = 0; Index < Count; Index++) {
+    if (Offset + 3 + Record[Index].Length > MaxSize) {
+      break;
+    }
+    Data[Offset] = Record[Index].Kind;
+    Data[Offset + 1] = (UINT8)Record[Index].Length;
+    Data[Offset + 2] = (UINT8)(Record[Index].Length >> 8);
+    Offset += 3;
+    CopyMem (Data + Offset, Record[Index].Message, Record[Index].Length);
+    Offset += Record[Index].Length;
+  }
+  return Offset;
+}
+
+/**
+  Make an SPDM message of a record consistent: a valid SPDM version, the minimum size of a known request,
+  and the length fields of the body matching the size of the message.
+**/
+VOID
+TestSpdmFixRecord (
+  IN OUT TEST_SPDM_RECORD  *Record
+  )
+{
+  SPDM_MESSAGE_HEADER                *Header;
+  SPDM_NEGOTIATE_ALGORITHMS_REQUEST  *Algorithms;
+  SPDM_PSK_EXCHANGE_REQUEST          *PskExchange;
+  SPDM_CHUNK_SEND_REQUEST            *ChunkSend;
+  UINT8                              *OpaqueLength;
+  UINTN                              Remaining;
+  UINTN                              Index;
+
+  if ((Record->Kind == TEST_SPDM_MESSAGE_KIND_RAW) || (Record->Kind == TEST_SPDM_MESSAGE_KIND_SECURED_APP)) {
+    return ;
+  }
+  if (Record->Length < sizeof(SPDM_MESSAGE_HEADER)) {
+    ZeroMem (Record->Message + Record->Length, sizeof(SPDM_MESSAGE_HEADER) - Record->Length);
+    Record->Length = sizeof(SPDM_MESSAGE_HEADER);
+  }
+  Header = (VOID *)Record->Message;
+  if ((Header->SPDMVersion != SPDM_MESSAGE_VERSION_10) && (Header->SPDMVersion != SPDM_MESSAGE_VERSION_11)) {
+    Header->SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  }
+  for (Index = 0; Index < ARRAY_SIZE(mTestSpdmRequestTemplate); Index++) {
+    if (Header->RequestResponseCode == mTestSpdmRequestTemplate[Index].RequestCode) {
+      break;
+    }
+  }
+  if (Index == ARRAY_SIZE(mTestSpdmRequestTemplate)) {
+    return ;
+  }
+  if (Record->Length < mTestSpdmRequestTemplate[Index].MinSize) {
+    ZeroMem (Record->Message + Record->Length, mTestSpdmRequestTemplate[Index].MinSize - Record->Length);
+    Record->Length = mTestSpdmRequestTemplate[Index].MinSize;
+  }
+
+  switch (Header->RequestResponseCode) {
+  case SPDM_NEGOTIATE_ALGORITHMS:
+    Algorithms = (VOID *)Record->Message;
+    Algorithms->Length = (UINT16)Record->Length;
+    break;
+  case SPDM_KEY_EXCHANGE:
+    OpaqueLength = Record->Message + sizeof(SPDM_KEY_EXCHANGE_REQUEST) + TEST_SPDM_DHE_EXCHANGE_SIZE;
+    Remaining = Record->Length - sizeof(SPDM_KEY_EXCHANGE_REQUEST) - TEST_SPDM_DHE_EXCHANGE_SIZE - sizeof(UINT16);
+    OpaqueLength[0] = (UINT8)Remaining;
+    OpaqueLength[1] = (UINT8)(Remaining >> 8);
+    break;
+  case SPDM_PSK_EXCHANGE:
+    PskExchange = (VOID *)Record->Message;
+    Remaining = Record->Length - sizeof(SPDM_PSK_EXCHANGE_REQUEST);
+    PskExchange->PSKHintLength = (UINT16)MIN (PskExchange->PSKHintLength, MIN (Remaining, MAX_SPDM_PSK_HINT_LENGTH));
+    Remaining -= PskExchange->PSKHintLength;
+    PskExchange->RequesterContextLength = (UINT16)MIN (PskExchange->RequesterContextLength, Remaining);
+    Remaining -= PskExchange->RequesterContextLength;
+    PskExchange->OpaqueLength = (UINT16)Remaining;
+    break;
+  case SPDM_CHUNK_SEND:
+    ChunkSend = (VOID *)Record->Message;
+    Remaining = Record->Length - sizeof(SPDM_CHUNK_SEND_REQUEST);
+    if (ChunkSend->ChunkSeqNo == 0) {
+      Remaining = (Remaining >= sizeof(UINT32)) ? Remaining - sizeof(UINT32) : 0;
+    }
+    ChunkSend->ChunkSize = (UINT32)Remaining;
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+  Fill a record with a new request of a random request code.
+**/
+VOID
+TestSpdmNewRecord (
+  IN OUT UINT32            *Random,
+     OUT TEST_SPDM_RECORD  *Record
+  )
+{
+  SPDM_MESSAGE_HEADER  *Header;
+  UINTN                Index;
+
+  Index = TestSpdmMutateRandom (Random) % ARRAY_SIZE(mTestSpdmRequestTemplate);
+  Record->Kind = (UINT8)(TestSpdmMutateRandom (Random) % 3);
+  Record->Length = mTestSpdmRequestTemplate[Index].MinSize;
+  ZeroMem (Record->Message, Record->Length);
+  Header = (VOID *)Record->Message;
+  Header->SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  Header->RequestResponseCode = mTestSpdmRequestTemplate[Index].RequestCode;
+  if (Record->Length > sizeof(SPDM_MESSAGE_HEADER)) {
+    LLVMFuzzerMutate (Record->Message + sizeof(SPDM_MESSAGE_HEADER), Record->Length - sizeof(SPDM_MESSAGE_HEADER), Record->Length - sizeof(SPDM_MESSAGE_HEADER));
+  }
+}
+
+size_t
+LLVMFuzzerCustomMutator (
+  uint8_t       *Data,
+  size_t        Size,
+  size_t        MaxSize,
+  unsigned int  Seed
+  )
+{
+  TEST_SPDM_RECORD     *Record;
+  SPDM_MESSAGE_HEADER  *Header;
+  UINT32               Random;
+  UINTN                Index;
+  UINTN                Other;
+  UINTN                MaxLength;
+
+  Random = Seed | 1;
+  mTestSpdmRecordCount = TestSpdmParseRecords (Data, Size, &mTestSpdmMutateSnapshot, mTestSpdmRecord);
+  if (mTestSpdmRecordCount == 0) {
+    TestSpdmNewRecord (&Random, &mTestSpdmRecord[0]);
+    mTestSpdmRecordCount = 1;
+  }
+  Index = TestSpdmMutateRandom (&Random) % mTestSpdmRecordCount;
+  Record = &mTestSpdmRecord[Index];
+  Header = (VOID *)Record->Message;
+
+  switch (TestSpdmMutateRandom (&Random) % TEST_SPDM_MUTATION_COUNT) {
+  case TEST_SPDM_MUTATION_SNAPSHOT:
+    mTestSpdmMutateSnapshot = (UINT8)TestSpdmMutateRandom (&Random);
+    break;
+  case TEST_SPDM_MUTATION_BODY:
+    //
+    // The header is kept, unless the record is a transport message.
+    //
+    if (Record->Kind == TEST_SPDM_MESSAGE_KIND_RAW) {
+      Record->Length = LLVMFuzzerMutate (Record->Message, Record->Length, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    } else if (Record->Length >= sizeof(SPDM_MESSAGE_HEADER)) {
+      MaxLength = MAX_SPDM_MESSAGE_BUFFER_SIZE - sizeof(SPDM_MESSAGE_HEADER);
+      Record->Length = sizeof(SPDM_MESSAGE_HEADER) +
+                       LLVMFuzzerMutate (Record->Message + sizeof(SPDM_MESSAGE_HEADER), Record->Length - sizeof(SPDM_MESSAGE_HEADER), MaxLength);
+    } else {
+      Record->Length = LLVMFuzzerMutate (Record->Message, Record->Length, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+    }
+    break;
+  case TEST_SPDM_MUTATION_CODE:
+    if (Record->Length >= sizeof(SPDM_MESSAGE_HEADER)) {
+      Header->RequestResponseCode = mTestSpdmRequestTemplate[TestSpdmMutateRandom (&Random) % ARRAY_SIZE(mTestSpdmRequestTemplate)].RequestCode;
+    }
+    break;
+  case TEST_SPDM_MUTATION_PARAM:
+    if (Record->Length >= sizeof(SPDM_MESSAGE_HEADER)) {
+      if ((TestSpdmMutateRandom (&Random) & 1) == 0) {
+        Header->Param1 = (UINT8)TestSpdmMutateRandom (&Random);
+      } else {
+        Header->Param2 = (UINT8)TestSpdmMutateRandom (&Random);
+      }
+    }
+    break;
+  case TEST_SPDM_MUTATION_KIND:
+    Record->Kind = (UINT8)(TestSpdmMutateRandom (&Random) & 0x3);
+    break;
+  case TEST_SPDM_MUTATION_INSERT:
+    if (mTestSpdmRecordCount < TEST_SPDM_MAX_MESSAGE_COUNT) {
+      CopyMem (&mTestSpdmRecord[Index + 1], &mTestSpdmRecord[Index], (mTestSpdmRecordCount - Index) * sizeof(TEST_SPDM_RECORD));
+      TestSpdmNewRecord (&Random, Record);
+      mTestSpdmRecordCount++;
+    }
+    break;
+  case TEST_SPDM_MUTATION_DELETE:
+    if (mTestSpdmRecordCount > 1) {
+      CopyMem (&mTestSpdmRecord[Index], &mTestSpdmRecord[Index + 1], (mTestSpdmRecordCount - Index - 1) * sizeof(TEST_SPDM_RECORD));
+      mTestSpdmRecordCount--;
+      Record = NULL;
+    }
+    break;
+  case TEST_SPDM_MUTATION_DUPLICATE:
+    if (mTestSpdmRecordCount < TEST_SPDM_MAX_MESSAGE_COUNT) {
+      CopyMem (&mTestSpdmRecord[Index + 1], &mTestSpdmRecord[Index], (mTestSpdmRecordCount - Index) * sizeof(TEST_SPDM_RECORD));
+      mTestSpdmRecordCount++;
+    }
+    break;
+  case TEST_SPDM_MUTATION_SWAP:
+    Other = TestSpdmMutateRandom (&Random) % mTestSpdmRecordCount;
+    if (Other != Index) {
+      CopyMem (&mTestSpdmSwapRecord, &mTestSpdmRecord[Index], sizeof(TEST_SPDM_RECORD));
+      CopyMem (&mTestSpdmRecord[Index], &mTestSpdmRecord[Other], sizeof(TEST_SPDM_RECORD));
+      CopyMem (&mTestSpdmRecord[Other], &mTestSpdmSwapRecord, sizeof(TEST_SPDM_RECORD));
+    }
+    break;
+  }
+  if (Record != NULL) {
+    TestSpdmFixRecord (Record);
+  }
+
+  return TestSpdmSerializeRecords (mTestSpdmMutateSnapshot, mTestSpdmRecord, mTestSpdmRecordCount, Data, MaxSize);
+}
+
+size_t
+LLVMFuzzerCustomCrossOver (
+  const uint8_t  *Data1,
+  size_t         Size1,
+  const uint8_t  *Data2,
+  size_t         Size2,
+  uint8_t        *Out,
+  size_t         MaxOutSize,
+  unsigned int   Seed
+  )
+{
+  UINT8   Snapshot;
+  UINT32  Random;
+  UINTN   Count1;
+  UINTN   Start2;
+
+  //
+  // The first records of Data1 are followed by the last records of Data2, from the snapshot of Data1.
+  //
+  Random = Seed | 1;
+  mTestSpdmRecordCount = TestSpdmParseRecords (Data1, Size1, &mTestSpdmMutateSnapshot, mTestSpdmRecord);
+  mTestSpdmCrossRecordCount = TestSpdmParseRecords (Data2, Size2, &Snapshot, mTestSpdmCrossRecord);
+  Count1 = TestSpdmMutateRandom (&Random) % (mTestSpdmRecordCount + 1);
+  Start2 = TestSpdmMutateRandom (&Random) % (mTestSpdmCrossRecordCount + 1);
+  if (Count1 + mTestSpdmCrossRecordCount - Start2 > TEST_SPDM_MAX_MESSAGE_COUNT) {
+    Start2 = Count1 + mTestSpdmCrossRecordCount - TEST_SPDM_MAX_MESSAGE_COUNT;
+  }
+  CopyMem (&mTestSpdmRecord[Count1], &mTestSpdmCrossRecord[Start2], (mTestSpdmCrossRecordCount - Start2) * sizeof(TEST_SPDM_RECORD));
+  return TestSpdmSerializeRecords (mTestSpdmMutateSnapshot, mTestSpdmRecord, Count1 + mTestSpdmCrossRecordCount - Start2, Out, MaxOutSize);
+}
+
+#endif
@@ -0,0 +1,894 @@
+/** @file
+  Application for SPDM Handshake Benchmark.
+
+  A requester and a responder SPDM context run in one process. The device send function of the
+  requester gives the transport message to SpdmProcessMessage of the responder through the test
+  transport, and the device receive function returns the response, so that the cost of both peers
+  is measured without any IO.
+
+  Each operation of the SPDM flow is measured for each algorithm suite: the VCA exchange, GET_DIGESTS
+  with GET_CERTIFICATE, CHALLENGE, signed GET_MEASUREMENTS, KEY_EXCHANGE with FINISH, PSK_EXCHANGE with
+  PSK_FINISH, KEY_UPDATE and an application message round trip in a session. The messages which set up
+  an operation are not measured. One CSV line is printed per measurement:
+  backend,asym,hash,dhe,aead,operation,iterations,min_us,p50_us,p90_us,p99_us,max_us,mean_us,allocs_per_op,heap_peak,stack_peak,status
+
+  The heap peak is the high water mark of the pool allocations of one operation, in an arena. The
+  allocations of the crypto library which do not use MemoryAllocationLib are not included, and an
+  arena which cannot be given back, because a block of a previous operation is outstanding, is
+  reported as n/a. The stack peak is the deepest stack used by one operation below the caller, for
+  both peers together.
+
+  An optional second argument gives the maximum allocations per operation. An operation above it has the
+  status over_budget, and the benchmark exits with 1, so that CI can keep the allocations from growing.
+  With the MemoryAllocationLib of the allocation audit, the allocations of each operation are broken down
+  per request code and phase in lines printed to stderr:
+  audit,backend,asym,hash,dhe,aead,operation,phase,request_code,allocs_per_op,bytes_per_op,live
+
+  The certificates are read from the current directory, as in the unit tests.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "HandshakeBench.h"
+
+//
+// Number of measured iterations of one operation.
+//
+UINTN  mHandshakeBenchIterations = 32;
+
+//
+// Maximum allocations per operation, and if an operation is above it.
+//
+UINTN    mHandshakeBenchMaxAllocations = MAX_UINTN;
+BOOLEAN  mHandshakeBenchOverBudget = FALSE;
+
+typedef struct {
+  UINT32    BaseAsymAlgo;
+  UINT32    BaseHashAlgo;
+  UINT32    MeasurementHashAlgo;
+  UINT16    DHENamedGroup;
+  UINT16    AEADCipherSuite;
+  CHAR8     *AsymName;
+  CHAR8     *HashName;
+  CHAR8     *DheName;
+  CHAR8     *AeadName;
+} HANDSHAKE_BENCH_SUITE;
+
+//
+// The suites use the asymmetric algorithms of the test keys. SPDM 1.1 has no algorithm for EdDSA or SM2.
+//
+HANDSHAKE_BENCH_SUITE  mHandshakeBenchSuite[] = {
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048,         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048,  SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM,       "RSASSA-2048", "SHA-256", "FFDHE-2048", "AES-128-GCM"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_2048,         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048,  SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM,       "RSAPSS-2048", "SHA-256", "FFDHE-2048", "AES-256-GCM"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_3072,         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072,  SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM,       "RSASSA-3072", "SHA-384", "FFDHE-3072", "AES-256-GCM"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072,         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM,       "RSAPSS-3072", "SHA-384", "SECP384R1",  "AES-256-GCM"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256, SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM,       "ECDSA-P256",  "SHA-256", "SECP256R1",  "AES-128-GCM"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256, SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305, "ECDSA-P256",  "SHA-256", "SECP256R1",  "CHACHA20-POLY1305"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384, SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM,       "ECDSA-P384",  "SHA-384", "SECP384R1",  "AES-256-GCM"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384, SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305, "ECDSA-P384",  "SHA-384", "SECP384R1",  "CHACHA20-POLY1305"},
+};
+
+//
+// The requester does not support the mutual authentication, so that only the responder signs.
+//
+#define HANDSHAKE_BENCH_REQUESTER_CAPABILITY_FLAGS  (SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCRYPT_CAP | \
+                                                     SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP | \
+                                                     SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP | \
+                                                     SPDM_GET_CAPABILITIES_REQUEST_FLAGS_PSK_CAP_REQUESTER | \
+                                                     SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP | \
+                                                     SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_UPD_CAP)
+
+#define HANDSHAKE_BENCH_RESPONDER_CAPABILITY_FLAGS  (SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP | \
+                                                     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP | \
+                                                     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP_SIG | \
+                                                     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_FRESH_CAP | \
+                                                     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCRYPT_CAP | \
+                                                     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MAC_CAP | \
+                                                     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP | \
+                                                     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP_RESPONDER_WITH_CONTEXT | \
+                                                     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP | \
+                                                     SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_UPD_CAP)
+
+typedef struct {
+  HANDSHAKE_BENCH_SUITE  *Suite;
+  VOID                   *RequesterContext;
+  VOID                   *ResponderContext;
+  VOID                   *PrivateKey;
+  VOID                   *CertChain;
+  VOID                   *RootCert;
+  UINT32                 SessionId;
+  BOOLEAN                SessionStarted;
+  UINT8                  *Arena;
+  UINT64                 *Sample;
+  UINT8                  *Message;
+  UINT8                  *ResponseMessage;
+} HANDSHAKE_BENCH_CONTEXT;
+
+/**
+  One step of an operation.
+
+  @param  Bench                        The benchmark context.
+
+  @retval TRUE   The step succeeded.
+  @retval FALSE  The step failed.
+**/
+typedef
+BOOLEAN
+(*HANDSHAKE_BENCH_FUNC) (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  );
+
+//
+// Setup and Teardown run once per operation, Prepare and Cleanup around each iteration.
+// Only Run is measured. Each of them but Run may be NULL.
+//
+typedef struct {
+  CHAR8                 *Name;
+  HANDSHAKE_BENCH_FUNC  Setup;
+  HANDSHAKE_BENCH_FUNC  Prepare;
+  HANDSHAKE_BENCH_FUNC  Run;
+  HANDSHAKE_BENCH_FUNC  Cleanup;
+  HANDSHAKE_BENCH_FUNC  Teardown;
+} HANDSHAKE_BENCH_OPERATION;
+
+SPDM_TEST_CONTEXT  mHandshakeBenchRequesterContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  TRUE,
+  NULL,
+  NULL,
+};
+
+SPDM_TEST_CONTEXT  mHandshakeBenchResponderContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  FALSE,
+  NULL,
+  NULL,
+};
+
+//
+// The response of the responder, until the requester receives it.
+//
+UINT8  mHandshakeBenchResponse[HANDSHAKE_BENCH_TRANSPORT_BUFFER_SIZE];
+UINTN  mHandshakeBenchResponseSize;
+
+/**
+  Send a transport message of the requester to the responder, which processes it at once.
+
+  @param  SpdmContext                  A pointer to the SPDM context of the requester.
+  @param  RequestSize                  Size in bytes of the request message.
+  @param  Request                      A pointer to the request message.
+  @param  Timeout                      The timeout, not used.
+
+  @retval RETURN_SUCCESS               The responder has processed the request.
+  @retval RETURN_DEVICE_ERROR          The responder cannot process the request.
+**/
+RETURN_STATUS
+EFIAPI
+HandshakeBenchSendMessage (
+  IN     VOID                                   *SpdmContext,
+  IN     UINTN                                  RequestSize,
+  IN     VOID                                   *Request,
+  IN     UINT64                                 Timeout
+  )
+{
+  RETURN_STATUS  Status;
+  UINT32         *SessionId;
+
+  SessionId = NULL;
+  mHandshakeBenchResponseSize = sizeof(mHandshakeBenchResponse);
+  Status = SpdmProcessMessage (
+             mHandshakeBenchResponderContext.SpdmContext,
+             &SessionId,
+             Request,
+             RequestSize,
+             mHandshakeBenchResponse,
+             &mHandshakeBenchResponseSize
+             );
+  if (RETURN_ERROR(Status)) {
+    mHandshakeBenchResponseSize = 0;
+    return RETURN_DEVICE_ERROR;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Receive the transport message of the responder.
+
+  @param  SpdmContext                  A pointer to the SPDM context of the requester.
+  @param  ResponseSize                 Size in bytes of the response buffer on input, of the response message on output.
+  @param  Response                     A pointer to the response buffer.
+  @param  Timeout                      The timeout, not used.
+
+  @retval RETURN_SUCCESS               The response is received.
+  @retval RETURN_DEVICE_ERROR          No response is pending, or it does not fit in the buffer.
+**/
+RETURN_STATUS
+EFIAPI
+HandshakeBenchReceiveMessage (
+  IN     VOID                                   *SpdmContext,
+  IN OUT UINTN                                  *ResponseSize,
+  IN OUT VOID                                   *Response,
+  IN     UINT64                                 Timeout
+  )
+{
+  if ((mHandshakeBenchResponseSize == 0) || (*ResponseSize < mHandshakeBenchResponseSize)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  CopyMem (Response, mHandshakeBenchResponse, mHandshakeBenchResponseSize);
+  *ResponseSize = mHandshakeBenchResponseSize;
+  mHandshakeBenchResponseSize = 0;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Echo the application messages of the requester.
+
+  @param  SpdmContext                  A pointer to the SPDM context of the responder.
+  @param  SessionId                    The session of the message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Request                      A pointer to the request data.
+  @param  ResponseSize                 Size in bytes of the response buffer on input, of the response data on output.
+  @param  Response                     A pointer to the response data.
+
+  @retval RETURN_SUCCESS               The application message is echoed.
+  @retval RETURN_UNSUPPORTED           The message is not an application message.
+**/
+RETURN_STATUS
+EFIAPI
+HandshakeBenchEchoAppMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  if (!IsAppMessage || (SessionId == NULL) || (*ResponseSize < RequestSize)) {
+    return RETURN_UNSUPPORTED;
+  }
+  CopyMem (Response, Request, RequestSize);
+  *ResponseSize = RequestSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Set the capabilities and the algorithms of one suite in one SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Suite                        The algorithm suite.
+  @param  CapabilityFlags              The capability flags of the peer.
+**/
+VOID
+HandshakeBenchSetupAlgorithms (
+  IN VOID                   *SpdmContext,
+  IN HANDSHAKE_BENCH_SUITE  *Suite,
+  IN UINT32                 CapabilityFlags
+  )
+{
+  SPDM_DATA_PARAMETER  Parameter;
+  UINT8                Data8;
+  UINT16               Data16;
+  UINT32               Data32;
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+
+  Data8 = 0;
+  SpdmSetData (SpdmContext, SpdmDataCapabilityCTExponent, &Parameter, &Data8, sizeof(Data8));
+  Data32 = CapabilityFlags;
+  SpdmSetData (SpdmContext, SpdmDataCapabilityFlags, &Parameter, &Data32, sizeof(Data32));
+
+  Data8 = SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF;
+  SpdmSetData (SpdmContext, SpdmDataMeasurementSpec, &Parameter, &Data8, sizeof(Data8));
+  Data32 = Suite->MeasurementHashAlgo;
+  SpdmSetData (SpdmContext, SpdmDataMeasurementHashAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data32 = Suite->BaseAsymAlgo;
+  SpdmSetData (SpdmContext, SpdmDataBaseAsymAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data32 = Suite->BaseHashAlgo;
+  SpdmSetData (SpdmContext, SpdmDataBaseHashAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data16 = Suite->DHENamedGroup;
+  SpdmSetData (SpdmContext, SpdmDataDHENamedGroup, &Parameter, &Data16, sizeof(Data16));
+  Data16 = Suite->AEADCipherSuite;
+  SpdmSetData (SpdmContext, SpdmDataAEADCipherSuite, &Parameter, &Data16, sizeof(Data16));
+  Data16 = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048;
+  SpdmSetData (SpdmContext, SpdmDataReqBaseAsymAlg, &Parameter, &Data16, sizeof(Data16));
+  Data16 = SPDM_ALGORITHMS_KEY_SCHEDULE_HMAC_HASH;
+  SpdmSetData (SpdmContext, SpdmDataKeySchedule, &Parameter, &Data16, sizeof(Data16));
+
+  SpdmSetData (SpdmContext, SpdmDataPskHint, NULL, TEST_PSK_HINT_STRING, sizeof(TEST_PSK_HINT_STRING));
+}
+
+/**
+  Provision the certificates and the private key of one suite in both SPDM contexts.
+
+  @param  Bench                        The benchmark context.
+
+  @retval TRUE   Both peers are provisioned.
+  @retval FALSE  The test keys of the suite cannot be read.
+**/
+BOOLEAN
+HandshakeBenchProvision (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  SPDM_DATA_PARAMETER  Parameter;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+  UINT8                Data8;
+
+  if (!ReadResponderPublicCertificateChain (Bench->Suite->BaseHashAlgo, Bench->Suite->BaseAsymAlgo, &Bench->CertChain, &DataSize, NULL, NULL)) {
+    return FALSE;
+  }
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  Data8 = 1;
+  SpdmSetData (Bench->ResponderContext, SpdmDataLocalSlotCount, &Parameter, &Data8, sizeof(Data8));
+  Parameter.AdditionalData[0] = 0;
+  SpdmSetData (Bench->ResponderContext, SpdmDataLocalPublicCertChain, &Parameter, Bench->CertChain, DataSize);
+
+  if (!SpdmResponderDataLoadKeyFunc (Bench->Suite->BaseAsymAlgo, &Bench->PrivateKey)) {
+    return FALSE;
+  }
+  SpdmRegisterLocalPrivateKey (Bench->ResponderContext, FALSE, Bench->Suite->BaseAsymAlgo, Bench->PrivateKey);
+
+  if (!ReadResponderRootPublicCertificate (Bench->Suite->BaseHashAlgo, Bench->Suite->BaseAsymAlgo, &Bench->RootCert, &DataSize, &Hash, &HashSize)) {
+    return FALSE;
+  }
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  SpdmSetData (Bench->RequesterContext, SpdmDataPeerPublicRootCertHash, &Parameter, Hash, HashSize);
+  return TRUE;
+}
+
+/**
+  Run the VCA exchange: GET_VERSION, GET_CAPABILITIES and NEGOTIATE_ALGORITHMS.
+**/
+BOOLEAN
+HandshakeBenchInitConnection (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  return !RETURN_ERROR(SpdmInitConnection (Bench->RequesterContext, FALSE));
+}
+
+/**
+  Run GET_DIGESTS and GET_CERTIFICATE, which verifies the certificate chain of the responder.
+**/
+BOOLEAN
+HandshakeBenchGetCertificate (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  UINT8  SlotMask;
+  UINTN  CertChainSize;
+
+  if (RETURN_ERROR(SpdmGetDigest (Bench->RequesterContext, &SlotMask, Bench->ResponseMessage))) {
+    return FALSE;
+  }
+  CertChainSize = MAX_SPDM_CERT_CHAIN_SIZE;
+  return !RETURN_ERROR(SpdmGetCertificate (Bench->RequesterContext, 0, &CertChainSize, Bench->ResponseMessage));
+}
+
+/**
+  Run the VCA exchange, GET_DIGESTS and GET_CERTIFICATE.
+**/
+BOOLEAN
+HandshakeBenchAuthenticate (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  return HandshakeBenchInitConnection (Bench) && HandshakeBenchGetCertificate (Bench);
+}
+
+/**
+  Run CHALLENGE, which verifies the signature of the responder.
+**/
+BOOLEAN
+HandshakeBenchChallenge (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  return !RETURN_ERROR(SpdmChallenge (Bench->RequesterContext, 0, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, Bench->ResponseMessage));
+}
+
+/**
+  Run a signed GET_MEASUREMENTS of all the measurements.
+**/
+BOOLEAN
+HandshakeBenchGetMeasurement (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  UINT8   NumberOfBlocks;
+  UINT32  MeasurementRecordLength;
+
+  MeasurementRecordLength = MAX_SPDM_MEASUREMENT_RECORD_SIZE;
+  return !RETURN_ERROR(SpdmGetMeasurement (
+                         Bench->RequesterContext,
+                         NULL,
+                         SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE,
+                         SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS,
+                         0,
+                         &NumberOfBlocks,
+                         &MeasurementRecordLength,
+                         Bench->ResponseMessage
+                         ));
+}
+
+/**
+  Start a session with a pre-shared key or with an ephemeral key exchange.
+
+  @param  Bench                        The benchmark context.
+  @param  UsePsk                       TRUE for PSK_EXCHANGE and PSK_FINISH, FALSE for KEY_EXCHANGE and FINISH.
+**/
+BOOLEAN
+HandshakeBenchStartSessionCommon (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench,
+  IN BOOLEAN                  UsePsk
+  )
+{
+  UINT8  HeartbeatPeriod;
+
+  if (RETURN_ERROR(SpdmStartSession (
+                     Bench->RequesterContext,
+                     UsePsk,
+                     SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH,
+                     0,
+                     &Bench->SessionId,
+                     &HeartbeatPeriod,
+                     Bench->ResponseMessage
+                     ))) {
+    return FALSE;
+  }
+  Bench->SessionStarted = TRUE;
+  return TRUE;
+}
+
+/**
+  Run KEY_EXCHANGE and FINISH.
+**/
+BOOLEAN
+HandshakeBenchStartSession (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  return HandshakeBenchStartSessionCommon (Bench, FALSE);
+}
+
+/**
+  Run PSK_EXCHANGE and PSK_FINISH.
+**/
+BOOLEAN
+HandshakeBenchStartPskSession (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  return HandshakeBenchStartSessionCommon (Bench, TRUE);
+}
+
+/**
+  Run END_SESSION, if a session is started.
+**/
+BOOLEAN
+HandshakeBenchStopSession (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  if (!Bench->SessionStarted) {
+    return TRUE;
+  }
+  Bench->SessionStarted = FALSE;
+  return !RETURN_ERROR(SpdmStopSession (Bench->RequesterContext, Bench->SessionId, 0));
+}
+
+/**
+  Run the VCA exchange, GET_DIGESTS, GET_CERTIFICATE, KEY_EXCHANGE and FINISH.
+**/
+BOOLEAN
+HandshakeBenchAuthenticateAndStartSession (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  return HandshakeBenchAuthenticate (Bench) && HandshakeBenchStartSession (Bench);
+}
+
+/**
+  Run KEY_UPDATE of both directions, with its VERIFY_NEW_KEY.
+**/
+BOOLEAN
+HandshakeBenchKeyUpdate (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  return !RETURN_ERROR(SpdmKeyUpdate (Bench->RequesterContext, Bench->SessionId, FALSE));
+}
+
+/**
+  Send an application message in the session and receive its echo.
+**/
+BOOLEAN
+HandshakeBenchAppData (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench
+  )
+{
+  UINTN  ResponseSize;
+
+  ResponseSize = HANDSHAKE_BENCH_TRANSPORT_BUFFER_SIZE;
+  if (RETURN_ERROR(SpdmSendReceiveData (
+                     Bench->RequesterContext,
+                     &Bench->SessionId,
+                     TRUE,
+                     Bench->Message,
+                     HANDSHAKE_BENCH_APP_MESSAGE_SIZE,
+                     Bench->ResponseMessage,
+                     &ResponseSize
+                     ))) {
+    return FALSE;
+  }
+  return (ResponseSize == HANDSHAKE_BENCH_APP_MESSAGE_SIZE) &&
+         (CompareMem (Bench->Message, Bench->ResponseMessage, HANDSHAKE_BENCH_APP_MESSAGE_SIZE) == 0);
+}
+
+HANDSHAKE_BENCH_OPERATION  mHandshakeBenchOperation[] = {
+  {"VCA",         NULL,                                      NULL,                         HandshakeBenchInitConnection,  NULL,                      NULL},
+  {"DigestCert",  NULL,                                      HandshakeBenchInitConnection, HandshakeBenchGetCertificate,  NULL,                      NULL},
+  {"Challenge",   NULL,                                      HandshakeBenchAuthenticate,   HandshakeBenchChallenge,       NULL,                      NULL},
+  {"Measurement", HandshakeBenchAuthenticate,                NULL,                         HandshakeBenchGetMeasurement,  NULL,                      NULL},
+  {"KeyExchange", HandshakeBenchAuthenticate,                NULL,                         HandshakeBenchStartSession,    HandshakeBenchStopSession, NULL},
+  {"PskExchange", HandshakeBenchInitConnection,              NULL,                         HandshakeBenchStartPskSession, HandshakeBenchStopSession, NULL},
+  {"KeyUpdate",   HandshakeBenchAuthenticateAndStartSession, NULL,                         HandshakeBenchKeyUpdate,       NULL,                      HandshakeBenchStopSession},
+  {"AppData",     HandshakeBenchAuthenticateAndStartSession, NULL,                         HandshakeBenchAppData,         NULL,                      HandshakeBenchStopSession},
+};
+
+int
+HandshakeBenchCompareSample (
+  IN CONST VOID       *Left,
+  IN CONST VOID       *Right
+  )
+{
+  UINT64  LeftSample;
+  UINT64  RightSample;
+
+  LeftSample = *(CONST UINT64 *)Left;
+  RightSample = *(CONST UINT64 *)Right;
+  if (LeftSample < RightSample) {
+    return -1;
+  }
+  return (LeftSample > RightSample) ? 1 : 0;
+}
+
+/**
+  Return a percentile of the sorted latency samples, in microseconds.
+
+  @param  Sample                       The sorted samples, in nanoseconds.
+  @param  SampleCount                  The number of samples.
+  @param  PerMille                     The percentile, in per mille.
+**/
+double
+HandshakeBenchGetPercentile (
+  IN UINT64  *Sample,
+  IN UINTN   SampleCount,
+  IN UINTN   PerMille
+  )
+{
+  UINTN  Index;
+
+  Index = (SampleCount * PerMille) / 1000;
+  if (Index >= SampleCount) {
+    Index = SampleCount - 1;
+  }
+  return (double)Sample[Index] / 1000.0;
+}
+
+/**
+  Print the failure line of one operation.
+
+  @param  Bench                        The benchmark context.
+  @param  Operation                    The operation.
+**/
+VOID
+HandshakeBenchPrintFailure (
+  IN HANDSHAKE_BENCH_CONTEXT    *Bench,
+  IN HANDSHAKE_BENCH_OPERATION  *Operation
+  )
+{
+  printf (
+    "%s,%s,%s,%s,%s,%s,0,0,0,0,0,0,0,0,0,0,fail\n",
+    HANDSHAKE_BENCH_BACKEND_NAME,
+    Bench->Suite->AsymName,
+    Bench->Suite->HashName,
+    Bench->Suite->DheName,
+    Bench->Suite->AeadName,
+    Operation->Name
+    );
+}
+
+/**
+  Print the audit lines of the allocations of one operation, per request code and phase.
+
+  Nothing is printed if the MemoryAllocationLib does not audit the allocations.
+
+  @param  Bench                        The benchmark context.
+  @param  Operation                    The operation.
+**/
+VOID
+HandshakeBenchPrintAudit (
+  IN HANDSHAKE_BENCH_CONTEXT    *Bench,
+  IN HANDSHAKE_BENCH_OPERATION  *Operation
+  )
+{
+  STATIC CONST CHAR8  *PhaseName[POOL_ALLOCATION_PHASE_COUNT] = {"none", "requester", "responder"};
+  POOL_AUDIT_RECORD   Record;
+  UINTN               Phase;
+  UINTN               RequestCode;
+
+  for (Phase = 0; Phase < POOL_ALLOCATION_PHASE_COUNT; Phase++) {
+    for (RequestCode = 0; RequestCode < 256; RequestCode++) {
+      if (!GetPoolAuditRecord ((UINT8)RequestCode, (UINT8)Phase, &Record)) {
+        return ;
+      }
+      if (Record.AllocationCount == 0) {
+        continue;
+      }
+      fprintf (
+        stderr,
+        "audit,%s,%s,%s,%s,%s,%s,%s,0x%02x,%.1f,%.1f,%u\n",
+        HANDSHAKE_BENCH_BACKEND_NAME,
+        Bench->Suite->AsymName,
+        Bench->Suite->HashName,
+        Bench->Suite->DheName,
+        Bench->Suite->AeadName,
+        Operation->Name,
+        PhaseName[Phase],
+        (UINT32)RequestCode,
+        (double)Record.AllocationCount / (double)mHandshakeBenchIterations,
+        (double)Record.AllocationSize / (double)mHandshakeBenchIterations,
+        (UINT32)Record.LiveCount
+        );
+    }
+  }
+}
+
+/**
+  Measure one operation and report one result line.
+
+  A first iteration, which is not timed, records the heap peak and the stack peak.
+  The next iterations are timed one by one.
+
+  @param  Bench                        The benchmark context.
+  @param  Operation                    The operation.
+**/
+VOID
+HandshakeBenchRun (
+  IN HANDSHAKE_BENCH_CONTEXT    *Bench,
+  IN HANDSHAKE_BENCH_OPERATION  *Operation
+  )
+{
+  BOOLEAN  Result;
+  BOOLEAN  ArenaSet;
+  UINTN    HeapPeak;
+  UINTN    StackPeak;
+  UINTN    Index;
+  UINTN    Allocations;
+  UINT64   Start;
+  UINT64   Total;
+  CHAR8    HeapPeakString[32];
+  BOOLEAN  OverBudget;
+
+  if ((Operation->Setup != NULL) && !Operation->Setup (Bench)) {
+    HandshakeBenchPrintFailure (Bench, Operation);
+    HandshakeBenchStopSession (Bench);
+    return ;
+  }
+
+  StackPeak = 0;
+  Result = (Operation->Prepare == NULL) || Operation->Prepare (Bench);
+  if (Result) {
+    ArenaSet = SetPoolArena (Bench->Arena, HANDSHAKE_BENCH_ARENA_SIZE, FALSE);
+    HandshakeBenchStackProbe (TRUE);
+    Result = Operation->Run (Bench);
+    StackPeak = HandshakeBenchStackProbe (FALSE);
+    HeapPeak = GetPoolArenaPeakSize ();
+    if (Result && (Operation->Cleanup != NULL)) {
+      Result = Operation->Cleanup (Bench);
+    }
+    //
+    // A block which outlives the operation keeps the arena, until it is freed.
+    //
+    if (ArenaSet) {
+      ArenaSet = SetPoolArena (NULL, 0, FALSE);
+    }
+    if (ArenaSet) {
+      snprintf (HeapPeakString, sizeof(HeapPeakString), "%u", (UINT32)HeapPeak);
+    } else {
+      snprintf (HeapPeakString, sizeof(HeapPeakString), "n/a");
+    }
+  }
+
+  Allocations = 0;
+  Total = 0;
+  ResetPoolAudit ();
+  for (Index = 0; Result && (Index < mHandshakeBenchIterations); Index++) {
+    if ((Operation->Prepare != NULL) && !Operation->Prepare (Bench)) {
+      Result = FALSE;
+      break;
+    }
+    Allocations -= GetPoolAllocationCount ();
+    Start = HandshakeBenchGetTimeNs ();
+    Result = Operation->Run (Bench);
+    Bench->Sample[Index] = HandshakeBenchGetTimeNs () - Start;
+    Allocations += GetPoolAllocationCount ();
+    Total += Bench->Sample[Index];
+    if (Result && (Operation->Cleanup != NULL)) {
+      Result = Operation->Cleanup (Bench);
+    }
+  }
+
+  if (Operation->Teardown != NULL) {
+    Operation->Teardown (Bench);
+  }
+  HandshakeBenchStopSession (Bench);
+
+  if (!Result) {
+    HandshakeBenchPrintFailure (Bench, Operation);
+    return ;
+  }
+
+  HandshakeBenchPrintAudit (Bench, Operation);
+  OverBudget = ((double)Allocations / (double)mHandshakeBenchIterations > (double)mHandshakeBenchMaxAllocations);
+  if (OverBudget) {
+    mHandshakeBenchOverBudget = TRUE;
+  }
+
+  qsort (Bench->Sample, mHandshakeBenchIterations, sizeof(UINT64), HandshakeBenchCompareSample);
+  printf (
+    "%s,%s,%s,%s,%s,%s,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%s,%u,%s\n",
+    HANDSHAKE_BENCH_BACKEND_NAME,
+    Bench->Suite->AsymName,
+    Bench->Suite->HashName,
+    Bench->Suite->DheName,
+    Bench->Suite->AeadName,
+    Operation->Name,
+    (UINT32)mHandshakeBenchIterations,
+    (double)Bench->Sample[0] / 1000.0,
+    HandshakeBenchGetPercentile (Bench->Sample, mHandshakeBenchIterations, 500),
+    HandshakeBenchGetPercentile (Bench->Sample, mHandshakeBenchIterations, 900),
+    HandshakeBenchGetPercentile (Bench->Sample, mHandshakeBenchIterations, 990),
+    (double)Bench->Sample[mHandshakeBenchIterations - 1] / 1000.0,
+    (double)Total / 1000.0 / (double)mHandshakeBenchIterations,
+    (double)Allocations / (double)mHandshakeBenchIterations,
+    HeapPeakString,
+    (UINT32)StackPeak,
+    OverBudget ? "over_budget" : "ok"
+    );
+}
+
+/**
+  Benchmark all operations of one algorithm suite, with a new requester and a new responder.
+
+  @param  Bench                        The benchmark context.
+  @param  Suite                        The algorithm suite.
+**/
+VOID
+HandshakeBenchSuite (
+  IN HANDSHAKE_BENCH_CONTEXT  *Bench,
+  IN HANDSHAKE_BENCH_SUITE    *Suite
+  )
+{
+  VOID   *RequesterState;
+  VOID   *ResponderState;
+  UINTN  Index;
+
+  Bench->Suite = Suite;
+  Bench->PrivateKey = NULL;
+  Bench->CertChain = NULL;
+  Bench->RootCert = NULL;
+  Bench->SessionStarted = FALSE;
+
+  SetupSpdmTestContext (&mHandshakeBenchRequesterContext);
+  if (SpdmUnitTestGroupSetup (&RequesterState) != 0) {
+    return ;
+  }
+  SetupSpdmTestContext (&mHandshakeBenchResponderContext);
+  if (SpdmUnitTestGroupSetup (&ResponderState) != 0) {
+    SpdmUnitTestGroupTeardown (&RequesterState);
+    return ;
+  }
+  Bench->RequesterContext = mHandshakeBenchRequesterContext.SpdmContext;
+  Bench->ResponderContext = mHandshakeBenchResponderContext.SpdmContext;
+
+  HandshakeBenchSetupAlgorithms (Bench->RequesterContext, Suite, HANDSHAKE_BENCH_REQUESTER_CAPABILITY_FLAGS);
+  HandshakeBenchSetupAlgorithms (Bench->ResponderContext, Suite, HANDSHAKE_BENCH_RESPONDER_CAPABILITY_FLAGS);
+  SpdmRegisterGetResponseFunc (Bench->ResponderContext, HandshakeBenchEchoAppMessage);
+
+  if (!HandshakeBenchProvision (Bench)) {
+    printf (
+      "%s,%s,%s,%s,%s,Setup,0,0,0,0,0,0,0,0,0,0,fail\n",
+      HANDSHAKE_BENCH_BACKEND_NAME,
+      Suite->AsymName,
+      Suite->HashName,
+      Suite->DheName,
+      Suite->AeadName
+      );
+  } else {
+    for (Index = 0; Index < ARRAY_SIZE(mHandshakeBenchOperation); Index++) {
+      HandshakeBenchRun (Bench, &mHandshakeBenchOperation[Index]);
+    }
+  }
+
+  SpdmUnitTestGroupTeardown (&ResponderState);
+  SpdmUnitTestGroupTeardown (&RequesterState);
+  if (Bench->PrivateKey != NULL) {
+    SpdmResponderDataReleaseKeyFunc (Suite->BaseAsymAlgo, Bench->PrivateKey);
+  }
+  if (Bench->CertChain != NULL) {
+    free (Bench->CertChain);
+  }
+  if (Bench->RootCert != NULL) {
+    free (Bench->RootCert);
+  }
+}
+
+/**
+  Entry Point of SPDM Handshake Benchmark Utility.
+
+  An optional argument gives the number of measured iterations of one operation,
+  and an optional second argument the maximum allocations per operation.
+**/
+int main(int argc, char *argv[])
+{
+  HANDSHAKE_BENCH_CONTEXT  Bench;
+  UINTN                    Index;
+
+  if (argc > 1) {
+    mHandshakeBenchIterations = (UINTN)strtoul (argv[1], NULL, 0);
+    if (mHandshakeBenchIterations == 0) {
+      mHandshakeBenchIterations = 1;
+    }
+  }
+  if (argc > 2) {
+    mHandshakeBenchMaxAllocations = (UINTN)strtoul (argv[2], NULL, 0);
+  }
+
+  ZeroMem (&Bench, sizeof(Bench));
+  mHandshakeBenchRequesterContext.SendMessage = HandshakeBenchSendMessage;
+  mHandshakeBenchRequesterContext.ReceiveMessage = HandshakeBenchReceiveMessage;
+  Bench.Arena = AllocatePool (HANDSHAKE_BENCH_ARENA_SIZE);
+  Bench.Sample = AllocatePool (mHandshakeBenchIterations * sizeof(UINT64));
+  Bench.Message = AllocatePool (HANDSHAKE_BENCH_TRANSPORT_BUFFER_SIZE * 2);
+  if ((Bench.Arena == NULL) || (Bench.Sample == NULL) || (Bench.Message == NULL)) {
+    return 1;
+  }
+  Bench.ResponseMessage = Bench.Message + HANDSHAKE_BENCH_TRANSPORT_BUFFER_SIZE;
+  SpdmGetRandomNumber (HANDSHAKE_BENCH_APP_MESSAGE_SIZE, Bench.Message);
+  Bench.Message[0] = HANDSHAKE_BENCH_APP_MESSAGE_TYPE;
+
+  printf ("backend,asym,hash,dhe,aead,operation,iterations,min_us,p50_us,p90_us,p99_us,max_us,mean_us,allocs_per_op,heap_peak,stack_peak,status\n");
+  for (Index = 0; Index < ARRAY_SIZE(mHandshakeBenchSuite); Index++) {
+    HandshakeBenchSuite (&Bench, &mHandshakeBenchSuite[Index]);
+  }
+
+  FreePool (Bench.Message);
+  FreePool (Bench.Sample);
+  //
+  // The arena is kept if a block allocated from it is still outstanding.
+  //
+  if (SetPoolArena (NULL, 0, FALSE)) {
+    FreePool (Bench.Arena);
+  }
+  return mHandshakeBenchOverBudget ? 1 : 0;
+}
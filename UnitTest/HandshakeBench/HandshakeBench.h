@@ -0,0 +1,76 @@
+/** @file
+  Application for SPDM Handshake Benchmark.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __HANDSHAKE_BENCH_H__
+#define __HANDSHAKE_BENCH_H__
+
+#include "SpdmUnitTest.h"
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SpdmDeviceSecretLib.h>
+
+//
+// The build passes HANDSHAKEBENCH_BACKEND_<CRYPTO> to name the crypto backend in the report.
+//
+#if defined(HANDSHAKEBENCH_BACKEND_Openssl)
+#define HANDSHAKE_BENCH_BACKEND_NAME  "Openssl"
+#elif defined(HANDSHAKEBENCH_BACKEND_MbedTls)
+#define HANDSHAKE_BENCH_BACKEND_NAME  "MbedTls"
+#elif defined(HANDSHAKEBENCH_BACKEND_Dummy)
+#define HANDSHAKE_BENCH_BACKEND_NAME  "Dummy"
+#else
+#define HANDSHAKE_BENCH_BACKEND_NAME  "Unknown"
+#endif
+
+//
+// Size of the transport message buffer between the requester and the responder.
+//
+#define HANDSHAKE_BENCH_TRANSPORT_BUFFER_SIZE  (MAX_SPDM_MESSAGE_BUFFER_SIZE + 0x100)
+
+//
+// Size of the application message echoed by the responder in the AppData operation.
+// The first byte is the message type of the test transport, which must not be an SPDM message type.
+//
+#define HANDSHAKE_BENCH_APP_MESSAGE_SIZE  64
+#define HANDSHAKE_BENCH_APP_MESSAGE_TYPE  0x80
+
+//
+// Size of the arena which records the peak of the pool allocations of one operation.
+//
+#define HANDSHAKE_BENCH_ARENA_SIZE  SIZE_4MB
+
+//
+// Size of the stack region painted below the caller to record the peak stack of one operation.
+//
+#define HANDSHAKE_BENCH_STACK_PROBE_SIZE  SIZE_256KB
+
+/**
+  Return a monotonic enough time stamp in nanoseconds.
+
+  @return the time stamp in nanoseconds.
+**/
+UINT64
+HandshakeBenchGetTimeNs (
+  VOID
+  );
+
+/**
+  Paint the stack region below the caller, or measure how deep it was used since it was painted.
+
+  The same function paints and measures, so that the region is at the same place in both calls.
+  It must be called from the same function as the operation which is measured.
+
+  @param  Paint                        TRUE to paint the region, FALSE to measure it.
+
+  @return the size in bytes of the region used since it was painted, or 0 when it is painted.
+**/
+UINTN
+HandshakeBenchStackProbe (
+  IN BOOLEAN  Paint
+  );
+
+#endif
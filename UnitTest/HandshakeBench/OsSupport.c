@@ -0,0 +1,64 @@
+/** @file
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "HandshakeBench.h"
+
+#include <time.h>
+
+#define HANDSHAKE_BENCH_STACK_PATTERN  0xA5
+
+/**
+  Return a monotonic enough time stamp in nanoseconds.
+
+  @return the time stamp in nanoseconds.
+**/
+UINT64
+HandshakeBenchGetTimeNs (
+  VOID
+  )
+{
+  struct timespec             Time;
+
+  timespec_get (&Time, TIME_UTC);
+  return (UINT64)Time.tv_sec * 1000000000ull + (UINT64)Time.tv_nsec;
+}
+
+/**
+  Paint the stack region below the caller, or measure how deep it was used since it was painted.
+
+  The same function paints and measures, so that the region is at the same place in both calls.
+  It must be called from the same function as the operation which is measured.
+
+  @param  Paint                        TRUE to paint the region, FALSE to measure it.
+
+  @return the size in bytes of the region used since it was painted, or 0 when it is painted.
+**/
+UINTN
+HandshakeBenchStackProbe (
+  IN BOOLEAN  Paint
+  )
+{
+  volatile UINT8  Region[HANDSHAKE_BENCH_STACK_PROBE_SIZE];
+  UINTN           Index;
+
+  if (Paint) {
+    for (Index = 0; Index < sizeof(Region); Index++) {
+      Region[Index] = HANDSHAKE_BENCH_STACK_PATTERN;
+    }
+    return 0;
+  }
+
+  //
+  // The stack grows down, so the deepest byte used is the lowest one which is not painted.
+  //
+  for (Index = 0; Index < sizeof(Region); Index++) {
+    if (Region[Index] != HANDSHAKE_BENCH_STACK_PATTERN) {
+      break;
+    }
+  }
+  return sizeof(Region) - Index;
+}
@@ -0,0 +1,49 @@
+/** @file
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SecuredMessageBench.h"
+
+#include <time.h>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+/**
+  Return a monotonic enough time stamp in nanoseconds.
+
+  @return the time stamp in nanoseconds.
+**/
+UINT64
+SecuredMessageBenchGetTimeNs (
+  VOID
+  )
+{
+  struct timespec             Time;
+
+  timespec_get (&Time, TIME_UTC);
+  return (UINT64)Time.tv_sec * 1000000000ull + (UINT64)Time.tv_nsec;
+}
+
+/**
+  Return the CPU cycle counter.
+
+  @return the CPU cycle counter, or 0 if the architecture has no cycle counter readable here.
+**/
+UINT64
+SecuredMessageBenchGetCycles (
+  VOID
+  )
+{
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || \
+    (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+  return (UINT64)__rdtsc ();
+#else
+  return 0;
+#endif
+}
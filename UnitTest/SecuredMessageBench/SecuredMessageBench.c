@@ -0,0 +1,492 @@
+/** @file
+  Application for Secured Message Throughput Benchmark.
+
+  An established session is set up between a requester and a responder SPDM context,
+  for each transport, AEAD cipher suite and session type. Application messages are then
+  encoded by the requester and decoded by the responder, through the transport layer and
+  SpdmEncodeSecuredMessage/SpdmDecodeSecuredMessage. One CSV line is printed per measurement:
+  backend,transport,aead,session,operation,size,records,records_per_s,mb_per_s,cycles_per_byte,allocs_per_record,status
+
+  The Encode operation only encodes the record. The EncodeDecode operation encodes the record
+  and decodes it on the peer, so the decode cost is the difference of both.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SecuredMessageBench.h"
+
+UINTN  mSecuredMessageBenchRecordSize[SECURED_MESSAGE_BENCH_RECORD_SIZE_COUNT] = {16, 64, 256, 1024, 4096, MAX_SPDM_MESSAGE_BUFFER_SIZE};
+
+//
+// Minimum measurement time of one operation, in nanoseconds.
+//
+UINT64 mSecuredMessageBenchMinTimeNs = 200000000ull;
+
+typedef struct {
+  CHAR8                               *Name;
+  SPDM_TRANSPORT_ENCODE_MESSAGE_FUNC  EncodeMessage;
+  SPDM_TRANSPORT_DECODE_MESSAGE_FUNC  DecodeMessage;
+  BOOLEAN                             IsAppMessage;
+} SECURED_MESSAGE_BENCH_TRANSPORT;
+
+//
+// PCI DOE carries no application message, so a secured SPDM message is used instead.
+//
+SECURED_MESSAGE_BENCH_TRANSPORT  mSecuredMessageBenchTransport[] = {
+  {"Test",   SpdmTransportTestEncodeMessage,   SpdmTransportTestDecodeMessage,   TRUE},
+  {"MCTP",   SpdmTransportMctpEncodeMessage,   SpdmTransportMctpDecodeMessage,   TRUE},
+  {"PCI-DOE", SpdmTransportPciDoeEncodeMessage, SpdmTransportPciDoeDecodeMessage, FALSE},
+};
+
+typedef struct {
+  UINT16    AEADCipherSuite;
+  CHAR8     *Name;
+} SECURED_MESSAGE_BENCH_AEAD_ALGO;
+
+SECURED_MESSAGE_BENCH_AEAD_ALGO  mSecuredMessageBenchAeadAlgo[] = {
+  {SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM,       "AES-128-GCM"},
+  {SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM,       "AES-256-GCM"},
+  {SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305, "CHACHA20-POLY1305"},
+};
+
+typedef struct {
+  UINT32    CapabilityFlags;
+  CHAR8     *Name;
+} SECURED_MESSAGE_BENCH_SESSION_TYPE;
+
+SECURED_MESSAGE_BENCH_SESSION_TYPE  mSecuredMessageBenchSessionType[] = {
+  {SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCRYPT_CAP | SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP, "EncMac"},
+  {SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP,                                                   "MacOnly"},
+};
+
+typedef struct {
+  SECURED_MESSAGE_BENCH_TRANSPORT  *Transport;
+  VOID                             *RequesterContext;
+  VOID                             *ResponderContext;
+  UINT32                           SessionId;
+  UINT8                            *SessionKeys;
+  UINTN                            SessionKeysSize;
+  UINT8                            *Message;
+  UINTN                            MessageSize;
+  UINT8                            *TransportMessage;
+  UINT8                            *DecodedMessage;
+} SECURED_MESSAGE_BENCH_CONTEXT;
+
+SPDM_TEST_CONTEXT  mSecuredMessageBenchRequesterContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  TRUE,
+  NULL,
+  NULL,
+};
+
+SPDM_TEST_CONTEXT  mSecuredMessageBenchResponderContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  FALSE,
+  NULL,
+  NULL,
+};
+
+/**
+  One operation to be measured.
+
+  @param  Bench                        The benchmark context.
+
+  @retval TRUE   The operation succeeded.
+  @retval FALSE  The operation failed.
+**/
+typedef
+BOOLEAN
+(*SECURED_MESSAGE_BENCH_FUNC) (
+  IN SECURED_MESSAGE_BENCH_CONTEXT  *Bench
+  );
+
+/**
+  Encode the application message of the requester to a transport message.
+
+  @param  Bench                        The benchmark context.
+  @param  TransportMessageSize         Return the size in bytes of the transport message.
+
+  @retval TRUE   The message is encoded.
+  @retval FALSE  The message cannot be encoded.
+**/
+BOOLEAN
+SecuredMessageBenchEncodeMessage (
+  IN  SECURED_MESSAGE_BENCH_CONTEXT  *Bench,
+  OUT UINTN                          *TransportMessageSize
+  )
+{
+  RETURN_STATUS  Status;
+
+  *TransportMessageSize = SECURED_MESSAGE_BENCH_TRANSPORT_BUFFER_SIZE;
+  Status = Bench->Transport->EncodeMessage (
+             Bench->RequesterContext,
+             &Bench->SessionId,
+             Bench->Transport->IsAppMessage,
+             TRUE,
+             Bench->MessageSize,
+             Bench->Message,
+             TransportMessageSize,
+             Bench->TransportMessage
+             );
+  return !RETURN_ERROR(Status);
+}
+
+/**
+  Encode one record.
+
+  @param  Bench                        The benchmark context.
+
+  @retval TRUE   The record is encoded.
+  @retval FALSE  The record cannot be encoded.
+**/
+BOOLEAN
+SecuredMessageBenchEncode (
+  IN SECURED_MESSAGE_BENCH_CONTEXT  *Bench
+  )
+{
+  UINTN  TransportMessageSize;
+
+  return SecuredMessageBenchEncodeMessage (Bench, &TransportMessageSize);
+}
+
+/**
+  Encode one record and decode it on the peer.
+
+  @param  Bench                        The benchmark context.
+
+  @retval TRUE   The record is encoded and decoded to the original message.
+  @retval FALSE  The record cannot be encoded or decoded.
+**/
+BOOLEAN
+SecuredMessageBenchEncodeDecode (
+  IN SECURED_MESSAGE_BENCH_CONTEXT  *Bench
+  )
+{
+  RETURN_STATUS  Status;
+  UINTN          TransportMessageSize;
+  UINT32         *SessionId;
+  BOOLEAN        IsAppMessage;
+  UINTN          MessageSize;
+
+  if (!SecuredMessageBenchEncodeMessage (Bench, &TransportMessageSize)) {
+    return FALSE;
+  }
+
+  MessageSize = SECURED_MESSAGE_BENCH_TRANSPORT_BUFFER_SIZE;
+  Status = Bench->Transport->DecodeMessage (
+             Bench->ResponderContext,
+             &SessionId,
+             &IsAppMessage,
+             TRUE,
+             TransportMessageSize,
+             Bench->TransportMessage,
+             &MessageSize,
+             Bench->DecodedMessage
+             );
+  if (RETURN_ERROR(Status)) {
+    return FALSE;
+  }
+  return (SessionId != NULL) && (*SessionId == Bench->SessionId) &&
+         (IsAppMessage == Bench->Transport->IsAppMessage) &&
+         (MessageSize == Bench->MessageSize);
+}
+
+/**
+  Import the session keys to both peers, so that both sequence numbers restart from 0.
+
+  @param  Bench                        The benchmark context.
+
+  @retval TRUE   The session keys are imported.
+  @retval FALSE  The session keys cannot be imported.
+**/
+BOOLEAN
+SecuredMessageBenchResetSession (
+  IN SECURED_MESSAGE_BENCH_CONTEXT  *Bench
+  )
+{
+  RETURN_STATUS  Status;
+
+  Status = SpdmSecuredMessageImportSessionKeys (
+             SpdmGetSecuredMessageContextViaSessionId (Bench->RequesterContext, Bench->SessionId),
+             Bench->SessionKeys,
+             Bench->SessionKeysSize
+             );
+  if (RETURN_ERROR(Status)) {
+    return FALSE;
+  }
+  Status = SpdmSecuredMessageImportSessionKeys (
+             SpdmGetSecuredMessageContextViaSessionId (Bench->ResponderContext, Bench->SessionId),
+             Bench->SessionKeys,
+             Bench->SessionKeysSize
+             );
+  return !RETURN_ERROR(Status);
+}
+
+/**
+  Measure one operation and report one result line.
+
+  The operation is repeated until the minimum measurement time is reached.
+
+  @param  Bench                        The benchmark context.
+  @param  AeadName                     The name of the AEAD cipher suite.
+  @param  SessionName                  The name of the session type.
+  @param  Operation                    The name of the operation.
+  @param  Func                         The operation.
+**/
+VOID
+SecuredMessageBenchRun (
+  IN SECURED_MESSAGE_BENCH_CONTEXT  *Bench,
+  IN CHAR8                          *AeadName,
+  IN CHAR8                          *SessionName,
+  IN CHAR8                          *Operation,
+  IN SECURED_MESSAGE_BENCH_FUNC     Func
+  )
+{
+  UINT64   Iterations;
+  UINT64   Batch;
+  UINT64   Index;
+  UINT64   Start;
+  UINT64   StartCycles;
+  UINTN    StartAllocations;
+  UINT64   Elapsed;
+  UINT64   Cycles;
+  double   RecordsPerSec;
+  double   MbPerSec;
+  double   CyclesPerByte;
+  double   AllocationsPerRecord;
+
+  //
+  // Warm up, so that the keyed AEAD handles of both peers are set up.
+  //
+  if (!SecuredMessageBenchResetSession (Bench) || !Func (Bench) ||
+      !SecuredMessageBenchResetSession (Bench)) {
+    printf (
+      "%s,%s,%s,%s,%s,%u,0,0,0,0,0,fail\n",
+      SECURED_MESSAGE_BENCH_BACKEND_NAME,
+      Bench->Transport->Name,
+      AeadName,
+      SessionName,
+      Operation,
+      (UINT32)Bench->MessageSize
+      );
+    return ;
+  }
+
+  Iterations = 0;
+  Batch = 1;
+  StartAllocations = GetPoolAllocationCount ();
+  StartCycles = SecuredMessageBenchGetCycles ();
+  Start = SecuredMessageBenchGetTimeNs ();
+  do {
+    for (Index = 0; Index < Batch; Index++) {
+      if (!Func (Bench)) {
+        printf (
+          "%s,%s,%s,%s,%s,%u,0,0,0,0,0,fail\n",
+          SECURED_MESSAGE_BENCH_BACKEND_NAME,
+          Bench->Transport->Name,
+          AeadName,
+          SessionName,
+          Operation,
+          (UINT32)Bench->MessageSize
+          );
+        return ;
+      }
+    }
+    Iterations += Batch;
+    Batch *= 2;
+    Elapsed = SecuredMessageBenchGetTimeNs () - Start;
+  } while (Elapsed < mSecuredMessageBenchMinTimeNs);
+  Cycles = SecuredMessageBenchGetCycles () - StartCycles;
+
+  RecordsPerSec = ((double)Iterations * 1000000000.0) / (double)Elapsed;
+  MbPerSec = ((double)Bench->MessageSize * (double)Iterations * 1000.0) / (double)Elapsed;
+  CyclesPerByte = (double)Cycles / ((double)Bench->MessageSize * (double)Iterations);
+  AllocationsPerRecord = (double)(GetPoolAllocationCount () - StartAllocations) / (double)Iterations;
+  printf (
+    "%s,%s,%s,%s,%s,%u,%llu,%.0f,%.2f,%.2f,%.2f,ok\n",
+    SECURED_MESSAGE_BENCH_BACKEND_NAME,
+    Bench->Transport->Name,
+    AeadName,
+    SessionName,
+    Operation,
+    (UINT32)Bench->MessageSize,
+    (unsigned long long)Iterations,
+    RecordsPerSec,
+    MbPerSec,
+    CyclesPerByte,
+    AllocationsPerRecord
+    );
+}
+
+/**
+  Set up an established session with imported session keys in one SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+  @param  CapabilityFlags              The ENCRYPT_CAP and MAC_CAP flags of both peers.
+  @param  SessionId                    The session ID of the session.
+
+  @retval TRUE   The session is set up.
+  @retval FALSE  The session cannot be set up.
+**/
+BOOLEAN
+SecuredMessageBenchSetupSession (
+  IN VOID     *SpdmContext,
+  IN UINT16   AEADCipherSuite,
+  IN UINT32   CapabilityFlags,
+  IN UINT32   SessionId
+  )
+{
+  SPDM_DEVICE_CONTEXT  *Context;
+  SPDM_SESSION_INFO    *SessionInfo;
+
+  Context = SpdmContext;
+  Context->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  Context->ConnectionInfo.Capability.Flags = CapabilityFlags;
+  Context->LocalContext.Capability.Flags = CapabilityFlags;
+  Context->ConnectionInfo.Algorithm.BaseHashAlgo = SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256;
+  Context->ConnectionInfo.Algorithm.DHENamedGroup = SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1;
+  Context->ConnectionInfo.Algorithm.AEADCipherSuite = AEADCipherSuite;
+  Context->ConnectionInfo.Algorithm.KeySchedule = SPDM_ALGORITHMS_KEY_SCHEDULE_HMAC_HASH;
+
+  SessionInfo = SpdmAssignSessionId (Context, SessionId, FALSE);
+  if (SessionInfo == NULL) {
+    return FALSE;
+  }
+  SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SpdmSessionStateEstablished);
+  return TRUE;
+}
+
+/**
+  Build random session keys with both sequence numbers at 0.
+
+  @param  Bench                        The benchmark context.
+  @param  AEADCipherSuite              SPDM AEADCipherSuite
+**/
+VOID
+SecuredMessageBenchBuildSessionKeys (
+  IN SECURED_MESSAGE_BENCH_CONTEXT  *Bench,
+  IN UINT16                         AEADCipherSuite
+  )
+{
+  SPDM_SECURE_SESSION_KEYS_STRUCT  *SessionKeysStruct;
+  UINT32                           KeySize;
+  UINT32                           IvSize;
+
+  KeySize = GetSpdmAeadKeySize (AEADCipherSuite);
+  IvSize = GetSpdmAeadIvSize (AEADCipherSuite);
+  Bench->SessionKeysSize = sizeof(SPDM_SECURE_SESSION_KEYS_STRUCT) + (KeySize + IvSize + sizeof(UINT64)) * 2;
+
+  SessionKeysStruct = (VOID *)Bench->SessionKeys;
+  SessionKeysStruct->Version = SPDM_SECURE_SESSION_KEYS_STRUCT_VERSION;
+  SessionKeysStruct->AeadKeySize = KeySize;
+  SessionKeysStruct->AeadIvSize = IvSize;
+  SpdmGetRandomNumber (Bench->SessionKeysSize - sizeof(SPDM_SECURE_SESSION_KEYS_STRUCT), (UINT8 *)(SessionKeysStruct + 1));
+  ZeroMem ((UINT8 *)(SessionKeysStruct + 1) + KeySize + IvSize, sizeof(UINT64));
+  ZeroMem ((UINT8 *)Bench->SessionKeys + Bench->SessionKeysSize - sizeof(UINT64), sizeof(UINT64));
+}
+
+/**
+  Benchmark all record sizes of one transport, AEAD cipher suite and session type.
+
+  @param  Bench                        The benchmark context.
+  @param  AeadAlgo                     The AEAD cipher suite.
+  @param  SessionType                  The session type.
+**/
+VOID
+SecuredMessageBenchSession (
+  IN SECURED_MESSAGE_BENCH_CONTEXT       *Bench,
+  IN SECURED_MESSAGE_BENCH_AEAD_ALGO     *AeadAlgo,
+  IN SECURED_MESSAGE_BENCH_SESSION_TYPE  *SessionType
+  )
+{
+  UINTN  SizeIndex;
+
+  SpdmRegisterTransportLayerFunc (Bench->RequesterContext, Bench->Transport->EncodeMessage, Bench->Transport->DecodeMessage);
+  SpdmRegisterTransportLayerFunc (Bench->ResponderContext, Bench->Transport->EncodeMessage, Bench->Transport->DecodeMessage);
+
+  if (!SecuredMessageBenchSetupSession (Bench->RequesterContext, AeadAlgo->AEADCipherSuite, SessionType->CapabilityFlags, Bench->SessionId) ||
+      !SecuredMessageBenchSetupSession (Bench->ResponderContext, AeadAlgo->AEADCipherSuite, SessionType->CapabilityFlags, Bench->SessionId)) {
+    printf (
+      "%s,%s,%s,%s,Setup,0,0,0,0,0,0,fail\n",
+      SECURED_MESSAGE_BENCH_BACKEND_NAME,
+      Bench->Transport->Name,
+      AeadAlgo->Name,
+      SessionType->Name
+      );
+  } else {
+    SecuredMessageBenchBuildSessionKeys (Bench, AeadAlgo->AEADCipherSuite);
+    for (SizeIndex = 0; SizeIndex < SECURED_MESSAGE_BENCH_RECORD_SIZE_COUNT; SizeIndex++) {
+      Bench->MessageSize = mSecuredMessageBenchRecordSize[SizeIndex];
+      SecuredMessageBenchRun (Bench, AeadAlgo->Name, SessionType->Name, "Encode", SecuredMessageBenchEncode);
+      SecuredMessageBenchRun (Bench, AeadAlgo->Name, SessionType->Name, "EncodeDecode", SecuredMessageBenchEncodeDecode);
+    }
+  }
+
+  SpdmFreeSessionId (Bench->RequesterContext, Bench->SessionId);
+  SpdmFreeSessionId (Bench->ResponderContext, Bench->SessionId);
+}
+
+/**
+  Entry Point of Secured Message Benchmark Utility.
+
+  An optional argument gives the minimum measurement time of one operation, in milliseconds.
+**/
+int main(int argc, char *argv[])
+{
+  SECURED_MESSAGE_BENCH_CONTEXT  Bench;
+  VOID                           *RequesterState;
+  VOID                           *ResponderState;
+  UINT8                          *Buffer;
+  UINTN                          TransportIndex;
+  UINTN                          AlgoIndex;
+  UINTN                          TypeIndex;
+
+  if (argc > 1) {
+    mSecuredMessageBenchMinTimeNs = (UINT64)strtoul (argv[1], NULL, 0) * 1000000ull;
+  }
+
+  SetupSpdmTestContext (&mSecuredMessageBenchRequesterContext);
+  if (SpdmUnitTestGroupSetup (&RequesterState) != 0) {
+    return 1;
+  }
+  SetupSpdmTestContext (&mSecuredMessageBenchResponderContext);
+  if (SpdmUnitTestGroupSetup (&ResponderState) != 0) {
+    SpdmUnitTestGroupTeardown (&RequesterState);
+    return 1;
+  }
+
+  Buffer = AllocatePool (MAX_SPDM_MESSAGE_BUFFER_SIZE + SECURED_MESSAGE_BENCH_TRANSPORT_BUFFER_SIZE * 2 +
+                         sizeof(SPDM_SECURE_SESSION_KEYS_STRUCT) + (MAX_AEAD_KEY_SIZE + MAX_AEAD_IV_SIZE + sizeof(UINT64)) * 2);
+  if (Buffer == NULL) {
+    SpdmUnitTestGroupTeardown (&ResponderState);
+    SpdmUnitTestGroupTeardown (&RequesterState);
+    return 1;
+  }
+  ZeroMem (&Bench, sizeof(Bench));
+  Bench.RequesterContext = mSecuredMessageBenchRequesterContext.SpdmContext;
+  Bench.ResponderContext = mSecuredMessageBenchResponderContext.SpdmContext;
+  Bench.SessionId = SECURED_MESSAGE_BENCH_SESSION_ID;
+  Bench.Message = Buffer;
+  Bench.TransportMessage = Bench.Message + MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  Bench.DecodedMessage = Bench.TransportMessage + SECURED_MESSAGE_BENCH_TRANSPORT_BUFFER_SIZE;
+  Bench.SessionKeys = Bench.DecodedMessage + SECURED_MESSAGE_BENCH_TRANSPORT_BUFFER_SIZE;
+  SpdmGetRandomNumber (MAX_SPDM_MESSAGE_BUFFER_SIZE, Bench.Message);
+
+  printf ("backend,transport,aead,session,operation,size,records,records_per_s,mb_per_s,cycles_per_byte,allocs_per_record,status\n");
+  for (TransportIndex = 0; TransportIndex < ARRAY_SIZE(mSecuredMessageBenchTransport); TransportIndex++) {
+    Bench.Transport = &mSecuredMessageBenchTransport[TransportIndex];
+    for (AlgoIndex = 0; AlgoIndex < ARRAY_SIZE(mSecuredMessageBenchAeadAlgo); AlgoIndex++) {
+      for (TypeIndex = 0; TypeIndex < ARRAY_SIZE(mSecuredMessageBenchSessionType); TypeIndex++) {
+        SecuredMessageBenchSession (&Bench, &mSecuredMessageBenchAeadAlgo[AlgoIndex], &mSecuredMessageBenchSessionType[TypeIndex]);
+      }
+    }
+  }
+
+  FreePool (Buffer);
+  SpdmUnitTestGroupTeardown (&ResponderState);
+  SpdmUnitTestGroupTeardown (&RequesterState);
+  return 0;
+}
@@ -0,0 +1,65 @@
+/** @file
+  Application for Secured Message Throughput Benchmark.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __SECURED_MESSAGE_BENCH_H__
+#define __SECURED_MESSAGE_BENCH_H__
+
+#include "SpdmUnitTest.h"
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SpdmSecuredMessageLib.h>
+#include <Library/SpdmTransportMctpLib.h>
+#include <Library/SpdmTransportPciDoeLib.h>
+
+//
+// The build passes SECUREDMESSAGEBENCH_BACKEND_<CRYPTO> to name the crypto backend in the report.
+//
+#if defined(SECUREDMESSAGEBENCH_BACKEND_Openssl)
+#define SECURED_MESSAGE_BENCH_BACKEND_NAME  "Openssl"
+#elif defined(SECUREDMESSAGEBENCH_BACKEND_MbedTls)
+#define SECURED_MESSAGE_BENCH_BACKEND_NAME  "MbedTls"
+#elif defined(SECUREDMESSAGEBENCH_BACKEND_Dummy)
+#define SECURED_MESSAGE_BENCH_BACKEND_NAME  "Dummy"
+#else
+#define SECURED_MESSAGE_BENCH_BACKEND_NAME  "Unknown"
+#endif
+
+//
+// Application message sizes pushed through a session, from 16 bytes up to MAX_SPDM_MESSAGE_BUFFER_SIZE.
+//
+#define SECURED_MESSAGE_BENCH_RECORD_SIZE_COUNT  6
+extern UINTN  mSecuredMessageBenchRecordSize[SECURED_MESSAGE_BENCH_RECORD_SIZE_COUNT];
+
+//
+// Size of the transport message buffer. It holds the largest record with
+// the transport header, the secured message header, the random padding and the tag.
+//
+#define SECURED_MESSAGE_BENCH_TRANSPORT_BUFFER_SIZE  (MAX_SPDM_MESSAGE_BUFFER_SIZE + 0x100)
+
+#define SECURED_MESSAGE_BENCH_SESSION_ID  0xFFFEFFFE
+
+/**
+  Return a monotonic enough time stamp in nanoseconds.
+
+  @return the time stamp in nanoseconds.
+**/
+UINT64
+SecuredMessageBenchGetTimeNs (
+  VOID
+  );
+
+/**
+  Return the CPU cycle counter.
+
+  @return the CPU cycle counter, or 0 if the architecture has no cycle counter readable here.
+**/
+UINT64
+SecuredMessageBenchGetCycles (
+  VOID
+  );
+
+#endif
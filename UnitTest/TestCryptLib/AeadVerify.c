@@ -121,6 +121,28 @@ GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 ChaCha20Poly1305_tag[] = {
     0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91,
 };
 
+/* AES-GCM test data with an empty plain text, from NIST public test vectors */
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 gcm_mac_key[] = {
+    0x78, 0xdc, 0x4e, 0x0a, 0xaf, 0x52, 0xd9, 0x35, 0xc3, 0xc0, 0x1e, 0xea,
+    0x57, 0x42, 0x8f, 0x00, 0xca, 0x1f, 0xd4, 0x75, 0xf5, 0xda, 0x86, 0xa4,
+    0x9c, 0x8d, 0xd7, 0x3d, 0x68, 0xc8, 0xe2, 0x23
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 gcm_mac_iv[] = {
+    0xd7, 0x9c, 0xf2, 0x2d, 0x50, 0x4c, 0xc7, 0x93, 0xc3, 0xfb, 0x6c, 0x8a
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 gcm_mac_aad[] = {
+    0xb9, 0x6b, 0xaa, 0x8c, 0x1c, 0x75, 0xa6, 0x71, 0xbf, 0xb2, 0xd0, 0x8d,
+    0x06, 0xbe, 0x5f, 0x36
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 gcm_mac_tag[] = {
+    0x3e, 0x5d, 0x48, 0x6a, 0xa2, 0xe3, 0x0b, 0x22, 0xe0, 0x40, 0xb8, 0x57,
+    0x23, 0xa0, 0x6e, 0x76
+};
+
 /* SM4-GCM test data */
 
 GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 Sm4Gcm_pt[] = {
@@ -171,6 +193,10 @@ ValidateCryptAeadCipher (
   UINTN    OutBufferSize;
   UINT8    OutTag[1024];
   UINTN    OutTagSize;
+  UINT8    ExpectedTag[16];
+  VOID     *AeadContext;
+  BOOLEAN  Verified;
+  BOOLEAN  TamperedVerified;
 
   Print ("\nUEFI-OpenSSL AEAD Testing: ");
 
@@ -373,6 +399,145 @@ ValidateCryptAeadCipher (
   Print ("[Pass]");
 
 
+  Print ("\n- AES-GCM MAC: ");
+  AeadContext = AeadAesGcmNew ();
+  if (AeadContext == NULL) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+  Status = AeadAesGcmSetKey (AeadContext, gcm_mac_key, sizeof(gcm_mac_key));
+  if (Status) {
+    Status = AeadAesGcmMac (
+               AeadContext,
+               gcm_mac_iv,
+               sizeof(gcm_mac_iv),
+               gcm_mac_aad,
+               sizeof(gcm_mac_aad),
+               OutTag,
+               sizeof(gcm_mac_tag)
+               );
+  }
+  Verified = FALSE;
+  TamperedVerified = TRUE;
+  if (Status) {
+    Verified = AeadAesGcmVerifyMac (AeadContext, gcm_mac_iv, sizeof(gcm_mac_iv), gcm_mac_aad, sizeof(gcm_mac_aad), OutTag, sizeof(gcm_mac_tag));
+    OutTag[0] ^= 0x01;
+    TamperedVerified = AeadAesGcmVerifyMac (AeadContext, gcm_mac_iv, sizeof(gcm_mac_iv), gcm_mac_aad, sizeof(gcm_mac_aad), OutTag, sizeof(gcm_mac_tag));
+    OutTag[0] ^= 0x01;
+  }
+  AeadAesGcmFree (AeadContext);
+  if (!Status || !Verified || TamperedVerified) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+  if (CompareMem (OutTag, gcm_mac_tag, sizeof(gcm_mac_tag)) != 0) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+  //
+  // The MAC is the tag of the AEAD over an empty plain text.
+  //
+  OutBufferSize = sizeof(OutBuffer);
+  Status = AeadAesGcmEncrypt (
+             gcm_mac_key,
+             sizeof(gcm_mac_key),
+             gcm_mac_iv,
+             sizeof(gcm_mac_iv),
+             gcm_mac_aad,
+             sizeof(gcm_mac_aad),
+             gcm_pt,
+             0,
+             ExpectedTag,
+             sizeof(ExpectedTag),
+             OutBuffer,
+             &OutBufferSize
+             );
+  if (!Status || (OutBufferSize != 0)) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+  if (CompareMem (OutTag, ExpectedTag, sizeof(ExpectedTag)) != 0) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+  Print ("[Pass]");
+
+  Print ("\n- ChaCha20Poly1305 MAC: ");
+  AeadContext = AeadChaCha20Poly1305New ();
+  if (AeadContext == NULL) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+  Status = AeadChaCha20Poly1305SetKey (AeadContext, ChaCha20Poly1305_key, sizeof(ChaCha20Poly1305_key));
+  if (Status) {
+    Status = AeadChaCha20Poly1305Mac (
+               AeadContext,
+               ChaCha20Poly1305_iv,
+               sizeof(ChaCha20Poly1305_iv),
+               ChaCha20Poly1305_aad,
+               sizeof(ChaCha20Poly1305_aad),
+               OutTag,
+               sizeof(ChaCha20Poly1305_tag)
+               );
+  }
+  Verified = FALSE;
+  TamperedVerified = TRUE;
+  if (Status) {
+    Verified = AeadChaCha20Poly1305VerifyMac (
+                 AeadContext,
+                 ChaCha20Poly1305_iv,
+                 sizeof(ChaCha20Poly1305_iv),
+                 ChaCha20Poly1305_aad,
+                 sizeof(ChaCha20Poly1305_aad),
+                 OutTag,
+                 sizeof(ChaCha20Poly1305_tag)
+                 );
+    OutTag[sizeof(ChaCha20Poly1305_tag) - 1] ^= 0x80;
+    TamperedVerified = AeadChaCha20Poly1305VerifyMac (
+                         AeadContext,
+                         ChaCha20Poly1305_iv,
+                         sizeof(ChaCha20Poly1305_iv),
+                         ChaCha20Poly1305_aad,
+                         sizeof(ChaCha20Poly1305_aad),
+                         OutTag,
+                         sizeof(ChaCha20Poly1305_tag)
+                         );
+    OutTag[sizeof(ChaCha20Poly1305_tag) - 1] ^= 0x80;
+  }
+  AeadChaCha20Poly1305Free (AeadContext);
+  if (!Status || !Verified || TamperedVerified) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+  //
+  // The MAC is the tag of the AEAD over an empty plain text.
+  //
+  OutBufferSize = sizeof(OutBuffer);
+  Status = AeadChaCha20Poly1305Encrypt (
+             ChaCha20Poly1305_key,
+             sizeof(ChaCha20Poly1305_key),
+             ChaCha20Poly1305_iv,
+             sizeof(ChaCha20Poly1305_iv),
+             ChaCha20Poly1305_aad,
+             sizeof(ChaCha20Poly1305_aad),
+             ChaCha20Poly1305_pt,
+             0,
+             ExpectedTag,
+             sizeof(ExpectedTag),
+             OutBuffer,
+             &OutBufferSize
+             );
+  if (!Status || (OutBufferSize != 0)) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+  if (CompareMem (OutTag, ExpectedTag, sizeof(ExpectedTag)) != 0) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+  Print ("[Pass]");
+
+
   Print ("\n- SM4-GCM Encryption: ");
   OutBufferSize = sizeof(OutBuffer);
   OutTagSize = sizeof(Sm4Gcm_tag);
@@ -0,0 +1,122 @@
+/** @file
+  Application for Scratch Arena Validation.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Cryptest.h"
+
+//
+// Max Known Digest Size is SHA512 Output (64 bytes) by far
+//
+#define MAX_DIGEST_SIZE    64
+
+#define SCRATCH_ARENA_SIZE 0x4000
+
+extern CONST CHAR8 *HmacData;
+extern CONST UINT8 HmacSha256Key[20];
+extern CONST UINT8 HmacSha256Digest[];
+
+UINT8  mScratchArena[SCRATCH_ARENA_SIZE];
+
+/**
+  Validate the scratch arena of the crypto backend.
+
+  @retval  EFI_SUCCESS  Validation succeeded.
+  @retval  EFI_ABORTED  Validation failed.
+
+**/
+EFI_STATUS
+ValidateCryptScratchArena (
+  VOID
+  )
+{
+  VOID             *HmacCtx;
+  UINT8            Digest[MAX_DIGEST_SIZE];
+  BOOLEAN          Status;
+  POOL_STATISTICS  Before;
+  POOL_STATISTICS  After;
+
+  Print (" \nUEFI-OpenSSL Scratch Arena Testing:\n");
+
+  Print ("- HMAC-SHA256 in Arena: ");
+  if (!CryptSetScratchArena (mScratchArena, sizeof(mScratchArena), TRUE)) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+
+  ZeroMem (Digest, MAX_DIGEST_SIZE);
+  HmacCtx = HmacSha256New ();
+  if (HmacCtx == NULL) {
+    Print ("[Fail]");
+    CryptSetScratchArena (NULL, 0, FALSE);
+    return EFI_ABORTED;
+  }
+
+  Status = HmacSha256SetKey (HmacCtx, HmacSha256Key, 20);
+  if (Status) {
+    Status = HmacSha256Update (HmacCtx, HmacData, 8);
+  }
+  if (Status) {
+    Status = HmacSha256Final (HmacCtx, Digest);
+  }
+  HmacSha256Free (HmacCtx);
+  if (!Status) {
+    Print ("[Fail]");
+    CryptSetScratchArena (NULL, 0, FALSE);
+    return EFI_ABORTED;
+  }
+
+  Print ("Check Value... ");
+  if (CompareMem (Digest, HmacSha256Digest, SHA256_DIGEST_SIZE) != 0) {
+    Print ("[Fail]");
+    CryptSetScratchArena (NULL, 0, FALSE);
+    return EFI_ABORTED;
+  }
+
+  Print ("Check Peak Size... ");
+  if ((CryptGetScratchArenaPeakSize () == 0) ||
+      (CryptGetScratchArenaPeakSize () > SCRATCH_ARENA_SIZE)) {
+    Print ("[Fail]");
+    CryptSetScratchArena (NULL, 0, FALSE);
+    return EFI_ABORTED;
+  }
+
+  //
+  // In strict mode, an allocation larger than the arena must not fall back to the heap.
+  //
+  Print ("Strict... ");
+  CryptSetScratchArena (mScratchArena, sizeof(UINTN), TRUE);
+  HmacCtx = HmacSha256New ();
+  CryptSetScratchArena (NULL, 0, FALSE);
+  if (HmacCtx != NULL) {
+    Print ("[Fail]");
+    HmacSha256Free (HmacCtx);
+    return EFI_ABORTED;
+  }
+
+  //
+  // The allocations outside of the arena are counted in the pool statistics.
+  //
+  Print ("Pool Statistics... ");
+  GetPoolStatistics (&Before);
+  HmacCtx = HmacSha256New ();
+  if (HmacCtx == NULL) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+  HmacSha256Free (HmacCtx);
+  GetPoolStatistics (&After);
+  if ((After.AllocationCount <= Before.AllocationCount) ||
+      (After.FreeCount - Before.FreeCount != After.AllocationCount - Before.AllocationCount) ||
+      (After.CurrentSize != Before.CurrentSize)) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+
+  Print ("[Pass]\n");
+
+  return EFI_SUCCESS;
+}
@@ -57,6 +57,15 @@ CryptestMain (
   Print ("\nUEFI-OpenSSL Wrapper Cryptosystem Testing: \n");
   Print ("-------------------------------------------- \n");
 
+  //
+  // The scratch arena is validated first, because OpenSSL accepts
+  // the memory functions only before its first allocation.
+  //
+  Status = ValidateCryptScratchArena ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
   RandomSeed (NULL, 0);
 
   Status = ValidateCryptDigest ();
@@ -164,6 +173,11 @@ CryptestMain (
     return Status;
   }
 
+  Status = ValidateCryptEcx ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
   Status = ValidateCryptSm2 ();
   if (EFI_ERROR (Status)) {
     return Status;
@@ -259,6 +259,18 @@ ValidateCryptEd2 (
   VOID
   );
 
+/**
+  Validate UEFI-OpenSSL Montgomery-Curve Interfaces.
+
+  @retval  EFI_SUCCESS  Validation succeeded.
+  @retval  EFI_ABORTED  Validation failed.
+
+**/
+EFI_STATUS
+ValidateCryptEcx (
+  VOID
+  );
+
 /**
   Validate UEFI-OpenSSL Sm2 Interfaces.
 
@@ -307,4 +319,16 @@ ValidateCryptPrng (
   VOID
   );
 
+/**
+  Validate the scratch arena of the crypto backend.
+
+  @retval  EFI_SUCCESS  Validation succeeded.
+  @retval  EFI_ABORTED  Validation failed.
+
+**/
+EFI_STATUS
+ValidateCryptScratchArena (
+  VOID
+  );
+
 #endif
@@ -22,6 +22,7 @@ ValidateCryptEc (
 {
   VOID    *Ec1;
   VOID    *Ec2;
+  VOID    *Prepared;
   UINT8   Public1[66 * 2];
   UINTN   Public1Length;
   UINT8   Public2[66 * 2];
@@ -283,8 +284,39 @@ ValidateCryptEc (
     Print ("[Pass]\n");
   }
 
-  EcFree (Ec1);
+  Print ("- Prepare key in Context2 ... ");
+  Prepared = EcDsaPreparePublicKey (Ec2);
   EcFree (Ec2);
+  if (Prepared == NULL) {
+    Print ("[Fail]");
+    EcFree (Ec1);
+    return EFI_ABORTED;
+  }
+
+  Print ("EC-DSA Verification with prepared key ... ");
+  Status = EcDsaVerifyPrepared (Prepared, CRYPTO_NID_SHA256, HashValue, HashSize, Signature, SigSize);
+  if (!Status) {
+    Print ("[Fail]");
+    EcDsaFreePreparedPublicKey (Prepared);
+    EcFree (Ec1);
+    return EFI_ABORTED;
+  }
+
+  Print ("Altered hash ... ");
+  HashValue[0] ^= 0x1;
+  Status = EcDsaVerifyPrepared (Prepared, CRYPTO_NID_SHA256, HashValue, HashSize, Signature, SigSize);
+  HashValue[0] ^= 0x1;
+  if (Status) {
+    Print ("[Fail]");
+    EcDsaFreePreparedPublicKey (Prepared);
+    EcFree (Ec1);
+    return EFI_ABORTED;
+  } else {
+    Print ("[Pass]\n");
+  }
+
+  EcDsaFreePreparedPublicKey (Prepared);
+  EcFree (Ec1);
 
   return EFI_SUCCESS;
 }
\ No newline at end of file
@@ -43,6 +43,18 @@ GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 EccTestRootCer[]= {
 0x3b, 0x59, 0xec, 0xf5, 0x51, 0xa0, 0xa6, 0x64, 0x6e, 0xe1, 0x44, 0xc7, 0xe1, 0xa2, 0xce, 0x90, 
 0x7f, 0xae, 0xad, 0xf4, 0xa9, 0xfa, };
 
+//
+// Public key of the Root CA X509 Certificate, as a DER-encoded SubjectPublicKeyInfo.
+//
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 EccTestRootPubKeyDer[]= {
+0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01, 0x06, 0x08, 0x2a, 
+0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0x11, 0xa4, 0x06, 0x65, 0xb6, 
+0x79, 0x6e, 0x72, 0xb6, 0xd8, 0x09, 0x84, 0x92, 0x86, 0x11, 0x09, 0xde, 0xea, 0xd0, 0x0c, 0x60, 
+0xf1, 0x8a, 0xff, 0x7c, 0xde, 0xce, 0xec, 0x07, 0xba, 0xa5, 0xb8, 0xd5, 0x17, 0xe5, 0x62, 0x33, 
+0x2d, 0x88, 0xb1, 0x9a, 0xe6, 0xf3, 0x09, 0x43, 0x0e, 0xa9, 0xf7, 0x3c, 0xe9, 0x20, 0xba, 0xbd, 
+0xb1, 0x3c, 0x03, 0x89, 0x1e, 0x2a, 0xff, 0x6e, 0x08, 0xff, 0x2e
+};
+
 
 //
 // PEM Key data for EC Private Key Retrieving.
@@ -89,6 +101,7 @@ ValidateCryptEc2 (
   BOOLEAN Status;
   VOID    *EcPrivKey;
   VOID    *EcPubKey;
+  VOID    *EcDerPubKey;
   UINT8   HashValue[SHA256_DIGEST_SIZE];
   UINTN   HashSize;
   UINT8   Signature[66 * 2];
@@ -139,6 +152,32 @@ ValidateCryptEc2 (
 
   Print ("\n- EC-DSA Verification ... ");
   Status = EcDsaVerify (EcPubKey, CRYPTO_NID_SHA256, HashValue, HashSize, Signature, SigSize);
+  if (!Status) {
+    Print ("[Fail]");
+    EcFree (EcPrivKey);
+    EcFree (EcPubKey);
+    return EFI_ABORTED;
+  } else {
+    Print ("[Pass]");
+  }
+
+  //
+  // Retrieve EC public key from DER-encoded SubjectPublicKeyInfo.
+  //
+  Print ("\n- Retrieve EC Public Key from DER ... ");
+  Status = EcGetPublicKeyFromDer (EccTestRootPubKeyDer, sizeof (EccTestRootPubKeyDer), &EcDerPubKey);
+  if (!Status) {
+    Print ("[Fail]");
+    EcFree (EcPrivKey);
+    EcFree (EcPubKey);
+    return EFI_ABORTED;
+  } else {
+    Print ("[Pass]");
+  }
+
+  Print ("\n- EC-DSA Verification with DER Public Key ... ");
+  Status = EcDsaVerify (EcDerPubKey, CRYPTO_NID_SHA256, HashValue, HashSize, Signature, SigSize);
+  EcFree (EcDerPubKey);
   if (!Status) {
     Print ("[Fail]");
     EcFree (EcPrivKey);
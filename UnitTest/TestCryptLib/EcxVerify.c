@@ -0,0 +1,152 @@
+/** @file
+  Application for Montgomery-Curve Primitives Validation.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Cryptest.h"
+
+/**
+  Validate UEFI-OpenSSL Montgomery-Curve key exchange of one curve.
+
+  @param  Nid          cipher NID, CRYPTO_NID_X25519 or CRYPTO_NID_X448.
+  @param  KeySize      The size in bytes of the public key and the exchanged key.
+
+  @retval  EFI_SUCCESS  Validation succeeded.
+  @retval  EFI_ABORTED  Validation failed.
+
+**/
+EFI_STATUS
+ValidateCryptEcxNid (
+  IN UINTN  Nid,
+  IN UINTN  KeySize
+  )
+{
+  VOID    *Ecx1;
+  VOID    *Ecx2;
+  UINT8   Public1[56];
+  UINTN   Public1Length;
+  UINT8   Public2[56];
+  UINTN   Public2Length;
+  UINT8   Key1[56];
+  UINTN   Key1Length;
+  UINT8   Key2[56];
+  UINTN   Key2Length;
+  UINT8   LowOrderPublic[56];
+  BOOLEAN Status;
+
+  Public1Length  = sizeof (Public1);
+  Public2Length  = sizeof (Public2);
+  Key1Length     = sizeof (Key1);
+  Key2Length     = sizeof (Key2);
+
+  Print ("- Context1 ... ");
+  Ecx1 = EcxNewByNid (Nid);
+  if (Ecx1 == NULL) {
+    Print ("[Fail]");
+    return EFI_ABORTED;
+  }
+
+  Print ("Context2 ... ");
+  Ecx2 = EcxNewByNid (Nid);
+  if (Ecx2 == NULL) {
+    Print ("[Fail]");
+    EcxFree (Ecx1);
+    return EFI_ABORTED;
+  }
+
+  Print ("Generate key1 ... ");
+  Status = EcxGenerateKey (Ecx1, Public1, &Public1Length);
+  if (!Status || Public1Length != KeySize) {
+    Print ("[Fail]");
+    EcxFree (Ecx1);
+    EcxFree (Ecx2);
+    return EFI_ABORTED;
+  }
+
+  Print ("Generate key2 ... ");
+  Status = EcxGenerateKey (Ecx2, Public2, &Public2Length);
+  if (!Status || Public2Length != KeySize) {
+    Print ("[Fail]");
+    EcxFree (Ecx1);
+    EcxFree (Ecx2);
+    return EFI_ABORTED;
+  }
+
+  Print ("Compute key1 ... ");
+  Status = EcxComputeKey (Ecx1, Public2, Public2Length, Key1, &Key1Length);
+  if (!Status) {
+    Print ("[Fail]");
+    EcxFree (Ecx1);
+    EcxFree (Ecx2);
+    return EFI_ABORTED;
+  }
+
+  Print ("Compute key2 ... ");
+  Status = EcxComputeKey (Ecx2, Public1, Public1Length, Key2, &Key2Length);
+  if (!Status) {
+    Print ("[Fail]");
+    EcxFree (Ecx1);
+    EcxFree (Ecx2);
+    return EFI_ABORTED;
+  }
+
+  Print ("Compare Keys ... ");
+  if (Key1Length != KeySize || Key2Length != KeySize ||
+      CompareMem (Key1, Key2, Key1Length) != 0) {
+    Print ("[Fail]");
+    EcxFree (Ecx1);
+    EcxFree (Ecx2);
+    return EFI_ABORTED;
+  }
+
+  //
+  // The point u = 0 is of low order, so the exchanged key is all zero.
+  //
+  Print ("Low Order Public ... ");
+  ZeroMem (LowOrderPublic, sizeof (LowOrderPublic));
+  Key1Length = sizeof (Key1);
+  Status = EcxComputeKey (Ecx1, LowOrderPublic, KeySize, Key1, &Key1Length);
+  if (Status) {
+    Print ("[Fail]");
+    EcxFree (Ecx1);
+    EcxFree (Ecx2);
+    return EFI_ABORTED;
+  }
+  Print ("[Pass]\n");
+
+  EcxFree (Ecx1);
+  EcxFree (Ecx2);
+  return EFI_SUCCESS;
+}
+
+/**
+  Validate UEFI-OpenSSL Montgomery-Curve Interfaces.
+
+  @retval  EFI_SUCCESS  Validation succeeded.
+  @retval  EFI_ABORTED  Validation failed.
+
+**/
+EFI_STATUS
+ValidateCryptEcx (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  Print ("\nUEFI-OpenSSL X25519 Key Exchange Testing:\n");
+  Status = ValidateCryptEcxNid (CRYPTO_NID_X25519, 32);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Print ("\nUEFI-OpenSSL X448 Key Exchange Testing:\n");
+  Status = ValidateCryptEcxNid (CRYPTO_NID_X448, 56);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return EFI_SUCCESS;
+}
@@ -73,6 +73,279 @@ GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 Sm3_256Digest[SHAKE256_DIGEST_SIZE] =
   0x41, 0x67, 0xc4, 0x87, 0x5c, 0xf2, 0xf7, 0xa2, 0x29, 0x7d, 0xa0, 0x2b, 0x8f, 0x4b, 0xa8, 0xe0
 };
 
+//
+// Buffers of the SHA3 multi-buffer tests. Buffer i is Sha3MultiBufferLength[i] bytes of
+// the message pattern, starting at byte i. The lengths are unequal, so that a batch has some
+// whole blocks in common and then a tail of its own in each buffer, including empty and
+// block-sized buffers.
+//
+#define SHA3_MULTI_BUFFER_COUNT    9
+#define SHA3_MULTI_PATTERN_SIZE    1024
+#define SHA3_MULTI_LONGEST_BUFFER  3
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINTN Sha3MultiBufferLength[SHA3_MULTI_BUFFER_COUNT] = {
+  300, 520, 137, 1000, 136, 72, 1, 0, 409
+};
+
+//
+// Results for SHA3-256/384/512 of the buffers, with the message pattern byte j = (j * 7 + 3) & 0xFF.
+//
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 Sha3_256MultiDigest[SHA3_MULTI_BUFFER_COUNT][SHA3_256_DIGEST_SIZE] = {
+  {
+    0x06, 0x4a, 0xf3, 0x40, 0x5a, 0xac, 0xb5, 0x3d, 0x5d, 0x77, 0xee, 0x85, 0x8f, 0xec, 0x1e, 0x6e,
+    0x22, 0x54, 0x80, 0xde, 0x3f, 0x14, 0xf0, 0x64, 0x44, 0xe2, 0xb3, 0x3d, 0x92, 0xd6, 0x18, 0x79,
+  },
+  {
+    0xbe, 0x8f, 0xa1, 0x72, 0xdf, 0x6a, 0x18, 0xe1, 0xba, 0x8b, 0x81, 0x7d, 0xd3, 0x59, 0x33, 0x01,
+    0x0f, 0x8d, 0x77, 0x63, 0x63, 0x67, 0x60, 0xbf, 0x5e, 0xf4, 0x9c, 0xb5, 0xf1, 0x09, 0xed, 0x00,
+  },
+  {
+    0x2a, 0xf0, 0x0e, 0x77, 0x51, 0x40, 0x01, 0xf1, 0x72, 0x58, 0x12, 0x92, 0x0b, 0x82, 0x40, 0xaf,
+    0x3e, 0x22, 0xc2, 0x14, 0x7f, 0x62, 0xfc, 0x62, 0x10, 0xe0, 0x21, 0xa4, 0xe6, 0x3d, 0xba, 0x67,
+  },
+  {
+    0x6f, 0x8d, 0xc8, 0xf2, 0x7d, 0x17, 0x84, 0xec, 0xbe, 0xfb, 0x5a, 0x80, 0xa0, 0x7e, 0x41, 0x45,
+    0xe6, 0x94, 0x03, 0x62, 0x12, 0xae, 0x0d, 0xe2, 0x6c, 0x6d, 0xaf, 0x13, 0x99, 0xc5, 0xed, 0x57,
+  },
+  {
+    0xa9, 0x56, 0x4b, 0x9c, 0xb0, 0x9e, 0x2e, 0x2e, 0x2e, 0xbf, 0x24, 0xd1, 0x69, 0xda, 0x92, 0xb0,
+    0xb8, 0x9f, 0xfe, 0xe6, 0x24, 0xe7, 0x71, 0x75, 0x5e, 0xad, 0xfb, 0xe8, 0x08, 0x83, 0xaa, 0x3b,
+  },
+  {
+    0x67, 0xc7, 0xec, 0xef, 0xcc, 0x87, 0x81, 0xfb, 0x31, 0x03, 0x42, 0x22, 0x17, 0x28, 0x77, 0xb5,
+    0x2a, 0x2e, 0x7d, 0x2d, 0x2a, 0xb1, 0xe7, 0x5b, 0x40, 0xb5, 0xf5, 0x70, 0xff, 0x51, 0x28, 0xbf,
+  },
+  {
+    0xa7, 0x32, 0x7a, 0xa6, 0x27, 0xec, 0x35, 0x66, 0xbe, 0x2a, 0x4a, 0x0c, 0x62, 0xe9, 0xb9, 0x0c,
+    0x33, 0x9b, 0x85, 0xdb, 0xe1, 0x3d, 0x04, 0x97, 0x75, 0x36, 0xd6, 0xba, 0x4c, 0x2d, 0xb8, 0xf6,
+  },
+  {
+    0xa7, 0xff, 0xc6, 0xf8, 0xbf, 0x1e, 0xd7, 0x66, 0x51, 0xc1, 0x47, 0x56, 0xa0, 0x61, 0xd6, 0x62,
+    0xf5, 0x80, 0xff, 0x4d, 0xe4, 0x3b, 0x49, 0xfa, 0x82, 0xd8, 0x0a, 0x4b, 0x80, 0xf8, 0x43, 0x4a,
+  },
+  {
+    0xa7, 0x27, 0xb7, 0x53, 0x34, 0x62, 0x0d, 0xd7, 0xc4, 0xee, 0xa1, 0x6c, 0x67, 0xcf, 0x43, 0x86,
+    0xa5, 0xfb, 0x93, 0x54, 0xc3, 0xff, 0x35, 0x33, 0xcb, 0x48, 0xd7, 0x30, 0xb7, 0xd3, 0x5a, 0x0c,
+  },
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 Sha3_384MultiDigest[SHA3_MULTI_BUFFER_COUNT][SHA3_384_DIGEST_SIZE] = {
+  {
+    0x16, 0x85, 0x76, 0xbf, 0x88, 0x8a, 0x5e, 0xd3, 0xa6, 0x8a, 0x9f, 0x2c, 0xb7, 0x02, 0x53, 0x28,
+    0x06, 0x07, 0xd0, 0x64, 0xd6, 0xe2, 0x60, 0x66, 0xfe, 0xb6, 0x03, 0xaf, 0x08, 0x9d, 0xc7, 0x84,
+    0x92, 0xcd, 0x94, 0xce, 0x47, 0x2e, 0x4a, 0xf3, 0x2d, 0xb9, 0x30, 0x16, 0xbc, 0x7e, 0xbf, 0x89,
+  },
+  {
+    0x0c, 0x51, 0x55, 0x8b, 0x58, 0xf1, 0x67, 0x7a, 0x69, 0x53, 0x87, 0xc0, 0x4d, 0x94, 0x1d, 0xe5,
+    0x57, 0x89, 0x01, 0xc0, 0xdb, 0x07, 0xf1, 0x02, 0xf8, 0x38, 0xe4, 0xd8, 0x00, 0x35, 0x8e, 0xdd,
+    0xf0, 0x72, 0x42, 0x8e, 0xef, 0x5b, 0x2a, 0x52, 0xc6, 0x42, 0xca, 0x1b, 0x12, 0x7e, 0x42, 0xd2,
+  },
+  {
+    0x94, 0x29, 0xed, 0xee, 0xd4, 0xd0, 0x4b, 0xd8, 0x06, 0xe2, 0xb4, 0xea, 0x53, 0xb2, 0x83, 0xde,
+    0x7a, 0x6a, 0x58, 0xf1, 0xa8, 0xb1, 0x94, 0x79, 0x6d, 0xc4, 0x83, 0x3f, 0x3b, 0xea, 0xd7, 0x72,
+    0xc2, 0x7a, 0xc8, 0x58, 0xf4, 0x35, 0x6a, 0x33, 0x00, 0xf8, 0x68, 0x32, 0x91, 0x65, 0x21, 0x14,
+  },
+  {
+    0x7e, 0xa9, 0x06, 0xfe, 0xe4, 0x86, 0x30, 0xf7, 0xbd, 0x33, 0x96, 0x99, 0x56, 0xcd, 0x4a, 0x58,
+    0x90, 0x20, 0xfc, 0x6e, 0x5a, 0xa3, 0xa8, 0x02, 0xd4, 0xa2, 0xfd, 0x18, 0x2e, 0x8e, 0x1c, 0x4a,
+    0x3e, 0x69, 0x65, 0xb7, 0xcc, 0x2f, 0xda, 0x59, 0x2b, 0xd3, 0xca, 0xd7, 0xb3, 0x85, 0x10, 0x0b,
+  },
+  {
+    0x8e, 0xea, 0x0f, 0x1b, 0xae, 0x97, 0x10, 0x76, 0x2d, 0xa7, 0x29, 0x30, 0xb6, 0x14, 0x2d, 0xa1,
+    0xcd, 0x8b, 0xe1, 0x43, 0x7c, 0x85, 0xd3, 0xb4, 0xca, 0xe1, 0x2e, 0x66, 0xce, 0xef, 0xbd, 0x68,
+    0x08, 0xad, 0x2d, 0xad, 0x57, 0xdb, 0x11, 0x20, 0x93, 0x1a, 0x04, 0xa5, 0xf1, 0xa3, 0x8c, 0xf5,
+  },
+  {
+    0x59, 0x77, 0x95, 0x6c, 0xda, 0x97, 0x20, 0xe4, 0xc9, 0xb1, 0xf2, 0xf9, 0x89, 0x6b, 0x18, 0xbc,
+    0xa0, 0x2c, 0x91, 0x02, 0x5b, 0x3b, 0x46, 0x52, 0x22, 0x47, 0x53, 0x08, 0x9c, 0x4c, 0xd5, 0x19,
+    0x1f, 0x34, 0x0c, 0xcb, 0x36, 0xe5, 0x67, 0xe6, 0xdf, 0xea, 0xdd, 0x3e, 0xbb, 0x42, 0x7e, 0x85,
+  },
+  {
+    0x12, 0xbf, 0x8b, 0x05, 0xc0, 0x3c, 0x25, 0x2d, 0x4e, 0x41, 0xdc, 0xa5, 0x9d, 0xa8, 0x46, 0x6f,
+    0x4a, 0x33, 0xeb, 0x95, 0x0c, 0x59, 0x14, 0xe7, 0xa2, 0xcb, 0x38, 0xfd, 0xdb, 0x55, 0xaf, 0x31,
+    0x1c, 0xbf, 0x22, 0x7c, 0x62, 0x32, 0x5e, 0x0e, 0x04, 0x12, 0xb6, 0x90, 0x0e, 0x3a, 0x00, 0xae,
+  },
+  {
+    0x0c, 0x63, 0xa7, 0x5b, 0x84, 0x5e, 0x4f, 0x7d, 0x01, 0x10, 0x7d, 0x85, 0x2e, 0x4c, 0x24, 0x85,
+    0xc5, 0x1a, 0x50, 0xaa, 0xaa, 0x94, 0xfc, 0x61, 0x99, 0x5e, 0x71, 0xbb, 0xee, 0x98, 0x3a, 0x2a,
+    0xc3, 0x71, 0x38, 0x31, 0x26, 0x4a, 0xdb, 0x47, 0xfb, 0x6b, 0xd1, 0xe0, 0x58, 0xd5, 0xf0, 0x04,
+  },
+  {
+    0x6c, 0x54, 0x3a, 0x5c, 0xea, 0x01, 0x49, 0x19, 0xe0, 0x3e, 0xd5, 0xf4, 0xdc, 0x9b, 0x4a, 0x89,
+    0x89, 0x42, 0xda, 0x3c, 0x77, 0x37, 0xa2, 0x62, 0xd7, 0xcb, 0xd3, 0xb8, 0x06, 0xa2, 0xa3, 0x43,
+    0xe7, 0x19, 0x9c, 0x2c, 0x97, 0x39, 0x35, 0x59, 0xb1, 0x6b, 0x98, 0x55, 0xd6, 0x68, 0xe6, 0x54,
+  },
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 Sha3_512MultiDigest[SHA3_MULTI_BUFFER_COUNT][SHA3_512_DIGEST_SIZE] = {
+  {
+    0xf8, 0x5b, 0x76, 0xd4, 0xd2, 0xc9, 0x8f, 0x6e, 0xc8, 0x2f, 0x06, 0x65, 0x11, 0x27, 0xd1, 0x96,
+    0x43, 0xe2, 0xb1, 0x11, 0x74, 0x20, 0xb7, 0x00, 0xc4, 0x2a, 0x8c, 0xdd, 0x55, 0x37, 0x91, 0x52,
+    0xca, 0x39, 0x1d, 0xf7, 0x2e, 0x30, 0x88, 0x6e, 0x70, 0xbe, 0xb5, 0x8c, 0xf2, 0x8c, 0x05, 0xae,
+    0x6b, 0xdb, 0x11, 0x97, 0xa9, 0x15, 0x42, 0xe5, 0x7f, 0xac, 0x33, 0x12, 0x33, 0x24, 0x6b, 0x93,
+  },
+  {
+    0xa0, 0x99, 0x80, 0x96, 0xa2, 0x2d, 0x8e, 0xc3, 0xbe, 0x59, 0x67, 0x7f, 0x3f, 0x3d, 0x29, 0xa8,
+    0x70, 0x3b, 0xe5, 0x10, 0xad, 0xf9, 0xcf, 0x95, 0x94, 0x7b, 0xc8, 0xf2, 0x97, 0xd6, 0xb8, 0xa7,
+    0x3d, 0x9c, 0xfc, 0xb9, 0x88, 0x9d, 0xe5, 0x43, 0xbd, 0xc7, 0xe3, 0x6b, 0xa3, 0xf9, 0xa7, 0x45,
+    0xb7, 0x3c, 0x4d, 0x59, 0x4d, 0xcd, 0x5c, 0x2f, 0x8b, 0x3b, 0x2d, 0xb9, 0xc0, 0xea, 0x70, 0xe7,
+  },
+  {
+    0xc7, 0x34, 0xbd, 0xa4, 0xf8, 0xcd, 0x8c, 0xc5, 0xbd, 0x97, 0xda, 0x74, 0xe4, 0xd9, 0x55, 0x63,
+    0xc5, 0x55, 0xf0, 0x83, 0x8b, 0x4b, 0x5c, 0xd0, 0x3f, 0x02, 0x98, 0x99, 0x5d, 0x45, 0xce, 0xe6,
+    0x06, 0x71, 0x9c, 0x1b, 0xea, 0x20, 0xf0, 0x82, 0x91, 0xf1, 0x1a, 0x1a, 0xed, 0xe4, 0x01, 0x9d,
+    0xa3, 0xeb, 0x7c, 0x8d, 0x50, 0x1c, 0x24, 0x43, 0xba, 0x7f, 0xf2, 0x2a, 0x25, 0x07, 0x0e, 0xb3,
+  },
+  {
+    0xa0, 0x5a, 0x31, 0x42, 0x0f, 0x9f, 0xcb, 0x0a, 0xe4, 0x2f, 0xd8, 0xb2, 0x0d, 0x9e, 0x3c, 0x31,
+    0x8f, 0x7f, 0x04, 0x52, 0xa0, 0xc1, 0xf7, 0xc1, 0x98, 0x8b, 0x91, 0x69, 0xe3, 0x85, 0x10, 0x18,
+    0x82, 0xd3, 0xfb, 0xfc, 0x49, 0xb8, 0xe1, 0x03, 0x27, 0xe1, 0x8a, 0x0b, 0xc7, 0xfb, 0x04, 0xfb,
+    0x57, 0x96, 0x1d, 0x9d, 0xd9, 0x8d, 0xa8, 0xe8, 0x35, 0x43, 0xf3, 0x24, 0x58, 0x3e, 0x9a, 0x74,
+  },
+  {
+    0x25, 0xe9, 0x2c, 0xe3, 0x63, 0x63, 0xf8, 0x09, 0xc5, 0xd1, 0x7b, 0x2d, 0x98, 0x41, 0x4b, 0xe2,
+    0xbf, 0x35, 0xaa, 0x6b, 0x1a, 0xa9, 0x66, 0xaf, 0xb0, 0x0a, 0xe2, 0x13, 0xee, 0x81, 0xb6, 0x46,
+    0x55, 0xf0, 0x37, 0xf1, 0x4d, 0xb0, 0x15, 0x43, 0x37, 0xd2, 0x23, 0x3a, 0x74, 0xa5, 0x43, 0x79,
+    0xb8, 0x92, 0x99, 0xaf, 0x94, 0x4e, 0xda, 0xd5, 0x39, 0xba, 0xef, 0x86, 0x6e, 0x14, 0x45, 0xc1,
+  },
+  {
+    0xf1, 0x51, 0xb8, 0x8d, 0x2e, 0x0e, 0x68, 0x5a, 0x43, 0x0f, 0x11, 0x17, 0x46, 0x4d, 0xb3, 0xe9,
+    0xa3, 0xf4, 0x4b, 0x0e, 0xce, 0x9b, 0x55, 0xa1, 0x07, 0x12, 0x90, 0x9c, 0x49, 0x07, 0x53, 0x93,
+    0xa2, 0xa8, 0xdd, 0x1e, 0xbc, 0xe4, 0xa3, 0xe1, 0x27, 0x27, 0x90, 0x16, 0xea, 0xc9, 0x62, 0x18,
+    0x56, 0x58, 0xba, 0x60, 0xf4, 0xf7, 0x3f, 0xa9, 0xaf, 0xa7, 0x41, 0xaf, 0x85, 0x62, 0x3a, 0x6c,
+  },
+  {
+    0xe2, 0xb3, 0x42, 0x34, 0xe7, 0x32, 0xf0, 0xde, 0x9b, 0x0c, 0x31, 0xfe, 0xac, 0x86, 0x52, 0x3a,
+    0xb5, 0xb0, 0x6d, 0xb7, 0x04, 0x75, 0x58, 0x13, 0x28, 0xd3, 0x54, 0xfe, 0x11, 0x9f, 0x06, 0x02,
+    0x33, 0x76, 0x4c, 0x16, 0xe9, 0x46, 0x0a, 0x52, 0x5d, 0x47, 0x76, 0x83, 0xac, 0xd0, 0xf0, 0x95,
+    0xd4, 0x3c, 0x77, 0x69, 0xf6, 0xd2, 0xa5, 0xa2, 0x82, 0xa2, 0x9d, 0xf4, 0xff, 0x56, 0x3d, 0x2e,
+  },
+  {
+    0xa6, 0x9f, 0x73, 0xcc, 0xa2, 0x3a, 0x9a, 0xc5, 0xc8, 0xb5, 0x67, 0xdc, 0x18, 0x5a, 0x75, 0x6e,
+    0x97, 0xc9, 0x82, 0x16, 0x4f, 0xe2, 0x58, 0x59, 0xe0, 0xd1, 0xdc, 0xc1, 0x47, 0x5c, 0x80, 0xa6,
+    0x15, 0xb2, 0x12, 0x3a, 0xf1, 0xf5, 0xf9, 0x4c, 0x11, 0xe3, 0xe9, 0x40, 0x2c, 0x3a, 0xc5, 0x58,
+    0xf5, 0x00, 0x19, 0x9d, 0x95, 0xb6, 0xd3, 0xe3, 0x01, 0x75, 0x85, 0x86, 0x28, 0x1d, 0xcd, 0x26,
+  },
+  {
+    0xfc, 0x2f, 0x23, 0xc6, 0xee, 0x97, 0x8d, 0x65, 0x3f, 0xe0, 0xf9, 0x8e, 0x87, 0xc0, 0xe6, 0xe7,
+    0x8e, 0x89, 0x77, 0xe5, 0x99, 0x2c, 0x8f, 0x3f, 0xc6, 0x42, 0x0c, 0x15, 0xcf, 0x83, 0xbb, 0x88,
+    0xd7, 0x98, 0xe1, 0x8e, 0xb1, 0xd3, 0xae, 0x4d, 0xa6, 0x04, 0x29, 0x33, 0xa6, 0xd6, 0x17, 0xc8,
+    0x68, 0x67, 0x4d, 0x94, 0xe7, 0x72, 0x87, 0x50, 0xf1, 0x0d, 0x03, 0xd0, 0x28, 0x12, 0xd9, 0x36,
+  },
+};
+
+//
+// The SHA3 functions under the multi-buffer test.
+//
+typedef struct {
+  CONST CHAR8  *Name;
+  UINTN        DigestSize;
+  CONST UINT8  *MultiDigest;
+  UINTN        (EFIAPI *GetContextSize) (VOID);
+  BOOLEAN      (EFIAPI *Init) (VOID *HashContext);
+  BOOLEAN      (EFIAPI *Update) (VOID *HashContext, CONST VOID *Data, UINTN DataSize);
+  BOOLEAN      (EFIAPI *Duplicate) (CONST VOID *HashContext, VOID *NewHashContext);
+  BOOLEAN      (EFIAPI *Final) (VOID *HashContext, UINT8 *HashValue);
+  BOOLEAN      (EFIAPI *HashAllMulti) (UINTN Count, CONST CRYPT_DATA_SEGMENT *Data, UINT8 **HashValue);
+} SHA3_MULTI_TEST;
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST SHA3_MULTI_TEST Sha3MultiTest[] = {
+  {"- SHA3_256 Multi: ", SHA3_256_DIGEST_SIZE, &Sha3_256MultiDigest[0][0], Sha3_256GetContextSize, Sha3_256Init, Sha3_256Update, Sha3_256Duplicate, Sha3_256Final, Sha3_256HashAllMulti},
+  {"- SHA3_384 Multi: ", SHA3_384_DIGEST_SIZE, &Sha3_384MultiDigest[0][0], Sha3_384GetContextSize, Sha3_384Init, Sha3_384Update, Sha3_384Duplicate, Sha3_384Final, Sha3_384HashAllMulti},
+  {"- SHA3_512 Multi: ", SHA3_512_DIGEST_SIZE, &Sha3_512MultiDigest[0][0], Sha3_512GetContextSize, Sha3_512Init, Sha3_512Update, Sha3_512Duplicate, Sha3_512Final, Sha3_512HashAllMulti},
+};
+
+/**
+  Validate a SHA3 HashAllMulti interface with batches of 1 to SHA3_MULTI_BUFFER_COUNT buffers,
+  and the split Update and Duplicate of the same hash over the longest buffer.
+
+  @param  Test     The SHA3 functions under test.
+  @param  Pattern  The message pattern of the buffers.
+
+  @retval  TRUE   Validation succeeded.
+  @retval  FALSE  Validation failed.
+**/
+BOOLEAN
+ValidateSha3Multi (
+  IN CONST SHA3_MULTI_TEST  *Test,
+  IN CONST UINT8            *Pattern
+  )
+{
+  CRYPT_DATA_SEGMENT  Data[SHA3_MULTI_BUFFER_COUNT];
+  UINT8               Digest[SHA3_MULTI_BUFFER_COUNT][MAX_DIGEST_SIZE];
+  UINT8               *HashValue[SHA3_MULTI_BUFFER_COUNT];
+  CONST UINT8         *Message;
+  UINTN               MessageSize;
+  CONST UINT8         *Expected;
+  VOID                *HashCtx;
+  VOID                *NewHashCtx;
+  UINTN               Count;
+  UINTN               Index;
+  BOOLEAN             Status;
+
+  for (Index = 0; Index < SHA3_MULTI_BUFFER_COUNT; Index++) {
+    Data[Index].Buffer = (VOID *)(Pattern + Index);
+    Data[Index].Size = Sha3MultiBufferLength[Index];
+    HashValue[Index] = Digest[Index];
+  }
+
+  //
+  // Every batch size, so that the whole blocks in common shrink down to none as the batch grows.
+  //
+  Print ("HashAllMulti... ");
+  for (Count = 1; Count <= SHA3_MULTI_BUFFER_COUNT; Count++) {
+    ZeroMem (Digest, sizeof(Digest));
+    if (!Test->HashAllMulti (Count, Data, HashValue)) {
+      return FALSE;
+    }
+    for (Index = 0; Index < Count; Index++) {
+      if (CompareMem (Digest[Index], Test->MultiDigest + Index * Test->DigestSize, Test->DigestSize) != 0) {
+        return FALSE;
+      }
+    }
+  }
+
+  //
+  // The longest buffer, hashed with updates that do not end on a block, and duplicated in the middle.
+  //
+  Print ("Update... ");
+  Message = Data[SHA3_MULTI_LONGEST_BUFFER].Buffer;
+  MessageSize = Data[SHA3_MULTI_LONGEST_BUFFER].Size;
+  Expected = Test->MultiDigest + SHA3_MULTI_LONGEST_BUFFER * Test->DigestSize;
+  HashCtx = AllocatePool (Test->GetContextSize ());
+  NewHashCtx = AllocatePool (Test->GetContextSize ());
+  Status = (HashCtx != NULL) && (NewHashCtx != NULL) &&
+           Test->Init (HashCtx) &&
+           Test->Update (HashCtx, Message, 1) &&
+           Test->Update (HashCtx, Message + 1, 135) &&
+           Test->Update (HashCtx, Message + 136, 200);
+  if (Status) {
+    Print ("Duplicate... ");
+    Status = Test->Duplicate (HashCtx, NewHashCtx) &&
+             Test->Update (HashCtx, Message + 336, MessageSize - 336) &&
+             Test->Update (NewHashCtx, Message + 336, 100) &&
+             Test->Update (NewHashCtx, Message + 436, MessageSize - 436);
+  }
+  if (Status) {
+    Print ("Finalize... ");
+    ZeroMem (Digest, sizeof(Digest));
+    Status = Test->Final (HashCtx, Digest[0]) &&
+             Test->Final (NewHashCtx, Digest[1]);
+  }
+  if (Status) {
+    Print ("Check Value... ");
+    Status = (CompareMem (Digest[0], Expected, Test->DigestSize) == 0) &&
+             (CompareMem (Digest[1], Expected, Test->DigestSize) == 0);
+  }
+  if (HashCtx != NULL) {
+    FreePool (HashCtx);
+  }
+  if (NewHashCtx != NULL) {
+    FreePool (NewHashCtx);
+  }
+  return Status;
+}
+
 /**
   Validate UEFI-OpenSSL Digest Interfaces.
 
@@ -90,6 +363,8 @@ ValidateCryptDigest (
   UINTN    DataSize;
   UINT8    Digest[MAX_DIGEST_SIZE];
   BOOLEAN  Status;
+  UINT8    *Pattern;
+  UINTN    Index;
 
   Print (" UEFI-OpenSSL Hash Engine Testing:\n");
   DataSize = AsciiStrLen (HashData);
@@ -409,6 +684,27 @@ ValidateCryptDigest (
     Print ("[Failed]\n");
   }
 
+  //
+  // SHA3 Multi-Buffer Digest Validation
+  //
+  Pattern = AllocatePool (SHA3_MULTI_PATTERN_SIZE);
+  if (Pattern != NULL) {
+    for (Index = 0; Index < SHA3_MULTI_PATTERN_SIZE; Index++) {
+      Pattern[Index] = (UINT8)(Index * 7 + 3);
+    }
+  }
+  for (Index = 0; Index < ARRAY_SIZE (Sha3MultiTest); Index++) {
+    Print ((CHAR8 *)Sha3MultiTest[Index].Name);
+    if ((Pattern != NULL) && ValidateSha3Multi (&Sha3MultiTest[Index], Pattern)) {
+      Print ("[Pass]\n");
+    } else {
+      Print ("[Failed]\n");
+    }
+  }
+  if (Pattern != NULL) {
+    FreePool (Pattern);
+  }
+
   Print ("- SHAKE256: ");
   //
   // SHAKE256 Digest Validation
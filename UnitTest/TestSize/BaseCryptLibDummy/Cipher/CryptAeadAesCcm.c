@@ -52,8 +52,10 @@ AeadAesCcmEncrypt (
   OUT  UINTN        *DataOutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  CopyMem (DataOut, DataIn, DataInSize);
+  *DataOutSize = DataInSize;
+  ZeroMem (TagOut, TagSize);
+  return TRUE;
 }
 
 /**
@@ -98,7 +100,11 @@ AeadAesCcmDecrypt (
   OUT  UINTN        *DataOutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (!DummyAeadCheckTag (Tag, TagSize)) {
+    return FALSE;
+  }
+  CopyMem (DataOut, DataIn, DataInSize);
+  *DataOutSize = DataInSize;
+  return TRUE;
 }
 
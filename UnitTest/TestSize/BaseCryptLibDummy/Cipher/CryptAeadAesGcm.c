@@ -11,6 +11,38 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "InternalCryptLib.h"
 
+/**
+  Check the fixed tag of the dummy AEAD.
+
+  The dummy AEAD copies the data and writes a zero tag, so that a benchmark
+  linked with this library measures the SPDM protocol overhead only.
+
+  @param[in]  Tag      Pointer to the authentication tag.
+  @param[in]  TagSize  Size of the authentication tag in bytes.
+
+  @retval TRUE   The tag is the fixed tag.
+  @retval FALSE  The tag is not the fixed tag.
+
+**/
+BOOLEAN
+DummyAeadCheckTag (
+  IN  CONST UINT8  *Tag,
+  IN  UINTN        TagSize
+  )
+{
+  UINTN  Index;
+
+  if (Tag == NULL && TagSize != 0) {
+    return FALSE;
+  }
+  for (Index = 0; Index < TagSize; Index++) {
+    if (Tag[Index] != 0) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
 /**
   Performs AEAD AES-GCM authenticated encryption on a data buffer and additional authenticated data (AAD).
 
@@ -100,9 +132,354 @@ AeadAesGcmDecrypt (
   OUT  UINTN        *DataOutSize
   )
 {
+  if (!DummyAeadCheckTag (Tag, TagSize)) {
+    return FALSE;
+  }
+  CopyMem (DataOut, DataIn, DataInSize);
+  *DataOutSize = DataInSize;
+  return TRUE;
+}
+
+
+
+/**
+  Allocates and initializes one AEAD AES-GCM context for subsequent use.
+
+  @return  Pointer to the AEAD AES-GCM context that has been initialized.
+           If the allocations fails, AeadAesGcmNew() returns NULL.
+
+**/
+VOID *
+EFIAPI
+AeadAesGcmNew (
+  VOID
+  )
+{
+  return AllocateZeroPool (sizeof(UINTN));
+}
+
+/**
+  Release the specified AEAD AES-GCM context.
+
+  @param[in]  AeadContext  Pointer to the AEAD AES-GCM context to be released.
+
+**/
+VOID
+EFIAPI
+AeadAesGcmFree (
+  IN  VOID  *AeadContext
+  )
+{
+  if (AeadContext != NULL) {
+    FreePool (AeadContext);
+  }
+}
+
+/**
+  Set user-supplied key for subsequent use. It must be done before any
+  calling to AeadAesGcmSeal() or AeadAesGcmOpen().
+
+  If AeadContext is NULL, then return FALSE.
+  KeySize must be 16, 24 or 32, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the AEAD AES-GCM context.
+  @param[in]       Key          Pointer to the user-supplied key.
+  @param[in]       KeySize      Key size in bytes.
+
+  @retval TRUE   The Key is set successfully.
+  @retval FALSE  The Key is set unsuccessfully.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmSetKey (
+  IN OUT  VOID         *AeadContext,
+  IN      CONST UINT8  *Key,
+  IN      UINTN        KeySize
+  )
+{
+  if (AeadContext == NULL || Key == NULL) {
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  Performs AEAD AES-GCM authenticated encryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD AES-GCM context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be encrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD AES-GCM authenticated encryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmSeal (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  OUT  UINT8        *TagOut,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  )
+{
+  CopyMem (DataOut, DataIn, DataInSize);
+  *DataOutSize = DataInSize;
+  ZeroMem (TagOut, TagSize);
+  return TRUE;
+}
+
+/**
+  Performs AEAD AES-GCM authenticated decryption on a data buffer and additional authenticated data (AAD),
+  with the key held in the AEAD AES-GCM context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the decryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD AES-GCM authenticated decryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmOpen (
+  IN OUT VOID       *AeadContext,
+  IN   CONST UINT8  *Iv,
+  IN   UINTN        IvSize,
+  IN   CONST UINT8  *AData,
+  IN   UINTN        ADataSize,
+  IN   CONST UINT8  *DataIn,
+  IN   UINTN        DataInSize,
+  IN   CONST UINT8  *Tag,
+  IN   UINTN        TagSize,
+  OUT  UINT8        *DataOut,
+  OUT  UINTN        *DataOutSize
+  )
+{
+  if (!DummyAeadCheckTag (Tag, TagSize)) {
+    return FALSE;
+  }
   CopyMem (DataOut, DataIn, DataInSize);
   *DataOutSize = DataInSize;
   return TRUE;
 }
 
+/**
+  Performs AEAD AES-GCM authenticated encryption on a list of data segments and additional authenticated data (AAD),
+  with the key held in the AEAD AES-GCM context.
+
+  The segments are encrypted in order, as if they were one contiguous buffer, into DataOut.
+  A segment may only overlap DataOut at the offset where its own cipher text is written.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the list of input data segments to be encrypted.
+  @param[in]   DataInCount Number of entries in DataIn.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[out]  DataOut     Pointer to a buffer that receives the encryption output.
+  @param[out]  DataOutSize Size of the output data buffer in bytes.
+
+  @retval TRUE   AEAD AES-GCM authenticated encryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated encryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmSealSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataIn,
+  IN   UINTN                       DataInCount,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize,
+  OUT  UINT8                       *DataOut,
+  OUT  UINTN                       *DataOutSize
+  )
+{
+  UINTN  Index;
+  UINTN  Offset;
+
+  Offset = 0;
+  for (Index = 0; Index < DataInCount; Index++) {
+    CopyMem (DataOut + Offset, DataIn[Index].Buffer, DataIn[Index].Size);
+    Offset += DataIn[Index].Size;
+  }
+  if (DataOutSize != NULL) {
+    *DataOutSize = Offset;
+  }
+  ZeroMem (TagOut, TagSize);
+  return TRUE;
+}
+
+/**
+  Performs AEAD AES-GCM authenticated decryption on a data buffer and additional authenticated data (AAD)
+  into a list of data segments, with the key held in the AEAD AES-GCM context.
+
+  The plain text is written in order across the segments, which must hold at least DataInSize bytes.
+  If the authentication fails, the plain text written to the segments is zeroed.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   DataIn      Pointer to the input data buffer to be decrypted.
+  @param[in]   DataInSize  Size of the input data buffer in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+  @param[in]   DataOut     Pointer to the list of segments that receive the decryption output.
+  @param[in]   DataOutCount Number of entries in DataOut.
+
+  @retval TRUE   AEAD AES-GCM authenticated decryption succeeded.
+  @retval FALSE  AEAD AES-GCM authenticated decryption failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmOpenSegments (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *DataIn,
+  IN   UINTN                       DataInSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize,
+  IN   CONST CRYPT_DATA_SEGMENT    *DataOut,
+  IN   UINTN                       DataOutCount
+  )
+{
+  UINTN  Index;
+  UINTN  Offset;
+  UINTN  Length;
+
+  if (!DummyAeadCheckTag (Tag, TagSize)) {
+    return FALSE;
+  }
+
+  Offset = 0;
+  for (Index = 0; (Index < DataOutCount) && (Offset < DataInSize); Index++) {
+    Length = MIN (DataOut[Index].Size, DataInSize - Offset);
+    CopyMem (DataOut[Index].Buffer, DataIn + Offset, Length);
+    Offset += Length;
+  }
+  return (BOOLEAN)(Offset == DataInSize);
+}
+
+/**
+  Generates the AEAD AES-GCM authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD AES-GCM context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[out]  TagOut      Pointer to a buffer that receives the authentication tag output.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD AES-GCM authentication tag generation succeeded.
+  @retval FALSE  AEAD AES-GCM authentication tag generation failed.
+
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmMac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  OUT  UINT8                       *TagOut,
+  IN   UINTN                       TagSize
+  )
+{
+  ZeroMem (TagOut, TagSize);
+  return TRUE;
+}
+
+/**
+  Verifies the AEAD AES-GCM authentication tag of additional authenticated data (AAD) only,
+  with the key held in the AEAD AES-GCM context.
+
+  IvSize must be 12, otherwise FALSE is returned.
+  TagSize must be 12, 13, 14, 15, 16, otherwise FALSE is returned.
+  If additional authenticated data verification fails, FALSE is returned.
+
+  @param[in, out]  AeadContext  Pointer to the keyed AEAD AES-GCM context.
+  @param[in]   Iv          Pointer to the IV value.
+  @param[in]   IvSize      Size of the IV value in bytes.
+  @param[in]   AData       Pointer to the additional authenticated data (AAD).
+  @param[in]   ADataSize   Size of the additional authenticated data (AAD) in bytes.
+  @param[in]   Tag         Pointer to a buffer that contains the authentication tag.
+  @param[in]   TagSize     Size of the authentication tag in bytes.
+
+  @retval TRUE   AEAD AES-GCM authentication tag verification succeeded.
+  @retval FALSE  AEAD AES-GCM authentication tag verification failed.
 
+**/
+BOOLEAN
+EFIAPI
+AeadAesGcmVerifyMac (
+  IN OUT VOID                      *AeadContext,
+  IN   CONST UINT8                 *Iv,
+  IN   UINTN                       IvSize,
+  IN   CONST UINT8                 *AData,
+  IN   UINTN                       ADataSize,
+  IN   CONST UINT8                 *Tag,
+  IN   UINTN                       TagSize
+  )
+{
+  return DummyAeadCheckTag (Tag, TagSize);
+}
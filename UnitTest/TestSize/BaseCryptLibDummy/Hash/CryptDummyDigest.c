@@ -0,0 +1,254 @@
+/** @file
+  Dummy digest and key context shared by the dummy hash, HMAC, HKDF, DH, EC and RSA implementations.
+
+  The digest is deterministic and cheap, so that a benchmark linked with this
+  library measures the SPDM protocol overhead only. It is NOT secure.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+
+#define DUMMY_DIGEST_OFFSET_BASIS  0xCBF29CE484222325ull
+#define DUMMY_DIGEST_PRIME         0x00000100000001B3ull
+#define DUMMY_DIGEST_GOLDEN_GAMMA  0x9E3779B97F4A7C15ull
+
+/**
+  Mix one 64-bit word into a dummy digest state.
+
+  @param  State                        The dummy digest state.
+  @param  Word                         The word to be mixed.
+
+  @return the new dummy digest state.
+**/
+STATIC
+UINT64
+DummyDigestMix (
+  IN UINT64  State,
+  IN UINT64  Word
+  )
+{
+  State ^= Word;
+  State *= DUMMY_DIGEST_PRIME;
+  State ^= State >> 29;
+  return State;
+}
+
+/**
+  Initialize a dummy digest context.
+
+  @param  Context                      The dummy digest context.
+**/
+VOID
+DummyDigestInit (
+  OUT DUMMY_DIGEST_CONTEXT  *Context
+  )
+{
+  ZeroMem (Context, sizeof(DUMMY_DIGEST_CONTEXT));
+  Context->State = DUMMY_DIGEST_OFFSET_BASIS;
+}
+
+/**
+  Digest the input data and update a dummy digest context.
+
+  The data is mixed 8 bytes at a time, so the result does not depend on
+  how the data is split between the calls.
+
+  @param  Context                      The dummy digest context.
+  @param  Data                         The data to be digested.
+  @param  DataSize                     Size in bytes of the data.
+**/
+VOID
+DummyDigestUpdate (
+  IN OUT DUMMY_DIGEST_CONTEXT  *Context,
+  IN     CONST VOID            *Data,
+  IN     UINTN                 DataSize
+  )
+{
+  CONST UINT8  *Bytes;
+  UINTN        Used;
+  UINT64       Word;
+
+  Bytes = Data;
+  Used = (UINTN)(Context->Length & (sizeof(Context->Buffer) - 1));
+  Context->Length += DataSize;
+
+  if (Used != 0) {
+    while ((DataSize > 0) && (Used < sizeof(Context->Buffer))) {
+      Context->Buffer[Used++] = *Bytes++;
+      DataSize--;
+    }
+    if (Used < sizeof(Context->Buffer)) {
+      return;
+    }
+    CopyMem (&Word, Context->Buffer, sizeof(Word));
+    Context->State = DummyDigestMix (Context->State, Word);
+  }
+
+  while (DataSize >= sizeof(Word)) {
+    CopyMem (&Word, Bytes, sizeof(Word));
+    Context->State = DummyDigestMix (Context->State, Word);
+    Bytes += sizeof(Word);
+    DataSize -= sizeof(Word);
+  }
+
+  if (DataSize > 0) {
+    CopyMem (Context->Buffer, Bytes, DataSize);
+  }
+}
+
+/**
+  Complete a dummy digest and expand it to the digest size.
+
+  The context is not modified, so the dummy digest may be completed several times.
+
+  @param  Context                      The dummy digest context.
+  @param  DigestSize                   Size in bytes of the digest.
+  @param  Digest                       The digest.
+**/
+VOID
+DummyDigestFinal (
+  IN  CONST DUMMY_DIGEST_CONTEXT  *Context,
+  IN  UINTN                       DigestSize,
+  OUT UINT8                       *Digest
+  )
+{
+  UINT64  State;
+  UINT64  Word;
+  UINTN   Used;
+  UINTN   Size;
+
+  State = Context->State;
+  Used = (UINTN)(Context->Length & (sizeof(Context->Buffer) - 1));
+  if (Used != 0) {
+    Word = 0;
+    CopyMem (&Word, Context->Buffer, Used);
+    State = DummyDigestMix (State, Word);
+  }
+  State = DummyDigestMix (State, Context->Length);
+  State = DummyDigestMix (State, (UINT64)DigestSize);
+
+  //
+  // Expand the state with SplitMix64.
+  //
+  while (DigestSize > 0) {
+    State += DUMMY_DIGEST_GOLDEN_GAMMA;
+    Word = State;
+    Word = (Word ^ (Word >> 30)) * 0xBF58476D1CE4E5B9ull;
+    Word = (Word ^ (Word >> 27)) * 0x94D049BB133111EBull;
+    Word = Word ^ (Word >> 31);
+    Size = (DigestSize < sizeof(Word)) ? DigestSize : sizeof(Word);
+    CopyMem (Digest, &Word, Size);
+    Digest += Size;
+    DigestSize -= Size;
+  }
+}
+
+/**
+  Compute the dummy digest of a data buffer.
+
+  @param  Data                         The data to be digested.
+  @param  DataSize                     Size in bytes of the data.
+  @param  DigestSize                   Size in bytes of the digest.
+  @param  Digest                       The digest.
+**/
+VOID
+DummyDigestAll (
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  IN  UINTN       DigestSize,
+  OUT UINT8       *Digest
+  )
+{
+  DUMMY_DIGEST_CONTEXT  Context;
+
+  DummyDigestInit (&Context);
+  DummyDigestUpdate (&Context, Data, DataSize);
+  DummyDigestFinal (&Context, DigestSize, Digest);
+}
+
+/**
+  Compute the dummy signature of a message hash, or of a message for EdDSA.
+
+  The dummy signature is the dummy digest of the message hash, expanded to the signature size.
+
+  @param  MessageHash                  The message hash.
+  @param  HashSize                     Size in bytes of the message hash.
+  @param  Signature                    The signature.
+  @param  SigSize                      Size in bytes of the signature.
+
+  @retval TRUE                         The dummy signature is computed.
+  @retval FALSE                        A parameter is invalid.
+**/
+BOOLEAN
+DummySign (
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  OUT UINT8        *Signature,
+  IN  UINTN        SigSize
+  )
+{
+  if (MessageHash == NULL || Signature == NULL || SigSize == 0) {
+    return FALSE;
+  }
+  DummyDigestAll (MessageHash, HashSize, SigSize, Signature);
+  return TRUE;
+}
+
+/**
+  Verify the dummy signature of a message hash, or of a message for EdDSA.
+
+  @param  MessageHash                  The message hash.
+  @param  HashSize                     Size in bytes of the message hash.
+  @param  Signature                    The signature.
+  @param  SigSize                      Size in bytes of the signature.
+
+  @retval TRUE                         The signature is the dummy signature of the message hash.
+  @retval FALSE                        The signature is not the dummy signature of the message hash.
+**/
+BOOLEAN
+DummyVerify (
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize
+  )
+{
+  UINT8  Expected[DUMMY_MAX_PUBLIC_SIZE];
+
+  if (MessageHash == NULL || Signature == NULL || SigSize == 0 || SigSize > sizeof(Expected)) {
+    return FALSE;
+  }
+  DummyDigestAll (MessageHash, HashSize, SigSize, Expected);
+  return (BOOLEAN)(CompareMem (Expected, Signature, SigSize) == 0);
+}
+
+/**
+  Allocate a dummy key context.
+
+  @param  Nid                          The NID of the key, or CRYPTO_NID_NULL.
+  @param  PublicSize                   Size in bytes of the public key, or 0.
+
+  @return the dummy key context, or NULL if the allocation fails.
+**/
+VOID *
+DummyKeyNew (
+  IN  UINTN  Nid,
+  IN  UINTN  PublicSize
+  )
+{
+  DUMMY_KEY_CONTEXT  *KeyContext;
+
+  if (PublicSize > DUMMY_MAX_PUBLIC_SIZE) {
+    return NULL;
+  }
+  KeyContext = AllocateZeroPool (sizeof(DUMMY_KEY_CONTEXT));
+  if (KeyContext == NULL) {
+    return NULL;
+  }
+  KeyContext->Nid = Nid;
+  KeyContext->PublicSize = PublicSize;
+  return KeyContext;
+}
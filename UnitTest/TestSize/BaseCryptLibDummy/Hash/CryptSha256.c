@@ -8,6 +8,47 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "InternalCryptLib.h"
 
+/**
+  Allocates one SHA-256 context for subsequent use.
+  The context must be initialized by Sha256Init() before it is used.
+
+  @return  Pointer to the SHA-256 context that has been allocated.
+           If the allocations fails, Sha256New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha256New (
+  VOID
+  )
+{
+  VOID  *Sha256Context;
+
+  Sha256Context = AllocatePool (sizeof(DUMMY_DIGEST_CONTEXT));
+  if (Sha256Context == NULL) {
+    return NULL;
+  }
+  DummyDigestInit (Sha256Context);
+  return Sha256Context;
+}
+
+/**
+  Release the specified SHA-256 context.
+
+  @param[in]  Sha256Context  Pointer to the SHA-256 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha256Free (
+  IN  VOID  *Sha256Context
+  )
+{
+  if (Sha256Context != NULL) {
+    FreePool (Sha256Context);
+  }
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-256 hash operations.
 
@@ -20,8 +61,7 @@ Sha256GetContextSize (
   VOID
   )
 {
-  ASSERT(FALSE);
-  return 0;
+  return sizeof(DUMMY_DIGEST_CONTEXT);
 }
 
 /**
@@ -42,8 +82,11 @@ Sha256Init (
   OUT  VOID  *Sha256Context
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha256Context == NULL) {
+    return FALSE;
+  }
+  DummyDigestInit (Sha256Context);
+  return TRUE;
 }
 
 /**
@@ -66,8 +109,11 @@ Sha256Duplicate (
   OUT  VOID        *NewSha256Context
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha256Context == NULL || NewSha256Context == NULL) {
+    return FALSE;
+  }
+  CopyMem (NewSha256Context, Sha256Context, sizeof(DUMMY_DIGEST_CONTEXT));
+  return TRUE;
 }
 
 /**
@@ -96,8 +142,14 @@ Sha256Update (
   IN      UINTN       DataSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha256Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestUpdate (Sha256Context, Data, DataSize);
+  return TRUE;
 }
 
 /**
@@ -127,8 +179,11 @@ Sha256Final (
   OUT     UINT8  *HashValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha256Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+  DummyDigestFinal (Sha256Context, SHA256_DIGEST_SIZE, HashValue);
+  return TRUE;
 }
 
 /**
@@ -157,6 +212,52 @@ Sha256HashAll (
   OUT  UINT8       *HashValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HashValue == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestAll (Data, DataSize, SHA256_DIGEST_SIZE, HashValue);
+  return TRUE;
+}
+
+/**
+  Computes the SHA-256 message digests of several independent data buffers.
+
+  The result is the same as calling Sha256HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA-256 digest values (32 bytes each).
+
+  @retval TRUE   SHA-256 digest computation succeeded.
+  @retval FALSE  SHA-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha256HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
 }
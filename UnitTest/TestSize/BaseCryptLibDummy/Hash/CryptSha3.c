@@ -0,0 +1,777 @@
+/** @file
+  SHA3-256/384/512 Digest Wrapper Implementation over OpenSSL.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalCryptLib.h"
+
+/**
+  Allocates one SHA3-256 context for subsequent use.
+  The context must be initialized by Sha3_256Init() before it is used.
+
+  @return  Pointer to the SHA3-256 context that has been allocated.
+           If the allocations fails, Sha3_256New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_256New (
+  VOID
+  )
+{
+  VOID  *Sha3_256Context;
+
+  Sha3_256Context = AllocatePool (sizeof(DUMMY_DIGEST_CONTEXT));
+  if (Sha3_256Context == NULL) {
+    return NULL;
+  }
+  DummyDigestInit (Sha3_256Context);
+  return Sha3_256Context;
+}
+
+/**
+  Release the specified SHA3-256 context.
+
+  @param[in]  Sha3_256Context  Pointer to the SHA3-256 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_256Free (
+  IN  VOID  *Sha3_256Context
+  )
+{
+  if (Sha3_256Context != NULL) {
+    FreePool (Sha3_256Context);
+  }
+}
+
+/**
+  Retrieves the size, in bytes, of the context buffer required for SHA-256 hash operations.
+
+  @return  The size, in bytes, of the context buffer required for SHA-256 hash operations.
+
+**/
+UINTN
+EFIAPI
+Sha3_256GetContextSize (
+  VOID
+  )
+{
+  return sizeof(DUMMY_DIGEST_CONTEXT);
+}
+
+/**
+  Initializes user-supplied memory pointed by Sha3_256Context as SHA3-256 hash context for
+  subsequent use.
+
+  If Sha3_256Context is NULL, then return FALSE.
+
+  @param[out]  Sha3_256Context  Pointer to SHA3-256 context being initialized.
+
+  @retval TRUE   SHA3-256 context initialization succeeded.
+  @retval FALSE  SHA3-256 context initialization failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_256Init (
+  OUT  VOID  *Sha3_256Context
+  )
+{
+  if (Sha3_256Context == NULL) {
+    return FALSE;
+  }
+  DummyDigestInit (Sha3_256Context);
+  return TRUE;
+}
+
+/**
+  Makes a copy of an existing SHA3-256 context.
+
+  If Sha3_256Context is NULL, then return FALSE.
+  If NewSha3_256Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in]  Sha3_256Context     Pointer to SHA3-256 context being copied.
+  @param[out] NewSha3_256Context  Pointer to new SHA3-256 context.
+
+  @retval TRUE   SHA3-256 context copy succeeded.
+  @retval FALSE  SHA3-256 context copy failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_256Duplicate (
+  IN   CONST VOID  *Sha3_256Context,
+  OUT  VOID        *NewSha3_256Context
+  )
+{
+  if (Sha3_256Context == NULL || NewSha3_256Context == NULL) {
+    return FALSE;
+  }
+  CopyMem (NewSha3_256Context, Sha3_256Context, sizeof(DUMMY_DIGEST_CONTEXT));
+  return TRUE;
+}
+
+/**
+  Digests the input data and updates SHA3-256 context.
+
+  This function performs SHA3-256 digest on a data buffer of the specified size.
+  It can be called multiple times to compute the digest of long or discontinuous data streams.
+  SHA3-256 context should be already correctly initialized by Sha3_256Init(), and should not be finalized
+  by Sha3_256Final(). Behavior with invalid context is undefined.
+
+  If Sha3_256Context is NULL, then return FALSE.
+
+  @param[in, out]  Sha3_256Context  Pointer to the SHA3-256 context.
+  @param[in]       Data           Pointer to the buffer containing the data to be hashed.
+  @param[in]       DataSize       Size of Data buffer in bytes.
+
+  @retval TRUE   SHA3-256 data digest succeeded.
+  @retval FALSE  SHA3-256 data digest failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_256Update (
+  IN OUT  VOID        *Sha3_256Context,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  if (Sha3_256Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestUpdate (Sha3_256Context, Data, DataSize);
+  return TRUE;
+}
+
+/**
+  Completes computation of the SHA3-256 digest value.
+
+  This function completes SHA3-256 hash computation and retrieves the digest value into
+  the specified memory. After this function has been called, the SHA3-256 context cannot
+  be used again.
+  SHA3-256 context should be already correctly initialized by Sha3_256Init(), and should not be
+  finalized by Sha3_256Final(). Behavior with invalid SHA3-256 context is undefined.
+
+  If Sha3_256Context is NULL, then return FALSE.
+  If HashValue is NULL, then return FALSE.
+
+  @param[in, out]  Sha3_256Context  Pointer to the SHA3-256 context.
+  @param[out]      HashValue      Pointer to a buffer that receives the SHA3-256 digest
+                                  value (256 / 8 bytes).
+
+  @retval TRUE   SHA3-256 digest computation succeeded.
+  @retval FALSE  SHA3-256 digest computation failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_256Final (
+  IN OUT  VOID   *Sha3_256Context,
+  OUT     UINT8  *HashValue
+  )
+{
+  if (Sha3_256Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+  DummyDigestFinal (Sha3_256Context, SHA3_256_DIGEST_SIZE, HashValue);
+  return TRUE;
+}
+
+/**
+  Computes the SHA3-256 message digest of a input data buffer.
+
+  This function performs the SHA3-256 message digest of a given data buffer, and places
+  the digest value into the specified memory.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Data        Pointer to the buffer containing the data to be hashed.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[out]  HashValue   Pointer to a buffer that receives the SHA3-256 digest
+                           value (256 / 8 bytes).
+
+  @retval TRUE   SHA3-256 digest computation succeeded.
+  @retval FALSE  SHA3-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_256HashAll (
+  IN   CONST VOID  *Data,
+  IN   UINTN       DataSize,
+  OUT  UINT8       *HashValue
+  )
+{
+  if (HashValue == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestAll (Data, DataSize, SHA3_256_DIGEST_SIZE, HashValue);
+  return TRUE;
+}
+
+/**
+  Computes the SHA3-256 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_256HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-256 digest values (256 / 8 bytes each).
+
+  @retval TRUE   SHA3-256 digest computation succeeded.
+  @retval FALSE  SHA3-256 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_256HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha3_256HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Allocates one SHA3-384 context for subsequent use.
+  The context must be initialized by Sha3_384Init() before it is used.
+
+  @return  Pointer to the SHA3-384 context that has been allocated.
+           If the allocations fails, Sha3_384New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_384New (
+  VOID
+  )
+{
+  VOID  *Sha3_384Context;
+
+  Sha3_384Context = AllocatePool (sizeof(DUMMY_DIGEST_CONTEXT));
+  if (Sha3_384Context == NULL) {
+    return NULL;
+  }
+  DummyDigestInit (Sha3_384Context);
+  return Sha3_384Context;
+}
+
+/**
+  Release the specified SHA3-384 context.
+
+  @param[in]  Sha3_384Context  Pointer to the SHA3-384 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_384Free (
+  IN  VOID  *Sha3_384Context
+  )
+{
+  if (Sha3_384Context != NULL) {
+    FreePool (Sha3_384Context);
+  }
+}
+
+/**
+  Retrieves the size, in bytes, of the context buffer required for SHA-384 hash operations.
+
+  @return  The size, in bytes, of the context buffer required for SHA-384 hash operations.
+
+**/
+UINTN
+EFIAPI
+Sha3_384GetContextSize (
+  VOID
+  )
+{
+  return sizeof(DUMMY_DIGEST_CONTEXT);
+}
+
+/**
+  Initializes user-supplied memory pointed by Sha3_384Context as SHA3-384 hash context for
+  subsequent use.
+
+  If Sha3_384Context is NULL, then return FALSE.
+
+  @param[out]  Sha3_384Context  Pointer to SHA3-384 context being initialized.
+
+  @retval TRUE   SHA3-384 context initialization succeeded.
+  @retval FALSE  SHA3-384 context initialization failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_384Init (
+  OUT  VOID  *Sha3_384Context
+  )
+{
+  if (Sha3_384Context == NULL) {
+    return FALSE;
+  }
+  DummyDigestInit (Sha3_384Context);
+  return TRUE;
+}
+
+/**
+  Makes a copy of an existing SHA3-384 context.
+
+  If Sha3_384Context is NULL, then return FALSE.
+  If NewSha3_384Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in]  Sha3_384Context     Pointer to SHA3-384 context being copied.
+  @param[out] NewSha3_384Context  Pointer to new SHA3-384 context.
+
+  @retval TRUE   SHA3-384 context copy succeeded.
+  @retval FALSE  SHA3-384 context copy failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_384Duplicate (
+  IN   CONST VOID  *Sha3_384Context,
+  OUT  VOID        *NewSha3_384Context
+  )
+{
+  if (Sha3_384Context == NULL || NewSha3_384Context == NULL) {
+    return FALSE;
+  }
+  CopyMem (NewSha3_384Context, Sha3_384Context, sizeof(DUMMY_DIGEST_CONTEXT));
+  return TRUE;
+}
+
+/**
+  Digests the input data and updates SHA3-384 context.
+
+  This function performs SHA3-384 digest on a data buffer of the specified size.
+  It can be called multiple times to compute the digest of long or discontinuous data streams.
+  SHA3-384 context should be already correctly initialized by Sha3_384Init(), and should not be finalized
+  by Sha3_384Final(). Behavior with invalid context is undefined.
+
+  If Sha3_384Context is NULL, then return FALSE.
+
+  @param[in, out]  Sha3_384Context  Pointer to the SHA3-384 context.
+  @param[in]       Data           Pointer to the buffer containing the data to be hashed.
+  @param[in]       DataSize       Size of Data buffer in bytes.
+
+  @retval TRUE   SHA3-384 data digest succeeded.
+  @retval FALSE  SHA3-384 data digest failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_384Update (
+  IN OUT  VOID        *Sha3_384Context,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  if (Sha3_384Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestUpdate (Sha3_384Context, Data, DataSize);
+  return TRUE;
+}
+
+/**
+  Completes computation of the SHA3-384 digest value.
+
+  This function completes SHA3-384 hash computation and retrieves the digest value into
+  the specified memory. After this function has been called, the SHA3-384 context cannot
+  be used again.
+  SHA3-384 context should be already correctly initialized by Sha3_384Init(), and should not be
+  finalized by Sha3_384Final(). Behavior with invalid SHA3-384 context is undefined.
+
+  If Sha3_384Context is NULL, then return FALSE.
+  If HashValue is NULL, then return FALSE.
+
+  @param[in, out]  Sha3_384Context  Pointer to the SHA3-384 context.
+  @param[out]      HashValue      Pointer to a buffer that receives the SHA3-384 digest
+                                  value (384 / 8 bytes).
+
+  @retval TRUE   SHA3-384 digest computation succeeded.
+  @retval FALSE  SHA3-384 digest computation failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_384Final (
+  IN OUT  VOID   *Sha3_384Context,
+  OUT     UINT8  *HashValue
+  )
+{
+  if (Sha3_384Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+  DummyDigestFinal (Sha3_384Context, SHA3_384_DIGEST_SIZE, HashValue);
+  return TRUE;
+}
+
+/**
+  Computes the SHA3-384 message digest of a input data buffer.
+
+  This function performs the SHA3-384 message digest of a given data buffer, and places
+  the digest value into the specified memory.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Data        Pointer to the buffer containing the data to be hashed.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[out]  HashValue   Pointer to a buffer that receives the SHA3-384 digest
+                           value (384 / 8 bytes).
+
+  @retval TRUE   SHA3-384 digest computation succeeded.
+  @retval FALSE  SHA3-384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_384HashAll (
+  IN   CONST VOID  *Data,
+  IN   UINTN       DataSize,
+  OUT  UINT8       *HashValue
+  )
+{
+  if (HashValue == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestAll (Data, DataSize, SHA3_384_DIGEST_SIZE, HashValue);
+  return TRUE;
+}
+
+/**
+  Computes the SHA3-384 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_384HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-384 digest values (384 / 8 bytes each).
+
+  @retval TRUE   SHA3-384 digest computation succeeded.
+  @retval FALSE  SHA3-384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_384HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha3_384HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Allocates one SHA3-512 context for subsequent use.
+  The context must be initialized by Sha3_512Init() before it is used.
+
+  @return  Pointer to the SHA3-512 context that has been allocated.
+           If the allocations fails, Sha3_512New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha3_512New (
+  VOID
+  )
+{
+  VOID  *Sha3_512Context;
+
+  Sha3_512Context = AllocatePool (sizeof(DUMMY_DIGEST_CONTEXT));
+  if (Sha3_512Context == NULL) {
+    return NULL;
+  }
+  DummyDigestInit (Sha3_512Context);
+  return Sha3_512Context;
+}
+
+/**
+  Release the specified SHA3-512 context.
+
+  @param[in]  Sha3_512Context  Pointer to the SHA3-512 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha3_512Free (
+  IN  VOID  *Sha3_512Context
+  )
+{
+  if (Sha3_512Context != NULL) {
+    FreePool (Sha3_512Context);
+  }
+}
+
+/**
+  Retrieves the size, in bytes, of the context buffer required for SHA3-512 hash operations.
+
+  @return  The size, in bytes, of the context buffer required for SHA3-512 hash operations.
+
+**/
+UINTN
+EFIAPI
+Sha3_512GetContextSize (
+  VOID
+  )
+{
+  return sizeof(DUMMY_DIGEST_CONTEXT);
+}
+
+/**
+  Initializes user-supplied memory pointed by Sha3_512Context as SHA3-512 hash context for
+  subsequent use.
+
+  If Sha3_512Context is NULL, then return FALSE.
+
+  @param[out]  Sha3_512Context  Pointer to SHA3-512 context being initialized.
+
+  @retval TRUE   SHA3-512 context initialization succeeded.
+  @retval FALSE  SHA3-512 context initialization failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_512Init (
+  OUT  VOID  *Sha3_512Context
+  )
+{
+  if (Sha3_512Context == NULL) {
+    return FALSE;
+  }
+  DummyDigestInit (Sha3_512Context);
+  return TRUE;
+}
+
+/**
+  Makes a copy of an existing SHA3-512 context.
+
+  If Sha3_512Context is NULL, then return FALSE.
+  If NewSha3_512Context is NULL, then return FALSE.
+  If this interface is not supported, then return FALSE.
+
+  @param[in]  Sha3_512Context     Pointer to SHA3-512 context being copied.
+  @param[out] NewSha3_512Context  Pointer to new SHA3-512 context.
+
+  @retval TRUE   SHA3-512 context copy succeeded.
+  @retval FALSE  SHA3-512 context copy failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_512Duplicate (
+  IN   CONST VOID  *Sha3_512Context,
+  OUT  VOID        *NewSha3_512Context
+  )
+{
+  if (Sha3_512Context == NULL || NewSha3_512Context == NULL) {
+    return FALSE;
+  }
+  CopyMem (NewSha3_512Context, Sha3_512Context, sizeof(DUMMY_DIGEST_CONTEXT));
+  return TRUE;
+}
+
+/**
+  Digests the input data and updates SHA3-512 context.
+
+  This function performs SHA3-512 digest on a data buffer of the specified size.
+  It can be called multiple times to compute the digest of long or discontinuous data streams.
+  SHA3-512 context should be already correctly initialized by Sha3_512Init(), and should not be finalized
+  by Sha3_512Final(). Behavior with invalid context is undefined.
+
+  If Sha3_512Context is NULL, then return FALSE.
+
+  @param[in, out]  Sha3_512Context  Pointer to the SHA3-512 context.
+  @param[in]       Data           Pointer to the buffer containing the data to be hashed.
+  @param[in]       DataSize       Size of Data buffer in bytes.
+
+  @retval TRUE   SHA3-512 data digest succeeded.
+  @retval FALSE  SHA3-512 data digest failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_512Update (
+  IN OUT  VOID        *Sha3_512Context,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  )
+{
+  if (Sha3_512Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestUpdate (Sha3_512Context, Data, DataSize);
+  return TRUE;
+}
+
+/**
+  Completes computation of the SHA3-512 digest value.
+
+  This function completes SHA3-512 hash computation and retrieves the digest value into
+  the specified memory. After this function has been called, the SHA3-512 context cannot
+  be used again.
+  SHA3-512 context should be already correctly initialized by Sha3_512Init(), and should not be
+  finalized by Sha3_512Final(). Behavior with invalid SHA3-512 context is undefined.
+
+  If Sha3_512Context is NULL, then return FALSE.
+  If HashValue is NULL, then return FALSE.
+
+  @param[in, out]  Sha3_512Context  Pointer to the SHA3-512 context.
+  @param[out]      HashValue      Pointer to a buffer that receives the SHA3-512 digest
+                                  value (512 / 8 bytes).
+
+  @retval TRUE   SHA3-512 digest computation succeeded.
+  @retval FALSE  SHA3-512 digest computation failed.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_512Final (
+  IN OUT  VOID   *Sha3_512Context,
+  OUT     UINT8  *HashValue
+  )
+{
+  if (Sha3_512Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+  DummyDigestFinal (Sha3_512Context, SHA3_512_DIGEST_SIZE, HashValue);
+  return TRUE;
+}
+
+/**
+  Computes the SHA3-512 message digest of a input data buffer.
+
+  This function performs the SHA3-512 message digest of a given data buffer, and places
+  the digest value into the specified memory.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Data        Pointer to the buffer containing the data to be hashed.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[out]  HashValue   Pointer to a buffer that receives the SHA3-512 digest
+                           value (512 / 8 bytes).
+
+  @retval TRUE   SHA3-512 digest computation succeeded.
+  @retval FALSE  SHA3-512 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_512HashAll (
+  IN   CONST VOID  *Data,
+  IN   UINTN       DataSize,
+  OUT  UINT8       *HashValue
+  )
+{
+  if (HashValue == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestAll (Data, DataSize, SHA3_512_DIGEST_SIZE, HashValue);
+  return TRUE;
+}
+
+/**
+  Computes the SHA3-512 message digests of several independent data buffers.
+
+  The result is the same as calling Sha3_512HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA3-512 digest values (512 / 8 bytes each).
+
+  @retval TRUE   SHA3-512 digest computation succeeded.
+  @retval FALSE  SHA3-512 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha3_512HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha3_512HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
@@ -8,6 +8,47 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "InternalCryptLib.h"
 
+/**
+  Allocates one SHA-384 context for subsequent use.
+  The context must be initialized by Sha384Init() before it is used.
+
+  @return  Pointer to the SHA-384 context that has been allocated.
+           If the allocations fails, Sha384New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha384New (
+  VOID
+  )
+{
+  VOID  *Sha384Context;
+
+  Sha384Context = AllocatePool (sizeof(DUMMY_DIGEST_CONTEXT));
+  if (Sha384Context == NULL) {
+    return NULL;
+  }
+  DummyDigestInit (Sha384Context);
+  return Sha384Context;
+}
+
+/**
+  Release the specified SHA-384 context.
+
+  @param[in]  Sha384Context  Pointer to the SHA-384 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha384Free (
+  IN  VOID  *Sha384Context
+  )
+{
+  if (Sha384Context != NULL) {
+    FreePool (Sha384Context);
+  }
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for SHA-384 hash operations.
 
@@ -20,8 +61,7 @@ Sha384GetContextSize (
   VOID
   )
 {
-  ASSERT(FALSE);
-  return 0;
+  return sizeof(DUMMY_DIGEST_CONTEXT);
 }
 
 /**
@@ -42,8 +82,11 @@ Sha384Init (
   OUT  VOID  *Sha384Context
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha384Context == NULL) {
+    return FALSE;
+  }
+  DummyDigestInit (Sha384Context);
+  return TRUE;
 }
 
 /**
@@ -68,8 +111,11 @@ Sha384Duplicate (
   OUT  VOID        *NewSha384Context
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha384Context == NULL || NewSha384Context == NULL) {
+    return FALSE;
+  }
+  CopyMem (NewSha384Context, Sha384Context, sizeof(DUMMY_DIGEST_CONTEXT));
+  return TRUE;
 }
 
 /**
@@ -98,8 +144,14 @@ Sha384Update (
   IN      UINTN       DataSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha384Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestUpdate (Sha384Context, Data, DataSize);
+  return TRUE;
 }
 
 /**
@@ -129,8 +181,11 @@ Sha384Final (
   OUT     UINT8  *HashValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha384Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+  DummyDigestFinal (Sha384Context, SHA384_DIGEST_SIZE, HashValue);
+  return TRUE;
 }
 
 /**
@@ -159,8 +214,95 @@ Sha384HashAll (
   OUT  UINT8       *HashValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HashValue == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestAll (Data, DataSize, SHA384_DIGEST_SIZE, HashValue);
+  return TRUE;
+}
+
+/**
+  Computes the SHA-384 message digests of several independent data buffers.
+
+  The result is the same as calling Sha384HashAll() on each buffer. Backends
+  with a multi-buffer implementation hash several buffers at once.
+
+  If this interface is not supported, then return FALSE.
+
+  @param[in]   Count       Number of data buffers.
+  @param[in]   Data        Array of Count data buffers to be hashed.
+  @param[in]   HashValue   Array of Count pointers to buffers that receive the
+                           SHA-384 digest values (48 bytes each).
+
+  @retval TRUE   SHA-384 digest computation succeeded.
+  @retval FALSE  SHA-384 digest computation failed.
+  @retval FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+Sha384HashAllMulti (
+  IN   UINTN                     Count,
+  IN   CONST CRYPT_DATA_SEGMENT  *Data,
+  IN   UINT8                     **HashValue
+  )
+{
+  UINTN  Index;
+
+  if (Count != 0 && (Data == NULL || HashValue == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (!Sha384HashAll (Data[Index].Buffer, Data[Index].Size, HashValue[Index])) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Allocates one SHA-512 context for subsequent use.
+  The context must be initialized by Sha512Init() before it is used.
+
+  @return  Pointer to the SHA-512 context that has been allocated.
+           If the allocations fails, Sha512New() returns NULL.
+
+**/
+VOID *
+EFIAPI
+Sha512New (
+  VOID
+  )
+{
+  VOID  *Sha512Context;
+
+  Sha512Context = AllocatePool (sizeof(DUMMY_DIGEST_CONTEXT));
+  if (Sha512Context == NULL) {
+    return NULL;
+  }
+  DummyDigestInit (Sha512Context);
+  return Sha512Context;
+}
+
+/**
+  Release the specified SHA-512 context.
+
+  @param[in]  Sha512Context  Pointer to the SHA-512 context to be released.
+
+**/
+VOID
+EFIAPI
+Sha512Free (
+  IN  VOID  *Sha512Context
+  )
+{
+  if (Sha512Context != NULL) {
+    FreePool (Sha512Context);
+  }
 }
 
 /**
@@ -175,8 +317,7 @@ Sha512GetContextSize (
   VOID
   )
 {
-  ASSERT(FALSE);
-  return 0;
+  return sizeof(DUMMY_DIGEST_CONTEXT);
 }
 
 /**
@@ -197,8 +338,11 @@ Sha512Init (
   OUT  VOID  *Sha512Context
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha512Context == NULL) {
+    return FALSE;
+  }
+  DummyDigestInit (Sha512Context);
+  return TRUE;
 }
 
 /**
@@ -223,8 +367,11 @@ Sha512Duplicate (
   OUT  VOID        *NewSha512Context
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha512Context == NULL || NewSha512Context == NULL) {
+    return FALSE;
+  }
+  CopyMem (NewSha512Context, Sha512Context, sizeof(DUMMY_DIGEST_CONTEXT));
+  return TRUE;
 }
 
 /**
@@ -253,8 +400,14 @@ Sha512Update (
   IN      UINTN       DataSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha512Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestUpdate (Sha512Context, Data, DataSize);
+  return TRUE;
 }
 
 /**
@@ -284,8 +437,11 @@ Sha512Final (
   OUT     UINT8  *HashValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (Sha512Context == NULL || HashValue == NULL) {
+    return FALSE;
+  }
+  DummyDigestFinal (Sha512Context, SHA512_DIGEST_SIZE, HashValue);
+  return TRUE;
 }
 
 /**
@@ -314,6 +470,12 @@ Sha512HashAll (
   OUT  UINT8       *HashValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HashValue == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestAll (Data, DataSize, SHA512_DIGEST_SIZE, HashValue);
+  return TRUE;
 }
@@ -21,8 +21,14 @@ HmacSha256New (
   VOID
   )
 {
-  ASSERT(FALSE);
-  return NULL;
+  VOID  *HmacSha256Ctx;
+
+  HmacSha256Ctx = AllocatePool (sizeof(DUMMY_DIGEST_CONTEXT));
+  if (HmacSha256Ctx == NULL) {
+    return NULL;
+  }
+  DummyDigestInit (HmacSha256Ctx);
+  return HmacSha256Ctx;
 }
 
 /**
@@ -37,7 +43,9 @@ HmacSha256Free (
   IN  VOID  *HmacSha256Ctx
   )
 {
-  ASSERT(FALSE);
+  if (HmacSha256Ctx != NULL) {
+    FreePool (HmacSha256Ctx);
+  }
 }
 
 /**
@@ -62,8 +70,18 @@ HmacSha256SetKey (
   IN   UINTN        KeySize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha256Context == NULL) {
+    return FALSE;
+  }
+  if (Key == NULL && KeySize != 0) {
+    return FALSE;
+  }
+  //
+  // The key seeds the dummy digest.
+  //
+  DummyDigestInit (HmacSha256Context);
+  DummyDigestUpdate (HmacSha256Context, Key, KeySize);
+  return TRUE;
 }
 
 /**
@@ -86,8 +104,11 @@ HmacSha256Duplicate (
   OUT  VOID        *NewHmacSha256Context
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha256Context == NULL || NewHmacSha256Context == NULL) {
+    return FALSE;
+  }
+  CopyMem (NewHmacSha256Context, HmacSha256Context, sizeof(DUMMY_DIGEST_CONTEXT));
+  return TRUE;
 }
 
 /**
@@ -116,8 +137,14 @@ HmacSha256Update (
   IN      UINTN       DataSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha256Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestUpdate (HmacSha256Context, Data, DataSize);
+  return TRUE;
 }
 
 /**
@@ -147,8 +174,11 @@ HmacSha256Final (
   OUT     UINT8  *HmacValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha256Context == NULL || HmacValue == NULL) {
+    return FALSE;
+  }
+  DummyDigestFinal (HmacSha256Context, SHA256_DIGEST_SIZE, HmacValue);
+  return TRUE;
 }
 
 /**
@@ -181,8 +211,19 @@ HmacSha256All (
   OUT  UINT8       *HmacValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_DIGEST_CONTEXT  Context;
+
+  if (HmacValue == NULL) {
+    return FALSE;
+  }
+  if ((Data == NULL && DataSize != 0) || (Key == NULL && KeySize != 0)) {
+    return FALSE;
+  }
+  DummyDigestInit (&Context);
+  DummyDigestUpdate (&Context, Key, KeySize);
+  DummyDigestUpdate (&Context, Data, DataSize);
+  DummyDigestFinal (&Context, SHA256_DIGEST_SIZE, HmacValue);
+  return TRUE;
 }
 
 /**
@@ -198,8 +239,14 @@ HmacSha384New (
   VOID
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  VOID  *HmacSha384Ctx;
+
+  HmacSha384Ctx = AllocatePool (sizeof(DUMMY_DIGEST_CONTEXT));
+  if (HmacSha384Ctx == NULL) {
+    return NULL;
+  }
+  DummyDigestInit (HmacSha384Ctx);
+  return HmacSha384Ctx;
 }
 
 /**
@@ -214,7 +261,9 @@ HmacSha384Free (
   IN  VOID  *HmacSha384Ctx
   )
 {
-  ASSERT(FALSE);
+  if (HmacSha384Ctx != NULL) {
+    FreePool (HmacSha384Ctx);
+  }
 }
 
 /**
@@ -241,8 +290,18 @@ HmacSha384SetKey (
   IN   UINTN        KeySize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha384Context == NULL) {
+    return FALSE;
+  }
+  if (Key == NULL && KeySize != 0) {
+    return FALSE;
+  }
+  //
+  // The key seeds the dummy digest.
+  //
+  DummyDigestInit (HmacSha384Context);
+  DummyDigestUpdate (HmacSha384Context, Key, KeySize);
+  return TRUE;
 }
 
 /**
@@ -267,8 +326,11 @@ HmacSha384Duplicate (
   OUT  VOID        *NewHmacSha384Context
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha384Context == NULL || NewHmacSha384Context == NULL) {
+    return FALSE;
+  }
+  CopyMem (NewHmacSha384Context, HmacSha384Context, sizeof(DUMMY_DIGEST_CONTEXT));
+  return TRUE;
 }
 
 /**
@@ -299,8 +361,14 @@ HmacSha384Update (
   IN      UINTN       DataSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha384Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestUpdate (HmacSha384Context, Data, DataSize);
+  return TRUE;
 }
 
 /**
@@ -332,8 +400,11 @@ HmacSha384Final (
   OUT     UINT8  *HmacValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha384Context == NULL || HmacValue == NULL) {
+    return FALSE;
+  }
+  DummyDigestFinal (HmacSha384Context, SHA384_DIGEST_SIZE, HmacValue);
+  return TRUE;
 }
 
 /**
@@ -366,8 +437,19 @@ HmacSha384All (
   OUT  UINT8        *HmacValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_DIGEST_CONTEXT  Context;
+
+  if (HmacValue == NULL) {
+    return FALSE;
+  }
+  if ((Data == NULL && DataSize != 0) || (Key == NULL && KeySize != 0)) {
+    return FALSE;
+  }
+  DummyDigestInit (&Context);
+  DummyDigestUpdate (&Context, Key, KeySize);
+  DummyDigestUpdate (&Context, Data, DataSize);
+  DummyDigestFinal (&Context, SHA384_DIGEST_SIZE, HmacValue);
+  return TRUE;
 }
 
 /**
@@ -383,8 +465,14 @@ HmacSha512New (
   VOID
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  VOID  *HmacSha512Ctx;
+
+  HmacSha512Ctx = AllocatePool (sizeof(DUMMY_DIGEST_CONTEXT));
+  if (HmacSha512Ctx == NULL) {
+    return NULL;
+  }
+  DummyDigestInit (HmacSha512Ctx);
+  return HmacSha512Ctx;
 }
 
 /**
@@ -399,7 +487,9 @@ HmacSha512Free (
   IN  VOID  *HmacSha512Ctx
   )
 {
-  ASSERT(FALSE);
+  if (HmacSha512Ctx != NULL) {
+    FreePool (HmacSha512Ctx);
+  }
 }
 
 /**
@@ -426,8 +516,18 @@ HmacSha512SetKey (
   IN   UINTN        KeySize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha512Context == NULL) {
+    return FALSE;
+  }
+  if (Key == NULL && KeySize != 0) {
+    return FALSE;
+  }
+  //
+  // The key seeds the dummy digest.
+  //
+  DummyDigestInit (HmacSha512Context);
+  DummyDigestUpdate (HmacSha512Context, Key, KeySize);
+  return TRUE;
 }
 
 /**
@@ -452,8 +552,11 @@ HmacSha512Duplicate (
   OUT  VOID        *NewHmacSha512Context
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha512Context == NULL || NewHmacSha512Context == NULL) {
+    return FALSE;
+  }
+  CopyMem (NewHmacSha512Context, HmacSha512Context, sizeof(DUMMY_DIGEST_CONTEXT));
+  return TRUE;
 }
 
 /**
@@ -484,8 +587,14 @@ HmacSha512Update (
   IN      UINTN       DataSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha512Context == NULL) {
+    return FALSE;
+  }
+  if (Data == NULL && DataSize != 0) {
+    return FALSE;
+  }
+  DummyDigestUpdate (HmacSha512Context, Data, DataSize);
+  return TRUE;
 }
 
 /**
@@ -517,8 +626,11 @@ HmacSha512Final (
   OUT     UINT8  *HmacValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (HmacSha512Context == NULL || HmacValue == NULL) {
+    return FALSE;
+  }
+  DummyDigestFinal (HmacSha512Context, SHA512_DIGEST_SIZE, HmacValue);
+  return TRUE;
 }
 
 /**
@@ -551,6 +663,17 @@ HmacSha512All (
   OUT  UINT8        *HmacValue
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_DIGEST_CONTEXT  Context;
+
+  if (HmacValue == NULL) {
+    return FALSE;
+  }
+  if ((Data == NULL && DataSize != 0) || (Key == NULL && KeySize != 0)) {
+    return FALSE;
+  }
+  DummyDigestInit (&Context);
+  DummyDigestUpdate (&Context, Key, KeySize);
+  DummyDigestUpdate (&Context, Data, DataSize);
+  DummyDigestFinal (&Context, SHA512_DIGEST_SIZE, HmacValue);
+  return TRUE;
 }
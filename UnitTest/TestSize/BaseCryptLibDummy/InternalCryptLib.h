@@ -12,8 +12,153 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Base.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/BaseCryptLib.h>
 
 typedef UINTN size_t;
 
+//
+// The dummy digest replaces SHA, HMAC, HKDF and the signatures.
+// It is deterministic and cheap, and NOT secure.
+//
+typedef struct {
+  UINT64  State;
+  UINT64  Length;
+  UINT8   Buffer[8];
+} DUMMY_DIGEST_CONTEXT;
+
+//
+// The dummy key context of the DHE, RSA and EC functions.
+// The dummy key exchange derives the shared secret from both public keys only.
+//
+#define DUMMY_MAX_PUBLIC_SIZE  512
+
+typedef struct {
+  UINTN   Nid;
+  UINTN   PublicSize;
+  UINT8   Public[DUMMY_MAX_PUBLIC_SIZE];
+} DUMMY_KEY_CONTEXT;
+
+/**
+  Initialize a dummy digest context.
+
+  @param  Context                      The dummy digest context.
+**/
+VOID
+DummyDigestInit (
+  OUT DUMMY_DIGEST_CONTEXT  *Context
+  );
+
+/**
+  Digest the input data and update a dummy digest context.
+
+  @param  Context                      The dummy digest context.
+  @param  Data                         The data to be digested.
+  @param  DataSize                     Size in bytes of the data.
+**/
+VOID
+DummyDigestUpdate (
+  IN OUT DUMMY_DIGEST_CONTEXT  *Context,
+  IN     CONST VOID            *Data,
+  IN     UINTN                 DataSize
+  );
+
+/**
+  Complete a dummy digest and expand it to the digest size.
+
+  @param  Context                      The dummy digest context.
+  @param  DigestSize                   Size in bytes of the digest.
+  @param  Digest                       The digest.
+**/
+VOID
+DummyDigestFinal (
+  IN  CONST DUMMY_DIGEST_CONTEXT  *Context,
+  IN  UINTN                       DigestSize,
+  OUT UINT8                       *Digest
+  );
+
+/**
+  Compute the dummy digest of a data buffer.
+
+  @param  Data                         The data to be digested.
+  @param  DataSize                     Size in bytes of the data.
+  @param  DigestSize                   Size in bytes of the digest.
+  @param  Digest                       The digest.
+**/
+VOID
+DummyDigestAll (
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  IN  UINTN       DigestSize,
+  OUT UINT8       *Digest
+  );
+
+/**
+  Check the fixed tag of the dummy AEAD.
+
+  @param[in]  Tag      Pointer to the authentication tag.
+  @param[in]  TagSize  Size of the authentication tag in bytes.
+
+  @retval TRUE   The tag is the fixed tag.
+  @retval FALSE  The tag is not the fixed tag.
+
+**/
+BOOLEAN
+DummyAeadCheckTag (
+  IN  CONST UINT8  *Tag,
+  IN  UINTN        TagSize
+  );
+
+/**
+  Compute the dummy signature of a message hash, or of a message for EdDSA.
+
+  @param  MessageHash                  The message hash.
+  @param  HashSize                     Size in bytes of the message hash.
+  @param  Signature                    The signature.
+  @param  SigSize                      Size in bytes of the signature.
+
+  @retval TRUE                         The dummy signature is computed.
+  @retval FALSE                        A parameter is invalid.
+**/
+BOOLEAN
+DummySign (
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  OUT UINT8        *Signature,
+  IN  UINTN        SigSize
+  );
+
+/**
+  Verify the dummy signature of a message hash, or of a message for EdDSA.
+
+  @param  MessageHash                  The message hash.
+  @param  HashSize                     Size in bytes of the message hash.
+  @param  Signature                    The signature.
+  @param  SigSize                      Size in bytes of the signature.
+
+  @retval TRUE                         The signature is the dummy signature of the message hash.
+  @retval FALSE                        The signature is not the dummy signature of the message hash.
+**/
+BOOLEAN
+DummyVerify (
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize
+  );
+
+/**
+  Allocate a dummy key context.
+
+  @param  Nid                          The NID of the key, or CRYPTO_NID_NULL.
+  @param  PublicSize                   Size in bytes of the public key, or 0.
+
+  @return the dummy key context, or NULL if the allocation fails.
+**/
+VOID *
+DummyKeyNew (
+  IN  UINTN  Nid,
+  IN  UINTN  PublicSize
+  );
+
 #endif
@@ -39,8 +39,12 @@ HkdfSha256ExtractAndExpand (
   IN   UINTN        OutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  Prk[64];
+
+  if (!HkdfSha256Extract (Key, KeySize, Salt, SaltSize, Prk, sizeof(Prk))) {
+    return FALSE;
+  }
+  return HkdfSha256Expand (Prk, sizeof(Prk), Info, InfoSize, Out, OutSize);
 }
 
 /**
@@ -68,8 +72,19 @@ HkdfSha256Extract (
   IN   UINTN        PrkOutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_DIGEST_CONTEXT  Context;
+
+  if (PrkOut == NULL) {
+    return FALSE;
+  }
+  if ((Key == NULL && KeySize != 0) || (Salt == NULL && SaltSize != 0)) {
+    return FALSE;
+  }
+  DummyDigestInit (&Context);
+  DummyDigestUpdate (&Context, Salt, SaltSize);
+  DummyDigestUpdate (&Context, Key, KeySize);
+  DummyDigestFinal (&Context, PrkOutSize, PrkOut);
+  return TRUE;
 }
 
 /**
@@ -97,8 +112,19 @@ HkdfSha256Expand (
   IN   UINTN        OutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_DIGEST_CONTEXT  Context;
+
+  if (Out == NULL) {
+    return FALSE;
+  }
+  if ((Prk == NULL && PrkSize != 0) || (Info == NULL && InfoSize != 0)) {
+    return FALSE;
+  }
+  DummyDigestInit (&Context);
+  DummyDigestUpdate (&Context, Prk, PrkSize);
+  DummyDigestUpdate (&Context, Info, InfoSize);
+  DummyDigestFinal (&Context, OutSize, Out);
+  return TRUE;
 }
 
 /**
@@ -130,8 +156,12 @@ HkdfSha384ExtractAndExpand (
   IN   UINTN        OutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  Prk[64];
+
+  if (!HkdfSha384Extract (Key, KeySize, Salt, SaltSize, Prk, sizeof(Prk))) {
+    return FALSE;
+  }
+  return HkdfSha384Expand (Prk, sizeof(Prk), Info, InfoSize, Out, OutSize);
 }
 
 /**
@@ -159,8 +189,19 @@ HkdfSha384Extract (
   IN   UINTN        PrkOutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_DIGEST_CONTEXT  Context;
+
+  if (PrkOut == NULL) {
+    return FALSE;
+  }
+  if ((Key == NULL && KeySize != 0) || (Salt == NULL && SaltSize != 0)) {
+    return FALSE;
+  }
+  DummyDigestInit (&Context);
+  DummyDigestUpdate (&Context, Salt, SaltSize);
+  DummyDigestUpdate (&Context, Key, KeySize);
+  DummyDigestFinal (&Context, PrkOutSize, PrkOut);
+  return TRUE;
 }
 
 /**
@@ -188,8 +229,19 @@ HkdfSha384Expand (
   IN   UINTN        OutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_DIGEST_CONTEXT  Context;
+
+  if (Out == NULL) {
+    return FALSE;
+  }
+  if ((Prk == NULL && PrkSize != 0) || (Info == NULL && InfoSize != 0)) {
+    return FALSE;
+  }
+  DummyDigestInit (&Context);
+  DummyDigestUpdate (&Context, Prk, PrkSize);
+  DummyDigestUpdate (&Context, Info, InfoSize);
+  DummyDigestFinal (&Context, OutSize, Out);
+  return TRUE;
 }
 
 /**
@@ -221,8 +273,12 @@ HkdfSha512ExtractAndExpand (
   IN   UINTN        OutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  Prk[64];
+
+  if (!HkdfSha512Extract (Key, KeySize, Salt, SaltSize, Prk, sizeof(Prk))) {
+    return FALSE;
+  }
+  return HkdfSha512Expand (Prk, sizeof(Prk), Info, InfoSize, Out, OutSize);
 }
 
 /**
@@ -250,8 +306,19 @@ HkdfSha512Extract (
   IN   UINTN        PrkOutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_DIGEST_CONTEXT  Context;
+
+  if (PrkOut == NULL) {
+    return FALSE;
+  }
+  if ((Key == NULL && KeySize != 0) || (Salt == NULL && SaltSize != 0)) {
+    return FALSE;
+  }
+  DummyDigestInit (&Context);
+  DummyDigestUpdate (&Context, Salt, SaltSize);
+  DummyDigestUpdate (&Context, Key, KeySize);
+  DummyDigestFinal (&Context, PrkOutSize, PrkOut);
+  return TRUE;
 }
 
 /**
@@ -279,6 +346,17 @@ HkdfSha512Expand (
   IN   UINTN        OutSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_DIGEST_CONTEXT  Context;
+
+  if (Out == NULL) {
+    return FALSE;
+  }
+  if ((Prk == NULL && PrkSize != 0) || (Info == NULL && InfoSize != 0)) {
+    return FALSE;
+  }
+  DummyDigestInit (&Context);
+  DummyDigestUpdate (&Context, Prk, PrkSize);
+  DummyDigestUpdate (&Context, Info, InfoSize);
+  DummyDigestFinal (&Context, OutSize, Out);
+  return TRUE;
 }
@@ -34,8 +34,11 @@ RsaGetPrivateKeyFromPem (
   OUT  VOID         **RsaContext
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (PemData == NULL || RsaContext == NULL) {
+    return FALSE;
+  }
+  *RsaContext = DummyKeyNew (CRYPTO_NID_NULL, 0);
+  return (BOOLEAN)(*RsaContext != NULL);
 }
 
 /**
@@ -64,7 +67,33 @@ EcGetPrivateKeyFromPem (
   OUT  VOID         **EcContext
   )
 {
-  ASSERT(FALSE);
+  if (PemData == NULL || EcContext == NULL) {
+    return FALSE;
+  }
+  *EcContext = DummyKeyNew (CRYPTO_NID_NULL, 0);
+  return (BOOLEAN)(*EcContext != NULL);
+}
+
+/**
+  Retrieve the EC Private Key held by the crypto implementation, such as a persistent key
+  provisioned in a secure element.
+
+  This interface is not supported, so it always returns FALSE.
+
+  @param[in]  KeyId        The key identifier of the crypto implementation.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which refer to the
+                           EC private key.
+
+  @retval  FALSE  This interface is not supported.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPrivateKeyFromKeyId (
+  IN   UINT32       KeyId,
+  OUT  VOID         **EcContext
+  )
+{
   return FALSE;
 }
 
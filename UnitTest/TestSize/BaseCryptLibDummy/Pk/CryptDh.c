@@ -26,8 +26,16 @@ DhNewByNid (
   IN UINTN  Nid
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  switch (Nid) {
+  case CRYPTO_NID_FFDHE2048:
+    return DummyKeyNew (Nid, 256);
+  case CRYPTO_NID_FFDHE3072:
+    return DummyKeyNew (Nid, 384);
+  case CRYPTO_NID_FFDHE4096:
+    return DummyKeyNew (Nid, 512);
+  default:
+    return NULL;
+  }
 }
 
 /**
@@ -44,7 +52,9 @@ DhFree (
   IN  VOID  *DhContext
   )
 {
-  ASSERT(FALSE);
+  if (DhContext != NULL) {
+    FreePool (DhContext);
+  }
 }
 
 /**
@@ -146,8 +156,23 @@ DhGenerateKey (
   IN OUT  UINTN  *PublicKeySize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_KEY_CONTEXT  *KeyContext;
+
+  if (DhContext == NULL || PublicKeySize == NULL) {
+    return FALSE;
+  }
+  KeyContext = DhContext;
+  if (*PublicKeySize < KeyContext->PublicSize) {
+    *PublicKeySize = KeyContext->PublicSize;
+    return FALSE;
+  }
+  if (PublicKey == NULL) {
+    return FALSE;
+  }
+  RandomBytes (KeyContext->Public, KeyContext->PublicSize);
+  CopyMem (PublicKey, KeyContext->Public, KeyContext->PublicSize);
+  *PublicKeySize = KeyContext->PublicSize;
+  return TRUE;
 }
 
 /**
@@ -184,6 +209,31 @@ DhComputeKey (
   IN OUT  UINTN        *KeySize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_KEY_CONTEXT  *KeyContext;
+  UINTN              SecretSize;
+  UINTN              Index;
+
+  if (DhContext == NULL || PeerPublicKey == NULL || KeySize == NULL) {
+    return FALSE;
+  }
+  KeyContext = DhContext;
+  if (PeerPublicKeySize != KeyContext->PublicSize) {
+    return FALSE;
+  }
+  SecretSize = KeyContext->PublicSize;
+  if (*KeySize < SecretSize) {
+    *KeySize = SecretSize;
+    return FALSE;
+  }
+  if (Key == NULL) {
+    return FALSE;
+  }
+  //
+  // The shared secret is the prime size, and is the same on both sides.
+  //
+  for (Index = 0; Index < SecretSize; Index++) {
+    Key[Index] = KeyContext->Public[Index] ^ PeerPublicKey[Index];
+  }
+  *KeySize = SecretSize;
+  return TRUE;
 }
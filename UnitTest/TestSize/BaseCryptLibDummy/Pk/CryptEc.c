@@ -27,8 +27,16 @@ EcNewByNid (
   IN UINTN  Nid
   )
 {
-  ASSERT(FALSE);
-  return NULL;
+  switch (Nid) {
+  case CRYPTO_NID_SECP256R1:
+    return DummyKeyNew (Nid, 32 * 2);
+  case CRYPTO_NID_SECP384R1:
+    return DummyKeyNew (Nid, 48 * 2);
+  case CRYPTO_NID_SECP521R1:
+    return DummyKeyNew (Nid, 66 * 2);
+  default:
+    return NULL;
+  }
 }
 
 /**
@@ -43,7 +51,9 @@ EcFree (
   IN  VOID  *EcContext
   )
 {
-  ASSERT(FALSE);
+  if (EcContext != NULL) {
+    FreePool (EcContext);
+  }
 }
 
 /**
@@ -83,8 +93,23 @@ EcGenerateKey (
   IN OUT  UINTN  *PublicSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_KEY_CONTEXT  *KeyContext;
+
+  if (EcContext == NULL || PublicSize == NULL) {
+    return FALSE;
+  }
+  KeyContext = EcContext;
+  if (*PublicSize < KeyContext->PublicSize) {
+    *PublicSize = KeyContext->PublicSize;
+    return FALSE;
+  }
+  if (Public == NULL) {
+    return FALSE;
+  }
+  RandomBytes (KeyContext->Public, KeyContext->PublicSize);
+  CopyMem (Public, KeyContext->Public, KeyContext->PublicSize);
+  *PublicSize = KeyContext->PublicSize;
+  return TRUE;
 }
 
 /**
@@ -127,8 +152,33 @@ EcComputeKey (
   IN OUT  UINTN        *KeySize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  DUMMY_KEY_CONTEXT  *KeyContext;
+  UINTN              SecretSize;
+  UINTN              Index;
+
+  if (EcContext == NULL || PeerPublic == NULL || KeySize == NULL) {
+    return FALSE;
+  }
+  KeyContext = EcContext;
+  if (PeerPublicSize != KeyContext->PublicSize) {
+    return FALSE;
+  }
+  SecretSize = KeyContext->PublicSize / 2;
+  if (*KeySize < SecretSize) {
+    *KeySize = SecretSize;
+    return FALSE;
+  }
+  if (Key == NULL) {
+    return FALSE;
+  }
+  //
+  // The shared secret is the X coordinate size, and is the same on both sides.
+  //
+  for (Index = 0; Index < SecretSize; Index++) {
+    Key[Index] = KeyContext->Public[Index] ^ PeerPublic[Index];
+  }
+  *KeySize = SecretSize;
+  return TRUE;
 }
 
 /**
@@ -171,8 +221,10 @@ EcDsaSign (
   IN OUT  UINTN        *SigSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (EcContext == NULL || SigSize == NULL) {
+    return FALSE;
+  }
+  return DummySign (MessageHash, HashSize, Signature, *SigSize);
 }
 
 /**
@@ -209,6 +261,90 @@ EcDsaVerify (
   IN  UINTN        SigSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (EcContext == NULL) {
+    return FALSE;
+  }
+  return DummyVerify (MessageHash, HashSize, Signature, SigSize);
+}
+
+/**
+  Prepares the public key of an EC context for repeated EC-DSA verification.
+
+  The prepared public key holds precomputed multiples of the public key point and of
+  the curve generator, so that EcDsaVerifyPrepared() is faster than EcDsaVerify().
+  It does not refer to EcContext, which may be released before the prepared public key.
+
+  If EcContext is NULL, then return NULL.
+
+  @param[in]  EcContext    Pointer to EC context holding the public key.
+
+  @return  Pointer to the prepared public key.
+           If the public key is invalid or the allocations fails, EcDsaPreparePublicKey() returns NULL.
+
+**/
+VOID *
+EFIAPI
+EcDsaPreparePublicKey (
+  IN  VOID         *EcContext
+  )
+{
+  //
+  // The dummy verification does not depend on the public key.
+  //
+  return EcContext;
+}
+
+/**
+  Release the specified prepared public key.
+
+  @param[in]  PreparedKey  Pointer to the prepared public key to be released.
+
+**/
+VOID
+EFIAPI
+EcDsaFreePreparedPublicKey (
+  IN  VOID         *PreparedKey
+  )
+{
+  //
+  // The prepared public key is the EC context, which is freed by EcFree().
+  //
+}
+
+/**
+  Verifies the EC-DSA signature with a prepared public key.
+
+  The result is the same as EcDsaVerify() with the EC context the public key is prepared from.
+
+  If PreparedKey is NULL, then return FALSE.
+  If MessageHash is NULL, then return FALSE.
+  If Signature is NULL, then return FALSE.
+  If HashSize need match the HashNid. HashNid could be SHA256, SHA384, SHA512.
+
+  @param[in]  PreparedKey  Pointer to the prepared public key for signature verification.
+  @param[in]  HashNid      hash NID
+  @param[in]  MessageHash  Pointer to octet message hash to be checked.
+  @param[in]  HashSize     Size of the message hash in bytes.
+  @param[in]  Signature    Pointer to EC-DSA signature to be verified.
+  @param[in]  SigSize      Size of signature in bytes.
+
+  @retval  TRUE   Valid signature encoded in EC-DSA.
+  @retval  FALSE  Invalid signature or invalid prepared public key.
+
+**/
+BOOLEAN
+EFIAPI
+EcDsaVerifyPrepared (
+  IN  VOID         *PreparedKey,
+  IN  UINTN        HashNid,
+  IN  CONST UINT8  *MessageHash,
+  IN  UINTN        HashSize,
+  IN  CONST UINT8  *Signature,
+  IN  UINTN        SigSize
+  )
+{
+  if (PreparedKey == NULL) {
+    return FALSE;
+  }
+  return DummyVerify (MessageHash, HashSize, Signature, SigSize);
 }
@@ -29,8 +29,7 @@ RsaNew (
   VOID
   )
 {
-  ASSERT(FALSE);
-  return NULL;
+  return DummyKeyNew (CRYPTO_NID_NULL, 0);
 }
 
 /**
@@ -45,7 +44,9 @@ RsaFree (
   IN  VOID  *RsaContext
   )
 {
-  ASSERT(FALSE);
+  if (RsaContext != NULL) {
+    FreePool (RsaContext);
+  }
 }
 
 /**
@@ -79,8 +80,10 @@ RsaSetKey (
   IN      UINTN        BnSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (RsaContext == NULL) {
+    return FALSE;
+  }
+  return TRUE;
 }
 
 /**
@@ -112,8 +115,10 @@ RsaPkcs1Verify (
   IN  UINTN        SigSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (RsaContext == NULL) {
+    return FALSE;
+  }
+  return DummyVerify (MessageHash, HashSize, Signature, SigSize);
 }
 
 /**
@@ -147,8 +152,10 @@ RsaPkcs1VerifyWithNid (
   IN  UINTN        SigSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (RsaContext == NULL) {
+    return FALSE;
+  }
+  return DummyVerify (MessageHash, HashSize, Signature, SigSize);
 }
 
 /**
@@ -184,6 +191,8 @@ RsaPssVerify (
   IN  UINTN        SigSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
-}
\ No newline at end of file
+  if (RsaContext == NULL) {
+    return FALSE;
+  }
+  return DummyVerify (MessageHash, HashSize, Signature, SigSize);
+}
@@ -153,8 +153,10 @@ RsaPkcs1Sign (
   IN OUT  UINTN        *SigSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (RsaContext == NULL || SigSize == NULL) {
+    return FALSE;
+  }
+  return DummySign (MessageHash, HashSize, Signature, *SigSize);
 }
 
 /**
@@ -167,11 +169,12 @@ RsaPkcs1Sign (
 
   If RsaContext is NULL, then return FALSE.
   If MessageHash is NULL, then return FALSE.
-  If HashSize is not equal to the size of MD5, SHA-1, SHA-256, SHA-384 or SHA-512 digest, then return FALSE.
+  If HashSize need match the HashNid. HashNid could be SHA256, SHA384, SHA512, SHA3_256, SHA3_384, SHA3_512.
   If SigSize is large enough but Signature is NULL, then return FALSE.
   If this interface is not supported, then return FALSE.
 
   @param[in]      RsaContext   Pointer to RSA context for signature generation.
+  @param[in]      HashNid      hash NID
   @param[in]      MessageHash  Pointer to octet message hash to be signed.
   @param[in]      HashSize     Size of the message hash in bytes.
   @param[out]     Signature    Pointer to buffer to receive RSA PKCS1-v1_5 signature.
@@ -186,16 +189,19 @@ RsaPkcs1Sign (
 **/
 BOOLEAN
 EFIAPI
-RsaPkcs1Sign (
+RsaPkcs1SignWithNid (
   IN      VOID         *RsaContext,
+  IN      UINTN        HashNid,
   IN      CONST UINT8  *MessageHash,
   IN      UINTN        HashSize,
   OUT     UINT8        *Signature,
   IN OUT  UINTN        *SigSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (RsaContext == NULL || SigSize == NULL) {
+    return FALSE;
+  }
+  return DummySign (MessageHash, HashSize, Signature, *SigSize);
 }
 
 /**
@@ -238,6 +244,8 @@ RsaPssSign (
   IN OUT  UINTN        *SigSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  if (RsaContext == NULL || SigSize == NULL) {
+    return FALSE;
+  }
+  return DummySign (MessageHash, HashSize, Signature, *SigSize);
 }
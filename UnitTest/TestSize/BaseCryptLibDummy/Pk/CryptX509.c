@@ -8,6 +8,95 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "InternalCryptLib.h"
 
+//
+// The dummy certificate validity, which is the widest one accepted by SpdmX509CertificateCheck.
+//
+#define DUMMY_X509_NOT_BEFORE  "19700101000000Z"
+#define DUMMY_X509_NOT_AFTER   "99991231235959Z"
+
+//
+// The elements of a TBSCertificate after the optional version.
+//
+#define DUMMY_X509_TBS_SERIAL_NUMBER  0
+#define DUMMY_X509_TBS_SIGNATURE      1
+#define DUMMY_X509_TBS_ISSUER         2
+#define DUMMY_X509_TBS_VALIDITY       3
+#define DUMMY_X509_TBS_SUBJECT        4
+
+/**
+  Walk the DER encoding of an X.509 certificate to one element of its TBSCertificate.
+
+  @param[in]  Cert         Pointer to the DER-encoded X509 certificate.
+  @param[in]  CertSize     Size of the X509 certificate in bytes.
+  @param[in]  Index        The element after the optional version, DUMMY_X509_TBS_*,
+                           or MAX_UINTN for the version.
+  @param[out] Element      Pointer to the DER-encoded element.
+  @param[out] ElementSize  Size of the DER-encoded element in bytes.
+
+  @retval TRUE   The element is found.
+  @retval FALSE  The certificate is malformed, or has not the element.
+
+**/
+STATIC
+BOOLEAN
+InternalX509GetTbsElement (
+  IN  CONST UINT8  *Cert,
+  IN  UINTN        CertSize,
+  IN  UINTN        Index,
+  OUT UINT8        **Element,
+  OUT UINTN        *ElementSize
+  )
+{
+  UINT8  *Ptr;
+  UINT8  *End;
+  UINT8  *Start;
+  UINTN  Length;
+  UINTN  Current;
+
+  if (Cert == NULL || CertSize == 0) {
+    return FALSE;
+  }
+  Ptr = (UINT8 *)Cert;
+  End = Ptr + CertSize;
+  if (!Asn1GetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  End = Ptr + Length;
+  if (!Asn1GetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  End = Ptr + Length;
+
+  //
+  // version [0] EXPLICIT Version DEFAULT v1
+  //
+  Start = Ptr;
+  if ((Ptr < End) && (*Ptr == (CRYPTO_ASN1_CONTEXT_SPECIFIC | CRYPTO_ASN1_CONSTRUCTED | 0))) {
+    if (!Asn1GetTag (&Ptr, End, &Length, CRYPTO_ASN1_CONTEXT_SPECIFIC | CRYPTO_ASN1_CONSTRUCTED | 0)) {
+      return FALSE;
+    }
+    Ptr += Length;
+    if (Index == MAX_UINTN) {
+      *Element = Start;
+      *ElementSize = Ptr - Start;
+      return TRUE;
+    }
+  } else if (Index == MAX_UINTN) {
+    return FALSE;
+  }
+
+  for (Current = 0; Current <= Index; Current++) {
+    Start = Ptr;
+    if ((Ptr >= End) || !Asn1GetTag (&Ptr, End, &Length, *Ptr)) {
+      return FALSE;
+    }
+    Ptr += Length;
+  }
+  *Element = Start;
+  *ElementSize = Ptr - Start;
+  return TRUE;
+}
+
 /**
   Construct a X509 object from DER-encoded certificate data.
 
@@ -75,7 +164,9 @@ X509Free (
   IN  VOID  *X509Cert
   )
 {
-  ASSERT(FALSE);
+  //
+  // No X509 object is constructed.
+  //
 }
 
 /**
@@ -92,7 +183,9 @@ X509StackFree (
   IN  VOID  *X509Stack
   )
 {
-  ASSERT(FALSE);
+  //
+  // No X509 stack is constructed.
+  //
 }
 
 /**
@@ -115,8 +208,42 @@ Asn1GetTag (
   IN     UINT32 Tag
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  *Cursor;
+  UINTN  LengthSize;
+  UINTN  ContentSize;
+
+  if (Ptr == NULL || *Ptr == NULL || End == NULL || Length == NULL) {
+    return FALSE;
+  }
+  Cursor = *Ptr;
+  if ((Cursor >= End) || (End - Cursor < 2) || (*Cursor != (UINT8)Tag)) {
+    return FALSE;
+  }
+  Cursor++;
+
+  if ((*Cursor & 0x80) == 0) {
+    ContentSize = *Cursor;
+    Cursor++;
+  } else {
+    LengthSize = *Cursor & 0x7F;
+    Cursor++;
+    if ((LengthSize == 0) || (LengthSize > sizeof(UINT32)) || ((UINTN)(End - Cursor) < LengthSize)) {
+      return FALSE;
+    }
+    ContentSize = 0;
+    while (LengthSize > 0) {
+      ContentSize = (ContentSize << 8) | *Cursor;
+      Cursor++;
+      LengthSize--;
+    }
+  }
+  if (ContentSize > (UINTN)(End - Cursor)) {
+    return FALSE;
+  }
+
+  *Ptr = Cursor;
+  *Length = ContentSize;
+  return TRUE;
 }
 
 /**
@@ -145,8 +272,24 @@ X509GetSubjectName (
   IN OUT  UINTN        *SubjectSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  *Ptr;
+  UINTN  Length;
+
+  if (SubjectSize == NULL) {
+    return FALSE;
+  }
+  if (!InternalX509GetTbsElement (Cert, CertSize, DUMMY_X509_TBS_SUBJECT, &Ptr, &Length)) {
+    return FALSE;
+  }
+  if (*SubjectSize < Length) {
+    *SubjectSize = Length;
+    return FALSE;
+  }
+  if (CertSubject != NULL) {
+    CopyMem (CertSubject, Ptr, Length);
+  }
+  *SubjectSize = Length;
+  return TRUE;
 }
 
 /**
@@ -251,8 +394,45 @@ RsaGetPublicKeyFromX509 (
   OUT  VOID         **RsaContext
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  *Ptr;
+  UINTN  Length;
+
+  if (RsaContext == NULL || !InternalX509GetTbsElement (Cert, CertSize, DUMMY_X509_TBS_SUBJECT, &Ptr, &Length)) {
+    return FALSE;
+  }
+  *RsaContext = DummyKeyNew (CRYPTO_NID_NULL, 0);
+  return (BOOLEAN)(*RsaContext != NULL);
+}
+
+/**
+  Retrieve the RSA Public Key from one DER-encoded SubjectPublicKeyInfo.
+
+  @param[in]  DerData      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param[in]  DerSize      Size of the DER data in bytes.
+  @param[out] RsaContext   Pointer to new-generated RSA context which contain the retrieved
+                           RSA public key component. Use RsaFree() function to free the
+                           resource.
+
+  If DerData is NULL, then return FALSE.
+  If RsaContext is NULL, then return FALSE.
+
+  @retval  TRUE   RSA Public Key was retrieved successfully.
+  @retval  FALSE  Invalid DER data, or the key is not an RSA key.
+
+**/
+BOOLEAN
+EFIAPI
+RsaGetPublicKeyFromDer (
+  IN   CONST UINT8  *DerData,
+  IN   UINTN        DerSize,
+  OUT  VOID         **RsaContext
+  )
+{
+  if (DerData == NULL || DerSize == 0 || RsaContext == NULL) {
+    return FALSE;
+  }
+  *RsaContext = DummyKeyNew (CRYPTO_NID_NULL, 0);
+  return (BOOLEAN)(*RsaContext != NULL);
 }
 
 /**
@@ -279,8 +459,45 @@ EcGetPublicKeyFromX509 (
   OUT  VOID         **EcContext
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  *Ptr;
+  UINTN  Length;
+
+  if (EcContext == NULL || !InternalX509GetTbsElement (Cert, CertSize, DUMMY_X509_TBS_SUBJECT, &Ptr, &Length)) {
+    return FALSE;
+  }
+  *EcContext = DummyKeyNew (CRYPTO_NID_NULL, 0);
+  return (BOOLEAN)(*EcContext != NULL);
+}
+
+/**
+  Retrieve the EC Public Key from one DER-encoded SubjectPublicKeyInfo.
+
+  @param[in]  DerData      Pointer to the DER-encoded SubjectPublicKeyInfo.
+  @param[in]  DerSize      Size of the DER data in bytes.
+  @param[out] EcContext    Pointer to new-generated EC DSA context which contain the retrieved
+                           EC public key component. Use EcFree() function to free the
+                           resource.
+
+  If DerData is NULL, then return FALSE.
+  If EcContext is NULL, then return FALSE.
+
+  @retval  TRUE   EC Public Key was retrieved successfully.
+  @retval  FALSE  Invalid DER data, or the key is not an EC key.
+
+**/
+BOOLEAN
+EFIAPI
+EcGetPublicKeyFromDer (
+  IN   CONST UINT8  *DerData,
+  IN   UINTN        DerSize,
+  OUT  VOID         **EcContext
+  )
+{
+  if (DerData == NULL || DerSize == 0 || EcContext == NULL) {
+    return FALSE;
+  }
+  *EcContext = DummyKeyNew (CRYPTO_NID_NULL, 0);
+  return (BOOLEAN)(*EcContext != NULL);
 }
 
 /**
@@ -308,8 +525,14 @@ X509VerifyCert (
   IN  UINTN        CACertSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  *Ptr;
+  UINTN  Length;
+
+  //
+  // The dummy signatures cannot verify a real certificate, so only the encoding is checked.
+  //
+  return (BOOLEAN)(InternalX509GetTbsElement (Cert, CertSize, DUMMY_X509_TBS_SUBJECT, &Ptr, &Length) &&
+                   InternalX509GetTbsElement (CACert, CACertSize, DUMMY_X509_TBS_SUBJECT, &Ptr, &Length));
 }
 
 /**
@@ -339,8 +562,51 @@ X509VerifyCertChain (
   IN UINTN    CertChainLength
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINTN    Asn1Len;
+  UINTN    PrecedingCertLen;
+  UINT8    *PrecedingCert;
+  UINTN    CurrentCertLen;
+  UINT8    *CurrentCert;
+  UINT8    *TmpPtr;
+  BOOLEAN  VerifyFlag;
+
+  VerifyFlag = FALSE;
+  PrecedingCert = RootCert;
+  PrecedingCertLen = RootCertLength;
+
+  CurrentCert = CertChain;
+
+  //
+  // Get Current certificate from Certificates buffer and Verify with preciding cert
+  //
+  do {
+    TmpPtr = CurrentCert;
+    if (!Asn1GetTag (&TmpPtr, CertChain + CertChainLength, &Asn1Len, CRYPTO_ASN1_CONSTRUCTED | CRYPTO_ASN1_SEQUENCE)) {
+      break;
+    }
+
+    CurrentCertLen = Asn1Len + (TmpPtr - CurrentCert);
+
+    if (X509VerifyCert (CurrentCert, CurrentCertLen, PrecedingCert, PrecedingCertLen) == FALSE) {
+      VerifyFlag = FALSE;
+      break;
+    } else {
+      VerifyFlag = TRUE;
+    }
+
+    //
+    // Save preceding certificate
+    //
+    PrecedingCert = CurrentCert;
+    PrecedingCertLen = CurrentCertLen;
+
+    //
+    // Move current certificate to next;
+    //
+    CurrentCert = CurrentCert + CurrentCertLen;
+  } while (1);
+
+  return VerifyFlag;
 }
 
 
@@ -371,7 +637,60 @@ X509GetCertFromCertChain (
   OUT UINT8 **Cert,
   OUT UINTN *CertLength)
 {
-  ASSERT(FALSE);
+  UINTN  Asn1Len;
+  INT32  CurrentIndex;
+  UINTN  CurrentCertLen;
+  UINT8  *CurrentCert;
+  UINT8  *TmpPtr;
+
+  //
+  // Check input parameters.
+  //
+  if ((CertChain == NULL) || (Cert == NULL) ||
+      (CertIndex < -1) || (CertLength == NULL)) {
+    return FALSE;
+  }
+
+  CurrentCert = CertChain;
+  CurrentIndex = -1;
+  CurrentCertLen = 0;
+
+  //
+  // Traverse the certificate chain
+  //
+  while (TRUE) {
+    //
+    // Get asn1 tag len
+    //
+    TmpPtr = CurrentCert;
+    if (!Asn1GetTag (&TmpPtr, CertChain + CertChainLength, &Asn1Len, CRYPTO_ASN1_CONSTRUCTED | CRYPTO_ASN1_SEQUENCE)) {
+      break;
+    }
+
+    CurrentCertLen = Asn1Len + (TmpPtr - CurrentCert);
+    CurrentIndex ++;
+
+    if (CurrentIndex == CertIndex) {
+      *Cert = CurrentCert;
+      *CertLength = CurrentCertLen;
+      return TRUE;
+    }
+
+    //
+    // Move to next
+    //
+    CurrentCert = CurrentCert + CurrentCertLen;
+  }
+
+  //
+  // If CertIndex is -1, Return the last certificate
+  //
+  if (CertIndex == -1 && CurrentIndex >= 0) {
+    *Cert = CurrentCert - CurrentCertLen;
+    *CertLength = CurrentCertLen;
+    return TRUE;
+  }
+
   return FALSE;
 }
 
@@ -401,8 +720,24 @@ X509GetTBSCert (
   OUT UINTN        *TBSCertSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  *Ptr;
+  UINT8  *End;
+  UINTN  Length;
+
+  if (Cert == NULL || CertSize == 0 || TBSCert == NULL || TBSCertSize == NULL) {
+    return FALSE;
+  }
+  Ptr = (UINT8 *)Cert;
+  End = Ptr + CertSize;
+  if (!Asn1GetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  *TBSCert = Ptr;
+  if (!Asn1GetTag (&Ptr, End, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED)) {
+    return FALSE;
+  }
+  *TBSCertSize = Length + (Ptr - *TBSCert);
+  return TRUE;
 }
 
 
@@ -430,8 +765,24 @@ X509GetVersion (
   OUT     UINTN          *Version
   )
 {
-  ASSERT(FALSE);
-  return RETURN_UNSUPPORTED;
+  UINT8  *Ptr;
+  UINTN  Length;
+
+  if (Version == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (!InternalX509GetTbsElement (Cert, CertSize, DUMMY_X509_TBS_SERIAL_NUMBER, &Ptr, &Length)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  *Version = 0;
+  if (InternalX509GetTbsElement (Cert, CertSize, MAX_UINTN, &Ptr, &Length)) {
+    if (!Asn1GetTag (&Ptr, Ptr + Length, &Length, CRYPTO_ASN1_CONTEXT_SPECIFIC | CRYPTO_ASN1_CONSTRUCTED | 0) ||
+        !Asn1GetTag (&Ptr, Ptr + Length, &Length, CRYPTO_ASN1_INTEGER) || (Length != 1)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+    *Version = *Ptr;
+  }
+  return RETURN_SUCCESS;
 }
 
 /**
@@ -466,8 +817,23 @@ X509GetSerialNumber (
   IN OUT  UINTN         *SerialNumberSize
   )
 {
-  ASSERT(FALSE);
-  return RETURN_UNSUPPORTED;
+  UINT8  *Ptr;
+  UINTN  Length;
+
+  if (SerialNumberSize == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (!InternalX509GetTbsElement (Cert, CertSize, DUMMY_X509_TBS_SERIAL_NUMBER, &Ptr, &Length) ||
+      !Asn1GetTag (&Ptr, Ptr + Length, &Length, CRYPTO_ASN1_INTEGER)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (*SerialNumberSize < Length || SerialNumber == NULL) {
+    *SerialNumberSize = Length;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  CopyMem (SerialNumber, Ptr, Length);
+  *SerialNumberSize = Length;
+  return RETURN_SUCCESS;
 }
 
 /**
@@ -498,8 +864,24 @@ X509GetIssuerName (
   IN OUT  UINTN        *CertIssuerSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  *Ptr;
+  UINTN  Length;
+
+  if (CertIssuerSize == NULL) {
+    return FALSE;
+  }
+  if (!InternalX509GetTbsElement (Cert, CertSize, DUMMY_X509_TBS_ISSUER, &Ptr, &Length)) {
+    return FALSE;
+  }
+  if (*CertIssuerSize < Length) {
+    *CertIssuerSize = Length;
+    return FALSE;
+  }
+  if (CertIssuer != NULL) {
+    CopyMem (CertIssuer, Ptr, Length);
+  }
+  *CertIssuerSize = Length;
+  return TRUE;
 }
 
 /**
@@ -607,8 +989,24 @@ X509GetSignatureAlgorithm (
   IN OUT   UINTN       *OidSize
   )
 {
-  ASSERT(FALSE);
-  return RETURN_UNSUPPORTED;
+  UINT8  *Ptr;
+  UINTN  Length;
+
+  if (OidSize == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (!InternalX509GetTbsElement (Cert, CertSize, DUMMY_X509_TBS_SIGNATURE, &Ptr, &Length) ||
+      !Asn1GetTag (&Ptr, Ptr + Length, &Length, CRYPTO_ASN1_SEQUENCE | CRYPTO_ASN1_CONSTRUCTED) ||
+      !Asn1GetTag (&Ptr, Ptr + Length, &Length, CRYPTO_ASN1_OID)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  if (*OidSize < Length || Oid == NULL) {
+    *OidSize = Length;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  CopyMem (Oid, Ptr, Length);
+  *OidSize = Length;
+  return RETURN_SUCCESS;
 }
 
 
@@ -679,8 +1077,25 @@ X509GetValidity  (
   IN OUT UINTN       *ToSize
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  *Ptr;
+  UINTN  Length;
+
+  if (FromSize == NULL || ToSize == NULL) {
+    return FALSE;
+  }
+  if (!InternalX509GetTbsElement (Cert, CertSize, DUMMY_X509_TBS_VALIDITY, &Ptr, &Length)) {
+    return FALSE;
+  }
+  //
+  // The dummy validity does not depend on the certificate.
+  //
+  if (X509SetDateTime (DUMMY_X509_NOT_BEFORE, From, FromSize) != RETURN_SUCCESS) {
+    return FALSE;
+  }
+  if (X509SetDateTime (DUMMY_X509_NOT_AFTER, To, ToSize) != RETURN_SUCCESS) {
+    return FALSE;
+  }
+  return TRUE;
 }
 
 /**
@@ -702,8 +1117,17 @@ X509GetKeyUsage (
   OUT   UINTN        *Usage
   )
 {
-  ASSERT(FALSE);
-  return FALSE;
+  UINT8  *Ptr;
+  UINTN  Length;
+
+  if (Usage == NULL || !InternalX509GetTbsElement (Cert, CertSize, DUMMY_X509_TBS_SUBJECT, &Ptr, &Length)) {
+    return FALSE;
+  }
+  //
+  // The dummy key usage is the one SpdmX509CertificateCheck requires.
+  //
+  *Usage = CRYPTO_X509_KU_DIGITAL_SIGNATURE;
+  return TRUE;
 }
 
 /**
@@ -732,8 +1156,13 @@ X509GetExtendedKeyUsage (
   IN OUT UINTN         *UsageSize
   )
 {
-  ASSERT(FALSE);
-  return RETURN_UNSUPPORTED;
+  if (Cert == NULL || UsageSize == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  //
+  // The extensions are not parsed, so no extended key usage is found.
+  //
+  return RETURN_NOT_FOUND;
 }
 
 /**
@@ -767,8 +1196,24 @@ X509SetDateTime (
   IN OUT UINTN  *DateTimeSize
   )
 {
-  ASSERT(FALSE);
-  return RETURN_UNSUPPORTED;
+  UINTN  Size;
+
+  if (DateTimeStr == NULL || DateTimeSize == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  //
+  // The dummy DateTime object is the NULL-terminated DateTimeStr.
+  //
+  for (Size = 0; DateTimeStr[Size] != '\0'; Size++) {
+  }
+  Size++;
+  if (*DateTimeSize < Size || DateTime == NULL) {
+    *DateTimeSize = Size;
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  CopyMem (DateTime, DateTimeStr, Size);
+  *DateTimeSize = Size;
+  return RETURN_SUCCESS;
 }
 
 /**
@@ -794,6 +1239,23 @@ X509CompareDateTime (
   IN    VOID   *DateTime2
   )
 {
-  ASSERT(FALSE);
-  return -3;
+  CONST CHAR8  *Str1;
+  CONST CHAR8  *Str2;
+
+  if (DateTime1 == NULL || DateTime2 == NULL) {
+    return -2;
+  }
+  //
+  // The DateTime strings have the same format, so they compare as strings.
+  //
+  Str1 = DateTime1;
+  Str2 = DateTime2;
+  while (*Str1 != '\0' && *Str1 == *Str2) {
+    Str1++;
+    Str2++;
+  }
+  if (*Str1 == *Str2) {
+    return 0;
+  }
+  return (*Str1 > *Str2) ? 1 : -1;
 }
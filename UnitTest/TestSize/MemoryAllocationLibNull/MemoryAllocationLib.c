@@ -32,3 +32,12 @@ FreePool (
   )
 {
 }
+
+VOID
+EFIAPI
+SetPoolAllocationTag (
+  IN UINT8  RequestCode,
+  IN UINT8  Phase
+  )
+{
+}
@@ -0,0 +1,46 @@
+/** @file
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TestFootprint.h"
+
+#define TEST_FOOTPRINT_STACK_PATTERN  0xA5
+
+/**
+  Paint the stack region below the caller, or measure how deep it was used since it was painted.
+
+  The same function paints and measures, so that the region is at the same place in both calls.
+  It must be called from the same function as the code which is measured.
+
+  @param  Paint                        TRUE to paint the region, FALSE to measure it.
+
+  @return the size in bytes of the region used since it was painted, or 0 when it is painted.
+**/
+UINTN
+TestFootprintStackProbe (
+  IN BOOLEAN  Paint
+  )
+{
+  volatile UINT8  Region[TEST_FOOTPRINT_STACK_PROBE_SIZE];
+  UINTN           Index;
+
+  if (Paint) {
+    for (Index = 0; Index < sizeof(Region); Index++) {
+      Region[Index] = TEST_FOOTPRINT_STACK_PATTERN;
+    }
+    return 0;
+  }
+
+  //
+  // The stack grows down, so the deepest byte used is the lowest one which is not painted.
+  //
+  for (Index = 0; Index < sizeof(Region); Index++) {
+    if (Region[Index] != TEST_FOOTPRINT_STACK_PATTERN) {
+      break;
+    }
+  }
+  return sizeof(Region) - Index;
+}
@@ -0,0 +1,774 @@
+/** @file
+  Application for SPDM RAM Footprint Report.
+
+  TestSizeOfSpdmRequester and TestSizeOfSpdmResponder measure the code size. This application reports
+  the data side: the size of the SPDM context and of the secured message context for some limits of
+  SPDM_CONTEXT_CONFIG, then the stack depth and the heap high water mark of each entry point.
+
+  A requester and a responder SPDM context run in one process. The device send function of the
+  requester gives the transport message to SpdmProcessMessage of the responder, so that each API of
+  the requester runs its full flow with real crypto, for each algorithm suite.
+
+  The stack depth is measured by painting a region below the caller. The depth of a requester entry
+  point includes the responder, which runs below it. The depth of the responder is also measured
+  alone for each request code, below the device send function. The heap high water mark is measured
+  in an arena set with SetPoolArena, for both peers together. The allocations of the crypto library
+  which do not use MemoryAllocationLib are not included, and an arena which cannot be given back,
+  because a block of a previous entry point is outstanding, is reported as n/a.
+
+  Two CSV tables are printed:
+  config,max_message_size,max_cert_chain_size,max_session_count,spdm_context_size,secured_message_context_size
+  asym,hash,dhe,aead,side,entry,stack_peak,heap_peak,allocs,status
+
+  The certificates are read from the current directory, as in the unit tests.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TestFootprint.h"
+
+typedef struct {
+  CHAR8                  *Name;
+  SPDM_CONTEXT_CONFIG    Config;
+} TEST_FOOTPRINT_CONFIG;
+
+//
+// A limit of 0 selects the default limit of SpdmInitContext.
+//
+TEST_FOOTPRINT_CONFIG  mTestFootprintConfig[] = {
+  {"Default",     {0,     0,      0}},
+  {"OneSession",  {0,     0,      1}},
+  {"Constrained", {0x400, 0x800,  1}},
+  {"Minimal",     {0x100, 0x400,  1}},
+};
+
+typedef struct {
+  UINT32    BaseAsymAlgo;
+  UINT32    BaseHashAlgo;
+  UINT32    MeasurementHashAlgo;
+  UINT16    DHENamedGroup;
+  UINT16    AEADCipherSuite;
+  CHAR8     *AsymName;
+  CHAR8     *HashName;
+  CHAR8     *DheName;
+  CHAR8     *AeadName;
+} TEST_FOOTPRINT_SUITE;
+
+//
+// The suites with the smallest and the largest keys of the test keys.
+//
+TEST_FOOTPRINT_SUITE  mTestFootprintSuite[] = {
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256, SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM, "ECDSA-P256",  "SHA-256", "SECP256R1",  "AES-128-GCM"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384, SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_384_R1, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM, "ECDSA-P384",  "SHA-384", "SECP384R1",  "AES-256-GCM"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048,         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_256,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_2048,  SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_128_GCM, "RSASSA-2048", "SHA-256", "FFDHE-2048", "AES-128-GCM"},
+  {SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSAPSS_3072,         SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_TPM_ALG_SHA_384,
+   SPDM_ALGORITHMS_DHE_NAMED_GROUP_FFDHE_3072,  SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM, "RSAPSS-3072", "SHA-384", "FFDHE-3072", "AES-256-GCM"},
+};
+
+#define TEST_FOOTPRINT_REQUESTER_CAPABILITY_FLAGS  (SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCRYPT_CAP | \
+                                                    SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP | \
+                                                    SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP | \
+                                                    SPDM_GET_CAPABILITIES_REQUEST_FLAGS_PSK_CAP_REQUESTER | \
+                                                    SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP | \
+                                                    SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_UPD_CAP)
+
+#define TEST_FOOTPRINT_RESPONDER_CAPABILITY_FLAGS  (SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP | \
+                                                    SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP | \
+                                                    SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP_SIG | \
+                                                    SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_FRESH_CAP | \
+                                                    SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCRYPT_CAP | \
+                                                    SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MAC_CAP | \
+                                                    SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP | \
+                                                    SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP_RESPONDER_WITH_CONTEXT | \
+                                                    SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP | \
+                                                    SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_UPD_CAP)
+
+typedef struct {
+  TEST_FOOTPRINT_SUITE  *Suite;
+  VOID                  *RequesterContext;
+  VOID                  *ResponderContext;
+  VOID                  *PrivateKey;
+  VOID                  *CertChain;
+  VOID                  *RootCert;
+  UINT32                SessionId;
+  UINT8                 *Arena;
+  UINT8                 *Message;
+  UINT8                 *ResponseMessage;
+} TEST_FOOTPRINT_CONTEXT;
+
+/**
+  One entry point of the requester.
+
+  @param  Footprint                    The footprint context.
+
+  @retval TRUE   The entry point succeeded.
+  @retval FALSE  The entry point failed.
+**/
+typedef
+BOOLEAN
+(*TEST_FOOTPRINT_FUNC) (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  );
+
+typedef struct {
+  CHAR8                *Name;
+  TEST_FOOTPRINT_FUNC  Func;
+} TEST_FOOTPRINT_ENTRY;
+
+typedef struct {
+  UINT8     RequestCode;
+  CHAR8     *Name;
+} TEST_FOOTPRINT_REQUEST;
+
+//
+// The requests processed by the responder. The stack depth of each is kept in mTestFootprintResponderStack.
+//
+TEST_FOOTPRINT_REQUEST  mTestFootprintRequest[] = {
+  {SPDM_GET_VERSION,          "GET_VERSION"},
+  {SPDM_GET_CAPABILITIES,     "GET_CAPABILITIES"},
+  {SPDM_NEGOTIATE_ALGORITHMS, "NEGOTIATE_ALGORITHMS"},
+  {SPDM_GET_DIGESTS,          "GET_DIGESTS"},
+  {SPDM_GET_CERTIFICATE,      "GET_CERTIFICATE"},
+  {SPDM_CHALLENGE,            "CHALLENGE"},
+  {SPDM_GET_MEASUREMENTS,     "GET_MEASUREMENTS"},
+  {SPDM_KEY_EXCHANGE,         "KEY_EXCHANGE"},
+  {SPDM_FINISH,               "FINISH"},
+  {SPDM_PSK_EXCHANGE,         "PSK_EXCHANGE"},
+  {SPDM_PSK_FINISH,           "PSK_FINISH"},
+  {SPDM_HEARTBEAT,            "HEARTBEAT"},
+  {SPDM_KEY_UPDATE,           "KEY_UPDATE"},
+  {SPDM_END_SESSION,          "END_SESSION"},
+};
+
+SPDM_TEST_CONTEXT  mTestFootprintRequesterContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  TRUE,
+  NULL,
+  NULL,
+};
+
+SPDM_TEST_CONTEXT  mTestFootprintResponderContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  FALSE,
+  NULL,
+  NULL,
+};
+
+//
+// The response of the responder, until the requester receives it.
+//
+UINT8    mTestFootprintResponse[TEST_FOOTPRINT_TRANSPORT_BUFFER_SIZE];
+UINTN    mTestFootprintResponseSize;
+
+//
+// The deepest stack of the responder for each request code, and for the application messages.
+//
+UINTN    mTestFootprintResponderStack[256];
+UINTN    mTestFootprintResponderAppStack;
+BOOLEAN  mTestFootprintAppMessage;
+
+/**
+  Send a transport message of the requester to the responder, which processes it at once.
+  The stack depth of the responder is recorded for the request code.
+
+  @param  SpdmContext                  A pointer to the SPDM context of the requester.
+  @param  RequestSize                  Size in bytes of the request message.
+  @param  Request                      A pointer to the request message.
+  @param  Timeout                      The timeout, not used.
+
+  @retval RETURN_SUCCESS               The responder has processed the request.
+  @retval RETURN_DEVICE_ERROR          The responder cannot process the request.
+**/
+RETURN_STATUS
+EFIAPI
+TestFootprintSendMessage (
+  IN     VOID                                   *SpdmContext,
+  IN     UINTN                                  RequestSize,
+  IN     VOID                                   *Request,
+  IN     UINT64                                 Timeout
+  )
+{
+  RETURN_STATUS        Status;
+  UINT32               *SessionId;
+  UINTN                Stack;
+  SPDM_DEVICE_CONTEXT  *ResponderContext;
+  SPDM_MESSAGE_HEADER  *SpdmRequest;
+
+  ResponderContext = mTestFootprintResponderContext.SpdmContext;
+  SessionId = NULL;
+  mTestFootprintAppMessage = FALSE;
+  mTestFootprintResponseSize = sizeof(mTestFootprintResponse);
+  TestFootprintStackProbe (TRUE);
+  Status = SpdmProcessMessage (
+             ResponderContext,
+             &SessionId,
+             Request,
+             RequestSize,
+             mTestFootprintResponse,
+             &mTestFootprintResponseSize
+             );
+  Stack = TestFootprintStackProbe (FALSE);
+  if (RETURN_ERROR(Status)) {
+    mTestFootprintResponseSize = 0;
+    return RETURN_DEVICE_ERROR;
+  }
+
+  if (mTestFootprintAppMessage) {
+    mTestFootprintResponderAppStack = MAX (mTestFootprintResponderAppStack, Stack);
+  } else {
+    SpdmRequest = (VOID *)ResponderContext->LastSpdmRequest;
+    mTestFootprintResponderStack[SpdmRequest->RequestResponseCode] = MAX (mTestFootprintResponderStack[SpdmRequest->RequestResponseCode], Stack);
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Receive the transport message of the responder.
+
+  @param  SpdmContext                  A pointer to the SPDM context of the requester.
+  @param  ResponseSize                 Size in bytes of the response buffer on input, of the response message on output.
+  @param  Response                     A pointer to the response buffer.
+  @param  Timeout                      The timeout, not used.
+
+  @retval RETURN_SUCCESS               The response is received.
+  @retval RETURN_DEVICE_ERROR          No response is pending, or it does not fit in the buffer.
+**/
+RETURN_STATUS
+EFIAPI
+TestFootprintReceiveMessage (
+  IN     VOID                                   *SpdmContext,
+  IN OUT UINTN                                  *ResponseSize,
+  IN OUT VOID                                   *Response,
+  IN     UINT64                                 Timeout
+  )
+{
+  if ((mTestFootprintResponseSize == 0) || (*ResponseSize < mTestFootprintResponseSize)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  CopyMem (Response, mTestFootprintResponse, mTestFootprintResponseSize);
+  *ResponseSize = mTestFootprintResponseSize;
+  mTestFootprintResponseSize = 0;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Echo the application messages of the requester.
+
+  @param  SpdmContext                  A pointer to the SPDM context of the responder.
+  @param  SessionId                    The session of the message.
+  @param  IsAppMessage                 Indicates if it is an APP message or SPDM message.
+  @param  RequestSize                  Size in bytes of the request data.
+  @param  Request                      A pointer to the request data.
+  @param  ResponseSize                 Size in bytes of the response buffer on input, of the response data on output.
+  @param  Response                     A pointer to the response data.
+
+  @retval RETURN_SUCCESS               The application message is echoed.
+  @retval RETURN_UNSUPPORTED           The message is not an application message.
+**/
+RETURN_STATUS
+EFIAPI
+TestFootprintEchoAppMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  if (!IsAppMessage || (SessionId == NULL) || (*ResponseSize < RequestSize)) {
+    return RETURN_UNSUPPORTED;
+  }
+  mTestFootprintAppMessage = TRUE;
+  CopyMem (Response, Request, RequestSize);
+  *ResponseSize = RequestSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Set the capabilities and the algorithms of one suite in one SPDM context.
+
+  @param  SpdmContext                  A pointer to the SPDM context.
+  @param  Suite                        The algorithm suite.
+  @param  CapabilityFlags              The capability flags of the peer.
+**/
+VOID
+TestFootprintSetupAlgorithms (
+  IN VOID                  *SpdmContext,
+  IN TEST_FOOTPRINT_SUITE  *Suite,
+  IN UINT32                CapabilityFlags
+  )
+{
+  SPDM_DATA_PARAMETER  Parameter;
+  UINT8                Data8;
+  UINT16               Data16;
+  UINT32               Data32;
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+
+  Data8 = 0;
+  SpdmSetData (SpdmContext, SpdmDataCapabilityCTExponent, &Parameter, &Data8, sizeof(Data8));
+  Data32 = CapabilityFlags;
+  SpdmSetData (SpdmContext, SpdmDataCapabilityFlags, &Parameter, &Data32, sizeof(Data32));
+
+  Data8 = SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF;
+  SpdmSetData (SpdmContext, SpdmDataMeasurementSpec, &Parameter, &Data8, sizeof(Data8));
+  Data32 = Suite->MeasurementHashAlgo;
+  SpdmSetData (SpdmContext, SpdmDataMeasurementHashAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data32 = Suite->BaseAsymAlgo;
+  SpdmSetData (SpdmContext, SpdmDataBaseAsymAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data32 = Suite->BaseHashAlgo;
+  SpdmSetData (SpdmContext, SpdmDataBaseHashAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data16 = Suite->DHENamedGroup;
+  SpdmSetData (SpdmContext, SpdmDataDHENamedGroup, &Parameter, &Data16, sizeof(Data16));
+  Data16 = Suite->AEADCipherSuite;
+  SpdmSetData (SpdmContext, SpdmDataAEADCipherSuite, &Parameter, &Data16, sizeof(Data16));
+  Data16 = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_RSASSA_2048;
+  SpdmSetData (SpdmContext, SpdmDataReqBaseAsymAlg, &Parameter, &Data16, sizeof(Data16));
+  Data16 = SPDM_ALGORITHMS_KEY_SCHEDULE_HMAC_HASH;
+  SpdmSetData (SpdmContext, SpdmDataKeySchedule, &Parameter, &Data16, sizeof(Data16));
+
+  SpdmSetData (SpdmContext, SpdmDataPskHint, NULL, TEST_PSK_HINT_STRING, sizeof(TEST_PSK_HINT_STRING));
+}
+
+/**
+  Provision the certificates and the private key of one suite in both SPDM contexts.
+
+  @param  Footprint                    The footprint context.
+
+  @retval TRUE   Both peers are provisioned.
+  @retval FALSE  The test keys of the suite cannot be read.
+**/
+BOOLEAN
+TestFootprintProvision (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  SPDM_DATA_PARAMETER  Parameter;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+  UINT8                Data8;
+
+  if (!ReadResponderPublicCertificateChain (Footprint->Suite->BaseHashAlgo, Footprint->Suite->BaseAsymAlgo, &Footprint->CertChain, &DataSize, NULL, NULL)) {
+    return FALSE;
+  }
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  Data8 = 1;
+  SpdmSetData (Footprint->ResponderContext, SpdmDataLocalSlotCount, &Parameter, &Data8, sizeof(Data8));
+  Parameter.AdditionalData[0] = 0;
+  SpdmSetData (Footprint->ResponderContext, SpdmDataLocalPublicCertChain, &Parameter, Footprint->CertChain, DataSize);
+
+  if (!SpdmResponderDataLoadKeyFunc (Footprint->Suite->BaseAsymAlgo, &Footprint->PrivateKey)) {
+    return FALSE;
+  }
+  SpdmRegisterLocalPrivateKey (Footprint->ResponderContext, FALSE, Footprint->Suite->BaseAsymAlgo, Footprint->PrivateKey);
+
+  if (!ReadResponderRootPublicCertificate (Footprint->Suite->BaseHashAlgo, Footprint->Suite->BaseAsymAlgo, &Footprint->RootCert, &DataSize, &Hash, &HashSize)) {
+    return FALSE;
+  }
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  SpdmSetData (Footprint->RequesterContext, SpdmDataPeerPublicRootCertHash, &Parameter, Hash, HashSize);
+  return TRUE;
+}
+
+BOOLEAN
+TestFootprintInitConnection (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  return !RETURN_ERROR(SpdmInitConnection (Footprint->RequesterContext, FALSE));
+}
+
+BOOLEAN
+TestFootprintGetDigest (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  UINT8  SlotMask;
+
+  return !RETURN_ERROR(SpdmGetDigest (Footprint->RequesterContext, &SlotMask, Footprint->ResponseMessage));
+}
+
+BOOLEAN
+TestFootprintGetCertificate (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  UINTN  CertChainSize;
+
+  CertChainSize = MAX_SPDM_CERT_CHAIN_SIZE;
+  return !RETURN_ERROR(SpdmGetCertificate (Footprint->RequesterContext, 0, &CertChainSize, Footprint->ResponseMessage));
+}
+
+BOOLEAN
+TestFootprintChallenge (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  return !RETURN_ERROR(SpdmChallenge (Footprint->RequesterContext, 0, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, Footprint->ResponseMessage));
+}
+
+BOOLEAN
+TestFootprintGetMeasurement (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  UINT8   NumberOfBlocks;
+  UINT32  MeasurementRecordLength;
+
+  MeasurementRecordLength = MAX_SPDM_MEASUREMENT_RECORD_SIZE;
+  return !RETURN_ERROR(SpdmGetMeasurement (
+                         Footprint->RequesterContext,
+                         NULL,
+                         SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE,
+                         SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS,
+                         0,
+                         &NumberOfBlocks,
+                         &MeasurementRecordLength,
+                         Footprint->ResponseMessage
+                         ));
+}
+
+/**
+  Start a session with a pre-shared key or with an ephemeral key exchange.
+
+  @param  Footprint                    The footprint context.
+  @param  UsePsk                       TRUE for PSK_EXCHANGE and PSK_FINISH, FALSE for KEY_EXCHANGE and FINISH.
+**/
+BOOLEAN
+TestFootprintStartSessionCommon (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint,
+  IN BOOLEAN                 UsePsk
+  )
+{
+  UINT8  HeartbeatPeriod;
+
+  return !RETURN_ERROR(SpdmStartSession (
+                         Footprint->RequesterContext,
+                         UsePsk,
+                         SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH,
+                         0,
+                         &Footprint->SessionId,
+                         &HeartbeatPeriod,
+                         Footprint->ResponseMessage
+                         ));
+}
+
+BOOLEAN
+TestFootprintStartSession (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  return TestFootprintStartSessionCommon (Footprint, FALSE);
+}
+
+BOOLEAN
+TestFootprintStartPskSession (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  return TestFootprintStartSessionCommon (Footprint, TRUE);
+}
+
+BOOLEAN
+TestFootprintSendReceiveData (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  UINTN  ResponseSize;
+
+  ResponseSize = TEST_FOOTPRINT_TRANSPORT_BUFFER_SIZE;
+  if (RETURN_ERROR(SpdmSendReceiveData (
+                     Footprint->RequesterContext,
+                     &Footprint->SessionId,
+                     TRUE,
+                     Footprint->Message,
+                     TEST_FOOTPRINT_APP_MESSAGE_SIZE,
+                     Footprint->ResponseMessage,
+                     &ResponseSize
+                     ))) {
+    return FALSE;
+  }
+  return (ResponseSize == TEST_FOOTPRINT_APP_MESSAGE_SIZE);
+}
+
+BOOLEAN
+TestFootprintHeartbeat (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  return !RETURN_ERROR(SpdmHeartbeat (Footprint->RequesterContext, Footprint->SessionId));
+}
+
+BOOLEAN
+TestFootprintKeyUpdate (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  return !RETURN_ERROR(SpdmKeyUpdate (Footprint->RequesterContext, Footprint->SessionId, FALSE));
+}
+
+BOOLEAN
+TestFootprintStopSession (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  return !RETURN_ERROR(SpdmStopSession (Footprint->RequesterContext, Footprint->SessionId, 0));
+}
+
+//
+// The entry points of the requester, in the order of the flow. Each one needs the previous ones.
+//
+TEST_FOOTPRINT_ENTRY  mTestFootprintEntry[] = {
+  {"SpdmInitConnection",         TestFootprintInitConnection},
+  {"SpdmGetDigest",              TestFootprintGetDigest},
+  {"SpdmGetCertificate",         TestFootprintGetCertificate},
+  {"SpdmChallenge",              TestFootprintChallenge},
+  {"SpdmGetMeasurement",         TestFootprintGetMeasurement},
+  {"SpdmStartSession",           TestFootprintStartSession},
+  {"SpdmSendReceiveData",        TestFootprintSendReceiveData},
+  {"SpdmHeartbeat",              TestFootprintHeartbeat},
+  {"SpdmKeyUpdate",              TestFootprintKeyUpdate},
+  {"SpdmStopSession",            TestFootprintStopSession},
+  {"SpdmStartSession(PSK)",      TestFootprintStartPskSession},
+  {"SpdmStopSession(PSK)",       TestFootprintStopSession},
+};
+
+/**
+  Print the context sizes for each limit of SPDM_CONTEXT_CONFIG.
+**/
+VOID
+TestFootprintContextSize (
+  VOID
+  )
+{
+  UINTN                  Index;
+  TEST_FOOTPRINT_CONFIG  *Config;
+
+  printf ("config,max_message_size,max_cert_chain_size,max_session_count,spdm_context_size,secured_message_context_size\n");
+  for (Index = 0; Index < ARRAY_SIZE(mTestFootprintConfig); Index++) {
+    Config = &mTestFootprintConfig[Index];
+    printf (
+      "%s,%u,%u,%u,%u,%u\n",
+      Config->Name,
+      (UINT32)((Config->Config.MaxSpdmMessageSize != 0) ? Config->Config.MaxSpdmMessageSize : MAX_SPDM_MESSAGE_BUFFER_SIZE),
+      (UINT32)((Config->Config.MaxCertChainSize != 0) ? Config->Config.MaxCertChainSize : MAX_SPDM_CERT_CHAIN_SIZE),
+      (UINT32)((Config->Config.MaxSessionCount != 0) ? Config->Config.MaxSessionCount : MAX_SPDM_SESSION_COUNT),
+      (UINT32)SpdmGetContextSizeEx (&Config->Config),
+      (UINT32)SpdmSecuredMessageGetContextSize ()
+      );
+  }
+  printf ("\n");
+}
+
+/**
+  Run the entry points of the requester in the order of the flow, and print the footprint of each.
+
+  @param  Footprint                    The footprint context.
+
+  @retval TRUE   All entry points succeeded.
+  @retval FALSE  An entry point failed. The next ones are not run.
+**/
+BOOLEAN
+TestFootprintRunEntries (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  UINTN                 Index;
+  TEST_FOOTPRINT_ENTRY  *Entry;
+  BOOLEAN               Result;
+  BOOLEAN               ArenaSet;
+  UINTN                 Allocations;
+  UINTN                 Stack;
+  UINTN                 HeapPeak;
+  CHAR8                 HeapPeakString[32];
+
+  for (Index = 0; Index < ARRAY_SIZE(mTestFootprintEntry); Index++) {
+    Entry = &mTestFootprintEntry[Index];
+
+    ArenaSet = SetPoolArena (Footprint->Arena, TEST_FOOTPRINT_ARENA_SIZE, FALSE);
+    Allocations = GetPoolAllocationCount ();
+    TestFootprintStackProbe (TRUE);
+    Result = Entry->Func (Footprint);
+    Stack = TestFootprintStackProbe (FALSE);
+    Allocations = GetPoolAllocationCount () - Allocations;
+    HeapPeak = GetPoolArenaPeakSize ();
+    //
+    // A block which outlives the entry point, such as a key of the session, keeps the arena until it is freed.
+    //
+    if (ArenaSet) {
+      ArenaSet = SetPoolArena (NULL, 0, FALSE);
+    }
+    if (ArenaSet) {
+      snprintf (HeapPeakString, sizeof(HeapPeakString), "%u", (UINT32)HeapPeak);
+    } else {
+      snprintf (HeapPeakString, sizeof(HeapPeakString), "n/a");
+    }
+
+    printf (
+      "%s,%s,%s,%s,Requester,%s,%u,%s,%u,%s\n",
+      Footprint->Suite->AsymName,
+      Footprint->Suite->HashName,
+      Footprint->Suite->DheName,
+      Footprint->Suite->AeadName,
+      Entry->Name,
+      (UINT32)Stack,
+      HeapPeakString,
+      (UINT32)Allocations,
+      Result ? "ok" : "fail"
+      );
+    if (!Result) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+  Print the deepest stack of the responder for each request code it processed.
+
+  @param  Footprint                    The footprint context.
+**/
+VOID
+TestFootprintPrintResponder (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE(mTestFootprintRequest); Index++) {
+    if (mTestFootprintResponderStack[mTestFootprintRequest[Index].RequestCode] == 0) {
+      continue;
+    }
+    printf (
+      "%s,%s,%s,%s,Responder,%s,%u,n/a,n/a,ok\n",
+      Footprint->Suite->AsymName,
+      Footprint->Suite->HashName,
+      Footprint->Suite->DheName,
+      Footprint->Suite->AeadName,
+      mTestFootprintRequest[Index].Name,
+      (UINT32)mTestFootprintResponderStack[mTestFootprintRequest[Index].RequestCode]
+      );
+  }
+  if (mTestFootprintResponderAppStack != 0) {
+    printf (
+      "%s,%s,%s,%s,Responder,APP_MESSAGE,%u,n/a,n/a,ok\n",
+      Footprint->Suite->AsymName,
+      Footprint->Suite->HashName,
+      Footprint->Suite->DheName,
+      Footprint->Suite->AeadName,
+      (UINT32)mTestFootprintResponderAppStack
+      );
+  }
+}
+
+/**
+  Report the footprint of all entry points for one algorithm suite, with a new requester and a new responder.
+
+  @param  Footprint                    The footprint context.
+  @param  Suite                        The algorithm suite.
+**/
+VOID
+TestFootprintSuite (
+  IN TEST_FOOTPRINT_CONTEXT  *Footprint,
+  IN TEST_FOOTPRINT_SUITE    *Suite
+  )
+{
+  VOID   *RequesterState;
+  VOID   *ResponderState;
+
+  Footprint->Suite = Suite;
+  Footprint->PrivateKey = NULL;
+  Footprint->CertChain = NULL;
+  Footprint->RootCert = NULL;
+  ZeroMem (mTestFootprintResponderStack, sizeof(mTestFootprintResponderStack));
+  mTestFootprintResponderAppStack = 0;
+
+  SetupSpdmTestContext (&mTestFootprintRequesterContext);
+  if (SpdmUnitTestGroupSetup (&RequesterState) != 0) {
+    return ;
+  }
+  SetupSpdmTestContext (&mTestFootprintResponderContext);
+  if (SpdmUnitTestGroupSetup (&ResponderState) != 0) {
+    SpdmUnitTestGroupTeardown (&RequesterState);
+    return ;
+  }
+  Footprint->RequesterContext = mTestFootprintRequesterContext.SpdmContext;
+  Footprint->ResponderContext = mTestFootprintResponderContext.SpdmContext;
+
+  TestFootprintSetupAlgorithms (Footprint->RequesterContext, Suite, TEST_FOOTPRINT_REQUESTER_CAPABILITY_FLAGS);
+  TestFootprintSetupAlgorithms (Footprint->ResponderContext, Suite, TEST_FOOTPRINT_RESPONDER_CAPABILITY_FLAGS);
+  SpdmRegisterGetResponseFunc (Footprint->ResponderContext, TestFootprintEchoAppMessage);
+
+  if (!TestFootprintProvision (Footprint)) {
+    printf (
+      "%s,%s,%s,%s,Requester,Setup,0,0,0,fail\n",
+      Suite->AsymName,
+      Suite->HashName,
+      Suite->DheName,
+      Suite->AeadName
+      );
+  } else {
+    TestFootprintRunEntries (Footprint);
+    TestFootprintPrintResponder (Footprint);
+  }
+
+  SpdmUnitTestGroupTeardown (&ResponderState);
+  SpdmUnitTestGroupTeardown (&RequesterState);
+  if (Footprint->PrivateKey != NULL) {
+    SpdmResponderDataReleaseKeyFunc (Suite->BaseAsymAlgo, Footprint->PrivateKey);
+  }
+  if (Footprint->CertChain != NULL) {
+    free (Footprint->CertChain);
+  }
+  if (Footprint->RootCert != NULL) {
+    free (Footprint->RootCert);
+  }
+}
+
+/**
+  Entry Point of SPDM RAM Footprint Report Utility.
+**/
+int main(int argc, char *argv[])
+{
+  TEST_FOOTPRINT_CONTEXT  Footprint;
+  UINTN                   Index;
+
+  ZeroMem (&Footprint, sizeof(Footprint));
+  mTestFootprintRequesterContext.SendMessage = TestFootprintSendMessage;
+  mTestFootprintRequesterContext.ReceiveMessage = TestFootprintReceiveMessage;
+  Footprint.Arena = AllocatePool (TEST_FOOTPRINT_ARENA_SIZE);
+  Footprint.Message = AllocatePool (TEST_FOOTPRINT_TRANSPORT_BUFFER_SIZE * 2);
+  if ((Footprint.Arena == NULL) || (Footprint.Message == NULL)) {
+    return 1;
+  }
+  Footprint.ResponseMessage = Footprint.Message + TEST_FOOTPRINT_TRANSPORT_BUFFER_SIZE;
+  SpdmGetRandomNumber (TEST_FOOTPRINT_APP_MESSAGE_SIZE, Footprint.Message);
+  Footprint.Message[0] = TEST_FOOTPRINT_APP_MESSAGE_TYPE;
+
+  TestFootprintContextSize ();
+
+  printf ("asym,hash,dhe,aead,side,entry,stack_peak,heap_peak,allocs,status\n");
+  for (Index = 0; Index < ARRAY_SIZE(mTestFootprintSuite); Index++) {
+    TestFootprintSuite (&Footprint, &mTestFootprintSuite[Index]);
+  }
+
+  FreePool (Footprint.Message);
+  //
+  // The arena is kept if a block allocated from it is still outstanding.
+  //
+  if (SetPoolArena (NULL, 0, FALSE)) {
+    FreePool (Footprint.Arena);
+  }
+  return 0;
+}
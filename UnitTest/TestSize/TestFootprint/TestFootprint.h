@@ -0,0 +1,54 @@
+/** @file
+  Application for SPDM RAM Footprint Report.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __TEST_FOOTPRINT_H__
+#define __TEST_FOOTPRINT_H__
+
+#include "SpdmUnitTest.h"
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SpdmSecuredMessageLib.h>
+#include <Library/SpdmDeviceSecretLib.h>
+
+//
+// Size of the transport message buffer between the requester and the responder.
+//
+#define TEST_FOOTPRINT_TRANSPORT_BUFFER_SIZE  (MAX_SPDM_MESSAGE_BUFFER_SIZE + 0x100)
+
+//
+// The application message echoed by the responder.
+// The first byte is the message type of the test transport, which must not be an SPDM message type.
+//
+#define TEST_FOOTPRINT_APP_MESSAGE_SIZE  64
+#define TEST_FOOTPRINT_APP_MESSAGE_TYPE  0x80
+
+//
+// Size of the arena which records the heap high water mark of one entry point.
+//
+#define TEST_FOOTPRINT_ARENA_SIZE  SIZE_4MB
+
+//
+// Size of the stack region painted below the caller to record the stack depth of one entry point.
+//
+#define TEST_FOOTPRINT_STACK_PROBE_SIZE  SIZE_256KB
+
+/**
+  Paint the stack region below the caller, or measure how deep it was used since it was painted.
+
+  The same function paints and measures, so that the region is at the same place in both calls.
+  It must be called from the same function as the code which is measured.
+
+  @param  Paint                        TRUE to paint the region, FALSE to measure it.
+
+  @return the size in bytes of the region used since it was painted, or 0 when it is painted.
+**/
+UINTN
+TestFootprintStackProbe (
+  IN BOOLEAN  Paint
+  );
+
+#endif
@@ -0,0 +1,419 @@
+/**
+@file
+SpdmAppraisalLib Tests
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmUnitTest.h"
+#include <Library/SpdmAppraisalLib.h>
+
+#define TEST_APPRAISAL_MAX_REFERENCE_COUNT  8
+#define TEST_APPRAISAL_DIGEST_SIZE          48
+
+#define TEST_APPRAISAL_MANIFEST_1           1
+#define TEST_APPRAISAL_MANIFEST_2           2
+
+typedef struct {
+  UINT8                Buffer[1024];
+  UINTN                Length;
+  UINT8                NumberOfBlocks;
+} TEST_APPRAISAL_RECORD;
+
+/**
+  Allocate and initialize an empty reference database.
+**/
+VOID *
+TestAppraisalNewDatabase (
+  IN UINT32  MaxReferenceCount
+  )
+{
+  VOID           *Database;
+  UINTN          DatabaseSize;
+  RETURN_STATUS  Status;
+
+  DatabaseSize = SpdmAppraisalGetDatabaseSize (MaxReferenceCount);
+  assert_int_not_equal (DatabaseSize, 0);
+  Database = malloc (DatabaseSize);
+  assert_non_null (Database);
+  Status = SpdmAppraisalInitDatabase (Database, DatabaseSize, MaxReferenceCount);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  return Database;
+}
+
+/**
+  Fill a digest with a pattern of a measurement index and a seed.
+**/
+VOID
+TestAppraisalDigest (
+  OUT UINT8  Digest[TEST_APPRAISAL_DIGEST_SIZE],
+  IN  UINT8  Index,
+  IN  UINT8  Seed
+  )
+{
+  UINTN  Offset;
+
+  for (Offset = 0; Offset < TEST_APPRAISAL_DIGEST_SIZE; Offset++) {
+    Digest[Offset] = (UINT8)(Index * 0x10 + Seed + Offset);
+  }
+}
+
+/**
+  Append a measurement block to a measurement record.
+**/
+VOID
+TestAppraisalAppendBlock (
+  IN OUT TEST_APPRAISAL_RECORD  *Record,
+  IN     UINT8                  Index,
+  IN     UINT8                  MeasurementSpecification,
+  IN     UINT8                  ValueType,
+  IN     CONST UINT8            *Value,
+  IN     UINTN                  ValueSize
+  )
+{
+  SPDM_MEASUREMENT_BLOCK_COMMON_HEADER  *CommonHeader;
+  SPDM_MEASUREMENT_BLOCK_DMTF_HEADER    *DmtfHeader;
+
+  assert_true (Record->Length + sizeof(*CommonHeader) + sizeof(*DmtfHeader) + ValueSize <= sizeof(Record->Buffer));
+  CommonHeader = (VOID *)(Record->Buffer + Record->Length);
+  CommonHeader->Index = Index;
+  CommonHeader->MeasurementSpecification = MeasurementSpecification;
+  CommonHeader->MeasurementSize = (UINT16)(sizeof(*DmtfHeader) + ValueSize);
+  DmtfHeader = (VOID *)(CommonHeader + 1);
+  DmtfHeader->DMTFSpecMeasurementValueType = ValueType;
+  DmtfHeader->DMTFSpecMeasurementValueSize = (UINT16)ValueSize;
+  CopyMem (DmtfHeader + 1, Value, ValueSize);
+  Record->Length += sizeof(*CommonHeader) + sizeof(*DmtfHeader) + ValueSize;
+  Record->NumberOfBlocks++;
+}
+
+/**
+  Append a DMTF measurement block, of the mutable firmware, with the digest of a measurement index and a seed.
+**/
+VOID
+TestAppraisalAppendDigestBlock (
+  IN OUT TEST_APPRAISAL_RECORD  *Record,
+  IN     UINT8                  Index,
+  IN     UINT8                  Seed
+  )
+{
+  UINT8  Digest[TEST_APPRAISAL_DIGEST_SIZE];
+
+  TestAppraisalDigest (Digest, Index, Seed);
+  TestAppraisalAppendBlock (Record, Index, SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF,
+    SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE, Digest, sizeof(Digest));
+}
+
+/**
+  Appraise a measurement record, and check the result of each measurement block.
+**/
+RETURN_STATUS
+TestAppraisalAppraise (
+  IN VOID                   *Database,
+  IN UINT32                 ManifestId,
+  IN TEST_APPRAISAL_RECORD  *Record,
+  IN CONST UINT8            *ExpectedStatus,
+  IN CONST UINT32           *ExpectedManifestId
+  )
+{
+  SPDM_APPRAISAL_RESULT  Results[16];
+  UINTN                  ResultCount;
+  UINTN                  Index;
+  RETURN_STATUS          Status;
+
+  ResultCount = ARRAY_SIZE(Results);
+  Status = SpdmAppraiseMeasurementRecord (Database, ManifestId, Record->NumberOfBlocks, Record->Length, Record->Buffer,
+             &ResultCount, Results);
+  if (RETURN_ERROR(Status) && (Status != RETURN_SECURITY_VIOLATION)) {
+    return Status;
+  }
+  assert_int_equal (ResultCount, Record->NumberOfBlocks);
+  for (Index = 0; Index < ResultCount; Index++) {
+    assert_int_equal (Results[Index].Status, ExpectedStatus[Index]);
+    assert_int_equal (Results[Index].ManifestId, ExpectedManifestId[Index]);
+  }
+  return Status;
+}
+
+/**
+  Reference values are found by their key among colliding keys and manifests, and a match reports its manifest.
+**/
+void TestSpdmAppraisalCase1(void **state) {
+  VOID                   *Database;
+  TEST_APPRAISAL_RECORD  Manifest;
+  TEST_APPRAISAL_RECORD  Record;
+  UINT8                  ExpectedStatus[4];
+  UINT32                 ExpectedManifestId[4];
+  UINT8                  Digest[TEST_APPRAISAL_DIGEST_SIZE];
+  UINT8                  Index;
+  RETURN_STATUS          Status;
+
+  //
+  // Eight reference values in eight buckets, so that some bucket chains hold several reference values.
+  //
+  Database = TestAppraisalNewDatabase (TEST_APPRAISAL_MAX_REFERENCE_COUNT);
+  ZeroMem (&Manifest, sizeof(Manifest));
+  for (Index = 1; Index <= 4; Index++) {
+    TestAppraisalAppendDigestBlock (&Manifest, Index, 0x01);
+  }
+  Status = SpdmAppraisalLoadManifest (Database, TEST_APPRAISAL_MANIFEST_1, Manifest.Length, Manifest.Buffer);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  ZeroMem (&Manifest, sizeof(Manifest));
+  for (Index = 1; Index <= 4; Index++) {
+    TestAppraisalAppendDigestBlock (&Manifest, Index, 0x02);
+  }
+  Status = SpdmAppraisalLoadManifest (Database, TEST_APPRAISAL_MANIFEST_2, Manifest.Length, Manifest.Buffer);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  //
+  // Each reference value is found, with its manifest.
+  //
+  ZeroMem (&Record, sizeof(Record));
+  TestAppraisalAppendDigestBlock (&Record, 1, 0x01);
+  TestAppraisalAppendDigestBlock (&Record, 2, 0x02);
+  TestAppraisalAppendDigestBlock (&Record, 3, 0x01);
+  TestAppraisalAppendDigestBlock (&Record, 4, 0x02);
+  for (Index = 0; Index < 4; Index++) {
+    ExpectedStatus[Index] = SpdmAppraisalMatch;
+    ExpectedManifestId[Index] = ((Index & 1) == 0) ? TEST_APPRAISAL_MANIFEST_1 : TEST_APPRAISAL_MANIFEST_2;
+  }
+  Status = TestAppraisalAppraise (Database, SPDM_APPRAISAL_ANY_MANIFEST, &Record, ExpectedStatus, ExpectedManifestId);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  //
+  // With a manifest, only its reference values match.
+  //
+  for (Index = 0; Index < 4; Index++) {
+    ExpectedStatus[Index] = ((Index & 1) == 0) ? SpdmAppraisalMatch : SpdmAppraisalMismatch;
+    ExpectedManifestId[Index] = ((Index & 1) == 0) ? TEST_APPRAISAL_MANIFEST_1 : SPDM_APPRAISAL_ANY_MANIFEST;
+  }
+  Status = TestAppraisalAppraise (Database, TEST_APPRAISAL_MANIFEST_1, &Record, ExpectedStatus, ExpectedManifestId);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+
+  //
+  // The same digest in another measurement index is not a reference value of that index.
+  //
+  TestAppraisalDigest (Digest, 1, 0x01);
+  ZeroMem (&Record, sizeof(Record));
+  TestAppraisalAppendBlock (&Record, 2, SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF,
+    SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE, Digest, sizeof(Digest));
+  ExpectedStatus[0] = SpdmAppraisalMismatch;
+  ExpectedManifestId[0] = SPDM_APPRAISAL_ANY_MANIFEST;
+  Status = TestAppraisalAppraise (Database, SPDM_APPRAISAL_ANY_MANIFEST, &Record, ExpectedStatus, ExpectedManifestId);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+
+  //
+  // The database is full.
+  //
+  Status = SpdmAppraisalAddReference (Database, TEST_APPRAISAL_MANIFEST_1, 5, SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE,
+             Digest, sizeof(Digest));
+  assert_int_equal (Status, RETURN_OUT_OF_RESOURCES);
+  free (Database);
+}
+
+/**
+  A measurement value matches only a reference value of the same index, value type and digest.
+**/
+void TestSpdmAppraisalCase2(void **state) {
+  VOID                   *Database;
+  TEST_APPRAISAL_RECORD  Record;
+  UINT8                  ExpectedStatus[3];
+  UINT32                 ExpectedManifestId[3];
+  UINT8                  Digest[TEST_APPRAISAL_DIGEST_SIZE];
+  RETURN_STATUS          Status;
+
+  Database = TestAppraisalNewDatabase (TEST_APPRAISAL_MAX_REFERENCE_COUNT);
+  TestAppraisalDigest (Digest, 1, 0x01);
+  Status = SpdmAppraisalAddReference (Database, TEST_APPRAISAL_MANIFEST_1, 1, SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE,
+             Digest, sizeof(Digest));
+  assert_int_equal (Status, RETURN_SUCCESS);
+  TestAppraisalDigest (Digest, 2, 0x01);
+  Status = SpdmAppraisalAddReference (Database, TEST_APPRAISAL_MANIFEST_1, 2, SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE,
+             Digest, sizeof(Digest));
+  assert_int_equal (Status, RETURN_SUCCESS);
+  //
+  // Adding a reference value again does nothing.
+  //
+  Status = SpdmAppraisalAddReference (Database, TEST_APPRAISAL_MANIFEST_1, 2, SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE,
+             Digest, sizeof(Digest));
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  ZeroMem (&Record, sizeof(Record));
+  TestAppraisalAppendDigestBlock (&Record, 1, 0x01);
+  TestAppraisalAppendDigestBlock (&Record, 2, 0x01);
+  ExpectedStatus[0] = SpdmAppraisalMatch;
+  ExpectedStatus[1] = SpdmAppraisalMatch;
+  ExpectedManifestId[0] = TEST_APPRAISAL_MANIFEST_1;
+  ExpectedManifestId[1] = TEST_APPRAISAL_MANIFEST_1;
+  Status = TestAppraisalAppraise (Database, SPDM_APPRAISAL_ANY_MANIFEST, &Record, ExpectedStatus, ExpectedManifestId);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  //
+  // Another digest, a truncated digest, and another value type are mismatched.
+  //
+  ZeroMem (&Record, sizeof(Record));
+  TestAppraisalAppendDigestBlock (&Record, 1, 0x02);
+  TestAppraisalDigest (Digest, 2, 0x01);
+  TestAppraisalAppendBlock (&Record, 2, SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF,
+    SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE, Digest, sizeof(Digest) - 1);
+  TestAppraisalAppendBlock (&Record, 2, SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF,
+    SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_FIRMWARE_CONFIGURATION, Digest, sizeof(Digest));
+  ExpectedStatus[0] = SpdmAppraisalMismatch;
+  ExpectedStatus[1] = SpdmAppraisalMismatch;
+  ExpectedStatus[2] = SpdmAppraisalMismatch;
+  ExpectedManifestId[0] = SPDM_APPRAISAL_ANY_MANIFEST;
+  ExpectedManifestId[1] = SPDM_APPRAISAL_ANY_MANIFEST;
+  ExpectedManifestId[2] = SPDM_APPRAISAL_ANY_MANIFEST;
+  Status = TestAppraisalAppraise (Database, SPDM_APPRAISAL_ANY_MANIFEST, &Record, ExpectedStatus, ExpectedManifestId);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+
+  //
+  // A removed reference value no longer matches.
+  //
+  TestAppraisalDigest (Digest, 1, 0x01);
+  Status = SpdmAppraisalRemoveReference (Database, TEST_APPRAISAL_MANIFEST_1, 1, SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE,
+             Digest, sizeof(Digest));
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmAppraisalRemoveReference (Database, TEST_APPRAISAL_MANIFEST_1, 1, SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE,
+             Digest, sizeof(Digest));
+  assert_int_equal (Status, RETURN_NOT_FOUND);
+  free (Database);
+}
+
+/**
+  A measurement index without reference value, or a block that is not appraisable, is not a mismatch.
+**/
+void TestSpdmAppraisalCase3(void **state) {
+  VOID                   *Database;
+  TEST_APPRAISAL_RECORD  Manifest;
+  TEST_APPRAISAL_RECORD  Record;
+  UINT8                  ExpectedStatus[4];
+  UINT32                 ExpectedManifestId[4];
+  UINT8                  Digest[MAX_HASH_SIZE + 1];
+  RETURN_STATUS          Status;
+
+  Database = TestAppraisalNewDatabase (TEST_APPRAISAL_MAX_REFERENCE_COUNT);
+
+  //
+  // Nothing has reference values in an empty database.
+  //
+  ZeroMem (&Record, sizeof(Record));
+  TestAppraisalAppendDigestBlock (&Record, 1, 0x01);
+  ExpectedStatus[0] = SpdmAppraisalNoReference;
+  ExpectedManifestId[0] = SPDM_APPRAISAL_ANY_MANIFEST;
+  Status = TestAppraisalAppraise (Database, SPDM_APPRAISAL_ANY_MANIFEST, &Record, ExpectedStatus, ExpectedManifestId);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  //
+  // The blocks that are not appraisable are skipped when the manifest is loaded.
+  //
+  ZeroMem (&Manifest, sizeof(Manifest));
+  TestAppraisalAppendDigestBlock (&Manifest, 1, 0x01);
+  SetMem (Digest, sizeof(Digest), 0x5A);
+  TestAppraisalAppendBlock (&Manifest, 3, SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF,
+    SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE, Digest, sizeof(Digest));
+  TestAppraisalAppendBlock (&Manifest, 4, 0,
+    SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE, Digest, TEST_APPRAISAL_DIGEST_SIZE);
+  Status = SpdmAppraisalLoadManifest (Database, TEST_APPRAISAL_MANIFEST_1, Manifest.Length, Manifest.Buffer);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  ZeroMem (&Record, sizeof(Record));
+  TestAppraisalAppendDigestBlock (&Record, 1, 0x01);
+  TestAppraisalAppendDigestBlock (&Record, 2, 0x01);
+  TestAppraisalAppendBlock (&Record, 3, SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF,
+    SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE, Digest, sizeof(Digest));
+  TestAppraisalAppendBlock (&Record, 4, 0,
+    SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE, Digest, TEST_APPRAISAL_DIGEST_SIZE);
+  ExpectedStatus[0] = SpdmAppraisalMatch;
+  ExpectedStatus[1] = SpdmAppraisalNoReference;
+  ExpectedStatus[2] = SpdmAppraisalNotAppraisable;
+  ExpectedStatus[3] = SpdmAppraisalNotAppraisable;
+  ExpectedManifestId[0] = TEST_APPRAISAL_MANIFEST_1;
+  ExpectedManifestId[1] = SPDM_APPRAISAL_ANY_MANIFEST;
+  ExpectedManifestId[2] = SPDM_APPRAISAL_ANY_MANIFEST;
+  ExpectedManifestId[3] = SPDM_APPRAISAL_ANY_MANIFEST;
+  Status = TestAppraisalAppraise (Database, SPDM_APPRAISAL_ANY_MANIFEST, &Record, ExpectedStatus, ExpectedManifestId);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  //
+  // The measurement index has no reference value once its manifest is removed.
+  //
+  Status = SpdmAppraisalRemoveManifest (Database, TEST_APPRAISAL_MANIFEST_1);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmAppraisalRemoveManifest (Database, TEST_APPRAISAL_MANIFEST_1);
+  assert_int_equal (Status, RETURN_NOT_FOUND);
+  ExpectedStatus[0] = SpdmAppraisalNoReference;
+  ExpectedManifestId[0] = SPDM_APPRAISAL_ANY_MANIFEST;
+  Status = TestAppraisalAppraise (Database, SPDM_APPRAISAL_ANY_MANIFEST, &Record, ExpectedStatus, ExpectedManifestId);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  free (Database);
+}
+
+/**
+  Malformed records, a wrong number of blocks, a small result buffer, and a manifest larger than the free space.
+**/
+void TestSpdmAppraisalCase4(void **state) {
+  VOID                   *Database;
+  TEST_APPRAISAL_RECORD  Record;
+  SPDM_APPRAISAL_RESULT  Results[1];
+  UINTN                  ResultCount;
+  UINT8                  Index;
+  RETURN_STATUS          Status;
+
+  Database = TestAppraisalNewDatabase (2);
+
+  //
+  // Nothing is loaded from a manifest with more reference values than the free ones.
+  //
+  ZeroMem (&Record, sizeof(Record));
+  for (Index = 1; Index <= 3; Index++) {
+    TestAppraisalAppendDigestBlock (&Record, Index, 0x01);
+  }
+  Status = SpdmAppraisalLoadManifest (Database, TEST_APPRAISAL_MANIFEST_1, Record.Length, Record.Buffer);
+  assert_int_equal (Status, RETURN_OUT_OF_RESOURCES);
+  Status = SpdmAppraisalRemoveManifest (Database, TEST_APPRAISAL_MANIFEST_1);
+  assert_int_equal (Status, RETURN_NOT_FOUND);
+
+  ResultCount = ARRAY_SIZE(Results);
+  Status = SpdmAppraiseMeasurementRecord (Database, SPDM_APPRAISAL_ANY_MANIFEST, Record.NumberOfBlocks, Record.Length, Record.Buffer,
+             &ResultCount, Results);
+  assert_int_equal (Status, RETURN_BUFFER_TOO_SMALL);
+  assert_int_equal (ResultCount, Record.NumberOfBlocks);
+  assert_int_equal (Results[0].Index, 1);
+  assert_int_equal (Results[0].Status, SpdmAppraisalNoReference);
+
+  ResultCount = ARRAY_SIZE(Results);
+  Status = SpdmAppraiseMeasurementRecord (Database, SPDM_APPRAISAL_ANY_MANIFEST, Record.NumberOfBlocks + 1, Record.Length, Record.Buffer,
+             &ResultCount, Results);
+  assert_int_equal (Status, RETURN_UNSUPPORTED);
+
+  ResultCount = ARRAY_SIZE(Results);
+  Status = SpdmAppraiseMeasurementRecord (Database, SPDM_APPRAISAL_ANY_MANIFEST, Record.NumberOfBlocks, Record.Length - 1, Record.Buffer,
+             &ResultCount, Results);
+  assert_int_equal (Status, RETURN_UNSUPPORTED);
+  Status = SpdmAppraisalLoadManifest (Database, TEST_APPRAISAL_MANIFEST_1, Record.Length - 1, Record.Buffer);
+  assert_int_equal (Status, RETURN_UNSUPPORTED);
+  free (Database);
+}
+
+int SpdmAppraisalTestMain(void) {
+  const struct CMUnitTest SpdmAppraisalTests[] = {
+    // Indexed lookup among manifests
+    cmocka_unit_test(TestSpdmAppraisalCase1),
+    // Match and mismatch
+    cmocka_unit_test(TestSpdmAppraisalCase2),
+    // Missing reference measurement, not appraisable blocks
+    cmocka_unit_test(TestSpdmAppraisalCase3),
+    // Malformed records and limits
+    cmocka_unit_test(TestSpdmAppraisalCase4),
+  };
+
+  return cmocka_run_group_tests(SpdmAppraisalTests, NULL, NULL);
+}
+
+int main(void) {
+  SpdmAppraisalTestMain();
+  return 0;
+}
@@ -34,6 +34,92 @@ CONST UINT8 DMTF_OID[] = {
   0x2B, 0x06, 0x01, 0x4, 0x01, 0x83, 0x1C, 0x82, 0x12, 0x01
 };
 
+// NIST gcmEncryptExtIV256, PTlen = 0, AADlen = 128, Count = 0
+CONST UINT8 AeadMacAesGcmKey[] = {
+0x78, 0xDC, 0x4E, 0x0A, 0xAF, 0x52, 0xD9, 0x35, 0xC3, 0xC0, 0x1E, 0xEA, 0x57, 0x42, 0x8F, 0x00,
+0xCA, 0x1F, 0xD4, 0x75, 0xF5, 0xDA, 0x86, 0xA4, 0x9C, 0x8D, 0xD7, 0x3D, 0x68, 0xC8, 0xE2, 0x23
+};
+
+CONST UINT8 AeadMacAesGcmIv[] = {
+0xD7, 0x9C, 0xF2, 0x2D, 0x50, 0x4C, 0xC7, 0x93, 0xC3, 0xFB, 0x6C, 0x8A
+};
+
+CONST UINT8 AeadMacAesGcmAData[] = {
+0xB9, 0x6B, 0xAA, 0x8C, 0x1C, 0x75, 0xA6, 0x71, 0xBF, 0xB2, 0xD0, 0x8D, 0x06, 0xBE, 0x5F, 0x36
+};
+
+CONST UINT8 AeadMacAesGcmTag[] = {
+0x3E, 0x5D, 0x48, 0x6A, 0xA2, 0xE3, 0x0B, 0x22, 0xE0, 0x40, 0xB8, 0x57, 0x23, 0xA0, 0x6E, 0x76
+};
+
+// RFC 8439, section 2.8.2, with an empty plain text
+CONST UINT8 AeadMacChaCha20Poly1305Key[] = {
+0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F
+};
+
+CONST UINT8 AeadMacChaCha20Poly1305Iv[] = {
+0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47
+};
+
+CONST UINT8 AeadMacChaCha20Poly1305AData[] = {
+0x50, 0x51, 0x52, 0x53, 0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7
+};
+
+/**
+  Check SpdmAeadMac and SpdmAeadVerifyMac of an AEAD cipher suite against the AEAD over an empty plain text,
+  and against the expected tag if it is given.
+**/
+VOID
+TestSpdmCryptLibCheckAeadMac (
+  IN UINT16         AEADCipherSuite,
+  IN CONST UINT8    *Key,
+  IN UINTN          KeySize,
+  IN CONST UINT8    *Iv,
+  IN UINTN          IvSize,
+  IN CONST UINT8    *AData,
+  IN UINTN          ADataSize,
+  IN CONST UINT8    *ExpectedTag OPTIONAL
+  )
+{
+  VOID          *AeadContext;
+  UINT8         Tag[16];
+  UINT8         EmptyPlainTextTag[16];
+  UINT8         DataOut[16];
+  UINTN         DataOutSize;
+  BOOLEAN       Status;
+
+  AeadContext = SpdmAeadNew (AEADCipherSuite);
+  assert_non_null (AeadContext);
+  Status = SpdmAeadSetKey (AEADCipherSuite, AeadContext, Key, KeySize);
+  assert_true (Status);
+
+  Status = SpdmAeadMac (AEADCipherSuite, AeadContext, Iv, IvSize, AData, ADataSize, Tag, sizeof(Tag));
+  assert_true (Status);
+  if (ExpectedTag != NULL) {
+    assert_memory_equal (Tag, ExpectedTag, sizeof(Tag));
+  }
+
+  DataOutSize = sizeof(DataOut);
+  Status = SpdmAeadEncryption (AEADCipherSuite, Key, KeySize, Iv, IvSize, AData, ADataSize, DataOut, 0,
+             EmptyPlainTextTag, sizeof(EmptyPlainTextTag), DataOut, &DataOutSize);
+  assert_true (Status);
+  assert_int_equal (DataOutSize, 0);
+  assert_memory_equal (Tag, EmptyPlainTextTag, sizeof(Tag));
+
+  Status = SpdmAeadVerifyMac (AEADCipherSuite, AeadContext, Iv, IvSize, AData, ADataSize, Tag, sizeof(Tag));
+  assert_true (Status);
+  Tag[0] ^= 0x01;
+  Status = SpdmAeadVerifyMac (AEADCipherSuite, AeadContext, Iv, IvSize, AData, ADataSize, Tag, sizeof(Tag));
+  assert_false (Status);
+  Tag[0] ^= 0x01;
+  Tag[sizeof(Tag) - 1] ^= 0x80;
+  Status = SpdmAeadVerifyMac (AEADCipherSuite, AeadContext, Iv, IvSize, AData, ADataSize, Tag, sizeof(Tag));
+  assert_false (Status);
+
+  SpdmAeadFree (AEADCipherSuite, AeadContext);
+}
+
 
 void TestSpdmCryptLib_SpdmGetDMTFSubjectAltNameFromBytes(void **state) {
   UINTN         CommonNameSize;
@@ -151,6 +237,114 @@ void TestSpdmCryptLib_SpdmX509CertificateCheck(void **state) {
   free (FileBuffer);
 }
 
+void TestSpdmCryptLib_SpdmCertChainView(void **state) {
+  SPDM_CERT_CHAIN_VIEW  View;
+  SPDM_X509_CERT_VIEW   CertView;
+  UINTN                 CommonNameSize;
+  CHAR8                 CommonName[64];
+  UINTN                 DMTFOidSize;
+  UINT8                 DMTFOid[64];
+  UINT8                 *FileBuffer;
+  UINTN                 FileBufferSize;
+  UINT8                 *Cert;
+  UINTN                 CertSize;
+  UINT8                 *ViewCert;
+  UINTN                 ViewCertSize;
+  INT32                 Index;
+  RETURN_STATUS         Ret;
+  BOOLEAN               Status;
+
+  Status = ReadInputFile ("EcP256/bundle_requester.certchain.der", (VOID **)&FileBuffer, &FileBufferSize);
+  assert_true(Status);
+  Status = SpdmCertChainViewInit (&View, FileBuffer, FileBufferSize);
+  assert_true(Status);
+  assert_int_equal((int)View.CertCount, 3);
+  for (Index = -1; Index < (INT32)View.CertCount; Index++) {
+    Status = X509GetCertFromCertChain (FileBuffer, FileBufferSize, Index, &Cert, &CertSize);
+    assert_true(Status);
+    Status = SpdmCertChainViewGetCert (&View, Index, &ViewCert, &ViewCertSize);
+    assert_true(Status);
+    assert_ptr_equal(ViewCert, Cert);
+    assert_int_equal((int)ViewCertSize, (int)CertSize);
+  }
+  Status = SpdmCertChainViewGetCert (&View, (INT32)View.CertCount, &ViewCert, &ViewCertSize);
+  assert_false(Status);
+
+  Status = SpdmX509CertViewParseFields (&View.Leaf);
+  assert_true(Status);
+  assert_true(View.Leaf.Tbs > View.Leaf.Cert);
+  assert_true(View.Leaf.SubjectPublicKeyInfo > View.Leaf.Tbs);
+  assert_true(View.Leaf.Signature + View.Leaf.SignatureSize == View.Leaf.Cert + View.Leaf.CertSize);
+  assert_non_null(View.Leaf.SubjectAltName);
+  DMTFOidSize = 64;
+  CommonNameSize = 64;
+  Ret = SpdmGetDMTFSubjectAltNameFromBytes(View.Leaf.SubjectAltName, View.Leaf.SubjectAltNameSize, CommonName, &CommonNameSize, DMTFOid, &DMTFOidSize);
+  assert_int_equal((int)Ret, RETURN_SUCCESS);
+  assert_memory_equal(DMTF_OID, DMTFOid, sizeof (DMTF_OID));
+  assert_string_equal(CommonName, "ACME:WIDGET:1234567890");
+  assert_int_equal((int)View.Leaf.TbsSignatureAlgorithmSize, (int)View.Leaf.SignatureAlgorithmSize);
+  assert_memory_equal(View.Leaf.TbsSignatureAlgorithm, View.Leaf.SignatureAlgorithm, View.Leaf.SignatureAlgorithmSize);
+  assert_non_null(View.Leaf.BasicConstraints);
+  assert_false(View.Leaf.OtherCriticalExtension);
+
+  Status = SpdmCertChainViewGetCert (&View, 1, &ViewCert, &ViewCertSize);
+  assert_true(Status);
+  SpdmX509CertViewInit (&CertView, ViewCert, ViewCertSize);
+  Status = SpdmX509CertViewParseFields (&CertView);
+  assert_true(Status);
+  assert_int_equal((int)View.Leaf.IssuerSize, (int)CertView.SubjectSize);
+  assert_memory_equal(View.Leaf.Issuer, CertView.Subject, CertView.SubjectSize);
+  assert_non_null(CertView.KeyUsage);
+  assert_non_null(CertView.SubjectKeyIdentifier);
+
+  Status = SpdmCertChainViewInit (&View, FileBuffer, 1);
+  assert_false(Status);
+  free (FileBuffer);
+}
+
+void TestSpdmCryptLib_SpdmConstTimeCompareMem(void **state) {
+  UINT8         Buffer1[MAX_HASH_SIZE];
+  UINT8         Buffer2[MAX_HASH_SIZE];
+  UINTN         Index;
+
+  for (Index = 0; Index < sizeof(Buffer1); Index++) {
+    Buffer1[Index] = (UINT8)Index;
+  }
+  CopyMem (Buffer2, Buffer1, sizeof(Buffer2));
+  assert_int_equal((int)SpdmConstTimeCompareMem(Buffer1, Buffer2, sizeof(Buffer1)), 0);
+  assert_int_equal((int)SpdmConstTimeCompareMem(Buffer1, Buffer2, 0), 0);
+
+  Buffer2[0] ^= 0x80;
+  assert_int_not_equal((int)SpdmConstTimeCompareMem(Buffer1, Buffer2, sizeof(Buffer1)), 0);
+  Buffer2[0] ^= 0x80;
+  Buffer2[sizeof(Buffer2) - 1] ^= 0x01;
+  assert_int_not_equal((int)SpdmConstTimeCompareMem(Buffer1, Buffer2, sizeof(Buffer1)), 0);
+  assert_int_equal((int)SpdmConstTimeCompareMem(Buffer1, Buffer2, sizeof(Buffer1) - 1), 0);
+}
+
+void TestSpdmCryptLib_SpdmAeadMac(void **state) {
+  TestSpdmCryptLibCheckAeadMac (
+    SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM,
+    AeadMacAesGcmKey,
+    sizeof(AeadMacAesGcmKey),
+    AeadMacAesGcmIv,
+    sizeof(AeadMacAesGcmIv),
+    AeadMacAesGcmAData,
+    sizeof(AeadMacAesGcmAData),
+    AeadMacAesGcmTag
+    );
+  TestSpdmCryptLibCheckAeadMac (
+    SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305,
+    AeadMacChaCha20Poly1305Key,
+    sizeof(AeadMacChaCha20Poly1305Key),
+    AeadMacChaCha20Poly1305Iv,
+    sizeof(AeadMacChaCha20Poly1305Iv),
+    AeadMacChaCha20Poly1305AData,
+    sizeof(AeadMacChaCha20Poly1305AData),
+    NULL
+    );
+}
+
 int Setup(void **state)
 {
   return 0;
@@ -165,7 +359,10 @@ int SpdmCryptLibTestMain(void) {
   const struct CMUnitTest SpdmCryptLibTests[] = {
       cmocka_unit_test(TestSpdmCryptLib_SpdmGetDMTFSubjectAltNameFromBytes),
       cmocka_unit_test(TestSpdmCryptLib_SpdmGetDMTFSubjectAltName),
-      cmocka_unit_test(TestSpdmCryptLib_SpdmX509CertificateCheck)
+      cmocka_unit_test(TestSpdmCryptLib_SpdmX509CertificateCheck),
+      cmocka_unit_test(TestSpdmCryptLib_SpdmCertChainView),
+      cmocka_unit_test(TestSpdmCryptLib_SpdmConstTimeCompareMem),
+      cmocka_unit_test(TestSpdmCryptLib_SpdmAeadMac)
   };
 
   return cmocka_run_group_tests(SpdmCryptLibTests, Setup, TearDown);
@@ -23,6 +23,7 @@ int SpdmRequesterPskExchangeTestMain (void);
 int SpdmRequesterPskFinishTestMain (void);
 int SpdmRequesterHeartbeatTestMain (void);
 int SpdmRequesterEndSessionTestMain (void);
+int SpdmRequesterStepTestMain (void);
 
 int main(void) {
   SpdmRequesterGetVersionTestMain();
@@ -50,5 +51,7 @@ int main(void) {
   SpdmRequesterHeartbeatTestMain();
 
   SpdmRequesterEndSessionTestMain();
+
+  SpdmRequesterStepTestMain();
   return 0;
 }
@@ -12,6 +12,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 STATIC UINTN                  LocalBufferSize;
 STATIC UINT8                  LocalBuffer[MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+STATIC UINT64                 LocalReceiveTimeout;
 
 RETURN_STATUS
 EFIAPI
@@ -76,6 +77,11 @@ SpdmRequesterChallengeTestSendMessage (
     }
   }
     return RETURN_SUCCESS;
+  case 0xA:
+    LocalBufferSize = 0;
+    CopyMem (LocalBuffer, &Ptr[1], RequestSize - 1);
+    LocalBufferSize += (RequestSize - 1);
+    return RETURN_SUCCESS;
   default:
     return RETURN_DEVICE_ERROR;
   }
@@ -383,6 +389,10 @@ SpdmRequesterChallengeTestReceiveMessage (
   }
     return RETURN_SUCCESS;
 
+  case 0xA:
+    LocalReceiveTimeout = Timeout;
+    return RETURN_TIMEOUT;
+
   default:
     return RETURN_DEVICE_ERROR;
   }
@@ -405,7 +415,7 @@ void TestSpdmRequesterChallengeCase1(void **state) {
   SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
   ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
   SpdmContext->Transcript.MessageA.BufferSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->Transcript.MessageC.BufferSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
@@ -436,7 +446,7 @@ void TestSpdmRequesterChallengeCase2(void **state) {
   SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
   ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
   SpdmContext->Transcript.MessageA.BufferSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->Transcript.MessageC.BufferSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
@@ -466,7 +476,7 @@ void TestSpdmRequesterChallengeCase3(void **state) {
   SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
   ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
   SpdmContext->Transcript.MessageA.BufferSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->Transcript.MessageC.BufferSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
@@ -497,7 +507,7 @@ void TestSpdmRequesterChallengeCase4(void **state) {
   SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
   ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
   SpdmContext->Transcript.MessageA.BufferSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->Transcript.MessageC.BufferSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
@@ -528,7 +538,7 @@ void TestSpdmRequesterChallengeCase5(void **state) {
   SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
   ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
   SpdmContext->Transcript.MessageA.BufferSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->Transcript.MessageC.BufferSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
@@ -559,7 +569,7 @@ void TestSpdmRequesterChallengeCase6(void **state) {
   SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
   ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
   SpdmContext->Transcript.MessageA.BufferSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->Transcript.MessageC.BufferSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
@@ -589,7 +599,7 @@ void TestSpdmRequesterChallengeCase7(void **state) {
   SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
   ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
   SpdmContext->Transcript.MessageA.BufferSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->Transcript.MessageC.BufferSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
@@ -621,7 +631,7 @@ void TestSpdmRequesterChallengeCase8(void **state) {
   SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
   ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
   SpdmContext->Transcript.MessageA.BufferSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->Transcript.MessageC.BufferSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
@@ -651,7 +661,7 @@ void TestSpdmRequesterChallengeCase9(void **state) {
   SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
   ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
   SpdmContext->Transcript.MessageA.BufferSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->Transcript.MessageC.BufferSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
@@ -664,6 +674,42 @@ void TestSpdmRequesterChallengeCase9(void **state) {
   free(Data);
 }
 
+void TestSpdmRequesterChallengeCase10(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT8                MeasurementHash[MAX_HASH_SIZE];
+  VOID                 *Data;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0xA;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
+  SpdmContext->ConnectionInfo.Capability.CTExponent = 20;
+  SpdmContext->LocalContext.TransportRoundTripTime = 1000;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
+  SpdmContext->Transcript.MessageC.BufferSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = DataSize;
+  CopyMem (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, Data, DataSize);
+
+  LocalReceiveTimeout = 0;
+  ZeroMem (MeasurementHash, sizeof(MeasurementHash));
+  Status = SpdmChallenge (SpdmContext, 0, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, MeasurementHash);
+  assert_int_equal (Status, RETURN_DEVICE_ERROR);
+  // RTT + CT, in 100ns units
+  assert_int_equal (LocalReceiveTimeout, (1000 + (1 << 20)) * 10);
+  SpdmContext->LocalContext.TransportRoundTripTime = 0;
+  free(Data);
+}
+
 SPDM_TEST_CONTEXT       mSpdmRequesterChallengeTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   TRUE,
@@ -691,6 +737,8 @@ int SpdmRequesterChallengeTestMain(void) {
       cmocka_unit_test(TestSpdmRequesterChallengeCase8),
       // SPDM_ERROR_CODE_RESPONSE_NOT_READY + Successful response
       cmocka_unit_test(TestSpdmRequesterChallengeCase9),
+      // The response timeout is RTT + CT
+      cmocka_unit_test(TestSpdmRequesterChallengeCase10),
   };
   
   SetupSpdmTestContext (&mSpdmRequesterChallengeTestContext);
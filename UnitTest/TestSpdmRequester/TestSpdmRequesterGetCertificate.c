@@ -56,6 +56,12 @@ SpdmRequesterGetCertificateTestSendMessage (
     return RETURN_SUCCESS;
   case 0xF:
     return RETURN_SUCCESS;
+  case 0x10:
+    return RETURN_SUCCESS;
+  case 0x11:
+    return RETURN_SUCCESS;
+  case 0x12:
+    return RETURN_SUCCESS;
   default:
     return RETURN_DEVICE_ERROR;
   }
@@ -636,6 +642,80 @@ SpdmRequesterGetCertificateTestReceiveMessage (
   }
     return RETURN_SUCCESS;
 
+  case 0x10:
+  case 0x11:
+  {
+      SPDM_CERTIFICATE_RESPONSE    *SpdmResponse;
+      UINT8                         TempBuf[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+      UINTN                         TempBufSize;
+      UINT16                        PortionLength;
+      UINT16                        RemainderLength;
+      UINTN                         Count;
+      STATIC UINTN                  CallingIndex = 0;
+
+      if (LocalCertificateChain == NULL) {
+        ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &LocalCertificateChain, &LocalCertificateChainSize, NULL, NULL);
+      }
+      Count = (LocalCertificateChainSize + MAX_SPDM_CERT_CHAIN_BLOCK_LEN + 1) / MAX_SPDM_CERT_CHAIN_BLOCK_LEN;
+      if (CallingIndex != Count - 1) {
+        PortionLength = MAX_SPDM_CERT_CHAIN_BLOCK_LEN;
+        RemainderLength = (UINT16)(LocalCertificateChainSize - MAX_SPDM_CERT_CHAIN_BLOCK_LEN * (CallingIndex + 1));
+      } else {
+        PortionLength = (UINT16)(LocalCertificateChainSize - MAX_SPDM_CERT_CHAIN_BLOCK_LEN * (Count - 1));
+        RemainderLength = 0;
+      }
+
+      TempBufSize = sizeof(SPDM_CERTIFICATE_RESPONSE) + PortionLength;
+      SpdmResponse = (VOID *)TempBuf;
+
+      SpdmResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+      SpdmResponse->Header.RequestResponseCode = SPDM_CERTIFICATE;
+      SpdmResponse->Header.Param1 = 0;
+      SpdmResponse->Header.Param2 = 0;
+      SpdmResponse->PortionLength = PortionLength;
+      SpdmResponse->RemainderLength = RemainderLength;
+      CopyMem (SpdmResponse + 1, (UINT8 *)LocalCertificateChain + MAX_SPDM_CERT_CHAIN_BLOCK_LEN * CallingIndex, PortionLength);
+
+      SpdmTransportTestEncodeMessage (SpdmContext, NULL, FALSE, FALSE, TempBufSize, TempBuf, ResponseSize, Response);
+
+      CallingIndex++;
+      if (CallingIndex == Count) {
+        CallingIndex = 0;
+        free (LocalCertificateChain);
+        LocalCertificateChain = NULL;
+        LocalCertificateChainSize = 0;
+      }
+  }
+    return RETURN_SUCCESS;
+
+  case 0x12:
+  {
+      SPDM_CERTIFICATE_RESPONSE    *SpdmResponse;
+      UINT8                         TempBuf[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+      UINTN                         TempBufSize;
+
+      // the whole certificate chain in one response
+      ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &LocalCertificateChain, &LocalCertificateChainSize, NULL, NULL);
+
+      TempBufSize = sizeof(SPDM_CERTIFICATE_RESPONSE) + LocalCertificateChainSize;
+      SpdmResponse = (VOID *)TempBuf;
+
+      SpdmResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+      SpdmResponse->Header.RequestResponseCode = SPDM_CERTIFICATE;
+      SpdmResponse->Header.Param1 = 0;
+      SpdmResponse->Header.Param2 = 0;
+      SpdmResponse->PortionLength = (UINT16)LocalCertificateChainSize;
+      SpdmResponse->RemainderLength = 0;
+      CopyMem (SpdmResponse + 1, LocalCertificateChain, LocalCertificateChainSize);
+
+      SpdmTransportTestEncodeMessage (SpdmContext, NULL, FALSE, FALSE, TempBufSize, TempBuf, ResponseSize, Response);
+
+      free (LocalCertificateChain);
+      LocalCertificateChain = NULL;
+      LocalCertificateChainSize = 0;
+  }
+    return RETURN_SUCCESS;
+
   default:
     return RETURN_DEVICE_ERROR;
   }
@@ -643,7 +723,7 @@ SpdmRequesterGetCertificateTestReceiveMessage (
 
 /**
   Test 1: message could not be sent
-  Expected Behavior: get a RETURN_DEVICE_ERROR, with no CERTIFICATE messages received (checked in Transcript.MessageB buffer)
+  Expected Behavior: get a RETURN_DEVICE_ERROR, with no CERTIFICATE messages received (checked in Transcript.MessageBDigest)
 **/
 void TestSpdmRequesterGetCertificateCase1(void **state) {
   RETURN_STATUS        Status;
@@ -666,14 +746,14 @@ void TestSpdmRequesterGetCertificateCase1(void **state) {
   SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
   SpdmContext->LocalContext.PeerCertChainProvision = NULL;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
 
   CertChainSize = sizeof(CertChain);
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
   free(Data);
 }
 
@@ -704,20 +784,20 @@ void TestSpdmRequesterGetCertificateCase2(void **state) {
   SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
   SpdmContext->LocalContext.PeerCertChainProvision = NULL;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
 
   CertChainSize = sizeof(CertChain);
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_SUCCESS);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
   free(Data);
 }
 
 /**
   Test 3: simulate wrong ConnectionState when sending GET_CERTIFICATE (missing SPDM_GET_DIGESTS_RECEIVE_FLAG and SPDM_GET_CAPABILITIES_RECEIVE_FLAG)
-  Expected Behavior: get a RETURN_UNSUPPORTED, with no CERTIFICATE messages received (checked in Transcript.MessageB buffer)
+  Expected Behavior: get a RETURN_UNSUPPORTED, with no CERTIFICATE messages received (checked in Transcript.MessageBDigest)
 **/
 void TestSpdmRequesterGetCertificateCase3(void **state) {
   RETURN_STATUS        Status;
@@ -740,20 +820,20 @@ void TestSpdmRequesterGetCertificateCase3(void **state) {
   SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
   SpdmContext->LocalContext.PeerCertChainProvision = NULL;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
 
   CertChainSize = sizeof(CertChain);
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_UNSUPPORTED);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
   free(Data);
 }
 
 /**
   Test 4: force responder to send an ERROR message with code SPDM_ERROR_CODE_INVALID_REQUEST
-  Expected Behavior: get a RETURN_DEVICE_ERROR, with no CERTIFICATE messages received (checked in Transcript.MessageB buffer)
+  Expected Behavior: get a RETURN_DEVICE_ERROR, with no CERTIFICATE messages received (checked in Transcript.MessageBDigest)
 **/
 void TestSpdmRequesterGetCertificateCase4(void **state) {
   RETURN_STATUS        Status;
@@ -776,20 +856,20 @@ void TestSpdmRequesterGetCertificateCase4(void **state) {
   SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
   SpdmContext->LocalContext.PeerCertChainProvision = NULL;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
 
   CertChainSize = sizeof(CertChain);
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
   free(Data);
 }
 
 /**
   Test 5: force responder to send an ERROR message with code SPDM_ERROR_CODE_BUSY
-  Expected Behavior: get a RETURN_NO_RESPONSE, with no CERTIFICATE messages received (checked in Transcript.MessageB buffer)
+  Expected Behavior: get a RETURN_NO_RESPONSE, with no CERTIFICATE messages received (checked in Transcript.MessageBDigest)
 **/
 void TestSpdmRequesterGetCertificateCase5(void **state) {
   RETURN_STATUS        Status;
@@ -812,14 +892,14 @@ void TestSpdmRequesterGetCertificateCase5(void **state) {
   SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
   SpdmContext->LocalContext.PeerCertChainProvision = NULL;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
 
   CertChainSize = sizeof(CertChain);
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_NO_RESPONSE);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
   free(Data);
 }
 
@@ -850,20 +930,20 @@ void TestSpdmRequesterGetCertificateCase6(void **state) {
   SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
   SpdmContext->LocalContext.PeerCertChainProvision = NULL;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
 
   CertChainSize = sizeof(CertChain);
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_SUCCESS);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
   free(Data);
 }
 
 /**
   Test 7: force responder to send an ERROR message with code SPDM_ERROR_CODE_REQUEST_RESYNCH
-  Expected Behavior: get a RETURN_DEVICE_ERROR, with no CERTIFICATE messages received (checked in Transcript.MessageB buffer)
+  Expected Behavior: get a RETURN_DEVICE_ERROR, with no CERTIFICATE messages received (checked in Transcript.MessageBDigest)
 **/
 void TestSpdmRequesterGetCertificateCase7(void **state) {
   RETURN_STATUS        Status;
@@ -886,7 +966,7 @@ void TestSpdmRequesterGetCertificateCase7(void **state) {
   SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
   SpdmContext->LocalContext.PeerCertChainProvision = NULL;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
 
   CertChainSize = sizeof(CertChain);
@@ -894,7 +974,7 @@ void TestSpdmRequesterGetCertificateCase7(void **state) {
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
   assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateNotStarted);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
   free(Data);
 }
 
@@ -923,7 +1003,7 @@ void TestSpdmRequesterGetCertificateCase8(void **state) {
   SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
   SpdmContext->LocalContext.PeerCertChainProvision = NULL;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
 
   CertChainSize = sizeof(CertChain);
@@ -960,14 +1040,14 @@ void TestSpdmRequesterGetCertificateCase9(void **state) {
   SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
   SpdmContext->LocalContext.PeerCertChainProvision = NULL;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
 
   CertChainSize = sizeof(CertChain);
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_SUCCESS);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
   free(Data);
 }
 
@@ -998,14 +1078,14 @@ void TestSpdmRequesterGetCertificateCase10(void **state) {
   SpdmContext->LocalContext.PeerRootCertHashProvision = NULL;
   SpdmContext->LocalContext.PeerCertChainProvision = Data;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = DataSize;
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
 
   CertChainSize = sizeof(CertChain);
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_SUCCESS);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
   free(Data);
 }
 
@@ -1039,7 +1119,7 @@ void TestSpdmRequesterGetCertificateCase11(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   // Reseting message buffer
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   // Calculating expected number of messages received
   Count = (DataSize + MAX_SPDM_CERT_CHAIN_BLOCK_LEN - 1) / MAX_SPDM_CERT_CHAIN_BLOCK_LEN;
 
@@ -1047,7 +1127,7 @@ void TestSpdmRequesterGetCertificateCase11(void **state) {
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
   free(Data);
 }
 
@@ -1082,7 +1162,7 @@ void TestSpdmRequesterGetCertificateCase12(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   // Reseting message buffer
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   // Calculating expected number of messages received
   Count = (DataSize + MAX_SPDM_CERT_CHAIN_BLOCK_LEN - 1) / MAX_SPDM_CERT_CHAIN_BLOCK_LEN;
 
@@ -1090,7 +1170,7 @@ void TestSpdmRequesterGetCertificateCase12(void **state) {
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
   free(Data);
 }
 
@@ -1124,7 +1204,7 @@ void TestSpdmRequesterGetCertificateCase13(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   // Reseting message buffer
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   // Calculating expected number of messages received
   Count = (DataSize + MAX_SPDM_CERT_CHAIN_BLOCK_LEN - 1) / MAX_SPDM_CERT_CHAIN_BLOCK_LEN;
 
@@ -1132,7 +1212,7 @@ void TestSpdmRequesterGetCertificateCase13(void **state) {
   ZeroMem (CertChain, sizeof(CertChain));
   Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
   assert_int_equal (Status, RETURN_SUCCESS);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
   free(Data);
 }
 
@@ -1170,7 +1250,7 @@ void TestSpdmRequesterGetCertificateCase14(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   // Reseting message buffer
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   // Calculating expected number of messages received
   Count = (DataSize + GetCertLength - 1) / GetCertLength;
 
@@ -1180,7 +1260,7 @@ void TestSpdmRequesterGetCertificateCase14(void **state) {
   // It may fail because the spdm does not support too many messages.
   //assert_int_equal (Status, RETURN_SUCCESS);
   if (Status == RETURN_SUCCESS) {
-    assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
+    assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
   }
   free(Data);
 }
@@ -1215,7 +1295,7 @@ void TestSpdmRequesterGetCertificateCase15(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
   SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
   // Reseting message buffer
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   // Calculating expected number of messages received
   Count = (DataSize + MAX_SPDM_CERT_CHAIN_BLOCK_LEN - 1) / MAX_SPDM_CERT_CHAIN_BLOCK_LEN;
 
@@ -1225,8 +1305,305 @@ void TestSpdmRequesterGetCertificateCase15(void **state) {
   // It may fail because the spdm does not support too long message.
   //assert_int_equal (Status, RETURN_SUCCESS);
   if (Status == RETURN_SUCCESS) {
-    assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
+    assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST)*Count + sizeof(SPDM_CERTIFICATE_RESPONSE)*Count + DataSize);
+  }
+  free(Data);
+}
+
+/**
+  Test 16: Get the same certificate chain twice with a certificate chain verification cache
+  Expected Behavior: both requests succeed, the chain is cached once and referenced by the connection
+**/
+void TestSpdmRequesterGetCertificateCase16(void **state) {
+  RETURN_STATUS                Status;
+  SPDM_TEST_CONTEXT            *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT          *SpdmContext;
+  UINTN                        CertChainSize;
+  UINT8                        CertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+  VOID                         *Data;
+  UINTN                        DataSize;
+  VOID                         *Hash;
+  UINTN                        HashSize;
+  VOID                         *Cache;
+  SPDM_CERT_CHAIN_CACHE_ENTRY  *Entry;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x10;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->LocalContext.PeerRootCertHashProvisionSize = HashSize;
+  SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
+  SpdmContext->LocalContext.PeerCertChainProvision = NULL;
+  SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+
+  Cache = malloc (SpdmCertChainCacheGetSize (2));
+  SpdmCertChainCacheInit (Cache, 2, NULL, NULL, NULL);
+  SpdmRegisterCertChainCache (SpdmContext, Cache);
+  Entry = (SPDM_CERT_CHAIN_CACHE_ENTRY *)((SPDM_CERT_CHAIN_CACHE *)Cache + 1);
+
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterDigests;
+  SpdmResetMessageB (SpdmContext);
+  CertChainSize = sizeof(CertChain);
+  ZeroMem (CertChain, sizeof(CertChain));
+  Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_true (Entry[0].Valid);
+  assert_int_equal (Entry[0].RefCount, 1);
+
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterDigests;
+  SpdmResetMessageB (SpdmContext);
+  CertChainSize = sizeof(CertChain);
+  ZeroMem (CertChain, sizeof(CertChain));
+  Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_true (Entry[0].Valid);
+  assert_false (Entry[1].Valid);
+  assert_int_equal (Entry[0].RefCount, 1);
+
+  SpdmRegisterCertChainCache (SpdmContext, NULL);
+  assert_int_equal (Entry[0].RefCount, 0);
+  SpdmCertChainCacheDeinit (Cache);
+  free (Cache);
+  free(Data);
+}
+
+/**
+  Test 17: the GET_DIGESTS digest of the slot matches a cached certificate chain
+  Expected Behavior: receives the cached certificate chain without any message sent, and no CERTIFICATE message in Transcript.MessageBDigest
+**/
+void TestSpdmRequesterGetCertificateCase17(void **state) {
+  RETURN_STATUS                Status;
+  SPDM_TEST_CONTEXT            *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT          *SpdmContext;
+  UINTN                        CertChainSize;
+  UINT8                        CertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+  VOID                         *Data;
+  UINTN                        DataSize;
+  VOID                         *Hash;
+  UINTN                        HashSize;
+  VOID                         *Cache;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x11;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->LocalContext.PeerRootCertHashProvisionSize = HashSize;
+  SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
+  SpdmContext->LocalContext.PeerCertChainProvision = NULL;
+  SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+
+  Cache = malloc (SpdmCertChainCacheGetSize (2));
+  SpdmCertChainCacheInit (Cache, 2, NULL, NULL, NULL);
+  SpdmRegisterCertChainCache (SpdmContext, Cache);
+
+  SpdmContext->ConnectionInfo.PeerDigestSlotMask = 0;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterDigests;
+  SpdmResetMessageB (SpdmContext);
+  CertChainSize = sizeof(CertChain);
+  ZeroMem (CertChain, sizeof(CertChain));
+  Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  //
+  // Any message sent from now on fails.
+  //
+  SpdmTestContext->CaseId = 0x1;
+  SpdmContext->ConnectionInfo.PeerDigestSlotMask = 0x1;
+  SpdmHashAll (mUseHashAlgo, Data, DataSize, SpdmContext->ConnectionInfo.PeerDigestBuffer);
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterDigests;
+  SpdmResetMessageB (SpdmContext);
+  CertChainSize = sizeof(CertChain);
+  ZeroMem (CertChain, sizeof(CertChain));
+  Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (CertChainSize, DataSize);
+  assert_memory_equal (CertChain, Data, DataSize);
+  assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateAfterCertificate);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
+
+  SpdmContext->ConnectionInfo.PeerDigestSlotMask = 0;
+  SpdmRegisterCertChainCache (SpdmContext, NULL);
+  SpdmCertChainCacheDeinit (Cache);
+  free (Cache);
+  free(Data);
+}
+
+/**
+  Test 18: the transport maximum message size holds the whole certificate chain
+  Expected Behavior: receives a valid certificate chain with one CERTIFICATE message
+**/
+void TestSpdmRequesterGetCertificateCase18(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                CertChainSize;
+  UINT8                CertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+  VOID                 *Data;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x12;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterDigests;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->LocalContext.PeerRootCertHashProvisionSize = HashSize;
+  SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
+  SpdmContext->LocalContext.PeerCertChainProvision = NULL;
+  SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->LocalContext.TransportMaxMessageSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  SpdmResetMessageB (SpdmContext);
+
+  CertChainSize = sizeof(CertChain);
+  ZeroMem (CertChain, sizeof(CertChain));
+  Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (CertChainSize, DataSize);
+  assert_memory_equal (CertChain, Data, DataSize);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_CERTIFICATE_REQUEST) + sizeof(SPDM_CERTIFICATE_RESPONSE) + DataSize);
+
+  SpdmContext->LocalContext.TransportMaxMessageSize = 0;
+  free(Data);
+}
+
+/**
+  Test 19: the certificate chain is collected in a buffer registered by SpdmRegisterPeerCertChainBuffer
+  Expected Behavior: receives a valid certificate chain in the registered buffer, and fails if the registered buffer is too small
+**/
+void TestSpdmRequesterGetCertificateCase19(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                CertChainSize;
+  UINT8                CertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+  UINT8                PeerCertChainBuffer[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  VOID                 *Data;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x2;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterDigests;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->LocalContext.PeerRootCertHashProvisionSize = HashSize;
+  SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
+  SpdmContext->LocalContext.PeerCertChainProvision = NULL;
+  SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+
+  Status = SpdmRegisterPeerCertChainBuffer (SpdmContext, PeerCertChainBuffer, MAX_UINT16 + 1);
+  assert_int_equal (Status, RETURN_INVALID_PARAMETER);
+
+  Status = SpdmRegisterPeerCertChainBuffer (SpdmContext, PeerCertChainBuffer, sizeof(PeerCertChainBuffer));
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResetMessageB (SpdmContext);
+  CertChainSize = sizeof(CertChain);
+  ZeroMem (CertChain, sizeof(CertChain));
+  Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (CertChainSize, DataSize);
+  assert_memory_equal (CertChain, Data, DataSize);
+  assert_ptr_equal (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, PeerCertChainBuffer);
+  assert_int_equal (SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize, DataSize);
+  assert_memory_equal (PeerCertChainBuffer, Data, DataSize);
+
+  Status = SpdmRegisterPeerCertChainBuffer (SpdmContext, PeerCertChainBuffer, DataSize - 1);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize, 0);
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterDigests;
+  SpdmResetMessageB (SpdmContext);
+  CertChainSize = sizeof(CertChain);
+  Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  assert_int_equal (SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize, 0);
+
+  Status = SpdmRegisterPeerCertChainBuffer (SpdmContext, NULL, 0);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmContext->ConnectionInfo.MaxPeerUsedCertChainBufferSize, MAX_SPDM_CERT_CHAIN_SIZE);
+  free(Data);
+}
+
+/**
+  Test 20: Get a certificate chain with two certificate chain verification caches behind one shared cache
+  Expected Behavior: the chain verified with the first cache is published once to the shared cache, and found there with the second cache
+**/
+void TestSpdmRequesterGetCertificateCase20(void **state) {
+  RETURN_STATUS                       Status;
+  SPDM_TEST_CONTEXT                   *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT                 *SpdmContext;
+  UINTN                               CertChainSize;
+  UINT8                               CertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+  VOID                                *Data;
+  UINTN                               DataSize;
+  VOID                                *Hash;
+  UINTN                               HashSize;
+  VOID                                *Cache[2];
+  VOID                                *SharedCache;
+  SPDM_SHARED_CERT_CHAIN_CACHE        *Shared;
+  SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY  *SharedEntry;
+  SPDM_CERT_CHAIN_CACHE_ENTRY         *Entry;
+  UINTN                               Index;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x10;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->LocalContext.PeerRootCertHashProvisionSize = HashSize;
+  SpdmContext->LocalContext.PeerRootCertHashProvision = Hash;
+  SpdmContext->LocalContext.PeerCertChainProvision = NULL;
+  SpdmContext->LocalContext.PeerCertChainProvisionSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+
+  SharedCache = malloc (SpdmSharedCertChainCacheGetSize (4));
+  ZeroMem (SharedCache, SpdmSharedCertChainCacheGetSize (4));
+  Cache[0] = malloc (SpdmCertChainCacheGetSize (2));
+  SpdmCertChainCacheInit (Cache[0], 2, NULL, NULL, NULL);
+  Status = SpdmCertChainCacheAttachShared (Cache[0], SharedCache);
+  assert_int_equal (Status, RETURN_UNSUPPORTED);
+  Status = SpdmSharedCertChainCacheInit (SharedCache, SpdmSharedCertChainCacheGetSize (4), 4);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Shared = SharedCache;
+  SharedEntry = (SPDM_SHARED_CERT_CHAIN_CACHE_ENTRY *)(Shared + 1);
+
+  for (Index = 0; Index < 2; Index++) {
+    if (Index != 0) {
+      Cache[Index] = malloc (SpdmCertChainCacheGetSize (2));
+      SpdmCertChainCacheInit (Cache[Index], 2, NULL, NULL, NULL);
+    }
+    Status = SpdmCertChainCacheAttachShared (Cache[Index], SharedCache);
+    assert_int_equal (Status, RETURN_SUCCESS);
+    SpdmRegisterCertChainCache (SpdmContext, Cache[Index]);
+    Entry = (SPDM_CERT_CHAIN_CACHE_ENTRY *)((SPDM_CERT_CHAIN_CACHE *)Cache[Index] + 1);
+
+    SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterDigests;
+    SpdmResetMessageB (SpdmContext);
+    CertChainSize = sizeof(CertChain);
+    ZeroMem (CertChain, sizeof(CertChain));
+    Status = SpdmGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
+    assert_int_equal (Status, RETURN_SUCCESS);
+    assert_true (Entry[0].Valid);
+    assert_int_equal (Shared->PublishCount, 1);
+  }
+  assert_int_equal (SharedEntry[0].Sequence | SharedEntry[1].Sequence | SharedEntry[2].Sequence | SharedEntry[3].Sequence, 2);
+  assert_int_equal (Shared->WriterLock, 0);
+
+  SpdmRegisterCertChainCache (SpdmContext, NULL);
+  for (Index = 0; Index < 2; Index++) {
+    SpdmCertChainCacheDeinit (Cache[Index]);
+    free (Cache[Index]);
   }
+  free (SharedCache);
   free(Data);
 }
 
@@ -1269,6 +1646,16 @@ int SpdmRequesterGetCertificateTestMain(void) {
       cmocka_unit_test(TestSpdmRequesterGetCertificateCase14),
       // Sucessful response: get a long certificate chain
       cmocka_unit_test(TestSpdmRequesterGetCertificateCase15),
+      // Sucessful response: certificate chain verification cache
+      cmocka_unit_test(TestSpdmRequesterGetCertificateCase16),
+      // Sucessful response: certificate chain from cache for a matching digest
+      cmocka_unit_test(TestSpdmRequesterGetCertificateCase17),
+      // Sucessful response: the whole certificate chain in one message of the transport maximum message size
+      cmocka_unit_test(TestSpdmRequesterGetCertificateCase18),
+      // Sucessful response: certificate chain in a registered buffer
+      cmocka_unit_test(TestSpdmRequesterGetCertificateCase19),
+      // Sucessful response: certificate chain verification cache behind a shared cache
+      cmocka_unit_test(TestSpdmRequesterGetCertificateCase20),
   };
 
   SetupSpdmTestContext (&mSpdmRequesterGetCertificateTestContext);
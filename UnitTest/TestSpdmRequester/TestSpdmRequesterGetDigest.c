@@ -524,12 +524,12 @@ void TestSpdmRequesterGetDigestCase1(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
 }
 
 /**
@@ -552,12 +552,12 @@ void TestSpdmRequesterGetDigestCase2(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_SUCCESS);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST) + sizeof(SPDM_DIGESTS_RESPONSE) + GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST) + sizeof(SPDM_DIGESTS_RESPONSE) + GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo));
 }
 
 /**
@@ -581,12 +581,12 @@ void TestSpdmRequesterGetDigestCase3(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_UNSUPPORTED);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
 }
 
 /**
@@ -609,12 +609,12 @@ void TestSpdmRequesterGetDigestCase4(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
 }
 
 /**
@@ -637,12 +637,12 @@ void TestSpdmRequesterGetDigestCase5(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
   
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_NO_RESPONSE);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
 }
 
 /**
@@ -666,12 +666,12 @@ void TestSpdmRequesterGetDigestCase6(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_SUCCESS);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST) + sizeof(SPDM_DIGESTS_RESPONSE) + GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST) + sizeof(SPDM_DIGESTS_RESPONSE) + GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo));
 }
 
 /**
@@ -695,13 +695,13 @@ void TestSpdmRequesterGetDigestCase7(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
   assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateNotStarted);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
 }
 
 /**
@@ -725,7 +725,7 @@ void TestSpdmRequesterGetDigestCase8(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
@@ -753,12 +753,12 @@ void TestSpdmRequesterGetDigestCase9(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_SUCCESS);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST) + sizeof(SPDM_DIGESTS_RESPONSE) + GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST) + sizeof(SPDM_DIGESTS_RESPONSE) + GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo));
 }
 
 /**
@@ -782,12 +782,12 @@ void TestSpdmRequesterGetDigestCase10(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_UNSUPPORTED);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
 }
 
 /**
@@ -810,12 +810,12 @@ void TestSpdmRequesterGetDigestCase11(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
 }
 
 /**
@@ -839,12 +839,12 @@ void TestSpdmRequesterGetDigestCase12(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
 }
 
 /**
@@ -867,12 +867,12 @@ void TestSpdmRequesterGetDigestCase13(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
 }
 
 /**
@@ -895,16 +895,16 @@ void TestSpdmRequesterGetDigestCase14(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
 }
 
 /**
-  Test 15: a request message is successfully sent but it cannot be appended to the internal cache since the internal cache is full
+  Test 15: a request message is successfully sent but it cannot be appended to the internal cache since the running hash of the internal cache is lost
   Expected Behavior: requester returns the status RETURN_SECURITY_VIOLATION
 **/
 void TestSpdmRequesterGetDigestCase15(void **state) {
@@ -923,7 +923,8 @@ void TestSpdmRequesterGetDigestCase15(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = SpdmContext->Transcript.MessageB.MaxBufferSize;
+  SpdmResetMessageB (SpdmContext);
+  SpdmContext->Transcript.MessageBDigest.BufferSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
@@ -931,8 +932,8 @@ void TestSpdmRequesterGetDigestCase15(void **state) {
 }
 
 /**
-  Test 16: a request message is successfully sent but the response message cannot be appended to the internal cache since the internal cache is full
-  Expected Behavior: requester returns the status RETURN_SECURITY_VIOLATION
+  Test 16: a request message is successfully sent while the internal cache already holds MAX_SPDM_MESSAGE_BUFFER_SIZE bytes
+  Expected Behavior: requester returns the status RETURN_SUCCESS and the correct Transcript.MessageBDigest.BufferSize, because the internal cache is kept as a running hash
 **/
 void TestSpdmRequesterGetDigestCase16(void **state) {
   RETURN_STATUS        Status;
@@ -950,11 +951,13 @@ void TestSpdmRequesterGetDigestCase16(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = SpdmContext->Transcript.MessageB.MaxBufferSize - (sizeof(SPDM_DIGESTS_RESPONSE));
+  SpdmResetMessageB (SpdmContext);
+  SpdmAppendMessageBDigest (SpdmContext, LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
-  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, MAX_SPDM_MESSAGE_BUFFER_SIZE + sizeof(SPDM_GET_DIGESTS_REQUEST) + sizeof(SPDM_DIGESTS_RESPONSE) + GetSpdmHashSize (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo));
 }
 
 /**
@@ -977,7 +980,7 @@ void TestSpdmRequesterGetDigestCase17(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
@@ -1006,12 +1009,12 @@ void TestSpdmRequesterGetDigestCase18(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
 }
 
 /**
@@ -1034,7 +1037,7 @@ void TestSpdmRequesterGetDigestCase19(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
@@ -1063,12 +1066,12 @@ void TestSpdmRequesterGetDigestCase20(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
 }
 
 /**
@@ -1092,12 +1095,12 @@ void TestSpdmRequesterGetDigestCase21(void **state) {
   SpdmContext->LocalContext.PeerCertChainProvision = LocalCertificateChain;
   SpdmContext->LocalContext.PeerCertChainProvisionSize = MAX_SPDM_MESSAGE_BUFFER_SIZE;
   SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  SpdmResetMessageB (SpdmContext);
 
   ZeroMem (TotalDigestBuffer, sizeof(TotalDigestBuffer));
   Status = SpdmGetDigest (SpdmContext, &SlotMask, &TotalDigestBuffer);
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
-  assert_int_equal (SpdmContext->Transcript.MessageB.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, sizeof(SPDM_GET_DIGESTS_REQUEST));
 }
 
 SPDM_TEST_CONTEXT       mSpdmRequesterGetDigestTestContext = {
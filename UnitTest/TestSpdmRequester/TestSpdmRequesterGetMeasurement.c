@@ -2323,7 +2323,7 @@ void TestSpdmRequesterGetMeasurementCase21(void **state) {
 
 /**
   Test 22: request a large number of unsigned measurements before requesting a signature
-  Expected Behavior: RETURN_SUCCESS return code and correct Transcript.MessageM.BufferSize while Transcript.MessageM has room; RETURN_DEVICE_ERROR otherwise
+  Expected Behavior: RETURN_SUCCESS return code and correct Transcript.MessageM.BufferSize for every request, because Transcript.MessageM is kept as a running hash
 **/
 void TestSpdmRequesterGetMeasurementCase22(void **state) {
   RETURN_STATUS        Status;
@@ -2361,13 +2361,8 @@ void TestSpdmRequesterGetMeasurementCase22(void **state) {
   MeasurementRecordLength = sizeof(MeasurementRecord);
   for (NumberOfMessages = 1; NumberOfMessages <= TOTAL_MESSAGES; NumberOfMessages++) {
     Status = SpdmGetMeasurement (SpdmContext, NULL, RequestAttribute, 1, 0, &NumberOfBlock, &MeasurementRecordLength, MeasurementRecord);
-    // It may fail due to Transcript.MessageM overflow
-    if (Status == RETURN_SUCCESS) {
-      assert_int_equal (SpdmContext->Transcript.MessageM.BufferSize, NumberOfMessages * (sizeof(SPDM_MESSAGE_HEADER) + sizeof(SPDM_MEASUREMENTS_RESPONSE) + sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + GetSpdmMeasurementHashSize (mUseMeasurementHashAlgo) + sizeof(UINT16)));
-    } else {
-      assert_int_equal (SpdmContext->Transcript.MessageM.BufferSize, 0);
-      break;
-    }
+    assert_int_equal (Status, RETURN_SUCCESS);
+    assert_int_equal (SpdmContext->Transcript.MessageM.BufferSize, NumberOfMessages * (sizeof(SPDM_MESSAGE_HEADER) + sizeof(SPDM_MEASUREMENTS_RESPONSE) + sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + GetSpdmMeasurementHashSize (mUseMeasurementHashAlgo) + sizeof(UINT16)));
   }
   free(Data);
 }
@@ -2790,6 +2785,259 @@ void TestSpdmRequesterGetMeasurementCase32(void **state) {
   free(Data);
 }
 
+/**
+  Test 33: Measurement cache with a maximum age of 2, primed by a successful response with signature
+  Expected Behavior: the unsigned requests are served from the cache twice without sending a message,
+                     and the third one is sent and gets a RETURN_DEVICE_ERROR return code
+**/
+void TestSpdmRequesterGetMeasurementCase33(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT8                NumberOfBlock;
+  UINT32               MeasurementRecordLength;
+  UINT8                MeasurementRecord[MAX_SPDM_MEASUREMENT_RECORD_SIZE];
+  UINT8                CachedMeasurementRecord[MAX_SPDM_MEASUREMENT_RECORD_SIZE];
+  UINT32               CachedMeasurementRecordLength;
+  VOID                 *Data;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x2;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAuthenticated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP_SIG;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->Transcript.MessageM.BufferSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = DataSize;
+  CopyMem (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, Data, DataSize);
+  ZeroMem (&SpdmContext->ConnectionInfo.MeasurementCache, sizeof(SpdmContext->ConnectionInfo.MeasurementCache));
+  SpdmContext->LocalContext.MeasurementCacheMaxAge = 2;
+
+  CachedMeasurementRecordLength = sizeof(CachedMeasurementRecord);
+  Status = SpdmGetMeasurement (SpdmContext, NULL, SPDM_GET_MEASUREMENTS_REQUEST_ATTRIBUTES_GENERATE_SIGNATURE, 1, 0, &NumberOfBlock, &CachedMeasurementRecordLength, CachedMeasurementRecord);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  SpdmTestContext->CaseId = 0x1;
+  MeasurementRecordLength = sizeof(MeasurementRecord);
+  Status = SpdmGetMeasurement (SpdmContext, NULL, 0, 1, 0, &NumberOfBlock, &MeasurementRecordLength, MeasurementRecord);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (NumberOfBlock, 1);
+  assert_int_equal (MeasurementRecordLength, CachedMeasurementRecordLength);
+  assert_memory_equal (MeasurementRecord, CachedMeasurementRecord, CachedMeasurementRecordLength);
+
+  MeasurementRecordLength = sizeof(MeasurementRecord);
+  Status = SpdmGetMeasurement (SpdmContext, NULL, 0, 1, 0, &NumberOfBlock, &MeasurementRecordLength, MeasurementRecord);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  MeasurementRecordLength = sizeof(MeasurementRecord);
+  Status = SpdmGetMeasurement (SpdmContext, NULL, 0, 1, 0, &NumberOfBlock, &MeasurementRecordLength, MeasurementRecord);
+  assert_int_equal (Status, RETURN_DEVICE_ERROR);
+
+  SpdmContext->LocalContext.MeasurementCacheMaxAge = 0;
+  free(Data);
+}
+
+STATIC BOOLEAN                mTestVerifyResult[MAX_SPDM_PIPELINED_VERIFY_COUNT];
+STATIC UINTN                  mTestVerifyStartCount;
+STATIC UINTN                  mTestVerifyOutstanding;
+STATIC UINTN                  mTestVerifyMaxOutstanding;
+
+RETURN_STATUS
+EFIAPI
+SpdmRequesterGetMeasurementTestVerifyAsync (
+  IN     VOID                                *SpdmContext,
+  IN     UINT32                              BaseAsymAlgo,
+  IN     UINT32                              BaseHashAlgo,
+  IN     VOID                                *PublicKey,
+  IN     CONST UINT8                         *MessageHash,
+  IN     CONST UINT8                         *Signature,
+  IN     UINTN                               SigSize,
+     OUT UINTN                               *VerifyToken
+  )
+{
+  *VerifyToken = mTestVerifyStartCount;
+  mTestVerifyResult[mTestVerifyStartCount % MAX_SPDM_PIPELINED_VERIFY_COUNT] = SpdmAsymVerifyHash (BaseAsymAlgo, BaseHashAlgo, PublicKey, MessageHash, Signature, SigSize);
+  mTestVerifyStartCount++;
+  mTestVerifyOutstanding++;
+  if (mTestVerifyOutstanding > mTestVerifyMaxOutstanding) {
+    mTestVerifyMaxOutstanding = mTestVerifyOutstanding;
+  }
+  return RETURN_NOT_READY;
+}
+
+RETURN_STATUS
+EFIAPI
+SpdmRequesterGetMeasurementTestVerifyPoll (
+  IN     VOID                                *SpdmContext,
+  IN     UINTN                               VerifyToken,
+  IN     BOOLEAN                             Wait
+  )
+{
+  mTestVerifyOutstanding--;
+  if (!mTestVerifyResult[VerifyToken % MAX_SPDM_PIPELINED_VERIFY_COUNT]) {
+    return RETURN_SECURITY_VIOLATION;
+  }
+  return RETURN_SUCCESS;
+}
+
+/**
+  Test 34: Pipelined measurements with signature, verified by asynchronous verification functions
+  Expected Behavior: get a RETURN_SUCCESS return code, with one block per index, while the signatures
+                     of all requests are verified after the next requests are sent
+**/
+void TestSpdmRequesterGetMeasurementCase34(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               MeasurementRecordLength;
+  UINT8                MeasurementRecord[MAX_SPDM_MEASUREMENT_RECORD_SIZE];
+  UINT8                IndexList[3];
+  VOID                 *Data;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x2;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAuthenticated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP_SIG;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->Transcript.MessageM.BufferSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = DataSize;
+  CopyMem (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, Data, DataSize);
+  SpdmRegisterRequesterVerifyAsyncFunc (SpdmContext, SpdmRequesterGetMeasurementTestVerifyAsync, SpdmRequesterGetMeasurementTestVerifyPoll);
+  mTestVerifyStartCount = 0;
+  mTestVerifyOutstanding = 0;
+  mTestVerifyMaxOutstanding = 0;
+
+  IndexList[0] = 1;
+  IndexList[1] = 1;
+  IndexList[2] = 1;
+  MeasurementRecordLength = sizeof(MeasurementRecord);
+  Status = SpdmGetMeasurementsPipelined (SpdmContext, NULL, 0, 3, IndexList, &MeasurementRecordLength, MeasurementRecord);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (MeasurementRecordLength, 3 * (sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + GetSpdmMeasurementHashSize (mUseMeasurementHashAlgo)));
+  assert_int_equal (mTestVerifyStartCount, 3);
+  assert_int_equal (mTestVerifyOutstanding, 0);
+  assert_int_equal (mTestVerifyMaxOutstanding, 3);
+  assert_int_equal (SpdmContext->Transcript.MessageM.BufferSize, 0);
+
+  SpdmRegisterRequesterVerifyAsyncFunc (SpdmContext, NULL, NULL);
+  free(Data);
+}
+
+/**
+  Test 35: get a range of measurement indices, first all at once while the number of blocks is unknown,
+  then with the cheaper of one GET_MEASUREMENTS for all blocks or one per index, given the learned block sizes.
+  Expected Behavior: get a RETURN_SUCCESS return code, with one parsed block per index, and the exchange
+                     selection follows the block sizes and the transport maximum message size
+**/
+void TestSpdmRequesterGetMeasurementCase35(void **state) {
+  RETURN_STATUS                Status;
+  SPDM_TEST_CONTEXT            *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT          *SpdmContext;
+  SPDM_MEASUREMENT_CACHE       *Cache;
+  UINT32                       MeasurementRecordLength;
+  UINT8                        MeasurementRecord[MAX_SPDM_MEASUREMENT_RECORD_SIZE];
+  SPDM_MEASUREMENT_BLOCK_INFO  BlockList[2];
+  UINT8                        IndexList[2];
+  UINT32                       TransportMaxMessageSize;
+  UINTN                        BlockSize;
+  UINTN                        Index;
+  VOID                         *Data;
+  UINTN                        DataSize;
+  VOID                         *Hash;
+  UINTN                        HashSize;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x2;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAuthenticated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP_SIG;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->Transcript.MessageM.BufferSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = DataSize;
+  CopyMem (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, Data, DataSize);
+  Cache = &SpdmContext->ConnectionInfo.MeasurementCache;
+  Cache->LearnedBlockCount = 0;
+  ZeroMem (Cache->LearnedBlockSize, sizeof(Cache->LearnedBlockSize));
+  BlockSize = sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + GetSpdmMeasurementHashSize (mUseMeasurementHashAlgo);
+
+  IndexList[0] = 1;
+  IndexList[1] = 1;
+  assert_true (SpdmMeasurementRangeUseAll (SpdmContext, TRUE, 2, IndexList));
+  assert_false (SpdmMeasurementRangeUseAll (SpdmContext, TRUE, 1, IndexList));
+
+  MeasurementRecordLength = sizeof(MeasurementRecord);
+  Status = SpdmGetMeasurementRange (SpdmContext, NULL, TRUE, 0, 2, IndexList, &MeasurementRecordLength, MeasurementRecord, BlockList);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (MeasurementRecordLength, 2 * BlockSize);
+  for (Index = 0; Index < 2; Index++) {
+    assert_int_equal (BlockList[Index].Index, 1);
+    assert_int_equal (BlockList[Index].MeasurementSpecification, SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF);
+    assert_int_equal (BlockList[Index].BlockSize, BlockSize);
+    assert_ptr_equal ((UINT8 *)BlockList[Index].Block, MeasurementRecord + Index * BlockSize);
+    assert_int_equal (BlockList[Index].DmtfValueSize, GetSpdmMeasurementHashSize (mUseMeasurementHashAlgo));
+  }
+  assert_int_equal (SpdmContext->Transcript.MessageM.BufferSize, 0);
+  assert_int_equal (Cache->LearnedBlockCount, 1);
+  assert_int_equal (Cache->LearnedBlockSize[0], BlockSize);
+
+  IndexList[0] = 0;
+  MeasurementRecordLength = sizeof(MeasurementRecord);
+  Status = SpdmGetMeasurementRange (SpdmContext, NULL, TRUE, 0, 2, IndexList, &MeasurementRecordLength, MeasurementRecord, BlockList);
+  assert_int_equal (Status, RETURN_INVALID_PARAMETER);
+
+  //
+  // Two of four small blocks: the extra bytes of all blocks cost less than a second round trip.
+  //
+  TransportMaxMessageSize = SpdmContext->LocalContext.TransportMaxMessageSize;
+  SpdmContext->LocalContext.TransportMaxMessageSize = 0;
+  Cache->LearnedBlockCount = 4;
+  for (Index = 0; Index < 4; Index++) {
+    Cache->LearnedBlockSize[Index] = 100;
+  }
+  IndexList[0] = 1;
+  IndexList[1] = 2;
+  assert_true (SpdmMeasurementRangeUseAll (SpdmContext, FALSE, 2, IndexList));
+  SpdmContext->LocalContext.TransportMaxMessageSize = 1100;
+  assert_true (SpdmMeasurementRangeUseAll (SpdmContext, FALSE, 2, IndexList));
+  //
+  // All blocks take several messages of the transport, but each block fits in one.
+  //
+  SpdmContext->LocalContext.TransportMaxMessageSize = 200;
+  assert_false (SpdmMeasurementRangeUseAll (SpdmContext, FALSE, 2, IndexList));
+  //
+  // Two of four large blocks.
+  //
+  SpdmContext->LocalContext.TransportMaxMessageSize = 0;
+  for (Index = 0; Index < 4; Index++) {
+    Cache->LearnedBlockSize[Index] = 1000;
+  }
+  assert_false (SpdmMeasurementRangeUseAll (SpdmContext, FALSE, 2, IndexList));
+
+  SpdmContext->LocalContext.TransportMaxMessageSize = TransportMaxMessageSize;
+  Cache->LearnedBlockCount = 0;
+  ZeroMem (Cache->LearnedBlockSize, sizeof(Cache->LearnedBlockSize));
+  free(Data);
+}
+
 SPDM_TEST_CONTEXT       mSpdmRequesterGetMeasurementTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   TRUE,
@@ -2863,6 +3111,12 @@ int SpdmRequesterGetMeasurementTestMain(void) {
       // cmocka_unit_test(TestSpdmRequesterGetMeasurementCase31), // test triggers runtime assert because the transmitted packet is larger than the 4096-byte buffer
       // Successful response to get all measurements without signature
       cmocka_unit_test(TestSpdmRequesterGetMeasurementCase32),
+      // Measurement cache primed by a response with signature, and bounded by the maximum age
+      cmocka_unit_test(TestSpdmRequesterGetMeasurementCase33),
+      // Pipelined measurements with asynchronous signature verification
+      cmocka_unit_test(TestSpdmRequesterGetMeasurementCase34),
+      // Measurement range, fetched all at once or one block per index by cost
+      cmocka_unit_test(TestSpdmRequesterGetMeasurementCase35),
   };
 
   SetupSpdmTestContext (&mSpdmRequesterGetMeasurementTestContext);
@@ -9,6 +9,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmUnitTest.h"
 #include <SpdmRequesterLibInternal.h>
+#include <IndustryStandard/Pcap.h>
+#include <IndustryStandard/LinkTypeEx.h>
 
 #pragma pack(1)
 typedef struct {
@@ -563,6 +565,99 @@ void TestSpdmRequesterGetVersionCase13(void **state) {
   assert_int_equal (Status, RETURN_DEVICE_ERROR);
 }
 
+/**
+  Test 14: receiving a correct VERSION message with available version 1.0 and 1.1,
+  first with the scratch arena of the SPDM context exhausted, then with it released.
+  Expected behavior: client returns a Status of RETURN_DEVICE_ERROR, then RETURN_SUCCESS,
+  and the scratch arena is released when the request completes.
+**/
+void TestSpdmRequesterGetVersionCase14(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x2;
+
+  SpdmContext->ScratchUsed = SpdmContext->ScratchSize;
+  Status = SpdmGetVersion (SpdmContext);
+  assert_int_equal (Status, RETURN_DEVICE_ERROR);
+
+  SpdmContext->ScratchUsed = 0;
+  Status = SpdmGetVersion (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmContext->ScratchUsed, 0);
+}
+
+UINT64
+EFIAPI
+SpdmRequesterGetVersionTestGetTime (
+  IN     VOID                    *SpdmContext
+  )
+{
+  return 0x123456789;
+}
+
+/**
+  Test 15: receiving a correct VERSION message with available version 1.0 and 1.1, captured to a capture ring
+  with a size cap of 4 bytes, then to a capture ring holding one message only.
+  Expected behavior: client returns a Status of RETURN_SUCCESS, the pcapng export has the GET_VERSION and VERSION
+  messages capped to 4 bytes with their time, then only the VERSION message with the GET_VERSION one dropped.
+**/
+void TestSpdmRequesterGetVersionCase15(void **state) {
+  RETURN_STATUS                 Status;
+  SPDM_TEST_CONTEXT             *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT           *SpdmContext;
+  UINT64                        Ring[64];
+  UINT8                         Pcap[512];
+  UINTN                         PcapSize;
+  UINT64                        DroppedCount;
+  UINTN                         BlockSize;
+  PCAPNG_ENHANCED_PACKET_BLOCK  *EnhancedPacket;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x2;
+
+  BlockSize = sizeof(PCAPNG_ENHANCED_PACKET_BLOCK) + 4 + sizeof(UINT32);
+  Status = SpdmCaptureRingInit (Ring, sizeof(Ring), LINKTYPE_MCTP);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmRegisterCaptureFunc (SpdmContext, SpdmCaptureRingSink, Ring, SpdmRequesterGetVersionTestGetTime, 0, 4);
+  Status = SpdmGetVersion (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  PcapSize = 0;
+  Status = SpdmCaptureRingExport (Ring, &PcapSize, Pcap, NULL);
+  assert_int_equal (Status, RETURN_BUFFER_TOO_SMALL);
+  assert_int_equal (PcapSize, 60 + BlockSize * 2);
+  PcapSize = sizeof(Pcap);
+  Status = SpdmCaptureRingExport (Ring, &PcapSize, Pcap, &DroppedCount);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (PcapSize, 60 + BlockSize * 2);
+  assert_int_equal (DroppedCount, 0);
+  assert_int_equal (((PCAPNG_BLOCK_HEADER *)Pcap)->BlockType, PCAPNG_BLOCK_TYPE_SECTION_HEADER);
+  assert_int_equal (((PCAPNG_INTERFACE_DESCRIPTION_BLOCK *)(Pcap + 28))->LinkType, LINKTYPE_MCTP);
+  EnhancedPacket = (VOID *)(Pcap + 60);
+  assert_int_equal (EnhancedPacket->Header.BlockType, PCAPNG_BLOCK_TYPE_ENHANCED_PACKET);
+  assert_int_equal (EnhancedPacket->TimestampHigh, 0x1);
+  assert_int_equal (EnhancedPacket->TimestampLow, 0x23456789);
+  assert_int_equal (EnhancedPacket->CapturedPacketLength, 4);
+  assert_true (EnhancedPacket->OriginalPacketLength > 4);
+
+  Status = SpdmCaptureRingInit (Ring, 64 + BlockSize, LINKTYPE_MCTP);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmGetVersion (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  PcapSize = sizeof(Pcap);
+  Status = SpdmCaptureRingExport (Ring, &PcapSize, Pcap, &DroppedCount);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (PcapSize, 60 + BlockSize);
+  assert_int_equal (DroppedCount, 1);
+
+  SpdmRegisterCaptureFunc (SpdmContext, NULL, NULL, NULL, 0, 0);
+}
+
 SPDM_TEST_CONTEXT       mSpdmRequesterGetVersionTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   TRUE,
@@ -593,6 +688,10 @@ int SpdmRequesterGetVersionTestMain(void) {
       cmocka_unit_test(TestSpdmRequesterGetVersionCase11),
       cmocka_unit_test(TestSpdmRequesterGetVersionCase12),
       cmocka_unit_test(TestSpdmRequesterGetVersionCase13),
+      // Scratch arena exhausted + Successful response
+      cmocka_unit_test(TestSpdmRequesterGetVersionCase14),
+      // Capture ring
+      cmocka_unit_test(TestSpdmRequesterGetVersionCase15),
   };
 
   SetupSpdmTestContext (&mSpdmRequesterGetVersionTestContext);
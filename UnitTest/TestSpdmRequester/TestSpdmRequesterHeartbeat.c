@@ -74,6 +74,8 @@ SpdmRequesterHeartbeatTestSendMessage (
     return RETURN_SUCCESS;
   case 0x9:
     return RETURN_SUCCESS;
+  case 0xA:
+    return RETURN_SUCCESS;
   default:
     return RETURN_DEVICE_ERROR;
   }
@@ -96,6 +98,7 @@ SpdmRequesterHeartbeatTestReceiveMessage (
     return RETURN_DEVICE_ERROR;
 
   case 0x2:
+  case 0xA:
   {
     SPDM_HEARTBEAT_RESPONSE       *SpdmResponse; 
     UINT8                         TempBuf[MAX_SPDM_MESSAGE_BUFFER_SIZE];
@@ -776,6 +779,485 @@ void TestSpdmRequesterHeartbeatCase9(void **state) {
   free(Data);
 }
 
+UINT64  mSpdmRequesterHeartbeatTestTime;
+
+UINT64
+EFIAPI
+SpdmRequesterHeartbeatTestGetTime (
+  IN     VOID                    *SpdmContext
+  )
+{
+  return mSpdmRequesterHeartbeatTestTime;
+}
+
+/**
+  Test 10: SpdmRunHeartbeats with a session whose heartbeat is due, then again once the HEARTBEAT_ACK refreshed it.
+  Expected Behavior: the first call sends the heartbeat and returns the end of the next heartbeat period,
+  the second call sends nothing.
+**/
+void TestSpdmRequesterHeartbeatCase10(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               SessionId;
+  VOID                 *Data;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+  SPDM_SESSION_INFO    *SessionInfo;
+  UINT64               NextWakeupTime;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0xA;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCRYPT_CAP;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MAC_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCRYPT_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+  SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = DataSize;
+  CopyMem (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, Data, DataSize);
+  ZeroMem (LocalPskHint, 32);
+  CopyMem (&LocalPskHint[0], TEST_PSK_HINT_STRING, sizeof(TEST_PSK_HINT_STRING));
+  SpdmContext->LocalContext.PskHintSize = sizeof(TEST_PSK_HINT_STRING);
+  SpdmContext->LocalContext.PskHint = LocalPskHint;
+  SpdmRegisterRequesterMonitorFunc (SpdmContext, SpdmRequesterHeartbeatTestGetTime, NULL);
+
+  SessionId = 0xFFFFFFFF;
+  SessionInfo = &SpdmContext->SessionInfo[0];
+  SpdmSessionInfoInit (SpdmContext, SessionInfo, SessionId, TRUE);
+  SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SpdmSessionStateEstablished);
+  SetMem (mDummyKeyBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadKeySize, (UINT8)(0xFF));
+  SpdmSecuredMessageSetResponseDataEncryptionKey (SessionInfo->SecuredMessageContext, mDummyKeyBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadKeySize);
+  SetMem (mDummySaltBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadIvSize, (UINT8)(0xFF));
+  SpdmSecuredMessageSetResponseDataSalt (SessionInfo->SecuredMessageContext, mDummySaltBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadIvSize);
+  ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->ApplicationSecret.ResponseDataSequenceNumber = 0;
+  SessionInfo->HeartbeatPeriod = 1;
+  SessionInfo->LastActivityTime = 0;
+
+  mSpdmRequesterHeartbeatTestTime = 6000000;
+  Status = SpdmRunHeartbeats (SpdmContext, &NextWakeupTime);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SessionInfo->LastActivityTime, 6000000);
+  assert_int_equal (NextWakeupTime, 16000000);
+
+  // A heartbeat sent now would fail.
+  SpdmTestContext->CaseId = 0x1;
+  mSpdmRequesterHeartbeatTestTime = 8000000;
+  Status = SpdmRunHeartbeats (SpdmContext, &NextWakeupTime);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (NextWakeupTime, 16000000);
+
+  SpdmRegisterRequesterMonitorFunc (SpdmContext, NULL, NULL);
+  free(Data);
+}
+
+/**
+  Test 11: warm session pool with one idle session, taken, returned, and dropped by SpdmRunSessionPool once its heartbeat fails.
+  Expected Behavior: the idle session is handed out once, and the pool drops it when the heartbeat cannot be sent.
+**/
+void TestSpdmRequesterHeartbeatCase11(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               SessionId;
+  UINT32               PooledSessionId;
+  SPDM_SESSION_INFO    *SessionInfo;
+  UINT64               NextWakeupTime;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x1;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCRYPT_CAP;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MAC_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCRYPT_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+  SpdmRegisterRequesterMonitorFunc (SpdmContext, SpdmRequesterHeartbeatTestGetTime, NULL);
+
+  Status = SpdmAcquirePooledSession (SpdmContext, &PooledSessionId);
+  assert_int_equal (Status, RETURN_NOT_STARTED);
+  Status = SpdmConfigureSessionPool (SpdmContext, 1, TRUE, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, 0);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  SessionId = 0xFFFFFFFF;
+  SessionInfo = &SpdmContext->SessionInfo[0];
+  SpdmSessionInfoInit (SpdmContext, SessionInfo, SessionId, TRUE);
+  SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SpdmSessionStateEstablished);
+  SessionInfo->PoolState = SpdmSessionPoolStateIdle;
+  SessionInfo->HeartbeatPeriod = 1;
+  SessionInfo->LastActivityTime = 0;
+
+  Status = SpdmAcquirePooledSession (SpdmContext, &PooledSessionId);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (PooledSessionId, SessionId);
+  Status = SpdmAcquirePooledSession (SpdmContext, &PooledSessionId);
+  assert_int_equal (Status, RETURN_NOT_READY);
+  Status = SpdmReleasePooledSession (SpdmContext, SessionId, FALSE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmReleasePooledSession (SpdmContext, SessionId, FALSE);
+  assert_int_equal (Status, RETURN_NOT_FOUND);
+
+  // The heartbeat is due, and it cannot be sent.
+  mSpdmRequesterHeartbeatTestTime = 6000000;
+  Status = SpdmRunSessionPool (SpdmContext, &NextWakeupTime);
+  assert_int_equal (Status, RETURN_DEVICE_ERROR);
+  assert_int_equal (NextWakeupTime, 10000000);
+  assert_int_equal (SessionInfo->SessionId, INVALID_SESSION_ID);
+  assert_int_equal (SessionInfo->PoolState, SpdmSessionPoolStateNone);
+
+  SpdmConfigureSessionPool (SpdmContext, 0, FALSE, 0, 0);
+  SpdmRegisterRequesterMonitorFunc (SpdmContext, NULL, NULL);
+}
+
+/**
+  Test 12: session multiplexer with one control channel and two bulk channels of weight 3 and 1, over a failing transport.
+  Expected Behavior: the control requests are dispatched first, and the bulk requests in the order of their finish tags.
+**/
+void TestSpdmRequesterHeartbeatCase12(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  VOID                 *Mux;
+  UINT8                Buffer[300];
+  UINTN                ResponseSize[8];
+  SPDM_MUX_REQUEST     Request[8];
+  UINTN                Index;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x1;
+
+  // Request 0 and 1 are control requests, 2 to 5 are on the channel of weight 3, and 6 and 7 on the channel of weight 1.
+  ZeroMem (Buffer, sizeof(Buffer));
+  for (Index = 0; Index < ARRAY_SIZE(Request); Index++) {
+    ResponseSize[Index] = 0;
+    Request[Index].IsAppMessage = TRUE;
+    Request[Index].Request = Buffer;
+    Request[Index].RequestSize = (Index < 6) ? 300 : 150;
+    Request[Index].Response = Buffer;
+    Request[Index].ResponseSize = &ResponseSize[Index];
+  }
+
+  Mux = malloc (SpdmMuxGetSize (3, 3));
+  Status = SpdmMuxInit (Mux, SpdmContext, 0xFFFFFFFF, 3, 3, NULL, NULL, NULL);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmMuxConfigureChannel (Mux, 0, TRUE, 0);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmMuxConfigureChannel (Mux, 1, FALSE, 3);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmMuxConfigureChannel (Mux, 2, FALSE, 0);
+  assert_int_equal (Status, RETURN_INVALID_PARAMETER);
+
+  // The finish tags are 100, 200 and 300 on channel 1, and 150 and 300 on channel 2, in units of 1 << SPDM_MUX_COST_SHIFT.
+  for (Index = 2; Index < 5; Index++) {
+    Status = SpdmMuxSubmit (Mux, 1, &Request[Index]);
+    assert_int_equal (Status, RETURN_SUCCESS);
+  }
+  Status = SpdmMuxSubmit (Mux, 1, &Request[5]);
+  assert_int_equal (Status, RETURN_OUT_OF_RESOURCES);
+  Status = SpdmMuxSubmit (Mux, 2, &Request[6]);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmMuxSubmit (Mux, 2, &Request[7]);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmMuxSubmit (Mux, 0, &Request[0]);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  Status = SpdmMuxDispatch (Mux);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (Request[0].Status, RETURN_DEVICE_ERROR);
+  assert_int_equal (Request[2].Status, RETURN_NOT_READY);
+  Status = SpdmMuxDispatch (Mux);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (Request[2].Status, RETURN_DEVICE_ERROR);
+
+  // A control request queued behind the bulk requests is dispatched next.
+  Status = SpdmMuxSubmit (Mux, 0, &Request[1]);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmMuxDispatch (Mux);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (Request[1].Status, RETURN_DEVICE_ERROR);
+  assert_int_equal (Request[6].Status, RETURN_NOT_READY);
+
+  Status = SpdmMuxDispatch (Mux);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (Request[6].Status, RETURN_DEVICE_ERROR);
+  assert_int_equal (Request[3].Status, RETURN_NOT_READY);
+  Status = SpdmMuxDispatch (Mux);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (Request[3].Status, RETURN_DEVICE_ERROR);
+  Status = SpdmMuxDispatch (Mux);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (Request[4].Status, RETURN_DEVICE_ERROR);
+  assert_int_equal (Request[7].Status, RETURN_NOT_READY);
+  Status = SpdmMuxRun (Mux);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (Request[7].Status, RETURN_DEVICE_ERROR);
+  Status = SpdmMuxDispatch (Mux);
+  assert_int_equal (Status, RETURN_NOT_FOUND);
+
+  free (Mux);
+}
+
+//
+// The number of messages sent and received over each transport path, the device IO context of the path.
+//
+STATIC UINTN  mSpdmRequesterHeartbeatTestPathMessageCount[3];
+
+RETURN_STATUS
+EFIAPI
+SpdmRequesterHeartbeatTestPathSendMessage (
+  IN     VOID                    *SpdmContext,
+  IN     UINTN                   RequestSize,
+  IN     VOID                    *Request,
+  IN     UINT64                  Timeout
+  )
+{
+  (*(UINTN *)SpdmGetTransportPathDeviceIoContext (SpdmContext, TRUE))++;
+  return SpdmRequesterHeartbeatTestSendMessage (SpdmContext, RequestSize, Request, Timeout);
+}
+
+RETURN_STATUS
+EFIAPI
+SpdmRequesterHeartbeatTestPathReceiveMessage (
+  IN     VOID                    *SpdmContext,
+  IN OUT UINTN                   *ResponseSize,
+  IN OUT VOID                    *Response,
+  IN     UINT64                  Timeout
+  )
+{
+  (*(UINTN *)SpdmGetTransportPathDeviceIoContext (SpdmContext, FALSE))++;
+  return SpdmRequesterHeartbeatTestReceiveMessage (SpdmContext, ResponseSize, Response, Timeout);
+}
+
+/**
+  Test 13: successful response in a session with two additional transport paths, for records of at least
+  sizeof(SPDM_HEARTBEAT_REQUEST) + 1 bytes and of at least sizeof(SPDM_HEARTBEAT_REQUEST) bytes.
+  Expected Behavior: the HEARTBEAT and the HEARTBEAT_ACK go over the second path,
+  and over path 0 once the session is not established or the paths are removed.
+**/
+void TestSpdmRequesterHeartbeatCase13(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               SessionId;
+  SPDM_SESSION_INFO    *SessionInfo;
+  SPDM_TRANSPORT_PATH  Path;
+  UINT8                PathIndex;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x2;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCRYPT_CAP;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MAC_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCRYPT_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+
+  SessionId = 0xFFFFFFFF;
+  SessionInfo = &SpdmContext->SessionInfo[0];
+  SpdmSessionInfoInit (SpdmContext, SessionInfo, SessionId, TRUE);
+  SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SpdmSessionStateEstablished);
+  SetMem (mDummyKeyBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadKeySize, (UINT8)(0xFF));
+  SpdmSecuredMessageSetResponseDataEncryptionKey (SessionInfo->SecuredMessageContext, mDummyKeyBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadKeySize);
+  SetMem (mDummySaltBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadIvSize, (UINT8)(0xFF));
+  SpdmSecuredMessageSetResponseDataSalt (SessionInfo->SecuredMessageContext, mDummySaltBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadIvSize);
+  ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->ApplicationSecret.ResponseDataSequenceNumber = 0;
+
+  ZeroMem (&Path, sizeof(Path));
+  Path.SendMessage = SpdmRequesterHeartbeatTestPathSendMessage;
+  Path.ReceiveMessage = SpdmRequesterHeartbeatTestPathReceiveMessage;
+  Status = SpdmRegisterTransportPath (SpdmContext, &Path, &PathIndex);
+  assert_int_equal (Status, RETURN_INVALID_PARAMETER);
+  Path.TransportEncodeMessage = SpdmTransportTestEncodeMessage;
+  Path.TransportDecodeMessage = SpdmTransportTestDecodeMessage;
+  Path.DeviceIoContext = &mSpdmRequesterHeartbeatTestPathMessageCount[1];
+  Path.MinPayloadSize = sizeof(SPDM_HEARTBEAT_REQUEST) + 1;
+  Status = SpdmRegisterTransportPath (SpdmContext, &Path, &PathIndex);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (PathIndex, 1);
+  Path.DeviceIoContext = &mSpdmRequesterHeartbeatTestPathMessageCount[2];
+  Path.MinPayloadSize = sizeof(SPDM_HEARTBEAT_REQUEST);
+  Status = SpdmRegisterTransportPath (SpdmContext, &Path, &PathIndex);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (PathIndex, 2);
+
+  ZeroMem (mSpdmRequesterHeartbeatTestPathMessageCount, sizeof(mSpdmRequesterHeartbeatTestPathMessageCount));
+  Status = SpdmHeartbeat (SpdmContext, SessionId);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmRequesterHeartbeatTestPathMessageCount[1], 0);
+  assert_int_equal (mSpdmRequesterHeartbeatTestPathMessageCount[2], 2);
+  assert_int_equal (SpdmContext->SendTransportPath, 0);
+  assert_int_equal (SpdmContext->ReceiveTransportPath, 0);
+  assert_ptr_equal (SpdmContext->TransportPath[0].SendMessage, SpdmRequesterHeartbeatTestSendMessage);
+
+  // The records of a session not established stay on path 0.
+  assert_int_equal (SpdmSelectTransportPath (SpdmContext, &SessionId, sizeof(SPDM_HEARTBEAT_REQUEST) + 1), 1);
+  SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SpdmSessionStateHandshaking);
+  assert_int_equal (SpdmSelectTransportPath (SpdmContext, &SessionId, sizeof(SPDM_HEARTBEAT_REQUEST) + 1), 0);
+  assert_int_equal (SpdmSelectTransportPath (SpdmContext, NULL, sizeof(SPDM_HEARTBEAT_REQUEST) + 1), 0);
+  SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SpdmSessionStateEstablished);
+
+  Status = SpdmRegisterTransportPath (SpdmContext, NULL, NULL);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmHeartbeat (SpdmContext, SessionId);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmRequesterHeartbeatTestPathMessageCount[2], 2);
+}
+
+#define SPDM_REQUESTER_HEARTBEAT_TEST_PATH_SESSION_ID  0xFFFFFFFE
+#define SPDM_REQUESTER_HEARTBEAT_TEST_PATH_APP_SIZE    0x40
+
+RETURN_STATUS
+EFIAPI
+SpdmRequesterHeartbeatTestPathReceiveAppMessage (
+  IN     VOID                    *SpdmContext,
+  IN OUT UINTN                   *ResponseSize,
+  IN OUT VOID                    *Response,
+  IN     UINT64                  Timeout
+  )
+{
+  UINT8                         TempBuf[SPDM_REQUESTER_HEARTBEAT_TEST_PATH_APP_SIZE];
+  UINT32                        SessionId;
+  SPDM_SESSION_INFO             *SessionInfo;
+  RETURN_STATUS                 Status;
+
+  //
+  // The send path is left alone while a response is received over another path.
+  //
+  assert_int_equal (((SPDM_DEVICE_CONTEXT *)SpdmContext)->SendTransportPath, 0);
+  (*(UINTN *)SpdmGetTransportPathDeviceIoContext (SpdmContext, FALSE))++;
+
+  SessionId = SPDM_REQUESTER_HEARTBEAT_TEST_PATH_SESSION_ID;
+  SetMem (TempBuf, sizeof(TempBuf), 0x5A);
+  Status = SpdmTransportTestEncodeMessage (SpdmContext, &SessionId, TRUE, FALSE, sizeof(TempBuf), TempBuf, ResponseSize, Response);
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  /* WALKAROUND: If just use single context to encode message and then decode message */
+  ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->ApplicationSecret.ResponseDataSequenceNumber --;
+  return Status;
+}
+
+/**
+  Test 14: two sessions, whose requests go over path 0 and over an additional transport path,
+  with the request of the second session sent before the response of the first session is received.
+  Expected Behavior: each response is received over the path of the request of its session,
+  and the send and receive paths of the SPDM context are back to path 0 after each message.
+**/
+void TestSpdmRequesterHeartbeatCase14(void **state) {
+  RETURN_STATUS           Status;
+  SPDM_TEST_CONTEXT       *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT     *SpdmContext;
+  UINT32                  SessionId[2];
+  SPDM_SESSION_INFO       *SessionInfo;
+  SPDM_TRANSPORT_PATH     Path;
+  UINT8                   PathIndex;
+  UINTN                   Index;
+  SPDM_HEARTBEAT_REQUEST  SpdmRequest;
+  UINT8                   AppMessage[SPDM_REQUESTER_HEARTBEAT_TEST_PATH_APP_SIZE];
+  UINT8                   Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                   ResponseSize;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x2;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCRYPT_CAP;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MAC_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCRYPT_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+
+  SessionId[0] = 0xFFFFFFFF;
+  SessionId[1] = SPDM_REQUESTER_HEARTBEAT_TEST_PATH_SESSION_ID;
+  for (Index = 0; Index < 2; Index++) {
+    SessionInfo = &SpdmContext->SessionInfo[Index];
+    SpdmSessionInfoInit (SpdmContext, SessionInfo, SessionId[Index], TRUE);
+    SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SpdmSessionStateEstablished);
+    SetMem (mDummyKeyBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadKeySize, (UINT8)(0xFF));
+    SpdmSecuredMessageSetResponseDataEncryptionKey (SessionInfo->SecuredMessageContext, mDummyKeyBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadKeySize);
+    SetMem (mDummySaltBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadIvSize, (UINT8)(0xFF));
+    SpdmSecuredMessageSetResponseDataSalt (SessionInfo->SecuredMessageContext, mDummySaltBuffer, ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->AeadIvSize);
+    ((SPDM_SECURED_MESSAGE_CONTEXT*)(SessionInfo->SecuredMessageContext))->ApplicationSecret.ResponseDataSequenceNumber = 0;
+  }
+
+  ZeroMem (&Path, sizeof(Path));
+  Path.SendMessage = SpdmRequesterHeartbeatTestPathSendMessage;
+  Path.ReceiveMessage = SpdmRequesterHeartbeatTestPathReceiveAppMessage;
+  Path.TransportEncodeMessage = SpdmTransportTestEncodeMessage;
+  Path.TransportDecodeMessage = SpdmTransportTestDecodeMessage;
+  Path.DeviceIoContext = &mSpdmRequesterHeartbeatTestPathMessageCount[1];
+  Path.MinPayloadSize = sizeof(AppMessage);
+  Status = SpdmRegisterTransportPath (SpdmContext, &Path, &PathIndex);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (PathIndex, 1);
+  ZeroMem (mSpdmRequesterHeartbeatTestPathMessageCount, sizeof(mSpdmRequesterHeartbeatTestPathMessageCount));
+
+  //
+  // The APP message of the second session goes over path 1, then the HEARTBEAT of the first session over path 0.
+  //
+  SetMem (AppMessage, sizeof(AppMessage), 0xA5);
+  Status = SpdmSendRequest (SpdmContext, &SessionId[1], TRUE, sizeof(AppMessage), AppMessage);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmRequesterHeartbeatTestPathMessageCount[1], 1);
+  assert_int_equal (SpdmContext->SendTransportPath, 0);
+
+  SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmRequest.Header.RequestResponseCode = SPDM_HEARTBEAT;
+  SpdmRequest.Header.Param1 = 0;
+  SpdmRequest.Header.Param2 = 0;
+  Status = SpdmSendRequest (SpdmContext, &SessionId[0], FALSE, sizeof(SpdmRequest), &SpdmRequest);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmRequesterHeartbeatTestPathMessageCount[1], 1);
+  assert_int_equal (SpdmContext->SessionInfo[0].RequestTransportPath, 0);
+  assert_int_equal (SpdmContext->SessionInfo[1].RequestTransportPath, 1);
+
+  //
+  // The response of the second session is received over path 1, although the last request went over path 0.
+  //
+  ResponseSize = sizeof(Response);
+  Status = SpdmReceiveResponse (SpdmContext, &SessionId[1], TRUE, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (ResponseSize, sizeof(AppMessage));
+  assert_int_equal (Response[0], 0x5A);
+  assert_int_equal (mSpdmRequesterHeartbeatTestPathMessageCount[1], 2);
+  assert_int_equal (SpdmContext->ReceiveTransportPath, 0);
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmReceiveResponse (SpdmContext, &SessionId[0], FALSE, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (((SPDM_MESSAGE_HEADER *)Response)->RequestResponseCode, SPDM_HEARTBEAT_ACK);
+  assert_int_equal (mSpdmRequesterHeartbeatTestPathMessageCount[1], 2);
+
+  Status = SpdmRegisterTransportPath (SpdmContext, NULL, NULL);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmSessionInfoInit (SpdmContext, &SpdmContext->SessionInfo[1], INVALID_SESSION_ID, FALSE);
+}
+
 SPDM_TEST_CONTEXT       mSpdmRequesterHeartbeatTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   TRUE,
@@ -803,6 +1285,16 @@ int SpdmRequesterHeartbeatTestMain(void) {
       cmocka_unit_test(TestSpdmRequesterHeartbeatCase8),
       // SPDM_ERROR_CODE_RESPONSE_NOT_READY + Successful response
       cmocka_unit_test(TestSpdmRequesterHeartbeatCase9),
+      // SpdmRunHeartbeats sends a due heartbeat only
+      cmocka_unit_test(TestSpdmRequesterHeartbeatCase10),
+      // Warm session pool drops an idle session whose heartbeat fails
+      cmocka_unit_test(TestSpdmRequesterHeartbeatCase11),
+      // Session multiplexer dispatches control requests first, and bulk requests by weighted fair queuing
+      cmocka_unit_test(TestSpdmRequesterHeartbeatCase12),
+      // Transport paths selected by the size of the records of an established session
+      cmocka_unit_test(TestSpdmRequesterHeartbeatCase13),
+      // Two sessions over two transport paths
+      cmocka_unit_test(TestSpdmRequesterHeartbeatCase14),
   };
   
   SetupSpdmTestContext (&mSpdmRequesterHeartbeatTestContext);
@@ -81,6 +81,7 @@ SpdmRequesterKeyExchangeTestSendMessage (
   case 0x1:
     return RETURN_DEVICE_ERROR;
   case 0x2:
+  case 0xA:
     LocalBufferSize = 0;
     MessageSize = SpdmTestGetKeyExchangeRequestSize (SpdmContext, (UINT8 *)Request + HeaderSize, RequestSize - HeaderSize);
     CopyMem (LocalBuffer, (UINT8 *)Request + HeaderSize, MessageSize);
@@ -156,6 +157,7 @@ SpdmRequesterKeyExchangeTestReceiveMessage (
     return RETURN_DEVICE_ERROR;
 
   case 0x2:
+  case 0xA:
   {
     SPDM_KEY_EXCHANGE_RESPONSE    *SpdmResponse;
     UINTN                         DheKeySize;
@@ -1000,6 +1002,56 @@ void TestSpdmRequesterKeyExchangeCase9(void **state) {
   free(Data);
 }
 
+void TestSpdmRequesterKeyExchangeCase10(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               SessionId;
+  UINT8                HeartbeatPeriod;
+  UINT8                MeasurementHash[MAX_HASH_SIZE];
+  UINT8                SlotIdParam;
+  VOID                 *Data;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+  UINT8                RandomData[SPDM_RANDOM_DATA_SIZE];
+  SPDM_SESSION_INFO    *SessionInfo;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0xA;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+  SpdmContext->ConnectionInfo.PeerUsedCertChainBufferSize = DataSize;
+  CopyMem (SpdmContext->ConnectionInfo.PeerUsedCertChainBuffer, Data, DataSize);
+
+  Status = SpdmPrestageKeyExchange (SpdmContext, MAX_SPDM_PRESTAGED_KEY_EXCHANGE_COUNT + 1);
+  assert_int_equal (Status, RETURN_INVALID_PARAMETER);
+  Status = SpdmPrestageKeyExchange (SpdmContext, 1);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_true (SpdmContext->PrestagedKeyExchange[0].Valid);
+  CopyMem (RandomData, SpdmContext->PrestagedKeyExchange[0].RandomData, SPDM_RANDOM_DATA_SIZE);
+
+  HeartbeatPeriod = 0;
+  ZeroMem(MeasurementHash, sizeof(MeasurementHash));
+  Status = SpdmSendReceiveKeyExchange (SpdmContext, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH,
+             0, &SessionId, &HeartbeatPeriod, &SlotIdParam, MeasurementHash);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_false (SpdmContext->PrestagedKeyExchange[0].Valid);
+  assert_memory_equal (((SPDM_KEY_EXCHANGE_REQUEST *)LocalBuffer)->RandomData, RandomData, SPDM_RANDOM_DATA_SIZE);
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  assert_non_null (SessionInfo);
+  assert_int_equal (SpdmSecuredMessageGetSessionState (SessionInfo->SecuredMessageContext), SpdmSessionStateHandshaking);
+  free(Data);
+}
+
 SPDM_TEST_CONTEXT       mSpdmRequesterKeyExchangeTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   TRUE,
@@ -1027,6 +1079,8 @@ int SpdmRequesterKeyExchangeTestMain(void) {
       cmocka_unit_test(TestSpdmRequesterKeyExchangeCase8),
       // SPDM_ERROR_CODE_RESPONSE_NOT_READY + Successful response
       cmocka_unit_test(TestSpdmRequesterKeyExchangeCase9),
+      // Successful response with a pre-staged request
+      cmocka_unit_test(TestSpdmRequesterKeyExchangeCase10),
   };
   
   SetupSpdmTestContext (&mSpdmRequesterKeyExchangeTestContext);
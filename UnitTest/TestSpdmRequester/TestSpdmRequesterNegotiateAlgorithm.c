@@ -47,6 +47,8 @@ SpdmRequesterNegotiateAlgorithmTestSendMessage (
     return RETURN_SUCCESS;
   case 0xC:
     return RETURN_SUCCESS;
+  case 0xD:
+    return RETURN_SUCCESS;
   default:
     return RETURN_DEVICE_ERROR;
   }
@@ -307,6 +309,27 @@ SpdmRequesterNegotiateAlgorithmTestReceiveMessage (
   }
     return RETURN_SUCCESS;
 
+  case 0xD:
+  {
+    SPDM_ALGORITHMS_RESPONSE  SpdmResponse;
+
+    ZeroMem (&SpdmResponse, sizeof(SpdmResponse));
+    SpdmResponse.Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+    SpdmResponse.Header.RequestResponseCode = SPDM_ALGORITHMS;
+    SpdmResponse.Header.Param1 = 0;
+    SpdmResponse.Header.Param2 = 0;
+    SpdmResponse.Length = sizeof(SPDM_ALGORITHMS_RESPONSE);
+    SpdmResponse.MeasurementSpecificationSel = SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF;
+    SpdmResponse.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+    SpdmResponse.BaseAsymSel = mUseAsymAlgo;
+    SpdmResponse.BaseHashSel = SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_256;
+    SpdmResponse.ExtAsymSelCount = 0;
+    SpdmResponse.ExtHashSelCount = 0;
+
+    SpdmTransportTestEncodeMessage (SpdmContext, NULL, FALSE, FALSE, sizeof(SpdmResponse), &SpdmResponse, ResponseSize, Response);
+  }
+    return RETURN_SUCCESS;
+
   default:
     return RETURN_DEVICE_ERROR;
   }
@@ -552,6 +575,36 @@ void TestSpdmRequesterNegotiateAlgorithmCase12(void **state) {
   assert_int_equal (SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo, 0);
 }
 
+void TestSpdmRequesterNegotiateAlgorithmCase13(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  SPDM_DATA_PARAMETER  Parameter;
+  UINT32               Data32;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0xD;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterCapabilities;
+  SpdmContext->LocalContext.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->LocalContext.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->LocalContext.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = 0;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = 0;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = 0;
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  Data32 = mUseHashAlgo | SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA3_384;
+  Status = SpdmSetData (SpdmContext, SpdmDataBaseHashAlgo, &Parameter, &Data32, sizeof(Data32));
+  assert_int_equal (Status, RETURN_UNSUPPORTED);
+  assert_int_equal (SpdmContext->LocalContext.Algorithm.BaseHashAlgo, mUseHashAlgo);
+
+  Status = SpdmNegotiateAlgorithms (SpdmContext);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+}
+
 SPDM_TEST_CONTEXT       mSpdmRequesterNegotiateAlgorithmTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   TRUE,
@@ -585,6 +638,8 @@ int SpdmRequesterNegotiateAlgorithmTestMain(void) {
       cmocka_unit_test(TestSpdmRequesterNegotiateAlgorithmCase11),
       // When SpdmResponse.BaseHashSel is 0
       cmocka_unit_test(TestSpdmRequesterNegotiateAlgorithmCase12),
+      // When SpdmResponse.BaseHashSel is SHA3, and SpdmSetData of a SHA3 base hash
+      cmocka_unit_test(TestSpdmRequesterNegotiateAlgorithmCase13),
   };
   
   SetupSpdmTestContext (&mSpdmRequesterNegotiateAlgorithmTestContext);
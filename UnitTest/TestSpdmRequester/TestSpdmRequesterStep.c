@@ -0,0 +1,1055 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmUnitTest.h"
+#include <SpdmRequesterLibInternal.h>
+#include <SpdmSecuredMessageLibInternal.h>
+
+#define TEST_STEP_NOT_READY_TOKEN  0x5A
+
+#pragma pack(1)
+typedef struct {
+  SPDM_MESSAGE_HEADER  Header;
+  UINT8                Reserved;
+  UINT8                VersionNumberEntryCount;
+  SPDM_VERSION_NUMBER  VersionNumberEntry[2];
+} TEST_STEP_VERSION_RESPONSE;
+
+typedef struct {
+  SPDM_MESSAGE_HEADER  Header;
+  UINT16               Length;
+  UINT8                MeasurementSpecificationSel;
+  UINT8                Reserved;
+  UINT32               MeasurementHashAlgo;
+  UINT32               BaseAsymSel;
+  UINT32               BaseHashSel;
+  UINT8                Reserved2[12];
+  UINT8                ExtAsymSelCount;
+  UINT8                ExtHashSelCount;
+  UINT16               Reserved3;
+  SPDM_NEGOTIATE_ALGORITHMS_COMMON_STRUCT_TABLE  StructTable[4];
+} TEST_STEP_ALGORITHMS_RESPONSE;
+
+typedef struct {
+  SPDM_ERROR_RESPONSE                 Header;
+  SPDM_ERROR_DATA_RESPONSE_NOT_READY  ExtendErrorData;
+} TEST_STEP_NOT_READY_RESPONSE;
+#pragma pack()
+
+//
+// The responder of the step tests. It answers the requests of one SPDM context,
+// and keeps Message A, Message B, Message K and Message F as they are on the wire,
+// so that the transcripts of the requester can be compared with them byte for byte.
+// The injected ERROR responses are not part of any transcript, so they are not kept.
+//
+typedef struct {
+  LARGE_MANAGED_BUFFER  MessageA;
+  LARGE_MANAGED_BUFFER  MessageB;
+  LARGE_MANAGED_BUFFER  MessageK;
+  LARGE_MANAGED_BUFFER  MessageF;
+  VOID                  *CertChain;
+  UINTN                 CertChainSize;
+  //
+  // BusyCount BUSY responses are sent to the requests of BusyRequestCode.
+  //
+  UINT8                 BusyRequestCode;
+  UINTN                 BusyCount;
+  //
+  // The first request of NotReadyRequestCode is answered by RESPONSE_NOT_READY,
+  // and its response is sent to the RESPOND_IF_READY.
+  //
+  UINT8                 NotReadyRequestCode;
+  UINT8                 PendingRequest[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                 PendingRequestSize;
+  UINTN                 RequestCount;
+  //
+  // The transport layer response of the blocking functions, from SendMessage to ReceiveMessage.
+  //
+  UINT8                 Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                 ResponseSize;
+} TEST_STEP_RESPONDER;
+
+TEST_STEP_RESPONDER  mTestStepResponder;
+
+//
+// SpdmDataPeerPublicRootCertHash is kept by reference, so it outlives the certificate chain it is read from.
+//
+UINT8  mTestStepRootCertHash[MAX_HASH_SIZE];
+
+/**
+  Reset the responder of the step tests for a new connection.
+**/
+VOID
+TestSpdmRequesterStepResetResponder (
+  VOID
+  )
+{
+  if (mTestStepResponder.CertChain != NULL) {
+    free (mTestStepResponder.CertChain);
+  }
+  ZeroMem (&mTestStepResponder, sizeof(mTestStepResponder));
+  InitManagedBuffer (&mTestStepResponder.MessageA, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  InitManagedBuffer (&mTestStepResponder.MessageB, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  InitManagedBuffer (&mTestStepResponder.MessageK, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  InitManagedBuffer (&mTestStepResponder.MessageF, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &mTestStepResponder.CertChain, &mTestStepResponder.CertChainSize, NULL, NULL);
+}
+
+/**
+  Build the TH of the session of the responder, Concatenate (A, Hash (Ct), K), and F if IncludeMessageF is TRUE.
+**/
+VOID
+TestSpdmRequesterStepBuildTH (
+  IN     BOOLEAN               IncludeMessageF,
+     OUT LARGE_MANAGED_BUFFER  *THCurr
+  )
+{
+  UINTN  HashSize;
+  UINT8  CertChainHash[MAX_HASH_SIZE];
+
+  HashSize = GetSpdmHashSize (mUseHashAlgo);
+  SpdmHashAll (
+    mUseHashAlgo,
+    (UINT8 *)mTestStepResponder.CertChain + sizeof(SPDM_CERT_CHAIN) + HashSize,
+    mTestStepResponder.CertChainSize - (sizeof(SPDM_CERT_CHAIN) + HashSize),
+    CertChainHash
+    );
+
+  InitManagedBuffer (THCurr, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  AppendManagedBuffer (THCurr, GetManagedBuffer (&mTestStepResponder.MessageA), GetManagedBufferSize (&mTestStepResponder.MessageA));
+  AppendManagedBuffer (THCurr, CertChainHash, HashSize);
+  AppendManagedBuffer (THCurr, GetManagedBuffer (&mTestStepResponder.MessageK), GetManagedBufferSize (&mTestStepResponder.MessageK));
+  if (IncludeMessageF) {
+    AppendManagedBuffer (THCurr, GetManagedBuffer (&mTestStepResponder.MessageF), GetManagedBufferSize (&mTestStepResponder.MessageF));
+  }
+}
+
+/**
+  Answer one SPDM request of the requester with the SPDM response of the responder of the step tests.
+**/
+RETURN_STATUS
+TestSpdmRequesterStepRespond (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  SPDM_MESSAGE_HEADER            *SpdmRequest;
+  SPDM_ERROR_RESPONSE            *ErrorResponse;
+  TEST_STEP_NOT_READY_RESPONSE   *NotReadyResponse;
+  TEST_STEP_VERSION_RESPONSE     *VersionResponse;
+  SPDM_CAPABILITIES_RESPONSE     *CapabilitiesResponse;
+  TEST_STEP_ALGORITHMS_RESPONSE  *AlgorithmsResponse;
+  SPDM_DIGESTS_RESPONSE          *DigestsResponse;
+  SPDM_GET_CERTIFICATE_REQUEST   *CertificateRequest;
+  SPDM_CERTIFICATE_RESPONSE      *CertificateResponse;
+  SPDM_KEY_EXCHANGE_RESPONSE     *KeyExchangeResponse;
+  SPDM_FINISH_RESPONSE           *FinishResponse;
+  SPDM_SESSION_INFO              *SessionInfo;
+  LARGE_MANAGED_BUFFER           THCurr;
+  VOID                           *DHEContext;
+  UINTN                          DheKeySize;
+  UINTN                          OpaqueDataSize;
+  UINTN                          SignatureSize;
+  UINTN                          HashSize;
+  UINTN                          PortionLength;
+  UINT8                          *Ptr;
+
+  SpdmRequest = Request;
+  HashSize = GetSpdmHashSize (mUseHashAlgo);
+  mTestStepResponder.RequestCount++;
+
+  if (SpdmRequest->RequestResponseCode == SPDM_RESPOND_IF_READY) {
+    if ((mTestStepResponder.PendingRequestSize == 0) ||
+        (SpdmRequest->Param1 != mTestStepResponder.PendingRequest[1]) ||
+        (SpdmRequest->Param2 != TEST_STEP_NOT_READY_TOKEN)) {
+      return RETURN_DEVICE_ERROR;
+    }
+    SpdmRequest = (VOID *)mTestStepResponder.PendingRequest;
+    RequestSize = mTestStepResponder.PendingRequestSize;
+    mTestStepResponder.PendingRequestSize = 0;
+  } else if ((SpdmRequest->RequestResponseCode == mTestStepResponder.BusyRequestCode) &&
+             (mTestStepResponder.BusyCount != 0)) {
+    mTestStepResponder.BusyCount--;
+    ErrorResponse = Response;
+    ErrorResponse->Header.SPDMVersion = SpdmRequest->SPDMVersion;
+    ErrorResponse->Header.RequestResponseCode = SPDM_ERROR;
+    ErrorResponse->Header.Param1 = SPDM_ERROR_CODE_BUSY;
+    ErrorResponse->Header.Param2 = 0;
+    *ResponseSize = sizeof(SPDM_ERROR_RESPONSE);
+    return RETURN_SUCCESS;
+  } else if (SpdmRequest->RequestResponseCode == mTestStepResponder.NotReadyRequestCode) {
+    mTestStepResponder.NotReadyRequestCode = 0;
+    CopyMem (mTestStepResponder.PendingRequest, SpdmRequest, RequestSize);
+    mTestStepResponder.PendingRequestSize = RequestSize;
+    NotReadyResponse = Response;
+    NotReadyResponse->Header.Header.SPDMVersion = SpdmRequest->SPDMVersion;
+    NotReadyResponse->Header.Header.RequestResponseCode = SPDM_ERROR;
+    NotReadyResponse->Header.Header.Param1 = SPDM_ERROR_CODE_RESPONSE_NOT_READY;
+    NotReadyResponse->Header.Header.Param2 = 0;
+    NotReadyResponse->ExtendErrorData.RDTExponent = 0;
+    NotReadyResponse->ExtendErrorData.RequestCode = SpdmRequest->RequestResponseCode;
+    NotReadyResponse->ExtendErrorData.Token = TEST_STEP_NOT_READY_TOKEN;
+    NotReadyResponse->ExtendErrorData.RDTM = 1;
+    *ResponseSize = sizeof(TEST_STEP_NOT_READY_RESPONSE);
+    return RETURN_SUCCESS;
+  }
+
+  switch (SpdmRequest->RequestResponseCode) {
+  case SPDM_GET_VERSION:
+    VersionResponse = Response;
+    ZeroMem (VersionResponse, sizeof(TEST_STEP_VERSION_RESPONSE));
+    VersionResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+    VersionResponse->Header.RequestResponseCode = SPDM_VERSION;
+    VersionResponse->VersionNumberEntryCount = 2;
+    VersionResponse->VersionNumberEntry[0].MajorVersion = 1;
+    VersionResponse->VersionNumberEntry[0].MinorVersion = 0;
+    VersionResponse->VersionNumberEntry[1].MajorVersion = 1;
+    VersionResponse->VersionNumberEntry[1].MinorVersion = 1;
+    *ResponseSize = sizeof(TEST_STEP_VERSION_RESPONSE);
+    ResetManagedBuffer (&mTestStepResponder.MessageA);
+    ResetManagedBuffer (&mTestStepResponder.MessageB);
+    AppendManagedBuffer (&mTestStepResponder.MessageA, SpdmRequest, RequestSize);
+    AppendManagedBuffer (&mTestStepResponder.MessageA, Response, *ResponseSize);
+    return RETURN_SUCCESS;
+
+  case SPDM_GET_CAPABILITIES:
+    CapabilitiesResponse = Response;
+    ZeroMem (CapabilitiesResponse, sizeof(SPDM_CAPABILITIES_RESPONSE));
+    CapabilitiesResponse->Header.SPDMVersion = SpdmRequest->SPDMVersion;
+    CapabilitiesResponse->Header.RequestResponseCode = SPDM_CAPABILITIES;
+    CapabilitiesResponse->Flags = SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP |
+                                  SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP |
+                                  SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCRYPT_CAP |
+                                  SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MAC_CAP |
+                                  SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP |
+                                  SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP;
+    *ResponseSize = sizeof(SPDM_CAPABILITIES_RESPONSE);
+    AppendManagedBuffer (&mTestStepResponder.MessageA, SpdmRequest, RequestSize);
+    AppendManagedBuffer (&mTestStepResponder.MessageA, Response, *ResponseSize);
+    return RETURN_SUCCESS;
+
+  case SPDM_NEGOTIATE_ALGORITHMS:
+    AlgorithmsResponse = Response;
+    ZeroMem (AlgorithmsResponse, sizeof(TEST_STEP_ALGORITHMS_RESPONSE));
+    AlgorithmsResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+    AlgorithmsResponse->Header.RequestResponseCode = SPDM_ALGORITHMS;
+    AlgorithmsResponse->Header.Param1 = 4;
+    AlgorithmsResponse->Length = sizeof(TEST_STEP_ALGORITHMS_RESPONSE);
+    AlgorithmsResponse->MeasurementSpecificationSel = mUseMeasurementSpec;
+    AlgorithmsResponse->MeasurementHashAlgo = mUseMeasurementHashAlgo;
+    AlgorithmsResponse->BaseAsymSel = mUseAsymAlgo;
+    AlgorithmsResponse->BaseHashSel = mUseHashAlgo;
+    AlgorithmsResponse->StructTable[0].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_DHE;
+    AlgorithmsResponse->StructTable[0].AlgCount = 0x20;
+    AlgorithmsResponse->StructTable[0].AlgSupported = mUseDheAlgo;
+    AlgorithmsResponse->StructTable[1].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_AEAD;
+    AlgorithmsResponse->StructTable[1].AlgCount = 0x20;
+    AlgorithmsResponse->StructTable[1].AlgSupported = mUseAeadAlgo;
+    AlgorithmsResponse->StructTable[2].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_REQ_BASE_ASYM_ALG;
+    AlgorithmsResponse->StructTable[2].AlgCount = 0x20;
+    AlgorithmsResponse->StructTable[2].AlgSupported = mUseReqAsymAlgo;
+    AlgorithmsResponse->StructTable[3].AlgType = SPDM_NEGOTIATE_ALGORITHMS_STRUCT_TABLE_ALG_TYPE_KEY_SCHEDULE;
+    AlgorithmsResponse->StructTable[3].AlgCount = 0x20;
+    AlgorithmsResponse->StructTable[3].AlgSupported = mUseKeyScheduleAlgo;
+    *ResponseSize = sizeof(TEST_STEP_ALGORITHMS_RESPONSE);
+    AppendManagedBuffer (&mTestStepResponder.MessageA, SpdmRequest, RequestSize);
+    AppendManagedBuffer (&mTestStepResponder.MessageA, Response, *ResponseSize);
+    return RETURN_SUCCESS;
+
+  case SPDM_GET_DIGESTS:
+    DigestsResponse = Response;
+    ZeroMem (DigestsResponse, sizeof(SPDM_DIGESTS_RESPONSE));
+    DigestsResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+    DigestsResponse->Header.RequestResponseCode = SPDM_DIGESTS;
+    DigestsResponse->Header.Param2 = BIT0;
+    SpdmHashAll (mUseHashAlgo, mTestStepResponder.CertChain, mTestStepResponder.CertChainSize, (UINT8 *)(DigestsResponse + 1));
+    *ResponseSize = sizeof(SPDM_DIGESTS_RESPONSE) + HashSize;
+    AppendManagedBuffer (&mTestStepResponder.MessageB, SpdmRequest, RequestSize);
+    AppendManagedBuffer (&mTestStepResponder.MessageB, Response, *ResponseSize);
+    return RETURN_SUCCESS;
+
+  case SPDM_GET_CERTIFICATE:
+    CertificateRequest = (VOID *)SpdmRequest;
+    if (CertificateRequest->Offset >= mTestStepResponder.CertChainSize) {
+      return RETURN_DEVICE_ERROR;
+    }
+    PortionLength = MIN (CertificateRequest->Length, mTestStepResponder.CertChainSize - CertificateRequest->Offset);
+    CertificateResponse = Response;
+    ZeroMem (CertificateResponse, sizeof(SPDM_CERTIFICATE_RESPONSE));
+    CertificateResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+    CertificateResponse->Header.RequestResponseCode = SPDM_CERTIFICATE;
+    CertificateResponse->Header.Param1 = CertificateRequest->Header.Param1;
+    CertificateResponse->PortionLength = (UINT16)PortionLength;
+    CertificateResponse->RemainderLength = (UINT16)(mTestStepResponder.CertChainSize - CertificateRequest->Offset - PortionLength);
+    CopyMem (CertificateResponse + 1, (UINT8 *)mTestStepResponder.CertChain + CertificateRequest->Offset, PortionLength);
+    *ResponseSize = sizeof(SPDM_CERTIFICATE_RESPONSE) + PortionLength;
+    AppendManagedBuffer (&mTestStepResponder.MessageB, SpdmRequest, RequestSize);
+    AppendManagedBuffer (&mTestStepResponder.MessageB, Response, *ResponseSize);
+    return RETURN_SUCCESS;
+
+  case SPDM_KEY_EXCHANGE:
+    //
+    // HANDSHAKE_IN_THE_CLEAR_CAP is negotiated, so the KEY_EXCHANGE_RSP has no ResponderVerifyData.
+    //
+    DheKeySize = GetSpdmDhePubKeySize (mUseDheAlgo);
+    OpaqueDataSize = SpdmGetOpaqueDataVersionSelectionDataSize (SpdmContext);
+    SignatureSize = GetSpdmAsymSignatureSize (mUseAsymAlgo);
+    KeyExchangeResponse = Response;
+    ZeroMem (KeyExchangeResponse, sizeof(SPDM_KEY_EXCHANGE_RESPONSE));
+    KeyExchangeResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+    KeyExchangeResponse->Header.RequestResponseCode = SPDM_KEY_EXCHANGE_RSP;
+    KeyExchangeResponse->RspSessionID = SpdmAllocateRspSessionId (SpdmContext);
+    SpdmGetRandomNumber (SPDM_RANDOM_DATA_SIZE, KeyExchangeResponse->RandomData);
+    Ptr = (VOID *)(KeyExchangeResponse + 1);
+    DHEContext = SpdmDheNew (mUseDheAlgo);
+    SpdmDheGenerateKey (mUseDheAlgo, DHEContext, Ptr, &DheKeySize);
+    SpdmDheFree (mUseDheAlgo, DHEContext);
+    Ptr += DheKeySize;
+    *(UINT16 *)Ptr = (UINT16)OpaqueDataSize;
+    Ptr += sizeof(UINT16);
+    SpdmBuildOpaqueDataVersionSelectionData (SpdmContext, &OpaqueDataSize, Ptr);
+    Ptr += OpaqueDataSize;
+
+    //
+    // The test transport layer pads the request to TEST_ALIGNMENT, and Message K has the request without the padding.
+    //
+    RequestSize = sizeof(SPDM_KEY_EXCHANGE_REQUEST) + DheKeySize;
+    RequestSize += sizeof(UINT16) + *(UINT16 *)((UINT8 *)SpdmRequest + RequestSize);
+
+    ResetManagedBuffer (&mTestStepResponder.MessageK);
+    ResetManagedBuffer (&mTestStepResponder.MessageF);
+    AppendManagedBuffer (&mTestStepResponder.MessageK, SpdmRequest, RequestSize);
+    AppendManagedBuffer (&mTestStepResponder.MessageK, Response, (UINTN)Ptr - (UINTN)Response);
+    TestSpdmRequesterStepBuildTH (FALSE, &THCurr);
+    SpdmResponderDataSignFunc (mUseAsymAlgo, mUseHashAlgo, GetManagedBuffer (&THCurr), GetManagedBufferSize (&THCurr), Ptr, &SignatureSize);
+    AppendManagedBuffer (&mTestStepResponder.MessageK, Ptr, SignatureSize);
+    Ptr += SignatureSize;
+    *ResponseSize = (UINTN)Ptr - (UINTN)Response;
+    return RETURN_SUCCESS;
+
+  case SPDM_FINISH:
+    //
+    // The ResponseFinishedKey is derived from the DHE secret that only the requester holds,
+    // so the FINISH_RSP is signed with the key of the session of the requester.
+    //
+    SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SpdmContext->LatestSessionId);
+    if (SessionInfo == NULL) {
+      return RETURN_DEVICE_ERROR;
+    }
+    FinishResponse = Response;
+    ZeroMem (FinishResponse, sizeof(SPDM_FINISH_RESPONSE));
+    FinishResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+    FinishResponse->Header.RequestResponseCode = SPDM_FINISH_RSP;
+    AppendManagedBuffer (&mTestStepResponder.MessageF, SpdmRequest, RequestSize);
+    AppendManagedBuffer (&mTestStepResponder.MessageF, Response, sizeof(SPDM_FINISH_RESPONSE));
+    Ptr = (UINT8 *)(FinishResponse + 1);
+    TestSpdmRequesterStepBuildTH (TRUE, &THCurr);
+    SpdmHmacAllWithResponseFinishedKey (SessionInfo->SecuredMessageContext, GetManagedBuffer (&THCurr), GetManagedBufferSize (&THCurr), Ptr);
+    AppendManagedBuffer (&mTestStepResponder.MessageF, Ptr, HashSize);
+    *ResponseSize = sizeof(SPDM_FINISH_RESPONSE) + HashSize;
+    return RETURN_SUCCESS;
+
+  default:
+    return RETURN_DEVICE_ERROR;
+  }
+}
+
+/**
+  Pass one transport layer request message through the responder of the step tests,
+  and return its transport layer response message.
+**/
+RETURN_STATUS
+TestSpdmRequesterStepTransact (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  RETURN_STATUS  Status;
+  UINT32         *SessionId;
+  BOOLEAN        IsAppMessage;
+  UINT8          SpdmRequest[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN          SpdmRequestSize;
+  UINT8          SpdmResponse[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN          SpdmResponseSize;
+
+  SpdmRequestSize = sizeof(SpdmRequest);
+  Status = SpdmTransportTestDecodeMessage (SpdmContext, &SessionId, &IsAppMessage, TRUE, RequestSize, Request, &SpdmRequestSize, SpdmRequest);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  //
+  // The handshake is in the clear, and no secured message is sent in the step tests.
+  //
+  if (SessionId != NULL) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  SpdmResponseSize = sizeof(SpdmResponse);
+  Status = TestSpdmRequesterStepRespond (SpdmContext, SpdmRequestSize, SpdmRequest, &SpdmResponseSize, SpdmResponse);
+  if (RETURN_ERROR(Status)) {
+    return Status;
+  }
+  return SpdmTransportTestEncodeMessage (SpdmContext, NULL, FALSE, FALSE, SpdmResponseSize, SpdmResponse, ResponseSize, Response);
+}
+
+RETURN_STATUS
+EFIAPI
+SpdmRequesterStepTestSendMessage (
+  IN     VOID                    *SpdmContext,
+  IN     UINTN                   RequestSize,
+  IN     VOID                    *Request,
+  IN     UINT64                  Timeout
+  )
+{
+  mTestStepResponder.ResponseSize = sizeof(mTestStepResponder.Response);
+  return TestSpdmRequesterStepTransact (SpdmContext, RequestSize, Request, &mTestStepResponder.ResponseSize, mTestStepResponder.Response);
+}
+
+RETURN_STATUS
+EFIAPI
+SpdmRequesterStepTestReceiveMessage (
+  IN     VOID                    *SpdmContext,
+  IN OUT UINTN                   *ResponseSize,
+  IN OUT VOID                    *Response,
+  IN     UINT64                  Timeout
+  )
+{
+  if (*ResponseSize < mTestStepResponder.ResponseSize) {
+    return RETURN_DEVICE_ERROR;
+  }
+  CopyMem (Response, mTestStepResponder.Response, mTestStepResponder.ResponseSize);
+  *ResponseSize = mTestStepResponder.ResponseSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Initialize an SPDM context for the step tests, with the algorithms and capabilities of the responder.
+**/
+VOID
+TestSpdmRequesterStepInitContext (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_DATA_PARAMETER  Parameter;
+  UINT8                Data8;
+  UINT16               Data16;
+  UINT32               Data32;
+  VOID                 *Data;
+  UINTN                DataSize;
+  VOID                 *Hash;
+  UINTN                HashSize;
+
+  SpdmInitContext (SpdmContext);
+  SpdmRegisterDeviceIoFunc (SpdmContext, SpdmRequesterStepTestSendMessage, SpdmRequesterStepTestReceiveMessage);
+  SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportTestEncodeMessage, SpdmTransportTestDecodeMessage);
+
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  Data32 = SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCRYPT_CAP |
+           SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP |
+           SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP |
+           SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HANDSHAKE_IN_THE_CLEAR_CAP;
+  SpdmSetData (SpdmContext, SpdmDataCapabilityFlags, &Parameter, &Data32, sizeof(Data32));
+  Data8 = mUseMeasurementSpec;
+  SpdmSetData (SpdmContext, SpdmDataMeasurementSpec, &Parameter, &Data8, sizeof(Data8));
+  Data32 = mUseAsymAlgo;
+  SpdmSetData (SpdmContext, SpdmDataBaseAsymAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data32 = mUseHashAlgo;
+  SpdmSetData (SpdmContext, SpdmDataBaseHashAlgo, &Parameter, &Data32, sizeof(Data32));
+  Data16 = mUseDheAlgo;
+  SpdmSetData (SpdmContext, SpdmDataDHENamedGroup, &Parameter, &Data16, sizeof(Data16));
+  Data16 = mUseAeadAlgo;
+  SpdmSetData (SpdmContext, SpdmDataAEADCipherSuite, &Parameter, &Data16, sizeof(Data16));
+  Data16 = mUseReqAsymAlgo;
+  SpdmSetData (SpdmContext, SpdmDataReqBaseAsymAlg, &Parameter, &Data16, sizeof(Data16));
+  Data16 = mUseKeyScheduleAlgo;
+  SpdmSetData (SpdmContext, SpdmDataKeySchedule, &Parameter, &Data16, sizeof(Data16));
+
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data, &DataSize, &Hash, &HashSize);
+  CopyMem (mTestStepRootCertHash, Hash, HashSize);
+  free (Data);
+  SpdmSetData (SpdmContext, SpdmDataPeerPublicRootCertHash, &Parameter, mTestStepRootCertHash, HashSize);
+}
+
+/**
+  Initialize the SPDM context of the test context again for the step tests.
+**/
+SPDM_DEVICE_CONTEXT *
+TestSpdmRequesterStepSetup (
+  IN     void                 **state
+  )
+{
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmDeinitContext (SpdmContext);
+  TestSpdmRequesterStepInitContext (SpdmContext);
+  TestSpdmRequesterStepResetResponder ();
+  return SpdmContext;
+}
+
+/**
+  Drive the operation started by a SpdmRequesterBegin function to its end, with the responder of the step tests.
+**/
+RETURN_STATUS
+TestSpdmRequesterStepRun (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  RETURN_STATUS  Status;
+  UINT8          OutgoingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN          OutgoingMessageSize;
+  UINT8          IncomingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN          IncomingMessageSize;
+  VOID           *Incoming;
+
+  Incoming = NULL;
+  IncomingMessageSize = 0;
+  while (TRUE) {
+    OutgoingMessageSize = sizeof(OutgoingMessage);
+    Status = SpdmRequesterStep (SpdmContext, IncomingMessageSize, Incoming, &OutgoingMessageSize, OutgoingMessage);
+    if (Status != RETURN_NOT_READY) {
+      assert_int_equal (OutgoingMessageSize, 0);
+      return Status;
+    }
+    IncomingMessageSize = sizeof(IncomingMessage);
+    Status = TestSpdmRequesterStepTransact (SpdmContext, OutgoingMessageSize, OutgoingMessage, &IncomingMessageSize, IncomingMessage);
+    if (RETURN_ERROR(Status)) {
+      SpdmRequesterAbort (SpdmContext);
+      return Status;
+    }
+    Incoming = IncomingMessage;
+  }
+}
+
+/**
+  Connect to the responder of the step tests with SpdmRequesterStep, up to the certificate chain of slot 0.
+**/
+VOID
+TestSpdmRequesterStepConnect (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  RETURN_STATUS  Status;
+  UINT8          SlotMask;
+  UINT8          TotalDigestBuffer[MAX_HASH_SIZE * MAX_SPDM_SLOT_COUNT];
+  UINTN          CertChainSize;
+  UINT8          CertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+
+  Status = SpdmRequesterBeginInitConnection (SpdmContext, FALSE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateNegotiated);
+
+  Status = SpdmRequesterBeginGetDigest (SpdmContext, &SlotMask, TotalDigestBuffer);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SlotMask, BIT0);
+
+  CertChainSize = sizeof(CertChain);
+  Status = SpdmRequesterBeginGetCertificate (SpdmContext, 0, &CertChainSize, CertChain);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (CertChainSize, mTestStepResponder.CertChainSize);
+  assert_memory_equal (CertChain, mTestStepResponder.CertChain, CertChainSize);
+}
+
+/**
+  Start a session with the responder of the step tests with SpdmRequesterStep.
+**/
+UINT32
+TestSpdmRequesterStepStartSession (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  RETURN_STATUS  Status;
+  UINT32         SessionId;
+  UINT8          HeartbeatPeriod;
+  UINT8          MeasurementHash[MAX_HASH_SIZE];
+
+  Status = SpdmRequesterBeginStartSession (SpdmContext, FALSE, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, 0, &SessionId, &HeartbeatPeriod, MeasurementHash);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  return SessionId;
+}
+
+/**
+  Check Message A and Message B of the requester against the messages of the responder.
+  The requester keeps Message B only as the running hash of Concatenate (A, B).
+**/
+VOID
+TestSpdmRequesterStepCheckMessageAB (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SPDM_MESSAGE_DIGEST  *MessageBDigest;
+  VOID                 *HashContext;
+  UINT8                HashData[MAX_HASH_SIZE];
+  UINT8                ExpectedHashData[MAX_HASH_SIZE];
+
+  assert_int_equal (GetManagedBufferSize (&SpdmContext->Transcript.MessageA), GetManagedBufferSize (&mTestStepResponder.MessageA));
+  assert_memory_equal (GetManagedBuffer (&SpdmContext->Transcript.MessageA), GetManagedBuffer (&mTestStepResponder.MessageA), GetManagedBufferSize (&mTestStepResponder.MessageA));
+
+  MessageBDigest = &SpdmContext->Transcript.MessageBDigest;
+  assert_int_equal (MessageBDigest->BufferSize, GetManagedBufferSize (&mTestStepResponder.MessageB));
+  if (MessageBDigest->BufferSize == 0) {
+    return;
+  }
+  HashContext = SpdmHashNew (mUseHashAlgo);
+  assert_non_null (HashContext);
+  SpdmHashDuplicate (mUseHashAlgo, MessageBDigest->HashContext, HashContext);
+  SpdmHashUpdate (mUseHashAlgo, HashContext, MessageBDigest->PendingBuffer, MessageBDigest->PendingBufferSize);
+  SpdmHashFinal (mUseHashAlgo, HashContext, HashData);
+  SpdmHashFree (mUseHashAlgo, HashContext);
+
+  HashContext = SpdmHashNew (mUseHashAlgo);
+  assert_non_null (HashContext);
+  SpdmHashUpdate (mUseHashAlgo, HashContext, GetManagedBuffer (&mTestStepResponder.MessageA), GetManagedBufferSize (&mTestStepResponder.MessageA));
+  SpdmHashUpdate (mUseHashAlgo, HashContext, GetManagedBuffer (&mTestStepResponder.MessageB), GetManagedBufferSize (&mTestStepResponder.MessageB));
+  SpdmHashFinal (mUseHashAlgo, HashContext, ExpectedHashData);
+  SpdmHashFree (mUseHashAlgo, HashContext);
+
+  assert_memory_equal (HashData, ExpectedHashData, GetSpdmHashSize (mUseHashAlgo));
+}
+
+/**
+  Check a segmented transcript of a session of the requester against the messages of the responder.
+**/
+VOID
+TestSpdmRequesterStepCheckSegmentedBuffer (
+  IN     SEGMENTED_MANAGED_BUFFER  *Transcript,
+  IN     LARGE_MANAGED_BUFFER      *ExpectedTranscript
+  )
+{
+  VOID   *Segment;
+  UINTN  SegmentSize;
+  UINTN  Offset;
+
+  assert_int_equal (GetManagedBufferSize (Transcript), GetManagedBufferSize (ExpectedTranscript));
+  Offset = 0;
+  while ((Segment = GetManagedBufferSegment (Transcript, Offset, &SegmentSize)) != NULL) {
+    assert_memory_equal (Segment, (UINT8 *)GetManagedBuffer (ExpectedTranscript) + Offset, SegmentSize);
+    Offset += SegmentSize;
+  }
+  assert_int_equal (Offset, GetManagedBufferSize (ExpectedTranscript));
+}
+
+/**
+  Check that the session of the requester is established, and its Message K and Message F
+  against the messages of the responder.
+**/
+VOID
+TestSpdmRequesterStepCheckSession (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId
+  )
+{
+  SPDM_SESSION_INFO  *SessionInfo;
+
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId);
+  assert_non_null (SessionInfo);
+  assert_int_equal (SpdmSecuredMessageGetSessionState (SessionInfo->SecuredMessageContext), SpdmSessionStateEstablished);
+  TestSpdmRequesterStepCheckSegmentedBuffer (&SessionInfo->SessionTranscript.MessageK, &mTestStepResponder.MessageK);
+  TestSpdmRequesterStepCheckSegmentedBuffer (&SessionInfo->SessionTranscript.MessageF, &mTestStepResponder.MessageF);
+}
+
+/**
+  Test 1: VCA, GET_DIGESTS, GET_CERTIFICATE, KEY_EXCHANGE and FINISH with the blocking functions and with SpdmRequesterStep
+  Expected Behavior: both get RETURN_SUCCESS with the same Message A and Message B, and the Message K and Message F of the messages on the wire
+**/
+void TestSpdmRequesterStepCase1(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  SPDM_DEVICE_CONTEXT  *BlockingContext;
+  UINT8                SlotMask;
+  UINT8                TotalDigestBuffer[MAX_HASH_SIZE * MAX_SPDM_SLOT_COUNT];
+  UINTN                CertChainSize;
+  UINT8                CertChain[MAX_SPDM_CERT_CHAIN_SIZE];
+  UINT32               SessionId;
+  UINT8                HeartbeatPeriod;
+  UINT8                MeasurementHash[MAX_HASH_SIZE];
+  UINTN                MessageKSize;
+  UINTN                MessageFSize;
+
+  BlockingContext = (VOID *)malloc (SpdmGetContextSize());
+  assert_non_null (BlockingContext);
+  TestSpdmRequesterStepInitContext (BlockingContext);
+  TestSpdmRequesterStepResetResponder ();
+
+  Status = SpdmInitConnection (BlockingContext, FALSE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmGetDigest (BlockingContext, &SlotMask, TotalDigestBuffer);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  CertChainSize = sizeof(CertChain);
+  Status = SpdmGetCertificate (BlockingContext, 0, &CertChainSize, CertChain);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  TestSpdmRequesterStepCheckMessageAB (BlockingContext);
+  Status = SpdmStartSession (BlockingContext, FALSE, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, 0, &SessionId, &HeartbeatPeriod, MeasurementHash);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  TestSpdmRequesterStepCheckSession (BlockingContext, SessionId);
+  MessageKSize = GetManagedBufferSize (&mTestStepResponder.MessageK);
+  MessageFSize = GetManagedBufferSize (&mTestStepResponder.MessageF);
+
+  //
+  // The messages of VCA, GET_DIGESTS and GET_CERTIFICATE are the same in both runs,
+  // so Message A and Message B of SpdmRequesterStep are also checked against the blocking functions.
+  // KEY_EXCHANGE and FINISH carry fresh random data and DHE keys, so only their sizes are the same.
+  //
+  SpdmContext = TestSpdmRequesterStepSetup (state);
+  TestSpdmRequesterStepConnect (SpdmContext);
+  TestSpdmRequesterStepCheckMessageAB (SpdmContext);
+  assert_int_equal (GetManagedBufferSize (&SpdmContext->Transcript.MessageA), GetManagedBufferSize (&BlockingContext->Transcript.MessageA));
+  assert_memory_equal (GetManagedBuffer (&SpdmContext->Transcript.MessageA), GetManagedBuffer (&BlockingContext->Transcript.MessageA), GetManagedBufferSize (&BlockingContext->Transcript.MessageA));
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, BlockingContext->Transcript.MessageBDigest.BufferSize);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.PendingBufferSize, BlockingContext->Transcript.MessageBDigest.PendingBufferSize);
+  assert_memory_equal (SpdmContext->Transcript.MessageBDigest.PendingBuffer, BlockingContext->Transcript.MessageBDigest.PendingBuffer, BlockingContext->Transcript.MessageBDigest.PendingBufferSize);
+
+  SessionId = TestSpdmRequesterStepStartSession (SpdmContext);
+  TestSpdmRequesterStepCheckSession (SpdmContext, SessionId);
+  assert_int_equal (GetManagedBufferSize (&mTestStepResponder.MessageK), MessageKSize);
+  assert_int_equal (GetManagedBufferSize (&mTestStepResponder.MessageF), MessageFSize);
+
+  SpdmDeinitContext (BlockingContext);
+  free (BlockingContext);
+}
+
+/**
+  Test 2: BUSY to NEGOTIATE_ALGORITHMS and to KEY_EXCHANGE with SpdmRequesterStep
+  Expected Behavior: the requests are sent again, get RETURN_SUCCESS, and the ERROR responses are not in any transcript
+**/
+void TestSpdmRequesterStepCase2(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               SessionId;
+
+  SpdmContext = TestSpdmRequesterStepSetup (state);
+  mTestStepResponder.BusyRequestCode = SPDM_NEGOTIATE_ALGORITHMS;
+  mTestStepResponder.BusyCount = 2;
+  Status = SpdmRequesterBeginInitConnection (SpdmContext, FALSE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mTestStepResponder.BusyCount, 0);
+  assert_int_equal (mTestStepResponder.RequestCount, 5);
+  TestSpdmRequesterStepCheckMessageAB (SpdmContext);
+
+  SpdmContext = TestSpdmRequesterStepSetup (state);
+  TestSpdmRequesterStepConnect (SpdmContext);
+  mTestStepResponder.BusyRequestCode = SPDM_KEY_EXCHANGE;
+  mTestStepResponder.BusyCount = 1;
+  SessionId = TestSpdmRequesterStepStartSession (SpdmContext);
+  assert_int_equal (mTestStepResponder.BusyCount, 0);
+  TestSpdmRequesterStepCheckSession (SpdmContext, SessionId);
+}
+
+/**
+  Test 3: BUSY to every GET_DIGESTS with SpdmRequesterStep
+  Expected Behavior: get RETURN_NO_RESPONSE after RetryTimes retries, and the operation ends with Message B unchanged
+**/
+void TestSpdmRequesterStepCase3(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT8                SlotMask;
+  UINT8                TotalDigestBuffer[MAX_HASH_SIZE * MAX_SPDM_SLOT_COUNT];
+  UINT8                OutgoingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                OutgoingMessageSize;
+
+  SpdmContext = TestSpdmRequesterStepSetup (state);
+  Status = SpdmRequesterBeginInitConnection (SpdmContext, FALSE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  mTestStepResponder.BusyRequestCode = SPDM_GET_DIGESTS;
+  mTestStepResponder.BusyCount = MAX_UINTN;
+  mTestStepResponder.RequestCount = 0;
+  Status = SpdmRequesterBeginGetDigest (SpdmContext, &SlotMask, TotalDigestBuffer);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_NO_RESPONSE);
+  assert_int_equal (mTestStepResponder.RequestCount, SpdmContext->RetryTimes + 1);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
+
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, 0, NULL, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_STARTED);
+}
+
+/**
+  Test 4: RESPONSE_NOT_READY to KEY_EXCHANGE with SpdmRequesterStep
+  Expected Behavior: RESPOND_IF_READY is sent with the token, gets RETURN_SUCCESS, and Message K is the KEY_EXCHANGE and the KEY_EXCHANGE_RSP
+**/
+void TestSpdmRequesterStepCase4(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               SessionId;
+  UINT8                HeartbeatPeriod;
+  UINT8                MeasurementHash[MAX_HASH_SIZE];
+  UINT8                OutgoingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                OutgoingMessageSize;
+  UINT8                IncomingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                IncomingMessageSize;
+  SPDM_MESSAGE_HEADER  *SpdmRequest;
+
+  SpdmContext = TestSpdmRequesterStepSetup (state);
+  TestSpdmRequesterStepConnect (SpdmContext);
+  mTestStepResponder.NotReadyRequestCode = SPDM_KEY_EXCHANGE;
+
+  Status = SpdmRequesterBeginStartSession (SpdmContext, FALSE, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, 0, &SessionId, &HeartbeatPeriod, MeasurementHash);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, 0, NULL, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_READY);
+  IncomingMessageSize = sizeof(IncomingMessage);
+  Status = TestSpdmRequesterStepTransact (SpdmContext, OutgoingMessageSize, OutgoingMessage, &IncomingMessageSize, IncomingMessage);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mTestStepResponder.PendingRequestSize, OutgoingMessageSize - sizeof(TEST_MESSAGE_HEADER));
+
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, IncomingMessageSize, IncomingMessage, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_READY);
+  SpdmRequest = (VOID *)(OutgoingMessage + sizeof(TEST_MESSAGE_HEADER));
+  assert_int_equal (SpdmRequest->RequestResponseCode, SPDM_RESPOND_IF_READY);
+  assert_int_equal (SpdmRequest->Param1, SPDM_KEY_EXCHANGE);
+  assert_int_equal (SpdmRequest->Param2, TEST_STEP_NOT_READY_TOKEN);
+  IncomingMessageSize = sizeof(IncomingMessage);
+  Status = TestSpdmRequesterStepTransact (SpdmContext, OutgoingMessageSize, OutgoingMessage, &IncomingMessageSize, IncomingMessage);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  //
+  // The KEY_EXCHANGE_RSP goes on to FINISH.
+  //
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, IncomingMessageSize, IncomingMessage, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_READY);
+  SpdmRequest = (VOID *)(OutgoingMessage + sizeof(TEST_MESSAGE_HEADER));
+  assert_int_equal (SpdmRequest->RequestResponseCode, SPDM_FINISH);
+  IncomingMessageSize = sizeof(IncomingMessage);
+  Status = TestSpdmRequesterStepTransact (SpdmContext, OutgoingMessageSize, OutgoingMessage, &IncomingMessageSize, IncomingMessage);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, IncomingMessageSize, IncomingMessage, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (OutgoingMessageSize, 0);
+
+  TestSpdmRequesterStepCheckSession (SpdmContext, SessionId);
+}
+
+/**
+  Test 5: SpdmRequesterAbort while GET_DIGESTS waits for its response
+  Expected Behavior: Message B is unchanged, SpdmRequesterStep gets RETURN_NOT_STARTED, and GET_DIGESTS can be started again
+**/
+void TestSpdmRequesterStepCase5(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT8                SlotMask;
+  UINT8                TotalDigestBuffer[MAX_HASH_SIZE * MAX_SPDM_SLOT_COUNT];
+  UINT8                OutgoingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                OutgoingMessageSize;
+  UINT8                IncomingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                IncomingMessageSize;
+
+  SpdmContext = TestSpdmRequesterStepSetup (state);
+  Status = SpdmRequesterBeginInitConnection (SpdmContext, FALSE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  Status = SpdmRequesterBeginGetDigest (SpdmContext, &SlotMask, TotalDigestBuffer);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, 0, NULL, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_READY);
+  //
+  // The responder answers, but the response is dropped by the caller.
+  //
+  IncomingMessageSize = sizeof(IncomingMessage);
+  Status = TestSpdmRequesterStepTransact (SpdmContext, OutgoingMessageSize, OutgoingMessage, &IncomingMessageSize, IncomingMessage);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  ResetManagedBuffer (&mTestStepResponder.MessageB);
+
+  SpdmRequesterAbort (SpdmContext);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, IncomingMessageSize, IncomingMessage, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_STARTED);
+
+  Status = SpdmRequesterBeginGetDigest (SpdmContext, &SlotMask, TotalDigestBuffer);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SlotMask, BIT0);
+  TestSpdmRequesterStepCheckMessageAB (SpdmContext);
+}
+
+/**
+  Test 6: SpdmRequesterAbort while KEY_EXCHANGE waits for its response
+  Expected Behavior: the DHE context is freed, no session is established, and a session can be started again
+**/
+void TestSpdmRequesterStepCase6(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               SessionId;
+  UINT8                HeartbeatPeriod;
+  UINT8                MeasurementHash[MAX_HASH_SIZE];
+  UINT8                OutgoingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                OutgoingMessageSize;
+
+  SpdmContext = TestSpdmRequesterStepSetup (state);
+  TestSpdmRequesterStepConnect (SpdmContext);
+
+  SessionId = INVALID_SESSION_ID;
+  Status = SpdmRequesterBeginStartSession (SpdmContext, FALSE, SPDM_CHALLENGE_REQUEST_NO_MEASUREMENT_SUMMARY_HASH, 0, &SessionId, &HeartbeatPeriod, MeasurementHash);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, 0, NULL, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_READY);
+  assert_non_null (SpdmContext->RequesterStep.DHEContext);
+
+  SpdmRequesterAbort (SpdmContext);
+  assert_null (SpdmContext->RequesterStep.DHEContext);
+  assert_int_equal (SpdmContext->RequesterStep.Stage, SpdmRequesterStepStageNone);
+  assert_int_equal (SessionId, INVALID_SESSION_ID);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, 0, NULL, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_STARTED);
+
+  SessionId = TestSpdmRequesterStepStartSession (SpdmContext);
+  TestSpdmRequesterStepCheckSession (SpdmContext, SessionId);
+}
+
+/**
+  Test 7: a transport layer message that cannot be decoded is received for GET_DIGESTS
+  Expected Behavior: get RETURN_DEVICE_ERROR with no outgoing message, the operation ends with Message B unchanged, and GET_DIGESTS can be started again
+**/
+void TestSpdmRequesterStepCase7(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT8                SlotMask;
+  UINT8                TotalDigestBuffer[MAX_HASH_SIZE * MAX_SPDM_SLOT_COUNT];
+  UINT8                OutgoingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                OutgoingMessageSize;
+  UINT8                IncomingMessage[sizeof(TEST_MESSAGE_HEADER) + sizeof(SPDM_MESSAGE_HEADER)];
+
+  SpdmContext = TestSpdmRequesterStepSetup (state);
+  Status = SpdmRequesterBeginInitConnection (SpdmContext, FALSE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  Status = SpdmRequesterBeginGetDigest (SpdmContext, &SlotMask, TotalDigestBuffer);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, 0, NULL, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_READY);
+
+  SetMem (IncomingMessage, sizeof(IncomingMessage), 0xFF);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, sizeof(IncomingMessage), IncomingMessage, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_DEVICE_ERROR);
+  assert_int_equal (OutgoingMessageSize, 0);
+  assert_int_equal (SpdmContext->Transcript.MessageBDigest.BufferSize, 0);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, 0, NULL, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_STARTED);
+
+  Status = SpdmRequesterBeginGetDigest (SpdmContext, &SlotMask, TotalDigestBuffer);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  TestSpdmRequesterStepCheckMessageAB (SpdmContext);
+}
+
+/**
+  Test 8: SpdmRequesterBegin while another operation is in progress, and no incoming message while a request is pending
+  Expected Behavior: get RETURN_ALREADY_STARTED and RETURN_INVALID_PARAMETER, and the operation in progress is not disturbed
+**/
+void TestSpdmRequesterStepCase8(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT8                SlotMask;
+  UINT8                TotalDigestBuffer[MAX_HASH_SIZE * MAX_SPDM_SLOT_COUNT];
+  UINT8                OutgoingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                OutgoingMessageSize;
+  UINT8                IncomingMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                IncomingMessageSize;
+
+  SpdmContext = TestSpdmRequesterStepSetup (state);
+  Status = SpdmRequesterBeginInitConnection (SpdmContext, FALSE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, 0, NULL, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_READY);
+
+  Status = SpdmRequesterBeginGetDigest (SpdmContext, &SlotMask, TotalDigestBuffer);
+  assert_int_equal (Status, RETURN_ALREADY_STARTED);
+  Status = SpdmRequesterBeginInitConnection (SpdmContext, FALSE);
+  assert_int_equal (Status, RETURN_ALREADY_STARTED);
+  IncomingMessageSize = sizeof(IncomingMessage);
+  Status = SpdmRequesterStep (SpdmContext, 0, NULL, &IncomingMessageSize, IncomingMessage);
+  assert_int_equal (Status, RETURN_INVALID_PARAMETER);
+
+  IncomingMessageSize = sizeof(IncomingMessage);
+  Status = TestSpdmRequesterStepTransact (SpdmContext, OutgoingMessageSize, OutgoingMessage, &IncomingMessageSize, IncomingMessage);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  OutgoingMessageSize = sizeof(OutgoingMessage);
+  Status = SpdmRequesterStep (SpdmContext, IncomingMessageSize, IncomingMessage, &OutgoingMessageSize, OutgoingMessage);
+  assert_int_equal (Status, RETURN_NOT_READY);
+  SpdmRequesterAbort (SpdmContext);
+
+  Status = SpdmRequesterBeginInitConnection (SpdmContext, FALSE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSpdmRequesterStepRun (SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  TestSpdmRequesterStepCheckMessageAB (SpdmContext);
+}
+
+SPDM_TEST_CONTEXT       mSpdmRequesterStepTestContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  TRUE,
+  SpdmRequesterStepTestSendMessage,
+  SpdmRequesterStepTestReceiveMessage,
+};
+
+int SpdmRequesterStepTestMain(void) {
+  const struct CMUnitTest SpdmRequesterStepTests[] = {
+      // Full flow, compared with the blocking functions
+      cmocka_unit_test(TestSpdmRequesterStepCase1),
+      // SPDM_ERROR_CODE_BUSY + Successful response
+      cmocka_unit_test(TestSpdmRequesterStepCase2),
+      // Always SPDM_ERROR_CODE_BUSY
+      cmocka_unit_test(TestSpdmRequesterStepCase3),
+      // SPDM_ERROR_CODE_RESPONSE_NOT_READY + Successful response
+      cmocka_unit_test(TestSpdmRequesterStepCase4),
+      // Abort while GET_DIGESTS is pending
+      cmocka_unit_test(TestSpdmRequesterStepCase5),
+      // Abort while KEY_EXCHANGE is pending
+      cmocka_unit_test(TestSpdmRequesterStepCase6),
+      // Incoming message cannot be decoded
+      cmocka_unit_test(TestSpdmRequesterStepCase7),
+      // Begin while busy, and no incoming message while a request is pending
+      cmocka_unit_test(TestSpdmRequesterStepCase8),
+  };
+
+  SetupSpdmTestContext (&mSpdmRequesterStepTestContext);
+
+  return cmocka_run_group_tests(SpdmRequesterStepTests, SpdmUnitTestGroupSetup, SpdmUnitTestGroupTeardown);
+}
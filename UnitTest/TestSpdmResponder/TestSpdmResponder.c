@@ -23,6 +23,9 @@ int SpdmResponderPskExchangeTestMain (void);
 int SpdmResponderPskFinishTestMain (void);
 int SpdmResponderHeartbeatTestMain (void);
 int SpdmResponderEndSessionTestMain (void);
+int SpdmResponderChunkGetTestMain (void);
+int SpdmResponderValidationTestMain (void);
+int SpdmResponderStateEventTestMain (void);
 
 int main(void) {
   SpdmResponderVersionTestMain ();
@@ -50,5 +53,11 @@ int main(void) {
   SpdmResponderHeartbeatTestMain();
 
   SpdmResponderEndSessionTestMain();
+
+  SpdmResponderChunkGetTestMain();
+
+  SpdmResponderValidationTestMain();
+
+  SpdmResponderStateEventTestMain();
   return 0;
 }
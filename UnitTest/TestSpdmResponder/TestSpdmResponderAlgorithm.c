@@ -204,6 +204,118 @@ void TestSpdmResponderAlgorithmCase6(void **state) {
   assert_int_equal (SpdmResponse->Header.Param2, 0);
 }
 
+void TestSpdmResponderAlgorithmCase7(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                FirstResponseSize;
+  UINT8                FirstResponse[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_ALGORITHMS_RESPONSE *SpdmResponse;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x7;
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterCapabilities;
+  SpdmContext->LocalContext.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->LocalContext.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->LocalContext.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->LocalContext.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+
+  FirstResponseSize = sizeof(FirstResponse);
+  Status = SpdmGetResponseAlgorithm (SpdmContext, mSpdmNegotiateAlgorithmRequest1Size, &mSpdmNegotiateAlgorithmRequest1, &FirstResponseSize, FirstResponse);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResponse = (VOID *)FirstResponse;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ALGORITHMS);
+  assert_int_equal (SpdmResponse->MeasurementHashAlgo, mUseMeasurementHashAlgo);
+  assert_int_equal (SpdmContext->AlgorithmSelectionCache.Valid, TRUE);
+
+  //
+  // The same algorithms are offered again.
+  //
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterCapabilities;
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseAlgorithm (SpdmContext, mSpdmNegotiateAlgorithmRequest1Size, &mSpdmNegotiateAlgorithmRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (ResponseSize, FirstResponseSize);
+  assert_memory_equal (Response, FirstResponse, ResponseSize);
+
+  //
+  // A change of the local algorithms selects the algorithms again.
+  //
+  SpdmContext->LocalContext.Algorithm.MeasurementHashAlgo = SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_RAW_BIT_STREAM_ONLY;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterCapabilities;
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseAlgorithm (SpdmContext, mSpdmNegotiateAlgorithmRequest1Size, &mSpdmNegotiateAlgorithmRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ALGORITHMS);
+  assert_int_equal (SpdmResponse->MeasurementHashAlgo, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_RAW_BIT_STREAM_ONLY);
+  assert_int_equal (SpdmContext->AlgorithmSelectionCache.Selected.MeasurementHashAlgo, SPDM_ALGORITHMS_MEASUREMENT_HASH_ALGO_RAW_BIT_STREAM_ONLY);
+}
+
+void TestSpdmResponderAlgorithmCase8(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_ALGORITHMS_RESPONSE *SpdmResponse;
+  SPDM_NEGOTIATE_ALGORITHMS_REQUEST SpdmRequest;
+  SPDM_ALGORITHM_COST_MODEL CostModel;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x8;
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterCapabilities;
+  SpdmContext->LocalContext.Algorithm.BaseHashAlgo = SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256 |
+                                                     SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384;
+  SpdmContext->LocalContext.Algorithm.BaseAsymAlgo = SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256 |
+                                                     SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384;
+  SpdmContext->LocalContext.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->LocalContext.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+  CopyMem (&SpdmRequest, &mSpdmNegotiateAlgorithmRequest1, sizeof(SpdmRequest));
+  SpdmRequest.BaseAsymAlgo = SpdmContext->LocalContext.Algorithm.BaseAsymAlgo;
+  SpdmRequest.BaseHashAlgo = SpdmContext->LocalContext.Algorithm.BaseHashAlgo;
+
+  //
+  // P256 is cheaper than the preferred P384.
+  //
+  ZeroMem (&CostModel, sizeof(CostModel));
+  CostModel.BaseAsymAlgoCost[4] = 10;
+  CostModel.BaseAsymAlgoCost[7] = 100;
+  SpdmSetAlgorithmCostModel (SpdmContext, &CostModel);
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseAlgorithm (SpdmContext, sizeof(SpdmRequest), &SpdmRequest, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ALGORITHMS);
+  assert_int_equal (SpdmResponse->BaseAsymSel, SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P256);
+
+  //
+  // P256 and SHA-256 are below the minimum security strength.
+  //
+  CostModel.MinSecurityStrength = 192;
+  SpdmSetAlgorithmCostModel (SpdmContext, &CostModel);
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterCapabilities;
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseAlgorithm (SpdmContext, sizeof(SpdmRequest), &SpdmRequest, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ALGORITHMS);
+  assert_int_equal (SpdmResponse->BaseAsymSel, SPDM_ALGORITHMS_BASE_ASYM_ALGO_TPM_ALG_ECDSA_ECC_NIST_P384);
+  assert_int_equal (SpdmResponse->BaseHashSel, SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_384);
+
+  SpdmSetAlgorithmCostModel (SpdmContext, NULL);
+}
+
 SPDM_TEST_CONTEXT       mSpdmResponderAlgorithmTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   FALSE,
@@ -223,6 +335,10 @@ int SpdmResponderAlgorithmTestMain(void) {
     cmocka_unit_test(TestSpdmResponderAlgorithmCase5),
     // ConnectionState Check
     cmocka_unit_test(TestSpdmResponderAlgorithmCase6),
+    // Success Case reusing the algorithm selection
+    cmocka_unit_test(TestSpdmResponderAlgorithmCase7),
+    // Success Case selecting by the algorithm cost model
+    cmocka_unit_test(TestSpdmResponderAlgorithmCase8),
   };
 
   mSpdmNegotiateAlgorithmRequest1.BaseAsymAlgo = mUseAsymAlgo;
@@ -256,6 +256,131 @@ void TestSpdmResponderChallengeAuthCase6(void **state) {
   free(Data1);
 }
 
+UINT8 mSpdmChallengeAuthPendingSignature[MAX_ASYM_KEY_SIZE];
+UINTN mSpdmChallengeAuthPendingSignatureSize;
+UINTN mSpdmChallengeAuthPollCount;
+
+RETURN_STATUS
+EFIAPI
+SpdmResponderChallengeAuthTestSignAsync (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               BaseAsymAlgo,
+  IN     UINT32               BaseHashAlgo,
+  IN     CONST UINT8          *Message,
+  IN     UINTN                MessageSize,
+     OUT UINT8                *Signature,
+  IN OUT UINTN                *SigSize,
+     OUT UINTN                *SignToken
+  )
+{
+  mSpdmChallengeAuthPendingSignatureSize = sizeof(mSpdmChallengeAuthPendingSignature);
+  if (!SpdmResponderDataSignFunc (BaseAsymAlgo, BaseHashAlgo, Message, MessageSize, mSpdmChallengeAuthPendingSignature, &mSpdmChallengeAuthPendingSignatureSize)) {
+    return RETURN_DEVICE_ERROR;
+  }
+  mSpdmChallengeAuthPollCount = 0;
+  *SignToken = 0x5A;
+  return RETURN_NOT_READY;
+}
+
+RETURN_STATUS
+EFIAPI
+SpdmResponderChallengeAuthTestSignPoll (
+  IN     VOID                 *SpdmContext,
+  IN     UINTN                SignToken,
+     OUT UINT8                *Signature,
+  IN OUT UINTN                *SigSize
+  )
+{
+  if (SignToken != 0x5A) {
+    return RETURN_INVALID_PARAMETER;
+  }
+  //
+  // Report the first poll as still in progress.
+  //
+  if (mSpdmChallengeAuthPollCount++ == 0) {
+    return RETURN_NOT_READY;
+  }
+  if (*SigSize < mSpdmChallengeAuthPendingSignatureSize) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  CopyMem (Signature, mSpdmChallengeAuthPendingSignature, mSpdmChallengeAuthPendingSignatureSize);
+  *SigSize = mSpdmChallengeAuthPendingSignatureSize;
+  return RETURN_SUCCESS;
+}
+
+void TestSpdmResponderChallengeAuthCase7(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_CHALLENGE_AUTH_RESPONSE *SpdmResponse;
+  SPDM_ERROR_DATA_RESPONSE_NOT_READY *ErrorData;
+  SPDM_MESSAGE_HEADER  SpdmRequest;
+  VOID                 *Data1;
+  UINTN                DataSize1;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x7;
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHAL_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data1, &DataSize1, NULL, NULL);
+  SpdmContext->LocalContext.LocalCertChainProvision[0] = Data1;
+  SpdmContext->LocalContext.LocalCertChainProvisionSize[0] = DataSize1;
+  SpdmContext->LocalContext.SlotCount = 1;
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageC);
+  SpdmRegisterResponderDataSignAsyncFunc (SpdmContext, SpdmResponderChallengeAuthTestSignAsync, SpdmResponderChallengeAuthTestSignPoll);
+
+  ResponseSize = sizeof(Response);
+  SpdmGetRandomNumber (SPDM_NONCE_SIZE, mSpdmChallengeRequest1.Nonce);
+  Status = SpdmGetResponseChallengeAuth (SpdmContext, mSpdmChallengeRequest1Size, &mSpdmChallengeRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (ResponseSize, sizeof(SPDM_ERROR_RESPONSE) + sizeof(SPDM_ERROR_DATA_RESPONSE_NOT_READY));
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
+  assert_int_equal (SpdmResponse->Header.Param1, SPDM_ERROR_CODE_RESPONSE_NOT_READY);
+  ErrorData = (VOID *)((SPDM_ERROR_RESPONSE *)Response + 1);
+  assert_int_equal (ErrorData->RequestCode, SPDM_CHALLENGE);
+  assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateNegotiated);
+
+  //
+  // The first RESPOND_IF_READY finds the signing still in progress.
+  //
+  SpdmRequest.SPDMVersion = SPDM_MESSAGE_VERSION_10;
+  SpdmRequest.RequestResponseCode = SPDM_RESPOND_IF_READY;
+  SpdmRequest.Param1 = ErrorData->RequestCode;
+  SpdmRequest.Param2 = ErrorData->Token;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseRespondIfReady (SpdmContext, sizeof(SpdmRequest), &SpdmRequest, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (ResponseSize, sizeof(SPDM_ERROR_RESPONSE) + sizeof(SPDM_ERROR_DATA_RESPONSE_NOT_READY));
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
+  assert_int_equal (SpdmResponse->Header.Param1, SPDM_ERROR_CODE_RESPONSE_NOT_READY);
+  assert_int_equal (ErrorData->RequestCode, SPDM_CHALLENGE);
+  assert_int_not_equal (ErrorData->Token, SpdmRequest.Param2);
+
+  SpdmRequest.Param2 = ErrorData->Token;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseRespondIfReady (SpdmContext, sizeof(SpdmRequest), &SpdmRequest, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (ResponseSize, sizeof(SPDM_CHALLENGE_AUTH_RESPONSE) + GetSpdmHashSize (mUseHashAlgo) + SPDM_NONCE_SIZE + 0 + sizeof(UINT16) + 0 + GetSpdmAsymSignatureSize (mUseAsymAlgo));
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_CHALLENGE_AUTH);
+  assert_int_equal (SpdmResponse->Header.Param1, 0);
+  assert_int_equal (SpdmResponse->Header.Param2, 1 << 0);
+  assert_memory_equal (Response + ResponseSize - mSpdmChallengeAuthPendingSignatureSize, mSpdmChallengeAuthPendingSignature, mSpdmChallengeAuthPendingSignatureSize);
+  assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateAuthenticated);
+  assert_int_equal (SpdmContext->PendingSignature.Valid, FALSE);
+
+  SpdmRegisterResponderDataSignAsyncFunc (SpdmContext, NULL, NULL);
+  free(Data1);
+}
+
 SPDM_TEST_CONTEXT       mSpdmResponderChallengeAuthTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   FALSE,
@@ -275,6 +400,8 @@ int SpdmResponderChallengeAuthTestMain(void) {
     cmocka_unit_test(TestSpdmResponderChallengeAuthCase5),
     // ConnectionState Check
     cmocka_unit_test(TestSpdmResponderChallengeAuthCase6),
+    // Asynchronous signing completed by RESPOND_IF_READY
+    cmocka_unit_test(TestSpdmResponderChallengeAuthCase7),
   };
 
   SetupSpdmTestContext (&mSpdmResponderChallengeAuthTestContext);
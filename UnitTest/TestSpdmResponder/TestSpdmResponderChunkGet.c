@@ -0,0 +1,206 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmUnitTest.h"
+#include <SpdmResponderLibInternal.h>
+
+#define TEST_LARGE_RESPONSE_SIZE  0x200
+#define TEST_MAX_MESSAGE_SIZE     0x40
+
+STATIC UINT8                  mLargeResponse[TEST_LARGE_RESPONSE_SIZE];
+
+void TestSpdmResponderChunkGetSetup (
+  IN SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN BOOLEAN              ChunkCap
+  )
+{
+  UINTN                Index;
+
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags = 0;
+  SpdmContext->LocalContext.Capability.Flags = 0;
+  if (ChunkCap) {
+    SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_CHUNK_CAP;
+    SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CHUNK_CAP;
+  }
+  SpdmContext->LocalContext.TransportMaxMessageSize = TEST_MAX_MESSAGE_SIZE;
+  SpdmContext->LastSpdmRequestSessionIdValid = FALSE;
+  SpdmContext->LargeResponseSize = 0;
+
+  mLargeResponse[0] = SPDM_MESSAGE_VERSION_11;
+  mLargeResponse[1] = SPDM_MEASUREMENTS;
+  for (Index = 2; Index < sizeof(mLargeResponse); Index++) {
+    mLargeResponse[Index] = (UINT8)Index;
+  }
+}
+
+void TestSpdmResponderChunkGetRequest (
+  IN     SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT8                Handle,
+  IN     UINT16               ChunkSeqNo,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  RETURN_STATUS           Status;
+  SPDM_CHUNK_GET_REQUEST  SpdmRequest;
+
+  SpdmRequest.Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmRequest.Header.RequestResponseCode = SPDM_CHUNK_GET;
+  SpdmRequest.Header.Param1 = 0;
+  SpdmRequest.Header.Param2 = Handle;
+  SpdmRequest.ChunkSeqNo = ChunkSeqNo;
+  Status = SpdmGetResponseChunkGet (SpdmContext, sizeof(SpdmRequest), &SpdmRequest, ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+}
+
+void TestSpdmResponderChunkGetCase1(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT8                LargeResponse[TEST_LARGE_RESPONSE_SIZE];
+  SPDM_ERROR_RESPONSE_DATA_LARGE_RESPONSE *ErrorResponse;
+  SPDM_CHUNK_RESPONSE_RESPONSE *SpdmResponse;
+  UINT8                Handle;
+  UINT16               ChunkSeqNo;
+  UINTN                Offset;
+  UINTN                HeaderSize;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x1;
+  TestSpdmResponderChunkGetSetup (SpdmContext, TRUE);
+
+  ResponseSize = sizeof(mLargeResponse);
+  CopyMem (Response, mLargeResponse, ResponseSize);
+  SpdmResponderHoldLargeResponse (SpdmContext, NULL, &ResponseSize, Response);
+  assert_int_equal (ResponseSize, sizeof(SPDM_ERROR_RESPONSE_DATA_LARGE_RESPONSE));
+  ErrorResponse = (VOID *)Response;
+  assert_int_equal (ErrorResponse->Header.RequestResponseCode, SPDM_ERROR);
+  assert_int_equal (ErrorResponse->Header.Param1, SPDM_ERROR_CODE_LARGE_RESPONSE);
+  Handle = ErrorResponse->ExtendErrorData.Handle;
+
+  Offset = 0;
+  for (ChunkSeqNo = 0; ; ChunkSeqNo++) {
+    ResponseSize = sizeof(Response);
+    TestSpdmResponderChunkGetRequest (SpdmContext, Handle, ChunkSeqNo, &ResponseSize, Response);
+    assert_true (ResponseSize <= TEST_MAX_MESSAGE_SIZE);
+    SpdmResponse = (VOID *)Response;
+    assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_CHUNK_RESPONSE);
+    assert_int_equal (SpdmResponse->Header.Param2, Handle);
+    assert_int_equal (SpdmResponse->ChunkSeqNo, ChunkSeqNo);
+    HeaderSize = sizeof(SPDM_CHUNK_RESPONSE_RESPONSE);
+    if (ChunkSeqNo == 0) {
+      assert_int_equal (*(UINT32 *)(SpdmResponse + 1), TEST_LARGE_RESPONSE_SIZE);
+      HeaderSize += sizeof(UINT32);
+    }
+    assert_int_equal (ResponseSize, HeaderSize + SpdmResponse->ChunkSize);
+    assert_true (Offset + SpdmResponse->ChunkSize <= sizeof(LargeResponse));
+    CopyMem (LargeResponse + Offset, Response + HeaderSize, SpdmResponse->ChunkSize);
+    Offset += SpdmResponse->ChunkSize;
+    if ((SpdmResponse->Header.Param1 & SPDM_CHUNK_RESPONSE_ATTRIBUTE_LAST_CHUNK) != 0) {
+      break;
+    }
+  }
+  assert_int_equal (Offset, TEST_LARGE_RESPONSE_SIZE);
+  assert_memory_equal (LargeResponse, mLargeResponse, TEST_LARGE_RESPONSE_SIZE);
+  assert_int_equal (SpdmContext->LargeResponseSize, 0);
+}
+
+void TestSpdmResponderChunkGetCase2(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_ERROR_RESPONSE_DATA_LARGE_RESPONSE *ErrorResponse;
+  SPDM_ERROR_RESPONSE  *SpdmResponse;
+  UINT8                Handle;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x2;
+  TestSpdmResponderChunkGetSetup (SpdmContext, TRUE);
+
+  ResponseSize = sizeof(mLargeResponse);
+  CopyMem (Response, mLargeResponse, ResponseSize);
+  SpdmResponderHoldLargeResponse (SpdmContext, NULL, &ResponseSize, Response);
+  ErrorResponse = (VOID *)Response;
+  Handle = ErrorResponse->ExtendErrorData.Handle;
+
+  ResponseSize = sizeof(Response);
+  TestSpdmResponderChunkGetRequest (SpdmContext, Handle, 1, &ResponseSize, Response);
+  assert_int_equal (ResponseSize, sizeof(SPDM_ERROR_RESPONSE));
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
+  assert_int_equal (SpdmResponse->Header.Param1, SPDM_ERROR_CODE_INVALID_REQUEST);
+  assert_int_equal (SpdmContext->LargeResponseSize, 0);
+}
+
+void TestSpdmResponderChunkGetCase3(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_ERROR_RESPONSE  *SpdmResponse;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x3;
+  TestSpdmResponderChunkGetSetup (SpdmContext, TRUE);
+
+  ResponseSize = sizeof(Response);
+  TestSpdmResponderChunkGetRequest (SpdmContext, SpdmContext->ChunkHandle, 0, &ResponseSize, Response);
+  assert_int_equal (ResponseSize, sizeof(SPDM_ERROR_RESPONSE));
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
+  assert_int_equal (SpdmResponse->Header.Param1, SPDM_ERROR_CODE_UNEXPECTED_REQUEST);
+}
+
+void TestSpdmResponderChunkGetCase4(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x4;
+  TestSpdmResponderChunkGetSetup (SpdmContext, FALSE);
+
+  ResponseSize = sizeof(mLargeResponse);
+  CopyMem (Response, mLargeResponse, ResponseSize);
+  SpdmResponderHoldLargeResponse (SpdmContext, NULL, &ResponseSize, Response);
+  assert_int_equal (ResponseSize, sizeof(mLargeResponse));
+  assert_memory_equal (Response, mLargeResponse, sizeof(mLargeResponse));
+  assert_int_equal (SpdmContext->LargeResponseSize, 0);
+}
+
+SPDM_TEST_CONTEXT       mSpdmResponderChunkGetTestContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  FALSE,
+};
+
+int SpdmResponderChunkGetTestMain(void) {
+  const struct CMUnitTest SpdmResponderChunkGetTests[] = {
+    // Success Case, all chunks
+    cmocka_unit_test(TestSpdmResponderChunkGetCase1),
+    // Bad ChunkSeqNo
+    cmocka_unit_test(TestSpdmResponderChunkGetCase2),
+    // No large response pending
+    cmocka_unit_test(TestSpdmResponderChunkGetCase3),
+    // CHUNK_CAP not negotiated
+    cmocka_unit_test(TestSpdmResponderChunkGetCase4),
+  };
+
+  SetupSpdmTestContext (&mSpdmResponderChunkGetTestContext);
+
+  return cmocka_run_group_tests(SpdmResponderChunkGetTests, SpdmUnitTestGroupSetup, SpdmUnitTestGroupTeardown);
+}
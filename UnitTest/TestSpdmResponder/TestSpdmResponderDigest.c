@@ -237,7 +237,7 @@ void TestSpdmResponderDigestCase6(void **state) {
 }
 
 /**
-  Test 7: receives a valid GET_DIGESTS request message from Requester, but the request message cannot be appended to the internal cache since the internal cache is full
+  Test 7: receives a valid GET_DIGESTS request message from Requester, but the request message cannot be appended to the internal cache since the transcript arena has no free chunk
   Expected Behavior: produces an ERROR response message with error code = InvalidRequest
 **/
 void TestSpdmResponderDigestCase7(void **state) {
@@ -247,6 +247,7 @@ void TestSpdmResponderDigestCase7(void **state) {
   UINTN                ResponseSize;
   UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
   SPDM_DIGESTS_RESPONSE *SpdmResponse;
+  SPDM_TRANSCRIPT_ARENA FreeArena;
 
   SpdmTestContext = *state;
   SpdmContext = SpdmTestContext->SpdmContext;
@@ -260,8 +261,11 @@ void TestSpdmResponderDigestCase7(void **state) {
   SpdmContext->LocalContext.SlotCount = 1;
 
   ResponseSize = sizeof(Response);
-  SpdmContext->Transcript.MessageB.BufferSize = SpdmContext->Transcript.MessageB.MaxBufferSize;
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+  CopyMem (&FreeArena, &SpdmContext->TranscriptArena, sizeof(FreeArena));
+  ZeroMem (&SpdmContext->TranscriptArena, sizeof(SpdmContext->TranscriptArena));
   Status = SpdmGetResponseDigest (SpdmContext, mSpdmGetDigestRequest1Size, &mSpdmGetDigestRequest1, &ResponseSize, Response);
+  CopyMem (&SpdmContext->TranscriptArena, &FreeArena, sizeof(FreeArena));
   assert_int_equal (Status, RETURN_SUCCESS);
   assert_int_equal (ResponseSize, sizeof(SPDM_ERROR_RESPONSE));
   SpdmResponse = (VOID *)Response;
@@ -271,7 +275,7 @@ void TestSpdmResponderDigestCase7(void **state) {
 }
 
 /**
-  Test 8: receives a valid GET_DIGESTS request message from Requester, but the response message cannot be appended to the internal cache since the internal cache is full
+  Test 8: receives a valid GET_DIGESTS request message from Requester, but the response message cannot be appended to the internal cache since the transcript arena has no free chunk
   Expected Behavior: produces an ERROR response message with error code = InvalidRequest
 **/
 void TestSpdmResponderDigestCase8(void **state) {
@@ -281,6 +285,7 @@ void TestSpdmResponderDigestCase8(void **state) {
   UINTN                ResponseSize;
   UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
   SPDM_DIGESTS_RESPONSE *SpdmResponse;
+  SPDM_TRANSCRIPT_ARENA FreeArena;
 
   SpdmTestContext = *state;
   SpdmContext = SpdmTestContext->SpdmContext;
@@ -294,8 +299,16 @@ void TestSpdmResponderDigestCase8(void **state) {
   SpdmContext->LocalContext.SlotCount = 1;
 
   ResponseSize = sizeof(Response);
-  SpdmContext->Transcript.MessageB.BufferSize = SpdmContext->Transcript.MessageB.MaxBufferSize - sizeof(SPDM_GET_DIGESTS_REQUEST);
+  //
+  // The last chunk of MessageB has room for the request only.
+  //
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+  AppendManagedBuffer (&SpdmContext->Transcript.MessageB, LocalCertificateChain, SPDM_TRANSCRIPT_CHUNK_SIZE - sizeof(SPDM_GET_DIGESTS_REQUEST));
+  CopyMem (&FreeArena, &SpdmContext->TranscriptArena, sizeof(FreeArena));
+  ZeroMem (&SpdmContext->TranscriptArena, sizeof(SpdmContext->TranscriptArena));
   Status = SpdmGetResponseDigest (SpdmContext, mSpdmGetDigestRequest1Size, &mSpdmGetDigestRequest1, &ResponseSize, Response);
+  CopyMem (&SpdmContext->TranscriptArena, &FreeArena, sizeof(FreeArena));
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
   assert_int_equal (Status, RETURN_SUCCESS);
   assert_int_equal (ResponseSize, sizeof(SPDM_ERROR_RESPONSE));
   SpdmResponse = (VOID *)Response;
@@ -331,7 +344,7 @@ void TestSpdmResponderDigestCase9(void **state) {
   SpdmContext->LocalContext.SlotCount = 0;
 
   ResponseSize = sizeof(Response);
-  SpdmContext->Transcript.MessageB.BufferSize = 0;
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
   Status = SpdmGetResponseDigest (SpdmContext, mSpdmGetDigestRequest1Size, &mSpdmGetDigestRequest1, &ResponseSize, Response);
   assert_int_equal (Status, RETURN_SUCCESS);
   assert_int_equal (ResponseSize, sizeof(SPDM_ERROR_RESPONSE));
@@ -341,6 +354,215 @@ void TestSpdmResponderDigestCase9(void **state) {
   assert_int_equal (SpdmResponse->Header.Param2, SPDM_GET_DIGESTS);
 }
 
+/**
+  Test 10: receives a valid GET_DIGESTS request message from Requester, with a device profile registered
+  Expected Behavior: produces a valid DIGESTS response message with the digest precomputed by the device profile,
+  even after the certificate chain buffer changes
+**/
+void TestSpdmResponderDigestCase10(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_DIGESTS_RESPONSE *SpdmResponse;
+  VOID                 *DeviceProfile;
+  UINT8                Digest[MAX_HASH_SIZE];
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0xA;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP;
+  SpdmContext->LocalContext.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->LocalContext.LocalCertChainProvision[0] = LocalCertificateChain;
+  SpdmContext->LocalContext.LocalCertChainProvisionSize[0] = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
+  SpdmContext->LocalContext.SlotCount = 1;
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+  SpdmHashAll (mUseHashAlgo, LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, Digest);
+
+  DeviceProfile = malloc (SpdmDeviceProfileGetSize ());
+  Status = SpdmDeviceProfileInit (DeviceProfile, SpdmContext);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmRegisterDeviceProfile (SpdmContext, DeviceProfile);
+  SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xEE));
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseDigest (SpdmContext, mSpdmGetDigestRequest1Size, &mSpdmGetDigestRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (ResponseSize, sizeof(SPDM_DIGESTS_RESPONSE) + GetSpdmHashSize(mUseHashAlgo));
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_DIGESTS);
+  assert_memory_equal (SpdmResponse + 1, Digest, GetSpdmHashSize(mUseHashAlgo));
+
+  SpdmRegisterDeviceProfile (SpdmContext, NULL);
+  free (DeviceProfile);
+}
+
+/**
+  Test 11: receives valid GET_DIGESTS request messages from Requester, before and after the local certificate chain is provisioned again
+  Expected Behavior: produces DIGESTS response messages with the digest cached since the certificate chain is provisioned
+**/
+void TestSpdmResponderDigestCase11(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_DIGESTS_RESPONSE *SpdmResponse;
+  SPDM_DATA_PARAMETER  Parameter;
+  UINT8                Digest1[MAX_HASH_SIZE];
+  UINT8                Digest2[MAX_HASH_SIZE];
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0xB;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->LocalContext.SlotCount = 1;
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+  ZeroMem (&Parameter, sizeof(Parameter));
+  Parameter.Location = SpdmDataLocationLocal;
+  Parameter.AdditionalData[0] = 0;
+
+  SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0x11));
+  SpdmHashAll (mUseHashAlgo, LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, Digest1);
+  Status = SpdmSetData (SpdmContext, SpdmDataLocalPublicCertChain, &Parameter, LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseDigest (SpdmContext, mSpdmGetDigestRequest1Size, &mSpdmGetDigestRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_DIGESTS);
+  assert_memory_equal (SpdmResponse + 1, Digest1, GetSpdmHashSize(mUseHashAlgo));
+
+  //
+  // The digest is not computed again, until the certificate chain is provisioned again.
+  //
+  SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0x22));
+  SpdmHashAll (mUseHashAlgo, LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, Digest2);
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseDigest (SpdmContext, mSpdmGetDigestRequest1Size, &mSpdmGetDigestRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_DIGESTS);
+  assert_memory_equal (SpdmResponse + 1, Digest1, GetSpdmHashSize(mUseHashAlgo));
+
+  Status = SpdmSetData (SpdmContext, SpdmDataLocalPublicCertChain, &Parameter, LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseDigest (SpdmContext, mSpdmGetDigestRequest1Size, &mSpdmGetDigestRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_DIGESTS);
+  assert_memory_equal (SpdmResponse + 1, Digest2, GetSpdmHashSize(mUseHashAlgo));
+}
+
+/**
+  Test 12: receives a valid GET_DIGESTS request message from Requester, with more than MAX_SPDM_MESSAGE_BUFFER_SIZE bytes in the internal cache
+  Expected Behavior: produces a valid DIGESTS response message, and the internal cache grows
+**/
+void TestSpdmResponderDigestCase12(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_DIGESTS_RESPONSE *SpdmResponse;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0xC;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->LocalContext.LocalCertChainProvision[0] = LocalCertificateChain;
+  SpdmContext->LocalContext.LocalCertChainProvisionSize[0] = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0xFF));
+  SpdmContext->LocalContext.SlotCount = 1;
+
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+  Status = AppendManagedBuffer (&SpdmContext->Transcript.MessageB, LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseDigest (SpdmContext, mSpdmGetDigestRequest1Size, &mSpdmGetDigestRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (ResponseSize, sizeof(SPDM_DIGESTS_RESPONSE) + GetSpdmHashSize (mUseHashAlgo));
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_DIGESTS);
+  assert_int_equal (GetManagedBufferSize (&SpdmContext->Transcript.MessageB), MAX_SPDM_MESSAGE_BUFFER_SIZE + mSpdmGetDigestRequest1Size + ResponseSize);
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+}
+
+/**
+  Test 13: receives a valid GET_DIGESTS request message from Requester, after a configuration profile is applied,
+  then an invalid configuration profile is applied
+  Expected Behavior: produces a valid DIGESTS response message with the certificate chain of the profile,
+  and the invalid profile is rejected without changing the local configuration
+**/
+void TestSpdmResponderDigestCase13(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_DIGESTS_RESPONSE *SpdmResponse;
+  SPDM_CONFIG_PROFILE  Profile;
+  UINT8                Digest[MAX_HASH_SIZE];
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0xD;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+  SetMem (LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, (UINT8)(0x33));
+  SpdmHashAll (mUseHashAlgo, LocalCertificateChain, MAX_SPDM_MESSAGE_BUFFER_SIZE, Digest);
+
+  ZeroMem (&Profile, sizeof(Profile));
+  Profile.SpdmVersionCount = 1;
+  Profile.SpdmVersion[0].MajorVersion = 1;
+  Profile.SpdmVersion[0].MinorVersion = 1;
+  Profile.CapabilityFlags = SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP;
+  Profile.BaseHashAlgo = mUseHashAlgo;
+  Profile.BaseAsymAlgo = mUseAsymAlgo;
+  Profile.LocalSlotCount = 1;
+  Profile.LocalPublicCertChain[0] = LocalCertificateChain;
+  Profile.LocalPublicCertChainSize[0] = MAX_SPDM_MESSAGE_BUFFER_SIZE;
+  Status = SpdmApplyProfile (SpdmContext, &Profile);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmContext->LocalContext.Capability.Flags, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP);
+  assert_int_equal (SpdmContext->LocalContext.Version.SpdmVersionCount, 1);
+  assert_int_equal (SpdmContext->LocalContext.SlotCount, 1);
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseDigest (SpdmContext, mSpdmGetDigestRequest1Size, &mSpdmGetDigestRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (ResponseSize, sizeof(SPDM_DIGESTS_RESPONSE) + GetSpdmHashSize(mUseHashAlgo));
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_DIGESTS);
+  assert_memory_equal (SpdmResponse + 1, Digest, GetSpdmHashSize(mUseHashAlgo));
+
+  Profile.CapabilityFlags = 0;
+  Profile.MutAuthRequested = 0x3;
+  Status = SpdmApplyProfile (SpdmContext, &Profile);
+  assert_int_equal (Status, RETURN_INVALID_PARAMETER);
+  assert_int_equal (SpdmContext->LocalContext.Capability.Flags, SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CERT_CAP);
+  assert_int_equal (SpdmContext->LocalContext.MutAuthRequested, 0);
+  ResetManagedBuffer (&SpdmContext->Transcript.MessageB);
+}
+
 SPDM_TEST_CONTEXT       mSpdmResponderDigestTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   FALSE,
@@ -360,12 +582,20 @@ int SpdmResponderDigestTestMain(void) {
     cmocka_unit_test(TestSpdmResponderDigestCase5),
     // ConnectionState Check
     cmocka_unit_test(TestSpdmResponderDigestCase6),
-    // Internal cache full (request message)
+    // Transcript arena exhausted (request message)
     cmocka_unit_test(TestSpdmResponderDigestCase7),
-    // Internal cache full (response message)
+    // Transcript arena exhausted (response message)
     cmocka_unit_test(TestSpdmResponderDigestCase8),
     // No digest to send
     cmocka_unit_test(TestSpdmResponderDigestCase9),
+    // Digest precomputed by a device profile
+    cmocka_unit_test(TestSpdmResponderDigestCase10),
+    // Digest cached until the certificate chain is provisioned again
+    cmocka_unit_test(TestSpdmResponderDigestCase11),
+    // Internal cache beyond MAX_SPDM_MESSAGE_BUFFER_SIZE
+    cmocka_unit_test(TestSpdmResponderDigestCase12),
+    // Local configuration applied from a configuration profile
+    cmocka_unit_test(TestSpdmResponderDigestCase13),
   };
 
   SetupSpdmTestContext (&mSpdmResponderDigestTestContext);
@@ -33,6 +33,98 @@ UINTN mSpdmEndSessionRequest2Size = MAX_SPDM_MESSAGE_BUFFER_SIZE;
 
 STATIC UINT8                  LocalPskHint[32];
 
+STATIC UINT8                  mSpdmEndSessionSentMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+STATIC UINTN                  mSpdmEndSessionSentMessageSize;
+
+/**
+  Transport encode function that sends the SPDM message as is, so that the response can be compared.
+**/
+RETURN_STATUS
+EFIAPI
+TestSpdmResponderEndSessionEncodeMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                SpdmMessageSize,
+  IN     VOID                 *SpdmMessage,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  )
+{
+  assert_non_null (SessionId);
+  assert_false (IsAppMessage);
+  assert_true (SpdmMessageSize <= sizeof(mSpdmEndSessionSentMessage));
+  assert_true (SpdmMessageSize <= *TransportMessageSize);
+  CopyMem (mSpdmEndSessionSentMessage, SpdmMessage, SpdmMessageSize);
+  mSpdmEndSessionSentMessageSize = SpdmMessageSize;
+  CopyMem (TransportMessage, SpdmMessage, SpdmMessageSize);
+  *TransportMessageSize = SpdmMessageSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Request handler registered for END_SESSION, which answers with a marked END_SESSION_ACK.
+**/
+RETURN_STATUS
+EFIAPI
+TestSpdmResponderEndSessionRequestHandler (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  SPDM_END_SESSION_RESPONSE  *SpdmResponse;
+
+  SpdmResponse = Response;
+  SpdmResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmResponse->Header.RequestResponseCode = SPDM_END_SESSION_ACK;
+  SpdmResponse->Header.Param1 = 0x5A;
+  SpdmResponse->Header.Param2 = 0;
+  *ResponseSize = sizeof(SPDM_END_SESSION_RESPONSE);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Set up a negotiated connection with a session in the given state, and an END_SESSION received in it.
+**/
+SPDM_SESSION_INFO *
+TestSpdmResponderEndSessionSetupSession (
+  IN SPDM_DEVICE_CONTEXT    *SpdmContext,
+  IN UINT32                 SessionId,
+  IN SPDM_SESSION_STATE     SessionState
+  )
+{
+  SPDM_SESSION_INFO    *SessionInfo;
+
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Version.SpdmVersionCount = 1;
+  SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MajorVersion = 1;
+  SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MinorVersion = 1;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+
+  SpdmContext->LatestSessionId = SessionId;
+  SpdmContext->LastSpdmRequestSessionIdValid = TRUE;
+  SpdmContext->LastSpdmRequestSessionId = SessionId;
+  SessionInfo = &SpdmContext->SessionInfo[0];
+  SpdmSessionInfoInit (SpdmContext, SessionInfo, SessionId, TRUE);
+  SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SessionState);
+
+  CopyMem (SpdmContext->LastSpdmRequest, &mSpdmEndSessionRequest1, mSpdmEndSessionRequest1Size);
+  SpdmContext->LastSpdmRequestSize = mSpdmEndSessionRequest1Size;
+  SpdmRegisterTransportLayerFunc (SpdmContext, TestSpdmResponderEndSessionEncodeMessage, SpdmTransportTestDecodeMessage);
+  mSpdmEndSessionSentMessageSize = 0;
+  return SessionInfo;
+}
+
 void TestSpdmResponderEndSessionCase1(void **state) {
   RETURN_STATUS        Status;
   SPDM_TEST_CONTEXT    *SpdmTestContext;
@@ -377,6 +469,154 @@ void TestSpdmResponderEndSessionCase6(void **state) {
   free(Data1);
 }
 
+void TestSpdmResponderEndSessionCase7(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_END_SESSION_RESPONSE *SpdmResponse;
+  SPDM_SESSION_INFO    *SessionInfo;
+  UINT32               SessionId;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x7;
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_PSK_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_PSK_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+
+  SessionId = 0xFFFFFFFF;
+  SpdmContext->LatestSessionId = SessionId;
+  SpdmContext->LastSpdmRequestSessionIdValid = TRUE;
+  SpdmContext->LastSpdmRequestSessionId = SessionId;
+  SessionInfo = &SpdmContext->SessionInfo[0];
+  SpdmSessionInfoInit (SpdmContext, SessionInfo, SessionId, TRUE);
+  SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SpdmSessionStateEstablished);
+
+  //
+  // The preserve request is honored only with CACHE_CAP.
+  //
+  SpdmContext->LocalContext.Capability.Flags &= ~SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CACHE_CAP;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseEndSession (SpdmContext, mSpdmEndSessionRequest1Size, &mSpdmEndSessionRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_END_SESSION_ACK);
+  assert_int_equal (SessionInfo->EndSessionAttributes, SPDM_END_SESSION_REQUEST_ATTRIBUTES_PRESERVE_NEGOTIATED_STATE_CLEAR);
+
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CACHE_CAP;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseEndSession (SpdmContext, mSpdmEndSessionRequest1Size, &mSpdmEndSessionRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_END_SESSION_ACK);
+  assert_int_equal (SessionInfo->EndSessionAttributes, 0);
+  SpdmContext->LocalContext.Capability.Flags &= ~SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_CACHE_CAP;
+}
+
+void TestSpdmResponderEndSessionCase8(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                HandlerResponseSize;
+  UINT8                HandlerResponse[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT32               SessionId;
+
+  //
+  // The END_SESSION_ACK of SpdmBuildResponse is the one of the END_SESSION handler,
+  // and the session is freed once it is encoded.
+  //
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x8;
+  SessionId = 0xFFFFFFFF;
+  TestSpdmResponderEndSessionSetupSession (SpdmContext, SessionId, SpdmSessionStateEstablished);
+
+  HandlerResponseSize = sizeof(HandlerResponse);
+  Status = SpdmGetResponseEndSession (SpdmContext, mSpdmEndSessionRequest1Size, &mSpdmEndSessionRequest1, &HandlerResponseSize, HandlerResponse);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  TestSpdmResponderEndSessionSetupSession (SpdmContext, SessionId, SpdmSessionStateEstablished);
+  ResponseSize = sizeof(Response);
+  Status = SpdmBuildResponse (SpdmContext, &SessionId, FALSE, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmEndSessionSentMessageSize, HandlerResponseSize);
+  assert_memory_equal (mSpdmEndSessionSentMessage, HandlerResponse, HandlerResponseSize);
+  assert_int_equal (ResponseSize, HandlerResponseSize);
+  assert_memory_equal (Response, HandlerResponse, HandlerResponseSize);
+  assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId));
+
+  SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportTestEncodeMessage, SpdmTransportTestDecodeMessage);
+}
+
+void TestSpdmResponderEndSessionCase9(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_END_SESSION_RESPONSE *SpdmResponse;
+  UINT32               SessionId;
+
+  //
+  // A request handler registered for END_SESSION answers it.
+  //
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x9;
+  SessionId = 0xFFFFFFFF;
+  TestSpdmResponderEndSessionSetupSession (SpdmContext, SessionId, SpdmSessionStateEstablished);
+  Status = SpdmRegisterRequestHandler (SpdmContext, SPDM_END_SESSION, TestSpdmResponderEndSessionRequestHandler);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmBuildResponse (SpdmContext, &SessionId, FALSE, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmEndSessionSentMessageSize, sizeof(SPDM_END_SESSION_RESPONSE));
+  SpdmResponse = (VOID *)mSpdmEndSessionSentMessage;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_END_SESSION_ACK);
+  assert_int_equal (SpdmResponse->Header.Param1, 0x5A);
+
+  SpdmRegisterRequestHandler (SpdmContext, SPDM_END_SESSION, NULL);
+  SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportTestEncodeMessage, SpdmTransportTestDecodeMessage);
+}
+
+void TestSpdmResponderEndSessionCase10(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_END_SESSION_RESPONSE *SpdmResponse;
+  UINT32               SessionId;
+
+  //
+  // In a session that is not established, the END_SESSION handler rejects the request and the session is kept.
+  //
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0xA;
+  SessionId = 0xFFFFFFFF;
+  TestSpdmResponderEndSessionSetupSession (SpdmContext, SessionId, SpdmSessionStateHandshaking);
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmBuildResponse (SpdmContext, &SessionId, FALSE, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmEndSessionSentMessageSize, sizeof(SPDM_ERROR_RESPONSE));
+  SpdmResponse = (VOID *)mSpdmEndSessionSentMessage;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
+  assert_int_equal (SpdmResponse->Header.Param1, SPDM_ERROR_CODE_INVALID_REQUEST);
+  assert_non_null (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId));
+
+  SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportTestEncodeMessage, SpdmTransportTestDecodeMessage);
+}
+
 SPDM_TEST_CONTEXT       mSpdmResponderEndSessionTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   FALSE,
@@ -396,6 +636,14 @@ int SpdmResponderEndSessionTestMain(void) {
     cmocka_unit_test(TestSpdmResponderEndSessionCase5),
     // ConnectionState Check
     cmocka_unit_test(TestSpdmResponderEndSessionCase6),
+    // Preserve negotiated state with and without CACHE_CAP
+    cmocka_unit_test(TestSpdmResponderEndSessionCase7),
+    // SpdmBuildResponse: same END_SESSION_ACK as the handler, and the session is freed
+    cmocka_unit_test(TestSpdmResponderEndSessionCase8),
+    // SpdmBuildResponse: registered request handler
+    cmocka_unit_test(TestSpdmResponderEndSessionCase9),
+    // SpdmBuildResponse: session not established
+    cmocka_unit_test(TestSpdmResponderEndSessionCase10),
   };
 
   SetupSpdmTestContext (&mSpdmResponderEndSessionTestContext);
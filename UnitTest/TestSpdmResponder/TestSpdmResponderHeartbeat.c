@@ -33,6 +33,100 @@ UINTN mSpdmHeartbeatRequest2Size = MAX_SPDM_MESSAGE_BUFFER_SIZE;
 
 STATIC UINT8                  LocalPskHint[32];
 
+STATIC UINT8                  mSpdmHeartbeatSentMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+STATIC UINTN                  mSpdmHeartbeatSentMessageSize;
+
+/**
+  Transport encode function that sends the SPDM message as is, so that the response can be compared.
+**/
+RETURN_STATUS
+EFIAPI
+TestSpdmResponderHeartbeatEncodeMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                SpdmMessageSize,
+  IN     VOID                 *SpdmMessage,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  )
+{
+  assert_non_null (SessionId);
+  assert_false (IsAppMessage);
+  assert_true (SpdmMessageSize <= sizeof(mSpdmHeartbeatSentMessage));
+  assert_true (SpdmMessageSize <= *TransportMessageSize);
+  CopyMem (mSpdmHeartbeatSentMessage, SpdmMessage, SpdmMessageSize);
+  mSpdmHeartbeatSentMessageSize = SpdmMessageSize;
+  CopyMem (TransportMessage, SpdmMessage, SpdmMessageSize);
+  *TransportMessageSize = SpdmMessageSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Request handler registered for HEARTBEAT, which answers with a marked HEARTBEAT_ACK.
+**/
+RETURN_STATUS
+EFIAPI
+TestSpdmResponderHeartbeatRequestHandler (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     UINTN                RequestSize,
+  IN     VOID                 *Request,
+  IN OUT UINTN                *ResponseSize,
+     OUT VOID                 *Response
+  )
+{
+  SPDM_HEARTBEAT_RESPONSE  *SpdmResponse;
+
+  SpdmResponse = Response;
+  SpdmResponse->Header.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmResponse->Header.RequestResponseCode = SPDM_HEARTBEAT_ACK;
+  SpdmResponse->Header.Param1 = 0x5A;
+  SpdmResponse->Header.Param2 = 0;
+  *ResponseSize = sizeof(SPDM_HEARTBEAT_RESPONSE);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Set up a negotiated connection with a session in the given state, and a HEARTBEAT received in it.
+**/
+SPDM_SESSION_INFO *
+TestSpdmResponderHeartbeatSetupSession (
+  IN SPDM_DEVICE_CONTEXT    *SpdmContext,
+  IN UINT32                 SessionId,
+  IN SPDM_SESSION_STATE     SessionState
+  )
+{
+  SPDM_SESSION_INFO    *SessionInfo;
+
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Version.SpdmVersionCount = 1;
+  SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MajorVersion = 1;
+  SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MinorVersion = 1;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+
+  SpdmContext->LatestSessionId = SessionId;
+  SpdmContext->LastSpdmRequestSessionIdValid = TRUE;
+  SpdmContext->LastSpdmRequestSessionId = SessionId;
+  SessionInfo = &SpdmContext->SessionInfo[0];
+  SpdmSessionInfoInit (SpdmContext, SessionInfo, SessionId, TRUE);
+  SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SessionState);
+
+  CopyMem (SpdmContext->LastSpdmRequest, &mSpdmHeartbeatRequest1, mSpdmHeartbeatRequest1Size);
+  SpdmContext->LastSpdmRequestSize = mSpdmHeartbeatRequest1Size;
+  SpdmRegisterTransportLayerFunc (SpdmContext, TestSpdmResponderHeartbeatEncodeMessage, SpdmTransportTestDecodeMessage);
+  mSpdmHeartbeatSentMessageSize = 0;
+  return SessionInfo;
+}
+
 void TestSpdmResponderHeartbeatCase1(void **state) {
   RETURN_STATUS        Status;
   SPDM_TEST_CONTEXT    *SpdmTestContext;
@@ -377,6 +471,133 @@ void TestSpdmResponderHeartbeatCase6(void **state) {
   free(Data1);
 }
 
+void TestSpdmResponderHeartbeatCase7(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                HandlerResponseSize;
+  UINT8                HandlerResponse[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINT32               SessionId;
+
+  //
+  // The HEARTBEAT_ACK of SpdmBuildResponse is the one of the HEARTBEAT handler.
+  //
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x7;
+  SessionId = 0xFFFFFFFF;
+  TestSpdmResponderHeartbeatSetupSession (SpdmContext, SessionId, SpdmSessionStateEstablished);
+
+  HandlerResponseSize = sizeof(HandlerResponse);
+  Status = SpdmGetResponseHeartbeat (SpdmContext, mSpdmHeartbeatRequest1Size, &mSpdmHeartbeatRequest1, &HandlerResponseSize, HandlerResponse);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmBuildResponse (SpdmContext, &SessionId, FALSE, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmHeartbeatSentMessageSize, HandlerResponseSize);
+  assert_memory_equal (mSpdmHeartbeatSentMessage, HandlerResponse, HandlerResponseSize);
+  assert_int_equal (ResponseSize, HandlerResponseSize);
+  assert_memory_equal (Response, HandlerResponse, HandlerResponseSize);
+  assert_non_null (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId));
+
+  SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportTestEncodeMessage, SpdmTransportTestDecodeMessage);
+}
+
+void TestSpdmResponderHeartbeatCase8(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_HEARTBEAT_RESPONSE *SpdmResponse;
+  UINT32               SessionId;
+
+  //
+  // A request handler registered for HEARTBEAT answers it.
+  //
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x8;
+  SessionId = 0xFFFFFFFF;
+  TestSpdmResponderHeartbeatSetupSession (SpdmContext, SessionId, SpdmSessionStateEstablished);
+  Status = SpdmRegisterRequestHandler (SpdmContext, SPDM_HEARTBEAT, TestSpdmResponderHeartbeatRequestHandler);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmBuildResponse (SpdmContext, &SessionId, FALSE, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmHeartbeatSentMessageSize, sizeof(SPDM_HEARTBEAT_RESPONSE));
+  SpdmResponse = (VOID *)mSpdmHeartbeatSentMessage;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_HEARTBEAT_ACK);
+  assert_int_equal (SpdmResponse->Header.Param1, 0x5A);
+
+  SpdmRegisterRequestHandler (SpdmContext, SPDM_HEARTBEAT, NULL);
+  SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportTestEncodeMessage, SpdmTransportTestDecodeMessage);
+}
+
+void TestSpdmResponderHeartbeatCase9(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_HEARTBEAT_RESPONSE *SpdmResponse;
+  UINT32               SessionId;
+
+  //
+  // Without HBEAT_CAP, the HEARTBEAT is rejected with the UNEXPECTED_REQUEST of its handler.
+  //
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x9;
+  SessionId = 0xFFFFFFFF;
+  TestSpdmResponderHeartbeatSetupSession (SpdmContext, SessionId, SpdmSessionStateEstablished);
+  SpdmContext->LocalContext.Capability.Flags &= ~SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP;
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmBuildResponse (SpdmContext, &SessionId, FALSE, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmHeartbeatSentMessageSize, sizeof(SPDM_ERROR_RESPONSE));
+  SpdmResponse = (VOID *)mSpdmHeartbeatSentMessage;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
+  assert_int_equal (SpdmResponse->Header.Param1, SPDM_ERROR_CODE_UNEXPECTED_REQUEST);
+  assert_int_equal (SpdmResponse->Header.Param2, 0);
+
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP;
+  SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportTestEncodeMessage, SpdmTransportTestDecodeMessage);
+}
+
+void TestSpdmResponderHeartbeatCase10(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_HEARTBEAT_RESPONSE *SpdmResponse;
+  UINT32               SessionId;
+
+  //
+  // In a session that is not established, the HEARTBEAT handler rejects the request.
+  //
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0xA;
+  SessionId = 0xFFFFFFFF;
+  TestSpdmResponderHeartbeatSetupSession (SpdmContext, SessionId, SpdmSessionStateHandshaking);
+
+  ResponseSize = sizeof(Response);
+  Status = SpdmBuildResponse (SpdmContext, &SessionId, FALSE, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (mSpdmHeartbeatSentMessageSize, sizeof(SPDM_ERROR_RESPONSE));
+  SpdmResponse = (VOID *)mSpdmHeartbeatSentMessage;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
+
+  SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportTestEncodeMessage, SpdmTransportTestDecodeMessage);
+}
+
 SPDM_TEST_CONTEXT       mSpdmResponderHeartbeatTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   FALSE,
@@ -396,6 +617,14 @@ int SpdmResponderHeartbeatTestMain(void) {
     cmocka_unit_test(TestSpdmResponderHeartbeatCase5),
     // ConnectionState Check
     cmocka_unit_test(TestSpdmResponderHeartbeatCase6),
+    // SpdmBuildResponse: same HEARTBEAT_ACK as the handler
+    cmocka_unit_test(TestSpdmResponderHeartbeatCase7),
+    // SpdmBuildResponse: registered request handler
+    cmocka_unit_test(TestSpdmResponderHeartbeatCase8),
+    // SpdmBuildResponse: no HBEAT_CAP
+    cmocka_unit_test(TestSpdmResponderHeartbeatCase9),
+    // SpdmBuildResponse: session not established
+    cmocka_unit_test(TestSpdmResponderHeartbeatCase10),
   };
 
   SetupSpdmTestContext (&mSpdmResponderHeartbeatTestContext);
@@ -9,6 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SpdmUnitTest.h"
 #include <SpdmResponderLibInternal.h>
+#include <SpdmSecuredMessageLibInternal.h>
 
 #pragma pack(1)
 
@@ -401,6 +402,321 @@ void TestSpdmResponderKeyExchangeCase6(void **state) {
   free(Data1);
 }
 
+void TestSpdmResponderKeyExchangeCase7(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_KEY_EXCHANGE_RESPONSE *SpdmResponse;
+  VOID                 *Data1;
+  UINTN                DataSize1;
+  UINT8                *Ptr;
+  UINTN                DheKeySize;
+  VOID                 *DHEContext;
+  UINTN                OpaqueKeyExchangeReqSize;
+  VOID                 *DheKeyPool;
+  SPDM_DHE_KEY_POOL_ENTRY *Entry;
+  SPDM_DHE_KEY_POOL_STATS PoolStats;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x7;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data1, &DataSize1, NULL, NULL);
+  SpdmContext->LocalContext.LocalCertChainProvision[0] = Data1;
+  SpdmContext->LocalContext.LocalCertChainProvisionSize[0] = DataSize1;
+  SpdmContext->LocalContext.SlotCount = 1;
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+  SpdmContext->LocalContext.MutAuthRequested = 0;
+
+  DheKeyPool = malloc (SpdmSecuredMessageDheKeyPoolGetSize (2));
+  SpdmSecuredMessageDheKeyPoolInit (DheKeyPool, 2, NULL, NULL, NULL);
+  assert_int_equal (SpdmSecuredMessageDheKeyPoolRefill (DheKeyPool, mUseDheAlgo, 1), 1);
+  SpdmRegisterDheKeyPool (SpdmContext, DheKeyPool);
+  Entry = (SPDM_DHE_KEY_POOL_ENTRY *)((SPDM_DHE_KEY_POOL *)DheKeyPool + 1);
+  assert_int_equal (Entry[0].State, SpdmDheKeyPoolEntryReady);
+
+  SpdmGetRandomNumber (SPDM_RANDOM_DATA_SIZE, mSpdmKeyExchangeRequest1.RandomData);
+  mSpdmKeyExchangeRequest1.ReqSessionID = 0xFFFF;
+  mSpdmKeyExchangeRequest1.Reserved = 0;
+  Ptr = mSpdmKeyExchangeRequest1.ExchangeData;
+  DheKeySize = GetSpdmDhePubKeySize (mUseDheAlgo);
+  DHEContext = SpdmDheNew (mUseDheAlgo);
+  SpdmDheGenerateKey (mUseDheAlgo, DHEContext, Ptr, &DheKeySize);
+  Ptr += DheKeySize;
+  SpdmDheFree (mUseDheAlgo, DHEContext);
+  OpaqueKeyExchangeReqSize = SpdmGetOpaqueDataSupportedVersionDataSize (SpdmContext);
+  *(UINT16 *)Ptr = (UINT16)OpaqueKeyExchangeReqSize;
+  Ptr += sizeof(UINT16);
+  SpdmBuildOpaqueDataSupportedVersionData (SpdmContext, &OpaqueKeyExchangeReqSize, Ptr);
+  Ptr += OpaqueKeyExchangeReqSize;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseKeyExchange (SpdmContext, mSpdmKeyExchangeRequest1Size, &mSpdmKeyExchangeRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_KEY_EXCHANGE_RSP);
+  assert_int_equal (Entry[0].State, SpdmDheKeyPoolEntryFree);
+  SpdmSecuredMessageDheKeyPoolGetStats (DheKeyPool, &PoolStats);
+  assert_int_equal (PoolStats.EntryCount, 2);
+  assert_int_equal (PoolStats.ReadyCount, 0);
+  assert_int_equal (PoolStats.HitCount, 1);
+  assert_int_equal (PoolStats.MissCount, 0);
+
+  SpdmRegisterDheKeyPool (SpdmContext, NULL);
+  SpdmSecuredMessageDheKeyPoolDeinit (DheKeyPool);
+  free (DheKeyPool);
+  free(Data1);
+}
+
+UINT64
+EFIAPI
+SpdmResponderKeyExchangeTestGetTime (
+  IN     VOID                 *SpdmContext
+  )
+{
+  return 1000;
+}
+
+BOOLEAN
+EFIAPI
+SpdmResponderKeyExchangeTestIsPrivileged (
+  IN     VOID                 *SpdmContext,
+  IN     UINT8                RequestCode
+  )
+{
+  return FALSE;
+}
+
+void TestSpdmResponderKeyExchangeCase8(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_KEY_EXCHANGE_RESPONSE *SpdmResponse;
+  VOID                 *Data1;
+  UINTN                DataSize1;
+  UINT8                *Ptr;
+  UINTN                DheKeySize;
+  VOID                 *DHEContext;
+  UINTN                OpaqueKeyExchangeReqSize;
+  SPDM_SESSION_INFO    *SessionInfo;
+  SPDM_RESPONDER_SESSION_POLICY Policy;
+  UINTN                Index;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x8;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP | SPDM_GET_CAPABILITIES_REQUEST_FLAGS_HBEAT_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP | SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_HBEAT_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data1, &DataSize1, NULL, NULL);
+  SpdmContext->LocalContext.LocalCertChainProvision[0] = Data1;
+  SpdmContext->LocalContext.LocalCertChainProvisionSize[0] = DataSize1;
+  SpdmContext->LocalContext.SlotCount = 1;
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+  SpdmContext->LocalContext.MutAuthRequested = 0;
+  SpdmContext->LastSpdmRequestSessionIdValid = FALSE;
+
+  //
+  // Fill all session slots. The least recently used session is privileged,
+  // so the unprivileged requester evicts the next least recently used one.
+  //
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SpdmContext->SessionInfo[Index].SessionId != INVALID_SESSION_ID) {
+      SpdmFreeSessionId (SpdmContext, SpdmContext->SessionInfo[Index].SessionId);
+    }
+  }
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    SessionInfo = SpdmAssignSessionId (SpdmContext, ((UINT32)(0x1000 + Index) << 16) | (UINT32)(0xFFFF - Index), FALSE);
+    assert_true (SessionInfo != NULL);
+    SessionInfo->LastActivityTime = 100 + Index;
+  }
+  SpdmContext->SessionInfo[1].Privileged = TRUE;
+  SpdmContext->SessionInfo[1].LastActivityTime = 10;
+
+  ZeroMem (&Policy, sizeof(Policy));
+  Policy.HeartbeatPeriod = 5;
+  Policy.EvictIdleTime = 500;
+  SpdmRegisterResponderAdmissionFunc (SpdmContext, SpdmResponderKeyExchangeTestGetTime, NULL);
+  SpdmSetResponderSessionPolicy (SpdmContext, &Policy, SpdmResponderKeyExchangeTestIsPrivileged);
+
+  SpdmGetRandomNumber (SPDM_RANDOM_DATA_SIZE, mSpdmKeyExchangeRequest1.RandomData);
+  mSpdmKeyExchangeRequest1.ReqSessionID = 0xFFFF;
+  mSpdmKeyExchangeRequest1.Reserved = 0;
+  Ptr = mSpdmKeyExchangeRequest1.ExchangeData;
+  DheKeySize = GetSpdmDhePubKeySize (mUseDheAlgo);
+  DHEContext = SpdmDheNew (mUseDheAlgo);
+  SpdmDheGenerateKey (mUseDheAlgo, DHEContext, Ptr, &DheKeySize);
+  Ptr += DheKeySize;
+  SpdmDheFree (mUseDheAlgo, DHEContext);
+  OpaqueKeyExchangeReqSize = SpdmGetOpaqueDataSupportedVersionDataSize (SpdmContext);
+  *(UINT16 *)Ptr = (UINT16)OpaqueKeyExchangeReqSize;
+  Ptr += sizeof(UINT16);
+  SpdmBuildOpaqueDataSupportedVersionData (SpdmContext, &OpaqueKeyExchangeReqSize, Ptr);
+  Ptr += OpaqueKeyExchangeReqSize;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseKeyExchange (SpdmContext, mSpdmKeyExchangeRequest1Size, &mSpdmKeyExchangeRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_KEY_EXCHANGE_RSP);
+  assert_int_equal (SpdmResponse->Header.Param1, 5);
+  assert_int_equal (SpdmContext->SessionInfo[0].SessionId, ((UINT32)0xFFFF << 16) | SpdmResponse->RspSessionID);
+  assert_int_equal (SpdmContext->SessionInfo[0].HeartbeatPeriod, 5);
+  assert_int_equal (SpdmContext->SessionInfo[0].Privileged, FALSE);
+  assert_int_equal (SpdmContext->SessionInfo[1].SessionId, ((UINT32)0x1001 << 16) | 0xFFFE);
+  assert_int_equal (SpdmContext->SessionIdList[0], SpdmContext->SessionInfo[0].SessionId);
+  assert_int_equal (SpdmContext->SessionIdList[1], SpdmContext->SessionInfo[1].SessionId);
+
+  //
+  // All slots are used by sessions which are not idle long enough to be evicted.
+  //
+  Policy.EvictIdleTime = 2000;
+  SpdmSetResponderSessionPolicy (SpdmContext, &Policy, SpdmResponderKeyExchangeTestIsPrivileged);
+  SpdmGetRandomNumber (SPDM_RANDOM_DATA_SIZE, mSpdmKeyExchangeRequest1.RandomData);
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseKeyExchange (SpdmContext, mSpdmKeyExchangeRequest1Size, &mSpdmKeyExchangeRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
+  assert_int_equal (SpdmResponse->Header.Param1, SPDM_ERROR_CODE_SESSION_LIMIT_EXCEEDED);
+
+  ZeroMem (&Policy, sizeof(Policy));
+  SpdmSetResponderSessionPolicy (SpdmContext, &Policy, NULL);
+  SpdmRegisterResponderAdmissionFunc (SpdmContext, NULL, NULL);
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SpdmContext->SessionInfo[Index].SessionId != INVALID_SESSION_ID) {
+      SpdmFreeSessionId (SpdmContext, SpdmContext->SessionInfo[Index].SessionId);
+    }
+  }
+  free(Data1);
+}
+
+UINTN mSpdmKeyExchangeYieldCount;
+
+BOOLEAN
+EFIAPI
+SpdmResponderKeyExchangeTestYield (
+  IN     VOID                        *SpdmContext,
+  IN     UINT8                       RequestCode,
+  IN     SPDM_RESPONDER_YIELD_POINT  YieldPoint
+  )
+{
+  //
+  // Yield after every step, in order.
+  //
+  assert_int_equal (RequestCode, SPDM_KEY_EXCHANGE);
+  assert_int_equal (YieldPoint, SpdmResponderYieldPointDheKeyGenerated + mSpdmKeyExchangeYieldCount);
+  mSpdmKeyExchangeYieldCount++;
+  return TRUE;
+}
+
+void TestSpdmResponderKeyExchangeCase9(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_KEY_EXCHANGE_RESPONSE *SpdmResponse;
+  SPDM_ERROR_DATA_RESPONSE_NOT_READY *ErrorData;
+  SPDM_MESSAGE_HEADER  SpdmRequest;
+  VOID                 *Data1;
+  UINTN                DataSize1;
+  UINT8                *Ptr;
+  UINTN                DheKeySize;
+  VOID                 *DHEContext;
+  UINTN                OpaqueKeyExchangeReqSize;
+  UINTN                Index;
+  SPDM_SESSION_INFO    *SessionInfo;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x9;
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+  SpdmContext->ConnectionInfo.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_KEY_EX_CAP;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_KEY_EX_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+  ReadResponderPublicCertificateChain (mUseHashAlgo, mUseAsymAlgo, &Data1, &DataSize1, NULL, NULL);
+  SpdmContext->LocalContext.LocalCertChainProvision[0] = Data1;
+  SpdmContext->LocalContext.LocalCertChainProvisionSize[0] = DataSize1;
+  SpdmContext->LocalContext.SlotCount = 1;
+  SpdmContext->Transcript.MessageA.BufferSize = 0;
+  SpdmContext->LocalContext.MutAuthRequested = 0;
+  mSpdmKeyExchangeYieldCount = 0;
+  SpdmRegisterResponderYieldFunc (SpdmContext, SpdmResponderKeyExchangeTestYield);
+
+  SpdmGetRandomNumber (SPDM_RANDOM_DATA_SIZE, mSpdmKeyExchangeRequest1.RandomData);
+  mSpdmKeyExchangeRequest1.ReqSessionID = 0xFFFF;
+  mSpdmKeyExchangeRequest1.Reserved = 0;
+  Ptr = mSpdmKeyExchangeRequest1.ExchangeData;
+  DheKeySize = GetSpdmDhePubKeySize (mUseDheAlgo);
+  DHEContext = SpdmDheNew (mUseDheAlgo);
+  SpdmDheGenerateKey (mUseDheAlgo, DHEContext, Ptr, &DheKeySize);
+  Ptr += DheKeySize;
+  SpdmDheFree (mUseDheAlgo, DHEContext);
+  OpaqueKeyExchangeReqSize = SpdmGetOpaqueDataSupportedVersionDataSize (SpdmContext);
+  *(UINT16 *)Ptr = (UINT16)OpaqueKeyExchangeReqSize;
+  Ptr += sizeof(UINT16);
+  SpdmBuildOpaqueDataSupportedVersionData (SpdmContext, &OpaqueKeyExchangeReqSize, Ptr);
+  Ptr += OpaqueKeyExchangeReqSize;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseKeyExchange (SpdmContext, mSpdmKeyExchangeRequest1Size, &mSpdmKeyExchangeRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResponse = (VOID *)Response;
+  ErrorData = (VOID *)((SPDM_ERROR_RESPONSE *)Response + 1);
+
+  //
+  // Each RESPOND_IF_READY runs one more step, until the handshake keys are derived.
+  //
+  SpdmRequest.SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmRequest.RequestResponseCode = SPDM_RESPOND_IF_READY;
+  for (Index = 0; Index < 3; Index++) {
+    assert_int_equal (mSpdmKeyExchangeYieldCount, Index + 1);
+    assert_int_equal (ResponseSize, sizeof(SPDM_ERROR_RESPONSE) + sizeof(SPDM_ERROR_DATA_RESPONSE_NOT_READY));
+    assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
+    assert_int_equal (SpdmResponse->Header.Param1, SPDM_ERROR_CODE_RESPONSE_NOT_READY);
+    assert_int_equal (ErrorData->RequestCode, SPDM_KEY_EXCHANGE);
+    SpdmRequest.Param1 = ErrorData->RequestCode;
+    SpdmRequest.Param2 = ErrorData->Token;
+    ResponseSize = sizeof(Response);
+    Status = SpdmGetResponseRespondIfReady (SpdmContext, sizeof(SpdmRequest), &SpdmRequest, &ResponseSize, Response);
+    assert_int_equal (Status, RETURN_SUCCESS);
+    if (SpdmResponse->Header.RequestResponseCode != SPDM_ERROR) {
+      break;
+    }
+  }
+  assert_int_equal (Index, 2);
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_KEY_EXCHANGE_RSP);
+  assert_int_equal (SpdmContext->PendingSignature.Valid, FALSE);
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, ((UINT32)0xFFFF << 16) | SpdmResponse->RspSessionID);
+  assert_non_null (SessionInfo);
+  assert_int_equal (SpdmSecuredMessageGetSessionState (SessionInfo->SecuredMessageContext), SpdmSessionStateHandshaking);
+
+  SpdmRegisterResponderYieldFunc (SpdmContext, NULL);
+  SpdmFreeSessionId (SpdmContext, SessionInfo->SessionId);
+  free(Data1);
+}
+
 SPDM_TEST_CONTEXT       mSpdmResponderKeyExchangeTestContext = {
   SPDM_TEST_CONTEXT_SIGNATURE,
   FALSE,
@@ -420,6 +736,12 @@ int SpdmResponderKeyExchangeTestMain(void) {
     cmocka_unit_test(TestSpdmResponderKeyExchangeCase5),
     // ConnectionState Check
     cmocka_unit_test(TestSpdmResponderKeyExchangeCase6),
+    // Success Case with a DHE key pool
+    cmocka_unit_test(TestSpdmResponderKeyExchangeCase7),
+    // Success Case evicting the least recently used unprivileged session
+    cmocka_unit_test(TestSpdmResponderKeyExchangeCase8),
+    // Success Case yielding after each cryptographic step
+    cmocka_unit_test(TestSpdmResponderKeyExchangeCase9),
   };
 
   SetupSpdmTestContext (&mSpdmResponderKeyExchangeTestContext);
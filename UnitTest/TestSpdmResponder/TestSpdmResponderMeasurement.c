@@ -988,8 +988,8 @@ void TestSpdmResponderMeasurementCase21(void **state) {
 
 /**
   Test 22: request a large number of measurements before requesting a singed response
-  Expected Behavior: while Transcript.MessageM is not full, get a RETURN_SUCCESS return code, empty Transcript.MessageM, and correct response message size and fields
-                      if Transcript.MessageM has no more room, an error response is expected
+  Expected Behavior: get a RETURN_SUCCESS return code, correct Transcript.MessageM size, and correct response message size and fields for every request,
+                      because Transcript.MessageM is kept as a running hash and never runs out of room
 **/
 void TestSpdmResponderMeasurementCase22(void **state) {
   RETURN_STATUS        Status;
@@ -1022,16 +1022,270 @@ void TestSpdmResponderMeasurementCase22(void **state) {
     Status = SpdmGetResponseMeasurement (SpdmContext, mSpdmGetMeasurementRequest6Size, &mSpdmGetMeasurementRequest6, &ResponseSize, Response);
     assert_int_equal (Status, RETURN_SUCCESS);
     SpdmResponse = (VOID *)Response;
-    if (SpdmResponse->Header.RequestResponseCode == SPDM_MEASUREMENTS) {
-      assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_MEASUREMENTS);
-      assert_int_equal (ResponseSize, sizeof(SPDM_MEASUREMENTS_RESPONSE) + sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + GetSpdmMeasurementHashSize (mUseMeasurementHashAlgo) + sizeof(UINT16));
-      assert_int_equal (SpdmContext->Transcript.MessageM.BufferSize, NumberOfMessages*(mSpdmGetMeasurementRequest6Size + sizeof(SPDM_MEASUREMENTS_RESPONSE) + sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + GetSpdmMeasurementHashSize (mUseMeasurementHashAlgo) + sizeof(UINT16)));
-    } else {
-      assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
-      assert_int_equal (SpdmContext->Transcript.MessageM.BufferSize, 0);
-      break;
+    assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_MEASUREMENTS);
+    assert_int_equal (ResponseSize, sizeof(SPDM_MEASUREMENTS_RESPONSE) + sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + GetSpdmMeasurementHashSize (mUseMeasurementHashAlgo) + sizeof(UINT16));
+    assert_int_equal (SpdmContext->Transcript.MessageM.BufferSize, NumberOfMessages*(mSpdmGetMeasurementRequest6Size + sizeof(SPDM_MEASUREMENTS_RESPONSE) + sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + GetSpdmMeasurementHashSize (mUseMeasurementHashAlgo) + sizeof(UINT16)));
+  }
+}
+
+UINTN  mSpdmResponderMeasurementBlockCollectionCount;
+UINT8  mSpdmResponderMeasurementBlockCollectionIndex;
+
+BOOLEAN
+EFIAPI
+SpdmResponderMeasurementTestBlockCollection (
+  IN     VOID                 *SpdmContext,
+  IN     UINT8                MeasurementSpecification,
+  IN     UINT32               MeasurementHashAlgo,
+  IN     UINT8                MeasurementIndex,
+     OUT VOID                 *MeasurementBlock,
+  IN OUT UINTN                *MeasurementBlockSize
+  )
+{
+  UINT8                        DeviceMeasurement[MAX_SPDM_MEASUREMENT_RECORD_SIZE];
+  UINT8                        DeviceMeasurementCount;
+  UINTN                        DeviceMeasurementSize;
+  SPDM_MEASUREMENT_BLOCK_DMTF  *CachedMeasurmentBlock;
+  UINTN                        MeasurmentBlockSize;
+  UINT8                        Index;
+
+  mSpdmResponderMeasurementBlockCollectionCount++;
+  mSpdmResponderMeasurementBlockCollectionIndex = MeasurementIndex;
+
+  DeviceMeasurementSize = sizeof(DeviceMeasurement);
+  if (!SpdmMeasurementCollectionFunc (MeasurementSpecification, MeasurementHashAlgo, &DeviceMeasurementCount, DeviceMeasurement, &DeviceMeasurementSize)) {
+    return FALSE;
+  }
+  CachedMeasurmentBlock = (VOID *)DeviceMeasurement;
+  for (Index = 1; Index <= DeviceMeasurementCount; Index++) {
+    MeasurmentBlockSize = sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + CachedMeasurmentBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueSize;
+    if (Index == MeasurementIndex) {
+      if (*MeasurementBlockSize < MeasurmentBlockSize) {
+        return FALSE;
+      }
+      CopyMem (MeasurementBlock, CachedMeasurmentBlock, MeasurmentBlockSize);
+      *MeasurementBlockSize = MeasurmentBlockSize;
+      return TRUE;
     }
+    CachedMeasurmentBlock = (VOID *)((UINTN)CachedMeasurmentBlock + MeasurmentBlockSize);
   }
+  return FALSE;
+}
+
+/**
+  Test 23: get one measurement repeatedly, with a measurement block collection function, before and after a measurement changes
+  Expected Behavior: get a RETURN_SUCCESS return code and correct response message size for every request,
+                      no measurement block is recollected until SpdmMeasurementChanged, then only the changed block is recollected once
+**/
+void TestSpdmResponderMeasurementCase23(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_MEASUREMENTS_RESPONSE *SpdmResponse;
+  UINTN                NumberOfMessages;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x17;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAuthenticated;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP_SIG;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->LocalContext.OpaqueMeasurementRspSize = 0;
+  SpdmContext->LocalContext.OpaqueMeasurementRsp = NULL;
+
+  mSpdmResponderMeasurementBlockCollectionCount = 0;
+  mSpdmResponderMeasurementBlockCollectionIndex = 0;
+  SpdmRegisterMeasurementBlockCollectionFunc (SpdmContext, SpdmResponderMeasurementTestBlockCollection);
+  SpdmMeasurementChanged (SpdmContext, SPDM_GET_MEASUREMENTS_REQUEST_MEASUREMENT_OPERATION_ALL_MEASUREMENTS);
+
+  for (NumberOfMessages = 0; NumberOfMessages < 3; NumberOfMessages++) {
+    if (NumberOfMessages == 2) {
+      SpdmMeasurementChanged (SpdmContext, 1);
+    }
+    SpdmContext->Transcript.MessageM.BufferSize = 0;
+    ResponseSize = sizeof(Response);
+    Status = SpdmGetResponseMeasurement (SpdmContext, mSpdmGetMeasurementRequest6Size, &mSpdmGetMeasurementRequest6, &ResponseSize, Response);
+    assert_int_equal (Status, RETURN_SUCCESS);
+    assert_int_equal (ResponseSize, sizeof(SPDM_MEASUREMENTS_RESPONSE) + sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + GetSpdmMeasurementHashSize (mUseMeasurementHashAlgo) + sizeof(UINT16));
+    SpdmResponse = (VOID *)Response;
+    assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_MEASUREMENTS);
+    if (NumberOfMessages < 2) {
+      assert_int_equal (mSpdmResponderMeasurementBlockCollectionCount, 0);
+    }
+  }
+  assert_int_equal (mSpdmResponderMeasurementBlockCollectionCount, 1);
+  assert_int_equal (mSpdmResponderMeasurementBlockCollectionIndex, 1);
+
+  SpdmRegisterMeasurementBlockCollectionFunc (SpdmContext, NULL);
+}
+
+#define SPDM_TEST_ITERATED_BLOCK_COUNT       (MAX_SPDM_MEASUREMENT_BLOCK_COUNT * 2)
+#define SPDM_TEST_ITERATED_BLOCK_VALUE_SIZE  0x40
+
+UINTN  mSpdmResponderMeasurementBlockIteratorCount;
+
+RETURN_STATUS
+EFIAPI
+SpdmResponderMeasurementTestBlockIterator (
+  IN     VOID                 *SpdmContext,
+  IN     UINT8                MeasurementSpecification,
+  IN     UINT32               MeasurementHashAlgo,
+  IN     UINT8                MeasurementIndex,
+     OUT VOID                 *MeasurementBlock OPTIONAL,
+  IN OUT UINTN                *MeasurementBlockSize
+  )
+{
+  SPDM_MEASUREMENT_BLOCK_DMTF  *MeasurmentBlock;
+  UINTN                        BufferSize;
+
+  mSpdmResponderMeasurementBlockIteratorCount++;
+  if (MeasurementIndex > SPDM_TEST_ITERATED_BLOCK_COUNT) {
+    return RETURN_NOT_FOUND;
+  }
+  BufferSize = *MeasurementBlockSize;
+  *MeasurementBlockSize = sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + SPDM_TEST_ITERATED_BLOCK_VALUE_SIZE;
+  if (BufferSize < *MeasurementBlockSize) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+  MeasurmentBlock = MeasurementBlock;
+  MeasurmentBlock->MeasurementBlockCommonHeader.Index = MeasurementIndex;
+  MeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSpecification = MeasurementSpecification;
+  MeasurmentBlock->MeasurementBlockCommonHeader.MeasurementSize = sizeof(SPDM_MEASUREMENT_BLOCK_DMTF_HEADER) + SPDM_TEST_ITERATED_BLOCK_VALUE_SIZE;
+  MeasurmentBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueType = SPDM_MEASUREMENT_BLOCK_MEASUREMENT_TYPE_MUTABLE_FIRMWARE;
+  MeasurmentBlock->MeasurementBlockDmtfHeader.DMTFSpecMeasurementValueSize = SPDM_TEST_ITERATED_BLOCK_VALUE_SIZE;
+  SetMem (MeasurmentBlock + 1, SPDM_TEST_ITERATED_BLOCK_VALUE_SIZE, MeasurementIndex);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Test 24: get the count and all measurements without signature, with a measurement block iterator
+  Expected Behavior: get a RETURN_SUCCESS return code, and all blocks of the iterator in the response,
+                      more than the measurement record kept in the SPDM context can hold
+**/
+void TestSpdmResponderMeasurementCase24(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                ResponseSize;
+  UINT8                Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_MEASUREMENTS_RESPONSE *SpdmResponse;
+  SPDM_MEASUREMENT_BLOCK_DMTF *MeasurmentBlock;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x18;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAuthenticated;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP_SIG;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->LocalContext.OpaqueMeasurementRspSize = 0;
+  SpdmContext->LocalContext.OpaqueMeasurementRsp = NULL;
+  SpdmRegisterMeasurementBlockIteratorFunc (SpdmContext, SpdmResponderMeasurementTestBlockIterator);
+
+  SpdmContext->Transcript.MessageM.BufferSize = 0;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseMeasurement (SpdmContext, mSpdmGetMeasurementRequest1Size, &mSpdmGetMeasurementRequest1, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_MEASUREMENTS);
+  assert_int_equal (SpdmResponse->Header.Param1, SPDM_TEST_ITERATED_BLOCK_COUNT);
+
+  SpdmContext->Transcript.MessageM.BufferSize = 0;
+  ResponseSize = sizeof(Response);
+  Status = SpdmGetResponseMeasurement (SpdmContext, mSpdmGetMeasurementRequest7Size, &mSpdmGetMeasurementRequest7, &ResponseSize, Response);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (ResponseSize, sizeof(SPDM_MEASUREMENTS_RESPONSE) + SPDM_TEST_ITERATED_BLOCK_COUNT * (sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + SPDM_TEST_ITERATED_BLOCK_VALUE_SIZE) + sizeof(UINT16));
+  SpdmResponse = (VOID *)Response;
+  assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_MEASUREMENTS);
+  assert_int_equal (SpdmResponse->NumberOfBlocks, SPDM_TEST_ITERATED_BLOCK_COUNT);
+  MeasurmentBlock = (VOID *)((UINT8 *)(SpdmResponse + 1) + (SPDM_TEST_ITERATED_BLOCK_COUNT - 1) * (sizeof(SPDM_MEASUREMENT_BLOCK_DMTF) + SPDM_TEST_ITERATED_BLOCK_VALUE_SIZE));
+  assert_int_equal (MeasurmentBlock->MeasurementBlockCommonHeader.Index, SPDM_TEST_ITERATED_BLOCK_COUNT);
+
+  SpdmRegisterMeasurementBlockIteratorFunc (SpdmContext, NULL);
+}
+
+/**
+  Test 25: generate the all measurements summary hash repeatedly, with a measurement block iterator, before and after a measurement changes
+  Expected Behavior: the same hash every time, the blocks are collected only for the first hash and after SpdmMeasurementChanged
+**/
+void TestSpdmResponderMeasurementCase25(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT8                SummaryHash[MAX_HASH_SIZE];
+  UINT8                CachedSummaryHash[MAX_HASH_SIZE];
+  BOOLEAN              Result;
+  UINTN                IteratorCount;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x19;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAuthenticated;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP_SIG;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmRegisterMeasurementBlockIteratorFunc (SpdmContext, SpdmResponderMeasurementTestBlockIterator);
+
+  mSpdmResponderMeasurementBlockIteratorCount = 0;
+  Result = SpdmGenerateMeasurementSummaryHash (SpdmContext, FALSE, SPDM_CHALLENGE_REQUEST_ALL_MEASUREMENTS_HASH, SummaryHash);
+  assert_true (Result);
+  IteratorCount = mSpdmResponderMeasurementBlockIteratorCount;
+  assert_int_not_equal (IteratorCount, 0);
+
+  Result = SpdmGenerateMeasurementSummaryHash (SpdmContext, FALSE, SPDM_CHALLENGE_REQUEST_ALL_MEASUREMENTS_HASH, CachedSummaryHash);
+  assert_true (Result);
+  assert_int_equal (mSpdmResponderMeasurementBlockIteratorCount, IteratorCount);
+  assert_memory_equal (CachedSummaryHash, SummaryHash, GetSpdmHashSize (mUseHashAlgo));
+
+  SpdmMeasurementChanged (SpdmContext, 1);
+  Result = SpdmGenerateMeasurementSummaryHash (SpdmContext, FALSE, SPDM_CHALLENGE_REQUEST_ALL_MEASUREMENTS_HASH, CachedSummaryHash);
+  assert_true (Result);
+  assert_int_equal (mSpdmResponderMeasurementBlockIteratorCount, IteratorCount * 2);
+  assert_memory_equal (CachedSummaryHash, SummaryHash, GetSpdmHashSize (mUseHashAlgo));
+
+  SpdmRegisterMeasurementBlockIteratorFunc (SpdmContext, NULL);
+}
+
+void TestSpdmResponderMeasurementCase26(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT8                SummaryHash[MAX_HASH_SIZE];
+  UINT8                FreshSummaryHash[MAX_HASH_SIZE];
+  BOOLEAN              Result;
+  UINTN                IteratorCount;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x1A;
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAuthenticated;
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_CAP_SIG |
+                                                SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_FRESH_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = mUseMeasurementSpec;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmRegisterMeasurementBlockIteratorFunc (SpdmContext, SpdmResponderMeasurementTestBlockIterator);
+
+  mSpdmResponderMeasurementBlockIteratorCount = 0;
+  Result = SpdmGenerateMeasurementSummaryHash (SpdmContext, FALSE, SPDM_CHALLENGE_REQUEST_ALL_MEASUREMENTS_HASH, SummaryHash);
+  assert_true (Result);
+  IteratorCount = mSpdmResponderMeasurementBlockIteratorCount;
+  assert_int_not_equal (IteratorCount, 0);
+
+  // no change is notified, but fresh measurements are recollected
+  Result = SpdmGenerateMeasurementSummaryHash (SpdmContext, FALSE, SPDM_CHALLENGE_REQUEST_ALL_MEASUREMENTS_HASH, FreshSummaryHash);
+  assert_true (Result);
+  assert_int_equal (mSpdmResponderMeasurementBlockIteratorCount, IteratorCount * 2);
+  assert_memory_equal (FreshSummaryHash, SummaryHash, GetSpdmHashSize (mUseHashAlgo));
+
+  SpdmContext->LocalContext.Capability.Flags &= ~SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MEAS_FRESH_CAP;
+  SpdmRegisterMeasurementBlockIteratorFunc (SpdmContext, NULL);
 }
 
 SPDM_TEST_CONTEXT       mSpdmResponderMeasurementTestContext = {
@@ -1088,6 +1342,14 @@ int SpdmResponderMeasurementTestMain(void) {
     cmocka_unit_test(TestSpdmResponderMeasurementCase21),
     // Large number of requests before requiring a signature
     cmocka_unit_test(TestSpdmResponderMeasurementCase22),
+    // Measurement record served from the local measurement cache, recollecting only the changed block
+    cmocka_unit_test(TestSpdmResponderMeasurementCase23),
+    // Measurement blocks served from a measurement block iterator, more than MAX_SPDM_MEASUREMENT_BLOCK_COUNT
+    cmocka_unit_test(TestSpdmResponderMeasurementCase24),
+    // Measurement summary hash reused until a measurement changes
+    cmocka_unit_test(TestSpdmResponderMeasurementCase25),
+    // MEAS_FRESH_CAP: measurement summary hash is recomputed for every request
+    cmocka_unit_test(TestSpdmResponderMeasurementCase26),
   };
 
   SetupSpdmTestContext (&mSpdmResponderMeasurementTestContext);
@@ -0,0 +1,287 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmUnitTest.h"
+#include <SpdmResponderLibInternal.h>
+
+#define TEST_STATE_EVENT_SESSION_ID  0xFFFFFFFE
+#define TEST_STATE_EVENT_MAX_COUNT   (MAX_SPDM_STATE_EVENT_QUEUE_DEPTH * 3)
+
+//
+// The transitions made by the test, in order, and the transitions seen by the callbacks.
+//
+STATIC SPDM_STATE_EVENT       mTestStateEventExpected[TEST_STATE_EVENT_MAX_COUNT];
+STATIC UINTN                  mTestStateEventExpectedCount;
+STATIC SPDM_STATE_EVENT       mTestStateEventLog[TEST_STATE_EVENT_MAX_COUNT];
+STATIC UINTN                  mTestStateEventLogCount;
+
+VOID
+EFIAPI
+TestSpdmResponderStateEventSessionCallback (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               SessionId,
+  IN     SPDM_SESSION_STATE   SessionState
+  )
+{
+  assert_true (mTestStateEventLogCount < TEST_STATE_EVENT_MAX_COUNT);
+  mTestStateEventLog[mTestStateEventLogCount].IsSessionEvent = TRUE;
+  mTestStateEventLog[mTestStateEventLogCount].SessionId = SessionId;
+  mTestStateEventLog[mTestStateEventLogCount].State = SessionState;
+  mTestStateEventLogCount++;
+}
+
+VOID
+EFIAPI
+TestSpdmResponderStateEventConnectionCallback (
+  IN     VOID                     *SpdmContext,
+  IN     SPDM_CONNECTION_STATE    ConnectionState
+  )
+{
+  assert_true (mTestStateEventLogCount < TEST_STATE_EVENT_MAX_COUNT);
+  mTestStateEventLog[mTestStateEventLogCount].IsSessionEvent = FALSE;
+  mTestStateEventLog[mTestStateEventLogCount].SessionId = 0;
+  mTestStateEventLog[mTestStateEventLogCount].State = ConnectionState;
+  mTestStateEventLogCount++;
+}
+
+/**
+  Reset the queue, the callbacks and the logs, and set up a session in which the states are changed.
+**/
+VOID
+TestSpdmResponderStateEventSetup (
+  IN SPDM_DEVICE_CONTEXT    *SpdmContext,
+  IN BOOLEAN                Enable
+  )
+{
+  ZeroMem (&SpdmContext->StateEventQueue, sizeof(SpdmContext->StateEventQueue));
+  ZeroMem (SpdmContext->SpdmSessionStateCallback, sizeof(SpdmContext->SpdmSessionStateCallback));
+  ZeroMem (SpdmContext->SpdmConnectionStateCallback, sizeof(SpdmContext->SpdmConnectionStateCallback));
+  SpdmRegisterSessionStateCallback (SpdmContext, TestSpdmResponderStateEventSessionCallback);
+  SpdmRegisterConnectionStateCallback (SpdmContext, TestSpdmResponderStateEventConnectionCallback);
+  SpdmEnableStateEventQueue (SpdmContext, Enable);
+
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNotStarted;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+  SpdmSessionInfoInit (SpdmContext, &SpdmContext->SessionInfo[0], TEST_STATE_EVENT_SESSION_ID, FALSE);
+
+  mTestStateEventExpectedCount = 0;
+  mTestStateEventLogCount = 0;
+}
+
+/**
+  Make Count state transitions, alternating between the connection and the session, and record them as expected.
+**/
+VOID
+TestSpdmResponderStateEventTransit (
+  IN SPDM_DEVICE_CONTEXT    *SpdmContext,
+  IN UINTN                  Count
+  )
+{
+  SPDM_STATE_EVENT    *Expected;
+  UINTN               Index;
+
+  for (Index = 0; Index < Count; Index++) {
+    assert_true (mTestStateEventExpectedCount < TEST_STATE_EVENT_MAX_COUNT);
+    Expected = &mTestStateEventExpected[mTestStateEventExpectedCount];
+    //
+    // Each state differs from the previous one of the same kind, so every call is a transition.
+    //
+    if ((mTestStateEventExpectedCount % 2) == 0) {
+      Expected->IsSessionEvent = FALSE;
+      Expected->SessionId = 0;
+      Expected->State = (UINT32)((mTestStateEventExpectedCount / 2 + 1) % SpdmConnectionStateMax);
+      SpdmSetConnectionState (SpdmContext, (SPDM_CONNECTION_STATE)Expected->State);
+    } else {
+      Expected->IsSessionEvent = TRUE;
+      Expected->SessionId = TEST_STATE_EVENT_SESSION_ID;
+      Expected->State = (UINT32)((mTestStateEventExpectedCount / 2 + 1) % SpdmSessionStateMax);
+      SpdmSetSessionState (SpdmContext, TEST_STATE_EVENT_SESSION_ID, (SPDM_SESSION_STATE)Expected->State);
+    }
+    mTestStateEventExpectedCount++;
+  }
+}
+
+/**
+  Check that Count transitions from LogIndex of the callback log are the expected ones from ExpectedIndex.
+**/
+VOID
+TestSpdmResponderStateEventCheckLog (
+  IN UINTN                  LogIndex,
+  IN UINTN                  ExpectedIndex,
+  IN UINTN                  Count
+  )
+{
+  UINTN               Index;
+
+  assert_true (LogIndex + Count <= mTestStateEventLogCount);
+  assert_true (ExpectedIndex + Count <= mTestStateEventExpectedCount);
+  for (Index = 0; Index < Count; Index++) {
+    assert_int_equal (mTestStateEventLog[LogIndex + Index].IsSessionEvent, mTestStateEventExpected[ExpectedIndex + Index].IsSessionEvent);
+    assert_int_equal (mTestStateEventLog[LogIndex + Index].SessionId, mTestStateEventExpected[ExpectedIndex + Index].SessionId);
+    assert_int_equal (mTestStateEventLog[LogIndex + Index].State, mTestStateEventExpected[ExpectedIndex + Index].State);
+  }
+}
+
+/**
+  Test 1: the state event queue is disabled.
+  Expected Behavior: the callbacks are called at each transition, and nothing is left to dispatch.
+**/
+void TestSpdmResponderStateEventCase1(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                EventCount;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x1;
+  TestSpdmResponderStateEventSetup (SpdmContext, FALSE);
+
+  TestSpdmResponderStateEventTransit (SpdmContext, 1);
+  assert_int_equal (mTestStateEventLogCount, 1);
+  TestSpdmResponderStateEventTransit (SpdmContext, 1);
+  assert_int_equal (mTestStateEventLogCount, 2);
+  TestSpdmResponderStateEventCheckLog (0, 0, 2);
+
+  Status = SpdmDispatchStateEvents (SpdmContext, 0, &EventCount);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (EventCount, 0);
+  assert_int_equal (mTestStateEventLogCount, 2);
+}
+
+/**
+  Test 2: connection and session transitions are posted to the queue, then dispatched.
+  Expected Behavior: no callback is called until the dispatch, which calls them once each, in the order of the transitions.
+**/
+void TestSpdmResponderStateEventCase2(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                EventCount;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x2;
+  TestSpdmResponderStateEventSetup (SpdmContext, TRUE);
+
+  TestSpdmResponderStateEventTransit (SpdmContext, 6);
+  assert_int_equal (mTestStateEventLogCount, 0);
+  assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, mTestStateEventExpected[4].State);
+
+  Status = SpdmDispatchStateEvents (SpdmContext, 0, &EventCount);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (EventCount, 6);
+  assert_int_equal (mTestStateEventLogCount, 6);
+  TestSpdmResponderStateEventCheckLog (0, 0, 6);
+
+  Status = SpdmDispatchStateEvents (SpdmContext, 0, &EventCount);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (EventCount, 0);
+  assert_int_equal (mTestStateEventLogCount, 6);
+}
+
+/**
+  Test 3: a full queue is dispatched partly with MaxEventCount, and the freed entries are posted again.
+  Expected Behavior: nothing is dropped, and all transitions are dispatched in order across the wrap of the ring.
+**/
+void TestSpdmResponderStateEventCase3(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                EventCount;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x3;
+  TestSpdmResponderStateEventSetup (SpdmContext, TRUE);
+
+  TestSpdmResponderStateEventTransit (SpdmContext, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH);
+  Status = SpdmDispatchStateEvents (SpdmContext, 3, &EventCount);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (EventCount, 3);
+  assert_int_equal (mTestStateEventLogCount, 3);
+  TestSpdmResponderStateEventCheckLog (0, 0, 3);
+
+  TestSpdmResponderStateEventTransit (SpdmContext, 3);
+  assert_int_equal (SpdmContext->StateEventQueue.DroppedCount, 0);
+  Status = SpdmDispatchStateEvents (SpdmContext, 0, &EventCount);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (EventCount, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH);
+  assert_int_equal (mTestStateEventLogCount, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH + 3);
+  TestSpdmResponderStateEventCheckLog (0, 0, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH + 3);
+}
+
+/**
+  Test 4: more transitions are made than the queue holds.
+  Expected Behavior: the transitions past the depth are dropped, the dispatch of the others returns RETURN_OUT_OF_RESOURCES
+  once, and a later drop is reported again.
+**/
+void TestSpdmResponderStateEventCase4(void **state) {
+  RETURN_STATUS        Status;
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINTN                EventCount;
+
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x4;
+  TestSpdmResponderStateEventSetup (SpdmContext, TRUE);
+
+  TestSpdmResponderStateEventTransit (SpdmContext, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH + 2);
+  assert_int_equal (SpdmContext->StateEventQueue.DroppedCount, 2);
+  assert_int_equal (mTestStateEventLogCount, 0);
+
+  Status = SpdmDispatchStateEvents (SpdmContext, 0, &EventCount);
+  assert_int_equal (Status, RETURN_OUT_OF_RESOURCES);
+  assert_int_equal (EventCount, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH);
+  assert_int_equal (mTestStateEventLogCount, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH);
+  TestSpdmResponderStateEventCheckLog (0, 0, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH);
+
+  Status = SpdmDispatchStateEvents (SpdmContext, 0, &EventCount);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (EventCount, 0);
+
+  TestSpdmResponderStateEventTransit (SpdmContext, 1);
+  Status = SpdmDispatchStateEvents (SpdmContext, 0, &EventCount);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (EventCount, 1);
+  TestSpdmResponderStateEventCheckLog (MAX_SPDM_STATE_EVENT_QUEUE_DEPTH, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH + 2, 1);
+
+  TestSpdmResponderStateEventTransit (SpdmContext, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH + 1);
+  assert_int_equal (SpdmContext->StateEventQueue.DroppedCount, 3);
+  Status = SpdmDispatchStateEvents (SpdmContext, 0, &EventCount);
+  assert_int_equal (Status, RETURN_OUT_OF_RESOURCES);
+  assert_int_equal (EventCount, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH);
+  TestSpdmResponderStateEventCheckLog (MAX_SPDM_STATE_EVENT_QUEUE_DEPTH + 1, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH + 3, MAX_SPDM_STATE_EVENT_QUEUE_DEPTH);
+}
+
+SPDM_TEST_CONTEXT       mSpdmResponderStateEventTestContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  FALSE,
+};
+
+int SpdmResponderStateEventTestMain(void) {
+  const struct CMUnitTest SpdmResponderStateEventTests[] = {
+    // Queue disabled
+    cmocka_unit_test(TestSpdmResponderStateEventCase1),
+    // Post and dispatch in order
+    cmocka_unit_test(TestSpdmResponderStateEventCase2),
+    // Partial dispatch and wrap of the ring
+    cmocka_unit_test(TestSpdmResponderStateEventCase3),
+    // Queue full: drop and RETURN_OUT_OF_RESOURCES
+    cmocka_unit_test(TestSpdmResponderStateEventCase4),
+  };
+
+  SetupSpdmTestContext (&mSpdmResponderStateEventTestContext);
+
+  return cmocka_run_group_tests(SpdmResponderStateEventTests, SpdmUnitTestGroupSetup, SpdmUnitTestGroupTeardown);
+}
@@ -0,0 +1,283 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SpdmUnitTest.h"
+#include <SpdmResponderLibInternal.h>
+
+#define TEST_VALIDATION_CAPABILITIES_MISSING  BIT0
+#define TEST_VALIDATION_STATE_LOW             BIT1
+#define TEST_VALIDATION_SESSION_MISSING       BIT2
+#define TEST_VALIDATION_REQUEST_SHORT         BIT3
+
+STATIC UINT8                  mSpdmValidationRequest[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+STATIC UINTN                  mSpdmValidationRequestSize;
+
+STATIC UINT8                  mSpdmValidationSentMessage[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+STATIC UINTN                  mSpdmValidationSentMessageSize;
+
+/**
+  Transport encode function that sends the SPDM message as is, so that the response can be compared.
+**/
+RETURN_STATUS
+EFIAPI
+TestSpdmResponderValidationEncodeMessage (
+  IN     VOID                 *SpdmContext,
+  IN     UINT32               *SessionId,
+  IN     BOOLEAN              IsAppMessage,
+  IN     BOOLEAN              IsRequester,
+  IN     UINTN                SpdmMessageSize,
+  IN     VOID                 *SpdmMessage,
+  IN OUT UINTN                *TransportMessageSize,
+     OUT VOID                 *TransportMessage
+  )
+{
+  assert_null (SessionId);
+  assert_false (IsAppMessage);
+  assert_true (SpdmMessageSize <= sizeof(mSpdmValidationSentMessage));
+  assert_true (SpdmMessageSize <= *TransportMessageSize);
+  CopyMem (mSpdmValidationSentMessage, SpdmMessage, SpdmMessageSize);
+  mSpdmValidationSentMessageSize = SpdmMessageSize;
+  CopyMem (TransportMessage, SpdmMessage, SpdmMessageSize);
+  *TransportMessageSize = SpdmMessageSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Set up a negotiated connection in which the request of a validation table entry fails the given checks.
+
+  The session of a session-only request is not allocated, so that its handler rejects it after the checks of the table.
+
+  @retval TRUE   The request fails the given checks.
+  @retval FALSE  The entry has no such checks.
+**/
+BOOLEAN
+TestSpdmResponderValidationSetup (
+  IN SPDM_DEVICE_CONTEXT             *SpdmContext,
+  IN SPDM_REQUEST_VALIDATION_STRUCT  *Validation,
+  IN UINT32                          Failure
+  )
+{
+  SPDM_MESSAGE_HEADER  *SpdmRequest;
+
+  if (((Failure & TEST_VALIDATION_CAPABILITIES_MISSING) != 0) &&
+      (Validation->RequesterCapabilitiesFlag == 0) && (Validation->ResponderCapabilitiesFlag == 0)) {
+    return FALSE;
+  }
+  if (((Failure & TEST_VALIDATION_STATE_LOW) != 0) &&
+      (Validation->MinConnectionState == SpdmConnectionStateNotStarted)) {
+    return FALSE;
+  }
+  if (((Failure & TEST_VALIDATION_SESSION_MISSING) != 0) && !Validation->SessionOnly) {
+    return FALSE;
+  }
+  if (((Failure & TEST_VALIDATION_REQUEST_SHORT) != 0) &&
+      (Validation->MinRequestSize <= sizeof(SPDM_MESSAGE_HEADER))) {
+    return FALSE;
+  }
+
+  SpdmContext->ResponseState = SpdmResponseStateNormal;
+  SpdmContext->ConnectionInfo.Version.SpdmVersionCount = 1;
+  SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MajorVersion = 1;
+  SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MinorVersion = 1;
+  if ((Failure & TEST_VALIDATION_STATE_LOW) != 0) {
+    SpdmContext->ConnectionInfo.ConnectionState = Validation->MinConnectionState - 1;
+  } else {
+    SpdmContext->ConnectionInfo.ConnectionState = Validation->MinConnectionState;
+  }
+  if ((Failure & TEST_VALIDATION_CAPABILITIES_MISSING) != 0) {
+    SpdmContext->ConnectionInfo.Capability.Flags = 0;
+    SpdmContext->LocalContext.Capability.Flags = 0;
+  } else {
+    SpdmContext->ConnectionInfo.Capability.Flags = Validation->RequesterCapabilitiesFlag;
+    SpdmContext->LocalContext.Capability.Flags = Validation->ResponderCapabilitiesFlag;
+  }
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = mUseHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.BaseAsymAlgo = mUseAsymAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementSpec = SPDM_MEASUREMENT_BLOCK_HEADER_SPECIFICATION_DMTF;
+  SpdmContext->ConnectionInfo.Algorithm.MeasurementHashAlgo = mUseMeasurementHashAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = mUseDheAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = mUseAeadAlgo;
+  SpdmContext->ConnectionInfo.Algorithm.KeySchedule = mUseKeyScheduleAlgo;
+  SpdmContext->LocalContext.SlotCount = 1;
+  SpdmContext->LargeResponseSize = 0;
+  SpdmContext->LatestSessionId = INVALID_SESSION_ID;
+  SpdmContext->LastSpdmRequestSessionIdValid = Validation->SessionOnly && ((Failure & TEST_VALIDATION_SESSION_MISSING) == 0);
+  SpdmContext->LastSpdmRequestSessionId = 0xFFFFFFFF;
+
+  ZeroMem (mSpdmValidationRequest, sizeof(mSpdmValidationRequest));
+  SpdmRequest = (VOID *)mSpdmValidationRequest;
+  SpdmRequest->SPDMVersion = SPDM_MESSAGE_VERSION_11;
+  SpdmRequest->RequestResponseCode = Validation->RequestCode;
+  mSpdmValidationRequestSize = Validation->MinRequestSize;
+  if ((Failure & TEST_VALIDATION_REQUEST_SHORT) != 0) {
+    mSpdmValidationRequestSize--;
+  }
+  CopyMem (SpdmContext->LastSpdmRequest, mSpdmValidationRequest, mSpdmValidationRequestSize);
+  SpdmContext->LastSpdmRequestSize = mSpdmValidationRequestSize;
+  return TRUE;
+}
+
+/**
+  Check that every validation table entry rejects its request with the ERROR of its handler.
+**/
+VOID
+TestSpdmResponderValidationCompare (
+  IN SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN UINT32               Failure
+  )
+{
+  RETURN_STATUS                   Status;
+  SPDM_REQUEST_VALIDATION_STRUCT  *Validation;
+  SPDM_GET_SPDM_RESPONSE_FUNC     GetResponseFunc;
+  UINTN                           Index;
+  UINTN                           TestedCount;
+  UINTN                           ResponseSize;
+  UINT8                           Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                           HandlerResponseSize;
+  UINT8                           HandlerResponse[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  SPDM_ERROR_RESPONSE             *SpdmResponse;
+
+  TestedCount = 0;
+  for (Index = 0; Index < mRequestValidationStructCount; Index++) {
+    Validation = &mRequestValidationStruct[Index];
+    GetResponseFunc = SpdmGetResponseFuncViaRequestCode (Validation->RequestCode);
+    if (GetResponseFunc == NULL) {
+      continue;
+    }
+
+    if (!TestSpdmResponderValidationSetup (SpdmContext, Validation, Failure)) {
+      continue;
+    }
+    ResponseSize = sizeof(Response);
+    ZeroMem (Response, sizeof(Response));
+    assert_true (SpdmResponderRejectMalformedRequest (SpdmContext, mSpdmValidationRequestSize, mSpdmValidationRequest, &ResponseSize, Response));
+    SpdmResponse = (VOID *)Response;
+    assert_int_equal (SpdmResponse->Header.RequestResponseCode, SPDM_ERROR);
+
+    TestSpdmResponderValidationSetup (SpdmContext, Validation, Failure);
+    HandlerResponseSize = sizeof(HandlerResponse);
+    ZeroMem (HandlerResponse, sizeof(HandlerResponse));
+    Status = GetResponseFunc (SpdmContext, mSpdmValidationRequestSize, mSpdmValidationRequest, &HandlerResponseSize, HandlerResponse);
+    assert_int_equal (Status, RETURN_SUCCESS);
+    assert_int_equal (ResponseSize, HandlerResponseSize);
+    assert_memory_equal (Response, HandlerResponse, HandlerResponseSize);
+    TestedCount++;
+  }
+  assert_int_not_equal (TestedCount, 0);
+}
+
+void TestSpdmResponderValidationCase1(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+
+  SpdmTestContext = *state;
+  SpdmTestContext->CaseId = 0x1;
+  TestSpdmResponderValidationCompare (SpdmTestContext->SpdmContext, TEST_VALIDATION_CAPABILITIES_MISSING);
+}
+
+void TestSpdmResponderValidationCase2(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+
+  SpdmTestContext = *state;
+  SpdmTestContext->CaseId = 0x2;
+  TestSpdmResponderValidationCompare (SpdmTestContext->SpdmContext, TEST_VALIDATION_STATE_LOW);
+}
+
+void TestSpdmResponderValidationCase3(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+
+  //
+  // The capabilities and the connection state are checked in the order of the handler.
+  //
+  SpdmTestContext = *state;
+  SpdmTestContext->CaseId = 0x3;
+  TestSpdmResponderValidationCompare (SpdmTestContext->SpdmContext, TEST_VALIDATION_CAPABILITIES_MISSING | TEST_VALIDATION_STATE_LOW);
+}
+
+void TestSpdmResponderValidationCase4(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+
+  SpdmTestContext = *state;
+  SpdmTestContext->CaseId = 0x4;
+  TestSpdmResponderValidationCompare (SpdmTestContext->SpdmContext, TEST_VALIDATION_SESSION_MISSING);
+}
+
+void TestSpdmResponderValidationCase5(void **state) {
+  SPDM_TEST_CONTEXT    *SpdmTestContext;
+
+  SpdmTestContext = *state;
+  SpdmTestContext->CaseId = 0x5;
+  TestSpdmResponderValidationCompare (SpdmTestContext->SpdmContext, TEST_VALIDATION_REQUEST_SHORT);
+}
+
+void TestSpdmResponderValidationCase6(void **state) {
+  RETURN_STATUS                   Status;
+  SPDM_TEST_CONTEXT               *SpdmTestContext;
+  SPDM_DEVICE_CONTEXT             *SpdmContext;
+  SPDM_REQUEST_VALIDATION_STRUCT  *Validation;
+  SPDM_GET_SPDM_RESPONSE_FUNC     GetResponseFunc;
+  UINTN                           Index;
+  UINTN                           ResponseSize;
+  UINT8                           Response[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                           HandlerResponseSize;
+  UINT8                           HandlerResponse[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+
+  //
+  // SpdmBuildResponse sends the ERROR of the handler for a request without its capabilities.
+  //
+  SpdmTestContext = *state;
+  SpdmContext = SpdmTestContext->SpdmContext;
+  SpdmTestContext->CaseId = 0x6;
+  SpdmRegisterTransportLayerFunc (SpdmContext, TestSpdmResponderValidationEncodeMessage, SpdmTransportTestDecodeMessage);
+  for (Index = 0; Index < mRequestValidationStructCount; Index++) {
+    Validation = &mRequestValidationStruct[Index];
+    GetResponseFunc = SpdmGetResponseFuncViaRequestCode (Validation->RequestCode);
+    if ((GetResponseFunc == NULL) ||
+        !TestSpdmResponderValidationSetup (SpdmContext, Validation, TEST_VALIDATION_CAPABILITIES_MISSING)) {
+      continue;
+    }
+    HandlerResponseSize = sizeof(HandlerResponse);
+    Status = GetResponseFunc (SpdmContext, mSpdmValidationRequestSize, mSpdmValidationRequest, &HandlerResponseSize, HandlerResponse);
+    assert_int_equal (Status, RETURN_SUCCESS);
+
+    TestSpdmResponderValidationSetup (SpdmContext, Validation, TEST_VALIDATION_CAPABILITIES_MISSING);
+    mSpdmValidationSentMessageSize = 0;
+    ResponseSize = sizeof(Response);
+    Status = SpdmBuildResponse (SpdmContext, NULL, FALSE, &ResponseSize, Response);
+    assert_int_equal (Status, RETURN_SUCCESS);
+    assert_int_equal (mSpdmValidationSentMessageSize, HandlerResponseSize);
+    assert_memory_equal (mSpdmValidationSentMessage, HandlerResponse, HandlerResponseSize);
+  }
+  SpdmRegisterTransportLayerFunc (SpdmContext, SpdmTransportTestEncodeMessage, SpdmTransportTestDecodeMessage);
+}
+
+SPDM_TEST_CONTEXT       mSpdmResponderValidationTestContext = {
+  SPDM_TEST_CONTEXT_SIGNATURE,
+  FALSE,
+};
+
+int SpdmResponderValidationTestMain(void) {
+  const struct CMUnitTest SpdmResponderValidationTests[] = {
+    // Missing capabilities
+    cmocka_unit_test(TestSpdmResponderValidationCase1),
+    // ConnectionState below the minimum
+    cmocka_unit_test(TestSpdmResponderValidationCase2),
+    // Missing capabilities and ConnectionState below the minimum
+    cmocka_unit_test(TestSpdmResponderValidationCase3),
+    // Session-only request outside a session
+    cmocka_unit_test(TestSpdmResponderValidationCase4),
+    // Request shorter than the minimum
+    cmocka_unit_test(TestSpdmResponderValidationCase5),
+    // SpdmBuildResponse: missing capabilities
+    cmocka_unit_test(TestSpdmResponderValidationCase6),
+  };
+
+  SetupSpdmTestContext (&mSpdmResponderValidationTestContext);
+
+  return cmocka_run_group_tests(SpdmResponderValidationTests, SpdmUnitTestGroupSetup, SpdmUnitTestGroupTeardown);
+}
@@ -0,0 +1,170 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TestSpdmSession.h"
+
+/**
+  Return the 2-byte sequence number carried in the record header, as MCTP does.
+**/
+UINT8
+EFIAPI
+TestSessionGetSequenceNumber (
+  IN     UINT64     SequenceNumber,
+  IN OUT UINT8      *SequenceNumberBuffer
+  )
+{
+  CopyMem (SequenceNumberBuffer, &SequenceNumber, sizeof(UINT16));
+  return sizeof(UINT16);
+}
+
+UINT32
+EFIAPI
+TestSessionGetMaxRandomNumberCount (
+  VOID
+  )
+{
+  return 0;
+}
+
+SPDM_SECURED_MESSAGE_CALLBACKS  mTestSessionCallbacks = {
+  SPDM_SECURED_MESSAGE_CALLBACKS_VERSION,
+  TestSessionGetSequenceNumber,
+  TestSessionGetMaxRandomNumberCount,
+};
+
+/**
+  Import the fixed AES-256-GCM session keys, with the given sequence numbers.
+**/
+VOID
+TestSessionImportSessionKeys (
+  IN OUT VOID       *SecuredMessageContext,
+  IN     UINT64     SequenceNumber
+  )
+{
+  UINT8                            SessionKeys[sizeof(SPDM_SECURE_SESSION_KEYS_STRUCT) + (MAX_AEAD_KEY_SIZE + MAX_AEAD_IV_SIZE + sizeof(UINT64)) * 2];
+  SPDM_SECURE_SESSION_KEYS_STRUCT  *SessionKeysStruct;
+  UINT8                            *Ptr;
+  UINTN                            SessionKeysSize;
+  RETURN_STATUS                    Status;
+
+  SessionKeysStruct = (VOID *)SessionKeys;
+  SessionKeysStruct->Version = SPDM_SECURE_SESSION_KEYS_STRUCT_VERSION;
+  SessionKeysStruct->AeadKeySize = 32;
+  SessionKeysStruct->AeadIvSize = 12;
+  Ptr = (VOID *)(SessionKeysStruct + 1);
+  SetMem (Ptr, 32, 0x5A);
+  Ptr += 32;
+  SetMem (Ptr, 12, 0xA5);
+  Ptr += 12;
+  CopyMem (Ptr, &SequenceNumber, sizeof(UINT64));
+  Ptr += sizeof(UINT64);
+  SetMem (Ptr, 32, 0x3C);
+  Ptr += 32;
+  SetMem (Ptr, 12, 0xC3);
+  Ptr += 12;
+  CopyMem (Ptr, &SequenceNumber, sizeof(UINT64));
+  Ptr += sizeof(UINT64);
+  SessionKeysSize = Ptr - SessionKeys;
+
+  Status = SpdmSecuredMessageImportSessionKeys (SecuredMessageContext, SessionKeys, SessionKeysSize);
+  assert_int_equal (Status, RETURN_SUCCESS);
+}
+
+/**
+  Initialize an established AES-256-GCM session with fixed keys and the given sequence numbers.
+**/
+VOID
+TestSessionInitSecuredMessageContext (
+  IN OUT VOID       *SecuredMessageContext,
+  IN     UINT64     SequenceNumber
+  )
+{
+  SpdmSecuredMessageInitContext (SecuredMessageContext);
+  SpdmSecuredMessageSetAlgorithms (
+    SecuredMessageContext,
+    SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256,
+    SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1,
+    SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM,
+    SPDM_ALGORITHMS_KEY_SCHEDULE_HMAC_HASH
+    );
+  SpdmSecuredMessageSetSessionType (SecuredMessageContext, SpdmSessionTypeEncMac);
+  SpdmSecuredMessageSetSessionState (SecuredMessageContext, SpdmSessionStateEstablished);
+  TestSessionImportSessionKeys (SecuredMessageContext, SequenceNumber);
+}
+
+/**
+  Encode the request records with the sequence numbers 0 to TEST_SESSION_RECORD_COUNT - 1.
+**/
+VOID
+TestSessionEncodeRecords (
+  OUT UINT8      SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE],
+  OUT UINTN      SecuredMessageSize[TEST_SESSION_RECORD_COUNT]
+  )
+{
+  VOID                   *SecuredMessageContext;
+  UINT8                  AppMessage[16];
+  UINTN                  Index;
+  RETURN_STATUS          Status;
+
+  SecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (SecuredMessageContext);
+  TestSessionInitSecuredMessageContext (SecuredMessageContext, 0);
+  for (Index = 0; Index < TEST_SESSION_RECORD_COUNT; Index++) {
+    SetMem (AppMessage, sizeof(AppMessage), (UINT8)Index);
+    SecuredMessageSize[Index] = MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE;
+    Status = SpdmEncodeSecuredMessage (SecuredMessageContext, TEST_SESSION_SESSION_ID, TRUE, sizeof(AppMessage), AppMessage,
+               &SecuredMessageSize[Index], SecuredMessage[Index], &mTestSessionCallbacks);
+    assert_int_equal (Status, RETURN_SUCCESS);
+  }
+  SpdmSecuredMessageDeinitContext (SecuredMessageContext);
+  free (SecuredMessageContext);
+}
+
+/**
+  Decode a request record, and check that it carries the application message of its sequence number.
+**/
+RETURN_STATUS
+TestSessionDecodeRecord (
+  IN VOID        *SecuredMessageContext,
+  IN UINT8       *SecuredMessage,
+  IN UINTN       SecuredMessageSize,
+  IN UINT8       SequenceNumber
+  )
+{
+  UINT8                  AppMessage[MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINT8                  ExpectedAppMessage[16];
+  UINTN                  AppMessageSize;
+  RETURN_STATUS          Status;
+
+  AppMessageSize = sizeof(AppMessage);
+  Status = SpdmDecodeSecuredMessage (SecuredMessageContext, TEST_SESSION_SESSION_ID, TRUE, SecuredMessageSize, SecuredMessage,
+             &AppMessageSize, AppMessage, &mTestSessionCallbacks);
+  if (!RETURN_ERROR(Status)) {
+    SetMem (ExpectedAppMessage, sizeof(ExpectedAppMessage), SequenceNumber);
+    assert_int_equal (AppMessageSize, sizeof(ExpectedAppMessage));
+    assert_memory_equal (AppMessage, ExpectedAppMessage, sizeof(ExpectedAppMessage));
+  }
+  return Status;
+}
+
+int SpdmSessionReplayWindowTestMain (void);
+int SpdmSessionExportTestMain (void);
+int SpdmSessionDecodeGroupTestMain (void);
+int SpdmSessionTableTestMain (void);
+
+int main(void) {
+  SpdmSessionReplayWindowTestMain ();
+
+  SpdmSessionExportTestMain ();
+
+  SpdmSessionDecodeGroupTestMain ();
+
+  SpdmSessionTableTestMain ();
+  return 0;
+}
@@ -0,0 +1,47 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __TEST_SPDM_SESSION_H__
+#define __TEST_SPDM_SESSION_H__
+
+#include "SpdmUnitTest.h"
+#include <SpdmSecuredMessageLibInternal.h>
+
+#define TEST_SESSION_SESSION_ID     0xFFFFFFFF
+#define TEST_SESSION_RECORD_COUNT   4
+
+extern SPDM_SECURED_MESSAGE_CALLBACKS  mTestSessionCallbacks;
+
+VOID
+TestSessionImportSessionKeys (
+  IN OUT VOID       *SecuredMessageContext,
+  IN     UINT64     SequenceNumber
+  );
+
+VOID
+TestSessionInitSecuredMessageContext (
+  IN OUT VOID       *SecuredMessageContext,
+  IN     UINT64     SequenceNumber
+  );
+
+VOID
+TestSessionEncodeRecords (
+  OUT UINT8      SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE],
+  OUT UINTN      SecuredMessageSize[TEST_SESSION_RECORD_COUNT]
+  );
+
+RETURN_STATUS
+TestSessionDecodeRecord (
+  IN VOID        *SecuredMessageContext,
+  IN UINT8       *SecuredMessage,
+  IN UINTN       SecuredMessageSize,
+  IN UINT8       SequenceNumber
+  );
+
+#endif
@@ -0,0 +1,287 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TestSpdmSession.h"
+
+#define TEST_SESSION_OTHER_SESSION_ID  0xFFFFFFFE
+#define TEST_SESSION_GROUP_SIZE        4
+
+typedef struct {
+  SPDM_SECURED_MESSAGE_CONTEXT         *SecuredMessageContext;
+  UINT32                               SessionId;
+  UINT8                                *SecuredMessage;
+  UINTN                                SecuredMessageSize;
+  UINT8                                SequenceNumber;
+  RETURN_STATUS                        PrepareStatus;
+  RETURN_STATUS                        Status;
+} TEST_SESSION_GROUP_ENTRY;
+
+/**
+  Encode the request records of the other session with the sequence numbers 0 to TEST_SESSION_RECORD_COUNT - 1.
+**/
+VOID
+TestSessionEncodeOtherSessionRecords (
+  OUT UINT8      SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE],
+  OUT UINTN      SecuredMessageSize[TEST_SESSION_RECORD_COUNT]
+  )
+{
+  VOID                   *SecuredMessageContext;
+  UINT8                  AppMessage[16];
+  UINTN                  Index;
+  RETURN_STATUS          Status;
+
+  SecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (SecuredMessageContext);
+  TestSessionInitSecuredMessageContext (SecuredMessageContext, 0);
+  for (Index = 0; Index < TEST_SESSION_RECORD_COUNT; Index++) {
+    SetMem (AppMessage, sizeof(AppMessage), (UINT8)(0x80 | Index));
+    SecuredMessageSize[Index] = MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE;
+    Status = SpdmEncodeSecuredMessage (SecuredMessageContext, TEST_SESSION_OTHER_SESSION_ID, TRUE, sizeof(AppMessage), AppMessage,
+               &SecuredMessageSize[Index], SecuredMessage[Index], &mTestSessionCallbacks);
+    assert_int_equal (Status, RETURN_SUCCESS);
+  }
+  SpdmSecuredMessageDeinitContext (SecuredMessageContext);
+  free (SecuredMessageContext);
+}
+
+/**
+  Decode a group of records: all of them are prepared, then opened back to back, then finished.
+  Each entry that is decoded must carry the application message of its sequence number.
+**/
+VOID
+TestSessionDecodeGroup (
+  IN OUT TEST_SESSION_GROUP_ENTRY  *Entry,
+  IN     UINTN                     EntryCount
+  )
+{
+  SPDM_SECURED_MESSAGE_DECODE_STATE  State[TEST_SESSION_GROUP_SIZE];
+  BOOLEAN                            Authenticated[TEST_SESSION_GROUP_SIZE];
+  UINT8                              AppMessage[TEST_SESSION_GROUP_SIZE][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                              AppMessageSize;
+  UINT8                              ExpectedAppMessage[16];
+  UINTN                              Index;
+
+  assert_true (EntryCount <= TEST_SESSION_GROUP_SIZE);
+  for (Index = 0; Index < EntryCount; Index++) {
+    Entry[Index].PrepareStatus = SpdmDecodeSecuredMessagePrepare (
+                                   Entry[Index].SecuredMessageContext,
+                                   Entry[Index].SessionId,
+                                   TRUE,
+                                   Entry[Index].SecuredMessageSize,
+                                   Entry[Index].SecuredMessage,
+                                   sizeof(AppMessage[Index]),
+                                   AppMessage[Index],
+                                   &mTestSessionCallbacks,
+                                   &State[Index]
+                                   );
+    Entry[Index].Status = Entry[Index].PrepareStatus;
+  }
+  for (Index = 0; Index < EntryCount; Index++) {
+    if (!RETURN_ERROR(Entry[Index].Status)) {
+      Authenticated[Index] = SpdmDecodeSecuredMessageOpen (&State[Index]);
+    }
+  }
+  for (Index = 0; Index < EntryCount; Index++) {
+    if (RETURN_ERROR(Entry[Index].Status)) {
+      continue;
+    }
+    AppMessageSize = sizeof(AppMessage[Index]);
+    Entry[Index].Status = SpdmDecodeSecuredMessageFinish (&State[Index], Authenticated[Index], &AppMessageSize, AppMessage[Index]);
+    if (!RETURN_ERROR(Entry[Index].Status)) {
+      if (Entry[Index].SessionId == TEST_SESSION_OTHER_SESSION_ID) {
+        SetMem (ExpectedAppMessage, sizeof(ExpectedAppMessage), (UINT8)(0x80 | Entry[Index].SequenceNumber));
+      } else {
+        SetMem (ExpectedAppMessage, sizeof(ExpectedAppMessage), Entry[Index].SequenceNumber);
+      }
+      assert_int_equal (AppMessageSize, sizeof(ExpectedAppMessage));
+      assert_memory_equal (AppMessage[Index], ExpectedAppMessage, sizeof(ExpectedAppMessage));
+    }
+  }
+}
+
+/**
+  Set a group entry for a record.
+**/
+VOID
+TestSessionSetGroupEntry (
+  OUT TEST_SESSION_GROUP_ENTRY        *Entry,
+  IN  SPDM_SECURED_MESSAGE_CONTEXT    *SecuredMessageContext,
+  IN  UINT32                          SessionId,
+  IN  UINT8                           *SecuredMessage,
+  IN  UINTN                           SecuredMessageSize,
+  IN  UINT8                           SequenceNumber
+  )
+{
+  Entry->SecuredMessageContext = SecuredMessageContext;
+  Entry->SessionId = SessionId;
+  Entry->SecuredMessage = SecuredMessage;
+  Entry->SecuredMessageSize = SecuredMessageSize;
+  Entry->SequenceNumber = SequenceNumber;
+}
+
+void TestSpdmSessionDecodeGroupCase1(void **state) {
+  UINT8                         SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                         SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  UINT8                         OtherSecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                         OtherSecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  SPDM_SECURED_MESSAGE_CONTEXT  *SecuredMessageContext;
+  SPDM_SECURED_MESSAGE_CONTEXT  *OtherSecuredMessageContext;
+  TEST_SESSION_GROUP_ENTRY      Entry[TEST_SESSION_GROUP_SIZE];
+  UINTN                         Index;
+  RETURN_STATUS                 Status;
+
+  //
+  // A group holds two records of each of two sessions. All of them are decoded.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  TestSessionEncodeOtherSessionRecords (OtherSecuredMessage, OtherSecuredMessageSize);
+  SecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (SecuredMessageContext);
+  TestSessionInitSecuredMessageContext (SecuredMessageContext, 0);
+  OtherSecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (OtherSecuredMessageContext);
+  TestSessionInitSecuredMessageContext (OtherSecuredMessageContext, 0);
+
+  TestSessionSetGroupEntry (&Entry[0], SecuredMessageContext, TEST_SESSION_SESSION_ID, SecuredMessage[0], SecuredMessageSize[0], 0);
+  TestSessionSetGroupEntry (&Entry[1], OtherSecuredMessageContext, TEST_SESSION_OTHER_SESSION_ID, OtherSecuredMessage[0], OtherSecuredMessageSize[0], 0);
+  TestSessionSetGroupEntry (&Entry[2], SecuredMessageContext, TEST_SESSION_SESSION_ID, SecuredMessage[1], SecuredMessageSize[1], 1);
+  TestSessionSetGroupEntry (&Entry[3], OtherSecuredMessageContext, TEST_SESSION_OTHER_SESSION_ID, OtherSecuredMessage[1], OtherSecuredMessageSize[1], 1);
+  TestSessionDecodeGroup (Entry, TEST_SESSION_GROUP_SIZE);
+  for (Index = 0; Index < TEST_SESSION_GROUP_SIZE; Index++) {
+    assert_int_equal (Entry[Index].Status, RETURN_SUCCESS);
+  }
+
+  //
+  // The sessions go on from the records decoded in the group.
+  //
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[1], SecuredMessageSize[1], 1);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[2], SecuredMessageSize[2], 2);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (OtherSecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber, 2);
+
+  SpdmSecuredMessageDeinitContext (OtherSecuredMessageContext);
+  free (OtherSecuredMessageContext);
+  SpdmSecuredMessageDeinitContext (SecuredMessageContext);
+  free (SecuredMessageContext);
+}
+
+void TestSpdmSessionDecodeGroupCase2(void **state) {
+  UINT8                         SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                         SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  UINT8                         OtherSecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                         OtherSecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  SPDM_SECURED_MESSAGE_CONTEXT  *SecuredMessageContext;
+  SPDM_SECURED_MESSAGE_CONTEXT  *OtherSecuredMessageContext;
+  TEST_SESSION_GROUP_ENTRY      Entry[TEST_SESSION_GROUP_SIZE];
+  SPDM_ERROR_STRUCT             LastSpdmError;
+
+  //
+  // A record whose tag does not verify fails alone. The other records of the group, of its own session
+  // and of the other session, are decoded.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  TestSessionEncodeOtherSessionRecords (OtherSecuredMessage, OtherSecuredMessageSize);
+  SecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (SecuredMessageContext);
+  TestSessionInitSecuredMessageContext (SecuredMessageContext, 0);
+  OtherSecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (OtherSecuredMessageContext);
+  TestSessionInitSecuredMessageContext (OtherSecuredMessageContext, 0);
+
+  OtherSecuredMessage[0][OtherSecuredMessageSize[0] - 1] ^= 0x01;
+  TestSessionSetGroupEntry (&Entry[0], SecuredMessageContext, TEST_SESSION_SESSION_ID, SecuredMessage[0], SecuredMessageSize[0], 0);
+  TestSessionSetGroupEntry (&Entry[1], OtherSecuredMessageContext, TEST_SESSION_OTHER_SESSION_ID, OtherSecuredMessage[0], OtherSecuredMessageSize[0], 0);
+  TestSessionSetGroupEntry (&Entry[2], OtherSecuredMessageContext, TEST_SESSION_OTHER_SESSION_ID, OtherSecuredMessage[1], OtherSecuredMessageSize[1], 1);
+  TestSessionSetGroupEntry (&Entry[3], SecuredMessageContext, TEST_SESSION_SESSION_ID, SecuredMessage[1], SecuredMessageSize[1], 1);
+  TestSessionDecodeGroup (Entry, TEST_SESSION_GROUP_SIZE);
+  assert_int_equal (Entry[0].Status, RETURN_SUCCESS);
+  assert_int_equal (Entry[1].PrepareStatus, RETURN_SUCCESS);
+  assert_int_equal (Entry[1].Status, RETURN_SECURITY_VIOLATION);
+  assert_int_equal (Entry[2].Status, RETURN_SUCCESS);
+  assert_int_equal (Entry[3].Status, RETURN_SUCCESS);
+
+  SpdmSecuredMessageGetLastSpdmErrorStruct (OtherSecuredMessageContext, &LastSpdmError);
+  assert_int_equal (LastSpdmError.ErrorCode, SPDM_ERROR_CODE_DECRYPT_ERROR);
+  assert_int_equal (LastSpdmError.SessionId, TEST_SESSION_OTHER_SESSION_ID);
+  SpdmSecuredMessageGetLastSpdmErrorStruct (SecuredMessageContext, &LastSpdmError);
+  assert_int_equal (LastSpdmError.ErrorCode, 0);
+
+  //
+  // The sequence number of the failed record is still free.
+  //
+  OtherSecuredMessage[0][OtherSecuredMessageSize[0] - 1] ^= 0x01;
+  TestSessionSetGroupEntry (&Entry[0], OtherSecuredMessageContext, TEST_SESSION_OTHER_SESSION_ID, OtherSecuredMessage[0], OtherSecuredMessageSize[0], 0);
+  TestSessionDecodeGroup (Entry, 1);
+  assert_int_equal (Entry[0].Status, RETURN_SUCCESS);
+
+  SpdmSecuredMessageDeinitContext (OtherSecuredMessageContext);
+  free (OtherSecuredMessageContext);
+  SpdmSecuredMessageDeinitContext (SecuredMessageContext);
+  free (SecuredMessageContext);
+}
+
+void TestSpdmSessionDecodeGroupCase3(void **state) {
+  UINT8                         SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                         SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  UINT8                         OtherSecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                         OtherSecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  SPDM_SECURED_MESSAGE_CONTEXT  *SecuredMessageContext;
+  SPDM_SECURED_MESSAGE_CONTEXT  *OtherSecuredMessageContext;
+  TEST_SESSION_GROUP_ENTRY      Entry[TEST_SESSION_GROUP_SIZE];
+
+  //
+  // A record replayed inside a group passes the check of its header, since the first copy is not
+  // authenticated yet, and is rejected when it is finished.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  TestSessionEncodeOtherSessionRecords (OtherSecuredMessage, OtherSecuredMessageSize);
+  SecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (SecuredMessageContext);
+  TestSessionInitSecuredMessageContext (SecuredMessageContext, 0);
+  OtherSecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (OtherSecuredMessageContext);
+  TestSessionInitSecuredMessageContext (OtherSecuredMessageContext, 0);
+
+  TestSessionSetGroupEntry (&Entry[0], SecuredMessageContext, TEST_SESSION_SESSION_ID, SecuredMessage[2], SecuredMessageSize[2], 2);
+  TestSessionSetGroupEntry (&Entry[1], OtherSecuredMessageContext, TEST_SESSION_OTHER_SESSION_ID, OtherSecuredMessage[0], OtherSecuredMessageSize[0], 0);
+  TestSessionSetGroupEntry (&Entry[2], SecuredMessageContext, TEST_SESSION_SESSION_ID, SecuredMessage[2], SecuredMessageSize[2], 2);
+  TestSessionSetGroupEntry (&Entry[3], SecuredMessageContext, TEST_SESSION_SESSION_ID, SecuredMessage[0], SecuredMessageSize[0], 0);
+  TestSessionDecodeGroup (Entry, TEST_SESSION_GROUP_SIZE);
+  assert_int_equal (Entry[0].Status, RETURN_SUCCESS);
+  assert_int_equal (Entry[1].Status, RETURN_SUCCESS);
+  assert_int_equal (Entry[2].PrepareStatus, RETURN_SUCCESS);
+  assert_int_equal (Entry[2].Status, RETURN_SECURITY_VIOLATION);
+  assert_int_equal (Entry[3].Status, RETURN_SUCCESS);
+
+  //
+  // The replayed record is rejected when it is decoded again after the group.
+  //
+  TestSessionSetGroupEntry (&Entry[0], SecuredMessageContext, TEST_SESSION_SESSION_ID, SecuredMessage[2], SecuredMessageSize[2], 2);
+  TestSessionDecodeGroup (Entry, 1);
+  assert_int_equal (Entry[0].PrepareStatus, RETURN_SECURITY_VIOLATION);
+
+  SpdmSecuredMessageDeinitContext (OtherSecuredMessageContext);
+  free (OtherSecuredMessageContext);
+  SpdmSecuredMessageDeinitContext (SecuredMessageContext);
+  free (SecuredMessageContext);
+}
+
+int SpdmSessionDecodeGroupTestMain(void) {
+  const struct CMUnitTest SpdmSessionDecodeGroupTests[] = {
+    // Two records of each of two sessions in one group
+    cmocka_unit_test(TestSpdmSessionDecodeGroupCase1),
+    // One record of the group is not authenticated
+    cmocka_unit_test(TestSpdmSessionDecodeGroupCase2),
+    // A record replayed inside the group
+    cmocka_unit_test(TestSpdmSessionDecodeGroupCase3),
+  };
+
+  return cmocka_run_group_tests(SpdmSessionDecodeGroupTests, NULL, NULL);
+}
@@ -0,0 +1,352 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TestSpdmSession.h"
+
+UINT8  mTestExportWrappingKey[SPDM_SESSION_WRAPPING_KEY_SIZE] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+};
+
+//
+// GET_VERSION and VERSION 1.1.
+//
+UINT8  mTestExportMessageA[] = {
+  0x10, 0x84, 0x00, 0x00,
+  0x10, 0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x11,
+};
+
+/**
+  Allocate and initialize an SPDM context whose local capabilities allow encrypted sessions.
+**/
+VOID *
+TestExportNewSpdmContext (
+  VOID
+  )
+{
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+
+  SpdmContext = malloc (SpdmGetContextSize ());
+  assert_non_null (SpdmContext);
+  SpdmInitContext (SpdmContext);
+  SpdmContext->LocalContext.Capability.Flags |= SPDM_GET_CAPABILITIES_REQUEST_FLAGS_ENCRYPT_CAP |
+                                                SPDM_GET_CAPABILITIES_REQUEST_FLAGS_MAC_CAP;
+  return SpdmContext;
+}
+
+VOID
+TestExportFreeSpdmContext (
+  IN VOID  *SpdmContext
+  )
+{
+  SpdmDeinitContext (SpdmContext);
+  free (SpdmContext);
+}
+
+/**
+  Negotiate the connection of an SPDM context with SHA-256, SECP256R1 and the given AEAD cipher suite.
+**/
+VOID
+TestExportNegotiate (
+  IN OUT SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT16               AEADCipherSuite
+  )
+{
+  SpdmContext->ConnectionInfo.Version.SpdmVersionCount = 1;
+  SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MajorVersion = 1;
+  SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MinorVersion = 1;
+  SpdmContext->ConnectionInfo.Capability.Flags = SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_ENCRYPT_CAP |
+                                                 SPDM_GET_CAPABILITIES_RESPONSE_FLAGS_MAC_CAP;
+  SpdmContext->ConnectionInfo.Algorithm.BaseHashAlgo = SPDM_ALGORITHMS_BASE_HASH_ALGO_TPM_ALG_SHA_256;
+  SpdmContext->ConnectionInfo.Algorithm.DHENamedGroup = SPDM_ALGORITHMS_DHE_NAMED_GROUP_SECP_256_R1;
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = AEADCipherSuite;
+  SpdmContext->ConnectionInfo.Algorithm.KeySchedule = SPDM_ALGORITHMS_KEY_SCHEDULE_HMAC_HASH;
+  SpdmResetMessageA (SpdmContext);
+  SpdmAppendMessageA (SpdmContext, mTestExportMessageA, sizeof(mTestExportMessageA));
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateNegotiated;
+}
+
+/**
+  Establish a session with the fixed keys in a negotiated SPDM context.
+**/
+SPDM_SESSION_INFO *
+TestExportEstablishSession (
+  IN OUT SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN     UINT32               SessionId
+  )
+{
+  SPDM_SESSION_INFO  *SessionInfo;
+
+  SessionInfo = SpdmAssignSessionId (SpdmContext, SessionId, FALSE);
+  assert_non_null (SessionInfo);
+  SpdmSecuredMessageSetSessionState (SessionInfo->SecuredMessageContext, SpdmSessionStateEstablished);
+  TestSessionImportSessionKeys (SessionInfo->SecuredMessageContext, 0);
+  SessionInfo->HeartbeatPeriod = 5;
+  return SessionInfo;
+}
+
+/**
+  Export the session of a negotiated SPDM context, after its first requests are decoded.
+**/
+VOID
+TestExportSession (
+  IN     UINT8      SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE],
+  IN     UINTN      SecuredMessageSize[TEST_SESSION_RECORD_COUNT],
+     OUT UINT8      *SessionState,
+  IN OUT UINTN      *SessionStateSize
+  )
+{
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  SPDM_SESSION_INFO    *SessionInfo;
+  RETURN_STATUS        Status;
+
+  SpdmContext = TestExportNewSpdmContext ();
+  TestExportNegotiate (SpdmContext, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM);
+  SessionInfo = TestExportEstablishSession (SpdmContext, TEST_SESSION_SESSION_ID);
+  Status = TestSessionDecodeRecord (SessionInfo->SecuredMessageContext, SecuredMessage[0], SecuredMessageSize[0], 0);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSessionDecodeRecord (SessionInfo->SecuredMessageContext, SecuredMessage[1], SecuredMessageSize[1], 1);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  Status = SpdmExportSession (SpdmContext, TEST_SESSION_SESSION_ID, mTestExportWrappingKey, sizeof(mTestExportWrappingKey),
+             SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  TestExportFreeSpdmContext (SpdmContext);
+}
+
+void TestSpdmSessionExportCase1(void **state) {
+  UINT8                SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  UINT8                SessionState[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                SessionStateSize;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  SPDM_SESSION_INFO    *SessionInfo;
+  RETURN_STATUS        Status;
+
+  //
+  // The imported session continues with the next sequence number, on the restored connection.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  SessionStateSize = sizeof(SessionState);
+  TestExportSession (SecuredMessage, SecuredMessageSize, SessionState, &SessionStateSize);
+
+  SpdmContext = TestExportNewSpdmContext ();
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateNegotiated);
+  assert_int_equal (SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM);
+  assert_int_equal (GetManagedBufferSize (&SpdmContext->Transcript.MessageA), sizeof(mTestExportMessageA));
+  assert_memory_equal (GetManagedBuffer (&SpdmContext->Transcript.MessageA), mTestExportMessageA, sizeof(mTestExportMessageA));
+
+  SessionInfo = SpdmGetSessionInfoViaSessionId (SpdmContext, TEST_SESSION_SESSION_ID);
+  assert_non_null (SessionInfo);
+  assert_int_equal (SessionInfo->HeartbeatPeriod, 5);
+  assert_int_equal (SpdmSecuredMessageGetSessionState (SessionInfo->SecuredMessageContext), SpdmSessionStateEstablished);
+  Status = TestSessionDecodeRecord (SessionInfo->SecuredMessageContext, SecuredMessage[2], SecuredMessageSize[2], 2);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSessionDecodeRecord (SessionInfo->SecuredMessageContext, SecuredMessage[1], SecuredMessageSize[1], 1);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  Status = TestSessionDecodeRecord (SessionInfo->SecuredMessageContext, SecuredMessage[3], SecuredMessageSize[3], 3);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  TestExportFreeSpdmContext (SpdmContext);
+}
+
+void TestSpdmSessionExportCase2(void **state) {
+  UINT8                SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  UINT8                SessionState[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                SessionStateSize;
+  UINT8                WrappingKey[SPDM_SESSION_WRAPPING_KEY_SIZE];
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  RETURN_STATUS        Status;
+
+  //
+  // A wrong wrapping key is detected, and the connection is left as it was.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  SessionStateSize = sizeof(SessionState);
+  TestExportSession (SecuredMessage, SecuredMessageSize, SessionState, &SessionStateSize);
+
+  SpdmContext = TestExportNewSpdmContext ();
+  CopyMem (WrappingKey, mTestExportWrappingKey, sizeof(WrappingKey));
+  WrappingKey[0] ^= 0x01;
+  Status = SpdmImportSession (SpdmContext, WrappingKey, sizeof(WrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey) - 1, 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_INVALID_PARAMETER);
+  assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateNotStarted);
+  assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, TEST_SESSION_SESSION_ID));
+  TestExportFreeSpdmContext (SpdmContext);
+}
+
+void TestSpdmSessionExportCase3(void **state) {
+  UINT8                         SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                         SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  UINT8                         SessionState[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                         SessionStateSize;
+  SPDM_EXPORTED_SESSION_HEADER  *Header;
+  SPDM_DEVICE_CONTEXT           *SpdmContext;
+  RETURN_STATUS                 Status;
+
+  //
+  // A tampered header, body or size is detected.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  SessionStateSize = sizeof(SessionState);
+  TestExportSession (SecuredMessage, SecuredMessageSize, SessionState, &SessionStateSize);
+  Header = (VOID *)SessionState;
+
+  SpdmContext = TestExportNewSpdmContext ();
+  Header->SessionId ^= 0x01;
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  Header->SessionId ^= 0x01;
+
+  Header->Iv[0] ^= 0x01;
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  Header->Iv[0] ^= 0x01;
+
+  SessionState[sizeof(SPDM_EXPORTED_SESSION_HEADER)] ^= 0x01;
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  SessionState[sizeof(SPDM_EXPORTED_SESSION_HEADER)] ^= 0x01;
+
+  Header->BodySize -= 1;
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_UNSUPPORTED);
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize - 1, SessionState);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  Header->BodySize += 1;
+
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize - 1, SessionState);
+  assert_int_equal (Status, RETURN_UNSUPPORTED);
+  Header->Version += 1;
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_UNSUPPORTED);
+  Header->Version -= 1;
+
+  assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateNotStarted);
+  assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, TEST_SESSION_SESSION_ID));
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  TestExportFreeSpdmContext (SpdmContext);
+}
+
+void TestSpdmSessionExportCase4(void **state) {
+  UINT8                SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  UINT8                SessionState[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                SessionStateSize;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  RETURN_STATUS        Status;
+
+  //
+  // A session ID which is already in use is not imported again.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  SessionStateSize = sizeof(SessionState);
+  TestExportSession (SecuredMessage, SecuredMessageSize, SessionState, &SessionStateSize);
+
+  SpdmContext = TestExportNewSpdmContext ();
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_ALREADY_STARTED);
+  assert_non_null (SpdmGetSessionInfoViaSessionId (SpdmContext, TEST_SESSION_SESSION_ID));
+  TestExportFreeSpdmContext (SpdmContext);
+}
+
+void TestSpdmSessionExportCase5(void **state) {
+  UINT8                SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  UINT8                SessionState[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                SessionStateSize;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  RETURN_STATUS        Status;
+
+  //
+  // A session is not imported to a connection negotiated with other algorithms.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  SessionStateSize = sizeof(SessionState);
+  TestExportSession (SecuredMessage, SecuredMessageSize, SessionState, &SessionStateSize);
+
+  SpdmContext = TestExportNewSpdmContext ();
+  TestExportNegotiate (SpdmContext, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305);
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_UNSUPPORTED);
+  assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateNegotiated);
+  assert_int_equal (SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite, SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_CHACHA20_POLY1305);
+  assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, TEST_SESSION_SESSION_ID));
+
+  //
+  // It is imported to a connection negotiated with the same algorithms.
+  //
+  SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite = SPDM_ALGORITHMS_AEAD_CIPHER_SUITE_AES_256_GCM;
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  TestExportFreeSpdmContext (SpdmContext);
+}
+
+void TestSpdmSessionExportCase6(void **state) {
+  UINT8                SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  UINT8                SessionState[MAX_SPDM_MESSAGE_BUFFER_SIZE];
+  UINTN                SessionStateSize;
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               SessionId;
+  RETURN_STATUS        Status;
+
+  //
+  // The connection is rolled back when no session can be assigned.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  SessionStateSize = sizeof(SessionState);
+  TestExportSession (SecuredMessage, SecuredMessageSize, SessionState, &SessionStateSize);
+
+  SpdmContext = TestExportNewSpdmContext ();
+  for (SessionId = 1; SpdmAssignSessionId (SpdmContext, SessionId, FALSE) != NULL; SessionId++) {
+  }
+  SpdmContext->ConnectionInfo.Version.SpdmVersionCount = 1;
+  SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MajorVersion = 1;
+  SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MinorVersion = 0;
+  SpdmAppendMessageA (SpdmContext, mTestExportMessageA, 4);
+  SpdmContext->ConnectionInfo.ConnectionState = SpdmConnectionStateAfterVersion;
+
+  Status = SpdmImportSession (SpdmContext, mTestExportWrappingKey, sizeof(mTestExportWrappingKey), 0, SessionStateSize, SessionState);
+  assert_int_equal (Status, RETURN_OUT_OF_RESOURCES);
+  assert_int_equal (SpdmContext->ConnectionInfo.ConnectionState, SpdmConnectionStateAfterVersion);
+  assert_int_equal (SpdmContext->ConnectionInfo.Version.SpdmVersion[0].MinorVersion, 0);
+  assert_int_equal (SpdmContext->ConnectionInfo.Capability.Flags, 0);
+  assert_int_equal (SpdmContext->ConnectionInfo.Algorithm.AEADCipherSuite, 0);
+  assert_int_equal (GetManagedBufferSize (&SpdmContext->Transcript.MessageA), 4);
+  assert_memory_equal (GetManagedBuffer (&SpdmContext->Transcript.MessageA), mTestExportMessageA, 4);
+  assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, TEST_SESSION_SESSION_ID));
+  TestExportFreeSpdmContext (SpdmContext);
+}
+
+int SpdmSessionExportTestMain(void) {
+  const struct CMUnitTest SpdmSessionExportTests[] = {
+    // Round trip, the next record is decoded
+    cmocka_unit_test(TestSpdmSessionExportCase1),
+    // Wrong wrapping key
+    cmocka_unit_test(TestSpdmSessionExportCase2),
+    // Tampered header, body or size
+    cmocka_unit_test(TestSpdmSessionExportCase3),
+    // Duplicate session ID
+    cmocka_unit_test(TestSpdmSessionExportCase4),
+    // Connection negotiated with other algorithms
+    cmocka_unit_test(TestSpdmSessionExportCase5),
+    // Connection rolled back on failure
+    cmocka_unit_test(TestSpdmSessionExportCase6),
+  };
+
+  return cmocka_run_group_tests(SpdmSessionExportTests, NULL, NULL);
+}
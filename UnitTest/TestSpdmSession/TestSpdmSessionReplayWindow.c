@@ -0,0 +1,283 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TestSpdmSession.h"
+#include <SpdmSecuredMessageLibInternal.h>
+
+void TestSpdmSessionReplayWindowCase1(void **state) {
+  UINT64               NextSequenceNumber;
+  UINT64               ReplayWindow;
+  UINT64               SequenceNumber;
+
+  //
+  // A duplicate of the highest record is rejected.
+  //
+  NextSequenceNumber = 0;
+  ReplayWindow = 0;
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 5, sizeof(UINT64), &SequenceNumber));
+  assert_int_equal (SequenceNumber, 5);
+  SpdmSecuredMessageUpdateReplayWindow (&NextSequenceNumber, &ReplayWindow, SequenceNumber);
+  assert_int_equal (NextSequenceNumber, 6);
+  assert_int_equal (ReplayWindow, 1);
+  assert_false (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 5, sizeof(UINT64), &SequenceNumber));
+
+  //
+  // A duplicate of a record below the highest one is rejected.
+  //
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 3, sizeof(UINT64), &SequenceNumber));
+  SpdmSecuredMessageUpdateReplayWindow (&NextSequenceNumber, &ReplayWindow, SequenceNumber);
+  assert_int_equal (NextSequenceNumber, 6);
+  assert_false (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 3, sizeof(UINT64), &SequenceNumber));
+}
+
+void TestSpdmSessionReplayWindowCase2(void **state) {
+  UINT64               SequenceNumber;
+
+  //
+  // A record OPENSPDM_REPLAY_WINDOW_SIZE below the highest one is too old.
+  //
+  assert_false (SpdmSecuredMessageCheckReplayWindow (100, 0, 100 - 1 - OPENSPDM_REPLAY_WINDOW_SIZE, sizeof(UINT64), &SequenceNumber));
+  assert_true (SpdmSecuredMessageCheckReplayWindow (100, 0, 100 - OPENSPDM_REPLAY_WINDOW_SIZE, sizeof(UINT64), &SequenceNumber));
+  assert_int_equal (SequenceNumber, 100 - OPENSPDM_REPLAY_WINDOW_SIZE);
+  assert_false (SpdmSecuredMessageCheckReplayWindow (100, 0, 0, sizeof(UINT64), &SequenceNumber));
+}
+
+void TestSpdmSessionReplayWindowCase3(void **state) {
+  UINT64               NextSequenceNumber;
+  UINT64               ReplayWindow;
+  UINT64               SequenceNumber;
+
+  //
+  // The records inside the window are accepted in any order, once each.
+  //
+  NextSequenceNumber = 0;
+  ReplayWindow = 0;
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 10, sizeof(UINT64), &SequenceNumber));
+  SpdmSecuredMessageUpdateReplayWindow (&NextSequenceNumber, &ReplayWindow, SequenceNumber);
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 8, sizeof(UINT64), &SequenceNumber));
+  SpdmSecuredMessageUpdateReplayWindow (&NextSequenceNumber, &ReplayWindow, SequenceNumber);
+  assert_int_equal (NextSequenceNumber, 11);
+  assert_int_equal (ReplayWindow, BIT0 | BIT2);
+
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 9, sizeof(UINT64), &SequenceNumber));
+  assert_int_equal (SequenceNumber, 9);
+  SpdmSecuredMessageUpdateReplayWindow (&NextSequenceNumber, &ReplayWindow, SequenceNumber);
+  assert_int_equal (ReplayWindow, BIT0 | BIT1 | BIT2);
+  assert_false (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 8, sizeof(UINT64), &SequenceNumber));
+  assert_false (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 9, sizeof(UINT64), &SequenceNumber));
+  assert_false (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 10, sizeof(UINT64), &SequenceNumber));
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 7, sizeof(UINT64), &SequenceNumber));
+
+  //
+  // A jump beyond the window forgets the old records.
+  //
+  SpdmSecuredMessageUpdateReplayWindow (&NextSequenceNumber, &ReplayWindow, 200);
+  assert_int_equal (NextSequenceNumber, 201);
+  assert_int_equal (ReplayWindow, BIT0);
+}
+
+void TestSpdmSessionReplayWindowCase4(void **state) {
+  UINT64               NextSequenceNumber;
+  UINT64               ReplayWindow;
+  UINT64               SequenceNumber;
+
+  //
+  // The 1-byte header sequence number wraps forward and backward around the next sequence number.
+  //
+  NextSequenceNumber = 0xFE;
+  ReplayWindow = 0;
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 0x01, sizeof(UINT8), &SequenceNumber));
+  assert_int_equal (SequenceNumber, 0x101);
+  SpdmSecuredMessageUpdateReplayWindow (&NextSequenceNumber, &ReplayWindow, SequenceNumber);
+  assert_int_equal (NextSequenceNumber, 0x102);
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 0xFF, sizeof(UINT8), &SequenceNumber));
+  assert_int_equal (SequenceNumber, 0xFF);
+  SpdmSecuredMessageUpdateReplayWindow (&NextSequenceNumber, &ReplayWindow, SequenceNumber);
+  assert_false (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 0xFF, sizeof(UINT8), &SequenceNumber));
+  assert_false (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 0x01, sizeof(UINT8), &SequenceNumber));
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 0x00, sizeof(UINT8), &SequenceNumber));
+  assert_int_equal (SequenceNumber, 0x100);
+
+  //
+  // The 2-byte header sequence number wraps the same way.
+  //
+  NextSequenceNumber = 0x10003;
+  ReplayWindow = 0;
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 0xFFFE, sizeof(UINT16), &SequenceNumber));
+  assert_int_equal (SequenceNumber, 0xFFFE);
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 0x0004, sizeof(UINT16), &SequenceNumber));
+  assert_int_equal (SequenceNumber, 0x10004);
+  NextSequenceNumber = 0xFFF0;
+  assert_true (SpdmSecuredMessageCheckReplayWindow (NextSequenceNumber, ReplayWindow, 0x0002, sizeof(UINT16), &SequenceNumber));
+  assert_int_equal (SequenceNumber, 0x10002);
+}
+
+void TestSpdmSessionReplayWindowCase5(void **state) {
+  UINT64               SequenceNumber;
+
+  //
+  // The sequence number -1 is never accepted, from a full or a truncated header.
+  //
+  assert_false (SpdmSecuredMessageCheckReplayWindow (0, 0, (UINT64)-1, sizeof(UINT64), &SequenceNumber));
+  assert_false (SpdmSecuredMessageCheckReplayWindow ((UINT64)-2, 0, (UINT64)-1, sizeof(UINT64), &SequenceNumber));
+  assert_false (SpdmSecuredMessageCheckReplayWindow ((UINT64)-2, 0, 0xFFFF, sizeof(UINT16), &SequenceNumber));
+  assert_true (SpdmSecuredMessageCheckReplayWindow ((UINT64)-2, 0, 0xFFFE, sizeof(UINT16), &SequenceNumber));
+  assert_int_equal (SequenceNumber, (UINT64)-2);
+}
+
+void TestSpdmSessionReplayWindowCase6(void **state) {
+  UINT8                SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  VOID                 *SecuredMessageContext;
+  RETURN_STATUS        Status;
+
+  //
+  // The records of a session are decoded out of order, and a replayed record is rejected.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  SecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (SecuredMessageContext);
+  TestSessionInitSecuredMessageContext (SecuredMessageContext, 0);
+
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[2], SecuredMessageSize[2], 2);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[0], SecuredMessageSize[0], 0);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[2], SecuredMessageSize[2], 2);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[0], SecuredMessageSize[0], 0);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[1], SecuredMessageSize[1], 1);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  //
+  // A record whose tag does not verify leaves its sequence number free.
+  //
+  SecuredMessage[3][SecuredMessageSize[3] - 1] ^= 0x01;
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[3], SecuredMessageSize[3], 3);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  SecuredMessage[3][SecuredMessageSize[3] - 1] ^= 0x01;
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[3], SecuredMessageSize[3], 3);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  SpdmSecuredMessageDeinitContext (SecuredMessageContext);
+  free (SecuredMessageContext);
+}
+
+void TestSpdmSessionReplayWindowCase7(void **state) {
+  UINT8                SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  VOID                 *SecuredMessageContext;
+  VOID                 *ImportedSecuredMessageContext;
+  UINT8                SessionKeys[sizeof(SPDM_SECURE_SESSION_KEYS_STRUCT) + (MAX_AEAD_KEY_SIZE + MAX_AEAD_IV_SIZE + sizeof(UINT64)) * 2];
+  UINTN                SessionKeysSize;
+  RETURN_STATUS        Status;
+
+  //
+  // The records decoded before the session keys are exported are not accepted after they are imported.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  SecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (SecuredMessageContext);
+  TestSessionInitSecuredMessageContext (SecuredMessageContext, 0);
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[0], SecuredMessageSize[0], 0);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[2], SecuredMessageSize[2], 2);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  SessionKeysSize = sizeof(SessionKeys);
+  Status = SpdmSecuredMessageExportSessionKeys (SecuredMessageContext, SessionKeys, &SessionKeysSize);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  ImportedSecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (ImportedSecuredMessageContext);
+  TestSessionInitSecuredMessageContext (ImportedSecuredMessageContext, 0);
+  Status = SpdmSecuredMessageImportSessionKeys (ImportedSecuredMessageContext, SessionKeys, SessionKeysSize);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  Status = TestSessionDecodeRecord (ImportedSecuredMessageContext, SecuredMessage[0], SecuredMessageSize[0], 0);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  Status = TestSessionDecodeRecord (ImportedSecuredMessageContext, SecuredMessage[2], SecuredMessageSize[2], 2);
+  assert_int_equal (Status, RETURN_SECURITY_VIOLATION);
+  Status = TestSessionDecodeRecord (ImportedSecuredMessageContext, SecuredMessage[3], SecuredMessageSize[3], 3);
+  assert_int_equal (Status, RETURN_SUCCESS);
+
+  SpdmSecuredMessageDeinitContext (ImportedSecuredMessageContext);
+  free (ImportedSecuredMessageContext);
+  SpdmSecuredMessageDeinitContext (SecuredMessageContext);
+  free (SecuredMessageContext);
+}
+
+void TestSpdmSessionReplayWindowCase8(void **state) {
+  UINT8                         SecuredMessage[TEST_SESSION_RECORD_COUNT][MAX_SPDM_MESSAGE_SMALL_BUFFER_SIZE];
+  UINTN                         SecuredMessageSize[TEST_SESSION_RECORD_COUNT];
+  SPDM_SECURED_MESSAGE_CONTEXT  *SecuredMessageContext;
+  SPDM_SECURED_MESSAGE_CONTEXT  *NewSecuredMessageContext;
+  RETURN_STATUS                 Status;
+
+  //
+  // A context reset after its session is released is the same as a new context,
+  // apart from its random stream.
+  //
+  TestSessionEncodeRecords (SecuredMessage, SecuredMessageSize);
+  SecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (SecuredMessageContext);
+  TestSessionInitSecuredMessageContext (SecuredMessageContext, 0);
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[0], SecuredMessageSize[0], 0);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  Status = TestSessionDecodeRecord (SecuredMessageContext, SecuredMessage[2], SecuredMessageSize[2], 2);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  assert_int_not_equal (SecuredMessageContext->ApplicationSecret.RequestDataSequenceNumber, 0);
+
+  SpdmSecuredMessageDeinitContext (SecuredMessageContext);
+  SpdmSecuredMessageResetContext (SecuredMessageContext);
+
+  NewSecuredMessageContext = malloc (SpdmSecuredMessageGetContextSize ());
+  assert_non_null (NewSecuredMessageContext);
+  SetMem (NewSecuredMessageContext, SpdmSecuredMessageGetContextSize (), 0xA5);
+  SpdmSecuredMessageInitContext (NewSecuredMessageContext);
+
+  assert_memory_equal (
+    SecuredMessageContext,
+    NewSecuredMessageContext,
+    OFFSET_OF(SPDM_SECURED_MESSAGE_CONTEXT, RandomStream)
+    );
+  assert_memory_equal (
+    SecuredMessageContext->DecodePadding,
+    NewSecuredMessageContext->DecodePadding,
+    sizeof(SPDM_SECURED_MESSAGE_CONTEXT) - OFFSET_OF(SPDM_SECURED_MESSAGE_CONTEXT, DecodePadding)
+    );
+
+  SpdmSecuredMessageDeinitContext (NewSecuredMessageContext);
+  free (NewSecuredMessageContext);
+  SpdmSecuredMessageDeinitContext (SecuredMessageContext);
+  free (SecuredMessageContext);
+}
+
+int SpdmSessionReplayWindowTestMain(void) {
+  const struct CMUnitTest SpdmSessionReplayWindowTests[] = {
+    // Duplicate record
+    cmocka_unit_test(TestSpdmSessionReplayWindowCase1),
+    // Record older than the window
+    cmocka_unit_test(TestSpdmSessionReplayWindowCase2),
+    // Out of order records inside the window
+    cmocka_unit_test(TestSpdmSessionReplayWindowCase3),
+    // 1-byte and 2-byte header sequence number wrap
+    cmocka_unit_test(TestSpdmSessionReplayWindowCase4),
+    // Sequence number -1
+    cmocka_unit_test(TestSpdmSessionReplayWindowCase5),
+    // Out of order and replayed secured messages
+    cmocka_unit_test(TestSpdmSessionReplayWindowCase6),
+    // Replay after the session keys are imported
+    cmocka_unit_test(TestSpdmSessionReplayWindowCase7),
+    // Reset of a released context
+    cmocka_unit_test(TestSpdmSessionReplayWindowCase8),
+  };
+
+  return cmocka_run_group_tests(SpdmSessionReplayWindowTests, NULL, NULL);
+}
@@ -0,0 +1,303 @@
+/**
+@file
+UEFI OS based application.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TestSpdmSession.h"
+
+#if OPENSPDM_SESSION_HASH_TABLE_SUPPORT == 1
+
+#define TEST_TABLE_LARGE_SESSION_COUNT  64
+
+/**
+  Allocate and initialize an SPDM context with the given number of session slots, or the default for 0.
+**/
+SPDM_DEVICE_CONTEXT *
+TestTableNewSpdmContext (
+  IN UINTN  MaxSessionCount
+  )
+{
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  SPDM_CONTEXT_CONFIG  Config;
+  RETURN_STATUS        Status;
+
+  ZeroMem (&Config, sizeof(Config));
+  Config.MaxSessionCount = MaxSessionCount;
+  SpdmContext = malloc (SpdmGetContextSizeEx (&Config));
+  assert_non_null (SpdmContext);
+  Status = SpdmInitContextEx (SpdmContext, &Config);
+  assert_int_equal (Status, RETURN_SUCCESS);
+  return SpdmContext;
+}
+
+VOID
+TestTableFreeSpdmContext (
+  IN SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  SpdmDeinitContext (SpdmContext);
+  free (SpdmContext);
+}
+
+/**
+  Check that the session hash table and the free list hold exactly the session slots of the session ID list.
+**/
+VOID
+TestTableCheck (
+  IN SPDM_DEVICE_CONTEXT  *SpdmContext
+  )
+{
+  UINTN                Index;
+  UINTN                Slot;
+  UINTN                AssignedCount;
+  UINTN                EntryCount;
+  UINTN                FreeCount;
+  UINTN                Link;
+
+  AssignedCount = 0;
+  for (Index = 0; Index < SpdmContext->MaxSessionCount; Index++) {
+    if (SpdmContext->SessionIdList[Index] == INVALID_SESSION_ID) {
+      continue;
+    }
+    AssignedCount++;
+    assert_true (SpdmSessionHashTableFind (SpdmContext, SpdmContext->SessionIdList[Index], &Slot));
+    assert_int_equal (SpdmContext->SessionHashTable[Slot], Index + 1);
+    assert_int_equal (SpdmContext->SessionFreeList[Index], 0);
+  }
+
+  EntryCount = 0;
+  for (Slot = 0; Slot < SpdmContext->SessionHashTableSize; Slot++) {
+    if (SpdmContext->SessionHashTable[Slot] != 0) {
+      EntryCount++;
+    }
+  }
+  assert_int_equal (EntryCount, AssignedCount);
+
+  FreeCount = 0;
+  for (Link = SpdmContext->SessionFreeHead; Link != 0; Link = SpdmContext->SessionFreeList[Link - 1]) {
+    assert_int_equal (SpdmContext->SessionIdList[Link - 1], INVALID_SESSION_ID);
+    FreeCount++;
+    assert_true (FreeCount <= SpdmContext->MaxSessionCount);
+  }
+  assert_int_equal (FreeCount, SpdmContext->MaxSessionCount - AssignedCount);
+}
+
+/**
+  Return the Count-th session ID, from FirstSessionId, whose home slot is Home.
+**/
+UINT32
+TestTableSessionIdWithHome (
+  IN SPDM_DEVICE_CONTEXT  *SpdmContext,
+  IN UINTN                Home,
+  IN UINT32               FirstSessionId,
+  IN UINTN                Count
+  )
+{
+  UINT32               SessionId;
+
+  for (SessionId = FirstSessionId; ; SessionId++) {
+    if (SpdmSessionHashTableHome (SpdmContext, SessionId) == Home) {
+      if (Count == 0) {
+        return SessionId;
+      }
+      Count--;
+    }
+  }
+}
+
+/**
+  Sessions are found by their session ID until the table is full, and unknown session IDs are not found.
+**/
+void TestSpdmSessionTableCase1(void **state) {
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  SPDM_SESSION_INFO    *SessionInfo[MAX_SPDM_SESSION_COUNT];
+  UINT32               SessionId;
+  UINTN                Index;
+
+  SpdmContext = TestTableNewSpdmContext (0);
+  assert_int_equal (SpdmContext->MaxSessionCount, MAX_SPDM_SESSION_COUNT);
+  TestTableCheck (SpdmContext);
+
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    SessionId = ((UINT32)(0xFFFF - Index) << 16) | (UINT32)(0xFFFF - Index);
+    SessionInfo[Index] = SpdmAssignSessionId (SpdmContext, SessionId, FALSE);
+    assert_non_null (SessionInfo[Index]);
+    assert_int_equal (SessionInfo[Index]->SessionId, SessionId);
+    TestTableCheck (SpdmContext);
+  }
+  assert_null (SpdmAssignSessionId (SpdmContext, 0x12345678, FALSE));
+  TestTableCheck (SpdmContext);
+
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    SessionId = ((UINT32)(0xFFFF - Index) << 16) | (UINT32)(0xFFFF - Index);
+    assert_ptr_equal (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId), SessionInfo[Index]);
+  }
+  assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, 0x12345678));
+  assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, 0xFFFFFFFE));
+
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    SessionId = ((UINT32)(0xFFFF - Index) << 16) | (UINT32)(0xFFFF - Index);
+    assert_ptr_equal (SpdmFreeSessionId (SpdmContext, SessionId), SessionInfo[Index]);
+    assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId));
+    TestTableCheck (SpdmContext);
+  }
+  TestTableFreeSpdmContext (SpdmContext);
+}
+
+/**
+  Colliding session IDs are found along their probe sequence, and stay found when one before them is removed.
+**/
+void TestSpdmSessionTableCase2(void **state) {
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               SessionId[MAX_SPDM_SESSION_COUNT];
+  UINTN                Home;
+  UINTN                Mask;
+  UINTN                Index;
+
+  SpdmContext = TestTableNewSpdmContext (0);
+  Mask = SpdmContext->SessionHashTableSize - 1;
+
+  //
+  // Three session IDs share the home slot, and the last one has its home in their probe sequence.
+  //
+  Home = SpdmSessionHashTableHome (SpdmContext, 0x00010001);
+  SessionId[0] = TestTableSessionIdWithHome (SpdmContext, Home, 0x00010001, 0);
+  SessionId[1] = TestTableSessionIdWithHome (SpdmContext, Home, 0x00010001, 1);
+  SessionId[2] = TestTableSessionIdWithHome (SpdmContext, Home, 0x00010001, 2);
+  SessionId[3] = TestTableSessionIdWithHome (SpdmContext, (Home + 1) & Mask, 0x00010001, 0);
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    assert_non_null (SpdmAssignSessionId (SpdmContext, SessionId[Index], FALSE));
+  }
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    assert_int_equal (SpdmContext->SessionIdList[SpdmContext->SessionHashTable[(Home + Index) & Mask] - 1], SessionId[Index]);
+  }
+  TestTableCheck (SpdmContext);
+
+  //
+  // Removing the head of the probe sequence shifts the others back.
+  //
+  assert_non_null (SpdmFreeSessionId (SpdmContext, SessionId[0]));
+  assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId[0]));
+  for (Index = 1; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    assert_non_null (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId[Index]));
+    assert_int_equal (SpdmContext->SessionIdList[SpdmContext->SessionHashTable[(Home + Index - 1) & Mask] - 1], SessionId[Index]);
+  }
+  assert_int_equal (SpdmContext->SessionHashTable[(Home + 3) & Mask], 0);
+  TestTableCheck (SpdmContext);
+
+  //
+  // Removing from the middle of the probe sequence keeps the last one, at its home slot, found.
+  //
+  assert_non_null (SpdmFreeSessionId (SpdmContext, SessionId[2]));
+  assert_non_null (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId[1]));
+  assert_non_null (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId[3]));
+  assert_int_equal (SpdmContext->SessionIdList[SpdmContext->SessionHashTable[(Home + 1) & Mask] - 1], SessionId[3]);
+  TestTableCheck (SpdmContext);
+
+  TestTableFreeSpdmContext (SpdmContext);
+}
+
+/**
+  A freed session ID is assigned again, to the freed slot, and the other sessions are unchanged.
+**/
+void TestSpdmSessionTableCase3(void **state) {
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  SPDM_SESSION_INFO    *SessionInfo[MAX_SPDM_SESSION_COUNT];
+  SPDM_SESSION_INFO    *NewSessionInfo;
+  UINTN                Index;
+
+  SpdmContext = TestTableNewSpdmContext (0);
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    SessionInfo[Index] = SpdmAssignSessionId (SpdmContext, (UINT32)(Index + 1), FALSE);
+    assert_non_null (SessionInfo[Index]);
+  }
+
+  assert_ptr_equal (SpdmFreeSessionId (SpdmContext, 2), SessionInfo[1]);
+  assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, 2));
+  assert_int_equal (SessionInfo[1]->SessionId, INVALID_SESSION_ID);
+  TestTableCheck (SpdmContext);
+
+  NewSessionInfo = SpdmAssignSessionId (SpdmContext, 2, TRUE);
+  assert_ptr_equal (NewSessionInfo, SessionInfo[1]);
+  assert_int_equal (NewSessionInfo->SessionId, 2);
+  assert_true (NewSessionInfo->UsePsk);
+  assert_int_equal (SpdmContext->LatestSessionId, 2);
+  for (Index = 0; Index < MAX_SPDM_SESSION_COUNT; Index++) {
+    assert_ptr_equal (SpdmGetSessionInfoViaSessionId (SpdmContext, (UINT32)(Index + 1)), SessionInfo[Index]);
+  }
+  TestTableCheck (SpdmContext);
+
+  //
+  // The table is full again.
+  //
+  assert_null (SpdmAssignSessionId (SpdmContext, 5, FALSE));
+  TestTableFreeSpdmContext (SpdmContext);
+}
+
+/**
+  A large table stays consistent across interleaved frees and re-assignments.
+**/
+void TestSpdmSessionTableCase4(void **state) {
+  SPDM_DEVICE_CONTEXT  *SpdmContext;
+  UINT32               SessionId;
+  UINTN                Index;
+
+  SpdmContext = TestTableNewSpdmContext (TEST_TABLE_LARGE_SESSION_COUNT);
+  assert_int_equal (SpdmContext->SessionHashTableSize, TEST_TABLE_LARGE_SESSION_COUNT * 2);
+
+  for (Index = 0; Index < TEST_TABLE_LARGE_SESSION_COUNT; Index++) {
+    SessionId = ((UINT32)(0xFFFF - Index) << 16) | (UINT32)(Index + 1);
+    assert_non_null (SpdmAssignSessionId (SpdmContext, SessionId, FALSE));
+  }
+  assert_null (SpdmAssignSessionId (SpdmContext, 0x12345678, FALSE));
+  TestTableCheck (SpdmContext);
+
+  for (Index = 0; Index < TEST_TABLE_LARGE_SESSION_COUNT; Index += 2) {
+    SessionId = ((UINT32)(0xFFFF - Index) << 16) | (UINT32)(Index + 1);
+    assert_non_null (SpdmFreeSessionId (SpdmContext, SessionId));
+  }
+  TestTableCheck (SpdmContext);
+  for (Index = 1; Index < TEST_TABLE_LARGE_SESSION_COUNT; Index += 2) {
+    SessionId = ((UINT32)(0xFFFF - Index) << 16) | (UINT32)(Index + 1);
+    assert_non_null (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId));
+  }
+
+  for (Index = 0; Index < TEST_TABLE_LARGE_SESSION_COUNT; Index += 2) {
+    SessionId = ((UINT32)(0xFFFF - Index) << 16) | (UINT32)(Index + 1);
+    assert_null (SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId));
+    assert_non_null (SpdmAssignSessionId (SpdmContext, SessionId, FALSE));
+  }
+  TestTableCheck (SpdmContext);
+  for (Index = 0; Index < TEST_TABLE_LARGE_SESSION_COUNT; Index++) {
+    SessionId = ((UINT32)(0xFFFF - Index) << 16) | (UINT32)(Index + 1);
+    assert_int_equal (((SPDM_SESSION_INFO *)SpdmGetSessionInfoViaSessionId (SpdmContext, SessionId))->SessionId, SessionId);
+  }
+  TestTableFreeSpdmContext (SpdmContext);
+}
+
+int SpdmSessionTableTestMain(void) {
+  const struct CMUnitTest SpdmSessionTableTests[] = {
+    // Insert and lookup until full, unknown session IDs
+    cmocka_unit_test(TestSpdmSessionTableCase1),
+    // Colliding session IDs, removal shifts the probe sequence back
+    cmocka_unit_test(TestSpdmSessionTableCase2),
+    // Free then re-assign the same session ID
+    cmocka_unit_test(TestSpdmSessionTableCase3),
+    // Large table, interleaved frees and re-assignments
+    cmocka_unit_test(TestSpdmSessionTableCase4),
+  };
+
+  return cmocka_run_group_tests(SpdmSessionTableTests, NULL, NULL);
+}
+
+#else
+
+int SpdmSessionTableTestMain(void) {
+  return 0;
+}
+
+#endif